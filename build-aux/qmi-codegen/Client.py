@@ -164,6 +164,10 @@ class Client:
                     '            ${output_camelcase} *output;\n'
                     '            GError *error = NULL;\n'
                     '\n'
+                    '            /* Don\'t bother parsing if nobody listens */\n'
+                    '            if (!g_signal_has_handler_pending (self, signals[SIGNAL_${signal_id}], 0, FALSE))\n'
+                    '                break;\n'
+                    '\n'
                     '            /* Parse indication */\n'
                     '            output = __${message_fullname_underscore}_indication_parse (message, &error);\n'
                     '            if (!output) {\n'
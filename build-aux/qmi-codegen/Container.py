@@ -55,6 +55,10 @@ class Container:
         #  e.g. "Qmi Message Ctl Something Output"
         self.fullname = self.prefix + ' ' + self.name
 
+        # Output containers may keep the message and decode some TLVs only
+        # when first read, see set_lazy()
+        self.lazy = False
+
         self.fields = None
         if dictionary is not None:
             self.fields = []
@@ -103,6 +107,31 @@ class Container:
                         self.fields.append(Field(self.fullname, field_dictionary, common_objects_dictionary, container_type, static))
 
 
+    """
+    Decode TLVs of the output only when their getter is first called, instead
+    of all of them when the message is parsed. Mandatory TLVs, and TLVs that
+    other TLVs have as prerequisites, are still decoded right away.
+    """
+    def set_lazy(self):
+        if self.readonly == False:
+            raise ValueError('Only output containers can be lazy')
+        if self.fields is None:
+            return
+
+        prerequisite_fields = set()
+        for field in self.fields:
+            for prerequisite in field.prerequisites:
+                prerequisite_fields.add(utils.build_underscore_name(prerequisite['field'].split('.')[0]))
+
+        for field in self.fields:
+            if field.variable is None or field.mandatory:
+                continue
+            if utils.build_underscore_name(field.name) in prerequisite_fields:
+                continue
+            field.lazy = True
+            self.lazy = True
+
+
     """
     Emit enumeration of TLVs in the container
     """
@@ -149,6 +178,13 @@ class Container:
             '    volatile gint ref_count;\n')
         cfile.write(string.Template(template).substitute(translations))
 
+        if self.lazy:
+            cfile.write(
+                '\n'
+                '    /* Message the lazy TLVs are decoded from, and the arena room left for them */\n'
+                '    QmiMessage *message;\n'
+                '    QmiMessageArena arena;\n')
+
         if self.fields is not None:
             for field in self.fields:
                 if field.variable is not None:
@@ -157,7 +193,11 @@ class Container:
                     translations['field_name'] = field.name
                     template = (
                         '\n'
-                        '    /* ${field_name} */\n'
+                        '    /* ${field_name} */\n')
+                    if field.lazy:
+                        template += (
+                            '    gboolean ${field_variable_name}_decoded;\n')
+                    template += (
                         '    gboolean ${field_variable_name}_set;\n')
                     cfile.write(string.Template(template).substitute(translations))
                     cfile.write(variable_declaration)
@@ -264,8 +304,18 @@ class Container:
                 if field.variable is not None and field.variable.needs_dispose is True:
                     template += field.variable.build_dispose('        ', 'self->' + field.variable_name)
 
+        if self.lazy:
+            template += (
+                '        qmi_message_unref (self->message);\n')
+
+        # Output containers come from the parsers, allocated along with their arena
+        if self.readonly == True:
+            template += (
+                '        g_free (self);\n')
+        else:
+            template += (
+                '        g_slice_free (${camelcase}, self);\n')
         template += (
-            '        g_slice_free (${camelcase}, self);\n'
             '    }\n'
             '}\n')
         cfile.write(string.Template(template).substitute(translations))
@@ -317,6 +367,11 @@ class Container:
         # Emit TLV enums
         self.__emit_tlv_ids_enum(cfile)
 
+        # Emit decoders of lazy fields
+        for field in self.fields:
+            if field.lazy:
+                field.emit_output_lazy_decoder(cfile)
+
         # Emit fields
         if self.fields is not None:
             for field in self.fields:
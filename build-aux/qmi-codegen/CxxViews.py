@@ -0,0 +1,801 @@
+#!/usr/bin/env python
+# -*- Mode: python; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+#
+# This program is free software; you can redistribute it and/or modify it under
+# the terms of the GNU Lesser General Public License as published by the Free
+# Software Foundation; either version 2 of the License, or (at your option) any
+# later version.
+#
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more
+# details.
+#
+# You should have received a copy of the GNU Lesser General Public License along
+# with this program; if not, write to the Free Software Foundation, Inc., 51
+# Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#
+
+import re
+import string
+
+import utils
+
+"""
+The CxxViews module emits header-only C++ views of the messages in a service
+database, for use by the Gobi API (see gobi-api/*/Core/QMIView.h for the
+support classes the generated code builds upon).
+
+Responses and indications get a view class indexing the TLVs of the message
+in a single pass, with a typed getter per TLV. Fixed layout structures get
+compile time offsets, arrays are accessed through bounded views. Requests get
+a writer class encoding the TLVs straight into a caller supplied buffer.
+
+Fields in a format the views do not support are still reachable through a raw
+getter of the enclosing TLV.
+"""
+
+# C++ types (and sizes) of the integer formats
+INTEGER_FORMATS = {
+    'guint8'  : ('BYTE',      1),
+    'gint8'   : ('INT8',      1),
+    'guint16' : ('WORD',      2),
+    'gint16'  : ('SHORT',     2),
+    'guint32' : ('ULONG',     4),
+    'gint32'  : ('LONG',      4),
+    'guint64' : ('ULONGLONG', 8),
+    'gint64'  : ('LONGLONG',  8) }
+
+# C++ types (and sizes) of the floating point formats
+FLOAT_FORMATS = {
+    'gfloat'  : ('FLOAT',  4),
+    'gdouble' : ('DOUBLE', 8) }
+
+# Sizes of the array/string size prefix formats
+PREFIX_FORMATS = {
+    'guint8'  : 1,
+    'guint16' : 2,
+    'guint32' : 4 }
+
+# Gobi API service types (eQMIService) of the database services, requests
+# of other services are written but not built
+GOBI_SERVICES = {
+    'CTL'   : 'eQMI_SVC_CONTROL',
+    'WDS'   : 'eQMI_SVC_WDS',
+    'DMS'   : 'eQMI_SVC_DMS',
+    'NAS'   : 'eQMI_SVC_NAS',
+    'QOS'   : 'eQMI_SVC_QOS',
+    'WMS'   : 'eQMI_SVC_WMS',
+    'PDS'   : 'eQMI_SVC_PDS',
+    'VOICE' : 'eQMI_SVC_VOICE',
+    'OMA'   : 'eQMI_SVC_OMA' }
+
+# Indentation of class members
+INDENT = '      '
+
+
+class Unsupported(Exception):
+    pass
+
+
+"""
+Split a database name in words, e.g. "Tx Packets Ok" or "IMSI_11_12"
+"""
+def split_words(name):
+    return [w for w in re.split('[^A-Za-z0-9]+', name) if w != '']
+
+
+"""
+Build a (Gobi style) camel case identifier from a database name,
+e.g. "Tx Packets Ok" -> "TxPacketsOk"
+"""
+def build_identifier(name):
+    return ''.join([w[0].upper() + w[1:] for w in split_words(name)])
+
+
+"""
+Build an upper case constant name from a database name,
+e.g. "Tx Packets Ok" -> "TX_PACKETS_OK"
+"""
+def build_constant(name):
+    return '_'.join([w.upper() for w in split_words(name)])
+
+
+"""
+Build a parameter name from a database name, e.g. "Tx Packets Ok" -> "txPacketsOk"
+"""
+def build_parameter(name):
+    ident = build_identifier(name)
+    if ident == '':
+        return 'value'
+    if ident.isupper():
+        return ident.lower()
+    return ident[0].lower() + ident[1:]
+
+
+"""
+Make the names of a list of (name, ...) tuples unique by appending the index
+of any repeated name
+"""
+def unique_names(names):
+    unique = []
+    for idx, name in enumerate(names):
+        if name in unique or names.count(name) > 1:
+            name = name + str(idx + 1)
+        unique.append(name)
+    return unique
+
+
+"""
+Emit a "return <type>::Read( <args> );" statement, wrapping the arguments
+(aligned) when the statement does not fit on a line
+"""
+def emit_read(indent, type_expr, args):
+    call = indent + 'return ' + type_expr + '::Read( '
+    line = call + ', '.join(args) + ' );'
+    if len(line) < 80:
+        return line.replace('$', '$$') + '\n'
+    align = ' ' * len(call)
+    return (call + (',\n' + align).join(args) + ' );\n').replace('$', '$$')
+
+
+"""
+A field type of the views, i.e. the C++ type providing FIXED_SIZE, Measure()
+and Read() along with the type of the value read
+"""
+class CxxType:
+
+    def __init__(self, type_expr, value_type, fixed_size, scalar = None):
+        # The type providing Measure()/Read(), e.g. "sQMIInt <ULONG, 4>"
+        self.type_expr = type_expr
+        # The type of the value read, e.g. "ULONG"
+        self.value_type = value_type
+        # The compile time size of the field (0 if variable)
+        self.fixed_size = fixed_size
+        # For integer and floating point fields, the type written
+        self.scalar = scalar
+
+
+"""
+The types (and the nested type definitions) of a single message container
+"""
+class CxxContainer:
+
+    def __init__(self, scope):
+        # Scope prefix of the nested types, i.e. the container class name
+        self.scope = scope
+        # Nested type definitions, in dependency order
+        self.definitions = []
+        # Names of the nested types defined so far
+        self.type_names = []
+
+    def new_type_name(self, prefix, name):
+        type_name = prefix + build_identifier(name)
+        if type_name in self.type_names:
+            idx = 2
+            while (type_name + str(idx)) in self.type_names:
+                idx += 1
+            type_name = type_name + str(idx)
+        self.type_names.append(type_name)
+        return type_name
+
+    """
+    Build the type of a field, top-level fields are complete TLV values
+    """
+    def build_type(self, field, top_level, name):
+        fmt = field['format']
+
+        if fmt in INTEGER_FORMATS:
+            (ctype, size) = INTEGER_FORMATS[fmt]
+            big_endian = field.get('endian', 'little') in ('network', 'big')
+            if big_endian:
+                type_expr = 'sQMIInt <%s, %d, true>' % (ctype, size)
+            else:
+                type_expr = 'sQMIInt <%s, %d>' % (ctype, size)
+            return CxxType(type_expr, ctype, size, ctype)
+
+        if fmt == 'guint-sized':
+            size = int(field['guint-size'])
+            if size < 1 or size > 8:
+                raise Unsupported()
+            return CxxType('sQMIInt <ULONGLONG, %d>' % size, 'ULONGLONG', size, 'ULONGLONG')
+
+        if fmt in FLOAT_FORMATS:
+            (ctype, size) = FLOAT_FORMATS[fmt]
+            return CxxType('sQMIFloat <%s>' % ctype, ctype, size, ctype)
+
+        if fmt == 'string':
+            if 'fixed-size' in field:
+                size = int(field['fixed-size'])
+                return CxxType('sQMIFixedString <%d>' % size, 'sQMIView', size)
+            if 'size-prefix-format' in field:
+                prefix = PREFIX_FORMATS.get(field['size-prefix-format'])
+                if prefix is None:
+                    raise Unsupported()
+            elif top_level:
+                # A string making up a whole TLV has no size prefix
+                prefix = 0
+            else:
+                prefix = 1
+            return CxxType('sQMIString <%d>' % prefix, 'sQMIView', 0)
+
+        if fmt == 'array':
+            if 'sequence-prefix-format' in field:
+                raise Unsupported()
+            element = self.build_type(field['array-element'], False, name + ' Element')
+            if 'fixed-size' in field:
+                type_expr = 'cQMIArrayView <%s, 0, %d>' % (element.type_expr, int(field['fixed-size']))
+                fixed_size = element.fixed_size * int(field['fixed-size'])
+            else:
+                prefix = PREFIX_FORMATS.get(field.get('size-prefix-format', 'guint8'))
+                if prefix is None:
+                    raise Unsupported()
+                type_expr = 'cQMIArrayView <%s, %d>' % (element.type_expr, prefix)
+                fixed_size = 0
+
+            type_name = self.new_type_name('t', name)
+            self.definitions.append(
+                INDENT + '// Array view of ' + name + '\n' +
+                INDENT + 'typedef ' + type_expr + ' ' + type_name + ';\n')
+            return CxxType(type_name, type_name, fixed_size)
+
+        if fmt == 'sequence' or fmt == 'struct':
+            members = []
+            names = unique_names([build_identifier(m['name']) for m in field['contents']])
+            for idx, member in enumerate(field['contents']):
+                member_type = self.build_type(member, False, name + ' ' + member['name'])
+                members.append((names[idx], member['name'], member_type))
+
+            type_name = self.new_type_name('s', name)
+            self.definitions.append(self.emit_struct(type_name, name, members))
+
+            fixed_size = 0
+            if all(m[2].fixed_size != 0 for m in members):
+                fixed_size = sum(m[2].fixed_size for m in members)
+            struct_type = CxxType(type_name, type_name, fixed_size)
+            struct_type.members = members
+            return struct_type
+
+        raise Unsupported()
+
+    """
+    Emit the view of a structure (a sequence TLV or a struct)
+    """
+    def emit_struct(self, type_name, name, members):
+        fixed = all(m[2].fixed_size != 0 for m in members)
+
+        # Offsets are compile time constants up to the first variable field
+        offsets = []
+        offset = 0
+        for (ident, member_name, member_type) in members:
+            offsets.append(offset)
+            if offset is not None and member_type.fixed_size != 0:
+                offset += member_type.fixed_size
+            else:
+                offset = None
+
+        translations = { 'type'   : type_name,
+                         'name'   : name,
+                         'indent' : INDENT }
+
+        template = (
+            '${indent}/*=================================================================*/\n'
+            '${indent}// Struct ${type} (${name})\n'
+            '${indent}/*=================================================================*/\n'
+            '${indent}struct ${type}\n'
+            '${indent}{\n'
+            '${indent}   public:\n')
+
+        offset_constants = []
+        for idx, (ident, member_name, member_type) in enumerate(members):
+            if offsets[idx] is not None:
+                offset_constants.append('OFFSET_%s = %d' % (build_constant(member_name), offsets[idx]))
+
+        if fixed:
+            template += (
+                '${indent}      // Compile time size/offsets of the fields\n'
+                '${indent}      enum { FIXED_SIZE = %d };\n' % sum(m[2].fixed_size for m in members))
+        else:
+            template += (
+                '${indent}      // Compile time size (variable)/offsets of the fields\n'
+                '${indent}      enum { FIXED_SIZE = 0 };\n')
+
+        if len(offset_constants) > 0:
+            template += '${indent}      enum\n${indent}      {\n'
+            template += ',\n'.join(['${indent}         ' + c for c in offset_constants]) + '\n'
+            template += '${indent}      };\n'
+
+        template += (
+            '\n'
+            '${indent}      // Type of value read\n'
+            '${indent}      typedef ${type} tValue;\n'
+            '\n'
+            '${indent}      // (Inline) Default constructor (results in invalid object)\n'
+            '${indent}      ${type}()\n'
+            '${indent}         :  mView()\n'
+            '${indent}      {\n'
+            '${indent}         // Nothing to do\n'
+            '${indent}      };\n'
+            '\n'
+            '${indent}      // (Inline) Parameter constructor\n'
+            '${indent}      ${type}( const sQMIView & view )\n'
+            '${indent}         :  mView( view )\n'
+            '${indent}      {\n'
+            '${indent}         // Nothing to do\n'
+            '${indent}      };\n'
+            '\n'
+            '${indent}      // (Inline) Is this object valid?\n'
+            '${indent}      bool IsValid() const\n'
+            '${indent}      {\n'
+            '${indent}         return mView.IsValid();\n'
+            '${indent}      };\n'
+            '\n'
+            '${indent}      // (Inline) Measure the structure at the given offset\n'
+            '${indent}      static bool Measure(\n'
+            '${indent}         const sQMIView &           in,\n'
+            '${indent}         ULONG                      offset,\n'
+            '${indent}         ULONG &                    sz )\n'
+            '${indent}      {\n')
+
+        if fixed:
+            template += (
+                '${indent}         sz = (ULONG)FIXED_SIZE;\n'
+                '${indent}         return in.Has( offset, sz );\n')
+        else:
+            template += (
+                '${indent}         sz = 0;\n'
+                '\n'
+                '${indent}         ULONG start = offset;\n'
+                '${indent}         ULONG fieldSz = 0;\n')
+            run = 0
+            for (ident, member_name, member_type) in members:
+                if member_type.fixed_size != 0:
+                    run += member_type.fixed_size
+                    continue
+                if run > 0:
+                    template += '${indent}         offset += %d;\n' % run
+                    run = 0
+                template += (
+                    '${indent}         if (%s::Measure( in, offset, fieldSz ) == false)\n'
+                    '${indent}         {\n'
+                    '${indent}            return false;\n'
+                    '${indent}         }\n'
+                    '\n'
+                    '${indent}         offset += fieldSz;\n') % member_type.type_expr
+            if run > 0:
+                template += '${indent}         offset += %d;\n' % run
+            template += (
+                '\n'
+                '${indent}         sz = offset - start;\n'
+                '${indent}         return in.Has( start, sz );\n')
+
+        template += (
+            '${indent}      };\n'
+            '\n'
+            '${indent}      // (Inline) Read the structure at the given offset\n'
+            '${indent}      static bool Read(\n'
+            '${indent}         const sQMIView &           in,\n'
+            '${indent}         ULONG                      offset,\n'
+            '${indent}         tValue &                   value )\n'
+            '${indent}      {\n'
+            '${indent}         ULONG sz = 0;\n'
+            '${indent}         if (Measure( in, offset, sz ) == false)\n'
+            '${indent}         {\n'
+            '${indent}            return false;\n'
+            '${indent}         }\n'
+            '\n'
+            '${indent}         value = tValue( in.Sub( offset, sz ) );\n'
+            '${indent}         return true;\n'
+            '${indent}      };\n')
+
+        for idx, (ident, member_name, member_type) in enumerate(members):
+            template += (
+                '\n'
+                '${indent}      // (Inline) Return ' + member_name + '\n'
+                '${indent}      bool Get' + ident + '( ' + member_type.value_type + ' & value ) const\n'
+                '${indent}      {\n')
+            if offsets[idx] is not None:
+                template += emit_read(INDENT + '         ',
+                                      member_type.type_expr,
+                                      ['mView', 'OFFSET_' + build_constant(member_name), 'value'])
+            else:
+                # Walk from the first variable field
+                first = offsets.index(None) - 1
+                template += (
+                    '${indent}         ULONG offset = OFFSET_' + build_constant(members[first][1]) + ';\n'
+                    '${indent}         ULONG fieldSz = 0;\n')
+                run = 0
+                for prior in members[first:idx]:
+                    if prior[2].fixed_size != 0:
+                        run += prior[2].fixed_size
+                        continue
+                    if run > 0:
+                        template += '${indent}         offset += %d;\n' % run
+                        run = 0
+                    template += (
+                        '\n'
+                        '${indent}         if (%s::Measure( mView, offset, fieldSz ) == false)\n'
+                        '${indent}         {\n'
+                        '${indent}            return false;\n'
+                        '${indent}         }\n'
+                        '\n'
+                        '${indent}         offset += fieldSz;\n') % prior[2].type_expr
+                if run > 0:
+                    template += '${indent}         offset += %d;\n' % run
+                template += '\n' + emit_read(INDENT + '         ',
+                                             member_type.type_expr,
+                                             ['mView', 'offset', 'value'])
+            template += '${indent}      };\n'
+
+        template += (
+            '\n'
+            '${indent}   protected:\n'
+            '${indent}      /* Viewed structure */\n'
+            '${indent}      sQMIView mView;\n'
+            '${indent}};\n')
+
+        return string.Template(template).substitute(translations)
+
+
+"""
+A single message (request/response pair or indication) of the collection
+"""
+class CxxMessage:
+
+    def __init__(self, dictionary, common_objects_dictionary):
+        self.service = dictionary['service']
+        self.name = dictionary['name']
+        self.id = int(dictionary['id'], 0)
+        self.type = dictionary['type']
+
+        prefix = 'Qmi ' + self.type
+        self.fullname = prefix + ' ' + self.service + ' ' + self.name
+        self.id_enum_name = utils.build_underscore_name(self.fullname).upper()
+
+        base = self.service.upper() + build_identifier(self.name)
+        if self.type == 'Message':
+            self.view_name = 'cQMIView' + base + 'Rsp'
+            self.writer_name = 'cQMIWriter' + base + 'Req'
+        else:
+            self.view_name = 'cQMIView' + base + 'Ind'
+            self.writer_name = None
+
+        self.output = self.resolve(dictionary.get('output', []), common_objects_dictionary)
+        self.input = self.resolve(dictionary.get('input', []), common_objects_dictionary)
+
+    """
+    Replace references to common types with the common types themselves
+    """
+    def resolve(self, fields, common_objects_dictionary):
+        resolved = []
+        for field in fields:
+            if 'common-ref' in field:
+                for common in common_objects_dictionary:
+                    if common['type'] == 'TLV' and common['common-ref'] == field['common-ref']:
+                        resolved.append(common)
+                        break
+                else:
+                    raise RuntimeError('Common type \'%s\' not found' % field['common-ref'])
+            else:
+                resolved.append(field)
+        return [f for f in resolved if f['type'] == 'TLV']
+
+    """
+    Build the types of the TLVs of a container, returns the container and the
+    (TLV, identifier, type) list, type being None for unsupported TLVs
+    """
+    def build_tlvs(self, scope, fields):
+        container = CxxContainer(scope)
+        tlvs = []
+        names = unique_names([build_identifier(f['name']) for f in fields])
+        for idx, field in enumerate(fields):
+            definitions = len(container.definitions)
+            try:
+                tlv_type = container.build_type(field, True, field['name'])
+            except Unsupported:
+                # Drop any definitions emitted for the unsupported TLV
+                del container.definitions[definitions:]
+                tlv_type = None
+            tlvs.append((field, names[idx], tlv_type))
+        return (container, tlvs)
+
+    def emit_view(self, f):
+        (container, tlvs) = self.build_tlvs(self.view_name, self.output)
+
+        translations = { 'view'    : self.view_name,
+                         'name'    : self.service + ' ' + self.name,
+                         'kind'    : 'response' if self.type == 'Message' else 'indication',
+                         'count'   : str(max(len(tlvs), 1)),
+                         'id'      : '0x%04X' % self.id,
+                         'indent'  : INDENT }
+
+        template = (
+            '\n'
+            '/*=========================================================================*/\n'
+            '// Class ${view}\n'
+            '//    View of the ${name} ${kind}\n'
+            '/*=========================================================================*/\n'
+            'class ${view} : public cQMIMessageView <${view}, ${count}>\n'
+            '{\n'
+            '   public:\n'
+            '${indent}// Message ID\n'
+            '${indent}enum { MESSAGE_ID = ${id} };\n')
+
+        if len(tlvs) > 0:
+            template += (
+                '\n'
+                '${indent}// TLV type IDs\n'
+                '${indent}enum\n'
+                '${indent}{\n')
+            template += ',\n'.join(['${indent}   TLV_%s = 0x%02X' % (build_constant(t[0]['name']), int(t[0]['id'], 0))
+                                    for t in tlvs]) + '\n'
+            template += '${indent}};\n'
+
+        for definition in container.definitions:
+            template += '\n' + definition.replace('$', '$$')
+
+        template += (
+            '\n'
+            '${indent}// (Inline) Constructor (from the TLVs of the message)\n'
+            '${indent}${view}(\n'
+            '${indent}   const BYTE *               pTLVs,\n'
+            '${indent}   ULONG                      sz )\n'
+            '${indent}   :  cQMIMessageView <${view}, ${count}>( pTLVs, sz )\n'
+            '${indent}{\n'
+            '${indent}   // Nothing to do\n'
+            '${indent}};\n'
+            '\n'
+            '${indent}// (Inline) Constructor (from a QMI service ${kind})\n'
+            '${indent}${view}( const sProtocolBuffer & buf )\n'
+            '${indent}   :  cQMIMessageView <${view}, ${count}>( buf )\n'
+            '${indent}{\n'
+            '${indent}   // Nothing to do\n'
+            '${indent}};\n'
+            '\n'
+            '${indent}// (Inline) Map a TLV type ID to its slot (-1 if unknown)\n'
+            '${indent}static int GetSlot( BYTE typeID )\n'
+            '${indent}{\n'
+            '${indent}   switch (typeID)\n'
+            '${indent}   {\n')
+        for slot, t in enumerate(tlvs):
+            template += (
+                '${indent}      case TLV_%s:\n'
+                '${indent}         return %d;\n') % (build_constant(t[0]['name']), slot)
+        template += (
+            '${indent}   }\n'
+            '\n'
+            '${indent}   return -1;\n'
+            '${indent}};\n')
+
+        for slot, (field, ident, tlv_type) in enumerate(tlvs):
+            if tlv_type is None:
+                template += (
+                    '\n'
+                    '${indent}// (Inline) Return ' + field['name'] + ' (raw, the format is not\n'
+                    '${indent}// supported by the views)\n'
+                    '${indent}bool Get' + ident + 'Raw( sQMIView & value ) const\n'
+                    '${indent}{\n'
+                    '${indent}   value = mTLVs[%d];\n'
+                    '${indent}   return value.IsValid();\n'
+                    '${indent}};\n') % slot
+                continue
+
+            template += (
+                '\n'
+                '${indent}// (Inline) Return ' + field['name'] + '\n'
+                '${indent}bool Get' + ident + '( ' + tlv_type.value_type + ' & value ) const\n'
+                '${indent}{\n' +
+                emit_read(INDENT + '   ',
+                          tlv_type.type_expr,
+                          ['mTLVs[%d]' % slot, '0', 'value']) +
+                '${indent}};\n')
+
+            if field.get('common-ref') == 'Operation Result' and tlv_type is not None:
+                # Same contract as sQMIServiceBuffer::GetResult()
+                template += (
+                    '\n'
+                    '${indent}// (Inline) Return contents of mandatory result content\n'
+                    '${indent}bool GetResult(\n'
+                    '${indent}   ULONG &                    returnCode,\n'
+                    '${indent}   ULONG &                    errorCode ) const\n'
+                    '${indent}{\n'
+                    '${indent}   ' + tlv_type.value_type + ' result;\n'
+                    '${indent}   WORD rc = 0;\n'
+                    '${indent}   WORD ec = 0;\n'
+                    '${indent}   if ( (Get' + ident + '( result ) == false)\n'
+                    '${indent}   ||   (result.GetErrorStatus( rc ) == false)\n'
+                    '${indent}   ||   (result.GetErrorCode( ec ) == false) )\n'
+                    '${indent}   {\n'
+                    '${indent}      return false;\n'
+                    '${indent}   }\n'
+                    '\n'
+                    '${indent}   returnCode = (ULONG)rc;\n'
+                    '${indent}   errorCode = (ULONG)ec;\n'
+                    '${indent}   return true;\n'
+                    '${indent}};\n')
+
+        template += '};\n'
+        f.write(string.Template(template).substitute(translations))
+
+    def emit_writer(self, f):
+        (container, tlvs) = self.build_tlvs(self.writer_name, self.input)
+
+        translations = { 'writer'  : self.writer_name,
+                         'name'    : self.service + ' ' + self.name,
+                         'service' : GOBI_SERVICES.get(self.service.upper()),
+                         'id'      : '0x%04X' % self.id,
+                         'indent'  : INDENT }
+
+        template = (
+            '\n'
+            '/*=========================================================================*/\n'
+            '// Class ${writer}\n'
+            '//    Writer of the ${name} request\n'
+            '/*=========================================================================*/\n'
+            'class ${writer} : public cQMIMessageWriter\n'
+            '{\n'
+            '   public:\n'
+            '${indent}// Message ID\n'
+            '${indent}enum { MESSAGE_ID = ${id} };\n')
+
+        if len(tlvs) > 0:
+            template += (
+                '\n'
+                '${indent}// TLV type IDs\n'
+                '${indent}enum\n'
+                '${indent}{\n')
+            template += ',\n'.join(['${indent}   TLV_%s = 0x%02X' % (build_constant(t[0]['name']), int(t[0]['id'], 0))
+                                    for t in tlvs]) + '\n'
+            template += '${indent}};\n'
+
+        template += (
+            '\n'
+            '${indent}// (Inline) Constructor\n'
+            '${indent}${writer}(\n'
+            '${indent}   BYTE *                     pBuffer,\n'
+            '${indent}   ULONG                      sz )\n'
+            '${indent}   :  cQMIMessageWriter( pBuffer, sz )\n'
+            '${indent}{\n'
+            '${indent}   // Nothing to do\n'
+            '${indent}};\n')
+
+        if translations['service'] is not None:
+            template += (
+                '\n'
+                '${indent}// (Inline) Build the QMI request from the encoded TLVs\n'
+                '${indent}sSharedBuffer * BuildRequest() const\n'
+                '${indent}{\n'
+                '${indent}   return cQMIMessageWriter::BuildRequest( ${service},\n'
+                '${indent}                                          (WORD)MESSAGE_ID );\n'
+                '${indent}};\n')
+
+        for (field, ident, tlv_type) in tlvs:
+            constant = 'TLV_' + build_constant(field['name'])
+            if tlv_type is not None and tlv_type.scalar is not None:
+                template += (
+                    '\n'
+                    '${indent}// (Inline) Set ' + field['name'] + '\n'
+                    '${indent}bool Set' + ident + '( ' + tlv_type.scalar + ' value )\n'
+                    '${indent}{\n'
+                    '${indent}   BYTE * pValue = AddTLV( (BYTE)' + constant + ', %d );\n'
+                    '${indent}   if (pValue == 0)\n'
+                    '${indent}   {\n'
+                    '${indent}      return false;\n'
+                    '${indent}   }\n'
+                    '\n'
+                    '${indent}   ' + tlv_type.type_expr + '::Write( pValue, value );\n'
+                    '${indent}   return true;\n'
+                    '${indent}};\n') % tlv_type.fixed_size
+            elif tlv_type is not None and tlv_type.fixed_size != 0 and \
+                 hasattr(tlv_type, 'members') and \
+                 all(m[2].scalar is not None for m in tlv_type.members):
+                params = unique_names([build_parameter(m[1]) for m in tlv_type.members])
+                template += (
+                    '\n'
+                    '${indent}// (Inline) Set ' + field['name'] + '\n'
+                    '${indent}bool Set' + ident + '(\n')
+                template += ',\n'.join(['${indent}   %-26s %s' % (m[2].scalar, params[i])
+                                        for i, m in enumerate(tlv_type.members)]) + ' )\n'
+                template += (
+                    '${indent}{\n'
+                    '${indent}   BYTE * pValue = AddTLV( (BYTE)' + constant + ', %d );\n'
+                    '${indent}   if (pValue == 0)\n'
+                    '${indent}   {\n'
+                    '${indent}      return false;\n'
+                    '${indent}   }\n'
+                    '\n') % tlv_type.fixed_size
+                offset = 0
+                for i, m in enumerate(tlv_type.members):
+                    template += '${indent}   %s::Write( pValue + %d, %s );\n' % (m[2].type_expr, offset, params[i])
+                    offset += m[2].fixed_size
+                template += (
+                    '${indent}   return true;\n'
+                    '${indent}};\n')
+            elif tlv_type is not None and tlv_type.type_expr == 'sQMIString <0>':
+                template += (
+                    '\n'
+                    '${indent}// (Inline) Set ' + field['name'] + '\n'
+                    '${indent}bool Set' + ident + '( const std::string & value )\n'
+                    '${indent}{\n'
+                    '${indent}   return AddTLV( (BYTE)' + constant + ',\n'
+                    '${indent}                  (const BYTE *)value.c_str(),\n'
+                    '${indent}                  (ULONG)value.size() );\n'
+                    '${indent}};\n')
+            else:
+                template += (
+                    '\n'
+                    '${indent}// NOTE: ' + field['name'] + ' is not supported by the writer, use\n'
+                    '${indent}// AddTLV( ' + constant + ', pValue, len ) with the encoded value\n')
+
+        template += '};\n'
+        f.write(string.Template(template).substitute(translations))
+
+    def emit(self, f):
+        if self.type == 'Message':
+            self.emit_writer(f)
+        self.emit_view(f)
+
+
+"""
+Emit the views of the messages in the collection (all messages if None)
+"""
+def emit(f, output_name, input_name, collection, objects_dictionary, common_objects_dictionary):
+    messages = []
+    service = None
+    for dictionary in objects_dictionary:
+        if dictionary['type'] == 'Service':
+            service = dictionary['name']
+        elif dictionary['type'] == 'Message' or dictionary['type'] == 'Indication':
+            message = CxxMessage(dictionary, common_objects_dictionary)
+            if collection is None or message.id_enum_name in collection:
+                messages.append(message)
+
+    if service is None:
+        raise ValueError('Missing Service field')
+
+    classes = ''
+    for message in messages:
+        if message.writer_name is not None:
+            classes += '   ' + message.writer_name + '\n'
+        classes += '   ' + message.view_name + '\n'
+
+    translations = { 'output'  : output_name,
+                     'input'   : input_name,
+                     'service' : service.upper(),
+                     'classes' : classes }
+
+    template = (
+        '/*===========================================================================\n'
+        'FILE:\n'
+        '   ${output}.h\n'
+        '\n'
+        'DESCRIPTION:\n'
+        '   Static views of the (collected) QMI ${service} messages\n'
+        '\n'
+        'PUBLIC CLASSES AND METHODS:\n'
+        '${classes}'
+        '\n'
+        '   NOTE:\n'
+        '      Generated by build-aux/qmi-codegen from ${input}, do not\n'
+        '      edit.  To regenerate run (from the top of the source tree):\n'
+        '\n'
+        '         build-aux/qmi-codegen/qmi-codegen --cxx-views \\\n'
+        '            --input data/${input} \\\n'
+        '            --include data/qmi-common.json \\\n'
+        '            --collection data/qmi-collection-gobi-views.json \\\n'
+        '            --output <Core directory>/${output}\n'
+        '===========================================================================*/\n'
+        '\n'
+        '//---------------------------------------------------------------------------\n'
+        '// Pragmas\n'
+        '//---------------------------------------------------------------------------\n'
+        '#pragma once\n'
+        '\n'
+        '//---------------------------------------------------------------------------\n'
+        '// Include Files\n'
+        '//---------------------------------------------------------------------------\n'
+        '#include "QMIView.h"\n')
+    f.write(string.Template(template).substitute(translations))
+
+    for message in messages:
+        message.emit(f)
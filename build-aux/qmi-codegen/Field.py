@@ -67,6 +67,9 @@ class Field:
         # Create the ID enumeration name
         self.id_enum_name = utils.build_underscore_name(self.prefix + ' TLV ' + self.name).upper()
 
+        # Output Fields may be decoded only when first read, see Container.set_lazy()
+        self.lazy = False
+
         # Output Fields may have prerequisites
         self.prerequisites = []
         if 'prerequisites' in dictionary:
@@ -157,7 +160,15 @@ class Field:
             '    GError **error)\n'
             '{\n'
             '    g_return_val_if_fail (self != NULL, FALSE);\n'
-            '\n'
+            '\n')
+        if self.lazy:
+            template += (
+                '    if (!self->${variable_name}_decoded) {\n'
+                '        self->${variable_name}_decoded = TRUE;\n'
+                '        ${prefix_underscore}_decode_${underscore} (self);\n'
+                '    }\n'
+                '\n')
+        template += (
             '    if (!self->${variable_name}_set) {\n'
             '        g_set_error (error,\n'
             '                     QMI_CORE_ERROR,\n'
@@ -173,6 +184,52 @@ class Field:
         cfile.write(string.Template(template).substitute(translations))
 
 
+    """
+    Emit the method decoding a lazy output TLV from the message kept in the
+    container, on its first read
+    """
+    def emit_output_lazy_decoder(self, f):
+        translations = { 'prefix_camelcase'  : utils.build_camelcase_name(self.prefix),
+                         'prefix_underscore' : utils.build_underscore_name(self.prefix),
+                         'underscore'        : utils.build_underscore_name(self.name) }
+
+        template = (
+            '\n'
+            'static void\n'
+            '${prefix_underscore}_decode_${underscore} (${prefix_camelcase} *self)\n'
+            '{\n'
+            '    QmiMessage *message = self->message;\n'
+            '    QmiMessageTlvIndex tlv_index_storage;\n'
+            '    const QmiMessageTlvIndex *tlv_index;\n')
+        if self.variable.uses_arena():
+            template += (
+                '    QmiMessageArena arena = self->arena;\n')
+        template += (
+            '\n'
+            '    tlv_index = __qmi_message_tlv_index_get (message, &tlv_index_storage);\n'
+            '\n'
+            '    do {\n')
+        f.write(string.Template(template).substitute(translations))
+
+        self.emit_output_prerequisite_check(f, '        ')
+        f.write(
+            '\n'
+            '        {\n')
+        self.emit_output_tlv_get(f, '            ')
+        f.write(
+            '\n'
+            '        }\n'
+            '    } while (0);\n')
+
+        # Strings of the TLV were carved from the arena sized at parse time
+        if self.variable.uses_arena():
+            f.write(
+                '\n'
+                '    self->arena = arena;\n')
+        f.write(
+            '}\n')
+
+
     """
     Emit the method responsible for setting this TLV in the input/output
     container
@@ -236,6 +293,17 @@ class Field:
         cfile.write(string.Template(template).substitute(translations))
 
 
+    """
+    Maximum number of bytes the TLV takes in the raw buffer, including the TLV
+    header, or None if not bounded
+    """
+    def max_tlv_size(self):
+        variable_size = self.variable.max_buffer_size()
+        if variable_size is None:
+            return None
+        return 3 + variable_size
+
+
     """
     Emit the code responsible for adding the TLV to the QMI message
     """
@@ -305,7 +373,7 @@ class Field:
             '${lp}gsize offset = 0;\n'
             '${lp}gsize init_offset;\n'
             '\n'
-            '${lp}if ((init_offset = qmi_message_tlv_read_init (message, ${tlv_id}, NULL, ${error})) == 0) {\n')
+            '${lp}if ((init_offset = __qmi_message_tlv_index_read_init (message, tlv_index, ${tlv_id}, NULL, ${error})) == 0) {\n')
 
         if self.mandatory:
             template += (
@@ -347,7 +415,8 @@ class Field:
 
 
     """
-    Emit the method responsible for creating a printable representation of the TLV
+    Emit the method responsible for appending a printable representation of the
+    TLV to a string
     """
     def emit_tlv_helpers(self, f):
         if TypeFactory.helpers_emitted(self.fullname):
@@ -361,20 +430,18 @@ class Field:
 
         template = (
             '\n'
-            'static gchar *\n'
-            '${underscore}_get_printable (\n'
+            'static void\n'
+            '${underscore}_append_printable (\n'
             '    QmiMessage *message,\n'
-            '    const gchar *line_prefix)\n'
+            '    const gchar *line_prefix,\n'
+            '    GString *printable)\n'
             '{\n'
             '    gsize offset = 0;\n'
             '    gsize init_offset;\n'
-            '    GString *printable;\n'
             '    GError *error = NULL;\n'
             '\n'
             '    if ((init_offset = qmi_message_tlv_read_init (message, ${tlv_id}, NULL, NULL)) == 0)\n'
-            '        return NULL;\n'
-            '\n'
-            '    printable = g_string_new ("");\n')
+            '        return;\n')
         f.write(string.Template(template).substitute(translations))
 
         # Now, read the contents of the buffer into the printable representation
@@ -390,7 +457,6 @@ class Field:
             '        g_string_append_printf (printable, " ERROR: %s", error->message);\n'
             '        g_error_free (error);\n'
             '    }\n'
-            '    return g_string_free (printable, FALSE);\n'
             '}\n')
         f.write(string.Template(template).substitute(translations))
 
@@ -110,8 +110,8 @@ class FieldResult(Field):
 
 
     """
-    Emit the method responsible for getting a printable representation of this
-    TLV field.
+    Emit the method responsible for appending a printable representation of
+    this TLV field to a string.
     """
     def emit_tlv_helpers(self, f):
         if TypeFactory.helpers_emitted(self.fullname):
@@ -144,10 +144,11 @@ class FieldResult(Field):
 
         template = (
             '\n'
-            'static gchar *\n'
-            '${underscore}_get_printable (\n'
+            'static void\n'
+            '${underscore}_append_printable (\n'
             '    QmiMessage *self,\n'
-            '    const gchar *line_prefix)\n'
+            '    const gchar *line_prefix,\n'
+            '    GString *printable)\n'
             '{\n'
             '    gsize offset = 0;\n'
             '    gsize init_offset;\n'
@@ -155,17 +156,17 @@ class FieldResult(Field):
             '    guint16 error_code;\n'
             '\n'
             '    if ((init_offset = qmi_message_tlv_read_init (self, ${tlv_id}, NULL, NULL)) == 0)\n'
-            '        return NULL;\n'
+            '        return;\n'
             '    if (!qmi_message_tlv_read_guint16 (self, init_offset, &offset, QMI_ENDIAN_LITTLE, &error_status, NULL))\n'
-            '        return NULL;\n'
+            '        return;\n'
             '    if (!qmi_message_tlv_read_guint16 (self, init_offset, &offset, QMI_ENDIAN_LITTLE, &error_code, NULL))\n'
-            '        return NULL;\n'
+            '        return;\n'
             '    g_warn_if_fail (__qmi_message_tlv_read_remaining_size (self, init_offset, offset) == 0);\n'
             '\n'
             '    if (error_status == QMI_STATUS_SUCCESS)\n'
-            '        return g_strdup ("SUCCESS");\n'
-            '\n'
-            '    return g_strdup_printf ("FAILURE: %s", qmi_protocol_error_get_string ((QmiProtocolError) error_code));\n'
+            '        g_string_append (printable, "SUCCESS");\n'
+            '    else\n'
+            '        g_string_append_printf (printable, "FAILURE: %s", qmi_protocol_error_get_string ((QmiProtocolError) error_code));\n'
             '}\n')
         f.write(string.Template(template).substitute(translations))
 
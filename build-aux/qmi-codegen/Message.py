@@ -83,6 +83,11 @@ class Message:
                                 self.static,
                                 self.since)
 
+        # Output TLVs may be decoded only when read, for messages where just
+        # a few of them are usually looked at
+        if 'lazy-output' in dictionary and dictionary['lazy-output'] == 'yes':
+            self.output.set_lazy()
+
         self.input = None
         if self.type == 'Message':
             # Build input container (Request/Response only).
@@ -118,11 +123,28 @@ class Message:
             '    GError **error)\n'
             '{\n'
             '    g_autoptr(QmiMessage) self = NULL;\n'
-            '\n'
-            '    self = qmi_message_new (QMI_SERVICE_${service},\n'
-            '                            cid,\n'
-            '                            transaction_id,\n'
-            '                            ${message_id});\n' % input_arg_template)
+            '\n' % input_arg_template)
+
+        if self.input.fields:
+            # Preallocate the worst case size of all the TLVs with a bounded
+            # size; the buffer will only grow if any of the others is given
+            translations['tlvs_size'] = 0
+            for field in self.input.fields:
+                tlv_size = field.max_tlv_size()
+                if tlv_size is not None:
+                    translations['tlvs_size'] += tlv_size
+            template += (
+                '    self = qmi_message_new_sized (QMI_SERVICE_${service},\n'
+                '                                  cid,\n'
+                '                                  transaction_id,\n'
+                '                                  ${message_id},\n'
+                '                                  ${tlvs_size});\n')
+        else:
+            template += (
+                '    self = qmi_message_new (QMI_SERVICE_${service},\n'
+                '                            cid,\n'
+                '                            transaction_id,\n'
+                '                            ${message_id});\n')
         cfile.write(string.Template(template).substitute(translations))
 
         if self.input.fields:
@@ -209,14 +231,51 @@ class Message:
             '    GError **error)\n'
             '{\n'
             '    ${container} *self;\n'
+            '    QmiMessageTlvIndex tlv_index_storage;\n'
+            '    const QmiMessageTlvIndex *tlv_index;\n')
+
+        # Strings of the output are all read into an arena placed right after
+        # the output struct, in the same allocation
+        arena_fields = [field for field in self.output.fields if field.variable is not None and field.variable.uses_arena()]
+        if arena_fields:
+            template += (
+                '    QmiMessageArena arena;\n'
+                '    gsize arena_size = 0;\n')
+
+        template += (
             '\n'
             '    g_assert_cmphex (qmi_message_get_message_id (message), ==, ${message_id});\n'
             '\n'
-            '    self = g_slice_new0 (${container});\n'
-            '    self->ref_count = 1;\n')
+            '    /* Walk the TLVs just once, all fields are then looked up by type */\n'
+            '    tlv_index = __qmi_message_tlv_index_get (message, &tlv_index_storage);\n'
+            '\n')
+
+        if arena_fields:
+            template += (
+                '    /* Size the arena for all the strings, so that a single allocation holds the whole output */\n')
+            for field in arena_fields:
+                template += (
+                    '    arena_size += __qmi_message_tlv_index_arena_size (message, tlv_index, %s);\n' % field.id_enum_name)
+            template += (
+                '\n'
+                '    self = g_malloc0 (sizeof (${container}) + arena_size);\n'
+                '    self->ref_count = 1;\n'
+                '    arena.next = (gchar *)(self + 1);\n'
+                '    arena.end = arena.next + arena_size;\n')
+        else:
+            template += (
+                '    self = g_new0 (${container}, 1);\n'
+                '    self->ref_count = 1;\n')
+        if self.output.lazy:
+            template += (
+                '\n'
+                '    /* Lazy fields are decoded from the message when first read */\n'
+                '    self->message = qmi_message_ref (message);\n')
         cfile.write(string.Template(template).substitute(translations))
 
         for field in self.output.fields:
+            if field.lazy:
+                continue
             cfile.write(
                 '\n'
                 '    do {\n')
@@ -230,6 +289,11 @@ class Message:
                 '        }\n')
             cfile.write(
                 '    } while (0);\n')
+
+        if self.output.lazy and arena_fields:
+            cfile.write(
+                '\n'
+                '    self->arena = arena;\n')
         cfile.write(
             '\n'
             '    return self;\n'
@@ -237,8 +301,8 @@ class Message:
 
 
     """
-    Emit method responsible for getting a printable representation of the whole
-    request/response
+    Emit methods printing the whole request/response into a message printer,
+    one TLV at a time
     """
     def __emit_helpers(self, hfile, cfile):
         need_tlv_printable = False
@@ -265,18 +329,19 @@ class Message:
                 'struct ${type}_${underscore}_context {\n'
                 '    QmiMessage *self;\n'
                 '    const gchar *line_prefix;\n'
-                '    GString *printable;\n'
+                '    QmiMessagePrinter *printer;\n'
                 '};\n'
                 '\n'
                 'static void\n'
-                '${type}_${underscore}_get_tlv_printable (\n'
+                '${type}_${underscore}_print_tlv (\n'
                 '    guint8 type,\n'
                 '    const guint8 *value,\n'
                 '    gsize length,\n'
                 '    struct ${type}_${underscore}_context *ctx)\n'
                 '{\n'
                 '    const gchar *tlv_type_str = NULL;\n'
-                '    g_autofree gchar *translated_value = NULL;\n'
+                '    void (* append_printable) (QmiMessage *, const gchar *, GString *) = NULL;\n'
+                '    GString *printable = ctx->printer->buffer;\n'
                 '\n')
 
             if self.type == 'Message':
@@ -292,9 +357,7 @@ class Message:
                         field_template = (
                             '        case ${field_enum}:\n'
                             '            tlv_type_str = "${field_name}";\n'
-                            '            translated_value = ${underscore_field}_get_printable (\n'
-                            '                                   ctx->self,\n'
-                            '                                   ctx->line_prefix);\n'
+                            '            append_printable = ${underscore_field}_append_printable;\n'
                             '            break;\n')
                         template += string.Template(field_template).substitute(translations)
 
@@ -315,9 +378,7 @@ class Message:
                     field_template = (
                         '        case ${field_enum}:\n'
                         '            tlv_type_str = "${field_name}";\n'
-                        '            translated_value = ${underscore_field}_get_printable (\n'
-                        '                                   ctx->self,\n'
-                        '                                   ctx->line_prefix);\n'
+                        '            append_printable = ${underscore_field}_append_printable;\n'
                         '            break;\n')
                     template += string.Template(field_template).substitute(translations)
 
@@ -328,43 +389,42 @@ class Message:
                 '    }\n'
                 '\n'
                 '    if (!tlv_type_str) {\n'
-                '        g_autofree gchar *value_str = NULL;\n'
-                '\n'
-                '        value_str = qmi_message_get_tlv_printable (ctx->self,\n'
-                '                                                   ctx->line_prefix,\n'
-                '                                                   type,\n'
-                '                                                   value,\n'
-                '                                                   length);\n'
-                '        g_string_append (ctx->printable, value_str);\n'
+                '        __qmi_message_append_tlv_printable (printable,\n'
+                '                                            ctx->line_prefix,\n'
+                '                                            type,\n'
+                '                                            value,\n'
+                '                                            length);\n'
                 '    } else {\n'
-                '        g_autofree gchar *value_hex = NULL;\n'
-                '\n'
-                '        value_hex = __qmi_utils_str_hex (value, length, \':\');\n'
-                '        g_string_append_printf (ctx->printable,\n'
+                '        g_string_append_printf (printable,\n'
                 '                                "%sTLV:\\n"\n'
                 '                                "%s  type       = \\"%s\\" (0x%02x)\\n"\n'
                 '                                "%s  length     = %" G_GSIZE_FORMAT "\\n"\n'
-                '                                "%s  value      = %s\\n"\n'
-                '                                "%s  translated = %s\\n",\n'
+                '                                "%s  value      = ",\n'
                 '                                ctx->line_prefix,\n'
                 '                                ctx->line_prefix, tlv_type_str, type,\n'
                 '                                ctx->line_prefix, length,\n'
-                '                                ctx->line_prefix, value_hex,\n'
-                '                                ctx->line_prefix, translated_value ? translated_value : "");\n'
+                '                                ctx->line_prefix);\n'
+                '        __qmi_string_append_hex (printable, value, length, \':\');\n'
+                '        g_string_append (printable, "\\n");\n'
+                '        g_string_append (printable, ctx->line_prefix);\n'
+                '        g_string_append (printable, "  translated = ");\n'
+                '        append_printable (ctx->self, ctx->line_prefix, printable);\n'
+                '        g_string_append_c (printable, \'\\n\');\n'
                 '    }\n'
+                '\n'
+                '    /* Hand over each TLV as soon as it is printed */\n'
+                '    __qmi_message_printer_flush (ctx->printer);\n'
                 '}\n')
 
         template += (
             '\n'
-            'static gchar *\n'
-            '${type}_${underscore}_get_printable (\n'
+            'static void\n'
+            '${type}_${underscore}_print (\n'
             '    QmiMessage *self,\n'
-            '    const gchar *line_prefix)\n'
+            '    const gchar *line_prefix,\n'
+            '    QmiMessagePrinter *printer)\n'
             '{\n'
-            '    GString *printable;\n'
-            '\n'
-            '    printable = g_string_new ("");\n'
-            '    g_string_append_printf (printable,\n'
+            '    g_string_append_printf (printer->buffer,\n'
             '                            "%s  message     = \\\"${name}\\\" (${id})\\n",\n'
             '                            line_prefix);\n')
 
@@ -375,14 +435,12 @@ class Message:
                 '        struct ${type}_${underscore}_context ctx;\n'
                 '        ctx.self = self;\n'
                 '        ctx.line_prefix = line_prefix;\n'
-                '        ctx.printable = printable;\n'
+                '        ctx.printer = printer;\n'
                 '        qmi_message_foreach_raw_tlv (self,\n'
-                '                                     (QmiMessageForeachRawTlvFn)${type}_${underscore}_get_tlv_printable,\n'
+                '                                     (QmiMessageForeachRawTlvFn)${type}_${underscore}_print_tlv,\n'
                 '                                     &ctx);\n'
                 '    }\n')
         template += (
-            '\n'
-            '    return g_string_free (printable, FALSE);\n'
             '}\n')
         cfile.write(string.Template(template).substitute(translations))
 
@@ -390,7 +448,7 @@ class Message:
     """
     Emit request/response/indication handling implementation
     """
-    def emit(self, hfile, cfile):
+    def emit(self, hfile, cfile, printable=True):
         if self.type == 'Message':
             utils.add_separator(hfile, 'REQUEST/RESPONSE', self.fullname);
             utils.add_separator(cfile, 'REQUEST/RESPONSE', self.fullname);
@@ -407,7 +465,8 @@ class Message:
         hfile.write('\n/* --- Output -- */\n');
         cfile.write('\n/* --- Output -- */\n');
         self.output.emit(hfile, cfile)
-        self.__emit_helpers(hfile, cfile)
+        if printable:
+            self.__emit_helpers(hfile, cfile)
         self.__emit_response_or_indication_parser(hfile, cfile)
 
     """
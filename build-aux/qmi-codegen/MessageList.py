@@ -142,10 +142,9 @@ class MessageList:
 
 
     """
-    Emit the method responsible for getting a printable representation of all
-    messages of a given service.
+    Emit the method responsible for printing any message of a given service.
     """
-    def __emit_get_printable(self, hfile, cfile):
+    def __emit_print(self, hfile, cfile, printable):
         translations = { 'service'    : self.service.lower() }
 
         template = (
@@ -153,22 +152,40 @@ class MessageList:
             '#if defined (LIBQMI_GLIB_COMPILATION)\n'
             '\n'
             'G_GNUC_INTERNAL\n'
-            'gchar *__qmi_message_${service}_get_printable (\n'
+            'gboolean __qmi_message_${service}_print (\n'
             '    QmiMessage *self,\n'
             '    QmiMessageContext *context,\n'
-            '    const gchar *line_prefix);\n'
+            '    const gchar *line_prefix,\n'
+            '    QmiMessagePrinter *printer);\n'
             '\n'
             '#endif\n'
             '\n')
         hfile.write(string.Template(template).substitute(translations))
 
+        # Without per-message printable support, the generic TLV dump is used
+        if not printable:
+            template = (
+                '\n'
+                'gboolean\n'
+                '__qmi_message_${service}_print (\n'
+                '    QmiMessage *self,\n'
+                '    QmiMessageContext *context,\n'
+                '    const gchar *line_prefix,\n'
+                '    QmiMessagePrinter *printer)\n'
+                '{\n'
+                '    return FALSE;\n'
+                '}\n')
+            cfile.write(string.Template(template).substitute(translations))
+            return
+
         template = (
             '\n'
-            'gchar *\n'
-            '__qmi_message_${service}_get_printable (\n'
+            'gboolean\n'
+            '__qmi_message_${service}_print (\n'
             '    QmiMessage *self,\n'
             '    QmiMessageContext *context,\n'
-            '    const gchar *line_prefix)\n'
+            '    const gchar *line_prefix,\n'
+            '    QmiMessagePrinter *printer)\n'
             '{\n'
             '    if (qmi_message_is_indication (self)) {\n'
             '        switch (qmi_message_get_message_id (self)) {\n')
@@ -178,12 +195,13 @@ class MessageList:
             translations['message_underscore'] = utils.build_underscore_name (message.name)
             inner_template = (
                 '        case ${enum_name}:\n'
-                '            return indication_${message_underscore}_get_printable (self, line_prefix);\n')
+                '            indication_${message_underscore}_print (self, line_prefix, printer);\n'
+                '            return TRUE;\n')
             template += string.Template(inner_template).substitute(translations)
 
         template += (
             '        default:\n'
-            '             return NULL;\n'
+            '             return FALSE;\n'
             '        }\n'
             '    } else {\n'
             '        guint16 vendor_id;\n'
@@ -198,12 +216,13 @@ class MessageList:
                 translations['message_underscore'] = utils.build_underscore_name (message.name)
                 inner_template = (
                     '            case ${enum_name}:\n'
-                    '                return message_${message_underscore}_get_printable (self, line_prefix);\n')
+                    '                message_${message_underscore}_print (self, line_prefix, printer);\n'
+                    '                return TRUE;\n')
                 template += string.Template(inner_template).substitute(translations)
 
         template += (
             '             default:\n'
-            '                 return NULL;\n'
+            '                 return FALSE;\n'
             '            }\n'
             '        } else {\n')
 
@@ -213,12 +232,14 @@ class MessageList:
                 translations['message_underscore'] = utils.build_underscore_name (message.name)
                 translations['message_vendor'] = message.vendor
                 inner_template = (
-                    '            if (vendor_id == ${message_vendor} && (qmi_message_get_message_id (self) == ${enum_name}))\n'
-                    '                return message_${message_underscore}_get_printable (self, line_prefix);\n')
+                    '            if (vendor_id == ${message_vendor} && (qmi_message_get_message_id (self) == ${enum_name})) {\n'
+                    '                message_${message_underscore}_print (self, line_prefix, printer);\n'
+                    '                return TRUE;\n'
+                    '            }\n')
                 template += string.Template(inner_template).substitute(translations)
 
         template += (
-            '            return NULL;\n'
+            '            return FALSE;\n'
             '        }\n'
             '    }\n'
             '}\n')
@@ -298,7 +319,7 @@ class MessageList:
     """
     Emit the message list handling implementation
     """
-    def emit(self, hfile, cfile):
+    def emit(self, hfile, cfile, printable=True):
         # Always write build symbols, even for unsupported messages
         self.__emit_message_build_symbols(hfile)
 
@@ -313,14 +334,14 @@ class MessageList:
 
         # Then, emit all message handlers
         for message in self.indication_list:
-            message.emit(hfile, cfile)
+            message.emit(hfile, cfile, printable)
         for message in self.request_list:
-            message.emit(hfile, cfile)
+            message.emit(hfile, cfile, printable)
 
         # First, emit common class code
         utils.add_separator(hfile, 'Service-specific utils', self.service);
         utils.add_separator(cfile, 'Service-specific utils', self.service);
-        self.__emit_get_printable(hfile, cfile)
+        self.__emit_print(hfile, cfile, printable)
         self.__emit_is_abortable(hfile, cfile)
 
     """
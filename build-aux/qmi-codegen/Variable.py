@@ -166,6 +166,27 @@ class Variable:
     def add_sections(self, sections):
         pass
 
+    """
+    Maximum number of bytes the variable may take in the raw buffer, or None
+    if not bounded
+    """
+    def max_buffer_size(self):
+        return None
+
+    """
+    Size in bytes of each element if an array of this variable can be read
+    from the raw buffer in a single bulk copy, or 0 otherwise
+    """
+    def bulk_read_size(self):
+        return 0
+
+    """
+    Whether reading the variable into an Output container takes room from the
+    container arena
+    """
+    def uses_arena(self):
+        return False
+
     """
     Flag as being public
     """
@@ -131,20 +131,26 @@ class VariableArray(Variable):
 
     """
     Reading an array from the raw byte buffer is just about providing a loop to
-    read every array element one by one.
+    read every array element one by one. Arrays of plain integers are instead
+    read in one go, with a single bounds check.
     """
     def emit_buffer_read(self, f, line_prefix, tlv_out, error, variable_name):
         common_var_prefix = utils.build_underscore_name(self.name)
+        bulk_read_size = self.array_element.bulk_read_size()
         translations = { 'lp'                          : line_prefix,
+                         'tlv_out'                     : tlv_out,
+                         'error'                       : error,
                          'variable_name'               : variable_name,
                          'private_format'              : self.private_format,
                          'public_array_element_format' : self.array_element.public_format,
                          'underscore'                  : self.clear_func_name(),
+                         'endian'                      : self.array_element.endian,
+                         'bulk_read_size'              : bulk_read_size,
                          'common_var_prefix'           : common_var_prefix }
 
-        template = (
-            '${lp}{\n'
-            '${lp}    guint ${common_var_prefix}_i;\n')
+        template = '${lp}{\n'
+        if not bulk_read_size:
+            template += '${lp}    guint ${common_var_prefix}_i;\n'
         f.write(string.Template(template).substitute(translations))
 
         if self.fixed_size:
@@ -191,6 +197,15 @@ class VariableArray(Variable):
             '${lp}        (guint)${common_var_prefix}_n_items);\n'
             '\n')
 
+        if bulk_read_size:
+            template += (
+                '${lp}    g_array_set_size (${variable_name}, (guint)${common_var_prefix}_n_items);\n'
+                '${lp}    if (!__qmi_message_tlv_read_integer_array (message, init_offset, &offset, ${common_var_prefix}_n_items, ${bulk_read_size}, ${endian}, ${variable_name}->data, ${error}))\n'
+                '${lp}        goto ${tlv_out};\n'
+                '${lp}}\n')
+            f.write(string.Template(template).substitute(translations))
+            return
+
         if self.array_element.needs_dispose == True:
             template += (
                 '${lp}    g_array_set_clear_func (${variable_name},\n'
@@ -212,6 +227,29 @@ class VariableArray(Variable):
         f.write(string.Template(template).substitute(translations))
 
 
+    """
+    Maximum number of bytes the array takes in the raw buffer; only fixed-size
+    arrays are bounded
+    """
+    def max_buffer_size(self):
+        if self.fixed_size == 0:
+            return None
+        element_size = self.array_element.max_buffer_size()
+        if element_size is None:
+            return None
+        size = int(self.fixed_size) * element_size
+        if self.array_sequence_element != '':
+            size += self.array_sequence_element.max_buffer_size()
+        return size
+
+
+    """
+    The array itself is a GArray, only its elements may be in the arena
+    """
+    def uses_arena(self):
+        return self.array_element.uses_arena()
+
+
     """
     Writing an array to the raw byte buffer is just about providing a loop to
     write every array element one by one.
@@ -301,7 +339,9 @@ class VariableArray(Variable):
                 self.array_sequence_element.emit_buffer_read(f, line_prefix + '    ', 'out', '&error', common_var_prefix + '_sequence')
                 template = (
                     '\n'
-                    '${lp}    g_string_append_printf (printable, "[[Seq:%u]] ", ${common_var_prefix}_sequence);\n')
+                    '${lp}    g_string_append (printable, "[[Seq:");\n'
+                    '${lp}    __qmi_string_append_uint (printable, (guint64)${common_var_prefix}_sequence);\n'
+                    '${lp}    g_string_append (printable, "]] ");\n')
                 f.write(string.Template(template).substitute(translations))
 
         template = (
@@ -309,7 +349,9 @@ class VariableArray(Variable):
             '${lp}    g_string_append (printable, "{");\n'
             '\n'
             '${lp}    for (${common_var_prefix}_i = 0; ${common_var_prefix}_i < ${common_var_prefix}_n_items; ${common_var_prefix}_i++) {\n'
-            '${lp}        g_string_append_printf (printable, " [%u] = \'", ${common_var_prefix}_i);\n')
+            '${lp}        g_string_append (printable, " [");\n'
+            '${lp}        __qmi_string_append_uint (printable, (guint64)${common_var_prefix}_i);\n'
+            '${lp}        g_string_append (printable, "] = \'");\n')
         f.write(string.Template(template).substitute(translations))
 
         self.array_element.emit_get_printable(f, line_prefix + '        ');
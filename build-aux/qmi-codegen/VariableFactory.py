@@ -36,7 +36,7 @@ def create_variable(dictionary, new_type_name, container_type):
     elif utils.format_is_float(dictionary['format']):
         return VariableInteger(dictionary)
     elif dictionary['format'] == 'string':
-        return VariableString(dictionary)
+        return VariableString(dictionary, container_type)
     elif dictionary['format'] == 'struct':
         return VariableStruct(dictionary, new_type_name, container_type)
     elif dictionary['format'] == 'sequence':
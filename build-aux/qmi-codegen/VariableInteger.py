@@ -96,6 +96,18 @@ class VariableInteger(Variable):
         f.write(string.Template(template).substitute(translations))
 
 
+    """
+    Fixed-size integers exposed in their own format have the same layout in
+    the GArray as in the buffer, modulo endianness
+    """
+    def bulk_read_size(self):
+        if self.format not in ('guint8', 'gint8', 'guint16', 'gint16', 'guint32', 'gint32', 'guint64', 'gint64'):
+            return 0
+        if self.private_format != self.public_format:
+            return 0
+        return VariableInteger.fixed_type_byte_size(self.format)
+
+
     """
     Return the data type size of fixed c-types
     """
@@ -119,6 +131,19 @@ class VariableInteger(Variable):
             return 8
         raise Exception("Unsupported format %s" % (fmt))
 
+    """
+    Maximum number of bytes the integer takes in the raw buffer
+    """
+    def max_buffer_size(self):
+        if self.format == 'guint-sized':
+            return int(self.guint_sized_size)
+        if self.format == 'gfloat':
+            return 4
+        if self.format == 'gdouble':
+            return 8
+        return self.fixed_type_byte_size(self.format)
+
+
     """
     Write a single integer to the raw byte buffer
     """
@@ -168,26 +193,18 @@ class VariableInteger(Variable):
     """
     def emit_get_printable(self, f, line_prefix):
         common_format = ''
+        common_append = ''
         common_cast = ''
 
-        if self.private_format == 'guint8':
-            common_format = '%u'
-            common_cast = '(guint)'
-        elif self.private_format == 'guint16':
-            common_format = '%" G_GUINT16_FORMAT "'
-        elif self.private_format == 'guint32':
-            common_format = '%" G_GUINT32_FORMAT "'
-        elif self.private_format == 'guint64':
-            common_format = '%" G_GUINT64_FORMAT "'
-        elif self.private_format == 'gint8':
-            common_format = '%d'
-            common_cast = '(gint)'
-        elif self.private_format == 'gint16':
-            common_format = '%" G_GINT16_FORMAT "'
-        elif self.private_format == 'gint32':
-            common_format = '%" G_GINT32_FORMAT "'
-        elif self.private_format == 'gint64':
-            common_format = '%" G_GINT64_FORMAT "'
+        # Integers are printed through the internal decimal conversion helpers
+        # instead of printf-family calls, as printables are built for every
+        # message when tracing
+        if self.private_format in ('guint8', 'guint16', 'guint32', 'guint64'):
+            common_append = '__qmi_string_append_uint'
+            common_cast = '(guint64)'
+        elif self.private_format in ('gint8', 'gint16', 'gint32', 'gint64'):
+            common_append = '__qmi_string_append_int'
+            common_cast = '(gint64)'
         elif self.private_format in ('gfloat', 'gdouble'):
             common_format = '%lf'
             common_cast = '(gdouble)'
@@ -197,6 +214,7 @@ class VariableInteger(Variable):
                          'public_format'  : self.public_format,
                          'len'            : self.guint_sized_size,
                          'common_format'  : common_format,
+                         'common_append'  : common_append,
                          'common_cast'    : common_cast }
 
         if self.private_format not in ('guint8', 'gint8'):
@@ -225,23 +243,31 @@ class VariableInteger(Variable):
 
         if self.public_format == 'gboolean':
             template += (
-                '${lp}    g_string_append_printf (printable, "%s", tmp ? "yes" : "no");\n')
+                '${lp}    g_string_append (printable, tmp ? "yes" : "no");\n')
         elif self.public_format != self.private_format:
             translations['public_type_underscore'] = utils.build_underscore_name_from_camelcase(self.public_format)
             translations['public_type_underscore_upper'] = utils.build_underscore_name_from_camelcase(self.public_format).upper()
             template += (
                 '#if defined  __${public_type_underscore_upper}_IS_ENUM__\n'
-                '${lp}    g_string_append_printf (printable, "%s", ${public_type_underscore}_get_string ((${public_format})tmp));\n'
+                '${lp}    {\n'
+                '${lp}        const gchar *enum_str;\n'
+                '\n'
+                '${lp}        enum_str = ${public_type_underscore}_get_string ((${public_format})tmp);\n'
+                '${lp}        g_string_append (printable, enum_str ? enum_str : "(null)");\n'
+                '${lp}    }\n'
                 '#elif defined  __${public_type_underscore_upper}_IS_FLAGS__\n'
                 '${lp}    {\n'
                 '${lp}        g_autofree gchar *flags_str = NULL;\n'
                 '\n'
                 '${lp}        flags_str = ${public_type_underscore}_build_string_from_mask ((${public_format})tmp);\n'
-                '${lp}        g_string_append_printf (printable, "%s", flags_str);\n'
+                '${lp}        g_string_append (printable, flags_str ? flags_str : "(null)");\n'
                 '${lp}    }\n'
                 '#else\n'
                 '# error unexpected public format: ${public_format}\n'
                 '#endif\n')
+        elif common_append:
+            template += (
+                '${lp}    ${common_append} (printable, ${common_cast}tmp);\n')
         else:
             template += (
                 '${lp}    g_string_append_printf (printable, "${common_format}", ${common_cast}tmp);\n')
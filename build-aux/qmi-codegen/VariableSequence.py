@@ -80,6 +80,30 @@ class VariableSequence(Variable):
             member['object'].emit_buffer_read(f, line_prefix, tlv_out, error, variable_name + '_' +  member['name'])
 
 
+    """
+    Maximum number of bytes the sequence takes in the raw buffer, the sum of
+    the maximum sizes of all its fields
+    """
+    def max_buffer_size(self):
+        size = 0
+        for member in self.members:
+            member_size = member['object'].max_buffer_size()
+            if member_size is None:
+                return None
+            size += member_size
+        return size
+
+
+    """
+    The sequence takes room from the arena if any of its fields does
+    """
+    def uses_arena(self):
+        for member in self.members:
+            if member['object'].uses_arena():
+                return True
+        return False
+
+
     """
     Writing the contents of a sequence is just about writing each of the sequence
     fields one by one.
@@ -30,11 +30,15 @@ class VariableString(Variable):
     """
     Constructor
     """
-    def __init__(self, dictionary):
+    def __init__(self, dictionary, container_type):
 
         # Call the parent constructor
         Variable.__init__(self, dictionary)
 
+        # Strings read into Output containers live in the arena allocated along
+        # with the container, so they're never disposed one by one
+        self.in_arena = (container_type == 'Output')
+
         self.private_format = 'gchar *'
         self.public_format = self.private_format
         self.element_type = 'utf8'
@@ -50,8 +54,8 @@ class VariableString(Variable):
         else:
             self.is_fixed_size = False
             self.fixed_size = '-1'
-            # Variable-length strings in heap
-            self.needs_dispose = True
+            # Variable-length strings in heap, unless in the arena
+            self.needs_dispose = not self.in_arena
             if 'size-prefix-format' in dictionary:
                 if dictionary['size-prefix-format'] == 'guint8':
                     self.length_prefix_size = 8
@@ -86,8 +90,12 @@ class VariableString(Variable):
             translations['fixed_size'] = self.fixed_size
 
             # Fixed sized strings exposed in public fields will need to be
-            # explicitly allocated in heap
-            if self.public:
+            # explicitly allocated in the arena or in heap
+            if self.public and self.in_arena:
+                template = (
+                    '${lp}if (!__qmi_message_tlv_read_fixed_size_string_in_arena (message, init_offset, &offset, ${fixed_size}, &arena, &(${variable_name}), ${error}))\n'
+                    '${lp}    goto ${tlv_out};\n')
+            elif self.public:
                 translations['fixed_size_plus_one'] = int(self.fixed_size) + 1
                 template = (
                     '${lp}${variable_name} = g_malloc (${fixed_size_plus_one});\n'
@@ -105,12 +113,29 @@ class VariableString(Variable):
         else:
             translations['n_size_prefix_bytes'] = self.n_size_prefix_bytes
             translations['max_size'] = self.max_size if self.max_size != '' else '0'
-            template = (
-                '${lp}if (!qmi_message_tlv_read_string (message, init_offset, &offset, ${n_size_prefix_bytes}, ${max_size}, &(${variable_name}), ${error}))\n'
-                '${lp}    goto ${tlv_out};\n')
+            if self.in_arena:
+                template = (
+                    '${lp}if (!__qmi_message_tlv_read_string_in_arena (message, init_offset, &offset, ${n_size_prefix_bytes}, ${max_size}, &arena, &(${variable_name}), ${error}))\n'
+                    '${lp}    goto ${tlv_out};\n')
+            else:
+                template = (
+                    '${lp}if (!qmi_message_tlv_read_string (message, init_offset, &offset, ${n_size_prefix_bytes}, ${max_size}, &(${variable_name}), ${error}))\n'
+                    '${lp}    goto ${tlv_out};\n')
         f.write(string.Template(template).substitute(translations))
 
 
+    """
+    Maximum number of bytes the string takes in the raw buffer, if it is
+    either fixed-size or has a maximum size
+    """
+    def max_buffer_size(self):
+        if self.is_fixed_size:
+            return int(self.fixed_size)
+        if self.max_size != '':
+            return self.n_size_prefix_bytes + int(self.max_size)
+        return None
+
+
     """
     Write a string to the raw byte buffer.
     """
@@ -346,8 +371,8 @@ class VariableString(Variable):
     Dispose the string
     """
     def build_dispose(self, line_prefix, variable_name):
-        # Fixed-size strings don't need dispose
-        if self.is_fixed_size and not self.public:
+        # Fixed-size strings don't need dispose, arena strings go with the arena
+        if (self.is_fixed_size and not self.public) or self.in_arena:
             return ''
 
         translations = { 'lp'            : line_prefix,
@@ -365,5 +390,12 @@ class VariableString(Variable):
         # Call the parent method
         Variable.flag_public(self)
         # Fixed-sized strings will need dispose if they are in the public header
-        if self.is_fixed_size:
+        if self.is_fixed_size and not self.in_arena:
             self.needs_dispose = True
+
+
+    """
+    Whether the string is read into the arena of the container
+    """
+    def uses_arena(self):
+        return self.in_arena and (self.public or not self.is_fixed_size)
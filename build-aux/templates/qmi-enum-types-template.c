@@ -1,5 +1,15 @@
 /*** BEGIN file-header ***/
 
+typedef struct {
+  gint value;
+  const gchar *value_nick;
+} EnumValueNick;
+
+typedef struct {
+  guint value;
+  const gchar *value_nick;
+} FlagsMaskNick;
+
 /*** END file-header ***/
 
 /*** BEGIN file-production ***/
@@ -34,28 +44,67 @@ GType
 }
 
 /* Enum-specific method to get the value as a string.
- * We get the nick of the GEnumValue. Note that this will be
- * valid even if the GEnumClass is not referenced anywhere. */
+ * We get the nick of the GEnumValue, looked up in a table indexed by
+ * value when the values are compact enough, or with a binary search in a
+ * table sorted by value otherwise. Note that this will be valid even if
+ * the GEnumClass is not referenced anywhere. */
 #if defined __@ENUMNAME@_IS_ENUM__
+#if @valuedense@
+static const gchar *@enum_name@_nicks[] = {
+#else
+static const EnumValueNick @enum_name@_nicks[] = {
+#endif
+@valuenicks@
+};
+
+#if @valuedense@
 const gchar *
 @enum_name@_get_string (@EnumName@ val)
 {
-    guint i;
+    gint64 i;
+
+    i = (gint64)(gint)val - (@valuemin@);
+    if (i < 0 || i >= (gint64) G_N_ELEMENTS (@enum_name@_nicks))
+        return NULL;
 
-    for (i = 0; @enum_name@_values[i].value_nick; i++) {
-      if ((gint)val == @enum_name@_values[i].value)
-            return @enum_name@_values[i].value_nick;
+    return @enum_name@_nicks[i];
+}
+#else
+const gchar *
+@enum_name@_get_string (@EnumName@ val)
+{
+    guint low = 0;
+    guint high = G_N_ELEMENTS (@enum_name@_nicks);
+
+    while (low < high) {
+        guint mid = low + (high - low) / 2;
+
+        if ((gint)val == @enum_name@_nicks[mid].value)
+            return @enum_name@_nicks[mid].value_nick;
+        if ((gint)val < @enum_name@_nicks[mid].value)
+            high = mid;
+        else
+            low = mid + 1;
     }
 
     return NULL;
 }
+#endif
 #endif /* __@ENUMNAME@_IS_ENUM__ */
 
 /* Flags-specific method to build a string with the given mask.
- * We get a comma separated list of the nicks of the GFlagsValues.
- * Note that this will be valid even if the GFlagsClass is not referenced
- * anywhere. */
+ * We get a comma separated list of the nicks of the GFlagsValues, looked up
+ * per bit. Note that this will be valid even if the GFlagsClass is not
+ * referenced anywhere. */
 #if defined __@ENUMNAME@_IS_FLAGS__
+static const gchar *@enum_name@_bit_nicks[] = {
+@valuenicks@
+};
+
+static const FlagsMaskNick @enum_name@_mask_nicks[] = {
+@valuemasks@
+};
+
 gchar *
 @enum_name@_build_string_from_mask (@EnumName@ mask)
 {
@@ -63,32 +112,24 @@ gchar *
     gboolean first = TRUE;
     GString *str = NULL;
 
-    for (i = 0; @enum_name@_values[i].value_nick; i++) {
-        /* We also look for exact matches */
-      if ((guint)mask == @enum_name@_values[i].value) {
-            if (str)
-                g_string_free (str, TRUE);
-            return g_strdup (@enum_name@_values[i].value_nick);
-        }
-
-        /* Build list with single-bit masks */
-        if (mask & @enum_name@_values[i].value) {
-            guint c;
-            gulong number = @enum_name@_values[i].value;
-
-            for (c = 0; number; c++)
-                number &= number - 1;
-
-            if (c == 1) {
-                if (!str)
-                    str = g_string_new ("");
-                g_string_append_printf (str, "%s%s",
-                                        first ? "" : ", ",
-                                        @enum_name@_values[i].value_nick);
-                if (first)
-                    first = FALSE;
-            }
-        }
+    /* We also look for exact matches of the values that aren't a single bit */
+    for (i = 0; @enum_name@_mask_nicks[i].value_nick; i++) {
+        if ((guint)mask == @enum_name@_mask_nicks[i].value)
+            return g_strdup (@enum_name@_mask_nicks[i].value_nick);
+    }
+
+    /* Build list with single-bit masks */
+    for (i = 0; i < G_N_ELEMENTS (@enum_name@_bit_nicks); i++) {
+        if (!((guint)mask & (1u << i)) || !@enum_name@_bit_nicks[i])
+            continue;
+
+        if (!str)
+            str = g_string_new ("");
+        g_string_append_printf (str, "%s%s",
+                                first ? "" : ", ",
+                                @enum_name@_bit_nicks[i]);
+        if (first)
+            first = FALSE;
     }
 
     return (str ? g_string_free (str, FALSE) : NULL);
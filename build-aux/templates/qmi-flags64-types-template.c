@@ -2,9 +2,8 @@
 
 typedef struct {
   guint64 value;
-  const gchar *value_name;
   const gchar *value_nick;
-} GFlags64Value;
+} GFlags64MaskNick;
 
 /*** END file-header ***/
 
@@ -12,14 +11,13 @@ typedef struct {
 /* enumerations from "@filename@" */
 /*** END file-production ***/
 
-/*** BEGIN value-header ***/
-static const GFlags64Value @enum_name@_values[] = {
-/*** END value-header ***/
-/*** BEGIN value-production ***/
-    { @VALUENAME@, "@VALUENAME@", "@valuenick@" },
-/*** END value-production ***/
 /*** BEGIN value-tail ***/
-    { 0, NULL, NULL }
+static const gchar *@enum_name@_bit_nicks[] = {
+@valuenicks@
+};
+
+static const GFlags64MaskNick @enum_name@_mask_nicks[] = {
+@valuemasks@
 };
 
 gchar *
@@ -29,32 +27,24 @@ gchar *
     gboolean first = TRUE;
     GString *str = NULL;
 
-    for (i = 0; @enum_name@_values[i].value_nick; i++) {
-        /* We also look for exact matches */
-        if (mask == @enum_name@_values[i].value) {
-            if (str)
-                g_string_free (str, TRUE);
-            return g_strdup (@enum_name@_values[i].value_nick);
-        }
-
-        /* Build list with single-bit masks */
-        if (mask & @enum_name@_values[i].value) {
-            guint c;
-            guint64 number = @enum_name@_values[i].value;
-
-            for (c = 0; number; c++)
-                number &= number - 1;
+    /* We also look for exact matches of the values that aren't a single bit */
+    for (i = 0; @enum_name@_mask_nicks[i].value_nick; i++) {
+        if (mask == @enum_name@_mask_nicks[i].value)
+            return g_strdup (@enum_name@_mask_nicks[i].value_nick);
+    }
 
-            if (c == 1) {
-                if (!str)
-                    str = g_string_new ("");
-                g_string_append_printf (str, "%s%s",
-                                        first ? "" : ", ",
-                                        @enum_name@_values[i].value_nick);
-                if (first)
-                    first = FALSE;
-            }
-        }
+    /* Build list with single-bit masks */
+    for (i = 0; i < G_N_ELEMENTS (@enum_name@_bit_nicks); i++) {
+        if (!(mask & (((guint64) 1) << i)) || !@enum_name@_bit_nicks[i])
+            continue;
+
+        if (!str)
+            str = g_string_new ("");
+        g_string_append_printf (str, "%s%s",
+                                first ? "" : ", ",
+                                @enum_name@_bit_nicks[i]);
+        if (first)
+            first = FALSE;
     }
 
     return (str ? g_string_free (str, FALSE) : NULL);
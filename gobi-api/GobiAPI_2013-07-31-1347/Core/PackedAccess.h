@@ -0,0 +1,209 @@
+/*===========================================================================
+FILE:
+   PackedAccess.h
+
+DESCRIPTION:
+   Alignment safe accessors for fields of packed (QMI) structs
+
+PUBLIC CLASSES AND METHODS:
+   GetPacked()
+   GetPackedAligned()
+   SetPacked()
+      Read/write a little endian value at any address
+
+Copyright (c) 2013, The Linux Foundation. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of The Linux Foundation nor the names of its
+      contributors may be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Pragmas
+//---------------------------------------------------------------------------
+#pragma once
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include <stddef.h>
+#include <string.h>
+
+//---------------------------------------------------------------------------
+// Definitions
+//---------------------------------------------------------------------------
+
+// Read a multi-byte field of a packed struct (which may lie at any address 
+// in a message), e.g. GET_PACKED_FIELD( pTLV, mLength )
+#define GET_PACKED_FIELD( pStruct, field ) \
+   GetPacked <__typeof__( (pStruct)->field )>( \
+      (const char *)&(pStruct)->field )
+
+// Write a multi-byte field of a packed struct
+#define SET_PACKED_FIELD( pStruct, field, val ) \
+   SetPacked <__typeof__( (pStruct)->field )>( \
+      (char *)&(pStruct)->field, (val) )
+
+/*=========================================================================*/
+// Struct sPackedBytes
+//    Unsigned integer of a given size and its byte swap
+/*=========================================================================*/
+template <size_t tSize> struct sPackedBytes;
+
+template <> struct sPackedBytes <1>
+{
+   typedef unsigned char tUInt;
+   static tUInt Swap( tUInt val ) { return val; };
+};
+
+template <> struct sPackedBytes <2>
+{
+   typedef unsigned short tUInt;
+   static tUInt Swap( tUInt val ) { return __builtin_bswap16( val ); };
+};
+
+template <> struct sPackedBytes <4>
+{
+   typedef unsigned int tUInt;
+   static tUInt Swap( tUInt val ) { return __builtin_bswap32( val ); };
+};
+
+template <> struct sPackedBytes <8>
+{
+   typedef unsigned long long tUInt;
+   static tUInt Swap( tUInt val ) { return __builtin_bswap64( val ); };
+};
+
+/*=========================================================================*/
+// Struct sPackedValue
+//    Type of a field value (its type without any const qualifier)
+/*=========================================================================*/
+template <class tField> struct sPackedValue
+{
+   typedef tField tVal;
+};
+
+template <class tField> struct sPackedValue <const tField>
+{
+   typedef tField tVal;
+};
+
+/*===========================================================================
+METHOD:
+   PackedToHost (Inline Method)
+
+DESCRIPTION:
+   Convert a value from QMI (little endian) to host byte order, or back
+
+PARAMETERS:
+   raw         [ I ] - Value
+
+RETURN VALUE:
+   Value in the other byte order
+===========================================================================*/
+template <class tUInt>
+inline tUInt PackedToHost( tUInt raw )
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+   return sPackedBytes <sizeof( tUInt )>::Swap( raw );
+#else
+   return raw;
+#endif
+};
+
+/*===========================================================================
+METHOD:
+   GetPacked (Inline Method)
+
+DESCRIPTION:
+   Read a little endian value from an address of any alignment.  The copy
+   is of a constant size, so it compiles to a single load where the CPU
+   allows unaligned loads and to byte loads (never a trap) elsewhere
+
+PARAMETERS:
+   pSrc        [ I ] - Address of the value
+
+RETURN VALUE:
+   tVal - The value (in host byte order)
+===========================================================================*/
+template <class tVal>
+inline tVal GetPacked( const void * pSrc )
+{
+   typedef typename sPackedBytes <sizeof( tVal )>::tUInt tUInt;
+
+   tUInt raw;
+   memcpy( &raw, pSrc, sizeof( raw ) );
+   raw = PackedToHost( raw );
+
+   typename sPackedValue <tVal>::tVal val;
+   memcpy( &val, &raw, sizeof( val ) );
+   return val;
+};
+
+/*===========================================================================
+METHOD:
+   GetPackedAligned (Inline Method)
+
+DESCRIPTION:
+   Read a little endian value from an address known to be aligned for 
+   the value, which always compiles to a single load
+
+PARAMETERS:
+   pSrc        [ I ] - Address of the value (aligned to its size)
+
+RETURN VALUE:
+   tVal - The value (in host byte order)
+===========================================================================*/
+template <class tVal>
+inline tVal GetPackedAligned( const void * pSrc )
+{
+   return GetPacked <tVal>( __builtin_assume_aligned( pSrc, sizeof( tVal ) ) );
+};
+
+/*===========================================================================
+METHOD:
+   SetPacked (Inline Method)
+
+DESCRIPTION:
+   Write a value in little endian to an address of any alignment
+
+PARAMETERS:
+   pDst        [ O ] - Address of the value
+   val         [ I ] - The value (in host byte order)
+
+RETURN VALUE:
+   None
+===========================================================================*/
+template <class tVal>
+inline void SetPacked( 
+   void *                     pDst,
+   tVal                       val )
+{
+   typedef typename sPackedBytes <sizeof( tVal )>::tUInt tUInt;
+
+   tUInt raw;
+   memcpy( &raw, &val, sizeof( raw ) );
+   raw = PackedToHost( raw );
+
+   memcpy( pDst, &raw, sizeof( raw ) );
+};
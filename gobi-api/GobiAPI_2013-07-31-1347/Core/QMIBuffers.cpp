@@ -111,29 +111,23 @@ bool sQMIServiceBuffer::GetResult(
       return false;
    }
 
-   std::map <ULONG, const sQMIRawContentHeader *>::const_iterator pIter;
-   pIter = mContents.find( QMI_TLV_ID_RESULT );
-   if (pIter == mContents.end())
-   {
-      return false;
-   }
-
-   const sQMIRawContentHeader * pContent = pIter->second;
+   const sQMIRawContentHeader * pContent = 0;
+   pContent = mContents.Find( QMI_TLV_ID_RESULT );
    if (pContent == 0)
    {
-      ASSERT( 0 );
       return false;
    }
 
-   if (pContent->mLength != 4)
+   if (GET_PACKED_FIELD( pContent, mLength ) != 4)
    {
       return false;
    }
    
-   const WORD * pData = (const WORD *)(++pContent);
+   // The result and error codes need not be aligned
+   const BYTE * pData = (const BYTE *)(++pContent);
 
-   returnCode = (ULONG)*pData++;
-   errorCode = (ULONG)*pData;
+   returnCode = (ULONG)GetPacked <WORD>( pData );
+   errorCode = (ULONG)GetPacked <WORD>( pData + sizeof( WORD ) );
 
    return true;
 }
@@ -194,7 +188,7 @@ sSharedBuffer * sQMIServiceBuffer::BuildBuffer(
    pHdr->mResponse      = 0;
    pHdr->mIndication    = 0;
    pHdr->mReserved      = 0;
-   pHdr->mTransactionID = 1;
+   SET_PACKED_FIELD( pHdr, mTransactionID, 1 );
    
    bool bTX = true;
    if (bResponse == true)
@@ -213,8 +207,8 @@ sSharedBuffer * sQMIServiceBuffer::BuildBuffer(
    // Format message header
    sQMIRawMessageHeader * pMsg = 0;
    pMsg = (sQMIRawMessageHeader *)pHdr;
-   pMsg->mMessageID = msgID;
-   pMsg->mLength    = (WORD)payloadLen;
+   SET_PACKED_FIELD( pMsg, mMessageID, msgID );
+   SET_PACKED_FIELD( pMsg, mLength, (WORD)payloadLen );
    
    // Copy in payload?
    if (payloadLen > 0 && pPayload != 0)
@@ -291,7 +285,8 @@ bool sQMIServiceBuffer::Validate()
 
    // Requests/responses required valid transaction IDs 
    if ( (pTransHdr->mIndication == 0) 
-   &&   (pTransHdr->mTransactionID == (WORD)INVALID_QMI_TRANSACTION_ID) )
+   &&   (GET_PACKED_FIELD( pTransHdr, mTransactionID ) 
+            == (WORD)INVALID_QMI_TRANSACTION_ID) )
    {
       mbValid = bRC;
       return bRC;
@@ -317,7 +312,8 @@ bool sQMIServiceBuffer::Validate()
    pBuffer += szMsgHdr;
 
    // Validate reported length
-   if (sz != ((ULONG)pMsgHdr->mLength + szTransHdr + szMsgHdr))
+   ULONG contentSz = (ULONG)GET_PACKED_FIELD( pMsgHdr, mLength );
+   if (sz != (contentSz + szTransHdr + szMsgHdr))
    {
       mbValid = bRC;
       return bRC;
@@ -325,22 +321,22 @@ bool sQMIServiceBuffer::Validate()
 
    // Extract content TLV structures
    ULONG contentProcessed = 0;
-   ULONG contentSz = (ULONG)pMsgHdr->mLength;
+   mContents.Reset( pBuffer );
    while (contentProcessed < contentSz)
    {
       const sQMIRawContentHeader * pContent = 0;
       pContent = (const sQMIRawContentHeader *)pBuffer;
 
-      ULONG tlvLen = szContentHdr + pContent->mLength; 
+      ULONG tlvLen = szContentHdr + GET_PACKED_FIELD( pContent, mLength ); 
       
       contentProcessed += tlvLen;
       if (contentProcessed <= contentSz)
       {
-         mContents[(ULONG)pContent->mTypeID] = pContent;
+         mContents.Add( pContent );
       }
       else
       {
-         mContents.clear();
+         mContents.Reset( 0 );
 
          mbValid = bRC;
          return bRC;
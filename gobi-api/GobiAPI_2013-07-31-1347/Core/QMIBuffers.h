@@ -12,6 +12,7 @@ PUBLIC CLASSES AND METHODS:
    sQMIRawMessageHeader
    sQMIRawContentHeader
 
+   sQMIContents
    sQMIServiceBuffer
 
 Copyright (c) 2013, The Linux Foundation. All rights reserved.
@@ -51,6 +52,7 @@ POSSIBILITY OF SUCH DAMAGE.
 //---------------------------------------------------------------------------
 #include "ProtocolBuffer.h"
 #include "QMIEnum.h"
+#include "PackedAccess.h"
 
 #include <map>
 #include <vector>
@@ -65,6 +67,9 @@ const ULONG QMI_MAX_BUFFER_SIZE = MAX_SHARED_BUFFER_SIZE;
 // Content ID for mandatory result TLV
 const ULONG QMI_TLV_ID_RESULT = 2;
 
+// Number of distinct content (TLV) type IDs
+const ULONG QMI_MAX_CONTENT_IDS = 256;
+
 /*===========================================================================
 METHOD:
    MapQMIServiceToProtocol (Inline Method)
@@ -210,6 +215,99 @@ struct sQMIRawContentHeader
 #pragma pack( pop )
 
 
+/*=========================================================================*/
+// Struct sQMIContents
+//    Directory of the content TLVs of a QMI message, indexed by type ID
+//    (a later TLV with an already seen type ID replaces the earlier one).
+//    Presence is kept as a bitmap and each TLV as an offset from the
+//    start of the contents, so building and searching it never allocates
+/*=========================================================================*/
+struct sQMIContents
+{
+   public:
+      // (Inline) Constructor
+      sQMIContents()
+         :  mpContents( 0 ),
+            mCount( 0 )
+      {
+         memset( (LPVOID)&mPresent[0], 0, sizeof( mPresent ) );
+      };
+
+      // (Inline) Reset to an empty directory for the given contents
+      void Reset( const BYTE * pContents )
+      {
+         mpContents = pContents;
+         mCount = 0;
+         memset( (LPVOID)&mPresent[0], 0, sizeof( mPresent ) );
+      };
+
+      // (Inline) Add a TLV (which has to be within the contents)
+      void Add( const sQMIRawContentHeader * pContent )
+      {
+         ULONG id = (ULONG)pContent->mTypeID;
+         ULONGLONG bit = 1ULL << (id & 63);
+         if ((mPresent[id >> 6] & bit) == 0)
+         {
+            mPresent[id >> 6] |= bit;
+            mCount++;
+         }
+
+         mOffsets[id] = (WORD)((const BYTE *)pContent - mpContents);
+      };
+
+      // (Inline) Return the TLV with the given type ID (0 if not present)
+      const sQMIRawContentHeader * Find( ULONG typeID ) const
+      {
+         if ( (typeID >= QMI_MAX_CONTENT_IDS)
+         ||   ((mPresent[typeID >> 6] & (1ULL << (typeID & 63))) == 0) )
+         {
+            return 0;
+         }
+
+         return (const sQMIRawContentHeader *)(mpContents + mOffsets[typeID]);
+      };
+
+      // (Inline) Return the number of TLVs
+      ULONG GetCount() const
+      {
+         return mCount;
+      };
+
+      // (Inline) Return the lowest present type ID at or above the given
+      // one (QMI_MAX_CONTENT_IDS if there is none), so that TLVs can be
+      // walked in type ID order:
+      //    for (id = c.GetNextID( 0 ); id < QMI_MAX_CONTENT_IDS; 
+      //         id = c.GetNextID( id + 1 ))
+      ULONG GetNextID( ULONG typeID ) const
+      {
+         while (typeID < QMI_MAX_CONTENT_IDS)
+         {
+            ULONGLONG bits = mPresent[typeID >> 6] >> (typeID & 63);
+            if (bits != 0)
+            {
+               return typeID + (ULONG)__builtin_ctzll( bits );
+            }
+
+            typeID = (typeID | 63) + 1;
+         }
+
+         return QMI_MAX_CONTENT_IDS;
+      };
+
+   protected:
+      /* Start of the contents the offsets are relative to */
+      const BYTE * mpContents;
+
+      /* Number of TLVs present */
+      ULONG mCount;
+
+      /* Presence bitmap (by type ID) */
+      ULONGLONG mPresent[QMI_MAX_CONTENT_IDS / 64];
+
+      /* TLV offsets (by type ID, only valid when present) */
+      WORD mOffsets[QMI_MAX_CONTENT_IDS];
+};
+
 /*=========================================================================*/
 // Struct sQMIServiceBuffer
 //    Struct to represent a QMI service channel request/response/indication 
@@ -290,7 +388,7 @@ struct sQMIServiceBuffer : public sProtocolBuffer
             const sQMIRawMessageHeader * pMsgHdr = 0;
             pMsgHdr = (sQMIRawMessageHeader *)pHdr;
 
-            id = pMsgHdr->mMessageID;
+            id = GET_PACKED_FIELD( pMsgHdr, mMessageID );
          }
 
          return id;
@@ -304,7 +402,7 @@ struct sQMIServiceBuffer : public sProtocolBuffer
          const sQMIServiceRawTransactionHeader * pHdr = GetHeader();
          if (pHdr != 0)
          {
-            id = pHdr->mTransactionID;
+            id = GET_PACKED_FIELD( pHdr, mTransactionID );
          }
 
          return id;
@@ -324,7 +422,7 @@ struct sQMIServiceBuffer : public sProtocolBuffer
             const sQMIRawMessageHeader * pMsgHdr = 0;
             pMsgHdr = (sQMIRawMessageHeader *)pHdr;
 
-            len = pMsgHdr->mLength;
+            len = GET_PACKED_FIELD( pMsgHdr, mLength );
             pMsgHdr++;
             if (len > 0)
             {
@@ -337,7 +435,7 @@ struct sQMIServiceBuffer : public sProtocolBuffer
       };
 
       // (Inline) Return content structures
-      std::map <ULONG, const sQMIRawContentHeader *> GetContents() const
+      const sQMIContents & GetContents() const
       {
          return mContents;
       };
@@ -372,7 +470,7 @@ struct sQMIServiceBuffer : public sProtocolBuffer
          pHdr = (sQMIServiceRawTransactionHeader *)GetHeader();
          if (pHdr != 0)
          {
-            pHdr->mTransactionID = tid;
+            SET_PACKED_FIELD( pHdr, mTransactionID, tid );
          }
       };
 
@@ -380,7 +478,7 @@ struct sQMIServiceBuffer : public sProtocolBuffer
       virtual bool Validate();
 
       /* Content TLV structures (indexed by type ID) */
-      std::map <ULONG, const sQMIRawContentHeader *> mContents;
+      sQMIContents mContents;
 
    private:
       // Prevent 'upcopying'
@@ -42,6 +42,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "QMIProtocolServer.h"
 #include "QMIBuffers.h"
 #include "Comm.h"
+#include "URingComm.h"
 #include "Socket.h"
 
 /*=========================================================================*/
@@ -129,7 +130,16 @@ bool cQMIProtocolServer::Connect( LPCSTR pControlFile )
    std::string name = pControlFile;
    if (name.find( "qcqmi" ) != std::string::npos)
    {
-      mpConnection = new cComm();
+      // Go through io_uring where the kernel has it
+      if (cURingComm::IsSupported() == true)
+      {
+         mpConnection = new cURingComm();
+      }
+      else
+      {
+         mpConnection = new cComm();
+      }
+
       mConnectionType = eConnectionType_RmNet;
    }
    else
@@ -41,217 +41,20 @@ POSSIBILITY OF SUCH DAMAGE.
 //---------------------------------------------------------------------------
 #include "StdAfx.h"
 #include "Socket.h"
+#include "SocketService.h"
 #include "ProtocolServer.h"
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/un.h>
 
 //---------------------------------------------------------------------------
 // Definitions
 //---------------------------------------------------------------------------
-// Thread commands
-#define START_READ_CMD  0
-#define STOP_READ_CMD   1
-#define EXIT_CMD        2
-
 // Size of the QMUXD command payload
 // GET_CLIENT_ID and RELEASE_CLIENT_ID must pass in a buffer of this size
 #define PAYLOAD_SIZE 808 
 
-/*=========================================================================*/
-// struct sQMUXDHeader
-/*=========================================================================*/
-#pragma pack( push, 1 )
-
-struct sQMUXDHeader
-{
-   /* Total size of header and following buffer */
-   int mTotalSize;
-
-   /* QMUXD client ID */
-   int mQMUXDClientID;
-
-   /* Message type */
-   eQMUXDMessageTypes mQMUXDMsgID;
-   
-   /* Duplicate of mQMUXDClientID */
-   int mQMUXDClientIDDuplicate;
-   
-   /* Transaction ID */
-   unsigned long mTxID;
-
-   /* System error code */
-   int mSysErrCode;
-
-   /* QMI error code (duplicate of TLV 0x02) */
-   int mQmiErrCode;
-
-   /* SMD channel.  0 = SMD_DATA_5 */
-   int mQMUXDConnectionType;
-   
-   /* QMI service ID */
-   int mQMUXServiceID;
-
-   /* QMI client ID */
-   unsigned char mQMUXClientID;
-
-   /* QMI flags */
-   unsigned char mRxFlags;
-
-   /* In QMUXD this struct is not packed, so the compiler appends
-      these two bytes */
-   unsigned short int mMissing2Bytes;
-};
-
-#pragma pack( pop )
-
-
-/*=========================================================================*/
-// Free Methods
-/*=========================================================================*/
-
-/*===========================================================================
-METHOD:
-   RxSocketThread (Free Method)
-
-DESCRIPTION:
-   Thread for simulating asynchronous reads to a socket
-
-PARAMETERS:
-   pData      [ I ]   cSocket pointer
-
-RETURN VALUE:
-   void * - thread exit value (always 0)
-===========================================================================*/
-void * RxSocketThread( void * pData )
-{
-   cSocket * pSocket = (cSocket*)pData;
-   if (pSocket == NULL || pSocket->IsValid() == false)
-   {
-      return 0;
-   }
-
-   fd_set inputSet, outputSet;
-   FD_ZERO( &inputSet );
-   FD_SET( pSocket->mCommandPipe[READING], &inputSet );
-   int largestFD = pSocket->mCommandPipe[READING];
-
-   int status = 0;
-   while (true)
-   {
-      // No FD_COPY() available
-      memcpy( &outputSet, &inputSet, sizeof( fd_set ) );
-
-      // Wait until we recieve a command or data is available
-      status = select( largestFD + 1, &outputSet, NULL, NULL, NULL );
-      if (status <= 0)
-      {
-         TRACE( "error %d in select, errno %d\n", status, errno );
-         break;
-      }
-
-      if (FD_ISSET( pSocket->mCommandPipe[READING], &outputSet ) == true)
-      {
-         // Read command value from the pipe
-         BYTE cmd;
-         status = read( pSocket->mCommandPipe[READING], &cmd, 1 );
-         if (status != 1)
-         {
-            TRACE( "cmd error %d\n", status );
-            break;
-         }
-
-         if (cmd == START_READ_CMD)
-         {
-            FD_SET( pSocket->mSocket, &inputSet );
-            largestFD = std::max( pSocket->mSocket, 
-                                  pSocket->mCommandPipe[READING] );
-         }
-         else if (cmd == STOP_READ_CMD)
-         {
-            FD_CLR( pSocket->mSocket, &inputSet );
-            largestFD = pSocket->mCommandPipe[READING];
-         }
-         else
-         {
-            // EXIT_CMD or anything else
-            pSocket->mpRxCallback = 0;
-            break;
-         }
-      }
-      else if (FD_ISSET( pSocket->mSocket, &outputSet ) == true)
-      {
-         // Stop watching for read data
-         FD_CLR( pSocket->mSocket, &inputSet );
-         largestFD = pSocket->mCommandPipe[READING];
-
-         // Perform a recv for the header
-         sQMUXDHeader recvHdr;
-         status = recv( pSocket->mSocket,
-                        &recvHdr,
-                        sizeof( recvHdr ),
-                        0 );         
-         if (status != sizeof( recvHdr ))
-         {
-            TRACE( "recv error, bad size %d\n", status );
-            break;
-         }            
-
-         // Calculate and read the remaining data
-         if ((recvHdr.mTotalSize < 0)
-         ||  ((ULONG)recvHdr.mTotalSize < sizeof( recvHdr ))
-         ||  ((ULONG)recvHdr.mTotalSize > sizeof( recvHdr ) + pSocket->mBuffSz))
-         {
-            TRACE( "read too large for buffer\n" );
-            break;
-         }
-
-         status = recv( pSocket->mSocket,
-                        pSocket->mpBuffer,
-                        recvHdr.mTotalSize - sizeof( recvHdr ),
-                        0 );
 
-         // Is this one of our IOCTLS or a standard message?
-         if (recvHdr.mQMUXDMsgID == eQMUXD_MSG_WRITE_QMI_SDU)
-         {
-            cIOCallback * pCallback = pSocket->mpRxCallback;
-            pSocket->mpRxCallback = 0;
-
-            if (pCallback == (cIOCallback *)1)
-            {
-               // We wanted to read, but not to be notified
-            }   
-            else if (status >= 0)
-            {
-               pCallback->IOComplete( 0, status );
-            }
-            else
-            {
-               pCallback->IOComplete( status, 0 );
-            }
-         }
-         else
-         {
-            pSocket->mpRxCallback = 0;
-            // Notify SendCtl() that control message completed
-
-            if (recvHdr.mQMUXDMsgID == eQMUXD_MSG_ALLOC_QMI_CLIENT_ID)
-            {
-               DWORD clientID;
-               memcpy( &clientID, &pSocket->mpBuffer[0], 4 );
-
-               pSocket->mCtrlMsgComplete.Set( clientID );
-            }
-            else
-            {
-               // Just set the event
-               pSocket->mCtrlMsgComplete.Set( 0 );
-            }
-         }
-      }
-   }
-
-   return 0;
-};
 
 /*=========================================================================*/
 // cSocket Methods
@@ -272,7 +75,11 @@ cSocket::cSocket()
       mbCancelWrite( false ),
       mpBuffer( 0 ),
       mBuffSz( 0 ),
-      mRxThreadID( 0 ),
+      mpStaging( 0 ),
+      mStageStart( 0 ),
+      mStageEnd( 0 ),
+      mbWatching( false ),
+      mbFailed( false ),
       mCtrlMsgComplete(),
       mQMUXDClientID( 0 ),
       mQMUXClientID( 0 ),
@@ -280,8 +87,7 @@ cSocket::cSocket()
       mChannelID( -1 ),
       mQMUXDTxID( 0 )
 {
-   mCommandPipe[READING] = INVALID_HANDLE_VALUE;
-   mCommandPipe[WRITING] = INVALID_HANDLE_VALUE;
+   // Nothing to do
 }
 
 /*===========================================================================
@@ -298,9 +104,6 @@ cSocket::~cSocket()
 {
    // Disconnect from current port
    Disconnect();
-
-   mCommandPipe[READING] = INVALID_HANDLE_VALUE;
-   mCommandPipe[WRITING] = INVALID_HANDLE_VALUE;
 }
 
 /*===========================================================================
@@ -346,27 +149,6 @@ bool cSocket::Connect( LPCSTR pPort )
       Disconnect();
    }
 
-   // Initialize command pipe for read thread
-   int nRet = pipe( mCommandPipe );
-   if (nRet != 0)
-   {
-      TRACE( "cSocket:Connect() pipe creation failed %d\n", nRet );
-      return false;
-   }
-
-   // Start the read thread
-   nRet = pthread_create( &mRxThreadID,
-                          0,
-                          RxSocketThread,
-                          this );
-   if (nRet != 0)
-   {
-      TRACE( "cSocket::Connect() pthread_create = %d\n",  nRet );
-
-      Disconnect();
-      return false;
-   }
-
    // Create a socket
    mSocket = socket( AF_UNIX, SOCK_STREAM, 0 );
    if (mSocket == INVALID_HANDLE_VALUE)
@@ -405,7 +187,7 @@ bool cSocket::Connect( LPCSTR pPort )
    unlink( clientSockAddr.sun_path );
 
    // Bind to a client address
-   nRet = bind( mSocket, 
+   int nRet = bind( mSocket, 
                 (struct sockaddr *)&clientSockAddr,
                 sizeof( sockaddr_un ) );
    if (nRet == -1)
@@ -459,6 +241,16 @@ bool cSocket::Connect( LPCSTR pPort )
       return false;
    }
 
+   // Reads are serviced by the thread shared by all sockets
+   mpStaging = new BYTE[SOCKET_STAGING_SIZE];
+   if (GetSocketService().Register( this ) == false)
+   {
+      TRACE( "cSocket::Connect() unable to register socket\n" );
+
+      Disconnect();
+      return false;
+   }
+
    // Success!
    return true;
 }
@@ -528,14 +320,8 @@ int cSocket::SendCtl(
       return rc;
    }
 
-   if (mpRxCallback == 0)
-   {
-      // No one is currently reading, need to trigger a read
-      // so our data can be recieved
-      RxData( &msg[0], sizeof( msg ), 0 );
-   }
-
-   // Wait for the response (10s timeout)
+   // Wait for the response (10s timeout), the socket service handles 
+   // control responses whether or not anyone is reading
    DWORD val;
    rc = mCtrlMsgComplete.Wait( 10000, val );
    if (rc != 0)
@@ -574,37 +360,24 @@ bool cSocket::Disconnect()
    // Assume success
    bool bRC = true;
 
-   if (mCommandPipe[WRITING] != INVALID_HANDLE_VALUE)
+   if (mSocket != INVALID_HANDLE_VALUE)
    {
-      if (mRxThreadID != 0)
-      {
-         // Notify the thread to exit
-         BYTE byte = EXIT_CMD;
-         write( mCommandPipe[WRITING], &byte, 1 );
+      // Waits for any read completion in progress
+      GetSocketService().Unregister( this );
 
-         // And wait for it
-         int nRC = pthread_join( mRxThreadID, 0 );
-         if (nRC != 0)
-         {
-            TRACE( "failed to join thread %d\n", nRC );
-            bRC = false;
-         }
-
-         mRxThreadID = 0;
-      }
-
-      close( mCommandPipe[WRITING] );
-      close( mCommandPipe[READING] );
-      mCommandPipe[READING] = INVALID_HANDLE_VALUE;
-      mCommandPipe[WRITING] = INVALID_HANDLE_VALUE;
+      close( mSocket );
+      mSocket = INVALID_HANDLE_VALUE;
    }
 
-   if (mSocket != INVALID_HANDLE_VALUE)
+   if (mpStaging != 0)
    {
-      close( mSocket );
-      mSocket = INVALID_HANDLE_VALUE;
+      delete [] mpStaging;
+      mpStaging = 0;
    }
 
+   mStageStart = 0;
+   mStageEnd = 0;
+
    // Double check
    mpRxCallback = 0;
 
@@ -653,29 +426,15 @@ RETURN VALUE:
 ===========================================================================*/
 bool cSocket::CancelRx()
 {
-   if (mSocket == INVALID_HANDLE_VALUE
-   ||  mCommandPipe[WRITING] == INVALID_HANDLE_VALUE
-   ||  mpRxCallback == 0
-   ||  mRxThreadID == 0)
+   if (mSocket == INVALID_HANDLE_VALUE)
    {
-      TRACE( "cannot cancel, thread not active\n" );
+      TRACE( "cannot cancel, not connected\n" );
       mpRxCallback = 0;
       return false;
    }
 
-   // Notify the thread to stop reading
-   BYTE byte = STOP_READ_CMD;
-   int nRC = write( mCommandPipe[WRITING], &byte, 1 );
-   if (nRC != 1)
-   {
-      TRACE( "error %d canceling read\n", nRC );
-      return false;
-   }
-   
    // Remove the old callback
-   mpRxCallback = 0;
-
-   return true;
+   return GetSocketService().CancelRead( this );
 }
 
 /*===========================================================================
@@ -721,36 +480,13 @@ bool cSocket::RxData(
    ULONG                      bufSz,
    cIOCallback *              pCallback )
 {
-   if (IsValid() == false || mpRxCallback != 0)
+   if (IsValid() == false || mSocket == INVALID_HANDLE_VALUE)
    {
       return false;
    }
 
-   if (pCallback == 0)
-   {
-      // Not interested in being notified, but we still need a value
-      // for this so that only one outstanding I/O operation is active
-      // at any given point in time
-      mpRxCallback = (cIOCallback * )1;
-   }
-   else
-   {
-      mpRxCallback = pCallback;
-   }
-
-   mpBuffer = pBuf;
-   mBuffSz = bufSz;
-
-   // Notify the thread to start reading
-   BYTE byte = START_READ_CMD;
-   int nRC = write( mCommandPipe[WRITING], &byte, 1 );
-   if (nRC != 1)
-   {
-      TRACE( "error %d starting read\n", nRC );
-      return false;
-   }
-
-   return true;
+   // The read is completed from the socket service thread
+   return GetSocketService().Read( this, pBuf, bufSz, pCallback );
 }
 
 /*===========================================================================
@@ -785,16 +521,12 @@ bool cSocket::TxData(
 
    // Format the header
    int totalSz = sizeof( sQMUXDHeader ) + bufSz;
-   BYTE * pMsg = new BYTE[totalSz];
-   if (pMsg == 0)
-   {
-      TRACE( "unable to allocate buffer\n" );
-      return false;
-   }
-   memset( pMsg, 0, totalSz );
+
+   sQMUXDHeader hdr;
+   memset( &hdr, 0, sizeof( hdr ) );
 
    // The important QMUXD header values
-   sQMUXDHeader * pHdr = (sQMUXDHeader *)pMsg;
+   sQMUXDHeader * pHdr = &hdr;
    pHdr->mTotalSize = totalSz;
    pHdr->mQMUXDClientID = mQMUXDClientID;
    pHdr->mQMUXDMsgID = eQMUXD_MSG_WRITE_QMI_SDU;
@@ -812,18 +544,51 @@ bool cSocket::TxData(
    pHdr->mQMUXServiceID = mQMUXServiceID;
    pHdr->mQMUXClientID = mQMUXClientID;
 
-   // The data payload
-   memcpy( &pMsg[sizeof( sQMUXDHeader )], pBuf, bufSz );
+   // Send the header and the data payload in place
+   struct iovec iov[2];
+   iov[0].iov_base = (void *)pHdr;
+   iov[0].iov_len = sizeof( sQMUXDHeader );
+   iov[1].iov_base = (void *)pBuf;
+   iov[1].iov_len = bufSz;
 
-   // Send the message
-   int nRet = send( mSocket, pMsg, totalSz, 0 );
-   delete [] pMsg;
-   if (nRet != totalSz)
+   struct msghdr msg;
+   memset( &msg, 0, sizeof( msg ) );
+   msg.msg_iov = &iov[0];
+   msg.msg_iovlen = 2;
+
+   int sent = 0;
+   while (sent < totalSz)
    {
-      TRACE( "cSocket::TxData() write returned %d instead of %d\n",
-             nRet,
-             totalSz );
-      return false;
+      ssize_t nRet = sendmsg( mSocket, &msg, MSG_NOSIGNAL );
+      if (nRet < 0 && errno == EINTR)
+      {
+         continue;
+      }
+
+      if (nRet <= 0)
+      {
+         TRACE( "cSocket::TxData() write returned %d after %d of %d\n",
+                (int)nRet,
+                sent,
+                totalSz );
+         return false;
+      }
+
+      // Skip what has been sent (a stream socket may take less)
+      sent += (int)nRet;
+      while (nRet > 0 && msg.msg_iovlen > 0)
+      {
+         size_t len = std::min( (size_t)nRet, msg.msg_iov->iov_len );
+         msg.msg_iov->iov_base = (BYTE *)msg.msg_iov->iov_base + len;
+         msg.msg_iov->iov_len -= len;
+         nRet -= len;
+
+         if (msg.msg_iov->iov_len == 0)
+         {
+            msg.msg_iov++;
+            msg.msg_iovlen--;
+         }
+      }
    }
 
 #ifdef DEBUG
@@ -58,6 +58,53 @@ enum eQMUXDMessageTypes
    eQMUXD_MSG_RELEASE_QMI_CLIENT_ID = 2,
 };
 
+/*=========================================================================*/
+// struct sQMUXDHeader
+/*=========================================================================*/
+#pragma pack( push, 1 )
+
+struct sQMUXDHeader
+{
+   /* Total size of header and following buffer */
+   int mTotalSize;
+
+   /* QMUXD client ID */
+   int mQMUXDClientID;
+
+   /* Message type */
+   eQMUXDMessageTypes mQMUXDMsgID;
+   
+   /* Duplicate of mQMUXDClientID */
+   int mQMUXDClientIDDuplicate;
+   
+   /* Transaction ID */
+   unsigned long mTxID;
+
+   /* System error code */
+   int mSysErrCode;
+
+   /* QMI error code (duplicate of TLV 0x02) */
+   int mQmiErrCode;
+
+   /* SMD channel.  0 = SMD_DATA_5 */
+   int mQMUXDConnectionType;
+   
+   /* QMI service ID */
+   int mQMUXServiceID;
+
+   /* QMI client ID */
+   unsigned char mQMUXClientID;
+
+   /* QMI flags */
+   unsigned char mRxFlags;
+
+   /* In QMUXD this struct is not packed, so the compiler appends
+      these two bytes */
+   unsigned short int mMissing2Bytes;
+};
+
+#pragma pack( pop )
+
 /*=========================================================================*/
 // Class cSocket
 /*=========================================================================*/
@@ -136,11 +183,18 @@ class cSocket : public cConnection
       /* Buffer size */
       ULONG mBuffSz;
 
-      /* Pipe for comunication with thread */
-      int mCommandPipe[2];
+      /* Receive staging buffer (SOCKET_STAGING_SIZE bytes) */
+      BYTE * mpStaging;
+
+      /* Staged data not yet handled (start and end offsets) */
+      ULONG mStageStart;
+      ULONG mStageEnd;
+
+      /* Is the socket service watching for data? */
+      bool mbWatching;
 
-      /* Thread ID of Rx Thread. */
-      pthread_t mRxThreadID;
+      /* Has the connection failed? */
+      bool mbFailed;
 
       /* Control message completion event */
       cEvent mCtrlMsgComplete;
@@ -158,6 +212,6 @@ class cSocket : public cConnection
       /* The SMD transaction ID */
       int mQMUXDTxID;
 
-      // Rx thread is allowed complete access
-      friend void * RxSocketThread( void * pData );
+      // Socket service is allowed complete access
+      friend class cSocketService;
 };
@@ -0,0 +1,752 @@
+/*===========================================================================
+FILE:
+   SocketService.cpp
+
+DESCRIPTION:
+   Implementation of cSocketService class
+
+PUBLIC CLASSES AND METHODS:
+   cSocketService
+      This class services the reads of all qmuxd sockets from one thread
+
+
+Copyright (c) 2013, The Linux Foundation. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of The Linux Foundation nor the names of its
+      contributors may be used to endorse or promote products derived from 
+      this software without specific prior written permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "StdAfx.h"
+#include "SocketService.h"
+#include "Socket.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+
+/*=========================================================================*/
+// Free Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   SocketServiceThread (Free Method)
+
+DESCRIPTION:
+   Thread reading all registered sockets
+
+PARAMETERS:
+   pData      [ I ]   cSocketService pointer
+
+RETURN VALUE:
+   void * - thread exit value (always 0)
+===========================================================================*/
+void * SocketServiceThread( void * pData )
+{
+   cSocketService * pSvc = (cSocketService *)pData;
+   if (pSvc == 0)
+   {
+      return 0;
+   }
+
+   struct epoll_event evts[SOCKET_SERVICE_EVENTS];
+   while (true)
+   {
+      int count = epoll_wait( pSvc->mEpollFD, 
+                              &evts[0], 
+                              (int)SOCKET_SERVICE_EVENTS, 
+                              -1 );
+      if (count < 0)
+      {
+         if (errno == EINTR)
+         {
+            continue;
+         }
+
+         TRACE( "error %d in epoll_wait\n", errno );
+         break;
+      }
+
+      pthread_mutex_lock( &pSvc->mMutex );
+      if (pSvc->mbExiting == true)
+      {
+         pthread_mutex_unlock( &pSvc->mMutex );
+         break;
+      }
+
+      // Read everything that is available first
+      for (int e = 0; e < count; e++)
+      {
+         cSocket * pSocket = (cSocket *)evts[e].data.ptr;
+         if (pSocket == 0)
+         {
+            eventfd_t val;
+            eventfd_read( pSvc->mWakeFD, &val );
+         }
+         else if (pSvc->mSockets.find( pSocket ) != pSvc->mSockets.end())
+         {
+            pSvc->Fill( pSocket );
+            pSvc->mArmed.insert( pSocket );
+         }
+      }
+
+      // Then hand out the messages
+      while (pSvc->mArmed.size() > 0)
+      {
+         cSocket * pSocket = *pSvc->mArmed.begin();
+         pSvc->mArmed.erase( pSvc->mArmed.begin() );
+
+         if (pSvc->mSockets.find( pSocket ) != pSvc->mSockets.end())
+         {
+            pSvc->Dispatch( pSocket );
+         }
+      }
+
+      pthread_mutex_unlock( &pSvc->mMutex );
+   }
+
+   return 0;
+}
+
+/*===========================================================================
+METHOD:
+   GetSocketService (Free Method)
+
+DESCRIPTION:
+   Return the service shared by all sockets
+
+RETURN VALUE:
+   cSocketService &
+===========================================================================*/
+cSocketService & GetSocketService()
+{
+   static cSocketService sService;
+   return sService;
+}
+
+/*=========================================================================*/
+// cSocketService Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   cSocketService (Public Method)
+
+DESCRIPTION:
+   Constructor
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+cSocketService::cSocketService()
+   :  mEpollFD( INVALID_HANDLE_VALUE ),
+      mWakeFD( INVALID_HANDLE_VALUE ),
+      mThreadID( 0 ),
+      mbRunning( false ),
+      mbExiting( false ),
+      mpDispatching( 0 )
+{
+   pthread_mutex_init( &mMutex, 0 );
+   pthread_cond_init( &mDispatchDone, 0 );
+}
+
+/*===========================================================================
+METHOD:
+   ~cSocketService (Public Method)
+
+DESCRIPTION:
+   Destructor
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+cSocketService::~cSocketService()
+{
+   Exit();
+
+   pthread_cond_destroy( &mDispatchDone );
+   pthread_mutex_destroy( &mMutex );
+}
+
+/*===========================================================================
+METHOD:
+   Register (Public Method)
+
+DESCRIPTION:
+   Add a (connected) socket to the service, starting the service thread 
+   upon first use.  Data is read once a read is started (see Read())
+
+PARAMETERS:
+   pSocket     [ I ] - Socket
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cSocketService::Register( cSocket * pSocket )
+{
+   if (pSocket == 0 || pSocket->mSocket == INVALID_HANDLE_VALUE)
+   {
+      return false;
+   }
+
+   pthread_mutex_lock( &mMutex );
+
+   bool bRC = Start();
+   if (bRC == true && mSockets.find( pSocket ) == mSockets.end())
+   {
+      pSocket->mStageStart = 0;
+      pSocket->mStageEnd = 0;
+      pSocket->mbWatching = true;
+      pSocket->mbFailed = false;
+
+      struct epoll_event evt;
+      memset( &evt, 0, sizeof( evt ) );
+      evt.events = EPOLLIN;
+      evt.data.ptr = pSocket;
+
+      int nRet = epoll_ctl( mEpollFD, EPOLL_CTL_ADD, pSocket->mSocket, &evt );
+      if (nRet != 0)
+      {
+         TRACE( "cSocketService::Register() epoll_ctl = %d\n", errno );
+         bRC = false;
+      }
+      else
+      {
+         mSockets.insert( pSocket );
+      }
+   }
+
+   pthread_mutex_unlock( &mMutex );
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   Unregister (Public Method)
+
+DESCRIPTION:
+   Remove a socket from the service, waiting for any read completion of 
+   the socket that is running on the service thread to finish (unless 
+   called from that read completion)
+
+PARAMETERS:
+   pSocket     [ I ] - Socket
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cSocketService::Unregister( cSocket * pSocket )
+{
+   pthread_mutex_lock( &mMutex );
+
+   bool bRC = (mSockets.erase( pSocket ) > 0);
+   if (bRC == true)
+   {
+      mArmed.erase( pSocket );
+      Watch( pSocket, false );
+
+      bool bSelf = (pthread_equal( pthread_self(), mThreadID ) != 0);
+      while (bSelf == false && mpDispatching == pSocket)
+      {
+         pthread_cond_wait( &mDispatchDone, &mMutex );
+      }
+
+      pSocket->mpRxCallback = 0;
+   }
+
+   pthread_mutex_unlock( &mMutex );
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   Read (Public Method)
+
+DESCRIPTION:
+   Start a read on a socket, the next QMI message is delivered to the 
+   given buffer from the service thread
+
+PARAMETERS:
+   pSocket     [ I ] - Socket
+   pBuf        [ I ] - Buffer to contain received data
+   bufSz       [ I ] - Amount of data to be received
+   pCallback   [ I ] - Callback object to be exercised when the
+                       operation completes (0 for none)
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cSocketService::Read(
+   cSocket *                  pSocket,
+   BYTE *                     pBuf, 
+   ULONG                      bufSz,
+   cIOCallback *              pCallback )
+{
+   pthread_mutex_lock( &mMutex );
+
+   // Only one read may be in progress
+   bool bRC = ( (mSockets.find( pSocket ) != mSockets.end())
+            &&  (pSocket->mpRxCallback == 0) );
+   if (bRC == true)
+   {
+      if (pCallback == 0)
+      {
+         // Not interested in being notified, but we still need a value
+         // for this so that only one outstanding I/O operation is active
+         // at any given point in time
+         pSocket->mpRxCallback = (cIOCallback *)1;
+      }
+      else
+      {
+         pSocket->mpRxCallback = pCallback;
+      }
+
+      pSocket->mpBuffer = pBuf;
+      pSocket->mBuffSz = bufSz;
+
+      // A message may already be staged
+      Wake( pSocket );
+   }
+
+   pthread_mutex_unlock( &mMutex );
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   CancelRead (Public Method)
+
+DESCRIPTION:
+   Cancel the read in progress on a socket
+
+PARAMETERS:
+   pSocket     [ I ] - Socket
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cSocketService::CancelRead( cSocket * pSocket )
+{
+   pthread_mutex_lock( &mMutex );
+
+   bool bRC = ( (mSockets.find( pSocket ) != mSockets.end())
+            &&  (pSocket->mpRxCallback != 0) );
+
+   pSocket->mpRxCallback = 0;
+
+   pthread_mutex_unlock( &mMutex );
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   Start (Internal Method)
+
+DESCRIPTION:
+   Start the service thread (if not already running)
+
+SEQUENCING:
+   Calling thread must have mMutex locked
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cSocketService::Start()
+{
+   if (mbRunning == true)
+   {
+      return true;
+   }
+
+   mEpollFD = epoll_create( (int)SOCKET_SERVICE_EVENTS );
+   mWakeFD = eventfd( 0, EFD_NONBLOCK );
+   if (mEpollFD == INVALID_HANDLE_VALUE || mWakeFD == INVALID_HANDLE_VALUE)
+   {
+      TRACE( "cSocketService::Start() unable to create epoll/eventfd\n" );
+   }
+   else
+   {
+      struct epoll_event evt;
+      memset( &evt, 0, sizeof( evt ) );
+      evt.events = EPOLLIN;
+      evt.data.ptr = 0;
+
+      int nRet = epoll_ctl( mEpollFD, EPOLL_CTL_ADD, mWakeFD, &evt );
+      if (nRet == 0)
+      {
+         mbExiting = false;
+         nRet = pthread_create( &mThreadID, 0, SocketServiceThread, this );
+         mbRunning = (nRet == 0);
+      }
+
+      if (mbRunning == false)
+      {
+         TRACE( "cSocketService::Start() failed %d\n", nRet );
+      }
+   }
+
+   if (mbRunning == false)
+   {
+      if (mEpollFD != INVALID_HANDLE_VALUE)
+      {
+         close( mEpollFD );
+         mEpollFD = INVALID_HANDLE_VALUE;
+      }
+
+      if (mWakeFD != INVALID_HANDLE_VALUE)
+      {
+         close( mWakeFD );
+         mWakeFD = INVALID_HANDLE_VALUE;
+      }
+   }
+
+   return mbRunning;
+}
+
+/*===========================================================================
+METHOD:
+   Exit (Internal Method)
+
+DESCRIPTION:
+   Exit the service thread
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cSocketService::Exit()
+{
+   pthread_mutex_lock( &mMutex );
+
+   bool bRunning = mbRunning;
+   mbExiting = true;
+   mbRunning = false;
+
+   pthread_mutex_unlock( &mMutex );
+
+   if (bRunning == false)
+   {
+      return;
+   }
+
+   eventfd_write( mWakeFD, 1 );
+
+   int nRC = pthread_join( mThreadID, 0 );
+   if (nRC != 0)
+   {
+      TRACE( "failed to join thread %d\n", nRC );
+   }
+
+   close( mEpollFD );
+   close( mWakeFD );
+   mEpollFD = INVALID_HANDLE_VALUE;
+   mWakeFD = INVALID_HANDLE_VALUE;
+   mThreadID = 0;
+
+   mSockets.clear();
+   mArmed.clear();
+}
+
+/*===========================================================================
+METHOD:
+   Fill (Internal Method)
+
+DESCRIPTION:
+   Read what is available on a socket into its staging buffer, a single
+   read picks up as many messages as are queued (and fit)
+
+PARAMETERS:
+   pSocket     [ I ] - Socket
+
+SEQUENCING:
+   Calling thread must have mMutex locked
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cSocketService::Fill( cSocket * pSocket )
+{
+   BYTE * pStaging = pSocket->mpStaging;
+
+   // Move what is left to the front
+   if (pSocket->mStageStart > 0)
+   {
+      ULONG staged = pSocket->mStageEnd - pSocket->mStageStart;
+      memmove( pStaging, pStaging + pSocket->mStageStart, staged );
+
+      pSocket->mStageStart = 0;
+      pSocket->mStageEnd = staged;
+   }
+
+   ULONG space = SOCKET_STAGING_SIZE - pSocket->mStageEnd;
+   if (space == 0)
+   {
+      Watch( pSocket, false );
+      return;
+   }
+
+   ssize_t n = recv( pSocket->mSocket, 
+                     pStaging + pSocket->mStageEnd, 
+                     space, 
+                     MSG_DONTWAIT );
+   if (n > 0)
+   {
+      pSocket->mStageEnd += (ULONG)n;
+   }
+   else if (n == 0 || (errno != EAGAIN && errno != EINTR))
+   {
+      // The connection is gone
+      TRACE( "recv error %d\n", (n == 0 ? 0 : errno) );
+      pSocket->mbFailed = true;
+      Watch( pSocket, false );
+   }
+}
+
+/*===========================================================================
+METHOD:
+   Dispatch (Internal Method)
+
+DESCRIPTION:
+   Handle the staged messages of a socket: control message responses are
+   handled as soon as they are staged while QMI messages are delivered in
+   order, one per read
+
+PARAMETERS:
+   pSocket     [ I ] - Socket
+
+SEQUENCING:
+   Calling thread must have mMutex locked (it is released while the
+   read completion runs)
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cSocketService::Dispatch( cSocket * pSocket )
+{
+   const ULONG hdrSz = (ULONG)sizeof( sQMUXDHeader );
+
+   // Messages are handled in order, except that control responses may 
+   // skip ahead of QMI messages that are waiting for a read
+   ULONG offset = pSocket->mStageStart;
+   while (pSocket->mbFailed == false)
+   {
+      BYTE * pMsg = pSocket->mpStaging + offset;
+      ULONG staged = pSocket->mStageEnd - offset;
+      if (staged < hdrSz)
+      {
+         break;
+      }
+
+      sQMUXDHeader hdr;
+      memcpy( &hdr, pMsg, hdrSz );
+      if ( (hdr.mTotalSize < 0)
+      ||   ((ULONG)hdr.mTotalSize < hdrSz)
+      ||   ((ULONG)hdr.mTotalSize > SOCKET_STAGING_SIZE) )
+      {
+         // There is no way to find the next message
+         TRACE( "bad message size %d\n", hdr.mTotalSize );
+         pSocket->mbFailed = true;
+         break;
+      }
+
+      ULONG msgSz = (ULONG)hdr.mTotalSize;
+      if (staged < msgSz)
+      {
+         break;
+      }
+
+      ULONG payloadSz = msgSz - hdrSz;
+      if (hdr.mQMUXDMsgID != eQMUXD_MSG_WRITE_QMI_SDU)
+      {
+         // Notify SendCtl() that control message completed
+         DWORD val = 0;
+         if ( (hdr.mQMUXDMsgID == eQMUXD_MSG_ALLOC_QMI_CLIENT_ID)
+         &&   (payloadSz >= 4) )
+         {
+            memcpy( &val, pMsg + hdrSz, 4 );
+         }
+
+         pSocket->mCtrlMsgComplete.Set( val );
+      }
+      else if (offset != pSocket->mStageStart)
+      {
+         // Looking ahead for control responses, leave this one be
+         offset += msgSz;
+         continue;
+      }
+      else if (pSocket->mpRxCallback == 0)
+      {
+         // Nobody is reading yet, look ahead for control responses
+         offset += msgSz;
+         continue;
+      }
+      else
+      {
+         cIOCallback * pCallback = pSocket->mpRxCallback;
+         pSocket->mpRxCallback = 0;
+
+         bool bFits = (payloadSz <= pSocket->mBuffSz);
+         if (bFits == true)
+         {
+            memcpy( pSocket->mpBuffer, pMsg + hdrSz, payloadSz );
+         }
+         else
+         {
+            TRACE( "read too large for buffer\n" );
+         }
+
+         pSocket->mStageStart += msgSz;
+         offset = pSocket->mStageStart;
+
+         if (pCallback == (cIOCallback *)1)
+         {
+            // We wanted to read, but not to be notified
+            continue;
+         }
+
+         // The completion usually starts the next read
+         mpDispatching = pSocket;
+         pthread_mutex_unlock( &mMutex );
+
+         if (bFits == true)
+         {
+            pCallback->IOComplete( 0, payloadSz );
+         }
+         else
+         {
+            pCallback->IOComplete( (DWORD)-EMSGSIZE, 0 );
+         }
+
+         pthread_mutex_lock( &mMutex );
+         mpDispatching = 0;
+         pthread_cond_broadcast( &mDispatchDone );
+
+         if (mSockets.find( pSocket ) == mSockets.end())
+         {
+            // Removed by the completion
+            return;
+         }
+
+         offset = pSocket->mStageStart;
+         continue;
+      }
+
+      // Remove the control response
+      if (offset == pSocket->mStageStart)
+      {
+         pSocket->mStageStart += msgSz;
+         offset = pSocket->mStageStart;
+      }
+      else
+      {
+         memmove( pMsg, pMsg + msgSz, pSocket->mStageEnd - offset - msgSz );
+         pSocket->mStageEnd -= msgSz;
+      }
+   }
+
+   if (pSocket->mStageStart == pSocket->mStageEnd)
+   {
+      pSocket->mStageStart = 0;
+      pSocket->mStageEnd = 0;
+   }
+
+   // Keep reading as long as there is room
+   bool bRoom = (pSocket->mStageEnd - pSocket->mStageStart) 
+              < SOCKET_STAGING_SIZE;
+
+   Watch( pSocket, (pSocket->mbFailed == false && bRoom == true) );
+}
+
+/*===========================================================================
+METHOD:
+   Watch (Internal Method)
+
+DESCRIPTION:
+   Watch (or stop watching) a socket for data
+
+PARAMETERS:
+   pSocket     [ I ] - Socket
+   bWatch      [ I ] - Watch for data?
+
+SEQUENCING:
+   Calling thread must have mMutex locked
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cSocketService::Watch( 
+   cSocket *                  pSocket,
+   bool                       bWatch )
+{
+   if (pSocket->mbWatching == bWatch)
+   {
+      return;
+   }
+
+   // The socket is removed rather than given an empty event set, which 
+   // would still report a hang up over and over again
+   struct epoll_event evt;
+   memset( &evt, 0, sizeof( evt ) );
+   evt.events = EPOLLIN;
+   evt.data.ptr = pSocket;
+
+   int op = (bWatch == true ? EPOLL_CTL_ADD : EPOLL_CTL_DEL);
+   int nRet = epoll_ctl( mEpollFD, op, pSocket->mSocket, &evt );
+   if (nRet != 0)
+   {
+      TRACE( "cSocketService::Watch() epoll_ctl = %d\n", errno );
+      return;
+   }
+
+   pSocket->mbWatching = bWatch;
+}
+
+/*===========================================================================
+METHOD:
+   Wake (Internal Method)
+
+DESCRIPTION:
+   Have the service thread look at a socket
+
+PARAMETERS:
+   pSocket     [ I ] - Socket
+
+SEQUENCING:
+   Calling thread must have mMutex locked
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cSocketService::Wake( cSocket * pSocket )
+{
+   mArmed.insert( pSocket );
+
+   // No need when called from a read completion
+   if (pthread_equal( pthread_self(), mThreadID ) == 0)
+   {
+      eventfd_write( mWakeFD, 1 );
+   }
+}
@@ -0,0 +1,155 @@
+/*===========================================================================
+FILE:
+   SocketService.h
+
+DESCRIPTION:
+   Declaration of cSocketService class
+
+PUBLIC CLASSES AND METHODS:
+   cSocketService
+      This class services the reads of all qmuxd sockets from one thread
+
+
+Copyright (c) 2013, The Linux Foundation. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of The Linux Foundation nor the names of its
+      contributors may be used to endorse or promote products derived from 
+      this software without specific prior written permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include <pthread.h>
+#include <set>
+
+//---------------------------------------------------------------------------
+// Pragmas
+//---------------------------------------------------------------------------
+#pragma once
+
+//---------------------------------------------------------------------------
+// Forward Declarations
+//---------------------------------------------------------------------------
+class cSocket;
+class cIOCallback;
+
+//---------------------------------------------------------------------------
+// Definitions
+//---------------------------------------------------------------------------
+
+// Size of the per socket receive staging buffer (largest qmuxd message)
+const ULONG SOCKET_STAGING_SIZE = 64 * 1024;
+
+// Maximum number of socket events handled per wait
+const ULONG SOCKET_SERVICE_EVENTS = 32;
+
+/*=========================================================================*/
+// Class cSocketService
+//
+//    Single epoll driven thread reading every registered qmuxd socket,
+//    each read drains as much of the socket as fits in its staging buffer
+//    and the messages are then split out of that buffer
+/*=========================================================================*/
+class cSocketService
+{
+   public:
+      // Constructor
+      cSocketService();
+
+      // Destructor
+      ~cSocketService();
+
+      // Add a (connected) socket to the service
+      bool Register( cSocket * pSocket );
+
+      // Remove a socket from the service
+      bool Unregister( cSocket * pSocket );
+
+      // Start a read on a socket
+      bool Read(
+         cSocket *                  pSocket,
+         BYTE *                     pBuf, 
+         ULONG                      bufSz,
+         cIOCallback *              pCallback );
+
+      // Cancel the read in progress on a socket
+      bool CancelRead( cSocket * pSocket );
+
+   protected:
+      // Start the service thread (mutex must be held)
+      bool Start();
+
+      // Exit the service thread
+      void Exit();
+
+      // Read what is available on a socket
+      void Fill( cSocket * pSocket );
+
+      // Handle the staged messages of a socket (mutex must be held)
+      void Dispatch( cSocket * pSocket );
+
+      // Watch (or stop watching) a socket for data (mutex must be held)
+      void Watch( 
+         cSocket *                  pSocket,
+         bool                       bWatch );
+
+      // Have the service thread look at a socket (mutex must be held)
+      void Wake( cSocket * pSocket );
+
+      /* epoll instance watching all registered sockets */
+      int mEpollFD;
+
+      /* eventfd used to wake the service thread */
+      int mWakeFD;
+
+      /* ID of service thread */
+      pthread_t mThreadID;
+
+      /* Is the service thread running? */
+      bool mbRunning;
+
+      /* Is the service thread exiting? */
+      bool mbExiting;
+
+      /* Registered sockets */
+      std::set <cSocket *> mSockets;
+
+      /* Sockets with staged messages or a changed read state */
+      std::set <cSocket *> mArmed;
+
+      /* Socket whose read completion is currently running */
+      cSocket * mpDispatching;
+
+      /* Mutex protecting all of the above and the socket read state */
+      pthread_mutex_t mMutex;
+
+      /* Signalled when a read completion finishes */
+      pthread_cond_t mDispatchDone;
+
+      // Service thread gets full access
+      friend void * SocketServiceThread( void * pData );
+};
+
+// Return the service shared by all sockets
+cSocketService & GetSocketService();
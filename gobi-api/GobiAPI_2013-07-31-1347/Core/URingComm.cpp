@@ -0,0 +1,338 @@
+/*===========================================================================
+FILE:
+   URingComm.cpp
+
+DESCRIPTION:
+   Implementation of cURingComm class
+
+PUBLIC CLASSES AND METHODS:
+   cURingComm
+      This class wraps low level port communications performed through
+      io_uring
+
+Copyright (c) 2013, The Linux Foundation. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of The Linux Foundation nor the names of its
+      contributors may be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "StdAfx.h"
+#include "URingComm.h"
+#include "URingService.h"
+
+/*=========================================================================*/
+// cURingComm Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   cURingComm (Public Method)
+
+DESCRIPTION:
+   Constructor
+
+RETURN VALUE:
+   None
+===========================================================================*/
+cURingComm::cURingComm()
+   :  mPortName( "" ),
+      mPort( INVALID_HANDLE_VALUE ),
+      mpBuffer( 0 ),
+      mBuffSz( 0 )
+{
+   // Nothing to do
+}
+
+/*===========================================================================
+METHOD:
+   ~cURingComm (Public Method)
+
+DESCRIPTION:
+   Destructor
+
+RETURN VALUE:
+   None
+===========================================================================*/
+cURingComm::~cURingComm()
+{
+   // Disconnect from current port
+   Disconnect();
+}
+
+/*===========================================================================
+METHOD:
+   IsSupported (Static Public Method)
+
+DESCRIPTION:
+   Can io_uring connections be used on this system?  Sets up the shared
+   ring upon first use
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cURingComm::IsSupported()
+{
+   return GetURingService().IsAvailable();
+}
+
+/*===========================================================================
+METHOD:
+   IsValid (Public Method)
+
+DESCRIPTION:
+   Is this object valid?
+
+RETURN VALUE:
+   Bool
+===========================================================================*/
+bool cURingComm::IsValid()
+{
+   // Nothing to do, dependant on extended class functionality
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   Connect (Public Method)
+
+DESCRIPTION:
+   Connect to the specified port
+
+PARAMETERS:
+   pPort       [ I ] - Name of port to open (IE: /dev/qcqmi0)
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cURingComm::Connect( LPCSTR pPort )
+{
+   if (IsValid() == false || pPort == 0 || pPort[0] == 0)
+   {
+      return false;
+   }
+
+   if (mPort != INVALID_HANDLE_VALUE)
+   {
+      Disconnect();
+   }
+
+   // Opening the com port
+   mPort = open( pPort, O_RDWR );
+   if (mPort == INVALID_HANDLE_VALUE)
+   {
+      return false;
+   }
+
+   // Reading starts right away
+   if (GetURingService().Register( this ) == false)
+   {
+      TRACE( "cURingComm::Connect() unable to register %s\n", pPort );
+
+      Disconnect();
+      return false;
+   }
+
+   // Save port name
+   mPortName = pPort;
+
+   // Success!
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   SendCtl (Public Method)
+
+DESCRIPTION:
+   Run an IOCTL on the open file handle
+
+PARAMETERS:
+   ioctlReq [ I ] - ioctl request value
+   pData    [I/O] - input or output specific to ioctl request value
+
+RETURN VALUE:
+   int - ioctl return value (0 for success)
+===========================================================================*/
+int cURingComm::SendCtl(
+   UINT     ioctlReq,
+   void *   pData )
+{
+   if (mPort == INVALID_HANDLE_VALUE)
+   {
+      TRACE( "Invalid file handle\n" );
+      return -EBADFD;
+   }
+
+   return ioctl( mPort, ioctlReq, pData );
+}
+
+/*===========================================================================
+METHOD:
+   Disconnect (Public Method)
+
+DESCRIPTION:
+   Disconnect from the current port
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cURingComm::Disconnect()
+{
+   if (mPort != INVALID_HANDLE_VALUE)
+   {
+      // Any read still submitted holds its own reference to the port
+      GetURingService().Unregister( this );
+
+      close( mPort );
+      mPort = INVALID_HANDLE_VALUE;
+   }
+
+   // Double check
+   mpRxCallback = 0;
+
+   mPortName.clear();
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   CancelIO (Public Method)
+
+DESCRIPTION:
+   Cancel any in-progress I/O
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cURingComm::CancelIO()
+{
+   if (mPort == INVALID_HANDLE_VALUE)
+   {
+      return false;
+   }
+
+   bool bRxCancel = CancelRx();
+   bool bTxCancel = CancelTx();
+
+   return (bRxCancel && bTxCancel);
+}
+
+/*===========================================================================
+METHOD:
+   CancelRx (Public Method)
+
+DESCRIPTION:
+   Cancel any in-progress receive operation
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cURingComm::CancelRx()
+{
+   if (mPort == INVALID_HANDLE_VALUE)
+   {
+      mpRxCallback = 0;
+      return false;
+   }
+
+   return GetURingService().CancelRead( this );
+}
+
+/*===========================================================================
+METHOD:
+   CancelTx (Public Method)
+
+DESCRIPTION:
+   Cancel any in-progress transmit operation
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cURingComm::CancelTx()
+{
+   if (mPort == INVALID_HANDLE_VALUE)
+   {
+      return false;
+   }
+
+   return GetURingService().CancelWrite( this );
+}
+
+/*===========================================================================
+METHOD:
+   RxData (Public Method)
+
+DESCRIPTION:
+   Receive data
+
+PARAMETERS:
+   pBuf        [ I ] - Buffer to contain received data
+   bufSz       [ I ] - Amount of data to be received
+   pCallback   [ I ] - Callback object to be exercised when the
+                       operation completes
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cURingComm::RxData(
+   BYTE *                     pBuf,
+   ULONG                      bufSz,
+   cIOCallback *              pCallback )
+{
+   if (IsValid() == false || mPort == INVALID_HANDLE_VALUE)
+   {
+      return false;
+   }
+
+   return GetURingService().Read( this, pBuf, bufSz, pCallback );
+}
+
+/*===========================================================================
+METHOD:
+   TxData (Public Method)
+
+DESCRIPTION:
+   Transmit data
+
+PARAMETERS:
+   pBuf        [ I ] - Data to be transmitted
+   bufSz       [ I ] - Amount of data to be transmitted
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cURingComm::TxData(
+   const BYTE *               pBuf,
+   ULONG                      bufSz )
+{
+   if (IsValid() == false || mPort == INVALID_HANDLE_VALUE)
+   {
+      return false;
+   }
+
+   return GetURingService().Write( this, pBuf, bufSz );
+}
@@ -0,0 +1,129 @@
+/*===========================================================================
+FILE:
+   URingComm.h
+
+DESCRIPTION:
+   Declaration of cURingComm class
+
+PUBLIC CLASSES AND METHODS:
+   cURingComm
+      This class wraps low level port communications performed through
+      io_uring
+
+Copyright (c) 2013, The Linux Foundation. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of The Linux Foundation nor the names of its
+      contributors may be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "Connection.h"
+
+//---------------------------------------------------------------------------
+// Pragmas
+//---------------------------------------------------------------------------
+#pragma once
+
+/*=========================================================================*/
+// Class cURingComm
+//
+//    Device node connection whose I/O is performed by the shared io_uring
+//    of cURingService, an alternative to cComm on kernels with io_uring
+/*=========================================================================*/
+class cURingComm : public cConnection
+{
+   public:
+      // Constructor
+      cURingComm();
+
+      // Destructor
+      ~cURingComm();
+
+      // Can io_uring connections be used on this system?
+      static bool IsSupported();
+
+      // Is this object valid?
+      bool IsValid();
+
+      // Connect to the specified port
+      bool Connect( LPCSTR pPort );
+
+      // Run an IOCTL on the open file handle
+      int SendCtl(
+         UINT     ioctlReq,
+         void *   pData );
+
+      // Disconnect from the current port
+      bool Disconnect();
+
+      // Cancel any in-progress I/O
+      bool CancelIO();
+
+      // Cancel any in-progress receive operation
+      bool CancelRx();
+
+      // Cancel any in-progress transmit operation
+      bool CancelTx();
+
+      // Receive data
+      bool RxData(
+         BYTE *                     pBuf,
+         ULONG                      bufSz,
+         cIOCallback *              pCallback );
+
+      // Transmit data
+      bool TxData(
+         const BYTE *               pBuf,
+         ULONG                      bufSz );
+
+      // (Inline) Return current port name
+      std::string GetPortName() const
+      {
+         return mPortName;
+      };
+
+      // Are we currently connected to a port?
+      bool IsConnected()
+      {
+         return (mPort != INVALID_HANDLE_VALUE);
+      };
+
+   protected:
+      /* Name of current port */
+      std::string mPortName;
+
+      /* Handle to port */
+      int mPort;
+
+      /* Buffer */
+      BYTE * mpBuffer;
+
+      /* Buffer size */
+      ULONG mBuffSz;
+
+      // The ring service gets full access
+      friend class cURingService;
+};
@@ -0,0 +1,1671 @@
+/*===========================================================================
+FILE:
+   URingService.cpp
+
+DESCRIPTION:
+   Implementation of cURingService class
+
+PUBLIC CLASSES AND METHODS:
+   cURingService
+      This class performs the I/O of all io_uring connections through one
+      ring serviced by one thread
+
+
+Copyright (c) 2013, The Linux Foundation. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of The Linux Foundation nor the names of its
+      contributors may be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "StdAfx.h"
+#include "URingService.h"
+#include "URingComm.h"
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
+//---------------------------------------------------------------------------
+// Definitions
+//---------------------------------------------------------------------------
+
+// io_uring system calls (same numbers on every architecture)
+#ifndef __NR_io_uring_setup
+#define __NR_io_uring_setup      425
+#define __NR_io_uring_enter      426
+#define __NR_io_uring_register   427
+#endif
+
+// Multishot read (Linux 6.7), not known to most installed headers
+const BYTE URING_OP_READ_MULTISHOT = 49;
+
+// Completion tags, the operation is kept in the low byte of the user data
+// and the port slot above it
+enum eURingTag
+{
+   eURING_TAG_WAKE = 0,
+   eURING_TAG_READ = 1,
+   eURING_TAG_WRITE = 2,
+   eURING_TAG_IGNORE = 3
+};
+
+/*=========================================================================*/
+// Free Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   URingEnter (Free Method)
+
+DESCRIPTION:
+   Submit queued entries and/or wait for completions
+
+PARAMETERS:
+   ringFD      [ I ] - io_uring instance
+   toSubmit    [ I ] - Number of entries to submit
+   minComplete [ I ] - Number of completions to wait for
+   flags       [ I ] - IORING_ENTER_* flags
+
+RETURN VALUE:
+   int - number of entries submitted (-1 on error, see errno)
+===========================================================================*/
+static int URingEnter(
+   int                        ringFD,
+   unsigned                   toSubmit,
+   unsigned                   minComplete,
+   unsigned                   flags )
+{
+   return (int)syscall( __NR_io_uring_enter,
+                        ringFD,
+                        toSubmit,
+                        minComplete,
+                        flags,
+                        0,
+                        0 );
+}
+
+/*===========================================================================
+METHOD:
+   URingRegister (Free Method)
+
+DESCRIPTION:
+   Register (or unregister) resources with a ring
+
+PARAMETERS:
+   ringFD      [ I ] - io_uring instance
+   opcode      [ I ] - IORING_(UN)REGISTER_* operation
+   pArg        [I/O] - Operation argument
+   nrArgs      [ I ] - Number of arguments
+
+RETURN VALUE:
+   int - 0 (or a positive value) on success, -1 on error, see errno
+===========================================================================*/
+static int URingRegister(
+   int                        ringFD,
+   unsigned                   opcode,
+   void *                     pArg,
+   unsigned                   nrArgs )
+{
+   return (int)syscall( __NR_io_uring_register,
+                        ringFD,
+                        opcode,
+                        pArg,
+                        nrArgs );
+}
+
+/*===========================================================================
+METHOD:
+   IsOpSupported (Free Method)
+
+DESCRIPTION:
+   Is an operation reported as supported by a ring probe?
+
+PARAMETERS:
+   pProbe      [ I ] - Probe results
+   op          [ I ] - IORING_OP_* operation
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+static bool IsOpSupported(
+   const io_uring_probe *     pProbe,
+   BYTE                       op )
+{
+   if (op > pProbe->last_op || op >= pProbe->ops_len)
+   {
+      return false;
+   }
+
+   return ((pProbe->ops[op].flags & IO_URING_OP_SUPPORTED) != 0);
+}
+
+/*===========================================================================
+METHOD:
+   MakeTag (Free Method)
+
+DESCRIPTION:
+   Return the user data identifying an operation on a port slot
+
+PARAMETERS:
+   slot        [ I ] - Port slot
+   tag         [ I ] - Operation
+
+RETURN VALUE:
+   ULONGLONG
+===========================================================================*/
+static ULONGLONG MakeTag(
+   ULONG                      slot,
+   eURingTag                  tag )
+{
+   return ((ULONGLONG)slot << 8) | (ULONGLONG)tag;
+}
+
+/*===========================================================================
+METHOD:
+   URingServiceThread (Free Method)
+
+DESCRIPTION:
+   Thread reaping the completions of the ring
+
+PARAMETERS:
+   pData      [ I ]   cURingService pointer
+
+RETURN VALUE:
+   void * - thread exit value (always 0)
+===========================================================================*/
+void * URingServiceThread( void * pData )
+{
+   cURingService * pSvc = (cURingService *)pData;
+   if (pSvc == 0)
+   {
+      return 0;
+   }
+
+   io_uring_cqe cqes[URING_CQ_BATCH];
+   while (true)
+   {
+      int nRet = URingEnter( pSvc->mRingFD, 0, 1, IORING_ENTER_GETEVENTS );
+      if (nRet < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+      {
+         TRACE( "error %d in io_uring_enter\n", errno );
+         break;
+      }
+
+      pthread_mutex_lock( &pSvc->mMutex );
+
+      // Handle every completion first, a batch at a time, each batch is
+      // copied out so the completion queue has room again before any of
+      // them is handled (handling may submit more work)
+      while (true)
+      {
+         unsigned head = *pSvc->mpCQHead;
+         unsigned tail = __atomic_load_n( pSvc->mpCQTail, __ATOMIC_ACQUIRE );
+
+         ULONG count = 0;
+         while (head != tail && count < URING_CQ_BATCH)
+         {
+            cqes[count++] = pSvc->mpCQEs[head & pSvc->mCQMask];
+            head++;
+         }
+
+         if (count == 0)
+         {
+            break;
+         }
+
+         __atomic_store_n( pSvc->mpCQHead, head, __ATOMIC_RELEASE );
+         for (ULONG c = 0; c < count; c++)
+         {
+            pSvc->Complete( cqes[c] );
+         }
+      }
+
+      if (pSvc->mbExiting == true)
+      {
+         pthread_mutex_unlock( &pSvc->mMutex );
+         break;
+      }
+
+      // Then hand out the received data
+      while (pSvc->mArmed.size() > 0)
+      {
+         ULONG slot = *pSvc->mArmed.begin();
+         pSvc->mArmed.erase( pSvc->mArmed.begin() );
+
+         pSvc->Dispatch( slot );
+      }
+
+      pthread_mutex_unlock( &pSvc->mMutex );
+   }
+
+   return 0;
+}
+
+/*===========================================================================
+METHOD:
+   GetURingService (Free Method)
+
+DESCRIPTION:
+   Return the service shared by all io_uring connections
+
+RETURN VALUE:
+   cURingService &
+===========================================================================*/
+cURingService & GetURingService()
+{
+   static cURingService sService;
+   return sService;
+}
+
+/*=========================================================================*/
+// cURingService Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   cURingService (Public Method)
+
+DESCRIPTION:
+   Constructor
+
+RETURN VALUE:
+   None
+===========================================================================*/
+cURingService::cURingService()
+   :  mRingFD( INVALID_HANDLE_VALUE ),
+      mbUnavailable( false ),
+      mbMultishot( false ),
+      mpSQRing( 0 ),
+      mSQRingSz( 0 ),
+      mpCQRing( 0 ),
+      mCQRingSz( 0 ),
+      mpSQEs( 0 ),
+      mSQEsSz( 0 ),
+      mpSQHead( 0 ),
+      mpSQTail( 0 ),
+      mSQMask( 0 ),
+      mSQEntries( 0 ),
+      mSQPending( 0 ),
+      mpCQHead( 0 ),
+      mpCQTail( 0 ),
+      mCQMask( 0 ),
+      mpCQEs( 0 ),
+      mpBuffers( 0 ),
+      mBuffersSz( 0 ),
+      mpBufRings( 0 ),
+      mBufRingSz( 0 ),
+      mThreadID( 0 ),
+      mbRunning( false ),
+      mbExiting( false ),
+      mpDispatching( 0 )
+{
+   memset( &mPorts[0], 0, sizeof( mPorts ) );
+   for (ULONG slot = 0; slot < URING_MAX_PORTS; slot++)
+   {
+      mPorts[slot].mPort = INVALID_HANDLE_VALUE;
+   }
+
+   pthread_mutex_init( &mMutex, 0 );
+   pthread_cond_init( &mDispatchDone, 0 );
+   pthread_cond_init( &mOpDone, 0 );
+}
+
+/*===========================================================================
+METHOD:
+   ~cURingService (Public Method)
+
+DESCRIPTION:
+   Destructor
+
+RETURN VALUE:
+   None
+===========================================================================*/
+cURingService::~cURingService()
+{
+   Exit();
+
+   pthread_cond_destroy( &mOpDone );
+   pthread_cond_destroy( &mDispatchDone );
+   pthread_mutex_destroy( &mMutex );
+}
+
+/*===========================================================================
+METHOD:
+   IsAvailable (Public Method)
+
+DESCRIPTION:
+   Can the service be used on this system?  The ring is set up (and the
+   ring thread started) upon first use
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cURingService::IsAvailable()
+{
+   pthread_mutex_lock( &mMutex );
+   bool bRC = Start();
+   pthread_mutex_unlock( &mMutex );
+
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   Register (Public Method)
+
+DESCRIPTION:
+   Add a (connected) port to the service, reading starts right away and
+   the data is handed out once a read is started (see Read())
+
+PARAMETERS:
+   pComm       [ I ] - Connection
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cURingService::Register( cURingComm * pComm )
+{
+   if (pComm == 0 || pComm->mPort == INVALID_HANDLE_VALUE)
+   {
+      return false;
+   }
+
+   pthread_mutex_lock( &mMutex );
+
+   bool bRC = Start();
+   if (bRC == true && FindPort( pComm ) == URING_MAX_PORTS)
+   {
+      ULONG slot = 0;
+      while (slot < URING_MAX_PORTS && mPorts[slot].mbBusy == true)
+      {
+         slot++;
+      }
+
+      if (slot == URING_MAX_PORTS)
+      {
+         TRACE( "cURingService::Register() no free port slot\n" );
+         bRC = false;
+      }
+      else
+      {
+         sURingPort & port = mPorts[slot];
+         port.mpOwner = pComm;
+         port.mbBusy = true;
+         port.mPort = pComm->mPort;
+         port.mbMultishot = false;
+         port.mbReceived = false;
+         port.mbReadArmed = false;
+         port.mReadBuffer = 0;
+         port.mFree = (1UL << URING_RX_BUFFERS) - 1;
+         port.mQueueStart = 0;
+         port.mQueueCount = 0;
+         port.mbFailed = false;
+         port.mbTxBusy = false;
+         port.mTxResult = 0;
+
+         if (mbMultishot == true && port.mpBufRing != 0)
+         {
+            // Hand the receive buffers to the kernel as a buffer group
+            // (one per port slot) for multishot reads to pick from
+            memset( port.mpBufRing, 0, mBufRingSz / URING_MAX_PORTS );
+
+            io_uring_buf_reg reg;
+            memset( &reg, 0, sizeof( reg ) );
+            reg.ring_addr = (ULONGLONG)port.mpBufRing;
+            reg.ring_entries = URING_RX_BUFFERS;
+            reg.bgid = (__u16)slot;
+
+            int nRet = URingRegister( mRingFD,
+                                      IORING_REGISTER_PBUF_RING,
+                                      &reg,
+                                      1 );
+            if (nRet == 0)
+            {
+               port.mbMultishot = true;
+               port.mFree = 0;
+               for (ULONG buffer = 0; buffer < URING_RX_BUFFERS; buffer++)
+               {
+                  Recycle( slot, buffer );
+               }
+            }
+            else
+            {
+               TRACE( "cURingService::Register() buffer ring = %d\n", errno );
+            }
+         }
+
+         // The first read is submitted by the ring thread
+         Wake( slot );
+      }
+   }
+
+   pthread_mutex_unlock( &mMutex );
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   Unregister (Public Method)
+
+DESCRIPTION:
+   Remove a port from the service, waiting for any read completion of
+   the port that is running on the ring thread to finish (unless called
+   from that read completion) and for any write to complete; the port
+   slot is released once its read has been canceled
+
+PARAMETERS:
+   pComm       [ I ] - Connection
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cURingService::Unregister( cURingComm * pComm )
+{
+   pthread_mutex_lock( &mMutex );
+
+   ULONG slot = FindPort( pComm );
+   bool bRC = (slot < URING_MAX_PORTS);
+   if (bRC == true)
+   {
+      sURingPort & port = mPorts[slot];
+      port.mpOwner = 0;
+      mArmed.erase( slot );
+
+      bool bSelf = (pthread_equal( pthread_self(), mThreadID ) != 0);
+      if (port.mbReadArmed == true)
+      {
+         Cancel( MakeTag( slot, eURING_TAG_READ ) );
+      }
+
+      if (port.mbTxBusy == true)
+      {
+         Cancel( MakeTag( slot, eURING_TAG_WRITE ) );
+      }
+
+      while (bSelf == false && port.mbTxBusy == true)
+      {
+         pthread_cond_wait( &mOpDone, &mMutex );
+      }
+
+      while (bSelf == false && mpDispatching == pComm)
+      {
+         pthread_cond_wait( &mDispatchDone, &mMutex );
+      }
+
+      pComm->mpRxCallback = 0;
+
+      if (port.mbBusy == true
+      &&  port.mbReadArmed == false
+      &&  port.mbTxBusy == false)
+      {
+         Release( slot );
+      }
+   }
+
+   pthread_mutex_unlock( &mMutex );
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   Read (Public Method)
+
+DESCRIPTION:
+   Start a read on a port, the next received message is delivered to the
+   given buffer from the ring thread
+
+PARAMETERS:
+   pComm       [ I ] - Connection
+   pBuf        [ I ] - Buffer to contain received data
+   bufSz       [ I ] - Amount of data to be received
+   pCallback   [ I ] - Callback object to be exercised when the
+                       operation completes (0 for none)
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cURingService::Read(
+   cURingComm *               pComm,
+   BYTE *                     pBuf,
+   ULONG                      bufSz,
+   cIOCallback *              pCallback )
+{
+   pthread_mutex_lock( &mMutex );
+
+   // Only one read may be in progress
+   ULONG slot = FindPort( pComm );
+   bool bRC = (slot < URING_MAX_PORTS && pComm->mpRxCallback == 0);
+   if (bRC == true)
+   {
+      if (pCallback == 0)
+      {
+         // Not interested in being notified, but we still need a value
+         // for this so that only one outstanding I/O operation is active
+         // at any given point in time
+         pComm->mpRxCallback = (cIOCallback *)1;
+      }
+      else
+      {
+         pComm->mpRxCallback = pCallback;
+      }
+
+      pComm->mpBuffer = pBuf;
+      pComm->mBuffSz = bufSz;
+
+      // A message may already be queued
+      if (mPorts[slot].mQueueCount > 0)
+      {
+         Wake( slot );
+      }
+   }
+
+   pthread_mutex_unlock( &mMutex );
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   CancelRead (Public Method)
+
+DESCRIPTION:
+   Cancel the read in progress on a port (the port keeps being read,
+   the data waits for the next read)
+
+PARAMETERS:
+   pComm       [ I ] - Connection
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cURingService::CancelRead( cURingComm * pComm )
+{
+   pthread_mutex_lock( &mMutex );
+
+   bool bRC = ( (FindPort( pComm ) < URING_MAX_PORTS)
+            &&  (pComm->mpRxCallback != 0) );
+
+   pComm->mpRxCallback = 0;
+
+   pthread_mutex_unlock( &mMutex );
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   Write (Public Method)
+
+DESCRIPTION:
+   Write to a port, the write is linked to a timeout of (1000 + num bytes)
+   MS and this method returns once it has completed
+
+PARAMETERS:
+   pComm       [ I ] - Connection
+   pBuf        [ I ] - Data to be transmitted
+   bufSz       [ I ] - Amount of data to be transmitted
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cURingService::Write(
+   cURingComm *               pComm,
+   const BYTE *               pBuf,
+   ULONG                      bufSz )
+{
+   pthread_mutex_lock( &mMutex );
+
+   ULONG slot = FindPort( pComm );
+   if (slot == URING_MAX_PORTS)
+   {
+      pthread_mutex_unlock( &mMutex );
+      return false;
+   }
+
+   if (pthread_equal( pthread_self(), mThreadID ) != 0)
+   {
+      // The ring thread cannot wait for its own completions
+      pthread_mutex_unlock( &mMutex );
+
+      ssize_t nRet = write( pComm->mPort, pBuf, bufSz );
+      return (nRet >= 0 && (ULONG)nRet == bufSz);
+   }
+
+   sURingPort & port = mPorts[slot];
+   while (port.mbTxBusy == true)
+   {
+      pthread_cond_wait( &mOpDone, &mMutex );
+   }
+
+   io_uring_sqe * pWrite = GetSQE();
+   io_uring_sqe * pTimeout = (pWrite != 0 ? GetSQE() : 0);
+   if (pTimeout == 0)
+   {
+      TRACE( "cURingService::Write() submission queue full\n" );
+      if (pWrite != 0)
+      {
+         pWrite->opcode = IORING_OP_NOP;
+         pWrite->user_data = MakeTag( slot, eURING_TAG_IGNORE );
+         Submit();
+      }
+
+      pthread_mutex_unlock( &mMutex );
+      return false;
+   }
+
+   // Give the device up to (1000 + num bytes) MS, the timeout is copied
+   // when it is submitted
+   ULONG timeoutMS = 1000 + bufSz;
+   struct __kernel_timespec ts;
+   ts.tv_sec = timeoutMS / 1000;
+   ts.tv_nsec = (timeoutMS % 1000) * 1000000;
+
+   pWrite->opcode = IORING_OP_WRITE;
+   pWrite->flags = IOSQE_IO_LINK;
+   pWrite->fd = pComm->mPort;
+   pWrite->off = (ULONGLONG)-1;
+   pWrite->addr = (ULONGLONG)pBuf;
+   pWrite->len = bufSz;
+   pWrite->user_data = MakeTag( slot, eURING_TAG_WRITE );
+
+   pTimeout->opcode = IORING_OP_LINK_TIMEOUT;
+   pTimeout->addr = (ULONGLONG)&ts;
+   pTimeout->len = 1;
+   pTimeout->user_data = MakeTag( slot, eURING_TAG_IGNORE );
+
+   port.mbTxBusy = true;
+   port.mTxResult = 0;
+
+   bool bRC = Submit();
+   if (bRC == false)
+   {
+      port.mbTxBusy = false;
+   }
+
+   while (port.mbTxBusy == true)
+   {
+      pthread_cond_wait( &mOpDone, &mMutex );
+   }
+
+   int result = port.mTxResult;
+   pthread_mutex_unlock( &mMutex );
+
+   if (bRC == true && (result < 0 || (ULONG)result != bufSz))
+   {
+      TRACE( "cURingService::Write() write returned %d instead of %lu\n",
+             result,
+             bufSz );
+      bRC = false;
+   }
+
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   CancelWrite (Public Method)
+
+DESCRIPTION:
+   Cancel the write in progress on a port
+
+PARAMETERS:
+   pComm       [ I ] - Connection
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cURingService::CancelWrite( cURingComm * pComm )
+{
+   pthread_mutex_lock( &mMutex );
+
+   ULONG slot = FindPort( pComm );
+   bool bRC = (slot < URING_MAX_PORTS);
+   if (bRC == true && mPorts[slot].mbTxBusy == true)
+   {
+      Cancel( MakeTag( slot, eURING_TAG_WRITE ) );
+   }
+
+   pthread_mutex_unlock( &mMutex );
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   Start (Internal Method)
+
+DESCRIPTION:
+   Set up the ring and start the ring thread (if not already running),
+   a failed set up is not retried
+
+SEQUENCING:
+   Calling thread must have mMutex locked
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cURingService::Start()
+{
+   if (mbRunning == true)
+   {
+      return true;
+   }
+
+   if (mbUnavailable == true)
+   {
+      return false;
+   }
+
+   if (Setup() == true)
+   {
+      mbExiting = false;
+      int nRet = pthread_create( &mThreadID, 0, URingServiceThread, this );
+      mbRunning = (nRet == 0);
+
+      if (mbRunning == false)
+      {
+         TRACE( "cURingService::Start() failed %d\n", nRet );
+      }
+   }
+
+   if (mbRunning == false)
+   {
+      Cleanup();
+      mbUnavailable = true;
+   }
+
+   return mbRunning;
+}
+
+/*===========================================================================
+METHOD:
+   Setup (Internal Method)
+
+DESCRIPTION:
+   Create and map the ring, check the operations needed are supported and
+   register the receive buffers of all port slots
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cURingService::Setup()
+{
+   io_uring_params params;
+   memset( &params, 0, sizeof( params ) );
+   params.flags = IORING_SETUP_CQSIZE;
+   params.cq_entries = URING_CQ_ENTRIES;
+
+   mRingFD = (int)syscall( __NR_io_uring_setup, URING_SQ_ENTRIES, &params );
+   if (mRingFD < 0)
+   {
+      TRACE( "cURingService::Setup() io_uring_setup = %d\n", errno );
+      mRingFD = INVALID_HANDLE_VALUE;
+      return false;
+   }
+
+   // Completions must never be dropped and reads/writes must be able to
+   // use the current file position
+   const unsigned features = IORING_FEAT_NODROP | IORING_FEAT_RW_CUR_POS;
+   if ((params.features & features) != features)
+   {
+      TRACE( "cURingService::Setup() features %08X\n", params.features );
+      return false;
+   }
+
+   mSQRingSz = params.sq_off.array + params.sq_entries * sizeof( unsigned );
+   mCQRingSz = params.cq_off.cqes + params.cq_entries * sizeof( io_uring_cqe );
+   bool bSingle = ((params.features & IORING_FEAT_SINGLE_MMAP) != 0);
+   if (bSingle == true)
+   {
+      mSQRingSz = std::max( mSQRingSz, mCQRingSz );
+      mCQRingSz = 0;
+   }
+
+   mpSQRing = mmap( 0,
+                    mSQRingSz,
+                    PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE,
+                    mRingFD,
+                    IORING_OFF_SQ_RING );
+   if (mpSQRing == MAP_FAILED)
+   {
+      mpSQRing = 0;
+      return false;
+   }
+
+   mpCQRing = mpSQRing;
+   if (bSingle == false)
+   {
+      mpCQRing = mmap( 0,
+                       mCQRingSz,
+                       PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE,
+                       mRingFD,
+                       IORING_OFF_CQ_RING );
+      if (mpCQRing == MAP_FAILED)
+      {
+         mpCQRing = 0;
+         return false;
+      }
+   }
+
+   mSQEsSz = params.sq_entries * sizeof( io_uring_sqe );
+   void * pSQEs = mmap( 0,
+                        mSQEsSz,
+                        PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE,
+                        mRingFD,
+                        IORING_OFF_SQES );
+   if (pSQEs == MAP_FAILED)
+   {
+      return false;
+   }
+
+   mpSQEs = (io_uring_sqe *)pSQEs;
+
+   BYTE * pSQ = (BYTE *)mpSQRing;
+   mpSQHead = (unsigned *)(pSQ + params.sq_off.head);
+   mpSQTail = (unsigned *)(pSQ + params.sq_off.tail);
+   mSQMask = *(unsigned *)(pSQ + params.sq_off.ring_mask);
+   mSQEntries = params.sq_entries;
+   mSQPending = 0;
+
+   // Entries are always submitted in order
+   unsigned * pArray = (unsigned *)(pSQ + params.sq_off.array);
+   for (unsigned idx = 0; idx < mSQEntries; idx++)
+   {
+      pArray[idx] = idx;
+   }
+
+   BYTE * pCQ = (BYTE *)mpCQRing;
+   mpCQHead = (unsigned *)(pCQ + params.cq_off.head);
+   mpCQTail = (unsigned *)(pCQ + params.cq_off.tail);
+   mCQMask = *(unsigned *)(pCQ + params.cq_off.ring_mask);
+   mpCQEs = (io_uring_cqe *)(pCQ + params.cq_off.cqes);
+
+   // Check the operations we use
+   const ULONG maxOps = 256;
+   ULONGLONG probeBuf[(sizeof( io_uring_probe )
+                    +  maxOps * sizeof( io_uring_probe_op ))
+                    /  sizeof( ULONGLONG ) + 1];
+   memset( &probeBuf[0], 0, sizeof( probeBuf ) );
+
+   io_uring_probe * pProbe = (io_uring_probe *)&probeBuf[0];
+   int nRet = URingRegister( mRingFD, IORING_REGISTER_PROBE, pProbe, maxOps );
+   if (nRet < 0)
+   {
+      TRACE( "cURingService::Setup() probe = %d\n", errno );
+      return false;
+   }
+
+   const BYTE ops[] =
+   {
+      IORING_OP_NOP,
+      IORING_OP_READ_FIXED,
+      IORING_OP_WRITE,
+      IORING_OP_LINK_TIMEOUT,
+      IORING_OP_ASYNC_CANCEL
+   };
+
+   for (ULONG op = 0; op < sizeof( ops ); op++)
+   {
+      if (IsOpSupported( pProbe, ops[op] ) == false)
+      {
+         TRACE( "cURingService::Setup() op %u not supported\n", ops[op] );
+         return false;
+      }
+   }
+
+   mbMultishot = IsOpSupported( pProbe, URING_OP_READ_MULTISHOT );
+
+   // Receive buffers of all port slots, registered once
+   mBuffersSz = URING_MAX_PORTS * URING_RX_BUFFERS * URING_RX_BUFFER_SIZE;
+   void * pBuffers = mmap( 0,
+                           mBuffersSz,
+                           PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS,
+                           -1,
+                           0 );
+   if (pBuffers == MAP_FAILED)
+   {
+      return false;
+   }
+
+   mpBuffers = (BYTE *)pBuffers;
+
+   struct iovec iov[URING_MAX_PORTS];
+   for (ULONG slot = 0; slot < URING_MAX_PORTS; slot++)
+   {
+      iov[slot].iov_base = mpBuffers
+                         + slot * URING_RX_BUFFERS * URING_RX_BUFFER_SIZE;
+      iov[slot].iov_len = URING_RX_BUFFERS * URING_RX_BUFFER_SIZE;
+   }
+
+   nRet = URingRegister( mRingFD,
+                         IORING_REGISTER_BUFFERS,
+                         &iov[0],
+                         URING_MAX_PORTS );
+   if (nRet < 0)
+   {
+      // Usually RLIMIT_MEMLOCK
+      TRACE( "cURingService::Setup() register buffers = %d\n", errno );
+      return false;
+   }
+
+   if (mbMultishot == true)
+   {
+      // Buffer rings must be page aligned, one page per port slot
+      mBufRingSz = URING_MAX_PORTS * (ULONG)sysconf( _SC_PAGESIZE );
+      void * pBufRings = mmap( 0,
+                               mBufRingSz,
+                               PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS,
+                               -1,
+                               0 );
+      if (pBufRings == MAP_FAILED)
+      {
+         mBufRingSz = 0;
+         mbMultishot = false;
+      }
+      else
+      {
+         mpBufRings = (BYTE *)pBufRings;
+      }
+   }
+
+   for (ULONG slot = 0; slot < URING_MAX_PORTS; slot++)
+   {
+      mPorts[slot].mpBuffers = (BYTE *)iov[slot].iov_base;
+      if (mpBufRings != 0)
+      {
+         ULONG ringSz = mBufRingSz / URING_MAX_PORTS;
+         mPorts[slot].mpBufRing = (io_uring_buf_ring *)(mpBufRings
+                                                      + slot * ringSz);
+      }
+   }
+
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   Cleanup (Internal Method)
+
+DESCRIPTION:
+   Release everything Setup() acquired (closing the ring drops everything
+   registered with it)
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cURingService::Cleanup()
+{
+   if (mpBufRings != 0)
+   {
+      munmap( mpBufRings, mBufRingSz );
+      mpBufRings = 0;
+      mBufRingSz = 0;
+   }
+
+   if (mpBuffers != 0)
+   {
+      munmap( mpBuffers, mBuffersSz );
+      mpBuffers = 0;
+      mBuffersSz = 0;
+   }
+
+   if (mpSQEs != 0)
+   {
+      munmap( mpSQEs, mSQEsSz );
+      mpSQEs = 0;
+      mSQEsSz = 0;
+   }
+
+   if (mpCQRing != 0 && mpCQRing != mpSQRing)
+   {
+      munmap( mpCQRing, mCQRingSz );
+   }
+
+   if (mpSQRing != 0)
+   {
+      munmap( mpSQRing, mSQRingSz );
+   }
+
+   mpSQRing = 0;
+   mpCQRing = 0;
+   mSQRingSz = 0;
+   mCQRingSz = 0;
+   mpSQHead = 0;
+   mpSQTail = 0;
+   mpCQHead = 0;
+   mpCQTail = 0;
+   mpCQEs = 0;
+
+   if (mRingFD != INVALID_HANDLE_VALUE)
+   {
+      close( mRingFD );
+      mRingFD = INVALID_HANDLE_VALUE;
+   }
+
+   memset( &mPorts[0], 0, sizeof( mPorts ) );
+   for (ULONG slot = 0; slot < URING_MAX_PORTS; slot++)
+   {
+      mPorts[slot].mPort = INVALID_HANDLE_VALUE;
+   }
+}
+
+/*===========================================================================
+METHOD:
+   Exit (Internal Method)
+
+DESCRIPTION:
+   Exit the ring thread
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cURingService::Exit()
+{
+   pthread_mutex_lock( &mMutex );
+
+   bool bRunning = mbRunning;
+   mbExiting = true;
+   mbRunning = false;
+
+   if (bRunning == true)
+   {
+      io_uring_sqe * pSQE = GetSQE();
+      if (pSQE != 0)
+      {
+         pSQE->opcode = IORING_OP_NOP;
+         pSQE->user_data = MakeTag( 0, eURING_TAG_WAKE );
+         Submit();
+      }
+   }
+
+   pthread_mutex_unlock( &mMutex );
+
+   if (bRunning == false)
+   {
+      return;
+   }
+
+   int nRC = pthread_join( mThreadID, 0 );
+   if (nRC != 0)
+   {
+      TRACE( "failed to join thread %d\n", nRC );
+   }
+
+   mThreadID = 0;
+   mArmed.clear();
+   Cleanup();
+}
+
+/*===========================================================================
+METHOD:
+   FindPort (Internal Method)
+
+DESCRIPTION:
+   Return the slot of a port
+
+PARAMETERS:
+   pComm       [ I ] - Connection
+
+SEQUENCING:
+   Calling thread must have mMutex locked
+
+RETURN VALUE:
+   ULONG - port slot (URING_MAX_PORTS if not registered)
+===========================================================================*/
+ULONG cURingService::FindPort( cURingComm * pComm )
+{
+   ULONG slot = 0;
+   while (slot < URING_MAX_PORTS)
+   {
+      if (pComm != 0 && mPorts[slot].mpOwner == pComm)
+      {
+         break;
+      }
+
+      slot++;
+   }
+
+   return slot;
+}
+
+/*===========================================================================
+METHOD:
+   GetSQE (Internal Method)
+
+DESCRIPTION:
+   Return the next free (cleared) submission queue entry, the entry is
+   handed to the kernel by the next Submit()
+
+SEQUENCING:
+   Calling thread must have mMutex locked
+
+RETURN VALUE:
+   io_uring_sqe * - 0 if the submission queue is full
+===========================================================================*/
+io_uring_sqe * cURingService::GetSQE()
+{
+   unsigned head = __atomic_load_n( mpSQHead, __ATOMIC_ACQUIRE );
+   unsigned tail = *mpSQTail + mSQPending;
+   if (tail - head >= mSQEntries)
+   {
+      return 0;
+   }
+
+   io_uring_sqe * pSQE = &mpSQEs[tail & mSQMask];
+   memset( pSQE, 0, sizeof( io_uring_sqe ) );
+
+   mSQPending++;
+   return pSQE;
+}
+
+/*===========================================================================
+METHOD:
+   Submit (Internal Method)
+
+DESCRIPTION:
+   Submit the queued submission queue entries (along with any the kernel
+   did not pick up before)
+
+SEQUENCING:
+   Calling thread must have mMutex locked
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cURingService::Submit()
+{
+   unsigned tail = *mpSQTail + mSQPending;
+   __atomic_store_n( mpSQTail, tail, __ATOMIC_RELEASE );
+   mSQPending = 0;
+
+   while (true)
+   {
+      unsigned head = __atomic_load_n( mpSQHead, __ATOMIC_ACQUIRE );
+      if (head == tail)
+      {
+         break;
+      }
+
+      int nRet = URingEnter( mRingFD, tail - head, 0, 0 );
+      if (nRet < 0 && errno == EINTR)
+      {
+         continue;
+      }
+
+      if (nRet <= 0)
+      {
+         TRACE( "cURingService::Submit() io_uring_enter = %d\n", errno );
+         return false;
+      }
+   }
+
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   Arm (Internal Method)
+
+DESCRIPTION:
+   Submit a read on a port (unless one is already submitted, the port is
+   gone or has failed, or there is no buffer to read into); a multishot
+   read keeps reading into the provided buffers until it runs out of them
+
+PARAMETERS:
+   slot        [ I ] - Port slot
+
+SEQUENCING:
+   Calling thread must have mMutex locked
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cURingService::Arm( ULONG slot )
+{
+   sURingPort & port = mPorts[slot];
+   if ( (port.mpOwner == 0)
+   ||   (port.mbReadArmed == true)
+   ||   (port.mbFailed == true)
+   ||   (port.mFree == 0) )
+   {
+      return;
+   }
+
+   io_uring_sqe * pSQE = GetSQE();
+   if (pSQE == 0)
+   {
+      TRACE( "cURingService::Arm() submission queue full\n" );
+      return;
+   }
+
+   pSQE->fd = port.mPort;
+   pSQE->off = (ULONGLONG)-1;
+   pSQE->user_data = MakeTag( slot, eURING_TAG_READ );
+
+   ULONG buffer = 0;
+   if (port.mbMultishot == true)
+   {
+      pSQE->opcode = URING_OP_READ_MULTISHOT;
+      pSQE->flags = IOSQE_BUFFER_SELECT;
+      pSQE->buf_group = (__u16)slot;
+   }
+   else
+   {
+      while ((port.mFree & (1UL << buffer)) == 0)
+      {
+         buffer++;
+      }
+
+      port.mFree &= ~(1UL << buffer);
+      port.mReadBuffer = buffer;
+
+      pSQE->opcode = IORING_OP_READ_FIXED;
+      pSQE->addr = (ULONGLONG)(port.mpBuffers + buffer * URING_RX_BUFFER_SIZE);
+      pSQE->len = URING_RX_BUFFER_SIZE;
+      pSQE->buf_index = (__u16)slot;
+   }
+
+   port.mbReadArmed = true;
+   if (Submit() == false)
+   {
+      port.mbReadArmed = false;
+      port.mbFailed = true;
+   }
+}
+
+/*===========================================================================
+METHOD:
+   Cancel (Internal Method)
+
+DESCRIPTION:
+   Cancel a submitted operation, the operation completes with -ECANCELED
+
+PARAMETERS:
+   userData    [ I ] - User data of the operation
+
+SEQUENCING:
+   Calling thread must have mMutex locked
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cURingService::Cancel( ULONGLONG userData )
+{
+   io_uring_sqe * pSQE = GetSQE();
+   if (pSQE == 0)
+   {
+      TRACE( "cURingService::Cancel() submission queue full\n" );
+      return;
+   }
+
+   pSQE->opcode = IORING_OP_ASYNC_CANCEL;
+   pSQE->addr = userData;
+   pSQE->user_data = MakeTag( 0, eURING_TAG_IGNORE );
+   Submit();
+}
+
+/*===========================================================================
+METHOD:
+   Recycle (Internal Method)
+
+DESCRIPTION:
+   Make a buffer available for reading again, handing it back to the
+   kernel when the port is read with a multishot read
+
+PARAMETERS:
+   slot        [ I ] - Port slot
+   buffer      [ I ] - Buffer index
+
+SEQUENCING:
+   Calling thread must have mMutex locked
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cURingService::Recycle(
+   ULONG                      slot,
+   ULONG                      buffer )
+{
+   sURingPort & port = mPorts[slot];
+   port.mFree |= (1UL << buffer);
+
+   if (port.mbMultishot == true)
+   {
+      // The ring is addressed as an array of entries, the flexible array
+      // of io_uring_buf_ring does not start at offset 0 when compiled as
+      // C++; the ring tail overlays the reserved field of the first entry
+      io_uring_buf * pEntries = (io_uring_buf *)port.mpBufRing;
+      __u16 tail = pEntries[0].resv;
+
+      io_uring_buf * pEntry = &pEntries[tail & (URING_RX_BUFFERS - 1)];
+      pEntry->addr = (ULONGLONG)(port.mpBuffers + buffer * URING_RX_BUFFER_SIZE);
+      pEntry->len = URING_RX_BUFFER_SIZE;
+      pEntry->bid = (__u16)buffer;
+
+      __atomic_store_n( &pEntries[0].resv, (__u16)(tail + 1), __ATOMIC_RELEASE );
+   }
+}
+
+/*===========================================================================
+METHOD:
+   Release (Internal Method)
+
+DESCRIPTION:
+   Release a port slot whose connection is gone and which has nothing
+   submitted anymore
+
+PARAMETERS:
+   slot        [ I ] - Port slot
+
+SEQUENCING:
+   Calling thread must have mMutex locked
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cURingService::Release( ULONG slot )
+{
+   sURingPort & port = mPorts[slot];
+   if (port.mbMultishot == true)
+   {
+      io_uring_buf_reg reg;
+      memset( &reg, 0, sizeof( reg ) );
+      reg.bgid = (__u16)slot;
+
+      URingRegister( mRingFD, IORING_UNREGISTER_PBUF_RING, &reg, 1 );
+      port.mbMultishot = false;
+   }
+
+   port.mpOwner = 0;
+   port.mbBusy = false;
+   port.mPort = INVALID_HANDLE_VALUE;
+   port.mQueueCount = 0;
+   mArmed.erase( slot );
+}
+
+/*===========================================================================
+METHOD:
+   Complete (Internal Method)
+
+DESCRIPTION:
+   Handle a completion
+
+PARAMETERS:
+   cqe         [ I ] - Completion queue entry
+
+SEQUENCING:
+   Calling thread must have mMutex locked
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cURingService::Complete( const io_uring_cqe & cqe )
+{
+   ULONG tag = (ULONG)(cqe.user_data & 0xFF);
+   ULONG slot = (ULONG)(cqe.user_data >> 8);
+   if (slot >= URING_MAX_PORTS || mPorts[slot].mbBusy == false)
+   {
+      return;
+   }
+
+   sURingPort & port = mPorts[slot];
+   if (tag == eURING_TAG_READ)
+   {
+      ReadComplete( slot, cqe );
+   }
+   else if (tag == eURING_TAG_WRITE)
+   {
+      port.mTxResult = cqe.res;
+      port.mbTxBusy = false;
+      pthread_cond_broadcast( &mOpDone );
+   }
+   else
+   {
+      // Wake up, cancelation or timeout
+      return;
+   }
+
+   if ( (port.mpOwner == 0)
+   &&   (port.mbReadArmed == false)
+   &&   (port.mbTxBusy == false) )
+   {
+      Release( slot );
+   }
+}
+
+/*===========================================================================
+METHOD:
+   ReadComplete (Internal Method)
+
+DESCRIPTION:
+   Handle a read completion, queueing the received data; a port whose
+   driver does not support multishot reads falls back to reading into
+   one registered buffer at a time
+
+PARAMETERS:
+   slot        [ I ] - Port slot
+   cqe         [ I ] - Completion queue entry
+
+SEQUENCING:
+   Calling thread must have mMutex locked
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cURingService::ReadComplete(
+   ULONG                      slot,
+   const io_uring_cqe &       cqe )
+{
+   sURingPort & port = mPorts[slot];
+
+   bool bMore = ( (port.mbMultishot == true)
+              &&  ((cqe.flags & IORING_CQE_F_MORE) != 0) );
+   if (bMore == false)
+   {
+      port.mbReadArmed = false;
+   }
+
+   bool bBuffer = (port.mbMultishot == false);
+   ULONG buffer = port.mReadBuffer;
+   if (port.mbMultishot == true && (cqe.flags & IORING_CQE_F_BUFFER) != 0)
+   {
+      buffer = (ULONG)(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+      port.mFree &= ~(1UL << buffer);
+      bBuffer = true;
+   }
+
+   if (cqe.res > 0 && bBuffer == true && port.mpOwner != 0)
+   {
+      ULONG idx = (port.mQueueStart + port.mQueueCount) % URING_RX_BUFFERS;
+      port.mQueued[idx] = buffer;
+      port.mQueuedSz[idx] = (ULONG)cqe.res;
+      port.mQueueCount++;
+
+      port.mbReceived = true;
+      mArmed.insert( slot );
+      return;
+   }
+
+   if (bBuffer == true)
+   {
+      Recycle( slot, buffer );
+   }
+
+   if (port.mpOwner == 0 || cqe.res == -ECANCELED)
+   {
+      // Disconnecting (or the submitting thread exited, resubmitted below)
+   }
+   else if (cqe.res == -ENOBUFS)
+   {
+      // Every buffer is queued, resubmitted once one is handed out
+   }
+   else if ( (port.mbMultishot == true)
+        &&   (port.mbReceived == false)
+        &&   (cqe.res == -EINVAL
+          ||  cqe.res == -EOPNOTSUPP
+          ||  cqe.res == -EBADFD) )
+   {
+      TRACE( "multishot read not supported (%d), reading singly\n", cqe.res );
+
+      io_uring_buf_reg reg;
+      memset( &reg, 0, sizeof( reg ) );
+      reg.bgid = (__u16)slot;
+
+      URingRegister( mRingFD, IORING_UNREGISTER_PBUF_RING, &reg, 1 );
+      port.mbMultishot = false;
+      port.mFree = (1UL << URING_RX_BUFFERS) - 1;
+   }
+   else
+   {
+      // The connection is gone
+      TRACE( "read error %d\n", cqe.res );
+      port.mbFailed = true;
+   }
+
+   mArmed.insert( slot );
+}
+
+/*===========================================================================
+METHOD:
+   Dispatch (Internal Method)
+
+DESCRIPTION:
+   Hand out the received data of a port in order, one message per read,
+   and keep the port read
+
+PARAMETERS:
+   slot        [ I ] - Port slot
+
+SEQUENCING:
+   Calling thread must have mMutex locked (it is released while the
+   read completion runs)
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cURingService::Dispatch( ULONG slot )
+{
+   sURingPort & port = mPorts[slot];
+   cURingComm * pComm = port.mpOwner;
+   if (pComm == 0)
+   {
+      return;
+   }
+
+   while (port.mQueueCount > 0 && pComm->mpRxCallback != 0)
+   {
+      ULONG buffer = port.mQueued[port.mQueueStart];
+      ULONG rxSz = port.mQueuedSz[port.mQueueStart];
+      port.mQueueStart = (port.mQueueStart + 1) % URING_RX_BUFFERS;
+      port.mQueueCount--;
+
+      cIOCallback * pCallback = pComm->mpRxCallback;
+      pComm->mpRxCallback = 0;
+
+      bool bFits = (rxSz <= pComm->mBuffSz);
+      if (bFits == true)
+      {
+         memcpy( pComm->mpBuffer,
+                 port.mpBuffers + buffer * URING_RX_BUFFER_SIZE,
+                 rxSz );
+      }
+      else
+      {
+         TRACE( "read too large for buffer\n" );
+      }
+
+      Recycle( slot, buffer );
+
+      if (pCallback == (cIOCallback *)1)
+      {
+         // We wanted to read, but not to be notified
+         continue;
+      }
+
+      // The completion usually starts the next read
+      mpDispatching = pComm;
+      pthread_mutex_unlock( &mMutex );
+
+      if (bFits == true)
+      {
+         pCallback->IOComplete( 0, rxSz );
+      }
+      else
+      {
+         pCallback->IOComplete( (DWORD)-EMSGSIZE, 0 );
+      }
+
+      pthread_mutex_lock( &mMutex );
+      mpDispatching = 0;
+      pthread_cond_broadcast( &mDispatchDone );
+
+      if (port.mpOwner != pComm)
+      {
+         // Removed by the completion
+         return;
+      }
+   }
+
+   // Keep reading as long as there is room
+   Arm( slot );
+}
+
+/*===========================================================================
+METHOD:
+   Wake (Internal Method)
+
+DESCRIPTION:
+   Have the ring thread look at a port
+
+PARAMETERS:
+   slot        [ I ] - Port slot
+
+SEQUENCING:
+   Calling thread must have mMutex locked
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cURingService::Wake( ULONG slot )
+{
+   mArmed.insert( slot );
+
+   // No need when called from a read completion
+   if (pthread_equal( pthread_self(), mThreadID ) == 0)
+   {
+      io_uring_sqe * pSQE = GetSQE();
+      if (pSQE != 0)
+      {
+         pSQE->opcode = IORING_OP_NOP;
+         pSQE->user_data = MakeTag( 0, eURING_TAG_WAKE );
+         Submit();
+      }
+   }
+}
@@ -0,0 +1,304 @@
+/*===========================================================================
+FILE:
+   URingService.h
+
+DESCRIPTION:
+   Declaration of cURingService class
+
+PUBLIC CLASSES AND METHODS:
+   cURingService
+      This class performs the I/O of all io_uring connections through one
+      ring serviced by one thread
+
+
+Copyright (c) 2013, The Linux Foundation. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of The Linux Foundation nor the names of its
+      contributors may be used to endorse or promote products derived from
+      this software without specific prior written permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include <pthread.h>
+#include <set>
+
+//---------------------------------------------------------------------------
+// Pragmas
+//---------------------------------------------------------------------------
+#pragma once
+
+//---------------------------------------------------------------------------
+// Forward Declarations
+//---------------------------------------------------------------------------
+class cURingComm;
+class cIOCallback;
+struct io_uring_sqe;
+struct io_uring_cqe;
+struct io_uring_buf_ring;
+
+//---------------------------------------------------------------------------
+// Definitions
+//---------------------------------------------------------------------------
+
+// Number of submission queue entries
+const ULONG URING_SQ_ENTRIES = 32;
+
+// Number of completion queue entries
+const ULONG URING_CQ_ENTRIES = 128;
+
+// Maximum number of completions handled per pass of the ring thread
+const ULONG URING_CQ_BATCH = 32;
+
+// Maximum number of simultaneously connected ports
+const ULONG URING_MAX_PORTS = 8;
+
+// Number of receive buffers per port (must be a power of two)
+const ULONG URING_RX_BUFFERS = 4;
+
+// Size of each receive buffer (largest QMI message)
+const ULONG URING_RX_BUFFER_SIZE = 8192;
+
+/*=========================================================================*/
+// Struct sURingPort
+//
+//    State of one port slot of the ring, a slot outlives its connection
+//    until the last read submitted for it has completed
+/*=========================================================================*/
+struct sURingPort
+{
+   /* Connection using the slot (0 for none) */
+   cURingComm * mpOwner;
+
+   /* Is the slot in use (possibly still draining its read)? */
+   bool mbBusy;
+
+   /* Port handle */
+   int mPort;
+
+   /* Registered receive buffers (URING_RX_BUFFERS of them) */
+   BYTE * mpBuffers;
+
+   /* Ring of buffers provided to multishot reads */
+   io_uring_buf_ring * mpBufRing;
+
+   /* Is the port read with a multishot read? */
+   bool mbMultishot;
+
+   /* Has any data been received? */
+   bool mbReceived;
+
+   /* Is a read submitted? */
+   bool mbReadArmed;
+
+   /* Buffer of the submitted (single shot) read */
+   ULONG mReadBuffer;
+
+   /* Bit mask of the buffers available for reading */
+   ULONG mFree;
+
+   /* Received buffers waiting to be handed out, oldest first */
+   ULONG mQueued[URING_RX_BUFFERS];
+   ULONG mQueuedSz[URING_RX_BUFFERS];
+   ULONG mQueueStart;
+   ULONG mQueueCount;
+
+   /* Has the port failed? */
+   bool mbFailed;
+
+   /* Is a write submitted? */
+   bool mbTxBusy;
+
+   /* Result of the last write */
+   int mTxResult;
+};
+
+/*=========================================================================*/
+// Class cURingService
+//
+//    Single io_uring shared by all io_uring connections; reads use buffers
+//    registered with the ring (and multishot reads where the driver allows
+//    it), writes are linked to a timeout, completions are reaped in batches
+//    by the ring thread which also runs all read completions
+/*=========================================================================*/
+class cURingService
+{
+   public:
+      // Constructor
+      cURingService();
+
+      // Destructor
+      ~cURingService();
+
+      // Can the service be used on this system?
+      bool IsAvailable();
+
+      // Add a (connected) port to the service
+      bool Register( cURingComm * pComm );
+
+      // Remove a port from the service
+      bool Unregister( cURingComm * pComm );
+
+      // Start a read on a port
+      bool Read(
+         cURingComm *               pComm,
+         BYTE *                     pBuf,
+         ULONG                      bufSz,
+         cIOCallback *              pCallback );
+
+      // Cancel the read in progress on a port
+      bool CancelRead( cURingComm * pComm );
+
+      // Write to a port
+      bool Write(
+         cURingComm *               pComm,
+         const BYTE *               pBuf,
+         ULONG                      bufSz );
+
+      // Cancel the write in progress on a port
+      bool CancelWrite( cURingComm * pComm );
+
+   protected:
+      // Set up the ring and start the ring thread (mutex must be held)
+      bool Start();
+
+      // Map the ring and register the receive buffers
+      bool Setup();
+
+      // Release everything Setup() acquired
+      void Cleanup();
+
+      // Exit the ring thread
+      void Exit();
+
+      // Return the slot of a port (mutex must be held)
+      ULONG FindPort( cURingComm * pComm );
+
+      // Return the next free submission queue entry (mutex must be held)
+      io_uring_sqe * GetSQE();
+
+      // Submit the queued submission queue entries (mutex must be held)
+      bool Submit();
+
+      // Submit a read on a port (mutex must be held)
+      void Arm( ULONG slot );
+
+      // Cancel a submitted operation (mutex must be held)
+      void Cancel( ULONGLONG userData );
+
+      // Make a buffer available for reading again (mutex must be held)
+      void Recycle(
+         ULONG                      slot,
+         ULONG                      buffer );
+
+      // Release a port slot (mutex must be held)
+      void Release( ULONG slot );
+
+      // Handle a completion (mutex must be held)
+      void Complete( const io_uring_cqe & cqe );
+
+      // Handle a read completion (mutex must be held)
+      void ReadComplete(
+         ULONG                      slot,
+         const io_uring_cqe &       cqe );
+
+      // Hand out the received data of a port (mutex must be held)
+      void Dispatch( ULONG slot );
+
+      // Have the ring thread look at a port (mutex must be held)
+      void Wake( ULONG slot );
+
+      /* io_uring instance */
+      int mRingFD;
+
+      /* Did ring set up fail (no point in trying again)? */
+      bool mbUnavailable;
+
+      /* Does the kernel support multishot reads? */
+      bool mbMultishot;
+
+      /* Mapped rings and submission queue entries */
+      void * mpSQRing;
+      ULONG mSQRingSz;
+      void * mpCQRing;
+      ULONG mCQRingSz;
+      io_uring_sqe * mpSQEs;
+      ULONG mSQEsSz;
+
+      /* Submission queue indices (in the mapped ring) */
+      unsigned * mpSQHead;
+      unsigned * mpSQTail;
+      unsigned mSQMask;
+      unsigned mSQEntries;
+
+      /* Submission queue entries not yet submitted */
+      unsigned mSQPending;
+
+      /* Completion queue (in the mapped ring) */
+      unsigned * mpCQHead;
+      unsigned * mpCQTail;
+      unsigned mCQMask;
+      io_uring_cqe * mpCQEs;
+
+      /* Receive buffers of all ports (registered with the ring) */
+      BYTE * mpBuffers;
+      ULONG mBuffersSz;
+
+      /* Provided buffer rings of all ports (one page each) */
+      BYTE * mpBufRings;
+      ULONG mBufRingSz;
+
+      /* Port slots */
+      sURingPort mPorts[URING_MAX_PORTS];
+
+      /* ID of ring thread */
+      pthread_t mThreadID;
+
+      /* Is the ring thread running? */
+      bool mbRunning;
+
+      /* Is the ring thread exiting? */
+      bool mbExiting;
+
+      /* Ports with received data or a changed read state */
+      std::set <ULONG> mArmed;
+
+      /* Connection whose read completion is currently running */
+      cURingComm * mpDispatching;
+
+      /* Mutex protecting all of the above and the connection read state */
+      pthread_mutex_t mMutex;
+
+      /* Signalled when a read completion finishes */
+      pthread_cond_t mDispatchDone;
+
+      /* Signalled when a read or write completes */
+      pthread_cond_t mOpDone;
+
+      // Ring thread gets full access
+      friend void * URingServiceThread( void * pData );
+};
+
+// Return the service shared by all io_uring connections
+cURingService & GetURingService();
@@ -76,25 +76,133 @@ ULONG GetTLV(
         offset + sizeof( sQMIRawContentHeader ) <= inLen; 
         offset += sizeof( sQMIRawContentHeader ))
    {
-      sQMIRawContentHeader * pHeader = (sQMIRawContentHeader*)(pIn + offset);
+      const sQMIRawContentHeader * pHeader = 
+         (const sQMIRawContentHeader *)(pIn + offset);
 
       // Is it big enough to contain this TLV?
-      if (offset + sizeof( sQMIRawContentHeader ) + pHeader->mLength > inLen)
+      WORD length = GET_PACKED_FIELD( pHeader, mLength );
+      if (offset + sizeof( sQMIRawContentHeader ) + length > inLen)
       {
          return eGOBI_ERR_MALFORMED_RSP;
       }
 
       if (pHeader->mTypeID == typeID)
       {
-         *pOutLen = pHeader->mLength;
+         *pOutLen = length;
          *ppOut = pIn + offset + sizeof( sQMIRawContentHeader );
 
          return eGOBI_ERR_NONE;
       }
 
-      offset += pHeader->mLength;
+      offset += length;
    }
    
    // TLV not found
    return eGOBI_ERR_INVALID_RSP;
 }
+
+/*=========================================================================*/
+// cTLVIndex Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   cTLVIndex
+
+DESCRIPTION:
+   Constructor, index the TLVs in the given buffer
+
+   NOTE: as with GetTLV() only the first instance of a type ID is indexed,
+   indexing stops at the first TLV that overruns the buffer
+
+PARAMETERS:
+   inLen             [ I ] - Length of input buffer
+   pIn               [ I ] - Input buffer
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+cTLVIndex::cTLVIndex(
+   ULONG          inLen,
+   const BYTE *   pIn )
+   :  mpIn( pIn ),
+      mbMalformed( false )
+{
+   memset( &mPresent[0], 0, sizeof( mPresent ) );
+   if (pIn == 0)
+   {
+      return;
+   }
+
+   for (ULONG offset = 0; 
+        offset + sizeof( sQMIRawContentHeader ) <= inLen; 
+        offset += sizeof( sQMIRawContentHeader ))
+   {
+      const sQMIRawContentHeader * pHeader = 
+         (const sQMIRawContentHeader *)(pIn + offset);
+
+      // Is it big enough to contain this TLV?
+      WORD length = GET_PACKED_FIELD( pHeader, mLength );
+      if (offset + sizeof( sQMIRawContentHeader ) + length > inLen)
+      {
+         mbMalformed = true;
+         return;
+      }
+
+      BYTE typeID = pHeader->mTypeID;
+      UINT32 bit = (UINT32)1 << (typeID & 31);
+      if ((mPresent[typeID >> 5] & bit) == 0)
+      {
+         mPresent[typeID >> 5] |= bit;
+         mOffsets[typeID] = (UINT32)(offset + sizeof( sQMIRawContentHeader ));
+         mLengths[typeID] = length;
+      }
+
+      offset += length;
+   }
+}
+
+/*===========================================================================
+METHOD:
+   GetTLV
+
+DESCRIPTION:
+   Return the starting location and size of TLV buffer.
+
+   NOTE: does not include the TLV header
+
+PARAMETERS:
+   typeID            [ I ] - Type ID
+   pOutLen           [ O ] - Length of the output buffer
+   ppOut             [ O ] - Pointer to output buffer
+  
+RETURN VALUE:
+   ULONG - Return code
+===========================================================================*/
+ULONG cTLVIndex::GetTLV(
+   BYTE           typeID,
+   ULONG *        pOutLen,
+   const BYTE **  ppOut ) const
+{
+   if (mpIn == 0 || pOutLen == 0 || ppOut == 0)
+   {
+      return eGOBI_ERR_INVALID_ARG;
+   }
+
+   if ((mPresent[typeID >> 5] & ((UINT32)1 << (typeID & 31))) != 0)
+   {
+      *pOutLen = mLengths[typeID];
+      *ppOut = mpIn + mOffsets[typeID];
+
+      return eGOBI_ERR_NONE;
+   }
+
+   // A malformed TLV hides any that follow it
+   if (mbMalformed == true)
+   {
+      return eGOBI_ERR_MALFORMED_RSP;
+   }
+
+   // TLV not found
+   return eGOBI_ERR_INVALID_RSP;
+}
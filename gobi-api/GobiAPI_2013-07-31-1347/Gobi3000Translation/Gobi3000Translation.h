@@ -73,6 +73,7 @@ typedef const char *       LPCSTR;
 #include <string.h>
 #include <string>
 #include "GobiConnectionMgmtAPIStructs.h"
+#include "PackedAccess.h"
 
 //---------------------------------------------------------------------------
 // Prototypes
@@ -86,6 +87,157 @@ ULONG GetTLV(
    ULONG *        pOutLen,
    const BYTE **  ppOut );
 
+/*=========================================================================*/
+// Class cTLVIndex
+//
+//    Index of the TLVs in a QMI payload, built in a single pass so that
+//    each subsequent lookup is a direct table access
+/*=========================================================================*/
+class cTLVIndex
+{
+   public:
+      // Constructor
+      cTLVIndex(
+         ULONG          inLen,
+         const BYTE *   pIn );
+
+      // Get a TLV (same semantics as the free GetTLV())
+      ULONG GetTLV(
+         BYTE           typeID,
+         ULONG *        pOutLen,
+         const BYTE **  ppOut ) const;
+
+   protected:
+      /* Input buffer */
+      const BYTE * mpIn;
+
+      /* Was a malformed TLV found (ending the index)? */
+      bool mbMalformed;
+
+      /* Bitmap of the type IDs present */
+      UINT32 mPresent[256 / 32];
+
+      /* Offset of each TLV value (valid only when present) */
+      UINT32 mOffsets[256];
+
+      /* Length of each TLV value (valid only when present) */
+      UINT16 mLengths[256];
+};
+
+/*=========================================================================*/
+// Class cTLVWriter
+//
+//    Writer of the TLVs of a QMI request payload.  The TLVs to be written
+//    are first sized (Need(), the size of a fixed TLV being a compile time
+//    constant), the caller buffer is then checked once (Fits()) and the
+//    TLVs are finally written with no further checks (Add())
+/*=========================================================================*/
+class cTLVWriter
+{
+   public:
+      // (Inline) Constructor
+      cTLVWriter( BYTE * pOut )
+         :  mpOut( pOut ),
+            mNeedSz( 0 ),
+            mOffset( 0 )
+      { };
+
+      // (Inline) Account for a fixed size TLV
+      template <class tTLV>
+      void Need()
+      {
+         mNeedSz += (ULONG)(sizeof( sQMIRawContentHeader ) + sizeof( tTLV ));
+      };
+
+      // (Inline) Account for a fixed size TLV, if present
+      template <class tTLV>
+      void Need( bool bPresent )
+      {
+         if (bPresent == true)
+         {
+            mNeedSz += (ULONG)(sizeof( sQMIRawContentHeader ) + sizeof( tTLV ));
+         }
+      };
+
+      // (Inline) Account for a TLV whose value is the given size
+      void Need( ULONG valueSz )
+      {
+         mNeedSz += (ULONG)sizeof( sQMIRawContentHeader ) + valueSz;
+      };
+
+      // (Inline) Account for a string TLV (the value excludes the NULL
+      // terminator), if present, returning the size of the value
+      WORD NeedString( const CHAR * pString )
+      {
+         if (pString == 0)
+         {
+            return 0;
+         }
+
+         WORD valueSz = (WORD)strlen( pString );
+         Need( valueSz );
+         return valueSz;
+      };
+
+      // (Inline) Do the accounted for TLVs fit in the given size?
+      bool Fits( ULONG maxSz ) const
+      {
+         return (mNeedSz <= maxSz);
+      };
+
+      // (Inline) Add a TLV header, returning where the value goes
+      BYTE * AddHeader(
+         BYTE                       typeID,
+         WORD                       valueSz )
+      {
+         sQMIRawContentHeader * pHeader;
+         pHeader = (sQMIRawContentHeader *)(mpOut + mOffset);
+         pHeader->mTypeID = typeID;
+         SET_PACKED_FIELD( pHeader, mLength, valueSz );
+
+         BYTE * pValue = mpOut + mOffset + sizeof( sQMIRawContentHeader );
+         mOffset += (ULONG)sizeof( sQMIRawContentHeader ) + valueSz;
+         return pValue;
+      };
+
+      // (Inline) Add a fixed size TLV, returning its (zeroed) value; the
+      // zeroing is of a constant size and so folds into the stores that
+      // follow it
+      template <class tTLV>
+      tTLV * Add( BYTE typeID )
+      {
+         tTLV * pTLV = (tTLV *)AddHeader( typeID, (WORD)sizeof( tTLV ) );
+         memset( pTLV, 0, sizeof( tTLV ) );
+         return pTLV;
+      };
+
+      // (Inline) Add a TLV with the given value
+      void Add(
+         BYTE                       typeID,
+         const void *               pValue,
+         WORD                       valueSz )
+      {
+         BYTE * pDst = AddHeader( typeID, valueSz );
+         memcpy( pDst, pValue, valueSz );
+      };
+
+      // (Inline) Return the number of BYTEs written
+      ULONG GetSize() const
+      {
+         return mOffset;
+      };
+
+   protected:
+      /* Output buffer */
+      BYTE * mpOut;
+
+      /* Number of BYTEs the accounted for TLVs need */
+      ULONG mNeedSz;
+
+      /* Number of BYTEs written */
+      ULONG mOffset;
+};
+
 // WDS
 
 ULONG ParseGetSessionState(
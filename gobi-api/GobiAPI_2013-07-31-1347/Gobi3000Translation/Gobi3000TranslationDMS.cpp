@@ -83,6 +83,9 @@ ULONG ParseGetDeviceCapabilities(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    ULONG maxRadioIfaces = (ULONG)*pRadioIfacesSize;
 
    // Assume failure
@@ -91,7 +94,7 @@ ULONG ParseGetDeviceCapabilities(
    const sDMSGetDeviceCapabilitiesResponse_Capabilities * pTLVx01;
    ULONG structSzx01 = sizeof( sDMSGetDeviceCapabilitiesResponse_Capabilities );
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -170,6 +173,9 @@ ULONG ParseGetManufacturer(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Assume failure
    *pString = 0;
 
@@ -177,7 +183,7 @@ ULONG ParseGetManufacturer(
    // sDMSGetDeviceManfacturerResponse_Manfacturer only contains this
    const CHAR * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -224,6 +230,9 @@ ULONG ParseGetModelID(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Assume failure
    *pString = 0;
 
@@ -231,7 +240,7 @@ ULONG ParseGetModelID(
    // sDMSGetDeviceModelResponse_Model only contains the model
    const CHAR * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -278,6 +287,9 @@ ULONG ParseGetFirmwareRevision(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Assume failure
    *pString = 0;
 
@@ -285,7 +297,7 @@ ULONG ParseGetFirmwareRevision(
    // sDMSGetDeviceRevisionResponse_UQCNRevision only contains this
    const CHAR * pTLVx11;
    ULONG outLenx11;
-   ULONG rc = GetTLV( inLen, pIn, 0x11, &outLenx11, (const BYTE **)&pTLVx11 );
+   ULONG rc = tlvs.GetTLV( 0x11, &outLenx11, (const BYTE **)&pTLVx11 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -346,6 +358,9 @@ ULONG ParseGetFirmwareRevisions(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Assume failure
    *pAMSSString = 0;
    *pBootString = 0;
@@ -355,7 +370,7 @@ ULONG ParseGetFirmwareRevisions(
    // sDMSGetDeviceRevisionResponse_Revision only contains this
    const CHAR * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -374,7 +389,7 @@ ULONG ParseGetFirmwareRevisions(
    // sDMSGetDeviceRevisionResponse_BootCodeRevision only contains this
    const CHAR * pTLVx10;
    ULONG outLenx10;
-   rc = GetTLV( inLen, pIn, 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
+   rc = tlvs.GetTLV( 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -437,6 +452,9 @@ ULONG ParseGetVoiceNumber(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Assume failure
    *pVoiceNumber = 0;
    *pMIN = 0;
@@ -445,7 +463,7 @@ ULONG ParseGetVoiceNumber(
    // sDMSGetDeviceVoiceNumberResponse_VoiceNumber only contains this
    const CHAR * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -464,7 +482,7 @@ ULONG ParseGetVoiceNumber(
    // sDMSGetDeviceVoiceNumberResponse_MobileIDNumber only contains this
    const CHAR * pTLVx10;
    ULONG outLenx10;
-   rc = GetTLV( inLen, pIn, 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
+   rc = tlvs.GetTLV( 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
    if (rc == eGOBI_ERR_NONE)
    {
       // Space to perform the copy?
@@ -509,6 +527,9 @@ ULONG ParseGetIMSI(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Assume failure
    *pString = 0;
 
@@ -516,7 +537,7 @@ ULONG ParseGetIMSI(
    // sDMSGetDeviceVoiceNumberResponse_IMSI only contains this
    const CHAR * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -579,6 +600,9 @@ ULONG ParseGetSerialNumbers(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Assume failure
    *pESNString = 0;
    *pIMEIString = 0;
@@ -588,7 +612,7 @@ ULONG ParseGetSerialNumbers(
    // sDMSGetDeviceSerialNumbersResponse_ESN only contains this
    const CHAR * pTLVx10;
    ULONG outLenx10;
-   ULONG rc = GetTLV( inLen, pIn, 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
+   ULONG rc = tlvs.GetTLV( 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -607,7 +631,7 @@ ULONG ParseGetSerialNumbers(
    // sDMSGetDeviceSerialNumbersResponse_IMEI only contains this
    const CHAR * pTLVx11;
    ULONG outLenx11;
-   rc = GetTLV( inLen, pIn, 0x11, &outLenx11, (const BYTE **)&pTLVx11 );
+   rc = tlvs.GetTLV( 0x11, &outLenx11, (const BYTE **)&pTLVx11 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -626,7 +650,7 @@ ULONG ParseGetSerialNumbers(
    // sDMSGetDeviceSerialNumbersResponse_MEID only contains this
    const CHAR * pTLVx12;
    ULONG outLenx12;
-   rc = GetTLV( inLen, pIn, 0x12, &outLenx12, (const BYTE **)&pTLVx12 );
+   rc = tlvs.GetTLV( 0x12, &outLenx12, (const BYTE **)&pTLVx12 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -738,10 +762,13 @@ ULONG ParseQueryLock(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Find the state
    const sDMSGetLockStateResponse_LockState * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -872,11 +899,14 @@ ULONG ParseGetHardwareRevision(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Find the hardware revision
    // sDMSGetHardwareRevisionResponse_HardwareRevision only contains this
    const CHAR * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -921,10 +951,13 @@ ULONG ParseGetPRLVersion(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Find the state
    const sDMSGetPRLVersionResponse_PRLVersion * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -971,6 +1004,9 @@ ULONG ParseGetERIFile(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Assume failure
    ULONG maxFileSize = *pFileSize;
    *pFileSize = 0;
@@ -978,7 +1014,7 @@ ULONG ParseGetERIFile(
    // Find the state
    const sDMSReadERIDataResponse_UserData * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -1178,10 +1214,13 @@ ULONG ParseGetActivationState(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Find the state
    const sDMSGetActivationStateResponse_ActivationState * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -1277,13 +1316,16 @@ ULONG ParseGetPower(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Assume failure
    *pPowerMode = 0xffffffff;
 
    // Find the mode
    const sDMSGetOperatingModeResponse_OperatingMode * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -1328,6 +1370,9 @@ ULONG ParseGetOfflineReason(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Assume failure
    *pReasonMask = 0;
    *pbPlatform = 0;
@@ -1335,7 +1380,7 @@ ULONG ParseGetOfflineReason(
    // Find the reason mask (optional)
    const sDMSGetOperatingModeResponse_OfflineReason * pTLVx10;
    ULONG outLenx10;
-   ULONG rc = GetTLV( inLen, pIn, 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
+   ULONG rc = tlvs.GetTLV( 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx10 < sizeof( sDMSGetOperatingModeResponse_OfflineReason ))
@@ -1344,13 +1389,13 @@ ULONG ParseGetOfflineReason(
       }
 
       // Copy the bitmask to pReasonMask
-      *pReasonMask = *(WORD*)pTLVx10;
+      *pReasonMask = GetPacked <WORD>( pTLVx10 );
    }
 
    // Find the platform restriction (optional)
    const sDMSGetOperatingModeResponse_PlatformRestricted * pTLVx11;
    ULONG outLenx11;
-   rc = GetTLV( inLen, pIn, 0x11, &outLenx11, (const BYTE **)&pTLVx11 );
+   rc = tlvs.GetTLV( 0x11, &outLenx11, (const BYTE **)&pTLVx11 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx11 < sizeof( sDMSGetOperatingModeResponse_PlatformRestricted ))
@@ -1394,10 +1439,13 @@ ULONG ParseGetNetworkTime(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Find the reason mask
    const sDMSGetTimestampResponse_Timestamp * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
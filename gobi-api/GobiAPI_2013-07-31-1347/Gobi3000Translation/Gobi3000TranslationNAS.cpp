@@ -117,10 +117,13 @@ ULONG ParseGetANAAAAuthenticationStatus(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Find the TLV
    const sNASGetANAAAAuthenticationStatusResponse_Status * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -284,6 +287,9 @@ ULONG ParseGetSignalStrengths(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    ULONG maxSignals = (ULONG)*pArraySizes;
 
    // Assume failure
@@ -292,7 +298,7 @@ ULONG ParseGetSignalStrengths(
    // Find the first signal strength value
    const sNASGetSignalStrengthResponse_SignalStrength * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -317,7 +323,7 @@ ULONG ParseGetSignalStrengths(
    // Handle list, if present
    const sNASGetSignalStrengthResponse_SignalStrengthList * pTLVx10;
    ULONG outLenx10;
-   rc = GetTLV( inLen, pIn, 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
+   rc = tlvs.GetTLV( 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx10 < sizeof( sNASGetSignalStrengthResponse_SignalStrengthList ))
@@ -415,6 +421,9 @@ ULONG ParseGetRFInfo(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Assume failure
    BYTE maxInstances = *pInstanceSize;
    *pInstanceSize = 0;
@@ -422,7 +431,7 @@ ULONG ParseGetRFInfo(
    // Find the TLV
    const sNASGetRFInfoResponse_RFInfo * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -458,9 +467,9 @@ ULONG ParseGetRFInfo(
    ULONG * pOutput = (ULONG *)pInstances;
    for (BYTE i = 0; i < ifaceCount; i++)
    {
-      *pOutput++ = pInstance->mRadioInterface;
-      *pOutput++ = pInstance->mActiveBandClass;
-      *pOutput++ = pInstance->mActiveChannel;
+      *pOutput++ = GET_PACKED_FIELD( pInstance, mRadioInterface );
+      *pOutput++ = GET_PACKED_FIELD( pInstance, mActiveBandClass );
+      *pOutput++ = GET_PACKED_FIELD( pInstance, mActiveChannel );
 
       // Move pInstance forward one element
       pInstance++;
@@ -505,6 +514,9 @@ ULONG ParsePerformNetworkScan(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    BYTE maxInstances = *pInstanceSize;
 
    // Assume failure
@@ -513,7 +525,7 @@ ULONG ParsePerformNetworkScan(
    // Find the TLV
    const sNASPerformNetworkScanResponse_NetworkInfo * pTLVx10;
    ULONG outLenx10;
-   ULONG rc = GetTLV( inLen, pIn, 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
+   ULONG rc = tlvs.GetTLV( 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -639,6 +651,9 @@ ULONG ParsePerformNetworkRATScan(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    BYTE maxRATInstances = *pRATSize;
 
    // Assume failure
@@ -657,7 +672,7 @@ ULONG ParsePerformNetworkRATScan(
    // Find the TLV
    const sNASPerformNetworkScanResponse_NetworkRAT * pTLVx11;
    ULONG outLenx11;
-   rc = GetTLV( inLen, pIn, 0x11, &outLenx11, (const BYTE **)&pTLVx11 );
+   rc = tlvs.GetTLV( 0x11, &outLenx11, (const BYTE **)&pTLVx11 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -740,57 +755,32 @@ ULONG PackInitiateNetworkRegistration(
       return eGOBI_ERR_INVALID_ARG;
    }
 
-   // Set the action
-
    // Check size
-   WORD tlvx01Sz = sizeof( sNASInitiateNetworkRegisterRequest_Action );
-   if (*pOutLen < sizeof( sQMIRawContentHeader ) + tlvx01Sz)
+   cTLVWriter tlvs( pOut );
+   tlvs.Need <sNASInitiateNetworkRegisterRequest_Action>();
+   tlvs.Need <sNASInitiateNetworkRegisterRequest_ManualInfo>();
+   if (tlvs.Fits( *pOutLen ) == false)
    {
       return eGOBI_ERR_BUFFER_SZ;
    }
 
-   sQMIRawContentHeader * pHeader = (sQMIRawContentHeader*)pOut;
-   pHeader->mTypeID = 0x01;
-   pHeader->mLength = tlvx01Sz;
-
-   ULONG offset = sizeof( sQMIRawContentHeader );
-
+   // Set the action
    sNASInitiateNetworkRegisterRequest_Action * pTLVx01;
-   pTLVx01 = (sNASInitiateNetworkRegisterRequest_Action*)(pOut + offset);
-   memset( pTLVx01, 0, tlvx01Sz );
+   pTLVx01 = tlvs.Add <sNASInitiateNetworkRegisterRequest_Action>( 0x01 );
 
    // Set the value
    pTLVx01->mRegisterAction = (eQMINASRegisterActions)regType;
 
-   offset += tlvx01Sz;
-
    // Set the info
-
-   // Check size
-   WORD tlvx10Sz = sizeof( sNASInitiateNetworkRegisterRequest_ManualInfo );
-   if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx10Sz)
-   {
-      return eGOBI_ERR_BUFFER_SZ;
-   }
-
-   pHeader = (sQMIRawContentHeader*)(pOut + offset);
-   pHeader->mTypeID = 0x10;
-   pHeader->mLength = tlvx10Sz;
-
-   offset = sizeof( sQMIRawContentHeader );
-
    sNASInitiateNetworkRegisterRequest_ManualInfo * pTLVx10;
-   pTLVx10 = (sNASInitiateNetworkRegisterRequest_ManualInfo*)(pOut + offset);
-   memset( pTLVx10, 0, tlvx10Sz );
+   pTLVx10 = tlvs.Add <sNASInitiateNetworkRegisterRequest_ManualInfo>( 0x10 );
 
    // Set the value
    pTLVx10->mMobileCountryCode = mcc;
    pTLVx10->mMobileNetworkCode = mnc;
    pTLVx10->mRadioAccessTechnology = (eQMINASRadioAccessTechnologies)rat;
 
-   offset += tlvx10Sz;
-
-   *pOutLen = offset;
+   *pOutLen = tlvs.GetSize();
    return eGOBI_ERR_NONE;
 }
 
@@ -914,6 +904,9 @@ ULONG ParseGetServingNetwork(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    BYTE maxRadioIfaces = *pRadioIfacesSize;
 
    // Assume failure
@@ -928,7 +921,7 @@ ULONG ParseGetServingNetwork(
    // Find the TLV
    const sNASGetServingSystemResponse_ServingSystem * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -979,7 +972,7 @@ ULONG ParseGetServingNetwork(
    // Find the roaming indicator (optional)
    const sNASGetServingSystemResponse_RoamingIndicator * pTLVx10;
    ULONG outLenx10;
-   rc = GetTLV( inLen, pIn, 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
+   rc = tlvs.GetTLV( 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx10 < sizeof( sNASGetServingSystemResponse_RoamingIndicator ))
@@ -994,7 +987,7 @@ ULONG ParseGetServingNetwork(
    // Find the PLMN (optional)
    const sNASGetServingSystemResponse_CurrentPLMN * pTLVx12;
    ULONG outLenx12;
-   rc = GetTLV( inLen, pIn, 0x12, &outLenx12, (const BYTE **)&pTLVx12 );
+   rc = tlvs.GetTLV( 0x12, &outLenx12, (const BYTE **)&pTLVx12 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx12 < sizeof( sNASGetServingSystemResponse_CurrentPLMN ))
@@ -1067,6 +1060,9 @@ ULONG ParseGetServingNetworkCapabilities(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    BYTE maxDataCaps = *pDataCapsSize;
 
    // Assume failure
@@ -1075,7 +1071,7 @@ ULONG ParseGetServingNetworkCapabilities(
    // Find the TLV
    const sNASGetServingSystemResponse_DataServices * pTLVx11;
    ULONG outLenx11;
-   ULONG rc = GetTLV( inLen, pIn, 0x11, &outLenx11, (const BYTE **)&pTLVx11 );
+   ULONG rc = tlvs.GetTLV( 0x11, &outLenx11, (const BYTE **)&pTLVx11 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -1163,6 +1159,9 @@ ULONG ParseGetHomeNetwork(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Assume failure
    *pName = 0;
    *pSID = 0xffff;
@@ -1171,7 +1170,7 @@ ULONG ParseGetHomeNetwork(
    // Find the name (mandatory)
    const sNASGetHomeNetworkResponse_HomeNetwork * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -1213,7 +1212,7 @@ ULONG ParseGetHomeNetwork(
    // Find the SID/NID (optional)
    const sNASGetHomeNetworkResponse_HomeIDs * pTLVx10;
    ULONG outLenx10;
-   rc = GetTLV( inLen, pIn, 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
+   rc = tlvs.GetTLV( 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx10 < sizeof( sNASGetHomeNetworkResponse_HomeIDs ))
@@ -1319,10 +1318,13 @@ ULONG ParseGetNetworkPreference(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Find the preference (mandatory)
    const sNASGetTechnologyPreferenceResponse_ActivePreference * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -1346,7 +1348,7 @@ ULONG ParseGetNetworkPreference(
    // Find the persistant technology preference (optional)
    const sNASGetTechnologyPreferenceResponse_PersistentPreference * pTLVx10;
    ULONG outLenx10;
-   rc = GetTLV( inLen, pIn, 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
+   rc = tlvs.GetTLV( 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx10 < sizeof( sNASGetTechnologyPreferenceResponse_PersistentPreference ))
@@ -1439,11 +1441,10 @@ ULONG PackSetCDMANetworkParameters(
       }
    }
 
-   sQMIRawContentHeader * pHeader;
-   ULONG offset = 0;
-
    // Need to start with SPC?
-   if (pForceRev0 != 0 || scpCount == 4)
+   bool bSPC = (pForceRev0 != 0 || scpCount == 4);
+   std::string spc;
+   if (bSPC == true)
    {
       // Validate arguments
       if (pSPC == 0 || pSPC[0] == 0)
@@ -1451,7 +1452,7 @@ ULONG PackSetCDMANetworkParameters(
          return eGOBI_ERR_INVALID_ARG;
       }
 
-      std::string spc( pSPC );
+      spc = pSPC;
       if (spc.size() > 6)
       {
          return eGOBI_ERR_INVALID_ARG;
@@ -1461,74 +1462,42 @@ ULONG PackSetCDMANetworkParameters(
       {
          return eGOBI_ERR_INVALID_ARG;
       }
+   }
 
-      // Check size
-      WORD tlvx10Sz = sizeof( sNASSetNetworkParametersRequest_SPC );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx10Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x10;
-      pHeader->mLength = tlvx10Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
+   // Check size
+   cTLVWriter tlvs( pOut );
+   tlvs.Need <sNASSetNetworkParametersRequest_SPC>( bSPC );
+   tlvs.Need <sNASSetNetworkParametersRequest_CDMA1xEVDORevision>( pForceRev0 != 0 );
+   tlvs.Need <sNASSetNetworkParametersRequest_CDMA1xEVDOSCPCustom>( scpCount == 4 );
+   tlvs.Need <sNASSetNetworkParametersRequest_Roaming>( pRoaming != 0 );
+   if (tlvs.Fits( *pOutLen ) == false)
+   {
+      return eGOBI_ERR_BUFFER_SZ;
+   }
 
+   if (bSPC == true)
+   {
       sNASSetNetworkParametersRequest_SPC * pTLVx10;
-      pTLVx10 = (sNASSetNetworkParametersRequest_SPC*)(pOut + offset);
-      memset( pTLVx10, 0, tlvx10Sz );
+      pTLVx10 = tlvs.Add <sNASSetNetworkParametersRequest_SPC>( 0x10 );
 
       // Set the values
       memcpy( &pTLVx10->mSPC[0], spc.c_str(), spc.size() );
-
-      offset += tlvx10Sz;
    }
 
    // Force Rev. 0?
    if (pForceRev0 != 0)
    {
-      // Check size
-      WORD tlvx14Sz = sizeof( sNASSetNetworkParametersRequest_CDMA1xEVDORevision );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx14Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x14;
-      pHeader->mLength = tlvx14Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
       sNASSetNetworkParametersRequest_CDMA1xEVDORevision * pTLVx14;
-      pTLVx14 = (sNASSetNetworkParametersRequest_CDMA1xEVDORevision*)(pOut + offset);
-      memset( pTLVx14, 0, tlvx14Sz );
+      pTLVx14 = tlvs.Add <sNASSetNetworkParametersRequest_CDMA1xEVDORevision>( 0x14 );
 
       // Set the value
       pTLVx14->mForceCDMA1xEVDORev0 = (*pForceRev0 == 0 ? 0 : 1);
-
-      offset += tlvx14Sz;
    }
 
    if (scpCount == 4)
    {
-      // Check size
-      WORD tlvx15Sz = sizeof( sNASSetNetworkParametersRequest_CDMA1xEVDOSCPCustom );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx15Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x15;
-      pHeader->mLength = tlvx15Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
       sNASSetNetworkParametersRequest_CDMA1xEVDOSCPCustom * pTLVx15;
-      pTLVx15 = (sNASSetNetworkParametersRequest_CDMA1xEVDOSCPCustom*)(pOut + offset);
-      memset( pTLVx15, 0, tlvx15Sz );
+      pTLVx15 = tlvs.Add <sNASSetNetworkParametersRequest_CDMA1xEVDOSCPCustom>( 0x15 );
 
       // Set the values
       pTLVx15->mCDMA1xEVDOSCPCustomConfig = (*pCustomSCP == 0 ? 0 : 1);
@@ -1551,42 +1520,24 @@ ULONG PackSetCDMANetworkParameters(
 
       pTLVx15->mSNEnhancedMultiflowPacketApplication
          = (*pApplication & 0x00000002 ? 1 : 0);
-
-      offset += tlvx15Sz;
    }
 
    if (pRoaming != 0)
    {
-      // Check size
-      WORD tlvx16Sz = sizeof( sNASSetNetworkParametersRequest_Roaming );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx16Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x16;
-      pHeader->mLength = tlvx16Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
       sNASSetNetworkParametersRequest_Roaming * pTLVx16;
-      pTLVx16 = (sNASSetNetworkParametersRequest_Roaming*)(pOut + offset);
-      memset( pTLVx16, 0, tlvx16Sz );
+      pTLVx16 = tlvs.Add <sNASSetNetworkParametersRequest_Roaming>( 0x16 );
 
       // Set the values
       pTLVx16->mRoamPreference = (eQMINASRoamingPreferences)*pRoaming;
-
-      offset += tlvx16Sz;
    }
 
    // At least one of the optional parameters must have been set
-   if (offset == 0)
+   if (tlvs.GetSize() == 0)
    {
       return eGOBI_ERR_INVALID_ARG;
    }
 
-   *pOutLen = offset;
+   *pOutLen = tlvs.GetSize();
    return eGOBI_ERR_NONE;
 }
 
@@ -1647,6 +1598,9 @@ ULONG ParseGetCDMANetworkParameters(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    *pSCI = 0xff;
    *pSCM = 0xff;
    *pRegHomeSID = 0xff;
@@ -1662,7 +1616,7 @@ ULONG ParseGetCDMANetworkParameters(
    // Find the SCI
    const sNASGetNetworkParametersResponse_SCI * pTLVx11;
    ULONG outLenx11;
-   ULONG rc = GetTLV( inLen, pIn, 0x11, &outLenx11, (const BYTE **)&pTLVx11 );
+   ULONG rc = tlvs.GetTLV( 0x11, &outLenx11, (const BYTE **)&pTLVx11 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx11 < sizeof( sNASGetNetworkParametersResponse_SCI ))
@@ -1676,7 +1630,7 @@ ULONG ParseGetCDMANetworkParameters(
    // Find the SCM
    const sNASGetNetworkParametersResponse_SCM * pTLVx12;
    ULONG outLenx12;
-   rc = GetTLV( inLen, pIn, 0x12, &outLenx12, (const BYTE **)&pTLVx12 );
+   rc = tlvs.GetTLV( 0x12, &outLenx12, (const BYTE **)&pTLVx12 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx12 < sizeof( sNASGetNetworkParametersResponse_SCM ))
@@ -1690,7 +1644,7 @@ ULONG ParseGetCDMANetworkParameters(
    // Find the Registration
    const sNASGetNetworkParametersResponse_Registration * pTLVx13;
    ULONG outLenx13;
-   rc = GetTLV( inLen, pIn, 0x13, &outLenx13, (const BYTE **)&pTLVx13 );
+   rc = tlvs.GetTLV( 0x13, &outLenx13, (const BYTE **)&pTLVx13 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx13 < sizeof( sNASGetNetworkParametersResponse_Registration ))
@@ -1706,7 +1660,7 @@ ULONG ParseGetCDMANetworkParameters(
    // Rev. 0?
    const sNASGetNetworkParametersResponse_CDMA1xEVDORevision * pTLVx14;
    ULONG outLenx14;
-   rc = GetTLV( inLen, pIn, 0x14, &outLenx14, (const BYTE **)&pTLVx14 );
+   rc = tlvs.GetTLV( 0x14, &outLenx14, (const BYTE **)&pTLVx14 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx14 < sizeof( sNASGetNetworkParametersResponse_CDMA1xEVDORevision ))
@@ -1722,7 +1676,7 @@ ULONG ParseGetCDMANetworkParameters(
    // respective container parameters
    const sEVDOCustomSCPConfig * pTLVx15;
    ULONG outLenx15;
-   rc = GetTLV( inLen, pIn, 0x15, &outLenx15, (const BYTE **)&pTLVx15 );
+   rc = tlvs.GetTLV( 0x15, &outLenx15, (const BYTE **)&pTLVx15 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx15 < sizeof( sEVDOCustomSCPConfig ))
@@ -1739,7 +1693,7 @@ ULONG ParseGetCDMANetworkParameters(
    // Roaming?
    const sNASGetNetworkParametersResponse_Roaming * pTLVx16;
    ULONG outLenx16;
-   rc = GetTLV( inLen, pIn, 0x16, &outLenx16, (const BYTE **)&pTLVx16 );
+   rc = tlvs.GetTLV( 0x16, &outLenx16, (const BYTE **)&pTLVx16 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx16 < sizeof( sNASGetNetworkParametersResponse_Roaming ))
@@ -1779,10 +1733,13 @@ ULONG ParseGetACCOLC(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Find the ACCOLC (mandatory)
    const sNASGetACCOLCResponse_ACCOLC * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -1893,10 +1850,13 @@ ULONG ParseGetPLMNMode(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Find the mode (mandatory)
    const sNASGetCSPPLMNModeResponse_Mode * pTLVx10;
    ULONG outLenx10;
-   ULONG rc = GetTLV( inLen, pIn, 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
+   ULONG rc = tlvs.GetTLV( 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -1999,9 +1959,12 @@ ULONG ParseGetPLMNName(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    const BYTE * pTLVx10;
    ULONG outLenx10;
-   ULONG rc = GetTLV( inLen, pIn, 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
+   ULONG rc = tlvs.GetTLV( 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -132,11 +132,14 @@ ULONG ParseOMADMGetSessionInfo(
    {
       return eGOBI_ERR_INVALID_ARG;
    }
+
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
    
    // Find the first TLV
    const sOMAGetSessionInfoResponse_Info * pTLVx10;
    ULONG outLenx10;
-   ULONG rc = GetTLV( inLen, pIn, 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
+   ULONG rc = tlvs.GetTLV( 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -154,7 +157,7 @@ ULONG ParseOMADMGetSessionInfo(
    // Find the second TLV
    const sOMAGetSessionInfoResponse_Failure * pTLVx11;
    ULONG outLenx11;
-   rc = GetTLV( inLen, pIn, 0x11, &outLenx11, (const BYTE **)&pTLVx11 );
+   rc = tlvs.GetTLV( 0x11, &outLenx11, (const BYTE **)&pTLVx11 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -171,7 +174,7 @@ ULONG ParseOMADMGetSessionInfo(
    // Find the third TLV
    const sOMAGetSessionInfoResponse_Retry * pTLVx12;
    ULONG outLenx12;
-   rc = GetTLV( inLen, pIn, 0x12, &outLenx12, (const BYTE **)&pTLVx12 );
+   rc = tlvs.GetTLV( 0x12, &outLenx12, (const BYTE **)&pTLVx12 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -218,11 +221,14 @@ ULONG ParseOMADMGetPendingNIA(
    {
       return eGOBI_ERR_INVALID_ARG;
    }
+
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
    
    // Find the TLV
    const sOMAGetSessionInfoResponse_NIA * pTLVx13;
    ULONG outLenx13;
-   ULONG rc = GetTLV( inLen, pIn, 0x13, &outLenx13, (const BYTE **)&pTLVx13 );
+   ULONG rc = tlvs.GetTLV( 0x13, &outLenx13, (const BYTE **)&pTLVx13 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -328,11 +334,14 @@ ULONG ParseOMADMGetFeatureSettings(
    {
       return eGOBI_ERR_INVALID_ARG;
    }
+
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
    
    // Find the first TLV
    const sOMAGetFeaturesResponse_Provisioning * pTLVx10;
    ULONG outLenx10;
-   ULONG rc = GetTLV( inLen, pIn, 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
+   ULONG rc = tlvs.GetTLV( 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -349,7 +358,7 @@ ULONG ParseOMADMGetFeatureSettings(
    // Find the second TLV
    const sOMAGetFeaturesResponse_PRLUpdate * pTLVx11;
    ULONG outLenx11;
-   rc = GetTLV( inLen, pIn, 0x11, &outLenx11, (const BYTE **)&pTLVx11 );
+   rc = tlvs.GetTLV( 0x11, &outLenx11, (const BYTE **)&pTLVx11 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
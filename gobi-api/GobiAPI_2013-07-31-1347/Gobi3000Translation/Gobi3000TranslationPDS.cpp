@@ -67,58 +67,36 @@ ULONG PackResetPDSData(
       return eGOBI_ERR_INVALID_ARG;
    }
 
-   sQMIRawContentHeader * pHeader;
-   ULONG offset = 0;
+   // Check size
+   cTLVWriter tlvs( pOut );
+   tlvs.Need <sPDSResetPDSDataRequest_GPSData>( pGPSDataMask != 0 );
+   tlvs.Need <sPDSResetPDSDataRequest_CellData>( pCellDataMask != 0 );
+   if (tlvs.Fits( *pOutLen ) == false)
+   {
+      return eGOBI_ERR_BUFFER_SZ;
+   }
 
    // Optionally add pGPSDataMask
    if (pGPSDataMask != 0)
    {
-      // Check size
-      WORD tlvx10Sz = sizeof( sPDSResetPDSDataRequest_GPSData );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx10Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x10;
-      pHeader->mLength = tlvx10Sz;
-      offset += sizeof( sQMIRawContentHeader );
-
       sPDSResetPDSDataRequest_GPSData * pTLVx10;
-      pTLVx10 = (sPDSResetPDSDataRequest_GPSData*)(pOut + offset);
-      memset( pTLVx10, 0, tlvx10Sz );
+      pTLVx10 = tlvs.Add <sPDSResetPDSDataRequest_GPSData>( 0x10 );
 
-      // Typecast the input over the bitmask
-	   *(ULONG *)pTLVx10 = *pGPSDataMask;
-      offset += tlvx10Sz;
+      // Write the input over the bitmask
+      SetPacked <UINT32>( pTLVx10, (UINT32)*pGPSDataMask );
    }
 
    // Optionally add pCellDataMask
    if (pCellDataMask != 0)
    {
-      // Check size
-      WORD tlvx11Sz = sizeof( sPDSResetPDSDataRequest_CellData );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx11Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x11;
-      pHeader->mLength = tlvx11Sz;
-      offset += sizeof( sQMIRawContentHeader );
-
       sPDSResetPDSDataRequest_CellData * pTLVx11;
-      pTLVx11 = (sPDSResetPDSDataRequest_CellData*)(pOut + offset);
-      memset( pTLVx11, 0, tlvx11Sz );
+      pTLVx11 = tlvs.Add <sPDSResetPDSDataRequest_CellData>( 0x11 );
 
-      // Typecast the input over the bitmask
-	   *(ULONG *)pTLVx11 = *pCellDataMask;
-      offset += tlvx11Sz;
+      // Write the input over the bitmask
+      SetPacked <UINT32>( pTLVx11, (UINT32)*pCellDataMask );
    }
 
-   *pOutLen = offset;
+   *pOutLen = tlvs.GetSize();
 
    return eGOBI_ERR_NONE;
 }
@@ -207,11 +185,14 @@ ULONG ParseGetPortAutomaticTracking(
    {
       return eGOBI_ERR_INVALID_ARG;
    }
+
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
    
    // Find pbAuto
    const sPDSGetCOMPortAutoTrackingConfigResponse_Config * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -309,11 +290,14 @@ ULONG ParseGetServiceAutomaticTracking(
    {
       return eGOBI_ERR_INVALID_ARG;
    }
+
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
    
    // Find pbAuto
    const sPDSGetServiceAutoTrackingStateResponse_State * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -425,11 +409,14 @@ ULONG ParseGetAGPSConfig(
    {
       return eGOBI_ERR_INVALID_ARG;
    }
+
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
    
    // Find arguments
    const sPDSGetAGPSConfigResponse_ServerAddress * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -533,11 +520,14 @@ ULONG ParseGetXTRATimeState(
    {
       return eGOBI_ERR_INVALID_ARG;
    }
+
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
    
    // Find pState
    const sPDSGetPositionMethodsStateResponse_XTRATime * pTLVx10;
    ULONG outLenx10;
-   ULONG rc = GetTLV( inLen, pIn, 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
+   ULONG rc = tlvs.GetTLV( 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -635,11 +625,14 @@ ULONG ParseGetXTRADataState(
    {
       return eGOBI_ERR_INVALID_ARG;
    }
+
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
    
    // Find pState
    const sPDSGetPositionMethodsStateResponse_XTRAData * pTLVx10;
    ULONG outLenx10;
-   ULONG rc = GetTLV( inLen, pIn, 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
+   ULONG rc = tlvs.GetTLV( 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -685,11 +678,14 @@ ULONG ParseGetXTRAValidity(
    {
       return eGOBI_ERR_INVALID_ARG;
    }
+
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
    
    // Find arguments
    const sPDSGetXTRAParametersResponse_Validity * pTLVx13;
    ULONG outLenx13;
-   ULONG rc = GetTLV( inLen, pIn, 0x13, &outLenx13, (const BYTE **)&pTLVx13 );
+   ULONG rc = tlvs.GetTLV( 0x13, &outLenx13, (const BYTE **)&pTLVx13 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -789,11 +785,14 @@ ULONG ParseGetXTRANetwork(
    {
       return eGOBI_ERR_INVALID_ARG;
    }
+
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
    
    // Find pPreference
    const sPDSGetXTRAParametersResponse_Network * pTLVx12;
    ULONG outLenx12;
-   ULONG rc = GetTLV( inLen, pIn, 0x12, &outLenx12, (const BYTE **)&pTLVx12 );
+   ULONG rc = tlvs.GetTLV( 0x12, &outLenx12, (const BYTE **)&pTLVx12 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -896,11 +895,14 @@ ULONG ParseGetXTRAAutomaticDownload(
    {
       return eGOBI_ERR_INVALID_ARG;
    }
+
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
    
    // Find arguments
    const sPDSGetXTRAParametersResponse_Automatic * pTLVx10;
    ULONG outLenx10;
-   ULONG rc = GetTLV( inLen, pIn, 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
+   ULONG rc = tlvs.GetTLV( 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -946,11 +948,14 @@ ULONG ParseGetPDSState(
    {
       return eGOBI_ERR_INVALID_ARG;
    }
+
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
    
    // Find arguments
    const sPDSGetServiceStateResponse_State * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -1116,10 +1121,13 @@ ULONG ParseGetPDSDefaults(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Find arguments
    const sPDSGetDefaultsResponse_Defaults * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -64,11 +64,14 @@ ULONG ParseGetSMSWake(
    {
       return eGOBI_ERR_INVALID_ARG;
    }
+
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
    
    // Find the first TLV
    const sRMSGetSMSWakeResponse_State * pTLVx10;
    ULONG outLenx10;
-   ULONG rc = GetTLV( inLen, pIn, 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
+   ULONG rc = tlvs.GetTLV( 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -83,7 +86,7 @@ ULONG ParseGetSMSWake(
    // Find the second TLV
    const sRMSGetSMSWakeRequest_Mask * pTLVx11;
    ULONG outLenx11;
-   rc = GetTLV( inLen, pIn, 0x11, &outLenx11, (const BYTE **)&pTLVx11 );
+   rc = tlvs.GetTLV( 0x11, &outLenx11, (const BYTE **)&pTLVx11 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -131,57 +134,33 @@ ULONG PackSetSMSWake(
       return eGOBI_ERR_INVALID_ARG;
    }
 
-   // Add bEnable
-   
    // Check size
-   WORD tlvx10Sz = sizeof( sRMSSetSMSWakeRequest_State );
-   if (*pOutLen < sizeof( sQMIRawContentHeader ) + tlvx10Sz)
+   cTLVWriter tlvs( pOut );
+   tlvs.Need <sRMSSetSMSWakeRequest_State>();
+   tlvs.Need <sRMSSetSMSWakeRequest_Mask>( bEnable != 0 );
+   if (tlvs.Fits( *pOutLen ) == false)
    {
       return eGOBI_ERR_BUFFER_SZ;
    }
 
-   sQMIRawContentHeader * pHeader = (sQMIRawContentHeader*)pOut;
-   pHeader->mTypeID = 0x10;
-   pHeader->mLength = tlvx10Sz;
-
-   ULONG offset = sizeof( sQMIRawContentHeader );
-
+   // Add bEnable
    sRMSSetSMSWakeRequest_State * pTLVx10;
-   pTLVx10 = (sRMSSetSMSWakeRequest_State*)(pOut + offset);
-   memset( pTLVx10, 0, tlvx10Sz );
+   pTLVx10 = tlvs.Add <sRMSSetSMSWakeRequest_State>( 0x10 );
 
    // Set the value
    pTLVx10->mSMSWakeEnabled = (INT8)bEnable;
-   
-   offset += tlvx10Sz;
 
    // Add wakeMask if enabled
    if (bEnable != 0)
    {
-      // Check size
-      WORD tlvx11Sz = sizeof( sRMSSetSMSWakeRequest_Mask );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx11Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x11;
-      pHeader->mLength = tlvx11Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
       sRMSSetSMSWakeRequest_Mask * pTLVx11;
-      pTLVx11 = (sRMSSetSMSWakeRequest_Mask*)(pOut + offset);
-      memset( pTLVx11, 0, tlvx11Sz );
+      pTLVx11 = tlvs.Add <sRMSSetSMSWakeRequest_Mask>( 0x11 );
 
       // Set the value
       pTLVx11->mMask = wakeMask;
-   
-      offset += tlvx11Sz;
    }
 
-   *pOutLen = offset;
+   *pOutLen = tlvs.GetSize();
 
    return eGOBI_ERR_NONE;
 }
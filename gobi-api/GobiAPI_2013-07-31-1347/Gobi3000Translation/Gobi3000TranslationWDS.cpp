@@ -63,10 +63,13 @@ ULONG ParseGetSessionState(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Find the TLV
    const sWDSGetPacketServiceStatusResponse_Status * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -109,10 +112,13 @@ ULONG ParseGetSessionDuration(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Find the TLV
    const sWDSGetDataSessionDurationResponse_Duration * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -155,10 +161,13 @@ ULONG ParseGetDormancyState(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Find the TLV
    const sWDSGetDormancyResponse_DormancyStatus * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -202,13 +211,16 @@ ULONG ParseGetEnhancedAutoconnect(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    *pSetting = 0xffffffff;
    *pRoamSetting = 0xffffffff;
 
    // Find the first TLV
    const sWDSGetAutoconnectSettingResponse_Autoconnect * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -225,7 +237,7 @@ ULONG ParseGetEnhancedAutoconnect(
    // Find the second TLV (optional)
    const sWDSGetAutoconnectSettingResponse_Roam * pTLVx10;
    ULONG outLenx10;
-   rc = GetTLV( inLen, pIn, 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
+   rc = tlvs.GetTLV( 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
    if (rc == eGOBI_ERR_NONE)
    {
       // Is the TLV large enough?
@@ -271,57 +283,33 @@ ULONG PackSetEnhancedAutoconnect(
       return eGOBI_ERR_INVALID_ARG;
    }
 
-   // Add setting
-
    // Check size
-   WORD tlvx01Sz = sizeof( sWDSSetAutoconnectSettingRequest_Autoconnect );
-   if (*pOutLen < sizeof( sQMIRawContentHeader ) + tlvx01Sz)
+   cTLVWriter tlvs( pOut );
+   tlvs.Need <sWDSSetAutoconnectSettingRequest_Autoconnect>();
+   tlvs.Need <sWDSSetAutoconnectSettingRequest_Roam>( pRoamSetting != 0 );
+   if (tlvs.Fits( *pOutLen ) == false)
    {
       return eGOBI_ERR_BUFFER_SZ;
    }
 
-   sQMIRawContentHeader * pHeader = (sQMIRawContentHeader*)pOut;
-   pHeader->mTypeID = 0x01;
-   pHeader->mLength = tlvx01Sz;
-
-   ULONG offset = sizeof( sQMIRawContentHeader );
-
+   // Add setting
    sWDSSetAutoconnectSettingRequest_Autoconnect * pTLVx01;
-   pTLVx01 = (sWDSSetAutoconnectSettingRequest_Autoconnect*)(pOut + offset);
-   memset( pTLVx01, 0, tlvx01Sz );
+   pTLVx01 = tlvs.Add <sWDSSetAutoconnectSettingRequest_Autoconnect>( 0x01 );
 
    // Set the value
    pTLVx01->mAutoconnectSetting = (eQMIWDSAutoconnectSettings)setting;
 
-   offset += tlvx01Sz;
-
    // Add roam setting, if specified
    if (pRoamSetting != 0)
    {
-      // Check size
-      WORD tlvx10Sz = sizeof( sWDSSetAutoconnectSettingRequest_Roam );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx10Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x10;
-      pHeader->mLength = tlvx10Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
       sWDSSetAutoconnectSettingRequest_Roam * pTLVx10;
-      pTLVx10 = (sWDSSetAutoconnectSettingRequest_Roam*)(pOut + offset);
-      memset( pTLVx10, 0, tlvx10Sz );
+      pTLVx10 = tlvs.Add <sWDSSetAutoconnectSettingRequest_Roam>( 0x10 );
 
       // Set the value
       pTLVx10->mAutoconnectRoamSetting = (eQMIWDSAutoconnectRoamSettings)*pRoamSetting;
-
-      offset += tlvx10Sz;
    }
 
-   *pOutLen = offset;
+   *pOutLen = tlvs.GetSize();
 
    return eGOBI_ERR_NONE;
 }
@@ -372,124 +360,58 @@ ULONG PackSetDefaultProfile(
       return eGOBI_ERR_INVALID_ARG;
    }
 
-   // Add profileType
-
    // Check size
-   WORD tlvx01Sz = sizeof( sWDSModifyProfileRequest_ProfileIdentifier );
-   if (*pOutLen < sizeof( sQMIRawContentHeader ) + tlvx01Sz)
+   cTLVWriter tlvs( pOut );
+   tlvs.Need <sWDSModifyProfileRequest_ProfileIdentifier>();
+   WORD nameSz = tlvs.NeedString( pName );
+   tlvs.Need <sWDSModifyProfileRequest_PDPType>( pPDPType != 0 );
+   WORD apnNameSz = tlvs.NeedString( pAPNName );
+   tlvs.Need <sWDSModifyProfileRequest_PrimaryDNS>( pPrimaryDNS != 0 );
+   tlvs.Need <sWDSModifyProfileRequest_SecondaryDNS>( pSecondaryDNS != 0 );
+   WORD usernameSz = tlvs.NeedString( pUsername );
+   WORD passwordSz = tlvs.NeedString( pPassword );
+   tlvs.Need <sWDSModifyProfileRequest_Authentication>( pAuthentication != 0 );
+   tlvs.Need <sWDSModifyProfileRequest_IPAddress>( pIPAddress != 0 );
+   if (tlvs.Fits( *pOutLen ) == false)
    {
       return eGOBI_ERR_BUFFER_SZ;
    }
 
-   sQMIRawContentHeader * pHeader = (sQMIRawContentHeader*)pOut;
-   pHeader->mTypeID = 0x01;
-   pHeader->mLength = tlvx01Sz;
-
-   ULONG offset = sizeof( sQMIRawContentHeader );
-
+   // Add profileType
    sWDSModifyProfileRequest_ProfileIdentifier * pTLVx01;
-   pTLVx01 = (sWDSModifyProfileRequest_ProfileIdentifier*)(pOut + offset);
-   memset( pTLVx01, 0, tlvx01Sz );
+   pTLVx01 = tlvs.Add <sWDSModifyProfileRequest_ProfileIdentifier>( 0x01 );
 
    // Set the value
    pTLVx01->mProfileType = (eQMIProfileTypes)profileType;
    pTLVx01->mProfileIndex = 1;
 
-   offset += tlvx01Sz;
-
    // Add name, if specified
    if (pName != 0)
    {
-      std::string name( pName );
-
-      // Check size
-      WORD tlvx10Sz = (WORD)name.size();
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx10Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x10;
-      pHeader->mLength = tlvx10Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
-      // Set the value
-      memcpy( pOut + offset, name.c_str(), name.size() );
-
-      offset += tlvx10Sz;
+      tlvs.Add( 0x10, pName, nameSz );
    }
 
    // Add PDP type, if specified
    if (pPDPType != 0)
    {
-      // Check size
-      WORD tlvx11Sz = sizeof( sWDSModifyProfileRequest_PDPType );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx11Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x11;
-      pHeader->mLength = tlvx11Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
       sWDSModifyProfileRequest_PDPType * pTLVx11;
-      pTLVx11 = (sWDSModifyProfileRequest_PDPType*)(pOut + offset);
-      memset( pTLVx11, 0, tlvx11Sz );
+      pTLVx11 = tlvs.Add <sWDSModifyProfileRequest_PDPType>( 0x11 );
 
       // Set the value
       pTLVx11->mPDPType = (eQMIPDPTypes)*pPDPType;
-
-      offset += tlvx11Sz;
    }
 
    // Add APN Name, if specified
    if (pAPNName != 0)
    {
-      std::string apnName( pAPNName );
-
-      // Check size
-      WORD tlvx14Sz = (WORD)apnName.size();
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx14Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x14;
-      pHeader->mLength = tlvx14Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
-      // Set the value
-      memcpy( (pOut + offset), apnName.c_str(), apnName.size() );
-
-      offset += tlvx14Sz;
+      tlvs.Add( 0x14, pAPNName, apnNameSz );
    }
 
    // Add Primary DNS, if specified
    if (pPrimaryDNS != 0)
    {
-      // Check size
-      WORD tlvx15Sz = sizeof( sWDSModifyProfileRequest_PrimaryDNS );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx15Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x15;
-      pHeader->mLength = tlvx15Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
       sWDSModifyProfileRequest_PrimaryDNS * pTLVx15;
-      pTLVx15 = (sWDSModifyProfileRequest_PrimaryDNS*)(pOut + offset);
-      memset( pTLVx15, 0, tlvx15Sz );
+      pTLVx15 = tlvs.Add <sWDSModifyProfileRequest_PrimaryDNS>( 0x15 );
 
       ULONG ip0 = (*pPrimaryDNS & 0x000000FF);
       ULONG ip1 = (*pPrimaryDNS & 0x0000FF00) >> 8;
@@ -501,29 +423,13 @@ ULONG PackSetDefaultProfile(
       pTLVx15->mIPV4Address[1] = (INT8)ip1;
       pTLVx15->mIPV4Address[2] = (INT8)ip2;
       pTLVx15->mIPV4Address[3] = (INT8)ip3;
-
-      offset += tlvx15Sz;
    }
 
    // Add Secondary DNS, if specified
    if (pSecondaryDNS != 0)
    {
-      // Check size
-      WORD tlvx16Sz = sizeof( sWDSModifyProfileRequest_SecondaryDNS );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx16Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x16;
-      pHeader->mLength = tlvx16Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
       sWDSModifyProfileRequest_SecondaryDNS * pTLVx16;
-      pTLVx16 = (sWDSModifyProfileRequest_SecondaryDNS*)(pOut + offset);
-      memset( pTLVx16, 0, tlvx16Sz );
+      pTLVx16 = tlvs.Add <sWDSModifyProfileRequest_SecondaryDNS>( 0x16 );
 
       ULONG ip0 = (*pSecondaryDNS & 0x000000FF);
       ULONG ip1 = (*pSecondaryDNS & 0x0000FF00) >> 8;
@@ -535,104 +441,36 @@ ULONG PackSetDefaultProfile(
       pTLVx16->mIPV4Address[1] = (INT8)ip1;
       pTLVx16->mIPV4Address[2] = (INT8)ip2;
       pTLVx16->mIPV4Address[3] = (INT8)ip3;
-
-      offset += tlvx16Sz;
    }
 
    // Add Username, if specified
    if (pUsername != 0)
    {
-      std::string username( pUsername );
-
-      // Check size
-      WORD tlvx1BSz = (WORD)username.size();
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx1BSz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x1B;
-      pHeader->mLength = tlvx1BSz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
-      // Set the value
-      memcpy( (pOut + offset), username.c_str(), username.size() );
-
-      offset += tlvx1BSz;
+      tlvs.Add( 0x1B, pUsername, usernameSz );
    }
 
    // Add Password, if specified
    if (pPassword != 0)
    {
-      std::string password( pPassword );
-
-      // Check size
-      WORD tlvx1CSz = (WORD)password.size();
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx1CSz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x1C;
-      pHeader->mLength = tlvx1CSz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
-      // Set the value
-      memcpy( (pOut + offset), password.c_str(), password.size() );
-
-      offset += tlvx1CSz;
+      tlvs.Add( 0x1C, pPassword, passwordSz );
    }
 
    // Add Authentication, if specified
    if (pAuthentication != 0)
    {
-      // Check size
-      WORD tlvx1DSz = sizeof( sWDSModifyProfileRequest_Authentication );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx1DSz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x1D;
-      pHeader->mLength = tlvx1DSz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
       sWDSModifyProfileRequest_Authentication * pTLVx1D;
-      pTLVx1D = (sWDSModifyProfileRequest_Authentication*)(pOut + offset);
-      memset( pTLVx1D, 0, tlvx1DSz );
+      pTLVx1D = tlvs.Add <sWDSModifyProfileRequest_Authentication>( 0x1D );
 
       // Set the value
       pTLVx1D->mEnablePAP = ((*pAuthentication & 0x00000001) != 0);
       pTLVx1D->mEnableCHAP = ((*pAuthentication & 0x00000002) != 0);
-
-      offset += tlvx1DSz;
    }
 
    // Add IP Address, if specified
    if (pIPAddress != 0)
    {
-      // Check size
-      WORD tlvx1ESz = sizeof( sWDSModifyProfileRequest_IPAddress );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx1ESz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x1E;
-      pHeader->mLength = tlvx1ESz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
       sWDSModifyProfileRequest_IPAddress * pTLVx1E;
-      pTLVx1E = (sWDSModifyProfileRequest_IPAddress*)(pOut + offset);
-      memset( pTLVx1E, 0, tlvx1ESz );
+      pTLVx1E = tlvs.Add <sWDSModifyProfileRequest_IPAddress>( 0x1E );
 
       ULONG ip0 = (*pIPAddress & 0x000000FF);
       ULONG ip1 = (*pIPAddress & 0x0000FF00) >> 8;
@@ -644,17 +482,17 @@ ULONG PackSetDefaultProfile(
       pTLVx1E->mIPV4Address[1] = (INT8)ip1;
       pTLVx1E->mIPV4Address[2] = (INT8)ip2;
       pTLVx1E->mIPV4Address[3] = (INT8)ip3;
-
-      offset += tlvx1ESz;
    }
 
    // At least one of the optional parameters must have been set
-   if (offset <= sizeof( sQMIRawContentHeader ) + tlvx01Sz)
+   ULONG reqSz = sizeof( sQMIRawContentHeader )
+               + sizeof( sWDSModifyProfileRequest_ProfileIdentifier );
+   if (tlvs.GetSize() <= reqSz)
    {
       return eGOBI_ERR_INVALID_ARG;
    }
 
-   *pOutLen = offset;
+   *pOutLen = tlvs.GetSize();
 
    return eGOBI_ERR_NONE;
 }
@@ -782,6 +620,9 @@ ULONG ParseGetDefaultProfile(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Set defaults
    *pPDPType = 0xffffffff;
    *pIPAddress = 0xffffffff;
@@ -795,7 +636,7 @@ ULONG ParseGetDefaultProfile(
    // Find the name
    const sWDSGetDefaultSettingsResponse_ProfileName * pTLVx10;
    ULONG outLenx10;
-   ULONG rc = GetTLV( inLen, pIn, 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
+   ULONG rc = tlvs.GetTLV( 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (nameSize < outLenx10 + 1)
@@ -812,7 +653,7 @@ ULONG ParseGetDefaultProfile(
    // Find the PDP type
    const sWDSGetDefaultSettingsResponse_PDPType * pTLVx11;
    ULONG outLenx11;
-   rc = GetTLV( inLen, pIn, 0x11, &outLenx11, (const BYTE **)&pTLVx11 );
+   rc = tlvs.GetTLV( 0x11, &outLenx11, (const BYTE **)&pTLVx11 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx11 < sizeof( sWDSGetDefaultSettingsResponse_PDPType ))
@@ -826,7 +667,7 @@ ULONG ParseGetDefaultProfile(
    // Find the APN name
    const sWDSGetDefaultSettingsResponse_APNName * pTLVx14;
    ULONG outLenx14;
-   rc = GetTLV( inLen, pIn, 0x14, &outLenx14, (const BYTE **)&pTLVx14 );
+   rc = tlvs.GetTLV( 0x14, &outLenx14, (const BYTE **)&pTLVx14 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (apnSize < outLenx14 + 1)
@@ -843,7 +684,7 @@ ULONG ParseGetDefaultProfile(
    // Find the Primary DNS
    const sWDSGetDefaultSettingsResponse_PrimaryDNS * pTLVx15;
    ULONG outLenx15;
-   rc = GetTLV( inLen, pIn, 0x15, &outLenx15, (const BYTE **)&pTLVx15 );
+   rc = tlvs.GetTLV( 0x15, &outLenx15, (const BYTE **)&pTLVx15 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx15 < sizeof( sWDSGetDefaultSettingsResponse_PrimaryDNS ))
@@ -862,7 +703,7 @@ ULONG ParseGetDefaultProfile(
    // Find the Secondary DNS
    const sWDSGetDefaultSettingsResponse_SecondaryDNS * pTLVx16;
    ULONG outLenx16;
-   rc = GetTLV( inLen, pIn, 0x16, &outLenx16, (const BYTE **)&pTLVx16 );
+   rc = tlvs.GetTLV( 0x16, &outLenx16, (const BYTE **)&pTLVx16 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx16 < sizeof( sWDSGetDefaultSettingsResponse_SecondaryDNS ))
@@ -881,7 +722,7 @@ ULONG ParseGetDefaultProfile(
    // Find the Username
    const sWDSGetDefaultSettingsResponse_APNName * pTLVx1B;
    ULONG outLenx1B;
-   rc = GetTLV( inLen, pIn, 0x1B, &outLenx1B, (const BYTE **)&pTLVx1B );
+   rc = tlvs.GetTLV( 0x1B, &outLenx1B, (const BYTE **)&pTLVx1B );
    if (rc == eGOBI_ERR_NONE)
    {
       if (userSize < outLenx1B + 1)
@@ -898,7 +739,7 @@ ULONG ParseGetDefaultProfile(
    // Find the Authentication
    const sWDSGetDefaultSettingsResponse_Authentication * pTLVx1D;
    ULONG outLenx1D;
-   rc = GetTLV( inLen, pIn, 0x1D, &outLenx1D, (const BYTE **)&pTLVx1D );
+   rc = tlvs.GetTLV( 0x1D, &outLenx1D, (const BYTE **)&pTLVx1D );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx1D < sizeof( sWDSGetDefaultSettingsResponse_Authentication ))
@@ -915,7 +756,7 @@ ULONG ParseGetDefaultProfile(
    // Find the IP Address
    const sWDSGetDefaultSettingsResponse_IPAddress * pTLVx1E;
    ULONG outLenx1E;
-   rc = GetTLV( inLen, pIn, 0x1E, &outLenx1E, (const BYTE **)&pTLVx1E );
+   rc = tlvs.GetTLV( 0x1E, &outLenx1E, (const BYTE **)&pTLVx1E );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx1E < sizeof( sWDSGetDefaultSettingsResponse_IPAddress ))
@@ -980,55 +821,39 @@ ULONG PackStartDataSession(
       return eGOBI_ERR_INVALID_ARG;
    }
 
-   sQMIRawContentHeader * pHeader;
-   ULONG offset = 0;
+   // Check size
+   cTLVWriter tlvs( pOut );
+   tlvs.Need <sWDSStartNetworkInterfaceRequest_TechnologyPreference>( pTechnology != 0 );
+   tlvs.Need <sWDSStartNetworkInterfaceRequest_PrimaryDNS>( pPrimaryDNS != 0 );
+   tlvs.Need <sWDSStartNetworkInterfaceRequest_SecondaryDNS>( pSecondaryDNS != 0 );
+   tlvs.Need <sWDSStartNetworkInterfaceRequest_PrimaryNBNS>( pPrimaryNBNS != 0 );
+   tlvs.Need <sWDSStartNetworkInterfaceRequest_SecondaryNBNS>( pSecondaryNBNS != 0 );
+   WORD apnNameSz = tlvs.NeedString( pAPNName );
+   tlvs.Need <sWDSStartNetworkInterfaceRequest_IPAddress>( pIPAddress != 0 );
+   tlvs.Need <sWDSStartNetworkInterfaceRequest_Authentication>( pAuthentication != 0 );
+   WORD usernameSz = tlvs.NeedString( pUsername );
+   WORD passwordSz = tlvs.NeedString( pPassword );
+   if (tlvs.Fits( *pOutLen ) == false)
+   {
+      return eGOBI_ERR_BUFFER_SZ;
+   }
 
    // Add technology, if specified
    if (pTechnology != 0)
    {
-      // Check size
-      WORD tlvx30Sz = sizeof( sWDSStartNetworkInterfaceRequest_TechnologyPreference );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx30Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x30;
-      pHeader->mLength = tlvx30Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
       sWDSStartNetworkInterfaceRequest_TechnologyPreference * pTLVx30;
-      pTLVx30 = (sWDSStartNetworkInterfaceRequest_TechnologyPreference*)(pOut + offset);
-      memset( pTLVx30, 0, tlvx30Sz );
+      pTLVx30 = tlvs.Add <sWDSStartNetworkInterfaceRequest_TechnologyPreference>( 0x30 );
 
       // Set the value
       pTLVx30->mEnable3GPP = ((*pTechnology & 0x00000001) != 0);
       pTLVx30->mEnable3GPP2 = ((*pTechnology & 0x00000002) != 0);
-
-      offset += tlvx30Sz;
    }
 
    // Add Primary DNS, if specified
    if (pPrimaryDNS != 0)
    {
-      // Check size
-      WORD tlvx10Sz = sizeof( sWDSStartNetworkInterfaceRequest_PrimaryDNS );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx10Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x10;
-      pHeader->mLength = tlvx10Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
       sWDSStartNetworkInterfaceRequest_PrimaryDNS * pTLVx10;
-      pTLVx10 = (sWDSStartNetworkInterfaceRequest_PrimaryDNS*)(pOut + offset);
-      memset( pTLVx10, 0, tlvx10Sz );
+      pTLVx10 = tlvs.Add <sWDSStartNetworkInterfaceRequest_PrimaryDNS>( 0x10 );
 
       ULONG ip0 = (*pPrimaryDNS & 0x000000FF);
       ULONG ip1 = (*pPrimaryDNS & 0x0000FF00) >> 8;
@@ -1040,29 +865,13 @@ ULONG PackStartDataSession(
       pTLVx10->mIPV4Address[1] = (INT8)ip1;
       pTLVx10->mIPV4Address[2] = (INT8)ip2;
       pTLVx10->mIPV4Address[3] = (INT8)ip3;
-
-      offset += tlvx10Sz;
    }
 
    // Add Secondary DNS, if specified
    if (pSecondaryDNS != 0)
    {
-      // Check size
-      WORD tlvx11Sz = sizeof( sWDSStartNetworkInterfaceRequest_SecondaryDNS );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx11Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x11;
-      pHeader->mLength = tlvx11Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
       sWDSStartNetworkInterfaceRequest_SecondaryDNS * pTLVx11;
-      pTLVx11 = (sWDSStartNetworkInterfaceRequest_SecondaryDNS*)(pOut + offset);
-      memset( pTLVx11, 0, tlvx11Sz );
+      pTLVx11 = tlvs.Add <sWDSStartNetworkInterfaceRequest_SecondaryDNS>( 0x11 );
 
       ULONG ip0 = (*pSecondaryDNS & 0x000000FF);
       ULONG ip1 = (*pSecondaryDNS & 0x0000FF00) >> 8;
@@ -1074,29 +883,13 @@ ULONG PackStartDataSession(
       pTLVx11->mIPV4Address[1] = (INT8)ip1;
       pTLVx11->mIPV4Address[2] = (INT8)ip2;
       pTLVx11->mIPV4Address[3] = (INT8)ip3;
-
-      offset += tlvx11Sz;
    }
 
    // Add Primary NBNS, if specified
    if (pPrimaryNBNS != 0)
    {
-      // Check size
-      WORD tlvx12Sz = sizeof( sWDSStartNetworkInterfaceRequest_PrimaryNBNS );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx12Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x12;
-      pHeader->mLength = tlvx12Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
       sWDSStartNetworkInterfaceRequest_PrimaryNBNS * pTLVx12;
-      pTLVx12 = (sWDSStartNetworkInterfaceRequest_PrimaryNBNS*)(pOut + offset);
-      memset( pTLVx12, 0, tlvx12Sz );
+      pTLVx12 = tlvs.Add <sWDSStartNetworkInterfaceRequest_PrimaryNBNS>( 0x12 );
 
       ULONG ip0 = (*pPrimaryNBNS & 0x000000FF);
       ULONG ip1 = (*pPrimaryNBNS & 0x0000FF00) >> 8;
@@ -1108,29 +901,13 @@ ULONG PackStartDataSession(
       pTLVx12->mIPV4Address[1] = (INT8)ip1;
       pTLVx12->mIPV4Address[2] = (INT8)ip2;
       pTLVx12->mIPV4Address[3] = (INT8)ip3;
-
-      offset += tlvx12Sz;
    }
 
    // Add Secondary NBNS, if specified
    if (pSecondaryNBNS != 0)
    {
-      // Check size
-      WORD tlvx13Sz = sizeof( sWDSStartNetworkInterfaceRequest_SecondaryNBNS );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx13Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x13;
-      pHeader->mLength = tlvx13Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
       sWDSStartNetworkInterfaceRequest_SecondaryNBNS * pTLVx13;
-      pTLVx13 = (sWDSStartNetworkInterfaceRequest_SecondaryNBNS*)(pOut + offset);
-      memset( pTLVx13, 0, tlvx13Sz );
+      pTLVx13 = tlvs.Add <sWDSStartNetworkInterfaceRequest_SecondaryNBNS>( 0x13 );
 
       ULONG ip0 = (*pSecondaryNBNS & 0x000000FF);
       ULONG ip1 = (*pSecondaryNBNS & 0x0000FF00) >> 8;
@@ -1142,53 +919,19 @@ ULONG PackStartDataSession(
       pTLVx13->mIPV4Address[1] = (INT8)ip1;
       pTLVx13->mIPV4Address[2] = (INT8)ip2;
       pTLVx13->mIPV4Address[3] = (INT8)ip3;
-
-      offset += tlvx13Sz;
    }
 
    // Add APN Name, if specified
    if (pAPNName != 0)
    {
-      std::string apnName( pAPNName );
-
-      // Check size
-      WORD tlvx14Sz = (WORD)apnName.size();
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx14Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x14;
-      pHeader->mLength = tlvx14Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
-      // Set the value
-      memcpy( (pOut + offset), apnName.c_str(), apnName.size() );
-
-      offset += tlvx14Sz;
+      tlvs.Add( 0x14, pAPNName, apnNameSz );
    }
 
    // Add IP Address, if specified
    if (pIPAddress != 0)
    {
-      // Check size
-      WORD tlvx15Sz = sizeof( sWDSStartNetworkInterfaceRequest_IPAddress );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx15Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x15;
-      pHeader->mLength = tlvx15Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
       sWDSStartNetworkInterfaceRequest_IPAddress * pTLVx15;
-      pTLVx15 = (sWDSStartNetworkInterfaceRequest_IPAddress*)(pOut + offset);
-      memset( pTLVx15, 0, tlvx15Sz );
+      pTLVx15 = tlvs.Add <sWDSStartNetworkInterfaceRequest_IPAddress>( 0x15 );
 
       ULONG ip0 = (*pIPAddress & 0x000000FF);
       ULONG ip1 = (*pIPAddress & 0x0000FF00) >> 8;
@@ -1200,86 +943,32 @@ ULONG PackStartDataSession(
       pTLVx15->mIPV4Address[1] = (INT8)ip1;
       pTLVx15->mIPV4Address[2] = (INT8)ip2;
       pTLVx15->mIPV4Address[3] = (INT8)ip3;
-
-      offset += tlvx15Sz;
    }
 
    // Add Authentication, if specified
    if (pAuthentication != 0)
    {
-      // Check size
-      WORD tlvx16Sz = sizeof( sWDSStartNetworkInterfaceRequest_Authentication );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx16Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x16;
-      pHeader->mLength = tlvx16Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
       sWDSStartNetworkInterfaceRequest_Authentication * pTLVx16;
-      pTLVx16 = (sWDSStartNetworkInterfaceRequest_Authentication*)(pOut + offset);
-      memset( pTLVx16, 0, tlvx16Sz );
+      pTLVx16 = tlvs.Add <sWDSStartNetworkInterfaceRequest_Authentication>( 0x16 );
 
       // Set the value
       pTLVx16->mEnablePAP = ((*pAuthentication & 0x00000001) != 0);
       pTLVx16->mEnableCHAP = ((*pAuthentication & 0x00000002) != 0);
-
-      offset += tlvx16Sz;
    }
 
    // Add Username, if specified
    if (pUsername != 0)
    {
-      std::string username( pUsername );
-
-      // Check size
-      WORD tlvx17Sz = (WORD)username.size();
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx17Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x17;
-      pHeader->mLength = tlvx17Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
-      // Set the value
-      memcpy( (pOut + offset), username.c_str(), username.size() );
-
-      offset += tlvx17Sz;
+      tlvs.Add( 0x17, pUsername, usernameSz );
    }
 
    // Add Password, if specified
    if (pPassword != 0)
    {
-      std::string password( pPassword );
-
-      // Check size
-      WORD tlvx18Sz = (WORD)password.size();
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx18Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x18;
-      pHeader->mLength = tlvx18Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
-      // Set the value
-      memcpy( (pOut + offset), password.c_str(), password.size() );
-
-      offset += tlvx18Sz;
+      tlvs.Add( 0x18, pPassword, passwordSz );
    }
 
-   *pOutLen = offset;
+   *pOutLen = tlvs.GetSize();
 
    return eGOBI_ERR_NONE;
 }
@@ -1314,10 +1003,13 @@ ULONG ParseStartDataSession(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Check mandatory response
    const sResultCode * pTLVx02;
    ULONG outLenx02;
-   ULONG rc = GetTLV( inLen, pIn, 0x02, &outLenx02, (const BYTE **)&pTLVx02 );
+   ULONG rc = tlvs.GetTLV( 0x02, &outLenx02, (const BYTE **)&pTLVx02 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -1338,7 +1030,7 @@ ULONG ParseStartDataSession(
       // Still parse call end reason, if present
       const sWDSStartNetworkInterfaceResponse_CallEndReason * pTLVx10;
       ULONG outLenx10;
-      ULONG rc2 = GetTLV( inLen, pIn, 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
+      ULONG rc2 = tlvs.GetTLV( 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
       if (rc2 == eGOBI_ERR_NONE)
       {
          if (outLenx10 >= sizeof( sWDSStartNetworkInterfaceResponse_CallEndReason ))
@@ -1353,7 +1045,7 @@ ULONG ParseStartDataSession(
    // Find the Session ID
    const sWDSStartNetworkInterfaceResponse_PacketDataHandle * pTLVx01;
    ULONG outLenx01;
-   rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx01 < sizeof( sWDSStartNetworkInterfaceResponse_PacketDataHandle ))
@@ -1504,10 +1196,13 @@ ULONG ParseGetIPAddress(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Find the IP Address
    const sWDSGetDefaultSettingsResponse_IPAddress * pTLVx1E;
    ULONG outLenx1E;
-   ULONG rc = GetTLV( inLen, pIn, 0x1E, &outLenx1E, (const BYTE **)&pTLVx1E );
+   ULONG rc = tlvs.GetTLV( 0x1E, &outLenx1E, (const BYTE **)&pTLVx1E );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx1E < sizeof( sWDSGetDefaultSettingsResponse_IPAddress ))
@@ -1564,10 +1259,13 @@ ULONG ParseGetConnectionRate(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Find the rates
    const sWDSGetChannelRatesResponse_ChannelRates * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx01 < sizeof( sWDSGetChannelRatesResponse_ChannelRates ))
@@ -1689,12 +1387,15 @@ ULONG ParseGetPacketStatus(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // NOTE: All TLVs are required.  If any fail then all fail
 
    // Find the TX packet sucesses
    const sWDSGetPacketStatisticsResponse_TXPacketSuccesses * pTLVx10;
    ULONG outLenx10;
-   ULONG rc = GetTLV( inLen, pIn, 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
+   ULONG rc = tlvs.GetTLV( 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx10 < sizeof( sWDSGetPacketStatisticsResponse_TXPacketSuccesses ))
@@ -1710,7 +1411,7 @@ ULONG ParseGetPacketStatus(
    // Find the RX packet sucesses
    const sWDSGetPacketStatisticsResponse_RXPacketSuccesses * pTLVx11;
    ULONG outLenx11;
-   rc = GetTLV( inLen, pIn, 0x11, &outLenx11, (const BYTE **)&pTLVx11 );
+   rc = tlvs.GetTLV( 0x11, &outLenx11, (const BYTE **)&pTLVx11 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx11 < sizeof( sWDSGetPacketStatisticsResponse_RXPacketSuccesses ))
@@ -1726,7 +1427,7 @@ ULONG ParseGetPacketStatus(
    // Find the TX packet errors
    const sWDSGetPacketStatisticsResponse_TXPacketErrors * pTLVx12;
    ULONG outLenx12;
-   rc = GetTLV( inLen, pIn, 0x12, &outLenx12, (const BYTE **)&pTLVx12 );
+   rc = tlvs.GetTLV( 0x12, &outLenx12, (const BYTE **)&pTLVx12 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx12 < sizeof( sWDSGetPacketStatisticsResponse_TXPacketErrors ))
@@ -1742,7 +1443,7 @@ ULONG ParseGetPacketStatus(
    // Find the RX packet errors
    const sWDSGetPacketStatisticsResponse_RXPacketErrors * pTLVx13;
    ULONG outLenx13;
-   rc = GetTLV( inLen, pIn, 0x13, &outLenx13, (const BYTE **)&pTLVx13 );
+   rc = tlvs.GetTLV( 0x13, &outLenx13, (const BYTE **)&pTLVx13 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx13 < sizeof( sWDSGetPacketStatisticsResponse_RXPacketErrors ))
@@ -1758,7 +1459,7 @@ ULONG ParseGetPacketStatus(
    // Find the TX packet overflows
    const sWDSGetPacketStatisticsResponse_TXOverflows * pTLVx14;
    ULONG outLenx14;
-   rc = GetTLV( inLen, pIn, 0x14, &outLenx14, (const BYTE **)&pTLVx14 );
+   rc = tlvs.GetTLV( 0x14, &outLenx14, (const BYTE **)&pTLVx14 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx14 < sizeof( sWDSGetPacketStatisticsResponse_TXOverflows ))
@@ -1774,7 +1475,7 @@ ULONG ParseGetPacketStatus(
    // Find the RX packet overflows
    const sWDSGetPacketStatisticsResponse_RXOverflows * pTLVx15;
    ULONG outLenx15;
-   rc = GetTLV( inLen, pIn, 0x15, &outLenx15, (const BYTE **)&pTLVx15 );
+   rc = tlvs.GetTLV( 0x15, &outLenx15, (const BYTE **)&pTLVx15 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx15 < sizeof( sWDSGetPacketStatisticsResponse_RXOverflows ))
@@ -1885,12 +1586,15 @@ ULONG ParseGetByteTotals(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // NOTE: All TLVs are required.  If any fail then all fail
 
    // Find the TX bytes
    const sWDSGetPacketStatisticsResponse_TXBytes * pTLVx19;
    ULONG outLenx19;
-   ULONG rc = GetTLV( inLen, pIn, 0x19, &outLenx19, (const BYTE **)&pTLVx19 );
+   ULONG rc = tlvs.GetTLV( 0x19, &outLenx19, (const BYTE **)&pTLVx19 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx19 < sizeof( sWDSGetPacketStatisticsResponse_TXBytes ))
@@ -1906,7 +1610,7 @@ ULONG ParseGetByteTotals(
    // Find the RX bytes
    const sWDSGetPacketStatisticsResponse_RXBytes * pTLVx1A;
    ULONG outLenx1A;
-   rc = GetTLV( inLen, pIn, 0x1A, &outLenx1A, (const BYTE **)&pTLVx1A );
+   rc = tlvs.GetTLV( 0x1A, &outLenx1A, (const BYTE **)&pTLVx1A );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx1A < sizeof( sWDSGetPacketStatisticsResponse_RXBytes ))
@@ -2008,10 +1712,13 @@ ULONG ParseGetMobileIP(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Find the mode
    const sWDSGetMIPModeResponse_MobileIPMode * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx01 < sizeof( sWDSGetMIPModeResponse_MobileIPMode ))
@@ -2119,10 +1826,13 @@ ULONG ParseGetActiveMobileIPProfile(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Find the mode
    const sWDSGetActiveMIPProfileResponse_Index * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx01 < sizeof( sWDSGetActiveMIPProfileResponse_Index ))
@@ -2198,73 +1908,45 @@ ULONG PackSetMobileIPProfile(
    }
 
    // Check size
-   WORD tlvx01Sz = sizeof( sWDSSetMIPProfileRequest_Index );
-   if (*pOutLen < sizeof( sQMIRawContentHeader ) + tlvx01Sz)
+   cTLVWriter tlvs( pOut );
+   tlvs.Need <sWDSSetMIPProfileRequest_Index>();
+   tlvs.Need <sWDSSetMIPProfileRequest_State>( pEnabled != 0 );
+   tlvs.Need <sWDSSetMIPProfileRequest_HomeAddress>( pAddress != 0 );
+   tlvs.Need <sWDSSetMIPProfileRequest_PrimaryHomeAgentAddress>( pPrimaryHA != 0 );
+   tlvs.Need <sWDSSetMIPProfileRequest_SecondaryHomeAgentAddress>( pSecondaryHA != 0 );
+   tlvs.Need <sWDSSetMIPProfileRequest_ReverseTunneling>( pRevTunneling != 0 );
+   WORD naiSz = tlvs.NeedString( pNAI );
+   tlvs.Need <sWDSSetMIPProfileRequest_HASPI>( pHASPI != 0 );
+   tlvs.Need <sWDSSetMIPProfileRequeste_AAASPI>( pAAASPI != 0 );
+   WORD mnhaSz = tlvs.NeedString( pMNHA );
+   WORD mnaaaSz = tlvs.NeedString( pMNAAA );
+   if (tlvs.Fits( *pOutLen ) == false)
    {
       return eGOBI_ERR_BUFFER_SZ;
    }
 
-   sQMIRawContentHeader * pHeader = (sQMIRawContentHeader*)pOut;
-   pHeader->mTypeID = 0x01;
-   pHeader->mLength = tlvx01Sz;
-
-   ULONG offset = sizeof( sQMIRawContentHeader );
-
    sWDSSetMIPProfileRequest_Index * pTLVx01;
-   pTLVx01 = (sWDSSetMIPProfileRequest_Index*)(pOut + offset);
-   memset( pTLVx01, 0, tlvx01Sz );
+   pTLVx01 = tlvs.Add <sWDSSetMIPProfileRequest_Index>( 0x01 );
 
    // Set the values
    memcpy( &pTLVx01->mSPC[0], spc.c_str(), spc.size() );
    pTLVx01->mProfileIndex = index;
 
-   offset += tlvx01Sz;
-
    // Add Enabled, if specified
    if (pEnabled != 0)
    {
-      // Check size
-      WORD tlvx10Sz = sizeof( sWDSSetMIPProfileRequest_State );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx10Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x10;
-      pHeader->mLength = tlvx10Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
       sWDSSetMIPProfileRequest_State * pTLVx10;
-      pTLVx10 = (sWDSSetMIPProfileRequest_State*)(pOut + offset);
-      memset( pTLVx10, 0, tlvx10Sz );
+      pTLVx10 = tlvs.Add <sWDSSetMIPProfileRequest_State>( 0x10 );
 
       // Set the value
       pTLVx10->mEnabled = (*pEnabled == 0 ? 0 : 1);
-
-      offset += tlvx10Sz;
    }
 
    // Add Home Address, if specified
    if (pAddress != 0)
    {
-      // Check size
-      WORD tlvx11Sz = sizeof( sWDSSetMIPProfileRequest_HomeAddress );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx11Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x11;
-      pHeader->mLength = tlvx11Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
       sWDSSetMIPProfileRequest_HomeAddress * pTLVx11;
-      pTLVx11 = (sWDSSetMIPProfileRequest_HomeAddress*)(pOut + offset);
-      memset( pTLVx11, 0, tlvx11Sz );
+      pTLVx11 = tlvs.Add <sWDSSetMIPProfileRequest_HomeAddress>( 0x11 );
 
       ULONG ip0 = (*pAddress & 0x000000FF);
       ULONG ip1 = (*pAddress & 0x0000FF00) >> 8;
@@ -2276,29 +1958,13 @@ ULONG PackSetMobileIPProfile(
       pTLVx11->mIPV4Address[1] = (INT8)ip1;
       pTLVx11->mIPV4Address[2] = (INT8)ip2;
       pTLVx11->mIPV4Address[3] = (INT8)ip3;
-
-      offset += tlvx11Sz;
    }
 
    // Add Primary Home Agent Address, if specified
    if (pPrimaryHA != 0)
    {
-      // Check size
-      WORD tlvx12Sz = sizeof( sWDSSetMIPProfileRequest_PrimaryHomeAgentAddress );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx12Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x12;
-      pHeader->mLength = tlvx12Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
       sWDSSetMIPProfileRequest_PrimaryHomeAgentAddress * pTLVx12;
-      pTLVx12 = (sWDSSetMIPProfileRequest_PrimaryHomeAgentAddress*)(pOut + offset);
-      memset( pTLVx12, 0, tlvx12Sz );
+      pTLVx12 = tlvs.Add <sWDSSetMIPProfileRequest_PrimaryHomeAgentAddress>( 0x12 );
 
       ULONG ip0 = (*pPrimaryHA & 0x000000FF);
       ULONG ip1 = (*pPrimaryHA & 0x0000FF00) >> 8;
@@ -2310,29 +1976,13 @@ ULONG PackSetMobileIPProfile(
       pTLVx12->mIPV4Address[1] = (INT8)ip1;
       pTLVx12->mIPV4Address[2] = (INT8)ip2;
       pTLVx12->mIPV4Address[3] = (INT8)ip3;
-
-      offset += tlvx12Sz;
    }
 
    // Add Secondary Home Agent Address, if specified
    if (pSecondaryHA != 0)
    {
-      // Check size
-      WORD tlvx13Sz = sizeof( sWDSSetMIPProfileRequest_SecondaryHomeAgentAddress );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx13Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x13;
-      pHeader->mLength = tlvx13Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
       sWDSSetMIPProfileRequest_SecondaryHomeAgentAddress * pTLVx13;
-      pTLVx13 = (sWDSSetMIPProfileRequest_SecondaryHomeAgentAddress*)(pOut + offset);
-      memset( pTLVx13, 0, tlvx13Sz );
+      pTLVx13 = tlvs.Add <sWDSSetMIPProfileRequest_SecondaryHomeAgentAddress>( 0x13 );
 
       ULONG ip0 = (*pSecondaryHA & 0x000000FF);
       ULONG ip1 = (*pSecondaryHA & 0x0000FF00) >> 8;
@@ -2344,167 +1994,65 @@ ULONG PackSetMobileIPProfile(
       pTLVx13->mIPV4Address[1] = (INT8)ip1;
       pTLVx13->mIPV4Address[2] = (INT8)ip2;
       pTLVx13->mIPV4Address[3] = (INT8)ip3;
-
-      offset += tlvx13Sz;
    }
 
    // Add reverse tunneling, if specified
    if (pRevTunneling != 0)
    {
-      // Check size
-      WORD tlvx14Sz = sizeof( sWDSSetMIPProfileRequest_ReverseTunneling );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx14Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x14;
-      pHeader->mLength = tlvx14Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
       sWDSSetMIPProfileRequest_ReverseTunneling * pTLVx14;
-      pTLVx14 = (sWDSSetMIPProfileRequest_ReverseTunneling*)(pOut + offset);
-      memset( pTLVx14, 0, tlvx14Sz );
+      pTLVx14 = tlvs.Add <sWDSSetMIPProfileRequest_ReverseTunneling>( 0x14 );
 
       // Set the value
       pTLVx14->mReverseTunneling = (*pRevTunneling == 0 ? 0 : 1);
-
-      offset += tlvx14Sz;
    }
 
    // Add NAI, if specified
    if (pNAI != 0)
    {
-      std::string nai( pNAI );
-
-      // Check size
-      WORD tlvx15Sz = (WORD)nai.size();
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx15Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x15;
-      pHeader->mLength = tlvx15Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
-      // Set the value
-      memcpy( (pOut + offset), nai.c_str(), nai.size() );
-
-      offset += tlvx15Sz;
+      tlvs.Add( 0x15, pNAI, naiSz );
    }
 
    // Add HA SPI, if specified
    if (pHASPI != 0)
    {
-      // Check size
-      WORD tlvx16Sz = sizeof( sWDSSetMIPProfileRequest_HASPI );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx16Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x16;
-      pHeader->mLength = tlvx16Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
       sWDSSetMIPProfileRequest_HASPI * pTLVx16;
-      pTLVx16 = (sWDSSetMIPProfileRequest_HASPI*)(pOut + offset);
-      memset( pTLVx16, 0, tlvx16Sz );
+      pTLVx16 = tlvs.Add <sWDSSetMIPProfileRequest_HASPI>( 0x16 );
 
       // Set the value
       pTLVx16->mHASPI = *pHASPI;
-
-      offset += tlvx16Sz;
    }
 
    // Add AAA SPI, if specified
    if (pAAASPI != 0)
    {
-      // Check size
-      WORD tlvx17Sz = sizeof( sWDSSetMIPProfileRequeste_AAASPI );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx17Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x17;
-      pHeader->mLength = tlvx17Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
       sWDSSetMIPProfileRequeste_AAASPI * pTLVx17;
-      pTLVx17 = (sWDSSetMIPProfileRequeste_AAASPI*)(pOut + offset);
-      memset( pTLVx17, 0, tlvx17Sz );
+      pTLVx17 = tlvs.Add <sWDSSetMIPProfileRequeste_AAASPI>( 0x17 );
 
       // Set the value
       pTLVx17->mAAASPI = *pAAASPI;
-
-      offset += tlvx17Sz;
    }
 
    // Add MN-HA key, if specified
    if (pMNHA != 0)
    {
-      std::string mnha( pMNHA );
-
-      // Check size
-      WORD tlvx18Sz = (WORD)mnha.size();
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx18Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x18;
-      pHeader->mLength = tlvx18Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
-      // Set the value
-      memcpy( (pOut + offset), mnha.c_str(), mnha.size() );
-
-      offset += tlvx18Sz;
+      tlvs.Add( 0x18, pMNHA, mnhaSz );
    }
 
    // Add MN-AAA key, if specified
-   if (pMNHA != 0)
+   if (pMNAAA != 0)
    {
-      std::string mnaaa( pMNAAA );
-
-      // Check size
-      WORD tlvx19Sz = (WORD)mnaaa.size();
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx19Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x19;
-      pHeader->mLength = tlvx19Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
-      // Set the value
-      memcpy( (pOut + offset), mnaaa.c_str(), mnaaa.size() );
-
-      offset += tlvx19Sz;
+      tlvs.Add( 0x19, pMNAAA, mnaaaSz );
    }
 
    // At least one of the optional parameters must have been set
-   if (offset <= sizeof( sQMIRawContentHeader ) + tlvx01Sz)
+   ULONG reqSz = sizeof( sQMIRawContentHeader )
+               + sizeof( sWDSSetMIPProfileRequest_Index );
+   if (tlvs.GetSize() <= reqSz)
    {
       return eGOBI_ERR_INVALID_ARG;
    }
 
-   *pOutLen = offset;
+   *pOutLen = tlvs.GetSize();
 
    return eGOBI_ERR_NONE;
 }
@@ -2621,6 +2169,9 @@ ULONG ParseGetMobileIPProfile(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Assume errors
    *pEnabled = 0xff;
    *pAddress = 0xffffffff;
@@ -2635,7 +2186,7 @@ ULONG ParseGetMobileIPProfile(
    // Find the State
    const sWDSGetMIPProfileResponse_State * pTLVx10;
    ULONG outLenx10;
-   ULONG rc = GetTLV( inLen, pIn, 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
+   ULONG rc = tlvs.GetTLV( 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx10 < sizeof( sWDSGetMIPProfileResponse_State ))
@@ -2649,7 +2200,7 @@ ULONG ParseGetMobileIPProfile(
    // Find the Home Address
    const sWDSGetMIPProfileResponse_HomeAddress * pTLVx11;
    ULONG outLenx11;
-   rc = GetTLV( inLen, pIn, 0x11, &outLenx11, (const BYTE **)&pTLVx11 );
+   rc = tlvs.GetTLV( 0x11, &outLenx11, (const BYTE **)&pTLVx11 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx11 < sizeof( sWDSGetMIPProfileResponse_HomeAddress ))
@@ -2668,7 +2219,7 @@ ULONG ParseGetMobileIPProfile(
    // Find the Primary Home Agent Address
    const sWDSGetMIPProfileResponse_PrimaryHomeAgentAddress * pTLVx12;
    ULONG outLenx12;
-   rc = GetTLV( inLen, pIn, 0x12, &outLenx12, (const BYTE **)&pTLVx12 );
+   rc = tlvs.GetTLV( 0x12, &outLenx12, (const BYTE **)&pTLVx12 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx12 < sizeof( sWDSGetMIPProfileResponse_PrimaryHomeAgentAddress ))
@@ -2687,7 +2238,7 @@ ULONG ParseGetMobileIPProfile(
    // Find the Secondary Home Agent Address
    const sWDSGetMIPProfileResponse_SecondaryHomeAgentAddress * pTLVx13;
    ULONG outLenx13;
-   rc = GetTLV( inLen, pIn, 0x13, &outLenx13, (const BYTE **)&pTLVx13 );
+   rc = tlvs.GetTLV( 0x13, &outLenx13, (const BYTE **)&pTLVx13 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx13 < sizeof( sWDSGetMIPProfileResponse_SecondaryHomeAgentAddress ))
@@ -2706,7 +2257,7 @@ ULONG ParseGetMobileIPProfile(
    // Find the Reverse tunneling, if enabled
    const sWDSGetMIPProfileResponse_ReverseTunneling * pTLVx14;
    ULONG outLenx14;
-   rc = GetTLV( inLen, pIn, 0x14, &outLenx14, (const BYTE **)&pTLVx14 );
+   rc = tlvs.GetTLV( 0x14, &outLenx14, (const BYTE **)&pTLVx14 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx10 < sizeof( sWDSGetMIPProfileResponse_ReverseTunneling ))
@@ -2720,7 +2271,7 @@ ULONG ParseGetMobileIPProfile(
    // Find the NAI, if enabled
    const sWDSGetMIPProfileResponse_NAI * pTLVx15;
    ULONG outLenx15;
-   rc = GetTLV( inLen, pIn, 0x15, &outLenx15, (const BYTE **)&pTLVx15 );
+   rc = tlvs.GetTLV( 0x15, &outLenx15, (const BYTE **)&pTLVx15 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (naiSize < outLenx15 + 1)
@@ -2737,7 +2288,7 @@ ULONG ParseGetMobileIPProfile(
    // Find the HA SPI
    const sWDSGetMIPProfileResponse_HASPI * pTLVx16;
    ULONG outLenx16;
-   rc = GetTLV( inLen, pIn, 0x16, &outLenx16, (const BYTE **)&pTLVx16 );
+   rc = tlvs.GetTLV( 0x16, &outLenx16, (const BYTE **)&pTLVx16 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx16 < sizeof( sWDSGetMIPProfileResponse_HASPI ))
@@ -2751,7 +2302,7 @@ ULONG ParseGetMobileIPProfile(
    // Find the AAA SPI
    const sWDSGetMIPProfileResponse_AAASPI * pTLVx17;
    ULONG outLenx17;
-   rc = GetTLV( inLen, pIn, 0x17, &outLenx17, (const BYTE **)&pTLVx17 );
+   rc = tlvs.GetTLV( 0x17, &outLenx17, (const BYTE **)&pTLVx17 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx17 < sizeof( sWDSGetMIPProfileResponse_AAASPI ))
@@ -2765,7 +2316,7 @@ ULONG ParseGetMobileIPProfile(
    // Find the HA state
    const sWDSGetMIPProfileResponse_HAState * pTLVx1A;
    ULONG outLenx1A;
-   rc = GetTLV( inLen, pIn, 0x1A, &outLenx1A, (const BYTE **)&pTLVx1A );
+   rc = tlvs.GetTLV( 0x1A, &outLenx1A, (const BYTE **)&pTLVx1A );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx1A < sizeof( sWDSGetMIPProfileResponse_HAState ))
@@ -2779,7 +2330,7 @@ ULONG ParseGetMobileIPProfile(
    // Find the AAA state
    const sWDSGetMIPProfileResponse_AAAState * pTLVx1B;
    ULONG outLenx1B;
-   rc = GetTLV( inLen, pIn, 0x1B, &outLenx1B, (const BYTE **)&pTLVx1B );
+   rc = tlvs.GetTLV( 0x1B, &outLenx1B, (const BYTE **)&pTLVx1B );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx1B < sizeof( sWDSGetMIPProfileResponse_AAAState ))
@@ -2847,216 +2398,105 @@ ULONG PackSetMobileIPParameters(
    }
 
    // Check size
-   WORD tlvx01Sz = sizeof( sWDSSetMIPParametersRequest_SPC );
-   if (*pOutLen < sizeof( sQMIRawContentHeader ) + tlvx01Sz)
+   cTLVWriter tlvs( pOut );
+   tlvs.Need <sWDSSetMIPParametersRequest_SPC>();
+   tlvs.Need <sWDSSetMIPParametersRequest_MobileIPMode>( pMode != 0 );
+   tlvs.Need <sWDSSetMIPParametersRequest_RetryAttemptLimit>( pRetryLimit != 0 );
+   tlvs.Need <sWDSSetMIPParametersRequest_RetryAttemptInterval>( pRetryInterval != 0 );
+   tlvs.Need <sWDSSetMIPParametersRequest_ReRegistrationPeriod>( pReRegPeriod != 0 );
+   tlvs.Need <sWDSSetMIPParametersRequest_ReRegistrationOnlyWithTraffic>( pReRegTraffic != 0 );
+   tlvs.Need <sWDSSetMIPParametersRequest_MNHAAuthenticatorCalculator>( pHAAuthenticator != 0 );
+   tlvs.Need <sWDSSetMIPParametersRequest_MNHARFC2002BISAuthentication>( pHA2002bis != 0 );
+   if (tlvs.Fits( *pOutLen ) == false)
    {
       return eGOBI_ERR_BUFFER_SZ;
    }
 
-   sQMIRawContentHeader * pHeader = (sQMIRawContentHeader*)pOut;
-   pHeader->mTypeID = 0x01;
-   pHeader->mLength = tlvx01Sz;
-
-   ULONG offset = sizeof( sQMIRawContentHeader );
-
    sWDSSetMIPParametersRequest_SPC * pTLVx01;
-   pTLVx01 = (sWDSSetMIPParametersRequest_SPC*)(pOut + offset);
-   memset( pTLVx01, 0, tlvx01Sz );
+   pTLVx01 = tlvs.Add <sWDSSetMIPParametersRequest_SPC>( 0x01 );
 
    // Set the values
    memcpy( &pTLVx01->mSPC[0], spc.c_str(), spc.size() );
 
-   offset += tlvx01Sz;
-
    // Add Mode, if specified
    if (pMode != 0)
    {
-      // Check size
-      WORD tlvx10Sz = sizeof( sWDSSetMIPParametersRequest_MobileIPMode );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx10Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x10;
-      pHeader->mLength = tlvx10Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
       sWDSSetMIPParametersRequest_MobileIPMode * pTLVx10;
-      pTLVx10 = (sWDSSetMIPParametersRequest_MobileIPMode*)(pOut + offset);
-      memset( pTLVx10, 0, tlvx10Sz );
+      pTLVx10 = tlvs.Add <sWDSSetMIPParametersRequest_MobileIPMode>( 0x10 );
 
       // Set the value
       pTLVx10->mMIPMode = (eQMIMobileIPModes)*pMode;
-
-      offset += tlvx10Sz;
    }
 
    // Add Retry Limit, if specified
    if (pRetryLimit != 0)
    {
-      // Check size
-      WORD tlvx11Sz = sizeof( sWDSSetMIPParametersRequest_RetryAttemptLimit );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx11Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x11;
-      pHeader->mLength = tlvx11Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
       sWDSSetMIPParametersRequest_RetryAttemptLimit * pTLVx11;
-      pTLVx11 = (sWDSSetMIPParametersRequest_RetryAttemptLimit*)(pOut + offset);
-      memset( pTLVx11, 0, tlvx11Sz );
+      pTLVx11 = tlvs.Add <sWDSSetMIPParametersRequest_RetryAttemptLimit>( 0x11 );
 
       // Set the value
       pTLVx11->mRetryAttemptLimit = *pRetryLimit;
-
-      offset += tlvx11Sz;
    }
 
    // Add Retry interval, if specified
    if (pRetryInterval != 0)
    {
-      // Check size
-      WORD tlvx12Sz = sizeof( sWDSSetMIPParametersRequest_RetryAttemptInterval );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx12Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x12;
-      pHeader->mLength = tlvx12Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
       sWDSSetMIPParametersRequest_RetryAttemptInterval * pTLVx12;
-      pTLVx12 = (sWDSSetMIPParametersRequest_RetryAttemptInterval*)(pOut + offset);
-      memset( pTLVx12, 0, tlvx12Sz );
+      pTLVx12 = tlvs.Add <sWDSSetMIPParametersRequest_RetryAttemptInterval>( 0x12 );
 
       // Set the value
       pTLVx12->mRetryAttemptInterval = *pRetryInterval;
-
-      offset += tlvx12Sz;
    }
 
    // Add Re-registration period, if specified
    if (pReRegPeriod != 0)
    {
-      // Check size
-      WORD tlvx13Sz = sizeof( sWDSSetMIPParametersRequest_ReRegistrationPeriod );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx13Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x13;
-      pHeader->mLength = tlvx13Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
       sWDSSetMIPParametersRequest_ReRegistrationPeriod * pTLVx13;
-      pTLVx13 = (sWDSSetMIPParametersRequest_ReRegistrationPeriod*)(pOut + offset);
-      memset( pTLVx13, 0, tlvx13Sz );
+      pTLVx13 = tlvs.Add <sWDSSetMIPParametersRequest_ReRegistrationPeriod>( 0x13 );
 
       // Set the value
       pTLVx13->mReRegistrationPeriod = *pReRegPeriod;
-
-      offset += tlvx13Sz;
    }
 
    // Add Re-registration on traffic flag, if specified
    if (pReRegTraffic != 0)
    {
-      // Check size
-      WORD tlvx14Sz = sizeof( sWDSSetMIPParametersRequest_ReRegistrationOnlyWithTraffic );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx14Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x14;
-      pHeader->mLength = tlvx14Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
       sWDSSetMIPParametersRequest_ReRegistrationOnlyWithTraffic * pTLVx14;
-      pTLVx14 = (sWDSSetMIPParametersRequest_ReRegistrationOnlyWithTraffic*)(pOut + offset);
-      memset( pTLVx14, 0, tlvx14Sz );
+      pTLVx14 = tlvs.Add <sWDSSetMIPParametersRequest_ReRegistrationOnlyWithTraffic>( 0x14 );
 
       // Set the value
       pTLVx14->mReRegistrationOnlyWithTraffic = (*pReRegTraffic == 0 ? 0 : 1);
-
-      offset += tlvx14Sz;
    }
 
    // Add HA authenticator flag, if specified
    if (pHAAuthenticator != 0)
    {
-      // Check size
-      WORD tlvx15Sz = sizeof( sWDSSetMIPParametersRequest_MNHAAuthenticatorCalculator );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx15Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x15;
-      pHeader->mLength = tlvx15Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
       sWDSSetMIPParametersRequest_MNHAAuthenticatorCalculator * pTLVx15;
-      pTLVx15 = (sWDSSetMIPParametersRequest_MNHAAuthenticatorCalculator*)(pOut + offset);
-      memset( pTLVx15, 0, tlvx15Sz );
+      pTLVx15 = tlvs.Add <sWDSSetMIPParametersRequest_MNHAAuthenticatorCalculator>( 0x15 );
 
       // Set the value
       pTLVx15->mMNHAAuthenticatorCalculator = (*pHAAuthenticator == 0 ? 0 : 1);
-
-      offset += tlvx15Sz;
    }
 
    // Add HA RFC2002bis authentication flag, if specified
    if (pHA2002bis != 0)
    {
-      // Check size
-      WORD tlvx16Sz = sizeof( sWDSSetMIPParametersRequest_MNHARFC2002BISAuthentication );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx16Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x16;
-      pHeader->mLength = tlvx16Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
       sWDSSetMIPParametersRequest_MNHARFC2002BISAuthentication * pTLVx16;
-      pTLVx16 = (sWDSSetMIPParametersRequest_MNHARFC2002BISAuthentication*)(pOut + offset);
-      memset( pTLVx16, 0, tlvx16Sz );
+      pTLVx16 = tlvs.Add <sWDSSetMIPParametersRequest_MNHARFC2002BISAuthentication>( 0x16 );
 
       // Set the value
       pTLVx16->mMNHARFC2002BISAuthentication = (*pHA2002bis == 0 ? 0 : 1);
-
-      offset += tlvx16Sz;
    }
 
    // At least one of the optional parameters must have been set
-   if (offset <= sizeof( sQMIRawContentHeader ) + tlvx01Sz)
+   ULONG reqSz = sizeof( sQMIRawContentHeader )
+               + sizeof( sWDSSetMIPParametersRequest_SPC );
+   if (tlvs.GetSize() <= reqSz)
    {
       return eGOBI_ERR_INVALID_ARG;
    }
 
-   *pOutLen = offset;
+   *pOutLen = tlvs.GetSize();
 
    return eGOBI_ERR_NONE;
 }
@@ -3106,6 +2546,9 @@ ULONG ParseGetMobileIPParameters(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    *pMode = 0xffffffff;
    *pRetryLimit = 0xff;
    *pRetryInterval = 0xff;
@@ -3117,7 +2560,7 @@ ULONG ParseGetMobileIPParameters(
    // Find the mode
    const sWDSGetMIPParametersResponse_MobileIPMode * pTLVx10;
    ULONG outLenx10;
-   ULONG rc = GetTLV( inLen, pIn, 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
+   ULONG rc = tlvs.GetTLV( 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx10 < sizeof( sWDSGetMIPParametersResponse_MobileIPMode ))
@@ -3131,7 +2574,7 @@ ULONG ParseGetMobileIPParameters(
    // Find the Retry limit
    const sWDSGetMIPParametersResponse_RetryAttemptLimit * pTLVx11;
    ULONG outLenx11;
-   rc = GetTLV( inLen, pIn, 0x11, &outLenx11, (const BYTE **)&pTLVx11 );
+   rc = tlvs.GetTLV( 0x11, &outLenx11, (const BYTE **)&pTLVx11 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx11 < sizeof( sWDSGetMIPParametersResponse_RetryAttemptLimit ))
@@ -3145,7 +2588,7 @@ ULONG ParseGetMobileIPParameters(
    // Find the Retry Interval
    const sWDSGetMIPParametersResponse_RetryAttemptInterval * pTLVx12;
    ULONG outLenx12;
-   rc = GetTLV( inLen, pIn, 0x12, &outLenx12, (const BYTE **)&pTLVx12 );
+   rc = tlvs.GetTLV( 0x12, &outLenx12, (const BYTE **)&pTLVx12 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx12 < sizeof( sWDSGetMIPParametersResponse_RetryAttemptInterval ))
@@ -3159,7 +2602,7 @@ ULONG ParseGetMobileIPParameters(
    // Find the Re-registration period
    const sWDSGetMIPParametersResponse_ReRegistrationPeriod * pTLVx13;
    ULONG outLenx13;
-   rc = GetTLV( inLen, pIn, 0x13, &outLenx13, (const BYTE **)&pTLVx13 );
+   rc = tlvs.GetTLV( 0x13, &outLenx13, (const BYTE **)&pTLVx13 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx13 < sizeof( sWDSGetMIPParametersResponse_ReRegistrationPeriod ))
@@ -3173,7 +2616,7 @@ ULONG ParseGetMobileIPParameters(
    // Find the Re-register on traffic flag
    const sWDSGetMIPParametersResponse_ReRegistrationOnlyWithTraffic * pTLVx14;
    ULONG outLenx14;
-   rc = GetTLV( inLen, pIn, 0x14, &outLenx14, (const BYTE **)&pTLVx14 );
+   rc = tlvs.GetTLV( 0x14, &outLenx14, (const BYTE **)&pTLVx14 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx14 < sizeof( sWDSGetMIPParametersResponse_ReRegistrationOnlyWithTraffic ))
@@ -3187,7 +2630,7 @@ ULONG ParseGetMobileIPParameters(
    // Find the HA authenticator
    const sWDSGetMIPParametersResponse_MNHAAuthenticatorCalculator * pTLVx15;
    ULONG outLenx15;
-   rc = GetTLV( inLen, pIn, 0x15, &outLenx15, (const BYTE **)&pTLVx15 );
+   rc = tlvs.GetTLV( 0x15, &outLenx15, (const BYTE **)&pTLVx15 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx15 < sizeof( sWDSGetMIPParametersResponse_MNHAAuthenticatorCalculator ))
@@ -3201,7 +2644,7 @@ ULONG ParseGetMobileIPParameters(
    // Find the HA RFC2002bis authentication flag
    const sWDSGetMIPParametersResponse_MNHARFC2002BISAuthentication * pTLVx16;
    ULONG outLenx16;
-   rc = GetTLV( inLen, pIn, 0x16, &outLenx16, (const BYTE **)&pTLVx16 );
+   rc = tlvs.GetTLV( 0x16, &outLenx16, (const BYTE **)&pTLVx16 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx16 < sizeof( sWDSGetMIPParametersResponse_MNHARFC2002BISAuthentication ))
@@ -3241,10 +2684,13 @@ ULONG ParseGetLastMobileIPError(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Find the TLV
    const sWDSGetLastMIPStatusResponse_Status * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -3292,28 +2738,20 @@ ULONG PackSetDNSSettings(
       return eGOBI_ERR_INVALID_ARG;
    }
 
-   sQMIRawContentHeader * pHeader;
-   ULONG offset = 0;
+   // Check size
+   cTLVWriter tlvs( pOut );
+   tlvs.Need <sWDSSetDNSSettingRequest_PrimaryDNS>( pPrimaryDNS != 0 );
+   tlvs.Need <sWDSSetDNSSettingRequest_SecondaryDNS>( pSecondaryDNS != 0 );
+   if (tlvs.Fits( *pOutLen ) == false)
+   {
+      return eGOBI_ERR_BUFFER_SZ;
+   }
 
    // Add Primary DNS, if specified
    if (pPrimaryDNS != 0)
    {
-      // Check size
-      WORD tlvx10Sz = sizeof( sWDSSetDNSSettingRequest_PrimaryDNS );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx10Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x10;
-      pHeader->mLength = tlvx10Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
       sWDSSetDNSSettingRequest_PrimaryDNS * pTLVx10;
-      pTLVx10 = (sWDSSetDNSSettingRequest_PrimaryDNS*)(pOut + offset);
-      memset( pTLVx10, 0, tlvx10Sz );
+      pTLVx10 = tlvs.Add <sWDSSetDNSSettingRequest_PrimaryDNS>( 0x10 );
 
       ULONG ip0 = (*pPrimaryDNS & 0x000000FF);
       ULONG ip1 = (*pPrimaryDNS & 0x0000FF00) >> 8;
@@ -3325,29 +2763,13 @@ ULONG PackSetDNSSettings(
       pTLVx10->mIPV4Address[1] = (INT8)ip1;
       pTLVx10->mIPV4Address[2] = (INT8)ip2;
       pTLVx10->mIPV4Address[3] = (INT8)ip3;
-
-      offset += tlvx10Sz;
    }
 
    // Add Secondary DNS, if specified
    if (pSecondaryDNS != 0)
    {
-      // Check size
-      WORD tlvx11Sz = sizeof( sWDSSetDNSSettingRequest_SecondaryDNS );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx11Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x11;
-      pHeader->mLength = tlvx11Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
       sWDSSetDNSSettingRequest_SecondaryDNS * pTLVx11;
-      pTLVx11 = (sWDSSetDNSSettingRequest_SecondaryDNS*)(pOut + offset);
-      memset( pTLVx11, 0, tlvx11Sz );
+      pTLVx11 = tlvs.Add <sWDSSetDNSSettingRequest_SecondaryDNS>( 0x11 );
 
       ULONG ip0 = (*pSecondaryDNS & 0x000000FF);
       ULONG ip1 = (*pSecondaryDNS & 0x0000FF00) >> 8;
@@ -3359,11 +2781,9 @@ ULONG PackSetDNSSettings(
       pTLVx11->mIPV4Address[1] = (INT8)ip1;
       pTLVx11->mIPV4Address[2] = (INT8)ip2;
       pTLVx11->mIPV4Address[3] = (INT8)ip3;
-
-      offset += tlvx11Sz;
    }
 
-   *pOutLen = offset;
+   *pOutLen = tlvs.GetSize();
 
    return eGOBI_ERR_NONE;
 }
@@ -3396,10 +2816,13 @@ ULONG ParseGetDNSSettings(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Find the Primary DNS
    const sWDSGetDNSSettingResponse_PrimaryDNS * pTLVx10;
    ULONG outLenx10;
-   ULONG rc = GetTLV( inLen, pIn, 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
+   ULONG rc = tlvs.GetTLV( 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx10 < sizeof( sWDSGetDNSSettingResponse_PrimaryDNS ))
@@ -3418,7 +2841,7 @@ ULONG ParseGetDNSSettings(
    // Find the Secondary DNS
    const sWDSGetDNSSettingResponse_SecondaryDNS * pTLVx11;
    ULONG outLenx11;
-   rc = GetTLV( inLen, pIn, 0x11, &outLenx11, (const BYTE **)&pTLVx11 );
+   rc = tlvs.GetTLV( 0x11, &outLenx11, (const BYTE **)&pTLVx11 );
    if (rc == eGOBI_ERR_NONE)
    {
       if (outLenx11 < sizeof( sWDSGetDNSSettingResponse_SecondaryDNS ))
@@ -3464,10 +2887,13 @@ ULONG ParseGetDataBearerTechnology(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Find the TLV
    const sWDSGetDataBearerTechnologyResponse_Technology * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
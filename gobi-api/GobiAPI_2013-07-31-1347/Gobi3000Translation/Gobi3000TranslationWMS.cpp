@@ -70,83 +70,43 @@ ULONG PackDeleteSMS(
    }
 
    // Check size
-   WORD tlvx01Sz = sizeof( sWMSDeleteRequest_MemoryStorage );
-   if (*pOutLen < sizeof( sQMIRawContentHeader ) + tlvx01Sz)
+   cTLVWriter tlvs( pOut );
+   tlvs.Need <sWMSDeleteRequest_MemoryStorage>();
+   tlvs.Need <sWMSDeleteRequest_MessageIndex>( pMessageIndex != 0 );
+   tlvs.Need <sWMSDeleteRequest_MessageTag>( pMessageTag != 0 );
+   if (tlvs.Fits( *pOutLen ) == false)
    {
       return eGOBI_ERR_BUFFER_SZ;
    }
 
-   sQMIRawContentHeader * pHeader = (sQMIRawContentHeader*)(pOut);
-   pHeader->mTypeID = 0x01;
-   pHeader->mLength = tlvx01Sz;
-
-   ULONG offset = sizeof( sQMIRawContentHeader );
-
-   // The SPC
+   // The storage type
    sWMSDeleteRequest_MemoryStorage * pTLVx01;
-   pTLVx01 = (sWMSDeleteRequest_MemoryStorage*)(pOut + offset);
-   memset( pTLVx01, 0, tlvx01Sz );
+   pTLVx01 = tlvs.Add <sWMSDeleteRequest_MemoryStorage>( 0x01 );
 
    // Set the values
    pTLVx01->mStorageType = (eQMIWMSStorageTypes)storageType;
 
-   offset += tlvx01Sz;
-
    // Add the Message index, if specified
    if (pMessageIndex != 0)
    {
-      // Check size
-      WORD tlvx10Sz = sizeof( sWMSDeleteRequest_MessageIndex );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx10Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x10;
-      pHeader->mLength = tlvx10Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
-      // The SPC
       sWMSDeleteRequest_MessageIndex * pTLVx10;
-      pTLVx10 = (sWMSDeleteRequest_MessageIndex*)(pOut + offset);
-      memset( pTLVx10, 0, tlvx10Sz );
+      pTLVx10 = tlvs.Add <sWMSDeleteRequest_MessageIndex>( 0x10 );
 
       // Set the values
       pTLVx10->mStorageIndex = *pMessageIndex;
-
-      offset += tlvx10Sz;
    }
 
    // Add the Message tag, if specified
    if (pMessageTag != 0)
    {
-      // Check size
-      WORD tlvx11Sz = sizeof( sWMSDeleteRequest_MessageTag );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx11Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x11;
-      pHeader->mLength = tlvx11Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
-      // The SPC
       sWMSDeleteRequest_MessageTag * pTLVx11;
-      pTLVx11 = (sWMSDeleteRequest_MessageTag*)(pOut + offset);
-      memset( pTLVx11, 0, tlvx11Sz );
+      pTLVx11 = tlvs.Add <sWMSDeleteRequest_MessageTag>( 0x11 );
 
       // Set the values
       pTLVx11->mMessageTag = (eQMIWMSMessageTags)*pMessageTag;
-
-      offset += tlvx11Sz;
    }
 
-   *pOutLen = offset;
+   *pOutLen = tlvs.GetSize();
    return eGOBI_ERR_NONE;
 }
 
@@ -181,56 +141,32 @@ ULONG PackGetSMSList(
    }
 
    // Check size
-   WORD tlvx01Sz = sizeof( sWMSListMessagesRequest_MemoryStorage );
-   if (*pOutLen < sizeof( sQMIRawContentHeader ) + tlvx01Sz)
+   cTLVWriter tlvs( pOut );
+   tlvs.Need <sWMSListMessagesRequest_MemoryStorage>();
+   tlvs.Need <sWMSListMessagesRequest_MessageTag>( pRequestedTag != 0 );
+   if (tlvs.Fits( *pOutLen ) == false)
    {
       return eGOBI_ERR_BUFFER_SZ;
    }
 
-   sQMIRawContentHeader * pHeader = (sQMIRawContentHeader*)(pOut);
-   pHeader->mTypeID = 0x01;
-   pHeader->mLength = tlvx01Sz;
-
-   ULONG offset = sizeof( sQMIRawContentHeader );
-
    // The storage type
    sWMSListMessagesRequest_MemoryStorage * pTLVx01;
-   pTLVx01 = (sWMSListMessagesRequest_MemoryStorage*)(pOut + offset);
-   memset( pTLVx01, 0, tlvx01Sz );
+   pTLVx01 = tlvs.Add <sWMSListMessagesRequest_MemoryStorage>( 0x01 );
 
    // Set the values
    pTLVx01->mStorageType = (eQMIWMSStorageTypes)storageType;
 
-   offset += tlvx01Sz;
-
    // Add the Message tag, if specified
    if (pRequestedTag != 0)
    {
-      // Check size
-      WORD tlvx10Sz = sizeof( sWMSListMessagesRequest_MessageTag );
-      if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx10Sz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      pHeader = (sQMIRawContentHeader*)(pOut + offset);
-      pHeader->mTypeID = 0x10;
-      pHeader->mLength = tlvx10Sz;
-
-      offset += sizeof( sQMIRawContentHeader );
-
-      // The SPC
       sWMSListMessagesRequest_MessageTag * pTLVx10;
-      pTLVx10 = (sWMSListMessagesRequest_MessageTag*)(pOut + offset);
-      memset( pTLVx10, 0, tlvx10Sz );
+      pTLVx10 = tlvs.Add <sWMSListMessagesRequest_MessageTag>( 0x10 );
 
       // Set the values
       pTLVx10->mMessageTag = (eQMIWMSMessageTags)*pRequestedTag;
-
-      offset += tlvx10Sz;
    }
 
-   *pOutLen = offset;
+   *pOutLen = tlvs.GetSize();
    return eGOBI_ERR_NONE;
 }
 
@@ -266,6 +202,9 @@ ULONG ParseGetSMSList(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    ULONG maxMessageListSz = *pMessageListSize;
 
    // Assume failure
@@ -274,7 +213,7 @@ ULONG ParseGetSMSList(
    // Find the messages
    const sWMSListMessagesResponse_MessageList * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -285,7 +224,7 @@ ULONG ParseGetSMSList(
       return eGOBI_ERR_MALFORMED_RSP;
    }
 
-   ULONG messageListSz = pTLVx01->mNumberOfMessages;
+   ULONG messageListSz = GET_PACKED_FIELD( pTLVx01, mNumberOfMessages );
    if (messageListSz == 0)
    {
       // No stored messages, but not necessarily a failure
@@ -315,8 +254,8 @@ ULONG ParseGetSMSList(
    ULONG * pData = (ULONG *)pMessageList;
    for (ULONG m = 0; m < messageListSz; m++)
    {
-      *pData++ = pMessages->mStorageIndex;
-      *pData++ = pMessages->mMessageTag;
+      *pData++ = GET_PACKED_FIELD( pMessages, mStorageIndex );
+      *pData++ = GET_PACKED_FIELD( pMessages, mMessageTag );
       pMessages++;
    }
 
@@ -422,6 +361,9 @@ ULONG ParseGetSMS(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    ULONG maxMessageSz = *pMessageSize;
 
    // Assume failure
@@ -430,7 +372,7 @@ ULONG ParseGetSMS(
    // Find the messages
    const sWMSRawReadResponse_MessageData * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -628,10 +570,13 @@ ULONG ParseSaveSMS(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Find the messages
    const sWMSRawWriteResponse_MessageIndex * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -744,13 +689,16 @@ ULONG ParseSendSMS(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Assume we have no message failure cause code
    *pMessageFailureCode = 0xffffffff;
 
    // Check mandatory response
    const sResultCode * pTLVx02;
    ULONG outLenx02;
-   ULONG rc = GetTLV( inLen, pIn, 0x02, &outLenx02, (const BYTE **)&pTLVx02 );
+   ULONG rc = tlvs.GetTLV( 0x02, &outLenx02, (const BYTE **)&pTLVx02 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -771,7 +719,7 @@ ULONG ParseSendSMS(
       // Check for the failure code (optional)
       const sWMSRawSendResponse_CauseCode * pTLVx10;
       ULONG outLenx10;
-      ULONG rc2 = GetTLV( inLen, pIn, 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
+      ULONG rc2 = tlvs.GetTLV( 0x10, &outLenx10, (const BYTE **)&pTLVx10 );
       if (rc2 == eGOBI_ERR_NONE)
       {
          if (outLenx10 < sizeof( sWMSRawSendResponse_CauseCode ))
@@ -826,6 +774,9 @@ ULONG ParseGetSMSCAddress(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Assume empty
    pSMSCAddress[0] = 0;
    pSMSCType[0] = 0;
@@ -833,7 +784,7 @@ ULONG ParseGetSMSCAddress(
    // Get the address (mandatory)
    const sWMSGetSMSCAddressResponse_Address * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
@@ -910,53 +861,29 @@ ULONG PackSetSMSCAddress(
       return eGOBI_ERR_INVALID_ARG;
    }
 
-   // The TLV contains only the address
-   std::string smscAddr( pSMSCAddress );
+   // Check size (the TLVs contain only the address and the type)
+   cTLVWriter tlvs( pOut );
+   WORD smscAddrSz = tlvs.NeedString( pSMSCAddress );
 
-   // Check size
-   WORD tlvx01Sz = (WORD)smscAddr.size();
-   if (*pOutLen < sizeof( sQMIRawContentHeader ) + tlvx01Sz)
+   // smscType is optional
+   WORD smscTypeSz = 0;
+   if (pSMSCType != 0 && pSMSCType[0] != 0)
    {
-      return eGOBI_ERR_BUFFER_SZ;
+      smscTypeSz = tlvs.NeedString( pSMSCType );
    }
 
-   sQMIRawContentHeader * pHeader = (sQMIRawContentHeader*)(pOut);
-   pHeader->mTypeID = 0x01;
-   pHeader->mLength = tlvx01Sz;
-
-   ULONG offset = sizeof( sQMIRawContentHeader );
-
-   memcpy( (pOut + offset), smscAddr.c_str(), tlvx01Sz );
-   offset += tlvx01Sz;
-
-   // smscType is optional
-   if (pSMSCType != 0)
+   if (tlvs.Fits( *pOutLen ) == false)
    {
-      // The TLV contains only the type
-      std::string smscType( pSMSCType );
-
-      if (smscType.size() != 0)
-      {
-         // Check size
-         WORD tlvx10Sz = (WORD)smscType.size();
-         if (*pOutLen < offset + sizeof( sQMIRawContentHeader ) + tlvx10Sz)
-         {
-            return eGOBI_ERR_BUFFER_SZ;
-         }
-
-         sQMIRawContentHeader * pHeader = (sQMIRawContentHeader*)(pOut);
-         pHeader->mTypeID = 0x10;
-         pHeader->mLength = tlvx10Sz;
-
-         ULONG offset = sizeof( sQMIRawContentHeader );
-
-         memcpy( (pOut + offset), smscType.c_str(), tlvx10Sz );
-         offset += tlvx10Sz;
-      }
+      return eGOBI_ERR_BUFFER_SZ;
    }
 
+   tlvs.Add( 0x01, pSMSCAddress, smscAddrSz );
+   if (smscTypeSz != 0)
+   {
+      tlvs.Add( 0x10, pSMSCType, smscTypeSz );
+   }
 
-   *pOutLen = offset;
+   *pOutLen = tlvs.GetSize();
 
    return eGOBI_ERR_NONE;
 }
@@ -991,6 +918,9 @@ ULONG ParseGetSMSRoutes(
       return eGOBI_ERR_INVALID_ARG;
    }
 
+   // Index the TLVs
+   cTLVIndex tlvs( inLen, pIn );
+
    // Assume failure
    BYTE maxRoutes = *pRouteSize;
    *pRouteSize = 0;
@@ -998,7 +928,7 @@ ULONG ParseGetSMSRoutes(
    // Get the route list
    const sWMSGetRoutesResponse_RouteList * pTLVx01;
    ULONG outLenx01;
-   ULONG rc = GetTLV( inLen, pIn, 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
+   ULONG rc = tlvs.GetTLV( 0x01, &outLenx01, (const BYTE **)&pTLVx01 );
    if (rc != eGOBI_ERR_NONE)
    {
       return rc;
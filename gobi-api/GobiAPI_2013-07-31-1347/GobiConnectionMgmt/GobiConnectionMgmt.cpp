@@ -43,6 +43,8 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "GobiConnectionMgmt.h"
 #include "QMIBuffers.h"
 
+#include <sched.h>
+
 //---------------------------------------------------------------------------
 // Definitions
 //---------------------------------------------------------------------------
@@ -199,6 +201,54 @@ void * CallbackThread( PVOID pArg )
    return 0;
 }
 
+/*=========================================================================*/
+// cGobiAPIRef Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   cGobiAPIRef (Public Method)
+
+DESCRIPTION:
+   Copy constructor
+
+PARAMETERS:
+   ref         [ I ] - Reference being copied
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+cGobiAPIRef::cGobiAPIRef( const cGobiAPIRef & ref )
+   :  mpAPI( ref.mpAPI ),
+      mpRefs( ref.mpRefs )
+{
+   if (mpRefs != 0)
+   {
+      __sync_fetch_and_add( mpRefs, 1 );
+   }
+}
+
+/*===========================================================================
+METHOD:
+   Release (Public Method)
+
+DESCRIPTION:
+   Drop the reference (the API object may be deleted from then on)
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiAPIRef::Release()
+{
+   if (mpRefs != 0)
+   {
+      __sync_fetch_and_sub( mpRefs, 1 );
+   }
+
+   mpAPI = 0;
+   mpRefs = 0;
+}
+
 /*=========================================================================*/
 // CGobiConnectionMgmtDLL Methods
 /*=========================================================================*/
@@ -215,6 +265,13 @@ RETURN VALUE:
 ===========================================================================*/
 CGobiConnectionMgmtDLL::CGobiConnectionMgmtDLL()
 {
+   for (ULONG i = 0; i < MAX_API_HANDLES; i++)
+   {
+      mAPI[i].mpAPI = 0;
+      mAPI[i].mGeneration = 1;
+      mAPI[i].mRefs = 0;
+   }
+
    // Create sync CS
    pthread_mutex_init( &mSyncSection, NULL );
 }
@@ -231,24 +288,18 @@ RETURN VALUE:
 ===========================================================================*/
 CGobiConnectionMgmtDLL::~CGobiConnectionMgmtDLL()
 {
-   std::map <GOBIHANDLE, cGobiConnectionMgmt *> tmpAPI = mAPI;
-   std::map <GOBIHANDLE, cGobiConnectionMgmt *>::const_iterator pIter;
-   pIter = tmpAPI.begin();
-
-   while (pIter != tmpAPI.end())
+   for (ULONG i = 0; i < MAX_API_HANDLES; i++)
    {
-      cGobiConnectionMgmt * pAPI = pIter->second;
+      cGobiConnectionMgmt * pAPI = mAPI[i].mpAPI;
       if (pAPI != 0)
       {
+         mAPI[i].mpAPI = 0;
+
          pAPI->Cleanup();
          delete pAPI;
       }
-
-      pIter++;
    }
 
-   mAPI.clear();
-
    pthread_mutex_destroy( &mSyncSection );
 }
 
@@ -264,21 +315,44 @@ RETURN VALUE:
 ===========================================================================*/ 
 GOBIHANDLE CGobiConnectionMgmtDLL::CreateAPI()
 {
+   GOBIHANDLE handle = 0;
+
    pthread_mutex_lock( &mSyncSection );
 
-   cGobiConnectionMgmt * pAPI = new cGobiConnectionMgmt;
+   ULONG idx = 0;
+   while (idx < MAX_API_HANDLES && mAPI[idx].mpAPI != 0)
+   {
+      idx++;
+   }
+
+   cGobiConnectionMgmt * pAPI = 0;
+   if (idx < MAX_API_HANDLES)
+   {
+      pAPI = new cGobiConnectionMgmt;
+   }
+
    if (pAPI != 0)
    {
       bool bInit = pAPI->Initialize();
       if (bInit == true)
       {
-         mAPI[(GOBIHANDLE)pAPI] = pAPI;
+         sAPISlot & slot = mAPI[idx];
+         handle = (GOBIHANDLE)((slot.mGeneration << API_HANDLE_INDEX_BITS)
+                             | idx);
+
+         // Publish the object, lookups may find it from here on
+         __sync_synchronize();
+         slot.mpAPI = pAPI;
+      }
+      else
+      {
+         delete pAPI;
       }
    }
 
    pthread_mutex_unlock( &mSyncSection );
 
-   return (GOBIHANDLE)pAPI;
+   return handle;
 }
 
 /*===========================================================================
@@ -286,7 +360,8 @@ METHOD:
    DeleteAPI (Public Method)
 
 DESCRIPTION:
-   Delete an existing API object
+   Delete an existing API object, once the references to it obtained
+   from GetAPI() have been dropped
 
 PARAMETERS:
    handle      [ I ] - Handle to API object to return
@@ -296,16 +371,33 @@ RETURN VALUE:
 ===========================================================================*/ 
 void CGobiConnectionMgmtDLL::DeleteAPI( GOBIHANDLE handle )
 {
+   ULONG idx = (ULONG)handle & (MAX_API_HANDLES - 1);
+   ULONG gen = (ULONG)handle >> API_HANDLE_INDEX_BITS;
+
    pthread_mutex_lock( &mSyncSection );
 
-   std::map <GOBIHANDLE, cGobiConnectionMgmt *>::iterator pIter;
-   pIter = mAPI.find( handle );
-   if (pIter != mAPI.end())
+   sAPISlot & slot = mAPI[idx];
+   cGobiConnectionMgmt * pAPI = slot.mpAPI;
+   if (pAPI != 0 && slot.mGeneration == gen)
    {
-      cGobiConnectionMgmt * pAPI = pIter->second;
-      delete pAPI;
+      // Retire the handle first, lookups from here on fail
+      ULONG nextGen = gen + 1;
+      if (nextGen == 0 || (nextGen >> (32 - API_HANDLE_INDEX_BITS)) != 0)
+      {
+         nextGen = 1;
+      }
+
+      slot.mGeneration = nextGen;
+      __sync_synchronize();
 
-      mAPI.erase( pIter );
+      // ... then wait out the lookups that got in before that
+      while (slot.mRefs != 0)
+      {
+         sched_yield();
+      }
+
+      slot.mpAPI = 0;
+      delete pAPI;
    }
 
    pthread_mutex_unlock( &mSyncSection );
@@ -316,30 +408,40 @@ METHOD:
    GetAPI (Public Method)
 
 DESCRIPTION:
-   Return the requested API object
+   Return the requested API object, without locking (the slot reference 
+   count is taken before the generation of the handle is checked, so that
+   DeleteAPI() either sees the reference or this sees the new generation)
 
 PARAMETERS:
    handle      [ I ] - Handle to API object to return
   
 RETURN VALUE:
-   cGobiConnectionMgmt *
+   cGobiAPIRef - Reference to the API object (0 if the handle is invalid)
 ===========================================================================*/ 
-cGobiConnectionMgmt * CGobiConnectionMgmtDLL::GetAPI( GOBIHANDLE handle )
+cGobiAPIRef CGobiConnectionMgmtDLL::GetAPI( GOBIHANDLE handle )
 {
-   cGobiConnectionMgmt * pAPI = 0;
+   if (handle == 0)
+   {
+      return cGobiAPIRef();
+   }
 
-   pthread_mutex_lock( &mSyncSection );
+   ULONG idx = (ULONG)handle & (MAX_API_HANDLES - 1);
+   ULONG gen = (ULONG)handle >> API_HANDLE_INDEX_BITS;
 
-   std::map <GOBIHANDLE, cGobiConnectionMgmt *>::const_iterator pIter;
-   pIter = mAPI.find( handle );
-   if (pIter != mAPI.end())
+   sAPISlot & slot = mAPI[idx];
+
+   // (Full barrier)
+   __sync_fetch_and_add( &slot.mRefs, 1 );
+
+   cGobiConnectionMgmt * pAPI = slot.mpAPI;
+   if (pAPI == 0 || slot.mGeneration != gen)
    {
-      pAPI = pIter->second;
+      __sync_fetch_and_sub( &slot.mRefs, 1 );
+      return cGobiAPIRef();
    }
 
-   pthread_mutex_unlock( &mSyncSection );
-
-   return pAPI;
+   // The reference taken above is handed over
+   return cGobiAPIRef( pAPI, &slot.mRefs );
 }
 
 /*=========================================================================*/
@@ -7,6 +7,7 @@ DESCRIPTION:
 
 PUBLIC CLASSES AND FUNCTIONS:
    CGobiConnectionMgmtDLL
+   cGobiAPIRef
    cGobiConnectionMgmt
 
 Copyright (c) 2013, The Linux Foundation. All rights reserved.
@@ -55,6 +56,12 @@ POSSIBILITY OF SUCH DAMAGE.
 // Handle to Gobi API
 typedef ULONG_PTR GOBIHANDLE;
 
+// Number of API objects that can exist at once (the low bits of a handle
+// are the index of its slot in the handle table, the rest the generation 
+// of that slot)
+const ULONG MAX_API_HANDLES = 256;
+const ULONG API_HANDLE_INDEX_BITS = 8;
+
 extern "C" 
 {
    // Generic callback function pointer
@@ -237,8 +244,64 @@ class cGobiConnectionMgmt : public cGobiQMICore
       friend VOID * TrafficProcessThread( PVOID pArg );
 };
 
+/*=========================================================================*/
+// Class cGobiAPIRef
+//
+//    Reference to an API object as returned by GetAPI(), the object is 
+//    not deleted while there are references to it
+/*=========================================================================*/
+class cGobiAPIRef
+{
+   public:
+      // (Inline) Constructor
+      cGobiAPIRef(
+         cGobiConnectionMgmt *      pAPI = 0,
+         volatile ULONG *           pRefs = 0 )
+         :  mpAPI( pAPI ),
+            mpRefs( pRefs )
+      { };
+
+      // Copy constructor
+      cGobiAPIRef( const cGobiAPIRef & ref );
+
+      // (Inline) Destructor
+      ~cGobiAPIRef()
+      {
+         Release();
+      };
+
+      // Drop the reference
+      void Release();
+
+      // (Inline) Access the API object
+      cGobiConnectionMgmt * operator -> () const
+      {
+         return mpAPI;
+      };
+
+      // (Inline) Return the API object (0 if none)
+      operator cGobiConnectionMgmt * () const
+      {
+         return mpAPI;
+      };
+
+   protected:
+      /* API object */
+      cGobiConnectionMgmt * mpAPI;
+
+      /* Reference count of the handle table slot of the above */
+      volatile ULONG * mpRefs;
+
+   private:
+      // Assignment operator (not supported)
+      cGobiAPIRef & operator = ( const cGobiAPIRef & );
+};
+
 /*=========================================================================*/
 // Class CGobiConnectionMgmtDLL 
+//
+//    Handles are resolved without locking, only creating and deleting
+//    API objects is serialized
 /*=========================================================================*/
 class CGobiConnectionMgmtDLL
 {
@@ -256,13 +319,27 @@ class CGobiConnectionMgmtDLL
       void DeleteAPI( GOBIHANDLE handle );
 
       // Return the requested API object
-      cGobiConnectionMgmt * GetAPI( GOBIHANDLE handle );
+      cGobiAPIRef GetAPI( GOBIHANDLE handle );
 
    protected:
-      /* API interface object */
-      std::map <GOBIHANDLE, cGobiConnectionMgmt *> mAPI;
+      // Handle table slot (one cache line each, so that calls on 
+      // different handles do not contend)
+      struct sAPISlot
+      {
+         /* API interface object (0 if the slot is free) */
+         cGobiConnectionMgmt * volatile mpAPI;
+
+         /* Generation of the slot (never 0), bumped when it is freed */
+         volatile ULONG mGeneration;
+
+         /* Number of references (cGobiAPIRef) to the above object */
+         volatile ULONG mRefs;
+      } __attribute__ (( aligned( 64 ) ));
+
+      /* Handle table */
+      sAPISlot mAPI[MAX_API_HANDLES];
 
-      /* Synchronization object */
+      /* Synchronization object (creating/deleting API objects) */
       mutable pthread_mutex_t mSyncSection;
 };
 
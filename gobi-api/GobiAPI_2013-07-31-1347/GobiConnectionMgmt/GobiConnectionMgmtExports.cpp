@@ -89,7 +89,7 @@ ULONG GobiConnect(
       return (ULONG)eGOBI_ERR_INTERNAL;
    }
 
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -119,7 +119,7 @@ ULONG GobiConnect(
    if (outSvcsCount == 0)
    {
       ULONG rc = (ULONG)pAPI->GetCorrectedLastError();
-      pAPI = 0;
+      pAPI.Release();
 
       gDLL.DeleteAPI( handle );
       return rc;
@@ -162,7 +162,7 @@ ULONG GobiCancel(
    ULONG                      svcID,
    ULONG *                    pTXID )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -187,7 +187,7 @@ RETURN VALUE:
 ===========================================================================*/
 ULONG GobiDisconnect( GOBIHANDLE handle )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -224,7 +224,7 @@ ULONG SetGenericCallback(
    ULONG                      msgID,
    tFNGenericCallback         pCallback )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -265,7 +265,7 @@ ULONG WDSReset(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -305,7 +305,7 @@ ULONG WDSSetEventReport(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -345,7 +345,7 @@ ULONG WDSAbort(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -385,7 +385,7 @@ ULONG WDSSetIndication(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -425,7 +425,7 @@ ULONG WDSGetSupportedMessages(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -465,7 +465,7 @@ ULONG WDSGetSupportedFields(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -505,7 +505,7 @@ ULONG WDSStartNetworkInterface(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -545,7 +545,7 @@ ULONG WDSStopNetworkInterface(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -585,7 +585,7 @@ ULONG WDSGetPacketServiceStatus(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -625,7 +625,7 @@ ULONG WDSGetChannelRates(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -665,7 +665,7 @@ ULONG WDSGetPacketStatistics(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -705,7 +705,7 @@ ULONG WDSGoDormant(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -745,7 +745,7 @@ ULONG WDSGoActive(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -785,7 +785,7 @@ ULONG WDSCreateProfile(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -825,7 +825,7 @@ ULONG WDSModifyProfile(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -865,7 +865,7 @@ ULONG WDSDeleteProfile(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -905,7 +905,7 @@ ULONG WDSGetProfileList(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -945,7 +945,7 @@ ULONG WDSGetProfileSettings(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -985,7 +985,7 @@ ULONG WDSGetDefaultSettings(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -1025,7 +1025,7 @@ ULONG WDSGetCurrentSettings(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -1065,7 +1065,7 @@ ULONG WDSSetMIPMode(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -1105,7 +1105,7 @@ ULONG WDSGetMIPMode(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -1145,7 +1145,7 @@ ULONG WDSGetDormancy(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -1185,7 +1185,7 @@ ULONG WDSGetAutoconnectSetting(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -1225,7 +1225,7 @@ ULONG WDSGetDataSessionDuration(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -1265,7 +1265,7 @@ ULONG WDSGetModemStatus(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -1305,7 +1305,7 @@ ULONG WDSGetDataBearerTechnology(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -1345,7 +1345,7 @@ ULONG WDSGetModemInfo(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -1385,7 +1385,7 @@ ULONG WDSGetActiveMIPProfile(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -1425,7 +1425,7 @@ ULONG WDSSetActiveMIPProfile(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -1465,7 +1465,7 @@ ULONG WDSGetMIPProfile(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -1505,7 +1505,7 @@ ULONG WDSSetMIPProfile(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -1545,7 +1545,7 @@ ULONG WDSGetMIPParameters(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -1585,7 +1585,7 @@ ULONG WDSSetMIPParameters(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -1625,7 +1625,7 @@ ULONG WDSGetLastMIPStatus(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -1665,7 +1665,7 @@ ULONG WDSGetANAAAAuthenticationStatus(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -1705,7 +1705,7 @@ ULONG WDSGetCurrentDataBearerTechnology(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -1745,7 +1745,7 @@ ULONG WDSGetCallList(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -1785,7 +1785,7 @@ ULONG WDSGetCallRecord(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -1825,7 +1825,7 @@ ULONG WDSClearCallList(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -1865,7 +1865,7 @@ ULONG WDSGetCallListMaxSize(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -1905,7 +1905,7 @@ ULONG WDSGetDefaultProfileNumber(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -1945,7 +1945,7 @@ ULONG WDSSetDefaultProfileNumber(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -1985,7 +1985,7 @@ ULONG WDSResetProfile(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -2025,7 +2025,7 @@ ULONG WDSResetProfileParamToInvalid(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -2065,7 +2065,7 @@ ULONG WDSSetIPFamilyPreference(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -2105,7 +2105,7 @@ ULONG WDSSetFMCTunnelParameters(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -2145,7 +2145,7 @@ ULONG WDSClearFMCTunnelParameters(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -2185,7 +2185,7 @@ ULONG WDSGetFMCTunnelParameters(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -2225,7 +2225,7 @@ ULONG WDSSetAutoconnectSetting(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -2265,7 +2265,7 @@ ULONG WDSGetDNSSetting(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -2305,7 +2305,7 @@ ULONG WDSSetDNSSetting(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -2345,7 +2345,7 @@ ULONG WDSGetCDMAPreDormancySettings(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -2385,7 +2385,7 @@ ULONG WDSSetCAMTimer(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -2425,7 +2425,7 @@ ULONG WDSGetCAMTimer(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -2465,7 +2465,7 @@ ULONG WDSSetSCRM(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -2505,7 +2505,7 @@ ULONG WDSGetSCRM(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -2545,7 +2545,7 @@ ULONG WDSSetRDUD(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -2585,7 +2585,7 @@ ULONG WDSGetRDUD(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -2625,7 +2625,7 @@ ULONG WDSGetSIPMIPCallType(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -2665,7 +2665,7 @@ ULONG WDSSetEVDOPageMonitorPeriod(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -2705,7 +2705,7 @@ ULONG WDSSetEVDOLongSleep(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -2745,7 +2745,7 @@ ULONG WDSGetEVDOPageMonitorPeriod(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -2785,7 +2785,7 @@ ULONG WDSGetCallThrottleInfo(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -2825,7 +2825,7 @@ ULONG WDSGetNSAPI(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -2865,7 +2865,7 @@ ULONG WDSSetDUNCallControlPreference(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -2905,7 +2905,7 @@ ULONG WDSGetDUNCallControlInfo(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -2945,7 +2945,7 @@ ULONG WDSSetDUNCallControlEventReport(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -2985,7 +2985,7 @@ ULONG WDSPendingDUNCallControl(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -3025,7 +3025,7 @@ ULONG WDSEMBMSTMGIActivate(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -3065,7 +3065,7 @@ ULONG WDSEMBMSTMGIDeactivate(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -3105,7 +3105,7 @@ ULONG WDSEMBMSTMGIListQuery(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -3145,7 +3145,7 @@ ULONG WDSGetPreferredDataSystem(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -3185,7 +3185,7 @@ ULONG WDSGetLastDataCallStatus(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -3225,7 +3225,7 @@ ULONG WDSGetCurrentDataSystems(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -3265,7 +3265,7 @@ ULONG WDSGetPDNThrottleInfo(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -3305,7 +3305,7 @@ ULONG WDSGetLTEAttachParameters(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -3345,7 +3345,7 @@ ULONG WDSResetPacketStatistics(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -3385,7 +3385,7 @@ ULONG WDSGetFlowControlStatus(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -3425,7 +3425,7 @@ ULONG WDSEMBMSTMGISwitch(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -3465,7 +3465,7 @@ ULONG WDSBindDataPort(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -3505,7 +3505,7 @@ ULONG WDSSetPDNFilter(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -3545,7 +3545,7 @@ ULONG WDSRemovePDNFilter(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -3585,7 +3585,7 @@ ULONG WDSReverseIPTransportConnectionIndication(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -3625,7 +3625,7 @@ ULONG WDSGetIPSecStaticSAConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -3665,7 +3665,7 @@ ULONG WDSReverseIPTransportConfigComplete(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -3705,7 +3705,7 @@ ULONG WDSGetExtendedDataBearerTechnology(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -3745,7 +3745,7 @@ ULONG WDSGetLTEMaximumAttachPDNNumber(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -3785,7 +3785,7 @@ ULONG WDSSetLTEAttachPDNList(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -3825,7 +3825,7 @@ ULONG WDSGetLTEAttachPDNList(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -3865,7 +3865,7 @@ ULONG WDSSetLTEDataRetry(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -3905,7 +3905,7 @@ ULONG WDSGetLTEDataRetry(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -3945,7 +3945,7 @@ ULONG WDSSetLTEAttachType(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -3985,7 +3985,7 @@ ULONG WDSGetLTEAttachType(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -4025,7 +4025,7 @@ ULONG DMSReset(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -4065,7 +4065,7 @@ ULONG DMSSetEventReport(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -4105,7 +4105,7 @@ ULONG DMSGetSupportedMessages(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -4145,7 +4145,7 @@ ULONG DMSGetSupportedFields(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -4185,7 +4185,7 @@ ULONG DMSGetDeviceCapabilities(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -4225,7 +4225,7 @@ ULONG DMSGetDeviceManfacturer(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -4265,7 +4265,7 @@ ULONG DMSGetDeviceModel(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -4305,7 +4305,7 @@ ULONG DMSGetDeviceRevision(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -4345,7 +4345,7 @@ ULONG DMSGetDeviceVoiceNumber(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -4385,7 +4385,7 @@ ULONG DMSGetDeviceSerialNumbers(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -4425,7 +4425,7 @@ ULONG DMSGetPowerState(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -4465,7 +4465,7 @@ ULONG DMSUIMSetPINProtection(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -4505,7 +4505,7 @@ ULONG DMSUIMVerifyPIN(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -4545,7 +4545,7 @@ ULONG DMSUIMUnblockPIN(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -4585,7 +4585,7 @@ ULONG DMSUIMChangePIN(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -4625,7 +4625,7 @@ ULONG DMSUIMGetPINStatus(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -4665,7 +4665,7 @@ ULONG DMSGetHardwareRevision(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -4705,7 +4705,7 @@ ULONG DMSGetOperatingMode(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -4745,7 +4745,7 @@ ULONG DMSSetOperatingMode(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -4785,7 +4785,7 @@ ULONG DMSGetTimestamp(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -4825,7 +4825,7 @@ ULONG DMSGetPRLVersion(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -4865,7 +4865,7 @@ ULONG DMSGetActivationState(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -4905,7 +4905,7 @@ ULONG DMSActivateAutomatic(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -4945,7 +4945,7 @@ ULONG DMSActivateManual(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -4985,7 +4985,7 @@ ULONG DMSGetLockState(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -5025,7 +5025,7 @@ ULONG DMSSetLockState(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -5065,7 +5065,7 @@ ULONG DMSSetLockCode(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -5105,7 +5105,7 @@ ULONG DMSReadUserData(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -5145,7 +5145,7 @@ ULONG DMSWriteUserData(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -5185,7 +5185,7 @@ ULONG DMSReadERIData(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -5225,7 +5225,7 @@ ULONG DMSResetFactoryDefaults(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -5265,7 +5265,7 @@ ULONG DMSValidateSPC(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -5305,7 +5305,7 @@ ULONG DMSUIMGetICCID(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -5345,7 +5345,7 @@ ULONG DMSUIMGetHostLockID(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -5385,7 +5385,7 @@ ULONG DMSUIMGetControlKeyStatus(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -5425,7 +5425,7 @@ ULONG DMSUIMSetControlKeyProtection(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -5465,7 +5465,7 @@ ULONG DMSUIMUnblockControlKey(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -5505,7 +5505,7 @@ ULONG DMSGetIMSI(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -5545,7 +5545,7 @@ ULONG DMSGetUIMState(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -5585,7 +5585,7 @@ ULONG DMSGetBandCapabilities(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -5625,7 +5625,7 @@ ULONG DMSGetFactorySerialNumber(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -5665,7 +5665,7 @@ ULONG DMSSetDeviceTime(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -5705,7 +5705,7 @@ ULONG DMSGetSoftwareVersion(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -5745,7 +5745,7 @@ ULONG DMSSetSPC(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -5785,7 +5785,7 @@ ULONG DMSGetCurrentPRLInfo(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -5825,7 +5825,7 @@ ULONG DMSBindSubscription(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -5865,7 +5865,7 @@ ULONG DMSGetSubscription(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -5905,7 +5905,7 @@ ULONG NASReset(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -5945,7 +5945,7 @@ ULONG NASAbort(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -5985,7 +5985,7 @@ ULONG NASSetEventReport(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -6025,7 +6025,7 @@ ULONG NASSetRegistrationEventReport(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -6065,7 +6065,7 @@ ULONG NASGetSupportedMessages(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -6105,7 +6105,7 @@ ULONG NASGetSupportedFields(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -6145,7 +6145,7 @@ ULONG NASGetSignalStrength(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -6185,7 +6185,7 @@ ULONG NASPerformNetworkScan(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -6225,7 +6225,7 @@ ULONG NASInitiateNetworkRegister(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -6265,7 +6265,7 @@ ULONG NASInitiateAttach(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -6305,7 +6305,7 @@ ULONG NASGetServingSystem(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -6345,7 +6345,7 @@ ULONG NASGetHomeNetwork(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -6385,7 +6385,7 @@ ULONG NASGetPreferredNetworks(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -6425,7 +6425,7 @@ ULONG NASSetPreferredNetworks(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -6465,7 +6465,7 @@ ULONG NASGetForbiddenNetworks(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -6505,7 +6505,7 @@ ULONG NASSetForbiddenNetworks(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -6545,7 +6545,7 @@ ULONG NASSetTechnologyPreference(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -6585,7 +6585,7 @@ ULONG NASGetTechnologyPreference(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -6625,7 +6625,7 @@ ULONG NASGetACCOLC(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -6665,7 +6665,7 @@ ULONG NASSetACCOLC(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -6705,7 +6705,7 @@ ULONG NASGetSystemPreference(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -6745,7 +6745,7 @@ ULONG NASGetNetworkParameters(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -6785,7 +6785,7 @@ ULONG NASSetNetworkParameters(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -6825,7 +6825,7 @@ ULONG NASGetRFInfo(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -6865,7 +6865,7 @@ ULONG NASGetANAAAAuthenticationStatus(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -6905,7 +6905,7 @@ ULONG NASSetSystemSelectionPref(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -6945,7 +6945,7 @@ ULONG NASGetSystemSelectionPref(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -6985,7 +6985,7 @@ ULONG NASSetDDTMPreference(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -7025,7 +7025,7 @@ ULONG NASGetDDTMPreference(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -7065,7 +7065,7 @@ ULONG NASGetOperatorNameData(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -7105,7 +7105,7 @@ ULONG NASGetCSPPLMNMode(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -7145,7 +7145,7 @@ ULONG NASUpdateAKEY(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -7185,7 +7185,7 @@ ULONG NASGet3GPP2SubscriptionInfo(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -7225,7 +7225,7 @@ ULONG NASSet3GPP2SubscriptionInfo(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -7265,7 +7265,7 @@ ULONG NASGetMobileCAIRevision(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -7305,7 +7305,7 @@ ULONG NASGetRTREConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -7345,7 +7345,7 @@ ULONG NASSetRTREConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -7385,7 +7385,7 @@ ULONG NASGetCellLocationInfo(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -7425,7 +7425,7 @@ ULONG NASGetPLMNName(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -7465,7 +7465,7 @@ ULONG NASBindSubscription(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -7505,7 +7505,7 @@ ULONG NASGetModePref(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -7545,7 +7545,7 @@ ULONG NASSetDualStandbyPreference(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -7585,7 +7585,7 @@ ULONG NASGetSystemInfo(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -7625,7 +7625,7 @@ ULONG NASGetSignalInfo(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -7665,7 +7665,7 @@ ULONG NASConfigureSignalInfo(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -7705,7 +7705,7 @@ ULONG NASGetErrorRate(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -7745,7 +7745,7 @@ ULONG NASGetEVDOProtocolSubtype(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -7785,7 +7785,7 @@ ULONG NASGetEVDOColorCode(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -7825,7 +7825,7 @@ ULONG NASGetAcquisitionSystemMode(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -7865,7 +7865,7 @@ ULONG NASSetRXDiversity(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -7905,7 +7905,7 @@ ULONG NASGetRXTXInfo(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -7945,7 +7945,7 @@ ULONG NASUpdateAKEYExtended(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -7985,7 +7985,7 @@ ULONG NASGetDualStandbyPreference(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -8025,7 +8025,7 @@ ULONG NASDetachLTE(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -8065,7 +8065,7 @@ ULONG NASBlockLTEPLMN(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -8105,7 +8105,7 @@ ULONG NASUnblockLTEPLMN(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -8145,7 +8145,7 @@ ULONG NASResetLTEPLMNBlock(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -8185,7 +8185,7 @@ ULONG NASConfigureEMBMS(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -8225,7 +8225,7 @@ ULONG NASGetEMBMSStatus(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -8265,7 +8265,7 @@ ULONG NASGetCDMAPositionInfo(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -8305,7 +8305,7 @@ ULONG NASForceNetworkSearch(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -8345,7 +8345,7 @@ ULONG NASGetManagedRoamingConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -8385,7 +8385,7 @@ ULONG NASGetCentralizedEONSSupport(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -8425,7 +8425,7 @@ ULONG NASConfigureSignalInfo2(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -8465,7 +8465,7 @@ ULONG NASGetTDSCDMACellInfo(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -8505,7 +8505,7 @@ ULONG NASSetHPLMNIRATSearchTimer(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -8545,7 +8545,7 @@ ULONG NASGetEMBMSSignalQuality(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -8585,7 +8585,7 @@ ULONG NASLimitSystemInfoIndications(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -8625,7 +8625,7 @@ ULONG NASGetSystemInfoIndicationLimits(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -8665,7 +8665,7 @@ ULONG NASUpdateIMSStatus(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -8705,7 +8705,7 @@ ULONG NASGetIMSPreference(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -8745,7 +8745,7 @@ ULONG NASConfigurePLMNNameIndication(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -8785,7 +8785,7 @@ ULONG NASCDMAAvoidSystem(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -8825,7 +8825,7 @@ ULONG NASGetCDMAAvoidSystemList(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -8865,7 +8865,7 @@ ULONG NASSetHPLMNSearchTimer(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -8905,7 +8905,7 @@ ULONG NASGetHPLMNSearchTimer(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -8945,7 +8945,7 @@ ULONG NASSetE911State(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -8985,7 +8985,7 @@ ULONG NASGetSubscriptionInfo(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -9025,7 +9025,7 @@ ULONG NASGetNetworkTime(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -9065,7 +9065,7 @@ ULONG NASGetLTESIB16NetworkTime(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -9105,7 +9105,7 @@ ULONG WMSReset(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -9145,7 +9145,7 @@ ULONG WMSSetEventReport(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -9185,7 +9185,7 @@ ULONG WMSGetSupportedMessages(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -9225,7 +9225,7 @@ ULONG WMSGetSupportedFields(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -9265,7 +9265,7 @@ ULONG WMSRawSend(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -9305,7 +9305,7 @@ ULONG WMSRawWrite(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -9345,7 +9345,7 @@ ULONG WMSRawRead(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -9385,7 +9385,7 @@ ULONG WMSModifyTag(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -9425,7 +9425,7 @@ ULONG WMSDelete(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -9465,7 +9465,7 @@ ULONG WMSGetMessageProtocol(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -9505,7 +9505,7 @@ ULONG WMSListMessages(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -9545,7 +9545,7 @@ ULONG WMSSetRoutes(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -9585,7 +9585,7 @@ ULONG WMSGetRoutes(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -9625,7 +9625,7 @@ ULONG WMSGetSMSCAddress(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -9665,7 +9665,7 @@ ULONG WMSSetSMSCAddress(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -9705,7 +9705,7 @@ ULONG WMSGetStorageMaxSize(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -9745,7 +9745,7 @@ ULONG WMSSendACK(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -9785,7 +9785,7 @@ ULONG WMSSetRetryPeriod(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -9825,7 +9825,7 @@ ULONG WMSSetRetryInterval(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -9865,7 +9865,7 @@ ULONG WMSSetDCDisconnectTimer(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -9905,7 +9905,7 @@ ULONG WMSSetMemoryStatus(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -9945,7 +9945,7 @@ ULONG WMSSetBroadcastActivation(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -9985,7 +9985,7 @@ ULONG WMSSetBroadcastConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -10025,7 +10025,7 @@ ULONG WMSGetBroadcastConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -10065,7 +10065,7 @@ ULONG WMSGetDomainPreference(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -10105,7 +10105,7 @@ ULONG WMSSetDomainPreference(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -10145,7 +10145,7 @@ ULONG WMSSendFromMemoryStore(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -10185,7 +10185,7 @@ ULONG WMSGetWaitingMessage(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -10225,7 +10225,7 @@ ULONG WMSSetPrimaryClient(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -10265,7 +10265,7 @@ ULONG WMSIndicatorRegistration(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -10305,7 +10305,7 @@ ULONG WMSGetTransportLayerInfo(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -10345,7 +10345,7 @@ ULONG WMSGetNetworkRegistrationInfo(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -10385,7 +10385,7 @@ ULONG WMSBindSubscription(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -10425,7 +10425,7 @@ ULONG WMSGetIndicatorRegistration(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -10465,7 +10465,7 @@ ULONG WMSGetSMSParameters(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -10505,7 +10505,7 @@ ULONG WMSSetSMSParameters(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -10545,7 +10545,7 @@ ULONG WMSGetDomainPreferenceConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -10585,7 +10585,7 @@ ULONG WMSSetDomainPreferenceConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -10625,7 +10625,7 @@ ULONG WMSGetRetryPeriod(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -10665,7 +10665,7 @@ ULONG WMSGetRetryInterval(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -10705,7 +10705,7 @@ ULONG WMSGetDCDisconnectTimer(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -10745,7 +10745,7 @@ ULONG WMSGetMemoryStatus(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -10785,7 +10785,7 @@ ULONG WMSGetPrimaryClient(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -10825,7 +10825,7 @@ ULONG WMSGetSubscriptionBinding(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -10865,7 +10865,7 @@ ULONG WMSAsyncRawSend(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -10905,7 +10905,7 @@ ULONG WMSAsyncSendACK(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -10945,7 +10945,7 @@ ULONG WMSAsyncSendFromMemoryStore(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -10985,7 +10985,7 @@ ULONG WMSGetServiceReadyStatus(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -11025,7 +11025,7 @@ ULONG WMSSetWaitingMessage(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -11065,7 +11065,7 @@ ULONG PDSReset(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -11105,7 +11105,7 @@ ULONG PDSSetEventReport(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -11145,7 +11145,7 @@ ULONG PDSGetServiceState(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -11185,7 +11185,7 @@ ULONG PDSSetServiceState(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -11225,7 +11225,7 @@ ULONG PDSStartTrackingSession(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -11265,7 +11265,7 @@ ULONG PDSGetTrackingSessionInfo(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -11305,7 +11305,7 @@ ULONG PDSFixPosition(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -11345,7 +11345,7 @@ ULONG PDSEndTrackingSession(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -11385,7 +11385,7 @@ ULONG PDSGetNMEAConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -11425,7 +11425,7 @@ ULONG PDSSetNMEAConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -11465,7 +11465,7 @@ ULONG PDSInjectTimeReference(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -11505,7 +11505,7 @@ ULONG PDSGetDefaults(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -11545,7 +11545,7 @@ ULONG PDSSetDefaults(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -11585,7 +11585,7 @@ ULONG PDSGetXTRAParameters(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -11625,7 +11625,7 @@ ULONG PDSSetXTRAParameters(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -11665,7 +11665,7 @@ ULONG PDSForceXTRADownload(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -11705,7 +11705,7 @@ ULONG PDSGetAGPSConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -11745,7 +11745,7 @@ ULONG PDSSetAGPSConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -11785,7 +11785,7 @@ ULONG PDSGetServiceAutoTrackingState(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -11825,7 +11825,7 @@ ULONG PDSSetServiceAutoTrackingState(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -11865,7 +11865,7 @@ ULONG PDSGetCOMPortAutoTrackingConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -11905,7 +11905,7 @@ ULONG PDSSetCOMPortAutoTrackingConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -11945,7 +11945,7 @@ ULONG PDSResetPDSData(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -11985,7 +11985,7 @@ ULONG PDSSinglePositionFix(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -12025,7 +12025,7 @@ ULONG PDSGetServiceVersion(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -12065,7 +12065,7 @@ ULONG PDSInjectXTRAData(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -12105,7 +12105,7 @@ ULONG PDSInjectPositionData(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -12145,7 +12145,7 @@ ULONG PDSInjectWiFiPositionData(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -12185,7 +12185,7 @@ ULONG PDSGetSBASConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -12225,7 +12225,7 @@ ULONG PDSSetSBASConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -12265,7 +12265,7 @@ ULONG PDSSendNetworkInitiatedResponse(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -12305,7 +12305,7 @@ ULONG PDSInjectAbsoluteTime(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -12345,7 +12345,7 @@ ULONG PDSInjectEFSData(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -12385,7 +12385,7 @@ ULONG PDSGetDPOConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -12425,7 +12425,7 @@ ULONG PDSSetDPOConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -12465,7 +12465,7 @@ ULONG PDSGetODPConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -12505,7 +12505,7 @@ ULONG PDSSetODPConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -12545,7 +12545,7 @@ ULONG PDSCancelSinglePositionFix(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -12585,7 +12585,7 @@ ULONG PDSGetGPSState(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -12625,7 +12625,7 @@ ULONG PDSSetPPMEventReport(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -12665,7 +12665,7 @@ ULONG PDSSetSPIStreamingReport(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -12705,7 +12705,7 @@ ULONG PDSSetSPIStatus(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -12745,7 +12745,7 @@ ULONG PDSSetPPMReportingState(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -12785,7 +12785,7 @@ ULONG PDSForceReceiverOff(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -12825,7 +12825,7 @@ ULONG PDSGetPositionMethodsState(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -12865,7 +12865,7 @@ ULONG PDSSetPositionMethodsState(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -12905,7 +12905,7 @@ ULONG PDSInjectSensorData(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -12945,7 +12945,7 @@ ULONG PDSInjectTimeSyncData(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -12985,7 +12985,7 @@ ULONG PDSGetSensorConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -13025,7 +13025,7 @@ ULONG PDSSetSensorConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -13065,7 +13065,7 @@ ULONG PDSGetSensorNavigation(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -13105,7 +13105,7 @@ ULONG PDSSetNavigationConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -13145,7 +13145,7 @@ ULONG PDSSetWLANBlanking(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -13185,7 +13185,7 @@ ULONG PDSSetSecurityChallengeReport(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -13225,7 +13225,7 @@ ULONG PDSSetSecurityChallenge(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -13265,7 +13265,7 @@ ULONG PDSGetSecurityEncryptionConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -13305,7 +13305,7 @@ ULONG PDSSetSecurityUpdateRate(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -13345,7 +13345,7 @@ ULONG PDSSetCellDatabaseControl(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -13385,7 +13385,7 @@ ULONG PDSInjectMotionData(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -13425,7 +13425,7 @@ ULONG PDSSetGNSSEngineErrorRecoveryReport(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -13465,7 +13465,7 @@ ULONG PDSResetLocationService(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -13505,7 +13505,7 @@ ULONG PDSInjectTestData(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -13545,7 +13545,7 @@ ULONG PDSSetGNSSRFConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -13585,7 +13585,7 @@ ULONG PDSInjectCourseOverGroundData(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -13625,7 +13625,7 @@ ULONG PDSInjectSUPLCertificate(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -13665,7 +13665,7 @@ ULONG PDSDeleteSUPLCertificate(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -13705,7 +13705,7 @@ ULONG PDSGetIS801OverSUPLIndicator(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -13745,7 +13745,7 @@ ULONG PDSSetIS801OverSUPLIndicator(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -13785,7 +13785,7 @@ ULONG PDSGetSUPLHashAlgorithm(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -13825,7 +13825,7 @@ ULONG PDSSetSUPLHashAlgorithm(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -13865,7 +13865,7 @@ ULONG PDSGetSUPLMaximumVersion(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -13905,7 +13905,7 @@ ULONG PDSSetSUPLMaximumVersion(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -13945,7 +13945,7 @@ ULONG PDSGetSUPLSecurity(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -13985,7 +13985,7 @@ ULONG PDSSetSUPLSecurity(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -14025,7 +14025,7 @@ ULONG PDSGetSUPLTLSVersion(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -14065,7 +14065,7 @@ ULONG PDSSetSUPLTLSVersion(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -14105,7 +14105,7 @@ ULONG PDSGetAGNSSPositioningModes(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -14145,7 +14145,7 @@ ULONG PDSSetAGNSSPositioningModes(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -14185,7 +14185,7 @@ ULONG PDSGetEmergencyProtocolConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -14225,7 +14225,7 @@ ULONG PDSSetEmergencyProtocolConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -14265,7 +14265,7 @@ ULONG PDSGetAPNProfiles(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -14305,7 +14305,7 @@ ULONG PDSSetAPNProfiles(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -14345,7 +14345,7 @@ ULONG PDSGetHomeSUPLAddress(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -14385,7 +14385,7 @@ ULONG PDSSetHomeSUPLAddress(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -14425,7 +14425,7 @@ ULONG PDSInjectVehicleSensorData(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -14465,7 +14465,7 @@ ULONG PDSInjectPedometerData(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -14505,7 +14505,7 @@ ULONG AUTHStartEAPSession(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -14545,7 +14545,7 @@ ULONG AUTHSendEAPPacket(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -14585,7 +14585,7 @@ ULONG AUTHGetEAPSessionKeys(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -14625,7 +14625,7 @@ ULONG AUTHEndEAPSession(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -14665,7 +14665,7 @@ ULONG AUTHRunAKA(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -14705,7 +14705,7 @@ ULONG VoiceIndicationRegistration(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -14745,7 +14745,7 @@ ULONG VoiceGetSupportedMessages(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -14785,7 +14785,7 @@ ULONG VoiceGetSupportedFields(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -14825,7 +14825,7 @@ ULONG VoiceCallOriginate(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -14865,7 +14865,7 @@ ULONG VoiceCallEnd(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -14905,7 +14905,7 @@ ULONG VoiceCallAnswer(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -14945,7 +14945,7 @@ ULONG VoiceGetCallInfo(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -14985,7 +14985,7 @@ ULONG VoiceSendFlash(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -15025,7 +15025,7 @@ ULONG VoiceBurstDTMF(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -15065,7 +15065,7 @@ ULONG VoiceStartContinuousDTMF(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -15105,7 +15105,7 @@ ULONG VoiceStopContinuousDTMF(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -15145,7 +15145,7 @@ ULONG VoiceSetPreferredPrivacy(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -15185,7 +15185,7 @@ ULONG VoiceGetAllCallInfo(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -15225,7 +15225,7 @@ ULONG VoiceManageCalls(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -15265,7 +15265,7 @@ ULONG VoiceSetSupplementaryService(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -15305,7 +15305,7 @@ ULONG VoiceGetCallWaiting(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -15345,7 +15345,7 @@ ULONG VoiceGetCallBarring(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -15385,7 +15385,7 @@ ULONG VoiceGetCLIP(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -15425,7 +15425,7 @@ ULONG VoiceGetCLIR(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -15465,7 +15465,7 @@ ULONG VoiceGetCallForwarding(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -15505,7 +15505,7 @@ ULONG VoiceSetCallBarringPassword(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -15545,7 +15545,7 @@ ULONG VoiceInitiateUSSD(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -15585,7 +15585,7 @@ ULONG VoiceAnswerUSSD(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -15625,7 +15625,7 @@ ULONG VoiceCancelUSSD(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -15665,7 +15665,7 @@ ULONG VoiceSetConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -15705,7 +15705,7 @@ ULONG VoiceGetConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -15745,7 +15745,7 @@ ULONG VoiceAsyncInitiateUSSD(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -15785,7 +15785,7 @@ ULONG VoiceBindSubscription(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -15825,7 +15825,7 @@ ULONG VoiceALSSetLineSwitching(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -15865,7 +15865,7 @@ ULONG VoiceALSSelectLine(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -15905,7 +15905,7 @@ ULONG VoiceAOCResetACM(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -15945,7 +15945,7 @@ ULONG VoiceAOCSetACMMaximum(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -15985,7 +15985,7 @@ ULONG VoiceAOCGetCallMeterInfo(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -16025,7 +16025,7 @@ ULONG VoiceGetCOLP(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -16065,7 +16065,7 @@ ULONG VoiceGetCOLR(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -16105,7 +16105,7 @@ ULONG VoiceGetCNAP(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -16145,7 +16145,7 @@ ULONG VoiceManageIPCalls(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -16185,7 +16185,7 @@ ULONG VoiceALSGetLineSwitchingStatus(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -16225,7 +16225,7 @@ ULONG VoiceALSGetSelectedLine(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -16265,7 +16265,7 @@ ULONG CAT2Reset(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -16305,7 +16305,7 @@ ULONG CAT2SetEventReport(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -16345,7 +16345,7 @@ ULONG CAT2GetSupportedMessages(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -16385,7 +16385,7 @@ ULONG CAT2GetSupportedFields(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -16425,7 +16425,7 @@ ULONG CAT2GetServiceState(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -16465,7 +16465,7 @@ ULONG CAT2SendTerminalResponse(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -16505,7 +16505,7 @@ ULONG CAT2EnvelopeCommand(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -16545,7 +16545,7 @@ ULONG CAT2GetEventReport(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -16585,7 +16585,7 @@ ULONG CAT2SendDecodedTerminalResponse(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -16625,7 +16625,7 @@ ULONG CAT2SendDecodedEnvelopeCommand(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -16665,7 +16665,7 @@ ULONG CAT2EventConfirmation(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -16705,7 +16705,7 @@ ULONG CAT2SCWSOpenChannel(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -16745,7 +16745,7 @@ ULONG CAT2SCWSCloseChannel(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -16785,7 +16785,7 @@ ULONG CAT2SCWSSendData(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -16825,7 +16825,7 @@ ULONG CAT2SCWSDataAvailable(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -16865,7 +16865,7 @@ ULONG CAT2SCWSChannelStatus(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -16905,7 +16905,7 @@ ULONG CAT2GetTerminalProfile(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -16945,7 +16945,7 @@ ULONG CAT2SetConfiguration(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -16985,7 +16985,7 @@ ULONG CAT2GetConfiguration(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -17025,7 +17025,7 @@ ULONG UIMReset(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -17065,7 +17065,7 @@ ULONG UIMGetSupportedMessages(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -17105,7 +17105,7 @@ ULONG UIMGetSupportedFields(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -17145,7 +17145,7 @@ ULONG UIMReadTransparent(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -17185,7 +17185,7 @@ ULONG UIMReadRecord(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -17225,7 +17225,7 @@ ULONG UIMWriteTransparent(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -17265,7 +17265,7 @@ ULONG UIMWriteRecord(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -17305,7 +17305,7 @@ ULONG UIMGetFileAttributes(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -17345,7 +17345,7 @@ ULONG UIMSetPINProtection(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -17385,7 +17385,7 @@ ULONG UIMVerifyPIN(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -17425,7 +17425,7 @@ ULONG UIMUnblockPIN(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -17465,7 +17465,7 @@ ULONG UIMChangePIN(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -17505,7 +17505,7 @@ ULONG UIMDepersonalization(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -17545,7 +17545,7 @@ ULONG UIMRefreshRegister(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -17585,7 +17585,7 @@ ULONG UIMRefreshOK(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -17625,7 +17625,7 @@ ULONG UIMRefreshComplete(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -17665,7 +17665,7 @@ ULONG UIMGetLastRefreshEvent(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -17705,7 +17705,7 @@ ULONG UIMEventRegistration(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -17745,7 +17745,7 @@ ULONG UIMGetCardStatus(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -17785,7 +17785,7 @@ ULONG UIMPowerDown(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -17825,7 +17825,7 @@ ULONG UIMPowerUp(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -17865,7 +17865,7 @@ ULONG UIMAuthenticate(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -17905,7 +17905,7 @@ ULONG UIMCloseSession(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -17945,7 +17945,7 @@ ULONG UIMGetServiceStatus(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -17985,7 +17985,7 @@ ULONG UIMSetServiceStatus(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -18025,7 +18025,7 @@ ULONG UIMChangeProvisioningSession(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -18065,7 +18065,7 @@ ULONG UIMGetLabel(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -18105,7 +18105,7 @@ ULONG UIMGetConfiguration(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -18145,7 +18145,7 @@ ULONG UIMSendADPU(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -18185,7 +18185,7 @@ ULONG UIMSAPConnection(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -18225,7 +18225,7 @@ ULONG UIMSAPRequest(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -18265,7 +18265,7 @@ ULONG UIMLogicalChannel(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -18305,7 +18305,7 @@ ULONG UIMSubscriptionOK(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -18345,7 +18345,7 @@ ULONG UIMGetATR(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -18385,7 +18385,7 @@ ULONG UIMOpenLogicalChannel(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -18425,7 +18425,7 @@ ULONG UIMRefreshRegisterAll(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -18465,7 +18465,7 @@ ULONG UIMSetFileStatus(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -18505,7 +18505,7 @@ ULONG PBMSetIndicationRegistrationState(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -18545,7 +18545,7 @@ ULONG PBMGetCapabilities(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -18585,7 +18585,7 @@ ULONG PBMGetAllCapabilities(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -18625,7 +18625,7 @@ ULONG PBMReadRecords(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -18665,7 +18665,7 @@ ULONG PBMWriteRecord(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -18705,7 +18705,7 @@ ULONG PBMDeleteRecord(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -18745,7 +18745,7 @@ ULONG PBMDeleteAllRecords(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -18785,7 +18785,7 @@ ULONG PBMSearchRecords(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -18825,7 +18825,7 @@ ULONG PBMGetEmergencyList(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -18865,7 +18865,7 @@ ULONG PBMGetAllGroups(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -18905,7 +18905,7 @@ ULONG PBMSetGroupInfo(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -18945,7 +18945,7 @@ ULONG PBMGetState(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -18985,7 +18985,7 @@ ULONG PBMReadAllHiddenRecords(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -19025,7 +19025,7 @@ ULONG PBMGetNextEmptyRecordID(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -19065,7 +19065,7 @@ ULONG PBMGetNextRecordID(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -19105,7 +19105,7 @@ ULONG PBMGetAASList(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -19145,7 +19145,7 @@ ULONG PBMSetAAS(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -19185,7 +19185,7 @@ ULONG PBMBindSubscription(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -19225,7 +19225,7 @@ ULONG PBMGetSubscription(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -19265,7 +19265,7 @@ ULONG PBMSetCapabilitiesReadOperation(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -19305,7 +19305,7 @@ ULONG PBMExtendedReadRecords(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -19345,7 +19345,7 @@ ULONG PBMExtendedWriteRecord(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -19385,7 +19385,7 @@ ULONG PBMExtendedSearchRecords(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -19425,7 +19425,7 @@ ULONG PBMExtendedReadAllHiddenRecords(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -19465,7 +19465,7 @@ ULONG PBMReadUndecodedRecords(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -19505,7 +19505,7 @@ ULONG LOCGetSupportedMessages(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -19545,7 +19545,7 @@ ULONG LOCGetSupportedFields(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -19585,7 +19585,7 @@ ULONG LOCClientRevision(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -19625,7 +19625,7 @@ ULONG LOCRegisterEvents(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -19665,7 +19665,7 @@ ULONG LOCStart(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -19705,7 +19705,7 @@ ULONG LOCStop(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -19745,7 +19745,7 @@ ULONG LOCGetServiceRevision(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -19785,7 +19785,7 @@ ULONG LOCGetFixCriteria(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -19825,7 +19825,7 @@ ULONG LOCProvideNIUserResponse(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -19865,7 +19865,7 @@ ULONG LOCInjectPredictedOrbitsData(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -19905,7 +19905,7 @@ ULONG LOCGetPredictedOrbitsDataSource(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -19945,7 +19945,7 @@ ULONG LOCGetPredictedOrbitsDataValidity(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -19985,7 +19985,7 @@ ULONG LOCInjectUTCTime(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -20025,7 +20025,7 @@ ULONG LOCInjectPosition(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -20065,7 +20065,7 @@ ULONG LOCSetEngineLock(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -20105,7 +20105,7 @@ ULONG LOCGetEngineLock(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -20145,7 +20145,7 @@ ULONG LOCSetSBASConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -20185,7 +20185,7 @@ ULONG LOCGetSBASConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -20225,7 +20225,7 @@ ULONG LOCSetNMEATypes(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -20265,7 +20265,7 @@ ULONG LOCGetNMEATypes(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -20305,7 +20305,7 @@ ULONG LOCSetLowPowerMode(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -20345,7 +20345,7 @@ ULONG LOCGetLowPowerMode(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -20385,7 +20385,7 @@ ULONG LOCSetLocationServer(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -20425,7 +20425,7 @@ ULONG LOCGetLocationServer(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -20465,7 +20465,7 @@ ULONG LOCDeleteAssistData(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -20505,7 +20505,7 @@ ULONG LOCSetXTRATSessionControl(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -20545,7 +20545,7 @@ ULONG LOC(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -20585,7 +20585,7 @@ ULONG LOCInjectWiFiPosition(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -20625,7 +20625,7 @@ ULONG LOCProvideWiFiStatus(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -20665,7 +20665,7 @@ ULONG LOCGetRegisteredEvents(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -20705,7 +20705,7 @@ ULONG LOCSetOperationMode(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -20745,7 +20745,7 @@ ULONG LOCGetOperationMode(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -20785,7 +20785,7 @@ ULONG LOCSetSPIStatus(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -20825,7 +20825,7 @@ ULONG LOCInjectSensorData(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -20865,7 +20865,7 @@ ULONG LOCInjectTimeSyncData(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -20905,7 +20905,7 @@ ULONG LOCSetCradleMountConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -20945,7 +20945,7 @@ ULONG LOCGetCradleMountConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -20985,7 +20985,7 @@ ULONG LOCSetExternalPowerConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -21025,7 +21025,7 @@ ULONG LOCGetExternalPowerConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -21065,7 +21065,7 @@ ULONG LOCProvideConnectionStatus(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -21105,7 +21105,7 @@ ULONG LOCSetProtocolConfigParameters(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -21145,7 +21145,7 @@ ULONG LOCGetProtocolConfigParameters(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -21185,7 +21185,7 @@ ULONG LOCSetSensorControlConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -21225,7 +21225,7 @@ ULONG LOCGetSensorControlConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -21265,7 +21265,7 @@ ULONG LOCSetSensorProperties(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -21305,7 +21305,7 @@ ULONG LOCGetSensorProperties(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -21345,7 +21345,7 @@ ULONG LOCSetSensorPerformanceConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -21385,7 +21385,7 @@ ULONG LOCGetSensorPerformanceConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -21425,7 +21425,7 @@ ULONG LOCInjectSUPLCertificate(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -21465,7 +21465,7 @@ ULONG LOCDeleteSUPLCertificate(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -21505,7 +21505,7 @@ ULONG LOCSetPositionEngineConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -21545,7 +21545,7 @@ ULONG LOCGetPositionEngineConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -21585,7 +21585,7 @@ ULONG LOCAddCircularGeofence(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -21625,7 +21625,7 @@ ULONG LOCDeleteGeofence(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -21665,7 +21665,7 @@ ULONG LOCQueryGeofence(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -21705,7 +21705,7 @@ ULONG LOCEditGeofence(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -21745,7 +21745,7 @@ ULONG LOCGetBestAvailablePosition(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -21785,7 +21785,7 @@ ULONG LOCInjectMotionData(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -21825,7 +21825,7 @@ ULONG LOCGetNIGeofenceIDList(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -21865,7 +21865,7 @@ ULONG LOCInjectGSMCellInfo(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -21905,7 +21905,7 @@ ULONG LOCInjectNetworkInitiatedMessage(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -21945,7 +21945,7 @@ ULONG LOCNotifyWWANOutOfService(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -21985,7 +21985,7 @@ ULONG LOCInjectPedometerData(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -22025,7 +22025,7 @@ ULONG LOCInjectWCDMACellInfo(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -22065,7 +22065,7 @@ ULONG LOCInjectTDSCDMACellInfo(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -22105,7 +22105,7 @@ ULONG LOCInjectSubscriberID(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -22145,7 +22145,7 @@ ULONG WDAGetSupportedMessages(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -22185,7 +22185,7 @@ ULONG WDAGetSupportedFields(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -22225,7 +22225,7 @@ ULONG WDASetDataFormat(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -22265,7 +22265,7 @@ ULONG WDAGetDataFormat(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -22305,7 +22305,7 @@ ULONG WDAEnablePacketFilter(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -22345,7 +22345,7 @@ ULONG WDADisablePacketFilter(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -22385,7 +22385,7 @@ ULONG WDAGetPacketFilterState(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -22425,7 +22425,7 @@ ULONG WDAAddPacketFilterRule(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -22465,7 +22465,7 @@ ULONG WDADeletePacketFilterRule(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -22505,7 +22505,7 @@ ULONG WDAGetPacketFilterRuleHandles(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -22545,7 +22545,7 @@ ULONG WDAGetPacketFilterRule(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -22585,7 +22585,7 @@ ULONG WDASetLoopbackState(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -22625,7 +22625,7 @@ ULONG WDAGetLoopbackState(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -22665,7 +22665,7 @@ ULONG QCMAPEnable(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -22705,7 +22705,7 @@ ULONG QCMAPDisable(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -22745,7 +22745,7 @@ ULONG QCMAPBringUpWWAN(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -22785,7 +22785,7 @@ ULONG QCMAPTearDownWWAN(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -22825,7 +22825,7 @@ ULONG QCMAPGetWWANStatus(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -22865,7 +22865,7 @@ ULONG QCMAPGetIPSecVPNPassthrough(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -22905,7 +22905,7 @@ ULONG QCMAPSetIPSecVPNPassthrough(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -22945,7 +22945,7 @@ ULONG QCMAPGetPPTPVPNPassthrough(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -22985,7 +22985,7 @@ ULONG QCMAPSetPPTPVPNPassthrough(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -23025,7 +23025,7 @@ ULONG QCMAPGetL2TPVPNPassthrough(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -23065,7 +23065,7 @@ ULONG QCMAPSetL2TPVPNPassthrough(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -23105,7 +23105,7 @@ ULONG QCMAPGetDynamicNATEntryTimeout(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -23145,7 +23145,7 @@ ULONG QCMAPSetDynamicNATEntryTimeout(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -23185,7 +23185,7 @@ ULONG QCMAPAddStaticNATEntry(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -23225,7 +23225,7 @@ ULONG QCMAPDeleteStaticNATEntry(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -23265,7 +23265,7 @@ ULONG QCMAPGetStaticNATEntries(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -23305,7 +23305,7 @@ ULONG QCMAPSetDMZ(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -23345,7 +23345,7 @@ ULONG QCMAPDeleteDMZ(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -23385,7 +23385,7 @@ ULONG QCMAPGetDMZ(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -23425,7 +23425,7 @@ ULONG QCMAPGetWWANConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -23465,7 +23465,7 @@ ULONG QCMAPEnableFirewallSetting(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -23505,7 +23505,7 @@ ULONG QCMAPGetFirewallSetting(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -23545,7 +23545,7 @@ ULONG QCMAPDisableFirewallSetting(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -23585,7 +23585,7 @@ ULONG QCMAPAddFirewallConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -23625,7 +23625,7 @@ ULONG QCMAPGetFirewallConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -23665,7 +23665,7 @@ ULONG QCMAPDeleteFirewallConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -23705,7 +23705,7 @@ ULONG QCMAPWWANStatusIndicationRegister(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -23745,7 +23745,7 @@ ULONG QCMAPStationModeEnable(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -23785,7 +23785,7 @@ ULONG QCMAPStationModeDisable(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -23825,7 +23825,7 @@ ULONG QCMAPGetStationMode(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -23865,7 +23865,7 @@ ULONG QCMAPAddExtendedFirewallConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -23905,7 +23905,7 @@ ULONG QCMAPGetExtendedFirewallConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -23945,7 +23945,7 @@ ULONG QCMAPGetFirewallHandles(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -23985,7 +23985,7 @@ ULONG QCMAPChangeNATType(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -24025,7 +24025,7 @@ ULONG QCMAPGetNATType(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -24065,7 +24065,7 @@ ULONG PDCReset(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -24105,7 +24105,7 @@ ULONG PDCRegisterForIndications(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -24145,7 +24145,7 @@ ULONG PDCGetSelectedConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -24185,7 +24185,7 @@ ULONG PDCSetSelectedConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -24225,7 +24225,7 @@ ULONG PDCListConfigs(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -24265,7 +24265,7 @@ ULONG PDCDeleteConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -24305,7 +24305,7 @@ ULONG PDCLoadConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -24345,7 +24345,7 @@ ULONG PDCActivateConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -24385,7 +24385,7 @@ ULONG PDCGetConfigInfo(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -24425,7 +24425,7 @@ ULONG PDCGetConfigLimits(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -24465,7 +24465,7 @@ ULONG PDCGetDefaultConfigInfo(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -24505,7 +24505,7 @@ ULONG PDCDeactivateConfig(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -24545,7 +24545,7 @@ ULONG RFRPESetRFMScenario(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -24585,7 +24585,7 @@ ULONG RFRPEGetRFMScenario(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -24625,7 +24625,7 @@ ULONG RFRPEGetProvisionedTableRevision(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -24665,7 +24665,7 @@ ULONG CATReset(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -24705,7 +24705,7 @@ ULONG CATSetEventReport(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -24745,7 +24745,7 @@ ULONG CATGetSupportedMessages(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -24785,7 +24785,7 @@ ULONG CATGetSupportedFields(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -24825,7 +24825,7 @@ ULONG CATGetServiceState(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -24865,7 +24865,7 @@ ULONG CATSendTerminalResponse(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -24905,7 +24905,7 @@ ULONG CATEnvelopeCommand(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -24945,7 +24945,7 @@ ULONG CATGetEventReport(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -24985,7 +24985,7 @@ ULONG CATSendDecodedTerminalResponse(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -25025,7 +25025,7 @@ ULONG CATSendDecodedEnvelopeCommand(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -25065,7 +25065,7 @@ ULONG CATEventConfirmation(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -25105,7 +25105,7 @@ ULONG CATSCWSOpenChannel(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -25145,7 +25145,7 @@ ULONG CATSCWSCloseChannel(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -25185,7 +25185,7 @@ ULONG CATSCWSSendData(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -25225,7 +25225,7 @@ ULONG CATSCWSDataAvailable(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -25265,7 +25265,7 @@ ULONG CATSCWSChannelStatus(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -25305,7 +25305,7 @@ ULONG CATGetTerminalProfile(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -25345,7 +25345,7 @@ ULONG CATSetConfiguration(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -25385,7 +25385,7 @@ ULONG CATGetConfiguration(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -25425,7 +25425,7 @@ ULONG RMSReset(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -25465,7 +25465,7 @@ ULONG RMSGetSMSWake(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -25505,7 +25505,7 @@ ULONG RMSSetSMSWake(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -25545,7 +25545,7 @@ ULONG OMAReset(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -25585,7 +25585,7 @@ ULONG OMASetEventReport(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -25625,7 +25625,7 @@ ULONG OMAStartSession(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -25665,7 +25665,7 @@ ULONG OMACancelSession(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -25705,7 +25705,7 @@ ULONG OMAGetSessionInfo(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -25745,7 +25745,7 @@ ULONG OMASendSelection(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -25785,7 +25785,7 @@ ULONG OMAGetFeatures(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
@@ -25825,7 +25825,7 @@ ULONG OMASetFeatures(
    ULONG *                    pOutLen,
    BYTE *                     pOut )
 {
-   cGobiConnectionMgmt * pAPI = gDLL.GetAPI( handle );
+   cGobiAPIRef pAPI = gDLL.GetAPI( handle );
    if (pAPI == 0)
    {
       return (ULONG)eGOBI_ERR_INTERNAL;
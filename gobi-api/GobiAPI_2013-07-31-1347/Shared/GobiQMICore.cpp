@@ -264,6 +264,75 @@ eGobiError cGobiQMICore::Send(
    const BYTE *               pIn,
    ULONG *                    pOutLen,
    BYTE *                     pOut )
+{
+   sQMIServiceBuffer qmiRsp( 0 );
+   eGobiError rc = Send( svcID, msgID, to, inLen, pIn, qmiRsp );
+   if (qmiRsp.IsValid() == false)
+   {
+      return rc;
+   }
+   
+   // Caller might not be interested in actual output (beyond error code)
+   ULONG maxSz = 0;
+   if (pOutLen != 0)
+   {
+      maxSz = *pOutLen;
+   }
+
+   if (maxSz > 0)
+   {
+      // TLV 2 is always present
+      ULONG needSz = 0;
+      const BYTE * pData = (const BYTE *)qmiRsp.GetRawContents( needSz );
+      if (needSz == 0 || pData == 0)
+      {
+         return eGOBI_ERR_INVALID_RSP;
+      }
+
+      *pOutLen = needSz;
+      if (needSz > maxSz)
+      {
+         return eGOBI_ERR_BUFFER_SZ;
+      }
+
+      memcpy( pOut, pData, needSz );
+   }
+
+   return rc;
+}
+
+/*===========================================================================
+METHOD:
+   Send (Public Method)
+
+DESCRIPTION:
+   Send a request using the specified QMI protocol server and wait for (and
+   then return) the response
+
+   The response is handed back in place: rsp shares the received buffer
+   (rather than copying it) and its TLV directory has already been built, 
+   so rsp.GetRawContents() and rsp.GetContents() can be used to parse the
+   response directly.  rsp is set whenever a well-formed response was 
+   received, including one carrying a QMI error
+
+PARAMETERS:
+   svcID       [ I ] - QMI service type
+   msgID       [ I ] - QMI message ID
+   to          [ I ] - Timeout value (in milliseconds)
+   inLen       [ I ] - Length of input buffer
+   pIn         [ I ] - Input buffer
+   rsp         [ O ] - The response
+
+RETURN VALUE:
+   eGobiError - The result
+===========================================================================*/
+eGobiError cGobiQMICore::Send(
+   ULONG                      svcID,
+   ULONG                      msgID,
+   ULONG                      to,
+   ULONG                      inLen,
+   const BYTE *               pIn,
+   sQMIServiceBuffer &        rsp )
 {
    // Clear last error recorded
    ClearLastError();
@@ -336,7 +405,7 @@ eGobiError cGobiQMICore::Send(
    DWORD idx;
 
    // Returned response
-   sProtocolBuffer rsp;
+   sProtocolBuffer logRsp;
 
    // Process up to the indicated timeout
    cEvent & sigEvt = evts.GetSignalEvent();
@@ -401,7 +470,7 @@ eGobiError cGobiQMICore::Send(
 
          case ePROTOCOL_EVT_RSP_RECV:
             // Success!
-            rsp = protocolLog.GetBuffer( evt.mParam2 );
+            logRsp = protocolLog.GetBuffer( evt.mParam2 );
             bExit = true;
             break;
 
@@ -419,44 +488,20 @@ eGobiError cGobiQMICore::Send(
       pSvr->RemoveRequest( reqID );
    }
 
-   if (rsp.IsValid() == false)
+   if (logRsp.IsValid() == false)
    {
       return GetCorrectedLastError();
    }
 
    // Did we receive a valid QMI response?
-   sQMIServiceBuffer qmiRsp( rsp.GetSharedBuffer() );
+   sQMIServiceBuffer qmiRsp( logRsp.GetSharedBuffer() );
    if (qmiRsp.IsValid() == false)
    {
       mLastError = eGOBI_ERR_MALFORMED_RSP;
       return mLastError;
    }
    
-   // Caller might not be interested in actual output (beyond error code)
-   ULONG maxSz = 0;
-   if (pOutLen != 0)
-   {
-      maxSz = *pOutLen;
-   }
-
-   if (maxSz > 0)
-   {
-      // TLV 2 is always present
-      ULONG needSz = 0;
-      const BYTE * pData = (const BYTE *)qmiRsp.GetRawContents( needSz );
-      if (needSz == 0 || pData == 0)
-      {
-         return eGOBI_ERR_INVALID_RSP;
-      }
-
-      *pOutLen = needSz;
-      if (needSz > maxSz)
-      {
-         return eGOBI_ERR_BUFFER_SZ;
-      }
-
-      memcpy( pOut, pData, needSz );
-   }
+   rsp = qmiRsp;
 
    // Check the mandatory QMI result TLV for success
    ULONG rc = 0;
@@ -44,6 +44,7 @@ POSSIBILITY OF SUCH DAMAGE.
 // Include Files
 //---------------------------------------------------------------------------
 #include "ProtocolBuffer.h"
+#include "QMIBuffers.h"
 #include "QMIProtocolServer.h"
 #include "SyncQueue.h"
 #include "GobiError.h"
@@ -141,6 +142,16 @@ class cGobiQMICore
          ULONG *                    pOutLen,
          BYTE *                     pOut );
 
+      // Send a request using the specified QMI protocol server and wait 
+      // for the response, which is returned in place (shared, not copied)
+      eGobiError Send(
+         ULONG                      svcID,
+         ULONG                      msgID,
+         ULONG                      to,
+         ULONG                      inLen,
+         const BYTE *               pIn,
+         sQMIServiceBuffer &        rsp );
+
       // Cancel the most recent in-progress Send() based operation
       eGobiError CancelSend( 
          ULONG                      svcID,
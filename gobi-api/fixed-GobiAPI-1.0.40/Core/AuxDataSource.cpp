@@ -0,0 +1,654 @@
+/*===========================================================================
+FILE: 
+   AuxDataSource.cpp
+
+DESCRIPTION:
+   Implementation of cAuxDataSource base class and derivations
+
+PUBLIC CLASSES AND METHODS:
+   cAuxDataSource
+      This abstract base class provides the auxiliary data of a protocol
+      request to the protocol server, one transmission unit at a time
+
+   cMemoryMappedAuxData
+      This class provides auxiliary data straight from a region of a
+      memory mapped file
+
+   cSharedBufferChain
+      This class provides auxiliary data from a chain of shared buffers
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "StdAfx.h"
+#include "AuxDataSource.h"
+#include "MemoryMappedFile.h"
+
+/*=========================================================================*/
+// cAuxDataSource Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   cAuxDataSource (Public Method)
+
+DESCRIPTION:
+   Constructor
+
+PARAMETERS:
+   tuSize      [ I ] - Transmission unit size (0 for the server's MTU, 
+                       larger values are capped to it)
+   tusInFlight [ I ] - Number of transmission units the server hands to 
+                       the port at once (at least one)
+
+RETURN VALUE:
+   None
+===========================================================================*/
+cAuxDataSource::cAuxDataSource( 
+   ULONG                      tuSize,
+   ULONG                      tusInFlight )
+   :  mTUSize( tuSize ),
+      mTUsInFlight( tusInFlight )
+{
+   if (mTUsInFlight == 0)
+   {
+      mTUsInFlight = 1;
+   }
+}
+
+/*===========================================================================
+METHOD:
+   ~cAuxDataSource (Public Method)
+
+DESCRIPTION:
+   Destructor
+
+RETURN VALUE:
+   None
+===========================================================================*/
+cAuxDataSource::~cAuxDataSource()
+{
+   // Nothing to do
+}
+
+/*===========================================================================
+METHOD:
+   GetTUCount (Public Method)
+
+DESCRIPTION:
+   Return the number of transmission units of (at most) the given size
+   the auxiliary data is sent in
+
+PARAMETERS:
+   tuSize      [ I ] - Transmission unit size
+
+RETURN VALUE:
+   ULONG - 0 if there is no data to send
+===========================================================================*/
+ULONG cAuxDataSource::GetTUCount( ULONG tuSize ) const
+{
+   ULONG sz = GetSize();
+   if (tuSize == 0 || sz == 0 || GetData( 0, sz ) == 0)
+   {
+      return 0;
+   }
+
+   ULONG tus = sz / tuSize;
+   if ((sz % tuSize) != 0)
+   {
+      tus++;
+   }
+
+   return tus;
+}
+
+/*===========================================================================
+METHOD:
+   GetTU (Public Method)
+
+DESCRIPTION:
+   Return the given transmission unit, the range of the auxiliary data 
+   starting at tu * tuSize
+
+PARAMETERS:
+   tu          [ I ] - Transmission unit index
+   tuSize      [ I ] - Transmission unit size
+   tuSz        [ O ] - Size of the transmission unit
+
+RETURN VALUE:
+   const BYTE * - 0 if there is no such transmission unit
+===========================================================================*/
+const BYTE * cAuxDataSource::GetTU( 
+   ULONG                      tu,
+   ULONG                      tuSize,
+   ULONG &                    tuSz ) const
+{
+   tuSz = 0;
+
+   ULONG sz = GetSize();
+   if (tuSize == 0 || tu >= GetTUCount( tuSize ))
+   {
+      return 0;
+   }
+
+   ULONG offset = tu * tuSize;
+   tuSz = sz - offset;
+   if (tuSz > tuSize)
+   {
+      tuSz = tuSize;
+   }
+
+   const BYTE * pTU = GetData( offset, tuSz );
+   if (pTU == 0)
+   {
+      tuSz = 0;
+   }
+
+   return pTU;
+}
+
+/*=========================================================================*/
+// cMemoryMappedAuxData Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   cMemoryMappedAuxData (Public Method)
+
+DESCRIPTION:
+   Constructor
+
+PARAMETERS:
+   file        [ I ] - Memory mapped file (has to outlive the request)
+   offset      [ I ] - Offset of the region within the file
+   size        [ I ] - Size of the region (capped to the end of the file)
+   tuSize      [ I ] - Transmission unit size (0 for the server's MTU)
+   tusInFlight [ I ] - Number of transmission units handed out at once
+
+RETURN VALUE:
+   None
+===========================================================================*/
+cMemoryMappedAuxData::cMemoryMappedAuxData( 
+   cMemoryMappedFile &        file,
+   ULONG                      offset,
+   ULONG                      size,
+   ULONG                      tuSize,
+   ULONG                      tusInFlight )
+   :  cAuxDataSource( tuSize, tusInFlight ),
+      mpData( 0 ),
+      mSize( 0 )
+{
+   const BYTE * pContents = (const BYTE *)file.GetContents();
+   ULONG fileSz = file.GetSize();
+   if (pContents == 0 || offset >= fileSz)
+   {
+      return;
+   }
+
+   if (size > fileSz - offset)
+   {
+      size = fileSz - offset;
+   }
+
+   mpData = pContents + offset;
+   mSize = size;
+}
+
+/*===========================================================================
+METHOD:
+   cMemoryMappedAuxData (Public Method)
+
+DESCRIPTION:
+   Copy constructor
+
+PARAMETERS:
+   source      [ I ] - Source being copied
+
+RETURN VALUE:
+   None
+===========================================================================*/
+cMemoryMappedAuxData::cMemoryMappedAuxData( 
+   const cMemoryMappedAuxData &  source )
+   :  cAuxDataSource( source ),
+      mpData( source.mpData ),
+      mSize( source.mSize )
+{
+   // Nothing to do
+}
+
+/*===========================================================================
+METHOD:
+   ~cMemoryMappedAuxData (Public Method)
+
+DESCRIPTION:
+   Destructor
+
+RETURN VALUE:
+   None
+===========================================================================*/
+cMemoryMappedAuxData::~cMemoryMappedAuxData()
+{
+   // Nothing to do (the mapping is owned by the caller)
+}
+
+/*===========================================================================
+METHOD:
+   Clone (Public Method)
+
+DESCRIPTION:
+   Return an allocated copy of this object
+
+RETURN VALUE:
+   cAuxDataSource * - 0 upon failure
+===========================================================================*/
+cAuxDataSource * cMemoryMappedAuxData::Clone() const
+{
+   cAuxDataSource * pCopy = 0;
+
+   try
+   {
+      pCopy = new cMemoryMappedAuxData( *this );
+   }
+   catch (...)
+   {
+      // Simply return 0
+   }
+
+   return pCopy;
+}
+
+/*===========================================================================
+METHOD:
+   GetSize (Public Method)
+
+DESCRIPTION:
+   Return the total size of the auxiliary data
+
+RETURN VALUE:
+   ULONG
+===========================================================================*/
+ULONG cMemoryMappedAuxData::GetSize() const
+{
+   return mSize;
+}
+
+/*===========================================================================
+METHOD:
+   GetData (Public Method)
+
+DESCRIPTION:
+   Return the given range of the auxiliary data, straight from the mapping
+
+PARAMETERS:
+   offset      [ I ] - Offset of the range
+   len         [ I ] - Length of the range
+
+RETURN VALUE:
+   const BYTE * - 0 if the range is outside of the region
+===========================================================================*/
+const BYTE * cMemoryMappedAuxData::GetData( 
+   ULONG                      offset,
+   ULONG                      len ) const
+{
+   if (mpData == 0 || offset > mSize || len > mSize - offset)
+   {
+      return 0;
+   }
+
+   return mpData + offset;
+}
+
+/*=========================================================================*/
+// cSharedBufferChain Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   cSharedBufferChain (Public Method)
+
+DESCRIPTION:
+   Constructor
+
+PARAMETERS:
+   tuSize      [ I ] - Transmission unit size (0 for the server's MTU)
+   tusInFlight [ I ] - Number of transmission units handed out at once
+
+RETURN VALUE:
+   None
+===========================================================================*/
+cSharedBufferChain::cSharedBufferChain( 
+   ULONG                      tuSize,
+   ULONG                      tusInFlight )
+   :  cAuxDataSource( tuSize, tusInFlight ),
+      mSize( 0 )
+{
+   // Nothing to do
+}
+
+/*===========================================================================
+METHOD:
+   cSharedBufferChain (Public Method)
+
+DESCRIPTION:
+   Copy constructor
+
+PARAMETERS:
+   source      [ I ] - Source being copied
+
+RETURN VALUE:
+   None
+===========================================================================*/
+cSharedBufferChain::cSharedBufferChain( 
+   const cSharedBufferChain & source )
+   :  cAuxDataSource( source ),
+      mLinks( source.mLinks ),
+      mSize( source.mSize )
+{
+   // Nothing to do
+}
+
+/*===========================================================================
+METHOD:
+   ~cSharedBufferChain (Public Method)
+
+DESCRIPTION:
+   Destructor
+
+RETURN VALUE:
+   None
+===========================================================================*/
+cSharedBufferChain::~cSharedBufferChain()
+{
+   // Nothing to do (the links release their buffers)
+}
+
+/*===========================================================================
+METHOD:
+   Append (Public Method)
+
+DESCRIPTION:
+   Append a buffer to the chain, sharing it
+
+PARAMETERS:
+   buffer      [ I ] - Buffer to append
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cSharedBufferChain::Append( const sProtocolBuffer & buffer )
+{
+   ULONG sz = buffer.GetSize();
+   if (buffer.IsValid() == false || sz > ULONG_MAX - mSize)
+   {
+      return false;
+   }
+
+   try
+   {
+      mLinks.push_back( buffer );
+   }
+   catch (...)
+   {
+      return false;
+   }
+
+   mSize += sz;
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   Append (Public Method)
+
+DESCRIPTION:
+   Append a copy of the given data to the chain, split in links of (at
+   most) the maximum shared buffer size
+
+PARAMETERS:
+   pData       [ I ] - Data to copy
+   dataSz      [ I ] - Size of the above data
+
+RETURN VALUE:
+   bool - false if not all of the data could be appended
+===========================================================================*/
+bool cSharedBufferChain::Append( 
+   const BYTE *               pData,
+   ULONG                      dataSz )
+{
+   if (pData == 0 || dataSz == 0)
+   {
+      return false;
+   }
+
+   ULONG offset = 0;
+   while (offset < dataSz)
+   {
+      ULONG linkSz = std::min( dataSz - offset, MAX_SHARED_BUFFER_SIZE );
+
+      sSharedBuffer * pBuf = 0;
+      try
+      {
+         pBuf = new sSharedBuffer( pData + offset, 
+                                   linkSz, 
+                                   (ULONG)ePROTOCOL_ENUM_BEGIN );
+      }
+      catch (...)
+      {
+         return false;
+      }
+
+      if (pBuf->IsValid() == false)
+      {
+         delete pBuf;
+         return false;
+      }
+
+      if (Append( sProtocolBuffer( pBuf ) ) == false)
+      {
+         return false;
+      }
+
+      offset += linkSz;
+   }
+
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   Clone (Public Method)
+
+DESCRIPTION:
+   Return an allocated copy of this object, sharing the links
+
+RETURN VALUE:
+   cAuxDataSource * - 0 upon failure
+===========================================================================*/
+cAuxDataSource * cSharedBufferChain::Clone() const
+{
+   cAuxDataSource * pCopy = 0;
+
+   try
+   {
+      pCopy = new cSharedBufferChain( *this );
+   }
+   catch (...)
+   {
+      // Simply return 0
+   }
+
+   return pCopy;
+}
+
+/*===========================================================================
+METHOD:
+   GetSize (Public Method)
+
+DESCRIPTION:
+   Return the total size of the auxiliary data
+
+RETURN VALUE:
+   ULONG
+===========================================================================*/
+ULONG cSharedBufferChain::GetSize() const
+{
+   return mSize;
+}
+
+/*===========================================================================
+METHOD:
+   GetData (Public Method)
+
+DESCRIPTION:
+   Return the given range of the auxiliary data, straight from the link
+   holding it
+
+PARAMETERS:
+   offset      [ I ] - Offset of the range
+   len         [ I ] - Length of the range
+
+RETURN VALUE:
+   const BYTE * - 0 if the range is outside of the chain or spans more 
+                  than one link
+===========================================================================*/
+const BYTE * cSharedBufferChain::GetData( 
+   ULONG                      offset,
+   ULONG                      len ) const
+{
+   if (offset > mSize || len > mSize - offset)
+   {
+      return 0;
+   }
+
+   ULONG linkCount = (ULONG)mLinks.size();
+   for (ULONG l = 0; l < linkCount; l++)
+   {
+      ULONG linkSz = mLinks[l].GetSize();
+      if (offset < linkSz)
+      {
+         if (len > linkSz - offset)
+         {
+            return 0;
+         }
+
+         return mLinks[l].GetBuffer() + offset;
+      }
+
+      offset -= linkSz;
+   }
+
+   return 0;
+}
+
+/*===========================================================================
+METHOD:
+   GetTUCount (Public Method)
+
+DESCRIPTION:
+   Return the number of transmission units the chain is sent in, each 
+   link being split in units of (at most) the given size
+
+PARAMETERS:
+   tuSize      [ I ] - Transmission unit size
+
+RETURN VALUE:
+   ULONG - 0 if there is no data to send
+===========================================================================*/
+ULONG cSharedBufferChain::GetTUCount( ULONG tuSize ) const
+{
+   if (tuSize == 0)
+   {
+      return 0;
+   }
+
+   ULONG tus = 0;
+   ULONG linkCount = (ULONG)mLinks.size();
+   for (ULONG l = 0; l < linkCount; l++)
+   {
+      ULONG linkSz = mLinks[l].GetSize();
+      tus += linkSz / tuSize;
+      if ((linkSz % tuSize) != 0)
+      {
+         tus++;
+      }
+   }
+
+   return tus;
+}
+
+/*===========================================================================
+METHOD:
+   GetTU (Public Method)
+
+DESCRIPTION:
+   Return the given transmission unit, straight from the link holding it
+
+PARAMETERS:
+   tu          [ I ] - Transmission unit index
+   tuSize      [ I ] - Transmission unit size
+   tuSz        [ O ] - Size of the transmission unit
+
+RETURN VALUE:
+   const BYTE * - 0 if there is no such transmission unit
+===========================================================================*/
+const BYTE * cSharedBufferChain::GetTU( 
+   ULONG                      tu,
+   ULONG                      tuSize,
+   ULONG &                    tuSz ) const
+{
+   tuSz = 0;
+   if (tuSize == 0)
+   {
+      return 0;
+   }
+
+   ULONG linkCount = (ULONG)mLinks.size();
+   for (ULONG l = 0; l < linkCount; l++)
+   {
+      ULONG linkSz = mLinks[l].GetSize();
+      ULONG linkTUs = linkSz / tuSize;
+      if ((linkSz % tuSize) != 0)
+      {
+         linkTUs++;
+      }
+
+      if (tu < linkTUs)
+      {
+         ULONG offset = tu * tuSize;
+         tuSz = std::min( linkSz - offset, tuSize );
+         return mLinks[l].GetBuffer() + offset;
+      }
+
+      tu -= linkTUs;
+   }
+
+   return 0;
+}
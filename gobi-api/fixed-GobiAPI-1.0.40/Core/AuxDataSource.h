@@ -0,0 +1,237 @@
+/*===========================================================================
+FILE: 
+   AuxDataSource.h
+
+DESCRIPTION:
+   Declaration of cAuxDataSource base class and derivations
+
+PUBLIC CLASSES AND METHODS:
+   cAuxDataSource
+      This abstract base class provides the auxiliary data of a protocol
+      request to the protocol server, one transmission unit at a time
+
+   cMemoryMappedAuxData
+      This class provides auxiliary data straight from a region of a
+      memory mapped file
+
+   cSharedBufferChain
+      This class provides auxiliary data from a chain of shared buffers
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Pragmas
+//---------------------------------------------------------------------------
+#pragma once
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "ProtocolBuffer.h"
+
+#include <vector>
+
+//---------------------------------------------------------------------------
+// Forward Declarations
+//---------------------------------------------------------------------------
+class cMemoryMappedFile;
+
+/*=========================================================================*/
+// Class cAuxDataSource
+//
+//    This abstract base class provides the auxiliary data of a protocol
+//    request to the protocol server, which sends it out after the request
+//    in transmission units (TUs) of the given size (0 for the server's
+//    MTU), handing the given number of TUs to the port at once
+/*=========================================================================*/
+class cAuxDataSource
+{
+   public:
+      // Constructor
+      cAuxDataSource( 
+         ULONG                      tuSize,
+         ULONG                      tusInFlight );
+
+      // Destructor
+      virtual ~cAuxDataSource();
+
+      // Return an allocated copy of this object
+      virtual cAuxDataSource * Clone() const = 0;
+
+      // Return the total size of the auxiliary data
+      virtual ULONG GetSize() const = 0;
+
+      // Return the given range of the auxiliary data (0 upon failure), 
+      // which has to stay valid for as long as this object
+      virtual const BYTE * GetData( 
+         ULONG                      offset,
+         ULONG                      len ) const = 0;
+
+      // Return the number of transmission units of (at most) the given
+      // size the auxiliary data is sent in
+      virtual ULONG GetTUCount( ULONG tuSize ) const;
+
+      // Return the given transmission unit (0 if there is no such unit), 
+      // by default the range of the data at tu * tuSize
+      virtual const BYTE * GetTU( 
+         ULONG                      tu,
+         ULONG                      tuSize,
+         ULONG &                    tuSz ) const;
+
+      // (Inline) Get transmission unit size (0 for the server's MTU)
+      ULONG GetTUSize() const
+      {
+         return mTUSize;
+      };
+
+      // (Inline) Get number of transmission units handed out at once
+      ULONG GetTUsInFlight() const
+      {
+         return mTUsInFlight;
+      };
+
+   protected:
+      /* Transmission unit size */
+      ULONG mTUSize;
+
+      /* Number of transmission units handed to the port at once */
+      ULONG mTUsInFlight;
+};
+
+/*=========================================================================*/
+// Class cMemoryMappedAuxData
+//
+//    This class provides auxiliary data straight from a region of a
+//    memory mapped file (which has to outlive the request)
+/*=========================================================================*/
+class cMemoryMappedAuxData : public cAuxDataSource
+{
+   public:
+      // Constructor
+      cMemoryMappedAuxData( 
+         cMemoryMappedFile &        file,
+         ULONG                      offset,
+         ULONG                      size,
+         ULONG                      tuSize = 0,
+         ULONG                      tusInFlight = 1 );
+
+      // Copy constructor
+      cMemoryMappedAuxData( const cMemoryMappedAuxData & source );
+
+      // Destructor
+      virtual ~cMemoryMappedAuxData();
+
+      // Return a copy of this object
+      virtual cAuxDataSource * Clone() const;
+
+      // Return the total size of the auxiliary data
+      virtual ULONG GetSize() const;
+
+      // Return the given range of the auxiliary data
+      virtual const BYTE * GetData( 
+         ULONG                      offset,
+         ULONG                      len ) const;
+
+   protected:
+      /* Start of the region within the mapping (0 if invalid) */
+      const BYTE * mpData;
+
+      /* Size of the region */
+      ULONG mSize;
+};
+
+/*=========================================================================*/
+// Class cSharedBufferChain
+//
+//    This class provides auxiliary data from a chain of shared buffers,
+//    so payloads larger than a single shared buffer can be sent with one
+//    request and without first being copied into one contiguous buffer.
+//    Transmission units never span two links, and the links handed to 
+//    the port at once are written with a single gathering write
+/*=========================================================================*/
+class cSharedBufferChain : public cAuxDataSource
+{
+   public:
+      // Constructor
+      cSharedBufferChain( 
+         ULONG                      tuSize = 0,
+         ULONG                      tusInFlight = 8 );
+
+      // Copy constructor (the links are shared, not copied)
+      cSharedBufferChain( const cSharedBufferChain & source );
+
+      // Destructor
+      virtual ~cSharedBufferChain();
+
+      // Append a buffer to the chain (shared, not copied)
+      bool Append( const sProtocolBuffer & buffer );
+
+      // Append a copy of the given data, in as many links as needed
+      bool Append( 
+         const BYTE *               pData,
+         ULONG                      dataSz );
+
+      // (Inline) Return the number of links in the chain
+      ULONG GetLinkCount() const
+      {
+         return (ULONG)mLinks.size();
+      };
+
+      // Return a copy of this object
+      virtual cAuxDataSource * Clone() const;
+
+      // Return the total size of the auxiliary data
+      virtual ULONG GetSize() const;
+
+      // Return the given range of the auxiliary data (0 if the range
+      // spans more than one link)
+      virtual const BYTE * GetData( 
+         ULONG                      offset,
+         ULONG                      len ) const;
+
+      // Return the number of transmission units the chain is sent in
+      virtual ULONG GetTUCount( ULONG tuSize ) const;
+
+      // Return the given transmission unit
+      virtual const BYTE * GetTU( 
+         ULONG                      tu,
+         ULONG                      tuSize,
+         ULONG &                    tuSz ) const;
+
+   protected:
+      /* Links of the chain */
+      std::vector <sProtocolBuffer> mLinks;
+
+      /* Total size of the links */
+      ULONG mSize;
+
+   private:
+      // Leave assignment operator unimplemented
+      cSharedBufferChain & operator = ( const cSharedBufferChain & );
+};
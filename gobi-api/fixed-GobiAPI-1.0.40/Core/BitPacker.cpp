@@ -50,10 +50,52 @@ POSSIBILITY OF SUCH DAMAGE.
 // Definitions
 //---------------------------------------------------------------------------
 
+static BYTE MASK[BITS_PER_BYTE + 1] =
+{
+   0x00,
+   0x01,
+   0x03,
+   0x07,
+   0x0F,
+   0x1F,
+   0x3F,
+   0x7F,
+   0xFF
+};
+
 /*=========================================================================*/
 // Free Methods
 /*=========================================================================*/
 
+/*===========================================================================
+METHOD:
+   OrLittleEndian (Internal Method)
+
+DESCRIPTION:
+   OR a value into the (possibly unaligned) buffer as little-endian
+
+PARAMETERS:
+   pData          [ O ] - Data buffer to write to
+   dataIn         [ I ] - Input value to write
+
+RETURN VALUE:
+   None
+===========================================================================*/
+template <class T> 
+static void OrLittleEndian(
+   BYTE *                     pData,
+   T                          dataIn )
+{
+   T tmp;
+   memcpy( (PVOID)&tmp, (LPCVOID)pData, sizeof( T ) );
+   LittleEndianSwap( tmp );
+
+   tmp |= dataIn;
+
+   LittleEndianSwap( tmp );
+   memcpy( (PVOID)pData, (LPCVOID)&tmp, sizeof( T ) );
+}
+
 /*===========================================================================
 METHOD:
    SetUnsignedVal (Public Method)
@@ -110,60 +152,78 @@ DWORD SetUnsignedVal(
    // Advance to first valid byte
    pData += (currentOffset / BITS_PER_BYTE);
 
-   // Since we don't really care about performance for bit packing
-   // (we do not anticipate this being called as frequently as bit
-   // parsing) we always use the generic approach
-
-   // Reduce input to a bit array
-   BYTE bits[MAX_TYPE_BITS];
+   // Number of bits left in current byte
+   ULONG bitsLeft = BITS_PER_BYTE - (currentOffset % BITS_PER_BYTE);
 
-   ULONG bitsExtracted = 0;   
-   while (bitsExtracted < numBits)
+   // Packing whole bytes on a byte boundary?
+   if (bLSB == true && bitsLeft == BITS_PER_BYTE)
    {
-      if (bLSB == true)
+      // Yes, for the common sizes a single (unaligned) load/store suffices
+      bool bStored = true;
+      switch (numBits)
       {
-         BYTE bit = (BYTE)(dataIn & (T)1);
-         bits[bitsExtracted++] = bit;
+         case 8:
+            *pData |= (BYTE)dataIn;
+            break;
+
+         case 16:
+            OrLittleEndian( pData, (USHORT)dataIn );
+            break;
+
+         case 32:
+            OrLittleEndian( pData, (UINT)dataIn );
+            break;
+
+         case 64:
+            OrLittleEndian( pData, (ULONGLONG)dataIn );
+            break;
+
+         default:
+            bStored = false;
+            break;
       }
-      else
+
+      if (bStored == true)
       {
-         BYTE bit = (BYTE)(dataIn & (T)1);
-         bits[numBits - ++bitsExtracted] = bit;
+         currentOffset += numBits;
+         return NO_ERROR;
       }
-
-      dataIn >>= 1;
    }
 
-
-   // Store current offset
-   ULONG offset = currentOffset;
-
-   // Add in each bit - one at a time
-   bitsExtracted = 0;
-   while (bitsExtracted != numBits)
+   // Add in as many bits of the input as fit in each byte
+   ULONGLONG val = (ULONGLONG)dataIn;
+   ULONG bitsPacked = 0;
+   while (bitsPacked < numBits)
    {
-      // How many bits are left in the current byte?
-      ULONG bitsLeft = BITS_PER_BYTE - (offset % BITS_PER_BYTE);
-      
-      // Shift input bit over to desired destination
-      BYTE tmp = bits[bitsExtracted++];
+      ULONG bitCount = numBits - bitsPacked;
+      if (bitCount > bitsLeft)
+      {
+         bitCount = bitsLeft;
+      }
 
+      BYTE tmp = 0;
       if (bLSB == true)
       {
+         // Next (low order) bits of input go to the low order bits
+         tmp = (BYTE)((val >> bitsPacked) & MASK[bitCount]);
          tmp <<= (BITS_PER_BYTE - bitsLeft);
       }
       else
       {
-         tmp <<= bitsLeft - 1;
+         // Next (high order) bits of input go to the high order bits
+         tmp = (BYTE)((val >> (numBits - bitsPacked - bitCount)) 
+             & MASK[bitCount]);
+         tmp <<= (bitsLeft - bitCount);
       }
 
       *pData |= tmp;
 
-      // Advance to next byte in buffer?
-      offset++;
-      if (offset % BITS_PER_BYTE == 0)
+      bitsPacked += bitCount;
+      bitsLeft -= bitCount;
+      if (bitsLeft == 0)
       {
          pData++;
+         bitsLeft = BITS_PER_BYTE;
       }
    }
 
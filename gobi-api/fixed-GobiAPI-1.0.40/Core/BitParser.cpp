@@ -127,14 +127,54 @@ DWORD GetUnsignedVal(
 
    if (bLSB == true)
    {
-      // Extracting native types on byte boundaries?
-      if (numBits == TYPE_BIT_COUNT && bitsLeft == BITS_PER_BYTE)
+      // Extracting whole bytes on a byte boundary?
+      if (bitsLeft == BITS_PER_BYTE && (numBits % BITS_PER_BYTE) == 0)
       {
-         // Yes, a simple cast will suffice
-         dataOut = *((T *)pData);
-
-         currentOffset += numBits;
-         return NO_ERROR;
+         // Yes, for the common sizes a single (unaligned) load will suffice
+         bool bLoaded = true;
+         switch (numBits)
+         {
+            case 8:
+               dataOut = (T)*pData;
+               break;
+
+            case 16:
+            {
+               USHORT tmp;
+               memcpy( (PVOID)&tmp, (LPCVOID)pData, sizeof( tmp ) );
+               LittleEndianSwap( tmp );
+               dataOut = (T)tmp;
+            }
+            break;
+
+            case 32:
+            {
+               UINT tmp;
+               memcpy( (PVOID)&tmp, (LPCVOID)pData, sizeof( tmp ) );
+               LittleEndianSwap( tmp );
+               dataOut = (T)tmp;
+            }
+            break;
+
+            case 64:
+            {
+               ULONGLONG tmp;
+               memcpy( (PVOID)&tmp, (LPCVOID)pData, sizeof( tmp ) );
+               LittleEndianSwap( tmp );
+               dataOut = (T)tmp;
+            }
+            break;
+
+            default:
+               bLoaded = false;
+               break;
+         }
+
+         if (bLoaded == true)
+         {
+            currentOffset += numBits;
+            return NO_ERROR;
+         }
       }
 
       // Extracting some small number of bits?
@@ -152,31 +192,35 @@ DWORD GetUnsignedVal(
       }
    }
 
-   // Not either of the simple cases - extract the relevant bits
-   // and then build the output
-
-   // Extract bits
-   BYTE bits[MAX_TYPE_BITS];
+   // Not either of the simple cases - build the output from as many
+   // bits of each byte as are needed (shift to origin and mask)
+   ULONGLONG val = 0;
    ULONG bitsExtracted = 0;
    
    while (bitsExtracted < numBits)
    {
-      BYTE bit = *pData;
+      ULONG bitCount = numBits - bitsExtracted;
+      if (bitCount > bitsLeft)
+      {
+         bitCount = bitsLeft;
+      }
 
+      ULONGLONG tmp = 0;
       if (bLSB == true)
       {
-         bit <<= (bitsLeft - 1);
-         bit >>= (BITS_PER_BYTE - 1);
-         bits[bitsExtracted++] = bit;
+         // Low order bits of the byte are the next bits of the output
+         tmp = (*pData >> (BITS_PER_BYTE - bitsLeft)) & MASK[bitCount];
+         val |= (tmp << bitsExtracted);
       }
       else
       {
-         bit >>= (bitsLeft - 1);
-         bit &= 0x01;
-         bits[numBits - ++bitsExtracted] = bit;
+         // High order bits of the byte are the next bits of the output
+         tmp = (*pData >> (bitsLeft - bitCount)) & MASK[bitCount];
+         val = (val << bitCount) | tmp;
       }
 
-      bitsLeft--;
+      bitsExtracted += bitCount;
+      bitsLeft -= bitCount;
       if (bitsLeft == 0)
       {
          pData++;
@@ -184,17 +228,7 @@ DWORD GetUnsignedVal(
       }
    }
 
-   // Reassemble to form output value
-   dataOut = 0;
-   T tmp = 0;
-
-   for (ULONG b = 0; b < numBits; b++)
-   {
-      tmp = bits[b];
-      tmp <<= b;
-
-      dataOut |= tmp;
-   }
+   dataOut = (T)val;
 
    currentOffset += numBits;
    return NO_ERROR;
@@ -80,6 +80,30 @@ void ByteSwap( T & data )
    }
 };
 
+/*===========================================================================
+METHOD:
+   LittleEndianSwap (Inline Public Method)
+
+DESCRIPTION:
+   Changes little-endian values to host byte order, and vice versa
+
+PARAMETERS:
+   data        [ I ] - Data being byte-swapped
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+template <class T>
+void LittleEndianSwap( T & data )
+{
+#if defined( __BYTE_ORDER__ ) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+   ByteSwap( data );
+#else
+   // Host is little-endian, nothing to do
+   (void)data;
+#endif
+};
+
 /*=========================================================================*/
 // Class cBitParser
 //
@@ -175,6 +199,51 @@ class cBitParser
          ULONG                      numBits, 
          ULONGLONG &                dataOut );
 
+      // (Inline) Return 'count' values of 'numBits' each as an array
+      // of T (advances offset)
+      template <class T>
+      DWORD Get(
+         ULONG                      numBits, 
+         ULONG                      count,
+         T *                        pDataOut )
+      {
+         if (pDataOut == 0)
+         {
+            return ERROR_INVALID_PARAMETER;
+         }
+
+         // Native types on byte boundaries can be copied in bulk
+         if ( (mbLSB == true)
+         &&   (numBits == (ULONG)(sizeof( T ) * BITS_PER_BYTE))
+         &&   ((mOffset % BITS_PER_BYTE) == 0) )
+         {
+            if (mOffset > mMaxOffset || count > (mMaxOffset - mOffset) / numBits)
+            {
+               return ERROR_NOT_ENOUGH_MEMORY;
+            }
+
+            memcpy( (PVOID)pDataOut, 
+                    (LPCVOID)&mpData[mOffset / BITS_PER_BYTE], 
+                    (SIZE_T)count * sizeof( T ) );
+
+            for (ULONG i = 0; i < count; i++)
+            {
+               LittleEndianSwap( pDataOut[i] );
+            }
+
+            mOffset += count * numBits;
+            return NO_ERROR;
+         }
+
+         DWORD rc = NO_ERROR;
+         for (ULONG i = 0; i < count && rc == NO_ERROR; i++)
+         {
+            rc = Get( numBits, pDataOut[i] );
+         }
+
+         return rc;
+      };
+
       // Release the data being parsed
       void ReleaseData();
 
@@ -0,0 +1,380 @@
+/*===========================================================================
+FILE:
+   BufferPool.cpp
+
+DESCRIPTION:
+   Implementation of cBufferPool class
+
+PUBLIC CLASSES AND METHODS:
+   cBufferPool
+      Thread safe, size classed pool of data blocks backing sSharedBuffer
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "StdAfx.h"
+#include "BufferPool.h"
+#include "SharedBuffer.h"
+
+#include <pthread.h>
+#include <vector>
+
+//---------------------------------------------------------------------------
+// Definitions
+//---------------------------------------------------------------------------
+
+// Block sizes of each class (typical QMI frame sizes), the last class is
+// large enough for any shared buffer
+const ULONG BUFFER_POOL_SIZES[BUFFER_POOL_CLASSES] = 
+{
+   64,
+   256,
+   1024,
+   MAX_SHARED_BUFFER_SIZE
+};
+
+// Maximum number of free blocks retained in the shared list of each class
+const ULONG BUFFER_POOL_DEPTHS[BUFFER_POOL_CLASSES] = 
+{
+   512,
+   256,
+   128,
+   32
+};
+
+// Maximum number of free blocks cached per thread in each class
+const ULONG BUFFER_POOL_THREAD_DEPTH = 8;
+
+// Per-thread cache of free blocks
+struct sBufferPoolThreadCache
+{
+   public:
+      /* Cached blocks */
+      PBYTE mBlocks[BUFFER_POOL_CLASSES][BUFFER_POOL_THREAD_DEPTH];
+
+      /* Number of cached blocks */
+      ULONG mCount[BUFFER_POOL_CLASSES];
+};
+
+// Shared free list of one block size class
+struct sBufferPoolClass
+{
+   public:
+      // Constructor
+      sBufferPoolClass()
+      {
+         pthread_mutex_init( &mMutex, NULL );
+         memset( (PVOID)&mStats, 0, sizeof( mStats ) );
+      };
+
+      /* Free blocks */
+      std::vector <PBYTE> mFree;
+
+      /* Mutex protecting mFree */
+      pthread_mutex_t mMutex;
+
+      /* Usage counters (updated atomically) */
+      sBufferPoolStats mStats;
+};
+
+// The shared free lists
+static sBufferPoolClass gPoolClasses[BUFFER_POOL_CLASSES];
+
+// The calling thread's cache
+static __thread sBufferPoolThreadCache * gpThreadCache = 0;
+
+// Key used to flush a thread's cache when the thread exits
+static pthread_key_t gThreadCacheKey;
+static pthread_once_t gThreadCacheOnce = PTHREAD_ONCE_INIT;
+
+/*=========================================================================*/
+// Free Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   ReleaseToClass (Free Method)
+
+DESCRIPTION:
+   Return a block to the shared free list of its class (or to the heap
+   if that list is full)
+
+PARAMETERS:
+   pBlock      [ I ] - Block being freed
+   poolClass   [ I ] - Class of the block
+
+RETURN VALUE:
+   None
+===========================================================================*/
+static void ReleaseToClass( 
+   PBYTE                      pBlock,
+   ULONG                      poolClass )
+{
+   sBufferPoolClass & pc = gPoolClasses[poolClass];
+
+   pthread_mutex_lock( &pc.mMutex );
+   if (pc.mFree.size() < BUFFER_POOL_DEPTHS[poolClass])
+   {
+      pc.mFree.push_back( pBlock );
+      pBlock = 0;
+   }
+   pthread_mutex_unlock( &pc.mMutex );
+
+   if (pBlock != 0)
+   {
+      __sync_fetch_and_add( &pc.mStats.mOverflows, 1 );
+      delete [] pBlock;
+   }
+}
+
+/*===========================================================================
+METHOD:
+   FlushThreadCache (Free Method)
+
+DESCRIPTION:
+   Thread exit handler, return all blocks cached by the thread to the
+   shared free lists
+
+PARAMETERS:
+   pArg        [ I ] - The thread's cache
+
+RETURN VALUE:
+   None
+===========================================================================*/
+static void FlushThreadCache( PVOID pArg )
+{
+   sBufferPoolThreadCache * pCache = (sBufferPoolThreadCache *)pArg;
+   if (pCache == 0)
+   {
+      return;
+   }
+
+   for (ULONG c = 0; c < BUFFER_POOL_CLASSES; c++)
+   {
+      for (ULONG b = 0; b < pCache->mCount[c]; b++)
+      {
+         ReleaseToClass( pCache->mBlocks[c][b], c );
+      }
+   }
+
+   delete pCache;
+}
+
+/*===========================================================================
+METHOD:
+   CreateThreadCacheKey (Free Method)
+
+DESCRIPTION:
+   Create the thread cache key (once per process)
+
+RETURN VALUE:
+   None
+===========================================================================*/
+static void CreateThreadCacheKey()
+{
+   pthread_key_create( &gThreadCacheKey, FlushThreadCache );
+}
+
+/*===========================================================================
+METHOD:
+   GetThreadCache (Free Method)
+
+DESCRIPTION:
+   Return the calling thread's cache, creating it as needed
+
+RETURN VALUE:
+   sBufferPoolThreadCache * (0 upon error)
+===========================================================================*/
+static sBufferPoolThreadCache * GetThreadCache()
+{
+   if (gpThreadCache != 0)
+   {
+      return gpThreadCache;
+   }
+
+   if (pthread_once( &gThreadCacheOnce, CreateThreadCacheKey ) != 0)
+   {
+      return 0;
+   }
+
+   sBufferPoolThreadCache * pCache = new sBufferPoolThreadCache;
+   memset( (PVOID)pCache, 0, sizeof( sBufferPoolThreadCache ) );
+
+   if (pthread_setspecific( gThreadCacheKey, pCache ) != 0)
+   {
+      delete pCache;
+      return 0;
+   }
+
+   gpThreadCache = pCache;
+   return pCache;
+}
+
+/*=========================================================================*/
+// cBufferPool Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   Allocate (Static Public Method)
+
+DESCRIPTION:
+   Allocate a block of at least the given size, first from the calling
+   thread's cache, then from the shared free list and lastly the heap
+
+PARAMETERS:
+   sz          [ I ] - Required size
+   poolClass   [ O ] - Class of the block (pass back to Free())
+
+RETURN VALUE:
+   PBYTE - The block (0 upon error)
+===========================================================================*/
+PBYTE cBufferPool::Allocate( 
+   ULONG                      sz,
+   ULONG &                    poolClass )
+{
+   poolClass = INVALID_BUFFER_POOL_CLASS;
+
+   ULONG c = 0;
+   while (c < BUFFER_POOL_CLASSES && BUFFER_POOL_SIZES[c] < sz)
+   {
+      c++;
+   }
+
+   if (c == BUFFER_POOL_CLASSES)
+   {
+      // Too large to be pooled
+      return 0;
+   }
+
+   sBufferPoolClass & pc = gPoolClasses[c];
+   PBYTE pBlock = 0;
+
+   sBufferPoolThreadCache * pCache = GetThreadCache();
+   if (pCache != 0 && pCache->mCount[c] > 0)
+   {
+      pBlock = pCache->mBlocks[c][--pCache->mCount[c]];
+   }
+   else
+   {
+      pthread_mutex_lock( &pc.mMutex );
+      if (pc.mFree.empty() == false)
+      {
+         pBlock = pc.mFree.back();
+         pc.mFree.pop_back();
+      }
+      pthread_mutex_unlock( &pc.mMutex );
+   }
+
+   if (pBlock != 0)
+   {
+      __sync_fetch_and_add( &pc.mStats.mHits, 1 );
+   }
+   else
+   {
+      __sync_fetch_and_add( &pc.mStats.mMisses, 1 );
+
+      pBlock = new BYTE[BUFFER_POOL_SIZES[c]];
+      if (pBlock == 0)
+      {
+         return 0;
+      }
+   }
+
+   poolClass = c;
+   return pBlock;
+}
+
+/*===========================================================================
+METHOD:
+   Free (Static Public Method)
+
+DESCRIPTION:
+   Return a block to the pool
+
+PARAMETERS:
+   pBlock      [ I ] - Block being freed
+   poolClass   [ I ] - Class of the block (as returned by Allocate())
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cBufferPool::Free( 
+   PBYTE                      pBlock,
+   ULONG                      poolClass )
+{
+   if (pBlock == 0 || poolClass >= BUFFER_POOL_CLASSES)
+   {
+      return;
+   }
+
+   sBufferPoolThreadCache * pCache = GetThreadCache();
+   if (pCache != 0 && pCache->mCount[poolClass] < BUFFER_POOL_THREAD_DEPTH)
+   {
+      pCache->mBlocks[poolClass][pCache->mCount[poolClass]++] = pBlock;
+      return;
+   }
+
+   ReleaseToClass( pBlock, poolClass );
+}
+
+/*===========================================================================
+METHOD:
+   GetStats (Static Public Method)
+
+DESCRIPTION:
+   Return the usage counters for the given block size class
+
+PARAMETERS:
+   poolClass   [ I ] - Block size class (0 to BUFFER_POOL_CLASSES - 1)
+   stats       [ O ] - Usage counters
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cBufferPool::GetStats( 
+   ULONG                      poolClass,
+   sBufferPoolStats &         stats )
+{
+   if (poolClass >= BUFFER_POOL_CLASSES)
+   {
+      return false;
+   }
+
+   sBufferPoolClass & pc = gPoolClasses[poolClass];
+
+   stats.mBlockSize = BUFFER_POOL_SIZES[poolClass];
+   stats.mHits = __sync_fetch_and_add( &pc.mStats.mHits, 0 );
+   stats.mMisses = __sync_fetch_and_add( &pc.mStats.mMisses, 0 );
+   stats.mOverflows = __sync_fetch_and_add( &pc.mStats.mOverflows, 0 );
+
+   return true;
+}
@@ -0,0 +1,105 @@
+/*===========================================================================
+FILE:
+   BufferPool.h
+
+DESCRIPTION:
+   Declaration of cBufferPool class
+
+PUBLIC CLASSES AND METHODS:
+   cBufferPool
+      Thread safe, size classed pool of data blocks backing sSharedBuffer
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Pragmas
+//---------------------------------------------------------------------------
+#pragma once
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "StdAfx.h"
+
+//---------------------------------------------------------------------------
+// Definitions
+//---------------------------------------------------------------------------
+
+// Number of block size classes in the pool
+const ULONG BUFFER_POOL_CLASSES = 4;
+
+// Pool class of a block that was not allocated from the pool
+const ULONG INVALID_BUFFER_POOL_CLASS = ULONG_MAX;
+
+/*=========================================================================*/
+// Struct sBufferPoolStats
+//
+//    Usage counters for one block size class
+/*=========================================================================*/
+struct sBufferPoolStats
+{
+   public:
+      /* Size of the blocks in this class */
+      ULONG mBlockSize;
+
+      /* Allocations served by a previously freed block */
+      ULONGLONG mHits;
+
+      /* Allocations that required a new heap block */
+      ULONGLONG mMisses;
+
+      /* Frees that returned the block to the heap (pool was full) */
+      ULONGLONG mOverflows;
+};
+
+/*=========================================================================*/
+// Class cBufferPool
+//
+//    Size classed pool of data blocks, freed blocks are kept in a small 
+//    per-thread cache first and then in a shared (mutex protected) free
+//    list per class so the steady state Rx/Tx path never reaches the heap
+/*=========================================================================*/
+class cBufferPool
+{
+   public:
+      // Allocate a block of at least the given size
+      static PBYTE Allocate( 
+         ULONG                      sz,
+         ULONG &                    poolClass );
+
+      // Return a block to the pool
+      static void Free( 
+         PBYTE                      pBlock,
+         ULONG                      poolClass );
+
+      // Return the usage counters for the given block size class
+      static bool GetStats( 
+         ULONG                      poolClass,
+         sBufferPoolStats &         stats );
+};
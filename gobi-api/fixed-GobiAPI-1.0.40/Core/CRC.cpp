@@ -9,6 +9,7 @@ PUBLIC CLASSES AND METHODS:
    SetCRC()
    CheckCRC()
    CalculateCRC()
+   CRCUpdate()
 
 Copyright (c) 2011, Code Aurora Forum. All rights reserved.
 
@@ -44,6 +45,23 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "StdAfx.h"
 #include "CRC.h"
 
+#include <pthread.h>
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+   #include <cpuid.h>
+   #include <emmintrin.h>
+   #include <wmmintrin.h>
+   #define CRC_CLMUL_X86
+#elif defined( __aarch64__ )
+   #include <sys/auxv.h>
+   #include <asm/hwcap.h>
+   #pragma GCC push_options
+   #pragma GCC target ("+crypto")
+   #include <arm_neon.h>
+   #pragma GCC pop_options
+   #define CRC_CLMUL_ARM
+#endif
+
 //---------------------------------------------------------------------------
 // Definitions
 //---------------------------------------------------------------------------
@@ -85,6 +103,395 @@ static USHORT CRCTable[CRC_TABLE_SIZE] =
    0x7bc7, 0x6a4e, 0x58d5, 0x495c, 0x3de3, 0x2c6a, 0x1ef1, 0x0f78
 };
 
+// Number of slicing tables (bytes processed per iteration)
+const ULONG CRC_SLICES = 8;
+
+// Minimum length for which carry-less multiply folding is used
+const ULONG CRC_FOLD_MIN_LEN = 128;
+
+// Signature of a CRC update engine
+typedef USHORT (* tCRCUpdateFn)( USHORT, const BYTE *, ULONG );
+
+// Slicing tables, CRCSliceTable[n][b] is the CRC of byte b followed
+// by n zero bytes (CRCSliceTable[0] is CRCTable)
+static USHORT CRCSliceTable[CRC_SLICES][CRC_TABLE_SIZE];
+
+// Folding constants (bit reflected x^n mod P), by 512 and 128 bits
+static ULONGLONG CRCFoldK512[2];
+static ULONGLONG CRCFoldK128[2];
+
+// Selected CRC update engine
+static tCRCUpdateFn gpCRCUpdate = 0;
+
+// One time engine initialization
+static pthread_once_t gCRCOnce = PTHREAD_ONCE_INIT;
+
+/*=========================================================================*/
+// Internal Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   CRCUpdateSliced (Internal Method)
+
+DESCRIPTION:
+   Update a running CRC state, processing eight bytes per iteration
+   using the slicing tables
+  
+PARAMETERS:
+   state       [ I ] - Running CRC state
+   pBuf        [ I ] - The data buffer
+   len         [ I ] - The length of the above buffer
+
+RETURN VALUE:
+   USHORT: The updated CRC state
+===========================================================================*/
+static USHORT CRCUpdateSliced(
+   USHORT                     state,
+   const BYTE *               pBuf, 
+   ULONG                      len )
+{  
+   while (len >= CRC_SLICES)
+   {
+      USHORT x = state ^ (USHORT)(pBuf[0] | (pBuf[1] << 8));
+      state = CRCSliceTable[7][x & 0x00ff]
+            ^ CRCSliceTable[6][x >> 8]
+            ^ CRCSliceTable[5][pBuf[2]]
+            ^ CRCSliceTable[4][pBuf[3]]
+            ^ CRCSliceTable[3][pBuf[4]]
+            ^ CRCSliceTable[2][pBuf[5]]
+            ^ CRCSliceTable[1][pBuf[6]]
+            ^ CRCSliceTable[0][pBuf[7]];
+
+      pBuf += CRC_SLICES;
+      len -= CRC_SLICES;
+   }
+
+   for (; len > 0; len--, pBuf++) 
+   {
+      state = CRCTable[(state ^ *pBuf) & 0x00ff] ^ (state >> 8);
+   }
+
+   return state;
+}
+
+/*===========================================================================
+METHOD:
+   GetFoldConstant (Internal Method)
+
+DESCRIPTION:
+   Compute x^n mod P, bit reflected into the top 16 bits of a 64-bit
+   value (the form a carry-less multiply of reflected data requires)
+  
+PARAMETERS:
+   n           [ I ] - Power of x
+
+RETURN VALUE:
+   ULONGLONG
+===========================================================================*/
+static ULONGLONG GetFoldConstant( ULONG n )
+{
+   // Unreflected polynomial (x^16 + x^12 + x^5 + 1) sans x^16 term
+   const ULONG POLY = 0x1021;
+
+   // x^n mod P, starting with x^0
+   ULONG rem = 1;
+   for (ULONG i = 0; i < n; i++)
+   {
+      rem <<= 1;
+      if ((rem & 0x10000) != 0)
+      {
+         rem = (rem ^ POLY) & 0xFFFF;
+      }
+   }
+
+   // Coefficient of x^i goes to bit 63 - i
+   ULONGLONG k = 0;
+   for (ULONG i = 0; i < 16; i++)
+   {
+      if ((rem & (1 << i)) != 0)
+      {
+         k |= (ULONGLONG)1 << (63 - i);
+      }
+   }
+
+   return k;
+}
+
+#if defined( CRC_CLMUL_X86 )
+
+/*===========================================================================
+METHOD:
+   CRCFold128 (Internal Method)
+
+DESCRIPTION:
+   Fold a 128-bit remainder forward over the given distance
+  
+PARAMETERS:
+   x           [ I ] - Remainder
+   k           [ I ] - Folding constants for the distance
+
+RETURN VALUE:
+   __m128i
+===========================================================================*/
+__attribute__ ((target ("sse2,pclmul")))
+static inline __m128i CRCFold128( __m128i x, __m128i k )
+{
+   return _mm_xor_si128( _mm_clmulepi64_si128( x, k, 0x00 ),
+                         _mm_clmulepi64_si128( x, k, 0x11 ) );
+}
+
+/*===========================================================================
+METHOD:
+   CRCUpdateCLMUL (Internal Method)
+
+DESCRIPTION:
+   Update a running CRC state by folding the data with carry-less 
+   multiplies (PCLMULQDQ), four 128-bit lanes at a time
+  
+PARAMETERS:
+   state       [ I ] - Running CRC state
+   pBuf        [ I ] - The data buffer
+   len         [ I ] - The length of the above buffer
+
+RETURN VALUE:
+   USHORT: The updated CRC state
+===========================================================================*/
+__attribute__ ((target ("sse2,pclmul")))
+static USHORT CRCUpdateCLMUL(
+   USHORT                     state,
+   const BYTE *               pBuf, 
+   ULONG                      len )
+{  
+   if (len < CRC_FOLD_MIN_LEN)
+   {
+      return CRCUpdateSliced( state, pBuf, len );
+   }
+
+   const __m128i k512 = _mm_set_epi64x( (LONGLONG)CRCFoldK512[1],
+                                        (LONGLONG)CRCFoldK512[0] );
+
+   const __m128i k128 = _mm_set_epi64x( (LONGLONG)CRCFoldK128[1],
+                                        (LONGLONG)CRCFoldK128[0] );
+
+   const __m128i * pIn = (const __m128i *)pBuf;
+
+   // The running state is XORed into the first two bytes
+   __m128i x0 = _mm_xor_si128( _mm_loadu_si128( pIn ), 
+                               _mm_cvtsi32_si128( state ) );
+   __m128i x1 = _mm_loadu_si128( pIn + 1 );
+   __m128i x2 = _mm_loadu_si128( pIn + 2 );
+   __m128i x3 = _mm_loadu_si128( pIn + 3 );
+
+   pIn += 4;
+   len -= 64;
+
+   // Fold four lanes forward by 512 bits
+   while (len >= 64)
+   {
+      x0 = _mm_xor_si128( CRCFold128( x0, k512 ), _mm_loadu_si128( pIn ) );
+      x1 = _mm_xor_si128( CRCFold128( x1, k512 ), _mm_loadu_si128( pIn + 1 ) );
+      x2 = _mm_xor_si128( CRCFold128( x2, k512 ), _mm_loadu_si128( pIn + 2 ) );
+      x3 = _mm_xor_si128( CRCFold128( x3, k512 ), _mm_loadu_si128( pIn + 3 ) );
+
+      pIn += 4;
+      len -= 64;
+   }
+
+   // Combine the lanes
+   x1 = _mm_xor_si128( CRCFold128( x0, k128 ), x1 );
+   x2 = _mm_xor_si128( CRCFold128( x1, k128 ), x2 );
+   x3 = _mm_xor_si128( CRCFold128( x2, k128 ), x3 );
+
+   // Fold forward by 128 bits
+   while (len >= 16)
+   {
+      x3 = _mm_xor_si128( CRCFold128( x3, k128 ), _mm_loadu_si128( pIn ) );
+
+      pIn++;
+      len -= 16;
+   }
+
+   // The remainder has the same CRC as the data it replaces
+   BYTE rem[16];
+   _mm_storeu_si128( (__m128i *)&rem[0], x3 );
+
+   state = CRCUpdateSliced( 0, &rem[0], 16 );
+   return CRCUpdateSliced( state, (const BYTE *)pIn, len );
+}
+
+#elif defined( CRC_CLMUL_ARM )
+
+#pragma GCC push_options
+#pragma GCC target ("+crypto")
+
+/*===========================================================================
+METHOD:
+   CRCFold128 (Internal Method)
+
+DESCRIPTION:
+   Fold a 128-bit remainder forward over the given distance
+  
+PARAMETERS:
+   x           [ I ] - Remainder
+   k           [ I ] - Folding constants for the distance
+
+RETURN VALUE:
+   uint64x2_t
+===========================================================================*/
+static inline uint64x2_t CRCFold128( uint64x2_t x, uint64x2_t k )
+{
+   poly128_t lo = vmull_p64( (poly64_t)vgetq_lane_u64( x, 0 ), 
+                             (poly64_t)vgetq_lane_u64( k, 0 ) );
+
+   poly128_t hi = vmull_p64( (poly64_t)vgetq_lane_u64( x, 1 ), 
+                             (poly64_t)vgetq_lane_u64( k, 1 ) );
+
+   return veorq_u64( vreinterpretq_u64_p128( lo ), 
+                     vreinterpretq_u64_p128( hi ) );
+}
+
+/*===========================================================================
+METHOD:
+   CRCUpdateCLMUL (Internal Method)
+
+DESCRIPTION:
+   Update a running CRC state by folding the data with carry-less 
+   multiplies (PMULL), four 128-bit lanes at a time
+  
+PARAMETERS:
+   state       [ I ] - Running CRC state
+   pBuf        [ I ] - The data buffer
+   len         [ I ] - The length of the above buffer
+
+RETURN VALUE:
+   USHORT: The updated CRC state
+===========================================================================*/
+static USHORT CRCUpdateCLMUL(
+   USHORT                     state,
+   const BYTE *               pBuf, 
+   ULONG                      len )
+{  
+   if (len < CRC_FOLD_MIN_LEN)
+   {
+      return CRCUpdateSliced( state, pBuf, len );
+   }
+
+   const uint64x2_t k512 = vcombine_u64( vcreate_u64( CRCFoldK512[0] ), 
+                                         vcreate_u64( CRCFoldK512[1] ) );
+
+   const uint64x2_t k128 = vcombine_u64( vcreate_u64( CRCFoldK128[0] ), 
+                                         vcreate_u64( CRCFoldK128[1] ) );
+
+   // The running state is XORed into the first two bytes
+   uint64x2_t s = vcombine_u64( vcreate_u64( state ), vcreate_u64( 0 ) );
+
+   uint64x2_t x0 = veorq_u64( vreinterpretq_u64_u8( vld1q_u8( pBuf ) ), s );
+   uint64x2_t x1 = vreinterpretq_u64_u8( vld1q_u8( pBuf + 16 ) );
+   uint64x2_t x2 = vreinterpretq_u64_u8( vld1q_u8( pBuf + 32 ) );
+   uint64x2_t x3 = vreinterpretq_u64_u8( vld1q_u8( pBuf + 48 ) );
+
+   pBuf += 64;
+   len -= 64;
+
+   // Fold four lanes forward by 512 bits
+   while (len >= 64)
+   {
+      x0 = veorq_u64( CRCFold128( x0, k512 ), 
+                      vreinterpretq_u64_u8( vld1q_u8( pBuf ) ) );
+      x1 = veorq_u64( CRCFold128( x1, k512 ), 
+                      vreinterpretq_u64_u8( vld1q_u8( pBuf + 16 ) ) );
+      x2 = veorq_u64( CRCFold128( x2, k512 ), 
+                      vreinterpretq_u64_u8( vld1q_u8( pBuf + 32 ) ) );
+      x3 = veorq_u64( CRCFold128( x3, k512 ), 
+                      vreinterpretq_u64_u8( vld1q_u8( pBuf + 48 ) ) );
+
+      pBuf += 64;
+      len -= 64;
+   }
+
+   // Combine the lanes
+   x1 = veorq_u64( CRCFold128( x0, k128 ), x1 );
+   x2 = veorq_u64( CRCFold128( x1, k128 ), x2 );
+   x3 = veorq_u64( CRCFold128( x2, k128 ), x3 );
+
+   // Fold forward by 128 bits
+   while (len >= 16)
+   {
+      x3 = veorq_u64( CRCFold128( x3, k128 ), 
+                      vreinterpretq_u64_u8( vld1q_u8( pBuf ) ) );
+
+      pBuf += 16;
+      len -= 16;
+   }
+
+   // The remainder has the same CRC as the data it replaces
+   BYTE rem[16];
+   vst1q_u8( &rem[0], vreinterpretq_u8_u64( x3 ) );
+
+   state = CRCUpdateSliced( 0, &rem[0], 16 );
+   return CRCUpdateSliced( state, pBuf, len );
+}
+
+#pragma GCC pop_options
+
+#endif
+
+/*===========================================================================
+METHOD:
+   InitCRC (Internal Method)
+
+DESCRIPTION:
+   Build the slicing tables and folding constants, and select the
+   CRC update engine for this CPU
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+static void InitCRC()
+{
+   for (ULONG b = 0; b < CRC_TABLE_SIZE; b++)
+   {
+      CRCSliceTable[0][b] = CRCTable[b];
+   }
+
+   for (ULONG n = 1; n < CRC_SLICES; n++)
+   {
+      for (ULONG b = 0; b < CRC_TABLE_SIZE; b++)
+      {
+         USHORT prev = CRCSliceTable[n - 1][b];
+         CRCSliceTable[n][b] = CRCTable[prev & 0x00ff] ^ (prev >> 8);
+      }
+   }
+
+   // Folding a 64-bit half over d bits multiplies by x^(d + 64) (low
+   // half) and x^d (high half), less one for the reflected product
+   CRCFoldK512[0] = GetFoldConstant( 512 + 64 - 1 );
+   CRCFoldK512[1] = GetFoldConstant( 512 - 1 );
+   CRCFoldK128[0] = GetFoldConstant( 128 + 64 - 1 );
+   CRCFoldK128[1] = GetFoldConstant( 128 - 1 );
+
+   gpCRCUpdate = CRCUpdateSliced;
+
+#if defined( CRC_CLMUL_X86 )
+   UINT eax = 0;
+   UINT ebx = 0;
+   UINT ecx = 0;
+   UINT edx = 0;
+   if ( (__get_cpuid( 1, &eax, &ebx, &ecx, &edx ) != 0)
+   &&   ((ecx & bit_PCLMUL) != 0)
+   &&   ((edx & bit_SSE2) != 0) )
+   {
+      gpCRCUpdate = CRCUpdateCLMUL;
+   }
+#elif defined( CRC_CLMUL_ARM )
+   if ((getauxval( AT_HWCAP ) & HWCAP_PMULL) != 0)
+   {
+      gpCRCUpdate = CRCUpdateCLMUL;
+   }
+#endif
+}
+
 /*=========================================================================*/
 // Free Methods
 /*=========================================================================*/
@@ -170,11 +577,43 @@ USHORT CalculateCRC(
    // There must be a buffer
    ASSERT( pBuf != 0 );
  
-   USHORT CRC;
-   for (CRC = CRC_16_L_SEED; bitLen >= 8; bitLen -= 8, pBuf++) 
+   USHORT CRC = CRCUpdate( CRC_16_L_SEED, pBuf, bitLen / 8 );
+   return ~CRC;
+}
+
+/*===========================================================================
+METHOD:
+   CRCUpdate (Free Method)
+
+DESCRIPTION:
+   Update a running 16-bit CRC state with the given data, allowing a CRC
+   to be computed incrementally over data that is not contiguous, i.e.:
+
+      state = CRCUpdate( CRC_16_L_SEED, pBuf1, len1 );
+      state = CRCUpdate( state, pBuf2, len2 );
+      CRC = ~state;
+
+   is equivalent to CalculateCRC() over the concatenated buffers
+  
+PARAMETERS:
+   state       [ I ] - Running CRC state
+   pBuf        [ I ] - The data buffer
+   len         [ I ] - The length of the above buffer (in bytes)
+
+RETURN VALUE:
+   USHORT: The updated CRC state
+===========================================================================*/
+USHORT CRCUpdate(
+   USHORT                     state,
+   const BYTE *               pBuf, 
+   ULONG                      len )
+{  
+   pthread_once( &gCRCOnce, InitCRC );
+
+   if (pBuf == 0 || len == 0)
    {
-      CRC = CRCTable[(CRC ^ *pBuf) & 0x00ff] ^ (CRC >> 8);
+      return state;
    }
 
-   return ~CRC;
+   return gpCRCUpdate( state, pBuf, len );
 }
@@ -9,6 +9,7 @@ PUBLIC CLASSES AND METHODS:
    SetCRC()
    CheckCRC()
    CalculateCRC()
+   CRCUpdate()
 
 Copyright (c) 2011, Code Aurora Forum. All rights reserved.
 
@@ -73,3 +74,10 @@ USHORT CalculateCRC(
    const BYTE *               pBuf, 
    ULONG                      bitLen );
 
+// Update a running CRC state with the given data, the state starts out
+// as CRC_16_L_SEED and the CRC value is the complement of the final state
+USHORT CRCUpdate( 
+   USHORT                     state,
+   const BYTE *               pBuf, 
+   ULONG                      len );
+
@@ -0,0 +1,1234 @@
+/*===========================================================================
+FILE:
+   CodecBench.cpp
+
+DESCRIPTION:
+   Microbenchmarks of the Core codec primitives (CRC, HDLC, bit parsing/
+   packing, QMI buffers and database driven parsing/packing) over a 
+   corpus of QMI messages
+
+PUBLIC CLASSES AND METHODS:
+   main
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "StdAfx.h"
+#include "BitPacker.h"
+#include "BitParser.h"
+#include "CommReplay.h"
+#include "CoreDatabase.h"
+#include "CRC.h"
+#include "DataPacker.h"
+#include "DataParser.h"
+#include "DB2Utilities.h"
+#include "HDLC.h"
+#include "QMIBuffers.h"
+
+#include <new>
+
+//---------------------------------------------------------------------------
+// Definitions
+//---------------------------------------------------------------------------
+
+// Default minimum run time of each benchmark (milliseconds)
+const ULONG BENCH_DEFAULT_TIME = 500;
+
+// Minimum size of the scratch buffer (the largest QMI buffer handled)
+const ULONG BENCH_SCRATCH_SZ = 8192;
+
+// Maximum number of raw field values parsed from one TLV
+const ULONG BENCH_MAX_VALUES = 512;
+
+// A message of the corpus
+struct sBenchMessage
+{
+   /* Name (for listing the corpus) */
+   std::string mName;
+
+   /* Protocol type */
+   eProtocolType mType;
+
+   /* Raw QMI service message */
+   std::vector <BYTE> mData;
+
+   /* HDLC encoded message */
+   std::vector <BYTE> mEncoded;
+
+   /* Message as a (validated) QMI buffer */
+   sQMIServiceBuffer * mpBuffer;
+
+   /* Database keys and payloads of the TLVs */
+   cDB2NavInputs mTLVs;
+};
+
+// A request to be packed
+struct sBenchPacking
+{
+   /* Name (for listing the corpus) */
+   std::string mName;
+
+   /* TLVs of the request */
+   std::vector <sDB2PackingInput> mInput;
+
+   /* Per TLV field values */
+   std::vector < std::list <sUnpackedField> > mFields;
+};
+
+// Benchmark corpus
+struct sBenchCorpus
+{
+   /* Database used by parsing/packing */
+   cCoreDatabase mDB;
+
+   /* Messages */
+   std::vector <sBenchMessage> mMessages;
+
+   /* Requests to pack */
+   std::vector <sBenchPacking> mPackings;
+
+   /* Scratch buffer (large enough for any operation) */
+   std::vector <BYTE> mScratch;
+};
+
+// A benchmark, a pass runs the operation once per corpus entry, returns 
+// the bytes processed and sets the number of operations run
+typedef ULONGLONG (* tBenchPass)( 
+   sBenchCorpus &             corpus,
+   ULONG &                    ops );
+
+struct sBenchCase
+{
+   /* Name */
+   LPCSTR mpName;
+
+   /* Does it need the database? */
+   bool mbDB;
+
+   /* The pass */
+   tBenchPass mpPass;
+};
+
+// Allocations made through operator new (all threads)
+static volatile ULONGLONG gAllocations = 0;
+
+// Results fed here so that the compiler keeps the work
+static volatile ULONG gSink = 0;
+
+/*=========================================================================*/
+// Allocation Counting
+/*=========================================================================*/
+
+void * operator new( size_t sz )
+{
+   __sync_add_and_fetch( &gAllocations, 1 );
+
+   void * pMem = malloc( sz > 0 ? sz : 1 );
+   if (pMem == 0)
+   {
+      throw std::bad_alloc();
+   }
+
+   return pMem;
+}
+
+void * operator new[]( size_t sz )
+{
+   return operator new( sz );
+}
+
+void operator delete( void * pMem ) throw()
+{
+   free( pMem );
+}
+
+void operator delete[]( void * pMem ) throw()
+{
+   free( pMem );
+}
+
+void operator delete( void * pMem, size_t ) throw()
+{
+   free( pMem );
+}
+
+void operator delete[]( void * pMem, size_t ) throw()
+{
+   free( pMem );
+}
+
+/*=========================================================================*/
+// Corpus
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   AddTLV (Free Method)
+
+DESCRIPTION:
+   Append a TLV to a raw QMI message
+
+PARAMETERS:
+   msg         [I/O] - Raw QMI message (header included)
+   type        [ I ] - TLV type
+   pData       [ I ] - TLV value
+   dataLen     [ I ] - Size of above
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void AddTLV(
+   std::vector <BYTE> &       msg,
+   BYTE                       type,
+   const void *               pData,
+   ULONG                      dataLen )
+{
+   msg.push_back( type );
+   msg.push_back( (BYTE)(dataLen & 0xFF) );
+   msg.push_back( (BYTE)(dataLen >> 8) );
+
+   const BYTE * pBytes = (const BYTE *)pData;
+   msg.insert( msg.end(), pBytes, pBytes + dataLen );
+}
+
+/*===========================================================================
+METHOD:
+   AddMessage (Free Method)
+
+DESCRIPTION:
+   Finish a raw QMI message (fix up the header) and add it to the corpus
+
+PARAMETERS:
+   corpus      [I/O] - Corpus
+   pName       [ I ] - Name of message
+   svc         [ I ] - QMI service
+   msgID       [ I ] - QMI message ID
+   bResponse   [ I ] - Response (or indication)?
+   msg         [ I ] - Raw QMI message, header space included
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool AddMessage(
+   sBenchCorpus &             corpus,
+   LPCSTR                     pName,
+   eQMIService                svc,
+   WORD                       msgID,
+   bool                       bResponse,
+   std::vector <BYTE> &       msg )
+{
+   ULONG szHdr = sQMIServiceBuffer::GetHeaderSize();
+   sQMIServiceBuffer::FormatHeader( &msg[0], 
+                                    msgID, 
+                                    bResponse,
+                                    !bResponse,
+                                    (ULONG)msg.size() - szHdr );
+
+   sBenchMessage entry;
+   entry.mName = pName;
+   entry.mType = MapQMIServiceToProtocol( svc, false );
+   entry.mData = msg;
+   entry.mpBuffer = 0;
+   corpus.mMessages.push_back( entry );
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   BuildCorpus (Free Method)
+
+DESCRIPTION:
+   Build the built-in corpus: responses and indications of several 
+   services, from a few bytes with a single TLV to a few hundred bytes
+   with a dozen TLVs, plus a few requests to pack
+
+PARAMETERS:
+   corpus      [I/O] - Corpus
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void BuildCorpus( sBenchCorpus & corpus )
+{
+   ULONG szHdr = sQMIServiceBuffer::GetHeaderSize();
+   const BYTE result[] = { 0x00, 0x00, 0x00, 0x00 };
+
+   // DMS get manufacturer response (2 TLVs, short string)
+   {
+      std::vector <BYTE> msg( szHdr );
+      const char mfr[] = "QUALCOMM INCORPORATED";
+      AddTLV( msg, 0x02, result, sizeof( result ) );
+      AddTLV( msg, 0x01, mfr, sizeof( mfr ) - 1 );
+      AddMessage( corpus, 
+                  "dms-get-manufacturer", 
+                  eQMI_SVC_DMS,
+                  (WORD)eQMI_DMS_GET_MANUFACTURER, 
+                  true,
+                  msg );
+   }
+
+   // DMS get IDs response (4 TLVs, strings)
+   {
+      std::vector <BYTE> msg( szHdr );
+      const char esn[] = "8055A3C1";
+      const char imei[] = "359225030012345";
+      const char meid[] = "A1000009ABCDEF";
+      AddTLV( msg, 0x02, result, sizeof( result ) );
+      AddTLV( msg, 0x10, esn, sizeof( esn ) - 1 );
+      AddTLV( msg, 0x11, imei, sizeof( imei ) - 1 );
+      AddTLV( msg, 0x12, meid, sizeof( meid ) - 1 );
+      AddMessage( corpus, 
+                  "dms-get-ids", 
+                  eQMI_SVC_DMS,
+                  (WORD)eQMI_DMS_GET_IDS, 
+                  true,
+                  msg );
+   }
+
+   // NAS get signal strength response (3 TLVs, arrays)
+   {
+      std::vector <BYTE> msg( szHdr );
+      const BYTE rssi[] = { 0xB5, 0x05 };
+      const BYTE rssiList[] = { 0x03, 0x00, 0xB5, 0x05, 0xB0, 0x04, 0xAE, 0x08 };
+      AddTLV( msg, 0x02, result, sizeof( result ) );
+      AddTLV( msg, 0x01, rssi, sizeof( rssi ) );
+      AddTLV( msg, 0x10, rssiList, sizeof( rssiList ) );
+      AddMessage( corpus, 
+                  "nas-get-rssi", 
+                  eQMI_SVC_NAS,
+                  (WORD)eQMI_NAS_GET_RSSI, 
+                  true,
+                  msg );
+   }
+
+   // NAS serving system indication (5 TLVs, nested structures)
+   {
+      std::vector <BYTE> msg( szHdr );
+      const BYTE ss[] = { 0x01, 0x01, 0x01, 0x02, 0x02, 0x05, 0x08 };
+      const BYTE roam[] = { 0x01 };
+      const BYTE dataCaps[] = { 0x03, 0x05, 0x06, 0x0B };
+      const BYTE plmn[] = { 0x36, 0x01, 0x1A, 0x01, 0x08, 
+                            'O', 'p', 'e', 'r', 'a', 't', 'o', 'r' };
+      const BYTE lac[] = { 0x34, 0x12 };
+      AddTLV( msg, 0x01, ss, sizeof( ss ) );
+      AddTLV( msg, 0x10, roam, sizeof( roam ) );
+      AddTLV( msg, 0x11, dataCaps, sizeof( dataCaps ) );
+      AddTLV( msg, 0x12, plmn, sizeof( plmn ) );
+      AddTLV( msg, 0x1D, lac, sizeof( lac ) );
+      AddMessage( corpus, 
+                  "nas-ss-info-ind", 
+                  eQMI_SVC_NAS,
+                  (WORD)eQMI_NAS_SS_INFO_IND, 
+                  false,
+                  msg );
+   }
+
+   // WDS get statistics response (9 TLVs, 32/64 bit counters)
+   {
+      std::vector <BYTE> msg( szHdr );
+      AddTLV( msg, 0x02, result, sizeof( result ) );
+      for (BYTE t = 0x10; t <= 0x15; t++)
+      {
+         ULONG counter = 0x00012345 * t;
+         AddTLV( msg, t, &counter, sizeof( counter ) );
+      }
+
+      ULONGLONG txBytes = 0x0000000123456789ULL;
+      ULONGLONG rxBytes = 0x0000000987654321ULL;
+      AddTLV( msg, 0x19, &txBytes, sizeof( txBytes ) );
+      AddTLV( msg, 0x1A, &rxBytes, sizeof( rxBytes ) );
+      AddMessage( corpus, 
+                  "wds-get-statistics", 
+                  eQMI_SVC_WDS,
+                  (WORD)eQMI_WDS_GET_STATISTICS, 
+                  true,
+                  msg );
+   }
+
+   // WMS raw read response (2 TLVs, a large payload)
+   {
+      std::vector <BYTE> msg( szHdr );
+      std::vector <BYTE> raw( 4 + 255 );
+      raw[0] = 0x01;
+      raw[1] = 0x06;
+      raw[2] = 0xFF;
+      raw[3] = 0x00;
+      for (ULONG b = 4; b < (ULONG)raw.size(); b++)
+      {
+         raw[b] = (BYTE)(b * 7);
+      }
+
+      AddTLV( msg, 0x02, result, sizeof( result ) );
+      AddTLV( msg, 0x01, &raw[0], (ULONG)raw.size() );
+      AddMessage( corpus, 
+                  "wms-raw-read", 
+                  eQMI_SVC_WMS,
+                  (WORD)eQMI_WMS_RAW_READ, 
+                  true,
+                  msg );
+   }
+
+   // Requests to pack
+   {
+      sBenchPacking packing;
+      packing.mName = "dms-set-user-lock-state";
+
+      WORD msgID = (WORD)eQMI_DMS_SET_USER_LOCK_STATE;
+      sProtocolEntityKey pek( eDB2_ET_QMI_DMS_REQ, msgID, 1 );
+      packing.mInput.push_back( sDB2PackingInput( pek, "1 1234" ) );
+      corpus.mPackings.push_back( packing );
+   }
+
+   {
+      sBenchPacking packing;
+      packing.mName = "wds-start-net";
+
+      WORD msgID = (WORD)eQMI_WDS_START_NET;
+      sProtocolEntityKey apn( eDB2_ET_QMI_WDS_REQ, msgID, 20 );
+      sProtocolEntityKey auth( eDB2_ET_QMI_WDS_REQ, msgID, 22 );
+      sProtocolEntityKey user( eDB2_ET_QMI_WDS_REQ, msgID, 23 );
+      sProtocolEntityKey pass( eDB2_ET_QMI_WDS_REQ, msgID, 24 );
+      sProtocolEntityKey family( eDB2_ET_QMI_WDS_REQ, msgID, 25 );
+
+      packing.mInput.push_back( sDB2PackingInput( apn, "internet" ) );
+      packing.mInput.push_back( sDB2PackingInput( auth, "3" ) );
+      packing.mInput.push_back( sDB2PackingInput( user, "user" ) );
+      packing.mInput.push_back( sDB2PackingInput( pass, "secret" ) );
+      packing.mInput.push_back( sDB2PackingInput( family, "4" ) );
+      corpus.mPackings.push_back( packing );
+   }
+}
+
+/*===========================================================================
+METHOD:
+   LoadCapture (Free Method)
+
+DESCRIPTION:
+   Add the QMI messages of a protocol log capture file to the corpus
+
+PARAMETERS:
+   corpus      [I/O] - Corpus
+   pFileName   [ I ] - Capture file
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool LoadCapture( 
+   sBenchCorpus &             corpus,
+   LPCSTR                     pFileName )
+{
+   cCommReplayCapture capture;
+   if (capture.Load( pFileName ) == false)
+   {
+      return false;
+   }
+
+   const std::vector <sCommReplayRecord> & records = capture.GetRecords();
+   for (ULONG r = 0; r < (ULONG)records.size(); r++)
+   {
+      char name[64];
+      snprintf( name, sizeof( name ), "capture-%lu", (unsigned long)r );
+
+      sBenchMessage entry;
+      entry.mName = name;
+      entry.mType = records[r].mType;
+      entry.mData = records[r].mData;
+      entry.mpBuffer = 0;
+      corpus.mMessages.push_back( entry );
+   }
+
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   PrepareCorpus (Free Method)
+
+DESCRIPTION:
+   Derive the encoded frames, QMI buffers and TLV keys of the messages
+   (dropping those that do not validate) and load the packing values
+
+PARAMETERS:
+   corpus      [I/O] - Corpus
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void PrepareCorpus( sBenchCorpus & corpus )
+{
+   ULONG maxSz = 0;
+
+   std::vector <sBenchMessage> & msgs = corpus.mMessages;
+   for (ULONG m = 0; m < (ULONG)msgs.size(); )
+   {
+      sBenchMessage & msg = msgs[m];
+      ULONG sz = (ULONG)msg.mData.size();
+
+      sSharedBuffer * pShared = new sSharedBuffer( &msg.mData[0], 
+                                                   sz, 
+                                                   (ULONG)msg.mType );
+
+      msg.mpBuffer = new sQMIServiceBuffer( pShared );
+      if (msg.mpBuffer->IsValid() == false)
+      {
+         fprintf( stderr, "Dropping invalid message %s\n", msg.mName.c_str() );
+
+         delete msg.mpBuffer;
+         msgs.erase( msgs.begin() + m );
+         continue;
+      }
+
+      msg.mTLVs = DB2ReduceQMIBuffer( *msg.mpBuffer );
+
+      ULONG encodedSz = HDLCMaxEncodedSize( sz );
+      ULONG encodedLen = 0;
+      msg.mEncoded.resize( encodedSz );
+      HDLCEncode( &msg.mData[0], sz, &msg.mEncoded[0], encodedSz, encodedLen );
+      msg.mEncoded.resize( encodedLen );
+
+      if (encodedSz > maxSz)
+      {
+         maxSz = encodedSz;
+      }
+
+      m++;
+   }
+
+   std::vector <sBenchPacking> & packings = corpus.mPackings;
+   for (ULONG p = 0; p < (ULONG)packings.size(); p++)
+   {
+      sBenchPacking & packing = packings[p];
+      for (ULONG i = 0; i < (ULONG)packing.mInput.size(); i++)
+      {
+         packing.mFields.push_back( 
+            cDataPacker::LoadValues( packing.mInput[i].mValues ) );
+      }
+   }
+
+   corpus.mScratch.resize( maxSz > BENCH_SCRATCH_SZ ? maxSz : BENCH_SCRATCH_SZ );
+}
+
+/*=========================================================================*/
+// Benchmark Passes
+/*=========================================================================*/
+
+ULONGLONG PassCRC(
+   sBenchCorpus &             corpus,
+   ULONG &                    ops )
+{
+   ULONGLONG bytes = 0;
+   ULONG sink = 0;
+
+   std::vector <sBenchMessage> & msgs = corpus.mMessages;
+   for (ULONG m = 0; m < (ULONG)msgs.size(); m++)
+   {
+      ULONG sz = (ULONG)msgs[m].mData.size();
+      sink += CalculateCRC( &msgs[m].mData[0], sz * 8 );
+      bytes += sz;
+   }
+
+   gSink += sink;
+   ops = (ULONG)msgs.size();
+   return bytes;
+}
+
+ULONGLONG PassHDLCEncode(
+   sBenchCorpus &             corpus,
+   ULONG &                    ops )
+{
+   ULONGLONG bytes = 0;
+   ULONG sink = 0;
+
+   std::vector <sBenchMessage> & msgs = corpus.mMessages;
+   for (ULONG m = 0; m < (ULONG)msgs.size(); m++)
+   {
+      ULONG sz = (ULONG)msgs[m].mData.size();
+      ULONG encodedLen = 0;
+      HDLCEncode( &msgs[m].mData[0], 
+                  sz, 
+                  &corpus.mScratch[0], 
+                  (ULONG)corpus.mScratch.size(),
+                  encodedLen );
+
+      sink += encodedLen;
+      bytes += sz;
+   }
+
+   gSink += sink;
+   ops = (ULONG)msgs.size();
+   return bytes;
+}
+
+ULONGLONG PassHDLCEncodeShared(
+   sBenchCorpus &             corpus,
+   ULONG &                    ops )
+{
+   ULONGLONG bytes = 0;
+   ULONG sink = 0;
+
+   std::vector <sBenchMessage> & msgs = corpus.mMessages;
+   for (ULONG m = 0; m < (ULONG)msgs.size(); m++)
+   {
+      sSharedBuffer * pEncoded = HDLCEncode( msgs[m].mpBuffer->GetSharedBuffer() );
+      if (pEncoded != 0)
+      {
+         sink += pEncoded->GetSize();
+         delete pEncoded;
+      }
+
+      bytes += msgs[m].mData.size();
+   }
+
+   gSink += sink;
+   ops = (ULONG)msgs.size();
+   return bytes;
+}
+
+ULONGLONG PassHDLCDecode(
+   sBenchCorpus &             corpus,
+   ULONG &                    ops )
+{
+   ULONGLONG bytes = 0;
+   ULONG sink = 0;
+
+   std::vector <sBenchMessage> & msgs = corpus.mMessages;
+   for (ULONG m = 0; m < (ULONG)msgs.size(); m++)
+   {
+      ULONG decodedLen = 0;
+      HDLCDecode( &msgs[m].mEncoded[0], 
+                  (ULONG)msgs[m].mEncoded.size(), 
+                  &corpus.mScratch[0], 
+                  (ULONG)corpus.mScratch.size(),
+                  decodedLen );
+
+      sink += decodedLen;
+      bytes += msgs[m].mEncoded.size();
+   }
+
+   gSink += sink;
+   ops = (ULONG)msgs.size();
+   return bytes;
+}
+
+ULONGLONG PassBitParserBytes(
+   sBenchCorpus &             corpus,
+   ULONG &                    ops )
+{
+   ULONGLONG bytes = 0;
+   ULONG sink = 0;
+
+   std::vector <sBenchMessage> & msgs = corpus.mMessages;
+   for (ULONG m = 0; m < (ULONG)msgs.size(); m++)
+   {
+      ULONG sz = (ULONG)msgs[m].mData.size();
+      cBitParser bp( &msgs[m].mData[0], sz * 8 );
+      for (ULONG b = 0; b < sz; b++)
+      {
+         UCHAR val;
+         bp.Get( 8, val );
+         sink += val;
+      }
+
+      bytes += sz;
+   }
+
+   gSink += sink;
+   ops = (ULONG)msgs.size();
+   return bytes;
+}
+
+ULONGLONG PassBitParserFields(
+   sBenchCorpus &             corpus,
+   ULONG &                    ops )
+{
+   ULONGLONG bytes = 0;
+   ULONG sink = 0;
+
+   // Odd widths, crossing byte boundaries
+   const ULONG widths[] = { 3, 5, 13, 1, 11, 32, 7, 24 };
+   const ULONG numWidths = sizeof( widths ) / sizeof( widths[0] );
+
+   std::vector <sBenchMessage> & msgs = corpus.mMessages;
+   for (ULONG m = 0; m < (ULONG)msgs.size(); m++)
+   {
+      ULONG sz = (ULONG)msgs[m].mData.size();
+      cBitParser bp( &msgs[m].mData[0], sz * 8 );
+      for (ULONG w = 0; bp.GetNumBitsLeft() >= 32; w++)
+      {
+         ULONG val;
+         bp.Get( widths[w % numWidths], val );
+         sink += val;
+      }
+
+      bytes += sz;
+   }
+
+   gSink += sink;
+   ops = (ULONG)msgs.size();
+   return bytes;
+}
+
+ULONGLONG PassBitPackerBytes(
+   sBenchCorpus &             corpus,
+   ULONG &                    ops )
+{
+   ULONGLONG bytes = 0;
+
+   std::vector <sBenchMessage> & msgs = corpus.mMessages;
+   for (ULONG m = 0; m < (ULONG)msgs.size(); m++)
+   {
+      ULONG sz = (ULONG)msgs[m].mData.size();
+      const BYTE * pData = &msgs[m].mData[0];
+
+      cBitPacker bp( &corpus.mScratch[0], sz * 8 );
+      for (ULONG b = 0; b < sz; b++)
+      {
+         bp.Set( 8, (UCHAR)pData[b] );
+      }
+
+      bytes += sz;
+   }
+
+   gSink += corpus.mScratch[0];
+   ops = (ULONG)msgs.size();
+   return bytes;
+}
+
+ULONGLONG PassBitPackerFields(
+   sBenchCorpus &             corpus,
+   ULONG &                    ops )
+{
+   ULONGLONG bytes = 0;
+
+   const ULONG widths[] = { 3, 5, 13, 1, 11, 32, 7, 24 };
+   const ULONG numWidths = sizeof( widths ) / sizeof( widths[0] );
+
+   std::vector <sBenchMessage> & msgs = corpus.mMessages;
+   for (ULONG m = 0; m < (ULONG)msgs.size(); m++)
+   {
+      ULONG sz = (ULONG)msgs[m].mData.size();
+      cBitPacker bp( &corpus.mScratch[0], sz * 8 );
+      for (ULONG w = 0; bp.GetNumBitsLeft() >= 32; w++)
+      {
+         bp.Set( widths[w % numWidths], (ULONG)(w * 0x9E3779B9) );
+      }
+
+      bytes += sz;
+   }
+
+   gSink += corpus.mScratch[0];
+   ops = (ULONG)msgs.size();
+   return bytes;
+}
+
+ULONGLONG PassQMIBufferBuild(
+   sBenchCorpus &             corpus,
+   ULONG &                    ops )
+{
+   ULONGLONG bytes = 0;
+   ULONG sink = 0;
+
+   std::vector <sBenchMessage> & msgs = corpus.mMessages;
+   for (ULONG m = 0; m < (ULONG)msgs.size(); m++)
+   {
+      ULONG sz = (ULONG)msgs[m].mData.size();
+      sSharedBuffer * pShared = new sSharedBuffer( &msgs[m].mData[0], 
+                                                   sz, 
+                                                   (ULONG)msgs[m].mType );
+
+      sQMIServiceBuffer qmiBuf( pShared );
+      sink += qmiBuf.GetMessageID();
+      bytes += sz;
+   }
+
+   gSink += sink;
+   ops = (ULONG)msgs.size();
+   return bytes;
+}
+
+ULONGLONG PassQMIBufferTLVs(
+   sBenchCorpus &             corpus,
+   ULONG &                    ops )
+{
+   ULONGLONG bytes = 0;
+   ULONG sink = 0;
+
+   std::vector <sBenchMessage> & msgs = corpus.mMessages;
+   for (ULONG m = 0; m < (ULONG)msgs.size(); m++)
+   {
+      const sQMIContents & tlvs = msgs[m].mpBuffer->GetContents();
+
+      ULONG id = tlvs.GetNextID( 0 );
+      for (; id < QMI_MAX_CONTENT_IDS; id = tlvs.GetNextID( id + 1 ))
+      {
+         sink += tlvs.Find( id )->mLength;
+      }
+
+      bytes += msgs[m].mData.size();
+   }
+
+   gSink += sink;
+   ops = (ULONG)msgs.size();
+   return bytes;
+}
+
+ULONGLONG PassReduce(
+   sBenchCorpus &             corpus,
+   ULONG &                    ops )
+{
+   ULONGLONG bytes = 0;
+   ULONG sink = 0;
+
+   std::vector <sBenchMessage> & msgs = corpus.mMessages;
+   for (ULONG m = 0; m < (ULONG)msgs.size(); m++)
+   {
+      cDB2NavInputs tlvs = DB2ReduceQMIBuffer( *msgs[m].mpBuffer );
+      sink += (ULONG)tlvs.size();
+      bytes += msgs[m].mData.size();
+   }
+
+   gSink += sink;
+   ops = (ULONG)msgs.size();
+   return bytes;
+}
+
+ULONGLONG PassParse(
+   sBenchCorpus &             corpus,
+   ULONG &                    ops )
+{
+   ULONGLONG bytes = 0;
+   ULONG sink = 0;
+
+   ops = 0;
+
+   std::vector <sBenchMessage> & msgs = corpus.mMessages;
+   for (ULONG m = 0; m < (ULONG)msgs.size(); m++)
+   {
+      const cDB2NavInputs & tlvs = msgs[m].mTLVs;
+      for (ULONG t = 0; t < (ULONG)tlvs.size(); t++)
+      {
+         const sDB2NavInput & ni = tlvs[t];
+         cDataParser dp( corpus.mDB, 
+                         *msgs[m].mpBuffer, 
+                         ni.mKey, 
+                         ni.mpPayload, 
+                         ni.mPayloadLen );
+
+         dp.Parse( true, true );
+         sink += (ULONG)dp.GetFields().size();
+         bytes += ni.mPayloadLen;
+         ops++;
+      }
+   }
+
+   gSink += sink;
+   return bytes;
+}
+
+ULONGLONG PassParseValues(
+   sBenchCorpus &             corpus,
+   ULONG &                    ops )
+{
+   ULONGLONG bytes = 0;
+   ULONG sink = 0;
+
+   ops = 0;
+
+   static sParsedFieldValue values[BENCH_MAX_VALUES];
+
+   std::vector <sBenchMessage> & msgs = corpus.mMessages;
+   for (ULONG m = 0; m < (ULONG)msgs.size(); m++)
+   {
+      const cDB2NavInputs & tlvs = msgs[m].mTLVs;
+      for (ULONG t = 0; t < (ULONG)tlvs.size(); t++)
+      {
+         const sDB2NavInput & ni = tlvs[t];
+         cDataParser dp( corpus.mDB, 
+                         *msgs[m].mpBuffer, 
+                         ni.mKey, 
+                         ni.mpPayload, 
+                         ni.mPayloadLen );
+
+         ULONG numValues = 0;
+         dp.ParseValues( &values[0], BENCH_MAX_VALUES, numValues );
+         sink += numValues;
+         bytes += ni.mPayloadLen;
+         ops++;
+      }
+   }
+
+   gSink += sink;
+   return bytes;
+}
+
+ULONGLONG PassParseIncremental(
+   sBenchCorpus &             corpus,
+   ULONG &                    ops )
+{
+   ULONGLONG bytes = 0;
+   ULONG sink = 0;
+
+   ops = 0;
+
+   // Feed each payload in small pieces
+   const ULONG PIECE_SZ = 4;
+
+   std::vector <sBenchMessage> & msgs = corpus.mMessages;
+   for (ULONG m = 0; m < (ULONG)msgs.size(); m++)
+   {
+      const cDB2NavInputs & tlvs = msgs[m].mTLVs;
+      for (ULONG t = 0; t < (ULONG)tlvs.size(); t++)
+      {
+         const sDB2NavInput & ni = tlvs[t];
+         cIncrementalDataParser dp( corpus.mDB, 
+                                    *msgs[m].mpBuffer, 
+                                    ni.mKey,
+                                    true,
+                                    true );
+
+         ULONG fed = 0;
+         sParsedField field;
+         eIncrementalParse ip = dp.NextField( field );
+         while (ip == eINCREMENTAL_PARSE_FIELD 
+         ||     ip == eINCREMENTAL_PARSE_NEED_DATA)
+         {
+            if (ip == eINCREMENTAL_PARSE_FIELD)
+            {
+               sink++;
+            }
+            else if (fed < ni.mPayloadLen)
+            {
+               ULONG sz = ni.mPayloadLen - fed;
+               if (sz > PIECE_SZ)
+               {
+                  sz = PIECE_SZ;
+               }
+
+               dp.Feed( ni.mpPayload + fed, sz );
+               fed += sz;
+            }
+            else
+            {
+               dp.Finish();
+            }
+
+            ip = dp.NextField( field );
+         }
+
+         bytes += ni.mPayloadLen;
+         ops++;
+      }
+   }
+
+   gSink += sink;
+   return bytes;
+}
+
+ULONGLONG PassPack(
+   sBenchCorpus &             corpus,
+   ULONG &                    ops )
+{
+   ULONGLONG bytes = 0;
+
+   ops = 0;
+
+   std::vector <sBenchPacking> & packings = corpus.mPackings;
+   for (ULONG p = 0; p < (ULONG)packings.size(); p++)
+   {
+      sBenchPacking & packing = packings[p];
+      for (ULONG i = 0; i < (ULONG)packing.mInput.size(); i++)
+      {
+         cDataPacker dp( corpus.mDB, 
+                         packing.mInput[i].mKey, 
+                         packing.mFields[i],
+                         &corpus.mScratch[0],
+                         (ULONG)corpus.mScratch.size() );
+
+         if (dp.Pack() == true)
+         {
+            ULONG len = 0;
+            dp.GetBuffer( len );
+            bytes += len;
+         }
+
+         ops++;
+      }
+   }
+
+   return bytes;
+}
+
+ULONGLONG PassPackQMI(
+   sBenchCorpus &             corpus,
+   ULONG &                    ops )
+{
+   ULONGLONG bytes = 0;
+
+   std::vector <sBenchPacking> & packings = corpus.mPackings;
+   for (ULONG p = 0; p < (ULONG)packings.size(); p++)
+   {
+      sSharedBuffer * pReq = DB2PackQMIBuffer( corpus.mDB, 
+                                               packings[p].mInput );
+      if (pReq != 0)
+      {
+         bytes += pReq->GetSize();
+         delete pReq;
+      }
+   }
+
+   ops = (ULONG)packings.size();
+   return bytes;
+}
+
+// The benchmarks
+const sBenchCase gBenchCases[] =
+{
+   { "crc",                   false,   PassCRC },
+   { "hdlc-encode",           false,   PassHDLCEncode },
+   { "hdlc-encode-shared",    false,   PassHDLCEncodeShared },
+   { "hdlc-decode",           false,   PassHDLCDecode },
+   { "bitparser-get-bytes",   false,   PassBitParserBytes },
+   { "bitparser-get-fields",  false,   PassBitParserFields },
+   { "bitpacker-set-bytes",   false,   PassBitPackerBytes },
+   { "bitpacker-set-fields",  false,   PassBitPackerFields },
+   { "qmibuffer-build",       false,   PassQMIBufferBuild },
+   { "qmibuffer-tlvs",        false,   PassQMIBufferTLVs },
+   { "db2-reduce",            false,   PassReduce },
+   { "dataparser-parse",      true,    PassParse },
+   { "dataparser-values",     true,    PassParseValues },
+   { "dataparser-feed",       true,    PassParseIncremental },
+   { "datapacker-pack",       true,    PassPack },
+   { "db2-pack-qmi",          true,    PassPackQMI }
+};
+
+/*=========================================================================*/
+// Free Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   GetNanoseconds (Free Method)
+
+DESCRIPTION:
+   Return the monotonic time in nanoseconds
+
+RETURN VALUE:
+   ULONGLONG
+===========================================================================*/
+ULONGLONG GetNanoseconds()
+{
+   timespec ts;
+   clock_gettime( CLOCK_MONOTONIC, &ts );
+   return (ULONGLONG)ts.tv_sec * 1000000000ULL + (ULONGLONG)ts.tv_nsec;
+}
+
+/*===========================================================================
+METHOD:
+   RunBench (Free Method)
+
+DESCRIPTION:
+   Run passes of a benchmark for at least the given time and report 
+   ns/op, bytes/s and allocations/op
+
+PARAMETERS:
+   bench       [ I ] - Benchmark
+   corpus      [I/O] - Corpus
+   minTime     [ I ] - Minimum run time (milliseconds)
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void RunBench( 
+   const sBenchCase &         bench,
+   sBenchCorpus &             corpus,
+   ULONG                      minTime )
+{
+   // Warm up (and discover empty benchmarks)
+   ULONG ops = 0;
+   bench.mpPass( corpus, ops );
+   if (ops == 0)
+   {
+      printf( "%-24s %12s\n", bench.mpName, "(no input)" );
+      return;
+   }
+
+   ULONGLONG totalOps = 0;
+   ULONGLONG totalBytes = 0;
+   ULONGLONG allocs = gAllocations;
+   ULONGLONG start = GetNanoseconds();
+   ULONGLONG end = start + (ULONGLONG)minTime * 1000000ULL;
+   ULONGLONG now = start;
+
+   while (now < end)
+   {
+      totalBytes += bench.mpPass( corpus, ops );
+      totalOps += ops;
+      now = GetNanoseconds();
+   }
+
+   allocs = gAllocations - allocs;
+
+   double elapsed = (double)(now - start);
+   printf( "%-24s %12.1f ns/op %10.1f MB/s %8.2f allocs/op\n",
+           bench.mpName,
+           elapsed / (double)totalOps,
+           (double)totalBytes * 1000.0 / elapsed,
+           (double)allocs / (double)totalOps );
+}
+
+/*===========================================================================
+METHOD:
+   main
+
+DESCRIPTION:
+   Run the codec microbenchmarks over the built-in corpus, extended with
+   the QMI messages of any capture files given
+
+   Usage: CodecBench [-t min time] [-b benchmark] [-d database directory] 
+                     [-l] [capture file ...]
+
+RETURN VALUE:
+   int - 0 upon success
+===========================================================================*/
+int main( int argc, char ** argv )
+{
+   ULONG minTime = BENCH_DEFAULT_TIME;
+   LPCSTR pFilter = 0;
+   LPCSTR pDBPath = 0;
+   bool bList = false;
+
+   int opt;
+   while ((opt = getopt( argc, argv, "t:b:d:l" )) != -1)
+   {
+      switch (opt)
+      {
+         case 't':
+            minTime = strtoul( optarg, 0, 0 );
+            break;
+
+         case 'b':
+            pFilter = optarg;
+            break;
+
+         case 'd':
+            pDBPath = optarg;
+            break;
+
+         case 'l':
+            bList = true;
+            break;
+
+         default:
+            fprintf( stderr, 
+                     "Usage: %s [-t min time] [-b benchmark] "
+                     "[-d database directory] [-l] [capture file ...]\n",
+                     argv[0] );
+            return 1;
+      }
+   }
+
+   sBenchCorpus corpus;
+   BuildCorpus( corpus );
+
+   for (int a = optind; a < argc; a++)
+   {
+      if (LoadCapture( corpus, argv[a] ) == false)
+      {
+         fprintf( stderr, "%s: capture \'%s\' failed to load\n", 
+                  argv[0], 
+                  argv[a] );
+         return 1;
+      }
+   }
+
+   PrepareCorpus( corpus );
+
+   bool bDB = false;
+   if (pDBPath != 0)
+   {
+      bDB = corpus.mDB.Initialize( pDBPath );
+   }
+   else
+   {
+      bDB = corpus.mDB.Initialize();
+   }
+
+   if (bDB == false)
+   {
+      fprintf( stderr, "%s: database failed to load, skipping the "
+                       "database benchmarks\n", 
+               argv[0] );
+   }
+
+   if (bList == true)
+   {
+      for (ULONG m = 0; m < (ULONG)corpus.mMessages.size(); m++)
+      {
+         const sBenchMessage & msg = corpus.mMessages[m];
+         printf( "%-24s %5lu bytes %3lu TLVs\n",
+                 msg.mName.c_str(),
+                 (unsigned long)msg.mData.size(),
+                 (unsigned long)msg.mTLVs.size() );
+      }
+
+      for (ULONG p = 0; p < (ULONG)corpus.mPackings.size(); p++)
+      {
+         const sBenchPacking & packing = corpus.mPackings[p];
+         printf( "%-24s (request) %3lu TLVs\n",
+                 packing.mName.c_str(),
+                 (unsigned long)packing.mInput.size() );
+      }
+   }
+
+   ULONG numCases = sizeof( gBenchCases ) / sizeof( gBenchCases[0] );
+   for (ULONG c = 0; c < numCases; c++)
+   {
+      const sBenchCase & bench = gBenchCases[c];
+      if (pFilter != 0 && strstr( bench.mpName, pFilter ) == 0)
+      {
+         continue;
+      }
+
+      if (bench.mbDB == true && bDB == false)
+      {
+         continue;
+      }
+
+      RunBench( bench, corpus, minTime );
+   }
+
+   for (ULONG m = 0; m < (ULONG)corpus.mMessages.size(); m++)
+   {
+      delete corpus.mMessages[m].mpBuffer;
+   }
+
+   return 0;
+}
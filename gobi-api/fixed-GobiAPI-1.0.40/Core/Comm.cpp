@@ -76,6 +76,13 @@ VOID RxCompletionRoutine( sigval returnSignal )
       return;
    }
 
+   // Every notification is run on a thread of its own
+   const cThreadConfig & config = pComm->mThreadConfig;
+   if (config.GetRole( eTHREAD_ROLE_RX ).IsDefault() == false)
+   {
+      config.Apply( eTHREAD_ROLE_RX );
+   }
+
    cIOCallback * pCallback = pComm->mpRxCallback;
    if (pCallback == 0)
    {
@@ -116,7 +123,12 @@ cComm::cComm()
       mPort( INVALID_HANDLE_VALUE ),
       mpRxCallback( 0 ),
       mbCancelWrite( false ),
-      mReadCanceled()
+      mReadCanceled(),
+      mpReactor( 0 ),
+      mpRxBuf( 0 ),
+      mRxBufSz( 0 ),
+      mpTransport( 0 ),
+      mbTransportConnected( false )
 {
    memset( &mReadIO, 0, sizeof( aiocb) );
 
@@ -176,11 +188,23 @@ bool cComm::Connect( LPCSTR pPort )
       return false;
    }
 
-   if (mPort != INVALID_HANDLE_VALUE)
+   if (IsConnected() == true)
    {
       Disconnect();
    }
 
+   // Forwarding to a transport instead?
+   if (mpTransport != 0)
+   {
+      mbTransportConnected = mpTransport->Connect( pPort );
+      if (mbTransportConnected == true)
+      {
+         mPortName = pPort;
+      }
+
+      return mbTransportConnected;
+   }
+
    // Opening the com port
    mPort = open( pPort, O_RDWR );
    if (mPort == INVALID_HANDLE_VALUE) 
@@ -193,6 +217,14 @@ bool cComm::Connect( LPCSTR pPort )
 
    mReadCanceled.Clear();
  
+   // Hand the port over to the reactor?
+   if (mpReactor != 0 && mpReactor->Register( this ) == false)
+   {
+      close( mPort );
+      mPort = INVALID_HANDLE_VALUE;
+      return false;
+   }
+
    // Save port name
    mPortName = pPort;
 
@@ -218,6 +250,11 @@ int cComm::RunIOCTL(
    UINT     ioctlReq,
    void *   pData )
 {
+   if (mbTransportConnected == true)
+   {
+      return mpTransport->RunIOCTL( ioctlReq, pData );
+   }
+
    if (mPort == INVALID_HANDLE_VALUE)
    {
       TRACE( "Invalid file handle\n" );
@@ -242,8 +279,20 @@ bool cComm::Disconnect()
    // Assume success
    bool bRC = true;
 
+   if (mbTransportConnected == true)
+   {
+      bRC = mpTransport->Disconnect();
+      mbTransportConnected = false;
+   }
+
    if (mPort != INVALID_HANDLE_VALUE)
    {
+      if (mpReactor != 0)
+      {
+         mpReactor->Unregister( this );
+         mpRxCallback = 0;
+      }
+
       int nClose = close( mPort );
       if (nClose == -1)
       {
@@ -333,7 +382,7 @@ RETURN VALUE:
 ===========================================================================*/
 bool cComm::CancelIO()
 {
-   if (mPort == INVALID_HANDLE_VALUE)
+   if (IsConnected() == false)
    {
       return false;
    }
@@ -356,11 +405,22 @@ RETURN VALUE:
 ===========================================================================*/
 bool cComm::CancelRx()
 {
+   if (mbTransportConnected == true)
+   {
+      return mpTransport->CancelRx();
+   }
+
    if (mPort == INVALID_HANDLE_VALUE || mpRxCallback == 0)
    {
       return false;
    }
 
+   if (mpReactor != 0)
+   {
+      // Disarm() waits out any receive completion already running
+      return mpReactor->Disarm( this );
+   }
+
    int nReadRC = aio_cancel( mPort, &mReadIO );
    mpRxCallback = 0;
 
@@ -395,7 +455,7 @@ RETURN VALUE:
 ===========================================================================*/
 bool cComm::CancelTx()
 {
-   if (mPort == INVALID_HANDLE_VALUE)
+   if (IsConnected() == false)
    {
       return false;
    }
@@ -426,7 +486,17 @@ bool cComm::RxData(
    ULONG                      bufSz,
    cIOCallback *              pCallback )
 {
-   if (IsValid() == false || mpRxCallback != 0)
+   if (IsValid() == false)
+   {
+      return false;
+   }
+
+   if (mbTransportConnected == true)
+   {
+      return mpTransport->RxData( pBuf, bufSz, pCallback );
+   }
+
+   if (mpRxCallback != 0)
    {
       return false;
    }
@@ -443,6 +513,20 @@ bool cComm::RxData(
       mpRxCallback = pCallback;
    }
 
+   if (mpReactor != 0)
+   {
+      mpRxBuf = pBuf;
+      mRxBufSz = bufSz;
+
+      if (mpReactor->Arm( this ) == false)
+      {
+         mpRxCallback = 0;
+         return false;
+      }
+
+      return true;
+   }
+
    mReadIO.aio_fildes = mPort;
    mReadIO.aio_buf = pBuf;
    mReadIO.aio_nbytes = bufSz;
@@ -484,17 +568,161 @@ bool cComm::TxData(
    {
       return false;
    }
+
+   if (mbTransportConnected == true)
+   {
+      return mpTransport->TxData( pBuf, bufSz );
+   }
    
 #ifdef DEBUG
    ULONGLONG nStart = GetTickCount();
 #endif
 
+   if (WaitTxReady( bufSz ) == false)
+   {
+      return false;
+   }
+   
+   int nRet = write( mPort, pBuf, bufSz );
+   if (nRet != bufSz)
+   {
+      TRACE( "cComm::TxData() write returned %d instead of %lu\n",
+             nRet,
+             bufSz );
+      return false;
+   }
+
+#ifdef DEBUG
+   TRACE( "Write of %lu bytes took %llu miliseconds\n", bufSz, GetTickCount() - nStart );
+#endif
+
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   TxData (Public Method)
+
+DESCRIPTION:
+   Transmit several buffers with a single gathering write (on a message
+   based port, e.g. a QMI device node, each buffer is still a message of 
+   its own), the port is only checked for being ready once
+
+PARAMETERS:
+   pBufs       [ I ] - Buffers to be transmitted, in order
+   bufCount    [ I ] - Number of buffers
+   bufsSent    [ O ] - Number of buffers transmitted in full
+
+RETURN VALUE:
+   bool - Were all of the buffers transmitted?
+===========================================================================*/
+bool cComm::TxData(
+   const iovec *              pBufs, 
+   ULONG                      bufCount,
+   ULONG &                    bufsSent )
+{
+   bufsSent = 0;
+   if (IsValid() == false || pBufs == 0)
+   {
+      return false;
+   }
+
+   if (mbTransportConnected == true)
+   {
+      // Transports take one buffer at a time
+      while (bufsSent < bufCount)
+      {
+         const iovec & buf = pBufs[bufsSent];
+         if (mpTransport->TxData( (const BYTE *)buf.iov_base, 
+                                  (ULONG)buf.iov_len ) == false)
+         {
+            return false;
+         }
+
+         bufsSent++;
+      }
+
+      return true;
+   }
+
+   ULONG totalSz = 0;
+   for (ULONG b = 0; b < bufCount; b++)
+   {
+      totalSz += (ULONG)pBufs[b].iov_len;
+   }
+
+   if (WaitTxReady( totalSz ) == false)
+   {
+      return false;
+   }
+
+   // A short write leaves the remaining buffers (and what is left of a
+   // partially written one) for the next write
+   std::vector <iovec> bufs( pBufs, pBufs + bufCount );
+   ULONG first = 0;
+   while (first < bufCount)
+   {
+      ULONG count = bufCount - first;
+      if (count > (ULONG)IOV_MAX)
+      {
+         count = (ULONG)IOV_MAX;
+      }
+
+      ssize_t nRet = writev( mPort, &bufs[first], (int)count );
+      if (nRet < 0 && errno == EINTR)
+      {
+         continue;
+      }
+
+      if (nRet <= 0)
+      {
+         TRACE( "cComm::TxData() writev returned %d after %lu of %lu buffers\n",
+                (int)nRet,
+                first,
+                bufCount );
+         return false;
+      }
+
+      size_t written = (size_t)nRet;
+      while (first < bufCount && written >= bufs[first].iov_len)
+      {
+         written -= bufs[first].iov_len;
+         first++;
+         bufsSent++;
+      }
+
+      if (first < bufCount && written > 0)
+      {
+         bufs[first].iov_base = (BYTE *)bufs[first].iov_base + written;
+         bufs[first].iov_len -= written;
+      }
+   }
+
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   WaitTxReady (Internal Method)
+
+DESCRIPTION:
+   Wait for the port to be ready for writing, giving it up to (1000 + 
+   num bytes) MS to be ready (in 100 MS chunks), the wait can be canceled
+   with CancelTx()
+
+PARAMETERS:
+   bufSz       [ I ] - Amount of data to be transmitted
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cComm::WaitTxReady( ULONG bufSz )
+{
    // Allow ourselves to be interupted
    mbCancelWrite = false;
 
    // This seems a bit pointless, but we're still going verify
-   // the device is ready for writing, and give it up to
-   // (1000 + num bytes) MS to be ready (in 100 MS chunks)
+   // the device is ready for writing
    
    struct timeval TimeOut;
    fd_set set;
@@ -533,19 +761,108 @@ bool cComm::TxData(
              strerror( nReady) );
       return false;
    }
-   
-   int nRet = write( mPort, pBuf, bufSz );
-   if (nRet != bufSz)
+
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   SetReactor (Public Method)
+
+DESCRIPTION:
+   Receive through the given reactor instead of POSIX AIO, the reactor
+   thread then reads from the port and exercises the receive callback.
+   Must be called while disconnected
+
+PARAMETERS:
+   pReactor    [ I ] - Reactor to use (0 to revert to POSIX AIO)
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cComm::SetReactor( cCommReactor * pReactor )
+{
+   if (mPort != INVALID_HANDLE_VALUE)
    {
-      TRACE( "cComm::TxData() write returned %d instead of %lu\n",
-             nRet,
-             bufSz );
       return false;
    }
 
-#ifdef DEBUG
-   TRACE( "Write of %lu bytes took %llu miliseconds\n", bufSz, GetTickCount() - nStart );
-#endif
+   mpReactor = pReactor;
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   SetTransport (Public Method)
+
+DESCRIPTION:
+   Forward all I/O to the given transport instead of opening the port
+   given to Connect(), which is then only passed on to the transport.
+   Must be called while disconnected
+
+PARAMETERS:
+   pTransport  [ I ] - Transport to use (0 to revert to the port)
 
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cComm::SetTransport( cCommTransport * pTransport )
+{
+   if (IsConnected() == true)
+   {
+      return false;
+   }
+
+   mpTransport = pTransport;
    return true;
 }
+
+/*===========================================================================
+METHOD:
+   DispatchRx (Internal Method)
+
+DESCRIPTION:
+   Read from a readable port (without blocking) into the buffer given
+   to RxData() and exercise the receive callback
+
+SEQUENCING:
+   Only called from the reactor thread
+
+RETURN VALUE:
+   bool - Was data received?
+===========================================================================*/
+bool cComm::DispatchRx()
+{
+   cIOCallback * pCallback = mpRxCallback;
+   if (pCallback == 0 || mPort == INVALID_HANDLE_VALUE)
+   {
+      return false;
+   }
+
+   int nRet = read( mPort, mpRxBuf, mRxBufSz );
+   if (nRet == -1 && (errno == EAGAIN || errno == EINTR))
+   {
+      // Nothing (more) to read, remain armed
+      return false;
+   }
+
+   DWORD status = NO_ERROR;
+   DWORD bytesReceived = 0;
+   if (nRet == -1)
+   {
+      status = errno;
+      TRACE( "cComm::DispatchRx() = %lu, %s\n", status, strerror( status ) );
+   }
+   else
+   {
+      bytesReceived = (DWORD)nRet;
+   }
+
+   mpRxCallback = 0;
+   if (pCallback != (cIOCallback *)1)
+   {
+      pCallback->IOComplete( status, bytesReceived );
+   }
+
+   return (status == NO_ERROR && bytesReceived > 0);
+}
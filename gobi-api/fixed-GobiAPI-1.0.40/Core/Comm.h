@@ -6,6 +6,10 @@ DESCRIPTION:
    Declaration of cComm class
 
 PUBLIC CLASSES AND METHODS:
+   cCommTransport
+      This class defines the interface of a replacement for the port
+      underlying a cComm object
+
    cComm
       This class wraps low level port communications
 
@@ -41,6 +45,8 @@ POSSIBILITY OF SUCH DAMAGE.
 // Include Files
 //---------------------------------------------------------------------------
 #include "Event.h"
+#include "CommReactor.h"
+#include "ThreadConfig.h"
 
 //---------------------------------------------------------------------------
 // Pragmas
@@ -65,6 +71,47 @@ class cIOCallback
          DWORD                      bytesTransferred ) = 0;
 };
 
+/*=========================================================================*/
+// Class cCommTransport
+//
+//    A cComm object given a transport (before connecting) forwards all
+//    port I/O to it instead of opening a device node, e.g. to run the
+//    protocol servers against recorded traffic
+/*=========================================================================*/
+class cCommTransport
+{
+   public:
+      // (Inline) Destructor
+      virtual ~cCommTransport() { };
+
+      // Connect to the specified port
+      virtual bool Connect( LPCSTR pPort ) = 0;
+
+      // Disconnect from the current port
+      virtual bool Disconnect() = 0;
+
+      // Run an IOCTL on the port
+      virtual int RunIOCTL(
+         UINT                       ioctlReq,
+         void *                     pData ) = 0;
+
+      // Receive data, exercising the callback from another thread once
+      // data is available
+      virtual bool RxData(
+         BYTE *                     pBuf, 
+         ULONG                      bufSz,
+         cIOCallback *              pCallback ) = 0;
+
+      // Cancel any in-progress receive operation (waiting out a callback
+      // already running, unless called from within that callback)
+      virtual bool CancelRx() = 0;
+
+      // Transmit data
+      virtual bool TxData(
+         const BYTE *               pBuf, 
+         ULONG                      bufSz ) = 0;
+};
+
 /*=========================================================================*/
 // Class cComm
 /*=========================================================================*/
@@ -117,6 +164,13 @@ class cComm
          const BYTE *               pBuf, 
          ULONG                      bufSz );
 
+      // Transmit several buffers with a single gathering write, returning
+      // the number of buffers transmitted in full
+      virtual bool TxData(
+         const iovec *              pBufs, 
+         ULONG                      bufCount,
+         ULONG &                    bufsSent );
+
       // (Inline) Return current port name
       virtual std::string GetPortName() const 
       { 
@@ -126,10 +180,41 @@ class cComm
       // Are we currently connected to a port?
       bool IsConnected()
       {
-         return (mPort != INVALID_HANDLE_VALUE);
+         return (mPort != INVALID_HANDLE_VALUE || mbTransportConnected);
+      };
+
+      // Receive through the given reactor instead of POSIX AIO
+      bool SetReactor( cCommReactor * pReactor );
+
+      // (Inline) Return the reactor used to receive (0 for POSIX AIO)
+      cCommReactor * GetReactor()
+      {
+         return mpReactor;
+      };
+
+      // Forward all I/O to the given transport instead of a port
+      bool SetTransport( cCommTransport * pTransport );
+
+      // (Inline) Return the transport I/O is forwarded to (0 for none)
+      cCommTransport * GetTransport()
+      {
+         return mpTransport;
+      };
+
+      // (Inline) Set the thread configuration POSIX AIO receive 
+      // completions are run with (must be called while disconnected)
+      void SetThreadConfig( const cThreadConfig & config )
+      {
+         mThreadConfig = config;
       };
 
    protected:
+      // Read from a readable port and exercise the receive callback
+      bool DispatchRx();
+
+      // Wait for the port to be ready for writing the given amount of data
+      bool WaitTxReady( ULONG bufSz );
+
       /* Name of current port */
       std::string mPortName;
 
@@ -148,6 +233,25 @@ class cComm
       // Read callback cancelation notification
       cEvent mReadCanceled;
 
+      /* Reactor used to receive data (0 for POSIX AIO) */
+      cCommReactor * mpReactor;
+
+      /* Receive buffer and size (reactor mode only) */
+      BYTE * mpRxBuf;
+      ULONG mRxBufSz;
+
+      /* Transport I/O is forwarded to (0 for none) */
+      cCommTransport * mpTransport;
+
+      /* Is the above transport connected? */
+      bool mbTransportConnected;
+
+      /* Thread configuration of receive completions */
+      cThreadConfig mThreadConfig;
+
       // Rx completion routine is allowed complete access
       friend VOID RxCompletionRoutine( sigval returnSignal );
+
+      // Reactor is allowed complete access
+      friend class cCommReactor;
 };
@@ -0,0 +1,551 @@
+/*===========================================================================
+FILE:
+   CommReactor.cpp
+
+DESCRIPTION:
+   Implementation of cCommReactor class
+
+PUBLIC CLASSES AND METHODS:
+   cCommReactor
+      A single epoll thread that owns the descriptors of any number of
+      cComm objects and dispatches their receive completions
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "StdAfx.h"
+#include "CommReactor.h"
+#include "Comm.h"
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+//---------------------------------------------------------------------------
+// Definitions
+//---------------------------------------------------------------------------
+
+// Maximum number of epoll events handled per wakeup
+const int MAX_REACTOR_EVENTS = 32;
+
+// Maximum number of back-to-back reads from one port per wakeup, this lets
+// queued frames be drained without a trip through epoll_wait() while
+// still keeping a busy port from starving the others
+const ULONG MAX_REACTOR_BATCH = 16;
+
+/*=========================================================================*/
+// Free Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   ReactorThread (Free Method)
+   
+DESCRIPTION:
+   Wait for registered ports to become readable and dispatch them
+
+PARAMETERS:
+   pArg        [ I ] - The reactor object
+
+RETURN VALUE:
+   void * - thread exit value (always NULL)
+===========================================================================*/
+void * ReactorThread( PVOID pArg )
+{
+   cCommReactor * pReactor = (cCommReactor *)pArg;
+   if (pReactor == 0)
+   {
+      TRACE( "ReactorThread started with empty pArg\n" );
+      
+      ASSERT( 0 );
+      return NULL;
+   }
+
+   TRACE( "Reactor thread [%lu] started\n", 
+          pthread_self() );
+
+   epoll_event events[MAX_REACTOR_EVENTS];
+   while (pReactor->mbExiting == false)
+   {
+      int nEvents = epoll_wait( pReactor->mEpollFD, 
+                                &events[0], 
+                                MAX_REACTOR_EVENTS, 
+                                -1 );
+      if (nEvents == -1)
+      {
+         if (errno == EINTR)
+         {
+            continue;
+         }
+
+         TRACE( "ReactorThread [%lu] epoll_wait error %d, %s\n",
+                pthread_self(),
+                errno,
+                strerror( errno ) );
+         break;
+      }
+
+      for (int e = 0; e < nEvents; e++)
+      {
+         cComm * pComm = (cComm *)events[e].data.ptr;
+         if (pComm == 0)
+         {
+            // Exit wakeup
+            continue;
+         }
+
+         pReactor->Dispatch( pComm );
+      }
+   }
+
+   TRACE( "Reactor thread [%lu] exited\n", 
+          pthread_self() );
+
+   return NULL;
+}
+
+/*=========================================================================*/
+// cCommReactor Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   cCommReactor (Public Method)
+
+DESCRIPTION:
+   Constructor
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+cCommReactor::cCommReactor()
+   :  mEpollFD( -1 ),
+      mWakeFD( -1 ),
+      mThreadID( 0 ),
+      mbExiting( false ),
+      mComms(),
+      mpDispatching( 0 )
+{
+   pthread_mutex_init( &mMutex, NULL );
+   pthread_cond_init( &mDispatchDone, NULL );
+}
+
+/*===========================================================================
+METHOD:
+   ~cCommReactor (Public Method)
+
+DESCRIPTION:
+   Destructor
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+cCommReactor::~cCommReactor()
+{
+   // This should have already been called, but ...
+   Exit();
+
+   pthread_cond_destroy( &mDispatchDone );
+   pthread_mutex_destroy( &mMutex );
+}
+
+/*===========================================================================
+METHOD:
+   Initialize (Public Method)
+
+DESCRIPTION:
+   Create the epoll instance and start the reactor thread
+  
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cCommReactor::Initialize()
+{
+   if (mThreadID != 0)
+   {
+      // Already running
+      return true;
+   }
+
+   mEpollFD = epoll_create( MAX_REACTOR_EVENTS );
+   if (mEpollFD == -1)
+   {
+      TRACE( "cCommReactor - Error %d creating epoll, %s\n", 
+             errno, 
+             strerror( errno ) );
+      return false;
+   }
+
+   mWakeFD = eventfd( 0, EFD_NONBLOCK );
+   if (mWakeFD == -1)
+   {
+      close( mEpollFD );
+      mEpollFD = -1;
+      return false;
+   }
+
+   epoll_event ev;
+   memset( &ev, 0, sizeof( ev ) );
+   ev.events = EPOLLIN;
+   ev.data.ptr = 0;
+
+   if (epoll_ctl( mEpollFD, EPOLL_CTL_ADD, mWakeFD, &ev ) != 0)
+   {
+      close( mWakeFD );
+      close( mEpollFD );
+      mWakeFD = -1;
+      mEpollFD = -1;
+      return false;
+   }
+
+   mbExiting = false;
+   int nRet = mThreadConfig.CreateThread( eTHREAD_ROLE_RX,
+                                          &mThreadID,
+                                          ReactorThread,
+                                          this );
+   if (nRet != 0)
+   {
+      mThreadID = 0;
+      close( mWakeFD );
+      close( mEpollFD );
+      mWakeFD = -1;
+      mEpollFD = -1;
+      return false;
+   }
+
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   Exit (Public Method)
+
+DESCRIPTION:
+   Exit the reactor thread, any object still registered stops receiving
+  
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cCommReactor::Exit()
+{
+   if (mThreadID == 0)
+   {
+      return true;
+   }
+
+   mbExiting = true;
+
+   uint64_t count = 1;
+   if (write( mWakeFD, &count, sizeof( count ) ) != sizeof( count ))
+   {
+      // This should never happen
+      return false;
+   }
+
+   int nRet = pthread_join( mThreadID, NULL );
+   if (nRet != 0 && nRet != ESRCH)
+   {
+      TRACE( "Unable to join ReactorThread. Error %d: %s\n",
+             nRet,
+             strerror( nRet ) );
+      return false;
+   }
+
+   mThreadID = 0;
+
+   pthread_mutex_lock( &mMutex );
+   mComms.clear();
+   pthread_mutex_unlock( &mMutex );
+
+   close( mWakeFD );
+   close( mEpollFD );
+   mWakeFD = -1;
+   mEpollFD = -1;
+
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   Register (Public Method)
+
+DESCRIPTION:
+   Add the (connected) port of the given object to the reactor, the port
+   is switched to non-blocking mode and is not watched until armed
+
+PARAMETERS:
+   pComm       [ I ] - Object being registered
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cCommReactor::Register( cComm * pComm )
+{
+   if (mEpollFD == -1 || pComm == 0 || pComm->mPort == INVALID_HANDLE_VALUE)
+   {
+      return false;
+   }
+
+   int flags = fcntl( pComm->mPort, F_GETFL );
+   if (flags == -1 || fcntl( pComm->mPort, F_SETFL, flags | O_NONBLOCK ) != 0)
+   {
+      return false;
+   }
+
+   // Registered disarmed (one shot with no events)
+   epoll_event ev;
+   memset( &ev, 0, sizeof( ev ) );
+   ev.events = EPOLLONESHOT;
+   ev.data.ptr = pComm;
+
+   pthread_mutex_lock( &mMutex );
+
+   bool bRC = (epoll_ctl( mEpollFD, EPOLL_CTL_ADD, pComm->mPort, &ev ) == 0);
+   if (bRC == true)
+   {
+      mComms.insert( pComm );
+   }
+
+   pthread_mutex_unlock( &mMutex );
+
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   Unregister (Public Method)
+
+DESCRIPTION:
+   Remove the port of the given object from the reactor, waiting out
+   any receive completion already running for it
+
+PARAMETERS:
+   pComm       [ I ] - Object being unregistered
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cCommReactor::Unregister( cComm * pComm )
+{
+   pthread_mutex_lock( &mMutex );
+
+   bool bRC = (mComms.erase( pComm ) > 0);
+   if (bRC == true)
+   {
+      epoll_ctl( mEpollFD, EPOLL_CTL_DEL, pComm->mPort, 0 );
+      WaitForDispatch( pComm );
+   }
+
+   pthread_mutex_unlock( &mMutex );
+
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   Arm (Public Method)
+
+DESCRIPTION:
+   Wait for the port of the given object to become readable, the receive
+   buffer and callback must already be stored in the object 
+
+   Note: when called from within a receive completion for the same object
+   the port is re-armed by the reactor thread once the completion returns,
+   allowing any further queued data to be read without another 
+   epoll_wait() call
+
+PARAMETERS:
+   pComm       [ I ] - Object being armed
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cCommReactor::Arm( cComm * pComm )
+{
+   // Assume failure
+   bool bRC = false;
+
+   pthread_mutex_lock( &mMutex );
+
+   if (mComms.find( pComm ) != mComms.end())
+   {
+      if (mpDispatching == pComm)
+      {
+         // Re-armed after dispatch
+         bRC = true;
+      }
+      else
+      {
+         epoll_event ev;
+         memset( &ev, 0, sizeof( ev ) );
+         ev.events = EPOLLIN | EPOLLONESHOT;
+         ev.data.ptr = pComm;
+
+         bRC = (epoll_ctl( mEpollFD, EPOLL_CTL_MOD, pComm->mPort, &ev ) == 0);
+      }
+   }
+
+   pthread_mutex_unlock( &mMutex );
+
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   Disarm (Public Method)
+
+DESCRIPTION:
+   Stop waiting for the port of the given object to become readable and 
+   clear its receive callback, waiting out any receive completion 
+   already running for it
+
+PARAMETERS:
+   pComm       [ I ] - Object being disarmed
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cCommReactor::Disarm( cComm * pComm )
+{
+   // Assume failure
+   bool bRC = false;
+
+   pthread_mutex_lock( &mMutex );
+
+   if (mComms.find( pComm ) != mComms.end())
+   {
+      WaitForDispatch( pComm );
+
+      epoll_event ev;
+      memset( &ev, 0, sizeof( ev ) );
+      ev.events = EPOLLONESHOT;
+      ev.data.ptr = pComm;
+
+      bRC = (epoll_ctl( mEpollFD, EPOLL_CTL_MOD, pComm->mPort, &ev ) == 0);
+   }
+
+   pComm->mpRxCallback = 0;
+
+   pthread_mutex_unlock( &mMutex );
+
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   WaitForDispatch (Internal Method)
+
+DESCRIPTION:
+   Wait until no receive completion is running for the given object 
+   (a completion running on the reactor thread itself is not waited on) 
+
+PARAMETERS:
+   pComm       [ I ] - Object in question
+
+SEQUENCING:
+   Calling process must have lock on mMutex
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cCommReactor::WaitForDispatch( cComm * pComm )
+{
+   if (mThreadID != 0 && pthread_equal( mThreadID, pthread_self() ) != 0)
+   {
+      return;
+   }
+
+   while (mpDispatching == pComm)
+   {
+      pthread_cond_wait( &mDispatchDone, &mMutex );
+   }
+}
+
+/*===========================================================================
+METHOD:
+   Dispatch (Internal Method)
+
+DESCRIPTION:
+   Service a readable port by exercising its receive callback, reading
+   again each time the callback re-arms (up to MAX_REACTOR_BATCH reads)
+   before the port goes back to epoll
+
+PARAMETERS:
+   pComm       [ I ] - Object whose port is readable
+
+SEQUENCING:
+   Only called from the reactor thread
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cCommReactor::Dispatch( cComm * pComm )
+{
+   pthread_mutex_lock( &mMutex );
+
+   if (mComms.find( pComm ) == mComms.end())
+   {
+      // Unregistered since epoll_wait() returned
+      pthread_mutex_unlock( &mMutex );
+      return;
+   }
+
+   mpDispatching = pComm;
+   pthread_mutex_unlock( &mMutex );
+
+   for (ULONG b = 0; b < MAX_REACTOR_BATCH; b++)
+   {
+      if (pComm->DispatchRx() == false)
+      {
+         break;
+      }
+   }
+
+   pthread_mutex_lock( &mMutex );
+
+   mpDispatching = 0;
+   pthread_cond_broadcast( &mDispatchDone );
+
+   // Re-arm if the callback asked for more data
+   if ( (mComms.find( pComm ) != mComms.end())
+   &&   (pComm->mpRxCallback != 0) )
+   {
+      epoll_event ev;
+      memset( &ev, 0, sizeof( ev ) );
+      ev.events = EPOLLIN | EPOLLONESHOT;
+      ev.data.ptr = pComm;
+
+      epoll_ctl( mEpollFD, EPOLL_CTL_MOD, pComm->mPort, &ev );
+   }
+
+   pthread_mutex_unlock( &mMutex );
+}
@@ -0,0 +1,133 @@
+/*===========================================================================
+FILE:
+   CommReactor.h
+
+DESCRIPTION:
+   Declaration of cCommReactor class
+
+PUBLIC CLASSES AND METHODS:
+   cCommReactor
+      A single epoll thread that owns the descriptors of any number of
+      cComm objects and dispatches their receive completions
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Pragmas
+//---------------------------------------------------------------------------
+#pragma once
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "StdAfx.h"
+#include "ThreadConfig.h"
+
+#include <pthread.h>
+#include <set>
+
+//---------------------------------------------------------------------------
+// Forward Declarations
+//---------------------------------------------------------------------------
+class cComm;
+
+/*=========================================================================*/
+// Class cCommReactor
+/*=========================================================================*/
+class cCommReactor
+{
+   public:
+      // Constructor
+      cCommReactor();
+
+      // Destructor
+      virtual ~cCommReactor();
+
+      // Start the reactor thread
+      bool Initialize();
+
+      // (Inline) Set the thread configuration the reactor thread is started
+      // with (as an eTHREAD_ROLE_RX thread)
+      void SetThreadConfig( const cThreadConfig & config )
+      {
+         mThreadConfig = config;
+      };
+
+      // Exit the reactor thread
+      bool Exit();
+
+      // Add the (connected) port of the given object to the reactor
+      bool Register( cComm * pComm );
+
+      // Remove the port of the given object from the reactor
+      bool Unregister( cComm * pComm );
+
+      // Wait for the port of the given object to become readable
+      bool Arm( cComm * pComm );
+
+      // Stop waiting for the port of the given object to become readable
+      bool Disarm( cComm * pComm );
+
+   protected:
+      // Wait until no receive completion is running for the given object
+      void WaitForDispatch( cComm * pComm );
+
+      // Service a readable port
+      void Dispatch( cComm * pComm );
+
+      /* epoll instance watching all registered ports */
+      int mEpollFD;
+
+      /* eventfd used to wake the reactor thread for exit */
+      int mWakeFD;
+
+      /* ID of reactor thread */
+      pthread_t mThreadID;
+
+      /* Thread configuration of the reactor thread */
+      cThreadConfig mThreadConfig;
+
+      /* Is the reactor thread exiting? */
+      bool mbExiting;
+
+      /* Registered objects */
+      std::set <cComm *> mComms;
+
+      /* Object whose receive completion is currently running */
+      cComm * mpDispatching;
+
+      /* Mutex protecting mComms and mpDispatching */
+      pthread_mutex_t mMutex;
+
+      /* Signalled when a dispatch completes */
+      pthread_cond_t mDispatchDone;
+
+      // Reactor thread gets full access
+      friend void * ReactorThread( PVOID pArg );
+};
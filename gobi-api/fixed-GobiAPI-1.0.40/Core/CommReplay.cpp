@@ -0,0 +1,963 @@
+/*===========================================================================
+FILE:
+   CommReplay.cpp
+
+DESCRIPTION:
+   Implementation of cCommReplayCapture and cCommReplay classes
+
+PUBLIC CLASSES AND METHODS:
+   cCommReplayCapture
+      The QMI traffic held in one or more protocol log capture files
+
+   cCommReplay
+      A cComm transport standing in for a QMI device, it replays the
+      indications of a capture and answers every request
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "StdAfx.h"
+#include "CommReplay.h"
+#include "MemoryMappedFile.h"
+#include "ProtocolLog.h"
+#include "ProtocolServer.h"
+#include "QMIBuffers.h"
+
+//---------------------------------------------------------------------------
+// Definitions
+//---------------------------------------------------------------------------
+
+// Signature of a protocol log capture file (see cProtocolLog::StartSpill())
+const UINT REPLAY_CAPTURE_SIG = 0x474F4C50;
+
+// Result TLV of a synthesized response (success, no error)
+const BYTE REPLAY_RESULT_TLV[] = { 0x02, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00 };
+
+/*=========================================================================*/
+// Free Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   ParseCaptureRecords (Free Method)
+
+DESCRIPTION:
+   Append the QMI records found in the given range of a capture file
+
+PARAMETERS:
+   pFile       [ I ] - Capture file contents
+   fileSz      [ I ] - Size of above
+   from        [ I ] - Offset of the first record
+   to          [ I ] - Offset of the end of the last record
+   records     [ O ] - Records read
+
+RETURN VALUE:
+   bool - Was the range well formed?
+===========================================================================*/
+bool ParseCaptureRecords(
+   const BYTE *                        pFile,
+   ULONG                               fileSz,
+   ULONG                               from,
+   ULONG                               to,
+   std::vector <sCommReplayRecord> &   records )
+{
+   if (to > fileSz)
+   {
+      return false;
+   }
+
+   ULONG offset = from;
+   while (offset < to)
+   {
+      if (to - offset < sizeof( sProtocolLogSpillRecord ))
+      {
+         return false;
+      }
+
+      sProtocolLogSpillRecord rec;
+      memcpy( &rec, pFile + offset, sizeof( rec ) );
+      offset += sizeof( rec );
+
+      if (to - offset < rec.mSize)
+      {
+         return false;
+      }
+
+      eProtocolType pt = (eProtocolType)rec.mType;
+      if (IsQMIProtocol( pt ) == true && rec.mSize > 0)
+      {
+         tm ts;
+         memset( &ts, 0, sizeof( ts ) );
+         ts.tm_year = (int)(rec.mDate / 10000) - 1900;
+         ts.tm_mon = (int)((rec.mDate / 100) % 100) - 1;
+         ts.tm_mday = (int)(rec.mDate % 100);
+         ts.tm_hour = (int)(rec.mTime / 10000);
+         ts.tm_min = (int)((rec.mTime / 100) % 100);
+         ts.tm_sec = (int)(rec.mTime % 100);
+         ts.tm_isdst = -1;
+
+         sCommReplayRecord replayRec;
+         replayRec.mType = pt;
+         replayRec.mTime = mktime( &ts );
+         replayRec.mData.assign( pFile + offset, pFile + offset + rec.mSize );
+         records.push_back( replayRec );
+      }
+
+      offset += rec.mSize;
+   }
+
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   ReplayThread (Free Method)
+   
+DESCRIPTION:
+   Deliver responses and indications to the pending receive once due
+
+PARAMETERS:
+   pArg        [ I ] - The replay object
+
+RETURN VALUE:
+   void * - thread exit value (always NULL)
+===========================================================================*/
+void * ReplayThread( PVOID pArg )
+{
+   cCommReplay * pReplay = (cCommReplay *)pArg;
+   if (pReplay == 0)
+   {
+      TRACE( "ReplayThread started with empty pArg\n" );
+      
+      ASSERT( 0 );
+      return NULL;
+   }
+
+   pthread_mutex_lock( &pReplay->mMutex );
+
+   while (pReplay->mbExiting == false)
+   {
+      // Next buffer due, responses first
+      cCommReplay::sPendingRx * pNext = 0;
+      if (pReplay->mResponses.empty() == false)
+      {
+         pNext = &pReplay->mResponses.front();
+      }
+
+      if (pReplay->mIndication.mDue != 0
+      &&  (pNext == 0 || pReplay->mIndication.mDue < pNext->mDue))
+      {
+         pNext = &pReplay->mIndication;
+      }
+
+      if (pNext == 0 || pReplay->mbRxPending == false)
+      {
+         pthread_cond_wait( &pReplay->mWake, &pReplay->mMutex );
+         continue;
+      }
+
+      ULONGLONG now = GetTickCount();
+      if (pNext->mDue > now)
+      {
+         timespec due = TimeIn( (ULONG)(pNext->mDue - now) );
+         pthread_cond_timedwait( &pReplay->mWake, &pReplay->mMutex, &due );
+         continue;
+      }
+
+      // Hand the buffer over (truncated, like a read would)
+      ULONG sz = (ULONG)pNext->mData.size();
+      if (sz > pReplay->mRxBufSz)
+      {
+         sz = pReplay->mRxBufSz;
+      }
+
+      memcpy( pReplay->mpRxBuf, &pNext->mData[0], (size_t)sz );
+
+      if (pNext == &pReplay->mIndication)
+      {
+         pReplay->QueueNextIndication();
+      }
+      else
+      {
+         pReplay->mResponses.pop_front();
+      }
+
+      cIOCallback * pCallback = pReplay->mpRxCallback;
+      pReplay->mpRxCallback = 0;
+      pReplay->mbRxPending = false;
+
+      if (pCallback != 0)
+      {
+         // The callback typically re-arms the receive
+         pReplay->mbDispatching = true;
+         pthread_mutex_unlock( &pReplay->mMutex );
+
+         pCallback->IOComplete( NO_ERROR, sz );
+
+         pthread_mutex_lock( &pReplay->mMutex );
+         pReplay->mbDispatching = false;
+         pthread_cond_broadcast( &pReplay->mDispatchDone );
+      }
+   }
+
+   pthread_mutex_unlock( &pReplay->mMutex );
+   return NULL;
+}
+
+/*=========================================================================*/
+// cCommReplayCapture Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   cCommReplayCapture (Public Method)
+
+DESCRIPTION:
+   Constructor
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+cCommReplayCapture::cCommReplayCapture()
+   :  mRecords(),
+      mResponses()
+{
+   // Nothing to do
+}
+
+/*===========================================================================
+METHOD:
+   ~cCommReplayCapture (Public Method)
+
+DESCRIPTION:
+   Destructor
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+cCommReplayCapture::~cCommReplayCapture()
+{
+   // Nothing to do
+}
+
+/*===========================================================================
+METHOD:
+   Load (Public Method)
+
+DESCRIPTION:
+   Add the QMI buffers held in a capture file written by 
+   cProtocolLog::StartSpill(), oldest first
+
+PARAMETERS:
+   pFileName   [ I ] - Capture file name
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cCommReplayCapture::Load( LPCSTR pFileName )
+{
+   // Assume failure
+   bool bRC = false;
+   if (pFileName == 0 || pFileName[0] == 0)
+   {
+      return bRC;
+   }
+
+   cMemoryMappedFile file( pFileName );
+   const BYTE * pFile = (const BYTE *)file.GetContents();
+   ULONG fileSz = file.GetSize();
+   if (pFile == 0 || fileSz < sizeof( sProtocolLogSpillHeader ))
+   {
+      TRACE( "CommReplay: Unable to read %s\n", pFileName );
+      return bRC;
+   }
+
+   sProtocolLogSpillHeader hdr;
+   memcpy( &hdr, pFile, sizeof( hdr ) );
+   if (hdr.mSignature != REPLAY_CAPTURE_SIG)
+   {
+      TRACE( "CommReplay: %s is not a capture file\n", pFileName );
+      return bRC;
+   }
+
+   // Once wrapped the oldest records are those after the write offset
+   std::vector <sCommReplayRecord> records;
+   ULONG start = (ULONG)sizeof( sProtocolLogSpillHeader );
+   if (hdr.mOldestOffset > start)
+   {
+      bRC = ParseCaptureRecords( pFile, 
+                                 fileSz, 
+                                 hdr.mOldestOffset,
+                                 hdr.mEndOffset,
+                                 records );
+   }
+   else
+   {
+      bRC = true;
+   }
+
+   if (bRC == true)
+   {
+      bRC = ParseCaptureRecords( pFile, 
+                                 fileSz, 
+                                 start,
+                                 hdr.mWriteOffset,
+                                 records );
+   }
+
+   if (bRC == false)
+   {
+      TRACE( "CommReplay: %s is corrupted\n", pFileName );
+      return bRC;
+   }
+
+   // Index the responses
+   for (ULONG r = 0; r < (ULONG)records.size(); r++)
+   {
+      const sCommReplayRecord & rec = records[r];
+      if (IsQMIProtocolRX( rec.mType ) == false)
+      {
+         continue;
+      }
+
+      ULONG szHdr = sQMIServiceBuffer::GetHeaderSize();
+      if (rec.mData.size() < szHdr)
+      {
+         continue;
+      }
+
+      const sQMIServiceRawTransactionHeader * pHdr = 0;
+      pHdr = (const sQMIServiceRawTransactionHeader *)&rec.mData[0];
+      if (pHdr->mResponse != 1)
+      {
+         continue;
+      }
+
+      const sQMIRawMessageHeader * pMsgHdr = 0;
+      pMsgHdr = (const sQMIRawMessageHeader *)
+                   (&rec.mData[0] + sizeof( sQMIServiceRawTransactionHeader ));
+
+      std::pair <ULONG, ULONG> key( (ULONG)rec.mType, (ULONG)pMsgHdr->mMessageID );
+      mResponses[key] = (ULONG)mRecords.size() + r;
+   }
+
+   mRecords.insert( mRecords.end(), records.begin(), records.end() );
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   FindResponse (Public Method)
+
+DESCRIPTION:
+   Return the latest recorded response to the given message
+
+PARAMETERS:
+   svc         [ I ] - QMI service
+   msgID       [ I ] - QMI message ID
+
+RETURN VALUE:
+   const sCommReplayRecord * - The response (0 if none)
+===========================================================================*/
+const sCommReplayRecord * cCommReplayCapture::FindResponse( 
+   eQMIService                svc,
+   ULONG                      msgID ) const
+{
+   eProtocolType pt = MapQMIServiceToProtocol( svc, false );
+
+   std::map <std::pair <ULONG, ULONG>, ULONG>::const_iterator pIter;
+   pIter = mResponses.find( std::pair <ULONG, ULONG>( (ULONG)pt, msgID ) );
+   if (pIter == mResponses.end())
+   {
+      return 0;
+   }
+
+   return &mRecords[pIter->second];
+}
+
+/*=========================================================================*/
+// cCommReplay Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   cCommReplay (Public Method)
+
+DESCRIPTION:
+   Constructor
+
+PARAMETERS:
+   pCapture    [ I ] - Capture to replay (0 to only answer requests), it
+                       must outlive this object
+   speed       [ I ] - Indication replay speed factor (1.0 for the 
+                       original timing, 0 to disable indications)
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+cCommReplay::cCommReplay( 
+   const cCommReplayCapture * pCapture,
+   double                     speed )
+   :  mpCapture( pCapture ),
+      mSpeed( speed ),
+      mResponseDelay( 0 ),
+      mService( eQMI_SVC_ENUM_BEGIN ),
+      mResponses(),
+      mbHoldResponses( false ),
+      mHeldResponses(),
+      mIndication(),
+      mNextRecord( 0 ),
+      mReplayStartTime( 0 ),
+      mReplayStartTick( 0 ),
+      mpRxBuf( 0 ),
+      mRxBufSz( 0 ),
+      mpRxCallback( 0 ),
+      mbRxPending( false ),
+      mThreadID( 0 ),
+      mbExiting( false ),
+      mbDispatching( false )
+{
+   mIndication.mDue = 0;
+
+   pthread_mutex_init( &mMutex, NULL );
+   pthread_cond_init( &mDispatchDone, NULL );
+
+   // Due times are monotonic (see TimeIn())
+   pthread_condattr_t attr;
+   pthread_condattr_init( &attr );
+   pthread_condattr_setclock( &attr, CLOCK_MONOTONIC );
+   pthread_cond_init( &mWake, &attr );
+   pthread_cond_init( &mHeld, &attr );
+   pthread_condattr_destroy( &attr );
+}
+
+/*===========================================================================
+METHOD:
+   ~cCommReplay (Public Method)
+
+DESCRIPTION:
+   Destructor
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+cCommReplay::~cCommReplay()
+{
+   // This should have already been called, but ...
+   Disconnect();
+
+   pthread_cond_destroy( &mWake );
+   pthread_cond_destroy( &mDispatchDone );
+   pthread_cond_destroy( &mHeld );
+   pthread_mutex_destroy( &mMutex );
+}
+
+/*===========================================================================
+METHOD:
+   SetResponseDelay (Public Method)
+
+DESCRIPTION:
+   Delay responses by the given time, to model the device round trip
+
+PARAMETERS:
+   delay       [ I ] - Response delay (milliseconds)
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cCommReplay::SetResponseDelay( ULONG delay )
+{
+   if (mThreadID != 0)
+   {
+      return false;
+   }
+
+   mResponseDelay = delay;
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   SetHoldResponses (Public Method)
+
+DESCRIPTION:
+   Hold the responses to requests until released through ReleaseResponse(),
+   e.g. to deliver them out of order or not at all
+
+PARAMETERS:
+   bHold       [ I ] - Hold responses?
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cCommReplay::SetHoldResponses( bool bHold )
+{
+   if (mThreadID != 0)
+   {
+      return false;
+   }
+
+   mbHoldResponses = bHold;
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   WaitForHeldResponses (Public Method)
+
+DESCRIPTION:
+   Wait for the given number of responses to be held
+
+PARAMETERS:
+   count       [ I ] - Number of responses
+   timeout     [ I ] - Time to wait for them (milliseconds)
+
+RETURN VALUE:
+   bool - Were that many responses held in time?
+===========================================================================*/
+bool cCommReplay::WaitForHeldResponses(
+   ULONG                      count,
+   ULONG                      timeout )
+{
+   timespec to = TimeIn( timeout );
+
+   pthread_mutex_lock( &mMutex );
+
+   int nRet = 0;
+   while ((ULONG)mHeldResponses.size() < count && nRet == 0)
+   {
+      nRet = pthread_cond_timedwait( &mHeld, &mMutex, &to );
+   }
+
+   bool bRC = ((ULONG)mHeldResponses.size() >= count);
+
+   pthread_mutex_unlock( &mMutex );
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   ReleaseResponse (Public Method)
+
+DESCRIPTION:
+   Release a held response, it is received right away (after any other
+   response already released)
+
+PARAMETERS:
+   idx         [ I ] - Index of the response among those still held (in
+                       transmission order)
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cCommReplay::ReleaseResponse( ULONG idx )
+{
+   pthread_mutex_lock( &mMutex );
+
+   if (idx >= (ULONG)mHeldResponses.size())
+   {
+      pthread_mutex_unlock( &mMutex );
+      return false;
+   }
+
+   sPendingRx rsp = mHeldResponses[idx];
+   mHeldResponses.erase( mHeldResponses.begin() + idx );
+
+   rsp.mDue = GetTickCount();
+   mResponses.push_back( rsp );
+
+   pthread_cond_signal( &mWake );
+   pthread_mutex_unlock( &mMutex );
+
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   Connect (Public Method)
+
+DESCRIPTION:
+   Connect to the specified (fake) port, starting the delivery thread
+
+PARAMETERS:
+   pPort       [ I ] - Name of port (only used for tracing)
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cCommReplay::Connect( LPCSTR pPort )
+{
+   if (mThreadID != 0)
+   {
+      return false;
+   }
+
+   mbExiting = false;
+   mService = eQMI_SVC_ENUM_BEGIN;
+
+   int nRet = pthread_create( &mThreadID, 
+                              NULL,
+                              ReplayThread, 
+                              this );
+   if (nRet != 0)
+   {
+      TRACE( "CommReplay: Unable to start thread for %s. Error %d: %s\n",
+             pPort,
+             nRet,
+             strerror( nRet ) );
+
+      mThreadID = 0;
+      return false;
+   }
+
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   Disconnect (Public Method)
+
+DESCRIPTION:
+   Stop the delivery thread and drop anything not yet received
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cCommReplay::Disconnect()
+{
+   if (mThreadID == 0)
+   {
+      return true;
+   }
+
+   pthread_mutex_lock( &mMutex );
+   mbExiting = true;
+   pthread_cond_signal( &mWake );
+   pthread_mutex_unlock( &mMutex );
+
+   if (pthread_self() != mThreadID)
+   {
+      pthread_join( mThreadID, NULL );
+   }
+   else
+   {
+      pthread_detach( mThreadID );
+   }
+
+   mThreadID = 0;
+
+   mResponses.clear();
+   mHeldResponses.clear();
+   mIndication.mDue = 0;
+   mIndication.mData.clear();
+   mpRxCallback = 0;
+   mbRxPending = false;
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   RunIOCTL (Public Method)
+
+DESCRIPTION:
+   Run an IOCTL on the port, the QMI service IOCTL starts the replay of
+   the indications of that service and any other IOCTL succeeds
+
+PARAMETERS:
+   ioctlReq [ I ] - ioctl request value
+   pData    [I/O] - input or output specific to ioctl request value
+
+RETURN VALUE:
+   int - ioctl return value (0 for success)
+===========================================================================*/
+int cCommReplay::RunIOCTL(
+   UINT                       ioctlReq,
+   void *                     pData )
+{
+   if (ioctlReq != (UINT)(QMI_GET_SERVICE_FILE_IOCTL))
+   {
+      return 0;
+   }
+
+   pthread_mutex_lock( &mMutex );
+
+   mService = (eQMIService)(unsigned long)pData;
+   mNextRecord = 0;
+   mReplayStartTime = 0;
+   mReplayStartTick = GetTickCount();
+   QueueNextIndication();
+
+   pthread_cond_signal( &mWake );
+   pthread_mutex_unlock( &mMutex );
+
+   return 0;
+}
+
+/*===========================================================================
+METHOD:
+   RxData (Public Method)
+
+DESCRIPTION:
+   Receive data
+
+PARAMETERS:
+   pBuf        [ I ] - Buffer to contain received data
+   bufSz       [ I ] - Amount of data to be received
+   pCallback   [ I ] - Callback object to be exercised when the
+                       operation completes
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cCommReplay::RxData(
+   BYTE *                     pBuf, 
+   ULONG                      bufSz,
+   cIOCallback *              pCallback )
+{
+   if (pBuf == 0 || bufSz == 0)
+   {
+      return false;
+   }
+
+   pthread_mutex_lock( &mMutex );
+
+   if (mThreadID == 0 || mbRxPending == true)
+   {
+      pthread_mutex_unlock( &mMutex );
+      return false;
+   }
+
+   mpRxBuf = pBuf;
+   mRxBufSz = bufSz;
+   mpRxCallback = pCallback;
+   mbRxPending = true;
+
+   pthread_cond_signal( &mWake );
+   pthread_mutex_unlock( &mMutex );
+
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   CancelRx (Public Method)
+
+DESCRIPTION:
+   Cancel any in-progress receive operation, waiting out a receive 
+   completion already running (unless called from within it)
+  
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cCommReplay::CancelRx()
+{
+   pthread_mutex_lock( &mMutex );
+
+   bool bRC = mbRxPending;
+   mpRxCallback = 0;
+   mbRxPending = false;
+
+   if (pthread_self() != mThreadID)
+   {
+      WaitForDispatch();
+   }
+
+   pthread_mutex_unlock( &mMutex );
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   TxData (Public Method)
+
+DESCRIPTION:
+   Transmit data, a QMI request is answered with the recorded response
+   to the same message (or a bare successful response) carrying the 
+   transaction ID of the request
+
+PARAMETERS:
+   pBuf        [ I ] - Data to be transmitted
+   bufSz       [ I ] - Amount of data to be transmitted
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cCommReplay::TxData(
+   const BYTE *               pBuf, 
+   ULONG                      bufSz )
+{
+   ULONG szHdr = sQMIServiceBuffer::GetHeaderSize();
+   if (pBuf == 0 || bufSz < szHdr || mThreadID == 0)
+   {
+      return false;
+   }
+
+   const sQMIServiceRawTransactionHeader * pHdr = 0;
+   pHdr = (const sQMIServiceRawTransactionHeader *)pBuf;
+   if (pHdr->mResponse != 0 || pHdr->mIndication != 0)
+   {
+      // Nothing to answer
+      return true;
+   }
+
+   const sQMIRawMessageHeader * pMsgHdr = 0;
+   pMsgHdr = (const sQMIRawMessageHeader *)
+                (pBuf + sizeof( sQMIServiceRawTransactionHeader ));
+
+   WORD msgID = pMsgHdr->mMessageID;
+
+   sPendingRx rsp;
+   rsp.mDue = GetTickCount() + mResponseDelay;
+
+   const sCommReplayRecord * pRec = 0;
+   if (mpCapture != 0)
+   {
+      pRec = mpCapture->FindResponse( mService, msgID );
+   }
+
+   if (pRec != 0)
+   {
+      rsp.mData = pRec->mData;
+   }
+   else
+   {
+      rsp.mData.resize( szHdr + sizeof( REPLAY_RESULT_TLV ) );
+      sQMIServiceBuffer::FormatHeader( &rsp.mData[0], 
+                                       msgID, 
+                                       true, 
+                                       false, 
+                                       sizeof( REPLAY_RESULT_TLV ) );
+
+      memcpy( &rsp.mData[szHdr], 
+              &REPLAY_RESULT_TLV[0], 
+              sizeof( REPLAY_RESULT_TLV ) );
+   }
+
+   sQMIServiceRawTransactionHeader * pRspHdr = 0;
+   pRspHdr = (sQMIServiceRawTransactionHeader *)&rsp.mData[0];
+   pRspHdr->mTransactionID = pHdr->mTransactionID;
+
+   pthread_mutex_lock( &mMutex );
+
+   if (mbHoldResponses == true)
+   {
+      mHeldResponses.push_back( rsp );
+      pthread_cond_broadcast( &mHeld );
+   }
+   else
+   {
+      mResponses.push_back( rsp );
+      pthread_cond_signal( &mWake );
+   }
+
+   pthread_mutex_unlock( &mMutex );
+
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   QueueNextIndication (Internal Method)
+
+DESCRIPTION:
+   Queue the next recorded indication of the service (if any)
+
+   NOTE: must be called with the mutex held
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cCommReplay::QueueNextIndication()
+{
+   mIndication.mDue = 0;
+   mIndication.mData.clear();
+
+   if (mpCapture == 0 || mSpeed <= 0.0)
+   {
+      return;
+   }
+
+   eProtocolType pt = MapQMIServiceToProtocol( mService, false );
+
+   const std::vector <sCommReplayRecord> & records = mpCapture->GetRecords();
+   while (mNextRecord < (ULONG)records.size())
+   {
+      const sCommReplayRecord & rec = records[mNextRecord++];
+      if (rec.mType != pt || rec.mData.size() < sizeof( sQMIServiceRawTransactionHeader ))
+      {
+         continue;
+      }
+
+      const sQMIServiceRawTransactionHeader * pHdr = 0;
+      pHdr = (const sQMIServiceRawTransactionHeader *)&rec.mData[0];
+      if (pHdr->mIndication != 1)
+      {
+         continue;
+      }
+
+      // Spacing is relative to the first indication replayed
+      if (mReplayStartTime == 0)
+      {
+         mReplayStartTime = rec.mTime;
+      }
+
+      double offset = difftime( rec.mTime, mReplayStartTime ) * 1000.0 / mSpeed;
+      if (offset < 0.0)
+      {
+         offset = 0.0;
+      }
+
+      // Never 0, which means no indication
+      mIndication.mDue = mReplayStartTick + (ULONGLONG)offset + 1;
+      mIndication.mData = rec.mData;
+      return;
+   }
+}
+
+/*===========================================================================
+METHOD:
+   WaitForDispatch (Internal Method)
+
+DESCRIPTION:
+   Wait until no receive completion is running
+
+   NOTE: must be called with the mutex held
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cCommReplay::WaitForDispatch()
+{
+   while (mbDispatching == true)
+   {
+      pthread_cond_wait( &mDispatchDone, &mMutex );
+   }
+}
@@ -0,0 +1,257 @@
+/*===========================================================================
+FILE:
+   CommReplay.h
+
+DESCRIPTION:
+   Declaration of cCommReplayCapture and cCommReplay classes
+
+PUBLIC CLASSES AND METHODS:
+   cCommReplayCapture
+      The QMI traffic held in one or more protocol log capture files
+
+   cCommReplay
+      A cComm transport standing in for a QMI device, it replays the
+      indications of a capture and answers every request
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Pragmas
+//---------------------------------------------------------------------------
+#pragma once
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "Comm.h"
+#include "ProtocolEnum.h"
+#include "QMIEnum.h"
+
+#include <deque>
+#include <map>
+#include <vector>
+
+//---------------------------------------------------------------------------
+// Definitions
+//---------------------------------------------------------------------------
+
+// A buffer read from a capture file
+struct sCommReplayRecord
+{
+   /* Protocol type of the buffer */
+   eProtocolType mType;
+
+   /* Time the buffer was logged at (seconds) */
+   time_t mTime;
+
+   /* The buffer */
+   std::vector <BYTE> mData;
+};
+
+/*=========================================================================*/
+// Class cCommReplayCapture
+/*=========================================================================*/
+class cCommReplayCapture
+{
+   public:
+      // Constructor
+      cCommReplayCapture();
+
+      // Destructor
+      virtual ~cCommReplayCapture();
+
+      // Add the QMI buffers held in a capture file (oldest first)
+      bool Load( LPCSTR pFileName );
+
+      // (Inline) Return the records loaded so far
+      const std::vector <sCommReplayRecord> & GetRecords() const
+      {
+         return mRecords;
+      };
+
+      // Return the latest recorded response to the given message
+      const sCommReplayRecord * FindResponse( 
+         eQMIService                svc,
+         ULONG                      msgID ) const;
+
+   protected:
+      /* Loaded records */
+      std::vector <sCommReplayRecord> mRecords;
+
+      /* Record index of responses (by protocol type and message ID) */
+      std::map <std::pair <ULONG, ULONG>, ULONG> mResponses;
+};
+
+/*=========================================================================*/
+// Class cCommReplay
+//
+//    Once connected the QMI service is learnt through the same IOCTL sent
+//    to a QMI device node.  Each request transmitted is answered with the
+//    recorded response to the same message (or, lacking one, a bare
+//    successful response) carrying the transaction ID of the request.  
+//    Recorded indications of the service are replayed with their original
+//    spacing divided by the speed factor (capture timestamps only have a 
+//    one second resolution), a speed of zero disables them
+//
+//    Responses may instead be held until released one by one, so that 
+//    they are received in any order (or never)
+/*=========================================================================*/
+class cCommReplay : public cCommTransport
+{
+   public:
+      // Constructor
+      cCommReplay( 
+         const cCommReplayCapture * pCapture = 0,
+         double                     speed = 1.0 );
+
+      // Destructor
+      virtual ~cCommReplay();
+
+      // Delay responses by the given time (must be called while 
+      // disconnected)
+      bool SetResponseDelay( ULONG delay );
+
+      // Hold the responses to requests until released (must be called 
+      // while disconnected)
+      bool SetHoldResponses( bool bHold );
+
+      // Wait for the given number of responses to be held
+      bool WaitForHeldResponses(
+         ULONG                      count,
+         ULONG                      timeout );
+
+      // Release a held response (indexed among those still held, in 
+      // transmission order), it is received right away
+      bool ReleaseResponse( ULONG idx );
+
+      // Connect to the specified (fake) port
+      virtual bool Connect( LPCSTR pPort );
+
+      // Disconnect from the current port
+      virtual bool Disconnect();
+
+      // Run an IOCTL on the port
+      virtual int RunIOCTL(
+         UINT                       ioctlReq,
+         void *                     pData );
+
+      // Receive data
+      virtual bool RxData(
+         BYTE *                     pBuf, 
+         ULONG                      bufSz,
+         cIOCallback *              pCallback );
+
+      // Cancel any in-progress receive operation
+      virtual bool CancelRx();
+
+      // Transmit data
+      virtual bool TxData(
+         const BYTE *               pBuf, 
+         ULONG                      bufSz );
+
+   protected:
+      // A buffer waiting to be received
+      struct sPendingRx
+      {
+         /* Tick at which it becomes available */
+         ULONGLONG mDue;
+
+         /* The buffer */
+         std::vector <BYTE> mData;
+      };
+
+      // Queue the next recorded indication of the service (if any)
+      void QueueNextIndication();
+
+      // Wait until no receive completion is running
+      void WaitForDispatch();
+
+      /* Capture being replayed (may be 0) */
+      const cCommReplayCapture * mpCapture;
+
+      /* Indication replay speed factor */
+      double mSpeed;
+
+      /* Response delay (milliseconds) */
+      ULONG mResponseDelay;
+
+      /* QMI service (learnt through the service IOCTL) */
+      eQMIService mService;
+
+      /* Responses waiting to be received (due in order) */
+      std::deque <sPendingRx> mResponses;
+
+      /* Hold responses until released? */
+      bool mbHoldResponses;
+
+      /* Responses held (in transmission order) */
+      std::deque <sPendingRx> mHeldResponses;
+
+      /* Next indication to be received (mDue == 0 for none) */
+      sPendingRx mIndication;
+
+      /* Capture index of the record after the above indication */
+      ULONG mNextRecord;
+
+      /* Capture time and tick the indication replay started at */
+      time_t mReplayStartTime;
+      ULONGLONG mReplayStartTick;
+
+      /* Receive buffer, size and callback of the pending RxData() */
+      BYTE * mpRxBuf;
+      ULONG mRxBufSz;
+      cIOCallback * mpRxCallback;
+
+      /* Is a receive pending? */
+      bool mbRxPending;
+
+      /* ID of the delivery thread */
+      pthread_t mThreadID;
+
+      /* Is the delivery thread exiting? */
+      bool mbExiting;
+
+      /* Is a receive completion currently running? */
+      bool mbDispatching;
+
+      /* Mutex protecting all of the above */
+      pthread_mutex_t mMutex;
+
+      /* Signalled when there may be something to deliver */
+      pthread_cond_t mWake;
+
+      /* Signalled when a receive completion is done */
+      pthread_cond_t mDispatchDone;
+
+      /* Signalled when a response is held */
+      pthread_cond_t mHeld;
+
+      // Delivery thread gets full access
+      friend void * ReplayThread( PVOID pArg );
+};
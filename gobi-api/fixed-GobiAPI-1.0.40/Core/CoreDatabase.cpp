@@ -44,9 +44,13 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "StdAfx.h"
 
 #include "CoreDatabase.h"
+#include "DB2Image.h"
 #include "DB2NavTree.h"
+#include "ProtocolEntityFieldEnumerator.h"
 
 #include "CoreUtilities.h"
+#include "CRC.h"
+#include "MemoryMappedFile.h"
 
 //---------------------------------------------------------------------------
 // Definitions
@@ -62,6 +66,14 @@ LPCSTR DB2_FILE_PROTOCOL_ENTITY  = "Entity.txt";
 LPCSTR DB2_FILE_ENUM_MAIN        = "Enum.txt";
 LPCSTR DB2_FILE_ENUM_ENTRY       = "EnumEntry.txt";
 
+// Precompiled database image file name
+LPCSTR DB2_FILE_IMAGE            = "QMIDB.img";
+
+// Installed location of the precompiled database image
+#ifndef DB2_IMAGE_PATH
+#define DB2_IMAGE_PATH "/usr/share/gobi/QMIDB.img"
+#endif
+
 // Database table file names
 LPCSTR DB2_TABLE_PROTOCOL_FIELD  = "Field";
 LPCSTR DB2_TABLE_PROTOCOL_STRUCT = "Struct";
@@ -84,247 +96,357 @@ const ULONG MAX_NESTING_LEVEL = 32;
 // The default logger (for backwards compatibility)
 cDB2TraceLog gDB2DefaultLog;
 
+// Precompiled database image magic ('DB2I') and format version
+const UINT DB2_IMAGE_MAGIC   = 0x49324244;
+const UINT DB2_IMAGE_VERSION = 2;
+
+// Number of embedded text tables an image is compiled against
+const ULONG DB2_IMAGE_TEXT_COUNT = 5;
+
 /*=========================================================================*/
-// Free Methods
+// Precompiled database image layout
+//
+//    The image is a header followed by flat arrays of fixed size records,
+//    each sorted by table key (see DB2Image.h), and a string pool.  All 
+//    references are offsets from the start of the pool (strings) or 
+//    indices into an array (entity IDs), so the image can be mapped at 
+//    any address
 /*=========================================================================*/
+struct sDB2ImageTable
+{
+   /* Offset of first record from start of image */
+   UINT mOffset;
 
-/*===========================================================================
-METHOD:
-   CopyQuotedString (Public Method)
+   /* Number of records */
+   UINT mCount;
+};
 
-DESCRIPTION:
-   Convert a string (in quotes) to a string (minus) quotes and copy
-   into an allocated buffer
-  
-PARAMETERS:
-   pString     [ I ] - The string being de-quoted/copied
+struct sDB2ImageText
+{
+   /* Size of the embedded text table (in bytes) */
+   UINT mSize;
 
-RETURN VALUE:
-   LPSTR: The copy (returns 0 upon error)
-===========================================================================*/
-LPCSTR CopyQuotedString( LPSTR pString )
+   /* CRC of the embedded text table */
+   UINT mCRC;
+};
+
+struct sDB2ImageHeader
 {
-   // Get string length
-   ULONG len = (ULONG)strlen( pString );
+   /* DB2_IMAGE_MAGIC */
+   UINT mMagic;
 
-   // Adjust to remove trailing spaces
-   while (len > 0 && pString[len - 1] == ' ')
-   {
-      pString[len - 1] = 0;
-      len--;
-   }
+   /* DB2_IMAGE_VERSION */
+   UINT mVersion;
 
-   // Long enough (and quoted?)
-   if ( (len >= 2)
-   &&   (pString[0] == '\"')
-   &&   (pString[len - 1] == '\"') )
-   {
-      if (len == 2)
-      {
-         return EMPTY_STRING;
-      }
-      else
-      {
-         // Attempt to allocate a copy
-         LPSTR pRet = new char[len - 1];
-         if (pRet != 0)
-         {  
-            ULONG bytes = (len - 2) * sizeof( char );
-            memcpy( (PVOID)pRet, (LPCVOID)&pString[1], (SIZE_T)bytes );
-            pRet[len - 2] = 0;
+   /* Total size of image (in bytes) */
+   UINT mSize;
 
-            return pRet;
-         }
-      }
-   }
+   /* The embedded text tables the image was compiled against (Field,
+      Struct, Entity, Enum and Enum Entry, see GetEmbeddedText()) */
+   sDB2ImageText mText[DB2_IMAGE_TEXT_COUNT];
 
-   return 0;
-}
+   /* Record arrays */
+   sDB2ImageTable mEntities;
+   sDB2ImageTable mEntityNames;
+   sDB2ImageTable mEntityIDs;
+   sDB2ImageTable mFragments;
+   sDB2ImageTable mFields;
+   sDB2ImageTable mEnums;
+   sDB2ImageTable mEnumEntries;
+
+   /* String pool (mCount is the size in bytes) */
+   sDB2ImageTable mStrings;
+};
 
 /*=========================================================================*/
-// sDB2ProtocolEntity Methods
+// Class cDB2ImageWriter
+//
+//    Helper used by cCoreDatabase::SaveImage() to lay out an image
 /*=========================================================================*/
+class cDB2ImageWriter
+{
+   public:
+      // Constructor
+      cDB2ImageWriter()
+      {
+         // String offset 0 is the empty string
+         mStrings.push_back( 0 );
+      };
 
-/*===========================================================================
-METHOD:
-   FromString (Public Method)
+      // Add a string to the pool (duplicates are shared)
+      UINT AddString( LPCSTR pStr )
+      {
+         if (pStr == 0 || pStr[0] == 0)
+         {
+            return 0;
+         }
 
-DESCRIPTION:
-   Populate this object from a string
+         std::string str = pStr;
+         std::map <std::string, UINT>::const_iterator pIter;
+         pIter = mStringOffsets.find( str );
+         if (pIter != mStringOffsets.end())
+         {
+            return pIter->second;
+         }
 
-PARAMETERS:
-   pStr        [ I ] - String to populate object from
-  
-RETURN VALUE:
-   bool
-===========================================================================*/
-bool sDB2ProtocolEntity::FromString( LPSTR pStr )
-{
-   bool bRC = false;
+         UINT offset = (UINT)mStrings.size();
+         mStrings.insert( mStrings.end(), str.begin(), str.end() );
+         mStrings.push_back( 0 );
 
-   // Should be
-   //   0: Type
-   //   1: "Key"
-   //   2: "Name"
-   //   3: Struct ID
-   //   4: Format specifier ID (optional)
-   //   5: Internal only flag (optional)
-   //   6: Extended format specifier ID (optional)
-   const ULONG NUM_REQ_VALS = 4;
-   
-   std::vector <LPSTR> tokens; 
-   ParseTokens( DB2_VALUE_SEP, pStr, tokens );
+         mStringOffsets[str] = offset;
+         return offset;
+      };
 
-   ULONG toks = (ULONG)tokens.size();
-   if (toks >= NUM_REQ_VALS)
-   {    
-      // Remove quotes from name string and copy
-      LPCSTR pCopy = CopyQuotedString( tokens[2] );
-      if (pCopy != 0)
-      {      
-         mpName    = pCopy;
-         mType     = (eDB2EntityType)strtol( tokens[0], 0, 10 );
+      // Append a record array to the image body
+      template <class Record>
+      void AddTable( 
+         const std::vector <Record> &  records,
+         sDB2ImageTable &              table )
+      {
+         table.mOffset = (UINT)(sizeof( sDB2ImageHeader ) + mBody.size());
+         table.mCount = (UINT)records.size();
+         if (records.size() > 0)
+         {
+            const BYTE * pData = (const BYTE *)&records[0];
+            mBody.insert( mBody.end(), 
+                          pData, 
+                          pData + records.size() * sizeof( Record ) );
+         }
+      };
 
-         // Convert key/populate ID
-         mID.push_back( (ULONG)mType );
-         CSVStringToContainer( DB2_SUBVAL_SEP, tokens[1], mID, false );    
+      /* Image body (record arrays) */
+      std::vector <BYTE> mBody;
 
-         mStructID = strtol( tokens[3], 0, 10  );
-         
-         // Format specifier?
-         if (toks > NUM_REQ_VALS)
+      /* String pool */
+      std::vector <char> mStrings;
+
+      /* String pool offsets, indexed by string */
+      std::map <std::string, UINT> mStringOffsets;
+};
+
+/*=========================================================================*/
+// Class cDB2BufferedLog
+//
+//    Status log that holds on to what it is given, used so a table can be
+//    loaded on its own thread and its status replayed (in order) into the
+//    database log afterwards
+/*=========================================================================*/
+class cDB2BufferedLog : public cDB2StatusLog
+{
+   public:
+      // (Inline) Log an error string
+      virtual void Log( 
+         LPCSTR                     pLog,
+         eDB2StatusLevel            lvl = eDB2_STATUS_ERROR )
+      {
+         if (pLog != 0 && pLog[0] != 0)
          {
-            mFormatID = strtol( tokens[NUM_REQ_VALS], 0, 10  );
+            mEntries.push_back( tEntry( std::string( pLog ), lvl ) );
          }
+      };
 
-         // Internal only flag?
-         if (toks > NUM_REQ_VALS + 1)
+      // (Inline) Log an error string
+      virtual void Log( 
+         const std::string &        log,
+         eDB2StatusLevel            lvl = eDB2_STATUS_ERROR )
+      {
+         if (log.size() > 0)
          {
-            mbInternal = (strtoul( tokens[NUM_REQ_VALS + 1], 0, 10 ) != 0);
+            mEntries.push_back( tEntry( log, lvl ) );
          }
+      };
 
-         // Extended format specifier ID?
-         if (toks > NUM_REQ_VALS + 2)
+      // (Inline) Pass everything logged on to the given log
+      void Replay( cDB2StatusLog & log ) const
+      {
+         for (ULONG e = 0; e < (ULONG)mEntries.size(); e++)
          {
-            mFormatExID = strtol( tokens[NUM_REQ_VALS + 2], 0, 10 );
+            log.Log( mEntries[e].first, mEntries[e].second );
          }
+      };
 
-         bRC = IsValid();
-      }
-   }
+   protected:
+      /* A logged string and its status level */
+      typedef std::pair <std::string, eDB2StatusLevel> tEntry;
 
-   return bRC;
-}
+      /* Everything logged, in order */
+      std::vector <tEntry> mEntries;
+};
+
+/*=========================================================================*/
+// Struct sDB2TableLoad
+//
+//    A single table load, as run by cCoreDatabase::LoadTables()
+/*=========================================================================*/
+struct sDB2TableLoad
+{
+   public:
+      // (Inline) Default constructor
+      sDB2TableLoad()
+         :  mpTable( 0 ),
+            mpLoad( 0 ),
+            mpStart( 0 ),
+            mSize( 0 ),
+            mpName( 0 ),
+            mbThread( false ),
+            mbRC( false )
+      { };
+
+      // (Inline) Load a table from a file
+      template <class Container>
+      void SetFile( 
+         Container &                cont,
+         const std::string &        file,
+         LPCSTR                     pName )
+      {
+         mpTable = (PVOID)&cont;
+         mpLoad = &LoadTable <Container>;
+         mFile = file;
+         mpName = pName;
+      };
+
+      // (Inline) Load a table from internal (linked in) text
+      template <class Container>
+      void SetText( 
+         Container &                cont,
+         const char *               pStart,
+         const char *               pEnd,
+         LPCSTR                     pName )
+      {
+         mpTable = (PVOID)&cont;
+         mpLoad = &LoadTable <Container>;
+         mpStart = pStart;
+         mSize = (int)(pEnd - pStart);
+         mpName = pName;
+      };
+
+      // (Inline) Load the table, logging to our own log
+      template <class Container>
+      static bool LoadTable( sDB2TableLoad & load )
+      {
+         Container & cont = *(Container *)load.mpTable;
+         if (load.mpStart != 0)
+         {
+            return LoadDB2Table( load.mpStart, 
+                                 load.mSize, 
+                                 cont, 
+                                 false, 
+                                 load.mpName, 
+                                 load.mLog );
+         }
+
+         return LoadDB2Table( (LPCSTR)load.mFile.c_str(), 
+                              cont, 
+                              false, 
+                              load.mpName, 
+                              load.mLog );
+      };
+
+      /* The table being loaded */
+      PVOID mpTable;
+
+      /* Loader for the above table's type */
+      bool (* mpLoad)( sDB2TableLoad & );
+
+      /* File to load from (when not loading internal text) */
+      std::string mFile;
+
+      /* Internal text to load from (0 = load from file) */
+      const char * mpStart;
+
+      /* Size of above text */
+      int mSize;
+
+      /* Table name (for error reporting) */
+      LPCSTR mpName;
+
+      /* Status of the load, replayed once all loads have finished */
+      cDB2BufferedLog mLog;
+
+      /* Loading thread */
+      pthread_t mThread;
+
+      /* Was the above thread started? */
+      bool mbThread;
+
+      /* Load result */
+      bool mbRC;
+};
 
 /*===========================================================================
 METHOD:
-   IsValid (Public Method)
+   TableLoadThread (Free Method)
 
 DESCRIPTION:
-   Is this object valid?
+   Thread that loads a single database table
   
+PARAMETERS:
+   pData       [ I ] - The table load (sDB2TableLoad)
+
 RETURN VALUE:
-   bool
+   void * - thread exit value (always 0)
 ===========================================================================*/
-bool sDB2ProtocolEntity::IsValid() const
+static void * TableLoadThread( PVOID pData )
 {
-   // The type has to be valid
-   if (::IsValid( mType ) == false)
-   {
-      return false;
-   }
-
-   // The ID must consists of at least two entries
-   if (mID.size() < 2)
-   {
-      return false;
-   }
-
-   // The first entry in the ID has to be the type
-   if (mID[0] != (ULONG)mType)
-   {
-      return false;
-   }
-
-   // The structure ID has to be >= -1)
-   if (mStructID < -1)
-   {
-      return false;
-   }      
-
-   // The format specifier has to be >= -1)
-   if (mFormatID < -1)
-   {
-      return false;
-   }      
-
-   // There has to be a non-empty name
-   if (mpName == 0 || mpName[0] == 0)
+   sDB2TableLoad * pLoad = (sDB2TableLoad *)pData;
+   if (pLoad != 0)
    {
-      return false;
+      pLoad->mbRC = pLoad->mpLoad( *pLoad );
    }
 
-   return true;
+   return 0;
 }
 
-/*=========================================================================*/
-// sDB2Fragment Methods
-/*=========================================================================*/
-
 /*===========================================================================
 METHOD:
-   FromString (Public Method)
+   RunTableLoads (Free Method)
 
 DESCRIPTION:
-   Populate this object from a string
+   Run the given table loads, each on its own thread (the tables are
+   independent of each other), then pass on their status in load order
 
-PARAMETERS:
-   pStr        [ I ] - String to populate object from
+   NOTE: A load whose thread cannot be started is run on this thread
   
+PARAMETERS:
+   pLoads      [I/O] - The table loads
+   loadCount   [ I ] - Number of above table loads
+   log         [I/O] - Where to log errors
+
 RETURN VALUE:
-   bool
+   bool - Did every table load?
 ===========================================================================*/
-bool sDB2Fragment::FromString( LPSTR pStr )
+static bool RunTableLoads( 
+   sDB2TableLoad *            pLoads,
+   ULONG                      loadCount,
+   cDB2StatusLog &            log )
 {
-   bool bRC = false;
-
-   // Should be 
-   //    0: ID
-   //    1: Order
-   //    2: Type
-   //    3: Val
-   //    4: "Name"
-   //    5: Offset
-   //    6: Mod Type
-   //    7: "Mod Value"
-   const ULONG NUM_REQ_VALS = 8;
-
-   std::vector <LPSTR> tokens; 
-   ParseTokens( DB2_VALUE_SEP, pStr, tokens );
-
-   ULONG toks = (ULONG)tokens.size();
-   if (toks >= NUM_REQ_VALS)
+   ULONG l;
+   for (l = 0; l < loadCount; l++)
    {
-      // Remove quotes from modifier value and copy
-      LPCSTR pVal = CopyQuotedString( tokens[7] );
-      if (pVal != 0)
+      sDB2TableLoad & load = pLoads[l];
+      int nRC = pthread_create( &load.mThread, 
+                                0, 
+                                TableLoadThread, 
+                                (PVOID)&load );
+
+      load.mbThread = (nRC == 0);
+      if (load.mbThread == false)
       {
-         // Remove quotes from name string and copy
-         LPCSTR pCopy = CopyQuotedString( tokens[4] );
-         if (pCopy != 0)
-         {
-            mStructID       = strtoul( tokens[0], 0, 10  );
-            mFragmentOrder  = strtoul( tokens[1], 0, 10  );
-            mFragmentValue  = strtoul( tokens[3], 0, 10  );
-            mFragmentOffset = strtol( tokens[5], 0, 10  );
-            mFragmentType   = (eDB2FragmentType)strtol( tokens[2], 0, 10 );
-            mModifierType   = (eDB2ModifierType)strtol( tokens[6], 0, 10 );;
-            mpModifierValue = pVal;
-            mpName          = pCopy;
+         TableLoadThread( (PVOID)&load );
+      }
+   }
 
-            bRC = IsValid();
-         }
+   bool bRC = true;
+   for (l = 0; l < loadCount; l++)
+   {
+      sDB2TableLoad & load = pLoads[l];
+      if (load.mbThread == true)
+      {
+         pthread_join( load.mThread, 0 );
       }
+
+      load.mLog.Replay( log );
+      bRC &= load.mbRC;
    }
 
    return bRC;
@@ -332,94 +454,155 @@ bool sDB2Fragment::FromString( LPSTR pStr )
 
 /*===========================================================================
 METHOD:
-   IsValid (Public Method)
+   GetImageTable (Free Method)
 
 DESCRIPTION:
-   Is this object valid?
+   Validate an image table against the image size and return a pointer
+   to the first record
   
+PARAMETERS:
+   pImage      [ I ] - Start of image
+   imageSz     [ I ] - Size of image
+   table       [ I ] - Table descriptor
+   recordSz    [ I ] - Size of a single record
+
 RETURN VALUE:
-   bool
+   const BYTE * - The first record (0 upon error, or for an empty table)
 ===========================================================================*/
-bool sDB2Fragment::IsValid() const
+static const BYTE * GetImageTable( 
+   const BYTE *               pImage,
+   ULONG                      imageSz,
+   const sDB2ImageTable &     table,
+   ULONG                      recordSz )
 {
-   // The fragment type has to be valid
-   if (::IsValid( mFragmentType ) == false)
+   if (table.mCount == 0)
    {
-      return false;
+      return 0;
    }
 
-   // The modifier type has to be valid
-   if (::IsValid( mModifierType ) == false)
+   unsigned long long endOffset = table.mOffset;
+   endOffset += (unsigned long long)table.mCount * recordSz;
+   if (table.mOffset % sizeof( UINT ) != 0 || endOffset > imageSz)
    {
-      return false;
+      return 0;
    }
 
-   // There has to be a name (possibly empty)
-   if (mpName == 0)
-   {
-      return false;
-   }
+   return pImage + table.mOffset;
+}
 
-   // There has to be a modifier value (possibly empty)
-   if (mpModifierValue == 0)
+/*===========================================================================
+METHOD:
+   GetEmbeddedText (Free Method)
+
+DESCRIPTION:
+   Describe the embedded text tables, so an image can be matched to the
+   tables it was compiled from (same sizes alone would let an edit that
+   keeps the length through)
+  
+PARAMETERS:
+   pText       [ O ] - DB2_IMAGE_TEXT_COUNT table descriptions
+
+RETURN VALUE:
+   None
+===========================================================================*/
+static void GetEmbeddedText( sDB2ImageText * pText )
+{
+   const char * pStart[DB2_IMAGE_TEXT_COUNT] =
    {
-      return false;
+      (const char*)&_binary_QMI_Field_txt_start,
+      (const char*)&_binary_QMI_Struct_txt_start,
+      (const char*)&_binary_QMI_Entity_txt_start,
+      (const char*)&_binary_QMI_Enum_txt_start,
+      (const char*)&_binary_QMI_EnumEntry_txt_start
+   };
+
+   const char * pEnd[DB2_IMAGE_TEXT_COUNT] =
+   {
+      (const char*)&_binary_QMI_Field_txt_end,
+      (const char*)&_binary_QMI_Struct_txt_end,
+      (const char*)&_binary_QMI_Entity_txt_end,
+      (const char*)&_binary_QMI_Enum_txt_end,
+      (const char*)&_binary_QMI_EnumEntry_txt_end
+   };
+
+   for (ULONG t = 0; t < DB2_IMAGE_TEXT_COUNT; t++)
+   {
+      pText[t].mSize = (UINT)(pEnd[t] - pStart[t]);
+      pText[t].mCRC = (UINT)CalculateCRC( (const BYTE *)pStart[t],
+                                          pText[t].mSize * 8 );
    }
+}
 
-   // Directives can only be given for the first fragment
-   if ( (mFragmentType == eDB2_FRAGMENT_MSB_2_LSB)
-   ||   (mFragmentType == eDB2_FRAGMENT_LSB_2_MSB) )
+/*===========================================================================
+METHOD:
+   GetImageString (Free Method)
+
+DESCRIPTION:
+   Map an image string offset to a string within the image string pool
+  
+PARAMETERS:
+   pPool       [ I ] - Start of string pool
+   poolSz      [ I ] - Size of string pool
+   offset      [ I ] - String offset
+   bOK         [I/O] - Cleared if the offset is outside the pool
+
+RETURN VALUE:
+   LPCSTR - The string (EMPTY_STRING for offset 0 or upon error)
+===========================================================================*/
+static LPCSTR GetImageString( 
+   LPCSTR                     pPool,
+   ULONG                      poolSz,
+   UINT                       offset,
+   bool &                     bOK )
+{
+   if (offset == 0)
    {
-      if (mFragmentOrder > 0)
-      {
-         return false;
-      }
+      return EMPTY_STRING;
    }
 
-   // Validate modifier
-   switch (mModifierType)
+   if (offset >= poolSz)
    {
-      case eDB2_MOD_NONE:
-         if (mpModifierValue != 0 && mpModifierValue[0] != 0)
-         {
-            // Modifier string needs to be empty
-            return false;
-         }
-         break;
+      bOK = false;
+      return EMPTY_STRING;
+   }
 
-      case eDB2_MOD_CONSTANT_ARRAY:
-      case eDB2_MOD_VARIABLE_ARRAY:
-      case eDB2_MOD_OPTIONAL:
-      case eDB2_MOD_VARIABLE_ARRAY2:
-      case eDB2_MOD_VARIABLE_ARRAY3:
-         if (mpModifierValue == 0 || mpModifierValue[0] == 0)
-         {
-            // Needs to be a modifier string
-            return false;
-         }
-         break;
+   return pPool + offset;
+}
 
-      case eDB2_MOD_VARIABLE_STRING1:
-      case eDB2_MOD_VARIABLE_STRING2:
-      case eDB2_MOD_VARIABLE_STRING3:
-         if (mpModifierValue == 0 || mpModifierValue[0] == 0)
-         {
-            // Needs to be a modifier string
-            return false;
-         }
+/*===========================================================================
+METHOD:
+   PackEntityKey (Free Method)
 
-         if (mFragmentType != eDB2_FRAGMENT_FIELD)
-         {
-            // Only valid when modifying fields (strings)
-            return false;
-         }
-         break;
+DESCRIPTION:
+   Pack a protocol entity key (type/service/message/TLV) into a single 
+   64-bit value for the entity hash index
+  
+PARAMETERS:
+   key         [ I ] - Protocol entity key
+   packed      [ O ] - Packed key
 
+RETURN VALUE:
+   bool - Can the key be packed?  (1 - 4 values each below 0x8000)
+===========================================================================*/
+static bool PackEntityKey( 
+   const std::vector <ULONG> &   key,
+   ULONGLONG &                   packed )
+{
+   ULONG count = (ULONG)key.size();
+   if (count == 0 || count > 4)
+   {
+      return false;
    }
 
-   if (mFragmentType == eDB2_FRAGMENT_CONSTANT_PAD && mFragmentValue == 0)
+   packed = (ULONGLONG)count << 60;
+   for (ULONG i = 0; i < count; i++)
    {
-      return false;
+      if (key[i] >= 0x8000)
+      {
+         return false;
+      }
+
+      packed |= (ULONGLONG)key[i] << (45 - (15 * i));
    }
 
    return true;
@@ -427,667 +610,1656 @@ bool sDB2Fragment::IsValid() const
 
 /*===========================================================================
 METHOD:
-   BuildCondition (Static Public Method)
+   HashEntityName (Free Method)
 
 DESCRIPTION:
-   Build a simple condition string
+   Case insensitive (FNV-1a) hash of a protocol entity name
   
 PARAMETERS:
-   id          [ I ] - Field ID
-   op          [ I ] - Operator
-   val         [ I ] - Value (or field ID)
-   bF2F        [ I ] - Field to field expression?
+   pName       [ I ] - Protocol entity name
 
 RETURN VALUE:
-   std::string
+   ULONGLONG
 ===========================================================================*/
-std::string sDB2Fragment::BuildCondition( 
-   ULONG                      id,
-   eDB2Operator               op,
-   LONGLONG                   val,
-   bool                       bF2F )
+static ULONGLONG HashEntityName( LPCSTR pName )
 {
-   std::ostringstream tmp;
-   
-   if (::IsValid( op ) == true)
+   ULONGLONG hash = 0xCBF29CE484222325ULL;
+   while (*pName != 0)
    {
-      if (bF2F == false)
-      {
-         switch (op)
-         {
-            case eDB2_OP_LT:
-               tmp << (UINT)id << " " << "<" << val;
-               break;
+      hash ^= (ULONGLONG)(BYTE)tolower( *pName++ );
+      hash *= 0x100000001B3ULL;
+   }
 
-            case eDB2_OP_LTE:
-               tmp << (UINT)id << " " << "<=" << val;
-               break;
+   return hash;
+}
 
-            case eDB2_OP_EQ:
-               tmp << (UINT)id << " " << "=" << val;
-               break;
+/*===========================================================================
+METHOD:
+   PackEnumKey (Free Method)
 
-            case eDB2_OP_NEQ:
-               tmp << (UINT)id << " " << "!=" << val;
-               break;
+DESCRIPTION:
+   Pack an enum ID/value pair into a single 64-bit value for the enum 
+   entry hash index
+  
+PARAMETERS:
+   enumID      [ I ] - Enum ID
+   enumVal     [ I ] - Enum value
+   packed      [ O ] - Packed key
 
-            case eDB2_OP_GTE:
-               tmp << (UINT)id << " " << ">=" << val;
-               break;
+RETURN VALUE:
+   bool - Can the key be packed?  (enum ID below 2^32)
+===========================================================================*/
+static bool PackEnumKey( 
+   ULONG                      enumID,
+   int                        enumVal,
+   ULONGLONG &                packed )
+{
+   if ((ULONGLONG)enumID > 0xFFFFFFFFULL)
+   {
+      return false;
+   }
 
-            case eDB2_OP_GT:
-               tmp << (UINT)id << " " << ">" << val;
-               break;
+   packed = ((ULONGLONG)enumID << 32) | (ULONGLONG)(UINT)enumVal;
+   return true;
+}
 
-            case eDB2_OP_DIV:
-               tmp << (UINT)id << " " << "%" << val;
-               break;
+/*===========================================================================
+METHOD:
+   FormatEnumValue (Free Method)
 
-            case eDB2_OP_NDIV:
-               tmp << (UINT)id << " " << "!%" << val;
-               break;
-         }
+DESCRIPTION:
+   Format an enum value that could not be mapped to a name
+
+PARAMETERS:
+   pEnumName   [ I ] - Name of the enumeration (0 = simple format)
+   enumVal     [ I ] - Enum value
+   bHex        [ I ] - Hexadecimal output?
+   pBuf        [ O ] - Buffer to format into
+   bufLen      [ I ] - Size of above buffer (in bytes)
+
+RETURN VALUE:
+   LPCSTR - pBuf
+===========================================================================*/
+static LPCSTR FormatEnumValue( 
+   LPCSTR                     pEnumName,
+   int                        enumVal,
+   bool                       bHex,
+   CHAR *                     pBuf,
+   ULONG                      bufLen )
+{
+   if (pEnumName == 0)
+   {
+      if (bHex == true)
+      {
+         snprintf( pBuf, (size_t)bufLen, "%#X", (UINT)enumVal );
       }
       else
       {
-         switch (op)
-         {
-            case eDB2_OP_LT:
-               tmp << (UINT)id << " " << "f<" << val;
-               break;
+         snprintf( pBuf, (size_t)bufLen, "%d", enumVal );
+      }
+   }
+   else
+   {
+      if (bHex == true)
+      {
+         snprintf( pBuf, 
+                   (size_t)bufLen, 
+                   "Unknown [%s/%#X", 
+                   pEnumName, 
+                   (UINT)enumVal );
+      }
+      else
+      {
+         snprintf( pBuf, 
+                   (size_t)bufLen, 
+                   "Unknown [%s/%d", 
+                   pEnumName, 
+                   enumVal );
+      }
+   }
 
-            case eDB2_OP_LTE:
-               tmp << (UINT)id << " " << "f<=" << val;
-               break;
+   return pBuf;
+}
 
-            case eDB2_OP_EQ:
-               tmp << (UINT)id << " " << "f=" << val;
-               break;
+/*===========================================================================
+METHOD:
+   HeapBlockSize (Free Method)
 
-            case eDB2_OP_NEQ:
-               tmp << (UINT)id << " " << "f!=" << val;
-               break;
+DESCRIPTION:
+   Approximate the size of the heap block backing an allocation, i.e. 
+   the request plus the allocator header, rounded up to the allocator 
+   alignment (as glibc malloc does)
+  
+PARAMETERS:
+   sz          [ I ] - Requested size (in bytes)
 
-            case eDB2_OP_GTE:
-               tmp << (UINT)id << " " << "f>=" << val;
-               break;
+RETURN VALUE:
+   ULONG
+===========================================================================*/
+static ULONG HeapBlockSize( size_t sz )
+{
+   const size_t align = 2 * sizeof( size_t );
+   const size_t minBlock = 4 * sizeof( size_t );
 
-            case eDB2_OP_GT:
-               tmp << (UINT)id << " " << "f>" << val;
-               break;
+   size_t block = (sz + sizeof( size_t ) + align - 1) & ~(align - 1);
+   if (block < minBlock)
+   {
+      block = minBlock;
+   }
 
-            case eDB2_OP_DIV:
-               tmp << (UINT)id << " " << "f%" << val;
-               break;
+   return (ULONG)block;
+}
 
-            case eDB2_OP_NDIV:
-               tmp << (UINT)id << " " << "f!%" << val;
-               break;
-         }
-      }
-   }
+/*===========================================================================
+METHOD:
+   MapNodeBytes (Free Method)
 
-   std::string retStr = tmp.str();
+DESCRIPTION:
+   Approximate the heap used by the nodes of a map/multimap, each node
+   is a separate allocation holding the red/black tree links (color, 
+   parent, left, right) and the value
+  
+PARAMETERS:
+   cont        [ I ] - The map
 
-   return retStr;
+RETURN VALUE:
+   ULONG
+===========================================================================*/
+template <class Container>
+static ULONG MapNodeBytes( const Container & cont )
+{
+   size_t nodeSz = 4 * sizeof( LPVOID ) + sizeof( typename Container::value_type );
+   return (ULONG)cont.size() * HeapBlockSize( nodeSz );
 }
 
 /*===========================================================================
 METHOD:
-   EvaluateCondition (Static Public Method)
+   VectorBytes (Free Method)
 
 DESCRIPTION:
-   Evaluate a simple condition
+   Approximate the heap used by the storage of a vector
   
 PARAMETERS:
-   valA        [ I ] - Left value
-   op          [ I ] - Operator
-   valB        [ I ] - Right value
+   vec         [ I ] - The vector
 
 RETURN VALUE:
-   bool
+   ULONG
 ===========================================================================*/
-bool sDB2Fragment::EvaluateCondition( 
-   LONGLONG                   valA,
-   eDB2Operator               op,
-   LONGLONG                   valB )
+template <class T>
+static ULONG VectorBytes( const std::vector <T> & vec )
 {
-   bool bOK = false;
-   if (::IsValid( op ) == true)
+   if (vec.capacity() == 0)
    {
-      switch (op)
-      {
-         case eDB2_OP_LT:
-            bOK = (valA < valB);
-            break;
+      return 0;
+   }
 
-         case eDB2_OP_LTE:
-            bOK = (valA <= valB);
-            break;
+   return HeapBlockSize( vec.capacity() * sizeof( T ) );
+}
 
-         case eDB2_OP_EQ:
-            bOK = (valA == valB);
-            break;
+/*===========================================================================
+METHOD:
+   StringBytes (Free Method)
 
-         case eDB2_OP_NEQ:
-            bOK = (valA != valB);
-            break;
+DESCRIPTION:
+   Approximate the heap used by an allocated table string
+  
+PARAMETERS:
+   pStr        [ I ] - The string
 
-         case eDB2_OP_GTE:
-            bOK = (valA >= valB);
-            break;
+RETURN VALUE:
+   ULONG
+===========================================================================*/
+static ULONG StringBytes( LPCSTR pStr )
+{
+   if (pStr == 0 || pStr == EMPTY_STRING)
+   {
+      return 0;
+   }
 
-         case eDB2_OP_GT:
-            bOK = (valA > valB);
-            break;
+   return HeapBlockSize( strlen( pStr ) + 1 );
+}
 
-         case eDB2_OP_DIV:
-            bOK = ((valA % valB) == 0);
-            break;
+/*===========================================================================
+METHOD:
+   ArenaString (Free Method)
 
-         case eDB2_OP_NDIV:
-            bOK = ((valA % valB) != 0);
-            break;
-      }
+DESCRIPTION:
+   Map a string to its copy in a string arena laid out from the given
+   string pool (the string must have been added to the pool already)
+  
+PARAMETERS:
+   pool        [ I ] - String pool the arena was copied from
+   pArena      [ I ] - String arena
+   pStr        [ I ] - The string
+
+RETURN VALUE:
+   LPCSTR - The arena copy (EMPTY_STRING for empty strings)
+===========================================================================*/
+static LPCSTR ArenaString( 
+   cDB2ImageWriter &          pool,
+   LPCSTR                     pArena,
+   LPCSTR                     pStr )
+{
+   UINT offset = pool.AddString( pStr );
+   if (offset == 0)
+   {
+      return EMPTY_STRING;
    }
 
-   return bOK;
+   return pArena + offset;
 }
 
 /*===========================================================================
 METHOD:
-   ParseCondition (Static Public Method)
+   MoveToArena (Free Method)
 
 DESCRIPTION:
-   Parse a simple condition
+   Point a table string at its copy in a string arena, releasing the
+   string the record allocated
   
 PARAMETERS:
-   pCondition  [ I ] - Condition string
-   id          [ O ] - Field ID
-   op          [ O ] - Operator
-   val         [ O ] - Value (or field ID)
-   bF2F        [ O ] - Field to field expression?
+   pool        [ I ] - String pool the arena was copied from
+   pArena      [ I ] - String arena
+   pStr        [I/O] - The string
 
 RETURN VALUE:
-   bool
+   None
 ===========================================================================*/
-bool sDB2Fragment::ParseCondition( 
-   LPCSTR                     pCondition,
-   ULONG &                    id,
-   eDB2Operator &             op,
-   LONGLONG &                 val,
-   bool &                     bF2F )
+static void MoveToArena( 
+   cDB2ImageWriter &          pool,
+   LPCSTR                     pArena,
+   LPCSTR &                   pStr )
 {
-   // Assume error
-   bool bOK = false;
-
-   // Even a condition to start with?
-   if (pCondition == 0 || pCondition == EMPTY_STRING)
+   LPCSTR pCopy = ArenaString( pool, pArena, pStr );
+   if (pStr != 0 && pStr != EMPTY_STRING)
    {
-      return bOK;
+      delete [] pStr;
    }
 
-   // Parse condition to tokens (field ID operator value)
-   int nSize = strlen( pCondition ) + 1;
-   
-   char * pCopy = new char[ nSize ];
-   if (pCopy == NULL)
+   pStr = pCopy;
+}
+
+/*=========================================================================*/
+// Free Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   CopyQuotedString (Public Method)
+
+DESCRIPTION:
+   Convert a string (in quotes) to a string (minus) quotes and copy
+   into an allocated buffer
+  
+PARAMETERS:
+   pString     [ I ] - The string being de-quoted/copied
+
+RETURN VALUE:
+   LPSTR: The copy (returns 0 upon error)
+===========================================================================*/
+LPCSTR CopyQuotedString( LPSTR pString )
+{
+   // Get string length
+   ULONG len = (ULONG)strlen( pString );
+
+   // Adjust to remove trailing spaces
+   while (len > 0 && pString[len - 1] == ' ')
    {
-      return false;
+      pString[len - 1] = 0;
+      len--;
    }
-   
-   memcpy( pCopy, pCondition, nSize );
-   
-   std::vector <LPSTR> tokens; 
-   ParseTokens( " ", pCopy, tokens );
 
-   if (tokens.size() == 3)
+   // Long enough (and quoted?)
+   if ( (len >= 2)
+   &&   (pString[0] == '\"')
+   &&   (pString[len - 1] == '\"') )
    {
-      // Covert first token to field ID
-      ULONG fieldID = strtoul( tokens[0], 0, 10 );
-
-      // Grab the value for the given field ID
-      LONGLONG fieldVal = 0;
-      bOK = StringToLONGLONG( tokens[2], 0, fieldVal );
-      if (bOK == true)
+      if (len == 2)
       {
-         std::string opStr = tokens[1];
-         
-         // std::string version of Trim()
-         int nFirst = opStr.find_first_not_of( ' ' );
-         int nLast = opStr.find_last_not_of( ' ' );
-         if (nFirst == -1 || nLast == -1)
-         {
-            // Something went horribly wrong, empty string or all spaces
-            delete [] pCopy;
-            return false;
-         }
-         
-         opStr = opStr.substr( nFirst, nLast - nFirst + 1 );
-         
-         // std::string version of MakeLower()
-         transform( opStr.begin(), opStr.end(), opStr.begin(), tolower );
-
-         bF2F = false;
-         if (opStr == "<")
-         {
-            op = eDB2_OP_LT;
-         }
-         else if (opStr == "<=")
-         {
-            op = eDB2_OP_LTE;
-         }
-         else if (opStr == "=")
-         {
-            op = eDB2_OP_EQ;
-         }
-         else if (opStr == "!=")
-         {
-            op = eDB2_OP_NEQ;
-         }
-         else if (opStr == ">=")
-         {
-            op = eDB2_OP_GTE;
-         }
-         else if (opStr == ">")
-         {
-            op = eDB2_OP_GT;
-         }
-         else if (opStr == "%")
-         {
-            op = eDB2_OP_DIV;
-         }
-         else if (opStr == "!%")
-         {
-            op = eDB2_OP_NDIV;
-         }
-         else if (opStr == "f<")
-         {
-            bF2F = true;
-            op = eDB2_OP_LT;
-         }
-         else if (opStr == "f<=")
-         {
-            bF2F = true;
-            op = eDB2_OP_LTE;
-         }
-         else if (opStr == "f=")
-         {
-            bF2F = true;
-            op = eDB2_OP_EQ;
-         }
-         else if (opStr == "f!=")
-         {
-            bF2F = true;
-            op = eDB2_OP_NEQ;
-         }
-         else if (opStr == "f>=")
-         {
-            bF2F = true;
-            op = eDB2_OP_GTE;
-         }
-         else if (opStr == "f>")
-         {
-            bF2F = true;
-            op = eDB2_OP_GT;
-         }
-         else if (opStr == "f%")
-         {
-            bF2F = true;
-            op = eDB2_OP_DIV;
-         }
-         else if (opStr == "f!%")
-         {
-            bF2F = true;
-            op = eDB2_OP_NDIV;
-         }
-         else
-         {
-            bOK = false;
-         }
+         return EMPTY_STRING;
+      }
+      else
+      {
+         // Attempt to allocate a copy
+         LPSTR pRet = new char[len - 1];
+         if (pRet != 0)
+         {  
+            ULONG bytes = (len - 2) * sizeof( char );
+            memcpy( (PVOID)pRet, (LPCVOID)&pString[1], (SIZE_T)bytes );
+            pRet[len - 2] = 0;
 
-         if (bOK == true)
-         {
-            id = fieldID;
-            val = fieldVal;
+            return pRet;
          }
       }
    }
 
-   delete [] pCopy;
-   
-   return bOK;
+   return 0;
 }
 
+/*=========================================================================*/
+// sDB2ProtocolEntity Methods
+/*=========================================================================*/
+
 /*===========================================================================
 METHOD:
-   BuildExpression (Static Public Method)
+   FromString (Public Method)
 
 DESCRIPTION:
-   Build a simple expression string
-  
-PARAMETERS:
-   id          [ I ] - Field ID
-   op          [ I ] - Operator
-   val         [ I ] - Value (or field ID)
-   bF2F        [ I ] - Field to field expression?
+   Populate this object from a string
 
+PARAMETERS:
+   pStr        [ I ] - String to populate object from
+  
 RETURN VALUE:
-   std::string
+   bool
 ===========================================================================*/
-std::string sDB2Fragment::BuildExpression( 
-   ULONG                      id,
-   eDB2ExpOperator            op,
-   LONGLONG                   val,
-   bool                       bF2F )
+bool sDB2ProtocolEntity::FromString( LPSTR pStr )
 {
-   std::ostringstream tmp;
+   bool bRC = false;
 
-   if (::IsValid( op ) == true)
-   {
-      if (bF2F == false)
-      {
-         switch (op)
-         {
-            case eDB2_EXPOP_ADD:
-               tmp << (UINT)id << " " << "+" << val;
-               break;
-
-            case eDB2_EXPOP_SUB:
-               tmp << (UINT)id << " " << "-" << val;
-               break;
-
-            case eDB2_EXPOP_MUL:
-               tmp << (UINT)id << " " << "*" << val;
-               break;
-
-            case eDB2_EXPOP_DIV:
-               tmp << (UINT)id << " " << "/" << val;
-               break;
+   // Should be
+   //   0: Type
+   //   1: "Key"
+   //   2: "Name"
+   //   3: Struct ID
+   //   4: Format specifier ID (optional)
+   //   5: Internal only flag (optional)
+   //   6: Extended format specifier ID (optional)
+   const ULONG NUM_REQ_VALS = 4;
+   
+   std::vector <LPSTR> tokens; 
+   ParseTokens( DB2_VALUE_SEP, pStr, tokens );
 
-            case eDB2_EXPOP_REM:
-               tmp << (UINT)id << " " << "%" << val;
-               break;
+   ULONG toks = (ULONG)tokens.size();
+   if (toks >= NUM_REQ_VALS)
+   {    
+      // Remove quotes from name string and copy
+      LPCSTR pCopy = CopyQuotedString( tokens[2] );
+      if (pCopy != 0)
+      {      
+         mpName    = pCopy;
+         mType     = (eDB2EntityType)strtol( tokens[0], 0, 10 );
 
-            case eDB2_EXPOP_MIN:
-               tmp << (UINT)id << " " << "min" << val;
-               break;
+         // Convert key/populate ID
+         mID.push_back( (ULONG)mType );
+         CSVStringToContainer( DB2_SUBVAL_SEP, tokens[1], mID, false );    
 
-            case eDB2_EXPOP_MAX:
-               tmp << (UINT)id << " " << "max" << val;
-               break;
-         }
-      }
-      else
-      {
-         switch (op)
+         mStructID = strtol( tokens[3], 0, 10  );
+         
+         // Format specifier?
+         if (toks > NUM_REQ_VALS)
          {
-            case eDB2_EXPOP_ADD:
-               tmp << (UINT)id << " " << "f+" << val;
-               break;
-
-            case eDB2_EXPOP_SUB:
-               tmp << (UINT)id << " " << "f-" << val;
-               break;
-
-            case eDB2_EXPOP_MUL:
-               tmp << (UINT)id << " " << "f*" << val;
-               break;
-
-            case eDB2_EXPOP_DIV:
-               tmp << (UINT)id << " " << "f/" << val;
-               break;
-
-            case eDB2_EXPOP_REM:
-               tmp << (UINT)id << " " << "f%" << val;
-               break;
+            mFormatID = strtol( tokens[NUM_REQ_VALS], 0, 10  );
+         }
 
-            case eDB2_EXPOP_MIN:
-               tmp << (UINT)id << " " << "fmin" << val;
-               break;
+         // Internal only flag?
+         if (toks > NUM_REQ_VALS + 1)
+         {
+            mbInternal = (strtoul( tokens[NUM_REQ_VALS + 1], 0, 10 ) != 0);
+         }
 
-            case eDB2_EXPOP_MAX:
-               tmp << (UINT)id << " " << "fmax" << val;
-               break;
+         // Extended format specifier ID?
+         if (toks > NUM_REQ_VALS + 2)
+         {
+            mFormatExID = strtol( tokens[NUM_REQ_VALS + 2], 0, 10 );
          }
+
+         bRC = IsValid();
       }
    }
 
-   std::string retStr = tmp.str();
-
-   return retStr;
+   return bRC;
 }
 
 /*===========================================================================
 METHOD:
-   EvaluateExpression (Static Public Method)
+   IsValid (Public Method)
 
 DESCRIPTION:
-   Evaluate a simple expression
+   Is this object valid?
   
-PARAMETERS:
-   valA        [ I ] - Left value
-   op          [ I ] - Operator
-   valB        [ I ] - Right value
-   res         [ O ] - Resulting value
-
 RETURN VALUE:
    bool
 ===========================================================================*/
-bool sDB2Fragment::EvaluateExpression( 
-   LONGLONG                   valA,
-   eDB2ExpOperator            op,
-   LONGLONG                   valB,
-   LONGLONG &                 res )
+bool sDB2ProtocolEntity::IsValid() const
 {
-   bool bOK = false;
-   if (::IsValid( op ) == true)
+   // The type has to be valid
+   if (::IsValid( mType ) == false)
    {
-      bOK = true;
-      switch (op)
-      {
-         case eDB2_EXPOP_ADD:
-            res = valA + valB;
-            break;
-
-         case eDB2_EXPOP_SUB:
-            res = valA - valB;
-            break;
-
-         case eDB2_EXPOP_MUL:
-            res = valA * valB;
-            break;
+      return false;
+   }
 
-         case eDB2_EXPOP_DIV:
-            res = valA / valB;
-            break;
+   // The ID must consists of at least two entries
+   if (mID.size() < 2)
+   {
+      return false;
+   }
 
-         case eDB2_EXPOP_REM:
-            res = valA % valB;
-            break;
+   // The first entry in the ID has to be the type
+   if (mID[0] != (ULONG)mType)
+   {
+      return false;
+   }
 
-         case eDB2_EXPOP_MIN:
-            res = valA;
-            if (valA > valB)
-            {
-               res = valB;
-            }
-            break;
+   // The structure ID has to be >= -1)
+   if (mStructID < -1)
+   {
+      return false;
+   }      
 
-         case eDB2_EXPOP_MAX:
-            res = valA;
-            if (valA < valB)
-            {
-               res = valB;
-            }
-            break;
+   // The format specifier has to be >= -1)
+   if (mFormatID < -1)
+   {
+      return false;
+   }      
 
-         default:
-            bOK = false;
-            break;
-      }
+   // There has to be a non-empty name
+   if (mpName == 0 || mpName[0] == 0)
+   {
+      return false;
    }
 
-   return bOK;
+   return true;
 }
 
+/*=========================================================================*/
+// sDB2Fragment Methods
+/*=========================================================================*/
+
 /*===========================================================================
 METHOD:
-   ParseExpression (Static Public Method)
+   FromString (Public Method)
 
 DESCRIPTION:
-   Parse a simple expression
-  
-PARAMETERS:
-   pExpr       [ I ] - Expression string
-   id          [ O ] - Field ID
-   op          [ O ] - Operator
-   val         [ O ] - Value (or Field ID)
-   bF2F        [ O ] - Field to field expression?
+   Populate this object from a string
 
+PARAMETERS:
+   pStr        [ I ] - String to populate object from
+  
 RETURN VALUE:
    bool
 ===========================================================================*/
-bool sDB2Fragment::ParseExpression( 
-   LPCSTR                    pExpr,
-   ULONG &                    id,
-   eDB2ExpOperator &          op,
-   LONGLONG &                 val,
-   bool &                     bF2F )
+bool sDB2Fragment::FromString( LPSTR pStr )
 {
-   // Assume error
-   bool bOK = false;
-
-   // Even a condition to start with?
-   if (pExpr == 0 || pExpr == EMPTY_STRING)
-   {
-      return bOK;
-   }
+   bool bRC = false;
 
-   // Parse condition to tokens (field ID operator value)
-   int nSize = strlen( pExpr ) + 1;
-   
-   char * pCopy = new char[ nSize ];
-   if (pCopy == NULL)
-   {
-      return false;
-   }
-   
-   memcpy( pCopy, pExpr, nSize );
+   // Should be 
+   //    0: ID
+   //    1: Order
+   //    2: Type
+   //    3: Val
+   //    4: "Name"
+   //    5: Offset
+   //    6: Mod Type
+   //    7: "Mod Value"
+   const ULONG NUM_REQ_VALS = 8;
 
    std::vector <LPSTR> tokens; 
-   ParseTokens( " ", pCopy, tokens );
+   ParseTokens( DB2_VALUE_SEP, pStr, tokens );
 
-   if (tokens.size() == 3)
+   ULONG toks = (ULONG)tokens.size();
+   if (toks >= NUM_REQ_VALS)
    {
-      // Covert first token to field ID
-      ULONG fieldID = strtoul( tokens[0], 0, 10 );
-
-      // Grab the value for the given field ID
-      LONGLONG fieldVal = 0;
-      bOK = StringToLONGLONG( tokens[2], 0, fieldVal );
-      if (bOK == true)
+      // Remove quotes from modifier value and copy
+      LPCSTR pVal = CopyQuotedString( tokens[7] );
+      if (pVal != 0)
       {
-         std::string opStr = tokens[1];
-         
-         // std::string version of Trim()
-         int nFirst = opStr.find_first_not_of( ' ' );
-         int nLast = opStr.find_last_not_of( ' ' );
-         if (nFirst == -1 || nLast == -1)
+         // Remove quotes from name string and copy
+         LPCSTR pCopy = CopyQuotedString( tokens[4] );
+         if (pCopy != 0)
          {
-            // Something went horribly wrong, empty string or all spaces
-            delete [] pCopy;
-            return false;
-         }
-         
-         opStr = opStr.substr( nFirst, nLast - nFirst + 1 );
-         
-         // std::string version of MakeLower()
-         transform( opStr.begin(), opStr.end(), opStr.begin(), tolower );
+            mStructID       = strtoul( tokens[0], 0, 10  );
+            mFragmentOrder  = strtoul( tokens[1], 0, 10  );
+            mFragmentValue  = strtoul( tokens[3], 0, 10  );
+            mFragmentOffset = strtol( tokens[5], 0, 10  );
+            mFragmentType   = (eDB2FragmentType)strtol( tokens[2], 0, 10 );
+            mModifierType   = (eDB2ModifierType)strtol( tokens[6], 0, 10 );;
+            mpModifierValue = pVal;
+            mpName          = pCopy;
 
-         bF2F = false;
-         if (opStr == "+")
-         {
-            op = eDB2_EXPOP_ADD;
-         }
-         else if (opStr == "-")
-         {
-            op = eDB2_EXPOP_SUB;
-         }
-         else if (opStr == "*")
-         {
-            op = eDB2_EXPOP_MUL;
-         }
-         else if (opStr == "/")
-         {
-            op = eDB2_EXPOP_DIV;
-         }
-         else if (opStr == "%")
-         {
-            op = eDB2_EXPOP_REM;
-         }
-         else if (opStr == "min")
-         {
-            op = eDB2_EXPOP_MIN;
-         }
-         else if (opStr == "max")
-         {
-            op = eDB2_EXPOP_MAX;
-         }
-         else if (opStr == "f+")
-         {
-            bF2F = true;
-            op = eDB2_EXPOP_ADD;
-         }
-         else if (opStr == "f-")
-         {
-            bF2F = true;
-            op = eDB2_EXPOP_SUB;
-         }
-         else if (opStr == "f*")
-         {
-            bF2F = true;
-            op = eDB2_EXPOP_MUL;
-         }
-         else if (opStr == "f/")
-         {
-            bF2F = true;
-            op = eDB2_EXPOP_DIV;
+            bRC = IsValid();
          }
-         else if (opStr == "f%")
+      }
+   }
+
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   IsValid (Public Method)
+
+DESCRIPTION:
+   Is this object valid?
+  
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool sDB2Fragment::IsValid() const
+{
+   // The fragment type has to be valid
+   if (::IsValid( mFragmentType ) == false)
+   {
+      return false;
+   }
+
+   // The modifier type has to be valid
+   if (::IsValid( mModifierType ) == false)
+   {
+      return false;
+   }
+
+   // There has to be a name (possibly empty)
+   if (mpName == 0)
+   {
+      return false;
+   }
+
+   // There has to be a modifier value (possibly empty)
+   if (mpModifierValue == 0)
+   {
+      return false;
+   }
+
+   // Directives can only be given for the first fragment
+   if ( (mFragmentType == eDB2_FRAGMENT_MSB_2_LSB)
+   ||   (mFragmentType == eDB2_FRAGMENT_LSB_2_MSB) )
+   {
+      if (mFragmentOrder > 0)
+      {
+         return false;
+      }
+   }
+
+   // Validate modifier
+   switch (mModifierType)
+   {
+      case eDB2_MOD_NONE:
+         if (mpModifierValue != 0 && mpModifierValue[0] != 0)
          {
-            bF2F = true;
-            op = eDB2_EXPOP_REM;
+            // Modifier string needs to be empty
+            return false;
          }
-         else if (opStr == "fmin")
+         break;
+
+      case eDB2_MOD_CONSTANT_ARRAY:
+      case eDB2_MOD_VARIABLE_ARRAY:
+      case eDB2_MOD_OPTIONAL:
+      case eDB2_MOD_VARIABLE_ARRAY2:
+      case eDB2_MOD_VARIABLE_ARRAY3:
+         if (mpModifierValue == 0 || mpModifierValue[0] == 0)
          {
-            bF2F = true;
-            op = eDB2_EXPOP_MIN;
+            // Needs to be a modifier string
+            return false;
          }
-         else if (opStr == "fmax")
+         break;
+
+      case eDB2_MOD_VARIABLE_STRING1:
+      case eDB2_MOD_VARIABLE_STRING2:
+      case eDB2_MOD_VARIABLE_STRING3:
+         if (mpModifierValue == 0 || mpModifierValue[0] == 0)
          {
-            bF2F = true;
-            op = eDB2_EXPOP_MAX;
+            // Needs to be a modifier string
+            return false;
          }
-         else
+
+         if (mFragmentType != eDB2_FRAGMENT_FIELD)
          {
-            bOK = false;
+            // Only valid when modifying fields (strings)
+            return false;
          }
+         break;
 
-         if (bOK == true)
+   }
+
+   if (mFragmentType == eDB2_FRAGMENT_CONSTANT_PAD && mFragmentValue == 0)
+   {
+      return false;
+   }
+
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   BuildCondition (Static Public Method)
+
+DESCRIPTION:
+   Build a simple condition string
+  
+PARAMETERS:
+   id          [ I ] - Field ID
+   op          [ I ] - Operator
+   val         [ I ] - Value (or field ID)
+   bF2F        [ I ] - Field to field expression?
+
+RETURN VALUE:
+   std::string
+===========================================================================*/
+std::string sDB2Fragment::BuildCondition( 
+   ULONG                      id,
+   eDB2Operator               op,
+   LONGLONG                   val,
+   bool                       bF2F )
+{
+   std::ostringstream tmp;
+   
+   if (::IsValid( op ) == true)
+   {
+      if (bF2F == false)
+      {
+         switch (op)
          {
-            id = fieldID;
-            val = fieldVal;
+            case eDB2_OP_LT:
+               tmp << (UINT)id << " " << "<" << val;
+               break;
+
+            case eDB2_OP_LTE:
+               tmp << (UINT)id << " " << "<=" << val;
+               break;
+
+            case eDB2_OP_EQ:
+               tmp << (UINT)id << " " << "=" << val;
+               break;
+
+            case eDB2_OP_NEQ:
+               tmp << (UINT)id << " " << "!=" << val;
+               break;
+
+            case eDB2_OP_GTE:
+               tmp << (UINT)id << " " << ">=" << val;
+               break;
+
+            case eDB2_OP_GT:
+               tmp << (UINT)id << " " << ">" << val;
+               break;
+
+            case eDB2_OP_DIV:
+               tmp << (UINT)id << " " << "%" << val;
+               break;
+
+            case eDB2_OP_NDIV:
+               tmp << (UINT)id << " " << "!%" << val;
+               break;
          }
       }
+      else
+      {
+         switch (op)
+         {
+            case eDB2_OP_LT:
+               tmp << (UINT)id << " " << "f<" << val;
+               break;
+
+            case eDB2_OP_LTE:
+               tmp << (UINT)id << " " << "f<=" << val;
+               break;
+
+            case eDB2_OP_EQ:
+               tmp << (UINT)id << " " << "f=" << val;
+               break;
+
+            case eDB2_OP_NEQ:
+               tmp << (UINT)id << " " << "f!=" << val;
+               break;
+
+            case eDB2_OP_GTE:
+               tmp << (UINT)id << " " << "f>=" << val;
+               break;
+
+            case eDB2_OP_GT:
+               tmp << (UINT)id << " " << "f>" << val;
+               break;
+
+            case eDB2_OP_DIV:
+               tmp << (UINT)id << " " << "f%" << val;
+               break;
+
+            case eDB2_OP_NDIV:
+               tmp << (UINT)id << " " << "f!%" << val;
+               break;
+         }
+      }
+   }
+
+   std::string retStr = tmp.str();
+
+   return retStr;
+}
+
+/*===========================================================================
+METHOD:
+   EvaluateCondition (Static Public Method)
+
+DESCRIPTION:
+   Evaluate a simple condition
+  
+PARAMETERS:
+   valA        [ I ] - Left value
+   op          [ I ] - Operator
+   valB        [ I ] - Right value
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool sDB2Fragment::EvaluateCondition( 
+   LONGLONG                   valA,
+   eDB2Operator               op,
+   LONGLONG                   valB )
+{
+   bool bOK = false;
+   if (::IsValid( op ) == true)
+   {
+      switch (op)
+      {
+         case eDB2_OP_LT:
+            bOK = (valA < valB);
+            break;
+
+         case eDB2_OP_LTE:
+            bOK = (valA <= valB);
+            break;
+
+         case eDB2_OP_EQ:
+            bOK = (valA == valB);
+            break;
+
+         case eDB2_OP_NEQ:
+            bOK = (valA != valB);
+            break;
+
+         case eDB2_OP_GTE:
+            bOK = (valA >= valB);
+            break;
+
+         case eDB2_OP_GT:
+            bOK = (valA > valB);
+            break;
+
+         case eDB2_OP_DIV:
+            bOK = ((valA % valB) == 0);
+            break;
+
+         case eDB2_OP_NDIV:
+            bOK = ((valA % valB) != 0);
+            break;
+      }
+   }
+
+   return bOK;
+}
+
+/*===========================================================================
+METHOD:
+   ParseCondition (Static Public Method)
+
+DESCRIPTION:
+   Parse a simple condition
+  
+PARAMETERS:
+   pCondition  [ I ] - Condition string
+   id          [ O ] - Field ID
+   op          [ O ] - Operator
+   val         [ O ] - Value (or field ID)
+   bF2F        [ O ] - Field to field expression?
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool sDB2Fragment::ParseCondition( 
+   LPCSTR                     pCondition,
+   ULONG &                    id,
+   eDB2Operator &             op,
+   LONGLONG &                 val,
+   bool &                     bF2F )
+{
+   // Assume error
+   bool bOK = false;
+
+   // Even a condition to start with?
+   if (pCondition == 0 || pCondition == EMPTY_STRING)
+   {
+      return bOK;
+   }
+
+   // Parse condition to tokens (field ID operator value)
+   int nSize = strlen( pCondition ) + 1;
+   
+   char * pCopy = new char[ nSize ];
+   if (pCopy == NULL)
+   {
+      return false;
+   }
+   
+   memcpy( pCopy, pCondition, nSize );
+   
+   std::vector <LPSTR> tokens; 
+   ParseTokens( " ", pCopy, tokens );
+
+   if (tokens.size() == 3)
+   {
+      // Covert first token to field ID
+      ULONG fieldID = strtoul( tokens[0], 0, 10 );
+
+      // Grab the value for the given field ID
+      LONGLONG fieldVal = 0;
+      bOK = StringToLONGLONG( tokens[2], 0, fieldVal );
+      if (bOK == true)
+      {
+         std::string opStr = tokens[1];
+         
+         // std::string version of Trim()
+         int nFirst = opStr.find_first_not_of( ' ' );
+         int nLast = opStr.find_last_not_of( ' ' );
+         if (nFirst == -1 || nLast == -1)
+         {
+            // Something went horribly wrong, empty string or all spaces
+            delete [] pCopy;
+            return false;
+         }
+         
+         opStr = opStr.substr( nFirst, nLast - nFirst + 1 );
+         
+         // std::string version of MakeLower()
+         transform( opStr.begin(), opStr.end(), opStr.begin(), tolower );
+
+         bF2F = false;
+         if (opStr == "<")
+         {
+            op = eDB2_OP_LT;
+         }
+         else if (opStr == "<=")
+         {
+            op = eDB2_OP_LTE;
+         }
+         else if (opStr == "=")
+         {
+            op = eDB2_OP_EQ;
+         }
+         else if (opStr == "!=")
+         {
+            op = eDB2_OP_NEQ;
+         }
+         else if (opStr == ">=")
+         {
+            op = eDB2_OP_GTE;
+         }
+         else if (opStr == ">")
+         {
+            op = eDB2_OP_GT;
+         }
+         else if (opStr == "%")
+         {
+            op = eDB2_OP_DIV;
+         }
+         else if (opStr == "!%")
+         {
+            op = eDB2_OP_NDIV;
+         }
+         else if (opStr == "f<")
+         {
+            bF2F = true;
+            op = eDB2_OP_LT;
+         }
+         else if (opStr == "f<=")
+         {
+            bF2F = true;
+            op = eDB2_OP_LTE;
+         }
+         else if (opStr == "f=")
+         {
+            bF2F = true;
+            op = eDB2_OP_EQ;
+         }
+         else if (opStr == "f!=")
+         {
+            bF2F = true;
+            op = eDB2_OP_NEQ;
+         }
+         else if (opStr == "f>=")
+         {
+            bF2F = true;
+            op = eDB2_OP_GTE;
+         }
+         else if (opStr == "f>")
+         {
+            bF2F = true;
+            op = eDB2_OP_GT;
+         }
+         else if (opStr == "f%")
+         {
+            bF2F = true;
+            op = eDB2_OP_DIV;
+         }
+         else if (opStr == "f!%")
+         {
+            bF2F = true;
+            op = eDB2_OP_NDIV;
+         }
+         else
+         {
+            bOK = false;
+         }
+
+         if (bOK == true)
+         {
+            id = fieldID;
+            val = fieldVal;
+         }
+      }
+   }
+
+   delete [] pCopy;
+   
+   return bOK;
+}
+
+/*===========================================================================
+METHOD:
+   BuildExpression (Static Public Method)
+
+DESCRIPTION:
+   Build a simple expression string
+  
+PARAMETERS:
+   id          [ I ] - Field ID
+   op          [ I ] - Operator
+   val         [ I ] - Value (or field ID)
+   bF2F        [ I ] - Field to field expression?
+
+RETURN VALUE:
+   std::string
+===========================================================================*/
+std::string sDB2Fragment::BuildExpression( 
+   ULONG                      id,
+   eDB2ExpOperator            op,
+   LONGLONG                   val,
+   bool                       bF2F )
+{
+   std::ostringstream tmp;
+
+   if (::IsValid( op ) == true)
+   {
+      if (bF2F == false)
+      {
+         switch (op)
+         {
+            case eDB2_EXPOP_ADD:
+               tmp << (UINT)id << " " << "+" << val;
+               break;
+
+            case eDB2_EXPOP_SUB:
+               tmp << (UINT)id << " " << "-" << val;
+               break;
+
+            case eDB2_EXPOP_MUL:
+               tmp << (UINT)id << " " << "*" << val;
+               break;
+
+            case eDB2_EXPOP_DIV:
+               tmp << (UINT)id << " " << "/" << val;
+               break;
+
+            case eDB2_EXPOP_REM:
+               tmp << (UINT)id << " " << "%" << val;
+               break;
+
+            case eDB2_EXPOP_MIN:
+               tmp << (UINT)id << " " << "min" << val;
+               break;
+
+            case eDB2_EXPOP_MAX:
+               tmp << (UINT)id << " " << "max" << val;
+               break;
+         }
+      }
+      else
+      {
+         switch (op)
+         {
+            case eDB2_EXPOP_ADD:
+               tmp << (UINT)id << " " << "f+" << val;
+               break;
+
+            case eDB2_EXPOP_SUB:
+               tmp << (UINT)id << " " << "f-" << val;
+               break;
+
+            case eDB2_EXPOP_MUL:
+               tmp << (UINT)id << " " << "f*" << val;
+               break;
+
+            case eDB2_EXPOP_DIV:
+               tmp << (UINT)id << " " << "f/" << val;
+               break;
+
+            case eDB2_EXPOP_REM:
+               tmp << (UINT)id << " " << "f%" << val;
+               break;
+
+            case eDB2_EXPOP_MIN:
+               tmp << (UINT)id << " " << "fmin" << val;
+               break;
+
+            case eDB2_EXPOP_MAX:
+               tmp << (UINT)id << " " << "fmax" << val;
+               break;
+         }
+      }
+   }
+
+   std::string retStr = tmp.str();
+
+   return retStr;
+}
+
+/*===========================================================================
+METHOD:
+   EvaluateExpression (Static Public Method)
+
+DESCRIPTION:
+   Evaluate a simple expression
+  
+PARAMETERS:
+   valA        [ I ] - Left value
+   op          [ I ] - Operator
+   valB        [ I ] - Right value
+   res         [ O ] - Resulting value
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool sDB2Fragment::EvaluateExpression( 
+   LONGLONG                   valA,
+   eDB2ExpOperator            op,
+   LONGLONG                   valB,
+   LONGLONG &                 res )
+{
+   bool bOK = false;
+   if (::IsValid( op ) == true)
+   {
+      bOK = true;
+      switch (op)
+      {
+         case eDB2_EXPOP_ADD:
+            res = valA + valB;
+            break;
+
+         case eDB2_EXPOP_SUB:
+            res = valA - valB;
+            break;
+
+         case eDB2_EXPOP_MUL:
+            res = valA * valB;
+            break;
+
+         case eDB2_EXPOP_DIV:
+            res = valA / valB;
+            break;
+
+         case eDB2_EXPOP_REM:
+            res = valA % valB;
+            break;
+
+         case eDB2_EXPOP_MIN:
+            res = valA;
+            if (valA > valB)
+            {
+               res = valB;
+            }
+            break;
+
+         case eDB2_EXPOP_MAX:
+            res = valA;
+            if (valA < valB)
+            {
+               res = valB;
+            }
+            break;
+
+         default:
+            bOK = false;
+            break;
+      }
+   }
+
+   return bOK;
+}
+
+/*===========================================================================
+METHOD:
+   ParseExpression (Static Public Method)
+
+DESCRIPTION:
+   Parse a simple expression
+  
+PARAMETERS:
+   pExpr       [ I ] - Expression string
+   id          [ O ] - Field ID
+   op          [ O ] - Operator
+   val         [ O ] - Value (or Field ID)
+   bF2F        [ O ] - Field to field expression?
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool sDB2Fragment::ParseExpression( 
+   LPCSTR                    pExpr,
+   ULONG &                    id,
+   eDB2ExpOperator &          op,
+   LONGLONG &                 val,
+   bool &                     bF2F )
+{
+   // Assume error
+   bool bOK = false;
+
+   // Even a condition to start with?
+   if (pExpr == 0 || pExpr == EMPTY_STRING)
+   {
+      return bOK;
+   }
+
+   // Parse condition to tokens (field ID operator value)
+   int nSize = strlen( pExpr ) + 1;
+   
+   char * pCopy = new char[ nSize ];
+   if (pCopy == NULL)
+   {
+      return false;
+   }
+   
+   memcpy( pCopy, pExpr, nSize );
+
+   std::vector <LPSTR> tokens; 
+   ParseTokens( " ", pCopy, tokens );
+
+   if (tokens.size() == 3)
+   {
+      // Covert first token to field ID
+      ULONG fieldID = strtoul( tokens[0], 0, 10 );
+
+      // Grab the value for the given field ID
+      LONGLONG fieldVal = 0;
+      bOK = StringToLONGLONG( tokens[2], 0, fieldVal );
+      if (bOK == true)
+      {
+         std::string opStr = tokens[1];
+         
+         // std::string version of Trim()
+         int nFirst = opStr.find_first_not_of( ' ' );
+         int nLast = opStr.find_last_not_of( ' ' );
+         if (nFirst == -1 || nLast == -1)
+         {
+            // Something went horribly wrong, empty string or all spaces
+            delete [] pCopy;
+            return false;
+         }
+         
+         opStr = opStr.substr( nFirst, nLast - nFirst + 1 );
+         
+         // std::string version of MakeLower()
+         transform( opStr.begin(), opStr.end(), opStr.begin(), tolower );
+
+         bF2F = false;
+         if (opStr == "+")
+         {
+            op = eDB2_EXPOP_ADD;
+         }
+         else if (opStr == "-")
+         {
+            op = eDB2_EXPOP_SUB;
+         }
+         else if (opStr == "*")
+         {
+            op = eDB2_EXPOP_MUL;
+         }
+         else if (opStr == "/")
+         {
+            op = eDB2_EXPOP_DIV;
+         }
+         else if (opStr == "%")
+         {
+            op = eDB2_EXPOP_REM;
+         }
+         else if (opStr == "min")
+         {
+            op = eDB2_EXPOP_MIN;
+         }
+         else if (opStr == "max")
+         {
+            op = eDB2_EXPOP_MAX;
+         }
+         else if (opStr == "f+")
+         {
+            bF2F = true;
+            op = eDB2_EXPOP_ADD;
+         }
+         else if (opStr == "f-")
+         {
+            bF2F = true;
+            op = eDB2_EXPOP_SUB;
+         }
+         else if (opStr == "f*")
+         {
+            bF2F = true;
+            op = eDB2_EXPOP_MUL;
+         }
+         else if (opStr == "f/")
+         {
+            bF2F = true;
+            op = eDB2_EXPOP_DIV;
+         }
+         else if (opStr == "f%")
+         {
+            bF2F = true;
+            op = eDB2_EXPOP_REM;
+         }
+         else if (opStr == "fmin")
+         {
+            bF2F = true;
+            op = eDB2_EXPOP_MIN;
+         }
+         else if (opStr == "fmax")
+         {
+            bF2F = true;
+            op = eDB2_EXPOP_MAX;
+         }
+         else
+         {
+            bOK = false;
+         }
+
+         if (bOK == true)
+         {
+            id = fieldID;
+            val = fieldVal;
+         }
+      }
+   }
+
+   delete [] pCopy;
+   return bOK;
+}
+
+/*=========================================================================*/
+// sDB2Field Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   FromString (Public Method)
+
+DESCRIPTION:
+   Populate this object from a string
+
+PARAMETERS:
+   pStr        [ I ] - String to populate object from
+  
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool sDB2Field::FromString( LPSTR pStr )
+{
+   bool bRC = false;
+
+   // Should be 
+   //    0: ID 
+   //    1: "Name"
+   //    2: Size
+   //    3: Field type
+   //    4: Field type value
+   //    5: Hexadecimal
+   //    6: Description ID (optional)
+   //    7: Internal only flag (optional)
+   const ULONG NUM_REQ_VALS = 6;
+
+   std::vector <LPSTR> tokens; 
+   ParseTokens( DB2_VALUE_SEP, pStr, tokens );
+
+   ULONG toks = (ULONG)tokens.size();
+
+   if (toks >= NUM_REQ_VALS)
+   {
+      // Remove quotes from name string and copy
+      LPCSTR pCopy = CopyQuotedString( tokens[1] );
+      if (pCopy != 0)
+      {
+         mID      = strtoul( tokens[0], 0, 10 );
+         mSize    = strtoul( tokens[2], 0, 10 );
+         mpName   = pCopy;
+         mType    = (eDB2FieldType)strtol( tokens[3], 0, 10 );
+         mTypeVal = strtoul( tokens[4], 0, 10 );
+         mbHex    = (strtoul( tokens[5], 0, 10 ) != 0);
+         
+         // Description ID?
+         if (toks > NUM_REQ_VALS)
+         {
+            mDescriptionID = strtol( tokens[NUM_REQ_VALS], 0, 10 );
+         }
+
+         // Internal only flag?
+         if (toks > NUM_REQ_VALS + 1)
+         {
+            mbInternal = (strtoul( tokens[NUM_REQ_VALS + 1], 0, 10 ) != 0);
+         }
+
+         bRC = IsValid();
+      }                
+   }
+
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   IsValid (Public Method)
+
+DESCRIPTION:
+   Is this object valid?
+  
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool sDB2Field::IsValid() const
+{
+   // There has to be a non-empty name
+   if (mpName == 0 || mpName[0] == 0)
+   {
+      return false;
+   }
+
+   // The field type must be valid
+   if (::IsValid( mType ) == false)
+   {
+      return false;
+   }
+
+   // For validating size
+   ULONG minSz = 1;
+   ULONG maxSz = 8;
+   ULONG modVal = 0;
+
+   // What type of field is this?
+   if (mType == eDB2_FIELD_STD)
+   {
+      eDB2StdFieldType ft = (eDB2StdFieldType)mTypeVal;
+      if (::IsValid( ft ) == false)
+      {
+         return false;
+      }
+
+      switch (ft)
+      {
+         case eDB2_FIELD_STDTYPE_BOOL:
+            maxSz = 64;
+            break;
+
+         case eDB2_FIELD_STDTYPE_INT16:
+         case eDB2_FIELD_STDTYPE_UINT16:
+            maxSz = 16;
+            break;
+
+         case eDB2_FIELD_STDTYPE_INT32:
+         case eDB2_FIELD_STDTYPE_UINT32:
+         case eDB2_FIELD_STDTYPE_FLOAT32:
+            maxSz = 32;
+            break;
+
+         case eDB2_FIELD_STDTYPE_INT64:
+         case eDB2_FIELD_STDTYPE_UINT64:
+         case eDB2_FIELD_STDTYPE_FLOAT64:
+            maxSz = 64;
+            break;
+
+         case eDB2_FIELD_STDTYPE_STRING_A:
+         case eDB2_FIELD_STDTYPE_STRING_U8:
+            // One character, no maximum
+            minSz = 8;
+            maxSz = 0;
+            modVal = 8;
+            break;
+
+         case eDB2_FIELD_STDTYPE_STRING_U:
+            // One UNICODE character, no maximum
+            minSz = 16;
+            maxSz = 0;
+            modVal = 16;
+            break;
+
+         case eDB2_FIELD_STDTYPE_STRING_ANT:
+         case eDB2_FIELD_STDTYPE_STRING_UNT:
+         case eDB2_FIELD_STDTYPE_STRING_U8NT:
+            // Size needs to be specified as 0
+            minSz = maxSz = 0;
+            break;
+      }
+   }
+   else 
+   {
+      // Enum must be between 1 - 32 bits in size
+      maxSz = 32;
+   }
+   
+   if (mSize < minSz)
+   {
+      return false;
+   }
+
+   if (maxSz != 0 && mSize > maxSz)
+   {
+      return false;
+   }
+
+   if (modVal != 0 && (mSize % modVal) != 0) 
+   {
+      return false;
+   }
+
+   if (mDescriptionID < -1)
+   {
+      return false;
+   }
+
+   // The name must be valid
+   std::string name = mpName;
+   if (name.find( DB2_VALUE_SEP ) != -1 || name.find( DB2_SUBVAL_SEP ) != -1)
+   {
+      return false;
+   }
+
+   return true;
+}
+
+/*=========================================================================*/
+// sDB2Category Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   FromString (Public Method)
+
+DESCRIPTION:
+   Populate this object from a string
+
+PARAMETERS:
+   pStr        [ I ] - String to populate object from
+  
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool sDB2Category::FromString( LPSTR pStr )
+{
+   bool bRC = false;
+
+   // Should be
+   //    0: ID
+   //    1: "Name"
+   //    2: Description ID
+   //    3: Parent ID
+   const ULONG NUM_REQ_VALS = 4;
+
+   std::vector <LPSTR> tokens; 
+   ParseTokens( DB2_VALUE_SEP, pStr, tokens );
+
+   ULONG toks = (ULONG)tokens.size();
+   if (toks >= NUM_REQ_VALS)
+   {
+      // Remove quotes from name string and copy
+      LPCSTR pCopy = CopyQuotedString( tokens[1] );
+      if (pCopy != 0)
+      {
+         mID       = strtoul( tokens[0], 0, 10 );
+         mParentID = strtol( tokens[3], 0, 10 );
+         mpName    = pCopy;
+
+         // Old format used to be a description string, so
+         // first check for quotes
+         if (tokens[2][0] != '\"')
+         {
+            mDescriptionID = strtol( tokens[2], 0, 10 );
+         }
+
+         bRC = IsValid();
+      }
+   }
+
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   IsValid (Public Method)
+
+DESCRIPTION:
+   Is this object valid?
+  
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool sDB2Category::IsValid() const
+{
+   // The parent ID has to be greater than or equal to -1
+   if (mParentID < -1)
+   {
+      return false;
+   }
+
+   // There has to be a non-empty name
+   if (mpName == 0 || mpName[0] == 0)
+   {
+      return false;
+   }
+
+   if (mDescriptionID < -1)
+   {
+      return false;
+   }
+
+   return true;
+}
+
+/*=========================================================================*/
+// sDB2NVItem Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   FromString (Public Method)
+
+DESCRIPTION:
+   Populate this object from a string
+
+PARAMETERS:
+   pStr        [ I ] - String to populate object from
+  
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool sDB2NVItem::FromString( LPSTR pStr )
+{
+   bool bRC = false;
+
+   // Should be
+   //    0: NV Item number
+   //    1: "Name"
+   //    2: "Categories"
+   //    3: Description ID
+   const ULONG NUM_REQ_VALS = 4;
+
+   std::vector <LPSTR> tokens; 
+   ParseTokens( DB2_VALUE_SEP, pStr, tokens );
+
+   ULONG toks = (ULONG)tokens.size();
+   if (toks >= NUM_REQ_VALS)
+   {
+      // Remove quotes from name string and copy
+      LPCSTR pCopy = CopyQuotedString( tokens[1] );
+      if (pCopy != 0)
+      {
+         CSVStringToContainer( DB2_SUBVAL_SEP, tokens[2], mCategoryIDs );
+
+         mItem  = strtoul( tokens[0], 0, 10 );
+         mpName = pCopy;
+
+         // Old format used to be a description string, so
+         // first check for quotes
+         if (tokens[3][0] != '\"')
+         {
+            mDescriptionID = strtol( tokens[3], 0, 10 );
+         }
+
+         bRC = IsValid();
+      }
+   }
+
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   IsValid (Public Method)
+
+DESCRIPTION:
+   Is this object valid?
+  
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool sDB2NVItem::IsValid() const
+{
+   // There has to be at least one category ID
+   ULONG cats = (ULONG)mCategoryIDs.size();
+   if (cats < 1)
+   {
+      return false;
+   }
+
+   // The category IDs have to be greater than or equal to -1
+   std::set <int>::const_iterator pIter = mCategoryIDs.begin();
+   while (pIter != mCategoryIDs.end())
+   {
+      if (*pIter++ < -1)
+      {
+         return false;
+      }
+   }
+
+   // There has to be a non-empty name
+   if (mpName == 0 || mpName[0] == 0)
+   {
+      return false;
+   }
+
+   if (mDescriptionID < -1)
+   {
+      return false;
    }
 
-   delete [] pCopy;
-   return bOK;
+   return true;
 }
 
 /*=========================================================================*/
-// sDB2Field Methods
+// sDB2Enum Methods
 /*=========================================================================*/
 
 /*===========================================================================
@@ -1103,53 +2275,40 @@ PARAMETERS:
 RETURN VALUE:
    bool
 ===========================================================================*/
-bool sDB2Field::FromString( LPSTR pStr )
+bool sDB2Enum::FromString( LPSTR pStr )
 {
    bool bRC = false;
 
    // Should be 
-   //    0: ID 
+   //    0: ID
    //    1: "Name"
-   //    2: Size
-   //    3: Field type
-   //    4: Field type value
-   //    5: Hexadecimal
-   //    6: Description ID (optional)
-   //    7: Internal only flag (optional)
-   const ULONG NUM_REQ_VALS = 6;
+   //    2: Description ID
+   //    3: Internal?
+   const ULONG NUM_REQ_VALS = 4;
 
    std::vector <LPSTR> tokens; 
    ParseTokens( DB2_VALUE_SEP, pStr, tokens );
 
    ULONG toks = (ULONG)tokens.size();
-
    if (toks >= NUM_REQ_VALS)
-   {
+   {    
       // Remove quotes from name string and copy
       LPCSTR pCopy = CopyQuotedString( tokens[1] );
       if (pCopy != 0)
-      {
-         mID      = strtoul( tokens[0], 0, 10 );
-         mSize    = strtoul( tokens[2], 0, 10 );
-         mpName   = pCopy;
-         mType    = (eDB2FieldType)strtol( tokens[3], 0, 10 );
-         mTypeVal = strtoul( tokens[4], 0, 10 );
-         mbHex    = (strtoul( tokens[5], 0, 10 ) != 0);
-         
-         // Description ID?
-         if (toks > NUM_REQ_VALS)
-         {
-            mDescriptionID = strtol( tokens[NUM_REQ_VALS], 0, 10 );
-         }
+      {               
+         mID         = strtoul( tokens[0], 0, 10  );
+         mbInternal  = (strtoul( tokens[3], 0, 10 ) != 0);
+         mpName      = pCopy;
 
-         // Internal only flag?
-         if (toks > NUM_REQ_VALS + 1)
+         // Old format used to be a description string, so
+         // first check for quotes
+         if (tokens[2][0] != '\"')
          {
-            mbInternal = (strtoul( tokens[NUM_REQ_VALS + 1], 0, 10 ) != 0);
+            mDescriptionID = strtol( tokens[2], 0, 10 );
          }
 
          bRC = IsValid();
-      }                
+      }
    }
 
    return bRC;
@@ -1165,7 +2324,7 @@ DESCRIPTION:
 RETURN VALUE:
    bool
 ===========================================================================*/
-bool sDB2Field::IsValid() const
+bool sDB2Enum::IsValid() const
 {
    // There has to be a non-empty name
    if (mpName == 0 || mpName[0] == 0)
@@ -1173,89 +2332,92 @@ bool sDB2Field::IsValid() const
       return false;
    }
 
-   // The field type must be valid
-   if (::IsValid( mType ) == false)
+   if (mDescriptionID < -1)
    {
       return false;
    }
 
-   // For validating size
-   ULONG minSz = 1;
-   ULONG maxSz = 8;
-   ULONG modVal = 0;
+   return true;
+}
 
-   // What type of field is this?
-   if (mType == eDB2_FIELD_STD)
-   {
-      eDB2StdFieldType ft = (eDB2StdFieldType)mTypeVal;
-      if (::IsValid( ft ) == false)
-      {
-         return false;
-      }
+/*=========================================================================*/
+// sDB2EnumEntry Methods
+/*=========================================================================*/
 
-      switch (ft)
-      {
-         case eDB2_FIELD_STDTYPE_BOOL:
-            maxSz = 64;
-            break;
+/*===========================================================================
+METHOD:
+   FromString (Public Method)
 
-         case eDB2_FIELD_STDTYPE_INT16:
-         case eDB2_FIELD_STDTYPE_UINT16:
-            maxSz = 16;
-            break;
+DESCRIPTION:
+   Populate this object from a string
 
-         case eDB2_FIELD_STDTYPE_INT32:
-         case eDB2_FIELD_STDTYPE_UINT32:
-         case eDB2_FIELD_STDTYPE_FLOAT32:
-            maxSz = 32;
-            break;
+PARAMETERS:
+   pStr        [ I ] - String to populate object from
+  
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool sDB2EnumEntry::FromString( LPSTR pStr )
+{
+   bool bRC = false;
 
-         case eDB2_FIELD_STDTYPE_INT64:
-         case eDB2_FIELD_STDTYPE_UINT64:
-         case eDB2_FIELD_STDTYPE_FLOAT64:
-            maxSz = 64;
-            break;
+   // Should be 
+   //    0: ID
+   //    1: Value
+   //    2: "Name"
+   //    3: Description ID (optional)
+   const ULONG NUM_REQ_VALS = 3;
 
-         case eDB2_FIELD_STDTYPE_STRING_A:
-         case eDB2_FIELD_STDTYPE_STRING_U8:
-            // One character, no maximum
-            minSz = 8;
-            maxSz = 0;
-            modVal = 8;
-            break;
+   std::vector <LPSTR> tokens; 
+   ParseTokens( DB2_VALUE_SEP, pStr, tokens );
 
-         case eDB2_FIELD_STDTYPE_STRING_U:
-            // One UNICODE character, no maximum
-            minSz = 16;
-            maxSz = 0;
-            modVal = 16;
-            break;
+   ULONG toks = (ULONG)tokens.size();
+   if (toks >= NUM_REQ_VALS)
+   {    
+      // Remove quotes from name string and copy
+      LPCSTR pCopy = CopyQuotedString( tokens[2] );
+      if (pCopy != 0)
+      {               
+         mID    = strtoul( tokens[0], 0, 10  );
+         mpName = pCopy;
 
-         case eDB2_FIELD_STDTYPE_STRING_ANT:
-         case eDB2_FIELD_STDTYPE_STRING_UNT:
-         case eDB2_FIELD_STDTYPE_STRING_U8NT:
-            // Size needs to be specified as 0
-            minSz = maxSz = 0;
-            break;
+         // Enum entries are signed by definition, but can be entered 
+         // in hexadecimal as they may be unsigned in practice
+         LONG val = -1;
+         StringToLONG( tokens[1], 0, val );
+         mValue = (INT)val;
+
+         // Determine hexadecimal flag by performing case-insensitve comparison
+         // of the value string's first two characters with "0x"
+         mbHex = (strncmp( tokens[1], "0x", 2 ) == 0);
+
+         // Description ID?
+         if (toks > NUM_REQ_VALS)
+         {
+            mDescriptionID = strtol( tokens[NUM_REQ_VALS], 0, 10 );
+         }
+
+         bRC = IsValid();
       }
    }
-   else 
-   {
-      // Enum must be between 1 - 32 bits in size
-      maxSz = 32;
-   }
-   
-   if (mSize < minSz)
-   {
-      return false;
-   }
 
-   if (maxSz != 0 && mSize > maxSz)
-   {
-      return false;
-   }
+   return bRC;
+}
 
-   if (modVal != 0 && (mSize % modVal) != 0) 
+/*===========================================================================
+METHOD:
+   IsValid (Public Method)
+
+DESCRIPTION:
+   Is this object valid?
+  
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool sDB2EnumEntry::IsValid() const
+{
+   // There has to be a non-empty name
+   if (mpName == 0 || mpName[0] == 0)
    {
       return false;
    }
@@ -1265,470 +2427,695 @@ bool sDB2Field::IsValid() const
       return false;
    }
 
-   // The name must be valid
-   std::string name = mpName;
-   if (name.find( DB2_VALUE_SEP ) != -1 || name.find( DB2_SUBVAL_SEP ) != -1)
-   {
-      return false;
-   }
+   return true;
+}
+
+/*=========================================================================*/
+// cCoreDatabase Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   cCoreDatabase (Public Method)
+
+DESCRIPTION:
+   Constructor
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+cCoreDatabase::cCoreDatabase()
+   :  mpLog( &gDB2DefaultLog ),
+      mbTrusted( false ),
+      mpImage( 0 ),
+      mpCompiledStrings( 0 ),
+      mCompiledStringsSz( 0 ),
+      mpStringArena( 0 ),
+      mStringArenaSz( 0 )
+{
+   pthread_rwlock_init( &mEntityNavLock, NULL );
+   pthread_rwlock_init( &mEntityFieldsLock, NULL );
+   pthread_mutex_init( &mValidateLock, NULL );
+
+   // Database empty, call Initialize()
+}
+
+/*===========================================================================
+METHOD:
+   ~cCoreDatabase (Public Method)
+
+DESCRIPTION:
+   Destructor
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+cCoreDatabase::~cCoreDatabase()
+{
+   Exit();
+
+   pthread_rwlock_destroy( &mEntityNavLock );
+   pthread_rwlock_destroy( &mEntityFieldsLock );
+   pthread_mutex_destroy( &mValidateLock );
+}
+
+/*===========================================================================
+METHOD:
+   Initialize (Public Method)
+
+DESCRIPTION:
+   Version to Load from file
+   Initialize the database - this must be done once (and only once)
+   prior to the database being accessed
+  
+PARAMETERS
+   pBasePath         [ I ] - Base path to database files
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cCoreDatabase::Initialize( LPCSTR pBasePath )
+{
+   bool bRC = true;
+
+   // Cleanup the last database (if necessary)
+   Exit();
+
+   bRC &= LoadTables( pBasePath );
+
+   // Pool the table strings (before anything references them by address)
+   CompactStrings();
+
+   // Build the modifier tables
+   bRC &= BuildModifierTables();
+
+   // Build the lookup indices
+   BuildIndices();
 
-   return true;
+   return bRC;
 }
 
-/*=========================================================================*/
-// sDB2Category Methods
-/*=========================================================================*/
-
 /*===========================================================================
 METHOD:
-   FromString (Public Method)
+   Initialize (Public Method)
 
 DESCRIPTION:
-   Populate this object from a string
+   Version to Load from internal pointers
+   Initialize the database - this must be done once (and only once)
+   prior to the database being accessed
 
-PARAMETERS:
-   pStr        [ I ] - String to populate object from
+   If tables compiled by utils/qmidb are linked in these are used, else
+   if a precompiled image built from the same internal tables is
+   installed it is mapped instead of parsing the internal tables
   
+PARAMETERS
+
 RETURN VALUE:
    bool
 ===========================================================================*/
-bool sDB2Category::FromString( LPSTR pStr )
+bool cCoreDatabase::Initialize()
 {
-   bool bRC = false;
-
-   // Should be
-   //    0: ID
-   //    1: "Name"
-   //    2: Description ID
-   //    3: Parent ID
-   const ULONG NUM_REQ_VALS = 4;
+   bool bRC = true;
 
-   std::vector <LPSTR> tokens; 
-   ParseTokens( DB2_VALUE_SEP, pStr, tokens );
+   // Cleanup the last database (if necessary)
+   Exit();
 
-   ULONG toks = (ULONG)tokens.size();
-   if (toks >= NUM_REQ_VALS)
+#ifdef DB2_COMPILED_TABLES
+   if (LoadCompiledTables() == true)
    {
-      // Remove quotes from name string and copy
-      LPCSTR pCopy = CopyQuotedString( tokens[1] );
-      if (pCopy != 0)
-      {
-         mID       = strtoul( tokens[0], 0, 10 );
-         mParentID = strtol( tokens[3], 0, 10 );
-         mpName    = pCopy;
+      BuildIndices();
+      return bRC;
+   }
 
-         // Old format used to be a description string, so
-         // first check for quotes
-         if (tokens[2][0] != '\"')
-         {
-            mDescriptionID = strtol( tokens[2], 0, 10 );
-         }
+   // Unusable compiled tables, discard anything partially loaded
+   Exit();
+#endif
 
-         bRC = IsValid();
-      }
+   if (LoadImage( DB2_IMAGE_PATH, true ) == true)
+   {
+      BuildIndices();
+      return bRC;
    }
 
+   // No usable image, discard anything partially loaded
+   Exit();
+
+   bRC &= LoadTables();
+
+   // Pool the table strings (before anything references them by address)
+   CompactStrings();
+
+   // Build the modifier tables
+   bRC &= BuildModifierTables();
+
+   // Build the lookup indices
+   BuildIndices();
+
    return bRC;
 }
 
 /*===========================================================================
 METHOD:
-   IsValid (Public Method)
+   InitializeFromImage (Public Method)
 
 DESCRIPTION:
-   Is this object valid?
+   Version to load from a precompiled database image (see SaveImage())
+   Initialize the database - this must be done once (and only once)
+   prior to the database being accessed
   
+PARAMETERS
+   pImageFile  [ I ] - Precompiled database image file
+
 RETURN VALUE:
    bool
 ===========================================================================*/
-bool sDB2Category::IsValid() const
+bool cCoreDatabase::InitializeFromImage( LPCSTR pImageFile )
 {
-   // The parent ID has to be greater than or equal to -1
-   if (mParentID < -1)
-   {
-      return false;
-   }
+   // Cleanup the last database (if necessary)
+   Exit();
 
-   // There has to be a non-empty name
-   if (mpName == 0 || mpName[0] == 0)
+   bool bRC = LoadImage( pImageFile, false );
+   if (bRC == false)
    {
-      return false;
+      Exit();
    }
-
-   if (mDescriptionID < -1)
+   else
    {
-      return false;
+      BuildIndices();
    }
 
-   return true;
+   return bRC;
 }
 
-/*=========================================================================*/
-// sDB2NVItem Methods
-/*=========================================================================*/
-
 /*===========================================================================
 METHOD:
-   FromString (Public Method)
+   SaveImage (Public Method)
 
 DESCRIPTION:
-   Populate this object from a string
-
-PARAMETERS:
-   pStr        [ I ] - String to populate object from
+   Write the currently loaded (and validated) database tables out as a 
+   precompiled image that can be loaded via InitializeFromImage()
   
+PARAMETERS
+   pImageFile  [ I ] - Precompiled database image file to create
+
 RETURN VALUE:
    bool
 ===========================================================================*/
-bool sDB2NVItem::FromString( LPSTR pStr )
+bool cCoreDatabase::SaveImage( LPCSTR pImageFile ) const
 {
+   // Assume failure
    bool bRC = false;
+   if (pImageFile == 0 || pImageFile[0] == 0)
+   {
+      return bRC;
+   }
 
-   // Should be
-   //    0: NV Item number
-   //    1: "Name"
-   //    2: "Categories"
-   //    3: Description ID
-   const ULONG NUM_REQ_VALS = 4;
+   // The image is trusted when loaded, so validate what is still pending
+   ValidateStructures();
 
-   std::vector <LPSTR> tokens; 
-   ParseTokens( DB2_VALUE_SEP, pStr, tokens );
+   cDB2ImageWriter writer;
 
-   ULONG toks = (ULONG)tokens.size();
-   if (toks >= NUM_REQ_VALS)
-   {
-      // Remove quotes from name string and copy
-      LPCSTR pCopy = CopyQuotedString( tokens[1] );
-      if (pCopy != 0)
-      {
-         CSVStringToContainer( DB2_SUBVAL_SEP, tokens[2], mCategoryIDs );
+   sDB2ImageHeader hdr;
+   memset( (LPVOID)&hdr, 0, sizeof( hdr ) );
+   hdr.mMagic = DB2_IMAGE_MAGIC;
+   hdr.mVersion = DB2_IMAGE_VERSION;
 
-         mItem  = strtoul( tokens[0], 0, 10 );
-         mpName = pCopy;
+   GetEmbeddedText( &hdr.mText[0] );
 
-         // Old format used to be a description string, so
-         // first check for quotes
-         if (tokens[3][0] != '\"')
-         {
-            mDescriptionID = strtol( tokens[3], 0, 10 );
-         }
+   // Protocol entities (and their multi-value IDs)
+   std::vector <sDB2ImageEntity> entities;
+   std::vector <UINT> entityIDs;
+   tDB2EntityMap::const_iterator pEntity = mProtocolEntities.begin();
+   while (pEntity != mProtocolEntities.end())
+   {
+      const sDB2ProtocolEntity & obj = pEntity->second;
+      pEntity++;
 
-         bRC = IsValid();
+      sDB2ImageEntity rec;
+      rec.mType = (UINT)obj.mType;
+      rec.mIDIndex = (UINT)entityIDs.size();
+      rec.mIDCount = (UINT)obj.mID.size();
+      rec.mStructID = obj.mStructID;
+      rec.mFormatID = obj.mFormatID;
+      rec.mFormatExID = obj.mFormatExID;
+      rec.mbInternal = (obj.mbInternal == true ? 1 : 0);
+      rec.mName = writer.AddString( obj.mpName );
+      entities.push_back( rec );
+
+      for (ULONG i = 0; i < (ULONG)obj.mID.size(); i++)
+      {
+         entityIDs.push_back( (UINT)obj.mID[i] );
       }
    }
 
-   return bRC;
-}
+   // Protocol entity names (in name map order)
+   std::vector <sDB2ImageEntityName> names;
+   tDB2EntityNameMap::const_iterator pName = mEntityNames.begin();
+   while (pName != mEntityNames.end())
+   {
+      const std::vector <ULONG> & key = pName->second;
 
-/*===========================================================================
-METHOD:
-   IsValid (Public Method)
+      sDB2ImageEntityName rec;
+      rec.mName = writer.AddString( pName->first );
+      rec.mIDIndex = (UINT)entityIDs.size();
+      rec.mIDCount = (UINT)key.size();
+      names.push_back( rec );
 
-DESCRIPTION:
-   Is this object valid?
-  
-RETURN VALUE:
-   bool
-===========================================================================*/
-bool sDB2NVItem::IsValid() const
-{
-   // There has to be at least one category ID
-   ULONG cats = (ULONG)mCategoryIDs.size();
-   if (cats < 1)
+      for (ULONG i = 0; i < (ULONG)key.size(); i++)
+      {
+         entityIDs.push_back( (UINT)key[i] );
+      }
+
+      pName++;
+   }
+
+   // Protocol structures
+   std::vector <sDB2ImageFragment> frags;
+   tDB2FragmentMap::const_iterator pFrag = mEntityStructs.begin();
+   while (pFrag != mEntityStructs.end())
    {
-      return false;
+      const sDB2Fragment & obj = pFrag->second;
+      pFrag++;
+
+      sDB2ImageFragment rec;
+      rec.mStructID = obj.mStructID;
+      rec.mFragmentOrder = obj.mFragmentOrder;
+      rec.mFragmentOffset = obj.mFragmentOffset;
+      rec.mFragmentType = (UINT)obj.mFragmentType;
+      rec.mFragmentValue = obj.mFragmentValue;
+      rec.mModifierType = (UINT)obj.mModifierType;
+      rec.mModifierValue = writer.AddString( obj.mpModifierValue );
+      rec.mName = writer.AddString( obj.mpName );
+      frags.push_back( rec );
    }
 
-   // The category IDs have to be greater than or equal to -1
-   std::set <int>::const_iterator pIter = mCategoryIDs.begin();
-   while (pIter != mCategoryIDs.end())
+   // Protocol fields
+   std::vector <sDB2ImageField> fields;
+   tDB2FieldMap::const_iterator pField = mEntityFields.begin();
+   while (pField != mEntityFields.end())
    {
-      if (*pIter++ < -1)
-      {
-         return false;
-      }
+      const sDB2Field & obj = pField->second;
+      pField++;
+
+      sDB2ImageField rec;
+      rec.mID = obj.mID;
+      rec.mSize = obj.mSize;
+      rec.mType = (UINT)obj.mType;
+      rec.mTypeVal = obj.mTypeVal;
+      rec.mbHex = (obj.mbHex == true ? 1 : 0);
+      rec.mbInternal = (obj.mbInternal == true ? 1 : 0);
+      rec.mDescriptionID = obj.mDescriptionID;
+      rec.mName = writer.AddString( obj.mpName );
+      fields.push_back( rec );
    }
 
-   // There has to be a non-empty name
-   if (mpName == 0 || mpName[0] == 0)
+   // Enums
+   std::vector <sDB2ImageEnum> enums;
+   tDB2EnumNameMap::const_iterator pEnum = mEnumNameMap.begin();
+   while (pEnum != mEnumNameMap.end())
    {
-      return false;
+      const sDB2Enum & obj = pEnum->second;
+      pEnum++;
+
+      sDB2ImageEnum rec;
+      rec.mID = obj.mID;
+      rec.mbInternal = (obj.mbInternal == true ? 1 : 0);
+      rec.mDescriptionID = obj.mDescriptionID;
+      rec.mName = writer.AddString( obj.mpName );
+      enums.push_back( rec );
    }
 
-   if (mDescriptionID < -1)
+   // Enum entries
+   std::vector <sDB2ImageEnumEntry> entries;
+   tDB2EnumEntryMap::const_iterator pEntry = mEnumEntryMap.begin();
+   while (pEntry != mEnumEntryMap.end())
    {
-      return false;
+      const sDB2EnumEntry & obj = pEntry->second;
+      pEntry++;
+
+      sDB2ImageEnumEntry rec;
+      rec.mID = obj.mID;
+      rec.mValue = obj.mValue;
+      rec.mbHex = (obj.mbHex == true ? 1 : 0);
+      rec.mDescriptionID = obj.mDescriptionID;
+      rec.mName = writer.AddString( obj.mpName );
+      entries.push_back( rec );
    }
 
-   return true;
-}
+   writer.AddTable( entities, hdr.mEntities );
+   writer.AddTable( names, hdr.mEntityNames );
+   writer.AddTable( entityIDs, hdr.mEntityIDs );
+   writer.AddTable( frags, hdr.mFragments );
+   writer.AddTable( fields, hdr.mFields );
+   writer.AddTable( enums, hdr.mEnums );
+   writer.AddTable( entries, hdr.mEnumEntries );
 
-/*=========================================================================*/
-// sDB2Enum Methods
-/*=========================================================================*/
+   hdr.mStrings.mOffset = (UINT)(sizeof( hdr ) + writer.mBody.size());
+   hdr.mStrings.mCount = (UINT)writer.mStrings.size();
+   hdr.mSize = hdr.mStrings.mOffset + hdr.mStrings.mCount;
 
-/*===========================================================================
-METHOD:
-   FromString (Public Method)
+   std::string tmpFile = pImageFile;
+   tmpFile += ".tmp";
 
-DESCRIPTION:
-   Populate this object from a string
+   int fd = open( tmpFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+   if (fd == -1)
+   {
+      std::ostringstream tmp;
+      tmp << "DB image \'" << pImageFile << "\' create failed, " 
+          << strerror( errno );
 
-PARAMETERS:
-   pStr        [ I ] - String to populate object from
-  
-RETURN VALUE:
-   bool
-===========================================================================*/
-bool sDB2Enum::FromString( LPSTR pStr )
-{
-   bool bRC = false;
+      mpLog->Log( tmp.str(), eDB2_STATUS_ERROR );
+      return bRC;
+   }
 
-   // Should be 
-   //    0: ID
-   //    1: "Name"
-   //    2: Description ID
-   //    3: Internal?
-   const ULONG NUM_REQ_VALS = 4;
+   bRC = true;
 
-   std::vector <LPSTR> tokens; 
-   ParseTokens( DB2_VALUE_SEP, pStr, tokens );
+   struct
+   {
+      LPCVOID mpData;
+      size_t mSz;
+   } parts[] =
+   {
+      { &hdr, sizeof( hdr ) },
+      { writer.mBody.size() > 0 ? &writer.mBody[0] : 0, writer.mBody.size() },
+      { &writer.mStrings[0], writer.mStrings.size() }
+   };
 
-   ULONG toks = (ULONG)tokens.size();
-   if (toks >= NUM_REQ_VALS)
-   {    
-      // Remove quotes from name string and copy
-      LPCSTR pCopy = CopyQuotedString( tokens[1] );
-      if (pCopy != 0)
-      {               
-         mID         = strtoul( tokens[0], 0, 10  );
-         mbInternal  = (strtoul( tokens[3], 0, 10 ) != 0);
-         mpName      = pCopy;
+   for (ULONG p = 0; p < sizeof( parts ) / sizeof( parts[0] ); p++)
+   {
+      const BYTE * pData = (const BYTE *)parts[p].mpData;
+      size_t remaining = parts[p].mSz;
+      while (bRC == true && remaining > 0)
+      {
+         ssize_t n = write( fd, pData, remaining );
+         if (n < 0 && errno == EINTR)
+         {
+            continue;
+         }
 
-         // Old format used to be a description string, so
-         // first check for quotes
-         if (tokens[2][0] != '\"')
+         if (n <= 0)
          {
-            mDescriptionID = strtol( tokens[2], 0, 10 );
+            bRC = false;
+            break;
          }
 
-         bRC = IsValid();
+         pData += n;
+         remaining -= n;
       }
    }
 
-   return bRC;
-}
-
-/*===========================================================================
-METHOD:
-   IsValid (Public Method)
-
-DESCRIPTION:
-   Is this object valid?
-  
-RETURN VALUE:
-   bool
-===========================================================================*/
-bool sDB2Enum::IsValid() const
-{
-   // There has to be a non-empty name
-   if (mpName == 0 || mpName[0] == 0)
+   if (close( fd ) != 0)
    {
-      return false;
+      bRC = false;
    }
 
-   if (mDescriptionID < -1)
+   // Replace the image atomically so mapped readers never see a partial one
+   if (bRC == true && rename( tmpFile.c_str(), pImageFile ) != 0)
    {
-      return false;
+      bRC = false;
    }
 
-   return true;
-}
+   if (bRC == false)
+   {
+      std::ostringstream tmp;
+      tmp << "DB image \'" << pImageFile << "\' write failed, " 
+          << strerror( errno );
+
+      mpLog->Log( tmp.str(), eDB2_STATUS_ERROR );
+      unlink( tmpFile.c_str() );
+   }
 
-/*=========================================================================*/
-// sDB2EnumEntry Methods
-/*=========================================================================*/
+   return bRC;
+}
 
 /*===========================================================================
 METHOD:
-   FromString (Public Method)
+   GetFootprint (Public Method)
 
 DESCRIPTION:
-   Populate this object from a string
+   Report the memory footprint of the database, broken down per table
+   (plus the lookup indices, the navigation trees built so far, and the
+   string arena or precompiled image)
 
-PARAMETERS:
-   pStr        [ I ] - String to populate object from
+   Heap sizes are estimates based on the container layouts, mapped 
+   image bytes are read-only and shared between processes
   
+PARAMETERS:
+   tables      [ O ] - Footprint of each table
+
 RETURN VALUE:
-   bool
+   ULONG - Total (estimated) heap use, in bytes
 ===========================================================================*/
-bool sDB2EnumEntry::FromString( LPSTR pStr )
+ULONG cCoreDatabase::GetFootprint( 
+   std::vector <sDB2TableFootprint> & tables ) const
 {
-   bool bRC = false;
+   tables.clear();
 
-   // Should be 
-   //    0: ID
-   //    1: Value
-   //    2: "Name"
-   //    3: Description ID (optional)
-   const ULONG NUM_REQ_VALS = 3;
+   // Records own their strings unless these live in an image, the 
+   // compiled tables or an arena
+   bool bOwnStrings = ( (mpImage == 0)
+                    &&  (mpCompiledStrings == 0)
+                    &&  (mpStringArena == 0) );
 
-   std::vector <LPSTR> tokens; 
-   ParseTokens( DB2_VALUE_SEP, pStr, tokens );
+   // Protocol entities
+   sDB2TableFootprint fp;
+   fp.mpName = DB2_TABLE_PROTOCOL_ENTITY;
+   fp.mRecords = (ULONG)mProtocolEntities.size();
+   fp.mContainerBytes = MapNodeBytes( mProtocolEntities );
 
-   ULONG toks = (ULONG)tokens.size();
-   if (toks >= NUM_REQ_VALS)
-   {    
-      // Remove quotes from name string and copy
-      LPCSTR pCopy = CopyQuotedString( tokens[2] );
-      if (pCopy != 0)
-      {               
-         mID    = strtoul( tokens[0], 0, 10  );
-         mpName = pCopy;
+   tDB2EntityMap::const_iterator pEntity = mProtocolEntities.begin();
+   while (pEntity != mProtocolEntities.end())
+   {
+      fp.mContainerBytes += VectorBytes( pEntity->first );
+      fp.mContainerBytes += VectorBytes( pEntity->second.mID );
+      if (bOwnStrings == true)
+      {
+         fp.mStringBytes += StringBytes( pEntity->second.mpName );
+      }
 
-         // Enum entries are signed by definition, but can be entered 
-         // in hexadecimal as they may be unsigned in practice
-         LONG val = -1;
-         StringToLONG( tokens[1], 0, val );
-         mValue = (INT)val;
+      pEntity++;
+   }
 
-         // Determine hexadecimal flag by performing case-insensitve comparison
-         // of the value string's first two characters with "0x"
-         mbHex = (strncmp( tokens[1], "0x", 2 ) == 0);
+   tables.push_back( fp );
 
-         // Description ID?
-         if (toks > NUM_REQ_VALS)
-         {
-            mDescriptionID = strtol( tokens[NUM_REQ_VALS], 0, 10 );
-         }
+   // Protocol entity names (keys reference the entity names)
+   fp = sDB2TableFootprint();
+   fp.mpName = "Entity Name";
+   fp.mRecords = (ULONG)mEntityNames.size();
+   fp.mContainerBytes = MapNodeBytes( mEntityNames );
 
-         bRC = IsValid();
+   tDB2EntityNameMap::const_iterator pName = mEntityNames.begin();
+   while (pName != mEntityNames.end())
+   {
+      fp.mContainerBytes += VectorBytes( pName->second );
+      pName++;
+   }
+
+   tables.push_back( fp );
+
+   // Protocol structures
+   fp = sDB2TableFootprint();
+   fp.mpName = DB2_TABLE_PROTOCOL_STRUCT;
+   fp.mRecords = (ULONG)mEntityStructs.size();
+   fp.mContainerBytes = MapNodeBytes( mEntityStructs );
+   if (bOwnStrings == true)
+   {
+      tDB2FragmentMap::const_iterator pFrag = mEntityStructs.begin();
+      while (pFrag != mEntityStructs.end())
+      {
+         fp.mStringBytes += StringBytes( pFrag->second.mpName );
+         fp.mStringBytes += StringBytes( pFrag->second.mpModifierValue );
+         pFrag++;
       }
    }
 
-   return bRC;
-}
+   tables.push_back( fp );
 
-/*===========================================================================
-METHOD:
-   IsValid (Public Method)
+   // Protocol fields
+   fp = sDB2TableFootprint();
+   fp.mpName = DB2_TABLE_PROTOCOL_FIELD;
+   fp.mRecords = (ULONG)mEntityFields.size();
+   fp.mContainerBytes = MapNodeBytes( mEntityFields );
+   if (bOwnStrings == true)
+   {
+      tDB2FieldMap::const_iterator pField = mEntityFields.begin();
+      while (pField != mEntityFields.end())
+      {
+         fp.mStringBytes += StringBytes( pField->second.mpName );
+         pField++;
+      }
+   }
 
-DESCRIPTION:
-   Is this object valid?
-  
-RETURN VALUE:
-   bool
-===========================================================================*/
-bool sDB2EnumEntry::IsValid() const
-{
-   // There has to be a non-empty name
-   if (mpName == 0 || mpName[0] == 0)
+   tables.push_back( fp );
+
+   // Enums
+   fp = sDB2TableFootprint();
+   fp.mpName = DB2_TABLE_ENUM_MAIN;
+   fp.mRecords = (ULONG)mEnumNameMap.size();
+   fp.mContainerBytes = MapNodeBytes( mEnumNameMap );
+   if (bOwnStrings == true)
    {
-      return false;
+      tDB2EnumNameMap::const_iterator pEnum = mEnumNameMap.begin();
+      while (pEnum != mEnumNameMap.end())
+      {
+         fp.mStringBytes += StringBytes( pEnum->second.mpName );
+         pEnum++;
+      }
    }
 
-   if (mDescriptionID < -1)
+   tables.push_back( fp );
+
+   // Enum entries
+   fp = sDB2TableFootprint();
+   fp.mpName = DB2_TABLE_ENUM_ENTRY;
+   fp.mRecords = (ULONG)mEnumEntryMap.size();
+   fp.mContainerBytes = MapNodeBytes( mEnumEntryMap );
+   if (bOwnStrings == true)
    {
-      return false;
+      tDB2EnumEntryMap::const_iterator pEntry = mEnumEntryMap.begin();
+      while (pEntry != mEnumEntryMap.end())
+      {
+         fp.mStringBytes += StringBytes( pEntry->second.mpName );
+         pEntry++;
+      }
    }
 
-   return true;
-}
+   tables.push_back( fp );
 
-/*=========================================================================*/
-// cCoreDatabase Methods
-/*=========================================================================*/
+   // Assembled enum map (strings reference the enum tables)
+   fp = sDB2TableFootprint();
+   fp.mpName = "Enum Map";
+   fp.mRecords = (ULONG)mEnumMap.size();
+   fp.mContainerBytes = MapNodeBytes( mEnumMap );
 
-/*===========================================================================
-METHOD:
-   cCoreDatabase (Public Method)
+   tDB2EnumMap::const_iterator pEnumMap = mEnumMap.begin();
+   while (pEnumMap != mEnumMap.end())
+   {
+      fp.mContainerBytes += MapNodeBytes( pEnumMap->second.second );
+      pEnumMap++;
+   }
 
-DESCRIPTION:
-   Constructor
-  
-RETURN VALUE:
-   None
-===========================================================================*/
-cCoreDatabase::cCoreDatabase()
-   :  mpLog( &gDB2DefaultLog )
-{
-   // Nothing to do - database empty, call Initialize()
-}
+   tables.push_back( fp );
 
-/*===========================================================================
-METHOD:
-   ~cCoreDatabase (Public Method)
+   // Parsed fragment modifiers (keys reference the fragment strings)
+   fp = sDB2TableFootprint();
+   fp.mpName = "Modifier";
+   fp.mRecords = (ULONG)mFragmentModMap.size();
+   fp.mContainerBytes = MapNodeBytes( mFragmentModMap )
+                      + MapNodeBytes( mOptionalModMap )
+                      + MapNodeBytes( mExpressionModMap )
+                      + MapNodeBytes( mArray1ModMap )
+                      + MapNodeBytes( mArray2ModMap );
 
-DESCRIPTION:
-   Destructor
-  
-RETURN VALUE:
-   None
-===========================================================================*/
-cCoreDatabase::~cCoreDatabase()
-{
-   Exit();
-}
+   tables.push_back( fp );
 
-/*===========================================================================
-METHOD:
-   Initialize (Public Method)
+   // Lookup indices
+   fp = sDB2TableFootprint();
+   fp.mpName = "Index";
+   fp.mContainerBytes = mEntityIndex.GetFootprint()
+                      + mEntityNameIndex.GetFootprint()
+                      + mFieldIndex.GetFootprint()
+                      + mEnumEntryIndex.GetFootprint();
 
-DESCRIPTION:
-   Version to Load from file
-   Initialize the database - this must be done once (and only once)
-   prior to the database being accessed
-  
-PARAMETERS
-   pBasePath         [ I ] - Base path to database files
+   tables.push_back( fp );
 
-RETURN VALUE:
-   bool
-===========================================================================*/
-bool cCoreDatabase::Initialize( LPCSTR pBasePath )
-{
-   bool bRC = true;
+   // Navigation trees built so far
+   fp = sDB2TableFootprint();
+   fp.mpName = "Navigation Tree";
 
-   // Cleanup the last database (if necessary)
-   Exit();
+   pthread_rwlock_rdlock( &mEntityNavLock );
 
-   bRC &= LoadEnumTables( pBasePath );
-   bRC &= LoadStructureTables( pBasePath );
+   fp.mRecords = (ULONG)mEntityNavMap.size();
+   fp.mContainerBytes = MapNodeBytes( mEntityNavMap );
 
-   // Build the modifier tables
-   bRC &= BuildModifierTables();
+   tDB2EntityNavMap::const_iterator pNav = mEntityNavMap.begin();
+   while (pNav != mEntityNavMap.end())
+   {
+      const cDB2NavTree * pTree = pNav->second;
+      pNav++;
 
-   return bRC;
-}
+      if (pTree == 0)
+      {
+         continue;
+      }
 
-/*===========================================================================
-METHOD:
-   Initialize (Public Method)
+      fp.mContainerBytes += HeapBlockSize( sizeof( cDB2NavTree ) );
+      fp.mContainerBytes += VectorBytes( pTree->GetFragments() );
+      fp.mContainerBytes += VectorBytes( pTree->GetProgram() );
+      fp.mContainerBytes += MapNodeBytes( pTree->GetTrackedFields() );
+   }
 
-DESCRIPTION:
-   Version to Load from internal pointers
-   Initialize the database - this must be done once (and only once)
-   prior to the database being accessed
-  
-PARAMETERS
+   pthread_rwlock_unlock( &mEntityNavLock );
 
-RETURN VALUE:
-   bool
-===========================================================================*/
-bool cCoreDatabase::Initialize()
-{
-   bool bRC = true;
+   tables.push_back( fp );
 
-   // Cleanup the last database (if necessary)
-   Exit();
+   // Entity field lists enumerated so far
+   fp = sDB2TableFootprint();
+   fp.mpName = "Entity Field List";
 
-   bRC &= LoadEnumTables();
-   bRC &= LoadStructureTables();
+   pthread_rwlock_rdlock( &mEntityFieldsLock );
 
-   // Build the modifier tables
-   bRC &= BuildModifierTables();
+   fp.mRecords = (ULONG)mEntityFieldsMap.size();
+   fp.mContainerBytes = MapNodeBytes( mEntityFieldsMap );
 
-   return bRC;
+   tDB2EntityFieldsMap::const_iterator pList = mEntityFieldsMap.begin();
+   while (pList != mEntityFieldsMap.end())
+   {
+      const sDB2EntityFields * pFields = pList->second;
+      pList++;
+
+      if (pFields == 0)
+      {
+         continue;
+      }
+
+      fp.mContainerBytes += HeapBlockSize( sizeof( sDB2EntityFields ) );
+      fp.mContainerBytes += VectorBytes( pFields->mFieldIDs );
+      fp.mContainerBytes += VectorBytes( pFields->mNames );
+      fp.mContainerBytes += MapNodeBytes( pFields->mNameIndex );
+
+      // Each name is held twice, by the names and by the index
+      ULONG nameCount = (ULONG)pFields->mNames.size();
+      for (ULONG n = 0; n < nameCount; n++)
+      {
+         fp.mStringBytes += 2 * HeapBlockSize( pFields->mNames[n].size() + 1 );
+      }
+   }
+
+   pthread_rwlock_unlock( &mEntityFieldsLock );
+
+   tables.push_back( fp );
+
+   // Table strings, either pooled in the arena or mapped from an image
+   if (mpStringArena != 0)
+   {
+      fp = sDB2TableFootprint();
+      fp.mpName = "String Arena";
+      fp.mStringBytes = HeapBlockSize( mStringArenaSz );
+      tables.push_back( fp );
+   }
+   else if (mpImage != 0)
+   {
+      fp = sDB2TableFootprint();
+      fp.mpName = "Image";
+      fp.mMappedBytes = mpImage->GetSize();
+      tables.push_back( fp );
+   }
+   else if (mpCompiledStrings != 0)
+   {
+      fp = sDB2TableFootprint();
+      fp.mpName = "Compiled Tables";
+      fp.mMappedBytes = mCompiledStringsSz;
+      tables.push_back( fp );
+   }
+
+   ULONG total = 0;
+   for (ULONG t = 0; t < (ULONG)tables.size(); t++)
+   {
+      total += tables[t].mContainerBytes + tables[t].mStringBytes;
+   }
+
+   return total;
 }
 
 /*===========================================================================
@@ -1743,12 +3130,40 @@ RETURN VALUE:
 ===========================================================================*/
 void cCoreDatabase::Exit()
 {
-   FreeDB2Table( mEntityFields );
-   FreeDB2Table( mEntityStructs );
-   FreeDB2Table( mProtocolEntities );
+   mEntityIndex.Clear();
+   mEntityNameIndex.Clear();
+   mFieldIndex.Clear();
+   mEnumEntryIndex.Clear();
+
+   // Image based strings live in the mapped string pool, compiled table
+   // strings in the linked in pool, compacted strings in the string arena
+   if (mpImage == 0 && mpCompiledStrings == 0 && mpStringArena == 0)
+   {
+      FreeDB2Table( mEntityFields );
+      FreeDB2Table( mEntityStructs );
+      FreeDB2Table( mProtocolEntities );
+
+      FreeDB2Table( mEnumNameMap );
+      FreeDB2Table( mEnumEntryMap );
+   }
+
+   mEntityFields.clear();
+   mEntityStructs.clear();
+   mProtocolEntities.clear();
+   mEntityNames.clear();
 
-   FreeDB2Table( mEnumNameMap );
-   FreeDB2Table( mEnumEntryMap );
+   mEnumNameMap.clear();
+   mEnumEntryMap.clear();
+   mEnumMap.clear();
+
+   // The modifier maps are keyed by the (now released) modifier strings
+   mOptionalModMap.clear();
+   mExpressionModMap.clear();
+   mArray1ModMap.clear();
+   mArray2ModMap.clear();
+   mFragmentModMap.clear();
+
+   pthread_rwlock_wrlock( &mEntityNavLock );
 
    tDB2EntityNavMap::iterator pIter = mEntityNavMap.begin();
    while (pIter != mEntityNavMap.end())
@@ -1763,6 +3178,41 @@ void cCoreDatabase::Exit()
    }
 
    mEntityNavMap.clear();
+
+   pthread_rwlock_unlock( &mEntityNavLock );
+
+   pthread_rwlock_wrlock( &mEntityFieldsLock );
+
+   tDB2EntityFieldsMap::iterator pFields = mEntityFieldsMap.begin();
+   while (pFields != mEntityFieldsMap.end())
+   {
+      if (pFields->second != 0)
+      {
+         delete pFields->second;
+      }
+
+      pFields++;
+   }
+
+   mEntityFieldsMap.clear();
+
+   pthread_rwlock_unlock( &mEntityFieldsLock );
+
+   if (mpImage != 0)
+   {
+      delete mpImage;
+      mpImage = 0;
+   }
+
+   mpCompiledStrings = 0;
+   mCompiledStringsSz = 0;
+
+   if (mpStringArena != 0)
+   {
+      delete [] mpStringArena;
+      mpStringArena = 0;
+      mStringArenaSz = 0;
+   }
 }
 
 /*===========================================================================
@@ -1794,14 +3244,33 @@ const cDB2NavTree * cCoreDatabase::GetEntityNavTree(
    }
 
    // Obtain the canonical key and use it to look up the nav tree
+   cDB2NavTree * pNavTree = 0;
+
+   pthread_rwlock_rdlock( &mEntityNavLock );
    tDB2EntityNavMap::const_iterator pIter = mEntityNavMap.find( key );
    if (pIter != mEntityNavMap.end())
    {
-      return pIter->second;
+      pNavTree = pIter->second;
+   }
+
+   pthread_rwlock_unlock( &mEntityNavLock );
+   if (pNavTree != 0)
+   {
+      return pNavTree;
+   }
+
+   // None found, go ahead and build one (re-checking under the write
+   // lock as another thread may have beaten us to it)
+   pthread_rwlock_wrlock( &mEntityNavLock );
+   pIter = mEntityNavMap.find( key );
+   if (pIter != mEntityNavMap.end())
+   {
+      pNavTree = pIter->second;
+      pthread_rwlock_unlock( &mEntityNavLock );
+      return pNavTree;
    }
 
-   // None found, go ahead and build one
-   cDB2NavTree * pNavTree = new cDB2NavTree( *this );
+   pNavTree = new cDB2NavTree( *this );
    if (pNavTree != 0)
    {
       bool bOK = pNavTree->BuildTree( key );
@@ -1818,7 +3287,86 @@ const cDB2NavTree * cCoreDatabase::GetEntityNavTree(
       }
    }
 
-   return pNavTree;
+   pthread_rwlock_unlock( &mEntityNavLock );
+   return pNavTree;
+}
+
+/*===========================================================================
+METHOD:
+   GetEntityFieldList (Public Method)
+
+DESCRIPTION:
+   Get the fields of the given protocol entity, if they have not been
+   enumerated yet they will be enumerated and returned
+
+   The result is shared by all users (and threads) and is never modified
+   once returned, it remains valid until the database is exited
+  
+PARAMETERS   
+   key         [ I ] - Protocol entity key
+
+RETURN VALUE:
+   const sDB2EntityFields * (0 upon error)
+===========================================================================*/
+const sDB2EntityFields * cCoreDatabase::GetEntityFieldList( 
+   const std::vector <ULONG> &   key ) const
+{
+   sDB2EntityFields * pFields = 0;
+
+   pthread_rwlock_rdlock( &mEntityFieldsLock );
+   tDB2EntityFieldsMap::const_iterator pIter = mEntityFieldsMap.find( key );
+   if (pIter != mEntityFieldsMap.end())
+   {
+      pFields = pIter->second;
+   }
+
+   pthread_rwlock_unlock( &mEntityFieldsLock );
+   if (pFields != 0)
+   {
+      return pFields;
+   }
+
+   // None found, enumerate the fields (without holding the lock, since 
+   // enumerating needs the navigation tree)
+   cProtocolEntityFieldEnumerator pefe( *this, key );
+   if (pefe.Enumerate() == false)
+   {
+      return 0;
+   }
+
+   pFields = new sDB2EntityFields;
+   if (pFields == 0)
+   {
+      return 0;
+   }
+
+   pFields->mFieldIDs = pefe.GetFields();
+   pFields->mNames = pefe.GetFieldNames();
+
+   ULONG fieldCount = (ULONG)pFields->mNames.size();
+   for (ULONG f = 0; f < fieldCount; f++)
+   {
+      // Keep the first of any duplicate names
+      std::pair <std::string, ULONG> e( pFields->mNames[f], f );
+      pFields->mNameIndex.insert( e );
+   }
+
+   // Store it, unless another thread has beaten us to it
+   pthread_rwlock_wrlock( &mEntityFieldsLock );
+   pIter = mEntityFieldsMap.find( key );
+   if (pIter != mEntityFieldsMap.end())
+   {
+      delete pFields;
+      pFields = pIter->second;
+   }
+   else
+   {
+      std::pair <std::vector <ULONG>, sDB2EntityFields *> e( key, pFields );
+      mEntityFieldsMap.insert( e );
+   }
+
+   pthread_rwlock_unlock( &mEntityFieldsLock );
+   return pFields;
 }
 
 /*===========================================================================
@@ -1842,9 +3390,26 @@ bool cCoreDatabase::FindEntity(
    // Assume failure
    bool bFound = false;
 
+   // Try the hash index first
+   ULONGLONG packed = 0;
+   const sDB2ProtocolEntity * pObj = 0;
+   if ( (PackEntityKey( key, packed ) == true)
+   &&   (mEntityIndex.Find( packed, pObj ) == true) )
+   {
+      if (pObj != 0)
+      {
+         ValidateEntity( *pObj );
+         entity = *pObj;
+         bFound = true;
+      }
+
+      return bFound;
+   }
+
    tDB2EntityMap::const_iterator pEntity = mProtocolEntities.find( key );
    if (pEntity != mProtocolEntities.end())
    {
+      ValidateEntity( pEntity->second );
       entity = pEntity->second;
       bFound = true;
    }
@@ -1874,11 +3439,10 @@ bool cCoreDatabase::FindEntity(
    bool bFound = false;
    if (pEntityName != 0 && pEntityName[0] != 0)
    {
-      tDB2EntityNameMap::const_iterator pIter = mEntityNames.find( pEntityName );
-      if (pIter != mEntityNames.end())
+      const std::vector <ULONG> * pKey = FindEntityKey( pEntityName );
+      if (pKey != 0)
       {
-         const std::vector <ULONG> & key = pIter->second;
-         bFound = FindEntity( key, entity );
+         bFound = FindEntity( *pKey, entity );
       }
    }
 
@@ -1922,10 +3486,10 @@ bool cCoreDatabase::MapEntityNameToID(
       tmp = tmp.substr( nFirst, nLast - nFirst + 1 );
      
       
-      tDB2EntityNameMap::const_iterator pIter = mEntityNames.find( tmp.c_str() );
-      if (pIter != mEntityNames.end())
+      const std::vector <ULONG> * pKey = FindEntityKey( tmp.c_str() );
+      if (pKey != 0)
       {
-         key = pIter->second;
+         key = *pKey;
          bOK = true;
       }
    }
@@ -1933,13 +3497,90 @@ bool cCoreDatabase::MapEntityNameToID(
    return bOK;
 }
 
+/*===========================================================================
+METHOD:
+   FindField (Public Method)
+
+DESCRIPTION:
+   Find the protocol field with the specified ID
+  
+PARAMETERS   
+   fieldID     [ I ] - ID of field to find
+
+RETURN VALUE:
+   const sDB2Field * - The field (0 if not found)
+===========================================================================*/
+const sDB2Field * cCoreDatabase::FindField( ULONG fieldID ) const
+{
+   const sDB2Field * pField = 0;
+   if (mFieldIndex.Find( fieldID, pField ) == true)
+   {
+      return pField;
+   }
+
+   tDB2FieldMap::const_iterator pIter = mEntityFields.find( fieldID );
+   if (pIter != mEntityFields.end())
+   {
+      pField = &pIter->second;
+   }
+
+   return pField;
+}
+
+/*===========================================================================
+METHOD:
+   FindEnumString (Public Method)
+
+DESCRIPTION:
+   Find the enum value name string for the given enum value (specified
+   by enum ID, and enum value), the string is owned by the database
+  
+PARAMETERS
+   enumID         [ I ] - ID of the enumeration
+   enumVal        [ I ] - Enum value to map
+
+RETURN VALUE:
+   LPCSTR - The enum name (0 if the enum value is not found)
+===========================================================================*/
+LPCSTR cCoreDatabase::FindEnumString( 
+   ULONG                      enumID,
+   int                        enumVal ) const
+{
+   LPCSTR pName = 0;
+
+   ULONGLONG packed = 0;
+   const sDB2EnumEntry * pEntry = 0;
+   if ( (PackEnumKey( enumID, enumVal, packed ) == true)
+   &&   (mEnumEntryIndex.Find( packed, pEntry ) == true) )
+   {
+      // The index answered (pEntry is 0 if the pair is not present)
+   }
+   else
+   {
+      // Look up the enum value descriptor
+      std::pair <ULONG, int> key( enumID, enumVal );
+      tDB2EnumEntryMap::const_iterator pVals = mEnumEntryMap.find( key );
+      if (pVals != mEnumEntryMap.end())
+      {
+         pEntry = &pVals->second;
+      }
+   }
+
+   if (pEntry != 0 && pEntry->mpName != 0 && pEntry->mpName[0] != 0)
+   {
+      pName = pEntry->mpName;
+   }
+
+   return pName;
+}
+
 /*===========================================================================
 METHOD:
    MapEnumToString (Public Method)
 
 DESCRIPTION:
    Map the given enum value (specified by enum ID, and enum value) to
-   the enum value name string
+   the enum value name string without allocating
   
 PARAMETERS
    enumID         [ I ] - ID of the enumeration
@@ -1951,51 +3592,79 @@ PARAMETERS
                           If 'false' then the enum ID, value, and 'Unknown'
 
    bHex           [ I ] - Hexadecimal output on mapping error?
+   pBuf           [ O ] - Buffer for the error string (should be at least
+                          DB2_ENUM_STRING_BUFFER_SIZE bytes)
+   bufLen         [ I ] - Size of above buffer (in bytes)
 
 RETURN VALUE:
-   std::string - The enum name (or error string if enum value is not found)
+   LPCSTR - The enum name (owned by the database), or the error string 
+            (in pBuf) if enum value is not found
 ===========================================================================*/
-std::string cCoreDatabase::MapEnumToString( 
+LPCSTR cCoreDatabase::MapEnumToString( 
    ULONG                      enumID,
    int                        enumVal,
    bool                       bSimpleErrFmt,
-   bool                       bHex ) const
+   bool                       bHex,
+   CHAR *                     pBuf,
+   ULONG                      bufLen ) const
 {
-   std::string retStr = "";
-
-   // Form the lookup key
-   std::pair <ULONG, int> key( enumID, enumVal );
-
-   // Look up the enum value descriptor
-   tDB2EnumEntryMap::const_iterator pVals = mEnumEntryMap.find( key );
-   if (pVals != mEnumEntryMap.end())
+   LPCSTR pName = FindEnumString( enumID, enumVal );
+   if (pName != 0)
    {
-      const sDB2EnumEntry & entry = pVals->second;
-      retStr = entry.mpName;
+      return pName;
    }
 
-   // No string?
-   if (retStr.size() <= 0)
+   if (pBuf == 0 || bufLen == 0)
    {
-      std::ostringstream tmp;
+      return EMPTY_STRING;
+   }
 
-      if (bSimpleErrFmt == false)
-      {
-         tmp << "Unknown [" << (UINT)enumID << "/";
-      }
-      
-      if (bHex == true)
-      {
-         tmp << std::ios_base::hex << std::ios_base::uppercase 
-                << std::ios_base::showbase << enumVal;
-      }
-      else
-      {
-         tmp << enumVal;
-      }
-      
-      retStr = tmp.str();
+   if (bSimpleErrFmt == true)
+   {
+      return FormatEnumValue( 0, enumVal, bHex, pBuf, bufLen );
    }
+
+   CHAR id[24];
+   snprintf( &id[0], sizeof( id ), "%u", (UINT)enumID );
+   return FormatEnumValue( &id[0], enumVal, bHex, pBuf, bufLen );
+}
+
+/*===========================================================================
+METHOD:
+   MapEnumToString (Public Method)
+
+DESCRIPTION:
+   Map the given enum value (specified by enum ID, and enum value) to
+   the enum value name string
+  
+PARAMETERS
+   enumID         [ I ] - ID of the enumeration
+   enumVal        [ I ] - Enum value to map
+   bSimpleErrFmt  [ I ] - If the eunum value cannot be mapped to a string
+                          what should this method return?
+
+                          If 'true' then just the value as a string
+                          If 'false' then the enum ID, value, and 'Unknown'
+
+   bHex           [ I ] - Hexadecimal output on mapping error?
+
+RETURN VALUE:
+   std::string - The enum name (or error string if enum value is not found)
+===========================================================================*/
+std::string cCoreDatabase::MapEnumToString( 
+   ULONG                      enumID,
+   int                        enumVal,
+   bool                       bSimpleErrFmt,
+   bool                       bHex ) const
+{
+   CHAR buf[DB2_ENUM_STRING_BUFFER_SIZE];
+
+   std::string retStr = MapEnumToString( enumID, 
+                                         enumVal, 
+                                         bSimpleErrFmt, 
+                                         bHex,
+                                         &buf[0],
+                                         DB2_ENUM_STRING_BUFFER_SIZE );
    
    return retStr;
 }
@@ -2028,50 +3697,34 @@ std::string cCoreDatabase::MapEnumToString(
    bool                       bSimpleErrFmt,
    bool                       bHex ) const
 {
-   std::string retStr = "";
-
-   tDB2EnumMap::const_iterator pEnumMapIter = mEnumMap.find( pEnumName );      
-   if (pEnumMapIter != mEnumMap.end())
+   LPCSTR pName = 0;
+   if (pEnumName != 0)
    {
-      const std::map <int, LPCSTR> & entries = pEnumMapIter->second.second;
-      std::map <int, LPCSTR>::const_iterator pEntry;
-
-      pEntry = entries.find( enumVal );
-      if (pEntry != entries.end())
+      tDB2EnumMap::const_iterator pEnumMapIter = mEnumMap.find( pEnumName );
+      if (pEnumMapIter != mEnumMap.end())
       {
-         retStr = pEntry->second;
+         pName = FindEnumString( pEnumMapIter->second.first, enumVal );
       }
    }
 
    // No string?
-   if (retStr.size() <= 0)
+   if (pName == 0)
    {
-      std::ostringstream tmp;
-
+      LPCSTR pPrefix = 0;
+      ULONG bufLen = DB2_ENUM_STRING_BUFFER_SIZE;
       if (bSimpleErrFmt == false)
       {
-         if (pEnumName == 0)
-         {
-            pEnumName = "?";
-         }
-         
-         tmp << "Unknown [" << pEnumName << "/";
-      }
-      
-      if (bHex == true)
-      {
-         tmp << std::ios_base::hex << std::ios_base::uppercase 
-                << std::ios_base::showbase << enumVal;
-      }
-      else
-      {
-         tmp << enumVal;
+         pPrefix = (pEnumName != 0 ? pEnumName : "?");
+
+         // The enum name may be of any length
+         bufLen += (ULONG)strlen( pPrefix );
       }
-      
-      retStr = tmp.str();
+
+      std::vector <CHAR> buf( (SIZE_T)bufLen );
+      return FormatEnumValue( pPrefix, enumVal, bHex, &buf[0], bufLen );
    }
    
-   return retStr;
+   return pName;
 }
 
 /*===========================================================================
@@ -2320,6 +3973,7 @@ bool cCoreDatabase::BuildModifierTables()
          {
             ULONG val = strtoul( frag.mpModifierValue, 0, 0 );
             mArray1ModMap[frag.mpModifierValue] = val;
+            mFragmentModMap[&frag].mValue = val;
          }
          break;
 
@@ -2346,51 +4000,292 @@ bool cCoreDatabase::BuildModifierTables()
                val.first  = indices[0];
                val.second = indices[1];
                mArray2ModMap[frag.mpModifierValue] = val;
+
+               sDB2FragmentModifier & mod = mFragmentModMap[&frag];
+               mod.mValue = val.first;
+               mod.mStopID = val.second;
+            }
+         }
+         break;
+
+         case eDB2_MOD_OPTIONAL:
+         {
+            sDB2SimpleCondition con;
+
+            // Parse condition to tokens (field ID operator value)
+            bool bRC = sDB2Fragment::ParseCondition( frag.mpModifierValue, 
+                                                     con.mID, 
+                                                     con.mOperator,
+                                                     con.mValue,
+                                                     con.mbF2F );
+
+            if (bRC == true)
+            {
+               mOptionalModMap[frag.mpModifierValue] = con;
+               mFragmentModMap[&frag].mCondition = con;
+            }
+         }
+         break;
+
+         case eDB2_MOD_VARIABLE_ARRAY3:
+         {
+            sDB2SimpleExpression exp;
+
+            // Parse condition to tokens (field ID operator value)
+            bool bRC = sDB2Fragment::ParseExpression( frag.mpModifierValue, 
+                                                      exp.mID, 
+                                                      exp.mOperator,
+                                                      exp.mValue,
+                                                      exp.mbF2F );
+
+            if (bRC == true)
+            {
+               mExpressionModMap[frag.mpModifierValue] = exp;
+               mFragmentModMap[&frag].mExpression = exp;
             }
          }
          break;
+      }
+   }
+
+   return bOK;
+}
+
+
+/*===========================================================================
+METHOD:
+   BuildIndices (Internal Method)
+
+DESCRIPTION:
+   Build the flat hash indices used to speed up entity, entity name, 
+   and field lookups (the maps remain the authoritative tables)
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+void cCoreDatabase::BuildIndices()
+{
+   // Protocol entities, keys that cannot be packed stay map only
+   mEntityIndex.Reserve( (ULONG)mProtocolEntities.size() );
+
+   tDB2EntityMap::const_iterator pEntity = mProtocolEntities.begin();
+   while (pEntity != mProtocolEntities.end())
+   {
+      ULONGLONG packed = 0;
+      if (PackEntityKey( pEntity->first, packed ) == true)
+      {
+         // Duplicate keys keep the first entity, as the map does
+         mEntityIndex.Insert( packed, &pEntity->second );
+      }
+
+      pEntity++;
+   }
+
+   // Protocol entity names, (unlikely) hash collisions between
+   // different names fall back to the map
+   mEntityNameIndex.Reserve( (ULONG)mEntityNames.size() );
+
+   tDB2EntityNameMap::const_iterator pName = mEntityNames.begin();
+   while (pName != mEntityNames.end())
+   {
+      ULONGLONG hash = HashEntityName( pName->first );
+      if (mEntityNameIndex.Insert( hash, &(*pName) ) == false)
+      {
+         mEntityNameIndex.SetAmbiguous( hash );
+      }
+
+      pName++;
+   }
+
+   // Protocol fields
+   mFieldIndex.Reserve( (ULONG)mEntityFields.size() );
+
+   tDB2FieldMap::const_iterator pField = mEntityFields.begin();
+   while (pField != mEntityFields.end())
+   {
+      mFieldIndex.Insert( pField->first, &pField->second );
+      pField++;
+   }
+
+   // Enum entries, pairs that cannot be packed stay map only
+   mEnumEntryIndex.Reserve( (ULONG)mEnumEntryMap.size() );
+
+   tDB2EnumEntryMap::const_iterator pEntry = mEnumEntryMap.begin();
+   while (pEntry != mEnumEntryMap.end())
+   {
+      ULONGLONG packed = 0;
+      if (PackEnumKey( pEntry->first.first, pEntry->first.second, packed ) == true)
+      {
+         mEnumEntryIndex.Insert( packed, &pEntry->second );
+      }
+
+      pEntry++;
+   }
+}
+
+/*===========================================================================
+METHOD:
+   CompactStrings (Internal Method)
+
+DESCRIPTION:
+   Move all table strings into a single string arena, each distinct 
+   string stored once, replacing the (many, often duplicated) strings
+   allocated by the records as the tables were parsed
+
+   Must be done before the modifier tables and indices are built, as 
+   those reference strings by address
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+void cCoreDatabase::CompactStrings()
+{
+   // Image (and compiled table) strings are already pooled
+   if (mpImage != 0 || mpCompiledStrings != 0 || mpStringArena != 0)
+   {
+      return;
+   }
+
+   // Pool the distinct strings, as a database image does
+   cDB2ImageWriter pool;
+
+   tDB2EntityMap::iterator pEntity = mProtocolEntities.begin();
+   for (; pEntity != mProtocolEntities.end(); pEntity++)
+   {
+      pool.AddString( pEntity->second.mpName );
+   }
+
+   tDB2FragmentMap::iterator pFrag = mEntityStructs.begin();
+   for (; pFrag != mEntityStructs.end(); pFrag++)
+   {
+      pool.AddString( pFrag->second.mpName );
+      pool.AddString( pFrag->second.mpModifierValue );
+   }
+
+   tDB2FieldMap::iterator pField = mEntityFields.begin();
+   for (; pField != mEntityFields.end(); pField++)
+   {
+      pool.AddString( pField->second.mpName );
+   }
+
+   tDB2EnumNameMap::iterator pEnum = mEnumNameMap.begin();
+   for (; pEnum != mEnumNameMap.end(); pEnum++)
+   {
+      pool.AddString( pEnum->second.mpName );
+   }
+
+   tDB2EnumEntryMap::iterator pEntry = mEnumEntryMap.begin();
+   for (; pEntry != mEnumEntryMap.end(); pEntry++)
+   {
+      pool.AddString( pEntry->second.mpName );
+   }
+
+   mStringArenaSz = (ULONG)pool.mStrings.size();
+   mpStringArena = new CHAR[mStringArenaSz];
+   memcpy( (LPVOID)mpStringArena, (LPCVOID)&pool.mStrings[0], mStringArenaSz );
+
+   // Re-key the name maps while the record strings still exist (the 
+   // order is unchanged, keys compare by content)
+   tDB2EntityNameMap names;
+   tDB2EntityNameMap::const_iterator pName = mEntityNames.begin();
+   for (; pName != mEntityNames.end(); pName++)
+   {
+      LPCSTR pKey = ArenaString( pool, mpStringArena, pName->first );
+      names.insert( names.end(), 
+                    tDB2EntityNameMap::value_type( pKey, pName->second ) );
+   }
+
+   mEntityNames.swap( names );
+
+   tDB2EnumMap enums;
+   tDB2EnumMap::const_iterator pEnumMap = mEnumMap.begin();
+   for (; pEnumMap != mEnumMap.end(); pEnumMap++)
+   {
+      tDB2EnumMapPair val = pEnumMap->second;
+
+      std::map <int, LPCSTR>::iterator pVal = val.second.begin();
+      for (; pVal != val.second.end(); pVal++)
+      {
+         pVal->second = ArenaString( pool, mpStringArena, pVal->second );
+      }
+
+      LPCSTR pKey = ArenaString( pool, mpStringArena, pEnumMap->first );
+      enums.insert( enums.end(), tDB2EnumMap::value_type( pKey, val ) );
+   }
+
+   mEnumMap.swap( enums );
+
+   // Now point the records at the arena
+   for (pEntity = mProtocolEntities.begin(); pEntity != mProtocolEntities.end(); pEntity++)
+   {
+      MoveToArena( pool, mpStringArena, pEntity->second.mpName );
+   }
 
-         case eDB2_MOD_OPTIONAL:
-         {
-            sDB2SimpleCondition con;
+   for (pFrag = mEntityStructs.begin(); pFrag != mEntityStructs.end(); pFrag++)
+   {
+      MoveToArena( pool, mpStringArena, pFrag->second.mpName );
+      MoveToArena( pool, mpStringArena, pFrag->second.mpModifierValue );
+   }
 
-            // Parse condition to tokens (field ID operator value)
-            bool bRC = sDB2Fragment::ParseCondition( frag.mpModifierValue, 
-                                                     con.mID, 
-                                                     con.mOperator,
-                                                     con.mValue,
-                                                     con.mbF2F );
+   for (pField = mEntityFields.begin(); pField != mEntityFields.end(); pField++)
+   {
+      MoveToArena( pool, mpStringArena, pField->second.mpName );
+   }
 
-            if (bRC == true)
-            {
-               mOptionalModMap[frag.mpModifierValue] = con;
-            }
-         }
-         break;
+   for (pEnum = mEnumNameMap.begin(); pEnum != mEnumNameMap.end(); pEnum++)
+   {
+      MoveToArena( pool, mpStringArena, pEnum->second.mpName );
+   }
 
-         case eDB2_MOD_VARIABLE_ARRAY3:
-         {
-            sDB2SimpleExpression exp;
+   for (pEntry = mEnumEntryMap.begin(); pEntry != mEnumEntryMap.end(); pEntry++)
+   {
+      MoveToArena( pool, mpStringArena, pEntry->second.mpName );
+   }
+}
 
-            // Parse condition to tokens (field ID operator value)
-            bool bRC = sDB2Fragment::ParseExpression( frag.mpModifierValue, 
-                                                      exp.mID, 
-                                                      exp.mOperator,
-                                                      exp.mValue,
-                                                      exp.mbF2F );
+/*===========================================================================
+METHOD:
+   FindEntityKey (Internal Method)
 
-            if (bRC == true)
-            {
-               mExpressionModMap[frag.mpModifierValue] = exp;
-            }
-         }
-         break;
+DESCRIPTION:
+   Find the protocol entity key for the given (trimmed) name
+  
+PARAMETERS
+   pName       [ I ] - Protocol entity name
+
+RETURN VALUE:
+   const std::vector <ULONG> * - The key (0 if not found)
+===========================================================================*/
+const std::vector <ULONG> * cCoreDatabase::FindEntityKey( LPCSTR pName ) const
+{
+   const std::vector <ULONG> * pKey = 0;
+   if (pName == 0 || pName[0] == 0)
+   {
+      return pKey;
+   }
+
+   // The name index is keyed by a (case insensitive) hash, so confirm
+   // the name itself before trusting a match
+   const tDB2EntityNameMap::value_type * pEntry = 0;
+   if (mEntityNameIndex.Find( HashEntityName( pName ), pEntry ) == true)
+   {
+      if ( (pEntry != 0)
+      &&   (strcasecmp( pEntry->first, pName ) == 0) )
+      {
+         pKey = &pEntry->second;
       }
+
+      return pKey;
    }
 
-   return bOK;
-}
+   tDB2EntityNameMap::const_iterator pIter = mEntityNames.find( pName );
+   if (pIter != mEntityNames.end())
+   {
+      pKey = &pIter->second;
+   }
 
+   return pKey;
+}
 
 /*===========================================================================
 METHOD:
@@ -2426,10 +4321,13 @@ std::string cCoreDatabase::CheckAndSetBasePath( LPCSTR pBasePath ) const
 
 /*===========================================================================
 METHOD:
-   LoadStructureTables (Internal Method)
+   LoadTables (Internal Method)
 
 DESCRIPTION:
-   Load all tables related to structure (entity, struct, field, format spec)
+   Load all tables (structure and enumeration related) from file
+
+   The tables are loaded in parallel, protocol entity structures are 
+   validated as each entity is first looked up (see FindEntity())
   
 PARAMETERS
    pBasePath   [ I ] - Base path to database files
@@ -2437,39 +4335,38 @@ PARAMETERS
 RETURN VALUE:
    bool
 ===========================================================================*/
-bool cCoreDatabase::LoadStructureTables( LPCSTR pBasePath )
+bool cCoreDatabase::LoadTables( LPCSTR pBasePath )
 {
    bool bRC = true;
 
    std::string basePath = CheckAndSetBasePath( pBasePath );
    basePath += "/";
 
-   std::string fn = basePath;
-   fn += DB2_FILE_PROTOCOL_FIELD;
-   bRC &= LoadDB2Table( (LPCSTR)fn.c_str(), 
-                        mEntityFields, 
-                        false, 
-                        DB2_TABLE_PROTOCOL_FIELD, 
-                        *mpLog );
-
-   fn = basePath;
-   fn += DB2_FILE_PROTOCOL_STRUCT;
-   bRC &= LoadDB2Table( (LPCSTR)fn.c_str(), 
-                        mEntityStructs, 
-                        false,
-                        DB2_TABLE_PROTOCOL_STRUCT,
-                        *mpLog );
-
-   fn = basePath;
-   fn += DB2_FILE_PROTOCOL_ENTITY;
-   bRC &= LoadDB2Table( (LPCSTR)fn.c_str(), 
-                        mProtocolEntities, 
-                        false,
-                        DB2_TABLE_PROTOCOL_ENTITY,
-                        *mpLog );
-
-   // Validate protocol entities
-   bRC &= ValidateStructures();
+   sDB2TableLoad loads[5];
+   loads[0].SetFile( mEntityFields, 
+                     basePath + DB2_FILE_PROTOCOL_FIELD,
+                     DB2_TABLE_PROTOCOL_FIELD );
+
+   loads[1].SetFile( mEntityStructs, 
+                     basePath + DB2_FILE_PROTOCOL_STRUCT,
+                     DB2_TABLE_PROTOCOL_STRUCT );
+
+   loads[2].SetFile( mProtocolEntities, 
+                     basePath + DB2_FILE_PROTOCOL_ENTITY,
+                     DB2_TABLE_PROTOCOL_ENTITY );
+
+   loads[3].SetFile( mEnumNameMap, 
+                     basePath + DB2_FILE_ENUM_MAIN,
+                     DB2_TABLE_ENUM_MAIN );
+
+   loads[4].SetFile( mEnumEntryMap, 
+                     basePath + DB2_FILE_ENUM_ENTRY,
+                     DB2_TABLE_ENUM_ENTRY );
+
+   bRC &= RunTableLoads( &loads[0], 5, *mpLog );
+
+   // Build the enum map
+   bRC &= AssembleEnumMap();
 
    // Build internal protocol entity name map
    bRC &= AssembleEntityNameMap();
@@ -2479,168 +4376,586 @@ bool cCoreDatabase::LoadStructureTables( LPCSTR pBasePath )
 
 /*===========================================================================
 METHOD:
-   LoadStructureTables (Internal Method)
+   LoadTables (Internal Method)
 
 DESCRIPTION:
-   Load all tables related to structure (entity, struct, field)
+   Load all tables (structure and enumeration related) from the internal
+   (linked in) tables
+
+   The tables are loaded in parallel, protocol entity structures are 
+   validated as each entity is first looked up (see FindEntity()) unless
+   the internal tables are trusted (see SetTrusted())
   
 PARAMETERS
 
 RETURN VALUE:
    bool
 ===========================================================================*/
-bool cCoreDatabase::LoadStructureTables()
+bool cCoreDatabase::LoadTables()
 {
    bool bRC = true;
 
-   // Calculate sizes
-   int nFieldSize =  (const char*)&_binary_QMI_Field_txt_end - 
-                           (const char*)&_binary_QMI_Field_txt_start;
-   int nStructSize = (const char*)&_binary_QMI_Struct_txt_end - 
-                           (const char*)&_binary_QMI_Struct_txt_start;
-   int nEntitySize = (const char*)&_binary_QMI_Entity_txt_end - 
-                           (const char*)&_binary_QMI_Entity_txt_start;
-
-   bRC &= LoadDB2Table( (const char*)&_binary_QMI_Field_txt_start,
-                        nFieldSize, 
-                        mEntityFields, 
-                        false,
-                        DB2_TABLE_PROTOCOL_FIELD,
-                        *mpLog );
-
-   bRC &= LoadDB2Table( (const char*)&_binary_QMI_Struct_txt_start,
-                        nStructSize, 
-                        mEntityStructs, 
-                        false,
-                        DB2_TABLE_PROTOCOL_STRUCT,
-                        *mpLog );
-
-   bRC &= LoadDB2Table( (const char*)&_binary_QMI_Entity_txt_start,
-                        nEntitySize, 
-                        mProtocolEntities, 
-                        false,
-                        DB2_TABLE_PROTOCOL_ENTITY,
-                        *mpLog );
-
-   // Validate protocol entities
-   bRC &= ValidateStructures();
+   sDB2TableLoad loads[5];
+   loads[0].SetText( mEntityFields, 
+                     (const char*)&_binary_QMI_Field_txt_start,
+                     (const char*)&_binary_QMI_Field_txt_end,
+                     DB2_TABLE_PROTOCOL_FIELD );
+
+   loads[1].SetText( mEntityStructs, 
+                     (const char*)&_binary_QMI_Struct_txt_start,
+                     (const char*)&_binary_QMI_Struct_txt_end,
+                     DB2_TABLE_PROTOCOL_STRUCT );
+
+   loads[2].SetText( mProtocolEntities, 
+                     (const char*)&_binary_QMI_Entity_txt_start,
+                     (const char*)&_binary_QMI_Entity_txt_end,
+                     DB2_TABLE_PROTOCOL_ENTITY );
+
+   loads[3].SetText( mEnumNameMap, 
+                     (const char*)&_binary_QMI_Enum_txt_start,
+                     (const char*)&_binary_QMI_Enum_txt_end,
+                     DB2_TABLE_ENUM_MAIN );
+
+   loads[4].SetText( mEnumEntryMap, 
+                     (const char*)&_binary_QMI_EnumEntry_txt_start,
+                     (const char*)&_binary_QMI_EnumEntry_txt_end,
+                     DB2_TABLE_ENUM_ENTRY );
+
+   bRC &= RunTableLoads( &loads[0], 5, *mpLog );
+
+   // Build the enum map
+   bRC &= AssembleEnumMap();
 
    // Build internal protocol entity name map
    bRC &= AssembleEntityNameMap();
 
+   // The internal tables are checked when they are built in, so when
+   // trusted there is nothing left to validate
+   if (mbTrusted == true)
+   {
+      MarkValidated();
+   }
+
    return bRC;
 }
 
 /*===========================================================================
 METHOD:
-   LoadEnumTables (Internal Method)
+   LoadImage (Internal Method)
 
 DESCRIPTION:
-   Load all enumeration tables 
+   Load all tables from a precompiled database image, the image is
+   memory mapped and table strings reference the image string pool
+   directly, so nothing is parsed or copied beyond the table maps
+   themselves (the image holds already validated tables)
   
 PARAMETERS
-   pBasePath   [ I ] - Base path to database files
+   pImageFile     [ I ] - Precompiled database image file
+   bCheckEmbedded [ I ] - Require the image to have been compiled from
+                          the internal (embedded) tables?
 
 RETURN VALUE:
    bool
 ===========================================================================*/
-bool cCoreDatabase::LoadEnumTables( LPCSTR pBasePath )
+bool cCoreDatabase::LoadImage( 
+   LPCSTR                     pImageFile,
+   bool                       bCheckEmbedded )
 {
-   bool bRC = true;
+   // Assume failure
+   bool bRC = false;
+   if (pImageFile == 0 || pImageFile[0] == 0)
+   {
+      return bRC;
+   }
 
-   std::string basePath = CheckAndSetBasePath( pBasePath );
-   basePath += "/";
+   // Quietly ignore a missing image
+   struct stat fileInfo;
+   if (stat( pImageFile, &fileInfo ) != 0)
+   {
+      return bRC;
+   }
 
+   mpImage = new cMemoryMappedFile( pImageFile );
+   if (mpImage == 0 || mpImage->GetStatus() != NO_ERROR)
+   {
+      return bRC;
+   }
 
-   std::string fn = basePath;
-   fn += DB2_FILE_ENUM_MAIN;
-   bRC &= LoadDB2Table( (LPCSTR)fn.c_str(), 
-                        mEnumNameMap, 
-                        false,
-                        DB2_TABLE_ENUM_MAIN,
-                        *mpLog );
+   const BYTE * pImage = (const BYTE *)mpImage->GetContents();
+   ULONG imageSz = mpImage->GetSize();
 
-   fn = basePath;
-   fn += DB2_FILE_ENUM_ENTRY;
-   bRC &= LoadDB2Table( (LPCSTR)fn.c_str(), 
-                        mEnumEntryMap, 
-                        false,
-                        DB2_TABLE_ENUM_ENTRY,
-                        *mpLog );
+   std::ostringstream err;
+   err << "DB image \'" << pImageFile << "\' ";
 
-   // Build the enum map
-   bRC &= AssembleEnumMap();
+   if (imageSz < sizeof( sDB2ImageHeader ))
+   {
+      err << "truncated";
+      mpLog->Log( err.str(), eDB2_STATUS_ERROR );
+      return bRC;
+   }
+
+   const sDB2ImageHeader & hdr = *(const sDB2ImageHeader *)pImage;
+   if ( (hdr.mMagic != DB2_IMAGE_MAGIC)
+   ||   (hdr.mVersion != DB2_IMAGE_VERSION)
+   ||   (hdr.mSize != imageSz) )
+   {
+      err << "has an unsupported format";
+      mpLog->Log( err.str(), eDB2_STATUS_ERROR );
+      return bRC;
+   }
+
+   if (bCheckEmbedded == true)
+   {
+      sDB2ImageText text[DB2_IMAGE_TEXT_COUNT];
+      GetEmbeddedText( &text[0] );
+
+      bool bMatch = true;
+      for (ULONG t = 0; t < DB2_IMAGE_TEXT_COUNT; t++)
+      {
+         if ( (hdr.mText[t].mSize != text[t].mSize)
+         ||   (hdr.mText[t].mCRC != text[t].mCRC) )
+         {
+            bMatch = false;
+         }
+      }
+
+      if (bMatch == false)
+      {
+         err << "does not match the internal database, ignored";
+         mpLog->Log( err.str(), eDB2_STATUS_WARNING );
+         return bRC;
+      }
+   }
+
+   // Validate the string pool, it must be terminated
+   ULONG poolSz = hdr.mStrings.mCount;
+   if ( (poolSz == 0)
+   ||   (hdr.mStrings.mOffset > imageSz)
+   ||   (poolSz > imageSz - hdr.mStrings.mOffset)
+   ||   (pImage[hdr.mStrings.mOffset + poolSz - 1] != 0) )
+   {
+      err << "has a corrupt string pool";
+      mpLog->Log( err.str(), eDB2_STATUS_ERROR );
+      return bRC;
+   }
+
+   LPCSTR pPool = (LPCSTR)(pImage + hdr.mStrings.mOffset);
+
+   const sDB2ImageEntity * pEntities = (const sDB2ImageEntity *)
+      GetImageTable( pImage, 
+                     imageSz, 
+                     hdr.mEntities, 
+                     sizeof( sDB2ImageEntity ) );
+   const sDB2ImageEntityName * pNames = (const sDB2ImageEntityName *)
+      GetImageTable( pImage, 
+                     imageSz, 
+                     hdr.mEntityNames, 
+                     sizeof( sDB2ImageEntityName ) );
+   const UINT * pEntityIDs = (const UINT *)
+      GetImageTable( pImage, 
+                     imageSz, 
+                     hdr.mEntityIDs, 
+                     sizeof( UINT ) );
+   const sDB2ImageFragment * pFrags = (const sDB2ImageFragment *)
+      GetImageTable( pImage, 
+                     imageSz, 
+                     hdr.mFragments, 
+                     sizeof( sDB2ImageFragment ) );
+   const sDB2ImageField * pFields = (const sDB2ImageField *)
+      GetImageTable( pImage, 
+                     imageSz, 
+                     hdr.mFields, 
+                     sizeof( sDB2ImageField ) );
+   const sDB2ImageEnum * pEnums = (const sDB2ImageEnum *)
+      GetImageTable( pImage, 
+                     imageSz, 
+                     hdr.mEnums, 
+                     sizeof( sDB2ImageEnum ) );
+   const sDB2ImageEnumEntry * pEntries = (const sDB2ImageEnumEntry *)
+      GetImageTable( pImage, 
+                     imageSz, 
+                     hdr.mEnumEntries, 
+                     sizeof( sDB2ImageEnumEntry ) );
+
+   if ( (pEntities == 0 && hdr.mEntities.mCount != 0)
+   ||   (pNames == 0 && hdr.mEntityNames.mCount != 0)
+   ||   (pEntityIDs == 0 && hdr.mEntityIDs.mCount != 0)
+   ||   (pFrags == 0 && hdr.mFragments.mCount != 0)
+   ||   (pFields == 0 && hdr.mFields.mCount != 0)
+   ||   (pEnums == 0 && hdr.mEnums.mCount != 0) 
+   ||   (pEntries == 0 && hdr.mEnumEntries.mCount != 0) )
+   {
+      err << "has a corrupt table";
+      mpLog->Log( err.str(), eDB2_STATUS_ERROR );
+      return bRC;
+   }
+
+   sDB2ImageView view;
+   view.mpEntities = pEntities;
+   view.mEntityCount = hdr.mEntities.mCount;
+   view.mpEntityNames = pNames;
+   view.mEntityNameCount = hdr.mEntityNames.mCount;
+   view.mpEntityIDs = pEntityIDs;
+   view.mEntityIDCount = hdr.mEntityIDs.mCount;
+   view.mpFragments = pFrags;
+   view.mFragmentCount = hdr.mFragments.mCount;
+   view.mpFields = pFields;
+   view.mFieldCount = hdr.mFields.mCount;
+   view.mpEnums = pEnums;
+   view.mEnumCount = hdr.mEnums.mCount;
+   view.mpEnumEntries = pEntries;
+   view.mEnumEntryCount = hdr.mEnumEntries.mCount;
+   view.mpStrings = pPool;
+   view.mStringsSz = poolSz;
+
+   // Structures are validated before an image is saved
+   if (LoadImageView( view, true ) == false)
+   {
+      err << "has a corrupt record";
+      mpLog->Log( err.str(), eDB2_STATUS_ERROR );
+      return bRC;
+   }
+
+   // The tables (and entity name map) were validated and assembled when 
+   // the image was compiled, only the remaining lookup maps are built
+   bRC = AssembleEnumMap();
+   bRC &= BuildModifierTables();
 
    return bRC;
 }
 
 /*===========================================================================
 METHOD:
-   LoadEnumTables (Internal Method)
+   LoadImageView (Internal Method)
 
 DESCRIPTION:
-   Load all enumeration tables 
+   Load all tables from the record arrays of a precompiled database, 
+   table strings reference the string pool directly
   
 PARAMETERS
+   view        [ I ] - Record arrays and string pool
+   bValidated  [ I ] - Were protocol entity structures validated when
+                       the records were compiled?
 
 RETURN VALUE:
    bool
 ===========================================================================*/
-bool cCoreDatabase::LoadEnumTables()
+bool cCoreDatabase::LoadImageView( 
+   const sDB2ImageView &      view,
+   bool                       bValidated )
 {
-   bool bRC = true;
-   // Calculate sizes
-   int nEnumSize = (const char*)&_binary_QMI_Enum_txt_end - 
-                           (const char*)&_binary_QMI_Enum_txt_start;
-   int nEnumEntrySize = (const char*)&_binary_QMI_EnumEntry_txt_end -
-                           (const char*)&_binary_QMI_EnumEntry_txt_start;
-
-   bRC &= LoadDB2Table( (const char*)&_binary_QMI_Enum_txt_start,
-                        nEnumSize,
-                        mEnumNameMap, 
-                        false,
-                        DB2_TABLE_ENUM_MAIN,
-                        *mpLog );
-
-   bRC &= LoadDB2Table( (const char*)&_binary_QMI_EnumEntry_txt_start,
-                        nEnumEntrySize,
-                        mEnumEntryMap, 
-                        false,
-                        DB2_TABLE_ENUM_ENTRY,
-                        *mpLog );
+   bool bOK = true;
 
-   // Build the enum map
-   bRC &= AssembleEnumMap();
+   // Records are stored in key order, so hinted inserts are constant time
+   // (records not validated when compiled are at least checked for sanity)
+   ULONG r;
+   for (r = 0; r < view.mEntityCount && bOK == true; r++)
+   {
+      const sDB2ImageEntity & rec = view.mpEntities[r];
+      if ( (rec.mIDIndex > view.mEntityIDCount)
+      ||   (rec.mIDCount > view.mEntityIDCount - rec.mIDIndex) )
+      {
+         bOK = false;
+         break;
+      }
+
+      sDB2ProtocolEntity obj;
+      obj.mType = (eDB2EntityType)rec.mType;
+      const UINT * pKey = view.mpEntityIDs + rec.mIDIndex;
+      obj.mID.assign( pKey, pKey + rec.mIDCount );
+      obj.mStructID = rec.mStructID;
+      obj.mFormatID = rec.mFormatID;
+      obj.mFormatExID = rec.mFormatExID;
+      obj.mbInternal = (rec.mbInternal != 0);
+      obj.mpName = GetImageString( view.mpStrings, 
+                                   view.mStringsSz, 
+                                   rec.mName, 
+                                   bOK );
+
+      obj.mbValidated = bValidated;
+      if (bValidated == false && obj.IsValid() == false)
+      {
+         bOK = false;
+         break;
+      }
+
+      mProtocolEntities.insert( mProtocolEntities.end(),
+                                tDB2EntityMap::value_type( obj.mID, obj ) );
+   }
+
+   for (r = 0; r < view.mEntityNameCount && bOK == true; r++)
+   {
+      const sDB2ImageEntityName & rec = view.mpEntityNames[r];
+      if ( (rec.mIDIndex > view.mEntityIDCount)
+      ||   (rec.mIDCount > view.mEntityIDCount - rec.mIDIndex) )
+      {
+         bOK = false;
+         break;
+      }
+
+      const UINT * pKey = view.mpEntityIDs + rec.mIDIndex;
+      std::vector <ULONG> key( pKey, pKey + rec.mIDCount );
+
+      LPCSTR pName = GetImageString( view.mpStrings, 
+                                     view.mStringsSz, 
+                                     rec.mName, 
+                                     bOK );
+      mEntityNames.insert( mEntityNames.end(),
+                           tDB2EntityNameMap::value_type( pName, key ) );
+   }
+
+   for (r = 0; r < view.mFragmentCount && bOK == true; r++)
+   {
+      const sDB2ImageFragment & rec = view.mpFragments[r];
+
+      sDB2Fragment obj;
+      obj.mStructID = rec.mStructID;
+      obj.mFragmentOrder = rec.mFragmentOrder;
+      obj.mFragmentOffset = rec.mFragmentOffset;
+      obj.mFragmentType = (eDB2FragmentType)rec.mFragmentType;
+      obj.mFragmentValue = rec.mFragmentValue;
+      obj.mModifierType = (eDB2ModifierType)rec.mModifierType;
+      obj.mpModifierValue = GetImageString( view.mpStrings, 
+                                            view.mStringsSz, 
+                                            rec.mModifierValue, 
+                                            bOK );
+      obj.mpName = GetImageString( view.mpStrings, 
+                                   view.mStringsSz, 
+                                   rec.mName, 
+                                   bOK );
+
+      if (bValidated == false && obj.IsValid() == false)
+      {
+         bOK = false;
+         break;
+      }
+
+      mEntityStructs.insert( mEntityStructs.end(),
+                             tDB2FragmentMap::value_type( obj.GetKey(), obj ) );
+   }
+
+   for (r = 0; r < view.mFieldCount && bOK == true; r++)
+   {
+      const sDB2ImageField & rec = view.mpFields[r];
+
+      sDB2Field obj;
+      obj.mID = rec.mID;
+      obj.mSize = rec.mSize;
+      obj.mType = (eDB2FieldType)rec.mType;
+      obj.mTypeVal = rec.mTypeVal;
+      obj.mbHex = (rec.mbHex != 0);
+      obj.mbInternal = (rec.mbInternal != 0);
+      obj.mDescriptionID = rec.mDescriptionID;
+      obj.mpName = GetImageString( view.mpStrings, 
+                                   view.mStringsSz, 
+                                   rec.mName, 
+                                   bOK );
+
+      if (bValidated == false && obj.IsValid() == false)
+      {
+         bOK = false;
+         break;
+      }
+
+      mEntityFields.insert( mEntityFields.end(),
+                            tDB2FieldMap::value_type( obj.mID, obj ) );
+   }
+
+   for (r = 0; r < view.mEnumCount && bOK == true; r++)
+   {
+      const sDB2ImageEnum & rec = view.mpEnums[r];
+
+      sDB2Enum obj;
+      obj.mID = rec.mID;
+      obj.mbInternal = (rec.mbInternal != 0);
+      obj.mDescriptionID = rec.mDescriptionID;
+      obj.mpName = GetImageString( view.mpStrings, 
+                                   view.mStringsSz, 
+                                   rec.mName, 
+                                   bOK );
+
+      if (bValidated == false && obj.IsValid() == false)
+      {
+         bOK = false;
+         break;
+      }
+
+      mEnumNameMap.insert( mEnumNameMap.end(),
+                           tDB2EnumNameMap::value_type( obj.mID, obj ) );
+   }
+
+   for (r = 0; r < view.mEnumEntryCount && bOK == true; r++)
+   {
+      const sDB2ImageEnumEntry & rec = view.mpEnumEntries[r];
+
+      sDB2EnumEntry obj;
+      obj.mID = rec.mID;
+      obj.mValue = rec.mValue;
+      obj.mbHex = (rec.mbHex != 0);
+      obj.mDescriptionID = rec.mDescriptionID;
+      obj.mpName = GetImageString( view.mpStrings, 
+                                   view.mStringsSz, 
+                                   rec.mName, 
+                                   bOK );
+
+      if (bValidated == false && obj.IsValid() == false)
+      {
+         bOK = false;
+         break;
+      }
+
+      mEnumEntryMap.insert( mEnumEntryMap.end(),
+                            tDB2EnumEntryMap::value_type( obj.GetKey(), obj ) );
+   }
+
+
+   return bOK;
+}
+
+/*===========================================================================
+METHOD:
+   LoadCompiledTables (Internal Method)
+
+DESCRIPTION:
+   Load all tables from the record arrays utils/qmidb compiled (and this
+   library linked in) from the database text, nothing is parsed and the
+   table strings reference the read only string pool shared by every 
+   process using the library
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cCoreDatabase::LoadCompiledTables()
+{
+   // Assume failure
+   bool bRC = false;
+
+#ifdef DB2_COMPILED_TABLES
+   const sDB2ImageView & view = gDB2CompiledTables;
+   if ( (view.mStringsSz == 0)
+   ||   (view.mpStrings[view.mStringsSz - 1] != 0) )
+   {
+      mpLog->Log( "DB compiled tables have a corrupt string pool", 
+                  eDB2_STATUS_ERROR );
+
+      return bRC;
+   }
+
+   // Table strings reference the pool (from here on)
+   mpCompiledStrings = view.mpStrings;
+   mCompiledStringsSz = view.mStringsSz;
+
+   // The generator mirrors the text parser, but leaves structure 
+   // validation to be done on lookup as when parsing the text
+   if (LoadImageView( view, false ) == false)
+   {
+      mpLog->Log( "DB compiled tables have an invalid record, ignored", 
+                  eDB2_STATUS_WARNING );
+
+      return bRC;
+   }
+
+   // The entity name map was assembled by the generator
+   bRC = AssembleEnumMap();
+   bRC &= BuildModifierTables();
+
+   if (mbTrusted == true)
+   {
+      MarkValidated();
+   }
+#endif
 
    return bRC;
 }
 
+/*===========================================================================
+METHOD:
+   MarkValidated (Internal Method)
+
+DESCRIPTION:
+   Mark every protocol entity structure as validated
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+void cCoreDatabase::MarkValidated()
+{
+   tDB2EntityMap::iterator pEntity = mProtocolEntities.begin();
+   while (pEntity != mProtocolEntities.end())
+   {
+      pEntity->second.mbValidated = true;
+      pEntity++;
+   }
+}
+
 /*===========================================================================
 METHOD:
    ValidateStructures (Internal Method)
 
 DESCRIPTION:
-   Validate (and attempt repair of) structure related tables
+   Validate (and attempt repair of) the structure of every protocol 
+   entity not yet validated
   
 RETURN VALUE:
    bool
 ===========================================================================*/
-bool cCoreDatabase::ValidateStructures()
+bool cCoreDatabase::ValidateStructures() const
 {
    // Assume success
    bool bRC = true;
 
-   tDB2EntityMap::iterator pEntity = mProtocolEntities.begin();
+   tDB2EntityMap::const_iterator pEntity = mProtocolEntities.begin();
    while (pEntity != mProtocolEntities.end())
    {
-      sDB2ProtocolEntity & entity = pEntity->second;
+      bRC &= ValidateEntity( pEntity->second );
+      pEntity++;
+   }
+
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   ValidateEntity (Internal Method)
+
+DESCRIPTION:
+   Validate (and attempt repair of) the structure of a protocol entity,
+   this is done once, when the entity is first looked up
+
+   NOTE: An invalid structure is reset to none
+  
+PARAMETERS:
+   entity      [I/O] - Protocol entity (as stored in mProtocolEntities)
+
+RETURN VALUE:
+   bool - False if the structure was found to be invalid by this call
+===========================================================================*/
+bool cCoreDatabase::ValidateEntity( const sDB2ProtocolEntity & entity ) const
+{
+   // Already validated?
+   if (entity.mbValidated == true)
+   {
+      // Pairs with the barrier made before the flag was set
+      __sync_synchronize();
+      return true;
+   }
+
+   // Assume success
+   bool bRC = true;
+
+   pthread_mutex_lock( &mValidateLock );
+
+   if (entity.mbValidated == false)
+   {
+      // The entity belongs to the table, which we may repair
+      sDB2ProtocolEntity & obj = const_cast <sDB2ProtocolEntity &>( entity );
 
       // Structure ID given?
-      if (entity.mStructID != -1)
+      if (obj.mStructID != -1)
       {
          // Yes, validate individual structure
          std::set <ULONG> fields;
-         bool bValid = ValidateStructure( (ULONG)entity.mStructID, fields, 0 );
+         bool bValid = ValidateStructure( (ULONG)obj.mStructID, fields, 0 );
 
          // Not valid?
          if (bValid == false)
@@ -2648,20 +4963,22 @@ bool cCoreDatabase::ValidateStructures()
             // Invalid structure, reset to none
             std::ostringstream tmp;
             tmp << "DB [" << DB2_TABLE_PROTOCOL_STRUCT 
-                << "] Invalid struct, ID " << entity.mStructID;
+                << "] Invalid struct, ID " << obj.mStructID;
             
             mpLog->Log( tmp.str(), eDB2_STATUS_ERROR );
 
-            entity.mStructID = -1;
-
-            // We found at least one bad structure
+            obj.mStructID = -1;
             bRC = false;
          }
       }
 
-      pEntity++;
+      // Make the (repaired) structure ID visible before the flag
+      __sync_synchronize();
+      obj.mbValidated = true;
    }
 
+   pthread_mutex_unlock( &mValidateLock );
+
    return bRC;
 }
 
@@ -2683,7 +5000,7 @@ RETURN VALUE:
 bool cCoreDatabase::ValidateStructure(
    ULONG                      structID,
    std::set <ULONG> &         fields,
-   ULONG                      depth )
+   ULONG                      depth ) const
 {
    // Assume success
    bool bRC = true;
@@ -2859,7 +5176,7 @@ RETURN VALUE:
 bool cCoreDatabase::ValidateField(
    ULONG                      structID,
    ULONG                      fieldID,
-   std::set <ULONG> &         fields )
+   std::set <ULONG> &         fields ) const
 {
    // Assume success
    bool bRC = true;
@@ -2919,7 +5236,7 @@ RETURN VALUE:
 ===========================================================================*/
 bool cCoreDatabase::ValidateArraySpecifier(
    const sDB2Fragment &      frag,
-   const std::set <ULONG> &   fields )
+   const std::set <ULONG> &   fields ) const
 {
    // Assume success
    bool bRC = true;
@@ -3024,7 +5341,7 @@ RETURN VALUE:
 ===========================================================================*/
 bool cCoreDatabase::ValidateOptionalSpecifier(
    const sDB2Fragment &       frag,
-   const std::set <ULONG> &   fields )
+   const std::set <ULONG> &   fields ) const
 {
    // Assume success
    bool bRC = true;
@@ -3112,7 +5429,7 @@ RETURN VALUE:
 ===========================================================================*/
 bool cCoreDatabase::ValidateExpressionSpecifier(
    const sDB2Fragment &       frag,
-   const std::set <ULONG> &   fields )
+   const std::set <ULONG> &   fields ) const
 {
    // Assume success
    bool bRC = true;
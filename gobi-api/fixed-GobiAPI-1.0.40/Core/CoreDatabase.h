@@ -50,6 +50,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include <map>
 #include <set>
 #include <vector>
+#include <pthread.h>
 
 #include "DB2TextFile.h"
 
@@ -57,6 +58,8 @@ POSSIBILITY OF SUCH DAMAGE.
 // Forward Declarations
 //---------------------------------------------------------------------------
 class cDB2NavTree;
+class cMemoryMappedFile;
+struct sDB2ImageView;
 
 //---------------------------------------------------------------------------
 // Prototypes 
@@ -86,6 +89,9 @@ extern LPCSTR DB2_FILE_PROTOCOL_ENTITY;
 extern LPCSTR DB2_FILE_ENUM_MAIN;
 extern LPCSTR DB2_FILE_ENUM_ENTRY;
 
+// Precompiled database image file name
+extern LPCSTR DB2_FILE_IMAGE;
+
 // Database start pointers
 extern const int _binary_QMI_Field_txt_start;
 extern const int _binary_QMI_Struct_txt_start;
@@ -257,22 +263,23 @@ bool LoadDB2Table(
    cDB2TextFile inFile( pFile );
    if (inFile.IsValid() == true)
    {
-      std::string line;
-      while (inFile.ReadLine( line ) == true)
+      // Lines are read in place, parsing (which tokenizes in place) is
+      // done on a copy in a buffer that is reused from line to line
+      std::vector <CHAR> lineBuf;
+      LPCSTR pText = 0;
+      ULONG textLen = 0;
+      while (inFile.ReadLine( pText, textLen ) == true)
       {
-         std::string lineCopy = line;
-         
-         int nLineSize = lineCopy.size();
-         LPSTR pLine = new CHAR[ nLineSize + 1 ];
-         if (pLine == NULL)
+         if (lineBuf.size() < textLen + 1)
          {
-            return false;
+            lineBuf.resize( textLen + 1 );
          }
 
-         memcpy( pLine, line.c_str(), nLineSize );
+         LPSTR pLine = &lineBuf[0];
+         memcpy( pLine, pText, textLen );
 
          // Enforce null terminator
-         pLine[ nLineSize ] = 0;
+         pLine[ textLen ] = 0;
 
          typename Container::mapped_type theType;
          bool bOK = theType.FromString( pLine );
@@ -290,7 +297,7 @@ bool LoadDB2Table(
                // The key already exists which indicates a (recoverable) error
                std::ostringstream tmp;
                tmp << "DB [" << pName << "] Duplicate key, line "
-                   << lineNum << " (" << line.c_str() << ")";
+                   << lineNum << " (" << std::string( pText, textLen ) << ")";
                
                log.Log( tmp.str(), eDB2_STATUS_WARNING );
 
@@ -306,19 +313,18 @@ bool LoadDB2Table(
                cont.insert( entry );
             }
          }
-         else if (lineCopy.size() > 0)
+         else if (textLen > 0)
          {
             // Error parsing line
             std::ostringstream tmp;
             tmp << "DB [" << pName << "] Parsing error, line "
-                << lineNum << " (" << line.c_str() << ")";
+                << lineNum << " (" << std::string( pText, textLen ) << ")";
 
             log.Log( tmp.str(), eDB2_STATUS_ERROR );
 
             theType.FreeAllocatedStrings();
             bRC = false;
          }
-         delete [] pLine;
          lineNum++;
       }
    }
@@ -380,22 +386,23 @@ bool LoadDB2Table(
    cDB2TextFile inFile( pStart, nSize );
    if (inFile.IsValid() == true)
    {
-      std::string line;
-      while (inFile.ReadLine( line ) == true)
+      // Lines are read in place, parsing (which tokenizes in place) is
+      // done on a copy in a buffer that is reused from line to line
+      std::vector <CHAR> lineBuf;
+      LPCSTR pText = 0;
+      ULONG textLen = 0;
+      while (inFile.ReadLine( pText, textLen ) == true)
       {
-         std::string lineCopy = line;
-         
-         int nLineSize = lineCopy.size();
-         LPSTR pLine = new CHAR[ nLineSize + 1 ];
-         if (pLine == NULL)
+         if (lineBuf.size() < textLen + 1)
          {
-            return false;
+            lineBuf.resize( textLen + 1 );
          }
 
-         memcpy( pLine, lineCopy.c_str(), nLineSize );
+         LPSTR pLine = &lineBuf[0];
+         memcpy( pLine, pText, textLen );
 
          // Enforce null terminator
-         pLine[ nLineSize ] = 0;
+         pLine[ textLen ] = 0;
 
          typename Container::mapped_type theType;
          bool bOK = theType.FromString( pLine );
@@ -413,7 +420,7 @@ bool LoadDB2Table(
                // The key already exists which indicates a (recoverable) error
                std::ostringstream tmp;
                tmp << "DB [" << pName << "] Duplicate key, line "
-                   << lineNum << " (" << line.c_str() << ")";
+                   << lineNum << " (" << std::string( pText, textLen ) << ")";
                
                log.Log( tmp.str(), eDB2_STATUS_WARNING );
 
@@ -429,12 +436,12 @@ bool LoadDB2Table(
                cont.insert( entry );
             }
          }
-         else if (lineCopy.size() > 0)
+         else if (textLen > 0)
          {
             // Error parsing line
             std::ostringstream tmp;
             tmp << "DB [" << pName << "] Parsing error, line "
-                << lineNum << " (" << line.c_str() << ")";
+                << lineNum << " (" << std::string( pText, textLen ) << ")";
 
             log.Log( tmp.str(), eDB2_STATUS_ERROR );
 
@@ -442,7 +449,6 @@ bool LoadDB2Table(
             bRC = false;
          }
 
-         delete [] pLine;
          lineNum++;
       }
    }
@@ -1133,7 +1139,8 @@ struct sDB2ProtocolEntity
             mFormatID( -1 ),
             mbInternal( false ),
             mFormatExID( -1 ),
-            mpName( EMPTY_STRING )
+            mpName( EMPTY_STRING ),
+            mbValidated( false )
       { };
 
       // (Inline) Free up our allocated strings
@@ -1178,6 +1185,10 @@ struct sDB2ProtocolEntity
 
       /* Name of protocol entity */
       LPCSTR mpName;
+
+      /* Has the associated structure been validated (see 
+         cCoreDatabase::FindEntity())? */
+      volatile bool mbValidated;
 };
 
 /*=========================================================================*/
@@ -1790,6 +1801,35 @@ struct sDB2SimpleExpression
       bool mbF2F;
 };
 
+/*=========================================================================*/
+// Struct sDB2FragmentModifier
+//
+//    Structure that defines the parsed modifier of a single fragment
+/*=========================================================================*/
+struct sDB2FragmentModifier
+{
+   public:
+      // (Inline) Default constructor
+      sDB2FragmentModifier()
+         :  mCondition(),
+            mExpression(),
+            mValue( 0 ),
+            mStopID( 0 )
+      { };
+
+      /* Condition (eDB2_MOD_OPTIONAL) */
+      sDB2SimpleCondition mCondition;
+
+      /* Expression (eDB2_MOD_VARIABLE_ARRAY3) */
+      sDB2SimpleExpression mExpression;
+
+      /* Element count, or ID of field holding count/length/start index */
+      ULONG mValue;
+
+      /* ID of field holding stop index (eDB2_MOD_VARIABLE_ARRAY2) */
+      ULONG mStopID;
+};
+
 /*=========================================================================*/
 // Struct sLPCSTRCmp
 //
@@ -1896,9 +1936,252 @@ typedef std::map <LPCSTR, ULONG> tDB2Array1ModMap;
 // Parsed fragment modifier map - start/stop index specified arrays
 typedef std::map <LPCSTR, std::pair <ULONG, ULONG> > tDB2Array2ModMap;
 
+// Parsed fragment modifier map - all modifiers, by fragment
+typedef std::map <const sDB2Fragment *, sDB2FragmentModifier> 
+tDB2FragmentModMap;
+
 // A protocol entity navigation map expressed as a type
 typedef std::map <std::vector <ULONG>, cDB2NavTree *> tDB2EntityNavMap;
 
+/*=========================================================================*/
+// Struct sDB2EntityFields
+//
+//    The fields of a protocol entity, in the order they are found in the
+//    entity (see cProtocolEntityFieldEnumerator), built once per entity
+//    and never modified afterwards
+/*=========================================================================*/
+struct sDB2EntityFields
+{
+   public:
+      // (Inline) Find a field by fully qualified name, returns the index 
+      // of the field (ULONG_MAX if there is no such field)
+      ULONG FindName( const std::string & name ) const
+      {
+         ULONG idx = ULONG_MAX;
+
+         std::map <std::string, ULONG>::const_iterator pIter;
+         pIter = mNameIndex.find( name );
+         if (pIter != mNameIndex.end())
+         {
+            idx = pIter->second;
+         }
+
+         return idx;
+      };
+
+      /* Field IDs */
+      std::vector <ULONG> mFieldIDs;
+
+      /* Fully qualified field names (in the same order as the above) */
+      std::vector <std::string> mNames;
+
+      /* Index of the first field with a given fully qualified name */
+      std::map <std::string, ULONG> mNameIndex;
+};
+
+// A protocol entity field map expressed as a type
+typedef std::map <std::vector <ULONG>, sDB2EntityFields *> tDB2EntityFieldsMap;
+
+/*=========================================================================*/
+// Class cDB2HashIndex
+//
+//    Flat open addressing (linear probe) index over database table 
+//    records keyed by a 64-bit value, built once after the tables are 
+//    loaded (records are referenced, so the tables must not change 
+//    while the index is in use)
+/*=========================================================================*/
+template <class Record>
+class cDB2HashIndex
+{
+   public:
+      // (Inline) Constructor
+      cDB2HashIndex()
+         :  mMask( 0 )
+      { };
+
+      // (Inline) Empty the index
+      void Clear()
+      {
+         mSlots.clear();
+         mMask = 0;
+      };
+
+      // (Inline) Size the index for the given number of records
+      void Reserve( ULONG count )
+      {
+         // Keep the load factor at or below 50%
+         ULONG slots = 16;
+         while (slots < count * 2)
+         {
+            slots <<= 1;
+         }
+
+         Clear();
+         mSlots.resize( slots );
+         mMask = slots - 1;
+      };
+
+      // (Inline) Add a record, the first record added for a key wins
+      bool Insert( 
+         ULONGLONG                  key,
+         const Record *             pRecord )
+      {
+         if (mSlots.size() == 0 || pRecord == 0)
+         {
+            return false;
+         }
+
+         ULONG idx = Hash( key ) & mMask;
+         while (mSlots[idx].mbUsed == true)
+         {
+            if (mSlots[idx].mKey == key)
+            {
+               return false;
+            }
+
+            idx = (idx + 1) & mMask;
+         }
+
+         mSlots[idx].mbUsed = true;
+         mSlots[idx].mKey = key;
+         mSlots[idx].mpRecord = pRecord;
+         return true;
+      };
+
+      // (Inline) Mark a key as ambiguous (multiple records share it)
+      void SetAmbiguous( ULONGLONG key )
+      {
+         sSlot * pSlot = FindSlot( key );
+         if (pSlot != 0)
+         {
+            pSlot->mpRecord = 0;
+         }
+      };
+
+      // (Inline) Look up the record for a key?  Returns false when the
+      // index cannot answer, i.e. it is empty or the key is ambiguous, 
+      // otherwise pRecord is the record (0 if the key is not present)
+      bool Find( 
+         ULONGLONG                  key,
+         const Record *&            pRecord ) const
+      {
+         pRecord = 0;
+         if (mSlots.size() == 0)
+         {
+            return false;
+         }
+
+         const sSlot * pSlot = FindSlot( key );
+         if (pSlot == 0)
+         {
+            return true;
+         }
+
+         pRecord = pSlot->mpRecord;
+         return (pRecord != 0);
+      };
+
+      // (Inline) Return the heap used by the index (in bytes)
+      ULONG GetFootprint() const
+      {
+         return (ULONG)(mSlots.capacity() * sizeof( sSlot ));
+      };
+
+   protected:
+      /* Index slot */
+      struct sSlot
+      {
+         sSlot()
+            :  mKey( 0 ),
+               mpRecord( 0 ),
+               mbUsed( false )
+         { };
+
+         ULONGLONG mKey;
+         const Record * mpRecord;
+         bool mbUsed;
+      };
+
+      // (Inline) Mix a key into a slot index 
+      static ULONG Hash( ULONGLONG key )
+      {
+         key ^= key >> 33;
+         key *= 0xFF51AFD7ED558CCDULL;
+         key ^= key >> 33;
+         key *= 0xC4CEB9FE1A85EC53ULL;
+         key ^= key >> 33;
+         return (ULONG)key;
+      };
+
+      // (Inline) Find the slot holding a key
+      sSlot * FindSlot( ULONGLONG key ) const
+      {
+         ULONG idx = Hash( key ) & mMask;
+         while (mSlots[idx].mbUsed == true)
+         {
+            if (mSlots[idx].mKey == key)
+            {
+               return const_cast <sSlot *>( &mSlots[idx] );
+            }
+
+            idx = (idx + 1) & mMask;
+         }
+
+         return 0;
+      };
+
+      /* Index slots (a power of two in size) */
+      std::vector <sSlot> mSlots;
+
+      /* Slot index mask */
+      ULONG mMask;
+};
+
+// Entity/field/name indices
+typedef cDB2HashIndex <sDB2ProtocolEntity> tDB2EntityIndex;
+typedef cDB2HashIndex <sDB2Field> tDB2FieldIndex;
+typedef cDB2HashIndex <tDB2EntityNameMap::value_type> tDB2EntityNameIndex;
+typedef cDB2HashIndex <sDB2EnumEntry> tDB2EnumEntryIndex;
+
+// Size of a buffer that holds any enum value string formatted by the 
+// non-allocating version of cCoreDatabase::MapEnumToString()
+const ULONG DB2_ENUM_STRING_BUFFER_SIZE = 64;
+
+/*=========================================================================*/
+// Struct sDB2TableFootprint
+//
+//    Memory footprint of a single database table (or other database 
+//    owned storage) as reported by cCoreDatabase::GetFootprint(), heap
+//    sizes are estimates that include per allocation overhead
+/*=========================================================================*/
+struct sDB2TableFootprint
+{
+   public:
+      // (Inline) Default constructor
+      sDB2TableFootprint()
+         :  mpName( EMPTY_STRING ),
+            mRecords( 0 ),
+            mContainerBytes( 0 ),
+            mStringBytes( 0 ),
+            mMappedBytes( 0 )
+      { };
+
+      /* Table name */
+      LPCSTR mpName;
+
+      /* Number of records */
+      ULONG mRecords;
+
+      /* Heap used by the container (nodes, keys, record payloads) */
+      ULONG mContainerBytes;
+
+      /* Heap used by strings owned by the table records */
+      ULONG mStringBytes;
+
+      /* Read-only mapped (shareable, not heap) bytes */
+      ULONG mMappedBytes;
+};
+
 
 
 /*=========================================================================*/
@@ -1918,6 +2201,16 @@ class cCoreDatabase
       virtual bool Initialize( LPCSTR pBasePath );
       virtual bool Initialize();
 
+      // Initialize the database from a precompiled (memory mapped) image
+      virtual bool InitializeFromImage( LPCSTR pImageFile );
+
+      // Write the currently loaded database out as a precompiled image
+      bool SaveImage( LPCSTR pImageFile ) const;
+
+      // Report the memory footprint of the database, per table, returns
+      // the total heap use (in bytes)
+      ULONG GetFootprint( std::vector <sDB2TableFootprint> & tables ) const;
+
       // Exit (cleanup) the database
       virtual void Exit();
 
@@ -1926,6 +2219,11 @@ class cCoreDatabase
       const cDB2NavTree * GetEntityNavTree( 
          const std::vector <ULONG> &   key ) const;
 
+      // Get the fields of the given protocol entity, if they have not 
+      // been enumerated yet they will be enumerated and returned
+      const sDB2EntityFields * GetEntityFieldList( 
+         const std::vector <ULONG> &   key ) const;
+
       // Find the protocol entity with the specified key
       bool FindEntity( 
          const std::vector <ULONG> &   key,
@@ -1941,6 +2239,9 @@ class cCoreDatabase
          LPCSTR                    pName,
          std::vector <ULONG> &      key ) const;
 
+      // Find the protocol field with the specified ID
+      const sDB2Field * FindField( ULONG fieldID ) const;
+
       // Map the given enum value (specified by enum ID, and enum value) 
       // to the enum value name string
       std::string MapEnumToString( 
@@ -1957,6 +2258,23 @@ class cCoreDatabase
          bool                       bSimpleErrFmt = false,
          bool                       bHex = false ) const;
 
+      // Map the given enum value (specified by enum ID, and enum value) 
+      // to the enum value name string without allocating, i.e. return
+      // the database string or format the error string into pBuf
+      LPCSTR MapEnumToString( 
+         ULONG                      enumID,
+         int                        enumVal,
+         bool                       bSimpleErrFmt,
+         bool                       bHex,
+         CHAR *                     pBuf,
+         ULONG                      bufLen ) const;
+
+      // Find the enum value name string for the given enum value 
+      // (specified by enum ID, and enum value), 0 if there is none
+      LPCSTR FindEnumString( 
+         ULONG                      enumID,
+         int                        enumVal ) const;
+
       // (Inline) Set status log (object must exist for the duration of 
       // the DB or at least until being reset)
       void SetLog( cDB2StatusLog * pLog )
@@ -1967,7 +2285,15 @@ class cCoreDatabase
          }
       };
 
-      // (Inline) Return protocol entities
+      // (Inline) Trust the internal (linked in) tables, which are checked
+      // when they are built in, and skip validating their structures
+      void SetTrusted( bool bTrusted )
+      {
+         mbTrusted = bTrusted;
+      };
+
+      // (Inline) Return protocol entities (structures of entities not yet
+      // looked up may not have been validated, see ValidateStructures())
       const tDB2EntityMap & GetProtocolEntities() const
       {
          return mProtocolEntities;
@@ -2035,6 +2361,12 @@ class cCoreDatabase
          return mArray2ModMap;
       };
 
+      // (Inline) Return parsed fragment modifier map - by fragment
+      const tDB2FragmentModMap & GetFragmentMods() const
+      {
+         return mFragmentModMap;
+      };
+
    protected:
       // Assemble the internal enum map
       bool AssembleEnumMap();
@@ -2045,59 +2377,128 @@ class cCoreDatabase
       // Build the modifier tables
       bool BuildModifierTables();
 
+      // Build the entity, entity name, and field hash indices
+      void BuildIndices();
+
+      // Move all table strings into a single (deduplicated) string arena
+      void CompactStrings();
+
+      // Find the protocol entity key for the given (trimmed) name
+      const std::vector <ULONG> * FindEntityKey( LPCSTR pName ) const;
+
       // Check and set the passed in path to something that is useful
       std::string CheckAndSetBasePath( LPCSTR pBasePath ) const;
 
-      // Load all tables related to structure (entity, struct, field)
-      bool LoadStructureTables( LPCSTR pBasePath );
-      bool LoadStructureTables();
+      // Load all tables (structure and enumeration related)
+      bool LoadTables( LPCSTR pBasePath );
+      bool LoadTables();
+
+      // Load all tables from a precompiled database image
+      bool LoadImage( 
+         LPCSTR                     pImageFile,
+         bool                       bCheckEmbedded );
+
+      // Load all tables from the record arrays of a precompiled database
+      bool LoadImageView( 
+         const sDB2ImageView &      view,
+         bool                       bValidated );
+
+      // Load all tables from the compiled in record arrays
+      bool LoadCompiledTables();
+
+      // Mark every protocol entity structure as validated
+      void MarkValidated();
 
-      // Load all enumeration related tables
-      bool LoadEnumTables( LPCSTR pBasePath );
-      bool LoadEnumTables();
+      // Validate (and attempt repair of) the structure of every protocol
+      // entity not yet validated
+      bool ValidateStructures() const;
 
-      // Validate (and attempt repair of) structure related tables
-      bool ValidateStructures();
+      // Validate (and attempt repair of) the structure of a protocol 
+      // entity, once
+      bool ValidateEntity( const sDB2ProtocolEntity & entity ) const;
 
       // Validate a single structure
       bool ValidateStructure(
          ULONG                      structID,
          std::set <ULONG> &         fields,
-         ULONG                      depth );
+         ULONG                      depth ) const;
 
       // Validate a single field
       bool ValidateField(
          ULONG                      structID,
          ULONG                      fieldID,
-         std::set <ULONG> &         fields );
+         std::set <ULONG> &         fields ) const;
 
       // Validate an array specifier
       bool ValidateArraySpecifier(
          const sDB2Fragment &       frag,
-         const std::set <ULONG> &   fields );
+         const std::set <ULONG> &   fields ) const;
 
       // Validate a simple optional fragment specifier
       bool ValidateOptionalSpecifier(
          const sDB2Fragment &       frag,
-         const std::set <ULONG> &   fields );
+         const std::set <ULONG> &   fields ) const;
 
       // Validate a simple expression fragment specifier
       bool ValidateExpressionSpecifier(
          const sDB2Fragment &       frag,
-         const std::set <ULONG> &   fields );
+         const std::set <ULONG> &   fields ) const;
 
       /* Status log */
       cDB2StatusLog * mpLog;
 
+      /* Skip validating the internal tables? */
+      bool mbTrusted;
+
+      /* Lock serializing protocol entity validation (done on lookup) */
+      mutable pthread_mutex_t mValidateLock;
+
+      /* Precompiled database image (table strings reference its pool) */
+      cMemoryMappedFile * mpImage;
+
+      /* Compiled in string pool (table strings reference it when the 
+         compiled tables are in use) */
+      const CHAR * mpCompiledStrings;
+
+      /* Size of the compiled in string pool (in bytes) */
+      ULONG mCompiledStringsSz;
+
+      /* String arena (table strings reference it when not using an image) */
+      CHAR * mpStringArena;
+
+      /* Size of the string arena (in bytes) */
+      ULONG mStringArenaSz;
+
       /* Protocol entity table, referenced by multi-value key */
       tDB2EntityMap mProtocolEntities;
 
       /* Protocol entity keys, referenced by indexed by entity name */
       tDB2EntityNameMap mEntityNames;
 
+      /* Hash index over mProtocolEntities, by packed entity key */
+      tDB2EntityIndex mEntityIndex;
+
+      /* Hash index over mEntityNames, by case insensitive name hash */
+      tDB2EntityNameIndex mEntityNameIndex;
+
+      /* Hash index over mEntityFields, by field ID */
+      tDB2FieldIndex mFieldIndex;
+
+      /* Hash index over mEnumEntryMap, by packed enum ID/value pair */
+      tDB2EnumEntryIndex mEnumEntryIndex;
+
       /* The on-demand Protocol entity navigation map */
       mutable tDB2EntityNavMap mEntityNavMap;
 
+      /* Lock protecting mEntityNavMap (built on demand by any thread) */
+      mutable pthread_rwlock_t mEntityNavLock;
+
+      /* The on-demand protocol entity field map */
+      mutable tDB2EntityFieldsMap mEntityFieldsMap;
+
+      /* Lock protecting mEntityFieldsMap (built on demand by any thread) */
+      mutable pthread_rwlock_t mEntityFieldsLock;
+
       /* Protocol entity struct table, indexed by struct ID & fragment order */
       tDB2FragmentMap mEntityStructs;
 
@@ -2124,4 +2525,7 @@ class cCoreDatabase
 
       /* Parsed fragment modifier map - start/stop index specified arrays */
       tDB2Array2ModMap mArray2ModMap;
+
+      /* Parsed fragment modifier map - all modifiers, by fragment */
+      tDB2FragmentModMap mFragmentModMap;
 };
@@ -661,14 +661,15 @@ void ParseTokens(
 {
    if (pSeparator != 0 && pSeparator[0] != 0 && pLine != 0 && pLine[0] != 0)
    {
-      LPSTR pToken = strtok( pLine, pSeparator );
+      LPSTR pSave = 0;
+      LPSTR pToken = strtok_r( pLine, pSeparator, &pSave );
       while (pToken != 0)
       {
          // Store token
          tokens.push_back( pToken );
 
          // Get next token:
-         pToken = strtok( 0, pSeparator );
+         pToken = strtok_r( 0, pSeparator, &pSave );
       }
    }
 }
@@ -0,0 +1,152 @@
+/*===========================================================================
+FILE:
+   DB2Image.h
+
+DESCRIPTION:
+   Record layout of a precompiled database image, shared by the image
+   files cCoreDatabase saves/maps and the tables utils/qmidb compiles in
+
+PUBLIC CLASSES AND METHODS:
+   sDB2ImageView
+      The record arrays and string pool of a precompiled database
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Pragmas
+//---------------------------------------------------------------------------
+#pragma once
+
+/*=========================================================================*/
+// Precompiled database records
+//
+//    Each table is a flat array of fixed size records sorted by table key.
+//    Strings are offsets into a single string pool (offset 0 always refers
+//    to an empty string) and entity keys are index/count ranges into a
+//    shared array of entity IDs, so nothing needs fixing up when loaded.
+//    NOTE: changing any of these requires bumping DB2_IMAGE_VERSION and
+//    regenerating the utils/qmidb compiled tables
+/*=========================================================================*/
+struct sDB2ImageEntity
+{
+   UINT mType;
+   UINT mIDIndex;
+   UINT mIDCount;
+   INT mStructID;
+   INT mFormatID;
+   INT mFormatExID;
+   UINT mbInternal;
+   UINT mName;
+};
+
+struct sDB2ImageEntityName
+{
+   UINT mName;
+   UINT mIDIndex;
+   UINT mIDCount;
+};
+
+struct sDB2ImageFragment
+{
+   UINT mStructID;
+   UINT mFragmentOrder;
+   INT mFragmentOffset;
+   UINT mFragmentType;
+   UINT mFragmentValue;
+   UINT mModifierType;
+   UINT mModifierValue;
+   UINT mName;
+};
+
+struct sDB2ImageField
+{
+   UINT mID;
+   UINT mSize;
+   UINT mType;
+   UINT mTypeVal;
+   UINT mbHex;
+   UINT mbInternal;
+   INT mDescriptionID;
+   UINT mName;
+};
+
+struct sDB2ImageEnum
+{
+   UINT mID;
+   UINT mbInternal;
+   INT mDescriptionID;
+   UINT mName;
+};
+
+struct sDB2ImageEnumEntry
+{
+   UINT mID;
+   INT mValue;
+   UINT mbHex;
+   INT mDescriptionID;
+   UINT mName;
+};
+
+/*=========================================================================*/
+// Struct sDB2ImageView
+//
+//    Where the record arrays of a precompiled database are, either within
+//    a mapped image file or linked in (see gDB2CompiledTables)
+/*=========================================================================*/
+struct sDB2ImageView
+{
+   const sDB2ImageEntity * mpEntities;
+   UINT mEntityCount;
+
+   const sDB2ImageEntityName * mpEntityNames;
+   UINT mEntityNameCount;
+
+   const UINT * mpEntityIDs;
+   UINT mEntityIDCount;
+
+   const sDB2ImageFragment * mpFragments;
+   UINT mFragmentCount;
+
+   const sDB2ImageField * mpFields;
+   UINT mFieldCount;
+
+   const sDB2ImageEnum * mpEnums;
+   UINT mEnumCount;
+
+   const sDB2ImageEnumEntry * mpEnumEntries;
+   UINT mEnumEntryCount;
+
+   /* String pool, mStringsSz includes the final terminator */
+   const CHAR * mpStrings;
+   UINT mStringsSz;
+};
+
+// Tables compiled from Database/QMI/*.txt by 'utils/qmidb/qmidb.py --cpp'
+// (only linked in when configured with --enable-compiled-db)
+extern const sDB2ImageView gDB2CompiledTables;
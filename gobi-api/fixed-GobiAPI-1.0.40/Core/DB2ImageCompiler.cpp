@@ -0,0 +1,89 @@
+/*===========================================================================
+FILE:
+   DB2ImageCompiler.cpp
+
+DESCRIPTION:
+   Build time compiler for the precompiled (binary) QMI database image
+
+PUBLIC CLASSES AND METHODS:
+   main
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "StdAfx.h"
+#include "CoreDatabase.h"
+
+//---------------------------------------------------------------------------
+// Free Methods
+//---------------------------------------------------------------------------
+
+/*===========================================================================
+METHOD:
+   main
+
+DESCRIPTION:
+   Load and validate the text database tables found in the given
+   directory and write them out as a precompiled database image
+
+   Usage: DB2ImageCompiler <database directory> <image file>
+
+RETURN VALUE:
+   int - 0 upon success
+===========================================================================*/
+int main( int argc, char ** argv )
+{
+   if (argc != 3)
+   {
+      fprintf( stderr, "Usage: %s <database directory> <image file>\n", 
+               argv[0] );
+      return 1;
+   }
+
+   cCoreDatabase db;
+   bool bRC = db.Initialize( argv[1] );
+   if (bRC == false)
+   {
+      fprintf( stderr, "%s: database in \'%s\' failed to load\n", 
+               argv[0],
+               argv[1] );
+      return 1;
+   }
+
+   bRC = db.SaveImage( argv[2] );
+   if (bRC == false)
+   {
+      fprintf( stderr, "%s: unable to write \'%s\'\n", argv[0], argv[2] );
+      return 1;
+   }
+
+   return 0;
+}
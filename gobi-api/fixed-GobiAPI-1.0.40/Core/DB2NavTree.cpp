@@ -7,9 +7,11 @@ DESCRIPTION:
    
 PUBLIC CLASSES AND METHODS:
    sDB2NavFragment
+   sDB2NavInstruction
    cDB2NavTree
       This class distills the database description of a protocol
-      entity into a simple tree structure more suited to
+      entity into a simple tree structure (and a linear navigation
+      program compiled from it) more suited to
       efficient navigation for parsing/packing
 
 Copyright (c) 2011, Code Aurora Forum. All rights reserved.
@@ -65,10 +67,36 @@ RETURN VALUE:
    None
 ===========================================================================*/
 sDB2NavFragment::sDB2NavFragment()
-   :  mpField( 0 ),
+   :  mNextFragment( DB2_NAV_NO_INDEX ),
+      mLinkFragment( DB2_NAV_NO_INDEX ),
       mpFragment( 0 ),
-      mpNextFragment( 0 ),
-      mpLinkFragment( 0 )
+      mpField( 0 )
+{
+   // Nothing to do
+}
+
+/*=========================================================================*/
+// sDB2NavInstruction Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   sDB2NavInstruction (Public Method)
+
+DESCRIPTION:
+   Constructor
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+sDB2NavInstruction::sDB2NavInstruction()
+   :  mOp( eDB2_NAV_OP_INVALID ),
+      mNext( 0 ),
+      mOwner( DB2_NAV_NO_INDEX ),
+      mbLSB( true ),
+      mpFragment( 0 ),
+      mpField( 0 ),
+      mpModifier( 0 )
 {
    // Nothing to do
 }
@@ -108,16 +136,7 @@ RETURN VALUE:
 ===========================================================================*/
 cDB2NavTree::~cDB2NavTree()
 {
-   // Clean-up our fragment allocations
-   std::list <sDB2NavFragment *>::iterator pIter;
-   for (pIter = mFragments.begin(); pIter != mFragments.end(); pIter++)
-   {
-      sDB2NavFragment * pFrag = *pIter;
-      if (pFrag != 0)
-      {
-         delete pFrag;
-      }
-   }
+   // Nothing to do
 }
 
 /*===========================================================================
@@ -176,7 +195,13 @@ bool cDB2NavTree::BuildTree( const std::vector <ULONG> & key )
    }
 
    // Process the initial structure
-   bRC = ProcessStruct( &pFrag->second, 0 );
+   bRC = ProcessStruct( &pFrag->second, DB2_NAV_NO_INDEX );
+   if (bRC == true && mFragments.size() > 0)
+   {
+      // Lower the tree to a navigation program
+      CompileStruct( 0, DB2_NAV_NO_INDEX );
+   }
+
    return bRC;
 }
 
@@ -189,14 +214,15 @@ DESCRIPTION:
 
 PARAMETERS:
    frag        [ I ] - Entry point for structure
-   pOwner      [ I ] - Owning fragment
+   owner       [ I ] - Index of the owning fragment (DB2_NAV_NO_INDEX
+                       for the protocol entity)
   
 RETURN VALUE:
    bool
 ===========================================================================*/
 bool cDB2NavTree::ProcessStruct( 
    const sDB2Fragment *       pFrag,
-   sDB2NavFragment *          pOwner )
+   UINT                       owner )
 {
    // Assume success
    bool bRC = true;
@@ -206,7 +232,6 @@ bool cDB2NavTree::ProcessStruct(
    ULONG structID = key.first;
 
    const tDB2FragmentMap & structTable = mDB.GetProtocolStructs();
-   const tDB2FieldMap & fieldTable = mDB.GetProtocolFields();
 
    // Sync iterator to fragment
    tDB2FragmentMap::const_iterator pFragIter = structTable.find( key );
@@ -219,9 +244,10 @@ bool cDB2NavTree::ProcessStruct(
       return bRC;
    }
 
-   // Fragments we allocate along the way
-   sDB2NavFragment * pOld = 0;
-   sDB2NavFragment * pNew = 0;
+   // Fragments we add along the way (as indices, since nested structures
+   // grow the fragment array)
+   UINT oldIdx = DB2_NAV_NO_INDEX;
+   UINT newIdx = DB2_NAV_NO_INDEX;
 
    // Process each fragment in the structure
    while ( (pFragIter != structTable.end())
@@ -229,28 +255,31 @@ bool cDB2NavTree::ProcessStruct(
    {      
       pFrag = &pFragIter->second;
 
-      // Allocate our new fragment
-      pNew = new sDB2NavFragment;
-      if (pNew == 0)
+      // Add our new fragment
+      newIdx = (UINT)mFragments.size();
+      if (newIdx == DB2_NAV_NO_INDEX)
       {
          bRC = false;
          break;
       }
-      
+
       // Store DB fragemnt
-      pNew->mpFragment = pFrag;
-      mFragments.push_back( pNew );
+      sDB2NavFragment navFrag;
+      navFrag.mpFragment = pFrag;
+      mFragments.push_back( navFrag );
 
       // Hook previous up to us
-      if (pOld != 0 && pOld->mpNextFragment == 0)
+      if ( (oldIdx != DB2_NAV_NO_INDEX)
+      &&   (mFragments[oldIdx].mNextFragment == DB2_NAV_NO_INDEX) )
       {
-         pOld->mpNextFragment = pNew;
+         mFragments[oldIdx].mNextFragment = newIdx;
       }
 
       // Hook owner up to us
-      if (pOwner != 0 && pOwner->mpLinkFragment == 0)
+      if ( (owner != DB2_NAV_NO_INDEX)
+      &&   (mFragments[owner].mLinkFragment == DB2_NAV_NO_INDEX) )
       {
-         pOwner->mpLinkFragment = pNew;
+         mFragments[owner].mLinkFragment = newIdx;
       }   
 
       // Modified?
@@ -368,10 +397,10 @@ bool cDB2NavTree::ProcessStruct(
             ULONG fieldID = pFrag->mFragmentValue;
 
             // Find field representation in database
-            tDB2FieldMap::const_iterator pField = fieldTable.find( fieldID );
-            if (pField != fieldTable.end())
+            const sDB2Field * pField = mDB.FindField( fieldID );
+            if (pField != 0)
             {
-               pNew->mpField = &pField->second;
+               mFragments[newIdx].mpField = pField;
             }
             else
             {
@@ -392,7 +421,7 @@ bool cDB2NavTree::ProcessStruct(
             if (pFragIterTmp != structTable.end())
             {        
                pFrag = &pFragIterTmp->second;    
-               bRC = ProcessStruct( pFrag, pNew );
+               bRC = ProcessStruct( pFrag, newIdx );
             }
             else
             {
@@ -421,8 +450,8 @@ bool cDB2NavTree::ProcessStruct(
       {
          pFragIter++;
 
-         pOld = pNew;
-         pNew = 0;
+         oldIdx = newIdx;
+         newIdx = DB2_NAV_NO_INDEX;
       }
       else
       {
@@ -432,3 +461,100 @@ bool cDB2NavTree::ProcessStruct(
 
    return bRC;
 }
+
+/*===========================================================================
+METHOD:
+   CompileStruct (Internal Method)
+
+DESCRIPTION:
+   Compile the structure starting with the given fragment into the 
+   navigation program, nested structures are compiled inline following
+   the instruction for the enclosing struct fragment
+
+PARAMETERS:
+   frag        [ I ] - Index of the first fragment in structure
+   owner       [ I ] - Index of the struct instruction that owns this
+                       structure (DB2_NAV_NO_INDEX for the protocol entity)
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+void cDB2NavTree::CompileStruct( 
+   UINT                       frag,
+   UINT                       owner )
+{
+   // Navigation order directives are only honoured as the first
+   // fragment of a structure
+   if (frag != DB2_NAV_NO_INDEX && mFragments[frag].mpFragment != 0)
+   {
+      const sDB2NavFragment * pFrag = &mFragments[frag];
+      eDB2FragmentType fragType = pFrag->mpFragment->mFragmentType;
+      if ( (fragType == eDB2_FRAGMENT_MSB_2_LSB)
+      ||   (fragType == eDB2_FRAGMENT_LSB_2_MSB) )
+      {
+         sDB2NavInstruction ins;
+         ins.mOp = eDB2_NAV_OP_SET_LSB;
+         ins.mpFragment = pFrag->mpFragment;
+         ins.mbLSB = (fragType == eDB2_FRAGMENT_LSB_2_MSB);
+         mProgram.push_back( ins );
+
+         frag = pFrag->mNextFragment;
+      }
+   }
+
+   const tDB2FragmentModMap & mods = mDB.GetFragmentMods();
+   while (frag != DB2_NAV_NO_INDEX)
+   {
+      const sDB2NavFragment * pFrag = &mFragments[frag];
+
+      sDB2NavInstruction ins;
+      ins.mpFragment = pFrag->mpFragment;
+      ins.mpField = pFrag->mpField;
+
+      tDB2FragmentModMap::const_iterator pMod = mods.find( ins.mpFragment );
+      if (pMod != mods.end())
+      {
+         ins.mpModifier = &pMod->second;
+      }
+
+      switch (pFrag->mpFragment->mFragmentType)
+      {
+         case eDB2_FRAGMENT_FIELD:
+            ins.mOp = eDB2_NAV_OP_FIELD;
+            break;
+
+         case eDB2_FRAGMENT_STRUCT:
+            if (pFrag->mLinkFragment != DB2_NAV_NO_INDEX)
+            {
+               ins.mOp = eDB2_NAV_OP_STRUCT;
+            }
+            break;
+
+         case eDB2_FRAGMENT_CONSTANT_PAD:
+         case eDB2_FRAGMENT_VARIABLE_PAD_BITS:
+         case eDB2_FRAGMENT_VARIABLE_PAD_BYTES:
+         case eDB2_FRAGMENT_FULL_BYTE_PAD:
+            ins.mOp = eDB2_NAV_OP_PAD;
+            break;
+
+         default:
+            break;
+      }
+
+      UINT idx = (UINT)mProgram.size();
+      mProgram.push_back( ins );
+
+      if (ins.mOp == eDB2_NAV_OP_STRUCT)
+      {
+         CompileStruct( pFrag->mLinkFragment, idx );
+      }
+
+      mProgram[idx].mNext = (UINT)mProgram.size();
+      frag = pFrag->mNextFragment;
+   }
+
+   sDB2NavInstruction end;
+   end.mOp = eDB2_NAV_OP_END_STRUCT;
+   end.mOwner = owner;
+   mProgram.push_back( end );
+}
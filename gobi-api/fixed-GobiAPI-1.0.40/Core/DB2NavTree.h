@@ -7,9 +7,11 @@ DESCRIPTION:
    
 PUBLIC CLASSES AND METHODS:
    sDB2NavFragment
+   sDB2NavInstruction
    cDB2NavTree
       This class distills the database description of a protocol
-      entity into a simple tree structure more suited to
+      entity into a simple tree structure (and a linear navigation
+      program compiled from it) more suited to
       efficient navigation for parsing/packing
 
 Copyright (c) 2011, Code Aurora Forum. All rights reserved.
@@ -52,14 +54,19 @@ POSSIBILITY OF SUCH DAMAGE.
 
 #include <list>
 #include <map>
+#include <vector>
 
 //---------------------------------------------------------------------------
 // Definitions
 //---------------------------------------------------------------------------
 
+// No fragment/instruction (navigation links are 32-bit indices)
+const UINT DB2_NAV_NO_INDEX = UINT_MAX;
+
 /*=========================================================================*/
 // Struct sDB2NavFragment
-//    Protocol entity navigation fragment
+//    Protocol entity navigation fragment, fragments are stored in one
+//    array (see cDB2NavTree) and linked by their index in it
 /*=========================================================================*/
 struct sDB2NavFragment
 {
@@ -67,17 +74,75 @@ struct sDB2NavFragment
       // Constructor
       sDB2NavFragment();
 
+      /* Next fragment in this structure */
+      UINT mNextFragment;
+
+      /* Fragment linked to this structure */
+      UINT mLinkFragment;
+
       /* Associated DB fragment (never empty) */
       const sDB2Fragment * mpFragment;
 
       /* Associated DB field (may be empty) */
       const sDB2Field * mpField;
+};
 
-      /* Next fragment in this structure */
-      const sDB2NavFragment * mpNextFragment;
+/*=========================================================================*/
+// eDB2NavOp Enumeration
+//
+//    Navigation program instruction (operation) enumeration
+/*=========================================================================*/
+enum eDB2NavOp
+{
+   eDB2_NAV_OP_ENUM_BEGIN = -1,
 
-      /* Fragment linked to this structure */
-      const sDB2NavFragment * mpLinkFragment;
+   eDB2_NAV_OP_SET_LSB,          // Set navigation order of enclosing struct
+   eDB2_NAV_OP_FIELD,            // Field fragment
+   eDB2_NAV_OP_STRUCT,           // Struct fragment, the body follows
+   eDB2_NAV_OP_PAD,              // Constant/variable/full byte pad fragment
+   eDB2_NAV_OP_END_STRUCT,       // End of struct body (loops for arrays)
+   eDB2_NAV_OP_INVALID,          // Fragment that cannot be navigated
+
+   eDB2_NAV_OP_ENUM_END
+};
+
+/*=========================================================================*/
+// Struct sDB2NavInstruction
+//
+//    Navigation program instruction, a struct fragment is followed by 
+//    the instructions for its body, ending in eDB2_NAV_OP_END_STRUCT
+//
+//    The control flow (operation, links) comes first and packs into
+//    16 bytes, the DB records (names etc.) are only reached through the
+//    pointers that follow
+/*=========================================================================*/
+struct sDB2NavInstruction
+{
+   public:
+      // Constructor
+      sDB2NavInstruction();
+
+      /* Operation */
+      eDB2NavOp mOp;
+
+      /* Instruction following the struct body (eDB2_NAV_OP_STRUCT) */
+      UINT mNext;
+
+      /* Instruction that began this struct body (eDB2_NAV_OP_END_STRUCT,
+         DB2_NAV_NO_INDEX for the body of the protocol entity itself) */
+      UINT mOwner;
+
+      /* Navigation order (eDB2_NAV_OP_SET_LSB) */
+      bool mbLSB;
+
+      /* Associated DB fragment (0 for eDB2_NAV_OP_END_STRUCT) */
+      const sDB2Fragment * mpFragment;
+
+      /* Associated DB field (eDB2_NAV_OP_FIELD) */
+      const sDB2Field * mpField;
+
+      /* Parsed fragment modifier (0 if none or unparseable) */
+      const sDB2FragmentModifier * mpModifier;
 };
 
 /*=========================================================================*/
@@ -103,13 +168,20 @@ class cDB2NavTree
       };
 
       // (Inline) Return fragments
-      const std::list <sDB2NavFragment *> & GetFragments() const
+      const std::vector <sDB2NavFragment> & GetFragments() const
       {
          return mFragments;
       };
 
-      // Return a map of all tracked fields
-      std::map <ULONG, std::pair <bool, LONGLONG> > GetTrackedFields() const
+      // (Inline) Return the navigation program
+      const std::vector <sDB2NavInstruction> & GetProgram() const
+      {
+         return mProgram;
+      };
+
+      // (Inline) Return a map of all tracked fields
+      const std::map <ULONG, std::pair <bool, LONGLONG> > & 
+      GetTrackedFields() const
       {
          return mTrackedFields;
       };
@@ -118,7 +190,13 @@ class cDB2NavTree
       // Process a structure described by the given initial fragment
       bool ProcessStruct( 
          const sDB2Fragment *       pFrag,
-         sDB2NavFragment *          pOwner );
+         UINT                       owner );
+
+      // Compile the structure starting with the given fragment into
+      // the navigation program
+      void CompileStruct( 
+         UINT                       frag,
+         UINT                       owner );
       
       /* Protocol entity being navigated */
       sDB2ProtocolEntity mEntity;
@@ -126,8 +204,11 @@ class cDB2NavTree
       /* Database reference */
       const cCoreDatabase & mDB;
 
-      /* List of all allocated fragments */
-      std::list <sDB2NavFragment *> mFragments;
+      /* All fragments, in the order they were processed */
+      std::vector <sDB2NavFragment> mFragments;
+
+      /* Navigation program compiled from the fragments */
+      std::vector <sDB2NavInstruction> mProgram;
 
       /* Map of all 'tracked' fields */
       std::map <ULONG, std::pair <bool, LONGLONG> > mTrackedFields;      
@@ -7,8 +7,9 @@ DESCRIPTION:
 
 PUBLIC CLASSES AND METHODS:
    cDB2TextFile
-      The cDB2TextFile class provides the simple ability to read in an
-      ANSI/UNICODE file and copy it to a dynamically allocated buffer
+      The cDB2TextFile class provides the simple ability to read lines
+      from an ANSI/UNICODE file, which is memory mapped (or a buffer, 
+      which is referenced in place) rather than copied
 
       The sole difference between this and CStdioFile is that the issues
       stemming from supporting both ANSI and UNICODE files are handled
@@ -67,7 +68,7 @@ METHOD:
    cDB2TextFile (Public Method)
 
 DESCRIPTION:
-   Construct object/load file into memory
+   Construct object/map file into memory
 
 PARAMETERS
    pFileName         [ I ] - File name
@@ -76,64 +77,47 @@ RETURN VALUE:
    None
 ===========================================================================*/
 cDB2TextFile::cDB2TextFile( LPCSTR pFileName )
-   :  mText( "" ),
-      mStatus( ERROR_FILE_NOT_FOUND ),
-      mCurrentPos( 0 )
+   :  mpFile( 0 ),
+      mpText( 0 ),
+      mTextLen( 0 ),
+      mCurrentPos( 0 ),
+      mStatus( ERROR_FILE_NOT_FOUND )
 {
    if (pFileName == 0 || pFileName[0] == 0)
    {
       return;
    }
 
-   // Open the file
-   std::ifstream tempFStream;
-   tempFStream.open( pFileName, std::ios::in | std::ios::binary );
-   if (tempFStream.fail() == true)
+   // An empty file is valid (it just has no lines)
+   struct stat fileInfo;
+   if (stat( pFileName, &fileInfo ) != 0)
    {
       mStatus = ERROR_FILE_NOT_FOUND;
       return;
    }
 
-   // Get size
-   LONG nFileSize = tempFStream.rdbuf()->in_avail();
-   if (nFileSize == -1 || nFileSize > MAX_FILE_SZ)
+   if (fileInfo.st_size == 0)
    {
-      tempFStream.close();
-      mStatus = ERROR_GEN_FAILURE;
+      mStatus = NO_ERROR;
       return;
    }
 
-   // Read file into pTempBuffer
-   CHAR * pTempBuffer = new char[ nFileSize ];
-   if (pTempBuffer == NULL)
+   if ((ULONGLONG)fileInfo.st_size > MAX_FILE_SZ)
    {
-      tempFStream.close();
       mStatus = ERROR_GEN_FAILURE;
       return;
    }
 
-   tempFStream.read( pTempBuffer, nFileSize );
-   if (tempFStream.fail() == true)
+   // Map the file
+   mpFile = new cMemoryMappedFile( pFileName );
+   if (mpFile == 0 || mpFile->GetStatus() != NO_ERROR)
    {
-      tempFStream.close();
-      delete [] pTempBuffer;
       mStatus = ERROR_GEN_FAILURE;
       return;
    }
 
-   tempFStream.close();
-   
-   // Convert to string
-   mText = std::string( pTempBuffer, nFileSize );
-
-   delete [] pTempBuffer;
-
-   // Final check
-   if (mText.size() != nFileSize)
-   {
-      mStatus = ERROR_GEN_FAILURE;      
-      return;
-   }
+   mpText = (LPCSTR)mpFile->GetContents();
+   mTextLen = mpFile->GetSize();
 
    // Success!
    mStatus = NO_ERROR;
@@ -144,10 +128,11 @@ METHOD:
    cDB2TextFile (Public Method)
 
 DESCRIPTION:
-   Construct object/copy from buffer into memory
+   Construct object from buffer, the buffer is referenced in place and so
+   has to outlive this object
 
 PARAMETERS
-   pBuffer     [ I ] - Buffer to copy from
+   pBuffer     [ I ] - Buffer to read from
    bufferLen   [ I ] - Size of above buffer
 
 RETURN VALUE:
@@ -156,16 +141,15 @@ RETURN VALUE:
 cDB2TextFile::cDB2TextFile(
    LPCSTR                     pBuffer, 
    ULONG                      bufferLen )
-   :  mText( "" ),
-      mStatus( ERROR_FILE_NOT_FOUND ),
-      mCurrentPos( 0 )
+   :  mpFile( 0 ),
+      mpText( pBuffer ),
+      mTextLen( bufferLen ),
+      mCurrentPos( 0 ),
+      mStatus( ERROR_FILE_NOT_FOUND )
 {
-   // Convert to string
-   mText = std::string( pBuffer, bufferLen );
-
-   // Final check
-   if (mText.size() != bufferLen)
+   if (pBuffer == 0 && bufferLen != 0)
    {
+      mTextLen = 0;
       mStatus = ERROR_GEN_FAILURE;      
       return;
    }
@@ -186,7 +170,11 @@ RETURN VALUE:
 ===========================================================================*/
 cDB2TextFile::~cDB2TextFile()
 {
-   // Nothing to do
+   if (mpFile != 0)
+   {
+      delete mpFile;
+      mpFile = 0;
+   }
 }
 
 /*===========================================================================
@@ -200,54 +188,66 @@ PARAMETERS
    line        [ O ] - Line (minus CR/LF)
 
 RETURN VALUE:
-   None
+   bool
 ===========================================================================*/
 bool cDB2TextFile::ReadLine( std::string & line )
 {
-   if (IsValid() == false)
+   LPCSTR pLine = 0;
+   ULONG lineLen = 0;
+   if (ReadLine( pLine, lineLen ) == false)
    {
       return false;
    }
 
-   int len = mText.size();
-   if (mCurrentPos >= len)
-   {
-      return false;
-   }
+   line.assign( pLine, lineLen );
+   return true;
+}
 
-   int newIdx = mText.find( '\n', mCurrentPos );
-   if (newIdx == -1)
+/*===========================================================================
+METHOD:
+   ReadLine (Public Method)
+
+DESCRIPTION:
+   Read the next available line in place (without copying it)
+
+PARAMETERS
+   pLine       [ O ] - Start of the line, within the file contents
+   lineLen     [ O ] - Length of the line (minus CR/LF)
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cDB2TextFile::ReadLine( 
+   LPCSTR &                   pLine,
+   ULONG &                    lineLen )
+{
+   if (IsValid() == false)
    {
-      // Possibly the end of the file
-      newIdx = len;
+      return false;
    }
 
-   if (newIdx < mCurrentPos)
+   if (mCurrentPos >= mTextLen)
    {
       return false;
    }
 
-   if (newIdx == mCurrentPos)
+   pLine = mpText + mCurrentPos;
+
+   ULONG newIdx = mTextLen;
+   const void * pLF = memchr( pLine, '\n', mTextLen - mCurrentPos );
+   if (pLF != 0)
    {
-      // Return an empty line
-      mCurrentPos++;    
-      line = "";
+      newIdx = (ULONG)((LPCSTR)pLF - mpText);
    }
-   else
-   {
-      // Grab line
-      line = mText.substr( mCurrentPos, (newIdx - mCurrentPos) );
 
-      // Check for CR
-      int nCR = line.find( '\r' );
-      if (nCR != -1)
-      {
-         line.erase( nCR, 1 );
-      }
+   lineLen = newIdx - mCurrentPos;
 
-      mCurrentPos = newIdx + 1;
+   // Drop a trailing CR
+   if (lineLen > 0 && pLine[lineLen - 1] == '\r')
+   {
+      lineLen--;
    }
 
+   mCurrentPos = newIdx + 1;
    return true;
 }
-
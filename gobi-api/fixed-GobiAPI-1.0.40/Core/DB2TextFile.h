@@ -7,8 +7,9 @@ DESCRIPTION:
 
 PUBLIC CLASSES AND METHODS:
    cDB2TextFile
-      The cDB2TextFile class provides the simple ability to read in an
-      ANSI/UNICODE file and copy it to a dynamically allocated buffer
+      The cDB2TextFile class provides the simple ability to read lines
+      from an ANSI/UNICODE file, which is memory mapped (or a buffer, 
+      which is referenced in place) rather than copied
 
       The sole difference between this and CStdioFile is that the issues
       stemming from supporting both ANSI and UNICODE files are handled
@@ -42,6 +43,7 @@ ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 POSSIBILITY OF SUCH DAMAGE.
 ===========================================================================*/
 #include "StdAfx.h"
+#include "MemoryMappedFile.h"
 
 //---------------------------------------------------------------------------
 // Pragmas
@@ -83,7 +85,7 @@ class cDB2TextFile
          bool bOK = IsValid();
          if (bOK == true)
          {
-            copy = mText;
+            copy.assign( mpText, mTextLen );
          }
          
          return bOK;
@@ -98,12 +100,24 @@ class cDB2TextFile
       // Read the next available line
       bool ReadLine( std::string & line );
 
+      // Read the next available line in place, the line (minus CR/LF) is
+      // not terminated and stays valid for the life of this object
+      bool ReadLine( 
+         LPCSTR &                   pLine,
+         ULONG &                    lineLen );
+
    protected:
+      /* Mapped file (when loaded from a file) */
+      cMemoryMappedFile * mpFile;
+
       /* File contents */
-      std::string mText;
+      LPCSTR mpText;
+
+      /* Size of above contents */
+      ULONG mTextLen;
 
       /* Current position (in above contents) */
-      int mCurrentPos;
+      ULONG mCurrentPos;
 
       /* Error status */
       DWORD mStatus;
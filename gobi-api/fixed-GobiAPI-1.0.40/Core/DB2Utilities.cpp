@@ -11,10 +11,6 @@ PUBLIC ENUMERATIONS AND METHODS:
    sDB2PackingInput
    sDB2NavInput
 
-   MapQMIEntityTypeToProtocolType
-   MapQMIEntityTypeToQMIServiceType
-   MapQMIProtocolTypeToEntityType
-   DB2GetMaxBufferSize
    DB2BuildQMIBuffer
    DB2PackQMIBuffer
    DB2ReduceQMIBuffer
@@ -56,7 +52,6 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "QMIBuffers.h"
 
 #include "DataPacker.h"
-#include "ProtocolEntityFieldEnumerator.h"
 
 //---------------------------------------------------------------------------
 // Definitions
@@ -66,462 +61,6 @@ POSSIBILITY OF SUCH DAMAGE.
 // Free Methods
 //---------------------------------------------------------------------------
 
-/*===========================================================================
-METHOD:
-   MapQMIEntityTypeToQMIServiceType (Public Free Method)
-
-DESCRIPTION:
-   Map a DB protocol entity type (for QMI) to a QMI service type
-
-PARAMETERS:
-   et          [ I ] - Protocol entity type
-  
-RETURN VALUE:
-   eQMIService
-===========================================================================*/
-eQMIService MapQMIEntityTypeToQMIServiceType( eDB2EntityType et )
-{
-   eQMIService st = eQMI_SVC_ENUM_BEGIN;
-   switch (et)
-   {
-      case eDB2_ET_QMI_CTL_REQ:
-      case eDB2_ET_QMI_CTL_RSP:
-      case eDB2_ET_QMI_CTL_IND:
-         st = eQMI_SVC_CONTROL;
-         break;
-
-      case eDB2_ET_QMI_WDS_REQ:
-      case eDB2_ET_QMI_WDS_RSP:
-      case eDB2_ET_QMI_WDS_IND:
-         st = eQMI_SVC_WDS;
-         break;
-
-      case eDB2_ET_QMI_DMS_REQ:
-      case eDB2_ET_QMI_DMS_RSP:
-      case eDB2_ET_QMI_DMS_IND:
-         st = eQMI_SVC_DMS;
-         break;
-
-      case eDB2_ET_QMI_NAS_REQ:
-      case eDB2_ET_QMI_NAS_RSP:
-      case eDB2_ET_QMI_NAS_IND:
-         st = eQMI_SVC_NAS;
-         break;
-
-      case eDB2_ET_QMI_QOS_REQ:
-      case eDB2_ET_QMI_QOS_RSP:
-      case eDB2_ET_QMI_QOS_IND:
-         st = eQMI_SVC_QOS;
-         break;
-
-      case eDB2_ET_QMI_WMS_REQ:
-      case eDB2_ET_QMI_WMS_RSP:
-      case eDB2_ET_QMI_WMS_IND:
-         st = eQMI_SVC_WMS;
-         break;
-
-      case eDB2_ET_QMI_PDS_REQ:
-      case eDB2_ET_QMI_PDS_RSP:
-      case eDB2_ET_QMI_PDS_IND:
-         st = eQMI_SVC_PDS;
-         break;
-      
-      case eDB2_ET_QMI_AUTH_REQ:
-      case eDB2_ET_QMI_AUTH_RSP:
-      case eDB2_ET_QMI_AUTH_IND:
-         st = eQMI_SVC_AUTH;
-         break;
-
-      case eDB2_ET_QMI_VOICE_REQ:
-      case eDB2_ET_QMI_VOICE_RSP:
-      case eDB2_ET_QMI_VOICE_IND:
-         st = eQMI_SVC_VOICE;
-         break;
-
-      case eDB2_ET_QMI_CAT_REQ:
-      case eDB2_ET_QMI_CAT_RSP:
-      case eDB2_ET_QMI_CAT_IND:
-         st = eQMI_SVC_CAT;
-         break;
-
-      case eDB2_ET_QMI_RMS_REQ:
-      case eDB2_ET_QMI_RMS_RSP:
-      case eDB2_ET_QMI_RMS_IND:
-         st = eQMI_SVC_RMS;
-         break;
-
-      case eDB2_ET_QMI_OMA_REQ:
-      case eDB2_ET_QMI_OMA_RSP:
-      case eDB2_ET_QMI_OMA_IND:
-         st = eQMI_SVC_OMA;
-         break;
-   }
-
-   return st;
-}
-
-/*===========================================================================
-METHOD:
-   MapQMIEntityTypeToProtocolType (Public Free Method)
-
-DESCRIPTION:
-   Map a DB protocol entity type (for QMI) to a buffer protocol type
-
-PARAMETERS:
-   et          [ I ] - Protocol entity type
-  
-RETURN VALUE:
-   eProtocolType
-===========================================================================*/
-eProtocolType MapQMIEntityTypeToProtocolType( eDB2EntityType et )
-{
-   eProtocolType pt = ePROTOCOL_ENUM_BEGIN;
-   switch (et)
-   {
-      case eDB2_ET_QMI_WDS_REQ:
-         pt = ePROTOCOL_QMI_WDS_TX;
-         break;
-
-      case eDB2_ET_QMI_WDS_RSP:
-      case eDB2_ET_QMI_WDS_IND:
-         pt = ePROTOCOL_QMI_WDS_RX;
-         break;
-
-      case eDB2_ET_QMI_DMS_REQ:
-         pt = ePROTOCOL_QMI_DMS_TX;
-         break;
-
-      case eDB2_ET_QMI_DMS_RSP:
-      case eDB2_ET_QMI_DMS_IND:
-         pt = ePROTOCOL_QMI_DMS_RX;
-         break;
-
-      case eDB2_ET_QMI_NAS_REQ:
-         pt = ePROTOCOL_QMI_NAS_TX;
-         break;
-
-      case eDB2_ET_QMI_NAS_RSP:
-      case eDB2_ET_QMI_NAS_IND:
-         pt = ePROTOCOL_QMI_NAS_RX;
-         break;
-
-      case eDB2_ET_QMI_QOS_REQ:
-         pt = ePROTOCOL_QMI_QOS_TX;
-         break;
-
-      case eDB2_ET_QMI_QOS_RSP:
-      case eDB2_ET_QMI_QOS_IND:
-         pt = ePROTOCOL_QMI_QOS_RX;
-         break;
-
-      case eDB2_ET_QMI_WMS_REQ:
-         pt = ePROTOCOL_QMI_WMS_TX;
-         break;
-
-      case eDB2_ET_QMI_WMS_RSP:
-      case eDB2_ET_QMI_WMS_IND:
-         pt = ePROTOCOL_QMI_WMS_RX;
-         break;
-
-      case eDB2_ET_QMI_PDS_REQ:
-         pt = ePROTOCOL_QMI_PDS_TX;
-         break;
-
-      case eDB2_ET_QMI_PDS_RSP:
-      case eDB2_ET_QMI_PDS_IND:
-         pt = ePROTOCOL_QMI_PDS_RX;
-         break;
-
-      case eDB2_ET_QMI_AUTH_REQ:
-         pt = ePROTOCOL_QMI_AUTH_TX;
-         break;
-
-      case eDB2_ET_QMI_AUTH_RSP:
-      case eDB2_ET_QMI_AUTH_IND:
-         pt = ePROTOCOL_QMI_AUTH_RX;
-         break;
-
-      case eDB2_ET_QMI_VOICE_REQ:
-         pt = ePROTOCOL_QMI_VOICE_TX;
-         break;
-
-      case eDB2_ET_QMI_VOICE_RSP:
-      case eDB2_ET_QMI_VOICE_IND:
-         pt = ePROTOCOL_QMI_VOICE_RX;
-         break;
-
-      case eDB2_ET_QMI_CAT_REQ:
-         pt = ePROTOCOL_QMI_CAT_TX;
-         break;
-
-      case eDB2_ET_QMI_CAT_RSP:
-      case eDB2_ET_QMI_CAT_IND:
-         pt = ePROTOCOL_QMI_CAT_RX;
-         break;
-
-      case eDB2_ET_QMI_RMS_REQ:
-         pt = ePROTOCOL_QMI_RMS_TX;
-         break;
-
-      case eDB2_ET_QMI_RMS_RSP:
-      case eDB2_ET_QMI_RMS_IND:
-         pt = ePROTOCOL_QMI_RMS_RX;
-         break;
-
-      case eDB2_ET_QMI_OMA_REQ:
-         pt = ePROTOCOL_QMI_OMA_TX;
-         break;
-
-      case eDB2_ET_QMI_OMA_RSP:
-      case eDB2_ET_QMI_OMA_IND:
-         pt = ePROTOCOL_QMI_OMA_RX;
-         break;
-
-      case eDB2_ET_QMI_CTL_REQ:
-         pt = ePROTOCOL_QMI_CTL_TX;
-         break;
-
-      case eDB2_ET_QMI_CTL_RSP:
-      case eDB2_ET_QMI_CTL_IND:
-         pt = ePROTOCOL_QMI_CTL_RX;
-         break;
-   }
-
-   return pt;
-}
-
-/*===========================================================================
-METHOD:
-   MapQMIProtocolTypeToEntityType (Public Free Method)
-
-DESCRIPTION:
-   Map a buffer protocol type to a DB protocol entity type
-
-PARAMETERS:
-   pt          [ I ] - Protocol type
-   bIndication [ I ] - Is this for an indication?
-  
-RETURN VALUE:
-   eDB2EntityType
-===========================================================================*/
-eDB2EntityType MapQMIProtocolTypeToEntityType( 
-   eProtocolType              pt,
-   bool                       bIndication )
-{
-   eDB2EntityType et = eDB2_ET_ENUM_BEGIN;
-   switch (pt)
-   {
-      case ePROTOCOL_QMI_WDS_RX:
-         if (bIndication == true)
-         {
-            et = eDB2_ET_QMI_WDS_IND;
-         }
-         else
-         {
-            et = eDB2_ET_QMI_WDS_RSP;
-         }
-         break;
-
-      case ePROTOCOL_QMI_WDS_TX:
-         et = eDB2_ET_QMI_WDS_REQ;
-         break;
-
-      case ePROTOCOL_QMI_DMS_RX:
-         if (bIndication == true)
-         {
-            et = eDB2_ET_QMI_DMS_IND;
-         }
-         else
-         {
-            et = eDB2_ET_QMI_DMS_RSP;
-         }
-         break;
-
-      case ePROTOCOL_QMI_DMS_TX:
-         et = eDB2_ET_QMI_DMS_REQ;
-         break;
-
-      case ePROTOCOL_QMI_NAS_RX:
-         if (bIndication == true)
-         {
-            et = eDB2_ET_QMI_NAS_IND;
-         }
-         else
-         {
-            et = eDB2_ET_QMI_NAS_RSP;
-         }
-         break;
-
-      case ePROTOCOL_QMI_NAS_TX:
-         et = eDB2_ET_QMI_NAS_REQ;
-         break;
-
-      case ePROTOCOL_QMI_QOS_RX:
-         if (bIndication == true)
-         {
-            et = eDB2_ET_QMI_QOS_IND;
-         }
-         else
-         {
-            et = eDB2_ET_QMI_QOS_RSP;
-         }
-         break;
-
-      case ePROTOCOL_QMI_QOS_TX:
-         et = eDB2_ET_QMI_QOS_REQ;
-         break;
-
-      case ePROTOCOL_QMI_WMS_RX:
-         if (bIndication == true)
-         {
-            et = eDB2_ET_QMI_WMS_IND;
-         }
-         else
-         {
-            et = eDB2_ET_QMI_WMS_RSP;
-         }
-         break;
-
-      case ePROTOCOL_QMI_WMS_TX:
-         et = eDB2_ET_QMI_WMS_REQ;
-         break;
-
-      case ePROTOCOL_QMI_PDS_RX:
-         if (bIndication == true)
-         {
-            et = eDB2_ET_QMI_PDS_IND;
-         }
-         else
-         {
-            et = eDB2_ET_QMI_PDS_RSP;
-         }
-         break;
-
-      case ePROTOCOL_QMI_PDS_TX:
-         et = eDB2_ET_QMI_PDS_REQ;
-         break;
-
-               case ePROTOCOL_QMI_AUTH_RX:
-         if (bIndication == true)
-         {
-            et = eDB2_ET_QMI_AUTH_IND;
-         }
-         else
-         {
-            et = eDB2_ET_QMI_AUTH_RSP;
-         }
-         break;
-
-      case ePROTOCOL_QMI_AUTH_TX:
-         et = eDB2_ET_QMI_AUTH_REQ;
-         break;
-
-      case ePROTOCOL_QMI_VOICE_RX:
-         if (bIndication == true)
-         {
-            et = eDB2_ET_QMI_VOICE_IND;
-         }
-         else
-         {
-            et = eDB2_ET_QMI_VOICE_RSP;
-         }
-         break;
-
-      case ePROTOCOL_QMI_VOICE_TX:
-         et = eDB2_ET_QMI_VOICE_REQ;
-         break;
-
-      case ePROTOCOL_QMI_CAT_RX:
-         if (bIndication == true)
-         {
-            et = eDB2_ET_QMI_CAT_IND;
-         }
-         else
-         {
-            et = eDB2_ET_QMI_CAT_RSP;
-         }
-         break;
-
-      case ePROTOCOL_QMI_CAT_TX:
-         et = eDB2_ET_QMI_CAT_REQ;
-         break;
-
-      case ePROTOCOL_QMI_RMS_RX:
-         if (bIndication == true)
-         {
-            et = eDB2_ET_QMI_RMS_IND;
-         }
-         else
-         {
-            et = eDB2_ET_QMI_RMS_RSP;
-         }
-         break;
-
-      case ePROTOCOL_QMI_RMS_TX:
-         et = eDB2_ET_QMI_RMS_REQ;
-         break;
-
-      case ePROTOCOL_QMI_OMA_RX:
-         if (bIndication == true)
-         {
-            et = eDB2_ET_QMI_OMA_IND;
-         }
-         else
-         {
-            et = eDB2_ET_QMI_OMA_RSP;
-         }
-         break;
-
-      case ePROTOCOL_QMI_OMA_TX:
-         et = eDB2_ET_QMI_OMA_REQ;
-         break;
-
-      case ePROTOCOL_QMI_CTL_RX:
-         if (bIndication == true)
-         {
-            et = eDB2_ET_QMI_CTL_IND;
-         }
-         else
-         {
-            et = eDB2_ET_QMI_CTL_RSP;
-         }
-         break;
-
-      case ePROTOCOL_QMI_CTL_TX:
-         et = eDB2_ET_QMI_CTL_REQ;
-         break;
-   }
-
-   return et;
-}
-
-/*===========================================================================
-METHOD:
-   DB2GetMaxBufferSize (Public Free Method)
-
-DESCRIPTION:
-   Return the maximum size of a payload buffer for given type of 
-   protocol entity
-
-PARAMETERS:
-   et          [ I ] - Protocol entity type
-  
-RETURN VALUE:
-   ULONG - Maximum 
-===========================================================================*/
-ULONG DB2GetMaxBufferSize( eDB2EntityType et )
-{
-   ULONG maxSzInBytes = MAX_SHARED_BUFFER_SIZE;
-
-   if (IsQMIEntityType( et ) == true)
-   {
-      // QMI items are further constrained in size
-      maxSzInBytes = QMI_MAX_BUFFER_SIZE;
-   }
-
-   return maxSzInBytes;
-}
-
 /*===========================================================================
 METHOD:
    DB2BuildQMIBuffer (Internal Method)
@@ -685,21 +224,64 @@ sSharedBuffer * DB2PackQMIBuffer(
       }
    }
 
-   BYTE buf[QMI_MAX_BUFFER_SIZE];
-   ULONG bufLen = 0;
+   // Fields are packed straight into a (zeroed) buffer from the pool
+   eQMIService st = MapQMIEntityTypeToQMIServiceType( et );
+   bool bRsp = IsQMIEntityResponseType( et );
+   bool bInd = IsQMIEntityIndicationType( et );
+   bool bTX = (bRsp == false && bInd == false);
 
-   sQMIRawContentHeader * pTLV = 0;
-   pTLV = (sQMIRawContentHeader *)&buf[0];
+   eProtocolType pt = MapQMIServiceToProtocol( st, bTX );
+   sSharedBuffer * pBuf = new sSharedBuffer( QMI_MAX_BUFFER_SIZE, pt );
+   if (pBuf == 0 || pBuf->IsValid() == false)
+   {
+      delete pBuf;
+      return pRef;
+   }
+
+   const ULONG hdrSz = sQMIServiceBuffer::GetHeaderSize();
+   const ULONG maxLen = QMI_MAX_BUFFER_SIZE - hdrSz;
+
+   PBYTE pBuffer = pBuf->GetWritableBuffer();
+   memset( (LPVOID)pBuffer, 0, (SIZE_T)QMI_MAX_BUFFER_SIZE );
+
+   BYTE * buf = pBuffer + hdrSz;
+   ULONG bufLen = 0;
 
    bool bOK = true;
    for (t = 0; t < tlvs; t++)
    {
-      ULONG packedLen = 0;
-      const BYTE * pPackedData = 0;
-
       const sDB2PackingInput & tlv2Input = input[t];
 
-      if (tlv2Input.mbString == true)
+      const ULONG tlvHdrSz = (ULONG)sizeof(sQMIRawContentHeader);
+      if (bufLen + tlvHdrSz > maxLen)
+      {
+         bOK = false;
+         break;
+      }
+
+      sQMIRawContentHeader * pTLV = (sQMIRawContentHeader *)&buf[bufLen];
+      BYTE * pPayload = (BYTE *)(pTLV + 1);
+      ULONG payloadMax = maxLen - bufLen - tlvHdrSz;
+
+      ULONG packedLen = 0;
+      if (tlv2Input.mpTypedFields != 0)
+      {
+         // Pack the typed values in place
+         cDataPacker dp( db, 
+                         tlv2Input.mKey, 
+                         *tlv2Input.mpTypedFields,
+                         pPayload,
+                         payloadMax );
+
+         bOK = dp.Pack();
+         if (bOK == false)
+         {
+            break;
+         }
+
+         dp.GetBuffer( packedLen );
+      }
+      else if (tlv2Input.mbString == true)
       {
          if (tlv2Input.mValues.empty() == false)
          {
@@ -707,16 +289,15 @@ sSharedBuffer * DB2PackQMIBuffer(
             std::list <sUnpackedField> fields 
                = cDataPacker::LoadValues( tlv2Input.mValues );
 
-            // Now pack
-            cDataPacker dp( db, tlv2Input.mKey, fields );
+            // Now pack (in place)
+            cDataPacker dp( db, tlv2Input.mKey, fields, pPayload, payloadMax );
             bOK = dp.Pack();
             if (bOK == false)
             {
                break;
             }
 
-            pPackedData = dp.GetBuffer( packedLen );
-            if (pPackedData == 0)
+            if (dp.GetBuffer( packedLen ) == 0)
             {
                bOK = false;
                break;
@@ -726,24 +307,32 @@ sSharedBuffer * DB2PackQMIBuffer(
       else
       {
          packedLen = tlv2Input.mDataLen;
-         pPackedData = tlv2Input.mpData;
+         if (packedLen > payloadMax)
+         {
+            bOK = false;
+            break;
+         }
+
+         if (packedLen > 0)
+         {
+            memcpy( (LPVOID)pPayload, 
+                    (LPCVOID)tlv2Input.mpData, 
+                    (SIZE_T)packedLen );
+         }
       }
 
       // Check if we need to adjust buffer
-      cProtocolEntityFieldEnumerator pefe( db, tlv2Input.mKey );
-      bool bEnum = pefe.Enumerate();
-      if (bEnum == true)
+      const sDB2EntityFields * pFields = db.GetEntityFieldList( tlv2Input.mKey );
+      if (pFields != 0)
       {
-         const std::vector <ULONG> & fieldIDs = pefe.GetFields();
+         const std::vector <ULONG> & fieldIDs = pFields->mFieldIDs;
          ULONG fieldCount = (ULONG)fieldIDs.size();
          if (fieldCount == 1)
          {
-            const tDB2FieldMap & dbFields = db.GetProtocolFields();
-
-            tDB2FieldMap::const_iterator pField = dbFields.find( fieldIDs[0] );
-            if (pField != dbFields.end())
+            const sDB2Field * pField = db.FindField( fieldIDs[0] );
+            if (pField != 0)
             {
-               const sDB2Field & theField = pField->second;
+               const sDB2Field & theField = *pField;
                if ( (theField.mType == eDB2_FIELD_STD)
                &&   (theField.mTypeVal == (ULONG)eDB2_FIELD_STDTYPE_STRING_ANT) )
                {
@@ -751,7 +340,7 @@ sSharedBuffer * DB2PackQMIBuffer(
                   // string terminator when the TLV consists solely
                   // of a string since the length contained in the 
                   // TLV structure itself renders the trailing NULL 
-                  // redundant
+                  // redundant (the stripped byte is already zero)
                   if (packedLen > 2)
                   {
                      packedLen--;
@@ -770,52 +359,25 @@ sSharedBuffer * DB2PackQMIBuffer(
          }
       }
 
-      if (bufLen + (ULONG)sizeof(sQMIRawContentHeader) < bufLen)
-      {
-         bOK = false;
-         break;
-      }
-      bufLen += (ULONG)sizeof(sQMIRawContentHeader);
-      if (bufLen + packedLen < bufLen)
-      {
-         bOK = false;
-         break;
-      }
-      bufLen += packedLen;
-
-      // What we are building cannot be too large
-      if (bufLen > QMI_MAX_BUFFER_SIZE)
-      {
-         bOK = false;
-         break;
-      }
-
       pTLV->mTypeID = (BYTE)tlv2Input.mKey[2];
       pTLV->mLength = (WORD)packedLen;
-      pTLV++;
 
-      const BYTE * pPayload = (const BYTE *)pTLV;
-      memcpy( (LPVOID)pPayload, 
-              (LPCVOID)pPackedData, 
-              (SIZE_T)packedLen );
-
-      pPayload += packedLen;
-      pTLV = (sQMIRawContentHeader *)pPayload;
+      bufLen += tlvHdrSz + packedLen;
    }
 
-   if (bOK == false)
+   if (bOK == false || pBuf->Truncate( hdrSz + bufLen ) == false)
    {
+      delete pBuf;
       return pRef;
    }
 
-   eQMIService st = MapQMIEntityTypeToQMIServiceType( et );
-   pRef = sQMIServiceBuffer::BuildBuffer( st,
-                                          (WORD)tlvInput.mKey[1],
-                                          IsQMIEntityResponseType( et ),
-                                          IsQMIEntityIndicationType( et ),
-                                          &buf[0],
-                                          bufLen );
+   sQMIServiceBuffer::FormatHeader( pBuffer, 
+                                    (WORD)tlvInput.mKey[1],
+                                    bRsp,
+                                    bInd,
+                                    bufLen );
 
+   pRef = pBuf;
    return pRef;
 }
 
@@ -830,11 +392,11 @@ PARAMETERS:
    buf         [ I ] - Protocol buffer being reduced
   
 RETURN VALUE:
-   sDB2NavInput (invalid upon failure)
+   cDB2NavInputs (empty upon failure)
 ===========================================================================*/ 
-std::vector <sDB2NavInput> DB2ReduceQMIBuffer( const sProtocolBuffer & buf )
+cDB2NavInputs DB2ReduceQMIBuffer( const sProtocolBuffer & buf )
 {
-   std::vector <sDB2NavInput> retInput;
+   cDB2NavInputs retInput;
 
    // We must have a valid protocol buffer
    if (buf.IsValid() == false)
@@ -849,13 +411,13 @@ std::vector <sDB2NavInput> DB2ReduceQMIBuffer( const sProtocolBuffer & buf )
    }
 
    sQMIServiceBuffer qmiBuf( buf.GetSharedBuffer() );
-   std::map <ULONG, const sQMIRawContentHeader *> tlvs = qmiBuf.GetContents();
+   const sQMIContents & tlvs = qmiBuf.GetContents();
 
    bool bErr = false;
-   std::map <ULONG, const sQMIRawContentHeader *>::const_iterator pIter;
-   for (pIter = tlvs.begin(); pIter != tlvs.end(); pIter++)
+   ULONG id = tlvs.GetNextID( 0 );
+   for (; id < QMI_MAX_CONTENT_IDS; id = tlvs.GetNextID( id + 1 ))
    {
-      const sQMIRawContentHeader * pHdr = pIter->second;
+      const sQMIRawContentHeader * pHdr = tlvs.Find( id );
       if (pHdr == 0)
       {
          bErr = true;
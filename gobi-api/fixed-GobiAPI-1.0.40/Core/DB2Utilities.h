@@ -10,6 +10,7 @@ PUBLIC ENUMERATIONS AND METHODS:
    sProtocolEntityKey
    sDB2PackingInput
    sDB2NavInput
+   cDB2NavInputs
 
    MapQMIEntityTypeToProtocolType
    MapQMIEntityTypeToQMIServiceType
@@ -59,6 +60,8 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "SharedBuffer.h"
 #include "ProtocolBuffer.h"
 #include "QMIEnum.h"
+#include "QMIServices.h"
+#include "DataPacker.h"
 
 #include <vector>
 
@@ -66,30 +69,42 @@ POSSIBILITY OF SUCH DAMAGE.
 // Definitions
 //---------------------------------------------------------------------------
 
+// Maximum number of values in a protocol entity key
+const ULONG DB2_MAX_KEY_VALUES = 4;
+
+// Number of TLVs a cDB2NavInputs holds without allocating
+const ULONG DB2_INLINE_NAV_INPUTS = 16;
+
 /*=========================================================================*/
 // Struct sProtocolEntityKey
 //    Simple structure to initializing protocol entity keys easier
+//
+//    The key values are held inline (QMI keys are three values), so 
+//    building and comparing keys never allocates
 /*=========================================================================*/
 struct sProtocolEntityKey
 {
    public:
       // (Inline) Constructor - default
       sProtocolEntityKey()
+         :  mCount( 0 )
       { };
  
       // (Inline) Constructor - single value keys
       sProtocolEntityKey( ULONG val1 )
+         :  mCount( 0 )
       {
-         mKey.push_back( val1 );
+         push_back( val1 );
       };
 
       // (Inline) Constructor - two value keys
       sProtocolEntityKey( 
          ULONG                      val1,
          ULONG                      val2 )
+         :  mCount( 0 )
       {
-         mKey.push_back( val1 );
-         mKey.push_back( val2 );
+         push_back( val1 );
+         push_back( val2 );
       };
 
       // (Inline) Constructor - three value keys
@@ -97,37 +112,85 @@ struct sProtocolEntityKey
          ULONG                      val1,
          ULONG                      val2,
          ULONG                      val3 )
+         :  mCount( 0 )
       {
-         mKey.push_back( val1 );
-         mKey.push_back( val2 );
-         mKey.push_back( val3 );
+         push_back( val1 );
+         push_back( val2 );
+         push_back( val3 );
       };
 
-      // (Inline) Constructor - psuedo-copy constructor
+      // (Inline) Constructor - psuedo-copy constructor (keys longer 
+      // than DB2_MAX_KEY_VALUES are not supported and result in an
+      // empty key)
       sProtocolEntityKey( const std::vector <ULONG> & key )
-         :  mKey( key )
-      { };
+         :  mCount( 0 )
+      {
+         if ((ULONG)key.size() <= DB2_MAX_KEY_VALUES)
+         {
+            for (ULONG k = 0; k < (ULONG)key.size(); k++)
+            {
+               push_back( key[k] );
+            }
+         }
+      };
 
-      // (Inline) Constructor - copy constructor
-      sProtocolEntityKey( const sProtocolEntityKey & key )
-         :  mKey( key.mKey )
-      { };
+      // (Inline) Add a value to the key (ignored once the key is full)
+      void push_back( ULONG val )
+      {
+         if (mCount < DB2_MAX_KEY_VALUES)
+         {
+            mKey[mCount++] = val;
+         }
+      };
 
-      // (Inline) Assignment operator
-      sProtocolEntityKey & operator = ( const sProtocolEntityKey & key )
+      // (Inline) Return the number of values in the key
+      ULONG size() const
       {
-         mKey = key.mKey;
-         return *this;
+         return mCount;
+      };
+
+      // (Inline) Return the given key value
+      ULONG operator [] ( ULONG idx ) const
+      {
+         return mKey[idx];
+      };
+
+      // (Inline) Equality operator
+      bool operator == ( const sProtocolEntityKey & key ) const
+      {
+         if (mCount != key.mCount)
+         {
+            return false;
+         }
+
+         for (ULONG k = 0; k < mCount; k++)
+         {
+            if (mKey[k] != key.mKey[k])
+            {
+               return false;
+            }
+         }
+
+         return true;
+      };
+
+      // (Inline) Inequality operator
+      bool operator != ( const sProtocolEntityKey & key ) const
+      {
+         return !(*this == key);
       };
 
       // Cast operator to a protocol entity key
       operator std::vector <ULONG>() const
       {
-         return mKey;
+         return std::vector <ULONG>( &mKey[0], &mKey[0] + mCount );
       };
 
-      /* Underlying key */
-      std::vector <ULONG> mKey;
+      /* Underlying key values */
+      ULONG mKey[DB2_MAX_KEY_VALUES];
+
+      /* Number of above key values in use */
+      ULONG mCount;
 };
 
 /*=========================================================================*/
@@ -139,9 +202,10 @@ struct sDB2PackingInput
    public:
       // (Inline) Constructor - default
       sDB2PackingInput()
-         :  mpData( 0 ),
+         :  mbString( true ),
+            mpData( 0 ),
             mDataLen( 0 ),
-            mbString( true )
+            mpTypedFields( 0 )
       { };
  
       // (Inline) Constructor - parameterized (string payload)
@@ -149,9 +213,10 @@ struct sDB2PackingInput
          const sProtocolEntityKey & key,
          LPCSTR                     pValue )
          :  mKey( key ),
+            mbString( true ),
             mpData( 0 ),
             mDataLen( 0 ),
-            mbString( true )
+            mpTypedFields( 0 )
       { 
          if (pValue != 0 && pValue[0] != 0)
          {
@@ -165,9 +230,24 @@ struct sDB2PackingInput
          const BYTE *               pData,
          ULONG                      dataLen )
          :  mKey( key ),
+            mbString( false ),
             mpData( pData ),
             mDataLen( dataLen ),
-            mbString( false )
+            mpTypedFields( 0 )
+      { 
+         // Nothing to do
+      };
+
+      // (Inline) Constructor - parameterized (typed payload, the fields 
+      // must outlive this object)
+      sDB2PackingInput( 
+         const sProtocolEntityKey & key,
+         const cTypedFields &       fields )
+         :  mKey( key ),
+            mbString( false ),
+            mpData( 0 ),
+            mDataLen( 0 ),
+            mpTypedFields( &fields.GetFields() )
       { 
          // Nothing to do
       };
@@ -198,6 +278,9 @@ struct sDB2PackingInput
 
       /* Length of above buffer */
       ULONG mDataLen;
+
+      /* Typed field values (when not specified by a string or buffer) */
+      const std::vector <sTypedField> * mpTypedFields;
 };
 
 /*=========================================================================*/
@@ -215,7 +298,7 @@ struct sDB2NavInput
 
       // (Inline) Constructor - parameterized
       sDB2NavInput( 
-         const std::vector <ULONG> &   key,
+         const sProtocolEntityKey &    key,
          const BYTE *                  pData,
          ULONG                         dataLen )
          :  mKey( key ),
@@ -230,7 +313,7 @@ struct sDB2NavInput
       };
 
       /* Database key for payload entity */
-      std::vector <ULONG> mKey;
+      sProtocolEntityKey mKey;
 
       /* Payload */
       const BYTE * mpPayload;
@@ -239,20 +322,202 @@ struct sDB2NavInput
       ULONG mPayloadLen;
 };
 
-// Map a DB protocol entity type to a buffer protocol type
-eProtocolType MapQMIEntityTypeToProtocolType( eDB2EntityType et );
+/*=========================================================================*/
+// Class cDB2NavInputs
+//    The key/payload TLVs a QMI buffer reduces to, the first 
+//    DB2_INLINE_NAV_INPUTS are held inline and only the rest (if any) 
+//    are allocated
+/*=========================================================================*/
+class cDB2NavInputs
+{
+   public:
+      // (Inline) Constructor
+      cDB2NavInputs()
+         :  mCount( 0 )
+      { };
 
-// Map a DB protocol entity type to a QMI service type
-eQMIService MapQMIEntityTypeToQMIServiceType( eDB2EntityType et );
+      // (Inline) Copy constructor
+      cDB2NavInputs( const cDB2NavInputs & inputs )
+         :  mOverflow( inputs.mOverflow ),
+            mCount( inputs.mCount )
+      {
+         for (ULONG i = 0; i < mCount && i < DB2_INLINE_NAV_INPUTS; i++)
+         {
+            mInline[i] = inputs.mInline[i];
+         }
+      };
 
-// Map a buffer protocol type to a DB protocol entity type
-eDB2EntityType MapQMIProtocolTypeToEntityType( 
+      // (Inline) Assignment operator
+      cDB2NavInputs & operator = ( const cDB2NavInputs & inputs )
+      {
+         ULONG count = inputs.mCount;
+         for (ULONG i = 0; i < count && i < DB2_INLINE_NAV_INPUTS; i++)
+         {
+            mInline[i] = inputs.mInline[i];
+         }
+
+         mOverflow = inputs.mOverflow;
+         mCount = inputs.mCount;
+         return *this;
+      };
+
+      // (Inline) Add a TLV
+      void push_back( const sDB2NavInput & input )
+      {
+         if (mCount < DB2_INLINE_NAV_INPUTS)
+         {
+            mInline[mCount] = input;
+         }
+         else
+         {
+            mOverflow.push_back( input );
+         }
+
+         mCount++;
+      };
+
+      // (Inline) Remove all TLVs
+      void clear()
+      {
+         mOverflow.clear();
+         mCount = 0;
+      };
+
+      // (Inline) Return the number of TLVs
+      ULONG size() const
+      {
+         return mCount;
+      };
+
+      // (Inline) Return the given TLV
+      const sDB2NavInput & operator [] ( ULONG idx ) const
+      {
+         if (idx < DB2_INLINE_NAV_INPUTS)
+         {
+            return mInline[idx];
+         }
+
+         return mOverflow[idx - DB2_INLINE_NAV_INPUTS];
+      };
+
+   protected:
+      /* The first DB2_INLINE_NAV_INPUTS TLVs */
+      sDB2NavInput mInline[DB2_INLINE_NAV_INPUTS];
+
+      /* Any TLVs beyond those */
+      std::vector <sDB2NavInput> mOverflow;
+
+      /* Total number of TLVs */
+      ULONG mCount;
+};
+
+/*===========================================================================
+METHOD:
+   MapQMIEntityTypeToProtocolType (Inline Method)
+
+DESCRIPTION:
+   Map a DB protocol entity type (for QMI) to a buffer protocol type
+
+PARAMETERS:
+   et          [ I ] - Protocol entity type
+  
+RETURN VALUE:
+   eProtocolType
+===========================================================================*/
+inline eProtocolType MapQMIEntityTypeToProtocolType( eDB2EntityType et )
+{
+   const sQMIServiceInfo * pInfo = FindQMIServiceByEntity( et );
+   if (pInfo == 0)
+   {
+      return ePROTOCOL_ENUM_BEGIN;
+   }
+
+   return (et == pInfo->mRequestType ? pInfo->mTxType : pInfo->mRxType);
+};
+
+/*===========================================================================
+METHOD:
+   MapQMIEntityTypeToQMIServiceType (Inline Method)
+
+DESCRIPTION:
+   Map a DB protocol entity type (for QMI) to a QMI service type
+
+PARAMETERS:
+   et          [ I ] - Protocol entity type
+  
+RETURN VALUE:
+   eQMIService
+===========================================================================*/
+inline eQMIService MapQMIEntityTypeToQMIServiceType( eDB2EntityType et )
+{
+   const sQMIServiceInfo * pInfo = FindQMIServiceByEntity( et );
+   if (pInfo == 0)
+   {
+      return eQMI_SVC_ENUM_BEGIN;
+   }
+
+   return pInfo->mService;
+};
+
+/*===========================================================================
+METHOD:
+   MapQMIProtocolTypeToEntityType (Inline Method)
+
+DESCRIPTION:
+   Map a buffer protocol type to a DB protocol entity type
+
+PARAMETERS:
+   pt          [ I ] - Protocol type
+   bIndication [ I ] - Is this for an indication?
+  
+RETURN VALUE:
+   eDB2EntityType
+===========================================================================*/
+inline eDB2EntityType MapQMIProtocolTypeToEntityType( 
    eProtocolType              pt,
-   bool                       bIndication = false );
+   bool                       bIndication = false )
+{
+   const sQMIServiceInfo * pInfo = FindQMIServiceByProtocol( pt );
+   if (pInfo == 0)
+   {
+      return eDB2_ET_ENUM_BEGIN;
+   }
+
+   // Requests are followed by responses and then indications
+   ULONG et = (ULONG)pInfo->mRequestType;
+   if (pt == pInfo->mRxType)
+   {
+      et += (bIndication == true ? 2 : 1);
+   }
+
+   return (eDB2EntityType)et;
+};
+
+/*===========================================================================
+METHOD:
+   DB2GetMaxBufferSize (Inline Method)
 
-// Return the maximum size of a payload buffer for given type of 
-// protocol entity
-ULONG DB2GetMaxBufferSize( eDB2EntityType et );
+DESCRIPTION:
+   Return the maximum size of a payload buffer for given type of 
+   protocol entity
+
+PARAMETERS:
+   et          [ I ] - Protocol entity type
+  
+RETURN VALUE:
+   ULONG - Maximum 
+===========================================================================*/
+inline ULONG DB2GetMaxBufferSize( eDB2EntityType et )
+{
+   const sQMIServiceInfo * pInfo = FindQMIServiceByEntity( et );
+   if (pInfo == 0)
+   {
+      return MAX_SHARED_BUFFER_SIZE;
+   }
+
+   // QMI items are further constrained in size
+   return pInfo->mMaxBufferSize;
+};
 
 // Build an allocated shared buffer for the QMI protocol
 sSharedBuffer * DB2BuildQMIBuffer(
@@ -264,5 +529,5 @@ sSharedBuffer * DB2PackQMIBuffer(
    const std::vector <sDB2PackingInput> & input );
 
 // Reduce a QMI buffer to DB keys and payload
-std::vector <sDB2NavInput> DB2ReduceQMIBuffer( const sProtocolBuffer & buf );
+cDB2NavInputs DB2ReduceQMIBuffer( const sProtocolBuffer & buf );
 
@@ -11,6 +11,11 @@ PUBLIC CLASSES AND METHODS:
       field value as a string and an optional field name (either fully
       qualified) or partial
 
+   sTypedField
+      Structure to represent a single typed (input) field - i.e. the
+      field value as a native integer, floating point value or string
+      and an optional field ID
+
    cDataPacker
       Class to pack bit/byte specified fields into a buffer accordinging
       to a database description, uses cProtocolEntityNav to navigate the DB
@@ -59,6 +64,98 @@ POSSIBILITY OF SUCH DAMAGE.
 // Definitions
 //---------------------------------------------------------------------------
 
+/*=========================================================================*/
+// Free Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   GetTypedInteger (Internal Method)
+
+DESCRIPTION:
+   Return the value of a typed (input) field as an integer (provided the
+   value is an integer within the given range)
+
+PARAMETERS:
+   field       [ I ] - Typed field
+   minVal      [ I ] - Minimum allowable value
+   maxVal      [ I ] - Maximum allowable value
+   val         [ O ] - The value (two's complement if negative)
+  
+RETURN VALUE:
+   bool
+===========================================================================*/
+static bool GetTypedInteger(
+   const sTypedField &        field,
+   LONGLONG                   minVal,
+   ULONGLONG                  maxVal,
+   ULONGLONG &                val )
+{
+   if (field.mType == eTYPED_FIELD_UNSIGNED)
+   {
+      if (field.mUnsigned > maxVal)
+      {
+         return false;
+      }
+
+      val = field.mUnsigned;
+      return true;
+   }
+
+   if (field.mType == eTYPED_FIELD_SIGNED)
+   {
+      if ( (field.mSigned < minVal)
+      ||   (field.mSigned > 0 && (ULONGLONG)field.mSigned > maxVal) )
+      {
+         return false;
+      }
+
+      val = (ULONGLONG)field.mSigned;
+      return true;
+   }
+
+   return false;
+}
+
+/*===========================================================================
+METHOD:
+   GetTypedFloat (Internal Method)
+
+DESCRIPTION:
+   Return the value of a typed (input) field as a floating point value
+
+PARAMETERS:
+   field       [ I ] - Typed field
+   val         [ O ] - The value
+  
+RETURN VALUE:
+   bool
+===========================================================================*/
+static bool GetTypedFloat(
+   const sTypedField &        field,
+   DOUBLE &                   val )
+{
+   switch (field.mType)
+   {
+      case eTYPED_FIELD_FLOAT:
+         val = field.mFloat;
+         return true;
+
+      case eTYPED_FIELD_SIGNED:
+         val = (DOUBLE)field.mSigned;
+         return true;
+
+      case eTYPED_FIELD_UNSIGNED:
+         val = (DOUBLE)field.mUnsigned;
+         return true;
+
+      default:
+         break;
+   }
+
+   return false;
+}
+
 /*=========================================================================*/
 // cDataPacker Methods
 /*=========================================================================*/
@@ -68,12 +165,14 @@ METHOD:
    cDataPacker (Public Method)
 
 DESCRIPTION:
-   Constructor
+   Constructor (string values)
 
 PARAMETERS:
    db             [ I ] - Database to use
    key            [ I ] - Key into protocol entity table
    fields         [ I ] - Fields to pack into buffer
+   pOutput        [ I ] - (Optional) zeroed buffer to pack into 
+   outputLen      [ I ] - Size of above buffer (in bytes)
   
 RETURN VALUE:
    None
@@ -81,26 +180,18 @@ RETURN VALUE:
 cDataPacker::cDataPacker( 
    const cCoreDatabase &               db,
    const std::vector <ULONG> &         key,
-   const std::list <sUnpackedField> &  fields )
+   const std::list <sUnpackedField> &  fields,
+   BYTE *                              pOutput,
+   ULONG                               outputLen )
    :  cProtocolEntityNav( db ),
       mKey( key ),
+      mpTypedFields( 0 ),
       mbValuesOnly( true ),
       mProcessedFields( 0 ),
+      mpBuffer( 0 ),
       mbPacked( false )
 {
-   // Initialize internal buffer
-   memset( &mBuffer[0], 0, (SIZE_T)MAX_SHARED_BUFFER_SIZE );
-
-   // Compute bits left in buffer
-   ULONG bits = MAX_SHARED_BUFFER_SIZE * BITS_PER_BYTE;
-   if (mKey.size() > 0)
-   {
-      eDB2EntityType et = (eDB2EntityType)mKey[0];
-      bits = DB2GetMaxBufferSize( et ) * BITS_PER_BYTE;
-   }
-   
-   // Setup the bit packer
-   mBitsy.SetData( mBuffer, bits );
+   InitializeBuffer( pOutput, outputLen );
 
    // Copy fields/set value only flag
    std::list <sUnpackedField>::const_iterator pIter = fields.begin();
@@ -109,6 +200,10 @@ cDataPacker::cDataPacker(
       if (pIter->mName.size() > 0)
       {
          mbValuesOnly = false;
+
+         // Index the name, keeping the first value given for a field
+         std::pair <std::string, ULONG> e( pIter->mName, (ULONG)mFields.size() );
+         mNameIndex.insert( e );
       }
 
       mFields.push_back( *pIter );
@@ -116,6 +211,42 @@ cDataPacker::cDataPacker(
    }
 }
 
+/*===========================================================================
+METHOD:
+   cDataPacker (Public Method)
+
+DESCRIPTION:
+   Constructor (typed values), the values are consumed in the order the
+   fields are encountered while navigating the entity (a value that
+   specifies a field ID must match the field it is consumed by)
+
+PARAMETERS:
+   db             [ I ] - Database to use
+   key            [ I ] - Key into protocol entity table
+   fields         [ I ] - Fields to pack into buffer (must outlive packer)
+   pOutput        [ I ] - (Optional) zeroed buffer to pack into 
+   outputLen      [ I ] - Size of above buffer (in bytes)
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+cDataPacker::cDataPacker( 
+   const cCoreDatabase &               db,
+   const std::vector <ULONG> &         key,
+   const std::vector <sTypedField> &   fields,
+   BYTE *                              pOutput,
+   ULONG                               outputLen )
+   :  cProtocolEntityNav( db ),
+      mKey( key ),
+      mpTypedFields( &fields ),
+      mbValuesOnly( true ),
+      mProcessedFields( 0 ),
+      mpBuffer( 0 ),
+      mbPacked( false )
+{
+   InitializeBuffer( pOutput, outputLen );
+}
+
 /*===========================================================================
 METHOD:
    ~cDataPacker (Public Method)
@@ -132,6 +263,54 @@ cDataPacker::~cDataPacker()
    mBitsy.ReleaseData();
 }
 
+/*===========================================================================
+METHOD:
+   InitializeBuffer (Internal Method)
+
+DESCRIPTION:
+   Setup the bit packer on the output buffer, packing into a caller 
+   supplied buffer (which must already be zeroed) avoids both clearing
+   and copying out of the internal working buffer
+
+PARAMETERS:
+   pOutput        [ I ] - Zeroed buffer to pack into (0 = internal buffer)
+   outputLen      [ I ] - Size of above buffer (in bytes)
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+void cDataPacker::InitializeBuffer( 
+   BYTE *                     pOutput,
+   ULONG                      outputLen )
+{
+   // Compute bits left in buffer
+   ULONG bits = MAX_SHARED_BUFFER_SIZE * BITS_PER_BYTE;
+   if (mKey.size() > 0)
+   {
+      eDB2EntityType et = (eDB2EntityType)mKey[0];
+      bits = DB2GetMaxBufferSize( et ) * BITS_PER_BYTE;
+   }
+
+   if (pOutput != 0)
+   {
+      if (outputLen * BITS_PER_BYTE < bits)
+      {
+         bits = outputLen * BITS_PER_BYTE;
+      }
+
+      mpBuffer = pOutput;
+   }
+   else
+   {
+      // Initialize internal buffer
+      memset( &mBuffer[0], 0, (SIZE_T)MAX_SHARED_BUFFER_SIZE );
+      mpBuffer = &mBuffer[0];
+   }
+   
+   // Setup the bit packer
+   mBitsy.SetData( mpBuffer, bits );
+}
+
 /*===========================================================================
 METHOD:
    Pack (Public Method)
@@ -191,7 +370,7 @@ const BYTE * cDataPacker::GetBuffer( ULONG & bufferLen )
    const BYTE * pBuffer = 0;
    if (bufferLen > 0)
    {
-      pBuffer = (const BYTE *)&mBuffer[0];
+      pBuffer = (const BYTE *)mpBuffer;
    }
 
    return pBuffer;
@@ -292,10 +471,9 @@ METHOD:
    GetLastValue (Internal Method)
 
 DESCRIPTION:
-   Working from the back of the current value list find and return the 
-   value for the specified field ID as a LONGLONG (field type must have 
-   been able to fit in a LONGLONG for a value to be stored in value list
-   and thus returned)
+   Return the last packed value for the specified (tracked) field ID as a
+   LONGLONG (field type must have been able to fit in a LONGLONG for a 
+   value to be stored and thus returned)
 
 PARAMETERS:
    fieldID     [ I ] - Field ID we are looking for
@@ -311,26 +489,45 @@ bool cDataPacker::GetLastValue(
    // Assume failure
    bool bRC = false;
 
-   std::list < std::pair <ULONG, LONGLONG> >::reverse_iterator pValues;
-   pValues = mValues.rbegin();
-   while (pValues != mValues.rend())
+   // Use field value tracking information
+   const sPENavTrackedField * pTF = FindTrackedField( fieldID );
+   if (pTF != 0 && pTF->mbValid == true)
    {
-      std::pair <ULONG, LONGLONG> & entry = *pValues;
-      if (entry.first == fieldID)
-      {
-         val = entry.second;
-
-         // Success!
-         bRC = true;
-         break;
-      }
+      val = pTF->mValue;
 
-      pValues++;
+      // Success!
+      bRC = true;
    }
 
    return bRC;
 }
 
+/*===========================================================================
+METHOD:
+   TrackValue (Internal Method)
+
+DESCRIPTION:
+   Store the value of a packed field if navigation depends upon it
+
+PARAMETERS:
+   fieldID     [ I ] - Field ID
+   val         [ I ] - The value
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+void cDataPacker::TrackValue( 
+   ULONG                      fieldID,
+   LONGLONG                   val )
+{
+   sPENavTrackedField * pTF = FindTrackedField( fieldID );
+   if (pTF != 0)
+   {
+      pTF->mValue = val;
+      pTF->mbValid = true;
+   }
+}
+
 /*===========================================================================
 METHOD:
    GetValueString (Internal Method)
@@ -357,17 +554,44 @@ bool cDataPacker::GetValueString(
    // Create fully qualified field name
    std::string fullName = GetFullFieldName( fieldName );
 
-   std::vector <sUnpackedField>::const_iterator pVals = mFields.begin();
-   while (pVals != mFields.end())
+   if (mbValuesOnly == false)
    {
-      const std::string & inName = pVals->mName;
-      if (fieldName == inName || fullName == inName)
+      // The names are fixed, look the field up by either name (the value
+      // given first wins)
+      ULONG idx = ULONG_MAX;
+      std::map <std::string, ULONG>::const_iterator pName;
+      pName = mNameIndex.find( fieldName );
+      if (pName != mNameIndex.end())
       {
-         pValueString = (LPCSTR)pVals->mValueString.c_str();
-         break;
+         idx = pName->second;
+      }
+
+      pName = mNameIndex.find( fullName );
+      if (pName != mNameIndex.end() && pName->second < idx)
+      {
+         idx = pName->second;
       }
 
-      pVals++;
+      if (idx != ULONG_MAX)
+      {
+         pValueString = (LPCSTR)mFields[idx].mValueString.c_str();
+      }
+   }
+   else
+   {
+      // Names are assigned as values are consumed
+      std::vector <sUnpackedField>::const_iterator pVals = mFields.begin();
+      while (pVals != mFields.end())
+      {
+         const std::string & inName = pVals->mName;
+         if (fieldName == inName || fullName == inName)
+         {
+            pValueString = (LPCSTR)pVals->mValueString.c_str();
+            break;
+         }
+
+         pVals++;
+      }
    }
 
    // Value provided?
@@ -515,6 +739,12 @@ bool cDataPacker::ProcessField(
       return bOK;
    }
 
+   // Packing typed values?
+   if (mpTypedFields != 0)
+   {
+      return ProcessTypedField( *pField );
+   }
+
    // Find given value for field
    LPCSTR pVal = 0;
    bool bVal = GetValueString( *pField, fieldName, pVal );
@@ -553,8 +783,7 @@ bool cDataPacker::ProcessField(
                   if (rc == NO_ERROR)
                   {         
                      // Success!
-                     std::pair <ULONG, LONGLONG> entry( id, (LONGLONG)val );
-                     mValues.push_back( entry );
+                     TrackValue( id, (LONGLONG)val );
                      bOK = true;
                   }
                }
@@ -573,8 +802,7 @@ bool cDataPacker::ProcessField(
                   if (rc == NO_ERROR)
                   {         
                      // Success!         
-                     std::pair <ULONG, LONGLONG> entry( id, (LONGLONG)val );
-                     mValues.push_back( entry );
+                     TrackValue( id, (LONGLONG)val );
                      bOK = true;
                   }
                }
@@ -593,8 +821,7 @@ bool cDataPacker::ProcessField(
                   if (rc == NO_ERROR)
                   {         
                      // Success!               
-                     std::pair <ULONG, LONGLONG> entry( id, (LONGLONG)val );
-                     mValues.push_back( entry );
+                     TrackValue( id, (LONGLONG)val );
                      bOK = true;
                   }
                }
@@ -613,8 +840,7 @@ bool cDataPacker::ProcessField(
                   if (rc == NO_ERROR)
                   {         
                      // Success!
-                     std::pair <ULONG, LONGLONG> entry( id, (LONGLONG)val );
-                     mValues.push_back( entry );
+                     TrackValue( id, (LONGLONG)val );
                      bOK = true;
                   } 
                }
@@ -633,8 +859,7 @@ bool cDataPacker::ProcessField(
                   if (rc == NO_ERROR)
                   {         
                      // Success!
-                     std::pair <ULONG, LONGLONG> entry( id, (LONGLONG)val );
-                     mValues.push_back( entry );
+                     TrackValue( id, (LONGLONG)val );
                      bOK = true;
                   }
                }
@@ -653,8 +878,7 @@ bool cDataPacker::ProcessField(
                   if (rc == NO_ERROR)
                   {         
                      // Success!
-                     std::pair <ULONG, LONGLONG> entry( id, (LONGLONG)val );
-                     mValues.push_back( entry );
+                     TrackValue( id, (LONGLONG)val );
                      bOK = true;
                   }
                }
@@ -673,8 +897,7 @@ bool cDataPacker::ProcessField(
                   if (rc == NO_ERROR)
                   {         
                      // Success!
-                     std::pair <ULONG, LONGLONG> entry( id, val );
-                     mValues.push_back( entry );
+                     TrackValue( id, val );
                      bOK = true;
                   }
                }
@@ -695,8 +918,7 @@ bool cDataPacker::ProcessField(
                      // Success!
                      if (val <= LLONG_MAX)
                      {                     
-                        std::pair <ULONG, LONGLONG> entry( id, (LONGLONG)val );
-                        mValues.push_back( entry );
+                        TrackValue( id, (LONGLONG)val );
                      }
 
                      bOK = true;
@@ -793,8 +1015,7 @@ bool cDataPacker::ProcessField(
             if (rc == NO_ERROR)
             {         
                // Success!
-               std::pair <ULONG, LONGLONG> entry( id, (LONGLONG)val );
-               mValues.push_back( entry );
+               TrackValue( id, (LONGLONG)val );
                bOK = true;
             }
          }
@@ -812,8 +1033,7 @@ bool cDataPacker::ProcessField(
             if (rc == NO_ERROR)
             {         
                // Success!
-               std::pair <ULONG, LONGLONG> entry( id, (LONGLONG)val );
-               mValues.push_back( entry );
+               TrackValue( id, (LONGLONG)val );
                bOK = true;
             }
          }
@@ -829,3 +1049,263 @@ bool cDataPacker::ProcessField(
 
    return bOK;
 }
+
+/*===========================================================================
+METHOD:
+   ProcessTypedField (Internal Method)
+
+DESCRIPTION:
+   Process the given field by packing the next typed value into the
+   buffer, values are packed as given (no string parsing) but must still
+   fit the field type
+  
+PARAMETERS:
+   field       [ I ] - The field being processed
+  
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cDataPacker::ProcessTypedField( const sDB2Field & field )
+{
+   // Assume failure
+   bool bOK = false;
+
+   // Grab the next value
+   if (mProcessedFields >= (ULONG)mpTypedFields->size())
+   {
+      return bOK;
+   }
+
+   const sTypedField & val = (*mpTypedFields)[mProcessedFields++];
+   if (val.mFieldID != TYPED_FIELD_ANY_ID && val.mFieldID != field.mID)
+   {
+      return bOK;
+   }
+
+   // Integer value as packed, should it be stored in the value list?
+   ULONGLONG raw = 0;
+   bool bStore = false;
+
+   // What type is this field?    
+   switch (field.mType)
+   {
+      case eDB2_FIELD_STD:
+      {
+         // Standard field, what kind?
+         eDB2StdFieldType ft = (eDB2StdFieldType)field.mTypeVal;
+         switch (ft)
+         {              
+            // Field is a boolean (0/1, false/true)/8-bit unsigned integer
+            case eDB2_FIELD_STDTYPE_BOOL:
+            case eDB2_FIELD_STDTYPE_UINT8:
+            {
+               bOK = GetTypedInteger( val, 0, UCHAR_MAX, raw );
+               if (bOK == true)
+               {
+                  if (ft == eDB2_FIELD_STDTYPE_BOOL && raw > 1)
+                  {
+                     raw = 1;
+                  }
+
+                  bOK = (mBitsy.Set( field.mSize, (UCHAR)raw ) == NO_ERROR);
+                  bStore = true;
+               }
+            }
+            break;
+
+            // Field is 8-bit signed integer
+            case eDB2_FIELD_STDTYPE_INT8:
+            {
+               bOK = GetTypedInteger( val, SCHAR_MIN, SCHAR_MAX, raw );
+               if (bOK == true)
+               {
+                  bOK = (mBitsy.Set( field.mSize, (CHAR)raw ) == NO_ERROR);
+                  bStore = true;
+               }
+            }
+            break;
+
+            // Field is 16-bit signed integer
+            case eDB2_FIELD_STDTYPE_INT16: 
+            {
+               bOK = GetTypedInteger( val, SHRT_MIN, SHRT_MAX, raw );
+               if (bOK == true)
+               {
+                  bOK = (mBitsy.Set( field.mSize, (SHORT)raw ) == NO_ERROR);
+                  bStore = true;
+               }
+            }
+            break;
+
+            // Field is 16-bit unsigned integer
+            case eDB2_FIELD_STDTYPE_UINT16:
+            {
+               bOK = GetTypedInteger( val, 0, USHRT_MAX, raw );
+               if (bOK == true)
+               {
+                  bOK = (mBitsy.Set( field.mSize, (USHORT)raw ) == NO_ERROR);
+                  bStore = true;
+               }
+            }
+            break;
+
+            // Field is 32-bit signed integer
+            case eDB2_FIELD_STDTYPE_INT32:
+            {
+               bOK = GetTypedInteger( val, INT_MIN, INT_MAX, raw );
+               if (bOK == true)
+               {
+                  bOK = (mBitsy.Set( field.mSize, (LONG)raw ) == NO_ERROR);
+                  bStore = true;
+               }
+            }
+            break;
+
+            // Field is 32-bit unsigned integer
+            case eDB2_FIELD_STDTYPE_UINT32:
+            {              
+               bOK = GetTypedInteger( val, 0, UINT_MAX, raw );
+               if (bOK == true)
+               {
+                  bOK = (mBitsy.Set( field.mSize, (ULONG)raw ) == NO_ERROR);
+                  bStore = true;
+               }
+            }
+            break;
+
+            // Field is 64-bit signed integer
+            case eDB2_FIELD_STDTYPE_INT64:
+            {
+               bOK = GetTypedInteger( val, LLONG_MIN, LLONG_MAX, raw );
+               if (bOK == true)
+               {
+                  bOK = (mBitsy.Set( field.mSize, (LONGLONG)raw ) == NO_ERROR);
+                  bStore = true;
+               }
+            }
+            break;
+
+            // Field is 64-bit unsigned integer
+            case eDB2_FIELD_STDTYPE_UINT64:
+            {
+               bOK = GetTypedInteger( val, 0, ULLONG_MAX, raw );
+               if (bOK == true)
+               {
+                  bOK = (mBitsy.Set( field.mSize, raw ) == NO_ERROR);
+                  bStore = (raw <= LLONG_MAX);
+               }
+            }
+            break;
+
+            // ANSI/UNICODE strings
+            case eDB2_FIELD_STDTYPE_STRING_A:
+            case eDB2_FIELD_STDTYPE_STRING_U:
+            case eDB2_FIELD_STDTYPE_STRING_ANT:
+            case eDB2_FIELD_STDTYPE_STRING_UNT:
+            {
+               if (val.mType != eTYPED_FIELD_STRING)
+               {
+                  break;
+               }
+
+               // Set the character size
+               ULONG charSz = sizeof(CHAR);
+               if ( (ft == eDB2_FIELD_STDTYPE_STRING_U)
+               ||   (ft == eDB2_FIELD_STDTYPE_STRING_UNT) )
+               {
+                  charSz = sizeof(USHORT);
+               }
+
+               // Compute the number of characters?
+               ULONG numChars = 0;
+               if ( (ft == eDB2_FIELD_STDTYPE_STRING_A)
+               ||   (ft == eDB2_FIELD_STDTYPE_STRING_U) )
+               {
+                  numChars = (field.mSize / BITS_PER_BYTE) / charSz;
+               }
+
+               // Pack the string
+               bOK = PackString( numChars, val.mString.c_str() );
+            }
+            break;
+
+            // Field is 32-bit floating point value
+            case eDB2_FIELD_STDTYPE_FLOAT32:
+            {
+               DOUBLE dbl = 0.0;
+               bOK = GetTypedFloat( val, dbl );
+               if (bOK == true)
+               {
+                  // We pack as a 32-bit unsigned integer
+                  FLOAT flt = (FLOAT)dbl;
+                  UINT tmp = 0;
+                  memcpy( (LPVOID)&tmp, (LPCVOID)&flt, sizeof( tmp ) );
+
+                  bOK = (mBitsy.Set( field.mSize, (ULONG)tmp ) == NO_ERROR);
+               }
+            }
+            break;
+
+            // Field is 64-bit floating point value
+            case eDB2_FIELD_STDTYPE_FLOAT64:
+            {
+               DOUBLE dbl = 0.0;
+               bOK = GetTypedFloat( val, dbl );
+               if (bOK == true)
+               {
+                  // We pack as a ULONGLONG
+                  ULONGLONG tmp = 0;
+                  memcpy( (LPVOID)&tmp, (LPCVOID)&dbl, sizeof( tmp ) );
+
+                  bOK = (mBitsy.Set( field.mSize, tmp ) == NO_ERROR);
+               }
+            }
+            break;
+
+            // UTF-8 strings are unsupported in the Linux adaptation
+            default:
+            {
+               bOK = false;                  
+            }
+            break;
+         }
+      }
+      break;
+
+      case eDB2_FIELD_ENUM_UNSIGNED:
+      {
+         bOK = GetTypedInteger( val, 0, UINT_MAX, raw );
+         if (bOK == true)
+         {
+            bOK = (mBitsy.Set( field.mSize, (ULONG)raw ) == NO_ERROR);
+            bStore = true;
+         }
+      }
+      break;
+
+      case eDB2_FIELD_ENUM_SIGNED:
+      {
+         bOK = GetTypedInteger( val, INT_MIN, INT_MAX, raw );
+         if (bOK == true)
+         {
+            bOK = (mBitsy.Set( field.mSize, (LONG)raw ) == NO_ERROR);
+            bStore = true;
+         }
+      }
+      break;
+
+      default:
+      {
+         bOK = false;                  
+      }
+      break;
+   }      
+
+   if (bOK == true && bStore == true)
+   {
+      // Success!
+      TrackValue( field.mID, (LONGLONG)raw );
+   }
+
+   return bOK;
+}
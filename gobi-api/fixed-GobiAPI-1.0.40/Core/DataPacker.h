@@ -3,7 +3,7 @@ FILE:
    DataPacker.h
 
 DESCRIPTION:
-   Declaration of sUnpackedField and cDataPacker
+   Declaration of sUnpackedField, sTypedField, cTypedFields and cDataPacker
 
 PUBLIC CLASSES AND METHODS:
    sUnpackedField
@@ -11,6 +11,14 @@ PUBLIC CLASSES AND METHODS:
       field value as a string and an optional field name (either fully
       qualified) or partial
 
+   sTypedField
+      Structure to represent a single typed (input) field - i.e. the
+      field value as a native integer, floating point value or string
+      and an optional field ID
+
+   cTypedFields
+      Class to build the vector of typed (input) fields for an entity
+
    cDataPacker
       Class to pack bit/byte specified fields into a buffer accordinging
       to a database description, uses cProtocolEntityNav to navigate the DB
@@ -59,6 +67,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "ProtocolEntityNav.h"
 
 #include <list>
+#include <map>
 #include <vector>
 
 //---------------------------------------------------------------------------
@@ -94,6 +103,139 @@ struct sUnpackedField
       std::string mName;
 };
 
+// Field ID of a typed field that matches whatever field is being packed
+const ULONG TYPED_FIELD_ANY_ID = ULONG_MAX;
+
+/*=========================================================================*/
+// Enum eTypedFieldValue
+//
+//    Kind of value held by a typed (input) field
+/*=========================================================================*/
+enum eTypedFieldValue
+{
+   eTYPED_FIELD_SIGNED,          // Signed integer (mSigned)
+   eTYPED_FIELD_UNSIGNED,        // Unsigned integer (mUnsigned)
+   eTYPED_FIELD_FLOAT,           // Floating point value (mFloat)
+   eTYPED_FIELD_STRING           // String (mString)
+};
+
+/*=========================================================================*/
+// Struct sTypedField
+//
+//    Structure to represent a typed (input) field, packing these skips
+//    formatting each value as a string and parsing it back out again
+/*=========================================================================*/
+struct sTypedField
+{
+   public:
+      // (Inline) Constructor - default
+      sTypedField()
+         :  mFieldID( TYPED_FIELD_ANY_ID ),
+            mType( eTYPED_FIELD_UNSIGNED ),
+            mUnsigned( 0 )
+      { };
+
+      /* ID of field (TYPED_FIELD_ANY_ID = next field in entity order) */
+      ULONG mFieldID;
+
+      /* Kind of value */
+      eTypedFieldValue mType;
+
+      /* Field value (as indicated by the above kind) */
+      union
+      {
+         LONGLONG mSigned;
+         ULONGLONG mUnsigned;
+         DOUBLE mFloat;
+      };
+
+      /* Field value (eTYPED_FIELD_STRING) */
+      std::string mString;
+};
+
+/*=========================================================================*/
+// Class cTypedFields
+//
+//    Class to build the vector of typed (input) fields for an entity, 
+//    values are given in the order the fields appear in the entity
+/*=========================================================================*/
+class cTypedFields
+{
+   public:
+      // (Inline) Add a signed integer value
+      cTypedFields & AddSigned( 
+         LONGLONG                   val,
+         ULONG                      fieldID = TYPED_FIELD_ANY_ID )
+      {
+         sTypedField & field = Add( eTYPED_FIELD_SIGNED, fieldID );
+         field.mSigned = val;
+         return *this;
+      };
+
+      // (Inline) Add an unsigned integer value
+      cTypedFields & AddUnsigned( 
+         ULONGLONG                  val,
+         ULONG                      fieldID = TYPED_FIELD_ANY_ID )
+      {
+         sTypedField & field = Add( eTYPED_FIELD_UNSIGNED, fieldID );
+         field.mUnsigned = val;
+         return *this;
+      };
+
+      // (Inline) Add a floating point value
+      cTypedFields & AddFloat( 
+         DOUBLE                     val,
+         ULONG                      fieldID = TYPED_FIELD_ANY_ID )
+      {
+         sTypedField & field = Add( eTYPED_FIELD_FLOAT, fieldID );
+         field.mFloat = val;
+         return *this;
+      };
+
+      // (Inline) Add a string value (0 = empty string)
+      cTypedFields & AddString( 
+         LPCSTR                     pVal,
+         ULONG                      fieldID = TYPED_FIELD_ANY_ID )
+      {
+         sTypedField & field = Add( eTYPED_FIELD_STRING, fieldID );
+         if (pVal != 0)
+         {
+            field.mString = pVal;
+         }
+
+         return *this;
+      };
+
+      // (Inline) Remove all values
+      void Clear()
+      {
+         mFields.clear();
+      };
+
+      // (Inline) Return the values
+      const std::vector <sTypedField> & GetFields() const
+      {
+         return mFields;
+      };
+
+   protected:
+      // (Inline) Add a value of the given kind
+      sTypedField & Add( 
+         eTypedFieldValue           type,
+         ULONG                      fieldID )
+      {
+         mFields.push_back( sTypedField() );
+
+         sTypedField & field = mFields.back();
+         field.mFieldID = fieldID;
+         field.mType = type;
+         return field;
+      };
+
+      /* The vector of values */
+      std::vector <sTypedField> mFields;
+};
+
 /*=========================================================================*/
 // Class cDataPacker
 //    Class to pack bit/byte specified fields into a buffer
@@ -101,11 +243,21 @@ struct sUnpackedField
 class cDataPacker : public cProtocolEntityNav
 {
    public:
-      // Constructor
+      // Constructor (string values)
+      cDataPacker( 
+         const cCoreDatabase &               db,
+         const std::vector <ULONG> &         key,
+         const std::list <sUnpackedField> &  fields,
+         BYTE *                              pOutput = 0,
+         ULONG                               outputLen = 0 );
+
+      // Constructor (typed values)
       cDataPacker( 
          const cCoreDatabase &               db,
          const std::vector <ULONG> &         key,
-         const std::list <sUnpackedField> &  fields );
+         const std::vector <sTypedField> &   fields,
+         BYTE *                              pOutput = 0,
+         ULONG                               outputLen = 0 );
          
       // Destructor
       virtual ~cDataPacker();
@@ -128,13 +280,22 @@ class cDataPacker : public cProtocolEntityNav
          ULONG                        startIndex );
 
    protected:
-      // Working from the back of the current value list find
-      // and return the value for the specified field ID as a
-      // LONGLONG (field type must be able to fit)
+      // Setup the bit packer on the output (or internal) buffer
+      void InitializeBuffer( 
+         BYTE *                     pOutput,
+         ULONG                      outputLen );
+
+      // Return the last packed value for the specified (tracked)
+      // field ID as a LONGLONG (field type must be able to fit)
       virtual bool GetLastValue( 
          ULONG                      fieldID,
          LONGLONG &                 val );
 
+      // Store the value of a packed field if navigation depends upon it
+      void TrackValue( 
+         ULONG                      fieldID,
+         LONGLONG                   val );
+
       // For the given field return the (input) value string
       virtual bool GetValueString(
          const sDB2Field &          field,
@@ -152,6 +313,9 @@ class cDataPacker : public cProtocolEntityNav
          const std::string &        fieldName,
          LONGLONG                   arrayIndex = -1 );
 
+      // Process the given field using the next typed value
+      virtual bool ProcessTypedField( const sDB2Field & field );
+
       // (Inline) Get current working offset 
       virtual ULONG GetOffset() 
       {         
@@ -201,16 +365,22 @@ class cDataPacker : public cProtocolEntityNav
       /* The vector of fields */
       std::vector <sUnpackedField> mFields;
 
+      /* Index into the above by field name (when names are given) */
+      std::map <std::string, ULONG> mNameIndex;
+
+      /* The vector of typed fields (0 when packing string values) */
+      const std::vector <sTypedField> * mpTypedFields;
+
       /* Are we operating in value only mode, i.e. no field names given? */
       bool mbValuesOnly;
       ULONG mProcessedFields;
 
-      /* Raw field values associated with field ID */
-      std::list < std::pair <ULONG, LONGLONG> > mValues;
-
       /* Internal working buffer */
       BYTE mBuffer[MAX_SHARED_BUFFER_SIZE];
 
+      /* Buffer being packed (caller supplied output or the above) */
+      BYTE * mpBuffer;
+
       /* Did we successfully pack the buffer? */
       bool mbPacked;
 };
@@ -15,6 +15,10 @@ PUBLIC CLASSES AND METHODS:
       to a database description, uses cProtocolEntityNav to navigate the DB
       definition
 
+   cIncrementalDataParser
+      Class to parse a payload that is fed to it in pieces, fields are
+      produced as soon as the data they depend on is available
+
 Copyright (c) 2011, Code Aurora Forum. All rights reserved.
 
 Redistribution and use in source and binary forms, with or without
@@ -52,6 +56,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "CoreDatabase.h"
 #include "DB2Utilities.h"
 
+#include <algorithm>
 #include <climits>
 
 //---------------------------------------------------------------------------
@@ -513,13 +518,16 @@ sParsedField::sParsedField(
             // Grab the enum ID
             ULONG id = pField->mTypeVal;
 
-            // Map to a string?
+            // Map to a string? (without building a temporary string)
             if (bGenStrings == true)
             {
+               CHAR buf[DB2_ENUM_STRING_BUFFER_SIZE];
                mValueString = db.MapEnumToString( id, 
                                                   (int)mValue.mU32, 
                                                   true,
-                                                  mField.mbHex );
+                                                  mField.mbHex,
+                                                  &buf[0],
+                                                  DB2_ENUM_STRING_BUFFER_SIZE );
             }
          }
       }
@@ -540,13 +548,16 @@ sParsedField::sParsedField(
             // Grab the enum ID
             ULONG id = pField->mTypeVal;
 
-            // Map to a string?
+            // Map to a string? (without building a temporary string)
             if (bGenStrings == true)
             {
+               CHAR buf[DB2_ENUM_STRING_BUFFER_SIZE];
                mValueString = db.MapEnumToString( id, 
                                                   (int)mValue.mS32, 
                                                   true,
-                                                  mField.mbHex );
+                                                  mField.mbHex,
+                                                  &buf[0],
+                                                  DB2_ENUM_STRING_BUFFER_SIZE );
             }
          }
       }
@@ -646,6 +657,11 @@ ULONG cParsedFieldNavigator::GetFieldIndex(
    ULONG                      fieldID,
    bool                       bLoop ) const 
 {
+   if (mbIndexed == true)
+   {
+      return GetIndexedFieldIndex( fieldID, bLoop );
+   }
+
    ULONG id = ULONG_MAX;
    ULONG count = (ULONG)mFields.size();
 
@@ -699,6 +715,98 @@ ULONG cParsedFieldNavigator::GetFieldIndex(
    return id;
 }
 
+/*===========================================================================
+METHOD:
+   BuildIndex (Internal Method)
+
+DESCRIPTION:
+   Build the table of field indices by field ID so that GetFieldIndex()
+   does not need to scan the field list
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cParsedFieldNavigator::BuildIndex()
+{
+   mIndex.clear();
+
+   ULONG count = (ULONG)mFields.size();
+   for (ULONG f = 0; f < count; f++)
+   {
+      mIndex[mFields[f].mField.mID].push_back( f );
+   }
+
+   mbIndexed = true;
+}
+
+/*===========================================================================
+METHOD:
+   GetIndexedFieldIndex (Internal Method)
+
+DESCRIPTION:
+   Get index of the (first) field that matches the given field ID using
+   the field index table, the search starts from the last success index
+   exactly as it does for GetFieldIndex()
+  
+PARAMETERS:
+   fieldID     [ I ] - Field ID to look for
+   bLoop       [ I ] - Loop around end of field list?
+
+RETURN VALUE:
+   ULONG - Index of the field (0xFFFFFFFF upon failure)
+===========================================================================*/
+ULONG cParsedFieldNavigator::GetIndexedFieldIndex(
+   ULONG                      fieldID,
+   bool                       bLoop ) const
+{
+   ULONG id = ULONG_MAX;
+   ULONG count = (ULONG)mFields.size();
+
+   // Start from last field ID?
+   ULONG fi = 0;
+   if (mLastIDIndex < count)
+   {
+      fi = mLastIDIndex;
+   }
+   else if (mLastIDIndex != ULONG_MAX && bLoop == false)
+   {
+      // Beyond end of fields with no looping
+      mLastIDIndex = id;
+      return id;
+   }
+
+   std::map <ULONG, std::vector <ULONG> >::const_iterator pIter;
+   pIter = mIndex.find( fieldID );
+   if (pIter != mIndex.end())
+   {
+      // First instance at or after the starting index
+      const std::vector <ULONG> & indices = pIter->second;
+      std::vector <ULONG>::const_iterator pIdx;
+      pIdx = std::lower_bound( indices.begin(), indices.end(), fi );
+      if (pIdx != indices.end())
+      {
+         id = *pIdx;
+      }
+      else if (bLoop == true)
+      {
+         id = indices.front();
+      }
+   }
+
+   // Update last ID accordingly (0xFFFFFFFF upon failure), and return
+   mLastIDIndex = id;
+   if (mLastIDIndex != ULONG_MAX)
+   {
+      mLastIDIndex++;
+      if (mLastIDIndex == count)
+      {
+         mLastIDIndex = 0;
+      }
+   }
+
+   return id;
+}
+
 /*=========================================================================*/
 // cDataParser Methods
 /*=========================================================================*/
@@ -729,7 +837,10 @@ cDataParser::cDataParser(
    :  cProtocolEntityNav( db ),    
       mBuffer( buffer.GetSharedBuffer() ),
       mbFieldStrings( true ),
-      mbParsed( false )
+      mbParsed( false ),
+      mpValues( 0 ),
+      mMaxValues( 0 ),
+      mNumValues( 0 )
 {
    // We must have a valid protocol buffer
    if (mBuffer.IsValid() == false)
@@ -743,35 +854,11 @@ cDataParser::cDataParser(
       return;
    }
 
-   // Key has to be proper
-   if (key.size() < 1)
-   {
-      return;
-   }
-
-   // Key needs to match protocol
-   eProtocolType pt = (eProtocolType)mBuffer.GetType();
-   eDB2EntityType et = (eDB2EntityType)key[0];
-
-   if (pt == ePROTOCOL_DIAG_RX || pt == ePROTOCOL_DIAG_TX)
-   {
-      if (IsDiagEntityType( et ) == false)
-      {
-         return;
-      }
-   }
-
-   else if (IsQMIProtocol( pt ) == true)
+   // Pass data to the bit parser
+   if (SetKey( key ) == true)
    {
-      if (IsQMIEntityType( et ) == false)
-      {
-         return;
-      }
+      mBitsy.SetData( pData, dataLen * BITS_PER_BYTE );
    }
-
-   // Pass data to the bit parser
-   mKey = key;
-   mBitsy.SetData( pData, dataLen * BITS_PER_BYTE );
 }
 
 /*===========================================================================
@@ -829,6 +916,159 @@ bool cDataParser::Parse(
 }
 
 
+/*===========================================================================
+METHOD:
+   ParseValues (Public Method)
+
+DESCRIPTION:
+   Parse the data to a caller supplied array of raw field values, no
+   field names or value strings are generated and nothing is added to
+   the list of parsed fields
+
+PARAMETERS:
+   pValues        [ O ] - Array to receive the raw field values
+   maxValues      [ I ] - Number of entries in the above array
+   numValues      [ O ] - Number of raw field values stored
+
+RETURN VALUE:
+   bool - false if the data could not be parsed or the array is too small
+===========================================================================*/
+bool cDataParser::ParseValues(
+   sParsedFieldValue *        pValues,
+   ULONG                      maxValues,
+   ULONG &                    numValues )
+{
+   // Assume failure
+   bool bRC = false;
+   numValues = 0;
+
+   if (pValues == 0 || maxValues == 0)
+   {
+      return bRC;
+   }
+
+   // Values only
+   mbFieldStrings = false;
+   mbFieldNames   = false;
+
+   mpValues = pValues;
+   mMaxValues = maxValues;
+   mNumValues = 0;
+
+   // Start from the beginning of the payload
+   mBitsy.SetOffset( 0 );
+   mBitsy.SetLSBMode( true );
+
+   bRC = ProcessEntity( mKey );
+   numValues = mNumValues;
+
+   mpValues = 0;
+   mMaxValues = 0;
+   mNumValues = 0;
+
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   GetParsedField (Public Method)
+
+DESCRIPTION:
+   Produce the parsed field corresponding to a raw field value returned
+   by ParseValues(), i.e. generate the value string (and string values)
+   on demand, the name is the (unqualified) field name
+
+PARAMETERS:
+   value          [ I ] - Raw field value
+   field          [ O ] - The parsed field
+   bFieldStrings  [ I ] - Generate string representation of field value?
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cDataParser::GetParsedField(
+   const sParsedFieldValue &  value,
+   sParsedField &             field,
+   bool                       bFieldStrings ) const
+{
+   // Re-parse the field from the payload
+   cBitParser bp( mBitsy );
+   bp.SetOffset( value.mOffset );
+   bp.SetLSBMode( value.mbLSB );
+
+   std::string name = "";
+   if (value.mField.mpName != 0)
+   {
+      name = value.mField.mpName;
+   }
+
+   field = sParsedField( mDB, &value.mField, name, bp, bFieldStrings );
+   if (field.IsString() == true)
+   {
+      // Point at our own copy of the string
+      field.mValue.mpAStr = (LPCSTR)field.mValueString.c_str();
+   }
+
+   return field.IsValid();
+}
+
+/*===========================================================================
+METHOD:
+   SetKey (Internal Method)
+
+DESCRIPTION:
+   Validate the protocol entity key against the protocol buffer and
+   store it
+
+PARAMETERS:
+   key         [ I ] - Protocol entity key
+  
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cDataParser::SetKey( const std::vector <ULONG> & key )
+{
+   // Assume failure
+   bool bRC = false;
+
+   // We must have a valid protocol buffer
+   if (mBuffer.IsValid() == false)
+   {
+      return bRC;
+   }
+
+   // Key has to be proper
+   if (key.size() < 1)
+   {
+      return bRC;
+   }
+
+   // Key needs to match protocol
+   eProtocolType pt = (eProtocolType)mBuffer.GetType();
+   eDB2EntityType et = (eDB2EntityType)key[0];
+
+   if (pt == ePROTOCOL_DIAG_RX || pt == ePROTOCOL_DIAG_TX)
+   {
+      if (IsDiagEntityType( et ) == false)
+      {
+         return bRC;
+      }
+   }
+
+   else if (IsQMIProtocol( pt ) == true)
+   {
+      if (IsQMIEntityType( et ) == false)
+      {
+         return bRC;
+      }
+   }
+
+   mKey = key;
+
+   bRC = true;
+   return bRC;
+}
+
 /*===========================================================================
 METHOD:
    GetLastValue (Internal Method)
@@ -853,11 +1093,10 @@ bool cDataParser::GetLastValue(
    bool bRC = false;
 
    // Use field value tracking information
-   std::map <ULONG, std::pair <bool, LONGLONG> >::iterator pTF;
-   pTF = mTrackedFields.find( fieldID );
-   if (pTF != mTrackedFields.end() && pTF->second.first == true)
+   const sPENavTrackedField * pTF = FindTrackedField( fieldID );
+   if (pTF != 0 && pTF->mbValid == true)
    {
-      val = pTF->second.second;
+      val = pTF->mValue;
       bRC = true;
    }
 
@@ -915,6 +1154,12 @@ bool cDataParser::ProcessField(
       return bRC;
    }
 
+   // Room for another raw value?
+   if (mpValues != 0 && mNumValues >= mMaxValues)
+   {
+      return bRC;
+   }
+
    // We must have a name
    sParsedField theField( mDB, 
                           pField, 
@@ -925,16 +1170,34 @@ bool cDataParser::ProcessField(
    // Did that result in a valid field?
    if (theField.IsValid() == true)
    {
-      // Add field 
-      mFields.push_back( theField );         
+      if (mpValues != 0)
+      {
+         // Store raw value only
+         sParsedFieldValue & val = mpValues[mNumValues++];
+         val.mField = *pField;
+         val.mOffset = theField.mOffset;
+         val.mSize = mBitsy.GetNumBitsParsed() - theField.mOffset;
+         val.mValue = theField.mValue;
+         val.mbLSB = mBitsy.GetLSBMode();
+
+         if (theField.IsString() == true)
+         {
+            val.mValue.mpAStr = 0;
+         }
+      }
+      else
+      {
+         // Add field 
+         mFields.push_back( theField );         
+      }
+
       bRC = true;
 
       // Are we tracking the value of this field?
-      std::map <ULONG, std::pair <bool, LONGLONG> >::iterator pTF;
-      pTF = mTrackedFields.find( pField->mID );
-      if (pTF != mTrackedFields.end())
+      sPENavTrackedField * pTF = FindTrackedField( pField->mID );
+      if (pTF != 0)
       {           
-         std::pair <bool, LONGLONG> & entry = pTF->second;
+         sPENavTrackedField & entry = *pTF;
 
          // What type is this field?
          switch (pField->mType)
@@ -950,8 +1213,8 @@ bool cDataParser::ProcessField(
                   case eDB2_FIELD_STDTYPE_UINT8:
                   {
                      // Treat as UCHAR
-                     entry.second = (LONGLONG)theField.mValue.mU8;
-                     entry.first = true;
+                     entry.mValue = (LONGLONG)theField.mValue.mU8;
+                     entry.mbValid = true;
                   }
                   break;
 
@@ -959,8 +1222,8 @@ bool cDataParser::ProcessField(
                   case eDB2_FIELD_STDTYPE_INT8:
                   {
                      // Treat as CHAR
-                     entry.second = (LONGLONG)theField.mValue.mS8;
-                     entry.first = true;
+                     entry.mValue = (LONGLONG)theField.mValue.mS8;
+                     entry.mbValid = true;
                   }
                   break;
 
@@ -968,8 +1231,8 @@ bool cDataParser::ProcessField(
                   case eDB2_FIELD_STDTYPE_INT16: 
                   {
                      // Treat as SHORT
-                     entry.second = (LONGLONG)theField.mValue.mS16;
-                     entry.first = true;
+                     entry.mValue = (LONGLONG)theField.mValue.mS16;
+                     entry.mbValid = true;
                   }
                   break;
 
@@ -977,8 +1240,8 @@ bool cDataParser::ProcessField(
                   case eDB2_FIELD_STDTYPE_UINT16:
                   {
                      // Treat as USHORT
-                     entry.second = (LONGLONG)theField.mValue.mU16;
-                     entry.first = true;
+                     entry.mValue = (LONGLONG)theField.mValue.mU16;
+                     entry.mbValid = true;
                   }
                   break;
 
@@ -986,8 +1249,8 @@ bool cDataParser::ProcessField(
                   case eDB2_FIELD_STDTYPE_INT32:
                   {
                      // Treat as LONG
-                     entry.second = (LONGLONG)theField.mValue.mS32;
-                     entry.first = true;
+                     entry.mValue = (LONGLONG)theField.mValue.mS32;
+                     entry.mbValid = true;
                   }
                   break;
 
@@ -995,8 +1258,8 @@ bool cDataParser::ProcessField(
                   case eDB2_FIELD_STDTYPE_UINT32:
                   {
                      // Treat as ULONG
-                     entry.second = (LONGLONG)theField.mValue.mU32;
-                     entry.first = true;
+                     entry.mValue = (LONGLONG)theField.mValue.mU32;
+                     entry.mbValid = true;
                   }
                   break;
 
@@ -1004,8 +1267,8 @@ bool cDataParser::ProcessField(
                   case eDB2_FIELD_STDTYPE_INT64:
                   {
                      // Treat as LONGLONG
-                     entry.second = (LONGLONG)theField.mValue.mS64;
-                     entry.first = true;
+                     entry.mValue = (LONGLONG)theField.mValue.mS64;
+                     entry.mbValid = true;
                   }
                   break;
 
@@ -1015,8 +1278,8 @@ bool cDataParser::ProcessField(
                      // Treat as ULONGLONG          
                      if (theField.mValue.mU64 <= LLONG_MAX)
                      {                     
-                        entry.second = (LONGLONG)theField.mValue.mU64;
-                        entry.first = true;
+                        entry.mValue = (LONGLONG)theField.mValue.mU64;
+                        entry.mbValid = true;
                      }
                   }
                   break;
@@ -1027,16 +1290,16 @@ bool cDataParser::ProcessField(
             case eDB2_FIELD_ENUM_UNSIGNED:
             {
                // Treat as ULONG
-               entry.second = (LONGLONG)theField.mValue.mU32;
-               entry.first = true;
+               entry.mValue = (LONGLONG)theField.mValue.mU32;
+               entry.mbValid = true;
             }
             break;
 
             case eDB2_FIELD_ENUM_SIGNED:
             {
                // Treat as LONG
-               entry.second = (LONGLONG)theField.mValue.mS32;
-               entry.first = true;
+               entry.mValue = (LONGLONG)theField.mValue.mS32;
+               entry.mbValid = true;
             }
             break;
          }
@@ -1116,3 +1379,340 @@ void cDataParser::HandleSpecialCases(
    }
 }
 
+/*=========================================================================*/
+// cIncrementalDataParser Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   cIncrementalDataParser (Public Method)
+
+DESCRIPTION:
+   Constructor (protocol buffer and entity key), the payload is then 
+   provided via Feed()
+
+PARAMETERS:
+   db             [ I ] - Database to use
+   buffer         [ I ] - The protocol buffer being parsed
+   key            [ I ] - Protocol entity key
+   bFieldStrings  [ I ] - Generate string representations of field values?
+   bFieldNames    [ I ] - Generate (partial) field names?
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+cIncrementalDataParser::cIncrementalDataParser( 
+   const cCoreDatabase &         db,
+   const sProtocolBuffer &       buffer,
+   const std::vector <ULONG> &   key,
+   bool                          bFieldStrings,
+   bool                          bFieldNames )
+   :  cDataParser( db, buffer, key, 0, 0 ),
+      mDataOffset( 0 ),
+      mSkipOffset( ULONG_MAX ),
+      mNextField( 0 ),
+      mbStarted( false ),
+      mbFinished( false ),
+      mbDiscarded( false ),
+      mbDone( false ),
+      mbResult( false )
+{
+   mbFieldStrings = bFieldStrings;
+   mbFieldNames   = bFieldNames;
+
+   if (SetKey( key ) == false)
+   {
+      // Nothing can be parsed
+      mbDone = true;
+   }
+}
+
+/*===========================================================================
+METHOD:
+   ~cIncrementalDataParser (Public Method)
+
+DESCRIPTION:
+   Destructor
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+cIncrementalDataParser::~cIncrementalDataParser()
+{
+   // The bit parser must not outlive our data
+   mBitsy.ReleaseData();
+}
+
+/*===========================================================================
+METHOD:
+   Feed (Public Method)
+
+DESCRIPTION:
+   Feed the next piece of the payload to the parser, any data that has 
+   already been parsed (or skipped) is discarded first
+
+PARAMETERS:
+   pData       [ I ] - Next piece of the payload
+   dataLen     [ I ] - Size of above piece
+  
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cIncrementalDataParser::Feed( 
+   const BYTE *               pData,
+   ULONG                      dataLen )
+{
+   // Assume failure
+   bool bRC = false;
+   if (pData == 0 || dataLen == 0)
+   {
+      return bRC;
+   }
+
+   if (mbFinished == true || mbDone == true)
+   {
+      return bRC;
+   }
+
+   // Discard whole bytes that precede the current offset
+   ULONG offset = GetOffset();
+   ULONG keep = offset / BITS_PER_BYTE;
+
+   ULONG discard = keep - mDataOffset;
+   if (discard > (ULONG)mData.size())
+   {
+      discard = (ULONG)mData.size();
+   }
+
+   mData.erase( mData.begin(), mData.begin() + discard );
+   mDataOffset += discard;
+
+   // Navigation skipped past the data held?  Discard that part too
+   if (mData.size() == 0 && keep > mDataOffset)
+   {
+      ULONG skip = keep - mDataOffset;
+      if (skip > dataLen)
+      {
+         skip = dataLen;
+      }
+
+      pData += skip;
+      dataLen -= skip;
+      mDataOffset += skip;
+   }
+
+   mData.insert( mData.end(), pData, pData + dataLen );
+
+   // The bit parser keeps its navigation order, re-establish the offset
+   if (mData.size() > 0)
+   {
+      mBitsy.SetData( &mData[0], (ULONG)mData.size() * BITS_PER_BYTE );
+   }
+   else
+   {
+      mBitsy.ReleaseData();
+   }
+
+   bRC = SetOffset( offset );
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   NextField (Public Method)
+
+DESCRIPTION:
+   Return the next parsed field, navigation is started (or resumed) once
+   the previously parsed fields have all been returned
+
+PARAMETERS:
+   field       [ O ] - The parsed field
+  
+RETURN VALUE:
+   eIncrementalParse
+===========================================================================*/
+eIncrementalParse cIncrementalDataParser::NextField( sParsedField & field )
+{
+   if (mNextField >= (ULONG)mFields.size() && mbDone == false)
+   {
+      // Previous fields have been returned, parse some more
+      mFields.clear();
+      mNextField = 0;
+
+      bool bRC = false;
+      if (mbStarted == false)
+      {
+         if (mData.size() == 0 && mbFinished == false)
+         {
+            return eINCREMENTAL_PARSE_NEED_DATA;
+         }
+
+         mbStarted = true;
+         bRC = ProcessEntity( mKey );
+      }
+      else
+      {
+         bRC = ResumeProgram();
+      }
+
+      if (mbSuspended == false)
+      {
+         mbDone = true;
+         mbResult = bRC;
+      }
+   }
+
+   if (mNextField < (ULONG)mFields.size())
+   {
+      field = mFields[mNextField++];
+      if (field.IsString() == true)
+      {
+         // Point at our own copy of the string
+         field.mValue.mpAStr = (LPCSTR)field.mValueString.c_str();
+      }
+
+      return eINCREMENTAL_PARSE_FIELD;
+   }
+
+   if (mbDone == false)
+   {
+      return eINCREMENTAL_PARSE_NEED_DATA;
+   }
+
+   if (mbResult == false)
+   {
+      return eINCREMENTAL_PARSE_ERROR;
+   }
+
+   return eINCREMENTAL_PARSE_DONE;
+}
+
+/*===========================================================================
+METHOD:
+   ProcessField (Internal Method)
+
+DESCRIPTION:
+   Process the given field by parsing the value, if the field cannot be
+   parsed before the entire payload has been fed then navigation is 
+   suspended (the field is retried when navigation is resumed)
+
+PARAMETERS:
+   pField      [ I ] - The field being processed
+   fieldName   [ I ] - Field name (partial)
+   arrayIndex  [ I ] - Array index (-1 = not an array)
+  
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cIncrementalDataParser::ProcessField(
+   const sDB2Field *          pField,
+   const std::string &        fieldName,
+   LONGLONG                   arrayIndex )
+{
+   // Assume failure
+   bool bRC = false;
+
+   // Navigation went back into data that has been discarded?
+   if (mbDiscarded == true)
+   {
+      return bRC;
+   }
+
+   // Still skipping data that has not been fed?
+   if (mSkipOffset != ULONG_MAX)
+   {
+      mbSuspended = (mbFinished == false);
+      return bRC;
+   }
+
+   ULONG offset = mBitsy.GetNumBitsParsed();
+   bRC = cDataParser::ProcessField( pField, fieldName, arrayIndex );
+
+   // A string that runs to the end of the data fed may be incomplete
+   // (NULL terminated strings are ended by running out of data)
+   if ( (bRC == true)
+   &&   (mbFinished == false)
+   &&   (mFields.back().IsString() == true)
+   &&   (mBitsy.GetNumBitsLeft() == 0) )
+   {
+      mFields.pop_back();
+      bRC = false;
+   }
+
+   if (bRC == true)
+   {
+      // Field offset is from the start of the payload
+      mFields.back().mOffset += mDataOffset * BITS_PER_BYTE;
+   }
+   else if (mbFinished == false)
+   {
+      // Assume the field is incomplete, try again with more data
+      mBitsy.SetOffset( offset );
+      mbSuspended = true;
+   }
+
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   GetOffset (Internal Method)
+
+DESCRIPTION:
+   Get current working offset (from start of payload)
+  
+RETURN VALUE:
+   ULONG
+===========================================================================*/
+ULONG cIncrementalDataParser::GetOffset()
+{
+   if (mSkipOffset != ULONG_MAX)
+   {
+      return mSkipOffset;
+   }
+
+   return mDataOffset * BITS_PER_BYTE + mBitsy.GetNumBitsParsed();
+}
+
+/*===========================================================================
+METHOD:
+   SetOffset (Internal Method)
+
+DESCRIPTION:
+   Set current working offset (from start of payload), an offset beyond 
+   the data fed so far is reached once enough data has been fed
+
+PARAMETERS:
+   offset      [ I ] - New offset
+  
+RETURN VALUE:
+   bool - false if the offset refers to data that has been discarded
+===========================================================================*/
+bool cIncrementalDataParser::SetOffset( ULONG offset )
+{
+   // Assume failure
+   bool bRC = false;
+
+   ULONG base = mDataOffset * BITS_PER_BYTE;
+   if (offset < base)
+   {
+      // Fail the next field processed
+      mbDiscarded = true;
+      return bRC;
+   }
+
+   ULONG relOffset = offset - base;
+   ULONG maxOffset = (ULONG)mData.size() * BITS_PER_BYTE;
+
+   mSkipOffset = ULONG_MAX;
+   if (relOffset > maxOffset)
+   {
+      mSkipOffset = offset;
+      relOffset = maxOffset;
+   }
+
+   mBitsy.SetOffset( relOffset );
+
+   bRC = true;
+   return bRC;
+}
@@ -10,11 +10,19 @@ PUBLIC CLASSES AND METHODS:
       Structure to represent a single parsed field (field ID, offset,
       size, value, name, etc.)
 
+   sParsedFieldValue
+      Structure to represent the raw value of a single parsed field
+      (field definition, offset, size, value), no names or strings
+
    cDataParser
       Class to parse a buffer into bit/byte specified fields accordinging
       to a database description, uses cProtocolEntityNav to navigate the DB
       definition
 
+   cIncrementalDataParser
+      Class to parse a payload that is fed to it in pieces, fields are
+      produced as soon as the data they depend on is available
+
 Copyright (c) 2011, Code Aurora Forum. All rights reserved.
 
 Redistribution and use in source and binary forms, with or without
@@ -226,6 +234,41 @@ struct sParsedField
       bool mbValid;
 };
 
+/*=========================================================================*/
+// Struct sParsedFieldValue
+//
+//    Structure to represent the raw value of a parsed field, as produced
+//    by cDataParser::ParseValues() into a caller supplied array
+/*=========================================================================*/
+struct sParsedFieldValue
+{
+   public:
+      // (Inline) Constructor - default
+      sParsedFieldValue()
+         :  mField(),
+            mOffset( 0 ),
+            mSize( 0 ),
+            mbLSB( true )
+      { 
+         memset( (PVOID)&mValue, 0, sizeof( mValue ) );
+      };
+
+      /* Field definition */
+      sDB2Field mField;
+
+      /* Bit offset (from start of payload) */ 
+      ULONG mOffset;
+
+      /* Number of bits parsed */
+      ULONG mSize;
+
+      /* Field value (string fields are not stored, mpAStr is 0) */
+      uFields mValue;
+
+      /* Parsed LSB -> MSB? */
+      bool mbLSB;
+};
+
 /*=========================================================================*/
 // Class cParsedFieldNavigator
 //
@@ -234,11 +277,20 @@ struct sParsedField
 class cParsedFieldNavigator
 {
    public:
-      // (Inline) Constructor
-      cParsedFieldNavigator( const std::vector <sParsedField> & pf )
+      // (Inline) Constructor, optionally index the fields by ID (the
+      // index reflects the fields at the time of construction)
+      cParsedFieldNavigator( 
+         const std::vector <sParsedField> &  pf,
+         bool                                bIndex = false )
          :  mFields( pf ),
-            mLastIDIndex( ULONG_MAX )
-      { };
+            mLastIDIndex( ULONG_MAX ),
+            mbIndexed( false )
+      { 
+         if (bIndex == true)
+         {
+            BuildIndex();
+         }
+      };
 
       // Get index of the (first) field that matches the field ID,
       // the search starts from the last success index returned by
@@ -259,11 +311,26 @@ class cParsedFieldNavigator
       };
 
    protected:
+      // Build the field ID to field indices table
+      void BuildIndex();
+
+      // Get index of the (first) field that matches the field ID
+      // using the above table
+      ULONG GetIndexedFieldIndex(
+         ULONG                      fieldID,
+         bool                       bLoop ) const;
+
       /* The list of parsed fields */
       const std::vector <sParsedField> & mFields;
 
       /* Index of last field we matched */
       mutable ULONG mLastIDIndex;
+
+      /* Indices (ascending) of the fields with each field ID */
+      std::map <ULONG, std::vector <ULONG> > mIndex;
+
+      /* Has the above table been built? */
+      bool mbIndexed;
 };
 
 /*=========================================================================*/
@@ -294,6 +361,18 @@ class cDataParser : public cProtocolEntityNav
          bool                       bFieldStrings = true,
          bool                       bFieldNames = true );
 
+      // Parse the data to a caller supplied array of raw field values
+      virtual bool ParseValues(
+         sParsedFieldValue *        pValues,
+         ULONG                      maxValues,
+         ULONG &                    numValues );
+
+      // Produce the parsed field corresponding to a raw field value
+      bool GetParsedField(
+         const sParsedFieldValue &  value,
+         sParsedField &             field,
+         bool                       bFieldStrings = true ) const;
+
       // (Inline) Get the protocol entity name
       std::string GetEntityName() const
       {
@@ -313,7 +392,17 @@ class cDataParser : public cProtocolEntityNav
          return mFields;
       };
 
+      // (Inline) Move the parsed fields out of the parser
+      void TakeFields( tParsedFields & fields )
+      {
+         fields.swap( mFields );
+         mFields.clear();
+      };
+
    protected:
+      // Validate and store the protocol entity key
+      bool SetKey( const std::vector <ULONG> & key );
+
       // Working from the back of the current field list find
       // and return the value for the specified field ID as a
       // LONGLONG (field type must be able to fit)
@@ -393,7 +482,108 @@ class cDataParser : public cProtocolEntityNav
       /* Did we successfully parse the buffer? */
       bool mbParsed;
 
+      /* Caller supplied raw field value array (ParseValues() only) */
+      sParsedFieldValue * mpValues;
+
+      /* Size of the above array, and number of values stored */
+      ULONG mMaxValues;
+      ULONG mNumValues;
+
       /* Parsed field vector index of last instance of each field (by ID) */
       std::map <ULONG, ULONG> mFieldIndices;
 };
 
+/*=========================================================================*/
+// Enum eIncrementalParse
+//
+//    Result of cIncrementalDataParser::NextField()
+/*=========================================================================*/
+enum eIncrementalParse
+{
+   eINCREMENTAL_PARSE_FIELD,        // A field was returned
+   eINCREMENTAL_PARSE_NEED_DATA,    // More of the payload must be fed
+   eINCREMENTAL_PARSE_DONE,         // The entire payload has been parsed
+   eINCREMENTAL_PARSE_ERROR         // The payload could not be parsed
+};
+
+/*=========================================================================*/
+// Class cIncrementalDataParser
+//    Class to parse a payload that is fed to it in pieces, navigation is
+//    suspended when a field needs data that has not been fed yet and is
+//    resumed once it has, parsed data (and returned fields) are discarded
+//    so only the unparsed part of the payload is held
+//
+//    NOTE: Parse()/ParseValues() are not to be used with this class, and 
+//    fragment offsets that point back into parsed data are not supported
+/*=========================================================================*/
+class cIncrementalDataParser : public cDataParser
+{
+   public:
+      // Constructor (protocol buffer and entity key)
+      cIncrementalDataParser( 
+         const cCoreDatabase &         db,
+         const sProtocolBuffer &       buffer,
+         const std::vector <ULONG> &   key,
+         bool                          bFieldStrings = true,
+         bool                          bFieldNames = true );
+
+      // Destructor
+      virtual ~cIncrementalDataParser();
+
+      // Feed the next piece of the payload to the parser
+      bool Feed( 
+         const BYTE *               pData,
+         ULONG                      dataLen );
+
+      // (Inline) Indicate that the entire payload has been fed
+      void Finish()
+      {
+         mbFinished = true;
+      };
+
+      // Return the next parsed field
+      eIncrementalParse NextField( sParsedField & field );
+
+      // (Inline) Get the number of payload bytes currently held
+      ULONG GetDataSize() const
+      {
+         return (ULONG)mData.size();
+      };
+
+   protected:
+      // Process the given field 
+      virtual bool ProcessField(
+         const sDB2Field *          pField,
+         const std::string &        fieldName,
+         LONGLONG                   arrayIndex = -1 );
+
+      // Get current working offset (from start of payload)
+      virtual ULONG GetOffset();
+
+      // Set current working offset (from start of payload)
+      virtual bool SetOffset( ULONG offset );
+
+      /* Payload data that has not been parsed yet */
+      std::vector <BYTE> mData;
+
+      /* Payload offset (in bytes) of the above data */
+      ULONG mDataOffset;
+
+      /* Offset (in bits) beyond the data fed so far that navigation
+         has skipped to (ULONG_MAX = none) */
+      ULONG mSkipOffset;
+
+      /* Index of the next parsed field to return */
+      ULONG mNextField;
+
+      /* Has navigation been started/has the entire payload been fed? */
+      bool mbStarted;
+      bool mbFinished;
+
+      /* Did navigation refer back to data that has been discarded? */
+      bool mbDiscarded;
+
+      /* Final result of navigation (valid once mbDone is set) */
+      bool mbDone;
+      bool mbResult;
+};
@@ -8,7 +8,7 @@ DESCRIPTION:
 PUBLIC CLASSES AND METHODS:
    WaitOnMultipleEvents
    cEvent
-      Functionality to mimic Windows events using UNIX pipes (enhanced
+      Functionality to mimic Windows events using a Linux eventfd (enhanced
       somewhat to allow one to specify a DWORD value to pass through
       when signalling the event)
 
@@ -49,11 +49,46 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "StdAfx.h"
 #include "Event.h"
 
+#include <poll.h>
+#include <stdint.h>
+#include <sys/eventfd.h>
+
 //---------------------------------------------------------------------------
 // Definitions
 //---------------------------------------------------------------------------
-const DWORD READING = 0;
-const DWORD WRITING = 1;
+
+// Find the milliseconds remaining until the given CLOCK_MONOTONIC deadline
+static DWORD TimeRemaining( const timespec & deadline )
+{
+   timespec now;
+   if (clock_gettime( CLOCK_MONOTONIC, &now ) != 0)
+   {
+      return 0;
+   }
+
+   if ( (now.tv_sec > deadline.tv_sec)
+   ||   ( (now.tv_sec == deadline.tv_sec)
+        &&(now.tv_nsec >= deadline.tv_nsec) ) )
+   {
+      return 0;
+   }
+
+   LONGLONG remaining = (deadline.tv_sec - now.tv_sec) * 1000LL;
+   remaining += (deadline.tv_nsec - now.tv_nsec) / 1000000LL;
+
+   return (DWORD)remaining;
+}
+
+// Convert a relative timeout in milliseconds to a poll() timeout
+static int PollTimeout( DWORD timeoutMS )
+{
+   if (timeoutMS > (DWORD)INT_MAX)
+   {
+      return INT_MAX;
+   }
+
+   return (int)timeoutMS;
+}
 
 /*===========================================================================
 METHOD:
@@ -66,6 +101,9 @@ DESCRIPTION:
       eventIndex will be read from.  Run this function again
       to get the next event.
 
+   Note: poll() is used rather than select() so the number (and value)
+      of the descriptors is not limited by FD_SETSIZE
+
 PARAMETERS:
    events      [ I ] - Vector of events which may be signaled
    timeoutMS   [ I ] - Relative timeout length (in milliseconds)
@@ -84,7 +122,7 @@ int WaitOnMultipleEvents(
    DWORD &                       val,
    DWORD &                       eventIndex )
 {
-   // Check internal pipes' status
+   // Check internal eventfds' status
    for (int index = 0; index < events.size(); index++)
    {
       int error = events[index]->mError;
@@ -95,73 +133,88 @@ int WaitOnMultipleEvents(
       }
    }
 
-   // Initialize the FD set
-   fd_set fds;
-   FD_ZERO( &fds );
-
-   // Add each item to the FD set, keeping track of the largest,
-   // which is used for select()
-   int largestFD = 0;
+   // Build the poll set
+   std::vector <pollfd> fds( events.size() );
    for (int index = 0; index < events.size(); index++)
    {
-      int pipe = events[index]->mPipes[READING];
-      FD_SET( pipe, &fds );
-
-      largestFD = std::max( pipe, largestFD );
+      fds[index].fd = events[index]->mEventFD;
+      fds[index].events = POLLIN;
+      fds[index].revents = 0;
    }
-   
-   struct timeval timeOut;
 
-   // Add avoiding an overflow on (long)usec
-   timeOut.tv_sec = timeoutMS / 1000l;
-   timeOut.tv_usec = ( timeoutMS % 1000l ) * 1000l;
-
-   // Wait for activity on the pipes for the specified amount of time
-   int rc = select( largestFD + 1, &fds, 0, 0, &timeOut );
-   if (rc == -1)
+   // Absolute deadline (another waiter may consume a signal we woke for)
+   timespec deadline;
+   clock_gettime( CLOCK_MONOTONIC, &deadline );
+   deadline.tv_sec += timeoutMS / 1000l;
+   deadline.tv_nsec += ( timeoutMS % 1000l ) * 1000000l;
+   if (deadline.tv_nsec >= 1000000000l)
    {
-      TRACE( "WaitOnMultipleEvents error %d\n", errno );
-      return -errno;
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000000000l;
    }
-   else if (rc == 0)
+
+   DWORD remaining = timeoutMS;
+   while (true)
    {
-      // No activity on the pipes
-      return -ETIME;
-   }
+      // Wait for activity on the eventfds for the specified amount of time
+      int rc = poll( &fds[0], fds.size(), PollTimeout( remaining ) );
+      if (rc == -1)
+      {
+         if (errno == EINTR)
+         {
+            remaining = TimeRemaining( deadline );
+            continue;
+         }
 
-   int numSignaled = rc;
+         TRACE( "WaitOnMultipleEvents error %d\n", errno );
+         return -errno;
+      }
+      else if (rc == 0)
+      {
+         // No activity on the eventfds
+         return -ETIME;
+      }
 
-   // Only read from first pipe which was signaled
-   int signaled = -1;
-   for (int index = 0; index < events.size(); index++)
-   {
-      int pipe = events[index]->mPipes[READING];
-      if (FD_ISSET( pipe, &fds ) != 0)
+      int numSignaled = rc;
+
+      // Only read from first eventfd which was signaled
+      int signaled = -1;
+      for (int index = 0; index < events.size(); index++)
+      {
+         if ((fds[index].revents & POLLIN) != 0)
+         {
+            signaled = index;
+            break;
+         }
+      }
+
+      if (signaled == -1)
       {
-         signaled = index;
-         break;
+         // Odd, no one was signaled
+         return -ENODATA;
       }
-   }
 
-   if (signaled == -1)
-   {
-      // Odd, no one was signaled
-      return -ENODATA;
-   }
+      DWORD tempVal = 0;
+      rc = events[signaled]->Read( tempVal );
+      if (rc == 0)
+      {
+         // Success
+         val = tempVal;
+         eventIndex = signaled;
+         return numSignaled;
+      }
+      else if (rc != EAGAIN)
+      {
+         // failure
+         return -rc;
+      }
 
-   DWORD tempVal = 0;
-   rc = events[signaled]->Read( tempVal );
-   if (rc == 0)
-   {
-      // Success
-      val = tempVal;
-      eventIndex = signaled;
-      return numSignaled;
-   }
-   else
-   {
-      // failure
-      return rc;
+      // Signal was consumed by another waiter, keep waiting
+      remaining = TimeRemaining( deadline );
+      if (remaining == 0)
+      {
+         return -ETIME;
+      }
    }
 }
 
@@ -180,13 +233,18 @@ RETURN VALUE:
    None
 ===========================================================================*/
 cEvent::cEvent()
-   :   mError( 0 )
+   :   mError( 0 ),
+       mEventFD( -1 ),
+       mValues()
 {
-   int rc = pipe( mPipes );
-   if (rc != 0)
+   pthread_mutex_init( &mValuesMutex, NULL );
+
+   // Semaphore mode, each read consumes exactly one signal
+   mEventFD = eventfd( 0, EFD_SEMAPHORE | EFD_NONBLOCK );
+   if (mEventFD == -1)
    {
       mError = errno;
-      TRACE( "cEvent - Error %d creating pipe, %s\n", 
+      TRACE( "cEvent - Error %d creating eventfd, %s\n", 
              mError, 
              strerror( mError ) );
    }
@@ -204,12 +262,14 @@ RETURN VALUE:
 ===========================================================================*/
 cEvent::~cEvent()
 {
-   // Check internal pipe status
+   // Check internal eventfd status
    if (mError == 0)
    {
       Close();
       mError = EBADF;
    }
+
+   pthread_mutex_destroy( &mValuesMutex );
 }
 
 /*===========================================================================
@@ -217,7 +277,7 @@ METHOD:
    Close (Internal Method)
    
 DESCRIPTION:
-   Close pipe
+   Close eventfd
 
 RETURN VALUE:
    Return code
@@ -227,25 +287,18 @@ RETURN VALUE:
 int cEvent::Close()
 {
    int retCode = 0;
-
-   int rc = close( mPipes[READING] );
-   mPipes[READING] = -1;
-
-   if (rc != 0)
+   if (mEventFD == -1)
    {
-      retCode = errno;
-      TRACE( "cEvent - Error %d deleting pipe[READING], %s\n", 
-             retCode, 
-             strerror( retCode ) );
+      return retCode;
    }
 
-   rc = close( mPipes[WRITING] );
-   mPipes[WRITING] = -1;
+   int rc = close( mEventFD );
+   mEventFD = -1;
 
    if (rc != 0)
    {
       retCode = errno;
-      TRACE( "cEvent - Error %d deleting pipe[WRITING], %s\n", 
+      TRACE( "cEvent - Error %d closing eventfd, %s\n", 
              retCode, 
              strerror( retCode ) );
    }
@@ -270,38 +323,35 @@ RETURN VALUE:
 ===========================================================================*/
 int cEvent::Set( DWORD val )
 {
-   // Check internal pipe status
+   // Check internal eventfd status
    if (mError != 0)
    {
       return mError;
    }
 
-   PBYTE pWrite = (PBYTE)&val;
+   // Queue the value before signalling so a woken reader always finds it
+   pthread_mutex_lock( &mValuesMutex );
+   mValues.push_back( val );
+   pthread_mutex_unlock( &mValuesMutex );
 
-   int writeSize = sizeof( DWORD );
-   while (writeSize > 0)
+   uint64_t count = 1;
+   int bytesWritten = write( mEventFD, &count, sizeof( count ) );
+   if (bytesWritten != sizeof( count ))
    {
-      int bytesWritten = write( mPipes[WRITING], pWrite, writeSize );
-      if (bytesWritten == -1)
-      {
-         // Store error from write
-         int writeErr = errno;
+      // Store error from write
+      int writeErr = (bytesWritten == -1 ? errno : EIO);
 
-         // First error?
-         if (mError == 0)
-         {
-            // Yes, save the error
-            mError = writeErr;
-         }
-
-         // We cannot recover from this error
-         Close();
-         return writeErr;
+      // First error?
+      if (mError == 0)
+      {
+         // Yes, save the error
+         mError = writeErr;
       }
-      
-      pWrite += bytesWritten;
-      writeSize -= bytesWritten;
-   }      
+
+      // We cannot recover from this error
+      Close();
+      return writeErr;
+   }
 
    // Success
    return 0;
@@ -328,47 +378,83 @@ int cEvent::Wait(
    DWORD                      timeoutMS, 
    DWORD &                    val )
 {
-   // Check internal pipe status
+   // Check internal eventfd status
    if (mError != 0)
    {
       return mError;
    }
 
-   fd_set fds;
-   FD_ZERO( &fds );
-   FD_SET( mPipes[READING], &fds );
-   
-   struct timeval timeOut;
+   // Already signalled?  (saves the poll() call)
+   int rc = Read( val );
+   if (rc != EAGAIN)
+   {
+      return rc;
+   }
 
-   // Add avoiding an overflow on (long)usec
-   timeOut.tv_sec = timeoutMS / 1000l;
-   timeOut.tv_usec = ( timeoutMS % 1000l ) * 1000l;
+   if (timeoutMS == 0)
+   {
+      return ETIME;
+   }
 
-   // Wait for activity on the pipe for the specified amount of time
-   int rc = select( mPipes[READING] + 1, &fds, 0, 0, &timeOut );
-   if (rc == -1)
+   // Absolute deadline (another waiter may consume a signal we woke for)
+   timespec deadline;
+   clock_gettime( CLOCK_MONOTONIC, &deadline );
+   deadline.tv_sec += timeoutMS / 1000l;
+   deadline.tv_nsec += ( timeoutMS % 1000l ) * 1000000l;
+   if (deadline.tv_nsec >= 1000000000l)
    {
-      // Store error from select
-      int selectErr = errno;
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000000000l;
+   }
 
-      // First error?
-      if (mError == 0)
+   DWORD remaining = timeoutMS;
+   while (true)
+   {
+      pollfd fd;
+      fd.fd = mEventFD;
+      fd.events = POLLIN;
+      fd.revents = 0;
+
+      // Wait for activity on the eventfd for the specified amount of time
+      rc = poll( &fd, 1, PollTimeout( remaining ) );
+      if (rc == -1 && errno != EINTR)
       {
-         // Yes, save the error
-         mError = selectErr;
+         // Store error from poll
+         int pollErr = errno;
+
+         // First error?
+         if (mError == 0)
+         {
+            // Yes, save the error
+            mError = pollErr;
+         }
+
+         // We cannot recover from this error
+         Close();
+         return pollErr;
+      }
+      else if (rc == 0)
+      {
+         // No activity on the eventfd
+         return ETIME;
       }
 
-      // We cannot recover from this error
-      Close();
-      return selectErr;
-   }
-   else if (rc == 0)
-   {
-      // No activity on the pipe
-      return ETIME;
-   }
+      if (rc > 0)
+      {
+         rc = Read( val );
+         if (rc != EAGAIN)
+         {
+            return rc;
+         }
+      }
 
-   return Read( val );
+      // Interrupted, or signal was consumed by another waiter
+      remaining = TimeRemaining( deadline );
+      if (remaining == 0)
+      {
+         return ETIME;
+      }
+   }
 }
 
 /*===========================================================================
@@ -376,7 +462,7 @@ METHOD:
    Clear (Free Method)
    
 DESCRIPTION:
-   Read and discard all values currently in the pipe
+   Read and discard all values currently queued
 ===========================================================================*/
 void cEvent::Clear()
 {
@@ -394,50 +480,53 @@ METHOD:
    Read (Internal Method)
    
 DESCRIPTION:
-   Read a DWORD from the pipe
+   Consume one signal from the eventfd (without blocking) and return the
+   value that was passed through with it
 
 RETURN VALUE:
    Return code
       0 on success
+      EAGAIN if the event is not signalled
       errno value on failure
 ===========================================================================*/
 int cEvent::Read( DWORD & val )
 {
-   DWORD tempVal;
-   PBYTE pRead = (PBYTE)&tempVal;
-
-   int readSize = sizeof( DWORD );
-   while (readSize > 0)
+   uint64_t count = 0;
+   int bytesRead = read( mEventFD, &count, sizeof( count ) );
+   if (bytesRead != sizeof( count ))
    {
-      int bytesRead = read( mPipes[READING], pRead, readSize );
-      if (bytesRead <= 0)
+      // Store error from read
+      int readErr = (bytesRead == -1 ? errno : EIO);
+      if (readErr == EAGAIN || readErr == EINTR)
       {
-         // Store error from read
-         int readErr = errno;
-         if (readErr == 0)
-         {
-            // Hard error! This should NEVER happen for a pipe
-            ASSERT( 0 );
-            readErr = EBADF;
-         }
-
-         // First error?
-         if (mError == 0)
-         {
-            // Yes, store the error
-            mError = readErr;
-         }
+         // Not signalled (yet)
+         return EAGAIN;
+      }
 
-         // We cannot recover from this error
-         Close();
-         return readErr;
+      // First error?
+      if (mError == 0)
+      {
+         // Yes, store the error
+         mError = readErr;
       }
-      
-      pRead += bytesRead;
-      readSize -= bytesRead;
+
+      // We cannot recover from this error
+      Close();
+      return readErr;
+   }
+
+   // Each signal has exactly one queued value
+   DWORD tempVal = 0;
+
+   pthread_mutex_lock( &mValuesMutex );
+   if (mValues.empty() == false)
+   {
+      tempVal = mValues.front();
+      mValues.pop_front();
    }
+   pthread_mutex_unlock( &mValuesMutex );
 
    val = tempVal;
    
    return 0;
-}
\ No newline at end of file
+}
@@ -8,7 +8,7 @@ DESCRIPTION:
 PUBLIC CLASSES AND METHODS:
    WaitOnMultipleEvents
    cEvent
-      Functionality to mimic Windows events using UNIX pipes (enhanced
+      Functionality to mimic Windows events using a Linux eventfd (enhanced
       somewhat to allow one to specify a DWORD value to pass through
       when signalling the event)
 
@@ -53,6 +53,8 @@ POSSIBILITY OF SUCH DAMAGE.
 //---------------------------------------------------------------------------
 #include "StdAfx.h"
 #include <vector>
+#include <deque>
+#include <pthread.h>
 
 //---------------------------------------------------------------------------
 // Prototype
@@ -91,21 +93,27 @@ class cEvent
          DWORD                      timeoutMS, 
          DWORD &                    val );
 
-      // Read and discard all values currently in the pipe
+      // Read and discard all values currently queued
       void Clear();
 
    protected:
-      // Close pipe (used in errors or normal exit)
+      // Close eventfd (used in errors or normal exit)
       int Close();
 
-      // Read from the pipe
+      // Read a signalled value (without blocking)
       int Read( DWORD & val );
 
       /* Internal error status */
       int mError;
       
-      /*  Internal pipes */
-      int mPipes[2];
+      /* Internal eventfd (semaphore mode, one count per queued value) */
+      int mEventFD;
+
+      /* Values passed through with each signal, oldest first */
+      std::deque <DWORD> mValues;
+
+      /* Mutex protecting mValues */
+      pthread_mutex_t mValuesMutex;
 
       // WaitOnMultipleEvents gets full access
       friend int WaitOnMultipleEvents(
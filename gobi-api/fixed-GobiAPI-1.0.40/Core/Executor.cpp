@@ -0,0 +1,271 @@
+/*===========================================================================
+FILE:
+   Executor.cpp
+
+DESCRIPTION:
+   Implementation of cThreadExecutor class
+
+PUBLIC CLASSES AND METHODS:
+   cThreadExecutor
+      This class runs tasks, in the order they were submitted, on a single
+      worker thread
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "StdAfx.h"
+#include "Executor.h"
+
+/*=========================================================================*/
+// Free Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   ExecutorThread (Free Method)
+   
+DESCRIPTION:
+   Run queued tasks until told to exit (and the queue has been drained)
+
+PARAMETERS:
+   pArg        [ I ] - The executor object
+
+RETURN VALUE:
+   void * - thread exit value (always NULL)
+===========================================================================*/
+void * ExecutorThread( PVOID pArg )
+{
+   cThreadExecutor * pExecutor = (cThreadExecutor *)pArg;
+   if (pExecutor == 0)
+   {
+      TRACE( "ExecutorThread started with empty pArg\n" );
+      
+      ASSERT( 0 );
+      return NULL;
+   }
+
+   TRACE( "Executor thread [%lu] started\n", 
+          pthread_self() );
+
+   pthread_mutex_lock( &pExecutor->mMutex );
+   while (true)
+   {
+      if (pExecutor->mTasks.size() == 0)
+      {
+         if (pExecutor->mbExiting == true)
+         {
+            break;
+         }
+
+         pthread_cond_wait( &pExecutor->mTaskReady, &pExecutor->mMutex );
+         continue;
+      }
+
+      cExecutorTask * pTask = pExecutor->mTasks.front();
+      pExecutor->mTasks.pop_front();
+
+      // Run the task without holding the mutex (it may queue more tasks)
+      pthread_mutex_unlock( &pExecutor->mMutex );
+
+      if (pTask != 0)
+      {
+         pTask->Run();
+         delete pTask;
+      }
+
+      pthread_mutex_lock( &pExecutor->mMutex );
+   }
+
+   pthread_mutex_unlock( &pExecutor->mMutex );
+
+   TRACE( "Executor thread [%lu] exited\n", 
+          pthread_self() );
+
+   return NULL;
+}
+
+/*=========================================================================*/
+// cThreadExecutor Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   cThreadExecutor (Public Method)
+
+DESCRIPTION:
+   Constructor
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+cThreadExecutor::cThreadExecutor()
+   :  mThreadID( 0 ),
+      mbExiting( false ),
+      mTasks()
+{
+   pthread_mutex_init( &mMutex, NULL );
+   pthread_cond_init( &mTaskReady, NULL );
+}
+
+/*===========================================================================
+METHOD:
+   ~cThreadExecutor (Public Method)
+
+DESCRIPTION:
+   Destructor
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+cThreadExecutor::~cThreadExecutor()
+{
+   // This should have already been called, but ...
+   Exit();
+
+   pthread_cond_destroy( &mTaskReady );
+   pthread_mutex_destroy( &mMutex );
+}
+
+/*===========================================================================
+METHOD:
+   Initialize (Public Method)
+
+DESCRIPTION:
+   Start the worker thread
+  
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cThreadExecutor::Initialize()
+{
+   if (mThreadID != 0)
+   {
+      // Already running
+      return true;
+   }
+
+   mbExiting = false;
+   int nRet = mThreadConfig.CreateThread( eTHREAD_ROLE_WORKER,
+                                          &mThreadID,
+                                          ExecutorThread,
+                                          this );
+   if (nRet != 0)
+   {
+      TRACE( "Unable to start ExecutorThread. Error %d: %s\n",
+             nRet,
+             strerror( nRet ) );
+
+      mThreadID = 0;
+      return false;
+   }
+
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   Exit (Public Method)
+
+DESCRIPTION:
+   Run any queued tasks and then exit the worker thread, this must not be
+   called from a task
+  
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cThreadExecutor::Exit()
+{
+   if (mThreadID == 0)
+   {
+      return true;
+   }
+
+   if (IsWorkerThread() == true)
+   {
+      // This should never happen
+      ASSERT( 0 );
+      return false;
+   }
+
+   pthread_mutex_lock( &mMutex );
+   mbExiting = true;
+   pthread_cond_signal( &mTaskReady );
+   pthread_mutex_unlock( &mMutex );
+
+   int nRet = pthread_join( mThreadID, NULL );
+   if (nRet != 0 && nRet != ESRCH)
+   {
+      TRACE( "Unable to join ExecutorThread. Error %d: %s\n",
+             nRet,
+             strerror( nRet ) );
+      return false;
+   }
+
+   mThreadID = 0;
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   Execute (Public Method)
+
+DESCRIPTION:
+   Queue a task to be run on the worker thread
+
+PARAMETERS:
+   pTask       [ I ] - Task to run (owned by the executor when accepted)
+  
+RETURN VALUE:
+   bool - false if the task was not accepted (worker thread not running)
+===========================================================================*/
+bool cThreadExecutor::Execute( cExecutorTask * pTask )
+{
+   // Assume failure
+   bool bRC = false;
+   if (pTask == 0)
+   {
+      return bRC;
+   }
+
+   pthread_mutex_lock( &mMutex );
+
+   // Tasks queued by a task are still accepted while draining
+   if ( (mThreadID != 0)
+   &&   (mbExiting == false || IsWorkerThread() == true) )
+   {
+      mTasks.push_back( pTask );
+      pthread_cond_signal( &mTaskReady );
+      bRC = true;
+   }
+
+   pthread_mutex_unlock( &mMutex );
+   return bRC;
+}
@@ -0,0 +1,151 @@
+/*===========================================================================
+FILE:
+   Executor.h
+
+DESCRIPTION:
+   Declaration of cExecutor class and derivations
+
+PUBLIC CLASSES AND METHODS:
+   cExecutorTask
+      This abstract base class is a unit of work run by an executor
+
+   cExecutor
+      This abstract base class runs tasks on a thread of its choosing
+
+   cThreadExecutor
+      This class runs tasks, in the order they were submitted, on a single
+      worker thread
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Pragmas
+//---------------------------------------------------------------------------
+#pragma once
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "StdAfx.h"
+#include "ThreadConfig.h"
+
+#include <deque>
+#include <pthread.h>
+
+/*=========================================================================*/
+// Class cExecutorTask
+/*=========================================================================*/
+class cExecutorTask
+{
+   public:
+      // (Inline) Constructor
+      cExecutorTask() { };
+
+      // (Inline) Destructor
+      virtual ~cExecutorTask() { };
+
+      // Perform the work
+      virtual void Run() = 0;
+};
+
+/*=========================================================================*/
+// Class cExecutor
+//
+//    Once accepted a task is owned by the executor, which deletes it 
+//    after it has run
+/*=========================================================================*/
+class cExecutor
+{
+   public:
+      // (Inline) Constructor
+      cExecutor() { };
+
+      // (Inline) Destructor
+      virtual ~cExecutor() { };
+
+      // Queue a task to be run (false if the task was not accepted)
+      virtual bool Execute( cExecutorTask * pTask ) = 0;
+};
+
+/*=========================================================================*/
+// Class cThreadExecutor
+/*=========================================================================*/
+class cThreadExecutor : public cExecutor
+{
+   public:
+      // Constructor
+      cThreadExecutor();
+
+      // Destructor
+      virtual ~cThreadExecutor();
+
+      // Start the worker thread
+      bool Initialize();
+
+      // (Inline) Set the thread configuration the worker thread is started
+      // with (as an eTHREAD_ROLE_WORKER thread)
+      void SetThreadConfig( const cThreadConfig & config )
+      {
+         mThreadConfig = config;
+      };
+
+      // Run any queued tasks and then exit the worker thread
+      bool Exit();
+
+      // Queue a task to be run
+      virtual bool Execute( cExecutorTask * pTask );
+
+      // (Inline) Is the calling thread the worker thread?
+      bool IsWorkerThread()
+      {
+         return (mThreadID != 0 && pthread_equal( mThreadID, pthread_self() ));
+      };
+
+   protected:
+      /* ID of worker thread */
+      pthread_t mThreadID;
+
+      /* Thread configuration of the worker thread */
+      cThreadConfig mThreadConfig;
+
+      /* Is the worker thread exiting? */
+      bool mbExiting;
+
+      /* Queued tasks, oldest first */
+      std::deque <cExecutorTask *> mTasks;
+
+      /* Mutex protecting mTasks and mbExiting */
+      pthread_mutex_t mMutex;
+
+      /* Signalled when a task is queued (or on exit) */
+      pthread_cond_t mTaskReady;
+
+      // Worker thread gets full access
+      friend void * ExecutorThread( PVOID pArg );
+};
@@ -7,6 +7,9 @@ DESCRIPTION:
    by both the QUALCOMM download & SDIC (diagnostic) protocol documents
 
 PUBLIC CLASSES AND METHODS:
+   HDLCScan()
+   HDLCFindFlag()
+   HDLCMaxEncodedSize()
    HDLCDecode()
    HDLCEncode()
 
@@ -47,6 +50,16 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "SharedBuffer.h"
 #include "ProtocolServer.h"
 
+#include <pthread.h>
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+   #include <immintrin.h>
+   #define HDLC_SCAN_X86
+#elif defined( __ARM_NEON ) || defined( __ARM_NEON__ )
+   #include <arm_neon.h>
+   #define HDLC_SCAN_NEON
+#endif
+
 //---------------------------------------------------------------------------
 // Definitions
 //---------------------------------------------------------------------------
@@ -56,96 +69,516 @@ const BYTE AHDLC_FLAG    = 0x7e;
 const BYTE AHDLC_ESCAPE  = 0x7d;
 const BYTE AHDLC_ESC_M   = 0x20;
 
+// Signature of a scan kernel
+typedef ULONG (* tHDLCScanFn)( const BYTE *, ULONG, BYTE, BYTE );
+
+// Selected scan kernel
+static tHDLCScanFn gpHDLCScan = 0;
+
+// One time scan kernel selection
+static pthread_once_t gHDLCScanOnce = PTHREAD_ONCE_INIT;
+
+/*=========================================================================*/
+// Internal Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   HDLCScanScalar (Internal Method)
+
+DESCRIPTION:
+   Return the number of leading bytes that match neither of the given
+   values, one byte at a time
+  
+PARAMETERS:
+   pBuf        [ I ] - The data buffer to scan
+   len         [ I ] - The length of the above buffer
+   a           [ I ] - First value to stop at
+   b           [ I ] - Second value to stop at
+
+RETURN VALUE:
+   ULONG
+===========================================================================*/
+static ULONG HDLCScanScalar(
+   const BYTE *               pBuf,
+   ULONG                      len,
+   BYTE                       a,
+   BYTE                       b )
+{
+   ULONG i = 0;
+   while (i < len && pBuf[i] != a && pBuf[i] != b)
+   {
+      i++;
+   }
+
+   return i;
+}
+
+#if defined( HDLC_SCAN_X86 )
+
+/*===========================================================================
+METHOD:
+   HDLCScanSSE2 (Internal Method)
+
+DESCRIPTION:
+   Return the number of leading bytes that match neither of the given
+   values, sixteen bytes at a time
+  
+PARAMETERS:
+   pBuf        [ I ] - The data buffer to scan
+   len         [ I ] - The length of the above buffer
+   a           [ I ] - First value to stop at
+   b           [ I ] - Second value to stop at
+
+RETURN VALUE:
+   ULONG
+===========================================================================*/
+__attribute__ ((target ("sse2")))
+static ULONG HDLCScanSSE2(
+   const BYTE *               pBuf,
+   ULONG                      len,
+   BYTE                       a,
+   BYTE                       b )
+{
+   const __m128i va = _mm_set1_epi8( (char)a );
+   const __m128i vb = _mm_set1_epi8( (char)b );
+
+   ULONG i = 0;
+   while (len - i >= 16)
+   {
+      __m128i v = _mm_loadu_si128( (const __m128i *)&pBuf[i] );
+      __m128i m = _mm_or_si128( _mm_cmpeq_epi8( v, va ), 
+                                _mm_cmpeq_epi8( v, vb ) );
+
+      int bits = _mm_movemask_epi8( m );
+      if (bits != 0)
+      {
+         return i + (ULONG)__builtin_ctz( bits );
+      }
+
+      i += 16;
+   }
+
+   return i + HDLCScanScalar( &pBuf[i], len - i, a, b );
+}
+
+/*===========================================================================
+METHOD:
+   HDLCScanAVX2 (Internal Method)
+
+DESCRIPTION:
+   Return the number of leading bytes that match neither of the given
+   values, thirty two bytes at a time
+  
+PARAMETERS:
+   pBuf        [ I ] - The data buffer to scan
+   len         [ I ] - The length of the above buffer
+   a           [ I ] - First value to stop at
+   b           [ I ] - Second value to stop at
+
+RETURN VALUE:
+   ULONG
+===========================================================================*/
+__attribute__ ((target ("avx2")))
+static ULONG HDLCScanAVX2(
+   const BYTE *               pBuf,
+   ULONG                      len,
+   BYTE                       a,
+   BYTE                       b )
+{
+   const __m256i va = _mm256_set1_epi8( (char)a );
+   const __m256i vb = _mm256_set1_epi8( (char)b );
+
+   ULONG i = 0;
+   while (len - i >= 32)
+   {
+      __m256i v = _mm256_loadu_si256( (const __m256i *)&pBuf[i] );
+      __m256i m = _mm256_or_si256( _mm256_cmpeq_epi8( v, va ), 
+                                   _mm256_cmpeq_epi8( v, vb ) );
+
+      UINT bits = (UINT)_mm256_movemask_epi8( m );
+      if (bits != 0)
+      {
+         return i + (ULONG)__builtin_ctz( bits );
+      }
+
+      i += 32;
+   }
+
+   return i + HDLCScanSSE2( &pBuf[i], len - i, a, b );
+}
+
+#elif defined( HDLC_SCAN_NEON )
+
+/*===========================================================================
+METHOD:
+   HDLCScanNEON (Internal Method)
+
+DESCRIPTION:
+   Return the number of leading bytes that match neither of the given
+   values, sixteen bytes at a time
+  
+PARAMETERS:
+   pBuf        [ I ] - The data buffer to scan
+   len         [ I ] - The length of the above buffer
+   a           [ I ] - First value to stop at
+   b           [ I ] - Second value to stop at
+
+RETURN VALUE:
+   ULONG
+===========================================================================*/
+static ULONG HDLCScanNEON(
+   const BYTE *               pBuf,
+   ULONG                      len,
+   BYTE                       a,
+   BYTE                       b )
+{
+   const uint8x16_t va = vdupq_n_u8( a );
+   const uint8x16_t vb = vdupq_n_u8( b );
+
+   ULONG i = 0;
+   while (len - i >= 16)
+   {
+      uint8x16_t v = vld1q_u8( &pBuf[i] );
+      uint8x16_t m = vorrq_u8( vceqq_u8( v, va ), vceqq_u8( v, vb ) );
+
+      // Narrow the byte mask to four bits per byte
+      uint8x8_t n = vshrn_n_u16( vreinterpretq_u16_u8( m ), 4 );
+      ULONGLONG bits = vget_lane_u64( vreinterpret_u64_u8( n ), 0 );
+      if (bits != 0)
+      {
+         return i + (ULONG)(__builtin_ctzll( bits ) >> 2);
+      }
+
+      i += 16;
+   }
+
+   return i + HDLCScanScalar( &pBuf[i], len - i, a, b );
+}
+
+#endif
+
+/*===========================================================================
+METHOD:
+   InitHDLCScan (Internal Method)
+
+DESCRIPTION:
+   Select the scan kernel for this CPU
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+static void InitHDLCScan()
+{
+#if defined( HDLC_SCAN_X86 )
+   __builtin_cpu_init();
+   if (__builtin_cpu_supports( "avx2" ) != 0)
+   {
+      gpHDLCScan = HDLCScanAVX2;
+   }
+   else if (__builtin_cpu_supports( "sse2" ) != 0)
+   {
+      gpHDLCScan = HDLCScanSSE2;
+   }
+   else
+   {
+      gpHDLCScan = HDLCScanScalar;
+   }
+#elif defined( HDLC_SCAN_NEON )
+   gpHDLCScan = HDLCScanNEON;
+#else
+   gpHDLCScan = HDLCScanScalar;
+#endif
+}
+
+/*===========================================================================
+METHOD:
+   HDLCScanFor (Internal Method)
+
+DESCRIPTION:
+   Return the number of leading bytes that match neither of the given
+   values, using the best scan kernel for this CPU
+  
+PARAMETERS:
+   pBuf        [ I ] - The data buffer to scan
+   len         [ I ] - The length of the above buffer
+   a           [ I ] - First value to stop at
+   b           [ I ] - Second value to stop at
+
+RETURN VALUE:
+   ULONG
+===========================================================================*/
+static inline ULONG HDLCScanFor(
+   const BYTE *               pBuf,
+   ULONG                      len,
+   BYTE                       a,
+   BYTE                       b )
+{
+   pthread_once( &gHDLCScanOnce, InitHDLCScan );
+   return gpHDLCScan( pBuf, len, a, b );
+}
+
+/*===========================================================================
+METHOD:
+   HDLCEscape (Internal Method)
+
+DESCRIPTION:
+   Escape the given data, copying runs that need no escaping in bulk
+
+   NOTE: The output buffer must be able to hold twice the input length
+  
+PARAMETERS:
+   pIn         [ I ] - The data to escape
+   inLen       [ I ] - The length of the above data
+   pOut        [ O ] - The escaped data
+
+RETURN VALUE:
+   ULONG: Number of bytes written to the output buffer
+===========================================================================*/
+static ULONG HDLCEscape(
+   const BYTE *               pIn,
+   ULONG                      inLen,
+   PBYTE                      pOut )
+{
+   ULONG inIndex = 0;
+   ULONG outIndex = 0;
+   while (inIndex < inLen)
+   {
+      ULONG run = HDLCScanFor( &pIn[inIndex], 
+                               inLen - inIndex, 
+                               AHDLC_FLAG, 
+                               AHDLC_ESCAPE );
+
+      if (run > 0)
+      {
+         memcpy( &pOut[outIndex], &pIn[inIndex], (size_t)run );
+         inIndex += run;
+         outIndex += run;
+      }
+
+      if (inIndex < inLen)
+      {
+         pOut[outIndex++] = AHDLC_ESCAPE;
+         pOut[outIndex++] = pIn[inIndex++] ^ AHDLC_ESC_M;
+      }
+   }
+
+   return outIndex;
+}
+
+/*===========================================================================
+METHOD:
+   HDLCUnescape (Internal Method)
+
+DESCRIPTION:
+   Unescape the given data, copying runs that need no unescaping in bulk
+   (an escape character ending the data is copied as is)
+
+   NOTE: The output buffer must be able to hold the input length
+  
+PARAMETERS:
+   pIn         [ I ] - The data to unescape
+   inLen       [ I ] - The length of the above data
+   pOut        [ O ] - The unescaped data
+
+RETURN VALUE:
+   ULONG: Number of bytes written to the output buffer
+===========================================================================*/
+static ULONG HDLCUnescape(
+   const BYTE *               pIn,
+   ULONG                      inLen,
+   PBYTE                      pOut )
+{
+   ULONG inIndex = 0;
+   ULONG outIndex = 0;
+   while (inIndex < inLen)
+   {
+      ULONG run = HDLCScanFor( &pIn[inIndex], 
+                               inLen - inIndex, 
+                               AHDLC_ESCAPE, 
+                               AHDLC_ESCAPE );
+
+      if (run > 0)
+      {
+         memcpy( &pOut[outIndex], &pIn[inIndex], (size_t)run );
+         inIndex += run;
+         outIndex += run;
+      }
+
+      if (inIndex < inLen)
+      {
+         inIndex++;
+         if (inIndex < inLen)
+         {
+            pOut[outIndex++] = pIn[inIndex++] ^ AHDLC_ESC_M;
+         }
+         else
+         {
+            pOut[outIndex++] = AHDLC_ESCAPE;
+         }
+      }
+   }
+
+   return outIndex;
+}
+
 /*=========================================================================*/
 // Free Methods
 /*=========================================================================*/
 
+/*===========================================================================
+METHOD:
+   HDLCScan (Free Method)
+
+DESCRIPTION:
+   Return the number of leading bytes in the given buffer that are neither
+   flag nor escape characters (i.e. that can be copied as is)
+  
+PARAMETERS:
+   pBuf        [ I ] - The data buffer to scan
+   len         [ I ] - The length of the above buffer
+
+RETURN VALUE:
+   ULONG
+===========================================================================*/
+ULONG HDLCScan( 
+   const BYTE *               pBuf,
+   ULONG                      len )
+{
+   if (pBuf == 0)
+   {
+      return 0;
+   }
+
+   return HDLCScanFor( pBuf, len, AHDLC_FLAG, AHDLC_ESCAPE );
+}
+
+/*===========================================================================
+METHOD:
+   HDLCFindFlag (Free Method)
+
+DESCRIPTION:
+   Return the offset of the first flag character in the given buffer, 
+   i.e. the end of the frame it starts
+  
+PARAMETERS:
+   pBuf        [ I ] - The data buffer to scan
+   len         [ I ] - The length of the above buffer
+
+RETURN VALUE:
+   ULONG - Offset of the flag (len if there is none)
+===========================================================================*/
+ULONG HDLCFindFlag( 
+   const BYTE *               pBuf,
+   ULONG                      len )
+{
+   if (pBuf == 0)
+   {
+      return len;
+   }
+
+   return HDLCScanFor( pBuf, len, AHDLC_FLAG, AHDLC_FLAG );
+}
+
+/*===========================================================================
+METHOD:
+   HDLCMaxEncodedSize (Free Method)
+
+DESCRIPTION:
+   Return the worst case HDLC encoded size of the given amount of data
+   (leading flag, every data and CRC byte escaped, trailing flag)
+  
+PARAMETERS:
+   len         [ I ] - The length of the data to encode
+
+RETURN VALUE:
+   ULONG
+===========================================================================*/
+ULONG HDLCMaxEncodedSize( ULONG len )
+{
+   return (len + CRC_SIZE) * 2 + 2;
+}
+
 /*===========================================================================
 METHOD:
    HDLCDecode (Free Method)
 
 DESCRIPTION:
-   HDLC decode the given buffer returning the results in an allocated buffer
+   HDLC decode the given frame into a caller supplied buffer
+
+   NOTE: The CRC is unescaped into the decode buffer as well, so the
+   decode buffer must be at least as large as the frame (less flags)
   
 PARAMETERS:
-   pBuf        [ I ] - The data buffer to decode
+   pData       [ I ] - The frame to decode
+   dataLen     [ I ] - The length of the above frame
+   pDecoded    [ O ] - The decoded data
+   decodedSz   [ I ] - The size of the above buffer
+   decodedLen  [ O ] - The length of the decoded data (less CRC)
 
 RETURN VALUE:
-   sSharedBuffer * : The decoded buffer (allocated), 0 on error
+   bool
 ===========================================================================*/
-sSharedBuffer * HDLCDecode( sSharedBuffer * pBuf )
-{  
-   // The return buffer
-   sSharedBuffer * pRet = 0;
+bool HDLCDecode( 
+   const BYTE *               pData,
+   ULONG                      dataLen,
+   PBYTE                      pDecoded,
+   ULONG                      decodedSz,
+   ULONG &                    decodedLen )
+{
+   // Assume failure
+   bool bRC = false;
+   decodedLen = 0;
 
    // The has to be something to decode
-   if (pBuf == 0 || pBuf->IsValid() == false)
+   if (pData == 0 || dataLen == 0 || pDecoded == 0)
    {
-      return pRet;
+      return bRC;
    }
 
-   // Grab raw data from shared buffer
-   const BYTE * pData = pBuf->GetBuffer();
-   UINT sz = pBuf->GetSize();
-
    // Is the first character a leading flag?
    if (pData[0] == AHDLC_FLAG)
    {
       pData++;
-      sz--;
+      dataLen--;
    }
 
    // There must be at least four bytes (data, CRC, trailing flag)
-   if (sz < 4)
+   if (dataLen < 4)
    {
-      return pRet;
+      return bRC;
    }
 
    // The last character must be the trailing flag
-   if (pData[sz - 1] == AHDLC_FLAG)
+   if (pData[dataLen - 1] == AHDLC_FLAG)
    {
-      sz--;
+      dataLen--;
    }
    else 
    {
-      return pRet;      
+      return bRC;      
    }
 
-   // Allocate the decode buffer
-   PBYTE pDecoded = new BYTE[sz];
-   if (pDecoded == 0)
+   // The decoded data can be no larger than the encoded data
+   if (decodedSz < dataLen)
    {
-      return pRet;
+      return bRC;
    }
 
    // Handle escaped characters and copy into decode buffer
-   UINT encodeIndex = 0;
-   UINT decodeIndex = 0;
-   while (encodeIndex < sz)
-   {
-      BYTE b = pData[encodeIndex++];
-      if (b == AHDLC_ESCAPE && encodeIndex < sz)
-      {
-         b = pData[encodeIndex++];
-         b ^= AHDLC_ESC_M;
-      }
-
-      pDecoded[decodeIndex++] = b;
-   }
+   ULONG decodeIndex = HDLCUnescape( pData, dataLen, pDecoded );
 
    // Check CRC value
    if (CheckCRC( pDecoded, decodeIndex ) == false)
    {
-      delete [] pDecoded;
-      return pRet;
+      return bRC;
    }
       
    // Adjust decode length down for CRC
-   decodeIndex -= 2;
+   decodedLen = decodeIndex - CRC_SIZE;
 
-   // ... and wrap up in a shared buffer
-   pRet = new sSharedBuffer( decodeIndex, pDecoded, pBuf->GetType() );
-   return pRet;
+   bRC = true;
+   return bRC;
 }
 
 /*===========================================================================
@@ -153,16 +586,84 @@ METHOD:
    HDLCEncode (Free Method)
 
 DESCRIPTION:
-   HDLC encode the given buffer returning the results in an allocated buffer
+   HDLC encode the given data into a caller supplied buffer
 
+PARAMETERS:
+   pData       [ I ] - The data to encode
+   dataLen     [ I ] - The length of the above data
+   pEncoded    [ O ] - The encoded frame
+   encodedSz   [ I ] - The size of the above buffer, which must be at
+                       least HDLCMaxEncodedSize( dataLen )
+   encodedLen  [ O ] - The length of the encoded frame
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool HDLCEncode( 
+   const BYTE *               pData,
+   ULONG                      dataLen,
+   PBYTE                      pEncoded,
+   ULONG                      encodedSz,
+   ULONG &                    encodedLen )
+{
+   // Assume failure
+   bool bRC = false;
+   encodedLen = 0;
+
+   // The has to be something to encode
+   if (pData == 0 || dataLen == 0 || pEncoded == 0)
+   {
+      return bRC;
+   }
+
+   // Is the encode buffer large enough?
+   if (encodedSz < HDLCMaxEncodedSize( dataLen ))
+   {
+      return bRC;
+   }
+
+   // Compute CRC
+   USHORT CRC = CalculateCRC( pData, dataLen * 8 );
+
+   // Byte order CRC
+   BYTE byteOrderedCRC[CRC_SIZE];
+   byteOrderedCRC[0] = (BYTE)(CRC & 0x00ff);
+   byteOrderedCRC[1] = (BYTE)(CRC >> 8);
+
+   // Add leading flag
+   ULONG encodeIndex = 0; 
+   pEncoded[encodeIndex++] = AHDLC_FLAG;
+
+   // Add data and CRC, escaping when necessary
+   encodeIndex += HDLCEscape( pData, dataLen, &pEncoded[encodeIndex] );
+   encodeIndex += HDLCEscape( &byteOrderedCRC[0], 
+                              CRC_SIZE, 
+                              &pEncoded[encodeIndex] );
+
+   // Add trailing flag
+   pEncoded[encodeIndex++] = AHDLC_FLAG;
+
+   encodedLen = encodeIndex;
+
+   bRC = true;
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   HDLCDecode (Free Method)
+
+DESCRIPTION:
+   HDLC decode the given buffer returning the results in an allocated buffer
+  
 PARAMETERS:
    pBuf        [ I ] - The data buffer to decode
 
 RETURN VALUE:
    sSharedBuffer * : The decoded buffer (allocated), 0 on error
 ===========================================================================*/
-sSharedBuffer * HDLCEncode( sSharedBuffer * pBuf )
-{
+sSharedBuffer * HDLCDecode( sSharedBuffer * pBuf )
+{  
    // The return buffer
    sSharedBuffer * pRet = 0;
 
@@ -174,60 +675,119 @@ sSharedBuffer * HDLCEncode( sSharedBuffer * pBuf )
 
    // Grab raw data from shared buffer
    const BYTE * pData = pBuf->GetBuffer();
-   UINT sz = pBuf->GetSize();
+   ULONG sz = pBuf->GetSize();
 
-   // Compute CRC
-   USHORT CRC = CalculateCRC( pData, sz * 8 );
+   // Allocate the decode buffer
+   sSharedBuffer * pDecodedBuf = new sSharedBuffer( sz, pBuf->GetType() );
+   if (pDecodedBuf == 0 || pDecodedBuf->IsValid() == false)
+   {
+      delete pDecodedBuf;
+      return pRet;
+   }
+
+   ULONG decodedLen = 0;
+   bool bDecoded = HDLCDecode( pData, 
+                               sz, 
+                               pDecodedBuf->GetWritableBuffer(), 
+                               sz, 
+                               decodedLen );
 
-   // Allocate the encode buffer
-   PBYTE pEncoded = new BYTE[sz * 2 + 4];
-   if (pEncoded == 0)
+   // ... and trim the shared buffer to fit
+   if ( (bDecoded == false)
+   ||   (pDecodedBuf->Truncate( decodedLen ) == false) )
    {
+      delete pDecodedBuf;
       return pRet;
    }
 
-   // Add leading flag
-   UINT encodeIndex = 0; 
-   pEncoded[encodeIndex++] = AHDLC_FLAG;
+   pRet = pDecodedBuf;
+   return pRet;
+}
+
+/*===========================================================================
+METHOD:
+   HDLCEncode (Free Method)
 
-   // Add data, escaping when necessary
-   UINT decodeIndex = 0;
-   while (decodeIndex < sz)
+DESCRIPTION:
+   HDLC encode the given buffer returning the results in an allocated buffer
+
+PARAMETERS:
+   pBuf        [ I ] - The data buffer to decode
+
+RETURN VALUE:
+   sSharedBuffer * : The decoded buffer (allocated), 0 on error
+===========================================================================*/
+sSharedBuffer * HDLCEncode( sSharedBuffer * pBuf )
+{
+   // The return buffer
+   sSharedBuffer * pRet = 0;
+
+   // The has to be something to decode
+   if (pBuf == 0 || pBuf->IsValid() == false)
    {
-      BYTE value = pData[decodeIndex++];  
-      if (value == AHDLC_FLAG || value == AHDLC_ESCAPE)
+      return pRet;
+   }
+
+   // Grab raw data from shared buffer
+   const BYTE * pData = pBuf->GetBuffer();
+   ULONG sz = pBuf->GetSize();
+
+   // Allocate the encode buffer (worst case every byte is escaped), from
+   // the buffer pool when the worst case fits in a shared buffer
+   ULONG encodedSz = HDLCMaxEncodedSize( sz );
+   sSharedBuffer * pEncodedBuf = 0;
+   PBYTE pEncoded = 0;
+
+   if (sSharedBuffer::IsValidSize( encodedSz ) == true)
+   {
+      pEncodedBuf = new sSharedBuffer( encodedSz, pBuf->GetType() );
+      if (pEncodedBuf == 0 || pEncodedBuf->IsValid() == false)
       {
-         value ^= AHDLC_ESC_M;
-         pEncoded[encodeIndex++] = AHDLC_ESCAPE;
+         delete pEncodedBuf;
+         return pRet;
       }
 
-      pEncoded[encodeIndex++] = value;
+      pEncoded = pEncodedBuf->GetWritableBuffer();
+   }
+   else
+   {
+      pEncoded = new BYTE[encodedSz];
+      if (pEncoded == 0)
+      {
+         return pRet;
+      }
    }
 
-   // Byte order CRC
-   BYTE byteOrderedCRC[2];
-   byteOrderedCRC[0] = (BYTE)(CRC & 0x00ff);
-   byteOrderedCRC[1] = (BYTE)(CRC >> 8);
-
-   // Add CRC
-   UINT c = 0;
-   while (c < 2)
+   ULONG encodedLen = 0;
+   bool bEncoded = HDLCEncode( pData, sz, pEncoded, encodedSz, encodedLen );
+   if (bEncoded == false)
    {
-      BYTE value = byteOrderedCRC[c++];  
-      if (value == AHDLC_FLAG || value == AHDLC_ESCAPE)
+      if (pEncodedBuf == 0)
+      {
+         delete [] pEncoded;
+      }
+      else
       {
-         value ^= AHDLC_ESC_M;
-         pEncoded[encodeIndex++] = AHDLC_ESCAPE;
+         delete pEncodedBuf;
       }
 
-      pEncoded[encodeIndex++] = value;
+      return pRet;
    }
 
-   // Add trailing flag
-   pEncoded[encodeIndex++] = AHDLC_FLAG;
+   // Wrap up in a shared buffer (or trim the pooled one to fit)
+   if (pEncodedBuf == 0)
+   {
+      pRet = new sSharedBuffer( encodedLen, pEncoded, pBuf->GetType() );
+   }
+   else if (pEncodedBuf->Truncate( encodedLen ) == true)
+   {
+      pRet = pEncodedBuf;
+   }
+   else
+   {
+      delete pEncodedBuf;
+   }
 
-   // Wrap up in a shared buffer
-   pRet = new sSharedBuffer( encodeIndex, pEncoded, pBuf->GetType() );
    return pRet;
 }
 
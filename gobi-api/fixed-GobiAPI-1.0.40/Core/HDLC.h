@@ -7,6 +7,8 @@ DESCRIPTION:
    by both the QUALCOMM download & SDIC (diagnostic) protocol documents
 
 PUBLIC CLASSES AND METHODS:
+   HDLCScan()
+   HDLCMaxEncodedSize()
    HDLCDecode()
    HDLCEncode()
 
@@ -56,6 +58,35 @@ struct sSharedBuffer;
 // Prototypes
 /*=========================================================================*/
 
+// Return the number of leading bytes that need no escaping
+ULONG HDLCScan( 
+   const BYTE *               pBuf,
+   ULONG                      len );
+
+// Return the offset of the first flag character (len if there is none)
+ULONG HDLCFindFlag( 
+   const BYTE *               pBuf,
+   ULONG                      len );
+
+// Return the worst case HDLC encoded size of the given amount of data
+ULONG HDLCMaxEncodedSize( ULONG len );
+
+// HDLC decode the given frame into a caller supplied buffer
+bool HDLCDecode( 
+   const BYTE *               pData,
+   ULONG                      dataLen,
+   PBYTE                      pDecoded,
+   ULONG                      decodedSz,
+   ULONG &                    decodedLen );
+
+// HDLC encode the given data into a caller supplied buffer
+bool HDLCEncode( 
+   const BYTE *               pData,
+   ULONG                      dataLen,
+   PBYTE                      pEncoded,
+   ULONG                      encodedSz,
+   ULONG &                    encodedLen );
+
 // HDLC encode the given buffer returning the results in an allocated buffer
 sSharedBuffer * HDLCEncode( sSharedBuffer * pBuf );
 
@@ -81,14 +81,15 @@ cHDLCProtocolServer::cHDLCProtocolServer(
    :  cProtocolServer( rxType, txType, bufferSzRx, logSz ),
       mRxType( rxType ),
       mpEncodedBuffer( 0 ),
-      mpRxDecodeBuffer( 0 ),
-      mRxDecodeOffset( 0 ),
-      mbInEscape( false )
+      mpRxFrameBuffer( 0 ),
+      mRxFrameSize( 0 ),
+      mRxFrameLen( 0 )
 {
-   // Allocate decode buffer?
+   // Allocate partial frame buffer? (grown on demand)
    if (mRxBufferSize > 0)
    {
-      mpRxDecodeBuffer = new BYTE[mRxBufferSize * 4];
+      mpRxFrameBuffer = new BYTE[mRxBufferSize];
+      mRxFrameSize = mRxBufferSize;
    }
 }
 
@@ -114,11 +115,11 @@ cHDLCProtocolServer::~cHDLCProtocolServer()
       mpEncodedBuffer = 0;
    }
 
-   // Free decode buffer?
-   if (mpRxDecodeBuffer != 0)
+   // Free partial frame buffer?
+   if (mpRxFrameBuffer != 0)
    {
-      delete [] mpRxDecodeBuffer;
-      mpRxDecodeBuffer = 0;
+      delete [] mpRxFrameBuffer;
+      mpRxFrameBuffer = 0;
    }
 }
 
@@ -216,7 +217,10 @@ METHOD:
    DecodeRxData (Internal Method)
 
 DESCRIPTION:
-   Decode incoming data into packets returning the last response
+   Decode incoming data into packets returning the last response, the
+   packets are matched through the virtual IsResponse() and 
+   IsTxAbortResponse() (see cHDLCProtocolServerT for servers binding 
+   those at compile time)
 
 PARAMETERS:
    bytesReceived  [ I ] - Number of bytes to decoded
@@ -234,90 +238,176 @@ bool cHDLCProtocolServer::DecodeRxData(
    ULONG &                    rspIdx,
    bool &                     bAbortTx )
 {
-   // Assume failure
-   bool bRC = false;
-   rspIdx = INVALID_LOG_INDEX;
+   sVirtualMatcher matcher( *this );
+   return DecodeRxFrames( matcher, bytesReceived, rspIdx, bAbortTx );
+}
 
-   // Something to decode from/to?
-   if (bytesReceived == 0 || mpRxDecodeBuffer == 0)
-   {
-      return bRC;
-   }
+/*===========================================================================
+METHOD:
+   DecodeRxFrame (Internal Method)
 
-   BYTE val;
-   ULONG idx = 0;
-   ULONG maxSz = mRxBufferSize * 4;
-   
-   while (idx < bytesReceived)
+DESCRIPTION:
+   Decode a single frame into a pooled buffer and log it
+
+PARAMETERS:
+   pFrame         [ I ] - Encoded frame (trailing flag included)
+   frameLen       [ I ] - Length of the above frame
+   buf            [ O ] - Decoded frame
+   logIdx         [ O ] - Log index of the decoded frame
+
+SEQUENCING:
+   None (must be called from protocol server thread)
+
+RETURN VALUE:
+   bool - Was the frame decoded?
+===========================================================================*/
+bool cHDLCProtocolServer::DecodeRxFrame( 
+   const BYTE *               pFrame,
+   ULONG                      frameLen,
+   sProtocolBuffer &          buf,
+   ULONG &                    logIdx )
+{
+   // Decoded data (with CRC) is no larger than the frame less its flag
+   sSharedBuffer * pTmp = 0;
+   ULONG decodedLen = 0;
+   ULONG maxLen = frameLen - 1;
+   if (sSharedBuffer::IsValidSize( maxLen ) == true)
    {
-      val = mpRxBuffer[idx++];
-     
-      // Check for target spewing nonsense
-      if (mRxDecodeOffset >= maxSz)
+      pTmp = new sSharedBuffer( maxLen, (ULONG)mRxType );
+      if ( (pTmp->IsValid() == false)
+      ||   (HDLCDecode( pFrame, 
+                        frameLen, 
+                        pTmp->GetWritableBuffer(), 
+                        maxLen, 
+                        decodedLen ) == false)
+      ||   (pTmp->Truncate( decodedLen ) == false) )
       {
-         // Reset to beginning
-         mRxDecodeOffset = 0;
+         delete pTmp;
+         pTmp = 0;
       }
-      
-      // Was the previous byte an escape byte?
-      if (mbInEscape == true)
+   }
+   else
+   {
+      // Heavily escaped frame, decode aside and copy
+      std::vector <BYTE> decoded( maxLen );
+      if ( (HDLCDecode( pFrame, 
+                        frameLen, 
+                        &decoded[0], 
+                        maxLen, 
+                        decodedLen ) == true)
+      &&   (sSharedBuffer::IsValidSize( decodedLen ) == true) )
       {
-         // Yes, handle it
-         mbInEscape = false;
-            
-         val ^= AHDLC_ESC_M;
-         mpRxDecodeBuffer[mRxDecodeOffset++] = val;
+         pTmp = new sSharedBuffer( &decoded[0], decodedLen, (ULONG)mRxType );
       }
-      else if (val == AHDLC_ESCAPE) 
+   }
+
+   if (pTmp == 0)
+   {
+      return false;
+   }
+
+   buf = sProtocolBuffer( pTmp );
+   logIdx = mLog.AddBuffer( buf );
+
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   CompleteRxFrame (Internal Method)
+
+DESCRIPTION:
+   Handle the outcome of matching a decoded frame, completing the in-flight
+   request it is the response to (if any)
+
+PARAMETERS:
+   bRsp           [ I ] - Is the frame a response?
+   logIdx         [ I ] - Log index of the frame
+   rspIdx         [ O ] - Log index of the frame if it is the response to
+                          the active request
+
+SEQUENCING:
+   None (must be called from protocol server thread)
+
+RETURN VALUE:
+   bool - Is the frame the response to the active request?
+===========================================================================*/
+bool cHDLCProtocolServer::CompleteRxFrame( 
+   bool                       bRsp,
+   ULONG                      logIdx,
+   ULONG &                    rspIdx )
+{
+   if (bRsp == true && mInFlightRspID != INVALID_REQUEST_ID)
+   {
+      // One read can carry the responses of several
+      // in-flight requests, complete each as decoded
+      CompleteInFlightRequest( mInFlightRspID, logIdx );
+      mInFlightRspID = INVALID_REQUEST_ID;
+      return false;
+   }
+
+   if (bRsp == true)
+   {
+      rspIdx = logIdx;
+   }
+
+   return bRsp;
+}
+
+/*===========================================================================
+METHOD:
+   AppendRxFrame (Internal Method)
+
+DESCRIPTION:
+   Append encoded data to the partial frame, doubling the buffer as needed
+   up to four times the receive buffer size, beyond which the target is 
+   assumed to be spewing nonsense and the partial frame is dropped
+
+PARAMETERS:
+   pData          [ I ] - Encoded data
+   dataLen        [ I ] - Length of the above data
+
+SEQUENCING:
+   None (must be called from protocol server thread)
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cHDLCProtocolServer::AppendRxFrame( 
+   const BYTE *               pData,
+   ULONG                      dataLen )
+{
+   ULONG maxSz = mRxBufferSize * 4;
+   if (dataLen > maxSz - mRxFrameLen)
+   {
+      // Reset to beginning
+      mRxFrameLen = 0;
+      return false;
+   }
+
+   ULONG needed = mRxFrameLen + dataLen;
+   if (needed > mRxFrameSize)
+   {
+      ULONG newSz = mRxFrameSize;
+      while (newSz < needed)
       {
-         // No, but this one is
-         mbInEscape = true;
+         newSz *= 2;
       }
-      else if (val == AHDLC_FLAG)
-      {
-         // Is this a valid frame?
-         if ( (mRxDecodeOffset > 0)
-         &&   (CheckCRC( mpRxDecodeBuffer, mRxDecodeOffset ) == true) )
-         {
-            // Yes, extract it (minus CRC) to a shared buffer
-            sSharedBuffer * pTmp = 0;
-            pTmp = new sSharedBuffer( mpRxDecodeBuffer, 
-                                      mRxDecodeOffset - 2, 
-                                      (ULONG)mRxType );
-
-            if (pTmp != 0)
-            {
-               sProtocolBuffer tmpPB( pTmp );
-               ULONG tmpIdx = mLog.AddBuffer( tmpPB );
-
-               // Abort?
-               bool bTmpAbortTx = IsTxAbortResponse( tmpPB );
-               if (bTmpAbortTx == true)
-               {
-                  bAbortTx = true;
-               }
-               else
-               {
-                  // Is this the response we are looking for?
-                  bool bRsp = IsResponse( tmpPB );
-                  if (bRsp == true)
-                  {
-                     rspIdx = tmpIdx;
-                     bRC = true;
-                  }
-               }
-            }
-         }
-
-         // Reset for next frame
-         mRxDecodeOffset = 0;
-      }  
-      else
+
+      if (newSz > maxSz)
       {
-         // No, just a regular value
-         mpRxDecodeBuffer[mRxDecodeOffset++] = val;
+         newSz = maxSz;
       }
+
+      BYTE * pNew = new BYTE[newSz];
+      memcpy( pNew, mpRxFrameBuffer, (size_t)mRxFrameLen );
+
+      delete [] mpRxFrameBuffer;
+      mpRxFrameBuffer = pNew;
+      mRxFrameSize = newSz;
    }
 
-   return bRC;
+   memcpy( &mpRxFrameBuffer[mRxFrameLen], pData, (size_t)dataLen );
+   mRxFrameLen = needed;
+   return true;
 }
@@ -7,6 +7,7 @@ DESCRIPTION:
    
 PUBLIC CLASSES AND METHODS:
    cHDLCProtocolServer
+   cHDLCProtocolServerT
 
 Copyright (c) 2011, Code Aurora Forum. All rights reserved.
 
@@ -45,6 +46,7 @@ POSSIBILITY OF SUCH DAMAGE.
 // Include Files
 //---------------------------------------------------------------------------
 #include "ProtocolServer.h"
+#include "HDLC.h"
 
 //---------------------------------------------------------------------------
 // Definitions
@@ -84,6 +86,33 @@ class cHDLCProtocolServer : public cProtocolServer
          ULONG &                    rspIdx,
          bool &                     bAbortTx );
 
+      // Decode incoming data into packets returning the last response,
+      // checking each packet through the given frame matcher
+      template <class tMatcher>
+      bool DecodeRxFrames( 
+         const tMatcher &           matcher,
+         ULONG                      bytesReceived,
+         ULONG &                    rspIdx,
+         bool &                     bAbortTx );
+
+      // Decode a single frame (trailing flag included) and log it
+      bool DecodeRxFrame( 
+         const BYTE *               pFrame,
+         ULONG                      frameLen,
+         sProtocolBuffer &          buf,
+         ULONG &                    logIdx );
+
+      // Handle the outcome of matching a decoded frame
+      bool CompleteRxFrame( 
+         bool                       bRsp,
+         ULONG                      logIdx,
+         ULONG &                    rspIdx );
+
+      // Append to the partial frame, growing the buffer as needed
+      bool AppendRxFrame( 
+         const BYTE *               pData,
+         ULONG                      dataLen );
+
       // Is the passed in data a response to the current request?
       virtual bool IsResponse( const sProtocolBuffer & /* rsp */ ) = 0;
 
@@ -96,12 +125,203 @@ class cHDLCProtocolServer : public cProtocolServer
       /* Encoded data being transmitted */
       sSharedBuffer * mpEncodedBuffer;
 
-      /* Decode buffer for incoming data */
-      BYTE * mpRxDecodeBuffer;
+      /* Encoded partial frame carried over between reads (frames that
+         end in the read they start in are decoded in place) */
+      BYTE * mpRxFrameBuffer;
+
+      /* Size of the above buffer */
+      ULONG mRxFrameSize;
+
+      /* Length of the partial frame in the above buffer */
+      ULONG mRxFrameLen;
+
+      // Frame matcher for DecodeRxFrames() dispatching through the virtual
+      // IsResponse() and IsTxAbortResponse() of the server
+      struct sVirtualMatcher
+      {
+         public:
+            // (Inline) Constructor
+            sVirtualMatcher( cHDLCProtocolServer & server )
+               :  mServer( server )
+            { };
+
+            // (Inline) Is the passed in data a response?
+            bool IsResponse( const sProtocolBuffer & rsp ) const
+            {
+               return mServer.IsResponse( rsp );
+            };
+
+            // (Inline) Is the passed in data a response that aborts the
+            // current request?
+            bool IsTxAbortResponse( const sProtocolBuffer & rsp ) const
+            {
+               return mServer.IsTxAbortResponse( rsp );
+            };
+
+            /* Server being matched for */
+            cHDLCProtocolServer & mServer;
+      };
+};
+
+/*=========================================================================*/
+// Class cHDLCProtocolServerT
+//
+//    HDLC framed protocol packet server whose packets are matched by the
+//    derived server class tServer directly (its IsResponse() and 
+//    IsTxAbortResponse() are bound at compile time for the receive path, 
+//    the virtual ones remain for everything else)
+/*=========================================================================*/
+template <class tServer>
+class cHDLCProtocolServerT : public cHDLCProtocolServer
+{
+   public:
+      // (Inline) Constructor
+      cHDLCProtocolServerT( 
+         eProtocolType              rxType,
+         eProtocolType              txType,
+         ULONG                      bufferSzRx,
+         ULONG                      logSz )
+         :  cHDLCProtocolServer( rxType, txType, bufferSzRx, logSz )
+      { };
+
+   protected:
+      // (Inline) Decode incoming data into packets returning the last
+      // response
+      virtual bool DecodeRxData( 
+         ULONG                      bytesReceived,
+         ULONG &                    rspIdx,
+         bool &                     bAbortTx )
+      {
+         sStaticMatcher matcher( static_cast <tServer &>( *this ) );
+         return DecodeRxFrames( matcher, bytesReceived, rspIdx, bAbortTx );
+      };
+
+      // Frame matcher for DecodeRxFrames() calling tServer directly
+      struct sStaticMatcher
+      {
+         public:
+            // (Inline) Constructor
+            sStaticMatcher( tServer & server )
+               :  mServer( server )
+            { };
+
+            // (Inline) Is the passed in data a response?
+            bool IsResponse( const sProtocolBuffer & rsp ) const
+            {
+               return mServer.tServer::IsResponse( rsp );
+            };
 
-      /* Current index into above buffer */
-      ULONG mRxDecodeOffset;
+            // (Inline) Is the passed in data a response that aborts the
+            // current request?
+            bool IsTxAbortResponse( const sProtocolBuffer & rsp ) const
+            {
+               return mServer.tServer::IsTxAbortResponse( rsp );
+            };
 
-      /* Are we currently escaping a character? */
-      bool mbInEscape;
+            /* Server being matched for */
+            tServer & mServer;
+      };
 };
+
+/*===========================================================================
+METHOD:
+   DecodeRxFrames (Internal Method)
+
+DESCRIPTION:
+   Decode incoming data into packets returning the last response
+
+   Frame boundaries are found by scanning for flags in bulk, frames that
+   end in the read they start in are decoded straight from the receive
+   buffer, only the encoded tail of a frame spanning reads is carried over
+
+PARAMETERS:
+   matcher        [ I ] - Frame matcher (IsResponse()/IsTxAbortResponse())
+   bytesReceived  [ I ] - Number of bytes to decoded
+   rspIdx         [ O ] - Log index of last valid response
+   bAbortTx       [ O ] - Response aborts current transmission?
+
+SEQUENCING:
+   None (must be called from protocol server thread)
+
+RETURN VALUE:
+   bool - Was a response received?
+===========================================================================*/
+template <class tMatcher>
+bool cHDLCProtocolServer::DecodeRxFrames( 
+   const tMatcher &           matcher,
+   ULONG                      bytesReceived,
+   ULONG &                    rspIdx,
+   bool &                     bAbortTx )
+{
+   // Assume failure
+   bool bRC = false;
+   rspIdx = INVALID_LOG_INDEX;
+
+   // Something to decode from/to?
+   if (bytesReceived == 0 || mpRxFrameBuffer == 0)
+   {
+      return bRC;
+   }
+
+   ULONG idx = 0;
+   while (idx < bytesReceived)
+   {
+      ULONG len = HDLCFindFlag( &mpRxBuffer[idx], bytesReceived - idx );
+      if (idx + len == bytesReceived)
+      {
+         // No flag, carry the partial frame over to the next read
+         AppendRxFrame( &mpRxBuffer[idx], len );
+         break;
+      }
+
+      // Frame including its trailing flag
+      const BYTE * pFrame = &mpRxBuffer[idx];
+      ULONG frameLen = len + 1;
+      idx += frameLen;
+
+      // Does this complete a frame from an earlier read?
+      if (mRxFrameLen > 0)
+      {
+         bool bAppend = AppendRxFrame( pFrame, frameLen );
+
+         pFrame = mpRxFrameBuffer;
+         frameLen = mRxFrameLen;
+         mRxFrameLen = 0;
+
+         if (bAppend == false)
+         {
+            continue;
+         }
+      }
+
+      // Skip empty frames (back to back flags)
+      if (frameLen == 1)
+      {
+         continue;
+      }
+
+      sProtocolBuffer buf;
+      ULONG logIdx = INVALID_LOG_INDEX;
+      if (DecodeRxFrame( pFrame, frameLen, buf, logIdx ) == false)
+      {
+         continue;
+      }
+
+      // Abort?
+      if (matcher.IsTxAbortResponse( buf ) == true)
+      {
+         bAbortTx = true;
+         continue;
+      }
+
+      // Is this the response we are looking for?
+      mInFlightRspID = INVALID_REQUEST_ID;
+      bool bRsp = matcher.IsResponse( buf );
+      if (CompleteRxFrame( bRsp, logIdx, rspIdx ) == true)
+      {
+         bRC = true;
+      }
+   }
+
+   return bRC;
+}
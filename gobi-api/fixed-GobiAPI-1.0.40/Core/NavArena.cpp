@@ -0,0 +1,246 @@
+/*===========================================================================
+FILE:
+   NavArena.cpp
+
+DESCRIPTION:
+   Implementation of cNavArena class
+
+PUBLIC CLASSES AND METHODS:
+   cNavArena
+      Monotonic allocator for the temporaries of a protocol entity 
+      navigation (names), released as a whole or back to a mark
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "StdAfx.h"
+#include "NavArena.h"
+
+//---------------------------------------------------------------------------
+// Definitions
+//---------------------------------------------------------------------------
+
+// Alignment of arena allocations
+const ULONG NAV_ARENA_ALIGN = sizeof( LONGLONG );
+
+/*=========================================================================*/
+// cNavArena Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   cNavArena (Public Method)
+
+DESCRIPTION:
+   Constructor
+
+PARAMETERS:
+   chunkSz     [ I ] - Size of a new chunk
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+cNavArena::cNavArena( ULONG chunkSz )
+   :  mChunkSz( chunkSz ),
+      mCurrent( 0 )
+{
+   if (mChunkSz < NAV_ARENA_ALIGN)
+   {
+      mChunkSz = NAV_ARENA_ALIGN;
+   }
+}
+
+/*===========================================================================
+METHOD:
+   ~cNavArena (Public Method)
+
+DESCRIPTION:
+   Destructor
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+cNavArena::~cNavArena()
+{
+   for (ULONG c = 0; c < (ULONG)mChunks.size(); c++)
+   {
+      delete [] mChunks[c].mpData;
+   }
+
+   mChunks.clear();
+}
+
+/*===========================================================================
+METHOD:
+   Allocate (Public Method)
+
+DESCRIPTION:
+   Allocate the given number of bytes, chunks beyond the current one 
+   (kept from before a release) are reused when large enough
+
+PARAMETERS:
+   sz          [ I ] - Number of bytes
+  
+RETURN VALUE:
+   PVOID - 0 upon failure
+===========================================================================*/
+PVOID cNavArena::Allocate( ULONG sz )
+{
+   // Round up to keep allocations aligned
+   sz = (sz + NAV_ARENA_ALIGN - 1) & ~(NAV_ARENA_ALIGN - 1);
+
+   while (mCurrent < (ULONG)mChunks.size())
+   {
+      sChunk & chunk = mChunks[mCurrent];
+      if (chunk.mSize - chunk.mUsed >= sz)
+      {
+         PVOID pMem = (PVOID)(chunk.mpData + chunk.mUsed);
+         chunk.mUsed += sz;
+         return pMem;
+      }
+
+      // Try the next chunk (if any)
+      if (mCurrent + 1 == (ULONG)mChunks.size())
+      {
+         break;
+      }
+
+      mCurrent++;
+      mChunks[mCurrent].mUsed = 0;
+   }
+
+   // A new chunk is required
+   sChunk chunk;
+   chunk.mSize = (sz > mChunkSz ? sz : mChunkSz);
+   chunk.mUsed = sz;
+   chunk.mpData = new BYTE[chunk.mSize];
+
+   mChunks.push_back( chunk );
+   mCurrent = (ULONG)mChunks.size() - 1;
+
+   return (PVOID)chunk.mpData;
+}
+
+/*===========================================================================
+METHOD:
+   MakeName (Public Method)
+
+DESCRIPTION:
+   Build a name from a prefix, separator, name, and suffix, the separator
+   is only used when both the prefix and name are not empty
+
+PARAMETERS:
+   prefix      [ I ] - Prefix (may be empty)
+   pSep        [ I ] - Separator
+   pName       [ I ] - Name (may be empty)
+   pSuffix     [ I ] - Suffix (may be empty)
+  
+RETURN VALUE:
+   sNavName
+===========================================================================*/
+sNavName cNavArena::MakeName(
+   const sNavName &           prefix,
+   LPCSTR                     pSep,
+   LPCSTR                     pName,
+   LPCSTR                     pSuffix )
+{
+   ULONG nameLen = (pName != 0 ? (ULONG)strlen( pName ) : 0);
+   ULONG sufLen = (pSuffix != 0 ? (ULONG)strlen( pSuffix ) : 0);
+
+   ULONG sepLen = 0;
+   if (prefix.mLen > 0 && nameLen > 0 && pSep != 0)
+   {
+      sepLen = (ULONG)strlen( pSep );
+   }
+
+   sNavName name;
+   ULONG len = prefix.mLen + sepLen + nameLen + sufLen;
+   if (len == 0)
+   {
+      return name;
+   }
+
+   LPSTR pBuf = (LPSTR)Allocate( len + 1 );
+
+   ULONG pos = 0;
+   memcpy( pBuf + pos, prefix.mpName, prefix.mLen );
+   pos += prefix.mLen;
+
+   if (sepLen > 0)
+   {
+      memcpy( pBuf + pos, pSep, sepLen );
+      pos += sepLen;
+   }
+
+   if (nameLen > 0)
+   {
+      memcpy( pBuf + pos, pName, nameLen );
+      pos += nameLen;
+   }
+
+   if (sufLen > 0)
+   {
+      memcpy( pBuf + pos, pSuffix, sufLen );
+      pos += sufLen;
+   }
+
+   pBuf[pos] = 0;
+
+   name.mpName = pBuf;
+   name.mLen = len;
+   return name;
+}
+
+/*===========================================================================
+METHOD:
+   Release (Public Method)
+
+DESCRIPTION:
+   Release all allocations made after the given mark (the chunks are 
+   kept for reuse)
+
+PARAMETERS:
+   mark        [ I ] - Mark returned by GetMark()
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+void cNavArena::Release( const sNavArenaMark & mark )
+{
+   if (mark.mChunk >= (ULONG)mChunks.size())
+   {
+      // Nothing was allocated after the mark
+      return;
+   }
+
+   mCurrent = mark.mChunk;
+   mChunks[mCurrent].mUsed = mark.mUsed;
+}
@@ -0,0 +1,180 @@
+/*===========================================================================
+FILE:
+   NavArena.h
+
+DESCRIPTION:
+   Declaration of cNavArena class
+
+PUBLIC CLASSES AND METHODS:
+   sNavName
+      View of a (NULL terminated) name string held in a cNavArena
+
+   cNavArena
+      Monotonic allocator for the temporaries of a protocol entity 
+      navigation (names), released as a whole or back to a mark
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Pragmas
+//---------------------------------------------------------------------------
+#pragma once
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "StdAfx.h"
+
+#include <vector>
+
+//---------------------------------------------------------------------------
+// Definitions
+//---------------------------------------------------------------------------
+
+// Default size of an arena chunk
+const ULONG NAV_ARENA_CHUNK_SZ = 1024;
+
+/*=========================================================================*/
+// Struct sNavName
+//
+//    View of a NULL terminated name string, the storage is owned by the
+//    cNavArena that produced it (or is a string literal)
+/*=========================================================================*/
+struct sNavName
+{
+   public:
+      // (Inline) Constructor - default (empty name)
+      sNavName()
+         :  mpName( "" ),
+            mLen( 0 )
+      { };
+
+      // (Inline) Is the name empty?
+      bool IsEmpty() const
+      {
+         return (mLen == 0);
+      };
+
+      /* The name */
+      LPCSTR mpName;
+
+      /* Length of the name (excluding the NULL) */
+      ULONG mLen;
+};
+
+/*=========================================================================*/
+// Struct sNavArenaMark
+//
+//    Position in a cNavArena that allocations can be released back to
+/*=========================================================================*/
+struct sNavArenaMark
+{
+   public:
+      // (Inline) Constructor - default (start of the arena)
+      sNavArenaMark()
+         :  mChunk( 0 ),
+            mUsed( 0 )
+      { };
+
+      /* Chunk index, and bytes used in that chunk */
+      ULONG mChunk;
+      ULONG mUsed;
+};
+
+/*=========================================================================*/
+// Class cNavArena
+//
+//    Monotonic (bump) allocator, memory is only released by Reset() or by
+//    releasing back to a mark, chunks are kept for reuse so steady state 
+//    navigation does not reach the heap
+//
+//    NOTE: Not thread safe, each navigator owns its own arena
+/*=========================================================================*/
+class cNavArena
+{
+   public:
+      // Constructor
+      cNavArena( ULONG chunkSz = NAV_ARENA_CHUNK_SZ );
+
+      // Destructor
+      ~cNavArena();
+
+      // Allocate the given number of bytes
+      PVOID Allocate( ULONG sz );
+
+      // Build a name from a prefix, separator, name, and suffix
+      sNavName MakeName(
+         const sNavName &           prefix,
+         LPCSTR                     pSep,
+         LPCSTR                     pName,
+         LPCSTR                     pSuffix = "" );
+
+      // (Inline) Get the current position
+      sNavArenaMark GetMark() const
+      {
+         sNavArenaMark mark;
+         mark.mChunk = mCurrent;
+         if (mCurrent < (ULONG)mChunks.size())
+         {
+            mark.mUsed = mChunks[mCurrent].mUsed;
+         }
+
+         return mark;
+      };
+
+      // Release all allocations made after the given mark
+      void Release( const sNavArenaMark & mark );
+
+      // (Inline) Release all allocations
+      void Reset()
+      {
+         Release( sNavArenaMark() );
+      };
+
+   protected:
+      /* A chunk of arena memory */
+      struct sChunk
+      {
+         PBYTE mpData;
+         ULONG mSize;
+         ULONG mUsed;
+      };
+
+      /* Size of a new chunk */
+      ULONG mChunkSz;
+
+      /* Chunks (in allocation order), and the chunk being used */
+      std::vector <sChunk> mChunks;
+      ULONG mCurrent;
+
+   private:
+      // Not copyable
+      cNavArena( const cNavArena & );
+      cNavArena & operator = ( const cNavArena & );
+};
@@ -0,0 +1,502 @@
+/*===========================================================================
+FILE:
+   ProfiledMutex.cpp
+
+DESCRIPTION:
+   Implementation of cProfiledMutex class
+   
+PUBLIC CLASSES AND METHODS:
+   cProfiledMutex
+      Mutex that can (opt-in, at run time) record acquisition wait time,
+      hold time and contended acquisitions under a lock name, all locks 
+      sharing a name are accounted together
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "StdAfx.h"
+#include "ProfiledMutex.h"
+
+#include <time.h>
+
+//---------------------------------------------------------------------------
+// Definitions
+//---------------------------------------------------------------------------
+
+// Maximum length of a lock name
+const ULONG MAX_LOCK_NAME_SZ = 32;
+
+/*=========================================================================*/
+// Struct sLockProfile
+//    Statistics of one lock name (counters updated atomically), these are
+//    never freed so locks may keep a pointer for their whole lifetime
+/*=========================================================================*/
+struct sLockProfile
+{
+   public:
+      /* Lock name */
+      CHAR mName[MAX_LOCK_NAME_SZ];
+
+      /* Acquisitions, and those that had to wait for another holder */
+      ULONG mAcquires;
+      ULONG mContended;
+
+      /* Time spent waiting to acquire the lock */
+      ULONGLONG mWaitTotal;
+      ULONGLONG mWaitMax;
+
+      /* Time the lock was held */
+      ULONGLONG mHoldTotal;
+      ULONGLONG mHoldMax;
+
+      /* Next lock name */
+      sLockProfile * mpNext;
+};
+
+// Is profiling on?
+static volatile bool gbLockProfiling = false;
+
+// Every lock name seen so far (protected by gLockProfilesSection)
+static sLockProfile * gpLockProfiles = 0;
+static pthread_mutex_t gLockProfilesSection = PTHREAD_MUTEX_INITIALIZER;
+
+/*=========================================================================*/
+// Free Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   GetLockTime (Free Method)
+
+DESCRIPTION:
+   Return the monotonic time in microseconds
+
+RETURN VALUE:
+   ULONGLONG
+===========================================================================*/
+static ULONGLONG GetLockTime()
+{
+   timespec now;
+   clock_gettime( CLOCK_MONOTONIC, &now );
+
+   return (ULONGLONG)now.tv_sec * 1000000LL + now.tv_nsec / 1000LL;
+}
+
+/*===========================================================================
+METHOD:
+   UpdateMax (Free Method)
+
+DESCRIPTION:
+   Atomically raise a maximum to the given value
+
+PARAMETERS:
+   pMax        [I/O] - Maximum being updated
+   val         [ I ] - New value
+
+RETURN VALUE:
+   None
+===========================================================================*/
+static void UpdateMax( 
+   ULONGLONG *                pMax,
+   ULONGLONG                  val )
+{
+   ULONGLONG curMax = *pMax;
+   while (val > curMax)
+   {
+      ULONGLONG prevMax = __sync_val_compare_and_swap( pMax, curMax, val );
+      if (prevMax == curMax)
+      {
+         break;
+      }
+
+      curMax = prevMax;
+   }
+}
+
+/*===========================================================================
+METHOD:
+   CompareLockStats (Free Method)
+
+DESCRIPTION:
+   Order lock statistics worst offender first (most time spent waiting,
+   then most contended acquisitions)
+
+PARAMETERS:
+   a           [ I ] - First statistics
+   b           [ I ] - Second statistics
+
+RETURN VALUE:
+   bool - Does a come before b?
+===========================================================================*/
+static bool CompareLockStats(
+   const sLockStats &         a,
+   const sLockStats &         b )
+{
+   if (a.mWaitTotal != b.mWaitTotal)
+   {
+      return (a.mWaitTotal > b.mWaitTotal);
+   }
+
+   return (a.mContended > b.mContended);
+}
+
+/*=========================================================================*/
+// cProfiledMutex Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   cProfiledMutex (Public Method)
+
+DESCRIPTION:
+   Constructor
+
+PARAMETERS:
+   pName       [ I ] - Name the lock is accounted under (0 for none)
+
+RETURN VALUE:
+   None
+===========================================================================*/
+cProfiledMutex::cProfiledMutex( LPCSTR pName )
+   :  mpProfile( 0 ),
+      mAcquireTime( 0 )
+{
+   int nRet = pthread_mutex_init( &mMutex, NULL );
+   if (nRet != 0)
+   {
+      TRACE( "ProfiledMutex: Unable to init mutex. Error %d: %s\n",
+             nRet,
+             strerror( nRet ) );
+   }
+
+   SetName( pName );
+}
+
+/*===========================================================================
+METHOD:
+   ~cProfiledMutex (Public Method)
+
+DESCRIPTION:
+   Destructor
+
+RETURN VALUE:
+   None
+===========================================================================*/
+cProfiledMutex::~cProfiledMutex()
+{
+   int nRet = pthread_mutex_destroy( &mMutex );
+   if (nRet != 0)
+   {
+      TRACE( "ProfiledMutex: Unable to destroy mutex. Error %d: %s\n",
+             nRet,
+             strerror( nRet ) );
+   }
+}
+
+/*===========================================================================
+METHOD:
+   SetName (Public Method)
+
+DESCRIPTION:
+   Set the name the lock is accounted under, must be called before the
+   lock is first used
+
+PARAMETERS:
+   pName       [ I ] - Lock name (0 for none, truncated if too long)
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cProfiledMutex::SetName( LPCSTR pName )
+{
+   mpProfile = 0;
+   if (pName == 0 || pName[0] == 0)
+   {
+      return;
+   }
+
+   pthread_mutex_lock( &gLockProfilesSection );
+
+   // Existing lock name?
+   sLockProfile * pProfile = gpLockProfiles;
+   while (pProfile != 0)
+   {
+      if (strncmp( pProfile->mName, pName, MAX_LOCK_NAME_SZ - 1 ) == 0)
+      {
+         break;
+      }
+
+      pProfile = pProfile->mpNext;
+   }
+
+   if (pProfile == 0)
+   {
+      pProfile = new sLockProfile;
+      memset( pProfile, 0, sizeof( sLockProfile ) );
+      strncpy( pProfile->mName, pName, MAX_LOCK_NAME_SZ - 1 );
+
+      pProfile->mpNext = gpLockProfiles;
+      gpLockProfiles = pProfile;
+   }
+
+   mpProfile = pProfile;
+
+   pthread_mutex_unlock( &gLockProfilesSection );
+}
+
+/*===========================================================================
+METHOD:
+   Lock (Public Method)
+
+DESCRIPTION:
+   Lock the mutex, when profiling an uncontended acquisition costs one
+   extra trylock and clock read
+
+RETURN VALUE:
+   int - pthread error code
+===========================================================================*/
+int cProfiledMutex::Lock()
+{
+   if (mpProfile == 0 || gbLockProfiling == false)
+   {
+      return pthread_mutex_lock( &mMutex );
+   }
+
+   ULONGLONG waitTime = 0;
+   bool bContended = false;
+
+   int nRet = pthread_mutex_trylock( &mMutex );
+   if (nRet == EBUSY)
+   {
+      bContended = true;
+      ULONGLONG start = GetLockTime();
+
+      nRet = pthread_mutex_lock( &mMutex );
+      if (nRet != 0)
+      {
+         return nRet;
+      }
+
+      mAcquireTime = GetLockTime();
+      waitTime = mAcquireTime - start;
+   }
+   else if (nRet == 0)
+   {
+      mAcquireTime = GetLockTime();
+   }
+   else
+   {
+      return nRet;
+   }
+
+   __sync_fetch_and_add( &mpProfile->mAcquires, 1 );
+   if (bContended == true)
+   {
+      __sync_fetch_and_add( &mpProfile->mContended, 1 );
+      __sync_fetch_and_add( &mpProfile->mWaitTotal, waitTime );
+      UpdateMax( &mpProfile->mWaitMax, waitTime );
+   }
+
+   return 0;
+}
+
+/*===========================================================================
+METHOD:
+   Unlock (Public Method)
+
+DESCRIPTION:
+   Unlock the mutex
+
+RETURN VALUE:
+   int - pthread error code
+===========================================================================*/
+int cProfiledMutex::Unlock()
+{
+   // Was this acquisition profiled? (we still hold the lock here)
+   if (mAcquireTime != 0)
+   {
+      ULONGLONG holdTime = GetLockTime() - mAcquireTime;
+      mAcquireTime = 0;
+
+      __sync_fetch_and_add( &mpProfile->mHoldTotal, holdTime );
+      UpdateMax( &mpProfile->mHoldMax, holdTime );
+   }
+
+   return pthread_mutex_unlock( &mMutex );
+}
+
+/*===========================================================================
+METHOD:
+   SetProfiling (Static Public Method)
+
+DESCRIPTION:
+   Turn profiling of every named lock on or off
+
+PARAMETERS:
+   bEnable     [ I ] - Profile locks?
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cProfiledMutex::SetProfiling( bool bEnable )
+{
+   gbLockProfiling = bEnable;
+   __sync_synchronize();
+}
+
+/*===========================================================================
+METHOD:
+   GetLockStats (Static Public Method)
+
+DESCRIPTION:
+   Return the statistics of every lock name, worst offenders (most time 
+   spent waiting to acquire the lock) first
+
+PARAMETERS:
+   maxLocks    [ I ] - Maximum number of lock names to return (0 = all)
+
+RETURN VALUE:
+   std::vector <sLockStats>
+===========================================================================*/
+std::vector <sLockStats> cProfiledMutex::GetLockStats( ULONG maxLocks )
+{
+   std::vector <sLockStats> stats;
+
+   pthread_mutex_lock( &gLockProfilesSection );
+
+   sLockProfile * pProfile = gpLockProfiles;
+   while (pProfile != 0)
+   {
+      sLockStats entry;
+      entry.mName = pProfile->mName;
+      entry.mAcquires = __sync_fetch_and_add( &pProfile->mAcquires, 0 );
+      entry.mContended = __sync_fetch_and_add( &pProfile->mContended, 0 );
+      entry.mWaitTotal = __sync_fetch_and_add( &pProfile->mWaitTotal, 0 );
+      entry.mWaitMax = __sync_fetch_and_add( &pProfile->mWaitMax, 0 );
+      entry.mHoldTotal = __sync_fetch_and_add( &pProfile->mHoldTotal, 0 );
+      entry.mHoldMax = __sync_fetch_and_add( &pProfile->mHoldMax, 0 );
+
+      // Skip locks that were never acquired while profiling
+      if (entry.mAcquires > 0)
+      {
+         stats.push_back( entry );
+      }
+
+      pProfile = pProfile->mpNext;
+   }
+
+   pthread_mutex_unlock( &gLockProfilesSection );
+
+   std::sort( stats.begin(), stats.end(), CompareLockStats );
+   if (maxLocks > 0 && (ULONG)stats.size() > maxLocks)
+   {
+      stats.resize( maxLocks );
+   }
+
+   return stats;
+}
+
+/*===========================================================================
+METHOD:
+   ResetLockStats (Static Public Method)
+
+DESCRIPTION:
+   Reset the statistics of every lock name (acquisitions in progress may
+   still be accounted afterwards)
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cProfiledMutex::ResetLockStats()
+{
+   pthread_mutex_lock( &gLockProfilesSection );
+
+   sLockProfile * pProfile = gpLockProfiles;
+   while (pProfile != 0)
+   {
+      __sync_lock_test_and_set( &pProfile->mAcquires, 0 );
+      __sync_lock_test_and_set( &pProfile->mContended, 0 );
+      __sync_lock_test_and_set( &pProfile->mWaitTotal, 0 );
+      __sync_lock_test_and_set( &pProfile->mWaitMax, 0 );
+      __sync_lock_test_and_set( &pProfile->mHoldTotal, 0 );
+      __sync_lock_test_and_set( &pProfile->mHoldMax, 0 );
+
+      pProfile = pProfile->mpNext;
+   }
+
+   pthread_mutex_unlock( &gLockProfilesSection );
+}
+
+/*===========================================================================
+METHOD:
+   Format (Static Public Method)
+
+DESCRIPTION:
+   Format the statistics of one lock name as a line of text
+
+PARAMETERS:
+   stats       [ I ] - Lock statistics
+
+RETURN VALUE:
+   std::string
+===========================================================================*/
+std::string cProfiledMutex::Format( const sLockStats & stats )
+{
+   ULONGLONG holdAvg = 0;
+   if (stats.mAcquires > 0)
+   {
+      holdAvg = stats.mHoldTotal / stats.mAcquires;
+   }
+
+   ULONGLONG waitAvg = 0;
+   if (stats.mContended > 0)
+   {
+      waitAvg = stats.mWaitTotal / stats.mContended;
+   }
+
+   CHAR line[256];
+   snprintf( line, 
+             sizeof( line ), 
+             "lock %s: acquires %lu contended %lu "
+             "wait total/avg/max %llu/%llu/%llu us "
+             "hold total/avg/max %llu/%llu/%llu us",
+             stats.mName.c_str(),
+             stats.mAcquires,
+             stats.mContended,
+             stats.mWaitTotal,
+             waitAvg,
+             stats.mWaitMax,
+             stats.mHoldTotal,
+             holdAvg,
+             stats.mHoldMax );
+
+   return line;
+}
@@ -0,0 +1,140 @@
+/*===========================================================================
+FILE:
+   ProfiledMutex.h
+
+DESCRIPTION:
+   Declaration of cProfiledMutex class
+   
+PUBLIC CLASSES AND METHODS:
+   cProfiledMutex
+      Mutex that can (opt-in, at run time) record acquisition wait time,
+      hold time and contended acquisitions under a lock name, all locks 
+      sharing a name are accounted together
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Pragmas
+//---------------------------------------------------------------------------
+#pragma once
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "StdAfx.h"
+
+#include <pthread.h>
+#include <string>
+#include <vector>
+
+//---------------------------------------------------------------------------
+// Forward Declarations
+//---------------------------------------------------------------------------
+struct sLockProfile;
+
+/*=========================================================================*/
+// Struct sLockStats
+//    Snapshot of the statistics of one lock name (microseconds)
+/*=========================================================================*/
+struct sLockStats
+{
+   public:
+      /* Lock name */
+      std::string mName;
+
+      /* Acquisitions, and those that had to wait for another holder */
+      ULONG mAcquires;
+      ULONG mContended;
+
+      /* Time spent waiting to acquire the lock */
+      ULONGLONG mWaitTotal;
+      ULONGLONG mWaitMax;
+
+      /* Time the lock was held */
+      ULONGLONG mHoldTotal;
+      ULONGLONG mHoldMax;
+};
+
+/*=========================================================================*/
+// Class cProfiledMutex
+//    Wrapper around a (non-recursive) pthread mutex
+/*=========================================================================*/
+class cProfiledMutex
+{
+   public:
+      // Constructor
+      cProfiledMutex( LPCSTR pName = 0 );
+
+      // Destructor
+      ~cProfiledMutex();
+
+      // Set the name the lock is accounted under (before first use)
+      void SetName( LPCSTR pName );
+
+      // Lock the mutex (returns a pthread error code)
+      int Lock();
+
+      // Unlock the mutex (returns a pthread error code)
+      int Unlock();
+
+      // (Inline) Return the underlying mutex
+      pthread_mutex_t * GetMutex()
+      {
+         return &mMutex;
+      };
+
+      // Turn profiling of every named lock on or off (off by default)
+      static void SetProfiling( bool bEnable );
+
+      // Return the statistics of every lock name, worst offenders (most
+      // time spent waiting) first, optionally limited to maxLocks entries
+      static std::vector <sLockStats> GetLockStats( ULONG maxLocks = 0 );
+
+      // Reset the statistics of every lock name
+      static void ResetLockStats();
+
+      // Format the statistics of one lock name as a line of text
+      static std::string Format( const sLockStats & stats );
+
+   protected:
+      /* Underlying mutex */
+      pthread_mutex_t mMutex;
+
+      /* Statistics of the lock name (0 when unnamed) */
+      sLockProfile * mpProfile;
+
+      /* Time (microseconds) the current holder acquired the lock (0 when
+         the acquisition was not profiled) */
+      ULONGLONG mAcquireTime;
+
+   private:
+      // Not copyable
+      cProfiledMutex( const cProfiledMutex & );
+      cProfiledMutex & operator = ( const cProfiledMutex & );
+};
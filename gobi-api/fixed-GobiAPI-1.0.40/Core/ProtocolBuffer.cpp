@@ -51,6 +51,28 @@ POSSIBILITY OF SUCH DAMAGE.
 // Definitions
 //---------------------------------------------------------------------------
 
+/*===========================================================================
+METHOD:
+   GetMonotonicTime (Free Method)
+
+DESCRIPTION:
+   Return the current time of the monotonic clock, the protocol buffer
+   timestamps and the protocol server latency measurements use this
+
+RETURN VALUE:
+   ULONGLONG - Time in nanoseconds
+===========================================================================*/
+ULONGLONG GetMonotonicTime()
+{
+   timespec now;
+   if (clock_gettime( CLOCK_MONOTONIC, &now ) != 0)
+   {
+      return 0;
+   }
+
+   return (ULONGLONG)now.tv_sec * 1000000000ULL + (ULONGLONG)now.tv_nsec;
+}
+
 /*=========================================================================*/
 // sProtocolBuffer Methods
 /*=========================================================================*/
@@ -67,10 +89,10 @@ RETURN VALUE:
 ===========================================================================*/
 sProtocolBuffer::sProtocolBuffer()
    :  mpData( 0 ),
+      mTimestamp( 0 ),
       mbValid( false )
 {
    // Object is currently invalid
-   mTimestamp = EMPTY_TIME;
 }
 
 /*===========================================================================
@@ -88,18 +110,9 @@ RETURN VALUE:
 ===========================================================================*/
 sProtocolBuffer::sProtocolBuffer( sSharedBuffer * pBuffer )
    :  mpData( 0 ),
+      mTimestamp( GetMonotonicTime() ),
       mbValid( false )
 {
-   mTimestamp = EMPTY_TIME;
- 
-   time_t rawtime;
-   time( &rawtime );
-   tm * timestamp = localtime( &rawtime );
-   if (timestamp != 0)
-   {
-      mTimestamp = *timestamp;
-   }
-
    if (mpData != 0 && mpData->IsValid() == true)
    {
       mpData->Release();
@@ -167,22 +180,14 @@ RETURN VALUE:
 ===========================================================================*/
 sProtocolBuffer & sProtocolBuffer::operator = ( const sProtocolBuffer & copyThis )
 {
-   // Do we already have data?
-   if (mpData != 0)
-   {
-      // Is it different than what we are duplicating?
-      if (mpData != copyThis.mpData)
-      {
-         // Yes, release our current buffer
-         mpData->Release();
-      }
-   }
+   // Bump reference count for the new shared buffer first, this keeps
+   // self (or same buffer) assignment from releasing the last reference
+   sSharedBuffer * pOldData = mpData;
 
    mpData     = copyThis.mpData;
    mTimestamp = copyThis.mTimestamp;
    mbValid    = copyThis.mbValid;
 
-   // Bump reference count for shared buffer
    if (mpData != 0 && mpData->IsValid() == true)
    {
       mpData->AddRef();
@@ -193,9 +198,77 @@ sProtocolBuffer & sProtocolBuffer::operator = ( const sProtocolBuffer & copyThis
       mbValid = false;
    }
 
+   // Release our previous buffer
+   if (pOldData != 0)
+   {
+      pOldData->Release();
+   }
+
    return *this;
 }
 
+#if __cplusplus >= 201103L
+/*===========================================================================
+METHOD:
+   sProtocolBuffer (Public Method)
+
+DESCRIPTION:
+   Move constructor, assumes the reference held by the passed in object
+   (no reference count traffic)
+
+PARAMETERS:
+   moveThis    [I/O] - sProtocolBuffer to take the shared buffer from
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+sProtocolBuffer::sProtocolBuffer( sProtocolBuffer && moveThis )
+   :  mpData( moveThis.mpData ),
+      mTimestamp( moveThis.mTimestamp ),
+      mbValid( moveThis.mbValid )
+{
+   moveThis.mpData = 0;
+   moveThis.mbValid = false;
+}
+
+/*===========================================================================
+METHOD:
+   operator = (Public Method)
+
+DESCRIPTION:
+   Move assignment operator, assumes the reference held by the passed in
+   object (no reference count traffic)
+
+PARAMETERS:
+   moveThis    [I/O] - sProtocolBuffer to take the shared buffer from
+
+RETURN VALUE:
+   sProtocolBuffer &
+===========================================================================*/
+sProtocolBuffer & sProtocolBuffer::operator = ( sProtocolBuffer && moveThis )
+{
+   if (this == &moveThis)
+   {
+      return *this;
+   }
+
+   // Release our current buffer
+   if (mpData != 0)
+   {
+      mpData->Release();
+   }
+
+   mpData     = moveThis.mpData;
+   mTimestamp = moveThis.mTimestamp;
+   mbValid    = moveThis.mbValid;
+
+   moveThis.mpData = 0;
+   moveThis.mbValid = false;
+
+   return *this;
+}
+#endif
+
 /*===========================================================================
 METHOD:
    ~sProtocolBuffer (Public Method)
@@ -220,3 +293,38 @@ sProtocolBuffer::~sProtocolBuffer()
 
    mbValid = false;
 }
+
+/*===========================================================================
+METHOD:
+   GetTimestamp (Public Method)
+
+DESCRIPTION:
+   Return the (local, wall clock) time the buffer was created, as derived
+   from the monotonic creation timestamp
+
+RETURN VALUE:
+   tm - EMPTY_TIME if the buffer is invalid
+===========================================================================*/
+tm sProtocolBuffer::GetTimestamp() const
+{
+   tm ft = EMPTY_TIME;
+   if (IsValid() == false)
+   {
+      return ft;
+   }
+
+   // How long ago was the buffer created?
+   ULONGLONG age = 0;
+   ULONGLONG now = GetMonotonicTime();
+   if (now > mTimestamp)
+   {
+      age = now - mTimestamp;
+   }
+
+   time_t rawtime;
+   time( &rawtime );
+   rawtime -= (time_t)(age / 1000000000ULL);
+
+   localtime_r( &rawtime, &ft );
+   return ft;
+}
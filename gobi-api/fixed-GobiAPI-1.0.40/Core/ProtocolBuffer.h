@@ -54,6 +54,10 @@ POSSIBILITY OF SUCH DAMAGE.
 
 static const tm EMPTY_TIME = { 0, 0, 0, 0, 0, 0, 0, 0, 0 }; 
 
+// Return the current time of the monotonic clock (nanoseconds), buffers
+// are stamped with this
+ULONGLONG GetMonotonicTime();
+
 /*=========================================================================*/
 // Struct sProtocolBuffer
 /*=========================================================================*/
@@ -72,6 +76,14 @@ struct sProtocolBuffer
       // Assignment operator
       sProtocolBuffer & operator = ( const sProtocolBuffer & copyThis );
 
+#if __cplusplus >= 201103L
+      // Move constructor
+      sProtocolBuffer( sProtocolBuffer && moveThis );
+
+      // Move assignment operator
+      sProtocolBuffer & operator = ( sProtocolBuffer && moveThis );
+#endif
+
       // Destructor
       virtual ~sProtocolBuffer();
 
@@ -123,17 +135,20 @@ struct sProtocolBuffer
          return pRet;
       };
 
-      // (Inline) Return the timestamp
-      tm GetTimestamp() const
+      // Return the (local, wall clock) time the buffer was created
+      tm GetTimestamp() const;
+
+      // (Inline) Return the monotonic time (nanoseconds) the buffer was
+      // created at
+      ULONGLONG GetMonotonicTimestamp() const
       {
-         tm ft = EMPTY_TIME;
-         
+         ULONGLONG ts = 0;
          if (IsValid() == true)
          {
-            ft = mTimestamp;
-         }   
+            ts = mTimestamp;
+         }
 
-         return ft;
+         return ts;
       };
 
       // (Inline) Is this buffer valid?
@@ -154,8 +169,8 @@ struct sProtocolBuffer
       /* Our data buffer */
       sSharedBuffer * mpData;
 
-      /* Time buffer was created */
-      tm mTimestamp;
+      /* Time buffer was created (monotonic clock, nanoseconds) */
+      ULONGLONG mTimestamp;
 
       /* Has this buffer been validated? (NOTE: *NOT* set in base) */
       bool mbValid;
@@ -11,6 +11,9 @@ PUBLIC CLASSES AND METHODS:
       field IDs, i.e. every field referenced by this protocol entity
       in the exact order it would regularly be found
 
+      NOTE: cCoreDatabase::GetEntityFieldList() keeps the results of
+      this per protocol entity, use that rather than enumerating again
+
       NOTE: This only functions for fixed structures such as NV items
 
 Copyright (c) 2011, Code Aurora Forum. All rights reserved.
@@ -93,6 +96,13 @@ class cProtocolEntityFieldEnumerator : public cProtocolEntityNav
          return mFields;
       };
 
+      // (Inline) Return fully qualified field names (in the same order
+      // as the fields)
+      const std::vector <std::string> & GetFieldNames() const
+      {
+         return mFieldNames;
+      };
+
    protected:     
       // (Inline) Evaluate the given condition
       virtual bool EvaluateCondition( 
@@ -104,6 +114,16 @@ class cProtocolEntityFieldEnumerator : public cProtocolEntityNav
          return bResult;
       };
 
+      // (Inline) Evaluate the given (parsed) condition
+      virtual bool EvaluateCondition( 
+         const sDB2SimpleCondition &   /* con */,
+         bool &                        bResult )
+      {
+         // All conditions pass
+         bResult = true;
+         return bResult;
+      };
+
       // Return the value for the specified field ID as a
       // LONGLONG (field type must be able to fit)
       virtual bool GetLastValue( 
@@ -119,12 +139,13 @@ class cProtocolEntityFieldEnumerator : public cProtocolEntityNav
       // Process the given field 
       virtual bool ProcessField(
          const sDB2Field *          pField,
-         const std::string &            /* fieldName */,
+         const std::string &        fieldName,
          LONGLONG                   /* arrayIndex = -1 */ )
       {
          if (pField != 0)
          {
             mFields.push_back( pField->mID );
+            mFieldNames.push_back( GetFullFieldName( fieldName ) );
          }
 
          return true;
@@ -136,4 +157,7 @@ class cProtocolEntityFieldEnumerator : public cProtocolEntityNav
 
       /* Fields (by ID) */
       std::vector <ULONG> mFields;
+
+      /* Fully qualified field names */
+      std::vector <std::string> mFieldNames;
 };
@@ -78,9 +78,10 @@ cProtocolEntityNav::cProtocolEntityNav( const cCoreDatabase & db )
    :  mDB( db ),
       mbFieldNames( true ),
       mConditions( db.GetOptionalMods() ),
-      mExpressions( db.GetExpressionMods() ),
-      mArrays1( db.GetArray1Mods() ),
-      mArrays2( db.GetArray2Mods() )
+      mpProgram( 0 ),
+      mPC( 0 ),
+      mFieldIndex( 0 ),
+      mbSuspended( false )
 {
    // Nothing to do
 }
@@ -128,36 +129,59 @@ bool cProtocolEntityNav::EvaluateCondition(
 
    if (pIter != mConditions.end())
    {
-      const sDB2SimpleCondition & con = pIter->second;
+      bRC = EvaluateCondition( pIter->second, bResult );
+   }
 
-      // Grab the value for the given field ID
-      LONGLONG valA = 0;
-      bRC = GetLastValue( con.mID, valA );
+   return bRC;
+}
 
-      // Field to field?
-      LONGLONG valB = con.mValue;
-      if (con.mbF2F == true)
-      {
-         // Yes, grab value of the second field
-         bRC &= GetLastValue( (ULONG)con.mValue, valB );
-      }
+/*===========================================================================
+METHOD:
+   EvaluateCondition (Internal Method)
 
-      if (bRC == true)
-      {
-         bResult = sDB2Fragment::EvaluateCondition( valA, 
-                                                    con.mOperator, 
-                                                    valB );
-      }
-      else
-      {
-         // We could not find the field used in the condition, this
-         // can either be because of a bad entity (which is ruled
-         // out prior to reaching this point) or the existence of
-         // the field itself is based on another condition.  The 
-         // former should not happen and the later is not an error         
-         bResult = false;
-         bRC = true;
-      }
+DESCRIPTION:
+   Evaluate the given (parsed) condition
+  
+PARAMETERS:
+   con         [ I ] - Condition to evaluate
+   bResult     [ O ] - Result of evaluating the condition (true/false)
+
+RETURN VALUE:
+   bool :
+      true  - We were able to evaluate the condition
+      false - Unable to evaluate condition
+===========================================================================*/
+bool cProtocolEntityNav::EvaluateCondition( 
+   const sDB2SimpleCondition &   con,
+   bool &                        bResult )
+{
+   // Grab the value for the given field ID
+   LONGLONG valA = 0;
+   bool bRC = GetLastValue( con.mID, valA );
+
+   // Field to field?
+   LONGLONG valB = con.mValue;
+   if (con.mbF2F == true)
+   {
+      // Yes, grab value of the second field
+      bRC &= GetLastValue( (ULONG)con.mValue, valB );
+   }
+
+   if (bRC == true)
+   {
+      bResult = sDB2Fragment::EvaluateCondition( valA, 
+                                                 con.mOperator, 
+                                                 valB );
+   }
+   else
+   {
+      // We could not find the field used in the condition, this
+      // can either be because of a bad entity (which is ruled
+      // out prior to reaching this point) or the existence of
+      // the field itself is based on another condition.  The 
+      // former should not happen and the later is not an error         
+      bResult = false;
+      bRC = true;
    }
 
    return bRC;
@@ -172,6 +196,7 @@ DESCRIPTION:
 
 PARAMETERS:
    frag        [ I ] - Fragment descriptor
+   pModifier   [ I ] - Parsed fragment modifier
    arraySz     [ O ] - Size of array
    arrayAdj    [ O ] - Adjust for array indices 
   
@@ -179,9 +204,10 @@ RETURN VALUE:
    bool
 ===========================================================================*/
 bool cProtocolEntityNav::GetArrayBounds( 
-   const sDB2Fragment &       frag,
-   LONGLONG &                 arraySz,
-   LONGLONG &                 arrayAdj )
+   const sDB2Fragment &          frag,
+   const sDB2FragmentModifier *  pModifier,
+   LONGLONG &                    arraySz,
+   LONGLONG &                    arrayAdj )
 {
    // Assume failure
    bool bRC = false;
@@ -190,39 +216,33 @@ bool cProtocolEntityNav::GetArrayBounds(
    arraySz = 0;
    arrayAdj = 0;
 
+   if (pModifier == 0)
+   {
+      // Modifier could not be parsed
+      return bRC;
+   }
+
    switch (frag.mModifierType)
    {
       case eDB2_MOD_CONSTANT_ARRAY:
       {
-         tDB2Array1ModMap::const_iterator pIter;
-         pIter = mArrays1.find( frag.mpModifierValue );
-
-         if (pIter != mArrays1.end())
-         {
-            arraySz = (LONGLONG)pIter->second;
-            bRC = true;
-         }
+         arraySz = (LONGLONG)pModifier->mValue;
+         bRC = true;
       }
       break;
 
       case eDB2_MOD_VARIABLE_ARRAY:      
       {
-         tDB2Array1ModMap::const_iterator pIter;
-         pIter = mArrays1.find( frag.mpModifierValue );
+         ULONG id = pModifier->mValue;
 
-         if (pIter != mArrays1.end())
+         // Now find last occurence of this field ID and grab the value
+         bRC = GetLastValue( id, arraySz );                
+         if (bRC == true)
          {
-            ULONG id = pIter->second;
-
-            // Now find last occurence of this field ID and grab the value
-            bRC = GetLastValue( id, arraySz );                
-            if (bRC == true)
-            {
-               // It makes no sense to have a negative sized array
-               if (arraySz < 0)
-               {          
-                  bRC = false;
-               }
+            // It makes no sense to have a negative sized array
+            if (arraySz < 0)
+            {          
+               bRC = false;
             }
          }
       }
@@ -230,33 +250,27 @@ bool cProtocolEntityNav::GetArrayBounds(
 
       case eDB2_MOD_VARIABLE_ARRAY2:
       {
-         tDB2Array2ModMap::const_iterator pIter;
-         pIter = mArrays2.find( frag.mpModifierValue );
-
-         if (pIter != mArrays2.end())
-         {
-            ULONG sID = pIter->second.first;
-            ULONG eID = pIter->second.second;
+         ULONG sID = pModifier->mValue;
+         ULONG eID = pModifier->mStopID;
 
-            LONGLONG s;
-            LONGLONG e;
+         LONGLONG s;
+         LONGLONG e;
 
-            // Now find last occurence of these field IDs and
-            // grab the values
-            bRC = GetLastValue( sID, s );
-            bRC &= GetLastValue( eID, e );
-            if (bRC == true)
+         // Now find last occurence of these field IDs and
+         // grab the values
+         bRC = GetLastValue( sID, s );
+         bRC &= GetLastValue( eID, e );
+         if (bRC == true)
+         {
+            // It makes no sense to have an negative sized array
+            if (e < s)
+            {          
+               bRC = false;
+            }
+            else
             {
-               // It makes no sense to have an negative sized array
-               if (e < s)
-               {          
-                  bRC = false;
-               }
-               else
-               {
-                  arrayAdj = s;
-                  arraySz = (e - s) + 1;
-               }
+               arrayAdj = s;
+               arraySz = (e - s) + 1;
             }
          }
       }
@@ -264,37 +278,31 @@ bool cProtocolEntityNav::GetArrayBounds(
 
       case eDB2_MOD_VARIABLE_ARRAY3:
       {
-         tDB2ExpressionModMap::const_iterator pIter;
-         pIter = mExpressions.find( frag.mpModifierValue );
-
-         if (pIter != mExpressions.end())
-         {
-            const sDB2SimpleExpression & expr = pIter->second;
+         const sDB2SimpleExpression & expr = pModifier->mExpression;
 
-            // Grab the value for the given field ID
-            LONGLONG valA = 0;
-            bRC = GetLastValue( expr.mID, valA );
+         // Grab the value for the given field ID
+         LONGLONG valA = 0;
+         bRC = GetLastValue( expr.mID, valA );
 
-            // Field to field?
-            LONGLONG valB = expr.mValue;
-            if (expr.mbF2F == true)
-            {
-               // Yes, grab value of the second field
-               bRC &= GetLastValue( (ULONG)expr.mValue, valB );
-            }
+         // Field to field?
+         LONGLONG valB = expr.mValue;
+         if (expr.mbF2F == true)
+         {
+            // Yes, grab value of the second field
+            bRC &= GetLastValue( (ULONG)expr.mValue, valB );
+         }
 
-            if (bRC == true)
-            {
-               bRC = sDB2Fragment::EvaluateExpression( valA, 
-                                                       expr.mOperator, 
-                                                       valB,
-                                                       arraySz );
-
-               // It makes no sense to have a negative sized array
-               if (bRC == true && arraySz < 0)
-               {          
-                  bRC = false;
-               }
+         if (bRC == true)
+         {
+            bRC = sDB2Fragment::EvaluateExpression( valA, 
+                                                    expr.mOperator, 
+                                                    valB,
+                                                    arraySz );
+
+            // It makes no sense to have a negative sized array
+            if (bRC == true && arraySz < 0)
+            {          
+               bRC = false;
             }
          }
       }
@@ -314,14 +322,16 @@ DESCRIPTION:
 
 PARAMETERS:
    frag        [ I ] - Fragment descriptor
+   pModifier   [ I ] - Parsed fragment modifier
    field       [ O ] - Field to modify
   
 RETURN VALUE:
    bool
 ===========================================================================*/
 bool cProtocolEntityNav::ModifyStringLength( 
-   const sDB2Fragment &       frag,
-   sDB2Field &                field )
+   const sDB2Fragment &          frag,
+   const sDB2FragmentModifier *  pModifier,
+   sDB2Field &                   field )
 {
    // Assume failure
    bool bRC = false;
@@ -351,15 +361,13 @@ bool cProtocolEntityNav::ModifyStringLength(
       return false;
    }
 
-   tDB2Array1ModMap::const_iterator pIter;
-   pIter = mArrays1.find( frag.mpModifierValue );
-   if (pIter == mArrays1.end())
+   if (pModifier == 0)
    {
       // Unable to obtain string length
       return bRC;
    }
 
-   ULONG id = pIter->second;
+   ULONG id = pModifier->mValue;
 
    // Now find last occurence of this field ID and grab the value
    LONGLONG strSz;
@@ -459,11 +467,11 @@ bool cProtocolEntityNav::ProcessEntity( const std::vector <ULONG> & key )
       return bRC;
    }
 
-   // Grab navigation fragments   
-   const std::list <sDB2NavFragment *> & frags = pNavTree->GetFragments();
+   // Grab navigation program
+   const std::vector <sDB2NavInstruction> & program = pNavTree->GetProgram();
 
    // Nothing to navigate?
-   if (frags.size() == 0)
+   if (program.size() == 0)
    {
       ASSERT( 0 );
       return bRC;
@@ -476,188 +484,470 @@ bool cProtocolEntityNav::ProcessEntity( const std::vector <ULONG> & key )
       return bRC;
    }
 
-   // Grab tracked fields
-   mTrackedFields = pNavTree->GetTrackedFields();
+   // Grab tracked fields (flattened, the map is ordered by field ID)
+   const std::map <ULONG, std::pair <bool, LONGLONG> > & tracked = 
+      pNavTree->GetTrackedFields();
 
-   std::string preamble = "";
+   mTrackedFields.clear();
+   mTrackedFields.reserve( tracked.size() );
+
+   std::map <ULONG, std::pair <bool, LONGLONG> >::const_iterator pTF;
+   for (pTF = tracked.begin(); pTF != tracked.end(); pTF++)
+   {
+      sPENavTrackedField tf;
+      tf.mID = pTF->first;
+      tf.mbValid = pTF->second.first;
+      tf.mValue = pTF->second.second;
+      mTrackedFields.push_back( tf );
+   }
 
    // Process the initial structure
    EnterStruct( mEntity.mpName, -1 );
-   bRC = ProcessStruct( frags.front(), preamble, -1 );
-   ExitStruct( mEntity.mpName, -1 );
+   bRC = ProcessProgram( program );
+
+   // A suspended program exits the structure once it is resumed
+   if (mbSuspended == false)
+   {
+      ExitStruct( mEntity.mpName, -1 );
+   }
    
    return bRC;
 }
 
 /*===========================================================================
 METHOD:
-   ProcessStruct (Internal Method)
+   ProcessProgram (Internal Method)
 
 DESCRIPTION:
-   Process a structure described by the given initial fragment
+   Run the navigation program of the protocol entity, structures (and
+   structure arrays) are handled iteratively using a stack of frames
+   rather than by recursion
 
 PARAMETERS:
-   pFrag       [ I ] - First fragment in structure
-   preamable   [ I ] - String to prepend to any field/struct names
-   arrayIndex  [ I ] - Array index (-1 = not part of an array)
+   program     [ I ] - Navigation program (see cDB2NavTree)
   
 RETURN VALUE:
    bool
 ===========================================================================*/
-bool cProtocolEntityNav::ProcessStruct(
-   const sDB2NavFragment *       pFrag,
-   const std::string &           preamble,
-   LONGLONG                      /* arrayIndex */ )
+bool cProtocolEntityNav::ProcessProgram(
+   const std::vector <sDB2NavInstruction> &  program )
 {
-   // Assume success
-   bool bRC = true;
-  
-   ULONG structSz = 0;
-   ULONG structOffset = GetOffset();
+   // Assume failure
+   bool bRC = false;
 
-   // Grab current navigation order
-   bool bOldLSB = GetLSBMode();
-   bool bNewLSB = bOldLSB;
+   mpProgram = 0;
+   mbSuspended = false;
+   mFrames.clear();
+
+   // Names built by the previous program are no longer referenced
+   mArena.Reset();
+
+   if (program.size() == 0)
+   {
+      return bRC;
+   }
+
+   // Begin the structure of the protocol entity itself
+   mpProgram = &program;
+   mPC = 0;
+   mFieldIndex = 0;
+
+   mFrames.reserve( 8 );
+   mFrames.push_back( sPENavFrame() );
+   BeginStruct( mFrames.back() );
+
+   bRC = RunProgram();
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   ResumeProgram (Internal Method)
+
+DESCRIPTION:
+   Resume a navigation program that was suspended, i.e. one where a 
+   derived class set mbSuspended when a field could not (yet) be 
+   processed, navigation continues with that field
+
+RETURN VALUE:
+   bool - false if the program fails or is suspended again
+===========================================================================*/
+bool cProtocolEntityNav::ResumeProgram()
+{
+   // Assume failure
+   bool bRC = false;
+
+   if (mpProgram == 0 || mbSuspended == false)
+   {
+      return bRC;
+   }
+
+   mbSuspended = false;
+   bRC = RunProgram();
+
+   if (mbSuspended == false && mEntity.mpName != 0)
+   {
+      ExitStruct( mEntity.mpName, -1 );
+   }
+
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   RunProgram (Internal Method)
+
+DESCRIPTION:
+   Run the current navigation program from the current instruction until
+   it completes, fails, or is suspended (in which case the program state
+   is retained so that ResumeProgram() can continue it)
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cProtocolEntityNav::RunProgram()
+{
+   // Assume failure
+   bool bRC = false;
+   if (mpProgram == 0 || mFrames.size() == 0)
+   {
+      return bRC;
+   }
 
-   // Check for directives
-   if (pFrag != 0)
+   const std::vector <sDB2NavInstruction> & program = *mpProgram;
+   ULONG instructions = (ULONG)program.size();
+
+   bRC = true;
+   while (bRC == true && mPC < instructions)
    {
-      bool bDirective = false;
+      const sDB2NavInstruction & ins = program[mPC];
+      sPENavFrame & frame = mFrames.back();
 
-      const sDB2Fragment & frag = *pFrag->mpFragment;
-      if (frag.mFragmentType == eDB2_FRAGMENT_MSB_2_LSB)
+      if (ins.mOp == eDB2_NAV_OP_SET_LSB)
       {
-         bDirective = true;
-         if (bOldLSB == true)
+         if (ins.mbLSB != frame.mbOldLSB)
          {
-            bNewLSB = false;
-            bRC = SetLSBMode( bNewLSB );
+            frame.mbNewLSB = ins.mbLSB;
+            bRC = SetLSBMode( frame.mbNewLSB );
          }
+
+         mPC++;
+         continue;
       }
 
-      if (frag.mFragmentType == eDB2_FRAGMENT_LSB_2_MSB)
+      if (ins.mOp == eDB2_NAV_OP_END_STRUCT)
       {
-         bDirective = true;
-         if (bOldLSB == false)
+         // Restore navigation order
+         if (frame.mbOldLSB != frame.mbNewLSB)
          {
-            bNewLSB = true;
-            bRC = SetLSBMode( bNewLSB );
+            bRC = SetLSBMode( frame.mbOldLSB );
+            if (bRC == false)
+            {
+               break;
+            }
          }
-      }
 
-      if (bDirective == true)
-      {
-         // We process directives here so move on to the next fragment
-         // upon success
-         if (bRC == true)
+         // End of the protocol entity?
+         if (ins.mOwner >= instructions)
          {
-            pFrag = pFrag->mpNextFragment;
+            mpProgram = 0;
+            mFrames.clear();
+            return bRC;
          }
-         else
+
+         const sDB2NavInstruction & owner = program[ins.mOwner];
+         const sDB2Fragment & frag = *owner.mpFragment;
+         ExitStruct( frag.mpName, frame.mArrayIndex );
+
+         // More array elements to process?
+         if (frame.mArrayIndex >= 0 && frame.mArrayIndex + 1 < frame.mArraySz)
          {
-            pFrag = 0;
+            frame.mArrayIndex++;
+
+            // Replace the preamble of the previous element
+            mArena.Release( frame.mPreambleMark );
+            frame.SetPreamble( mbFieldNames, mArena );
+
+            EnterStruct( frag.mpName, frame.mArrayIndex );
+            BeginStruct( frame );
+
+            mPC = ins.mOwner + 1;
+            continue;
          }
-      }      
-   }
 
-   // Process each fragment in the structure
-   while (pFrag != 0)
-   { 
-      bRC = ProcessFragment( pFrag, structOffset, structSz, preamble );
-      if (bRC == true)
+         if (frame.mArrayIndex >= 0)
+         {
+            ExitArray( frag, frame.mArraySz );
+         }
+
+         // Release the names of the structure
+         mArena.Release( frame.mBaseMark );
+
+         mFrames.pop_back();
+         EndFragment( mFrames.back() );
+
+         mPC = owner.mNext;
+         continue;
+      }
+
+      if (ins.mpFragment == 0)
       {
-         pFrag = pFrag->mpNextFragment;
+         bRC = false;
+         break;
       }
-      else
+
+      const sDB2Fragment & frag = *ins.mpFragment;
+
+      // Resuming part way through a field array?
+      ULONG resumeOffset = GetOffset();
+
+      // Names built for this instruction are released when it completes
+      // (structures release them when the structure is exited)
+      sNavArenaMark insMark = mArena.GetMark();
+
+      bool bSkip = false;
+      LONGLONG arraySz = -1;
+      LONGLONG arrayAdj = 0;
+      sNavName baseName;
+      bRC = BeginFragment( frag, 
+                           ins.mpModifier,
+                           frame.mStructOffset,
+                           frame.mPreamble, 
+                           bSkip, 
+                           arraySz, 
+                           arrayAdj, 
+                           baseName );
+
+      if (bRC == false)
       {
          break;
       }
+
+      if (bSkip == true)
+      {
+         mArena.Release( insMark );
+         mPC = ins.mNext;
+         continue;
+      }
+
+      switch (ins.mOp)
+      {
+         case eDB2_NAV_OP_STRUCT:
+         {
+            if (arraySz > 0)
+            {
+               EnterArray( frag, arraySz );
+            }
+
+            sPENavFrame child;
+            child.mOwner = mPC;
+            child.mArraySz = arraySz;
+            child.mArrayAdj = arrayAdj;
+            child.mArrayIndex = (arraySz > 0 ? 0 : -1);
+            child.mBaseName = baseName;
+            child.mBaseMark = insMark;
+            child.mPreambleMark = mArena.GetMark();
+            child.SetPreamble( mbFieldNames, mArena );
+
+            // NOTE: invalidates frame
+            mFrames.push_back( child );
+
+            EnterStruct( frag.mpName, mFrames.back().mArrayIndex );
+            BeginStruct( mFrames.back() );
+
+            mPC++;
+         }
+         break;
+
+         case eDB2_NAV_OP_FIELD:
+         {
+            if (mFieldIndex > 0)
+            {
+               // Do not re-apply any fragment offset
+               SetOffset( resumeOffset );
+            }
+
+            bool bSized = true;
+            bRC = ProcessFieldFragment( frag, 
+                                        ins.mpModifier,
+                                        ins.mpField, 
+                                        baseName, 
+                                        arraySz, 
+                                        arrayAdj,
+                                        bSized );
+
+            mArena.Release( insMark );
+            if (bRC == true)
+            {
+               if (bSized == true)
+               {
+                  EndFragment( frame );
+               }
+
+               mFieldIndex = 0;
+               mPC++;
+            }
+         }
+         break;
+
+         case eDB2_NAV_OP_PAD:
+         {
+            bRC = ProcessPadFragment( frag, 
+                                      frame.mStructOffset, 
+                                      frame.mStructSize );
+
+            mArena.Release( insMark );
+            if (bRC == true)
+            {
+               EndFragment( frame );
+            }
+
+            mPC++;
+         }
+         break;
+
+         default:
+            bRC = false;
+            break;
+      }
    }
 
-   // Restore navigation order
-   if (bRC == true && bOldLSB != bNewLSB)
+   if (mbSuspended == true)
    {
-      bRC = SetLSBMode( bOldLSB );
+      // Keep the program state, navigation will be resumed
+      bRC = false;
+      return bRC;
    }
 
+   UnwindProgram();
+
+   bRC = false;
    return bRC;
 }
 
 /*===========================================================================
 METHOD:
-   ProcessFragment (Internal Method)
+   UnwindProgram (Internal Method)
+
+DESCRIPTION:
+   Unwind any structures/arrays that were entered by the current
+   navigation program and discard the program state
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cProtocolEntityNav::UnwindProgram()
+{
+   if (mpProgram != 0)
+   {
+      const std::vector <sDB2NavInstruction> & program = *mpProgram;
+      while (mFrames.size() > 1)
+      {
+         const sPENavFrame & frame = mFrames.back();
+         const sDB2Fragment & frag = *program[frame.mOwner].mpFragment;
+
+         ExitStruct( frag.mpName, frame.mArrayIndex );
+         if (frame.mArrayIndex >= 0)
+         {
+            ExitArray( frag, frame.mArraySz );
+         }
+
+         mFrames.pop_back();
+      }
+   }
+
+   mpProgram = 0;
+   mFrames.clear();
+   mbSuspended = false;
+}
+
+/*===========================================================================
+METHOD:
+   BeginFragment (Internal Method)
 
 DESCRIPTION:
-   Process the given fragment
+   Begin processing a fragment, i.e. evaluate any condition, determine
+   array bounds, build the base name, and apply any fragment offset
 
 PARAMETERS:
-   pFrag          [ I ] - Fragment to be processed
+   frag           [ I ] - Fragment to be processed
+   pModifier      [ I ] - Parsed fragment modifier (may be 0)
    structOffset   [ I ] - Offset (from start of payload) of enclosing struct
-   structSize     [ I ] - Current size of enclosing struct
    preamble       [ I ] - String to prepend to any field/struct names
+   bSkip          [ O ] - Nothing to process for this fragment?
+   arraySz        [ O ] - Array size (-1 = not an array)
+   arrayAdj       [ O ] - Adjust for array indices
+   baseName       [ O ] - Name of fragment (when generating names)
   
 RETURN VALUE:
    bool
 ===========================================================================*/
-bool cProtocolEntityNav::ProcessFragment(
-   const sDB2NavFragment *       pFrag,
+bool cProtocolEntityNav::BeginFragment(
+   const sDB2Fragment &          frag,
+   const sDB2FragmentModifier *  pModifier,
    ULONG                         structOffset,
-   ULONG &                       structSize,
-   const std::string &           preamble )
+   const sNavName &              preamble,
+   bool &                        bSkip,
+   LONGLONG &                    arraySz,
+   LONGLONG &                    arrayAdj,
+   sNavName &                    baseName )
 {
    // Assume failure
    bool bRC = false;
-   if (pFrag == 0 || pFrag->mpFragment == 0)
-   {
-      return bRC;
-   }
 
-   // Grab database fragment
-   const sDB2Fragment & frag = *pFrag->mpFragment;
+   bSkip = false;
+   arraySz = -1;
+   arrayAdj = 0;
 
    // Is this fragment optional?   
    if (frag.mModifierType == eDB2_MOD_OPTIONAL)
    {      
       bool bParse = false;
-      bool bOK = EvaluateCondition( frag.mpModifierValue, bParse );
+      bool bOK = false;
+      if (pModifier != 0)
+      {
+         bOK = EvaluateCondition( pModifier->mCondition, bParse );
+      }
+      else
+      {
+         bOK = EvaluateCondition( frag.mpModifierValue, bParse );
+      }
+
       if (bOK == false)
       {
          // Error evaluating the condition
-         bRC = false;
          return bRC;
       }
 
       if (bParse == false)
       {
          // Condition not satisfied, nothing to parse
+         bSkip = true;
          bRC = true;
          return bRC;
       }
    }
 
    // Is this an array?
-   LONGLONG arraySz = -1;
-   LONGLONG arrayAdj = 0;
    bool bArray = ModifiedToArray( frag.mModifierType );
    if (bArray == true)
    {
-      bool bOK = GetArrayBounds( frag, arraySz, arrayAdj );
+      bool bOK = GetArrayBounds( frag, pModifier, arraySz, arrayAdj );
       if (bOK == false)
       {
          // Error obtaining array dimensions
-         bRC = false;
          return bRC;
       }
       else if (arraySz == 0)
       {
          // No array to process
+         bSkip = true;
          bRC = true;
          return bRC;
       }
    }
 
    // Set base name
-   std::string baseName = "";
    if (mbFieldNames == true)
    {
       baseName = preamble;
@@ -665,13 +955,10 @@ bool cProtocolEntityNav::ProcessFragment(
       // Add in fragment name?
       if (frag.mpName != EMPTY_STRING)
       {
-         if (baseName.size() > 0)
-         {
-            baseName += PE_NAV_FIELD_SEP;
-         }
-
          // Yes, add to the preamble            
-         baseName += frag.mpName;
+         baseName = mArena.MakeName( preamble, 
+                                     PE_NAV_FIELD_SEP, 
+                                     frag.mpName );
       }
    }
 
@@ -683,174 +970,170 @@ bool cProtocolEntityNav::ProcessFragment(
       SetOffset( newOffset );
    }   
 
-   // What type of fragment is this?
-   switch (frag.mFragmentType)
-   {
-      case eDB2_FRAGMENT_FIELD:
-      {
-         const sDB2Field * pField = pFrag->mpField;
-         if (pField != 0)
-         {
-            if (mbFieldNames == true)
-            {
-               if (baseName.size() > 0)
-               {
-                  baseName += PE_NAV_FIELD_SEP;
-               }
-
-               // Add in field name
-               baseName += pField->mpName;
-            }
-
-            // Variable string?
-            sDB2Field modField;
-            if ( (frag.mModifierType == eDB2_MOD_VARIABLE_STRING1)
-            ||   (frag.mModifierType == eDB2_MOD_VARIABLE_STRING2)
-            ||   (frag.mModifierType == eDB2_MOD_VARIABLE_STRING3) )
-            {
-               modField = *pField;
-               bRC = ModifyStringLength( frag, modField );
-               if (bRC == false)
-               {
-                  // Unable to obtain string length
-                  return bRC;
-               }
-
-               if (modField.mSize == 0)
-               {
-                  // String has no length - treat like an optional fragment
-                  bRC = true;
-                  return bRC;
-               }
-
-               pField = &modField;
-            }
-
-            // Handle an array?
-            if (bArray == true)
-            {
-               EnterArray( frag, arraySz );
+   bRC = true;
+   return bRC;
+}
 
-               if (mbFieldNames == true)
-               {
-                  ULONG baseLen = baseName.size();
+/*===========================================================================
+METHOD:
+   ProcessFieldFragment (Internal Method)
 
-                  std::string fieldName;
-                  fieldName.reserve( baseLen + 16 );
-                  fieldName = baseName;
+DESCRIPTION:
+   Process a field fragment (once BeginFragment() has succeeded)
 
-                  CHAR arraySpec[32];
+PARAMETERS:
+   frag           [ I ] - Fragment to be processed
+   pModifier      [ I ] - Parsed fragment modifier (may be 0)
+   pField         [ I ] - Associated field
+   baseName       [ I ] - Name of fragment (field name is appended)
+   arraySz        [ I ] - Array size (-1 = not an array)
+   arrayAdj       [ I ] - Adjust for array indices
+   bSized         [ O ] - Should the fragment count towards the size of 
+                          the enclosing structure?
+  
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cProtocolEntityNav::ProcessFieldFragment(
+   const sDB2Fragment &          frag,
+   const sDB2FragmentModifier *  pModifier,
+   const sDB2Field *             pField,
+   const sNavName &              baseName,
+   LONGLONG                      arraySz,
+   LONGLONG                      arrayAdj,
+   bool &                        bSized )
+{
+   // Assume failure
+   bool bRC = false;
 
-                  for (LONGLONG i = 0; i < arraySz; i++)
-                  { 
-                     snprintf( arraySpec, 31, "[%lld]", i + arrayAdj );
-                     fieldName += arraySpec;
+   bSized = true;
+   if (pField == 0)
+   {
+      return bRC;
+   }
 
-                     bRC = ProcessField( pField, fieldName, i );
-                     if (bRC == false)
-                     {                  
-                        break;
-                     }
+   // Field names are built in reused storage
+   mFieldName.clear();
+   if (mbFieldNames == true)
+   {
+      mFieldName.append( baseName.mpName, baseName.mLen );
+      if (baseName.IsEmpty() == false)
+      {
+         mFieldName += PE_NAV_FIELD_SEP;
+      }
 
-                     // Remove the array specifier for the next pass
-                     fieldName.resize( baseLen );
-                  }
-               }
-               else
-               {
-                  for (LONGLONG i = 0; i < arraySz; i++)
-                  { 
-                     bRC = ProcessField( pField, baseName, i );
-                     if (bRC == false)
-                     {                  
-                        break;
-                     }
-                  }
-               }
+      // Add in field name
+      mFieldName += pField->mpName;
+   }
 
-               ExitArray( frag, arraySz );
-            }
-            else
-            {
-               bRC = ProcessField( pField, baseName );
-            }
-         }
+   // Variable string?
+   sDB2Field modField;
+   if ( (frag.mModifierType == eDB2_MOD_VARIABLE_STRING1)
+   ||   (frag.mModifierType == eDB2_MOD_VARIABLE_STRING2)
+   ||   (frag.mModifierType == eDB2_MOD_VARIABLE_STRING3) )
+   {
+      modField = *pField;
+      bRC = ModifyStringLength( frag, pModifier, modField );
+      if (bRC == false)
+      {
+         // Unable to obtain string length
+         return bRC;
       }
-      break;
 
-      case eDB2_FRAGMENT_STRUCT:                     
+      if (modField.mSize == 0)
       {
-         if (pFrag->mpLinkFragment != 0)
-         {
-            // Handle an array?
-            if (bArray == true)
-            {
-               EnterArray( frag, arraySz );
-
-               if (mbFieldNames == true)
-               {
-                  ULONG baseLen = baseName.size();
-
-                  std::string structName;
-                  structName.reserve( baseLen + 16 );
-                  structName = baseName;
+         // String has no length - treat like an optional fragment
+         bSized = false;
+         bRC = true;
+         return bRC;
+      }
 
-                  CHAR arraySpec[32];
+      pField = &modField;
+   }
 
-                  for (LONGLONG i = 0; i < arraySz; i++)
-                  {          
-                     snprintf( arraySpec, 31, "[%lld]", i + arrayAdj );
-                     structName += arraySpec;
+   // Handle an array?
+   if (arraySz > 0)
+   {
+      // Resuming a suspended array part way through?
+      LONGLONG first = mFieldIndex;
+      if (first == 0)
+      {
+         EnterArray( frag, arraySz );
+      }
 
-                     EnterStruct( frag.mpName, i );
+      if (mbFieldNames == true)
+      {
+         ULONG baseLen = mFieldName.size();
 
-                     bRC = ProcessStruct( pFrag->mpLinkFragment, 
-                                          structName, 
-                                          i );
+         CHAR arraySpec[32];
 
-                     ExitStruct( frag.mpName, i );
+         for (LONGLONG i = first; i < arraySz; i++)
+         { 
+            snprintf( arraySpec, 31, "[%lld]", i + arrayAdj );
+            mFieldName += arraySpec;
 
-                     if (bRC == false)
-                     {                  
-                        break;
-                     } 
+            bRC = ProcessField( pField, mFieldName, i );
+            if (bRC == false)
+            {                  
+               mFieldIndex = i;
+               break;
+            }
 
-                     // Remove the array specifier for the next pass
-                     structName.resize( baseLen );
-                  }
-               }
-               else
-               {
+            // Remove the array specifier for the next pass
+            mFieldName.resize( baseLen );
+         }
+      }
+      else
+      {
+         for (LONGLONG i = first; i < arraySz; i++)
+         { 
+            bRC = ProcessField( pField, mFieldName, i );
+            if (bRC == false)
+            {                  
+               mFieldIndex = i;
+               break;
+            }
+         }
+      }
 
-                  for (LONGLONG i = 0; i < arraySz; i++)
-                  {          
-                     EnterStruct( frag.mpName, i );
+      if (mbSuspended == false)
+      {
+         ExitArray( frag, arraySz );
+      }
+   }
+   else
+   {
+      bRC = ProcessField( pField, mFieldName );
+   }
 
-                     bRC = ProcessStruct( pFrag->mpLinkFragment, 
-                                          baseName, 
-                                          i );
+   return bRC;
+}
 
-                     ExitStruct( frag.mpName, i );
+/*===========================================================================
+METHOD:
+   ProcessPadFragment (Internal Method)
 
-                     if (bRC == false)
-                     {                  
-                        break;
-                     } 
-                  }
-               }
+DESCRIPTION:
+   Process a pad fragment (once BeginFragment() has succeeded)
 
-               ExitArray( frag, arraySz );
-            }
-            else
-            {
-               EnterStruct( frag.mpName, -1 );
-               bRC = ProcessStruct( pFrag->mpLinkFragment, baseName );
-               ExitStruct( frag.mpName, -1 );
-            }
-         }
-      }
-      break;
+PARAMETERS:
+   frag           [ I ] - Fragment to be processed
+   structOffset   [ I ] - Offset (from start of payload) of enclosing struct
+   structSize     [ I ] - Current size of enclosing struct
+  
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cProtocolEntityNav::ProcessPadFragment(
+   const sDB2Fragment &          frag,
+   ULONG                         structOffset,
+   ULONG                         structSize )
+{
+   // Assume failure
+   bool bRC = false;
 
+   switch (frag.mFragmentType)
+   {
       case eDB2_FRAGMENT_CONSTANT_PAD:
       {
          // Is the structure is smaller than the specified
@@ -912,25 +1195,98 @@ bool cProtocolEntityNav::ProcessFragment(
       break;
 
       default:
-         bRC = false;
          break;
    }
-      
-   // Adjust struct size?
-   if (bRC == true)
+
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   BeginStruct (Internal Method)
+
+DESCRIPTION:
+   Begin a structure (or the next element of a structure array)
+
+PARAMETERS:
+   frame       [I/O] - Frame for the structure
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+void cProtocolEntityNav::BeginStruct( sPENavFrame & frame )
+{
+   frame.mStructOffset = GetOffset();
+   frame.mStructSize = 0;
+
+   // Grab current navigation order
+   frame.mbOldLSB = GetLSBMode();
+   frame.mbNewLSB = frame.mbOldLSB;
+}
+
+/*===========================================================================
+METHOD:
+   EndFragment (Internal Method)
+
+DESCRIPTION:
+   Account for a successfully processed fragment in the size of the
+   enclosing structure
+
+PARAMETERS:
+   frame       [I/O] - Frame for the enclosing structure
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+void cProtocolEntityNav::EndFragment( sPENavFrame & frame )
+{
+   ULONG newOffset = GetOffset();
+   if (newOffset > frame.mStructOffset)
    {
-      ULONG newOffset = GetOffset();
-      if (newOffset > structOffset)
+      ULONG newSz = newOffset - frame.mStructOffset;
+      if (newSz > frame.mStructSize)
       {
-         ULONG newSz = newOffset - structOffset;
-         if (newSz > structSize)
-         {
-            structSize = newSz;
-         }
+         frame.mStructSize = newSz;
       }
    }
+}
 
-   return bRC;
+/*===========================================================================
+METHOD:
+   FindTrackedField (Internal Method)
+
+DESCRIPTION:
+   Find the given field in the (ordered) tracked fields
+
+PARAMETERS:
+   fieldID     [ I ] - Field ID to look for
+  
+RETURN VALUE:
+   sPENavTrackedField * - 0 if the field is not tracked
+===========================================================================*/
+sPENavTrackedField * cProtocolEntityNav::FindTrackedField( ULONG fieldID )
+{
+   ULONG lo = 0;
+   ULONG hi = (ULONG)mTrackedFields.size();
+   while (lo < hi)
+   {
+      ULONG mid = lo + (hi - lo) / 2;
+      if (mTrackedFields[mid].mID < fieldID)
+      {
+         lo = mid + 1;
+      }
+      else
+      {
+         hi = mid;
+      }
+   }
+
+   if (lo < (ULONG)mTrackedFields.size() && mTrackedFields[lo].mID == fieldID)
+   {
+      return &mTrackedFields[lo];
+   }
+
+   return 0;
 }
 
 /*===========================================================================
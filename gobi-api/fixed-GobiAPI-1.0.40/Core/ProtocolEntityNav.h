@@ -49,12 +49,14 @@ POSSIBILITY OF SUCH DAMAGE.
 // Include Files
 //---------------------------------------------------------------------------
 #include "CoreDatabase.h"
+#include "NavArena.h"
 
 //---------------------------------------------------------------------------
 // Definitions
 //---------------------------------------------------------------------------
 struct sSharedBuffer;
 struct sDB2NavFragment;
+struct sDB2NavInstruction;
 
 // Field seperator string
 extern LPCSTR PE_NAV_FIELD_SEP;
@@ -102,6 +104,97 @@ inline bool IsValid( ePENavFieldAttr attr )
    return bRC;
 };
 
+/*=========================================================================*/
+// Struct sPENavFrame
+//
+//    Navigation program frame, one per structure being processed
+/*=========================================================================*/
+struct sPENavFrame
+{
+   public:
+      // (Inline) Constructor
+      sPENavFrame()
+         :  mOwner( ULONG_MAX ),
+            mStructOffset( 0 ),
+            mStructSize( 0 ),
+            mbOldLSB( true ),
+            mbNewLSB( true ),
+            mArraySz( -1 ),
+            mArrayAdj( 0 ),
+            mArrayIndex( -1 ),
+            mBaseName(),
+            mPreamble(),
+            mBaseMark(),
+            mPreambleMark()
+      { };
+
+      // (Inline) Set the name preamble for the current array element
+      void SetPreamble( 
+         bool                       bFieldNames,
+         cNavArena &                arena )
+      {
+         if (bFieldNames == false)
+         {
+            return;
+         }
+
+         mPreamble = mBaseName;
+         if (mArrayIndex >= 0)
+         {
+            CHAR arraySpec[32];
+            snprintf( arraySpec, 31, "[%lld]", mArrayIndex + mArrayAdj );
+            mPreamble = arena.MakeName( mBaseName, "", "", arraySpec );
+         }
+      };
+
+      /* Struct instruction that began this frame (ULONG_MAX = entity) */
+      ULONG mOwner;
+
+      /* Offset (from start of payload) of the structure */
+      ULONG mStructOffset;
+
+      /* Current size of the structure */
+      ULONG mStructSize;
+
+      /* Navigation order upon entry, and as set by a directive */
+      bool mbOldLSB;
+      bool mbNewLSB;
+
+      /* Array size/adjust/current index (-1 = not an array) */
+      LONGLONG mArraySz;
+      LONGLONG mArrayAdj;
+      LONGLONG mArrayIndex;
+
+      /* Name of the struct fragment */
+      sNavName mBaseName;
+
+      /* String to prepend to any field/struct names */
+      sNavName mPreamble;
+
+      /* Arena position before the above base name/preamble were built */
+      sNavArenaMark mBaseMark;
+      sNavArenaMark mPreambleMark;
+};
+
+/*=========================================================================*/
+// Struct sPENavTrackedField
+//
+//    Last value of a field that navigation depends upon (array sizes,
+//    string lengths, conditions, etc.), see cDB2NavTree
+/*=========================================================================*/
+struct sPENavTrackedField
+{
+   public:
+      /* Field ID */
+      ULONG mID;
+
+      /* Has a value been parsed/packed? */
+      bool mbValid;
+
+      /* The value */
+      LONGLONG mValue;
+};
+
 /*=========================================================================*/
 // Class cProtocolEntityNav
 //    Class to navigate a protocol entity
@@ -128,11 +221,17 @@ class cProtocolEntityNav
          LPCSTR                    pCondition,
          bool &                     bResult );
 
+      // Evaluate the given (parsed) condition
+      virtual bool EvaluateCondition( 
+         const sDB2SimpleCondition &   con,
+         bool &                        bResult );
+
       // Get the array bounds described by the fragment descriptor
       virtual bool GetArrayBounds( 
-         const sDB2Fragment &       frag,
-         LONGLONG &                 arraySz,
-         LONGLONG &                 arrayAdj );
+         const sDB2Fragment &          frag,
+         const sDB2FragmentModifier *  pModifier,
+         LONGLONG &                    arraySz,
+         LONGLONG &                    arrayAdj );
 
       // Return the value for the specified field ID as a
       // LONGLONG (field type must be able to fit)
@@ -142,8 +241,9 @@ class cProtocolEntityNav
 
       // Modify string length based on existing field value
       virtual bool ModifyStringLength( 
-         const sDB2Fragment &       frag,
-         sDB2Field &                field );
+         const sDB2Fragment &          frag,
+         const sDB2FragmentModifier *  pModifier,
+         sDB2Field &                   field );
 
       // Process the protocol entity described by the given key/name
       virtual bool ProcessEntity( const std::vector <ULONG> & key );
@@ -155,18 +255,54 @@ class cProtocolEntityNav
          return true;
       };
 
-      // Process a structure described by the given initial fragment
-      virtual bool ProcessStruct(
-         const sDB2NavFragment *       pFrag,
-         const std::string &               preamble,
-         LONGLONG                      arrayIndex = -1 );
+      // Run the navigation program of the protocol entity
+      virtual bool ProcessProgram(
+         const std::vector <sDB2NavInstruction> &  program );
+
+      // Resume a navigation program that was suspended
+      virtual bool ResumeProgram();
+
+      // Run the current navigation program from the current instruction
+      bool RunProgram();
 
-      // Process the given fragment
-      virtual bool ProcessFragment(
-         const sDB2NavFragment *       pFrag,
+      // Unwind any structures/arrays that were entered
+      void UnwindProgram();
+
+      // Begin processing a fragment (conditions, bounds, name, offset)
+      bool BeginFragment(
+         const sDB2Fragment &          frag,
+         const sDB2FragmentModifier *  pModifier,
+         ULONG                         structOffset,
+         const sNavName &              preamble,
+         bool &                        bSkip,
+         LONGLONG &                    arraySz,
+         LONGLONG &                    arrayAdj,
+         sNavName &                    baseName );
+
+      // Process a field fragment
+      bool ProcessFieldFragment(
+         const sDB2Fragment &          frag,
+         const sDB2FragmentModifier *  pModifier,
+         const sDB2Field *             pField,
+         const sNavName &              baseName,
+         LONGLONG                      arraySz,
+         LONGLONG                      arrayAdj,
+         bool &                        bSized );
+
+      // Process a pad fragment
+      bool ProcessPadFragment(
+         const sDB2Fragment &          frag,
          ULONG                         structOffset,
-         ULONG &                       structSize,
-         const std::string &               preamble );
+         ULONG                         structSize );
+
+      // Begin a structure (or structure array element)
+      void BeginStruct( sPENavFrame & frame );
+
+      // Account for a processed fragment in the enclosing structure size
+      void EndFragment( sPENavFrame & frame );
+
+      // Find the given field in the tracked fields (0 = not tracked)
+      sPENavTrackedField * FindTrackedField( ULONG fieldID );
 
       // Process the given field 
       virtual bool ProcessField(
@@ -237,10 +373,29 @@ class cProtocolEntityNav
 
       /* References to DB tables we need */
       const tDB2OptionalModMap & mConditions;
-      const tDB2ExpressionModMap & mExpressions;
-      const tDB2Array1ModMap & mArrays1;
-      const tDB2Array2ModMap & mArrays2;
 
-      /* Map of all 'tracked' fields */
-      std::map <ULONG, std::pair <bool, LONGLONG> > mTrackedFields;
+      /* All 'tracked' fields (flat, ordered by field ID) */
+      std::vector <sPENavTrackedField> mTrackedFields;
+
+      /* Arena for navigation temporaries (reset for each program) */
+      cNavArena mArena;
+
+      /* Field name passed to ProcessField() (storage is reused) */
+      std::string mFieldName;
+
+      /* Navigation program being run (0 = none) */
+      const std::vector <sDB2NavInstruction> * mpProgram;
+
+      /* Next instruction of the above program */
+      ULONG mPC;
+
+      /* Navigation program frames, one per structure being processed */
+      std::vector <sPENavFrame> mFrames;
+
+      /* Array element a suspended field fragment resumes at */
+      LONGLONG mFieldIndex;
+
+      /* Was navigation suspended (i.e. awaiting data) rather than failed?
+         (set by a derived class when ProcessField() cannot complete) */
+      bool mbSuspended;
 };
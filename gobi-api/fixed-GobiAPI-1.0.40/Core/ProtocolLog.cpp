@@ -7,10 +7,15 @@ DESCRIPTION:
    
 PUBLIC CLASSES AND METHODS:
    cProtocolLog
-      This class stores protocol buffers in to a flat array (actually a
-      double-ended queue) so that they can be accessed by other objects 
-      during the flow of normal processing.  Note that the storage is
-      in-memory and therefore finite
+      This class stores protocol buffers in to a fixed size ring so that 
+      they can be accessed by other objects during the flow of normal 
+      processing.  Note that the storage is in-memory and therefore finite,
+      although buffers evicted from the ring can optionally be streamed to
+      a memory mapped capture file
+
+      Buffers are indexed by a monotonically increasing sequence number,
+      readers access the ring without locking and can detect when the 
+      buffer they are after has been overwritten (i.e. they were lapped)
 
 Copyright (c) 2011, Code Aurora Forum. All rights reserved.
 
@@ -45,6 +50,13 @@ POSSIBILITY OF SUCH DAMAGE.
 //---------------------------------------------------------------------------
 #include "StdAfx.h"
 #include "ProtocolLog.h"
+#include "CoreUtilities.h"
+#include "QMIBuffers.h"
+
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 //---------------------------------------------------------------------------
 // Definitions
@@ -71,10 +83,26 @@ RETURN VALUE:
    None
 ===========================================================================*/
 cProtocolLog::cProtocolLog( ULONG maxBuffers )
-   :  mLog( maxBuffers > MAX_PROTOCOL_BUFFERS ? MAX_PROTOCOL_BUFFERS : maxBuffers,
-            true )
+   :  mpSlots( 0 ),
+      mCapacity( maxBuffers > MAX_PROTOCOL_BUFFERS 
+                 ? MAX_PROTOCOL_BUFFERS : maxBuffers ),
+      mTotal( 0 ),
+      mWriteSection(),
+      mSignalEvent(),
+      mSpillFD( -1 ),
+      mpSpill( 0 ),
+      mSpillSize( 0 ),
+      mbSpillFilter( false ),
+      mSpillServiceKinds( QMI_SERVICE_COUNT, 0 ),
+      mSpillMessageKinds()
 {
-   // Nothing to do
+   // There has to be room for at least one buffer
+   if (mCapacity == 0)
+   {
+      mCapacity = 1;
+   }
+
+   mpSlots = new sProtocolLogSlot[mCapacity];
 }
 
 /*===========================================================================
@@ -91,6 +119,40 @@ cProtocolLog::~cProtocolLog()
 {
    // Empty out the log
    Clear();
+   StopSpill();
+
+   delete [] mpSlots;
+   mpSlots = 0;
+}
+
+/*===========================================================================
+METHOD:
+   ClaimSlot (Internal Method)
+
+DESCRIPTION:
+   Claim a slot for writing; the slot is marked empty so that no new 
+   readers will touch it, then any readers already copying it out are
+   waited on (they only hold the slot long enough to add a reference)
+
+   NOTE: must be called with the write mutex held
+
+PARAMETERS:
+   slot        [ I ] - Slot to claim
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cProtocolLog::ClaimSlot( sProtocolLogSlot & slot )
+{
+   slot.mSeq = 0;
+   __sync_synchronize();
+
+   while (slot.mReaders != 0)
+   {
+      sched_yield();
+   }
+
+   __sync_synchronize();
 }
 
 /*===========================================================================
@@ -98,7 +160,8 @@ METHOD:
    AddBuffer (Public Method)
 
 DESCRIPTION:
-   Add an protocol buffer to the end of the log
+   Add an protocol buffer to the end of the log (overwriting the oldest
+   buffer when the log is full)
 
 PARAMETERS:
    buff        [ I ] - Protocol buffer to add
@@ -109,17 +172,50 @@ RETURN VALUE:
 ULONG cProtocolLog::AddBuffer( sProtocolBuffer & buf )
 {
    ULONG idx = INVALID_LOG_INDEX;
-   if (buf.IsValid() == false)
+   if (buf.IsValid() == false || mpSlots == 0)
    {
       return idx;
    }
 
-   bool bRC = mLog.AddElement( buf, idx );
-   if (bRC == false)
+   int nRet = mWriteSection.Lock();
+   if (nRet != 0)
    {
-      idx = INVALID_LOG_INDEX;
+      TRACE( "ProtocolLog: Unable to lock write mutex. Error %d: %s\n",
+             nRet,
+             strerror( nRet ) );
+      return idx;
    }
-    
+
+   ULONG seq = mTotal;
+   sProtocolLogSlot & slot = mpSlots[seq % mCapacity];
+   
+   // Evicting a buffer to the capture file?
+   ULONG evictSeq = slot.mSeq;
+   if (evictSeq != 0 && mpSpill != 0)
+   {
+      Spill( evictSeq - 1, slot.mBuffer );
+   }
+
+   ClaimSlot( slot );
+   slot.mBuffer = buf;
+
+   // Publish the buffer, then the new count
+   __sync_synchronize();
+   slot.mSeq = seq + 1;
+
+   __sync_synchronize();
+   mTotal = seq + 1;
+   idx = seq;
+
+   nRet = mSignalEvent.Set( (DWORD)idx );
+   if (nRet != 0)
+   {
+      TRACE( "ProtocolLog: Unable to signal. Error %d: %s\n",
+             nRet,
+             strerror( nRet ) );
+   }
+
+   mWriteSection.Unlock();
    return idx;
 }
 
@@ -139,10 +235,59 @@ RETURN VALUE:
 sProtocolBuffer cProtocolLog::GetBuffer( ULONG idx ) const
 {
    sProtocolBuffer buf;
-   mLog.GetElement( idx, buf );
+   GetBuffer( idx, buf );
    return buf;
 }
 
+/*===========================================================================
+METHOD:
+   GetBuffer (Public Method)
+
+DESCRIPTION:
+   Return the protocol buffer at the given index from the log, without
+   locking (the buffer data itself is shared, not copied)
+
+PARAMETERS:
+   idx         [ I ] - Index of protocol buffer to obtain
+   buf         [ O ] - Protocol buffer
+
+RETURN VALUE:
+   bool - false if the index has not yet been added or has been 
+          overwritten (the latter being the case when idx is below
+          GetFirstIndex())
+===========================================================================*/
+bool cProtocolLog::GetBuffer( 
+   ULONG                      idx,
+   sProtocolBuffer &          buf ) const
+{
+   // Assume failure
+   bool bRC = false;
+   if (mpSlots == 0 || idx == INVALID_LOG_INDEX)
+   {
+      return bRC;
+   }
+
+   sProtocolLogSlot & slot = mpSlots[idx % mCapacity];
+
+   // Skip slots that obviously do not hold the buffer (so that readers
+   // polling a slot being written do not hold off the writer)
+   if (slot.mSeq != idx + 1)
+   {
+      return bRC;
+   }
+
+   // Announce ourselves (a full barrier) before checking the slot again
+   __sync_add_and_fetch( &slot.mReaders, 1 );
+   if (slot.mSeq == idx + 1)
+   {
+      buf = slot.mBuffer;
+      bRC = true;
+   }
+
+   __sync_sub_and_fetch( &slot.mReaders, 1 );
+   return bRC;
+}
+
 /*===========================================================================
 METHOD:
    GetSignalEvent (Public Method)
@@ -156,7 +301,7 @@ RETURN VALUE:
 ===========================================================================*/
 cEvent & cProtocolLog::GetSignalEvent() const
 {
-   return mLog.GetSignalEvent();
+   return mSignalEvent;
 }
 
 /*===========================================================================
@@ -171,7 +316,31 @@ RETURN VALUE:
 ===========================================================================*/
 ULONG cProtocolLog::GetCount() const
 {
-   return mLog.GetTotalCount();
+   ULONG count = mTotal;
+   __sync_synchronize();
+   return count;
+}
+
+/*===========================================================================
+METHOD:
+   GetFirstIndex (Public Method)
+
+DESCRIPTION:
+   Return the index of the oldest buffer still held in the log, a reader
+   positioned before this index has been lapped and has missed buffers
+
+RETURN VALUE:
+   ULONG
+===========================================================================*/
+ULONG cProtocolLog::GetFirstIndex() const
+{
+   ULONG count = GetCount();
+   if (count <= mCapacity)
+   {
+      return 0;
+   }
+
+   return count - mCapacity;
 }
 
 /*===========================================================================
@@ -186,5 +355,548 @@ RETURN VALUE:
 ===========================================================================*/
 void cProtocolLog::Clear()
 {
-   mLog.EmptyQueue();
+   if (mpSlots == 0)
+   {
+      return;
+   }
+
+   mWriteSection.Lock();
+
+   for (ULONG s = 0; s < mCapacity; s++)
+   {
+      sProtocolLogSlot & slot = mpSlots[s];
+      if (slot.mSeq != 0)
+      {
+         ClaimSlot( slot );
+         slot.mBuffer = sProtocolBuffer();
+      }
+   }
+
+   __sync_synchronize();
+   mTotal = 0;
+
+   mWriteSection.Unlock();
+}
+
+/*===========================================================================
+METHOD:
+   StartSpill (Public Method)
+
+DESCRIPTION:
+   Stream buffers evicted from the log to the given capture file (which
+   is memory mapped, and then reused circularly once full) so that long
+   running traces do not need a larger in-memory log
+
+PARAMETERS:
+   pFileName   [ I ] - Capture file name
+   maxBytes    [ I ] - Capture file size
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cProtocolLog::StartSpill( 
+   LPCSTR                     pFileName,
+   ULONG                      maxBytes )
+{
+   // Assume failure
+   bool bRC = false;
+
+   ULONG minBytes = sizeof( sProtocolLogSpillHeader ) 
+                  + sizeof( sProtocolLogSpillRecord );
+
+   if (pFileName == 0 || pFileName[0] == 0 || maxBytes < minBytes)
+   {
+      return bRC;
+   }
+
+   // Offsets in the capture file are 32-bit
+   if (maxBytes > (ULONG)UINT_MAX)
+   {
+      maxBytes = (ULONG)UINT_MAX;
+   }
+
+   StopSpill();
+
+   int fd = open( pFileName, O_RDWR | O_CREAT | O_TRUNC, 0644 );
+   if (fd < 0)
+   {
+      TRACE( "ProtocolLog: Unable to open %s. Error %d: %s\n",
+             pFileName,
+             errno,
+             strerror( errno ) );
+      return bRC;
+   }
+
+   if (ftruncate( fd, (off_t)maxBytes ) != 0)
+   {
+      TRACE( "ProtocolLog: Unable to size %s. Error %d: %s\n",
+             pFileName,
+             errno,
+             strerror( errno ) );
+      close( fd );
+      return bRC;
+   }
+
+   void * pMap = mmap( 0, 
+                       (size_t)maxBytes, 
+                       PROT_READ | PROT_WRITE, 
+                       MAP_SHARED, 
+                       fd, 
+                       0 );
+
+   if (pMap == MAP_FAILED)
+   {
+      TRACE( "ProtocolLog: Unable to map %s. Error %d: %s\n",
+             pFileName,
+             errno,
+             strerror( errno ) );
+      close( fd );
+      return bRC;
+   }
+
+   sProtocolLogSpillHeader * pHdr = (sProtocolLogSpillHeader *)pMap;
+   pHdr->mSignature = (UINT)eSPILL_SIG;
+   pHdr->mWriteOffset = (UINT)sizeof( sProtocolLogSpillHeader );
+   pHdr->mOldestOffset = pHdr->mWriteOffset;
+   pHdr->mEndOffset = pHdr->mWriteOffset;
+   pHdr->mRecords = 0;
+
+   mWriteSection.Lock();
+   mSpillFD = fd;
+   mpSpill = (PBYTE)pMap;
+   mSpillSize = maxBytes;
+   mWriteSection.Unlock();
+
+   bRC = true;
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   StopSpill (Public Method)
+
+DESCRIPTION:
+   Stop streaming evicted buffers to the capture file
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cProtocolLog::StopSpill()
+{
+   mWriteSection.Lock();
+
+   if (mpSpill != 0)
+   {
+      msync( mpSpill, (size_t)mSpillSize, MS_ASYNC );
+      munmap( mpSpill, (size_t)mSpillSize );
+      mpSpill = 0;
+      mSpillSize = 0;
+   }
+
+   if (mSpillFD >= 0)
+   {
+      close( mSpillFD );
+      mSpillFD = -1;
+   }
+
+   mWriteSection.Unlock();
+}
+
+/*===========================================================================
+METHOD:
+   SetSpillFilter (Public Method)
+
+DESCRIPTION:
+   Only stream the QMI buffers matching the given rules to the capture
+   file, so that a long running trace of a few messages of interest does
+   not need to copy (and then wrap over) everything else
+
+   Rules are separated by commas, each one being 
+   SERVICE[:MESSAGE][/KIND[+KIND...]] where SERVICE is a service name
+   (e.g. "WDS") or type, MESSAGE a message ID and KIND one of "request", 
+   "response", "indication", or "error" (a failed response).  A rule 
+   without a message ID applies to every message of the service, one 
+   without kinds to every request, response, and indication, e.g.
+   "WDS:0x22/indication,NAS/error".  Buffers of other protocols are
+   always streamed
+
+PARAMETERS:
+   pFilter     [ I ] - Filter rules (0 or "" to stream every buffer)
+
+RETURN VALUE:
+   bool - false if the rules could not be parsed (the filter is then
+          left as it was)
+===========================================================================*/
+bool cProtocolLog::SetSpillFilter( LPCSTR pFilter )
+{
+   std::vector <BYTE> serviceKinds( QMI_SERVICE_COUNT, 0 );
+   std::map <ULONG, BYTE> messageKinds;
+
+   bool bFilter = (pFilter != 0 && pFilter[0] != 0);
+   if (bFilter == true)
+   {
+      std::string filter = pFilter;
+      std::vector <LPSTR> rules;
+      ParseTokens( ",", (LPSTR)&filter[0], rules );
+
+      ULONG ruleCount = (ULONG)rules.size();
+      for (ULONG r = 0; r < ruleCount; r++)
+      {
+         LPSTR pService = rules[r];
+         while (*pService == ' ')
+         {
+            pService++;
+         }
+
+         LPSTR pKinds = strchr( pService, '/' );
+         if (pKinds != 0)
+         {
+            *pKinds++ = 0;
+         }
+
+         LPSTR pMessage = strchr( pService, ':' );
+         if (pMessage != 0)
+         {
+            *pMessage++ = 0;
+         }
+
+         // Service, by name or type
+         const sQMIServiceInfo * pInfo = 0;
+         ULONG svc = 0;
+         if (StringToULONG( pService, 0, svc ) == true)
+         {
+            pInfo = FindQMIService( (eQMIService)svc );
+         }
+         else
+         {
+            for (ULONG row = 0; row < QMI_SERVICE_COUNT; row++)
+            {
+               if (strcasecmp( pService, gQMIServices[row].mpName ) == 0)
+               {
+                  pInfo = &gQMIServices[row];
+                  break;
+               }
+            }
+         }
+
+         if (pInfo == 0)
+         {
+            TRACE( "ProtocolLog: Unknown service in filter rule %s\n", 
+                   pService );
+            return false;
+         }
+
+         ULONG row = (ULONG)(pInfo - &gQMIServices[0]);
+
+         ULONG msgID = 0;
+         if ( (pMessage != 0)
+         &&   ( (StringToULONG( pMessage, 0, msgID ) == false)
+         ||     (msgID > 0xFFFF) ) )
+         {
+            TRACE( "ProtocolLog: Invalid message ID in filter rule %s\n", 
+                   pMessage );
+            return false;
+         }
+
+         BYTE kinds = PROTOCOL_LOG_KIND_REQUEST 
+                    | PROTOCOL_LOG_KIND_RESPONSE 
+                    | PROTOCOL_LOG_KIND_INDICATION;
+
+         if (pKinds != 0)
+         {
+            kinds = 0;
+
+            std::vector <LPSTR> kindTokens;
+            ParseTokens( "+", pKinds, kindTokens );
+
+            ULONG kindCount = (ULONG)kindTokens.size();
+            for (ULONG k = 0; k < kindCount; k++)
+            {
+               LPCSTR pKind = kindTokens[k];
+               if (strcasecmp( pKind, "request" ) == 0)
+               {
+                  kinds |= PROTOCOL_LOG_KIND_REQUEST;
+               }
+               else if (strcasecmp( pKind, "response" ) == 0)
+               {
+                  kinds |= PROTOCOL_LOG_KIND_RESPONSE;
+               }
+               else if (strcasecmp( pKind, "indication" ) == 0)
+               {
+                  kinds |= PROTOCOL_LOG_KIND_INDICATION;
+               }
+               else if (strcasecmp( pKind, "error" ) == 0)
+               {
+                  kinds |= PROTOCOL_LOG_KIND_ERROR;
+               }
+               else
+               {
+                  TRACE( "ProtocolLog: Unknown kind in filter rule %s\n", 
+                         pKind );
+                  return false;
+               }
+            }
+         }
+
+         if (pMessage == 0)
+         {
+            serviceKinds[row] |= kinds;
+         }
+         else
+         {
+            messageKinds[(row << 16) | msgID] |= kinds;
+         }
+      }
+   }
+
+   mWriteSection.Lock();
+   mbSpillFilter = bFilter;
+   mSpillServiceKinds.swap( serviceKinds );
+   mSpillMessageKinds.swap( messageKinds );
+   mWriteSection.Unlock();
+
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   IsSpillSelected (Internal Method)
+
+DESCRIPTION:
+   Does the capture filter select the given buffer?  Only the raw headers
+   are looked at, and the result content only when failed responses are 
+   all that is selected
+
+   NOTE: must be called with the write mutex held
+
+PARAMETERS:
+   buf         [ I ] - The buffer
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cProtocolLog::IsSpillSelected( const sProtocolBuffer & buf ) const
+{
+   if (mbSpillFilter == false)
+   {
+      return true;
+   }
+
+   eProtocolType pt = buf.GetType();
+   const sQMIServiceInfo * pInfo = FindQMIServiceByProtocol( pt );
+   if (pInfo == 0)
+   {
+      return true;
+   }
+
+   // Control and service transaction headers differ
+   const BYTE * pData = buf.GetBuffer();
+   ULONG sz = buf.GetSize();
+
+   bool bResponse = false;
+   bool bIndication = false;
+   ULONG hdrSz = 0;
+   if (pInfo->mService == eQMI_SVC_CONTROL)
+   {
+      const sQMIControlRawTransactionHeader * pHdr = 
+         (const sQMIControlRawTransactionHeader *)pData;
+
+      hdrSz = (ULONG)sizeof( sQMIControlRawTransactionHeader );
+      if (sz < hdrSz + (ULONG)sizeof( sQMIRawMessageHeader ))
+      {
+         return false;
+      }
+
+      bResponse = (pHdr->mResponse == 1);
+      bIndication = (pHdr->mIndication == 1);
+   }
+   else
+   {
+      const sQMIServiceRawTransactionHeader * pHdr = 
+         (const sQMIServiceRawTransactionHeader *)pData;
+
+      hdrSz = (ULONG)sizeof( sQMIServiceRawTransactionHeader );
+      if (sz < hdrSz + (ULONG)sizeof( sQMIRawMessageHeader ))
+      {
+         return false;
+      }
+
+      bResponse = (pHdr->mResponse == 1);
+      bIndication = (pHdr->mIndication == 1);
+   }
+
+   const sQMIRawMessageHeader * pMsgHdr = 
+      (const sQMIRawMessageHeader *)(pData + hdrSz);
+
+   ULONG row = (ULONG)(pInfo - &gQMIServices[0]);
+   BYTE kinds = mSpillServiceKinds[row];
+
+   if (mSpillMessageKinds.empty() == false)
+   {
+      std::map <ULONG, BYTE>::const_iterator pIter;
+      pIter = mSpillMessageKinds.find( (row << 16) | pMsgHdr->mMessageID );
+      if (pIter != mSpillMessageKinds.end())
+      {
+         kinds |= pIter->second;
+      }
+   }
+
+   if (kinds == 0)
+   {
+      return false;
+   }
+
+   if (IsQMIProtocolTX( pt ) == true)
+   {
+      return ((kinds & PROTOCOL_LOG_KIND_REQUEST) != 0);
+   }
+
+   if (bIndication == true)
+   {
+      return ((kinds & PROTOCOL_LOG_KIND_INDICATION) != 0);
+   }
+
+   if ((kinds & PROTOCOL_LOG_KIND_RESPONSE) != 0)
+   {
+      return true;
+   }
+
+   if (bResponse == false || (kinds & PROTOCOL_LOG_KIND_ERROR) == 0)
+   {
+      return false;
+   }
+
+   // Look for the mandatory result content (0x02) of the response
+   ULONG offset = hdrSz + (ULONG)sizeof( sQMIRawMessageHeader );
+   ULONG end = offset + (ULONG)pMsgHdr->mLength;
+   if (end > sz)
+   {
+      end = sz;
+   }
+
+   const ULONG szContentHdr = (ULONG)sizeof( sQMIRawContentHeader );
+   while (offset + szContentHdr <= end)
+   {
+      const sQMIRawContentHeader * pTLV = 
+         (const sQMIRawContentHeader *)(pData + offset);
+
+      offset += szContentHdr;
+      if (pTLV->mTypeID == 0x02)
+      {
+         if (pTLV->mLength < 2 || offset + 2 > end)
+         {
+            return false;
+         }
+
+         WORD result = 0;
+         memcpy( &result, pData + offset, sizeof( result ) );
+         return (result != 0);
+      }
+
+      offset += (ULONG)pTLV->mLength;
+   }
+
+   return false;
+}
+
+/*===========================================================================
+METHOD:
+   Spill (Internal Method)
+
+DESCRIPTION:
+   Write an evicted buffer to the capture file
+
+   NOTE: must be called with the write mutex held
+
+PARAMETERS:
+   idx         [ I ] - Log index of the buffer
+   buf         [ I ] - The buffer
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cProtocolLog::Spill( 
+   ULONG                      idx,
+   const sProtocolBuffer &    buf )
+{
+   if (mpSpill == 0 || buf.IsValid() == false)
+   {
+      return;
+   }
+
+   // Filtered out buffers are not copied
+   if (IsSpillSelected( buf ) == false)
+   {
+      return;
+   }
+
+   sProtocolLogSpillHeader * pHdr = (sProtocolLogSpillHeader *)mpSpill;
+   ULONG start = sizeof( sProtocolLogSpillHeader );
+   ULONG sz = buf.GetSize();
+   ULONG recSz = sizeof( sProtocolLogSpillRecord ) + sz;
+
+   // Will it ever fit?
+   if (recSz > mSpillSize - start)
+   {
+      return;
+   }
+
+   // Wrap around? (everything left in the file is then older)
+   ULONG offset = pHdr->mWriteOffset;
+   if (offset + recSz > mSpillSize)
+   {
+      pHdr->mEndOffset = (UINT)offset;
+      pHdr->mOldestOffset = (UINT)start;
+      offset = start;
+   }
+
+   // Drop the old records this one overwrites
+   bool bWrapped = (pHdr->mOldestOffset > start || offset == start);
+   if (bWrapped == true && pHdr->mEndOffset > start)
+   {
+      ULONG oldest = pHdr->mOldestOffset;
+      while (oldest < offset + recSz && oldest < pHdr->mEndOffset)
+      {
+         const sProtocolLogSpillRecord * pOld = 
+            (const sProtocolLogSpillRecord *)(mpSpill + oldest);
+
+         oldest += sizeof( sProtocolLogSpillRecord ) + pOld->mSize;
+      }
+
+      // All the old records gone?
+      if (oldest >= pHdr->mEndOffset)
+      {
+         oldest = start;
+         bWrapped = false;
+      }
+
+      pHdr->mOldestOffset = (UINT)oldest;
+   }
+   else
+   {
+      bWrapped = false;
+   }
+
+   tm ts = buf.GetTimestamp();
+
+   sProtocolLogSpillRecord rec;
+   rec.mIndex = (ULONGLONG)idx;
+   rec.mType = (UINT)buf.GetType();
+   rec.mDate = (UINT)((ts.tm_year + 1900) * 10000 
+                    + (ts.tm_mon + 1) * 100 
+                    + ts.tm_mday);
+   rec.mTime = (UINT)(ts.tm_hour * 10000 + ts.tm_min * 100 + ts.tm_sec);
+   rec.mSize = (UINT)sz;
+
+   memcpy( mpSpill + offset, &rec, sizeof( rec ) );
+   memcpy( mpSpill + offset + sizeof( rec ), buf.GetBuffer(), (size_t)sz );
+
+   offset += recSz;
+   pHdr->mWriteOffset = (UINT)offset;
+   if (bWrapped == false)
+   {
+      pHdr->mEndOffset = (UINT)offset;
+   }
+
+   pHdr->mRecords++;
 }
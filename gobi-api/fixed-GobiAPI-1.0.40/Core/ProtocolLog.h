@@ -7,10 +7,15 @@ DESCRIPTION:
    
 PUBLIC CLASSES AND METHODS:
    cProtocolLog
-      This class stores protocol buffers in to a flat array (actually a
-      double-ended queue) so that they can be accessed by other objects 
-      during the flow of normal processing.  Note that the storage is
-      in-memory and therefore finite
+      This class stores protocol buffers in to a fixed size ring so that 
+      they can be accessed by other objects during the flow of normal 
+      processing.  Note that the storage is in-memory and therefore finite,
+      although buffers evicted from the ring can optionally be streamed to
+      a memory mapped capture file
+
+      Buffers are indexed by a monotonically increasing sequence number,
+      readers access the ring without locking and can detect when the 
+      buffer they are after has been overwritten (i.e. they were lapped)
 
 Copyright (c) 2011, Code Aurora Forum. All rights reserved.
 
@@ -49,15 +54,97 @@ POSSIBILITY OF SUCH DAMAGE.
 // Include Files
 //---------------------------------------------------------------------------
 #include "ProtocolBuffer.h"
-#include "SyncQueue.h"
+#include "Event.h"
+#include "ProfiledMutex.h"
 
 #include <climits>
+#include <map>
+#include <pthread.h>
+#include <vector>
 
 //---------------------------------------------------------------------------
 // Definitions
 //---------------------------------------------------------------------------
 const ULONG INVALID_LOG_INDEX = ULONG_MAX;
 
+// Kinds of QMI buffer selected by a capture filter (see 
+// cProtocolLog::SetSpillFilter()), errors being failed responses
+const BYTE PROTOCOL_LOG_KIND_REQUEST    = 0x01;
+const BYTE PROTOCOL_LOG_KIND_RESPONSE   = 0x02;
+const BYTE PROTOCOL_LOG_KIND_INDICATION = 0x04;
+const BYTE PROTOCOL_LOG_KIND_ERROR      = 0x08;
+
+/*=========================================================================*/
+// Struct sProtocolLogSlot
+//
+//    A single entry in the protocol log ring
+/*=========================================================================*/
+struct sProtocolLogSlot
+{
+   public:
+      // (Inline) Constructor
+      sProtocolLogSlot()
+         :  mBuffer(),
+            mSeq( 0 ),
+            mReaders( 0 )
+      { };
+
+      /* The logged buffer */
+      sProtocolBuffer mBuffer;
+
+      /* Log index of above buffer plus one (0 = empty/being written) */
+      volatile ULONG mSeq;
+
+      /* Number of readers currently copying the above buffer */
+      volatile ULONG mReaders;
+};
+
+/*=========================================================================*/
+// Struct sProtocolLogSpillHeader
+//
+//    Header at the start of a protocol log capture file, followed by 
+//    sProtocolLogSpillRecord records (each followed by its data).  Once 
+//    the file is full records wrap around to just after this header, 
+//    the records (oldest first) are then those in [mOldestOffset,
+//    mEndOffset) followed by those in [header end, mWriteOffset)
+/*=========================================================================*/
+struct sProtocolLogSpillHeader
+{
+   /* Signature (eSPILL_SIG) */
+   UINT mSignature;
+
+   /* Offset at which the next record will be written */
+   UINT mWriteOffset;
+
+   /* Offset of the oldest record (header end when not wrapped) */
+   UINT mOldestOffset;
+
+   /* Offset of the end of the oldest run of records */
+   UINT mEndOffset;
+
+   /* Total number of records written */
+   UINT mRecords;
+};
+
+/*=========================================================================*/
+// Struct sProtocolLogSpillRecord
+/*=========================================================================*/
+struct sProtocolLogSpillRecord
+{
+   /* Log index of the buffer */
+   ULONGLONG mIndex;
+
+   /* Protocol type of the buffer */
+   UINT mType;
+
+   /* Timestamp of the buffer (YYYYMMDD and HHMMSS) */
+   UINT mDate;
+   UINT mTime;
+
+   /* Size of the buffer data following this record */
+   UINT mSize;
+};
+
 /*=========================================================================*/
 // Class cProtocolLog
 /*=========================================================================*/
@@ -76,16 +163,92 @@ class cProtocolLog
       // Return the protocol buffer at the given index from the log
       virtual sProtocolBuffer GetBuffer( ULONG idx ) const;
 
+      // Return the protocol buffer at the given index from the log, 
+      // indicating if it is (still) available
+      virtual bool GetBuffer( 
+         ULONG                      idx,
+         sProtocolBuffer &          buf ) const;
+
       // Return the underlying signal event
       virtual cEvent & GetSignalEvent() const;
 
       // Return the total number of buffers added to the log
       virtual ULONG GetCount() const;
 
+      // Return the index of the oldest buffer still held in the log
+      virtual ULONG GetFirstIndex() const;
+
       // Clear the log
       virtual void Clear();
 
+      // Stream buffers evicted from the log to the given capture file
+      virtual bool StartSpill( 
+         LPCSTR                     pFileName,
+         ULONG                      maxBytes );
+
+      // Stop streaming evicted buffers to the capture file
+      virtual void StopSpill();
+
+      // Only stream the QMI buffers matching the given rules to the 
+      // capture file (0 or "" streams every buffer)
+      virtual bool SetSpillFilter( LPCSTR pFilter );
+
+      // (Inline) Set the name writer lock contention is accounted under
+      void SetLockName( LPCSTR pName )
+      {
+         mWriteSection.SetName( pName );
+      };
+
    protected:
+      // Write an evicted buffer to the capture file
+      void Spill( 
+         ULONG                      idx,
+         const sProtocolBuffer &    buf );
+
+      // Does the capture filter select the given buffer?
+      bool IsSpillSelected( const sProtocolBuffer & buf ) const;
+
+      // Claim a slot for writing, waiting out any readers
+      void ClaimSlot( sProtocolLogSlot & slot );
+
+      // Object signature
+      enum eClassConstants
+      {
+         eSPILL_SIG = 0x474F4C50
+      };
+
       /* The underlying 'log' */
-      cSyncQueue <sProtocolBuffer> mLog;
+      sProtocolLogSlot * mpSlots;
+
+      /* Number of slots in above ring */
+      ULONG mCapacity;
+
+      /* Total number of buffers added to the log */
+      volatile ULONG mTotal;
+
+      /* Multithreaded mutex serializing writers */
+      mutable cProfiledMutex mWriteSection;
+
+      /* Signal event, set everytime a buffer is added */
+      mutable cEvent mSignalEvent;
+
+      /* Capture file descriptor (-1 = not spilling) */
+      int mSpillFD;
+
+      /* Capture file mapping */
+      PBYTE mpSpill;
+
+      /* Size of above mapping */
+      ULONG mSpillSize;
+
+      /* Is a capture filter set? */
+      bool mbSpillFilter;
+
+      /* Capture filter, kinds selected for every message of a service 
+         (indexed by gQMIServices row) */
+      std::vector <BYTE> mSpillServiceKinds;
+
+      /* Capture filter, kinds selected for a single message (indexed by
+         gQMIServices row in the upper and message ID in the lower word) */
+      std::map <ULONG, BYTE> mSpillMessageKinds;
 };
@@ -73,7 +73,7 @@ RETURN VALUE:
    None
 ===========================================================================*/
 cProtocolQueueNotification::cProtocolQueueNotification( 
-   cSyncQueue <sProtocolNotificationEvent> * pSQ )
+   tProtocolNotificationQueue * pSQ )
    :  mpSQ( pSQ )
 {
    // Nothing to do
@@ -185,6 +185,10 @@ struct sProtocolNotificationEvent
       DWORD mParam2;
 };
 
+// Notification event queue (the protocol server never blocks adding events)
+typedef cSyncQueue <sProtocolNotificationEvent, sSyncQueueLockFree> 
+   tProtocolNotificationQueue;
+
 /*=========================================================================*/
 // Class cProtocolNotification
 //
@@ -194,6 +198,9 @@ struct sProtocolNotificationEvent
 class cProtocolNotification
 {
    public:
+      // (Inline) Destructor
+      virtual ~cProtocolNotification() { };
+
       // Return an allocated copy of this object
       virtual cProtocolNotification * Clone() const = 0;
 
@@ -207,14 +214,14 @@ class cProtocolNotification
 /*=========================================================================*/
 // Class cProtocolQueueNotification
 //
-//    This class provides notification via a cSyncQueue object
+//    This class provides notification via a (lock-free) cSyncQueue object
 //    populated with sProtocolNotificationEvent objects
 /*=========================================================================*/
 class cProtocolQueueNotification : public cProtocolNotification
 {
    public:
       // Constructor
-      cProtocolQueueNotification( cSyncQueue <sProtocolNotificationEvent> * pSQ );
+      cProtocolQueueNotification( tProtocolNotificationQueue * pSQ );
 
       // Copy constructor
       cProtocolQueueNotification( const cProtocolQueueNotification & notifier );
@@ -233,5 +240,5 @@ class cProtocolQueueNotification : public cProtocolNotification
 
    protected:
       /* Event notification queue */
-      mutable cSyncQueue <sProtocolNotificationEvent> * mpSQ;
+      mutable tProtocolNotificationQueue * mpSQ;
 };
@@ -127,7 +127,9 @@ sProtocolRequest::sProtocolRequest(
       mpNotifier( 0 ),
       mpAuxData( 0 ),
       mAuxDataSize( 0 ),
-      mbTXOnly( false )
+      mpAuxSource( 0 ),
+      mbTXOnly( false ),
+      mPriority( ePROTOCOL_PRIORITY_NORMAL )
 {
    // Constrain requested timeout to allowable range
    if (timeout < MIN_REQ_TIMEOUT)
@@ -154,6 +156,12 @@ sProtocolRequest::sProtocolRequest(
       mFrequency = frequency;
    }
 
+   // Repeated requests are polls, these yield to one-off requests
+   if (mRequests != MIN_REQ_ATTEMPTS)
+   {
+      mPriority = ePROTOCOL_PRIORITY_BACKGROUND;
+   }
+
    // Clone notifier?
    if (pNotifier != 0)
    {
@@ -189,7 +197,9 @@ sProtocolRequest::sProtocolRequest(
       mpNotifier( pNotifier ),
       mpAuxData( 0 ),
       mAuxDataSize( 0 ),
-      mbTXOnly( false )
+      mpAuxSource( 0 ),
+      mbTXOnly( false ),
+      mPriority( ePROTOCOL_PRIORITY_NORMAL )
 {
    // Clone notifier?
    if (pNotifier != 0)
@@ -222,7 +232,9 @@ sProtocolRequest::sProtocolRequest( const sProtocolRequest & req )
       mpNotifier( 0 ),
       mpAuxData( req.mpAuxData ),
       mAuxDataSize( req.mAuxDataSize ),
-      mbTXOnly( req.mbTXOnly )
+      mpAuxSource( 0 ),
+      mbTXOnly( req.mbTXOnly ),
+      mPriority( req.mPriority )
 {
    // Clone notifier?
    if (req.mpNotifier != 0)
@@ -230,7 +242,64 @@ sProtocolRequest::sProtocolRequest( const sProtocolRequest & req )
       mpNotifier = req.mpNotifier->Clone();
    }
 
+   // Clone auxiliary data source?
+   if (req.mpAuxSource != 0)
+   {
+      mpAuxSource = req.mpAuxSource->Clone();
+   }
+
+   Validate();
+}
+
+/*===========================================================================
+METHOD:
+   operator = 
+
+DESCRIPTION:
+   Assignment operator
+  
+PARAMETERS:
+   req         [ I ] - Request to copy
+
+RETURN VALUE:
+   sProtocolRequest &
+===========================================================================*/
+sProtocolRequest & sProtocolRequest::operator = ( 
+   const sProtocolRequest &   req )
+{
+   if (this == &req)
+   {
+      return *this;
+   }
+
+   sProtocolBuffer::operator = ( req );
+
+   mSchedule = req.mSchedule;
+   mTimeout = req.mTimeout;
+   mRequests = req.mRequests;
+   mFrequency = req.mFrequency;
+   mpAuxData = req.mpAuxData;
+   mAuxDataSize = req.mAuxDataSize;
+   mbTXOnly = req.mbTXOnly;
+   mPriority = req.mPriority;
+
+   // Replace cloned notifier
+   if (mpNotifier != 0)
+   {
+      delete mpNotifier;
+      mpNotifier = 0;
+   }
+
+   if (req.mpNotifier != 0)
+   {
+      mpNotifier = req.mpNotifier->Clone();
+   }
+
+   // Replace cloned auxiliary data source
+   SetAuxiliaryData( req.mpAuxSource );
+
    Validate();
+   return *this;
 }
 
 /*===========================================================================
@@ -251,4 +320,48 @@ sProtocolRequest::~sProtocolRequest()
       delete mpNotifier;
       mpNotifier = 0;
    }
+
+   // Delete cloned auxiliary data source?
+   if (mpAuxSource != 0)
+   {
+      delete mpAuxSource;
+      mpAuxSource = 0;
+   }
+}
+
+/*===========================================================================
+METHOD:
+   SetAuxiliaryData (Public Method)
+
+DESCRIPTION:
+   Set the source of the auxiliary data, which the protocol server then 
+   streams out after the request one transmission unit at a time (this
+   replaces any auxiliary data set as a buffer)
+  
+PARAMETERS:
+   pSource     [ I ] - Auxiliary data source (cloned, 0 to clear)
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void sProtocolRequest::SetAuxiliaryData( const cAuxDataSource * pSource )
+{
+   if (pSource == mpAuxSource && pSource != 0)
+   {
+      return;
+   }
+
+   if (mpAuxSource != 0)
+   {
+      delete mpAuxSource;
+      mpAuxSource = 0;
+   }
+
+   if (pSource != 0)
+   {
+      mpAuxData = 0;
+      mAuxDataSize = 0;
+
+      mpAuxSource = pSource->Clone();
+   }
 }
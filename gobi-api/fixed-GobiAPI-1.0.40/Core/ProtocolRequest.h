@@ -47,6 +47,7 @@ POSSIBILITY OF SUCH DAMAGE.
 // Include Files
 //---------------------------------------------------------------------------
 #include "ProtocolBuffer.h"
+#include "AuxDataSource.h"
 
 //---------------------------------------------------------------------------
 // Forward Declarations
@@ -74,6 +75,19 @@ extern const ULONG INFINITE_REQS;
 extern const ULONG MIN_REQ_FREQUENCY;
 extern const ULONG DEFAULT_REQ_FREQUENCY;
 
+// Scheduling priority of a request (due control requests are always sent
+// first, normal and background requests share what remains by weight)
+enum eProtocolPriority
+{
+   ePROTOCOL_PRIORITY_BEGIN = -1,
+
+   ePROTOCOL_PRIORITY_CONTROL,      // Connection control (strict priority)
+   ePROTOCOL_PRIORITY_NORMAL,       // One-off requests (the default)
+   ePROTOCOL_PRIORITY_BACKGROUND,   // Repeated (polling) requests
+
+   ePROTOCOL_PRIORITY_END
+};
+
 /*=========================================================================*/
 // Struct sProtocolRequest
 //
@@ -105,6 +119,9 @@ struct sProtocolRequest : public sProtocolBuffer
       // Copy constructor
       sProtocolRequest( const sProtocolRequest & req );
 
+      // Assignment operator
+      sProtocolRequest & operator = ( const sProtocolRequest & req );
+
       // Destructor
       virtual ~sProtocolRequest();
 
@@ -142,17 +159,28 @@ struct sProtocolRequest : public sProtocolBuffer
          const BYTE *               pData,
          ULONG                      dataSz )
       {
+         SetAuxiliaryData( 0 );
+
          mpAuxData = pData;
          mAuxDataSize = dataSz;
       };
 
-      // (Inline) Get auxiliary data
+      // Set auxiliary data source (streamed by the server)
+      void SetAuxiliaryData( const cAuxDataSource * pSource );
+
+      // (Inline) Get auxiliary data (0 when set from a source)
       const BYTE * GetAuxiliaryData( ULONG & dataSz ) const
       {
          dataSz = mAuxDataSize;
          return mpAuxData;
       };
 
+      // (Inline) Get auxiliary data source (0 if none)
+      const cAuxDataSource * GetAuxiliarySource() const
+      {
+         return mpAuxSource;
+      };
+
       // (Inline) Set TX only flag
       void SetTXOnly()
       {
@@ -162,7 +190,23 @@ struct sProtocolRequest : public sProtocolBuffer
       // (Inline) Get TX only flag
       bool IsTXOnly() const
       {
-         return mbTXOnly;
+         return (mbTXOnly != 0);
+      };
+
+      // (Inline) Set scheduling priority
+      void SetPriority( eProtocolPriority priority )
+      {
+         if (priority > ePROTOCOL_PRIORITY_BEGIN 
+         &&  priority < ePROTOCOL_PRIORITY_END)
+         {
+            mPriority = priority;
+         }
+      };
+
+      // (Inline) Get scheduling priority
+      eProtocolPriority GetPriority() const
+      {
+         return (eProtocolPriority)mPriority;
       };
 
    protected:
@@ -187,7 +231,13 @@ struct sProtocolRequest : public sProtocolBuffer
       /* Auxilary data size */
       ULONG mAuxDataSize;
 
+      /* Auxiliary data source (cloned, replaces the above) */
+      cAuxDataSource * mpAuxSource;
+
       /* TX only (i.e. do not wait for a response) ? */
-      bool mbTXOnly;
+      UINT mbTXOnly : 1;
+
+      /* Scheduling priority (eProtocolPriority) */
+      UINT mPriority : 2;
 };
 
@@ -45,7 +45,9 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "ProtocolServer.h"
 #include "ProtocolNotification.h"
 
+#include <algorithm>
 #include <climits>
+#include <syslog.h>
 
 //---------------------------------------------------------------------------
 // Definitions
@@ -63,6 +65,41 @@ const ULONG MAX_AUX_MTU_SIZE = 1024 * 256;
 // USB's MaxPacketSize
 const ULONG MAX_PACKET_SIZE = 512;
 
+// Maximum number of auxiliary data transmission units handed to the port
+// with a single (gathering) write
+const ULONG MAX_AUX_TUS_IN_FLIGHT = 16;
+
+// Default (and minimum) number of requests awaiting a response at once
+const ULONG DEFAULT_IN_FLIGHT_WINDOW = 1;
+
+// Largest number of times the retransmission timeout is doubled
+const ULONG MAX_RTO_BACKOFF = 6;
+
+// Largest number of requests transmitted with a single write
+const ULONG MAX_TX_BATCH = 16;
+
+// Request IDs carry the index of their record in the low bits and the
+// number of times the record has been taken (never 0) above those, so the
+// ID of a finished request does not match the one reusing its record
+const ULONG REQ_SLOT_BITS = 16;
+const ULONG REQ_SLOT_MASK = (1UL << REQ_SLOT_BITS) - 1;
+const ULONG REQ_GENERATION_MASK = 0xFFFF;
+
+// No request record (end of the free list)
+const ULONG REQ_SLOT_NONE = ULONG_MAX;
+
+// Largest transmit coalescing window (milliseconds)
+const ULONG MAX_TX_COALESCING = 50;
+
+// Sends per weighted round of each priority (control requests are always
+// sent first, so their weight is unused)
+static const ULONG gPriorityWeights[ePROTOCOL_PRIORITY_END] =
+{
+   0,
+   4,
+   1
+};
+
 // Maximum amount of time to wait on external access synchronization object
 #ifdef DEBUG
    // For the sake of debugging do not be so quick to assume failure
@@ -108,15 +145,22 @@ void * ScheduleThread( PVOID pArg )
           pthread_self() );
    
    // Default wait event
-   timespec toTime = TimeIn( DEFAULT_WAIT );
+   ULONGLONG toTime = GetTickCount() + DEFAULT_WAIT;
 
    // Return value checking
    int nRet;
    
    while (pServer->mbExiting == false)
    {
+      DWORD waitTime = 0;
+      ULONGLONG nowTime = GetTickCount();
+      if (toTime > nowTime)
+      {
+         waitTime = (DWORD)(toTime - nowTime);
+      }
+
       DWORD nTemp; 
-      nRet = pServer->mThreadScheduleEvent.Wait( TimeFromNow( toTime ), nTemp );
+      nRet = pServer->mThreadScheduleEvent.Wait( waitTime, nTemp );
       if (nRet != 0 && nRet != ETIME)
       {
          // Error condition
@@ -133,7 +177,7 @@ void * ScheduleThread( PVOID pArg )
          break;
       }
 
-      nRet = pthread_mutex_lock( &pServer->mScheduleMutex );
+      nRet = pServer->mScheduleMutex.Lock();
       if (nRet != 0)
       {
          // Error condition
@@ -144,14 +188,19 @@ void * ScheduleThread( PVOID pArg )
          break;
       }
 
-      // Verify time.  In the rare event it does move backward
-      // it would simply place all our schedule items as due now
-      pServer->CheckSystemTime();
-      
-      // Default next wait period
-      toTime = TimeIn( DEFAULT_WAIT );
+      // Exit() may have got the mutex first
+      if (pServer->mbExiting == true)
+      {
+         pServer->mScheduleMutex.Unlock();
+         break;
+      }
+
+      // Note: all timers run off the monotonic clock, so system time
+      // changes cannot strand (or prematurely expire) any of them
+      ULONGLONG curTime = GetTickCount();
 
-      timespec curTime = TimeIn( 0 );
+      // Default next wait period
+      toTime = curTime + DEFAULT_WAIT;
 
       if (pServer->mpActiveRequest != 0)
       {
@@ -185,41 +234,81 @@ void * ScheduleThread( PVOID pArg )
             TRACE( "ScheduleThread() Sequencing error: "
                    "Active request %lu is not waiting for response ???\n",
                    pServer->mpActiveRequest->mID );
-            pthread_mutex_unlock( &pServer->mScheduleMutex );
+            pServer->mScheduleMutex.Unlock();
             break;
          }
       }
 
-      if (pServer->mpActiveRequest == 0 
-          && pServer->mRequestSchedule.size() > 0)
+      // Check the response timers of any in-flight requests
+      pServer->CheckInFlightTimeouts( curTime, toTime );
+
+      // Move every scheduled item that is now due to the ready queues
+      pServer->mRequestSchedule.Advance( curTime );
+      pServer->QueueDueRequests();
+
+      // No response timer active, start the due scheduled items as one
+      //    batch in priority order (as many as the in-flight window 
+      //    allows, items that are rescheduled as already due wait for 
+      //    the next pass)
+      ULONG dueItems = pServer->GetReadyCount();
+
+      // Too few to fill the in-flight window? Then they may be held for 
+      //    the transmit coalescing window so that more can go along
+      bool bHeld = pServer->HoldForCoalescing( dueItems, curTime, toTime );
+      if (bHeld == false)
+      {
+         // Process scheduled items
+         pServer->ProcessRequests( dueItems );
+      }
+
+      // Statistics dump due before the next wake up?
+      bool bDumpStats = false;
+      if (pServer->mStatsDumpInterval > 0)
       {
-         // No response timer active, ready to start the next 
-         //    scheduled item if due
-         
-         timespec scheduledItem = pServer->GetNextRequestTime();
-         
-         // Is item due to be scheduled?
-         if (scheduledItem <= curTime)
+         if (pServer->mNextStatsDump <= curTime)
          {
-            // Process scheduled item
-            pServer->ProcessRequest();
+            bDumpStats = true;
+            pServer->mNextStatsDump = curTime + pServer->mStatsDumpInterval;
          }
-         else
+
+         if (pServer->mNextStatsDump <= toTime)
          {
-            // Scheduled item is not yet due to be processed
-            // Default timeout again, or this item's start time?
-            if (scheduledItem <= toTime)
-            {
-               toTime = scheduledItem;
-            }
+            toTime = pServer->mNextStatsDump;
+         }
+      }
+
+      ULONGLONG scheduledItem = 0;
+      if (bHeld == false
+          && pServer->mpActiveRequest == 0 
+          && pServer->mInFlight.size() < pServer->mInFlightWindow
+          && pServer->GetReadyCount() > 0)
+      {
+         // Ready items left over, process them right away
+         toTime = curTime;
+      }
+      else if (pServer->mpActiveRequest == 0 
+          && pServer->mInFlight.size() < pServer->mInFlightWindow
+          && pServer->mRequestSchedule.GetNextExpiry( scheduledItem ) == true)
+      {
+         // Scheduled item is not yet due to be processed
+         // Default timeout again, or this item's start time?
+         if (scheduledItem <= toTime)
+         {
+            toTime = scheduledItem;
          }
       }
       
-      /*TRACE( "Updated timer at %llu waiting %lu\n", 
+      /*TRACE( "Updated timer at %llu waiting until %llu\n", 
              GetTickCount(), 
-             TimeFromNow( toTime ) );  */
+             toTime );  */
       
-      pthread_mutex_unlock( &pServer->mScheduleMutex );
+      pServer->mScheduleMutex.Unlock();
+
+      // The statistics are lock free, log them outside of the mutex
+      if (bDumpStats == true)
+      {
+         pServer->DumpStatistics();
+      }
    }
 
    TRACE( "Schedule thread [%lu] exited\n", 
@@ -236,18 +325,21 @@ DESCRIPTION:
    Fill timespec with the time it will be in specified milliseconds
    Relative time to Absolute time
 
+   NOTE: This time is based on the monotonic clock (which system time 
+   changes do not affect), not the time since epoc
+
 PARAMETERS:
    millis   [ I ] - Milliseconds from current time
 
 RETURN VALUE:
-   timespec - resulting time (from epoc)
+   timespec - resulting (monotonic) time
      NOTE: tv_sec of 0 is an error
 ===========================================================================*/
 timespec TimeIn( ULONG millis )
 {
    timespec outTime;
 
-   int nRC = clock_gettime( CLOCK_REALTIME, &outTime );
+   int nRC = clock_gettime( CLOCK_MONOTONIC, &outTime );
    if (nRC == 0)
    {
       // Add avoiding an overflow on (long)nsec
@@ -279,7 +371,7 @@ DESCRIPTION:
    Absolute time to Relative time
 
 PARAMETERS:
-   time   [ I ] - Absolute time
+   time   [ I ] - Absolute (monotonic) time
 
 RETURN VALUE:
    Milliseconds in which absolute time will occur
@@ -291,7 +383,7 @@ ULONG TimeFromNow( timespec time )
    ULONG nOutTime = 0;
 
    timespec now;
-   int nRC = clock_gettime( CLOCK_REALTIME, &now );
+   int nRC = clock_gettime( CLOCK_MONOTONIC, &now );
    if (nRC == -1)
    {
       TRACE( "Error %d with gettime, %s\n", errno, strerror( errno ) );
@@ -317,8 +409,8 @@ DESCRIPTION:
    Provide a number for sequencing reference, similar to the windows
    ::GetTickCount().  
    
-   NOTE: This number is based on the time since epoc, not 
-   uptime.
+   NOTE: This number is based on the monotonic clock (i.e. roughly
+   uptime), not the time since epoc.
 
 PARAMETERS:
 
@@ -335,6 +427,24 @@ ULONGLONG GetTickCount()
    return outtime;
 }
 
+/*===========================================================================
+METHOD:
+   GetMicroTickCount (Free Method)
+   
+DESCRIPTION:
+   Provide a microsecond resolution version of GetTickCount(), used for
+   latency measurements (on the clock protocol buffers are stamped with)
+
+PARAMETERS:
+
+RETURN VALUE:
+   ULONGLONG - Number of microseconds system has been up
+===========================================================================*/
+ULONGLONG GetMicroTickCount()
+{
+   return GetMonotonicTime() / 1000ULL;
+}
+
 /*=========================================================================*/
 // cProtocolServerRxCallback Methods
 /*=========================================================================*/
@@ -363,6 +473,71 @@ void cProtocolServerRxCallback::IOComplete(
    }
 }
 
+/*=========================================================================*/
+// cProtocolServer::sRTTEstimate Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   AddSample (Public Method)
+
+DESCRIPTION:
+   Fold a round trip time sample into the estimate (RFC 6298, the first
+   sample seeds the smoothed time and half of it the variation)
+
+PARAMETERS:
+   rtt         [ I ] - Round trip time (microseconds)
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cProtocolServer::sRTTEstimate::AddSample( ULONGLONG rtt )
+{
+   if (mSamples++ == 0)
+   {
+      mSRTT = rtt;
+      mRTTVar = rtt / 2;
+      return;
+   }
+
+   ULONGLONG delta = (mSRTT > rtt ? mSRTT - rtt : rtt - mSRTT);
+
+   // RTTVAR = 3/4 RTTVAR + 1/4 |SRTT - R|, SRTT = 7/8 SRTT + 1/8 R
+   mRTTVar = (3 * mRTTVar + delta) / 4;
+   mSRTT = (7 * mSRTT + rtt) / 8;
+}
+
+/*===========================================================================
+METHOD:
+   GetRTO (Public Method)
+
+DESCRIPTION:
+   Return the retransmission timeout, SRTT + 4 * RTTVAR no lower than the
+   minimum request timeout
+
+RETURN VALUE:
+   ULONG - Timeout in milliseconds (0 if there have been no samples yet)
+===========================================================================*/
+ULONG cProtocolServer::sRTTEstimate::GetRTO() const
+{
+   if (mSamples == 0)
+   {
+      return 0;
+   }
+
+   ULONGLONG rto = (mSRTT + 4 * mRTTVar + 999) / 1000;
+   if (rto < MIN_REQ_TIMEOUT)
+   {
+      rto = MIN_REQ_TIMEOUT;
+   }
+   else if (rto > MAX_REQ_TIMEOUT)
+   {
+      rto = MAX_REQ_TIMEOUT;
+   }
+
+   return (ULONG)rto;
+}
+
 /*=========================================================================*/
 // cProtocolServer::sProtocolReqRsp Methods
 /*=========================================================================*/
@@ -372,7 +547,81 @@ METHOD:
    cProtocolServer::sProtocolReqRsp (Public Method)
 
 DESCRIPTION:
-   Constructor
+   Constructor (free record)
+
+RETURN VALUE:
+   None
+===========================================================================*/
+cProtocolServer::sProtocolReqRsp::sProtocolReqRsp()
+   :  sTimerWheelNode(),
+      mID( INVALID_REQUEST_ID ),
+      mState( eREQ_STATE_FREE ),
+      mbWaitingForResponse( 0 ),
+      mbRetransmit( 0 ),
+      mPriority( ePROTOCOL_PRIORITY_NORMAL ),
+      mStartTime( 0 ),
+      mDueTime( 0 ),
+      mSentTime( 0 ),
+      mDeadline( 0 ),
+      mRetransmits( 0 ),
+      mAttempts( 0 ),
+      mCycleAttempts( 0 ),
+      mEncodedSize( 0 ),
+      mRequiredAuxTxs( 0 ),
+      mCurrentAuxTx( 0 ),
+      mAuxTUSize( 0 ),
+      mStatsKey( 0 ),
+      mNextFree( REQ_SLOT_NONE ),
+      mRequest( 0 )
+{
+   // Nothing to do
+}
+
+/*===========================================================================
+METHOD:
+   cProtocolServer::sProtocolReqRsp (Public Method)
+
+DESCRIPTION:
+   Coop constructor
+
+PARAMETERS:
+   reqRsp      [ I ] - Object being copied
+
+RETURN VALUE:
+   None
+===========================================================================*/
+cProtocolServer::sProtocolReqRsp::sProtocolReqRsp( 
+   const sProtocolReqRsp &    reqRsp )
+   :  sTimerWheelNode( reqRsp ),
+      mID( reqRsp.mID ),
+      mState( reqRsp.mState ),
+      mbWaitingForResponse( reqRsp.mbWaitingForResponse ),
+      mbRetransmit( reqRsp.mbRetransmit ),
+      mPriority( reqRsp.mPriority ),
+      mStartTime( reqRsp.mStartTime ),
+      mDueTime( reqRsp.mDueTime ),
+      mSentTime( reqRsp.mSentTime ),
+      mDeadline( reqRsp.mDeadline ),
+      mRetransmits( reqRsp.mRetransmits ),
+      mAttempts( reqRsp.mAttempts ),
+      mCycleAttempts( reqRsp.mCycleAttempts ),
+      mEncodedSize( reqRsp.mEncodedSize ),
+      mRequiredAuxTxs( reqRsp.mRequiredAuxTxs ),
+      mCurrentAuxTx( reqRsp.mCurrentAuxTx ),
+      mAuxTUSize( reqRsp.mAuxTUSize ),
+      mStatsKey( reqRsp.mStatsKey ),
+      mNextFree( reqRsp.mNextFree ),
+      mRequest( reqRsp.mRequest )
+{
+   // Nothing to do
+};
+
+/*===========================================================================
+METHOD:
+   Init (Public Method)
+
+DESCRIPTION:
+   Take on the given request (the record must be free)
 
 PARAMETERS:
    requestInfo [ I ] - Underlying request object
@@ -382,29 +631,61 @@ PARAMETERS:
 RETURN VALUE:
    None
 ===========================================================================*/
-cProtocolServer::sProtocolReqRsp::sProtocolReqRsp(
+void cProtocolServer::sProtocolReqRsp::Init(
    const sProtocolRequest &   requestInfo,
    ULONG                      requestID,
    ULONG                      auxDataMTU )
-   :  mRequest( requestInfo ),
-      mID( requestID ),
-      mAttempts( 0 ),
-      mEncodedSize( requestInfo.GetSize() ),
-      mRequiredAuxTxs( 0 ),
-      mCurrentAuxTx( 0 ),
-      mbWaitingForResponse( false )
 {
+   mID = requestID;
+   mState = eREQ_STATE_PENDING;
+   mbWaitingForResponse = 0;
+   mbRetransmit = 0;
+   mPriority = requestInfo.GetPriority();
+   mStartTime = 0;
+   mDueTime = 0;
+   mSentTime = 0;
+   mDeadline = 0;
+   mRetransmits = 0;
+   mAttempts = 0;
+   mCycleAttempts = 0;
+   mEncodedSize = requestInfo.GetSize();
+   mRequiredAuxTxs = 0;
+   mCurrentAuxTx = 0;
+   mAuxTUSize = auxDataMTU;
+   mStatsKey = 0;
+   mNextFree = REQ_SLOT_NONE;
+   mRequest = requestInfo;
+
    ULONG auxDataSz = 0;
    const BYTE * pAuxData = requestInfo.GetAuxiliaryData( auxDataSz );
 
+   // A source streams its data in its own (smaller) transmission units,
+   // laid out as it sees fit (e.g. never spanning two links of a chain)
+   const cAuxDataSource * pAuxSource = requestInfo.GetAuxiliarySource();
+   if (pAuxSource != 0)
+   {
+      ULONG tuSz = pAuxSource->GetTUSize();
+      if (tuSz > 0 && tuSz < auxDataMTU)
+      {
+         mAuxTUSize = tuSz;
+      }
+
+      if (mAuxTUSize > 0)
+      {
+         mRequiredAuxTxs = pAuxSource->GetTUCount( mAuxTUSize );
+      }
+
+      return;
+   }
+
    // Compute the number of required auxiliary data transmissions?
-   if (auxDataMTU > 0 && pAuxData != 0 && auxDataSz > 0)
+   if (mAuxTUSize > 0 && pAuxData != 0 && auxDataSz > 0)
    {
       mRequiredAuxTxs = 1;
-      if (auxDataSz > auxDataMTU)
+      if (auxDataSz > mAuxTUSize)
       {
-         mRequiredAuxTxs = auxDataSz / auxDataMTU;
-         if ((auxDataSz % auxDataMTU) != 0)
+         mRequiredAuxTxs = auxDataSz / mAuxTUSize;
+         if ((auxDataSz % mAuxTUSize) != 0)
          {   
             mRequiredAuxTxs++;
          }
@@ -414,29 +695,52 @@ cProtocolServer::sProtocolReqRsp::sProtocolReqRsp(
 
 /*===========================================================================
 METHOD:
-   cProtocolServer::sProtocolReqRsp (Public Method)
+   GetAuxTU (Public Method)
 
 DESCRIPTION:
-   Coop constructor
+   Get the given auxiliary data transmission unit, straight from the
+   auxiliary data (buffer or source) of the request
 
 PARAMETERS:
-   reqRsp      [ I ] - Object being copied
+   tu          [ I ] - Transmission unit index
+   tuSz        [ O ] - Size of the transmission unit
 
 RETURN VALUE:
-   None
+   const BYTE * - 0 if there is no such transmission unit
 ===========================================================================*/
-cProtocolServer::sProtocolReqRsp::sProtocolReqRsp( 
-   const sProtocolReqRsp &    reqRsp )
-   :  mRequest( reqRsp.mRequest ),
-      mID( reqRsp.mID ),
-      mAttempts( reqRsp.mAttempts ),
-      mEncodedSize( reqRsp.mEncodedSize ),
-      mRequiredAuxTxs( reqRsp.mRequiredAuxTxs ),
-      mCurrentAuxTx( reqRsp.mCurrentAuxTx ),
-      mbWaitingForResponse( reqRsp.mbWaitingForResponse )
+const BYTE * cProtocolServer::sProtocolReqRsp::GetAuxTU(
+   ULONG                      tu,
+   ULONG &                    tuSz ) const
 {
-   // Nothing to do
-};
+   tuSz = 0;
+   if (tu >= mRequiredAuxTxs)
+   {
+      return 0;
+   }
+
+   const cAuxDataSource * pAuxSource = mRequest.GetAuxiliarySource();
+   if (pAuxSource != 0)
+   {
+      return pAuxSource->GetTU( tu, mAuxTUSize, tuSz );
+   }
+
+   ULONG auxDataSz = 0;
+   const BYTE * pAuxData = mRequest.GetAuxiliaryData( auxDataSz );
+
+   ULONG offset = tu * mAuxTUSize;
+   if (offset >= auxDataSz)
+   {
+      return 0;
+   }
+
+   tuSz = auxDataSz - offset;
+   if (tuSz > mAuxTUSize)
+   {
+      tuSz = mAuxTUSize;
+   }
+
+   return pAuxData + offset;
+}
 
 /*=========================================================================*/
 // cProtocolServer Methods
@@ -470,36 +774,43 @@ cProtocolServer::cProtocolServer(
       mRxCallback(),
       mScheduleThreadID( 0 ),
       mThreadScheduleEvent(),
+      mScheduleMutex(),
       mbExiting( false ),
       mpServerControl( 0 ),
-      mLastRequestID( 1 ),
+      mRequestSchedule( GetTickCount() ),
+      mRequestSlots(),
+      mFreeSlot( REQ_SLOT_NONE ),
       mpActiveRequest( 0 ),
+      mActiveRequestTimeout( 0 ),
+      mInFlight(),
+      mResponseTimers( GetTickCount() ),
+      mInFlightWindow( DEFAULT_IN_FLIGHT_WINDOW ),
+      mInFlightRspID( INVALID_REQUEST_ID ),
+      mbErrorRsp( false ),
+      mStatistics(),
+      mStatsDumpInterval( 0 ),
+      mNextStatsDump( 0 ),
+      mbAdaptiveTimeouts( false ),
+      mTxCoalescing( 0 ),
+      mRTTEstimates(),
+      mServerRTT(),
       mpRxBuffer( 0 ),
+      mpRxArmedBuffer( 0 ),
       mRxBufferSize( bufferSzRx ),
       mRxType( rxType ),
       mTxType( txType ),
       mLog( logSz )
 {
-   mLastTime = TimeIn( 0 );
-
-   // Allocate receive buffer?
-   if (mRxBufferSize > 0 && mComm.IsValid() == true)
+   for (ULONG p = 0; p < (ULONG)ePROTOCOL_PRIORITY_END; p++)
    {
-      mpRxBuffer = new BYTE[mRxBufferSize];
+      mPriorityCredits[p] = gPriorityWeights[p];
    }
 
-   // Before continuing verify receive buffer was allocated
-   if (mpRxBuffer != 0)
+   // Allocate receive buffers?
+   if (mRxBufferSize > 0 && mComm.IsValid() == true)
    {
-      // Schedule mutex
-      int nRet = pthread_mutex_init( &mScheduleMutex, NULL );
-      if (nRet != 0)
-      {
-         TRACE( "Unable to init schedule mutex. Error %d: %s\n",
-                nRet,
-                strerror( nRet ) );
-         return;
-      }
+      mpRxBuffer = new BYTE[mRxBufferSize];
+      mpRxArmedBuffer = new BYTE[mRxBufferSize];
    }
 }
 
@@ -521,96 +832,287 @@ cProtocolServer::~cProtocolServer()
    // This should have already been called, but ...
    Exit();
 
-   // Schedule mutex
-   int nRet = pthread_mutex_destroy( &mScheduleMutex );
-   if (nRet != 0)
-   {
-      TRACE( "Unable to destroy schedule mutex. Error %d: %s\n",
-             nRet,
-             strerror( nRet ) );
-   }
-   
-   // Free receive buffer
+   // Free receive buffers
    if (mpRxBuffer != 0)
    {
       delete [] mpRxBuffer;
       mpRxBuffer = 0;
    }
+
+   if (mpRxArmedBuffer != 0)
+   {
+      delete [] mpRxArmedBuffer;
+      mpRxArmedBuffer = 0;
+   }
 }
 
 /*===========================================================================
 METHOD:
-   HandleRemoveRequest (Public Method)
+   CheckRequest (Internal Method)
 
 DESCRIPTION:
-   Remove a previously added protocol request 
-   
-   Note: if a request is being processed, it cannot be inturrupted
+   Can the given outgoing protocol request be added to this server?
 
 PARAMETERS:
-   reqID       [ I ] - Server assigned request ID
+   req        [ I ] - Request being checked
 
 SEQUENCING:
-   Calling process must have lock on mScheduleMutex
+   None
 
 RETURN VALUE:
    bool
 ===========================================================================*/
-bool cProtocolServer::HandleRemoveRequest( ULONG reqID )
+bool cProtocolServer::CheckRequest( const sProtocolRequest & req )
 {
-   // Assume failure
-   bool bRC = false;
+   // Server not configured for sending requests?
+   if (IsValid( mTxType ) == false)
+   {
+      return false;
+   }
 
-   // Find and erase request from request map
-   std::map <ULONG, sProtocolReqRsp *>::iterator pReqIter;
-   pReqIter = mRequestMap.find( reqID );
+   // Request type not valid for server?
+   if (req.GetType() != mTxType)
+   {
+      return false;
+   }
 
-   if (pReqIter != mRequestMap.end())
+   // Invalide request?
+   if (ValidateRequest( req ) == false)
    {
-      sProtocolReqRsp * pReqRsp = pReqIter->second;
-      if (pReqRsp != 0)
-      {
-         delete pReqRsp;
-      }
+      return false;
+   }
 
-      mRequestMap.erase( pReqIter );
+   return true;
+}
 
-      // Success!
-      bRC = true;
+/*===========================================================================
+METHOD:
+   AllocRequest (Internal Method)
 
-      // Find and erase request from schedule
-      bool bFound = false;
-      int entryIndex = -1;
+DESCRIPTION:
+   Take a free request record (growing the records as needed) for the 
+   given request and assign it the next request ID of that record
 
-      std::set <tSchedule>::iterator pScheduleIter;
-      pScheduleIter = mRequestSchedule.begin();
-      
-      while (pScheduleIter != mRequestSchedule.end())
-      {
-         entryIndex++;
+PARAMETERS:
+   req        [ I ] - Request being added
 
-         tSchedule entry = *pScheduleIter;
-         if (entry.second == reqID)
-         {
-            bFound = true;
-            mRequestSchedule.erase( pScheduleIter );
-            break;
-         }
-         else
-         {
-            pScheduleIter++;
-         }
-      }
+SEQUENCING:
+   Calling process must have lock on mScheduleMutex
 
-      // Note: schedule will be updated when mutex is unlocked/signaled
+RETURN VALUE:
+   sProtocolReqRsp * - The (pending) record, 0 if there are no more left
+===========================================================================*/
+cProtocolServer::sProtocolReqRsp * cProtocolServer::AllocRequest( 
+   const sProtocolRequest &   req )
+{
+   ULONG slot = mFreeSlot;
+   if (slot != REQ_SLOT_NONE)
+   {
+      mFreeSlot = mRequestSlots[slot].mNextFree;
    }
-   else if (mpActiveRequest != 0 && mpActiveRequest->mID == reqID)
+   else if (mRequestSlots.size() <= REQ_SLOT_MASK)
    {
-      const sProtocolRequest & req = mpActiveRequest->mRequest;
-      const cProtocolNotification * pNotifier = req.GetNotifier();
+      slot = (ULONG)mRequestSlots.size();
+      mRequestSlots.push_back( sProtocolReqRsp() );
+   }
+   else
+   {
+      TRACE( "cProtocolServer::AllocRequest(), no request records left\n" );
+      return 0;
+   }
 
-      // Cancel the response timer (when active)
-      if (mpActiveRequest->mbWaitingForResponse == true)
+   sProtocolReqRsp & reqRsp = mRequestSlots[slot];
+
+   // Next generation of the record, skipping 0 so that the ID is valid
+   ULONG gen = ((reqRsp.mID >> REQ_SLOT_BITS) + 1) & REQ_GENERATION_MASK;
+   if (gen == 0)
+   {
+      gen = 1;
+   }
+
+   reqRsp.Init( req, (gen << REQ_SLOT_BITS) | slot, MAX_AUX_MTU_SIZE );
+   return &reqRsp;
+}
+
+/*===========================================================================
+METHOD:
+   FreeRequest (Internal Method)
+
+DESCRIPTION:
+   Return a request record, which must no longer be referenced by the
+   schedule, the ready queues, mpActiveRequest or mInFlight, to the free
+   list (releasing the underlying request)
+
+PARAMETERS:
+   pReqRsp     [ I ] - Record being freed
+
+SEQUENCING:
+   Calling process must have lock on mScheduleMutex
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cProtocolServer::FreeRequest( sProtocolReqRsp * pReqRsp )
+{
+   // The ID is kept, it holds the generation of the record
+   pReqRsp->mState = eREQ_STATE_FREE;
+   pReqRsp->mRequest = sProtocolRequest( 0 );
+
+   pReqRsp->mNextFree = mFreeSlot;
+   mFreeSlot = pReqRsp->mID & REQ_SLOT_MASK;
+}
+
+/*===========================================================================
+METHOD:
+   FindRequest (Internal Method)
+
+DESCRIPTION:
+   Find the request record with the given ID in the given state
+
+PARAMETERS:
+   reqID       [ I ] - Server assigned request ID
+   state       [ I ] - State the request must be in
+
+SEQUENCING:
+   Calling process must have lock on mScheduleMutex
+
+RETURN VALUE:
+   sProtocolReqRsp * - The record (0 if not found)
+===========================================================================*/
+cProtocolServer::sProtocolReqRsp * cProtocolServer::FindRequest( 
+   ULONG                      reqID,
+   eRequestState              state )
+{
+   ULONG slot = reqID & REQ_SLOT_MASK;
+   if (reqID == INVALID_REQUEST_ID || slot >= (ULONG)mRequestSlots.size())
+   {
+      return 0;
+   }
+
+   sProtocolReqRsp * pReqRsp = &mRequestSlots[slot];
+   if (pReqRsp->mID != reqID || pReqRsp->mState != (UINT)state)
+   {
+      return 0;
+   }
+
+   return pReqRsp;
+}
+
+/*===========================================================================
+METHOD:
+   RemoveInFlightRequest (Internal Method)
+
+DESCRIPTION:
+   Remove the given request from mInFlight (keeping the others in 
+   transmission order)
+
+PARAMETERS:
+   pReqRsp     [ I ] - Request being removed
+
+SEQUENCING:
+   Calling process must have lock on mScheduleMutex
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cProtocolServer::RemoveInFlightRequest( sProtocolReqRsp * pReqRsp )
+{
+   std::vector <sProtocolReqRsp *>::iterator pIter;
+   pIter = std::find( mInFlight.begin(), mInFlight.end(), pReqRsp );
+   if (pIter != mInFlight.end())
+   {
+      mInFlight.erase( pIter );
+   }
+}
+
+/*===========================================================================
+METHOD:
+   HandleAddRequest (Internal Method)
+
+DESCRIPTION:
+   Add a (checked) outgoing protocol request to the request records and 
+   schedule it
+
+PARAMETERS:
+   req        [ I ] - Request being added
+
+SEQUENCING:
+   Calling process must have lock on mScheduleMutex
+
+RETURN VALUE:
+   ULONG - ID of scheduled request (INVALID_REQUEST_ID upon error)
+===========================================================================*/
+ULONG cProtocolServer::HandleAddRequest( const sProtocolRequest & req )
+{
+   // Wrap in our internal structure
+   sProtocolReqRsp * pReqRsp = AllocRequest( req );
+   if (pReqRsp == 0)
+   {
+      return INVALID_REQUEST_ID;
+   }
+
+   pReqRsp->mStatsKey = GetStatisticsKey( req );
+   pReqRsp->mPriority = GetRequestPriority( req );
+      
+   // ... and schedule
+   ScheduleRequest( pReqRsp, req.GetSchedule() );
+
+   return pReqRsp->mID;
+}
+
+/*===========================================================================
+METHOD:
+   HandleRemoveRequest (Public Method)
+
+DESCRIPTION:
+   Remove a previously added protocol request 
+   
+   Note: if a request is being processed, it cannot be inturrupted
+
+PARAMETERS:
+   reqID       [ I ] - Server assigned request ID
+
+SEQUENCING:
+   Calling process must have lock on mScheduleMutex
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cProtocolServer::HandleRemoveRequest( ULONG reqID )
+{
+   // Assume failure
+   bool bRC = false;
+
+   // Find and free pending request
+   sProtocolReqRsp * pReqRsp = FindRequest( reqID, eREQ_STATE_PENDING );
+   if (pReqRsp != 0)
+   {
+      // Erase request from schedule (or the ready queues)
+      mRequestSchedule.Remove( *pReqRsp );
+      RemoveReadyRequest( pReqRsp );
+
+      // Abandoning a request between attempts?
+      if (pReqRsp->mCycleAttempts > 0)
+      {
+         mStatistics.Count( pReqRsp->mStatsKey, ePROTOCOL_STAT_ABORT );
+      }
+
+      FreeRequest( pReqRsp );
+
+      // Success!
+      bRC = true;
+
+      // Note: schedule will be updated when mutex is unlocked/signaled
+   }
+   else if (mpActiveRequest != 0 && mpActiveRequest->mID == reqID)
+   {
+      const sProtocolRequest & req = mpActiveRequest->mRequest;
+      const cProtocolNotification * pNotifier = req.GetNotifier();
+
+      mStatistics.Count( mpActiveRequest->mStatsKey, ePROTOCOL_STAT_ABORT );
+
+      // Cancel the response timer (when active)
+      if (mpActiveRequest->mbWaitingForResponse == true)
       {
          // Schedule will be updated when mutex is unlocked
 
@@ -639,13 +1141,38 @@ bool cProtocolServer::HandleRemoveRequest( ULONG reqID )
          }
       }
 
-      // Now delete the request
-      delete mpActiveRequest;
+      // Now free the request
+      FreeRequest( mpActiveRequest );
       mpActiveRequest = 0;
 
       // Success!
       bRC = true;
    }
+   else if ((pReqRsp = FindRequest( reqID, eREQ_STATE_IN_FLIGHT )) != 0)
+   {
+      RemoveInFlightRequest( pReqRsp );
+
+      // Cancel the response timer
+      mResponseTimers.Remove( *pReqRsp );
+
+      mStatistics.Count( pReqRsp->mStatsKey, ePROTOCOL_STAT_ABORT );
+
+      // Failure to receive response, notify client
+      const cProtocolNotification * pNotifier = 
+         pReqRsp->mRequest.GetNotifier();
+
+      if (pNotifier != 0)
+      {
+         pNotifier->Notify( ePROTOCOL_EVT_RSP_ERR, 
+                            (DWORD)reqID, 
+                            ECANCELED );
+      }
+
+      FreeRequest( pReqRsp );
+
+      // Success!
+      bRC = true;
+   }
    else
    {
       TRACE( "cProtocolServer::RemoveRequest( %lu ),"
@@ -664,8 +1191,8 @@ DESCRIPTION:
    Schedule a request for transmission
 
 PARAMETERS:
-   reqID       [ I ] - ID of the request being scheduled this ID must exist
-                       in the internal request/schedule maps
+   pReqRsp     [ I ] - Request being scheduled, this request must exist
+                       in the request records
 
    schedule    [ I ] - Value in milliseconds that indicates the approximate
                        time from now that the request is to be sent out, the
@@ -681,20 +1208,29 @@ RETURN VALUE:
    bool
 ===========================================================================*/
 bool cProtocolServer::ScheduleRequest(
-   ULONG                      reqID,
+   sProtocolReqRsp *          pReqRsp,
    ULONG                      schedule )
 {
    // Assume failure
    bool bRC = false;
+   if (pReqRsp == 0)
+   {
+      return bRC;
+   }
    
    // Schedule adjust is in milliseconds
-   timespec schTimer = TimeIn( schedule );
+   ULONGLONG schTimer = GetTickCount() + schedule;
 
-   // Create the schedule entry
-   tSchedule newEntry( schTimer, reqID );
+   // Note when this attempt (and the first attempt of the cycle) is due
+   pReqRsp->mDueTime = GetMicroTickCount() + (ULONGLONG)schedule * 1000;
+   if (pReqRsp->mStartTime == 0)
+   {
+      pReqRsp->mStartTime = pReqRsp->mDueTime;
+   }
 
    // Fit this request into the schedule (ordered by scheduled time)
-   mRequestSchedule.insert( newEntry );
+   mRequestSchedule.Insert( *pReqRsp, schTimer );
+   bRC = true;
 
    // Note: timer will be updated when mScheduleMutex is unlocked
    
@@ -703,10 +1239,11 @@ bool cProtocolServer::ScheduleRequest(
 
 /*===========================================================================
 METHOD:
-   RescheduleActiveRequest (Internal Method)
+   QueueDueRequests (Internal Method)
 
 DESCRIPTION:
-   Reschedule (or cleanup) the active request
+   Move the requests on the expired list of the schedule to the tail of 
+   the ready queue of their priority
 
 SEQUENCING:
    Calling process must have lock on mScheduleMutex
@@ -714,320 +1251,305 @@ SEQUENCING:
 RETURN VALUE:
    None
 ===========================================================================*/
-void cProtocolServer::RescheduleActiveRequest()
+void cProtocolServer::QueueDueRequests()
 {
-   // Are there more attempts to be made?
-   if (mpActiveRequest->mAttempts < mpActiveRequest->mRequest.GetRequests())
+   sTimerWheelNode * pNode = mRequestSchedule.PopExpired();
+   while (pNode != 0)
    {
-      // Yes, first reset the request 
-      mpActiveRequest->Reset();
+      sProtocolReqRsp * pReqRsp = static_cast <sProtocolReqRsp *>( pNode );
+      mReadyQueues[pReqRsp->mPriority].push_back( pReqRsp );
 
-      // Now add it back to the request map
-      mRequestMap[mpActiveRequest->mID] = mpActiveRequest;
+      pNode = mRequestSchedule.PopExpired();
+   }
+}
 
-      TRACE( "RescheduleActiveRequest(): req %lu rescheduled\n", mpActiveRequest->mID );                       
-      
-      // Lastly reschedule the request
-      ScheduleRequest( mpActiveRequest->mID, 
-                       mpActiveRequest->mRequest.GetFrequency() );
+/*===========================================================================
+METHOD:
+   PopReadyRequest (Internal Method)
+
+DESCRIPTION:
+   Remove (and return) the next ready request to be sent, control 
+   requests are taken first while the other priorities are taken in
+   weighted rounds (so background polls cannot starve one-off requests,
+   nor be starved by them)
 
+SEQUENCING:
+   Calling process must have lock on mScheduleMutex
+
+RETURN VALUE:
+   sProtocolReqRsp * - The request (0 if none are ready)
+===========================================================================*/
+cProtocolServer::sProtocolReqRsp * cProtocolServer::PopReadyRequest()
+{
+   sProtocolReqRsp * pReqRsp = 0;
+
+   std::deque <sProtocolReqRsp *> & ctl = 
+      mReadyQueues[ePROTOCOL_PRIORITY_CONTROL];
+
+   if (ctl.empty() == false)
+   {
+      pReqRsp = ctl.front();
+      ctl.pop_front();
+      return pReqRsp;
    }
-   else
+
+   // Take from the first priority with credit left in this round, once 
+   // every ready priority is out of credit start a new round
+   for (ULONG round = 0; round < 2; round++)
    {
-      TRACE( "RescheduleActiveRequest(): req %lu removed\n", mpActiveRequest->mID );
+      for (ULONG p = (ULONG)ePROTOCOL_PRIORITY_NORMAL; 
+           p < (ULONG)ePROTOCOL_PRIORITY_END; 
+           p++)
+      {
+         std::deque <sProtocolReqRsp *> & ready = mReadyQueues[p];
+         if (ready.empty() == false && mPriorityCredits[p] > 0)
+         {
+            mPriorityCredits[p]--;
 
-      // No, we are through with this request
-      delete mpActiveRequest;
+            pReqRsp = ready.front();
+            ready.pop_front();
+            return pReqRsp;
+         }
+      }
+
+      for (ULONG p = 0; p < (ULONG)ePROTOCOL_PRIORITY_END; p++)
+      {
+         mPriorityCredits[p] = gPriorityWeights[p];
+      }
    }
 
-   // There is no longer an active request
-   mpActiveRequest = 0;
-  
+   return pReqRsp;
 }
 
 /*===========================================================================
 METHOD:
-   ProcessRequest (Internal Method)
+   RemoveReadyRequest (Internal Method)
 
 DESCRIPTION:
-   Process a single outgoing protocol request, this consists of removing
-   the request ID from the head of the schedule, looking up the internal 
-   request object in the request map, sending out the request, and setting
-   up the response timer (if a response is required)
+   Remove the given request from the ready queues (if present)
+
+PARAMETERS:
+   pReqRsp     [ I ] - Request being removed
 
 SEQUENCING:
    Calling process must have lock on mScheduleMutex
 
 RETURN VALUE:
+   None
 ===========================================================================*/
-void cProtocolServer::ProcessRequest()
+void cProtocolServer::RemoveReadyRequest( sProtocolReqRsp * pReqRsp )
 {
-   // Is there already an active request?
-   if (mpActiveRequest != 0)
-   {
-      return;
-   }
-   
-   // Grab request ID from the schedule
-   std::set <tSchedule>::iterator pScheduleIter;
-   pScheduleIter = mRequestSchedule.begin();
+   std::deque <sProtocolReqRsp *> & ready = mReadyQueues[pReqRsp->mPriority];
 
-   // Did we find the request?
-   if (pScheduleIter == mRequestSchedule.end())
+   std::deque <sProtocolReqRsp *>::iterator pIter;
+   pIter = std::find( ready.begin(), ready.end(), pReqRsp );
+   if (pIter != ready.end())
    {
-      // No
-      return;
+      ready.erase( pIter );
    }
+}
 
-   // Yes, grab the request ID
-   ULONG reqID = pScheduleIter->second;
+/*===========================================================================
+METHOD:
+   GetReadyCount (Internal Method)
 
-   // Remove from schedule
-   mRequestSchedule.erase( pScheduleIter );
+DESCRIPTION:
+   Return the number of requests in the ready queues
 
-   // Look up the internal request object
-   std::map <ULONG, sProtocolReqRsp *>::iterator pReqIter;
-   pReqIter = mRequestMap.find( reqID );
+SEQUENCING:
+   Calling process must have lock on mScheduleMutex
 
-   // Request not found around?
-   if (pReqIter == mRequestMap.end() || pReqIter->second == 0)
+RETURN VALUE:
+   ULONG
+===========================================================================*/
+ULONG cProtocolServer::GetReadyCount()
+{
+   ULONG count = 0;
+   for (ULONG p = 0; p < (ULONG)ePROTOCOL_PRIORITY_END; p++)
    {
-      // No
-      return;
+      count += (ULONG)mReadyQueues[p].size();
    }
 
-   // Set this request as the active request
-   mpActiveRequest = pReqIter->second;
-   
-   TRACE( "ProcessRequest(): req %lu started\n", mpActiveRequest->mID );
+   return count;
+}
 
-   // Remove request from pending request map
-   mRequestMap.erase( pReqIter );
+/*===========================================================================
+METHOD:
+   HoldForCoalescing (Internal Method)
 
-   // Extract the underlying request
-   const sProtocolRequest & req = mpActiveRequest->mRequest;
+DESCRIPTION:
+   Should the ready requests be held back, as they are too few to fill 
+   the in-flight window and the oldest of them has been due for less than
+   the transmit coalescing window? (control requests are never held)
 
-   // Increment attempt count?
-   if (req.GetRequests() != INFINITE_REQS)
-   {
-      // This request isn't an indefinite one, so keep track of each attempt
-      mpActiveRequest->mAttempts++;
-   }
+PARAMETERS:
+   readyCount  [ I ] - Number of ready requests
+   curTime     [ I ] - Current tick
+   toTime      [I/O] - Next schedule thread wake up (moved up to the end
+                       of the hold)
 
-   bool bTxSuccess = false;
+SEQUENCING:
+   Calling process must have lock on mScheduleMutex
 
-   // Encode data for transmission?
-   bool bEncoded = false;
-   sSharedBuffer * pEncoded = 0;
-   pEncoded = EncodeTxData( req.GetSharedBuffer(), bEncoded );
-   if (bEncoded == false)
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cProtocolServer::HoldForCoalescing(
+   ULONG                      readyCount,
+   ULONGLONG                  curTime,
+   ULONGLONG &                toTime )
+{
+   if ( (mTxCoalescing == 0)
+   ||   (readyCount == 0)
+   ||   (mpActiveRequest != 0)
+   ||   (mInFlightWindow <= DEFAULT_IN_FLIGHT_WINDOW)
+   ||   (mInFlight.size() + readyCount >= mInFlightWindow)
+   ||   (mReadyQueues[ePROTOCOL_PRIORITY_CONTROL].empty() == false) )
    {
-      // Note: no longer asynchronus
-      // Send the request data
-      bTxSuccess = mComm.TxData( req.GetBuffer(), 
-                                 req.GetSize() );
+      return false;
    }
-   else if (bEncoded == true)
+
+   ULONGLONG oldest = 0;
+   for (ULONG p = 0; p < (ULONG)ePROTOCOL_PRIORITY_END; p++)
    {
-      if (pEncoded != 0 && pEncoded->IsValid() == true)
+      const std::deque <sProtocolReqRsp *> & ready = mReadyQueues[p];
+      if ( (ready.empty() == false)
+      &&   (oldest == 0 || ready.front()->mDueTime < oldest) )
       {
-         // Note: no longer asynchronus
-         // Send the request data
-         mpActiveRequest->mEncodedSize = pEncoded->GetSize();
-         bTxSuccess = mComm.TxData( pEncoded->GetBuffer(), 
-                                    pEncoded->GetSize() );
+         oldest = ready.front()->mDueTime;
       }
    }
 
-   if (bTxSuccess == true)
+   ULONGLONG holdEnd = oldest + (ULONGLONG)mTxCoalescing * 1000;
+   ULONGLONG now = GetMicroTickCount();
+   if (now >= holdEnd)
    {
-      TRACE( "ProcessRequest(): req %lu finished\n", mpActiveRequest->mID );
-      TxComplete();
+      return false;
    }
-   else
+
+   ULONGLONG wakeTime = curTime + (holdEnd - now + 999) / 1000;
+   if (wakeTime < toTime)
    {
-      TxError();
-      TRACE( "ProcessRequest(): req finished with a TxError\n" );
+      toTime = wakeTime;
    }
 
-   return;
+   return true;
 }
 
 /*===========================================================================
 METHOD:
-   CheckSystemTime (Internal Method)
+   RescheduleRequest (Internal Method)
 
 DESCRIPTION:
-   Check that system time hasn't moved backwards.  Since we use the system
-   time for scheduling requests we need to periodically check that the
-   user (or system itself) hasn't reset system time backwards, if it has
-   then we reschedule everything to the current system time.  This disrupts
-   the schedule but avoids stranding requests
+   Reschedule (or cleanup) the given request, which must no longer be 
+   referenced by mpActiveRequest or mInFlight
 
-   Updates mLastTime
+PARAMETERS:
+   pReqRsp     [ I ] - Request being rescheduled
 
 SEQUENCING:
    Calling process must have lock on mScheduleMutex
 
 RETURN VALUE:
-   bool: System time moved backwards?
+   None
 ===========================================================================*/
-bool cProtocolServer::CheckSystemTime()
+void cProtocolServer::RescheduleRequest( sProtocolReqRsp * pReqRsp )
 {
-   // Assume that time is still marching forward
-   bool bAdjust = false;   
-
-   timespec curTime = TimeIn( 0 );
+   // The current attempt is over
+   pReqRsp->mDeadline = 0;
+   pReqRsp->mRetransmits = 0;
 
-   if (curTime < mLastTime)
+   // Are there more attempts to be made?
+   if (pReqRsp->mAttempts < pReqRsp->mRequest.GetRequests())
    {
-      // Looks like the system clock has been adjusted to an earlier
-      // value, go through the current schedule and adjust each timer
-      // to reflect the adjustment.  This isn't an exact approach but
-      // it prevents requests from being stranded which is our goal
-
-      // Note: set iterators are constant.  This means we need to
-      //  create a set with the new data, we can't modify this one
-      
-      std::set < tSchedule, std::less <tSchedule> > tempSchedule;
-      
-      std::set <tSchedule>::iterator pScheduleIter;
-      pScheduleIter = mRequestSchedule.begin();
+      // Yes, first reset the request 
+      pReqRsp->Reset();
 
-      while (pScheduleIter != mRequestSchedule.end())
-      {
-         tSchedule entry = *pScheduleIter;
-         entry.first.tv_sec = curTime.tv_sec;
-         entry.first.tv_nsec = curTime.tv_nsec;
-         tempSchedule.insert( entry );
+      // Now make it pending again
+      pReqRsp->mState = eREQ_STATE_PENDING;
 
-         pScheduleIter++;
-      }
-      
-      mRequestSchedule = tempSchedule;
+      TRACE( "RescheduleRequest(): req %lu rescheduled\n", pReqRsp->mID );                       
       
-      // Update mActiveRequestTimeout
-      if ( (mpActiveRequest != 0)
-      && (mpActiveRequest->mbWaitingForResponse == true) )
-      {
-         // Restart active request's timeout
-         ULONG mTimeout = mpActiveRequest->mRequest.GetTimeout();
-         mActiveRequestTimeout = TimeIn( mTimeout );
-      }         
-
-      TRACE( "Time has moved backwards, schedule updated\n" );
+      // Lastly reschedule the request
+      ScheduleRequest( pReqRsp, 
+                       pReqRsp->mRequest.GetFrequency() );
 
-      // Indicate the change
-      bAdjust = true;
    }
+   else
+   {
+      TRACE( "RescheduleRequest(): req %lu removed\n", pReqRsp->mID );
 
-   mLastTime.tv_sec = curTime.tv_sec;
-   mLastTime.tv_nsec = curTime.tv_nsec;
-
-   return bAdjust;
+      // No, we are through with this request
+      FreeRequest( pReqRsp );
+   }
 }
 
 /*===========================================================================
 METHOD:
-   RxComplete (Internal Method)
+   RescheduleActiveRequest (Internal Method)
 
 DESCRIPTION:
-   Handle completion of receive data operation
-
-PARAMETERS:
-   status         [ I ] - Status of operation
-   bytesReceived  [ I ] - Number of bytes received
+   Reschedule (or cleanup) the active request
 
 SEQUENCING:
-   This method is sequenced according to the schedule mutex
-   i.e. any other thread that needs to modify the schedule 
-   will block until this method completes
+   Calling process must have lock on mScheduleMutex
 
 RETURN VALUE:
    None
 ===========================================================================*/
-void cProtocolServer::RxComplete(
-   DWORD                      status,
-   DWORD                      bytesReceived )
+void cProtocolServer::RescheduleActiveRequest()
 {
-   if (status != NO_ERROR)
-   {
-      TRACE( "cProtocolServer::RxComplete() = %lu\n", status );
-   }
-
-   // Error with the read
-   if (status != NO_ERROR || bytesReceived == 0)
-   {
-      // Setup the next read
-      mComm.RxData( mpRxBuffer, 
-                    (ULONG)mRxBufferSize, 
-                    (cIOCallback *)&mRxCallback );
+   sProtocolReqRsp * pReqRsp = mpActiveRequest;
 
-      return;
-   }
+   // There is no longer an active request
+   mpActiveRequest = 0;
 
-   // Get Schedule Mutex
-   if (GetScheduleMutex() == false)
-   {
-      TRACE( "RxComplete(), unable to get schedule Mutex\n" );
-      return;
-   }
+   RescheduleRequest( pReqRsp );
+}
 
-   TRACE( "RxComplete() - Entry at %llu\n", GetTickCount() );
+/*===========================================================================
+METHOD:
+   SetActiveRequestInFlight (Internal Method)
 
-   // Decode data
-   bool bAbortTx = false;
-   ULONG rspIdx = INVALID_LOG_INDEX;
-   bool bRsp = DecodeRxData( bytesReceived, rspIdx, bAbortTx );
+DESCRIPTION:
+   Move the active request (which has been fully transmitted) to the
+   in-flight requests where it awaits its response under its own timeout, 
+   thus freeing the server to transmit the next scheduled request
 
-   // Is there an active request that needs to be aborted
-   if (mpActiveRequest != 0 && bAbortTx == true)
-   {
-      // Yes, terminate the transmission and handle the error
-      mComm.CancelTx();
-      TxError();
-   }
-   // Is there an active request and a valid response?
-   else if (mpActiveRequest != 0 && bRsp == true)
-   {
-      const sProtocolRequest & req = mpActiveRequest->mRequest;
-      const cProtocolNotification * pNotifier = req.GetNotifier();
+SEQUENCING:
+   Calling process must have lock on mScheduleMutex
 
-      // Notify client that response was received
-      if (pNotifier != 0)
-      {
-         pNotifier->Notify( ePROTOCOL_EVT_RSP_RECV, 
-                            (DWORD)mpActiveRequest->mID, 
-                            (DWORD)rspIdx );
-      }
+RETURN VALUE:
+   None
+===========================================================================*/
+void cProtocolServer::SetActiveRequestInFlight()
+{
+   sProtocolReqRsp * pReqRsp = mpActiveRequest;
+   mpActiveRequest = 0;
 
-      // Reschedule request as needed
-      RescheduleActiveRequest();
-   }
-   
-   // Setup the next read
-   mComm.RxData( mpRxBuffer, 
-                 (ULONG)mRxBufferSize, 
-                 (cIOCallback *)&mRxCallback );
+   pReqRsp->mbWaitingForResponse = true;
 
-   TRACE( "RxComplete() - Exit at %llu\n", GetTickCount() );
+   ULONGLONG timeout = GetResponseTimeout( pReqRsp );
+   mResponseTimers.Insert( *pReqRsp, timeout );
 
-   // Unlock schedule mutex        
-   if (ReleaseScheduleMutex() == false)
-   {
-      // This should never happen
-      return;
-   }
+   pReqRsp->mState = eREQ_STATE_IN_FLIGHT;
+   mInFlight.push_back( pReqRsp );
 
-   return;
+   TRACE( "SetActiveRequestInFlight(): req %lu in flight (%lu/%lu)\n", 
+          pReqRsp->mID,
+          (ULONG)mInFlight.size(),
+          mInFlightWindow );
 }
 
 /*===========================================================================
 METHOD:
-   RxTimeout (Internal Method)
+   InFlightTimeout (Internal Method)
 
 DESCRIPTION:
-   Handle the response timer expiring
+   Handle the response timer expiring for an in-flight request
+
+PARAMETERS:
+   reqID       [ I ] - ID of the request that timed out
 
 SEQUENCING:
    Calling process must have lock on mScheduleMutex
@@ -1035,40 +1557,49 @@ SEQUENCING:
 RETURN VALUE:
    None
 ===========================================================================*/
-void cProtocolServer::RxTimeout()
+void cProtocolServer::InFlightTimeout( ULONG reqID )
 {
-   // No active request?
-   if (mpActiveRequest == 0)
+   sProtocolReqRsp * pReqRsp = FindRequest( reqID, eREQ_STATE_IN_FLIGHT );
+   if (pReqRsp == 0)
    {
-      TRACE( "RxTimeout() with no active request\n" );
-      ASSERT( 0 );
+      return;
    }
-   
-   TRACE( "RxTimeout() for req %lu\n", mpActiveRequest->mID );
 
-   const sProtocolRequest & req = mpActiveRequest->mRequest;
-   const cProtocolNotification * pNotifier = req.GetNotifier();
+   RemoveInFlightRequest( pReqRsp );
+
+   TRACE( "InFlightTimeout() for req %lu\n", reqID );
+
+   // Still time to retransmit the request?
+   if (RetransmitRequest( pReqRsp ) == true)
+   {
+      return;
+   }
+
+   mStatistics.Count( pReqRsp->mStatsKey, ePROTOCOL_STAT_TIMEOUT );
 
    // Failure to receive response, notify client
+   const cProtocolNotification * pNotifier = pReqRsp->mRequest.GetNotifier();
    if (pNotifier != 0)
    {
       pNotifier->Notify( ePROTOCOL_EVT_RSP_ERR, 
-                         (DWORD)mpActiveRequest->mID, 
+                         (DWORD)reqID, 
                          (DWORD)0 );
    }
 
    // Reschedule request as needed
-   RescheduleActiveRequest();
+   RescheduleRequest( pReqRsp );
 }
 
 /*===========================================================================
 METHOD:
-   TxComplete (Internal Method)
+   CompleteInFlightRequest (Internal Method)
 
 DESCRIPTION:
-   Handle completion of transmit data operation
+   Handle the response to an in-flight request
 
 PARAMETERS:
+   reqID       [ I ] - ID of the request the response is for
+   rspIdx      [ I ] - Log index of the response
 
 SEQUENCING:
    Calling process must have lock on mScheduleMutex
@@ -1076,131 +1607,49 @@ SEQUENCING:
 RETURN VALUE:
    None
 ===========================================================================*/
-void cProtocolServer::TxComplete()
+void cProtocolServer::CompleteInFlightRequest(
+   ULONG                      reqID,
+   ULONG                      rspIdx )
 {
-   // No active request?
-   if (mpActiveRequest == 0)
-   {
-      TRACE( "TxComplete() called with no active request\n" );
-      ASSERT( 0 );
-   }
-   
-   TRACE( "TxComplete() req %lu started\n", mpActiveRequest->mID );
-
-   ULONG reqID = mpActiveRequest->mID;
-   const sProtocolRequest & req = mpActiveRequest->mRequest;
-   const cProtocolNotification * pNotifier = req.GetNotifier();
-
-   // Notify client of auxiliary data being sent?
-   if (mpActiveRequest->mRequiredAuxTxs && mpActiveRequest->mCurrentAuxTx)
+   sProtocolReqRsp * pReqRsp = FindRequest( reqID, eREQ_STATE_IN_FLIGHT );
+   if (pReqRsp == 0)
    {
-      pNotifier->Notify( ePROTOCOL_EVT_AUX_TU_SENT, 
-                         (DWORD)reqID, 
-                         (DWORD)mpActiveRequest->mEncodedSize );
+      return;
    }
 
-   // Check for more auxiliary data to transmit
-   if (mpActiveRequest->mCurrentAuxTx < mpActiveRequest->mRequiredAuxTxs)
-   {
-      ULONG auxDataSz = 0;
-      const BYTE * pAuxData = req.GetAuxiliaryData( auxDataSz );
-      if (auxDataSz > 0 && pAuxData != 0)
-      {
-         bool bRC = false;
-
-         // Adjust for current MTU
-         pAuxData += (mpActiveRequest->mCurrentAuxTx * MAX_AUX_MTU_SIZE);
-         mpActiveRequest->mCurrentAuxTx++;
-
-         // Last MTU?
-         if (mpActiveRequest->mCurrentAuxTx == mpActiveRequest->mRequiredAuxTxs)
-         {
-            // More than one MTU?
-            if (mpActiveRequest->mRequiredAuxTxs > 1)
-            {
-               auxDataSz = (auxDataSz % MAX_AUX_MTU_SIZE);
-               if (auxDataSz == 0)
-               {
-                  auxDataSz = MAX_AUX_MTU_SIZE;
-               }
-            }
-            
-            if (auxDataSz % MAX_PACKET_SIZE == 0)
-            {
-               // If last write of unframed write request is divisible
-               //    by 512, break off last byte and send seperatly.
-               TRACE( "TxComplete() Special case, break off last byte\n" );
-
-               bRC = mComm.TxData( pAuxData, 
-                                   auxDataSz - 1  );
-
-               if (bRC == true)
-               {
-                  bRC = mComm.TxData( pAuxData + auxDataSz -1,
-                                      1 );
-               }
-            }
-            else
-            {
-               bRC = mComm.TxData( pAuxData, 
-                                   auxDataSz );
-            }
-         }
-         else if (mpActiveRequest->mRequiredAuxTxs > 1)
-         {
-            auxDataSz = MAX_AUX_MTU_SIZE;
-
-            bRC = mComm.TxData( pAuxData, 
-                                auxDataSz );
-         }
+   RemoveInFlightRequest( pReqRsp );
 
-         if (bRC == true)
-         {
-            mpActiveRequest->mEncodedSize = auxDataSz;
-            TxComplete();
-         }
-         else
-         {
-            TxError();
-         }
+   // Cancel the response timer
+   mResponseTimers.Remove( *pReqRsp );
 
-         return;
-      }
-   }
-   
-   // Another successful transmission, add the buffer to the log
-   ULONG reqIdx = INVALID_LOG_INDEX;
+   EndRequestCycle( pReqRsp, true, rspIdx );
 
-   sProtocolBuffer pb( req.GetSharedBuffer() );
-   reqIdx = mLog.AddBuffer( pb );
+   const cProtocolNotification * pNotifier = pReqRsp->mRequest.GetNotifier();
 
-   // Notify client?
+   // Notify client that response was received
    if (pNotifier != 0)
    {
-      pNotifier->Notify( ePROTOCOL_EVT_REQ_SENT, (DWORD)reqID, (DWORD)reqIdx );
+      pNotifier->Notify( ePROTOCOL_EVT_RSP_RECV, 
+                         (DWORD)pReqRsp->mID, 
+                         (DWORD)rspIdx );
    }
 
-   // Wait for a response?
-   if (mpActiveRequest->mRequest.IsTXOnly() == false)
-   {
-      // We now await the response
-      mpActiveRequest->mbWaitingForResponse = true;
-      mActiveRequestTimeout = TimeIn( mpActiveRequest->mRequest.GetTimeout() );
-   }
-   else
-   {
-      // Reschedule request as needed
-      RescheduleActiveRequest();
-   }
+   // Reschedule request as needed
+   RescheduleRequest( pReqRsp );
 }
 
 /*===========================================================================
 METHOD:
-   TxError (Internal Method)
+   CheckInFlightTimeouts (Internal Method)
 
 DESCRIPTION:
-   Handle transmit data operation error be either rescheduling the
-   request or cleaning it up
+   Expire any in-flight request whose response timer is due and pull the
+   next wait time in to the earliest outstanding response timer (or the
+   response timer wheel's next cascade)
+
+PARAMETERS:
+   curTime     [ I ] - Current time
+   toTime      [I/O] - Time the schedule thread is to wake up at 
 
 SEQUENCING:
    Calling process must have lock on mScheduleMutex
@@ -1208,91 +1657,932 @@ SEQUENCING:
 RETURN VALUE:
    None
 ===========================================================================*/
-void cProtocolServer::TxError()
+void cProtocolServer::CheckInFlightTimeouts(
+   ULONGLONG                  curTime,
+   ULONGLONG &                toTime )
 {
-   // No active request?
-   if (mpActiveRequest == 0)
+   // Expire every response timer that is due as one batch
+   mResponseTimers.Advance( curTime );
+
+   sTimerWheelNode * pNode = mResponseTimers.PopExpired();
+   while (pNode != 0)
    {
-      return;
+      InFlightTimeout( static_cast <sProtocolReqRsp *>( pNode )->mID );
+      pNode = mResponseTimers.PopExpired();
    }
 
-   ULONG reqID = mpActiveRequest->mID;
-   const sProtocolRequest & req = mpActiveRequest->mRequest;
-   const cProtocolNotification * pNotifier = req.GetNotifier();
-
-   // Failure to send request, notify client
-   if (pNotifier != 0)
+   ULONGLONG nextTimeout = 0;
+   if ( (mResponseTimers.GetNextExpiry( nextTimeout ) == true)
+   &&   (nextTimeout <= toTime) )
    {
-      pNotifier->Notify( ePROTOCOL_EVT_REQ_ERR, (DWORD)reqID, (DWORD)0 );
+      toTime = nextTimeout;
    }
-
-   // Reschedule request as needed
-   RescheduleActiveRequest();
 }
 
 /*===========================================================================
 METHOD:
-   Initialize (Public Method)
+   EndRequestCycle (Internal Method)
 
 DESCRIPTION:
-   Initialize the protocol server by starting up the schedule thread
+   Record the outcome of the attempts made at a request since its last 
+   response and start a new cycle
+
+PARAMETERS:
+   pReqRsp     [ I ] - Request that completed
+   bResponse   [ I ] - Was a response received? (false for TX only)
+   rspIdx      [ I ] - Log index of the response (INVALID_LOG_INDEX if 
+                       none), the latencies are measured up to the time
+                       it was stamped with upon receipt
 
 SEQUENCING:
-   This method is sequenced according to the schedule mutex, i.e. any
-   other thread that needs to modify the schedule will block until 
-   this method completes
+   Calling process must have lock on mScheduleMutex
 
 RETURN VALUE:
-   bool
+   None
 ===========================================================================*/
-bool cProtocolServer::Initialize()
+void cProtocolServer::EndRequestCycle(
+   sProtocolReqRsp *          pReqRsp,
+   bool                       bResponse,
+   ULONG                      rspIdx )
 {
-   // Assume failure
-   bool bRC = false;
+   if (bResponse == true)
+   {
+      ULONG key = pReqRsp->mStatsKey;
+      ULONGLONG now = 0;
 
-   mbExiting = false;
+      sProtocolBuffer rsp;
+      if ( (rspIdx != INVALID_LOG_INDEX)
+      &&   (mLog.GetBuffer( rspIdx, rsp ) == true) )
+      {
+         now = rsp.GetMonotonicTimestamp() / 1000ULL;
+      }
 
-   // Get mScheduleMutex
-   if (GetScheduleMutex() == true)
-   {
-      if (mScheduleThreadID == 0)
+      if (now == 0)
       {
-         // Yes, start thread
-         int nRet = pthread_create( &mScheduleThreadID,
-                                    NULL,
-                                    ScheduleThread,
-                                    this );
-         if (nRet == 0)
+         now = GetMicroTickCount();
+      }
+
+      mStatistics.Count( key, ePROTOCOL_STAT_RSP );
+      if (mbErrorRsp == true)
+      {
+         mStatistics.Count( key, ePROTOCOL_STAT_ERROR_RSP );
+      }
+
+      if (pReqRsp->mSentTime != 0 && now >= pReqRsp->mSentTime)
+      {
+         ULONGLONG rtt = now - pReqRsp->mSentTime;
+         mStatistics.AddLatency( key, ePROTOCOL_LAT_RTT, rtt );
+
+         // Only a response to a request sent once unambiguously measures
+         // the round trip (Karn's algorithm)
+         if (pReqRsp->mCycleAttempts == 1 && pReqRsp->mRetransmits == 0)
          {
-            // Success!
-            bRC = true;
+            mRTTEstimates[key].AddSample( rtt );
+            mServerRTT.AddSample( rtt );
          }
       }
-   }
-   else
-   {
-      TRACE( "cProtocolServer::Initialize(), unable to aquire ScheduleMutex\n" );
-      return false;
-   }
 
-   // Unlock schedule mutex        
-   if (ReleaseScheduleMutex() == false)
-   {
-      // This should never happen
-      return false;
+      if (pReqRsp->mStartTime != 0 && now >= pReqRsp->mStartTime)
+      {
+         mStatistics.AddLatency( key, 
+                                 ePROTOCOL_LAT_TOTAL, 
+                                 now - pReqRsp->mStartTime );
+      }
    }
 
-   return bRC;
+   pReqRsp->mCycleAttempts = 0;
+   pReqRsp->mStartTime = 0;
+   pReqRsp->mSentTime = 0;
 }
 
 /*===========================================================================
 METHOD:
-   Exit (Public Method)
+   GetResponseTimeout (Internal Method)
 
 DESCRIPTION:
-   Exit the protocol server by exiting the schedule thread (if necessary)
+   Return the tick the response timer of a request that has just been
+   transmitted is to expire at, the first transmission of an attempt sets
+   the attempt deadline (the request timeout from now)
 
-SEQUENCING:
+   With adaptive timeouts the timer expires after the retransmission 
+   timeout of the request's message ID (or of the server while the message
+   ID has no samples), doubled for each retransmission already made, but 
+   never after the attempt deadline
+
+PARAMETERS:
+   pReqRsp     [I/O] - Request that has just been transmitted
+
+SEQUENCING:
+   Calling process must have lock on mScheduleMutex
+
+RETURN VALUE:
+   ULONGLONG - Tick the response timer expires at
+===========================================================================*/
+ULONGLONG cProtocolServer::GetResponseTimeout( sProtocolReqRsp * pReqRsp )
+{
+   ULONGLONG now = GetTickCount();
+   if (pReqRsp->mDeadline == 0)
+   {
+      pReqRsp->mDeadline = now + pReqRsp->mRequest.GetTimeout();
+   }
+
+   if (mbAdaptiveTimeouts == false)
+   {
+      return pReqRsp->mDeadline;
+   }
+
+   ULONG rto = 0;
+   std::map <ULONG, sRTTEstimate>::const_iterator pIter;
+   pIter = mRTTEstimates.find( pReqRsp->mStatsKey );
+   if (pIter != mRTTEstimates.end())
+   {
+      rto = pIter->second.GetRTO();
+   }
+   else
+   {
+      rto = mServerRTT.GetRTO();
+   }
+
+   if (rto == 0)
+   {
+      // Nothing measured yet
+      return pReqRsp->mDeadline;
+   }
+
+   ULONG backoff = pReqRsp->mRetransmits;
+   if (backoff > MAX_RTO_BACKOFF)
+   {
+      backoff = MAX_RTO_BACKOFF;
+   }
+
+   ULONGLONG timeout = now + ((ULONGLONG)rto << backoff);
+   if (timeout > pReqRsp->mDeadline)
+   {
+      timeout = pReqRsp->mDeadline;
+   }
+
+   return timeout;
+}
+
+/*===========================================================================
+METHOD:
+   RetransmitRequest (Internal Method)
+
+DESCRIPTION:
+   Retransmit a request whose response timer expired before the attempt
+   deadline by scheduling it again at once (as part of the same attempt),
+   the request must no longer be referenced by mpActiveRequest or 
+   mInFlight
+
+   Requests with auxiliary data are never retransmitted this way
+
+PARAMETERS:
+   pReqRsp     [ I ] - Request whose response timer expired
+
+SEQUENCING:
+   Calling process must have lock on mScheduleMutex
+
+RETURN VALUE:
+   bool - false if the attempt has failed instead
+===========================================================================*/
+bool cProtocolServer::RetransmitRequest( sProtocolReqRsp * pReqRsp )
+{
+   if ( (mbAdaptiveTimeouts == false)
+   ||   (pReqRsp->mRequiredAuxTxs != 0)
+   ||   (GetTickCount() >= pReqRsp->mDeadline) )
+   {
+      return false;
+   }
+
+   TRACE( "RetransmitRequest(): req %lu retransmitted\n", pReqRsp->mID );
+
+   mStatistics.Count( pReqRsp->mStatsKey, ePROTOCOL_STAT_RETRANSMIT );
+
+   pReqRsp->Reset();
+   pReqRsp->mRetransmits++;
+   pReqRsp->mbRetransmit = true;
+
+   pReqRsp->mState = eREQ_STATE_PENDING;
+   return ScheduleRequest( pReqRsp, 0 );
+}
+
+/*===========================================================================
+METHOD:
+   ProcessRequest (Internal Method)
+
+DESCRIPTION:
+   Process a single outgoing protocol request, this consists of removing
+   the oldest due request from the schedule, looking up the internal 
+   request record, sending out the request, and setting
+   up the response timer (if a response is required)
+
+SEQUENCING:
+   Calling process must have lock on mScheduleMutex
+
+RETURN VALUE:
+===========================================================================*/
+void cProtocolServer::ProcessRequest()
+{
+   // Is there already an active request?
+   if (mpActiveRequest != 0)
+   {
+      return;
+   }
+
+   const BYTE * pTxData = 0;
+   ULONG txSz = 0;
+   bool bEncoded = false;
+   if (StartRequest( pTxData, txSz, bEncoded ) == false)
+   {
+      return;
+   }
+
+   // Note: no longer asynchronus
+   // Send the request data
+   bool bTxSuccess = false;
+   if (pTxData != 0)
+   {
+      bTxSuccess = mComm.TxData( pTxData, txSz );
+   }
+
+   FinishRequestTx( bTxSuccess );
+}
+
+/*===========================================================================
+METHOD:
+   ProcessRequests (Internal Method)
+
+DESCRIPTION:
+   Process up to the given number of outgoing protocol requests (as long
+   as the active request and in-flight window allow), requests that await
+   their response in flight and are sent as is (no encoding, auxiliary 
+   data) are gathered and then transmitted with a single write
+
+PARAMETERS:
+   count       [ I ] - Maximum number of requests to process
+
+SEQUENCING:
+   Calling process must have lock on mScheduleMutex
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cProtocolServer::ProcessRequests( ULONG count )
+{
+   std::vector <sProtocolReqRsp *> batch;
+   std::vector <iovec> bufs;
+
+   while ( (count > 0)
+   &&      (mpActiveRequest == 0)
+   &&      (mInFlight.size() + batch.size() < mInFlightWindow) )
+   {
+      count--;
+
+      const BYTE * pTxData = 0;
+      ULONG txSz = 0;
+      bool bEncoded = false;
+      if (StartRequest( pTxData, txSz, bEncoded ) == false)
+      {
+         continue;
+      }
+
+      if ( (pTxData != 0)
+      &&   (bEncoded == false)
+      &&   (mpActiveRequest->mRequiredAuxTxs == 0)
+      &&   (mInFlightWindow > DEFAULT_IN_FLIGHT_WINDOW)
+      &&   (batch.size() < MAX_TX_BATCH) )
+      {
+         iovec buf;
+         buf.iov_base = (void *)pTxData;
+         buf.iov_len = (size_t)txSz;
+
+         batch.push_back( mpActiveRequest );
+         bufs.push_back( buf );
+         mpActiveRequest = 0;
+         continue;
+      }
+
+      // This one goes out on its own, after what was gathered before it
+      sProtocolReqRsp * pReqRsp = mpActiveRequest;
+      mpActiveRequest = 0;
+      TransmitBatch( batch, bufs );
+
+      mpActiveRequest = pReqRsp;
+
+      bool bTxSuccess = false;
+      if (pTxData != 0)
+      {
+         bTxSuccess = mComm.TxData( pTxData, txSz );
+      }
+
+      FinishRequestTx( bTxSuccess );
+   }
+
+   TransmitBatch( batch, bufs );
+}
+
+/*===========================================================================
+METHOD:
+   TransmitBatch (Internal Method)
+
+DESCRIPTION:
+   Transmit the gathered requests with a single write and complete each
+   of them (in order) according to whether it was sent in full
+
+PARAMETERS:
+   batch       [I/O] - Requests (cleared upon return)
+   bufs        [I/O] - Their data (cleared upon return)
+
+SEQUENCING:
+   Calling process must have lock on mScheduleMutex, there must be no 
+   active request
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cProtocolServer::TransmitBatch(
+   std::vector <sProtocolReqRsp *> &   batch,
+   std::vector <iovec> &               bufs )
+{
+   ULONG batchSz = (ULONG)batch.size();
+   if (batchSz == 0)
+   {
+      return;
+   }
+
+   ULONG sent = 0;
+   if (batchSz == 1)
+   {
+      if (mComm.TxData( (const BYTE *)bufs[0].iov_base, 
+                        (ULONG)bufs[0].iov_len ) == true)
+      {
+         sent = 1;
+      }
+   }
+   else
+   {
+      mComm.TxData( &bufs[0], batchSz, sent );
+      TRACE( "TransmitBatch(): %lu of %lu requests sent\n", sent, batchSz );
+   }
+
+   for (ULONG b = 0; b < batchSz; b++)
+   {
+      mpActiveRequest = batch[b];
+      FinishRequestTx( b < sent );
+   }
+
+   batch.clear();
+   bufs.clear();
+}
+
+/*===========================================================================
+METHOD:
+   StartRequest (Internal Method)
+
+DESCRIPTION:
+   Make the next due request the active one and prepare it for 
+   transmission (the part of ProcessRequest() before the data is sent)
+
+PARAMETERS:
+   pTxData     [ O ] - Data to transmit (0 if it could not be encoded)
+   txSz        [ O ] - Size of the above
+   bEncoded    [ O ] - Was the data encoded? (if so it only lives until
+                       the next request is encoded)
+
+SEQUENCING:
+   Calling process must have lock on mScheduleMutex, there must be no 
+   active request
+
+RETURN VALUE:
+   bool - Was a request made active?
+===========================================================================*/
+bool cProtocolServer::StartRequest(
+   const BYTE * &             pTxData,
+   ULONG &                    txSz,
+   bool &                     bEncoded )
+{
+   pTxData = 0;
+   txSz = 0;
+   bEncoded = false;
+
+   // Grab (and remove) the next due request from the ready queues
+   sProtocolReqRsp * pReady = PopReadyRequest();
+
+   // Did we find the request?
+   if (pReady == 0)
+   {
+      // No
+      return false;
+   }
+
+   // Set this request as the active request
+   mpActiveRequest = pReady;
+   mpActiveRequest->mState = eREQ_STATE_ACTIVE;
+   
+   TRACE( "ProcessRequest(): req %lu started\n", mpActiveRequest->mID );
+
+   // Extract the underlying request
+   const sProtocolRequest & req = mpActiveRequest->mRequest;
+
+   // A retransmission is part of the attempt already counted
+   if (mpActiveRequest->mbRetransmit == true)
+   {
+      mpActiveRequest->mbRetransmit = false;
+   }
+   else
+   {
+      // Increment attempt count?
+      if (req.GetRequests() != INFINITE_REQS)
+      {
+         // This request isn't an indefinite one, so keep track of each 
+         // attempt
+         mpActiveRequest->mAttempts++;
+      }
+
+      // Another attempt without a response?
+      if (++mpActiveRequest->mCycleAttempts > 1)
+      {
+         mStatistics.Count( mpActiveRequest->mStatsKey, 
+                            ePROTOCOL_STAT_RETRY );
+      }
+   }
+
+   // Note how long this transmission waited
+   ULONGLONG now = GetMicroTickCount();
+
+   ULONGLONG queueWait = 0;
+   if (now > mpActiveRequest->mDueTime)
+   {
+      queueWait = now - mpActiveRequest->mDueTime;
+   }
+
+   mStatistics.AddLatency( mpActiveRequest->mStatsKey, 
+                           ePROTOCOL_LAT_QUEUE, 
+                           queueWait );
+
+   // Encode data for transmission?
+   sSharedBuffer * pEncoded = 0;
+   pEncoded = EncodeTxData( req.GetSharedBuffer(), bEncoded );
+   if (bEncoded == false)
+   {
+      pTxData = req.GetBuffer();
+      txSz = req.GetSize();
+   }
+   else if (pEncoded != 0 && pEncoded->IsValid() == true)
+   {
+      mpActiveRequest->mEncodedSize = pEncoded->GetSize();
+      pTxData = pEncoded->GetBuffer();
+      txSz = pEncoded->GetSize();
+   }
+
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   FinishRequestTx (Internal Method)
+
+DESCRIPTION:
+   Handle the outcome of transmitting the active request
+
+PARAMETERS:
+   bTxSuccess  [ I ] - Was the request transmitted?
+
+SEQUENCING:
+   Calling process must have lock on mScheduleMutex
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cProtocolServer::FinishRequestTx( bool bTxSuccess )
+{
+   if (bTxSuccess == true)
+   {
+      TRACE( "ProcessRequest(): req %lu finished\n", mpActiveRequest->mID );
+      TxComplete();
+   }
+   else
+   {
+      TxError();
+      TRACE( "ProcessRequest(): req finished with a TxError\n" );
+   }
+}
+
+/*===========================================================================
+METHOD:
+   RxComplete (Internal Method)
+
+DESCRIPTION:
+   Handle completion of receive data operation
+
+PARAMETERS:
+   status         [ I ] - Status of operation
+   bytesReceived  [ I ] - Number of bytes received
+
+SEQUENCING:
+   This method is sequenced according to the schedule mutex
+   i.e. any other thread that needs to modify the schedule 
+   will block until this method completes
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cProtocolServer::RxComplete(
+   DWORD                      status,
+   DWORD                      bytesReceived )
+{
+   if (status != NO_ERROR)
+   {
+      TRACE( "cProtocolServer::RxComplete() = %lu\n", status );
+   }
+
+   // Error with the read
+   if (status != NO_ERROR || bytesReceived == 0)
+   {
+      // Setup the next read
+      mComm.RxData( mpRxArmedBuffer, 
+                    (ULONG)mRxBufferSize, 
+                    (cIOCallback *)&mRxCallback );
+
+      return;
+   }
+
+   // Get Schedule Mutex
+   if (GetScheduleMutex() == false)
+   {
+      TRACE( "RxComplete(), unable to get schedule Mutex\n" );
+      return;
+   }
+
+   TRACE( "RxComplete() - Entry at %llu\n", GetTickCount() );
+
+   // Decode from the buffer just filled and setup the next read into the
+   // other one right away, so that a burst of incoming data does not back
+   // up while decoding (a read completing meanwhile waits for the schedule
+   // mutex, hence the buffer being decoded is never read into)
+   BYTE * pFilled = mpRxArmedBuffer;
+   mpRxArmedBuffer = mpRxBuffer;
+   mpRxBuffer = pFilled;
+
+   mComm.RxData( mpRxArmedBuffer, 
+                 (ULONG)mRxBufferSize, 
+                 (cIOCallback *)&mRxCallback );
+
+   // Decode data
+   bool bAbortTx = false;
+   ULONG rspIdx = INVALID_LOG_INDEX;
+   mInFlightRspID = INVALID_REQUEST_ID;
+   mbErrorRsp = false;
+   bool bRsp = DecodeRxData( bytesReceived, rspIdx, bAbortTx );
+
+   // Is there an active request that needs to be aborted
+   if (mpActiveRequest != 0 && bAbortTx == true)
+   {
+      // Yes, terminate the transmission and handle the error
+      mComm.CancelTx();
+      TxError();
+   }
+   // Is there an active request and a valid response?
+   else if (mpActiveRequest != 0 && bRsp == true)
+   {
+      EndRequestCycle( mpActiveRequest, true, rspIdx );
+
+      const sProtocolRequest & req = mpActiveRequest->mRequest;
+      const cProtocolNotification * pNotifier = req.GetNotifier();
+
+      // Notify client that response was received
+      if (pNotifier != 0)
+      {
+         pNotifier->Notify( ePROTOCOL_EVT_RSP_RECV, 
+                            (DWORD)mpActiveRequest->mID, 
+                            (DWORD)rspIdx );
+      }
+
+      // Reschedule request as needed
+      RescheduleActiveRequest();
+   }
+   // Response to one of the in-flight requests?
+   else if (bRsp == true && mInFlightRspID != INVALID_REQUEST_ID)
+   {
+      CompleteInFlightRequest( mInFlightRspID, rspIdx );
+   }
+
+   TRACE( "RxComplete() - Exit at %llu\n", GetTickCount() );
+
+   // Unlock schedule mutex        
+   if (ReleaseScheduleMutex() == false)
+   {
+      // This should never happen
+      return;
+   }
+
+   return;
+}
+
+/*===========================================================================
+METHOD:
+   RxTimeout (Internal Method)
+
+DESCRIPTION:
+   Handle the response timer expiring
+
+SEQUENCING:
+   Calling process must have lock on mScheduleMutex
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cProtocolServer::RxTimeout()
+{
+   // No active request?
+   if (mpActiveRequest == 0)
+   {
+      TRACE( "RxTimeout() with no active request\n" );
+      ASSERT( 0 );
+   }
+   
+   TRACE( "RxTimeout() for req %lu\n", mpActiveRequest->mID );
+
+   // Still time to retransmit the request?
+   sProtocolReqRsp * pReqRsp = mpActiveRequest;
+   mpActiveRequest = 0;
+   if (RetransmitRequest( pReqRsp ) == true)
+   {
+      return;
+   }
+
+   mpActiveRequest = pReqRsp;
+   mStatistics.Count( mpActiveRequest->mStatsKey, ePROTOCOL_STAT_TIMEOUT );
+
+   const sProtocolRequest & req = mpActiveRequest->mRequest;
+   const cProtocolNotification * pNotifier = req.GetNotifier();
+
+   // Failure to receive response, notify client
+   if (pNotifier != 0)
+   {
+      pNotifier->Notify( ePROTOCOL_EVT_RSP_ERR, 
+                         (DWORD)mpActiveRequest->mID, 
+                         (DWORD)0 );
+   }
+
+   // Reschedule request as needed
+   RescheduleActiveRequest();
+}
+
+/*===========================================================================
+METHOD:
+   TxComplete (Internal Method)
+
+DESCRIPTION:
+   Handle completion of transmit data operation
+
+PARAMETERS:
+
+SEQUENCING:
+   Calling process must have lock on mScheduleMutex
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cProtocolServer::TxComplete()
+{
+   // No active request?
+   if (mpActiveRequest == 0)
+   {
+      TRACE( "TxComplete() called with no active request\n" );
+      ASSERT( 0 );
+   }
+   
+   TRACE( "TxComplete() req %lu started\n", mpActiveRequest->mID );
+
+   ULONG reqID = mpActiveRequest->mID;
+   const sProtocolRequest & req = mpActiveRequest->mRequest;
+   const cProtocolNotification * pNotifier = req.GetNotifier();
+
+   // Transmit the auxiliary data straight from the request, handing the 
+   // port as many transmission units at once as the source allows
+   ULONG tusInFlight = 1;
+   const cAuxDataSource * pAuxSource = req.GetAuxiliarySource();
+   if (pAuxSource != 0)
+   {
+      tusInFlight = std::min( pAuxSource->GetTUsInFlight(), 
+                              MAX_AUX_TUS_IN_FLIGHT );
+   }
+
+   while (mpActiveRequest->mCurrentAuxTx < mpActiveRequest->mRequiredAuxTxs)
+   {
+      iovec bufs[MAX_AUX_TUS_IN_FLIGHT];
+      ULONG tus = 0;
+
+      bool bRC = true;
+      while ( (tus < tusInFlight)
+      &&      (mpActiveRequest->mCurrentAuxTx + tus 
+                  < mpActiveRequest->mRequiredAuxTxs) )
+      {
+         ULONG tuSz = 0;
+         const BYTE * pTU = mpActiveRequest->GetAuxTU( 
+                               mpActiveRequest->mCurrentAuxTx + tus, 
+                               tuSz );
+
+         if (pTU == 0)
+         {
+            bRC = false;
+            break;
+         }
+
+         bufs[tus].iov_base = (void *)pTU;
+         bufs[tus].iov_len = tuSz;
+         tus++;
+      }
+
+      // If the last write of unframed write request is divisible by 
+      // 512, break off last byte and send seperatly
+      const BYTE * pLastByte = 0;
+      if ( (bRC == true)
+      &&   (mpActiveRequest->mCurrentAuxTx + tus 
+               == mpActiveRequest->mRequiredAuxTxs)
+      &&   (bufs[tus - 1].iov_len % MAX_PACKET_SIZE == 0) )
+      {
+         TRACE( "TxComplete() Special case, break off last byte\n" );
+
+         bufs[tus - 1].iov_len--;
+         pLastByte = (const BYTE *)bufs[tus - 1].iov_base 
+                   + bufs[tus - 1].iov_len;
+      }
+
+      if (bRC == true)
+      {
+         ULONG bufsSent = 0;
+         bRC = mComm.TxData( &bufs[0], tus, bufsSent );
+      }
+
+      if (bRC == true && pLastByte != 0)
+      {
+         bRC = mComm.TxData( pLastByte, 1 );
+         bufs[tus - 1].iov_len++;
+      }
+
+      if (bRC == false)
+      {
+         TxError();
+         return;
+      }
+
+      // Notify client of auxiliary data being sent
+      for (ULONG t = 0; t < tus; t++)
+      {
+         mpActiveRequest->mCurrentAuxTx++;
+         mpActiveRequest->mEncodedSize = (ULONG)bufs[t].iov_len;
+
+         if (pNotifier != 0)
+         {
+            pNotifier->Notify( ePROTOCOL_EVT_AUX_TU_SENT, 
+                               (DWORD)reqID, 
+                               (DWORD)mpActiveRequest->mEncodedSize );
+         }
+      }
+   }
+   
+   // Another successful transmission, add the buffer to the log
+   ULONG reqIdx = INVALID_LOG_INDEX;
+
+   sProtocolBuffer pb( req.GetSharedBuffer() );
+   reqIdx = mLog.AddBuffer( pb );
+
+   mStatistics.Count( mpActiveRequest->mStatsKey, ePROTOCOL_STAT_SENT );
+   mpActiveRequest->mSentTime = GetMicroTickCount();
+
+   // Notify client?
+   if (pNotifier != 0)
+   {
+      pNotifier->Notify( ePROTOCOL_EVT_REQ_SENT, (DWORD)reqID, (DWORD)reqIdx );
+   }
+
+   // Wait for a response?
+   if (mpActiveRequest->mRequest.IsTXOnly() == false)
+   {
+      if (mInFlightWindow > DEFAULT_IN_FLIGHT_WINDOW)
+      {
+         // Await the response alongside any other in-flight requests
+         SetActiveRequestInFlight();
+         return;
+      }
+
+      // We now await the response
+      mpActiveRequest->mbWaitingForResponse = true;
+      mActiveRequestTimeout = GetResponseTimeout( mpActiveRequest );
+   }
+   else
+   {
+      // Nothing more to wait for
+      EndRequestCycle( mpActiveRequest, false, INVALID_LOG_INDEX );
+
+      // Reschedule request as needed
+      RescheduleActiveRequest();
+   }
+}
+
+/*===========================================================================
+METHOD:
+   TxError (Internal Method)
+
+DESCRIPTION:
+   Handle transmit data operation error be either rescheduling the
+   request or cleaning it up
+
+SEQUENCING:
+   Calling process must have lock on mScheduleMutex
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cProtocolServer::TxError()
+{
+   // No active request?
+   if (mpActiveRequest == 0)
+   {
+      return;
+   }
+
+   ULONG reqID = mpActiveRequest->mID;
+   const sProtocolRequest & req = mpActiveRequest->mRequest;
+   const cProtocolNotification * pNotifier = req.GetNotifier();
+
+   mStatistics.Count( mpActiveRequest->mStatsKey, ePROTOCOL_STAT_TX_ERROR );
+
+   // Failure to send request, notify client
+   if (pNotifier != 0)
+   {
+      pNotifier->Notify( ePROTOCOL_EVT_REQ_ERR, (DWORD)reqID, (DWORD)0 );
+   }
+
+   // Reschedule request as needed
+   RescheduleActiveRequest();
+}
+
+/*===========================================================================
+METHOD:
+   Initialize (Public Method)
+
+DESCRIPTION:
+   Initialize the protocol server by starting up the schedule thread
+
+SEQUENCING:
+   This method is sequenced according to the schedule mutex, i.e. any
+   other thread that needs to modify the schedule will block until 
+   this method completes
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cProtocolServer::Initialize()
+{
+   // Assume failure
+   bool bRC = false;
+
+   mbExiting = false;
+
+   // Get mScheduleMutex
+   if (GetScheduleMutex() == true)
+   {
+      if (mScheduleThreadID == 0)
+      {
+         // Yes, start thread
+         int nRet = mThreadConfig.CreateThread( eTHREAD_ROLE_SCHEDULE,
+                                                &mScheduleThreadID,
+                                                ScheduleThread,
+                                                this );
+         if (nRet == 0)
+         {
+            // Success!
+            bRC = true;
+         }
+      }
+   }
+   else
+   {
+      TRACE( "cProtocolServer::Initialize(), unable to aquire ScheduleMutex\n" );
+      return false;
+   }
+
+   // Unlock schedule mutex        
+   if (ReleaseScheduleMutex() == false)
+   {
+      // This should never happen
+      return false;
+   }
+
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   Exit (Public Method)
+
+DESCRIPTION:
+   Exit the protocol server by exiting the schedule thread (if necessary)
+
+SEQUENCING:
    This method is sequenced according to the schedule mutex, i.e. any
    other thread that needs to modify the schedule will block until 
    this method completes
@@ -1316,8 +2606,9 @@ bool cProtocolServer::Exit()
       // Set exit event
       mbExiting = true;
       
-      // Signal a schedule update
-      if (mThreadScheduleEvent.Set( 1 ) != 0)
+      // Signal a schedule update and release the mutex, the thread may
+      // be about to lock it
+      if (ReleaseScheduleMutex( true ) == false)
       {
          // This should never happen
          return false;
@@ -1342,152 +2633,484 @@ bool cProtocolServer::Exit()
       TRACE( "cProtocolServer::Exit(), completed thread %lu\n",
              (ULONG)mScheduleThreadID );
 
-      bRC = true;
+      bRC = true;
+      
+      // Release "handle"
+      mScheduleThreadID = 0;
+   }
+   else
+   {
+      // No ScheduleThread
+      bRC = true;
+   }
+
+   // Free any allocated requests
+   for (ULONG p = 0; p < (ULONG)ePROTOCOL_PRIORITY_END; p++)
+   {
+      mReadyQueues[p].clear();
+   }
+
+   mInFlight.clear();
+   mpActiveRequest = 0;
+
+   // (The records are kept, they hold the generation of their IDs)
+   for (ULONG r = 0; r < (ULONG)mRequestSlots.size(); r++)
+   {
+      sProtocolReqRsp & reqRsp = mRequestSlots[r];
+      if (reqRsp.mState != eREQ_STATE_FREE)
+      {
+         mRequestSchedule.Remove( reqRsp );
+         mResponseTimers.Remove( reqRsp );
+         FreeRequest( &reqRsp );
+      }
+   }
+
+   // Free log
+   mLog.Clear();
+
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   Connect (Public Method)
+
+DESCRIPTION:
+   Connect to the given communications port
+
+PARAMETERS:
+   pPort       [ I ] - String pointer representing the device node to
+                       connect to (IE: /dev/qcqmi0)
+
+SEQUENCING:
+   None
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cProtocolServer::Connect( LPCSTR pPort )
+{
+   // Assume failure
+   bool bRC = false;
+   if (pPort == 0 || pPort[0] == 0)
+   {
+      return bRC;
+   }
+
+   // Connect to device
+
+   // Set callback
+   mRxCallback.SetServer( this );
+
+   // Override to initialize port with protocol specific options
+   bRC = mComm.Connect( pPort );
+   if (bRC == true)
+   {
+      bRC = InitializeComm();
+      if (bRC == true)
+      {
+         // Setup the initial read
+         mComm.RxData( mpRxArmedBuffer, 
+                       (ULONG)mRxBufferSize, 
+                       (cIOCallback *)&mRxCallback );
+      }
+   }
+
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   Disconnect (Public Method)
+
+DESCRIPTION:
+   Disconnect from the current communications port
+
+SEQUENCING:
+   None
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cProtocolServer::Disconnect()
+{
+   // Disconnect
+
+   // Cancel any outstanding I/O
+   mComm.CancelIO();
+
+   // Empty callback
+   mRxCallback.SetServer( 0 );
+
+   // Cleanup COM port
+   CleanupComm();
+
+   // Now disconnect
+   return mComm.Disconnect();
+}
+
+/*===========================================================================
+METHOD:
+   IsConnected (Public Method)
+
+DESCRIPTION:
+   Are we currently connected to a port?
+
+SEQUENCING:
+   None
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cProtocolServer::IsConnected()
+{
+   return mComm.IsConnected();
+}
+
+/*===========================================================================
+METHOD:
+   AddRequest (Public Method)
+
+DESCRIPTION:
+   Add an outgoing protocol request to the protocol server request queue
+
+PARAMETERS:
+   req        [ I ] - Request being added
+
+SEQUENCING:
+   This method is sequenced according to the schedule mutex, i.e. any
+   other thread that needs to modify the schedule will block until 
+   this method completes
+
+RETURN VALUE:
+   ULONG - ID of scheduled request (INVALID_REQUEST_ID upon error)
+===========================================================================*/
+ULONG cProtocolServer::AddRequest( const sProtocolRequest & req )
+{
+   // Assume failure
+   ULONG reqID = INVALID_REQUEST_ID;
+
+   // Invalid request for this server?
+   if (CheckRequest( req ) == false)
+   {
+      return reqID;
+   }
+
+   // Get mScheduleMutex
+   if (GetScheduleMutex() == true)
+   {
+      TRACE( "AddRequest() - Entry at %llu\n", GetTickCount() );
+
+      reqID = HandleAddRequest( req );
+      
+      TRACE( "AddRequest() - Exit at %llu\n", GetTickCount() );
+
+      // Unlock schedule mutex        
+      if (ReleaseScheduleMutex() == false)
+      {
+         // This should never happen
+         return INVALID_REQUEST_ID;
+      }
+   }
+   else
+   {
+      TRACE( "cProtocolServer::AddRequest(), unable to get schedule Mutex\n" );
+   }
+
+   return reqID;
+}
+
+/*===========================================================================
+METHOD:
+   AddRequests (Public Method)
+
+DESCRIPTION:
+   Add several outgoing protocol requests to the protocol server request
+   queue at once, i.e. under a single acquisition of the schedule mutex and
+   with a single wakeup of the schedule thread
+
+PARAMETERS:
+   reqs       [ I ] - Requests being added
+   reqIDs     [ O ] - ID of each scheduled request (INVALID_REQUEST_ID for
+                      each request that could not be added)
+
+SEQUENCING:
+   This method is sequenced according to the schedule mutex, i.e. any
+   other thread that needs to modify the schedule will block until 
+   this method completes
+
+RETURN VALUE:
+   ULONG - Number of requests scheduled
+===========================================================================*/
+ULONG cProtocolServer::AddRequests(
+   const std::vector <const sProtocolRequest *> &  reqs,
+   std::vector <ULONG> &                           reqIDs )
+{
+   ULONG reqCount = (ULONG)reqs.size();
+   reqIDs.assign( reqCount, INVALID_REQUEST_ID );
+
+   // Validate (outside of the schedule mutex) first
+   std::vector <bool> valid( reqCount, false );
+
+   ULONG validCount = 0;
+   for (ULONG r = 0; r < reqCount; r++)
+   {
+      if (reqs[r] != 0 && CheckRequest( *reqs[r] ) == true)
+      {
+         valid[r] = true;
+         validCount++;
+      }
+   }
+
+   if (validCount == 0)
+   {
+      return 0;
+   }
+
+   // Get mScheduleMutex
+   if (GetScheduleMutex() == false)
+   {
+      TRACE( "cProtocolServer::AddRequests(), unable to get schedule Mutex\n" );
+      return 0;
+   }
+
+   TRACE( "AddRequests() - Entry at %llu\n", GetTickCount() );
+
+   ULONG added = 0;
+   for (ULONG r = 0; r < reqCount; r++)
+   {
+      if (valid[r] == true)
+      {
+         reqIDs[r] = HandleAddRequest( *reqs[r] );
+         if (reqIDs[r] != INVALID_REQUEST_ID)
+         {
+            added++;
+         }
+      }
+   }
+
+   TRACE( "AddRequests() - Exit at %llu\n", GetTickCount() );
+
+   // Unlock schedule mutex        
+   if (ReleaseScheduleMutex() == false)
+   {
+      // This should never happen
+      reqIDs.assign( reqCount, INVALID_REQUEST_ID );
+      return 0;
+   }
+
+   return added;
+}
+
+/*===========================================================================
+METHOD:
+   RemoveRequest (Public Method)
+
+DESCRIPTION:
+   Remove a previously added protocol request
+
+SEQUENCING:
+   This method is sequenced according to the schedule mutex, i.e. any
+   other thread that needs to modify the schedule will block until 
+   this method completes
+   
+   Note: If a request is being written, it cannot be inturrupted as
+      both ProcessRequest and RemoveRequest depend on the ScheduleMutex
+      and the write is synchronus.  If the request has been written but
+      the read has not been triggered it can be removed.
+
+PARAMETERS:
+   reqID    [ I ] - ID of request being removed
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cProtocolServer::RemoveRequest( ULONG reqID )
+{
+   // Assume failure
+   bool bRC = false;
+   
+   // Get Schedule Mutex
+   if (GetScheduleMutex() == true)
+   {
+      TRACE( "RemoveRequest() - Entry at %llu\n", GetTickCount() );
       
-      // Release "handle"
-      mScheduleThreadID = 0;
+      bRC = HandleRemoveRequest( reqID );
       
-      // Release mutex lock, don't signal ScheduleThread
-      if (ReleaseScheduleMutex( false ) == false)
+      TRACE( "RemoveRequest() - Exit at %llu\n", GetTickCount() );
+
+      // Unlock schedule mutex        
+      if (ReleaseScheduleMutex() == false)
       {
          // This should never happen
          return false;
-      }   
+      }
    }
    else
    {
-      // No ScheduleThread
-      bRC = true;
-   }
-
-   // Free any allocated requests
-   std::map <ULONG, sProtocolReqRsp *>::iterator pReqIter;
-   pReqIter = mRequestMap.begin();
-
-   while (pReqIter != mRequestMap.end())
-   {
-      sProtocolReqRsp * pReqRsp = pReqIter->second;
-      if (pReqRsp != 0)
-      {
-         delete pReqRsp;
-      }
-
-      pReqIter++;
+      TRACE( "cProtocolServer::RemoveRequest(), unable to get mScheduleMutex\n" );
    }
 
-   mRequestMap.clear();
-
-   // Free log
-   mLog.Clear();
-
    return bRC;
 }
 
 /*===========================================================================
 METHOD:
-   Connect (Public Method)
+   SetInFlightWindow (Public Method)
 
 DESCRIPTION:
-   Connect to the given communications port
+   Set the maximum number of requests that may be awaiting a response at
+   once.  The default window of one sends each request only after the 
+   previous one has been answered (or has timed out), a larger window 
+   requires a protocol that can match responses to the in-flight requests
+   (i.e. by QMI transaction ID)
+
+   Note: shrinking the window does not affect requests already in flight
 
 PARAMETERS:
-   pPort       [ I ] - String pointer representing the device node to
-                       connect to (IE: /dev/qcqmi0)
+   window   [ I ] - Maximum number of requests awaiting a response
 
 SEQUENCING:
-   None
+   This method is sequenced according to the schedule mutex, i.e. any
+   other thread that needs to modify the schedule will block until 
+   this method completes
 
 RETURN VALUE:
    bool
 ===========================================================================*/
-bool cProtocolServer::Connect( LPCSTR pPort )
+bool cProtocolServer::SetInFlightWindow( ULONG window )
 {
    // Assume failure
    bool bRC = false;
-   if (pPort == 0 || pPort[0] == 0)
+   if (window < DEFAULT_IN_FLIGHT_WINDOW || SupportsInFlightWindow() == false)
    {
       return bRC;
    }
 
-   // Connect to device
-
-   // Set callback
-   mRxCallback.SetServer( this );
-
-   // Override to initialize port with protocol specific options
-   bRC = mComm.Connect( pPort );
-   if (bRC == true)
+   // Get Schedule Mutex
+   if (GetScheduleMutex() == true)
    {
-      bRC = InitializeComm();
-      if (bRC == true)
+      mInFlightWindow = window;
+      bRC = true;
+
+      // Unlock schedule mutex (the schedule thread may now send more)  
+      if (ReleaseScheduleMutex() == false)
       {
-         // Setup the initial read
-         mComm.RxData( mpRxBuffer, 
-                       (ULONG)mRxBufferSize, 
-                       (cIOCallback *)&mRxCallback );
+         // This should never happen
+         return false;
       }
    }
+   else
+   {
+      TRACE( "cProtocolServer::SetInFlightWindow(), unable to get mScheduleMutex\n" );
+   }
 
    return bRC;
 }
 
 /*===========================================================================
 METHOD:
-   Disconnect (Public Method)
+   SetStatisticsDump (Public Method)
 
 DESCRIPTION:
-   Disconnect from the current communications port
+   Log the request statistics to syslog at the given interval
 
-SEQUENCING:
-   None
+PARAMETERS:
+   interval    [ I ] - Interval in milliseconds (0 to stop logging)
 
 RETURN VALUE:
    bool
 ===========================================================================*/
-bool cProtocolServer::Disconnect()
+bool cProtocolServer::SetStatisticsDump( ULONG interval )
 {
-   // Disconnect
-
-   // Cancel any outstanding I/O
-   mComm.CancelIO();
+   // Assume failure
+   bool bRC = false;
 
-   // Empty callback
-   mRxCallback.SetServer( 0 );
+   // Get Schedule Mutex
+   if (GetScheduleMutex() == true)
+   {
+      mStatsDumpInterval = interval;
+      mNextStatsDump = GetTickCount() + interval;
+      bRC = true;
 
-   // Cleanup COM port
-   CleanupComm();
+      // Unlock schedule mutex (and have the schedule thread pick up the
+      // new interval)
+      if (ReleaseScheduleMutex( true ) == false)
+      {
+         // This should never happen
+         return false;
+      }
+   }
+   else
+   {
+      TRACE( "cProtocolServer::SetStatisticsDump(), unable to get mScheduleMutex\n" );
+   }
 
-   // Now disconnect
-   return mComm.Disconnect();
+   return bRC;
 }
 
 /*===========================================================================
 METHOD:
-   IsConnected (Public Method)
+   SetAdaptiveTimeouts (Public Method)
 
 DESCRIPTION:
-   Are we currently connected to a port?
+   Enable or disable adaptive response timeouts, when enabled a request
+   still unanswered once the retransmission timeout estimated from the 
+   round trip times of its message ID (RFC 6298) elapses is retransmitted
+   with exponential backoff, the request timeout still bounds the attempt
+
+   Note: requests already awaiting a response keep their current timer
+
+PARAMETERS:
+   bAdaptive   [ I ] - Enable adaptive timeouts?
 
 SEQUENCING:
-   None
+   This method is sequenced according to the schedule mutex, i.e. any
+   other thread that needs to modify the schedule will block until 
+   this method completes
 
 RETURN VALUE:
    bool
 ===========================================================================*/
-bool cProtocolServer::IsConnected()
+bool cProtocolServer::SetAdaptiveTimeouts( bool bAdaptive )
 {
-   return mComm.IsConnected();
+   // Assume failure
+   bool bRC = false;
+
+   // Get Schedule Mutex
+   if (GetScheduleMutex() == true)
+   {
+      mbAdaptiveTimeouts = bAdaptive;
+      bRC = true;
+
+      // Unlock schedule mutex
+      if (ReleaseScheduleMutex( false ) == false)
+      {
+         // This should never happen
+         return false;
+      }
+   }
+   else
+   {
+      TRACE( "cProtocolServer::SetAdaptiveTimeouts(), unable to get mScheduleMutex\n" );
+   }
+
+   return bRC;
 }
 
 /*===========================================================================
 METHOD:
-   AddRequest (Public Method)
+   SetTxCoalescing (Public Method)
 
 DESCRIPTION:
-   Add an outgoing protocol request to the protocol server request queue
+   Set the transmit coalescing window, requests that become due while 
+   there is room in the in-flight window are held for up to this long so
+   that those following closely can be transmitted with the same write
+   (only applies with an in-flight window above one)
 
 PARAMETERS:
-   req        [ I ] - Request being added
+   window      [ I ] - Window in milliseconds (0 to send right away, the
+                       default)
 
 SEQUENCING:
    This method is sequenced according to the schedule mutex, i.e. any
@@ -1495,128 +3118,147 @@ SEQUENCING:
    this method completes
 
 RETURN VALUE:
-   ULONG - ID of scheduled request (INVALID_REQUEST_ID upon error)
+   bool
 ===========================================================================*/
-ULONG cProtocolServer::AddRequest( const sProtocolRequest & req )
+bool cProtocolServer::SetTxCoalescing( ULONG window )
 {
    // Assume failure
-   ULONG reqID = INVALID_REQUEST_ID;
-
-   // Server not configured for sending requests?
-   if (IsValid( mTxType ) == false)
-   {
-      return reqID;
-   }
-
-   // Request type not valid for server?
-   if (req.GetType() != mTxType)
-   {
-      return reqID;
-   }
-
-   // Invalide request?
-   if (ValidateRequest( req ) == false)
+   bool bRC = false;
+   if (window > MAX_TX_COALESCING)
    {
-      return reqID;
+      return bRC;
    }
 
-   // Get mScheduleMutex
+   // Get Schedule Mutex
    if (GetScheduleMutex() == true)
    {
-      TRACE( "AddRequest() - Entry at %llu\n", GetTickCount() );
-
-      // Grab next available request ID
-      if (++mLastRequestID == 0)
-      {
-         mLastRequestID++;
-      }
-      
-      reqID = mLastRequestID;
-      while (mRequestMap.find( reqID ) != mRequestMap.end())
-      {
-         reqID++;
-      }
-
-      // Wrap in our internal structure
-      sProtocolReqRsp * pReqRsp = 0;
-      pReqRsp = new sProtocolReqRsp( req, reqID, MAX_AUX_MTU_SIZE );
-
-      if (pReqRsp != 0)
-      {
-         // Add to request map
-         mRequestMap[reqID] = pReqRsp;
-         
-         // ... and schedule
-         ScheduleRequest( reqID, req.GetSchedule() );
-      }
-      
-      TRACE( "AddRequest() - Exit at %llu\n", GetTickCount() );
+      mTxCoalescing = window;
+      bRC = true;
 
-      // Unlock schedule mutex        
-      if (ReleaseScheduleMutex() == false)
+      // Unlock schedule mutex (and have the schedule thread release 
+      // anything held)
+      if (ReleaseScheduleMutex( true ) == false)
       {
          // This should never happen
-         return INVALID_REQUEST_ID;
+         return false;
       }
    }
    else
    {
-      TRACE( "cProtocolServer::AddRequest(), unable to get schedule Mutex\n" );
+      TRACE( "cProtocolServer::SetTxCoalescing(), unable to get mScheduleMutex\n" );
    }
 
-   return reqID;
+   return bRC;
 }
 
 /*===========================================================================
 METHOD:
-   RemoveRequest (Public Method)
+   GetQueueDepths (Public Method)
 
 DESCRIPTION:
-   Remove a previously added protocol request
+   Return the number of requests waiting to be sent at each priority and
+   how many of those are already due (but held back by the active or
+   in-flight requests, or by requests of higher priority)
+
+PARAMETERS:
+   pending     [ O ] - Requests waiting, indexed by eProtocolPriority
+   due         [ O ] - Of those the requests due, same indexing
 
 SEQUENCING:
    This method is sequenced according to the schedule mutex, i.e. any
    other thread that needs to modify the schedule will block until 
    this method completes
-   
-   Note: If a request is being written, it cannot be inturrupted as
-      both ProcessRequest and RemoveRequest depend on the ScheduleMutex
-      and the write is synchronus.  If the request has been written but
-      the read has not been triggered it can be removed.
-
-PARAMETERS:
-   reqID    [ I ] - ID of request being removed
 
 RETURN VALUE:
    bool
 ===========================================================================*/
-bool cProtocolServer::RemoveRequest( ULONG reqID )
+bool cProtocolServer::GetQueueDepths(
+   std::vector <ULONG> &      pending,
+   std::vector <ULONG> &      due )
 {
-   // Assume failure
-   bool bRC = false;
-   
+   pending.assign( (ULONG)ePROTOCOL_PRIORITY_END, 0 );
+   due.assign( (ULONG)ePROTOCOL_PRIORITY_END, 0 );
+
    // Get Schedule Mutex
-   if (GetScheduleMutex() == true)
+   if (GetScheduleMutex() == false)
    {
-      TRACE( "RemoveRequest() - Entry at %llu\n", GetTickCount() );
-      
-      bRC = HandleRemoveRequest( reqID );
-      
-      TRACE( "RemoveRequest() - Exit at %llu\n", GetTickCount() );
+      TRACE( "cProtocolServer::GetQueueDepths(), unable to get mScheduleMutex\n" );
+      return false;
+   }
 
-      // Unlock schedule mutex        
-      if (ReleaseScheduleMutex() == false)
+   for (ULONG r = 0; r < (ULONG)mRequestSlots.size(); r++)
+   {
+      const sProtocolReqRsp & reqRsp = mRequestSlots[r];
+      if (reqRsp.mState == eREQ_STATE_PENDING)
       {
-         // This should never happen
-         return false;
+         pending[reqRsp.mPriority]++;
       }
    }
-   else
+
+   for (ULONG p = 0; p < (ULONG)ePROTOCOL_PRIORITY_END; p++)
    {
-      TRACE( "cProtocolServer::RemoveRequest(), unable to get mScheduleMutex\n" );
+      due[p] = (ULONG)mReadyQueues[p].size();
    }
 
-   return bRC;
+   // Unlock schedule mutex
+   if (ReleaseScheduleMutex( false ) == false)
+   {
+      // This should never happen
+      return false;
+   }
+
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   SetLockName (Public Method)
+
+DESCRIPTION:
+   Set the name lock contention of this server is accounted under, the
+   schedule and log locks become "schedule:<name>" and "log:<name>"
+
+PARAMETERS:
+   pName       [ I ] - Name (typically the service, e.g. "WDS")
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cProtocolServer::SetLockName( LPCSTR pName )
+{
+   if (pName == 0)
+   {
+      return;
+   }
+
+   std::string name = pName;
+   mScheduleMutex.SetName( ("schedule:" + name).c_str() );
+   mLog.SetLockName( ("log:" + name).c_str() );
+}
+
+/*===========================================================================
+METHOD:
+   DumpStatistics (Internal Method)
+
+DESCRIPTION:
+   Log the request statistics to syslog, one line per message ID
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cProtocolServer::DumpStatistics()
+{
+   std::string port = mComm.GetPortName();
+   std::vector <sProtocolMessageStats> stats = mStatistics.GetStatistics();
+
+   for (ULONG s = 0; s < (ULONG)stats.size(); s++)
+   {
+      std::string line = cProtocolStatistics::Format( stats[s] );
+      syslog( LOG_INFO, 
+              "%s %s", 
+              port.c_str(), 
+              line.c_str() );
+   }
 }
 
 /*===========================================================================
@@ -1640,7 +3282,7 @@ bool cProtocolServer::GetScheduleMutex()
    ULONGLONG nStart = GetTickCount();
    
    //TRACE( "Locking Schedule mutex\n" );
-   int nRet = pthread_mutex_lock( &mScheduleMutex );
+   int nRet = mScheduleMutex.Lock();
    if (nRet != 0)
    {
       TRACE( "Unable to lock schedule mutex. Error %d: %s\n",
@@ -1687,7 +3329,7 @@ bool cProtocolServer::ReleaseScheduleMutex( bool bSignalThread )
       }
    }
    
-   int nRet = pthread_mutex_unlock( &mScheduleMutex );
+   int nRet = mScheduleMutex.Unlock();
    if (nRet != 0)
    {
       TRACE( "Unable to unlock schedule mutex. Error %d: %s\n",
@@ -48,10 +48,14 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "Comm.h"
 #include "ProtocolRequest.h"
 #include "ProtocolLog.h"
+#include "ProtocolStatistics.h"
+#include "ProfiledMutex.h"
 #include "Event.h"
+#include "TimerWheel.h"
 
+#include <deque>
 #include <map>
-#include <set>
+#include <vector>
 
 //---------------------------------------------------------------------------
 // Forward Declarations
@@ -66,7 +70,7 @@ struct sServerControl;
 // Invalid request ID
 extern const ULONG INVALID_REQUEST_ID;
 
-// Fill timespec with the time it will be in specified milliseconds
+// Fill timespec with the (monotonic) time it will be in specified milliseconds
 //   Relative time to Absolute time
 timespec TimeIn( ULONG millis );
 
@@ -77,6 +81,9 @@ ULONG TimeFromNow( timespec time );
 // Provide a number for sequencing reference, similar to the windows function
 ULONGLONG GetTickCount();
 
+// Provide a monotonic time in microseconds (for latency measurements)
+ULONGLONG GetMicroTickCount();
+
 // timespec < comparison method
 inline bool operator< (const timespec & first, const timespec & second)
 {
@@ -154,32 +161,159 @@ class cProtocolServer
       // Are we currently connected to a port?
       bool IsConnected();
 
+      // (Inline) Receive through the given reactor instead of POSIX AIO
+      // (must be called while disconnected)
+      bool SetCommReactor( cCommReactor * pReactor )
+      {
+         return mComm.SetReactor( pReactor );
+      };
+
+      // (Inline) Forward all I/O to the given transport instead of the
+      // port given to Connect() (must be called while disconnected)
+      bool SetCommTransport( cCommTransport * pTransport )
+      {
+         return mComm.SetTransport( pTransport );
+      };
+
+      // (Inline) Run the schedule thread and receive completions with the
+      // given thread configuration (must be called before Initialize())
+      void SetThreadConfig( const cThreadConfig & config )
+      {
+         mThreadConfig = config;
+         mComm.SetThreadConfig( config );
+      };
+
       // Add an outgoing protocol request to the protocol server request queue
       ULONG AddRequest( const sProtocolRequest & req );
+
+      // Add several outgoing protocol requests to the request queue at once
+      ULONG AddRequests(
+         const std::vector <const sProtocolRequest *> &  reqs,
+         std::vector <ULONG> &                           reqIDs );
  
       // Remove a previously added protocol request 
       bool RemoveRequest( ULONG reqID );
 
+      // Set the maximum number of requests awaiting a response at once
+      bool SetInFlightWindow( ULONG window );
+
+      // (Inline) Return the maximum number of requests awaiting a response
+      ULONG GetInFlightWindow()
+      {
+         return mInFlightWindow;
+      };
+
       // (Inline) Return the protocol log
       const cProtocolLog & GetLog()
       {
          return mLog;
       };
 
+      // (Inline) Return the request statistics (may be read from any 
+      // thread at any time)
+      const cProtocolStatistics & GetStatistics() const
+      {
+         return mStatistics;
+      };
+
+      // Log the request statistics to syslog at the given interval 
+      // (milliseconds, 0 to stop)
+      bool SetStatisticsDump( ULONG interval );
+
+      // Enable or disable adaptive response timeouts (unanswered requests
+      // are retransmitted once the round trip time measured for their 
+      // message ID has clearly elapsed, well before the request timeout)
+      bool SetAdaptiveTimeouts( bool bAdaptive );
+
+      // Return the number of requests waiting to be sent at each priority
+      // (indexed by eProtocolPriority) and how many of those are due
+      bool GetQueueDepths(
+         std::vector <ULONG> &      pending,
+         std::vector <ULONG> &      due );
+
+      // (Inline) Are adaptive response timeouts enabled?
+      bool GetAdaptiveTimeouts()
+      {
+         return mbAdaptiveTimeouts;
+      };
+
+      // Set the transmit coalescing window (milliseconds, 0 for none), 
+      // due requests are held up to this long so that more can be sent
+      // with the same write
+      bool SetTxCoalescing( ULONG window );
+
+      // (Inline) Return the transmit coalescing window
+      ULONG GetTxCoalescing()
+      {
+         return mTxCoalescing;
+      };
+
+      // Set the name lock contention of this server is accounted under
+      // (the schedule and log locks become "schedule:<name>" and 
+      // "log:<name>"), call before Initialize()
+      void SetLockName( LPCSTR pName );
+
    protected:
+      // Smoothed round trip time estimate (RFC 6298) of a message ID
+      struct sRTTEstimate
+      {
+         public:
+            // (Inline) Constructor
+            sRTTEstimate()
+               :  mSRTT( 0 ),
+                  mRTTVar( 0 ),
+                  mSamples( 0 )
+            { };
+
+            // Fold a round trip time sample (microseconds) into the estimate
+            void AddSample( ULONGLONG rtt );
+
+            // Return the retransmission timeout (milliseconds, 0 if there
+            // have been no samples yet)
+            ULONG GetRTO() const;
+
+            /* Smoothed round trip time and its variation (microseconds) */
+            ULONGLONG mSRTT;
+            ULONGLONG mRTTVar;
+
+            /* Number of samples folded in */
+            ULONG mSamples;
+      };
+
+      // State of a request record
+      enum eRequestState
+      {
+         eREQ_STATE_FREE = 0,       // On the free list
+         eREQ_STATE_PENDING,        // Scheduled or in a ready queue
+         eREQ_STATE_ACTIVE,         // Being transmitted (mpActiveRequest)
+         eREQ_STATE_IN_FLIGHT       // Awaiting its response (mInFlight)
+      };
+
       // Internal protocol server request/response structure, used to track
-      // info related to sending out a request
-      struct sProtocolReqRsp
+      // info related to sending out a request (the timer entry is linked in
+      // the request schedule or, while in-flight, the response timers)
+      //
+      // Records live in mRequestSlots and are recycled, the fields used by
+      // the scheduler on every pass come first and the request itself last
+      struct sProtocolReqRsp : public sTimerWheelNode
       {
          public:
-            // Constructor
-            sProtocolReqRsp(
+            // Constructor (free record)
+            sProtocolReqRsp();
+
+            // Copy constructor
+            sProtocolReqRsp( const sProtocolReqRsp & reqRsp );
+
+            // Take on the given request
+            void Init(
                const sProtocolRequest &   requestInfo,
                ULONG                      requestID,
                ULONG                      auxDataMTU );
 
-            // Copy constructor
-            sProtocolReqRsp( const sProtocolReqRsp & reqRsp );
+            // Get the given auxiliary data transmission unit (0 if none)
+            const BYTE * GetAuxTU(
+               ULONG                      tu,
+               ULONG &                    tuSz ) const;
 
             // (Inline) Reset for next transmission attempt
             void Reset()
@@ -190,12 +324,39 @@ class cProtocolServer
                mbWaitingForResponse = 0;
             };
 
-            /* Request ID */
+            /* Request ID (slot generation and index) */
             ULONG mID;
 
+            /* Record state (eRequestState) */
+            UINT mState : 2;
+
+            /* Are we currently waiting for a response? */
+            UINT mbWaitingForResponse : 1;
+
+            /* Is the request scheduled as a retransmission? */
+            UINT mbRetransmit : 1;
+
+            /* Scheduling priority */
+            eProtocolPriority mPriority;
+
+            /* Time (microseconds) the first of the attempts made since the
+               last response was due, the current attempt is due and the 
+               last attempt was sent */
+            ULONGLONG mStartTime;
+            ULONGLONG mDueTime;
+            ULONGLONG mSentTime;
+
+            /* Tick the current attempt fails at without a response (0 
+               until sent) and number of retransmissions made before it */
+            ULONGLONG mDeadline;
+            ULONG mRetransmits;
+
             /* Number of times this request has been attempted */
             ULONG mAttempts;
 
+            /* Attempts made since the last response */
+            ULONG mCycleAttempts;
+
             /* Size of encoded data being transmitted */
             ULONG mEncodedSize;
 
@@ -205,48 +366,150 @@ class cProtocolServer
             /* Current auxiliary data transmission */
             ULONG mCurrentAuxTx;
 
-            /* Are we currently waiting for a response? */
-            bool mbWaitingForResponse;
+            /* Auxiliary data transmission unit size */
+            ULONG mAuxTUSize;
+
+            /* Statistics key (message ID) */
+            ULONG mStatsKey;
+
+            /* Next record on the free list (when free) */
+            ULONG mNextFree;
 
             /* Underlying protocol request */
             sProtocolRequest mRequest;
       };
 
+      // Take a free request record for the given request (0 if none left)
+      sProtocolReqRsp * AllocRequest( const sProtocolRequest & req );
+
+      // Return a request record to the free list
+      void FreeRequest( sProtocolReqRsp * pReqRsp );
+
+      // Find the request record with the given ID and state (0 if none)
+      sProtocolReqRsp * FindRequest( 
+         ULONG                      reqID,
+         eRequestState              state );
+
+      // Remove the given request from mInFlight
+      void RemoveInFlightRequest( sProtocolReqRsp * pReqRsp );
+
+      // Can the given request be added to this server?
+      bool CheckRequest( const sProtocolRequest & req );
+
+      // Handle the add request
+      ULONG HandleAddRequest( const sProtocolRequest & req );
+
       // Handle the remove request
       bool HandleRemoveRequest( ULONG reqID );
 
       // Schedule a request for transmission
       bool ScheduleRequest(
-         ULONG                      reqID,
+         sProtocolReqRsp *          pReqRsp,
          ULONG                      schedule );
 
-      // (Inline) Get next request's time from mRequestSchedule
-      timespec GetNextRequestTime()
-      {
-         timespec outTime;
-      
-         std::set <tSchedule>::iterator pScheduleIter;
-         pScheduleIter = mRequestSchedule.begin();
-         tSchedule entry = *pScheduleIter;
-
-         outTime = entry.first;
-         return outTime;
-      }
-   
       // (Inline) Validate a request that is about to be scheduled
       virtual bool ValidateRequest( const sProtocolRequest & req )
       {
          return req.IsValid();
       };
 
+      // (Inline) Return the statistics key (message ID) of a request
+      virtual ULONG GetStatisticsKey( const sProtocolRequest & /* req */ )
+      {
+         return 0;
+      };
+
+      // (Inline) Return the scheduling priority of a request
+      virtual eProtocolPriority GetRequestPriority( 
+         const sProtocolRequest &   req )
+      {
+         return req.GetPriority();
+      };
+
+      // Move the due requests of the schedule to the ready queues
+      void QueueDueRequests();
+
+      // Remove (and return) the next ready request to be sent
+      sProtocolReqRsp * PopReadyRequest();
+
+      // Remove the given request from the ready queues
+      void RemoveReadyRequest( sProtocolReqRsp * pReqRsp );
+
+      // Return the number of requests in the ready queues
+      ULONG GetReadyCount();
+
+      // Record the outcome of the current attempt cycle of a request
+      void EndRequestCycle(
+         sProtocolReqRsp *          pReqRsp,
+         bool                       bResponse,
+         ULONG                      rspIdx );
+
+      // Return the tick the response timer of a request that has just been
+      // transmitted is to expire at
+      ULONGLONG GetResponseTimeout( sProtocolReqRsp * pReqRsp );
+
+      // Retransmit a request whose response timer expired before the
+      // attempt deadline (returns false if the attempt has failed instead)
+      bool RetransmitRequest( sProtocolReqRsp * pReqRsp );
+
+      // Log the request statistics to syslog
+      void DumpStatistics();
+
+      // (Inline) Can responses be matched to one of several in-flight
+      // requests? (if so DecodeRxData() must set mInFlightRspID)
+      virtual bool SupportsInFlightWindow()
+      {
+         return false;
+      };
+
+      // Reschedule (or cleanup) the given request
+      void RescheduleRequest( sProtocolReqRsp * pReqRsp );
+
       // Reschedule (or cleanup) the active request
       void RescheduleActiveRequest();
 
+      // Move the active request to mInFlight to await a response
+      void SetActiveRequestInFlight();
+
+      // Handle the response timer expiring for an in-flight request
+      void InFlightTimeout( ULONG reqID );
+
+      // Handle the response to an in-flight request
+      void CompleteInFlightRequest(
+         ULONG                      reqID,
+         ULONG                      rspIdx );
+
+      // Handle response timers of in-flight requests, returning next due
+      void CheckInFlightTimeouts(
+         ULONGLONG                  curTime,
+         ULONGLONG &                toTime );
+
       // Process a single outgoing protocol request
       void ProcessRequest();
 
-      // Check that system time hasn't moved backwards
-      bool CheckSystemTime();
+      // Process several outgoing protocol requests, sending those that 
+      // allow it with a single write
+      void ProcessRequests( ULONG count );
+
+      // Make the next due request active and prepare its data
+      bool StartRequest(
+         const BYTE * &             pTxData,
+         ULONG &                    txSz,
+         bool &                     bEncoded );
+
+      // Handle the outcome of transmitting the active request
+      void FinishRequestTx( bool bTxSuccess );
+
+      // Transmit the gathered requests with a single write
+      void TransmitBatch(
+         std::vector <sProtocolReqRsp *> &   batch,
+         std::vector <iovec> &               bufs );
+
+      // Hold the ready requests for the transmit coalescing window?
+      bool HoldForCoalescing(
+         ULONG                      readyCount,
+         ULONGLONG                  curTime,
+         ULONGLONG &                toTime );
 
       // Perform protocol specific communications port initialization
       virtual bool InitializeComm() = 0;
@@ -282,6 +545,9 @@ class cProtocolServer
       /* Underlying communications object */
       cComm mComm;
 
+      /* Thread configuration (of the schedule thread) */
+      cThreadConfig mThreadConfig;
+
       /* Rx callback */
       cProtocolServerRxCallback mRxCallback;
 
@@ -293,7 +559,7 @@ class cProtocolServer
 
       // Schedule mutex
       // Ensures exclusive access to mRequestSchedule
-      pthread_mutex_t mScheduleMutex;
+      cProfiledMutex mScheduleMutex;
       
       // Is the thread in the process of exiting?
       //  (no new commands will be accepted)
@@ -302,30 +568,71 @@ class cProtocolServer
       /* Client/server thread control object */
       sSharedBuffer * mpServerControl;
 
-      /* Protocol request schedule (scheduled time/request ID) */
-      typedef std::pair <timespec, ULONG> tSchedule;
-      std::set < tSchedule, std::less <tSchedule> > mRequestSchedule;
+      /* Protocol request schedule (pending requests by due tick) */
+      cTimerWheel mRequestSchedule;
+
+      /* Pending requests that are due, oldest first, by priority */
+      std::deque <sProtocolReqRsp *> mReadyQueues[ePROTOCOL_PRIORITY_END];
 
-      /* Last system time value (used to check for time changes) */
-      timespec mLastTime;
+      /* Sends left to each priority in the current weighted round */
+      ULONG mPriorityCredits[ePROTOCOL_PRIORITY_END];
 
-      /* Protocol request map (request ID mapped to internal req/rsp struct) */
-      std::map <ULONG, sProtocolReqRsp *> mRequestMap;
+      /* Request records, indexed by the low bits of the request ID (a 
+         deque so records stay put as it grows) */
+      std::deque <sProtocolReqRsp> mRequestSlots;
 
-      /* Last assigned request ID */
-      ULONG mLastRequestID;
+      /* First record on the free list (REQ_SLOT_NONE if empty) */
+      ULONG mFreeSlot;
 
       /* Current request being processed */
       sProtocolReqRsp * mpActiveRequest;
       
-      /* Absolute timeout for mpActiveRequest
+      /* Absolute timeout tick for mpActiveRequest
          based on when write was completed */
-      timespec mActiveRequestTimeout;
+      ULONGLONG mActiveRequestTimeout;
+
+      /* Requests transmitted and awaiting a response, oldest first */
+      std::vector <sProtocolReqRsp *> mInFlight;
+
+      /* Response timers of the requests in mInFlight */
+      cTimerWheel mResponseTimers;
+
+      /* Maximum number of requests awaiting a response at once */
+      ULONG mInFlightWindow;
+
+      /* ID of the in-flight request matched by the last DecodeRxData() */
+      ULONG mInFlightRspID;
+
+      /* Did the response decoded by the last DecodeRxData() report an 
+         error? (only used for statistics) */
+      bool mbErrorRsp;
 
-      /* Data buffer for incoming data */
+      /* Request statistics */
+      cProtocolStatistics mStatistics;
+
+      /* Statistics dump interval (0 for none) and next dump tick */
+      ULONG mStatsDumpInterval;
+      ULONGLONG mNextStatsDump;
+
+      /* Are response timeouts derived from measured round trip times? */
+      bool mbAdaptiveTimeouts;
+
+      /* Transmit coalescing window (milliseconds, 0 for none) */
+      ULONG mTxCoalescing;
+
+      /* Round trip time estimates (by statistics key) and across all
+         requests (used for message IDs without samples of their own) */
+      std::map <ULONG, sRTTEstimate> mRTTEstimates;
+      sRTTEstimate mServerRTT;
+
+      /* Data buffer for incoming data (being decoded) */
       BYTE * mpRxBuffer;
 
-      /* Size of above buffer (i.e. how much data to read in at once) */
+      /* Second data buffer for incoming data, handed to the port so the
+         next read is outstanding while the above buffer is decoded */
+      BYTE * mpRxArmedBuffer;
+
+      /* Size of above buffers (i.e. how much data to read in at once) */
       ULONG mRxBufferSize;
 
       /* Protocol type for incoming/outgoing data*/
@@ -0,0 +1,522 @@
+/*===========================================================================
+FILE:
+   ProtocolStatistics.cpp
+
+DESCRIPTION:
+   Implementation of cLatencyHistogram and cProtocolStatistics classes
+
+PUBLIC CLASSES AND METHODS:
+   cLatencyHistogram
+      Log-linear (HDR style) histogram of microsecond latencies
+
+   cProtocolStatistics
+      Request counters and latency histograms of a protocol server,
+      keyed by message ID
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "StdAfx.h"
+#include "ProtocolStatistics.h"
+
+//---------------------------------------------------------------------------
+// Definitions
+//---------------------------------------------------------------------------
+
+// Values below this have a bucket of their own
+const ULONGLONG LATENCY_EXACT_LIMIT = 2 << LATENCY_HISTOGRAM_SUB_BITS;
+
+// Counter names (indexed by eProtocolStatCounter)
+static LPCSTR gCounterNames[ePROTOCOL_STAT_END] =
+{
+   "sent",
+   "rsp",
+   "err",
+   "timeout",
+   "retry",
+   "abort",
+   "txerr",
+   "rexmit"
+};
+
+// Latency names (indexed by eProtocolStatLatency)
+static LPCSTR gLatencyNames[ePROTOCOL_LAT_END] =
+{
+   "queue",
+   "rtt",
+   "total"
+};
+
+/*=========================================================================*/
+// cLatencyHistogram Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   cLatencyHistogram (Public Method)
+
+DESCRIPTION:
+   Constructor
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+cLatencyHistogram::cLatencyHistogram()
+   :  mMax( 0 )
+{
+   memset( &mBuckets[0], 0, sizeof( mBuckets ) );
+}
+
+/*===========================================================================
+METHOD:
+   Add (Public Method)
+
+DESCRIPTION:
+   Add a sample
+
+PARAMETERS:
+   us          [ I ] - Latency (microseconds)
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+void cLatencyHistogram::Add( ULONGLONG us )
+{
+   __sync_add_and_fetch( &mBuckets[GetBucket( us )], 1 );
+
+   ULONGLONG curMax = mMax;
+   while (us > curMax)
+   {
+      ULONGLONG prevMax = __sync_val_compare_and_swap( &mMax, curMax, us );
+      if (prevMax == curMax)
+      {
+         break;
+      }
+
+      curMax = prevMax;
+   }
+}
+
+/*===========================================================================
+METHOD:
+   Summarize (Public Method)
+
+DESCRIPTION:
+   Summarize the samples added so far, percentiles are the highest value
+   of the bucket they fall in (never above the maximum)
+  
+RETURN VALUE:
+   sLatencySummary
+===========================================================================*/
+sLatencySummary cLatencyHistogram::Summarize() const
+{
+   sLatencySummary summary;
+   memset( &summary, 0, sizeof( summary ) );
+
+   // Snapshot the buckets (concurrent samples may or may not be seen)
+   ULONG counts[LATENCY_HISTOGRAM_BUCKETS];
+   ULONG total = 0;
+   for (ULONG b = 0; b < LATENCY_HISTOGRAM_BUCKETS; b++)
+   {
+      counts[b] = __sync_fetch_and_add( (ULONG *)&mBuckets[b], 0 );
+      total += counts[b];
+   }
+
+   summary.mCount = total;
+   summary.mMax = __sync_fetch_and_add( (ULONGLONG *)&mMax, 0 );
+   if (total == 0)
+   {
+      return summary;
+   }
+
+   const ULONG pcts[] = { 50, 90, 99 };
+   ULONGLONG * pOut[] = { &summary.mP50, &summary.mP90, &summary.mP99 };
+   const ULONG numPcts = sizeof( pcts ) / sizeof( pcts[0] );
+
+   ULONG p = 0;
+   ULONG seen = 0;
+   for (ULONG b = 0; b < LATENCY_HISTOGRAM_BUCKETS && p < numPcts; b++)
+   {
+      seen += counts[b];
+
+      // Rank of the percentile (rounded up, at least one)
+      while (p < numPcts)
+      {
+         ULONGLONG rank = ((ULONGLONG)total * pcts[p] + 99) / 100;
+         if (rank == 0)
+         {
+            rank = 1;
+         }
+
+         if ((ULONGLONG)seen < rank)
+         {
+            break;
+         }
+
+         ULONGLONG val = GetBucketValue( b );
+         *pOut[p++] = (val < summary.mMax ? val : summary.mMax);
+      }
+   }
+
+   return summary;
+}
+
+/*===========================================================================
+METHOD:
+   GetBucket (Static Public Method)
+
+DESCRIPTION:
+   Return the bucket of the given value
+
+PARAMETERS:
+   us          [ I ] - Value
+  
+RETURN VALUE:
+   ULONG
+===========================================================================*/
+ULONG cLatencyHistogram::GetBucket( ULONGLONG us )
+{
+   if (us < LATENCY_EXACT_LIMIT)
+   {
+      return (ULONG)us;
+   }
+
+   // Top (sub bits + 1) bits of the value, scaled by its magnitude
+   ULONG msb = 63 - (ULONG)__builtin_clzll( us );
+   ULONG shift = msb - LATENCY_HISTOGRAM_SUB_BITS;
+   ULONG bucket = (shift << LATENCY_HISTOGRAM_SUB_BITS) + (ULONG)(us >> shift);
+   if (bucket >= LATENCY_HISTOGRAM_BUCKETS)
+   {
+      bucket = LATENCY_HISTOGRAM_BUCKETS - 1;
+   }
+
+   return bucket;
+}
+
+/*===========================================================================
+METHOD:
+   GetBucketValue (Static Public Method)
+
+DESCRIPTION:
+   Return the highest value of the given bucket
+
+PARAMETERS:
+   bucket      [ I ] - Bucket
+  
+RETURN VALUE:
+   ULONGLONG
+===========================================================================*/
+ULONGLONG cLatencyHistogram::GetBucketValue( ULONG bucket )
+{
+   if (bucket < LATENCY_EXACT_LIMIT)
+   {
+      return bucket;
+   }
+
+   ULONG half = 1 << LATENCY_HISTOGRAM_SUB_BITS;
+   ULONG shift = (bucket >> LATENCY_HISTOGRAM_SUB_BITS) - 1;
+   ULONGLONG mantissa = (bucket & (half - 1)) + half;
+   return ((mantissa + 1) << shift) - 1;
+}
+
+/*=========================================================================*/
+// cProtocolStatistics Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   cProtocolStatistics (Public Method)
+
+DESCRIPTION:
+   Constructor
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+cProtocolStatistics::cProtocolStatistics()
+{
+   memset( &mpPages[0], 0, sizeof( mpPages ) );
+}
+
+/*===========================================================================
+METHOD:
+   ~cProtocolStatistics (Public Method)
+
+DESCRIPTION:
+   Destructor
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+cProtocolStatistics::~cProtocolStatistics()
+{
+   for (ULONG p = 0; p < (ULONG)ePAGES; p++)
+   {
+      sEntry ** pPage = mpPages[p];
+      if (pPage == 0)
+      {
+         continue;
+      }
+
+      for (ULONG e = 0; e < (ULONG)ePAGE_SZ; e++)
+      {
+         delete pPage[e];
+      }
+
+      delete [] pPage;
+      mpPages[p] = 0;
+   }
+}
+
+/*===========================================================================
+METHOD:
+   Count (Public Method)
+
+DESCRIPTION:
+   Increment a counter of the given message ID
+
+PARAMETERS:
+   msgID       [ I ] - Message ID
+   counter     [ I ] - Counter
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+void cProtocolStatistics::Count(
+   ULONG                      msgID,
+   eProtocolStatCounter       counter )
+{
+   if (counter <= ePROTOCOL_STAT_BEGIN || counter >= ePROTOCOL_STAT_END)
+   {
+      return;
+   }
+
+   sEntry * pEntry = GetEntry( msgID );
+   if (pEntry != 0)
+   {
+      __sync_add_and_fetch( &pEntry->mCounters[counter], 1 );
+   }
+}
+
+/*===========================================================================
+METHOD:
+   AddLatency (Public Method)
+
+DESCRIPTION:
+   Add a latency sample to the given message ID
+
+PARAMETERS:
+   msgID       [ I ] - Message ID
+   latency     [ I ] - Latency type
+   us          [ I ] - Latency (microseconds)
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+void cProtocolStatistics::AddLatency(
+   ULONG                      msgID,
+   eProtocolStatLatency       latency,
+   ULONGLONG                  us )
+{
+   if (latency <= ePROTOCOL_LAT_BEGIN || latency >= ePROTOCOL_LAT_END)
+   {
+      return;
+   }
+
+   sEntry * pEntry = GetEntry( msgID );
+   if (pEntry != 0)
+   {
+      pEntry->mLatencies[latency].Add( us );
+   }
+}
+
+/*===========================================================================
+METHOD:
+   GetStatistics (Public Method)
+
+DESCRIPTION:
+   Return the statistics of every message ID seen so far
+
+RETURN VALUE:
+   std::vector <sProtocolMessageStats> - Statistics, by message ID
+===========================================================================*/
+std::vector <sProtocolMessageStats> cProtocolStatistics::GetStatistics() const
+{
+   std::vector <sProtocolMessageStats> stats;
+
+   for (ULONG p = 0; p < (ULONG)ePAGES; p++)
+   {
+      sEntry ** pPage = __sync_fetch_and_add( (sEntry ***)&mpPages[p], 0 );
+      if (pPage == 0)
+      {
+         continue;
+      }
+
+      for (ULONG e = 0; e < (ULONG)ePAGE_SZ; e++)
+      {
+         const sEntry * pEntry = __sync_fetch_and_add( &pPage[e], 0 );
+         if (pEntry == 0)
+         {
+            continue;
+         }
+
+         sProtocolMessageStats msgStats;
+         msgStats.mMessageID = (p << ePAGE_BITS) | e;
+
+         for (ULONG c = 0; c < (ULONG)ePROTOCOL_STAT_END; c++)
+         {
+            msgStats.mCounters[c] = 
+               __sync_fetch_and_add( (ULONG *)&pEntry->mCounters[c], 0 );
+         }
+
+         for (ULONG l = 0; l < (ULONG)ePROTOCOL_LAT_END; l++)
+         {
+            msgStats.mLatencies[l] = pEntry->mLatencies[l].Summarize();
+         }
+
+         stats.push_back( msgStats );
+      }
+   }
+
+   return stats;
+}
+
+/*===========================================================================
+METHOD:
+   Format (Static Public Method)
+
+DESCRIPTION:
+   Format the statistics of one message ID as a line of text (no 
+   line terminator), latencies are in microseconds
+
+PARAMETERS:
+   stats       [ I ] - Statistics
+  
+RETURN VALUE:
+   std::string
+===========================================================================*/
+std::string cProtocolStatistics::Format( const sProtocolMessageStats & stats )
+{
+   char buf[128];
+   snprintf( buf, sizeof( buf ), "msg 0x%04lX:", stats.mMessageID );
+
+   std::string line = buf;
+   for (ULONG c = 0; c < (ULONG)ePROTOCOL_STAT_END; c++)
+   {
+      snprintf( buf, 
+                sizeof( buf ), 
+                " %s %lu", 
+                gCounterNames[c], 
+                stats.mCounters[c] );
+
+      line += buf;
+   }
+
+   for (ULONG l = 0; l < (ULONG)ePROTOCOL_LAT_END; l++)
+   {
+      const sLatencySummary & lat = stats.mLatencies[l];
+      if (lat.mCount == 0)
+      {
+         continue;
+      }
+
+      snprintf( buf, 
+                sizeof( buf ), 
+                " %s p50/p90/p99/max %llu/%llu/%llu/%llu us",
+                gLatencyNames[l],
+                lat.mP50,
+                lat.mP90,
+                lat.mP99,
+                lat.mMax );
+
+      line += buf;
+   }
+
+   return line;
+}
+
+/*===========================================================================
+METHOD:
+   GetEntry (Internal Method)
+
+DESCRIPTION:
+   Return the entry of the given message ID, allocating it (and its 
+   page) on first use, racing allocations are resolved by compare and 
+   swap with the loser freeing its copy
+
+PARAMETERS:
+   msgID       [ I ] - Message ID
+  
+RETURN VALUE:
+   sEntry * - The entry (0 upon allocation failure)
+===========================================================================*/
+cProtocolStatistics::sEntry * cProtocolStatistics::GetEntry( ULONG msgID )
+{
+   msgID &= (PROTOCOL_STATS_MSG_IDS - 1);
+
+   sEntry ** volatile * ppPage = &mpPages[msgID >> ePAGE_BITS];
+   sEntry ** pPage = *ppPage;
+   if (pPage == 0)
+   {
+      sEntry ** pNewPage = new sEntry *[ePAGE_SZ];
+      memset( pNewPage, 0, sizeof( sEntry * ) * ePAGE_SZ );
+
+      pPage = __sync_val_compare_and_swap( ppPage, (sEntry **)0, pNewPage );
+      if (pPage == 0)
+      {
+         pPage = pNewPage;
+      }
+      else
+      {
+         delete [] pNewPage;
+      }
+   }
+
+   sEntry * volatile * ppEntry = &pPage[msgID & (ePAGE_SZ - 1)];
+   sEntry * pEntry = *ppEntry;
+   if (pEntry == 0)
+   {
+      sEntry * pNewEntry = new sEntry;
+      memset( &pNewEntry->mCounters[0], 0, sizeof( pNewEntry->mCounters ) );
+
+      pEntry = __sync_val_compare_and_swap( ppEntry, (sEntry *)0, pNewEntry );
+      if (pEntry == 0)
+      {
+         pEntry = pNewEntry;
+      }
+      else
+      {
+         delete pNewEntry;
+      }
+   }
+
+   return pEntry;
+}
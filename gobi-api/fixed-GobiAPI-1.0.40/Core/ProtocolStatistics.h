@@ -0,0 +1,235 @@
+/*===========================================================================
+FILE:
+   ProtocolStatistics.h
+
+DESCRIPTION:
+   Declaration of cLatencyHistogram and cProtocolStatistics classes
+
+PUBLIC CLASSES AND METHODS:
+   sLatencySummary
+      Percentiles of a latency histogram
+
+   sProtocolMessageStats
+      Counters and latency summaries of a single message ID
+
+   cLatencyHistogram
+      Log-linear (HDR style) histogram of microsecond latencies
+
+   cProtocolStatistics
+      Request counters and latency histograms of a protocol server,
+      keyed by message ID
+
+   NOTE:
+      Updates and reads are lock-free (atomic), so statistics can be 
+      read from any thread while the protocol server updates them
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Pragmas
+//---------------------------------------------------------------------------
+#pragma once
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "StdAfx.h"
+
+#include <string>
+#include <vector>
+
+//---------------------------------------------------------------------------
+// Definitions
+//---------------------------------------------------------------------------
+
+// Histogram buckets, each power of two is split into this many (halves
+// of the first sixteen values excepted) for a worst case error of 1/8
+const ULONG LATENCY_HISTOGRAM_SUB_BITS = 3;
+
+// Number of histogram buckets (covering over 2^40 microseconds)
+const ULONG LATENCY_HISTOGRAM_BUCKETS = 42 << LATENCY_HISTOGRAM_SUB_BITS;
+
+// Number of message IDs tracked (16-bit message IDs)
+const ULONG PROTOCOL_STATS_MSG_IDS = 0x10000;
+
+// Request counters
+enum eProtocolStatCounter
+{
+   ePROTOCOL_STAT_BEGIN = -1,
+
+   ePROTOCOL_STAT_SENT,       // Requests transmitted (all attempts)
+   ePROTOCOL_STAT_RSP,        // Responses received
+   ePROTOCOL_STAT_ERROR_RSP,  // Responses reporting an error
+   ePROTOCOL_STAT_TIMEOUT,    // Response timeouts
+   ePROTOCOL_STAT_RETRY,      // Retransmissions after a failed attempt
+   ePROTOCOL_STAT_ABORT,      // Requests removed before completing
+   ePROTOCOL_STAT_TX_ERROR,   // Transmission failures
+   ePROTOCOL_STAT_RETRANSMIT, // Early retransmissions (adaptive timeouts)
+
+   ePROTOCOL_STAT_END
+};
+
+// Latencies
+enum eProtocolStatLatency
+{
+   ePROTOCOL_LAT_BEGIN = -1,
+
+   ePROTOCOL_LAT_QUEUE,       // Time due in the schedule until sent
+   ePROTOCOL_LAT_RTT,         // Time sent until the response arrived
+   ePROTOCOL_LAT_TOTAL,       // Time first due until the response arrived
+                              // (retries included)
+
+   ePROTOCOL_LAT_END
+};
+
+/*=========================================================================*/
+// Struct sLatencySummary
+//    Percentiles of a latency histogram (microseconds)
+/*=========================================================================*/
+struct sLatencySummary
+{
+   public:
+      /* Number of samples */
+      ULONG mCount;
+
+      /* Percentiles and maximum */
+      ULONGLONG mP50;
+      ULONGLONG mP90;
+      ULONGLONG mP99;
+      ULONGLONG mMax;
+};
+
+/*=========================================================================*/
+// Struct sProtocolMessageStats
+//    Counters and latency summaries of a single message ID
+/*=========================================================================*/
+struct sProtocolMessageStats
+{
+   public:
+      /* Message ID */
+      ULONG mMessageID;
+
+      /* Counters (indexed by eProtocolStatCounter) */
+      ULONG mCounters[ePROTOCOL_STAT_END];
+
+      /* Latencies (indexed by eProtocolStatLatency) */
+      sLatencySummary mLatencies[ePROTOCOL_LAT_END];
+};
+
+/*=========================================================================*/
+// Class cLatencyHistogram
+//    Log-linear (HDR style) histogram of microsecond latencies
+/*=========================================================================*/
+class cLatencyHistogram
+{
+   public:
+      // Constructor
+      cLatencyHistogram();
+
+      // Add a sample
+      void Add( ULONGLONG us );
+
+      // Summarize the samples added so far
+      sLatencySummary Summarize() const;
+
+      // Return the bucket of the given value
+      static ULONG GetBucket( ULONGLONG us );
+
+      // Return the highest value of the given bucket
+      static ULONGLONG GetBucketValue( ULONG bucket );
+
+   protected:
+      /* Sample counts (updated atomically) */
+      ULONG mBuckets[LATENCY_HISTOGRAM_BUCKETS];
+
+      /* Largest sample (updated atomically) */
+      ULONGLONG mMax;
+};
+
+/*=========================================================================*/
+// Class cProtocolStatistics
+//    Request counters and latency histograms keyed by message ID, entries
+//    are allocated on first use and live as long as this object
+/*=========================================================================*/
+class cProtocolStatistics
+{
+   public:
+      // Constructor
+      cProtocolStatistics();
+
+      // Destructor
+      ~cProtocolStatistics();
+
+      // Increment a counter of the given message ID
+      void Count(
+         ULONG                      msgID,
+         eProtocolStatCounter       counter );
+
+      // Add a latency sample to the given message ID
+      void AddLatency(
+         ULONG                      msgID,
+         eProtocolStatLatency       latency,
+         ULONGLONG                  us );
+
+      // Return the statistics of every message ID seen, by message ID
+      std::vector <sProtocolMessageStats> GetStatistics() const;
+
+      // Format the statistics of one message ID as a line of text
+      static std::string Format( const sProtocolMessageStats & stats );
+
+   protected:
+      // Statistics of one message ID
+      struct sEntry
+      {
+         /* Counters (updated atomically) */
+         ULONG mCounters[ePROTOCOL_STAT_END];
+
+         /* Latency histograms */
+         cLatencyHistogram mLatencies[ePROTOCOL_LAT_END];
+      };
+
+      // Return the entry of the given message ID (allocated if needed)
+      sEntry * GetEntry( ULONG msgID );
+
+      // Entry pages (the high byte of the message ID selects the page)
+      enum
+      {
+         ePAGE_BITS = 8,
+         ePAGE_SZ = 1 << ePAGE_BITS,
+         ePAGES = PROTOCOL_STATS_MSG_IDS >> ePAGE_BITS
+      };
+
+      /* Pages of entry pointers (both published atomically) */
+      sEntry ** mpPages[ePAGES];
+
+   private:
+      // Not copyable
+      cProtocolStatistics( const cProtocolStatistics & );
+      cProtocolStatistics & operator = ( const cProtocolStatistics & );
+};
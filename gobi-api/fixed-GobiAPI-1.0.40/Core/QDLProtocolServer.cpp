@@ -42,6 +42,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "StdAfx.h"
 #include "QDLProtocolServer.h"
 #include "QDLEnum.h"
+#include "QDLBuffers.h"
 
 //---------------------------------------------------------------------------
 // Definitions
@@ -70,12 +71,12 @@ RETURN VALUE:
 cQDLProtocolServer::cQDLProtocolServer( 
    ULONG                      bufferSzRx,
    ULONG                      logSz )
-   :  cHDLCProtocolServer( ePROTOCOL_QDL_RX, 
-                           ePROTOCOL_QDL_TX,
-                           bufferSzRx, 
-                           logSz )
+   :  cHDLCProtocolServerT <cQDLProtocolServer>( ePROTOCOL_QDL_RX, 
+                                                 ePROTOCOL_QDL_TX,
+                                                 bufferSzRx, 
+                                                 logSz )
 {
-   // Nothing to do
+   SetLockName( "QDL" );
 }
 
 /*===========================================================================
@@ -145,7 +146,9 @@ METHOD:
    IsResponse (Internal Method)
 
 DESCRIPTION:
-   Is the passed in data a response to the current request?
+   Is the passed in data a response to the current request?  When no
+   request is active the in-flight requests are searched instead and the
+   ID of the matching request is stored in mInFlightRspID
 
 PARAMETERS:
    rsp         [ I ] - Candidate response
@@ -157,18 +160,97 @@ RETURN VALUE:
    bool
 ===========================================================================*/
 bool cQDLProtocolServer::IsResponse( const sProtocolBuffer & rsp )
+{
+   if (mpActiveRequest != 0)
+   {
+      return IsResponse( *mpActiveRequest, rsp );
+   }
+
+   if (rsp.IsValid() == false || rsp.GetSize() == 0)
+   {
+      return false;
+   }
+
+   const BYTE * pRspBuf = rsp.GetBuffer();
+   eQDLCommand rspCmd = (eQDLCommand)pRspBuf[0];
+
+   // Write responses carry the sequence number of the block
+   bool bWriteRsp = false;
+   WORD seqNum = 0;
+   if (rspCmd == eQDL_CMD_WRITE_UNFRAMED_RSP)
+   {
+      if (rsp.GetSize() < (ULONG)sizeof( sQDLRawWriteUnframedRsp ))
+      {
+         return false;
+      }
+
+      const sQDLRawWriteUnframedRsp * pRsp = 0;
+      pRsp = (const sQDLRawWriteUnframedRsp *)pRspBuf;
+
+      seqNum = pRsp->mSequenceNumber;
+      bWriteRsp = true;
+   }
+
+   // The in-flight window is small, a linear search (oldest request
+   // first, so errors are attributed to the oldest) is sufficient
+   for (ULONG r = 0; r < (ULONG)mInFlight.size(); r++)
+   {
+      const sProtocolReqRsp * pReqRsp = mInFlight[r];
+      if (IsResponse( *pReqRsp, rsp ) == false)
+      {
+         continue;
+      }
+
+      if (bWriteRsp == true)
+      {
+         const sQDLRawWriteUnframedReq * pReq = 0;
+         pReq = (const sQDLRawWriteUnframedReq *)
+                pReqRsp->mRequest.GetBuffer();
+
+         if (pReq->mSequenceNumber != seqNum)
+         {
+            continue;
+         }
+      }
+
+      mInFlightRspID = pReqRsp->mID;
+      return true;
+   }
+
+   return false;
+}
+
+/*===========================================================================
+METHOD:
+   IsResponse (Internal Method)
+
+DESCRIPTION:
+   Is the passed in data a response to the given request?
+
+PARAMETERS:
+   reqRsp      [ I ] - Request awaiting a response
+   rsp         [ I ] - Candidate response
+
+SEQUENCING:
+   None (must be called from protocol server thread)
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cQDLProtocolServer::IsResponse( 
+   const sProtocolReqRsp &    reqRsp,
+   const sProtocolBuffer &    rsp )
 {
    // Assume not
    bool bRC = false;
-   if ( (mpActiveRequest == 0) 
-   ||   (mpActiveRequest->mRequest.IsValid() == false)
-   ||   (mpActiveRequest->mbWaitingForResponse == false)
+   if ( (reqRsp.mRequest.IsValid() == false)
+   ||   (reqRsp.mbWaitingForResponse == false)
    ||   (rsp.IsValid() == false) )
    {
       return bRC;
    }
 
-   const BYTE * pReqBuf = mpActiveRequest->mRequest.GetBuffer();
+   const BYTE * pReqBuf = reqRsp.mRequest.GetBuffer();
    const BYTE * pRspBuf = rsp.GetBuffer();
 
    eQDLCommand reqCmd = (eQDLCommand)pReqBuf[0];
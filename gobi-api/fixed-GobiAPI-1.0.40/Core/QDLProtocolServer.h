@@ -52,8 +52,11 @@ POSSIBILITY OF SUCH DAMAGE.
 
 /*=========================================================================*/
 // Class cQDLProtocolServer
+//
+//    QDL responses are matched as they are decoded without going through
+//    virtual dispatch (see cHDLCProtocolServerT)
 /*=========================================================================*/
-class cQDLProtocolServer : public cHDLCProtocolServer
+class cQDLProtocolServer : public cHDLCProtocolServerT <cQDLProtocolServer>
 {
    public:
       // Constructor
@@ -72,6 +75,18 @@ class cQDLProtocolServer : public cHDLCProtocolServer
       // Is the passed in data a response to the current request?
       virtual bool IsResponse( const sProtocolBuffer & rsp );
 
+      // Is the passed in data a response to the given request?
+      bool IsResponse( 
+         const sProtocolReqRsp &    reqRsp,
+         const sProtocolBuffer &    rsp );
+
+      // (Inline) Write responses are matched to requests by sequence
+      // number, allowing several image block writes in flight
+      virtual bool SupportsInFlightWindow()
+      {
+         return true;
+      };
+
       // Is the passed in data a response that aborts the current request?
       virtual bool IsTxAbortResponse( const sProtocolBuffer & rsp );
 };
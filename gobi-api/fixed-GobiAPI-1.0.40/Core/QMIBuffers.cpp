@@ -112,17 +112,10 @@ bool sQMIServiceBuffer::GetResult(
       return false;
    }
 
-   std::map <ULONG, const sQMIRawContentHeader *>::const_iterator pIter;
-   pIter = mContents.find( QMI_TLV_ID_RESULT );
-   if (pIter == mContents.end())
-   {
-      return false;
-   }
-
-   const sQMIRawContentHeader * pContent = pIter->second;
+   const sQMIRawContentHeader * pContent = 0;
+   pContent = mContents.Find( QMI_TLV_ID_RESULT );
    if (pContent == 0)
    {
-      ASSERT( 0 );
       return false;
    }
 
@@ -139,6 +132,58 @@ bool sQMIServiceBuffer::GetResult(
    return true;
 }
 
+/*===========================================================================
+METHOD:
+   FormatHeader (Static Public Method)
+
+DESCRIPTION:
+   Format the headers of a QMI request/response/indication (the payload
+   follows the headers, i.e. starts at GetHeaderSize())
+  
+PARAMETERS:
+   pBuffer     [ O ] - Buffer to format (at least GetHeaderSize() bytes)
+   msgID       [ I ] - The QMI message ID
+   bResponse   [ I ] - Format a response?
+   bIndication [ I ] - Format an indication?
+   payloadLen  [ I ] - Size of payload following the headers
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void sQMIServiceBuffer::FormatHeader( 
+   PBYTE                      pBuffer,
+   WORD                       msgID,
+   bool                       bResponse,
+   bool                       bIndication,
+   ULONG                      payloadLen )
+{
+   // Format header
+   sQMIServiceRawTransactionHeader * pHdr = 0;
+   pHdr = (sQMIServiceRawTransactionHeader *)&pBuffer[0];
+   pHdr->mCompound      = 0;
+   pHdr->mResponse      = 0;
+   pHdr->mIndication    = 0;
+   pHdr->mReserved      = 0;
+   pHdr->mTransactionID = 1;
+   
+   if (bResponse == true)
+   {
+      pHdr->mResponse = 1;
+   }
+   else if (bIndication == true)
+   {
+      pHdr->mIndication = 1;
+   }
+
+   pHdr++;
+
+   // Format message header
+   sQMIRawMessageHeader * pMsg = 0;
+   pMsg = (sQMIRawMessageHeader *)pHdr;
+   pMsg->mMessageID = msgID;
+   pMsg->mLength    = (WORD)payloadLen;
+}
+
 /*===========================================================================
 METHOD:
    BuildBuffer (Static Public Method)
@@ -181,42 +226,24 @@ sSharedBuffer * sQMIServiceBuffer::BuildBuffer(
       payloadLen = 0;
    }
 
-   // Allocate buffer
-   PBYTE pBuffer = new BYTE[payloadLen + totalHdrSz];
-   if (pBuffer == 0)
-   {
-      return 0;
-   }
+   // Compute total size
+   ULONG sz = payloadLen + totalHdrSz;
 
-   // Format header
-   sQMIServiceRawTransactionHeader * pHdr = 0;
-   pHdr = (sQMIServiceRawTransactionHeader *)&pBuffer[0];
-   pHdr->mCompound      = 0;
-   pHdr->mResponse      = 0;
-   pHdr->mIndication    = 0;
-   pHdr->mReserved      = 0;
-   pHdr->mTransactionID = 1;
-   
-   bool bTX = true;
-   if (bResponse == true)
-   {
-      pHdr->mResponse = 1;
-      bTX = false;
-   }
-   else if (bIndication == true)
+   // Requests are the only transmitted messages
+   bool bTX = (bResponse == false && bIndication == false);
+
+   // Allocate the shared buffer (from the buffer pool)
+   eProtocolType pt = MapQMIServiceToProtocol( serviceType, bTX );
+   sSharedBuffer * pBuf = new sSharedBuffer( sz, pt );
+   if (pBuf == 0 || pBuf->IsValid() == false)
    {
-      pHdr->mIndication = 1;
-      bTX = false;
+      delete pBuf;
+      return 0;
    }
 
-   pHdr++;
+   PBYTE pBuffer = pBuf->GetWritableBuffer();
+   FormatHeader( pBuffer, msgID, bResponse, bIndication, payloadLen );
 
-   // Format message header
-   sQMIRawMessageHeader * pMsg = 0;
-   pMsg = (sQMIRawMessageHeader *)pHdr;
-   pMsg->mMessageID = msgID;
-   pMsg->mLength    = (WORD)payloadLen;
-   
    // Copy in payload?
    if (payloadLen > 0 && pPayload != 0)
    {
@@ -225,12 +252,6 @@ sSharedBuffer * sQMIServiceBuffer::BuildBuffer(
               (SIZE_T)payloadLen );
    }   
 
-   // Compute total size
-   ULONG sz = payloadLen + totalHdrSz;
-
-   // Build and return the shared buffer
-   eProtocolType pt = MapQMIServiceToProtocol( serviceType, bTX );
-   sSharedBuffer * pBuf = new sSharedBuffer( sz, pBuffer, pt );
    return pBuf;
 }
 
@@ -327,6 +348,7 @@ bool sQMIServiceBuffer::Validate()
    // Extract content TLV structures
    ULONG contentProcessed = 0;
    ULONG contentSz = (ULONG)pMsgHdr->mLength;
+   mContents.Reset( pBuffer );
    while (contentProcessed < contentSz)
    {
       const sQMIRawContentHeader * pContent = 0;
@@ -337,11 +359,11 @@ bool sQMIServiceBuffer::Validate()
       contentProcessed += tlvLen;
       if (contentProcessed <= contentSz)
       {
-         mContents[(ULONG)pContent->mTypeID] = pContent;
+         mContents.Add( pContent );
       }
       else
       {
-         mContents.clear();
+         mContents.Reset( 0 );
 
          mbValid = bRC;
          return bRC;
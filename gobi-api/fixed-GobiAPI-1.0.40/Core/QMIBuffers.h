@@ -12,6 +12,7 @@ PUBLIC CLASSES AND METHODS:
    sQMIRawMessageHeader
    sQMIRawContentHeader
 
+   sQMIContents
    sQMIServiceBuffer
 
 Copyright (c) 2011, Code Aurora Forum. All rights reserved.
@@ -52,6 +53,7 @@ POSSIBILITY OF SUCH DAMAGE.
 //---------------------------------------------------------------------------
 #include "ProtocolBuffer.h"
 #include "QMIEnum.h"
+#include "QMIServices.h"
 
 #include <map>
 #include <vector>
@@ -66,6 +68,9 @@ const ULONG QMI_MAX_BUFFER_SIZE = MAX_SHARED_BUFFER_SIZE;
 // Content ID for mandatory result TLV
 const ULONG QMI_TLV_ID_RESULT = 2;
 
+// Number of distinct content (TLV) type IDs
+const ULONG QMI_MAX_CONTENT_IDS = 256;
+
 /*===========================================================================
 METHOD:
    MapQMIServiceToProtocol (Inline Method)
@@ -79,74 +84,19 @@ PARAMETERS:
    bTransmission  [ I ] - IS this a transmission (TX vs. RX)?
 
 RETURN VALUE:
-   bool
+   eProtocolType (ePROTOCOL_ENUM_BEGIN for an unknown service)
 ===========================================================================*/
 inline eProtocolType MapQMIServiceToProtocol( 
    eQMIService                serviceType,
    bool                       bTransmission = true )
 {
-   eProtocolType pt = ePROTOCOL_ENUM_BEGIN;
-   switch (serviceType)
-   {
-      case eQMI_SVC_WDS:
-         pt = ePROTOCOL_QMI_WDS_RX;
-         break;
-
-      case eQMI_SVC_DMS:
-         pt = ePROTOCOL_QMI_DMS_RX;
-         break;
-
-      case eQMI_SVC_NAS:
-         pt = ePROTOCOL_QMI_NAS_RX;
-         break;
-
-      case eQMI_SVC_QOS:
-         pt = ePROTOCOL_QMI_QOS_RX;
-         break;
-
-      case eQMI_SVC_WMS:
-         pt = ePROTOCOL_QMI_WMS_RX;
-         break;
-
-      case eQMI_SVC_PDS:
-         pt = ePROTOCOL_QMI_PDS_RX;
-         break;
-
-      case eQMI_SVC_AUTH:
-         pt = ePROTOCOL_QMI_AUTH_RX;
-         break;
-
-      case eQMI_SVC_VOICE:
-         pt = ePROTOCOL_QMI_VOICE_RX;
-         break;
-
-      case eQMI_SVC_CAT:
-         pt = ePROTOCOL_QMI_CAT_RX;
-         break;
-
-      case eQMI_SVC_RMS:
-         pt = ePROTOCOL_QMI_RMS_RX;
-         break;
-
-      case eQMI_SVC_OMA:
-         pt = ePROTOCOL_QMI_OMA_RX;
-         break;
-
-      case eQMI_SVC_CONTROL:
-         pt = ePROTOCOL_QMI_CTL_RX;
-         break;
-
-   }
-
-   if (pt != ePROTOCOL_ENUM_BEGIN && bTransmission == true)
+   const sQMIServiceInfo * pInfo = FindQMIService( serviceType );
+   if (pInfo == 0)
    {
-      // This relies on the fact the the TX variant is always the next
-      // enumerated value after the RX variant (so don't do something
-      // to change that)
-      pt  = (eProtocolType)((ULONG)pt + 1);
+      return ePROTOCOL_ENUM_BEGIN;
    }
 
-   return pt;
+   return (bTransmission == true ? pInfo->mTxType : pInfo->mRxType);
 };
 
 //---------------------------------------------------------------------------
@@ -225,6 +175,99 @@ struct sQMIRawContentHeader
 #pragma pack( pop )
 
 
+/*=========================================================================*/
+// Struct sQMIContents
+//    Directory of the content TLVs of a QMI message, indexed by type ID
+//    (a later TLV with an already seen type ID replaces the earlier one).
+//    Presence is kept as a bitmap and each TLV as an offset from the
+//    start of the contents, so building and searching it never allocates
+/*=========================================================================*/
+struct sQMIContents
+{
+   public:
+      // (Inline) Constructor
+      sQMIContents()
+         :  mpContents( 0 ),
+            mCount( 0 )
+      {
+         memset( (LPVOID)&mPresent[0], 0, sizeof( mPresent ) );
+      };
+
+      // (Inline) Reset to an empty directory for the given contents
+      void Reset( const BYTE * pContents )
+      {
+         mpContents = pContents;
+         mCount = 0;
+         memset( (LPVOID)&mPresent[0], 0, sizeof( mPresent ) );
+      };
+
+      // (Inline) Add a TLV (which has to be within the contents)
+      void Add( const sQMIRawContentHeader * pContent )
+      {
+         ULONG id = (ULONG)pContent->mTypeID;
+         ULONGLONG bit = 1ULL << (id & 63);
+         if ((mPresent[id >> 6] & bit) == 0)
+         {
+            mPresent[id >> 6] |= bit;
+            mCount++;
+         }
+
+         mOffsets[id] = (WORD)((const BYTE *)pContent - mpContents);
+      };
+
+      // (Inline) Return the TLV with the given type ID (0 if not present)
+      const sQMIRawContentHeader * Find( ULONG typeID ) const
+      {
+         if ( (typeID >= QMI_MAX_CONTENT_IDS)
+         ||   ((mPresent[typeID >> 6] & (1ULL << (typeID & 63))) == 0) )
+         {
+            return 0;
+         }
+
+         return (const sQMIRawContentHeader *)(mpContents + mOffsets[typeID]);
+      };
+
+      // (Inline) Return the number of TLVs
+      ULONG GetCount() const
+      {
+         return mCount;
+      };
+
+      // (Inline) Return the lowest present type ID at or above the given
+      // one (QMI_MAX_CONTENT_IDS if there is none), so that TLVs can be
+      // walked in type ID order:
+      //    for (id = c.GetNextID( 0 ); id < QMI_MAX_CONTENT_IDS; 
+      //         id = c.GetNextID( id + 1 ))
+      ULONG GetNextID( ULONG typeID ) const
+      {
+         while (typeID < QMI_MAX_CONTENT_IDS)
+         {
+            ULONGLONG bits = mPresent[typeID >> 6] >> (typeID & 63);
+            if (bits != 0)
+            {
+               return typeID + (ULONG)__builtin_ctzll( bits );
+            }
+
+            typeID = (typeID | 63) + 1;
+         }
+
+         return QMI_MAX_CONTENT_IDS;
+      };
+
+   protected:
+      /* Start of the contents the offsets are relative to */
+      const BYTE * mpContents;
+
+      /* Number of TLVs present */
+      ULONG mCount;
+
+      /* Presence bitmap (by type ID) */
+      ULONGLONG mPresent[QMI_MAX_CONTENT_IDS / 64];
+
+      /* TLV offsets (by type ID, only valid when present) */
+      WORD mOffsets[QMI_MAX_CONTENT_IDS];
+};
+
 /*=========================================================================*/
 // Struct sQMIServiceBuffer
 //    Struct to represent a QMI service channel request/response/indication 
@@ -326,7 +369,7 @@ struct sQMIServiceBuffer : public sProtocolBuffer
       };
 
       // (Inline) Return content structures
-      std::map <ULONG, const sQMIRawContentHeader *> GetContents() const
+      const sQMIContents & GetContents() const
       {
          return mContents;
       };
@@ -336,6 +379,51 @@ struct sQMIServiceBuffer : public sProtocolBuffer
          ULONG &                    returnCode,
          ULONG &                    errorCode );
 
+      // (Inline) Return the message ID of a raw QMI indication without
+      // constructing (and hence validating) a sQMIServiceBuffer
+      static bool GetIndicationID( 
+         const sProtocolBuffer &    buf,
+         ULONG &                    msgID )
+      {
+         const ULONG szTransHdr = (ULONG)sizeof(sQMIServiceRawTransactionHeader);
+         const ULONG szMsgHdr   = (ULONG)sizeof(sQMIRawMessageHeader);
+
+         const BYTE * pBuffer = buf.GetBuffer();
+         if (pBuffer == 0 || buf.GetSize() < szTransHdr + szMsgHdr)
+         {
+            return false;
+         }
+
+         const sQMIServiceRawTransactionHeader * pHdr = 0;
+         pHdr = (const sQMIServiceRawTransactionHeader *)pBuffer;
+         if (pHdr->mIndication != 1)
+         {
+            return false;
+         }
+
+         const sQMIRawMessageHeader * pMsgHdr = 0;
+         pMsgHdr = (const sQMIRawMessageHeader *)(pBuffer + szTransHdr);
+
+         msgID = pMsgHdr->mMessageID;
+         return true;
+      };
+
+      // (Inline) Return the size of the headers preceding the payload of
+      // a QMI request/response/indication
+      static ULONG GetHeaderSize()
+      {
+         return (ULONG)( sizeof(sQMIServiceRawTransactionHeader)
+                       + sizeof(sQMIRawMessageHeader) );
+      };
+
+      // Format the headers of a QMI request/response/indication
+      static void FormatHeader( 
+         PBYTE                      pBuffer,
+         WORD                       msgID,
+         bool                       bResponse,
+         bool                       bIndication,
+         ULONG                      payloadLen );
+
       // Build a QMI request/response/indication
       static sSharedBuffer * BuildBuffer( 
          eQMIService                serviceType,
@@ -369,7 +457,7 @@ struct sQMIServiceBuffer : public sProtocolBuffer
       virtual bool Validate();
 
       /* Content TLV structures (indexed by type ID) */
-      std::map <ULONG, const sQMIRawContentHeader *> mContents;
+      sQMIContents mContents;
 
    private:
       // Prevent 'upcopying'
@@ -78,7 +78,7 @@ cQMIProtocolServer::cQMIProtocolServer(
       mMEID( "" )
 
 {
-   // Nothing to do
+   SetLockName( MapQMIServiceToName( serviceType ) );
 }
 
 /*===========================================================================
@@ -119,6 +119,39 @@ RETURN VALUE:
    bool
 ===========================================================================*/
 bool cQMIProtocolServer::Connect( LPCSTR pControlFile )
+{
+   if (pControlFile == 0)
+   {
+      return false;
+   }
+
+   return Connect( pControlFile, GetDeviceMEID( pControlFile ) );
+}
+
+/*===========================================================================
+METHOD:
+   Connect (Public Method)
+
+DESCRIPTION:
+   Connect to the configured QMI service using the given QMI
+   control file, storing a device MEID that the caller has already
+   read (saving one device open and ioctl per service)
+
+PARAMETERS:
+   pControlFile   [ I ] - QMI control file
+   meid           [ I ] - Device MEID
+
+SEQUENCING:
+   This method is sequenced according to the command event, i.e. any
+   other thread that needs to send a command to the protocol server 
+   thread will block until this method completes
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cQMIProtocolServer::Connect( 
+   LPCSTR                     pControlFile,
+   const std::string &        meid )
 {
    // Assume failure
    bool bRC = false;
@@ -128,7 +161,7 @@ bool cQMIProtocolServer::Connect( LPCSTR pControlFile )
    }
 
    // Store the MEID
-   mMEID = GetDeviceMEID( pControlFile );
+   mMEID = meid;
 
    // Pass service file to base class for actual connection
    bRC = cProtocolServer::Connect( pControlFile );
@@ -143,7 +176,7 @@ bool cQMIProtocolServer::Connect( LPCSTR pControlFile )
 
 /*===========================================================================
 METHOD:
-   GetDeviceMEID (Internal Method)
+   GetDeviceMEID (Static Public Method)
 
 DESCRIPTION:
    Get device MEID by interfacing to the given QMI control file
@@ -152,7 +185,7 @@ PARAMETERS:
    deviceNode   [ I ] - QMI device node
 
 SEQUENCING:
-   None (must be called from protocol server thread)
+   None
 
 RETURN VALUE:
    std::string (empty upon failure)
@@ -182,6 +215,7 @@ std::string cQMIProtocolServer::GetDeviceMEID( std::string deviceNode )
    retStr = &devMEID[0];
    
    close( devHandle );
+   return retStr;
 }
 
 /*===========================================================================
@@ -210,6 +244,73 @@ bool cQMIProtocolServer::ValidateRequest( const sProtocolRequest & req )
    return qmiReq.IsValid();
 }
 
+/*===========================================================================
+METHOD:
+   GetStatisticsKey (Internal Method)
+
+DESCRIPTION:
+   Return the statistics key (QMI message ID) of a request, read straight
+   from the raw request rather than by parsing it again
+
+PARAMETERS:
+   req         [ I ] - Request (already validated)
+
+RETURN VALUE:
+   ULONG
+===========================================================================*/
+ULONG cQMIProtocolServer::GetStatisticsKey( const sProtocolRequest & req )
+{
+   const ULONG szTransHdr = (ULONG)sizeof(sQMIServiceRawTransactionHeader);
+   const ULONG szMsgHdr = (ULONG)sizeof(sQMIRawMessageHeader);
+
+   const BYTE * pData = req.GetBuffer();
+   if (pData == 0 || req.GetSize() < szTransHdr + szMsgHdr)
+   {
+      return 0;
+   }
+
+   const sQMIRawMessageHeader * pMsgHdr = 0;
+   pMsgHdr = (const sQMIRawMessageHeader *)(pData + szTransHdr);
+   return (ULONG)pMsgHdr->mMessageID;
+}
+
+/*===========================================================================
+METHOD:
+   GetRequestPriority (Internal Method)
+
+DESCRIPTION:
+   Return the scheduling priority of a request, control service requests
+   and starting/stopping (or aborting) a data session always take 
+   precedence, otherwise the priority the request was given applies
+
+PARAMETERS:
+   req         [ I ] - Request (already validated)
+
+RETURN VALUE:
+   eProtocolPriority
+===========================================================================*/
+eProtocolPriority cQMIProtocolServer::GetRequestPriority( 
+   const sProtocolRequest &   req )
+{
+   if (mService == eQMI_SVC_CONTROL)
+   {
+      return ePROTOCOL_PRIORITY_CONTROL;
+   }
+
+   if (mService == eQMI_SVC_WDS)
+   {
+      ULONG msgID = GetStatisticsKey( req );
+      if ( (msgID == (ULONG)eQMI_WDS_START_NET)
+      ||   (msgID == (ULONG)eQMI_WDS_STOP_NET)
+      ||   (msgID == (ULONG)eQMI_WDS_ABORT) )
+      {
+         return ePROTOCOL_PRIORITY_CONTROL;
+      }
+   }
+
+   return req.GetPriority();
+}
+
 /*===========================================================================
 METHOD:
    InitializeComm (Internal Method)
@@ -268,7 +369,7 @@ DESCRIPTION:
 
 PARAMETERS:
    bytesReceived  [ I ] - Number of bytes to decoded
-   rspIdx         [ O ] - Log index of last valid response (not used)
+   rspIdx         [ O ] - Log index of last valid response
    bAbortTx       [ O ] - Response aborts current transmission? (not used)
 
 SEQUENCING:
@@ -301,25 +402,81 @@ bool cQMIProtocolServer::DecodeRxData(
       return bRC;
    }
 
-   sSharedBuffer * pTmp = 0;
-   pTmp = new sSharedBuffer( mpRxBuffer, bytesReceived, pt );
-   if (pTmp != 0)
+   const ULONG szTransHdr = (ULONG)sizeof(sQMIServiceRawTransactionHeader);
+   const ULONG szHdrs = szTransHdr + (ULONG)sizeof(sQMIRawMessageHeader);
+
+   // Error state of the response returned (responses to in-flight 
+   // requests are completed as they are decoded)
+   bool bErrorRsp = false;
+
+   ULONG offset = 0;
+   while (offset < bytesReceived)
    {
-      sQMIServiceBuffer tmpBuf( pTmp );
-      if (tmpBuf.IsValid() == true)
+      // One read may carry several messages back to back, each one is
+      // as long as its message header says (a short message is left to
+      // fail validation)
+      ULONG msgLen = bytesReceived - offset;
+      if (msgLen >= szHdrs)
       {
-         rspIdx = mLog.AddBuffer( tmpBuf );
-         if (IsResponse( tmpBuf ) == true)
-         {
-            bRC = true;
-         }
-         else
+         const sQMIRawMessageHeader * pMsgHdr = 0;
+         pMsgHdr = (const sQMIRawMessageHeader *)&mpRxBuffer[offset + szTransHdr];
+
+         ULONG len = szHdrs + (ULONG)pMsgHdr->mLength;
+         if (len < msgLen)
          {
-            rspIdx = INVALID_LOG_INDEX;
+            msgLen = len;
          }
       }
+
+      const BYTE * pMsg = &mpRxBuffer[offset];
+      offset += msgLen;
+
+      sSharedBuffer * pTmp = 0;
+      pTmp = new sSharedBuffer( pMsg, msgLen, pt );
+      if (pTmp == 0)
+      {
+         continue;
+      }
+
+      sQMIServiceBuffer tmpBuf( pTmp );
+      if (tmpBuf.IsValid() == false)
+      {
+         continue;
+      }
+
+      ULONG tmpIdx = mLog.AddBuffer( tmpBuf );
+
+      // (Bound at compile time, this is called for every message)
+      mInFlightRspID = INVALID_REQUEST_ID;
+      if (cQMIProtocolServer::IsResponse( tmpBuf ) == false)
+      {
+         continue;
+      }
+
+      // Note failed responses for the request statistics
+      bool bErr = false;
+      ULONG rc = 0;
+      ULONG ec = 0;
+      if (tmpBuf.GetResult( rc, ec ) == true && rc != 0)
+      {
+         bErr = true;
+      }
+
+      if (mInFlightRspID != INVALID_REQUEST_ID)
+      {
+         mbErrorRsp = bErr;
+         CompleteInFlightRequest( mInFlightRspID, tmpIdx );
+         mInFlightRspID = INVALID_REQUEST_ID;
+      }
+      else
+      {
+         rspIdx = tmpIdx;
+         bErrorRsp = bErr;
+         bRC = true;
+      }
    }
 
+   mbErrorRsp = bErrorRsp;
    return bRC;
 }
 
@@ -363,7 +520,9 @@ METHOD:
    IsResponse (Internal Method)
 
 DESCRIPTION:
-   Is the passed in data a response to the current request?
+   Is the passed in data a response to the current request?  When no
+   request is active the in-flight requests are searched instead and the
+   ID of the matching request is stored in mInFlightRspID
 
 PARAMETERS:
    rsp         [ I ] - Candidate response
@@ -375,18 +534,57 @@ RETURN VALUE:
    bool
 ===========================================================================*/
 bool cQMIProtocolServer::IsResponse( const sProtocolBuffer & rsp )
+{
+   if (mpActiveRequest != 0)
+   {
+      return IsResponse( *mpActiveRequest, rsp );
+   }
+
+   // The in-flight window is small, a linear search is sufficient
+   for (ULONG r = 0; r < (ULONG)mInFlight.size(); r++)
+   {
+      const sProtocolReqRsp * pReqRsp = mInFlight[r];
+      if (IsResponse( *pReqRsp, rsp ) == true)
+      {
+         mInFlightRspID = pReqRsp->mID;
+         return true;
+      }
+   }
+
+   return false;
+}
+
+/*===========================================================================
+METHOD:
+   IsResponse (Internal Method)
+
+DESCRIPTION:
+   Is the passed in data a response to the given request?
+
+PARAMETERS:
+   reqRsp      [ I ] - Request awaiting a response
+   rsp         [ I ] - Candidate response
+
+SEQUENCING:
+   None (must be called from protocol server thread)
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cQMIProtocolServer::IsResponse( 
+   const sProtocolReqRsp &    reqRsp,
+   const sProtocolBuffer &    rsp )
 {
    // Assume not
    bool bRC = false;
-   if ( (mpActiveRequest == 0) 
-   ||   (mpActiveRequest->mRequest.IsValid() == false)
-   ||   (mpActiveRequest->mbWaitingForResponse == false)
+   if ( (reqRsp.mRequest.IsValid() == false)
+   ||   (reqRsp.mbWaitingForResponse == false)
    ||   (rsp.IsValid() == false) )
    {
       return bRC;
    }
 
-   sQMIServiceBuffer qmiReq( mpActiveRequest->mRequest.GetSharedBuffer() );
+   sQMIServiceBuffer qmiReq( reqRsp.mRequest.GetSharedBuffer() );
    sQMIServiceBuffer qmiRsp( rsp.GetSharedBuffer() );
 
    if (qmiReq.IsValid() == false || qmiRsp.IsValid() == false)
@@ -70,6 +70,12 @@ class cQMIProtocolServer : public cProtocolServer
       // control file
       bool Connect( LPCSTR pControlFile );
 
+      // Connect to the given QMI service using the configured QMI
+      // control file and an already read device MEID
+      bool Connect( 
+         LPCSTR                     pControlFile,
+         const std::string &        meid );
+
       // (Inline) Return the device MEID
       std::string GetMEID()
       {
@@ -89,6 +95,13 @@ class cQMIProtocolServer : public cProtocolServer
       // Validate a request that is about to be scheduled
       virtual bool ValidateRequest( const sProtocolRequest & req );
 
+      // Return the statistics key (QMI message ID) of a request
+      virtual ULONG GetStatisticsKey( const sProtocolRequest & req );
+
+      // Return the scheduling priority of a request
+      virtual eProtocolPriority GetRequestPriority( 
+         const sProtocolRequest &   req );
+
       // Perform protocol specific communications port initialization
       virtual bool InitializeComm();
 
@@ -109,6 +122,17 @@ class cQMIProtocolServer : public cProtocolServer
       // Is the passed in data a response to the current request?
       virtual bool IsResponse( const sProtocolBuffer & rsp );
 
+      // Is the passed in data a response to the given request?
+      bool IsResponse( 
+         const sProtocolReqRsp &    reqRsp,
+         const sProtocolBuffer &    rsp );
+
+      // (Inline) Responses are matched to requests by transaction ID
+      virtual bool SupportsInFlightWindow()
+      {
+         return true;
+      };
+
       // (Inline) Is the passed in data a response that aborts the 
       // current request?
       virtual bool IsTxAbortResponse( const sProtocolBuffer & /* rsp */ )
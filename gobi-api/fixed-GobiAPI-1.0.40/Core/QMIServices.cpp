@@ -0,0 +1,173 @@
+/*===========================================================================
+FILE:
+   QMIServices.cpp
+
+DESCRIPTION:
+   QMI service metadata table
+   
+PUBLIC CLASSES AND METHODS:
+   gQMIServices
+   gQMIServiceRows
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "StdAfx.h"
+#include "QMIServices.h"
+#include "QMIBuffers.h"
+
+//---------------------------------------------------------------------------
+// Definitions
+//---------------------------------------------------------------------------
+
+// Shorthand for a service type that is not described
+#define N QMI_SERVICE_ROW_NONE
+
+/*=========================================================================*/
+// QMI service table
+//
+//    NOTE: Rows must stay in eProtocolType (and eDB2EntityType) order, 
+//    FindQMIServiceByProtocol() and FindQMIServiceByEntity() index it
+/*=========================================================================*/
+const sQMIServiceInfo gQMIServices[QMI_SERVICE_COUNT] =
+{
+   { eQMI_SVC_CONTROL,
+     ePROTOCOL_QMI_CTL_RX,
+     ePROTOCOL_QMI_CTL_TX,
+     eDB2_ET_QMI_CTL_REQ,
+     QMI_MAX_BUFFER_SIZE,
+     "CTL" },
+
+   { eQMI_SVC_WDS,
+     ePROTOCOL_QMI_WDS_RX,
+     ePROTOCOL_QMI_WDS_TX,
+     eDB2_ET_QMI_WDS_REQ,
+     QMI_MAX_BUFFER_SIZE,
+     "WDS" },
+
+   { eQMI_SVC_DMS,
+     ePROTOCOL_QMI_DMS_RX,
+     ePROTOCOL_QMI_DMS_TX,
+     eDB2_ET_QMI_DMS_REQ,
+     QMI_MAX_BUFFER_SIZE,
+     "DMS" },
+
+   { eQMI_SVC_NAS,
+     ePROTOCOL_QMI_NAS_RX,
+     ePROTOCOL_QMI_NAS_TX,
+     eDB2_ET_QMI_NAS_REQ,
+     QMI_MAX_BUFFER_SIZE,
+     "NAS" },
+
+   { eQMI_SVC_QOS,
+     ePROTOCOL_QMI_QOS_RX,
+     ePROTOCOL_QMI_QOS_TX,
+     eDB2_ET_QMI_QOS_REQ,
+     QMI_MAX_BUFFER_SIZE,
+     "QOS" },
+
+   { eQMI_SVC_WMS,
+     ePROTOCOL_QMI_WMS_RX,
+     ePROTOCOL_QMI_WMS_TX,
+     eDB2_ET_QMI_WMS_REQ,
+     QMI_MAX_BUFFER_SIZE,
+     "WMS" },
+
+   { eQMI_SVC_PDS,
+     ePROTOCOL_QMI_PDS_RX,
+     ePROTOCOL_QMI_PDS_TX,
+     eDB2_ET_QMI_PDS_REQ,
+     QMI_MAX_BUFFER_SIZE,
+     "PDS" },
+
+   { eQMI_SVC_AUTH,
+     ePROTOCOL_QMI_AUTH_RX,
+     ePROTOCOL_QMI_AUTH_TX,
+     eDB2_ET_QMI_AUTH_REQ,
+     QMI_MAX_BUFFER_SIZE,
+     "AUTH" },
+
+   { eQMI_SVC_CAT,
+     ePROTOCOL_QMI_CAT_RX,
+     ePROTOCOL_QMI_CAT_TX,
+     eDB2_ET_QMI_CAT_REQ,
+     QMI_MAX_BUFFER_SIZE,
+     "CAT" },
+
+   { eQMI_SVC_RMS,
+     ePROTOCOL_QMI_RMS_RX,
+     ePROTOCOL_QMI_RMS_TX,
+     eDB2_ET_QMI_RMS_REQ,
+     QMI_MAX_BUFFER_SIZE,
+     "RMS" },
+
+   { eQMI_SVC_OMA,
+     ePROTOCOL_QMI_OMA_RX,
+     ePROTOCOL_QMI_OMA_TX,
+     eDB2_ET_QMI_OMA_REQ,
+     QMI_MAX_BUFFER_SIZE,
+     "OMA" },
+
+   { eQMI_SVC_VOICE,
+     ePROTOCOL_QMI_VOICE_RX,
+     ePROTOCOL_QMI_VOICE_TX,
+     eDB2_ET_QMI_VOICE_REQ,
+     QMI_MAX_BUFFER_SIZE,
+     "VOICE" }
+};
+
+/*=========================================================================*/
+// QMI service type to gQMIServices row
+/*=========================================================================*/
+const BYTE gQMIServiceRows[256] =
+{
+   // 0x00 - 0x0F (CTL, WDS, DMS, NAS, QOS, WMS, PDS, AUTH, VOICE)
+   0, 1, 2, 3, 4, 5, 6, 7, N, 11, N, N, N, N, N, N,
+   N, N, N, N, N, N, N, N, N, N, N, N, N, N, N, N,
+   N, N, N, N, N, N, N, N, N, N, N, N, N, N, N, N,
+   N, N, N, N, N, N, N, N, N, N, N, N, N, N, N, N,
+   N, N, N, N, N, N, N, N, N, N, N, N, N, N, N, N,
+   N, N, N, N, N, N, N, N, N, N, N, N, N, N, N, N,
+   N, N, N, N, N, N, N, N, N, N, N, N, N, N, N, N,
+   N, N, N, N, N, N, N, N, N, N, N, N, N, N, N, N,
+   N, N, N, N, N, N, N, N, N, N, N, N, N, N, N, N,
+   N, N, N, N, N, N, N, N, N, N, N, N, N, N, N, N,
+   N, N, N, N, N, N, N, N, N, N, N, N, N, N, N, N,
+   N, N, N, N, N, N, N, N, N, N, N, N, N, N, N, N,
+   N, N, N, N, N, N, N, N, N, N, N, N, N, N, N, N,
+   N, N, N, N, N, N, N, N, N, N, N, N, N, N, N, N,
+
+   // 0xE0 - 0xEF (CAT, RMS, OMA)
+   8, 9, 10, N, N, N, N, N, N, N, N, N, N, N, N, N,
+   N, N, N, N, N, N, N, N, N, N, N, N, N, N, N, N
+};
+
+#undef N
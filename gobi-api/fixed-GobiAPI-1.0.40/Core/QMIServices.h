@@ -0,0 +1,195 @@
+/*===========================================================================
+FILE:
+   QMIServices.h
+
+DESCRIPTION:
+   QMI service metadata table and the lookups built on it
+
+PUBLIC ENUMERATIONS AND METHODS:
+   sQMIServiceInfo
+
+   FindQMIService
+   FindQMIServiceByProtocol
+   FindQMIServiceByEntity
+   MapQMIServiceToName
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Pragmas
+//---------------------------------------------------------------------------
+#pragma once
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "CoreDatabase.h"
+#include "ProtocolEnum.h"
+#include "QMIEnum.h"
+
+//---------------------------------------------------------------------------
+// Definitions
+//---------------------------------------------------------------------------
+
+// Number of QMI services described by gQMIServices
+const ULONG QMI_SERVICE_COUNT = 12;
+
+// gQMIServiceRows value for a service type that is not described
+const BYTE QMI_SERVICE_ROW_NONE = 0xFF;
+
+/*=========================================================================*/
+// Struct sQMIServiceInfo
+//    Everything that is specific to one QMI service (one row of 
+//    gQMIServices)
+/*=========================================================================*/
+struct sQMIServiceInfo
+{
+   public:
+      /* QMI service type */
+      eQMIService mService;
+
+      /* Protocol type of incoming (response/indication) buffers */
+      eProtocolType mRxType;
+
+      /* Protocol type of outgoing (request) buffers */
+      eProtocolType mTxType;
+
+      /* DB protocol entity type of requests (the response and indication 
+         entity types are the next two enumerated values) */
+      eDB2EntityType mRequestType;
+
+      /* Maximum size of a payload buffer */
+      ULONG mMaxBufferSize;
+
+      /* Short name (e.g. "WDS") */
+      LPCSTR mpName;
+};
+
+// Service table, rows are in eProtocolType (and eDB2EntityType) order so
+// protocol and entity types index it directly
+extern const sQMIServiceInfo gQMIServices[QMI_SERVICE_COUNT];
+
+// Row of gQMIServices, indexed by service type
+extern const BYTE gQMIServiceRows[256];
+
+/*===========================================================================
+METHOD:
+   FindQMIService (Inline Method)
+
+DESCRIPTION:
+   Return the service table row for a QMI service type
+
+PARAMETERS:
+   serviceType [ I ] - QMI service type
+
+RETURN VALUE:
+   const sQMIServiceInfo * (0 if the service is not described)
+===========================================================================*/
+inline const sQMIServiceInfo * FindQMIService( eQMIService serviceType )
+{
+   ULONG svc = (ULONG)serviceType;
+   if (svc >= 256 || gQMIServiceRows[svc] == QMI_SERVICE_ROW_NONE)
+   {
+      return 0;
+   }
+
+   return &gQMIServices[gQMIServiceRows[svc]];
+};
+
+/*===========================================================================
+METHOD:
+   FindQMIServiceByProtocol (Inline Method)
+
+DESCRIPTION:
+   Return the service table row for a QMI protocol type (RX or TX)
+
+PARAMETERS:
+   pt          [ I ] - Protocol type
+
+RETURN VALUE:
+   const sQMIServiceInfo * (0 if not a QMI protocol)
+===========================================================================*/
+inline const sQMIServiceInfo * FindQMIServiceByProtocol( eProtocolType pt )
+{
+   if (IsQMIProtocol( pt ) == false)
+   {
+      return 0;
+   }
+
+   // Each service has an RX and then a TX protocol type
+   return &gQMIServices[((ULONG)pt - (ULONG)ePROTOCOL_QMI_CTL_RX) / 2];
+};
+
+/*===========================================================================
+METHOD:
+   FindQMIServiceByEntity (Inline Method)
+
+DESCRIPTION:
+   Return the service table row for a QMI DB protocol entity type
+
+PARAMETERS:
+   et          [ I ] - Protocol entity type
+
+RETURN VALUE:
+   const sQMIServiceInfo * (0 if not a QMI entity type)
+===========================================================================*/
+inline const sQMIServiceInfo * FindQMIServiceByEntity( eDB2EntityType et )
+{
+   if (et <= eDB2_ET_QMI_BEGIN || et >= eDB2_ET_QMI_END)
+   {
+      return 0;
+   }
+
+   // Each service has a request, response, and indication entity type
+   return &gQMIServices[((ULONG)et - (ULONG)eDB2_ET_QMI_CTL_REQ) / 3];
+};
+
+/*===========================================================================
+METHOD:
+   MapQMIServiceToName (Inline Method)
+
+DESCRIPTION:
+   Return the short name of a QMI service
+
+PARAMETERS:
+   serviceType [ I ] - QMI service type
+
+RETURN VALUE:
+   LPCSTR ("QMI" if the service is not described)
+===========================================================================*/
+inline LPCSTR MapQMIServiceToName( eQMIService serviceType )
+{
+   const sQMIServiceInfo * pInfo = FindQMIService( serviceType );
+   if (pInfo == 0)
+   {
+      return "QMI";
+   }
+
+   return pInfo->mpName;
+};
@@ -0,0 +1,841 @@
+/*===========================================================================
+FILE:
+   QMIView.h
+
+DESCRIPTION:
+   Support classes for the generated (static) QMI message views
+
+PUBLIC CLASSES AND METHODS:
+   sQMIView
+      Bounded view of raw QMI data (a TLV value or part of one)
+
+   sQMIInt
+   sQMIFloat
+   sQMIString
+   sQMIFixedString
+      Field types of the generated views, each type provides a compile
+      time FIXED_SIZE (0 when variable), Measure() and Read()
+
+   cQMIArrayView
+      Bounded view of a (size prefixed or fixed count) QMI array
+
+   cQMIMessageView
+      Base of the generated message views, indexes the TLVs of a QMI
+      response/indication in a single pass
+
+   cQMIMessageWriter
+      Base of the generated request writers, encodes TLVs directly into
+      a caller supplied buffer
+
+   NOTE:
+      The message views are generated by build-aux/qmi-codegen (see the
+      QMIViews*.h headers) and are an alternative to parsing through the
+      QMI database for frequently decoded messages.  A view never copies
+      the underlying data, so the buffer must outlive the view
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Pragmas
+//---------------------------------------------------------------------------
+#pragma once
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "QMIBuffers.h"
+
+#include <string>
+
+/*=========================================================================*/
+// Struct sQMIView
+/*=========================================================================*/
+struct sQMIView
+{
+   public:
+      // (Inline) Default constructor (results in invalid object)
+      sQMIView()
+         :  mpData( 0 ),
+            mSize( 0 )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Parameter constructor
+      sQMIView(
+         const BYTE *               pData,
+         ULONG                      sz )
+         :  mpData( pData ),
+            mSize( sz )
+      {
+         if (mpData == 0)
+         {
+            mSize = 0;
+         }
+      };
+
+      // (Inline) Is this object valid?
+      bool IsValid() const
+      {
+         return (mpData != 0);
+      };
+
+      // (Inline) Does the view hold the given number of bytes at offset?
+      bool Has(
+         ULONG                      offset,
+         ULONG                      sz ) const
+      {
+         return (mpData != 0 && offset <= mSize && sz <= mSize - offset);
+      };
+
+      // (Inline) Return the view of sz bytes at offset (invalid if the
+      // bytes are not all within this view)
+      sQMIView Sub(
+         ULONG                      offset,
+         ULONG                      sz ) const
+      {
+         sQMIView sub;
+         if (Has( offset, sz ) == true)
+         {
+            sub = sQMIView( mpData + offset, sz );
+         }
+
+         return sub;
+      };
+
+      // (Inline) Return the data viewed as a string
+      std::string ToString() const
+      {
+         std::string str;
+         if (mpData != 0)
+         {
+            str.assign( (LPCSTR)mpData, (std::string::size_type)mSize );
+         }
+
+         return str;
+      };
+
+      // (Inline) Return the viewed data
+      const BYTE * GetData() const
+      {
+         return mpData;
+      };
+
+      // (Inline) Return the size of the viewed data
+      ULONG GetSize() const
+      {
+         return mSize;
+      };
+
+   protected:
+      /* Viewed data */
+      const BYTE * mpData;
+
+      /* Size of above data */
+      ULONG mSize;
+};
+
+/*=========================================================================*/
+// Struct sQMIInt
+//
+//    Integer field of SZ bytes (little endian unless bBigEndian), read as
+//    type T (which must be at least SZ bytes, note LONG/ULONG may be wider
+//    than the 4 byte QMI field they are read from)
+/*=========================================================================*/
+template <typename T, ULONG SZ, bool bBigEndian = false>
+struct sQMIInt
+{
+   public:
+      // Compile time size of the field
+      enum { FIXED_SIZE = SZ };
+
+      // Type of value read
+      typedef T tValue;
+
+      // (Inline) Measure the field at the given offset
+      static bool Measure(
+         const sQMIView &           in,
+         ULONG                      offset,
+         ULONG &                    sz )
+      {
+         sz = SZ;
+         return in.Has( offset, SZ );
+      };
+
+      // (Inline) Read the field at the given offset
+      static bool Read(
+         const sQMIView &           in,
+         ULONG                      offset,
+         T &                        value )
+      {
+         if (in.Has( offset, SZ ) == false)
+         {
+            return false;
+         }
+
+         const BYTE * pData = in.GetData() + offset;
+
+         ULONGLONG val = 0;
+         for (ULONG b = 0; b < SZ; b++)
+         {
+            ULONG idx = (bBigEndian == true ? b : SZ - 1 - b);
+            val = (val << 8) | (ULONGLONG)pData[idx];
+         }
+
+         // Sign extend values of signed types wider than the field
+         bool bSigned = ((T)-1 < (T)0);
+         if (bSigned == true && SZ < sizeof( ULONGLONG ))
+         {
+            ULONGLONG signBit = 1ULL << (SZ > 0 && SZ < 8 ? SZ * 8 - 1 : 0);
+            if ((val & signBit) != 0)
+            {
+               val |= ~((signBit << 1) - 1);
+            }
+         }
+
+         value = (T)val;
+         return true;
+      };
+
+      // (Inline) Write a value (buffer must hold SZ bytes)
+      static void Write(
+         BYTE *                     pData,
+         T                          value )
+      {
+         ULONGLONG val = (ULONGLONG)value;
+         for (ULONG b = 0; b < SZ; b++)
+         {
+            ULONG idx = (bBigEndian == true ? SZ - 1 - b : b);
+            pData[idx] = (BYTE)(val & 0xFF);
+            val >>= 8;
+         }
+      };
+};
+
+/*=========================================================================*/
+// Struct sQMIFloat
+//
+//    IEEE 754 (little endian) floating point field of type T (FLOAT or
+//    DOUBLE)
+/*=========================================================================*/
+template <typename T>
+struct sQMIFloat
+{
+   public:
+      // Compile time size of the field
+      enum { FIXED_SIZE = sizeof( T ) };
+
+      // Type of value read
+      typedef T tValue;
+
+      // (Inline) Measure the field at the given offset
+      static bool Measure(
+         const sQMIView &           in,
+         ULONG                      offset,
+         ULONG &                    sz )
+      {
+         sz = (ULONG)sizeof( T );
+         return in.Has( offset, sz );
+      };
+
+      // (Inline) Read the field at the given offset
+      static bool Read(
+         const sQMIView &           in,
+         ULONG                      offset,
+         T &                        value )
+      {
+         if (in.Has( offset, (ULONG)sizeof( T ) ) == false)
+         {
+            return false;
+         }
+
+         memcpy( (LPVOID)&value,
+                 (LPCVOID)(in.GetData() + offset),
+                 sizeof( T ) );
+
+         return true;
+      };
+
+      // (Inline) Write a value (buffer must hold sizeof( T ) bytes)
+      static void Write(
+         BYTE *                     pData,
+         T                          value )
+      {
+         memcpy( (LPVOID)pData, (LPCVOID)&value, sizeof( T ) );
+      };
+};
+
+/*=========================================================================*/
+// Struct sQMIString
+//
+//    String field with a PREFIX byte length prefix, a PREFIX of 0 means
+//    the string fills the remainder of the view (only used for strings
+//    that are a whole TLV value)
+/*=========================================================================*/
+template <ULONG PREFIX>
+struct sQMIString
+{
+   public:
+      // Compile time size of the field
+      enum { FIXED_SIZE = 0 };
+
+      // Type of value read
+      typedef sQMIView tValue;
+
+      // (Inline) Measure the field at the given offset
+      static bool Measure(
+         const sQMIView &           in,
+         ULONG                      offset,
+         ULONG &                    sz )
+      {
+         sz = 0;
+         if (in.Has( offset, PREFIX ) == false)
+         {
+            return false;
+         }
+
+         if (PREFIX == 0)
+         {
+            sz = in.GetSize() - offset;
+            return true;
+         }
+
+         ULONG len = 0;
+         sQMIInt <ULONG, PREFIX>::Read( in, offset, len );
+
+         sz = PREFIX + len;
+         return in.Has( offset + PREFIX, len );
+      };
+
+      // (Inline) Read the field at the given offset (the string itself,
+      // without the length prefix)
+      static bool Read(
+         const sQMIView &           in,
+         ULONG                      offset,
+         sQMIView &                 value )
+      {
+         ULONG sz = 0;
+         if (Measure( in, offset, sz ) == false)
+         {
+            return false;
+         }
+
+         value = in.Sub( offset + PREFIX, sz - PREFIX );
+         return true;
+      };
+};
+
+/*=========================================================================*/
+// Struct sQMIFixedString
+//
+//    String field of exactly SZ bytes
+/*=========================================================================*/
+template <ULONG SZ>
+struct sQMIFixedString
+{
+   public:
+      // Compile time size of the field
+      enum { FIXED_SIZE = SZ };
+
+      // Type of value read
+      typedef sQMIView tValue;
+
+      // (Inline) Measure the field at the given offset
+      static bool Measure(
+         const sQMIView &           in,
+         ULONG                      offset,
+         ULONG &                    sz )
+      {
+         sz = SZ;
+         return in.Has( offset, SZ );
+      };
+
+      // (Inline) Read the field at the given offset
+      static bool Read(
+         const sQMIView &           in,
+         ULONG                      offset,
+         sQMIView &                 value )
+      {
+         if (in.Has( offset, SZ ) == false)
+         {
+            return false;
+         }
+
+         value = in.Sub( offset, SZ );
+         return true;
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIArrayView
+//
+//    Bounded view of an array of tElement, prefixed by a PREFIX byte
+//    element count or (when PREFIX is 0) of exactly COUNT elements.
+//    Elements of fixed size are accessed in constant time, otherwise
+//    through the (forward only) iterator
+/*=========================================================================*/
+template <class tElement, ULONG PREFIX, ULONG COUNT = 0>
+class cQMIArrayView
+{
+   public:
+      // Compile time size of the array (when known)
+      enum { FIXED_SIZE = (PREFIX == 0 ? COUNT * tElement::FIXED_SIZE : 0) };
+
+      // Type of value read
+      typedef cQMIArrayView <tElement, PREFIX, COUNT> tValue;
+
+      // Type of element value
+      typedef typename tElement::tValue tElementValue;
+
+      // (Inline) Default constructor (results in invalid object)
+      cQMIArrayView()
+         :  mElements(),
+            mCount( 0 )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Measure the array at the given offset
+      static bool Measure(
+         const sQMIView &           in,
+         ULONG                      offset,
+         ULONG &                    sz )
+      {
+         sz = 0;
+         if (in.Has( offset, PREFIX ) == false)
+         {
+            return false;
+         }
+
+         ULONG count = COUNT;
+         if (PREFIX != 0)
+         {
+            ReadCount( in, offset, count );
+         }
+
+         ULONG elemOffset = offset + PREFIX;
+         ULONG elemSz = (ULONG)tElement::FIXED_SIZE;
+         if (elemSz != 0)
+         {
+            // Guard against overflow of the total size
+            ULONG avail = in.GetSize() - elemOffset;
+            if (count > avail / elemSz)
+            {
+               return false;
+            }
+
+            sz = PREFIX + count * elemSz;
+            return true;
+         }
+
+         for (ULONG e = 0; e < count; e++)
+         {
+            if (tElement::Measure( in, elemOffset, elemSz ) == false)
+            {
+               return false;
+            }
+
+            elemOffset += elemSz;
+         }
+
+         sz = elemOffset - offset;
+         return true;
+      };
+
+      // (Inline) Read the array at the given offset
+      static bool Read(
+         const sQMIView &           in,
+         ULONG                      offset,
+         tValue &                   value )
+      {
+         ULONG sz = 0;
+         if (Measure( in, offset, sz ) == false)
+         {
+            return false;
+         }
+
+         ULONG count = COUNT;
+         if (PREFIX != 0)
+         {
+            ReadCount( in, offset, count );
+         }
+
+         value.mCount = count;
+         value.mElements = in.Sub( offset + PREFIX, sz - PREFIX );
+         return true;
+      };
+
+      // (Inline) Is this object valid?
+      bool IsValid() const
+      {
+         return mElements.IsValid();
+      };
+
+      // (Inline) Return the number of elements
+      ULONG GetCount() const
+      {
+         return mCount;
+      };
+
+      // (Inline) Return the view of the element data (not including the
+      // prefix), i.e. the raw contents of an array of bytes
+      const sQMIView & GetElements() const
+      {
+         return mElements;
+      };
+
+      // (Inline) Return the element at the given index (constant time
+      // for fixed size elements, linear otherwise)
+      bool GetElement(
+         ULONG                      idx,
+         tElementValue &            value ) const
+      {
+         if (idx >= mCount)
+         {
+            return false;
+         }
+
+         if (tElement::FIXED_SIZE != 0)
+         {
+            ULONG offset = idx * (ULONG)tElement::FIXED_SIZE;
+            return tElement::Read( mElements, offset, value );
+         }
+
+         cIterator iter( *this );
+         for (ULONG e = 0; e <= idx; e++)
+         {
+            if (iter.Next( value ) == false)
+            {
+               return false;
+            }
+         }
+
+         return true;
+      };
+
+      /*====================================================================*/
+      // Class cIterator
+      //    Bounded forward iterator over the array elements
+      /*====================================================================*/
+      class cIterator
+      {
+         public:
+            // (Inline) Constructor
+            cIterator( const cQMIArrayView & array )
+               :  mArray( array ),
+                  mIndex( 0 ),
+                  mOffset( 0 )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Read the next element, false when exhausted
+            bool Next( tElementValue & value )
+            {
+               if (mIndex >= mArray.mCount)
+               {
+                  return false;
+               }
+
+               ULONG sz = 0;
+               if (tElement::Measure( mArray.mElements, mOffset, sz ) == false
+               ||  tElement::Read( mArray.mElements, mOffset, value ) == false)
+               {
+                  // Stop here for good
+                  mIndex = mArray.mCount;
+                  return false;
+               }
+
+               mOffset += sz;
+               mIndex++;
+               return true;
+            };
+
+            // (Inline) Return the index of the next element
+            ULONG GetIndex() const
+            {
+               return mIndex;
+            };
+
+         protected:
+            /* Array being iterated */
+            const cQMIArrayView & mArray;
+
+            /* Index/offset of the next element */
+            ULONG mIndex;
+            ULONG mOffset;
+      };
+
+   protected:
+      // (Inline) Read the element count prefix
+      static bool ReadCount(
+         const sQMIView &           in,
+         ULONG                      offset,
+         ULONG &                    count )
+      {
+         return sQMIInt <ULONG, (PREFIX == 0 ? 1 : PREFIX)>::Read( in,
+                                                                   offset,
+                                                                   count );
+      };
+
+      /* Element data (not including the prefix) */
+      sQMIView mElements;
+
+      /* Number of elements */
+      ULONG mCount;
+
+      // Iterators get full access
+      friend class cIterator;
+};
+
+/*=========================================================================*/
+// Class cQMIMessageView
+//
+//    Base of a generated message view tMessage, having TLVS known TLVs.
+//    The TLVs are indexed once at construction, tMessage::GetSlot() maps
+//    a TLV type ID to its slot (-1 for unknown TLVs, which are skipped)
+/*=========================================================================*/
+template <class tMessage, ULONG TLVS>
+class cQMIMessageView
+{
+   public:
+      // (Inline) Constructor (from the TLVs of a QMI message)
+      cQMIMessageView(
+         const BYTE *               pTLVs,
+         ULONG                      sz )
+         :  mbValid( false )
+      {
+         Index( pTLVs, sz );
+      };
+
+      // (Inline) Constructor (from a QMI service response/indication)
+      cQMIMessageView( const sProtocolBuffer & buf )
+         :  mbValid( false )
+      {
+         const ULONG szTransHdr = (ULONG)sizeof(sQMIServiceRawTransactionHeader);
+         const ULONG szMsgHdr   = (ULONG)sizeof(sQMIRawMessageHeader);
+         const ULONG szHdrs     = szTransHdr + szMsgHdr;
+
+         const BYTE * pBuffer = buf.GetBuffer();
+         if (pBuffer == 0 || buf.GetSize() < szHdrs)
+         {
+            return;
+         }
+
+         const sQMIRawMessageHeader * pMsgHdr = 0;
+         pMsgHdr = (const sQMIRawMessageHeader *)(pBuffer + szTransHdr);
+         if (pMsgHdr->mMessageID != (WORD)tMessage::MESSAGE_ID
+         ||  (ULONG)pMsgHdr->mLength > buf.GetSize() - szHdrs)
+         {
+            return;
+         }
+
+         Index( pBuffer + szHdrs, (ULONG)pMsgHdr->mLength );
+      };
+
+      // (Inline) Was the TLV stream well formed?
+      bool IsValid() const
+      {
+         return mbValid;
+      };
+
+      // (Inline) Return the (raw) value of the TLV in the given slot
+      const sQMIView & GetTLV( ULONG slot ) const
+      {
+         static const sQMIView invalid;
+         if (slot >= TLVS)
+         {
+            return invalid;
+         }
+
+         return mTLVs[slot];
+      };
+
+   protected:
+      // (Inline) Index the TLVs
+      void Index(
+         const BYTE *               pTLVs,
+         ULONG                      sz )
+      {
+         const ULONG szTLVHdr = (ULONG)sizeof(sQMIRawContentHeader);
+         if (pTLVs == 0)
+         {
+            return;
+         }
+
+         while (sz >= szTLVHdr)
+         {
+            BYTE typeID = pTLVs[0];
+            ULONG len = (ULONG)pTLVs[1] | ((ULONG)pTLVs[2] << 8);
+            if (len > sz - szTLVHdr)
+            {
+               // Truncated TLV
+               return;
+            }
+
+            // The first instance of a TLV wins
+            int slot = tMessage::GetSlot( typeID );
+            if (slot >= 0 && mTLVs[slot].IsValid() == false)
+            {
+               mTLVs[slot] = sQMIView( pTLVs + szTLVHdr, len );
+            }
+
+            pTLVs += szTLVHdr + len;
+            sz -= szTLVHdr + len;
+         }
+
+         mbValid = (sz == 0);
+      };
+
+      /* Was the TLV stream well formed? */
+      bool mbValid;
+
+      /* TLV values (by slot) */
+      sQMIView mTLVs[TLVS];
+};
+
+/*=========================================================================*/
+// Class cQMIMessageWriter
+//
+//    Base of a generated request writer, TLVs are appended to a caller
+//    supplied buffer (any TLV preceding an overflow is kept)
+/*=========================================================================*/
+class cQMIMessageWriter
+{
+   public:
+      // (Inline) Constructor
+      cQMIMessageWriter(
+         BYTE *                     pBuffer,
+         ULONG                      sz )
+         :  mpBuffer( pBuffer ),
+            mSize( sz ),
+            mUsed( 0 ),
+            mbOverflow( false )
+      {
+         if (mpBuffer == 0)
+         {
+            mSize = 0;
+         }
+      };
+
+      // (Inline) Append a TLV of the given length, returning where to
+      // write the value (0 on overflow)
+      BYTE * AddTLV(
+         BYTE                       typeID,
+         ULONG                      len )
+      {
+         const ULONG szTLVHdr = (ULONG)sizeof(sQMIRawContentHeader);
+         if (len > 0xFFFF || len + szTLVHdr > mSize - mUsed)
+         {
+            mbOverflow = true;
+            return 0;
+         }
+
+         BYTE * pTLV = mpBuffer + mUsed;
+         pTLV[0] = typeID;
+         sQMIInt <WORD, 2>::Write( pTLV + 1, (WORD)len );
+
+         mUsed += szTLVHdr + len;
+         return pTLV + szTLVHdr;
+      };
+
+      // (Inline) Append a TLV with the given value
+      bool AddTLV(
+         BYTE                       typeID,
+         const BYTE *               pValue,
+         ULONG                      len )
+      {
+         if (pValue == 0 && len != 0)
+         {
+            return false;
+         }
+
+         BYTE * pData = AddTLV( typeID, len );
+         if (pData == 0)
+         {
+            return false;
+         }
+
+         if (len > 0)
+         {
+            memcpy( (LPVOID)pData, (LPCVOID)pValue, (SIZE_T)len );
+         }
+
+         return true;
+      };
+
+      // (Inline) Did every TLV fit?
+      bool IsValid() const
+      {
+         return (mpBuffer != 0 && mbOverflow == false);
+      };
+
+      // (Inline) Return the encoded TLVs
+      const BYTE * GetBuffer() const
+      {
+         return mpBuffer;
+      };
+
+      // (Inline) Return the size of the encoded TLVs
+      ULONG GetSize() const
+      {
+         return mUsed;
+      };
+
+      // (Inline) Build the QMI request from the encoded TLVs
+      sSharedBuffer * BuildRequest(
+         eQMIService                serviceType,
+         WORD                       msgID ) const
+      {
+         if (IsValid() == false)
+         {
+            return 0;
+         }
+
+         return sQMIServiceBuffer::BuildBuffer( serviceType,
+                                                msgID,
+                                                false,
+                                                false,
+                                                mpBuffer,
+                                                mUsed );
+      };
+
+   protected:
+      /* Buffer being written */
+      BYTE * mpBuffer;
+
+      /* Size of above buffer */
+      ULONG mSize;
+
+      /* Number of bytes written */
+      ULONG mUsed;
+
+      /* Did a TLV not fit? */
+      bool mbOverflow;
+};
@@ -0,0 +1,1123 @@
+/*===========================================================================
+FILE:
+   QMIViewsDMS.h
+
+DESCRIPTION:
+   Static views of the (collected) QMI DMS messages
+
+PUBLIC CLASSES AND METHODS:
+   cQMIWriterDMSGetOperatingModeReq
+   cQMIViewDMSGetOperatingModeRsp
+   cQMIWriterDMSGetTimeReq
+   cQMIViewDMSGetTimeRsp
+   cQMIWriterDMSGetPRLVersionReq
+   cQMIViewDMSGetPRLVersionRsp
+   cQMIWriterDMSGetActivationStateReq
+   cQMIViewDMSGetActivationStateRsp
+   cQMIWriterDMSGetUserLockStateReq
+   cQMIViewDMSGetUserLockStateRsp
+
+   NOTE:
+      Generated by build-aux/qmi-codegen from qmi-service-dms.json, do not
+      edit.  To regenerate run (from the top of the source tree):
+
+         build-aux/qmi-codegen/qmi-codegen --cxx-views \
+            --input data/qmi-service-dms.json \
+            --include data/qmi-common.json \
+            --collection data/qmi-collection-gobi-views.json \
+            --output <Core directory>/QMIViewsDMS
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Pragmas
+//---------------------------------------------------------------------------
+#pragma once
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "QMIView.h"
+
+/*=========================================================================*/
+// Class cQMIWriterDMSGetOperatingModeReq
+//    Writer of the DMS Get Operating Mode request
+/*=========================================================================*/
+class cQMIWriterDMSGetOperatingModeReq : public cQMIMessageWriter
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x002D };
+
+      // (Inline) Constructor
+      cQMIWriterDMSGetOperatingModeReq(
+         BYTE *                     pBuffer,
+         ULONG                      sz )
+         :  cQMIMessageWriter( pBuffer, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Build the QMI request from the encoded TLVs
+      sSharedBuffer * BuildRequest() const
+      {
+         return cQMIMessageWriter::BuildRequest( eQMI_SVC_DMS,
+                                                (WORD)MESSAGE_ID );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIViewDMSGetOperatingModeRsp
+//    View of the DMS Get Operating Mode response
+/*=========================================================================*/
+class cQMIViewDMSGetOperatingModeRsp : public cQMIMessageView <cQMIViewDMSGetOperatingModeRsp, 4>
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x002D };
+
+      // TLV type IDs
+      enum
+      {
+         TLV_RESULT = 0x02,
+         TLV_MODE = 0x01,
+         TLV_OFFLINE_REASON = 0x10,
+         TLV_HARDWARE_RESTRICTED_MODE = 0x11
+      };
+
+      /*=================================================================*/
+      // Struct sResult (Result)
+      /*=================================================================*/
+      struct sResult
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 4 };
+            enum
+            {
+               OFFSET_ERROR_STATUS = 0,
+               OFFSET_ERROR_CODE = 2
+            };
+
+            // Type of value read
+            typedef sResult tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sResult()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sResult( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Error Status
+            bool GetErrorStatus( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_STATUS,
+                                               value );
+            };
+
+            // (Inline) Return Error Code
+            bool GetErrorCode( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_CODE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // (Inline) Constructor (from the TLVs of the message)
+      cQMIViewDMSGetOperatingModeRsp(
+         const BYTE *               pTLVs,
+         ULONG                      sz )
+         :  cQMIMessageView <cQMIViewDMSGetOperatingModeRsp, 4>( pTLVs, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Constructor (from a QMI service response)
+      cQMIViewDMSGetOperatingModeRsp( const sProtocolBuffer & buf )
+         :  cQMIMessageView <cQMIViewDMSGetOperatingModeRsp, 4>( buf )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Map a TLV type ID to its slot (-1 if unknown)
+      static int GetSlot( BYTE typeID )
+      {
+         switch (typeID)
+         {
+            case TLV_RESULT:
+               return 0;
+            case TLV_MODE:
+               return 1;
+            case TLV_OFFLINE_REASON:
+               return 2;
+            case TLV_HARDWARE_RESTRICTED_MODE:
+               return 3;
+         }
+
+         return -1;
+      };
+
+      // (Inline) Return Result
+      bool GetResult( sResult & value ) const
+      {
+         return sResult::Read( mTLVs[0], 0, value );
+      };
+
+      // (Inline) Return contents of mandatory result content
+      bool GetResult(
+         ULONG &                    returnCode,
+         ULONG &                    errorCode ) const
+      {
+         sResult result;
+         WORD rc = 0;
+         WORD ec = 0;
+         if ( (GetResult( result ) == false)
+         ||   (result.GetErrorStatus( rc ) == false)
+         ||   (result.GetErrorCode( ec ) == false) )
+         {
+            return false;
+         }
+
+         returnCode = (ULONG)rc;
+         errorCode = (ULONG)ec;
+         return true;
+      };
+
+      // (Inline) Return Mode
+      bool GetMode( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[1], 0, value );
+      };
+
+      // (Inline) Return Offline Reason
+      bool GetOfflineReason( WORD & value ) const
+      {
+         return sQMIInt <WORD, 2>::Read( mTLVs[2], 0, value );
+      };
+
+      // (Inline) Return Hardware Restricted Mode
+      bool GetHardwareRestrictedMode( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[3], 0, value );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIWriterDMSGetTimeReq
+//    Writer of the DMS Get Time request
+/*=========================================================================*/
+class cQMIWriterDMSGetTimeReq : public cQMIMessageWriter
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x002F };
+
+      // (Inline) Constructor
+      cQMIWriterDMSGetTimeReq(
+         BYTE *                     pBuffer,
+         ULONG                      sz )
+         :  cQMIMessageWriter( pBuffer, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Build the QMI request from the encoded TLVs
+      sSharedBuffer * BuildRequest() const
+      {
+         return cQMIMessageWriter::BuildRequest( eQMI_SVC_DMS,
+                                                (WORD)MESSAGE_ID );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIViewDMSGetTimeRsp
+//    View of the DMS Get Time response
+/*=========================================================================*/
+class cQMIViewDMSGetTimeRsp : public cQMIMessageView <cQMIViewDMSGetTimeRsp, 4>
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x002F };
+
+      // TLV type IDs
+      enum
+      {
+         TLV_RESULT = 0x02,
+         TLV_DEVICE_TIME = 0x01,
+         TLV_SYSTEM_TIME = 0x10,
+         TLV_USER_TIME = 0x11
+      };
+
+      /*=================================================================*/
+      // Struct sResult (Result)
+      /*=================================================================*/
+      struct sResult
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 4 };
+            enum
+            {
+               OFFSET_ERROR_STATUS = 0,
+               OFFSET_ERROR_CODE = 2
+            };
+
+            // Type of value read
+            typedef sResult tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sResult()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sResult( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Error Status
+            bool GetErrorStatus( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_STATUS,
+                                               value );
+            };
+
+            // (Inline) Return Error Code
+            bool GetErrorCode( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_CODE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sDeviceTime (Device Time)
+      /*=================================================================*/
+      struct sDeviceTime
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 8 };
+            enum
+            {
+               OFFSET_TIME_COUNT = 0,
+               OFFSET_TIME_SOURCE = 6
+            };
+
+            // Type of value read
+            typedef sDeviceTime tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sDeviceTime()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sDeviceTime( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Time Count
+            bool GetTimeCount( ULONGLONG & value ) const
+            {
+               return sQMIInt <ULONGLONG, 6>::Read( mView,
+                                                    OFFSET_TIME_COUNT,
+                                                    value );
+            };
+
+            // (Inline) Return Time Source
+            bool GetTimeSource( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_TIME_SOURCE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // (Inline) Constructor (from the TLVs of the message)
+      cQMIViewDMSGetTimeRsp(
+         const BYTE *               pTLVs,
+         ULONG                      sz )
+         :  cQMIMessageView <cQMIViewDMSGetTimeRsp, 4>( pTLVs, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Constructor (from a QMI service response)
+      cQMIViewDMSGetTimeRsp( const sProtocolBuffer & buf )
+         :  cQMIMessageView <cQMIViewDMSGetTimeRsp, 4>( buf )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Map a TLV type ID to its slot (-1 if unknown)
+      static int GetSlot( BYTE typeID )
+      {
+         switch (typeID)
+         {
+            case TLV_RESULT:
+               return 0;
+            case TLV_DEVICE_TIME:
+               return 1;
+            case TLV_SYSTEM_TIME:
+               return 2;
+            case TLV_USER_TIME:
+               return 3;
+         }
+
+         return -1;
+      };
+
+      // (Inline) Return Result
+      bool GetResult( sResult & value ) const
+      {
+         return sResult::Read( mTLVs[0], 0, value );
+      };
+
+      // (Inline) Return contents of mandatory result content
+      bool GetResult(
+         ULONG &                    returnCode,
+         ULONG &                    errorCode ) const
+      {
+         sResult result;
+         WORD rc = 0;
+         WORD ec = 0;
+         if ( (GetResult( result ) == false)
+         ||   (result.GetErrorStatus( rc ) == false)
+         ||   (result.GetErrorCode( ec ) == false) )
+         {
+            return false;
+         }
+
+         returnCode = (ULONG)rc;
+         errorCode = (ULONG)ec;
+         return true;
+      };
+
+      // (Inline) Return Device Time
+      bool GetDeviceTime( sDeviceTime & value ) const
+      {
+         return sDeviceTime::Read( mTLVs[1], 0, value );
+      };
+
+      // (Inline) Return System Time
+      bool GetSystemTime( ULONGLONG & value ) const
+      {
+         return sQMIInt <ULONGLONG, 8>::Read( mTLVs[2], 0, value );
+      };
+
+      // (Inline) Return User Time
+      bool GetUserTime( ULONGLONG & value ) const
+      {
+         return sQMIInt <ULONGLONG, 8>::Read( mTLVs[3], 0, value );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIWriterDMSGetPRLVersionReq
+//    Writer of the DMS Get PRL Version request
+/*=========================================================================*/
+class cQMIWriterDMSGetPRLVersionReq : public cQMIMessageWriter
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0030 };
+
+      // (Inline) Constructor
+      cQMIWriterDMSGetPRLVersionReq(
+         BYTE *                     pBuffer,
+         ULONG                      sz )
+         :  cQMIMessageWriter( pBuffer, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Build the QMI request from the encoded TLVs
+      sSharedBuffer * BuildRequest() const
+      {
+         return cQMIMessageWriter::BuildRequest( eQMI_SVC_DMS,
+                                                (WORD)MESSAGE_ID );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIViewDMSGetPRLVersionRsp
+//    View of the DMS Get PRL Version response
+/*=========================================================================*/
+class cQMIViewDMSGetPRLVersionRsp : public cQMIMessageView <cQMIViewDMSGetPRLVersionRsp, 3>
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0030 };
+
+      // TLV type IDs
+      enum
+      {
+         TLV_RESULT = 0x02,
+         TLV_VERSION = 0x01,
+         TLV_PRL_ONLY_PREFERENCE = 0x10
+      };
+
+      /*=================================================================*/
+      // Struct sResult (Result)
+      /*=================================================================*/
+      struct sResult
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 4 };
+            enum
+            {
+               OFFSET_ERROR_STATUS = 0,
+               OFFSET_ERROR_CODE = 2
+            };
+
+            // Type of value read
+            typedef sResult tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sResult()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sResult( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Error Status
+            bool GetErrorStatus( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_STATUS,
+                                               value );
+            };
+
+            // (Inline) Return Error Code
+            bool GetErrorCode( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_CODE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // (Inline) Constructor (from the TLVs of the message)
+      cQMIViewDMSGetPRLVersionRsp(
+         const BYTE *               pTLVs,
+         ULONG                      sz )
+         :  cQMIMessageView <cQMIViewDMSGetPRLVersionRsp, 3>( pTLVs, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Constructor (from a QMI service response)
+      cQMIViewDMSGetPRLVersionRsp( const sProtocolBuffer & buf )
+         :  cQMIMessageView <cQMIViewDMSGetPRLVersionRsp, 3>( buf )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Map a TLV type ID to its slot (-1 if unknown)
+      static int GetSlot( BYTE typeID )
+      {
+         switch (typeID)
+         {
+            case TLV_RESULT:
+               return 0;
+            case TLV_VERSION:
+               return 1;
+            case TLV_PRL_ONLY_PREFERENCE:
+               return 2;
+         }
+
+         return -1;
+      };
+
+      // (Inline) Return Result
+      bool GetResult( sResult & value ) const
+      {
+         return sResult::Read( mTLVs[0], 0, value );
+      };
+
+      // (Inline) Return contents of mandatory result content
+      bool GetResult(
+         ULONG &                    returnCode,
+         ULONG &                    errorCode ) const
+      {
+         sResult result;
+         WORD rc = 0;
+         WORD ec = 0;
+         if ( (GetResult( result ) == false)
+         ||   (result.GetErrorStatus( rc ) == false)
+         ||   (result.GetErrorCode( ec ) == false) )
+         {
+            return false;
+         }
+
+         returnCode = (ULONG)rc;
+         errorCode = (ULONG)ec;
+         return true;
+      };
+
+      // (Inline) Return Version
+      bool GetVersion( WORD & value ) const
+      {
+         return sQMIInt <WORD, 2>::Read( mTLVs[1], 0, value );
+      };
+
+      // (Inline) Return PRL Only Preference
+      bool GetPRLOnlyPreference( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[2], 0, value );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIWriterDMSGetActivationStateReq
+//    Writer of the DMS Get Activation State request
+/*=========================================================================*/
+class cQMIWriterDMSGetActivationStateReq : public cQMIMessageWriter
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0031 };
+
+      // (Inline) Constructor
+      cQMIWriterDMSGetActivationStateReq(
+         BYTE *                     pBuffer,
+         ULONG                      sz )
+         :  cQMIMessageWriter( pBuffer, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Build the QMI request from the encoded TLVs
+      sSharedBuffer * BuildRequest() const
+      {
+         return cQMIMessageWriter::BuildRequest( eQMI_SVC_DMS,
+                                                (WORD)MESSAGE_ID );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIViewDMSGetActivationStateRsp
+//    View of the DMS Get Activation State response
+/*=========================================================================*/
+class cQMIViewDMSGetActivationStateRsp : public cQMIMessageView <cQMIViewDMSGetActivationStateRsp, 2>
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0031 };
+
+      // TLV type IDs
+      enum
+      {
+         TLV_RESULT = 0x02,
+         TLV_INFO = 0x01
+      };
+
+      /*=================================================================*/
+      // Struct sResult (Result)
+      /*=================================================================*/
+      struct sResult
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 4 };
+            enum
+            {
+               OFFSET_ERROR_STATUS = 0,
+               OFFSET_ERROR_CODE = 2
+            };
+
+            // Type of value read
+            typedef sResult tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sResult()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sResult( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Error Status
+            bool GetErrorStatus( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_STATUS,
+                                               value );
+            };
+
+            // (Inline) Return Error Code
+            bool GetErrorCode( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_CODE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // (Inline) Constructor (from the TLVs of the message)
+      cQMIViewDMSGetActivationStateRsp(
+         const BYTE *               pTLVs,
+         ULONG                      sz )
+         :  cQMIMessageView <cQMIViewDMSGetActivationStateRsp, 2>( pTLVs, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Constructor (from a QMI service response)
+      cQMIViewDMSGetActivationStateRsp( const sProtocolBuffer & buf )
+         :  cQMIMessageView <cQMIViewDMSGetActivationStateRsp, 2>( buf )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Map a TLV type ID to its slot (-1 if unknown)
+      static int GetSlot( BYTE typeID )
+      {
+         switch (typeID)
+         {
+            case TLV_RESULT:
+               return 0;
+            case TLV_INFO:
+               return 1;
+         }
+
+         return -1;
+      };
+
+      // (Inline) Return Result
+      bool GetResult( sResult & value ) const
+      {
+         return sResult::Read( mTLVs[0], 0, value );
+      };
+
+      // (Inline) Return contents of mandatory result content
+      bool GetResult(
+         ULONG &                    returnCode,
+         ULONG &                    errorCode ) const
+      {
+         sResult result;
+         WORD rc = 0;
+         WORD ec = 0;
+         if ( (GetResult( result ) == false)
+         ||   (result.GetErrorStatus( rc ) == false)
+         ||   (result.GetErrorCode( ec ) == false) )
+         {
+            return false;
+         }
+
+         returnCode = (ULONG)rc;
+         errorCode = (ULONG)ec;
+         return true;
+      };
+
+      // (Inline) Return Info
+      bool GetInfo( WORD & value ) const
+      {
+         return sQMIInt <WORD, 2>::Read( mTLVs[1], 0, value );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIWriterDMSGetUserLockStateReq
+//    Writer of the DMS Get User Lock State request
+/*=========================================================================*/
+class cQMIWriterDMSGetUserLockStateReq : public cQMIMessageWriter
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0034 };
+
+      // (Inline) Constructor
+      cQMIWriterDMSGetUserLockStateReq(
+         BYTE *                     pBuffer,
+         ULONG                      sz )
+         :  cQMIMessageWriter( pBuffer, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Build the QMI request from the encoded TLVs
+      sSharedBuffer * BuildRequest() const
+      {
+         return cQMIMessageWriter::BuildRequest( eQMI_SVC_DMS,
+                                                (WORD)MESSAGE_ID );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIViewDMSGetUserLockStateRsp
+//    View of the DMS Get User Lock State response
+/*=========================================================================*/
+class cQMIViewDMSGetUserLockStateRsp : public cQMIMessageView <cQMIViewDMSGetUserLockStateRsp, 2>
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0034 };
+
+      // TLV type IDs
+      enum
+      {
+         TLV_RESULT = 0x02,
+         TLV_ENABLED = 0x01
+      };
+
+      /*=================================================================*/
+      // Struct sResult (Result)
+      /*=================================================================*/
+      struct sResult
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 4 };
+            enum
+            {
+               OFFSET_ERROR_STATUS = 0,
+               OFFSET_ERROR_CODE = 2
+            };
+
+            // Type of value read
+            typedef sResult tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sResult()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sResult( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Error Status
+            bool GetErrorStatus( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_STATUS,
+                                               value );
+            };
+
+            // (Inline) Return Error Code
+            bool GetErrorCode( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_CODE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // (Inline) Constructor (from the TLVs of the message)
+      cQMIViewDMSGetUserLockStateRsp(
+         const BYTE *               pTLVs,
+         ULONG                      sz )
+         :  cQMIMessageView <cQMIViewDMSGetUserLockStateRsp, 2>( pTLVs, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Constructor (from a QMI service response)
+      cQMIViewDMSGetUserLockStateRsp( const sProtocolBuffer & buf )
+         :  cQMIMessageView <cQMIViewDMSGetUserLockStateRsp, 2>( buf )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Map a TLV type ID to its slot (-1 if unknown)
+      static int GetSlot( BYTE typeID )
+      {
+         switch (typeID)
+         {
+            case TLV_RESULT:
+               return 0;
+            case TLV_ENABLED:
+               return 1;
+         }
+
+         return -1;
+      };
+
+      // (Inline) Return Result
+      bool GetResult( sResult & value ) const
+      {
+         return sResult::Read( mTLVs[0], 0, value );
+      };
+
+      // (Inline) Return contents of mandatory result content
+      bool GetResult(
+         ULONG &                    returnCode,
+         ULONG &                    errorCode ) const
+      {
+         sResult result;
+         WORD rc = 0;
+         WORD ec = 0;
+         if ( (GetResult( result ) == false)
+         ||   (result.GetErrorStatus( rc ) == false)
+         ||   (result.GetErrorCode( ec ) == false) )
+         {
+            return false;
+         }
+
+         returnCode = (ULONG)rc;
+         errorCode = (ULONG)ec;
+         return true;
+      };
+
+      // (Inline) Return Enabled
+      bool GetEnabled( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[1], 0, value );
+      };
+};
@@ -0,0 +1,6193 @@
+/*===========================================================================
+FILE:
+   QMIViewsNAS.h
+
+DESCRIPTION:
+   Static views of the (collected) QMI NAS messages
+
+PUBLIC CLASSES AND METHODS:
+   cQMIViewNASEventReportInd
+   cQMIWriterNASGetSignalStrengthReq
+   cQMIViewNASGetSignalStrengthRsp
+   cQMIWriterNASNetworkScanReq
+   cQMIViewNASNetworkScanRsp
+   cQMIWriterNASGetServingSystemReq
+   cQMIViewNASGetServingSystemRsp
+   cQMIViewNASServingSystemInd
+   cQMIWriterNASGetHomeNetworkReq
+   cQMIViewNASGetHomeNetworkRsp
+   cQMIWriterNASGetTechnologyPreferenceReq
+   cQMIViewNASGetTechnologyPreferenceRsp
+   cQMIWriterNASGetRFBandInformationReq
+   cQMIViewNASGetRFBandInformationRsp
+
+   NOTE:
+      Generated by build-aux/qmi-codegen from qmi-service-nas.json, do not
+      edit.  To regenerate run (from the top of the source tree):
+
+         build-aux/qmi-codegen/qmi-codegen --cxx-views \
+            --input data/qmi-service-nas.json \
+            --include data/qmi-common.json \
+            --collection data/qmi-collection-gobi-views.json \
+            --output <Core directory>/QMIViewsNAS
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Pragmas
+//---------------------------------------------------------------------------
+#pragma once
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "QMIView.h"
+
+/*=========================================================================*/
+// Class cQMIViewNASEventReportInd
+//    View of the NAS Event Report indication
+/*=========================================================================*/
+class cQMIViewNASEventReportInd : public cQMIMessageView <cQMIViewNASEventReportInd, 11>
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0002 };
+
+      // TLV type IDs
+      enum
+      {
+         TLV_SIGNAL_STRENGTH = 0x10,
+         TLV_RF_BAND_INFORMATION = 0x11,
+         TLV_REGISTRATION_REJECT_REASON = 0x12,
+         TLV_RSSI = 0x13,
+         TLV_ECIO = 0x14,
+         TLV_IO = 0x15,
+         TLV_SINR = 0x16,
+         TLV_ERROR_RATE = 0x17,
+         TLV_RSRQ = 0x18,
+         TLV_LTE_SNR = 0x19,
+         TLV_LTE_RSRP = 0x1A
+      };
+
+      /*=================================================================*/
+      // Struct sSignalStrength (Signal Strength)
+      /*=================================================================*/
+      struct sSignalStrength
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 2 };
+            enum
+            {
+               OFFSET_STRENGTH = 0,
+               OFFSET_RADIO_INTERFACE = 1
+            };
+
+            // Type of value read
+            typedef sSignalStrength tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sSignalStrength()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sSignalStrength( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Strength
+            bool GetStrength( INT8 & value ) const
+            {
+               return sQMIInt <INT8, 1>::Read( mView, OFFSET_STRENGTH, value );
+            };
+
+            // (Inline) Return Radio Interface
+            bool GetRadioInterface( INT8 & value ) const
+            {
+               return sQMIInt <INT8, 1>::Read( mView,
+                                               OFFSET_RADIO_INTERFACE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sRFBandInformationElement (RF Band Information Element)
+      /*=================================================================*/
+      struct sRFBandInformationElement
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 5 };
+            enum
+            {
+               OFFSET_RADIO_INTERFACE = 0,
+               OFFSET_ACTIVE_BAND_CLASS = 1,
+               OFFSET_ACTIVE_CHANNEL = 3
+            };
+
+            // Type of value read
+            typedef sRFBandInformationElement tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sRFBandInformationElement()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sRFBandInformationElement( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Radio Interface
+            bool GetRadioInterface( INT8 & value ) const
+            {
+               return sQMIInt <INT8, 1>::Read( mView,
+                                               OFFSET_RADIO_INTERFACE,
+                                               value );
+            };
+
+            // (Inline) Return Active Band Class
+            bool GetActiveBandClass( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ACTIVE_BAND_CLASS,
+                                               value );
+            };
+
+            // (Inline) Return Active Channel
+            bool GetActiveChannel( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ACTIVE_CHANNEL,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // Array view of RF Band Information
+      typedef cQMIArrayView <sRFBandInformationElement, 1> tRFBandInformation;
+
+      /*=================================================================*/
+      // Struct sRegistrationRejectReason (Registration Reject Reason)
+      /*=================================================================*/
+      struct sRegistrationRejectReason
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 3 };
+            enum
+            {
+               OFFSET_SERVICE_DOMAIN = 0,
+               OFFSET_REJECT_CAUSE = 1
+            };
+
+            // Type of value read
+            typedef sRegistrationRejectReason tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sRegistrationRejectReason()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sRegistrationRejectReason( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Service Domain
+            bool GetServiceDomain( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_SERVICE_DOMAIN,
+                                               value );
+            };
+
+            // (Inline) Return Reject Cause
+            bool GetRejectCause( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_REJECT_CAUSE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sRSSI (RSSI)
+      /*=================================================================*/
+      struct sRSSI
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 2 };
+            enum
+            {
+               OFFSET_RSSI = 0,
+               OFFSET_RADIO_INTERFACE = 1
+            };
+
+            // Type of value read
+            typedef sRSSI tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sRSSI()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sRSSI( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return RSSI
+            bool GetRSSI( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView, OFFSET_RSSI, value );
+            };
+
+            // (Inline) Return Radio Interface
+            bool GetRadioInterface( INT8 & value ) const
+            {
+               return sQMIInt <INT8, 1>::Read( mView,
+                                               OFFSET_RADIO_INTERFACE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sECIO (ECIO)
+      /*=================================================================*/
+      struct sECIO
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 2 };
+            enum
+            {
+               OFFSET_ECIO = 0,
+               OFFSET_RADIO_INTERFACE = 1
+            };
+
+            // Type of value read
+            typedef sECIO tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sECIO()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sECIO( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return ECIO
+            bool GetECIO( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView, OFFSET_ECIO, value );
+            };
+
+            // (Inline) Return Radio Interface
+            bool GetRadioInterface( INT8 & value ) const
+            {
+               return sQMIInt <INT8, 1>::Read( mView,
+                                               OFFSET_RADIO_INTERFACE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sErrorRate (Error Rate)
+      /*=================================================================*/
+      struct sErrorRate
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 3 };
+            enum
+            {
+               OFFSET_RATE = 0,
+               OFFSET_RADIO_INTERFACE = 2
+            };
+
+            // Type of value read
+            typedef sErrorRate tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sErrorRate()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sErrorRate( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Rate
+            bool GetRate( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView, OFFSET_RATE, value );
+            };
+
+            // (Inline) Return Radio Interface
+            bool GetRadioInterface( INT8 & value ) const
+            {
+               return sQMIInt <INT8, 1>::Read( mView,
+                                               OFFSET_RADIO_INTERFACE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sRSRQ (RSRQ)
+      /*=================================================================*/
+      struct sRSRQ
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 2 };
+            enum
+            {
+               OFFSET_RSRQ = 0,
+               OFFSET_RADIO_INTERFACE = 1
+            };
+
+            // Type of value read
+            typedef sRSRQ tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sRSRQ()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sRSRQ( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return RSRQ
+            bool GetRSRQ( INT8 & value ) const
+            {
+               return sQMIInt <INT8, 1>::Read( mView, OFFSET_RSRQ, value );
+            };
+
+            // (Inline) Return Radio Interface
+            bool GetRadioInterface( INT8 & value ) const
+            {
+               return sQMIInt <INT8, 1>::Read( mView,
+                                               OFFSET_RADIO_INTERFACE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // (Inline) Constructor (from the TLVs of the message)
+      cQMIViewNASEventReportInd(
+         const BYTE *               pTLVs,
+         ULONG                      sz )
+         :  cQMIMessageView <cQMIViewNASEventReportInd, 11>( pTLVs, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Constructor (from a QMI service indication)
+      cQMIViewNASEventReportInd( const sProtocolBuffer & buf )
+         :  cQMIMessageView <cQMIViewNASEventReportInd, 11>( buf )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Map a TLV type ID to its slot (-1 if unknown)
+      static int GetSlot( BYTE typeID )
+      {
+         switch (typeID)
+         {
+            case TLV_SIGNAL_STRENGTH:
+               return 0;
+            case TLV_RF_BAND_INFORMATION:
+               return 1;
+            case TLV_REGISTRATION_REJECT_REASON:
+               return 2;
+            case TLV_RSSI:
+               return 3;
+            case TLV_ECIO:
+               return 4;
+            case TLV_IO:
+               return 5;
+            case TLV_SINR:
+               return 6;
+            case TLV_ERROR_RATE:
+               return 7;
+            case TLV_RSRQ:
+               return 8;
+            case TLV_LTE_SNR:
+               return 9;
+            case TLV_LTE_RSRP:
+               return 10;
+         }
+
+         return -1;
+      };
+
+      // (Inline) Return Signal Strength
+      bool GetSignalStrength( sSignalStrength & value ) const
+      {
+         return sSignalStrength::Read( mTLVs[0], 0, value );
+      };
+
+      // (Inline) Return RF Band Information
+      bool GetRFBandInformation( tRFBandInformation & value ) const
+      {
+         return tRFBandInformation::Read( mTLVs[1], 0, value );
+      };
+
+      // (Inline) Return Registration Reject Reason
+      bool GetRegistrationRejectReason( sRegistrationRejectReason & value ) const
+      {
+         return sRegistrationRejectReason::Read( mTLVs[2], 0, value );
+      };
+
+      // (Inline) Return RSSI
+      bool GetRSSI( sRSSI & value ) const
+      {
+         return sRSSI::Read( mTLVs[3], 0, value );
+      };
+
+      // (Inline) Return ECIO
+      bool GetECIO( sECIO & value ) const
+      {
+         return sECIO::Read( mTLVs[4], 0, value );
+      };
+
+      // (Inline) Return IO
+      bool GetIO( LONG & value ) const
+      {
+         return sQMIInt <LONG, 4>::Read( mTLVs[5], 0, value );
+      };
+
+      // (Inline) Return SINR
+      bool GetSINR( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[6], 0, value );
+      };
+
+      // (Inline) Return Error Rate
+      bool GetErrorRate( sErrorRate & value ) const
+      {
+         return sErrorRate::Read( mTLVs[7], 0, value );
+      };
+
+      // (Inline) Return RSRQ
+      bool GetRSRQ( sRSRQ & value ) const
+      {
+         return sRSRQ::Read( mTLVs[8], 0, value );
+      };
+
+      // (Inline) Return LTE SNR
+      bool GetLTESNR( SHORT & value ) const
+      {
+         return sQMIInt <SHORT, 2>::Read( mTLVs[9], 0, value );
+      };
+
+      // (Inline) Return LTE RSRP
+      bool GetLTERSRP( SHORT & value ) const
+      {
+         return sQMIInt <SHORT, 2>::Read( mTLVs[10], 0, value );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIWriterNASGetSignalStrengthReq
+//    Writer of the NAS Get Signal Strength request
+/*=========================================================================*/
+class cQMIWriterNASGetSignalStrengthReq : public cQMIMessageWriter
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0020 };
+
+      // TLV type IDs
+      enum
+      {
+         TLV_REQUEST_MASK = 0x10
+      };
+
+      // (Inline) Constructor
+      cQMIWriterNASGetSignalStrengthReq(
+         BYTE *                     pBuffer,
+         ULONG                      sz )
+         :  cQMIMessageWriter( pBuffer, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Build the QMI request from the encoded TLVs
+      sSharedBuffer * BuildRequest() const
+      {
+         return cQMIMessageWriter::BuildRequest( eQMI_SVC_NAS,
+                                                (WORD)MESSAGE_ID );
+      };
+
+      // (Inline) Set Request Mask
+      bool SetRequestMask( WORD value )
+      {
+         BYTE * pValue = AddTLV( (BYTE)TLV_REQUEST_MASK, 2 );
+         if (pValue == 0)
+         {
+            return false;
+         }
+
+         sQMIInt <WORD, 2>::Write( pValue, value );
+         return true;
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIViewNASGetSignalStrengthRsp
+//    View of the NAS Get Signal Strength response
+/*=========================================================================*/
+class cQMIViewNASGetSignalStrengthRsp : public cQMIMessageView <cQMIViewNASGetSignalStrengthRsp, 11>
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0020 };
+
+      // TLV type IDs
+      enum
+      {
+         TLV_RESULT = 0x02,
+         TLV_SIGNAL_STRENGTH = 0x01,
+         TLV_STRENGTH_LIST = 0x10,
+         TLV_RSSI_LIST = 0x11,
+         TLV_ECIO_LIST = 0x12,
+         TLV_IO = 0x13,
+         TLV_SINR = 0x14,
+         TLV_ERROR_RATE_LIST = 0x15,
+         TLV_RSRQ = 0x16,
+         TLV_LTE_SNR = 0x17,
+         TLV_LTE_RSRP = 0x18
+      };
+
+      /*=================================================================*/
+      // Struct sResult (Result)
+      /*=================================================================*/
+      struct sResult
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 4 };
+            enum
+            {
+               OFFSET_ERROR_STATUS = 0,
+               OFFSET_ERROR_CODE = 2
+            };
+
+            // Type of value read
+            typedef sResult tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sResult()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sResult( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Error Status
+            bool GetErrorStatus( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_STATUS,
+                                               value );
+            };
+
+            // (Inline) Return Error Code
+            bool GetErrorCode( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_CODE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sSignalStrength (Signal Strength)
+      /*=================================================================*/
+      struct sSignalStrength
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 2 };
+            enum
+            {
+               OFFSET_STRENGTH = 0,
+               OFFSET_RADIO_INTERFACE = 1
+            };
+
+            // Type of value read
+            typedef sSignalStrength tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sSignalStrength()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sSignalStrength( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Strength
+            bool GetStrength( INT8 & value ) const
+            {
+               return sQMIInt <INT8, 1>::Read( mView, OFFSET_STRENGTH, value );
+            };
+
+            // (Inline) Return Radio Interface
+            bool GetRadioInterface( INT8 & value ) const
+            {
+               return sQMIInt <INT8, 1>::Read( mView,
+                                               OFFSET_RADIO_INTERFACE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sStrengthListElement (Strength List Element)
+      /*=================================================================*/
+      struct sStrengthListElement
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 2 };
+            enum
+            {
+               OFFSET_STRENGTH = 0,
+               OFFSET_RADIO_INTERFACE = 1
+            };
+
+            // Type of value read
+            typedef sStrengthListElement tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sStrengthListElement()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sStrengthListElement( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Strength
+            bool GetStrength( INT8 & value ) const
+            {
+               return sQMIInt <INT8, 1>::Read( mView, OFFSET_STRENGTH, value );
+            };
+
+            // (Inline) Return Radio Interface
+            bool GetRadioInterface( INT8 & value ) const
+            {
+               return sQMIInt <INT8, 1>::Read( mView,
+                                               OFFSET_RADIO_INTERFACE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // Array view of Strength List
+      typedef cQMIArrayView <sStrengthListElement, 2> tStrengthList;
+
+      /*=================================================================*/
+      // Struct sRSSIListElement (RSSI List Element)
+      /*=================================================================*/
+      struct sRSSIListElement
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 2 };
+            enum
+            {
+               OFFSET_RSSI = 0,
+               OFFSET_RADIO_INTERFACE = 1
+            };
+
+            // Type of value read
+            typedef sRSSIListElement tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sRSSIListElement()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sRSSIListElement( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return RSSI
+            bool GetRSSI( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView, OFFSET_RSSI, value );
+            };
+
+            // (Inline) Return Radio Interface
+            bool GetRadioInterface( INT8 & value ) const
+            {
+               return sQMIInt <INT8, 1>::Read( mView,
+                                               OFFSET_RADIO_INTERFACE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // Array view of RSSI List
+      typedef cQMIArrayView <sRSSIListElement, 2> tRSSIList;
+
+      /*=================================================================*/
+      // Struct sECIOListElement (ECIO List Element)
+      /*=================================================================*/
+      struct sECIOListElement
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 2 };
+            enum
+            {
+               OFFSET_ECIO = 0,
+               OFFSET_RADIO_INTERFACE = 1
+            };
+
+            // Type of value read
+            typedef sECIOListElement tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sECIOListElement()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sECIOListElement( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return ECIO
+            bool GetECIO( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView, OFFSET_ECIO, value );
+            };
+
+            // (Inline) Return Radio Interface
+            bool GetRadioInterface( INT8 & value ) const
+            {
+               return sQMIInt <INT8, 1>::Read( mView,
+                                               OFFSET_RADIO_INTERFACE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // Array view of ECIO List
+      typedef cQMIArrayView <sECIOListElement, 2> tECIOList;
+
+      /*=================================================================*/
+      // Struct sErrorRateListElement (Error Rate List Element)
+      /*=================================================================*/
+      struct sErrorRateListElement
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 3 };
+            enum
+            {
+               OFFSET_RATE = 0,
+               OFFSET_RADIO_INTERFACE = 2
+            };
+
+            // Type of value read
+            typedef sErrorRateListElement tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sErrorRateListElement()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sErrorRateListElement( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Rate
+            bool GetRate( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView, OFFSET_RATE, value );
+            };
+
+            // (Inline) Return Radio Interface
+            bool GetRadioInterface( INT8 & value ) const
+            {
+               return sQMIInt <INT8, 1>::Read( mView,
+                                               OFFSET_RADIO_INTERFACE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // Array view of Error Rate List
+      typedef cQMIArrayView <sErrorRateListElement, 2> tErrorRateList;
+
+      /*=================================================================*/
+      // Struct sRSRQ (RSRQ)
+      /*=================================================================*/
+      struct sRSRQ
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 2 };
+            enum
+            {
+               OFFSET_RSRQ = 0,
+               OFFSET_RADIO_INTERFACE = 1
+            };
+
+            // Type of value read
+            typedef sRSRQ tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sRSRQ()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sRSRQ( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return RSRQ
+            bool GetRSRQ( INT8 & value ) const
+            {
+               return sQMIInt <INT8, 1>::Read( mView, OFFSET_RSRQ, value );
+            };
+
+            // (Inline) Return Radio Interface
+            bool GetRadioInterface( INT8 & value ) const
+            {
+               return sQMIInt <INT8, 1>::Read( mView,
+                                               OFFSET_RADIO_INTERFACE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // (Inline) Constructor (from the TLVs of the message)
+      cQMIViewNASGetSignalStrengthRsp(
+         const BYTE *               pTLVs,
+         ULONG                      sz )
+         :  cQMIMessageView <cQMIViewNASGetSignalStrengthRsp, 11>( pTLVs, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Constructor (from a QMI service response)
+      cQMIViewNASGetSignalStrengthRsp( const sProtocolBuffer & buf )
+         :  cQMIMessageView <cQMIViewNASGetSignalStrengthRsp, 11>( buf )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Map a TLV type ID to its slot (-1 if unknown)
+      static int GetSlot( BYTE typeID )
+      {
+         switch (typeID)
+         {
+            case TLV_RESULT:
+               return 0;
+            case TLV_SIGNAL_STRENGTH:
+               return 1;
+            case TLV_STRENGTH_LIST:
+               return 2;
+            case TLV_RSSI_LIST:
+               return 3;
+            case TLV_ECIO_LIST:
+               return 4;
+            case TLV_IO:
+               return 5;
+            case TLV_SINR:
+               return 6;
+            case TLV_ERROR_RATE_LIST:
+               return 7;
+            case TLV_RSRQ:
+               return 8;
+            case TLV_LTE_SNR:
+               return 9;
+            case TLV_LTE_RSRP:
+               return 10;
+         }
+
+         return -1;
+      };
+
+      // (Inline) Return Result
+      bool GetResult( sResult & value ) const
+      {
+         return sResult::Read( mTLVs[0], 0, value );
+      };
+
+      // (Inline) Return contents of mandatory result content
+      bool GetResult(
+         ULONG &                    returnCode,
+         ULONG &                    errorCode ) const
+      {
+         sResult result;
+         WORD rc = 0;
+         WORD ec = 0;
+         if ( (GetResult( result ) == false)
+         ||   (result.GetErrorStatus( rc ) == false)
+         ||   (result.GetErrorCode( ec ) == false) )
+         {
+            return false;
+         }
+
+         returnCode = (ULONG)rc;
+         errorCode = (ULONG)ec;
+         return true;
+      };
+
+      // (Inline) Return Signal Strength
+      bool GetSignalStrength( sSignalStrength & value ) const
+      {
+         return sSignalStrength::Read( mTLVs[1], 0, value );
+      };
+
+      // (Inline) Return Strength List
+      bool GetStrengthList( tStrengthList & value ) const
+      {
+         return tStrengthList::Read( mTLVs[2], 0, value );
+      };
+
+      // (Inline) Return RSSI List
+      bool GetRSSIList( tRSSIList & value ) const
+      {
+         return tRSSIList::Read( mTLVs[3], 0, value );
+      };
+
+      // (Inline) Return ECIO List
+      bool GetECIOList( tECIOList & value ) const
+      {
+         return tECIOList::Read( mTLVs[4], 0, value );
+      };
+
+      // (Inline) Return IO
+      bool GetIO( LONG & value ) const
+      {
+         return sQMIInt <LONG, 4>::Read( mTLVs[5], 0, value );
+      };
+
+      // (Inline) Return SINR
+      bool GetSINR( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[6], 0, value );
+      };
+
+      // (Inline) Return Error Rate List
+      bool GetErrorRateList( tErrorRateList & value ) const
+      {
+         return tErrorRateList::Read( mTLVs[7], 0, value );
+      };
+
+      // (Inline) Return RSRQ
+      bool GetRSRQ( sRSRQ & value ) const
+      {
+         return sRSRQ::Read( mTLVs[8], 0, value );
+      };
+
+      // (Inline) Return LTE SNR
+      bool GetLTESNR( SHORT & value ) const
+      {
+         return sQMIInt <SHORT, 2>::Read( mTLVs[9], 0, value );
+      };
+
+      // (Inline) Return LTE RSRP
+      bool GetLTERSRP( SHORT & value ) const
+      {
+         return sQMIInt <SHORT, 2>::Read( mTLVs[10], 0, value );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIWriterNASNetworkScanReq
+//    Writer of the NAS Network Scan request
+/*=========================================================================*/
+class cQMIWriterNASNetworkScanReq : public cQMIMessageWriter
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0021 };
+
+      // TLV type IDs
+      enum
+      {
+         TLV_NETWORK_TYPE = 0x10
+      };
+
+      // (Inline) Constructor
+      cQMIWriterNASNetworkScanReq(
+         BYTE *                     pBuffer,
+         ULONG                      sz )
+         :  cQMIMessageWriter( pBuffer, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Build the QMI request from the encoded TLVs
+      sSharedBuffer * BuildRequest() const
+      {
+         return cQMIMessageWriter::BuildRequest( eQMI_SVC_NAS,
+                                                (WORD)MESSAGE_ID );
+      };
+
+      // (Inline) Set Network Type
+      bool SetNetworkType( BYTE value )
+      {
+         BYTE * pValue = AddTLV( (BYTE)TLV_NETWORK_TYPE, 1 );
+         if (pValue == 0)
+         {
+            return false;
+         }
+
+         sQMIInt <BYTE, 1>::Write( pValue, value );
+         return true;
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIViewNASNetworkScanRsp
+//    View of the NAS Network Scan response
+/*=========================================================================*/
+class cQMIViewNASNetworkScanRsp : public cQMIMessageView <cQMIViewNASNetworkScanRsp, 5>
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0021 };
+
+      // TLV type IDs
+      enum
+      {
+         TLV_RESULT = 0x02,
+         TLV_NETWORK_INFORMATION = 0x10,
+         TLV_RADIO_ACCESS_TECHNOLOGY = 0x11,
+         TLV_MNC_PCS_DIGIT_INCLUDE_STATUS = 0x12,
+         TLV_NETWORK_SCAN_RESULT = 0x13
+      };
+
+      /*=================================================================*/
+      // Struct sResult (Result)
+      /*=================================================================*/
+      struct sResult
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 4 };
+            enum
+            {
+               OFFSET_ERROR_STATUS = 0,
+               OFFSET_ERROR_CODE = 2
+            };
+
+            // Type of value read
+            typedef sResult tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sResult()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sResult( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Error Status
+            bool GetErrorStatus( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_STATUS,
+                                               value );
+            };
+
+            // (Inline) Return Error Code
+            bool GetErrorCode( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_CODE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sNetworkInformationElement (Network Information Element)
+      /*=================================================================*/
+      struct sNetworkInformationElement
+      {
+         public:
+            // Compile time size (variable)/offsets of the fields
+            enum { FIXED_SIZE = 0 };
+            enum
+            {
+               OFFSET_MCC = 0,
+               OFFSET_MNC = 2,
+               OFFSET_NETWORK_STATUS = 4,
+               OFFSET_DESCRIPTION = 5
+            };
+
+            // Type of value read
+            typedef sNetworkInformationElement tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sNetworkInformationElement()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sNetworkInformationElement( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = 0;
+
+               ULONG start = offset;
+               ULONG fieldSz = 0;
+               offset += 5;
+               if (sQMIString <1>::Measure( in, offset, fieldSz ) == false)
+               {
+                  return false;
+               }
+
+               offset += fieldSz;
+
+               sz = offset - start;
+               return in.Has( start, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return MCC
+            bool GetMCC( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView, OFFSET_MCC, value );
+            };
+
+            // (Inline) Return MNC
+            bool GetMNC( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView, OFFSET_MNC, value );
+            };
+
+            // (Inline) Return Network Status
+            bool GetNetworkStatus( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_NETWORK_STATUS,
+                                               value );
+            };
+
+            // (Inline) Return Description
+            bool GetDescription( sQMIView & value ) const
+            {
+               return sQMIString <1>::Read( mView, OFFSET_DESCRIPTION, value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // Array view of Network Information
+      typedef cQMIArrayView <sNetworkInformationElement, 2> tNetworkInformation;
+
+      /*=================================================================*/
+      // Struct sRadioAccessTechnologyElement (Radio Access Technology Element)
+      /*=================================================================*/
+      struct sRadioAccessTechnologyElement
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 5 };
+            enum
+            {
+               OFFSET_MCC = 0,
+               OFFSET_MNC = 2,
+               OFFSET_RADIO_INTERFACE = 4
+            };
+
+            // Type of value read
+            typedef sRadioAccessTechnologyElement tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sRadioAccessTechnologyElement()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sRadioAccessTechnologyElement( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return MCC
+            bool GetMCC( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView, OFFSET_MCC, value );
+            };
+
+            // (Inline) Return MNC
+            bool GetMNC( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView, OFFSET_MNC, value );
+            };
+
+            // (Inline) Return Radio Interface
+            bool GetRadioInterface( INT8 & value ) const
+            {
+               return sQMIInt <INT8, 1>::Read( mView,
+                                               OFFSET_RADIO_INTERFACE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // Array view of Radio Access Technology
+      typedef cQMIArrayView <sRadioAccessTechnologyElement, 2> tRadioAccessTechnology;
+
+      /*=================================================================*/
+      // Struct sMNCPCSDigitIncludeStatusElement (MNC PCS Digit Include Status Element)
+      /*=================================================================*/
+      struct sMNCPCSDigitIncludeStatusElement
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 5 };
+            enum
+            {
+               OFFSET_MCC = 0,
+               OFFSET_MNC = 2,
+               OFFSET_INCLUDES_PCS_DIGIT = 4
+            };
+
+            // Type of value read
+            typedef sMNCPCSDigitIncludeStatusElement tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sMNCPCSDigitIncludeStatusElement()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sMNCPCSDigitIncludeStatusElement( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return MCC
+            bool GetMCC( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView, OFFSET_MCC, value );
+            };
+
+            // (Inline) Return MNC
+            bool GetMNC( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView, OFFSET_MNC, value );
+            };
+
+            // (Inline) Return Includes PCS Digit
+            bool GetIncludesPCSDigit( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_INCLUDES_PCS_DIGIT,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // Array view of MNC PCS Digit Include Status
+      typedef cQMIArrayView <sMNCPCSDigitIncludeStatusElement, 2> tMNCPCSDigitIncludeStatus;
+
+      // (Inline) Constructor (from the TLVs of the message)
+      cQMIViewNASNetworkScanRsp(
+         const BYTE *               pTLVs,
+         ULONG                      sz )
+         :  cQMIMessageView <cQMIViewNASNetworkScanRsp, 5>( pTLVs, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Constructor (from a QMI service response)
+      cQMIViewNASNetworkScanRsp( const sProtocolBuffer & buf )
+         :  cQMIMessageView <cQMIViewNASNetworkScanRsp, 5>( buf )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Map a TLV type ID to its slot (-1 if unknown)
+      static int GetSlot( BYTE typeID )
+      {
+         switch (typeID)
+         {
+            case TLV_RESULT:
+               return 0;
+            case TLV_NETWORK_INFORMATION:
+               return 1;
+            case TLV_RADIO_ACCESS_TECHNOLOGY:
+               return 2;
+            case TLV_MNC_PCS_DIGIT_INCLUDE_STATUS:
+               return 3;
+            case TLV_NETWORK_SCAN_RESULT:
+               return 4;
+         }
+
+         return -1;
+      };
+
+      // (Inline) Return Result
+      bool GetResult( sResult & value ) const
+      {
+         return sResult::Read( mTLVs[0], 0, value );
+      };
+
+      // (Inline) Return contents of mandatory result content
+      bool GetResult(
+         ULONG &                    returnCode,
+         ULONG &                    errorCode ) const
+      {
+         sResult result;
+         WORD rc = 0;
+         WORD ec = 0;
+         if ( (GetResult( result ) == false)
+         ||   (result.GetErrorStatus( rc ) == false)
+         ||   (result.GetErrorCode( ec ) == false) )
+         {
+            return false;
+         }
+
+         returnCode = (ULONG)rc;
+         errorCode = (ULONG)ec;
+         return true;
+      };
+
+      // (Inline) Return Network Information
+      bool GetNetworkInformation( tNetworkInformation & value ) const
+      {
+         return tNetworkInformation::Read( mTLVs[1], 0, value );
+      };
+
+      // (Inline) Return Radio Access Technology
+      bool GetRadioAccessTechnology( tRadioAccessTechnology & value ) const
+      {
+         return tRadioAccessTechnology::Read( mTLVs[2], 0, value );
+      };
+
+      // (Inline) Return MNC PCS Digit Include Status
+      bool GetMNCPCSDigitIncludeStatus( tMNCPCSDigitIncludeStatus & value ) const
+      {
+         return tMNCPCSDigitIncludeStatus::Read( mTLVs[3], 0, value );
+      };
+
+      // (Inline) Return Network Scan Result
+      bool GetNetworkScanResult( ULONG & value ) const
+      {
+         return sQMIInt <ULONG, 4>::Read( mTLVs[4], 0, value );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIWriterNASGetServingSystemReq
+//    Writer of the NAS Get Serving System request
+/*=========================================================================*/
+class cQMIWriterNASGetServingSystemReq : public cQMIMessageWriter
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0024 };
+
+      // (Inline) Constructor
+      cQMIWriterNASGetServingSystemReq(
+         BYTE *                     pBuffer,
+         ULONG                      sz )
+         :  cQMIMessageWriter( pBuffer, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Build the QMI request from the encoded TLVs
+      sSharedBuffer * BuildRequest() const
+      {
+         return cQMIMessageWriter::BuildRequest( eQMI_SVC_NAS,
+                                                (WORD)MESSAGE_ID );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIViewNASGetServingSystemRsp
+//    View of the NAS Get Serving System response
+/*=========================================================================*/
+class cQMIViewNASGetServingSystemRsp : public cQMIMessageView <cQMIViewNASGetServingSystemRsp, 26>
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0024 };
+
+      // TLV type IDs
+      enum
+      {
+         TLV_RESULT = 0x02,
+         TLV_SERVING_SYSTEM = 0x01,
+         TLV_ROAMING_INDICATOR = 0x10,
+         TLV_DATA_SERVICE_CAPABILITY = 0x11,
+         TLV_CURRENT_PLMN = 0x12,
+         TLV_CDMA_SYSTEM_ID = 0x13,
+         TLV_CDMA_BASE_STATION_INFO = 0x14,
+         TLV_ROAMING_INDICATOR_LIST = 0x15,
+         TLV_DEFAULT_ROAMING_INDICATOR = 0x16,
+         TLV_TIME_ZONE_3GPP2 = 0x17,
+         TLV_CDMA_P_REV = 0x18,
+         TLV_TIME_ZONE_3GPP = 0x1A,
+         TLV_DAYLIGHT_SAVING_TIME_ADJUSTMENT_3GPP = 0x1B,
+         TLV_LAC_3GPP = 0x1C,
+         TLV_CID_3GPP = 0x1D,
+         TLV_CONCURRENT_SERVICE_INFO_3GPP2 = 0x1E,
+         TLV_PRL_INDICATOR_3GPP2 = 0x1F,
+         TLV_DTM_SUPPORT = 0x20,
+         TLV_DETAILED_SERVICE_STATUS = 0x21,
+         TLV_CDMA_SYSTEM_INFO = 0x22,
+         TLV_HDR_PERSONALITY = 0x23,
+         TLV_LTE_TAC = 0x24,
+         TLV_CALL_BARRING_STATUS = 0x25,
+         TLV_UMTS_PRIMARY_SCRAMBLING_CODE = 0x26,
+         TLV_MNC_PCS_DIGIT_INCLUDE_STATUS = 0x27,
+         TLV_NETWORK_NAME_SOURCE = 0x29
+      };
+
+      /*=================================================================*/
+      // Struct sResult (Result)
+      /*=================================================================*/
+      struct sResult
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 4 };
+            enum
+            {
+               OFFSET_ERROR_STATUS = 0,
+               OFFSET_ERROR_CODE = 2
+            };
+
+            // Type of value read
+            typedef sResult tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sResult()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sResult( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Error Status
+            bool GetErrorStatus( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_STATUS,
+                                               value );
+            };
+
+            // (Inline) Return Error Code
+            bool GetErrorCode( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_CODE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // Array view of Serving System Radio Interfaces
+      typedef cQMIArrayView <sQMIInt <INT8, 1>, 1> tServingSystemRadioInterfaces;
+
+      /*=================================================================*/
+      // Struct sServingSystem (Serving System)
+      /*=================================================================*/
+      struct sServingSystem
+      {
+         public:
+            // Compile time size (variable)/offsets of the fields
+            enum { FIXED_SIZE = 0 };
+            enum
+            {
+               OFFSET_REGISTRATION_STATE = 0,
+               OFFSET_CS_ATTACH_STATE = 1,
+               OFFSET_PS_ATTACH_STATE = 2,
+               OFFSET_SELECTED_NETWORK = 3,
+               OFFSET_RADIO_INTERFACES = 4
+            };
+
+            // Type of value read
+            typedef sServingSystem tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sServingSystem()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sServingSystem( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = 0;
+
+               ULONG start = offset;
+               ULONG fieldSz = 0;
+               offset += 4;
+               if (tServingSystemRadioInterfaces::Measure( in, offset, fieldSz ) == false)
+               {
+                  return false;
+               }
+
+               offset += fieldSz;
+
+               sz = offset - start;
+               return in.Has( start, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Registration State
+            bool GetRegistrationState( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_REGISTRATION_STATE,
+                                               value );
+            };
+
+            // (Inline) Return CS Attach State
+            bool GetCSAttachState( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_CS_ATTACH_STATE,
+                                               value );
+            };
+
+            // (Inline) Return PS Attach State
+            bool GetPSAttachState( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_PS_ATTACH_STATE,
+                                               value );
+            };
+
+            // (Inline) Return Selected Network
+            bool GetSelectedNetwork( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_SELECTED_NETWORK,
+                                               value );
+            };
+
+            // (Inline) Return Radio Interfaces
+            bool GetRadioInterfaces( tServingSystemRadioInterfaces & value ) const
+            {
+               return tServingSystemRadioInterfaces::Read( mView,
+                                                           OFFSET_RADIO_INTERFACES,
+                                                           value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // Array view of Data Service Capability
+      typedef cQMIArrayView <sQMIInt <BYTE, 1>, 1> tDataServiceCapability;
+
+      /*=================================================================*/
+      // Struct sCurrentPLMN (Current PLMN)
+      /*=================================================================*/
+      struct sCurrentPLMN
+      {
+         public:
+            // Compile time size (variable)/offsets of the fields
+            enum { FIXED_SIZE = 0 };
+            enum
+            {
+               OFFSET_MCC = 0,
+               OFFSET_MNC = 2,
+               OFFSET_DESCRIPTION = 4
+            };
+
+            // Type of value read
+            typedef sCurrentPLMN tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sCurrentPLMN()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sCurrentPLMN( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = 0;
+
+               ULONG start = offset;
+               ULONG fieldSz = 0;
+               offset += 4;
+               if (sQMIString <1>::Measure( in, offset, fieldSz ) == false)
+               {
+                  return false;
+               }
+
+               offset += fieldSz;
+
+               sz = offset - start;
+               return in.Has( start, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return MCC
+            bool GetMCC( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView, OFFSET_MCC, value );
+            };
+
+            // (Inline) Return MNC
+            bool GetMNC( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView, OFFSET_MNC, value );
+            };
+
+            // (Inline) Return Description
+            bool GetDescription( sQMIView & value ) const
+            {
+               return sQMIString <1>::Read( mView, OFFSET_DESCRIPTION, value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sCDMASystemID (CDMA System ID)
+      /*=================================================================*/
+      struct sCDMASystemID
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 4 };
+            enum
+            {
+               OFFSET_SID = 0,
+               OFFSET_NID = 2
+            };
+
+            // Type of value read
+            typedef sCDMASystemID tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sCDMASystemID()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sCDMASystemID( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return SID
+            bool GetSID( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView, OFFSET_SID, value );
+            };
+
+            // (Inline) Return NID
+            bool GetNID( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView, OFFSET_NID, value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sCDMABaseStationInfo (CDMA Base Station Info)
+      /*=================================================================*/
+      struct sCDMABaseStationInfo
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 10 };
+            enum
+            {
+               OFFSET_BASE_STATION_ID = 0,
+               OFFSET_BASE_STATION_LATITUDE = 2,
+               OFFSET_BASE_STATION_LONGITUDE = 6
+            };
+
+            // Type of value read
+            typedef sCDMABaseStationInfo tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sCDMABaseStationInfo()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sCDMABaseStationInfo( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Base Station ID
+            bool GetBaseStationID( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_BASE_STATION_ID,
+                                               value );
+            };
+
+            // (Inline) Return Base Station Latitude
+            bool GetBaseStationLatitude( LONG & value ) const
+            {
+               return sQMIInt <LONG, 4>::Read( mView,
+                                               OFFSET_BASE_STATION_LATITUDE,
+                                               value );
+            };
+
+            // (Inline) Return Base Station Longitude
+            bool GetBaseStationLongitude( LONG & value ) const
+            {
+               return sQMIInt <LONG, 4>::Read( mView,
+                                               OFFSET_BASE_STATION_LONGITUDE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sRoamingIndicatorListElement (Roaming Indicator List Element)
+      /*=================================================================*/
+      struct sRoamingIndicatorListElement
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 2 };
+            enum
+            {
+               OFFSET_RADIO_INTERFACE = 0,
+               OFFSET_ROAMING_INDICATOR = 1
+            };
+
+            // Type of value read
+            typedef sRoamingIndicatorListElement tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sRoamingIndicatorListElement()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sRoamingIndicatorListElement( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Radio Interface
+            bool GetRadioInterface( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_RADIO_INTERFACE,
+                                               value );
+            };
+
+            // (Inline) Return Roaming Indicator
+            bool GetRoamingIndicator( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_ROAMING_INDICATOR,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // Array view of Roaming Indicator List
+      typedef cQMIArrayView <sRoamingIndicatorListElement, 1> tRoamingIndicatorList;
+
+      /*=================================================================*/
+      // Struct sTimeZone3GPP2 (Time Zone 3GPP2)
+      /*=================================================================*/
+      struct sTimeZone3GPP2
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 3 };
+            enum
+            {
+               OFFSET_LEAP_SECONDS = 0,
+               OFFSET_LOCAL_TIME_OFFSET = 1,
+               OFFSET_DAYLIGHT_SAVING_TIME = 2
+            };
+
+            // Type of value read
+            typedef sTimeZone3GPP2 tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sTimeZone3GPP2()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sTimeZone3GPP2( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Leap Seconds
+            bool GetLeapSeconds( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_LEAP_SECONDS,
+                                               value );
+            };
+
+            // (Inline) Return Local Time Offset
+            bool GetLocalTimeOffset( INT8 & value ) const
+            {
+               return sQMIInt <INT8, 1>::Read( mView,
+                                               OFFSET_LOCAL_TIME_OFFSET,
+                                               value );
+            };
+
+            // (Inline) Return Daylight Saving Time
+            bool GetDaylightSavingTime( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_DAYLIGHT_SAVING_TIME,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sDetailedServiceStatus (Detailed Service Status)
+      /*=================================================================*/
+      struct sDetailedServiceStatus
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 5 };
+            enum
+            {
+               OFFSET_STATUS = 0,
+               OFFSET_CAPABILITY = 1,
+               OFFSET_HDR_STATUS = 2,
+               OFFSET_HDR_HYBRID = 3,
+               OFFSET_FORBIDDEN = 4
+            };
+
+            // Type of value read
+            typedef sDetailedServiceStatus tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sDetailedServiceStatus()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sDetailedServiceStatus( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Status
+            bool GetStatus( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView, OFFSET_STATUS, value );
+            };
+
+            // (Inline) Return Capability
+            bool GetCapability( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_CAPABILITY,
+                                               value );
+            };
+
+            // (Inline) Return HDR Status
+            bool GetHDRStatus( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_HDR_STATUS,
+                                               value );
+            };
+
+            // (Inline) Return HDR Hybrid
+            bool GetHDRHybrid( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_HDR_HYBRID,
+                                               value );
+            };
+
+            // (Inline) Return Forbidden
+            bool GetForbidden( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_FORBIDDEN,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sCDMASystemInfo (CDMA System Info)
+      /*=================================================================*/
+      struct sCDMASystemInfo
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 3 };
+            enum
+            {
+               OFFSET_MCC = 0,
+               OFFSET_IMSI_11_12 = 2
+            };
+
+            // Type of value read
+            typedef sCDMASystemInfo tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sCDMASystemInfo()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sCDMASystemInfo( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return MCC
+            bool GetMCC( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView, OFFSET_MCC, value );
+            };
+
+            // (Inline) Return IMSI_11_12
+            bool GetIMSI1112( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_IMSI_11_12,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sCallBarringStatus (Call Barring Status)
+      /*=================================================================*/
+      struct sCallBarringStatus
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 8 };
+            enum
+            {
+               OFFSET_CS_STATUS = 0,
+               OFFSET_PS_STATUS = 4
+            };
+
+            // Type of value read
+            typedef sCallBarringStatus tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sCallBarringStatus()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sCallBarringStatus( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return CS Status
+            bool GetCSStatus( LONG & value ) const
+            {
+               return sQMIInt <LONG, 4>::Read( mView,
+                                               OFFSET_CS_STATUS,
+                                               value );
+            };
+
+            // (Inline) Return PS Status
+            bool GetPSStatus( LONG & value ) const
+            {
+               return sQMIInt <LONG, 4>::Read( mView,
+                                               OFFSET_PS_STATUS,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sMNCPCSDigitIncludeStatus (MNC PCS Digit Include Status)
+      /*=================================================================*/
+      struct sMNCPCSDigitIncludeStatus
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 5 };
+            enum
+            {
+               OFFSET_MCC = 0,
+               OFFSET_MNC = 2,
+               OFFSET_INCLUDES_PCS_DIGIT = 4
+            };
+
+            // Type of value read
+            typedef sMNCPCSDigitIncludeStatus tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sMNCPCSDigitIncludeStatus()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sMNCPCSDigitIncludeStatus( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return MCC
+            bool GetMCC( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView, OFFSET_MCC, value );
+            };
+
+            // (Inline) Return MNC
+            bool GetMNC( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView, OFFSET_MNC, value );
+            };
+
+            // (Inline) Return Includes PCS Digit
+            bool GetIncludesPCSDigit( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_INCLUDES_PCS_DIGIT,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // (Inline) Constructor (from the TLVs of the message)
+      cQMIViewNASGetServingSystemRsp(
+         const BYTE *               pTLVs,
+         ULONG                      sz )
+         :  cQMIMessageView <cQMIViewNASGetServingSystemRsp, 26>( pTLVs, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Constructor (from a QMI service response)
+      cQMIViewNASGetServingSystemRsp( const sProtocolBuffer & buf )
+         :  cQMIMessageView <cQMIViewNASGetServingSystemRsp, 26>( buf )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Map a TLV type ID to its slot (-1 if unknown)
+      static int GetSlot( BYTE typeID )
+      {
+         switch (typeID)
+         {
+            case TLV_RESULT:
+               return 0;
+            case TLV_SERVING_SYSTEM:
+               return 1;
+            case TLV_ROAMING_INDICATOR:
+               return 2;
+            case TLV_DATA_SERVICE_CAPABILITY:
+               return 3;
+            case TLV_CURRENT_PLMN:
+               return 4;
+            case TLV_CDMA_SYSTEM_ID:
+               return 5;
+            case TLV_CDMA_BASE_STATION_INFO:
+               return 6;
+            case TLV_ROAMING_INDICATOR_LIST:
+               return 7;
+            case TLV_DEFAULT_ROAMING_INDICATOR:
+               return 8;
+            case TLV_TIME_ZONE_3GPP2:
+               return 9;
+            case TLV_CDMA_P_REV:
+               return 10;
+            case TLV_TIME_ZONE_3GPP:
+               return 11;
+            case TLV_DAYLIGHT_SAVING_TIME_ADJUSTMENT_3GPP:
+               return 12;
+            case TLV_LAC_3GPP:
+               return 13;
+            case TLV_CID_3GPP:
+               return 14;
+            case TLV_CONCURRENT_SERVICE_INFO_3GPP2:
+               return 15;
+            case TLV_PRL_INDICATOR_3GPP2:
+               return 16;
+            case TLV_DTM_SUPPORT:
+               return 17;
+            case TLV_DETAILED_SERVICE_STATUS:
+               return 18;
+            case TLV_CDMA_SYSTEM_INFO:
+               return 19;
+            case TLV_HDR_PERSONALITY:
+               return 20;
+            case TLV_LTE_TAC:
+               return 21;
+            case TLV_CALL_BARRING_STATUS:
+               return 22;
+            case TLV_UMTS_PRIMARY_SCRAMBLING_CODE:
+               return 23;
+            case TLV_MNC_PCS_DIGIT_INCLUDE_STATUS:
+               return 24;
+            case TLV_NETWORK_NAME_SOURCE:
+               return 25;
+         }
+
+         return -1;
+      };
+
+      // (Inline) Return Result
+      bool GetResult( sResult & value ) const
+      {
+         return sResult::Read( mTLVs[0], 0, value );
+      };
+
+      // (Inline) Return contents of mandatory result content
+      bool GetResult(
+         ULONG &                    returnCode,
+         ULONG &                    errorCode ) const
+      {
+         sResult result;
+         WORD rc = 0;
+         WORD ec = 0;
+         if ( (GetResult( result ) == false)
+         ||   (result.GetErrorStatus( rc ) == false)
+         ||   (result.GetErrorCode( ec ) == false) )
+         {
+            return false;
+         }
+
+         returnCode = (ULONG)rc;
+         errorCode = (ULONG)ec;
+         return true;
+      };
+
+      // (Inline) Return Serving System
+      bool GetServingSystem( sServingSystem & value ) const
+      {
+         return sServingSystem::Read( mTLVs[1], 0, value );
+      };
+
+      // (Inline) Return Roaming Indicator
+      bool GetRoamingIndicator( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[2], 0, value );
+      };
+
+      // (Inline) Return Data Service Capability
+      bool GetDataServiceCapability( tDataServiceCapability & value ) const
+      {
+         return tDataServiceCapability::Read( mTLVs[3], 0, value );
+      };
+
+      // (Inline) Return Current PLMN
+      bool GetCurrentPLMN( sCurrentPLMN & value ) const
+      {
+         return sCurrentPLMN::Read( mTLVs[4], 0, value );
+      };
+
+      // (Inline) Return CDMA System ID
+      bool GetCDMASystemID( sCDMASystemID & value ) const
+      {
+         return sCDMASystemID::Read( mTLVs[5], 0, value );
+      };
+
+      // (Inline) Return CDMA Base Station Info
+      bool GetCDMABaseStationInfo( sCDMABaseStationInfo & value ) const
+      {
+         return sCDMABaseStationInfo::Read( mTLVs[6], 0, value );
+      };
+
+      // (Inline) Return Roaming Indicator List
+      bool GetRoamingIndicatorList( tRoamingIndicatorList & value ) const
+      {
+         return tRoamingIndicatorList::Read( mTLVs[7], 0, value );
+      };
+
+      // (Inline) Return Default Roaming Indicator
+      bool GetDefaultRoamingIndicator( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[8], 0, value );
+      };
+
+      // (Inline) Return Time Zone 3GPP2
+      bool GetTimeZone3GPP2( sTimeZone3GPP2 & value ) const
+      {
+         return sTimeZone3GPP2::Read( mTLVs[9], 0, value );
+      };
+
+      // (Inline) Return CDMA P Rev
+      bool GetCDMAPRev( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[10], 0, value );
+      };
+
+      // (Inline) Return Time Zone 3GPP
+      bool GetTimeZone3GPP( INT8 & value ) const
+      {
+         return sQMIInt <INT8, 1>::Read( mTLVs[11], 0, value );
+      };
+
+      // (Inline) Return Daylight Saving Time Adjustment 3GPP
+      bool GetDaylightSavingTimeAdjustment3GPP( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[12], 0, value );
+      };
+
+      // (Inline) Return LAC 3GPP
+      bool GetLAC3GPP( WORD & value ) const
+      {
+         return sQMIInt <WORD, 2>::Read( mTLVs[13], 0, value );
+      };
+
+      // (Inline) Return CID 3GPP
+      bool GetCID3GPP( ULONG & value ) const
+      {
+         return sQMIInt <ULONG, 4>::Read( mTLVs[14], 0, value );
+      };
+
+      // (Inline) Return Concurrent Service Info 3GPP2
+      bool GetConcurrentServiceInfo3GPP2( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[15], 0, value );
+      };
+
+      // (Inline) Return PRL Indicator 3GPP2
+      bool GetPRLIndicator3GPP2( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[16], 0, value );
+      };
+
+      // (Inline) Return DTM Support
+      bool GetDTMSupport( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[17], 0, value );
+      };
+
+      // (Inline) Return Detailed Service Status
+      bool GetDetailedServiceStatus( sDetailedServiceStatus & value ) const
+      {
+         return sDetailedServiceStatus::Read( mTLVs[18], 0, value );
+      };
+
+      // (Inline) Return CDMA System Info
+      bool GetCDMASystemInfo( sCDMASystemInfo & value ) const
+      {
+         return sCDMASystemInfo::Read( mTLVs[19], 0, value );
+      };
+
+      // (Inline) Return HDR Personality
+      bool GetHDRPersonality( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[20], 0, value );
+      };
+
+      // (Inline) Return LTE TAC
+      bool GetLTETAC( WORD & value ) const
+      {
+         return sQMIInt <WORD, 2>::Read( mTLVs[21], 0, value );
+      };
+
+      // (Inline) Return Call Barring Status
+      bool GetCallBarringStatus( sCallBarringStatus & value ) const
+      {
+         return sCallBarringStatus::Read( mTLVs[22], 0, value );
+      };
+
+      // (Inline) Return UMTS Primary Scrambling Code
+      bool GetUMTSPrimaryScramblingCode( WORD & value ) const
+      {
+         return sQMIInt <WORD, 2>::Read( mTLVs[23], 0, value );
+      };
+
+      // (Inline) Return MNC PCS Digit Include Status
+      bool GetMNCPCSDigitIncludeStatus( sMNCPCSDigitIncludeStatus & value ) const
+      {
+         return sMNCPCSDigitIncludeStatus::Read( mTLVs[24], 0, value );
+      };
+
+      // (Inline) Return Network Name Source
+      bool GetNetworkNameSource( ULONG & value ) const
+      {
+         return sQMIInt <ULONG, 4>::Read( mTLVs[25], 0, value );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIViewNASServingSystemInd
+//    View of the NAS Serving System indication
+/*=========================================================================*/
+class cQMIViewNASServingSystemInd : public cQMIMessageView <cQMIViewNASServingSystemInd, 28>
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0024 };
+
+      // TLV type IDs
+      enum
+      {
+         TLV_SERVING_SYSTEM = 0x01,
+         TLV_ROAMING_INDICATOR = 0x10,
+         TLV_DATA_SERVICE_CAPABILITY = 0x11,
+         TLV_CURRENT_PLMN = 0x12,
+         TLV_CDMA_SYSTEM_ID = 0x13,
+         TLV_CDMA_BASE_STATION_INFO = 0x14,
+         TLV_ROAMING_INDICATOR_LIST = 0x15,
+         TLV_DEFAULT_ROAMING_INDICATOR = 0x16,
+         TLV_TIME_ZONE_3GPP2 = 0x17,
+         TLV_CDMA_P_REV = 0x18,
+         TLV_PLMN_NAME_FLAG_3GPP = 0x19,
+         TLV_TIME_ZONE_3GPP = 0x1A,
+         TLV_DAYLIGHT_SAVING_TIME_ADJUSTMENT_3GPP = 0x1B,
+         TLV_UNIVERSAL_TIME_AND_LOCAL_TIME_ZONE_3GPP = 0x1C,
+         TLV_LAC_3GPP = 0x1D,
+         TLV_CID_3GPP = 0x1E,
+         TLV_CONCURRENT_SERVICE_INFO_3GPP2 = 0x1F,
+         TLV_PRL_INDICATOR_3GPP2 = 0x20,
+         TLV_DTM_SUPPORT = 0x21,
+         TLV_DETAILED_SERVICE_STATUS = 0x22,
+         TLV_CDMA_SYSTEM_INFO = 0x23,
+         TLV_HDR_PERSONALITY = 0x24,
+         TLV_LTE_TAC = 0x25,
+         TLV_CALL_BARRING_STATUS = 0x26,
+         TLV_PLMN_NOT_CHANGED_INDICATION = 0x27,
+         TLV_UMTS_PRIMARY_SCRAMBLING_CODE = 0x28,
+         TLV_MNC_PCS_DIGIT_INCLUDE_STATUS = 0x29,
+         TLV_NETWORK_NAME_SOURCE = 0x2B
+      };
+
+      // Array view of Serving System Radio Interfaces
+      typedef cQMIArrayView <sQMIInt <INT8, 1>, 1> tServingSystemRadioInterfaces;
+
+      /*=================================================================*/
+      // Struct sServingSystem (Serving System)
+      /*=================================================================*/
+      struct sServingSystem
+      {
+         public:
+            // Compile time size (variable)/offsets of the fields
+            enum { FIXED_SIZE = 0 };
+            enum
+            {
+               OFFSET_REGISTRATION_STATE = 0,
+               OFFSET_CS_ATTACH_STATE = 1,
+               OFFSET_PS_ATTACH_STATE = 2,
+               OFFSET_SELECTED_NETWORK = 3,
+               OFFSET_RADIO_INTERFACES = 4
+            };
+
+            // Type of value read
+            typedef sServingSystem tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sServingSystem()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sServingSystem( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = 0;
+
+               ULONG start = offset;
+               ULONG fieldSz = 0;
+               offset += 4;
+               if (tServingSystemRadioInterfaces::Measure( in, offset, fieldSz ) == false)
+               {
+                  return false;
+               }
+
+               offset += fieldSz;
+
+               sz = offset - start;
+               return in.Has( start, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Registration State
+            bool GetRegistrationState( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_REGISTRATION_STATE,
+                                               value );
+            };
+
+            // (Inline) Return CS Attach State
+            bool GetCSAttachState( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_CS_ATTACH_STATE,
+                                               value );
+            };
+
+            // (Inline) Return PS Attach State
+            bool GetPSAttachState( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_PS_ATTACH_STATE,
+                                               value );
+            };
+
+            // (Inline) Return Selected Network
+            bool GetSelectedNetwork( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_SELECTED_NETWORK,
+                                               value );
+            };
+
+            // (Inline) Return Radio Interfaces
+            bool GetRadioInterfaces( tServingSystemRadioInterfaces & value ) const
+            {
+               return tServingSystemRadioInterfaces::Read( mView,
+                                                           OFFSET_RADIO_INTERFACES,
+                                                           value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // Array view of Data Service Capability
+      typedef cQMIArrayView <sQMIInt <BYTE, 1>, 1> tDataServiceCapability;
+
+      /*=================================================================*/
+      // Struct sCurrentPLMN (Current PLMN)
+      /*=================================================================*/
+      struct sCurrentPLMN
+      {
+         public:
+            // Compile time size (variable)/offsets of the fields
+            enum { FIXED_SIZE = 0 };
+            enum
+            {
+               OFFSET_MCC = 0,
+               OFFSET_MNC = 2,
+               OFFSET_DESCRIPTION = 4
+            };
+
+            // Type of value read
+            typedef sCurrentPLMN tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sCurrentPLMN()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sCurrentPLMN( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = 0;
+
+               ULONG start = offset;
+               ULONG fieldSz = 0;
+               offset += 4;
+               if (sQMIString <1>::Measure( in, offset, fieldSz ) == false)
+               {
+                  return false;
+               }
+
+               offset += fieldSz;
+
+               sz = offset - start;
+               return in.Has( start, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return MCC
+            bool GetMCC( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView, OFFSET_MCC, value );
+            };
+
+            // (Inline) Return MNC
+            bool GetMNC( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView, OFFSET_MNC, value );
+            };
+
+            // (Inline) Return Description
+            bool GetDescription( sQMIView & value ) const
+            {
+               return sQMIString <1>::Read( mView, OFFSET_DESCRIPTION, value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sCDMASystemID (CDMA System ID)
+      /*=================================================================*/
+      struct sCDMASystemID
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 4 };
+            enum
+            {
+               OFFSET_SID = 0,
+               OFFSET_NID = 2
+            };
+
+            // Type of value read
+            typedef sCDMASystemID tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sCDMASystemID()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sCDMASystemID( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return SID
+            bool GetSID( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView, OFFSET_SID, value );
+            };
+
+            // (Inline) Return NID
+            bool GetNID( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView, OFFSET_NID, value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sCDMABaseStationInfo (CDMA Base Station Info)
+      /*=================================================================*/
+      struct sCDMABaseStationInfo
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 10 };
+            enum
+            {
+               OFFSET_BASE_STATION_ID = 0,
+               OFFSET_BASE_STATION_LATITUDE = 2,
+               OFFSET_BASE_STATION_LONGITUDE = 6
+            };
+
+            // Type of value read
+            typedef sCDMABaseStationInfo tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sCDMABaseStationInfo()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sCDMABaseStationInfo( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Base Station ID
+            bool GetBaseStationID( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_BASE_STATION_ID,
+                                               value );
+            };
+
+            // (Inline) Return Base Station Latitude
+            bool GetBaseStationLatitude( LONG & value ) const
+            {
+               return sQMIInt <LONG, 4>::Read( mView,
+                                               OFFSET_BASE_STATION_LATITUDE,
+                                               value );
+            };
+
+            // (Inline) Return Base Station Longitude
+            bool GetBaseStationLongitude( LONG & value ) const
+            {
+               return sQMIInt <LONG, 4>::Read( mView,
+                                               OFFSET_BASE_STATION_LONGITUDE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sRoamingIndicatorListElement (Roaming Indicator List Element)
+      /*=================================================================*/
+      struct sRoamingIndicatorListElement
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 2 };
+            enum
+            {
+               OFFSET_RADIO_INTERFACE = 0,
+               OFFSET_ROAMING_INDICATOR = 1
+            };
+
+            // Type of value read
+            typedef sRoamingIndicatorListElement tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sRoamingIndicatorListElement()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sRoamingIndicatorListElement( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Radio Interface
+            bool GetRadioInterface( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_RADIO_INTERFACE,
+                                               value );
+            };
+
+            // (Inline) Return Roaming Indicator
+            bool GetRoamingIndicator( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_ROAMING_INDICATOR,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // Array view of Roaming Indicator List
+      typedef cQMIArrayView <sRoamingIndicatorListElement, 1> tRoamingIndicatorList;
+
+      /*=================================================================*/
+      // Struct sTimeZone3GPP2 (Time Zone 3GPP2)
+      /*=================================================================*/
+      struct sTimeZone3GPP2
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 3 };
+            enum
+            {
+               OFFSET_LEAP_SECONDS = 0,
+               OFFSET_LOCAL_TIME_OFFSET = 1,
+               OFFSET_DAYLIGHT_SAVING_TIME = 2
+            };
+
+            // Type of value read
+            typedef sTimeZone3GPP2 tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sTimeZone3GPP2()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sTimeZone3GPP2( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Leap Seconds
+            bool GetLeapSeconds( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_LEAP_SECONDS,
+                                               value );
+            };
+
+            // (Inline) Return Local Time Offset
+            bool GetLocalTimeOffset( INT8 & value ) const
+            {
+               return sQMIInt <INT8, 1>::Read( mView,
+                                               OFFSET_LOCAL_TIME_OFFSET,
+                                               value );
+            };
+
+            // (Inline) Return Daylight Saving Time
+            bool GetDaylightSavingTime( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_DAYLIGHT_SAVING_TIME,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sUniversalTimeAndLocalTimeZone3GPP (Universal Time and Local Time Zone 3GPP)
+      /*=================================================================*/
+      struct sUniversalTimeAndLocalTimeZone3GPP
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 8 };
+            enum
+            {
+               OFFSET_YEAR = 0,
+               OFFSET_MONTH = 2,
+               OFFSET_DAY = 3,
+               OFFSET_HOUR = 4,
+               OFFSET_MINUTE = 5,
+               OFFSET_SECOND = 6,
+               OFFSET_TIME_ZONE = 7
+            };
+
+            // Type of value read
+            typedef sUniversalTimeAndLocalTimeZone3GPP tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sUniversalTimeAndLocalTimeZone3GPP()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sUniversalTimeAndLocalTimeZone3GPP( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Year
+            bool GetYear( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView, OFFSET_YEAR, value );
+            };
+
+            // (Inline) Return Month
+            bool GetMonth( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView, OFFSET_MONTH, value );
+            };
+
+            // (Inline) Return Day
+            bool GetDay( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView, OFFSET_DAY, value );
+            };
+
+            // (Inline) Return Hour
+            bool GetHour( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView, OFFSET_HOUR, value );
+            };
+
+            // (Inline) Return Minute
+            bool GetMinute( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView, OFFSET_MINUTE, value );
+            };
+
+            // (Inline) Return Second
+            bool GetSecond( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView, OFFSET_SECOND, value );
+            };
+
+            // (Inline) Return Time Zone
+            bool GetTimeZone( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_TIME_ZONE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sDetailedServiceStatus (Detailed Service Status)
+      /*=================================================================*/
+      struct sDetailedServiceStatus
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 5 };
+            enum
+            {
+               OFFSET_STATUS = 0,
+               OFFSET_CAPABILITY = 1,
+               OFFSET_HDR_STATUS = 2,
+               OFFSET_HDR_HYBRID = 3,
+               OFFSET_FORBIDDEN = 4
+            };
+
+            // Type of value read
+            typedef sDetailedServiceStatus tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sDetailedServiceStatus()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sDetailedServiceStatus( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Status
+            bool GetStatus( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView, OFFSET_STATUS, value );
+            };
+
+            // (Inline) Return Capability
+            bool GetCapability( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_CAPABILITY,
+                                               value );
+            };
+
+            // (Inline) Return HDR Status
+            bool GetHDRStatus( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_HDR_STATUS,
+                                               value );
+            };
+
+            // (Inline) Return HDR Hybrid
+            bool GetHDRHybrid( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_HDR_HYBRID,
+                                               value );
+            };
+
+            // (Inline) Return Forbidden
+            bool GetForbidden( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_FORBIDDEN,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sCDMASystemInfo (CDMA System Info)
+      /*=================================================================*/
+      struct sCDMASystemInfo
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 3 };
+            enum
+            {
+               OFFSET_MCC = 0,
+               OFFSET_IMSI_11_12 = 2
+            };
+
+            // Type of value read
+            typedef sCDMASystemInfo tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sCDMASystemInfo()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sCDMASystemInfo( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return MCC
+            bool GetMCC( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView, OFFSET_MCC, value );
+            };
+
+            // (Inline) Return IMSI_11_12
+            bool GetIMSI1112( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_IMSI_11_12,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sCallBarringStatus (Call Barring Status)
+      /*=================================================================*/
+      struct sCallBarringStatus
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 8 };
+            enum
+            {
+               OFFSET_CS_STATUS = 0,
+               OFFSET_PS_STATUS = 4
+            };
+
+            // Type of value read
+            typedef sCallBarringStatus tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sCallBarringStatus()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sCallBarringStatus( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return CS Status
+            bool GetCSStatus( LONG & value ) const
+            {
+               return sQMIInt <LONG, 4>::Read( mView,
+                                               OFFSET_CS_STATUS,
+                                               value );
+            };
+
+            // (Inline) Return PS Status
+            bool GetPSStatus( LONG & value ) const
+            {
+               return sQMIInt <LONG, 4>::Read( mView,
+                                               OFFSET_PS_STATUS,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sMNCPCSDigitIncludeStatus (MNC PCS Digit Include Status)
+      /*=================================================================*/
+      struct sMNCPCSDigitIncludeStatus
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 5 };
+            enum
+            {
+               OFFSET_MCC = 0,
+               OFFSET_MNC = 2,
+               OFFSET_INCLUDES_PCS_DIGIT = 4
+            };
+
+            // Type of value read
+            typedef sMNCPCSDigitIncludeStatus tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sMNCPCSDigitIncludeStatus()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sMNCPCSDigitIncludeStatus( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return MCC
+            bool GetMCC( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView, OFFSET_MCC, value );
+            };
+
+            // (Inline) Return MNC
+            bool GetMNC( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView, OFFSET_MNC, value );
+            };
+
+            // (Inline) Return Includes PCS Digit
+            bool GetIncludesPCSDigit( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_INCLUDES_PCS_DIGIT,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // (Inline) Constructor (from the TLVs of the message)
+      cQMIViewNASServingSystemInd(
+         const BYTE *               pTLVs,
+         ULONG                      sz )
+         :  cQMIMessageView <cQMIViewNASServingSystemInd, 28>( pTLVs, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Constructor (from a QMI service indication)
+      cQMIViewNASServingSystemInd( const sProtocolBuffer & buf )
+         :  cQMIMessageView <cQMIViewNASServingSystemInd, 28>( buf )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Map a TLV type ID to its slot (-1 if unknown)
+      static int GetSlot( BYTE typeID )
+      {
+         switch (typeID)
+         {
+            case TLV_SERVING_SYSTEM:
+               return 0;
+            case TLV_ROAMING_INDICATOR:
+               return 1;
+            case TLV_DATA_SERVICE_CAPABILITY:
+               return 2;
+            case TLV_CURRENT_PLMN:
+               return 3;
+            case TLV_CDMA_SYSTEM_ID:
+               return 4;
+            case TLV_CDMA_BASE_STATION_INFO:
+               return 5;
+            case TLV_ROAMING_INDICATOR_LIST:
+               return 6;
+            case TLV_DEFAULT_ROAMING_INDICATOR:
+               return 7;
+            case TLV_TIME_ZONE_3GPP2:
+               return 8;
+            case TLV_CDMA_P_REV:
+               return 9;
+            case TLV_PLMN_NAME_FLAG_3GPP:
+               return 10;
+            case TLV_TIME_ZONE_3GPP:
+               return 11;
+            case TLV_DAYLIGHT_SAVING_TIME_ADJUSTMENT_3GPP:
+               return 12;
+            case TLV_UNIVERSAL_TIME_AND_LOCAL_TIME_ZONE_3GPP:
+               return 13;
+            case TLV_LAC_3GPP:
+               return 14;
+            case TLV_CID_3GPP:
+               return 15;
+            case TLV_CONCURRENT_SERVICE_INFO_3GPP2:
+               return 16;
+            case TLV_PRL_INDICATOR_3GPP2:
+               return 17;
+            case TLV_DTM_SUPPORT:
+               return 18;
+            case TLV_DETAILED_SERVICE_STATUS:
+               return 19;
+            case TLV_CDMA_SYSTEM_INFO:
+               return 20;
+            case TLV_HDR_PERSONALITY:
+               return 21;
+            case TLV_LTE_TAC:
+               return 22;
+            case TLV_CALL_BARRING_STATUS:
+               return 23;
+            case TLV_PLMN_NOT_CHANGED_INDICATION:
+               return 24;
+            case TLV_UMTS_PRIMARY_SCRAMBLING_CODE:
+               return 25;
+            case TLV_MNC_PCS_DIGIT_INCLUDE_STATUS:
+               return 26;
+            case TLV_NETWORK_NAME_SOURCE:
+               return 27;
+         }
+
+         return -1;
+      };
+
+      // (Inline) Return Serving System
+      bool GetServingSystem( sServingSystem & value ) const
+      {
+         return sServingSystem::Read( mTLVs[0], 0, value );
+      };
+
+      // (Inline) Return Roaming Indicator
+      bool GetRoamingIndicator( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[1], 0, value );
+      };
+
+      // (Inline) Return Data Service Capability
+      bool GetDataServiceCapability( tDataServiceCapability & value ) const
+      {
+         return tDataServiceCapability::Read( mTLVs[2], 0, value );
+      };
+
+      // (Inline) Return Current PLMN
+      bool GetCurrentPLMN( sCurrentPLMN & value ) const
+      {
+         return sCurrentPLMN::Read( mTLVs[3], 0, value );
+      };
+
+      // (Inline) Return CDMA System ID
+      bool GetCDMASystemID( sCDMASystemID & value ) const
+      {
+         return sCDMASystemID::Read( mTLVs[4], 0, value );
+      };
+
+      // (Inline) Return CDMA Base Station Info
+      bool GetCDMABaseStationInfo( sCDMABaseStationInfo & value ) const
+      {
+         return sCDMABaseStationInfo::Read( mTLVs[5], 0, value );
+      };
+
+      // (Inline) Return Roaming Indicator List
+      bool GetRoamingIndicatorList( tRoamingIndicatorList & value ) const
+      {
+         return tRoamingIndicatorList::Read( mTLVs[6], 0, value );
+      };
+
+      // (Inline) Return Default Roaming Indicator
+      bool GetDefaultRoamingIndicator( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[7], 0, value );
+      };
+
+      // (Inline) Return Time Zone 3GPP2
+      bool GetTimeZone3GPP2( sTimeZone3GPP2 & value ) const
+      {
+         return sTimeZone3GPP2::Read( mTLVs[8], 0, value );
+      };
+
+      // (Inline) Return CDMA P Rev
+      bool GetCDMAPRev( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[9], 0, value );
+      };
+
+      // (Inline) Return PLMN Name Flag 3GPP
+      bool GetPLMNNameFlag3GPP( INT8 & value ) const
+      {
+         return sQMIInt <INT8, 1>::Read( mTLVs[10], 0, value );
+      };
+
+      // (Inline) Return Time Zone 3GPP
+      bool GetTimeZone3GPP( INT8 & value ) const
+      {
+         return sQMIInt <INT8, 1>::Read( mTLVs[11], 0, value );
+      };
+
+      // (Inline) Return Daylight Saving Time Adjustment 3GPP
+      bool GetDaylightSavingTimeAdjustment3GPP( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[12], 0, value );
+      };
+
+      // (Inline) Return Universal Time and Local Time Zone 3GPP
+      bool GetUniversalTimeAndLocalTimeZone3GPP( sUniversalTimeAndLocalTimeZone3GPP & value ) const
+      {
+         return sUniversalTimeAndLocalTimeZone3GPP::Read( mTLVs[13],
+                                                          0,
+                                                          value );
+      };
+
+      // (Inline) Return LAC 3GPP
+      bool GetLAC3GPP( WORD & value ) const
+      {
+         return sQMIInt <WORD, 2>::Read( mTLVs[14], 0, value );
+      };
+
+      // (Inline) Return CID 3GPP
+      bool GetCID3GPP( ULONG & value ) const
+      {
+         return sQMIInt <ULONG, 4>::Read( mTLVs[15], 0, value );
+      };
+
+      // (Inline) Return Concurrent Service Info 3GPP2
+      bool GetConcurrentServiceInfo3GPP2( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[16], 0, value );
+      };
+
+      // (Inline) Return PRL Indicator 3GPP2
+      bool GetPRLIndicator3GPP2( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[17], 0, value );
+      };
+
+      // (Inline) Return DTM Support
+      bool GetDTMSupport( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[18], 0, value );
+      };
+
+      // (Inline) Return Detailed Service Status
+      bool GetDetailedServiceStatus( sDetailedServiceStatus & value ) const
+      {
+         return sDetailedServiceStatus::Read( mTLVs[19], 0, value );
+      };
+
+      // (Inline) Return CDMA System Info
+      bool GetCDMASystemInfo( sCDMASystemInfo & value ) const
+      {
+         return sCDMASystemInfo::Read( mTLVs[20], 0, value );
+      };
+
+      // (Inline) Return HDR Personality
+      bool GetHDRPersonality( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[21], 0, value );
+      };
+
+      // (Inline) Return LTE TAC
+      bool GetLTETAC( WORD & value ) const
+      {
+         return sQMIInt <WORD, 2>::Read( mTLVs[22], 0, value );
+      };
+
+      // (Inline) Return Call Barring Status
+      bool GetCallBarringStatus( sCallBarringStatus & value ) const
+      {
+         return sCallBarringStatus::Read( mTLVs[23], 0, value );
+      };
+
+      // (Inline) Return PLMN Not Changed Indication
+      bool GetPLMNNotChangedIndication( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[24], 0, value );
+      };
+
+      // (Inline) Return UMTS Primary Scrambling Code
+      bool GetUMTSPrimaryScramblingCode( WORD & value ) const
+      {
+         return sQMIInt <WORD, 2>::Read( mTLVs[25], 0, value );
+      };
+
+      // (Inline) Return MNC PCS Digit Include Status
+      bool GetMNCPCSDigitIncludeStatus( sMNCPCSDigitIncludeStatus & value ) const
+      {
+         return sMNCPCSDigitIncludeStatus::Read( mTLVs[26], 0, value );
+      };
+
+      // (Inline) Return Network Name Source
+      bool GetNetworkNameSource( ULONG & value ) const
+      {
+         return sQMIInt <ULONG, 4>::Read( mTLVs[27], 0, value );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIWriterNASGetHomeNetworkReq
+//    Writer of the NAS Get Home Network request
+/*=========================================================================*/
+class cQMIWriterNASGetHomeNetworkReq : public cQMIMessageWriter
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0025 };
+
+      // (Inline) Constructor
+      cQMIWriterNASGetHomeNetworkReq(
+         BYTE *                     pBuffer,
+         ULONG                      sz )
+         :  cQMIMessageWriter( pBuffer, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Build the QMI request from the encoded TLVs
+      sSharedBuffer * BuildRequest() const
+      {
+         return cQMIMessageWriter::BuildRequest( eQMI_SVC_NAS,
+                                                (WORD)MESSAGE_ID );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIViewNASGetHomeNetworkRsp
+//    View of the NAS Get Home Network response
+/*=========================================================================*/
+class cQMIViewNASGetHomeNetworkRsp : public cQMIMessageView <cQMIViewNASGetHomeNetworkRsp, 6>
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0025 };
+
+      // TLV type IDs
+      enum
+      {
+         TLV_RESULT = 0x02,
+         TLV_HOME_NETWORK = 0x01,
+         TLV_HOME_SYSTEM_ID = 0x10,
+         TLV_HOME_NETWORK_3GPP2_EXT = 0x11,
+         TLV_HOME_NETWORK_3GPP_MNC = 0x12,
+         TLV_NETWORK_NAME_SOURCE = 0x13
+      };
+
+      /*=================================================================*/
+      // Struct sResult (Result)
+      /*=================================================================*/
+      struct sResult
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 4 };
+            enum
+            {
+               OFFSET_ERROR_STATUS = 0,
+               OFFSET_ERROR_CODE = 2
+            };
+
+            // Type of value read
+            typedef sResult tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sResult()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sResult( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Error Status
+            bool GetErrorStatus( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_STATUS,
+                                               value );
+            };
+
+            // (Inline) Return Error Code
+            bool GetErrorCode( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_CODE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sHomeNetwork (Home Network)
+      /*=================================================================*/
+      struct sHomeNetwork
+      {
+         public:
+            // Compile time size (variable)/offsets of the fields
+            enum { FIXED_SIZE = 0 };
+            enum
+            {
+               OFFSET_MCC = 0,
+               OFFSET_MNC = 2,
+               OFFSET_DESCRIPTION = 4
+            };
+
+            // Type of value read
+            typedef sHomeNetwork tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sHomeNetwork()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sHomeNetwork( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = 0;
+
+               ULONG start = offset;
+               ULONG fieldSz = 0;
+               offset += 4;
+               if (sQMIString <1>::Measure( in, offset, fieldSz ) == false)
+               {
+                  return false;
+               }
+
+               offset += fieldSz;
+
+               sz = offset - start;
+               return in.Has( start, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return MCC
+            bool GetMCC( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView, OFFSET_MCC, value );
+            };
+
+            // (Inline) Return MNC
+            bool GetMNC( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView, OFFSET_MNC, value );
+            };
+
+            // (Inline) Return Description
+            bool GetDescription( sQMIView & value ) const
+            {
+               return sQMIString <1>::Read( mView, OFFSET_DESCRIPTION, value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sHomeSystemID (Home System ID)
+      /*=================================================================*/
+      struct sHomeSystemID
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 4 };
+            enum
+            {
+               OFFSET_SID = 0,
+               OFFSET_NID = 2
+            };
+
+            // Type of value read
+            typedef sHomeSystemID tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sHomeSystemID()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sHomeSystemID( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return SID
+            bool GetSID( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView, OFFSET_SID, value );
+            };
+
+            // (Inline) Return NID
+            bool GetNID( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView, OFFSET_NID, value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // Array view of Home Network 3GPP2 Ext Description
+      typedef cQMIArrayView <sQMIInt <BYTE, 1>, 1> tHomeNetwork3GPP2ExtDescription;
+
+      /*=================================================================*/
+      // Struct sHomeNetwork3GPP2Ext (Home Network 3GPP2 Ext)
+      /*=================================================================*/
+      struct sHomeNetwork3GPP2Ext
+      {
+         public:
+            // Compile time size (variable)/offsets of the fields
+            enum { FIXED_SIZE = 0 };
+            enum
+            {
+               OFFSET_MCC = 0,
+               OFFSET_MNC = 2,
+               OFFSET_DISPLAY_DESCRIPTION = 4,
+               OFFSET_DESCRIPTION_ENCODING = 5,
+               OFFSET_DESCRIPTION = 6
+            };
+
+            // Type of value read
+            typedef sHomeNetwork3GPP2Ext tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sHomeNetwork3GPP2Ext()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sHomeNetwork3GPP2Ext( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = 0;
+
+               ULONG start = offset;
+               ULONG fieldSz = 0;
+               offset += 6;
+               if (tHomeNetwork3GPP2ExtDescription::Measure( in, offset, fieldSz ) == false)
+               {
+                  return false;
+               }
+
+               offset += fieldSz;
+
+               sz = offset - start;
+               return in.Has( start, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return MCC
+            bool GetMCC( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView, OFFSET_MCC, value );
+            };
+
+            // (Inline) Return MNC
+            bool GetMNC( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView, OFFSET_MNC, value );
+            };
+
+            // (Inline) Return Display Description
+            bool GetDisplayDescription( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_DISPLAY_DESCRIPTION,
+                                               value );
+            };
+
+            // (Inline) Return Description Encoding
+            bool GetDescriptionEncoding( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_DESCRIPTION_ENCODING,
+                                               value );
+            };
+
+            // (Inline) Return Description
+            bool GetDescription( tHomeNetwork3GPP2ExtDescription & value ) const
+            {
+               return tHomeNetwork3GPP2ExtDescription::Read( mView,
+                                                             OFFSET_DESCRIPTION,
+                                                             value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sHomeNetwork3GPPMNC (Home Network 3GPP MNC)
+      /*=================================================================*/
+      struct sHomeNetwork3GPPMNC
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 2 };
+            enum
+            {
+               OFFSET_IS_3GPP = 0,
+               OFFSET_INCLUDES_PCS_DIGIT = 1
+            };
+
+            // Type of value read
+            typedef sHomeNetwork3GPPMNC tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sHomeNetwork3GPPMNC()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sHomeNetwork3GPPMNC( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Is 3GPP
+            bool GetIs3GPP( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView, OFFSET_IS_3GPP, value );
+            };
+
+            // (Inline) Return Includes PCS Digit
+            bool GetIncludesPCSDigit( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_INCLUDES_PCS_DIGIT,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // (Inline) Constructor (from the TLVs of the message)
+      cQMIViewNASGetHomeNetworkRsp(
+         const BYTE *               pTLVs,
+         ULONG                      sz )
+         :  cQMIMessageView <cQMIViewNASGetHomeNetworkRsp, 6>( pTLVs, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Constructor (from a QMI service response)
+      cQMIViewNASGetHomeNetworkRsp( const sProtocolBuffer & buf )
+         :  cQMIMessageView <cQMIViewNASGetHomeNetworkRsp, 6>( buf )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Map a TLV type ID to its slot (-1 if unknown)
+      static int GetSlot( BYTE typeID )
+      {
+         switch (typeID)
+         {
+            case TLV_RESULT:
+               return 0;
+            case TLV_HOME_NETWORK:
+               return 1;
+            case TLV_HOME_SYSTEM_ID:
+               return 2;
+            case TLV_HOME_NETWORK_3GPP2_EXT:
+               return 3;
+            case TLV_HOME_NETWORK_3GPP_MNC:
+               return 4;
+            case TLV_NETWORK_NAME_SOURCE:
+               return 5;
+         }
+
+         return -1;
+      };
+
+      // (Inline) Return Result
+      bool GetResult( sResult & value ) const
+      {
+         return sResult::Read( mTLVs[0], 0, value );
+      };
+
+      // (Inline) Return contents of mandatory result content
+      bool GetResult(
+         ULONG &                    returnCode,
+         ULONG &                    errorCode ) const
+      {
+         sResult result;
+         WORD rc = 0;
+         WORD ec = 0;
+         if ( (GetResult( result ) == false)
+         ||   (result.GetErrorStatus( rc ) == false)
+         ||   (result.GetErrorCode( ec ) == false) )
+         {
+            return false;
+         }
+
+         returnCode = (ULONG)rc;
+         errorCode = (ULONG)ec;
+         return true;
+      };
+
+      // (Inline) Return Home Network
+      bool GetHomeNetwork( sHomeNetwork & value ) const
+      {
+         return sHomeNetwork::Read( mTLVs[1], 0, value );
+      };
+
+      // (Inline) Return Home System ID
+      bool GetHomeSystemID( sHomeSystemID & value ) const
+      {
+         return sHomeSystemID::Read( mTLVs[2], 0, value );
+      };
+
+      // (Inline) Return Home Network 3GPP2 Ext
+      bool GetHomeNetwork3GPP2Ext( sHomeNetwork3GPP2Ext & value ) const
+      {
+         return sHomeNetwork3GPP2Ext::Read( mTLVs[3], 0, value );
+      };
+
+      // (Inline) Return Home Network 3GPP MNC
+      bool GetHomeNetwork3GPPMNC( sHomeNetwork3GPPMNC & value ) const
+      {
+         return sHomeNetwork3GPPMNC::Read( mTLVs[4], 0, value );
+      };
+
+      // (Inline) Return Network Name Source
+      bool GetNetworkNameSource( ULONG & value ) const
+      {
+         return sQMIInt <ULONG, 4>::Read( mTLVs[5], 0, value );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIWriterNASGetTechnologyPreferenceReq
+//    Writer of the NAS Get Technology Preference request
+/*=========================================================================*/
+class cQMIWriterNASGetTechnologyPreferenceReq : public cQMIMessageWriter
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x002B };
+
+      // (Inline) Constructor
+      cQMIWriterNASGetTechnologyPreferenceReq(
+         BYTE *                     pBuffer,
+         ULONG                      sz )
+         :  cQMIMessageWriter( pBuffer, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Build the QMI request from the encoded TLVs
+      sSharedBuffer * BuildRequest() const
+      {
+         return cQMIMessageWriter::BuildRequest( eQMI_SVC_NAS,
+                                                (WORD)MESSAGE_ID );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIViewNASGetTechnologyPreferenceRsp
+//    View of the NAS Get Technology Preference response
+/*=========================================================================*/
+class cQMIViewNASGetTechnologyPreferenceRsp : public cQMIMessageView <cQMIViewNASGetTechnologyPreferenceRsp, 3>
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x002B };
+
+      // TLV type IDs
+      enum
+      {
+         TLV_RESULT = 0x02,
+         TLV_ACTIVE = 0x01,
+         TLV_PERSISTENT = 0x10
+      };
+
+      /*=================================================================*/
+      // Struct sResult (Result)
+      /*=================================================================*/
+      struct sResult
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 4 };
+            enum
+            {
+               OFFSET_ERROR_STATUS = 0,
+               OFFSET_ERROR_CODE = 2
+            };
+
+            // Type of value read
+            typedef sResult tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sResult()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sResult( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Error Status
+            bool GetErrorStatus( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_STATUS,
+                                               value );
+            };
+
+            // (Inline) Return Error Code
+            bool GetErrorCode( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_CODE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sActive (Active)
+      /*=================================================================*/
+      struct sActive
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 3 };
+            enum
+            {
+               OFFSET_TECHNOLOGY_PREFERENCE = 0,
+               OFFSET_TECHNOLOGY_PREFERENCE_DURATION = 2
+            };
+
+            // Type of value read
+            typedef sActive tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sActive()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sActive( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Technology Preference
+            bool GetTechnologyPreference( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_TECHNOLOGY_PREFERENCE,
+                                               value );
+            };
+
+            // (Inline) Return Technology Preference Duration
+            bool GetTechnologyPreferenceDuration( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_TECHNOLOGY_PREFERENCE_DURATION,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // (Inline) Constructor (from the TLVs of the message)
+      cQMIViewNASGetTechnologyPreferenceRsp(
+         const BYTE *               pTLVs,
+         ULONG                      sz )
+         :  cQMIMessageView <cQMIViewNASGetTechnologyPreferenceRsp, 3>( pTLVs, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Constructor (from a QMI service response)
+      cQMIViewNASGetTechnologyPreferenceRsp( const sProtocolBuffer & buf )
+         :  cQMIMessageView <cQMIViewNASGetTechnologyPreferenceRsp, 3>( buf )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Map a TLV type ID to its slot (-1 if unknown)
+      static int GetSlot( BYTE typeID )
+      {
+         switch (typeID)
+         {
+            case TLV_RESULT:
+               return 0;
+            case TLV_ACTIVE:
+               return 1;
+            case TLV_PERSISTENT:
+               return 2;
+         }
+
+         return -1;
+      };
+
+      // (Inline) Return Result
+      bool GetResult( sResult & value ) const
+      {
+         return sResult::Read( mTLVs[0], 0, value );
+      };
+
+      // (Inline) Return contents of mandatory result content
+      bool GetResult(
+         ULONG &                    returnCode,
+         ULONG &                    errorCode ) const
+      {
+         sResult result;
+         WORD rc = 0;
+         WORD ec = 0;
+         if ( (GetResult( result ) == false)
+         ||   (result.GetErrorStatus( rc ) == false)
+         ||   (result.GetErrorCode( ec ) == false) )
+         {
+            return false;
+         }
+
+         returnCode = (ULONG)rc;
+         errorCode = (ULONG)ec;
+         return true;
+      };
+
+      // (Inline) Return Active
+      bool GetActive( sActive & value ) const
+      {
+         return sActive::Read( mTLVs[1], 0, value );
+      };
+
+      // (Inline) Return Persistent
+      bool GetPersistent( WORD & value ) const
+      {
+         return sQMIInt <WORD, 2>::Read( mTLVs[2], 0, value );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIWriterNASGetRFBandInformationReq
+//    Writer of the NAS Get RF Band Information request
+/*=========================================================================*/
+class cQMIWriterNASGetRFBandInformationReq : public cQMIMessageWriter
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0031 };
+
+      // (Inline) Constructor
+      cQMIWriterNASGetRFBandInformationReq(
+         BYTE *                     pBuffer,
+         ULONG                      sz )
+         :  cQMIMessageWriter( pBuffer, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Build the QMI request from the encoded TLVs
+      sSharedBuffer * BuildRequest() const
+      {
+         return cQMIMessageWriter::BuildRequest( eQMI_SVC_NAS,
+                                                (WORD)MESSAGE_ID );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIViewNASGetRFBandInformationRsp
+//    View of the NAS Get RF Band Information response
+/*=========================================================================*/
+class cQMIViewNASGetRFBandInformationRsp : public cQMIMessageView <cQMIViewNASGetRFBandInformationRsp, 4>
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0031 };
+
+      // TLV type IDs
+      enum
+      {
+         TLV_RESULT = 0x02,
+         TLV_LIST = 0x01,
+         TLV_EXTENDED_LIST = 0x11,
+         TLV_BANDWIDTH_LIST = 0x12
+      };
+
+      /*=================================================================*/
+      // Struct sResult (Result)
+      /*=================================================================*/
+      struct sResult
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 4 };
+            enum
+            {
+               OFFSET_ERROR_STATUS = 0,
+               OFFSET_ERROR_CODE = 2
+            };
+
+            // Type of value read
+            typedef sResult tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sResult()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sResult( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Error Status
+            bool GetErrorStatus( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_STATUS,
+                                               value );
+            };
+
+            // (Inline) Return Error Code
+            bool GetErrorCode( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_CODE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sListElement (List Element)
+      /*=================================================================*/
+      struct sListElement
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 5 };
+            enum
+            {
+               OFFSET_RADIO_INTERFACE = 0,
+               OFFSET_ACTIVE_BAND_CLASS = 1,
+               OFFSET_ACTIVE_CHANNEL = 3
+            };
+
+            // Type of value read
+            typedef sListElement tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sListElement()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sListElement( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Radio Interface
+            bool GetRadioInterface( INT8 & value ) const
+            {
+               return sQMIInt <INT8, 1>::Read( mView,
+                                               OFFSET_RADIO_INTERFACE,
+                                               value );
+            };
+
+            // (Inline) Return Active Band Class
+            bool GetActiveBandClass( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ACTIVE_BAND_CLASS,
+                                               value );
+            };
+
+            // (Inline) Return Active Channel
+            bool GetActiveChannel( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ACTIVE_CHANNEL,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // Array view of List
+      typedef cQMIArrayView <sListElement, 1> tList;
+
+      /*=================================================================*/
+      // Struct sExtendedListElement (Extended List Element)
+      /*=================================================================*/
+      struct sExtendedListElement
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 7 };
+            enum
+            {
+               OFFSET_RADIO_INTERFACE = 0,
+               OFFSET_ACTIVE_BAND_CLASS = 1,
+               OFFSET_ACTIVE_CHANNEL = 3
+            };
+
+            // Type of value read
+            typedef sExtendedListElement tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sExtendedListElement()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sExtendedListElement( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Radio Interface
+            bool GetRadioInterface( INT8 & value ) const
+            {
+               return sQMIInt <INT8, 1>::Read( mView,
+                                               OFFSET_RADIO_INTERFACE,
+                                               value );
+            };
+
+            // (Inline) Return Active Band Class
+            bool GetActiveBandClass( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ACTIVE_BAND_CLASS,
+                                               value );
+            };
+
+            // (Inline) Return Active Channel
+            bool GetActiveChannel( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_ACTIVE_CHANNEL,
+                                                value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // Array view of Extended List
+      typedef cQMIArrayView <sExtendedListElement, 1> tExtendedList;
+
+      /*=================================================================*/
+      // Struct sBandwidthListElement (Bandwidth List Element)
+      /*=================================================================*/
+      struct sBandwidthListElement
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 5 };
+            enum
+            {
+               OFFSET_RADIO_INTERFACE = 0,
+               OFFSET_BANDWIDTH = 1
+            };
+
+            // Type of value read
+            typedef sBandwidthListElement tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sBandwidthListElement()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sBandwidthListElement( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Radio Interface
+            bool GetRadioInterface( INT8 & value ) const
+            {
+               return sQMIInt <INT8, 1>::Read( mView,
+                                               OFFSET_RADIO_INTERFACE,
+                                               value );
+            };
+
+            // (Inline) Return Bandwidth
+            bool GetBandwidth( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_BANDWIDTH,
+                                                value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // Array view of Bandwidth List
+      typedef cQMIArrayView <sBandwidthListElement, 1> tBandwidthList;
+
+      // (Inline) Constructor (from the TLVs of the message)
+      cQMIViewNASGetRFBandInformationRsp(
+         const BYTE *               pTLVs,
+         ULONG                      sz )
+         :  cQMIMessageView <cQMIViewNASGetRFBandInformationRsp, 4>( pTLVs, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Constructor (from a QMI service response)
+      cQMIViewNASGetRFBandInformationRsp( const sProtocolBuffer & buf )
+         :  cQMIMessageView <cQMIViewNASGetRFBandInformationRsp, 4>( buf )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Map a TLV type ID to its slot (-1 if unknown)
+      static int GetSlot( BYTE typeID )
+      {
+         switch (typeID)
+         {
+            case TLV_RESULT:
+               return 0;
+            case TLV_LIST:
+               return 1;
+            case TLV_EXTENDED_LIST:
+               return 2;
+            case TLV_BANDWIDTH_LIST:
+               return 3;
+         }
+
+         return -1;
+      };
+
+      // (Inline) Return Result
+      bool GetResult( sResult & value ) const
+      {
+         return sResult::Read( mTLVs[0], 0, value );
+      };
+
+      // (Inline) Return contents of mandatory result content
+      bool GetResult(
+         ULONG &                    returnCode,
+         ULONG &                    errorCode ) const
+      {
+         sResult result;
+         WORD rc = 0;
+         WORD ec = 0;
+         if ( (GetResult( result ) == false)
+         ||   (result.GetErrorStatus( rc ) == false)
+         ||   (result.GetErrorCode( ec ) == false) )
+         {
+            return false;
+         }
+
+         returnCode = (ULONG)rc;
+         errorCode = (ULONG)ec;
+         return true;
+      };
+
+      // (Inline) Return List
+      bool GetList( tList & value ) const
+      {
+         return tList::Read( mTLVs[1], 0, value );
+      };
+
+      // (Inline) Return Extended List
+      bool GetExtendedList( tExtendedList & value ) const
+      {
+         return tExtendedList::Read( mTLVs[2], 0, value );
+      };
+
+      // (Inline) Return Bandwidth List
+      bool GetBandwidthList( tBandwidthList & value ) const
+      {
+         return tBandwidthList::Read( mTLVs[3], 0, value );
+      };
+};
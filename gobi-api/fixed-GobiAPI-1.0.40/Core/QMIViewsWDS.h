@@ -0,0 +1,6316 @@
+/*===========================================================================
+FILE:
+   QMIViewsWDS.h
+
+DESCRIPTION:
+   Static views of the (collected) QMI WDS messages
+
+PUBLIC CLASSES AND METHODS:
+   cQMIViewWDSEventReportInd
+   cQMIWriterWDSGetPacketServiceStatusReq
+   cQMIViewWDSGetPacketServiceStatusRsp
+   cQMIViewWDSPacketServiceStatusInd
+   cQMIWriterWDSGetChannelRatesReq
+   cQMIViewWDSGetChannelRatesRsp
+   cQMIWriterWDSGetPacketStatisticsReq
+   cQMIViewWDSGetPacketStatisticsRsp
+   cQMIWriterWDSModifyProfileReq
+   cQMIViewWDSModifyProfileRsp
+   cQMIWriterWDSGetProfileListReq
+   cQMIViewWDSGetProfileListRsp
+   cQMIWriterWDSGetProfileSettingsReq
+   cQMIViewWDSGetProfileSettingsRsp
+   cQMIWriterWDSGetCurrentSettingsReq
+   cQMIViewWDSGetCurrentSettingsRsp
+   cQMIWriterWDSGetDormancyStatusReq
+   cQMIViewWDSGetDormancyStatusRsp
+   cQMIWriterWDSGetAutoconnectSettingsReq
+   cQMIViewWDSGetAutoconnectSettingsRsp
+   cQMIWriterWDSGetDataBearerTechnologyReq
+   cQMIViewWDSGetDataBearerTechnologyRsp
+
+   NOTE:
+      Generated by build-aux/qmi-codegen from qmi-service-wds.json, do not
+      edit.  To regenerate run (from the top of the source tree):
+
+         build-aux/qmi-codegen/qmi-codegen --cxx-views \
+            --input data/qmi-service-wds.json \
+            --include data/qmi-common.json \
+            --collection data/qmi-collection-gobi-views.json \
+            --output <Core directory>/QMIViewsWDS
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Pragmas
+//---------------------------------------------------------------------------
+#pragma once
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "QMIView.h"
+
+/*=========================================================================*/
+// Class cQMIViewWDSEventReportInd
+//    View of the WDS Event Report indication
+/*=========================================================================*/
+class cQMIViewWDSEventReportInd : public cQMIMessageView <cQMIViewWDSEventReportInd, 24>
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0001 };
+
+      // TLV type IDs
+      enum
+      {
+         TLV_TX_PACKETS_OK = 0x10,
+         TLV_RX_PACKETS_OK = 0x11,
+         TLV_TX_PACKETS_ERROR = 0x12,
+         TLV_RX_PACKETS_ERROR = 0x13,
+         TLV_TX_OVERFLOWS = 0x14,
+         TLV_RX_OVERFLOWS = 0x15,
+         TLV_CHANNEL_RATES = 0x16,
+         TLV_DATA_BEARER_TECHNOLOGY = 0x17,
+         TLV_DORMANCY_STATUS = 0x18,
+         TLV_TX_BYTES_OK = 0x19,
+         TLV_RX_BYTES_OK = 0x1A,
+         TLV_MIP_STATUS = 0x1B,
+         TLV_CURRENT_DATA_BEARER_TECHNOLOGY = 0x1D,
+         TLV_DATA_CALL_STATUS = 0x1F,
+         TLV_PREFERRED_DATA_SYSTEM = 0x20,
+         TLV_DATA_CALL_TYPE = 0x22,
+         TLV_EVDO_PAGE_MONITOR_PERIOD_CHANGE = 0x23,
+         TLV_DATA_SYSTEMS = 0x24,
+         TLV_TX_PACKETS_DROPPED = 0x25,
+         TLV_RX_PACKETS_DROPPED = 0x26,
+         TLV_UPLINK_FLOW_CONTROL_ENABLED = 0x27,
+         TLV_DATA_CALL_ADDRESS_FAMILY = 0x28,
+         TLV_PDN_FILTERS_REMOVED = 0x29,
+         TLV_EXTENDED_DATA_BEARER_TECHNOLOGY = 0x2A
+      };
+
+      /*=================================================================*/
+      // Struct sChannelRates (Channel Rates)
+      /*=================================================================*/
+      struct sChannelRates
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 8 };
+            enum
+            {
+               OFFSET_TX_RATE_BPS = 0,
+               OFFSET_RX_RATE_BPS = 4
+            };
+
+            // Type of value read
+            typedef sChannelRates tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sChannelRates()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sChannelRates( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Tx Rate BPS
+            bool GetTxRateBPS( LONG & value ) const
+            {
+               return sQMIInt <LONG, 4>::Read( mView,
+                                               OFFSET_TX_RATE_BPS,
+                                               value );
+            };
+
+            // (Inline) Return Rx Rate BPS
+            bool GetRxRateBPS( LONG & value ) const
+            {
+               return sQMIInt <LONG, 4>::Read( mView,
+                                               OFFSET_RX_RATE_BPS,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sCurrentDataBearerTechnology (Current Data Bearer Technology)
+      /*=================================================================*/
+      struct sCurrentDataBearerTechnology
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 9 };
+            enum
+            {
+               OFFSET_NETWORK_TYPE = 0,
+               OFFSET_RAT_MASK = 1,
+               OFFSET_SO_MASK = 5
+            };
+
+            // Type of value read
+            typedef sCurrentDataBearerTechnology tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sCurrentDataBearerTechnology()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sCurrentDataBearerTechnology( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Network Type
+            bool GetNetworkType( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_NETWORK_TYPE,
+                                               value );
+            };
+
+            // (Inline) Return RAT Mask
+            bool GetRATMask( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_RAT_MASK,
+                                                value );
+            };
+
+            // (Inline) Return SO Mask
+            bool GetSOMask( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView, OFFSET_SO_MASK, value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sDataCallType (Data Call Type)
+      /*=================================================================*/
+      struct sDataCallType
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 2 };
+            enum
+            {
+               OFFSET_DATA_CALL_TYPE = 0,
+               OFFSET_TETHERED_CALL_TYPE = 1
+            };
+
+            // Type of value read
+            typedef sDataCallType tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sDataCallType()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sDataCallType( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Data Call Type
+            bool GetDataCallType( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_DATA_CALL_TYPE,
+                                               value );
+            };
+
+            // (Inline) Return Tethered Call Type
+            bool GetTetheredCallType( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_TETHERED_CALL_TYPE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sEVDOPageMonitorPeriodChange (EVDO Page Monitor Period Change)
+      /*=================================================================*/
+      struct sEVDOPageMonitorPeriodChange
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 2 };
+            enum
+            {
+               OFFSET_PERIOD_CHANGE = 0,
+               OFFSET_FORCE_LONG_SLEEP = 1
+            };
+
+            // Type of value read
+            typedef sEVDOPageMonitorPeriodChange tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sEVDOPageMonitorPeriodChange()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sEVDOPageMonitorPeriodChange( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Period Change
+            bool GetPeriodChange( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_PERIOD_CHANGE,
+                                               value );
+            };
+
+            // (Inline) Return Force Long Sleep
+            bool GetForceLongSleep( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_FORCE_LONG_SLEEP,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sDataSystemsNetworksElement (Data Systems Networks Element)
+      /*=================================================================*/
+      struct sDataSystemsNetworksElement
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 9 };
+            enum
+            {
+               OFFSET_NETWORK_TYPE = 0,
+               OFFSET_RAT_MASK = 1,
+               OFFSET_SO_MASK = 5
+            };
+
+            // Type of value read
+            typedef sDataSystemsNetworksElement tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sDataSystemsNetworksElement()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sDataSystemsNetworksElement( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Network Type
+            bool GetNetworkType( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_NETWORK_TYPE,
+                                               value );
+            };
+
+            // (Inline) Return RAT Mask
+            bool GetRATMask( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_RAT_MASK,
+                                                value );
+            };
+
+            // (Inline) Return SO Mask
+            bool GetSOMask( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView, OFFSET_SO_MASK, value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // Array view of Data Systems Networks
+      typedef cQMIArrayView <sDataSystemsNetworksElement, 1> tDataSystemsNetworks;
+
+      /*=================================================================*/
+      // Struct sDataSystems (Data Systems)
+      /*=================================================================*/
+      struct sDataSystems
+      {
+         public:
+            // Compile time size (variable)/offsets of the fields
+            enum { FIXED_SIZE = 0 };
+            enum
+            {
+               OFFSET_PREFERRED_NETWORK_TYPE = 0,
+               OFFSET_NETWORKS = 1
+            };
+
+            // Type of value read
+            typedef sDataSystems tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sDataSystems()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sDataSystems( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = 0;
+
+               ULONG start = offset;
+               ULONG fieldSz = 0;
+               offset += 1;
+               if (tDataSystemsNetworks::Measure( in, offset, fieldSz ) == false)
+               {
+                  return false;
+               }
+
+               offset += fieldSz;
+
+               sz = offset - start;
+               return in.Has( start, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Preferred Network Type
+            bool GetPreferredNetworkType( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_PREFERRED_NETWORK_TYPE,
+                                               value );
+            };
+
+            // (Inline) Return Networks
+            bool GetNetworks( tDataSystemsNetworks & value ) const
+            {
+               return tDataSystemsNetworks::Read( mView,
+                                                  OFFSET_NETWORKS,
+                                                  value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // Array view of PDN Filters Removed PDN Filter Handler
+      typedef cQMIArrayView <sQMIInt <ULONG, 4>, 1> tPDNFiltersRemovedPDNFilterHandler;
+
+      /*=================================================================*/
+      // Struct sPDNFiltersRemoved (PDN Filters Removed)
+      /*=================================================================*/
+      struct sPDNFiltersRemoved
+      {
+         public:
+            // Compile time size (variable)/offsets of the fields
+            enum { FIXED_SIZE = 0 };
+            enum
+            {
+               OFFSET_PDN_FILTER_HANDLER = 0
+            };
+
+            // Type of value read
+            typedef sPDNFiltersRemoved tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sPDNFiltersRemoved()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sPDNFiltersRemoved( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = 0;
+
+               ULONG start = offset;
+               ULONG fieldSz = 0;
+               if (tPDNFiltersRemovedPDNFilterHandler::Measure( in, offset, fieldSz ) == false)
+               {
+                  return false;
+               }
+
+               offset += fieldSz;
+
+               sz = offset - start;
+               return in.Has( start, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return PDN Filter Handler
+            bool GetPDNFilterHandler( tPDNFiltersRemovedPDNFilterHandler & value ) const
+            {
+               return tPDNFiltersRemovedPDNFilterHandler::Read( mView,
+                                                                OFFSET_PDN_FILTER_HANDLER,
+                                                                value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sExtendedDataBearerTechnology (Extended Data Bearer Technology)
+      /*=================================================================*/
+      struct sExtendedDataBearerTechnology
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 16 };
+            enum
+            {
+               OFFSET_DATA_BEARER_TECHNOLOGY = 0,
+               OFFSET_RADIO_ACCESS_TECHNOLOGY = 4,
+               OFFSET_EXTENDED_DATA_BEARER_TECHNOLOGY_3GPP = 8,
+               OFFSET_RESERVED1 = 10,
+               OFFSET_EXTENDED_DATA_BEARER_TECHNOLOGY_3GPP2 = 11,
+               OFFSET_RESERVED2 = 13,
+               OFFSET_RESERVED3 = 14,
+               OFFSET_RESERVED4 = 15
+            };
+
+            // Type of value read
+            typedef sExtendedDataBearerTechnology tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sExtendedDataBearerTechnology()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sExtendedDataBearerTechnology( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Data Bearer Technology
+            bool GetDataBearerTechnology( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_DATA_BEARER_TECHNOLOGY,
+                                                value );
+            };
+
+            // (Inline) Return Radio Access Technology
+            bool GetRadioAccessTechnology( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_RADIO_ACCESS_TECHNOLOGY,
+                                                value );
+            };
+
+            // (Inline) Return Extended Data Bearer Technology 3GPP
+            bool GetExtendedDataBearerTechnology3GPP( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_EXTENDED_DATA_BEARER_TECHNOLOGY_3GPP,
+                                               value );
+            };
+
+            // (Inline) Return Reserved1
+            bool GetReserved1( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_RESERVED1,
+                                               value );
+            };
+
+            // (Inline) Return Extended Data Bearer Technology 3GPP2
+            bool GetExtendedDataBearerTechnology3GPP2( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_EXTENDED_DATA_BEARER_TECHNOLOGY_3GPP2,
+                                               value );
+            };
+
+            // (Inline) Return Reserved2
+            bool GetReserved2( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_RESERVED2,
+                                               value );
+            };
+
+            // (Inline) Return Reserved3
+            bool GetReserved3( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_RESERVED3,
+                                               value );
+            };
+
+            // (Inline) Return Reserved4
+            bool GetReserved4( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_RESERVED4,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // (Inline) Constructor (from the TLVs of the message)
+      cQMIViewWDSEventReportInd(
+         const BYTE *               pTLVs,
+         ULONG                      sz )
+         :  cQMIMessageView <cQMIViewWDSEventReportInd, 24>( pTLVs, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Constructor (from a QMI service indication)
+      cQMIViewWDSEventReportInd( const sProtocolBuffer & buf )
+         :  cQMIMessageView <cQMIViewWDSEventReportInd, 24>( buf )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Map a TLV type ID to its slot (-1 if unknown)
+      static int GetSlot( BYTE typeID )
+      {
+         switch (typeID)
+         {
+            case TLV_TX_PACKETS_OK:
+               return 0;
+            case TLV_RX_PACKETS_OK:
+               return 1;
+            case TLV_TX_PACKETS_ERROR:
+               return 2;
+            case TLV_RX_PACKETS_ERROR:
+               return 3;
+            case TLV_TX_OVERFLOWS:
+               return 4;
+            case TLV_RX_OVERFLOWS:
+               return 5;
+            case TLV_CHANNEL_RATES:
+               return 6;
+            case TLV_DATA_BEARER_TECHNOLOGY:
+               return 7;
+            case TLV_DORMANCY_STATUS:
+               return 8;
+            case TLV_TX_BYTES_OK:
+               return 9;
+            case TLV_RX_BYTES_OK:
+               return 10;
+            case TLV_MIP_STATUS:
+               return 11;
+            case TLV_CURRENT_DATA_BEARER_TECHNOLOGY:
+               return 12;
+            case TLV_DATA_CALL_STATUS:
+               return 13;
+            case TLV_PREFERRED_DATA_SYSTEM:
+               return 14;
+            case TLV_DATA_CALL_TYPE:
+               return 15;
+            case TLV_EVDO_PAGE_MONITOR_PERIOD_CHANGE:
+               return 16;
+            case TLV_DATA_SYSTEMS:
+               return 17;
+            case TLV_TX_PACKETS_DROPPED:
+               return 18;
+            case TLV_RX_PACKETS_DROPPED:
+               return 19;
+            case TLV_UPLINK_FLOW_CONTROL_ENABLED:
+               return 20;
+            case TLV_DATA_CALL_ADDRESS_FAMILY:
+               return 21;
+            case TLV_PDN_FILTERS_REMOVED:
+               return 22;
+            case TLV_EXTENDED_DATA_BEARER_TECHNOLOGY:
+               return 23;
+         }
+
+         return -1;
+      };
+
+      // (Inline) Return Tx Packets Ok
+      bool GetTxPacketsOk( ULONG & value ) const
+      {
+         return sQMIInt <ULONG, 4>::Read( mTLVs[0], 0, value );
+      };
+
+      // (Inline) Return Rx Packets Ok
+      bool GetRxPacketsOk( ULONG & value ) const
+      {
+         return sQMIInt <ULONG, 4>::Read( mTLVs[1], 0, value );
+      };
+
+      // (Inline) Return Tx Packets Error
+      bool GetTxPacketsError( ULONG & value ) const
+      {
+         return sQMIInt <ULONG, 4>::Read( mTLVs[2], 0, value );
+      };
+
+      // (Inline) Return Rx Packets Error
+      bool GetRxPacketsError( ULONG & value ) const
+      {
+         return sQMIInt <ULONG, 4>::Read( mTLVs[3], 0, value );
+      };
+
+      // (Inline) Return Tx Overflows
+      bool GetTxOverflows( ULONG & value ) const
+      {
+         return sQMIInt <ULONG, 4>::Read( mTLVs[4], 0, value );
+      };
+
+      // (Inline) Return Rx Overflows
+      bool GetRxOverflows( ULONG & value ) const
+      {
+         return sQMIInt <ULONG, 4>::Read( mTLVs[5], 0, value );
+      };
+
+      // (Inline) Return Channel Rates
+      bool GetChannelRates( sChannelRates & value ) const
+      {
+         return sChannelRates::Read( mTLVs[6], 0, value );
+      };
+
+      // (Inline) Return Data Bearer Technology
+      bool GetDataBearerTechnology( INT8 & value ) const
+      {
+         return sQMIInt <INT8, 1>::Read( mTLVs[7], 0, value );
+      };
+
+      // (Inline) Return Dormancy Status
+      bool GetDormancyStatus( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[8], 0, value );
+      };
+
+      // (Inline) Return Tx Bytes Ok
+      bool GetTxBytesOk( ULONGLONG & value ) const
+      {
+         return sQMIInt <ULONGLONG, 8>::Read( mTLVs[9], 0, value );
+      };
+
+      // (Inline) Return Rx Bytes Ok
+      bool GetRxBytesOk( ULONGLONG & value ) const
+      {
+         return sQMIInt <ULONGLONG, 8>::Read( mTLVs[10], 0, value );
+      };
+
+      // (Inline) Return MIP Status
+      bool GetMIPStatus( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[11], 0, value );
+      };
+
+      // (Inline) Return Current Data Bearer Technology
+      bool GetCurrentDataBearerTechnology( sCurrentDataBearerTechnology & value ) const
+      {
+         return sCurrentDataBearerTechnology::Read( mTLVs[12], 0, value );
+      };
+
+      // (Inline) Return Data Call Status
+      bool GetDataCallStatus( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[13], 0, value );
+      };
+
+      // (Inline) Return Preferred Data System
+      bool GetPreferredDataSystem( ULONG & value ) const
+      {
+         return sQMIInt <ULONG, 4>::Read( mTLVs[14], 0, value );
+      };
+
+      // (Inline) Return Data Call Type
+      bool GetDataCallType( sDataCallType & value ) const
+      {
+         return sDataCallType::Read( mTLVs[15], 0, value );
+      };
+
+      // (Inline) Return EVDO Page Monitor Period Change
+      bool GetEVDOPageMonitorPeriodChange( sEVDOPageMonitorPeriodChange & value ) const
+      {
+         return sEVDOPageMonitorPeriodChange::Read( mTLVs[16], 0, value );
+      };
+
+      // (Inline) Return Data Systems
+      bool GetDataSystems( sDataSystems & value ) const
+      {
+         return sDataSystems::Read( mTLVs[17], 0, value );
+      };
+
+      // (Inline) Return Tx Packets Dropped
+      bool GetTxPacketsDropped( ULONG & value ) const
+      {
+         return sQMIInt <ULONG, 4>::Read( mTLVs[18], 0, value );
+      };
+
+      // (Inline) Return Rx Packets Dropped
+      bool GetRxPacketsDropped( ULONG & value ) const
+      {
+         return sQMIInt <ULONG, 4>::Read( mTLVs[19], 0, value );
+      };
+
+      // (Inline) Return Uplink Flow Control Enabled
+      bool GetUplinkFlowControlEnabled( INT8 & value ) const
+      {
+         return sQMIInt <INT8, 1>::Read( mTLVs[20], 0, value );
+      };
+
+      // (Inline) Return Data Call Address Family
+      bool GetDataCallAddressFamily( ULONG & value ) const
+      {
+         return sQMIInt <ULONG, 4>::Read( mTLVs[21], 0, value );
+      };
+
+      // (Inline) Return PDN Filters Removed
+      bool GetPDNFiltersRemoved( sPDNFiltersRemoved & value ) const
+      {
+         return sPDNFiltersRemoved::Read( mTLVs[22], 0, value );
+      };
+
+      // (Inline) Return Extended Data Bearer Technology
+      bool GetExtendedDataBearerTechnology( sExtendedDataBearerTechnology & value ) const
+      {
+         return sExtendedDataBearerTechnology::Read( mTLVs[23], 0, value );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIWriterWDSGetPacketServiceStatusReq
+//    Writer of the WDS Get Packet Service Status request
+/*=========================================================================*/
+class cQMIWriterWDSGetPacketServiceStatusReq : public cQMIMessageWriter
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0022 };
+
+      // (Inline) Constructor
+      cQMIWriterWDSGetPacketServiceStatusReq(
+         BYTE *                     pBuffer,
+         ULONG                      sz )
+         :  cQMIMessageWriter( pBuffer, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Build the QMI request from the encoded TLVs
+      sSharedBuffer * BuildRequest() const
+      {
+         return cQMIMessageWriter::BuildRequest( eQMI_SVC_WDS,
+                                                (WORD)MESSAGE_ID );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIViewWDSGetPacketServiceStatusRsp
+//    View of the WDS Get Packet Service Status response
+/*=========================================================================*/
+class cQMIViewWDSGetPacketServiceStatusRsp : public cQMIMessageView <cQMIViewWDSGetPacketServiceStatusRsp, 2>
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0022 };
+
+      // TLV type IDs
+      enum
+      {
+         TLV_RESULT = 0x02,
+         TLV_CONNECTION_STATUS = 0x01
+      };
+
+      /*=================================================================*/
+      // Struct sResult (Result)
+      /*=================================================================*/
+      struct sResult
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 4 };
+            enum
+            {
+               OFFSET_ERROR_STATUS = 0,
+               OFFSET_ERROR_CODE = 2
+            };
+
+            // Type of value read
+            typedef sResult tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sResult()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sResult( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Error Status
+            bool GetErrorStatus( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_STATUS,
+                                               value );
+            };
+
+            // (Inline) Return Error Code
+            bool GetErrorCode( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_CODE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // (Inline) Constructor (from the TLVs of the message)
+      cQMIViewWDSGetPacketServiceStatusRsp(
+         const BYTE *               pTLVs,
+         ULONG                      sz )
+         :  cQMIMessageView <cQMIViewWDSGetPacketServiceStatusRsp, 2>( pTLVs, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Constructor (from a QMI service response)
+      cQMIViewWDSGetPacketServiceStatusRsp( const sProtocolBuffer & buf )
+         :  cQMIMessageView <cQMIViewWDSGetPacketServiceStatusRsp, 2>( buf )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Map a TLV type ID to its slot (-1 if unknown)
+      static int GetSlot( BYTE typeID )
+      {
+         switch (typeID)
+         {
+            case TLV_RESULT:
+               return 0;
+            case TLV_CONNECTION_STATUS:
+               return 1;
+         }
+
+         return -1;
+      };
+
+      // (Inline) Return Result
+      bool GetResult( sResult & value ) const
+      {
+         return sResult::Read( mTLVs[0], 0, value );
+      };
+
+      // (Inline) Return contents of mandatory result content
+      bool GetResult(
+         ULONG &                    returnCode,
+         ULONG &                    errorCode ) const
+      {
+         sResult result;
+         WORD rc = 0;
+         WORD ec = 0;
+         if ( (GetResult( result ) == false)
+         ||   (result.GetErrorStatus( rc ) == false)
+         ||   (result.GetErrorCode( ec ) == false) )
+         {
+            return false;
+         }
+
+         returnCode = (ULONG)rc;
+         errorCode = (ULONG)ec;
+         return true;
+      };
+
+      // (Inline) Return Connection Status
+      bool GetConnectionStatus( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[1], 0, value );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIViewWDSPacketServiceStatusInd
+//    View of the WDS Packet Service Status indication
+/*=========================================================================*/
+class cQMIViewWDSPacketServiceStatusInd : public cQMIMessageView <cQMIViewWDSPacketServiceStatusInd, 5>
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0022 };
+
+      // TLV type IDs
+      enum
+      {
+         TLV_CONNECTION_STATUS = 0x01,
+         TLV_CALL_END_REASON = 0x10,
+         TLV_VERBOSE_CALL_END_REASON = 0x11,
+         TLV_IP_FAMILY = 0x12,
+         TLV_EXTENDED_TECHNOLOGY_PREFERENCE = 0x34
+      };
+
+      /*=================================================================*/
+      // Struct sConnectionStatus (Connection Status)
+      /*=================================================================*/
+      struct sConnectionStatus
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 2 };
+            enum
+            {
+               OFFSET_STATUS = 0,
+               OFFSET_RECONFIGURATION_REQUIRED = 1
+            };
+
+            // Type of value read
+            typedef sConnectionStatus tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sConnectionStatus()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sConnectionStatus( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Status
+            bool GetStatus( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView, OFFSET_STATUS, value );
+            };
+
+            // (Inline) Return Reconfiguration Required
+            bool GetReconfigurationRequired( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_RECONFIGURATION_REQUIRED,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sVerboseCallEndReason (Verbose Call End Reason)
+      /*=================================================================*/
+      struct sVerboseCallEndReason
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 4 };
+            enum
+            {
+               OFFSET_TYPE = 0,
+               OFFSET_REASON = 2
+            };
+
+            // Type of value read
+            typedef sVerboseCallEndReason tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sVerboseCallEndReason()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sVerboseCallEndReason( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Type
+            bool GetType( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView, OFFSET_TYPE, value );
+            };
+
+            // (Inline) Return Reason
+            bool GetReason( SHORT & value ) const
+            {
+               return sQMIInt <SHORT, 2>::Read( mView, OFFSET_REASON, value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // (Inline) Constructor (from the TLVs of the message)
+      cQMIViewWDSPacketServiceStatusInd(
+         const BYTE *               pTLVs,
+         ULONG                      sz )
+         :  cQMIMessageView <cQMIViewWDSPacketServiceStatusInd, 5>( pTLVs, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Constructor (from a QMI service indication)
+      cQMIViewWDSPacketServiceStatusInd( const sProtocolBuffer & buf )
+         :  cQMIMessageView <cQMIViewWDSPacketServiceStatusInd, 5>( buf )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Map a TLV type ID to its slot (-1 if unknown)
+      static int GetSlot( BYTE typeID )
+      {
+         switch (typeID)
+         {
+            case TLV_CONNECTION_STATUS:
+               return 0;
+            case TLV_CALL_END_REASON:
+               return 1;
+            case TLV_VERBOSE_CALL_END_REASON:
+               return 2;
+            case TLV_IP_FAMILY:
+               return 3;
+            case TLV_EXTENDED_TECHNOLOGY_PREFERENCE:
+               return 4;
+         }
+
+         return -1;
+      };
+
+      // (Inline) Return Connection Status
+      bool GetConnectionStatus( sConnectionStatus & value ) const
+      {
+         return sConnectionStatus::Read( mTLVs[0], 0, value );
+      };
+
+      // (Inline) Return Call End Reason
+      bool GetCallEndReason( WORD & value ) const
+      {
+         return sQMIInt <WORD, 2>::Read( mTLVs[1], 0, value );
+      };
+
+      // (Inline) Return Verbose Call End Reason
+      bool GetVerboseCallEndReason( sVerboseCallEndReason & value ) const
+      {
+         return sVerboseCallEndReason::Read( mTLVs[2], 0, value );
+      };
+
+      // (Inline) Return IP Family
+      bool GetIPFamily( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[3], 0, value );
+      };
+
+      // (Inline) Return Extended Technology Preference
+      bool GetExtendedTechnologyPreference( WORD & value ) const
+      {
+         return sQMIInt <WORD, 2>::Read( mTLVs[4], 0, value );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIWriterWDSGetChannelRatesReq
+//    Writer of the WDS Get Channel Rates request
+/*=========================================================================*/
+class cQMIWriterWDSGetChannelRatesReq : public cQMIMessageWriter
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0023 };
+
+      // (Inline) Constructor
+      cQMIWriterWDSGetChannelRatesReq(
+         BYTE *                     pBuffer,
+         ULONG                      sz )
+         :  cQMIMessageWriter( pBuffer, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Build the QMI request from the encoded TLVs
+      sSharedBuffer * BuildRequest() const
+      {
+         return cQMIMessageWriter::BuildRequest( eQMI_SVC_WDS,
+                                                (WORD)MESSAGE_ID );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIViewWDSGetChannelRatesRsp
+//    View of the WDS Get Channel Rates response
+/*=========================================================================*/
+class cQMIViewWDSGetChannelRatesRsp : public cQMIMessageView <cQMIViewWDSGetChannelRatesRsp, 2>
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0023 };
+
+      // TLV type IDs
+      enum
+      {
+         TLV_RESULT = 0x02,
+         TLV_CHANNEL_RATES = 0x01
+      };
+
+      /*=================================================================*/
+      // Struct sResult (Result)
+      /*=================================================================*/
+      struct sResult
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 4 };
+            enum
+            {
+               OFFSET_ERROR_STATUS = 0,
+               OFFSET_ERROR_CODE = 2
+            };
+
+            // Type of value read
+            typedef sResult tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sResult()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sResult( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Error Status
+            bool GetErrorStatus( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_STATUS,
+                                               value );
+            };
+
+            // (Inline) Return Error Code
+            bool GetErrorCode( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_CODE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sChannelRates (Channel Rates)
+      /*=================================================================*/
+      struct sChannelRates
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 16 };
+            enum
+            {
+               OFFSET_CHANNEL_TX_RATE_BPS = 0,
+               OFFSET_CHANNEL_RX_RATE_BPS = 4,
+               OFFSET_MAX_CHANNEL_TX_RATE_BPS = 8,
+               OFFSET_MAX_CHANNEL_RX_RATE_BPS = 12
+            };
+
+            // Type of value read
+            typedef sChannelRates tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sChannelRates()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sChannelRates( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Channel TX Rate BPS
+            bool GetChannelTXRateBPS( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_CHANNEL_TX_RATE_BPS,
+                                                value );
+            };
+
+            // (Inline) Return Channel RX Rate BPS
+            bool GetChannelRXRateBPS( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_CHANNEL_RX_RATE_BPS,
+                                                value );
+            };
+
+            // (Inline) Return Max Channel TX Rate BPS
+            bool GetMaxChannelTXRateBPS( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_MAX_CHANNEL_TX_RATE_BPS,
+                                                value );
+            };
+
+            // (Inline) Return Max Channel RX Rate BPS
+            bool GetMaxChannelRXRateBPS( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_MAX_CHANNEL_RX_RATE_BPS,
+                                                value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // (Inline) Constructor (from the TLVs of the message)
+      cQMIViewWDSGetChannelRatesRsp(
+         const BYTE *               pTLVs,
+         ULONG                      sz )
+         :  cQMIMessageView <cQMIViewWDSGetChannelRatesRsp, 2>( pTLVs, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Constructor (from a QMI service response)
+      cQMIViewWDSGetChannelRatesRsp( const sProtocolBuffer & buf )
+         :  cQMIMessageView <cQMIViewWDSGetChannelRatesRsp, 2>( buf )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Map a TLV type ID to its slot (-1 if unknown)
+      static int GetSlot( BYTE typeID )
+      {
+         switch (typeID)
+         {
+            case TLV_RESULT:
+               return 0;
+            case TLV_CHANNEL_RATES:
+               return 1;
+         }
+
+         return -1;
+      };
+
+      // (Inline) Return Result
+      bool GetResult( sResult & value ) const
+      {
+         return sResult::Read( mTLVs[0], 0, value );
+      };
+
+      // (Inline) Return contents of mandatory result content
+      bool GetResult(
+         ULONG &                    returnCode,
+         ULONG &                    errorCode ) const
+      {
+         sResult result;
+         WORD rc = 0;
+         WORD ec = 0;
+         if ( (GetResult( result ) == false)
+         ||   (result.GetErrorStatus( rc ) == false)
+         ||   (result.GetErrorCode( ec ) == false) )
+         {
+            return false;
+         }
+
+         returnCode = (ULONG)rc;
+         errorCode = (ULONG)ec;
+         return true;
+      };
+
+      // (Inline) Return Channel Rates
+      bool GetChannelRates( sChannelRates & value ) const
+      {
+         return sChannelRates::Read( mTLVs[1], 0, value );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIWriterWDSGetPacketStatisticsReq
+//    Writer of the WDS Get Packet Statistics request
+/*=========================================================================*/
+class cQMIWriterWDSGetPacketStatisticsReq : public cQMIMessageWriter
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0024 };
+
+      // TLV type IDs
+      enum
+      {
+         TLV_MASK = 0x01
+      };
+
+      // (Inline) Constructor
+      cQMIWriterWDSGetPacketStatisticsReq(
+         BYTE *                     pBuffer,
+         ULONG                      sz )
+         :  cQMIMessageWriter( pBuffer, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Build the QMI request from the encoded TLVs
+      sSharedBuffer * BuildRequest() const
+      {
+         return cQMIMessageWriter::BuildRequest( eQMI_SVC_WDS,
+                                                (WORD)MESSAGE_ID );
+      };
+
+      // (Inline) Set Mask
+      bool SetMask( ULONG value )
+      {
+         BYTE * pValue = AddTLV( (BYTE)TLV_MASK, 4 );
+         if (pValue == 0)
+         {
+            return false;
+         }
+
+         sQMIInt <ULONG, 4>::Write( pValue, value );
+         return true;
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIViewWDSGetPacketStatisticsRsp
+//    View of the WDS Get Packet Statistics response
+/*=========================================================================*/
+class cQMIViewWDSGetPacketStatisticsRsp : public cQMIMessageView <cQMIViewWDSGetPacketStatisticsRsp, 13>
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0024 };
+
+      // TLV type IDs
+      enum
+      {
+         TLV_RESULT = 0x02,
+         TLV_TX_PACKETS_OK = 0x10,
+         TLV_RX_PACKETS_OK = 0x11,
+         TLV_TX_PACKETS_ERROR = 0x12,
+         TLV_RX_PACKETS_ERROR = 0x13,
+         TLV_TX_OVERFLOWS = 0x14,
+         TLV_RX_OVERFLOWS = 0x15,
+         TLV_TX_BYTES_OK = 0x19,
+         TLV_RX_BYTES_OK = 0x1A,
+         TLV_LAST_CALL_TX_BYTES_OK = 0x1B,
+         TLV_LAST_CALL_RX_BYTES_OK = 0x1C,
+         TLV_TX_PACKETS_DROPPED = 0x1D,
+         TLV_RX_PACKETS_DROPPED = 0x1E
+      };
+
+      /*=================================================================*/
+      // Struct sResult (Result)
+      /*=================================================================*/
+      struct sResult
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 4 };
+            enum
+            {
+               OFFSET_ERROR_STATUS = 0,
+               OFFSET_ERROR_CODE = 2
+            };
+
+            // Type of value read
+            typedef sResult tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sResult()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sResult( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Error Status
+            bool GetErrorStatus( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_STATUS,
+                                               value );
+            };
+
+            // (Inline) Return Error Code
+            bool GetErrorCode( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_CODE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // (Inline) Constructor (from the TLVs of the message)
+      cQMIViewWDSGetPacketStatisticsRsp(
+         const BYTE *               pTLVs,
+         ULONG                      sz )
+         :  cQMIMessageView <cQMIViewWDSGetPacketStatisticsRsp, 13>( pTLVs, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Constructor (from a QMI service response)
+      cQMIViewWDSGetPacketStatisticsRsp( const sProtocolBuffer & buf )
+         :  cQMIMessageView <cQMIViewWDSGetPacketStatisticsRsp, 13>( buf )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Map a TLV type ID to its slot (-1 if unknown)
+      static int GetSlot( BYTE typeID )
+      {
+         switch (typeID)
+         {
+            case TLV_RESULT:
+               return 0;
+            case TLV_TX_PACKETS_OK:
+               return 1;
+            case TLV_RX_PACKETS_OK:
+               return 2;
+            case TLV_TX_PACKETS_ERROR:
+               return 3;
+            case TLV_RX_PACKETS_ERROR:
+               return 4;
+            case TLV_TX_OVERFLOWS:
+               return 5;
+            case TLV_RX_OVERFLOWS:
+               return 6;
+            case TLV_TX_BYTES_OK:
+               return 7;
+            case TLV_RX_BYTES_OK:
+               return 8;
+            case TLV_LAST_CALL_TX_BYTES_OK:
+               return 9;
+            case TLV_LAST_CALL_RX_BYTES_OK:
+               return 10;
+            case TLV_TX_PACKETS_DROPPED:
+               return 11;
+            case TLV_RX_PACKETS_DROPPED:
+               return 12;
+         }
+
+         return -1;
+      };
+
+      // (Inline) Return Result
+      bool GetResult( sResult & value ) const
+      {
+         return sResult::Read( mTLVs[0], 0, value );
+      };
+
+      // (Inline) Return contents of mandatory result content
+      bool GetResult(
+         ULONG &                    returnCode,
+         ULONG &                    errorCode ) const
+      {
+         sResult result;
+         WORD rc = 0;
+         WORD ec = 0;
+         if ( (GetResult( result ) == false)
+         ||   (result.GetErrorStatus( rc ) == false)
+         ||   (result.GetErrorCode( ec ) == false) )
+         {
+            return false;
+         }
+
+         returnCode = (ULONG)rc;
+         errorCode = (ULONG)ec;
+         return true;
+      };
+
+      // (Inline) Return Tx Packets Ok
+      bool GetTxPacketsOk( ULONG & value ) const
+      {
+         return sQMIInt <ULONG, 4>::Read( mTLVs[1], 0, value );
+      };
+
+      // (Inline) Return Rx Packets Ok
+      bool GetRxPacketsOk( ULONG & value ) const
+      {
+         return sQMIInt <ULONG, 4>::Read( mTLVs[2], 0, value );
+      };
+
+      // (Inline) Return Tx Packets Error
+      bool GetTxPacketsError( ULONG & value ) const
+      {
+         return sQMIInt <ULONG, 4>::Read( mTLVs[3], 0, value );
+      };
+
+      // (Inline) Return Rx Packets Error
+      bool GetRxPacketsError( ULONG & value ) const
+      {
+         return sQMIInt <ULONG, 4>::Read( mTLVs[4], 0, value );
+      };
+
+      // (Inline) Return Tx Overflows
+      bool GetTxOverflows( ULONG & value ) const
+      {
+         return sQMIInt <ULONG, 4>::Read( mTLVs[5], 0, value );
+      };
+
+      // (Inline) Return Rx Overflows
+      bool GetRxOverflows( ULONG & value ) const
+      {
+         return sQMIInt <ULONG, 4>::Read( mTLVs[6], 0, value );
+      };
+
+      // (Inline) Return Tx Bytes Ok
+      bool GetTxBytesOk( ULONGLONG & value ) const
+      {
+         return sQMIInt <ULONGLONG, 8>::Read( mTLVs[7], 0, value );
+      };
+
+      // (Inline) Return Rx Bytes Ok
+      bool GetRxBytesOk( ULONGLONG & value ) const
+      {
+         return sQMIInt <ULONGLONG, 8>::Read( mTLVs[8], 0, value );
+      };
+
+      // (Inline) Return Last Call Tx Bytes Ok
+      bool GetLastCallTxBytesOk( ULONGLONG & value ) const
+      {
+         return sQMIInt <ULONGLONG, 8>::Read( mTLVs[9], 0, value );
+      };
+
+      // (Inline) Return Last Call Rx Bytes Ok
+      bool GetLastCallRxBytesOk( ULONGLONG & value ) const
+      {
+         return sQMIInt <ULONGLONG, 8>::Read( mTLVs[10], 0, value );
+      };
+
+      // (Inline) Return Tx Packets Dropped
+      bool GetTxPacketsDropped( ULONG & value ) const
+      {
+         return sQMIInt <ULONG, 4>::Read( mTLVs[11], 0, value );
+      };
+
+      // (Inline) Return Rx Packets Dropped
+      bool GetRxPacketsDropped( ULONG & value ) const
+      {
+         return sQMIInt <ULONG, 4>::Read( mTLVs[12], 0, value );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIWriterWDSModifyProfileReq
+//    Writer of the WDS Modify Profile request
+/*=========================================================================*/
+class cQMIWriterWDSModifyProfileReq : public cQMIMessageWriter
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0028 };
+
+      // TLV type IDs
+      enum
+      {
+         TLV_PROFILE_IDENTIFIER = 0x01,
+         TLV_PROFILE_NAME = 0x10,
+         TLV_PDP_TYPE = 0x11,
+         TLV_PDP_HEADER_COMPRESSION_TYPE = 0x12,
+         TLV_PDP_DATA_COMPRESSION_TYPE = 0x13,
+         TLV_APN_NAME = 0x14,
+         TLV_PRIMARY_IPV4_DNS_ADDRESS = 0x15,
+         TLV_SECONDARY_IPV4_DNS_ADDRESS = 0x16,
+         TLV_UMTS_REQUESTED_QOS = 0x17,
+         TLV_UMTS_MINIMUM_QOS = 0x18,
+         TLV_GPRS_REQUESTED_QOS = 0x19,
+         TLV_GPRS_MINIMUM_QOS = 0x1A,
+         TLV_USERNAME = 0x1B,
+         TLV_PASSWORD = 0x1C,
+         TLV_AUTHENTICATION = 0x1D,
+         TLV_IPV4_ADDRESS_PREFERENCE = 0x1E,
+         TLV_PCSCF_ADDRESS_USING_PCO = 0x1F,
+         TLV_PCSCF_ADDRESS_USING_DHCP = 0x21,
+         TLV_IMCN_FLAG = 0x22,
+         TLV_PDP_CONTEXT_NUMBER = 0x25,
+         TLV_PDP_CONTEXT_SECONDARY_FLAG = 0x26,
+         TLV_PDP_CONTEXT_PRIMARY_ID = 0x27,
+         TLV_IPV6_ADDRESS_PREFERENCE = 0x28,
+         TLV_UMTS_REQUESTED_QOS_WITH_SIGNALING_INDICATION_FLAG = 0x29,
+         TLV_UMTS_MINIMUM_QOS_WITH_SIGNALING_INDICATION_FLAG = 0x2A,
+         TLV_IPV6_PRIMARY_DNS_ADDRESS_PREFERENCE = 0x2B,
+         TLV_IPV6_SECONDARY_DNS_ADDRESS_PREFERENCE = 0x2C,
+         TLV_LTE_QOS_PARAMETERS = 0x2E,
+         TLV_APN_DISABLED_FLAG = 0x2F,
+         TLV_ROAMING_DISALLOWED_FLAG = 0x3E
+      };
+
+      // (Inline) Constructor
+      cQMIWriterWDSModifyProfileReq(
+         BYTE *                     pBuffer,
+         ULONG                      sz )
+         :  cQMIMessageWriter( pBuffer, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Build the QMI request from the encoded TLVs
+      sSharedBuffer * BuildRequest() const
+      {
+         return cQMIMessageWriter::BuildRequest( eQMI_SVC_WDS,
+                                                (WORD)MESSAGE_ID );
+      };
+
+      // (Inline) Set Profile Identifier
+      bool SetProfileIdentifier(
+         BYTE                       profileType,
+         BYTE                       profileIndex )
+      {
+         BYTE * pValue = AddTLV( (BYTE)TLV_PROFILE_IDENTIFIER, 2 );
+         if (pValue == 0)
+         {
+            return false;
+         }
+
+         sQMIInt <BYTE, 1>::Write( pValue + 0, profileType );
+         sQMIInt <BYTE, 1>::Write( pValue + 1, profileIndex );
+         return true;
+      };
+
+      // (Inline) Set Profile Name
+      bool SetProfileName( const std::string & value )
+      {
+         return AddTLV( (BYTE)TLV_PROFILE_NAME,
+                        (const BYTE *)value.c_str(),
+                        (ULONG)value.size() );
+      };
+
+      // (Inline) Set PDP Type
+      bool SetPDPType( BYTE value )
+      {
+         BYTE * pValue = AddTLV( (BYTE)TLV_PDP_TYPE, 1 );
+         if (pValue == 0)
+         {
+            return false;
+         }
+
+         sQMIInt <BYTE, 1>::Write( pValue, value );
+         return true;
+      };
+
+      // (Inline) Set PDP Header Compression Type
+      bool SetPDPHeaderCompressionType( BYTE value )
+      {
+         BYTE * pValue = AddTLV( (BYTE)TLV_PDP_HEADER_COMPRESSION_TYPE, 1 );
+         if (pValue == 0)
+         {
+            return false;
+         }
+
+         sQMIInt <BYTE, 1>::Write( pValue, value );
+         return true;
+      };
+
+      // (Inline) Set PDP Data Compression Type
+      bool SetPDPDataCompressionType( BYTE value )
+      {
+         BYTE * pValue = AddTLV( (BYTE)TLV_PDP_DATA_COMPRESSION_TYPE, 1 );
+         if (pValue == 0)
+         {
+            return false;
+         }
+
+         sQMIInt <BYTE, 1>::Write( pValue, value );
+         return true;
+      };
+
+      // (Inline) Set APN Name
+      bool SetAPNName( const std::string & value )
+      {
+         return AddTLV( (BYTE)TLV_APN_NAME,
+                        (const BYTE *)value.c_str(),
+                        (ULONG)value.size() );
+      };
+
+      // (Inline) Set Primary IPv4 DNS Address
+      bool SetPrimaryIPv4DNSAddress( ULONG value )
+      {
+         BYTE * pValue = AddTLV( (BYTE)TLV_PRIMARY_IPV4_DNS_ADDRESS, 4 );
+         if (pValue == 0)
+         {
+            return false;
+         }
+
+         sQMIInt <ULONG, 4>::Write( pValue, value );
+         return true;
+      };
+
+      // (Inline) Set Secondary IPv4 DNS Address
+      bool SetSecondaryIPv4DNSAddress( ULONG value )
+      {
+         BYTE * pValue = AddTLV( (BYTE)TLV_SECONDARY_IPV4_DNS_ADDRESS, 4 );
+         if (pValue == 0)
+         {
+            return false;
+         }
+
+         sQMIInt <ULONG, 4>::Write( pValue, value );
+         return true;
+      };
+
+      // (Inline) Set UMTS Requested QoS
+      bool SetUMTSRequestedQoS(
+         BYTE                       trafficClass,
+         ULONG                      maxUplinkBitrate,
+         ULONG                      maxDownlinkBitrate,
+         ULONG                      guaranteedUplinkBitrate,
+         ULONG                      guaranteedDownlinkBitrate,
+         BYTE                       qoSDeliveryOrder,
+         ULONG                      maximumSDUSize,
+         BYTE                       sDUErrorRatio,
+         BYTE                       residualBitErrorRatio,
+         BYTE                       deliveryErroneousSDU,
+         ULONG                      transferDelay,
+         ULONG                      trafficHandlingPriority )
+      {
+         BYTE * pValue = AddTLV( (BYTE)TLV_UMTS_REQUESTED_QOS, 33 );
+         if (pValue == 0)
+         {
+            return false;
+         }
+
+         sQMIInt <BYTE, 1>::Write( pValue + 0, trafficClass );
+         sQMIInt <ULONG, 4>::Write( pValue + 1, maxUplinkBitrate );
+         sQMIInt <ULONG, 4>::Write( pValue + 5, maxDownlinkBitrate );
+         sQMIInt <ULONG, 4>::Write( pValue + 9, guaranteedUplinkBitrate );
+         sQMIInt <ULONG, 4>::Write( pValue + 13, guaranteedDownlinkBitrate );
+         sQMIInt <BYTE, 1>::Write( pValue + 17, qoSDeliveryOrder );
+         sQMIInt <ULONG, 4>::Write( pValue + 18, maximumSDUSize );
+         sQMIInt <BYTE, 1>::Write( pValue + 22, sDUErrorRatio );
+         sQMIInt <BYTE, 1>::Write( pValue + 23, residualBitErrorRatio );
+         sQMIInt <BYTE, 1>::Write( pValue + 24, deliveryErroneousSDU );
+         sQMIInt <ULONG, 4>::Write( pValue + 25, transferDelay );
+         sQMIInt <ULONG, 4>::Write( pValue + 29, trafficHandlingPriority );
+         return true;
+      };
+
+      // (Inline) Set UMTS Minimum QoS
+      bool SetUMTSMinimumQoS(
+         BYTE                       trafficClass,
+         ULONG                      maxUplinkBitrate,
+         ULONG                      maxDownlinkBitrate,
+         ULONG                      guaranteedUplinkBitrate,
+         ULONG                      guaranteedDownlinkBitrate,
+         BYTE                       qoSDeliveryOrder,
+         ULONG                      maximumSDUSize,
+         BYTE                       sDUErrorRatio,
+         BYTE                       residualBitErrorRatio,
+         BYTE                       deliveryErroneousSDU,
+         ULONG                      transferDelay,
+         ULONG                      trafficHandlingPriority )
+      {
+         BYTE * pValue = AddTLV( (BYTE)TLV_UMTS_MINIMUM_QOS, 33 );
+         if (pValue == 0)
+         {
+            return false;
+         }
+
+         sQMIInt <BYTE, 1>::Write( pValue + 0, trafficClass );
+         sQMIInt <ULONG, 4>::Write( pValue + 1, maxUplinkBitrate );
+         sQMIInt <ULONG, 4>::Write( pValue + 5, maxDownlinkBitrate );
+         sQMIInt <ULONG, 4>::Write( pValue + 9, guaranteedUplinkBitrate );
+         sQMIInt <ULONG, 4>::Write( pValue + 13, guaranteedDownlinkBitrate );
+         sQMIInt <BYTE, 1>::Write( pValue + 17, qoSDeliveryOrder );
+         sQMIInt <ULONG, 4>::Write( pValue + 18, maximumSDUSize );
+         sQMIInt <BYTE, 1>::Write( pValue + 22, sDUErrorRatio );
+         sQMIInt <BYTE, 1>::Write( pValue + 23, residualBitErrorRatio );
+         sQMIInt <BYTE, 1>::Write( pValue + 24, deliveryErroneousSDU );
+         sQMIInt <ULONG, 4>::Write( pValue + 25, transferDelay );
+         sQMIInt <ULONG, 4>::Write( pValue + 29, trafficHandlingPriority );
+         return true;
+      };
+
+      // (Inline) Set GPRS Requested QoS
+      bool SetGPRSRequestedQoS(
+         ULONG                      precedenceClass,
+         ULONG                      delayClass,
+         ULONG                      reliabilityClass,
+         ULONG                      peakThroughputClass,
+         ULONG                      meanThroughputClass )
+      {
+         BYTE * pValue = AddTLV( (BYTE)TLV_GPRS_REQUESTED_QOS, 20 );
+         if (pValue == 0)
+         {
+            return false;
+         }
+
+         sQMIInt <ULONG, 4>::Write( pValue + 0, precedenceClass );
+         sQMIInt <ULONG, 4>::Write( pValue + 4, delayClass );
+         sQMIInt <ULONG, 4>::Write( pValue + 8, reliabilityClass );
+         sQMIInt <ULONG, 4>::Write( pValue + 12, peakThroughputClass );
+         sQMIInt <ULONG, 4>::Write( pValue + 16, meanThroughputClass );
+         return true;
+      };
+
+      // (Inline) Set GPRS Minimum QoS
+      bool SetGPRSMinimumQoS(
+         ULONG                      precedenceClass,
+         ULONG                      delayClass,
+         ULONG                      reliabilityClass,
+         ULONG                      peakThroughputClass,
+         ULONG                      meanThroughputClass )
+      {
+         BYTE * pValue = AddTLV( (BYTE)TLV_GPRS_MINIMUM_QOS, 20 );
+         if (pValue == 0)
+         {
+            return false;
+         }
+
+         sQMIInt <ULONG, 4>::Write( pValue + 0, precedenceClass );
+         sQMIInt <ULONG, 4>::Write( pValue + 4, delayClass );
+         sQMIInt <ULONG, 4>::Write( pValue + 8, reliabilityClass );
+         sQMIInt <ULONG, 4>::Write( pValue + 12, peakThroughputClass );
+         sQMIInt <ULONG, 4>::Write( pValue + 16, meanThroughputClass );
+         return true;
+      };
+
+      // (Inline) Set Username
+      bool SetUsername( const std::string & value )
+      {
+         return AddTLV( (BYTE)TLV_USERNAME,
+                        (const BYTE *)value.c_str(),
+                        (ULONG)value.size() );
+      };
+
+      // (Inline) Set Password
+      bool SetPassword( const std::string & value )
+      {
+         return AddTLV( (BYTE)TLV_PASSWORD,
+                        (const BYTE *)value.c_str(),
+                        (ULONG)value.size() );
+      };
+
+      // (Inline) Set Authentication
+      bool SetAuthentication( BYTE value )
+      {
+         BYTE * pValue = AddTLV( (BYTE)TLV_AUTHENTICATION, 1 );
+         if (pValue == 0)
+         {
+            return false;
+         }
+
+         sQMIInt <BYTE, 1>::Write( pValue, value );
+         return true;
+      };
+
+      // (Inline) Set IPv4 Address Preference
+      bool SetIPv4AddressPreference( ULONG value )
+      {
+         BYTE * pValue = AddTLV( (BYTE)TLV_IPV4_ADDRESS_PREFERENCE, 4 );
+         if (pValue == 0)
+         {
+            return false;
+         }
+
+         sQMIInt <ULONG, 4>::Write( pValue, value );
+         return true;
+      };
+
+      // (Inline) Set PCSCF Address Using PCO
+      bool SetPCSCFAddressUsingPCO( BYTE value )
+      {
+         BYTE * pValue = AddTLV( (BYTE)TLV_PCSCF_ADDRESS_USING_PCO, 1 );
+         if (pValue == 0)
+         {
+            return false;
+         }
+
+         sQMIInt <BYTE, 1>::Write( pValue, value );
+         return true;
+      };
+
+      // (Inline) Set PCSCF Address Using DHCP
+      bool SetPCSCFAddressUsingDHCP( BYTE value )
+      {
+         BYTE * pValue = AddTLV( (BYTE)TLV_PCSCF_ADDRESS_USING_DHCP, 1 );
+         if (pValue == 0)
+         {
+            return false;
+         }
+
+         sQMIInt <BYTE, 1>::Write( pValue, value );
+         return true;
+      };
+
+      // (Inline) Set IMCN Flag
+      bool SetIMCNFlag( BYTE value )
+      {
+         BYTE * pValue = AddTLV( (BYTE)TLV_IMCN_FLAG, 1 );
+         if (pValue == 0)
+         {
+            return false;
+         }
+
+         sQMIInt <BYTE, 1>::Write( pValue, value );
+         return true;
+      };
+
+      // (Inline) Set PDP Context Number
+      bool SetPDPContextNumber( BYTE value )
+      {
+         BYTE * pValue = AddTLV( (BYTE)TLV_PDP_CONTEXT_NUMBER, 1 );
+         if (pValue == 0)
+         {
+            return false;
+         }
+
+         sQMIInt <BYTE, 1>::Write( pValue, value );
+         return true;
+      };
+
+      // (Inline) Set PDP Context Secondary Flag
+      bool SetPDPContextSecondaryFlag( BYTE value )
+      {
+         BYTE * pValue = AddTLV( (BYTE)TLV_PDP_CONTEXT_SECONDARY_FLAG, 1 );
+         if (pValue == 0)
+         {
+            return false;
+         }
+
+         sQMIInt <BYTE, 1>::Write( pValue, value );
+         return true;
+      };
+
+      // (Inline) Set PDP Context Primary ID
+      bool SetPDPContextPrimaryID( BYTE value )
+      {
+         BYTE * pValue = AddTLV( (BYTE)TLV_PDP_CONTEXT_PRIMARY_ID, 1 );
+         if (pValue == 0)
+         {
+            return false;
+         }
+
+         sQMIInt <BYTE, 1>::Write( pValue, value );
+         return true;
+      };
+
+      // NOTE: IPv6 Address Preference is not supported by the writer, use
+      // AddTLV( TLV_IPV6_ADDRESS_PREFERENCE, pValue, len ) with the encoded value
+
+      // (Inline) Set UMTS Requested QoS With Signaling Indication Flag
+      bool SetUMTSRequestedQoSWithSignalingIndicationFlag(
+         BYTE                       trafficClass,
+         ULONG                      maxUplinkBitrate,
+         ULONG                      maxDownlinkBitrate,
+         ULONG                      guaranteedUplinkBitrate,
+         ULONG                      guaranteedDownlinkBitrate,
+         BYTE                       qoSDeliveryOrder,
+         ULONG                      maximumSDUSize,
+         BYTE                       sDUErrorRatio,
+         BYTE                       residualBitErrorRatio,
+         BYTE                       deliveryErroneousSDU,
+         ULONG                      transferDelay,
+         ULONG                      trafficHandlingPriority,
+         INT8                       signalingIndication )
+      {
+         BYTE * pValue = AddTLV( (BYTE)TLV_UMTS_REQUESTED_QOS_WITH_SIGNALING_INDICATION_FLAG, 34 );
+         if (pValue == 0)
+         {
+            return false;
+         }
+
+         sQMIInt <BYTE, 1>::Write( pValue + 0, trafficClass );
+         sQMIInt <ULONG, 4>::Write( pValue + 1, maxUplinkBitrate );
+         sQMIInt <ULONG, 4>::Write( pValue + 5, maxDownlinkBitrate );
+         sQMIInt <ULONG, 4>::Write( pValue + 9, guaranteedUplinkBitrate );
+         sQMIInt <ULONG, 4>::Write( pValue + 13, guaranteedDownlinkBitrate );
+         sQMIInt <BYTE, 1>::Write( pValue + 17, qoSDeliveryOrder );
+         sQMIInt <ULONG, 4>::Write( pValue + 18, maximumSDUSize );
+         sQMIInt <BYTE, 1>::Write( pValue + 22, sDUErrorRatio );
+         sQMIInt <BYTE, 1>::Write( pValue + 23, residualBitErrorRatio );
+         sQMIInt <BYTE, 1>::Write( pValue + 24, deliveryErroneousSDU );
+         sQMIInt <ULONG, 4>::Write( pValue + 25, transferDelay );
+         sQMIInt <ULONG, 4>::Write( pValue + 29, trafficHandlingPriority );
+         sQMIInt <INT8, 1>::Write( pValue + 33, signalingIndication );
+         return true;
+      };
+
+      // (Inline) Set UMTS Minimum QoS With Signaling Indication Flag
+      bool SetUMTSMinimumQoSWithSignalingIndicationFlag(
+         BYTE                       trafficClass,
+         ULONG                      maxUplinkBitrate,
+         ULONG                      maxDownlinkBitrate,
+         ULONG                      guaranteedUplinkBitrate,
+         ULONG                      guaranteedDownlinkBitrate,
+         BYTE                       qoSDeliveryOrder,
+         ULONG                      maximumSDUSize,
+         BYTE                       sDUErrorRatio,
+         BYTE                       residualBitErrorRatio,
+         BYTE                       deliveryErroneousSDU,
+         ULONG                      transferDelay,
+         ULONG                      trafficHandlingPriority,
+         INT8                       signalingIndication )
+      {
+         BYTE * pValue = AddTLV( (BYTE)TLV_UMTS_MINIMUM_QOS_WITH_SIGNALING_INDICATION_FLAG, 34 );
+         if (pValue == 0)
+         {
+            return false;
+         }
+
+         sQMIInt <BYTE, 1>::Write( pValue + 0, trafficClass );
+         sQMIInt <ULONG, 4>::Write( pValue + 1, maxUplinkBitrate );
+         sQMIInt <ULONG, 4>::Write( pValue + 5, maxDownlinkBitrate );
+         sQMIInt <ULONG, 4>::Write( pValue + 9, guaranteedUplinkBitrate );
+         sQMIInt <ULONG, 4>::Write( pValue + 13, guaranteedDownlinkBitrate );
+         sQMIInt <BYTE, 1>::Write( pValue + 17, qoSDeliveryOrder );
+         sQMIInt <ULONG, 4>::Write( pValue + 18, maximumSDUSize );
+         sQMIInt <BYTE, 1>::Write( pValue + 22, sDUErrorRatio );
+         sQMIInt <BYTE, 1>::Write( pValue + 23, residualBitErrorRatio );
+         sQMIInt <BYTE, 1>::Write( pValue + 24, deliveryErroneousSDU );
+         sQMIInt <ULONG, 4>::Write( pValue + 25, transferDelay );
+         sQMIInt <ULONG, 4>::Write( pValue + 29, trafficHandlingPriority );
+         sQMIInt <INT8, 1>::Write( pValue + 33, signalingIndication );
+         return true;
+      };
+
+      // NOTE: IPv6 Primary DNS Address Preference is not supported by the writer, use
+      // AddTLV( TLV_IPV6_PRIMARY_DNS_ADDRESS_PREFERENCE, pValue, len ) with the encoded value
+
+      // NOTE: IPv6 Secondary DNS Address Preference is not supported by the writer, use
+      // AddTLV( TLV_IPV6_SECONDARY_DNS_ADDRESS_PREFERENCE, pValue, len ) with the encoded value
+
+      // (Inline) Set LTE QoS Parameters
+      bool SetLTEQoSParameters(
+         BYTE                       qoSClassIdentifier,
+         ULONG                      guaranteedDownlinkBitrate,
+         ULONG                      maxDownlinkBitrate,
+         ULONG                      guaranteedUplinkBitrate,
+         ULONG                      maxUplinkBitrate )
+      {
+         BYTE * pValue = AddTLV( (BYTE)TLV_LTE_QOS_PARAMETERS, 17 );
+         if (pValue == 0)
+         {
+            return false;
+         }
+
+         sQMIInt <BYTE, 1>::Write( pValue + 0, qoSClassIdentifier );
+         sQMIInt <ULONG, 4>::Write( pValue + 1, guaranteedDownlinkBitrate );
+         sQMIInt <ULONG, 4>::Write( pValue + 5, maxDownlinkBitrate );
+         sQMIInt <ULONG, 4>::Write( pValue + 9, guaranteedUplinkBitrate );
+         sQMIInt <ULONG, 4>::Write( pValue + 13, maxUplinkBitrate );
+         return true;
+      };
+
+      // (Inline) Set APN Disabled Flag
+      bool SetAPNDisabledFlag( BYTE value )
+      {
+         BYTE * pValue = AddTLV( (BYTE)TLV_APN_DISABLED_FLAG, 1 );
+         if (pValue == 0)
+         {
+            return false;
+         }
+
+         sQMIInt <BYTE, 1>::Write( pValue, value );
+         return true;
+      };
+
+      // (Inline) Set Roaming Disallowed Flag
+      bool SetRoamingDisallowedFlag( BYTE value )
+      {
+         BYTE * pValue = AddTLV( (BYTE)TLV_ROAMING_DISALLOWED_FLAG, 1 );
+         if (pValue == 0)
+         {
+            return false;
+         }
+
+         sQMIInt <BYTE, 1>::Write( pValue, value );
+         return true;
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIViewWDSModifyProfileRsp
+//    View of the WDS Modify Profile response
+/*=========================================================================*/
+class cQMIViewWDSModifyProfileRsp : public cQMIMessageView <cQMIViewWDSModifyProfileRsp, 2>
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0028 };
+
+      // TLV type IDs
+      enum
+      {
+         TLV_RESULT = 0x02,
+         TLV_EXTENDED_ERROR_CODE = 0xE0
+      };
+
+      /*=================================================================*/
+      // Struct sResult (Result)
+      /*=================================================================*/
+      struct sResult
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 4 };
+            enum
+            {
+               OFFSET_ERROR_STATUS = 0,
+               OFFSET_ERROR_CODE = 2
+            };
+
+            // Type of value read
+            typedef sResult tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sResult()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sResult( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Error Status
+            bool GetErrorStatus( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_STATUS,
+                                               value );
+            };
+
+            // (Inline) Return Error Code
+            bool GetErrorCode( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_CODE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // (Inline) Constructor (from the TLVs of the message)
+      cQMIViewWDSModifyProfileRsp(
+         const BYTE *               pTLVs,
+         ULONG                      sz )
+         :  cQMIMessageView <cQMIViewWDSModifyProfileRsp, 2>( pTLVs, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Constructor (from a QMI service response)
+      cQMIViewWDSModifyProfileRsp( const sProtocolBuffer & buf )
+         :  cQMIMessageView <cQMIViewWDSModifyProfileRsp, 2>( buf )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Map a TLV type ID to its slot (-1 if unknown)
+      static int GetSlot( BYTE typeID )
+      {
+         switch (typeID)
+         {
+            case TLV_RESULT:
+               return 0;
+            case TLV_EXTENDED_ERROR_CODE:
+               return 1;
+         }
+
+         return -1;
+      };
+
+      // (Inline) Return Result
+      bool GetResult( sResult & value ) const
+      {
+         return sResult::Read( mTLVs[0], 0, value );
+      };
+
+      // (Inline) Return contents of mandatory result content
+      bool GetResult(
+         ULONG &                    returnCode,
+         ULONG &                    errorCode ) const
+      {
+         sResult result;
+         WORD rc = 0;
+         WORD ec = 0;
+         if ( (GetResult( result ) == false)
+         ||   (result.GetErrorStatus( rc ) == false)
+         ||   (result.GetErrorCode( ec ) == false) )
+         {
+            return false;
+         }
+
+         returnCode = (ULONG)rc;
+         errorCode = (ULONG)ec;
+         return true;
+      };
+
+      // (Inline) Return Extended Error Code
+      bool GetExtendedErrorCode( WORD & value ) const
+      {
+         return sQMIInt <WORD, 2>::Read( mTLVs[1], 0, value );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIWriterWDSGetProfileListReq
+//    Writer of the WDS Get Profile List request
+/*=========================================================================*/
+class cQMIWriterWDSGetProfileListReq : public cQMIMessageWriter
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x002A };
+
+      // TLV type IDs
+      enum
+      {
+         TLV_PROFILE_TYPE = 0x10
+      };
+
+      // (Inline) Constructor
+      cQMIWriterWDSGetProfileListReq(
+         BYTE *                     pBuffer,
+         ULONG                      sz )
+         :  cQMIMessageWriter( pBuffer, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Build the QMI request from the encoded TLVs
+      sSharedBuffer * BuildRequest() const
+      {
+         return cQMIMessageWriter::BuildRequest( eQMI_SVC_WDS,
+                                                (WORD)MESSAGE_ID );
+      };
+
+      // (Inline) Set Profile Type
+      bool SetProfileType( BYTE value )
+      {
+         BYTE * pValue = AddTLV( (BYTE)TLV_PROFILE_TYPE, 1 );
+         if (pValue == 0)
+         {
+            return false;
+         }
+
+         sQMIInt <BYTE, 1>::Write( pValue, value );
+         return true;
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIViewWDSGetProfileListRsp
+//    View of the WDS Get Profile List response
+/*=========================================================================*/
+class cQMIViewWDSGetProfileListRsp : public cQMIMessageView <cQMIViewWDSGetProfileListRsp, 3>
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x002A };
+
+      // TLV type IDs
+      enum
+      {
+         TLV_RESULT = 0x02,
+         TLV_PROFILE_LIST = 0x01,
+         TLV_EXTENDED_ERROR_CODE = 0xE0
+      };
+
+      /*=================================================================*/
+      // Struct sResult (Result)
+      /*=================================================================*/
+      struct sResult
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 4 };
+            enum
+            {
+               OFFSET_ERROR_STATUS = 0,
+               OFFSET_ERROR_CODE = 2
+            };
+
+            // Type of value read
+            typedef sResult tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sResult()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sResult( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Error Status
+            bool GetErrorStatus( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_STATUS,
+                                               value );
+            };
+
+            // (Inline) Return Error Code
+            bool GetErrorCode( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_CODE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sProfileListElement (Profile List Element)
+      /*=================================================================*/
+      struct sProfileListElement
+      {
+         public:
+            // Compile time size (variable)/offsets of the fields
+            enum { FIXED_SIZE = 0 };
+            enum
+            {
+               OFFSET_PROFILE_TYPE = 0,
+               OFFSET_PROFILE_INDEX = 1,
+               OFFSET_PROFILE_NAME = 2
+            };
+
+            // Type of value read
+            typedef sProfileListElement tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sProfileListElement()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sProfileListElement( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = 0;
+
+               ULONG start = offset;
+               ULONG fieldSz = 0;
+               offset += 2;
+               if (sQMIString <1>::Measure( in, offset, fieldSz ) == false)
+               {
+                  return false;
+               }
+
+               offset += fieldSz;
+
+               sz = offset - start;
+               return in.Has( start, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Profile Type
+            bool GetProfileType( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_PROFILE_TYPE,
+                                               value );
+            };
+
+            // (Inline) Return Profile Index
+            bool GetProfileIndex( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_PROFILE_INDEX,
+                                               value );
+            };
+
+            // (Inline) Return Profile Name
+            bool GetProfileName( sQMIView & value ) const
+            {
+               return sQMIString <1>::Read( mView,
+                                            OFFSET_PROFILE_NAME,
+                                            value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // Array view of Profile List
+      typedef cQMIArrayView <sProfileListElement, 1> tProfileList;
+
+      // (Inline) Constructor (from the TLVs of the message)
+      cQMIViewWDSGetProfileListRsp(
+         const BYTE *               pTLVs,
+         ULONG                      sz )
+         :  cQMIMessageView <cQMIViewWDSGetProfileListRsp, 3>( pTLVs, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Constructor (from a QMI service response)
+      cQMIViewWDSGetProfileListRsp( const sProtocolBuffer & buf )
+         :  cQMIMessageView <cQMIViewWDSGetProfileListRsp, 3>( buf )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Map a TLV type ID to its slot (-1 if unknown)
+      static int GetSlot( BYTE typeID )
+      {
+         switch (typeID)
+         {
+            case TLV_RESULT:
+               return 0;
+            case TLV_PROFILE_LIST:
+               return 1;
+            case TLV_EXTENDED_ERROR_CODE:
+               return 2;
+         }
+
+         return -1;
+      };
+
+      // (Inline) Return Result
+      bool GetResult( sResult & value ) const
+      {
+         return sResult::Read( mTLVs[0], 0, value );
+      };
+
+      // (Inline) Return contents of mandatory result content
+      bool GetResult(
+         ULONG &                    returnCode,
+         ULONG &                    errorCode ) const
+      {
+         sResult result;
+         WORD rc = 0;
+         WORD ec = 0;
+         if ( (GetResult( result ) == false)
+         ||   (result.GetErrorStatus( rc ) == false)
+         ||   (result.GetErrorCode( ec ) == false) )
+         {
+            return false;
+         }
+
+         returnCode = (ULONG)rc;
+         errorCode = (ULONG)ec;
+         return true;
+      };
+
+      // (Inline) Return Profile List
+      bool GetProfileList( tProfileList & value ) const
+      {
+         return tProfileList::Read( mTLVs[1], 0, value );
+      };
+
+      // (Inline) Return Extended Error Code
+      bool GetExtendedErrorCode( WORD & value ) const
+      {
+         return sQMIInt <WORD, 2>::Read( mTLVs[2], 0, value );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIWriterWDSGetProfileSettingsReq
+//    Writer of the WDS Get Profile Settings request
+/*=========================================================================*/
+class cQMIWriterWDSGetProfileSettingsReq : public cQMIMessageWriter
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x002B };
+
+      // TLV type IDs
+      enum
+      {
+         TLV_PROFILE_ID = 0x01
+      };
+
+      // (Inline) Constructor
+      cQMIWriterWDSGetProfileSettingsReq(
+         BYTE *                     pBuffer,
+         ULONG                      sz )
+         :  cQMIMessageWriter( pBuffer, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Build the QMI request from the encoded TLVs
+      sSharedBuffer * BuildRequest() const
+      {
+         return cQMIMessageWriter::BuildRequest( eQMI_SVC_WDS,
+                                                (WORD)MESSAGE_ID );
+      };
+
+      // (Inline) Set Profile ID
+      bool SetProfileID(
+         BYTE                       profileType,
+         BYTE                       profileIndex )
+      {
+         BYTE * pValue = AddTLV( (BYTE)TLV_PROFILE_ID, 2 );
+         if (pValue == 0)
+         {
+            return false;
+         }
+
+         sQMIInt <BYTE, 1>::Write( pValue + 0, profileType );
+         sQMIInt <BYTE, 1>::Write( pValue + 1, profileIndex );
+         return true;
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIViewWDSGetProfileSettingsRsp
+//    View of the WDS Get Profile Settings response
+/*=========================================================================*/
+class cQMIViewWDSGetProfileSettingsRsp : public cQMIMessageView <cQMIViewWDSGetProfileSettingsRsp, 31>
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x002B };
+
+      // TLV type IDs
+      enum
+      {
+         TLV_RESULT = 0x02,
+         TLV_PROFILE_NAME = 0x10,
+         TLV_PDP_TYPE = 0x11,
+         TLV_PDP_HEADER_COMPRESSION_TYPE = 0x12,
+         TLV_PDP_DATA_COMPRESSION_TYPE = 0x13,
+         TLV_APN_NAME = 0x14,
+         TLV_PRIMARY_IPV4_DNS_ADDRESS = 0x15,
+         TLV_SECONDARY_IPV4_DNS_ADDRESS = 0x16,
+         TLV_UMTS_REQUESTED_QOS = 0x17,
+         TLV_UMTS_MINIMUM_QOS = 0x18,
+         TLV_GPRS_REQUESTED_QOS = 0x19,
+         TLV_GPRS_MINIMUM_QOS = 0x1A,
+         TLV_USERNAME = 0x1B,
+         TLV_PASSWORD = 0x1C,
+         TLV_AUTHENTICATION = 0x1D,
+         TLV_IPV4_ADDRESS_PREFERENCE = 0x1E,
+         TLV_PCSCF_ADDRESS_USING_PCO = 0x1F,
+         TLV_PCSCF_ADDRESS_USING_DHCP = 0x21,
+         TLV_IMCN_FLAG = 0x22,
+         TLV_PDP_CONTEXT_NUMBER = 0x25,
+         TLV_PDP_CONTEXT_SECONDARY_FLAG = 0x26,
+         TLV_PDP_CONTEXT_PRIMARY_ID = 0x27,
+         TLV_IPV6_ADDRESS_PREFERENCE = 0x28,
+         TLV_UMTS_REQUESTED_QOS_WITH_SIGNALING_INDICATION_FLAG = 0x29,
+         TLV_UMTS_MINIMUM_QOS_WITH_SIGNALING_INDICATION_FLAG = 0x2A,
+         TLV_IPV6_PRIMARY_DNS_ADDRESS_PREFERENCE = 0x2B,
+         TLV_IPV6_SECONDARY_DNS_ADDRESS_PREFERENCE = 0x2C,
+         TLV_LTE_QOS_PARAMETERS = 0x2E,
+         TLV_APN_DISABLED_FLAG = 0x2F,
+         TLV_ROAMING_DISALLOWED_FLAG = 0x3E,
+         TLV_EXTENDED_ERROR_CODE = 0xE0
+      };
+
+      /*=================================================================*/
+      // Struct sResult (Result)
+      /*=================================================================*/
+      struct sResult
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 4 };
+            enum
+            {
+               OFFSET_ERROR_STATUS = 0,
+               OFFSET_ERROR_CODE = 2
+            };
+
+            // Type of value read
+            typedef sResult tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sResult()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sResult( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Error Status
+            bool GetErrorStatus( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_STATUS,
+                                               value );
+            };
+
+            // (Inline) Return Error Code
+            bool GetErrorCode( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_CODE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sUMTSRequestedQoS (UMTS Requested QoS)
+      /*=================================================================*/
+      struct sUMTSRequestedQoS
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 33 };
+            enum
+            {
+               OFFSET_TRAFFIC_CLASS = 0,
+               OFFSET_MAX_UPLINK_BITRATE = 1,
+               OFFSET_MAX_DOWNLINK_BITRATE = 5,
+               OFFSET_GUARANTEED_UPLINK_BITRATE = 9,
+               OFFSET_GUARANTEED_DOWNLINK_BITRATE = 13,
+               OFFSET_QOS_DELIVERY_ORDER = 17,
+               OFFSET_MAXIMUM_SDU_SIZE = 18,
+               OFFSET_SDU_ERROR_RATIO = 22,
+               OFFSET_RESIDUAL_BIT_ERROR_RATIO = 23,
+               OFFSET_DELIVERY_ERRONEOUS_SDU = 24,
+               OFFSET_TRANSFER_DELAY = 25,
+               OFFSET_TRAFFIC_HANDLING_PRIORITY = 29
+            };
+
+            // Type of value read
+            typedef sUMTSRequestedQoS tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sUMTSRequestedQoS()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sUMTSRequestedQoS( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Traffic Class
+            bool GetTrafficClass( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_TRAFFIC_CLASS,
+                                               value );
+            };
+
+            // (Inline) Return Max uplink bitrate
+            bool GetMaxUplinkBitrate( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_MAX_UPLINK_BITRATE,
+                                                value );
+            };
+
+            // (Inline) Return Max downlink bitrate
+            bool GetMaxDownlinkBitrate( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_MAX_DOWNLINK_BITRATE,
+                                                value );
+            };
+
+            // (Inline) Return Guaranteed uplink bitrate
+            bool GetGuaranteedUplinkBitrate( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_GUARANTEED_UPLINK_BITRATE,
+                                                value );
+            };
+
+            // (Inline) Return Guaranteed downlink bitrate
+            bool GetGuaranteedDownlinkBitrate( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_GUARANTEED_DOWNLINK_BITRATE,
+                                                value );
+            };
+
+            // (Inline) Return QoS Delivery Order
+            bool GetQoSDeliveryOrder( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_QOS_DELIVERY_ORDER,
+                                               value );
+            };
+
+            // (Inline) Return Maximum SDU Size
+            bool GetMaximumSDUSize( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_MAXIMUM_SDU_SIZE,
+                                                value );
+            };
+
+            // (Inline) Return SDU Error Ratio
+            bool GetSDUErrorRatio( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_SDU_ERROR_RATIO,
+                                               value );
+            };
+
+            // (Inline) Return Residual Bit Error Ratio
+            bool GetResidualBitErrorRatio( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_RESIDUAL_BIT_ERROR_RATIO,
+                                               value );
+            };
+
+            // (Inline) Return Delivery Erroneous SDU
+            bool GetDeliveryErroneousSDU( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_DELIVERY_ERRONEOUS_SDU,
+                                               value );
+            };
+
+            // (Inline) Return Transfer Delay
+            bool GetTransferDelay( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_TRANSFER_DELAY,
+                                                value );
+            };
+
+            // (Inline) Return Traffic Handling Priority
+            bool GetTrafficHandlingPriority( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_TRAFFIC_HANDLING_PRIORITY,
+                                                value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sUMTSMinimumQoS (UMTS Minimum QoS)
+      /*=================================================================*/
+      struct sUMTSMinimumQoS
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 33 };
+            enum
+            {
+               OFFSET_TRAFFIC_CLASS = 0,
+               OFFSET_MAX_UPLINK_BITRATE = 1,
+               OFFSET_MAX_DOWNLINK_BITRATE = 5,
+               OFFSET_GUARANTEED_UPLINK_BITRATE = 9,
+               OFFSET_GUARANTEED_DOWNLINK_BITRATE = 13,
+               OFFSET_QOS_DELIVERY_ORDER = 17,
+               OFFSET_MAXIMUM_SDU_SIZE = 18,
+               OFFSET_SDU_ERROR_RATIO = 22,
+               OFFSET_RESIDUAL_BIT_ERROR_RATIO = 23,
+               OFFSET_DELIVERY_ERRONEOUS_SDU = 24,
+               OFFSET_TRANSFER_DELAY = 25,
+               OFFSET_TRAFFIC_HANDLING_PRIORITY = 29
+            };
+
+            // Type of value read
+            typedef sUMTSMinimumQoS tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sUMTSMinimumQoS()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sUMTSMinimumQoS( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Traffic Class
+            bool GetTrafficClass( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_TRAFFIC_CLASS,
+                                               value );
+            };
+
+            // (Inline) Return Max uplink bitrate
+            bool GetMaxUplinkBitrate( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_MAX_UPLINK_BITRATE,
+                                                value );
+            };
+
+            // (Inline) Return Max downlink bitrate
+            bool GetMaxDownlinkBitrate( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_MAX_DOWNLINK_BITRATE,
+                                                value );
+            };
+
+            // (Inline) Return Guaranteed uplink bitrate
+            bool GetGuaranteedUplinkBitrate( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_GUARANTEED_UPLINK_BITRATE,
+                                                value );
+            };
+
+            // (Inline) Return Guaranteed downlink bitrate
+            bool GetGuaranteedDownlinkBitrate( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_GUARANTEED_DOWNLINK_BITRATE,
+                                                value );
+            };
+
+            // (Inline) Return QoS Delivery Order
+            bool GetQoSDeliveryOrder( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_QOS_DELIVERY_ORDER,
+                                               value );
+            };
+
+            // (Inline) Return Maximum SDU Size
+            bool GetMaximumSDUSize( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_MAXIMUM_SDU_SIZE,
+                                                value );
+            };
+
+            // (Inline) Return SDU Error Ratio
+            bool GetSDUErrorRatio( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_SDU_ERROR_RATIO,
+                                               value );
+            };
+
+            // (Inline) Return Residual Bit Error Ratio
+            bool GetResidualBitErrorRatio( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_RESIDUAL_BIT_ERROR_RATIO,
+                                               value );
+            };
+
+            // (Inline) Return Delivery Erroneous SDU
+            bool GetDeliveryErroneousSDU( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_DELIVERY_ERRONEOUS_SDU,
+                                               value );
+            };
+
+            // (Inline) Return Transfer Delay
+            bool GetTransferDelay( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_TRANSFER_DELAY,
+                                                value );
+            };
+
+            // (Inline) Return Traffic Handling Priority
+            bool GetTrafficHandlingPriority( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_TRAFFIC_HANDLING_PRIORITY,
+                                                value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sGPRSRequestedQoS (GPRS Requested QoS)
+      /*=================================================================*/
+      struct sGPRSRequestedQoS
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 20 };
+            enum
+            {
+               OFFSET_PRECEDENCE_CLASS = 0,
+               OFFSET_DELAY_CLASS = 4,
+               OFFSET_RELIABILITY_CLASS = 8,
+               OFFSET_PEAK_THROUGHPUT_CLASS = 12,
+               OFFSET_MEAN_THROUGHPUT_CLASS = 16
+            };
+
+            // Type of value read
+            typedef sGPRSRequestedQoS tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sGPRSRequestedQoS()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sGPRSRequestedQoS( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Precedence Class
+            bool GetPrecedenceClass( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_PRECEDENCE_CLASS,
+                                                value );
+            };
+
+            // (Inline) Return Delay Class
+            bool GetDelayClass( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_DELAY_CLASS,
+                                                value );
+            };
+
+            // (Inline) Return Reliability Class
+            bool GetReliabilityClass( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_RELIABILITY_CLASS,
+                                                value );
+            };
+
+            // (Inline) Return Peak Throughput Class
+            bool GetPeakThroughputClass( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_PEAK_THROUGHPUT_CLASS,
+                                                value );
+            };
+
+            // (Inline) Return Mean Throughput Class
+            bool GetMeanThroughputClass( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_MEAN_THROUGHPUT_CLASS,
+                                                value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sGPRSMinimumQoS (GPRS Minimum QoS)
+      /*=================================================================*/
+      struct sGPRSMinimumQoS
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 20 };
+            enum
+            {
+               OFFSET_PRECEDENCE_CLASS = 0,
+               OFFSET_DELAY_CLASS = 4,
+               OFFSET_RELIABILITY_CLASS = 8,
+               OFFSET_PEAK_THROUGHPUT_CLASS = 12,
+               OFFSET_MEAN_THROUGHPUT_CLASS = 16
+            };
+
+            // Type of value read
+            typedef sGPRSMinimumQoS tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sGPRSMinimumQoS()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sGPRSMinimumQoS( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Precedence Class
+            bool GetPrecedenceClass( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_PRECEDENCE_CLASS,
+                                                value );
+            };
+
+            // (Inline) Return Delay Class
+            bool GetDelayClass( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_DELAY_CLASS,
+                                                value );
+            };
+
+            // (Inline) Return Reliability Class
+            bool GetReliabilityClass( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_RELIABILITY_CLASS,
+                                                value );
+            };
+
+            // (Inline) Return Peak Throughput Class
+            bool GetPeakThroughputClass( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_PEAK_THROUGHPUT_CLASS,
+                                                value );
+            };
+
+            // (Inline) Return Mean Throughput Class
+            bool GetMeanThroughputClass( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_MEAN_THROUGHPUT_CLASS,
+                                                value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // Array view of IPv6 Address Preference Address
+      typedef cQMIArrayView <sQMIInt <WORD, 2, true>, 0, 8> tIPv6AddressPreferenceAddress;
+
+      /*=================================================================*/
+      // Struct sIPv6AddressPreference (IPv6 Address Preference)
+      /*=================================================================*/
+      struct sIPv6AddressPreference
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 16 };
+            enum
+            {
+               OFFSET_ADDRESS = 0
+            };
+
+            // Type of value read
+            typedef sIPv6AddressPreference tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sIPv6AddressPreference()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sIPv6AddressPreference( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Address
+            bool GetAddress( tIPv6AddressPreferenceAddress & value ) const
+            {
+               return tIPv6AddressPreferenceAddress::Read( mView,
+                                                           OFFSET_ADDRESS,
+                                                           value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sUMTSRequestedQoSWithSignalingIndicationFlag (UMTS Requested QoS With Signaling Indication Flag)
+      /*=================================================================*/
+      struct sUMTSRequestedQoSWithSignalingIndicationFlag
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 34 };
+            enum
+            {
+               OFFSET_TRAFFIC_CLASS = 0,
+               OFFSET_MAX_UPLINK_BITRATE = 1,
+               OFFSET_MAX_DOWNLINK_BITRATE = 5,
+               OFFSET_GUARANTEED_UPLINK_BITRATE = 9,
+               OFFSET_GUARANTEED_DOWNLINK_BITRATE = 13,
+               OFFSET_QOS_DELIVERY_ORDER = 17,
+               OFFSET_MAXIMUM_SDU_SIZE = 18,
+               OFFSET_SDU_ERROR_RATIO = 22,
+               OFFSET_RESIDUAL_BIT_ERROR_RATIO = 23,
+               OFFSET_DELIVERY_ERRONEOUS_SDU = 24,
+               OFFSET_TRANSFER_DELAY = 25,
+               OFFSET_TRAFFIC_HANDLING_PRIORITY = 29,
+               OFFSET_SIGNALING_INDICATION = 33
+            };
+
+            // Type of value read
+            typedef sUMTSRequestedQoSWithSignalingIndicationFlag tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sUMTSRequestedQoSWithSignalingIndicationFlag()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sUMTSRequestedQoSWithSignalingIndicationFlag( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Traffic Class
+            bool GetTrafficClass( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_TRAFFIC_CLASS,
+                                               value );
+            };
+
+            // (Inline) Return Max uplink bitrate
+            bool GetMaxUplinkBitrate( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_MAX_UPLINK_BITRATE,
+                                                value );
+            };
+
+            // (Inline) Return Max downlink bitrate
+            bool GetMaxDownlinkBitrate( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_MAX_DOWNLINK_BITRATE,
+                                                value );
+            };
+
+            // (Inline) Return Guaranteed uplink bitrate
+            bool GetGuaranteedUplinkBitrate( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_GUARANTEED_UPLINK_BITRATE,
+                                                value );
+            };
+
+            // (Inline) Return Guaranteed downlink bitrate
+            bool GetGuaranteedDownlinkBitrate( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_GUARANTEED_DOWNLINK_BITRATE,
+                                                value );
+            };
+
+            // (Inline) Return QoS Delivery Order
+            bool GetQoSDeliveryOrder( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_QOS_DELIVERY_ORDER,
+                                               value );
+            };
+
+            // (Inline) Return Maximum SDU Size
+            bool GetMaximumSDUSize( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_MAXIMUM_SDU_SIZE,
+                                                value );
+            };
+
+            // (Inline) Return SDU Error Ratio
+            bool GetSDUErrorRatio( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_SDU_ERROR_RATIO,
+                                               value );
+            };
+
+            // (Inline) Return Residual Bit Error Ratio
+            bool GetResidualBitErrorRatio( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_RESIDUAL_BIT_ERROR_RATIO,
+                                               value );
+            };
+
+            // (Inline) Return Delivery Erroneous SDU
+            bool GetDeliveryErroneousSDU( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_DELIVERY_ERRONEOUS_SDU,
+                                               value );
+            };
+
+            // (Inline) Return Transfer Delay
+            bool GetTransferDelay( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_TRANSFER_DELAY,
+                                                value );
+            };
+
+            // (Inline) Return Traffic Handling Priority
+            bool GetTrafficHandlingPriority( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_TRAFFIC_HANDLING_PRIORITY,
+                                                value );
+            };
+
+            // (Inline) Return Signaling Indication
+            bool GetSignalingIndication( INT8 & value ) const
+            {
+               return sQMIInt <INT8, 1>::Read( mView,
+                                               OFFSET_SIGNALING_INDICATION,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sUMTSMinimumQoSWithSignalingIndicationFlag (UMTS Minimum QoS With Signaling Indication Flag)
+      /*=================================================================*/
+      struct sUMTSMinimumQoSWithSignalingIndicationFlag
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 34 };
+            enum
+            {
+               OFFSET_TRAFFIC_CLASS = 0,
+               OFFSET_MAX_UPLINK_BITRATE = 1,
+               OFFSET_MAX_DOWNLINK_BITRATE = 5,
+               OFFSET_GUARANTEED_UPLINK_BITRATE = 9,
+               OFFSET_GUARANTEED_DOWNLINK_BITRATE = 13,
+               OFFSET_QOS_DELIVERY_ORDER = 17,
+               OFFSET_MAXIMUM_SDU_SIZE = 18,
+               OFFSET_SDU_ERROR_RATIO = 22,
+               OFFSET_RESIDUAL_BIT_ERROR_RATIO = 23,
+               OFFSET_DELIVERY_ERRONEOUS_SDU = 24,
+               OFFSET_TRANSFER_DELAY = 25,
+               OFFSET_TRAFFIC_HANDLING_PRIORITY = 29,
+               OFFSET_SIGNALING_INDICATION = 33
+            };
+
+            // Type of value read
+            typedef sUMTSMinimumQoSWithSignalingIndicationFlag tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sUMTSMinimumQoSWithSignalingIndicationFlag()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sUMTSMinimumQoSWithSignalingIndicationFlag( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Traffic Class
+            bool GetTrafficClass( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_TRAFFIC_CLASS,
+                                               value );
+            };
+
+            // (Inline) Return Max uplink bitrate
+            bool GetMaxUplinkBitrate( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_MAX_UPLINK_BITRATE,
+                                                value );
+            };
+
+            // (Inline) Return Max downlink bitrate
+            bool GetMaxDownlinkBitrate( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_MAX_DOWNLINK_BITRATE,
+                                                value );
+            };
+
+            // (Inline) Return Guaranteed uplink bitrate
+            bool GetGuaranteedUplinkBitrate( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_GUARANTEED_UPLINK_BITRATE,
+                                                value );
+            };
+
+            // (Inline) Return Guaranteed downlink bitrate
+            bool GetGuaranteedDownlinkBitrate( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_GUARANTEED_DOWNLINK_BITRATE,
+                                                value );
+            };
+
+            // (Inline) Return QoS Delivery Order
+            bool GetQoSDeliveryOrder( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_QOS_DELIVERY_ORDER,
+                                               value );
+            };
+
+            // (Inline) Return Maximum SDU Size
+            bool GetMaximumSDUSize( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_MAXIMUM_SDU_SIZE,
+                                                value );
+            };
+
+            // (Inline) Return SDU Error Ratio
+            bool GetSDUErrorRatio( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_SDU_ERROR_RATIO,
+                                               value );
+            };
+
+            // (Inline) Return Residual Bit Error Ratio
+            bool GetResidualBitErrorRatio( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_RESIDUAL_BIT_ERROR_RATIO,
+                                               value );
+            };
+
+            // (Inline) Return Delivery Erroneous SDU
+            bool GetDeliveryErroneousSDU( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_DELIVERY_ERRONEOUS_SDU,
+                                               value );
+            };
+
+            // (Inline) Return Transfer Delay
+            bool GetTransferDelay( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_TRANSFER_DELAY,
+                                                value );
+            };
+
+            // (Inline) Return Traffic Handling Priority
+            bool GetTrafficHandlingPriority( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_TRAFFIC_HANDLING_PRIORITY,
+                                                value );
+            };
+
+            // (Inline) Return Signaling Indication
+            bool GetSignalingIndication( INT8 & value ) const
+            {
+               return sQMIInt <INT8, 1>::Read( mView,
+                                               OFFSET_SIGNALING_INDICATION,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // Array view of IPv6 Primary DNS Address Preference
+      typedef cQMIArrayView <sQMIInt <WORD, 2, true>, 0, 8> tIPv6PrimaryDNSAddressPreference;
+
+      // Array view of IPv6 Secondary DNS Address Preference
+      typedef cQMIArrayView <sQMIInt <WORD, 2, true>, 0, 8> tIPv6SecondaryDNSAddressPreference;
+
+      /*=================================================================*/
+      // Struct sLTEQoSParameters (LTE QoS Parameters)
+      /*=================================================================*/
+      struct sLTEQoSParameters
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 17 };
+            enum
+            {
+               OFFSET_QOS_CLASS_IDENTIFIER = 0,
+               OFFSET_GUARANTEED_DOWNLINK_BITRATE = 1,
+               OFFSET_MAX_DOWNLINK_BITRATE = 5,
+               OFFSET_GUARANTEED_UPLINK_BITRATE = 9,
+               OFFSET_MAX_UPLINK_BITRATE = 13
+            };
+
+            // Type of value read
+            typedef sLTEQoSParameters tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sLTEQoSParameters()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sLTEQoSParameters( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return QoS Class Identifier
+            bool GetQoSClassIdentifier( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_QOS_CLASS_IDENTIFIER,
+                                               value );
+            };
+
+            // (Inline) Return Guaranteed Downlink Bitrate
+            bool GetGuaranteedDownlinkBitrate( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_GUARANTEED_DOWNLINK_BITRATE,
+                                                value );
+            };
+
+            // (Inline) Return Max Downlink Bitrate
+            bool GetMaxDownlinkBitrate( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_MAX_DOWNLINK_BITRATE,
+                                                value );
+            };
+
+            // (Inline) Return Guaranteed Uplink Bitrate
+            bool GetGuaranteedUplinkBitrate( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_GUARANTEED_UPLINK_BITRATE,
+                                                value );
+            };
+
+            // (Inline) Return Max Uplink Bitrate
+            bool GetMaxUplinkBitrate( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_MAX_UPLINK_BITRATE,
+                                                value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // (Inline) Constructor (from the TLVs of the message)
+      cQMIViewWDSGetProfileSettingsRsp(
+         const BYTE *               pTLVs,
+         ULONG                      sz )
+         :  cQMIMessageView <cQMIViewWDSGetProfileSettingsRsp, 31>( pTLVs, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Constructor (from a QMI service response)
+      cQMIViewWDSGetProfileSettingsRsp( const sProtocolBuffer & buf )
+         :  cQMIMessageView <cQMIViewWDSGetProfileSettingsRsp, 31>( buf )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Map a TLV type ID to its slot (-1 if unknown)
+      static int GetSlot( BYTE typeID )
+      {
+         switch (typeID)
+         {
+            case TLV_RESULT:
+               return 0;
+            case TLV_PROFILE_NAME:
+               return 1;
+            case TLV_PDP_TYPE:
+               return 2;
+            case TLV_PDP_HEADER_COMPRESSION_TYPE:
+               return 3;
+            case TLV_PDP_DATA_COMPRESSION_TYPE:
+               return 4;
+            case TLV_APN_NAME:
+               return 5;
+            case TLV_PRIMARY_IPV4_DNS_ADDRESS:
+               return 6;
+            case TLV_SECONDARY_IPV4_DNS_ADDRESS:
+               return 7;
+            case TLV_UMTS_REQUESTED_QOS:
+               return 8;
+            case TLV_UMTS_MINIMUM_QOS:
+               return 9;
+            case TLV_GPRS_REQUESTED_QOS:
+               return 10;
+            case TLV_GPRS_MINIMUM_QOS:
+               return 11;
+            case TLV_USERNAME:
+               return 12;
+            case TLV_PASSWORD:
+               return 13;
+            case TLV_AUTHENTICATION:
+               return 14;
+            case TLV_IPV4_ADDRESS_PREFERENCE:
+               return 15;
+            case TLV_PCSCF_ADDRESS_USING_PCO:
+               return 16;
+            case TLV_PCSCF_ADDRESS_USING_DHCP:
+               return 17;
+            case TLV_IMCN_FLAG:
+               return 18;
+            case TLV_PDP_CONTEXT_NUMBER:
+               return 19;
+            case TLV_PDP_CONTEXT_SECONDARY_FLAG:
+               return 20;
+            case TLV_PDP_CONTEXT_PRIMARY_ID:
+               return 21;
+            case TLV_IPV6_ADDRESS_PREFERENCE:
+               return 22;
+            case TLV_UMTS_REQUESTED_QOS_WITH_SIGNALING_INDICATION_FLAG:
+               return 23;
+            case TLV_UMTS_MINIMUM_QOS_WITH_SIGNALING_INDICATION_FLAG:
+               return 24;
+            case TLV_IPV6_PRIMARY_DNS_ADDRESS_PREFERENCE:
+               return 25;
+            case TLV_IPV6_SECONDARY_DNS_ADDRESS_PREFERENCE:
+               return 26;
+            case TLV_LTE_QOS_PARAMETERS:
+               return 27;
+            case TLV_APN_DISABLED_FLAG:
+               return 28;
+            case TLV_ROAMING_DISALLOWED_FLAG:
+               return 29;
+            case TLV_EXTENDED_ERROR_CODE:
+               return 30;
+         }
+
+         return -1;
+      };
+
+      // (Inline) Return Result
+      bool GetResult( sResult & value ) const
+      {
+         return sResult::Read( mTLVs[0], 0, value );
+      };
+
+      // (Inline) Return contents of mandatory result content
+      bool GetResult(
+         ULONG &                    returnCode,
+         ULONG &                    errorCode ) const
+      {
+         sResult result;
+         WORD rc = 0;
+         WORD ec = 0;
+         if ( (GetResult( result ) == false)
+         ||   (result.GetErrorStatus( rc ) == false)
+         ||   (result.GetErrorCode( ec ) == false) )
+         {
+            return false;
+         }
+
+         returnCode = (ULONG)rc;
+         errorCode = (ULONG)ec;
+         return true;
+      };
+
+      // (Inline) Return Profile Name
+      bool GetProfileName( sQMIView & value ) const
+      {
+         return sQMIString <0>::Read( mTLVs[1], 0, value );
+      };
+
+      // (Inline) Return PDP Type
+      bool GetPDPType( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[2], 0, value );
+      };
+
+      // (Inline) Return PDP Header Compression Type
+      bool GetPDPHeaderCompressionType( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[3], 0, value );
+      };
+
+      // (Inline) Return PDP Data Compression Type
+      bool GetPDPDataCompressionType( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[4], 0, value );
+      };
+
+      // (Inline) Return APN Name
+      bool GetAPNName( sQMIView & value ) const
+      {
+         return sQMIString <0>::Read( mTLVs[5], 0, value );
+      };
+
+      // (Inline) Return Primary IPv4 DNS Address
+      bool GetPrimaryIPv4DNSAddress( ULONG & value ) const
+      {
+         return sQMIInt <ULONG, 4>::Read( mTLVs[6], 0, value );
+      };
+
+      // (Inline) Return Secondary IPv4 DNS Address
+      bool GetSecondaryIPv4DNSAddress( ULONG & value ) const
+      {
+         return sQMIInt <ULONG, 4>::Read( mTLVs[7], 0, value );
+      };
+
+      // (Inline) Return UMTS Requested QoS
+      bool GetUMTSRequestedQoS( sUMTSRequestedQoS & value ) const
+      {
+         return sUMTSRequestedQoS::Read( mTLVs[8], 0, value );
+      };
+
+      // (Inline) Return UMTS Minimum QoS
+      bool GetUMTSMinimumQoS( sUMTSMinimumQoS & value ) const
+      {
+         return sUMTSMinimumQoS::Read( mTLVs[9], 0, value );
+      };
+
+      // (Inline) Return GPRS Requested QoS
+      bool GetGPRSRequestedQoS( sGPRSRequestedQoS & value ) const
+      {
+         return sGPRSRequestedQoS::Read( mTLVs[10], 0, value );
+      };
+
+      // (Inline) Return GPRS Minimum QoS
+      bool GetGPRSMinimumQoS( sGPRSMinimumQoS & value ) const
+      {
+         return sGPRSMinimumQoS::Read( mTLVs[11], 0, value );
+      };
+
+      // (Inline) Return Username
+      bool GetUsername( sQMIView & value ) const
+      {
+         return sQMIString <0>::Read( mTLVs[12], 0, value );
+      };
+
+      // (Inline) Return Password
+      bool GetPassword( sQMIView & value ) const
+      {
+         return sQMIString <0>::Read( mTLVs[13], 0, value );
+      };
+
+      // (Inline) Return Authentication
+      bool GetAuthentication( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[14], 0, value );
+      };
+
+      // (Inline) Return IPv4 Address Preference
+      bool GetIPv4AddressPreference( ULONG & value ) const
+      {
+         return sQMIInt <ULONG, 4>::Read( mTLVs[15], 0, value );
+      };
+
+      // (Inline) Return PCSCF Address Using PCO
+      bool GetPCSCFAddressUsingPCO( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[16], 0, value );
+      };
+
+      // (Inline) Return PCSCF Address Using DHCP
+      bool GetPCSCFAddressUsingDHCP( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[17], 0, value );
+      };
+
+      // (Inline) Return IMCN Flag
+      bool GetIMCNFlag( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[18], 0, value );
+      };
+
+      // (Inline) Return PDP Context Number
+      bool GetPDPContextNumber( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[19], 0, value );
+      };
+
+      // (Inline) Return PDP Context Secondary Flag
+      bool GetPDPContextSecondaryFlag( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[20], 0, value );
+      };
+
+      // (Inline) Return PDP Context Primary ID
+      bool GetPDPContextPrimaryID( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[21], 0, value );
+      };
+
+      // (Inline) Return IPv6 Address Preference
+      bool GetIPv6AddressPreference( sIPv6AddressPreference & value ) const
+      {
+         return sIPv6AddressPreference::Read( mTLVs[22], 0, value );
+      };
+
+      // (Inline) Return UMTS Requested QoS With Signaling Indication Flag
+      bool GetUMTSRequestedQoSWithSignalingIndicationFlag( sUMTSRequestedQoSWithSignalingIndicationFlag & value ) const
+      {
+         return sUMTSRequestedQoSWithSignalingIndicationFlag::Read( mTLVs[23],
+                                                                    0,
+                                                                    value );
+      };
+
+      // (Inline) Return UMTS Minimum QoS With Signaling Indication Flag
+      bool GetUMTSMinimumQoSWithSignalingIndicationFlag( sUMTSMinimumQoSWithSignalingIndicationFlag & value ) const
+      {
+         return sUMTSMinimumQoSWithSignalingIndicationFlag::Read( mTLVs[24],
+                                                                  0,
+                                                                  value );
+      };
+
+      // (Inline) Return IPv6 Primary DNS Address Preference
+      bool GetIPv6PrimaryDNSAddressPreference( tIPv6PrimaryDNSAddressPreference & value ) const
+      {
+         return tIPv6PrimaryDNSAddressPreference::Read( mTLVs[25], 0, value );
+      };
+
+      // (Inline) Return IPv6 Secondary DNS Address Preference
+      bool GetIPv6SecondaryDNSAddressPreference( tIPv6SecondaryDNSAddressPreference & value ) const
+      {
+         return tIPv6SecondaryDNSAddressPreference::Read( mTLVs[26],
+                                                          0,
+                                                          value );
+      };
+
+      // (Inline) Return LTE QoS Parameters
+      bool GetLTEQoSParameters( sLTEQoSParameters & value ) const
+      {
+         return sLTEQoSParameters::Read( mTLVs[27], 0, value );
+      };
+
+      // (Inline) Return APN Disabled Flag
+      bool GetAPNDisabledFlag( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[28], 0, value );
+      };
+
+      // (Inline) Return Roaming Disallowed Flag
+      bool GetRoamingDisallowedFlag( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[29], 0, value );
+      };
+
+      // (Inline) Return Extended Error Code
+      bool GetExtendedErrorCode( WORD & value ) const
+      {
+         return sQMIInt <WORD, 2>::Read( mTLVs[30], 0, value );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIWriterWDSGetCurrentSettingsReq
+//    Writer of the WDS Get Current Settings request
+/*=========================================================================*/
+class cQMIWriterWDSGetCurrentSettingsReq : public cQMIMessageWriter
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x002D };
+
+      // TLV type IDs
+      enum
+      {
+         TLV_REQUESTED_SETTINGS = 0x10
+      };
+
+      // (Inline) Constructor
+      cQMIWriterWDSGetCurrentSettingsReq(
+         BYTE *                     pBuffer,
+         ULONG                      sz )
+         :  cQMIMessageWriter( pBuffer, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Build the QMI request from the encoded TLVs
+      sSharedBuffer * BuildRequest() const
+      {
+         return cQMIMessageWriter::BuildRequest( eQMI_SVC_WDS,
+                                                (WORD)MESSAGE_ID );
+      };
+
+      // (Inline) Set Requested Settings
+      bool SetRequestedSettings( ULONG value )
+      {
+         BYTE * pValue = AddTLV( (BYTE)TLV_REQUESTED_SETTINGS, 4 );
+         if (pValue == 0)
+         {
+            return false;
+         }
+
+         sQMIInt <ULONG, 4>::Write( pValue, value );
+         return true;
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIViewWDSGetCurrentSettingsRsp
+//    View of the WDS Get Current Settings response
+/*=========================================================================*/
+class cQMIViewWDSGetCurrentSettingsRsp : public cQMIMessageView <cQMIViewWDSGetCurrentSettingsRsp, 26>
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x002D };
+
+      // TLV type IDs
+      enum
+      {
+         TLV_RESULT = 0x02,
+         TLV_PROFILE_NAME = 0x10,
+         TLV_PDP_TYPE = 0x11,
+         TLV_APN_NAME = 0x14,
+         TLV_PRIMARY_IPV4_DNS_ADDRESS = 0x15,
+         TLV_SECONDARY_IPV4_DNS_ADDRESS = 0x16,
+         TLV_UMTS_GRANTED_QOS = 0x17,
+         TLV_GPRS_GRANTED_QOS = 0x19,
+         TLV_USERNAME = 0x1B,
+         TLV_AUTHENTICATION = 0x1D,
+         TLV_IPV4_ADDRESS = 0x1E,
+         TLV_PROFILE_ID = 0x1F,
+         TLV_IPV4_GATEWAY_ADDRESS = 0x20,
+         TLV_IPV4_GATEWAY_SUBNET_MASK = 0x21,
+         TLV_PCSCF_ADDRESS_USING_PCO = 0x22,
+         TLV_PCSCF_SERVER_ADDRESS_LIST = 0x23,
+         TLV_PCSCF_DOMAIN_NAME_LIST = 0x24,
+         TLV_IPV6_ADDRESS = 0x25,
+         TLV_IPV6_GATEWAY_ADDRESS = 0x26,
+         TLV_IPV6_PRIMARY_DNS_ADDRESS = 0x27,
+         TLV_IPV6_SECONDARY_DNS_ADDRESS = 0x28,
+         TLV_MTU = 0x29,
+         TLV_DOMAIN_NAME_LIST = 0x2A,
+         TLV_IP_FAMILY = 0x2B,
+         TLV_IMCN_FLAG = 0x2C,
+         TLV_EXTENDED_TECHNOLOGY_PREFERENCE = 0x2D
+      };
+
+      /*=================================================================*/
+      // Struct sResult (Result)
+      /*=================================================================*/
+      struct sResult
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 4 };
+            enum
+            {
+               OFFSET_ERROR_STATUS = 0,
+               OFFSET_ERROR_CODE = 2
+            };
+
+            // Type of value read
+            typedef sResult tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sResult()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sResult( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Error Status
+            bool GetErrorStatus( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_STATUS,
+                                               value );
+            };
+
+            // (Inline) Return Error Code
+            bool GetErrorCode( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_CODE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sUMTSGrantedQoS (UMTS Granted QoS)
+      /*=================================================================*/
+      struct sUMTSGrantedQoS
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 33 };
+            enum
+            {
+               OFFSET_TRAFFIC_CLASS = 0,
+               OFFSET_MAX_UPLINK_BITRATE = 1,
+               OFFSET_MAX_DOWNLINK_BITRATE = 5,
+               OFFSET_GUARANTEED_UPLINK_BITRATE = 9,
+               OFFSET_GUARANTEED_DOWNLINK_BITRATE = 13,
+               OFFSET_QOS_DELIVERY_ORDER = 17,
+               OFFSET_MAXIMUM_SDU_SIZE = 18,
+               OFFSET_SDU_ERROR_RATIO = 22,
+               OFFSET_RESIDUAL_BIT_ERROR_RATIO = 23,
+               OFFSET_DELIVERY_ERRONEOUS_SDU = 24,
+               OFFSET_TRANSFER_DELAY = 25,
+               OFFSET_TRAFFIC_HANDLING_PRIORITY = 29
+            };
+
+            // Type of value read
+            typedef sUMTSGrantedQoS tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sUMTSGrantedQoS()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sUMTSGrantedQoS( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Traffic Class
+            bool GetTrafficClass( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_TRAFFIC_CLASS,
+                                               value );
+            };
+
+            // (Inline) Return Max uplink bitrate
+            bool GetMaxUplinkBitrate( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_MAX_UPLINK_BITRATE,
+                                                value );
+            };
+
+            // (Inline) Return Max downlink bitrate
+            bool GetMaxDownlinkBitrate( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_MAX_DOWNLINK_BITRATE,
+                                                value );
+            };
+
+            // (Inline) Return Guaranteed uplink bitrate
+            bool GetGuaranteedUplinkBitrate( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_GUARANTEED_UPLINK_BITRATE,
+                                                value );
+            };
+
+            // (Inline) Return Guaranteed downlink bitrate
+            bool GetGuaranteedDownlinkBitrate( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_GUARANTEED_DOWNLINK_BITRATE,
+                                                value );
+            };
+
+            // (Inline) Return QoS Delivery Order
+            bool GetQoSDeliveryOrder( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_QOS_DELIVERY_ORDER,
+                                               value );
+            };
+
+            // (Inline) Return Maximum SDU Size
+            bool GetMaximumSDUSize( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_MAXIMUM_SDU_SIZE,
+                                                value );
+            };
+
+            // (Inline) Return SDU Error Ratio
+            bool GetSDUErrorRatio( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_SDU_ERROR_RATIO,
+                                               value );
+            };
+
+            // (Inline) Return Residual Bit Error Ratio
+            bool GetResidualBitErrorRatio( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_RESIDUAL_BIT_ERROR_RATIO,
+                                               value );
+            };
+
+            // (Inline) Return Delivery Erroneous SDU
+            bool GetDeliveryErroneousSDU( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_DELIVERY_ERRONEOUS_SDU,
+                                               value );
+            };
+
+            // (Inline) Return Transfer Delay
+            bool GetTransferDelay( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_TRANSFER_DELAY,
+                                                value );
+            };
+
+            // (Inline) Return Traffic Handling Priority
+            bool GetTrafficHandlingPriority( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_TRAFFIC_HANDLING_PRIORITY,
+                                                value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sGPRSGrantedQoS (GPRS Granted QoS)
+      /*=================================================================*/
+      struct sGPRSGrantedQoS
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 20 };
+            enum
+            {
+               OFFSET_PRECEDENCE_CLASS = 0,
+               OFFSET_DELAY_CLASS = 4,
+               OFFSET_RELIABILITY_CLASS = 8,
+               OFFSET_PEAK_THROUGHPUT_CLASS = 12,
+               OFFSET_MEAN_THROUGHPUT_CLASS = 16
+            };
+
+            // Type of value read
+            typedef sGPRSGrantedQoS tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sGPRSGrantedQoS()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sGPRSGrantedQoS( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Precedence Class
+            bool GetPrecedenceClass( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_PRECEDENCE_CLASS,
+                                                value );
+            };
+
+            // (Inline) Return Delay Class
+            bool GetDelayClass( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_DELAY_CLASS,
+                                                value );
+            };
+
+            // (Inline) Return Reliability Class
+            bool GetReliabilityClass( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_RELIABILITY_CLASS,
+                                                value );
+            };
+
+            // (Inline) Return Peak Throughput Class
+            bool GetPeakThroughputClass( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_PEAK_THROUGHPUT_CLASS,
+                                                value );
+            };
+
+            // (Inline) Return Mean Throughput Class
+            bool GetMeanThroughputClass( ULONG & value ) const
+            {
+               return sQMIInt <ULONG, 4>::Read( mView,
+                                                OFFSET_MEAN_THROUGHPUT_CLASS,
+                                                value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      /*=================================================================*/
+      // Struct sProfileID (Profile ID)
+      /*=================================================================*/
+      struct sProfileID
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 2 };
+            enum
+            {
+               OFFSET_PROFILE_TYPE = 0,
+               OFFSET_PROFILE_INDEX = 1
+            };
+
+            // Type of value read
+            typedef sProfileID tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sProfileID()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sProfileID( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Profile Type
+            bool GetProfileType( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_PROFILE_TYPE,
+                                               value );
+            };
+
+            // (Inline) Return Profile Index
+            bool GetProfileIndex( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_PROFILE_INDEX,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // Array view of PCSCF Server Address List
+      typedef cQMIArrayView <sQMIInt <ULONG, 4>, 1> tPCSCFServerAddressList;
+
+      // Array view of PCSCF Domain Name List
+      typedef cQMIArrayView <sQMIString <2>, 1> tPCSCFDomainNameList;
+
+      // Array view of IPv6 Address Address
+      typedef cQMIArrayView <sQMIInt <WORD, 2, true>, 0, 8> tIPv6AddressAddress;
+
+      /*=================================================================*/
+      // Struct sIPv6Address (IPv6 Address)
+      /*=================================================================*/
+      struct sIPv6Address
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 17 };
+            enum
+            {
+               OFFSET_ADDRESS = 0,
+               OFFSET_PREFIX_LENGTH = 16
+            };
+
+            // Type of value read
+            typedef sIPv6Address tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sIPv6Address()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sIPv6Address( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Address
+            bool GetAddress( tIPv6AddressAddress & value ) const
+            {
+               return tIPv6AddressAddress::Read( mView,
+                                                 OFFSET_ADDRESS,
+                                                 value );
+            };
+
+            // (Inline) Return Prefix Length
+            bool GetPrefixLength( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_PREFIX_LENGTH,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // Array view of IPv6 Gateway Address Address
+      typedef cQMIArrayView <sQMIInt <WORD, 2, true>, 0, 8> tIPv6GatewayAddressAddress;
+
+      /*=================================================================*/
+      // Struct sIPv6GatewayAddress (IPv6 Gateway Address)
+      /*=================================================================*/
+      struct sIPv6GatewayAddress
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 17 };
+            enum
+            {
+               OFFSET_ADDRESS = 0,
+               OFFSET_PREFIX_LENGTH = 16
+            };
+
+            // Type of value read
+            typedef sIPv6GatewayAddress tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sIPv6GatewayAddress()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sIPv6GatewayAddress( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Address
+            bool GetAddress( tIPv6GatewayAddressAddress & value ) const
+            {
+               return tIPv6GatewayAddressAddress::Read( mView,
+                                                        OFFSET_ADDRESS,
+                                                        value );
+            };
+
+            // (Inline) Return Prefix Length
+            bool GetPrefixLength( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_PREFIX_LENGTH,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // Array view of IPv6 Primary DNS Address
+      typedef cQMIArrayView <sQMIInt <WORD, 2, true>, 0, 8> tIPv6PrimaryDNSAddress;
+
+      // Array view of IPv6 Secondary DNS Address
+      typedef cQMIArrayView <sQMIInt <WORD, 2, true>, 0, 8> tIPv6SecondaryDNSAddress;
+
+      // Array view of Domain Name List
+      typedef cQMIArrayView <sQMIString <2>, 1> tDomainNameList;
+
+      // (Inline) Constructor (from the TLVs of the message)
+      cQMIViewWDSGetCurrentSettingsRsp(
+         const BYTE *               pTLVs,
+         ULONG                      sz )
+         :  cQMIMessageView <cQMIViewWDSGetCurrentSettingsRsp, 26>( pTLVs, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Constructor (from a QMI service response)
+      cQMIViewWDSGetCurrentSettingsRsp( const sProtocolBuffer & buf )
+         :  cQMIMessageView <cQMIViewWDSGetCurrentSettingsRsp, 26>( buf )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Map a TLV type ID to its slot (-1 if unknown)
+      static int GetSlot( BYTE typeID )
+      {
+         switch (typeID)
+         {
+            case TLV_RESULT:
+               return 0;
+            case TLV_PROFILE_NAME:
+               return 1;
+            case TLV_PDP_TYPE:
+               return 2;
+            case TLV_APN_NAME:
+               return 3;
+            case TLV_PRIMARY_IPV4_DNS_ADDRESS:
+               return 4;
+            case TLV_SECONDARY_IPV4_DNS_ADDRESS:
+               return 5;
+            case TLV_UMTS_GRANTED_QOS:
+               return 6;
+            case TLV_GPRS_GRANTED_QOS:
+               return 7;
+            case TLV_USERNAME:
+               return 8;
+            case TLV_AUTHENTICATION:
+               return 9;
+            case TLV_IPV4_ADDRESS:
+               return 10;
+            case TLV_PROFILE_ID:
+               return 11;
+            case TLV_IPV4_GATEWAY_ADDRESS:
+               return 12;
+            case TLV_IPV4_GATEWAY_SUBNET_MASK:
+               return 13;
+            case TLV_PCSCF_ADDRESS_USING_PCO:
+               return 14;
+            case TLV_PCSCF_SERVER_ADDRESS_LIST:
+               return 15;
+            case TLV_PCSCF_DOMAIN_NAME_LIST:
+               return 16;
+            case TLV_IPV6_ADDRESS:
+               return 17;
+            case TLV_IPV6_GATEWAY_ADDRESS:
+               return 18;
+            case TLV_IPV6_PRIMARY_DNS_ADDRESS:
+               return 19;
+            case TLV_IPV6_SECONDARY_DNS_ADDRESS:
+               return 20;
+            case TLV_MTU:
+               return 21;
+            case TLV_DOMAIN_NAME_LIST:
+               return 22;
+            case TLV_IP_FAMILY:
+               return 23;
+            case TLV_IMCN_FLAG:
+               return 24;
+            case TLV_EXTENDED_TECHNOLOGY_PREFERENCE:
+               return 25;
+         }
+
+         return -1;
+      };
+
+      // (Inline) Return Result
+      bool GetResult( sResult & value ) const
+      {
+         return sResult::Read( mTLVs[0], 0, value );
+      };
+
+      // (Inline) Return contents of mandatory result content
+      bool GetResult(
+         ULONG &                    returnCode,
+         ULONG &                    errorCode ) const
+      {
+         sResult result;
+         WORD rc = 0;
+         WORD ec = 0;
+         if ( (GetResult( result ) == false)
+         ||   (result.GetErrorStatus( rc ) == false)
+         ||   (result.GetErrorCode( ec ) == false) )
+         {
+            return false;
+         }
+
+         returnCode = (ULONG)rc;
+         errorCode = (ULONG)ec;
+         return true;
+      };
+
+      // (Inline) Return Profile Name
+      bool GetProfileName( sQMIView & value ) const
+      {
+         return sQMIString <0>::Read( mTLVs[1], 0, value );
+      };
+
+      // (Inline) Return PDP Type
+      bool GetPDPType( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[2], 0, value );
+      };
+
+      // (Inline) Return APN Name
+      bool GetAPNName( sQMIView & value ) const
+      {
+         return sQMIString <0>::Read( mTLVs[3], 0, value );
+      };
+
+      // (Inline) Return Primary IPv4 DNS Address
+      bool GetPrimaryIPv4DNSAddress( ULONG & value ) const
+      {
+         return sQMIInt <ULONG, 4>::Read( mTLVs[4], 0, value );
+      };
+
+      // (Inline) Return Secondary IPv4 DNS Address
+      bool GetSecondaryIPv4DNSAddress( ULONG & value ) const
+      {
+         return sQMIInt <ULONG, 4>::Read( mTLVs[5], 0, value );
+      };
+
+      // (Inline) Return UMTS Granted QoS
+      bool GetUMTSGrantedQoS( sUMTSGrantedQoS & value ) const
+      {
+         return sUMTSGrantedQoS::Read( mTLVs[6], 0, value );
+      };
+
+      // (Inline) Return GPRS Granted QoS
+      bool GetGPRSGrantedQoS( sGPRSGrantedQoS & value ) const
+      {
+         return sGPRSGrantedQoS::Read( mTLVs[7], 0, value );
+      };
+
+      // (Inline) Return Username
+      bool GetUsername( sQMIView & value ) const
+      {
+         return sQMIString <0>::Read( mTLVs[8], 0, value );
+      };
+
+      // (Inline) Return Authentication
+      bool GetAuthentication( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[9], 0, value );
+      };
+
+      // (Inline) Return IPv4 Address
+      bool GetIPv4Address( ULONG & value ) const
+      {
+         return sQMIInt <ULONG, 4>::Read( mTLVs[10], 0, value );
+      };
+
+      // (Inline) Return Profile ID
+      bool GetProfileID( sProfileID & value ) const
+      {
+         return sProfileID::Read( mTLVs[11], 0, value );
+      };
+
+      // (Inline) Return IPv4 Gateway Address
+      bool GetIPv4GatewayAddress( ULONG & value ) const
+      {
+         return sQMIInt <ULONG, 4>::Read( mTLVs[12], 0, value );
+      };
+
+      // (Inline) Return IPv4 Gateway Subnet Mask
+      bool GetIPv4GatewaySubnetMask( ULONG & value ) const
+      {
+         return sQMIInt <ULONG, 4>::Read( mTLVs[13], 0, value );
+      };
+
+      // (Inline) Return PCSCF Address Using PCO
+      bool GetPCSCFAddressUsingPCO( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[14], 0, value );
+      };
+
+      // (Inline) Return PCSCF Server Address List
+      bool GetPCSCFServerAddressList( tPCSCFServerAddressList & value ) const
+      {
+         return tPCSCFServerAddressList::Read( mTLVs[15], 0, value );
+      };
+
+      // (Inline) Return PCSCF Domain Name List
+      bool GetPCSCFDomainNameList( tPCSCFDomainNameList & value ) const
+      {
+         return tPCSCFDomainNameList::Read( mTLVs[16], 0, value );
+      };
+
+      // (Inline) Return IPv6 Address
+      bool GetIPv6Address( sIPv6Address & value ) const
+      {
+         return sIPv6Address::Read( mTLVs[17], 0, value );
+      };
+
+      // (Inline) Return IPv6 Gateway Address
+      bool GetIPv6GatewayAddress( sIPv6GatewayAddress & value ) const
+      {
+         return sIPv6GatewayAddress::Read( mTLVs[18], 0, value );
+      };
+
+      // (Inline) Return IPv6 Primary DNS Address
+      bool GetIPv6PrimaryDNSAddress( tIPv6PrimaryDNSAddress & value ) const
+      {
+         return tIPv6PrimaryDNSAddress::Read( mTLVs[19], 0, value );
+      };
+
+      // (Inline) Return IPv6 Secondary DNS Address
+      bool GetIPv6SecondaryDNSAddress( tIPv6SecondaryDNSAddress & value ) const
+      {
+         return tIPv6SecondaryDNSAddress::Read( mTLVs[20], 0, value );
+      };
+
+      // (Inline) Return MTU
+      bool GetMTU( ULONG & value ) const
+      {
+         return sQMIInt <ULONG, 4>::Read( mTLVs[21], 0, value );
+      };
+
+      // (Inline) Return Domain Name List
+      bool GetDomainNameList( tDomainNameList & value ) const
+      {
+         return tDomainNameList::Read( mTLVs[22], 0, value );
+      };
+
+      // (Inline) Return IP Family
+      bool GetIPFamily( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[23], 0, value );
+      };
+
+      // (Inline) Return IMCN Flag
+      bool GetIMCNFlag( INT8 & value ) const
+      {
+         return sQMIInt <INT8, 1>::Read( mTLVs[24], 0, value );
+      };
+
+      // (Inline) Return Extended Technology Preference
+      bool GetExtendedTechnologyPreference( WORD & value ) const
+      {
+         return sQMIInt <WORD, 2>::Read( mTLVs[25], 0, value );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIWriterWDSGetDormancyStatusReq
+//    Writer of the WDS Get Dormancy Status request
+/*=========================================================================*/
+class cQMIWriterWDSGetDormancyStatusReq : public cQMIMessageWriter
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0030 };
+
+      // (Inline) Constructor
+      cQMIWriterWDSGetDormancyStatusReq(
+         BYTE *                     pBuffer,
+         ULONG                      sz )
+         :  cQMIMessageWriter( pBuffer, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Build the QMI request from the encoded TLVs
+      sSharedBuffer * BuildRequest() const
+      {
+         return cQMIMessageWriter::BuildRequest( eQMI_SVC_WDS,
+                                                (WORD)MESSAGE_ID );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIViewWDSGetDormancyStatusRsp
+//    View of the WDS Get Dormancy Status response
+/*=========================================================================*/
+class cQMIViewWDSGetDormancyStatusRsp : public cQMIMessageView <cQMIViewWDSGetDormancyStatusRsp, 2>
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0030 };
+
+      // TLV type IDs
+      enum
+      {
+         TLV_RESULT = 0x02,
+         TLV_DORMANCY_STATUS = 0x01
+      };
+
+      /*=================================================================*/
+      // Struct sResult (Result)
+      /*=================================================================*/
+      struct sResult
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 4 };
+            enum
+            {
+               OFFSET_ERROR_STATUS = 0,
+               OFFSET_ERROR_CODE = 2
+            };
+
+            // Type of value read
+            typedef sResult tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sResult()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sResult( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Error Status
+            bool GetErrorStatus( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_STATUS,
+                                               value );
+            };
+
+            // (Inline) Return Error Code
+            bool GetErrorCode( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_CODE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // (Inline) Constructor (from the TLVs of the message)
+      cQMIViewWDSGetDormancyStatusRsp(
+         const BYTE *               pTLVs,
+         ULONG                      sz )
+         :  cQMIMessageView <cQMIViewWDSGetDormancyStatusRsp, 2>( pTLVs, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Constructor (from a QMI service response)
+      cQMIViewWDSGetDormancyStatusRsp( const sProtocolBuffer & buf )
+         :  cQMIMessageView <cQMIViewWDSGetDormancyStatusRsp, 2>( buf )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Map a TLV type ID to its slot (-1 if unknown)
+      static int GetSlot( BYTE typeID )
+      {
+         switch (typeID)
+         {
+            case TLV_RESULT:
+               return 0;
+            case TLV_DORMANCY_STATUS:
+               return 1;
+         }
+
+         return -1;
+      };
+
+      // (Inline) Return Result
+      bool GetResult( sResult & value ) const
+      {
+         return sResult::Read( mTLVs[0], 0, value );
+      };
+
+      // (Inline) Return contents of mandatory result content
+      bool GetResult(
+         ULONG &                    returnCode,
+         ULONG &                    errorCode ) const
+      {
+         sResult result;
+         WORD rc = 0;
+         WORD ec = 0;
+         if ( (GetResult( result ) == false)
+         ||   (result.GetErrorStatus( rc ) == false)
+         ||   (result.GetErrorCode( ec ) == false) )
+         {
+            return false;
+         }
+
+         returnCode = (ULONG)rc;
+         errorCode = (ULONG)ec;
+         return true;
+      };
+
+      // (Inline) Return Dormancy Status
+      bool GetDormancyStatus( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[1], 0, value );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIWriterWDSGetAutoconnectSettingsReq
+//    Writer of the WDS Get Autoconnect Settings request
+/*=========================================================================*/
+class cQMIWriterWDSGetAutoconnectSettingsReq : public cQMIMessageWriter
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0034 };
+
+      // (Inline) Constructor
+      cQMIWriterWDSGetAutoconnectSettingsReq(
+         BYTE *                     pBuffer,
+         ULONG                      sz )
+         :  cQMIMessageWriter( pBuffer, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Build the QMI request from the encoded TLVs
+      sSharedBuffer * BuildRequest() const
+      {
+         return cQMIMessageWriter::BuildRequest( eQMI_SVC_WDS,
+                                                (WORD)MESSAGE_ID );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIViewWDSGetAutoconnectSettingsRsp
+//    View of the WDS Get Autoconnect Settings response
+/*=========================================================================*/
+class cQMIViewWDSGetAutoconnectSettingsRsp : public cQMIMessageView <cQMIViewWDSGetAutoconnectSettingsRsp, 3>
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0034 };
+
+      // TLV type IDs
+      enum
+      {
+         TLV_RESULT = 0x02,
+         TLV_STATUS = 0x01,
+         TLV_ROAMING = 0x10
+      };
+
+      /*=================================================================*/
+      // Struct sResult (Result)
+      /*=================================================================*/
+      struct sResult
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 4 };
+            enum
+            {
+               OFFSET_ERROR_STATUS = 0,
+               OFFSET_ERROR_CODE = 2
+            };
+
+            // Type of value read
+            typedef sResult tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sResult()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sResult( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Error Status
+            bool GetErrorStatus( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_STATUS,
+                                               value );
+            };
+
+            // (Inline) Return Error Code
+            bool GetErrorCode( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_CODE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // (Inline) Constructor (from the TLVs of the message)
+      cQMIViewWDSGetAutoconnectSettingsRsp(
+         const BYTE *               pTLVs,
+         ULONG                      sz )
+         :  cQMIMessageView <cQMIViewWDSGetAutoconnectSettingsRsp, 3>( pTLVs, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Constructor (from a QMI service response)
+      cQMIViewWDSGetAutoconnectSettingsRsp( const sProtocolBuffer & buf )
+         :  cQMIMessageView <cQMIViewWDSGetAutoconnectSettingsRsp, 3>( buf )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Map a TLV type ID to its slot (-1 if unknown)
+      static int GetSlot( BYTE typeID )
+      {
+         switch (typeID)
+         {
+            case TLV_RESULT:
+               return 0;
+            case TLV_STATUS:
+               return 1;
+            case TLV_ROAMING:
+               return 2;
+         }
+
+         return -1;
+      };
+
+      // (Inline) Return Result
+      bool GetResult( sResult & value ) const
+      {
+         return sResult::Read( mTLVs[0], 0, value );
+      };
+
+      // (Inline) Return contents of mandatory result content
+      bool GetResult(
+         ULONG &                    returnCode,
+         ULONG &                    errorCode ) const
+      {
+         sResult result;
+         WORD rc = 0;
+         WORD ec = 0;
+         if ( (GetResult( result ) == false)
+         ||   (result.GetErrorStatus( rc ) == false)
+         ||   (result.GetErrorCode( ec ) == false) )
+         {
+            return false;
+         }
+
+         returnCode = (ULONG)rc;
+         errorCode = (ULONG)ec;
+         return true;
+      };
+
+      // (Inline) Return Status
+      bool GetStatus( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[1], 0, value );
+      };
+
+      // (Inline) Return Roaming
+      bool GetRoaming( BYTE & value ) const
+      {
+         return sQMIInt <BYTE, 1>::Read( mTLVs[2], 0, value );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIWriterWDSGetDataBearerTechnologyReq
+//    Writer of the WDS Get Data Bearer Technology request
+/*=========================================================================*/
+class cQMIWriterWDSGetDataBearerTechnologyReq : public cQMIMessageWriter
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0037 };
+
+      // (Inline) Constructor
+      cQMIWriterWDSGetDataBearerTechnologyReq(
+         BYTE *                     pBuffer,
+         ULONG                      sz )
+         :  cQMIMessageWriter( pBuffer, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Build the QMI request from the encoded TLVs
+      sSharedBuffer * BuildRequest() const
+      {
+         return cQMIMessageWriter::BuildRequest( eQMI_SVC_WDS,
+                                                (WORD)MESSAGE_ID );
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIViewWDSGetDataBearerTechnologyRsp
+//    View of the WDS Get Data Bearer Technology response
+/*=========================================================================*/
+class cQMIViewWDSGetDataBearerTechnologyRsp : public cQMIMessageView <cQMIViewWDSGetDataBearerTechnologyRsp, 3>
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0037 };
+
+      // TLV type IDs
+      enum
+      {
+         TLV_RESULT = 0x02,
+         TLV_CURRENT = 0x01,
+         TLV_LAST = 0x10
+      };
+
+      /*=================================================================*/
+      // Struct sResult (Result)
+      /*=================================================================*/
+      struct sResult
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 4 };
+            enum
+            {
+               OFFSET_ERROR_STATUS = 0,
+               OFFSET_ERROR_CODE = 2
+            };
+
+            // Type of value read
+            typedef sResult tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sResult()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sResult( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Error Status
+            bool GetErrorStatus( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_STATUS,
+                                               value );
+            };
+
+            // (Inline) Return Error Code
+            bool GetErrorCode( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_CODE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // (Inline) Constructor (from the TLVs of the message)
+      cQMIViewWDSGetDataBearerTechnologyRsp(
+         const BYTE *               pTLVs,
+         ULONG                      sz )
+         :  cQMIMessageView <cQMIViewWDSGetDataBearerTechnologyRsp, 3>( pTLVs, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Constructor (from a QMI service response)
+      cQMIViewWDSGetDataBearerTechnologyRsp( const sProtocolBuffer & buf )
+         :  cQMIMessageView <cQMIViewWDSGetDataBearerTechnologyRsp, 3>( buf )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Map a TLV type ID to its slot (-1 if unknown)
+      static int GetSlot( BYTE typeID )
+      {
+         switch (typeID)
+         {
+            case TLV_RESULT:
+               return 0;
+            case TLV_CURRENT:
+               return 1;
+            case TLV_LAST:
+               return 2;
+         }
+
+         return -1;
+      };
+
+      // (Inline) Return Result
+      bool GetResult( sResult & value ) const
+      {
+         return sResult::Read( mTLVs[0], 0, value );
+      };
+
+      // (Inline) Return contents of mandatory result content
+      bool GetResult(
+         ULONG &                    returnCode,
+         ULONG &                    errorCode ) const
+      {
+         sResult result;
+         WORD rc = 0;
+         WORD ec = 0;
+         if ( (GetResult( result ) == false)
+         ||   (result.GetErrorStatus( rc ) == false)
+         ||   (result.GetErrorCode( ec ) == false) )
+         {
+            return false;
+         }
+
+         returnCode = (ULONG)rc;
+         errorCode = (ULONG)ec;
+         return true;
+      };
+
+      // (Inline) Return Current
+      bool GetCurrent( INT8 & value ) const
+      {
+         return sQMIInt <INT8, 1>::Read( mTLVs[1], 0, value );
+      };
+
+      // (Inline) Return Last
+      bool GetLast( INT8 & value ) const
+      {
+         return sQMIInt <INT8, 1>::Read( mTLVs[2], 0, value );
+      };
+};
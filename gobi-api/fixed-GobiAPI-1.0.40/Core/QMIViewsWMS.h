@@ -0,0 +1,378 @@
+/*===========================================================================
+FILE:
+   QMIViewsWMS.h
+
+DESCRIPTION:
+   Static views of the (collected) QMI WMS messages
+
+PUBLIC CLASSES AND METHODS:
+   cQMIWriterWMSRawReadReq
+   cQMIViewWMSRawReadRsp
+
+   NOTE:
+      Generated by build-aux/qmi-codegen from qmi-service-wms.json, do not
+      edit.  To regenerate run (from the top of the source tree):
+
+         build-aux/qmi-codegen/qmi-codegen --cxx-views \
+            --input data/qmi-service-wms.json \
+            --include data/qmi-common.json \
+            --collection data/qmi-collection-gobi-views.json \
+            --output <Core directory>/QMIViewsWMS
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Pragmas
+//---------------------------------------------------------------------------
+#pragma once
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "QMIView.h"
+
+/*=========================================================================*/
+// Class cQMIWriterWMSRawReadReq
+//    Writer of the WMS Raw Read request
+/*=========================================================================*/
+class cQMIWriterWMSRawReadReq : public cQMIMessageWriter
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0022 };
+
+      // TLV type IDs
+      enum
+      {
+         TLV_MESSAGE_MEMORY_STORAGE_ID = 0x01,
+         TLV_MESSAGE_MODE = 0x10,
+         TLV_SMS_ON_IMS = 0x11
+      };
+
+      // (Inline) Constructor
+      cQMIWriterWMSRawReadReq(
+         BYTE *                     pBuffer,
+         ULONG                      sz )
+         :  cQMIMessageWriter( pBuffer, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Build the QMI request from the encoded TLVs
+      sSharedBuffer * BuildRequest() const
+      {
+         return cQMIMessageWriter::BuildRequest( eQMI_SVC_WMS,
+                                                (WORD)MESSAGE_ID );
+      };
+
+      // (Inline) Set Message Memory Storage ID
+      bool SetMessageMemoryStorageID(
+         BYTE                       storageType,
+         ULONG                      memoryIndex )
+      {
+         BYTE * pValue = AddTLV( (BYTE)TLV_MESSAGE_MEMORY_STORAGE_ID, 5 );
+         if (pValue == 0)
+         {
+            return false;
+         }
+
+         sQMIInt <BYTE, 1>::Write( pValue + 0, storageType );
+         sQMIInt <ULONG, 4>::Write( pValue + 1, memoryIndex );
+         return true;
+      };
+
+      // (Inline) Set Message Mode
+      bool SetMessageMode( BYTE value )
+      {
+         BYTE * pValue = AddTLV( (BYTE)TLV_MESSAGE_MODE, 1 );
+         if (pValue == 0)
+         {
+            return false;
+         }
+
+         sQMIInt <BYTE, 1>::Write( pValue, value );
+         return true;
+      };
+
+      // (Inline) Set SMS on IMS
+      bool SetSMSOnIMS( BYTE value )
+      {
+         BYTE * pValue = AddTLV( (BYTE)TLV_SMS_ON_IMS, 1 );
+         if (pValue == 0)
+         {
+            return false;
+         }
+
+         sQMIInt <BYTE, 1>::Write( pValue, value );
+         return true;
+      };
+};
+
+/*=========================================================================*/
+// Class cQMIViewWMSRawReadRsp
+//    View of the WMS Raw Read response
+/*=========================================================================*/
+class cQMIViewWMSRawReadRsp : public cQMIMessageView <cQMIViewWMSRawReadRsp, 2>
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0022 };
+
+      // TLV type IDs
+      enum
+      {
+         TLV_RESULT = 0x02,
+         TLV_RAW_MESSAGE_DATA = 0x01
+      };
+
+      /*=================================================================*/
+      // Struct sResult (Result)
+      /*=================================================================*/
+      struct sResult
+      {
+         public:
+            // Compile time size/offsets of the fields
+            enum { FIXED_SIZE = 4 };
+            enum
+            {
+               OFFSET_ERROR_STATUS = 0,
+               OFFSET_ERROR_CODE = 2
+            };
+
+            // Type of value read
+            typedef sResult tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sResult()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sResult( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = (ULONG)FIXED_SIZE;
+               return in.Has( offset, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Error Status
+            bool GetErrorStatus( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_STATUS,
+                                               value );
+            };
+
+            // (Inline) Return Error Code
+            bool GetErrorCode( WORD & value ) const
+            {
+               return sQMIInt <WORD, 2>::Read( mView,
+                                               OFFSET_ERROR_CODE,
+                                               value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // Array view of Raw Message Data Raw Data
+      typedef cQMIArrayView <sQMIInt <BYTE, 1>, 2> tRawMessageDataRawData;
+
+      /*=================================================================*/
+      // Struct sRawMessageData (Raw Message Data)
+      /*=================================================================*/
+      struct sRawMessageData
+      {
+         public:
+            // Compile time size (variable)/offsets of the fields
+            enum { FIXED_SIZE = 0 };
+            enum
+            {
+               OFFSET_MESSAGE_TAG = 0,
+               OFFSET_FORMAT = 1,
+               OFFSET_RAW_DATA = 2
+            };
+
+            // Type of value read
+            typedef sRawMessageData tValue;
+
+            // (Inline) Default constructor (results in invalid object)
+            sRawMessageData()
+               :  mView()
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Parameter constructor
+            sRawMessageData( const sQMIView & view )
+               :  mView( view )
+            {
+               // Nothing to do
+            };
+
+            // (Inline) Is this object valid?
+            bool IsValid() const
+            {
+               return mView.IsValid();
+            };
+
+            // (Inline) Measure the structure at the given offset
+            static bool Measure(
+               const sQMIView &           in,
+               ULONG                      offset,
+               ULONG &                    sz )
+            {
+               sz = 0;
+
+               ULONG start = offset;
+               ULONG fieldSz = 0;
+               offset += 2;
+               if (tRawMessageDataRawData::Measure( in, offset, fieldSz ) == false)
+               {
+                  return false;
+               }
+
+               offset += fieldSz;
+
+               sz = offset - start;
+               return in.Has( start, sz );
+            };
+
+            // (Inline) Read the structure at the given offset
+            static bool Read(
+               const sQMIView &           in,
+               ULONG                      offset,
+               tValue &                   value )
+            {
+               ULONG sz = 0;
+               if (Measure( in, offset, sz ) == false)
+               {
+                  return false;
+               }
+
+               value = tValue( in.Sub( offset, sz ) );
+               return true;
+            };
+
+            // (Inline) Return Message Tag
+            bool GetMessageTag( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView,
+                                               OFFSET_MESSAGE_TAG,
+                                               value );
+            };
+
+            // (Inline) Return Format
+            bool GetFormat( BYTE & value ) const
+            {
+               return sQMIInt <BYTE, 1>::Read( mView, OFFSET_FORMAT, value );
+            };
+
+            // (Inline) Return Raw Data
+            bool GetRawData( tRawMessageDataRawData & value ) const
+            {
+               return tRawMessageDataRawData::Read( mView,
+                                                    OFFSET_RAW_DATA,
+                                                    value );
+            };
+
+         protected:
+            /* Viewed structure */
+            sQMIView mView;
+      };
+
+      // (Inline) Constructor (from the TLVs of the message)
+      cQMIViewWMSRawReadRsp(
+         const BYTE *               pTLVs,
+         ULONG                      sz )
+         :  cQMIMessageView <cQMIViewWMSRawReadRsp, 2>( pTLVs, sz )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Constructor (from a QMI service response)
+      cQMIViewWMSRawReadRsp( const sProtocolBuffer & buf )
+         :  cQMIMessageView <cQMIViewWMSRawReadRsp, 2>( buf )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Map a TLV type ID to its slot (-1 if unknown)
+      static int GetSlot( BYTE typeID )
+      {
+         switch (typeID)
+         {
+            case TLV_RESULT:
+               return 0;
+            case TLV_RAW_MESSAGE_DATA:
+               return 1;
+         }
+
+         return -1;
+      };
+
+      // (Inline) Return Result
+      bool GetResult( sResult & value ) const
+      {
+         return sResult::Read( mTLVs[0], 0, value );
+      };
+
+      // (Inline) Return contents of mandatory result content
+      bool GetResult(
+         ULONG &                    returnCode,
+         ULONG &                    errorCode ) const
+      {
+         sResult result;
+         WORD rc = 0;
+         WORD ec = 0;
+         if ( (GetResult( result ) == false)
+         ||   (result.GetErrorStatus( rc ) == false)
+         ||   (result.GetErrorCode( ec ) == false) )
+         {
+            return false;
+         }
+
+         returnCode = (ULONG)rc;
+         errorCode = (ULONG)ec;
+         return true;
+      };
+
+      // (Inline) Return Raw Message Data
+      bool GetRawMessageData( sRawMessageData & value ) const
+      {
+         return sRawMessageData::Read( mTLVs[1], 0, value );
+      };
+};
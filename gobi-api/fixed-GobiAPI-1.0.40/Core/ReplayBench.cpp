@@ -0,0 +1,512 @@
+/*===========================================================================
+FILE:
+   ReplayBench.cpp
+
+DESCRIPTION:
+   Hardware free throughput benchmark of the QMI protocol server, driven 
+   through cCommReplay
+
+PUBLIC CLASSES AND METHODS:
+   main
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "StdAfx.h"
+#include "CommReplay.h"
+#include "ProfiledMutex.h"
+#include "ProtocolNotification.h"
+#include "QMIBuffers.h"
+#include "QMIProtocolServer.h"
+
+#include <algorithm>
+#include <sys/resource.h>
+
+//---------------------------------------------------------------------------
+// Definitions
+//---------------------------------------------------------------------------
+
+// Default number of requests per server
+const ULONG BENCH_DEFAULT_REQUESTS = 10000;
+
+// Default message ID requested
+const WORD BENCH_DEFAULT_MSG_ID = 0x0020;
+
+// Events per request (request sent, response received/error)
+const ULONG BENCH_REQUEST_EVENTS = 2;
+
+// Time allowed to any one event (milliseconds)
+const ULONG BENCH_EVENT_TIMEOUT = 5000;
+
+// One (device, service) protocol server being benchmarked
+struct sBenchServer
+{
+   /* QMI service */
+   eQMIService mService;
+
+   /* (Fake) port name */
+   std::string mPort;
+
+   /* Protocol server and its transport */
+   cQMIProtocolServer * mpServer;
+   cCommReplay * mpReplay;
+
+   /* Request/response latencies (microseconds) */
+   std::vector <ULONGLONG> mLatencies;
+
+   /* Requests failed */
+   ULONG mFailures;
+
+   /* Benchmark thread */
+   pthread_t mThreadID;
+};
+
+// Benchmark settings (shared by all servers)
+struct sBenchSettings
+{
+   ULONG mRequests;
+   ULONG mWindow;
+   WORD mMsgID;
+};
+
+static sBenchSettings gSettings;
+
+/*=========================================================================*/
+// Free Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   GetMicroseconds (Free Method)
+
+DESCRIPTION:
+   Return the monotonic time in microseconds
+
+RETURN VALUE:
+   ULONGLONG
+===========================================================================*/
+ULONGLONG GetMicroseconds()
+{
+   timespec ts;
+   clock_gettime( CLOCK_MONOTONIC, &ts );
+   return (ULONGLONG)ts.tv_sec * 1000000 + (ULONGLONG)(ts.tv_nsec / 1000);
+}
+
+/*===========================================================================
+METHOD:
+   GetCPUMicroseconds (Free Method)
+
+DESCRIPTION:
+   Return the (user + system) CPU time used by the process in microseconds
+
+RETURN VALUE:
+   ULONGLONG
+===========================================================================*/
+ULONGLONG GetCPUMicroseconds()
+{
+   rusage ru;
+   getrusage( RUSAGE_SELF, &ru );
+
+   ULONGLONG us = (ULONGLONG)ru.ru_utime.tv_sec * 1000000 
+                + (ULONGLONG)ru.ru_utime.tv_usec
+                + (ULONGLONG)ru.ru_stime.tv_sec * 1000000 
+                + (ULONGLONG)ru.ru_stime.tv_usec;
+
+   return us;
+}
+
+/*===========================================================================
+METHOD:
+   BenchThread (Free Method)
+
+DESCRIPTION:
+   Keep the in-flight window of one server full until all requests have 
+   completed, recording the latency of each
+
+PARAMETERS:
+   pArg        [ I ] - The server (sBenchServer)
+
+RETURN VALUE:
+   void * - thread exit value (always NULL)
+===========================================================================*/
+void * BenchThread( PVOID pArg )
+{
+   sBenchServer * pBench = (sBenchServer *)pArg;
+   cQMIProtocolServer & server = *pBench->mpServer;
+
+   ULONG window = gSettings.mWindow;
+   tProtocolNotificationQueue evts( (window + 1) * BENCH_REQUEST_EVENTS, 
+                                    true );
+
+   cProtocolQueueNotification pn( &evts );
+   cEvent & sigEvt = evts.GetSignalEvent();
+
+   // Outstanding requests (request ID mapped to submission time)
+   std::map <ULONG, ULONGLONG> outstanding;
+
+   ULONG submitted = 0;
+   ULONG completed = 0;
+   while (completed < gSettings.mRequests)
+   {
+      while ( ((ULONG)outstanding.size() < window)
+      &&      (submitted < gSettings.mRequests) )
+      {
+         sSharedBuffer * pReq = 0;
+         pReq = sQMIServiceBuffer::BuildBuffer( pBench->mService, 
+                                                gSettings.mMsgID );
+
+         sProtocolRequest req( pReq, 0, BENCH_EVENT_TIMEOUT, 1, 1, &pn );
+         ULONGLONG now = GetMicroseconds();
+         ULONG reqID = server.AddRequest( req );
+         if (reqID == INVALID_REQUEST_ID)
+         {
+            // Give up on this one
+            pBench->mFailures++;
+            completed++;
+         }
+         else
+         {
+            outstanding[reqID] = now;
+         }
+
+         submitted++;
+      }
+
+      if (outstanding.size() == 0)
+      {
+         continue;
+      }
+
+      DWORD idx;
+      int wc = sigEvt.Wait( BENCH_EVENT_TIMEOUT, idx );
+      if (wc != 0)
+      {
+         fprintf( stderr, 
+                  "%s: no progress, %lu requests abandoned\n",
+                  pBench->mPort.c_str(),
+                  (unsigned long)outstanding.size() );
+
+         pBench->mFailures += (ULONG)outstanding.size();
+         break;
+      }
+
+      sProtocolNotificationEvent evt;
+      if (evts.GetElement( idx, evt ) == false)
+      {
+         continue;
+      }
+
+      std::map <ULONG, ULONGLONG>::iterator pIter;
+      pIter = outstanding.find( (ULONG)evt.mParam1 );
+      if (pIter == outstanding.end())
+      {
+         continue;
+      }
+
+      switch (evt.mEventType)
+      {
+         case ePROTOCOL_EVT_RSP_RECV:
+            pBench->mLatencies.push_back( GetMicroseconds() - pIter->second );
+            break;
+
+         case ePROTOCOL_EVT_REQ_ERR:
+         case ePROTOCOL_EVT_RSP_ERR:
+            pBench->mFailures++;
+            break;
+
+         default:
+            // Still in flight
+            continue;
+      }
+
+      outstanding.erase( pIter );
+      completed++;
+   }
+
+   return NULL;
+}
+
+/*===========================================================================
+METHOD:
+   ParseServices (Free Method)
+
+DESCRIPTION:
+   Parse a comma separated list of QMI service numbers
+
+PARAMETERS:
+   pList       [ I ] - The list
+   services    [ O ] - Services parsed
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool ParseServices(
+   LPCSTR                     pList,
+   std::vector <eQMIService> & services )
+{
+   services.clear();
+
+   while (pList != 0 && *pList != 0)
+   {
+      char * pEnd = 0;
+      unsigned long val = strtoul( pList, &pEnd, 0 );
+      if (pEnd == pList)
+      {
+         return false;
+      }
+
+      eQMIService svc = (eQMIService)val;
+      if (IsValid( svc ) == false || svc == eQMI_SVC_CONTROL)
+      {
+         return false;
+      }
+
+      services.push_back( svc );
+
+      pList = pEnd;
+      if (*pList == ',')
+      {
+         pList++;
+      }
+   }
+
+   return (services.size() > 0);
+}
+
+/*===========================================================================
+METHOD:
+   main
+
+DESCRIPTION:
+   Connect one QMI protocol server per (device, service) to a replay 
+   transport, push requests through all of them concurrently and report 
+   the throughput, latency and CPU cost observed
+
+   Usage: ReplayBench [-d devices] [-s services] [-n requests] 
+                      [-w window] [-m message ID] [-r response delay]
+                      [-x indication speed] [-l locks to report] 
+                      [capture file ...]
+
+RETURN VALUE:
+   int - 0 upon success
+===========================================================================*/
+int main( int argc, char ** argv )
+{
+   ULONG devices = 1;
+   ULONG responseDelay = 0;
+   double speed = 1.0;
+   ULONG lockReports = 0;
+   std::vector <eQMIService> services( 1, eQMI_SVC_DMS );
+
+   gSettings.mRequests = BENCH_DEFAULT_REQUESTS;
+   gSettings.mWindow = 1;
+   gSettings.mMsgID = BENCH_DEFAULT_MSG_ID;
+
+   int opt;
+   while ((opt = getopt( argc, argv, "d:s:n:w:m:r:x:l:" )) != -1)
+   {
+      switch (opt)
+      {
+         case 'd':
+            devices = strtoul( optarg, 0, 0 );
+            break;
+
+         case 's':
+            if (ParseServices( optarg, services ) == false)
+            {
+               fprintf( stderr, "%s: bad service list \'%s\'\n", 
+                        argv[0], 
+                        optarg );
+               return 1;
+            }
+            break;
+
+         case 'n':
+            gSettings.mRequests = strtoul( optarg, 0, 0 );
+            break;
+
+         case 'w':
+            gSettings.mWindow = strtoul( optarg, 0, 0 );
+            break;
+
+         case 'm':
+            gSettings.mMsgID = (WORD)strtoul( optarg, 0, 0 );
+            break;
+
+         case 'r':
+            responseDelay = strtoul( optarg, 0, 0 );
+            break;
+
+         case 'x':
+            speed = strtod( optarg, 0 );
+            break;
+
+         case 'l':
+            lockReports = strtoul( optarg, 0, 0 );
+            break;
+
+         default:
+            fprintf( stderr, 
+                     "Usage: %s [-d devices] [-s services] [-n requests] "
+                     "[-w window] [-m message ID] [-r response delay] "
+                     "[-x indication speed] [-l locks to report] "
+                     "[capture file ...]\n",
+                     argv[0] );
+            return 1;
+      }
+   }
+
+   if (devices == 0 || gSettings.mRequests == 0 || gSettings.mWindow == 0)
+   {
+      fprintf( stderr, "%s: devices, requests and window must be > 0\n",
+               argv[0] );
+      return 1;
+   }
+
+   cCommReplayCapture capture;
+   for (int a = optind; a < argc; a++)
+   {
+      if (capture.Load( argv[a] ) == false)
+      {
+         fprintf( stderr, "%s: capture \'%s\' failed to load\n", 
+                  argv[0], 
+                  argv[a] );
+         return 1;
+      }
+   }
+
+   // Connect all servers
+   std::vector <sBenchServer> benches( devices * services.size() );
+   for (ULONG b = 0; b < (ULONG)benches.size(); b++)
+   {
+      sBenchServer & bench = benches[b];
+      bench.mService = services[b % services.size()];
+      bench.mFailures = 0;
+      bench.mThreadID = 0;
+
+      char port[32];
+      snprintf( port, sizeof( port ), "replay%lu", 
+                (unsigned long)(b / services.size()) );
+      bench.mPort = port;
+
+      bench.mpReplay = new cCommReplay( &capture, speed );
+      bench.mpReplay->SetResponseDelay( responseDelay );
+
+      bench.mpServer = new cQMIProtocolServer( bench.mService, 8192, 512 );
+      bench.mpServer->SetCommTransport( bench.mpReplay );
+      bench.mpServer->Initialize();
+
+      if ( (bench.mpServer->Connect( port ) == false)
+      ||   (bench.mpServer->SetInFlightWindow( gSettings.mWindow ) == false) )
+      {
+         fprintf( stderr, "%s: unable to connect service %d on %s\n", 
+                  argv[0], 
+                  (int)bench.mService,
+                  port );
+         return 1;
+      }
+   }
+
+   if (lockReports > 0)
+   {
+      cProfiledMutex::SetProfiling( true );
+   }
+
+   ULONGLONG startCPU = GetCPUMicroseconds();
+   ULONGLONG start = GetMicroseconds();
+
+   for (ULONG b = 0; b < (ULONG)benches.size(); b++)
+   {
+      pthread_create( &benches[b].mThreadID, NULL, BenchThread, &benches[b] );
+   }
+
+   std::vector <ULONGLONG> latencies;
+   ULONG failures = 0;
+   for (ULONG b = 0; b < (ULONG)benches.size(); b++)
+   {
+      sBenchServer & bench = benches[b];
+      pthread_join( bench.mThreadID, NULL );
+
+      latencies.insert( latencies.end(), 
+                        bench.mLatencies.begin(), 
+                        bench.mLatencies.end() );
+
+      failures += bench.mFailures;
+   }
+
+   ULONGLONG elapsed = GetMicroseconds() - start;
+   ULONGLONG cpu = GetCPUMicroseconds() - startCPU;
+
+   for (ULONG b = 0; b < (ULONG)benches.size(); b++)
+   {
+      benches[b].mpServer->Disconnect();
+      benches[b].mpServer->Exit();
+      delete benches[b].mpServer;
+      delete benches[b].mpReplay;
+   }
+
+   ULONG done = (ULONG)latencies.size();
+   printf( "servers      %lu (%lu devices x %lu services), window %lu\n",
+           (unsigned long)benches.size(),
+           (unsigned long)devices,
+           (unsigned long)services.size(),
+           (unsigned long)gSettings.mWindow );
+
+   printf( "requests     %lu completed, %lu failed in %.3f s\n",
+           (unsigned long)done,
+           (unsigned long)failures,
+           (double)elapsed / 1000000.0 );
+
+   if (done == 0)
+   {
+      return 1;
+   }
+
+   std::sort( latencies.begin(), latencies.end() );
+   printf( "throughput   %.1f requests/s\n",
+           (double)done * 1000000.0 / (double)(elapsed > 0 ? elapsed : 1) );
+
+   printf( "latency      p50 %llu us, p99 %llu us, max %llu us\n",
+           latencies[done / 2],
+           latencies[((ULONGLONG)done * 99) / 100],
+           latencies[done - 1] );
+
+   printf( "cpu          %.1f us/request\n", (double)cpu / (double)done );
+
+   // Worst lock offenders
+   std::vector <sLockStats> locks = cProfiledMutex::GetLockStats( lockReports );
+   for (ULONG l = 0; lockReports > 0 && l < (ULONG)locks.size(); l++)
+   {
+      printf( "%s\n", cProfiledMutex::Format( locks[l] ).c_str() );
+   }
+
+   return (failures == 0 ? 0 : 1);
+}
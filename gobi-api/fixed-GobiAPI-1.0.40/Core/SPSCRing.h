@@ -0,0 +1,211 @@
+/*===========================================================================
+FILE:
+   SPSCRing.h
+
+DESCRIPTION:
+   Declaration/Implementation of cSPSCRing class
+   
+PUBLIC CLASSES AND METHODS:
+   cSPSCRing
+      Bounded lock-free ring of preallocated elements passed from a 
+      single producer thread to a single consumer thread
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Pragmas
+//---------------------------------------------------------------------------
+#pragma once
+
+//---------------------------------------------------------------------------
+// Definitions
+//---------------------------------------------------------------------------
+
+// Size the producer and consumer positions are padded to (a cache line)
+const ULONG SPSC_RING_PAD_SZ = 64;
+
+/*=========================================================================*/
+// Class cSPSCRing
+//
+//    Bounded single-producer/single-consumer ring.  Elements are allocated
+//    once, the producer fills the next free element in place (BeginPush()
+//    then CommitPush()) and the consumer copies elements out in order
+//    (Pop()).  Neither side ever blocks: when the ring is full the new 
+//    element is dropped (and counted) rather than overwriting one the 
+//    consumer may be reading.  The producer and consumer positions are
+//    kept on separate cache lines
+//
+//    NOTE: Only one thread may produce and only one thread may consume
+/*=========================================================================*/
+template <class tElementType> 
+class cSPSCRing
+{
+   public:
+      // (Inline) Constructor (the capacity is rounded up to a power of 2)
+      cSPSCRing( ULONG maxElements )
+         :  mCapacity( 1 ),
+            mpElements( 0 ),
+            mHead( 0 ),
+            mTail( 0 ),
+            mDropped( 0 )
+      {
+         while (mCapacity < maxElements && mCapacity < 0x80000000UL)
+         {
+            mCapacity <<= 1;
+         }
+
+         mpElements = new tElementType[mCapacity];
+      };
+
+      // (Inline) Destructor
+      ~cSPSCRing()
+      {
+         delete [] mpElements;
+         mpElements = 0;
+      };
+
+      // (Inline) Is this object valid?
+      bool IsValid() const
+      {
+         return (mpElements != 0);
+      };
+
+      // (Inline) Producer: return the next free element to fill in place
+      // (0 when the ring is full, the element is then counted as dropped)
+      tElementType * BeginPush()
+      {
+         if (IsValid() == false)
+         {
+            return 0;
+         }
+
+         ULONG tail = mTail;
+         ULONG head = mHead;
+         __sync_synchronize();
+
+         if (tail - head >= mCapacity)
+         {
+            __sync_fetch_and_add( &mDropped, 1 );
+            return 0;
+         }
+
+         return &mpElements[tail & (mCapacity - 1)];
+      };
+
+      // (Inline) Producer: publish the element returned by BeginPush()
+      void CommitPush()
+      {
+         // Element contents before the position
+         __sync_synchronize();
+         mTail = mTail + 1;
+      };
+
+      // (Inline) Producer: copy an element in
+      bool Push( const tElementType & elem )
+      {
+         tElementType * pElem = BeginPush();
+         if (pElem == 0)
+         {
+            return false;
+         }
+
+         *pElem = elem;
+         CommitPush();
+         return true;
+      };
+
+      // (Inline) Consumer: copy the oldest element out (false if empty)
+      bool Pop( tElementType & elem )
+      {
+         if (IsValid() == false)
+         {
+            return false;
+         }
+
+         ULONG head = mHead;
+         ULONG tail = mTail;
+         __sync_synchronize();
+
+         if (head == tail)
+         {
+            return false;
+         }
+
+         elem = mpElements[head & (mCapacity - 1)];
+
+         // Element copied out before the slot is handed back
+         __sync_synchronize();
+         mHead = head + 1;
+         return true;
+      };
+
+      // (Inline) Return the number of queued elements
+      ULONG GetCount() const
+      {
+         ULONG tail = mTail;
+         ULONG head = mHead;
+         return tail - head;
+      };
+
+      // (Inline) Return the capacity of the ring
+      ULONG GetCapacity() const
+      {
+         return mCapacity;
+      };
+
+      // (Inline) Return the number of elements dropped as the ring was full
+      ULONG GetDropped() const
+      {
+         return mDropped;
+      };
+
+   protected:
+      /* Number of elements (a power of 2) */
+      ULONG mCapacity;
+
+      /* Elements */
+      tElementType * mpElements;
+
+      /* Position of the next element to consume (consumer owned) */
+      BYTE mPadHead[SPSC_RING_PAD_SZ];
+      volatile ULONG mHead;
+
+      /* Position of the next element to produce (producer owned) */
+      BYTE mPadTail[SPSC_RING_PAD_SZ - sizeof( ULONG )];
+      volatile ULONG mTail;
+
+      /* Number of elements dropped (producer owned) */
+      volatile ULONG mDropped;
+      BYTE mPadEnd[SPSC_RING_PAD_SZ - 2 * sizeof( ULONG )];
+
+   private:
+      // Not copyable
+      cSPSCRing( const cSPSCRing & );
+      cSPSCRing & operator = ( const cSPSCRing & );
+};
@@ -52,93 +52,6 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "StdAfx.h"
 #include "SharedBuffer.h"
 
-//---------------------------------------------------------------------------
-// Definitions
-//---------------------------------------------------------------------------
-
-// Synchronization object
-struct sSharedBufferSync
-{
-   public:
-      // Constructor
-      sSharedBufferSync()
-         :  mbInitialized( false )
-      {
-         int nRet = pthread_mutex_init( &mSyncSection, NULL );
-         if (nRet != 0)
-         {
-            TRACE( "SharedBuffer: Unable to init sync mutex."
-                   " Error %d: %s\n",
-                   nRet,
-                   strerror( nRet ) );
-            return;
-         }         
-
-         mbInitialized = true;
-      };
-
-      // Destructor
-      ~sSharedBufferSync()
-      {
-         mbInitialized = false;
-         int nRet = pthread_mutex_destroy( &mSyncSection );
-         if (nRet != 0)
-         {
-            TRACE( "SharedBuffer: Unable to destroy sync mutex."
-                   " Error %d: %s\n",
-                   nRet,
-                   strerror( nRet ) );
-         }         
-
-      };
-
-      // Lock sync object
-      void Lock()
-      {
-         if (mbInitialized == true)
-         {
-            int nRet = pthread_mutex_lock( &mSyncSection );
-            if (nRet != 0)
-            {
-               TRACE( "SharedBuffer: Unable to lock sync mutex."
-                      " Error %d: %s\n",
-                      nRet,
-                      strerror( nRet ) );
-               return;
-            }            
-
-         }
-      };
-
-      // Unlock sync object
-      void Unlock()
-      {
-         if (mbInitialized == true)
-         {
-            int nRet = pthread_mutex_unlock( &mSyncSection );
-            if (nRet != 0)
-            {
-               TRACE( "SharedBuffer: Unable to unlock sync mutex."
-                      " Error %d: %s\n",
-                      nRet,
-                      strerror( nRet ) );
-               return;
-            }            
-
-         }
-      };
-   
-   protected:
-      /* DIAG buffer critical section */
-      pthread_mutex_t mSyncSection;
-
-      /* Has this object been initialized? */
-      bool mbInitialized;
-};
-
-// Global (across all shared buffers) reference count guard
-sSharedBufferSync gRefCount;
-
 /*=========================================================================*/
 // sSharedBuffer Methods
 /*=========================================================================*/
@@ -165,7 +78,8 @@ sSharedBuffer::sSharedBuffer(
    :  mpData( 0 ),
       mSize( 0 ),
       mType( dataType ),
-      mRefCount( 0 )
+      mRefCount( 0 ),
+      mPoolClass( INVALID_BUFFER_POOL_CLASS )
 {
    // Length not too small/not too big?
    if (IsValidSize( dataLen ) == true)
@@ -174,7 +88,7 @@ sSharedBuffer::sSharedBuffer(
       if (pDataToCopy != 0)
       {
          // Yes, try to allocate memory
-         mpData = new BYTE[dataLen];
+         mpData = cBufferPool::Allocate( dataLen, mPoolClass );
          if (mpData != 0)
          {
             // Now copy into our allocation
@@ -218,7 +132,8 @@ sSharedBuffer::sSharedBuffer(
    :  mpData( 0 ),
       mSize( 0 ),
       mType( dataType ),
-      mRefCount( 0 )
+      mRefCount( 0 ),
+      mPoolClass( INVALID_BUFFER_POOL_CLASS )
 {
    // Data actually exists?
    if (pDataToOwn != 0)
@@ -239,6 +154,41 @@ sSharedBuffer::sSharedBuffer(
    }
 }
 
+/*===========================================================================
+METHOD:
+   sSharedBuffer (Public Method)
+
+DESCRIPTION:
+   Constructor (allocate uninitialized buffer from the buffer pool), the
+   contents are to be filled in through GetWritableBuffer()
+
+PARAMETERS:
+   dataLen     [ I ] - The length of the buffer (should be > 1)
+   dataType    [ I ] - Type of data (not used internal to class)
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+sSharedBuffer::sSharedBuffer( 
+   ULONG                      dataLen,
+   ULONG                      dataType )
+   :  mpData( 0 ),
+      mSize( 0 ),
+      mType( dataType ),
+      mRefCount( 0 ),
+      mPoolClass( INVALID_BUFFER_POOL_CLASS )
+{
+   // Length not too small/not too big?
+   if (IsValidSize( dataLen ) == true)
+   {
+      mpData = cBufferPool::Allocate( dataLen, mPoolClass );
+      if (mpData != 0)
+      {
+         mSize = dataLen;
+      }
+   }
+}
+
 /*===========================================================================
 METHOD:
    ~sSharedBuffer (Public Method)
@@ -256,9 +206,17 @@ sSharedBuffer::~sSharedBuffer()
    // Buffer data to free?
    if (mpData != 0)
    {
-      // Yes, zero first byte for caution and then delete it
+      // Yes, zero first byte for caution and then delete it (or return
+      // it to the buffer pool)
       mpData[0] = 0;
-      delete [] mpData;
+      if (mPoolClass != INVALID_BUFFER_POOL_CLASS)
+      {
+         cBufferPool::Free( mpData, mPoolClass );
+      }
+      else
+      {
+         delete [] mpData;
+      }
 
       // Even more caution, zero out pointer
       mpData = 0;
@@ -333,21 +291,46 @@ bool sSharedBuffer::operator != ( const sSharedBuffer & refBuf ) const
    return true;
 }
 
+/*===========================================================================
+METHOD:
+   Truncate (Public Method)
+
+DESCRIPTION:
+   Reduce the buffer size, only to be used before the buffer is shared 
+   (i.e. when the final size of a buffer allocated from the buffer pool
+   is only known after filling it in)
+
+PARAMETERS:
+   dataLen     [ I ] - The new length (should be > 1 and <= current size)
+  
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool sSharedBuffer::Truncate( ULONG dataLen )
+{
+   if (mpData == 0 || dataLen == 0 || dataLen > mSize || mRefCount != 0)
+   {
+      return false;
+   }
+
+   mSize = dataLen;
+   return true;
+}
+
 /*===========================================================================
 METHOD:
    AddRef (Internal Method)
 
 DESCRIPTION:
-   Increment reference count
+   Increment reference count (atomically, references may be taken and 
+   released on any thread)
   
 RETURN VALUE:
    None
 ===========================================================================*/
 void sSharedBuffer::AddRef()
 {
-   gRefCount.Lock();
-   mRefCount++;     
-   gRefCount.Unlock();
+   __sync_add_and_fetch( &mRefCount, 1 );
 }
 
 /*===========================================================================
@@ -355,28 +338,19 @@ METHOD:
    Release (Internal Method)
 
 DESCRIPTION:
-   Release reference, delete if reference count zero
+   Release reference, delete if reference count zero (atomically, only 
+   the thread releasing the last reference deletes the buffer)
   
 RETURN VALUE:
    None
 ===========================================================================*/
 void sSharedBuffer::Release()
 {
-   gRefCount.Lock();
-
    ASSERT( mRefCount != 0 );
 
-   // Decrement reference count
-   if (mRefCount > 0)
-   {
-      mRefCount--;
-   }
-
-   // ... and delete if reference count now 0
-   if (mRefCount == 0)
+   // Decrement reference count ... and delete if reference count now 0
+   if (__sync_sub_and_fetch( &mRefCount, 1 ) == 0)
    {
       delete this;
    }
-
-   gRefCount.Unlock();
 }
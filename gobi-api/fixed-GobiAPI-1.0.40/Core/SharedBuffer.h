@@ -43,6 +43,11 @@ POSSIBILITY OF SUCH DAMAGE.
 //---------------------------------------------------------------------------
 #pragma once
 
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "BufferPool.h"
+
 //---------------------------------------------------------------------------
 // Forward Declarations
 //---------------------------------------------------------------------------
@@ -84,6 +89,11 @@ struct sSharedBuffer
          PBYTE                      pDataToOwn,
          ULONG                      dataType );
 
+      // Constructor (allocate uninitialized buffer from the buffer pool)
+      sSharedBuffer( 
+         ULONG                      dataLen,
+         ULONG                      dataType );
+
       // Destructor
       virtual ~sSharedBuffer();
 
@@ -99,6 +109,16 @@ struct sSharedBuffer
          return mpData;
       };   
 
+      // (Inline) Get writable buffer, only to be used to fill in a buffer
+      // allocated from the buffer pool before it is shared
+      PBYTE GetWritableBuffer()
+      {
+         return mpData;
+      };   
+
+      // Reduce the buffer size (before it is shared)
+      bool Truncate( ULONG dataLen );
+
       // (Inline) Get buffer size
       ULONG GetSize() const
       {
@@ -146,9 +166,13 @@ struct sSharedBuffer
       /* Type of data */
       ULONG mType;
 
-      /* Reference count */
+      /* Reference count (only modified atomically) */
       ULONG mRefCount;
 
+      /* Buffer pool class of data (INVALID_BUFFER_POOL_CLASS if the
+         data was not allocated from the buffer pool) */
+      ULONG mPoolClass;
+
    private:
       // Leave copy constructor and assignment operator unimplemented
       // to prevent unintentional and unauthorized copying of the object
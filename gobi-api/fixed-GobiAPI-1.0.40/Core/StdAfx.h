@@ -57,6 +57,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include <sys/time.h>
 #include <sys/ioctl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 
 //---------------------------------------------------------------------------
 // Macro defination
@@ -10,6 +10,10 @@ PUBLIC CLASSES AND METHODS:
       Synchronized shareable (across multiple threads) queue of
       structures with event notifications
 
+      The queue policy (second template parameter) selects either a 
+      mutex protected deque (sSyncQueueLocked, the default) or a bounded 
+      lock-free ring (sSyncQueueLockFree) with the same semantics
+
 Copyright (c) 2011, Code Aurora Forum. All rights reserved.
 
 Redistribution and use in source and binary forms, with or without
@@ -47,16 +51,25 @@ POSSIBILITY OF SUCH DAMAGE.
 // Include Files
 //---------------------------------------------------------------------------
 #include <deque>
+#include <sched.h>
 #include "Event.h"
+#include "ProfiledMutex.h"
 
 //---------------------------------------------------------------------------
 // Definitions
 //---------------------------------------------------------------------------
 
+// Queue policy: mutex protected deque
+struct sSyncQueueLocked { };
+
+// Queue policy: bounded lock-free ring
+struct sSyncQueueLockFree { };
+
 /*=========================================================================*/
 // Class cSyncQueue
 /*=========================================================================*/
-template <class tElementType> class cSyncQueue
+template <class tElementType, class tPolicy = sSyncQueueLocked> 
+class cSyncQueue
 {
    public:
       // (Inline) Constructor
@@ -64,20 +77,13 @@ template <class tElementType> class cSyncQueue
          ULONG                      maxElements,
          bool                       bSignalEvent = false )
          :  mSignature( (ULONG)eSYNC_QUEUE_SIG ),
+            mSyncSection(),
             mSignalEvent(),
             mbSignalEvent( bSignalEvent ),
             mMaxElements( maxElements ),
             mTotalElements( 0 )
       {
-         // Create sync CS
-         int nRet = pthread_mutex_init( &mSyncSection, NULL );
-         if (nRet != 0)
-         {
-            TRACE( "SyncQueue: Unable to init sync mutex. Error %d: %s\n",
-                   nRet,
-                   strerror( nRet ) );
-            return;
-         }
+         // Nothing to do
       };
 
       // (Inline) Destructor
@@ -92,15 +98,6 @@ template <class tElementType> class cSyncQueue
             EmptyQueue();
 
             mSignature = 0;
-            int nRet = pthread_mutex_destroy( &mSyncSection );
-            if (nRet != 0)
-            {
-               TRACE( "SyncQueue: Unable to destroy sync mutex."
-                      " Error %d: %s\n",
-                      nRet,
-                      strerror( nRet ) );
-               return;
-            }
          }
 
       };
@@ -116,7 +113,7 @@ template <class tElementType> class cSyncQueue
             return bRC;
          }
 
-         int nRet = pthread_mutex_lock( &mSyncSection );
+         int nRet = mSyncSection.Lock();
          if (nRet != 0)
          {
             TRACE( "SyncQueue: Unable to lock sync mutex. Error %d: %s\n",
@@ -153,7 +150,7 @@ template <class tElementType> class cSyncQueue
          // Success!
          bRC = true;
 
-         nRet = pthread_mutex_unlock( &mSyncSection );
+         nRet = mSyncSection.Unlock();
          if (nRet != 0)
          {
             TRACE( "SyncQueue: Unable to unlock sync mutex. Error %d: %s\n",
@@ -179,7 +176,7 @@ template <class tElementType> class cSyncQueue
             return bRC;
          }
 
-         int nRet = pthread_mutex_lock( &mSyncSection );
+         int nRet = mSyncSection.Lock();
          if (nRet != 0)
          {
             TRACE( "SyncQueue: Unable to lock sync mutex. Error %d: %s\n",
@@ -215,7 +212,7 @@ template <class tElementType> class cSyncQueue
          // Success!
          bRC = true;
 
-         nRet = pthread_mutex_unlock( &mSyncSection );
+         nRet = mSyncSection.Unlock();
          if (nRet != 0)
          {
             TRACE( "SyncQueue: Unable to unlock sync mutex. Error %d: %s\n",
@@ -240,7 +237,7 @@ template <class tElementType> class cSyncQueue
             return bRC;
          }
 
-         int nRet = pthread_mutex_lock( &mSyncSection );
+         int nRet = mSyncSection.Lock();
          if (nRet != 0)
          {
             TRACE( "SyncQueue: Unable to lock sync mutex. Error %d: %s\n",
@@ -262,7 +259,7 @@ template <class tElementType> class cSyncQueue
             }
          }   
      
-         nRet = pthread_mutex_unlock( &mSyncSection );
+         nRet = mSyncSection.Unlock();
          if (nRet != 0)
          {
             TRACE( "SyncQueue: Unable to unlock sync mutex. Error %d: %s\n",
@@ -285,7 +282,7 @@ template <class tElementType> class cSyncQueue
             return bRC;
          }
 
-         int nRet = pthread_mutex_lock( &mSyncSection );
+         int nRet = mSyncSection.Lock();
          if (nRet != 0)
          {
             TRACE( "SyncQueue: Unable to lock sync mutex. Error %d: %s\n",
@@ -298,7 +295,7 @@ template <class tElementType> class cSyncQueue
          mElementDeque.clear();
          mTotalElements = 0;
          
-         nRet = pthread_mutex_unlock( &mSyncSection );
+         nRet = mSyncSection.Unlock();
          if (nRet != 0)
          {
             TRACE( "SyncQueue: Unable to unlock sync mutex. Error %d: %s\n",
@@ -321,7 +318,7 @@ template <class tElementType> class cSyncQueue
             return elems;
          }
 
-         int nRet = pthread_mutex_lock( &mSyncSection );
+         int nRet = mSyncSection.Lock();
          if (nRet != 0)
          {
             TRACE( "SyncQueue: Unable to lock sync mutex. Error %d: %s\n",
@@ -332,7 +329,7 @@ template <class tElementType> class cSyncQueue
          
          elems = (ULONG)mElementDeque.size();
          
-         nRet = pthread_mutex_unlock( &mSyncSection );
+         nRet = mSyncSection.Unlock();
          if (nRet != 0)
          {
             TRACE( "SyncQueue: Unable to unlock sync mutex. Error %d: %s\n",
@@ -354,7 +351,7 @@ template <class tElementType> class cSyncQueue
             return elems;
          }
 
-         int nRet = pthread_mutex_lock( &mSyncSection );
+         int nRet = mSyncSection.Lock();
          if (nRet != 0)
          {
             TRACE( "SyncQueue: Unable to lock sync mutex. Error %d: %s\n",
@@ -365,7 +362,7 @@ template <class tElementType> class cSyncQueue
          
          elems = mTotalElements;
          
-         nRet = pthread_mutex_unlock( &mSyncSection );
+         nRet = mSyncSection.Unlock();
          if (nRet != 0)
          {
             TRACE( "SyncQueue: Unable to unlock sync mutex. Error %d: %s\n",
@@ -383,6 +380,12 @@ template <class tElementType> class cSyncQueue
          return mSignalEvent;
       };
 
+      // (Inline) Set the name lock contention is accounted under
+      void SetLockName( LPCSTR pName )
+      {
+         mSyncSection.SetName( pName );
+      };
+
       // (Inline) Is this sync queue valid?
       bool IsValid() const
       {
@@ -400,7 +403,7 @@ template <class tElementType> class cSyncQueue
       ULONG mSignature;
 
       /* Multithreaded mutex type */
-      mutable pthread_mutex_t mSyncSection;
+      mutable cProfiledMutex mSyncSection;
 
       /* Signal event, set everytime an element is added (if configured) */
       mutable cEvent mSignalEvent;
@@ -417,3 +420,274 @@ template <class tElementType> class cSyncQueue
      /* Element queue */
       std::deque <tElementType> mElementDeque;
 };
+
+/*=========================================================================*/
+// Class cSyncQueue (lock-free policy)
+//
+//    Bounded multi-producer/multi-consumer ring, in the style of Vyukov's
+//    bounded queue: producers claim a position with an atomic increment
+//    and each cell carries a sequence number marking which position it
+//    currently holds.  As with the deque based version the oldest element
+//    is dropped once full, elements keep their position as index, and
+//    readers copy elements out by index without locking
+//
+//    NOTE: EmptyQueue() must not be called concurrently with AddElement()
+/*=========================================================================*/
+template <class tElementType> 
+class cSyncQueue <tElementType, sSyncQueueLockFree>
+{
+   public:
+      // (Inline) Constructor
+      cSyncQueue(
+         ULONG                      maxElements,
+         bool                       bSignalEvent = false )
+         :  mSignature( (ULONG)eSYNC_QUEUE_SIG ),
+            mSignalEvent(),
+            mbSignalEvent( bSignalEvent ),
+            mMaxElements( maxElements > 0 ? maxElements : 1 ),
+            mTotalElements( 0 ),
+            mpCells( 0 )
+      {
+         mpCells = new sCell[mMaxElements];
+      };
+
+      // (Inline) Destructor
+      ~cSyncQueue()
+      {
+         if (IsValid() == false)
+         {
+            ASSERT( (PVOID)"Double deletion detected in ~cSyncQueue" == 0 );
+         }
+         else
+         {
+            EmptyQueue();
+
+            mSignature = 0;
+            delete [] mpCells;
+            mpCells = 0;
+         }
+      };
+
+      // (Inline) Add an element to the queue
+      bool AddElement( const tElementType & elem )
+      {
+         ULONG idx;
+         return AddElement( elem, idx );
+      };
+
+      // (Inline) Add an element to the queue returning the index of
+      // the element
+      bool AddElement( 
+         const tElementType &       elem,
+         ULONG &                    idx )
+      {
+         // Assume failure
+         bool bRC = false;
+         if (IsValid() == false)
+         {
+            ASSERT( (PVOID)"Bad cSyncQueue object detected" == 0 );
+            return bRC;
+         }
+
+         // Claim the next position
+         ULONG pos = __sync_fetch_and_add( &mTotalElements, 1 );
+         sCell & cell = mpCells[pos % mMaxElements];
+
+         // Wait for the producer of the previous lap through this cell
+         ULONG prevSeq = (pos >= mMaxElements ? pos - mMaxElements + 1 : 0);
+         while (cell.mSeq != prevSeq)
+         {
+            sched_yield();
+         }
+
+         // Stop new readers, wait out current ones
+         cell.mSeq = 0;
+         __sync_synchronize();
+
+         while (cell.mReaders != 0)
+         {
+            sched_yield();
+         }
+
+         __sync_synchronize();
+         cell.mElement = elem;
+
+         // Publish
+         __sync_synchronize();
+         cell.mSeq = pos + 1;
+         idx = pos;
+
+         // Set event?
+         if (mbSignalEvent == true)
+         {
+            // Signal index of event
+            int nRet = mSignalEvent.Set( pos );
+            if (nRet != 0)
+            {
+               TRACE( "SyncQueue: Unable to signal. Error %d: %s\n",
+                      nRet,
+                      strerror( nRet ) );
+               return false;
+            }
+         }
+
+         // Success!
+         bRC = true;
+         return bRC;
+      };
+
+      // (Inline) Return given element in the queue
+      bool GetElement(
+         ULONG                      idx,
+         tElementType &             elem ) const
+      {
+         // Assume failure
+         bool bRC = false;
+         if (IsValid() == false)
+         {
+            ASSERT( (PVOID)"Bad cSyncQueue object detected" == 0 );
+            return bRC;
+         }
+
+         sCell & cell = mpCells[idx % mMaxElements];
+
+         // Skip cells that obviously do not hold the element (so that 
+         // readers polling a cell being written do not hold off the writer)
+         if (cell.mSeq != idx + 1)
+         {
+            return bRC;
+         }
+
+         // Announce ourselves (a full barrier) before checking the cell again
+         __sync_add_and_fetch( &cell.mReaders, 1 );
+         if (cell.mSeq == idx + 1)
+         {
+            elem = cell.mElement;
+            bRC = true;
+         }
+
+         __sync_sub_and_fetch( &cell.mReaders, 1 );
+         return bRC;
+      };
+
+      // (Inline) Empty element queue
+      bool EmptyQueue()
+      {
+         // Assume failure
+         bool bRC = false;
+         if (IsValid() == false)
+         {
+            ASSERT( (PVOID)"Bad cSyncQueue object detected" == 0 );
+            return bRC;
+         }
+
+         for (ULONG c = 0; c < mMaxElements; c++)
+         {
+            sCell & cell = mpCells[c];
+            if (cell.mSeq == 0)
+            {
+               continue;
+            }
+
+            cell.mSeq = 0;
+            __sync_synchronize();
+
+            while (cell.mReaders != 0)
+            {
+               sched_yield();
+            }
+
+            cell.mElement = tElementType();
+         }
+
+         __sync_synchronize();
+         mTotalElements = 0;
+
+         bRC = true;
+         return bRC;
+      };
+
+      // (Inline) Return the number of queued elements
+      ULONG GetQueueCount() const
+      {
+         ULONG elems = GetTotalCount();
+         if (elems > mMaxElements)
+         {
+            elems = mMaxElements;
+         }
+
+         return elems;
+      };
+
+      // (Inline) Return the total number of elements added to queue
+      ULONG GetTotalCount() const
+      {
+         ULONG elems = 0;
+         if (IsValid() == false)
+         {
+            ASSERT( (PVOID)"Bad cSyncQueue object detected" == 0 );
+            return elems;
+         }
+
+         elems = mTotalElements;
+         __sync_synchronize();
+         return elems;
+      };
+
+      // (Inline) Return the signal event
+      cEvent & GetSignalEvent() const
+      {
+         return mSignalEvent;
+      };
+
+      // (Inline) Is this sync queue valid?
+      bool IsValid() const
+      {
+         return (mSignature == (ULONG)eSYNC_QUEUE_SIG);
+      };
+
+   protected:
+      // Object signature
+      enum eClassConstants
+      {
+         eSYNC_QUEUE_SIG = 0x1799A2BD
+      };
+
+      // A single ring cell
+      struct sCell
+      {
+         // (Inline) Constructor
+         sCell()
+            :  mElement(),
+               mSeq( 0 ),
+               mReaders( 0 )
+         { };
+
+         /* The element */
+         tElementType mElement;
+
+         /* Position held by this cell plus one (0 = empty/being written) */
+         volatile ULONG mSeq;
+
+         /* Number of readers currently copying the above element */
+         volatile ULONG mReaders;
+      };
+
+      /* Object signature */
+      ULONG mSignature;
+
+      /* Signal event, set everytime an element is added (if configured) */
+      mutable cEvent mSignalEvent;
+      
+      /* Use above signal event? */
+      bool mbSignalEvent;
+
+      /* Maximum number of elements (cells in the ring) */
+      ULONG mMaxElements;
+
+      /* Total number of element positions claimed */
+      volatile ULONG mTotalElements;
+
+      /* Element ring */
+      sCell * mpCells;
+};
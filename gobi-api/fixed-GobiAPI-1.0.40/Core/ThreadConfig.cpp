@@ -0,0 +1,377 @@
+/*===========================================================================
+FILE:
+   ThreadConfig.cpp
+
+DESCRIPTION:
+   Implementation of cThreadConfig class
+
+PUBLIC CLASSES AND METHODS:
+   cThreadConfig
+      This class holds the CPU affinity, scheduling class and name of each
+      role of thread the library creates, and starts threads accordingly
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "StdAfx.h"
+#include "ThreadConfig.h"
+
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+//---------------------------------------------------------------------------
+// Definitions
+//---------------------------------------------------------------------------
+
+// Longest thread name the kernel keeps (not counting the terminator)
+const ULONG MAX_THREAD_NAME = 15;
+
+// Name of each thread role (when not configured)
+static LPCSTR gRoleNames[eTHREAD_ROLE_ENUM_END] =
+{
+   "qmisched",
+   "qmirx",
+   "qmitraffic",
+   "qmiworker"
+};
+
+// Thread start work item
+struct sThreadStart
+{
+   /* Configuration (and role) to apply */
+   cThreadConfig mConfig;
+   eThreadRole mRole;
+
+   /* Thread routine and its argument */
+   void * (* mpStartRoutine)( void * );
+   void * mpArg;
+};
+
+/*=========================================================================*/
+// Free Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   ConfiguredThread (Free Method)
+
+DESCRIPTION:
+   Apply the settings of the thread's role and then run the thread routine
+
+PARAMETERS:
+   pData       [ I ] - Thread start work item (sThreadStart, freed here)
+  
+RETURN VALUE:
+   void * - value returned by the thread routine
+===========================================================================*/
+static void * ConfiguredThread( void * pData )
+{
+   sThreadStart * pStart = (sThreadStart *)pData;
+   void * (* pStartRoutine)( void * ) = pStart->mpStartRoutine;
+   void * pArg = pStart->mpArg;
+
+   pStart->mConfig.Apply( pStart->mRole );
+   delete pStart;
+
+   return pStartRoutine( pArg );
+}
+
+/*=========================================================================*/
+// sThreadSettings Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   sThreadSettings (Public Method)
+
+DESCRIPTION:
+   Constructor (default settings)
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+sThreadSettings::sThreadSettings()
+   :  mbAffinity( false ),
+      mPolicy( SCHED_OTHER ),
+      mPriority( 0 ),
+      mbNice( false ),
+      mNice( 0 ),
+      mName( "" )
+{
+   CPU_ZERO( &mCPUs );
+}
+
+/*===========================================================================
+METHOD:
+   IsDefault (Public Method)
+
+DESCRIPTION:
+   Are these the default settings?
+  
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool sThreadSettings::IsDefault() const
+{
+   return ( (mbAffinity == false)
+        &&  (mPolicy == SCHED_OTHER)
+        &&  (mbNice == false)
+        &&  (mName.size() == 0) );
+}
+
+/*=========================================================================*/
+// cThreadConfig Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   cThreadConfig (Public Method)
+
+DESCRIPTION:
+   Constructor (default settings for every role)
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+cThreadConfig::cThreadConfig()
+   :  mDevice( "" )
+{
+   // Nothing to do
+}
+
+/*===========================================================================
+METHOD:
+   SetRole (Public Method)
+
+DESCRIPTION:
+   Set the settings of a role, these apply to threads started afterwards
+
+PARAMETERS:
+   role        [ I ] - Thread role
+   settings    [ I ] - Settings of the role
+  
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cThreadConfig::SetRole(
+   eThreadRole                role,
+   const sThreadSettings &    settings )
+{
+   if (role <= eTHREAD_ROLE_ENUM_BEGIN || role >= eTHREAD_ROLE_ENUM_END)
+   {
+      return false;
+   }
+
+   if ( (settings.mPolicy != SCHED_OTHER)
+   &&   (settings.mPolicy != SCHED_FIFO)
+   &&   (settings.mPolicy != SCHED_RR) )
+   {
+      return false;
+   }
+
+   if (settings.mPolicy != SCHED_OTHER)
+   {
+      int minPriority = sched_get_priority_min( settings.mPolicy );
+      int maxPriority = sched_get_priority_max( settings.mPolicy );
+      if (settings.mPriority < minPriority || settings.mPriority > maxPriority)
+      {
+         return false;
+      }
+   }
+
+   if ( (settings.mbAffinity == true)
+   &&   (CPU_COUNT( &settings.mCPUs ) == 0) )
+   {
+      return false;
+   }
+
+   mRoles[role] = settings;
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   GetRole (Public Method)
+
+DESCRIPTION:
+   Return the settings of a role
+
+PARAMETERS:
+   role        [ I ] - Thread role
+  
+RETURN VALUE:
+   const sThreadSettings & (defaults for an invalid role)
+===========================================================================*/
+const sThreadSettings & cThreadConfig::GetRole( eThreadRole role ) const
+{
+   static const sThreadSettings defaults;
+   if (role <= eTHREAD_ROLE_ENUM_BEGIN || role >= eTHREAD_ROLE_ENUM_END)
+   {
+      return defaults;
+   }
+
+   return mRoles[role];
+}
+
+/*===========================================================================
+METHOD:
+   Apply (Public Method)
+
+DESCRIPTION:
+   Apply the settings of a role to the calling thread, the thread is named
+   after the role (or the configured name) and the device node, settings
+   that cannot be applied are logged and skipped
+
+PARAMETERS:
+   role        [ I ] - Thread role
+  
+RETURN VALUE:
+   bool - true if every setting was applied
+===========================================================================*/
+bool cThreadConfig::Apply( eThreadRole role ) const
+{
+   if (role <= eTHREAD_ROLE_ENUM_BEGIN || role >= eTHREAD_ROLE_ENUM_END)
+   {
+      return false;
+   }
+
+   const sThreadSettings & settings = mRoles[role];
+   bool bRC = true;
+
+   std::string name = settings.mName;
+   if (name.size() == 0)
+   {
+      name = gRoleNames[role];
+   }
+
+   if (mDevice.size() > 0)
+   {
+      name += "-" + mDevice;
+   }
+
+   if (name.size() > MAX_THREAD_NAME)
+   {
+      name.resize( MAX_THREAD_NAME );
+   }
+
+   pthread_t self = pthread_self();
+   pthread_setname_np( self, name.c_str() );
+
+   if (settings.mbAffinity == true)
+   {
+      int nRet = pthread_setaffinity_np( self, 
+                                         sizeof( settings.mCPUs ), 
+                                         &settings.mCPUs );
+      if (nRet != 0)
+      {
+         TRACE( "cThreadConfig::Apply(), %s affinity error %d: %s\n",
+                name.c_str(),
+                nRet,
+                strerror( nRet ) );
+
+         bRC = false;
+      }
+   }
+
+   if (settings.mPolicy != SCHED_OTHER)
+   {
+      sched_param param;
+      memset( &param, 0, sizeof( param ) );
+      param.sched_priority = settings.mPriority;
+
+      int nRet = pthread_setschedparam( self, settings.mPolicy, &param );
+      if (nRet != 0)
+      {
+         TRACE( "cThreadConfig::Apply(), %s policy error %d: %s\n",
+                name.c_str(),
+                nRet,
+                strerror( nRet ) );
+
+         bRC = false;
+      }
+   }
+   else if (settings.mbNice == true)
+   {
+      // Under Linux niceness is a per thread attribute
+      pid_t tid = (pid_t)syscall( SYS_gettid );
+      if (setpriority( PRIO_PROCESS, tid, settings.mNice ) != 0)
+      {
+         TRACE( "cThreadConfig::Apply(), %s nice error %d: %s\n",
+                name.c_str(),
+                errno,
+                strerror( errno ) );
+
+         errno = 0;
+         bRC = false;
+      }
+   }
+
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   CreateThread (Public Method)
+
+DESCRIPTION:
+   Start a thread with the settings of a role, these are applied by the
+   new thread itself before the thread routine is run
+
+PARAMETERS:
+   role           [ I ] - Thread role
+   pThreadID      [ O ] - ID of the new thread
+   pStartRoutine  [ I ] - Thread routine
+   pArg           [ I ] - Argument of the thread routine
+  
+RETURN VALUE:
+   int - pthread_create() return value (0 for success)
+===========================================================================*/
+int cThreadConfig::CreateThread(
+   eThreadRole                role,
+   pthread_t *                pThreadID,
+   void * (*                  pStartRoutine)( void * ),
+   void *                     pArg ) const
+{
+   sThreadStart * pStart = new sThreadStart;
+   pStart->mConfig = *this;
+   pStart->mRole = role;
+   pStart->mpStartRoutine = pStartRoutine;
+   pStart->mpArg = pArg;
+
+   int nRet = pthread_create( pThreadID, NULL, ConfiguredThread, pStart );
+   if (nRet != 0)
+   {
+      delete pStart;
+   }
+
+   return nRet;
+}
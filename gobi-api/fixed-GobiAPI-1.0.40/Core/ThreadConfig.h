@@ -0,0 +1,157 @@
+/*===========================================================================
+FILE:
+   ThreadConfig.h
+
+DESCRIPTION:
+   Declaration of cThreadConfig class
+
+PUBLIC CLASSES AND METHODS:
+   cThreadConfig
+      This class holds the CPU affinity, scheduling class and name of each
+      role of thread the library creates, and starts threads accordingly
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+
+//---------------------------------------------------------------------------
+// Pragmas
+//---------------------------------------------------------------------------
+#pragma once
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "StdAfx.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <string>
+
+/*=========================================================================*/
+// eThreadRole Enumeration
+//
+//    Role of a library thread
+/*=========================================================================*/
+enum eThreadRole
+{
+   eTHREAD_ROLE_ENUM_BEGIN = -1,
+
+   eTHREAD_ROLE_SCHEDULE,        // 0 Protocol server schedule threads
+   eTHREAD_ROLE_RX,              // 1 Receive completions (POSIX AIO 
+                                 //   notifications, reactor thread)
+   eTHREAD_ROLE_TRAFFIC,         // 2 Traffic processing, parse and callback
+                                 //   threads of connection management
+   eTHREAD_ROLE_WORKER,          // 3 Everything else (server startup, 
+                                 //   reaper, executors, device pool and
+                                 //   monitor threads)
+
+   eTHREAD_ROLE_ENUM_END
+};
+
+/*=========================================================================*/
+// Struct sThreadSettings
+//
+//    Settings of one thread role, the defaults leave a thread exactly as
+//    pthread_create() would
+/*=========================================================================*/
+struct sThreadSettings
+{
+   // Constructor (default settings)
+   sThreadSettings();
+
+   // Are these the default settings?
+   bool IsDefault() const;
+
+   /* Restrict the threads to the CPUs in mCPUs? */
+   bool mbAffinity;
+   cpu_set_t mCPUs;
+
+   /* Scheduling policy (SCHED_OTHER, SCHED_FIFO or SCHED_RR) and priority
+      (real-time policies only) */
+   int mPolicy;
+   int mPriority;
+
+   /* Change the niceness of the threads (SCHED_OTHER only) to mNice? */
+   bool mbNice;
+   int mNice;
+
+   /* Thread name, the device node is appended (empty for the role name) */
+   std::string mName;
+};
+
+/*=========================================================================*/
+// Class cThreadConfig
+//
+//    Threads are configured from within, once running, so settings the 
+//    process is not permitted (e.g. SCHED_FIFO without CAP_SYS_NICE) are
+//    logged and skipped rather than failing thread creation
+/*=========================================================================*/
+class cThreadConfig
+{
+   public:
+      // Constructor
+      cThreadConfig();
+
+      // Set the settings of a role
+      bool SetRole(
+         eThreadRole                role,
+         const sThreadSettings &    settings );
+
+      // Return the settings of a role
+      const sThreadSettings & GetRole( eThreadRole role ) const;
+
+      // (Inline) Set the device node (IE: qcqmi0) named in thread names
+      void SetDevice( const std::string & device )
+      {
+         mDevice = device;
+      };
+
+      // (Inline) Return the device node named in thread names
+      const std::string & GetDevice() const
+      {
+         return mDevice;
+      };
+
+      // Apply the settings of a role to the calling thread
+      bool Apply( eThreadRole role ) const;
+
+      // Start a thread with the settings of a role
+      int CreateThread(
+         eThreadRole                role,
+         pthread_t *                pThreadID,
+         void * (*                  pStartRoutine)( void * ),
+         void *                     pArg ) const;
+
+   protected:
+      /* Settings of each role */
+      sThreadSettings mRoles[eTHREAD_ROLE_ENUM_END];
+
+      /* Device node named in thread names (empty for none) */
+      std::string mDevice;
+};
@@ -0,0 +1,555 @@
+/*===========================================================================
+FILE:
+   TimerWheel.cpp
+
+DESCRIPTION:
+   Implementation of cTimerWheel class
+
+PUBLIC CLASSES AND METHODS:
+   sTimerWheelNode
+      Intrusive timer entry, embedded in (or inherited by) the object
+      being timed
+
+   cTimerWheel
+      Hierarchical timing wheel with millisecond ticks providing O(1)
+      insertion, removal and expiry of timer entries
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "StdAfx.h"
+#include "TimerWheel.h"
+
+//---------------------------------------------------------------------------
+// Definitions
+//---------------------------------------------------------------------------
+
+// Slot index of the expired list
+const ULONG TIMER_WHEEL_EXPIRED_SLOT = TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS;
+
+// Slot mask within a level
+const ULONGLONG TIMER_WHEEL_SLOT_MASK = TIMER_WHEEL_SLOTS - 1;
+
+/*=========================================================================*/
+// Free Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   RotateRight (Free Method)
+
+DESCRIPTION:
+   Rotate a slot bitmap so that the given slot becomes bit 0
+
+PARAMETERS:
+   bits        [ I ] - Slot bitmap
+   pos         [ I ] - Slot to rotate down to bit 0
+
+RETURN VALUE:
+   ULONGLONG - rotated bitmap
+===========================================================================*/
+static inline ULONGLONG RotateRight(
+   ULONGLONG                  bits,
+   ULONG                      pos )
+{
+   if (pos == 0)
+   {
+      return bits;
+   }
+
+   return (bits >> pos) | (bits << (TIMER_WHEEL_SLOTS - pos));
+}
+
+/*=========================================================================*/
+// sTimerWheelNode Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   ~sTimerWheelNode (Public Method)
+
+DESCRIPTION:
+   Destructor, removes the entry from any wheel it is linked in
+
+RETURN VALUE:
+   None
+===========================================================================*/
+sTimerWheelNode::~sTimerWheelNode()
+{
+   if (mpWheel != 0)
+   {
+      mpWheel->Remove( *this );
+   }
+}
+
+/*=========================================================================*/
+// cTimerWheel Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   cTimerWheel (Public Method)
+
+DESCRIPTION:
+   Constructor
+
+PARAMETERS:
+   startTick   [ I ] - Current tick (first tick to be processed)
+
+RETURN VALUE:
+   None
+===========================================================================*/
+cTimerWheel::cTimerWheel( ULONGLONG startTick )
+   :  mTick( startTick ),
+      mCount( 0 ),
+      mExpiredCount( 0 )
+{
+   for (ULONG l = 0; l < TIMER_WHEEL_LEVELS; l++)
+   {
+      mOccupied[l] = 0;
+   }
+}
+
+/*===========================================================================
+METHOD:
+   ~cTimerWheel (Public Method)
+
+DESCRIPTION:
+   Destructor, any entries still linked are simply orphaned (unlinked)
+
+RETURN VALUE:
+   None
+===========================================================================*/
+cTimerWheel::~cTimerWheel()
+{
+   for (ULONG s = 0; s <= TIMER_WHEEL_EXPIRED_SLOT; s++)
+   {
+      sTimerWheelLink * pHead = &mExpired;
+      if (s < TIMER_WHEEL_EXPIRED_SLOT)
+      {
+         pHead = &mSlots[s];
+      }
+
+      sTimerWheelLink * pLink = pHead->mpNext;
+      while (pLink != pHead)
+      {
+         sTimerWheelLink * pNext = pLink->mpNext;
+
+         sTimerWheelNode * pNode = static_cast <sTimerWheelNode *>( pLink );
+         pNode->mpPrev = pNode;
+         pNode->mpNext = pNode;
+         pNode->mpWheel = 0;
+
+         pLink = pNext;
+      }
+
+      pHead->mpPrev = pHead;
+      pHead->mpNext = pHead;
+   }
+
+   mCount = 0;
+   mExpiredCount = 0;
+}
+
+/*===========================================================================
+METHOD:
+   Insert (Public Method)
+
+DESCRIPTION:
+   Add an entry to expire at the given absolute tick, an entry that is
+   already linked (in this or another wheel) is moved
+
+PARAMETERS:
+   node        [I/O] - Entry being added
+   expiry      [ I ] - Absolute expiry tick (ticks already gone by place
+                       the entry directly on the expired list)
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cTimerWheel::Insert(
+   sTimerWheelNode &          node,
+   ULONGLONG                  expiry )
+{
+   if (node.mpWheel != 0)
+   {
+      node.mpWheel->Remove( node );
+   }
+
+   node.mExpiry = expiry;
+   node.mpWheel = this;
+   mCount++;
+
+   Place( node );
+}
+
+/*===========================================================================
+METHOD:
+   Remove (Public Method)
+
+DESCRIPTION:
+   Remove an entry (pending or expired), entries not linked in this
+   wheel are ignored
+
+PARAMETERS:
+   node        [I/O] - Entry being removed
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cTimerWheel::Remove( sTimerWheelNode & node )
+{
+   if (node.mpWheel != this)
+   {
+      return;
+   }
+
+   node.mpPrev->mpNext = node.mpNext;
+   node.mpNext->mpPrev = node.mpPrev;
+
+   // Slot now empty?
+   ULONG slot = node.mSlot;
+   if (slot == TIMER_WHEEL_EXPIRED_SLOT)
+   {
+      mExpiredCount--;
+   }
+   else if (mSlots[slot].mpNext == &mSlots[slot])
+   {
+      mOccupied[slot / TIMER_WHEEL_SLOTS] &=
+         ~(1ULL << (slot % TIMER_WHEEL_SLOTS));
+   }
+
+   node.mpPrev = &node;
+   node.mpNext = &node;
+   node.mpWheel = 0;
+   mCount--;
+}
+
+/*===========================================================================
+METHOD:
+   Advance (Public Method)
+
+DESCRIPTION:
+   Advance the wheel, moving every entry due by the given tick to the
+   expired list.  Ticks with nothing to expire or cascade are skipped
+
+PARAMETERS:
+   now         [ I ] - Current tick
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cTimerWheel::Advance( ULONGLONG now )
+{
+   while (mTick <= now)
+   {
+      ULONGLONG t = mTick;
+
+      // Lower level wrapped?  Cascade the slot(s) for this block down
+      if ((t & TIMER_WHEEL_SLOT_MASK) == 0)
+      {
+         for (ULONG l = 1; l < TIMER_WHEEL_LEVELS; l++)
+         {
+            ULONG idx = (ULONG)(t >> (l * TIMER_WHEEL_SLOT_BITS))
+                      & TIMER_WHEEL_SLOT_MASK;
+
+            Cascade( l, idx );
+            if (idx != 0)
+            {
+               break;
+            }
+         }
+      }
+
+      // Everything in this tick's slot is due, move it over as one batch
+      ULONG slot = (ULONG)(t & TIMER_WHEEL_SLOT_MASK);
+      sTimerWheelLink & head = mSlots[slot];
+      if (head.mpNext != &head)
+      {
+         sTimerWheelLink * pLink = head.mpNext;
+         while (pLink != &head)
+         {
+            static_cast <sTimerWheelNode *>( pLink )->mSlot =
+               TIMER_WHEEL_EXPIRED_SLOT;
+
+            mExpiredCount++;
+            pLink = pLink->mpNext;
+         }
+
+         head.mpNext->mpPrev = mExpired.mpPrev;
+         head.mpPrev->mpNext = &mExpired;
+         mExpired.mpPrev->mpNext = head.mpNext;
+         mExpired.mpPrev = head.mpPrev;
+
+         head.mpPrev = &head;
+         head.mpNext = &head;
+         mOccupied[0] &= ~(1ULL << slot);
+      }
+
+      // Skip ahead to the next tick that has something to do
+      ULONGLONG next = NextTick( t + 1 );
+      if (next <= now)
+      {
+         mTick = next;
+      }
+      else
+      {
+         mTick = now + 1;
+      }
+   }
+}
+
+/*===========================================================================
+METHOD:
+   PopExpired (Public Method)
+
+DESCRIPTION:
+   Remove and return the oldest expired entry
+
+RETURN VALUE:
+   sTimerWheelNode * - the entry (0 if none have expired)
+===========================================================================*/
+sTimerWheelNode * cTimerWheel::PopExpired()
+{
+   if (mExpired.mpNext == &mExpired)
+   {
+      return 0;
+   }
+
+   sTimerWheelNode * pNode = static_cast <sTimerWheelNode *>( mExpired.mpNext );
+   Remove( *pNode );
+
+   return pNode;
+}
+
+/*===========================================================================
+METHOD:
+   GetNextExpiry (Public Method)
+
+DESCRIPTION:
+   Return the earliest tick at which the next Advance() will have
+   something to do; this is either an entry's expiry or a (no later)
+   cascade of entries on a higher level
+
+PARAMETERS:
+   tick        [ O ] - The tick (<= the current tick when entries have
+                       already expired)
+
+RETURN VALUE:
+   bool - false when the wheel is empty
+===========================================================================*/
+bool cTimerWheel::GetNextExpiry( ULONGLONG & tick ) const
+{
+   if (mCount == 0)
+   {
+      return false;
+   }
+
+   if (HasExpired() == true)
+   {
+      tick = mTick - 1;
+   }
+   else
+   {
+      tick = NextTick( mTick );
+   }
+
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   Link (Internal Method)
+
+DESCRIPTION:
+   Link an entry at the tail of the given slot list
+
+PARAMETERS:
+   node        [I/O] - Entry being linked
+   slot        [ I ] - Slot list index
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cTimerWheel::Link(
+   sTimerWheelNode &          node,
+   ULONG                      slot )
+{
+   sTimerWheelLink * pHead = &mExpired;
+   if (slot < TIMER_WHEEL_EXPIRED_SLOT)
+   {
+      pHead = &mSlots[slot];
+      mOccupied[slot / TIMER_WHEEL_SLOTS] |=
+         (1ULL << (slot % TIMER_WHEEL_SLOTS));
+   }
+   else
+   {
+      mExpiredCount++;
+   }
+
+   node.mpNext = pHead;
+   node.mpPrev = pHead->mpPrev;
+   pHead->mpPrev->mpNext = &node;
+   pHead->mpPrev = &node;
+
+   node.mSlot = slot;
+}
+
+/*===========================================================================
+METHOD:
+   Place (Internal Method)
+
+DESCRIPTION:
+   Place an (unlinked) entry on the first level whose span covers its
+   distance from the current tick
+
+PARAMETERS:
+   node        [I/O] - Entry being placed
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cTimerWheel::Place( sTimerWheelNode & node )
+{
+   if (node.mExpiry < mTick)
+   {
+      Link( node, TIMER_WHEEL_EXPIRED_SLOT );
+      return;
+   }
+
+   ULONGLONG delta = node.mExpiry - mTick;
+   for (ULONG l = 0; l < TIMER_WHEEL_LEVELS; l++)
+   {
+      ULONG shift = l * TIMER_WHEEL_SLOT_BITS;
+      if (delta < (1ULL << (shift + TIMER_WHEEL_SLOT_BITS)))
+      {
+         ULONG idx = (ULONG)(node.mExpiry >> shift) & TIMER_WHEEL_SLOT_MASK;
+         Link( node, l * TIMER_WHEEL_SLOTS + idx );
+         return;
+      }
+   }
+
+   // Beyond the span of the wheel, park in the furthest top level slot
+   ULONG shift = (TIMER_WHEEL_LEVELS - 1) * TIMER_WHEEL_SLOT_BITS;
+   ULONGLONG furthest = mTick + (1ULL << (shift + TIMER_WHEEL_SLOT_BITS)) - 1;
+   ULONG idx = (ULONG)(furthest >> shift) & TIMER_WHEEL_SLOT_MASK;
+   Link( node, (TIMER_WHEEL_LEVELS - 1) * TIMER_WHEEL_SLOTS + idx );
+}
+
+/*===========================================================================
+METHOD:
+   Cascade (Internal Method)
+
+DESCRIPTION:
+   Re-place every entry of the given level's slot relative to the
+   current tick (moving them down at least one level)
+
+PARAMETERS:
+   level       [ I ] - Wheel level
+   idx         [ I ] - Slot within level
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cTimerWheel::Cascade(
+   ULONG                      level,
+   ULONG                      idx )
+{
+   ULONG slot = level * TIMER_WHEEL_SLOTS + idx;
+   sTimerWheelLink & head = mSlots[slot];
+   if (head.mpNext == &head)
+   {
+      return;
+   }
+
+   // Detach the list before re-placing (entries may land back here)
+   sTimerWheelLink * pLink = head.mpNext;
+   head.mpPrev->mpNext = 0;
+   head.mpPrev = &head;
+   head.mpNext = &head;
+   mOccupied[level] &= ~(1ULL << idx);
+
+   while (pLink != 0)
+   {
+      sTimerWheelLink * pNext = pLink->mpNext;
+      Place( *static_cast <sTimerWheelNode *>( pLink ) );
+      pLink = pNext;
+   }
+}
+
+/*===========================================================================
+METHOD:
+   NextTick (Internal Method)
+
+DESCRIPTION:
+   Return the earliest tick >= from at which a level 0 entry expires or
+   a higher level slot cascades
+
+PARAMETERS:
+   from        [ I ] - First tick to consider (no earlier than mTick)
+
+RETURN VALUE:
+   ULONGLONG - the tick (all ones when the wheel has no pending entries)
+===========================================================================*/
+ULONGLONG cTimerWheel::NextTick( ULONGLONG from ) const
+{
+   ULONGLONG best = ~0ULL;
+
+   // Level 0 entries expire within the next TIMER_WHEEL_SLOTS ticks
+   if (mOccupied[0] != 0)
+   {
+      ULONG pos = (ULONG)(from & TIMER_WHEEL_SLOT_MASK);
+      ULONGLONG bits = RotateRight( mOccupied[0], pos );
+      best = from + __builtin_ctzll( bits );
+   }
+
+   // Higher levels cascade on the first wrap of their slot's block
+   for (ULONG l = 1; l < TIMER_WHEEL_LEVELS; l++)
+   {
+      if (mOccupied[l] == 0)
+      {
+         continue;
+      }
+
+      ULONG shift = l * TIMER_WHEEL_SLOT_BITS;
+      ULONGLONG block = (from + (1ULL << shift) - 1) >> shift;
+
+      ULONG pos = (ULONG)(block & TIMER_WHEEL_SLOT_MASK);
+      ULONGLONG bits = RotateRight( mOccupied[l], pos );
+      ULONGLONG tick = (block + __builtin_ctzll( bits )) << shift;
+      if (tick < best)
+      {
+         best = tick;
+      }
+   }
+
+   return best;
+}
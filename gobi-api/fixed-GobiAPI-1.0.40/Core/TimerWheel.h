@@ -0,0 +1,250 @@
+/*===========================================================================
+FILE:
+   TimerWheel.h
+
+DESCRIPTION:
+   Declaration of cTimerWheel class
+
+PUBLIC CLASSES AND METHODS:
+   sTimerWheelNode
+      Intrusive timer entry, embedded in (or inherited by) the object
+      being timed
+
+   cTimerWheel
+      Hierarchical timing wheel with millisecond ticks providing O(1)
+      insertion, removal and expiry of timer entries
+
+   WARNING:
+      This class is not designed to be thread safe
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Pragmas
+//---------------------------------------------------------------------------
+#pragma once
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "StdAfx.h"
+
+//---------------------------------------------------------------------------
+// Forward Declarations
+//---------------------------------------------------------------------------
+class cTimerWheel;
+
+//---------------------------------------------------------------------------
+// Definitions
+//---------------------------------------------------------------------------
+
+// Number of wheel levels, each level spans 64 times the previous one
+const ULONG TIMER_WHEEL_LEVELS = 5;
+
+// Number of slots per wheel level (bits of tick consumed per level)
+const ULONG TIMER_WHEEL_SLOT_BITS = 6;
+const ULONG TIMER_WHEEL_SLOTS = 1 << TIMER_WHEEL_SLOT_BITS;
+
+/*=========================================================================*/
+// Struct sTimerWheelLink
+//
+//    Doubly linked list link (wheel slots are circular lists headed by
+//    a bare link)
+/*=========================================================================*/
+struct sTimerWheelLink
+{
+   public:
+      // (Inline) Constructor (results in an empty list/unlinked entry)
+      sTimerWheelLink()
+         :  mpPrev( this ),
+            mpNext( this )
+      {
+         // Nothing to do
+      };
+
+      /* Previous/next links */
+      sTimerWheelLink * mpPrev;
+      sTimerWheelLink * mpNext;
+};
+
+/*=========================================================================*/
+// Struct sTimerWheelNode
+/*=========================================================================*/
+struct sTimerWheelNode : public sTimerWheelLink
+{
+   public:
+      // (Inline) Constructor
+      sTimerWheelNode()
+         :  sTimerWheelLink(),
+            mExpiry( 0 ),
+            mpWheel( 0 ),
+            mSlot( 0 )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Copy constructor (copies are never linked in a wheel)
+      sTimerWheelNode( const sTimerWheelNode & node )
+         :  sTimerWheelLink(),
+            mExpiry( node.mExpiry ),
+            mpWheel( 0 ),
+            mSlot( 0 )
+      {
+         // Nothing to do
+      };
+
+      // Destructor (removes the entry from any wheel it is linked in)
+      ~sTimerWheelNode();
+
+      // (Inline) Is this entry currently linked in a wheel?
+      bool IsScheduled() const
+      {
+         return (mpWheel != 0);
+      };
+
+      // (Inline) Return the absolute expiry tick
+      ULONGLONG GetExpiry() const
+      {
+         return mExpiry;
+      };
+
+   protected:
+      // Unsupported (would corrupt the wheel)
+      sTimerWheelNode & operator = ( const sTimerWheelNode & );
+
+      /* Absolute expiry tick */
+      ULONGLONG mExpiry;
+
+      /* Wheel this entry is linked in (0 when unlinked) */
+      cTimerWheel * mpWheel;
+
+      /* Index of the slot list this entry is linked in */
+      ULONG mSlot;
+
+      // The wheel gets full access
+      friend class cTimerWheel;
+};
+
+/*=========================================================================*/
+// Class cTimerWheel
+//
+//    Entries are placed on the first level whose span covers their
+//    distance from the current tick and cascade down a level each time
+//    the level below wraps.  Entries due in the same tick are moved to
+//    the expired list in one splice, oldest tick first.  Distances
+//    beyond the span of the top level are parked in its furthest slot
+//    and re-placed when that slot cascades.
+/*=========================================================================*/
+class cTimerWheel
+{
+   public:
+      // Constructor
+      cTimerWheel( ULONGLONG startTick );
+
+      // Destructor
+      ~cTimerWheel();
+
+      // Add (or move) an entry to expire at the given absolute tick
+      void Insert(
+         sTimerWheelNode &          node,
+         ULONGLONG                  expiry );
+
+      // Remove an entry (pending or expired)
+      void Remove( sTimerWheelNode & node );
+
+      // Advance the wheel, moving every entry due by the given tick
+      // to the expired list
+      void Advance( ULONGLONG now );
+
+      // Remove and return the oldest expired entry (0 if none)
+      sTimerWheelNode * PopExpired();
+
+      // Return the earliest tick at which the next Advance() will have
+      // something to do (a tick <= the current one when entries have
+      // already expired), false when the wheel is empty
+      bool GetNextExpiry( ULONGLONG & tick ) const;
+
+      // (Inline) Return the number of entries (pending and expired)
+      ULONG GetSize() const
+      {
+         return mCount;
+      };
+
+      // (Inline) Are there entries on the expired list?
+      bool HasExpired() const
+      {
+         return (mExpired.mpNext != &mExpired);
+      };
+
+      // (Inline) Return the number of entries on the expired list
+      ULONG GetExpiredCount() const
+      {
+         return mExpiredCount;
+      };
+
+   protected:
+      // Link an entry into the given slot list
+      void Link(
+         sTimerWheelNode &          node,
+         ULONG                      slot );
+
+      // Place an (unlinked) entry relative to the current tick
+      void Place( sTimerWheelNode & node );
+
+      // Re-place every entry of the given level's slot
+      void Cascade(
+         ULONG                      level,
+         ULONG                      idx );
+
+      // Return the earliest tick >= from with an expiry or cascade due
+      ULONGLONG NextTick( ULONGLONG from ) const;
+
+      /* Next tick to be processed */
+      ULONGLONG mTick;
+
+      /* Number of linked entries */
+      ULONG mCount;
+
+      /* Number of entries on the expired list */
+      ULONG mExpiredCount;
+
+      /* Slot lists, level major */
+      sTimerWheelLink mSlots[TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS];
+
+      /* Occupied slot bitmap of each level */
+      ULONGLONG mOccupied[TIMER_WHEEL_LEVELS];
+
+      /* Expired entries, oldest first */
+      sTimerWheelLink mExpired;
+
+   private:
+      // Unsupported (entries point back at the wheel)
+      cTimerWheel( const cTimerWheel & );
+      cTimerWheel & operator = ( const cTimerWheel & );
+};
@@ -43,6 +43,9 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "StdAfx.h"
 #include "GobiConnectionMgmt.h"
 #include "QMIBuffers.h"
+#include "QMIViewsNAS.h"
+#include "QMIViewsWDS.h"
+#include "QMIView.h"
 
 //---------------------------------------------------------------------------
 // Definitions
@@ -54,6 +57,141 @@ cGobiConnectionMgmtDLL gConnectionDLL;
 // Interval between traffic processing loop iterations (milliseconds)
 const ULONG TRAFFIC_INTERVAL_MS = 300000;
 
+// Size of the PDS event report parsed position data TLV value
+const ULONG PDS_PARSED_POSITION_SZ = 105;
+
+// Last OMA-DM session state that ends a session (0 = complete, info 
+// updated, 1 = complete, info unavailable, 2 = failed)
+const ULONG OMADM_SESSION_LAST_FINAL_STATE = 2;
+
+/*===========================================================================
+METHOD:
+   GetSignalBand (Free Method)
+
+DESCRIPTION:
+   Return the threshold band a signal strength is in, i.e. the number of 
+   thresholds at or below it, given the band it was in: it only rises past
+   a threshold once above it by the hysteresis, and only falls back below 
+   a threshold once that far under it
+
+PARAMETERS:
+   pThresholds    [ I ] - Thresholds (ascending)
+   thresholdCount [ I ] - Number of thresholds
+   hysteresis     [ I ] - Hysteresis (dB)
+   band           [ I ] - Band the signal strength was in
+   strength       [ I ] - Signal strength (dBm)
+
+RETURN VALUE:
+   ULONG - Band
+===========================================================================*/
+static ULONG GetSignalBand(
+   const INT8 *               pThresholds,
+   ULONG                      thresholdCount,
+   BYTE                       hysteresis,
+   ULONG                      band,
+   INT8                       strength )
+{
+   ULONG rise = 0;
+   ULONG fall = 0;
+   for (ULONG t = 0; t < thresholdCount; t++)
+   {
+      if ((INT)strength >= (INT)pThresholds[t] + (INT)hysteresis)
+      {
+         rise++;
+      }
+
+      if ((INT)strength >= (INT)pThresholds[t] - (INT)hysteresis)
+      {
+         fall++;
+      }
+   }
+
+   if (rise > band)
+   {
+      return rise;
+   }
+
+   if (fall < band)
+   {
+      return fall;
+   }
+
+   return band;
+}
+
+/*=========================================================================*/
+// Class cPDSEventReportView
+//
+//    View of the parsed position data of a PDS event report, the TLV is
+//    a fixed layout (not described by the generated views) that is read 
+//    directly from the indication by the position stream
+/*=========================================================================*/
+class cPDSEventReportView 
+   :  public cQMIMessageView <cPDSEventReportView, 1>
+{
+   public:
+      // Message ID
+      enum { MESSAGE_ID = 0x0001 };
+
+      // TLV type IDs
+      enum { TLV_PARSED_POSITION = 0x13 };
+
+      // Offsets of the parsed position fields
+      enum
+      {
+         OFFSET_VALID = 0,
+         OFFSET_YEAR = 4,
+         OFFSET_MONTH = 6,
+         OFFSET_DAY_OF_WEEK = 7,
+         OFFSET_DAY = 8,
+         OFFSET_HOUR = 9,
+         OFFSET_MINUTE = 10,
+         OFFSET_SECOND = 11,
+         OFFSET_MILLISECOND = 12,
+         OFFSET_LEAP_SECONDS = 14,
+         OFFSET_UTC_TIMESTAMP = 15,
+         OFFSET_TIME_UNCERTAINTY = 23,
+         OFFSET_LATITUDE = 27,
+         OFFSET_LONGITUDE = 35,
+         OFFSET_ELLIPSOID_ALTITUDE = 43,
+         OFFSET_MSL_ALTITUDE = 47,
+         OFFSET_HORIZONTAL_SPEED = 51,
+         OFFSET_VERTICAL_SPEED = 55,
+         OFFSET_HEADING = 59,
+         OFFSET_H_UNCERTAINTY_CIRCULAR = 63,
+         OFFSET_H_UNCERTAINTY_MAJOR = 67,
+         OFFSET_H_UNCERTAINTY_MINOR = 71,
+         OFFSET_H_UNCERTAINTY_AZIMUTH = 75,
+         OFFSET_V_UNCERTAINTY = 79,
+         OFFSET_H_VELOCITY_UNCERTAINTY = 83,
+         OFFSET_V_VELOCITY_UNCERTAINTY = 87,
+         OFFSET_H_CONFIDENCE = 91,
+         OFFSET_PDOP = 92,
+         OFFSET_HDOP = 96,
+         OFFSET_VDOP = 100,
+         OFFSET_OPERATING_MODE = 104
+      };
+
+      // (Inline) Constructor
+      cPDSEventReportView( const sProtocolBuffer & buf )
+         :  cQMIMessageView <cPDSEventReportView, 1>( buf )
+      {
+         // Nothing to do
+      };
+
+      // (Inline) Map a TLV type ID to its slot
+      static int GetSlot( BYTE typeID )
+      {
+         return (typeID == (BYTE)TLV_PARSED_POSITION ? 0 : -1);
+      };
+
+      // (Inline) Return the parsed position data
+      const sQMIView & GetParsedPosition() const
+      {
+         return mTLVs[0];
+      };
+};
+
 /*=========================================================================*/
 // Free Methods
 /*=========================================================================*/
@@ -64,7 +202,8 @@ METHOD:
    
 DESCRIPTION:
    QMI traffic process thread - processes all traffic in order to fire
-   off QMI traffic related callbacks
+   off QMI traffic related callbacks (the indications of interest are 
+   handed over to the parse pool, which does the parsing)
 
 PARAMETERS:
    pArg        [ I ] - Object to interface to
@@ -83,8 +222,8 @@ VOID * TrafficProcessThread( PVOID pArg )
    // Create a vector of the objects to wait on
    std::vector <cEvent *> events;
 
-   // Store the index to service type for use later
-   std::map <DWORD, eQMIService> services;
+   // Store the service type of each event (by index) for use later
+   std::vector <eQMIService> services;
 
    cGobiConnectionMgmt * pAPI = (cGobiConnectionMgmt *)pArg;
    if (pAPI != 0)
@@ -94,27 +233,19 @@ VOID * TrafficProcessThread( PVOID pArg )
 
       // Add the thread exit event
       events.push_back( &pAPI->mExitEvent );
+      services.push_back( eQMI_SVC_ENUM_BEGIN );
 
-      // For each Protocol server, grab the signal event
-      std::set <cGobiConnectionMgmt::tServerConfig>::const_iterator pIter;
-      pIter = pAPI->mServerConfig.begin();
-      while (pIter != pAPI->mServerConfig.end())
+      // For each Protocol server, grab the signal event of the log
+      ULONG svcCount = (ULONG)pAPI->mServiceIDs.size();
+      for (ULONG s = 0; s < svcCount; s++)
       {
-         eQMIService svc = pIter->first;
-         cQMIProtocolServer * pServer = pAPI->GetServer( svc );
-         if (pServer != 0)
+         eQMIService svc = pAPI->mServiceIDs[s];
+         sGobiQMIServiceEntry * pEntry = pAPI->GetServiceEntry( svc );
+         if (pEntry != 0)
          {
-            // Grab the log from the server
-            const cProtocolLog & log = pServer->GetLog();
-
-            // Grab the Signal event, if it exists
-            cEvent & sigEvent = log.GetSignalEvent();
-
-            services[events.size()] = svc;
-            events.push_back( &sigEvent );
+            services.push_back( svc );
+            events.push_back( pEntry->mpSignalEvent );
          }
-
-         pIter++;
       }
    }
 
@@ -146,10 +277,7 @@ VOID * TrafficProcessThread( PVOID pArg )
       else if (index < events.size())
       {
          // Run ProcessTraffic() for this service type
-         if (services.find( index ) != services.end())
-         {
-            pAPI->ProcessTraffic( services[index] );
-         }
+         pAPI->ProcessTraffic( services[index] );
       }
       else
       {
@@ -169,38 +297,159 @@ METHOD:
    CallbackThread (Free Method)
    
 DESCRIPTION:
-   Thread to execute a callback asynchronously
+   Callback pool thread, runs queued callbacks (one at a time per callback
+   type) until told to exit and the queues have been drained
 
 PARAMETERS:
-   pArg        [ I ] - The cAsyncFunction object
+   pArg        [ I ] - The cGobiCMCallbackPool object
 
 RETURN VALUE:
    void * - thread exit value (always 0)
 ===========================================================================*/
 void * CallbackThread( PVOID pArg )
 {
-   cGobiCMCallback * pCB = (cGobiCMCallback *)pArg;
-   if (pCB == 0)
+   cGobiCMCallbackPool * pPool = (cGobiCMCallbackPool *)pArg;
+   if (pPool == 0)
+   {
+      ASSERT( 0 );
+      return 0;
+   }
+
+   pthread_mutex_lock( &pPool->mSyncSection );
+
+   while (true)
+   {
+      if (pPool->mReady.size() == 0)
+      {
+         if (pPool->mbExiting == true)
+         {
+            break;
+         }
+
+         pthread_cond_wait( &pPool->mReadyCond, &pPool->mSyncSection );
+         continue;
+      }
+
+      eGobiCMCallbackType type = pPool->mReady.front();
+      pPool->mReady.pop_front();
+
+      cGobiCMCallbackPool::sTypeQueue & q = pPool->mQueues[type];
+      cGobiCMCallback * pCB = q.mPending.front();
+      q.mPending.pop_front();
+      q.mbReady = false;
+      q.mbRunning = true;
+      pPool->mStats.mDepth--;
+
+      // Run the callback without holding the lock
+      pthread_mutex_unlock( &pPool->mSyncSection );
+
+      pCB->Call();
+
+      delete pCB;
+      pCB = 0;
+
+      pthread_mutex_lock( &pPool->mSyncSection );
+
+      pPool->mStats.mCompleted++;
+      q.mbRunning = false;
+
+      // Next callback of this type is now free to run
+      if (q.mPending.size() > 0)
+      {
+         q.mbReady = true;
+         pPool->mReady.push_back( type );
+         pthread_cond_signal( &pPool->mReadyCond );
+      }
+   }
+
+   pthread_mutex_unlock( &pPool->mSyncSection );
+   return 0;
+}
+
+/*===========================================================================
+METHOD:
+   ParseThread (Free Method)
+   
+DESCRIPTION:
+   Parse pool thread, parses queued indications (one service at a time per
+   thread) until told to exit and the queues have been drained
+
+PARAMETERS:
+   pArg        [ I ] - The cGobiCMParsePool object
+
+RETURN VALUE:
+   void * - thread exit value (always 0)
+===========================================================================*/
+void * ParseThread( PVOID pArg )
+{
+   cGobiCMParsePool * pPool = (cGobiCMParsePool *)pArg;
+   if (pPool == 0 || pPool->mpAPI == 0)
    {
       ASSERT( 0 );
       return 0;
    }
 
-   pCB->Call();
+   pthread_mutex_lock( &pPool->mSyncSection );
+
+   while (true)
+   {
+      if (pPool->mReady.size() == 0)
+      {
+         if (pPool->mbExiting == true)
+         {
+            break;
+         }
+
+         pthread_cond_wait( &pPool->mReadyCond, &pPool->mSyncSection );
+         continue;
+      }
+
+      eQMIService svc = pPool->mReady.front();
+      pPool->mReady.pop_front();
+
+      // Take everything queued for the service in one go
+      cGobiCMParsePool::sServiceQueue & q = pPool->mQueues[svc];
+      std::deque <sProtocolBuffer> bufs;
+      bufs.swap( q.mPending );
+      q.mbReady = false;
+      q.mbRunning = true;
+
+      // Parse without holding the lock
+      pthread_mutex_unlock( &pPool->mSyncSection );
+
+      std::deque <sProtocolBuffer>::const_iterator pIter = bufs.begin();
+      while (pIter != bufs.end())
+      {
+         pPool->mpAPI->ParseIndication( svc, *pIter );
+         pIter++;
+      }
+
+      bufs.clear();
 
-   delete pCB;
-   pCB = 0;
+      pthread_mutex_lock( &pPool->mSyncSection );
+
+      q.mbRunning = false;
+
+      // Indications of this service that arrived meanwhile are next
+      if (q.mPending.size() > 0)
+      {
+         q.mbReady = true;
+         pPool->mReady.push_back( svc );
+         pthread_cond_signal( &pPool->mReadyCond );
+      }
+   }
 
+   pthread_mutex_unlock( &pPool->mSyncSection );
    return 0;
 }
 
 /*=========================================================================*/
-// cGobiConnectionMgmtDLL Methods
+// cGobiCMCallbackPool Methods
 /*=========================================================================*/
 
 /*===========================================================================
 METHOD:
-   cGobiConnectionMgmtDLL (Public Method)
+   cGobiCMCallbackPool (Public Method)
 
 DESCRIPTION:
    Constructor
@@ -208,17 +457,19 @@ DESCRIPTION:
 RETURN VALUE:
    None
 ===========================================================================*/
-cGobiConnectionMgmtDLL::cGobiConnectionMgmtDLL()
-   :  mpAPI( 0 ),
-      mbAllocated( false )
+cGobiCMCallbackPool::cGobiCMCallbackPool()
+   :  mReady(),
+      mThreadCount( 0 ),
+      mbExiting( false ),
+      mStats()
 {
-   // Create sync CS
    pthread_mutex_init( &mSyncSection, NULL );
+   pthread_cond_init( &mReadyCond, NULL );
 }
 
 /*===========================================================================
 METHOD:
-   ~cGobiConnectionMgmtDLL (Public Method)
+   ~cGobiCMCallbackPool (Public Method)
 
 DESCRIPTION:
    Destructor
@@ -226,550 +477,2464 @@ DESCRIPTION:
 RETURN VALUE:
    None
 ===========================================================================*/
-cGobiConnectionMgmtDLL::~cGobiConnectionMgmtDLL()
+cGobiCMCallbackPool::~cGobiCMCallbackPool()
 {
-   // Just in case
-   if (mpAPI != 0)
-   {
-      mpAPI->Cleanup();
-      delete mpAPI;
-      mpAPI = 0;
-   }
+   // This should have already been called, but ...
+   Exit();
 
+   pthread_cond_destroy( &mReadyCond );
    pthread_mutex_destroy( &mSyncSection );
 }
 
 /*===========================================================================
 METHOD:
-   GetAPI (Public Method)
+   Submit (Public Method)
 
 DESCRIPTION:
-   Return the cGobiConnectionMgmt object
+   Queue a callback to be run (and deleted) by a pool thread, a queued
+   callback of the same type that the new one supersedes is dropped
+
+PARAMETERS:
+   pCB         [ I ] - Callback (owned by the pool only upon success)
   
 RETURN VALUE:
-   cGobiConnectionMgmt *
-===========================================================================*/ 
-cGobiConnectionMgmt * cGobiConnectionMgmtDLL::GetAPI()
+   bool
+===========================================================================*/
+bool cGobiCMCallbackPool::Submit( cGobiCMCallback * pCB )
 {
+   if (pCB == 0)
+   {
+      return false;
+   }
+
+   eGobiCMCallbackType type = pCB->GetType();
+   if (type <= eGOBI_CM_CB_BEGIN || type >= eGOBI_CM_CB_END)
+   {
+      return false;
+   }
+
    pthread_mutex_lock( &mSyncSection );
 
-   bool bAlloc = mbAllocated;
+   if (mbExiting == true || StartThreads() == false)
+   {
+      pthread_mutex_unlock( &mSyncSection );
+      return false;
+   }
 
-   pthread_mutex_unlock( &mSyncSection );
+   sTypeQueue & q = mQueues[type];
+   mStats.mSubmitted++;
 
-   if (bAlloc == true)
+   // Drop the most recent queued callback made redundant by this one
+   std::deque <cGobiCMCallback *>::iterator pIter = q.mPending.end();
+   while (pIter != q.mPending.begin())
    {
-      return mpAPI;
+      pIter--;
+
+      if (pCB->Supersedes( **pIter ) == true)
+      {
+         delete *pIter;
+         q.mPending.erase( pIter );
+
+         mStats.mDepth--;
+         mStats.mCoalesced++;
+         break;
+      }
    }
 
-   pthread_mutex_lock( &mSyncSection );
+   q.mPending.push_back( pCB );
 
-   mpAPI = new cGobiConnectionMgmt();
-   if (mpAPI != 0)
+   mStats.mDepth++;
+   if (mStats.mDepth > mStats.mPeakDepth)
    {
-      mpAPI->Initialize();
+      mStats.mPeakDepth = mStats.mDepth;
    }
 
-   // We have tried to allocate the object
-   mbAllocated = true;
+   // Make the type ready (unless a callback of it is queued or running)
+   if (q.mbReady == false && q.mbRunning == false)
+   {
+      q.mbReady = true;
+      mReady.push_back( type );
+      pthread_cond_signal( &mReadyCond );
+   }
 
    pthread_mutex_unlock( &mSyncSection );
-   return mpAPI;
+   return true;
 }
 
-/*=========================================================================*/
-// cGobiConnectionMgmt Methods
-/*=========================================================================*/
-
 /*===========================================================================
 METHOD:
-   cGobiConnectionMgmt (Public Method)
+   Exit (Public Method)
 
 DESCRIPTION:
-   Constructor
+   Run the queued callbacks and then exit the pool threads (a pool thread
+   calling this only signals the others)
   
 RETURN VALUE:
-   None
+   bool
 ===========================================================================*/
-cGobiConnectionMgmt::cGobiConnectionMgmt()
-   :  cGobiQMICore(),
-      mbThreadStarted( false ),
-      mThreadID( 0 ),
-      mWDSItemsProcessed( 0 ),
-      mDMSItemsProcessed( 0 ),
-      mNASItemsProcessed( 0 ),
-      mWMSItemsProcessed( 0 ),
-      mPDSItemsProcessed( 0 ),
-      mCATItemsProcessed( 0 ),
-      mOMAItemsProcessed( 0 ),
-      mVoiceItemsProcessed( 0 ),
-      mpFNSessionState( 0 ),
-      mpFNByteTotals( 0 ),
-      mpFNDataCapabilities( 0 ),
-      mpFNDataBearer( 0 ),
-      mpFNDormancyStatus( 0 ),
-      mpFNMobileIPStatus( 0 ),
-      mpFNActivationStatus( 0 ),
-      mpFNPower( 0 ),
-      mpFNWirelessDisable( 0 ),
-      mpFNRoamingIndicator( 0 ),
-      mpFNSignalStrength( 0 ),
-      mpFNRFInfo( 0 ),
-      mpFNLUReject( 0 ),
-      mpPLMNMode( 0 ),
-      mpFNNewSMS( 0 ),
-      mpFNNewNMEA( 0 ),
-      mpFNPDSState( 0 ),
-      mpFNCATEvent( 0 ),
-      mpFNOMADMAlert( 0 ),
-      mpFNOMADMState( 0 ),
-      mpFNUSSDRelease( 0 ),
-      mpFNUSSDNotification( 0 ),
-      mpFNUSSDOrigination( 0 )
+bool cGobiCMCallbackPool::Exit()
 {
-   tServerConfig wdsSvr( eQMI_SVC_WDS, true );
-   tServerConfig dmsSvr( eQMI_SVC_DMS, true );
-   tServerConfig nasSvr( eQMI_SVC_NAS, true );
-   tServerConfig wmsSvr( eQMI_SVC_WMS, true );
-   tServerConfig pdsSvr( eQMI_SVC_PDS, true );
-   tServerConfig catSvr( eQMI_SVC_CAT, false );
-   tServerConfig rmsSvr( eQMI_SVC_RMS, false );
-   tServerConfig omaSvr( eQMI_SVC_OMA, false );
-   tServerConfig voiceSvr( eQMI_SVC_VOICE, false );
-   mServerConfig.insert( wdsSvr );
-   mServerConfig.insert( dmsSvr );
-   mServerConfig.insert( nasSvr );
-   mServerConfig.insert( wmsSvr );
-   mServerConfig.insert( pdsSvr );
-   mServerConfig.insert( catSvr );
-   mServerConfig.insert( rmsSvr );
-   mServerConfig.insert( omaSvr );
-   mServerConfig.insert( voiceSvr );
+   pthread_mutex_lock( &mSyncSection );
+
+   mbExiting = true;
+   pthread_cond_broadcast( &mReadyCond );
+
+   ULONG threadCount = mThreadCount;
+   mThreadCount = 0;
+
+   pthread_mutex_unlock( &mSyncSection );
+
+   bool bSelf = false;
+   pthread_t self = pthread_self();
+   for (ULONG t = 0; t < threadCount; t++)
+   {
+      if (pthread_equal( mThreadIDs[t], self ) != 0)
+      {
+         // Can't wait on ourselves
+         pthread_detach( self );
+         bSelf = true;
+      }
+      else
+      {
+         pthread_join( mThreadIDs[t], NULL );
+      }
+   }
+
+   // Allow the pool to be restarted (unless this thread has to exit)
+   if (bSelf == false)
+   {
+      pthread_mutex_lock( &mSyncSection );
+      mbExiting = false;
+      pthread_mutex_unlock( &mSyncSection );
+   }
+
+   return bSelf == false;
 }
 
 /*===========================================================================
 METHOD:
-   ~cGobiConnectionMgmt (Public Method)
+   GetStats (Public Method)
 
 DESCRIPTION:
-   Destructor
+   Return the queue metrics
   
 RETURN VALUE:
-   None
+   sGobiCMCallbackStats
 ===========================================================================*/
-cGobiConnectionMgmt::~cGobiConnectionMgmt()
+sGobiCMCallbackStats cGobiCMCallbackPool::GetStats()
 {
-   Disconnect();
+   pthread_mutex_lock( &mSyncSection );
+
+   sGobiCMCallbackStats stats = mStats;
+
+   pthread_mutex_unlock( &mSyncSection );
+   return stats;
 }
 
 /*===========================================================================
 METHOD:
-   ProcessTraffic (Internal Method)
+   SetThreadConfig (Public Method)
 
 DESCRIPTION:
-   Process traffic in a QMI server protocol log, this is done to
-   exercise QMI indication related callbacks
+   Set the thread configuration pool threads are started with (as 
+   eTHREAD_ROLE_TRAFFIC threads), running pool threads are unaffected
 
 PARAMETERS:
-   svc         [ I ] - QMI Service type
-
+   config      [ I ] - Thread configuration
+  
 RETURN VALUE:
    None
 ===========================================================================*/
-void cGobiConnectionMgmt::ProcessTraffic( eQMIService svc )
+void cGobiCMCallbackPool::SetThreadConfig( const cThreadConfig & config )
 {
-   ULONG count = 0;
+   pthread_mutex_lock( &mSyncSection );
+   mThreadConfig = config;
+   pthread_mutex_unlock( &mSyncSection );
+}
+
+/*===========================================================================
+METHOD:
+   StartThreads (Internal Method)
+
+DESCRIPTION:
+   Start the pool threads (if not already running)
 
-   switch (svc)
+SEQUENCING:
+   mSyncSection must be held
+  
+RETURN VALUE:
+   bool - true if at least one pool thread is running
+===========================================================================*/
+bool cGobiCMCallbackPool::StartThreads()
+{
+   while (mThreadCount < CALLBACK_POOL_THREADS)
    {
-      case eQMI_SVC_WDS:
+      int nRC = mThreadConfig.CreateThread( eTHREAD_ROLE_TRAFFIC,
+                                            &mThreadIDs[mThreadCount],
+                                            CallbackThread,
+                                            this );
+
+      if (nRC != 0)
       {
-         cQMIProtocolServer * pWDS = GetServer( eQMI_SVC_WDS );
-         if (pWDS != 0)
-         {
-            // Grab the WDS log from the server
-            const cProtocolLog & logWDS = pWDS->GetLog();
+         TRACE( "Unable to start CallbackThread. Error %d: %s\n",
+                nRC,
+                strerror( nRC ) );
+         break;
+      }
 
-            // New WDS items to process?
-            count = logWDS.GetCount();
-            if (count != INVALID_LOG_INDEX && count > mWDSItemsProcessed)
-            {
-               for (ULONG i = mWDSItemsProcessed; i < count; i++)
-               {
-                  sProtocolBuffer buf = logWDS.GetBuffer( i );
-                  if ( (buf.IsValid() == true) 
-                  &&   (buf.GetType() == (ULONG)ePROTOCOL_QMI_WDS_RX) )
-                  {
-                     ProcessWDSBuffer( buf );
-                  }
-               }
+      mThreadCount++;
+   }
 
-               mWDSItemsProcessed = count;
-            }
-         }
+   return (mThreadCount > 0);
+}
 
-         break;
-      }
+/*=========================================================================*/
+// cGobiCMParsePool Methods
+/*=========================================================================*/
 
-      case eQMI_SVC_DMS:
-      {
-         cQMIProtocolServer * pDMS = GetServer( eQMI_SVC_DMS );
-         if (pDMS != 0)
-         {
-            // Grab the DMS log from the server
-            const cProtocolLog & logDMS = pDMS->GetLog();
+/*===========================================================================
+METHOD:
+   cGobiCMParsePool (Public Method)
 
-            // New DMS items to process?
-            count = logDMS.GetCount();
-            if (count != INVALID_LOG_INDEX && count > mDMSItemsProcessed)
-            {
-               for (ULONG i = mDMSItemsProcessed; i < count; i++)
-               {
-                  sProtocolBuffer buf = logDMS.GetBuffer( i );
-                  if ( (buf.IsValid() == true) 
-                  &&   (buf.GetType() == (ULONG)ePROTOCOL_QMI_DMS_RX) )
-                  {
-                     ProcessDMSBuffer( buf );
-                  }
-               }
+DESCRIPTION:
+   Constructor
 
-               mDMSItemsProcessed = count;
-            }
-         }
+PARAMETERS:
+   pAPI        [ I ] - Object the indications are parsed by
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+cGobiCMParsePool::cGobiCMParsePool( cGobiConnectionMgmt * pAPI )
+   :  mpAPI( pAPI ),
+      mQueues(),
+      mReady(),
+      mThreadCount( 0 ),
+      mbExiting( false )
+{
+   pthread_mutex_init( &mSyncSection, NULL );
+   pthread_cond_init( &mReadyCond, NULL );
+}
 
-         break;
-      }
+/*===========================================================================
+METHOD:
+   ~cGobiCMParsePool (Public Method)
 
-      case eQMI_SVC_NAS:
-      {
-         cQMIProtocolServer * pNAS = GetServer( eQMI_SVC_NAS );
-         if (pNAS != 0)
-         {
-            // Grab the NAS log from the server
-            const cProtocolLog & logNAS = pNAS->GetLog();
+DESCRIPTION:
+   Destructor
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+cGobiCMParsePool::~cGobiCMParsePool()
+{
+   // This should have already been called, but ...
+   Exit();
 
-            // New NAS items to process?
-            count = logNAS.GetCount();
-            if (count != INVALID_LOG_INDEX && count > mNASItemsProcessed)
-            {
-               for (ULONG i = mNASItemsProcessed; i < count; i++)
-               {
-                  sProtocolBuffer buf = logNAS.GetBuffer( i );
-                  if ( (buf.IsValid() == true) 
-                  &&   (buf.GetType() == (ULONG)ePROTOCOL_QMI_NAS_RX) )
-                  {
-                     ProcessNASBuffer( buf );
-                  }
-               }
+   pthread_cond_destroy( &mReadyCond );
+   pthread_mutex_destroy( &mSyncSection );
+}
 
-               mNASItemsProcessed = count;
-            }
-         }
+/*===========================================================================
+METHOD:
+   Submit (Public Method)
 
-         break;
-      }
+DESCRIPTION:
+   Queue indications of a service to be parsed by a pool thread, after 
+   any indications of the service already queued
 
-      case eQMI_SVC_WMS:
-      {
-         cQMIProtocolServer * pWMS = GetServer( eQMI_SVC_WMS );
-         if (pWMS != 0)
-         {
-            // Grab the WMS log from the server
-            const cProtocolLog & logWMS = pWMS->GetLog();
+PARAMETERS:
+   svc         [ I ] - QMI Service type
+   bufs        [ I ] - Indications, oldest first
+  
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cGobiCMParsePool::Submit(
+   eQMIService                         svc,
+   const std::vector <sProtocolBuffer> & bufs )
+{
+   if (bufs.size() == 0)
+   {
+      return true;
+   }
 
-            // New WMS items to process?
-            count = logWMS.GetCount();
-            if (count != INVALID_LOG_INDEX && count > mWMSItemsProcessed)
-            {
-               for (ULONG i = mWMSItemsProcessed; i < count; i++)
-               {
-                  sProtocolBuffer buf = logWMS.GetBuffer( i );
-                  if ( (buf.IsValid() == true) 
-                  &&   (buf.GetType() == (ULONG)ePROTOCOL_QMI_WMS_RX) )
-                  {
-                     ProcessWMSBuffer( buf );
-                  }
-               }
+   pthread_mutex_lock( &mSyncSection );
 
-               mWMSItemsProcessed = count;
-            }
-         }
+   if (mbExiting == true || StartThreads() == false)
+   {
+      pthread_mutex_unlock( &mSyncSection );
+      return false;
+   }
 
-         break;
-      }
+   sServiceQueue & q = mQueues[svc];
+   q.mPending.insert( q.mPending.end(), bufs.begin(), bufs.end() );
 
-      case eQMI_SVC_PDS:
-      {
-         cQMIProtocolServer * pPDS = GetServer( eQMI_SVC_PDS );
-         if (pPDS != 0)
-         {
-            // Grab the PDS log from the server
-            const cProtocolLog & logPDS = pPDS->GetLog();
+   // Make the service ready (unless it is queued or being parsed)
+   if (q.mbReady == false && q.mbRunning == false)
+   {
+      q.mbReady = true;
+      mReady.push_back( svc );
+      pthread_cond_signal( &mReadyCond );
+   }
 
-            // New PDS items to process?
-            count = logPDS.GetCount();
-            if (count != INVALID_LOG_INDEX && count > mPDSItemsProcessed)
-            {
-               for (ULONG i = mPDSItemsProcessed; i < count; i++)
-               {
-                  sProtocolBuffer buf = logPDS.GetBuffer( i );
-                  if ( (buf.IsValid() == true) 
-                  &&   (buf.GetType() == (ULONG)ePROTOCOL_QMI_PDS_RX) )
-                  {
-                     ProcessPDSBuffer( buf );
-                  }
-               }
+   pthread_mutex_unlock( &mSyncSection );
+   return true;
+}
 
-               mPDSItemsProcessed = count;
-            }
-         }
+/*===========================================================================
+METHOD:
+   Exit (Public Method)
 
-         break;
-      }
+DESCRIPTION:
+   Parse the queued indications and then exit the pool threads (a pool 
+   thread calling this only signals the others)
+  
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cGobiCMParsePool::Exit()
+{
+   pthread_mutex_lock( &mSyncSection );
 
-      case eQMI_SVC_CAT:
-      {
-         cQMIProtocolServer * pCAT = GetServer( eQMI_SVC_CAT );
-         if (pCAT != 0)
-         {
-            // Grab the CAT log from the server
-            const cProtocolLog & logCAT = pCAT->GetLog();
+   mbExiting = true;
+   pthread_cond_broadcast( &mReadyCond );
 
-            // New CAT items to process?
-            count = logCAT.GetCount();
-            if (count != INVALID_LOG_INDEX && count > mCATItemsProcessed)
-            {
-               for (ULONG i = mCATItemsProcessed; i < count; i++)
-               {
-                  sProtocolBuffer buf = logCAT.GetBuffer( i );
-                  if ( (buf.IsValid() == true) 
-                  &&   (buf.GetType() == (ULONG)ePROTOCOL_QMI_CAT_RX) )
-                  {
-                     ProcessCATBuffer( buf );
-                  }
-               }
+   ULONG threadCount = mThreadCount;
+   mThreadCount = 0;
 
-               mCATItemsProcessed = count;
-            }
-         }
+   pthread_mutex_unlock( &mSyncSection );
 
-         break;
+   bool bSelf = false;
+   pthread_t self = pthread_self();
+   for (ULONG t = 0; t < threadCount; t++)
+   {
+      if (pthread_equal( mThreadIDs[t], self ) != 0)
+      {
+         // Can't wait on ourselves
+         pthread_detach( self );
+         bSelf = true;
       }
-
-      case eQMI_SVC_OMA:
+      else
       {
-         cQMIProtocolServer * pOMA = GetServer( eQMI_SVC_OMA );
-         if (pOMA != 0)
-         {
-            // Grab the OMA log from the server
-            const cProtocolLog & logOMA = pOMA->GetLog();
+         pthread_join( mThreadIDs[t], NULL );
+      }
+   }
 
-            // New OMA items to process?
-            count = logOMA.GetCount();
-            if (count != INVALID_LOG_INDEX && count > mOMAItemsProcessed)
-            {
-               for (ULONG i = mOMAItemsProcessed; i < count; i++)
-               {
-                  sProtocolBuffer buf = logOMA.GetBuffer( i );
-                  if ( (buf.IsValid() == true) 
-                  &&   (buf.GetType() == (ULONG)ePROTOCOL_QMI_OMA_RX) )
-                  {
-                     ProcessOMABuffer( buf );
-                  }
-               }
+   // Allow the pool to be restarted (unless this thread has to exit)
+   if (bSelf == false)
+   {
+      pthread_mutex_lock( &mSyncSection );
+      mbExiting = false;
+      pthread_mutex_unlock( &mSyncSection );
+   }
 
-               mOMAItemsProcessed = count;
-            }
-         }
+   return bSelf == false;
+}
 
-         break;
-      }
+/*===========================================================================
+METHOD:
+   SetThreadConfig (Public Method)
 
-      case eQMI_SVC_VOICE:
-      {
-         cQMIProtocolServer * pVoice = GetServer( eQMI_SVC_VOICE );
-         if (pVoice != 0)
-         {
-            // Grab the voice log from the server
-            const cProtocolLog & logVoice = pVoice->GetLog();
+DESCRIPTION:
+   Set the thread configuration pool threads are started with (as 
+   eTHREAD_ROLE_TRAFFIC threads), running pool threads are unaffected
 
-            // New voice items to process?
-            count = logVoice.GetCount();
-            if (count != INVALID_LOG_INDEX && count > mVoiceItemsProcessed)
-            {
-               for (ULONG i = mVoiceItemsProcessed; i < count; i++)
-               {
-                  sProtocolBuffer buf = logVoice.GetBuffer( i );
-                  if ( (buf.IsValid() == true) 
-                  &&   (buf.GetType() == (ULONG)ePROTOCOL_QMI_VOICE_RX) )
-                  {
-                     ProcessVoiceBuffer( buf );
-                  }
-               }
+PARAMETERS:
+   config      [ I ] - Thread configuration
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiCMParsePool::SetThreadConfig( const cThreadConfig & config )
+{
+   pthread_mutex_lock( &mSyncSection );
+   mThreadConfig = config;
+   pthread_mutex_unlock( &mSyncSection );
+}
 
-               mVoiceItemsProcessed = count;
-            }
-         }
+/*===========================================================================
+METHOD:
+   StartThreads (Internal Method)
+
+DESCRIPTION:
+   Start the pool threads (if not already running)
+
+SEQUENCING:
+   mSyncSection must be held
+  
+RETURN VALUE:
+   bool - true if at least one pool thread is running
+===========================================================================*/
+bool cGobiCMParsePool::StartThreads()
+{
+   while (mThreadCount < PARSE_POOL_THREADS)
+   {
+      int nRC = mThreadConfig.CreateThread( eTHREAD_ROLE_TRAFFIC,
+                                            &mThreadIDs[mThreadCount],
+                                            ParseThread,
+                                            this );
 
+      if (nRC != 0)
+      {
+         TRACE( "Unable to start ParseThread. Error %d: %s\n",
+                nRC,
+                strerror( nRC ) );
          break;
       }
 
-      default:
-         break;
+      mThreadCount++;
    }
+
+   return (mThreadCount > 0);
 }
 
+/*=========================================================================*/
+// cGobiCMReconnector Methods
+/*=========================================================================*/
+
 /*===========================================================================
 METHOD:
-   ProcessWDSBuffer (Internal Method)
+   DeviceAdded (Public Method)
 
 DESCRIPTION:
-   Process a WDS buffer
+   A device has been added (or its key has changed), run on the device
+   manager's monitor thread
 
 PARAMETERS:
-   buf         [ I ] - QMI buffer to process
-
+   device      [ I ] - The device (node and key)
+  
 RETURN VALUE:
    None
 ===========================================================================*/
-void cGobiConnectionMgmt::ProcessWDSBuffer( const sProtocolBuffer & buf )
+void cGobiCMReconnector::DeviceAdded( const cGobiQMICore::tDeviceID & device )
 {
-   sQMIServiceBuffer qmiBuf( buf.GetSharedBuffer() );   
-   if (qmiBuf.IsValid() == false)
-   {
-      return;
-   }
+   mpAPI->DeviceReturned( device );
+}
 
-   // Indication?
-   if (qmiBuf.IsIndication() == false)
-   {
-      return;
-   } 
+/*===========================================================================
+METHOD:
+   DeviceRemoved (Public Method)
 
-   // Do we even care?
-   ULONG msgID = qmiBuf.GetMessageID();
-   if (msgID == eQMI_WDS_EVENT_IND)
-   {
-      // Prepare TLVs for parsing
-      std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiBuf );
+DESCRIPTION:
+   A device has been removed, run on the device manager's monitor thread
 
-      // Parse out data bearer technology
-      sProtocolEntityKey tlvKey( eDB2_ET_QMI_WDS_IND, msgID, 23 );
-      cDataParser::tParsedFields pf = ParseTLV( mDB, buf, tlvs, tlvKey );
-      if (pf.size() >= 1)
-      {
-         if (mpFNDataBearer != 0)
-         {
-            cDataBearerCallback * pCB = 0;
-            pCB = new cDataBearerCallback( mpFNDataBearer, pf[0].mValue.mU32 );
-            if (pCB != 0)
-            {
-               if (pCB->Initialize() == false)
-               {
-                  delete pCB;
-               }
-            }
-         }
-      }
+PARAMETERS:
+   device      [ I ] - The device (node and key)
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiCMReconnector::DeviceRemoved( const cGobiQMICore::tDeviceID & device )
+{
+   mpAPI->DeviceDeparted( device );
+}
 
-      // Parse out dormancy status
-      tlvKey = sProtocolEntityKey( eDB2_ET_QMI_WDS_IND, msgID, 24 );
-      pf = ParseTLV( mDB, buf, tlvs, tlvKey );
-      if (pf.size() >= 1)
-      {
-         if (mpFNDormancyStatus != 0)
-         {
-            cDormancyStatusCallback * pCB = 0;
-            pCB = new cDormancyStatusCallback( mpFNDormancyStatus, 
-                                               pf[0].mValue.mU32 );
+/*=========================================================================*/
+// cGobiConnectionMgmtDLL Methods
+/*=========================================================================*/
 
-            if (pCB != 0)
-            {
-               if (pCB->Initialize() == false)
-               {
-                  delete pCB;
-               }
-            }
-         }
-      }
+/*===========================================================================
+METHOD:
+   cGobiConnectionMgmtDLL (Public Method)
 
-      // Parse out byte totals
-      tlvKey = sProtocolEntityKey( eDB2_ET_QMI_WDS_IND, msgID, 25 );
-      pf = ParseTLV( mDB, buf, tlvs, tlvKey );
-      if (pf.size() >= 1)
-      {
-         ULONGLONG tx = pf[0].mValue.mU64;
-         ULONGLONG rx = ULLONG_MAX;
+DESCRIPTION:
+   Constructor
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+cGobiConnectionMgmtDLL::cGobiConnectionMgmtDLL()
+   :  mpAPI( 0 ),
+      mbAllocated( false )
+{
+   // Create sync CS
+   pthread_mutex_init( &mSyncSection, NULL );
+}
 
-         tlvKey = sProtocolEntityKey( eDB2_ET_QMI_WDS_IND, msgID, 26 );
-         pf = ParseTLV( mDB, buf, tlvs, tlvKey );
-         if (pf.size() >= 1)
-         {
-            rx = pf[0].mValue.mU64;
-         }        
+/*===========================================================================
+METHOD:
+   ~cGobiConnectionMgmtDLL (Public Method)
 
-         if (mpFNByteTotals != 0)
-         {
-            cByteTotalsCallback * pCB = 0;
-            pCB = new cByteTotalsCallback( mpFNByteTotals, tx, rx ); 
-            if (pCB != 0)
-            {
-               if (pCB->Initialize() == false)
+DESCRIPTION:
+   Destructor
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+cGobiConnectionMgmtDLL::~cGobiConnectionMgmtDLL()
+{
+   // Just in case
+   if (mpAPI != 0)
+   {
+      mpAPI->Cleanup();
+      delete mpAPI;
+      mpAPI = 0;
+   }
+
+   pthread_mutex_destroy( &mSyncSection );
+}
+
+/*===========================================================================
+METHOD:
+   GetAPI (Public Method)
+
+DESCRIPTION:
+   Return the cGobiConnectionMgmt object
+  
+RETURN VALUE:
+   cGobiConnectionMgmt *
+===========================================================================*/ 
+cGobiConnectionMgmt * cGobiConnectionMgmtDLL::GetAPI()
+{
+   pthread_mutex_lock( &mSyncSection );
+
+   bool bAlloc = mbAllocated;
+
+   pthread_mutex_unlock( &mSyncSection );
+
+   if (bAlloc == true)
+   {
+      return mpAPI;
+   }
+
+   pthread_mutex_lock( &mSyncSection );
+
+   mpAPI = new cGobiConnectionMgmt();
+   if (mpAPI != 0)
+   {
+      mpAPI->Initialize();
+   }
+
+   // We have tried to allocate the object
+   mbAllocated = true;
+
+   pthread_mutex_unlock( &mSyncSection );
+   return mpAPI;
+}
+
+/*=========================================================================*/
+// cGobiConnectionMgmt Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   cGobiConnectionMgmt (Public Method)
+
+DESCRIPTION:
+   Constructor
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+cGobiConnectionMgmt::cGobiConnectionMgmt()
+   :  cGobiQMICore(),
+      mbThreadStarted( false ),
+      mThreadID( 0 ),
+      mIndications(),
+      mpFNSessionState( 0 ),
+      mpFNByteTotals( 0 ),
+      mpFNDataCapabilities( 0 ),
+      mpFNDataBearer( 0 ),
+      mpFNDormancyStatus( 0 ),
+      mpFNMobileIPStatus( 0 ),
+      mpFNActivationStatus( 0 ),
+      mpFNPower( 0 ),
+      mpFNWirelessDisable( 0 ),
+      mpFNRoamingIndicator( 0 ),
+      mpFNSignalStrength( 0 ),
+      mpFNRFInfo( 0 ),
+      mpFNLUReject( 0 ),
+      mpPLMNMode( 0 ),
+      mpFNNewSMS( 0 ),
+      mpFNNewNMEA( 0 ),
+      mpFNPDSState( 0 ),
+      mpFNCATEvent( 0 ),
+      mpFNOMADMAlert( 0 ),
+      mpFNOMADMState( 0 ),
+      mpFNUSSDRelease( 0 ),
+      mpFNUSSDNotification( 0 ),
+      mpFNUSSDOrigination( 0 ),
+      mpPositionRing( 0 ),
+      mbPositionStream( false ),
+      mPositionSequence( 0 ),
+      mPositionWaiting( 0 ),
+      mByteTotalsInterval( 0 ),
+      mSessionStatsInterval( 0 ),
+      mSessionStatsStart( 0 ),
+      mSessionStatsSequence( 0 ),
+      mSessionStats(),
+      mbSignalMonitor( false ),
+      mMonitorThresholdCount( 0 ),
+      mMonitorHysteresis( 0 ),
+      mpFNSignalMonitor( 0 ),
+      mSignalThresholds(),
+      mSignalStateSequence( 0 ),
+      mSignalState(),
+      mbOMADMTracker( false ),
+      mOMADMSession(),
+      mParsePool( this ),
+      mbAutoReconnect( false ),
+      mReconnector( this ),
+      mLostDevice(),
+      mRegistrations()
+{
+   pthread_mutex_init( &mConnectMutex, NULL );
+   pthread_mutex_init( &mRegistrationsMutex, NULL );
+
+   memset( (LPVOID)&mMonitorThresholds[0], 0, sizeof( mMonitorThresholds ) );
+   pthread_mutex_init( &mSignalStateMutex, NULL );
+
+   // Position report waits are timed against the monotonic clock
+   pthread_condattr_t attr;
+   pthread_condattr_init( &attr );
+   pthread_condattr_setclock( &attr, CLOCK_MONOTONIC );
+   pthread_cond_init( &mPositionCond, &attr );
+   pthread_cond_init( &mOMADMCond, &attr );
+   pthread_condattr_destroy( &attr );
+
+   pthread_mutex_init( &mPositionMutex, NULL );
+   pthread_mutex_init( &mOMADMMutex, NULL );
+
+   tServerConfig wdsSvr( eQMI_SVC_WDS, true );
+   tServerConfig dmsSvr( eQMI_SVC_DMS, true );
+   tServerConfig nasSvr( eQMI_SVC_NAS, true );
+   tServerConfig wmsSvr( eQMI_SVC_WMS, true );
+   tServerConfig pdsSvr( eQMI_SVC_PDS, true );
+   tServerConfig catSvr( eQMI_SVC_CAT, false );
+   tServerConfig rmsSvr( eQMI_SVC_RMS, false );
+   tServerConfig omaSvr( eQMI_SVC_OMA, false );
+   tServerConfig voiceSvr( eQMI_SVC_VOICE, false );
+   mServerConfig.insert( wdsSvr );
+   mServerConfig.insert( dmsSvr );
+   mServerConfig.insert( nasSvr );
+   mServerConfig.insert( wmsSvr );
+   mServerConfig.insert( pdsSvr );
+   mServerConfig.insert( catSvr );
+   mServerConfig.insert( rmsSvr );
+   mServerConfig.insert( omaSvr );
+   mServerConfig.insert( voiceSvr );
+
+   // Indications of each service with callbacks are dispatched to the 
+   // service's buffer processing method
+   mIndications[eQMI_SVC_WDS] = 
+      sIndicationTable( ePROTOCOL_QMI_WDS_RX, 
+                        &cGobiConnectionMgmt::ProcessWDSBuffer );
+
+   mIndications[eQMI_SVC_DMS] = 
+      sIndicationTable( ePROTOCOL_QMI_DMS_RX, 
+                        &cGobiConnectionMgmt::ProcessDMSBuffer );
+
+   mIndications[eQMI_SVC_NAS] = 
+      sIndicationTable( ePROTOCOL_QMI_NAS_RX, 
+                        &cGobiConnectionMgmt::ProcessNASBuffer );
+
+   mIndications[eQMI_SVC_WMS] = 
+      sIndicationTable( ePROTOCOL_QMI_WMS_RX, 
+                        &cGobiConnectionMgmt::ProcessWMSBuffer );
+
+   mIndications[eQMI_SVC_PDS] = 
+      sIndicationTable( ePROTOCOL_QMI_PDS_RX, 
+                        &cGobiConnectionMgmt::ProcessPDSBuffer );
+
+   mIndications[eQMI_SVC_CAT] = 
+      sIndicationTable( ePROTOCOL_QMI_CAT_RX, 
+                        &cGobiConnectionMgmt::ProcessCATBuffer );
+
+   mIndications[eQMI_SVC_OMA] = 
+      sIndicationTable( ePROTOCOL_QMI_OMA_RX, 
+                        &cGobiConnectionMgmt::ProcessOMABuffer );
+
+   mIndications[eQMI_SVC_VOICE] = 
+      sIndicationTable( ePROTOCOL_QMI_VOICE_RX, 
+                        &cGobiConnectionMgmt::ProcessVoiceBuffer );
+}
+
+/*===========================================================================
+METHOD:
+   ~cGobiConnectionMgmt (Public Method)
+
+DESCRIPTION:
+   Destructor
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+cGobiConnectionMgmt::~cGobiConnectionMgmt()
+{
+   // No more reconnecting
+   SetAutoReconnect( false );
+
+   Disconnect();
+
+   // Run any callbacks still queued
+   mCallbackPool.Exit();
+
+   // The parse pool threads are gone, so is the ring's producer
+   if (mpPositionRing != 0)
+   {
+      delete mpPositionRing;
+      mpPositionRing = 0;
+   }
+
+   pthread_cond_destroy( &mPositionCond );
+   pthread_mutex_destroy( &mPositionMutex );
+   pthread_mutex_destroy( &mSignalStateMutex );
+   pthread_cond_destroy( &mOMADMCond );
+   pthread_mutex_destroy( &mOMADMMutex );
+   pthread_mutex_destroy( &mRegistrationsMutex );
+   pthread_mutex_destroy( &mConnectMutex );
+}
+
+/*===========================================================================
+METHOD:
+   ProcessTraffic (Internal Method)
+
+DESCRIPTION:
+   Process traffic in a QMI server protocol log, this is done to
+   exercise QMI indication related callbacks (only indications enabled 
+   in the service's dispatch table are looked at beyond their header)
+
+PARAMETERS:
+   svc         [ I ] - QMI Service type
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiConnectionMgmt::ProcessTraffic( eQMIService svc )
+{
+   std::map <eQMIService, sIndicationTable>::iterator pTable;
+   pTable = mIndications.find( svc );
+   if (pTable == mIndications.end())
+   {
+      return;
+   }
+
+   sIndicationTable & table = pTable->second;
+
+   sGobiQMIServiceEntry * pEntry = GetServiceEntry( svc );
+   if (pEntry == 0)
+   {
+      return;
+   }
+
+   // Grab the log from the server
+   const cProtocolLog & log = *pEntry->mpLog;
+
+   // New items to process? (an on-demand server that was taken down 
+   // starts over with an empty log)
+   ULONG count = log.GetCount();
+   if (count != INVALID_LOG_INDEX && count < table.mItemsProcessed)
+   {
+      table.mItemsProcessed = 0;
+   }
+
+   if (count == INVALID_LOG_INDEX || count <= table.mItemsProcessed)
+   {
+      return;
+   }
+
+   // Nothing to dispatch for an idle service
+   std::vector <sProtocolBuffer> bufs;
+   if (table.mEnabledCount > 0)
+   {
+      for (ULONG i = table.mItemsProcessed; i < count; i++)
+      {
+         sProtocolBuffer buf = log.GetBuffer( i );
+         if ( (buf.IsValid() == false) 
+         ||   (buf.GetType() != table.mRxType) )
+         {
+            continue;
+         }
+
+         ULONG msgID = ULONG_MAX;
+         bool bInd = sQMIServiceBuffer::GetIndicationID( buf, msgID );
+         if ( (bInd == true) 
+         &&   (msgID <= MAX_INDICATION_ID)
+         &&   (table.mEnabled[msgID] == true) )
+         {
+            bufs.push_back( buf );
+         }
+      }
+   }
+
+   table.mItemsProcessed = count;
+
+   // The parsing itself is done by the parse pool (or right here should
+   // the pool be unable to start)
+   if (mParsePool.Submit( svc, bufs ) == false)
+   {
+      for (ULONG b = 0; b < (ULONG)bufs.size(); b++)
+      {
+         (this->*table.mpHandler)( bufs[b] );
+      }
+   }
+}
+
+/*===========================================================================
+METHOD:
+   ParseIndication (Internal Method)
+
+DESCRIPTION:
+   Parse an indication of the given service (exercising the callbacks)
+
+PARAMETERS:
+   svc         [ I ] - QMI Service type
+   buf         [ I ] - QMI indication
+
+SEQUENCING:
+   Only called by the parse pool, one indication of a service at a time
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiConnectionMgmt::ParseIndication(
+   eQMIService                svc,
+   const sProtocolBuffer &    buf )
+{
+   // The dispatch tables are fixed upon construction
+   std::map <eQMIService, sIndicationTable>::const_iterator pTable;
+   pTable = mIndications.find( svc );
+   if (pTable != mIndications.end())
+   {
+      (this->*pTable->second.mpHandler)( buf );
+   }
+}
+
+/*===========================================================================
+METHOD:
+   UpdateIndicationTables (Internal Method)
+
+DESCRIPTION:
+   Rebuild the indication dispatch tables from the enabled callbacks, this
+   must be called whenever a callback function is changed
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiConnectionMgmt::UpdateIndicationTables()
+{
+   bool bOn = false;
+
+   bOn = ( (mpFNDataBearer != 0) 
+       ||  (mpFNDormancyStatus != 0)
+       ||  (mpFNByteTotals != 0)
+       ||  (mpFNMobileIPStatus != 0)
+       ||  (mSessionStatsInterval != 0) );
+
+   EnableIndication( eQMI_SVC_WDS, eQMI_WDS_EVENT_IND, bOn );
+
+   bOn = (mpFNSessionState != 0);
+   EnableIndication( eQMI_SVC_WDS, eQMI_WDS_PKT_STATUS_IND, bOn );
+
+   bOn = ( (mpFNActivationStatus != 0) 
+       ||  (mpFNPower != 0)
+       ||  (mpFNWirelessDisable != 0) );
+
+   EnableIndication( eQMI_SVC_DMS, eQMI_DMS_EVENT_IND, bOn );
+
+   bOn = ( (mpFNSignalStrength != 0) 
+       ||  (mpFNRFInfo != 0)
+       ||  (mpFNLUReject != 0)
+       ||  (mbSignalMonitor == true) );
+
+   EnableIndication( eQMI_SVC_NAS, eQMI_NAS_EVENT_IND, bOn );
+
+   bOn = ( (mpFNRoamingIndicator != 0) 
+       ||  (mpFNDataCapabilities != 0)
+       ||  (mbSignalMonitor == true) );
+
+   EnableIndication( eQMI_SVC_NAS, eQMI_NAS_SS_INFO_IND, bOn );
+
+   bOn = (mpPLMNMode != 0);
+   EnableIndication( eQMI_SVC_NAS, eQMI_NAS_PLMN_MODE_IND, bOn );
+
+   bOn = (mpFNNewSMS != 0);
+   EnableIndication( eQMI_SVC_WMS, eQMI_WMS_EVENT_IND, bOn );
+
+   bOn = (mpFNNewNMEA != 0 || mbPositionStream == true);
+   EnableIndication( eQMI_SVC_PDS, eQMI_PDS_EVENT_IND, bOn );
+
+   bOn = (mpFNPDSState != 0);
+   EnableIndication( eQMI_SVC_PDS, eQMI_PDS_STATE_IND, bOn );
+
+   bOn = (mpFNCATEvent != 0);
+   EnableIndication( eQMI_SVC_CAT, eQMI_CAT_EVENT_IND, bOn );
+
+   bOn = ( (mpFNOMADMAlert != 0) 
+       ||  (mpFNOMADMState != 0) 
+       ||  (mbOMADMTracker == true) );
+
+   EnableIndication( eQMI_SVC_OMA, eQMI_OMA_EVENT_IND, bOn );
+
+   bOn = (mpFNUSSDRelease != 0);
+   EnableIndication( eQMI_SVC_VOICE, eQMI_VOICE_USSD_RELEASE_IND, bOn );
+
+   bOn = (mpFNUSSDNotification != 0);
+   EnableIndication( eQMI_SVC_VOICE, eQMI_VOICE_USSD_IND, bOn );
+
+   bOn = (mpFNUSSDOrigination != 0);
+   EnableIndication( eQMI_SVC_VOICE, eQMI_VOICE_ASYNC_USSD_IND, bOn );
+}
+
+/*===========================================================================
+METHOD:
+   EnableIndication (Internal Method)
+
+DESCRIPTION:
+   Enable/disable dispatching of the given indication
+
+PARAMETERS:
+   svc         [ I ] - QMI Service type
+   msgID       [ I ] - Indication message ID
+   bEnable     [ I ] - Dispatch the indication?
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiConnectionMgmt::EnableIndication(
+   eQMIService                svc,
+   ULONG                      msgID,
+   bool                       bEnable )
+{
+   std::map <eQMIService, sIndicationTable>::iterator pTable;
+   pTable = mIndications.find( svc );
+   if (pTable == mIndications.end() || msgID > MAX_INDICATION_ID)
+   {
+      return;
+   }
+
+   sIndicationTable & table = pTable->second;
+   if (table.mEnabled[msgID] == bEnable)
+   {
+      return;
+   }
+
+   table.mEnabled[msgID] = bEnable;
+   if (bEnable == true)
+   {
+      table.mEnabledCount++;
+   }
+   else
+   {
+      table.mEnabledCount--;
+   }
+}
+
+/*===========================================================================
+METHOD:
+   IsServerReapable (Internal Method)
+
+DESCRIPTION:
+   May the given on-demand service be taken down once idle? Not while any
+   of its indications is being dispatched
+
+PARAMETERS:
+   svc         [ I ] - QMI Service type
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cGobiConnectionMgmt::IsServerReapable( eQMIService svc )
+{
+   std::map <eQMIService, sIndicationTable>::const_iterator pTable;
+   pTable = mIndications.find( svc );
+   if (pTable != mIndications.end() && pTable->second.mEnabledCount > 0)
+   {
+      return false;
+   }
+
+   return cGobiQMICore::IsServerReapable( svc );
+}
+
+/*===========================================================================
+METHOD:
+   ProcessWDSBuffer (Internal Method)
+
+DESCRIPTION:
+   Process a WDS buffer
+
+PARAMETERS:
+   buf         [ I ] - QMI buffer to process
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiConnectionMgmt::ProcessWDSBuffer( const sProtocolBuffer & buf )
+{
+   // Indication? (the raw header is enough, the TLVs are indexed by the
+   // static views below instead of being parsed through the database)
+   ULONG msgID = 0;
+   if (sQMIServiceBuffer::GetIndicationID( buf, msgID ) == false)
+   {
+      return;
+   } 
+
+   // Do we even care?
+   if (msgID == eQMI_WDS_EVENT_IND)
+   {
+      cQMIViewWDSEventReportInd ind( buf );
+      if (ind.IsValid() == false)
+      {
+         return;
+      }
+
+      if (mSessionStatsInterval != 0)
+      {
+         PublishSessionStats( buf );
+      }
+
+      // Parse out data bearer technology
+      INT8 bearer = 0;
+      if (ind.GetDataBearerTechnology( bearer ) == true)
+      {
+         if (mpFNDataBearer != 0)
+         {
+            cDataBearerCallback * pCB = 0;
+            pCB = new cDataBearerCallback( mpFNDataBearer, 
+                                           (ULONG)(BYTE)bearer );
+
+            if (pCB != 0)
+            {
+               if (mCallbackPool.Submit( pCB ) == false)
+               {
+                  delete pCB;
+               }
+            }
+         }
+      }
+
+      // Parse out dormancy status
+      BYTE dormancy = 0;
+      if (ind.GetDormancyStatus( dormancy ) == true)
+      {
+         if (mpFNDormancyStatus != 0)
+         {
+            cDormancyStatusCallback * pCB = 0;
+            pCB = new cDormancyStatusCallback( mpFNDormancyStatus, 
+                                               (ULONG)dormancy );
+
+            if (pCB != 0)
+            {
+               if (mCallbackPool.Submit( pCB ) == false)
+               {
+                  delete pCB;
+               }
+            }
+         }
+      }
+
+      // Parse out byte totals
+      ULONGLONG tx = 0;
+      if (ind.GetTxBytesOk( tx ) == true)
+      {
+         ULONGLONG rx = ULLONG_MAX;
+         ind.GetRxBytesOk( rx );
+
+         if (mpFNByteTotals != 0)
+         {
+            cByteTotalsCallback * pCB = 0;
+            pCB = new cByteTotalsCallback( mpFNByteTotals, tx, rx ); 
+            if (pCB != 0)
+            {
+               if (mCallbackPool.Submit( pCB ) == false)
+               {
+                  delete pCB;
+               }
+            }
+         }
+      }
+
+      // Parse out mobile IP status
+      BYTE mip = 0;
+      if (ind.GetMIPStatus( mip ) == true)
+      {
+         if (mpFNMobileIPStatus != 0)
+         {
+            cMobileIPStatusCallback * pCB = 0;
+            pCB = new cMobileIPStatusCallback( mpFNMobileIPStatus, 
+                                               (ULONG)mip );
+
+            if (pCB != 0)
+            {
+               if (mCallbackPool.Submit( pCB ) == false)
+               {
+                  delete pCB;
+               }
+            }
+         }
+      }
+   }
+   else if (msgID == eQMI_WDS_PKT_STATUS_IND)
+   {
+      cQMIViewWDSPacketServiceStatusInd ind( buf );
+      if (ind.IsValid() == false)
+      {
+         return;
+      }
+
+      // Parse out session status
+      cQMIViewWDSPacketServiceStatusInd::sConnectionStatus status;
+      BYTE ss = 0;
+      if ( (ind.GetConnectionStatus( status ) == true)
+      &&   (status.GetStatus( ss ) == true) )
+      {
+         // Parse out call end reason (if present)
+         ULONG cer = ULONG_MAX;
+         WORD reason = 0;
+         if (ind.GetCallEndReason( reason ) == true)
+         {
+            cer = (ULONG)reason;
+         }
+
+         if (mpFNSessionState != 0)
+         {
+            cSessionStateCallback * pCB = 0;
+            pCB = new cSessionStateCallback( mpFNSessionState, 
+                                             (ULONG)ss, 
+                                             cer );
+
+            if (pCB != 0)
+            {
+               if (mCallbackPool.Submit( pCB ) == false)
+               {
+                  delete pCB;
+               }
+            }
+         }
+      }
+   }
+}
+
+/*===========================================================================
+METHOD:
+   ProcessDMSBuffer (Internal Method)
+
+DESCRIPTION:
+   Process a DMS buffer
+
+PARAMETERS:
+   buf         [ I ] - QMI buffer to process
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiConnectionMgmt::ProcessDMSBuffer( const sProtocolBuffer & buf )
+{
+   sQMIServiceBuffer qmiBuf( buf.GetSharedBuffer() );   
+   if (qmiBuf.IsValid() == false)
+   {
+      return;
+   }
+
+   // Indication?
+   if (qmiBuf.IsIndication() == false)
+   {
+      return;
+   } 
+
+   // Do we even care?
+   ULONG msgID = qmiBuf.GetMessageID();
+   if (msgID == eQMI_DMS_EVENT_IND)
+   {
+      // Prepare TLVs for parsing
+      cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiBuf );
+
+      // Parse out activation status
+      sProtocolEntityKey tlvKey( eDB2_ET_QMI_DMS_IND, msgID, 19 );
+      cDataParser::tParsedFields pf = ParseTLV( mDB, buf, tlvs, tlvKey );
+      if (pf.size() >= 1 && mpFNActivationStatus != 0)
+      {
+         cActivationStatusCallback * pCB = 0;
+         pCB = new cActivationStatusCallback( mpFNActivationStatus, 
+                                              pf[0].mValue.mU32 );
+
+         if (pCB != 0)
+         {
+            if (mCallbackPool.Submit( pCB ) == false)
+            {
+               delete pCB;
+            }
+         }
+      }
+
+      // Parse out operating mode
+      tlvKey = sProtocolEntityKey( eDB2_ET_QMI_DMS_IND, msgID, 20 );
+      pf = ParseTLV( mDB, buf, tlvs, tlvKey );
+      if (pf.size() >= 1 && mpFNPower != 0)
+      {
+         cPowerCallback * pCB = 0;
+         pCB = new cPowerCallback( mpFNPower, pf[0].mValue.mU32 );
+         if (pCB != 0)
+         {
+            if (mCallbackPool.Submit( pCB ) == false)
+            {
+               delete pCB;
+            }
+         }
+      }
+
+      // Parse out wireless disable state
+      tlvKey = sProtocolEntityKey( eDB2_ET_QMI_DMS_IND, msgID, 22 );
+      pf = ParseTLV( mDB, buf, tlvs, tlvKey );
+      if (pf.size() >= 1 && mpFNWirelessDisable != 0)
+      {
+         cWirelessDisableCallback * pCB = 0;
+         pCB = new cWirelessDisableCallback( mpFNWirelessDisable, 
+                                             pf[0].mValue.mU32 );
+         if (pCB != 0)
+         {
+            if (mCallbackPool.Submit( pCB ) == false)
+            {
+               delete pCB;
+            }
+         }
+      }
+   }
+}
+
+/*===========================================================================
+METHOD:
+   ProcessNASBuffer (Internal Method)
+
+DESCRIPTION:
+   Process a NAS buffer
+
+PARAMETERS:
+   buf         [ I ] - QMI buffer to process
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiConnectionMgmt::ProcessNASBuffer( const sProtocolBuffer & buf )
+{
+   // Indication? (the raw header is enough, the frequent indications are
+   // indexed by the static views below instead of the database)
+   ULONG msgID = 0;
+   if (sQMIServiceBuffer::GetIndicationID( buf, msgID ) == false)
+   {
+      return;
+   } 
+
+   // Do we even care?
+   if (msgID == (ULONG)eQMI_NAS_EVENT_IND)
+   {
+      cQMIViewNASEventReportInd ind( buf );
+      if (ind.IsValid() == false)
+      {
+         return;
+      }
+
+      if (mbSignalMonitor == true)
+      {
+         PublishSignalReport( buf );
+      }
+
+      // Parse signal strength
+      cQMIViewNASEventReportInd::sSignalStrength sig;
+      INT8 sigVal = 0;
+      INT8 radio = 0;
+      if ( (ind.GetSignalStrength( sig ) == true)
+      &&   (sig.GetStrength( sigVal ) == true)
+      &&   (sig.GetRadioInterface( radio ) == true) )
+      {
+         ULONG radioVal = (ULONG)(BYTE)radio;
+         bool bValidSig = (sigVal <= -30 && sigVal > -125 && radioVal != 0);
+
+         if (bValidSig == true && mpFNSignalStrength != 0)
+         {
+            cSignalStrengthCallback * pCB = 0;
+            pCB = new cSignalStrengthCallback( mpFNSignalStrength, 
+                                               sigVal,
+                                               radioVal );
+
+            if (pCB != 0)
+            {
+               if (mCallbackPool.Submit( pCB ) == false)
+               {
+                  delete pCB;
+               }
+            }
+         }
+      }
+
+      // Parse out RF info
+      cQMIViewNASEventReportInd::tRFBandInformation rfInfo;
+      if (mpFNRFInfo != 0 && ind.GetRFBandInformation( rfInfo ) == true)
+      {
+         cQMIViewNASEventReportInd::tRFBandInformation::cIterator iter( rfInfo );
+
+         cQMIViewNASEventReportInd::sRFBandInformationElement elem;
+         while (iter.Next( elem ) == true)
+         {
+            INT8 iface = 0;
+            WORD bandClass = 0;
+            WORD channel = 0;
+            if ( (elem.GetRadioInterface( iface ) == false)
+            ||   (elem.GetActiveBandClass( bandClass ) == false)
+            ||   (elem.GetActiveChannel( channel ) == false) )
+            {
+               break;
+            }
+
+            cRFInfoCallback * pCB = 0;
+            pCB = new cRFInfoCallback( mpFNRFInfo, 
+                                       (ULONG)(BYTE)iface,
+                                       (ULONG)bandClass,
+                                       (ULONG)channel );
+
+            if (pCB != 0)
+            {
+               if (mCallbackPool.Submit( pCB ) == false)
+               {
+                  delete pCB;
+               }
+            }
+         }
+      }
+
+      // Parse out LU reject
+      cQMIViewNASEventReportInd::sRegistrationRejectReason reject;
+      BYTE domain = 0;
+      WORD cause = 0;
+      if ( (mpFNLUReject != 0)
+      &&   (ind.GetRegistrationRejectReason( reject ) == true)
+      &&   (reject.GetServiceDomain( domain ) == true)
+      &&   (reject.GetRejectCause( cause ) == true) )
+      {
+         cLURejectCallback * pCB = 0;
+         pCB = new cLURejectCallback( mpFNLUReject, 
+                                      (ULONG)domain,
+                                      (ULONG)cause );
+
+         if (pCB != 0)
+         {
+            if (mCallbackPool.Submit( pCB ) == false)
+            {
+               delete pCB;
+            }
+         }
+      }
+
+   }
+   else if (msgID == (ULONG)eQMI_NAS_SS_INFO_IND)
+   {
+      cQMIViewNASServingSystemInd ind( buf );
+      if (ind.IsValid() == false)
+      {
+         return;
+      }
+
+      if (mbSignalMonitor == true)
+      {
+         PublishServingSystem( buf );
+      }
+
+      // Parse out roaming indicator
+      BYTE roaming = 0;
+      if (ind.GetRoamingIndicator( roaming ) == true)
+      {
+         if (mpFNRoamingIndicator != 0)
+         {
+            cRoamingIndicatorCallback * pCB = 0;
+            pCB = new cRoamingIndicatorCallback( mpFNRoamingIndicator, 
+                                                 (ULONG)roaming );
+
+            if (pCB != 0)
+            {
+               if (mCallbackPool.Submit( pCB ) == false)
+               {
+                  delete pCB;
+               }
+            }
+         }
+      }
+
+      // Parse out data capabilities
+      cQMIViewNASServingSystemInd::tDataServiceCapability dataCaps;
+      if (ind.GetDataServiceCapability( dataCaps ) == true)
+      {
+         ULONG caps[12] = { 0 };
+         ULONG activeDataCaps = dataCaps.GetCount();
+         if (activeDataCaps > 12)
+         {
+            activeDataCaps = 12;
+         }
+
+         for (ULONG d = 0; d < activeDataCaps; d++)
+         {
+            BYTE cap = 0;
+            dataCaps.GetElement( d, cap );
+            caps[d] = (ULONG)cap;
+         }
+
+         if (mpFNDataCapabilities != 0)
+         {
+            cDataCapabilitiesCallback * pCB = 0;
+            pCB = new cDataCapabilitiesCallback( mpFNDataCapabilities, 
+                                                 (BYTE)activeDataCaps, 
+                                                 &caps[0] );
+
+            if (pCB != 0)
+            {
+               if (mCallbackPool.Submit( pCB ) == false)
+               {
+                  delete pCB;
+               }
+            }
+         }
+      }
+   }
+   else if (msgID == (ULONG)eQMI_NAS_PLMN_MODE_IND)
+   {
+      sQMIServiceBuffer qmiBuf( buf.GetSharedBuffer() );   
+      if (qmiBuf.IsValid() == false)
+      {
+         return;
+      }
+
+      // Prepare TLVs for parsing
+      cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiBuf );
+
+      // Parse PLMN mode
+      sProtocolEntityKey tlvKey( eDB2_ET_QMI_NAS_IND, msgID, 16 );
+      cDataParser::tParsedFields pf = ParseTLV( mDB, buf, tlvs, tlvKey );
+      if (pf.size() >= 1)
+      {  
+         cPLMNModeCallback * pCB = 0;
+         pCB = new cPLMNModeCallback( mpPLMNMode, 
+                                      (ULONG)pf[0].mValue.mU8 );
+
+         if (pCB != 0)
+         {
+            if (mCallbackPool.Submit( pCB ) == false)
+            {
+               delete pCB;
+            }
+         }
+      }
+   }
+}
+
+/*===========================================================================
+METHOD:
+   ProcessWMSBuffer (Internal Method)
+
+DESCRIPTION:
+   Process a WDS buffer
+
+PARAMETERS:
+   buf         [ I ] - QMI buffer to process
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiConnectionMgmt::ProcessWMSBuffer( const sProtocolBuffer & buf )
+{
+   sQMIServiceBuffer qmiBuf( buf.GetSharedBuffer() );   
+   if (qmiBuf.IsValid() == false)
+   {
+      return;
+   }
+
+   // Indication?
+   if (qmiBuf.IsIndication() == false)
+   {
+      return;
+   }
+
+   // Do we even care?
+   ULONG msgID = qmiBuf.GetMessageID();
+   if (msgID == (ULONG)eQMI_WMS_EVENT_IND)
+   {
+      // Prepare TLVs for parsing
+      cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiBuf );
+
+      // Parse out message details
+      sProtocolEntityKey tlvKey( eDB2_ET_QMI_WMS_IND, msgID, 16 );
+      cDataParser::tParsedFields pf = ParseTLV( mDB, buf, tlvs, tlvKey );
+      if (pf.size() >= 2)
+      {
+         if (mpFNNewSMS != 0)
+         {
+            cNewSMSCallback * pCB = 0;
+            pCB = new cNewSMSCallback( mpFNNewSMS, 
+                                       pf[0].mValue.mU32,
+                                       pf[1].mValue.mU32 );
+
+            if (pCB != 0)
+            {
+               if (mCallbackPool.Submit( pCB ) == false)
                {
                   delete pCB;
                }
             }
          }
       }
-      // Parse out mobile IP status
-      tlvKey = sProtocolEntityKey( eDB2_ET_QMI_WDS_IND, msgID, 27 );
-      pf = ParseTLV( mDB, buf, tlvs, tlvKey );
-      if (pf.size() >= 1)
+   }
+}
+
+/*===========================================================================
+METHOD:
+   ProcessPDSBuffer (Internal Method)
+
+DESCRIPTION:
+   Process a PDS buffer
+
+PARAMETERS:
+   buf         [ I ] - QMI buffer to process
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiConnectionMgmt::ProcessPDSBuffer( const sProtocolBuffer & buf )
+{
+   sQMIServiceBuffer qmiBuf( buf.GetSharedBuffer() );   
+   if (qmiBuf.IsValid() == false)
+   {
+      return;
+   }
+
+   // Indication?
+   if (qmiBuf.IsIndication() == false)
+   {
+      return;
+   }
+
+   // Do we even care?
+   ULONG msgID = qmiBuf.GetMessageID();
+   if (msgID == (ULONG)eQMI_PDS_EVENT_IND)
+   {
+      if (mbPositionStream == true)
+      {
+         PublishPosition( buf );
+      }
+
+      // The database parse is only needed for NMEA sentences
+      if (mpFNNewNMEA == 0)
+      {
+         return;
+      }
+
+      // Prepare TLVs for extraction
+      cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiBuf );
+
+      sProtocolEntityKey tlvKey( eDB2_ET_QMI_PDS_IND, msgID, 16 );
+      cDataParser::tParsedFields pf = ParseTLV( mDB, buf, tlvs, tlvKey );
+      if (pf.size() >= 1 && mpFNNewNMEA != 0)
+      {
+         cNewNMEACallback * pCB = 0;
+         pCB = new cNewNMEACallback( mpFNNewNMEA, pf[0].mValueString );
+         if (pCB != 0)
+         {
+            if (mCallbackPool.Submit( pCB ) == false)
+            {
+               delete pCB;
+            }
+         }
+      }
+   }
+   else if (msgID == (ULONG)eQMI_PDS_STATE_IND)
+   {
+      // Prepare TLVs for extraction
+      cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiBuf );
+
+      // Parse out message details
+      sProtocolEntityKey tlvKey( eDB2_ET_QMI_PDS_IND, msgID, 1 );
+      cDataParser::tParsedFields pf = ParseTLV( mDB, buf, tlvs, tlvKey );
+      if (pf.size() >= 2 && mpFNPDSState != 0)
+      {
+         cPDSStateCallback * pCB = 0;
+         pCB = new cPDSStateCallback( mpFNPDSState, 
+                                      pf[0].mValue.mU32,
+                                      pf[1].mValue.mU32 );
+
+         if (pCB != 0)
+         {
+            if (mCallbackPool.Submit( pCB ) == false)
+            {
+               delete pCB;
+            }
+         }
+      }
+   }
+}
+
+/*===========================================================================
+METHOD:
+   PublishPosition (Internal Method)
+
+DESCRIPTION:
+   Decode the parsed position data of a PDS event report straight into 
+   the position stream's ring (reports are dropped while the ring is full)
+
+PARAMETERS:
+   buf         [ I ] - QMI buffer to process
+
+SEQUENCING:
+   Only called when parsing a PDS indication (the ring's producer)
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiConnectionMgmt::PublishPosition( const sProtocolBuffer & buf )
+{
+   if (mpPositionRing == 0)
+   {
+      return;
+   }
+
+   cPDSEventReportView ind( buf );
+   const sQMIView & pos = ind.GetParsedPosition();
+   if (pos.Has( 0, PDS_PARSED_POSITION_SZ ) == false)
+   {
+      // Not every event report carries a position
+      return;
+   }
+
+   // Every report counts, even when it is dropped below
+   ULONG seq = ++mPositionSequence;
+
+   sGobiPositionReport * pRpt = mpPositionRing->BeginPush();
+   if (pRpt == 0)
+   {
+      return;
+   }
+
+   typedef cPDSEventReportView tView;
+
+   pRpt->mSequence = seq;
+   pRpt->mReceived = GetTickCount();
+
+   sQMIInt <ULONG, 4>::Read( pos, tView::OFFSET_VALID, pRpt->mValid );
+   sQMIInt <WORD, 2>::Read( pos, tView::OFFSET_YEAR, pRpt->mYear );
+   sQMIInt <BYTE, 1>::Read( pos, tView::OFFSET_MONTH, pRpt->mMonth );
+   sQMIInt <BYTE, 1>::Read( pos, 
+                            tView::OFFSET_DAY_OF_WEEK, 
+                            pRpt->mDayOfWeek );
+
+   sQMIInt <BYTE, 1>::Read( pos, tView::OFFSET_DAY, pRpt->mDay );
+   sQMIInt <BYTE, 1>::Read( pos, tView::OFFSET_HOUR, pRpt->mHour );
+   sQMIInt <BYTE, 1>::Read( pos, tView::OFFSET_MINUTE, pRpt->mMinute );
+   sQMIInt <BYTE, 1>::Read( pos, tView::OFFSET_SECOND, pRpt->mSecond );
+   sQMIInt <WORD, 2>::Read( pos, 
+                            tView::OFFSET_MILLISECOND, 
+                            pRpt->mMillisecond );
+
+   sQMIInt <BYTE, 1>::Read( pos, 
+                            tView::OFFSET_LEAP_SECONDS, 
+                            pRpt->mLeapSeconds );
+
+   sQMIInt <ULONGLONG, 8>::Read( pos, 
+                                 tView::OFFSET_UTC_TIMESTAMP, 
+                                 pRpt->mUTCTimestamp );
+
+   sQMIInt <ULONG, 4>::Read( pos, 
+                             tView::OFFSET_TIME_UNCERTAINTY, 
+                             pRpt->mTimeUncertainty );
+
+   sQMIFloat <DOUBLE>::Read( pos, tView::OFFSET_LATITUDE, pRpt->mLatitude );
+   sQMIFloat <DOUBLE>::Read( pos, tView::OFFSET_LONGITUDE, pRpt->mLongitude );
+   sQMIFloat <FLOAT>::Read( pos, 
+                            tView::OFFSET_ELLIPSOID_ALTITUDE, 
+                            pRpt->mEllipsoidAltitude );
+
+   sQMIFloat <FLOAT>::Read( pos, 
+                            tView::OFFSET_MSL_ALTITUDE, 
+                            pRpt->mMSLAltitude );
+
+   sQMIFloat <FLOAT>::Read( pos, 
+                            tView::OFFSET_HORIZONTAL_SPEED, 
+                            pRpt->mHorizontalSpeed );
+
+   sQMIFloat <FLOAT>::Read( pos, 
+                            tView::OFFSET_VERTICAL_SPEED, 
+                            pRpt->mVerticalSpeed );
+
+   sQMIFloat <FLOAT>::Read( pos, tView::OFFSET_HEADING, pRpt->mHeading );
+   sQMIFloat <FLOAT>::Read( pos, 
+                            tView::OFFSET_H_UNCERTAINTY_CIRCULAR, 
+                            pRpt->mHUncertaintyCircular );
+
+   sQMIFloat <FLOAT>::Read( pos, 
+                            tView::OFFSET_H_UNCERTAINTY_MAJOR, 
+                            pRpt->mHUncertaintyMajor );
+
+   sQMIFloat <FLOAT>::Read( pos, 
+                            tView::OFFSET_H_UNCERTAINTY_MINOR, 
+                            pRpt->mHUncertaintyMinor );
+
+   sQMIFloat <FLOAT>::Read( pos, 
+                            tView::OFFSET_H_UNCERTAINTY_AZIMUTH, 
+                            pRpt->mHUncertaintyAzimuth );
+
+   sQMIFloat <FLOAT>::Read( pos, 
+                            tView::OFFSET_V_UNCERTAINTY, 
+                            pRpt->mVUncertainty );
+
+   sQMIFloat <FLOAT>::Read( pos, 
+                            tView::OFFSET_H_VELOCITY_UNCERTAINTY, 
+                            pRpt->mHVelocityUncertainty );
+
+   sQMIFloat <FLOAT>::Read( pos, 
+                            tView::OFFSET_V_VELOCITY_UNCERTAINTY, 
+                            pRpt->mVVelocityUncertainty );
+
+   sQMIInt <BYTE, 1>::Read( pos, 
+                            tView::OFFSET_H_CONFIDENCE, 
+                            pRpt->mHConfidence );
+
+   sQMIFloat <FLOAT>::Read( pos, tView::OFFSET_PDOP, pRpt->mPDOP );
+   sQMIFloat <FLOAT>::Read( pos, tView::OFFSET_HDOP, pRpt->mHDOP );
+   sQMIFloat <FLOAT>::Read( pos, tView::OFFSET_VDOP, pRpt->mVDOP );
+   sQMIInt <BYTE, 1>::Read( pos, 
+                            tView::OFFSET_OPERATING_MODE, 
+                            pRpt->mOperatingMode );
+
+   mpPositionRing->CommitPush();
+
+   // Only take the lock when the consumer is (about to be) waiting
+   __sync_synchronize();
+   if (mPositionWaiting != 0)
+   {
+      pthread_mutex_lock( &mPositionMutex );
+      pthread_cond_signal( &mPositionCond );
+      pthread_mutex_unlock( &mPositionMutex );
+   }
+}
+
+/*===========================================================================
+METHOD:
+   SendStatisticsReport (Internal Method)
+
+DESCRIPTION:
+   Configure the statistics carried by the WDS event reports, either just
+   the byte totals or every counter (plus the channel rates)
+
+PARAMETERS:
+   interval    [ I ] - Interval in seconds (0 = stop reporting)
+   bAll        [ I ] - Report every counter?
+
+RETURN VALUE:
+   eGobiError - Return code
+===========================================================================*/
+eGobiError cGobiConnectionMgmt::SendStatisticsReport(
+   BYTE                       interval,
+   bool                       bAll )
+{
+   WORD msgID = (WORD)eQMI_WDS_SET_EVENT;
+   std::vector <sDB2PackingInput> piv;
+
+   sProtocolEntityKey pekRates( eDB2_ET_QMI_WDS_REQ, msgID, 16 );
+   sDB2PackingInput piRates( pekRates, (bAll == true ? "1" : "0") );
+   piv.push_back( piRates );
+
+   std::ostringstream tmp;
+   if (interval == 0)
+   {
+      tmp << "0 0 0 0 0 0 0 0 0";
+   }
+   else if (bAll == true)
+   {
+      tmp << (ULONG)interval << " 1 1 1 1 1 1 1 1";
+   }
+   else
+   {
+      tmp << (ULONG)interval << " 0 0 0 0 0 0 1 1";
+   }
+
+   sProtocolEntityKey pekStats( eDB2_ET_QMI_WDS_REQ, msgID, 17 );
+   sDB2PackingInput piStats( pekStats, (LPCSTR)tmp.str().c_str() );
+   piv.push_back( piStats );
+
+   sSharedBuffer * pReq = DB2PackQMIBuffer( mDB, piv );
+   return SendRegistration( eQMI_SVC_WDS, pReq );
+}
+
+/*===========================================================================
+METHOD:
+   PublishSessionStats (Internal Method)
+
+DESCRIPTION:
+   Fold the counters of a WDS event report into the session statistics
+   (reports without counters, e.g. dormancy changes, are ignored)
+
+PARAMETERS:
+   buf         [ I ] - QMI buffer to process
+
+SEQUENCING:
+   Only called when parsing a WDS indication (the single writer of the
+   session statistics)
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiConnectionMgmt::PublishSessionStats( const sProtocolBuffer & buf )
+{
+   cQMIViewWDSEventReportInd ind( buf );
+
+   ULONG valid = 0;
+   ULONG txOK = 0;
+   ULONG rxOK = 0;
+   ULONG txErr = 0;
+   ULONG rxErr = 0;
+   ULONG txOvf = 0;
+   ULONG rxOvf = 0;
+   if ( (ind.GetTxPacketsOk( txOK ) == true)
+   &&   (ind.GetRxPacketsOk( rxOK ) == true)
+   &&   (ind.GetTxPacketsError( txErr ) == true)
+   &&   (ind.GetRxPacketsError( rxErr ) == true)
+   &&   (ind.GetTxOverflows( txOvf ) == true)
+   &&   (ind.GetRxOverflows( rxOvf ) == true) )
+   {
+      valid |= (ULONG)eGOBI_STATS_PACKETS;
+   }
+
+   ULONGLONG txBytes = 0;
+   ULONGLONG rxBytes = 0;
+   if ( (ind.GetTxBytesOk( txBytes ) == true)
+   &&   (ind.GetRxBytesOk( rxBytes ) == true) )
+   {
+      valid |= (ULONG)eGOBI_STATS_BYTES;
+   }
+
+   cQMIViewWDSEventReportInd::sChannelRates rates;
+   LONG txRate = 0;
+   LONG rxRate = 0;
+   if ( (ind.GetChannelRates( rates ) == true)
+   &&   (rates.GetTxRateBPS( txRate ) == true)
+   &&   (rates.GetRxRateBPS( rxRate ) == true) )
+   {
+      valid |= (ULONG)eGOBI_STATS_CHANNEL_RATES;
+   }
+
+   if (valid == 0)
+   {
+      return;
+   }
+
+   // Odd sequence count while the snapshot is being written
+   mSessionStatsSequence++;
+   __sync_synchronize();
+
+   sGobiSessionStats & stats = mSessionStats;
+   stats.mReports++;
+   stats.mReceived = GetTickCount();
+   stats.mValid |= valid;
+
+   if ((valid & (ULONG)eGOBI_STATS_PACKETS) != 0)
+   {
+      stats.mTXPacketSuccesses = txOK;
+      stats.mRXPacketSuccesses = rxOK;
+      stats.mTXPacketErrors = txErr;
+      stats.mRXPacketErrors = rxErr;
+      stats.mTXPacketOverflows = txOvf;
+      stats.mRXPacketOverflows = rxOvf;
+   }
+
+   if ((valid & (ULONG)eGOBI_STATS_BYTES) != 0)
+   {
+      stats.mTXTotalBytes = txBytes;
+      stats.mRXTotalBytes = rxBytes;
+   }
+
+   if ((valid & (ULONG)eGOBI_STATS_CHANNEL_RATES) != 0)
+   {
+      stats.mTXChannelRate = (ULONG)txRate;
+      stats.mRXChannelRate = (ULONG)rxRate;
+   }
+
+   __sync_synchronize();
+   mSessionStatsSequence++;
+}
+
+/*===========================================================================
+METHOD:
+   GetCurrentSessionStats (Internal Method)
+
+DESCRIPTION:
+   Return the session statistics if they are being reported and the 
+   latest report is current, i.e. was received since the statistics were
+   started and within two reporting intervals
+
+PARAMETERS:
+   stats       [ O ] - The session statistics
+
+RETURN VALUE:
+   bool - Are the statistics current?
+===========================================================================*/
+bool cGobiConnectionMgmt::GetCurrentSessionStats( sGobiSessionStats & stats )
+{
+   ULONGLONG maxAge = (ULONGLONG)mSessionStatsInterval * 2000;
+   if (maxAge == 0 || GetSessionStats( stats ) == false)
+   {
+      return false;
+   }
+
+   ULONGLONG now = GetTickCount();
+   if ( (stats.mReceived < mSessionStatsStart)
+   ||   (now - stats.mReceived > maxAge) )
+   {
+      return false;
+   }
+
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   SendSignalThresholds (Internal Method)
+
+DESCRIPTION:
+   Configure the signal strength thresholds of the NAS event reports, the
+   device only supports a single set so the thresholds of the signal 
+   strength callback are merged with those of the signal monitor
+
+PARAMETERS:
+   thresholds  [ I ] - Thresholds of the signal strength callback
+
+RETURN VALUE:
+   eGobiError - Return code
+===========================================================================*/
+eGobiError cGobiConnectionMgmt::SendSignalThresholds( 
+   const std::list <INT8> &   thresholds )
+{
+   std::list <INT8> merged = thresholds;
+   for (ULONG t = 0; t < mMonitorThresholdCount; t++)
+   {
+      merged.push_back( mMonitorThresholds[t] );
+   }
+
+   merged.sort();
+   merged.unique();
+   if (merged.size() > (size_t)MAX_SIGNAL_THRESHOLDS)
+   {
+      return eGOBI_ERR_INVALID_ARG;
+   }
+
+   WORD msgID = (WORD)eQMI_NAS_SET_EVENT;
+   std::vector <sDB2PackingInput> piv;
+   sProtocolEntityKey pek( eDB2_ET_QMI_NAS_REQ, msgID, 16 );
+
+   std::ostringstream args;
+   if (merged.size() == 0)
+   {
+      args << "0 0";
+   }
+   else
+   {
+      args << "1 " << (UINT)merged.size();
+
+      std::list <INT8>::const_iterator pThreshold = merged.begin();
+      while (pThreshold != merged.end())
+      {
+         INT8 t = *pThreshold++;
+
+         args << " " << (INT)t;
+      }
+   }
+
+   sDB2PackingInput pi( pek, (LPCSTR)args.str().c_str() ); 
+   piv.push_back( pi );
+
+   sSharedBuffer * pReq = DB2PackQMIBuffer( mDB, piv );
+   return SendRegistration( eQMI_SVC_NAS, pReq );
+}
+
+/*===========================================================================
+METHOD:
+   SendRFInfoReport (Internal Method)
+
+DESCRIPTION:
+   Turn the RF information of the NAS event reports on/off
+
+PARAMETERS:
+   bOn         [ I ] - Report the RF information?
+
+RETURN VALUE:
+   eGobiError - Return code
+===========================================================================*/
+eGobiError cGobiConnectionMgmt::SendRFInfoReport( bool bOn )
+{
+   WORD msgID = (WORD)eQMI_NAS_SET_EVENT;
+   std::vector <sDB2PackingInput> piv;
+
+   sProtocolEntityKey pek( eDB2_ET_QMI_NAS_REQ, msgID, 17 );
+   sDB2PackingInput pi( pek, (bOn == true ? "1" : "0") ); 
+   piv.push_back( pi );
+
+   sSharedBuffer * pReq = DB2PackQMIBuffer( mDB, piv );
+   return SendRegistration( eQMI_SVC_NAS, pReq );
+}
+
+/*===========================================================================
+METHOD:
+   SeedSignalState (Internal Method)
+
+DESCRIPTION:
+   Fill the signal state from queries when starting the signal monitor,
+   the device only pushes values as they change so until then there 
+   would be nothing to serve (values pushed while querying are kept, as
+   they are newer)
+
+PARAMETERS:
+   bRFInfo     [ I ] - Is the RF information being pushed?
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiConnectionMgmt::SeedSignalState( bool bRFInfo )
+{
+   sGobiDeviceSnapshot snapshot;
+   ULONG mask = (ULONG)eGOBI_SNAPSHOT_SIGNAL_STRENGTHS
+              | (ULONG)eGOBI_SNAPSHOT_SERVING_NETWORK
+              | (ULONG)eGOBI_SNAPSHOT_ROAMING;
+
+   GetDeviceSnapshot( mask, &snapshot );
+
+   // RF information is only served while it is being pushed
+   BYTE rfCount = 0;
+   ULONG rfInfo[GOBI_SNAPSHOT_MAX_RADIO_IFACES * 3];
+   if (bRFInfo == true)
+   {
+      rfCount = GOBI_SNAPSHOT_MAX_RADIO_IFACES;
+      eGobiError rc = cGobiQMICore::GetRFInfo( &rfCount, (BYTE *)&rfInfo[0] );
+      if (rc != eGOBI_ERR_NONE)
+      {
+         bRFInfo = false;
+      }
+   }
+
+   pthread_mutex_lock( &mSignalStateMutex );
+   if (mbSignalMonitor == false)
+   {
+      pthread_mutex_unlock( &mSignalStateMutex );
+      return;
+   }
+
+   mSignalStateSequence++;
+   __sync_synchronize();
+
+   sGobiSignalState & state = mSignalState;
+   ULONG valid = snapshot.mValid;
+   if ( ((valid & (ULONG)eGOBI_SNAPSHOT_SIGNAL_STRENGTHS) != 0)
+   &&   ((state.mValid & (ULONG)eGOBI_SIGNAL_STRENGTHS) == 0) )
+   {
+      state.mSignalCount = snapshot.mSignalCount;
+      for (ULONG s = 0; s < snapshot.mSignalCount; s++)
+      {
+         INT8 sigVal = snapshot.mSignalStrengths[s];
+         state.mSignalStrengths[s] = sigVal;
+         state.mSignalRadioIfaces[s] = snapshot.mSignalRadioIfaces[s];
+         state.mSignalBands[s] = GetSignalBand( &mMonitorThresholds[0],
+                                                mMonitorThresholdCount,
+                                                0,
+                                                0,
+                                                sigVal );
+      }
+
+      state.mValid |= (ULONG)eGOBI_SIGNAL_STRENGTHS;
+   }
+
+   if ( (bRFInfo == true)
+   &&   ((state.mValid & (ULONG)eGOBI_SIGNAL_RF_INFO) == 0) )
+   {
+      state.mRFInfoCount = rfCount;
+      for (BYTE r = 0; r < rfCount; r++)
+      {
+         state.mRFRadioIfaces[r] = rfInfo[r * 3];
+         state.mRFBandClasses[r] = rfInfo[r * 3 + 1];
+         state.mRFChannels[r] = rfInfo[r * 3 + 2];
+      }
+
+      state.mValid |= (ULONG)eGOBI_SIGNAL_RF_INFO;
+   }
+
+   if ( ((valid & (ULONG)eGOBI_SNAPSHOT_SERVING_NETWORK) != 0)
+   &&   ((state.mValid & (ULONG)eGOBI_SIGNAL_SERVING_NETWORK) == 0) )
+   {
+      state.mRegistrationState = snapshot.mRegistrationState;
+      state.mCSDomain = snapshot.mCSDomain;
+      state.mPSDomain = snapshot.mPSDomain;
+      state.mRAN = snapshot.mRAN;
+      state.mRadioIfaceCount = snapshot.mRadioIfaceCount;
+      memcpy( (LPVOID)&state.mRadioIfaces[0], 
+              (LPCVOID)&snapshot.mRadioIfaces[0], 
+              sizeof( state.mRadioIfaces ) );
+
+      state.mRoaming = ULONG_MAX;
+      if ((valid & (ULONG)eGOBI_SNAPSHOT_ROAMING) != 0)
+      {
+         state.mRoaming = snapshot.mRoaming;
+      }
+
+      state.mMCC = snapshot.mMCC;
+      state.mMNC = snapshot.mMNC;
+      memcpy( (LPVOID)&state.mNetworkName[0], 
+              (LPCVOID)&snapshot.mNetworkName[0], 
+              sizeof( state.mNetworkName ) );
+
+      state.mValid |= (ULONG)eGOBI_SIGNAL_SERVING_NETWORK;
+   }
+
+   state.mReceived = GetTickCount();
+
+   __sync_synchronize();
+   mSignalStateSequence++;
+   pthread_mutex_unlock( &mSignalStateMutex );
+}
+
+/*===========================================================================
+METHOD:
+   PublishSignalReport (Internal Method)
+
+DESCRIPTION:
+   Fold the signal strength and RF information of a NAS event report into
+   the signal state, running the signal monitor callback when a signal 
+   strength moves to another threshold band
+
+PARAMETERS:
+   buf         [ I ] - QMI buffer to process
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiConnectionMgmt::PublishSignalReport( const sProtocolBuffer & buf )
+{
+   cQMIViewNASEventReportInd ind( buf );
+
+   // Signal strength (out of range values are dropped, as for the 
+   // signal strength callback)
+   cQMIViewNASEventReportInd::sSignalStrength sig;
+   INT8 sigVal = 0;
+   INT8 radio = 0;
+   ULONG radioVal = 0;
+   bool bSig = ( (ind.GetSignalStrength( sig ) == true)
+             &&  (sig.GetStrength( sigVal ) == true)
+             &&  (sig.GetRadioInterface( radio ) == true) );
+
+   if (bSig == true)
+   {
+      radioVal = (ULONG)(BYTE)radio;
+      bSig = (sigVal <= -30 && sigVal > -125 && radioVal != 0);
+   }
+
+   // RF information (the complete list of active radio interfaces)
+   ULONG rfCount = 0;
+   ULONG rfRadios[GOBI_SNAPSHOT_MAX_RADIO_IFACES];
+   ULONG rfBandClasses[GOBI_SNAPSHOT_MAX_RADIO_IFACES];
+   ULONG rfChannels[GOBI_SNAPSHOT_MAX_RADIO_IFACES];
+
+   cQMIViewNASEventReportInd::tRFBandInformation rfInfo;
+   bool bRF = ind.GetRFBandInformation( rfInfo );
+   if (bRF == true)
+   {
+      cQMIViewNASEventReportInd::tRFBandInformation::cIterator iter( rfInfo );
+
+      cQMIViewNASEventReportInd::sRFBandInformationElement elem;
+      while ( (rfCount < (ULONG)GOBI_SNAPSHOT_MAX_RADIO_IFACES)
+      &&      (iter.Next( elem ) == true) )
+      {
+         INT8 iface = 0;
+         WORD bandClass = 0;
+         WORD channel = 0;
+         if ( (elem.GetRadioInterface( iface ) == false)
+         ||   (elem.GetActiveBandClass( bandClass ) == false)
+         ||   (elem.GetActiveChannel( channel ) == false) )
+         {
+            bRF = false;
+            break;
+         }
+
+         rfRadios[rfCount] = (ULONG)(BYTE)iface;
+         rfBandClasses[rfCount] = (ULONG)bandClass;
+         rfChannels[rfCount] = (ULONG)channel;
+         rfCount++;
+      }
+   }
+
+   if (bSig == false && bRF == false)
+   {
+      return;
+   }
+
+   bool bNotify = false;
+
+   pthread_mutex_lock( &mSignalStateMutex );
+   mSignalStateSequence++;
+   __sync_synchronize();
+
+   sGobiSignalState & state = mSignalState;
+   if (bSig == true)
+   {
+      if ((state.mValid & (ULONG)eGOBI_SIGNAL_STRENGTHS) == 0)
       {
-         if (mpFNMobileIPStatus != 0)
+         state.mSignalCount = 0;
+      }
+
+      // Strengths are kept ordered by radio interface
+      ULONG s = 0;
+      while (s < state.mSignalCount && state.mSignalRadioIfaces[s] < radioVal)
+      {
+         s++;
+      }
+
+      if (s < state.mSignalCount && state.mSignalRadioIfaces[s] == radioVal)
+      {
+         ULONG band = GetSignalBand( &mMonitorThresholds[0],
+                                     mMonitorThresholdCount,
+                                     mMonitorHysteresis,
+                                     state.mSignalBands[s],
+                                     sigVal );
+
+         bNotify = (band != state.mSignalBands[s]);
+         state.mSignalStrengths[s] = sigVal;
+         state.mSignalBands[s] = band;
+      }
+      else if (state.mSignalCount < GOBI_SNAPSHOT_MAX_SIGNALS)
+      {
+         for (ULONG m = state.mSignalCount; m > s; m--)
          {
-            cMobileIPStatusCallback * pCB = 0;
-            pCB = new cMobileIPStatusCallback( mpFNMobileIPStatus, 
-                                               pf[0].mValue.mU32 );
+            state.mSignalStrengths[m] = state.mSignalStrengths[m - 1];
+            state.mSignalRadioIfaces[m] = state.mSignalRadioIfaces[m - 1];
+            state.mSignalBands[m] = state.mSignalBands[m - 1];
+         }
+
+         state.mSignalStrengths[s] = sigVal;
+         state.mSignalRadioIfaces[s] = radioVal;
+         state.mSignalBands[s] = GetSignalBand( &mMonitorThresholds[0],
+                                                mMonitorThresholdCount,
+                                                0,
+                                                0,
+                                                sigVal );
+         state.mSignalCount++;
+         bNotify = true;
+      }
+
+      state.mValid |= (ULONG)eGOBI_SIGNAL_STRENGTHS;
+   }
+
+   if (bRF == true)
+   {
+      state.mRFInfoCount = (BYTE)rfCount;
+      for (ULONG r = 0; r < rfCount; r++)
+      {
+         state.mRFRadioIfaces[r] = rfRadios[r];
+         state.mRFBandClasses[r] = rfBandClasses[r];
+         state.mRFChannels[r] = rfChannels[r];
+      }
+
+      state.mValid |= (ULONG)eGOBI_SIGNAL_RF_INFO;
+   }
+
+   state.mReports++;
+   state.mReceived = GetTickCount();
+
+   __sync_synchronize();
+   mSignalStateSequence++;
+
+   tFNSignalStrength pCallback = mpFNSignalMonitor;
+   pthread_mutex_unlock( &mSignalStateMutex );
+
+   if (bNotify == true && pCallback != 0)
+   {
+      cSignalStrengthCallback * pCB = 0;
+      pCB = new cSignalStrengthCallback( pCallback, sigVal, radioVal );
+      if (pCB != 0)
+      {
+         if (mCallbackPool.Submit( pCB ) == false)
+         {
+            delete pCB;
+         }
+      }
+   }
+}
+
+/*===========================================================================
+METHOD:
+   PublishServingSystem (Internal Method)
+
+DESCRIPTION:
+   Fold a NAS serving system indication into the signal state (the 
+   roaming indicator and current PLMN are kept when not included)
+
+PARAMETERS:
+   buf         [ I ] - QMI buffer to process
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiConnectionMgmt::PublishServingSystem( const sProtocolBuffer & buf )
+{
+   cQMIViewNASServingSystemInd ind( buf );
+
+   cQMIViewNASServingSystemInd::sServingSystem ss;
+   cQMIViewNASServingSystemInd::tServingSystemRadioInterfaces radios;
+   BYTE regState = 0;
+   BYTE csState = 0;
+   BYTE psState = 0;
+   BYTE ran = 0;
+   if ( (ind.GetServingSystem( ss ) == false)
+   ||   (ss.GetRegistrationState( regState ) == false)
+   ||   (ss.GetCSAttachState( csState ) == false)
+   ||   (ss.GetPSAttachState( psState ) == false)
+   ||   (ss.GetSelectedNetwork( ran ) == false)
+   ||   (ss.GetRadioInterfaces( radios ) == false) )
+   {
+      return;
+   }
 
-            if (pCB != 0)
-            {
-               if (pCB->Initialize() == false)
-               {
-                  delete pCB;
-               }
-            }
-         }
-      }
+   ULONG radioCount = radios.GetCount();
+   if (radioCount > (ULONG)GOBI_SNAPSHOT_MAX_RADIO_IFACES)
+   {
+      radioCount = (ULONG)GOBI_SNAPSHOT_MAX_RADIO_IFACES;
    }
-   else if (msgID == eQMI_WDS_PKT_STATUS_IND)
+
+   BYTE roaming = 0;
+   bool bRoaming = ind.GetRoamingIndicator( roaming );
+
+   cQMIViewNASServingSystemInd::sCurrentPLMN plmn;
+   WORD mcc = 0;
+   WORD mnc = 0;
+   sQMIView desc;
+   bool bPLMN = ( (ind.GetCurrentPLMN( plmn ) == true)
+              &&  (plmn.GetMCC( mcc ) == true)
+              &&  (plmn.GetMNC( mnc ) == true)
+              &&  (plmn.GetDescription( desc ) == true) );
+
+   pthread_mutex_lock( &mSignalStateMutex );
+   mSignalStateSequence++;
+   __sync_synchronize();
+
+   sGobiSignalState & state = mSignalState;
+   if ((state.mValid & (ULONG)eGOBI_SIGNAL_SERVING_NETWORK) == 0)
    {
-      // Prepare TLVs for parsing
-      std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiBuf );
+      state.mRoaming = ULONG_MAX;
+      state.mMCC = USHRT_MAX;
+      state.mMNC = USHRT_MAX;
+      state.mNetworkName[0] = 0;
+   }
 
-      // Parse out session status
-      sProtocolEntityKey tlvKey( eDB2_ET_QMI_WDS_IND, msgID, 1 );
-      cDataParser::tParsedFields pf = ParseTLV( mDB, buf, tlvs, tlvKey );
-      if (pf.size() >= 1)
+   state.mRegistrationState = (ULONG)regState;
+   state.mCSDomain = (ULONG)csState;
+   state.mPSDomain = (ULONG)psState;
+   state.mRAN = (ULONG)ran;
+   state.mRadioIfaceCount = (BYTE)radioCount;
+   for (ULONG r = 0; r < radioCount; r++)
+   {
+      INT8 radio = 0;
+      radios.GetElement( r, radio );
+      state.mRadioIfaces[r] = (ULONG)(BYTE)radio;
+   }
+
+   if (bRoaming == true)
+   {
+      state.mRoaming = (ULONG)roaming;
+   }
+
+   if (bPLMN == true)
+   {
+      state.mMCC = mcc;
+      state.mMNC = mnc;
+
+      ULONG nameLen = desc.GetSize();
+      if (nameLen >= (ULONG)GOBI_SNAPSHOT_NAME_SZ)
       {
-         ULONG ss = pf[0].mValue.mU32;
-         ULONG cer = ULONG_MAX;
+         nameLen = (ULONG)GOBI_SNAPSHOT_NAME_SZ - 1;
+      }
 
-         // Parse out call end reason (if present)
-         tlvKey = sProtocolEntityKey( eDB2_ET_QMI_WDS_IND, msgID, 16 );
-         pf = ParseTLV( mDB, buf, tlvs, tlvKey );
-         if (pf.size() >= 1)
-         {
-            cer = pf[0].mValue.mU32;
-         }
+      memcpy( (LPVOID)&state.mNetworkName[0], 
+              (LPCVOID)desc.GetData(), 
+              (size_t)nameLen );
 
-         if (mpFNSessionState != 0)
+      state.mNetworkName[nameLen] = 0;
+   }
+
+   state.mValid |= (ULONG)eGOBI_SIGNAL_SERVING_NETWORK;
+   state.mReports++;
+   state.mReceived = GetTickCount();
+
+   __sync_synchronize();
+   mSignalStateSequence++;
+   pthread_mutex_unlock( &mSignalStateMutex );
+}
+
+/*===========================================================================
+METHOD:
+   GetCurrentSignalState (Internal Method)
+
+DESCRIPTION:
+   Return the signal state if the signal monitor is running and the given
+   values are present
+
+PARAMETERS:
+   valid       [ I ] - Values needed (eGobiSignalStateValid)
+   state       [ O ] - The signal state
+
+RETURN VALUE:
+   bool - Can the values be served from the signal state?
+===========================================================================*/
+bool cGobiConnectionMgmt::GetCurrentSignalState( 
+   ULONG                      valid,
+   sGobiSignalState &         state )
+{
+   if (mbSignalMonitor == false || GetSignalState( state ) == false)
+   {
+      return false;
+   }
+
+   return ((state.mValid & valid) == valid);
+}
+
+/*===========================================================================
+METHOD:
+   ProcessCATBuffer (Internal Method)
+
+DESCRIPTION:
+   Process a CAT buffer
+
+PARAMETERS:
+   buf         [ I ] - QMI buffer to process
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiConnectionMgmt::ProcessCATBuffer( const sProtocolBuffer & buf )
+{
+   sQMIServiceBuffer qmiBuf( buf.GetSharedBuffer() );   
+   if (qmiBuf.IsValid() == false)
+   {
+      return;
+   }
+
+   // Indication?
+   if (qmiBuf.IsIndication() == false)
+   {
+      return;
+   }
+
+   // Do we even care?
+   ULONG msgID = qmiBuf.GetMessageID();
+   if (msgID == (ULONG)eQMI_CAT_EVENT_IND && mpFNCATEvent != 0)
+   {
+      // Prepare TLVs for extraction
+      cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiBuf );
+
+      ULONG tlvCount = (ULONG)tlvs.size();
+      for (ULONG t = 0; t < tlvCount; t++)
+      {
+         const sDB2NavInput tlv = tlvs[t];
+         if (tlv.mKey.size() == 3)
          {
-            cSessionStateCallback * pCB = 0;
-            pCB = new cSessionStateCallback( mpFNSessionState, ss, cer );
+            cCATEventCallback * pCB = 0;
+            pCB = new cCATEventCallback( mpFNCATEvent, 
+                                         tlv.mKey[2],
+                                         tlv.mPayloadLen,
+                                         tlv.mpPayload );
+
             if (pCB != 0)
             {
-               if (pCB->Initialize() == false)
+               if (mCallbackPool.Submit( pCB ) == false)
                {
                   delete pCB;
                }
@@ -781,10 +2946,10 @@ void cGobiConnectionMgmt::ProcessWDSBuffer( const sProtocolBuffer & buf )
 
 /*===========================================================================
 METHOD:
-   ProcessDMSBuffer (Internal Method)
+   ProcessOMABuffer (Internal Method)
 
 DESCRIPTION:
-   Process a DMS buffer
+   Process an OMA buffer
 
 PARAMETERS:
    buf         [ I ] - QMI buffer to process
@@ -792,7 +2957,7 @@ PARAMETERS:
 RETURN VALUE:
    None
 ===========================================================================*/
-void cGobiConnectionMgmt::ProcessDMSBuffer( const sProtocolBuffer & buf )
+void cGobiConnectionMgmt::ProcessOMABuffer( const sProtocolBuffer & buf )
 {
    sQMIServiceBuffer qmiBuf( buf.GetSharedBuffer() );   
    if (qmiBuf.IsValid() == false)
@@ -804,74 +2969,100 @@ void cGobiConnectionMgmt::ProcessDMSBuffer( const sProtocolBuffer & buf )
    if (qmiBuf.IsIndication() == false)
    {
       return;
-   } 
+   }
 
    // Do we even care?
    ULONG msgID = qmiBuf.GetMessageID();
-   if (msgID == eQMI_DMS_EVENT_IND)
+   if (msgID == (ULONG)eQMI_OMA_EVENT_IND)
    {
       // Prepare TLVs for parsing
-      std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiBuf );
+      cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiBuf );
 
-      // Parse out activation status
-      sProtocolEntityKey tlvKey( eDB2_ET_QMI_DMS_IND, msgID, 19 );
+      bool bNIA = false;
+      ULONG niaSessionType = ULONG_MAX;
+      USHORT niaSessionID = USHRT_MAX;
+
+      // Parse out NIA
+      sProtocolEntityKey tlvKey( eDB2_ET_QMI_OMA_IND, msgID, 16 );
       cDataParser::tParsedFields pf = ParseTLV( mDB, buf, tlvs, tlvKey );
-      if (pf.size() >= 1 && mpFNActivationStatus != 0)
+      if (pf.size() >= 2)
       {
-         cActivationStatusCallback * pCB = 0;
-         pCB = new cActivationStatusCallback( mpFNActivationStatus, 
-                                              pf[0].mValue.mU32 );
+         bNIA = true;
+         niaSessionType = pf[0].mValue.mU32;
+         niaSessionID = pf[1].mValue.mU16;
 
-         if (pCB != 0)
+         if (mpFNOMADMAlert != 0)
          {
-            if (pCB->Initialize() == false)
+            cOMADMAlertCallback * pCB = 0;
+            pCB = new cOMADMAlertCallback( mpFNOMADMAlert, 
+                                           pf[0].mValue.mU32,
+                                           pf[1].mValue.mU16 );
+
+            if (pCB != 0)
             {
-               delete pCB;
+               if (mCallbackPool.Submit( pCB ) == false)
+               {
+                  delete pCB;
+               }
             }
          }
       }
 
-      // Parse out operating mode
-      tlvKey = sProtocolEntityKey( eDB2_ET_QMI_DMS_IND, msgID, 20 );
+      // Parse out failure reason (may not be present)
+      ULONG failureReason = ULONG_MAX;
+      tlvKey = sProtocolEntityKey( eDB2_ET_QMI_OMA_IND, msgID, 18 );
       pf = ParseTLV( mDB, buf, tlvs, tlvKey );
-      if (pf.size() >= 1 && mpFNPower != 0)
+      if (pf.size() >= 1)
       {
-         cPowerCallback * pCB = 0;
-         pCB = new cPowerCallback( mpFNPower, pf[0].mValue.mU32 );
-         if (pCB != 0)
-         {
-            if (pCB->Initialize() == false)
-            {
-               delete pCB;
-            }
-         }
+         failureReason = pf[0].mValue.mU32;
       }
+         
+      bool bState = false;
+      ULONG sessionState = ULONG_MAX;
 
-      // Parse out wireless disable state
-      tlvKey = sProtocolEntityKey( eDB2_ET_QMI_DMS_IND, msgID, 22 );
+      // Parse out state
+      tlvKey = sProtocolEntityKey( eDB2_ET_QMI_OMA_IND, msgID, 17 );
       pf = ParseTLV( mDB, buf, tlvs, tlvKey );
-      if (pf.size() >= 1 && mpFNWirelessDisable != 0)
+      if (pf.size() >= 1)
       {
-         cWirelessDisableCallback * pCB = 0;
-         pCB = new cWirelessDisableCallback( mpFNWirelessDisable, 
-                                             pf[0].mValue.mU32 );
-         if (pCB != 0)
+         bState = true;
+         sessionState = pf[0].mValue.mU32;
+
+         if (mpFNOMADMState != 0)
          {
-            if (pCB->Initialize() == false)
+            cOMADMStateCallback * pCB = 0;
+            pCB = new cOMADMStateCallback( mpFNOMADMState, 
+                                           pf[0].mValue.mU32,
+                                           failureReason );
+
+            if (pCB != 0)
             {
-               delete pCB;
+               if (mCallbackPool.Submit( pCB ) == false)
+               {
+                  delete pCB;
+               }
             }
          }
       }
+
+      if (mbOMADMTracker == true && (bNIA == true || bState == true))
+      {
+         PublishOMADMEvent( bNIA, 
+                            niaSessionType, 
+                            niaSessionID, 
+                            bState,
+                            sessionState, 
+                            failureReason );
+      }
    }
 }
 
 /*===========================================================================
 METHOD:
-   ProcessNASBuffer (Internal Method)
+   ProcessVoiceBuffer (Internal Method)
 
 DESCRIPTION:
-   Process a NAS buffer
+   Process a voice buffer
 
 PARAMETERS:
    buf         [ I ] - QMI buffer to process
@@ -879,7 +3070,7 @@ PARAMETERS:
 RETURN VALUE:
    None
 ===========================================================================*/
-void cGobiConnectionMgmt::ProcessNASBuffer( const sProtocolBuffer & buf )
+void cGobiConnectionMgmt::ProcessVoiceBuffer( const sProtocolBuffer & buf )
 {
    sQMIServiceBuffer qmiBuf( buf.GetSharedBuffer() );   
    if (qmiBuf.IsValid() == false)
@@ -891,175 +3082,136 @@ void cGobiConnectionMgmt::ProcessNASBuffer( const sProtocolBuffer & buf )
    if (qmiBuf.IsIndication() == false)
    {
       return;
-   } 
+   }
 
    // Do we even care?
    ULONG msgID = qmiBuf.GetMessageID();
-   if (msgID == (ULONG)eQMI_NAS_EVENT_IND)
+   if (msgID == (ULONG)eQMI_VOICE_USSD_RELEASE_IND && mpFNUSSDRelease != 0)
    {
-      // Prepare TLVs for parsing
-      std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiBuf );
-
-      // Parse signal strength
-      sProtocolEntityKey tlvKey( eDB2_ET_QMI_NAS_IND, msgID, 16 );
-      cDataParser::tParsedFields pf = ParseTLV( mDB, buf, tlvs, tlvKey );
-      if (pf.size() >= 2)
+      cUSSDReleaseCallback * pCB = 0;
+      pCB = new cUSSDReleaseCallback( mpFNUSSDRelease );
+      if (pCB != 0)
       {
-         INT8 sigVal = pf[0].mValue.mS8;
-         ULONG radioVal = pf[1].mValue.mU32;
-         bool bValidSig = (sigVal <= -30 && sigVal > -125 && radioVal != 0);
-
-         if (bValidSig == true && mpFNSignalStrength != 0)
+         if (mCallbackPool.Submit( pCB ) == false)
          {
-            cSignalStrengthCallback * pCB = 0;
-            pCB = new cSignalStrengthCallback( mpFNSignalStrength, 
-                                               pf[0].mValue.mS8,
-                                               pf[1].mValue.mU32 );
-
-            if (pCB != 0)
-            {
-               if (pCB->Initialize() == false)
-               {
-                  delete pCB;
-               }
-            }
+            delete pCB;
          }
       }
 
-      // Parse out RF info
-      sProtocolEntityKey tlvKey2( eDB2_ET_QMI_NAS_IND, msgID, 17 );
-      cDataParser::tParsedFields pf2 = ParseTLV( mDB, buf, tlvs, tlvKey2 );
+   }
+   else if (msgID == (ULONG)eQMI_VOICE_USSD_IND && mpFNUSSDNotification != 0)
+   {
+      // Prepare TLVs for extraction
+      cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiBuf );
+      const sQMIContents & tlvMap = qmiBuf.GetContents();
 
-      ULONG fieldCount = (ULONG)pf2.size();
-      if (fieldCount >= 1 && mpFNRFInfo != 0)
+      // Parse out message details
+      sProtocolEntityKey tlvKey( eDB2_ET_QMI_VOICE_IND, msgID, 1 );
+      cDataParser::tParsedFields pf = ParseTLV( mDB, buf, tlvs, tlvKey );
+      if (pf.size() >= 1)
       {
-         BYTE ifaceCount = pf2[0].mValue.mU8;
-         if (fieldCount >= 1 + ((ULONG)ifaceCount * 3))
+         const BYTE * pUSSData = 0;
+
+         const sQMIRawContentHeader * pHdr = 0;
+         pHdr = tlvMap.Find( 16 );
+         if (pHdr != 0)
          {
-            for (BYTE i = 0; i < ifaceCount; i++)
+            ULONG len = (ULONG)pHdr->mLength;
+            if (len >= (ULONG)2)
             {
-               ULONG offset = 3 * (ULONG)i;
-
-               cRFInfoCallback * pCB = 0;
-               pCB = new cRFInfoCallback( mpFNRFInfo, 
-                                          pf2[offset + 1].mValue.mU32,
-                                          pf2[offset + 2].mValue.mU32,
-                                          (ULONG)pf2[offset + 3].mValue.mU16 );
-
-               if (pCB != 0)
+               const BYTE * pData = (const BYTE *)++pHdr;
+               if (len >= (ULONG)pData[1] + (ULONG)2)
                {
-                  if (pCB->Initialize() == false)
-                  {
-                     delete pCB;
-                  }
+                  pUSSData = pData;
                }
             }
          }
-      }
 
-      // Parse out LU reject
-      sProtocolEntityKey tlvKey3( eDB2_ET_QMI_NAS_IND, msgID, 18 );
-      cDataParser::tParsedFields pf3 = ParseTLV( mDB, buf, tlvs, tlvKey3 );
-      if (pf3.size() >= 2 && mpFNLUReject != 0)
-      {
-         cLURejectCallback * pCB = 0;
-         pCB = new cLURejectCallback( mpFNLUReject, 
-                                      pf3[0].mValue.mU32,
-                                      (ULONG)pf3[1].mValue.mU16 );
+         cUSSDNotificationCallback * pCB = 0;
+         pCB = new cUSSDNotificationCallback( mpFNUSSDNotification, 
+                                              pf[0].mValue.mU32,
+                                              pUSSData );
 
          if (pCB != 0)
          {
-            if (pCB->Initialize() == false)
+            if (mCallbackPool.Submit( pCB ) == false)
             {
                delete pCB;
             }
          }
       }
+   }
+   else if ( (msgID == (ULONG)eQMI_VOICE_ASYNC_USSD_IND) 
+        &&   (mpFNUSSDOrigination != 0) )
+   {
+      // Prepare TLVs for extraction
+      cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiBuf );
+      const sQMIContents & tlvMap = qmiBuf.GetContents();
+
+      ULONG ec = ULONG_MAX;
+      ULONG fc = ULONG_MAX;
+
+      // Parse out message details
+      sProtocolEntityKey tlvKey( eDB2_ET_QMI_VOICE_IND, msgID, 16 );
+      cDataParser::tParsedFields pf = ParseTLV( mDB, buf, tlvs, tlvKey );
+      if (pf.size() >= 1)
+      {
+         ec = pf[0].mValue.mU32;
+      }
+
+      tlvKey = sProtocolEntityKey( eDB2_ET_QMI_VOICE_IND, msgID, 17 );
+      pf = ParseTLV( mDB, buf, tlvs, tlvKey );
+      if (pf.size() >= 1)
+      {
+         fc = pf[0].mValue.mU32;
+      }
 
-   }
-   else if (msgID == (ULONG)eQMI_NAS_SS_INFO_IND)
-   {
-      // Prepare TLVs for parsing
-      std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiBuf );
+      const BYTE * pNetworkInfo = 0;
 
-      // Parse out roaming indicator
-      sProtocolEntityKey tlvKey1( eDB2_ET_QMI_NAS_IND, msgID, 16 );
-      cDataParser::tParsedFields pf1 = ParseTLV( mDB, buf, tlvs, tlvKey1 );
-      if (pf1.size() >= 1)
+      const sQMIRawContentHeader * pHdr = 0;
+      pHdr = tlvMap.Find( 18 );
+      if (pHdr != 0)
       {
-         if (mpFNRoamingIndicator != 0)
+         ULONG len = (ULONG)pHdr->mLength;
+         if (len >= (ULONG)2)
          {
-            cRoamingIndicatorCallback * pCB = 0;
-            pCB = new cRoamingIndicatorCallback( mpFNRoamingIndicator, 
-                                                 pf1[0].mValue.mU32 );
-
-            if (pCB != 0)
+            const BYTE * pData = (const BYTE *)++pHdr;
+            if (len >= (ULONG)pData[1] + (ULONG)2)
             {
-               if (pCB->Initialize() == false)
-               {
-                  delete pCB;
-               }
+               pNetworkInfo = pData;
             }
          }
       }
 
-      // Parse out data capabilities
-      sProtocolEntityKey tlvKey2( eDB2_ET_QMI_NAS_IND, msgID, 17 );
-      cDataParser::tParsedFields pf2 = ParseTLV( mDB, buf, tlvs, tlvKey2 );
-      if (pf2.size() >= 1)
+      const BYTE * pAlpha = 0;
+
+      pHdr = tlvMap.Find( 19 );
+      if (pHdr != 0)
       {
-         BYTE activeDataCaps = pf2[0].mValue.mU8;
-         if (pf2.size() >= 1 + (ULONG)activeDataCaps)
+         ULONG len = (ULONG)pHdr->mLength;
+         if (len >= (ULONG)2)
          {
-            ULONG caps[12] = { 0 };
-            if (activeDataCaps > 12)
-            {
-               activeDataCaps = 12;
-            }
-
-            for (ULONG d = 0; d < activeDataCaps; d++)
-            {
-               caps[d] = pf2[1 + d].mValue.mU32;
-            }
-
-            if (mpFNDataCapabilities != 0)
+            const BYTE * pData = (const BYTE *)++pHdr;
+            if (len >= (ULONG)pData[1] + (ULONG)2)
             {
-               cDataCapabilitiesCallback * pCB = 0;
-               pCB = new cDataCapabilitiesCallback( mpFNDataCapabilities, 
-                                                    activeDataCaps, 
-                                                    &caps[0] );
-
-               if (pCB != 0)
-               {
-                  if (pCB->Initialize() == false)
-                  {
-                     delete pCB;
-                  }
-               }
+               pAlpha = pData;
             }
          }
       }
-   }
-   else if (msgID == (ULONG)eQMI_NAS_PLMN_MODE_IND)
-   {
-      // Prepare TLVs for parsing
-      std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiBuf );
 
-      // Parse PLMN mode
-      sProtocolEntityKey tlvKey( eDB2_ET_QMI_NAS_IND, msgID, 16 );
-      cDataParser::tParsedFields pf = ParseTLV( mDB, buf, tlvs, tlvKey );
-      if (pf.size() >= 1)
-      {  
-         cPLMNModeCallback * pCB = 0;
-         pCB = new cPLMNModeCallback( mpPLMNMode, 
-                                      (ULONG)pf[0].mValue.mU8 );
 
-         if (pCB != 0)
+      cUSSDOriginationCallback * pCB = 0;
+      pCB = new cUSSDOriginationCallback( mpFNUSSDOrigination, 
+                                          ec,
+                                          fc,
+                                          pNetworkInfo,
+                                          pAlpha );
+
+      if (pCB != 0)
+      {
+         if (mCallbackPool.Submit( pCB ) == false)
          {
-            if (pCB->Initialize() == false)
-            {
-               delete pCB;
-            }
+            delete pCB;
          }
       }
    }
@@ -1067,565 +3219,713 @@ void cGobiConnectionMgmt::ProcessNASBuffer( const sProtocolBuffer & buf )
 
 /*===========================================================================
 METHOD:
-   ProcessWMSBuffer (Internal Method)
+   Connect (Public Method)
 
 DESCRIPTION:
-   Process a WDS buffer
+   Connect to the specified (or first detected) Gobi device
 
 PARAMETERS:
-   buf         [ I ] - QMI buffer to process
-
+   pDeviceNode   [ I ] - The device node
+   pDeviceKey    [ I ] - The device key (unique, stored on-device)
+  
 RETURN VALUE:
-   None
+   bool
 ===========================================================================*/
-void cGobiConnectionMgmt::ProcessWMSBuffer( const sProtocolBuffer & buf )
+bool cGobiConnectionMgmt::Connect(
+   LPCSTR                    pDeviceNode,
+   LPCSTR                    pDeviceKey )
 {
-   sQMIServiceBuffer qmiBuf( buf.GetSharedBuffer() );   
-   if (qmiBuf.IsValid() == false)
-   {
-      return;
-   }
+   pthread_mutex_lock( &mConnectMutex );
 
-   // Indication?
-   if (qmiBuf.IsIndication() == false)
+   // An explicit connection replaces any pending reconnection
+   mLostDevice = tDeviceID();
+
+   // Assume failure
+   bool bRC = cGobiQMICore::Connect( pDeviceNode, pDeviceKey );
+   if (bRC == true)
    {
-      return;
+      StartTraffic();
    }
 
-   // Do we even care?
-   ULONG msgID = qmiBuf.GetMessageID();
-   if (msgID == (ULONG)eQMI_WMS_EVENT_IND)
-   {
-      // Prepare TLVs for parsing
-      std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiBuf );
+   pthread_mutex_unlock( &mConnectMutex );
+   return bRC;
+}
 
-      // Parse out message details
-      sProtocolEntityKey tlvKey( eDB2_ET_QMI_WMS_IND, msgID, 16 );
-      cDataParser::tParsedFields pf = ParseTLV( mDB, buf, tlvs, tlvKey );
-      if (pf.size() >= 2)
-      {
-         if (mpFNNewSMS != 0)
-         {
-            cNewSMSCallback * pCB = 0;
-            pCB = new cNewSMSCallback( mpFNNewSMS, 
-                                       pf[0].mValue.mU32,
-                                       pf[1].mValue.mU32 );
+/*===========================================================================
+METHOD:
+   Disconnect (Public Method)
 
-            if (pCB != 0)
-            {
-               if (pCB->Initialize() == false)
-               {
-                  delete pCB;
-               }
-            }
-         }
-      }
-   }
+DESCRIPTION:
+   Disconnect from the currently connected Gobi device
+  
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cGobiConnectionMgmt::Disconnect()
+{
+   pthread_mutex_lock( &mConnectMutex );
+
+   // Nothing to restore on the next connection
+   mLostDevice = tDeviceID();
+
+   pthread_mutex_lock( &mRegistrationsMutex );
+   mRegistrations.clear();
+   pthread_mutex_unlock( &mRegistrationsMutex );
+
+   // Clear all callback function pointers (no need to turn them off at
+   // the device as we are about to tear-down each QMI service client)
+   mpFNSessionState = 0;
+   mpFNByteTotals = 0;
+   mpFNDataCapabilities = 0;
+   mpFNDataBearer = 0;
+   mpFNDormancyStatus = 0;
+   mpFNMobileIPStatus = 0;
+   mpFNActivationStatus = 0;
+   mpFNPower = 0;
+   mpFNWirelessDisable = 0;
+   mpFNRoamingIndicator = 0;
+   mpFNSignalStrength = 0;
+   mpFNRFInfo = 0;
+   mpFNLUReject = 0;
+   mpPLMNMode = 0;
+   mpFNNewSMS = 0;
+   mpFNNewNMEA = 0;
+   mpFNPDSState = 0;
+   mpFNCATEvent = 0;
+   mpFNOMADMAlert = 0;
+   mpFNOMADMState = 0;
+   mpFNUSSDRelease = 0;
+   mpFNUSSDNotification = 0;
+   mpFNUSSDOrigination = 0;
+   mbPositionStream = false;
+   mSessionStatsInterval = 0;
+   mbSignalMonitor = false;
+   mpFNSignalMonitor = 0;
+   mSignalThresholds.clear();
+   mbOMADMTracker = false;
+   UpdateIndicationTables();
+
+   // Release anyone waiting on a position report
+   pthread_mutex_lock( &mPositionMutex );
+   pthread_cond_broadcast( &mPositionCond );
+   pthread_mutex_unlock( &mPositionMutex );
+
+   // ... or on an OMA-DM session
+   pthread_mutex_lock( &mOMADMMutex );
+   pthread_cond_broadcast( &mOMADMCond );
+   pthread_mutex_unlock( &mOMADMMutex );
+
+   bool bRC = Teardown();
+
+   pthread_mutex_unlock( &mConnectMutex );
+   return bRC;
 }
 
 /*===========================================================================
 METHOD:
-   ProcessPDSBuffer (Internal Method)
+   StartTraffic (Internal Method)
 
 DESCRIPTION:
-   Process a PDS buffer
-
-PARAMETERS:
-   buf         [ I ] - QMI buffer to process
+   Start the traffic processing thread
 
+SEQUENCING:
+   mConnectMutex must be held
+  
 RETURN VALUE:
    None
 ===========================================================================*/
-void cGobiConnectionMgmt::ProcessPDSBuffer( const sProtocolBuffer & buf )
+void cGobiConnectionMgmt::StartTraffic()
 {
-   sQMIServiceBuffer qmiBuf( buf.GetSharedBuffer() );   
-   if (qmiBuf.IsValid() == false)
-   {
-      return;
-   }
+   // Clear mExitEvent;
+   mExitEvent.Clear();
+
+   // Pool threads are started upon first use
+   mCallbackPool.SetThreadConfig( mThreadConfig );
+   mParsePool.SetThreadConfig( mThreadConfig );
+
+   mThreadConfig.CreateThread( eTHREAD_ROLE_TRAFFIC,
+                               &mThreadID,
+                               TrafficProcessThread,
+                               this );
+                   
+   mbThreadStarted = true;
+}
 
-   // Indication?
-   if (qmiBuf.IsIndication() == false)
-   {
-      return;
-   }
+/*===========================================================================
+METHOD:
+   Teardown (Internal Method)
 
-   // Do we even care?
-   ULONG msgID = qmiBuf.GetMessageID();
-   if (msgID == (ULONG)eQMI_PDS_EVENT_IND)
+DESCRIPTION:
+   Stop the traffic processing thread and disconnect the servers, the
+   callbacks are left as they are
+
+SEQUENCING:
+   mConnectMutex must be held
+  
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cGobiConnectionMgmt::Teardown()
+{
+   // Exit traffic processing thread
+   if (mbThreadStarted == true)
    {
-      // Prepare TLVs for extraction
-      std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiBuf );
+      // Signal thread to exit
+      mExitEvent.Set( 0 );
 
-      sProtocolEntityKey tlvKey( eDB2_ET_QMI_PDS_IND, msgID, 16 );
-      cDataParser::tParsedFields pf = ParseTLV( mDB, buf, tlvs, tlvKey );
-      if (pf.size() >= 1 && mpFNNewNMEA != 0)
+      // If we are not being called from the thread itself then wait for
+      // it to exit, if not then it will have to exit automatically
+      if (pthread_self() != mThreadID)
       {
-         cNewNMEACallback * pCB = 0;
-         pCB = new cNewNMEACallback( mpFNNewNMEA, pf[0].mValueString );
-         if (pCB != 0)
+         if (mThreadID != 0)
          {
-            if (pCB->Initialize() == false)
-            {
-               delete pCB;
-            }
+            pthread_join( mThreadID, NULL );
          }
       }
    }
-   else if (msgID == (ULONG)eQMI_PDS_STATE_IND)
+
+   // Clear out thread handle/ID
+   mbThreadStarted = false;
+   mThreadID = 0;
+
+   // Parse what the traffic processing thread handed over
+   mParsePool.Exit();
+
+   bool bRC = cGobiQMICore::Disconnect();
+
+   // Servers reset server logs so we need to reset our counters
+   std::map <eQMIService, sIndicationTable>::iterator pTable;
+   pTable = mIndications.begin();
+   while (pTable != mIndications.end())
    {
-      // Prepare TLVs for extraction
-      std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiBuf );
+      pTable->second.mItemsProcessed = 0;
+      pTable++;
+   }
 
-      // Parse out message details
-      sProtocolEntityKey tlvKey( eDB2_ET_QMI_PDS_IND, msgID, 1 );
-      cDataParser::tParsedFields pf = ParseTLV( mDB, buf, tlvs, tlvKey );
-      if (pf.size() >= 2 && mpFNPDSState != 0)
-      {
-         cPDSStateCallback * pCB = 0;
-         pCB = new cPDSStateCallback( mpFNPDSState, 
-                                      pf[0].mValue.mU32,
-                                      pf[1].mValue.mU32 );
+   return bRC;
+}
 
-         if (pCB != 0)
-         {
-            if (pCB->Initialize() == false)
-            {
-               delete pCB;
-            }
-         }
+/*===========================================================================
+METHOD:
+   SetAutoReconnect (Public Method)
+
+DESCRIPTION:
+   Reconnect automatically when the device node of the connected device 
+   goes away (modem reset, USB re-enumeration) and comes back, the servers
+   are then brought up again and the cached indication registrations are
+   sent again, so that every callback keeps working without having to be 
+   set again.  The device manager's monitor thread watches for the device
+   node, automatic reconnection therefore requires a device manager
+
+PARAMETERS:
+   bEnable     [ I ] - Reconnect automatically?
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cGobiConnectionMgmt::SetAutoReconnect( bool bEnable )
+{
+   if (bEnable == mbAutoReconnect)
+   {
+      return true;
+   }
+
+   if (bEnable == true)
+   {
+      if (mpManager == 0 || mpManager->AddDeviceCallback( &mReconnector ) == false)
+      {
+         return false;
       }
+
+      mbAutoReconnect = true;
+      return true;
    }
+
+   // Once this returns the callback is no longer run
+   mpManager->RemoveDeviceCallback( &mReconnector );
+   mbAutoReconnect = false;
+
+   pthread_mutex_lock( &mConnectMutex );
+   mLostDevice = tDeviceID();
+   pthread_mutex_unlock( &mConnectMutex );
+
+   return true;
 }
 
 /*===========================================================================
 METHOD:
-   ProcessCATBuffer (Internal Method)
+   SendRegistration (Internal Method)
 
 DESCRIPTION:
-   Process a CAT buffer
+   Send an indication registration request and wait for (and then 
+   validate) the response, a successful request is cached so that it can
+   be sent again upon reconnection
 
 PARAMETERS:
-   buf         [ I ] - QMI buffer to process
+   svc         [ I ] - QMI service type
+   pRequest    [ I ] - Request to send
 
 RETURN VALUE:
-   None
+   eGobiError - Return code
 ===========================================================================*/
-void cGobiConnectionMgmt::ProcessCATBuffer( const sProtocolBuffer & buf )
+eGobiError cGobiConnectionMgmt::SendRegistration(
+   eQMIService                svc,
+   sSharedBuffer *            pRequest )
 {
-   sQMIServiceBuffer qmiBuf( buf.GetSharedBuffer() );   
-   if (qmiBuf.IsValid() == false)
-   {
-      return;
-   }
+   // Hold on to the request for the cache
+   sProtocolBuffer req( pRequest );
 
-   // Indication?
-   if (qmiBuf.IsIndication() == false)
+   eGobiError rc = SendAndCheckReturn( svc, pRequest );
+   if (rc == eGOBI_ERR_NONE)
    {
-      return;
+      RecordRegistration( svc, req );
    }
 
-   // Do we even care?
-   ULONG msgID = qmiBuf.GetMessageID();
-   if (msgID == (ULONG)eQMI_CAT_EVENT_IND && mpFNCATEvent != 0)
-   {
-      // Prepare TLVs for extraction
-      std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiBuf );
-
-      ULONG tlvCount = (ULONG)tlvs.size();
-      for (ULONG t = 0; t < tlvCount; t++)
-      {
-         const sDB2NavInput tlv = tlvs[t];
-         if (tlv.mKey.size() == 3)
-         {
-            cCATEventCallback * pCB = 0;
-            pCB = new cCATEventCallback( mpFNCATEvent, 
-                                         tlv.mKey[2],
-                                         tlv.mPayloadLen,
-                                         tlv.mpPayload );
-
-            if (pCB != 0)
-            {
-               if (pCB->Initialize() == false)
-               {
-                  delete pCB;
-               }
-            }
-         }
-      }
-   }
+   return rc;
 }
 
 /*===========================================================================
 METHOD:
-   ProcessOMABuffer (Internal Method)
+   RecordRegistration (Internal Method)
 
 DESCRIPTION:
-   Process an OMA buffer
+   Cache the TLVs of a successful registration request, a TLV replaces the
+   cached TLV with the same type ID (of the same service/message ID)
 
 PARAMETERS:
-   buf         [ I ] - QMI buffer to process
+   svc         [ I ] - QMI service type
+   req         [ I ] - The request
 
 RETURN VALUE:
    None
 ===========================================================================*/
-void cGobiConnectionMgmt::ProcessOMABuffer( const sProtocolBuffer & buf )
+void cGobiConnectionMgmt::RecordRegistration(
+   eQMIService                svc,
+   const sProtocolBuffer &    req )
 {
-   sQMIServiceBuffer qmiBuf( buf.GetSharedBuffer() );   
-   if (qmiBuf.IsValid() == false)
+   sQMIServiceBuffer qmiReq( req.GetSharedBuffer() );
+   if (qmiReq.IsValid() == false)
    {
       return;
    }
 
-   // Indication?
-   if (qmiBuf.IsIndication() == false)
+   tRegistrationKey key( svc, (WORD)qmiReq.GetMessageID() );
+   const sQMIContents & tlvs = qmiReq.GetContents();
+
+   pthread_mutex_lock( &mRegistrationsMutex );
+
+   tRegistrationTLVs & cached = mRegistrations[key];
+   for (ULONG id = tlvs.GetNextID( 0 ); 
+        id < QMI_MAX_CONTENT_IDS; 
+        id = tlvs.GetNextID( id + 1 ))
    {
-      return;
+      const sQMIRawContentHeader * pTLV = tlvs.Find( id );
+      const BYTE * pData = (const BYTE *)pTLV;
+      ULONG sz = (ULONG)sizeof( sQMIRawContentHeader ) + pTLV->mLength;
+
+      cached[(BYTE)id].assign( pData, pData + sz );
    }
 
-   // Do we even care?
-   ULONG msgID = qmiBuf.GetMessageID();
-   if (msgID == (ULONG)eQMI_OMA_EVENT_IND)
+   pthread_mutex_unlock( &mRegistrationsMutex );
+}
+
+/*===========================================================================
+METHOD:
+   RestoreRegistrations (Internal Method)
+
+DESCRIPTION:
+   Send the cached registrations again, the TLVs cached for each 
+   service/message ID are merged into a single request and the requests 
+   of each service are sent at once (see SendBatch()), all services at 
+   the same time
+
+RETURN VALUE:
+   eGobiError - Return code (the first failure)
+===========================================================================*/
+eGobiError cGobiConnectionMgmt::RestoreRegistrations()
+{
+   std::map <eQMIService, std::vector <sSharedBuffer *> > requests;
+   std::vector <sProtocolBuffer> held;
+
+   pthread_mutex_lock( &mRegistrationsMutex );
+
+   std::map <tRegistrationKey, tRegistrationTLVs>::const_iterator pReg;
+   for (pReg = mRegistrations.begin(); pReg != mRegistrations.end(); pReg++)
    {
-      // Prepare TLVs for parsing
-      std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiBuf );
+      std::vector <BYTE> payload;
 
-      // Parse out NIA
-      sProtocolEntityKey tlvKey( eDB2_ET_QMI_OMA_IND, msgID, 16 );
-      cDataParser::tParsedFields pf = ParseTLV( mDB, buf, tlvs, tlvKey );
-      if (pf.size() >= 2)
+      tRegistrationTLVs::const_iterator pTLV = pReg->second.begin();
+      while (pTLV != pReg->second.end())
       {
-         if (mpFNOMADMAlert != 0)
-         {
-            cOMADMAlertCallback * pCB = 0;
-            pCB = new cOMADMAlertCallback( mpFNOMADMAlert, 
-                                           pf[0].mValue.mU32,
-                                           pf[1].mValue.mU16 );
+         payload.insert( payload.end(), 
+                         pTLV->second.begin(), 
+                         pTLV->second.end() );
 
-            if (pCB != 0)
-            {
-               if (pCB->Initialize() == false)
-               {
-                  delete pCB;
-               }
-            }
-         }
+         pTLV++;
       }
 
-      // Parse out failure reason (may not be present)
-      ULONG failureReason = ULONG_MAX;
-      tlvKey = sProtocolEntityKey( eDB2_ET_QMI_OMA_IND, msgID, 18 );
-      pf = ParseTLV( mDB, buf, tlvs, tlvKey );
-      if (pf.size() >= 1)
+      if (payload.size() == 0)
       {
-         failureReason = pf[0].mValue.mU32;
+         continue;
       }
-         
-      // Parse out state
-      tlvKey = sProtocolEntityKey( eDB2_ET_QMI_OMA_IND, msgID, 17 );
-      pf = ParseTLV( mDB, buf, tlvs, tlvKey );
-      if (pf.size() >= 1)
+
+      sSharedBuffer * pReq = 0;
+      pReq = sQMIServiceBuffer::BuildBuffer( pReg->first.first,
+                                             pReg->first.second,
+                                             false,
+                                             false,
+                                             &payload[0],
+                                             (ULONG)payload.size() );
+
+      if (pReq != 0)
       {
-         if (mpFNOMADMState != 0)
+         requests[pReg->first.first].push_back( pReq );
+         held.push_back( sProtocolBuffer( pReq ) );
+      }
+   }
+
+   pthread_mutex_unlock( &mRegistrationsMutex );
+
+   eGobiError rc = eGOBI_ERR_NONE;
+   cGobiQMIResponseCollector collector;
+   std::vector <ULONG> handles;
+
+   std::map <eQMIService, std::vector <sSharedBuffer *> >::iterator pSvc;
+   for (pSvc = requests.begin(); pSvc != requests.end(); pSvc++)
+   {
+      std::vector <ULONG> svcHandles;
+      eGobiError ec = SendBatch( pSvc->first,
+                                 pSvc->second,
+                                 DEFAULT_GOBI_QMI_TIMEOUT,
+                                 &collector,
+                                 svcHandles );
+
+      if (ec != eGOBI_ERR_NONE && rc == eGOBI_ERR_NONE)
+      {
+         rc = ec;
+      }
+
+      handles.insert( handles.end(), svcHandles.begin(), svcHandles.end() );
+   }
+
+   collector.Wait( handles );
+
+   ULONG handleCount = (ULONG)handles.size();
+   for (ULONG h = 0; h < handleCount; h++)
+   {
+      if (handles[h] == INVALID_GOBI_SEND_HANDLE)
+      {
+         continue;
+      }
+
+      sProtocolBuffer rsp;
+      eGobiError ec = collector.GetResponse( handles[h], rsp );
+      if (ec == eGOBI_ERR_NONE)
+      {
+         sQMIServiceBuffer qmiRsp( rsp.GetSharedBuffer() );
+
+         ULONG qmiRC = 0;
+         ULONG qmiEC = 0;
+         if ( (qmiRsp.IsValid() == false)
+         ||   (qmiRsp.GetResult( qmiRC, qmiEC ) == false) )
          {
-            cOMADMStateCallback * pCB = 0;
-            pCB = new cOMADMStateCallback( mpFNOMADMState, 
-                                           pf[0].mValue.mU32,
-                                           failureReason );
+            ec = eGOBI_ERR_MALFORMED_RSP;
+         }
+         else if (qmiRC != 0)
+         {
+            ec = GetCorrectedQMIError( qmiEC );
+         }
+      }
 
-            if (pCB != 0)
-            {
-               if (pCB->Initialize() == false)
-               {
-                  delete pCB;
-               }
-            }
+      if (ec != eGOBI_ERR_NONE)
+      {
+         TRACE( "cGobiConnectionMgmt::RestoreRegistrations(), error %d\n",
+                (int)ec );
+
+         if (rc == eGOBI_ERR_NONE)
+         {
+            rc = ec;
          }
       }
    }
+
+   return rc;
 }
 
 /*===========================================================================
 METHOD:
-   ProcessVoiceBuffer (Internal Method)
+   DeviceDeparted (Internal Method)
 
 DESCRIPTION:
-   Process a voice buffer
+   A device node has gone away, if it is that of the connected device the
+   servers are taken down (keeping the callbacks and the cached 
+   registrations) until the device comes back
 
 PARAMETERS:
-   buf         [ I ] - QMI buffer to process
+   device      [ I ] - The device (node and key)
 
 RETURN VALUE:
    None
 ===========================================================================*/
-void cGobiConnectionMgmt::ProcessVoiceBuffer( const sProtocolBuffer & buf )
+void cGobiConnectionMgmt::DeviceDeparted( const tDeviceID & device )
 {
-   sQMIServiceBuffer qmiBuf( buf.GetSharedBuffer() );   
-   if (qmiBuf.IsValid() == false)
+   pthread_mutex_lock( &mConnectMutex );
+
+   if (mDeviceNode.size() > 0 && device.first == mDeviceNode)
    {
-      return;
+      TRACE( "cGobiConnectionMgmt, %s gone, awaiting its return\n",
+             mDeviceNode.c_str() );
+
+      mLostDevice = tDeviceID( mDeviceNode, mDeviceKey );
+      Teardown();
    }
 
-   // Indication?
-   if (qmiBuf.IsIndication() == false)
+   pthread_mutex_unlock( &mConnectMutex );
+}
+
+/*===========================================================================
+METHOD:
+   DeviceReturned (Internal Method)
+
+DESCRIPTION:
+   A device node has come (back), if it is that of the lost device (and
+   the device key, when known, still matches) the servers are brought up 
+   again, each on its own thread (see cGobiQMICore::Connect()), and the 
+   cached registrations are restored
+
+PARAMETERS:
+   device      [ I ] - The device (node and key)
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiConnectionMgmt::DeviceReturned( const tDeviceID & device )
+{
+   pthread_mutex_lock( &mConnectMutex );
+
+   const tDeviceID & lost = mLostDevice;
+   if ( (lost.first.size() == 0)
+   ||   (device.first != lost.first)
+   ||   ( (lost.second.size() > 0)
+      &&  (device.second.size() > 0)
+      &&  (device.second != lost.second) ) )
    {
+      pthread_mutex_unlock( &mConnectMutex );
       return;
    }
 
-   // Do we even care?
-   ULONG msgID = qmiBuf.GetMessageID();
-   if (msgID == (ULONG)eQMI_VOICE_USSD_RELEASE_IND && mpFNUSSDRelease != 0)
+   LPCSTR pKey = 0;
+   if (lost.second.size() > 0)
    {
-      cUSSDReleaseCallback * pCB = 0;
-      pCB = new cUSSDReleaseCallback( mpFNUSSDRelease );
-      if (pCB != 0)
-      {
-         if (pCB->Initialize() == false)
-         {
-            delete pCB;
-         }
-      }
-
+      pKey = lost.second.c_str();
    }
-   else if (msgID == (ULONG)eQMI_VOICE_USSD_IND && mpFNUSSDNotification != 0)
+
+   if (cGobiQMICore::Connect( lost.first.c_str(), pKey ) == false)
    {
-      // Prepare TLVs for extraction
-      std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiBuf );
-      std::map <ULONG, const sQMIRawContentHeader *> tlvMap;
-      tlvMap = qmiBuf.GetContents();
+      // Try again should the device be reported again
+      TRACE( "cGobiConnectionMgmt, %s back, unable to reconnect\n",
+             lost.first.c_str() );
 
-      // Parse out message details
-      sProtocolEntityKey tlvKey( eDB2_ET_QMI_VOICE_IND, msgID, 1 );
-      cDataParser::tParsedFields pf = ParseTLV( mDB, buf, tlvs, tlvKey );
-      if (pf.size() >= 1)
-      {
-         const BYTE * pUSSData = 0;
+      pthread_mutex_unlock( &mConnectMutex );
+      return;
+   }
 
-         std::map <ULONG, const sQMIRawContentHeader *>::const_iterator pIter;
-         pIter = tlvMap.find( 16 );
-         if (pIter != tlvMap.end())
-         {
-            const sQMIRawContentHeader * pHdr = pIter->second;
-            ULONG len = (ULONG)pHdr->mLength;
-            if (len >= (ULONG)2)
-            {
-               const BYTE * pData = (const BYTE *)++pHdr;
-               if (len >= (ULONG)pData[1] + (ULONG)2)
-               {
-                  pUSSData = pData;
-               }
-            }
-         }
+   mLostDevice = tDeviceID();
+   StartTraffic();
 
-         cUSSDNotificationCallback * pCB = 0;
-         pCB = new cUSSDNotificationCallback( mpFNUSSDNotification, 
-                                              pf[0].mValue.mU32,
-                                              pUSSData );
+   // A registration that fails to restore is traced by
+   // RestoreRegistrations(), the device stays connected regardless
+   RestoreRegistrations();
+   TRACE( "cGobiConnectionMgmt, %s reconnected\n",
+          mDeviceNode.c_str() );
 
-         if (pCB != 0)
-         {
-            if (pCB->Initialize() == false)
-            {
-               delete pCB;
-            }
-         }
-      }
-   }
-   else if ( (msgID == (ULONG)eQMI_VOICE_ASYNC_USSD_IND) 
-        &&   (mpFNUSSDOrigination != 0) )
-   {
-      // Prepare TLVs for extraction
-      std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiBuf );
-      std::map <ULONG, const sQMIRawContentHeader *> tlvMap;
-      tlvMap = qmiBuf.GetContents();
+   pthread_mutex_unlock( &mConnectMutex );
+}
 
-      ULONG ec = ULONG_MAX;
-      ULONG fc = ULONG_MAX;
+/*===========================================================================
+METHOD:
+   SetSessionStateCallback (Public Method)
 
-      // Parse out message details
-      sProtocolEntityKey tlvKey( eDB2_ET_QMI_VOICE_IND, msgID, 16 );
-      cDataParser::tParsedFields pf = ParseTLV( mDB, buf, tlvs, tlvKey );
-      if (pf.size() >= 1)
-      {
-         ec = pf[0].mValue.mU32;
-      }
+DESCRIPTION:
+   Enable/disable session state callback function
+  
+PARAMETERS:
+   pCallback   [ I ] - Callback function
+
+RETURN VALUE:
+   eGobiError - Return code
+===========================================================================*/
+eGobiError cGobiConnectionMgmt::SetSessionStateCallback(
+   tFNSessionState            pCallback )
+{
+   // We don't have to register for anything so a simple assignment works
+   mpFNSessionState = pCallback;
+   UpdateIndicationTables();
+   return eGOBI_ERR_NONE;
+}
+
+/*===========================================================================
+METHOD:
+   SetByteTotalsCallback
+
+DESCRIPTION:
+   This function enables/disables the RX/TX byte counts callback function
+
+PARAMETERS:
+   pCallback   [ I ] - Callback function (0 = disable)
+   interval    [ I ] - Interval in seconds (ignored when disabling)
+
+RETURN VALUE:
+   eGobiError - Return code
+===========================================================================*/
+eGobiError cGobiConnectionMgmt::SetByteTotalsCallback( 
+   tFNByteTotals              pCallback,
+   BYTE                       interval )
+{
+   // Assume failure
+   eGobiError rc = eGOBI_ERR_GENERAL;
 
-      tlvKey = sProtocolEntityKey( eDB2_ET_QMI_VOICE_IND, msgID, 17 );
-      pf = ParseTLV( mDB, buf, tlvs, tlvKey );
-      if (pf.size() >= 1)
+   // Something changing?
+   bool bOn = (pCallback != 0 && mpFNByteTotals == 0);
+   bool bOff = (pCallback == 0 && mpFNByteTotals != 0);
+   bool bReplace = (pCallback != 0 && mpFNByteTotals != 0);
+   if (bOn == true || bOff == true)
+   {
+      // Turning on/off (the session statistics reports already carry the
+      // byte totals, at their own interval)
+      if (mSessionStatsInterval != 0)
       {
-         fc = pf[0].mValue.mU32;
+         rc = eGOBI_ERR_NONE;
       }
-
-      const BYTE * pNetworkInfo = 0;
-
-      std::map <ULONG, const sQMIRawContentHeader *>::const_iterator pIter;
-      pIter = tlvMap.find( 18 );
-      if (pIter != tlvMap.end())
+      else if (bOn == true)
       {
-         const sQMIRawContentHeader * pHdr = pIter->second;
-         ULONG len = (ULONG)pHdr->mLength;
-         if (len >= (ULONG)2)
-         {
-            const BYTE * pData = (const BYTE *)++pHdr;
-            if (len >= (ULONG)pData[1] + (ULONG)2)
-            {
-               pNetworkInfo = pData;
-            }
-         }
+         rc = SendStatisticsReport( interval, false );
       }
-
-      const BYTE * pAlpha = 0;
-
-      pIter = tlvMap.find( 19 );
-      if (pIter != tlvMap.end())
+      else
       {
-         const sQMIRawContentHeader * pHdr = pIter->second;
-         ULONG len = (ULONG)pHdr->mLength;
-         if (len >= (ULONG)2)
-         {
-            const BYTE * pData = (const BYTE *)++pHdr;
-            if (len >= (ULONG)pData[1] + (ULONG)2)
-            {
-               pAlpha = pData;
-            }
-         }
+         rc = SendStatisticsReport( 0, false );
       }
 
-
-      cUSSDOriginationCallback * pCB = 0;
-      pCB = new cUSSDOriginationCallback( mpFNUSSDOrigination, 
-                                          ec,
-                                          fc,
-                                          pNetworkInfo,
-                                          pAlpha );
-
-      if (pCB != 0)
+      if (rc == eGOBI_ERR_NONE || bOff == true)
       {
-         if (pCB->Initialize() == false)
-         {
-            delete pCB;
-         }
+         mpFNByteTotals = pCallback;
+         mByteTotalsInterval = interval;
+         UpdateIndicationTables();
       }
    }
+   else if (bReplace == true)
+   {
+      // We don't have to register for anything so a simple assignment works
+      mpFNByteTotals = pCallback;
+      UpdateIndicationTables();
+      rc = eGOBI_ERR_NONE;
+   }
+   else
+   {
+      // Turning it off redundantly
+      rc = eGOBI_ERR_NONE;
+   }
+
+   return rc;
 }
 
 /*===========================================================================
 METHOD:
-   Connect (Public Method)
+   SetDataCapabilitiesCallback (Public Method)
 
 DESCRIPTION:
-   Connect to the specified (or first detected) Gobi device
-
-PARAMETERS:
-   pDeviceNode   [ I ] - The device node
-   pDeviceKey    [ I ] - The device key (unique, stored on-device)
+   Enables/disables the serving system data capabilities callback
   
+PARAMETERS:
+   pCallback   [ I ] - Callback function
+
 RETURN VALUE:
-   bool
+   eGobiError - Corrected error code
 ===========================================================================*/
-bool cGobiConnectionMgmt::Connect(
-   LPCSTR                    pDeviceNode,
-   LPCSTR                    pDeviceKey )
+eGobiError cGobiConnectionMgmt::SetDataCapabilitiesCallback( 
+   tFNDataCapabilities        pCallback )
 {
-   // Assume failure
-   bool bRC = cGobiQMICore::Connect( pDeviceNode, pDeviceKey );
-   if (bRC == true)
-   {
-      // Clear mExitEvent;
-      mExitEvent.Clear();
-
-      pthread_create( &mThreadID,
-                      NULL,
-                      TrafficProcessThread,
-                      this );
-                      
-      mbThreadStarted = true;
-   }
-
-   return bRC;
+   // We don't have to register for anything so a simple assignment works
+   mpFNDataCapabilities = pCallback;
+   UpdateIndicationTables();
+   return eGOBI_ERR_NONE;
 }
 
 /*===========================================================================
 METHOD:
-   Disconnect (Public Method)
+   SetDataBearerCallback (Public Method)
 
 DESCRIPTION:
-   Disconnect from the currently connected Gobi device
+   Enable/disable data bearer callback function
   
+PARAMETERS:
+   pCallback   [ I ] - Callback function
+
 RETURN VALUE:
-   bool
+   eGobiError - Return cod
 ===========================================================================*/
-bool cGobiConnectionMgmt::Disconnect()
+eGobiError cGobiConnectionMgmt::SetDataBearerCallback( 
+   tFNDataBearer              pCallback )
 {
-   // Clear all callback function pointers (no need to turn them off at
-   // the device as we are about to tear-down each QMI service client)
-   mpFNSessionState = 0;
-   mpFNByteTotals = 0;
-   mpFNDataCapabilities = 0;
-   mpFNDataBearer = 0;
-   mpFNDormancyStatus = 0;
-   mpFNMobileIPStatus = 0;
-   mpFNActivationStatus = 0;
-   mpFNPower = 0;
-   mpFNWirelessDisable = 0;
-   mpFNRoamingIndicator = 0;
-   mpFNSignalStrength = 0;
-   mpFNRFInfo = 0;
-   mpFNLUReject = 0;
-   mpPLMNMode = 0;
-   mpFNNewSMS = 0;
-   mpFNNewNMEA = 0;
-   mpFNPDSState = 0;
-   mpFNCATEvent = 0;
-   mpFNOMADMAlert = 0;
-   mpFNOMADMState = 0;
-   mpFNUSSDRelease = 0;
-   mpFNUSSDNotification = 0;
-   mpFNUSSDOrigination = 0;
+   // Assume failure
+   eGobiError rc = eGOBI_ERR_GENERAL;
 
-   // Exit traffic processing thread
-   if (mbThreadStarted == true)
+   // Something changing?
+   bool bOn = (pCallback != 0 && mpFNDataBearer == 0);
+   bool bOff = (pCallback == 0 && mpFNDataBearer != 0);
+   bool bReplace = (pCallback != 0 && mpFNDataBearer != 0);
+   if (bOn == true || bOff == true)
    {
-      // Signal thread to exit
-      mExitEvent.Set( 0 );
+      // Turning on/off
+      eQMIService svc = eQMI_SVC_WDS;
+      WORD msgID = (WORD)eQMI_WDS_SET_EVENT;
+      sSharedBuffer * pReq = 0;
 
-      // If we are not being called from the thread itself then wait for
-      // it to exit, if not then it will have to exit automatically
-      if (pthread_self() != mThreadID)
+      std::vector <sDB2PackingInput> piv;
+      sProtocolEntityKey pek( eDB2_ET_QMI_WDS_REQ, msgID, 18 );
+
+      if (bOn == true)
       {
-         if (mThreadID != 0)
-         {
-            pthread_join( mThreadID, NULL );
-         }
+         sDB2PackingInput pi( pek, "1" ); 
+         piv.push_back( pi );
+      }
+      else
+      {
+         sDB2PackingInput pi( pek, "0" ); 
+         piv.push_back( pi );
       }
-   }
-
-   // Clear out thread handle/ID
-   mbThreadStarted = false;
-   mThreadID = 0;
 
-   bool bRC = cGobiQMICore::Disconnect();
+      pReq = DB2PackQMIBuffer( mDB, piv );
 
-   // Servers reset server logs so we need to reset our counters
-   mWDSItemsProcessed = 0;
-   mDMSItemsProcessed = 0;
-   mNASItemsProcessed = 0;
-   mWMSItemsProcessed = 0;
-   mPDSItemsProcessed = 0;
-   mCATItemsProcessed = 0;
-   mOMAItemsProcessed = 0;
-   mVoiceItemsProcessed = 0;
+      rc = SendRegistration( svc, pReq );
+      if (rc == eGOBI_ERR_NONE || bOff == true)
+      {
+         mpFNDataBearer = pCallback;
+         UpdateIndicationTables();
+      }
+   }
+   else if (bReplace == true)
+   {
+      // We don't have to register for anything so a simple assignment works
+      mpFNDataBearer = pCallback;
+      UpdateIndicationTables();
+      rc = eGOBI_ERR_NONE;
+   }
+   else
+   {
+      // Turning it off redundantly
+      rc = eGOBI_ERR_NONE;
+   }
 
-   return bRC;
+   return rc;
 }
 
 /*===========================================================================
 METHOD:
-   SetSessionStateCallback (Public Method)
+   SetDormancyStatusCallback (Public Method)
 
 DESCRIPTION:
-   Enable/disable session state callback function
+   Enable/disable dormancy status callback function
   
 PARAMETERS:
    pCallback   [ I ] - Callback function
@@ -1633,39 +3933,85 @@ PARAMETERS:
 RETURN VALUE:
    eGobiError - Return code
 ===========================================================================*/
-eGobiError cGobiConnectionMgmt::SetSessionStateCallback(
-   tFNSessionState            pCallback )
+eGobiError cGobiConnectionMgmt::SetDormancyStatusCallback( 
+   tFNDormancyStatus          pCallback )
 {
-   // We don't have to register for anything so a simple assignment works
-   mpFNSessionState = pCallback;
-   return eGOBI_ERR_NONE;
+   // Assume failure
+   eGobiError rc = eGOBI_ERR_GENERAL;
+
+   // Something changing?
+   bool bOn = (pCallback != 0 && mpFNDormancyStatus == 0);
+   bool bOff = (pCallback == 0 && mpFNDormancyStatus != 0);
+   bool bReplace = (pCallback != 0 && mpFNDormancyStatus != 0);
+   if (bOn == true || bOff == true)
+   {
+      // Turning on/off
+      eQMIService svc = eQMI_SVC_WDS;
+      WORD msgID = (WORD)eQMI_WDS_SET_EVENT;
+      sSharedBuffer * pReq = 0;
+
+      std::vector <sDB2PackingInput> piv;
+      sProtocolEntityKey pek( eDB2_ET_QMI_WDS_REQ, msgID, 19 );
+
+      if (bOn == true)
+      {
+         sDB2PackingInput pi( pek, "1" ); 
+         piv.push_back( pi );
+      }
+      else
+      {
+         sDB2PackingInput pi( pek, "0" ); 
+         piv.push_back( pi );
+      }
+
+      pReq = DB2PackQMIBuffer( mDB, piv );
+
+      rc = SendRegistration( svc, pReq );
+      if (rc == eGOBI_ERR_NONE || bOff == true)
+      {
+         mpFNDormancyStatus = pCallback;
+         UpdateIndicationTables();
+      }
+   }
+   else if (bReplace == true)
+   {
+      // We don't have to register for anything so a simple assignment works
+      mpFNDormancyStatus = pCallback;
+      UpdateIndicationTables();
+      rc = eGOBI_ERR_NONE;
+   }
+   else
+   {
+      // Turning it off redundantly
+      rc = eGOBI_ERR_NONE;
+   }
+
+   return rc;
 }
 
 /*===========================================================================
 METHOD:
-   SetByteTotalsCallback
+   SetMobileIPStatusCallback (Public Method)
 
 DESCRIPTION:
-   This function enables/disables the RX/TX byte counts callback function
-
+   Enable/disable mobile IP status callback function
+  
 PARAMETERS:
-   pCallback   [ I ] - Callback function (0 = disable)
-   interval    [ I ] - Interval in seconds (ignored when disabling)
+   pCallback   [ I ] - Callback function
 
 RETURN VALUE:
    eGobiError - Return code
 ===========================================================================*/
-eGobiError cGobiConnectionMgmt::SetByteTotalsCallback( 
-   tFNByteTotals              pCallback,
-   BYTE                       interval )
+eGobiError cGobiConnectionMgmt::SetMobileIPStatusCallback( 
+   tFNMobileIPStatus          pCallback )
 {
    // Assume failure
    eGobiError rc = eGOBI_ERR_GENERAL;
 
    // Something changing?
-   bool bOn = (pCallback != 0 && mpFNByteTotals == 0);
-   bool bOff = (pCallback == 0 && mpFNByteTotals != 0);
-   bool bReplace = (pCallback != 0 && mpFNByteTotals != 0);
+   bool bOn = (pCallback != 0 && mpFNMobileIPStatus == 0);
+   bool bOff = (pCallback == 0 && mpFNMobileIPStatus != 0);
+   bool bReplace = (pCallback != 0 && mpFNMobileIPStatus != 0);
    if (bOn == true || bOff == true)
    {
       // Turning on/off
@@ -1674,33 +4020,33 @@ eGobiError cGobiConnectionMgmt::SetByteTotalsCallback(
       sSharedBuffer * pReq = 0;
 
       std::vector <sDB2PackingInput> piv;
-      sProtocolEntityKey pek( eDB2_ET_QMI_WDS_REQ, msgID, 17 );
+      sProtocolEntityKey pek( eDB2_ET_QMI_WDS_REQ, msgID, 20 );
 
       if (bOn == true)
       {
-         std::ostringstream tmp;
-         tmp << (ULONG)interval << " 0 0 0 0 0 0 1 1";
-         sDB2PackingInput pi( pek, (LPCSTR)tmp.str().c_str() ); 
+         sDB2PackingInput pi( pek, "1" ); 
          piv.push_back( pi );
       }
       else
       {
-         sDB2PackingInput pi( pek, "0 0 0 0 0 0 0 0 0" ); 
+         sDB2PackingInput pi( pek, "0" ); 
          piv.push_back( pi );
       }
 
       pReq = DB2PackQMIBuffer( mDB, piv );
 
-      rc = SendAndCheckReturn( svc, pReq );
+      rc = SendRegistration( svc, pReq );
       if (rc == eGOBI_ERR_NONE || bOff == true)
       {
-         mpFNByteTotals = pCallback;
+         mpFNMobileIPStatus = pCallback;
+         UpdateIndicationTables();
       }
    }
    else if (bReplace == true)
    {
       // We don't have to register for anything so a simple assignment works
-      mpFNByteTotals = pCallback;
+      mpFNMobileIPStatus = pCallback;
+      UpdateIndicationTables();
       rc = eGOBI_ERR_NONE;
    }
    else
@@ -1714,57 +4060,105 @@ eGobiError cGobiConnectionMgmt::SetByteTotalsCallback(
 
 /*===========================================================================
 METHOD:
-   SetDataCapabilitiesCallback (Public Method)
+   SetActivationStatusCallback (Public Method)
 
 DESCRIPTION:
-   Enables/disables the serving system data capabilities callback
+   Enable/disable activation status callback function
   
 PARAMETERS:
    pCallback   [ I ] - Callback function
 
 RETURN VALUE:
-   eGobiError - Corrected error code
+   eGobiError - Return code
 ===========================================================================*/
-eGobiError cGobiConnectionMgmt::SetDataCapabilitiesCallback( 
-   tFNDataCapabilities        pCallback )
+eGobiError cGobiConnectionMgmt::SetActivationStatusCallback( 
+   tFNActivationStatus        pCallback )
 {
-   // We don't have to register for anything so a simple assignment works
-   mpFNDataCapabilities = pCallback;
-   return eGOBI_ERR_NONE;
+   // Assume failure
+   eGobiError rc = eGOBI_ERR_GENERAL;
+
+   // Something changing?
+   bool bOn = (pCallback != 0 && mpFNActivationStatus == 0);
+   bool bOff = (pCallback == 0 && mpFNActivationStatus != 0);
+   bool bReplace = (pCallback != 0 && mpFNActivationStatus != 0);
+   if (bOn == true || bOff == true)
+   {
+      // Turning on/off
+      eQMIService svc = eQMI_SVC_DMS;
+      WORD msgID = (WORD)eQMI_DMS_SET_EVENT;
+      sSharedBuffer * pReq = 0;
+
+      std::vector <sDB2PackingInput> piv;
+      sProtocolEntityKey pek( eDB2_ET_QMI_DMS_REQ, msgID, 19 );
+
+      if (bOn == true)
+      {
+         sDB2PackingInput pi( pek, "1" ); 
+         piv.push_back( pi );
+      }
+      else
+      {
+         sDB2PackingInput pi( pek, "0" ); 
+         piv.push_back( pi );
+      }
+
+      pReq = DB2PackQMIBuffer( mDB, piv );
+
+      rc = SendRegistration( svc, pReq );
+      if (rc == eGOBI_ERR_NONE || bOff == true)
+      {
+         mpFNActivationStatus = pCallback;
+         UpdateIndicationTables();
+      }
+   }
+   else if (bReplace == true)
+   {
+      // We don't have to register for anything so a simple assignment works
+      mpFNActivationStatus = pCallback;
+      UpdateIndicationTables();
+      rc = eGOBI_ERR_NONE;
+   }
+   else
+   {
+      // Turning it off redundantly
+      rc = eGOBI_ERR_NONE;
+   }
+
+   return rc;
 }
 
 /*===========================================================================
 METHOD:
-   SetDataBearerCallback (Public Method)
+   SetPowerCallback (Public Method)
 
 DESCRIPTION:
-   Enable/disable data bearer callback function
+   Enable/disable power operating mode callback function
   
 PARAMETERS:
    pCallback   [ I ] - Callback function
 
 RETURN VALUE:
-   eGobiError - Return cod
+   eGobiError - Return code
 ===========================================================================*/
-eGobiError cGobiConnectionMgmt::SetDataBearerCallback( 
-   tFNDataBearer              pCallback )
+eGobiError cGobiConnectionMgmt::SetPowerCallback( 
+   tFNPower                   pCallback )
 {
    // Assume failure
    eGobiError rc = eGOBI_ERR_GENERAL;
 
    // Something changing?
-   bool bOn = (pCallback != 0 && mpFNDataBearer == 0);
-   bool bOff = (pCallback == 0 && mpFNDataBearer != 0);
-   bool bReplace = (pCallback != 0 && mpFNDataBearer != 0);
+   bool bOn = (pCallback != 0 && mpFNPower == 0);
+   bool bOff = (pCallback == 0 && mpFNPower != 0);
+   bool bReplace = (pCallback != 0 && mpFNPower != 0);
    if (bOn == true || bOff == true)
    {
       // Turning on/off
-      eQMIService svc = eQMI_SVC_WDS;
-      WORD msgID = (WORD)eQMI_WDS_SET_EVENT;
+      eQMIService svc = eQMI_SVC_DMS;
+      WORD msgID = (WORD)eQMI_DMS_SET_EVENT;
       sSharedBuffer * pReq = 0;
 
       std::vector <sDB2PackingInput> piv;
-      sProtocolEntityKey pek( eDB2_ET_QMI_WDS_REQ, msgID, 18 );
+      sProtocolEntityKey pek( eDB2_ET_QMI_DMS_REQ, msgID, 20 );
 
       if (bOn == true)
       {
@@ -1779,16 +4173,18 @@ eGobiError cGobiConnectionMgmt::SetDataBearerCallback(
 
       pReq = DB2PackQMIBuffer( mDB, piv );
 
-      rc = SendAndCheckReturn( svc, pReq );
+      rc = SendRegistration( svc, pReq );
       if (rc == eGOBI_ERR_NONE || bOff == true)
       {
-         mpFNDataBearer = pCallback;
+         mpFNPower = pCallback;
+         UpdateIndicationTables();
       }
    }
    else if (bReplace == true)
    {
       // We don't have to register for anything so a simple assignment works
-      mpFNDataBearer = pCallback;
+      mpFNPower = pCallback;
+      UpdateIndicationTables();
       rc = eGOBI_ERR_NONE;
    }
    else
@@ -1802,10 +4198,10 @@ eGobiError cGobiConnectionMgmt::SetDataBearerCallback(
 
 /*===========================================================================
 METHOD:
-   SetDormancyStatusCallback (Public Method)
+   SetWirelessDisableCallback (Public Method)
 
 DESCRIPTION:
-   Enable/disable dormancy status callback function
+   Enable/disable wireless disable state callback function
   
 PARAMETERS:
    pCallback   [ I ] - Callback function
@@ -1813,25 +4209,25 @@ PARAMETERS:
 RETURN VALUE:
    eGobiError - Return code
 ===========================================================================*/
-eGobiError cGobiConnectionMgmt::SetDormancyStatusCallback( 
-   tFNDormancyStatus          pCallback )
+eGobiError cGobiConnectionMgmt::SetWirelessDisableCallback( 
+   tFNWirelessDisable         pCallback )
 {
    // Assume failure
    eGobiError rc = eGOBI_ERR_GENERAL;
 
    // Something changing?
-   bool bOn = (pCallback != 0 && mpFNDormancyStatus == 0);
-   bool bOff = (pCallback == 0 && mpFNDormancyStatus != 0);
-   bool bReplace = (pCallback != 0 && mpFNDormancyStatus != 0);
+   bool bOn = (pCallback != 0 && mpFNWirelessDisable == 0);
+   bool bOff = (pCallback == 0 && mpFNWirelessDisable != 0);
+   bool bReplace = (pCallback != 0 && mpFNWirelessDisable != 0);
    if (bOn == true || bOff == true)
    {
       // Turning on/off
-      eQMIService svc = eQMI_SVC_WDS;
-      WORD msgID = (WORD)eQMI_WDS_SET_EVENT;
+      eQMIService svc = eQMI_SVC_DMS;
+      WORD msgID = (WORD)eQMI_DMS_SET_EVENT;
       sSharedBuffer * pReq = 0;
 
       std::vector <sDB2PackingInput> piv;
-      sProtocolEntityKey pek( eDB2_ET_QMI_WDS_REQ, msgID, 19 );
+      sProtocolEntityKey pek( eDB2_ET_QMI_DMS_REQ, msgID, 22 );
 
       if (bOn == true)
       {
@@ -1846,16 +4242,18 @@ eGobiError cGobiConnectionMgmt::SetDormancyStatusCallback(
 
       pReq = DB2PackQMIBuffer( mDB, piv );
 
-      rc = SendAndCheckReturn( svc, pReq );
+      rc = SendRegistration( svc, pReq );
       if (rc == eGOBI_ERR_NONE || bOff == true)
       {
-         mpFNDormancyStatus = pCallback;
+         mpFNWirelessDisable = pCallback;
+         UpdateIndicationTables();
       }
    }
    else if (bReplace == true)
    {
       // We don't have to register for anything so a simple assignment works
-      mpFNDormancyStatus = pCallback;
+      mpFNWirelessDisable = pCallback;
+      UpdateIndicationTables();
       rc = eGOBI_ERR_NONE;
    }
    else
@@ -1869,60 +4267,145 @@ eGobiError cGobiConnectionMgmt::SetDormancyStatusCallback(
 
 /*===========================================================================
 METHOD:
-   SetMobileIPStatusCallback (Public Method)
+   SetRoamingIndicatorCallback (Public Method)
 
 DESCRIPTION:
-   Enable/disable mobile IP status callback function
+   Enable/disable roaming indicator callback function
+  
+PARAMETERS:
+   pCallback   [ I ] - Callback function
+
+RETURN VALUE:
+   eGobiError - Corrected error code
+===========================================================================*/
+eGobiError cGobiConnectionMgmt::SetRoamingIndicatorCallback( 
+   tFNRoamingIndicator        pCallback )
+{
+   // We don't have to register for anything so a simple assignment works
+   mpFNRoamingIndicator = pCallback;
+   UpdateIndicationTables();
+   return eGOBI_ERR_NONE;
+}
+
+/*===========================================================================
+METHOD:
+   SetSignalStrengthCallback (Public Method)
+
+DESCRIPTION:
+   Enable/disable signal strength callback function
   
 PARAMETERS:
    pCallback   [ I ] - Callback function
+   thresholds  [ I ] - Desired threholds (only valid when enabling)
 
 RETURN VALUE:
    eGobiError - Return code
 ===========================================================================*/
-eGobiError cGobiConnectionMgmt::SetMobileIPStatusCallback( 
-   tFNMobileIPStatus          pCallback )
+eGobiError cGobiConnectionMgmt::SetSignalStrengthCallback( 
+   tFNSignalStrength          pCallback,
+   std::list <INT8>           thresholds )
 {
    // Assume failure
    eGobiError rc = eGOBI_ERR_GENERAL;
 
-   // Something changing?
-   bool bOn = (pCallback != 0 && mpFNMobileIPStatus == 0);
-   bool bOff = (pCallback == 0 && mpFNMobileIPStatus != 0);
-   bool bReplace = (pCallback != 0 && mpFNMobileIPStatus != 0);
-   if (bOn == true || bOff == true)
+   // Grab number of thresholds
+   ULONG thresholdCount = (ULONG)thresholds.size();
+
+   // Validate arguments versus what is changing
+   bool bOn = (pCallback != 0 && mpFNSignalStrength == 0);
+   if (bOn == true && thresholdCount == 0)
    {
-      // Turning on/off
-      eQMIService svc = eQMI_SVC_WDS;
-      WORD msgID = (WORD)eQMI_WDS_SET_EVENT;
-      sSharedBuffer * pReq = 0;
+      rc = eGOBI_ERR_INVALID_ARG;
+      return rc;
+   }
 
-      std::vector <sDB2PackingInput> piv;
-      sProtocolEntityKey pek( eDB2_ET_QMI_WDS_REQ, msgID, 20 );
+   bool bOff = (pCallback == 0 && mpFNSignalStrength != 0);
+   if (bOff == true && thresholdCount != 0)
+   {
+      rc = eGOBI_ERR_INVALID_ARG;
+      return rc;
+   }
 
-      if (bOn == true)
+   bool bReplace = (pCallback != 0 && mpFNSignalStrength != 0);
+   if (bReplace == true && thresholdCount == 0)
+   {
+      rc = eGOBI_ERR_INVALID_ARG;
+      return rc;
+   }
+
+   if (bOn == true || bOff == true || bReplace == true)
+   {
+      // The device reports at the thresholds of the signal monitor too
+      rc = SendSignalThresholds( thresholds );
+      if (rc == eGOBI_ERR_NONE || bOff == true || bReplace == true)
       {
-         sDB2PackingInput pi( pek, "1" ); 
-         piv.push_back( pi );
+         mpFNSignalStrength = pCallback;
+         mSignalThresholds = thresholds;
+         UpdateIndicationTables();
+      }
+   }
+   else
+   {
+      // Turning it off redundantly
+      if (thresholdCount != 0)
+      {
+         rc = eGOBI_ERR_INVALID_ARG;
       }
       else
       {
-         sDB2PackingInput pi( pek, "0" ); 
-         piv.push_back( pi );
+         rc = eGOBI_ERR_NONE;
       }
+   }
 
-      pReq = DB2PackQMIBuffer( mDB, piv );
+   return rc;
+}
 
-      rc = SendAndCheckReturn( svc, pReq );
+/*===========================================================================
+METHOD:
+   SetRFInfoCallback (Public Method)
+
+DESCRIPTION:
+   Enable/disable RF information callback function
+  
+PARAMETERS:
+   pCallback   [ I ] - Callback function
+
+RETURN VALUE:
+   eGobiError - Return code
+===========================================================================*/
+eGobiError cGobiConnectionMgmt::SetRFInfoCallback( tFNRFInfo pCallback )
+{
+   // Assume failure
+   eGobiError rc = eGOBI_ERR_GENERAL;
+
+   // Validate arguments versus what is changing
+   bool bOn = (pCallback != 0 && mpFNRFInfo == 0);
+   bool bOff = (pCallback == 0 && mpFNRFInfo != 0);
+   bool bReplace = (pCallback != 0 && mpFNRFInfo != 0);
+
+   // The signal monitor keeps the RF information reported
+   if (mbSignalMonitor == true)
+   {
+      bReplace = (bReplace || bOn || bOff);
+      bOn = false;
+      bOff = false;
+   }
+
+   if (bOn == true || bOff == true)
+   {
+      // Turning on/off
+      rc = SendRFInfoReport( bOn );
       if (rc == eGOBI_ERR_NONE || bOff == true)
       {
-         mpFNMobileIPStatus = pCallback;
+         mpFNRFInfo = pCallback;
+         UpdateIndicationTables();
       }
    }
    else if (bReplace == true)
    {
       // We don't have to register for anything so a simple assignment works
-      mpFNMobileIPStatus = pCallback;
+      mpFNRFInfo = pCallback;
+      UpdateIndicationTables();
       rc = eGOBI_ERR_NONE;
    }
    else
@@ -1936,10 +4419,10 @@ eGobiError cGobiConnectionMgmt::SetMobileIPStatusCallback(
 
 /*===========================================================================
 METHOD:
-   SetActivationStatusCallback (Public Method)
+   SetLURejectCallback (Public Method)
 
 DESCRIPTION:
-   Enable/disable activation status callback function
+   Enable/disable LU reject callback function
   
 PARAMETERS:
    pCallback   [ I ] - Callback function
@@ -1947,25 +4430,24 @@ PARAMETERS:
 RETURN VALUE:
    eGobiError - Return code
 ===========================================================================*/
-eGobiError cGobiConnectionMgmt::SetActivationStatusCallback( 
-   tFNActivationStatus        pCallback )
+eGobiError cGobiConnectionMgmt::SetLURejectCallback( tFNLUReject pCallback )
 {
    // Assume failure
    eGobiError rc = eGOBI_ERR_GENERAL;
 
-   // Something changing?
-   bool bOn = (pCallback != 0 && mpFNActivationStatus == 0);
-   bool bOff = (pCallback == 0 && mpFNActivationStatus != 0);
-   bool bReplace = (pCallback != 0 && mpFNActivationStatus != 0);
+   // Validate arguments versus what is changing
+   bool bOn = (pCallback != 0 && mpFNLUReject == 0);
+   bool bOff = (pCallback == 0 && mpFNLUReject != 0);
+   bool bReplace = (pCallback != 0 && mpFNLUReject != 0);
    if (bOn == true || bOff == true)
    {
       // Turning on/off
-      eQMIService svc = eQMI_SVC_DMS;
-      WORD msgID = (WORD)eQMI_DMS_SET_EVENT;
+      eQMIService svc = eQMI_SVC_NAS;
+      WORD msgID = (WORD)eQMI_NAS_SET_EVENT;
       sSharedBuffer * pReq = 0;
 
       std::vector <sDB2PackingInput> piv;
-      sProtocolEntityKey pek( eDB2_ET_QMI_DMS_REQ, msgID, 19 );
+      sProtocolEntityKey pek( eDB2_ET_QMI_NAS_REQ, msgID, 18 );
 
       if (bOn == true)
       {
@@ -1980,16 +4462,18 @@ eGobiError cGobiConnectionMgmt::SetActivationStatusCallback(
 
       pReq = DB2PackQMIBuffer( mDB, piv );
 
-      rc = SendAndCheckReturn( svc, pReq );
+      rc = SendRegistration( svc, pReq );
       if (rc == eGOBI_ERR_NONE || bOff == true)
       {
-         mpFNActivationStatus = pCallback;
+         mpFNLUReject = pCallback;
+         UpdateIndicationTables();
       }
    }
    else if (bReplace == true)
    {
       // We don't have to register for anything so a simple assignment works
-      mpFNActivationStatus = pCallback;
+      mpFNLUReject = pCallback;
+      UpdateIndicationTables();
       rc = eGOBI_ERR_NONE;
    }
    else
@@ -2003,10 +4487,10 @@ eGobiError cGobiConnectionMgmt::SetActivationStatusCallback(
 
 /*===========================================================================
 METHOD:
-   SetPowerCallback (Public Method)
+   SetPLMNModeCallback (Public Method)
 
 DESCRIPTION:
-   Enable/disable power operating mode callback function
+   Enable/disable PLMN mode callback function
   
 PARAMETERS:
    pCallback   [ I ] - Callback function
@@ -2014,25 +4498,45 @@ PARAMETERS:
 RETURN VALUE:
    eGobiError - Return code
 ===========================================================================*/
-eGobiError cGobiConnectionMgmt::SetPowerCallback( 
-   tFNPower                   pCallback )
+eGobiError cGobiConnectionMgmt::SetPLMNModeCallback( tFNPLMNMode pCallback )
+{
+   // We don't have to register for anything so a simple assignment works
+   mpPLMNMode = pCallback;
+   UpdateIndicationTables();
+   return eGOBI_ERR_NONE;
+}
+
+/*===========================================================================
+METHOD:
+   SetNewSMSCallback (Public Method)
+
+DESCRIPTION:
+   Enable/disable new SMS callback function
+  
+PARAMETERS:
+   pCallback   [ I ] - Callback function
+
+RETURN VALUE:
+   eGobiError - Return code
+===========================================================================*/
+eGobiError cGobiConnectionMgmt::SetNewSMSCallback( tFNNewSMS pCallback )
 {
    // Assume failure
    eGobiError rc = eGOBI_ERR_GENERAL;
 
    // Something changing?
-   bool bOn = (pCallback != 0 && mpFNPower == 0);
-   bool bOff = (pCallback == 0 && mpFNPower != 0);
-   bool bReplace = (pCallback != 0 && mpFNPower != 0);
+   bool bOn = (pCallback != 0 && mpFNNewSMS == 0);
+   bool bOff = (pCallback == 0 && mpFNNewSMS != 0);
+   bool bReplace = (pCallback != 0 && mpFNNewSMS != 0);
    if (bOn == true || bOff == true)
    {
       // Turning on/off
-      eQMIService svc = eQMI_SVC_DMS;
-      WORD msgID = (WORD)eQMI_DMS_SET_EVENT;
+      eQMIService svc = eQMI_SVC_WMS;
+      WORD msgID = (WORD)eQMI_WMS_SET_EVENT;
       sSharedBuffer * pReq = 0;
 
       std::vector <sDB2PackingInput> piv;
-      sProtocolEntityKey pek( eDB2_ET_QMI_DMS_REQ, msgID, 20 );
+      sProtocolEntityKey pek( eDB2_ET_QMI_WMS_REQ, msgID, 16 );
 
       if (bOn == true)
       {
@@ -2047,16 +4551,18 @@ eGobiError cGobiConnectionMgmt::SetPowerCallback(
 
       pReq = DB2PackQMIBuffer( mDB, piv );
 
-      rc = SendAndCheckReturn( svc, pReq );
+      rc = SendRegistration( svc, pReq );
       if (rc == eGOBI_ERR_NONE || bOff == true)
       {
-         mpFNPower = pCallback;
+         mpFNNewSMS = pCallback;
+         UpdateIndicationTables();
       }
    }
    else if (bReplace == true)
    {
       // We don't have to register for anything so a simple assignment works
-      mpFNPower = pCallback;
+      mpFNNewSMS = pCallback;
+      UpdateIndicationTables();
       rc = eGOBI_ERR_NONE;
    }
    else
@@ -2070,10 +4576,10 @@ eGobiError cGobiConnectionMgmt::SetPowerCallback(
 
 /*===========================================================================
 METHOD:
-   SetWirelessDisableCallback (Public Method)
+   SetNMEACallback (Public Method)
 
 DESCRIPTION:
-   Enable/disable wireless disable state callback function
+   Enable/disable new NMEA sentence function
   
 PARAMETERS:
    pCallback   [ I ] - Callback function
@@ -2081,25 +4587,24 @@ PARAMETERS:
 RETURN VALUE:
    eGobiError - Return code
 ===========================================================================*/
-eGobiError cGobiConnectionMgmt::SetWirelessDisableCallback( 
-   tFNWirelessDisable         pCallback )
+eGobiError cGobiConnectionMgmt::SetNMEACallback( tFNNewNMEA pCallback )
 {
    // Assume failure
    eGobiError rc = eGOBI_ERR_GENERAL;
 
    // Something changing?
-   bool bOn = (pCallback != 0 && mpFNWirelessDisable == 0);
-   bool bOff = (pCallback == 0 && mpFNWirelessDisable != 0);
-   bool bReplace = (pCallback != 0 && mpFNWirelessDisable != 0);
+   bool bOn = (pCallback != 0 && mpFNNewNMEA == 0);
+   bool bOff = (pCallback == 0 && mpFNNewNMEA != 0);
+   bool bReplace = (pCallback != 0 && mpFNNewNMEA != 0);
    if (bOn == true || bOff == true)
    {
       // Turning on/off
-      eQMIService svc = eQMI_SVC_DMS;
-      WORD msgID = (WORD)eQMI_DMS_SET_EVENT;
+      eQMIService svc = eQMI_SVC_PDS;
+      WORD msgID = (WORD)eQMI_PDS_SET_EVENT;
       sSharedBuffer * pReq = 0;
 
       std::vector <sDB2PackingInput> piv;
-      sProtocolEntityKey pek( eDB2_ET_QMI_DMS_REQ, msgID, 22 );
+      sProtocolEntityKey pek( eDB2_ET_QMI_PDS_REQ, msgID, 16 );
 
       if (bOn == true)
       {
@@ -2114,16 +4619,18 @@ eGobiError cGobiConnectionMgmt::SetWirelessDisableCallback(
 
       pReq = DB2PackQMIBuffer( mDB, piv );
 
-      rc = SendAndCheckReturn( svc, pReq );
+      rc = SendRegistration( svc, pReq );
       if (rc == eGOBI_ERR_NONE || bOff == true)
       {
-         mpFNWirelessDisable = pCallback;
+         mpFNNewNMEA = pCallback;
+         UpdateIndicationTables();
       }
    }
    else if (bReplace == true)
    {
       // We don't have to register for anything so a simple assignment works
-      mpFNWirelessDisable = pCallback;
+      mpFNNewNMEA = pCallback;
+      UpdateIndicationTables();
       rc = eGOBI_ERR_NONE;
    }
    else
@@ -2137,427 +4644,819 @@ eGobiError cGobiConnectionMgmt::SetWirelessDisableCallback(
 
 /*===========================================================================
 METHOD:
-   SetRoamingIndicatorCallback (Public Method)
+   SetPDSStateCallback (Public Method)
 
 DESCRIPTION:
-   Enable/disable roaming indicator callback function
+   Enable/disable PDS service state callback function
   
 PARAMETERS:
    pCallback   [ I ] - Callback function
 
 RETURN VALUE:
-   eGobiError - Corrected error code
+   eGobiError - Return code
 ===========================================================================*/
-eGobiError cGobiConnectionMgmt::SetRoamingIndicatorCallback( 
-   tFNRoamingIndicator        pCallback )
+eGobiError cGobiConnectionMgmt::SetPDSStateCallback( tFNPDSState pCallback )
 {
    // We don't have to register for anything so a simple assignment works
-   mpFNRoamingIndicator = pCallback;
+   mpFNPDSState = pCallback;
+   UpdateIndicationTables();
    return eGOBI_ERR_NONE;
 }
 
 /*===========================================================================
 METHOD:
-   SetSignalStrengthCallback (Public Method)
+   StartPositionStream (Public Method)
 
 DESCRIPTION:
-   Enable/disable signal strength callback function
-  
+   Start streaming position reports, each PDS event report carrying 
+   parsed position data is decoded into a ring that is drained with 
+   GetPositionReport()/WaitPositionReport() (no callback is involved)
+
 PARAMETERS:
-   pCallback   [ I ] - Callback function
-   thresholds  [ I ] - Desired threholds (only valid when enabling)
+   depth       [ I ] - Number of reports the ring holds (rounded up to a 
+                       power of 2, only used by the first start)
+
+SEQUENCING:
+   The ring has a single consumer, only one thread may drain it
 
 RETURN VALUE:
    eGobiError - Return code
 ===========================================================================*/
-eGobiError cGobiConnectionMgmt::SetSignalStrengthCallback( 
-   tFNSignalStrength          pCallback,
-   std::list <INT8>           thresholds )
+eGobiError cGobiConnectionMgmt::StartPositionStream( ULONG depth )
 {
-   // Assume failure
-   eGobiError rc = eGOBI_ERR_GENERAL;
+   if (mbPositionStream == true)
+   {
+      return eGOBI_ERR_NONE;
+   }
 
-   // Grab number of thresholds
-   ULONG thresholdCount = (ULONG)thresholds.size();
+   // The ring outlives a stop as the consumer may still be draining it
+   if (mpPositionRing == 0)
+   {
+      mpPositionRing = new cSPSCRing <sGobiPositionReport>( depth );
+      if (mpPositionRing == 0 || mpPositionRing->IsValid() == false)
+      {
+         delete mpPositionRing;
+         mpPositionRing = 0;
+         return eGOBI_ERR_MEMORY;
+      }
+   }
 
-   // Validate arguments versus what is changing
-   bool bOn = (pCallback != 0 && mpFNSignalStrength == 0);
-   if (bOn == true && thresholdCount == 0)
+   // Parsed position data is reported under the raw indicator
+   WORD msgID = (WORD)eQMI_PDS_SET_EVENT;
+   std::vector <sDB2PackingInput> piv;
+   sProtocolEntityKey pek( eDB2_ET_QMI_PDS_REQ, msgID, 18 );
+   sDB2PackingInput pi( pek, "1" );
+   piv.push_back( pi );
+
+   sSharedBuffer * pReq = DB2PackQMIBuffer( mDB, piv );
+
+   eGobiError rc = SendRegistration( eQMI_SVC_PDS, pReq );
+   if (rc == eGOBI_ERR_NONE)
    {
-      rc = eGOBI_ERR_INVALID_ARG;
-      return rc;
+      mbPositionStream = true;
+      UpdateIndicationTables();
    }
 
-   bool bOff = (pCallback == 0 && mpFNSignalStrength != 0);
-   if (bOff == true && thresholdCount != 0)
+   return rc;
+}
+
+/*===========================================================================
+METHOD:
+   StopPositionStream (Public Method)
+
+DESCRIPTION:
+   Stop streaming position reports (reports already in the ring can 
+   still be retrieved)
+
+RETURN VALUE:
+   eGobiError - Return code
+===========================================================================*/
+eGobiError cGobiConnectionMgmt::StopPositionStream()
+{
+   if (mbPositionStream == false)
    {
-      rc = eGOBI_ERR_INVALID_ARG;
-      return rc;
+      // Turning it off redundantly
+      return eGOBI_ERR_NONE;
    }
 
-   bool bReplace = (pCallback != 0 && mpFNSignalStrength != 0);
-   if (bReplace == true && thresholdCount == 0)
+   WORD msgID = (WORD)eQMI_PDS_SET_EVENT;
+   std::vector <sDB2PackingInput> piv;
+   sProtocolEntityKey pek( eDB2_ET_QMI_PDS_REQ, msgID, 18 );
+   sDB2PackingInput pi( pek, "0" );
+   piv.push_back( pi );
+
+   sSharedBuffer * pReq = DB2PackQMIBuffer( mDB, piv );
+
+   // We always stop regardless of the response
+   eGobiError rc = SendRegistration( eQMI_SVC_PDS, pReq );
+   mbPositionStream = false;
+   UpdateIndicationTables();
+
+   // Release anyone waiting on a position report
+   pthread_mutex_lock( &mPositionMutex );
+   pthread_cond_broadcast( &mPositionCond );
+   pthread_mutex_unlock( &mPositionMutex );
+
+   return rc;
+}
+
+/*===========================================================================
+METHOD:
+   GetPositionReport (Public Method)
+
+DESCRIPTION:
+   Return the oldest streamed position report, without waiting
+
+PARAMETERS:
+   report      [ O ] - The position report
+
+SEQUENCING:
+   Only called by the ring's single consumer
+
+RETURN VALUE:
+   bool - Was a report returned?
+===========================================================================*/
+bool cGobiConnectionMgmt::GetPositionReport( sGobiPositionReport & report )
+{
+   if (mpPositionRing == 0)
    {
-      rc = eGOBI_ERR_INVALID_ARG;
-      return rc;
+      return false;
    }
 
-   eQMIService svc = eQMI_SVC_NAS;
-   WORD msgID = (WORD)eQMI_NAS_SET_EVENT;
-   sSharedBuffer * pReq = 0;
+   return mpPositionRing->Pop( report );
+}
 
-   std::vector <sDB2PackingInput> piv;
-   sProtocolEntityKey pek( eDB2_ET_QMI_NAS_REQ, msgID, 16 );
+/*===========================================================================
+METHOD:
+   WaitPositionReport (Public Method)
 
-   if (bOn == true || bOff == true || bReplace == true)
+DESCRIPTION:
+   Return the oldest streamed position report, waiting for one to arrive
+   (the wait ends early when the stream is stopped)
+
+PARAMETERS:
+   report      [ O ] - The position report
+   to          [ I ] - Timeout value (in milliseconds)
+
+SEQUENCING:
+   Only called by the ring's single consumer
+
+RETURN VALUE:
+   bool - Was a report returned?
+===========================================================================*/
+bool cGobiConnectionMgmt::WaitPositionReport(
+   sGobiPositionReport &      report,
+   ULONG                      to )
+{
+   if (mpPositionRing == 0)
    {
-      if (bOn == true || bReplace == true)
-      {
-         std::ostringstream args;
-         args << "1 " << (UINT)thresholdCount;
+      return false;
+   }
 
-         std::list <INT8>::const_iterator pThreshold = thresholds.begin();
-         while (pThreshold != thresholds.end())
-         {
-            INT8 t = *pThreshold++;
+   // Fast path, no locking when a report is already there
+   if (mpPositionRing->Pop( report ) == true)
+   {
+      return true;
+   }
 
-            args << " " << (INT)t;
-         }
+   timespec due = TimeIn( to );
 
-         sDB2PackingInput pi( pek, (LPCSTR)args.str().c_str() ); 
-         piv.push_back( pi );
-      }
-      else
+   pthread_mutex_lock( &mPositionMutex );
+
+   // Announce the wait before looking again so the producer can not
+   // commit a report in between unnoticed
+   mPositionWaiting = 1;
+   __sync_synchronize();
+
+   bool bRC = mpPositionRing->Pop( report );
+   while (bRC == false && mbPositionStream == true)
+   {
+      int nRet = pthread_cond_timedwait( &mPositionCond, 
+                                         &mPositionMutex, 
+                                         &due );
+
+      bRC = mpPositionRing->Pop( report );
+      if (nRet == ETIMEDOUT)
       {
-         sDB2PackingInput pi( pek, "0 0" ); 
-         piv.push_back( pi );
+         break;
       }
+   }
 
-      pReq = DB2PackQMIBuffer( mDB, piv );
+   mPositionWaiting = 0;
+   pthread_mutex_unlock( &mPositionMutex );
 
-      rc = SendAndCheckReturn( svc, pReq );
-      if (rc == eGOBI_ERR_NONE || bOff == true || bReplace == true)
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   GetDroppedPositionReports (Public Method)
+
+DESCRIPTION:
+   Return the number of position reports dropped as the ring was full
+
+RETURN VALUE:
+   ULONG
+===========================================================================*/
+ULONG cGobiConnectionMgmt::GetDroppedPositionReports()
+{
+   if (mpPositionRing == 0)
+   {
+      return 0;
+   }
+
+   return mpPositionRing->GetDropped();
+}
+
+/*===========================================================================
+METHOD:
+   SetSessionStatsInterval (Public Method)
+
+DESCRIPTION:
+   Start/stop serving the session statistics from WDS event reports, once
+   started the device pushes every counter at the given interval and
+   GetPacketStatus()/GetByteTotals() are answered from the latest report
+   without a QMI request (falling back to one when no report is current)
+
+PARAMETERS:
+   interval    [ I ] - Interval in seconds (0 = stop)
+
+RETURN VALUE:
+   eGobiError - Return code
+===========================================================================*/
+eGobiError cGobiConnectionMgmt::SetSessionStatsInterval( BYTE interval )
+{
+   eGobiError rc = eGOBI_ERR_NONE;
+   if (interval != 0)
+   {
+      rc = SendStatisticsReport( interval, true );
+      if (rc == eGOBI_ERR_NONE)
       {
-         mpFNSignalStrength = pCallback;
+         // Reports received before (re)starting are never served
+         mSessionStatsStart = GetTickCount();
+         __sync_synchronize();
+
+         mSessionStatsInterval = interval;
+         UpdateIndicationTables();
       }
    }
-   else
+   else if (mSessionStatsInterval != 0)
+   {
+      // Restore what the byte totals callback asked for, we always stop 
+      // regardless of the response
+      if (mpFNByteTotals != 0)
+      {
+         rc = SendStatisticsReport( mByteTotalsInterval, false );
+      }
+      else
+      {
+         rc = SendStatisticsReport( 0, false );
+      }
+
+      mSessionStatsInterval = 0;
+      UpdateIndicationTables();
+   }
+
+   return rc;
+}
+
+/*===========================================================================
+METHOD:
+   GetSessionStats (Public Method)
+
+DESCRIPTION:
+   Return the latest reported session statistics (the snapshot is read
+   without a lock, retrying while the WDS indication parsing updates it)
+
+PARAMETERS:
+   stats       [ O ] - The session statistics
+
+RETURN VALUE:
+   bool - Has a report been received?
+===========================================================================*/
+bool cGobiConnectionMgmt::GetSessionStats( sGobiSessionStats & stats )
+{
+   while (true)
    {
-      // Turning it off redundantly
-      if (thresholdCount != 0)
+      ULONG seq = mSessionStatsSequence;
+      if ((seq & 1) != 0)
       {
-         rc = eGOBI_ERR_INVALID_ARG;
+         continue;
       }
-      else
+
+      __sync_synchronize();
+      stats = mSessionStats;
+      __sync_synchronize();
+
+      if (seq == mSessionStatsSequence)
       {
-         rc = eGOBI_ERR_NONE;
+         break;
       }
    }
 
-   return rc;
+   return (stats.mReports != 0);
 }
 
 /*===========================================================================
 METHOD:
-   SetRFInfoCallback (Public Method)
+   GetPacketStatus (Public Method)
 
 DESCRIPTION:
-   Enable/disable RF information callback function
-  
-PARAMETERS:
-   pCallback   [ I ] - Callback function
+   This function returns the packet data transfer statistics since the start 
+   of the current packet data session
 
+PARAMETERS:
+   pTXPacketSuccesses   [ O ] - Packets transmitted without error
+   pRXPacketSuccesses   [ O ] - Packets received without error
+   pTXPacketErrors      [ O ] - Outgoing packets with framing errors
+   pRXPacketErrors      [ O ] - Incoming packets with framing errors
+   pTXPacketOverflows   [ O ] - Packets dropped because TX buffer overflowed 
+   pRXPacketOverflows   [ O ] - Packets dropped because RX buffer overflowed
+  
 RETURN VALUE:
    eGobiError - Return code
 ===========================================================================*/
-eGobiError cGobiConnectionMgmt::SetRFInfoCallback( tFNRFInfo pCallback )
+eGobiError cGobiConnectionMgmt::GetPacketStatus(  
+   ULONG *                    pTXPacketSuccesses, 
+   ULONG *                    pRXPacketSuccesses, 
+   ULONG *                    pTXPacketErrors, 
+   ULONG *                    pRXPacketErrors, 
+   ULONG *                    pTXPacketOverflows, 
+   ULONG *                    pRXPacketOverflows )
 {
-   // Assume failure
-   eGobiError rc = eGOBI_ERR_GENERAL;
+   sGobiSessionStats stats;
+   if ( (GetCurrentSessionStats( stats ) == false)
+   ||   ((stats.mValid & (ULONG)eGOBI_STATS_PACKETS) == 0) )
+   {
+      return cGobiQMICore::GetPacketStatus( pTXPacketSuccesses,
+                                            pRXPacketSuccesses,
+                                            pTXPacketErrors,
+                                            pRXPacketErrors,
+                                            pTXPacketOverflows,
+                                            pRXPacketOverflows );
+   }
 
-   // Validate arguments versus what is changing
-   bool bOn = (pCallback != 0 && mpFNRFInfo == 0);
-   bool bOff = (pCallback == 0 && mpFNRFInfo != 0);
-   bool bReplace = (pCallback != 0 && mpFNRFInfo != 0);
-   if (bOn == true || bOff == true)
+   // Validate arguments
+   if ( (pTXPacketSuccesses == 0)
+   ||   (pRXPacketSuccesses == 0)
+   ||   (pTXPacketErrors == 0)
+   ||   (pRXPacketErrors == 0)
+   ||   (pTXPacketOverflows == 0)
+   ||   (pRXPacketOverflows == 0) )
    {
-      // Turning on/off
-      eQMIService svc = eQMI_SVC_NAS;
-      WORD msgID = (WORD)eQMI_NAS_SET_EVENT;
-      sSharedBuffer * pReq = 0;
+      return eGOBI_ERR_INVALID_ARG;
+   }
 
-      std::vector <sDB2PackingInput> piv;
-      sProtocolEntityKey pek( eDB2_ET_QMI_NAS_REQ, msgID, 17 );
+   *pTXPacketSuccesses = stats.mTXPacketSuccesses;
+   *pRXPacketSuccesses = stats.mRXPacketSuccesses;
+   *pTXPacketErrors = stats.mTXPacketErrors;
+   *pRXPacketErrors = stats.mRXPacketErrors;
+   *pTXPacketOverflows = stats.mTXPacketOverflows;
+   *pRXPacketOverflows = stats.mRXPacketOverflows;
+   return eGOBI_ERR_NONE;
+}
 
-      if (bOn == true)
-      {
-         sDB2PackingInput pi( pek, "1" ); 
-         piv.push_back( pi );
-      }
-      else
-      {
-         sDB2PackingInput pi( pek, "0" ); 
-         piv.push_back( pi );
-      }
+/*===========================================================================
+METHOD:
+   GetByteTotals (Public Method)
 
-      pReq = DB2PackQMIBuffer( mDB, piv );
+DESCRIPTION:
+   This function returns the RX/TX byte counts since the start of the 
+   current packet data session
 
-      rc = SendAndCheckReturn( svc, pReq );
-      if (rc == eGOBI_ERR_NONE || bOff == true)
-      {
-         mpFNRFInfo = pCallback;
-      }
-   }
-   else if (bReplace == true)
+PARAMETERS:
+   pTXTotalBytes  [ O ] - Bytes transmitted without error
+   pRXTotalBytes  [ O ] - Bytes received without error
+  
+RETURN VALUE:
+   eGobiError - Return code
+===========================================================================*/
+eGobiError cGobiConnectionMgmt::GetByteTotals(   
+   ULONGLONG *                pTXTotalBytes, 
+   ULONGLONG *                pRXTotalBytes )
+{
+   sGobiSessionStats stats;
+   if ( (GetCurrentSessionStats( stats ) == false)
+   ||   ((stats.mValid & (ULONG)eGOBI_STATS_BYTES) == 0) )
    {
-      // We don't have to register for anything so a simple assignment works
-      mpFNRFInfo = pCallback;
-      rc = eGOBI_ERR_NONE;
+      return cGobiQMICore::GetByteTotals( pTXTotalBytes, pRXTotalBytes );
    }
-   else
+
+   // Validate arguments
+   if (pTXTotalBytes == 0 || pRXTotalBytes == 0)
    {
-      // Turning it off redundantly
-      rc = eGOBI_ERR_NONE;
+      return eGOBI_ERR_INVALID_ARG;
    }
 
-   return rc;
+   *pTXTotalBytes = stats.mTXTotalBytes;
+   *pRXTotalBytes = stats.mRXTotalBytes;
+   return eGOBI_ERR_NONE;
 }
 
 /*===========================================================================
 METHOD:
-   SetLURejectCallback (Public Method)
+   SetSignalMonitor (Public Method)
 
 DESCRIPTION:
-   Enable/disable LU reject callback function
-  
+   Start/stop serving the signal state from NAS indications, once started
+   the device pushes the signal strength as it crosses one of the given 
+   thresholds (along with RF information and serving system changes) and
+   GetSignalStrengths()/GetRFInfo()/GetServingNetwork() are answered from
+   the latest values without a QMI request
+
+   The callback is only run when a signal strength moves to another 
+   threshold band, rising past a threshold once above it by the 
+   hysteresis and falling back once that far below it
+
 PARAMETERS:
-   pCallback   [ I ] - Callback function
+   thresholds  [ I ] - Signal strength thresholds in dBm (none = stop)
+   hysteresis  [ I ] - Hysteresis in dB
+   pCallback   [ I ] - Callback function (optional)
 
 RETURN VALUE:
    eGobiError - Return code
 ===========================================================================*/
-eGobiError cGobiConnectionMgmt::SetLURejectCallback( tFNLUReject pCallback )
+eGobiError cGobiConnectionMgmt::SetSignalMonitor( 
+   const std::list <INT8> &   thresholds,
+   BYTE                       hysteresis,
+   tFNSignalStrength          pCallback )
 {
-   // Assume failure
-   eGobiError rc = eGOBI_ERR_GENERAL;
-
-   // Validate arguments versus what is changing
-   bool bOn = (pCallback != 0 && mpFNLUReject == 0);
-   bool bOff = (pCallback == 0 && mpFNLUReject != 0);
-   bool bReplace = (pCallback != 0 && mpFNLUReject != 0);
-   if (bOn == true || bOff == true)
+   eGobiError rc = eGOBI_ERR_NONE;
+   if (thresholds.size() == 0)
    {
-      // Turning on/off
-      eQMIService svc = eQMI_SVC_NAS;
-      WORD msgID = (WORD)eQMI_NAS_SET_EVENT;
-      sSharedBuffer * pReq = 0;
-
-      std::vector <sDB2PackingInput> piv;
-      sProtocolEntityKey pek( eDB2_ET_QMI_NAS_REQ, msgID, 18 );
-
-      if (bOn == true)
-      {
-         sDB2PackingInput pi( pek, "1" ); 
-         piv.push_back( pi );
-      }
-      else
+      if (mbSignalMonitor == false)
       {
-         sDB2PackingInput pi( pek, "0" ); 
-         piv.push_back( pi );
+         return rc;
       }
 
-      pReq = DB2PackQMIBuffer( mDB, piv );
+      mbSignalMonitor = false;
+      UpdateIndicationTables();
 
-      rc = SendAndCheckReturn( svc, pReq );
-      if (rc == eGOBI_ERR_NONE || bOff == true)
+      pthread_mutex_lock( &mSignalStateMutex );
+      mSignalStateSequence++;
+      __sync_synchronize();
+
+      mMonitorThresholdCount = 0;
+      mpFNSignalMonitor = 0;
+      mSignalState = sGobiSignalState();
+
+      __sync_synchronize();
+      mSignalStateSequence++;
+      pthread_mutex_unlock( &mSignalStateMutex );
+
+      // Restore what the signal strength/RF info callbacks asked for, we
+      // always stop regardless of the response
+      rc = SendSignalThresholds( mSignalThresholds );
+      if (mpFNRFInfo == 0)
       {
-         mpFNLUReject = pCallback;
+         eGobiError rfRC = SendRFInfoReport( false );
+         if (rc == eGOBI_ERR_NONE)
+         {
+            rc = rfRC;
+         }
       }
+
+      return rc;
    }
-   else if (bReplace == true)
+
+   std::list <INT8> sorted = thresholds;
+   sorted.sort();
+   sorted.unique();
+   if (sorted.size() > (size_t)MAX_SIGNAL_THRESHOLDS)
    {
-      // We don't have to register for anything so a simple assignment works
-      mpFNLUReject = pCallback;
-      rc = eGOBI_ERR_NONE;
+      return eGOBI_ERR_INVALID_ARG;
    }
-   else
+
+   INT8 oldThresholds[MAX_SIGNAL_THRESHOLDS];
+   memcpy( (LPVOID)&oldThresholds[0], 
+           (LPCVOID)&mMonitorThresholds[0], 
+           sizeof( oldThresholds ) );
+
+   ULONG oldCount = mMonitorThresholdCount;
+   BYTE oldHysteresis = mMonitorHysteresis;
+   tFNSignalStrength pOldCallback = mpFNSignalMonitor;
+
+   pthread_mutex_lock( &mSignalStateMutex );
+   mSignalStateSequence++;
+   __sync_synchronize();
+
+   mMonitorThresholdCount = 0;
+   std::list <INT8>::const_iterator pThreshold = sorted.begin();
+   while (pThreshold != sorted.end())
    {
-      // Turning it off redundantly
-      rc = eGOBI_ERR_NONE;
+      mMonitorThresholds[mMonitorThresholdCount++] = *pThreshold++;
+   }
+
+   mMonitorHysteresis = hysteresis;
+   mpFNSignalMonitor = pCallback;
+
+   __sync_synchronize();
+   mSignalStateSequence++;
+   pthread_mutex_unlock( &mSignalStateMutex );
+
+   rc = SendSignalThresholds( mSignalThresholds );
+   if (rc != eGOBI_ERR_NONE)
+   {
+      // The device kept the previous thresholds
+      pthread_mutex_lock( &mSignalStateMutex );
+      memcpy( (LPVOID)&mMonitorThresholds[0], 
+              (LPCVOID)&oldThresholds[0], 
+              sizeof( oldThresholds ) );
+
+      mMonitorThresholdCount = oldCount;
+      mMonitorHysteresis = oldHysteresis;
+      mpFNSignalMonitor = pOldCallback;
+      pthread_mutex_unlock( &mSignalStateMutex );
+      return rc;
    }
 
+   // Bands of the new thresholds are computed from scratch
+   pthread_mutex_lock( &mSignalStateMutex );
+   mSignalStateSequence++;
+   __sync_synchronize();
+
+   mSignalState = sGobiSignalState();
+
+   __sync_synchronize();
+   mSignalStateSequence++;
+   pthread_mutex_unlock( &mSignalStateMutex );
+
+   // Not every device reports RF information, the rest is still served
+   bool bRFInfo = (SendRFInfoReport( true ) == eGOBI_ERR_NONE);
+
+   mbSignalMonitor = true;
+   UpdateIndicationTables();
+
+   SeedSignalState( bRFInfo );
    return rc;
 }
 
 /*===========================================================================
 METHOD:
-   SetPLMNModeCallback (Public Method)
+   GetSignalState (Public Method)
 
 DESCRIPTION:
-   Enable/disable PLMN mode callback function
-  
+   Return the latest pushed signal state (the snapshot is read without a 
+   lock, retrying while it is being updated)
+
 PARAMETERS:
-   pCallback   [ I ] - Callback function
+   state       [ O ] - The signal state
 
 RETURN VALUE:
-   eGobiError - Return code
+   bool - Is any value present?
 ===========================================================================*/
-eGobiError cGobiConnectionMgmt::SetPLMNModeCallback( tFNPLMNMode pCallback )
+bool cGobiConnectionMgmt::GetSignalState( sGobiSignalState & state )
 {
-   // We don't have to register for anything so a simple assignment works
-   mpPLMNMode = pCallback;
-   return eGOBI_ERR_NONE;
+   while (true)
+   {
+      ULONG seq = mSignalStateSequence;
+      if ((seq & 1) != 0)
+      {
+         continue;
+      }
+
+      __sync_synchronize();
+      state = mSignalState;
+      __sync_synchronize();
+
+      if (seq == mSignalStateSequence)
+      {
+         break;
+      }
+   }
+
+   return (state.mValid != 0);
 }
 
 /*===========================================================================
 METHOD:
-   SetNewSMSCallback (Public Method)
+   GetSignalStrengths (Public Method)
 
 DESCRIPTION:
-   Enable/disable new SMS callback function
-  
+   This function gets the current available signal strengths (in dBm) 
+   as measured by the device
+
 PARAMETERS:
-   pCallback   [ I ] - Callback function
+   pArraySizes       [I/O] - Upon input the maximum number of elements 
+                             that each array can contain can contain.  
+                             Upon successful output the actual number 
+                             of elements in each array
+   pSignalStrengths  [ O ] - Received signal strength array (dBm)
+   pRadioInterfaces  [ O ] - Radio interface technology array 
 
 RETURN VALUE:
    eGobiError - Return code
 ===========================================================================*/
-eGobiError cGobiConnectionMgmt::SetNewSMSCallback( tFNNewSMS pCallback )
+eGobiError cGobiConnectionMgmt::GetSignalStrengths( 
+   ULONG *                    pArraySizes, 
+   INT8 *                     pSignalStrengths, 
+   ULONG *                    pRadioInterfaces )
 {
-   // Assume failure
-   eGobiError rc = eGOBI_ERR_GENERAL;
-
-   // Something changing?
-   bool bOn = (pCallback != 0 && mpFNNewSMS == 0);
-   bool bOff = (pCallback == 0 && mpFNNewSMS != 0);
-   bool bReplace = (pCallback != 0 && mpFNNewSMS != 0);
-   if (bOn == true || bOff == true)
+   sGobiSignalState state;
+   if (GetCurrentSignalState( (ULONG)eGOBI_SIGNAL_STRENGTHS, state ) == false)
    {
-      // Turning on/off
-      eQMIService svc = eQMI_SVC_WMS;
-      WORD msgID = (WORD)eQMI_WMS_SET_EVENT;
-      sSharedBuffer * pReq = 0;
-
-      std::vector <sDB2PackingInput> piv;
-      sProtocolEntityKey pek( eDB2_ET_QMI_WMS_REQ, msgID, 16 );
-
-      if (bOn == true)
-      {
-         sDB2PackingInput pi( pek, "1" ); 
-         piv.push_back( pi );
-      }
-      else
-      {
-         sDB2PackingInput pi( pek, "0" ); 
-         piv.push_back( pi );
-      }
+      return cGobiQMICore::GetSignalStrengths( pArraySizes,
+                                               pSignalStrengths,
+                                               pRadioInterfaces );
+   }
 
-      pReq = DB2PackQMIBuffer( mDB, piv );
+   // Validate arguments
+   if ( (pArraySizes == 0)
+   ||   (*pArraySizes == 0)
+   ||   (pSignalStrengths == 0)
+   ||   (pRadioInterfaces == 0) )
+   {
+      return eGOBI_ERR_INVALID_ARG;
+   }
 
-      rc = SendAndCheckReturn( svc, pReq );
-      if (rc == eGOBI_ERR_NONE || bOff == true)
-      {
-         mpFNNewSMS = pCallback;
-      }
+   ULONG sigCount = state.mSignalCount;
+   if (sigCount == 0)
+   {
+      *pArraySizes = 0;
+      return eGOBI_ERR_NO_SIGNAL;
    }
-   else if (bReplace == true)
+
+   if (sigCount > *pArraySizes)
    {
-      // We don't have to register for anything so a simple assignment works
-      mpFNNewSMS = pCallback;
-      rc = eGOBI_ERR_NONE;
+      sigCount = *pArraySizes;
    }
-   else
+
+   for (ULONG s = 0; s < sigCount; s++)
    {
-      // Turning it off redundantly
-      rc = eGOBI_ERR_NONE;
+      pSignalStrengths[s] = state.mSignalStrengths[s];
+      pRadioInterfaces[s] = state.mSignalRadioIfaces[s];
    }
 
-   return rc;
+   *pArraySizes = sigCount;
+   return eGOBI_ERR_NONE;
 }
 
 /*===========================================================================
 METHOD:
-   SetNMEACallback (Public Method)
+   GetRFInfo (Public Method)
 
 DESCRIPTION:
-   Enable/disable new NMEA sentence function
-  
-PARAMETERS:
-   pCallback   [ I ] - Callback function
+   This function gets the current RF information
 
+PARAMETERS:
+   pInstanceSize  [I/O] - Upon input the maximum number of elements that the 
+                          RF info instance array can contain.  Upon success
+                          the actual number of elements in the RF info 
+                          instance array
+   pInstances     [ O ] - The RF info instance array 
+  
 RETURN VALUE:
    eGobiError - Return code
 ===========================================================================*/
-eGobiError cGobiConnectionMgmt::SetNMEACallback( tFNNewNMEA pCallback )
+eGobiError cGobiConnectionMgmt::GetRFInfo( 
+   BYTE *                     pInstanceSize, 
+   BYTE *                     pInstances )
 {
-   // Assume failure
-   eGobiError rc = eGOBI_ERR_GENERAL;
-
-   // Something changing?
-   bool bOn = (pCallback != 0 && mpFNNewNMEA == 0);
-   bool bOff = (pCallback == 0 && mpFNNewNMEA != 0);
-   bool bReplace = (pCallback != 0 && mpFNNewNMEA != 0);
-   if (bOn == true || bOff == true)
+   sGobiSignalState state;
+   if (GetCurrentSignalState( (ULONG)eGOBI_SIGNAL_RF_INFO, state ) == false)
    {
-      // Turning on/off
-      eQMIService svc = eQMI_SVC_PDS;
-      WORD msgID = (WORD)eQMI_PDS_SET_EVENT;
-      sSharedBuffer * pReq = 0;
-
-      std::vector <sDB2PackingInput> piv;
-      sProtocolEntityKey pek( eDB2_ET_QMI_PDS_REQ, msgID, 16 );
-
-      if (bOn == true)
-      {
-         sDB2PackingInput pi( pek, "1" ); 
-         piv.push_back( pi );
-      }
-      else
-      {
-         sDB2PackingInput pi( pek, "0" ); 
-         piv.push_back( pi );
-      }
-
-      pReq = DB2PackQMIBuffer( mDB, piv );
+      return cGobiQMICore::GetRFInfo( pInstanceSize, pInstances );
+   }
 
-      rc = SendAndCheckReturn( svc, pReq );
-      if (rc == eGOBI_ERR_NONE || bOff == true)
-      {
-         mpFNNewNMEA = pCallback;
-      }
+   // Validate arguments
+   if (pInstanceSize == 0 || *pInstanceSize == 0 || pInstances == 0)
+   {
+      return eGOBI_ERR_INVALID_ARG;
    }
-   else if (bReplace == true)
+
+   BYTE ifaceCount = state.mRFInfoCount;
+   if (ifaceCount > *pInstanceSize)
    {
-      // We don't have to register for anything so a simple assignment works
-      mpFNNewNMEA = pCallback;
-      rc = eGOBI_ERR_NONE;
+      ifaceCount = *pInstanceSize;
    }
-   else
+
+   ULONG * pOutput = (ULONG *)pInstances;
+   for (BYTE i = 0; i < ifaceCount; i++)
    {
-      // Turning it off redundantly
-      rc = eGOBI_ERR_NONE;
+      *pOutput++ = state.mRFRadioIfaces[i];
+      *pOutput++ = state.mRFBandClasses[i];
+      *pOutput++ = state.mRFChannels[i];
    }
 
-   return rc;
+   *pInstanceSize = ifaceCount;
+   return eGOBI_ERR_NONE;
 }
 
 /*===========================================================================
 METHOD:
-   SetPDSStateCallback (Public Method)
+   GetServingNetwork (Public Method)
 
 DESCRIPTION:
-   Enable/disable PDS service state callback function
-  
-PARAMETERS:
-   pCallback   [ I ] - Callback function
+   Gets information regarding the system that currently provides service 
+   to the device
 
+PARAMETERS:
+   pRegistrationState   [ O ] - Registration state
+   pCSDomain            [ O ] - Circuit switch domain status
+   pPSDomain            [ O ] - Packet switch domain status 
+   pRAN                 [ O ] - Radio access network 
+   pRadioIfacesSize     [I/O] - Upon input the maximum number of elements 
+                                that the radio interfaces can contain.  Upon 
+                                successful output the actual number of elements 
+                                in the radio interface array
+   pRadioIfaces         [ O ] - The radio interface array 
+   pRoaming             [ O ] - Roaming indicator (0xFFFFFFFF - Unknown)
+   pMCC                 [ O ] - Mobile country code (0xFFFF - Unknown)
+   pMNC                 [ O ] - Mobile network code (0xFFFF - Unknown)
+   nameSize             [ I ] - The maximum number of characters (including 
+                                NULL terminator) that the network name array 
+                                can contain
+   pName                [ O ] - The network name or description represented 
+                                as a NULL terminated string (empty string 
+                                returned when unknown)
+  
 RETURN VALUE:
    eGobiError - Return code
 ===========================================================================*/
-eGobiError cGobiConnectionMgmt::SetPDSStateCallback( tFNPDSState pCallback )
+eGobiError cGobiConnectionMgmt::GetServingNetwork( 
+   ULONG *                    pRegistrationState, 
+   ULONG *                    pCSDomain, 
+   ULONG *                    pPSDomain, 
+   ULONG *                    pRAN, 
+   BYTE *                     pRadioIfacesSize, 
+   BYTE *                     pRadioIfaces, 
+   ULONG *                    pRoaming, 
+   WORD *                     pMCC, 
+   WORD *                     pMNC, 
+   BYTE                       nameSize, 
+   CHAR *                     pName )
 {
-   // We don't have to register for anything so a simple assignment works
-   mpFNPDSState = pCallback;
+   sGobiSignalState state;
+   ULONG valid = (ULONG)eGOBI_SIGNAL_SERVING_NETWORK;
+   if (GetCurrentSignalState( valid, state ) == false)
+   {
+      return cGobiQMICore::GetServingNetwork( pRegistrationState,
+                                              pCSDomain,
+                                              pPSDomain,
+                                              pRAN,
+                                              pRadioIfacesSize,
+                                              pRadioIfaces,
+                                              pRoaming,
+                                              pMCC,
+                                              pMNC,
+                                              nameSize,
+                                              pName );
+   }
+
+   // Validate arguments
+   if ( (pRegistrationState == 0)
+   ||   (pCSDomain == 0)
+   ||   (pPSDomain == 0)
+   ||   (pRAN == 0)
+   ||   (pRadioIfacesSize == 0)
+   ||   (*pRadioIfacesSize == 0)
+   ||   (pRadioIfaces == 0)
+   ||   (pRoaming == 0)
+   ||   (pMCC == 0)
+   ||   (pMNC == 0)
+   ||   (nameSize == 0)
+   ||   (pName == 0) )
+   {
+      return eGOBI_ERR_INVALID_ARG;
+   }
+
+   *pName = 0;
+
+   ULONG nameLen = (ULONG)strlen( state.mNetworkName );
+   if (nameLen > 0 && (ULONG)nameSize < nameLen + 1)
+   {
+      *pRadioIfacesSize = 0;
+      return eGOBI_ERR_BUFFER_SZ;
+   }
+
+   *pRegistrationState = state.mRegistrationState;
+   *pCSDomain = state.mCSDomain;
+   *pPSDomain = state.mPSDomain;
+   *pRAN = state.mRAN;
+
+   BYTE radioCount = state.mRadioIfaceCount;
+   if (radioCount > *pRadioIfacesSize)
+   {
+      radioCount = *pRadioIfacesSize;
+   }
+
+   ULONG * pOutRadioIfaces = (ULONG *)pRadioIfaces;
+   for (BYTE r = 0; r < radioCount; r++)
+   {
+      *pOutRadioIfaces++ = state.mRadioIfaces[r];
+   }
+
+   *pRadioIfacesSize = radioCount;
+   *pRoaming = state.mRoaming;
+   *pMCC = state.mMCC;
+   *pMNC = state.mMNC;
+
+   if (nameLen > 0)
+   {
+      memcpy( (LPVOID)pName, (LPCVOID)&state.mNetworkName[0], nameLen );
+      pName[nameLen] = 0;
+   }
+
    return eGOBI_ERR_NONE;
 }
 
@@ -2610,6 +5509,7 @@ eGobiError cGobiConnectionMgmt::SetCATEventCallback(
 
          // We also always clear the callback regardless of the response
          mpFNCATEvent = pCallback;
+         UpdateIndicationTables();
       }
 
       sSharedBuffer * pReq = 0;
@@ -2620,6 +5520,9 @@ eGobiError cGobiConnectionMgmt::SetCATEventCallback(
                                               &buf[0],
                                               szTLVHdr + szData );
 
+      // Hold on to the request for the registration cache
+      sProtocolBuffer req( pReq );
+
       sProtocolBuffer rsp = Send( eQMI_SVC_CAT, pReq );
       if (rsp.IsValid() == false)
       {
@@ -2649,14 +5552,12 @@ eGobiError cGobiConnectionMgmt::SetCATEventCallback(
          // Parse out the error mask?
          if (qmiRsp.GetMessageID() == (ULONG)eQMI_CAT_SET_EVENT)
          {
-            std::map <ULONG, const sQMIRawContentHeader *> tlvs; 
-            tlvs = qmiRsp.GetContents();
+            const sQMIContents & tlvs = qmiRsp.GetContents();
 
-            std::map <ULONG, const sQMIRawContentHeader *>::const_iterator pIter;
-            pIter = tlvs.find( 16 );
-            if (pIter != tlvs.end())
+            const sQMIRawContentHeader * pHdr = 0;
+            pHdr = tlvs.Find( 16 );
+            if (pHdr != 0)
             {
-               const sQMIRawContentHeader * pHdr = pIter->second;
                if (pHdr->mLength > 4)
 
                {
@@ -2671,7 +5572,9 @@ eGobiError cGobiConnectionMgmt::SetCATEventCallback(
       }
 
       // Success!
+      RecordRegistration( eQMI_SVC_CAT, req );
       mpFNCATEvent = pCallback;
+      UpdateIndicationTables();
       retCode = eGOBI_ERR_NONE;
    }
    else
@@ -2703,10 +5606,14 @@ eGobiError cGobiConnectionMgmt::SetOMADMAlertCallback(
    // Assume failure
    eGobiError rc = eGOBI_ERR_GENERAL;
 
-   // Something changing?
-   bool bOn = (pCallback != 0 && mpFNOMADMAlert == 0);
-   bool bOff = (pCallback == 0 && mpFNOMADMAlert != 0);
-   bool bReplace = (pCallback != 0 && mpFNOMADMAlert != 0);
+   // Something changing? (the event reports stay on while the OMA-DM 
+   // session tracker runs, only the callback changes)
+   bool bTracker = mbOMADMTracker;
+   bool bOn = (pCallback != 0 && mpFNOMADMAlert == 0 && bTracker == false);
+   bool bOff = (pCallback == 0 && mpFNOMADMAlert != 0 && bTracker == false);
+   bool bReplace = ( (pCallback != mpFNOMADMAlert) 
+                 &&  (bOn == false) 
+                 &&  (bOff == false) );
    if (bOn == true || bOff == true)
    {
       // Turning on/off
@@ -2730,16 +5637,18 @@ eGobiError cGobiConnectionMgmt::SetOMADMAlertCallback(
 
       pReq = DB2PackQMIBuffer( mDB, piv );
 
-      rc = SendAndCheckReturn( svc, pReq );
+      rc = SendRegistration( svc, pReq );
       if (rc == eGOBI_ERR_NONE || bOff == true)
       {
          mpFNOMADMAlert = pCallback;
+         UpdateIndicationTables();
       }
    }
    else if (bReplace == true)
    {
       // We don't have to register for anything so a simple assignment works
       mpFNOMADMAlert = pCallback;
+      UpdateIndicationTables();
       rc = eGOBI_ERR_NONE;
    }
    else
@@ -2769,10 +5678,14 @@ eGobiError cGobiConnectionMgmt::SetOMADMStateCallback( tFNOMADMState pCallback )
    // Assume failure
    eGobiError rc = eGOBI_ERR_GENERAL;
 
-   // Something changing?
-   bool bOn = (pCallback != 0 && mpFNOMADMState == 0);
-   bool bOff = (pCallback == 0 && mpFNOMADMState != 0);
-   bool bReplace = (pCallback != 0 && mpFNOMADMState != 0);
+   // Something changing? (the event reports stay on while the OMA-DM 
+   // session tracker runs, only the callback changes)
+   bool bTracker = mbOMADMTracker;
+   bool bOn = (pCallback != 0 && mpFNOMADMState == 0 && bTracker == false);
+   bool bOff = (pCallback == 0 && mpFNOMADMState != 0 && bTracker == false);
+   bool bReplace = ( (pCallback != mpFNOMADMState) 
+                 &&  (bOn == false) 
+                 &&  (bOff == false) );
    if (bOn == true || bOff == true)
    {
       // Turning on/off
@@ -2796,16 +5709,18 @@ eGobiError cGobiConnectionMgmt::SetOMADMStateCallback( tFNOMADMState pCallback )
 
       pReq = DB2PackQMIBuffer( mDB, piv );
 
-      rc = SendAndCheckReturn( svc, pReq );
+      rc = SendRegistration( svc, pReq );
       if (rc == eGOBI_ERR_NONE || bOff == true)
       {
          mpFNOMADMState = pCallback;
+         UpdateIndicationTables();
       }
    }
    else if (bReplace == true)
    {
       // We don't have to register for anything so a simple assignment works
       mpFNOMADMState = pCallback;
+      UpdateIndicationTables();
       rc = eGOBI_ERR_NONE;
    }
    else
@@ -2817,6 +5732,414 @@ eGobiError cGobiConnectionMgmt::SetOMADMStateCallback( tFNOMADMState pCallback )
    return rc;
 }
 
+/*===========================================================================
+METHOD:
+   StartOMADMTracker (Public Method)
+
+DESCRIPTION:
+   Start tracking the OMA-DM session state, the device pushes network 
+   initiated alerts and session state changes in OMA event reports so 
+   there is no need to poll OMADMGetSessionInfo()/OMADMGetPendingNIA(),
+   the state is read with GetOMADMSession() and waited on with 
+   WaitOMADMSession() (the OMA-DM callbacks keep working as before)
+
+RETURN VALUE:
+   eGobiError - Return code
+===========================================================================*/
+eGobiError cGobiConnectionMgmt::StartOMADMTracker()
+{
+   if (mbOMADMTracker == true)
+   {
+      return eGOBI_ERR_NONE;
+   }
+
+   // Start from a clean state, so that reports arriving while the event 
+   // reports are being turned on are not lost
+   pthread_mutex_lock( &mOMADMMutex );
+   mOMADMSession = sGobiOMADMSession();
+   mbOMADMTracker = true;
+   pthread_mutex_unlock( &mOMADMMutex );
+
+   eGobiError rc = SendOMADMEvents( true, true );
+   if (rc != eGOBI_ERR_NONE)
+   {
+      mbOMADMTracker = false;
+      return rc;
+   }
+
+   UpdateIndicationTables();
+   SeedOMADMSession();
+
+   return eGOBI_ERR_NONE;
+}
+
+/*===========================================================================
+METHOD:
+   StopOMADMTracker (Public Method)
+
+DESCRIPTION:
+   Stop tracking the OMA-DM session state (anyone waiting on a session is
+   released)
+
+RETURN VALUE:
+   eGobiError - Return code
+===========================================================================*/
+eGobiError cGobiConnectionMgmt::StopOMADMTracker()
+{
+   if (mbOMADMTracker == false)
+   {
+      // Turning it off redundantly
+      return eGOBI_ERR_NONE;
+   }
+
+   // We always stop regardless of the response, what the callbacks need
+   // stays on
+   eGobiError rc = SendOMADMEvents( (mpFNOMADMAlert != 0), 
+                                    (mpFNOMADMState != 0) );
+
+   pthread_mutex_lock( &mOMADMMutex );
+   mbOMADMTracker = false;
+   pthread_cond_broadcast( &mOMADMCond );
+   pthread_mutex_unlock( &mOMADMMutex );
+
+   UpdateIndicationTables();
+   return rc;
+}
+
+/*===========================================================================
+METHOD:
+   GetOMADMSession (Public Method)
+
+DESCRIPTION:
+   Return the tracked OMA-DM session state
+
+PARAMETERS:
+   session     [ O ] - The OMA-DM session state
+
+RETURN VALUE:
+   bool - Is the OMA-DM session tracker running?
+===========================================================================*/
+bool cGobiConnectionMgmt::GetOMADMSession( sGobiOMADMSession & session )
+{
+   pthread_mutex_lock( &mOMADMMutex );
+
+   bool bRC = mbOMADMTracker;
+   if (bRC == true)
+   {
+      session = mOMADMSession;
+   }
+
+   pthread_mutex_unlock( &mOMADMMutex );
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   WaitOMADMSession (Public Method)
+
+DESCRIPTION:
+   Wait for an OMA-DM session to complete or fail, i.e. for a final 
+   session state to be reported once the given number of session state 
+   reports is exceeded (take the count with GetOMADMSession() before 
+   starting or accepting the session)
+
+PARAMETERS:
+   afterReports   [ I ] - Session state reports already seen
+   to             [ I ] - Timeout value (in milliseconds)
+   session        [ O ] - The OMA-DM session state
+
+RETURN VALUE:
+   eGobiError - Return code (eGOBI_ERR_RESPONSE_TO on timeout, 
+                eGOBI_ERR_GENERAL when the tracker is not running)
+===========================================================================*/
+eGobiError cGobiConnectionMgmt::WaitOMADMSession(
+   ULONG                      afterReports,
+   ULONG                      to,
+   sGobiOMADMSession &        session )
+{
+   timespec due = TimeIn( to );
+
+   pthread_mutex_lock( &mOMADMMutex );
+
+   eGobiError rc = eGOBI_ERR_RESPONSE_TO;
+   while (mbOMADMTracker == true)
+   {
+      const sGobiOMADMSession & current = mOMADMSession;
+      if ( (current.mStateReports > afterReports)
+      &&   (current.mSessionState <= OMADM_SESSION_LAST_FINAL_STATE) )
+      {
+         rc = eGOBI_ERR_NONE;
+         break;
+      }
+
+      int nRet = pthread_cond_timedwait( &mOMADMCond, &mOMADMMutex, &due );
+      if (nRet == ETIMEDOUT)
+      {
+         // One last look, the state may have arrived with the timeout
+         if ( (mbOMADMTracker == true)
+         &&   (current.mStateReports > afterReports)
+         &&   (current.mSessionState <= OMADM_SESSION_LAST_FINAL_STATE) )
+         {
+            rc = eGOBI_ERR_NONE;
+         }
+
+         break;
+      }
+   }
+
+   if (mbOMADMTracker == false)
+   {
+      rc = eGOBI_ERR_GENERAL;
+   }
+
+   session = mOMADMSession;
+   pthread_mutex_unlock( &mOMADMMutex );
+
+   return rc;
+}
+
+/*===========================================================================
+METHOD:
+   OMADMStartSession (Public Method)
+
+DESCRIPTION:
+   This function starts an OMA-DM session
+
+PARAMETERS:
+   sessionType [ I ] - Type of session to initiate
+
+RETURN VALUE:
+   eGobiError - Return code
+===========================================================================*/
+eGobiError cGobiConnectionMgmt::OMADMStartSession( ULONG sessionType )
+{
+   eGobiError rc = cGobiQMICore::OMADMStartSession( sessionType );
+   if (rc == eGOBI_ERR_NONE)
+   {
+      ClearOMADMAlert();
+   }
+
+   return rc;
+}
+
+/*===========================================================================
+METHOD:
+   OMADMSendSelection (Public Method)
+
+DESCRIPTION:
+   This function sends the specified OMA-DM selection for the current 
+   network initiated session
+
+PARAMETERS:
+   selection   [ I ] - Selection
+   sessionID   [ I ] - Unique session ID
+
+RETURN VALUE:
+   eGobiError - Return code
+===========================================================================*/
+eGobiError cGobiConnectionMgmt::OMADMSendSelection( 
+   ULONG                      selection, 
+   USHORT                     sessionID )
+{
+   eGobiError rc = cGobiQMICore::OMADMSendSelection( selection, sessionID );
+   if (rc == eGOBI_ERR_NONE)
+   {
+      ClearOMADMAlert();
+   }
+
+   return rc;
+}
+
+/*===========================================================================
+METHOD:
+   SendOMADMEvents (Internal Method)
+
+DESCRIPTION:
+   Turn the network initiated alert and session state parts of the OMA
+   event reports on/off
+
+PARAMETERS:
+   bNIA        [ I ] - Report network initiated alerts?
+   bState      [ I ] - Report session state changes?
+
+RETURN VALUE:
+   eGobiError - Return code
+===========================================================================*/
+eGobiError cGobiConnectionMgmt::SendOMADMEvents(
+   bool                       bNIA,
+   bool                       bState )
+{
+   WORD msgID = (WORD)eQMI_OMA_SET_EVENT;
+   std::vector <sDB2PackingInput> piv;
+
+   sProtocolEntityKey pek( eDB2_ET_QMI_OMA_REQ, msgID, 16 );
+   sDB2PackingInput pi( pek, (bNIA == true ? "1" : "0") );
+   piv.push_back( pi );
+
+   pek = sProtocolEntityKey( eDB2_ET_QMI_OMA_REQ, msgID, 17 );
+   pi = sDB2PackingInput( pek, (bState == true ? "1" : "0") );
+   piv.push_back( pi );
+
+   sSharedBuffer * pReq = DB2PackQMIBuffer( mDB, piv );
+   return SendRegistration( eQMI_SVC_OMA, pReq );
+}
+
+/*===========================================================================
+METHOD:
+   SeedOMADMSession (Internal Method)
+
+DESCRIPTION:
+   Fill the OMA-DM session state from a single session information query
+   when starting the tracker, the device only pushes changes so until then
+   there would be nothing to serve (a state pushed while querying is kept,
+   as it is newer)
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiConnectionMgmt::SeedOMADMSession()
+{
+   // Both the session and the pending alert come with the one response
+   WORD msgID = (WORD)eQMI_OMA_GET_SESSION_INFO;
+   sProtocolBuffer rsp = SendSimple( eQMI_SVC_OMA, msgID );
+   if (rsp.IsValid() == false)
+   {
+      return;
+   }
+
+   sQMIServiceBuffer qmiRsp( rsp.GetSharedBuffer() );
+   if (qmiRsp.IsValid() == false)
+   {
+      return;
+   }
+
+   ULONG rc = 0;
+   ULONG ec = 0;
+   if (qmiRsp.GetResult( rc, ec ) == false || rc != 0)
+   {
+      return;
+   }
+
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
+
+   sProtocolEntityKey tlvKey( eDB2_ET_QMI_OMA_RSP, msgID, 16 );
+   cDataParser::tParsedFields sessionPF = ParseTLV( mDB, rsp, tlvs, tlvKey );
+
+   tlvKey = sProtocolEntityKey( eDB2_ET_QMI_OMA_RSP, msgID, 17 );
+   cDataParser::tParsedFields failurePF = ParseTLV( mDB, rsp, tlvs, tlvKey );
+
+   tlvKey = sProtocolEntityKey( eDB2_ET_QMI_OMA_RSP, msgID, 19 );
+   cDataParser::tParsedFields niaPF = ParseTLV( mDB, rsp, tlvs, tlvKey );
+
+   pthread_mutex_lock( &mOMADMMutex );
+   if (mbOMADMTracker == false)
+   {
+      pthread_mutex_unlock( &mOMADMMutex );
+      return;
+   }
+
+   sGobiOMADMSession & session = mOMADMSession;
+   if (sessionPF.size() >= 2)
+   {
+      // Session state reports never carry the type
+      session.mSessionType = sessionPF[1].mValue.mU32;
+      if (session.mStateReports == 0)
+      {
+         session.mSessionState = sessionPF[0].mValue.mU32;
+         if (failurePF.size() >= 1)
+         {
+            session.mFailureReason = failurePF[0].mValue.mU32;
+         }
+      }
+   }
+
+   if (niaPF.size() >= 2 && session.mReports == 0)
+   {
+      session.mbNIAPending = true;
+      session.mNIASessionType = niaPF[0].mValue.mU32;
+      session.mNIASessionID = niaPF[1].mValue.mU16;
+   }
+
+   pthread_mutex_unlock( &mOMADMMutex );
+}
+
+/*===========================================================================
+METHOD:
+   PublishOMADMEvent (Internal Method)
+
+DESCRIPTION:
+   Fold an OMA event report into the OMA-DM session state, and wake 
+   anyone waiting on the session
+
+PARAMETERS:
+   bNIA           [ I ] - Was a network initiated alert reported?
+   niaSessionType [ I ] - Type of the alerted session
+   niaSessionID   [ I ] - Unique ID of the alerted session
+   bState         [ I ] - Was a session state reported?
+   sessionState   [ I ] - Session state
+   failureReason  [ I ] - Session failure reason (ULONG_MAX = none)
+
+SEQUENCING:
+   Only called when parsing an OMA indication
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiConnectionMgmt::PublishOMADMEvent(
+   bool                       bNIA,
+   ULONG                      niaSessionType,
+   USHORT                     niaSessionID,
+   bool                       bState,
+   ULONG                      sessionState,
+   ULONG                      failureReason )
+{
+   pthread_mutex_lock( &mOMADMMutex );
+   if (mbOMADMTracker == false)
+   {
+      pthread_mutex_unlock( &mOMADMMutex );
+      return;
+   }
+
+   sGobiOMADMSession & session = mOMADMSession;
+   session.mReports++;
+   session.mReceived = GetTickCount();
+
+   if (bNIA == true)
+   {
+      session.mbNIAPending = true;
+      session.mNIASessionType = niaSessionType;
+      session.mNIASessionID = niaSessionID;
+   }
+
+   if (bState == true)
+   {
+      session.mStateReports++;
+      session.mSessionState = sessionState;
+      session.mFailureReason = failureReason;
+   }
+
+   pthread_cond_broadcast( &mOMADMCond );
+   pthread_mutex_unlock( &mOMADMMutex );
+}
+
+/*===========================================================================
+METHOD:
+   ClearOMADMAlert (Internal Method)
+
+DESCRIPTION:
+   The tracked network initiated alert is no longer pending (a session
+   was started or a selection sent)
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiConnectionMgmt::ClearOMADMAlert()
+{
+   pthread_mutex_lock( &mOMADMMutex );
+   mOMADMSession.mbNIAPending = false;
+   pthread_mutex_unlock( &mOMADMMutex );
+}
+
 /*===========================================================================
 METHOD:
    SetUSSDReleaseCallback (Public Method)
@@ -2835,6 +6158,7 @@ eGobiError cGobiConnectionMgmt::SetUSSDReleaseCallback(
 {
    // We don't have to register for anything so a simple assignment works
    mpFNUSSDRelease = pCallback;
+   UpdateIndicationTables();
    return eGOBI_ERR_NONE;
 }
 
@@ -2856,6 +6180,7 @@ eGobiError cGobiConnectionMgmt::SetUSSDNotificationCallback(
 {
    // We don't have to register for anything so a simple assignment works
    mpFNUSSDNotification = pCallback;
+   UpdateIndicationTables();
    return eGOBI_ERR_NONE;
 }
 
@@ -2877,6 +6202,7 @@ eGobiError cGobiConnectionMgmt::SetUSSDOriginationCallback(
 {
    // We don't have to register for anything so a simple assignment works
    mpFNUSSDOrigination = pCallback;
+   UpdateIndicationTables();
    return eGOBI_ERR_NONE;
 }
 
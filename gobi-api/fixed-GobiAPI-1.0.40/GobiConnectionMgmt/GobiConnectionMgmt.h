@@ -6,6 +6,12 @@ DESCRIPTION:
    QUALCOMM Connection Management API for Gobi 3000
 
 PUBLIC CLASSES AND FUNCTIONS:
+   cGobiCMCallbackPool
+   cGobiCMParsePool
+   cGobiCMReconnector
+   sGobiPositionReport
+   sGobiSignalState
+   sGobiOMADMSession
    cGobiConnectionMgmtDLL
    cGobiConnectionMgmt
 
@@ -46,6 +52,10 @@ POSSIBILITY OF SUCH DAMAGE.
 // Include Files
 //---------------------------------------------------------------------------
 #include "GobiQMICore.h"
+#include "GobiDeviceManager.h"
+#include "SPSCRing.h"
+
+#include <deque>
 
 //---------------------------------------------------------------------------
 // Definitions
@@ -154,8 +164,55 @@ typedef void (* tFNUSSDOrigination)(
 
 };
 
+// Callback types (callbacks of the same type are run in order)
+enum eGobiCMCallbackType
+{
+   eGOBI_CM_CB_BEGIN = -1,
+
+   eGOBI_CM_CB_SESSION_STATE,
+   eGOBI_CM_CB_BYTE_TOTALS,
+   eGOBI_CM_CB_DORMANCY_STATUS,
+   eGOBI_CM_CB_MOBILE_IP_STATUS,
+   eGOBI_CM_CB_ACTIVATION_STATUS,
+   eGOBI_CM_CB_POWER,
+   eGOBI_CM_CB_WIRELESS_DISABLE,
+   eGOBI_CM_CB_DATA_CAPABILITIES,
+   eGOBI_CM_CB_DATA_BEARER,
+   eGOBI_CM_CB_ROAMING_INDICATOR,
+   eGOBI_CM_CB_SIGNAL_STRENGTH,
+   eGOBI_CM_CB_RF_INFO,
+   eGOBI_CM_CB_LU_REJECT,
+   eGOBI_CM_CB_PLMN_MODE,
+   eGOBI_CM_CB_NEW_SMS,
+   eGOBI_CM_CB_NEW_NMEA,
+   eGOBI_CM_CB_PDS_STATE,
+   eGOBI_CM_CB_CAT_EVENT,
+   eGOBI_CM_CB_OMADM_ALERT,
+   eGOBI_CM_CB_OMADM_STATE,
+   eGOBI_CM_CB_USSD_RELEASE,
+   eGOBI_CM_CB_USSD_NOTIFICATION,
+   eGOBI_CM_CB_USSD_ORIGINATION,
+
+   eGOBI_CM_CB_END
+};
+
+// Number of callback pool threads
+const ULONG CALLBACK_POOL_THREADS = 2;
+
+// Number of indication parse pool threads
+const ULONG PARSE_POOL_THREADS = 3;
+
+// Highest QMI indication message ID that can be dispatched
+const ULONG MAX_INDICATION_ID = 255;
+
+// Default number of position reports buffered by the position stream
+const ULONG DEFAULT_POSITION_STREAM_DEPTH = 64;
+
+// Maximum number of signal strength thresholds the device accepts
+const ULONG MAX_SIGNAL_THRESHOLDS = 5;
+
 // CallbackThread prototype
-// Thread to execute a callback asynchronously
+// Callback pool thread, executes queued callbacks asynchronously
 void * CallbackThread( PVOID pArg );
 
 /*=========================================================================*/
@@ -165,33 +222,24 @@ class cGobiCMCallback
 {
    public:
       // (Inline) Constructor
-      cGobiCMCallback()
+      cGobiCMCallback( eGobiCMCallbackType type )
+         :  mType( type )
       { };
 
       // (Inline) Destructor
       virtual ~cGobiCMCallback()
       { };
 
-      // (Inline) Initialize the callback object by starting the thread
-      bool Initialize()
+      // (Inline) Return the callback type
+      eGobiCMCallbackType GetType() const
       {
-         // Start the thread
-         pthread_t threadID;
-         pthread_attr_t attributes;
-         pthread_attr_init( &attributes );
-         pthread_attr_setdetachstate( &attributes, PTHREAD_CREATE_DETACHED );
-
-         int nRC = pthread_create( &threadID,
-                                   &attributes,
-                                   CallbackThread,
-                                   this );
-
-         if (nRC == 0)
-         {
-            // Success!
-            return true;
-         }
+         return mType;
+      };
 
+      // (Inline) Does this callback make the given (not yet run) callback
+      // of the same type redundant?
+      virtual bool Supersedes( const cGobiCMCallback & /* older */ ) const
+      {
          return false;
       };
 
@@ -199,6 +247,9 @@ class cGobiCMCallback
       // Call the function
       virtual void Call() = 0;
 
+      /* Callback type */
+      eGobiCMCallbackType mType;
+
       // Function thread gets full access
       friend void * CallbackThread( PVOID pArg );
 };
@@ -214,7 +265,8 @@ class cSessionStateCallback : public cGobiCMCallback
          tFNSessionState            pCallback,
          ULONG                      state,
          ULONG                      sessionEndReason )
-         :  mpCallback( pCallback ),
+         :  cGobiCMCallback( eGOBI_CM_CB_SESSION_STATE ),
+            mpCallback( pCallback ),
             mState( state ),
             mSessionEndReason( sessionEndReason )
       { };
@@ -254,7 +306,8 @@ class cByteTotalsCallback : public cGobiCMCallback
          tFNByteTotals              pCallback,
          ULONGLONG                  totalBytesTX,
          ULONGLONG                  totalBytesRX )
-         :  mpCallback( pCallback ),
+         :  cGobiCMCallback( eGOBI_CM_CB_BYTE_TOTALS ),
+            mpCallback( pCallback ),
             mTotalBytesTX( totalBytesTX ),
             mTotalBytesRX( totalBytesRX )
       { };
@@ -265,6 +318,12 @@ class cByteTotalsCallback : public cGobiCMCallback
          mpCallback = 0;
       };
 
+      // (Inline) Newer totals make older (unreported) ones redundant
+      virtual bool Supersedes( const cGobiCMCallback & /* older */ ) const
+      {
+         return true;
+      };
+
    protected:
       // (Inline) Call the function
       virtual void Call()
@@ -293,7 +352,8 @@ class cDormancyStatusCallback : public cGobiCMCallback
       cDormancyStatusCallback(
          tFNDormancyStatus          pCallback,
          ULONG                      dormancyStatus )
-         :  mpCallback( pCallback ),
+         :  cGobiCMCallback( eGOBI_CM_CB_DORMANCY_STATUS ),
+            mpCallback( pCallback ),
             mDormancyStatus( dormancyStatus )
       { };
 
@@ -330,7 +390,8 @@ class cMobileIPStatusCallback : public cGobiCMCallback
       cMobileIPStatusCallback(
          tFNMobileIPStatus          pCallback,
          ULONG                      mobileIPStatus )
-         :  mpCallback( pCallback ),
+         :  cGobiCMCallback( eGOBI_CM_CB_MOBILE_IP_STATUS ),
+            mpCallback( pCallback ),
             mMobileIPStatus( mobileIPStatus )
       { };
 
@@ -367,7 +428,8 @@ class cActivationStatusCallback : public cGobiCMCallback
       cActivationStatusCallback(
          tFNActivationStatus        pCallback,
          ULONG                      activationStatus )
-         :  mpCallback( pCallback ),
+         :  cGobiCMCallback( eGOBI_CM_CB_ACTIVATION_STATUS ),
+            mpCallback( pCallback ),
             mActivationStatus( activationStatus )
       { };
 
@@ -404,7 +466,8 @@ class cPowerCallback : public cGobiCMCallback
       cPowerCallback(
          tFNPower                   pCallback,
          ULONG                      operatingMode )
-         :  mpCallback( pCallback ),
+         :  cGobiCMCallback( eGOBI_CM_CB_POWER ),
+            mpCallback( pCallback ),
             mOperatingMode( operatingMode )
       { };
 
@@ -441,7 +504,8 @@ class cWirelessDisableCallback : public cGobiCMCallback
       cWirelessDisableCallback(
          tFNWirelessDisable         pCallback,
          ULONG                      bState )
-         :  mpCallback( pCallback ),
+         :  cGobiCMCallback( eGOBI_CM_CB_WIRELESS_DISABLE ),
+            mpCallback( pCallback ),
             mbState( bState )
       { };
 
@@ -479,7 +543,8 @@ class cDataCapabilitiesCallback : public cGobiCMCallback
          tFNDataCapabilities        pCallback,
          BYTE                       dataCapsSize,
          ULONG *                    pDataCaps )
-         :  mpCallback( pCallback ),
+         :  cGobiCMCallback( eGOBI_CM_CB_DATA_CAPABILITIES ),
+            mpCallback( pCallback ),
             mDataCapsSize( dataCapsSize )
       {
          memset( (LPVOID)&mDataCaps[0], 0, 12 * sizeof( ULONG ) );
@@ -529,7 +594,8 @@ class cDataBearerCallback : public cGobiCMCallback
       cDataBearerCallback(
          tFNDataBearer              pCallback,
          ULONG                      dataBearer )
-         :  mpCallback( pCallback ),
+         :  cGobiCMCallback( eGOBI_CM_CB_DATA_BEARER ),
+            mpCallback( pCallback ),
             mDataBearer( dataBearer )
       { };
 
@@ -566,7 +632,8 @@ class cRoamingIndicatorCallback : public cGobiCMCallback
       cRoamingIndicatorCallback(
          tFNRoamingIndicator        pCallback,
          ULONG                      roaming )
-         :  mpCallback( pCallback ),
+         :  cGobiCMCallback( eGOBI_CM_CB_ROAMING_INDICATOR ),
+            mpCallback( pCallback ),
             mRoaming( roaming )
       { };
 
@@ -604,7 +671,8 @@ class cSignalStrengthCallback : public cGobiCMCallback
          tFNSignalStrength          pCallback,
          INT8                       signalStrength,
          ULONG                      radioInterface )
-         :  mpCallback( pCallback ),
+         :  cGobiCMCallback( eGOBI_CM_CB_SIGNAL_STRENGTH ),
+            mpCallback( pCallback ),
             mSignalStrength( signalStrength ),
             mRadioInterface( radioInterface )
       { };
@@ -615,6 +683,16 @@ class cSignalStrengthCallback : public cGobiCMCallback
          mpCallback = 0;
       };
 
+      // (Inline) A newer signal strength for the same radio interface
+      // makes an older (unreported) one redundant
+      virtual bool Supersedes( const cGobiCMCallback & older ) const
+      {
+         const cSignalStrengthCallback & cb = 
+            static_cast <const cSignalStrengthCallback &>( older );
+
+         return (cb.mRadioInterface == mRadioInterface);
+      };
+
    protected:
       // (Inline) Call the function
       virtual void Call()
@@ -645,7 +723,8 @@ class cRFInfoCallback : public cGobiCMCallback
          ULONG                      radioInterface,
          ULONG                      activeBandClass,
          ULONG                      activeChannel )
-         :  mpCallback( pCallback ),
+         :  cGobiCMCallback( eGOBI_CM_CB_RF_INFO ),
+            mpCallback( pCallback ),
             mRadioInterface( radioInterface ),
             mActiveBandClass( activeBandClass ),
             mActiveChannel( activeChannel )
@@ -657,6 +736,16 @@ class cRFInfoCallback : public cGobiCMCallback
          mpCallback = 0;
       };
 
+      // (Inline) Newer RF information for the same radio interface
+      // makes older (unreported) information redundant
+      virtual bool Supersedes( const cGobiCMCallback & older ) const
+      {
+         const cRFInfoCallback & cb = 
+            static_cast <const cRFInfoCallback &>( older );
+
+         return (cb.mRadioInterface == mRadioInterface);
+      };
+
    protected:
       // (Inline) Call the function
       virtual void Call()
@@ -687,7 +776,8 @@ class cLURejectCallback : public cGobiCMCallback
          tFNLUReject                pCallback,
          ULONG                      serviceDomain,
          ULONG                      rejectCause )
-         :  mpCallback( pCallback ),
+         :  cGobiCMCallback( eGOBI_CM_CB_LU_REJECT ),
+            mpCallback( pCallback ),
             mServiceDomain( serviceDomain ),
             mRejectCause( rejectCause )
       { };
@@ -726,7 +816,8 @@ class cPLMNModeCallback : public cGobiCMCallback
       cPLMNModeCallback(
          tFNPLMNMode                pCallback,
          ULONG                      mode )
-         :  mpCallback( pCallback ),
+         :  cGobiCMCallback( eGOBI_CM_CB_PLMN_MODE ),
+            mpCallback( pCallback ),
             mMode( mode )
       { };
 
@@ -764,7 +855,8 @@ class cNewSMSCallback : public cGobiCMCallback
          tFNNewSMS                  pCallback,
          ULONG                      storageType,
          ULONG                      messageIndex )
-         :  mpCallback( pCallback ),
+         :  cGobiCMCallback( eGOBI_CM_CB_NEW_SMS ),
+            mpCallback( pCallback ),
             mStorageType( storageType ),
             mMessageIndex( messageIndex )
       { };
@@ -803,7 +895,8 @@ class cNewNMEACallback : public cGobiCMCallback
       cNewNMEACallback(
          tFNNewNMEA                 pCallback,
          std::string &              nmea )
-         :  mpCallback( pCallback )
+         :  cGobiCMCallback( eGOBI_CM_CB_NEW_NMEA ),
+            mpCallback( pCallback )
       {
          memset( (LPVOID)&mNMEA[0], 0, 512 );
 
@@ -850,7 +943,8 @@ class cPDSStateCallback : public cGobiCMCallback
          tFNPDSState                pCallback,
          ULONG                      enabledState,
          ULONG                      trackingState )
-         :  mpCallback( pCallback ),
+         :  cGobiCMCallback( eGOBI_CM_CB_PDS_STATE ),
+            mpCallback( pCallback ),
             mEnabledState( enabledState ),
             mTrackingState( trackingState )
       { };
@@ -891,7 +985,8 @@ class cCATEventCallback : public cGobiCMCallback
          ULONG                      eventID,
          ULONG                      eventLen,
          const BYTE *               pEventData )
-         :  mpCallback( pCallback ),
+         :  cGobiCMCallback( eGOBI_CM_CB_CAT_EVENT ),
+            mpCallback( pCallback ),
             mEventID( eventID ),
             mEventLen( 0 )
       {
@@ -942,7 +1037,8 @@ class cOMADMAlertCallback : public cGobiCMCallback
          tFNOMADMAlert              pCallback,
          ULONG                      sessionType,
          USHORT                     sessionID )
-         :  mpCallback( pCallback ),
+         :  cGobiCMCallback( eGOBI_CM_CB_OMADM_ALERT ),
+            mpCallback( pCallback ),
             mSessionType( sessionType ),
             mSessionID( sessionID )
       { };
@@ -982,7 +1078,8 @@ class cOMADMStateCallback : public cGobiCMCallback
          tFNOMADMState              pCallback,
          ULONG                      sessionState,
          ULONG                      failureReason )
-         :  mpCallback( pCallback ),
+         :  cGobiCMCallback( eGOBI_CM_CB_OMADM_STATE ),
+            mpCallback( pCallback ),
             mSessionState( sessionState ),
             mFailureReason( failureReason )
       { };
@@ -1019,7 +1116,8 @@ class cUSSDReleaseCallback : public cGobiCMCallback
    public:
       // (Inline) Constructor
       cUSSDReleaseCallback( tFNUSSDRelease pCallback )
-         :  mpCallback( pCallback )
+         :  cGobiCMCallback( eGOBI_CM_CB_USSD_RELEASE ),
+            mpCallback( pCallback )
       { };
 
       // (Inline) Destructor
@@ -1053,7 +1151,8 @@ class cUSSDNotificationCallback : public cGobiCMCallback
          tFNUSSDNotification        pCallback,
          ULONG                      type,
          const BYTE *               pData )
-         :  mpCallback( pCallback ),
+         :  cGobiCMCallback( eGOBI_CM_CB_USSD_NOTIFICATION ),
+            mpCallback( pCallback ),
             mType( type ),
             mbData( false )
       {
@@ -1116,7 +1215,8 @@ class cUSSDOriginationCallback : public cGobiCMCallback
          ULONG                      failureCause,
          const BYTE *               pNetworkInfo,
          const BYTE *               pAlpha )
-         :  mpCallback( pCallback ),
+         :  cGobiCMCallback( eGOBI_CM_CB_USSD_ORIGINATION ),
+            mpCallback( pCallback ),
             mErrorCode( errorCode ),
             mFailureCause( failureCause ),
             mbNetwork( false ),
@@ -1180,6 +1280,514 @@ class cUSSDOriginationCallback : public cGobiCMCallback
       bool mbAlpha;
 };
 
+/*=========================================================================*/
+// Struct sGobiCMCallbackStats
+//
+//    Callback pool queue metrics
+/*=========================================================================*/
+struct sGobiCMCallbackStats
+{
+   public:
+      // (Inline) Constructor
+      sGobiCMCallbackStats()
+         :  mDepth( 0 ),
+            mPeakDepth( 0 ),
+            mSubmitted( 0 ),
+            mCoalesced( 0 ),
+            mCompleted( 0 )
+      { };
+
+      /* Number of callbacks currently queued (not yet running) */
+      ULONG mDepth;
+
+      /* Highest value of the above */
+      ULONG mPeakDepth;
+
+      /* Number of callbacks submitted */
+      ULONGLONG mSubmitted;
+
+      /* Number of queued callbacks dropped as superseded */
+      ULONGLONG mCoalesced;
+
+      /* Number of callbacks run */
+      ULONGLONG mCompleted;
+};
+
+/*=========================================================================*/
+// Class cGobiCMCallbackPool
+//
+//    Fixed size pool of threads executing queued callbacks, callbacks of
+//    a given type are run one at a time in the order they were submitted
+/*=========================================================================*/
+class cGobiCMCallbackPool
+{
+   public:
+      // Constructor
+      cGobiCMCallbackPool();
+
+      // Destructor
+      virtual ~cGobiCMCallbackPool();
+
+      // Queue a callback to be run (and deleted) by a pool thread,
+      // starting the pool threads upon first use
+      bool Submit( cGobiCMCallback * pCB );
+
+      // Run the queued callbacks and then exit the pool threads
+      bool Exit();
+
+      // Return the queue metrics
+      sGobiCMCallbackStats GetStats();
+
+      // Set the thread configuration pool threads are started with
+      void SetThreadConfig( const cThreadConfig & config );
+
+   protected:
+      // Start the pool threads (mutex must be held)
+      bool StartThreads();
+
+      // Callbacks queued for a single callback type
+      struct sTypeQueue
+      {
+         public:
+            // (Inline) Constructor
+            sTypeQueue()
+               :  mbReady( false ),
+                  mbRunning( false )
+            { };
+
+            /* Callbacks not yet run, oldest first */
+            std::deque <cGobiCMCallback *> mPending;
+
+            /* Is this type in mReady? */
+            bool mbReady;
+
+            /* Is a callback of this type running? */
+            bool mbRunning;
+      };
+
+      /* Per type callback queues */
+      sTypeQueue mQueues[eGOBI_CM_CB_END];
+
+      /* Types with a callback ready to run, in order of readiness */
+      std::deque <eGobiCMCallbackType> mReady;
+
+      /* Pool threads */
+      pthread_t mThreadIDs[CALLBACK_POOL_THREADS];
+
+      /* Number of running pool threads */
+      ULONG mThreadCount;
+
+      /* Thread configuration of the pool threads */
+      cThreadConfig mThreadConfig;
+
+      /* Are the pool threads exiting? */
+      bool mbExiting;
+
+      /* Queue metrics */
+      sGobiCMCallbackStats mStats;
+
+      /* Synchronization object (guards all of the above) */
+      pthread_mutex_t mSyncSection;
+
+      /* Signalled when a type becomes ready (or upon exit) */
+      pthread_cond_t mReadyCond;
+
+      // Pool threads get full access
+      friend void * CallbackThread( PVOID pArg );
+
+   private:
+      // Unsupported
+      cGobiCMCallbackPool( const cGobiCMCallbackPool & );
+      cGobiCMCallbackPool & operator = ( const cGobiCMCallbackPool & );
+};
+
+/*=========================================================================*/
+// Class cGobiCMParsePool
+//
+//    Fixed size pool of threads parsing the indications handed over by the
+//    traffic processing thread, indications of a given service are parsed
+//    one at a time in the order they were received (so that a burst on one
+//    service does not hold up the others)
+/*=========================================================================*/
+class cGobiConnectionMgmt;
+
+class cGobiCMParsePool
+{
+   public:
+      // Constructor
+      cGobiCMParsePool( cGobiConnectionMgmt * pAPI );
+
+      // Destructor
+      virtual ~cGobiCMParsePool();
+
+      // Queue indications of a service to be parsed by a pool thread,
+      // starting the pool threads upon first use
+      bool Submit(
+         eQMIService                         svc,
+         const std::vector <sProtocolBuffer> & bufs );
+
+      // Parse the queued indications and then exit the pool threads (the
+      // pool can be restarted)
+      bool Exit();
+
+      // Set the thread configuration pool threads are started with
+      void SetThreadConfig( const cThreadConfig & config );
+
+   protected:
+      // Start the pool threads (mutex must be held)
+      bool StartThreads();
+
+      // Indications queued for a single service
+      struct sServiceQueue
+      {
+         public:
+            // (Inline) Constructor
+            sServiceQueue()
+               :  mbReady( false ),
+                  mbRunning( false )
+            { };
+
+            /* Indications not yet parsed, oldest first */
+            std::deque <sProtocolBuffer> mPending;
+
+            /* Is this service in mReady? */
+            bool mbReady;
+
+            /* Are indications of this service being parsed? */
+            bool mbRunning;
+      };
+
+      /* Object the indications are parsed by */
+      cGobiConnectionMgmt * mpAPI;
+
+      /* Per service indication queues */
+      std::map <eQMIService, sServiceQueue> mQueues;
+
+      /* Services with indications ready to parse, in order of readiness */
+      std::deque <eQMIService> mReady;
+
+      /* Pool threads */
+      pthread_t mThreadIDs[PARSE_POOL_THREADS];
+
+      /* Number of running pool threads */
+      ULONG mThreadCount;
+
+      /* Thread configuration of the pool threads */
+      cThreadConfig mThreadConfig;
+
+      /* Are the pool threads exiting? */
+      bool mbExiting;
+
+      /* Synchronization object (guards all of the above) */
+      pthread_mutex_t mSyncSection;
+
+      /* Signalled when a service becomes ready (or upon exit) */
+      pthread_cond_t mReadyCond;
+
+      // Pool threads get full access
+      friend void * ParseThread( PVOID pArg );
+
+   private:
+      // Unsupported
+      cGobiCMParsePool( const cGobiCMParsePool & );
+      cGobiCMParsePool & operator = ( const cGobiCMParsePool & );
+};
+
+/*=========================================================================*/
+// Enum eGobiPositionValid
+//
+//    Valid field mask of a sGobiPositionReport (as reported by the device)
+/*=========================================================================*/
+enum eGobiPositionValid
+{
+   eGOBI_POS_CALENDAR               = 0x00000001,
+   eGOBI_POS_UTC_TIMESTAMP          = 0x00000002,
+   eGOBI_POS_LEAP_SECONDS           = 0x00000004,
+   eGOBI_POS_TIME_UNCERTAINTY       = 0x00000008,
+   eGOBI_POS_LATITUDE               = 0x00000010,
+   eGOBI_POS_LONGITUDE              = 0x00000020,
+   eGOBI_POS_ELLIPSOID_ALTITUDE     = 0x00000040,
+   eGOBI_POS_MSL_ALTITUDE           = 0x00000080,
+   eGOBI_POS_HORIZONTAL_SPEED       = 0x00000100,
+   eGOBI_POS_VERTICAL_SPEED         = 0x00000200,
+   eGOBI_POS_HEADING                = 0x00000400,
+   eGOBI_POS_H_UNCERTAINTY_CIRCULAR = 0x00000800,
+   eGOBI_POS_H_UNCERTAINTY_MAJOR    = 0x00001000,
+   eGOBI_POS_H_UNCERTAINTY_MINOR    = 0x00002000,
+   eGOBI_POS_H_UNCERTAINTY_AZIMUTH  = 0x00004000,
+   eGOBI_POS_V_UNCERTAINTY          = 0x00008000,
+   eGOBI_POS_H_VELOCITY_UNCERTAINTY = 0x00010000,
+   eGOBI_POS_V_VELOCITY_UNCERTAINTY = 0x00020000,
+   eGOBI_POS_H_CONFIDENCE           = 0x00040000,
+   eGOBI_POS_PDOP                   = 0x00080000,
+   eGOBI_POS_HDOP                   = 0x00100000,
+   eGOBI_POS_VDOP                   = 0x00200000,
+   eGOBI_POS_OPERATING_MODE         = 0x00400000
+};
+
+/*=========================================================================*/
+// Struct sGobiPositionReport
+//
+//    Position fix streamed by cGobiConnectionMgmt (decoded from the parsed
+//    position data of a PDS event report), fields are only meaningful
+//    when flagged in the valid field mask
+/*=========================================================================*/
+struct sGobiPositionReport
+{
+   public:
+      // (Inline) Constructor
+      sGobiPositionReport()
+      {
+         memset( (LPVOID)this, 0, sizeof( *this ) );
+      };
+
+      /* Number of the report (counting every report received, a gap 
+         means reports were dropped) */
+      ULONG mSequence;
+
+      /* Time the report was received (GetTickCount() milliseconds) */
+      ULONGLONG mReceived;
+
+      /* Valid field mask (eGobiPositionValid) */
+      ULONG mValid;
+
+      /* Calendar time */
+      WORD mYear;
+      BYTE mMonth;
+      BYTE mDayOfWeek;
+      BYTE mDay;
+      BYTE mHour;
+      BYTE mMinute;
+      BYTE mSecond;
+      WORD mMillisecond;
+      BYTE mLeapSeconds;
+
+      /* UTC timestamp (milliseconds since the epoch) and uncertainty */
+      ULONGLONG mUTCTimestamp;
+      ULONG mTimeUncertainty;
+
+      /* Position (degrees, meters) */
+      DOUBLE mLatitude;
+      DOUBLE mLongitude;
+      FLOAT mEllipsoidAltitude;
+      FLOAT mMSLAltitude;
+
+      /* Velocity (meters/second, degrees) */
+      FLOAT mHorizontalSpeed;
+      FLOAT mVerticalSpeed;
+      FLOAT mHeading;
+
+      /* Uncertainties (meters, meters/second, degrees) */
+      FLOAT mHUncertaintyCircular;
+      FLOAT mHUncertaintyMajor;
+      FLOAT mHUncertaintyMinor;
+      FLOAT mHUncertaintyAzimuth;
+      FLOAT mVUncertainty;
+      FLOAT mHVelocityUncertainty;
+      FLOAT mVVelocityUncertainty;
+      BYTE mHConfidence;
+
+      /* Dilutions of precision */
+      FLOAT mPDOP;
+      FLOAT mHDOP;
+      FLOAT mVDOP;
+
+      /* Operating mode used */
+      BYTE mOperatingMode;
+};
+
+/*=========================================================================*/
+// Enum eGobiSessionStatsValid
+//
+//    Groups of counters present in a session statistics snapshot
+/*=========================================================================*/
+enum eGobiSessionStatsValid
+{
+   eGOBI_STATS_PACKETS              = 0x00000001,
+   eGOBI_STATS_BYTES                = 0x00000002,
+   eGOBI_STATS_CHANNEL_RATES        = 0x00000004
+};
+
+/*=========================================================================*/
+// Struct sGobiSessionStats
+//
+//    Latest data session statistics pushed by the device in WDS event 
+//    reports (see cGobiConnectionMgmt::SetSessionStatsInterval()), counters
+//    are only meaningful when their group is flagged in the valid mask
+/*=========================================================================*/
+struct sGobiSessionStats
+{
+   public:
+      // (Inline) Constructor
+      sGobiSessionStats()
+      {
+         memset( (LPVOID)this, 0, sizeof( *this ) );
+      };
+
+      /* Number of event reports folded into the snapshot */
+      ULONG mReports;
+
+      /* Time of the latest event report (GetTickCount() milliseconds) */
+      ULONGLONG mReceived;
+
+      /* Valid counter mask (eGobiSessionStatsValid) */
+      ULONG mValid;
+
+      /* Packet counters (eGOBI_STATS_PACKETS) */
+      ULONG mTXPacketSuccesses;
+      ULONG mRXPacketSuccesses;
+      ULONG mTXPacketErrors;
+      ULONG mRXPacketErrors;
+      ULONG mTXPacketOverflows;
+      ULONG mRXPacketOverflows;
+
+      /* Byte counters (eGOBI_STATS_BYTES) */
+      ULONGLONG mTXTotalBytes;
+      ULONGLONG mRXTotalBytes;
+
+      /* Current channel rates in bps (eGOBI_STATS_CHANNEL_RATES) */
+      ULONG mTXChannelRate;
+      ULONG mRXChannelRate;
+};
+
+/*=========================================================================*/
+// Enum eGobiSignalStateValid
+//
+//    Groups of values present in a signal state snapshot
+/*=========================================================================*/
+enum eGobiSignalStateValid
+{
+   eGOBI_SIGNAL_STRENGTHS           = 0x00000001,
+   eGOBI_SIGNAL_RF_INFO             = 0x00000002,
+   eGOBI_SIGNAL_SERVING_NETWORK     = 0x00000004
+};
+
+/*=========================================================================*/
+// Struct sGobiSignalState
+//
+//    Latest signal strengths, RF information and serving system pushed by
+//    the device in NAS indications (see cGobiConnectionMgmt::
+//    SetSignalMonitor()), values are only meaningful when their group is
+//    flagged in the valid mask
+/*=========================================================================*/
+struct sGobiSignalState
+{
+   public:
+      // (Inline) Constructor
+      sGobiSignalState()
+      {
+         memset( (LPVOID)this, 0, sizeof( *this ) );
+      };
+
+      /* Number of indications folded into the snapshot */
+      ULONG mReports;
+
+      /* Time of the latest indication (GetTickCount() milliseconds) */
+      ULONGLONG mReceived;
+
+      /* Valid value mask (eGobiSignalStateValid) */
+      ULONG mValid;
+
+      /* Signal strengths in dBm, by radio interface, along with the 
+         threshold band each one is in, i.e. the number of thresholds at
+         or below it (eGOBI_SIGNAL_STRENGTHS) */
+      ULONG mSignalCount;
+      INT8 mSignalStrengths[GOBI_SNAPSHOT_MAX_SIGNALS];
+      ULONG mSignalRadioIfaces[GOBI_SNAPSHOT_MAX_SIGNALS];
+      ULONG mSignalBands[GOBI_SNAPSHOT_MAX_SIGNALS];
+
+      /* Active band class/channel by radio interface (eGOBI_SIGNAL_RF_INFO) */
+      BYTE mRFInfoCount;
+      ULONG mRFRadioIfaces[GOBI_SNAPSHOT_MAX_RADIO_IFACES];
+      ULONG mRFBandClasses[GOBI_SNAPSHOT_MAX_RADIO_IFACES];
+      ULONG mRFChannels[GOBI_SNAPSHOT_MAX_RADIO_IFACES];
+
+      /* Serving network (eGOBI_SIGNAL_SERVING_NETWORK) */
+      ULONG mRegistrationState;
+      ULONG mCSDomain;
+      ULONG mPSDomain;
+      ULONG mRAN;
+      BYTE mRadioIfaceCount;
+      ULONG mRadioIfaces[GOBI_SNAPSHOT_MAX_RADIO_IFACES];
+      ULONG mRoaming;
+      WORD mMCC;
+      WORD mMNC;
+      CHAR mNetworkName[GOBI_SNAPSHOT_NAME_SZ];
+};
+
+/*=========================================================================*/
+// Struct sGobiOMADMSession
+//
+//    OMA-DM session state pushed by the device in OMA event reports (see 
+//    cGobiConnectionMgmt::StartOMADMTracker()), ULONG_MAX/USHRT_MAX when
+//    not (yet) known
+/*=========================================================================*/
+struct sGobiOMADMSession
+{
+   public:
+      // (Inline) Constructor
+      sGobiOMADMSession()
+         :  mReports( 0 ),
+            mStateReports( 0 ),
+            mReceived( 0 ),
+            mSessionState( ULONG_MAX ),
+            mSessionType( ULONG_MAX ),
+            mFailureReason( ULONG_MAX ),
+            mbNIAPending( false ),
+            mNIASessionType( ULONG_MAX ),
+            mNIASessionID( USHRT_MAX )
+      { };
+
+      /* Number of indications folded into the state, and of those that
+         carried a session state */
+      ULONG mReports;
+      ULONG mStateReports;
+
+      /* Time of the latest indication (GetTickCount() milliseconds) */
+      ULONGLONG mReceived;
+
+      /* State, type and failure reason of the current (or previous) 
+         session, the type is only known from the initial query */
+      ULONG mSessionState;
+      ULONG mSessionType;
+      ULONG mFailureReason;
+
+      /* Latest network initiated alert, pending until a session is 
+         started or a selection is sent */
+      bool mbNIAPending;
+      ULONG mNIASessionType;
+      USHORT mNIASessionID;
+};
+
+/*=========================================================================*/
+// Class cGobiCMReconnector
+//
+//    Hot-plug callback through which a connection management object
+//    follows its device node going away and coming back (see 
+//    cGobiConnectionMgmt::SetAutoReconnect())
+/*=========================================================================*/
+class cGobiCMReconnector : public cGobiDeviceCallback
+{
+   public:
+      // (Inline) Constructor
+      cGobiCMReconnector( cGobiConnectionMgmt * pAPI )
+         :  mpAPI( pAPI )
+      { };
+
+      // (Inline) Destructor
+      virtual ~cGobiCMReconnector() { };
+
+      // A device has been added (or its key has changed)
+      virtual void DeviceAdded( const cGobiQMICore::tDeviceID & device );
+
+      // A device has been removed
+      virtual void DeviceRemoved( const cGobiQMICore::tDeviceID & device );
+
+   protected:
+      /* Object being reconnected */
+      cGobiConnectionMgmt * mpAPI;
+};
+
 /*=========================================================================*/
 // Class cGobiConnectionMgmt
 /*=========================================================================*/
@@ -1200,6 +1808,18 @@ class cGobiConnectionMgmt : public cGobiQMICore
       // Disconnect from the currently connected Gobi device
       virtual bool Disconnect();
 
+      // Reconnect automatically when the device node of the connected 
+      // device goes away (modem reset, USB re-enumeration) and comes back,
+      // restoring every callback, this requires a device manager (see
+      // SetDeviceManager())
+      bool SetAutoReconnect( bool bEnable );
+
+      // (Inline) Is automatic reconnection enabled?
+      bool GetAutoReconnect()
+      {
+         return mbAutoReconnect;
+      };
+
       // Enable/disable session state callback function
       eGobiError SetSessionStateCallback( tFNSessionState pCallback );
 
@@ -1255,6 +1875,26 @@ class cGobiConnectionMgmt : public cGobiQMICore
       // Enable/disable PDS service state callback function
       eGobiError SetPDSStateCallback( tFNPDSState pCallback );
 
+      // Start streaming position reports (the depth of the report ring 
+      // is set by the first start)
+      eGobiError StartPositionStream( 
+         ULONG                      depth = DEFAULT_POSITION_STREAM_DEPTH );
+
+      // Stop streaming position reports
+      eGobiError StopPositionStream();
+
+      // Return the oldest streamed position report, without waiting
+      bool GetPositionReport( sGobiPositionReport & report );
+
+      // Return the oldest streamed position report, waiting up to the
+      // given timeout (in milliseconds) for one to arrive
+      bool WaitPositionReport( 
+         sGobiPositionReport &      report,
+         ULONG                      to );
+
+      // Return the number of position reports dropped as the ring was full
+      ULONG GetDroppedPositionReports();
+
       // Enable/disable CAT event callback function
       eGobiError SetCATEventCallback( 
          tFNCATEvent                pCallback,
@@ -1267,6 +1907,32 @@ class cGobiConnectionMgmt : public cGobiQMICore
       // Enable/disable OMA-DM state callback function
       eGobiError SetOMADMStateCallback( tFNOMADMState pCallback );
 
+      // Start tracking the OMA-DM session state from the device's OMA 
+      // event reports
+      eGobiError StartOMADMTracker();
+
+      // Stop tracking the OMA-DM session state
+      eGobiError StopOMADMTracker();
+
+      // Return the tracked OMA-DM session state
+      bool GetOMADMSession( sGobiOMADMSession & session );
+
+      // Wait up to the given timeout (in milliseconds) for a session to 
+      // complete or fail, as reported after the given number of session
+      // state reports
+      eGobiError WaitOMADMSession( 
+         ULONG                      afterReports,
+         ULONG                      to,
+         sGobiOMADMSession &        session );
+
+      // Start an OMA-DM session (the tracked alert is no longer pending)
+      eGobiError OMADMStartSession( ULONG sessionType );
+
+      // Send an OMA-DM selection (the tracked alert is no longer pending)
+      eGobiError OMADMSendSelection( 
+         ULONG                      selection, 
+         USHORT                     sessionID );
+
       // Enable/disable USSD release callback function
       eGobiError SetUSSDReleaseCallback( tFNUSSDRelease pCallback );
 
@@ -1276,10 +1942,127 @@ class cGobiConnectionMgmt : public cGobiQMICore
       // Enable/disable USSD origination callback function
       eGobiError SetUSSDOriginationCallback( tFNUSSDOrigination pCallback );
 
+      // Start (interval > 0) or stop (interval = 0) serving the session
+      // statistics from the device's periodic WDS event reports
+      eGobiError SetSessionStatsInterval( BYTE interval );
+
+      // Return the latest reported session statistics
+      bool GetSessionStats( sGobiSessionStats & stats );
+
+      // Return the packet statistics (served from the session statistics
+      // when they are being reported)
+      eGobiError GetPacketStatus(  
+         ULONG *                    pTXPacketSuccesses, 
+         ULONG *                    pRXPacketSuccesses, 
+         ULONG *                    pTXPacketErrors, 
+         ULONG *                    pRXPacketErrors, 
+         ULONG *                    pTXPacketOverflows, 
+         ULONG *                    pRXPacketOverflows );
+
+      // Return the RX/TX byte counts (served from the session statistics
+      // when they are being reported)
+      eGobiError GetByteTotals(   
+         ULONGLONG *                pTXTotalBytes, 
+         ULONGLONG *                pRXTotalBytes );
+
+      // Start (thresholds given) or stop (no thresholds) serving the signal
+      // state from the device's NAS indications, the device pushes signal 
+      // strengths as they cross the thresholds, and the callback is only 
+      // run when a strength moves to another threshold band (by more than 
+      // the hysteresis, in dB)
+      eGobiError SetSignalMonitor( 
+         const std::list <INT8> &   thresholds,
+         BYTE                       hysteresis = 0,
+         tFNSignalStrength          pCallback = 0 );
+
+      // Return the latest pushed signal state
+      bool GetSignalState( sGobiSignalState & state );
+
+      // Return the signal strengths (served from the signal state when the
+      // signal monitor is running)
+      eGobiError GetSignalStrengths( 
+         ULONG *                    pArraySizes, 
+         INT8 *                     pSignalStrengths, 
+         ULONG *                    pRadioInterfaces );
+
+      // Return the RF information (served from the signal state when the
+      // signal monitor is running)
+      eGobiError GetRFInfo( 
+         BYTE *                     pInstanceSize, 
+         BYTE *                     pInstances );
+
+      // Return the serving network (served from the signal state when the
+      // signal monitor is running)
+      eGobiError GetServingNetwork( 
+         ULONG *                    pRegistrationState, 
+         ULONG *                    pCSDomain, 
+         ULONG *                    pPSDomain, 
+         ULONG *                    pRAN, 
+         BYTE *                     pRadioIfacesSize, 
+         BYTE *                     pRadioIfaces, 
+         ULONG *                    pRoaming, 
+         WORD *                     pMCC, 
+         WORD *                     pMNC, 
+         BYTE                       nameSize, 
+         CHAR *                     pName );
+
+      // (Inline) Return the callback queue metrics
+      sGobiCMCallbackStats GetCallbackStats()
+      {
+         return mCallbackPool.GetStats();
+      };
+
    protected:
-      // Process new traffic
+      // Start the traffic processing thread (connect mutex must be held)
+      void StartTraffic();
+
+      // Stop the traffic processing thread and disconnect the servers,
+      // leaving the callbacks in place (connect mutex must be held)
+      bool Teardown();
+
+      // Send an indication registration request (see SendAndCheckReturn())
+      // caching it upon success for replay upon reconnection
+      eGobiError SendRegistration(
+         eQMIService                svc,
+         sSharedBuffer *            pRequest );
+
+      // Cache the TLVs of a successful registration request
+      void RecordRegistration(
+         eQMIService                svc,
+         const sProtocolBuffer &    req );
+
+      // Send the cached registrations again, merged into one request per
+      // message ID and sent in one batch per service
+      eGobiError RestoreRegistrations();
+
+      // The device node of the connected device has gone away
+      void DeviceDeparted( const tDeviceID & device );
+
+      // A device node has come (back)
+      void DeviceReturned( const tDeviceID & device );
+
+      // Process new traffic (handing the indications over to the parse 
+      // pool)
       void ProcessTraffic( eQMIService svc );
 
+      // Parse an indication of the given service
+      void ParseIndication( 
+         eQMIService                svc,
+         const sProtocolBuffer &    buf );
+
+      // Rebuild the indication dispatch tables from the enabled callbacks
+      void UpdateIndicationTables();
+
+      // Enable/disable dispatching of the given indication
+      void EnableIndication(
+         eQMIService                svc,
+         ULONG                      msgID,
+         bool                       bEnable );
+
+      // An on-demand service with indications being dispatched must be
+      // kept up
+      virtual bool IsServerReapable( eQMIService svc );
+
       // Process QMI traffic
       void ProcessWDSBuffer( const sProtocolBuffer & buf );
       void ProcessDMSBuffer( const sProtocolBuffer & buf );
@@ -1290,6 +2073,64 @@ class cGobiConnectionMgmt : public cGobiQMICore
       void ProcessOMABuffer( const sProtocolBuffer & buf );
       void ProcessVoiceBuffer( const sProtocolBuffer & buf );
 
+      // Decode a PDS event report into the position stream
+      void PublishPosition( const sProtocolBuffer & buf );
+
+      // Configure the statistics carried by the WDS event reports
+      eGobiError SendStatisticsReport(
+         BYTE                       interval,
+         bool                       bAll );
+
+      // Fold a WDS event report into the session statistics
+      void PublishSessionStats( const sProtocolBuffer & buf );
+
+      // Return the session statistics if they are current
+      bool GetCurrentSessionStats( sGobiSessionStats & stats );
+
+      // Configure the signal strength thresholds of the NAS event reports,
+      // i.e. the given thresholds of the signal strength callback merged
+      // with those of the signal monitor
+      eGobiError SendSignalThresholds( const std::list <INT8> & thresholds );
+
+      // Turn the RF information of the NAS event reports on/off
+      eGobiError SendRFInfoReport( bool bOn );
+
+      // Fill the signal state from queries (values already pushed are 
+      // kept), when starting the signal monitor
+      void SeedSignalState( bool bRFInfo );
+
+      // Fold a NAS event report/serving system indication into the signal
+      // state
+      void PublishSignalReport( const sProtocolBuffer & buf );
+      void PublishServingSystem( const sProtocolBuffer & buf );
+
+      // Return the signal state if the signal monitor is running and the
+      // given values are present
+      bool GetCurrentSignalState( 
+         ULONG                      valid,
+         sGobiSignalState &         state );
+
+      // Turn the NIA/session state parts of the OMA event reports on/off
+      eGobiError SendOMADMEvents(
+         bool                       bNIA,
+         bool                       bState );
+
+      // Fill the OMA-DM session state from a query (a state already
+      // pushed is kept), when starting the OMA-DM session tracker
+      void SeedOMADMSession();
+
+      // Fold an OMA event report into the OMA-DM session state
+      void PublishOMADMEvent(
+         bool                       bNIA,
+         ULONG                      niaSessionType,
+         USHORT                     niaSessionID,
+         bool                       bState,
+         ULONG                      sessionState,
+         ULONG                      failureReason );
+
+      // The tracked network initiated alert is no longer pending
+      void ClearOMADMAlert();
+
       /* Is there an active thread? */
       bool mbThreadStarted;
 
@@ -1302,15 +2143,54 @@ class cGobiConnectionMgmt : public cGobiQMICore
       /* Has the protocol server thread finished cleanup? */
       bool mThreadCleanupFinished;
 
-      /* Number of buffers processed by ProcessTraffic() (per server) */
-      ULONG mWDSItemsProcessed;
-      ULONG mDMSItemsProcessed;
-      ULONG mNASItemsProcessed;
-      ULONG mWMSItemsProcessed;
-      ULONG mPDSItemsProcessed;
-      ULONG mCATItemsProcessed;
-      ULONG mOMAItemsProcessed;
-      ULONG mVoiceItemsProcessed;
+      // QMI indication handler
+      typedef void (cGobiConnectionMgmt::* tIndicationHandler)( 
+         const sProtocolBuffer &    buf );
+
+      // Indication dispatch table of a single service
+      struct sIndicationTable
+      {
+         public:
+            // (Inline) Default constructor (results in an idle table)
+            sIndicationTable()
+               :  mRxType( ePROTOCOL_ENUM_BEGIN ),
+                  mpHandler( 0 ),
+                  mEnabledCount( 0 ),
+                  mItemsProcessed( 0 )
+            {
+               memset( &mEnabled[0], 0, sizeof( mEnabled ) );
+            };
+
+            // (Inline) Parameter constructor
+            sIndicationTable(
+               eProtocolType              rxType,
+               tIndicationHandler         pHandler )
+               :  mRxType( rxType ),
+                  mpHandler( pHandler ),
+                  mEnabledCount( 0 ),
+                  mItemsProcessed( 0 )
+            {
+               memset( &mEnabled[0], 0, sizeof( mEnabled ) );
+            };
+
+            /* Protocol type of the service's incoming buffers */
+            eProtocolType mRxType;
+
+            /* Handler of the enabled indications */
+            tIndicationHandler mpHandler;
+
+            /* Is the indication with the given message ID enabled? */
+            bool mEnabled[MAX_INDICATION_ID + 1];
+
+            /* Number of enabled indications */
+            ULONG mEnabledCount;
+
+            /* Number of log buffers processed by ProcessTraffic() */
+            ULONG mItemsProcessed;
+      };
+
+      /* Indication dispatch tables (per service) */
+      std::map <eQMIService, sIndicationTable> mIndications;
 
       /* Callback functions */
       tFNSessionState mpFNSessionState;
@@ -1337,8 +2217,95 @@ class cGobiConnectionMgmt : public cGobiQMICore
       tFNUSSDNotification mpFNUSSDNotification;
       tFNUSSDOrigination mpFNUSSDOrigination;
 
+      /* Threads the above callbacks are executed on */
+      cGobiCMCallbackPool mCallbackPool;
+
+      /* Position stream (produced by the PDS indication parsing) */
+      cSPSCRing <sGobiPositionReport> * mpPositionRing;
+      volatile bool mbPositionStream;
+      ULONG mPositionSequence;
+
+      /* Is the consumer waiting on a position report? */
+      volatile ULONG mPositionWaiting;
+
+      /* Synchronization of waiting on a position report */
+      pthread_mutex_t mPositionMutex;
+      pthread_cond_t mPositionCond;
+
+      /* Interval of the byte totals callback's event reports */
+      BYTE mByteTotalsInterval;
+
+      /* Interval of the session statistics event reports (0 = off) */
+      volatile BYTE mSessionStatsInterval;
+
+      /* Time the session statistics were started (GetTickCount()) */
+      ULONGLONG mSessionStatsStart;
+
+      /* Session statistics (written by the WDS indication parsing, 
+         read under the sequence count, odd while being written) */
+      volatile ULONG mSessionStatsSequence;
+      sGobiSessionStats mSessionStats;
+
+      /* Is the signal monitor running? */
+      volatile bool mbSignalMonitor;
+
+      /* Signal monitor thresholds (ascending), hysteresis and callback */
+      INT8 mMonitorThresholds[MAX_SIGNAL_THRESHOLDS];
+      ULONG mMonitorThresholdCount;
+      BYTE mMonitorHysteresis;
+      tFNSignalStrength mpFNSignalMonitor;
+
+      /* Thresholds of the signal strength callback */
+      std::list <INT8> mSignalThresholds;
+
+      /* Signal state (written under the mutex, read under the sequence 
+         count, odd while being written) */
+      pthread_mutex_t mSignalStateMutex;
+      volatile ULONG mSignalStateSequence;
+      sGobiSignalState mSignalState;
+
+      /* Is the OMA-DM session tracker running? */
+      volatile bool mbOMADMTracker;
+
+      /* OMA-DM session state (written by the OMA indication parsing, 
+         read and waited on under the mutex) */
+      pthread_mutex_t mOMADMMutex;
+      pthread_cond_t mOMADMCond;
+      sGobiOMADMSession mOMADMSession;
+
+      /* Threads the indications are parsed on */
+      cGobiCMParsePool mParsePool;
+
+      /* Reconnect automatically? */
+      bool mbAutoReconnect;
+
+      /* Hot-plug callback (registered while reconnecting automatically) */
+      cGobiCMReconnector mReconnector;
+
+      /* Device awaiting reconnection (empty node for none) */
+      tDeviceID mLostDevice;
+
+      /* Synchronization object serializing connecting, disconnecting and
+         reconnecting (guards mLostDevice) */
+      pthread_mutex_t mConnectMutex;
+
+      /* Cached registrations, the TLVs (by type ID) of the successful 
+         registration requests of each service/message ID */
+      typedef std::pair <eQMIService, WORD> tRegistrationKey;
+      typedef std::map <BYTE, std::vector <BYTE> > tRegistrationTLVs;
+      std::map <tRegistrationKey, tRegistrationTLVs> mRegistrations;
+
+      /* Mutex protecting mRegistrations */
+      pthread_mutex_t mRegistrationsMutex;
+
       // Traffic process thread gets full access
       friend VOID * TrafficProcessThread( PVOID pArg );
+
+      // ... as does the hot-plug callback
+      friend class cGobiCMReconnector;
+
+      // ... as do the parse pool threads
+      friend void * ParseThread( PVOID pArg );
 };
 
 /*=========================================================================*/
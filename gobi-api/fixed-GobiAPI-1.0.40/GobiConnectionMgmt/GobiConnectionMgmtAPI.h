@@ -104,6 +104,15 @@ typedef void (* tFNNewSMS)(
    ULONG                      storageType,
    ULONG                      messageIndex );
 
+// SMS message read callback function (GetSMSBatch)
+typedef void (* tFNSMSRead)( 
+   ULONG                      messageIndex,
+   ULONG                      status,
+   ULONG                      messageTag,
+   ULONG                      messageFormat,
+   ULONG                      messageSize,
+   const BYTE *               pMessage );
+
 // New NMEA sentence callback function
 typedef void (* tFNNewNMEA)( LPCSTR pNMEA );
 
@@ -1825,6 +1834,31 @@ ULONG GetSMS(
    ULONG *                    pMessageSize, 
    BYTE *                     pMessage );
 
+/*===========================================================================
+METHOD:
+   GetSMSBatch
+
+DESCRIPTION:
+   This function reads several SMS messages from device memory, passing 
+   each message to the callback as it arrives (the message contents are 
+   only valid for the duration of the callback, and only when the status
+   is 0).  The function returns once every message has been read
+
+PARAMETERS:
+   storageType       [ I ] - SMS message storage type
+   messageListSize   [ I ] - Number of elements in the message index array
+   pMessageIndices   [ I ] - The message index array
+   pCallback         [ I ] - Callback receiving the messages
+  
+RETURN VALUE:
+   ULONG - Return code
+===========================================================================*/
+ULONG GetSMSBatch( 
+   ULONG                      storageType, 
+   ULONG                      messageListSize,
+   ULONG *                    pMessageIndices,
+   tFNSMSRead                 pCallback );
+
 /*===========================================================================
 METHOD:
    ModifySMSStatus
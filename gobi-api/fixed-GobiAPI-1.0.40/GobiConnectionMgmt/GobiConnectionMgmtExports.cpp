@@ -70,6 +70,40 @@ struct sAdapterInfo
 //---------------------------------------------------------------------------
 #pragma pack( pop )
 
+/*=========================================================================*/
+// Class cSMSReadCallback
+//    Passes the messages read by GetSMSBatch() on to the API callback
+/*=========================================================================*/
+class cSMSReadCallback : public cGobiQMISMSCallback
+{
+   public:
+      // (Inline) Constructor
+      cSMSReadCallback( tFNSMSRead pCallback )
+         :  mpCallback( pCallback )
+      { };
+
+      // (Inline) An SMS message has been read
+      virtual void SMSRead(
+         ULONG                      messageIndex,
+         eGobiError                 ec,
+         ULONG                      messageTag,
+         ULONG                      messageFormat,
+         ULONG                      messageSize,
+         const BYTE *               pMessage )
+      {
+         mpCallback( messageIndex, 
+                     (ULONG)ec, 
+                     messageTag, 
+                     messageFormat, 
+                     messageSize, 
+                     pMessage );
+      };
+
+   protected:
+      /* API callback */
+      tFNSMSRead mpCallback;
+};
+
 /*=========================================================================*/
 // Exported Methods
 /*=========================================================================*/
@@ -2743,6 +2777,49 @@ ULONG GetSMS(
                                   pMessage );
 }
 
+/*===========================================================================
+METHOD:
+   GetSMSBatch
+
+DESCRIPTION:
+   This function reads several SMS messages from device memory, passing 
+   each message to the callback as it arrives (the message contents are 
+   only valid for the duration of the callback, and only when the status
+   is 0).  The function returns once every message has been read
+
+PARAMETERS:
+   storageType       [ I ] - SMS message storage type
+   messageListSize   [ I ] - Number of elements in the message index array
+   pMessageIndices   [ I ] - The message index array
+   pCallback         [ I ] - Callback receiving the messages
+  
+RETURN VALUE:
+   ULONG - Return code
+===========================================================================*/
+ULONG GetSMSBatch( 
+   ULONG                      storageType, 
+   ULONG                      messageListSize,
+   ULONG *                    pMessageIndices,
+   tFNSMSRead                 pCallback )
+{
+   cGobiConnectionMgmt * pAPI = gConnectionDLL.GetAPI();
+   if (pAPI == 0)
+   {
+      return (ULONG)eGOBI_ERR_INTERNAL;
+   }
+
+   if (messageListSize == 0 || pMessageIndices == 0 || pCallback == 0)
+   {
+      return (ULONG)eGOBI_ERR_INVALID_ARG;
+   }
+
+   std::vector <ULONG> indices( pMessageIndices, 
+                                pMessageIndices + messageListSize );
+
+   cSMSReadCallback cb( pCallback );
+   return (ULONG)pAPI->GetSMSBatch( storageType, indices, &cb );
+}
+
 /*===========================================================================
 METHOD:
    ModifySMSStatus
@@ -163,10 +163,10 @@ bool Run(void)
          }
       }
 
-      err = qdl.WriteQDLImageBlock( 0, imgSz, (BYTE *)pImgData );
+      err = qdl.WriteQDLImage( (const BYTE *)pImgData, imgSz, blockSz );
       if (err != eGOBI_ERR_NONE)
       {
-         syslog( LOG_INFO, "WriteQDLImageBlock() = %d", err );
+         syslog( LOG_INFO, "WriteQDLImage() = %d", err );
          bErr = true;
          break;
       }
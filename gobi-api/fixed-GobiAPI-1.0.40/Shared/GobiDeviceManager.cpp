@@ -0,0 +1,1068 @@
+/*===========================================================================
+FILE:
+   GobiDeviceManager.cpp
+
+DESCRIPTION:
+   Resources shared by many Gobi QMI core objects (one per device)
+
+PUBLIC CLASSES AND FUNCTIONS:
+   cGobiDeviceLane
+   cGobiDevicePool
+   cGobiDeviceManager
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+==========================================================================*/
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "StdAfx.h"
+#include "GobiDeviceManager.h"
+
+#include <poll.h>
+#include <stdint.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+
+//---------------------------------------------------------------------------
+// Definitions
+//---------------------------------------------------------------------------
+
+// Directory the Gobi device nodes are created in, and their name prefix
+const char DEVICE_NODE_DIR[] = "/dev";
+const char DEVICE_NODE_PREFIX[] = "qcqmi";
+
+/*=========================================================================*/
+// Free Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   DevicePoolThread (Free Method)
+
+DESCRIPTION:
+   Device pool thread, runs queued tasks (one at a time per device lane)
+   until told to exit and the lanes have been drained
+
+PARAMETERS:
+   pArg        [ I ] - The cGobiDevicePool object
+
+RETURN VALUE:
+   void * - thread exit value (always 0)
+===========================================================================*/
+void * DevicePoolThread( PVOID pArg )
+{
+   cGobiDevicePool * pPool = (cGobiDevicePool *)pArg;
+   if (pPool == 0)
+   {
+      ASSERT( 0 );
+      return 0;
+   }
+
+   pthread_mutex_lock( &pPool->mSyncSection );
+
+   while (true)
+   {
+      if (pPool->mReady.size() == 0)
+      {
+         if (pPool->mbExiting == true)
+         {
+            break;
+         }
+
+         pthread_cond_wait( &pPool->mReadyCond, &pPool->mSyncSection );
+         continue;
+      }
+
+      cGobiDeviceLane * pLane = pPool->mReady.front();
+      pPool->mReady.pop_front();
+
+      cExecutorTask * pTask = pLane->mPending.front();
+      pLane->mPending.pop_front();
+      pLane->mbReady = false;
+      pLane->mbRunning = true;
+
+      // Run the task without holding the lock
+      pthread_mutex_unlock( &pPool->mSyncSection );
+
+      pTask->Run();
+
+      delete pTask;
+      pTask = 0;
+
+      pthread_mutex_lock( &pPool->mSyncSection );
+
+      pLane->mbRunning = false;
+
+      if (pLane->mPending.size() > 0)
+      {
+         // Next task of this lane is now free to run (behind any other
+         // lane that became ready in the meantime)
+         pLane->mbReady = true;
+         pPool->mReady.push_back( pLane );
+         pthread_cond_signal( &pPool->mReadyCond );
+      }
+      else if (pLane->mbDetached == true)
+      {
+         // Drained, free the lane
+         pPool->mLanes.erase( pLane );
+         delete pLane;
+
+         pthread_cond_broadcast( &pPool->mFreedCond );
+      }
+   }
+
+   pthread_mutex_unlock( &pPool->mSyncSection );
+   return 0;
+}
+
+/*=========================================================================*/
+// cGobiDeviceLane Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   Execute (Public Method)
+
+DESCRIPTION:
+   Queue a task to be run (and deleted) by the device pool
+
+PARAMETERS:
+   pTask       [ I ] - Task (owned by the pool only upon success)
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cGobiDeviceLane::Execute( cExecutorTask * pTask )
+{
+   if (mpPool == 0)
+   {
+      return false;
+   }
+
+   return mpPool->Submit( this, pTask );
+}
+
+/*=========================================================================*/
+// cGobiDevicePool Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   cGobiDevicePool (Public Method)
+
+DESCRIPTION:
+   Constructor
+
+RETURN VALUE:
+   None
+===========================================================================*/
+cGobiDevicePool::cGobiDevicePool()
+   :  mLanes(),
+      mReady(),
+      mThreadCount( 0 ),
+      mbExiting( false )
+{
+   pthread_mutex_init( &mSyncSection, NULL );
+   pthread_cond_init( &mReadyCond, NULL );
+   pthread_cond_init( &mFreedCond, NULL );
+}
+
+/*===========================================================================
+METHOD:
+   ~cGobiDevicePool (Public Method)
+
+DESCRIPTION:
+   Destructor
+
+RETURN VALUE:
+   None
+===========================================================================*/
+cGobiDevicePool::~cGobiDevicePool()
+{
+   // This should have already been called, but ...
+   Exit();
+
+   // Free any lanes that were never removed
+   std::set <cGobiDeviceLane *>::iterator pIter = mLanes.begin();
+   while (pIter != mLanes.end())
+   {
+      delete *pIter;
+      pIter++;
+   }
+
+   mLanes.clear();
+
+   pthread_cond_destroy( &mFreedCond );
+   pthread_cond_destroy( &mReadyCond );
+   pthread_mutex_destroy( &mSyncSection );
+}
+
+/*===========================================================================
+METHOD:
+   Initialize (Public Method)
+
+DESCRIPTION:
+   Start the pool threads (if not already running)
+
+RETURN VALUE:
+   bool - true if at least one pool thread is running
+===========================================================================*/
+bool cGobiDevicePool::Initialize()
+{
+   pthread_mutex_lock( &mSyncSection );
+
+   while (mThreadCount < DEVICE_POOL_THREADS)
+   {
+      int nRC = mThreadConfig.CreateThread( eTHREAD_ROLE_WORKER,
+                                            &mThreadIDs[mThreadCount],
+                                            DevicePoolThread,
+                                            this );
+
+      if (nRC != 0)
+      {
+         TRACE( "Unable to start DevicePoolThread. Error %d: %s\n",
+                nRC,
+                strerror( nRC ) );
+         break;
+      }
+
+      mThreadCount++;
+   }
+
+   bool bRC = (mThreadCount > 0);
+
+   pthread_mutex_unlock( &mSyncSection );
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   Exit (Public Method)
+
+DESCRIPTION:
+   Run the queued tasks and then exit the pool threads
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cGobiDevicePool::Exit()
+{
+   pthread_mutex_lock( &mSyncSection );
+
+   if (IsPoolThread() == true)
+   {
+      // Can't wait on ourselves
+      pthread_mutex_unlock( &mSyncSection );
+      return false;
+   }
+
+   mbExiting = true;
+   pthread_cond_broadcast( &mReadyCond );
+
+   ULONG threadCount = mThreadCount;
+
+   pthread_mutex_unlock( &mSyncSection );
+
+   for (ULONG t = 0; t < threadCount; t++)
+   {
+      pthread_join( mThreadIDs[t], NULL );
+   }
+
+   // Allow the pool to be restarted
+   pthread_mutex_lock( &mSyncSection );
+   mThreadCount = 0;
+   mbExiting = false;
+   pthread_mutex_unlock( &mSyncSection );
+
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   AddLane (Public Method)
+
+DESCRIPTION:
+   Add a device lane
+
+RETURN VALUE:
+   cGobiDeviceLane * - The new lane (0 upon failure)
+===========================================================================*/
+cGobiDeviceLane * cGobiDevicePool::AddLane()
+{
+   cGobiDeviceLane * pLane = new cGobiDeviceLane( this );
+   if (pLane == 0)
+   {
+      return 0;
+   }
+
+   pthread_mutex_lock( &mSyncSection );
+   mLanes.insert( pLane );
+   pthread_mutex_unlock( &mSyncSection );
+
+   return pLane;
+}
+
+/*===========================================================================
+METHOD:
+   RemoveLane (Public Method)
+
+DESCRIPTION:
+   Run the queued tasks of a device lane and then free it, when called
+   from a pool thread the lane is freed later (once drained) instead
+
+PARAMETERS:
+   pLane       [ I ] - Lane to remove
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiDevicePool::RemoveLane( cGobiDeviceLane * pLane )
+{
+   pthread_mutex_lock( &mSyncSection );
+
+   if (mLanes.find( pLane ) == mLanes.end() || pLane->mbDetached == true)
+   {
+      pthread_mutex_unlock( &mSyncSection );
+      return;
+   }
+
+   pLane->mbDetached = true;
+
+   // Nothing queued or running? Free it now
+   if ( (pLane->mbReady == false)
+   &&   (pLane->mbRunning == false) )
+   {
+      mLanes.erase( pLane );
+      delete pLane;
+
+      pthread_mutex_unlock( &mSyncSection );
+      return;
+   }
+
+   // Pool threads (or no threads at all) can't wait on the drain
+   if (IsPoolThread() == false && mThreadCount > 0)
+   {
+      while (mLanes.find( pLane ) != mLanes.end())
+      {
+         pthread_cond_wait( &mFreedCond, &mSyncSection );
+      }
+   }
+
+   pthread_mutex_unlock( &mSyncSection );
+}
+
+/*===========================================================================
+METHOD:
+   Submit (Internal Method)
+
+DESCRIPTION:
+   Queue a task on the given lane, tasks are still accepted while a lane
+   or the pool is draining
+
+PARAMETERS:
+   pLane       [ I ] - Lane to run the task on
+   pTask       [ I ] - Task (owned by the pool only upon success)
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cGobiDevicePool::Submit(
+   cGobiDeviceLane *          pLane,
+   cExecutorTask *            pTask )
+{
+   // Assume failure
+   bool bRC = false;
+   if (pLane == 0 || pTask == 0)
+   {
+      return bRC;
+   }
+
+   pthread_mutex_lock( &mSyncSection );
+
+   if ( (mThreadCount > 0)
+   &&   (mbExiting == false || IsPoolThread() == true) )
+   {
+      pLane->mPending.push_back( pTask );
+
+      // Make the lane ready (unless a task of it is queued or running)
+      if (pLane->mbReady == false && pLane->mbRunning == false)
+      {
+         pLane->mbReady = true;
+         mReady.push_back( pLane );
+         pthread_cond_signal( &mReadyCond );
+      }
+
+      bRC = true;
+   }
+
+   pthread_mutex_unlock( &mSyncSection );
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   IsPoolThread (Internal Method)
+
+DESCRIPTION:
+   Is the calling thread a pool thread?
+
+SEQUENCING:
+   mSyncSection must be held
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cGobiDevicePool::IsPoolThread()
+{
+   pthread_t self = pthread_self();
+   for (ULONG t = 0; t < mThreadCount; t++)
+   {
+      if (pthread_equal( mThreadIDs[t], self ) != 0)
+      {
+         return true;
+      }
+   }
+
+   return false;
+}
+
+/*===========================================================================
+METHOD:
+   DeviceMonitorThread (Free Method)
+
+DESCRIPTION:
+   Device monitor thread, updates the available devices whenever a Gobi
+   device node is created, removed or has its attributes changed (udev 
+   sets the permissions after creating the node) until told to exit
+
+PARAMETERS:
+   pArg        [ I ] - The cGobiDeviceManager object
+
+RETURN VALUE:
+   void * - thread exit value (always 0)
+===========================================================================*/
+void * DeviceMonitorThread( PVOID pArg )
+{
+   cGobiDeviceManager * pManager = (cGobiDeviceManager *)pArg;
+   if (pManager == 0)
+   {
+      ASSERT( 0 );
+      return 0;
+   }
+
+   pollfd fds[2];
+   memset( &fds[0], 0, sizeof( fds ) );
+   fds[0].fd = pManager->mWakeFD;
+   fds[0].events = POLLIN;
+   fds[1].fd = pManager->mInotifyFD;
+   fds[1].events = POLLIN;
+
+   const ULONG prefixLen = (ULONG)strlen( DEVICE_NODE_PREFIX );
+
+   // Room for a batch of events (each with a name)
+   char buf[4096] __attribute__ ((aligned (__alignof__ (inotify_event))));
+
+   while (true)
+   {
+      int nRet = poll( &fds[0], 2, -1 );
+      if (nRet < 0)
+      {
+         if (errno == EINTR)
+         {
+            continue;
+         }
+
+         TRACE( "DeviceMonitorThread wait error %d\n", errno );
+         break;
+      }
+
+      // Exit?
+      if (fds[0].revents != 0)
+      {
+         break;
+      }
+
+      if ((fds[1].revents & POLLIN) == 0)
+      {
+         continue;
+      }
+
+      ssize_t len = read( pManager->mInotifyFD, buf, sizeof( buf ) );
+      if (len <= 0)
+      {
+         continue;
+      }
+
+      // Any of our device nodes? (on overflow we can't tell)
+      bool bUpdate = false;
+      const char * pEvt = buf;
+      while (pEvt < buf + len)
+      {
+         const inotify_event * pIN = (const inotify_event *)pEvt;
+         if ( ((pIN->mask & IN_Q_OVERFLOW) != 0)
+         ||   ( (pIN->len > 0)
+         &&     (strncmp( pIN->name, DEVICE_NODE_PREFIX, prefixLen ) == 0) ) )
+         {
+            bUpdate = true;
+         }
+
+         pEvt += sizeof( inotify_event ) + pIN->len;
+      }
+
+      if (bUpdate == true)
+      {
+         pManager->UpdateDevices();
+      }
+   }
+
+   return 0;
+}
+
+/*=========================================================================*/
+// cGobiDeviceManager Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   cGobiDeviceManager (Public Method)
+
+DESCRIPTION:
+   Constructor
+
+RETURN VALUE:
+   None
+===========================================================================*/
+cGobiDeviceManager::cGobiDeviceManager()
+   :  mDB(),
+      mReactor(),
+      mPool(),
+      mDevices(),
+      mCores(),
+      mbInitialized( false ),
+      mCallbacks(),
+      mInotifyFD( -1 ),
+      mWakeFD( -1 ),
+      mMonitorThreadID( 0 )
+{
+   pthread_mutex_init( &mSyncSection, NULL );
+   pthread_mutex_init( &mUpdateSection, NULL );
+}
+
+/*===========================================================================
+METHOD:
+   ~cGobiDeviceManager (Public Method)
+
+DESCRIPTION:
+   Destructor
+
+RETURN VALUE:
+   None
+===========================================================================*/
+cGobiDeviceManager::~cGobiDeviceManager()
+{
+   // This should have already been called, but ...
+   Exit();
+
+   pthread_mutex_destroy( &mUpdateSection );
+   pthread_mutex_destroy( &mSyncSection );
+}
+
+/*===========================================================================
+METHOD:
+   Initialize (Public Method)
+
+DESCRIPTION:
+   Load the database, start the reactor/pool and enumerate the available
+   devices
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cGobiDeviceManager::Initialize()
+{
+   pthread_mutex_lock( &mSyncSection );
+
+   if (mbInitialized == true)
+   {
+      pthread_mutex_unlock( &mSyncSection );
+      return true;
+   }
+
+   // Assume failure
+   bool bRC = false;
+   if (mDB.Initialize() == false)
+   {
+      TRACE( "cGobiDeviceManager::Initialize(), database load failed\n" );
+   }
+   else if (mReactor.Initialize() == false)
+   {
+      mDB.Exit();
+   }
+   else if (mPool.Initialize() == false)
+   {
+      mReactor.Exit();
+      mDB.Exit();
+   }
+   else
+   {
+      mDevices = cGobiQMICore::EnumerateDevices();
+      mbInitialized = true;
+      bRC = true;
+   }
+
+   pthread_mutex_unlock( &mSyncSection );
+
+   // Without the monitor the devices are only enumerated again upon
+   // RefreshDevices()
+   if (bRC == true && StartMonitor() == false)
+   {
+      TRACE( "cGobiDeviceManager::Initialize(), not watching %s\n",
+             DEVICE_NODE_DIR );
+   }
+
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   SetThreadConfig (Public Method)
+
+DESCRIPTION:
+   Set the thread configuration of the reactor, pool and monitor threads,
+   which fails once the shared resources have been initialized
+
+PARAMETERS:
+   config      [ I ] - Thread configuration
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cGobiDeviceManager::SetThreadConfig( const cThreadConfig & config )
+{
+   pthread_mutex_lock( &mSyncSection );
+
+   bool bRC = (mbInitialized == false);
+   if (bRC == true)
+   {
+      mThreadConfig = config;
+      mReactor.SetThreadConfig( config );
+      mPool.SetThreadConfig( config );
+   }
+
+   pthread_mutex_unlock( &mSyncSection );
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   Exit (Public Method)
+
+DESCRIPTION:
+   Release the shared resources, this fails while any core object is
+   still attached
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cGobiDeviceManager::Exit()
+{
+   pthread_mutex_lock( &mSyncSection );
+
+   if (mbInitialized == false)
+   {
+      pthread_mutex_unlock( &mSyncSection );
+      return true;
+   }
+
+   if (mCores.size() > 0)
+   {
+      TRACE( "cGobiDeviceManager::Exit(), %u objects attached\n",
+             (UINT)mCores.size() );
+
+      pthread_mutex_unlock( &mSyncSection );
+      return false;
+   }
+
+   mbInitialized = false;
+   mDevices.clear();
+
+   pthread_mutex_unlock( &mSyncSection );
+
+   StopMonitor();
+
+   mPool.Exit();
+   mReactor.Exit();
+   mDB.Exit();
+
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   RefreshDevices (Public Method)
+
+DESCRIPTION:
+   Enumerate the available Gobi devices again (e.g. after a hotplug when
+   /dev could not be watched)
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cGobiDeviceManager::RefreshDevices()
+{
+   return UpdateDevices();
+}
+
+/*===========================================================================
+METHOD:
+   UpdateDevices (Internal Method)
+
+DESCRIPTION:
+   Enumerate the available Gobi devices, only the key of devices not seen
+   before (or whose key could not be read then) is read from the device,
+   and run the hot-plug callbacks for every device added or removed
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cGobiDeviceManager::UpdateDevices()
+{
+   pthread_mutex_lock( &mUpdateSection );
+
+   pthread_mutex_lock( &mSyncSection );
+   std::vector <cGobiQMICore::tDeviceID> oldDevices = mDevices;
+   bool bRC = mbInitialized;
+   pthread_mutex_unlock( &mSyncSection );
+
+   if (bRC == false)
+   {
+      pthread_mutex_unlock( &mUpdateSection );
+      return bRC;
+   }
+
+   std::map <std::string, std::string> keys;
+   for (ULONG d = 0; d < (ULONG)oldDevices.size(); d++)
+   {
+      if (oldDevices[d].second.size() > 0)
+      {
+         keys[oldDevices[d].first] = oldDevices[d].second;
+      }
+   }
+
+   // Enumerate without holding the lock
+   std::vector <std::string> nodes = cGobiQMICore::EnumerateDeviceNodes();
+   std::vector <cGobiQMICore::tDeviceID> devices( nodes.size() );
+   for (ULONG n = 0; n < (ULONG)nodes.size(); n++)
+   {
+      devices[n].first = nodes[n];
+
+      std::map <std::string, std::string>::const_iterator pKey;
+      pKey = keys.find( nodes[n] );
+      if (pKey != keys.end())
+      {
+         devices[n].second = pKey->second;
+      }
+      else
+      {
+         std::string deviceStr = std::string( DEVICE_NODE_DIR ) + "/" + nodes[n];
+         devices[n].second = cQMIProtocolServer::GetDeviceMEID( deviceStr );
+      }
+   }
+
+   pthread_mutex_lock( &mSyncSection );
+
+   bRC = mbInitialized;
+   if (bRC == true)
+   {
+      mDevices = devices;
+   }
+
+   pthread_mutex_unlock( &mSyncSection );
+
+   // Tell about the changes (a device whose key changed is added again)
+   if (bRC == true && mCallbacks.size() > 0)
+   {
+      std::set <cGobiQMICore::tDeviceID> before( oldDevices.begin(), 
+                                                 oldDevices.end() );
+      std::set <cGobiQMICore::tDeviceID> after( devices.begin(), 
+                                                devices.end() );
+
+      std::set <cGobiDeviceCallback *>::const_iterator pCB;
+      std::set <cGobiQMICore::tDeviceID>::const_iterator pDev;
+      for (pDev = before.begin(); pDev != before.end(); pDev++)
+      {
+         if (after.find( *pDev ) == after.end())
+         {
+            for (pCB = mCallbacks.begin(); pCB != mCallbacks.end(); pCB++)
+            {
+               (*pCB)->DeviceRemoved( *pDev );
+            }
+         }
+      }
+
+      for (pDev = after.begin(); pDev != after.end(); pDev++)
+      {
+         if (before.find( *pDev ) == before.end())
+         {
+            for (pCB = mCallbacks.begin(); pCB != mCallbacks.end(); pCB++)
+            {
+               (*pCB)->DeviceAdded( *pDev );
+            }
+         }
+      }
+   }
+
+   pthread_mutex_unlock( &mUpdateSection );
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   AddDeviceCallback (Public Method)
+
+DESCRIPTION:
+   Add a hot-plug callback, which is run on the monitor thread (or the 
+   thread calling RefreshDevices()) for every device added or removed
+
+PARAMETERS:
+   pCallback   [ I ] - Callback (must remain valid until removed)
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cGobiDeviceManager::AddDeviceCallback( cGobiDeviceCallback * pCallback )
+{
+   if (pCallback == 0)
+   {
+      return false;
+   }
+
+   pthread_mutex_lock( &mUpdateSection );
+   mCallbacks.insert( pCallback );
+   pthread_mutex_unlock( &mUpdateSection );
+
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   RemoveDeviceCallback (Public Method)
+
+DESCRIPTION:
+   Remove a hot-plug callback, waiting for any update running it
+
+PARAMETERS:
+   pCallback   [ I ] - Callback
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiDeviceManager::RemoveDeviceCallback( cGobiDeviceCallback * pCallback )
+{
+   pthread_mutex_lock( &mUpdateSection );
+   mCallbacks.erase( pCallback );
+   pthread_mutex_unlock( &mUpdateSection );
+}
+
+/*===========================================================================
+METHOD:
+   StartMonitor (Internal Method)
+
+DESCRIPTION:
+   Start watching /dev for Gobi device nodes
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cGobiDeviceManager::StartMonitor()
+{
+   if (mMonitorThreadID != 0)
+   {
+      // Already running
+      return true;
+   }
+
+   mInotifyFD = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+   if (mInotifyFD == -1)
+   {
+      return false;
+   }
+
+   if (inotify_add_watch( mInotifyFD, 
+                          DEVICE_NODE_DIR, 
+                          IN_CREATE | IN_DELETE | IN_ATTRIB ) == -1)
+   {
+      close( mInotifyFD );
+      mInotifyFD = -1;
+      return false;
+   }
+
+   mWakeFD = eventfd( 0, EFD_NONBLOCK );
+   if (mWakeFD == -1)
+   {
+      close( mInotifyFD );
+      mInotifyFD = -1;
+      return false;
+   }
+
+   int nRet = mThreadConfig.CreateThread( eTHREAD_ROLE_WORKER,
+                                          &mMonitorThreadID, 
+                                          DeviceMonitorThread, 
+                                          this );
+   if (nRet != 0)
+   {
+      mMonitorThreadID = 0;
+      close( mWakeFD );
+      close( mInotifyFD );
+      mWakeFD = -1;
+      mInotifyFD = -1;
+      return false;
+   }
+
+   // A device may have come up between the first enumeration and the
+   // watch being added
+   UpdateDevices();
+
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   StopMonitor (Internal Method)
+
+DESCRIPTION:
+   Stop watching /dev for Gobi device nodes
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiDeviceManager::StopMonitor()
+{
+   if (mMonitorThreadID == 0)
+   {
+      return;
+   }
+
+   uint64_t count = 1;
+   if (write( mWakeFD, &count, sizeof( count ) ) == sizeof( count ))
+   {
+      pthread_join( mMonitorThreadID, NULL );
+   }
+
+   mMonitorThreadID = 0;
+
+   close( mWakeFD );
+   close( mInotifyFD );
+   mWakeFD = -1;
+   mInotifyFD = -1;
+}
+
+/*===========================================================================
+METHOD:
+   GetAvailableDevices (Public Method)
+
+DESCRIPTION:
+   Return the set of available Gobi devices as of the last enumeration
+
+RETURN VALUE:
+   std::vector <tDeviceID> - Vector of device ID and device key pairs
+===========================================================================*/
+std::vector <cGobiQMICore::tDeviceID>
+cGobiDeviceManager::GetAvailableDevices()
+{
+   pthread_mutex_lock( &mSyncSection );
+
+   std::vector <cGobiQMICore::tDeviceID> devices = mDevices;
+
+   pthread_mutex_unlock( &mSyncSection );
+   return devices;
+}
+
+/*===========================================================================
+METHOD:
+   Attach (Public Method)
+
+DESCRIPTION:
+   Attach a core object (called by cGobiQMICore::Initialize())
+
+PARAMETERS:
+   pCore       [ I ] - Object to attach
+
+RETURN VALUE:
+   cExecutor * - Executor for the tasks of the object (0 upon failure)
+===========================================================================*/
+cExecutor * cGobiDeviceManager::Attach( cGobiQMICore * pCore )
+{
+   if (pCore == 0)
+   {
+      return 0;
+   }
+
+   pthread_mutex_lock( &mSyncSection );
+
+   cExecutor * pLane = 0;
+   if (mbInitialized == true)
+   {
+      pLane = mPool.AddLane();
+      if (pLane != 0)
+      {
+         mCores.insert( pCore );
+      }
+   }
+
+   pthread_mutex_unlock( &mSyncSection );
+   return pLane;
+}
+
+/*===========================================================================
+METHOD:
+   Detach (Public Method)
+
+DESCRIPTION:
+   Detach a core object (called by cGobiQMICore::Cleanup()), tasks still
+   queued for the object are run first
+
+PARAMETERS:
+   pCore       [ I ] - Object to detach
+   pLane       [ I ] - Executor returned by Attach()
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiDeviceManager::Detach(
+   cGobiQMICore *             pCore,
+   cExecutor *                pLane )
+{
+   // Drain without holding the lock (the tasks may call back into us)
+   mPool.RemoveLane( (cGobiDeviceLane *)pLane );
+
+   pthread_mutex_lock( &mSyncSection );
+   mCores.erase( pCore );
+   pthread_mutex_unlock( &mSyncSection );
+}
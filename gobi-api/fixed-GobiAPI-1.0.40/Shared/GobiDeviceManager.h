@@ -0,0 +1,331 @@
+/*===========================================================================
+FILE:
+   GobiDeviceManager.h
+
+DESCRIPTION:
+   Resources shared by many Gobi QMI core objects (one per device)
+
+PUBLIC CLASSES AND METHODS:
+   cGobiDeviceLane
+   cGobiDevicePool
+   cGobiDeviceManager
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+==========================================================================*/
+
+/*=========================================================================*/
+// Pragmas
+/*=========================================================================*/
+#pragma once
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "GobiQMICore.h"
+#include "CommReactor.h"
+
+#include <deque>
+#include <set>
+
+//---------------------------------------------------------------------------
+// Definitions
+//---------------------------------------------------------------------------
+
+// Number of threads in the device worker pool
+const ULONG DEVICE_POOL_THREADS = 4;
+
+//---------------------------------------------------------------------------
+// Forward Declarations
+//---------------------------------------------------------------------------
+class cGobiDevicePool;
+
+/*=========================================================================*/
+// Class cGobiDeviceLane
+//
+//    Executor for a single device, tasks are run by the device pool one
+//    at a time in the order they were submitted
+/*=========================================================================*/
+class cGobiDeviceLane : public cExecutor
+{
+   public:
+      // (Inline) Constructor
+      cGobiDeviceLane( cGobiDevicePool * pPool )
+         :  mpPool( pPool ),
+            mbReady( false ),
+            mbRunning( false ),
+            mbDetached( false )
+      { };
+
+      // (Inline) Destructor
+      virtual ~cGobiDeviceLane() { };
+
+      // Queue a task to be run
+      virtual bool Execute( cExecutorTask * pTask );
+
+   protected:
+      /* Pool the tasks are run on */
+      cGobiDevicePool * mpPool;
+
+      /* Tasks not yet run, oldest first */
+      std::deque <cExecutorTask *> mPending;
+
+      /* Is this lane in the ready list of the pool? */
+      bool mbReady;
+
+      /* Is a task of this lane running? */
+      bool mbRunning;
+
+      /* Has this lane been removed (freed once drained)? */
+      bool mbDetached;
+
+      // Pool gets full access
+      friend class cGobiDevicePool;
+      friend void * DevicePoolThread( PVOID pArg );
+};
+
+/*=========================================================================*/
+// Class cGobiDevicePool
+//
+//    Fixed size pool of threads running the tasks of any number of device
+//    lanes, ready lanes are serviced round robin so that a busy device
+//    cannot starve the others
+/*=========================================================================*/
+class cGobiDevicePool
+{
+   public:
+      // Constructor
+      cGobiDevicePool();
+
+      // Destructor
+      virtual ~cGobiDevicePool();
+
+      // Start the pool threads
+      bool Initialize();
+
+      // (Inline) Set the thread configuration the pool threads are started
+      // with (as eTHREAD_ROLE_WORKER threads)
+      void SetThreadConfig( const cThreadConfig & config )
+      {
+         mThreadConfig = config;
+      };
+
+      // Run the queued tasks and then exit the pool threads
+      bool Exit();
+
+      // Add a device lane
+      cGobiDeviceLane * AddLane();
+
+      // Run the queued tasks of a device lane and then free it
+      void RemoveLane( cGobiDeviceLane * pLane );
+
+   protected:
+      // Queue a task on the given lane
+      bool Submit(
+         cGobiDeviceLane *          pLane,
+         cExecutorTask *            pTask );
+
+      // Is the calling thread a pool thread? (mutex must be held)
+      bool IsPoolThread();
+
+      /* Device lanes */
+      std::set <cGobiDeviceLane *> mLanes;
+
+      /* Lanes with a task ready to run, in order of readiness */
+      std::deque <cGobiDeviceLane *> mReady;
+
+      /* Pool threads */
+      pthread_t mThreadIDs[DEVICE_POOL_THREADS];
+
+      /* Number of running pool threads */
+      ULONG mThreadCount;
+
+      /* Thread configuration of the pool threads */
+      cThreadConfig mThreadConfig;
+
+      /* Are the pool threads exiting? */
+      bool mbExiting;
+
+      /* Synchronization object (guards all of the above and the lanes) */
+      pthread_mutex_t mSyncSection;
+
+      /* Signalled when a lane becomes ready (or upon exit) */
+      pthread_cond_t mReadyCond;
+
+      /* Signalled when a detached lane has been freed */
+      pthread_cond_t mFreedCond;
+
+      // Lanes and pool threads get full access
+      friend class cGobiDeviceLane;
+      friend void * DevicePoolThread( PVOID pArg );
+
+   private:
+      // Unsupported
+      cGobiDevicePool( const cGobiDevicePool & );
+      cGobiDevicePool & operator = ( const cGobiDevicePool & );
+};
+
+/*=========================================================================*/
+// Class cGobiDeviceCallback
+//
+//    This abstract base class is told about Gobi devices arriving and 
+//    leaving (see cGobiDeviceManager::AddDeviceCallback())
+/*=========================================================================*/
+class cGobiDeviceCallback
+{
+   public:
+      // (Inline) Constructor
+      cGobiDeviceCallback() { };
+
+      // (Inline) Destructor
+      virtual ~cGobiDeviceCallback() { };
+
+      // A device has been added (or its key has changed)
+      virtual void DeviceAdded( const cGobiQMICore::tDeviceID & device ) = 0;
+
+      // A device has been removed
+      virtual void DeviceRemoved( const cGobiQMICore::tDeviceID & device ) = 0;
+};
+
+/*=========================================================================*/
+// Class cGobiDeviceManager
+//
+//    Owns the database, communications reactor and worker pool shared by
+//    every attached core object (see cGobiQMICore::SetDeviceManager()),
+//    the set of available devices is enumerated once and then kept up to
+//    date by watching device nodes come and go in /dev
+/*=========================================================================*/
+class cGobiDeviceManager
+{
+   public:
+      // Constructor
+      cGobiDeviceManager();
+
+      // Destructor
+      virtual ~cGobiDeviceManager();
+
+      // Load the database, start the reactor/pool and enumerate devices
+      virtual bool Initialize();
+
+      // Release shared resources (attached objects must be cleaned up)
+      virtual bool Exit();
+
+      // Set the thread configuration of the reactor, pool and monitor 
+      // threads (must be called before Initialize())
+      bool SetThreadConfig( const cThreadConfig & config );
+
+      // Enumerate the available Gobi devices again
+      bool RefreshDevices();
+
+      // Add a hot-plug callback, run on the monitor thread as devices are
+      // added/removed
+      bool AddDeviceCallback( cGobiDeviceCallback * pCallback );
+
+      // Remove a hot-plug callback, which is not run once this returns
+      // (this must not be called from a callback)
+      void RemoveDeviceCallback( cGobiDeviceCallback * pCallback );
+
+      // Return the (cached) set of available Gobi devices
+      std::vector <cGobiQMICore::tDeviceID> GetAvailableDevices();
+
+      // (Inline) Return the shared QMI database
+      const cCoreDatabase & GetDatabase()
+      {
+         return mDB;
+      };
+
+      // (Inline) Return the shared communications reactor
+      cCommReactor * GetCommReactor()
+      {
+         return &mReactor;
+      };
+
+      // Attach a core object, returning the executor for its device
+      cExecutor * Attach( cGobiQMICore * pCore );
+
+      // Detach a core object, running any of its queued tasks
+      void Detach(
+         cGobiQMICore *             pCore,
+         cExecutor *                pLane );
+
+   protected:
+      // Enumerate the available devices, reading the key of new devices
+      // only, and notify the callbacks of any change
+      bool UpdateDevices();
+
+      // Start/stop watching /dev for device nodes
+      bool StartMonitor();
+      void StopMonitor();
+
+      /* Database shared by all attached objects */
+      cCoreDatabase mDB;
+
+      /* Reactor servicing the ports of all attached objects */
+      cCommReactor mReactor;
+
+      /* Worker pool running tasks of all attached objects */
+      cGobiDevicePool mPool;
+
+      /* Available devices as of the last enumeration */
+      std::vector <cGobiQMICore::tDeviceID> mDevices;
+
+      /* Attached objects */
+      std::set <cGobiQMICore *> mCores;
+
+      /* Have the shared resources been initialized? */
+      bool mbInitialized;
+
+      /* Synchronization object (guards all of the above) */
+      pthread_mutex_t mSyncSection;
+
+      /* Hot-plug callbacks */
+      std::set <cGobiDeviceCallback *> mCallbacks;
+
+      /* Synchronization object serializing device updates and the 
+         callbacks they run (guards mCallbacks) */
+      pthread_mutex_t mUpdateSection;
+
+      /* inotify instance watching /dev (-1 if not watching) */
+      int mInotifyFD;
+
+      /* eventfd used to wake the monitor thread for exit */
+      int mWakeFD;
+
+      /* ID of the monitor thread (0 if not running) */
+      pthread_t mMonitorThreadID;
+
+      /* Thread configuration of the monitor thread */
+      cThreadConfig mThreadConfig;
+
+      // Monitor thread gets full access
+      friend void * DeviceMonitorThread( PVOID pArg );
+
+   private:
+      // Unsupported
+      cGobiDeviceManager( const cGobiDeviceManager & );
+      cGobiDeviceManager & operator = ( const cGobiDeviceManager & );
+};
@@ -0,0 +1,1510 @@
+/*===========================================================================
+FILE:
+   GobiMBNIndex.cpp
+
+DESCRIPTION:
+   Persistent index of the MBN images in an image store
+
+PUBLIC CLASSES AND FUNCTIONS:
+   cGobiMBNIndex
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+==========================================================================*/
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "StdAfx.h"
+#include "GobiMBNIndex.h"
+
+#include "CoreUtilities.h"
+#include "MemoryMappedFile.h"
+
+#include <glob.h>
+#include <set>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//---------------------------------------------------------------------------
+// Definitions
+//---------------------------------------------------------------------------
+
+// Folder (at the root of an image store) holding the index file, which 
+// keeps the store folder itself from changing whenever the index does
+LPCSTR MBN_INDEX_FOLDER_NAME = ".gobi-mbn-index";
+
+// Name of the index file
+LPCSTR MBN_INDEX_FILE_NAME = "index";
+
+// First line of an index file (identifies the format)
+LPCSTR MBN_INDEX_HEADER = "GOBI-MBN-INDEX 2";
+
+// Modification times this recent (in seconds) are not trusted since a 
+// change made within the same clock tick would go unnoticed
+const ULONG MBN_INDEX_RACY_TIME = 2;
+
+// Maximum number of threads parsing image files at once
+const ULONG MBN_INDEX_PARSE_THREADS = 8;
+
+/*=========================================================================*/
+// Struct sMBNParseWork
+//    Image files to be parsed, shared by the parsing threads
+/*=========================================================================*/
+struct sMBNParseWork
+{
+   public:
+      /* Files to parse (path, time and size set) */
+      std::vector <sMBNIndexFile> * mpFiles;
+
+      /* Index of the next file to be parsed */
+      ULONG mNext;
+};
+
+/*=========================================================================*/
+// Free Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   NormalizeMBNFolder (Free Method)
+
+DESCRIPTION:
+   Return the given folder without any trailing '/'
+
+PARAMETERS:
+   folder      [ I ] - Folder
+
+RETURN VALUE:
+   std::string
+===========================================================================*/
+std::string NormalizeMBNFolder( const std::string & folder )
+{
+   std::string retStr = folder;
+   while (retStr.size() > 1 && retStr[retStr.size() - 1] == '/')
+   {
+      retStr.erase( retStr.size() - 1 );
+   }
+
+   return retStr;
+}
+
+/*===========================================================================
+METHOD:
+   GetMBNFileTime (Free Method)
+
+DESCRIPTION:
+   Get the modification time and size of a file or folder, times that are
+   too recent to be trusted are returned as 0
+
+PARAMETERS:
+   path        [ I ] - Fully qualified path
+   bFolder     [ I ] - Is the path expected to be a folder?
+   modTime     [ O ] - Modification time (in nanoseconds)
+   size        [ O ] - Size
+  
+RETURN VALUE:
+   bool - Does the file (or folder) exist?
+===========================================================================*/
+bool GetMBNFileTime( 
+   const std::string &        path,
+   bool                       bFolder,
+   ULONGLONG &                modTime,
+   ULONGLONG &                size )
+{
+   modTime = 0;
+   size = 0;
+
+   struct stat st;
+   if (stat( path.c_str(), &st ) != 0)
+   {
+      return false;
+   }
+
+   if (bFolder != (S_ISDIR( st.st_mode ) != 0))
+   {
+      return false;
+   }
+
+   size = (ULONGLONG)st.st_size;
+   if ((ULONGLONG)st.st_mtime + MBN_INDEX_RACY_TIME <= (ULONGLONG)time( 0 ))
+   {
+      modTime = (ULONGLONG)st.st_mtime * 1000000000ULL 
+              + (ULONGLONG)st.st_mtim.tv_nsec;
+   }
+
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   FoldMBNImageID (Free Method)
+
+DESCRIPTION:
+   Fold a unique image ID into a 64-bit index key
+
+PARAMETERS:
+   pImageID    [ I ] - Unique image ID
+  
+RETURN VALUE:
+   ULONGLONG
+===========================================================================*/
+ULONGLONG FoldMBNImageID( const BYTE * pImageID )
+{
+   ULONGLONG key = 0;
+   for (ULONG i = 0; i < MBN_UNIQUE_ID_LEN; i++)
+   {
+      key ^= (ULONGLONG)pImageID[i] << ((i % 8) * 8);
+   }
+
+   return key;
+}
+
+/*===========================================================================
+METHOD:
+   ParseMBNIndexFile (Free Method)
+
+DESCRIPTION:
+   Parse the metadata of an image file into its index record
+
+PARAMETERS:
+   file        [I/O] - Index record (path set)
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+void ParseMBNIndexFile( sMBNIndexFile & file )
+{
+   sImageMetadata meta;
+   eGobiError rc = ::GetImageMetadata( file.mPath.c_str(), meta );
+
+   file.mbValid = (rc == eGOBI_ERR_NONE);
+   if (file.mbValid == true)
+   {
+      file.mInfo = meta.mInfo;
+      file.mbBootValid = meta.mbBootValid;
+      file.mBootMajorVersion = meta.mBootMajorVersion;
+      file.mBootMinorVersion = meta.mBootMinorVersion;
+   }
+}
+
+/*===========================================================================
+METHOD:
+   MBNParseThread (Free Method)
+
+DESCRIPTION:
+   Thread that parses image files until none are left
+  
+PARAMETERS:
+   pData       [ I ] - The shared work (sMBNParseWork)
+
+RETURN VALUE:
+   void * - thread exit value (always 0)
+===========================================================================*/
+static void * MBNParseThread( PVOID pData )
+{
+   sMBNParseWork * pWork = (sMBNParseWork *)pData;
+   if (pWork == 0)
+   {
+      return 0;
+   }
+
+   std::vector <sMBNIndexFile> & files = *pWork->mpFiles;
+   ULONG fileCount = (ULONG)files.size();
+   while (true)
+   {
+      ULONG f = __sync_fetch_and_add( &pWork->mNext, 1 );
+      if (f >= fileCount)
+      {
+         break;
+      }
+
+      ParseMBNIndexFile( files[f] );
+   }
+
+   return 0;
+}
+
+/*===========================================================================
+METHOD:
+   ParseMBNIndexFiles (Free Method)
+
+DESCRIPTION:
+   Parse the given image files on a pool of threads (the files are 
+   independent of each other and parsing is mostly waiting on the file
+   system), the calling thread takes its share
+
+   NOTE: Fewer threads are used if they cannot be started
+  
+PARAMETERS:
+   files       [I/O] - Index records (paths set)
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void ParseMBNIndexFiles( std::vector <sMBNIndexFile> & files )
+{
+   ULONG fileCount = (ULONG)files.size();
+   if (fileCount == 0)
+   {
+      return;
+   }
+
+   sMBNParseWork work;
+   work.mpFiles = &files;
+   work.mNext = 0;
+
+   long cpus = sysconf( _SC_NPROCESSORS_ONLN );
+   ULONG threadCount = (cpus > 0 ? (ULONG)cpus : 1);
+   threadCount = std::min( threadCount, MBN_INDEX_PARSE_THREADS );
+   threadCount = std::min( threadCount, fileCount );
+
+   std::vector <pthread_t> threads;
+   for (ULONG t = 1; t < threadCount; t++)
+   {
+      pthread_t threadID;
+      if (pthread_create( &threadID, 0, MBNParseThread, (PVOID)&work ) != 0)
+      {
+         break;
+      }
+
+      threads.push_back( threadID );
+   }
+
+   MBNParseThread( (PVOID)&work );
+
+   for (ULONG t = 0; t < (ULONG)threads.size(); t++)
+   {
+      pthread_join( threads[t], 0 );
+   }
+}
+
+/*=========================================================================*/
+// cGobiMBNIndex Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   cGobiMBNIndex (Public Method)
+
+DESCRIPTION:
+   Constructor
+
+RETURN VALUE:
+   None
+===========================================================================*/
+cGobiMBNIndex::cGobiMBNIndex()
+   :  mGeneration( 0 )
+{
+   pthread_mutex_init( &mSyncSection, 0 );
+}
+
+/*===========================================================================
+METHOD:
+   ~cGobiMBNIndex (Public Method)
+
+DESCRIPTION:
+   Destructor
+
+RETURN VALUE:
+   None
+===========================================================================*/
+cGobiMBNIndex::~cGobiMBNIndex()
+{
+   pthread_mutex_destroy( &mSyncSection );
+}
+
+/*===========================================================================
+METHOD:
+   GetFolderImages (Public Method)
+
+DESCRIPTION:
+   Return the information for the valid images in the given folder (not 
+   including subfolders), a folder in the given image store is recorded
+   in the index file of the store
+
+PARAMETERS:
+   imageStore  [ I ] - Fully qualified path to image store
+   folder      [ I ] - Fully qualified path to folder
+
+RETURN VALUE:
+   std:vector <sImageInfo> - Vector of image information
+===========================================================================*/
+std::vector <sImageInfo> cGobiMBNIndex::GetFolderImages( 
+   const std::string &        imageStore,
+   const std::string &        folder )
+{
+   std::vector <sImageInfo> retVec;
+   if (folder.size() == 0)
+   {
+      return retVec;
+   }
+
+   std::string storeName = NormalizeMBNFolder( imageStore );
+   std::string folderName = NormalizeMBNFolder( folder );
+
+   pthread_mutex_lock( &mSyncSection );
+
+   // Load the index of the store holding the folder first
+   sStore * pStore = 0;
+   if ( (storeName.size() > 0)
+   &&   (folderName.size() > storeName.size())
+   &&   (folderName.compare( 0, storeName.size(), storeName ) == 0)
+   &&   (folderName[storeName.size()] == '/') )
+   {
+      pStore = &GetStore( storeName );
+   }
+
+   if (RefreshFolder( folderName ) == true && pStore != 0)
+   {
+      pStore->mbDirty = true;
+   }
+
+   std::map <std::string, sMBNIndexFolder>::const_iterator pFolder;
+   pFolder = mFolders.find( folderName );
+   if (pFolder != mFolders.end())
+   {
+      const std::vector <std::string> & files = pFolder->second.mFiles;
+      for (ULONG f = 0; f < (ULONG)files.size(); f++)
+      {
+         const sMBNIndexFile & file = mFiles[files[f]];
+         if (file.mbValid == true)
+         {
+            retVec.push_back( file.mInfo );
+         }
+      }
+   }
+
+   if (pStore != 0 && pStore->mbDirty == true)
+   {
+      SaveStore( storeName, *pStore );
+      pStore->mbDirty = false;
+   }
+
+   pthread_mutex_unlock( &mSyncSection );
+   return retVec;
+}
+
+/*===========================================================================
+METHOD:
+   FindImage (Public Method)
+
+DESCRIPTION:
+   Return the fully qualified path to the first image (in folder search 
+   order) with the given unique ID that lies in a subfolder of the given 
+   image store
+
+   An index hit is only checked against the file itself, the subfolders 
+   of the store are only refreshed upon a miss (or a stale hit)
+
+PARAMETERS:
+   imageStore  [ I ] - Fully qualified path to image store
+   pImageID    [ I ] - Unique image ID
+
+RETURN VALUE:
+   std::string - Fully qualified path to matching image
+===========================================================================*/
+std::string cGobiMBNIndex::FindImage( 
+   const std::string &        imageStore,
+   const BYTE *               pImageID )
+{
+   std::string retStr = "";
+   if (imageStore.size() == 0 || pImageID == 0)
+   {
+      return retStr;
+   }
+
+   std::string storeName = NormalizeMBNFolder( imageStore );
+
+   pthread_mutex_lock( &mSyncSection );
+
+   sStore & store = GetStore( storeName );
+
+   // Trust an index hit as long as the image itself is unchanged
+   const sMBNIndexFile * pFile = FindID( store, pImageID );
+   if (pFile != 0)
+   {
+      std::string path = pFile->mPath;
+      if (RefreshFile( path ) == false)
+      {
+         retStr = path;
+      }
+      else
+      {
+         store.mbDirty = true;
+      }
+   }
+
+   if (retStr.size() == 0)
+   {
+      RefreshStore( storeName, store );
+
+      pFile = FindID( store, pImageID );
+      if (pFile != 0)
+      {
+         retStr = pFile->mPath;
+      }
+   }
+
+   if (store.mbDirty == true)
+   {
+      SaveStore( storeName, store );
+      store.mbDirty = false;
+   }
+
+   pthread_mutex_unlock( &mSyncSection );
+   return retStr;
+}
+
+/*===========================================================================
+METHOD:
+   FindImages (Public Method)
+
+DESCRIPTION:
+   Return the fully qualified paths to the first images (in folder search
+   order) with the given unique IDs that lie in a subfolder of the given
+   image store
+
+   This is FindImage() for a set of images, the subfolders of the store
+   are refreshed at most once (upon the first miss or stale hit) and the
+   index file is written at most once
+
+PARAMETERS:
+   imageStore  [ I ] - Fully qualified path to image store
+   imageIDs    [ I ] - Unique image IDs
+
+RETURN VALUE:
+   std::vector <std::string> - Fully qualified path to each matching image
+                               (empty for an image that was not found)
+===========================================================================*/
+std::vector <std::string> cGobiMBNIndex::FindImages( 
+   const std::string &                 imageStore,
+   const std::vector <const BYTE *> &  imageIDs )
+{
+   ULONG idCount = (ULONG)imageIDs.size();
+   std::vector <std::string> retVec( idCount );
+   if (imageStore.size() == 0 || idCount == 0)
+   {
+      return retVec;
+   }
+
+   std::string storeName = NormalizeMBNFolder( imageStore );
+
+   pthread_mutex_lock( &mSyncSection );
+
+   sStore & store = GetStore( storeName );
+
+   // Trust index hits as long as the images themselves are unchanged
+   bool bMiss = false;
+   for (ULONG i = 0; i < idCount; i++)
+   {
+      if (imageIDs[i] == 0)
+      {
+         continue;
+      }
+
+      const sMBNIndexFile * pFile = FindID( store, imageIDs[i] );
+      if (pFile == 0)
+      {
+         bMiss = true;
+         continue;
+      }
+
+      std::string path = pFile->mPath;
+      if (RefreshFile( path ) == false)
+      {
+         retVec[i] = path;
+      }
+      else
+      {
+         store.mbDirty = true;
+         bMiss = true;
+      }
+   }
+
+   // A single refresh resolves every miss
+   if (bMiss == true)
+   {
+      RefreshStore( storeName, store );
+
+      for (ULONG i = 0; i < idCount; i++)
+      {
+         if (imageIDs[i] == 0 || retVec[i].size() > 0)
+         {
+            continue;
+         }
+
+         const sMBNIndexFile * pFile = FindID( store, imageIDs[i] );
+         if (pFile != 0)
+         {
+            retVec[i] = pFile->mPath;
+         }
+      }
+   }
+
+   if (store.mbDirty == true)
+   {
+      SaveStore( storeName, store );
+      store.mbDirty = false;
+   }
+
+   pthread_mutex_unlock( &mSyncSection );
+   return retVec;
+}
+
+/*===========================================================================
+METHOD:
+   GetStoreImages (Public Method)
+
+DESCRIPTION:
+   Return the metadata of the valid images that lie in a subfolder of the
+   given image store (in folder search order), bringing the whole store 
+   up to date first.  Only new or changed images are parsed, in parallel
+
+PARAMETERS:
+   imageStore  [ I ] - Fully qualified path to image store
+
+RETURN VALUE:
+   std::vector <sImageMetadata> - Metadata of each image
+===========================================================================*/
+std::vector <sImageMetadata> cGobiMBNIndex::GetStoreImages( 
+   const std::string &        imageStore )
+{
+   std::vector <sImageMetadata> retVec;
+   if (imageStore.size() == 0)
+   {
+      return retVec;
+   }
+
+   std::string storeName = NormalizeMBNFolder( imageStore );
+
+   pthread_mutex_lock( &mSyncSection );
+
+   sStore & store = GetStore( storeName );
+   RefreshStore( storeName, store );
+
+   for (ULONG d = 0; d < (ULONG)store.mFolders.size(); d++)
+   {
+      std::map <std::string, sMBNIndexFolder>::const_iterator pFolder;
+      pFolder = mFolders.find( store.mFolders[d] );
+      if (pFolder == mFolders.end())
+      {
+         continue;
+      }
+
+      const std::vector <std::string> & files = pFolder->second.mFiles;
+      for (ULONG f = 0; f < (ULONG)files.size(); f++)
+      {
+         std::map <std::string, sMBNIndexFile>::const_iterator pFile;
+         pFile = mFiles.find( files[f] );
+         if (pFile == mFiles.end() || pFile->second.mbValid == false)
+         {
+            continue;
+         }
+
+         const sMBNIndexFile & file = pFile->second;
+
+         sImageMetadata meta;
+         meta.mPath = file.mPath;
+         meta.mInfo = file.mInfo;
+         meta.mbBootValid = file.mbBootValid;
+         meta.mBootMajorVersion = file.mBootMajorVersion;
+         meta.mBootMinorVersion = file.mBootMinorVersion;
+         retVec.push_back( meta );
+      }
+   }
+
+   if (store.mbDirty == true)
+   {
+      SaveStore( storeName, store );
+      store.mbDirty = false;
+   }
+
+   pthread_mutex_unlock( &mSyncSection );
+   return retVec;
+}
+
+/*===========================================================================
+METHOD:
+   Clear (Public Method)
+
+DESCRIPTION:
+   Empty the (in memory) index, index files are loaded again upon next use
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiMBNIndex::Clear()
+{
+   pthread_mutex_lock( &mSyncSection );
+
+   mStores.clear();
+   mFolders.clear();
+   mFiles.clear();
+   mGeneration++;
+
+   pthread_mutex_unlock( &mSyncSection );
+}
+
+/*===========================================================================
+METHOD:
+   GetStore (Internal Method)
+
+DESCRIPTION:
+   Return the store with the given name, loading its index file upon 
+   first use
+
+PARAMETERS:
+   storeName   [ I ] - Fully qualified path to image store (normalized)
+
+SEQUENCING:
+   Calling thread must have mSyncSection locked
+
+RETURN VALUE:
+   sStore &
+===========================================================================*/
+cGobiMBNIndex::sStore & cGobiMBNIndex::GetStore( 
+   const std::string &        storeName )
+{
+   sStore & store = mStores[storeName];
+   if (store.mbLoaded == false)
+   {
+      store.mbLoaded = true;
+      LoadStore( storeName, store );
+   }
+
+   return store;
+}
+
+/*===========================================================================
+METHOD:
+   LoadStore (Internal Method)
+
+DESCRIPTION:
+   Load the index file of a store, what is loaded is only trusted until
+   the next refresh which compares it against the file system.  Records 
+   already in memory are kept since they are at least as recent
+
+PARAMETERS:
+   storeName   [ I ] - Fully qualified path to image store (normalized)
+   store       [I/O] - Store
+
+SEQUENCING:
+   Calling thread must have mSyncSection locked
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiMBNIndex::LoadStore( 
+   const std::string &        storeName,
+   sStore &                   store )
+{
+   std::string indexName = storeName + "/" + MBN_INDEX_FOLDER_NAME 
+                         + "/" + MBN_INDEX_FILE_NAME;
+
+   cMemoryMappedFile indexFile( indexName.c_str() );
+
+   LPCSTR pData = (LPCSTR)indexFile.GetContents();
+   ULONG dataSz = indexFile.GetSize();
+   if (pData == 0 || dataSz == 0)
+   {
+      return;
+   }
+
+   std::istringstream lines( std::string( pData, dataSz ) );
+   std::string line;
+
+   std::getline( lines, line );
+   if (line != MBN_INDEX_HEADER)
+   {
+      TRACE( "MBN index %s, unknown format\n", indexName.c_str() );
+      return;
+   }
+
+   // Parse everything before using any of it
+   ULONGLONG storeTime = 0;
+   std::vector <std::string> folderNames;
+   std::vector <sMBNIndexFolder> folders;
+   std::vector <sMBNIndexFile> files;
+
+   bool bOK = true;
+   while (bOK == true && std::getline( lines, line ))
+   {
+      std::istringstream fields( line );
+
+      std::string recType;
+      std::getline( fields, recType, '\t' );
+
+      ULONGLONG modTime = 0;
+      fields >> modTime;
+      fields.get();
+
+      if (recType == "S")
+      {
+         std::string path;
+         std::getline( fields, path );
+
+         bOK = (fields.fail() == false && path == storeName);
+         storeTime = modTime;
+      }
+      else if (recType == "D")
+      {
+         std::string path;
+         std::getline( fields, path );
+
+         sMBNIndexFolder folder;
+         folder.mTime = modTime;
+         folder.mbScanned = true;
+
+         bOK = (fields.fail() == false && path.size() > 0);
+         folderNames.push_back( path );
+         folders.push_back( folder );
+      }
+      else if (recType == "F" && folders.size() > 0)
+      {
+         sMBNIndexFile file;
+         file.mTime = modTime;
+
+         ULONG bValid = 0;
+         ULONG imageType = 0;
+         ULONG versionID = 0;
+         ULONG bBootValid = 0;
+         std::string imageID;
+
+         fields >> file.mSize >> bValid >> imageType >> versionID 
+                >> bBootValid >> file.mBootMajorVersion 
+                >> file.mBootMinorVersion;
+         fields.get();
+         std::getline( fields, imageID, '\t' );
+         std::getline( fields, file.mInfo.mVersion, '\t' );
+         std::getline( fields, file.mPath );
+
+         bOK = (fields.fail() == false)
+            && (file.mPath.size() > 0)
+            && (imageID.size() == MBN_UNIQUE_ID_LEN * 2);
+
+         for (ULONG i = 0; bOK == true && i < MBN_UNIQUE_ID_LEN; i++)
+         {
+            ULONG val = 0;
+            std::istringstream hex( imageID.substr( i * 2, 2 ) );
+            hex >> std::hex >> val;
+
+            bOK = (hex.fail() == false);
+            file.mInfo.mImageID[i] = (BYTE)val;
+         }
+
+         file.mbValid = (bValid != 0);
+         file.mbBootValid = (bBootValid != 0);
+         file.mInfo.mImageType = (eGobiMBNType)imageType;
+         file.mInfo.mVersionID = versionID;
+
+         folders.back().mFiles.push_back( file.mPath );
+         files.push_back( file );
+      }
+      else
+      {
+         bOK = false;
+      }
+   }
+
+   if (bOK == false)
+   {
+      TRACE( "MBN index %s, malformed\n", indexName.c_str() );
+      return;
+   }
+
+   store.mTime = storeTime;
+   store.mFolders = folderNames;
+
+   for (ULONG d = 0; d < (ULONG)folders.size(); d++)
+   {
+      if (mFolders.find( folderNames[d] ) == mFolders.end())
+      {
+         mFolders[folderNames[d]] = folders[d];
+      }
+   }
+
+   for (ULONG f = 0; f < (ULONG)files.size(); f++)
+   {
+      if (mFiles.find( files[f].mPath ) == mFiles.end())
+      {
+         mFiles[files[f].mPath] = files[f];
+      }
+   }
+
+   mGeneration++;
+}
+
+/*===========================================================================
+METHOD:
+   SaveStore (Internal Method)
+
+DESCRIPTION:
+   Write the index file of a store (replacing it atomically), failure, 
+   e.g. a read-only image store, only means the index is kept in memory
+
+PARAMETERS:
+   storeName   [ I ] - Fully qualified path to image store (normalized)
+   store       [ I ] - Store
+
+SEQUENCING:
+   Calling thread must have mSyncSection locked
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cGobiMBNIndex::SaveStore( 
+   const std::string &        storeName,
+   const sStore &             store )
+{
+   std::ostringstream out;
+   out << MBN_INDEX_HEADER << "\n";
+   out << "S\t" << store.mTime << "\t" << storeName << "\n";
+
+   // The folders of the store as well as any others indexed under it
+   std::map <std::string, sMBNIndexFolder>::const_iterator pFolder;
+   pFolder = mFolders.lower_bound( storeName + "/" );
+   while ( (pFolder != mFolders.end())
+   &&      (pFolder->first.compare( 0, storeName.size() + 1, 
+                                    storeName + "/" ) == 0) )
+   {
+      const sMBNIndexFolder & folder = pFolder->second;
+      out << "D\t" << folder.mTime << "\t" << pFolder->first << "\n";
+
+      for (ULONG f = 0; f < (ULONG)folder.mFiles.size(); f++)
+      {
+         const sMBNIndexFile & file = mFiles[folder.mFiles[f]];
+
+         CHAR imageID[MBN_UNIQUE_ID_LEN * 2 + 1];
+         for (ULONG i = 0; i < MBN_UNIQUE_ID_LEN; i++)
+         {
+            snprintf( &imageID[i * 2], 3, "%02X", file.mInfo.mImageID[i] );
+         }
+
+         out << "F\t" << file.mTime 
+             << "\t" << file.mSize 
+             << "\t" << (file.mbValid == true ? 1 : 0)
+             << "\t" << (ULONG)file.mInfo.mImageType
+             << "\t" << file.mInfo.mVersionID
+             << "\t" << (file.mbBootValid == true ? 1 : 0)
+             << "\t" << file.mBootMajorVersion
+             << "\t" << file.mBootMinorVersion
+             << "\t" << imageID
+             << "\t" << file.mInfo.mVersion
+             << "\t" << file.mPath << "\n";
+      }
+
+      pFolder++;
+   }
+
+   // Hidden, so never enumerated as an image folder
+   std::string indexFolder = storeName + "/" + MBN_INDEX_FOLDER_NAME;
+   mkdir( indexFolder.c_str(), 0755 );
+
+   std::string indexName = indexFolder + "/" + MBN_INDEX_FILE_NAME;
+   std::string tmpName = indexName + ".tmp";
+
+   int fd = open( tmpName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+   if (fd == -1)
+   {
+      TRACE( "MBN index %s, create failed\n", indexName.c_str() );
+      return false;
+   }
+
+   std::string data = out.str();
+   LPCSTR pData = data.c_str();
+   size_t remaining = data.size();
+
+   bool bRC = true;
+   while (bRC == true && remaining > 0)
+   {
+      ssize_t n = write( fd, pData, remaining );
+      if (n < 0 && errno == EINTR)
+      {
+         continue;
+      }
+
+      if (n <= 0)
+      {
+         bRC = false;
+         break;
+      }
+
+      pData += n;
+      remaining -= n;
+   }
+
+   if (close( fd ) != 0)
+   {
+      bRC = false;
+   }
+
+   if (bRC == true && rename( tmpName.c_str(), indexName.c_str() ) != 0)
+   {
+      bRC = false;
+   }
+
+   if (bRC == false)
+   {
+      TRACE( "MBN index %s, write failed\n", indexName.c_str() );
+      unlink( tmpName.c_str() );
+   }
+
+   return bRC;
+}
+
+/*===========================================================================
+METHOD:
+   RefreshStore (Internal Method)
+
+DESCRIPTION:
+   Bring the subfolders of a store (and the files in them) up to date, the
+   folders are only enumerated again if the store folder or one of its 
+   subfolders has changed (a new subfolder changes its parent)
+
+PARAMETERS:
+   storeName   [ I ] - Fully qualified path to image store (normalized)
+   store       [I/O] - Store
+
+SEQUENCING:
+   Calling thread must have mSyncSection locked
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiMBNIndex::RefreshStore( 
+   const std::string &        storeName,
+   sStore &                   store )
+{
+   ULONGLONG modTime = 0;
+   ULONGLONG size = 0;
+   bool bExists = GetMBNFileTime( storeName, true, modTime, size );
+
+   bool bSame = (bExists == true && modTime != 0 && modTime == store.mTime);
+   for (ULONG f = 0; bSame == true && f < (ULONG)store.mFolders.size(); f++)
+   {
+      const std::string & folder = store.mFolders[f];
+
+      ULONGLONG folderTime = 0;
+      bSame = ( (GetMBNFileTime( folder, true, folderTime, size ) == true)
+            &&  (folderTime != 0)
+            &&  (folderTime == mFolders[folder].mTime) );
+   }
+
+   if (bSame == false)
+   {
+      std::vector <std::string> folders;
+      if (bExists == true)
+      {
+         EnumerateFolders( storeName, folders );
+      }
+
+      // Drop what is no longer there
+      std::set <std::string> newFolders( folders.begin(), folders.end() );
+      for (ULONG f = 0; f < (ULONG)store.mFolders.size(); f++)
+      {
+         if (newFolders.find( store.mFolders[f] ) == newFolders.end())
+         {
+            RemoveFolder( store.mFolders[f] );
+         }
+      }
+
+      store.mbDirty = (store.mbDirty == true)
+                   || (store.mTime != modTime)
+                   || (store.mFolders != folders);
+
+      store.mTime = modTime;
+      store.mFolders = folders;
+   }
+
+   // The files of all folders are brought up to date together, which 
+   // lets the parsing of changed images spread over every folder
+   std::vector <std::string> files;
+   for (ULONG f = 0; f < (ULONG)store.mFolders.size(); f++)
+   {
+      const std::string & folder = store.mFolders[f];
+      if (ScanFolder( folder ) == true)
+      {
+         store.mbDirty = true;
+      }
+
+      std::map <std::string, sMBNIndexFolder>::const_iterator pFolder;
+      pFolder = mFolders.find( folder );
+      if (pFolder != mFolders.end())
+      {
+         files.insert( files.end(), 
+                       pFolder->second.mFiles.begin(), 
+                       pFolder->second.mFiles.end() );
+      }
+   }
+
+   if (RefreshFiles( files ) == true)
+   {
+      store.mbDirty = true;
+   }
+}
+
+/*===========================================================================
+METHOD:
+   RefreshFolder (Internal Method)
+
+DESCRIPTION:
+   Bring a folder (and the files in it) up to date, the folder is only 
+   searched for image files again if it has changed
+
+PARAMETERS:
+   folder      [ I ] - Fully qualified path to folder (normalized)
+
+SEQUENCING:
+   Calling thread must have mSyncSection locked
+
+RETURN VALUE:
+   bool - Did anything change?
+===========================================================================*/
+bool cGobiMBNIndex::RefreshFolder( const std::string & folder )
+{
+   bool bChanged = ScanFolder( folder );
+
+   std::map <std::string, sMBNIndexFolder>::const_iterator pFolder;
+   pFolder = mFolders.find( folder );
+   if ( (pFolder != mFolders.end())
+   &&   (RefreshFiles( pFolder->second.mFiles ) == true) )
+   {
+      bChanged = true;
+   }
+
+   return bChanged;
+}
+
+/*===========================================================================
+METHOD:
+   ScanFolder (Internal Method)
+
+DESCRIPTION:
+   Bring the list of image files in a folder up to date (but not the files
+   themselves), the folder is only searched again if it has changed
+
+PARAMETERS:
+   folder      [ I ] - Fully qualified path to folder (normalized)
+
+SEQUENCING:
+   Calling thread must have mSyncSection locked
+
+RETURN VALUE:
+   bool - Did anything change?
+===========================================================================*/
+bool cGobiMBNIndex::ScanFolder( const std::string & folder )
+{
+   ULONGLONG modTime = 0;
+   ULONGLONG size = 0;
+   if (GetMBNFileTime( folder, true, modTime, size ) == false)
+   {
+      return RemoveFolder( folder );
+   }
+
+   bool bChanged = false;
+
+   sMBNIndexFolder & rec = mFolders[folder];
+   if ( (rec.mbScanned == false)
+   ||   (modTime == 0)
+   ||   (modTime != rec.mTime) )
+   {
+      // Search all MBN files in the folder
+      std::vector <std::string> files;
+
+      std::string folderSearch = folder + "/*.mbn";
+
+      glob_t found;
+      int ret = glob( folderSearch.c_str(), 
+                      0, 
+                      NULL, 
+                      &found );
+      if (ret == 0)
+      {
+         for (int i = 0; i < (int)found.gl_pathc; i++)
+         {
+            files.push_back( found.gl_pathv[i] );
+         }
+
+         globfree( &found );
+      }
+
+      // Drop what is no longer there
+      std::set <std::string> newFiles( files.begin(), files.end() );
+      for (ULONG f = 0; f < (ULONG)rec.mFiles.size(); f++)
+      {
+         if (newFiles.find( rec.mFiles[f] ) == newFiles.end())
+         {
+            mFiles.erase( rec.mFiles[f] );
+            mGeneration++;
+         }
+      }
+
+      bChanged = (rec.mbScanned == false)
+              || (rec.mTime != modTime)
+              || (rec.mFiles != files);
+
+      rec.mbScanned = true;
+      rec.mTime = modTime;
+      rec.mFiles = files;
+   }
+
+   return bChanged;
+}
+
+/*===========================================================================
+METHOD:
+   RemoveFolder (Internal Method)
+
+DESCRIPTION:
+   Remove a folder (and the files in it) from the index
+
+PARAMETERS:
+   folder      [ I ] - Fully qualified path to folder (normalized)
+
+SEQUENCING:
+   Calling thread must have mSyncSection locked
+
+RETURN VALUE:
+   bool - Was the folder indexed?
+===========================================================================*/
+bool cGobiMBNIndex::RemoveFolder( const std::string & folder )
+{
+   std::map <std::string, sMBNIndexFolder>::iterator pFolder;
+   pFolder = mFolders.find( folder );
+   if (pFolder == mFolders.end())
+   {
+      return false;
+   }
+
+   const std::vector <std::string> & files = pFolder->second.mFiles;
+   for (ULONG f = 0; f < (ULONG)files.size(); f++)
+   {
+      mFiles.erase( files[f] );
+   }
+
+   mFolders.erase( pFolder );
+   mGeneration++;
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   RefreshFile (Internal Method)
+
+DESCRIPTION:
+   Bring a file up to date, the image information is only parsed again
+   if the file modification time or size has changed
+
+PARAMETERS:
+   path        [ I ] - Fully qualified path to file
+
+SEQUENCING:
+   Calling thread must have mSyncSection locked
+
+RETURN VALUE:
+   bool - Did anything change?
+===========================================================================*/
+bool cGobiMBNIndex::RefreshFile( const std::string & path )
+{
+   std::vector <std::string> paths( 1, path );
+   return RefreshFiles( paths );
+}
+
+/*===========================================================================
+METHOD:
+   RefreshFiles (Internal Method)
+
+DESCRIPTION:
+   Bring a set of files up to date, the image information of a file is 
+   only parsed again if its modification time or size has changed.  The 
+   files that need parsing are parsed in parallel (see 
+   ParseMBNIndexFiles()) and then recorded in order
+
+PARAMETERS:
+   paths       [ I ] - Fully qualified paths to files
+
+SEQUENCING:
+   Calling thread must have mSyncSection locked
+
+RETURN VALUE:
+   bool - Did anything change?
+===========================================================================*/
+bool cGobiMBNIndex::RefreshFiles( const std::vector <std::string> & paths )
+{
+   bool bChanged = false;
+
+   std::vector <sMBNIndexFile> stale;
+   for (ULONG p = 0; p < (ULONG)paths.size(); p++)
+   {
+      const std::string & path = paths[p];
+
+      ULONGLONG modTime = 0;
+      ULONGLONG size = 0;
+      if (GetMBNFileTime( path, false, modTime, size ) == false)
+      {
+         // Gone (the folder will drop it once searched again)
+         std::map <std::string, sMBNIndexFile>::iterator pFile;
+         pFile = mFiles.find( path );
+         if (pFile == mFiles.end() || pFile->second.mbValid == false)
+         {
+            continue;
+         }
+
+         pFile->second = sMBNIndexFile();
+         pFile->second.mPath = path;
+         mGeneration++;
+         bChanged = true;
+         continue;
+      }
+
+      std::map <std::string, sMBNIndexFile>::const_iterator pFile;
+      pFile = mFiles.find( path );
+      if ( (pFile != mFiles.end())
+      &&   (pFile->second.mPath.size() > 0)
+      &&   (modTime != 0)
+      &&   (pFile->second.mTime == modTime)
+      &&   (pFile->second.mSize == size) )
+      {
+         continue;
+      }
+
+      sMBNIndexFile newFile;
+      newFile.mPath = path;
+      newFile.mTime = modTime;
+      newFile.mSize = size;
+      stale.push_back( newFile );
+   }
+
+   ParseMBNIndexFiles( stale );
+
+   for (ULONG f = 0; f < (ULONG)stale.size(); f++)
+   {
+      if (UpdateFile( stale[f] ) == true)
+      {
+         bChanged = true;
+      }
+   }
+
+   return bChanged;
+}
+
+/*===========================================================================
+METHOD:
+   UpdateFile (Internal Method)
+
+DESCRIPTION:
+   Record a (freshly parsed) file in the index
+
+PARAMETERS:
+   newFile     [ I ] - The file
+
+SEQUENCING:
+   Calling thread must have mSyncSection locked
+
+RETURN VALUE:
+   bool - Did anything change?
+===========================================================================*/
+bool cGobiMBNIndex::UpdateFile( const sMBNIndexFile & newFile )
+{
+   sMBNIndexFile & file = mFiles[newFile.mPath];
+
+   bool bChanged = (file.mPath.size() == 0)
+                || (file.mTime != newFile.mTime)
+                || (file.mSize != newFile.mSize)
+                || (file.mbValid != newFile.mbValid)
+                || (file.mInfo.mImageType != newFile.mInfo.mImageType)
+                || (file.mInfo.mVersionID != newFile.mInfo.mVersionID)
+                || (file.mInfo.mVersion != newFile.mInfo.mVersion)
+                || (file.mbBootValid != newFile.mbBootValid)
+                || (file.mBootMajorVersion != newFile.mBootMajorVersion)
+                || (file.mBootMinorVersion != newFile.mBootMinorVersion)
+                || (memcmp( (LPCVOID)&file.mInfo.mImageID[0],
+                            (LPCVOID)&newFile.mInfo.mImageID[0],
+                            (SIZE_T)MBN_UNIQUE_ID_LEN ) != 0);
+
+   file = newFile;
+   if (bChanged == true)
+   {
+      mGeneration++;
+   }
+
+   return bChanged;
+}
+
+/*===========================================================================
+METHOD:
+   BuildIDs (Internal Method)
+
+DESCRIPTION:
+   Rebuild the unique ID index of a store if the index has changed since
+   it was last built, images are added in folder search order so that the
+   first image with a given ID wins
+
+PARAMETERS:
+   store       [I/O] - Store
+
+SEQUENCING:
+   Calling thread must have mSyncSection locked
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiMBNIndex::BuildIDs( sStore & store )
+{
+   if (store.mGeneration == mGeneration)
+   {
+      return;
+   }
+
+   std::vector <const sMBNIndexFile *> images;
+   for (ULONG d = 0; d < (ULONG)store.mFolders.size(); d++)
+   {
+      std::map <std::string, sMBNIndexFolder>::const_iterator pFolder;
+      pFolder = mFolders.find( store.mFolders[d] );
+      if (pFolder == mFolders.end())
+      {
+         continue;
+      }
+
+      const std::vector <std::string> & files = pFolder->second.mFiles;
+      for (ULONG f = 0; f < (ULONG)files.size(); f++)
+      {
+         std::map <std::string, sMBNIndexFile>::const_iterator pFile;
+         pFile = mFiles.find( files[f] );
+         if (pFile != mFiles.end() && pFile->second.mbValid == true)
+         {
+            images.push_back( &pFile->second );
+         }
+      }
+   }
+
+   store.mIDs.Reserve( (ULONG)images.size() );
+   for (ULONG i = 0; i < (ULONG)images.size(); i++)
+   {
+      const BYTE * pImageID = &images[i]->mInfo.mImageID[0];
+
+      ULONGLONG key = FoldMBNImageID( pImageID );
+      if (store.mIDs.Insert( key, images[i] ) == false)
+      {
+         // Two different IDs sharing a key make it ambiguous
+         const sMBNIndexFile * pOther = 0;
+         if ( (store.mIDs.Find( key, pOther ) == true)
+         &&   (memcmp( (LPCVOID)&pOther->mInfo.mImageID[0], 
+                       (LPCVOID)pImageID, 
+                       (SIZE_T)MBN_UNIQUE_ID_LEN ) != 0) )
+         {
+            store.mIDs.SetAmbiguous( key );
+         }
+      }
+   }
+
+   store.mGeneration = mGeneration;
+}
+
+/*===========================================================================
+METHOD:
+   FindID (Internal Method)
+
+DESCRIPTION:
+   Find an image in a store by unique ID
+
+PARAMETERS:
+   store       [I/O] - Store
+   pImageID    [ I ] - Unique image ID
+
+SEQUENCING:
+   Calling thread must have mSyncSection locked
+
+RETURN VALUE:
+   const sMBNIndexFile * - The image (0 if not found)
+===========================================================================*/
+const sMBNIndexFile * cGobiMBNIndex::FindID( 
+   sStore &                   store,
+   const BYTE *               pImageID )
+{
+   BuildIDs( store );
+
+   const sMBNIndexFile * pFile = 0;
+   if (store.mIDs.Find( FoldMBNImageID( pImageID ), pFile ) == false)
+   {
+      // Ambiguous key
+      return SearchStore( store, pImageID );
+   }
+
+   if ( (pFile != 0)
+   &&   (memcmp( (LPCVOID)&pFile->mInfo.mImageID[0], 
+                 (LPCVOID)pImageID, 
+                 (SIZE_T)MBN_UNIQUE_ID_LEN ) != 0) )
+   {
+      // Another ID with the same key (ours would have made it ambiguous)
+      pFile = 0;
+   }
+
+   return pFile;
+}
+
+/*===========================================================================
+METHOD:
+   SearchStore (Internal Method)
+
+DESCRIPTION:
+   Search the store subfolders for an image in order
+
+PARAMETERS:
+   store       [ I ] - Store
+   pImageID    [ I ] - Unique image ID
+
+SEQUENCING:
+   Calling thread must have mSyncSection locked
+
+RETURN VALUE:
+   const sMBNIndexFile * - The image (0 if not found)
+===========================================================================*/
+const sMBNIndexFile * cGobiMBNIndex::SearchStore( 
+   const sStore &             store,
+   const BYTE *               pImageID )
+{
+   for (ULONG d = 0; d < (ULONG)store.mFolders.size(); d++)
+   {
+      const sMBNIndexFolder & folder = mFolders[store.mFolders[d]];
+      for (ULONG f = 0; f < (ULONG)folder.mFiles.size(); f++)
+      {
+         const sMBNIndexFile & file = mFiles[folder.mFiles[f]];
+         if ( (file.mbValid == true)
+         &&   (memcmp( (LPCVOID)&file.mInfo.mImageID[0], 
+                       (LPCVOID)pImageID, 
+                       (SIZE_T)MBN_UNIQUE_ID_LEN ) == 0) )
+         {
+            return &file;
+         }
+      }
+   }
+
+   return 0;
+}
@@ -0,0 +1,276 @@
+/*===========================================================================
+FILE:
+   GobiMBNIndex.h
+
+DESCRIPTION:
+   Persistent index of the MBN images in an image store
+
+PUBLIC CLASSES AND METHODS:
+   sMBNIndexFile
+   sMBNIndexFolder
+   cGobiMBNIndex
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+==========================================================================*/
+
+/*=========================================================================*/
+// Pragmas
+/*=========================================================================*/
+#pragma once
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "GobiMBNMgmt.h"
+#include "CoreDatabase.h"
+
+#include <map>
+
+//---------------------------------------------------------------------------
+// Definitions
+//---------------------------------------------------------------------------
+
+// Folder (at the root of an image store) holding the index file, which 
+// keeps the store folder itself from changing whenever the index does
+extern LPCSTR MBN_INDEX_FOLDER_NAME;
+
+// Name of the index file
+extern LPCSTR MBN_INDEX_FILE_NAME;
+
+/*=========================================================================*/
+// Struct sMBNIndexFile
+//    An indexed image file, the (parsed) image information is valid for 
+//    as long as the file modification time and size are unchanged
+/*=========================================================================*/
+struct sMBNIndexFile
+{
+   public:
+      // (Inline) Default constructor
+      sMBNIndexFile()
+         :  mTime( 0 ),
+            mSize( 0 ),
+            mbValid( false ),
+            mbBootValid( false ),
+            mBootMajorVersion( 0 ),
+            mBootMinorVersion( 0 )
+      { };
+
+      /* Fully qualified path to the file */
+      std::string mPath;
+
+      /* Modification time (in nanoseconds) */
+      ULONGLONG mTime;
+
+      /* Size of the file */
+      ULONGLONG mSize;
+
+      /* Is this a valid image? (invalid files are indexed to avoid parsing 
+         them again) */
+      bool mbValid;
+
+      /* Image information */
+      sImageInfo mInfo;
+
+      /* Does the image carry a boot compatibility record? */
+      bool mbBootValid;
+
+      /* Major version of compatible boot downloader */
+      ULONG mBootMajorVersion;
+
+      /* Minor version of compatible boot downloader */
+      ULONG mBootMinorVersion;
+};
+
+/*=========================================================================*/
+// Struct sMBNIndexFolder
+//    An indexed folder, the list of image files is valid for as long as 
+//    the folder modification time is unchanged
+/*=========================================================================*/
+struct sMBNIndexFolder
+{
+   public:
+      // (Inline) Default constructor
+      sMBNIndexFolder()
+         :  mTime( 0 ),
+            mbScanned( false )
+      { };
+
+      /* Modification time (in nanoseconds) */
+      ULONGLONG mTime;
+
+      /* Has the folder been searched for image files? */
+      bool mbScanned;
+
+      /* Fully qualified paths of the image files (in search order) */
+      std::vector <std::string> mFiles;
+};
+
+/*=========================================================================*/
+// Class cGobiMBNIndex
+//
+//    Index of the MBN images found in one or more image stores, each store
+//    keeps its part of the index in a file (see MBN_INDEX_FOLDER_NAME) so 
+//    that image headers are only parsed again once the file changes.  
+//    Changes are detected by comparing file and folder modification times
+//    (and file sizes) so that a refresh only touches the file system 
+//    metadata of unchanged images 
+/*=========================================================================*/
+class cGobiMBNIndex
+{
+   public:
+      // Constructor
+      cGobiMBNIndex();
+
+      // Destructor
+      virtual ~cGobiMBNIndex();
+
+      // Return the information for the images in the given folder (which
+      // may lie in a subfolder of the given image store)
+      std::vector <sImageInfo> GetFolderImages( 
+         const std::string &        imageStore,
+         const std::string &        folder );
+
+      // Return the path to the image with the given unique ID that lies
+      // in a subfolder of the given image store
+      std::string FindImage( 
+         const std::string &        imageStore,
+         const BYTE *               pImageID );
+
+      // Return the paths to the images with the given unique IDs that lie
+      // in a subfolder of the given image store (a single pass)
+      std::vector <std::string> FindImages( 
+         const std::string &                 imageStore,
+         const std::vector <const BYTE *> &  imageIDs );
+
+      // Return the metadata of the images that lie in a subfolder of the
+      // given image store (in folder search order)
+      std::vector <sImageMetadata> GetStoreImages( 
+         const std::string &        imageStore );
+
+      // Empty the (in memory) index
+      void Clear();
+
+   protected:
+      /* An indexed image store */
+      struct sStore
+      {
+         sStore()
+            :  mTime( 0 ),
+               mbLoaded( false ),
+               mbDirty( false ),
+               mGeneration( ULONG_MAX )
+         { };
+
+         /* Modification time of the store folder (0 if never searched) */
+         ULONGLONG mTime;
+
+         /* Has the index file been loaded? */
+         bool mbLoaded;
+
+         /* Does the index file need to be written? */
+         bool mbDirty;
+
+         /* Subfolders of the store (in search order) */
+         std::vector <std::string> mFolders;
+
+         /* Unique ID index of the valid images in the store subfolders */
+         cDB2HashIndex <sMBNIndexFile> mIDs;
+
+         /* Index generation the unique ID index was built for */
+         ULONG mGeneration;
+      };
+
+      // Return the (loaded) store with the given name
+      sStore & GetStore( const std::string & storeName );
+
+      // Load the index file of a store
+      void LoadStore( 
+         const std::string &        storeName,
+         sStore &                   store );
+
+      // Write the index file of a store
+      bool SaveStore( 
+         const std::string &        storeName,
+         const sStore &             store );
+
+      // Bring the subfolders of a store up to date
+      void RefreshStore( 
+         const std::string &        storeName,
+         sStore &                   store );
+
+      // Bring a folder (and the files in it) up to date
+      bool RefreshFolder( const std::string & folder );
+
+      // Bring the list of files in a folder up to date
+      bool ScanFolder( const std::string & folder );
+
+      // Remove a folder (and the files in it) from the index
+      bool RemoveFolder( const std::string & folder );
+
+      // Bring a file up to date
+      bool RefreshFile( const std::string & path );
+
+      // Bring a set of files up to date (parsing them in parallel)
+      bool RefreshFiles( const std::vector <std::string> & paths );
+
+      // Record a (parsed) file
+      bool UpdateFile( const sMBNIndexFile & newFile );
+
+      // Find an image in a store by unique ID
+      const sMBNIndexFile * FindID( 
+         sStore &                   store,
+         const BYTE *               pImageID );
+
+      // Rebuild the unique ID index of a store (if out of date)
+      void BuildIDs( sStore & store );
+
+      // Search the store subfolders for an image in order
+      const sMBNIndexFile * SearchStore( 
+         const sStore &             store,
+         const BYTE *               pImageID );
+
+      /* Indexed image stores, by fully qualified path */
+      std::map <std::string, sStore> mStores;
+
+      /* Indexed folders, by fully qualified path */
+      std::map <std::string, sMBNIndexFolder> mFolders;
+
+      /* Indexed files, by fully qualified path */
+      std::map <std::string, sMBNIndexFile> mFiles;
+
+      /* Index generation (changes whenever a file is added or removed) */
+      ULONG mGeneration;
+
+      /* Synchronization object (guards all of the above) */
+      pthread_mutex_t mSyncSection;
+
+   private:
+      // Unsupported
+      cGobiMBNIndex( const cGobiMBNIndex & );
+      cGobiMBNIndex & operator = ( const cGobiMBNIndex & );
+};
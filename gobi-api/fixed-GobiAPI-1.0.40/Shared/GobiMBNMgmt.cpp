@@ -46,13 +46,12 @@ POSSIBILITY OF SUCH DAMAGE.
 //---------------------------------------------------------------------------
 #include "StdAfx.h"
 #include "GobiMBNMgmt.h"
+#include "GobiMBNIndex.h"
 #include "GobiError.h"
 
 #include "CoreUtilities.h"
 #include "MemoryMappedFile.h"
 
-#include <glob.h>
-
 //---------------------------------------------------------------------------
 // Definitions
 //---------------------------------------------------------------------------
@@ -68,6 +67,9 @@ const ULONG MBN_LOCK_AUTH_MAGIC = 0xFEDC1238;
 // Maximum length for an UQCN build info string (including NULL)
 const ULONG MBN_BUILD_ID_LEN = 32;
 
+// Index of the images found in the image stores
+cGobiMBNIndex gMBNIndex;
+
 //---------------------------------------------------------------------------
 // Pragmas (pack structs)
 //---------------------------------------------------------------------------
@@ -547,6 +549,137 @@ static const char *VidPidToImageStore(unsigned int vid, unsigned int pid)
 	return dev ? dev->fwpath : NULL;
 }
 
+/*===========================================================================
+METHOD:
+   ParseMBNInfo (Free Method)
+
+DESCRIPTION:
+   Parse the image information out of the trailing records of an MBN image
+
+PARAMETERS:
+   pMBNData    [ I ] - The last 256 bytes of the image
+   info        [ O ] - Image information
+
+RETURN VALUE:
+   eGobiError - Return code
+===========================================================================*/
+static eGobiError ParseMBNInfo(
+   const BYTE *               pMBNData,
+   sImageInfo &               info )
+{
+   // Search for the UQCN specific info
+   const BYTE * pTmp = 0;
+   pTmp = ReverseBinaryDataSearch( pMBNData,
+                                   256,
+                                   (const BYTE *)&UQCN_INFO_MAGIC,
+                                   (ULONG)sizeof( UQCN_INFO_MAGIC ) );
+
+   if (pTmp != 0)
+   {
+      const sUQCNInfoRecord * pRec = (const sUQCNInfoRecord *)pTmp;
+      info.mVersionID = *(ULONG *)&pRec->mVersionID;
+      info.mImageType = eGOBI_MBN_TYPE_PRI;
+   }
+   else
+   {
+      // Since we did not find UQCN info, presume this is an AMSS file
+      pTmp = ReverseBinaryDataSearch( pMBNData,
+                                      256,
+                                      (const BYTE *)&MBN_BOOT_MAGIC,
+                                      (ULONG)sizeof( MBN_BOOT_MAGIC ) );
+
+      if (pTmp == 0)
+      {
+         return eGOBI_ERR_INVALID_FILE;
+      }
+
+      const sMBNBootRecord * pRec = (const sMBNBootRecord *)pTmp;
+      info.mVersionID = pRec->mMinorID;
+      info.mImageType = eGOBI_MBN_TYPE_MODEM;
+   }
+
+   // Search for the unique ID
+   pTmp = ReverseBinaryDataSearch( pMBNData,
+                                   256,
+                                   (const BYTE *)&MBN_HASH_MAGIC,
+                                   (ULONG)sizeof( MBN_HASH_MAGIC ) );
+
+   if (pTmp == 0)
+   {
+      return eGOBI_ERR_INVALID_FILE;
+   }
+
+   // Copy the unique ID
+   const sMBNHashRecord * pHash = (const sMBNHashRecord *)pTmp;
+   memcpy( (LPVOID)&info.mImageID[0],
+           (LPCVOID)&pHash->mUniqueID[0],
+           (SIZE_T)MBN_UNIQUE_ID_LEN );
+
+
+   // Search for the build ID
+   pTmp = ReverseBinaryDataSearch( pMBNData,
+                                   256,
+                                   (const BYTE *)&MBN_BUILD_MAGIC,
+                                   (ULONG)sizeof( MBN_BUILD_MAGIC ) );
+
+   if (pTmp == 0)
+   {
+      return eGOBI_ERR_INVALID_FILE;
+   }
+
+   // Copy the MBN_BUILD_MAGIC ID (which need not be NULL terminated)
+   const sMBNBuildIDRecord * pRec = (const sMBNBuildIDRecord *)pTmp;
+
+   ULONG len = 0;
+   while (len < MBN_BUILD_ID_LEN && pRec->mBuildID[len] != 0)
+   {
+      len++;
+   }
+
+   info.mVersion.assign( &pRec->mBuildID[0], len );
+
+   return eGOBI_ERR_NONE;
+}
+
+/*===========================================================================
+METHOD:
+   ParseMBNBoot (Free Method)
+
+DESCRIPTION:
+   Parse the boot compatibility out of the trailing records of an MBN 
+   image
+
+PARAMETERS:
+   pMBNData       [ I ] - The last 256 bytes of the image
+   majorVersion   [ O ] - Major version of compatible boot downloader
+   minorVersion   [ O ] - Minor version of compatible boot downloader
+
+RETURN VALUE:
+   bool - Was a boot compatibility record found?
+===========================================================================*/
+static bool ParseMBNBoot(
+   const BYTE *               pMBNData,
+   ULONG &                    majorVersion,
+   ULONG &                    minorVersion )
+{
+   const BYTE * pTmp = 0;
+   pTmp = ReverseBinaryDataSearch( pMBNData,
+                                   256,
+                                   (const BYTE *)&MBN_BOOT_MAGIC,
+                                   (ULONG)sizeof( MBN_BOOT_MAGIC ) );
+
+   if (pTmp == 0)
+   {
+      return false;
+   }
+
+   const sMBNBootRecord * pRec = (const sMBNBootRecord *)pTmp;
+   majorVersion = pRec->mMajorID;
+   minorVersion = pRec->mMinorID;
+
+   return true;
+}
+
 /*===========================================================================
 METHOD:
    GetImageStore (Public Method)
@@ -625,70 +758,22 @@ eGobiError GetImageInfo(
    // Skip to the end
    pMBNData += (dataSz - 256);
 
-   // Search for the UQCN specific info
-   const BYTE * pTmp = 0;
-   pTmp = ReverseBinaryDataSearch( pMBNData,
-                                   256,
-                                   (const BYTE *)&UQCN_INFO_MAGIC,
-                                   (ULONG)sizeof( UQCN_INFO_MAGIC ) );
-
-   if (pTmp != 0)
-   {
-      const sUQCNInfoRecord * pRec = (const sUQCNInfoRecord *)pTmp;
-      *pVersionID = *(ULONG *)&pRec->mVersionID;
-      *pImageType = 1;
-   }
-   else
-   {
-      // Since we did not find UQCN info, presume this is an AMSS file
-      pTmp = ReverseBinaryDataSearch( pMBNData,
-                                      256,
-                                      (const BYTE *)&MBN_BOOT_MAGIC,
-                                      (ULONG)sizeof( MBN_BOOT_MAGIC ) );
-
-      if (pTmp == 0)
-      {
-         return eGOBI_ERR_INVALID_FILE;
-      }
-
-      const sMBNBootRecord * pRec = (const sMBNBootRecord *)pTmp;
-      *pVersionID = pRec->mMinorID;
-      *pImageType = 0;
-   }
-
-   // Search for the unique ID
-   pTmp = ReverseBinaryDataSearch( pMBNData,
-                                   256,
-                                   (const BYTE *)&MBN_HASH_MAGIC,
-                                   (ULONG)sizeof( MBN_HASH_MAGIC ) );
-
-   if (pTmp == 0)
+   sImageInfo info;
+   eGobiError rc = ParseMBNInfo( pMBNData, info );
+   if (rc != eGOBI_ERR_NONE)
    {
-      return eGOBI_ERR_INVALID_FILE;
+      return rc;
    }
 
-   // Copy the unique ID
-   const sMBNHashRecord * pHash = (const sMBNHashRecord *)pTmp;
+   *pImageType = (BYTE)info.mImageType;
+   *pVersionID = info.mVersionID;
    memcpy( (LPVOID)pImageID,
-           (LPCVOID)&pHash->mUniqueID[0],
+           (LPCVOID)&info.mImageID[0],
            (SIZE_T)MBN_UNIQUE_ID_LEN );
 
-
-   // Search for the build ID
-   pTmp = ReverseBinaryDataSearch( pMBNData,
-                                   256,
-                                   (const BYTE *)&MBN_BUILD_MAGIC,
-                                   (ULONG)sizeof( MBN_BUILD_MAGIC ) );
-
-   if (pTmp == 0)
-   {
-      return eGOBI_ERR_INVALID_FILE;
-   }
-
    memset( (PVOID)&pVersion[0], 0, (SIZE_T)versionSize );
 
-   // Copy the MBN_BUILD_MAGIC ID
-   const sMBNBuildIDRecord * pRec = (const sMBNBuildIDRecord *)pTmp;
+   // Copy the build ID (including the NULL terminator)
    for (ULONG t = 0; t < MBN_BUILD_ID_LEN; t++)
    {
       if (t >= versionSize)
@@ -696,11 +781,12 @@ eGobiError GetImageInfo(
          return eGOBI_ERR_BUFFER_SZ;
       }
 
-      pVersion[t] = pRec->mBuildID[t];
-      if (pRec->mBuildID[t] == 0)
+      if (t >= (ULONG)info.mVersion.size())
       {
          break;
       }
+
+      pVersion[t] = info.mVersion[t];
    }
 
    return eGOBI_ERR_NONE;
@@ -708,77 +794,84 @@ eGobiError GetImageInfo(
 
 /*===========================================================================
 METHOD:
-   GetImagesInfo (Public Method)
+   GetImageMetadata (Public Method)
 
 DESCRIPTION:
-   Return the info for the images located at the given path
-  
+   Get the image information and boot compatibility for the image 
+   specified by the given fully qualified path, reading the file once
+
 PARAMETERS:
-   path        [ I ] - Fully qualified path
+   pFilePath   [ I ] - Fully qualified path to image file
+   metadata    [ O ] - Image metadata
 
 RETURN VALUE:
-   std:vector <sImageInfo> - Vector of image information
+   eGobiError - Return code (the image information is required, the boot
+                compatibility is optional)
 ===========================================================================*/
-std::vector <sImageInfo> GetImagesInfo( const std::string & path )
+eGobiError GetImageMetadata(
+   LPCSTR                     pFilePath,
+   sImageMetadata &           metadata )
 {
+   metadata = sImageMetadata();
+
    // Validate arguments
-   std::vector <sImageInfo> retVec;
-   if (path.size() <= 0)
+   if (pFilePath == 0 || pFilePath[0] == 0)
    {
-      return retVec;
+      return eGOBI_ERR_INVALID_ARG;
    }
 
-   // Search all MBN files in the specified folder
-   std::string folderSearch = path;
+   metadata.mPath = pFilePath;
 
-   int folderLen = folderSearch.size();
-   if (folderSearch[folderLen - 1] != '/')
+   // Open up MBN file
+   cMemoryMappedFile mbnFile( pFilePath );
+   const BYTE * pMBNData = (const BYTE *)mbnFile.GetContents();
+   ULONG dataSz = mbnFile.GetSize();
+
+   // MBN file (sort of) valid?
+   if (pMBNData == 0)
    {
-      folderSearch += '/';
+      return eGOBI_ERR_FILE_OPEN;
    }
-
-   folderSearch += "*.mbn";
-
-   glob_t files;
-   int ret = glob( folderSearch.c_str(), 
-                   0, 
-                   NULL, 
-                   &files );
-   if (ret != 0)
+   
+   if (dataSz <= 256)
    {
-      // Glob error
-      return retVec;
+      return eGOBI_ERR_INVALID_FILE;
    }
 
-   for (int i = 0; i < files.gl_pathc; i++)
-   {
-      std::string mbnName = files.gl_pathv[i];
+   // Skip to the end
+   pMBNData += (dataSz - 256);
 
-      BYTE imageType = UCHAR_MAX;
-      BYTE imageID[16] = { 0 };
-      ULONG versionID = ULONG_MAX;
-      USHORT versionSz = MAX_PATH * 2 + 1;
-      CHAR versionStr[MAX_PATH * 2 + 1] = { 0 };
-      eGobiError rc = ::GetImageInfo( mbnName.c_str(),
-                                      &imageType,
-                                      &imageID[0],
-                                      &versionID,
-                                      versionSz,
-                                      &versionStr[0] );
+   metadata.mbBootValid = ParseMBNBoot( pMBNData, 
+                                        metadata.mBootMajorVersion,
+                                        metadata.mBootMinorVersion );
 
-      if (rc == eGOBI_ERR_NONE)
-      {
-         sImageInfo ii;
-         ii.mImageType = (eGobiMBNType)imageType;
-         ii.mVersionID = versionID;
-         ii.mVersion = (LPCSTR)&versionStr[0];
-         memcpy( (LPVOID)&ii.mImageID[0], (LPCVOID)&imageID[0], 16 );
+   return ParseMBNInfo( pMBNData, metadata.mInfo );
+}
 
-         retVec.push_back( ii );
-      }
+/*===========================================================================
+METHOD:
+   GetImagesInfo (Public Method)
+
+DESCRIPTION:
+   Return the info for the images located at the given path
+  
+PARAMETERS:
+   path        [ I ] - Fully qualified path
+
+RETURN VALUE:
+   std:vector <sImageInfo> - Vector of image information
+===========================================================================*/
+std::vector <sImageInfo> GetImagesInfo( const std::string & path )
+{
+   // Validate arguments
+   std::vector <sImageInfo> retVec;
+   if (path.size() <= 0)
+   {
+      return retVec;
    }
-   globfree( &files );
 
+   // Images are only parsed again once changed
+   retVec = gMBNIndex.GetFolderImages( VidPidToImageStore( 0, 0 ), path );
    return retVec;
 }
 
@@ -831,21 +924,11 @@ eGobiError GetImageBootCompatibility(
    // Skip to the end
    pMBNData += (dataSz - 256);
 
-   const BYTE * pTmp = 0;
-   pTmp = ReverseBinaryDataSearch( pMBNData,
-                                   256,
-                                   (const BYTE *)&MBN_BOOT_MAGIC,
-                                   (ULONG)sizeof( MBN_BOOT_MAGIC ) );
-
-   if (pTmp == 0)
+   if (ParseMBNBoot( pMBNData, *pMajorVersion, *pMinorVersion ) == false)
    {
       return eGOBI_ERR_INVALID_FILE;
    }
 
-   const sMBNBootRecord * pRec = (const sMBNBootRecord *)pTmp;
-   *pMajorVersion = pRec->mMajorID;
-   *pMinorVersion = pRec->mMinorID;
-
    return eGOBI_ERR_NONE;
 }
 
@@ -931,87 +1014,53 @@ std::string GetImageByUniqueID( BYTE * pImageID )
       return retStr;
    }
 
-   // Enumerate all folders of the image store
-   std::vector <std::string> folders;
-
+   // Search all folders of the image store (through the index)
    std::string imageStore = ::GetImageStore(0, 0);
-   EnumerateFolders( imageStore, folders );
-
-   // Did we find any folders?
-   ULONG foldersSz = (ULONG)folders.size();
-   if (foldersSz == 0)
-   {
-      return retStr;
-   }
+   retStr = gMBNIndex.FindImage( imageStore, pImageID );
 
-   // Go through each folder searching for a match
-   for (ULONG f = 0; f < foldersSz; f++)
-   {
-      // Search all MBN files in the specified folder
-      std::string folderSearch = folders[f];
+   return retStr;
+}
 
-      int folderLen = folderSearch.size();
-      if (folderSearch[folderLen - 1] != '/')
-      {
-         folderSearch += '/';
-      }
+/*===========================================================================
+METHOD:
+   GetImagesByUniqueID (Public Method)
 
-      folderSearch += "*.mbn";
+DESCRIPTION:
+   Return the fully qualified paths to the images specified by unique ID,
+   matching them all in a single pass over the image store index
+  
+PARAMETERS:
+   imageIDs    [ I ] - Unique image IDs
 
-      glob_t files;
-      int ret = glob( folderSearch.c_str(), 
-                      0, 
-                      NULL, 
-                      &files );
-      if (ret != 0)
-      {
-         // Glob error, often GLOB_NOMATCH
-         continue;
-      }
+RETURN VALUE:
+   std::vector <std::string> - Fully qualified path to each matching image
+                               (empty for an image that was not found)
+===========================================================================*/
+std::vector <std::string> GetImagesByUniqueID( 
+   const std::vector <const BYTE *> & imageIDs )
+{
+   std::string imageStore = ::GetImageStore(0, 0);
+   return gMBNIndex.FindImages( imageStore, imageIDs );
+}
 
-      for (int i = 0; i < files.gl_pathc; i++)
-      {
-         std::string mbnName = files.gl_pathv[i];
-
-         BYTE imageType = UCHAR_MAX;
-         BYTE imageID[16] = { 0 };
-         ULONG versionID = ULONG_MAX;
-         USHORT versionSz = MAX_PATH * 2 + 1;
-         CHAR versionStr[MAX_PATH * 2 + 1] = { 0 };
-         eGobiError rc = ::GetImageInfo( mbnName.c_str(),
-                                         &imageType,
-                                         &imageID[0],
-                                         &versionID,
-                                         versionSz,
-                                         &versionStr[0] );
-
-         if (rc == eGOBI_ERR_NONE)
-         {
-            bool bMatch = true;
-            for (ULONG i = 0; i < 16; i++)
-            {
-               if (imageID[i] != pImageID[i])
-               {
-                  bMatch = false;
-                  break;
-               }
-            }
-
-            if (bMatch == true)
-            {
-               retStr = mbnName;
-               break;
-            }
-         }
-      }
-      globfree( &files );
+/*===========================================================================
+METHOD:
+   GetImageStoreMetadata (Public Method)
 
-      if (retStr.size() > 0)
-      {
-         break;
-      }
-   }
+DESCRIPTION:
+   Return the metadata of every valid image in the subfolders of the given
+   image store, in folder search order.  The store is scanned through the
+   image store index, so only new or changed images are parsed (in 
+   parallel)
+  
+PARAMETERS:
+   imageStore  [ I ] - Fully qualified path to image store
 
-   return retStr;
+RETURN VALUE:
+   std::vector <sImageMetadata> - Metadata of each image
+===========================================================================*/
+std::vector <sImageMetadata> GetImageStoreMetadata( 
+   const std::string &        imageStore )
+{
+   return gMBNIndex.GetStoreImages( imageStore );
 }
-
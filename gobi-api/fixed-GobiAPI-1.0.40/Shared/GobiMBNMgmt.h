@@ -13,6 +13,7 @@ PUBLIC CLASSES AND FUNCTIONS:
    GetImageBootCompatibility
    MapVersionInfo
    GetImageByUniqueID 
+   GetImagesByUniqueID
 
 Copyright (c) 2011, Code Aurora Forum. All rights reserved.
 
@@ -101,6 +102,38 @@ struct sImageInfo
       std::string mVersion;
 };
 
+/*=========================================================================*/
+// Struct sImageMetadata
+//    Storage structure for everything known about an image file, i.e. 
+//    both its image information and its boot compatibility
+/*=========================================================================*/
+struct sImageMetadata
+{
+   public:
+      // Default constructor
+      sImageMetadata()
+         :  mPath( "" ),
+            mbBootValid( false ),
+            mBootMajorVersion( 0 ),
+            mBootMinorVersion( 0 )
+      { };
+
+      /* Fully qualified path to the image file */
+      std::string mPath;
+
+      /* Image information */
+      sImageInfo mInfo;
+
+      /* Does the image carry a boot compatibility record? */
+      bool mbBootValid;
+
+      /* Major version of compatible boot downloader */
+      ULONG mBootMajorVersion;
+
+      /* Minor version of compatible boot downloader */
+      ULONG mBootMinorVersion;
+};
+
 /*=========================================================================*/
 // Public Methods
 /*=========================================================================*/
@@ -148,6 +181,25 @@ eGobiError GetImageInfo(
    USHORT                     versionSize,
    CHAR *                     pVersion );
 
+/*===========================================================================
+METHOD:
+   GetImageMetadata (Public Method)
+
+DESCRIPTION:
+   Get the image information and boot compatibility for the image 
+   specified by the given fully qualified path, reading the file once
+
+PARAMETERS:
+   pFilePath   [ I ] - Fully qualified path to image file
+   metadata    [ O ] - Image metadata
+
+RETURN VALUE:
+   eGobiError - Return code
+===========================================================================*/
+eGobiError GetImageMetadata(
+   LPCSTR                     pFilePath,
+   sImageMetadata &           metadata );
+
 /*===========================================================================
 METHOD:
    GetImagesInfo (Public Method)
@@ -227,4 +279,39 @@ RETURN VALUE:
 ===========================================================================*/
 std::string GetImageByUniqueID( BYTE * pImageID );
 
+/*===========================================================================
+METHOD:
+   GetImagesByUniqueID (Public Method)
 
+DESCRIPTION:
+   Return the fully qualified paths to the images specified by unique ID,
+   matching them all in a single pass over the image store index
+  
+PARAMETERS:
+   imageIDs    [ I ] - Unique image IDs
+
+RETURN VALUE:
+   std::vector <std::string> - Fully qualified path to each matching image
+                               (empty for an image that was not found)
+===========================================================================*/
+std::vector <std::string> GetImagesByUniqueID( 
+   const std::vector <const BYTE *> & imageIDs );
+
+/*===========================================================================
+METHOD:
+   GetImageStoreMetadata (Public Method)
+
+DESCRIPTION:
+   Return the metadata of every valid image in the subfolders of the given
+   image store, in folder search order.  The store is scanned through the
+   image store index, so only new or changed images are parsed (in 
+   parallel)
+  
+PARAMETERS:
+   imageStore  [ I ] - Fully qualified path to image store
+
+RETURN VALUE:
+   std::vector <sImageMetadata> - Metadata of each image
+===========================================================================*/
+std::vector <sImageMetadata> GetImageStoreMetadata( 
+   const std::string &        imageStore );
@@ -44,8 +44,11 @@ POSSIBILITY OF SUCH DAMAGE.
 
 #include "QDLBuffers.h"
 #include "ProtocolNotification.h"
+#include "MemoryMappedFile.h"
 
 #include <glob.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 //---------------------------------------------------------------------------
 // Definitions
@@ -55,6 +58,52 @@ POSSIBILITY OF SUCH DAMAGE.
 const ULONG DEFAULT_GOBI_QDL_TIMEOUT = 4000;
 const ULONG MINIMUM_GOBI_QDL_TIMEOUT = 2000;
 
+// Default number of image block writes awaiting a response at once
+const ULONG DEFAULT_GOBI_QDL_WRITE_WINDOW = 4;
+
+// Maximum number of attempts made at writing a single image block
+const ULONG MAX_GOBI_QDL_WRITE_ATTEMPTS = 3;
+
+// Protocol events queued per outstanding image block write
+const ULONG GOBI_QDL_WRITE_EVENTS = 512;
+
+/*=========================================================================*/
+// Free Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   PrefetchImage (Internal Method)
+
+DESCRIPTION:
+   Ask the kernel to start reading in the given part of a (memory mapped)
+   image so that the pages are resident by the time the protocol server
+   transmits them.  The read-ahead is asynchronous, failure (an image that
+   is not mapped from a file, for instance) is harmless
+
+PARAMETERS:
+   pData       [ I ] - Start of the image region
+   dataSz      [ I ] - Size of the image region
+  
+RETURN VALUE:
+   None
+===========================================================================*/
+static void PrefetchImage(
+   const BYTE *               pData,
+   ULONG                      dataSz )
+{
+   if (pData == 0 || dataSz == 0)
+   {
+      return;
+   }
+
+   // madvise() wants a page aligned start
+   ULONG pageSz = (ULONG)sysconf( _SC_PAGESIZE );
+   ULONG lead = (ULONG)((unsigned long)pData % pageSz);
+
+   madvise( (void *)(pData - lead), dataSz + lead, MADV_WILLNEED );
+}
+
 /*=========================================================================*/
 // cGobiQDLCore Methods
 /*=========================================================================*/
@@ -610,6 +659,334 @@ eGobiError cGobiQDLCore::WriteQDLImageBlock(
       return GetCorrectedLastError();
    }
 
+   return CheckWriteResponse( rsp );
+}
+
+/*===========================================================================
+METHOD:
+   WriteQDLImage (Public Method)
+
+DESCRIPTION:
+   This function writes a prepared image (see PrepareQDLImageWrite()) to 
+   the device as a series of blocks, block N being sent with sequence 
+   number N.  Up to the given number of block writes are kept awaiting a
+   response at once, and a block whose write times out or is rejected 
+   with a CRC error is retransmitted
+
+PARAMETERS:
+   pImage         [ I ] - Image (must remain valid for the duration)
+   imageSize      [ I ] - Size of image
+   blockSize      [ I ] - Size of image block (as returned by the device)
+   window         [ I ] - Maximum number of block writes awaiting a
+                          response (1 to write one block at a time)
+  
+RETURN VALUE:
+   eGobiError - Return code
+===========================================================================*/
+eGobiError cGobiQDLCore::WriteQDLImage( 
+   const BYTE *               pImage,
+   ULONG                      imageSize,
+   ULONG                      blockSize,
+   ULONG                      window )
+{
+   if ( (pImage == 0 || imageSize == 0 || window == 0)
+   ||   (blockSize == 0 || blockSize > QDL_MAX_CHUNK_SIZE) )
+   {
+      return eGOBI_ERR_INVALID_ARG;
+   }
+
+   // Blocks are identified by their (16-bit) sequence number
+   ULONG blockCount = imageSize / blockSize;
+   if ((imageSize % blockSize) != 0)
+   {
+      blockCount++;
+   }
+
+   if (blockCount > (ULONG)USHRT_MAX + 1)
+   {
+      return eGOBI_ERR_INVALID_ARG;
+   }
+
+   // Are we connected?
+   if ( (mQDLPortNode.empty() == true)
+   ||   (mQDL.IsConnected() == false) )
+   {
+      return eGOBI_ERR_NO_CONNECTION;
+   }
+
+   if (window > blockCount)
+   {
+      window = blockCount;
+   }
+
+   // Open the window on the server (one block at a time otherwise)
+   ULONG oldWindow = mQDL.GetInFlightWindow();
+   if (window > 1 && mQDL.SetInFlightWindow( window ) == false)
+   {
+      window = 1;
+   }
+
+   // We use the event based notification approach
+   tProtocolNotificationQueue evts( (window + 1) * GOBI_QDL_WRITE_EVENTS, 
+                                    true );
+
+   cProtocolQueueNotification pn( &evts );
+   cEvent & sigEvt = evts.GetSignalEvent();
+   const cProtocolLog & protocolLog = mQDL.GetLog();
+
+   // Outstanding writes (request ID mapped to block) and write attempts 
+   std::map <ULONG, ULONG> outstanding;
+   std::vector <ULONG> attempts( blockCount, 0 );
+
+   // Blocks to be retransmitted, oldest first
+   std::deque <ULONG> retries;
+
+   ULONG nextBlock = 0;
+   ULONG blocksDone = 0;
+
+   // First block not yet prefetched
+   ULONG prefetchBlock = 0;
+
+   eGobiError rc = eGOBI_ERR_NONE;
+   while (rc == eGOBI_ERR_NONE && blocksDone < blockCount)
+   {
+      // Keep the window full (retransmissions first)
+      while ( ((ULONG)outstanding.size() < window)
+      &&      (retries.size() > 0 || nextBlock < blockCount) )
+      {
+         ULONG block = nextBlock;
+         if (retries.size() > 0)
+         {
+            block = retries.front();
+            retries.pop_front();
+         }
+         else
+         {
+            nextBlock++;
+         }
+
+         ULONG offset = block * blockSize;
+         ULONG sz = imageSize - offset;
+         if (sz > blockSize)
+         {
+            sz = blockSize;
+         }
+
+         sSharedBuffer * pReq = 0;
+         pReq = sQDLWriteUnframed::BuildWriteUnframedReq( (USHORT)block, sz );
+         if (pReq == 0)
+         {
+            rc = eGOBI_ERR_MEMORY;
+            break;
+         }
+
+         // The block is sent straight from the image
+         sProtocolRequest req( pReq, 0, mQDLTimeout, 1, 1, &pn );
+         req.SetAuxiliaryData( pImage + offset, sz );
+
+         ULONG reqID = mQDL.AddRequest( req );
+         if (reqID == INVALID_REQUEST_ID)
+         {
+            rc = eGOBI_ERR_REQ_SCHEDULE;
+            break;
+         }
+
+         attempts[block]++;
+         outstanding[reqID] = block;
+      }
+
+      if (rc != eGOBI_ERR_NONE)
+      {
+         break;
+      }
+
+      // While the window is on the wire read in the one after it, so the
+      // server never stalls on a page fault when sending the next block
+      ULONG prefetchEnd = nextBlock + window;
+      if (prefetchEnd > blockCount)
+      {
+         prefetchEnd = blockCount;
+      }
+
+      if (prefetchBlock < prefetchEnd)
+      {
+         ULONG offset = prefetchBlock * blockSize;
+         ULONG end = prefetchEnd * blockSize;
+         if (end > imageSize)
+         {
+            end = imageSize;
+         }
+
+         PrefetchImage( pImage + offset, end - offset );
+         prefetchBlock = prefetchEnd;
+      }
+
+      // The server times out the individual writes (at which point we
+      // retransmit), this only guards against losing those timeouts
+      DWORD idx;
+      int wc = sigEvt.Wait( mQDLTimeout * 2, idx );
+      if (wc == ETIME)
+      {
+         rc = eGOBI_ERR_RESPONSE_TO;
+         break;
+      }
+      else if (wc != 0)
+      {
+         rc = eGOBI_ERR_INTERNAL;
+         break;
+      }
+
+      sProtocolNotificationEvent evt;
+      if (evts.GetElement( idx, evt ) == false)
+      {
+         rc = eGOBI_ERR_INTERNAL;
+         break;
+      }
+
+      std::map <ULONG, ULONG>::iterator pIter;
+      pIter = outstanding.find( (ULONG)evt.mParam1 );
+      if (pIter == outstanding.end())
+      {
+         continue;
+      }
+
+      ULONG block = pIter->second;
+      eGobiError blockRC = eGOBI_ERR_NONE;
+
+      switch (evt.mEventType)
+      {
+         case ePROTOCOL_EVT_REQ_ERR:
+            // The port itself failed, retrying won't help
+            rc = eGOBI_ERR_REQUEST;
+            break;
+
+         case ePROTOCOL_EVT_RSP_ERR:
+            outstanding.erase( pIter );
+            blockRC = eGOBI_ERR_RESPONSE_TO;
+            break;
+
+         case ePROTOCOL_EVT_RSP_RECV:
+            outstanding.erase( pIter );
+            {
+               sProtocolBuffer rsp = protocolLog.GetBuffer( evt.mParam2 );
+               blockRC = CheckWriteResponse( rsp );
+            }
+            if (blockRC == eGOBI_ERR_NONE)
+            {
+               blocksDone++;
+            }
+            else if (blockRC != eGOBI_ERR_QDL_CRC)
+            {
+               // Rejected for good
+               rc = blockRC;
+            }
+            break;
+
+         default:
+            // Transmission progress
+            break;
+      }
+
+      // Retransmit a block that timed out or was NAKed?
+      if (rc == eGOBI_ERR_NONE && blockRC != eGOBI_ERR_NONE)
+      {
+         TRACE( "WriteQDLImage(), block %lu failed (%d)\n", block, blockRC );
+
+         if (attempts[block] < MAX_GOBI_QDL_WRITE_ATTEMPTS)
+         {
+            retries.push_back( block );
+         }
+         else
+         {
+            rc = blockRC;
+         }
+      }
+   }
+
+   // Remove what is still outstanding as our protocol notification 
+   // object is about to go out of scope and hence be destroyed
+   std::map <ULONG, ULONG>::const_iterator pIter = outstanding.begin();
+   while (pIter != outstanding.end())
+   {
+      mQDL.RemoveRequest( pIter->first );
+      pIter++;
+   }
+
+   if (window > 1)
+   {
+      mQDL.SetInFlightWindow( oldWindow );
+   }
+
+   return rc;
+}
+
+/*===========================================================================
+METHOD:
+   WriteQDLImageFile (Public Method)
+
+DESCRIPTION:
+   This function prepares the device boot downloader for an image write
+   and then writes the given image file, which is memory mapped so that
+   the blocks are sent straight from the mapping
+
+PARAMETERS:
+   imageType      [ I ] - Type of image being written 
+   pImageFile     [ I ] - Fully qualified path to the image file
+   window         [ I ] - Maximum number of block writes awaiting a
+                          response (see WriteQDLImage())
+  
+RETURN VALUE:
+   eGobiError - Return code
+===========================================================================*/
+eGobiError cGobiQDLCore::WriteQDLImageFile( 
+   BYTE                       imageType,
+   LPCSTR                     pImageFile,
+   ULONG                      window )
+{
+   if (pImageFile == 0 || pImageFile[0] == 0)
+   {
+      return eGOBI_ERR_INVALID_FILE;
+   }
+
+   cMemoryMappedFile imgFile( pImageFile );
+
+   const BYTE * pImage = (const BYTE *)imgFile.GetContents();
+   ULONG imageSize = imgFile.GetSize();
+   if (pImage == 0 || imageSize == 0)
+   {
+      return eGOBI_ERR_FILE_OPEN;
+   }
+
+   ULONG blockSize = QDL_MAX_CHUNK_SIZE;
+   eGobiError rc = PrepareQDLImageWrite( imageType, imageSize, &blockSize );
+   if (rc != eGOBI_ERR_NONE)
+   {
+      return rc;
+   }
+
+   return WriteQDLImage( pImage, imageSize, blockSize, window );
+}
+
+/*===========================================================================
+METHOD:
+   CheckWriteResponse (Internal Method)
+
+DESCRIPTION:
+   Check the response to an image block write
+
+PARAMETERS:
+   rsp            [ I ] - Response
+  
+RETURN VALUE:
+   eGobiError - Return code
+===========================================================================*/
+eGobiError cGobiQDLCore::CheckWriteResponse( const sProtocolBuffer & rsp )
+{
+   if (rsp.IsValid() == false)
+   {
+      return eGOBI_ERR_MALFORMED_RSP;
+   }
+
    sQDLWriteUnframed writeRsp( rsp.GetSharedBuffer() );
    const sQDLRawWriteUnframedRsp * pTmp = writeRsp.GetResponse();
    if (pTmp == 0)
@@ -748,7 +1125,7 @@ sProtocolBuffer cGobiQDLCore::SendQDL(
    }
 
    // We use the event based notification approach
-   cSyncQueue <sProtocolNotificationEvent> evts( 12, true );   
+   tProtocolNotificationQueue evts( 12, true );   
    cProtocolQueueNotification pn( &evts );
 
    // Process up to the indicated timeout
@@ -55,6 +55,9 @@ POSSIBILITY OF SUCH DAMAGE.
 // Definitions
 //---------------------------------------------------------------------------
 
+// Default number of image block writes awaiting a response at once
+extern const ULONG DEFAULT_GOBI_QDL_WRITE_WINDOW;
+
 /*=========================================================================*/
 // Class cGobiQDLCore
 /*=========================================================================*/
@@ -105,6 +108,20 @@ class cGobiQDLCore
          USHORT                     sequenceNumber,
          ULONG                      chunkSize,
          BYTE *                     pImageBlock );
+
+      // Write a prepared image to the device as a series of blocks, with
+      // up to the given number of block writes awaiting a response
+      eGobiError WriteQDLImage( 
+         const BYTE *               pImage,
+         ULONG                      imageSize,
+         ULONG                      blockSize,
+         ULONG                      window = DEFAULT_GOBI_QDL_WRITE_WINDOW );
+
+      // Prepare for and write the given (memory mapped) image file
+      eGobiError WriteQDLImageFile( 
+         BYTE                       imageType,
+         LPCSTR                     pImageFile,
+         ULONG                      window = DEFAULT_GOBI_QDL_WRITE_WINDOW );
       
       // Request the device validate the written images
       eGobiError ValidateQDLImages( BYTE * pImageType );
@@ -152,6 +169,9 @@ class cGobiQDLCore
       };
 
    protected:
+      // Check the response to an image block write
+      eGobiError CheckWriteResponse( const sProtocolBuffer & rsp );
+
       /* QDL protocol server */
       cQDLProtocolServer mQDL;
 
@@ -6,6 +6,7 @@ DESCRIPTION:
    QUALCOMM Gobi QMI Based API Core
 
 PUBLIC CLASSES AND FUNCTIONS:
+   cGobiQMIAsyncNotification
    cGobiQMICore
 
 Copyright (c) 2011, Code Aurora Forum. All rights reserved.
@@ -41,6 +42,7 @@ POSSIBILITY OF SUCH DAMAGE.
 //---------------------------------------------------------------------------
 #include "StdAfx.h"
 #include "GobiQMICore.h"
+#include "GobiDeviceManager.h"
 
 #include "QMIBuffers.h"
 #include "ProtocolNotification.h"
@@ -59,6 +61,9 @@ extern "C" {
 // Default timeout for Gobi QMI requests
 const ULONG DEFAULT_GOBI_QMI_TIMEOUT = 2000;
 
+// Invalid asynchronous send handle
+const ULONG INVALID_GOBI_SEND_HANDLE = 0;
+
 /*=========================================================================*/
 // Free Methods
 /*=========================================================================*/
@@ -78,14 +83,14 @@ RETURN VALUE:
    cDataParser::tParsedFields
 ===========================================================================*/
 sDB2NavInput FindTLV( 
-   const std::vector <sDB2NavInput> &  tlvs, 
+   const cDB2NavInputs &               tlvs, 
    const sProtocolEntityKey &          tlvKey )
 {
    sDB2NavInput retNI;
 
    // We need some TLVs to parse and a valid QMI DB key
    ULONG tlvCount = (ULONG)tlvs.size();
-   if (tlvCount == 0 || tlvKey.mKey.size() < 3)
+   if (tlvCount == 0 || tlvKey.size() < 3)
    {
       return retNI;
    }
@@ -93,7 +98,7 @@ sDB2NavInput FindTLV(
    for (ULONG t = 0; t < tlvCount; t++)
    {
       const sDB2NavInput & ni = tlvs[t];
-      if (tlvKey.mKey == ni.mKey)
+      if (tlvKey == ni.mKey)
       {
          retNI = ni;
          break;
@@ -123,7 +128,7 @@ RETURN VALUE:
 cDataParser::tParsedFields ParseTLV( 
    const cCoreDatabase &               db,
    const sProtocolBuffer &             qmiBuf,
-   const std::vector <sDB2NavInput> &  tlvs, 
+   const cDB2NavInputs &               tlvs, 
    const sProtocolEntityKey &          tlvKey,
    bool                                bFieldStrings )
 {
@@ -131,7 +136,7 @@ cDataParser::tParsedFields ParseTLV(
    
    // We need some TLVs to parse and a valid QMI DB key
    ULONG tlvCount = (ULONG)tlvs.size();
-   if (tlvCount == 0 || tlvKey.mKey.size() < 3)
+   if (tlvCount == 0 || tlvKey.size() < 3)
    {
       return retFields;
    }
@@ -139,12 +144,12 @@ cDataParser::tParsedFields ParseTLV(
    for (ULONG t = 0; t < tlvCount; t++)
    {
       const sDB2NavInput & ni = tlvs[t];
-      if (tlvKey.mKey == ni.mKey)
+      if (tlvKey == ni.mKey)
       {
          cDataParser dp( db, qmiBuf, tlvKey, ni.mpPayload, ni.mPayloadLen );
          dp.Parse( bFieldStrings, false );
 
-         retFields = dp.GetFields();
+         dp.TakeFields( retFields );
          break;
       }
    }
@@ -152,6 +157,228 @@ cDataParser::tParsedFields ParseTLV(
    return retFields;
 }
 
+/*===========================================================================
+METHOD:
+   ParseTLVValues (Free Method)
+
+DESCRIPTION:
+   Parse the given TLV to raw field values, stored in the caller supplied
+   array (no field names or value strings are generated)
+
+PARAMETERS:
+   db             [ I ] - Database to use
+   qmiBuf         [ I ] - Original buffer containing TLV (locks data)
+   tlvs           [ I ] - TLV parsing input vector
+   tlvKey         [ I ] - Key of the TLV that is to be parsed
+   pValues        [ O ] - Array to receive the raw field values
+   maxValues      [ I ] - Number of entries in the above array
+
+RETURN VALUE:
+   ULONG - Number of raw field values stored (0 upon failure)
+===========================================================================*/
+ULONG ParseTLVValues( 
+   const cCoreDatabase &               db,
+   const sProtocolBuffer &             qmiBuf,
+   const cDB2NavInputs &               tlvs, 
+   const sProtocolEntityKey &          tlvKey,
+   sParsedFieldValue *                 pValues,
+   ULONG                               maxValues )
+{
+   ULONG numValues = 0;
+   
+   // We need some TLVs to parse and a valid QMI DB key
+   ULONG tlvCount = (ULONG)tlvs.size();
+   if (tlvCount == 0 || tlvKey.size() < 3)
+   {
+      return numValues;
+   }
+   
+   for (ULONG t = 0; t < tlvCount; t++)
+   {
+      const sDB2NavInput & ni = tlvs[t];
+      if (tlvKey == ni.mKey)
+      {
+         cDataParser dp( db, qmiBuf, tlvKey, ni.mpPayload, ni.mPayloadLen );
+         bool bOK = dp.ParseValues( pValues, maxValues, numValues );
+         if (bOK == false)
+         {
+            numValues = 0;
+         }
+
+         break;
+      }
+   }
+
+   return numValues;
+}
+
+/*=========================================================================*/
+// cGobiQMIAsyncNotification Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   Notify (Public Method)
+
+DESCRIPTION:
+   Pass a protocol event on to the core object that issued the request
+
+PARAMETERS:
+   eventType   [ I ] - Event type
+   param1      [ I ] - Event type specific argument (see header description)
+   param2      [ I ] - Event type specific argument (see header description)
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiQMIAsyncNotification::Notify(
+   eProtocolEventType         eventType,
+   DWORD                      param1,
+   DWORD                      param2 ) const
+{
+   if (mpCore != 0)
+   {
+      mpCore->AsyncSendEvent( mHandle, eventType, param1, param2 );
+   }
+}
+
+/*=========================================================================*/
+// cGobiQMIResponseCollector Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   cGobiQMIResponseCollector (Public Method)
+
+DESCRIPTION:
+   Constructor
+
+RETURN VALUE:
+   None
+===========================================================================*/
+cGobiQMIResponseCollector::cGobiQMIResponseCollector()
+   :  mResponses()
+{
+   pthread_mutex_init( &mMutex, NULL );
+   pthread_cond_init( &mCond, NULL );
+}
+
+/*===========================================================================
+METHOD:
+   ~cGobiQMIResponseCollector (Public Method)
+
+DESCRIPTION:
+   Destructor
+
+RETURN VALUE:
+   None
+===========================================================================*/
+cGobiQMIResponseCollector::~cGobiQMIResponseCollector()
+{
+   pthread_cond_destroy( &mCond );
+   pthread_mutex_destroy( &mMutex );
+}
+
+/*===========================================================================
+METHOD:
+   Wait (Public Method)
+
+DESCRIPTION:
+   Wait for the requests with the given handles to complete (requests are
+   always completed, be it by a response, an error or a timeout)
+
+PARAMETERS:
+   handles     [ I ] - Handle of each request (INVALID_GOBI_SEND_HANDLE
+                       for a request that was not scheduled)
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiQMIResponseCollector::Wait( const std::vector <ULONG> & handles )
+{
+   pthread_mutex_lock( &mMutex );
+
+   ULONG reqCount = (ULONG)handles.size();
+   for (ULONG r = 0; r < reqCount; r++)
+   {
+      if (handles[r] == INVALID_GOBI_SEND_HANDLE)
+      {
+         continue;
+      }
+
+      while (mResponses.find( handles[r] ) == mResponses.end())
+      {
+         pthread_cond_wait( &mCond, &mMutex );
+      }
+   }
+
+   pthread_mutex_unlock( &mMutex );
+}
+
+/*===========================================================================
+METHOD:
+   GetResponse (Public Method)
+
+DESCRIPTION:
+   Return the outcome of the request with the given handle
+
+PARAMETERS:
+   handle      [ I ] - Handle of the request
+   rsp         [ O ] - Response (only valid when eGOBI_ERR_NONE is returned)
+
+RETURN VALUE:
+   eGobiError - Outcome of the request (eGOBI_ERR_REQ_SCHEDULE if it was
+                not scheduled or has not completed)
+===========================================================================*/
+eGobiError cGobiQMIResponseCollector::GetResponse(
+   ULONG                      handle,
+   sProtocolBuffer &          rsp )
+{
+   eGobiError ec = eGOBI_ERR_REQ_SCHEDULE;
+
+   pthread_mutex_lock( &mMutex );
+
+   std::map <ULONG, std::pair <eGobiError, sProtocolBuffer> >::iterator 
+      pIter = mResponses.find( handle );
+   if (pIter != mResponses.end())
+   {
+      ec = pIter->second.first;
+      rsp = pIter->second.second;
+   }
+
+   pthread_mutex_unlock( &mMutex );
+   return ec;
+}
+
+/*===========================================================================
+METHOD:
+   SendComplete (Public Method)
+
+DESCRIPTION:
+   A request has completed, keep the outcome
+
+PARAMETERS:
+   handle      [ I ] - Handle of the request
+   ec          [ I ] - Error
+   rsp         [ I ] - Response (only valid when the error is 
+                       eGOBI_ERR_NONE)
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiQMIResponseCollector::SendComplete(
+   ULONG                      handle,
+   eGobiError                 ec,
+   const sProtocolBuffer &    rsp )
+{
+   pthread_mutex_lock( &mMutex );
+
+   mResponses[handle] = std::pair <eGobiError, sProtocolBuffer>( ec, rsp );
+   pthread_cond_broadcast( &mCond );
+
+   pthread_mutex_unlock( &mMutex );
+}
+
 /*=========================================================================*/
 // cGobiQMICore Methods
 /*=========================================================================*/
@@ -167,15 +394,80 @@ RETURN VALUE:
    None
 ===========================================================================*/
 cGobiQMICore::cGobiQMICore()
-   :  mbFailOnMultipleDevices( false ),
+   :  mpDB( &mDB ),
+      mpManager( 0 ),
+      mpManagerExecutor( 0 ),
+      mpServices( 0 ),
+      mServiceIDs(),
+      mOnDemandServers(),
+      mControlFile( "" ),
+      mMEID( "" ),
+      mReaperThreadID( 0 ),
+      mReaperExitEvent(),
+      mbFailOnMultipleDevices( false ),
       mDeviceNode( "" ),
       mDeviceKey( "" ),
       mLastError( eGOBI_ERR_NONE ),
-      mRequests( 16 ),
+      mRequests(),
       mLastNetStartID( (WORD)INVALID_QMI_TRANSACTION_ID ),
-      mVid(0xBAADBEEF), mPid(0xCAFEBABE)
+      mVid(0xBAADBEEF), mPid(0xCAFEBABE),
+      mLastAsyncHandle( INVALID_GOBI_SEND_HANDLE ),
+      mpSendExecutor( 0 ),
+      mStatsDumpInterval( 0 ),
+      mbAdaptiveTimeouts( false ),
+      mThreadConfig(),
+      mStartupTimes(),
+      mbResponseCache( true ),
+      mCacheTTLs(),
+      mCacheInvalidations(),
+      mResponseCache(),
+      mCacheScanned()
 {
-   // Nothing to do
+   pthread_mutex_init( &mAsyncMutex, NULL );
+   pthread_mutex_init( &mServerMutex, NULL );
+   pthread_mutex_init( &mCacheMutex, NULL );
+   pthread_cond_init( &mCacheCond, NULL );
+   pthread_mutex_init( &mRequestsMutex, NULL );
+
+   // Allocate the (cache line aligned) service table
+   PVOID pTable = 0;
+   ULONG tableSz = QMI_SERVICE_TABLE_SZ 
+                 * (ULONG)sizeof( sGobiQMIServiceEntry );
+   if (posix_memalign( &pTable, 64, tableSz ) == 0)
+   {
+      memset( pTable, 0, tableSz );
+      mpServices = (sGobiQMIServiceEntry *)pTable;
+   }
+
+   // Device information doesn't change while connected (bar the IMSI
+   // upon a SIM change, which the DMS event report announces)
+   const ULONG DEVICE_INFO_TTL = 60000;
+   SetResponseCacheTTL( eQMI_SVC_DMS, eQMI_DMS_GET_CAPS, DEVICE_INFO_TTL );
+   SetResponseCacheTTL( eQMI_SVC_DMS, eQMI_DMS_GET_MANUFACTURER, DEVICE_INFO_TTL );
+   SetResponseCacheTTL( eQMI_SVC_DMS, eQMI_DMS_GET_MODEL_ID, DEVICE_INFO_TTL );
+   SetResponseCacheTTL( eQMI_SVC_DMS, eQMI_DMS_GET_REV_ID, DEVICE_INFO_TTL );
+   SetResponseCacheTTL( eQMI_SVC_DMS, eQMI_DMS_GET_IDS, DEVICE_INFO_TTL );
+   SetResponseCacheTTL( eQMI_SVC_DMS, eQMI_DMS_GET_MSM_ID, DEVICE_INFO_TTL );
+   SetResponseCacheTTL( eQMI_SVC_DMS, eQMI_DMS_GET_IMSI, DEVICE_INFO_TTL );
+   SetResponseCacheTTL( eQMI_SVC_DMS, eQMI_DMS_GET_PRL_VERSION, DEVICE_INFO_TTL );
+   AddResponseCacheInvalidation( eQMI_SVC_DMS, 
+                                 eQMI_DMS_EVENT_IND, 
+                                 eQMI_SVC_DMS, 
+                                 eQMI_DMS_GET_IMSI );
+
+   // Network information is served briefly, and dropped as soon as the
+   // serving system indication announces a change
+   const ULONG NETWORK_INFO_TTL = 1000;
+   SetResponseCacheTTL( eQMI_SVC_NAS, eQMI_NAS_GET_SS_INFO, NETWORK_INFO_TTL );
+   SetResponseCacheTTL( eQMI_SVC_NAS, eQMI_NAS_GET_HOME_INFO, NETWORK_INFO_TTL );
+   AddResponseCacheInvalidation( eQMI_SVC_NAS, 
+                                 eQMI_NAS_SS_INFO_IND,
+                                 eQMI_SVC_NAS, 
+                                 eQMI_NAS_GET_SS_INFO );
+   AddResponseCacheInvalidation( eQMI_SVC_NAS, 
+                                 eQMI_NAS_SS_INFO_IND,
+                                 eQMI_SVC_NAS, 
+                                 eQMI_NAS_GET_HOME_INFO );
 }
 
 /*===========================================================================
@@ -191,6 +483,18 @@ RETURN VALUE:
 cGobiQMICore::~cGobiQMICore()
 {
    Cleanup();
+
+   if (mpServices != 0)
+   {
+      free( mpServices );
+      mpServices = 0;
+   }
+
+   pthread_mutex_destroy( &mAsyncMutex );
+   pthread_mutex_destroy( &mServerMutex );
+   pthread_cond_destroy( &mCacheCond );
+   pthread_mutex_destroy( &mCacheMutex );
+   pthread_mutex_destroy( &mRequestsMutex );
 }
 
 /*===========================================================================
@@ -205,16 +509,63 @@ RETURN VALUE:
 ===========================================================================*/
 bool cGobiQMICore::Initialize()
 {
-   // Initialize database
-   mDB.Initialize();
+   if (mpManager != 0)
+   {
+      // Use the shared database, asynchronous send completions are run
+      // on the worker pool of the manager
+      if (mpManagerExecutor == 0)
+      {
+         mpManagerExecutor = mpManager->Attach( this );
+         if (mpManagerExecutor == 0)
+         {
+            return false;
+         }
+      }
+
+      mpDB = &mpManager->GetDatabase();
+   }
+   else
+   {
+      // Initialize database
+      mpDB = &mDB;
+      mDB.Initialize();
+
+      // Start the asynchronous send completion thread
+      if (mSendExecutor.Initialize() == false)
+      {
+         return false;
+      }
+   }
    
+   if (mpServices == 0)
+   {
+      return false;
+   }
+
    // Allocate configured QMI servers
    bool bOK = true;
    std::set <tServerConfig>::const_iterator pIter = mServerConfig.begin();
    while (pIter != mServerConfig.end())
    {
+      eQMIService svc = pIter->first;
+      if ((ULONG)svc >= QMI_SERVICE_TABLE_SZ)
+      {
+         pIter++;
+         continue;
+      }
+
+      sGobiQMIServiceEntry & entry = mpServices[svc];
+      if (entry.mpServer != 0)
+      {
+         // Configured twice
+         entry.mbRequired |= pIter->second;
+
+         pIter++;
+         continue;
+      }
+
       cQMIProtocolServer * pSvr = 0;
-      pSvr = new cQMIProtocolServer( pIter->first, 8192, 512 );
+      pSvr = new cQMIProtocolServer( svc, 8192, 512 );
       if (pSvr == 0)
       {
          if (pIter->second == true)
@@ -225,7 +576,24 @@ bool cGobiQMICore::Initialize()
       }
       else
       {
-         mServers[pIter->first] = pSvr;
+         const cProtocolLog & log = pSvr->GetLog();
+
+         entry.mpServer = pSvr;
+         entry.mpLog = &log;
+         entry.mpSignalEvent = &log.GetSignalEvent();
+         entry.mRxType = MapQMIServiceToProtocol( svc, false );
+         entry.mTxType = MapQMIServiceToProtocol( svc, true );
+         entry.mbRequired = pIter->second;
+
+         std::map <eQMIService, ULONG>::const_iterator pOnDemand;
+         pOnDemand = mOnDemandServers.find( svc );
+         if (pOnDemand != mOnDemandServers.end())
+         {
+            entry.mbOnDemand = true;
+            entry.mIdleTimeout = pOnDemand->second;
+         }
+
+         mServiceIDs.push_back( svc );
       }
   
       pIter++;
@@ -253,93 +621,381 @@ bool cGobiQMICore::Cleanup()
 {
    Disconnect();
 
-   // Free allocated QMI servers
-   std::map <eQMIService, cQMIProtocolServer *>::const_iterator pIter;
-   pIter = mServers.begin();
+   // Run any remaining asynchronous send completions
+   if (mpManagerExecutor != 0)
+   {
+      mpManager->Detach( this, mpManagerExecutor );
+      mpManagerExecutor = 0;
+   }
+   else
+   {
+      mSendExecutor.Exit();
+   }
 
-   while (pIter != mServers.end())
+   // Free allocated QMI servers
+   ULONG svcCount = (ULONG)mServiceIDs.size();
+   for (ULONG s = 0; s < svcCount; s++)
    {
-      cQMIProtocolServer * pSvr = pIter->second;
-      if (pSvr != 0)
+      sGobiQMIServiceEntry & entry = mpServices[mServiceIDs[s]];
+      if (entry.mpServer != 0)
       {
-         delete pSvr;
+         delete entry.mpServer;
       }
 
-      pIter++;
+      memset( &entry, 0, sizeof( entry ) );
    }
 
-   mServers.clear();
+   mServiceIDs.clear();
 
    return true;
 }
 
-GobiType cGobiQMICore::GetDeviceType()
+/*===========================================================================
+METHOD:
+   GetServiceStats (Public Method)
+
+DESCRIPTION:
+   Return the request counters of the given service type
+
+PARAMETERS:
+   svc         [ I ] - QMI service type
+
+RETURN VALUE:
+   sGobiQMIServiceStats - Counters (zero if the service is not configured)
+===========================================================================*/
+sGobiQMIServiceStats cGobiQMICore::GetServiceStats( eQMIService svc )
 {
-   return ::GetDeviceType(mVid, mPid);
+   sGobiQMIServiceStats stats;
+   memset( &stats, 0, sizeof( stats ) );
+
+   sGobiQMIServiceEntry * pEntry = GetServiceEntry( svc );
+   if (pEntry != 0)
+   {
+      stats.mRequests = __sync_fetch_and_add( &pEntry->mStats.mRequests, 0 );
+      stats.mFailures = __sync_fetch_and_add( &pEntry->mStats.mFailures, 0 );
+      stats.mTimeouts = __sync_fetch_and_add( &pEntry->mStats.mTimeouts, 0 );
+   }
+
+   return stats;
 }
 
 /*===========================================================================
 METHOD:
-   GetAvailableDevices (Public Method)
+   GetStatistics (Public Method)
 
 DESCRIPTION:
-   Return the set of available Gobi network devices
+   Return the per-message request statistics (counters and latency 
+   percentiles) of the given service type
+
+PARAMETERS:
+   svc         [ I ] - QMI service type
+   stats       [ O ] - Statistics of every message ID seen, by message ID
 
 RETURN VALUE:
-   std::vector <tDeviceID> - Vector of device ID and device key pairs
+   bool
 ===========================================================================*/
-std::vector <cGobiQMICore::tDeviceID>
-cGobiQMICore::GetAvailableDevices()
+bool cGobiQMICore::GetStatistics( 
+   eQMIService                            svc,
+   std::vector <sProtocolMessageStats> &  stats )
 {
-   std::vector <tDeviceID> devices;
-
-   std::string path = "/sys/bus/usb/devices/";
-   char buf[PATH_MAX];
-   char *s;
+   stats.clear();
 
-   glob_t files;
-   int ret = glob( (path + "*/*/*/qcqmi*").c_str(), 
-                   0, 
-                   NULL, 
-                   &files );
-   if (ret != 0)
+   cQMIProtocolServer * pSvr = GetServer( svc );
+   if (pSvr == 0)
    {
-      // Glob failure
-      return devices;
+      return false;
    }
 
-   for (int i = 0; i < files.gl_pathc; i++)
-   {
-      // Example "/sys/bus/usb/devices/8-1/8-1:1.0/GobiQMI/qcqmi0"
-      std::string nodePath = files.gl_pathv[i];
-      
-      int lastSlash = nodePath.find_last_of( "/" );
+   stats = pSvr->GetStatistics().GetStatistics();
+   return true;
+}
 
-      // This is what we want to return if everything else matches
-      std::string deviceNode = nodePath.substr( lastSlash + 1 );
+/*===========================================================================
+METHOD:
+   GetQueueDepths (Public Method)
 
-      // Move down two directories to the interface level
-      std::string curPath = nodePath.substr( 0, lastSlash );
-      curPath = curPath.substr( 0, curPath.find_last_of( "/" ) );
+DESCRIPTION:
+   Return the number of requests waiting to be sent at each priority of 
+   the given service type and how many of those are already due
 
-      // Read bInterfaceNumber
-      int handle = open( (curPath + "/bInterfaceNumber").c_str(), 
-                         O_RDONLY );
-      if (handle == -1)
-      {
-         continue;
-      }
+PARAMETERS:
+   svc         [ I ] - QMI service type
+   pending     [ O ] - Requests waiting, indexed by eProtocolPriority
+   due         [ O ] - Of those the requests due, same indexing
 
-      char buff[4];
-      memset( buff, 0, 4 );
-      
-      bool bFound = false;
-      ret = read( handle, buff, 2 );
-      if (ret == 2)
-      {
-         ret = strncmp( buff, "00", 2 );
-         if (ret == 0)
-         {
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cGobiQMICore::GetQueueDepths( 
+   eQMIService                svc,
+   std::vector <ULONG> &      pending,
+   std::vector <ULONG> &      due )
+{
+   pending.clear();
+   due.clear();
+
+   cQMIProtocolServer * pSvr = GetServer( svc );
+   if (pSvr == 0)
+   {
+      return false;
+   }
+
+   return pSvr->GetQueueDepths( pending, due );
+}
+
+/*===========================================================================
+METHOD:
+   SetStatisticsDump (Public Method)
+
+DESCRIPTION:
+   Log the request statistics of every service to syslog at the given 
+   interval, applies to the current servers and any created later
+
+PARAMETERS:
+   interval    [ I ] - Interval in milliseconds (0 to stop logging)
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiQMICore::SetStatisticsDump( ULONG interval )
+{
+   mStatsDumpInterval = interval;
+
+   ULONG svcCount = (ULONG)mServiceIDs.size();
+   for (ULONG s = 0; s < svcCount; s++)
+   {
+      cQMIProtocolServer * pSvr = mpServices[mServiceIDs[s]].mpServer;
+      if (pSvr != 0)
+      {
+         pSvr->SetStatisticsDump( interval );
+      }
+   }
+}
+
+/*===========================================================================
+METHOD:
+   SetAdaptiveTimeouts (Public Method)
+
+DESCRIPTION:
+   Enable or disable adaptive response timeouts on every service, applies
+   to the current servers and any created later
+
+PARAMETERS:
+   bAdaptive   [ I ] - Enable adaptive timeouts?
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiQMICore::SetAdaptiveTimeouts( bool bAdaptive )
+{
+   mbAdaptiveTimeouts = bAdaptive;
+
+   ULONG svcCount = (ULONG)mServiceIDs.size();
+   for (ULONG s = 0; s < svcCount; s++)
+   {
+      cQMIProtocolServer * pSvr = mpServices[mServiceIDs[s]].mpServer;
+      if (pSvr != 0)
+      {
+         pSvr->SetAdaptiveTimeouts( bAdaptive );
+      }
+   }
+}
+
+/*===========================================================================
+METHOD:
+   SetThreadConfig (Public Method)
+
+DESCRIPTION:
+   Set the CPU affinity, scheduling class and name of the threads started
+   for this object by role, servers (and their receive completions) pick 
+   up the configuration when next connected, the asynchronous send 
+   completion thread when next initialized
+
+PARAMETERS:
+   config      [ I ] - Thread configuration
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiQMICore::SetThreadConfig( const cThreadConfig & config )
+{
+   mThreadConfig = config;
+   mThreadConfig.SetDevice( mDeviceNode );
+
+   mSendExecutor.SetThreadConfig( config );
+}
+
+/*===========================================================================
+METHOD:
+   SetServerOnDemand (Public Method)
+
+DESCRIPTION:
+   Bring the server of the given service up on the first request made on 
+   it rather than on Connect(), and take it down again once it has been 
+   idle for the given time
+
+   The server object (and so its protocol log) is still allocated by
+   Initialize(), only its schedule thread and device connection are on 
+   demand; a required on-demand service that cannot be brought up fails
+   its requests rather than Connect()
+
+PARAMETERS:
+   svc         [ I ] - QMI service type
+   bOnDemand   [ I ] - Bring the server up on demand?
+   idleTimeout [ I ] - Idle time after which the server is taken down 
+                       (milliseconds, 0 to keep it up once started)
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiQMICore::SetServerOnDemand( 
+   eQMIService                svc,
+   bool                       bOnDemand,
+   ULONG                      idleTimeout )
+{
+   if (bOnDemand == true)
+   {
+      mOnDemandServers[svc] = idleTimeout;
+   }
+   else
+   {
+      mOnDemandServers.erase( svc );
+      idleTimeout = 0;
+   }
+
+   // Already initialized?
+   if ((ULONG)svc < QMI_SERVICE_TABLE_SZ && mpServices != 0)
+   {
+      sGobiQMIServiceEntry & entry = mpServices[svc];
+      if (entry.mpServer != 0)
+      {
+         entry.mbOnDemand = bOnDemand;
+         entry.mIdleTimeout = idleTimeout;
+      }
+   }
+}
+
+GobiType cGobiQMICore::GetDeviceType()
+{
+   return ::GetDeviceType(mVid, mPid);
+}
+
+/*===========================================================================
+METHOD:
+   GetAvailableDevices (Public Method)
+
+DESCRIPTION:
+   Return the set of available Gobi network devices (as last enumerated
+   by the device manager, when one is set)
+
+RETURN VALUE:
+   std::vector <tDeviceID> - Vector of device ID and device key pairs
+===========================================================================*/
+std::vector <cGobiQMICore::tDeviceID>
+cGobiQMICore::GetAvailableDevices()
+{
+   if (mpManager != 0)
+   {
+      return mpManager->GetAvailableDevices();
+   }
+
+   return EnumerateDevices();
+}
+
+/*===========================================================================
+METHOD:
+   EnumerateDevices (Static Public Method)
+
+DESCRIPTION:
+   Enumerate the Gobi network devices present on the system
+
+RETURN VALUE:
+   std::vector <tDeviceID> - Vector of device ID and device key pairs
+===========================================================================*/
+std::vector <cGobiQMICore::tDeviceID>
+cGobiQMICore::EnumerateDevices()
+{
+   std::vector <tDeviceID> devices;
+
+   std::vector <std::string> nodes = EnumerateDeviceNodes();
+   for (ULONG n = 0; n < (ULONG)nodes.size(); n++)
+   {
+      // Get MEID of device node (via ioctl) to use as key
+      std::string deviceStr = "/dev/" + nodes[n];
+      std::string key = cQMIProtocolServer::GetDeviceMEID( deviceStr );
+
+      tDeviceID device;
+      device.first = nodes[n];
+      device.second = key;
+
+      devices.push_back( device );
+   }
+
+   return devices;
+}
+
+/*===========================================================================
+METHOD:
+   EnumerateDeviceNodes (Static Public Method)
+
+DESCRIPTION:
+   Enumerate the device nodes of the Gobi network devices present on the
+   system, this only looks at sysfs (the devices are not queried)
+
+RETURN VALUE:
+   std::vector <std::string> - Device nodes (IE: qcqmi0)
+===========================================================================*/
+std::vector <std::string> cGobiQMICore::EnumerateDeviceNodes()
+{
+   std::vector <std::string> devices;
+
+   std::string path = "/sys/bus/usb/devices/";
+   char buf[PATH_MAX];
+   char *s;
+
+   glob_t files;
+   int ret = glob( (path + "*/*/*/qcqmi*").c_str(), 
+                   0, 
+                   NULL, 
+                   &files );
+   if (ret != 0)
+   {
+      // Glob failure
+      return devices;
+   }
+
+   for (int i = 0; i < files.gl_pathc; i++)
+   {
+      // Example "/sys/bus/usb/devices/8-1/8-1:1.0/GobiQMI/qcqmi0"
+      std::string nodePath = files.gl_pathv[i];
+      
+      int lastSlash = nodePath.find_last_of( "/" );
+
+      // This is what we want to return if everything else matches
+      std::string deviceNode = nodePath.substr( lastSlash + 1 );
+
+      // Move down two directories to the interface level
+      std::string curPath = nodePath.substr( 0, lastSlash );
+      curPath = curPath.substr( 0, curPath.find_last_of( "/" ) );
+
+      // Read bInterfaceNumber
+      int handle = open( (curPath + "/bInterfaceNumber").c_str(), 
+                         O_RDONLY );
+      if (handle == -1)
+      {
+         continue;
+      }
+
+      char buff[4];
+      memset( buff, 0, 4 );
+      
+      bool bFound = false;
+      ret = read( handle, buff, 2 );
+      if (ret == 2)
+      {
+         ret = strncmp( buff, "00", 2 );
+         if (ret == 0)
+         {
             bFound = true;
          }
 
@@ -367,16 +1023,7 @@ cGobiQMICore::GetAvailableDevices()
          continue;
 
       // Device node success!
-
-      // Get MEID of device node (via ioctl) to use as key
-      std::string deviceStr = "/dev/" + deviceNode;
-      std::string key = cQMIProtocolServer::GetDeviceMEID( deviceStr );
-
-      tDeviceID device;
-      device.first = deviceNode;
-      device.second = key;
-
-      devices.push_back( device );
+      devices.push_back( deviceNode );
    }
    globfree( &files );
 
@@ -443,6 +1090,8 @@ bool cGobiQMICore::Connect(
    // Assume failure
    bool bRC = false;
 
+   ULONGLONG connectTime = GetMicroTickCount();
+
    // Clear last error recorded
    ClearLastError();
 
@@ -517,44 +1166,123 @@ bool cGobiQMICore::Connect(
    // Store device ID/key strings
    mDeviceNode = devices[0].first;
    mDeviceKey = devices[0].second;
+   mThreadConfig.SetDevice( mDeviceNode );
 
    unsigned int vidpid = getvidpid(mDeviceNode.c_str());
    mVid = (vidpid >> 16) & 0xFFFF;
    mPid = vidpid & 0xFFFF;
 
-   // Initalize/connect all configured QMI servers
-   std::map <eQMIService, cQMIProtocolServer *>::const_iterator pIter;
-   pIter = mServers.begin();
+   // Initalize/connect all configured QMI servers, each on its own
+   // thread (server startup is dominated by thread creation and driver
+   // ioctls, none of which depend on the other servers)
+   ULONGLONG startTime = GetMicroTickCount();
+   std::string deviceStr = "/dev/" + mDeviceNode;
+
+   // The MEID is a property of the device, read it just the once
+   std::string meid = cQMIProtocolServer::GetDeviceMEID( deviceStr );
+   ULONGLONG meidTime = GetMicroTickCount();
 
-   while (pIter != mServers.end())
+   // ... and so are the on-demand servers, later on
+   mControlFile = deviceStr;
+   mMEID = meid;
+
+   ULONG svcCount = (ULONG)mServiceIDs.size();
+   std::vector <sServerStartup> items( svcCount );
+   for (ULONG s = 0; s < svcCount; s++)
    {
-      cQMIProtocolServer * pSvr = pIter->second;
-      if (pSvr != 0)
+      const sGobiQMIServiceEntry & entry = mpServices[mServiceIDs[s]];
+
+      sServerStartup & item = items[s];
+      item.mpServer = entry.mpServer;
+      item.mpControlFile = &deviceStr;
+      item.mpMEID = &meid;
+      item.mStatsDumpInterval = mStatsDumpInterval;
+      item.mbAdaptiveTimeouts = mbAdaptiveTimeouts;
+      item.mpThreadConfig = &mThreadConfig;
+      item.mThreadID = 0;
+      item.mResult.mService = mServiceIDs[s];
+      item.mResult.mInitializeTime = 0;
+      item.mResult.mConnectTime = 0;
+      item.mResult.mbConnected = false;
+
+      // Receive through the shared reactor?
+      if (item.mpServer != 0 && mpManager != 0)
       {
-         // Initialize server (we don't care about the return code
-         // since the following Connect() call will fail if we are
-         // unable to initialize the server)
-         pSvr->Initialize();
-
-         std::string deviceStr = "/dev/" + mDeviceNode;
-         bRC = pSvr->Connect( deviceStr.c_str() );
-         if (bRC == false)
-         {
-            tServerConfig tsc( pIter->first, true );
-            if (mServerConfig.find( tsc ) != mServerConfig.end())
-            {
-               // Failure on essential server
-               break;
-            }
-            else
-            {
-               // QMI server non-essential (ignore failure)
-               bRC = true;
-            }
-         }
+         item.mpServer->SetCommReactor( mpManager->GetCommReactor() );
       }
 
-      pIter++;
+      // On-demand servers are brought up by their first request
+      if (entry.mbOnDemand == true)
+      {
+         item.mpServer = 0;
+      }
+   }
+
+   for (ULONG s = 0; s < svcCount; s++)
+   {
+      sServerStartup & item = items[s];
+      if (item.mpServer == 0)
+      {
+         continue;
+      }
+
+      int nRet = mThreadConfig.CreateThread( eTHREAD_ROLE_WORKER,
+                                             &item.mThreadID, 
+                                             StartServer,
+                                             &item );
+      if (nRet != 0)
+      {
+         // Unable to create a startup thread, so do the work here
+         item.mThreadID = 0;
+         StartServer( &item );
+      }
+   }
+
+   // Wait for every server, then evaluate them in service order
+   bRC = true;
+   mStartupTimes.mServices.clear();
+   for (ULONG s = 0; s < svcCount; s++)
+   {
+      sServerStartup & item = items[s];
+      if (item.mpServer == 0)
+      {
+         continue;
+      }
+
+      if (item.mThreadID != 0)
+      {
+         pthread_join( item.mThreadID, NULL );
+      }
+
+      mStartupTimes.mServices.push_back( item.mResult );
+
+      const sGobiQMIServiceEntry & entry = mpServices[mServiceIDs[s]];
+      if (item.mResult.mbConnected == false && entry.mbRequired == true)
+      {
+         // Failure on essential server (non-essential failures are
+         // ignored)
+         bRC = false;
+      }
+   }
+
+   ULONGLONG endTime = GetMicroTickCount();
+   mStartupTimes.mMEIDTime = (ULONG)(meidTime - startTime);
+   mStartupTimes.mServersTime = (ULONG)(endTime - meidTime);
+   mStartupTimes.mTotalTime = (ULONG)(endTime - connectTime);
+
+   TRACE( "Connect(), %s up in %lu us (MEID %lu us, servers %lu us)\n",
+          mDeviceNode.c_str(),
+          mStartupTimes.mTotalTime,
+          mStartupTimes.mMEIDTime,
+          mStartupTimes.mServersTime );
+
+   for (ULONG s = 0; s < (ULONG)mStartupTimes.mServices.size(); s++)
+   {
+      TRACE( "   service %d: initialize %lu us, connect %lu us%s\n",
+             (int)mStartupTimes.mServices[s].mService,
+             mStartupTimes.mServices[s].mInitializeTime,
+             mStartupTimes.mServices[s].mConnectTime,
+             mStartupTimes.mServices[s].mbConnected == true ? "" : " (failed)" );
    }
 
    // Any server fail?
@@ -565,6 +1293,29 @@ bool cGobiQMICore::Connect(
 
       // ... and set the error code
       mLastError = eGOBI_ERR_CONNECT;
+      return bRC;
+   }
+
+   // Take down idle on-demand servers?
+   for (ULONG s = 0; s < svcCount; s++)
+   {
+      const sGobiQMIServiceEntry & entry = mpServices[mServiceIDs[s]];
+      if (entry.mbOnDemand == true && entry.mIdleTimeout > 0)
+      {
+         mReaperExitEvent.Clear();
+
+         int nRet = mThreadConfig.CreateThread( eTHREAD_ROLE_WORKER,
+                                                &mReaperThreadID, 
+                                                ReaperThread,
+                                                this );
+         if (nRet != 0)
+         {
+            // Servers will just be kept up
+            mReaperThreadID = 0;
+         }
+
+         break;
+      }
    }
 
    return bRC;
@@ -572,7 +1323,292 @@ bool cGobiQMICore::Connect(
 
 /*===========================================================================
 METHOD:
-   Disconnect (Public Method)
+   StartServer (Static Internal Method)
+
+DESCRIPTION:
+   Initialize and connect a single server, timing both steps
+
+PARAMETERS:
+   pData       [ I ] - Server startup work item (sServerStartup)
+  
+RETURN VALUE:
+   void * - always NULL
+===========================================================================*/
+void * cGobiQMICore::StartServer( void * pData )
+{
+   sServerStartup * pItem = (sServerStartup *)pData;
+   cQMIProtocolServer * pSvr = pItem->mpServer;
+
+   ULONGLONG t0 = GetMicroTickCount();
+
+   // The schedule thread is started by Initialize()
+   pSvr->SetThreadConfig( *pItem->mpThreadConfig );
+
+   // Initialize server (we don't care about the return code
+   // since the following Connect() call will fail if we are
+   // unable to initialize the server)
+   pSvr->Initialize();
+
+   if (pItem->mStatsDumpInterval > 0)
+   {
+      pSvr->SetStatisticsDump( pItem->mStatsDumpInterval );
+   }
+
+   if (pItem->mbAdaptiveTimeouts == true)
+   {
+      pSvr->SetAdaptiveTimeouts( true );
+   }
+
+   ULONGLONG t1 = GetMicroTickCount();
+
+   bool bRC = pSvr->Connect( pItem->mpControlFile->c_str(), 
+                             *pItem->mpMEID );
+
+   ULONGLONG t2 = GetMicroTickCount();
+
+   pItem->mResult.mInitializeTime = (ULONG)(t1 - t0);
+   pItem->mResult.mConnectTime = (ULONG)(t2 - t1);
+   pItem->mResult.mbConnected = bRC;
+
+   return NULL;
+}
+
+/*===========================================================================
+METHOD:
+   AcquireServer (Internal Method)
+
+DESCRIPTION:
+   Return the service table entry of the given service type with the 
+   server up, an on-demand server is brought up if needed, the server is
+   then held up until ReleaseServer() is called
+
+PARAMETERS:
+   svc         [ I ] - QMI service type
+
+RETURN VALUE:
+   sGobiQMIServiceEntry * - The entry (0 if the service is not configured)
+===========================================================================*/
+sGobiQMIServiceEntry * cGobiQMICore::AcquireServer( eQMIService svc )
+{
+   sGobiQMIServiceEntry * pEntry = GetServiceEntry( svc );
+   if (pEntry == 0)
+   {
+      return 0;
+   }
+
+   __sync_fetch_and_add( &pEntry->mUsers, 1 );
+   if (pEntry->mbOnDemand == false)
+   {
+      return pEntry;
+   }
+
+   pEntry->mLastUse = GetTickCount();
+
+   pthread_mutex_lock( &mServerMutex );
+
+   if (pEntry->mbStarted == false && mControlFile.size() > 0)
+   {
+      sServerStartup item;
+      item.mpServer = pEntry->mpServer;
+      item.mpControlFile = &mControlFile;
+      item.mpMEID = &mMEID;
+      item.mStatsDumpInterval = mStatsDumpInterval;
+      item.mbAdaptiveTimeouts = mbAdaptiveTimeouts;
+      item.mpThreadConfig = &mThreadConfig;
+      item.mThreadID = 0;
+      item.mResult.mService = svc;
+      item.mResult.mInitializeTime = 0;
+      item.mResult.mConnectTime = 0;
+      item.mResult.mbConnected = false;
+
+      StartServer( &item );
+      if (item.mResult.mbConnected == true)
+      {
+         pEntry->mbStarted = true;
+      }
+      else
+      {
+         // The request will fail as not connected, the next one retries
+         pEntry->mpServer->Disconnect();
+         pEntry->mpServer->Exit();
+      }
+
+      TRACE( "AcquireServer(), service %d: initialize %lu us, connect %lu us%s\n",
+             (int)svc,
+             item.mResult.mInitializeTime,
+             item.mResult.mConnectTime,
+             item.mResult.mbConnected == true ? "" : " (failed)" );
+   }
+
+   pthread_mutex_unlock( &mServerMutex );
+
+   return pEntry;
+}
+
+/*===========================================================================
+METHOD:
+   ReleaseServer (Internal Method)
+
+DESCRIPTION:
+   Release a server held up by AcquireServer()
+
+PARAMETERS:
+   pEntry      [ I ] - Service table entry returned by AcquireServer()
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiQMICore::ReleaseServer( sGobiQMIServiceEntry * pEntry )
+{
+   if (pEntry == 0)
+   {
+      return;
+   }
+
+   // The idle time starts now
+   if (pEntry->mbOnDemand == true)
+   {
+      pEntry->mLastUse = GetTickCount();
+   }
+
+   __sync_fetch_and_sub( &pEntry->mUsers, 1 );
+}
+
+/*===========================================================================
+METHOD:
+   IsServerReapable (Internal Method)
+
+DESCRIPTION:
+   May the given on-demand service be taken down once idle? 
+
+   Taking a server down releases its QMI client on the device, along with
+   anything set up through it (indication registrations, data sessions),
+   objects relying on such state override this
+
+PARAMETERS:
+   svc         [ I ] - QMI service type
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool cGobiQMICore::IsServerReapable( eQMIService /* svc */ )
+{
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   ReapIdleServers (Internal Method)
+
+DESCRIPTION:
+   Take down the on-demand servers that have been idle (no requests, not 
+   even asynchronous ones) for longer than their idle timeout
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiQMICore::ReapIdleServers()
+{
+   ULONG svcCount = (ULONG)mServiceIDs.size();
+   for (ULONG s = 0; s < svcCount; s++)
+   {
+      eQMIService svc = mServiceIDs[s];
+      sGobiQMIServiceEntry & entry = mpServices[svc];
+      if (entry.mbOnDemand == false || entry.mIdleTimeout == 0)
+      {
+         continue;
+      }
+
+      pthread_mutex_lock( &mServerMutex );
+
+      bool bReap = false;
+      if ( (entry.mbStarted == true)
+      &&   (__sync_fetch_and_add( &entry.mUsers, 0 ) == 0) )
+      {
+         ULONGLONG now = GetTickCount();
+         ULONGLONG lastUse = entry.mLastUse;
+         bReap = (now >= lastUse && now - lastUse >= entry.mIdleTimeout);
+      }
+
+      // Asynchronous sends are still on the server
+      if (bReap == true)
+      {
+         pthread_mutex_lock( &mAsyncMutex );
+
+         std::map <ULONG, sAsyncSend>::const_iterator pSend;
+         for (pSend = mAsyncSends.begin(); pSend != mAsyncSends.end(); pSend++)
+         {
+            if (pSend->second.mSvc == svc)
+            {
+               bReap = false;
+               break;
+            }
+         }
+
+         pthread_mutex_unlock( &mAsyncMutex );
+      }
+
+      if (bReap == true && IsServerReapable( svc ) == true)
+      {
+         entry.mpServer->Disconnect();
+         entry.mpServer->Exit();
+         entry.mbStarted = false;
+
+         TRACE( "ReapIdleServers(), service %d taken down\n", (int)svc );
+      }
+      else
+      {
+         bReap = false;
+      }
+
+      pthread_mutex_unlock( &mServerMutex );
+
+      // Indications of the service won't invalidate its cached responses
+      if (bReap == true)
+      {
+         InvalidateServiceCache( svc );
+      }
+   }
+}
+
+/*===========================================================================
+METHOD:
+   ReaperThread (Static Internal Method)
+
+DESCRIPTION:
+   Idle on-demand server reaper thread, checks the on-demand servers once
+   a second until told to exit
+
+PARAMETERS:
+   pData       [ I ] - Object to reap the servers of (cGobiQMICore)
+  
+RETURN VALUE:
+   void * - always NULL
+===========================================================================*/
+void * cGobiQMICore::ReaperThread( void * pData )
+{
+   cGobiQMICore * pCore = (cGobiQMICore *)pData;
+
+   const DWORD REAP_INTERVAL_MS = 1000;
+   while (true)
+   {
+      DWORD val;
+      int wc = pCore->mReaperExitEvent.Wait( REAP_INTERVAL_MS, val );
+      if (wc != ETIME)
+      {
+         // Exit event (or a wait error)
+         break;
+      }
+
+      pCore->ReapIdleServers();
+   }
+
+   return NULL;
+}
+
+/*===========================================================================
+METHOD:
+   Disconnect (Public Method)
 
 DESCRIPTION:
    Disconnect from the currently connected Gobi device
@@ -598,22 +1634,41 @@ bool cGobiQMICore::Disconnect()
       mLastError = eGOBI_ERR_NO_CONNECTION;
    }
 
+   // Stop taking down idle on-demand servers
+   if (mReaperThreadID != 0)
+   {
+      mReaperExitEvent.Set( 1 );
+      pthread_join( mReaperThreadID, NULL );
+      mReaperThreadID = 0;
+   }
+
    // Disconnect/clean-up all configured QMI servers
-   std::map <eQMIService, cQMIProtocolServer *>::const_iterator pIter;
-   pIter = mServers.begin();
+   pthread_mutex_lock( &mServerMutex );
 
-   while (pIter != mServers.end())
+   ULONG svcCount = (ULONG)mServiceIDs.size();
+   for (ULONG s = 0; s < svcCount; s++)
    {
-      cQMIProtocolServer * pSvr = pIter->second;
-      if (pSvr != 0)
+      sGobiQMIServiceEntry & entry = mpServices[mServiceIDs[s]];
+      if (entry.mpServer != 0)
       {
-         pSvr->Disconnect();
-         pSvr->Exit();
+         entry.mpServer->Disconnect();
+         entry.mpServer->Exit();
       }
 
-      pIter++;
+      entry.mbStarted = false;
    }
 
+   mControlFile.clear();
+   mMEID.clear();
+
+   pthread_mutex_unlock( &mServerMutex );
+
+   // The servers dropped any outstanding requests without notification
+   FailAsyncSends( eGOBI_ERR_NO_CONNECTION );
+
+   // Nothing cached applies to the next connection
+   ClearResponseCache();
+
    mVid = 0xDEADD00D;
    mPid = 0xDEADD00D;
 
@@ -649,25 +1704,21 @@ bool cGobiQMICore::GetConnectedDeviceID(
    // Are all required servers connected?
    bool bAllConnected = true;
 
-   std::map <eQMIService, cQMIProtocolServer *>::const_iterator pIter;
-   pIter = mServers.begin();
-
-   while (pIter != mServers.end())
+   ULONG svcCount = (ULONG)mServiceIDs.size();
+   for (ULONG s = 0; s < svcCount; s++)
    {
-      tServerConfig tsc( pIter->first, true );
-      cQMIProtocolServer * pSvr = pIter->second;
-
-      if (mServerConfig.find( tsc ) != mServerConfig.end() && pSvr != 0)
+      // (on-demand servers come up with their first request)
+      const sGobiQMIServiceEntry & entry = mpServices[mServiceIDs[s]];
+      if ( (entry.mbRequired == true && entry.mpServer != 0)
+      &&   (entry.mbOnDemand == false || entry.mbStarted == true) )
       {
-         if (pSvr->IsConnected() == false)
+         if (entry.mpServer->IsConnected() == false)
          {
             // Failure on essential server
             bAllConnected = false;
             break;
          }
       }
-
-      pIter++;
    }
 
    // Were we once connected?
@@ -724,7 +1775,8 @@ METHOD:
 
 DESCRIPTION:
    Send a request using the specified QMI protocol server and wait for (and
-   then return) the response
+   then return) the response, read-only requests with a cache TTL are 
+   served through the response cache
 
 PARAMETERS:
    svc         [ I ] - QMI service type
@@ -738,6 +1790,36 @@ sProtocolBuffer cGobiQMICore::Send(
    eQMIService                svc,
    sSharedBuffer *            pRequest,
    ULONG                      to )
+{
+   ULONG ttl = GetResponseCacheTTL( svc, pRequest );
+   if (ttl > 0)
+   {
+      return SendCached( svc, pRequest, to, ttl );
+   }
+
+   return SendRequest( svc, pRequest, to );
+}
+
+/*===========================================================================
+METHOD:
+   SendRequest (Internal Method)
+
+DESCRIPTION:
+   Send a request using the specified QMI protocol server and wait for (and
+   then return) the response, bypassing the response cache
+
+PARAMETERS:
+   svc         [ I ] - QMI service type
+   pRequest    [ I ] - Request to schedule
+   to          [ I ] - Timeout value (in milliseconds)
+
+RETURN VALUE:
+   sProtocolBuffer - The response (invalid when no response was received)
+===========================================================================*/
+sProtocolBuffer cGobiQMICore::SendRequest(
+   eQMIService                svc,
+   sSharedBuffer *            pRequest,
+   ULONG                      to )
 {
    // Clear last error recorded
    ClearLastError();
@@ -753,7 +1835,7 @@ sProtocolBuffer cGobiQMICore::Send(
    }
 
    // We use the event based notification approach
-   cSyncQueue <sProtocolNotificationEvent> evts( 12, true );   
+   tProtocolNotificationQueue evts( 12, true );   
    cProtocolQueueNotification pn( &evts );
 
    // Process up to the indicated timeout
@@ -767,35 +1849,43 @@ sProtocolBuffer cGobiQMICore::Send(
       return rsp;
    }
 
-   // Grab the server
-   cQMIProtocolServer * pSvr = GetServer( svc );
-   if (pSvr == 0)
+   // Grab the server (bringing it up if needed)
+   sGobiQMIServiceEntry * pEntry = AcquireServer( svc );
+   if (pEntry == 0)
    {
       mLastError = eGOBI_ERR_INTERNAL;
       return rsp;
    }
 
+   cQMIProtocolServer * pSvr = pEntry->mpServer;
+
    // Are we connected?
    if (mDeviceNode.size() <= 0 || pSvr->IsConnected() == false)
    {
+      ReleaseServer( pEntry );
       mLastError = eGOBI_ERR_NO_CONNECTION;
       return rsp;
    }
 
    // Grab the log from the server
-   const cProtocolLog & protocolLog = pSvr->GetLog();
+   const cProtocolLog & protocolLog = *pEntry->mpLog;
 
    // Schedule the request
    ULONG reqID = pSvr->AddRequest( req );
    if (reqID == INVALID_REQUEST_ID)
    {
+      ReleaseServer( pEntry );
       mLastError = eGOBI_ERR_REQ_SCHEDULE;
       return rsp;
    }   
 
-   // Store for external cancel
+   __sync_fetch_and_add( &pEntry->mStats.mRequests, 1 );
+
+   // Store for external cancel (until this call is done with it)
    tServiceRequest sr( svc, reqID );
-   mRequests.AddElement( sr ); 
+   pthread_mutex_lock( &mRequestsMutex );
+   mRequests.push_back( sr );
+   pthread_mutex_unlock( &mRequestsMutex );
 
    bool bReq = false;
    bool bExit = false;
@@ -845,30 +1935,9 @@ sProtocolBuffer cGobiQMICore::Send(
             break;
             
          case ePROTOCOL_EVT_REQ_SENT:
-         {
-            // Are we doing WDS business?
-            if (svc == eQMI_SVC_WDS)
-            {
-               // Grab the as-sent request
-               DWORD id = evt.mParam2;
-               sProtocolBuffer tmpReq = protocolLog.GetBuffer( id );
-               sSharedBuffer * pTmpRequest = tmpReq.GetSharedBuffer();
-               if (pTmpRequest != 0)
-               {
-                  // Check the message ID
-                  sQMIServiceBuffer actualReq( pTmpRequest );
-                  ULONG msgID = actualReq.GetMessageID();
-                  if (msgID == (ULONG)eQMI_WDS_START_NET)
-                  {
-                     // Grab the transaction ID
-                     mLastNetStartID = actualReq.GetTransactionID();
-                  }
-               }
-            }
-
+            CheckSentRequest( svc, protocolLog, evt.mParam2 );
             bReq = true;
-         }
-         break;
+            break;
 
          case ePROTOCOL_EVT_RSP_RECV:
             // Success!
@@ -887,6 +1956,25 @@ sProtocolBuffer cGobiQMICore::Send(
       pSvr->RemoveRequest( reqID );
    }
 
+   // The request can no longer be cancelled
+   pthread_mutex_lock( &mRequestsMutex );
+
+   std::vector <tServiceRequest>::iterator pIter = mRequests.end();
+   while (pIter != mRequests.begin())
+   {
+      --pIter;
+      if (*pIter == sr)
+      {
+         mRequests.erase( pIter );
+         break;
+      }
+   }
+
+   pthread_mutex_unlock( &mRequestsMutex );
+
+   RecordServiceOutcome( pEntry, mLastError );
+   ReleaseServer( pEntry );
+
    // Check that the device is still there?
    if ( (mLastError == eGOBI_ERR_REQUEST)
    ||   (mLastError == eGOBI_ERR_RESPONSE)
@@ -906,6 +1994,48 @@ sProtocolBuffer cGobiQMICore::Send(
    return rsp;
 }
 
+/*===========================================================================
+METHOD:
+   CheckSentRequest (Internal Method)
+
+DESCRIPTION:
+   Record the transaction ID of an as-sent QMI_WDS_START_NET request
+
+PARAMETERS:
+   svc         [ I ] - QMI service type
+   protocolLog [ I ] - Log of the protocol server the request was sent on
+   logIdx      [ I ] - Index of the as-sent request in the log
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiQMICore::CheckSentRequest(
+   eQMIService                svc,
+   const cProtocolLog &       protocolLog,
+   ULONG                      logIdx )
+{
+   // Are we doing WDS business?
+   if (svc != eQMI_SVC_WDS)
+   {
+      return;
+   }
+
+   // Grab the as-sent request
+   sProtocolBuffer tmpReq = protocolLog.GetBuffer( logIdx );
+   sSharedBuffer * pTmpRequest = tmpReq.GetSharedBuffer();
+   if (pTmpRequest != 0)
+   {
+      // Check the message ID
+      sQMIServiceBuffer actualReq( pTmpRequest );
+      ULONG msgID = actualReq.GetMessageID();
+      if (msgID == (ULONG)eQMI_WDS_START_NET)
+      {
+         // Grab the transaction ID
+         mLastNetStartID = actualReq.GetTransactionID();
+      }
+   }
+}
+
 /*===========================================================================
 METHOD:
    SendAndCheckReturn (Public Method)
@@ -1012,17 +2142,19 @@ RETURN VALUE:
 ===========================================================================*/
 eGobiError cGobiQMICore::CancelSend()
 {
-   ULONG reqs = mRequests.GetTotalCount();
-   if (reqs == 0)
+   tServiceRequest elem( eQMI_SVC_ENUM_BEGIN, INVALID_REQUEST_ID );
+
+   pthread_mutex_lock( &mRequestsMutex );
+   if (mRequests.empty() == false)
    {
-      return eGOBI_ERR_NO_CANCELABLE_OP;
+      elem = mRequests.back();
    }
 
-   tServiceRequest elem( eQMI_SVC_ENUM_BEGIN, INVALID_REQUEST_ID );
-   bool bElem = mRequests.GetElement( --reqs, elem );
-   if (bElem == false)
+   pthread_mutex_unlock( &mRequestsMutex );
+
+   if (elem.second == INVALID_REQUEST_ID)
    {
-      return eGOBI_ERR_INTERNAL;
+      return eGOBI_ERR_NO_CANCELABLE_OP;
    }
 
    cQMIProtocolServer * pSvr = GetServer( elem.first );
@@ -1040,3 +2172,471 @@ eGobiError cGobiQMICore::CancelSend()
 
    return eGOBI_ERR_NONE;
 }
+
+/*===========================================================================
+METHOD:
+   SendAsync (Public Method)
+
+DESCRIPTION:
+   Send a request using the specified QMI protocol server without waiting,
+   the callback is run on the send executor with the response (or error)
+   once the request completes
+
+PARAMETERS:
+   svc         [ I ] - QMI service type
+   pRequest    [ I ] - Request to schedule
+   to          [ I ] - Timeout value (in milliseconds)
+   pCallback   [ I ] - Completion callback (must remain valid until run)
+
+RETURN VALUE:
+   ULONG - Handle of the request (INVALID_GOBI_SEND_HANDLE upon error, see
+           GetLastError())
+===========================================================================*/
+ULONG cGobiQMICore::SendAsync(
+   eQMIService                svc,
+   sSharedBuffer *            pRequest,
+   ULONG                      to,
+   cGobiQMISendCallback *     pCallback )
+{
+   std::vector <sSharedBuffer *> requests( 1, pRequest );
+   std::vector <ULONG> handles;
+
+   SendBatch( svc, requests, to, pCallback, handles );
+   return handles[0];
+}
+
+/*===========================================================================
+METHOD:
+   SendBatch (Public Method)
+
+DESCRIPTION:
+   Send several requests using the specified QMI protocol server at once
+   (under a single schedule update) without waiting, the callback is run 
+   on the send executor for each request as it completes
+
+PARAMETERS:
+   svc         [ I ] - QMI service type
+   requests    [ I ] - Requests to schedule
+   to          [ I ] - Timeout value (in milliseconds)
+   pCallback   [ I ] - Completion callback (must remain valid until run 
+                       for every request)
+   handles     [ O ] - Handle of each request (INVALID_GOBI_SEND_HANDLE
+                       for each request that could not be scheduled)
+
+RETURN VALUE:
+   eGobiError - eGOBI_ERR_NONE when every request was scheduled
+===========================================================================*/
+eGobiError cGobiQMICore::SendBatch(
+   eQMIService                            svc,
+   const std::vector <sSharedBuffer *> &  requests,
+   ULONG                                  to,
+   cGobiQMISendCallback *                 pCallback,
+   std::vector <ULONG> &                  handles )
+{
+   // Clear last error recorded
+   ClearLastError();
+
+   ULONG reqCount = (ULONG)requests.size();
+   handles.assign( reqCount, INVALID_GOBI_SEND_HANDLE );
+
+   // Validate the arguments
+   if (pCallback == 0 || reqCount == 0)
+   {
+      mLastError = eGOBI_ERR_INVALID_ARG;
+      return mLastError;
+   }
+
+   for (ULONG r = 0; r < reqCount; r++)
+   {
+      if (requests[r] == 0)
+      {
+         mLastError = eGOBI_ERR_MEMORY;
+         return mLastError;
+      }
+   }
+
+   if (to == 0)
+   {
+      mLastError = eGOBI_ERR_INTERNAL;
+      return mLastError;
+   }
+
+   // Grab the server (bringing it up if needed), the registered sends
+   // keep it up once released
+   sGobiQMIServiceEntry * pEntry = AcquireServer( svc );
+   if (pEntry == 0)
+   {
+      mLastError = eGOBI_ERR_INTERNAL;
+      return mLastError;
+   }
+
+   cQMIProtocolServer * pSvr = pEntry->mpServer;
+
+   // Are we connected?
+   if (mDeviceNode.size() <= 0 || pSvr->IsConnected() == false)
+   {
+      ReleaseServer( pEntry );
+      mLastError = eGOBI_ERR_NO_CONNECTION;
+      return mLastError;
+   }
+
+   // Register the sends first, as their notifications can arrive before
+   // the server returns the request IDs
+   sAsyncSend send;
+   send.mSvc = svc;
+   send.mReqID = INVALID_REQUEST_ID;
+   send.mpCallback = pCallback;
+
+   pthread_mutex_lock( &mAsyncMutex );
+
+   for (ULONG r = 0; r < reqCount; r++)
+   {
+      ULONG handle = ++mLastAsyncHandle;
+      while ( (handle == INVALID_GOBI_SEND_HANDLE)
+      ||      (mAsyncSends.find( handle ) != mAsyncSends.end()) )
+      {
+         handle = ++mLastAsyncHandle;
+      }
+
+      mAsyncSends[handle] = send;
+      handles[r] = handle;
+   }
+
+   pthread_mutex_unlock( &mAsyncMutex );
+
+   // Build the request objects (each clones its own notifier)
+   std::vector <const sProtocolRequest *> reqs( reqCount, 0 );
+   for (ULONG r = 0; r < reqCount; r++)
+   {
+      cGobiQMIAsyncNotification pn( this, handles[r] );
+      reqs[r] = new sProtocolRequest( requests[r], 0, to, 1, 1, &pn );
+   }
+
+   // Schedule the requests
+   std::vector <ULONG> reqIDs;
+   ULONG added = pSvr->AddRequests( reqs, reqIDs );
+   __sync_fetch_and_add( &pEntry->mStats.mRequests, added );
+
+   for (ULONG r = 0; r < reqCount; r++)
+   {
+      delete reqs[r];
+   }
+
+   // Store the request IDs for cancellation (or drop what failed)
+   pthread_mutex_lock( &mAsyncMutex );
+
+   for (ULONG r = 0; r < reqCount; r++)
+   {
+      std::map <ULONG, sAsyncSend>::iterator pIter;
+      pIter = mAsyncSends.find( handles[r] );
+
+      if (reqIDs[r] == INVALID_REQUEST_ID)
+      {
+         if (pIter != mAsyncSends.end())
+         {
+            mAsyncSends.erase( pIter );
+         }
+
+         handles[r] = INVALID_GOBI_SEND_HANDLE;
+      }
+      else if (pIter != mAsyncSends.end())
+      {
+         pIter->second.mReqID = reqIDs[r];
+      }
+   }
+
+   pthread_mutex_unlock( &mAsyncMutex );
+
+   ReleaseServer( pEntry );
+
+   if (added < reqCount)
+   {
+      mLastError = eGOBI_ERR_REQ_SCHEDULE;
+   }
+
+   return mLastError;
+}
+
+/*===========================================================================
+METHOD:
+   CancelAsync (Public Method)
+
+DESCRIPTION:
+   Cancel an in-progress SendAsync()/SendBatch() request, the callback is
+   still run (with eGOBI_ERR_REQUEST or eGOBI_ERR_RESPONSE)
+
+PARAMETERS:
+   handle      [ I ] - Handle of the request
+
+RETURN VALUE:
+   eGobiError
+===========================================================================*/
+eGobiError cGobiQMICore::CancelAsync( ULONG handle )
+{
+   std::map <ULONG, sAsyncSend>::iterator pIter;
+
+   pthread_mutex_lock( &mAsyncMutex );
+
+   pIter = mAsyncSends.find( handle );
+   if (pIter == mAsyncSends.end())
+   {
+      pthread_mutex_unlock( &mAsyncMutex );
+      return eGOBI_ERR_NO_CANCELABLE_OP;
+   }
+
+   sAsyncSend send = pIter->second;
+
+   pthread_mutex_unlock( &mAsyncMutex );
+
+   // Still being scheduled?
+   if (send.mReqID == INVALID_REQUEST_ID)
+   {
+      return eGOBI_ERR_CANCEL_OP;
+   }
+
+   cQMIProtocolServer * pSvr = GetServer( send.mSvc );
+   if (pSvr == 0)
+   {
+      return eGOBI_ERR_INTERNAL;
+   }
+
+   // Note: this notifies (and hence completes) a request that has 
+   // already been sent
+   bool bRemove = pSvr->RemoveRequest( send.mReqID );
+   if (bRemove == false)
+   {
+      return eGOBI_ERR_CANCEL_OP;
+   }
+
+   // A request still awaiting transmission is dropped without notification
+   bool bComplete = false;
+
+   pthread_mutex_lock( &mAsyncMutex );
+
+   pIter = mAsyncSends.find( handle );
+   if (pIter != mAsyncSends.end())
+   {
+      mAsyncSends.erase( pIter );
+      bComplete = true;
+   }
+
+   pthread_mutex_unlock( &mAsyncMutex );
+
+   if (bComplete == true)
+   {
+      CompleteAsyncSend( handle, send, eGOBI_ERR_REQUEST, sProtocolBuffer() );
+   }
+
+   return eGOBI_ERR_NONE;
+}
+
+/*===========================================================================
+METHOD:
+   AsyncSendEvent (Internal Method)
+
+DESCRIPTION:
+   Handle a protocol event for an asynchronous send, terminal events
+   complete the send
+
+PARAMETERS:
+   handle      [ I ] - Handle of the request
+   eventType   [ I ] - Event type
+   param1      [ I ] - Event type specific argument (request ID)
+   param2      [ I ] - Event type specific argument (log index/error)
+
+SEQUENCING:
+   Called from the protocol server with its schedule mutex held, so the
+   callback itself is never run here
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiQMICore::AsyncSendEvent(
+   ULONG                      handle,
+   eProtocolEventType         eventType,
+   DWORD                      param1,
+   DWORD                      param2 )
+{
+   if ( (eventType != ePROTOCOL_EVT_REQ_SENT)
+   &&   (eventType != ePROTOCOL_EVT_REQ_ERR)
+   &&   (eventType != ePROTOCOL_EVT_RSP_ERR)
+   &&   (eventType != ePROTOCOL_EVT_RSP_RECV) )
+   {
+      return;
+   }
+
+   std::map <ULONG, sAsyncSend>::iterator pIter;
+
+   pthread_mutex_lock( &mAsyncMutex );
+
+   pIter = mAsyncSends.find( handle );
+   if (pIter == mAsyncSends.end())
+   {
+      // Already completed (or cancelled)
+      pthread_mutex_unlock( &mAsyncMutex );
+      return;
+   }
+
+   sAsyncSend send = pIter->second;
+   if (eventType != ePROTOCOL_EVT_REQ_SENT)
+   {
+      mAsyncSends.erase( pIter );
+   }
+
+   pthread_mutex_unlock( &mAsyncMutex );
+
+   eGobiError ec = eGOBI_ERR_NONE;
+   sProtocolBuffer rsp;
+
+   cQMIProtocolServer * pSvr = GetServer( send.mSvc );
+
+   switch (eventType)
+   {
+      case ePROTOCOL_EVT_REQ_SENT:
+         if (pSvr != 0)
+         {
+            CheckSentRequest( send.mSvc, pSvr->GetLog(), param2 );
+         }
+         return;
+
+      case ePROTOCOL_EVT_REQ_ERR:
+         ec = eGOBI_ERR_REQUEST;
+         break;
+
+      case ePROTOCOL_EVT_RSP_ERR:
+         // The server reports a response timeout as error code 0
+         ec = (param2 == 0 ? eGOBI_ERR_RESPONSE_TO : eGOBI_ERR_RESPONSE);
+         break;
+
+      case ePROTOCOL_EVT_RSP_RECV:
+         if (pSvr != 0)
+         {
+            rsp = pSvr->GetLog().GetBuffer( param2 );
+         }
+
+         if (rsp.IsValid() == false)
+         {
+            // The response has already been pushed out of the log
+            ec = eGOBI_ERR_INTERNAL;
+         }
+         break;
+
+      default:
+         return;
+   }
+
+   CompleteAsyncSend( handle, send, ec, rsp );
+}
+
+/*===========================================================================
+METHOD:
+   CompleteAsyncSend (Internal Method)
+
+DESCRIPTION:
+   Queue the completion of an asynchronous send on the send executor 
+   (the send must already have been removed from mAsyncSends)
+
+PARAMETERS:
+   handle      [ I ] - Handle of the request
+   send        [ I ] - The send
+   ec          [ I ] - Outcome
+   rsp         [ I ] - Response (eGOBI_ERR_NONE only)
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiQMICore::CompleteAsyncSend(
+   ULONG                      handle,
+   const sAsyncSend &         send,
+   eGobiError                 ec,
+   const sProtocolBuffer &    rsp )
+{
+   RecordServiceOutcome( GetServiceEntry( send.mSvc ), ec );
+
+   cGobiQMISendTask * pTask = 0;
+   pTask = new cGobiQMISendTask( send.mpCallback, handle, ec, rsp );
+   if (pTask == 0)
+   {
+      return;
+   }
+
+   cExecutor * pExecutor = mpSendExecutor;
+   if (pExecutor == 0)
+   {
+      pExecutor = mpManagerExecutor;
+   }
+
+   if (pExecutor == 0)
+   {
+      pExecutor = &mSendExecutor;
+   }
+
+   if (pExecutor->Execute( pTask ) == false)
+   {
+      // No executor to run on, this should never happen
+      TRACE( "CompleteAsyncSend(), completion run inline\n" );
+
+      pTask->Run();
+      delete pTask;
+   }
+}
+
+/*===========================================================================
+METHOD:
+   FailAsyncSends (Internal Method)
+
+DESCRIPTION:
+   Complete every outstanding asynchronous send with the given error
+
+PARAMETERS:
+   ec          [ I ] - Error
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiQMICore::FailAsyncSends( eGobiError ec )
+{
+   std::map <ULONG, sAsyncSend> sends;
+
+   pthread_mutex_lock( &mAsyncMutex );
+   sends.swap( mAsyncSends );
+   pthread_mutex_unlock( &mAsyncMutex );
+
+   std::map <ULONG, sAsyncSend>::const_iterator pIter = sends.begin();
+   while (pIter != sends.end())
+   {
+      CompleteAsyncSend( pIter->first, pIter->second, ec, sProtocolBuffer() );
+      pIter++;
+   }
+}
+
+/*===========================================================================
+METHOD:
+   RecordServiceOutcome (Internal Method)
+
+DESCRIPTION:
+   Record the outcome of a scheduled request in the service counters
+
+PARAMETERS:
+   pEntry      [ I ] - Service table entry (may be 0)
+   ec          [ I ] - Outcome
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiQMICore::RecordServiceOutcome(
+   sGobiQMIServiceEntry *     pEntry,
+   eGobiError                 ec )
+{
+   if (pEntry == 0 || ec == eGOBI_ERR_NONE)
+   {
+      return;
+   }
+
+   __sync_fetch_and_add( &pEntry->mStats.mFailures, 1 );
+
+   if (ec == eGOBI_ERR_REQUEST_TO || ec == eGOBI_ERR_RESPONSE_TO)
+   {
+      __sync_fetch_and_add( &pEntry->mStats.mTimeouts, 1 );
+   }
+}
@@ -6,6 +6,18 @@ DESCRIPTION:
    QUALCOMM Gobi QMI Based API Core
 
 PUBLIC CLASSES AND FUNCTIONS:
+   cGobiQMISendCallback
+   cGobiQMIAsyncNotification
+   cGobiQMISendTask
+   cGobiQMIResponseCollector
+   cGobiQMISMSCallback
+   cGobiQMISMSBatchReader
+   cGobiQMINetworkScanCallback
+   cGobiQMINetworkScanner
+   sGobiImageEntry
+   sGobiImageInventory
+   sGobiDeviceSnapshot
+   sGobiProfile
    cGobiQMICore
 
 Copyright (c) 2011, Code Aurora Forum. All rights reserved.
@@ -53,6 +65,8 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "DataPacker.h"
 #include "DB2Utilities.h"
 #include "SyncQueue.h"
+#include "Executor.h"
+#include "ProtocolNotification.h"
 #include "GobiError.h"
 #include "GobiMBNMgmt.h"
 
@@ -63,23 +77,703 @@ POSSIBILITY OF SUCH DAMAGE.
 // Default timeout for Gobi QMI requests
 extern const ULONG DEFAULT_GOBI_QMI_TIMEOUT;
 
+// Invalid asynchronous send handle
+extern const ULONG INVALID_GOBI_SEND_HANDLE;
+
+// Default number of SMS reads awaiting a response at once (GetSMSBatch())
+extern const ULONG DEFAULT_GOBI_SMS_BATCH_WINDOW;
+
+// Default number of profile reads/writes awaiting a response at once 
+// (GetProfiles()/ApplyProfiles())
+extern const ULONG DEFAULT_GOBI_PROFILE_BATCH_WINDOW;
+
+// Number of QMI service table entries (indexed by eQMIService)
+const ULONG QMI_SERVICE_TABLE_SZ = (ULONG)eQMI_SVC_ENUM_END;
+
+// Capacities of the arrays/strings of a device snapshot
+const ULONG GOBI_SNAPSHOT_MAX_SIGNALS = 12;
+const BYTE GOBI_SNAPSHOT_MAX_RADIO_IFACES = 12;
+const BYTE GOBI_SNAPSHOT_NAME_SZ = 255;
+const BYTE GOBI_SNAPSHOT_ICCID_SZ = 32;
+
+//---------------------------------------------------------------------------
+// Forward Declarations
+//---------------------------------------------------------------------------
+class cGobiQMICore;
+class cGobiDeviceManager;
+
 /*=========================================================================*/
 // Prototypes 
 /*=========================================================================*/
 
 // Find the given TLV
 sDB2NavInput FindTLV( 
-   const std::vector <sDB2NavInput> &  tlvs, 
+   const cDB2NavInputs &               tlvs, 
    const sProtocolEntityKey &          tlvKey );
 
 // Parse the given TLV to fields
 cDataParser::tParsedFields ParseTLV( 
    const cCoreDatabase &               db,
    const sProtocolBuffer &             qmiBuf,
-   const std::vector <sDB2NavInput> &  tlvs, 
+   const cDB2NavInputs &               tlvs, 
    const sProtocolEntityKey &          tlvKey,
    bool                                bFieldStrings = false );
 
+// Parse the given TLV to raw field values (no names or strings)
+ULONG ParseTLVValues( 
+   const cCoreDatabase &               db,
+   const sProtocolBuffer &             qmiBuf,
+   const cDB2NavInputs &               tlvs, 
+   const sProtocolEntityKey &          tlvKey,
+   sParsedFieldValue *                 pValues,
+   ULONG                               maxValues );
+
+/*=========================================================================*/
+// Class cGobiQMISendCallback
+//
+//    This abstract base class receives the outcome of an asynchronous
+//    (SendAsync/SendBatch) request
+/*=========================================================================*/
+class cGobiQMISendCallback
+{
+   public:
+      // (Inline) Constructor
+      cGobiQMISendCallback() { };
+
+      // (Inline) Destructor
+      virtual ~cGobiQMISendCallback() { };
+
+      // The request has completed, process the response (only valid when 
+      // the error is eGOBI_ERR_NONE)
+      virtual void SendComplete(
+         ULONG                      handle,
+         eGobiError                 ec,
+         const sProtocolBuffer &    rsp ) = 0;
+};
+
+/*=========================================================================*/
+// Class cGobiQMIAsyncNotification
+//
+//    This class passes the protocol events of an asynchronous request
+//    straight on to the owning cGobiQMICore object
+/*=========================================================================*/
+class cGobiQMIAsyncNotification : public cProtocolNotification
+{
+   public:
+      // (Inline) Constructor
+      cGobiQMIAsyncNotification(
+         cGobiQMICore *             pCore,
+         ULONG                      handle )
+         :  mpCore( pCore ),
+            mHandle( handle )
+      { };
+
+      // (Inline) Destructor
+      virtual ~cGobiQMIAsyncNotification() { };
+
+      // (Inline) Return an allocated copy of this object
+      virtual cProtocolNotification * Clone() const
+      {
+         return new cGobiQMIAsyncNotification( mpCore, mHandle );
+      };
+
+      // Notify core of a protocol event
+      virtual void Notify(
+         eProtocolEventType         eventType,
+         DWORD                      param1,
+         DWORD                      param2 ) const;
+
+   protected:
+      /* Core object that issued the request */
+      cGobiQMICore * mpCore;
+
+      /* Asynchronous send handle */
+      ULONG mHandle;
+};
+
+/*=========================================================================*/
+// Class cGobiQMISendTask
+//
+//    Executor task that runs the completion of an asynchronous request
+/*=========================================================================*/
+class cGobiQMISendTask : public cExecutorTask
+{
+   public:
+      // (Inline) Constructor
+      cGobiQMISendTask(
+         cGobiQMISendCallback *     pCallback,
+         ULONG                      handle,
+         eGobiError                 ec,
+         const sProtocolBuffer &    rsp )
+         :  mpCallback( pCallback ),
+            mHandle( handle ),
+            mError( ec ),
+            mRsp( rsp )
+      { };
+
+      // (Inline) Run the completion
+      virtual void Run()
+      {
+         if (mpCallback != 0)
+         {
+            mpCallback->SendComplete( mHandle, mError, mRsp );
+         }
+      };
+
+   protected:
+      /* Completion callback */
+      cGobiQMISendCallback * mpCallback;
+
+      /* Asynchronous send handle */
+      ULONG mHandle;
+
+      /* Outcome */
+      eGobiError mError;
+      sProtocolBuffer mRsp;
+};
+
+/*=========================================================================*/
+// Class cGobiQMIResponseCollector
+//
+//    Completion callback that keeps the outcome of each asynchronous 
+//    request (by handle) for a caller waiting on the whole batch
+/*=========================================================================*/
+class cGobiQMIResponseCollector : public cGobiQMISendCallback
+{
+   public:
+      // Constructor
+      cGobiQMIResponseCollector();
+
+      // Destructor
+      virtual ~cGobiQMIResponseCollector();
+
+      // Wait for the requests with the given handles to complete (invalid
+      // handles, i.e. requests that were not scheduled, are skipped)
+      void Wait( const std::vector <ULONG> & handles );
+
+      // Return the outcome of the request with the given handle
+      eGobiError GetResponse(
+         ULONG                      handle,
+         sProtocolBuffer &          rsp );
+
+      // A request has completed
+      virtual void SendComplete(
+         ULONG                      handle,
+         eGobiError                 ec,
+         const sProtocolBuffer &    rsp );
+
+   protected:
+      /* Outcome of each completed request (by handle) */
+      std::map <ULONG, std::pair <eGobiError, sProtocolBuffer> > mResponses;
+
+      /* Mutex protecting the above */
+      pthread_mutex_t mMutex;
+
+      /* Signalled as requests complete */
+      pthread_cond_t mCond;
+};
+
+/*=========================================================================*/
+// Class cGobiQMISMSCallback
+//
+//    This abstract base class receives the SMS messages read by
+//    GetSMSBatch()
+/*=========================================================================*/
+class cGobiQMISMSCallback
+{
+   public:
+      // (Inline) Constructor
+      cGobiQMISMSCallback() { };
+
+      // (Inline) Destructor
+      virtual ~cGobiQMISMSCallback() { };
+
+      // An SMS message has been read (the message is only valid when the
+      // error is eGOBI_ERR_NONE, and only for the duration of the call)
+      virtual void SMSRead(
+         ULONG                      messageIndex,
+         eGobiError                 ec,
+         ULONG                      messageTag,
+         ULONG                      messageFormat,
+         ULONG                      messageSize,
+         const BYTE *               pMessage ) = 0;
+};
+
+/*=========================================================================*/
+// Class cGobiQMISMSBatchReader
+//
+//    Completion callback of the (asynchronous) raw reads of GetSMSBatch(),
+//    decoding each message and passing it on to a cGobiQMISMSCallback
+/*=========================================================================*/
+class cGobiQMISMSBatchReader : public cGobiQMISendCallback
+{
+   public:
+      // Constructor
+      cGobiQMISMSBatchReader(
+         cGobiQMICore *             pCore,
+         cGobiQMISMSCallback *      pCallback );
+
+      // Destructor
+      virtual ~cGobiQMISMSBatchReader();
+
+      // Map the handles of the scheduled reads to message indices
+      void AddReads(
+         const std::vector <ULONG> &   handles,
+         const std::vector <ULONG> &   messageIndices,
+         eGobiError                    scheduleError );
+
+      // Wait for every read added to complete
+      void Wait();
+
+      // A read has completed
+      virtual void SendComplete(
+         ULONG                      handle,
+         eGobiError                 ec,
+         const sProtocolBuffer &    rsp );
+
+   protected:
+      // Decode a read and pass it on (the mutex must be held)
+      void Deliver(
+         ULONG                      messageIndex,
+         eGobiError                 ec,
+         const sProtocolBuffer &    rsp );
+
+      /* Core object that issued the reads */
+      cGobiQMICore * mpCore;
+
+      /* Callback receiving the messages */
+      cGobiQMISMSCallback * mpCallback;
+
+      /* Message index of each outstanding read (by handle) */
+      std::map <ULONG, ULONG> mReads;
+
+      /* Reads completed before their handle was added */
+      std::map <ULONG, std::pair <eGobiError, sProtocolBuffer> > mEarly;
+
+      /* Number of reads added/completed */
+      ULONG mExpected;
+      ULONG mCompleted;
+
+      /* Mutex protecting the above (and serializing the callback) */
+      pthread_mutex_t mMutex;
+
+      /* Signalled as reads complete */
+      pthread_cond_t mCond;
+};
+
+/*=========================================================================*/
+// Class cGobiQMINetworkScanCallback
+//
+//    This abstract base class receives the networks found by an 
+//    asynchronous network scan (StartNetworkScan())
+/*=========================================================================*/
+class cGobiQMINetworkScanCallback
+{
+   public:
+      // (Inline) Constructor
+      cGobiQMINetworkScanCallback() { };
+
+      // (Inline) Destructor
+      virtual ~cGobiQMINetworkScanCallback() { };
+
+      // A network has been found (the description is only valid for the
+      // duration of the call)
+      virtual void NetworkFound(
+         WORD                       mcc,
+         WORD                       mnc,
+         ULONG                      inUse,
+         ULONG                      roaming,
+         ULONG                      forbidden,
+         ULONG                      preferred,
+         LPCSTR                     pDescription ) = 0;
+
+      // (Inline) The radio access technology of a network found has been
+      // reported (after all networks have been passed on)
+      virtual void NetworkRATFound(
+         WORD                       /* mcc */,
+         WORD                       /* mnc */,
+         ULONG                      /* rat */ ) { };
+
+      // The scan has completed, failed or been cancelled (no other call
+      // is made after this one)
+      virtual void ScanComplete( eGobiError ec ) = 0;
+};
+
+/*=========================================================================*/
+// Class cGobiQMINetworkScanner
+//
+//    Completion callback of an asynchronous network scan, decoding the
+//    networks found straight from the response and passing them on to a
+//    cGobiQMINetworkScanCallback (deletes itself once complete)
+/*=========================================================================*/
+class cGobiQMINetworkScanner : public cGobiQMISendCallback
+{
+   public:
+      // (Inline) Constructor
+      cGobiQMINetworkScanner(
+         cGobiQMICore *                pCore,
+         cGobiQMINetworkScanCallback * pCallback,
+         const sProtocolBuffer &       req )
+         :  mpCore( pCore ),
+            mpCallback( pCallback ),
+            mRequest( req )
+      { };
+
+      // (Inline) Destructor
+      virtual ~cGobiQMINetworkScanner() { };
+
+      // The scan has completed
+      virtual void SendComplete(
+         ULONG                      handle,
+         eGobiError                 ec,
+         const sProtocolBuffer &    rsp );
+
+   protected:
+      // Decode the networks found and pass them on
+      eGobiError Deliver( const sProtocolBuffer & rsp );
+
+      /* Core object that issued the scan */
+      cGobiQMICore * mpCore;
+
+      /* Callback receiving the networks */
+      cGobiQMINetworkScanCallback * mpCallback;
+
+      /* Scan request (held until complete) */
+      sProtocolBuffer mRequest;
+};
+
+/*=========================================================================*/
+// Struct sGobiImageEntry
+//    An image of the image inventory, stored on the device and/or listed 
+//    in the device's image preference
+/*=========================================================================*/
+struct sGobiImageEntry
+{
+   public:
+      // (Inline) Default constructor
+      sGobiImageEntry()
+         :  mImageType( UCHAR_MAX ),
+            mStorageIndex( UCHAR_MAX ),
+            mFailureCount( 0 ),
+            mbExecuting( false ),
+            mbPreferred( false ),
+            mBuildID( "" ),
+            mHostPath( "" )
+      {
+         memset( (LPVOID)&mImageID[0], 0, MBN_UNIQUE_ID_LEN );
+      };
+
+      /* Image type (eGobiMBNType) */
+      BYTE mImageType;
+
+      /* Storage index on the device (UCHAR_MAX if not stored) */
+      BYTE mStorageIndex;
+
+      /* Number of failed attempts to execute the image */
+      BYTE mFailureCount;
+
+      /* Is this the executing image (of its type)? */
+      bool mbExecuting;
+
+      /* Is this image in the image preference? */
+      bool mbPreferred;
+
+      /* Unique image ID */
+      BYTE mImageID[MBN_UNIQUE_ID_LEN];
+
+      /* Build ID */
+      std::string mBuildID;
+
+      /* Fully qualified path to the matching image in the host image 
+         store (empty if there is none) */
+      std::string mHostPath;
+};
+
+/*=========================================================================*/
+// Struct sGobiImageInventory
+//    Everything known about the images of a device (GetImageInventory())
+/*=========================================================================*/
+struct sGobiImageInventory
+{
+   public:
+      // (Inline) Default constructor
+      sGobiImageInventory()
+         :  mBARMode( ULONG_MAX ),
+            mImages()
+      { };
+
+      /* Boot and recovery image download mode */
+      ULONG mBARMode;
+
+      /* Images stored on the device (in device order), followed by the 
+         preferred images that are not stored */
+      std::vector <sGobiImageEntry> mImages;
+};
+
+/*=========================================================================*/
+// Enum eGobiSnapshotItem
+//    Items of a device snapshot (GetDeviceSnapshot()), the bit index of
+//    an item indexes the snapshot's per item outcome
+/*=========================================================================*/
+enum eGobiSnapshotItem
+{
+   eGOBI_SNAPSHOT_SESSION_STATE     = 0x00000001,
+   eGOBI_SNAPSHOT_SIGNAL_STRENGTHS  = 0x00000002,
+   eGOBI_SNAPSHOT_SERVING_NETWORK   = 0x00000004,
+   eGOBI_SNAPSHOT_DATA_BEARER       = 0x00000008,
+   eGOBI_SNAPSHOT_BYTE_TOTALS       = 0x00000010,
+   eGOBI_SNAPSHOT_ROAMING           = 0x00000020,
+   eGOBI_SNAPSHOT_POWER             = 0x00000040,
+   eGOBI_SNAPSHOT_ICCID             = 0x00000080,
+
+   eGOBI_SNAPSHOT_ALL               = 0x000000FF
+};
+
+// Number of device snapshot items
+const ULONG GOBI_SNAPSHOT_ITEMS = 8;
+
+/*=========================================================================*/
+// Struct sGobiDeviceSnapshot
+//    The state of a device gathered by concurrent queries, each item is
+//    only meaningful when flagged in the valid item mask
+/*=========================================================================*/
+struct sGobiDeviceSnapshot
+{
+   public:
+      // (Inline) Default constructor
+      sGobiDeviceSnapshot()
+      {
+         memset( (LPVOID)this, 0, sizeof( *this ) );
+      };
+
+      /* Items requested/retrieved (eGobiSnapshotItem) */
+      ULONG mRequested;
+      ULONG mValid;
+
+      /* Outcome of each requested item (by item bit index) */
+      eGobiError mErrors[GOBI_SNAPSHOT_ITEMS];
+
+      /* Session state (eGOBI_SNAPSHOT_SESSION_STATE) */
+      ULONG mSessionState;
+
+      /* Signal strengths (eGOBI_SNAPSHOT_SIGNAL_STRENGTHS) */
+      ULONG mSignalCount;
+      INT8 mSignalStrengths[GOBI_SNAPSHOT_MAX_SIGNALS];
+      ULONG mSignalRadioIfaces[GOBI_SNAPSHOT_MAX_SIGNALS];
+
+      /* Serving network (eGOBI_SNAPSHOT_SERVING_NETWORK) */
+      ULONG mRegistrationState;
+      ULONG mCSDomain;
+      ULONG mPSDomain;
+      ULONG mRAN;
+      BYTE mRadioIfaceCount;
+      ULONG mRadioIfaces[GOBI_SNAPSHOT_MAX_RADIO_IFACES];
+      WORD mMCC;
+      WORD mMNC;
+      CHAR mNetworkName[GOBI_SNAPSHOT_NAME_SZ];
+
+      /* Data bearer technology (eGOBI_SNAPSHOT_DATA_BEARER) */
+      ULONG mDataBearer;
+
+      /* RX/TX byte counts (eGOBI_SNAPSHOT_BYTE_TOTALS) */
+      ULONGLONG mTXTotalBytes;
+      ULONGLONG mRXTotalBytes;
+
+      /* Roaming indicator (eGOBI_SNAPSHOT_ROAMING) */
+      ULONG mRoaming;
+
+      /* Operating mode (eGOBI_SNAPSHOT_POWER) */
+      ULONG mPowerMode;
+
+      /* UIM ICCID (eGOBI_SNAPSHOT_ICCID) */
+      CHAR mICCID[GOBI_SNAPSHOT_ICCID_SZ];
+};
+
+/*=========================================================================*/
+// Enum eGobiProfileSetting
+//    Settings of a profile (sGobiProfile)
+/*=========================================================================*/
+enum eGobiProfileSetting
+{
+   eGOBI_PROFILE_NAME               = 0x00000001,
+   eGOBI_PROFILE_PDP_TYPE           = 0x00000002,
+   eGOBI_PROFILE_APN_NAME           = 0x00000004,
+   eGOBI_PROFILE_PRIMARY_DNS        = 0x00000008,
+   eGOBI_PROFILE_SECONDARY_DNS      = 0x00000010,
+   eGOBI_PROFILE_USERNAME           = 0x00000020,
+   eGOBI_PROFILE_PASSWORD           = 0x00000040,
+   eGOBI_PROFILE_AUTHENTICATION     = 0x00000080,
+   eGOBI_PROFILE_IP_ADDRESS         = 0x00000100,
+
+   eGOBI_PROFILE_ALL                = 0x000001FF
+};
+
+/*=========================================================================*/
+// Struct sGobiProfile
+//    The settings of a profile read (GetProfiles()) or to be written 
+//    (ApplyProfiles()), each setting is only meaningful when flagged in 
+//    the valid setting mask
+/*=========================================================================*/
+struct sGobiProfile
+{
+   public:
+      // (Inline) Default constructor
+      sGobiProfile()
+         :  mProfileType( 0 ),
+            mIndex( 0 ),
+            mValid( 0 ),
+            mError( eGOBI_ERR_NONE ),
+            mbWritten( false ),
+            mPDPType( ULONG_MAX ),
+            mIPAddress( ULONG_MAX ),
+            mPrimaryDNS( ULONG_MAX ),
+            mSecondaryDNS( ULONG_MAX ),
+            mAuthentication( ULONG_MAX ),
+            mName( "" ),
+            mAPNName( "" ),
+            mUsername( "" ),
+            mPassword( "" )
+      { };
+
+      /* Profile type and index */
+      ULONG mProfileType;
+      BYTE mIndex;
+
+      /* Settings present (eGobiProfileSetting) */
+      ULONG mValid;
+
+      /* Outcome of the last read/write of the profile */
+      eGobiError mError;
+
+      /* Was the profile written (ApplyProfiles())? */
+      bool mbWritten;
+
+      /* PDP type (eGOBI_PROFILE_PDP_TYPE) */
+      ULONG mPDPType;
+
+      /* Preferred assigned IPv4 address (eGOBI_PROFILE_IP_ADDRESS) */
+      ULONG mIPAddress;
+
+      /* Primary/secondary DNS IPv4 addresses (eGOBI_PROFILE_xxx_DNS) */
+      ULONG mPrimaryDNS;
+      ULONG mSecondaryDNS;
+
+      /* Authentication bitmap (eGOBI_PROFILE_AUTHENTICATION) */
+      ULONG mAuthentication;
+
+      /* Profile name (eGOBI_PROFILE_NAME) */
+      std::string mName;
+
+      /* Access point name (eGOBI_PROFILE_APN_NAME) */
+      std::string mAPNName;
+
+      /* Username/password (eGOBI_PROFILE_USERNAME/PASSWORD) */
+      std::string mUsername;
+      std::string mPassword;
+};
+
+/*=========================================================================*/
+// Struct sGobiQMIServiceStats
+//    Request counters of a single QMI service
+/*=========================================================================*/
+struct sGobiQMIServiceStats
+{
+   public:
+      /* Requests scheduled */
+      ULONG mRequests;
+
+      /* Requests that completed with an error */
+      ULONG mFailures;
+
+      /* Failures that were request/response timeouts */
+      ULONG mTimeouts;
+};
+
+/*=========================================================================*/
+// Struct sGobiQMIServiceEntry
+//    Everything an API call needs to reach a configured QMI service, one
+//    cache line per service
+/*=========================================================================*/
+struct sGobiQMIServiceEntry
+{
+   public:
+      /* Protocol server (0 if the service is not configured) */
+      cQMIProtocolServer * mpServer;
+
+      /* Protocol log of the server */
+      const cProtocolLog * mpLog;
+
+      /* Signal event of the protocol log */
+      cEvent * mpSignalEvent;
+
+      /* Protocol types of responses/requests */
+      eProtocolType mRxType;
+      eProtocolType mTxType;
+
+      /* Is the service required for object operation? */
+      bool mbRequired;
+
+      /* Is the server brought up by the first request (and taken down
+         once idle) rather than by Connect()? */
+      bool mbOnDemand;
+
+      /* Is the on-demand server up? (protected by the server mutex) */
+      bool mbStarted;
+
+      /* Request counters (updated atomically) */
+      sGobiQMIServiceStats mStats;
+
+      /* Idle time after which the on-demand server is taken down
+         (milliseconds, 0 to keep it up once started) */
+      ULONG mIdleTimeout;
+
+      /* Requests holding the server up (updated atomically) */
+      ULONG mUsers;
+
+      /* Last time the server was acquired (GetTickCount() based) */
+      ULONGLONG mLastUse;
+} __attribute__ ((aligned (64)));
+
+/*=========================================================================*/
+// Struct sGobiQMIServiceStartup
+//    Startup time of a single QMI service
+/*=========================================================================*/
+struct sGobiQMIServiceStartup
+{
+   public:
+      /* QMI service type */
+      eQMIService mService;
+
+      /* Time spent initializing the server (microseconds) */
+      ULONG mInitializeTime;
+
+      /* Time spent connecting the server (microseconds) */
+      ULONG mConnectTime;
+
+      /* Did the server connect? */
+      bool mbConnected;
+};
+
+/*=========================================================================*/
+// Struct sGobiQMIStartupTimes
+//    Startup time breakdown of the last device connection
+/*=========================================================================*/
+struct sGobiQMIStartupTimes
+{
+   public:
+      /* Time spent reading the device MEID (microseconds) */
+      ULONG mMEIDTime;
+
+      /* Wall time spent bringing up all servers (microseconds) */
+      ULONG mServersTime;
+
+      /* Wall time of the whole connection (microseconds) */
+      ULONG mTotalTime;
+
+      /* Per-service breakdown, in ascending service order */
+      std::vector <sGobiQMIServiceStartup> mServices;
+};
+
 /*=========================================================================*/
 // Class cGobiQMICore
 /*=========================================================================*/
@@ -101,7 +795,32 @@ class cGobiQMICore
       // (Inline) Return the QMI database
       const cCoreDatabase & GetDatabase()
       {
-         return mDB;
+         return *mpDB;
+      };
+
+      // (Inline) Share the database, device list, reactor and worker 
+      // pool of the given manager (0 to revert), this must be set before
+      // the object is initialized
+      void SetDeviceManager( cGobiDeviceManager * pManager )
+      {
+         mpManager = pManager;
+      };
+
+      // (Inline) Return the service table entry of the given service type
+      // (0 if the service is not configured)
+      sGobiQMIServiceEntry * GetServiceEntry( eQMIService svc )
+      {
+         sGobiQMIServiceEntry * pEntry = 0;
+         if ((ULONG)svc < QMI_SERVICE_TABLE_SZ && mpServices != 0)
+         {
+            pEntry = &mpServices[svc];
+            if (pEntry->mpServer == 0)
+            {
+               pEntry = 0;
+            }
+         }
+
+         return pEntry;
       };
 
       // (Inline) Return the server as determined by the service type
@@ -109,17 +828,64 @@ class cGobiQMICore
       {
          cQMIProtocolServer * pSvr = 0;
 
-         std::map <eQMIService, cQMIProtocolServer *>::const_iterator pIter;
-         pIter = mServers.find( svc );
-
-         if (pIter != mServers.end())
+         sGobiQMIServiceEntry * pEntry = GetServiceEntry( svc );
+         if (pEntry != 0)
          {
-            pSvr = pIter->second;
+            pSvr = pEntry->mpServer;
          }
 
          return pSvr;
       };
 
+      // Return the request counters of the given service type
+      sGobiQMIServiceStats GetServiceStats( eQMIService svc );
+
+      // Return the per-message request statistics of the given service type
+      bool GetStatistics( 
+         eQMIService                            svc,
+         std::vector <sProtocolMessageStats> &  stats );
+
+      // Return the number of requests waiting to be sent (and of those 
+      // the number due) at each priority of the given service type
+      bool GetQueueDepths( 
+         eQMIService                svc,
+         std::vector <ULONG> &      pending,
+         std::vector <ULONG> &      due );
+
+      // (Inline) Return the startup time breakdown of the last connection
+      const sGobiQMIStartupTimes & GetStartupTimes()
+      {
+         return mStartupTimes;
+      };
+
+      // Log the request statistics of every service to syslog at the 
+      // given interval (milliseconds, 0 to stop)
+      void SetStatisticsDump( ULONG interval );
+
+      // Enable or disable adaptive response timeouts (early retransmission
+      // based on measured round trip times) on every service
+      void SetAdaptiveTimeouts( bool bAdaptive );
+
+      // Set the CPU affinity, scheduling class and name of the threads
+      // started for this object by role (the device node is appended to
+      // thread names), this must be set before initializing
+      void SetThreadConfig( const cThreadConfig & config );
+
+      // (Inline) Return the thread configuration
+      const cThreadConfig & GetThreadConfig()
+      {
+         return mThreadConfig;
+      };
+
+      // Bring the server of the given service up on the first request
+      // made on it rather than on Connect(), and take it down again once
+      // idle for the given time (milliseconds, 0 to keep it up once 
+      // started), this must be set before connecting
+      void SetServerOnDemand( 
+         eQMIService                svc,
+         bool                       bOnDemand,
+         ULONG                      idleTimeout = 0 );
+
       // (Inline) Clear last error recorded
       void ClearLastError()
       {
@@ -163,6 +929,13 @@ class cGobiQMICore
       typedef std::pair <std::string, std::string> tDeviceID;
       virtual std::vector <tDeviceID> GetAvailableDevices();
 
+      // Enumerate the Gobi devices present on the system
+      static std::vector <tDeviceID> EnumerateDevices();
+
+      // Enumerate the device nodes of the Gobi devices present on the 
+      // system (without reading their keys)
+      static std::vector <std::string> EnumerateDeviceNodes();
+
       // Return the type of the currently connected device
       GobiType GetDeviceType();
 
@@ -203,6 +976,69 @@ class cGobiQMICore
       // Cancel the most recent in-progress Send() based operation
       eGobiError CancelSend();
 
+      // Send a request using the specified QMI protocol server without
+      // waiting, the callback is run on the send executor with the outcome
+      ULONG SendAsync(
+         eQMIService                svc,
+         sSharedBuffer *            pRequest,
+         ULONG                      to,
+         cGobiQMISendCallback *     pCallback );
+
+      // Send several requests using the specified QMI protocol server at
+      // once without waiting (see SendAsync())
+      eGobiError SendBatch(
+         eQMIService                            svc,
+         const std::vector <sSharedBuffer *> &  requests,
+         ULONG                                  to,
+         cGobiQMISendCallback *                 pCallback,
+         std::vector <ULONG> &                  handles );
+
+      // Cancel an in-progress SendAsync()/SendBatch() request
+      eGobiError CancelAsync( ULONG handle );
+
+      // (Inline) Run asynchronous send callbacks on the given executor 
+      // rather than the internal completion thread (0 to revert), this
+      // must be set before any asynchronous send is made
+      void SetSendExecutor( cExecutor * pExecutor )
+      {
+         mpSendExecutor = pExecutor;
+      };
+
+      // Enable/disable the response cache of read-only requests
+      void SetResponseCache( bool bEnable );
+
+      // Cache responses to the given read-only request for the given
+      // time (milliseconds, 0 to stop caching the request)
+      void SetResponseCacheTTL(
+         eQMIService                svc,
+         WORD                       msgID,
+         ULONG                      ttl );
+
+      // Drop cached responses to the given request whenever the given
+      // indication is received
+      void AddResponseCacheInvalidation(
+         eQMIService                indSvc,
+         WORD                       indID,
+         eQMIService                svc,
+         WORD                       msgID );
+
+      // Drop every cached response
+      void ClearResponseCache();
+
+      // Save the static information of the connected device to the given
+      // snapshot file
+      eGobiError SaveDeviceInfoSnapshot( LPCSTR pFile );
+
+      // Seed the response cache from the given snapshot file, provided it
+      // was saved for the connected device and firmware revision
+      eGobiError LoadDeviceInfoSnapshot( LPCSTR pFile );
+
+      // Query the selected items of the device at once (every service's 
+      // queries are in flight together) and return them in one snapshot
+      eGobiError GetDeviceSnapshot(
+         ULONG                      mask,
+         sGobiDeviceSnapshot *      pSnapshot );
+
 #ifdef WDS_SUPPORT
       // Return the state of the current packet data session
       eGobiError GetSessionState( ULONG * pState );
@@ -256,6 +1092,25 @@ class cGobiQMICore
          BYTE                       userSize,
          CHAR *                     pUsername );
 
+      // Return the indices of the profiles of the given type
+      eGobiError GetProfileList(
+         ULONG                      profileType,
+         std::vector <BYTE> &       indices );
+
+      // Read every profile of the given type, the reads are pipelined
+      eGobiError GetProfiles(
+         ULONG                            profileType,
+         std::vector <sGobiProfile> &     profiles,
+         ULONG                            window = DEFAULT_GOBI_PROFILE_BATCH_WINDOW );
+
+      // Bring the given profiles on the device to the given settings, the
+      // profiles are read and only those that differ are written (both
+      // pipelined)
+      eGobiError ApplyProfiles(
+         std::vector <sGobiProfile> &     profiles,
+         ULONG *                          pWritten,
+         ULONG                            window = DEFAULT_GOBI_PROFILE_BATCH_WINDOW );
+
       // Activate a packet data session
       eGobiError StartDataSession( 
          ULONG *                    pTechnology, 
@@ -407,6 +1262,15 @@ class cGobiQMICore
          BYTE *                     pRATSize, 
          BYTE *                     pRATInstances );
 
+      // Start a scan for available networks without waiting, the networks
+      // found are passed to the callback
+      eGobiError StartNetworkScan( 
+         cGobiQMINetworkScanCallback *    pCallback,
+         ULONG &                          handle );
+
+      // Cancel a scan started by StartNetworkScan()
+      eGobiError CancelNetworkScan( ULONG handle );
+
       // Initiate a network registration
       eGobiError InitiateNetworkRegistration( 
          ULONG                      regType,
@@ -718,6 +1582,14 @@ class cGobiQMICore
          ULONG *                    pMessageSize, 
          BYTE *                     pMessage );
 
+      // Read several SMS messages from device memory, the reads are
+      // pipelined and each message passed to the callback as it arrives
+      eGobiError GetSMSBatch(
+         ULONG                         storageType,
+         const std::vector <ULONG> &   messageIndices,
+         cGobiQMISMSCallback *         pCallback,
+         ULONG                         window = DEFAULT_GOBI_SMS_BATCH_WINDOW );
+
       // Modify the status of an SMS message
       eGobiError ModifySMSStatus( 
          ULONG                      storageType, 
@@ -971,6 +1843,10 @@ class cGobiQMICore
       eGobiError DeleteStoredImage( 
          ULONG                      imageInfoSize, 
          BYTE *                     pImageInfo );
+
+      // Return the stored images, image preference and BAR mode of the 
+      // device (queried at once) matched against the host image store
+      eGobiError GetImageInventory( sGobiImageInventory & inventory );
 #endif
 
 #ifdef IMG2K_SUPPORT
@@ -1000,17 +1876,264 @@ class cGobiQMICore
 #endif
 
    protected:
+      // Record the transaction ID of an as-sent QMI_WDS_START_NET request
+      void CheckSentRequest(
+         eQMIService                svc,
+         const cProtocolLog &       protocolLog,
+         ULONG                      logIdx );
+
+      // Handle a protocol event for an asynchronous send
+      void AsyncSendEvent(
+         ULONG                      handle,
+         eProtocolEventType         eventType,
+         DWORD                      param1,
+         DWORD                      param2 );
+
+      // Outstanding asynchronous send
+      struct sAsyncSend
+      {
+         /* QMI service type */
+         eQMIService mSvc;
+
+         /* Protocol server request ID (INVALID_REQUEST_ID until added) */
+         ULONG mReqID;
+
+         /* Completion callback */
+         cGobiQMISendCallback * mpCallback;
+      };
+
+      // Queue the completion of an asynchronous send
+      void CompleteAsyncSend(
+         ULONG                      handle,
+         const sAsyncSend &         send,
+         eGobiError                 ec,
+         const sProtocolBuffer &    rsp );
+
+      // Complete every outstanding asynchronous send with the given error
+      void FailAsyncSends( eGobiError ec );
+
+      // Build the request/parse the response of the queries a device 
+      // snapshot is made of (shared with the individual query methods)
+      eGobiError ParseSessionState(
+         const sProtocolBuffer &    rsp,
+         ULONG *                    pState );
+
+      eGobiError ParseSignalStrengths( 
+         const sProtocolBuffer &    rsp,
+         ULONG                      maxSignals,
+         ULONG *                    pArraySizes, 
+         INT8 *                     pSignalStrengths, 
+         ULONG *                    pRadioInterfaces );
+
+      eGobiError ParseServingNetwork( 
+         const sProtocolBuffer &    rsp,
+         ULONG *                    pRegistrationState, 
+         ULONG *                    pCSDomain, 
+         ULONG *                    pPSDomain, 
+         ULONG *                    pRAN, 
+         BYTE                       maxRadioIfaces,
+         BYTE *                     pRadioIfacesSize, 
+         BYTE *                     pRadioIfaces, 
+         ULONG *                    pRoaming, 
+         WORD *                     pMCC, 
+         WORD *                     pMNC, 
+         BYTE                       nameSize, 
+         CHAR *                     pName );
+
+      eGobiError ParseDataBearerTechnology(
+         const sProtocolBuffer &    rsp,
+         ULONG *                    pDataBearer );
+
+      sSharedBuffer * BuildByteTotalsRequest();
+
+      eGobiError ParseByteTotals(
+         const sProtocolBuffer &    rsp,
+         ULONGLONG *                pTXTotalBytes, 
+         ULONGLONG *                pRXTotalBytes );
+
+      eGobiError ParsePowerInfo(
+         const sProtocolBuffer &    rsp,
+         ULONG *                    pPowerMode,
+         ULONG *                    pReasonMask,
+         ULONG *                    pbPlatform );
+
+      eGobiError ParseICCID(
+         const sProtocolBuffer &    rsp,
+         BYTE                       stringSize, 
+         CHAR *                     pString );
+
+      // Send the given WDS requests at once (see SendBatch()), with up to 
+      // a window of them awaiting a response at a time, and wait for every
+      // one of them
+      eGobiError SendProfileBatch(
+         const std::vector <sSharedBuffer *> &  requests,
+         ULONG                                  window,
+         cGobiQMIResponseCollector &            collector,
+         std::vector <ULONG> &                  handles );
+
+      // Read the settings of the given profiles (by type/index) at once
+      eGobiError ReadProfiles(
+         std::vector <sGobiProfile> &     profiles,
+         ULONG                            window );
+
+      // Parse a Get Profile Settings response into the given profile
+      eGobiError ParseProfile(
+         const sProtocolBuffer &    rsp,
+         sGobiProfile &             profile );
+
+      // Server startup work item (one per configured service)
+      struct sServerStartup
+      {
+         /* Server to initialize and connect */
+         cQMIProtocolServer * mpServer;
+
+         /* QMI control file and device MEID */
+         const std::string * mpControlFile;
+         const std::string * mpMEID;
+
+         /* Request statistics dump interval (0 for none) */
+         ULONG mStatsDumpInterval;
+
+         /* Use adaptive response timeouts? */
+         bool mbAdaptiveTimeouts;
+
+         /* Thread configuration of the server */
+         const cThreadConfig * mpThreadConfig;
+
+         /* Startup thread (0 if the item was run inline) */
+         pthread_t mThreadID;
+
+         /* Outcome */
+         sGobiQMIServiceStartup mResult;
+      };
+
+      // Initialize and connect a single server
+      static void * StartServer( void * pData );
+
+      // Return the service table entry of the given service type with the
+      // server up (starting it if on-demand), which is then held up until
+      // ReleaseServer() (0 if the service is not configured)
+      sGobiQMIServiceEntry * AcquireServer( eQMIService svc );
+
+      // Release a server held up by AcquireServer()
+      void ReleaseServer( sGobiQMIServiceEntry * pEntry );
+
+      // May the given on-demand service be taken down once idle? (to be
+      // overridden by objects that rely on device side state of a 
+      // service, such as enabled indications)
+      virtual bool IsServerReapable( eQMIService svc );
+
+      // Take down the on-demand servers idle for longer than their timeout
+      void ReapIdleServers();
+
+      // Idle on-demand server reaper thread
+      static void * ReaperThread( void * pData );
+
+      // Send a request using the specified QMI protocol server and wait
+      // for (and then return) the response, bypassing the response cache
+      sProtocolBuffer SendRequest(
+         eQMIService                svc,
+         sSharedBuffer *            pRequest,
+         ULONG                      to );
+
+      // Send a read-only request through the response cache
+      sProtocolBuffer SendCached(
+         eQMIService                svc,
+         sSharedBuffer *            pRequest,
+         ULONG                      to,
+         ULONG                      ttl );
+
+      // Return the response cache TTL of a request (0 if not cached)
+      ULONG GetResponseCacheTTL(
+         eQMIService                svc,
+         sSharedBuffer *            pRequest );
+
+      // Drop cached responses invalidated by indications received since
+      // the last scan (cache mutex must be held)
+      void ScanCacheInvalidations();
+
+      // Drop cached responses to the given request (cache mutex must be
+      // held)
+      void InvalidateCachedResponses( ULONG reqKey );
+
+      // Cache a response to a simple read-only request as if just received
+      void SeedCachedResponse(
+         eQMIService                svc,
+         WORD                       msgID,
+         const sProtocolBuffer &    rsp );
+
+      // Drop cached responses that rely on indications of the given
+      // service to be invalidated (its server is being taken down)
+      void InvalidateServiceCache( eQMIService svc );
+
+      // Cached (or in-flight) response to a read-only request
+      struct sCachedResponse
+      {
+         /* Request TLVs (hash collisions are not served) */
+         std::string mRequest;
+
+         /* Response (invalid while in-flight or upon failure) */
+         sProtocolBuffer mRsp;
+
+         /* Error recorded by the in-flight request */
+         eGobiError mError;
+
+         /* Expiry (GetTickCount() based, 0 if not to be served again) */
+         ULONGLONG mExpiry;
+
+         /* Is the request in-flight? */
+         bool mbInFlight;
+
+         /* Was the response invalidated while in-flight? */
+         bool mbStale;
+
+         /* Callers waiting on the in-flight request */
+         ULONG mWaiters;
+      };
+
+      // Record the outcome of a scheduled request in the service counters
+      void RecordServiceOutcome(
+         sGobiQMIServiceEntry *     pEntry,
+         eGobiError                 ec );
+
       /* Database used for packing/parsing QMI protocol entities */
       cCoreDatabase mDB;
 
+      /* Database in use (mDB or that of the device manager) */
+      const cCoreDatabase * mpDB;
+
+      /* Device manager providing shared resources (may be 0) */
+      cGobiDeviceManager * mpManager;
+
+      /* Executor for this device on the worker pool of mpManager */
+      cExecutor * mpManagerExecutor;
+
       /* Service type/service is required for object operation */
       typedef std::pair <eQMIService, bool> tServerConfig;
 
       /* Servers object is configured to support */
       std::set <tServerConfig> mServerConfig;
 
-      /* QMI protocol servers */
-      std::map <eQMIService, cQMIProtocolServer *> mServers;
+      /* QMI service table (QMI_SERVICE_TABLE_SZ entries) */
+      sGobiQMIServiceEntry * mpServices;
+
+      /* Services with a server in mpServices, in ascending order */
+      std::vector <eQMIService> mServiceIDs;
+
+      /* On-demand services (service type mapped to idle timeout) */
+      std::map <eQMIService, ULONG> mOnDemandServers;
+
+      /* Mutex protecting the startup/teardown of on-demand servers */
+      pthread_mutex_t mServerMutex;
+
+      /* Control file and MEID the on-demand servers connect with */
+      std::string mControlFile;
+      std::string mMEID;
+
+      /* Idle on-demand server reaper thread (0 if not running) and the
+         event telling it to exit */
+      pthread_t mReaperThreadID;
+      cEvent mReaperExitEvent;
 
       /* Fail connect attempts when multiple devices are present? */
       bool mbFailOnMultipleDevices;
@@ -1027,10 +2150,66 @@ class cGobiQMICore
       /* Last error recorded */
       eGobiError mLastError;
 
-      /* Outstanding requests */
+      /* Requests of the Send() calls in progress, most recent last 
+         (for CancelSend()) */
       typedef std::pair <eQMIService, ULONG> tServiceRequest;
-      cSyncQueue <tServiceRequest> mRequests;
+      std::vector <tServiceRequest> mRequests;
+
+      /* Mutex protecting mRequests */
+      pthread_mutex_t mRequestsMutex;
 
       /* Last recorded QMI_WDS_START_NET transaction ID */
       WORD mLastNetStartID;
+
+      /* Outstanding asynchronous sends (handle mapped to send) */
+      std::map <ULONG, sAsyncSend> mAsyncSends;
+
+      /* Last assigned asynchronous send handle */
+      ULONG mLastAsyncHandle;
+
+      /* Mutex protecting mAsyncSends */
+      pthread_mutex_t mAsyncMutex;
+
+      /* Internal completion thread for asynchronous sends */
+      cThreadExecutor mSendExecutor;
+
+      /* Executor asynchronous send callbacks are run on (0 = internal) */
+      cExecutor * mpSendExecutor;
+
+      /* Request statistics dump interval (0 for none) */
+      ULONG mStatsDumpInterval;
+
+      /* Use adaptive response timeouts on every service? */
+      bool mbAdaptiveTimeouts;
+
+      /* Thread configuration (device node set upon Connect()) */
+      cThreadConfig mThreadConfig;
+
+      /* Startup time breakdown of the last connection */
+      sGobiQMIStartupTimes mStartupTimes;
+
+      /* Is the response cache enabled? */
+      bool mbResponseCache;
+
+      /* Response cache TTLs (request key mapped to milliseconds) */
+      std::map <ULONG, ULONG> mCacheTTLs;
+
+      /* Cache invalidations (indication key mapped to request keys) */
+      std::multimap <ULONG, ULONG> mCacheInvalidations;
+
+      /* Cached responses (request key and TLV hash mapped to response) */
+      typedef std::pair <ULONG, ULONG> tCacheKey;
+      std::map <tCacheKey, sCachedResponse> mResponseCache;
+
+      /* Protocol log items scanned for invalidations, by service */
+      std::map <ULONG, ULONG> mCacheScanned;
+
+      /* Mutex protecting the response cache */
+      pthread_mutex_t mCacheMutex;
+
+      /* Condition signalled when an in-flight cached request completes */
+      pthread_cond_t mCacheCond;
+
+      // Asynchronous notifications get full access
+      friend class cGobiQMIAsyncNotification;
 };
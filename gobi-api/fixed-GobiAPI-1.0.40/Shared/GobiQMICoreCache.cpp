@@ -0,0 +1,1129 @@
+/*===========================================================================
+FILE: 
+   GobiQMICoreCache.cpp
+
+DESCRIPTION:
+   QUALCOMM Gobi QMI Based API Core (Response Cache)
+
+PUBLIC CLASSES AND FUNCTIONS:
+   cGobiQMICore
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+==========================================================================*/
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "StdAfx.h"
+#include "GobiQMICore.h"
+
+#include "CRC.h"
+#include "MemoryMappedFile.h"
+#include "QMIBuffers.h"
+
+//---------------------------------------------------------------------------
+// Definitions
+//---------------------------------------------------------------------------
+
+// Device information snapshot file identification ("GQDI") and version
+const ULONG DEVICE_SNAPSHOT_MAGIC = 0x49445147;
+const ULONG DEVICE_SNAPSHOT_VERSION = 1;
+
+// Static device information requests kept in a device information 
+// snapshot, the firmware revision is the one checked against the device
+const WORD DEVICE_SNAPSHOT_MSGS[] =
+{
+   (WORD)eQMI_DMS_GET_REV_ID,
+   (WORD)eQMI_DMS_GET_IDS,
+   (WORD)eQMI_DMS_GET_CAPS,
+   (WORD)eQMI_DMS_GET_MANUFACTURER,
+   (WORD)eQMI_DMS_GET_MODEL_ID,
+   (WORD)eQMI_DMS_GET_MSM_ID,
+   (WORD)eQMI_DMS_GET_PRL_VERSION
+};
+
+const ULONG DEVICE_SNAPSHOT_MSG_COUNT = 
+   (ULONG)(sizeof( DEVICE_SNAPSHOT_MSGS ) / sizeof( DEVICE_SNAPSHOT_MSGS[0] ));
+
+/*=========================================================================*/
+// Struct sDeviceSnapshotHeader
+//    Header of a device information snapshot file, followed by the MEID
+//    and then by the responses (each a sDeviceSnapshotEntry followed by
+//    the raw QMI response), the file ends with a CRC of everything before
+/*=========================================================================*/
+struct sDeviceSnapshotHeader
+{
+   ULONG mMagic;
+   ULONG mVersion;
+   ULONG mMEIDSize;
+   ULONG mEntryCount;
+};
+
+struct sDeviceSnapshotEntry
+{
+   WORD mService;
+   WORD mMessageID;
+   ULONG mSize;
+};
+
+/*===========================================================================
+METHOD:
+   MakeCacheKey (Free Method)
+
+DESCRIPTION:
+   Combine a QMI service type and message ID into a cache key
+
+PARAMETERS:
+   svc         [ I ] - QMI service type
+   msgID       [ I ] - QMI message ID
+
+RETURN VALUE:
+   ULONG
+===========================================================================*/
+static ULONG MakeCacheKey(
+   eQMIService                svc,
+   ULONG                      msgID )
+{
+   return ((ULONG)svc << 16) | (msgID & 0x0000FFFF);
+}
+
+/*===========================================================================
+METHOD:
+   GetRequestTLVs (Free Method)
+
+DESCRIPTION:
+   Locate the message ID and TLVs of a raw QMI request (without building
+   the TLV map of a sQMIServiceBuffer)
+
+PARAMETERS:
+   pRequest    [ I ] - Request
+   msgID       [ O ] - QMI message ID
+   pTLVs       [ O ] - TLVs of the request
+   tlvSz       [ O ] - Size of above TLVs
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+static bool GetRequestTLVs(
+   const sSharedBuffer *      pRequest,
+   ULONG &                    msgID,
+   const BYTE * &             pTLVs,
+   ULONG &                    tlvSz )
+{
+   const ULONG szTransHdr = (ULONG)sizeof(sQMIServiceRawTransactionHeader);
+   const ULONG szMsgHdr = (ULONG)sizeof(sQMIRawMessageHeader);
+
+   if (pRequest == 0 || pRequest->IsValid() == false)
+   {
+      return false;
+   }
+
+   const BYTE * pData = pRequest->GetBuffer();
+   ULONG sz = pRequest->GetSize();
+   if (sz < szTransHdr + szMsgHdr)
+   {
+      return false;
+   }
+
+   const sQMIRawMessageHeader * pMsgHdr = 0;
+   pMsgHdr = (const sQMIRawMessageHeader *)(pData + szTransHdr);
+   if ((ULONG)pMsgHdr->mLength > sz - szTransHdr - szMsgHdr)
+   {
+      return false;
+   }
+
+   msgID = (ULONG)pMsgHdr->mMessageID;
+   pTLVs = pData + szTransHdr + szMsgHdr;
+   tlvSz = (ULONG)pMsgHdr->mLength;
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   HashTLVs (Free Method)
+
+DESCRIPTION:
+   Hash the TLVs of a request (32-bit FNV-1a)
+
+PARAMETERS:
+   pTLVs       [ I ] - TLVs
+   tlvSz       [ I ] - Size of above TLVs
+
+RETURN VALUE:
+   ULONG
+===========================================================================*/
+static ULONG HashTLVs(
+   const BYTE *               pTLVs,
+   ULONG                      tlvSz )
+{
+   ULONG hash = 2166136261UL;
+   for (ULONG i = 0; i < tlvSz; i++)
+   {
+      hash ^= (ULONG)pTLVs[i];
+      hash = (hash * 16777619UL) & 0xFFFFFFFFUL;
+   }
+
+   return hash;
+}
+
+/*===========================================================================
+METHOD:
+   IsSameResponse (Free Method)
+
+DESCRIPTION:
+   Do two raw QMI responses carry the same message? (transaction IDs are
+   not compared)
+
+PARAMETERS:
+   rsp1        [ I ] - First response
+   rsp2        [ I ] - Second response
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+static bool IsSameResponse(
+   const sProtocolBuffer &    rsp1,
+   const sProtocolBuffer &    rsp2 )
+{
+   const ULONG szTransHdr = (ULONG)sizeof(sQMIServiceRawTransactionHeader);
+
+   ULONG sz = rsp1.GetSize();
+   if (sz < szTransHdr || sz != rsp2.GetSize())
+   {
+      return false;
+   }
+
+   return (memcmp( (LPCVOID)(rsp1.GetBuffer() + szTransHdr),
+                   (LPCVOID)(rsp2.GetBuffer() + szTransHdr),
+                   (size_t)(sz - szTransHdr) ) == 0);
+}
+
+/*===========================================================================
+METHOD:
+   IsSuccessResponse (Free Method)
+
+DESCRIPTION:
+   Is the given QMI response a successful one?
+
+PARAMETERS:
+   rsp         [ I ] - Response
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+static bool IsSuccessResponse( const sProtocolBuffer & rsp )
+{
+   if (rsp.IsValid() == false)
+   {
+      return false;
+   }
+
+   sQMIServiceBuffer qmiRsp( rsp.GetSharedBuffer() );
+
+   ULONG rc = 0;
+   ULONG ec = 0;
+   return ( (qmiRsp.IsValid() == true)
+        &&  (qmiRsp.GetResult( rc, ec ) == true)
+        &&  (rc == 0) );
+}
+
+/*=========================================================================*/
+// cGobiQMICore Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   SetResponseCache (Public Method)
+
+DESCRIPTION:
+   Enable/disable the response cache of read-only requests (disabling it
+   drops every cached response)
+
+PARAMETERS:
+   bEnable     [ I ] - Enable the cache?
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiQMICore::SetResponseCache( bool bEnable )
+{
+   pthread_mutex_lock( &mCacheMutex );
+   mbResponseCache = bEnable;
+   pthread_mutex_unlock( &mCacheMutex );
+
+   if (bEnable == false)
+   {
+      ClearResponseCache();
+   }
+}
+
+/*===========================================================================
+METHOD:
+   SetResponseCacheTTL (Public Method)
+
+DESCRIPTION:
+   Cache responses to the given read-only request for the given time,
+   requests are cached by service, message ID and contents
+
+PARAMETERS:
+   svc         [ I ] - QMI service type
+   msgID       [ I ] - QMI message ID of the request
+   ttl         [ I ] - Time to live (milliseconds, 0 to stop caching)
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiQMICore::SetResponseCacheTTL(
+   eQMIService                svc,
+   WORD                       msgID,
+   ULONG                      ttl )
+{
+   ULONG reqKey = MakeCacheKey( svc, msgID );
+
+   pthread_mutex_lock( &mCacheMutex );
+
+   if (ttl == 0)
+   {
+      mCacheTTLs.erase( reqKey );
+      InvalidateCachedResponses( reqKey );
+   }
+   else
+   {
+      mCacheTTLs[reqKey] = ttl;
+   }
+
+   pthread_mutex_unlock( &mCacheMutex );
+}
+
+/*===========================================================================
+METHOD:
+   AddResponseCacheInvalidation (Public Method)
+
+DESCRIPTION:
+   Drop cached responses to the given request whenever the given 
+   indication is received
+
+PARAMETERS:
+   indSvc      [ I ] - QMI service type of the indication
+   indID       [ I ] - QMI message ID of the indication
+   svc         [ I ] - QMI service type of the request
+   msgID       [ I ] - QMI message ID of the request
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiQMICore::AddResponseCacheInvalidation(
+   eQMIService                indSvc,
+   WORD                       indID,
+   eQMIService                svc,
+   WORD                       msgID )
+{
+   ULONG indKey = MakeCacheKey( indSvc, indID );
+   ULONG reqKey = MakeCacheKey( svc, msgID );
+
+   pthread_mutex_lock( &mCacheMutex );
+
+   std::multimap <ULONG, ULONG>::const_iterator pIter;
+   pIter = mCacheInvalidations.lower_bound( indKey );
+   while (pIter != mCacheInvalidations.upper_bound( indKey ))
+   {
+      if (pIter->second == reqKey)
+      {
+         // Already there
+         pthread_mutex_unlock( &mCacheMutex );
+         return;
+      }
+
+      pIter++;
+   }
+
+   mCacheInvalidations.insert( std::pair <ULONG, ULONG>( indKey, reqKey ) );
+   pthread_mutex_unlock( &mCacheMutex );
+}
+
+/*===========================================================================
+METHOD:
+   ClearResponseCache (Public Method)
+
+DESCRIPTION:
+   Drop every cached response (in-flight requests complete, but their 
+   responses are not cached)
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiQMICore::ClearResponseCache()
+{
+   pthread_mutex_lock( &mCacheMutex );
+
+   std::map <tCacheKey, sCachedResponse>::iterator pIter;
+   pIter = mResponseCache.begin();
+   while (pIter != mResponseCache.end())
+   {
+      sCachedResponse & entry = pIter->second;
+      if (entry.mbInFlight == true || entry.mWaiters > 0)
+      {
+         // Still referenced, the last user drops it
+         entry.mbStale = true;
+         entry.mExpiry = 0;
+         pIter++;
+      }
+      else
+      {
+         mResponseCache.erase( pIter++ );
+      }
+   }
+
+   // Indications already logged are of no further interest
+   std::map <ULONG, ULONG>::iterator pScanned = mCacheScanned.begin();
+   while (pScanned != mCacheScanned.end())
+   {
+      ULONG count = 0;
+      sGobiQMIServiceEntry * pEntry = GetServiceEntry( (eQMIService)pScanned->first );
+      if (pEntry != 0 && pEntry->mpLog != 0)
+      {
+         count = pEntry->mpLog->GetCount();
+         if (count == INVALID_LOG_INDEX)
+         {
+            count = 0;
+         }
+      }
+
+      pScanned->second = count;
+      pScanned++;
+   }
+
+   pthread_mutex_unlock( &mCacheMutex );
+}
+
+/*===========================================================================
+METHOD:
+   SaveDeviceInfoSnapshot (Public Method)
+
+DESCRIPTION:
+   Save the static information of the connected device (firmware revision,
+   serial numbers, capabilities, manufacturer, model, hardware revision and
+   PRL version) to a snapshot file, so that the next connection to the 
+   same device can load it with LoadDeviceInfoSnapshot() rather than query
+   each item
+
+   Items still cached are not queried again
+
+PARAMETERS:
+   pFile       [ I ] - Snapshot file
+
+RETURN VALUE:
+   eGobiError - Return code
+===========================================================================*/
+eGobiError cGobiQMICore::SaveDeviceInfoSnapshot( LPCSTR pFile )
+{
+   if (pFile == 0 || pFile[0] == 0)
+   {
+      return eGOBI_ERR_INVALID_ARG;
+   }
+
+   if (mMEID.size() == 0)
+   {
+      return eGOBI_ERR_NO_CONNECTION;
+   }
+
+   std::string data;
+
+   sDeviceSnapshotHeader hdr;
+   hdr.mMagic = DEVICE_SNAPSHOT_MAGIC;
+   hdr.mVersion = DEVICE_SNAPSHOT_VERSION;
+   hdr.mMEIDSize = (ULONG)mMEID.size();
+   hdr.mEntryCount = 0;
+
+   data.append( (LPCSTR)&hdr, sizeof( hdr ) );
+   data.append( mMEID );
+
+   // Only successful responses are kept (e.g. there is no PRL on every 
+   // device), but the firmware revision is needed to check the snapshot
+   for (ULONG m = 0; m < DEVICE_SNAPSHOT_MSG_COUNT; m++)
+   {
+      sProtocolBuffer rsp = SendSimple( eQMI_SVC_DMS, DEVICE_SNAPSHOT_MSGS[m] );
+      if (IsSuccessResponse( rsp ) == false)
+      {
+         if (DEVICE_SNAPSHOT_MSGS[m] == (WORD)eQMI_DMS_GET_REV_ID)
+         {
+            return (rsp.IsValid() == false 
+                    ? GetCorrectedLastError() : eGOBI_ERR_INVALID_RSP);
+         }
+
+         continue;
+      }
+
+      sDeviceSnapshotEntry entry;
+      entry.mService = (WORD)eQMI_SVC_DMS;
+      entry.mMessageID = DEVICE_SNAPSHOT_MSGS[m];
+      entry.mSize = rsp.GetSize();
+
+      data.append( (LPCSTR)&entry, sizeof( entry ) );
+      data.append( (LPCSTR)rsp.GetBuffer(), (std::string::size_type)entry.mSize );
+      hdr.mEntryCount++;
+   }
+
+   data.replace( 0, sizeof( hdr ), (LPCSTR)&hdr, sizeof( hdr ) );
+
+   // Room for the CRC
+   ULONG dataSz = (ULONG)data.size();
+   data.resize( data.size() + CRC_SIZE );
+   SetCRC( (PBYTE)&data[0], dataSz );
+
+   // Written aside and renamed, a reader never sees a partial snapshot
+   std::string tmpName = std::string( pFile ) + ".tmp";
+   int fd = open( tmpName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+   if (fd == -1)
+   {
+      return eGOBI_ERR_FILE_OPEN;
+   }
+
+   LPCSTR pData = data.c_str();
+   size_t remaining = data.size();
+
+   bool bRC = true;
+   while (bRC == true && remaining > 0)
+   {
+      ssize_t n = write( fd, pData, remaining );
+      if (n < 0 && errno == EINTR)
+      {
+         continue;
+      }
+
+      if (n <= 0)
+      {
+         bRC = false;
+         break;
+      }
+
+      pData += n;
+      remaining -= n;
+   }
+
+   if (close( fd ) != 0)
+   {
+      bRC = false;
+   }
+
+   if (bRC == true && rename( tmpName.c_str(), pFile ) != 0)
+   {
+      bRC = false;
+   }
+
+   if (bRC == false)
+   {
+      unlink( tmpName.c_str() );
+      return eGOBI_ERR_FILE_COPY;
+   }
+
+   return eGOBI_ERR_NONE;
+}
+
+/*===========================================================================
+METHOD:
+   LoadDeviceInfoSnapshot (Public Method)
+
+DESCRIPTION:
+   Seed the response cache with the static device information saved by
+   SaveDeviceInfoSnapshot(), provided the snapshot was saved for the 
+   connected device: the MEID (known since connecting) must match, and so
+   must the firmware revision, which is the only item queried
+
+   The seeded responses then live as long as any other cached response
+   (see SetResponseCacheTTL())
+
+PARAMETERS:
+   pFile       [ I ] - Snapshot file
+
+RETURN VALUE:
+   eGobiError - Return code (eGOBI_ERR_INVALID_FILE when the snapshot 
+                is corrupt or for another device/firmware)
+===========================================================================*/
+eGobiError cGobiQMICore::LoadDeviceInfoSnapshot( LPCSTR pFile )
+{
+   if (pFile == 0 || pFile[0] == 0)
+   {
+      return eGOBI_ERR_INVALID_ARG;
+   }
+
+   if (mMEID.size() == 0)
+   {
+      return eGOBI_ERR_NO_CONNECTION;
+   }
+
+   cMemoryMappedFile snapshotFile( pFile );
+
+   const BYTE * pData = (const BYTE *)snapshotFile.GetContents();
+   ULONG dataSz = snapshotFile.GetSize();
+   if (pData == 0 || dataSz == 0)
+   {
+      return eGOBI_ERR_FILE_OPEN;
+   }
+
+   if ( (dataSz < (ULONG)sizeof( sDeviceSnapshotHeader ) + CRC_SIZE)
+   ||   (CheckCRC( pData, dataSz ) == false) )
+   {
+      return eGOBI_ERR_INVALID_FILE;
+   }
+
+   // The header is copied out, the mapping need not be aligned
+   sDeviceSnapshotHeader hdr;
+   memcpy( (LPVOID)&hdr, (LPCVOID)pData, sizeof( hdr ) );
+
+   ULONG offset = (ULONG)sizeof( hdr );
+   ULONG endOffset = dataSz - CRC_SIZE;
+   if ( (hdr.mMagic != DEVICE_SNAPSHOT_MAGIC)
+   ||   (hdr.mVersion != DEVICE_SNAPSHOT_VERSION)
+   ||   (hdr.mMEIDSize > endOffset - offset) )
+   {
+      return eGOBI_ERR_INVALID_FILE;
+   }
+
+   std::string meid( (LPCSTR)pData + offset, (std::string::size_type)hdr.mMEIDSize );
+   offset += hdr.mMEIDSize;
+   if (meid != mMEID)
+   {
+      return eGOBI_ERR_INVALID_FILE;
+   }
+
+   // Parse everything before using any of it
+   std::vector <WORD> msgIDs;
+   std::vector <sProtocolBuffer> responses;
+   sProtocolBuffer savedRevision;
+   for (ULONG e = 0; e < hdr.mEntryCount; e++)
+   {
+      sDeviceSnapshotEntry entry;
+      if (endOffset - offset < (ULONG)sizeof( entry ))
+      {
+         return eGOBI_ERR_INVALID_FILE;
+      }
+
+      memcpy( (LPVOID)&entry, (LPCVOID)(pData + offset), sizeof( entry ) );
+      offset += (ULONG)sizeof( entry );
+      if ( (entry.mService != (WORD)eQMI_SVC_DMS)
+      ||   (entry.mSize > endOffset - offset) )
+      {
+         return eGOBI_ERR_INVALID_FILE;
+      }
+
+      sSharedBuffer * pBuf = new sSharedBuffer( pData + offset,
+                                                entry.mSize,
+                                                (ULONG)ePROTOCOL_QMI_DMS_RX );
+
+      sProtocolBuffer rsp( pBuf );
+      offset += entry.mSize;
+      if (IsSuccessResponse( rsp ) == false)
+      {
+         return eGOBI_ERR_INVALID_FILE;
+      }
+
+      if (entry.mMessageID == (WORD)eQMI_DMS_GET_REV_ID)
+      {
+         savedRevision = rsp;
+      }
+
+      msgIDs.push_back( entry.mMessageID );
+      responses.push_back( rsp );
+   }
+
+   if (offset != endOffset || savedRevision.IsValid() == false)
+   {
+      return eGOBI_ERR_INVALID_FILE;
+   }
+
+   // The one query: has the firmware changed since? (bypassing the cache,
+   // the revision must come from the device)
+   sSharedBuffer * pReq = sQMIServiceBuffer::BuildBuffer( eQMI_SVC_DMS, 
+                                                           eQMI_DMS_GET_REV_ID );
+   if (pReq == 0)
+   {
+      return eGOBI_ERR_MEMORY;
+   }
+
+   sProtocolBuffer revision = SendRequest( eQMI_SVC_DMS, 
+                                           pReq, 
+                                           DEFAULT_GOBI_QMI_TIMEOUT );
+   if (revision.IsValid() == false)
+   {
+      return GetCorrectedLastError();
+   }
+
+   if (IsSameResponse( revision, savedRevision ) == false)
+   {
+      return eGOBI_ERR_INVALID_FILE;
+   }
+
+   for (ULONG r = 0; r < (ULONG)responses.size(); r++)
+   {
+      if (msgIDs[r] == (WORD)eQMI_DMS_GET_REV_ID)
+      {
+         SeedCachedResponse( eQMI_SVC_DMS, msgIDs[r], revision );
+      }
+      else
+      {
+         SeedCachedResponse( eQMI_SVC_DMS, msgIDs[r], responses[r] );
+      }
+   }
+
+   return eGOBI_ERR_NONE;
+}
+
+/*===========================================================================
+METHOD:
+   GetResponseCacheTTL (Internal Method)
+
+DESCRIPTION:
+   Return the response cache TTL of a request
+
+PARAMETERS:
+   svc         [ I ] - QMI service type
+   pRequest    [ I ] - Request
+
+RETURN VALUE:
+   ULONG - TTL (milliseconds, 0 if the request is not cached)
+===========================================================================*/
+ULONG cGobiQMICore::GetResponseCacheTTL(
+   eQMIService                svc,
+   sSharedBuffer *            pRequest )
+{
+   ULONG msgID = 0;
+   const BYTE * pTLVs = 0;
+   ULONG tlvSz = 0;
+   if (GetRequestTLVs( pRequest, msgID, pTLVs, tlvSz ) == false)
+   {
+      return 0;
+   }
+
+   ULONG ttl = 0;
+   pthread_mutex_lock( &mCacheMutex );
+
+   if (mbResponseCache == true)
+   {
+      std::map <ULONG, ULONG>::const_iterator pIter;
+      pIter = mCacheTTLs.find( MakeCacheKey( svc, msgID ) );
+      if (pIter != mCacheTTLs.end())
+      {
+         ttl = pIter->second;
+      }
+   }
+
+   pthread_mutex_unlock( &mCacheMutex );
+   return ttl;
+}
+
+/*===========================================================================
+METHOD:
+   SendCached (Internal Method)
+
+DESCRIPTION:
+   Send a read-only request through the response cache: a fresh cached 
+   response is returned as-is, a request identical to one in-flight waits
+   for (and shares) its response, anything else is sent and its 
+   (successful) response cached
+
+PARAMETERS:
+   svc         [ I ] - QMI service type
+   pRequest    [ I ] - Request to schedule
+   to          [ I ] - Timeout value (in milliseconds)
+   ttl         [ I ] - Time to live of the response (in milliseconds)
+
+RETURN VALUE:
+   sProtocolBuffer - The response (invalid when no response was received)
+===========================================================================*/
+sProtocolBuffer cGobiQMICore::SendCached(
+   eQMIService                svc,
+   sSharedBuffer *            pRequest,
+   ULONG                      to,
+   ULONG                      ttl )
+{
+   ULONG msgID = 0;
+   const BYTE * pTLVs = 0;
+   ULONG tlvSz = 0;
+   if (GetRequestTLVs( pRequest, msgID, pTLVs, tlvSz ) == false)
+   {
+      return SendRequest( svc, pRequest, to );
+   }
+
+   // The request is owned from here on, dropped unless it is sent
+   sProtocolBuffer req( pRequest );
+
+   std::string tlvs( (LPCSTR)pTLVs, (std::string::size_type)tlvSz );
+   tCacheKey key( MakeCacheKey( svc, msgID ), HashTLVs( pTLVs, tlvSz ) );
+
+   pthread_mutex_lock( &mCacheMutex );
+
+   ScanCacheInvalidations();
+
+   std::map <tCacheKey, sCachedResponse>::iterator pIter;
+   pIter = mResponseCache.find( key );
+   if (pIter != mResponseCache.end())
+   {
+      sCachedResponse & entry = pIter->second;
+      if (entry.mRequest != tlvs)
+      {
+         // Hash collision, leave the cached response be
+         pthread_mutex_unlock( &mCacheMutex );
+         return SendRequest( svc, pRequest, to );
+      }
+
+      if (entry.mbInFlight == true)
+      {
+         // Share the response of the identical in-flight request
+         entry.mWaiters++;
+         while (entry.mbInFlight == true)
+         {
+            pthread_cond_wait( &mCacheCond, &mCacheMutex );
+         }
+
+         entry.mWaiters--;
+
+         sProtocolBuffer rsp = entry.mRsp;
+         eGobiError ec = entry.mError;
+         if ( (entry.mWaiters == 0)
+         &&   (entry.mbInFlight == false)
+         &&   (entry.mExpiry == 0) )
+         {
+            mResponseCache.erase( pIter );
+         }
+
+         pthread_mutex_unlock( &mCacheMutex );
+
+         mLastError = ec;
+         return rsp;
+      }
+
+      if (entry.mRsp.IsValid() == true && GetTickCount() < entry.mExpiry)
+      {
+         // Cache hit
+         sProtocolBuffer rsp = entry.mRsp;
+         pthread_mutex_unlock( &mCacheMutex );
+
+         ClearLastError();
+         return rsp;
+      }
+   }
+   else
+   {
+      sCachedResponse entry;
+      entry.mRequest = tlvs;
+      entry.mError = eGOBI_ERR_NONE;
+      entry.mExpiry = 0;
+      entry.mbInFlight = false;
+      entry.mbStale = false;
+      entry.mWaiters = 0;
+
+      pIter = mResponseCache.insert( 
+         std::pair <tCacheKey, sCachedResponse>( key, entry ) ).first;
+   }
+
+   // Send the request on behalf of everyone asking for it meanwhile (the
+   // entry is not dropped while in-flight)
+   sCachedResponse & entry = pIter->second;
+   entry.mbInFlight = true;
+   entry.mbStale = false;
+   entry.mRsp = sProtocolBuffer();
+   entry.mExpiry = 0;
+
+   pthread_mutex_unlock( &mCacheMutex );
+
+   sProtocolBuffer rsp = SendRequest( svc, pRequest, to );
+   eGobiError ec = mLastError;
+
+   // Only successful responses are cached
+   bool bCache = false;
+   if (rsp.IsValid() == true)
+   {
+      sQMIServiceBuffer qmiRsp( rsp.GetSharedBuffer() );
+
+      ULONG rc = 0;
+      ULONG qmiEC = 0;
+      if ( (qmiRsp.IsValid() == true)
+      &&   (qmiRsp.GetResult( rc, qmiEC ) == true)
+      &&   (rc == 0) )
+      {
+         bCache = true;
+      }
+   }
+
+   pthread_mutex_lock( &mCacheMutex );
+
+   entry.mbInFlight = false;
+   entry.mRsp = rsp;
+   entry.mError = ec;
+   if (bCache == true && entry.mbStale == false)
+   {
+      entry.mExpiry = GetTickCount() + (ULONGLONG)ttl;
+   }
+   else
+   {
+      entry.mExpiry = 0;
+   }
+
+   if (entry.mWaiters > 0)
+   {
+      pthread_cond_broadcast( &mCacheCond );
+   }
+   else if (entry.mExpiry == 0)
+   {
+      mResponseCache.erase( pIter );
+   }
+
+   pthread_mutex_unlock( &mCacheMutex );
+
+   mLastError = ec;
+   return rsp;
+}
+
+/*===========================================================================
+METHOD:
+   SeedCachedResponse (Internal Method)
+
+DESCRIPTION:
+   Cache a response to a simple (TLV-less) read-only request as if it had
+   just been received, unless the request is not cached or is in-flight
+
+PARAMETERS:
+   svc         [ I ] - QMI service type
+   msgID       [ I ] - QMI message ID of the request
+   rsp         [ I ] - Response
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiQMICore::SeedCachedResponse(
+   eQMIService                svc,
+   WORD                       msgID,
+   const sProtocolBuffer &    rsp )
+{
+   ULONG reqKey = MakeCacheKey( svc, msgID );
+   tCacheKey key( reqKey, HashTLVs( 0, 0 ) );
+
+   pthread_mutex_lock( &mCacheMutex );
+
+   std::map <ULONG, ULONG>::const_iterator pTTL = mCacheTTLs.find( reqKey );
+   if (mbResponseCache == false || pTTL == mCacheTTLs.end())
+   {
+      pthread_mutex_unlock( &mCacheMutex );
+      return;
+   }
+
+   std::map <tCacheKey, sCachedResponse>::iterator pIter;
+   pIter = mResponseCache.find( key );
+   if (pIter == mResponseCache.end())
+   {
+      sCachedResponse entry;
+      entry.mWaiters = 0;
+
+      pIter = mResponseCache.insert( 
+         std::pair <tCacheKey, sCachedResponse>( key, entry ) ).first;
+   }
+   else if (pIter->second.mbInFlight == true || pIter->second.mWaiters > 0)
+   {
+      pthread_mutex_unlock( &mCacheMutex );
+      return;
+   }
+
+   sCachedResponse & entry = pIter->second;
+   entry.mRequest.clear();
+   entry.mRsp = rsp;
+   entry.mError = eGOBI_ERR_NONE;
+   entry.mExpiry = GetTickCount() + (ULONGLONG)pTTL->second;
+   entry.mbInFlight = false;
+   entry.mbStale = false;
+
+   pthread_mutex_unlock( &mCacheMutex );
+}
+
+/*===========================================================================
+METHOD:
+   ScanCacheInvalidations (Internal Method)
+
+DESCRIPTION:
+   Drop cached responses invalidated by indications received since the 
+   last scan, only indication headers are looked at (when indications 
+   have been evicted from a protocol log unseen everything they could
+   have invalidated is dropped)
+
+SEQUENCING:
+   The cache mutex must be held
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiQMICore::ScanCacheInvalidations()
+{
+   if (mCacheInvalidations.empty() == true || mResponseCache.empty() == true)
+   {
+      return;
+   }
+
+   ULONG lastSvc = ULONG_MAX;
+   std::multimap <ULONG, ULONG>::const_iterator pRule;
+   for (pRule = mCacheInvalidations.begin(); 
+        pRule != mCacheInvalidations.end(); 
+        pRule++)
+   {
+      // Each service log is scanned once
+      ULONG svc = pRule->first >> 16;
+      if (svc == lastSvc)
+      {
+         continue;
+      }
+
+      lastSvc = svc;
+
+      sGobiQMIServiceEntry * pEntry = GetServiceEntry( (eQMIService)svc );
+      if (pEntry == 0 || pEntry->mpLog == 0)
+      {
+         continue;
+      }
+
+      const cProtocolLog & log = *pEntry->mpLog;
+      ULONG count = log.GetCount();
+      if (count == INVALID_LOG_INDEX)
+      {
+         continue;
+      }
+
+      ULONG & scanned = mCacheScanned[svc];
+      if (count == scanned)
+      {
+         continue;
+      }
+
+      // Missed any indications? (the log was cleared or lapped us)
+      ULONG first = log.GetFirstIndex();
+      if (count < scanned || (first != INVALID_LOG_INDEX && first > scanned))
+      {
+         std::multimap <ULONG, ULONG>::const_iterator pMissed = pRule;
+         while (pMissed != mCacheInvalidations.end()
+         &&     (pMissed->first >> 16) == svc)
+         {
+            InvalidateCachedResponses( pMissed->second );
+            pMissed++;
+         }
+
+         scanned = (count < scanned ? 0 : first);
+      }
+
+      for (ULONG i = scanned; i < count; i++)
+      {
+         sProtocolBuffer buf;
+         if (log.GetBuffer( i, buf ) == false)
+         {
+            continue;
+         }
+
+         ULONG indID = ULONG_MAX;
+         if (sQMIServiceBuffer::GetIndicationID( buf, indID ) == false)
+         {
+            continue;
+         }
+
+         ULONG indKey = MakeCacheKey( (eQMIService)svc, indID );
+         std::multimap <ULONG, ULONG>::const_iterator pMatch;
+         pMatch = mCacheInvalidations.lower_bound( indKey );
+         while (pMatch != mCacheInvalidations.upper_bound( indKey ))
+         {
+            InvalidateCachedResponses( pMatch->second );
+            pMatch++;
+         }
+      }
+
+      scanned = count;
+   }
+}
+
+/*===========================================================================
+METHOD:
+   InvalidateCachedResponses (Internal Method)
+
+DESCRIPTION:
+   Drop cached responses to the given request (in-flight requests complete,
+   but their responses are not cached)
+
+PARAMETERS:
+   reqKey      [ I ] - Cache key of the request (service and message ID)
+
+SEQUENCING:
+   The cache mutex must be held
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiQMICore::InvalidateCachedResponses( ULONG reqKey )
+{
+   std::map <tCacheKey, sCachedResponse>::iterator pIter;
+   pIter = mResponseCache.lower_bound( tCacheKey( reqKey, 0 ) );
+   while (pIter != mResponseCache.end() && pIter->first.first == reqKey)
+   {
+      sCachedResponse & entry = pIter->second;
+      if (entry.mbInFlight == true || entry.mWaiters > 0)
+      {
+         // Still referenced, the last user drops it
+         entry.mbStale = true;
+         entry.mExpiry = 0;
+         pIter++;
+      }
+      else
+      {
+         mResponseCache.erase( pIter++ );
+      }
+   }
+}
+
+/*===========================================================================
+METHOD:
+   InvalidateServiceCache (Internal Method)
+
+DESCRIPTION:
+   Drop cached responses that rely on indications of the given service to
+   be invalidated, as those won't be received while its server is down
+
+PARAMETERS:
+   svc         [ I ] - QMI service type
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiQMICore::InvalidateServiceCache( eQMIService svc )
+{
+   pthread_mutex_lock( &mCacheMutex );
+
+   std::multimap <ULONG, ULONG>::const_iterator pRule;
+   pRule = mCacheInvalidations.lower_bound( MakeCacheKey( svc, 0 ) );
+   while ( (pRule != mCacheInvalidations.end())
+   &&      ((pRule->first >> 16) == (ULONG)svc) )
+   {
+      InvalidateCachedResponses( pRule->second );
+      pRule++;
+   }
+
+   pthread_mutex_unlock( &mCacheMutex );
+}
@@ -43,6 +43,7 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "GobiQMICore.h"
 
 #include "QMIBuffers.h"
+#include "QMIViewsDMS.h"
 
 //---------------------------------------------------------------------------
 // Definitions
@@ -127,7 +128,7 @@ eGobiError cGobiQMICore::GetDeviceCapabilities(
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (by DB key)
@@ -222,7 +223,7 @@ eGobiError cGobiQMICore::GetManufacturer(
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (by DB key)
@@ -308,7 +309,7 @@ eGobiError cGobiQMICore::GetModelID(
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (by DB key)
@@ -394,7 +395,7 @@ eGobiError cGobiQMICore::GetFirmwareRevision(
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (PRI revision)
@@ -491,7 +492,7 @@ eGobiError cGobiQMICore::GetFirmwareRevisions(
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (PRI revision)
@@ -619,7 +620,7 @@ eGobiError cGobiQMICore::GetVoiceNumber(
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (by DB key)
@@ -726,7 +727,7 @@ eGobiError cGobiQMICore::GetIMSI(
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (IMSI)
@@ -828,7 +829,7 @@ eGobiError cGobiQMICore::GetSerialNumbers(
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the optional TLV we want (by DB key)
@@ -982,8 +983,9 @@ eGobiError cGobiQMICore::QueryLock( ULONG * pState )
       return GetCorrectedLastError();
    }
 
-   // Did we receive a valid QMI response?
-   sQMIServiceBuffer qmiRsp( rsp.GetSharedBuffer() );
+   // Did we receive a valid QMI response? (decoded through the static
+   // view instead of the database, this is polled frequently)
+   cQMIViewDMSGetUserLockStateRsp qmiRsp( rsp );
    if (qmiRsp.IsValid() == false)
    {
       return eGOBI_ERR_MALFORMED_RSP;
@@ -1002,20 +1004,15 @@ eGobiError cGobiQMICore::QueryLock( ULONG * pState )
       return GetCorrectedQMIError( ec );
    }
 
-   // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
-   const cCoreDatabase & db = GetDatabase();
-
-   // Parse the TLV we want (by DB key)
-   sProtocolEntityKey tlvKey( eDB2_ET_QMI_DMS_RSP, msgID, 1 );
-   cDataParser::tParsedFields pf = ParseTLV( db, rsp, tlvs, tlvKey );
-   if (pf.size() < 1) 
+   // Parse the TLV we want
+   BYTE state = 0;
+   if (qmiRsp.GetEnabled( state ) == false)
    {
       return eGOBI_ERR_INVALID_RSP;
    }
 
    // Populate the mode
-   *pState = pf[0].mValue.mU32;
+   *pState = (ULONG)state;
    return eGOBI_ERR_NONE;
 }
 
@@ -1148,7 +1145,7 @@ eGobiError cGobiQMICore::GetHardwareRevision(
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (by DB key)
@@ -1207,8 +1204,9 @@ eGobiError cGobiQMICore::GetPRLVersion( WORD * pPRLVersion )
       return GetCorrectedLastError();
    }
 
-   // Did we receive a valid QMI response?
-   sQMIServiceBuffer qmiRsp( rsp.GetSharedBuffer() );
+   // Did we receive a valid QMI response? (decoded through the static
+   // view instead of the database, this is polled frequently)
+   cQMIViewDMSGetPRLVersionRsp qmiRsp( rsp );
    if (qmiRsp.IsValid() == false)
    {
       return eGOBI_ERR_MALFORMED_RSP;
@@ -1227,19 +1225,14 @@ eGobiError cGobiQMICore::GetPRLVersion( WORD * pPRLVersion )
       return GetCorrectedQMIError( ec );
    }
 
-   // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
-   const cCoreDatabase & db = GetDatabase();
-
-   // Parse the TLV we want (by DB key)
-   sProtocolEntityKey tlvKey( eDB2_ET_QMI_DMS_RSP, msgID, 1 );
-   cDataParser::tParsedFields pf = ParseTLV( db, rsp, tlvs, tlvKey );
-   if (pf.size() < 1) 
+   // Parse the TLV we want
+   WORD version = 0;
+   if (qmiRsp.GetVersion( version ) == false)
    {
       return eGOBI_ERR_INVALID_RSP;
    }
 
-   *pPRLVersion = pf[0].mValue.mU16;
+   *pPRLVersion = version;
    return eGOBI_ERR_NONE;
 }
 
@@ -1303,7 +1296,7 @@ eGobiError cGobiQMICore::GetERIFile(
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (by DB key)
@@ -1697,8 +1690,9 @@ eGobiError cGobiQMICore::GetActivationState( ULONG * pActivationState )
       return GetCorrectedLastError();
    }
 
-   // Did we receive a valid QMI response?
-   sQMIServiceBuffer qmiRsp( rsp.GetSharedBuffer() );
+   // Did we receive a valid QMI response? (decoded through the static
+   // view instead of the database, this is polled frequently)
+   cQMIViewDMSGetActivationStateRsp qmiRsp( rsp );
    if (qmiRsp.IsValid() == false)
    {
       return eGOBI_ERR_MALFORMED_RSP;
@@ -1717,19 +1711,14 @@ eGobiError cGobiQMICore::GetActivationState( ULONG * pActivationState )
       return GetCorrectedQMIError( ec );
    }
 
-   // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
-   const cCoreDatabase & db = GetDatabase();
-
-   // Parse the TLV we want (by DB key)
-   sProtocolEntityKey tlvKey( eDB2_ET_QMI_DMS_RSP, msgID, 1 );
-   cDataParser::tParsedFields pf = ParseTLV( db, rsp, tlvs, tlvKey );
-   if (pf.size() < 1) 
+   // Parse the TLV we want
+   WORD state = 0;
+   if (qmiRsp.GetInfo( state ) == false)
    {
       return eGOBI_ERR_INVALID_RSP;
    }
 
-   *pActivationState = pf[0].mValue.mU32;
+   *pActivationState = (ULONG)state;
    return eGOBI_ERR_NONE;
 }
 
@@ -1833,8 +1822,35 @@ eGobiError cGobiQMICore::GetPowerInfo(
       return GetCorrectedLastError();
    }
 
-   // Did we receive a valid QMI response?
-   sQMIServiceBuffer qmiRsp( rsp.GetSharedBuffer() );
+   return ParsePowerInfo( rsp, pPowerMode, pReasonMask, pbPlatform );
+}
+
+/*===========================================================================
+METHOD:
+   ParsePowerInfo (Internal Method)
+
+DESCRIPTION:
+   Parse the response of a GetPowerInfo() request (also used by 
+   GetDeviceSnapshot())
+
+PARAMETERS:
+   rsp         [ I ] - QMI response
+   pPowerMode  [ O ] - Current operating mode
+   pReasonMask [ O ] - Offline reason bitmask (left as is when absent)
+   pbPlatform  [ O ] - Platform restricted? (left as is when absent)
+
+RETURN VALUE:
+   eGobiError - Return code
+===========================================================================*/
+eGobiError cGobiQMICore::ParsePowerInfo(
+   const sProtocolBuffer &    rsp,
+   ULONG *                    pPowerMode,
+   ULONG *                    pReasonMask,
+   ULONG *                    pbPlatform )
+{
+   // Did we receive a valid QMI response? (decoded through the static
+   // view instead of the database, this is polled frequently)
+   cQMIViewDMSGetOperatingModeRsp qmiRsp( rsp );
    if (qmiRsp.IsValid() == false)
    {
       return eGOBI_ERR_MALFORMED_RSP;
@@ -1853,43 +1869,27 @@ eGobiError cGobiQMICore::GetPowerInfo(
       return GetCorrectedQMIError( ec );
    }
 
-   // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
-   const cCoreDatabase & db = GetDatabase();
-
-   // Parse the TLV we want (by DB key)
-   sProtocolEntityKey tlvKey( eDB2_ET_QMI_DMS_RSP, msgID, 1 );
-   cDataParser::tParsedFields pf = ParseTLV( db, rsp, tlvs, tlvKey );
-   if (pf.size() < 1) 
+   // Parse the TLV we want
+   BYTE mode = 0;
+   if (qmiRsp.GetMode( mode ) == false)
    {
       return eGOBI_ERR_INVALID_RSP;
    }
 
-   *pPowerMode = pf[0].mValue.mU32;
+   *pPowerMode = (ULONG)mode;
 
-   // Parse the TLV we want (by DB key)
-   tlvKey = sProtocolEntityKey( eDB2_ET_QMI_DMS_RSP, msgID, 16 );
-   pf = ParseTLV( db, rsp, tlvs, tlvKey );
-   
-   // Convert back to a bitmask
-   ULONG fieldCount = (ULONG)pf.size();
-   if (fieldCount > 16)
+   // Parse the (optional) offline reason bitmask
+   WORD reasonMask = 0;
+   if (qmiRsp.GetOfflineReason( reasonMask ) == true)
    {
-      fieldCount = 16;
+      *pReasonMask = (ULONG)reasonMask;
    }
 
-   for (ULONG f = 0; f < fieldCount; f++)
-   {  
-      ULONG val = (ULONG)pf[f].mValue.mU8 & 0x00000001;
-      *pReasonMask |= (val << f);
-   }
-
-   // Parse the TLV we want (by DB key)
-   tlvKey = sProtocolEntityKey( eDB2_ET_QMI_DMS_RSP, msgID, 17 );
-   pf = ParseTLV( db, rsp, tlvs, tlvKey );
-   if (pf.size() >= 1) 
+   // Parse the (optional) platform restriction
+   BYTE bPlatform = 0;
+   if (qmiRsp.GetHardwareRestrictedMode( bPlatform ) == true)
    {
-      *pbPlatform = (ULONG)pf[0].mValue.mU8;
+      *pbPlatform = (ULONG)bPlatform;
    }
 
    return eGOBI_ERR_NONE;
@@ -1963,8 +1963,9 @@ eGobiError cGobiQMICore::GetNetworkTime(
       return GetCorrectedLastError();
    }
 
-   // Did we receive a valid QMI response?
-   sQMIServiceBuffer qmiRsp( rsp.GetSharedBuffer() );
+   // Did we receive a valid QMI response? (decoded through the static
+   // view instead of the database, this is polled frequently)
+   cQMIViewDMSGetTimeRsp qmiRsp( rsp );
    if (qmiRsp.IsValid() == false)
    {
       return eGOBI_ERR_MALFORMED_RSP;
@@ -1983,20 +1984,19 @@ eGobiError cGobiQMICore::GetNetworkTime(
       return GetCorrectedQMIError( ec );
    }
 
-   // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
-   const cCoreDatabase & db = GetDatabase();
-
-   // Parse the TLV we want (by DB key)
-   sProtocolEntityKey tlvKey( eDB2_ET_QMI_DMS_RSP, msgID, 1 );
-   cDataParser::tParsedFields pf = ParseTLV( db, rsp, tlvs, tlvKey );
-   if (pf.size() < 1) 
+   // Parse the TLV we want
+   cQMIViewDMSGetTimeRsp::sDeviceTime deviceTime;
+   ULONGLONG timeCount = 0;
+   WORD timeSource = 0;
+   if ( (qmiRsp.GetDeviceTime( deviceTime ) == false)
+   ||   (deviceTime.GetTimeCount( timeCount ) == false)
+   ||   (deviceTime.GetTimeSource( timeSource ) == false) )
    {
       return eGOBI_ERR_INVALID_RSP;
    }
 
-   *pTimeCount = pf[0].mValue.mU64;
-   *pTimeSource = pf[1].mValue.mU32;
+   *pTimeCount = timeCount;
+   *pTimeSource = (ULONG)timeSource;
    return eGOBI_ERR_NONE;
 }
 
@@ -43,6 +43,120 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "GobiQMICore.h"
 
 #include "QMIBuffers.h"
+#include "QMIView.h"
+
+//---------------------------------------------------------------------------
+// Definitions
+//---------------------------------------------------------------------------
+
+// Timeout for the (concurrent) image inventory queries
+const ULONG GOBI_IMAGE_INVENTORY_TIMEOUT = 5000;
+
+/*=========================================================================*/
+// Free Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   GetInventoryTLV (Free Method)
+
+DESCRIPTION:
+   Check an image inventory query response for success and return the 
+   value of the given TLV
+
+PARAMETERS:
+   core        [ I ] - Core object that issued the query
+   rsp         [ I ] - Response
+   typeID      [ I ] - Type ID of the TLV
+   tlv         [ O ] - Value of the TLV
+
+RETURN VALUE:
+   eGobiError - Return code
+===========================================================================*/
+static eGobiError GetInventoryTLV(
+   cGobiQMICore &             core,
+   const sProtocolBuffer &    rsp,
+   ULONG                      typeID,
+   sQMIView &                 tlv )
+{
+   // Did we receive a valid QMI response?
+   sQMIServiceBuffer qmiRsp( rsp.GetSharedBuffer() );
+   if (qmiRsp.IsValid() == false)
+   {
+      return eGOBI_ERR_MALFORMED_RSP;
+   }
+
+   // Check the mandatory QMI result TLV for success
+   ULONG rc = 0;
+   ULONG ec = 0;
+   bool bResult = qmiRsp.GetResult( rc, ec );
+   if (bResult == false)
+   {
+      return eGOBI_ERR_MALFORMED_RSP;
+   }
+   else if (rc != 0)
+   {
+      return core.GetCorrectedQMIError( ec );
+   }
+
+   const sQMIContents & tlvs = qmiRsp.GetContents();
+
+   const sQMIRawContentHeader * pHdr = 0;
+   pHdr = tlvs.Find( typeID );
+   if (pHdr == 0)
+   {
+      return eGOBI_ERR_INVALID_RSP;
+   }
+
+   tlv = sQMIView( (const BYTE *)(pHdr + 1), (ULONG)pHdr->mLength );
+   return eGOBI_ERR_NONE;
+}
+
+/*===========================================================================
+METHOD:
+   ReadInventoryImageID (Free Method)
+
+DESCRIPTION:
+   Read the unique ID and (length prefixed) build ID of an image in an 
+   image list, advancing the offset past them
+
+PARAMETERS:
+   view        [ I ] - Image list
+   offset      [I/O] - Offset of the unique ID
+   entry       [ O ] - Image receiving the IDs
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+static bool ReadInventoryImageID(
+   const sQMIView &           view,
+   ULONG &                    offset,
+   sGobiImageEntry &          entry )
+{
+   if (view.Has( offset, MBN_UNIQUE_ID_LEN + 1 ) == false)
+   {
+      return false;
+   }
+
+   memcpy( (LPVOID)&entry.mImageID[0],
+           (LPCVOID)(view.GetData() + offset),
+           (SIZE_T)MBN_UNIQUE_ID_LEN );
+
+   offset += MBN_UNIQUE_ID_LEN;
+
+   ULONG buildLen = 0;
+   sQMIInt <ULONG, 1>::Read( view, offset++, buildLen );
+
+   sQMIView build = view.Sub( offset, buildLen );
+   if (build.IsValid() == false)
+   {
+      return false;
+   }
+
+   entry.mBuildID = build.ToString();
+   offset += buildLen;
+   return true;
+}
 
 /*=========================================================================*/
 // cGobiQMICore Methods
@@ -108,18 +222,16 @@ eGobiError cGobiQMICore::GetImagesPreference(
    }
 
    // Try to find TLV ID 1
-   std::map <ULONG, const sQMIRawContentHeader *> tlvs;
-   tlvs = qmiRsp.GetContents();
+   const sQMIContents & tlvs = qmiRsp.GetContents();
 
-   std::map <ULONG, const sQMIRawContentHeader *>::const_iterator pIter;
-   pIter = tlvs.find( 1 );
-   if (pIter == tlvs.end())
+   const sQMIRawContentHeader * pHdr = 0;
+   pHdr = tlvs.Find( 1 );
+   if (pHdr == 0)
    {
       return eGOBI_ERR_INVALID_RSP;
    }
 
    // Enough space to copy result?
-   const sQMIRawContentHeader * pHdr = pIter->second;
    ULONG needSz = (ULONG)pHdr->mLength;
    if (needSz == 0)
    {
@@ -242,18 +354,16 @@ eGobiError cGobiQMICore::SetImagesPreference(
    }
 
    // Try to find TLV ID 1
-   std::map <ULONG, const sQMIRawContentHeader *> tlvs;
-   tlvs = qmiRsp.GetContents();
+   const sQMIContents & tlvs = qmiRsp.GetContents();
 
-   std::map <ULONG, const sQMIRawContentHeader *>::const_iterator pIter;
-   pIter = tlvs.find( 1 );
-   if (pIter == tlvs.end())
+   const sQMIRawContentHeader * pHdr = 0;
+   pHdr = tlvs.Find( 1 );
+   if (pHdr == 0)
    {
       return eGOBI_ERR_INVALID_RSP;
    }
 
    // Enough space to copy result?
-   const sQMIRawContentHeader * pHdr = pIter->second;
    ULONG dataLen = (ULONG)pHdr->mLength;
    if (dataLen == 0)
    {
@@ -334,7 +444,7 @@ eGobiError cGobiQMICore::GetBARMode( ULONG * pBARMode )
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (by DB key)
@@ -444,18 +554,16 @@ eGobiError cGobiQMICore::GetStoredImages(
    }
 
    // Try to find TLV ID 1
-   std::map <ULONG, const sQMIRawContentHeader *> tlvs;
-   tlvs = qmiRsp.GetContents();
+   const sQMIContents & tlvs = qmiRsp.GetContents();
 
-   std::map <ULONG, const sQMIRawContentHeader *>::const_iterator pIter;
-   pIter = tlvs.find( 1 );
-   if (pIter == tlvs.end())
+   const sQMIRawContentHeader * pHdr = 0;
+   pHdr = tlvs.Find( 1 );
+   if (pHdr == 0)
    {
       return eGOBI_ERR_INVALID_RSP;
    }
 
    // Enough space to copy result?
-   const sQMIRawContentHeader * pHdr = pIter->second;
    ULONG needSz = (ULONG)pHdr->mLength;
 
    *pImageListSize = needSz;
@@ -567,7 +675,7 @@ eGobiError cGobiQMICore::GetStoredImageInfo(
    ULONG tlvCount = 0;
 
    // Parse the TLV we want (by DB key)
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    sProtocolEntityKey tlvKey( eDB2_ET_QMI_DMS_RSP, msgID, 16 );
    cDataParser::tParsedFields pf = ParseTLV( db, rsp, tlvs, tlvKey );
    if (pf.size() >= 2) 
@@ -654,3 +762,228 @@ eGobiError cGobiQMICore::DeleteStoredImage(
    // Send the QMI request, check result, and return 
    return SendAndCheckReturn( eQMI_SVC_DMS, pRequest );
 }
+
+/*===========================================================================
+METHOD:
+   GetImageInventory (Public Method)
+
+DESCRIPTION:
+   This function returns the images stored on the device, the image 
+   preference and the boot and recovery image download mode, matched 
+   against the host image store
+
+   The three queries are issued at once (rather than one after the other)
+   and every image is matched against the image store index in a single 
+   pass, the subfolders of the store are refreshed at most once
+
+PARAMETERS:
+   inventory   [ O ] - The image inventory
+
+RETURN VALUE:
+   eGobiError - Return code
+===========================================================================*/
+eGobiError cGobiQMICore::GetImageInventory( sGobiImageInventory & inventory )
+{
+   inventory = sGobiImageInventory();
+
+   cQMIProtocolServer * pSvr = GetServer( eQMI_SVC_DMS );
+   if (pSvr == 0)
+   {
+      return eGOBI_ERR_INTERNAL;
+   }
+
+   // Build the queries, which are held until every one has completed
+   const WORD msgIDs[] = 
+   {
+      (WORD)eQMI_DMS_LIST_FIRMWARE,
+      (WORD)eQMI_DMS_GET_FIRMWARE_PREF,
+      (WORD)eQMI_DMS_GET_IMG_DLOAD_MODE
+   };
+
+   const ULONG reqCount = (ULONG)(sizeof( msgIDs ) / sizeof( msgIDs[0] ));
+   std::vector <sSharedBuffer *> requests( reqCount, 0 );
+   std::vector <sProtocolBuffer> held( reqCount );
+   for (ULONG r = 0; r < reqCount; r++)
+   {
+      requests[r] = sQMIServiceBuffer::BuildBuffer( eQMI_SVC_DMS, msgIDs[r] );
+      if (requests[r] == 0)
+      {
+         return eGOBI_ERR_MEMORY;
+      }
+
+      held[r] = sProtocolBuffer( requests[r] );
+   }
+
+   // Widen the in-flight window of the DMS server for the queries
+   ULONG oldWindow = pSvr->GetInFlightWindow();
+   bool bWidened = false;
+   if (reqCount > oldWindow && pSvr->SetInFlightWindow( reqCount ) == true)
+   {
+      bWidened = true;
+   }
+
+   cGobiQMIResponseCollector collector;
+
+   std::vector <ULONG> handles;
+   eGobiError rc = SendBatch( eQMI_SVC_DMS,
+                              requests,
+                              GOBI_IMAGE_INVENTORY_TIMEOUT,
+                              &collector,
+                              handles );
+
+   collector.Wait( handles );
+
+   if (bWidened == true)
+   {
+      pSvr->SetInFlightWindow( oldWindow );
+   }
+
+   if (rc != eGOBI_ERR_NONE)
+   {
+      return rc;
+   }
+
+   sProtocolBuffer rsps[reqCount];
+   for (ULONG r = 0; r < reqCount; r++)
+   {
+      rc = collector.GetResponse( handles[r], rsps[r] );
+      if (rc != eGOBI_ERR_NONE)
+      {
+         return rc;
+      }
+   }
+
+   // Stored images (by image type)
+   sQMIView list;
+   rc = GetInventoryTLV( *this, rsps[0], 1, list );
+   if (rc != eGOBI_ERR_NONE)
+   {
+      return rc;
+   }
+
+   ULONG offset = 0;
+   ULONG typeCount = 0;
+   if (sQMIInt <ULONG, 1>::Read( list, offset++, typeCount ) == false)
+   {
+      return eGOBI_ERR_INVALID_RSP;
+   }
+
+   for (ULONG t = 0; t < typeCount; t++)
+   {
+      BYTE imageType = 0;
+      BYTE executing = 0;
+      ULONG imageCount = 0;
+      if ( (sQMIInt <BYTE, 1>::Read( list, offset, imageType ) == false)
+      ||   (sQMIInt <BYTE, 1>::Read( list, offset + 2, executing ) == false)
+      ||   (sQMIInt <ULONG, 1>::Read( list, offset + 3, imageCount ) == false) )
+      {
+         return eGOBI_ERR_INVALID_RSP;
+      }
+
+      // Skip the maximum number of images
+      offset += 4;
+
+      for (ULONG i = 0; i < imageCount; i++)
+      {
+         sGobiImageEntry entry;
+         entry.mImageType = imageType;
+
+         BYTE * pIndex = &entry.mStorageIndex;
+         BYTE * pFailures = &entry.mFailureCount;
+         if ( (sQMIInt <BYTE, 1>::Read( list, offset, *pIndex ) == false)
+         ||   (sQMIInt <BYTE, 1>::Read( list, offset + 1, *pFailures ) == false) )
+         {
+            return eGOBI_ERR_INVALID_RSP;
+         }
+
+         offset += 2;
+         if (ReadInventoryImageID( list, offset, entry ) == false)
+         {
+            return eGOBI_ERR_INVALID_RSP;
+         }
+
+         entry.mbExecuting = (entry.mStorageIndex == executing);
+         inventory.mImages.push_back( entry );
+      }
+   }
+
+   ULONG storedCount = (ULONG)inventory.mImages.size();
+
+   // Image preference (marking stored images, adding the others)
+   sQMIView pref;
+   rc = GetInventoryTLV( *this, rsps[1], 1, pref );
+   if (rc != eGOBI_ERR_NONE)
+   {
+      return rc;
+   }
+
+   offset = 0;
+   ULONG prefCount = 0;
+   if (sQMIInt <ULONG, 1>::Read( pref, offset++, prefCount ) == false)
+   {
+      return eGOBI_ERR_INVALID_RSP;
+   }
+
+   for (ULONG p = 0; p < prefCount; p++)
+   {
+      sGobiImageEntry entry;
+      if (sQMIInt <BYTE, 1>::Read( pref, offset++, entry.mImageType ) == false)
+      {
+         return eGOBI_ERR_INVALID_RSP;
+      }
+
+      if (ReadInventoryImageID( pref, offset, entry ) == false)
+      {
+         return eGOBI_ERR_INVALID_RSP;
+      }
+
+      bool bStored = false;
+      for (ULONG s = 0; s < storedCount; s++)
+      {
+         sGobiImageEntry & stored = inventory.mImages[s];
+         if ( (stored.mImageType == entry.mImageType)
+         &&   (memcmp( (LPCVOID)&stored.mImageID[0],
+                       (LPCVOID)&entry.mImageID[0],
+                       (SIZE_T)MBN_UNIQUE_ID_LEN ) == 0) )
+         {
+            stored.mbPreferred = true;
+            bStored = true;
+         }
+      }
+
+      if (bStored == false)
+      {
+         entry.mbPreferred = true;
+         inventory.mImages.push_back( entry );
+      }
+   }
+
+   // Boot and recovery image download mode
+   sQMIView barMode;
+   rc = GetInventoryTLV( *this, rsps[2], 16, barMode );
+   if (rc != eGOBI_ERR_NONE)
+   {
+      return rc;
+   }
+
+   if (sQMIInt <ULONG, 1>::Read( barMode, 0, inventory.mBARMode ) == false)
+   {
+      return eGOBI_ERR_INVALID_RSP;
+   }
+
+   // Match every image against the host image store at once
+   ULONG imageCount = (ULONG)inventory.mImages.size();
+   std::vector <const BYTE *> imageIDs( imageCount, 0 );
+   for (ULONG i = 0; i < imageCount; i++)
+   {
+      imageIDs[i] = &inventory.mImages[i].mImageID[0];
+   }
+
+   std::vector <std::string> paths = ::GetImagesByUniqueID( imageIDs );
+   for (ULONG i = 0; i < imageCount && i < (ULONG)paths.size(); i++)
+   {
+      inventory.mImages[i].mHostPath = paths[i];
+   }
+
+   return eGOBI_ERR_NONE;
+}
@@ -255,7 +255,7 @@ eGobiError cGobiQMICore::GetFirmwareInfo(
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (by DB key)
@@ -43,6 +43,8 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "GobiQMICore.h"
 
 #include "QMIBuffers.h"
+#include "QMIViewsNAS.h"
+#include "QMIViewsWDS.h"
 
 //---------------------------------------------------------------------------
 // Definitions
@@ -102,6 +104,157 @@ struct sScannedNetworkRATInfo
 //---------------------------------------------------------------------------
 #pragma pack( pop )
 
+/*=========================================================================*/
+// cGobiQMINetworkScanner Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   SendComplete (Public Method)
+
+DESCRIPTION:
+   The scan has completed, pass the networks found on to the callback and
+   delete this object
+
+PARAMETERS:
+   handle      [ I ] - Asynchronous send handle
+   ec          [ I ] - Outcome of the request
+   rsp         [ I ] - Response (only valid when the error is 
+                       eGOBI_ERR_NONE)
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiQMINetworkScanner::SendComplete(
+   ULONG                      /* handle */,
+   eGobiError                 ec,
+   const sProtocolBuffer &    rsp )
+{
+   if (ec == eGOBI_ERR_NONE)
+   {
+      ec = Deliver( rsp );
+   }
+
+   if (mpCallback != 0)
+   {
+      mpCallback->ScanComplete( ec );
+   }
+
+   delete this;
+}
+
+/*===========================================================================
+METHOD:
+   Deliver (Internal Method)
+
+DESCRIPTION:
+   Decode the networks found (and their radio access technologies) straight
+   from the response, passing each on to the callback as it is decoded
+
+PARAMETERS:
+   rsp         [ I ] - Response
+
+RETURN VALUE:
+   eGobiError - Return code
+===========================================================================*/
+eGobiError cGobiQMINetworkScanner::Deliver( const sProtocolBuffer & rsp )
+{
+   // Did we receive a valid QMI response?
+   cQMIViewNASNetworkScanRsp qmiRsp( rsp );
+   if (qmiRsp.IsValid() == false)
+   {
+      return eGOBI_ERR_MALFORMED_RSP;
+   }
+   
+   // Check the mandatory QMI result TLV for success
+   ULONG rc = 0;
+   ULONG ec = 0;
+   bool bResult = qmiRsp.GetResult( rc, ec );
+   if (bResult == false)
+   {
+      return eGOBI_ERR_MALFORMED_RSP;
+   }
+   else if (rc != 0)
+   {
+      return mpCore->GetCorrectedQMIError( ec );
+   }
+
+   if (mpCallback == 0)
+   {
+      return eGOBI_ERR_NONE;
+   }
+
+   // Parse the TLV we want
+   cQMIViewNASNetworkScanRsp::tNetworkInformation nets;
+   if (qmiRsp.GetNetworkInformation( nets ) == false)
+   {
+      return eGOBI_ERR_INVALID_RSP;
+   }
+
+   cQMIViewNASNetworkScanRsp::tNetworkInformation::cIterator netIter( nets );
+   cQMIViewNASNetworkScanRsp::sNetworkInformationElement net;
+   while (netIter.Next( net ) == true)
+   {
+      WORD mcc = 0;
+      WORD mnc = 0;
+      BYTE status = 0;
+      sQMIView desc;
+      if ( (net.GetMCC( mcc ) == false)
+      ||   (net.GetMNC( mnc ) == false)
+      ||   (net.GetNetworkStatus( status ) == false)
+      ||   (net.GetDescription( desc ) == false) )
+      {
+         return eGOBI_ERR_INVALID_RSP;
+      }
+
+      // The description is length prefixed (by a byte), terminate it
+      CHAR description[MAX_SNI_DESCRIPTION_LEN];
+      ULONG descLen = desc.GetSize();
+      if (descLen >= MAX_SNI_DESCRIPTION_LEN)
+      {
+         descLen = MAX_SNI_DESCRIPTION_LEN - 1;
+      }
+
+      memcpy( (LPVOID)&description[0], (LPCVOID)desc.GetData(), (SIZE_T)descLen );
+      description[descLen] = 0;
+
+      // Status is made up of four 2-bit fields
+      mpCallback->NetworkFound( mcc, 
+                                mnc, 
+                                (ULONG)(status & 0x03),
+                                (ULONG)((status >> 2) & 0x03),
+                                (ULONG)((status >> 4) & 0x03),
+                                (ULONG)((status >> 6) & 0x03),
+                                (LPCSTR)&description[0] );
+   }
+
+   // Radio access technologies are optional
+   cQMIViewNASNetworkScanRsp::tRadioAccessTechnology rats;
+   if (qmiRsp.GetRadioAccessTechnology( rats ) == false)
+   {
+      return eGOBI_ERR_NONE;
+   }
+
+   cQMIViewNASNetworkScanRsp::tRadioAccessTechnology::cIterator ratIter( rats );
+   cQMIViewNASNetworkScanRsp::sRadioAccessTechnologyElement rat;
+   while (ratIter.Next( rat ) == true)
+   {
+      WORD mcc = 0;
+      WORD mnc = 0;
+      INT8 radio = 0;
+      if ( (rat.GetMCC( mcc ) == false)
+      ||   (rat.GetMNC( mnc ) == false)
+      ||   (rat.GetRadioInterface( radio ) == false) )
+      {
+         return eGOBI_ERR_INVALID_RSP;
+      }
+
+      mpCallback->NetworkRATFound( mcc, mnc, (ULONG)(BYTE)radio );
+   }
+
+   return eGOBI_ERR_NONE;
+}
+
 /*=========================================================================*/
 // cGobiQMICore Methods
 /*=========================================================================*/
@@ -156,7 +309,7 @@ eGobiError cGobiQMICore::GetANAAAAuthenticationStatus( ULONG * pStatus )
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (by DB key)
@@ -218,8 +371,42 @@ eGobiError cGobiQMICore::GetSignalStrengths(
       return GetCorrectedLastError();
    }
 
-   // Did we receive a valid QMI response?
-   sQMIServiceBuffer qmiRsp( rsp.GetSharedBuffer() );
+   return ParseSignalStrengths( rsp,
+                                maxSignals,
+                                pArraySizes,
+                                pSignalStrengths,
+                                pRadioInterfaces );
+}
+
+/*===========================================================================
+METHOD:
+   ParseSignalStrengths (Internal Method)
+
+DESCRIPTION:
+   Parse the response of a GetSignalStrengths() request (also used by 
+   GetDeviceSnapshot())
+
+PARAMETERS:
+   rsp               [ I ] - QMI response
+   maxSignals        [ I ] - Maximum number of elements that each array 
+                             can contain
+   pArraySizes       [ O ] - Actual number of elements in each array
+   pSignalStrengths  [ O ] - Received signal strength array (dBm)
+   pRadioInterfaces  [ O ] - Radio interface technology array 
+
+RETURN VALUE:
+   eGobiError - Return code
+===========================================================================*/
+eGobiError cGobiQMICore::ParseSignalStrengths( 
+   const sProtocolBuffer &    rsp,
+   ULONG                      maxSignals,
+   ULONG *                    pArraySizes, 
+   INT8 *                     pSignalStrengths, 
+   ULONG *                    pRadioInterfaces )
+{
+   // Did we receive a valid QMI response? (decoded through the static
+   // view instead of the database, this is polled frequently)
+   cQMIViewNASGetSignalStrengthRsp qmiRsp( rsp );
    if (qmiRsp.IsValid() == false)
    {
       return eGOBI_ERR_MALFORMED_RSP;
@@ -238,14 +425,13 @@ eGobiError cGobiQMICore::GetSignalStrengths(
       return GetCorrectedQMIError( ec );
    }
 
-   // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
-   const cCoreDatabase & db = GetDatabase();
-
-   // Parse the TLV we want (by DB key)
-   sProtocolEntityKey tlvKey( eDB2_ET_QMI_NAS_RSP, msgID, 1 );
-   cDataParser::tParsedFields pf = ParseTLV( db, rsp, tlvs, tlvKey );
-   if (pf.size() < 2) 
+   // Parse the TLV we want
+   cQMIViewNASGetSignalStrengthRsp::sSignalStrength sig;
+   INT8 sigVal = 0;
+   INT8 radio = 0;
+   if ( (qmiRsp.GetSignalStrength( sig ) == false)
+   ||   (sig.GetStrength( sigVal ) == false)
+   ||   (sig.GetRadioInterface( radio ) == false) )
    {
       return eGOBI_ERR_INVALID_RSP;
    }
@@ -253,30 +439,31 @@ eGobiError cGobiQMICore::GetSignalStrengths(
    // Remove any values outside the legal range
    std::map <ULONG, INT8> sigMap;
    
-   INT8 sigVal = pf[0].mValue.mS8;
-   ULONG radioVal = pf[1].mValue.mU32;
+   ULONG radioVal = (ULONG)(BYTE)radio;
    if (sigVal <= -30 && sigVal > -125 && radioVal != 0)
    {
       sigMap[radioVal] = sigVal;
    }
 
-   // Parse the TLV we want (by DB key)
-   tlvKey = sProtocolEntityKey( eDB2_ET_QMI_NAS_RSP, msgID, 16 );
-   pf = ParseTLV( db, rsp, tlvs, tlvKey );
-   if (pf.size() > 2) 
+   // Parse the (optional) list of additional signals
+   cQMIViewNASGetSignalStrengthRsp::tStrengthList sigs;
+   if (qmiRsp.GetStrengthList( sigs ) == true)
    {
-      ULONG fi = 0;
-      ULONG auxSigs = (ULONG)pf[fi++].mValue.mU16;
-      if (pf.size() >= 1 + 2 * auxSigs)
+      cQMIViewNASGetSignalStrengthRsp::tStrengthList::cIterator iter( sigs );
+
+      cQMIViewNASGetSignalStrengthRsp::sStrengthListElement elem;
+      while (iter.Next( elem ) == true)
       {
-         for (ULONG s = 0; s < auxSigs; s++, fi += 2)
+         if ( (elem.GetStrength( sigVal ) == false)
+         ||   (elem.GetRadioInterface( radio ) == false) )
          {
-            sigVal = pf[fi].mValue.mS8;
-            radioVal = pf[fi + 1].mValue.mU32;
-            if (sigVal <= -30 && sigVal > -125 && radioVal != 0)
-            {
-               sigMap[radioVal] = sigVal;
-            }
+            break;
+         }
+
+         radioVal = (ULONG)(BYTE)radio;
+         if (sigVal <= -30 && sigVal > -125 && radioVal != 0)
+         {
+            sigMap[radioVal] = sigVal;
          }
       }
    }
@@ -341,8 +528,9 @@ eGobiError cGobiQMICore::GetRFInfo(
       return GetCorrectedLastError();
    }
 
-   // Did we receive a valid QMI response?
-   sQMIServiceBuffer qmiRsp( rsp.GetSharedBuffer() );
+   // Did we receive a valid QMI response? (decoded through the static
+   // view instead of the database, this is polled frequently)
+   cQMIViewNASGetRFBandInformationRsp qmiRsp( rsp );
    if (qmiRsp.IsValid() == false)
    {
       return eGOBI_ERR_MALFORMED_RSP;
@@ -361,42 +549,40 @@ eGobiError cGobiQMICore::GetRFInfo(
       return GetCorrectedQMIError( ec );
    }
 
-   // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
-   const cCoreDatabase & db = GetDatabase();
-
-   // Parse the TLV we want (by DB key)
-   sProtocolEntityKey tlvKey( eDB2_ET_QMI_NAS_RSP, msgID, 1 );
-   cDataParser::tParsedFields pf = ParseTLV( db, rsp, tlvs, tlvKey );
-
-   ULONG fieldCount = (ULONG)pf.size();
-   if (fieldCount < 1) 
-   {
-      return eGOBI_ERR_INVALID_RSP;
-   }
-
-   BYTE ifaceCount = pf[0].mValue.mU8;
-   if (fieldCount < 1 + ((ULONG)ifaceCount * 3))
+   // Parse the TLV we want
+   cQMIViewNASGetRFBandInformationRsp::tList ifaces;
+   if (qmiRsp.GetList( ifaces ) == false)
    {
       return eGOBI_ERR_INVALID_RSP;
    }
 
-   if (ifaceCount > maxInstances)
+   ULONG ifaceCount = ifaces.GetCount();
+   if (ifaceCount > (ULONG)maxInstances)
    {
-      ifaceCount = maxInstances;
+      ifaceCount = (ULONG)maxInstances;
    }
 
    ULONG * pOutput = (ULONG *)pInstances;
-   for (BYTE i = 0; i < ifaceCount; i++)
-   {
-      ULONG offset = 3 * (ULONG)i;
+   for (ULONG i = 0; i < ifaceCount; i++)
+   {
+      cQMIViewNASGetRFBandInformationRsp::sListElement iface;
+      INT8 radio = 0;
+      WORD bandClass = 0;
+      WORD channel = 0;
+      if ( (ifaces.GetElement( i, iface ) == false)
+      ||   (iface.GetRadioInterface( radio ) == false)
+      ||   (iface.GetActiveBandClass( bandClass ) == false)
+      ||   (iface.GetActiveChannel( channel ) == false) )
+      {
+         return eGOBI_ERR_INVALID_RSP;
+      }
 
-      *pOutput++ = pf[offset + 1].mValue.mU32;
-      *pOutput++ = pf[offset + 2].mValue.mU32;
-      *pOutput++ = (ULONG)pf[offset + 3].mValue.mU16;
+      *pOutput++ = (ULONG)(BYTE)radio;
+      *pOutput++ = (ULONG)bandClass;
+      *pOutput++ = (ULONG)channel;
    }
 
-   *pInstanceSize = ifaceCount;
+   *pInstanceSize = (BYTE)ifaceCount;
    return eGOBI_ERR_NONE;
 }
 
@@ -466,7 +652,7 @@ eGobiError cGobiQMICore::PerformNetworkScan(
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (by DB key)
@@ -606,7 +792,7 @@ eGobiError cGobiQMICore::PerformNetworkRATScan(
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (by DB key)
@@ -702,6 +888,86 @@ eGobiError cGobiQMICore::PerformNetworkRATScan(
    return eGOBI_ERR_NONE;
 }
 
+/*===========================================================================
+METHOD:
+   StartNetworkScan (Public Method)
+
+DESCRIPTION:
+   This function starts a scan for available networks without waiting for
+   it to complete, the networks found (and their radio access technologies)
+   are passed to the callback as they are decoded, followed by the outcome
+   of the scan, all on the send executor
+
+PARAMETERS:
+   pCallback   [ I ] - Callback (must remain valid until ScanComplete() 
+                       has been run on it)
+   handle      [ O ] - Handle of the scan (see CancelNetworkScan())
+  
+RETURN VALUE:
+   eGobiError - Return code (the callback is only run upon success)
+===========================================================================*/
+eGobiError cGobiQMICore::StartNetworkScan( 
+   cGobiQMINetworkScanCallback *    pCallback,
+   ULONG &                          handle )
+{
+   handle = INVALID_GOBI_SEND_HANDLE;
+
+   // Validate arguments
+   if (pCallback == 0)
+   {
+      return eGOBI_ERR_INVALID_ARG;
+   }
+
+   // Encode the QMI request (no TLVs)
+   BYTE tlvs[4] = { 0 };
+   cQMIWriterNASNetworkScanReq req( &tlvs[0], (ULONG)sizeof( tlvs ) );
+
+   sSharedBuffer * pRequest = req.BuildRequest();
+   if (pRequest == 0)
+   {
+      return eGOBI_ERR_MEMORY;
+   }
+
+   cGobiQMINetworkScanner * pScanner = 0;
+   pScanner = new cGobiQMINetworkScanner( this, 
+                                          pCallback, 
+                                          sProtocolBuffer( pRequest ) );
+
+   // This can take a really long time, the scanner deletes itself once
+   // complete (which may be before we even get the handle)
+   ULONG h = SendAsync( eQMI_SVC_NAS, pRequest, MAX_REQ_TIMEOUT, pScanner );
+   if (h == INVALID_GOBI_SEND_HANDLE)
+   {
+      delete pScanner;
+      return GetCorrectedLastError();
+   }
+
+   handle = h;
+   return eGOBI_ERR_NONE;
+}
+
+/*===========================================================================
+METHOD:
+   CancelNetworkScan (Public Method)
+
+DESCRIPTION:
+   This function cancels a scan started by StartNetworkScan(), the outcome
+   is still passed to the callback
+
+   NOTE: The scan is only abandoned on this side, the device may carry on
+   scanning until done
+
+PARAMETERS:
+   handle      [ I ] - Handle of the scan
+  
+RETURN VALUE:
+   eGobiError - Return code
+===========================================================================*/
+eGobiError cGobiQMICore::CancelNetworkScan( ULONG handle )
+{
+   return CancelAsync( handle );
+}
+
 /*===========================================================================
 METHOD:
    InitiateNetworkRegistration (Public Method)
@@ -866,6 +1132,70 @@ eGobiError cGobiQMICore::GetServingNetwork(
       return GetCorrectedLastError();
    }
 
+   return ParseServingNetwork( rsp,
+                               pRegistrationState,
+                               pCSDomain,
+                               pPSDomain,
+                               pRAN,
+                               maxRadioIfaces,
+                               pRadioIfacesSize,
+                               pRadioIfaces,
+                               pRoaming,
+                               pMCC,
+                               pMNC,
+                               nameSize,
+                               pName );
+}
+
+/*===========================================================================
+METHOD:
+   ParseServingNetwork (Internal Method)
+
+DESCRIPTION:
+   Parse the response of a GetServingNetwork() request (also used by 
+   GetDeviceSnapshot())
+
+PARAMETERS:
+   rsp                  [ I ] - QMI response
+   pRegistrationState   [ O ] - Registration state
+   pCSDomain            [ O ] - Circuit switch domain status
+   pPSDomain            [ O ] - Packet switch domain status 
+   pRAN                 [ O ] - Radio access network 
+   maxRadioIfaces       [ I ] - Maximum number of elements that the radio
+                                interface array can contain
+   pRadioIfacesSize     [ O ] - Actual number of elements in the radio 
+                                interface array
+   pRadioIfaces         [ O ] - The radio interface array 
+   pRoaming             [ O ] - Roaming indicator (left as is when unknown)
+   pMCC                 [ O ] - Mobile country code (left as is when unknown)
+   pMNC                 [ O ] - Mobile network code (left as is when unknown)
+   nameSize             [ I ] - The maximum number of characters (including 
+                                NULL terminator) that the network name array 
+                                can contain
+   pName                [ O ] - The network name or description represented 
+                                as a NULL terminated string (left as is when 
+                                unknown)
+
+RETURN VALUE:
+   eGobiError - Return code
+===========================================================================*/
+eGobiError cGobiQMICore::ParseServingNetwork( 
+   const sProtocolBuffer &    rsp,
+   ULONG *                    pRegistrationState, 
+   ULONG *                    pCSDomain, 
+   ULONG *                    pPSDomain, 
+   ULONG *                    pRAN, 
+   BYTE                       maxRadioIfaces,
+   BYTE *                     pRadioIfacesSize, 
+   BYTE *                     pRadioIfaces, 
+   ULONG *                    pRoaming, 
+   WORD *                     pMCC, 
+   WORD *                     pMNC, 
+   BYTE                       nameSize, 
+   CHAR *                     pName )
+{
+   WORD msgID = (WORD)eQMI_NAS_GET_SS_INFO;
+
    // Did we receive a valid QMI response?
    sQMIServiceBuffer qmiRsp( rsp.GetSharedBuffer() );
    if (qmiRsp.IsValid() == false)
@@ -887,7 +1217,7 @@ eGobiError cGobiQMICore::GetServingNetwork(
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (by DB key)
@@ -1024,7 +1354,7 @@ eGobiError cGobiQMICore::GetServingNetworkCapabilities(
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (by DB key)
@@ -1087,8 +1417,31 @@ eGobiError cGobiQMICore::GetDataBearerTechnology( ULONG * pDataBearer )
       return GetCorrectedLastError();
    }
 
-   // Did we receive a valid QMI response?
-   sQMIServiceBuffer qmiRsp( rsp.GetSharedBuffer() );
+   return ParseDataBearerTechnology( rsp, pDataBearer );
+}
+
+/*===========================================================================
+METHOD:
+   ParseDataBearerTechnology (Internal Method)
+
+DESCRIPTION:
+   Parse the response of a GetDataBearerTechnology() request (also used by 
+   GetDeviceSnapshot())
+
+PARAMETERS:
+   rsp         [ I ] - QMI response
+   pDataBearer [ O ] - The data bearer technology
+
+RETURN VALUE:
+   eGobiError - Return code
+===========================================================================*/
+eGobiError cGobiQMICore::ParseDataBearerTechnology(
+   const sProtocolBuffer &    rsp,
+   ULONG *                    pDataBearer )
+{
+   // Did we receive a valid QMI response? (decoded through the static
+   // view instead of the database, this is polled frequently)
+   cQMIViewWDSGetDataBearerTechnologyRsp qmiRsp( rsp );
    if (qmiRsp.IsValid() == false)
    {
       return eGOBI_ERR_MALFORMED_RSP;
@@ -1107,20 +1460,15 @@ eGobiError cGobiQMICore::GetDataBearerTechnology( ULONG * pDataBearer )
       return GetCorrectedQMIError( ec );
    }
 
-   // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
-   const cCoreDatabase & db = GetDatabase();
-
-   // Parse the TLV we want (by DB key)
-   sProtocolEntityKey tlvKey( eDB2_ET_QMI_WDS_RSP, msgID, 1 );
-   cDataParser::tParsedFields pf = ParseTLV( db, rsp, tlvs, tlvKey );
-   if (pf.size() < 1) 
+   // Parse the TLV we want
+   INT8 bearer = 0;
+   if (qmiRsp.GetCurrent( bearer ) == false)
    {
       return eGOBI_ERR_INVALID_RSP;
    }
 
    // Populate the state
-   *pDataBearer = pf[0].mValue.mU32;
+   *pDataBearer = (ULONG)(BYTE)bearer;
    return eGOBI_ERR_NONE;
 }
 
@@ -1177,8 +1525,9 @@ eGobiError cGobiQMICore::GetHomeNetwork(
       return GetCorrectedLastError();
    }
 
-   // Did we receive a valid QMI response?
-   sQMIServiceBuffer qmiRsp( rsp.GetSharedBuffer() );
+   // Did we receive a valid QMI response? (decoded through the static
+   // view instead of the database, this is polled frequently)
+   cQMIViewNASGetHomeNetworkRsp qmiRsp( rsp );
    if (qmiRsp.IsValid() == false)
    {
       return eGOBI_ERR_MALFORMED_RSP;
@@ -1197,46 +1546,47 @@ eGobiError cGobiQMICore::GetHomeNetwork(
       return GetCorrectedQMIError( ec );
    }
 
-   // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
-   const cCoreDatabase & db = GetDatabase();
-
-   // Parse the TLV we want (by DB key)
-   sProtocolEntityKey tlvKey1( eDB2_ET_QMI_NAS_RSP, msgID, 1 );
-   cDataParser::tParsedFields pf1 = ParseTLV( db, rsp, tlvs, tlvKey1 );
-   if (pf1.size() < 3) 
+   // Parse the TLV we want
+   cQMIViewNASGetHomeNetworkRsp::sHomeNetwork home;
+   WORD mcc = 0;
+   WORD mnc = 0;
+   sQMIView name;
+   if ( (qmiRsp.GetHomeNetwork( home ) == false)
+   ||   (home.GetMCC( mcc ) == false)
+   ||   (home.GetMNC( mnc ) == false)
+   ||   (home.GetDescription( name ) == false) )
    {
       return eGOBI_ERR_INVALID_RSP;
    }
 
    // Populate the variables
-   *pMCC = pf1[0].mValue.mU16;
-   *pMNC = pf1[1].mValue.mU16;
+   *pMCC = mcc;
+   *pMNC = mnc;
 
    // Network name?
-   if (pf1[2].mValue.mU8 > 0 && pf1.size() >= 4)
+   ULONG strLen = name.GetSize();
+   if (strLen > 0)
    {
-      LONG strLen = pf1[3].mValueString.size();
-      if (strLen > 0)
+      // Space to perform the copy?
+      if ((ULONG)nameSize < strLen + 1)
       {
-         // Space to perform the copy?
-         if (nameSize < strLen + 1)
-         {
-            return eGOBI_ERR_BUFFER_SZ;
-         }
-
-         memcpy( (LPVOID)pName, (LPCSTR)pf1[3].mValueString.c_str(), strLen );
-         pName[strLen] = 0;
+         return eGOBI_ERR_BUFFER_SZ;
       }
+
+      memcpy( (LPVOID)pName, (LPCVOID)name.GetData(), (SIZE_T)strLen );
+      pName[strLen] = 0;
    }
 
-   // Parse the optional TLV we want (by DB key)
-   sProtocolEntityKey tlvKey2( eDB2_ET_QMI_NAS_RSP, msgID, 16 );
-   cDataParser::tParsedFields pf2 = ParseTLV( db, rsp, tlvs, tlvKey2 );
-   if (pf2.size() >= 2) 
+   // Parse the optional TLV we want
+   cQMIViewNASGetHomeNetworkRsp::sHomeSystemID sys;
+   WORD sid = 0;
+   WORD nid = 0;
+   if ( (qmiRsp.GetHomeSystemID( sys ) == true)
+   &&   (sys.GetSID( sid ) == true)
+   &&   (sys.GetNID( nid ) == true) )
    {
-      *pSID = pf2[0].mValue.mU16;
-      *pNID = pf2[1].mValue.mU16;
+      *pSID = sid;
+      *pNID = nid;
    }
 
    return eGOBI_ERR_NONE;
@@ -1325,8 +1675,9 @@ eGobiError cGobiQMICore::GetNetworkPreference(
       return GetCorrectedLastError();
    }
 
-   // Did we receive a valid QMI response?
-   sQMIServiceBuffer qmiRsp( rsp.GetSharedBuffer() );
+   // Did we receive a valid QMI response? (decoded through the static
+   // view instead of the database, this is polled frequently)
+   cQMIViewNASGetTechnologyPreferenceRsp qmiRsp( rsp );
    if (qmiRsp.IsValid() == false)
    {
       return eGOBI_ERR_MALFORMED_RSP;
@@ -1345,35 +1696,29 @@ eGobiError cGobiQMICore::GetNetworkPreference(
       return GetCorrectedQMIError( ec );
    }
 
-   // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
-
-   // Parse the TLV we want (by DB key)
-   sProtocolEntityKey tlvKey1( eDB2_ET_QMI_NAS_RSP, msgID, 1 );
-   sDB2NavInput ni1 = FindTLV( tlvs, tlvKey1 );
-   if (ni1.mPayloadLen < 3) 
+   // Parse the TLV we want
+   cQMIViewNASGetTechnologyPreferenceRsp::sActive active;
+   WORD pref = 0;
+   BYTE duration = 0;
+   if ( (qmiRsp.GetActive( active ) == false)
+   ||   (active.GetTechnologyPreference( pref ) == false)
+   ||   (active.GetTechnologyPreferenceDuration( duration ) == false) )
    {
       return eGOBI_ERR_INVALID_RSP;
    }
 
-   const BYTE * pData = ni1.mpPayload;
-   const WORD * pTmp = (const WORD *)pData;
-   pData += 2;
-
    // Populate the variables
-   *pTechnologyPref = (ULONG)*pTmp;
-   *pDuration = (ULONG)*pData;
+   *pTechnologyPref = (ULONG)pref;
+   *pDuration = (ULONG)duration;
 
    // Until we know any better the persistent setting is the current setting
    *pPersistentTechnologyPref = *pTechnologyPref;
 
-   // Parse the optional TLV we want (by DB key)
-   sProtocolEntityKey tlvKey2( eDB2_ET_QMI_NAS_RSP, msgID, 16 );
-   sDB2NavInput ni2 = FindTLV( tlvs, tlvKey2 );
-   if (ni2.mPayloadLen >= 2) 
+   // Parse the optional TLV we want
+   WORD persistentPref = 0;
+   if (qmiRsp.GetPersistent( persistentPref ) == true)
    {
-      pTmp = (const WORD *)ni2.mpPayload;
-      *pPersistentTechnologyPref = (ULONG)*pTmp;
+      *pPersistentTechnologyPref = (ULONG)persistentPref;
    }
 
    return eGOBI_ERR_NONE;
@@ -1447,6 +1792,10 @@ eGobiError cGobiQMICore::SetCDMANetworkParameters(
    WORD msgID = (WORD)eQMI_NAS_SET_NET_PARAMS;
    std::vector <sDB2PackingInput> piv;
 
+   // Typed values of each TLV (packed as is, no string formatting)
+   cTypedFields tlvs[4];
+   ULONG t = 0;
+
    // Need to start with SPC?
    if (pForceRev0 != 0 || scpCount == 4)
    {
@@ -1469,52 +1818,46 @@ eGobiError cGobiQMICore::SetCDMANetworkParameters(
          return eGOBI_ERR_INVALID_ARG;
       }
 
+      tlvs[t].AddString( (LPCSTR)spc.c_str() );
+
       sProtocolEntityKey pek( eDB2_ET_QMI_NAS_REQ, msgID, 16 );
-      sDB2PackingInput pi( pek, (LPCSTR)spc.c_str() );
+      sDB2PackingInput pi( pek, tlvs[t++] );
       piv.push_back( pi );
    }
 
    if (pForceRev0 != 0)
    {
-      // "%u"
-      std::ostringstream tmp;
-      tmp << (UINT)(*pForceRev0 == 0 ? 0 : 1);
+      tlvs[t].AddUnsigned( *pForceRev0 == 0 ? 0 : 1 );
 
       sProtocolEntityKey pek( eDB2_ET_QMI_NAS_REQ, msgID, 20 );
-      sDB2PackingInput pi( pek, (LPCSTR)tmp.str().c_str() );
+      sDB2PackingInput pi( pek, tlvs[t++] );
       piv.push_back( pi );
    }
 
    if (scpCount == 4)
    {
-      // "%u %u %u %u %u %u %u %u %u %u %u %u"
-      std::ostringstream tmp;
-      tmp << (UINT)(*pCustomSCP == 0 ? 0 : 1)
-          << (UINT)(*pProtocol & 0x00000001 ? 1 : 0)
-          << (UINT)(*pProtocol & 0x00000002 ? 1 : 0)
-          << (UINT)(*pProtocol & 0x00000004 ? 1 : 0)
-          << (UINT)(*pProtocol & 0x00000008 ? 1 : 0)
-          << (UINT)(*pProtocol & 0x00000010 ? 1 : 0)
-          << (UINT)(*pProtocol & 0x00000020 ? 1 : 0)
-          << (UINT)(*pProtocol & 0x00000040 ? 1 : 0)
-          << (UINT)(*pProtocol & 0x00000080 ? 1 : 0)
-          << (UINT)(*pBroadcast & 0x00000001 ? 1 : 0)
-          << (UINT)(*pApplication & 0x00000001 ? 1 : 0)
-          << (UINT)(*pApplication & 0x00000002 ? 1 : 0);
-      
+      cTypedFields & scp = tlvs[t];
+      scp.AddUnsigned( *pCustomSCP == 0 ? 0 : 1 );
+      for (ULONG bit = 0; bit < 8; bit++)
+      {
+         scp.AddUnsigned( (*pProtocol >> bit) & 0x00000001 );
+      }
+
+      scp.AddUnsigned( *pBroadcast & 0x00000001 )
+         .AddUnsigned( *pApplication & 0x00000001 )
+         .AddUnsigned( (*pApplication & 0x00000002) >> 1 );
+
       sProtocolEntityKey pek( eDB2_ET_QMI_NAS_REQ, msgID, 21 );
-      sDB2PackingInput pi( pek, (LPCSTR)tmp.str().c_str() );
+      sDB2PackingInput pi( pek, tlvs[t++] );
       piv.push_back( pi );
    }
 
    if (pRoaming != 0)
    {
-      // "%u"
-      std::ostringstream tmp;
-      tmp << (UINT)*pRoaming;
+      tlvs[t].AddUnsigned( *pRoaming );
 
       sProtocolEntityKey pek( eDB2_ET_QMI_NAS_REQ, msgID, 22 );
-      sDB2PackingInput pi( pek, (LPCSTR)tmp.str().c_str() );
+      sDB2PackingInput pi( pek, tlvs[t++] );
       piv.push_back( pi );
    }
 
@@ -1626,7 +1969,7 @@ eGobiError cGobiQMICore::GetCDMANetworkParameters(
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLVs we want (by DB key)
@@ -1733,7 +2076,7 @@ eGobiError cGobiQMICore::GetACCOLC( BYTE * pACCOLC )
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (by DB key)
@@ -1856,7 +2199,7 @@ eGobiError cGobiQMICore::GetPLMNMode( ULONG * pMode )
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (by DB key)
@@ -1951,18 +2294,16 @@ eGobiError cGobiQMICore::GetPLMNName(
    }
 
    // Try to find TLV ID 16
-   std::map <ULONG, const sQMIRawContentHeader *> tlvs;
-   tlvs = qmiRsp.GetContents();
+   const sQMIContents & tlvs = qmiRsp.GetContents();
 
-   std::map <ULONG, const sQMIRawContentHeader *>::const_iterator pIter;
-   pIter = tlvs.find( 16 );
-   if (pIter == tlvs.end())
+   const sQMIRawContentHeader * pHdr = 0;
+   pHdr = tlvs.Find( 16 );
+   if (pHdr == 0)
    {
       return eGOBI_ERR_INVALID_RSP;
    }
 
    // Enough space to copy result?
-   const sQMIRawContentHeader * pHdr = pIter->second;
    ULONG needSz = (ULONG)pHdr->mLength;
    if (needSz == 0)
    {
@@ -209,7 +209,7 @@ eGobiError cGobiQMICore::OMADMGetSessionInfo(
    ULONG params = 0;
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLVs we want (by DB key)
@@ -308,7 +308,7 @@ eGobiError cGobiQMICore::OMADMGetPendingNIA(
    ULONG params = 0;
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLVs we want (by DB key)
@@ -429,7 +429,7 @@ eGobiError cGobiQMICore::OMADMGetFeatureSettings(
    ULONG params = 0;
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLVs we want (by DB key)
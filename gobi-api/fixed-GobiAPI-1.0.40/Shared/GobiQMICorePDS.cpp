@@ -109,7 +109,7 @@ eGobiError cGobiQMICore::GetPDSState(
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (by DB key)
@@ -264,7 +264,7 @@ eGobiError cGobiQMICore::GetPDSDefaults(
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (by DB key)
@@ -391,7 +391,7 @@ eGobiError cGobiQMICore::GetXTRAAutomaticDownload(
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (by DB key)
@@ -501,7 +501,7 @@ eGobiError cGobiQMICore::GetXTRANetwork( ULONG * pPreference )
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (by DB key)
@@ -612,7 +612,7 @@ eGobiError cGobiQMICore::GetXTRAValidity(
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (by DB key)
@@ -725,7 +725,7 @@ eGobiError cGobiQMICore::GetXTRADataState( ULONG * pState )
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (by DB key)
@@ -829,7 +829,7 @@ eGobiError cGobiQMICore::GetXTRATimeState( ULONG * pState )
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (by DB key)
@@ -937,7 +937,7 @@ eGobiError cGobiQMICore::GetAGPSConfig(
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (by DB key)
@@ -1056,7 +1056,7 @@ eGobiError cGobiQMICore::GetServiceAutomaticTracking( ULONG * pbAuto )
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (by DB key)
@@ -1159,7 +1159,7 @@ eGobiError cGobiQMICore::GetPortAutomaticTracking( ULONG * pbAuto )
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (by DB key)
@@ -108,14 +108,12 @@ eGobiError cGobiQMICore::GetSMSWake(
    }
 
    // Try to find TLVs ID 16/17
-   std::map <ULONG, const sQMIRawContentHeader *> tlvs;
-   tlvs = qmiRsp.GetContents();
+   const sQMIContents & tlvs = qmiRsp.GetContents();
 
-   std::map <ULONG, const sQMIRawContentHeader *>::const_iterator pIter;
-   pIter = tlvs.find( 16 );
-   if (pIter != tlvs.end())
+   const sQMIRawContentHeader * pHdr = 0;
+   pHdr = tlvs.Find( 16 );
+   if (pHdr != 0)
    {
-      const sQMIRawContentHeader * pHdr = pIter->second;
       if (pHdr->mLength < (WORD)1)
       {
          return eGOBI_ERR_MALFORMED_RSP;
@@ -125,10 +123,9 @@ eGobiError cGobiQMICore::GetSMSWake(
       *pbEnabled = (ULONG)*pData;
    }
 
-   pIter = tlvs.find( 17 );
-   if (pIter != tlvs.end())
+   pHdr = tlvs.Find( 17 );
+   if (pHdr != 0)
    {
-      const sQMIRawContentHeader * pHdr = pIter->second;
       if (pHdr->mLength < (WORD)4)
       {
          return eGOBI_ERR_MALFORMED_RSP;
@@ -6,6 +6,7 @@ DESCRIPTION:
    QUALCOMM Gobi QMI Based API Core (SMS Service)
 
 PUBLIC CLASSES AND FUNCTIONS:
+   cGobiQMISMSBatchReader
    cGobiQMICore
 
 Copyright (c) 2011, Code Aurora Forum. All rights reserved.
@@ -43,11 +44,275 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "GobiQMICore.h"
 
 #include "QMIBuffers.h"
+#include "QMIViewsWMS.h"
 
 //---------------------------------------------------------------------------
 // Definitions
 //---------------------------------------------------------------------------
 
+// Default number of SMS reads awaiting a response at once (GetSMSBatch())
+const ULONG DEFAULT_GOBI_SMS_BATCH_WINDOW = 8;
+
+// Timeout for SMS reads
+const ULONG GOBI_SMS_READ_TIMEOUT = 5000;
+
+/*=========================================================================*/
+// cGobiQMISMSBatchReader Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   cGobiQMISMSBatchReader (Public Method)
+
+DESCRIPTION:
+   Constructor
+
+PARAMETERS:
+   pCore       [ I ] - Core object issuing the reads
+   pCallback   [ I ] - Callback receiving the messages
+
+RETURN VALUE:
+   None
+===========================================================================*/
+cGobiQMISMSBatchReader::cGobiQMISMSBatchReader(
+   cGobiQMICore *             pCore,
+   cGobiQMISMSCallback *      pCallback )
+   :  mpCore( pCore ),
+      mpCallback( pCallback ),
+      mReads(),
+      mEarly(),
+      mExpected( 0 ),
+      mCompleted( 0 )
+{
+   pthread_mutex_init( &mMutex, NULL );
+   pthread_cond_init( &mCond, NULL );
+}
+
+/*===========================================================================
+METHOD:
+   ~cGobiQMISMSBatchReader (Public Method)
+
+DESCRIPTION:
+   Destructor
+
+RETURN VALUE:
+   None
+===========================================================================*/
+cGobiQMISMSBatchReader::~cGobiQMISMSBatchReader()
+{
+   pthread_cond_destroy( &mCond );
+   pthread_mutex_destroy( &mMutex );
+}
+
+/*===========================================================================
+METHOD:
+   AddReads (Public Method)
+
+DESCRIPTION:
+   Map the handles of the scheduled reads to message indices, reads that
+   already completed are passed on now (reads that could not be scheduled,
+   i.e. having an invalid handle, are passed on as failed)
+
+PARAMETERS:
+   handles        [ I ] - Handle of each read
+   messageIndices [ I ] - Message index of each read
+   scheduleError  [ I ] - Error scheduling the reads
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiQMISMSBatchReader::AddReads(
+   const std::vector <ULONG> &   handles,
+   const std::vector <ULONG> &   messageIndices,
+   eGobiError                    scheduleError )
+{
+   if (scheduleError == eGOBI_ERR_NONE)
+   {
+      scheduleError = eGOBI_ERR_REQ_SCHEDULE;
+   }
+
+   pthread_mutex_lock( &mMutex );
+
+   ULONG reads = (ULONG)handles.size();
+   for (ULONG r = 0; r < reads && r < (ULONG)messageIndices.size(); r++)
+   {
+      ULONG handle = handles[r];
+      if (handle == INVALID_GOBI_SEND_HANDLE)
+      {
+         Deliver( messageIndices[r], scheduleError, sProtocolBuffer() );
+         continue;
+      }
+
+      mExpected++;
+
+      std::map <ULONG, std::pair <eGobiError, sProtocolBuffer> >::iterator 
+         pEarly = mEarly.find( handle );
+      if (pEarly != mEarly.end())
+      {
+         Deliver( messageIndices[r], pEarly->second.first, pEarly->second.second );
+         mEarly.erase( pEarly );
+      }
+      else
+      {
+         mReads[handle] = messageIndices[r];
+      }
+   }
+
+   pthread_mutex_unlock( &mMutex );
+}
+
+/*===========================================================================
+METHOD:
+   Wait (Public Method)
+
+DESCRIPTION:
+   Wait for every read added to complete
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiQMISMSBatchReader::Wait()
+{
+   pthread_mutex_lock( &mMutex );
+
+   while (mCompleted < mExpected)
+   {
+      pthread_cond_wait( &mCond, &mMutex );
+   }
+
+   pthread_mutex_unlock( &mMutex );
+}
+
+/*===========================================================================
+METHOD:
+   SendComplete (Public Method)
+
+DESCRIPTION:
+   A read has completed, pass the message on (unless the handle has not 
+   been added yet, in which case the outcome is kept until it is)
+
+PARAMETERS:
+   handle      [ I ] - Handle of the read
+   ec          [ I ] - Error
+   rsp         [ I ] - Response (only valid when the error is 
+                       eGOBI_ERR_NONE)
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiQMISMSBatchReader::SendComplete(
+   ULONG                      handle,
+   eGobiError                 ec,
+   const sProtocolBuffer &    rsp )
+{
+   pthread_mutex_lock( &mMutex );
+
+   std::map <ULONG, ULONG>::iterator pIter = mReads.find( handle );
+   if (pIter != mReads.end())
+   {
+      Deliver( pIter->second, ec, rsp );
+      mReads.erase( pIter );
+   }
+   else
+   {
+      mEarly[handle] = std::pair <eGobiError, sProtocolBuffer>( ec, rsp );
+   }
+
+   mCompleted++;
+   pthread_cond_broadcast( &mCond );
+
+   pthread_mutex_unlock( &mMutex );
+}
+
+/*===========================================================================
+METHOD:
+   Deliver (Internal Method)
+
+DESCRIPTION:
+   Decode a raw read response (through the static view, straight from the
+   response buffer) and pass the message on
+
+PARAMETERS:
+   messageIndex   [ I ] - Message index
+   ec             [ I ] - Error
+   rsp            [ I ] - Response (only valid when the error is 
+                          eGOBI_ERR_NONE)
+
+SEQUENCING:
+   The mutex must be held
+
+RETURN VALUE:
+   None
+===========================================================================*/
+void cGobiQMISMSBatchReader::Deliver(
+   ULONG                      messageIndex,
+   eGobiError                 ec,
+   const sProtocolBuffer &    rsp )
+{
+   if (mpCallback == 0)
+   {
+      return;
+   }
+
+   if (ec != eGOBI_ERR_NONE || rsp.IsValid() == false)
+   {
+      if (ec == eGOBI_ERR_NONE)
+      {
+         ec = eGOBI_ERR_INTERNAL;
+      }
+
+      mpCallback->SMSRead( messageIndex, ec, 0, 0, 0, 0 );
+      return;
+   }
+
+   // Did we receive a valid QMI response?
+   cQMIViewWMSRawReadRsp qmiRsp( rsp );
+   if (qmiRsp.IsValid() == false)
+   {
+      mpCallback->SMSRead( messageIndex, eGOBI_ERR_MALFORMED_RSP, 0, 0, 0, 0 );
+      return;
+   }
+
+   // Check the mandatory QMI result TLV for success
+   ULONG rc = 0;
+   ULONG qmiEC = 0;
+   bool bResult = qmiRsp.GetResult( rc, qmiEC );
+   if (bResult == false)
+   {
+      mpCallback->SMSRead( messageIndex, eGOBI_ERR_MALFORMED_RSP, 0, 0, 0, 0 );
+      return;
+   }
+   else if (rc != 0)
+   {
+      ec = mpCore->GetCorrectedQMIError( qmiEC );
+      mpCallback->SMSRead( messageIndex, ec, 0, 0, 0, 0 );
+      return;
+   }
+
+   // Parse the TLV we want (there has to be message data)
+   cQMIViewWMSRawReadRsp::sRawMessageData msg;
+   cQMIViewWMSRawReadRsp::tRawMessageDataRawData data;
+   BYTE tag = 0;
+   BYTE fmt = 0;
+   if ( (qmiRsp.GetRawMessageData( msg ) == false)
+   ||   (msg.GetMessageTag( tag ) == false)
+   ||   (msg.GetFormat( fmt ) == false)
+   ||   (msg.GetRawData( data ) == false)
+   ||   (data.GetCount() == 0) )
+   {
+      mpCallback->SMSRead( messageIndex, eGOBI_ERR_INVALID_RSP, 0, 0, 0, 0 );
+      return;
+   }
+
+   const sQMIView & pdu = data.GetElements();
+   mpCallback->SMSRead( messageIndex, 
+                        eGOBI_ERR_NONE,
+                        (ULONG)tag,
+                        (ULONG)fmt,
+                        pdu.GetSize(),
+                        pdu.GetData() );
+}
+
 /*=========================================================================*/
 // cGobiQMICore Methods
 /*=========================================================================*/
@@ -202,7 +467,7 @@ eGobiError cGobiQMICore::GetSMSList(
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
 
    // Parse the TLV we want (by DB key)
    sProtocolEntityKey tlvKey( eDB2_ET_QMI_WMS_RSP, msgID, 1 );
@@ -332,7 +597,7 @@ eGobiError cGobiQMICore::GetSMS(
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
 
    // Parse the TLV we want (by DB key)
    sProtocolEntityKey tlvKey( eDB2_ET_QMI_WMS_RSP, msgID, 1 );
@@ -373,6 +638,95 @@ eGobiError cGobiQMICore::GetSMS(
    return eGOBI_ERR_NONE;
 }
 
+/*===========================================================================
+METHOD:
+   GetSMSBatch (Public Method)
+
+DESCRIPTION:
+   This function reads several SMS messages from device memory, i.e. what
+   GetSMS() does for each of the given messages.  Every read is scheduled
+   at once, with up to a window of them awaiting a response at a time, and
+   each message is passed to the callback (from the send executor, one at
+   a time) as it arrives.  Returns once every read has completed
+
+PARAMETERS:
+   storageType    [ I ] - SMS message storage type
+   messageIndices [ I ] - Index of each message to read
+   pCallback      [ I ] - Callback receiving the messages
+   window         [ I ] - Maximum number of reads awaiting a response
+
+RETURN VALUE:
+   eGobiError - Return code (eGOBI_ERR_NONE when every read was scheduled,
+                the outcome of each read is passed to the callback)
+===========================================================================*/
+eGobiError cGobiQMICore::GetSMSBatch(
+   ULONG                         storageType,
+   const std::vector <ULONG> &   messageIndices,
+   cGobiQMISMSCallback *         pCallback,
+   ULONG                         window )
+{
+   // Validate arguments
+   ULONG reads = (ULONG)messageIndices.size();
+   if (pCallback == 0 || reads == 0 || window == 0)
+   {
+      return eGOBI_ERR_INVALID_ARG;
+   }
+
+   cQMIProtocolServer * pSvr = GetServer( eQMI_SVC_WMS );
+   if (pSvr == 0)
+   {
+      return eGOBI_ERR_INTERNAL;
+   }
+
+   // Encode the QMI requests (reusing the TLV buffer), which are held
+   // until every read has completed
+   BYTE tlvs[16];
+   std::vector <sSharedBuffer *> requests( reads, 0 );
+   std::vector <sProtocolBuffer> held( reads );
+   for (ULONG r = 0; r < reads; r++)
+   {
+      cQMIWriterWMSRawReadReq req( &tlvs[0], (ULONG)sizeof( tlvs ) );
+      req.SetMessageMemoryStorageID( (BYTE)storageType, messageIndices[r] );
+
+      requests[r] = req.BuildRequest();
+      if (requests[r] == 0)
+      {
+         return eGOBI_ERR_MEMORY;
+      }
+
+      held[r] = sProtocolBuffer( requests[r] );
+   }
+
+   // Widen the in-flight window of the WMS server for the reads
+   ULONG oldWindow = pSvr->GetInFlightWindow();
+   bool bWidened = false;
+   if (window > oldWindow && pSvr->SetInFlightWindow( window ) == true)
+   {
+      bWidened = true;
+   }
+
+   // Schedule the reads
+   cGobiQMISMSBatchReader reader( this, pCallback );
+
+   std::vector <ULONG> handles;
+   eGobiError rc = SendBatch( eQMI_SVC_WMS,
+                              requests,
+                              GOBI_SMS_READ_TIMEOUT,
+                              &reader,
+                              handles );
+
+   // Stream the messages as they arrive
+   reader.AddReads( handles, messageIndices, rc );
+   reader.Wait();
+
+   if (bWidened == true)
+   {
+      pSvr->SetInFlightWindow( oldWindow );
+   }
+
+   return rc;
+}
+
 /*===========================================================================
 METHOD:
    ModifySMSStatus (Public Method)
@@ -496,7 +850,7 @@ eGobiError cGobiQMICore::SaveSMS(
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
 
    // Parse the TLV we want (by DB key)
    sProtocolEntityKey tlvKey( eDB2_ET_QMI_WMS_RSP, msgID, 1 );
@@ -593,7 +947,7 @@ eGobiError cGobiQMICore::SendSMS(
    else if (rc != 0)
    {
       // Prepare TLVs for parsing
-      std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+      cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
 
       // Parse the optional TLV we want (by DB key)
       sProtocolEntityKey tlvKey( eDB2_ET_QMI_WMS_RSP, msgID, 1 );
@@ -675,7 +1029,7 @@ eGobiError cGobiQMICore::GetSMSCAddress(
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (by DB key)
@@ -835,7 +1189,7 @@ eGobiError cGobiQMICore::GetSMSRoutes(
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (by DB key)
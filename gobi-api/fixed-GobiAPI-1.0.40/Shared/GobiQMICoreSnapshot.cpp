@@ -0,0 +1,405 @@
+/*===========================================================================
+FILE: 
+   GobiQMICoreSnapshot.cpp
+
+DESCRIPTION:
+   QUALCOMM Gobi QMI Based API Core (Device Snapshot)
+
+PUBLIC CLASSES AND FUNCTIONS:
+   cGobiQMICore
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+==========================================================================*/
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "StdAfx.h"
+#include "GobiQMICore.h"
+
+#include "QMIBuffers.h"
+
+//---------------------------------------------------------------------------
+// Definitions
+//---------------------------------------------------------------------------
+
+// A device snapshot query (the serving network query also carries the 
+// roaming indicator)
+struct sGobiSnapshotQuery
+{
+   /* QMI service type */
+   eQMIService mSvc;
+
+   /* QMI message ID */
+   WORD mMsgID;
+
+   /* Snapshot items the response carries (eGobiSnapshotItem) */
+   ULONG mItems;
+};
+
+// Device snapshot queries
+const sGobiSnapshotQuery GOBI_SNAPSHOT_QUERIES[] = 
+{
+   { 
+      eQMI_SVC_WDS, 
+      (WORD)eQMI_WDS_GET_PKT_STATUS, 
+      (ULONG)eGOBI_SNAPSHOT_SESSION_STATE 
+   },
+   { 
+      eQMI_SVC_WDS, 
+      (WORD)eQMI_WDS_GET_DATA_BEARER, 
+      (ULONG)eGOBI_SNAPSHOT_DATA_BEARER 
+   },
+   { 
+      eQMI_SVC_WDS, 
+      (WORD)eQMI_WDS_GET_STATISTICS, 
+      (ULONG)eGOBI_SNAPSHOT_BYTE_TOTALS 
+   },
+   { 
+      eQMI_SVC_NAS, 
+      (WORD)eQMI_NAS_GET_RSSI, 
+      (ULONG)eGOBI_SNAPSHOT_SIGNAL_STRENGTHS 
+   },
+   { 
+      eQMI_SVC_NAS, 
+      (WORD)eQMI_NAS_GET_SS_INFO, 
+      (ULONG)eGOBI_SNAPSHOT_SERVING_NETWORK | (ULONG)eGOBI_SNAPSHOT_ROAMING
+   },
+   { 
+      eQMI_SVC_DMS, 
+      (WORD)eQMI_DMS_GET_OPERTAING_MODE, 
+      (ULONG)eGOBI_SNAPSHOT_POWER 
+   },
+   { 
+      eQMI_SVC_DMS, 
+      (WORD)eQMI_DMS_UIM_GET_ICCID, 
+      (ULONG)eGOBI_SNAPSHOT_ICCID 
+   }
+};
+
+// Number of device snapshot queries
+const ULONG GOBI_SNAPSHOT_QUERY_COUNT = 
+   (ULONG)(sizeof( GOBI_SNAPSHOT_QUERIES ) 
+         / sizeof( GOBI_SNAPSHOT_QUERIES[0] ));
+
+// Services the device snapshot queries are issued to
+const eQMIService GOBI_SNAPSHOT_SERVICES[] = 
+{
+   eQMI_SVC_WDS,
+   eQMI_SVC_NAS,
+   eQMI_SVC_DMS
+};
+
+// Number of services the device snapshot queries are issued to
+const ULONG GOBI_SNAPSHOT_SERVICE_COUNT = 
+   (ULONG)(sizeof( GOBI_SNAPSHOT_SERVICES ) 
+         / sizeof( GOBI_SNAPSHOT_SERVICES[0] ));
+
+/*=========================================================================*/
+// Free Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   SetSnapshotOutcome (Free Method)
+
+DESCRIPTION:
+   Record the outcome of the requested items among the given items
+
+PARAMETERS:
+   snapshot    [I/O] - Device snapshot
+   items       [ I ] - Snapshot items (eGobiSnapshotItem)
+   ec          [ I ] - Outcome
+
+RETURN VALUE:
+   None
+===========================================================================*/
+static void SetSnapshotOutcome(
+   sGobiDeviceSnapshot &      snapshot,
+   ULONG                      items,
+   eGobiError                 ec )
+{
+   items &= snapshot.mRequested;
+   for (ULONG i = 0; i < GOBI_SNAPSHOT_ITEMS; i++)
+   {
+      ULONG item = (1 << i);
+      if ((items & item) == 0)
+      {
+         continue;
+      }
+
+      snapshot.mErrors[i] = ec;
+      if (ec == eGOBI_ERR_NONE)
+      {
+         snapshot.mValid |= item;
+      }
+   }
+}
+
+/*=========================================================================*/
+// cGobiQMICore Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   GetDeviceSnapshot (Public Method)
+
+DESCRIPTION:
+   This function queries the selected items of the device and returns 
+   them in one snapshot
+
+   The queries of every service are scheduled at once (each service's
+   protocol server runs on its own thread) and are waited on together, so
+   the snapshot takes about as long as the slowest query rather than the
+   sum of them
+
+PARAMETERS:
+   mask        [ I ] - Items to query (eGobiSnapshotItem)
+   pSnapshot   [ O ] - The device snapshot
+  
+RETURN VALUE:
+   eGobiError - eGOBI_ERR_NONE when every requested item was retrieved, 
+                otherwise the outcome of the first item that was not (the
+                outcome of each item is kept in the snapshot)
+===========================================================================*/
+eGobiError cGobiQMICore::GetDeviceSnapshot(
+   ULONG                      mask,
+   sGobiDeviceSnapshot *      pSnapshot )
+{
+   // Validate arguments
+   mask &= (ULONG)eGOBI_SNAPSHOT_ALL;
+   if (mask == 0 || pSnapshot == 0)
+   {
+      return eGOBI_ERR_INVALID_ARG;
+   }
+
+   sGobiDeviceSnapshot & snapshot = *pSnapshot;
+   snapshot = sGobiDeviceSnapshot();
+   snapshot.mRequested = mask;
+   snapshot.mRoaming = ULONG_MAX;
+   snapshot.mMCC = USHRT_MAX;
+   snapshot.mMNC = USHRT_MAX;
+   snapshot.mPowerMode = ULONG_MAX;
+
+   // Build the queries of the requested items, which are held until 
+   // every one has completed
+   std::vector <sProtocolBuffer> held( GOBI_SNAPSHOT_QUERY_COUNT );
+   std::vector <ULONG> handles( GOBI_SNAPSHOT_QUERY_COUNT, 
+                                INVALID_GOBI_SEND_HANDLE );
+
+   cGobiQMIResponseCollector collector;
+   ULONG oldWindows[GOBI_SNAPSHOT_SERVICE_COUNT];
+   bool bWidened[GOBI_SNAPSHOT_SERVICE_COUNT];
+
+   for (ULONG s = 0; s < GOBI_SNAPSHOT_SERVICE_COUNT; s++)
+   {
+      eQMIService svc = GOBI_SNAPSHOT_SERVICES[s];
+      oldWindows[s] = 0;
+      bWidened[s] = false;
+
+      std::vector <ULONG> queries;
+      std::vector <sSharedBuffer *> requests;
+      for (ULONG q = 0; q < GOBI_SNAPSHOT_QUERY_COUNT; q++)
+      {
+         const sGobiSnapshotQuery & query = GOBI_SNAPSHOT_QUERIES[q];
+         if (query.mSvc != svc || (query.mItems & mask) == 0)
+         {
+            continue;
+         }
+
+         sSharedBuffer * pReq = 0;
+         if (query.mMsgID == (WORD)eQMI_WDS_GET_STATISTICS)
+         {
+            pReq = BuildByteTotalsRequest();
+         }
+         else
+         {
+            pReq = sQMIServiceBuffer::BuildBuffer( svc, query.mMsgID );
+         }
+
+         if (pReq == 0)
+         {
+            SetSnapshotOutcome( snapshot, query.mItems, eGOBI_ERR_MEMORY );
+            continue;
+         }
+
+         held[q] = sProtocolBuffer( pReq );
+         queries.push_back( q );
+         requests.push_back( pReq );
+      }
+
+      ULONG reqCount = (ULONG)requests.size();
+      if (reqCount == 0)
+      {
+         continue;
+      }
+
+      // Widen the in-flight window of the server for the queries
+      cQMIProtocolServer * pSvr = GetServer( svc );
+      if (pSvr != 0)
+      {
+         oldWindows[s] = pSvr->GetInFlightWindow();
+         if ( (reqCount > oldWindows[s])
+         &&   (pSvr->SetInFlightWindow( reqCount ) == true) )
+         {
+            bWidened[s] = true;
+         }
+      }
+
+      std::vector <ULONG> svcHandles;
+      eGobiError rc = SendBatch( svc,
+                                 requests,
+                                 DEFAULT_GOBI_QMI_TIMEOUT,
+                                 &collector,
+                                 svcHandles );
+
+      if (rc == eGOBI_ERR_NONE)
+      {
+         // Not every request was scheduled
+         rc = eGOBI_ERR_REQ_SCHEDULE;
+      }
+
+      for (ULONG r = 0; r < reqCount; r++)
+      {
+         ULONG q = queries[r];
+         handles[q] = svcHandles[r];
+
+         if (handles[q] == INVALID_GOBI_SEND_HANDLE)
+         {
+            ULONG items = GOBI_SNAPSHOT_QUERIES[q].mItems;
+            SetSnapshotOutcome( snapshot, items, rc );
+         }
+      }
+   }
+
+   // Wait once for every query
+   collector.Wait( handles );
+
+   for (ULONG s = 0; s < GOBI_SNAPSHOT_SERVICE_COUNT; s++)
+   {
+      if (bWidened[s] == true)
+      {
+         cQMIProtocolServer * pSvr = GetServer( GOBI_SNAPSHOT_SERVICES[s] );
+         pSvr->SetInFlightWindow( oldWindows[s] );
+      }
+   }
+
+   // Parse the responses straight into the snapshot
+   for (ULONG q = 0; q < GOBI_SNAPSHOT_QUERY_COUNT; q++)
+   {
+      if (handles[q] == INVALID_GOBI_SEND_HANDLE)
+      {
+         continue;
+      }
+
+      const sGobiSnapshotQuery & query = GOBI_SNAPSHOT_QUERIES[q];
+
+      sProtocolBuffer rsp;
+      eGobiError ec = collector.GetResponse( handles[q], rsp );
+      if (ec != eGOBI_ERR_NONE)
+      {
+         SetSnapshotOutcome( snapshot, query.mItems, ec );
+         continue;
+      }
+
+      switch (query.mItems)
+      {
+         case eGOBI_SNAPSHOT_SESSION_STATE:
+            ec = ParseSessionState( rsp, &snapshot.mSessionState );
+            break;
+
+         case eGOBI_SNAPSHOT_DATA_BEARER:
+            ec = ParseDataBearerTechnology( rsp, &snapshot.mDataBearer );
+            break;
+
+         case eGOBI_SNAPSHOT_BYTE_TOTALS:
+            ec = ParseByteTotals( rsp, 
+                                  &snapshot.mTXTotalBytes, 
+                                  &snapshot.mRXTotalBytes );
+            break;
+
+         case eGOBI_SNAPSHOT_SIGNAL_STRENGTHS:
+            ec = ParseSignalStrengths( rsp,
+                                       GOBI_SNAPSHOT_MAX_SIGNALS,
+                                       &snapshot.mSignalCount,
+                                       &snapshot.mSignalStrengths[0],
+                                       &snapshot.mSignalRadioIfaces[0] );
+            break;
+
+         case eGOBI_SNAPSHOT_POWER:
+         {
+            ULONG reasonMask = 0;
+            ULONG bPlatform = 0;
+            ec = ParsePowerInfo( rsp, 
+                                 &snapshot.mPowerMode, 
+                                 &reasonMask, 
+                                 &bPlatform );
+         }
+         break;
+
+         case eGOBI_SNAPSHOT_ICCID:
+            ec = ParseICCID( rsp, 
+                             GOBI_SNAPSHOT_ICCID_SZ, 
+                             &snapshot.mICCID[0] );
+            break;
+
+         case eGOBI_SNAPSHOT_SERVING_NETWORK | eGOBI_SNAPSHOT_ROAMING:
+            ec = ParseServingNetwork( rsp,
+                                      &snapshot.mRegistrationState,
+                                      &snapshot.mCSDomain,
+                                      &snapshot.mPSDomain,
+                                      &snapshot.mRAN,
+                                      GOBI_SNAPSHOT_MAX_RADIO_IFACES,
+                                      &snapshot.mRadioIfaceCount,
+                                      (BYTE *)&snapshot.mRadioIfaces[0],
+                                      &snapshot.mRoaming,
+                                      &snapshot.mMCC,
+                                      &snapshot.mMNC,
+                                      GOBI_SNAPSHOT_NAME_SZ,
+                                      &snapshot.mNetworkName[0] );
+            break;
+
+         default:
+            ec = eGOBI_ERR_INTERNAL;
+            break;
+      }
+
+      SetSnapshotOutcome( snapshot, query.mItems, ec );
+   }
+
+   // First item that was not retrieved?
+   for (ULONG i = 0; i < GOBI_SNAPSHOT_ITEMS; i++)
+   {
+      if (snapshot.mErrors[i] != eGOBI_ERR_NONE)
+      {
+         return snapshot.mErrors[i];
+      }
+   }
+
+   return eGOBI_ERR_NONE;
+}
@@ -147,7 +147,7 @@ eGobiError cGobiQMICore::UIMSetPINProtection(
    else if (rc != 0)
    {
       // Prepare TLVs for parsing
-      std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+      cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
 
       // Parse the optional TLV we want (by DB key)
       sProtocolEntityKey tlvKey( eDB2_ET_QMI_DMS_RSP, msgID, 16 );
@@ -250,7 +250,7 @@ eGobiError cGobiQMICore::UIMVerifyPIN(
    else if (rc != 0)
    {
       // Prepare TLVs for parsing
-      std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+      cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
 
       // Parse the optional TLV we want (by DB key)
       sProtocolEntityKey tlvKey( eDB2_ET_QMI_DMS_RSP, msgID, 16 );
@@ -361,7 +361,7 @@ eGobiError cGobiQMICore::UIMUnblockPIN(
    else if (rc != 0)
    {
       // Prepare TLVs for parsing
-      std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+      cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
 
       // Parse the optional TLV we want (by DB key)
       sProtocolEntityKey tlvKey( eDB2_ET_QMI_DMS_RSP, msgID, 16 );
@@ -472,7 +472,7 @@ eGobiError cGobiQMICore::UIMChangePIN(
    else if (rc != 0)
    {
       // Prepare TLVs for parsing
-      std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+      cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
 
       // Parse the optional TLV we want (by DB key)
       sProtocolEntityKey tlvKey( eDB2_ET_QMI_DMS_RSP, msgID, 16 );
@@ -553,7 +553,7 @@ eGobiError cGobiQMICore::UIMGetPINStatus(
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    ULONG tlvID = 16 + id;
@@ -609,6 +609,33 @@ eGobiError cGobiQMICore::UIMGetICCID(
       return GetCorrectedLastError();
    }
 
+   return ParseICCID( rsp, stringSize, pString );
+}
+
+/*===========================================================================
+METHOD:
+   ParseICCID (Internal Method)
+
+DESCRIPTION:
+   Parse the response of a UIMGetICCID() request (also used by 
+   GetDeviceSnapshot())
+
+PARAMETERS:
+   rsp         [ I ] - QMI response
+   stringSize  [ I ] - The maximum number of characters (including NULL 
+                       terminator) that the string array can contain
+   pString     [ O ] - NULL terminated string
+
+RETURN VALUE:
+   eGobiError - Return code
+===========================================================================*/
+eGobiError cGobiQMICore::ParseICCID(
+   const sProtocolBuffer &    rsp,
+   BYTE                       stringSize, 
+   CHAR *                     pString )
+{
+   WORD msgID = (WORD)eQMI_DMS_UIM_GET_ICCID;
+
    // Did we receive a valid QMI response?
    sQMIServiceBuffer qmiRsp( rsp.GetSharedBuffer() );
    if (qmiRsp.IsValid() == false)
@@ -630,7 +657,7 @@ eGobiError cGobiQMICore::UIMGetICCID(
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (IMSI)
@@ -745,7 +772,7 @@ eGobiError cGobiQMICore::UIMGetControlKeyBlockingStatus(
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
 
    // Parse the required TLV we want (by DB key)
    sProtocolEntityKey tlvKey( eDB2_ET_QMI_DMS_RSP, msgID, 1 );
@@ -854,7 +881,7 @@ eGobiError cGobiQMICore::UIMSetControlKeyProtection(
    else if (rc != 0)
    {
       // Prepare TLVs for parsing
-      std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+      cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
 
       // Parse the optional TLV we want (by DB key)
       sProtocolEntityKey tlvKey( eDB2_ET_QMI_DMS_RSP, msgID, 16 );
@@ -948,7 +975,7 @@ eGobiError cGobiQMICore::UIMUnblockControlKey(
    else if (rc != 0)
    {
       // Prepare TLVs for parsing
-      std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+      cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
 
       // Parse the optional TLV we want (by DB key)
       sProtocolEntityKey tlvKey( eDB2_ET_QMI_DMS_RSP, msgID, 16 );
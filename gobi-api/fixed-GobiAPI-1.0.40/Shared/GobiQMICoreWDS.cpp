@@ -43,11 +43,24 @@ POSSIBILITY OF SUCH DAMAGE.
 #include "GobiQMICore.h"
 
 #include "QMIBuffers.h"
+#include "QMIViewsWDS.h"
 
 //---------------------------------------------------------------------------
 // Definitions
 //---------------------------------------------------------------------------
 
+// Statistics requested by GetPacketStatus()/GetByteTotals(), i.e. the
+// Tx/Rx packets OK, packet error and overflow counters/Tx/Rx bytes OK
+const ULONG WDS_STATS_MASK_PACKETS = 0x0000003F;
+const ULONG WDS_STATS_MASK_BYTES   = 0x000000C0;
+
+// Settings requested by GetIPAddress(), i.e. the IP address
+const ULONG WDS_SETTINGS_MASK_IP_ADDRESS = 0x00000100;
+
+// Default number of profile reads/writes awaiting a response at once 
+// (GetProfiles()/ApplyProfiles())
+const ULONG DEFAULT_GOBI_PROFILE_BATCH_WINDOW = 8;
+
 /*=========================================================================*/
 // cGobiQMICore Methods
 /*=========================================================================*/
@@ -81,8 +94,31 @@ eGobiError cGobiQMICore::GetSessionState( ULONG * pState )
       return GetCorrectedLastError();
    }
 
-   // Did we receive a valid QMI response?
-   sQMIServiceBuffer qmiRsp( rsp.GetSharedBuffer() );
+   return ParseSessionState( rsp, pState );
+}
+
+/*===========================================================================
+METHOD:
+   ParseSessionState (Internal Method)
+
+DESCRIPTION:
+   Parse the response of a GetSessionState() request (also used by 
+   GetDeviceSnapshot())
+
+PARAMETERS:
+   rsp         [ I ] - QMI response
+   pState      [ O ] - State of the current packet session
+
+RETURN VALUE:
+   eGobiError - Return code
+===========================================================================*/
+eGobiError cGobiQMICore::ParseSessionState(
+   const sProtocolBuffer &    rsp,
+   ULONG *                    pState )
+{
+   // Did we receive a valid QMI response? (decoded through the static
+   // view instead of the database, this is polled frequently)
+   cQMIViewWDSGetPacketServiceStatusRsp qmiRsp( rsp );
    if (qmiRsp.IsValid() == false)
    {
       return eGOBI_ERR_MALFORMED_RSP;
@@ -101,20 +137,15 @@ eGobiError cGobiQMICore::GetSessionState( ULONG * pState )
       return GetCorrectedQMIError( ec );
    }
 
-   // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
-   const cCoreDatabase & db = GetDatabase();
-
-   // Parse the TLV we want (by DB key)
-   sProtocolEntityKey tlvKey( eDB2_ET_QMI_WDS_RSP, msgID, 1 );
-   cDataParser::tParsedFields pf = ParseTLV( db, rsp, tlvs, tlvKey );
-   if (pf.size() < 1) 
+   // Parse the TLV we want
+   BYTE state = 0;
+   if (qmiRsp.GetConnectionStatus( state ) == false)
    {
       return eGOBI_ERR_INVALID_RSP;
    }
 
    // Populate the state
-   *pState = pf[0].mValue.mU32;
+   *pState = (ULONG)state;
    return eGOBI_ERR_NONE;
 }
 
@@ -168,7 +199,7 @@ eGobiError cGobiQMICore::GetSessionDuration( ULONGLONG * pDuration )
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (by DB key)
@@ -238,7 +269,7 @@ eGobiError cGobiQMICore::GetSessionDurations(
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (by DB key)
@@ -296,8 +327,9 @@ eGobiError cGobiQMICore::GetDormancyState( ULONG * pState )
       return GetCorrectedLastError();
    }
 
-   // Did we receive a valid QMI response?
-   sQMIServiceBuffer qmiRsp( rsp.GetSharedBuffer() );
+   // Did we receive a valid QMI response? (decoded through the static
+   // view instead of the database, this is polled frequently)
+   cQMIViewWDSGetDormancyStatusRsp qmiRsp( rsp );
    if (qmiRsp.IsValid() == false)
    {
       return eGOBI_ERR_MALFORMED_RSP;
@@ -316,20 +348,15 @@ eGobiError cGobiQMICore::GetDormancyState( ULONG * pState )
       return GetCorrectedQMIError( ec );
    }
 
-   // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
-   const cCoreDatabase & db = GetDatabase();
-
-   // Parse the TLV we want (by DB key)
-   sProtocolEntityKey tlvKey( eDB2_ET_QMI_WDS_RSP, msgID, 1 );
-   cDataParser::tParsedFields pf = ParseTLV( db, rsp, tlvs, tlvKey );
-   if (pf.size() < 1) 
+   // Parse the TLV we want
+   BYTE state = 0;
+   if (qmiRsp.GetDormancyStatus( state ) == false)
    {
       return eGOBI_ERR_INVALID_RSP;
    }
 
    // Populate the state
-   *pState = pf[0].mValue.mU32;
+   *pState = (ULONG)state;
    return eGOBI_ERR_NONE;
 }
 
@@ -369,8 +396,9 @@ eGobiError cGobiQMICore::GetEnhancedAutoconnect(
       return GetCorrectedLastError();
    }
 
-   // Did we receive a valid QMI response?
-   sQMIServiceBuffer qmiRsp( rsp.GetSharedBuffer() );
+   // Did we receive a valid QMI response? (decoded through the static
+   // view instead of the database, this is polled frequently)
+   cQMIViewWDSGetAutoconnectSettingsRsp qmiRsp( rsp );
    if (qmiRsp.IsValid() == false)
    {
       return eGOBI_ERR_MALFORMED_RSP;
@@ -389,25 +417,20 @@ eGobiError cGobiQMICore::GetEnhancedAutoconnect(
       return GetCorrectedQMIError( ec );
    }
 
-   // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
-   const cCoreDatabase & db = GetDatabase();
-
-   sProtocolEntityKey tlvKey( eDB2_ET_QMI_WDS_RSP, msgID, 1 );
-   cDataParser::tParsedFields pf = ParseTLV( db, rsp, tlvs, tlvKey );
-   if (pf.size() < 1) 
+   // Parse the TLV we want
+   BYTE setting = 0;
+   if (qmiRsp.GetStatus( setting ) == false)
    {
       return eGOBI_ERR_INVALID_RSP;
    }
 
-   *pSetting = (ULONG)pf[0].mValue.mU32;
+   *pSetting = (ULONG)setting;
 
-   // Parse the TLV we want (by DB key)
-   tlvKey = sProtocolEntityKey( eDB2_ET_QMI_WDS_RSP, msgID, 16 );
-   pf = ParseTLV( db, rsp, tlvs, tlvKey );
-   if (pf.size() > 0) 
+   // Parse the (optional) roam setting
+   BYTE roamSetting = 0;
+   if (qmiRsp.GetRoaming( roamSetting ) == true)
    {
-      *pRoamSetting = (ULONG)pf[0].mValue.mU32;
+      *pRoamSetting = (ULONG)roamSetting;
    }
 
    return eGOBI_ERR_NONE;
@@ -505,140 +528,105 @@ eGobiError cGobiQMICore::SetDefaultProfile(
    WORD msgID = (WORD)eQMI_WDS_MODIFY_PROFILE;
    std::vector <sDB2PackingInput> piv;
 
-   // "%u 1"
-   std::ostringstream tmp;
-   tmp << (UINT)profileType << " 1";
+   // Typed values of each TLV (packed as is, no string formatting)
+   cTypedFields tlvs[10];
+   ULONG t = 0;
+
+   tlvs[t].AddUnsigned( profileType ).AddUnsigned( 1 );
 
    sProtocolEntityKey pek( eDB2_ET_QMI_WDS_REQ, msgID, 1 );
-   sDB2PackingInput pi( pek, (LPCSTR)tmp.str().c_str() );
+   sDB2PackingInput pi( pek, tlvs[t++] );
    piv.push_back( pi );
 
    if (pName != 0)
    {
-      std::ostringstream tmp2;
-      if (pName[0] != 0)
-      {
-         tmp2 << "\"" << pName << "\"";
-      }
+      tlvs[t].AddString( pName );
 
       sProtocolEntityKey pek( eDB2_ET_QMI_WDS_REQ, msgID, 16 );
-      sDB2PackingInput pi( pek, (LPCSTR)tmp2.str().c_str() );
+      sDB2PackingInput pi( pek, tlvs[t++] );
       piv.push_back( pi );
    }
 
    if (pPDPType != 0)
    {
-      // "%u"
-      std::ostringstream tmp2;
-      tmp2 << (UINT)*pPDPType;
+      tlvs[t].AddUnsigned( *pPDPType );
 
       sProtocolEntityKey pek( eDB2_ET_QMI_WDS_REQ, msgID, 17 );
-      sDB2PackingInput pi( pek, (LPCSTR)tmp2.str().c_str() );
+      sDB2PackingInput pi( pek, tlvs[t++] );
       piv.push_back( pi );
    }
 
    if (pAPNName != 0)
    {
-      std::ostringstream tmp2;
-      if (pAPNName[0] != 0)
-      {
-         tmp2 << "\"" << pAPNName << "\"";
-      }
+      tlvs[t].AddString( pAPNName );
 
       sProtocolEntityKey pek( eDB2_ET_QMI_WDS_REQ, msgID, 20 );
-      sDB2PackingInput pi( pek, (LPCSTR)tmp2.str().c_str() );
+      sDB2PackingInput pi( pek, tlvs[t++] );
       piv.push_back( pi );
    }
 
    if (pPrimaryDNS != 0)
    {
-      ULONG ip4 = (*pPrimaryDNS & 0x000000FF);
-      ULONG ip3 = (*pPrimaryDNS & 0x0000FF00) >> 8;
-      ULONG ip2 = (*pPrimaryDNS & 0x00FF0000) >> 16;
-      ULONG ip1 = (*pPrimaryDNS & 0xFF000000) >> 24;
-
-      // "%u %u %u %u"
-      std::ostringstream tmp2;
-      tmp2 << (UINT)ip4 << " " << (UINT)ip3 << " " << (UINT)ip2 
-           << " " << (UINT)ip1;
+      tlvs[t].AddUnsigned( (*pPrimaryDNS & 0x000000FF) )
+             .AddUnsigned( (*pPrimaryDNS & 0x0000FF00) >> 8 )
+             .AddUnsigned( (*pPrimaryDNS & 0x00FF0000) >> 16 )
+             .AddUnsigned( (*pPrimaryDNS & 0xFF000000) >> 24 );
 
       sProtocolEntityKey pek( eDB2_ET_QMI_WDS_REQ, msgID, 21 );
-      sDB2PackingInput pi( pek, (LPCSTR)tmp2.str().c_str() );
+      sDB2PackingInput pi( pek, tlvs[t++] );
       piv.push_back( pi );
    }
 
    if (pSecondaryDNS != 0)
    {
-      ULONG ip4 = (*pSecondaryDNS & 0x000000FF);
-      ULONG ip3 = (*pSecondaryDNS & 0x0000FF00) >> 8;
-      ULONG ip2 = (*pSecondaryDNS & 0x00FF0000) >> 16;
-      ULONG ip1 = (*pSecondaryDNS & 0xFF000000) >> 24;
-
-      // "%u %u %u %u"
-      std::ostringstream tmp2;
-      tmp2 << (UINT)ip4 << " " << (UINT)ip3 << " " << (UINT)ip2 
-           << " " << (UINT)ip1;
+      tlvs[t].AddUnsigned( (*pSecondaryDNS & 0x000000FF) )
+             .AddUnsigned( (*pSecondaryDNS & 0x0000FF00) >> 8 )
+             .AddUnsigned( (*pSecondaryDNS & 0x00FF0000) >> 16 )
+             .AddUnsigned( (*pSecondaryDNS & 0xFF000000) >> 24 );
 
       sProtocolEntityKey pek( eDB2_ET_QMI_WDS_REQ, msgID, 22 );
-      sDB2PackingInput pi( pek, (LPCSTR)tmp2.str().c_str() );
+      sDB2PackingInput pi( pek, tlvs[t++] );
       piv.push_back( pi );
    }
 
    if (pUsername != 0)
    {
-      std::ostringstream tmp2;
-      if (pUsername[0] != 0)
-      {
-         tmp2 << "\"" << pUsername << "\"";
-      }
+      tlvs[t].AddString( pUsername );
 
       sProtocolEntityKey pek( eDB2_ET_QMI_WDS_REQ, msgID, 27 );
-      sDB2PackingInput pi( pek, (LPCSTR)tmp2.str().c_str() );
+      sDB2PackingInput pi( pek, tlvs[t++] );
       piv.push_back( pi );
    }
 
    if (pPassword != 0)
    {
-      std::ostringstream tmp2;
-      if (pPassword[0] != 0)
-      {
-         tmp2 << "\"" << pPassword << "\"";
-      }
+      tlvs[t].AddString( pPassword );
 
       sProtocolEntityKey pek( eDB2_ET_QMI_WDS_REQ, msgID, 28 );
-      sDB2PackingInput pi( pek, (LPCSTR)tmp2.str().c_str() );
+      sDB2PackingInput pi( pek, tlvs[t++] );
       piv.push_back( pi );
    }
 
    if (pAuthentication != 0)
    {
-      ULONG pap = *pAuthentication & 0x00000001;
-      ULONG chap = *pAuthentication & 0x00000002;
-      
-      // "%u %u"
-      std::ostringstream tmp2;
-      tmp2 << (UINT)pap << " " << (UINT)chap;
+      // PAP/CHAP flags
+      tlvs[t].AddUnsigned( *pAuthentication & 0x00000001 )
+             .AddUnsigned( (*pAuthentication & 0x00000002) >> 1 );
 
       sProtocolEntityKey pek( eDB2_ET_QMI_WDS_REQ, msgID, 29 );
-      sDB2PackingInput pi( pek, (LPCSTR)tmp2.str().c_str() );
+      sDB2PackingInput pi( pek, tlvs[t++] );
       piv.push_back( pi );
    }
 
    if (pIPAddress != 0)
    {
-      ULONG ip4 = (*pIPAddress & 0x000000FF);
-      ULONG ip3 = (*pIPAddress & 0x0000FF00) >> 8;
-      ULONG ip2 = (*pIPAddress & 0x00FF0000) >> 16;
-      ULONG ip1 = (*pIPAddress & 0xFF000000) >> 24;
-
-      // "%u %u %u %u"
-      std::ostringstream tmp2;
-      tmp2 << (UINT)ip4 << " " << (UINT)ip3 << " " << (UINT)ip2 
-           << " " << (UINT)ip1;
-
+      tlvs[t].AddUnsigned( (*pIPAddress & 0x000000FF) )
+             .AddUnsigned( (*pIPAddress & 0x0000FF00) >> 8 )
+             .AddUnsigned( (*pIPAddress & 0x00FF0000) >> 16 )
+             .AddUnsigned( (*pIPAddress & 0xFF000000) >> 24 );
 
       sProtocolEntityKey pek( eDB2_ET_QMI_WDS_REQ, msgID, 30 );
-      sDB2PackingInput pi( pek, (LPCSTR)tmp2.str().c_str() );
+      sDB2PackingInput pi( pek, tlvs[t++] );
       piv.push_back( pi );
    }
 
@@ -775,7 +763,7 @@ eGobiError cGobiQMICore::GetDefaultProfile(
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
 
    sProtocolEntityKey tlvKey( eDB2_ET_QMI_WDS_RSP, msgID, 16 );
    cDataParser::tParsedFields pf = ParseTLV( db, rsp, tlvs, tlvKey );
@@ -853,41 +841,437 @@ eGobiError cGobiQMICore::GetDefaultProfile(
       LONG strLen = pf[0].mValueString.size();
       if (strLen <= 0)
       {
-         return eGOBI_ERR_INVALID_RSP;
+         return eGOBI_ERR_INVALID_RSP;
+      }
+
+      // Space to perform the copy?
+      if (userSize < strLen + 1)
+      {
+         return eGOBI_ERR_BUFFER_SZ;
+      }
+
+      memcpy( (LPVOID)pUsername, (LPCSTR)pf[0].mValueString.c_str(), strLen );
+      pUsername[strLen] = 0;
+   }
+
+   tlvKey = sProtocolEntityKey( eDB2_ET_QMI_WDS_RSP, msgID, 29 );
+   pf = ParseTLV( db, rsp, tlvs, tlvKey );
+   if (pf.size() >= 2)
+   {
+      ULONG pap = (ULONG)pf[0].mValue.mU8;
+      ULONG chap = (ULONG)pf[1].mValue.mU8 << 1;
+
+      *pAuthentication = (pap | chap);   
+   }
+
+   tlvKey = sProtocolEntityKey( eDB2_ET_QMI_WDS_RSP, msgID, 30 );
+   pf = ParseTLV( db, rsp, tlvs, tlvKey );
+   if (pf.size() >= 4)
+   {
+      ULONG ip4 = (ULONG)pf[0].mValue.mU8;
+      ULONG ip3 = (ULONG)pf[1].mValue.mU8 << 8;
+      ULONG ip2 = (ULONG)pf[2].mValue.mU8 << 16;
+      ULONG ip1 = (ULONG)pf[3].mValue.mU8 << 24;
+      *pIPAddress = (ip4 | ip3 | ip2 | ip1);   
+   }
+
+   return eGOBI_ERR_NONE;
+}
+
+/*===========================================================================
+METHOD:
+   GetProfileList (Public Method)
+
+DESCRIPTION:
+   This function returns the indices of the profiles of the given type 
+   stored on the device
+
+PARAMETERS:
+   profileType [ I ] - Profile type being listed
+   indices     [ O ] - Index of each profile
+
+RETURN VALUE:
+   eGobiError - Return code
+===========================================================================*/
+eGobiError cGobiQMICore::GetProfileList(
+   ULONG                      profileType,
+   std::vector <BYTE> &       indices )
+{
+   indices.clear();
+
+   BYTE tlvs[8];
+   cQMIWriterWDSGetProfileListReq req( &tlvs[0], (ULONG)sizeof( tlvs ) );
+   req.SetProfileType( (BYTE)profileType );
+
+   sSharedBuffer * pRequest = req.BuildRequest();
+   if (pRequest == 0)
+   {
+      return eGOBI_ERR_MEMORY;
+   }
+
+   // Send the QMI request
+   sProtocolBuffer rsp = Send( eQMI_SVC_WDS, pRequest );
+   if (rsp.IsValid() == false)
+   {
+      return GetCorrectedLastError();
+   }
+
+   // Did we receive a valid QMI response?
+   cQMIViewWDSGetProfileListRsp qmiRsp( rsp );
+   if (qmiRsp.IsValid() == false)
+   {
+      return eGOBI_ERR_MALFORMED_RSP;
+   }
+
+   // Check the mandatory QMI result TLV for success
+   ULONG rc = 0;
+   ULONG ec = 0;
+   bool bResult = qmiRsp.GetResult( rc, ec );
+   if (bResult == false)
+   {
+      return eGOBI_ERR_MALFORMED_RSP;
+   }
+   else if (rc != 0)
+   {
+      return GetCorrectedQMIError( ec );
+   }
+
+   // Parse the TLV we want
+   cQMIViewWDSGetProfileListRsp::tProfileList profiles;
+   if (qmiRsp.GetProfileList( profiles ) == false)
+   {
+      return eGOBI_ERR_INVALID_RSP;
+   }
+
+   indices.reserve( profiles.GetCount() );
+
+   cQMIViewWDSGetProfileListRsp::tProfileList::cIterator iter( profiles );
+   cQMIViewWDSGetProfileListRsp::sProfileListElement profile;
+   while (iter.Next( profile ) == true)
+   {
+      BYTE index = 0;
+      if (profile.GetProfileIndex( index ) == false)
+      {
+         indices.clear();
+         return eGOBI_ERR_INVALID_RSP;
+      }
+
+      indices.push_back( index );
+   }
+
+   return eGOBI_ERR_NONE;
+}
+
+/*===========================================================================
+METHOD:
+   GetProfiles (Public Method)
+
+DESCRIPTION:
+   This function reads every profile of the given type, i.e. lists the 
+   profiles and then reads the settings of all of them at once, with up to
+   a window of reads awaiting a response at a time
+
+PARAMETERS:
+   profileType [ I ] - Profile type being read
+   profiles    [ O ] - The profiles (in device order), the outcome of 
+                       reading each one is in its error
+   window      [ I ] - Maximum number of reads awaiting a response
+
+RETURN VALUE:
+   eGobiError - Return code (eGOBI_ERR_NONE when the profiles were listed
+                and every read was scheduled)
+===========================================================================*/
+eGobiError cGobiQMICore::GetProfiles(
+   ULONG                            profileType,
+   std::vector <sGobiProfile> &     profiles,
+   ULONG                            window )
+{
+   profiles.clear();
+   if (window == 0)
+   {
+      return eGOBI_ERR_INVALID_ARG;
+   }
+
+   std::vector <BYTE> indices;
+   eGobiError rc = GetProfileList( profileType, indices );
+   if (rc != eGOBI_ERR_NONE || indices.size() == 0)
+   {
+      return rc;
+   }
+
+   profiles.resize( indices.size() );
+   for (ULONG p = 0; p < (ULONG)indices.size(); p++)
+   {
+      profiles[p].mProfileType = profileType;
+      profiles[p].mIndex = indices[p];
+   }
+
+   return ReadProfiles( profiles, window );
+}
+
+/*===========================================================================
+METHOD:
+   ApplyProfiles (Public Method)
+
+DESCRIPTION:
+   This function brings the given profiles on the device to the given 
+   settings: the current settings of every profile are read at once, and
+   then only the profiles with a setting that differs are written at once 
+   (with only the settings that differ), with up to a window of requests
+   awaiting a response at a time
+
+   NOTE: A password can not always be read back, so a password given is 
+   only compared when the device reports one, it is otherwise only written
+   along with the other settings of a profile that differs
+
+PARAMETERS:
+   profiles    [I/O] - The profiles (by type/index) and the settings each 
+                       one should have, on return the outcome of reading/
+                       writing each one is in its error, and the profiles
+                       written are flagged as such
+   pWritten    [ O ] - (Optional) number of profiles written
+   window      [ I ] - Maximum number of requests awaiting a response
+
+RETURN VALUE:
+   eGobiError - Return code (eGOBI_ERR_NONE when every request was 
+                scheduled)
+===========================================================================*/
+eGobiError cGobiQMICore::ApplyProfiles(
+   std::vector <sGobiProfile> &     profiles,
+   ULONG *                          pWritten,
+   ULONG                            window )
+{
+   if (pWritten != 0)
+   {
+      *pWritten = 0;
+   }
+
+   ULONG count = (ULONG)profiles.size();
+   if (count == 0 || window == 0)
+   {
+      return eGOBI_ERR_INVALID_ARG;
+   }
+
+   // Read the current settings of the profiles
+   std::vector <sGobiProfile> current( count );
+   for (ULONG p = 0; p < count; p++)
+   {
+      current[p].mProfileType = profiles[p].mProfileType;
+      current[p].mIndex = profiles[p].mIndex;
+
+      profiles[p].mbWritten = false;
+   }
+
+   eGobiError rc = ReadProfiles( current, window );
+
+   // Encode a write of the settings that differ (reusing the TLV buffer), 
+   // which are held until every write has completed
+   std::vector <BYTE> tlvs( QMI_MAX_BUFFER_SIZE );
+   std::vector <sSharedBuffer *> requests;
+   std::vector <sProtocolBuffer> held;
+   std::vector <ULONG> writes;
+   for (ULONG p = 0; p < count; p++)
+   {
+      sGobiProfile & want = profiles[p];
+      const sGobiProfile & have = current[p];
+
+      want.mError = have.mError;
+      if (want.mError != eGOBI_ERR_NONE)
+      {
+         continue;
+      }
+
+      ULONG changed = 0;
+      ULONG both = want.mValid & have.mValid;
+      changed |= (want.mValid & ~have.mValid);
+
+      if ( ((both & eGOBI_PROFILE_NAME) != 0)
+      &&   (want.mName != have.mName) )
+      {
+         changed |= eGOBI_PROFILE_NAME;
+      }
+
+      if ( ((both & eGOBI_PROFILE_PDP_TYPE) != 0)
+      &&   (want.mPDPType != have.mPDPType) )
+      {
+         changed |= eGOBI_PROFILE_PDP_TYPE;
+      }
+
+      if ( ((both & eGOBI_PROFILE_APN_NAME) != 0)
+      &&   (want.mAPNName != have.mAPNName) )
+      {
+         changed |= eGOBI_PROFILE_APN_NAME;
+      }
+
+      if ( ((both & eGOBI_PROFILE_PRIMARY_DNS) != 0)
+      &&   (want.mPrimaryDNS != have.mPrimaryDNS) )
+      {
+         changed |= eGOBI_PROFILE_PRIMARY_DNS;
+      }
+
+      if ( ((both & eGOBI_PROFILE_SECONDARY_DNS) != 0)
+      &&   (want.mSecondaryDNS != have.mSecondaryDNS) )
+      {
+         changed |= eGOBI_PROFILE_SECONDARY_DNS;
+      }
+
+      if ( ((both & eGOBI_PROFILE_USERNAME) != 0)
+      &&   (want.mUsername != have.mUsername) )
+      {
+         changed |= eGOBI_PROFILE_USERNAME;
+      }
+
+      if ( ((both & eGOBI_PROFILE_PASSWORD) != 0)
+      &&   (want.mPassword != have.mPassword) )
+      {
+         changed |= eGOBI_PROFILE_PASSWORD;
+      }
+
+      if ( ((both & eGOBI_PROFILE_AUTHENTICATION) != 0)
+      &&   (want.mAuthentication != have.mAuthentication) )
+      {
+         changed |= eGOBI_PROFILE_AUTHENTICATION;
+      }
+
+      if ( ((both & eGOBI_PROFILE_IP_ADDRESS) != 0)
+      &&   (want.mIPAddress != have.mIPAddress) )
+      {
+         changed |= eGOBI_PROFILE_IP_ADDRESS;
+      }
+
+      // A password not reported does not make a profile differ
+      if ((have.mValid & eGOBI_PROFILE_PASSWORD) == 0)
+      {
+         changed &= ~(ULONG)eGOBI_PROFILE_PASSWORD;
+      }
+
+      if (changed == 0)
+      {
+         continue;
+      }
+
+      if ((want.mValid & eGOBI_PROFILE_PASSWORD) != 0)
+      {
+         changed |= eGOBI_PROFILE_PASSWORD;
+      }
+
+      cQMIWriterWDSModifyProfileReq req( &tlvs[0], (ULONG)tlvs.size() );
+      req.SetProfileIdentifier( (BYTE)want.mProfileType, want.mIndex );
+
+      if ((changed & eGOBI_PROFILE_NAME) != 0)
+      {
+         req.SetProfileName( want.mName );
+      }
+
+      if ((changed & eGOBI_PROFILE_PDP_TYPE) != 0)
+      {
+         req.SetPDPType( (BYTE)want.mPDPType );
+      }
+
+      if ((changed & eGOBI_PROFILE_APN_NAME) != 0)
+      {
+         req.SetAPNName( want.mAPNName );
+      }
+
+      if ((changed & eGOBI_PROFILE_PRIMARY_DNS) != 0)
+      {
+         req.SetPrimaryIPv4DNSAddress( want.mPrimaryDNS );
+      }
+
+      if ((changed & eGOBI_PROFILE_SECONDARY_DNS) != 0)
+      {
+         req.SetSecondaryIPv4DNSAddress( want.mSecondaryDNS );
+      }
+
+      if ((changed & eGOBI_PROFILE_USERNAME) != 0)
+      {
+         req.SetUsername( want.mUsername );
+      }
+
+      if ((changed & eGOBI_PROFILE_PASSWORD) != 0)
+      {
+         req.SetPassword( want.mPassword );
+      }
+
+      if ((changed & eGOBI_PROFILE_AUTHENTICATION) != 0)
+      {
+         req.SetAuthentication( (BYTE)want.mAuthentication );
+      }
+
+      if ((changed & eGOBI_PROFILE_IP_ADDRESS) != 0)
+      {
+         req.SetIPv4AddressPreference( want.mIPAddress );
       }
 
-      // Space to perform the copy?
-      if (userSize < strLen + 1)
+      sSharedBuffer * pRequest = req.BuildRequest();
+      if (pRequest == 0)
       {
-         return eGOBI_ERR_BUFFER_SZ;
+         want.mError = eGOBI_ERR_MEMORY;
+         continue;
       }
 
-      memcpy( (LPVOID)pUsername, (LPCSTR)pf[0].mValueString.c_str(), strLen );
-      pUsername[strLen] = 0;
+      requests.push_back( pRequest );
+      held.push_back( sProtocolBuffer( pRequest ) );
+      writes.push_back( p );
    }
 
-   tlvKey = sProtocolEntityKey( eDB2_ET_QMI_WDS_RSP, msgID, 29 );
-   pf = ParseTLV( db, rsp, tlvs, tlvKey );
-   if (pf.size() >= 2)
+   ULONG writeCount = (ULONG)writes.size();
+   if (writeCount == 0)
    {
-      ULONG pap = (ULONG)pf[0].mValue.mU8;
-      ULONG chap = (ULONG)pf[1].mValue.mU8 << 1;
+      return rc;
+   }
 
-      *pAuthentication = (pap | chap);   
+   // Write the profiles that differ
+   cGobiQMIResponseCollector collector;
+   std::vector <ULONG> handles;
+   eGobiError writeRC = SendProfileBatch( requests, window, collector, handles );
+   if (rc == eGOBI_ERR_NONE)
+   {
+      rc = writeRC;
    }
 
-   tlvKey = sProtocolEntityKey( eDB2_ET_QMI_WDS_RSP, msgID, 30 );
-   pf = ParseTLV( db, rsp, tlvs, tlvKey );
-   if (pf.size() >= 4)
+   for (ULONG w = 0; w < writeCount; w++)
    {
-      ULONG ip4 = (ULONG)pf[0].mValue.mU8;
-      ULONG ip3 = (ULONG)pf[1].mValue.mU8 << 8;
-      ULONG ip2 = (ULONG)pf[2].mValue.mU8 << 16;
-      ULONG ip1 = (ULONG)pf[3].mValue.mU8 << 24;
-      *pIPAddress = (ip4 | ip3 | ip2 | ip1);   
+      sGobiProfile & profile = profiles[writes[w]];
+      if (handles[w] == INVALID_GOBI_SEND_HANDLE)
+      {
+         profile.mError = (writeRC != eGOBI_ERR_NONE 
+                           ? writeRC : eGOBI_ERR_REQ_SCHEDULE);
+         continue;
+      }
+
+      sProtocolBuffer rsp;
+      eGobiError ec = collector.GetResponse( handles[w], rsp );
+      if (ec != eGOBI_ERR_NONE)
+      {
+         profile.mError = ec;
+         continue;
+      }
+
+      // Did we receive a valid QMI response?
+      cQMIViewWDSModifyProfileRsp qmiRsp( rsp );
+      ULONG qmiRC = 0;
+      ULONG qmiEC = 0;
+      if ( (qmiRsp.IsValid() == false)
+      ||   (qmiRsp.GetResult( qmiRC, qmiEC ) == false) )
+      {
+         profile.mError = eGOBI_ERR_MALFORMED_RSP;
+         continue;
+      }
+      else if (qmiRC != 0)
+      {
+         profile.mError = GetCorrectedQMIError( qmiEC );
+         continue;
+      }
+
+      profile.mbWritten = true;
+      if (pWritten != 0)
+      {
+         (*pWritten)++;
+      }
    }
 
-   return eGOBI_ERR_NONE;
+   return rc;
 }
 
 /*===========================================================================
@@ -1135,7 +1519,7 @@ eGobiError cGobiQMICore::StartDataSession(
    else if (rc != 0)
    {
       // Prepare TLVs for parsing
-      std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+      cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
       const cCoreDatabase & db = GetDatabase();
 
       // Parse the TLV we want (by DB key)
@@ -1150,7 +1534,7 @@ eGobiError cGobiQMICore::StartDataSession(
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (by DB key)
@@ -1261,18 +1645,14 @@ eGobiError cGobiQMICore::GetIPAddress( ULONG * pIPAddress )
    // Assume failure
    *pIPAddress = ULONG_MAX;
 
-   WORD msgID = (WORD)eQMI_WDS_GET_SETTINGS;
-   std::vector <sDB2PackingInput> piv;
-
-   std::string tmp = "0 0 0 0 0 0 0 0 1 0 0 0 0 0 0 0 0 0";
-
-   sProtocolEntityKey pek( eDB2_ET_QMI_WDS_REQ, msgID, 16 );
-   sDB2PackingInput pi( pek, (LPCSTR)tmp.c_str() );
-   piv.push_back( pi );
+   // Encode the QMI request (only the IP address is requested, the
+   // response is decoded through the static view instead of the database,
+   // this is polled frequently)
+   BYTE tlvs[16];
+   cQMIWriterWDSGetCurrentSettingsReq req( &tlvs[0], (ULONG)sizeof( tlvs ) );
+   req.SetRequestedSettings( WDS_SETTINGS_MASK_IP_ADDRESS );
 
-   // Pack up the QMI request
-   const cCoreDatabase & db = GetDatabase();
-   sSharedBuffer * pRequest = DB2PackQMIBuffer( db, piv );
+   sSharedBuffer * pRequest = req.BuildRequest();
    if (pRequest == 0)
    {
       return eGOBI_ERR_MEMORY;
@@ -1286,7 +1666,7 @@ eGobiError cGobiQMICore::GetIPAddress( ULONG * pIPAddress )
    }
 
    // Did we receive a valid QMI response?
-   sQMIServiceBuffer qmiRsp( rsp.GetSharedBuffer() );
+   cQMIViewWDSGetCurrentSettingsRsp qmiRsp( rsp );
    if (qmiRsp.IsValid() == false)
    {
       return eGOBI_ERR_MALFORMED_RSP;
@@ -1305,23 +1685,14 @@ eGobiError cGobiQMICore::GetIPAddress( ULONG * pIPAddress )
       return GetCorrectedQMIError( ec );
    }
 
-   // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
-
-   // Parse the TLVs we want (IP address)
-   sProtocolEntityKey tlvKey( eDB2_ET_QMI_WDS_RSP, msgID, 30 );
-   cDataParser::tParsedFields pf = ParseTLV( db, rsp, tlvs, tlvKey );
-   if (pf.size() < 4) 
+   // Parse the TLV we want (IP address)
+   ULONG ip = 0;
+   if (qmiRsp.GetIPv4Address( ip ) == false)
    {
       return eGOBI_ERR_INVALID_RSP;
    }
 
-   ULONG ip4 = (ULONG)pf[0].mValue.mU8;
-   ULONG ip3 = (ULONG)pf[1].mValue.mU8 << 8;
-   ULONG ip2 = (ULONG)pf[2].mValue.mU8 << 16;
-   ULONG ip1 = (ULONG)pf[3].mValue.mU8 << 24;
-   *pIPAddress = (ip4 | ip3 | ip2 | ip1);
-
+   *pIPAddress = ip;
    return eGOBI_ERR_NONE;
 }
 
@@ -1365,8 +1736,9 @@ eGobiError cGobiQMICore::GetConnectionRate(
       return GetCorrectedLastError();
    }
 
-   // Did we receive a valid QMI response?
-   sQMIServiceBuffer qmiRsp( rsp.GetSharedBuffer() );
+   // Did we receive a valid QMI response? (decoded through the static
+   // view instead of the database, this is polled frequently)
+   cQMIViewWDSGetChannelRatesRsp qmiRsp( rsp );
    if (qmiRsp.IsValid() == false)
    {
       return eGOBI_ERR_MALFORMED_RSP;
@@ -1385,23 +1757,26 @@ eGobiError cGobiQMICore::GetConnectionRate(
       return GetCorrectedQMIError( ec );
    }
 
-   // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
-   const cCoreDatabase & db = GetDatabase();
-
-   // Parse the TLV we want (by DB key)
-   sProtocolEntityKey tlvKey( eDB2_ET_QMI_WDS_RSP, msgID, 1 );
-   cDataParser::tParsedFields pf = ParseTLV( db, rsp, tlvs, tlvKey );
-   if (pf.size() < 4) 
+   // Parse the TLV we want
+   cQMIViewWDSGetChannelRatesRsp::sChannelRates rates;
+   ULONG curTX = 0;
+   ULONG curRX = 0;
+   ULONG maxTX = 0;
+   ULONG maxRX = 0;
+   if ( (qmiRsp.GetChannelRates( rates ) == false)
+   ||   (rates.GetChannelTXRateBPS( curTX ) == false)
+   ||   (rates.GetChannelRXRateBPS( curRX ) == false)
+   ||   (rates.GetMaxChannelTXRateBPS( maxTX ) == false)
+   ||   (rates.GetMaxChannelRXRateBPS( maxRX ) == false) )
    {
       return eGOBI_ERR_INVALID_RSP;
    }
 
    // Populate the rates
-   *pCurrentChannelTXRate = pf[0].mValue.mU32;
-   *pCurrentChannelRXRate = pf[1].mValue.mU32;
-   *pMaxChannelTXRate = pf[2].mValue.mU32;
-   *pMaxChannelRXRate = pf[3].mValue.mU32;
+   *pCurrentChannelTXRate = curTX;
+   *pCurrentChannelRXRate = curRX;
+   *pMaxChannelTXRate = maxTX;
+   *pMaxChannelRXRate = maxRX;
    return eGOBI_ERR_NONE;
 }
 
@@ -1443,18 +1818,13 @@ eGobiError cGobiQMICore::GetPacketStatus(
       return eGOBI_ERR_INVALID_ARG;
    }
 
-   WORD msgID = (WORD)eQMI_WDS_GET_STATISTICS;
-   std::vector <sDB2PackingInput> piv;
-
-   std::string tmp = "1 1 1 1 1 1 0 0";
-
-   sProtocolEntityKey pek( eDB2_ET_QMI_WDS_REQ, msgID, 1 );
-   sDB2PackingInput pi( pek, (LPCSTR)tmp.c_str() );
-   piv.push_back( pi );
+   // Encode the QMI request (the statistics are decoded through the
+   // static view instead of the database, this is polled frequently)
+   BYTE tlvs[16];
+   cQMIWriterWDSGetPacketStatisticsReq req( &tlvs[0], (ULONG)sizeof( tlvs ) );
+   req.SetMask( WDS_STATS_MASK_PACKETS );
 
-   // Pack up the QMI request
-   const cCoreDatabase & db = GetDatabase();
-   sSharedBuffer * pRequest = DB2PackQMIBuffer( db, piv );
+   sSharedBuffer * pRequest = req.BuildRequest();
    if (pRequest == 0)
    {
       return eGOBI_ERR_MEMORY;
@@ -1468,7 +1838,7 @@ eGobiError cGobiQMICore::GetPacketStatus(
    }
 
    // Did we receive a valid QMI response?
-   sQMIServiceBuffer qmiRsp( rsp.GetSharedBuffer() );
+   cQMIViewWDSGetPacketStatisticsRsp qmiRsp( rsp );
    if (qmiRsp.IsValid() == false)
    {
       return eGOBI_ERR_MALFORMED_RSP;
@@ -1487,59 +1857,30 @@ eGobiError cGobiQMICore::GetPacketStatus(
       return GetCorrectedQMIError( ec );
    }
 
-   // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
-
-   // Parse the TLVs we want (by DB key)
-   sProtocolEntityKey tlvKey1( eDB2_ET_QMI_WDS_RSP, msgID, 16 );
-   cDataParser::tParsedFields pf1 = ParseTLV( db, rsp, tlvs, tlvKey1 );
-   if (pf1.size() < 1) 
-   {
-      return eGOBI_ERR_INVALID_RSP;
-   }
-
-   sProtocolEntityKey tlvKey2( eDB2_ET_QMI_WDS_RSP, msgID, 17 );
-   cDataParser::tParsedFields pf2 = ParseTLV( db, rsp, tlvs, tlvKey2 );
-   if (pf2.size() < 1) 
-   {
-      return eGOBI_ERR_INVALID_RSP;
-   }
-
-   sProtocolEntityKey tlvKey3( eDB2_ET_QMI_WDS_RSP, msgID, 18 );
-   cDataParser::tParsedFields pf3 = ParseTLV( db, rsp, tlvs, tlvKey3 );
-   if (pf3.size() < 1) 
-   {
-      return eGOBI_ERR_INVALID_RSP;
-   }
-
-   sProtocolEntityKey tlvKey4( eDB2_ET_QMI_WDS_RSP, msgID, 19 );
-   cDataParser::tParsedFields pf4 = ParseTLV( db, rsp, tlvs, tlvKey4 );
-   if (pf4.size() < 1) 
-   {
-      return eGOBI_ERR_INVALID_RSP;
-   }
-
-   sProtocolEntityKey tlvKey5( eDB2_ET_QMI_WDS_RSP, msgID, 20 );
-   cDataParser::tParsedFields pf5 = ParseTLV( db, rsp, tlvs, tlvKey5 );
-   if (pf5.size() < 1) 
-   {
-      return eGOBI_ERR_INVALID_RSP;
-   }
-
-   sProtocolEntityKey tlvKey6( eDB2_ET_QMI_WDS_RSP, msgID, 21 );
-   cDataParser::tParsedFields pf6 = ParseTLV( db, rsp, tlvs, tlvKey5 );
-   if (pf6.size() < 1) 
+   // Parse the TLVs we want
+   ULONG txOK = 0;
+   ULONG rxOK = 0;
+   ULONG txErr = 0;
+   ULONG rxErr = 0;
+   ULONG txOvf = 0;
+   ULONG rxOvf = 0;
+   if ( (qmiRsp.GetTxPacketsOk( txOK ) == false)
+   ||   (qmiRsp.GetRxPacketsOk( rxOK ) == false)
+   ||   (qmiRsp.GetTxPacketsError( txErr ) == false)
+   ||   (qmiRsp.GetRxPacketsError( rxErr ) == false)
+   ||   (qmiRsp.GetTxOverflows( txOvf ) == false)
+   ||   (qmiRsp.GetRxOverflows( rxOvf ) == false) )
    {
       return eGOBI_ERR_INVALID_RSP;
    }
 
    // Populate the statistics
-   *pTXPacketSuccesses = pf1[0].mValue.mU32;
-   *pRXPacketSuccesses = pf2[0].mValue.mU32;
-   *pTXPacketErrors = pf3[0].mValue.mU32;
-   *pRXPacketErrors = pf4[0].mValue.mU32;
-   *pTXPacketOverflows = pf5[0].mValue.mU32;
-   *pRXPacketOverflows = pf6[0].mValue.mU32;
+   *pTXPacketSuccesses = txOK;
+   *pRXPacketSuccesses = rxOK;
+   *pTXPacketErrors = txErr;
+   *pRXPacketErrors = rxErr;
+   *pTXPacketOverflows = txOvf;
+   *pRXPacketOverflows = rxOvf;
    return eGOBI_ERR_NONE;
 }
 
@@ -1568,18 +1909,8 @@ eGobiError cGobiQMICore::GetByteTotals(
       return eGOBI_ERR_INVALID_ARG;
    }
 
-   WORD msgID = (WORD)eQMI_WDS_GET_STATISTICS;
-   std::vector <sDB2PackingInput> piv;
-
-   std::string tmp = "0 0 0 0 0 0 1 1";
-
-   sProtocolEntityKey pek( eDB2_ET_QMI_WDS_REQ, msgID, 1 );
-   sDB2PackingInput pi( pek, (LPCSTR)tmp.c_str() );
-   piv.push_back( pi );
-
-   // Pack up the QMI request
-   const cCoreDatabase & db = GetDatabase();
-   sSharedBuffer * pRequest = DB2PackQMIBuffer( db, piv );
+   // Encode the QMI request
+   sSharedBuffer * pRequest = BuildByteTotalsRequest();
    if (pRequest == 0)
    {
       return eGOBI_ERR_MEMORY;
@@ -1592,8 +1923,50 @@ eGobiError cGobiQMICore::GetByteTotals(
       return GetCorrectedLastError();
    }
 
+   return ParseByteTotals( rsp, pTXTotalBytes, pRXTotalBytes );
+}
+
+/*===========================================================================
+METHOD:
+   BuildByteTotalsRequest (Internal Method)
+
+DESCRIPTION:
+   Build the request of GetByteTotals() (also used by GetDeviceSnapshot())
+
+RETURN VALUE:
+   sSharedBuffer * - The request (0 upon failure)
+===========================================================================*/
+sSharedBuffer * cGobiQMICore::BuildByteTotalsRequest()
+{
+   BYTE tlvs[16];
+   cQMIWriterWDSGetPacketStatisticsReq req( &tlvs[0], (ULONG)sizeof( tlvs ) );
+   req.SetMask( WDS_STATS_MASK_BYTES );
+   return req.BuildRequest();
+}
+
+/*===========================================================================
+METHOD:
+   ParseByteTotals (Internal Method)
+
+DESCRIPTION:
+   Parse the response of a GetByteTotals() request (also used by 
+   GetDeviceSnapshot())
+
+PARAMETERS:
+   rsp            [ I ] - QMI response
+   pTXTotalBytes  [ O ] - Bytes transmitted without error
+   pRXTotalBytes  [ O ] - Bytes received without error
+
+RETURN VALUE:
+   eGobiError - Return code
+===========================================================================*/
+eGobiError cGobiQMICore::ParseByteTotals(
+   const sProtocolBuffer &    rsp,
+   ULONGLONG *                pTXTotalBytes, 
+   ULONGLONG *                pRXTotalBytes )
+{
    // Did we receive a valid QMI response?
-   sQMIServiceBuffer qmiRsp( rsp.GetSharedBuffer() );
+   cQMIViewWDSGetPacketStatisticsRsp qmiRsp( rsp );
    if (qmiRsp.IsValid() == false)
    {
       return eGOBI_ERR_MALFORMED_RSP;
@@ -1612,26 +1985,18 @@ eGobiError cGobiQMICore::GetByteTotals(
       return GetCorrectedQMIError( ec );
    }
 
-   // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
-
-   sProtocolEntityKey tlvKey1( eDB2_ET_QMI_WDS_RSP, msgID, 25 );
-   cDataParser::tParsedFields pf1 = ParseTLV( db, rsp, tlvs, tlvKey1 );
-   if (pf1.size() < 1) 
-   {
-      return eGOBI_ERR_INVALID_RSP;
-   }
-
-   sProtocolEntityKey tlvKey2( eDB2_ET_QMI_WDS_RSP, msgID, 26 );
-   cDataParser::tParsedFields pf2 = ParseTLV( db, rsp, tlvs, tlvKey2 );
-   if (pf2.size() < 1) 
+   // Parse the TLVs we want
+   ULONGLONG txBytes = 0;
+   ULONGLONG rxBytes = 0;
+   if ( (qmiRsp.GetTxBytesOk( txBytes ) == false)
+   ||   (qmiRsp.GetRxBytesOk( rxBytes ) == false) )
    {
       return eGOBI_ERR_INVALID_RSP;
    }
 
    // Populate the statistics
-   *pTXTotalBytes = pf1[0].mValue.mU64;
-   *pRXTotalBytes = pf2[0].mValue.mU64;
+   *pTXTotalBytes = txBytes;
+   *pRXTotalBytes = rxBytes;
 
    return eGOBI_ERR_NONE;
 }
@@ -1720,7 +2085,7 @@ eGobiError cGobiQMICore::GetMobileIP( ULONG * pMode )
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (by DB key)
@@ -1842,7 +2207,7 @@ eGobiError cGobiQMICore::GetActiveMobileIPProfile( BYTE * pIndex )
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (by DB key)
@@ -2199,7 +2564,7 @@ eGobiError cGobiQMICore::GetMobileIPProfile(
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
 
    sProtocolEntityKey tlvKey1( eDB2_ET_QMI_WDS_RSP, msgID, 16 );
    cDataParser::tParsedFields pf1 = ParseTLV( db, rsp, tlvs, tlvKey1 );
@@ -2525,7 +2890,7 @@ eGobiError cGobiQMICore::GetMobileIPParameters(
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (by DB key)
@@ -2632,7 +2997,7 @@ eGobiError cGobiQMICore::GetLastMobileIPError( ULONG * pError )
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (by DB key)
@@ -2774,7 +3139,7 @@ eGobiError cGobiQMICore::GetDNSSettings(
    }
 
    // Prepare TLVs for parsing
-   std::vector <sDB2NavInput> tlvs = DB2ReduceQMIBuffer( qmiRsp );
+   cDB2NavInputs tlvs = DB2ReduceQMIBuffer( qmiRsp );
    const cCoreDatabase & db = GetDatabase();
 
    // Parse the TLV we want (by DB key)
@@ -2802,3 +3167,223 @@ eGobiError cGobiQMICore::GetDNSSettings(
 
    return eGOBI_ERR_NONE;
 }
+
+/*===========================================================================
+METHOD:
+   SendProfileBatch (Internal Method)
+
+DESCRIPTION:
+   Send the given WDS requests at once (see SendBatch()), widening the 
+   in-flight window of the WDS server to the given window for as long as 
+   they are in flight, and wait for every one of them
+
+PARAMETERS:
+   requests    [ I ] - The requests
+   window      [ I ] - Maximum number of requests awaiting a response
+   collector   [ I ] - Collector of the outcome of each request
+   handles     [ O ] - Handle of each request (INVALID_GOBI_SEND_HANDLE
+                       when not scheduled)
+
+RETURN VALUE:
+   eGobiError - Return code (eGOBI_ERR_NONE when every request was 
+                scheduled)
+===========================================================================*/
+eGobiError cGobiQMICore::SendProfileBatch(
+   const std::vector <sSharedBuffer *> &  requests,
+   ULONG                                  window,
+   cGobiQMIResponseCollector &            collector,
+   std::vector <ULONG> &                  handles )
+{
+   handles.assign( requests.size(), INVALID_GOBI_SEND_HANDLE );
+
+   cQMIProtocolServer * pSvr = GetServer( eQMI_SVC_WDS );
+   if (pSvr == 0)
+   {
+      return eGOBI_ERR_INTERNAL;
+   }
+
+   ULONG oldWindow = pSvr->GetInFlightWindow();
+   bool bWidened = false;
+   if (window > oldWindow && pSvr->SetInFlightWindow( window ) == true)
+   {
+      bWidened = true;
+   }
+
+   eGobiError rc = SendBatch( eQMI_SVC_WDS,
+                              requests,
+                              DEFAULT_GOBI_QMI_TIMEOUT,
+                              &collector,
+                              handles );
+
+   collector.Wait( handles );
+
+   if (bWidened == true)
+   {
+      pSvr->SetInFlightWindow( oldWindow );
+   }
+
+   return rc;
+}
+
+/*===========================================================================
+METHOD:
+   ReadProfiles (Internal Method)
+
+DESCRIPTION:
+   Read the settings of the given profiles (by type/index) at once, with 
+   up to a window of reads awaiting a response at a time
+
+PARAMETERS:
+   profiles    [I/O] - The profiles, on return the outcome of reading each 
+                       one is in its error
+   window      [ I ] - Maximum number of reads awaiting a response
+
+RETURN VALUE:
+   eGobiError - Return code (eGOBI_ERR_NONE when every read was scheduled)
+===========================================================================*/
+eGobiError cGobiQMICore::ReadProfiles(
+   std::vector <sGobiProfile> &     profiles,
+   ULONG                            window )
+{
+   // Encode the QMI requests (reusing the TLV buffer), which are held
+   // until every read has completed
+   ULONG count = (ULONG)profiles.size();
+   BYTE tlvs[8];
+   std::vector <sSharedBuffer *> requests( count, 0 );
+   std::vector <sProtocolBuffer> held( count );
+   for (ULONG p = 0; p < count; p++)
+   {
+      cQMIWriterWDSGetProfileSettingsReq req( &tlvs[0], (ULONG)sizeof( tlvs ) );
+      req.SetProfileID( (BYTE)profiles[p].mProfileType, profiles[p].mIndex );
+
+      requests[p] = req.BuildRequest();
+      if (requests[p] == 0)
+      {
+         return eGOBI_ERR_MEMORY;
+      }
+
+      held[p] = sProtocolBuffer( requests[p] );
+   }
+
+   cGobiQMIResponseCollector collector;
+   std::vector <ULONG> handles;
+   eGobiError rc = SendProfileBatch( requests, window, collector, handles );
+
+   for (ULONG p = 0; p < count; p++)
+   {
+      sGobiProfile & profile = profiles[p];
+      if (handles[p] == INVALID_GOBI_SEND_HANDLE)
+      {
+         profile.mError = (rc != eGOBI_ERR_NONE 
+                           ? rc : eGOBI_ERR_REQ_SCHEDULE);
+         continue;
+      }
+
+      sProtocolBuffer rsp;
+      profile.mError = collector.GetResponse( handles[p], rsp );
+      if (profile.mError == eGOBI_ERR_NONE)
+      {
+         profile.mError = ParseProfile( rsp, profile );
+      }
+   }
+
+   return rc;
+}
+
+/*===========================================================================
+METHOD:
+   ParseProfile (Internal Method)
+
+DESCRIPTION:
+   Parse a Get Profile Settings response (through the static view, 
+   straight from the response buffer) into the given profile
+
+PARAMETERS:
+   rsp         [ I ] - Response
+   profile     [ O ] - Profile, the settings present are flagged as valid
+
+RETURN VALUE:
+   eGobiError - Return code
+===========================================================================*/
+eGobiError cGobiQMICore::ParseProfile(
+   const sProtocolBuffer &    rsp,
+   sGobiProfile &             profile )
+{
+   profile.mValid = 0;
+
+   // Did we receive a valid QMI response?
+   cQMIViewWDSGetProfileSettingsRsp qmiRsp( rsp );
+   if (qmiRsp.IsValid() == false)
+   {
+      return eGOBI_ERR_MALFORMED_RSP;
+   }
+
+   // Check the mandatory QMI result TLV for success
+   ULONG rc = 0;
+   ULONG ec = 0;
+   bool bResult = qmiRsp.GetResult( rc, ec );
+   if (bResult == false)
+   {
+      return eGOBI_ERR_MALFORMED_RSP;
+   }
+   else if (rc != 0)
+   {
+      return GetCorrectedQMIError( ec );
+   }
+
+   // Every setting is optional
+   sQMIView str;
+   if (qmiRsp.GetProfileName( str ) == true)
+   {
+      profile.mName.assign( (LPCSTR)str.GetData(), str.GetSize() );
+      profile.mValid |= eGOBI_PROFILE_NAME;
+   }
+
+   BYTE val8 = 0;
+   if (qmiRsp.GetPDPType( val8 ) == true)
+   {
+      profile.mPDPType = (ULONG)val8;
+      profile.mValid |= eGOBI_PROFILE_PDP_TYPE;
+   }
+
+   if (qmiRsp.GetAPNName( str ) == true)
+   {
+      profile.mAPNName.assign( (LPCSTR)str.GetData(), str.GetSize() );
+      profile.mValid |= eGOBI_PROFILE_APN_NAME;
+   }
+
+   if (qmiRsp.GetPrimaryIPv4DNSAddress( profile.mPrimaryDNS ) == true)
+   {
+      profile.mValid |= eGOBI_PROFILE_PRIMARY_DNS;
+   }
+
+   if (qmiRsp.GetSecondaryIPv4DNSAddress( profile.mSecondaryDNS ) == true)
+   {
+      profile.mValid |= eGOBI_PROFILE_SECONDARY_DNS;
+   }
+
+   if (qmiRsp.GetUsername( str ) == true)
+   {
+      profile.mUsername.assign( (LPCSTR)str.GetData(), str.GetSize() );
+      profile.mValid |= eGOBI_PROFILE_USERNAME;
+   }
+
+   if (qmiRsp.GetPassword( str ) == true)
+   {
+      profile.mPassword.assign( (LPCSTR)str.GetData(), str.GetSize() );
+      profile.mValid |= eGOBI_PROFILE_PASSWORD;
+   }
+
+   if (qmiRsp.GetAuthentication( val8 ) == true)
+   {
+      profile.mAuthentication = (ULONG)val8;
+      profile.mValid |= eGOBI_PROFILE_AUTHENTICATION;
+   }
+
+   if (qmiRsp.GetIPv4AddressPreference( profile.mIPAddress ) == true)
+   {
+      profile.mValid |= eGOBI_PROFILE_IP_ADDRESS;
+   }
+
+   return eGOBI_ERR_NONE;
+}
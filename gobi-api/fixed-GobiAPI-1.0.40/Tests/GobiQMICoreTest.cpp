@@ -0,0 +1,385 @@
+/*===========================================================================
+FILE:
+   GobiQMICoreTest.cpp
+
+DESCRIPTION:
+   Hardware free tests of cGobiQMICore::Send() and CancelSend(), the DMS
+   server being connected to cCommReplay holding the responses: concurrent
+   sends answered out of order, send timeouts and sends cancelled while
+   awaiting their response
+
+PUBLIC CLASSES AND METHODS:
+   main
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "StdAfx.h"
+#include "CommReplay.h"
+#include "GobiQMICore.h"
+#include "QMIBuffers.h"
+
+//---------------------------------------------------------------------------
+// Definitions
+//---------------------------------------------------------------------------
+
+// Message ID sent (not answered from the response cache)
+const WORD TEST_MSG_ID = (WORD)eQMI_DMS_GET_TIME;
+
+// Time allowed to any expected outcome (milliseconds)
+const ULONG TEST_EVENT_TIMEOUT = 5000;
+
+// Send timeout of the timeout test (milliseconds)
+const ULONG TEST_SEND_TIMEOUT = 200;
+
+// Report a failed check and fail the test
+#define TEST_CHECK( cond )                                              \
+   if (!(cond))                                                         \
+   {                                                                    \
+      fprintf( stderr, "%s:%d: check failed: %s\n",                     \
+               __FILE__, __LINE__, #cond );                             \
+      return false;                                                     \
+   }
+
+/*=========================================================================*/
+// Class cTestQMICore
+//
+//    A cGobiQMICore with only a DMS server, finding a single (fake) device
+//    whose DMS server is connected to a replay transport holding all
+//    responses
+/*=========================================================================*/
+class cTestQMICore : public cGobiQMICore
+{
+   public:
+      // (Inline) Constructor
+      cTestQMICore()
+         :  mReplay( 0, 0.0 )
+      {
+         mServerConfig.insert( tServerConfig( eQMI_SVC_DMS, true ) );
+      };
+
+      // (Inline) Destructor
+      virtual ~cTestQMICore()
+      {
+         Cleanup();
+      };
+
+      // Initialize the object and connect to the fake device
+      bool Start()
+      {
+         if (Initialize() == false)
+         {
+            return false;
+         }
+
+         cQMIProtocolServer * pSvr = GetServer( eQMI_SVC_DMS );
+         if ( (pSvr == 0)
+         ||   (mReplay.SetHoldResponses( true ) == false)
+         ||   (pSvr->SetCommTransport( &mReplay ) == false) )
+         {
+            return false;
+         }
+
+         return Connect( "qcqmi-test" );
+      };
+
+      // (Inline) Return the single fake device
+      virtual std::vector <tDeviceID> GetAvailableDevices()
+      {
+         return std::vector <tDeviceID>( 1, tDeviceID( "qcqmi-test", "" ) );
+      };
+
+      /* Transport of the DMS server */
+      cCommReplay mReplay;
+};
+
+// A Send() run on its own thread
+struct sTestSend
+{
+   /* Object to send through */
+   cTestQMICore * mpCore;
+
+   /* Send timeout (milliseconds) */
+   ULONG mTimeout;
+
+   /* The response (invalid upon failure) and error recorded */
+   sProtocolBuffer mResponse;
+   eGobiError mError;
+
+   /* Is Send() done? */
+   volatile bool mbDone;
+
+   /* Sending thread */
+   pthread_t mThreadID;
+};
+
+/*=========================================================================*/
+// Free Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   SendThread (Free Method)
+
+DESCRIPTION:
+   Run a single Send() of the test message
+
+PARAMETERS:
+   pArg        [ I ] - The send (sTestSend)
+
+RETURN VALUE:
+   void * - thread exit value (always NULL)
+===========================================================================*/
+void * SendThread( PVOID pArg )
+{
+   sTestSend * pSend = (sTestSend *)pArg;
+
+   sSharedBuffer * pReq = 0;
+   pReq = sQMIServiceBuffer::BuildBuffer( eQMI_SVC_DMS, TEST_MSG_ID );
+
+   pSend->mResponse = pSend->mpCore->Send( eQMI_SVC_DMS,
+                                           pReq,
+                                           pSend->mTimeout );
+
+   pSend->mError = pSend->mpCore->GetLastError();
+   pSend->mbDone = true;
+   return NULL;
+}
+
+/*===========================================================================
+METHOD:
+   StartSend (Free Method)
+
+DESCRIPTION:
+   Start a Send() of the test message on its own thread
+
+PARAMETERS:
+   core        [ I ] - Object to send through
+   timeout     [ I ] - Send timeout (milliseconds)
+   send        [ O ] - The send
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool StartSend(
+   cTestQMICore &             core,
+   ULONG                      timeout,
+   sTestSend &                send )
+{
+   send.mpCore = &core;
+   send.mTimeout = timeout;
+   send.mError = eGOBI_ERR_NONE;
+   send.mbDone = false;
+
+   int nRet = pthread_create( &send.mThreadID, NULL, SendThread, &send );
+   return (nRet == 0);
+}
+
+/*===========================================================================
+METHOD:
+   GetTID (Free Method)
+
+DESCRIPTION:
+   Return the transaction ID of a QMI buffer
+
+PARAMETERS:
+   buf         [ I ] - The buffer
+
+RETURN VALUE:
+   WORD
+===========================================================================*/
+WORD GetTID( const sProtocolBuffer & buf )
+{
+   sQMIServiceBuffer qmiBuf( buf.GetSharedBuffer() );
+   return qmiBuf.GetTransactionID();
+}
+
+/*===========================================================================
+METHOD:
+   TestOutOfOrder (Free Method)
+
+DESCRIPTION:
+   Two concurrent sends answered in reverse order each return their own
+   response, the later send completing first
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool TestOutOfOrder()
+{
+   cTestQMICore core;
+   TEST_CHECK( core.Start() );
+   TEST_CHECK( core.GetServer( eQMI_SVC_DMS )->SetInFlightWindow( 2 ) );
+
+   sTestSend first;
+   sTestSend second;
+   TEST_CHECK( StartSend( core, TEST_EVENT_TIMEOUT, first ) );
+   TEST_CHECK( core.mReplay.WaitForHeldResponses( 1, TEST_EVENT_TIMEOUT ) );
+   TEST_CHECK( StartSend( core, TEST_EVENT_TIMEOUT, second ) );
+   TEST_CHECK( core.mReplay.WaitForHeldResponses( 2, TEST_EVENT_TIMEOUT ) );
+
+   // Answer the second send first
+   TEST_CHECK( core.mReplay.ReleaseResponse( 1 ) );
+   pthread_join( second.mThreadID, NULL );
+   TEST_CHECK( second.mResponse.IsValid() );
+   TEST_CHECK( first.mbDone == false );
+
+   TEST_CHECK( core.mReplay.ReleaseResponse( 0 ) );
+   pthread_join( first.mThreadID, NULL );
+   TEST_CHECK( first.mResponse.IsValid() );
+
+   TEST_CHECK( GetTID( first.mResponse ) != GetTID( second.mResponse ) );
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   TestTimeout (Free Method)
+
+DESCRIPTION:
+   An unanswered send fails once its timeout expires and a following send
+   is not completed by the late response to it
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool TestTimeout()
+{
+   cTestQMICore core;
+   TEST_CHECK( core.Start() );
+
+   ULONGLONG start = GetTickCount();
+
+   sTestSend send;
+   TEST_CHECK( StartSend( core, TEST_SEND_TIMEOUT, send ) );
+   pthread_join( send.mThreadID, NULL );
+
+   TEST_CHECK( send.mResponse.IsValid() == false );
+   TEST_CHECK( send.mError == eGOBI_ERR_RESPONSE_TO
+           ||  send.mError == eGOBI_ERR_RESPONSE );
+   TEST_CHECK( GetTickCount() - start >= TEST_SEND_TIMEOUT );
+
+   // The next send only completes with its own response
+   TEST_CHECK( StartSend( core, TEST_EVENT_TIMEOUT, send ) );
+   TEST_CHECK( core.mReplay.WaitForHeldResponses( 2, TEST_EVENT_TIMEOUT ) );
+   TEST_CHECK( core.mReplay.ReleaseResponse( 0 ) );
+   timespec quiet = { 0, 100000000 };
+   nanosleep( &quiet, 0 );
+   TEST_CHECK( send.mbDone == false );
+
+   TEST_CHECK( core.mReplay.ReleaseResponse( 0 ) );
+   pthread_join( send.mThreadID, NULL );
+   TEST_CHECK( send.mResponse.IsValid() );
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   TestCancelInFlight (Free Method)
+
+DESCRIPTION:
+   CancelSend() fails a send awaiting its response right away, there is
+   then nothing left to cancel
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool TestCancelInFlight()
+{
+   cTestQMICore core;
+   TEST_CHECK( core.Start() );
+   TEST_CHECK( core.CancelSend() == eGOBI_ERR_NO_CANCELABLE_OP );
+
+   ULONGLONG start = GetTickCount();
+
+   sTestSend send;
+   TEST_CHECK( StartSend( core, TEST_EVENT_TIMEOUT, send ) );
+   TEST_CHECK( core.mReplay.WaitForHeldResponses( 1, TEST_EVENT_TIMEOUT ) );
+
+   // Send() makes the request cancelable once scheduled, which may be 
+   // after it went out
+   eGobiError ec = core.CancelSend();
+   while ( (ec == eGOBI_ERR_NO_CANCELABLE_OP)
+   &&      (GetTickCount() - start < TEST_EVENT_TIMEOUT) )
+   {
+      timespec wait = { 0, 1000000 };
+      nanosleep( &wait, 0 );
+
+      ec = core.CancelSend();
+   }
+
+   TEST_CHECK( ec == eGOBI_ERR_NONE );
+   pthread_join( send.mThreadID, NULL );
+
+   TEST_CHECK( send.mResponse.IsValid() == false );
+   TEST_CHECK( send.mError == eGOBI_ERR_RESPONSE );
+   TEST_CHECK( GetTickCount() - start < TEST_EVENT_TIMEOUT );
+
+   TEST_CHECK( core.CancelSend() == eGOBI_ERR_NO_CANCELABLE_OP );
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   main
+
+DESCRIPTION:
+   Run all tests
+
+RETURN VALUE:
+   int - 0 upon success
+===========================================================================*/
+int main( int /* argc */, char ** /* argv */ )
+{
+   struct
+   {
+      LPCSTR mpName;
+      bool (* mpTest)();
+   } tests[] =
+   {
+      { "out of order responses", TestOutOfOrder },
+      { "send timeout", TestTimeout },
+      { "cancel in flight", TestCancelInFlight }
+   };
+
+   int failures = 0;
+   for (ULONG t = 0; t < sizeof( tests ) / sizeof( tests[0] ); t++)
+   {
+      bool bOK = tests[t].mpTest();
+      printf( "%s: %s\n", bOK == true ? "PASS" : "FAIL", tests[t].mpName );
+      if (bOK == false)
+      {
+         failures++;
+      }
+   }
+
+   return (failures == 0 ? 0 : 1);
+}
@@ -0,0 +1,417 @@
+/*===========================================================================
+FILE:
+   ProtocolServerTest.cpp
+
+DESCRIPTION:
+   Hardware free tests of the QMI protocol server request lifecycle, driven
+   through cCommReplay holding the responses: responses received out of
+   transaction ID order, response timeouts and requests cancelled while
+   awaiting their response
+
+PUBLIC CLASSES AND METHODS:
+   main
+
+Copyright (c) 2011, Code Aurora Forum. All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+    * Redistributions of source code must retain the above copyright
+      notice, this list of conditions and the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright
+      notice, this list of conditions and the following disclaimer in the
+      documentation and/or other materials provided with the distribution.
+    * Neither the name of Code Aurora Forum nor
+      the names of its contributors may be used to endorse or promote
+      products derived from this software without specific prior written
+      permission.
+
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+===========================================================================*/
+
+//---------------------------------------------------------------------------
+// Include Files
+//---------------------------------------------------------------------------
+#include "StdAfx.h"
+#include "CommReplay.h"
+#include "ProtocolNotification.h"
+#include "QMIBuffers.h"
+#include "QMIProtocolServer.h"
+
+//---------------------------------------------------------------------------
+// Definitions
+//---------------------------------------------------------------------------
+
+// Message ID requested
+const WORD TEST_MSG_ID = (WORD)eQMI_DMS_GET_CAPS;
+
+// Time allowed to any expected event (milliseconds)
+const ULONG TEST_EVENT_TIMEOUT = 5000;
+
+// Time no event is expected for (milliseconds)
+const ULONG TEST_QUIET_TIME = 300;
+
+// Request timeout of the timeout test (milliseconds)
+const ULONG TEST_REQUEST_TIMEOUT = 200;
+
+// Report a failed check and fail the test
+#define TEST_CHECK( cond )                                              \
+   if (!(cond))                                                         \
+   {                                                                    \
+      fprintf( stderr, "%s:%d: check failed: %s\n",                     \
+               __FILE__, __LINE__, #cond );                             \
+      return false;                                                     \
+   }
+
+// One protocol server under test and its transport
+struct sTestServer
+{
+   /* Transport holding the responses */
+   cCommReplay mReplay;
+
+   /* Protocol server */
+   cQMIProtocolServer mServer;
+
+   /* Notification of the requests */
+   tProtocolNotificationQueue mEvents;
+   cProtocolQueueNotification mNotifier;
+
+   // (Inline) Constructor
+   sTestServer()
+      :  mReplay( 0, 0.0 ),
+         mServer( eQMI_SVC_DMS, 8192, 512 ),
+         mEvents( 64, true ),
+         mNotifier( &mEvents )
+   { };
+
+   // (Inline) Destructor, the server is stopped before the notification
+   // queue goes away
+   ~sTestServer()
+   {
+      mServer.Disconnect();
+      mServer.Exit();
+   };
+};
+
+/*=========================================================================*/
+// Free Methods
+/*=========================================================================*/
+
+/*===========================================================================
+METHOD:
+   StartServer (Free Method)
+
+DESCRIPTION:
+   Connect the server under test with the given in-flight window
+
+PARAMETERS:
+   test        [ I ] - Server under test
+   window      [ I ] - In-flight window
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool StartServer(
+   sTestServer &              test,
+   ULONG                      window )
+{
+   TEST_CHECK( test.mReplay.SetHoldResponses( true ) );
+   TEST_CHECK( test.mServer.SetCommTransport( &test.mReplay ) );
+   TEST_CHECK( test.mServer.Initialize() );
+   TEST_CHECK( test.mServer.Connect( "replay0", "" ) );
+   TEST_CHECK( test.mServer.SetInFlightWindow( window ) );
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   SendRequest (Free Method)
+
+DESCRIPTION:
+   Add a single attempt request for the test message
+
+PARAMETERS:
+   test        [ I ] - Server under test
+   timeout     [ I ] - Request timeout (milliseconds)
+
+RETURN VALUE:
+   ULONG - Request ID (INVALID_REQUEST_ID upon failure)
+===========================================================================*/
+ULONG SendRequest(
+   sTestServer &              test,
+   ULONG                      timeout )
+{
+   sSharedBuffer * pReq = 0;
+   pReq = sQMIServiceBuffer::BuildBuffer( eQMI_SVC_DMS, TEST_MSG_ID );
+   if (pReq == 0)
+   {
+      return INVALID_REQUEST_ID;
+   }
+
+   sProtocolRequest req( pReq, 0, timeout, 1, 1, &test.mNotifier );
+   return test.mServer.AddRequest( req );
+}
+
+/*===========================================================================
+METHOD:
+   WaitForEvent (Free Method)
+
+DESCRIPTION:
+   Wait for the next completion (response received or request/response
+   error) of any request, transmissions are skipped after recording the
+   transaction ID of the request sent
+
+PARAMETERS:
+   test        [ I ] - Server under test
+   timeout     [ I ] - Time to wait (milliseconds)
+   evt         [ O ] - The completion
+   pTIDs       [I/O] - Transaction IDs sent by request ID (may be 0)
+
+RETURN VALUE:
+   bool - Was there a completion in time?
+===========================================================================*/
+bool WaitForEvent(
+   sTestServer &                 test,
+   ULONG                         timeout,
+   sProtocolNotificationEvent &  evt,
+   std::map <ULONG, WORD> *      pTIDs = 0 )
+{
+   cEvent & sigEvt = test.mEvents.GetSignalEvent();
+
+   ULONGLONG deadline = GetTickCount() + timeout;
+   while (true)
+   {
+      ULONGLONG now = GetTickCount();
+      if (now >= deadline)
+      {
+         return false;
+      }
+
+      DWORD idx;
+      if (sigEvt.Wait( (ULONG)(deadline - now), idx ) != 0)
+      {
+         return false;
+      }
+
+      if (test.mEvents.GetElement( idx, evt ) == false)
+      {
+         continue;
+      }
+
+      if (evt.mEventType != ePROTOCOL_EVT_REQ_SENT)
+      {
+         return true;
+      }
+
+      if (pTIDs != 0)
+      {
+         sProtocolBuffer req = test.mServer.GetLog().GetBuffer( evt.mParam2 );
+         sQMIServiceBuffer qmiReq( req.GetSharedBuffer() );
+         (*pTIDs)[evt.mParam1] = qmiReq.GetTransactionID();
+      }
+   }
+}
+
+/*===========================================================================
+METHOD:
+   GetResponseTID (Free Method)
+
+DESCRIPTION:
+   Return the transaction ID of the response a completion refers to
+
+PARAMETERS:
+   test        [ I ] - Server under test
+   evt         [ I ] - Response received completion
+
+RETURN VALUE:
+   WORD
+===========================================================================*/
+WORD GetResponseTID(
+   sTestServer &                       test,
+   const sProtocolNotificationEvent &  evt )
+{
+   sProtocolBuffer rsp = test.mServer.GetLog().GetBuffer( evt.mParam2 );
+   sQMIServiceBuffer qmiRsp( rsp.GetSharedBuffer() );
+   return qmiRsp.GetTransactionID();
+}
+
+/*===========================================================================
+METHOD:
+   TestOutOfOrder (Free Method)
+
+DESCRIPTION:
+   Responses received in reverse transaction ID order complete the
+   request each one answers
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool TestOutOfOrder()
+{
+   sTestServer test;
+   TEST_CHECK( StartServer( test, 3 ) );
+
+   std::vector <ULONG> reqIDs;
+   for (ULONG r = 0; r < 3; r++)
+   {
+      reqIDs.push_back( SendRequest( test, TEST_EVENT_TIMEOUT ) );
+      TEST_CHECK( reqIDs.back() != INVALID_REQUEST_ID );
+   }
+
+   // All three must be outstanding at once
+   TEST_CHECK( test.mReplay.WaitForHeldResponses( 3, TEST_EVENT_TIMEOUT ) );
+
+   // Answer the last, first and then middle request
+   std::map <ULONG, WORD> tids;
+   const ULONG order[] = { 2, 0, 1 };
+   const ULONG held[] = { 2, 0, 0 };
+   for (ULONG r = 0; r < 3; r++)
+   {
+      TEST_CHECK( test.mReplay.ReleaseResponse( held[r] ) );
+
+      sProtocolNotificationEvent evt;
+      TEST_CHECK( WaitForEvent( test, TEST_EVENT_TIMEOUT, evt, &tids ) );
+      TEST_CHECK( evt.mEventType == ePROTOCOL_EVT_RSP_RECV );
+      TEST_CHECK( evt.mParam1 == reqIDs[order[r]] );
+      TEST_CHECK( tids.find( evt.mParam1 ) != tids.end() );
+      TEST_CHECK( GetResponseTID( test, evt ) == tids[evt.mParam1] );
+   }
+
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   TestTimeout (Free Method)
+
+DESCRIPTION:
+   An unanswered request fails once its timeout expires, its response
+   arriving late is ignored and the server carries on with the next
+   request
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool TestTimeout()
+{
+   sTestServer test;
+   TEST_CHECK( StartServer( test, 2 ) );
+
+   ULONGLONG start = GetTickCount();
+   ULONG reqID = SendRequest( test, TEST_REQUEST_TIMEOUT );
+   TEST_CHECK( reqID != INVALID_REQUEST_ID );
+
+   sProtocolNotificationEvent evt;
+   TEST_CHECK( WaitForEvent( test, TEST_EVENT_TIMEOUT, evt ) );
+   TEST_CHECK( evt.mEventType == ePROTOCOL_EVT_RSP_ERR );
+   TEST_CHECK( evt.mParam1 == reqID );
+   TEST_CHECK( GetTickCount() - start >= TEST_REQUEST_TIMEOUT );
+
+   // The late response completes nothing
+   TEST_CHECK( test.mReplay.ReleaseResponse( 0 ) );
+   TEST_CHECK( WaitForEvent( test, TEST_QUIET_TIME, evt ) == false );
+
+   reqID = SendRequest( test, TEST_EVENT_TIMEOUT );
+   TEST_CHECK( reqID != INVALID_REQUEST_ID );
+   TEST_CHECK( test.mReplay.WaitForHeldResponses( 1, TEST_EVENT_TIMEOUT ) );
+   TEST_CHECK( test.mReplay.ReleaseResponse( 0 ) );
+
+   TEST_CHECK( WaitForEvent( test, TEST_EVENT_TIMEOUT, evt ) );
+   TEST_CHECK( evt.mEventType == ePROTOCOL_EVT_RSP_RECV );
+   TEST_CHECK( evt.mParam1 == reqID );
+
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   TestCancelInFlight (Free Method)
+
+DESCRIPTION:
+   A request removed while awaiting its response fails as cancelled right
+   away, its response arriving later is ignored while the other request
+   in flight still completes
+
+RETURN VALUE:
+   bool
+===========================================================================*/
+bool TestCancelInFlight()
+{
+   sTestServer test;
+   TEST_CHECK( StartServer( test, 2 ) );
+
+   ULONG reqID1 = SendRequest( test, TEST_EVENT_TIMEOUT );
+   ULONG reqID2 = SendRequest( test, TEST_EVENT_TIMEOUT );
+   TEST_CHECK( reqID1 != INVALID_REQUEST_ID );
+   TEST_CHECK( reqID2 != INVALID_REQUEST_ID );
+   TEST_CHECK( test.mReplay.WaitForHeldResponses( 2, TEST_EVENT_TIMEOUT ) );
+
+   TEST_CHECK( test.mServer.RemoveRequest( reqID1 ) );
+
+   sProtocolNotificationEvent evt;
+   TEST_CHECK( WaitForEvent( test, TEST_EVENT_TIMEOUT, evt ) );
+   TEST_CHECK( evt.mEventType == ePROTOCOL_EVT_RSP_ERR );
+   TEST_CHECK( evt.mParam1 == reqID1 );
+   TEST_CHECK( evt.mParam2 == (DWORD)ECANCELED );
+
+   // Cancelling it again fails
+   TEST_CHECK( test.mServer.RemoveRequest( reqID1 ) == false );
+
+   // The response to the cancelled request completes nothing
+   TEST_CHECK( test.mReplay.ReleaseResponse( 0 ) );
+   TEST_CHECK( WaitForEvent( test, TEST_QUIET_TIME, evt ) == false );
+
+   TEST_CHECK( test.mReplay.ReleaseResponse( 0 ) );
+   TEST_CHECK( WaitForEvent( test, TEST_EVENT_TIMEOUT, evt ) );
+   TEST_CHECK( evt.mEventType == ePROTOCOL_EVT_RSP_RECV );
+   TEST_CHECK( evt.mParam1 == reqID2 );
+
+   return true;
+}
+
+/*===========================================================================
+METHOD:
+   main
+
+DESCRIPTION:
+   Run all tests
+
+RETURN VALUE:
+   int - 0 upon success
+===========================================================================*/
+int main( int /* argc */, char ** /* argv */ )
+{
+   struct
+   {
+      LPCSTR mpName;
+      bool (* mpTest)();
+   } tests[] =
+   {
+      { "out of order responses", TestOutOfOrder },
+      { "response timeout", TestTimeout },
+      { "cancel in flight", TestCancelInFlight }
+   };
+
+   int failures = 0;
+   for (ULONG t = 0; t < sizeof( tests ) / sizeof( tests[0] ); t++)
+   {
+      bool bOK = tests[t].mpTest();
+      printf( "%s: %s\n", bOK == true ? "PASS" : "FAIL", tests[t].mpName );
+      if (bOK == false)
+      {
+         failures++;
+      }
+   }
+
+   return (failures == 0 ? 0 : 1);
+}
@@ -29,6 +29,9 @@
 #include <fcntl.h>
 #include <termios.h>
 #include <unistd.h>
+#include <sys/stat.h>
+
+#include <glib/gstdio.h>
 
 #include "qmi-device.h"
 #include "qmi-message.h"
@@ -60,6 +63,7 @@
 #include "qmi-enum-types.h"
 #include "qmi-proxy.h"
 #include "qmi-version.h"
+#include "qmi-worker.h"
 
 #if QMI_QRTR_SUPPORTED
 # include <libqrtr-glib.h>
@@ -92,6 +96,14 @@ enum {
 static GParamSpec *properties[PROP_LAST];
 static guint       signals   [SIGNAL_LAST] = { 0 };
 
+typedef struct {
+    gint64       timestamp;
+    gboolean     sent;
+    const gchar *message_str;
+    guint16      vendor_id;
+    GByteArray  *raw;
+} TraceRingEntry;
+
 struct _QmiDevicePrivate {
     /* File or node */
     QmiFile *file;
@@ -111,6 +123,11 @@ struct _QmiDevicePrivate {
     /* Supported services */
     GArray *supported_services;
 
+    /* Services to preallocate client IDs for when opening, and the client
+     * IDs preallocated and not yet given to any client */
+    GArray *preallocate_services;
+    GArray *preallocated_cids;
+
     /* Lower-level transport */
     QmiEndpoint *endpoint;
     guint endpoint_new_data_id;
@@ -122,14 +139,47 @@ struct _QmiDevicePrivate {
     /* HT to keep track of ongoing transactions */
     GHashTable *transactions;
 
+    /* Min-heap of transactions by timeout deadline, with a single source
+     * waking up for the earliest one */
+    GPtrArray *transaction_timeouts;
+    GSource *transaction_timeout_source;
+
     /* HT of clients that want to get indications */
     GHashTable *registered_clients;
+
+    /* Indications not yet reported to their clients, oldest first */
+    GQueue *pending_indications;
+    GSource *indication_source;
+
+    /* Messages received by an endpoint doing its I/O in a worker thread */
+    struct _WorkerInput *worker_input;
+
+    /* Ring of the latest messages sent or received */
+    TraceRingEntry *trace_ring;
+    guint trace_ring_size;
+    guint trace_ring_next;
+    guint trace_ring_n_entries;
+
+    /* Reused to print traced messages */
+    GString *trace_buffer;
+
+    /* Most requests waiting for the port to be writable */
+    guint tx_queue_max_size;
+
+    /* Performance counters */
+    struct _DeviceStatistics *statistics;
 };
 
 #if QMI_QRTR_SUPPORTED
 # define QMI_CLIENT_VERSION_UNKNOWN 99
 #endif
 
+/* Maximum number of indications reported to clients in a single main loop
+ * iteration; the rest wait for the next one */
+#ifndef QMI_DEVICE_INDICATION_BUDGET
+# define QMI_DEVICE_INDICATION_BUDGET 32
+#endif
+
 /*****************************************************************************/
 /* Message transactions (private) */
 
@@ -138,14 +188,18 @@ typedef struct {
     gpointer   key;
 } TransactionWaitContext;
 
+#define TRANSACTION_TIMEOUT_INDEX_NONE G_MAXUINT
+
 typedef struct {
     QmiMessage             *message;
     QmiMessageContext      *message_context;
     GSimpleAsyncResult     *result;
-    GSource                *timeout_source;
+    gint64                  timeout_deadline;
+    guint                   timeout_index;
     GCancellable           *cancellable;
     gulong                  cancellable_id;
     TransactionWaitContext *wait_ctx;
+    gint64                  sent_time;
 
     /* abortable support */
     GError                                   *abort_error;
@@ -175,10 +229,235 @@ transaction_new (QmiDevice           *self,
                                             transaction_new);
     if (cancellable)
         tr->cancellable = g_object_ref (cancellable);
+    tr->timeout_index = TRANSACTION_TIMEOUT_INDEX_NONE;
 
     return tr;
 }
 
+/*****************************************************************************/
+/* Statistics (private)
+ *
+ * Counters are only updated from the context of the device, but may be read
+ * from any thread, so they're all accessed atomically. The counters of each
+ * service are allocated the first time the service is used. */
+
+typedef struct {
+    volatile gsize requests_sent;
+    volatile gsize responses_received;
+    volatile gsize latency_histogram[QMI_DEVICE_STATISTICS_N_LATENCY_BUCKETS];
+} ServiceStatistics;
+
+typedef struct _DeviceStatistics {
+    volatile gsize     timeouts;
+    volatile gsize     aborts;
+    volatile gsize     indications_received;
+    volatile gsize     indications_dropped;
+    volatile gsize     bytes_in;
+    volatile gsize     bytes_out;
+    ServiceStatistics *services[G_MAXUINT8 + 1];
+} DeviceStatistics;
+
+#define STATISTICS_INC(counter)      g_atomic_pointer_add (&(counter), 1)
+#define STATISTICS_ADD(counter, val) g_atomic_pointer_add (&(counter), (val))
+#define STATISTICS_GET(counter)      ((guint64) GPOINTER_TO_SIZE (g_atomic_pointer_get (&(counter))))
+
+static ServiceStatistics *
+statistics_peek_service (QmiDevice *self,
+                         QmiService service)
+{
+    ServiceStatistics **service_statistics;
+
+    service_statistics = &self->priv->statistics->services[(guint8)service];
+    if (G_UNLIKELY (!*service_statistics))
+        g_atomic_pointer_set (service_statistics, g_new0 (ServiceStatistics, 1));
+    return *service_statistics;
+}
+
+static void
+statistics_request_sent (QmiDevice   *self,
+                         Transaction *tr)
+{
+    tr->sent_time = g_get_monotonic_time ();
+    STATISTICS_ADD (self->priv->statistics->bytes_out, ((GByteArray *)tr->message)->len);
+    STATISTICS_INC (statistics_peek_service (self, qmi_message_get_service (tr->message))->requests_sent);
+}
+
+static void
+statistics_response_received (QmiDevice   *self,
+                              Transaction *tr)
+{
+    ServiceStatistics *service_statistics;
+    gint64             latency_ms;
+    guint              bucket;
+
+    /* Bucket 0 for less than 1ms, bucket n for less than 2^n ms */
+    latency_ms = (g_get_monotonic_time () - tr->sent_time) / 1000;
+    bucket = MIN (g_bit_storage ((gulong) MAX (latency_ms, 0)), QMI_DEVICE_STATISTICS_N_LATENCY_BUCKETS - 1);
+
+    service_statistics = statistics_peek_service (self, qmi_message_get_service (tr->message));
+    STATISTICS_INC (service_statistics->responses_received);
+    STATISTICS_INC (service_statistics->latency_histogram[bucket]);
+}
+
+static void
+statistics_free (DeviceStatistics *statistics)
+{
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (statistics->services); i++)
+        g_free (statistics->services[i]);
+    g_free (statistics);
+}
+
+void
+qmi_device_get_statistics (QmiDevice           *self,
+                           QmiDeviceStatistics *statistics)
+{
+    DeviceStatistics *device_statistics;
+
+    g_return_if_fail (QMI_IS_DEVICE (self));
+    g_return_if_fail (statistics != NULL);
+
+    device_statistics = self->priv->statistics;
+    statistics->timeouts             = STATISTICS_GET (device_statistics->timeouts);
+    statistics->aborts               = STATISTICS_GET (device_statistics->aborts);
+    statistics->indications_received = STATISTICS_GET (device_statistics->indications_received);
+    statistics->indications_dropped  = STATISTICS_GET (device_statistics->indications_dropped);
+    statistics->bytes_in             = STATISTICS_GET (device_statistics->bytes_in);
+    statistics->bytes_out            = STATISTICS_GET (device_statistics->bytes_out);
+}
+
+void
+qmi_device_get_service_statistics (QmiDevice                  *self,
+                                   QmiService                  service,
+                                   QmiDeviceServiceStatistics *statistics)
+{
+    ServiceStatistics *service_statistics;
+    guint              i;
+
+    g_return_if_fail (QMI_IS_DEVICE (self));
+    g_return_if_fail (statistics != NULL);
+
+    memset (statistics, 0, sizeof (QmiDeviceServiceStatistics));
+
+    service_statistics = g_atomic_pointer_get (&self->priv->statistics->services[(guint8)service]);
+    if (!service_statistics)
+        return;
+
+    statistics->requests_sent      = STATISTICS_GET (service_statistics->requests_sent);
+    statistics->responses_received = STATISTICS_GET (service_statistics->responses_received);
+    for (i = 0; i < QMI_DEVICE_STATISTICS_N_LATENCY_BUCKETS; i++)
+        statistics->latency_histogram[i] = STATISTICS_GET (service_statistics->latency_histogram[i]);
+}
+
+/*****************************************************************************/
+/* Transaction timeouts (private)
+ *
+ * Instead of a timeout source per transaction, transactions with a timeout
+ * are kept in a binary min-heap sorted by deadline, and a single source per
+ * device is rearmed to wake up when the earliest one expires. */
+
+static inline void
+transaction_timeouts_set (QmiDevice   *self,
+                          guint        i,
+                          Transaction *tr)
+{
+    g_ptr_array_index (self->priv->transaction_timeouts, i) = tr;
+    tr->timeout_index = i;
+}
+
+static void
+transaction_timeouts_sift_up (QmiDevice *self,
+                              guint      i)
+{
+    Transaction *tr;
+
+    tr = g_ptr_array_index (self->priv->transaction_timeouts, i);
+    while (i > 0) {
+        Transaction *parent;
+
+        parent = g_ptr_array_index (self->priv->transaction_timeouts, (i - 1) / 2);
+        if (parent->timeout_deadline <= tr->timeout_deadline)
+            break;
+        transaction_timeouts_set (self, i, parent);
+        i = (i - 1) / 2;
+    }
+    transaction_timeouts_set (self, i, tr);
+}
+
+static void
+transaction_timeouts_sift_down (QmiDevice *self,
+                                guint      i)
+{
+    Transaction *tr;
+    guint        len;
+
+    len = self->priv->transaction_timeouts->len;
+    tr = g_ptr_array_index (self->priv->transaction_timeouts, i);
+    while (2 * i + 1 < len) {
+        Transaction *child;
+        guint        child_i;
+
+        child_i = 2 * i + 1;
+        if (child_i + 1 < len &&
+            ((Transaction *) g_ptr_array_index (self->priv->transaction_timeouts, child_i + 1))->timeout_deadline <
+            ((Transaction *) g_ptr_array_index (self->priv->transaction_timeouts, child_i))->timeout_deadline)
+            child_i++;
+        child = g_ptr_array_index (self->priv->transaction_timeouts, child_i);
+        if (tr->timeout_deadline <= child->timeout_deadline)
+            break;
+        transaction_timeouts_set (self, i, child);
+        i = child_i;
+    }
+    transaction_timeouts_set (self, i, tr);
+}
+
+static void
+transaction_timeouts_rearm (QmiDevice *self)
+{
+    Transaction *earliest;
+
+    if (!self->priv->transaction_timeout_source)
+        return;
+
+    if (!self->priv->transaction_timeouts->len) {
+        g_source_set_ready_time (self->priv->transaction_timeout_source, -1);
+        return;
+    }
+
+    earliest = g_ptr_array_index (self->priv->transaction_timeouts, 0);
+    g_source_set_ready_time (self->priv->transaction_timeout_source, earliest->timeout_deadline);
+}
+
+static void
+transaction_timeouts_remove (QmiDevice   *self,
+                             Transaction *tr)
+{
+    Transaction *last;
+    guint        i;
+
+    if (tr->timeout_index == TRANSACTION_TIMEOUT_INDEX_NONE)
+        return;
+
+    i = tr->timeout_index;
+    tr->timeout_index = TRANSACTION_TIMEOUT_INDEX_NONE;
+
+    /* Move the last one to the free slot, and restore the heap from there */
+    last = g_ptr_array_remove_index (self->priv->transaction_timeouts,
+                                     self->priv->transaction_timeouts->len - 1);
+    if (last != tr) {
+        transaction_timeouts_set (self, i, last);
+        transaction_timeouts_sift_down (self, i);
+        transaction_timeouts_sift_up (self, last->timeout_index);
+    }
+
+    /* Only need to wake up at a different time if the earliest one changed */
+    if (i == 0)
+        transaction_timeouts_rearm (self);
+}
+
+/*****************************************************************************/
+
 static void
 transaction_complete_and_free (Transaction  *tr,
                                QmiMessage   *reply,
@@ -204,8 +483,8 @@ transaction_complete_and_free (Transaction  *tr,
     else
         g_assert_not_reached ();
 
-    if (tr->timeout_source)
-        g_source_destroy (tr->timeout_source);
+    if (tr->wait_ctx)
+        transaction_timeouts_remove (tr->wait_ctx->self, tr);
 
     if (tr->cancellable) {
         if (tr->cancellable_id)
@@ -377,6 +656,7 @@ transaction_abort (QmiDevice   *self,
      * operation has been acknowledged by the device. */
     tr->abort_error = abort_error_take;
     tr->abort_cancellable = g_cancellable_new ();
+    STATISTICS_INC (self->priv->statistics->aborts);
 
     qmi_device_command_full (self,
                              abort_request,
@@ -390,21 +670,80 @@ transaction_abort (QmiDevice   *self,
 }
 
 static gboolean
-transaction_timed_out (TransactionWaitContext *ctx)
+process_transaction_timeouts (QmiDevice *self)
 {
-    Transaction *tr;
-    GError *error = NULL;
+    gint64 now;
 
-    /* A timed out transaction is always tracked */
-    tr = device_peek_transaction (ctx->self, ctx->key);
-    g_assert (tr);
+    /* Aborting a transaction may complete others, so the earliest one is
+     * looked up again on every iteration */
+    now = g_get_monotonic_time ();
+    while (self->priv->transaction_timeouts->len > 0) {
+        Transaction *tr;
+
+        tr = g_ptr_array_index (self->priv->transaction_timeouts, 0);
+        if (tr->timeout_deadline > now)
+            break;
 
-    tr->timeout_source = NULL;
+        /* A timed out transaction is always tracked */
+        g_assert (device_peek_transaction (self, tr->wait_ctx->key) == tr);
 
-    error = g_error_new (QMI_CORE_ERROR, QMI_CORE_ERROR_TIMEOUT, "Transaction timed out");
-    transaction_abort (ctx->self, tr, error);
+        transaction_timeouts_remove (self, tr);
+        STATISTICS_INC (self->priv->statistics->timeouts);
+        transaction_abort (self,
+                           tr,
+                           g_error_new (QMI_CORE_ERROR, QMI_CORE_ERROR_TIMEOUT, "Transaction timed out"));
+    }
+
+    transaction_timeouts_rearm (self);
+    return G_SOURCE_CONTINUE;
+}
+
+static gboolean
+transaction_timeout_source_dispatch (GSource     *source,
+                                     GSourceFunc  callback,
+                                     gpointer     user_data)
+{
+    return callback (user_data);
+}
+
+static GSourceFuncs transaction_timeout_source_funcs = {
+    NULL, /* prepare */
+    NULL, /* check */
+    transaction_timeout_source_dispatch,
+    NULL, /* finalize */
+};
+
+static void
+transaction_timeouts_add (QmiDevice   *self,
+                          Transaction *tr,
+                          guint        timeout)
+{
+    GMainContext *context;
+
+    /* The source follows the thread-default context, as the per-transaction
+     * timeouts did */
+    context = g_main_context_ref_thread_default ();
+    if (self->priv->transaction_timeout_source &&
+        g_source_get_context (self->priv->transaction_timeout_source) != context) {
+        g_source_destroy (self->priv->transaction_timeout_source);
+        g_clear_pointer (&self->priv->transaction_timeout_source, g_source_unref);
+    }
+    if (!self->priv->transaction_timeout_source) {
+        self->priv->transaction_timeout_source = g_source_new (&transaction_timeout_source_funcs, sizeof (GSource));
+        g_source_set_callback (self->priv->transaction_timeout_source,
+                               (GSourceFunc)process_transaction_timeouts,
+                               self,
+                               NULL);
+        g_source_attach (self->priv->transaction_timeout_source, context);
+    }
+    g_main_context_unref (context);
+
+    tr->timeout_deadline = g_get_monotonic_time () + (gint64) timeout * G_USEC_PER_SEC;
+    g_ptr_array_add (self->priv->transaction_timeouts, tr);
+    transaction_timeouts_sift_up (self, self->priv->transaction_timeouts->len - 1);
 
-    return G_SOURCE_REMOVE;
+    if (tr->timeout_index == 0)
+        transaction_timeouts_rearm (self);
 }
 
 static void
@@ -446,12 +785,8 @@ device_store_transaction (QmiDevice *self,
     tr->wait_ctx->key = key; /* valid as long as the transaction is in the HT */
 
     /* Timeout is optional (e.g. disabled when MBIM is used) */
-    if (timeout > 0) {
-        tr->timeout_source = g_timeout_source_new_seconds (timeout);
-        g_source_set_callback (tr->timeout_source, (GSourceFunc)transaction_timed_out, tr->wait_ctx, NULL);
-        g_source_attach (tr->timeout_source, g_main_context_get_thread_default ());
-        g_source_unref (tr->timeout_source);
-    }
+    if (timeout > 0)
+        transaction_timeouts_add (self, tr, timeout);
 
     if (tr->cancellable) {
         /* Note: transaction_cancelled() will also be called directly if the
@@ -914,116 +1249,522 @@ qmi_device_set_expected_data_format (QmiDevice *self,
 }
 
 /*****************************************************************************/
-/* Register/Unregister clients that want to receive indications */
+/* Link management
+ *
+ * Multiplexed links are managed through the qmi_wwan driver, which creates a
+ * new 'qmimux' net interface for every QMAP mux ID written to the 'add_mux'
+ * sysfs file of the WWAN iface. The new interfaces are reported as upper
+ * devices of the WWAN iface, and expose their own mux ID in sysfs. */
 
-static gpointer
-build_registered_client_key (guint8 cid,
-                             QmiService service)
+#define UPPER_LINK_PREFIX "upper_"
+
+static gboolean
+write_sysfs_value (QmiDevice    *self,
+                   const gchar  *sysfs_path,
+                   const gchar  *value,
+                   GError      **error)
 {
-    return GUINT_TO_POINTER (((guint8)service << 8) | cid);
+    gboolean  status = FALSE;
+    gsize     len;
+    FILE     *f;
+
+    g_debug ("[%s] Writing '%s' to: %s",
+             qmi_file_get_path_display (self->priv->file),
+             value,
+             sysfs_path);
+
+    if (!(f = fopen (sysfs_path, "w"))) {
+        g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errno),
+                     "Failed to open file '%s' for writing: %s",
+                     sysfs_path, g_strerror (errno));
+        return FALSE;
+    }
+
+    /* sysfs reports errors once the buffered value is flushed */
+    len = strlen (value);
+    if (fwrite (value, 1, len, f) != len || fflush (f) != 0) {
+        g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errno),
+                     "Failed to write to file '%s': %s",
+                     sysfs_path, g_strerror (errno));
+        goto out;
+    }
+
+    status = TRUE;
+
+ out:
+    fclose (f);
+    return status;
 }
 
 static gboolean
-register_client (QmiDevice *self,
-                 QmiClient *client,
-                 GError **error)
+check_link_management_supported (QmiDevice  *self,
+                                 GError    **error)
 {
-    gpointer key;
+    /* Make sure we load the WWAN iface name */
+    reload_wwan_iface_name (self);
 
-    key = build_registered_client_key (qmi_client_get_cid (client),
-                                       qmi_client_get_service (client));
-    /* Only add the new client if not already registered one with the same CID
-     * for the same service */
-    if (g_hash_table_lookup (self->priv->registered_clients, key)) {
-        g_set_error (error,
-                     QMI_CORE_ERROR,
-                     QMI_CORE_ERROR_FAILED,
-                     "A client with CID '%u' and service '%s' is already registered",
-                     qmi_client_get_cid (client),
-                     qmi_service_get_string (qmi_client_get_service (client)));
+    /* Same as with the expected data format, only the qmi_wwan driver is
+     * supported, so no WWAN iface means no link management. */
+    if (!self->priv->wwan_iface) {
+        g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_UNSUPPORTED,
+                     "Link management is unsupported by the driver");
         return FALSE;
     }
-
-    g_hash_table_insert (self->priv->registered_clients,
-                         key,
-                         g_object_ref (client));
     return TRUE;
 }
 
-static void
-unregister_client (QmiDevice *self,
-                   QmiClient *client)
+static GPtrArray *
+list_links (QmiDevice  *self,
+            GError    **error)
 {
-    g_hash_table_remove (self->priv->registered_clients,
-                         build_registered_client_key (qmi_client_get_cid (client),
-                                                      qmi_client_get_service (client)));
-}
+    g_autofree gchar *sysfs_path = NULL;
+    GPtrArray        *links;
+    GDir             *dir;
+    const gchar      *name;
+
+    sysfs_path = g_strdup_printf ("/sys/class/net/%s", self->priv->wwan_iface);
+    if (!(dir = g_dir_open (sysfs_path, 0, error))) {
+        g_prefix_error (error, "Couldn't list links: ");
+        return NULL;
+    }
 
-/*****************************************************************************/
-/* Allocate new client */
+    links = g_ptr_array_new_with_free_func (g_free);
+    while ((name = g_dir_read_name (dir)) != NULL) {
+        if (g_str_has_prefix (name, UPPER_LINK_PREFIX))
+            g_ptr_array_add (links, g_strdup (name + strlen (UPPER_LINK_PREFIX)));
+    }
+    g_dir_close (dir);
 
-typedef struct {
-    QmiService service;
-    GType client_type;
-    guint8 cid;
-} AllocateClientContext;
+    return links;
+}
 
-static void
-allocate_client_context_free (AllocateClientContext *ctx)
+static gboolean
+links_contain (GPtrArray   *links,
+               const gchar *ifname)
 {
-    g_slice_free (AllocateClientContext, ctx);
+    guint i;
+
+    for (i = 0; i < links->len; i++) {
+        if (g_strcmp0 ((const gchar *) g_ptr_array_index (links, i), ifname) == 0)
+            return TRUE;
+    }
+    return FALSE;
 }
 
-QmiClient *
-qmi_device_allocate_client_finish (QmiDevice *self,
-                                   GAsyncResult *res,
-                                   GError **error)
+static gboolean
+read_link_mux_id (const gchar  *ifname,
+                  guint        *mux_id,
+                  GError      **error)
 {
-    return g_task_propagate_pointer (G_TASK (res), error);
+    g_autofree gchar *sysfs_path = NULL;
+    g_autofree gchar *contents = NULL;
+    gchar            *end = NULL;
+    guint64           value;
+
+    sysfs_path = g_strdup_printf ("/sys/class/net/%s/qmap/mux_id", ifname);
+    if (!g_file_get_contents (sysfs_path, &contents, NULL, error)) {
+        g_prefix_error (error, "Couldn't read mux ID of link '%s': ", ifname);
+        return FALSE;
+    }
+
+    /* Reported in hexadecimal, e.g. "0x01" */
+    g_strstrip (contents);
+    value = g_ascii_strtoull (contents, &end, 0);
+    if (end == contents || *end != '\0' ||
+        value < QMI_DEVICE_MUX_ID_MIN || value > QMI_DEVICE_MUX_ID_MAX) {
+        g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_FAILED,
+                     "Invalid mux ID of link '%s': %s", ifname, contents);
+        return FALSE;
+    }
+
+    *mux_id = (guint) value;
+    return TRUE;
 }
 
-static void
-build_client_object (GTask *task)
+static guint
+find_free_mux_id (GPtrArray *links)
 {
-    QmiDevice *self;
-    AllocateClientContext *ctx;
-    gchar *version_string = NULL;
-    QmiClient *client;
-    GError *error = NULL;
-    const QmiMessageCtlGetVersionInfoOutputServiceListService *version_info;
+    gboolean used[QMI_DEVICE_MUX_ID_MAX + 1] = { FALSE };
+    guint    mux_id;
+    guint    i;
+
+    for (i = 0; i < links->len; i++) {
+        /* Links whose mux ID cannot be read are ignored, the kernel rejects
+         * the new link if the ID turns out to be in use */
+        if (read_link_mux_id ((const gchar *) g_ptr_array_index (links, i), &mux_id, NULL))
+            used[mux_id] = TRUE;
+    }
 
-    self = g_task_get_source_object (task);
-    ctx = g_task_get_task_data (task);
+    for (mux_id = QMI_DEVICE_MUX_ID_MIN; mux_id <= QMI_DEVICE_MUX_ID_MAX; mux_id++) {
+        if (!used[mux_id])
+            return mux_id;
+    }
+    return QMI_DEVICE_MUX_ID_UNBOUND;
+}
 
-    /* We now have a proper CID for the client, we should be able to create it
-     * right away */
-    client = g_object_new (ctx->client_type,
-                           QMI_CLIENT_DEVICE,  self,
-                           QMI_CLIENT_SERVICE, ctx->service,
-                           QMI_CLIENT_CID,     ctx->cid,
-                           NULL);
+gchar *
+qmi_device_add_link (QmiDevice  *self,
+                     guint       mux_id,
+                     guint      *out_mux_id,
+                     GError    **error)
+{
+    g_autoptr(GPtrArray)  links_before = NULL;
+    g_autoptr(GPtrArray)  links_after = NULL;
+    g_autofree gchar     *sysfs_path = NULL;
+    g_autofree gchar     *value = NULL;
+    guint                 i;
 
-    /* Add version info to the client if it was retrieved */
-    version_info = find_service_version_info (self, ctx->service);
-    if (version_info)
-        g_object_set (client,
-                      QMI_CLIENT_VERSION_MAJOR, version_info->major_version,
-                      QMI_CLIENT_VERSION_MINOR, version_info->minor_version,
-                      NULL);
-#if QMI_QRTR_SUPPORTED
-    else if (self->priv->node) {
-        /* QRTR does not have any way of fetching version information. Assume
-         * all services can handle all message types and TLVs. */
-        g_debug ("[%s] Client version cannot be retrieved when using QRTR",
-                 qmi_file_get_path_display (self->priv->file));
-        g_object_set (client,
-                      QMI_CLIENT_VERSION_MAJOR, QMI_CLIENT_VERSION_UNKNOWN,
-                      QMI_CLIENT_VERSION_MINOR, QMI_CLIENT_VERSION_UNKNOWN,
-                      NULL);
-    }
-#endif
+    g_return_val_if_fail (QMI_IS_DEVICE (self), NULL);
+    g_return_val_if_fail (mux_id == QMI_DEVICE_MUX_ID_AUTOMATIC ||
+                          (mux_id >= QMI_DEVICE_MUX_ID_MIN && mux_id <= QMI_DEVICE_MUX_ID_MAX), NULL);
 
-    /* Register the client to get indications */
+    if (!check_link_management_supported (self, error))
+        return NULL;
+
+    if (!(links_before = list_links (self, error)))
+        return NULL;
+
+    if (mux_id == QMI_DEVICE_MUX_ID_AUTOMATIC) {
+        mux_id = find_free_mux_id (links_before);
+        if (mux_id == QMI_DEVICE_MUX_ID_UNBOUND) {
+            g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_FAILED,
+                         "No mux ID available for a new link");
+            return NULL;
+        }
+    }
+
+    sysfs_path = g_strdup_printf ("/sys/class/net/%s/qmi/add_mux", self->priv->wwan_iface);
+    value = g_strdup_printf ("%u", mux_id);
+    if (!write_sysfs_value (self, sysfs_path, value, error)) {
+        g_prefix_error (error, "Couldn't add link with mux ID %u: ", mux_id);
+        return NULL;
+    }
+
+    /* The driver registers the new net interface before the write returns,
+     * so it is the only upper link not listed before */
+    if (!(links_after = list_links (self, error)))
+        return NULL;
+
+    for (i = 0; i < links_after->len; i++) {
+        const gchar *ifname;
+
+        ifname = (const gchar *) g_ptr_array_index (links_after, i);
+        if (!links_contain (links_before, ifname)) {
+            g_debug ("[%s] link '%s' added with mux ID %u",
+                     qmi_file_get_path_display (self->priv->file), ifname, mux_id);
+            if (out_mux_id)
+                *out_mux_id = mux_id;
+            return g_strdup (ifname);
+        }
+    }
+
+    g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_FAILED,
+                 "Link with mux ID %u added but not found", mux_id);
+    return NULL;
+}
+
+static gboolean
+delete_link (QmiDevice    *self,
+             const gchar  *ifname,
+             GError      **error)
+{
+    g_autofree gchar *sysfs_path = NULL;
+    g_autofree gchar *value = NULL;
+    guint             mux_id;
+
+    if (!read_link_mux_id (ifname, &mux_id, error))
+        return FALSE;
+
+    sysfs_path = g_strdup_printf ("/sys/class/net/%s/qmi/del_mux", self->priv->wwan_iface);
+    value = g_strdup_printf ("%u", mux_id);
+    if (!write_sysfs_value (self, sysfs_path, value, error)) {
+        g_prefix_error (error, "Couldn't delete link '%s': ", ifname);
+        return FALSE;
+    }
+
+    g_debug ("[%s] link '%s' with mux ID %u deleted",
+             qmi_file_get_path_display (self->priv->file), ifname, mux_id);
+    return TRUE;
+}
+
+gboolean
+qmi_device_delete_link (QmiDevice    *self,
+                        const gchar  *ifname,
+                        GError      **error)
+{
+    g_autoptr(GPtrArray) links = NULL;
+
+    g_return_val_if_fail (QMI_IS_DEVICE (self), FALSE);
+    g_return_val_if_fail (ifname != NULL, FALSE);
+
+    if (!check_link_management_supported (self, error))
+        return FALSE;
+
+    if (!(links = list_links (self, error)))
+        return FALSE;
+
+    if (!links_contain (links, ifname)) {
+        g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_INVALID_ARGS,
+                     "Link '%s' not found in '%s'", ifname, self->priv->wwan_iface);
+        return FALSE;
+    }
+
+    return delete_link (self, ifname, error);
+}
+
+gboolean
+qmi_device_delete_all_links (QmiDevice  *self,
+                             GError    **error)
+{
+    g_autoptr(GPtrArray) links = NULL;
+    guint                i;
+
+    g_return_val_if_fail (QMI_IS_DEVICE (self), FALSE);
+
+    if (!check_link_management_supported (self, error))
+        return FALSE;
+
+    if (!(links = list_links (self, error)))
+        return FALSE;
+
+    for (i = 0; i < links->len; i++) {
+        if (!delete_link (self, (const gchar *) g_ptr_array_index (links, i), error))
+            return FALSE;
+    }
+    return TRUE;
+}
+
+gboolean
+qmi_device_list_links (QmiDevice  *self,
+                       GPtrArray **out_links,
+                       GError    **error)
+{
+    GPtrArray *links;
+
+    g_return_val_if_fail (QMI_IS_DEVICE (self), FALSE);
+    g_return_val_if_fail (out_links != NULL, FALSE);
+
+    if (!check_link_management_supported (self, error))
+        return FALSE;
+
+    if (!(links = list_links (self, error)))
+        return FALSE;
+
+    *out_links = links;
+    return TRUE;
+}
+
+gboolean
+qmi_device_get_link_mux_id (QmiDevice    *self,
+                            const gchar  *ifname,
+                            guint        *out_mux_id,
+                            GError      **error)
+{
+    g_return_val_if_fail (QMI_IS_DEVICE (self), FALSE);
+    g_return_val_if_fail (ifname != NULL, FALSE);
+    g_return_val_if_fail (out_mux_id != NULL, FALSE);
+
+    return read_link_mux_id (ifname, out_mux_id, error);
+}
+
+gboolean
+qmi_device_set_link_aggregation_max_size (QmiDevice  *self,
+                                          guint32     max_size,
+                                          GError    **error)
+{
+    g_autofree gchar *sysfs_path = NULL;
+    g_autofree gchar *value = NULL;
+
+    g_return_val_if_fail (QMI_IS_DEVICE (self), FALSE);
+    g_return_val_if_fail (max_size > 0, FALSE);
+
+    if (!check_link_management_supported (self, error))
+        return FALSE;
+
+    /* qmi_wwan sizes its RX buffers after the MTU of the WWAN iface, which
+     * must therefore fit the largest aggregated frame the modem may send */
+    sysfs_path = g_strdup_printf ("/sys/class/net/%s/mtu", self->priv->wwan_iface);
+    value = g_strdup_printf ("%u", max_size);
+    if (!write_sysfs_value (self, sysfs_path, value, error)) {
+        g_prefix_error (error, "Couldn't set aggregation max size: ");
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/*****************************************************************************/
+/* Register/Unregister clients that want to receive indications */
+
+static gpointer
+build_registered_client_key (guint8 cid,
+                             QmiService service)
+{
+    return GUINT_TO_POINTER (((guint8)service << 8) | cid);
+}
+
+static gboolean
+register_client (QmiDevice *self,
+                 QmiClient *client,
+                 GError **error)
+{
+    gpointer key;
+
+    key = build_registered_client_key (qmi_client_get_cid (client),
+                                       qmi_client_get_service (client));
+    /* Only add the new client if not already registered one with the same CID
+     * for the same service */
+    if (g_hash_table_lookup (self->priv->registered_clients, key)) {
+        g_set_error (error,
+                     QMI_CORE_ERROR,
+                     QMI_CORE_ERROR_FAILED,
+                     "A client with CID '%u' and service '%s' is already registered",
+                     qmi_client_get_cid (client),
+                     qmi_service_get_string (qmi_client_get_service (client)));
+        return FALSE;
+    }
+
+    g_hash_table_insert (self->priv->registered_clients,
+                         key,
+                         g_object_ref (client));
+    return TRUE;
+}
+
+static void
+unregister_client (QmiDevice *self,
+                   QmiClient *client)
+{
+    g_hash_table_remove (self->priv->registered_clients,
+                         build_registered_client_key (qmi_client_get_cid (client),
+                                                      qmi_client_get_service (client)));
+}
+
+/*****************************************************************************/
+/* Preallocated client IDs */
+
+typedef struct {
+    QmiService service;
+    guint8     cid;
+} PreallocatedCid;
+
+void
+qmi_device_set_preallocated_services (QmiDevice        *self,
+                                      const QmiService *services,
+                                      guint             n_services)
+{
+    g_return_if_fail (QMI_IS_DEVICE (self));
+    g_return_if_fail (services || !n_services);
+
+    g_clear_pointer (&self->priv->preallocate_services, g_array_unref);
+    if (!n_services)
+        return;
+
+    self->priv->preallocate_services = g_array_sized_new (FALSE, FALSE, sizeof (QmiService), n_services);
+    g_array_append_vals (self->priv->preallocate_services, services, n_services);
+}
+
+static void
+preallocated_cid_add (QmiDevice  *self,
+                      QmiService  service,
+                      guint8      cid)
+{
+    PreallocatedCid preallocated;
+
+    if (!self->priv->preallocated_cids)
+        self->priv->preallocated_cids = g_array_new (FALSE, FALSE, sizeof (PreallocatedCid));
+
+    preallocated.service = service;
+    preallocated.cid     = cid;
+    g_array_append_val (self->priv->preallocated_cids, preallocated);
+}
+
+static gboolean
+preallocated_cid_take (QmiDevice  *self,
+                       QmiService  service,
+                       guint8     *cid)
+{
+    guint i;
+
+    if (!self->priv->preallocated_cids)
+        return FALSE;
+
+    for (i = 0; i < self->priv->preallocated_cids->len; i++) {
+        PreallocatedCid *preallocated;
+
+        preallocated = &g_array_index (self->priv->preallocated_cids, PreallocatedCid, i);
+        if (preallocated->service == service) {
+            *cid = preallocated->cid;
+            g_array_remove_index (self->priv->preallocated_cids, i);
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+/*****************************************************************************/
+/* Allocate new client */
+
+typedef struct {
+    QmiService service;
+    GType client_type;
+    guint8 cid;
+} AllocateClientContext;
+
+static void
+allocate_client_context_free (AllocateClientContext *ctx)
+{
+    g_slice_free (AllocateClientContext, ctx);
+}
+
+QmiClient *
+qmi_device_allocate_client_finish (QmiDevice *self,
+                                   GAsyncResult *res,
+                                   GError **error)
+{
+    return g_task_propagate_pointer (G_TASK (res), error);
+}
+
+static void
+build_client_object (GTask *task)
+{
+    QmiDevice *self;
+    AllocateClientContext *ctx;
+    gchar *version_string = NULL;
+    QmiClient *client;
+    GError *error = NULL;
+    const QmiMessageCtlGetVersionInfoOutputServiceListService *version_info;
+
+    self = g_task_get_source_object (task);
+    ctx = g_task_get_task_data (task);
+
+    /* We now have a proper CID for the client, we should be able to create it
+     * right away */
+    client = g_object_new (ctx->client_type,
+                           QMI_CLIENT_DEVICE,  self,
+                           QMI_CLIENT_SERVICE, ctx->service,
+                           QMI_CLIENT_CID,     ctx->cid,
+                           NULL);
+
+    /* Add version info to the client if it was retrieved */
+    version_info = find_service_version_info (self, ctx->service);
+    if (version_info)
+        g_object_set (client,
+                      QMI_CLIENT_VERSION_MAJOR, version_info->major_version,
+                      QMI_CLIENT_VERSION_MINOR, version_info->minor_version,
+                      NULL);
+#if QMI_QRTR_SUPPORTED
+    else if (self->priv->node) {
+        /* QRTR does not have any way of fetching version information. Assume
+         * all services can handle all message types and TLVs. */
+        g_debug ("[%s] Client version cannot be retrieved when using QRTR",
+                 qmi_file_get_path_display (self->priv->file));
+        g_object_set (client,
+                      QMI_CLIENT_VERSION_MAJOR, QMI_CLIENT_VERSION_UNKNOWN,
+                      QMI_CLIENT_VERSION_MINOR, QMI_CLIENT_VERSION_UNKNOWN,
+                      NULL);
+    }
+#endif
+
+    /* Register the client to get indications */
     if (!register_client (self, client, &error)) {
         g_prefix_error (&error,
                         "Cannot register new client with CID '%u' and service '%s'",
@@ -1283,6 +2024,15 @@ qmi_device_allocate_client (QmiDevice *self,
         return;
     }
 
+    /* Use a client ID preallocated when the device was open, if any */
+    if (cid == QMI_CID_NONE && preallocated_cid_take (self, service, &ctx->cid)) {
+        g_debug ("[%s] Using preallocated client CID '%u'...",
+                 qmi_file_get_path_display (self->priv->file),
+                 ctx->cid);
+        build_client_object (task);
+        return;
+    }
+
     /* Allocate a new CID for the client to be created */
     if (cid == QMI_CID_NONE) {
         QmiMessageCtlAllocateCidInput *input;
@@ -1537,54 +2287,664 @@ endpoint_new_data_cb (QmiEndpoint *endpoint,
     }
 }
 
-static void
-endpoint_hangup_cb (QmiEndpoint *endpoint,
-                    QmiDevice   *self)
+/*****************************************************************************/
+/* Version info cache
+ *
+ * The list of services reported by the device is kept in one small key file
+ * per device under the user runtime directory, so that processes opening the
+ * same device over and over don't need to query it every time. An entry is
+ * only valid while the stamp of the device node (node identity and change
+ * time) is unchanged: a modem reset or a firmware upgrade re-enumerates the
+ * device and recreates the node, which invalidates the entry without asking
+ * the modem for its firmware revision. The entry is also removed as soon as
+ * a hangup is detected. */
+
+#define VERSION_INFO_CACHE_GROUP "version-info"
+
+static gchar *
+version_info_cache_get_path (QmiDevice *self)
 {
-    g_debug ("[%s] QMI endpoint hangup: removed",
-             qmi_file_get_path_display (self->priv->file));
+    gchar *name;
+    gchar *path;
 
-    /* cancel all ongoing transactions as the endpoing hangup happened */
-    device_hangup_transactions (self);
+#if QMI_QRTR_SUPPORTED
+    /* Only devices backed by a file, e.g. not QRTR nodes */
+    if (self->priv->node)
+        return NULL;
+#endif
 
-    g_signal_emit (self, signals[SIGNAL_REMOVED], 0);
+    name = g_strdelimit (g_strdup (qmi_file_get_path (self->priv->file)), "/", '_');
+    path = g_build_filename (g_get_user_runtime_dir (), "libqmi", name, NULL);
+    g_free (name);
+    return path;
 }
 
-typedef struct {
-    QmiClient *client;
-    QmiMessage *message;
-} IdleIndicationContext;
-
-static gboolean
-process_indication_idle (IdleIndicationContext *ctx)
+static gchar *
+version_info_cache_build_stamp (QmiDevice *self)
 {
-    g_assert (ctx->client != NULL);
-    g_assert (ctx->message != NULL);
+    struct stat st;
 
-    __qmi_client_process_indication (ctx->client, ctx->message);
+    if (stat (qmi_file_get_path (self->priv->file), &st) < 0)
+        return NULL;
 
-    g_object_unref (ctx->client);
-    qmi_message_unref (ctx->message);
-    g_slice_free (IdleIndicationContext, ctx);
-    return FALSE;
+    return g_strdup_printf ("%" G_GUINT64_FORMAT ":%" G_GUINT64_FORMAT ":%" G_GUINT64_FORMAT ":%" G_GINT64_FORMAT ".%ld",
+                            (guint64) st.st_dev,
+                            (guint64) st.st_rdev,
+                            (guint64) st.st_ino,
+                            (gint64) st.st_ctim.tv_sec,
+                            (glong) st.st_ctim.tv_nsec);
 }
 
-static void
-report_indication (QmiClient *client,
+static gboolean
+version_info_cache_load (QmiDevice *self)
+{
+    GKeyFile *key_file = NULL;
+    GArray *service_list = NULL;
+    gchar *path;
+    gchar *stamp = NULL;
+    gchar *cached_stamp = NULL;
+    gchar **services = NULL;
+    guint i;
+
+    path = version_info_cache_get_path (self);
+    if (!path)
+        goto out;
+
+    key_file = g_key_file_new ();
+    if (!g_key_file_load_from_file (key_file, path, G_KEY_FILE_NONE, NULL))
+        goto out;
+
+    stamp = version_info_cache_build_stamp (self);
+    cached_stamp = g_key_file_get_string (key_file, VERSION_INFO_CACHE_GROUP, "stamp", NULL);
+    if (!stamp || g_strcmp0 (stamp, cached_stamp) != 0) {
+        g_debug ("[%s] Version info cache entry is stale",
+                 qmi_file_get_path_display (self->priv->file));
+        goto out;
+    }
+
+    services = g_key_file_get_string_list (key_file, VERSION_INFO_CACHE_GROUP, "services", NULL, NULL);
+    if (!services)
+        goto out;
+
+    service_list = g_array_new (FALSE, FALSE, sizeof (QmiMessageCtlGetVersionInfoOutputServiceListService));
+    for (i = 0; services[i]; i++) {
+        QmiMessageCtlGetVersionInfoOutputServiceListService info;
+        guint service;
+        guint major_version;
+        guint minor_version;
+
+        if (sscanf (services[i], "%u:%u:%u", &service, &major_version, &minor_version) != 3 ||
+            service > G_MAXUINT8 ||
+            major_version > G_MAXUINT16 ||
+            minor_version > G_MAXUINT16) {
+            g_debug ("[%s] Invalid version info cache entry",
+                     qmi_file_get_path_display (self->priv->file));
+            g_clear_pointer (&service_list, g_array_unref);
+            goto out;
+        }
+
+        info.service = (QmiService) service;
+        info.major_version = (guint16) major_version;
+        info.minor_version = (guint16) minor_version;
+        g_array_append_val (service_list, info);
+    }
+
+    g_clear_pointer (&self->priv->supported_services, g_array_unref);
+    self->priv->supported_services = service_list;
+
+out:
+    g_strfreev (services);
+    g_free (cached_stamp);
+    g_free (stamp);
+    if (key_file)
+        g_key_file_free (key_file);
+    g_free (path);
+    return !!service_list;
+}
+
+static void
+version_info_cache_store (QmiDevice *self)
+{
+    GKeyFile *key_file;
+    GPtrArray *services;
+    gchar *path;
+    gchar *dir;
+    gchar *stamp;
+    gchar *contents;
+    gsize contents_len;
+    GError *error = NULL;
+    guint i;
+
+    path = version_info_cache_get_path (self);
+    if (!path)
+        return;
+
+    stamp = version_info_cache_build_stamp (self);
+    if (!stamp) {
+        g_free (path);
+        return;
+    }
+
+    services = g_ptr_array_new_with_free_func (g_free);
+    for (i = 0; i < self->priv->supported_services->len; i++) {
+        const QmiMessageCtlGetVersionInfoOutputServiceListService *info;
+
+        info = &g_array_index (self->priv->supported_services,
+                               QmiMessageCtlGetVersionInfoOutputServiceListService,
+                               i);
+        g_ptr_array_add (services, g_strdup_printf ("%u:%u:%u",
+                                                    (guint) info->service,
+                                                    (guint) info->major_version,
+                                                    (guint) info->minor_version));
+    }
+
+    key_file = g_key_file_new ();
+    g_key_file_set_string (key_file, VERSION_INFO_CACHE_GROUP, "stamp", stamp);
+    g_key_file_set_string_list (key_file, VERSION_INFO_CACHE_GROUP, "services",
+                                (const gchar * const *) services->pdata, services->len);
+    contents = g_key_file_to_data (key_file, &contents_len, NULL);
+
+    /* Written atomically, other processes may be reading it right now */
+    dir = g_path_get_dirname (path);
+    if (g_mkdir_with_parents (dir, 0700) < 0 ||
+        !g_file_set_contents (path, contents, contents_len, &error)) {
+        g_debug ("[%s] Couldn't store version info cache entry: %s",
+                 qmi_file_get_path_display (self->priv->file),
+                 error ? error->message : g_strerror (errno));
+        g_clear_error (&error);
+    }
+
+    g_free (dir);
+    g_free (contents);
+    g_key_file_free (key_file);
+    g_ptr_array_unref (services);
+    g_free (stamp);
+    g_free (path);
+}
+
+static void
+version_info_cache_invalidate (QmiDevice *self)
+{
+    gchar *path;
+
+    path = version_info_cache_get_path (self);
+    if (path && g_unlink (path) == 0)
+        g_debug ("[%s] Version info cache entry removed",
+                 qmi_file_get_path_display (self->priv->file));
+    g_free (path);
+}
+
+/*****************************************************************************/
+
+static void
+endpoint_hangup_cb (QmiEndpoint *endpoint,
+                    QmiDevice   *self)
+{
+    g_debug ("[%s] QMI endpoint hangup: removed",
+             qmi_file_get_path_display (self->priv->file));
+
+    /* cancel all ongoing transactions as the endpoing hangup happened */
+    device_hangup_transactions (self);
+
+    /* the device may come back with a different firmware */
+    version_info_cache_invalidate (self);
+
+    g_signal_emit (self, signals[SIGNAL_REMOVED], 0);
+}
+
+typedef struct {
+    QmiClient *client;
+    QmiMessage *message;
+} PendingIndication;
+
+static void
+pending_indication_free (PendingIndication *pending)
+{
+    g_object_unref (pending->client);
+    qmi_message_unref (pending->message);
+    g_slice_free (PendingIndication, pending);
+}
+
+static gboolean
+process_pending_indications (QmiDevice *self)
+{
+    guint n;
+
+    /* A client may drop the last reference to the device while processing */
+    g_object_ref (self);
+
+    for (n = 0;
+         n < QMI_DEVICE_INDICATION_BUDGET &&
+             self->priv->pending_indications &&
+             !g_queue_is_empty (self->priv->pending_indications);
+         n++) {
+        PendingIndication *pending;
+
+        pending = g_queue_pop_head (self->priv->pending_indications);
+        __qmi_client_process_indication (pending->client, pending->message);
+        pending_indication_free (pending);
+    }
+
+    /* Sleep until new indications are queued */
+    if (self->priv->indication_source &&
+        g_queue_is_empty (self->priv->pending_indications))
+        g_source_set_ready_time (self->priv->indication_source, -1);
+
+    g_object_unref (self);
+    return G_SOURCE_CONTINUE;
+}
+
+static gboolean
+indication_source_dispatch (GSource     *source,
+                            GSourceFunc  callback,
+                            gpointer     user_data)
+{
+    return callback (user_data);
+}
+
+static GSourceFuncs indication_source_funcs = {
+    NULL, /* prepare */
+    NULL, /* check */
+    indication_source_dispatch,
+    NULL, /* finalize */
+};
+
+static void
+report_indication (QmiDevice  *self,
+                   QmiClient  *client,
                    QmiMessage *message)
 {
-    IdleIndicationContext *ctx;
-    GSource *source;
+    PendingIndication *pending;
+    GMainContext *context;
 
-    /* Setup an idle to Pass the indication down to the client */
-    ctx = g_slice_new (IdleIndicationContext);
-    ctx->client = g_object_ref (client);
-    ctx->message = qmi_message_ref (message);
+    if (!self->priv->pending_indications)
+        return;
+
+    /* Queue the indication, it will be passed down to the client from the
+     * main loop, together with any other one received meanwhile */
+    pending = g_slice_new (PendingIndication);
+    pending->client = g_object_ref (client);
+    pending->message = qmi_message_ref (message);
+    g_queue_push_tail (self->priv->pending_indications, pending);
+
+    /* A single source reports all the queued indications, in order; it
+     * follows the thread-default context, as the per-indication idles did */
+    context = g_main_context_ref_thread_default ();
+    if (self->priv->indication_source &&
+        g_source_get_context (self->priv->indication_source) != context) {
+        g_source_destroy (self->priv->indication_source);
+        g_clear_pointer (&self->priv->indication_source, g_source_unref);
+    }
+    if (!self->priv->indication_source) {
+        self->priv->indication_source = g_source_new (&indication_source_funcs, sizeof (GSource));
+        g_source_set_priority (self->priv->indication_source, G_PRIORITY_DEFAULT_IDLE);
+        g_source_set_callback (self->priv->indication_source,
+                               (GSourceFunc)process_pending_indications,
+                               self,
+                               NULL);
+        g_source_attach (self->priv->indication_source, context);
+    }
+    g_main_context_unref (context);
+
+    g_source_set_ready_time (self->priv->indication_source, 0);
+}
+
+/*****************************************************************************/
+/* Worker thread input
+ *
+ * When the endpoint does its I/O in a worker thread, the messages are framed
+ * there and queued, and then processed in the context of the device, so that
+ * transactions and clients are never touched from the worker. The queue is
+ * refcounted as the signal handlers in the worker may outlive the device. */
+
+typedef struct _WorkerInput {
+    volatile gint  ref_count;
+    GMutex         mutex;
+    GQueue         messages;
+    gboolean       hangup;
+    /* In the device context, NULL once the device no longer listens */
+    GSource       *source;
+} WorkerInput;
+
+static WorkerInput *
+worker_input_ref (WorkerInput *input)
+{
+    g_atomic_int_inc (&input->ref_count);
+    return input;
+}
+
+static void
+worker_input_unref (WorkerInput *input)
+{
+    QmiMessage *message;
+
+    if (!g_atomic_int_dec_and_test (&input->ref_count))
+        return;
+
+    g_assert (!input->source);
+    while ((message = g_queue_pop_head (&input->messages)) != NULL)
+        qmi_message_unref (message);
+    g_mutex_clear (&input->mutex);
+    g_slice_free (WorkerInput, input);
+}
+
+static void
+worker_input_wakeup_locked (WorkerInput *input)
+{
+    if (input->source)
+        g_source_set_ready_time (input->source, 0);
+}
+
+static void
+worker_input_push (QmiMessage  *message,
+                   WorkerInput *input)
+{
+    g_mutex_lock (&input->mutex);
+    g_queue_push_tail (&input->messages, qmi_message_ref (message));
+    g_mutex_unlock (&input->mutex);
+}
+
+static void
+endpoint_new_data_worker_cb (QmiEndpoint *endpoint,
+                             WorkerInput *input)
+{
+    GError *error = NULL;
+
+    if (!qmi_endpoint_parse_buffer (endpoint,
+                                    (QmiMessageHandler)worker_input_push,
+                                    input,
+                                    &error)) {
+        g_warning ("[%s] QMI parsing error: %s",
+                   qmi_endpoint_get_name (endpoint), error->message);
+        g_error_free (error);
+    }
+
+    g_mutex_lock (&input->mutex);
+    worker_input_wakeup_locked (input);
+    g_mutex_unlock (&input->mutex);
+}
+
+static void
+endpoint_hangup_worker_cb (QmiEndpoint *endpoint,
+                           WorkerInput *input)
+{
+    g_mutex_lock (&input->mutex);
+    input->hangup = TRUE;
+    worker_input_wakeup_locked (input);
+    g_mutex_unlock (&input->mutex);
+}
+
+static gboolean
+process_worker_input (QmiDevice *self)
+{
+    WorkerInput *input = self->priv->worker_input;
+    GQueue       messages;
+    gboolean     hangup;
+    QmiMessage  *message;
+
+    /* Take everything queued so far, and sleep until something else is */
+    g_mutex_lock (&input->mutex);
+    g_source_set_ready_time (input->source, -1);
+    messages = input->messages;
+    g_queue_init (&input->messages);
+    hangup = input->hangup;
+    input->hangup = FALSE;
+    g_mutex_unlock (&input->mutex);
+
+    /* A client may drop the last reference to the device while processing */
+    g_object_ref (self);
+
+    while ((message = g_queue_pop_head (&messages)) != NULL) {
+        process_message (message, self);
+        qmi_message_unref (message);
+    }
+    if (hangup && self->priv->endpoint)
+        endpoint_hangup_cb (self->priv->endpoint, self);
+
+    g_object_unref (self);
+    return G_SOURCE_CONTINUE;
+}
+
+static gboolean
+worker_input_source_dispatch (GSource     *source,
+                              GSourceFunc  callback,
+                              gpointer     user_data)
+{
+    return callback (user_data);
+}
+
+static GSourceFuncs worker_input_source_funcs = {
+    NULL, /* prepare */
+    NULL, /* check */
+    worker_input_source_dispatch,
+    NULL, /* finalize */
+};
+
+static void
+worker_input_start (QmiDevice *self)
+{
+    WorkerInput *input;
 
-    source = g_idle_source_new ();
-    g_source_set_callback (source, (GSourceFunc)process_indication_idle, ctx, NULL);
-    g_source_attach (source, g_main_context_get_thread_default ());
+    input = g_slice_new0 (WorkerInput);
+    input->ref_count = 1;
+    g_mutex_init (&input->mutex);
+    g_queue_init (&input->messages);
+
+    input->source = g_source_new (&worker_input_source_funcs, sizeof (GSource));
+    g_source_set_callback (input->source, (GSourceFunc)process_worker_input, self, NULL);
+    g_source_attach (input->source, g_main_context_get_thread_default ());
+
+    self->priv->worker_input = input;
+}
+
+static void
+worker_input_stop (QmiDevice *self)
+{
+    WorkerInput *input;
+    GSource     *source;
+
+    input = g_steal_pointer (&self->priv->worker_input);
+    if (!input)
+        return;
+
+    /* Messages received from now on are lost */
+    g_mutex_lock (&input->mutex);
+    source = g_steal_pointer (&input->source);
+    g_mutex_unlock (&input->mutex);
+
+    g_source_destroy (source);
     g_source_unref (source);
+    worker_input_unref (input);
+}
+
+/*****************************************************************************/
+/* Trace ring
+ *
+ * When enabled, the raw contents of the latest messages sent or received are
+ * copied into a fixed size ring, along with when they were seen. Storing a
+ * message is just a copy into a buffer reused from the previous round of the
+ * ring; the messages are only parsed and translated when the ring contents are
+ * requested, so the ring may be kept enabled permanently. */
+
+static void
+trace_ring_clear (QmiDevice *self)
+{
+    guint i;
+
+    for (i = 0; i < self->priv->trace_ring_size; i++) {
+        if (self->priv->trace_ring[i].raw)
+            g_byte_array_unref (self->priv->trace_ring[i].raw);
+    }
+    g_clear_pointer (&self->priv->trace_ring, g_free);
+    self->priv->trace_ring_size = 0;
+    self->priv->trace_ring_next = 0;
+    self->priv->trace_ring_n_entries = 0;
+}
+
+static void
+trace_ring_store (QmiDevice         *self,
+                  QmiMessage        *message,
+                  gboolean           sent_or_received,
+                  const gchar       *message_str,
+                  QmiMessageContext *message_context)
+{
+    TraceRingEntry *entry;
+
+    entry = &self->priv->trace_ring[self->priv->trace_ring_next];
+    entry->timestamp = g_get_real_time ();
+    entry->sent = sent_or_received;
+    entry->message_str = message_str;
+    entry->vendor_id = (message_context ?
+                        qmi_message_context_get_vendor_id (message_context) :
+                        QMI_MESSAGE_VENDOR_GENERIC);
+    if (!entry->raw)
+        entry->raw = g_byte_array_new ();
+    g_byte_array_set_size (entry->raw, 0);
+    g_byte_array_append (entry->raw,
+                         ((GByteArray *)message)->data,
+                         ((GByteArray *)message)->len);
+
+    self->priv->trace_ring_next = (self->priv->trace_ring_next + 1) % self->priv->trace_ring_size;
+    if (self->priv->trace_ring_n_entries < self->priv->trace_ring_size)
+        self->priv->trace_ring_n_entries++;
+}
+
+void
+qmi_device_set_trace_ring_size (QmiDevice *self,
+                                guint      n_messages)
+{
+    g_return_if_fail (QMI_IS_DEVICE (self));
+
+    trace_ring_clear (self);
+    if (n_messages) {
+        self->priv->trace_ring = g_new0 (TraceRingEntry, n_messages);
+        self->priv->trace_ring_size = n_messages;
+    }
+}
+
+void
+qmi_device_set_tx_queue_max_size (QmiDevice *self,
+                                   guint      n_messages)
+{
+    g_return_if_fail (QMI_IS_DEVICE (self));
+
+    self->priv->tx_queue_max_size = n_messages;
+}
+
+gchar *
+qmi_device_get_trace_ring_printable (QmiDevice *self)
+{
+    GString *printable;
+    guint    i;
+
+    g_return_val_if_fail (QMI_IS_DEVICE (self), NULL);
+
+    printable = g_string_new (NULL);
+
+    for (i = 0; i < self->priv->trace_ring_n_entries; i++) {
+        const TraceRingEntry *entry;
+        GDateTime            *datetime;
+        gchar                *datetime_str;
+        gchar                *message_printable = NULL;
+        GByteArray           *raw;
+        QmiMessage           *message;
+        GError               *error = NULL;
+
+        entry = &self->priv->trace_ring[(self->priv->trace_ring_next +
+                                         self->priv->trace_ring_size -
+                                         self->priv->trace_ring_n_entries +
+                                         i) % self->priv->trace_ring_size];
+
+        datetime = g_date_time_new_from_unix_local (entry->timestamp / G_USEC_PER_SEC);
+        datetime_str = g_date_time_format (datetime, "%d %b %Y, %H:%M:%S");
+        g_string_append_printf (printable, "[%s.%06u] %s %s %s\n",
+                                datetime_str,
+                                (guint)(entry->timestamp % G_USEC_PER_SEC),
+                                entry->sent ? "Sent" : "Received",
+                                entry->vendor_id != QMI_MESSAGE_VENDOR_GENERIC ? "vendor-specific" : "generic",
+                                entry->message_str);
+        g_free (datetime_str);
+        g_date_time_unref (datetime);
+
+        /* The parser consumes the buffer given */
+        raw = g_byte_array_sized_new (entry->raw->len);
+        g_byte_array_append (raw, entry->raw->data, entry->raw->len);
+        message = qmi_message_new_from_raw (raw, &error);
+        if (message) {
+            QmiMessageContext *message_context = NULL;
+
+            if (entry->vendor_id != QMI_MESSAGE_VENDOR_GENERIC) {
+                message_context = qmi_message_context_new ();
+                qmi_message_context_set_vendor_id (message_context, entry->vendor_id);
+            }
+            message_printable = qmi_message_get_printable_full (message, message_context, "  ");
+            if (message_context)
+                qmi_message_context_unref (message_context);
+            qmi_message_unref (message);
+        } else {
+            gchar *raw_printable;
+
+            raw_printable = __qmi_utils_str_hex (entry->raw->data, entry->raw->len, ':');
+            message_printable = g_strdup_printf ("  invalid message (%s): %s\n",
+                                                 error ? error->message : "incomplete",
+                                                 raw_printable);
+            g_free (raw_printable);
+            g_clear_error (&error);
+        }
+        g_byte_array_unref (raw);
+
+        g_string_append (printable, message_printable);
+        g_free (message_printable);
+    }
+
+    return g_string_free (printable, FALSE);
+}
+
+/*****************************************************************************/
+
+static gboolean
+trace_message_filtered (QmiMessage *message)
+{
+    guint8  kinds;
+    guint16 tlv_length = 0;
+    gsize   offset = 0;
+    gsize   init_offset;
+    guint16 status = 0;
+
+    kinds = __qmi_utils_get_traces_filter_kinds ((guint8) qmi_message_get_service (message),
+                                                 qmi_message_get_message_id (message));
+    if (kinds == __QMI_TRACE_KIND_ALL)
+        return TRUE;
+    if (!kinds)
+        return FALSE;
+
+    if (qmi_message_is_request (message))
+        return !!(kinds & __QMI_TRACE_KIND_REQUEST);
+    if (qmi_message_is_indication (message))
+        return !!(kinds & __QMI_TRACE_KIND_INDICATION);
+    if (kinds & __QMI_TRACE_KIND_RESPONSE)
+        return TRUE;
+    if (!(kinds & __QMI_TRACE_KIND_ERROR))
+        return FALSE;
+
+    /* Only look for the result TLV when errors are the only thing traced */
+    init_offset = qmi_message_tlv_read_init (message, 0x02, &tlv_length, NULL);
+    if (!init_offset)
+        return FALSE;
+    if (!qmi_message_tlv_read_guint16 (message, init_offset, &offset, QMI_ENDIAN_LITTLE, &status, NULL))
+        return FALSE;
+    return (status != 0);
+}
+
+static void
+trace_message_chunk (const gchar *chunk,
+                     gsize        chunk_length,
+                     gpointer     user_data)
+{
+    /* Chunks end at a line boundary, and g_debug() already adds one */
+    if (chunk_length > 0 && chunk[chunk_length - 1] == '\n')
+        chunk_length--;
+    g_debug ("%.*s", (gint) chunk_length, chunk);
 }
 
 static void
@@ -1599,6 +2959,16 @@ trace_message (QmiDevice         *self,
     const gchar *action_str;
     gchar       *vendor_str = NULL;
 
+    if (!self->priv->trace_ring && !qmi_utils_get_traces_enabled ())
+        return;
+
+    /* Filtered out messages are neither copied nor formatted */
+    if (!trace_message_filtered (message))
+        return;
+
+    if (self->priv->trace_ring)
+        trace_ring_store (self, message, sent_or_received, message_str, message_context);
+
     if (!qmi_utils_get_traces_enabled ())
         return;
 
@@ -1631,14 +3001,21 @@ trace_message (QmiDevice         *self,
             vendor_str = g_strdup_printf ("vendor-specific (0x%04x)", vendor_id);
     }
 
-    printable = qmi_message_get_printable_full (message, message_context, prefix_str);
-    g_debug ("[%s] %s %s %s (translated)...\n%s",
+    g_debug ("[%s] %s %s %s (translated)...",
              qmi_file_get_path_display (self->priv->file),
              action_str,
              vendor_str ? vendor_str : "generic",
-             message_str,
-             printable);
-    g_free (printable);
+             message_str);
+
+    /* Logged as printed, without building the whole printable string */
+    if (!self->priv->trace_buffer)
+        self->priv->trace_buffer = g_string_sized_new (1024);
+    qmi_message_print_full (message,
+                            message_context,
+                            prefix_str,
+                            self->priv->trace_buffer,
+                            trace_message_chunk,
+                            NULL);
 
     g_free (vendor_str);
 }
@@ -1647,7 +3024,13 @@ static void
 process_message (QmiMessage *message,
                  QmiDevice *self)
 {
+    STATISTICS_ADD (self->priv->statistics->bytes_in, ((GByteArray *)message)->len);
+
     if (qmi_message_is_indication (message)) {
+        gboolean reported = FALSE;
+
+        STATISTICS_INC (self->priv->statistics->indications_received);
+
         /* Indication traces translated without an explicit vendor */
         trace_message (self, message, FALSE, "indication", NULL);
 
@@ -1662,8 +3045,10 @@ process_message (QmiMessage *message,
             g_hash_table_iter_init (&iter, self->priv->registered_clients);
             while (g_hash_table_iter_next (&iter, &key, (gpointer *)&client)) {
                 /* For broadcast messages, report them just if the service matches */
-                if (qmi_message_get_service (message) == qmi_client_get_service (client))
-                    report_indication (client, message);
+                if (qmi_message_get_service (message) == qmi_client_get_service (client)) {
+                    report_indication (self, client, message);
+                    reported = TRUE;
+                }
             }
         } else {
             QmiClient *client;
@@ -1671,10 +3056,14 @@ process_message (QmiMessage *message,
             client = g_hash_table_lookup (self->priv->registered_clients,
                                           build_registered_client_key (qmi_message_get_client_id (message),
                                                                        qmi_message_get_service (message)));
-            if (client)
-                report_indication (client, message);
+            if (client) {
+                report_indication (self, client, message);
+                reported = TRUE;
+            }
         }
 
+        if (!reported)
+            STATISTICS_INC (self->priv->statistics->indications_dropped);
         return;
     }
 
@@ -1713,6 +3102,7 @@ process_message (QmiMessage *message,
 
         /* Matched transactions translated with the same context as the request */
         trace_message (self, message, FALSE, "response", tr->message_context);
+        statistics_response_received (self, tr);
         /* Report the reply message */
         transaction_complete_and_free (tr, message, NULL);
         return;
@@ -1737,6 +3127,7 @@ typedef enum {
     DEVICE_OPEN_CONTEXT_STEP_FLAGS_VERSION_INFO,
     DEVICE_OPEN_CONTEXT_STEP_FLAGS_SYNC,
     DEVICE_OPEN_CONTEXT_STEP_FLAGS_NETPORT,
+    DEVICE_OPEN_CONTEXT_STEP_PREALLOCATE_CIDS,
     DEVICE_OPEN_CONTEXT_STEP_FLAGS_EXPECT_INDICATIONS,
     DEVICE_OPEN_CONTEXT_STEP_LAST
 } DeviceOpenContextStep;
@@ -1747,11 +3138,17 @@ typedef struct {
     guint timeout;
     guint version_check_retries;
     guint sync_retries;
+    /* CTL requests of the current step(s) not yet completed, and the
+     * first error reported by any of them */
+    guint n_pending;
+    GError *error;
 } DeviceOpenContext;
 
 static void
 device_open_context_free (DeviceOpenContext *ctx)
 {
+    g_assert (ctx->n_pending == 0);
+    g_clear_error (&ctx->error);
     g_slice_free (DeviceOpenContext, ctx);
 }
 
@@ -1765,6 +3162,35 @@ qmi_device_open_finish (QmiDevice *self,
 
 static void device_open_step (GTask *task);
 
+/* Called when each CTL request of the open sequence finishes, taking
+ * ownership of @error; the sequence goes on once all the requests sent
+ * together have finished, or fails with the first error */
+static void
+device_open_request_done (GTask  *task,
+                          GError *error)
+{
+    DeviceOpenContext *ctx;
+
+    ctx = g_task_get_task_data (task);
+    g_assert (ctx->n_pending > 0);
+
+    if (error && !ctx->error)
+        ctx->error = error;
+    else if (error)
+        g_error_free (error);
+
+    if (--ctx->n_pending > 0)
+        return;
+
+    if (ctx->error) {
+        g_task_return_error (task, g_steal_pointer (&ctx->error));
+        g_object_unref (task);
+        return;
+    }
+
+    device_open_step (task);
+}
+
 static void
 setup_indications_ready (QmiEndpoint *endpoint,
                          GAsyncResult *res,
@@ -1791,22 +3217,19 @@ ctl_set_data_format_ready (QmiClientCtl *client,
                            GTask *task)
 {
     QmiDevice *self;
-    DeviceOpenContext *ctx;
     QmiMessageCtlSetDataFormatOutput *output = NULL;
     GError *error = NULL;
 
     output = qmi_client_ctl_set_data_format_finish (client, res, &error);
     /* Check result of the async operation */
     if (!output) {
-        g_task_return_error (task, error);
-        g_object_unref (task);
+        device_open_request_done (task, error);
         return;
     }
 
     /* Check result of the QMI operation */
     if (!qmi_message_ctl_set_data_format_output_get_result (output, &error)) {
-        g_task_return_error (task, error);
-        g_object_unref (task);
+        device_open_request_done (task, error);
         qmi_message_ctl_set_data_format_output_unref (output);
         return;
     }
@@ -1819,9 +3242,7 @@ ctl_set_data_format_ready (QmiClientCtl *client,
     qmi_message_ctl_set_data_format_output_unref (output);
 
     /* Go on */
-    ctx = g_task_get_task_data (task);
-    ctx->step++;
-    device_open_step (task);
+    device_open_request_done (task, NULL);
 }
 
 static void
@@ -1857,15 +3278,13 @@ sync_ready (QmiClientCtl *client_ctl,
 
             /* Otherwise, propagate the error */
         }
-        g_task_return_error (task, error);
-        g_object_unref (task);
+        device_open_request_done (task, error);
         return;
     }
 
     /* Check result of the QMI operation */
     if (!qmi_message_ctl_sync_output_get_result (output, &error)) {
-        g_task_return_error (task, error);
-        g_object_unref (task);
+        device_open_request_done (task, error);
         qmi_message_ctl_sync_output_unref (output);
         return;
     }
@@ -1876,8 +3295,7 @@ sync_ready (QmiClientCtl *client_ctl,
     qmi_message_ctl_sync_output_unref (output);
 
     /* Go on */
-    ctx->step++;
-    device_open_step (task);
+    device_open_request_done (task, NULL);
 }
 
 static void
@@ -1916,15 +3334,13 @@ open_version_info_ready (QmiClientCtl *client_ctl,
             /* Otherwise, propagate the error */
         }
 
-        g_task_return_error (task, error);
-        g_object_unref (task);
+        device_open_request_done (task, error);
         return;
     }
 
     /* Check result of the QMI operation */
     if (!qmi_message_ctl_get_version_info_output_get_result (output, &error)) {
-        g_task_return_error (task, error);
-        g_object_unref (task);
+        device_open_request_done (task, error);
         qmi_message_ctl_get_version_info_output_unref (output);
         return;
     }
@@ -1934,8 +3350,12 @@ open_version_info_ready (QmiClientCtl *client_ctl,
     qmi_message_ctl_get_version_info_output_get_service_list (output,
                                                               &service_list,
                                                               NULL);
+    g_clear_pointer (&self->priv->supported_services, g_array_unref);
     self->priv->supported_services = g_array_ref (service_list);
 
+    if (ctx->flags & QMI_DEVICE_OPEN_FLAGS_VERSION_INFO_CACHE)
+        version_info_cache_store (self);
+
     g_debug ("[%s] QMI Device supports %u services:",
              qmi_file_get_path_display (self->priv->file),
              self->priv->supported_services->len);
@@ -1964,8 +3384,7 @@ open_version_info_ready (QmiClientCtl *client_ctl,
     qmi_message_ctl_get_version_info_output_unref (output);
 
     /* Go on */
-    ctx->step++;
-    device_open_step (task);
+    device_open_request_done (task, NULL);
 }
 
 static void
@@ -2008,6 +3427,9 @@ device_create_endpoint (QmiDevice *self,
             self->priv->endpoint = QMI_ENDPOINT (qmi_endpoint_qmux_new (self->priv->file,
                                                                         self->priv->proxy_path,
                                                                         self->priv->client_ctl));
+            if (self->priv->endpoint)
+                qmi_endpoint_qmux_set_tx_queue_max_size (QMI_ENDPOINT_QMUX (self->priv->endpoint),
+                                                         self->priv->tx_queue_max_size);
         }
     }
 #if defined MBIM_QMUX_ENABLED
@@ -2019,6 +3441,33 @@ device_create_endpoint (QmiDevice *self,
     if (!self->priv->endpoint)
         return;
 
+    /* Only the QMUX endpoint reads by itself, MBIM and QRTR get their
+     * messages through their own libraries */
+    if ((ctx->flags & QMI_DEVICE_OPEN_FLAGS_WORKER_THREAD) && QMI_IS_ENDPOINT_QMUX (self->priv->endpoint)) {
+        QmiWorker *worker;
+
+        worker = __qmi_worker_pool_get ();
+        qmi_endpoint_set_worker (self->priv->endpoint, worker);
+        __qmi_worker_unref (worker);
+
+        worker_input_stop (self);
+        worker_input_start (self);
+        self->priv->endpoint_new_data_id = g_signal_connect_data (self->priv->endpoint,
+                                                                  QMI_ENDPOINT_SIGNAL_NEW_DATA,
+                                                                  G_CALLBACK (endpoint_new_data_worker_cb),
+                                                                  worker_input_ref (self->priv->worker_input),
+                                                                  (GClosureNotify)worker_input_unref,
+                                                                  0);
+        self->priv->endpoint_hangup_id = g_signal_connect_data (self->priv->endpoint,
+                                                                QMI_ENDPOINT_SIGNAL_HANGUP,
+                                                                G_CALLBACK (endpoint_hangup_worker_cb),
+                                                                worker_input_ref (self->priv->worker_input),
+                                                                (GClosureNotify)worker_input_unref,
+                                                                0);
+        g_debug ("[%s] created endpoint with I/O in worker thread", qmi_file_get_path_display (self->priv->file));
+        return;
+    }
+
     self->priv->endpoint_new_data_id = g_signal_connect (self->priv->endpoint,
                                                          QMI_ENDPOINT_SIGNAL_NEW_DATA,
                                                          G_CALLBACK (endpoint_new_data_cb),
@@ -2031,73 +3480,257 @@ device_create_endpoint (QmiDevice *self,
 }
 
 static gboolean
-device_setup_open_flags_by_transport (QmiDevice          *self,
-                                      DeviceOpenContext  *ctx,
-                                      GError            **error)
+device_setup_open_flags_by_transport (QmiDevice          *self,
+                                      DeviceOpenContext  *ctx,
+                                      GError            **error)
+{
+    __QmiTransportType  transport;
+    GError             *inner_error = NULL;
+
+    transport = __qmi_utils_get_transport_type (qmi_file_get_path (self->priv->file), &inner_error);
+    if ((transport == __QMI_TRANSPORT_TYPE_UNKNOWN) && !self->priv->no_file_check)
+        g_warning ("[%s] couldn't detect transport type of port: %s", qmi_file_get_path_display (self->priv->file), inner_error->message);
+    g_clear_error (&inner_error);
+
+#if defined MBIM_QMUX_ENABLED
+
+    /* Auto mode requested? */
+    if (ctx->flags & QMI_DEVICE_OPEN_FLAGS_AUTO) {
+        switch (transport) {
+        case __QMI_TRANSPORT_TYPE_MBIM:
+            g_debug ("[%s] automatically selecting MBIM mode", qmi_file_get_path_display (self->priv->file));
+            ctx->flags |= QMI_DEVICE_OPEN_FLAGS_MBIM;
+            break;
+        case __QMI_TRANSPORT_TYPE_QMUX:
+            g_debug ("[%s] automatically selecting QMI mode", qmi_file_get_path_display (self->priv->file));
+            ctx->flags &= ~QMI_DEVICE_OPEN_FLAGS_MBIM;
+            break;
+        case __QMI_TRANSPORT_TYPE_UNKNOWN:
+            g_set_error (&inner_error, QMI_CORE_ERROR, QMI_CORE_ERROR_FAILED,
+                         "Cannot automatically select QMI/MBIM mode");
+            break;
+        default:
+            g_assert_not_reached ();
+        }
+        goto out;
+    }
+
+    /* MBIM mode requested? */
+    if (ctx->flags & QMI_DEVICE_OPEN_FLAGS_MBIM) {
+        if ((transport != __QMI_TRANSPORT_TYPE_MBIM) && !self->priv->no_file_check)
+            g_warning ("[%s] requested MBIM mode but unexpected transport type found", qmi_file_get_path_display (self->priv->file));
+        goto out;
+    }
+
+#else
+
+    /* MBIM mode requested? */
+    if (ctx->flags & QMI_DEVICE_OPEN_FLAGS_MBIM) {
+        g_warning ("[%s] requested MBIM mode but no MBIM QMUX support available", qmi_file_get_path_display (self->priv->file));
+        goto out;
+    }
+
+    /* Treat AUTO as QMI mode, without warnings */
+
+#endif /* MBIM_QMUX_ENABLED */
+
+    /* QMI mode requested? */
+    if ((transport != __QMI_TRANSPORT_TYPE_QMUX) && !self->priv->no_file_check)
+        g_warning ("[%s] requested QMI mode but unexpected transport type found",
+                   qmi_file_get_path_display (self->priv->file));
+
+out:
+
+    if (inner_error) {
+        g_propagate_error (error, inner_error);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+static gboolean
+device_open_version_info (GTask *task)
+{
+    QmiDevice *self;
+    DeviceOpenContext *ctx;
+
+    self = g_task_get_source_object (task);
+    ctx = g_task_get_task_data (task);
+
+    if (!(ctx->flags & QMI_DEVICE_OPEN_FLAGS_VERSION_INFO))
+        return FALSE;
+
+    if ((ctx->flags & QMI_DEVICE_OPEN_FLAGS_VERSION_INFO_CACHE) &&
+        version_info_cache_load (self)) {
+        g_debug ("[%s] Version info loaded from cache: %u services",
+                 qmi_file_get_path_display (self->priv->file),
+                 self->priv->supported_services->len);
+        return FALSE;
+    }
+
+    /* Setup how many times to retry... We'll retry once per second */
+    ctx->version_check_retries = ctx->timeout > 0 ? ctx->timeout : 1;
+    g_debug ("[%s] Checking version info (%u retries)...",
+             qmi_file_get_path_display (self->priv->file),
+             ctx->version_check_retries);
+    ctx->n_pending++;
+    qmi_client_ctl_get_version_info (self->priv->client_ctl,
+                                     NULL,
+                                     1,
+                                     g_task_get_cancellable (task),
+                                     (GAsyncReadyCallback)open_version_info_ready,
+                                     task);
+    return TRUE;
+}
+
+static gboolean
+device_open_sync (GTask *task)
+{
+    QmiDevice *self;
+    DeviceOpenContext *ctx;
+
+    self = g_task_get_source_object (task);
+    ctx = g_task_get_task_data (task);
+
+    if (!(ctx->flags & QMI_DEVICE_OPEN_FLAGS_SYNC))
+        return FALSE;
+
+    /* Client IDs preallocated in a previous open don't survive the sync */
+    if (self->priv->preallocated_cids)
+        g_array_set_size (self->priv->preallocated_cids, 0);
+
+    /* Setup how many times to retry... We'll retry once per second */
+    ctx->sync_retries = ctx->timeout > SYNC_TIMEOUT_SECS ? (ctx->timeout / SYNC_TIMEOUT_SECS) : 1;
+    g_debug ("[%s] Running sync (%u retries)...",
+             qmi_file_get_path_display (self->priv->file),
+             ctx->sync_retries);
+    ctx->n_pending++;
+    qmi_client_ctl_sync (self->priv->client_ctl,
+                         NULL,
+                         SYNC_TIMEOUT_SECS,
+                         g_task_get_cancellable (task),
+                         (GAsyncReadyCallback)sync_ready,
+                         task);
+    return TRUE;
+}
+
+static gboolean
+device_open_netport (GTask *task)
 {
-    __QmiTransportType  transport;
-    GError             *inner_error = NULL;
+    QmiDevice *self;
+    DeviceOpenContext *ctx;
+    QmiMessageCtlSetDataFormatInput *input;
+    QmiCtlDataFormat qos = QMI_CTL_DATA_FORMAT_QOS_FLOW_HEADER_ABSENT;
+    QmiCtlDataLinkProtocol link_protocol = QMI_CTL_DATA_LINK_PROTOCOL_802_3;
 
-    transport = __qmi_utils_get_transport_type (qmi_file_get_path (self->priv->file), &inner_error);
-    if ((transport == __QMI_TRANSPORT_TYPE_UNKNOWN) && !self->priv->no_file_check)
-        g_warning ("[%s] couldn't detect transport type of port: %s", qmi_file_get_path_display (self->priv->file), inner_error->message);
-    g_clear_error (&inner_error);
+    self = g_task_get_source_object (task);
+    ctx = g_task_get_task_data (task);
 
-#if defined MBIM_QMUX_ENABLED
+    if (!(ctx->flags & NETPORT_FLAGS))
+        return FALSE;
 
-    /* Auto mode requested? */
-    if (ctx->flags & QMI_DEVICE_OPEN_FLAGS_AUTO) {
-        switch (transport) {
-        case __QMI_TRANSPORT_TYPE_MBIM:
-            g_debug ("[%s] automatically selecting MBIM mode", qmi_file_get_path_display (self->priv->file));
-            ctx->flags |= QMI_DEVICE_OPEN_FLAGS_MBIM;
-            break;
-        case __QMI_TRANSPORT_TYPE_QMUX:
-            g_debug ("[%s] automatically selecting QMI mode", qmi_file_get_path_display (self->priv->file));
-            ctx->flags &= ~QMI_DEVICE_OPEN_FLAGS_MBIM;
-            break;
-        case __QMI_TRANSPORT_TYPE_UNKNOWN:
-            g_set_error (&inner_error, QMI_CORE_ERROR, QMI_CORE_ERROR_FAILED,
-                         "Cannot automatically select QMI/MBIM mode");
-            break;
-        default:
-            g_assert_not_reached ();
-        }
-        goto out;
-    }
+    g_debug ("[%s] Setting network port data format...",
+             qmi_file_get_path_display (self->priv->file));
 
-    /* MBIM mode requested? */
-    if (ctx->flags & QMI_DEVICE_OPEN_FLAGS_MBIM) {
-        if ((transport != __QMI_TRANSPORT_TYPE_MBIM) && !self->priv->no_file_check)
-            g_warning ("[%s] requested MBIM mode but unexpected transport type found", qmi_file_get_path_display (self->priv->file));
-        goto out;
-    }
+    input = qmi_message_ctl_set_data_format_input_new ();
 
-#else
+    if (ctx->flags & QMI_DEVICE_OPEN_FLAGS_NET_QOS_HEADER)
+        qos = QMI_CTL_DATA_FORMAT_QOS_FLOW_HEADER_PRESENT;
+    qmi_message_ctl_set_data_format_input_set_format (input, qos, NULL);
 
-    /* MBIM mode requested? */
-    if (ctx->flags & QMI_DEVICE_OPEN_FLAGS_MBIM) {
-        g_warning ("[%s] requested MBIM mode but no MBIM QMUX support available", qmi_file_get_path_display (self->priv->file));
-        goto out;
+    if (ctx->flags & QMI_DEVICE_OPEN_FLAGS_NET_RAW_IP)
+        link_protocol = QMI_CTL_DATA_LINK_PROTOCOL_RAW_IP;
+    qmi_message_ctl_set_data_format_input_set_protocol (input, link_protocol, NULL);
+
+    ctx->n_pending++;
+    qmi_client_ctl_set_data_format (self->priv->client_ctl,
+                                    input,
+                                    5,
+                                    NULL,
+                                    (GAsyncReadyCallback)ctl_set_data_format_ready,
+                                    task);
+    qmi_message_ctl_set_data_format_input_unref (input);
+    return TRUE;
+}
+
+static void
+preallocate_cid_ready (QmiClientCtl *client_ctl,
+                       GAsyncResult *res,
+                       GTask *task)
+{
+    QmiDevice *self;
+    QmiMessageCtlAllocateCidOutput *output;
+    QmiService service;
+    guint8 cid;
+    GError *error = NULL;
+
+    self = g_task_get_source_object (task);
+
+    /* Preallocation failures aren't fatal, the client ID will be allocated
+     * when the client is created instead */
+    output = qmi_client_ctl_allocate_cid_finish (client_ctl, res, &error);
+    if (output &&
+        qmi_message_ctl_allocate_cid_output_get_result (output, &error) &&
+        qmi_message_ctl_allocate_cid_output_get_allocation_info (output, &service, &cid, &error)) {
+        g_debug ("[%s] Preallocated client CID '%u' for service '%s'",
+                 qmi_file_get_path_display (self->priv->file),
+                 cid,
+                 qmi_service_get_string (service));
+        preallocated_cid_add (self, service, cid);
+    } else {
+        g_debug ("[%s] Couldn't preallocate client CID: %s",
+                 qmi_file_get_path_display (self->priv->file),
+                 error->message);
+        g_error_free (error);
     }
 
-    /* Treat AUTO as QMI mode, without warnings */
+    if (output)
+        qmi_message_ctl_allocate_cid_output_unref (output);
 
-#endif /* MBIM_QMUX_ENABLED */
+    device_open_request_done (task, NULL);
+}
 
-    /* QMI mode requested? */
-    if ((transport != __QMI_TRANSPORT_TYPE_QMUX) && !self->priv->no_file_check)
-        g_warning ("[%s] requested QMI mode but unexpected transport type found",
-                   qmi_file_get_path_display (self->priv->file));
+static gboolean
+device_open_preallocate_cids (GTask *task)
+{
+    QmiDevice *self;
+    DeviceOpenContext *ctx;
+    guint i;
+    gboolean started = FALSE;
 
-out:
+    self = g_task_get_source_object (task);
+    ctx = g_task_get_task_data (task);
 
-    if (inner_error) {
-        g_propagate_error (error, inner_error);
+    if (!self->priv->preallocate_services)
         return FALSE;
+
+    for (i = 0; i < self->priv->preallocate_services->len; i++) {
+        QmiService service;
+        QmiMessageCtlAllocateCidInput *input;
+
+        service = g_array_index (self->priv->preallocate_services, QmiService, i);
+        if (service == QMI_SERVICE_CTL || !check_service_supported (self, service))
+            continue;
+
+        g_debug ("[%s] Preallocating client ID for service '%s'...",
+                 qmi_file_get_path_display (self->priv->file),
+                 qmi_service_get_string (service));
+
+        input = qmi_message_ctl_allocate_cid_input_new ();
+        qmi_message_ctl_allocate_cid_input_set_service (input, service, NULL);
+        ctx->n_pending++;
+        qmi_client_ctl_allocate_cid (self->priv->client_ctl,
+                                     input,
+                                     10,
+                                     g_task_get_cancellable (task),
+                                     (GAsyncReadyCallback)preallocate_cid_ready,
+                                     task);
+        qmi_message_ctl_allocate_cid_input_unref (input);
+        started = TRUE;
     }
 
-    return TRUE;
+    return started;
 }
 
 static void
@@ -2154,73 +3787,44 @@ device_open_step (GTask *task)
         return;
 
     case DEVICE_OPEN_CONTEXT_STEP_FLAGS_VERSION_INFO:
-        /* Query version info? */
-        if (ctx->flags & QMI_DEVICE_OPEN_FLAGS_VERSION_INFO) {
-            /* Setup how many times to retry... We'll retry once per second */
-            ctx->version_check_retries = ctx->timeout > 0 ? ctx->timeout : 1;
-            g_debug ("[%s] Checking version info (%u retries)...",
-                     qmi_file_get_path_display (self->priv->file),
-                     ctx->version_check_retries);
-            qmi_client_ctl_get_version_info (self->priv->client_ctl,
-                                             NULL,
-                                             1,
-                                             g_task_get_cancellable (task),
-                                             (GAsyncReadyCallback)open_version_info_ready,
-                                             task);
-            return;
-        }
+        /* Query version info? When requested, sync right away as well
+         * instead of waiting for the version info response */
         ctx->step++;
-        /* Fall through */
+        device_open_version_info (task);
+        if (ctx->flags & QMI_DEVICE_OPEN_FLAGS_CONCURRENT_CTL) {
+            ctx->step++;
+            device_open_sync (task);
+        }
+        if (ctx->n_pending > 0)
+            return;
+        device_open_step (task);
+        return;
 
     case DEVICE_OPEN_CONTEXT_STEP_FLAGS_SYNC:
         /* Sync? */
-        if (ctx->flags & QMI_DEVICE_OPEN_FLAGS_SYNC) {
-            /* Setup how many times to retry... We'll retry once per second */
-            ctx->sync_retries = ctx->timeout > SYNC_TIMEOUT_SECS ? (ctx->timeout / SYNC_TIMEOUT_SECS) : 1;
-            g_debug ("[%s] Running sync (%u retries)...",
-                     qmi_file_get_path_display (self->priv->file),
-                     ctx->sync_retries);
-            qmi_client_ctl_sync (self->priv->client_ctl,
-                                 NULL,
-                                 SYNC_TIMEOUT_SECS,
-                                 g_task_get_cancellable (task),
-                                 (GAsyncReadyCallback)sync_ready,
-                                 task);
-            return;
-        }
         ctx->step++;
+        if (device_open_sync (task))
+            return;
         /* Fall through */
 
     case DEVICE_OPEN_CONTEXT_STEP_FLAGS_NETPORT:
-        /* Network port setup */
-        if (ctx->flags & NETPORT_FLAGS) {
-            QmiMessageCtlSetDataFormatInput *input;
-            QmiCtlDataFormat qos = QMI_CTL_DATA_FORMAT_QOS_FLOW_HEADER_ABSENT;
-            QmiCtlDataLinkProtocol link_protocol = QMI_CTL_DATA_LINK_PROTOCOL_802_3;
-
-            g_debug ("[%s] Setting network port data format...",
-                     qmi_file_get_path_display (self->priv->file));
-
-            input = qmi_message_ctl_set_data_format_input_new ();
-
-            if (ctx->flags & QMI_DEVICE_OPEN_FLAGS_NET_QOS_HEADER)
-                qos = QMI_CTL_DATA_FORMAT_QOS_FLOW_HEADER_PRESENT;
-            qmi_message_ctl_set_data_format_input_set_format (input, qos, NULL);
-
-            if (ctx->flags & QMI_DEVICE_OPEN_FLAGS_NET_RAW_IP)
-                link_protocol = QMI_CTL_DATA_LINK_PROTOCOL_RAW_IP;
-            qmi_message_ctl_set_data_format_input_set_protocol (input, link_protocol, NULL);
-
-            qmi_client_ctl_set_data_format (self->priv->client_ctl,
-                                            input,
-                                            5,
-                                            NULL,
-                                            (GAsyncReadyCallback)ctl_set_data_format_ready,
-                                            task);
-            qmi_message_ctl_set_data_format_input_unref (input);
-            return;
+        /* Network port setup; the sync releases all client IDs, so the
+         * preallocation may only go along with the requests after it */
+        ctx->step++;
+        device_open_netport (task);
+        if (ctx->flags & QMI_DEVICE_OPEN_FLAGS_CONCURRENT_CTL) {
+            ctx->step++;
+            device_open_preallocate_cids (task);
         }
+        if (ctx->n_pending > 0)
+            return;
+        device_open_step (task);
+        return;
+
+    case DEVICE_OPEN_CONTEXT_STEP_PREALLOCATE_CIDS:
         ctx->step++;
+        if (device_open_preallocate_cids (task))
+            return;
         /* Fall through */
 
     case DEVICE_OPEN_CONTEXT_STEP_FLAGS_EXPECT_INDICATIONS:
@@ -2368,6 +3972,8 @@ qmi_device_close_async (QmiDevice           *self,
     self->priv->endpoint_hangup_id = 0;
     g_task_set_task_data (task, ctx, (GDestroyNotify) close_context_free);
 
+    worker_input_stop (self);
+
     qmi_endpoint_close (ctx->endpoint,
                         timeout,
                         cancellable,
@@ -2407,6 +4013,49 @@ transaction_early_error (QmiDevice   *self,
     g_error_free (error);
 }
 
+static void
+command_setup_transaction_id (QmiDevice  *self,
+                              QmiMessage *message)
+{
+    /* Use a proper transaction id for CTL messages if they don't have one */
+    if (qmi_message_get_service (message) == QMI_SERVICE_CTL &&
+        qmi_message_get_transaction_id (message) == 0) {
+        qmi_message_set_transaction_id (
+            message,
+            qmi_client_get_next_transaction_id (
+                QMI_CLIENT (
+                    self->priv->client_ctl)));
+    }
+}
+
+static gboolean
+command_check (QmiDevice   *self,
+               QmiMessage  *message,
+               GError     **error)
+{
+    /* Device must be open */
+    if (!qmi_device_is_open (self)) {
+        g_set_error (error,
+                     QMI_CORE_ERROR,
+                     QMI_CORE_ERROR_WRONG_STATE,
+                     "Device must be open to send commands");
+        return FALSE;
+    }
+
+    /* Non-CTL services should use a proper CID */
+    if (qmi_message_get_service (message) != QMI_SERVICE_CTL &&
+        qmi_message_get_client_id (message) == 0) {
+        g_set_error (error,
+                     QMI_CORE_ERROR,
+                     QMI_CORE_ERROR_FAILED,
+                     "Cannot send message in service '%s' without a CID",
+                     qmi_service_get_string (qmi_message_get_service (message)));
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
 void
 qmi_device_command_abortable (QmiDevice                                *self,
                               QmiMessage                               *message,
@@ -2431,34 +4080,11 @@ qmi_device_command_abortable (QmiDevice                                *self,
     g_return_if_fail ((!abort_build_request_fn && !abort_parse_response_fn) ||
                       (abort_build_request_fn  && abort_parse_response_fn));
 
-    /* Use a proper transaction id for CTL messages if they don't have one */
-    if (qmi_message_get_service (message) == QMI_SERVICE_CTL &&
-        qmi_message_get_transaction_id (message) == 0) {
-        qmi_message_set_transaction_id (
-            message,
-            qmi_client_get_next_transaction_id (
-                QMI_CLIENT (
-                    self->priv->client_ctl)));
-    }
+    command_setup_transaction_id (self, message);
 
     tr = transaction_new (self, message, message_context, cancellable, callback, user_data);
 
-    /* Device must be open */
-    if (!qmi_device_is_open (self)) {
-        error = g_error_new (QMI_CORE_ERROR,
-                             QMI_CORE_ERROR_WRONG_STATE,
-                             "Device must be open to send commands");
-        transaction_early_error (self, tr, FALSE, error);
-        return;
-    }
-
-    /* Non-CTL services should use a proper CID */
-    if (qmi_message_get_service (message) != QMI_SERVICE_CTL &&
-        qmi_message_get_client_id (message) == 0) {
-        error = g_error_new (QMI_CORE_ERROR,
-                             QMI_CORE_ERROR_FAILED,
-                             "Cannot send message in service '%s' without a CID",
-                             qmi_service_get_string (qmi_message_get_service (message)));
+    if (!command_check (self, message, &error)) {
         transaction_early_error (self, tr, FALSE, error);
         return;
     }
@@ -2496,6 +4122,8 @@ qmi_device_command_abortable (QmiDevice                                *self,
         transaction_early_error (self, tr, TRUE, error);
         return;
     }
+
+    statistics_request_sent (self, tr);
 }
 
 /*****************************************************************************/
@@ -2531,6 +4159,185 @@ qmi_device_command_full (QmiDevice           *self,
                                   user_data);
 }
 
+/*****************************************************************************/
+/* Batch of commands */
+
+typedef struct _CommandBatchContext CommandBatchContext;
+
+typedef struct {
+    CommandBatchContext *ctx;
+    guint                index;
+} CommandBatchItem;
+
+struct _CommandBatchContext {
+    GTask            *task;
+    CommandBatchItem *items;
+    GPtrArray        *responses;
+    GPtrArray        *errors;
+    guint             n_pending;
+};
+
+static void
+command_batch_response_free (QmiMessage *response)
+{
+    if (response)
+        qmi_message_unref (response);
+}
+
+static void
+command_batch_error_free (GError *error)
+{
+    if (error)
+        g_error_free (error);
+}
+
+static void
+command_batch_context_free (CommandBatchContext *ctx)
+{
+    g_free (ctx->items);
+    g_ptr_array_unref (ctx->responses);
+    g_ptr_array_unref (ctx->errors);
+    g_slice_free (CommandBatchContext, ctx);
+}
+
+gboolean
+qmi_device_command_batch_finish (QmiDevice     *self,
+                                 GAsyncResult  *res,
+                                 GPtrArray    **responses,
+                                 GPtrArray    **errors,
+                                 GError       **error)
+{
+    CommandBatchContext *ctx;
+
+    if (!g_task_propagate_boolean (G_TASK (res), error))
+        return FALSE;
+
+    ctx = g_task_get_task_data (G_TASK (res));
+    if (responses)
+        *responses = g_ptr_array_ref (ctx->responses);
+    if (errors)
+        *errors = g_ptr_array_ref (ctx->errors);
+    return TRUE;
+}
+
+static void
+command_batch_ready (QmiDevice        *self,
+                     GAsyncResult     *res,
+                     CommandBatchItem *item)
+{
+    CommandBatchContext *ctx = item->ctx;
+    GError              *error = NULL;
+
+    g_ptr_array_index (ctx->responses, item->index) = qmi_device_command_abortable_finish (self, res, &error);
+    g_ptr_array_index (ctx->errors, item->index) = error;
+
+    if (--ctx->n_pending == 0) {
+        GTask *task;
+
+        /* ctx goes away along with the task */
+        task = ctx->task;
+        g_task_return_boolean (task, TRUE);
+        g_object_unref (task);
+    }
+}
+
+void
+qmi_device_command_batch (QmiDevice            *self,
+                          QmiMessage          **messages,
+                          guint                 n_messages,
+                          QmiMessageContext    *message_context,
+                          guint                 timeout,
+                          GCancellable         *cancellable,
+                          GAsyncReadyCallback   callback,
+                          gpointer              user_data)
+{
+    CommandBatchContext     *ctx;
+    g_autofree Transaction **stored = NULL;
+    g_autofree QmiMessage  **to_send = NULL;
+    GError                  *error = NULL;
+    guint                    n_to_send = 0;
+    guint                    n_sent = 0;
+    guint                    i;
+
+    g_return_if_fail (QMI_IS_DEVICE (self));
+    g_return_if_fail (messages != NULL || n_messages == 0);
+    g_return_if_fail (timeout > 0);
+
+    ctx = g_slice_new0 (CommandBatchContext);
+    ctx->task = g_task_new (self, NULL, callback, user_data);
+    ctx->items = g_new (CommandBatchItem, n_messages);
+    ctx->responses = g_ptr_array_new_full (n_messages, (GDestroyNotify)command_batch_response_free);
+    g_ptr_array_set_size (ctx->responses, n_messages);
+    ctx->errors = g_ptr_array_new_full (n_messages, (GDestroyNotify)command_batch_error_free);
+    g_ptr_array_set_size (ctx->errors, n_messages);
+    ctx->n_pending = n_messages;
+    g_task_set_task_data (ctx->task, ctx, (GDestroyNotify)command_batch_context_free);
+
+    if (!n_messages) {
+        g_task_return_boolean (ctx->task, TRUE);
+        g_object_unref (ctx->task);
+        return;
+    }
+
+    /* Every transaction completes in idle, so the batch cannot finish
+     * before all of them are set up */
+    stored = g_new (Transaction *, n_messages);
+    to_send = g_new (QmiMessage *, n_messages);
+    for (i = 0; i < n_messages; i++) {
+        Transaction *tr;
+
+        ctx->items[i].ctx = ctx;
+        ctx->items[i].index = i;
+
+        command_setup_transaction_id (self, messages[i]);
+        tr = transaction_new (self,
+                              messages[i],
+                              message_context,
+                              cancellable,
+                              (GAsyncReadyCallback)command_batch_ready,
+                              &ctx->items[i]);
+
+        if (!command_check (self, messages[i], &error)) {
+            transaction_early_error (self, tr, FALSE, error);
+            error = NULL;
+            continue;
+        }
+
+        if (!device_store_transaction (self, tr, timeout, &error)) {
+            g_prefix_error (&error, "Cannot store transaction: ");
+            transaction_early_error (self, tr, FALSE, error);
+            error = NULL;
+            continue;
+        }
+
+        trace_message (self, messages[i], TRUE, "request", message_context);
+
+        stored[n_to_send] = tr;
+        to_send[n_to_send++] = messages[i];
+    }
+
+    if (n_to_send > 0)
+        n_sent = qmi_endpoint_send_batch (self->priv->endpoint,
+                                          to_send,
+                                          n_to_send,
+                                          timeout,
+                                          cancellable,
+                                          &error);
+
+    for (i = 0; i < n_sent; i++) {
+        if (device_peek_transaction (self, build_transaction_key (to_send[i])) == stored[i])
+            statistics_request_sent (self, stored[i]);
+    }
+
+    for (i = n_sent; i < n_to_send; i++) {
+        /* Skip transactions already overwritten by a later one with the same
+         * id in this same batch */
+        if (device_peek_transaction (self, build_transaction_key (to_send[i])) == stored[i])
+            transaction_early_error (self, stored[i], TRUE, g_error_copy (error));
+    }
+    g_clear_error (&error);
+}
+
 /*****************************************************************************/
 /* New QMI device */
 
@@ -2810,12 +4617,16 @@ qmi_device_init (QmiDevice *self)
 
     self->priv->transactions = g_hash_table_new (g_direct_hash,
                                                  g_direct_equal);
+    self->priv->transaction_timeouts = g_ptr_array_new ();
 
     self->priv->registered_clients = g_hash_table_new_full (g_direct_hash,
                                                             g_direct_equal,
                                                             NULL,
                                                             g_object_unref);
     self->priv->proxy_path = g_strdup (QMI_PROXY_SOCKET_PATH);
+    self->priv->pending_indications = g_queue_new ();
+    self->priv->tx_queue_max_size = QMI_ENDPOINT_QMUX_TX_QUEUE_MAX_SIZE_DEFAULT;
+    self->priv->statistics = g_new0 (DeviceStatistics, 1);
 }
 
 static gboolean
@@ -2836,6 +4647,23 @@ dispose (GObject *object)
 {
     QmiDevice *self = QMI_DEVICE (object);
 
+    if (self->priv->transaction_timeout_source) {
+        g_source_destroy (self->priv->transaction_timeout_source);
+        g_clear_pointer (&self->priv->transaction_timeout_source, g_source_unref);
+    }
+
+    /* Indications not yet reported are lost */
+    if (self->priv->indication_source) {
+        g_source_destroy (self->priv->indication_source);
+        g_clear_pointer (&self->priv->indication_source, g_source_unref);
+    }
+    if (self->priv->pending_indications) {
+        g_queue_free_full (self->priv->pending_indications, (GDestroyNotify)pending_indication_free);
+        self->priv->pending_indications = NULL;
+    }
+
+    worker_input_stop (self);
+
     /* unregister our CTL client */
     if (self->priv->client_ctl)
         unregister_client (self, QMI_CLIENT (self->priv->client_ctl));
@@ -2885,11 +4713,24 @@ finalize (GObject *object)
         g_assert (g_hash_table_size (self->priv->transactions) == 0);
         g_hash_table_unref (self->priv->transactions);
     }
+    if (self->priv->transaction_timeouts) {
+        g_assert (self->priv->transaction_timeouts->len == 0);
+        g_ptr_array_unref (self->priv->transaction_timeouts);
+    }
 
     g_hash_table_unref (self->priv->registered_clients);
 
     if (self->priv->supported_services)
         g_array_unref (self->priv->supported_services);
+    if (self->priv->preallocate_services)
+        g_array_unref (self->priv->preallocate_services);
+    if (self->priv->preallocated_cids)
+        g_array_unref (self->priv->preallocated_cids);
+
+    trace_ring_clear (self);
+    if (self->priv->trace_buffer)
+        g_string_free (self->priv->trace_buffer, TRUE);
+    statistics_free (self->priv->statistics);
 
     g_free (self->priv->proxy_path);
     g_free (self->priv->wwan_iface);
@@ -263,6 +263,9 @@ gboolean qmi_device_is_open (QmiDevice *self);
  * @QMI_DEVICE_OPEN_FLAGS_MBIM: open an MBIM port with QMUX tunneling service. Since: 1.16.
  * @QMI_DEVICE_OPEN_FLAGS_AUTO: open a port either in QMI or MBIM mode, depending on device driver. Since: 1.18.
  * @QMI_DEVICE_OPEN_FLAGS_EXPECT_INDICATIONS: Explicitly state that indications are wanted (implicit in QMI mode, optional when in MBIM mode).
+ * @QMI_DEVICE_OPEN_FLAGS_VERSION_INFO_CACHE: Used along with @QMI_DEVICE_OPEN_FLAGS_VERSION_INFO, load the version info from a per-user cache instead of querying the device, as long as the device node was not recreated since it was stored; the cache entry is removed when the device is hung up. Since: 1.28.
+ * @QMI_DEVICE_OPEN_FLAGS_WORKER_THREAD: Read from the port and split the received data into messages in a worker thread owned by the library, shared with other devices opened with this same flag, instead of in the thread-default main context of the caller. Responses and indications are still processed and reported in the context of the caller. Only applies to QMI ports, also when opened through the 'qmi-proxy'. Since: 1.28.
+ * @QMI_DEVICE_OPEN_FLAGS_CONCURRENT_CTL: Send the version info and sync requests at the same time instead of one after the other, and the network port setup request along with the client ID allocations requested with qmi_device_set_preallocated_services(). Since: 1.28.
  *
  * Flags to specify which actions to be performed when the device is open.
  *
@@ -280,6 +283,9 @@ typedef enum { /*< since=1.0 >*/
     QMI_DEVICE_OPEN_FLAGS_MBIM               = 1 << 7,
     QMI_DEVICE_OPEN_FLAGS_AUTO               = 1 << 8,
     QMI_DEVICE_OPEN_FLAGS_EXPECT_INDICATIONS = 1 << 9,
+    QMI_DEVICE_OPEN_FLAGS_VERSION_INFO_CACHE = 1 << 10,
+    QMI_DEVICE_OPEN_FLAGS_WORKER_THREAD      = 1 << 11,
+    QMI_DEVICE_OPEN_FLAGS_CONCURRENT_CTL     = 1 << 12,
 } QmiDeviceOpenFlags;
 
 /**
@@ -411,6 +417,28 @@ QmiClient *qmi_device_allocate_client_finish (QmiDevice     *self,
                                               GAsyncResult  *res,
                                               GError       **error);
 
+/**
+ * qmi_device_set_preallocated_services:
+ * @self: a #QmiDevice.
+ * @services: (array length=n_services): the services to preallocate client IDs for.
+ * @n_services: the number of items in @services.
+ *
+ * Sets the services for which client IDs will be allocated while the device is
+ * being open, all of them requested at the same time. If the device is open with
+ * #QMI_DEVICE_OPEN_FLAGS_CONCURRENT_CTL, the allocations also go in the same round
+ * trip as the network port setup. Services not supported by the device are
+ * ignored, and failing to preallocate a client ID is not fatal.
+ *
+ * qmi_device_allocate_client() called with #QMI_CID_NONE uses the preallocated
+ * client ID of the service, if any, instead of allocating a new one. Client IDs
+ * preallocated and never used are not released when the device is closed.
+ *
+ * Since: 1.28
+ */
+void qmi_device_set_preallocated_services (QmiDevice        *self,
+                                           const QmiService *services,
+                                           guint             n_services);
+
 /**
  * QmiDeviceReleaseClientFlags:
  * @QMI_DEVICE_RELEASE_CLIENT_FLAGS_NONE: No flags.
@@ -682,6 +710,139 @@ QmiMessage *qmi_device_command_abortable_finish (QmiDevice     *self,
                                                  GAsyncResult  *res,
                                                  GError       **error);
 
+/**
+ * qmi_device_command_batch:
+ * @self: a #QmiDevice.
+ * @messages: (array length=n_messages): the messages to send.
+ * @n_messages: the number of messages in @messages.
+ * @message_context: the context of the messages, or %NULL.
+ * @timeout: maximum time, in seconds, to wait for each response.
+ * @cancellable: a #GCancellable, or %NULL.
+ * @callback: a #GAsyncReadyCallback to call when the operation is finished.
+ * @user_data: the data to pass to callback function.
+ *
+ * Asynchronously sends all the @messages to the device, which may be for
+ * different services and clients, as with qmi_device_command_full(), except
+ * that they are all written together.
+ *
+ * The operation finishes once every message has its response or has failed,
+ * each one on its own, e.g. a cancelled @cancellable aborts every one of them
+ * still pending.
+ *
+ * When the operation is finished @callback will be called. You can then call
+ * qmi_device_command_batch_finish() to get the result of the operation.
+ *
+ * Since: 1.28
+ */
+void qmi_device_command_batch (QmiDevice            *self,
+                               QmiMessage          **messages,
+                               guint                 n_messages,
+                               QmiMessageContext    *message_context,
+                               guint                 timeout,
+                               GCancellable         *cancellable,
+                               GAsyncReadyCallback   callback,
+                               gpointer              user_data);
+
+/**
+ * qmi_device_command_batch_finish:
+ * @self: a #QmiDevice.
+ * @res: a #GAsyncResult.
+ * @responses: (out) (optional) (element-type QmiMessage) (transfer full): return location for the responses, or %NULL.
+ * @errors: (out) (optional) (element-type GError) (transfer full): return location for the errors, or %NULL.
+ * @error: Return location for error or %NULL.
+ *
+ * Finishes an operation started with qmi_device_command_batch().
+ *
+ * Both @responses and @errors have one entry per message sent, in the same
+ * order: for each message either the response is set and the error is %NULL,
+ * or the other way around. The arrays should be freed with g_ptr_array_unref().
+ *
+ * Returns: %TRUE if the batch was processed, %FALSE if @error is set.
+ *
+ * Since: 1.28
+ */
+gboolean qmi_device_command_batch_finish (QmiDevice     *self,
+                                          GAsyncResult  *res,
+                                          GPtrArray    **responses,
+                                          GPtrArray    **errors,
+                                          GError       **error);
+
+/**
+ * QMI_DEVICE_STATISTICS_N_LATENCY_BUCKETS:
+ *
+ * Number of buckets in the response latency histogram of a
+ * #QmiDeviceServiceStatistics.
+ *
+ * Since: 1.28
+ */
+#define QMI_DEVICE_STATISTICS_N_LATENCY_BUCKETS 16
+
+/**
+ * QmiDeviceStatistics:
+ * @timeouts: number of requests that timed out.
+ * @aborts: number of abort requests sent for requests timed out or cancelled.
+ * @indications_received: number of indications received.
+ * @indications_dropped: number of indications not reported to any #QmiClient, e.g. those for clients already released.
+ * @bytes_in: number of bytes received.
+ * @bytes_out: number of bytes of requests sent.
+ *
+ * Counters of a #QmiDevice, since it was created.
+ *
+ * Since: 1.28
+ */
+typedef struct {
+    guint64 timeouts;
+    guint64 aborts;
+    guint64 indications_received;
+    guint64 indications_dropped;
+    guint64 bytes_in;
+    guint64 bytes_out;
+} QmiDeviceStatistics;
+
+/**
+ * QmiDeviceServiceStatistics:
+ * @requests_sent: number of requests sent.
+ * @responses_received: number of responses received for the requests sent.
+ * @latency_histogram: number of responses received by latency: the first bucket counts the ones received within 1ms of sending the request, bucket N the ones received within 2^N ms, and the last one all the slower ones.
+ *
+ * Counters of a single service of a #QmiDevice, since it was created.
+ *
+ * Since: 1.28
+ */
+typedef struct {
+    guint64 requests_sent;
+    guint64 responses_received;
+    guint64 latency_histogram[QMI_DEVICE_STATISTICS_N_LATENCY_BUCKETS];
+} QmiDeviceServiceStatistics;
+
+/**
+ * qmi_device_get_statistics:
+ * @self: a #QmiDevice.
+ * @statistics: (out caller-allocates): return location for the counters.
+ *
+ * Gets a snapshot of the counters of @self. The counters are updated as
+ * messages are sent and received, and may be read from any thread.
+ *
+ * Since: 1.28
+ */
+void qmi_device_get_statistics (QmiDevice           *self,
+                                QmiDeviceStatistics *statistics);
+
+/**
+ * qmi_device_get_service_statistics:
+ * @self: a #QmiDevice.
+ * @service: a #QmiService.
+ * @statistics: (out caller-allocates): return location for the counters.
+ *
+ * Gets a snapshot of the counters of @service in @self, all zero if the
+ * service was never used.
+ *
+ * Since: 1.28
+ */
+void qmi_device_get_service_statistics (QmiDevice                  *self,
+                                        QmiService                  service,
+                                        QmiDeviceServiceStatistics *statistics);
+
 /**
  * QmiDeviceServiceVersionInfo:
  * @service: a #QmiService.
@@ -797,6 +958,227 @@ gboolean qmi_device_set_expected_data_format (QmiDevice                    *self
                                               QmiDeviceExpectedDataFormat   format,
                                               GError                      **error);
 
+/**
+ * QMI_DEVICE_MUX_ID_UNBOUND:
+ *
+ * Symbol defining a mux ID not bound to any link.
+ *
+ * Since: 1.28
+ */
+#define QMI_DEVICE_MUX_ID_UNBOUND 0
+
+/**
+ * QMI_DEVICE_MUX_ID_MIN:
+ *
+ * Symbol defining the minimum QMAP mux ID of a link.
+ *
+ * Since: 1.28
+ */
+#define QMI_DEVICE_MUX_ID_MIN 1
+
+/**
+ * QMI_DEVICE_MUX_ID_MAX:
+ *
+ * Symbol defining the maximum QMAP mux ID of a link.
+ *
+ * Since: 1.28
+ */
+#define QMI_DEVICE_MUX_ID_MAX 0xfe
+
+/**
+ * QMI_DEVICE_MUX_ID_AUTOMATIC:
+ *
+ * Symbol requesting qmi_device_add_link() to select the lowest mux ID not
+ * yet in use.
+ *
+ * Since: 1.28
+ */
+#define QMI_DEVICE_MUX_ID_AUTOMATIC G_MAXUINT
+
+/**
+ * qmi_device_add_link:
+ * @self: a #QmiDevice.
+ * @mux_id: the QMAP mux ID of the new link, between %QMI_DEVICE_MUX_ID_MIN and %QMI_DEVICE_MUX_ID_MAX, or %QMI_DEVICE_MUX_ID_AUTOMATIC.
+ * @out_mux_id: (out)(optional): return location for the mux ID of the new link, or %NULL.
+ * @error: Return location for error or %NULL.
+ *
+ * Creates a new net interface multiplexed over the WWAN interface of @self,
+ * carrying the QMAP frames with the given mux ID.
+ *
+ * Each PDN connection gets its own link by binding the WDS client that
+ * starts it to the mux ID of the link (see qmi_client_wds_bind_mux_data_port()),
+ * so several sessions share a single control port and WWAN interface.
+ *
+ * The WWAN interface must expect raw IP, and the modem must have been
+ * configured with QMAP as downlink data aggregation protocol.
+ *
+ * <note><para>
+ * This method is only applicable when using the qmi_wwan kernel driver.
+ * </para></note>
+ *
+ * Returns: (transfer full): the name of the new net interface, or %NULL if @error is set. The returned value should be freed with g_free().
+ *
+ * Since: 1.28
+ */
+gchar *qmi_device_add_link (QmiDevice  *self,
+                            guint       mux_id,
+                            guint      *out_mux_id,
+                            GError    **error);
+
+/**
+ * qmi_device_delete_link:
+ * @self: a #QmiDevice.
+ * @ifname: the name of a net interface created with qmi_device_add_link().
+ * @error: Return location for error or %NULL.
+ *
+ * Deletes a net interface multiplexed over the WWAN interface of @self.
+ *
+ * <note><para>
+ * This method is only applicable when using the qmi_wwan kernel driver.
+ * </para></note>
+ *
+ * Returns: %TRUE if successful, %FALSE if @error is set.
+ *
+ * Since: 1.28
+ */
+gboolean qmi_device_delete_link (QmiDevice    *self,
+                                 const gchar  *ifname,
+                                 GError      **error);
+
+/**
+ * qmi_device_delete_all_links:
+ * @self: a #QmiDevice.
+ * @error: Return location for error or %NULL.
+ *
+ * Deletes every net interface multiplexed over the WWAN interface of @self.
+ *
+ * <note><para>
+ * This method is only applicable when using the qmi_wwan kernel driver.
+ * </para></note>
+ *
+ * Returns: %TRUE if successful, %FALSE if @error is set.
+ *
+ * Since: 1.28
+ */
+gboolean qmi_device_delete_all_links (QmiDevice  *self,
+                                      GError    **error);
+
+/**
+ * qmi_device_list_links:
+ * @self: a #QmiDevice.
+ * @out_links: (out)(transfer full)(element-type utf8): return location for the names of the links.
+ * @error: Return location for error or %NULL.
+ *
+ * Lists the net interfaces multiplexed over the WWAN interface of @self.
+ *
+ * <note><para>
+ * This method is only applicable when using the qmi_wwan kernel driver.
+ * </para></note>
+ *
+ * Returns: %TRUE if successful (@out_links is set, and should be freed with g_ptr_array_unref()), %FALSE if @error is set.
+ *
+ * Since: 1.28
+ */
+gboolean qmi_device_list_links (QmiDevice  *self,
+                                GPtrArray **out_links,
+                                GError    **error);
+
+/**
+ * qmi_device_get_link_mux_id:
+ * @self: a #QmiDevice.
+ * @ifname: the name of a net interface created with qmi_device_add_link().
+ * @out_mux_id: (out): return location for the mux ID.
+ * @error: Return location for error or %NULL.
+ *
+ * Gets the QMAP mux ID of a net interface multiplexed over the WWAN interface
+ * of @self.
+ *
+ * <note><para>
+ * This method is only applicable when using the qmi_wwan kernel driver.
+ * </para></note>
+ *
+ * Returns: %TRUE if successful, %FALSE if @error is set.
+ *
+ * Since: 1.28
+ */
+gboolean qmi_device_get_link_mux_id (QmiDevice    *self,
+                                     const gchar  *ifname,
+                                     guint        *out_mux_id,
+                                     GError      **error);
+
+/**
+ * qmi_device_set_link_aggregation_max_size:
+ * @self: a #QmiDevice.
+ * @max_size: the downlink data aggregation max size agreed with the modem.
+ * @error: Return location for error or %NULL.
+ *
+ * Sizes the receive buffers of the WWAN interface of @self so that they fit
+ * the largest aggregated frame the modem may send, as agreed with
+ * qmi_client_wda_set_data_format().
+ *
+ * <note><para>
+ * This method is only applicable when using the qmi_wwan kernel driver, which
+ * sizes its receive buffers after the MTU of the WWAN interface.
+ * </para></note>
+ *
+ * Returns: %TRUE if successful, %FALSE if @error is set.
+ *
+ * Since: 1.28
+ */
+gboolean qmi_device_set_link_aggregation_max_size (QmiDevice  *self,
+                                                   guint32     max_size,
+                                                   GError    **error);
+
+/**
+ * qmi_device_set_trace_ring_size:
+ * @self: a #QmiDevice.
+ * @n_messages: the number of messages to keep, or 0 to disable the ring.
+ *
+ * Keeps the raw contents of the last @n_messages messages sent or received by
+ * @self, along with the time they were seen. This is independent of
+ * qmi_utils_set_traces_enabled(), and the cost per message is just a memory
+ * copy, as the messages are not translated until
+ * qmi_device_get_trace_ring_printable() is called.
+ *
+ * Any message already stored is discarded.
+ *
+ * Since: 1.28
+ */
+void qmi_device_set_trace_ring_size (QmiDevice *self,
+                                     guint      n_messages);
+
+/**
+ * qmi_device_get_trace_ring_printable:
+ * @self: a #QmiDevice.
+ *
+ * Gets a printable string with the translated contents of the messages stored
+ * in the trace ring set up with qmi_device_set_trace_ring_size(), oldest first.
+ *
+ * Returns: (transfer full): a newly allocated string, which should be freed with g_free().
+ *
+ * Since: 1.28
+ */
+gchar *qmi_device_get_trace_ring_printable (QmiDevice *self);
+
+/**
+ * qmi_device_set_tx_queue_max_size:
+ * @self: a #QmiDevice.
+ * @n_messages: the maximum number of queued requests, or 0 for no limit.
+ *
+ * Requests that cannot be written to a QMI port right away, e.g. because the
+ * kernel driver is not accepting more data during a modem recovery, are queued
+ * until the port is writable again instead of blocking. Once @n_messages
+ * requests are queued, new requests fail right away with a
+ * %QMI_CORE_ERROR_FAILED error. The default limit is 256.
+ *
+ * Takes effect the next time @self is opened. Does not apply to MBIM or QRTR
+ * based devices.
+ *
+ * Since: 1.28
+ */
+void qmi_device_set_tx_queue_max_size (QmiDevice *self,
+                                       guint      n_messages);
+
 
 /******************************************************************************/
 /* New QRTR based APIs */
@@ -30,6 +30,7 @@
 #include "qmi-errors.h"
 #include "qmi-error-types.h"
 #include "qmi-file.h"
+#include "qmi-message.h"
 
 G_DEFINE_TYPE (QmiEndpointMbim, qmi_endpoint_mbim, QMI_TYPE_ENDPOINT)
 
@@ -57,6 +58,36 @@ mbim_device_removed_cb (MbimDevice *device,
 
 /*****************************************************************************/
 
+/* The information buffer carries complete QMUX frames, so build the
+ * QmiMessages straight from it instead of appending the data to the byte
+ * stream buffer and parsing it all over again. */
+static void
+add_information_buffer (QmiEndpointMbim *self,
+                        const guint8    *buf,
+                        guint32          len)
+{
+    while (len > 0) {
+        g_autoptr(GError)  error = NULL;
+        QmiMessage        *message;
+        gsize              consumed;
+
+        message = __qmi_message_new_from_buffer (buf, len, &consumed, &error);
+        if (!message) {
+            if (!error) {
+                g_warning ("[%s] Truncated QMI message received via MBIM: %u bytes",
+                           qmi_endpoint_get_name (QMI_ENDPOINT (self)), len);
+                return;
+            }
+            g_warning ("[%s] Invalid QMI message received via MBIM: '%s'",
+                       qmi_endpoint_get_name (QMI_ENDPOINT (self)), error->message);
+        } else
+            qmi_endpoint_add_qmi_message (QMI_ENDPOINT (self), message);
+
+        buf += consumed;
+        len -= consumed;
+    }
+}
+
 static void
 mbim_device_command_ready (MbimDevice      *dev,
                            GAsyncResult    *res,
@@ -78,10 +109,8 @@ mbim_device_command_ready (MbimDevice      *dev,
         return;
     }
 
-    /* Store the raw information buffer in the internal reception buffer,
-     * as if we had read from a iochannel. */
     buf = mbim_message_command_done_get_raw_information_buffer (response, &len);
-    qmi_endpoint_add_message (QMI_ENDPOINT (self), buf, len);
+    add_information_buffer (self, buf, len);
     mbim_message_unref (response);
     g_object_unref (self);
 }
@@ -100,7 +129,7 @@ mbim_qmi_notification_cb (MbimDevice      *device,
         return;
 
     buf = mbim_message_indicate_status_get_raw_information_buffer (notification, &len);
-    qmi_endpoint_add_message (QMI_ENDPOINT (self), buf, len);
+    add_information_buffer (self, buf, len);
 }
 
 static void
@@ -28,14 +28,19 @@
 #include <gio/gunixinputstream.h>
 #include <gio/gunixoutputstream.h>
 #include <gio/gunixsocketaddress.h>
+#include <gio/gunixfdmessage.h>
+#include <glib-unix.h>
 #include <string.h>
+#include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 
 #include "qmi-endpoint-qmux.h"
 #include "qmi-ctl.h"
 #include "qmi-errors.h"
 #include "qmi-error-types.h"
+#include "qmi-shm-channel.h"
 
 G_DEFINE_TYPE (QmiEndpointQmux, qmi_endpoint_qmux, QMI_TYPE_ENDPOINT)
 
@@ -51,6 +56,21 @@ struct _QmiEndpointQmuxPrivate {
     GSocketClient *socket_client;
     GSocketConnection *socket_connection;
 
+    /* Shared memory transport to the proxy, if negotiated; the channel
+     * descriptors come along with the proxy open response */
+    gint shm_fds[QMI_SHM_CHANNEL_N_FDS];
+    guint n_shm_fds;
+    QmiShmChannel *shm;
+    GSource *shm_source;
+
+    /* Outgoing messages not yet fully written, oldest first, along with how
+     * much of the first one was already written; the queue is drained by
+     * tx_source once the port becomes writable */
+    GQueue tx_queue;
+    gsize tx_offset;
+    GSource *tx_source;
+    guint tx_queue_max_size;
+
     /* Control client */
     QmiClientCtl *client_ctl;
 };
@@ -58,10 +78,58 @@ struct _QmiEndpointQmuxPrivate {
 #define BUFFER_SIZE 2048
 #define MAX_SPAWN_RETRIES 10
 
+/* Most queued messages written with a single writev() */
+#define TX_BATCH_SIZE 32
+
 static void destroy_iostream (QmiEndpointQmux *self);
 
 /*****************************************************************************/
 
+static gssize
+socket_receive_with_fds (QmiEndpointQmux  *self,
+                         guint8           *buffer,
+                         gsize             size,
+                         GError          **error)
+{
+    GInputVector vector = { buffer, size };
+    GSocketControlMessage **messages = NULL;
+    gint n_messages = 0;
+    gint i;
+    gssize r;
+
+    r = g_socket_receive_message (g_socket_connection_get_socket (self->priv->socket_connection),
+                                  NULL,
+                                  &vector,
+                                  1,
+                                  &messages,
+                                  &n_messages,
+                                  NULL,
+                                  NULL,
+                                  error);
+
+    /* Keep any descriptors received, they're only expected once */
+    for (i = 0; i < n_messages; i++) {
+        if (G_IS_UNIX_FD_MESSAGE (messages[i])) {
+            gint *fds;
+            gint n_fds;
+            gint j;
+
+            fds = g_unix_fd_message_steal_fds (G_UNIX_FD_MESSAGE (messages[i]), &n_fds);
+            for (j = 0; j < n_fds; j++) {
+                if (self->priv->n_shm_fds < QMI_SHM_CHANNEL_N_FDS)
+                    self->priv->shm_fds[self->priv->n_shm_fds++] = fds[j];
+                else
+                    close (fds[j]);
+            }
+            g_free (fds);
+        }
+        g_object_unref (messages[i]);
+    }
+    g_free (messages);
+
+    return r;
+}
+
 static gboolean
 input_ready_cb (GInputStream *istream,
                 QmiEndpointQmux *self)
@@ -70,11 +138,15 @@ input_ready_cb (GInputStream *istream,
     GError *error = NULL;
     gssize r;
 
-    r = g_pollable_input_stream_read_nonblocking (G_POLLABLE_INPUT_STREAM (istream),
-                                                  buffer,
-                                                  BUFFER_SIZE,
-                                                  NULL,
-                                                  &error);
+    /* The proxy may pass descriptors until the transport is settled */
+    if (self->priv->socket_connection && !self->priv->shm)
+        r = socket_receive_with_fds (self, buffer, BUFFER_SIZE, &error);
+    else
+        r = g_pollable_input_stream_read_nonblocking (G_POLLABLE_INPUT_STREAM (istream),
+                                                      buffer,
+                                                      BUFFER_SIZE,
+                                                      NULL,
+                                                      &error);
     if (r < 0) {
         g_warning ("Error reading from istream: %s", error ? error->message : "unknown");
         if (error)
@@ -96,6 +168,326 @@ input_ready_cb (GInputStream *istream,
     return G_SOURCE_CONTINUE;
 }
 
+static gboolean
+shm_ready_cb (gint             fd,
+              GIOCondition     condition,
+              QmiEndpointQmux *self)
+{
+    if (fd >= 0)
+        __qmi_shm_channel_ack (fd);
+
+    /* Drain the ring, re-checking after asking for the next doorbell */
+    do {
+        const guint8 *data;
+        gsize len;
+        GError *error = NULL;
+
+        while (TRUE) {
+            if (!__qmi_shm_channel_peek (self->priv->shm, QMI_SHM_RING_PROXY_TO_CLIENT, &data, &len, &error)) {
+                g_warning ("Error reading from shared memory: %s", error->message);
+                g_error_free (error);
+                g_signal_emit_by_name (QMI_ENDPOINT (self), QMI_ENDPOINT_SIGNAL_HANGUP);
+                return G_SOURCE_REMOVE;
+            }
+            if (!len)
+                break;
+
+            /* Copied straight from the ring into the endpoint buffer */
+            qmi_endpoint_add_message (QMI_ENDPOINT (self), data, len);
+
+            /* The endpoint may have been closed while processing */
+            if (!self->priv->shm)
+                return G_SOURCE_REMOVE;
+            __qmi_shm_channel_consume (self->priv->shm, QMI_SHM_RING_PROXY_TO_CLIENT, len);
+        }
+    } while (!__qmi_shm_channel_sleep (self->priv->shm, QMI_SHM_RING_PROXY_TO_CLIENT));
+
+    return G_SOURCE_CONTINUE;
+}
+
+static gboolean
+setup_shm (QmiEndpointQmux  *self,
+           GError          **error)
+{
+    if (self->priv->n_shm_fds != QMI_SHM_CHANNEL_N_FDS) {
+        g_set_error (error,
+                     QMI_CORE_ERROR,
+                     QMI_CORE_ERROR_FAILED,
+                     "Shared memory transport requested without channel");
+        return FALSE;
+    }
+
+    self->priv->n_shm_fds = 0;
+    self->priv->shm = __qmi_shm_channel_new_from_fds (self->priv->shm_fds, error);
+    if (!self->priv->shm) {
+        g_prefix_error (error, "Cannot setup shared memory transport: ");
+        return FALSE;
+    }
+
+    self->priv->shm_source = g_unix_fd_source_new (__qmi_shm_channel_get_doorbell_fd (self->priv->shm, QMI_SHM_RING_PROXY_TO_CLIENT),
+                                                   G_IO_IN);
+    g_source_set_callback (self->priv->shm_source,
+                           (GSourceFunc)shm_ready_cb,
+                           self,
+                           NULL);
+    g_source_attach (self->priv->shm_source, qmi_endpoint_peek_io_context (QMI_ENDPOINT (self)));
+
+    /* Process anything written before the doorbell was requested */
+    shm_ready_cb (-1, 0, self);
+    return TRUE;
+}
+
+typedef struct {
+    QmiEndpointQmux  *self;
+    GError          **error;
+    gboolean          ret;
+} SetupShmContext;
+
+static gboolean
+setup_shm_cb (SetupShmContext *ctx)
+{
+    ctx->ret = setup_shm (ctx->self, ctx->error);
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean
+shm_send (QmiEndpointQmux  *self,
+          const guint8     *raw_message,
+          gsize             raw_message_len,
+          guint             timeout,
+          GError          **error)
+{
+    gint64 deadline;
+    GError *inner_error = NULL;
+
+    deadline = g_get_monotonic_time () + (gint64)MAX (timeout, 1) * G_USEC_PER_SEC;
+
+    while (!__qmi_shm_channel_write (self->priv->shm,
+                                     QMI_SHM_RING_CLIENT_TO_PROXY,
+                                     raw_message,
+                                     raw_message_len,
+                                     &inner_error)) {
+        GPollFD pollfd;
+        gint64 now;
+
+        if (!g_error_matches (inner_error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK)) {
+            g_propagate_prefixed_error (error, inner_error, "Cannot write message: ");
+            return FALSE;
+        }
+        g_clear_error (&inner_error);
+
+        /* Ring full, wait for the proxy to make room, as a blocking socket
+         * write would do */
+        now = g_get_monotonic_time ();
+        if (now >= deadline) {
+            g_set_error (error,
+                         QMI_CORE_ERROR,
+                         QMI_CORE_ERROR_TIMEOUT,
+                         "Cannot write message: shared memory ring full");
+            return FALSE;
+        }
+        pollfd.fd = __qmi_shm_channel_get_space_fd (self->priv->shm, QMI_SHM_RING_CLIENT_TO_PROXY);
+        pollfd.events = G_IO_IN;
+        pollfd.revents = 0;
+        if (g_poll (&pollfd, 1, (gint)((deadline - now + 999) / 1000)) > 0)
+            __qmi_shm_channel_ack (pollfd.fd);
+    }
+
+    return TRUE;
+}
+
+/*****************************************************************************/
+/* Outgoing queue, only used from the I/O context of the endpoint */
+
+static gint
+tx_get_fd (QmiEndpointQmux *self)
+{
+    if (self->priv->socket_connection)
+        return g_socket_get_fd (g_socket_connection_get_socket (self->priv->socket_connection));
+    return self->priv->fd;
+}
+
+static void
+tx_queue_clear (QmiEndpointQmux *self)
+{
+    if (self->priv->tx_source) {
+        g_source_destroy (self->priv->tx_source);
+        g_clear_pointer (&self->priv->tx_source, g_source_unref);
+    }
+    while (!g_queue_is_empty (&self->priv->tx_queue))
+        qmi_message_unref (g_queue_pop_head (&self->priv->tx_queue));
+    self->priv->tx_offset = 0;
+}
+
+/* Write as much of the queue as the port takes without blocking. Each queued
+ * message is its own iovec, so character devices without vectored write
+ * support (cdc-wdm, qcqmi) still get one write() per message. */
+static gboolean
+tx_queue_flush (QmiEndpointQmux  *self,
+                GError          **error)
+{
+    gint fd;
+
+    fd = tx_get_fd (self);
+    while (!g_queue_is_empty (&self->priv->tx_queue)) {
+        struct iovec  iov[TX_BATCH_SIZE];
+        GList        *l;
+        guint         n;
+        gssize        written;
+
+        for (l = self->priv->tx_queue.head, n = 0; l && n < TX_BATCH_SIZE; l = g_list_next (l), n++) {
+            gsize len;
+
+            iov[n].iov_base = (gpointer) qmi_message_get_raw ((QmiMessage *)l->data, &len, NULL);
+            iov[n].iov_len = len;
+        }
+        iov[0].iov_base = (guint8 *)iov[0].iov_base + self->priv->tx_offset;
+        iov[0].iov_len -= self->priv->tx_offset;
+
+        if (self->priv->socket_connection) {
+            struct msghdr msg = { 0 };
+
+            /* The proxy may go away, report that as an error, not SIGPIPE */
+            msg.msg_iov = iov;
+            msg.msg_iovlen = n;
+            written = sendmsg (fd, &msg, MSG_NOSIGNAL);
+        } else
+            written = writev (fd, iov, n);
+
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return TRUE;
+            g_set_error (error,
+                         G_IO_ERROR,
+                         g_io_error_from_errno (errno),
+                         "%s", g_strerror (errno));
+            return FALSE;
+        }
+
+        /* Drop what was fully written */
+        for (n = 0; written > 0; n++) {
+            if ((gsize)written < iov[n].iov_len) {
+                self->priv->tx_offset += written;
+                break;
+            }
+            written -= iov[n].iov_len;
+            qmi_message_unref (g_queue_pop_head (&self->priv->tx_queue));
+            self->priv->tx_offset = 0;
+        }
+    }
+
+    return TRUE;
+}
+
+static gboolean
+tx_ready_cb (gint             fd,
+             GIOCondition     condition,
+             QmiEndpointQmux *self)
+{
+    GError *error = NULL;
+
+    if (!tx_queue_flush (self, &error)) {
+        g_warning ("Cannot write to ostream: %s", error->message);
+        g_error_free (error);
+
+        /* The queued requests are lost, hang up the endpoint */
+        g_clear_pointer (&self->priv->tx_source, g_source_unref);
+        tx_queue_clear (self);
+        g_signal_emit_by_name (QMI_ENDPOINT (self), QMI_ENDPOINT_SIGNAL_HANGUP);
+        return G_SOURCE_REMOVE;
+    }
+
+    if (g_queue_is_empty (&self->priv->tx_queue)) {
+        g_clear_pointer (&self->priv->tx_source, g_source_unref);
+        return G_SOURCE_REMOVE;
+    }
+
+    return G_SOURCE_CONTINUE;
+}
+
+static gboolean
+tx_queue_append (QmiEndpointQmux  *self,
+                 QmiMessage       *message,
+                 GError          **error)
+{
+    if (!self->priv->ostream) {
+        g_set_error (error,
+                     QMI_CORE_ERROR,
+                     QMI_CORE_ERROR_WRONG_STATE,
+                     "Cannot write message: endpoint not open");
+        return FALSE;
+    }
+
+    if (self->priv->tx_queue_max_size &&
+        self->priv->tx_queue.length >= self->priv->tx_queue_max_size) {
+        g_set_error (error,
+                     QMI_CORE_ERROR,
+                     QMI_CORE_ERROR_FAILED,
+                     "Cannot write message: outgoing queue full (%u messages not yet written)",
+                     self->priv->tx_queue.length);
+        return FALSE;
+    }
+
+    g_queue_push_tail (&self->priv->tx_queue, qmi_message_ref (message));
+    return TRUE;
+}
+
+/* Queue the given messages and write as many as possible right away; returns
+ * how many were accepted, the error applies to the first one that was not */
+static guint
+tx_queue_push (QmiEndpointQmux  *self,
+               QmiMessage      **messages,
+               guint             n_messages,
+               GError          **error)
+{
+    GError *inner_error = NULL;
+    gboolean idle;
+    guint n_queued;
+    guint n_accepted;
+
+    /* Nothing is queued unless we are already waiting for the port to be
+     * writable, in which case the new messages just go after the others */
+    idle = !self->priv->tx_source;
+
+    for (n_queued = 0; n_queued < n_messages; n_queued++) {
+        if (!tx_queue_append (self, messages[n_queued], &inner_error))
+            break;
+    }
+    n_accepted = n_queued;
+
+    if (idle && n_queued > 0) {
+        GError *flush_error = NULL;
+
+        if (!tx_queue_flush (self, &flush_error)) {
+            /* Whatever was not written is lost (and it was all ours) */
+            n_accepted = n_queued - self->priv->tx_queue.length;
+            tx_queue_clear (self);
+            g_clear_error (&inner_error);
+            g_propagate_prefixed_error (&inner_error, flush_error, "Cannot write message: ");
+        } else if (!g_queue_is_empty (&self->priv->tx_queue)) {
+            self->priv->tx_source = g_unix_fd_source_new (tx_get_fd (self), G_IO_OUT);
+            g_source_set_callback (self->priv->tx_source,
+                                   (GSourceFunc)tx_ready_cb,
+                                   self,
+                                   NULL);
+            g_source_attach (self->priv->tx_source, qmi_endpoint_peek_io_context (QMI_ENDPOINT (self)));
+        }
+    }
+
+    if (inner_error)
+        g_propagate_error (error, inner_error);
+    return n_accepted;
+}
+
+void
+qmi_endpoint_qmux_set_tx_queue_max_size (QmiEndpointQmux *self,
+                                         guint            n_messages)
+{
+    self->priv->tx_queue_max_size = n_messages;
+}
+
 /*****************************************************************************/
 
 typedef struct {
@@ -123,6 +515,7 @@ internal_proxy_open_ready (QmiClientCtl *client_ctl,
                            GTask *task)
 {
     QmiMessageCtlInternalProxyOpenOutput *output;
+    guint8 transport;
     GError *error = NULL;
 
     /* Check result of the async operation */
@@ -141,6 +534,21 @@ internal_proxy_open_ready (QmiClientCtl *client_ctl,
         return;
     }
 
+    /* Switch to the shared memory transport if the proxy agreed; the
+     * descriptors were received where the I/O happens, so set it up there */
+    if (qmi_message_ctl_internal_proxy_open_output_get_transport (output, &transport, NULL) &&
+        transport == QMI_PROXY_TRANSPORT_SHM) {
+        SetupShmContext shm_ctx = { g_task_get_source_object (task), &error, FALSE };
+
+        qmi_endpoint_io_invoke_sync (QMI_ENDPOINT (shm_ctx.self), (GSourceFunc)setup_shm_cb, &shm_ctx);
+        if (!shm_ctx.ret) {
+            g_task_return_error (task, error);
+            g_object_unref (task);
+            qmi_message_ctl_internal_proxy_open_output_unref (output);
+            return;
+        }
+    }
+
     qmi_message_ctl_internal_proxy_open_output_unref (output);
     g_task_return_boolean (task, TRUE);
     g_object_unref (task);
@@ -158,6 +566,7 @@ setup_proxy (GTask *task)
     g_object_get (self, QMI_ENDPOINT_FILE, &file, NULL);
     input = qmi_message_ctl_internal_proxy_open_input_new ();
     qmi_message_ctl_internal_proxy_open_input_set_device_path (input, qmi_file_get_path (file), NULL);
+    qmi_message_ctl_internal_proxy_open_input_set_transport (input, QMI_PROXY_TRANSPORT_SHM, NULL);
     qmi_client_ctl_internal_proxy_open (self->priv->client_ctl,
                                         input,
                                         5,
@@ -196,7 +605,7 @@ setup_iostream (GTask *task)
                            (GSourceFunc)input_ready_cb,
                            self,
                            NULL);
-    g_source_attach (self->priv->input_source, g_main_context_get_thread_default ());
+    g_source_attach (self->priv->input_source, qmi_endpoint_peek_io_context (QMI_ENDPOINT (self)));
 
     if (!ctx->use_proxy) {
         /* We're done here */
@@ -406,19 +815,34 @@ endpoint_send (QmiEndpoint   *self,
         return FALSE;
     }
 
-    if (!g_output_stream_write_all (QMI_ENDPOINT_QMUX (self)->priv->ostream,
-                                    raw_message,
-                                    raw_message_len,
-                                    NULL, /* bytes_written */
-                                    NULL, /* cancellable */
-                                    &inner_error)) {
-        g_propagate_prefixed_error (error, inner_error, "Cannot write message: ");
-        return FALSE;
+    if (QMI_ENDPOINT_QMUX (self)->priv->shm)
+        return shm_send (QMI_ENDPOINT_QMUX (self), raw_message, raw_message_len, timeout, error);
+
+    /* Never block the I/O context on a stalled port, whatever cannot be
+     * written right away is queued */
+    return (tx_queue_push (QMI_ENDPOINT_QMUX (self), &message, 1, error) == 1);
+}
+
+static guint
+endpoint_send_batch (QmiEndpoint   *self,
+                     QmiMessage   **messages,
+                     guint          n_messages,
+                     guint          timeout,
+                     GCancellable  *cancellable,
+                     GError       **error)
+{
+    guint i;
+
+    if (QMI_ENDPOINT_QMUX (self)->priv->shm) {
+        for (i = 0; i < n_messages; i++) {
+            if (!endpoint_send (self, messages[i], timeout, cancellable, error))
+                break;
+        }
+        return i;
     }
 
-    /* Flush explicitly if correctly written */
-    g_output_stream_flush (QMI_ENDPOINT_QMUX (self)->priv->ostream, NULL, NULL);
-    return TRUE;
+    /* Written together, as a single writev() when the port allows */
+    return tx_queue_push (QMI_ENDPOINT_QMUX (self), messages, n_messages, error);
 }
 
 /*****************************************************************************/
@@ -431,9 +855,19 @@ endpoint_close_finish (QmiEndpoint   *self,
     return g_task_propagate_boolean (G_TASK (res), error);
 }
 
-static void
-destroy_iostream (QmiEndpointQmux *self)
+static gboolean
+destroy_iostream_cb (QmiEndpointQmux *self)
 {
+    tx_queue_clear (self);
+
+    if (self->priv->shm_source) {
+        g_source_destroy (self->priv->shm_source);
+        g_clear_pointer (&self->priv->shm_source, g_source_unref);
+    }
+    g_clear_pointer (&self->priv->shm, __qmi_shm_channel_free);
+    while (self->priv->n_shm_fds > 0)
+        close (self->priv->shm_fds[--self->priv->n_shm_fds]);
+
     if (self->priv->input_source) {
         g_source_destroy (self->priv->input_source);
         g_clear_pointer (&self->priv->input_source, g_source_unref);
@@ -446,6 +880,14 @@ destroy_iostream (QmiEndpointQmux *self)
         close (self->priv->fd);
         self->priv->fd = -1;
     }
+    return G_SOURCE_REMOVE;
+}
+
+static void
+destroy_iostream (QmiEndpointQmux *self)
+{
+    /* Not while a read may be in progress in a worker thread */
+    qmi_endpoint_io_invoke_sync (QMI_ENDPOINT (self), (GSourceFunc)destroy_iostream_cb, self);
 }
 
 static void
@@ -496,6 +938,8 @@ qmi_endpoint_qmux_init (QmiEndpointQmux *self)
                                               QMI_TYPE_ENDPOINT_QMUX,
                                               QmiEndpointQmuxPrivate);
     self->priv->fd = -1;
+    g_queue_init (&self->priv->tx_queue);
+    self->priv->tx_queue_max_size = QMI_ENDPOINT_QMUX_TX_QUEUE_MAX_SIZE_DEFAULT;
 }
 
 static void
@@ -522,6 +966,7 @@ qmi_endpoint_qmux_class_init (QmiEndpointQmuxClass *klass)
     endpoint_class->open_finish = endpoint_open_finish;
     endpoint_class->is_open = endpoint_is_open;
     endpoint_class->send = endpoint_send;
+    endpoint_class->send_batch = endpoint_send_batch;
     endpoint_class->close = endpoint_close;
     endpoint_class->close_finish = endpoint_close_finish;
 }
@@ -56,4 +56,12 @@ QmiEndpointQmux *qmi_endpoint_qmux_new (QmiFile *file,
                                         gchar *proxy_path,
                                         QmiClientCtl *client_ctl);
 
+/* Messages that cannot be written right away are queued until the port is
+ * writable; sending fails once @n_messages are queued (0 means no limit).
+ * Must be set before opening. */
+#define QMI_ENDPOINT_QMUX_TX_QUEUE_MAX_SIZE_DEFAULT 256
+
+void qmi_endpoint_qmux_set_tx_queue_max_size (QmiEndpointQmux *self,
+                                              guint            n_messages);
+
 #endif /* _LIBQMI_GLIB_QMI_ENDPOINT_QMUX_H_ */
@@ -21,14 +21,18 @@
  * Copyright (C) 2020 Aleksander Morgado <aleksander@aleksander.es>
  */
 
+#define _GNU_SOURCE
 #include <errno.h>
 #include <linux/qrtr.h>
 #include <string.h>
+#include <unistd.h>
+#include <sys/epoll.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 
 #include <gmodule.h>
 #include <gio/gio.h>
+#include <glib-unix.h>
 
 #include <libqrtr-glib.h>
 
@@ -48,6 +52,12 @@
 #define QMI_MESSAGE_CTL_GET_VERSION_INFO 0x0021
 #define QMI_MESSAGE_CTL_SYNC 0x0027
 
+/* Datagrams read at once from a single socket; each one gets a receive
+ * buffer big enough for the largest QMI message, with room for the QMUX
+ * header in front */
+#define RX_BATCH_SIZE   8
+#define RX_BUFFER_SIZE  (QMI_MESSAGE_QMUX_HEADROOM + G_MAXUINT16)
+
 G_DEFINE_TYPE (QmiEndpointQrtr, qmi_endpoint_qrtr, QMI_TYPE_ENDPOINT)
 
 struct _QmiEndpointQrtrPrivate {
@@ -59,107 +69,155 @@ struct _QmiEndpointQrtrPrivate {
     GList *client_list;
     /* Map of client id -> ClientInfo */
     GTree *client_map;
-    /* Map of socket -> ClientInfo */
+    /* Map of socket fd -> ClientInfo */
     GHashTable *socket_map;
+
+    /* Single watch on the sockets of all clients */
+    gint epoll_fd;
+    GSource *epoll_source;
+
+    /* Reusable receive buffers, RX_BATCH_SIZE of RX_BUFFER_SIZE bytes */
+    guint8 *rx_buffers;
 };
 
 typedef struct {
     guint client_id;
     GSocket *socket;
-    GSource *source;
 } ClientInfo;
 
 /*****************************************************************************/
 
-static gboolean
-add_qmi_message_to_buffer (QmiEndpointQrtr *self,
-                           QmiMessage *message)
+static void
+add_qmi_message (QmiEndpointQrtr *self,
+                 QmiMessage *message)
 {
-    const guint8 *raw_message;
-    gsize raw_message_len;
-    GError *error = NULL;
-
-    raw_message = qmi_message_get_raw (message, &raw_message_len, &error);
-    if (!raw_message) {
-        g_warning ("[%s] Got malformed QMI message: %s",
-                   qmi_endpoint_get_name (QMI_ENDPOINT (self)), error->message);
-        return FALSE;
-    }
-
-    qmi_endpoint_add_message (QMI_ENDPOINT (self), raw_message, raw_message_len);
-    qmi_message_unref (message);
-    return TRUE;
+    /* Messages are already framed, so they skip the byte stream parser */
+    qmi_endpoint_add_qmi_message (QMI_ENDPOINT (self), message);
 }
 
-static gboolean
-qrtr_message_cb (GSocket *gsocket,
-                 GIOCondition cond,
-                 QmiEndpointQrtr *self)
+static void
+qrtr_datagram_process (QmiEndpointQrtr *self,
+                       guint client_id,
+                       struct mmsghdr *msg)
 {
     g_autoptr(GError) error = NULL;
-    g_autoptr(GSocketAddress) addr = NULL;
-    struct sockaddr_qrtr sq;
-    g_autoptr(GByteArray) buf = NULL;
-    gssize next_datagram_size;
-    gssize bytes_received;
-    ClientInfo *info;
+    struct sockaddr_qrtr *sq;
     QmiService service;
-    guint client;
     QmiMessage *message;
+    guint8 *buffer;
 
-    info = g_hash_table_lookup (self->priv->socket_map, gsocket);
-    if (!info) {
-        /* We're no longer watching this socket. */
-        return FALSE;
-    }
-
-    next_datagram_size = g_socket_get_available_bytes (gsocket);
-    buf = g_byte_array_new ();
-    g_byte_array_set_size (buf, next_datagram_size);
-
-    bytes_received = g_socket_receive_from (gsocket, &addr, (gchar *)buf->data,
-                                            next_datagram_size, NULL, &error);
-    if (bytes_received < 0) {
-        g_warning ("[%s] Socket IO failure: %s",
-                   qmi_endpoint_get_name (QMI_ENDPOINT (self)), error->message);
-        g_signal_emit_by_name (QMI_ENDPOINT (self), QMI_ENDPOINT_SIGNAL_HANGUP);
-        return FALSE;
-    }
-
-    if (bytes_received != next_datagram_size) {
+    if (msg->msg_hdr.msg_flags & MSG_TRUNC) {
         g_debug ("[%s] Datagram was not expected size", qmi_endpoint_get_name (QMI_ENDPOINT (self)));
-        return TRUE;
+        return;
     }
 
     /* Figure out where we got this message from */
-    if (!g_socket_address_to_native (addr, &sq, sizeof(sq), &error)) {
-        g_warning ("[%s] Could not parse QRTR address: %s",
-                   qmi_endpoint_get_name (QMI_ENDPOINT (self)), error->message);
-        return TRUE;
-    }
-
-    if (sq.sq_family != AF_QIPCRTR ||
-        sq.sq_node != qrtr_node_id (self->priv->node) ||
-        sq.sq_port == QRTR_PORT_CTRL) {
+    sq = msg->msg_hdr.msg_name;
+    if (msg->msg_hdr.msg_namelen < sizeof (*sq) ||
+        sq->sq_family != AF_QIPCRTR ||
+        sq->sq_node != qrtr_node_id (self->priv->node) ||
+        sq->sq_port == QRTR_PORT_CTRL) {
         /* ignore all CTRL messages or ones not from our node, we only want real
          * QMI messages */
-        return TRUE;
+        return;
     }
 
-    /* Create a fake QMUX header and add this message to the buffer */
-    service = qrtr_node_lookup_service (self->priv->node, sq.sq_port);
-    client = info->client_id;
-    message = qmi_message_new_from_data (service, client, buf, &error);
+    /* Create a fake QMUX header in the room left in front of the datagram
+     * and hand over the message */
+    buffer = (guint8 *)msg->msg_hdr.msg_iov->iov_base - QMI_MESSAGE_QMUX_HEADROOM;
+    service = qrtr_node_lookup_service (self->priv->node, sq->sq_port);
+    message = __qmi_message_new_from_headroom (service, client_id, buffer,
+                                               msg->msg_len, &error);
     if (!message) {
         g_warning ("[%s] Got malformed QMI message: %s",
                    qmi_endpoint_get_name (QMI_ENDPOINT (self)), error->message);
-        return TRUE;
+        return;
     }
 
-    add_qmi_message_to_buffer (self, message);
+    add_qmi_message (self, message);
+}
+
+/* Returns FALSE if the endpoint stopped reading while processing */
+static gboolean
+qrtr_socket_drain (QmiEndpointQrtr *self,
+                   gint fd)
+{
+    struct mmsghdr msgs[RX_BATCH_SIZE];
+    struct iovec iovs[RX_BATCH_SIZE];
+    struct sockaddr_qrtr addrs[RX_BATCH_SIZE];
+    ClientInfo *info;
+    guint client_id;
+    gint n_msgs;
+    gint i;
+
+    do {
+        /* The client may have been released while processing the previous
+         * batch */
+        info = g_hash_table_lookup (self->priv->socket_map, GINT_TO_POINTER (fd));
+        if (!info)
+            return TRUE;
+        client_id = info->client_id;
+
+        memset (msgs, 0, sizeof (msgs));
+        for (i = 0; i < RX_BATCH_SIZE; i++) {
+            iovs[i].iov_base = self->priv->rx_buffers + (i * RX_BUFFER_SIZE) + QMI_MESSAGE_QMUX_HEADROOM;
+            iovs[i].iov_len = RX_BUFFER_SIZE - QMI_MESSAGE_QMUX_HEADROOM;
+            msgs[i].msg_hdr.msg_name = &addrs[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof (addrs[i]);
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        n_msgs = recvmmsg (fd, msgs, RX_BATCH_SIZE, MSG_DONTWAIT, NULL);
+        if (n_msgs < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+                return TRUE;
+            g_warning ("[%s] Socket IO failure: %s",
+                       qmi_endpoint_get_name (QMI_ENDPOINT (self)), g_strerror (errno));
+            g_signal_emit_by_name (QMI_ENDPOINT (self), QMI_ENDPOINT_SIGNAL_HANGUP);
+            return FALSE;
+        }
+
+        for (i = 0; i < n_msgs; i++) {
+            qrtr_datagram_process (self, client_id, &msgs[i]);
+            /* Endpoint closed by whoever got the message */
+            if (!self->priv->socket_map)
+                return FALSE;
+        }
+    } while (n_msgs == RX_BATCH_SIZE);
+
     return TRUE;
 }
 
+static gboolean
+qrtr_sockets_cb (gint epoll_fd,
+                 GIOCondition cond,
+                 QmiEndpointQrtr *self)
+{
+    struct epoll_event events[RX_BATCH_SIZE];
+    gint n_events;
+    gint i;
+
+    n_events = epoll_wait (epoll_fd, events, RX_BATCH_SIZE, 0);
+    if (n_events < 0) {
+        if (errno != EINTR)
+            g_warning ("[%s] Couldn't wait for QRTR sockets: %s",
+                       qmi_endpoint_get_name (QMI_ENDPOINT (self)), g_strerror (errno));
+        return G_SOURCE_CONTINUE;
+    }
+
+    /* Level-triggered, so any socket not reached in this wake-up (more than
+     * RX_BATCH_SIZE ready at once) is reported again in the next one */
+    g_object_ref (self);
+    for (i = 0; i < n_events; i++) {
+        if (!qrtr_socket_drain (self, events[i].data.fd))
+            break;
+    }
+    g_object_unref (self);
+
+    return G_SOURCE_CONTINUE;
+}
+
 static void
 node_removed_cb (QrtrNode *node,
                  QmiEndpointQrtr *self)
@@ -175,10 +233,7 @@ node_removed_cb (QrtrNode *node,
 static void
 client_info_destroy (ClientInfo *info)
 {
-    if (info->source) {
-        g_source_destroy (info->source);
-        g_source_unref (info->source);
-    }
+    /* Closing the socket also removes it from the epoll set */
     if (info->socket) {
         g_socket_close (info->socket, NULL);
         g_clear_object (&info->socket);
@@ -221,6 +276,7 @@ allocate_client (QmiEndpointQrtr *self, GError **error)
     GSocket *gsocket;
     guint client_id;
     ClientInfo *info;
+    struct epoll_event event = { 0 };
 
     if (!self->priv->client_map) {
         g_set_error (error,
@@ -262,17 +318,26 @@ allocate_client (QmiEndpointQrtr *self, GError **error)
 
     g_socket_set_timeout (gsocket, 0);
 
+    event.events = EPOLLIN;
+    event.data.fd = socket_fd;
+    if (epoll_ctl (self->priv->epoll_fd, EPOLL_CTL_ADD, socket_fd, &event) < 0) {
+        g_set_error (error,
+                     QMI_CORE_ERROR,
+                     QMI_CORE_ERROR_FAILED,
+                     "[%s] Could not watch QRTR socket: %s",
+                     qmi_endpoint_get_name (QMI_ENDPOINT (self)), strerror(errno));
+        g_socket_close (gsocket, NULL);
+        g_object_unref (gsocket);
+        return -QMI_PROTOCOL_ERROR_INTERNAL;
+    }
+
     info = g_slice_new0 (ClientInfo);
     info->client_id = client_id;
     info->socket = gsocket;
-    info->source = g_socket_create_source (gsocket, G_IO_IN, NULL);
-    g_source_set_callback (info->source, (GSourceFunc) qrtr_message_cb,
-                           self, NULL);
-    g_source_attach (info->source, NULL);
 
     self->priv->client_list = g_list_append (self->priv->client_list, info);
     g_tree_insert (self->priv->client_map, GUINT_TO_POINTER (info->client_id), info);
-    g_hash_table_insert (self->priv->socket_map, gsocket, info);
+    g_hash_table_insert (self->priv->socket_map, GINT_TO_POINTER (socket_fd), info);
     return info->client_id;
 }
 
@@ -285,7 +350,7 @@ release_client (QmiEndpointQrtr *self, guint client_id)
     if (!info)
         return;
 
-    g_hash_table_remove (self->priv->socket_map, info->socket);
+    g_hash_table_remove (self->priv->socket_map, GINT_TO_POINTER (g_socket_get_fd (info->socket)));
     g_tree_remove (self->priv->client_map, GUINT_TO_POINTER (client_id));
     self->priv->client_list = g_list_remove (self->priv->client_list, info);
     client_info_destroy (info);
@@ -347,7 +412,7 @@ handle_alloc_cid (QmiEndpointQrtr *self, QmiMessage *message)
         return;
     }
 
-    add_qmi_message_to_buffer (self, response);
+    add_qmi_message (self, response);
 }
 
 static void
@@ -380,7 +445,7 @@ handle_release_cid (QmiEndpointQrtr *self, QmiMessage *message)
         return;
     }
 
-    add_qmi_message_to_buffer (self, response);
+    add_qmi_message (self, response);
 }
 
 static void
@@ -392,7 +457,7 @@ handle_sync (QmiEndpointQrtr *self, QmiMessage *message)
     if (!response)
         return;
 
-    add_qmi_message_to_buffer (self, response);
+    add_qmi_message (self, response);
 }
 
 static void
@@ -415,7 +480,7 @@ unhandled_message (QmiEndpointQrtr *self,
     response = qmi_message_response_new (message, QMI_PROTOCOL_ERROR_NOT_SUPPORTED);
     if (!response)
         return;
-    add_qmi_message_to_buffer (self, response);
+    add_qmi_message (self, response);
 }
 
 static void
@@ -487,6 +552,26 @@ endpoint_open (QmiEndpoint         *endpoint,
     }
 
     g_assert (self->priv->client_list == NULL);
+    g_assert (self->priv->epoll_fd < 0);
+
+    self->priv->epoll_fd = epoll_create1 (EPOLL_CLOEXEC);
+    if (self->priv->epoll_fd < 0) {
+        g_task_return_new_error (task,
+                                 QMI_CORE_ERROR,
+                                 QMI_CORE_ERROR_FAILED,
+                                 "Could not create epoll instance: %s",
+                                 g_strerror (errno));
+        g_object_unref (task);
+        return;
+    }
+    self->priv->epoll_source = g_unix_fd_source_new (self->priv->epoll_fd, G_IO_IN);
+    g_source_set_callback (self->priv->epoll_source, (GSourceFunc) qrtr_sockets_cb,
+                           self, NULL);
+    g_source_attach (self->priv->epoll_source, NULL);
+
+    if (!self->priv->rx_buffers)
+        self->priv->rx_buffers = g_malloc (RX_BATCH_SIZE * RX_BUFFER_SIZE);
+
     self->priv->client_map = g_tree_new (client_map_key_cmp);
     self->priv->socket_map = g_hash_table_new (g_direct_hash, g_direct_equal);
     g_task_return_boolean (task, TRUE);
@@ -593,6 +678,19 @@ endpoint_send (QmiEndpoint   *endpoint,
 
 /*****************************************************************************/
 
+static void
+stop_watching_sockets (QmiEndpointQrtr *self)
+{
+    if (self->priv->epoll_source) {
+        g_source_destroy (self->priv->epoll_source);
+        g_clear_pointer (&self->priv->epoll_source, g_source_unref);
+    }
+    if (self->priv->epoll_fd >= 0) {
+        close (self->priv->epoll_fd);
+        self->priv->epoll_fd = -1;
+    }
+}
+
 static gboolean
 endpoint_close_finish (QmiEndpoint   *self,
                        GAsyncResult  *res,
@@ -614,6 +712,7 @@ endpoint_close (QmiEndpoint         *endpoint,
     self = QMI_ENDPOINT_QRTR (endpoint);
     task = g_task_new (self, cancellable, callback, user_data);
 
+    stop_watching_sockets (self);
     g_clear_pointer (&self->priv->socket_map, g_hash_table_destroy);
     g_clear_pointer (&self->priv->client_map, g_tree_destroy);
     g_clear_pointer (&self->priv->client_list, client_list_destroy);
@@ -657,6 +756,8 @@ qmi_endpoint_qrtr_init (QmiEndpointQrtr *self)
     self->priv = G_TYPE_INSTANCE_GET_PRIVATE ((self),
                                               QMI_TYPE_ENDPOINT_QRTR,
                                               QmiEndpointQrtrPrivate);
+
+    self->priv->epoll_fd = -1;
 }
 
 static void
@@ -664,6 +765,7 @@ dispose (GObject *object)
 {
     QmiEndpointQrtr *self = QMI_ENDPOINT_QRTR (object);
 
+    stop_watching_sockets (self);
     g_clear_pointer (&self->priv->socket_map, g_hash_table_destroy);
     g_clear_pointer (&self->priv->client_map, g_tree_destroy);
     g_clear_pointer (&self->priv->client_list, client_list_destroy);
@@ -676,6 +778,8 @@ dispose (GObject *object)
         g_clear_object (&self->priv->node);
     }
 
+    g_clear_pointer (&self->priv->rx_buffers, g_free);
+
     G_OBJECT_CLASS (qmi_endpoint_qrtr_parent_class)->dispose (object);
 }
 
@@ -27,12 +27,19 @@
 #include "qmi-utils-private.h"
 #include "qmi-error-types.h"
 #include "qmi-errors.h"
+#include "qmi-worker.h"
 
 G_DEFINE_TYPE (QmiEndpoint, qmi_endpoint, G_TYPE_OBJECT)
 
 struct _QmiEndpointPrivate {
     GByteArray *buffer;
+    /* Start of the not yet parsed data in the buffer */
+    guint offset;
+    /* Complete messages added by the subclass, not yet handled */
+    GQueue *messages;
     QmiFile *file;
+    /* Thread doing the I/O, if not the one of the caller */
+    QmiWorker *worker;
 };
 
 enum {
@@ -52,22 +59,46 @@ static guint signals[SIGNAL_LAST] = { 0 };
 
 /*****************************************************************************/
 
+static void
+endpoint_compact_buffer (QmiEndpoint *self)
+{
+    /* Drop the bytes of all the messages parsed so far in one go, instead of
+     * shifting the remaining data once per message */
+    if (self->priv->offset == self->priv->buffer->len)
+        g_byte_array_set_size (self->priv->buffer, 0);
+    else if (self->priv->offset > 0)
+        g_byte_array_remove_range (self->priv->buffer, 0, self->priv->offset);
+    self->priv->offset = 0;
+}
+
 gboolean
 qmi_endpoint_parse_buffer (QmiEndpoint        *self,
                            QmiMessageHandler   handler,
                            gpointer            user_data,
                            GError            **error)
 {
+    QmiMessage *message;
+
+    /* Whole messages skip the byte stream parser altogether */
+    while ((message = g_queue_pop_head (self->priv->messages)) != NULL) {
+        handler (message, user_data);
+        qmi_message_unref (message);
+    }
+
+    if (self->priv->buffer->len == 0)
+        return TRUE;
+
     do {
         GError *inner_error = NULL;
-        QmiMessage *message;
+        gsize consumed;
 
         /* Every message received must start with the QMUX marker.
          * If it doesn't, we broke framing :-/
          * If we broke framing, an error should be reported and the device
          * should get closed */
-        if (self->priv->buffer->len > 0 &&
-            self->priv->buffer->data[0] != QMI_MESSAGE_QMUX_MARKER) {
+        if (self->priv->buffer->len > self->priv->offset &&
+            self->priv->buffer->data[self->priv->offset] != QMI_MESSAGE_QMUX_MARKER) {
+            endpoint_compact_buffer (self);
             g_set_error (error,
                          QMI_PROTOCOL_ERROR,
                          QMI_PROTOCOL_ERROR_MALFORMED_MESSAGE,
@@ -76,11 +107,17 @@ qmi_endpoint_parse_buffer (QmiEndpoint        *self,
             return FALSE;
         }
 
-        message = qmi_message_new_from_raw (self->priv->buffer, &inner_error);
+        message = __qmi_message_new_from_buffer (self->priv->buffer->data + self->priv->offset,
+                                                 self->priv->buffer->len - self->priv->offset,
+                                                 &consumed,
+                                                 &inner_error);
+        self->priv->offset += consumed;
         if (!message) {
-            if (!inner_error)
+            if (!inner_error) {
                 /* More data we need */
+                endpoint_compact_buffer (self);
                 return TRUE;
+            }
 
             /* Warn about the issue */
             g_warning ("[%s] Invalid QMI message received: '%s'",
@@ -90,14 +127,15 @@ qmi_endpoint_parse_buffer (QmiEndpoint        *self,
 
             if (qmi_utils_get_traces_enabled ()) {
                 gchar *printable;
-                guint len = MIN (self->priv->buffer->len, 2048);
+                guint remaining = self->priv->buffer->len - self->priv->offset;
+                guint len = MIN (remaining, 2048);
 
-                printable = __qmi_utils_str_hex (self->priv->buffer->data,
+                printable = __qmi_utils_str_hex (self->priv->buffer->data + self->priv->offset,
                                                  len, ':');
                 g_debug ("<<<<<< RAW INVALID MESSAGE:\n"
                          "<<<<<<   length = %u\n"
                          "<<<<<<   data   = %s\n",
-                         self->priv->buffer->len, /* show full buffer len */
+                         remaining, /* show full buffer len */
                          printable);
                 g_free (printable);
             }
@@ -107,8 +145,9 @@ qmi_endpoint_parse_buffer (QmiEndpoint        *self,
             handler (message, user_data);
             qmi_message_unref (message);
         }
-    } while (self->priv->buffer->len > 0);
+    } while (self->priv->buffer->len > self->priv->offset);
 
+    endpoint_compact_buffer (self);
     return TRUE;
 }
 
@@ -121,6 +160,14 @@ qmi_endpoint_add_message (QmiEndpoint  *self,
     g_signal_emit (self, signals[SIGNAL_NEW_DATA], 0);
 }
 
+void
+qmi_endpoint_add_qmi_message (QmiEndpoint *self,
+                              QmiMessage  *message)
+{
+    g_queue_push_tail (self->priv->messages, message);
+    g_signal_emit (self, signals[SIGNAL_NEW_DATA], 0);
+}
+
 /*****************************************************************************/
 
 static gboolean
@@ -214,6 +261,55 @@ qmi_endpoint_setup_indications (QmiEndpoint         *self,
                                                              user_data);
 }
 
+void
+qmi_endpoint_set_worker (QmiEndpoint *self,
+                         QmiWorker   *worker)
+{
+    g_assert (!self->priv->worker);
+    g_assert (!qmi_endpoint_is_open (self));
+
+    self->priv->worker = __qmi_worker_ref (worker);
+}
+
+GMainContext *
+qmi_endpoint_peek_io_context (QmiEndpoint *self)
+{
+    if (self->priv->worker)
+        return __qmi_worker_peek_context (self->priv->worker);
+    return g_main_context_get_thread_default ();
+}
+
+void
+qmi_endpoint_io_invoke_sync (QmiEndpoint *self,
+                             GSourceFunc  func,
+                             gpointer     user_data)
+{
+    if (self->priv->worker)
+        __qmi_worker_invoke_sync (self->priv->worker, func, user_data);
+    else
+        func (user_data);
+}
+
+typedef struct {
+    QmiEndpoint   *self;
+    QmiMessage    *message;
+    guint          timeout;
+    GCancellable  *cancellable;
+    GError       **error;
+    gboolean       sent;
+} SendContext;
+
+static gboolean
+send_cb (SendContext *ctx)
+{
+    ctx->sent = QMI_ENDPOINT_GET_CLASS (ctx->self)->send (ctx->self,
+                                                          ctx->message,
+                                                          ctx->timeout,
+                                                          ctx->cancellable,
+                                                          ctx->error);
+    return G_SOURCE_REMOVE;
+}
+
 gboolean
 qmi_endpoint_send (QmiEndpoint   *self,
                    QmiMessage    *message,
@@ -221,9 +317,71 @@ qmi_endpoint_send (QmiEndpoint   *self,
                    GCancellable  *cancellable,
                    GError       **error)
 {
+    SendContext ctx = { self, message, timeout, cancellable, error, FALSE };
+
+    g_assert (QMI_ENDPOINT_GET_CLASS (self)->send);
+
+    /* Writes go through the worker as well, so that the transport is never
+     * used from two threads at the same time */
+    qmi_endpoint_io_invoke_sync (self, (GSourceFunc)send_cb, &ctx);
+    return ctx.sent;
+}
+
+typedef struct {
+    QmiEndpoint   *self;
+    QmiMessage   **messages;
+    guint          n_messages;
+    guint          timeout;
+    GCancellable  *cancellable;
+    GError       **error;
+    guint          n_sent;
+} SendBatchContext;
+
+static gboolean
+send_batch_cb (SendBatchContext *ctx)
+{
+    QmiEndpointClass *klass;
+
+    klass = QMI_ENDPOINT_GET_CLASS (ctx->self);
+    if (klass->send_batch) {
+        ctx->n_sent = klass->send_batch (ctx->self,
+                                         ctx->messages,
+                                         ctx->n_messages,
+                                         ctx->timeout,
+                                         ctx->cancellable,
+                                         ctx->error);
+        return G_SOURCE_REMOVE;
+    }
+
+    for (ctx->n_sent = 0; ctx->n_sent < ctx->n_messages; ctx->n_sent++) {
+        if (!klass->send (ctx->self,
+                          ctx->messages[ctx->n_sent],
+                          ctx->timeout,
+                          ctx->cancellable,
+                          ctx->error))
+            break;
+    }
+    return G_SOURCE_REMOVE;
+}
+
+guint
+qmi_endpoint_send_batch (QmiEndpoint   *self,
+                         QmiMessage   **messages,
+                         guint          n_messages,
+                         guint          timeout,
+                         GCancellable  *cancellable,
+                         GError       **error)
+{
+    SendBatchContext ctx = { self, messages, n_messages, timeout, cancellable, error, 0 };
+
     g_assert (QMI_ENDPOINT_GET_CLASS (self)->send);
 
-    return QMI_ENDPOINT_GET_CLASS (self)->send (self, message, timeout, cancellable, error);
+    if (!n_messages)
+        return 0;
+
+    /* A single hop to the worker for the whole batch */
+    qmi_endpoint_io_invoke_sync (self, (GSourceFunc)send_batch_cb, &ctx);
+    return ctx.n_sent;
 }
 
 gboolean
@@ -300,6 +458,7 @@ qmi_endpoint_init (QmiEndpoint *self)
                                               QmiEndpointPrivate);
 
     self->priv->buffer = g_byte_array_new ();
+    self->priv->messages = g_queue_new ();
 }
 
 static void
@@ -308,7 +467,12 @@ dispose (GObject *object)
     QmiEndpoint *self = QMI_ENDPOINT (object);
 
     g_clear_pointer (&self->priv->buffer, g_byte_array_unref);
+    if (self->priv->messages) {
+        g_queue_free_full (self->priv->messages, (GDestroyNotify)qmi_message_unref);
+        self->priv->messages = NULL;
+    }
     g_clear_object (&self->priv->file);
+    g_clear_pointer (&self->priv->worker, __qmi_worker_unref);
 
     G_OBJECT_CLASS (qmi_endpoint_parent_class)->dispose (object);
 }
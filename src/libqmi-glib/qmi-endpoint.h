@@ -30,6 +30,7 @@
 #include "qmi-ctl.h"
 #include "qmi-file.h"
 #include "qmi-message.h"
+#include "qmi-worker.h"
 
 typedef void (*QmiMessageHandler) (QmiMessage *message,
                                    gpointer user_data);
@@ -87,6 +88,14 @@ struct _QmiEndpointClass {
                        GCancellable  *cancellable,
                        GError       **error);
 
+    /* optional, send() is used for each message otherwise */
+    guint (* send_batch) (QmiEndpoint   *self,
+                          QmiMessage   **messages,
+                          guint          n_messages,
+                          guint          timeout,
+                          GCancellable  *cancellable,
+                          GError       **error);
+
     void (* close)            (QmiEndpoint         *self,
                                guint                timeout,
                                GCancellable        *cancellable,
@@ -123,12 +132,47 @@ gboolean qmi_endpoint_setup_indications_finish (QmiEndpoint   *self,
                                                 GAsyncResult  *res,
                                                 GError       **error);
 
+/*
+ * Do the I/O of the endpoint in the thread of @worker, instead of in the
+ * thread-default context of the caller. Must be set before opening.
+ *
+ * The ::new-data and ::hangup signals are then emitted in the worker thread.
+ */
+void qmi_endpoint_set_worker (QmiEndpoint *self,
+                              QmiWorker   *worker);
+
+/*
+ * Context where subclasses attach their I/O sources.
+ */
+GMainContext *qmi_endpoint_peek_io_context (QmiEndpoint *self);
+
+/*
+ * Run @func where the I/O of the endpoint happens and wait for it, so that
+ * subclasses can safely update their I/O state from any thread.
+ */
+void qmi_endpoint_io_invoke_sync (QmiEndpoint *self,
+                                  GSourceFunc  func,
+                                  gpointer     user_data);
+
 gboolean qmi_endpoint_send (QmiEndpoint   *self,
                             QmiMessage    *message,
                             guint          timeout,
                             GCancellable  *cancellable,
                             GError       **error);
 
+/*
+ * Send the @n_messages in @messages, in order, written together if the
+ * endpoint supports it. Returns how many were sent; if fewer than
+ * @n_messages, @error applies to the first one not sent, and none of
+ * the ones after it were tried.
+ */
+guint qmi_endpoint_send_batch (QmiEndpoint   *self,
+                               QmiMessage   **messages,
+                               guint          n_messages,
+                               guint          timeout,
+                               GCancellable  *cancellable,
+                               GError       **error);
+
 void qmi_endpoint_close (QmiEndpoint         *self,
                          guint                timeout,
                          GCancellable        *cancellable,
@@ -160,4 +204,14 @@ void qmi_endpoint_add_message (QmiEndpoint *self,
                                const guint8 *buf,
                                guint len);
 
+/*
+ * Adds the already framed @message, which is given to the parse_buffer()
+ * handler as is. The endpoint takes ownership of @message.
+ *
+ * This function should only be called by subclasses whose transport
+ * delivers whole messages.
+ */
+void qmi_endpoint_add_qmi_message (QmiEndpoint *self,
+                                   QmiMessage  *message);
+
 #endif /* _LIBQMI_GLIB_QMI_ENDPOINT_H_ */
@@ -215,6 +215,23 @@ qmi_message_set_transaction_id (QmiMessage *self,
         ((struct full_message *)self->data)->qmi.service.header.transaction = GUINT16_TO_LE (transaction_id);
 }
 
+void
+__qmi_message_set_client_id (QmiMessage *self,
+                             guint8      client_id)
+{
+    ((struct full_message *)self->data)->qmux.client = client_id;
+}
+
+QmiMessage *
+__qmi_message_copy (QmiMessage *self)
+{
+    GByteArray *copy;
+
+    copy = g_byte_array_sized_new (self->len);
+    g_byte_array_append (copy, self->data, self->len);
+    return (QmiMessage *)copy;
+}
+
 guint16
 qmi_message_get_message_id (QmiMessage *self)
 {
@@ -403,6 +420,16 @@ qmi_message_new (QmiService service,
                  guint8 client_id,
                  guint16 transaction_id,
                  guint16 message_id)
+{
+    return qmi_message_new_sized (service, client_id, transaction_id, message_id, 0);
+}
+
+QmiMessage *
+qmi_message_new_sized (QmiService service,
+                       guint8 client_id,
+                       guint16 transaction_id,
+                       guint16 message_id,
+                       gsize tlvs_size)
 {
     GByteArray *self;
     struct full_message *buffer;
@@ -424,8 +451,9 @@ qmi_message_new (QmiService service,
      * https://bugzilla.gnome.org/show_bug.cgi?id=738170
      */
 
-    /* Create the GByteArray with buffer_len bytes preallocated */
-    self = g_byte_array_sized_new (buffer_len);
+    /* Create the GByteArray with buffer_len bytes preallocated, plus the
+     * space requested for TLVs */
+    self = g_byte_array_sized_new (buffer_len + tlvs_size);
     /* Actually flag as all the buffer_len bytes being used. */
     g_byte_array_set_size (self, buffer_len);
 
@@ -913,6 +941,35 @@ qmi_message_tlv_write_string (QmiMessage   *self,
 /*****************************************************************************/
 /* TLV reader */
 
+static gsize
+tlv_read_init (QmiMessage  *self,
+               struct tlv  *tlv,
+               guint8       type,
+               guint16     *out_tlv_length,
+               GError     **error)
+{
+    guint16 tlv_length;
+
+    if (!tlv) {
+        g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_TLV_NOT_FOUND,
+                     "TLV 0x%02X not found", type);
+        return 0;
+    }
+
+    tlv_length = GUINT16_FROM_LE (tlv->length);
+
+    if (((guint8 *) tlv_next (tlv)) > ((guint8 *) qmi_end (self))) {
+        g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_TLV_TOO_LONG,
+                     "Invalid length for TLV 0x%02X: %" G_GUINT16_FORMAT, type, tlv_length);
+        return 0;
+    }
+
+    if (out_tlv_length)
+        *out_tlv_length = tlv_length;
+
+    return (((guint8 *)tlv) - self->data);
+}
+
 gsize
 qmi_message_tlv_read_init (QmiMessage  *self,
                            guint8       type,
@@ -920,7 +977,6 @@ qmi_message_tlv_read_init (QmiMessage  *self,
                            GError     **error)
 {
     struct tlv *tlv;
-    guint16     tlv_length;
 
     g_return_val_if_fail (self != NULL, 0);
     g_return_val_if_fail (self->len > 0, 0);
@@ -930,24 +986,75 @@ qmi_message_tlv_read_init (QmiMessage  *self,
             break;
     }
 
-    if (!tlv) {
-        g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_TLV_NOT_FOUND,
-                     "TLV 0x%02X not found", type);
-        return 0;
+    return tlv_read_init (self, tlv, type, out_tlv_length, error);
+}
+
+const QmiMessageTlvIndex *
+__qmi_message_tlv_index_get (QmiMessage         *self,
+                             QmiMessageTlvIndex *tlv_index)
+{
+    struct tlv *tlv;
+
+    memset (tlv_index->offsets, 0, sizeof (tlv_index->offsets));
+
+    /* Only the first TLV of each type is looked up, as in qmi_message_tlv_read_init() */
+    for (tlv = qmi_tlv_first (self); tlv; tlv = qmi_tlv_next (self, tlv)) {
+        if (!tlv_index->offsets[tlv->type])
+            tlv_index->offsets[tlv->type] = (guint16)(((guint8 *)tlv) - self->data);
     }
+    return tlv_index;
+}
 
-    tlv_length = GUINT16_FROM_LE (tlv->length);
+gsize
+__qmi_message_tlv_index_read_init (QmiMessage               *self,
+                                   const QmiMessageTlvIndex *tlv_index,
+                                   guint8                    type,
+                                   guint16                  *out_tlv_length,
+                                   GError                  **error)
+{
+    struct tlv *tlv = NULL;
 
-    if (((guint8 *) tlv_next (tlv)) > ((guint8 *) qmi_end (self))) {
-        g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_TLV_TOO_LONG,
-                     "Invalid length for TLV 0x%02X: %" G_GUINT16_FORMAT, type, tlv_length);
+    g_return_val_if_fail (self != NULL, 0);
+    g_return_val_if_fail (self->len > 0, 0);
+
+    if (tlv_index->offsets[type])
+        tlv = (struct tlv *) &(self->data[tlv_index->offsets[type]]);
+
+    return tlv_read_init (self, tlv, type, out_tlv_length, error);
+}
+
+gsize
+__qmi_message_tlv_index_arena_size (QmiMessage               *self,
+                                    const QmiMessageTlvIndex *tlv_index,
+                                    guint8                    type)
+{
+    struct tlv *tlv;
+
+    if (!tlv_index->offsets[type])
         return 0;
-    }
 
-    if (out_tlv_length)
-        *out_tlv_length = tlv_length;
+    /* Every string read takes at least one byte of the TLV (its size prefix,
+     * or its contents), and decoding GSM-7 or UCS-2 into UTF-8 takes at most
+     * 3 bytes per input byte, plus the NUL. */
+    tlv = (struct tlv *) &(self->data[tlv_index->offsets[type]]);
+    return (4 * (gsize) GUINT16_FROM_LE (tlv->length)) + 1;
+}
 
-    return (((guint8 *)tlv) - self->data);
+static gchar *
+arena_alloc (QmiMessageArena  *arena,
+             gsize             size,
+             GError          **error)
+{
+    gchar *ptr;
+
+    if ((gsize)(arena->end - arena->next) < size) {
+        g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_INVALID_DATA, "too many strings in TLV");
+        return NULL;
+    }
+
+    ptr = arena->next;
+    arena->next += size;
+    return ptr;
 }
 
 static const guint8 *
@@ -1266,23 +1373,21 @@ qmi_message_tlv_read_gdouble (QmiMessage  *self,
     return TRUE;
 }
 
-gboolean
-qmi_message_tlv_read_string (QmiMessage  *self,
-                             gsize        tlv_offset,
-                             gsize       *offset,
-                             guint8       n_size_prefix_bytes,
-                             guint16      max_size,
-                             gchar      **out,
-                             GError     **error)
+/* Reads into @arena if given, or into a new heap string otherwise */
+static gboolean
+tlv_read_string (QmiMessage       *self,
+                 gsize             tlv_offset,
+                 gsize            *offset,
+                 guint8            n_size_prefix_bytes,
+                 guint16           max_size,
+                 QmiMessageArena  *arena,
+                 gchar           **out,
+                 GError          **error)
 {
     const guint8 *ptr;
     guint16 string_length;
     guint16 valid_string_length;
-
-    g_return_val_if_fail (self != NULL, FALSE);
-    g_return_val_if_fail (offset != NULL, FALSE);
-    g_return_val_if_fail (out != NULL, FALSE);
-    g_return_val_if_fail (n_size_prefix_bytes <= 2, FALSE);
+    gchar *decoded;
 
     switch (n_size_prefix_bytes) {
     case 0: {
@@ -1313,7 +1418,13 @@ qmi_message_tlv_read_string (QmiMessage  *self,
     }
 
     if (string_length == 0) {
-        *out = g_strdup ("");
+        if (!arena) {
+            *out = g_strdup ("");
+            return TRUE;
+        }
+        if (!(*out = arena_alloc (arena, 1, error)))
+            return FALSE;
+        (*out)[0] = '\0';
         return TRUE;
     }
 
@@ -1331,27 +1442,81 @@ qmi_message_tlv_read_string (QmiMessage  *self,
      * and we're trying to do our best to overcome modem firmware problems...
      */
     if (__qmi_string_utf8_validate_printable (ptr, valid_string_length)) {
-        *out = g_malloc (valid_string_length + 1);
+        if (!arena)
+            *out = g_malloc (valid_string_length + 1);
+        else if (!(*out = arena_alloc (arena, valid_string_length + 1, error)))
+            return FALSE;
         memcpy (*out, ptr, valid_string_length);
         (*out)[valid_string_length] = '\0';
     } else {
         /* Otherwise, attempt GSM-7 */
-        *out =__qmi_string_utf8_from_gsm7 (ptr, valid_string_length);
-        if (*out == NULL) {
+        decoded =__qmi_string_utf8_from_gsm7 (ptr, valid_string_length);
+        if (decoded == NULL) {
             /* Otherwise, attempt UCS-2 */
-            *out = __qmi_string_utf8_from_ucs2le (ptr, valid_string_length);
-            if (*out == NULL) {
+            decoded = __qmi_string_utf8_from_ucs2le (ptr, valid_string_length);
+            if (decoded == NULL) {
                 /* Otherwise, error */
                 g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_INVALID_DATA, "invalid string");
                 return FALSE;
             }
         }
+
+        if (!arena)
+            *out = decoded;
+        else {
+            gsize decoded_size;
+
+            /* Decoding is rare enough to keep going through a temporary */
+            decoded_size = strlen (decoded) + 1;
+            *out = arena_alloc (arena, decoded_size, error);
+            if (*out)
+                memcpy (*out, decoded, decoded_size);
+            g_free (decoded);
+            if (!*out)
+                return FALSE;
+        }
     }
 
     *offset = (*offset + string_length);
     return TRUE;
 }
 
+gboolean
+qmi_message_tlv_read_string (QmiMessage  *self,
+                             gsize        tlv_offset,
+                             gsize       *offset,
+                             guint8       n_size_prefix_bytes,
+                             guint16      max_size,
+                             gchar      **out,
+                             GError     **error)
+{
+    g_return_val_if_fail (self != NULL, FALSE);
+    g_return_val_if_fail (offset != NULL, FALSE);
+    g_return_val_if_fail (out != NULL, FALSE);
+    g_return_val_if_fail (n_size_prefix_bytes <= 2, FALSE);
+
+    return tlv_read_string (self, tlv_offset, offset, n_size_prefix_bytes, max_size, NULL, out, error);
+}
+
+gboolean
+__qmi_message_tlv_read_string_in_arena (QmiMessage       *self,
+                                        gsize             tlv_offset,
+                                        gsize            *offset,
+                                        guint8            n_size_prefix_bytes,
+                                        guint16           max_size,
+                                        QmiMessageArena  *arena,
+                                        gchar           **out,
+                                        GError          **error)
+{
+    g_return_val_if_fail (self != NULL, FALSE);
+    g_return_val_if_fail (offset != NULL, FALSE);
+    g_return_val_if_fail (arena != NULL, FALSE);
+    g_return_val_if_fail (out != NULL, FALSE);
+    g_return_val_if_fail (n_size_prefix_bytes <= 2, FALSE);
+
+    return tlv_read_string (self, tlv_offset, offset, n_size_prefix_bytes, max_size, arena, out, error);
+}
+
 gboolean
 qmi_message_tlv_read_fixed_size_string (QmiMessage  *self,
                                         gsize        tlv_offset,
@@ -1393,6 +1558,30 @@ qmi_message_tlv_read_fixed_size_string (QmiMessage  *self,
     return FALSE;
 }
 
+gboolean
+__qmi_message_tlv_read_fixed_size_string_in_arena (QmiMessage       *self,
+                                                   gsize             tlv_offset,
+                                                   gsize            *offset,
+                                                   guint16           string_length,
+                                                   QmiMessageArena  *arena,
+                                                   gchar           **out,
+                                                   GError          **error)
+{
+    gchar *str;
+
+    g_return_val_if_fail (arena != NULL, FALSE);
+    g_return_val_if_fail (out != NULL, FALSE);
+
+    /* The arena is zero-filled, so the string is always terminated */
+    if (!(str = arena_alloc (arena, (gsize) string_length + 1, error)))
+        return FALSE;
+    if (!qmi_message_tlv_read_fixed_size_string (self, tlv_offset, offset, string_length, str, error))
+        return FALSE;
+
+    *out = str;
+    return TRUE;
+}
+
 guint16
 __qmi_message_tlv_read_remaining_size (QmiMessage *self,
                                        gsize       tlv_offset,
@@ -1408,6 +1597,67 @@ __qmi_message_tlv_read_remaining_size (QmiMessage *self,
     return (GUINT16_FROM_LE (tlv->length) >= offset ? (GUINT16_FROM_LE (tlv->length) - offset) : 0);
 }
 
+gboolean
+__qmi_message_tlv_read_integer_array (QmiMessage  *self,
+                                      gsize        tlv_offset,
+                                      gsize       *offset,
+                                      guint        n_items,
+                                      guint        item_size,
+                                      QmiEndian    endian,
+                                      gpointer     out,
+                                      GError     **error)
+{
+    const guint8 *ptr;
+    gsize         len;
+    guint         i;
+
+    g_return_val_if_fail (self != NULL, FALSE);
+    g_return_val_if_fail (offset != NULL, FALSE);
+    g_return_val_if_fail (out != NULL || n_items == 0, FALSE);
+    g_return_val_if_fail (item_size == 1 || item_size == 2 || item_size == 4 || item_size == 8, FALSE);
+
+    len = (gsize) n_items * item_size;
+    if (!(ptr = tlv_error_if_read_overflow (self, tlv_offset, *offset, len, error)))
+        return FALSE;
+
+    if (len > 0)
+        memcpy (out, ptr, len);
+
+    /* Swap in place only if the wire order isn't the host one */
+    if (item_size > 1 &&
+        ((endian == QMI_ENDIAN_BIG && G_BYTE_ORDER != G_BIG_ENDIAN) ||
+         (endian == QMI_ENDIAN_LITTLE && G_BYTE_ORDER != G_LITTLE_ENDIAN))) {
+        switch (item_size) {
+        case 2: {
+            guint16 *items = out;
+
+            for (i = 0; i < n_items; i++)
+                items[i] = GUINT16_SWAP_LE_BE (items[i]);
+            break;
+        }
+        case 4: {
+            guint32 *items = out;
+
+            for (i = 0; i < n_items; i++)
+                items[i] = GUINT32_SWAP_LE_BE (items[i]);
+            break;
+        }
+        case 8: {
+            guint64 *items = out;
+
+            for (i = 0; i < n_items; i++)
+                items[i] = GUINT64_SWAP_LE_BE (items[i]);
+            break;
+        }
+        default:
+            g_assert_not_reached ();
+        }
+    }
+
+    *offset = *offset + len;
+    return TRUE;
+}
+
 /*****************************************************************************/
 
 const guint8 *
@@ -1494,31 +1744,33 @@ qmi_message_add_raw_tlv (QmiMessage *self,
 }
 
 QmiMessage *
-qmi_message_new_from_raw (GByteArray *raw,
-                          GError **error)
+__qmi_message_new_from_buffer (const guint8  *data,
+                               gsize          len,
+                               gsize         *consumed,
+                               GError       **error)
 {
     GByteArray *self;
     gsize message_len;
 
-    g_return_val_if_fail (raw != NULL, NULL);
+    g_assert (consumed != NULL);
+    *consumed = 0;
 
     /* If we didn't even read the QMUX header (comes after the 1-byte marker),
      * leave */
-    if (raw->len < (sizeof (struct qmux) + 1))
+    if (len < (sizeof (struct qmux) + 1))
         return NULL;
 
     /* We need to have read the length reported by the QMUX header (plus the
      * initial 1-byte marker) */
-    message_len = GUINT16_FROM_LE (((struct full_message *)raw->data)->qmux.length);
-    if (raw->len < (message_len + 1))
+    message_len = GUINT16_FROM_LE (((struct full_message *)data)->qmux.length);
+    if (len < (message_len + 1))
         return NULL;
 
-    /* Ok, so we should have all the data available already */
+    /* Ok, so we should have all the data available already; the caller
+     * drops the consumed bytes from its own buffer whenever it likes */
     self = g_byte_array_sized_new (message_len + 1);
-    g_byte_array_prepend (self, raw->data, message_len + 1);
-
-    /* We got a complete QMI message, remove from input buffer */
-    g_byte_array_remove_range (raw, 0, self->len);
+    g_byte_array_append (self, data, message_len + 1);
+    *consumed = self->len;
 
     /* Check input message validity as soon as we create the QmiMessage */
     if (!message_check (self, error)) {
@@ -1530,6 +1782,79 @@ qmi_message_new_from_raw (GByteArray *raw,
     return (QmiMessage *)self;
 }
 
+QmiMessage *
+__qmi_message_new_from_headroom (QmiService     service,
+                                 guint8         client_id,
+                                 guint8        *buffer,
+                                 gsize          qmi_data_len,
+                                 GError       **error)
+{
+    struct full_message *full;
+    gsize buffer_len;
+    gsize consumed;
+
+    G_STATIC_ASSERT (QMI_MESSAGE_QMUX_HEADROOM == 1 + sizeof (struct qmux));
+
+    buffer_len = QMI_MESSAGE_QMUX_HEADROOM + qmi_data_len;
+    if (buffer_len - 1 > G_MAXUINT16) {
+        g_set_error (error,
+                     QMI_CORE_ERROR,
+                     QMI_CORE_ERROR_INVALID_MESSAGE,
+                     "QMI message too long: %" G_GSIZE_FORMAT " bytes",
+                     qmi_data_len);
+        return NULL;
+    }
+
+    /* Set up fake QMUX header in the reserved headroom, so that the whole
+     * message gets copied (and validated) just once */
+    full = (struct full_message *)buffer;
+    full->marker = QMI_MESSAGE_QMUX_MARKER;
+    full->qmux.length = GUINT16_TO_LE (buffer_len - 1);
+    full->qmux.flags = 0;
+    full->qmux.service = service;
+    full->qmux.client = client_id;
+
+    return __qmi_message_new_from_buffer (buffer, buffer_len, &consumed, error);
+}
+
+QmiMessage *
+qmi_message_new_from_raw (GByteArray *raw,
+                          GError **error)
+{
+    QmiMessage *self;
+    gsize consumed;
+
+    g_return_val_if_fail (raw != NULL, NULL);
+
+    self = __qmi_message_new_from_buffer (raw->data, raw->len, &consumed, error);
+
+    /* We got a complete QMI message, remove from input buffer */
+    if (consumed > 0)
+        g_byte_array_remove_range (raw, 0, consumed);
+
+    return self;
+}
+
+void
+__qmi_message_append_tlv_printable (GString      *printable,
+                                    const gchar  *line_prefix,
+                                    guint8        type,
+                                    const guint8 *raw,
+                                    gsize         raw_length)
+{
+    g_string_append_printf (printable,
+                            "%sTLV:\n"
+                            "%s  type   = 0x%02x\n"
+                            "%s  length = %" G_GSIZE_FORMAT "\n"
+                            "%s  value  = ",
+                            line_prefix,
+                            line_prefix, type,
+                            line_prefix, raw_length,
+                            line_prefix);
+    __qmi_string_append_hex (printable, raw, raw_length, ':');
+    g_string_append_c (printable, '\n');
+}
+
 gchar *
 qmi_message_get_tlv_printable (QmiMessage *self,
                                const gchar *line_prefix,
@@ -1537,71 +1862,59 @@ qmi_message_get_tlv_printable (QmiMessage *self,
                                const guint8 *raw,
                                gsize raw_length)
 {
-    gchar *printable;
-    gchar *value_hex;
+    GString *printable;
 
     g_return_val_if_fail (self != NULL, NULL);
     g_return_val_if_fail (line_prefix != NULL, NULL);
     g_return_val_if_fail (raw != NULL, NULL);
     g_return_val_if_fail (raw_length > 0, NULL);
 
-    value_hex = __qmi_utils_str_hex (raw, raw_length, ':');
-    printable = g_strdup_printf ("%sTLV:\n"
-                                 "%s  type   = 0x%02x\n"
-                                 "%s  length = %" G_GSIZE_FORMAT "\n"
-                                 "%s  value  = %s\n",
-                                 line_prefix,
-                                 line_prefix, type,
-                                 line_prefix, raw_length,
-                                 line_prefix, value_hex);
-    g_free (value_hex);
-    return printable;
+    printable = g_string_new ("");
+    __qmi_message_append_tlv_printable (printable, line_prefix, type, raw, raw_length);
+    return g_string_free (printable, FALSE);
 }
 
-static gchar *
-get_generic_printable (QmiMessage *self,
-                       const gchar *line_prefix)
+void
+__qmi_message_printer_flush (QmiMessagePrinter *printer)
 {
-    GString *printable;
-    struct tlv *tlv;
+    if (!printer->func || !printer->buffer->len)
+        return;
 
-    printable = g_string_new ("");
+    printer->func (printer->buffer->str, printer->buffer->len, printer->user_data);
+    g_string_truncate (printer->buffer, 0);
+}
 
-    g_string_append_printf (printable,
+static void
+print_generic (QmiMessage        *self,
+               const gchar       *line_prefix,
+               QmiMessagePrinter *printer)
+{
+    struct tlv *tlv;
+
+    g_string_append_printf (printer->buffer,
                             "%s  message     = (0x%04x)\n",
                             line_prefix, qmi_message_get_message_id (self));
 
     for (tlv = qmi_tlv_first (self); tlv; tlv = qmi_tlv_next (self, tlv)) {
-        gchar *printable_tlv;
-
-        printable_tlv = qmi_message_get_tlv_printable (self,
-                                                       line_prefix,
-                                                       tlv->type,
-                                                       tlv->value,
-                                                       GUINT16_FROM_LE (tlv->length));
-        g_string_append (printable, printable_tlv);
-        g_free (printable_tlv);
+        __qmi_message_append_tlv_printable (printer->buffer,
+                                            line_prefix,
+                                            tlv->type,
+                                            tlv->value,
+                                            GUINT16_FROM_LE (tlv->length));
+        __qmi_message_printer_flush (printer);
     }
-
-    return g_string_free (printable, FALSE);
 }
 
-gchar *
-qmi_message_get_printable_full (QmiMessage        *self,
-                                QmiMessageContext *context,
-                                const gchar       *line_prefix)
+static void
+print_message (QmiMessage        *self,
+               QmiMessageContext *context,
+               const gchar       *line_prefix,
+               QmiMessagePrinter *printer)
 {
-    GString *printable;
     gchar *qmi_flags_str;
-    gchar *contents;
-
-    g_return_val_if_fail (self != NULL, NULL);
-
-    if (!line_prefix)
-        line_prefix = "";
+    gboolean printed = FALSE;
 
-    printable = g_string_new ("");
-    g_string_append_printf (printable,
+    g_string_append_printf (printer->buffer,
                             "%sQMUX:\n"
                             "%s  length  = %u\n"
                             "%s  flags   = 0x%02x\n"
@@ -1618,7 +1931,7 @@ qmi_message_get_printable_full (QmiMessage        *self,
     else
         qmi_flags_str = qmi_service_flag_build_string_from_mask (get_qmi_flags (self));
 
-    g_string_append_printf (printable,
+    g_string_append_printf (printer->buffer,
                             "%sQMI:\n"
                             "%s  flags       = \"%s\"\n"
                             "%s  transaction = %u\n"
@@ -1629,91 +1942,90 @@ qmi_message_get_printable_full (QmiMessage        *self,
                             line_prefix, get_all_tlvs_length (self));
     g_free (qmi_flags_str);
 
-    contents = NULL;
     switch (qmi_message_get_service (self)) {
     case QMI_SERVICE_CTL:
 #if defined HAVE_QMI_SERVICE_CTL
-        contents = __qmi_message_ctl_get_printable (self, context, line_prefix);
+        printed = __qmi_message_ctl_print (self, context, line_prefix, printer);
 #endif
         break;
     case QMI_SERVICE_DMS:
 #if defined HAVE_QMI_SERVICE_DMS
-        contents = __qmi_message_dms_get_printable (self, context, line_prefix);
+        printed = __qmi_message_dms_print (self, context, line_prefix, printer);
 #endif
         break;
     case QMI_SERVICE_WDS:
 #if defined HAVE_QMI_SERVICE_WDS
-        contents = __qmi_message_wds_get_printable (self, context, line_prefix);
+        printed = __qmi_message_wds_print (self, context, line_prefix, printer);
 #endif
         break;
     case QMI_SERVICE_NAS:
 #if defined HAVE_QMI_SERVICE_NAS
-        contents = __qmi_message_nas_get_printable (self, context, line_prefix);
+        printed = __qmi_message_nas_print (self, context, line_prefix, printer);
 #endif
         break;
     case QMI_SERVICE_WMS:
 #if defined HAVE_QMI_SERVICE_WMS
-        contents = __qmi_message_wms_get_printable (self, context, line_prefix);
+        printed = __qmi_message_wms_print (self, context, line_prefix, printer);
 #endif
         break;
     case QMI_SERVICE_PDC:
 #if defined HAVE_QMI_SERVICE_PDC
-        contents = __qmi_message_pdc_get_printable (self, context, line_prefix);
+        printed = __qmi_message_pdc_print (self, context, line_prefix, printer);
 #endif
         break;
     case QMI_SERVICE_PDS:
 #if defined HAVE_QMI_SERVICE_PDS
-        contents = __qmi_message_pds_get_printable (self, context, line_prefix);
+        printed = __qmi_message_pds_print (self, context, line_prefix, printer);
 #endif
         break;
     case QMI_SERVICE_PBM:
 #if defined HAVE_QMI_SERVICE_PBM
-        contents = __qmi_message_pbm_get_printable (self, context, line_prefix);
+        printed = __qmi_message_pbm_print (self, context, line_prefix, printer);
 #endif
         break;
     case QMI_SERVICE_UIM:
 #if defined HAVE_QMI_SERVICE_UIM
-        contents = __qmi_message_uim_get_printable (self, context, line_prefix);
+        printed = __qmi_message_uim_print (self, context, line_prefix, printer);
 #endif
         break;
     case QMI_SERVICE_OMA:
 #if defined HAVE_QMI_SERVICE_OMA
-        contents = __qmi_message_oma_get_printable (self, context, line_prefix);
+        printed = __qmi_message_oma_print (self, context, line_prefix, printer);
 #endif
         break;
     case QMI_SERVICE_GAS:
 #if defined HAVE_QMI_SERVICE_GAS
-        contents = __qmi_message_gas_get_printable (self, context, line_prefix);
+        printed = __qmi_message_gas_print (self, context, line_prefix, printer);
 #endif
         break;
     case QMI_SERVICE_GMS:
 #if defined HAVE_QMI_SERVICE_GMS
-        contents = __qmi_message_gms_get_printable (self, context, line_prefix);
+        printed = __qmi_message_gms_print (self, context, line_prefix, printer);
 #endif
         break;
     case QMI_SERVICE_WDA:
 #if defined HAVE_QMI_SERVICE_WDA
-        contents = __qmi_message_wda_get_printable (self, context, line_prefix);
+        printed = __qmi_message_wda_print (self, context, line_prefix, printer);
 #endif
         break;
     case QMI_SERVICE_VOICE:
 #if defined HAVE_QMI_SERVICE_VOICE
-        contents = __qmi_message_voice_get_printable (self, context, line_prefix);
+        printed = __qmi_message_voice_print (self, context, line_prefix, printer);
 #endif
         break;
     case QMI_SERVICE_LOC:
 #if defined HAVE_QMI_SERVICE_LOC
-        contents = __qmi_message_loc_get_printable (self, context, line_prefix);
+        printed = __qmi_message_loc_print (self, context, line_prefix, printer);
 #endif
         break;
     case QMI_SERVICE_QOS:
 #if defined HAVE_QMI_SERVICE_QOS
-        contents = __qmi_message_qos_get_printable (self, context, line_prefix);
+        printed = __qmi_message_qos_print (self, context, line_prefix, printer);
 #endif
         break;
     case QMI_SERVICE_DSD:
 #if defined HAVE_QMI_SERVICE_DSD
-        contents = __qmi_message_dsd_get_printable (self, context, line_prefix);
+        printed = __qmi_message_dsd_print (self, context, line_prefix, printer);
 #endif
         break;
 
@@ -1755,12 +2067,54 @@ qmi_message_get_printable_full (QmiMessage        *self,
         break;
     }
 
-    if (!contents)
-        contents = get_generic_printable (self, line_prefix);
-    g_string_append (printable, contents);
-    g_free (contents);
+    if (!printed)
+        print_generic (self, line_prefix, printer);
+    __qmi_message_printer_flush (printer);
+}
 
-    return g_string_free (printable, FALSE);
+gchar *
+qmi_message_get_printable_full (QmiMessage        *self,
+                                QmiMessageContext *context,
+                                const gchar       *line_prefix)
+{
+    QmiMessagePrinter printer = { NULL, NULL, NULL };
+
+    g_return_val_if_fail (self != NULL, NULL);
+
+    if (!line_prefix)
+        line_prefix = "";
+
+    /* Without a print function, the whole printable is built in the buffer */
+    printer.buffer = g_string_sized_new (1024);
+    print_message (self, context, line_prefix, &printer);
+    return g_string_free (printer.buffer, FALSE);
+}
+
+void
+qmi_message_print_full (QmiMessage        *self,
+                        QmiMessageContext *context,
+                        const gchar       *line_prefix,
+                        GString           *buffer,
+                        QmiMessagePrintFn  func,
+                        gpointer           user_data)
+{
+    QmiMessagePrinter printer;
+
+    g_return_if_fail (self != NULL);
+    g_return_if_fail (func != NULL);
+
+    if (!line_prefix)
+        line_prefix = "";
+
+    printer.buffer = buffer ? buffer : g_string_sized_new (1024);
+    printer.func = func;
+    printer.user_data = user_data;
+
+    g_string_truncate (printer.buffer, 0);
+    print_message (self, context, line_prefix, &printer);
+
+    if (!buffer)
+        g_string_free (printer.buffer, TRUE);
 }
 
 gboolean
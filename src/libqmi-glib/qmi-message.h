@@ -96,6 +96,32 @@ QmiMessage *qmi_message_new (QmiService service,
                              guint16    transaction_id,
                              guint16    message_id);
 
+/**
+ * qmi_message_new_sized:
+ * @service: a #QmiService
+ * @client_id: client ID of the originating control point.
+ * @transaction_id: transaction ID.
+ * @message_id: message ID.
+ * @tlvs_size: number of bytes to preallocate for TLVs.
+ *
+ * Create a new #QmiMessage with the specified parameters, like
+ * qmi_message_new(), but with enough space already allocated for @tlvs_size
+ * bytes of TLVs, so that the message buffer doesn't need to be reallocated
+ * while they're written.
+ *
+ * A message may be sent multiple times, updating its transaction ID with
+ * qmi_message_set_transaction_id() before each one.
+ *
+ * Returns: (transfer full): a newly created #QmiMessage. The returned value should be freed with qmi_message_unref().
+ *
+ * Since: 1.28
+ */
+QmiMessage *qmi_message_new_sized (QmiService service,
+                                   guint8     client_id,
+                                   guint16    transaction_id,
+                                   guint16    message_id,
+                                   gsize      tlvs_size);
+
 /**
  * qmi_message_new_from_raw:
  * @raw: (inout): raw data buffer.
@@ -112,6 +138,34 @@ QmiMessage *qmi_message_new (QmiService service,
 QmiMessage *qmi_message_new_from_raw (GByteArray  *raw,
                                       GError     **error);
 
+#if defined (LIBQMI_GLIB_COMPILATION)
+G_GNUC_INTERNAL
+QmiMessage *__qmi_message_new_from_buffer (const guint8  *data,
+                                           gsize          len,
+                                           gsize         *consumed,
+                                           GError       **error);
+
+/* Used by the proxy to hand out the same response to several clients */
+G_GNUC_INTERNAL
+void __qmi_message_set_client_id (QmiMessage *self,
+                                  guint8      client_id);
+
+/* Copy of a message, which is valid already and so isn't checked again */
+G_GNUC_INTERNAL
+QmiMessage *__qmi_message_copy (QmiMessage *self);
+
+/* Bytes a caller must reserve in front of the QMI data it passes to
+ * __qmi_message_new_from_headroom(): the QMUX marker and header */
+#define QMI_MESSAGE_QMUX_HEADROOM 6
+
+G_GNUC_INTERNAL
+QmiMessage *__qmi_message_new_from_headroom (QmiService     service,
+                                             guint8         client_id,
+                                             guint8        *buffer,
+                                             gsize          qmi_data_len,
+                                             GError       **error);
+#endif
+
 /**
  * qmi_message_new_from_data:
  * @service: a #QmiService
@@ -938,6 +992,70 @@ G_GNUC_INTERNAL
 guint16 __qmi_message_tlv_read_remaining_size (QmiMessage  *self,
                                                gsize        tlv_offset,
                                                gsize        offset);
+
+/* Reads @n_items integers of @item_size bytes each (1, 2, 4 or 8) into @out,
+ * in host byte order, with a single bounds check. */
+G_GNUC_INTERNAL
+gboolean __qmi_message_tlv_read_integer_array (QmiMessage  *self,
+                                               gsize        tlv_offset,
+                                               gsize       *offset,
+                                               guint        n_items,
+                                               guint        item_size,
+                                               QmiEndian    endian,
+                                               gpointer     out,
+                                               GError     **error);
+#endif
+
+#if defined (LIBQMI_GLIB_COMPILATION)
+
+/* Offset of the first TLV of each type in a message, or 0 if not found. The
+ * QMUX length is 16-bit, so any TLV offset fits. */
+typedef struct {
+    guint16 offsets[G_MAXUINT8 + 1];
+} QmiMessageTlvIndex;
+
+/* Fills and returns @tlv_index, walking the TLVs of the message once */
+G_GNUC_INTERNAL
+const QmiMessageTlvIndex *
+      __qmi_message_tlv_index_get       (QmiMessage                *self,
+                                         QmiMessageTlvIndex        *tlv_index);
+G_GNUC_INTERNAL
+gsize __qmi_message_tlv_index_read_init (QmiMessage                *self,
+                                         const QmiMessageTlvIndex  *tlv_index,
+                                         guint8                     type,
+                                         guint16                   *out_tlv_length,
+                                         GError                   **error);
+
+/* Bump allocator for the strings of a parsed output, carved out of the same
+ * allocation as the output struct so that a single free releases both. */
+typedef struct {
+    gchar *next;
+    gchar *end;
+} QmiMessageArena;
+
+/* Arena bytes enough for every string read from the TLV of the given type,
+ * or 0 if the message has no such TLV. */
+G_GNUC_INTERNAL
+gsize    __qmi_message_tlv_index_arena_size         (QmiMessage                *self,
+                                                     const QmiMessageTlvIndex  *tlv_index,
+                                                     guint8                     type);
+G_GNUC_INTERNAL
+gboolean __qmi_message_tlv_read_string_in_arena     (QmiMessage                *self,
+                                                     gsize                      tlv_offset,
+                                                     gsize                     *offset,
+                                                     guint8                     n_size_prefix_bytes,
+                                                     guint16                    max_size,
+                                                     QmiMessageArena           *arena,
+                                                     gchar                    **out,
+                                                     GError                   **error);
+G_GNUC_INTERNAL
+gboolean __qmi_message_tlv_read_fixed_size_string_in_arena (QmiMessage         *self,
+                                                            gsize               tlv_offset,
+                                                            gsize              *offset,
+                                                            guint16             string_length,
+                                                            QmiMessageArena    *arena,
+                                                            gchar             **out,
+                                                            GError            **error);
 #endif
 
 /*****************************************************************************/
@@ -1058,6 +1176,72 @@ gchar *qmi_message_get_printable_full (QmiMessage        *self,
                                        QmiMessageContext *context,
                                        const gchar       *line_prefix);
 
+/**
+ * QmiMessagePrintFn:
+ * @chunk: the next part of the printable representation of the message.
+ * @chunk_length: length of @chunk, in bytes, not including the NUL terminator.
+ * @user_data: user data.
+ *
+ * Callback type to use when printing a message with qmi_message_print_full().
+ *
+ * @chunk is only valid during the call. It always ends at a line boundary,
+ * usually right after a whole TLV.
+ *
+ * Since: 1.28
+ */
+typedef void (* QmiMessagePrintFn) (const gchar *chunk,
+                                    gsize        chunk_length,
+                                    gpointer     user_data);
+
+/**
+ * qmi_message_print_full:
+ * @self: a #QmiMessage.
+ * @context: a #QmiMessageContext.
+ * @line_prefix: prefix string to use in each new generated line.
+ * @buffer: (nullable): a #GString to print into, or %NULL.
+ * @func: (scope call): the function to call with each printed chunk.
+ * @user_data: (closure func): user data to pass to the function.
+ *
+ * Prints the same contents as qmi_message_get_printable_full(), but instead of
+ * building the whole string, hands them over to @func as they are printed,
+ * one TLV at a time.
+ *
+ * Each chunk is printed into @buffer, which is emptied after every call to
+ * @func. Passing the same @buffer when printing many messages avoids
+ * allocating a new one each time. If %NULL, a temporary one is used.
+ *
+ * Since: 1.28
+ */
+void qmi_message_print_full (QmiMessage        *self,
+                             QmiMessageContext *context,
+                             const gchar       *line_prefix,
+                             GString           *buffer,
+                             QmiMessagePrintFn  func,
+                             gpointer           user_data);
+
+#if defined (LIBQMI_GLIB_COMPILATION)
+
+/* Where the printable support writes messages to; @func is NULL when the
+ * whole printable string is being built in @buffer */
+typedef struct {
+    GString           *buffer;
+    QmiMessagePrintFn  func;
+    gpointer           user_data;
+} QmiMessagePrinter;
+
+/* Hands over the contents of the buffer printed so far, if any */
+G_GNUC_INTERNAL
+void __qmi_message_printer_flush (QmiMessagePrinter *printer);
+
+/* Same as qmi_message_get_tlv_printable(), appending to @printable */
+G_GNUC_INTERNAL
+void __qmi_message_append_tlv_printable (GString      *printable,
+                                         const gchar  *line_prefix,
+                                         guint8        type,
+                                         const guint8 *raw,
+                                         gsize         raw_length);
+#endif
+
 /**
  * qmi_message_get_tlv_printable:
  * @self: a #QmiMessage.
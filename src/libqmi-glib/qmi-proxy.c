@@ -25,10 +25,13 @@
 #include <ctype.h>
 #include <sys/file.h>
 #include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
 #include <errno.h>
 
 #include <glib.h>
 #include <glib/gstdio.h>
+#include <glib-unix.h>
 #include <gio/gunixsocketaddress.h>
 
 #include "config.h"
@@ -38,7 +41,9 @@
 #include "qmi-ctl.h"
 #include "qmi-utils-private.h"
 #include "qmi-proxy.h"
+#include "qmi-shm-channel.h"
 #include "qmi-version.h"
+#include "qmi-worker.h"
 
 #if QMI_QRTR_SUPPORTED
 # include "libqrtr-glib.h"
@@ -46,15 +51,45 @@
 
 #define BUFFER_SIZE 512
 
+/* Number of queued messages written to a client socket in one go */
+#define OUTPUT_IOV_MAX 16
+
+/* Indications are dropped for a client with more than this many bytes
+ * queued but not yet written to its socket */
+#ifndef QMI_PROXY_CLIENT_OUTPUT_HIGH_WATER
+# define QMI_PROXY_CLIENT_OUTPUT_HIGH_WATER (256 * 1024)
+#endif
+
+/* Seconds the authorization decision for a given user is cached, so that
+ * users opening many short-lived connections don't go through a user
+ * database lookup for every one of them */
+#ifndef QMI_PROXY_AUTH_CACHE_TTL
+# define QMI_PROXY_AUTH_CACHE_TTL 10
+#endif
+
+/* CIDs of each service allocated ahead of time for each device, once a
+ * client has asked for one of that service */
+#ifndef QMI_PROXY_CID_POOL_SIZE
+# define QMI_PROXY_CID_POOL_SIZE 1
+#endif
+
 #define QMI_MESSAGE_OUTPUT_TLV_RESULT 0x02
+#define QMI_MESSAGE_INPUT_TLV_SERVICE 0x01
 #define QMI_MESSAGE_OUTPUT_TLV_ALLOCATION_INFO 0x01
 #define QMI_MESSAGE_CTL_ALLOCATE_CID 0x0022
 
 #define QMI_MESSAGE_INPUT_TLV_RELEASE_INFO 0x01
+#define QMI_MESSAGE_OUTPUT_TLV_RELEASE_INFO 0x01
 #define QMI_MESSAGE_CTL_RELEASE_CID 0x0023
 
+#define QMI_MESSAGE_CTL_GET_VERSION_INFO 0x0021
+
+#define QMI_MESSAGE_CTL_SYNC 0x0027
+
 #define QMI_MESSAGE_CTL_INTERNAL_PROXY_OPEN 0xFF00
 #define QMI_MESSAGE_CTL_INTERNAL_PROXY_OPEN_INPUT_TLV_DEVICE_PATH 0x01
+#define QMI_MESSAGE_CTL_INTERNAL_PROXY_OPEN_INPUT_TLV_TRANSPORT 0x10
+#define QMI_MESSAGE_CTL_INTERNAL_PROXY_OPEN_OUTPUT_TLV_TRANSPORT 0x10
 
 G_DEFINE_TYPE (QmiProxy, qmi_proxy, G_TYPE_OBJECT)
 
@@ -80,16 +115,86 @@ struct _QmiProxyPrivate {
      * application (e.g. they were allocated by a client application but
      * then not explicitly released). */
     GArray *disowned_qmi_client_info_array;
+
+    /* Map of (device, service, CID) -> GPtrArray of subscribed clients (not
+     * full refs); the broadcast CID maps to the clients with any CID of the
+     * service, once per CID */
+    GHashTable *subscriptions;
+
+    /* Map of (device, request) -> GArray of CoalesceWaiter, with the
+     * identical read-only requests waiting for one already in flight */
+    gboolean    coalesce_requests;
+    GHashTable *coalesced;
+
+    /* Seconds an unused device stays open, waiting for the next client */
+    guint       device_linger_time;
+
+    /* Set of (real) paths of the devices that are never closed */
+    GHashTable *persistent_devices;
+
+    /* Map of uid -> AuthEntry, with the latest authorization decisions */
+    GHashTable *auth_cache;
+    guint       n_auth_lookups;
+
+    /* Context the proxy was created in, where property changes are notified */
+    GMainContext *context;
+
+    /* Map of (real) device path -> QmiWorker running the device and all the
+     * clients using it, if devices run in their own thread */
+    gboolean    device_threads;
+    GHashTable *workers;
+
+    /* Taken by every callback and public method; with device threads, it
+     * serializes access to the clients, devices and tables above */
+    GRecMutex   lock;
 };
 
 /*****************************************************************************/
 
+static void
+proxy_lock (QmiProxy *self)
+{
+    g_rec_mutex_lock (&self->priv->lock);
+}
+
+static void
+proxy_unlock (QmiProxy *self)
+{
+    g_rec_mutex_unlock (&self->priv->lock);
+}
+
+static gboolean
+notify_n_clients_cb (QmiProxy *self)
+{
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_CLIENTS]);
+    return G_SOURCE_REMOVE;
+}
+
+/* Right away if running in the context of the proxy, as always without
+ * device threads */
+static void
+notify_n_clients (QmiProxy *self)
+{
+    g_main_context_invoke_full (self->priv->context,
+                                G_PRIORITY_DEFAULT,
+                                (GSourceFunc)notify_n_clients_cb,
+                                g_object_ref (self),
+                                (GDestroyNotify)g_object_unref);
+}
+
+/*****************************************************************************/
+
 guint
 qmi_proxy_get_n_clients (QmiProxy *self)
 {
+    guint n_clients;
+
     g_return_val_if_fail (QMI_IS_PROXY (self), 0);
 
-    return g_list_length (self->priv->clients);
+    proxy_lock (self);
+    n_clients = g_list_length (self->priv->clients);
+    proxy_unlock (self);
+    return n_clients;
 }
 
 /*****************************************************************************/
@@ -99,6 +204,23 @@ typedef struct {
     guint8     cid;
 } QmiClientInfo;
 
+/* Time spent by the proxy itself forwarding a request and its response,
+ * leaving out the time waiting for the device */
+typedef struct {
+    guint64 n;
+    guint64 total_us;
+    guint64 max_us;
+} ForwardingTime;
+
+static void
+forwarding_time_add (ForwardingTime *forwarding,
+                     gint64          us)
+{
+    forwarding->n++;
+    forwarding->total_us += us;
+    forwarding->max_us = MAX (forwarding->max_us, (guint64)us);
+}
+
 typedef struct {
     volatile gint ref_count;
 
@@ -109,15 +231,43 @@ typedef struct {
     GSource           *connection_readable_source;
     GByteArray        *buffer;
 
+    /* Messages not yet fully written to the socket, oldest first; the head
+     * one is written from output_offset */
+    GQueue            *output_queue;
+    gsize              output_offset;
+    GSource           *connection_writable_source;
+
+    /* Output counters */
+    gsize              output_queued;       /* bytes not yet written */
+    guint              dropped_indications; /* over the high-water mark */
+
+    /* Metrics */
+    guint              requests_in_flight;
+    volatile gint      forwarded_indications;
+    ForwardingTime     forwarding;
+
+    /* Shared memory transport, replaces the socket for messages once
+     * negotiated in the internal proxy open */
+    gboolean           shm_requested;
+    QmiShmChannel     *shm;
+    GSource           *shm_readable_source;
+    GSource           *shm_writable_source;
+
     /* QMI device associated to connection */
     QmiDevice  *device;
     QmiMessage *internal_proxy_open_request;
     GArray     *qmi_client_info_array;
-    guint       indication_id;
     guint       device_removed_id;
+
+    /* Worker the client was handed off to, along with its device; not a
+     * ref, owned by the proxy */
+    QmiWorker  *worker;
 } Client;
 
 static gboolean connection_readable_cb (GSocket *socket, GIOCondition condition, Client *client);
+static gboolean connection_writable_cb (GSocket *socket, GIOCondition condition, Client *client);
+static gboolean shm_readable_cb        (gint fd, GIOCondition condition, Client *client);
+static gboolean shm_writable_cb        (gint fd, GIOCondition condition, Client *client);
 static void     track_client           (QmiProxy *self, Client *client);
 static void     untrack_client         (QmiProxy *self, Client *client);
 
@@ -130,8 +280,36 @@ client_disconnect (Client *client)
         client->connection_readable_source = 0;
     }
 
+    if (client->connection_writable_source) {
+        g_source_destroy (client->connection_writable_source);
+        g_source_unref (client->connection_writable_source);
+        client->connection_writable_source = NULL;
+    }
+
+    if (client->shm_readable_source) {
+        g_source_destroy (client->shm_readable_source);
+        g_clear_pointer (&client->shm_readable_source, g_source_unref);
+    }
+    if (client->shm_writable_source) {
+        g_source_destroy (client->shm_writable_source);
+        g_clear_pointer (&client->shm_writable_source, g_source_unref);
+    }
+    g_clear_pointer (&client->shm, __qmi_shm_channel_free);
+
+    if (client->output_queue) {
+        QmiMessage *message;
+
+        while ((message = g_queue_pop_head (client->output_queue)) != NULL)
+            qmi_message_unref (message);
+    }
+
     if (client->connection) {
-        g_debug ("Client (%d) connection closed...", g_socket_get_fd (g_socket_connection_get_socket (client->connection)));
+        g_debug ("Client (%d) connection closed (%" G_GSIZE_FORMAT " bytes unsent, %u indications dropped)...",
+                 g_socket_get_fd (g_socket_connection_get_socket (client->connection)),
+                 client->output_queued,
+                 client->dropped_indications);
+        client->output_queued = 0;
+        client->output_offset = 0;
         g_output_stream_close (g_io_stream_get_output_stream (G_IO_STREAM (client->connection)), NULL, NULL);
         g_object_unref (client->connection);
         client->connection = NULL;
@@ -146,8 +324,6 @@ client_unref (Client *client)
         client_disconnect (client);
 
         if (client->device) {
-            if (g_signal_handler_is_connected (client->device, client->indication_id))
-                g_signal_handler_disconnect (client->device, client->indication_id);
             if (g_signal_handler_is_connected (client->device, client->device_removed_id))
                 g_signal_handler_disconnect (client->device, client->device_removed_id);
             g_object_unref (client->device);
@@ -156,6 +332,7 @@ client_unref (Client *client)
         g_clear_pointer (&client->buffer,                      g_byte_array_unref);
         g_clear_pointer (&client->internal_proxy_open_request, g_byte_array_unref);
         g_clear_pointer (&client->qmi_client_info_array,       g_array_unref);
+        g_clear_pointer (&client->output_queue,                g_queue_free);
 
         g_slice_free (Client, client);
     }
@@ -168,6 +345,157 @@ client_ref (Client *client)
     return client;
 }
 
+/* Start reading from the client socket in the thread-default context */
+static void
+client_watch_connection (Client *client)
+{
+    client->connection_readable_source = g_socket_create_source (g_socket_connection_get_socket (client->connection),
+                                                                 G_IO_IN | G_IO_PRI | G_IO_ERR | G_IO_HUP,
+                                                                 NULL);
+    g_source_set_callback (client->connection_readable_source,
+                           (GSourceFunc)connection_readable_cb,
+                           client,
+                           NULL);
+    g_source_attach (client->connection_readable_source, g_main_context_get_thread_default ());
+}
+
+/* Whether the client was handed off to a worker and is no longer to be
+ * processed in the running thread */
+static gboolean
+client_handed_off (Client *client)
+{
+    return (client->worker && !g_main_context_is_owner (__qmi_worker_peek_context (client->worker)));
+}
+
+static gboolean
+client_flush_output_shm (Client  *client,
+                         GError **error)
+{
+    while (!g_queue_is_empty (client->output_queue)) {
+        QmiMessage *message;
+        GError     *inner_error = NULL;
+
+        /* Whole messages only, the head one was never partially written */
+        message = g_queue_peek_head (client->output_queue);
+        if (!__qmi_shm_channel_write (client->shm,
+                                      QMI_SHM_RING_PROXY_TO_CLIENT,
+                                      message->data,
+                                      message->len,
+                                      &inner_error)) {
+            if (g_error_matches (inner_error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK)) {
+                g_error_free (inner_error);
+                break;
+            }
+            g_propagate_prefixed_error (error, inner_error, "Cannot send message to client: ");
+            return FALSE;
+        }
+        client->output_queued -= message->len;
+        qmi_message_unref (g_queue_pop_head (client->output_queue));
+    }
+
+    /* Keep on writing once the client makes room, if anything is left */
+    if (!g_queue_is_empty (client->output_queue)) {
+        if (!client->shm_writable_source) {
+            client->shm_writable_source = g_unix_fd_source_new (__qmi_shm_channel_get_space_fd (client->shm, QMI_SHM_RING_PROXY_TO_CLIENT),
+                                                                G_IO_IN);
+            g_source_set_callback (client->shm_writable_source,
+                                   (GSourceFunc)shm_writable_cb,
+                                   client,
+                                   NULL);
+            g_source_attach (client->shm_writable_source, g_main_context_get_thread_default ());
+        }
+    } else if (client->shm_writable_source) {
+        g_source_destroy (client->shm_writable_source);
+        g_clear_pointer (&client->shm_writable_source, g_source_unref);
+    }
+
+    return TRUE;
+}
+
+static gboolean
+client_flush_output (Client  *client,
+                     GError **error)
+{
+    gint fd;
+
+    if (client->shm)
+        return client_flush_output_shm (client, error);
+
+    fd = g_socket_get_fd (g_socket_connection_get_socket (client->connection));
+
+    while (!g_queue_is_empty (client->output_queue)) {
+        struct iovec iov[OUTPUT_IOV_MAX];
+        struct msghdr msg;
+        GList *l;
+        gsize offset;
+        guint n;
+        gssize r;
+
+        /* Scatter write as many queued messages as possible; the socket is
+         * non-blocking, so this never stalls the proxy */
+        offset = client->output_offset;
+        for (l = client->output_queue->head, n = 0; l && n < OUTPUT_IOV_MAX; l = g_list_next (l), n++) {
+            GByteArray *raw = l->data;
+
+            iov[n].iov_base = raw->data + offset;
+            iov[n].iov_len = raw->len - offset;
+            offset = 0;
+        }
+
+        memset (&msg, 0, sizeof (msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = n;
+        r = sendmsg (fd, &msg, MSG_NOSIGNAL);
+        if (r < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+            g_set_error (error,
+                         QMI_CORE_ERROR,
+                         QMI_CORE_ERROR_FAILED,
+                         "Cannot send message to client: %s",
+                         g_strerror (errno));
+            return FALSE;
+        }
+
+        /* Release the messages written completely */
+        client->output_queued -= r;
+        while (r > 0) {
+            GByteArray *raw = g_queue_peek_head (client->output_queue);
+            gsize left = raw->len - client->output_offset;
+
+            if ((gsize)r < left) {
+                client->output_offset += r;
+                break;
+            }
+            r -= left;
+            client->output_offset = 0;
+            qmi_message_unref (g_queue_pop_head (client->output_queue));
+        }
+    }
+
+    /* Keep on writing once the client reads, if anything is left */
+    if (!g_queue_is_empty (client->output_queue)) {
+        if (!client->connection_writable_source) {
+            client->connection_writable_source = g_socket_create_source (g_socket_connection_get_socket (client->connection),
+                                                                         G_IO_OUT | G_IO_ERR | G_IO_HUP,
+                                                                         NULL);
+            g_source_set_callback (client->connection_writable_source,
+                                   (GSourceFunc)connection_writable_cb,
+                                   client,
+                                   NULL);
+            g_source_attach (client->connection_writable_source, g_main_context_get_thread_default ());
+        }
+    } else if (client->connection_writable_source) {
+        g_source_destroy (client->connection_writable_source);
+        g_source_unref (client->connection_writable_source);
+        client->connection_writable_source = NULL;
+    }
+
+    return TRUE;
+}
+
 static gboolean
 client_send_message (Client      *client,
                      QmiMessage  *message,
@@ -182,17 +510,227 @@ client_send_message (Client      *client,
     }
 
     g_debug ("Client (%d) TX: %u bytes", g_socket_get_fd (g_socket_connection_get_socket (client->connection)), message->len);
-    if (!g_output_stream_write_all (g_io_stream_get_output_stream (G_IO_STREAM (client->connection)),
-                                    message->data,
-                                    message->len,
-                                    NULL, /* bytes_written */
-                                    NULL, /* cancellable */
-                                    error)) {
-        g_prefix_error (error, "Cannot send message to client: ");
-        return FALSE;
+    g_queue_push_tail (client->output_queue, qmi_message_ref (message));
+    client->output_queued += message->len;
+
+    return client_flush_output (client, error);
+}
+
+static gboolean
+connection_writable_cb (GSocket *socket,
+                        GIOCondition condition,
+                        Client *client)
+{
+    QmiProxy *self = client->proxy;
+    GError   *error = NULL;
+    gboolean  keep;
+
+    proxy_lock (self);
+    if (!client_flush_output (client, &error)) {
+        g_warning ("couldn't write to client: %s", error->message);
+        g_error_free (error);
+        untrack_client (self, client);
+        keep = FALSE;
+    } else {
+        /* The source is removed once the whole queue is written */
+        keep = client->connection_writable_source ? TRUE : FALSE;
+    }
+    proxy_unlock (self);
+
+    return keep;
+}
+
+static gboolean
+shm_writable_cb (gint fd,
+                 GIOCondition condition,
+                 Client *client)
+{
+    QmiProxy *self = client->proxy;
+    GError   *error = NULL;
+    gboolean  keep;
+
+    __qmi_shm_channel_ack (fd);
+
+    proxy_lock (self);
+    if (!client_flush_output (client, &error)) {
+        g_warning ("couldn't write to client: %s", error->message);
+        g_error_free (error);
+        untrack_client (self, client);
+        keep = FALSE;
+    } else {
+        /* The source is removed once the whole queue is written */
+        keep = client->shm_writable_source ? TRUE : FALSE;
+    }
+    proxy_unlock (self);
+
+    return keep;
+}
+
+static gboolean
+client_send_shm_open_response (Client         *client,
+                               QmiMessage     *response,
+                               QmiShmChannel  *shm,
+                               GError        **error)
+{
+    union {
+        struct cmsghdr align;
+        gchar          buffer[CMSG_SPACE (sizeof (gint) * QMI_SHM_CHANNEL_N_FDS)];
+    } control;
+    struct cmsghdr *cmsg;
+    struct msghdr   msg;
+    struct iovec    iov;
+    gsize           init_offset;
+    gssize          r;
+
+    /* The response is the first message sent to the client, so it can carry
+     * the descriptors of the channel directly */
+    if (!g_queue_is_empty (client->output_queue)) {
+        g_set_error (error,
+                     QMI_CORE_ERROR,
+                     QMI_CORE_ERROR_WRONG_STATE,
+                     "Cannot send proxy open response: output pending");
+        goto failed;
+    }
+
+    if (((init_offset = qmi_message_tlv_write_init (response, QMI_MESSAGE_CTL_INTERNAL_PROXY_OPEN_OUTPUT_TLV_TRANSPORT, error)) == 0) ||
+        !qmi_message_tlv_write_guint8 (response, QMI_PROXY_TRANSPORT_SHM, error) ||
+        !qmi_message_tlv_write_complete (response, init_offset, error))
+        goto failed;
+
+    iov.iov_base = response->data;
+    iov.iov_len = response->len;
+    memset (&msg, 0, sizeof (msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buffer;
+    msg.msg_controllen = sizeof (control.buffer);
+    cmsg = CMSG_FIRSTHDR (&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN (sizeof (gint) * QMI_SHM_CHANNEL_N_FDS);
+    memcpy (CMSG_DATA (cmsg), __qmi_shm_channel_get_fds (shm), sizeof (gint) * QMI_SHM_CHANNEL_N_FDS);
+
+    do {
+        r = sendmsg (g_socket_get_fd (g_socket_connection_get_socket (client->connection)), &msg, MSG_NOSIGNAL);
+    } while (r < 0 && errno == EINTR);
+    if (r != (gssize)response->len) {
+        g_set_error (error,
+                     QMI_CORE_ERROR,
+                     QMI_CORE_ERROR_FAILED,
+                     "Cannot send proxy open response to client: %s",
+                     r < 0 ? g_strerror (errno) : "short write");
+        goto failed;
     }
 
+    /* From now on, messages go through the channel */
+    client->shm = shm;
+    client->shm_readable_source = g_unix_fd_source_new (__qmi_shm_channel_get_doorbell_fd (shm, QMI_SHM_RING_CLIENT_TO_PROXY),
+                                                        G_IO_IN);
+    g_source_set_callback (client->shm_readable_source,
+                           (GSourceFunc)shm_readable_cb,
+                           client,
+                           NULL);
+    g_source_attach (client->shm_readable_source, g_main_context_get_thread_default ());
+    __qmi_shm_channel_sleep (shm, QMI_SHM_RING_CLIENT_TO_PROXY);
+
+    g_debug ("Client (%d) using shared memory transport",
+             g_socket_get_fd (g_socket_connection_get_socket (client->connection)));
     return TRUE;
+
+failed:
+    __qmi_shm_channel_free (shm);
+    return FALSE;
+}
+
+/*****************************************************************************/
+/* Indication subscriptions */
+
+typedef struct {
+    QmiDevice  *device;
+    QmiService  service;
+    guint8      cid;
+} SubscriptionKey;
+
+static guint
+subscription_key_hash (gconstpointer v)
+{
+    const SubscriptionKey *key = v;
+
+    return g_direct_hash (key->device) ^ ((guint)key->service << 8 | key->cid);
+}
+
+static gboolean
+subscription_key_equal (gconstpointer v1,
+                        gconstpointer v2)
+{
+    const SubscriptionKey *key1 = v1;
+    const SubscriptionKey *key2 = v2;
+
+    return (key1->device == key2->device &&
+            key1->service == key2->service &&
+            key1->cid == key2->cid);
+}
+
+static void
+subscription_key_free (SubscriptionKey *key)
+{
+    g_slice_free (SubscriptionKey, key);
+}
+
+static void
+subscription_insert (QmiProxy   *self,
+                     Client     *client,
+                     QmiService  service,
+                     guint8      cid)
+{
+    SubscriptionKey  lookup = { client->device, service, cid };
+    GPtrArray       *clients;
+
+    clients = g_hash_table_lookup (self->priv->subscriptions, &lookup);
+    if (!clients) {
+        SubscriptionKey *key;
+
+        key = g_slice_new (SubscriptionKey);
+        *key = lookup;
+        clients = g_ptr_array_new ();
+        g_hash_table_insert (self->priv->subscriptions, key, clients);
+    }
+    g_ptr_array_add (clients, client);
+}
+
+static void
+subscription_remove (QmiProxy   *self,
+                     Client     *client,
+                     QmiService  service,
+                     guint8      cid)
+{
+    SubscriptionKey  lookup = { client->device, service, cid };
+    GPtrArray       *clients;
+
+    clients = g_hash_table_lookup (self->priv->subscriptions, &lookup);
+    if (!clients)
+        return;
+    g_ptr_array_remove (clients, client);
+    if (!clients->len)
+        g_hash_table_remove (self->priv->subscriptions, &lookup);
+}
+
+static void
+subscribe (QmiProxy            *self,
+           Client              *client,
+           const QmiClientInfo *info)
+{
+    subscription_insert (self, client, info->service, info->cid);
+    subscription_insert (self, client, info->service, QMI_CID_BROADCAST);
+}
+
+static void
+unsubscribe (QmiProxy            *self,
+             Client              *client,
+             const QmiClientInfo *info)
+{
+    subscription_remove (self, client, info->service, info->cid);
+    subscription_remove (self, client, info->service, QMI_CID_BROADCAST);
 }
 
 /*****************************************************************************/
@@ -203,7 +741,7 @@ track_client (QmiProxy *self,
               Client   *client)
 {
     self->priv->clients = g_list_append (self->priv->clients, client_ref (client));
-    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_CLIENTS]);
+    notify_n_clients (self);
 }
 
 static void
@@ -219,6 +757,7 @@ disown_not_released_clients (QmiProxy *self,
         QmiClientInfo *info;
 
         info = &g_array_index (client->qmi_client_info_array, QmiClientInfo, i);
+        unsubscribe (self, client, info);
         g_debug ("QMI client disowned [%s,%s,%u]",
                  qmi_device_get_path_display (client->device),
                  qmi_service_get_string (info->service),
@@ -255,7 +794,7 @@ untrack_client (QmiProxy *self,
     if (g_list_find (self->priv->clients, client)) {
         self->priv->clients = g_list_remove (self->priv->clients, client);
         client_unref (client);
-        g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_N_CLIENTS]);
+        notify_n_clients (self);
     }
 
     if (device)
@@ -286,6 +825,7 @@ complete_internal_proxy_open (QmiProxy *self,
                               Client   *client)
 {
     QmiMessage *response;
+    QmiShmChannel *shm = NULL;
     GError *error = NULL;
 
     g_debug ("connection to QMI device '%s' established", qmi_device_get_path (client->device));
@@ -295,7 +835,22 @@ complete_internal_proxy_open (QmiProxy *self,
     qmi_message_unref (client->internal_proxy_open_request);
     client->internal_proxy_open_request = NULL;
 
-    if (!client_send_message (client, response, &error)) {
+    /* Fallback to the socket if the channel cannot be created */
+    if (client->shm_requested && client->connection) {
+        shm = __qmi_shm_channel_new (&error);
+        if (!shm) {
+            g_debug ("couldn't setup shared memory transport: %s", error->message);
+            g_clear_error (&error);
+        }
+    }
+
+    if (shm) {
+        if (!client_send_shm_open_response (client, response, shm, &error)) {
+            g_warning ("couldn't send proxy open response to client: %s", error->message);
+            g_error_free (error);
+            untrack_client (self, client);
+        }
+    } else if (!client_send_message (client, response, &error)) {
         g_warning ("couldn't send proxy open response to client: %s", error->message);
         g_error_free (error);
         untrack_client (self, client);
@@ -304,49 +859,120 @@ complete_internal_proxy_open (QmiProxy *self,
     qmi_message_unref (response);
 }
 
+/* Metrics of each device, kept along with the device itself */
+
+#define METRICS_QUARK_STR "metrics"
+static GQuark metrics_quark;
+
+typedef struct {
+    guint64        indications;
+    guint64        indications_fan_out;
+    ForwardingTime forwarding;
+} DeviceMetrics;
+
 static void
-indication_cb (QmiDevice *device,
-               QmiMessage *message,
-               Client *client)
+device_metrics_free (DeviceMetrics *metrics)
 {
-    guint i;
+    g_slice_free (DeviceMetrics, metrics);
+}
 
-    for (i = 0; i < client->qmi_client_info_array->len; i++) {
-        QmiClientInfo *info;
+static DeviceMetrics *
+device_metrics_peek (QmiDevice *device)
+{
+    DeviceMetrics *metrics;
 
-        info = &g_array_index (client->qmi_client_info_array, QmiClientInfo, i);
+    metrics = g_object_get_qdata (G_OBJECT (device), metrics_quark);
+    if (!metrics) {
+        metrics = g_slice_new0 (DeviceMetrics);
+        g_object_set_qdata_full (G_OBJECT (device), metrics_quark, metrics, (GDestroyNotify)device_metrics_free);
+    }
+    return metrics;
+}
+
+static void
+client_send_indication (Client     *client,
+                        QmiMessage *message)
+{
+    GError *error = NULL;
 
-        /* If service and CID match; or if service and broadcast, forward to
-         * the remote client. This message may therefore be forwarded to multiple
-         * clients, all that match the conditions. */
-        if ((qmi_message_get_service (message) == info->service) &&
-            (qmi_message_get_client_id (message) == info->cid ||
-             qmi_message_get_client_id (message) == QMI_CID_BROADCAST)) {
-            GError *error = NULL;
+    /* Don't let a client that isn't reading grow its queue forever,
+     * indications are the only messages not requested by it */
+    if (client->output_queued >= QMI_PROXY_CLIENT_OUTPUT_HIGH_WATER) {
+        if (client->dropped_indications++ == 0)
+            g_warning ("client output queue full (%" G_GSIZE_FORMAT " bytes): dropping indications",
+                       client->output_queued);
+        return;
+    }
 
-            if (!client_send_message (client, message, &error)) {
-                g_warning ("couldn't forward indication to client: %s", error->message);
-                g_error_free (error);
+    /* The message is queued by reference, so all the clients share it */
+    if (!client_send_message (client, message, &error)) {
+        g_warning ("couldn't forward indication to client: %s", error->message);
+        g_error_free (error);
+        return;
+    }
+    g_atomic_int_inc (&client->forwarded_indications);
+}
+
+static void
+indication_cb (QmiDevice *device,
+               QmiMessage *message,
+               QmiProxy *self)
+{
+    SubscriptionKey      lookup = { device, qmi_message_get_service (message), qmi_message_get_client_id (message) };
+    g_autoptr(GPtrArray) clients = NULL;
+    GPtrArray           *subscribed;
+    DeviceMetrics       *metrics;
+    guint                i;
+
+    /* If service and CID match; or if service and broadcast, forward to
+     * the remote client. This message may therefore be forwarded to multiple
+     * clients, all that match the conditions. */
+    proxy_lock (self);
+    metrics = device_metrics_peek (device);
+    metrics->indications++;
+    subscribed = g_hash_table_lookup (self->priv->subscriptions, &lookup);
+    if (subscribed) {
+        clients = g_ptr_array_new_full (subscribed->len, (GDestroyNotify)client_unref);
+        for (i = 0; i < subscribed->len; i++) {
+            Client *client = g_ptr_array_index (subscribed, i);
+            guint   j;
+
+            /* A client with several CIDs of the service is listed once per
+             * CID for broadcasts, but gets each of them just once */
+            for (j = 0; j < i; j++) {
+                if (g_ptr_array_index (subscribed, j) == client)
+                    break;
             }
+            if (j == i)
+                g_ptr_array_add (clients, client_ref (client));
         }
+        metrics->indications_fan_out += clients->len;
     }
+    proxy_unlock (self);
+
+    if (!clients)
+        return;
+
+    /* Sent without the lock, all the clients of the device run in the same
+     * context as the device itself */
+    for (i = 0; i < clients->len; i++)
+        client_send_indication (g_ptr_array_index (clients, i), message);
 }
 
 static void
 device_removed_cb (QmiDevice *device,
                    Client *client)
 {
-    untrack_client (client->proxy, client);
+    QmiProxy *self = client->proxy;
+
+    proxy_lock (self);
+    untrack_client (self, client);
+    proxy_unlock (self);
 }
 
 static void
 register_signal_handlers (Client *client)
 {
-    /* Register for device indications */
-    client->indication_id = g_signal_connect (client->device,
-                                              "indication",
-                                              G_CALLBACK (indication_cb),
-                                              client);
     client->device_removed_id = g_signal_connect (client->device,
                                                   "device-removed",
                                                   G_CALLBACK (device_removed_cb),
@@ -364,6 +990,8 @@ device_open_ready (QmiDevice *device,
 
     /* Note: we get a full client ref */
 
+    proxy_lock (self);
+
     if (!qmi_device_open_finish (device, res, &error)) {
         g_debug ("couldn't open QMI device: %s", error->message);
         g_error_free (error);
@@ -378,8 +1006,13 @@ device_open_ready (QmiDevice *device,
         g_object_unref (client->device);
         client->device = g_object_ref (existing);
     } else {
-        /* Keep the newly added device in the proxy */
+        /* Keep the newly added device in the proxy, and forward its
+         * indications to the subscribed clients */
         self->priv->devices = g_list_append (self->priv->devices, g_object_ref (client->device));
+        g_signal_connect (client->device,
+                          "indication",
+                          G_CALLBACK (indication_cb),
+                          self);
     }
 
     register_signal_handlers (client);
@@ -387,6 +1020,8 @@ device_open_ready (QmiDevice *device,
     complete_internal_proxy_open (self, client);
 
 out:
+    proxy_unlock (self);
+
     /* Balance out the reference we got */
     client_unref (client);
 }
@@ -401,6 +1036,8 @@ device_new_ready (GObject *source,
 
     /* Note: we get a full client ref */
 
+    proxy_lock (self);
+
     client->device = qmi_device_new_finish (res, &error);
     if (!client->device) {
         g_debug ("couldn't open QMI device: %s", error->message);
@@ -417,6 +1054,8 @@ device_new_ready (GObject *source,
                      client_ref (client)); /* Full ref */
 
 out:
+    proxy_unlock (self);
+
     /* Balance out the reference we got */
     client_unref (client);
 }
@@ -431,6 +1070,8 @@ qrtr_node_ready (GObject *source,
     QrtrNode *node;
     GError *error = NULL;
 
+    proxy_lock (self);
+
     node = qrtr_node_for_id_finish (res, &error);
     if (!node) {
         g_debug ("couldn't open QRTR node: %s", error->message);
@@ -447,24 +1088,126 @@ qrtr_node_ready (GObject *source,
     g_object_unref (node);
 
 out:
+    proxy_unlock (self);
+
     /* Balance out the reference we got */
     client_unref (client);
 }
 #endif
 
-static gboolean
-process_internal_proxy_open (QmiProxy   *self,
-                             Client     *client,
-                             QmiMessage *message)
+/*****************************************************************************/
+/* Device threads
+ *
+ * Each device may run in a worker thread of its own, along with all the
+ * clients using it: the client is handed off to the worker of the device as
+ * soon as it asks to open one, and from then on its messages are read,
+ * parsed and forwarded in that thread. */
+
+static QmiWorker *
+peek_worker_for_path (QmiProxy    *self,
+                      const gchar *path)
 {
-    gsize   offset = 0;
-    gsize   init_offset;
-    gchar  *incoming_path;
-    gchar  *device_file_path;
-    GError *error = NULL;
+    QmiWorker *worker;
 
-    if ((init_offset = qmi_message_tlv_read_init (message, QMI_MESSAGE_CTL_INTERNAL_PROXY_OPEN_INPUT_TLV_DEVICE_PATH, NULL, &error)) == 0) {
-        g_debug ("ignoring message from client: invalid proxy open request: %s", error->message);
+    worker = g_hash_table_lookup (self->priv->workers, path);
+    if (!worker) {
+        g_debug ("starting worker thread for device '%s'", path);
+        worker = __qmi_worker_new ();
+        g_hash_table_insert (self->priv->workers, g_strdup (path), worker);
+    }
+    return worker;
+}
+
+static gboolean process_message (QmiProxy   *self,
+                                 Client     *client,
+                                 QmiMessage *message);
+static void     parse_request   (QmiProxy   *self,
+                                 Client     *client);
+
+typedef struct {
+    QmiProxy   *self;    /* Full ref */
+    Client     *client;  /* Full ref */
+    QmiMessage *message; /* The proxy open request */
+} HandOffContext;
+
+static void
+hand_off_context_free (HandOffContext *ctx)
+{
+    qmi_message_unref (ctx->message);
+    client_unref (ctx->client);
+    g_object_unref (ctx->self);
+    g_slice_free (HandOffContext, ctx);
+}
+
+static gboolean
+hand_off_cb (HandOffContext *ctx)
+{
+    Client *client = ctx->client;
+
+    proxy_lock (ctx->self);
+
+    /* Skip if untracked meanwhile */
+    if (client->connection) {
+        client_watch_connection (client);
+        if (!g_queue_is_empty (client->output_queue))
+            client_flush_output (client, NULL);
+
+        /* Start again with the proxy open request, and go on with whatever
+         * was received after it */
+        process_message (ctx->self, client, ctx->message);
+        if (client->buffer && client->buffer->len > 0)
+            parse_request (ctx->self, client);
+    }
+
+    proxy_unlock (ctx->self);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+hand_off_client (QmiProxy    *self,
+                 Client      *client,
+                 const gchar *device_file_path,
+                 QmiMessage  *message)
+{
+    HandOffContext *ctx;
+
+    /* Stop reading in this thread, the worker sets up its own sources */
+    if (client->connection_readable_source) {
+        g_source_destroy (client->connection_readable_source);
+        g_clear_pointer (&client->connection_readable_source, g_source_unref);
+    }
+    if (client->connection_writable_source) {
+        g_source_destroy (client->connection_writable_source);
+        g_clear_pointer (&client->connection_writable_source, g_source_unref);
+    }
+
+    client->worker = peek_worker_for_path (self, device_file_path);
+
+    ctx = g_slice_new (HandOffContext);
+    ctx->self = g_object_ref (self);
+    ctx->client = client_ref (client);
+    ctx->message = qmi_message_ref (message);
+    g_main_context_invoke_full (__qmi_worker_peek_context (client->worker),
+                                G_PRIORITY_DEFAULT,
+                                (GSourceFunc)hand_off_cb,
+                                ctx,
+                                (GDestroyNotify)hand_off_context_free);
+}
+
+static gboolean
+process_internal_proxy_open (QmiProxy   *self,
+                             Client     *client,
+                             QmiMessage *message)
+{
+    gsize   offset = 0;
+    gsize   init_offset;
+    gchar  *incoming_path;
+    gchar  *device_file_path;
+    guint8  transport;
+    GError *error = NULL;
+
+    if ((init_offset = qmi_message_tlv_read_init (message, QMI_MESSAGE_CTL_INTERNAL_PROXY_OPEN_INPUT_TLV_DEVICE_PATH, NULL, &error)) == 0) {
+        g_debug ("ignoring message from client: invalid proxy open request: %s", error->message);
         g_error_free (error);
         return FALSE;
     }
@@ -493,6 +1236,19 @@ process_internal_proxy_open (QmiProxy   *self,
 
     g_debug ("valid request to open connection to QMI device file: %s", device_file_path);
 
+    /* Processed again from the start in the thread of the device */
+    if (self->priv->device_threads && !client->worker) {
+        hand_off_client (self, client, device_file_path, message);
+        g_free (device_file_path);
+        return TRUE;
+    }
+
+    /* Optional request to move to a different transport */
+    offset = 0;
+    if ((init_offset = qmi_message_tlv_read_init (message, QMI_MESSAGE_CTL_INTERNAL_PROXY_OPEN_INPUT_TLV_TRANSPORT, NULL, NULL)) > 0 &&
+        qmi_message_tlv_read_guint8 (message, init_offset, &offset, &transport, NULL))
+        client->shm_requested = (transport == QMI_PROXY_TRANSPORT_SHM);
+
     /* Keep it */
     client->internal_proxy_open_request = qmi_message_ref (message);
 
@@ -551,18 +1307,16 @@ qmi_client_info_array_lookup_cid (GArray     *array,
     return -1;
 }
 
-static void
-track_cid (Client     *client,
-           QmiMessage *message)
+static gboolean
+parse_allocate_cid_response (QmiMessage    *message,
+                             QmiClientInfo *info)
 {
-    gsize          offset = 0;
-    gsize          init_offset;
-    guint16        error_status;
-    guint16        error_code;
-    GError        *error = NULL;
-    guint8         service_tmp;
-    QmiClientInfo  info;
-    gint           i;
+    gsize    offset = 0;
+    gsize    init_offset;
+    guint16  error_status;
+    guint16  error_code;
+    GError  *error = NULL;
+    guint8   service_tmp;
 
     g_assert_cmpuint (qmi_message_get_service (message), ==, QMI_SERVICE_CTL);
     g_assert (qmi_message_is_response (message));
@@ -572,21 +1326,33 @@ track_cid (Client     *client,
         !qmi_message_tlv_read_guint16 (message, init_offset, &offset, QMI_ENDIAN_LITTLE, &error_code, &error)) {
         g_warning ("invalid 'CTL allocate CID' response: missing or invalid result TLV: %s", error->message);
         g_error_free (error);
-        return;
+        return FALSE;
     }
     g_warn_if_fail (__qmi_message_tlv_read_remaining_size (message, init_offset, offset) == 0);
     if ((error_status != 0x00) || (error_code != QMI_PROTOCOL_ERROR_NONE))
-        return;
+        return FALSE;
 
     offset = 0;
     if (((init_offset = qmi_message_tlv_read_init (message, QMI_MESSAGE_OUTPUT_TLV_ALLOCATION_INFO, NULL, &error)) == 0) ||
         !qmi_message_tlv_read_guint8 (message, init_offset, &offset, &service_tmp, &error) ||
-        !qmi_message_tlv_read_guint8 (message, init_offset, &offset, &(info.cid), &error)) {
+        !qmi_message_tlv_read_guint8 (message, init_offset, &offset, &(info->cid), &error)) {
         g_warning ("invalid 'CTL allocate CID' response: missing or invalid allocation info TLV: %s", error->message);
         g_error_free (error);
-        return;
+        return FALSE;
     }
-    info.service = (QmiService)service_tmp;
+    info->service = (QmiService)service_tmp;
+    return TRUE;
+}
+
+static void
+track_cid (Client     *client,
+           QmiMessage *message)
+{
+    QmiClientInfo  info;
+    gint           i;
+
+    if (!parse_allocate_cid_response (message, &info))
+        return;
 
     /* Check if it already exists */
     i = qmi_client_info_array_lookup_cid (client->qmi_client_info_array, info.service, info.cid);
@@ -596,10 +1362,11 @@ track_cid (Client     *client,
                  qmi_service_get_string (info.service),
                  info.cid);
         g_array_append_val (client->qmi_client_info_array, info);
+        subscribe (client->proxy, client, &info);
     }
 }
 
-static void
+static gboolean
 untrack_cid (QmiProxy   *self,
              Client     *client,
              QmiMessage *message)
@@ -619,7 +1386,7 @@ untrack_cid (QmiProxy   *self,
         !qmi_message_tlv_read_guint8 (message, init_offset, &offset, &(info.cid), &error)) {
         g_warning ("invalid 'CTL release CID' request: missing or invalid release info TLV: %s", error->message);
         g_error_free (error);
-        return;
+        return FALSE;
     }
     info.service = (QmiService)service_tmp;
 
@@ -631,7 +1398,8 @@ untrack_cid (QmiProxy   *self,
                  qmi_service_get_string (info.service),
                  info.cid);
         g_array_remove_index (client->qmi_client_info_array, i);
-        return;
+        unsubscribe (self, client, &info);
+        return TRUE;
     }
 
     /* Otherwise, check if it wasn't onwned */
@@ -642,125 +1410,1048 @@ untrack_cid (QmiProxy   *self,
                  qmi_service_get_string (info.service),
                  info.cid);
         g_array_remove_index (self->priv->disowned_qmi_client_info_array, i);
+        return TRUE;
+    }
+
+    g_debug ("unexpected attempt to release QMI client [%s,%s,%u]",
+             qmi_device_get_path_display (client->device),
+             qmi_service_get_string (info.service),
+             info.cid);
+    return FALSE;
+}
+
+static void
+track_implicit_cid (QmiProxy   *self,
+                    Client     *client,
+                    QmiMessage *message)
+{
+    QmiClientInfo info;
+    gint          i;
+
+    info.service = qmi_message_get_service (message);
+    info.cid     = qmi_message_get_client_id (message);
+
+    g_assert_cmpuint (info.service, !=, QMI_SERVICE_CTL);
+
+    /* Check if the QMI client already exists in the client application, and if
+     * so, nothing else to do */
+    i = qmi_client_info_array_lookup_cid (client->qmi_client_info_array, info.service, info.cid);
+    if (i >= 0)
+        return;
+
+    /* The QMI client doesn't exist in the client application, see if it
+     * was disowned previously */
+    i = qmi_client_info_array_lookup_cid (self->priv->disowned_qmi_client_info_array, info.service, info.cid);
+    if (i >= 0) {
+        /* Remove client info from array of disowned ones, and append it to the client */
+        g_debug ("QMI client reowned [%s,%s,%u]",
+                 qmi_device_get_path_display (client->device),
+                 qmi_service_get_string (info.service),
+                 info.cid);
+        g_array_remove_index (self->priv->disowned_qmi_client_info_array, i);
+        g_array_append_val (client->qmi_client_info_array, info);
+        subscribe (self, client, &info);
+        return;
+    }
+
+    /* The QMI client wasn't disowned earlier either. Well, this could be due to the proxy
+     * having crashed and restarted. Just create a new client info from scratch. */
+    g_debug ("QMI client tracked implicitly [%s,%s,%u]",
+             qmi_device_get_path_display (client->device),
+             qmi_service_get_string (info.service),
+             info.cid);
+    g_array_append_val (client->qmi_client_info_array, info);
+    subscribe (self, client, &info);
+}
+
+/*****************************************************************************/
+
+#define TRACK_CTL_QUARK_STR "track-ctl-data"
+static GQuark track_ctl_quark;
+
+static void
+device_track_ctl_request (QmiDevice *device)
+{
+    guint ongoing_ctl;
+
+    if (G_UNLIKELY (!track_ctl_quark)) {
+        track_ctl_quark = g_quark_from_static_string (TRACK_CTL_QUARK_STR);
+        ongoing_ctl = 0;
+    } else
+        ongoing_ctl = GPOINTER_TO_UINT (g_object_get_qdata (G_OBJECT (device), track_ctl_quark));
+    g_object_set_qdata (G_OBJECT (device), track_ctl_quark, GUINT_TO_POINTER (ongoing_ctl + 1));
+}
+
+static void
+device_untrack_ctl_request (QmiDevice *device)
+{
+    guint ongoing_ctl;
+
+    g_assert (track_ctl_quark != 0);
+    ongoing_ctl = GPOINTER_TO_UINT (g_object_get_qdata (G_OBJECT (device), track_ctl_quark));
+    g_assert_cmpuint (ongoing_ctl, >, 0);
+    g_object_set_qdata (G_OBJECT (device), track_ctl_quark, GUINT_TO_POINTER (ongoing_ctl - 1));
+}
+
+static void cid_pool_release_all (QmiDevice *device);
+
+/* Devices are closed once no longer used; unless kept open explicitly, or
+ * after lingering for a while, so that clients connecting in short sequence
+ * (e.g. one qmicli call after another) skip the whole device bring-up. */
+
+#define LINGER_QUARK_STR "linger"
+static GQuark linger_quark;
+
+#define VERSION_INFO_QUARK_STR "version-info"
+static GQuark version_info_quark;
+
+static gboolean
+device_in_use (QmiProxy  *self,
+               QmiDevice *device)
+{
+    GList *l;
+
+    /* If there is at least one client using the device,
+     * no need to close */
+    for (l = self->priv->clients; l; l = g_list_next (l)) {
+        Client *client = l->data;
+
+        if (client->device &&
+            (device == client->device ||
+             g_str_equal (qmi_device_get_path (device), qmi_device_get_path (client->device))))
+            return TRUE;
+    }
+
+    /* If there are no clients using the device BUT there
+     * are still ongoing CTL requests ongoing, no need to
+     * close */
+    if (GPOINTER_TO_UINT (g_object_get_qdata (G_OBJECT (device), track_ctl_quark)) > 0)
+        return TRUE;
+
+    return FALSE;
+}
+
+static void
+device_close (QmiProxy  *self,
+              QmiDevice *device)
+{
+    GList *l;
+
+    /* Now, untrack device from proxy and close it */
+    for (l = self->priv->devices; l; l = g_list_next (l)) {
+        QmiDevice *device_in_list = QMI_DEVICE (l->data);
+
+        if (device_in_list &&
+            (device == device_in_list ||
+             g_str_equal (qmi_device_get_path (device), qmi_device_get_path (device_in_list)))) {
+            g_debug ("closing device '%s': no longer used", qmi_device_get_path_display (device));
+            g_object_set_qdata (G_OBJECT (device_in_list), linger_quark, NULL);
+            cid_pool_release_all (device_in_list);
+            g_signal_handlers_disconnect_by_func (device_in_list, indication_cb, self);
+            qmi_device_close_async (device_in_list, 0, NULL, NULL, NULL);
+            g_object_unref (device_in_list);
+            self->priv->devices = g_list_remove (self->priv->devices, device_in_list);
+            return;
+        }
+    }
+
+    g_assert_not_reached ();
+}
+
+typedef struct {
+    QmiProxy  *self;   /* Not a ref, the timeout goes away with the proxy */
+    QmiDevice *device; /* Not a ref, the timeout goes away with the device */
+} LingerContext;
+
+static void
+linger_context_free (LingerContext *ctx)
+{
+    g_slice_free (LingerContext, ctx);
+}
+
+static void
+linger_source_remove (GSource *source)
+{
+    g_source_destroy (source);
+    g_source_unref (source);
+}
+
+static gboolean
+linger_timeout_cb (LingerContext *ctx)
+{
+    proxy_lock (ctx->self);
+
+    /* The timeout is over, don't let the qdata remove it */
+    g_source_unref (g_object_steal_qdata (G_OBJECT (ctx->device), linger_quark));
+
+    /* A client may have come in the meantime */
+    if (!device_in_use (ctx->self, ctx->device))
+        device_close (ctx->self, ctx->device);
+
+    proxy_unlock (ctx->self);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+device_close_if_unused (QmiProxy  *self,
+                        QmiDevice *device)
+{
+    QmiDevice     *device_in_list;
+    LingerContext *ctx;
+    GSource       *source;
+
+    if (device_in_use (self, device))
+        return;
+
+    /* Kept open until the proxy goes away */
+    if (g_hash_table_contains (self->priv->persistent_devices, qmi_device_get_path (device)))
+        return;
+
+    device_in_list = find_device_for_path (self, qmi_device_get_path (device));
+    if (!self->priv->device_linger_time || !device_in_list) {
+        device_close (self, device);
+        return;
+    }
+
+    /* Wait for the next client, starting again if already waiting */
+    g_debug ("device '%s' no longer used: closing in %u seconds",
+             qmi_device_get_path_display (device), self->priv->device_linger_time);
+    ctx = g_slice_new (LingerContext);
+    ctx->self = self;
+    ctx->device = device_in_list;
+    /* In the context of the device, which may be a worker */
+    source = g_timeout_source_new_seconds (self->priv->device_linger_time);
+    g_source_set_callback (source,
+                           (GSourceFunc)linger_timeout_cb,
+                           ctx,
+                           (GDestroyNotify)linger_context_free);
+    g_source_attach (source, g_main_context_get_thread_default ());
+    g_object_set_qdata_full (G_OBJECT (device_in_list),
+                             linger_quark,
+                             source,
+                             (GDestroyNotify)linger_source_remove);
+}
+
+/* The services supported by the device don't change while it's open, so the
+ * first successful 'CTL Get Version Info' response is given to every client
+ * asking later on */
+static void
+version_info_store (QmiDevice  *device,
+                    QmiMessage *response)
+{
+    gsize   offset = 0;
+    gsize   init_offset;
+    guint16 error_status;
+    guint16 error_code;
+
+    if (((init_offset = qmi_message_tlv_read_init (response, QMI_MESSAGE_OUTPUT_TLV_RESULT, NULL, NULL)) == 0) ||
+        !qmi_message_tlv_read_guint16 (response, init_offset, &offset, QMI_ENDIAN_LITTLE, &error_status, NULL) ||
+        !qmi_message_tlv_read_guint16 (response, init_offset, &offset, QMI_ENDIAN_LITTLE, &error_code, NULL) ||
+        (error_status != 0x00) ||
+        (error_code != QMI_PROTOCOL_ERROR_NONE))
+        return;
+
+    g_object_set_qdata_full (G_OBJECT (device),
+                             version_info_quark,
+                             __qmi_message_copy (response),
+                             (GDestroyNotify)qmi_message_unref);
+}
+
+static gboolean
+reply_version_info (Client     *client,
+                    QmiMessage *message)
+{
+    g_autoptr(QmiMessage)  response = NULL;
+    g_autoptr(GError)      error = NULL;
+    QmiMessage            *cached;
+
+    cached = g_object_get_qdata (G_OBJECT (client->device), version_info_quark);
+    if (!cached)
+        return FALSE;
+
+    response = __qmi_message_copy (cached);
+    qmi_message_set_transaction_id (response, qmi_message_get_transaction_id (message));
+
+    if (!client_send_message (client, response, &error)) {
+        if (!g_error_matches (error, QMI_CORE_ERROR, QMI_CORE_ERROR_WRONG_STATE))
+            g_warning ("sending version info response to client failed: %s", error->message);
+    }
+    return TRUE;
+}
+
+/*****************************************************************************/
+/* CID pool
+ *
+ * Allocating a CID is a CTL round-trip that the modem serializes, so once a
+ * client asks for a CID of a given service, a few more of that service are
+ * allocated in the background and handed out right away to the next clients.
+ *
+ * CIDs released by clients are never put back in the pool, as the modem may
+ * keep state associated to them (indication registrations, packet data
+ * sessions...) that cannot be reset in a generic way. The release response
+ * is sent right away to the client instead, and the CID released in the
+ * background. */
+
+#define CID_POOL_QUARK_STR "cid-pool"
+static GQuark cid_pool_quark;
+
+typedef struct {
+    /* QmiClientInfo of the CIDs ready to be handed out */
+    GArray *cids;
+    /* Allocations ongoing, per service */
+    guint8  n_allocating[G_MAXUINT8 + 1];
+    /* Bumped whenever the pool is emptied without releasing the CIDs */
+    guint   generation;
+} CidPool;
+
+static void
+cid_pool_free (CidPool *pool)
+{
+    g_array_unref (pool->cids);
+    g_slice_free (CidPool, pool);
+}
+
+static CidPool *
+cid_pool_peek (QmiDevice *device)
+{
+    CidPool *pool;
+
+    if (G_UNLIKELY (!cid_pool_quark))
+        cid_pool_quark = g_quark_from_static_string (CID_POOL_QUARK_STR);
+
+    pool = g_object_get_qdata (G_OBJECT (device), cid_pool_quark);
+    if (!pool) {
+        pool = g_slice_new0 (CidPool);
+        pool->cids = g_array_new (FALSE, FALSE, sizeof (QmiClientInfo));
+        g_object_set_qdata_full (G_OBJECT (device), cid_pool_quark, pool, (GDestroyNotify)cid_pool_free);
+    }
+    return pool;
+}
+
+static guint
+cid_pool_count (CidPool    *pool,
+                QmiService  service)
+{
+    guint i;
+    guint n = 0;
+
+    for (i = 0; i < pool->cids->len; i++) {
+        if (g_array_index (pool->cids, QmiClientInfo, i).service == service)
+            n++;
+    }
+    return n;
+}
+
+typedef struct {
+    QmiProxy   *self;   /* Full ref */
+    QmiService  service;
+    guint       generation;
+} CidPoolAllocateContext;
+
+static void
+cid_pool_allocate_ready (QmiDevice              *device,
+                         GAsyncResult           *res,
+                         CidPoolAllocateContext *ctx)
+{
+    g_autoptr(QmiMessage) response = NULL;
+    g_autoptr(GError)     error = NULL;
+    CidPool              *pool;
+    QmiClientInfo         info;
+
+    proxy_lock (ctx->self);
+
+    pool = cid_pool_peek (device);
+    g_assert (pool->n_allocating[ctx->service] > 0);
+    pool->n_allocating[ctx->service]--;
+
+    response = qmi_device_command_full_finish (device, res, &error);
+    if (!response)
+        g_debug ("couldn't allocate pooled CID: %s", error->message);
+    else if (parse_allocate_cid_response (response, &info)) {
+        /* A sync was requested meanwhile, the CID is no longer valid */
+        if (ctx->generation != pool->generation)
+            g_debug ("pooled CID discarded [%s,%s,%u]",
+                     qmi_device_get_path_display (device),
+                     qmi_service_get_string (info.service),
+                     info.cid);
+        else {
+            g_debug ("CID pooled [%s,%s,%u]",
+                     qmi_device_get_path_display (device),
+                     qmi_service_get_string (info.service),
+                     info.cid);
+            g_array_append_val (pool->cids, info);
+        }
+    }
+
+    device_untrack_ctl_request (device);
+    device_close_if_unused (ctx->self, device);
+
+    proxy_unlock (ctx->self);
+
+    g_object_unref (ctx->self);
+    g_slice_free (CidPoolAllocateContext, ctx);
+}
+
+static void
+cid_pool_refill (QmiProxy   *self,
+                 QmiDevice  *device,
+                 QmiService  service)
+{
+    CidPool *pool;
+
+    pool = cid_pool_peek (device);
+    while (cid_pool_count (pool, service) + pool->n_allocating[service] < QMI_PROXY_CID_POOL_SIZE) {
+        g_autoptr(QmiMessage)   request = NULL;
+        CidPoolAllocateContext *ctx;
+        gsize                   init_offset;
+
+        request = qmi_message_new (QMI_SERVICE_CTL, 0, 0, QMI_MESSAGE_CTL_ALLOCATE_CID);
+        init_offset = qmi_message_tlv_write_init (request, QMI_MESSAGE_INPUT_TLV_SERVICE, NULL);
+        qmi_message_tlv_write_guint8 (request, (guint8)service, NULL);
+        qmi_message_tlv_write_complete (request, init_offset, NULL);
+
+        ctx = g_slice_new (CidPoolAllocateContext);
+        ctx->self = g_object_ref (self);
+        ctx->service = service;
+        ctx->generation = pool->generation;
+
+        pool->n_allocating[service]++;
+        device_track_ctl_request (device);
+        qmi_device_command_full (device,
+                                 request,
+                                 NULL,
+                                 10,
+                                 NULL,
+                                 (GAsyncReadyCallback)cid_pool_allocate_ready,
+                                 ctx);
+    }
+}
+
+/* A sync releases all CIDs in the modem */
+static void
+cid_pool_forget_all (QmiDevice *device)
+{
+    CidPool *pool;
+
+    pool = cid_pool_peek (device);
+    g_array_set_size (pool->cids, 0);
+    pool->generation++;
+}
+
+static void
+cid_pool_release_ready (QmiDevice    *device,
+                        GAsyncResult *res)
+{
+    g_autoptr(QmiMessage) response = NULL;
+
+    response = qmi_device_command_full_finish (device, res, NULL);
+}
+
+static void
+cid_pool_release_all (QmiDevice *device)
+{
+    CidPool *pool;
+    guint    i;
+
+    pool = cid_pool_peek (device);
+    for (i = 0; i < pool->cids->len; i++) {
+        QmiClientInfo         *info;
+        g_autoptr(QmiMessage)  request = NULL;
+        gsize                  init_offset;
+
+        info = &g_array_index (pool->cids, QmiClientInfo, i);
+        g_debug ("pooled CID released [%s,%s,%u]",
+                 qmi_device_get_path_display (device),
+                 qmi_service_get_string (info->service),
+                 info->cid);
+
+        /* The request is written right away, no need to wait for the
+         * response before closing the device */
+        request = qmi_message_new (QMI_SERVICE_CTL, 0, 0, QMI_MESSAGE_CTL_RELEASE_CID);
+        init_offset = qmi_message_tlv_write_init (request, QMI_MESSAGE_INPUT_TLV_RELEASE_INFO, NULL);
+        qmi_message_tlv_write_guint8 (request, (guint8)info->service, NULL);
+        qmi_message_tlv_write_guint8 (request, info->cid, NULL);
+        qmi_message_tlv_write_complete (request, init_offset, NULL);
+        qmi_device_command_full (device,
+                                 request,
+                                 NULL,
+                                 10,
+                                 NULL,
+                                 (GAsyncReadyCallback)cid_pool_release_ready,
+                                 NULL);
+    }
+    g_array_set_size (pool->cids, 0);
+}
+
+static gboolean
+allocate_cid_from_pool (QmiProxy   *self,
+                        Client     *client,
+                        QmiMessage *message)
+{
+    g_autoptr(QmiMessage)  response = NULL;
+    g_autoptr(GError)      error = NULL;
+    CidPool               *pool;
+    QmiClientInfo          info;
+    guint8                 service_tmp;
+    gsize                  offset = 0;
+    gsize                  init_offset;
+    guint                  i;
+
+    if (((init_offset = qmi_message_tlv_read_init (message, QMI_MESSAGE_INPUT_TLV_SERVICE, NULL, NULL)) == 0) ||
+        !qmi_message_tlv_read_guint8 (message, init_offset, &offset, &service_tmp, NULL))
+        return FALSE;
+
+    /* Whatever happens, have CIDs of this service ready for the next time */
+    pool = cid_pool_peek (client->device);
+    for (i = 0; i < pool->cids->len; i++) {
+        if (g_array_index (pool->cids, QmiClientInfo, i).service == (QmiService)service_tmp)
+            break;
+    }
+    if (i == pool->cids->len) {
+        cid_pool_refill (self, client->device, (QmiService)service_tmp);
+        return FALSE;
+    }
+
+    info = g_array_index (pool->cids, QmiClientInfo, i);
+    g_array_remove_index (pool->cids, i);
+    cid_pool_refill (self, client->device, info.service);
+
+    response = qmi_message_response_new (message, QMI_PROTOCOL_ERROR_NONE);
+    init_offset = qmi_message_tlv_write_init (response, QMI_MESSAGE_OUTPUT_TLV_ALLOCATION_INFO, NULL);
+    qmi_message_tlv_write_guint8 (response, (guint8)info.service, NULL);
+    qmi_message_tlv_write_guint8 (response, info.cid, NULL);
+    qmi_message_tlv_write_complete (response, init_offset, NULL);
+
+    track_cid (client, response);
+    if (!client_send_message (client, response, &error)) {
+        if (!g_error_matches (error, QMI_CORE_ERROR, QMI_CORE_ERROR_WRONG_STATE))
+            g_warning ("sending pooled CID to client failed: %s", error->message);
+        untrack_client (self, client);
+    }
+    return TRUE;
+}
+
+static gboolean
+reply_release_cid (Client     *client,
+                   QmiMessage *message)
+{
+    g_autoptr(QmiMessage)  response = NULL;
+    g_autoptr(GError)      error = NULL;
+    guint8                 service;
+    guint8                 cid;
+    gsize                  offset = 0;
+    gsize                  init_offset;
+
+    if (((init_offset = qmi_message_tlv_read_init (message, QMI_MESSAGE_INPUT_TLV_RELEASE_INFO, NULL, NULL)) == 0) ||
+        !qmi_message_tlv_read_guint8 (message, init_offset, &offset, &service, NULL) ||
+        !qmi_message_tlv_read_guint8 (message, init_offset, &offset, &cid, NULL))
+        return FALSE;
+
+    response = qmi_message_response_new (message, QMI_PROTOCOL_ERROR_NONE);
+    init_offset = qmi_message_tlv_write_init (response, QMI_MESSAGE_OUTPUT_TLV_RELEASE_INFO, NULL);
+    qmi_message_tlv_write_guint8 (response, service, NULL);
+    qmi_message_tlv_write_guint8 (response, cid, NULL);
+    qmi_message_tlv_write_complete (response, init_offset, NULL);
+
+    if (!client_send_message (client, response, &error)) {
+        if (!g_error_matches (error, QMI_CORE_ERROR, QMI_CORE_ERROR_WRONG_STATE))
+            g_warning ("sending release CID response to client failed: %s", error->message);
+    }
+    return TRUE;
+}
+
+/*****************************************************************************/
+/* Request coalescing */
+
+/* Read-only requests with no per-client state, whose response may be given
+ * to every client that asked the very same thing while it was in flight */
+static const struct {
+    QmiService service;
+    guint16    message_id;
+} coalescable_requests[] = {
+    { QMI_SERVICE_DMS, 0x0020 }, /* Get Capabilities */
+    { QMI_SERVICE_DMS, 0x0023 }, /* Get Revision */
+    { QMI_SERVICE_DMS, 0x0025 }, /* Get IDs */
+    { QMI_SERVICE_DMS, 0x002D }, /* Get Operating Mode */
+    { QMI_SERVICE_NAS, 0x0020 }, /* Get Signal Strength */
+    { QMI_SERVICE_NAS, 0x0024 }, /* Get Serving System */
+    { QMI_SERVICE_NAS, 0x0043 }, /* Get Cell Location Info */
+    { QMI_SERVICE_NAS, 0x004D }, /* Get System Info */
+    { QMI_SERVICE_NAS, 0x004F }, /* Get Signal Info */
+};
+
+typedef struct {
+    QmiDevice *device;  /* Not a ref, only compared */
+    GBytes    *request; /* Raw request, without CID and transaction ID */
+} CoalesceKey;
+
+typedef struct {
+    Client  *client; /* Full ref */
+    guint8   cid;
+    guint16  trid;
+} CoalesceWaiter;
+
+static guint
+coalesce_key_hash (gconstpointer v)
+{
+    const CoalesceKey *key = v;
+
+    return g_direct_hash (key->device) ^ g_bytes_hash (key->request);
+}
+
+static gboolean
+coalesce_key_equal (gconstpointer v1,
+                    gconstpointer v2)
+{
+    const CoalesceKey *a = v1;
+    const CoalesceKey *b = v2;
+
+    return (a->device == b->device && g_bytes_equal (a->request, b->request));
+}
+
+static void
+coalesce_key_free (CoalesceKey *key)
+{
+    g_bytes_unref (key->request);
+    g_slice_free (CoalesceKey, key);
+}
+
+static void
+coalesce_waiter_clear (CoalesceWaiter *waiter)
+{
+    client_unref (waiter->client);
+}
+
+static QmiMessage *
+message_dup (QmiMessage *message,
+             guint8      cid,
+             guint16     trid)
+{
+    QmiMessage *copy;
+
+    /* The message was validated when received, no need to parse it again */
+    copy = __qmi_message_copy (message);
+    __qmi_message_set_client_id (copy, cid);
+    qmi_message_set_transaction_id (copy, trid);
+    return copy;
+}
+
+/* Returns TRUE if the request was attached to an identical one already in
+ * flight; otherwise, if it can be shared, @out_key is set so that the
+ * response is also given to the requests coming in the meantime. */
+static gboolean
+coalesce_request (QmiProxy     *self,
+                  Client       *client,
+                  QmiMessage   *message,
+                  CoalesceKey **out_key)
+{
+    g_autoptr(QmiMessage)  normalized = NULL;
+    CoalesceKey            lookup;
+    CoalesceKey           *key;
+    GArray                *waiters;
+    CoalesceWaiter         waiter;
+    const guint8          *raw;
+    gsize                  len;
+    guint                  i;
+
+    if (!self->priv->coalesce_requests)
+        return FALSE;
+
+    for (i = 0; i < G_N_ELEMENTS (coalescable_requests); i++) {
+        if (coalescable_requests[i].service == qmi_message_get_service (message) &&
+            coalescable_requests[i].message_id == qmi_message_get_message_id (message))
+            break;
+    }
+    if (i == G_N_ELEMENTS (coalescable_requests))
+        return FALSE;
+
+    normalized = message_dup (message, 0, 0);
+    raw = qmi_message_get_raw (normalized, &len, NULL);
+    lookup.device = client->device;
+    lookup.request = g_bytes_new_static (raw, len);
+
+    waiters = g_hash_table_lookup (self->priv->coalesced, &lookup);
+    if (!waiters) {
+        key = g_slice_new (CoalesceKey);
+        key->device = client->device;
+        key->request = g_bytes_new (raw, len);
+        waiters = g_array_new (FALSE, FALSE, sizeof (CoalesceWaiter));
+        g_array_set_clear_func (waiters, (GDestroyNotify)coalesce_waiter_clear);
+        g_hash_table_insert (self->priv->coalesced, key, waiters);
+        g_bytes_unref (lookup.request);
+        *out_key = key;
+        return FALSE;
+    }
+    g_bytes_unref (lookup.request);
+
+    waiter.client = client_ref (client);
+    waiter.cid = qmi_message_get_client_id (message);
+    waiter.trid = qmi_message_get_transaction_id (message);
+    g_array_append_val (waiters, waiter);
+    g_debug ("request coalesced with one already in flight (%u waiting)", waiters->len);
+    return TRUE;
+}
+
+static void
+coalesce_complete (QmiProxy    *self,
+                   CoalesceKey *key,
+                   QmiMessage  *response)
+{
+    g_autoptr(GArray) waiters = NULL;
+    gpointer          stolen_key;
+    gpointer          stolen_waiters;
+    guint             i;
+
+    if (!self->priv->coalesced ||
+        !g_hash_table_lookup_extended (self->priv->coalesced, key, &stolen_key, &stolen_waiters))
         return;
+
+    g_hash_table_steal (self->priv->coalesced, key);
+    waiters = stolen_waiters;
+    coalesce_key_free (stolen_key);
+
+    /* Without a response there's nothing to give, same as for the request
+     * that was actually sent */
+    if (!response)
+        return;
+
+    for (i = 0; i < waiters->len; i++) {
+        CoalesceWaiter        *waiter;
+        g_autoptr(QmiMessage)  copy = NULL;
+        g_autoptr(GError)      error = NULL;
+
+        waiter = &g_array_index (waiters, CoalesceWaiter, i);
+        copy = message_dup (response, waiter->cid, waiter->trid);
+        if (!client_send_message (waiter->client, copy, &error)) {
+            if (!g_error_matches (error, QMI_CORE_ERROR, QMI_CORE_ERROR_WRONG_STATE))
+                g_warning ("forwarding coalesced response to client failed: %s", error->message);
+            untrack_client (self, waiter->client);
+        }
     }
+}
+
+void
+qmi_proxy_set_request_coalescing (QmiProxy *self,
+                                  gboolean  enabled)
+{
+    g_return_if_fail (QMI_IS_PROXY (self));
+
+    self->priv->coalesce_requests = enabled;
+}
+
+void
+qmi_proxy_set_device_linger_time (QmiProxy *self,
+                                  guint     seconds)
+{
+    g_return_if_fail (QMI_IS_PROXY (self));
+
+    self->priv->device_linger_time = seconds;
+}
+
+void
+qmi_proxy_set_device_threads (QmiProxy *self,
+                              gboolean  enabled)
+{
+    g_return_if_fail (QMI_IS_PROXY (self));
+
+    proxy_lock (self);
+    self->priv->device_threads = enabled;
+    proxy_unlock (self);
+}
+
+/*****************************************************************************/
+/* Devices kept open */
+
+static void
+persistent_version_info_ready (QmiDevice    *device,
+                               GAsyncResult *res,
+                               QmiProxy     *self)
+{
+    g_autoptr(QmiMessage) response = NULL;
+    g_autoptr(GError)     error = NULL;
 
-    g_debug ("unexpected attempt to release QMI client [%s,%s,%u]",
-             qmi_device_get_path_display (client->device),
-             qmi_service_get_string (info.service),
-             info.cid);
+    response = qmi_device_command_full_finish (device, res, &error);
+    if (!response)
+        g_debug ("couldn't get version info of device '%s': %s",
+                 qmi_device_get_path_display (device), error->message);
+    else
+        version_info_store (device, response);
+
+    proxy_lock (self);
+    device_untrack_ctl_request (device);
+    proxy_unlock (self);
+
+    g_object_unref (self);
 }
 
 static void
-track_implicit_cid (QmiProxy   *self,
-                    Client     *client,
-                    QmiMessage *message)
+persistent_device_open_ready (QmiDevice    *device,
+                              GAsyncResult *res,
+                              QmiProxy     *self)
 {
-    QmiClientInfo info;
-    gint          i;
+    g_autoptr(QmiMessage) request = NULL;
+    g_autoptr(GError)     error = NULL;
 
-    info.service = qmi_message_get_service (message);
-    info.cid     = qmi_message_get_client_id (message);
+    proxy_lock (self);
 
-    g_assert_cmpuint (info.service, !=, QMI_SERVICE_CTL);
+    if (!qmi_device_open_finish (device, res, &error)) {
+        g_warning ("couldn't open QMI device '%s': %s", qmi_device_get_path_display (device), error->message);
+        goto out;
+    }
 
-    /* Check if the QMI client already exists in the client application, and if
-     * so, nothing else to do */
-    i = qmi_client_info_array_lookup_cid (client->qmi_client_info_array, info.service, info.cid);
-    if (i >= 0)
-        return;
+    /* Race condition, a client opened the same port meanwhile; use that one */
+    if (find_device_for_path (self, qmi_device_get_path (device))) {
+        qmi_device_close_async (device, 0, NULL, NULL, NULL);
+        goto out;
+    }
 
-    /* The QMI client doesn't exist in the client application, see if it
-     * was disowned previously */
-    i = qmi_client_info_array_lookup_cid (self->priv->disowned_qmi_client_info_array, info.service, info.cid);
-    if (i >= 0) {
-        /* Remove client info from array of disowned ones, and append it to the client */
-        g_debug ("QMI client reowned [%s,%s,%u]",
-                 qmi_device_get_path_display (client->device),
-                 qmi_service_get_string (info.service),
-                 info.cid);
-        g_array_remove_index (self->priv->disowned_qmi_client_info_array, i);
-        g_array_append_val (client->qmi_client_info_array, info);
+    g_debug ("device '%s' kept open", qmi_device_get_path_display (device));
+    self->priv->devices = g_list_append (self->priv->devices, g_object_ref (device));
+    g_signal_connect (device,
+                      "indication",
+                      G_CALLBACK (indication_cb),
+                      self);
+
+    /* Have the version info ready for the first client */
+    request = qmi_message_new (QMI_SERVICE_CTL, 0, 0, QMI_MESSAGE_CTL_GET_VERSION_INFO);
+    device_track_ctl_request (device);
+    qmi_device_command_full (device,
+                             request,
+                             NULL,
+                             10,
+                             NULL,
+                             (GAsyncReadyCallback)persistent_version_info_ready,
+                             g_object_ref (self));
+
+out:
+    proxy_unlock (self);
+
+    g_object_unref (device);
+    g_object_unref (self);
+}
+
+static void
+persistent_device_new_ready (GObject      *source,
+                             GAsyncResult *res,
+                             QmiProxy     *self)
+{
+    QmiDevice         *device;
+    g_autoptr(GError)  error = NULL;
+
+    device = qmi_device_new_finish (res, &error);
+    if (!device) {
+        g_warning ("couldn't create QMI device: %s", error->message);
+        g_object_unref (self);
         return;
     }
 
-    /* The QMI client wasn't disowned earlier either. Well, this could be due to the proxy
-     * having crashed and restarted. Just create a new client info from scratch. */
-    g_debug ("QMI client tracked implicitly [%s,%s,%u]",
-             qmi_device_get_path_display (client->device),
-             qmi_service_get_string (info.service),
-             info.cid);
-    g_array_append_val (client->qmi_client_info_array, info);
+    qmi_device_open (device,
+                     QMI_DEVICE_OPEN_FLAGS_NONE,
+                     10,
+                     NULL,
+                     (GAsyncReadyCallback)persistent_device_open_ready,
+                     self); /* Full ref, passed on */
 }
 
-/*****************************************************************************/
-
-#define TRACK_CTL_QUARK_STR "track-ctl-data"
-static GQuark track_ctl_quark;
+typedef struct {
+    QmiProxy *self; /* Full ref */
+    gchar    *path;
+} PersistentDeviceContext;
 
 static void
-device_track_ctl_request (QmiDevice *device)
+persistent_device_context_free (PersistentDeviceContext *ctx)
 {
-    guint ongoing_ctl;
+    g_free (ctx->path);
+    g_object_unref (ctx->self);
+    g_slice_free (PersistentDeviceContext, ctx);
+}
 
-    if (G_UNLIKELY (!track_ctl_quark)) {
-        track_ctl_quark = g_quark_from_static_string (TRACK_CTL_QUARK_STR);
-        ongoing_ctl = 0;
-    } else
-        ongoing_ctl = GPOINTER_TO_UINT (g_object_get_qdata (G_OBJECT (device), track_ctl_quark));
-    g_object_set_qdata (G_OBJECT (device), track_ctl_quark, GUINT_TO_POINTER (ongoing_ctl + 1));
+static gboolean
+persistent_device_create_cb (PersistentDeviceContext *ctx)
+{
+    g_autoptr(GFile) file = NULL;
+
+    file = g_file_new_for_path (ctx->path);
+    qmi_device_new (file,
+                    NULL,
+                    (GAsyncReadyCallback)persistent_device_new_ready,
+                    g_object_ref (ctx->self));
+    return G_SOURCE_REMOVE;
+}
+
+gboolean
+qmi_proxy_keep_device_open (QmiProxy     *self,
+                            const gchar  *path,
+                            GError      **error)
+{
+    g_autofree gchar        *device_file_path = NULL;
+    PersistentDeviceContext *ctx;
+    GMainContext            *context;
+
+    g_return_val_if_fail (QMI_IS_PROXY (self), FALSE);
+    g_return_val_if_fail (path != NULL, FALSE);
+
+    /* Same real path as the one clients end up using */
+    device_file_path = __qmi_utils_get_devpath (path, error);
+    if (!device_file_path)
+        return FALSE;
+
+    proxy_lock (self);
+
+    /* Nothing else to do if already kept open; or if already open by a
+     * client, it just won't be closed */
+    if (!g_hash_table_add (self->priv->persistent_devices, g_strdup (device_file_path)) ||
+        find_device_for_path (self, device_file_path)) {
+        proxy_unlock (self);
+        return TRUE;
+    }
+
+    /* Created in the thread the clients of the device will end up in */
+    context = (self->priv->device_threads ?
+               __qmi_worker_peek_context (peek_worker_for_path (self, device_file_path)) :
+               g_main_context_get_thread_default ());
+
+    proxy_unlock (self);
+
+    ctx = g_slice_new (PersistentDeviceContext);
+    ctx->self = g_object_ref (self);
+    ctx->path = g_steal_pointer (&device_file_path);
+    g_main_context_invoke_full (context,
+                                G_PRIORITY_DEFAULT,
+                                (GSourceFunc)persistent_device_create_cb,
+                                ctx,
+                                (GDestroyNotify)persistent_device_context_free);
+    return TRUE;
 }
 
+/*****************************************************************************/
+/* Metrics, in the text exposition format of Prometheus */
+
 static void
-device_untrack_ctl_request (QmiDevice *device)
+append_seconds (GString     *str,
+                const gchar *name,
+                const gchar *labels,
+                guint64      us)
 {
-    guint ongoing_ctl;
+    gchar buffer[G_ASCII_DTOSTR_BUF_SIZE];
 
-    g_assert (track_ctl_quark != 0);
-    ongoing_ctl = GPOINTER_TO_UINT (g_object_get_qdata (G_OBJECT (device), track_ctl_quark));
-    g_assert_cmpuint (ongoing_ctl, >, 0);
-    g_object_set_qdata (G_OBJECT (device), track_ctl_quark, GUINT_TO_POINTER (ongoing_ctl - 1));
+    /* Regardless of the locale */
+    g_string_append_printf (str, "%s{%s} %s\n", name, labels,
+                            g_ascii_formatd (buffer, sizeof (buffer), "%.6f", (gdouble)us / G_USEC_PER_SEC));
 }
 
 static void
-device_close_if_unused (QmiProxy  *self,
-                        QmiDevice *device)
+append_device_metrics (QmiProxy  *self,
+                       GString   *str,
+                       QmiDevice *device)
 {
-    GList *l;
+    g_autofree gchar    *path = NULL;
+    g_autofree gchar    *labels = NULL;
+    DeviceMetrics       *metrics;
+    QmiDeviceStatistics  statistics;
+    guint                requests_in_flight = 0;
+    guint                service;
+    GList               *l;
+
+    path = g_strescape (qmi_device_get_path (device), NULL);
+    labels = g_strdup_printf ("device=\"%s\"", path);
+    metrics = device_metrics_peek (device);
 
-    /* If there is at least one client using the device,
-     * no need to close */
     for (l = self->priv->clients; l; l = g_list_next (l)) {
         Client *client = l->data;
 
-        if (client->device &&
-            (device == client->device ||
-             g_str_equal (qmi_device_get_path (device), qmi_device_get_path (client->device))))
-            return;
+        if (client->device == device)
+            requests_in_flight += client->requests_in_flight;
     }
 
-    /* If there are no clients using the device BUT there
-     * are still ongoing CTL requests ongoing, no need to
-     * close */
-    if (GPOINTER_TO_UINT (g_object_get_qdata (G_OBJECT (device), track_ctl_quark)) > 0)
-        return;
-
-    /* Now, untrack device from proxy and close it */
-    for (l = self->priv->devices; l; l = g_list_next (l)) {
-        QmiDevice *device_in_list = QMI_DEVICE (l->data);
-
-        if (device_in_list &&
-            (device == device_in_list ||
-             g_str_equal (qmi_device_get_path (device), qmi_device_get_path (device_in_list)))) {
-            g_debug ("closing device '%s': no longer used", qmi_device_get_path_display (device));
-            qmi_device_close_async (device_in_list, 0, NULL, NULL, NULL);
-            g_object_unref (device_in_list);
-            self->priv->devices = g_list_remove (self->priv->devices, device_in_list);
-            return;
+    g_string_append_printf (str, "qmi_proxy_device_requests_in_flight{%s} %u\n", labels, requests_in_flight);
+    g_string_append_printf (str, "qmi_proxy_device_indications_total{%s} %" G_GUINT64_FORMAT "\n", labels, metrics->indications);
+    g_string_append_printf (str, "qmi_proxy_device_indications_fan_out_total{%s} %" G_GUINT64_FORMAT "\n", labels, metrics->indications_fan_out);
+    g_string_append_printf (str, "qmi_proxy_device_forwarding_seconds_count{%s} %" G_GUINT64_FORMAT "\n", labels, metrics->forwarding.n);
+    append_seconds (str, "qmi_proxy_device_forwarding_seconds_sum", labels, metrics->forwarding.total_us);
+    append_seconds (str, "qmi_proxy_device_forwarding_seconds_max", labels, metrics->forwarding.max_us);
+
+    qmi_device_get_statistics (device, &statistics);
+    g_string_append_printf (str, "qmi_device_timeouts_total{%s} %" G_GUINT64_FORMAT "\n", labels, statistics.timeouts);
+    g_string_append_printf (str, "qmi_device_aborts_total{%s} %" G_GUINT64_FORMAT "\n", labels, statistics.aborts);
+    g_string_append_printf (str, "qmi_device_bytes_in_total{%s} %" G_GUINT64_FORMAT "\n", labels, statistics.bytes_in);
+    g_string_append_printf (str, "qmi_device_bytes_out_total{%s} %" G_GUINT64_FORMAT "\n", labels, statistics.bytes_out);
+
+    /* Time waiting for the device, to compare with the forwarding time */
+    for (service = 0; service <= G_MAXUINT8; service++) {
+        QmiDeviceServiceStatistics  service_statistics;
+        const gchar                *service_str;
+        gchar                       service_label[8];
+        guint64                     cumulative = 0;
+        guint                       i;
+
+        qmi_device_get_service_statistics (device, (QmiService)service, &service_statistics);
+        if (!service_statistics.requests_sent)
+            continue;
+
+        service_str = qmi_service_get_string ((QmiService)service);
+        if (!service_str) {
+            g_snprintf (service_label, sizeof (service_label), "0x%02x", service);
+            service_str = service_label;
+        }
+        g_string_append_printf (str, "qmi_device_requests_total{%s,service=\"%s\"} %" G_GUINT64_FORMAT "\n",
+                                labels, service_str, service_statistics.requests_sent);
+
+        for (i = 0; i < QMI_DEVICE_STATISTICS_N_LATENCY_BUCKETS; i++) {
+            gchar buffer[G_ASCII_DTOSTR_BUF_SIZE];
+
+            cumulative += service_statistics.latency_histogram[i];
+            g_string_append_printf (str, "qmi_device_response_seconds_bucket{%s,service=\"%s\",le=\"%s\"} %" G_GUINT64_FORMAT "\n",
+                                    labels,
+                                    service_str,
+                                    (i < QMI_DEVICE_STATISTICS_N_LATENCY_BUCKETS - 1 ?
+                                     g_ascii_formatd (buffer, sizeof (buffer), "%.3f", (gdouble)(1 << i) / 1000) :
+                                     "+Inf"),
+                                    cumulative);
         }
     }
+}
 
-    g_assert_not_reached ();
+static void
+append_client_metrics (GString *str,
+                       Client  *client)
+{
+    g_autofree gchar *path = NULL;
+    g_autofree gchar *labels = NULL;
+
+    path = g_strescape (client->device ? qmi_device_get_path (client->device) : "", NULL);
+    labels = g_strdup_printf ("device=\"%s\",client=\"%d\"",
+                              path,
+                              client->connection ? g_socket_get_fd (g_socket_connection_get_socket (client->connection)) : -1);
+
+    g_string_append_printf (str, "qmi_proxy_client_output_queued_bytes{%s} %" G_GSIZE_FORMAT "\n", labels, client->output_queued);
+    g_string_append_printf (str, "qmi_proxy_client_requests_in_flight{%s} %u\n", labels, client->requests_in_flight);
+    g_string_append_printf (str, "qmi_proxy_client_indications_forwarded_total{%s} %d\n", labels, g_atomic_int_get (&client->forwarded_indications));
+    g_string_append_printf (str, "qmi_proxy_client_indications_dropped_total{%s} %u\n", labels, client->dropped_indications);
+    g_string_append_printf (str, "qmi_proxy_client_forwarding_seconds_count{%s} %" G_GUINT64_FORMAT "\n", labels, client->forwarding.n);
+    append_seconds (str, "qmi_proxy_client_forwarding_seconds_sum", labels, client->forwarding.total_us);
+    append_seconds (str, "qmi_proxy_client_forwarding_seconds_max", labels, client->forwarding.max_us);
+}
+
+gchar *
+qmi_proxy_get_metrics (QmiProxy *self)
+{
+    GString *str;
+    GList   *l;
+
+    g_return_val_if_fail (QMI_IS_PROXY (self), NULL);
+
+    str = g_string_new (NULL);
+
+    proxy_lock (self);
+    g_string_append_printf (str, "qmi_proxy_clients %u\n", g_list_length (self->priv->clients));
+    for (l = self->priv->devices; l; l = g_list_next (l))
+        append_device_metrics (self, str, l->data);
+    for (l = self->priv->clients; l; l = g_list_next (l))
+        append_client_metrics (str, l->data);
+    proxy_unlock (self);
+
+    return g_string_free (str, FALSE);
 }
 
 /*****************************************************************************/
@@ -770,6 +2461,13 @@ typedef struct {
     Client   *client; /* Full ref */
     guint8    in_trid;
     gboolean  ctl;
+    /* The response was already sent to the client */
+    gboolean  replied;
+    /* Owned by the coalesced requests table */
+    CoalesceKey *coalesce_key;
+    /* When received from the client, and when sent to the device */
+    gint64    received_time;
+    gint64    sent_time;
 } Request;
 
 static void
@@ -789,6 +2487,13 @@ device_command_ready (QmiDevice    *device,
 {
     g_autoptr(QmiMessage) response = NULL;
     g_autoptr(GError)     error = NULL;
+    gint64                completed_time;
+
+    completed_time = g_get_monotonic_time ();
+
+    proxy_lock (request->self);
+
+    request->client->requests_in_flight--;
 
     response = qmi_device_command_full_finish (device, res, &error);
     if (!response) {
@@ -796,10 +2501,15 @@ device_command_ready (QmiDevice    *device,
         goto out;
     }
 
+    if (request->replied)
+        goto out;
+
     if (qmi_message_get_service (response) == QMI_SERVICE_CTL) {
         qmi_message_set_transaction_id (response, request->in_trid);
         if (qmi_message_get_message_id (response) == QMI_MESSAGE_CTL_ALLOCATE_CID)
             track_cid (request->client, response);
+        else if (qmi_message_get_message_id (response) == QMI_MESSAGE_CTL_GET_VERSION_INFO)
+            version_info_store (device, response);
     }
 
     if (!client_send_message (request->client, response, &error)) {
@@ -808,13 +2518,23 @@ device_command_ready (QmiDevice    *device,
         if (!g_error_matches (error, QMI_CORE_ERROR, QMI_CORE_ERROR_WRONG_STATE))
             g_warning ("forwarding response to client failed: %s", error->message);
         untrack_client (request->self, request->client);
+    } else {
+        gint64 us;
+
+        us = (request->sent_time - request->received_time) + (g_get_monotonic_time () - completed_time);
+        forwarding_time_add (&request->client->forwarding, us);
+        forwarding_time_add (&device_metrics_peek (device)->forwarding, us);
     }
 
  out:
+    if (request->coalesce_key)
+        coalesce_complete (request->self, request->coalesce_key, response);
     if (request->ctl) {
         device_untrack_ctl_request (device);
         device_close_if_unused (request->self, device);
     }
+    proxy_unlock (request->self);
+
     request_free (request);
 }
 
@@ -824,6 +2544,9 @@ process_message (QmiProxy   *self,
                  QmiMessage *message)
 {
     Request *request;
+    gint64   received_time;
+
+    received_time = g_get_monotonic_time ();
 
     /* Accept only request messages from the client */
     if (!qmi_message_is_request (message)) {
@@ -835,22 +2558,42 @@ process_message (QmiProxy   *self,
         qmi_message_get_message_id (message) == QMI_MESSAGE_CTL_INTERNAL_PROXY_OPEN)
         return process_internal_proxy_open (self, client, message);
 
+    if (qmi_message_get_service (message) == QMI_SERVICE_CTL &&
+        qmi_message_get_message_id (message) == QMI_MESSAGE_CTL_ALLOCATE_CID &&
+        allocate_cid_from_pool (self, client, message))
+        return TRUE;
+
+    if (qmi_message_get_service (message) == QMI_SERVICE_CTL &&
+        qmi_message_get_message_id (message) == QMI_MESSAGE_CTL_GET_VERSION_INFO &&
+        reply_version_info (client, message))
+        return TRUE;
+
     request = g_slice_new0 (Request);
     request->self = g_object_ref (self);
     request->client = client_ref (client);
+    request->received_time = received_time;
 
     if (qmi_message_get_service (message) == QMI_SERVICE_CTL) {
         /* Keep track of how many CTL requests are ongoing */
         device_track_ctl_request (client->device);
         request->ctl = TRUE;
         request->in_trid = qmi_message_get_transaction_id (message);
-        qmi_message_set_transaction_id (message, 0);
         /* Try to untrack QMI client as soon as we detect the associated
-         * release message, no need to wait for the response. */
-        if (qmi_message_get_message_id (message) == QMI_MESSAGE_CTL_RELEASE_CID)
-            untrack_cid (self, client, message);
-    } else
+         * release message, and reply right away, no need to wait for the
+         * response. */
+        if (qmi_message_get_message_id (message) == QMI_MESSAGE_CTL_RELEASE_CID &&
+            untrack_cid (self, client, message))
+            request->replied = reply_release_cid (client, message);
+        else if (qmi_message_get_message_id (message) == QMI_MESSAGE_CTL_SYNC)
+            cid_pool_forget_all (client->device);
+        qmi_message_set_transaction_id (message, 0);
+    } else {
         track_implicit_cid (self, client, message);
+        if (coalesce_request (self, client, message, &request->coalesce_key)) {
+            request_free (request);
+            return TRUE;
+        }
+    }
 
     /* The timeout needs to be big enough for any kind of transaction to
      * complete, otherwise the remote clients will lose the reply if they
@@ -861,6 +2604,8 @@ process_message (QmiProxy   *self,
      * logs (as it doesn't have the original message context with the vendor
      * id).
      */
+    request->sent_time = g_get_monotonic_time ();
+    client->requests_in_flight++;
     qmi_device_command_full (client->device,
                              message,
                              NULL,
@@ -904,6 +2649,10 @@ parse_request (QmiProxy *self,
             /* Play with the received message */
             process_message (self, client, message);
             qmi_message_unref (message);
+
+            /* The rest is parsed by the worker */
+            if (client_handed_off (client))
+                return;
         }
     } while (client->buffer->len > 0);
 }
@@ -917,9 +2666,12 @@ connection_readable_cb (GSocket *socket,
     guint8 buffer[BUFFER_SIZE];
     GError *error = NULL;
     gssize r;
+    gboolean keep = TRUE;
 
     self = client->proxy;
 
+    proxy_lock (self);
+
     if (condition & G_IO_IN || condition & G_IO_PRI) {
         r = g_input_stream_read (g_io_stream_get_input_stream (G_IO_STREAM (client->connection)),
                                 buffer,
@@ -931,7 +2683,8 @@ connection_readable_cb (GSocket *socket,
             if (error)
                 g_error_free (error);
             untrack_client (self, client);
-            return FALSE;
+            keep = FALSE;
+            goto out;
         }
 
         if (r > 0) {
@@ -941,17 +2694,136 @@ connection_readable_cb (GSocket *socket,
 
             /* Try to parse input messages */
             parse_request (self, client);
+
+            /* The source was destroyed when handing off the client */
+            if (client_handed_off (client)) {
+                keep = FALSE;
+                goto out;
+            }
         }
     }
 
     if (condition & G_IO_HUP || condition & G_IO_ERR) {
         untrack_client (self, client);
-        return FALSE;
+        keep = FALSE;
+    }
+
+out:
+    proxy_unlock (self);
+    return keep;
+}
+
+static gboolean
+shm_readable_cb (gint fd,
+                 GIOCondition condition,
+                 Client *client)
+{
+    QmiProxy *self;
+
+    self = client->proxy;
+
+    __qmi_shm_channel_ack (fd);
+
+    proxy_lock (self);
+
+    /* Drain the ring, re-checking after asking for the next doorbell */
+    do {
+        const guint8 *data;
+        gsize         len;
+        GError       *error = NULL;
+
+        while (TRUE) {
+            if (!__qmi_shm_channel_peek (client->shm, QMI_SHM_RING_CLIENT_TO_PROXY, &data, &len, &error)) {
+                g_warning ("Error reading from shared memory: %s", error->message);
+                g_error_free (error);
+                untrack_client (self, client);
+                proxy_unlock (self);
+                return FALSE;
+            }
+            if (!len)
+                break;
+
+            if (!G_UNLIKELY (client->buffer))
+                client->buffer = g_byte_array_sized_new (len);
+            g_byte_array_append (client->buffer, data, len);
+            __qmi_shm_channel_consume (client->shm, QMI_SHM_RING_CLIENT_TO_PROXY, len);
+        }
+    } while (!__qmi_shm_channel_sleep (client->shm, QMI_SHM_RING_CLIENT_TO_PROXY));
+
+    /* Try to parse input messages */
+    if (client->buffer && client->buffer->len)
+        parse_request (self, client);
+
+    proxy_unlock (self);
+    return TRUE;
+}
+
+/*****************************************************************************/
+/* Client authorization */
+
+typedef struct {
+    gint64  expiry; /* monotonic time */
+    GError *error;  /* NULL if allowed */
+} AuthEntry;
+
+static void
+auth_entry_free (AuthEntry *entry)
+{
+    g_clear_error (&entry->error);
+    g_slice_free (AuthEntry, entry);
+}
+
+static gboolean
+auth_entry_expired (gpointer   key,
+                    AuthEntry *entry,
+                    gint64    *now)
+{
+    return (entry->expiry <= *now);
+}
+
+static gboolean
+user_allowed (QmiProxy  *self,
+              uid_t      uid,
+              GError   **error)
+{
+    AuthEntry *entry;
+    gint64     now;
+
+    now = g_get_monotonic_time ();
+    entry = g_hash_table_lookup (self->priv->auth_cache, GUINT_TO_POINTER (uid));
+    if (!entry || entry->expiry <= now) {
+        /* Drop the decisions of the users no longer connecting */
+        g_hash_table_foreach_remove (self->priv->auth_cache, (GHRFunc)auth_entry_expired, &now);
+
+        entry = g_slice_new0 (AuthEntry);
+        entry->expiry = now + (QMI_PROXY_AUTH_CACHE_TTL * G_USEC_PER_SEC);
+        __qmi_user_allowed (uid, &entry->error);
+        self->priv->n_auth_lookups++;
+        g_hash_table_insert (self->priv->auth_cache, GUINT_TO_POINTER (uid), entry);
     }
 
+    if (entry->error) {
+        g_propagate_error (error, g_error_copy (entry->error));
+        return FALSE;
+    }
     return TRUE;
 }
 
+guint
+qmi_proxy_get_n_auth_lookups (QmiProxy *self)
+{
+    guint n_auth_lookups;
+
+    g_return_val_if_fail (QMI_IS_PROXY (self), 0);
+
+    proxy_lock (self);
+    n_auth_lookups = self->priv->n_auth_lookups;
+    proxy_unlock (self);
+    return n_auth_lookups;
+}
+
+/*****************************************************************************/
+
 static void
 incoming_cb (GSocketService *service,
              GSocketConnection *connection,
@@ -962,6 +2834,7 @@ incoming_cb (GSocketService *service,
     GCredentials *credentials;
     GError *error = NULL;
     uid_t uid;
+    gboolean allowed;
 
     g_debug ("Client (%d) connection open...", g_socket_get_fd (g_socket_connection_get_socket (connection)));
 
@@ -979,7 +2852,11 @@ incoming_cb (GSocketService *service,
         g_error_free (error);
         return;
     }
-    if (!__qmi_user_allowed (uid, &error)) {
+
+    proxy_lock (self);
+    allowed = user_allowed (self, uid, &error);
+    proxy_unlock (self);
+    if (!allowed) {
         g_warning ("Client not allowed: %s", error->message);
         g_error_free (error);
         return;
@@ -990,18 +2867,14 @@ incoming_cb (GSocketService *service,
     client->ref_count = 1;
     client->proxy = self;
     client->connection = g_object_ref (connection);
-    client->connection_readable_source = g_socket_create_source (g_socket_connection_get_socket (client->connection),
-                                                                 G_IO_IN | G_IO_PRI | G_IO_ERR | G_IO_HUP,
-                                                                 NULL);
-    g_source_set_callback (client->connection_readable_source,
-                           (GSourceFunc)connection_readable_cb,
-                           client,
-                           NULL);
-    g_source_attach (client->connection_readable_source, g_main_context_get_thread_default ());
+    client_watch_connection (client);
     client->qmi_client_info_array = g_array_sized_new (FALSE, FALSE, sizeof (QmiClientInfo), 8);
+    client->output_queue = g_queue_new ();
 
     /* Keep the client info around */
+    proxy_lock (self);
     track_client (self, client);
+    proxy_unlock (self);
 
     client_unref (client);
 }
@@ -1078,6 +2951,20 @@ qmi_proxy_init (QmiProxy *self)
     self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
                                               QMI_TYPE_PROXY,
                                               QmiProxyPrivate);
+
+    self->priv->subscriptions = g_hash_table_new_full (subscription_key_hash,
+                                                       subscription_key_equal,
+                                                       (GDestroyNotify)subscription_key_free,
+                                                       (GDestroyNotify)g_ptr_array_unref);
+    self->priv->coalesced = g_hash_table_new_full (coalesce_key_hash,
+                                                   coalesce_key_equal,
+                                                   (GDestroyNotify)coalesce_key_free,
+                                                   (GDestroyNotify)g_array_unref);
+    self->priv->persistent_devices = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    self->priv->auth_cache = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify)auth_entry_free);
+    self->priv->workers = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify)__qmi_worker_unref);
+    self->priv->context = g_main_context_ref_thread_default ();
+    g_rec_mutex_init (&self->priv->lock);
 }
 
 static void
@@ -1090,7 +2977,7 @@ get_property (GObject *object,
 
     switch (prop_id) {
     case PROP_N_CLIENTS:
-        g_value_set_uint (value, g_list_length (self->priv->clients));
+        g_value_set_uint (value, qmi_proxy_get_n_clients (self));
         break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -1098,13 +2985,80 @@ get_property (GObject *object,
     }
 }
 
+typedef struct {
+    QmiProxy  *self;
+    QmiWorker *worker;
+} WorkerShutdownContext;
+
+/* Drop the clients and devices of the worker from within its thread, so
+ * that none of their callbacks may be running meanwhile */
+static gboolean
+worker_shutdown_cb (WorkerShutdownContext *ctx)
+{
+    QmiProxyPrivate *priv = ctx->self->priv;
+    GList           *l;
+    GList           *next;
+
+    proxy_lock (ctx->self);
+
+    for (l = priv->clients; l; l = next) {
+        Client *client = l->data;
+
+        next = g_list_next (l);
+        if (client->worker == ctx->worker) {
+            priv->clients = g_list_delete_link (priv->clients, l);
+            client_unref (client);
+        }
+    }
+
+    for (l = priv->devices; l; l = next) {
+        QmiDevice *device = l->data;
+
+        next = g_list_next (l);
+        if (g_hash_table_lookup (priv->workers, qmi_device_get_path (device)) == ctx->worker) {
+            g_signal_handlers_disconnect_by_func (device, indication_cb, ctx->self);
+            g_object_set_qdata (G_OBJECT (device), linger_quark, NULL);
+            priv->devices = g_list_delete_link (priv->devices, l);
+            g_object_unref (device);
+        }
+    }
+
+    proxy_unlock (ctx->self);
+    return G_SOURCE_REMOVE;
+}
+
 static void
 dispose (GObject *object)
 {
     QmiProxyPrivate *priv = QMI_PROXY (object)->priv;
+    GList           *l;
+
+    /* Stop the workers first, the rest is cleaned up in this thread */
+    if (priv->workers) {
+        GHashTableIter  iter;
+        QmiWorker      *worker;
+
+        g_hash_table_iter_init (&iter, priv->workers);
+        while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&worker)) {
+            WorkerShutdownContext ctx = { QMI_PROXY (object), worker };
+
+            __qmi_worker_invoke_sync (worker, (GSourceFunc)worker_shutdown_cb, &ctx);
+        }
+        g_clear_pointer (&priv->workers, g_hash_table_unref);
+    }
 
     g_clear_pointer (&priv->disowned_qmi_client_info_array, g_array_unref);
     g_list_free_full (g_steal_pointer (&priv->clients), (GDestroyNotify) client_unref);
+    g_clear_pointer (&priv->subscriptions, g_hash_table_unref);
+    g_clear_pointer (&priv->coalesced, g_hash_table_unref);
+    g_clear_pointer (&priv->persistent_devices, g_hash_table_unref);
+    g_clear_pointer (&priv->auth_cache, g_hash_table_unref);
+
+    /* Stop forwarding indications, and stop lingering */
+    for (l = priv->devices; l; l = g_list_next (l)) {
+        g_signal_handlers_disconnect_by_func (l->data, indication_cb, object);
+        g_object_set_qdata (G_OBJECT (l->data), linger_quark, NULL);
+    }
 
     if (priv->socket_service) {
         if (g_socket_service_is_active (priv->socket_service))
@@ -1117,6 +3071,17 @@ dispose (GObject *object)
     G_OBJECT_CLASS (qmi_proxy_parent_class)->dispose (object);
 }
 
+static void
+finalize (GObject *object)
+{
+    QmiProxyPrivate *priv = QMI_PROXY (object)->priv;
+
+    g_main_context_unref (priv->context);
+    g_rec_mutex_clear (&priv->lock);
+
+    G_OBJECT_CLASS (qmi_proxy_parent_class)->finalize (object);
+}
+
 static void
 qmi_proxy_class_init (QmiProxyClass *proxy_class)
 {
@@ -1126,6 +3091,11 @@ qmi_proxy_class_init (QmiProxyClass *proxy_class)
 
     object_class->get_property = get_property;
     object_class->dispose = dispose;
+    object_class->finalize = finalize;
+
+    linger_quark = g_quark_from_static_string (LINGER_QUARK_STR);
+    metrics_quark = g_quark_from_static_string (METRICS_QUARK_STR);
+    version_info_quark = g_quark_from_static_string (VERSION_INFO_QUARK_STR);
 
     /**
      * QmiProxy:qmi-proxy-n-clients
@@ -115,4 +115,113 @@ QmiProxy *qmi_proxy_new (GError **error);
  */
 guint qmi_proxy_get_n_clients (QmiProxy *self);
 
+/**
+ * qmi_proxy_get_n_auth_lookups:
+ * @self: a #QmiProxy.
+ *
+ * Get the number of times the user of an incoming connection has been
+ * checked against the user database. Decisions are cached per user for a
+ * few seconds, so users connecting repeatedly are only checked once in a
+ * while.
+ *
+ * Returns: the number of authorization lookups.
+ *
+ * Since: 1.28
+ */
+guint qmi_proxy_get_n_auth_lookups (QmiProxy *self);
+
+/**
+ * qmi_proxy_get_metrics:
+ * @self: a #QmiProxy.
+ *
+ * Gets the current metrics of the proxy in the text exposition format of
+ * Prometheus, one sample per line.
+ *
+ * For each device: the requests in flight, the indications received and the
+ * number of clients they were forwarded to, the time spent by the proxy
+ * itself forwarding requests and responses, and the counters of the device
+ * as given by qmi_device_get_statistics() and
+ * qmi_device_get_service_statistics(), including the time the device took
+ * to respond.
+ *
+ * For each client: the bytes queued but not yet written to it, the requests
+ * in flight, the indications forwarded and dropped, and the time spent by
+ * the proxy forwarding its requests and their responses.
+ *
+ * Returns: (transfer full): the metrics, to be freed with g_free().
+ *
+ * Since: 1.28
+ */
+gchar *qmi_proxy_get_metrics (QmiProxy *self);
+
+/**
+ * qmi_proxy_set_request_coalescing:
+ * @self: a #QmiProxy.
+ * @enabled: whether requests should be coalesced.
+ *
+ * Sets whether identical read-only requests (e.g. DMS Get IDs or NAS Get
+ * Signal Strength) sent by several clients to the same device while one of
+ * them is already in flight are answered with the response of the one
+ * already sent, instead of being sent to the device again.
+ *
+ * Disabled by default.
+ *
+ * Since: 1.28
+ */
+void qmi_proxy_set_request_coalescing (QmiProxy *self,
+                                       gboolean  enabled);
+
+/**
+ * qmi_proxy_set_device_linger_time:
+ * @self: a #QmiProxy.
+ * @seconds: time an unused device is kept open, or 0 to close it right away.
+ *
+ * Sets how long a device stays open once its last client is gone, so that a
+ * client connecting again within that time skips opening the device.
+ *
+ * Devices are closed right away by default.
+ *
+ * Since: 1.28
+ */
+void qmi_proxy_set_device_linger_time (QmiProxy *self,
+                                       guint     seconds);
+
+/**
+ * qmi_proxy_set_device_threads:
+ * @self: a #QmiProxy.
+ * @enabled: whether each device runs in a thread of its own.
+ *
+ * Sets whether each device, and the clients using it, run in a dedicated
+ * thread with its own main context, instead of in the context the proxy was
+ * created in. Clients are moved to the thread of the device once they ask to
+ * open it, so that a busy device doesn't delay the clients of the others.
+ *
+ * Must be called before any client connects or any device is kept open.
+ * Disabled by default.
+ *
+ * Since: 1.28
+ */
+void qmi_proxy_set_device_threads (QmiProxy *self,
+                                   gboolean  enabled);
+
+/**
+ * qmi_proxy_keep_device_open:
+ * @self: a #QmiProxy.
+ * @path: path of the device.
+ * @error: return location for error or %NULL.
+ *
+ * Opens the device at @path right away, and keeps it open as long as the
+ * proxy exists, whether or not clients use it. The services supported by the
+ * device are queried once it's open, and clients asking for them afterwards
+ * get the stored response.
+ *
+ * Returns: %TRUE if the device is kept open, %FALSE if @error is set. Errors
+ * opening the device are only logged.
+ *
+ * Since: 1.28
+ */
+gboolean qmi_proxy_keep_device_open (QmiProxy     *self,
+                                     const gchar  *path,
+                                     GError      **error);
+
 #endif /* QMI_PROXY_H */
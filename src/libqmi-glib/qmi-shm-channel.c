@@ -0,0 +1,386 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+
+/*
+ * libqmi-glib -- GLib/GIO based library to control QMI devices
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2020 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+#define _GNU_SOURCE
+
+#include <config.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <gio/gio.h>
+
+#include "qmi-shm-channel.h"
+
+/* Ring control block, shared by both processes. Positions are free running
+ * byte counters, each one written only by its owner and kept in its own
+ * cache line. */
+typedef struct {
+    gint  head;              /* bytes ever written, by the producer */
+    gchar pad0[60];
+    gint  tail;              /* bytes ever read, by the consumer */
+    gchar pad1[60];
+    gint  consumer_waiting;  /* consumer wants the doorbell */
+    gint  producer_waiting;  /* producer wants the space bell */
+    gchar pad2[56];
+} RingHeader;
+
+#define RING_STRIDE  (sizeof (RingHeader) + QMI_SHM_RING_SIZE)
+#define CHANNEL_SIZE (2 * RING_STRIDE)
+
+/* Order of the file descriptors passed to the client */
+enum {
+    FD_MEMORY,
+    FD_DOORBELL_CLIENT_TO_PROXY,
+    FD_SPACE_CLIENT_TO_PROXY,
+    FD_DOORBELL_PROXY_TO_CLIENT,
+    FD_SPACE_PROXY_TO_CLIENT,
+};
+
+struct _QmiShmChannel {
+    gint    fds[QMI_SHM_CHANNEL_N_FDS];
+    guint8 *memory;
+};
+
+G_STATIC_ASSERT ((QMI_SHM_RING_SIZE & (QMI_SHM_RING_SIZE - 1)) == 0);
+G_STATIC_ASSERT (sizeof (RingHeader) % 64 == 0);
+
+/*****************************************************************************/
+
+static inline RingHeader *
+ring_header (QmiShmChannel *self,
+             QmiShmRing     ring)
+{
+    return (RingHeader *)(self->memory + ring * RING_STRIDE);
+}
+
+static inline guint8 *
+ring_data (QmiShmChannel *self,
+           QmiShmRing     ring)
+{
+    return self->memory + ring * RING_STRIDE + sizeof (RingHeader);
+}
+
+static void
+ring_bell (gint fd)
+{
+    guint64 one = 1;
+
+    /* A full counter means the bell is already ringing */
+    if (write (fd, &one, sizeof (one)) < 0 && errno != EAGAIN)
+        g_debug ("couldn't ring shared memory channel bell: %s", g_strerror (errno));
+}
+
+void
+__qmi_shm_channel_ack (gint fd)
+{
+    guint64 value;
+
+    if (read (fd, &value, sizeof (value)) < 0 && errno != EAGAIN)
+        g_debug ("couldn't reset shared memory channel bell: %s", g_strerror (errno));
+}
+
+/* Bytes in use in the ring; the other process may have corrupted the
+ * positions, so never trust them blindly */
+static gboolean
+ring_used (RingHeader  *header,
+           guint32     *used,
+           GError     **error)
+{
+    *used = (guint32)g_atomic_int_get (&header->head) - (guint32)g_atomic_int_get (&header->tail);
+    if (*used > QMI_SHM_RING_SIZE) {
+        g_set_error (error,
+                     G_IO_ERROR,
+                     G_IO_ERROR_INVALID_DATA,
+                     "Shared memory ring corrupted");
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/*****************************************************************************/
+
+gboolean
+__qmi_shm_channel_write (QmiShmChannel  *self,
+                         QmiShmRing      ring,
+                         const guint8   *data,
+                         gsize           len,
+                         GError        **error)
+{
+    RingHeader *header;
+    guint32     used;
+    guint32     head;
+    guint32     index;
+    gsize       first;
+
+    if (len > QMI_SHM_RING_SIZE) {
+        g_set_error (error,
+                     G_IO_ERROR,
+                     G_IO_ERROR_MESSAGE_TOO_LARGE,
+                     "Message too long for the shared memory ring: %" G_GSIZE_FORMAT " bytes",
+                     len);
+        return FALSE;
+    }
+
+    header = ring_header (self, ring);
+    if (!ring_used (header, &used, error))
+        return FALSE;
+
+    if (QMI_SHM_RING_SIZE - used < len) {
+        /* Ask for the space bell, unless room was made meanwhile */
+        g_atomic_int_set (&header->producer_waiting, 1);
+        if (!ring_used (header, &used, error))
+            return FALSE;
+        if (QMI_SHM_RING_SIZE - used < len) {
+            g_set_error (error,
+                         G_IO_ERROR,
+                         G_IO_ERROR_WOULD_BLOCK,
+                         "Shared memory ring full");
+            return FALSE;
+        }
+        g_atomic_int_set (&header->producer_waiting, 0);
+    }
+
+    head = (guint32)g_atomic_int_get (&header->head);
+    index = head & (QMI_SHM_RING_SIZE - 1);
+    first = MIN (len, QMI_SHM_RING_SIZE - index);
+    memcpy (ring_data (self, ring) + index, data, first);
+    memcpy (ring_data (self, ring), data + first, len - first);
+
+    /* Publish the data, then wake up the consumer only if it sleeps */
+    g_atomic_int_set (&header->head, (gint)(head + len));
+    if (g_atomic_int_get (&header->consumer_waiting) &&
+        g_atomic_int_compare_and_exchange (&header->consumer_waiting, 1, 0))
+        ring_bell (ring == QMI_SHM_RING_CLIENT_TO_PROXY ?
+                   self->fds[FD_DOORBELL_CLIENT_TO_PROXY] :
+                   self->fds[FD_DOORBELL_PROXY_TO_CLIENT]);
+    return TRUE;
+}
+
+gboolean
+__qmi_shm_channel_peek (QmiShmChannel  *self,
+                        QmiShmRing      ring,
+                        const guint8  **data,
+                        gsize          *len,
+                        GError        **error)
+{
+    RingHeader *header;
+    guint32     used;
+    guint32     index;
+
+    header = ring_header (self, ring);
+    if (!ring_used (header, &used, error))
+        return FALSE;
+
+    index = (guint32)g_atomic_int_get (&header->tail) & (QMI_SHM_RING_SIZE - 1);
+    *data = ring_data (self, ring) + index;
+    *len = MIN (used, QMI_SHM_RING_SIZE - index);
+    return TRUE;
+}
+
+void
+__qmi_shm_channel_consume (QmiShmChannel *self,
+                           QmiShmRing     ring,
+                           gsize          len)
+{
+    RingHeader *header;
+
+    header = ring_header (self, ring);
+    g_atomic_int_add (&header->tail, (gint)len);
+
+    /* Wake up the producer only if it found the ring full */
+    if (g_atomic_int_get (&header->producer_waiting) &&
+        g_atomic_int_compare_and_exchange (&header->producer_waiting, 1, 0))
+        ring_bell (ring == QMI_SHM_RING_CLIENT_TO_PROXY ?
+                   self->fds[FD_SPACE_CLIENT_TO_PROXY] :
+                   self->fds[FD_SPACE_PROXY_TO_CLIENT]);
+}
+
+gboolean
+__qmi_shm_channel_sleep (QmiShmChannel *self,
+                         QmiShmRing     ring)
+{
+    RingHeader *header;
+
+    header = ring_header (self, ring);
+    g_atomic_int_set (&header->consumer_waiting, 1);
+    if (g_atomic_int_get (&header->head) == g_atomic_int_get (&header->tail))
+        return TRUE;
+
+    /* Data arrived before the producer could see us sleeping */
+    g_atomic_int_set (&header->consumer_waiting, 0);
+    return FALSE;
+}
+
+/*****************************************************************************/
+
+const gint *
+__qmi_shm_channel_get_fds (QmiShmChannel *self)
+{
+    return self->fds;
+}
+
+gint
+__qmi_shm_channel_get_doorbell_fd (QmiShmChannel *self,
+                                   QmiShmRing     ring)
+{
+    return (ring == QMI_SHM_RING_CLIENT_TO_PROXY ?
+            self->fds[FD_DOORBELL_CLIENT_TO_PROXY] :
+            self->fds[FD_DOORBELL_PROXY_TO_CLIENT]);
+}
+
+gint
+__qmi_shm_channel_get_space_fd (QmiShmChannel *self,
+                                QmiShmRing     ring)
+{
+    return (ring == QMI_SHM_RING_CLIENT_TO_PROXY ?
+            self->fds[FD_SPACE_CLIENT_TO_PROXY] :
+            self->fds[FD_SPACE_PROXY_TO_CLIENT]);
+}
+
+void
+__qmi_shm_channel_free (QmiShmChannel *self)
+{
+    guint i;
+
+    if (self->memory)
+        munmap (self->memory, CHANNEL_SIZE);
+    for (i = 0; i < QMI_SHM_CHANNEL_N_FDS; i++) {
+        if (self->fds[i] >= 0)
+            close (self->fds[i]);
+    }
+    g_slice_free (QmiShmChannel, self);
+}
+
+static QmiShmChannel *
+channel_new (void)
+{
+    QmiShmChannel *self;
+    guint          i;
+
+    self = g_slice_new0 (QmiShmChannel);
+    for (i = 0; i < QMI_SHM_CHANNEL_N_FDS; i++)
+        self->fds[i] = -1;
+    return self;
+}
+
+static gboolean
+channel_map (QmiShmChannel  *self,
+             GError        **error)
+{
+    self->memory = mmap (NULL, CHANNEL_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, self->fds[FD_MEMORY], 0);
+    if (self->memory == MAP_FAILED) {
+        self->memory = NULL;
+        g_set_error (error,
+                     G_IO_ERROR,
+                     g_io_error_from_errno (errno),
+                     "Couldn't map shared memory: %s",
+                     g_strerror (errno));
+        return FALSE;
+    }
+    return TRUE;
+}
+
+QmiShmChannel *
+__qmi_shm_channel_new (GError **error)
+{
+#if defined HAVE_MEMFD_CREATE
+    QmiShmChannel *self;
+    guint          i;
+
+    self = channel_new ();
+
+    /* The client must not be able to resize the memory under our feet */
+    self->fds[FD_MEMORY] = memfd_create ("qmi-proxy-channel", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (self->fds[FD_MEMORY] < 0 ||
+        ftruncate (self->fds[FD_MEMORY], CHANNEL_SIZE) < 0 ||
+        fcntl (self->fds[FD_MEMORY], F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) < 0) {
+        g_set_error (error,
+                     G_IO_ERROR,
+                     g_io_error_from_errno (errno),
+                     "Couldn't create shared memory: %s",
+                     g_strerror (errno));
+        goto failed;
+    }
+
+    for (i = FD_DOORBELL_CLIENT_TO_PROXY; i < QMI_SHM_CHANNEL_N_FDS; i++) {
+        self->fds[i] = eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (self->fds[i] < 0) {
+            g_set_error (error,
+                         G_IO_ERROR,
+                         g_io_error_from_errno (errno),
+                         "Couldn't create shared memory channel bell: %s",
+                         g_strerror (errno));
+            goto failed;
+        }
+    }
+
+    if (!channel_map (self, error))
+        goto failed;
+
+    return self;
+
+failed:
+    __qmi_shm_channel_free (self);
+    return NULL;
+#else
+    g_set_error (error,
+                 G_IO_ERROR,
+                 G_IO_ERROR_NOT_SUPPORTED,
+                 "Shared memory channels not supported");
+    return NULL;
+#endif
+}
+
+QmiShmChannel *
+__qmi_shm_channel_new_from_fds (const gint  *fds,
+                                GError     **error)
+{
+    QmiShmChannel *self;
+    struct stat    st;
+
+    self = channel_new ();
+    memcpy (self->fds, fds, sizeof (self->fds));
+
+    if (fstat (self->fds[FD_MEMORY], &st) < 0 || st.st_size != CHANNEL_SIZE) {
+        g_set_error (error,
+                     G_IO_ERROR,
+                     G_IO_ERROR_INVALID_DATA,
+                     "Invalid shared memory channel");
+        goto failed;
+    }
+
+    if (!channel_map (self, error))
+        goto failed;
+
+    return self;
+
+failed:
+    __qmi_shm_channel_free (self);
+    return NULL;
+}
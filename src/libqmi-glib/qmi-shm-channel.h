@@ -0,0 +1,126 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+
+/*
+ * libqmi-glib -- GLib/GIO based library to control QMI devices
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2020 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+#ifndef _LIBQMI_GLIB_QMI_SHM_CHANNEL_H_
+#define _LIBQMI_GLIB_QMI_SHM_CHANNEL_H_
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+#if !defined (LIBQMI_GLIB_COMPILATION)
+# error private shared memory channel
+#endif
+
+/*
+ * Shared memory channel between the qmi-proxy and one of its clients: a
+ * memfd holding one single-producer/single-consumer ring of raw QMUX bytes
+ * per direction, plus eventfd doorbells. A consumer only gets its doorbell
+ * rung when it went to sleep on an empty ring, and a producer only gets its
+ * space bell rung when it found the ring full, so message bursts are moved
+ * without a syscall per message.
+ */
+
+/* Values of the 'Transport' TLV in the internal proxy open messages */
+#define QMI_PROXY_TRANSPORT_SOCKET 0
+#define QMI_PROXY_TRANSPORT_SHM    1
+
+/* Bytes of data each ring can hold, a power of two bigger than any message */
+#define QMI_SHM_RING_SIZE (128 * 1024)
+
+typedef enum {
+    QMI_SHM_RING_CLIENT_TO_PROXY = 0,
+    QMI_SHM_RING_PROXY_TO_CLIENT = 1,
+} QmiShmRing;
+
+/* Number of file descriptors to pass to the client, see
+ * __qmi_shm_channel_get_fds() */
+#define QMI_SHM_CHANNEL_N_FDS 5
+
+typedef struct _QmiShmChannel QmiShmChannel;
+
+/* Create a new channel (proxy side) */
+G_GNUC_INTERNAL
+QmiShmChannel *__qmi_shm_channel_new (GError **error);
+
+/* Map a channel from the file descriptors received from the proxy (client
+ * side). Takes ownership of the @fds, also on error. */
+G_GNUC_INTERNAL
+QmiShmChannel *__qmi_shm_channel_new_from_fds (const gint  *fds,
+                                               GError     **error);
+
+G_GNUC_INTERNAL
+void __qmi_shm_channel_free (QmiShmChannel *self);
+
+/* The QMI_SHM_CHANNEL_N_FDS descriptors that describe the channel */
+G_GNUC_INTERNAL
+const gint *__qmi_shm_channel_get_fds (QmiShmChannel *self);
+
+/* Descriptor readable when data was written to an empty @ring */
+G_GNUC_INTERNAL
+gint __qmi_shm_channel_get_doorbell_fd (QmiShmChannel *self,
+                                        QmiShmRing     ring);
+
+/* Descriptor readable when data was read from a full @ring */
+G_GNUC_INTERNAL
+gint __qmi_shm_channel_get_space_fd (QmiShmChannel *self,
+                                     QmiShmRing     ring);
+
+/* Reset a readable doorbell or space descriptor */
+G_GNUC_INTERNAL
+void __qmi_shm_channel_ack (gint fd);
+
+/* Producer: write the whole message or nothing. If the ring is full,
+ * G_IO_ERROR_WOULD_BLOCK is returned and the space descriptor becomes
+ * readable once the consumer frees some room. */
+G_GNUC_INTERNAL
+gboolean __qmi_shm_channel_write (QmiShmChannel  *self,
+                                  QmiShmRing      ring,
+                                  const guint8   *data,
+                                  gsize           len,
+                                  GError        **error);
+
+/* Consumer: get the contiguous span of data available at the head of the
+ * @ring (*len is 0 if empty), to be released with
+ * __qmi_shm_channel_consume() */
+G_GNUC_INTERNAL
+gboolean __qmi_shm_channel_peek (QmiShmChannel  *self,
+                                 QmiShmRing      ring,
+                                 const guint8  **data,
+                                 gsize          *len,
+                                 GError        **error);
+
+G_GNUC_INTERNAL
+void __qmi_shm_channel_consume (QmiShmChannel *self,
+                                QmiShmRing     ring,
+                                gsize          len);
+
+/* Consumer: request the doorbell for the next write to the @ring. Returns
+ * FALSE if data arrived meanwhile, and the consumer should peek again. */
+G_GNUC_INTERNAL
+gboolean __qmi_shm_channel_sleep (QmiShmChannel *self,
+                                  QmiShmRing     ring);
+
+G_END_DECLS
+
+#endif /* _LIBQMI_GLIB_QMI_SHM_CHANNEL_H_ */
@@ -43,6 +43,30 @@ G_GNUC_INTERNAL
 gchar *__qmi_utils_str_hex (gconstpointer mem,
                             gsize size,
                             gchar delimiter);
+
+/* Same as __qmi_utils_str_hex(), writing into a caller buffer which must be
+ * exactly 3 bytes per input byte long. */
+G_GNUC_INTERNAL
+void __qmi_utils_str_hex_into (gconstpointer  mem,
+                               gsize          size,
+                               gchar          delimiter,
+                               gchar         *out);
+
+/* Decimal printing of integers without going through printf(), used by the
+ * generated printable support */
+G_GNUC_INTERNAL
+void __qmi_string_append_uint (GString *str,
+                               guint64  value);
+G_GNUC_INTERNAL
+void __qmi_string_append_int  (GString *str,
+                               gint64   value);
+
+/* Same as __qmi_utils_str_hex(), appending to @str */
+G_GNUC_INTERNAL
+void __qmi_string_append_hex (GString       *str,
+                              gconstpointer  mem,
+                              gsize          size,
+                              gchar          delimiter);
 G_GNUC_INTERNAL
 gboolean __qmi_user_allowed (uid_t uid,
                              GError **error);
@@ -51,14 +75,58 @@ G_GNUC_INTERNAL
 gboolean __qmi_string_utf8_validate_printable (const guint8 *utf8,
                                                gsize         utf8_len);
 
+/* Maximum size (including the NUL terminator) of the UTF-8 string that may be
+ * converted from a packed GSM-7 string of the given length in bytes: every
+ * septet expands to at most 2 bytes. */
+#define __QMI_STRING_UTF8_FROM_GSM7_MAX_SIZE(gsm_len) ((((gsize) (gsm_len)) * 8 / 7) * 2 + 1)
+
+/* Maximum size (including the NUL terminator) of the UTF-8 string that may be
+ * converted from a UCS-2LE string of the given length in bytes: every
+ * character expands to at most 3 bytes. */
+#define __QMI_STRING_UTF8_FROM_UCS2LE_MAX_SIZE(ucs2le_len) ((((gsize) (ucs2le_len)) / 2) * 3 + 1)
+
 G_GNUC_INTERNAL
 gchar *__qmi_string_utf8_from_gsm7 (const guint8 *gsm,
                                     gsize         gsm_len);
 
+/* Converts into the given buffer, which must be at least
+ * __QMI_STRING_UTF8_FROM_GSM7_MAX_SIZE() bytes and is also used as scratch
+ * space. Returns the length of the NUL-terminated UTF-8 string, or -1 if
+ * the buffer is too small or the input isn't valid GSM-7. */
+G_GNUC_INTERNAL
+gssize __qmi_string_utf8_from_gsm7_into (const guint8 *gsm,
+                                         gsize         gsm_len,
+                                         gchar        *out,
+                                         gsize         out_size);
+
 G_GNUC_INTERNAL
 gchar *__qmi_string_utf8_from_ucs2le (const guint8 *ucs2le,
                                       gsize         ucs2le_len);
 
+/* Converts into the given buffer, which must be at least
+ * __QMI_STRING_UTF8_FROM_UCS2LE_MAX_SIZE() bytes. Returns the length of the
+ * NUL-terminated UTF-8 string, or -1 if the buffer is too small or the input
+ * isn't valid UCS-2LE. */
+G_GNUC_INTERNAL
+gssize __qmi_string_utf8_from_ucs2le_into (const guint8 *ucs2le,
+                                           gsize         ucs2le_len,
+                                           gchar        *out,
+                                           gsize         out_size);
+
+/* Kinds of message selected by the trace filter, see
+ * qmi_utils_set_traces_filter(); errors are responses with a failed result */
+#define __QMI_TRACE_KIND_REQUEST    (1 << 0)
+#define __QMI_TRACE_KIND_RESPONSE   (1 << 1)
+#define __QMI_TRACE_KIND_INDICATION (1 << 2)
+#define __QMI_TRACE_KIND_ERROR      (1 << 3)
+#define __QMI_TRACE_KIND_ALL        0x0F
+
+/* Returns the kinds of message traced for the given service and message id,
+ * all of them if there is no filter */
+G_GNUC_INTERNAL
+guint8 __qmi_utils_get_traces_filter_kinds (guint8  service,
+                                            guint16 message_id);
+
 typedef enum {
     __QMI_TRANSPORT_TYPE_UNKNOWN,
     __QMI_TRANSPORT_TYPE_QMUX,
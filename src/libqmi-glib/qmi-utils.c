@@ -35,6 +35,7 @@
 #include "qmi-utils.h"
 #include "qmi-utils-private.h"
 #include "qmi-error-types.h"
+#include "qmi-enum-types.h"
 
 /**
  * SECTION:qmi-utils
@@ -45,15 +46,33 @@
 
 /*****************************************************************************/
 
+static const gchar hex_digits[] = "0123456789ABCDEF";
+
+void
+__qmi_utils_str_hex_into (gconstpointer  mem,
+                          gsize          size,
+                          gchar          delimiter,
+                          gchar         *out)
+{
+    const guint8 *data = mem;
+    gsize         i;
+
+    /* Each byte takes exactly 3 output bytes: 2 hex chars plus either the
+     * delimiter or, for the last one, the NUL terminator. */
+    for (i = 0; i < size; i++, out += 3) {
+        out[0] = hex_digits[data[i] >> 4];
+        out[1] = hex_digits[data[i] & 0x0F];
+        out[2] = delimiter;
+    }
+    if (size > 0)
+        out[-1] = '\0';
+}
+
 gchar *
 __qmi_utils_str_hex (gconstpointer mem,
                      gsize size,
                      gchar delimiter)
 {
-    const guint8 *data = mem;
-    gsize i;
-    gsize j;
-    gsize new_str_length;
     gchar *new_str;
 
     /* Get new string length. If input string has N bytes, we need:
@@ -61,19 +80,8 @@ __qmi_utils_str_hex (gconstpointer mem,
      * - 2N bytes for hexadecimal char representation of each byte...
      * - N-1 bytes for the separator ':'
      * So... a total of (1+2N+N-1) = 3N bytes are needed... */
-    new_str_length =  3 * size;
-
-    /* Allocate memory for new array and initialize contents to NUL */
-    new_str = g_malloc0 (new_str_length);
-
-    /* Print hexadecimal representation of each byte... */
-    for (i = 0, j = 0; i < size; i++, j += 3) {
-        /* Print character in output string... */
-        snprintf (&new_str[j], 3, "%02X", data[i]);
-        /* And if needed, add separator */
-        if (i != (size - 1) )
-            new_str[j + 2] = delimiter;
-    }
+    new_str = g_malloc (3 * size);
+    __qmi_utils_str_hex_into (mem, size, delimiter, new_str);
 
     /* Set output string */
     return new_str;
@@ -81,6 +89,76 @@ __qmi_utils_str_hex (gconstpointer mem,
 
 /*****************************************************************************/
 
+/* Pairs of decimal digits for every value from 0 to 99 */
+static const gchar decimal_digit_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+void
+__qmi_string_append_uint (GString *str,
+                          guint64  value)
+{
+    gchar  buffer[20]; /* G_MAXUINT64 has 20 digits */
+    gchar *p;
+
+    /* Written backwards from the end of the buffer, two digits at a time */
+    p = buffer + sizeof (buffer);
+    while (value >= 100) {
+        guint pair;
+
+        pair = (guint) (value % 100) * 2;
+        value /= 100;
+        *--p = decimal_digit_pairs[pair + 1];
+        *--p = decimal_digit_pairs[pair];
+    }
+    if (value >= 10) {
+        *--p = decimal_digit_pairs[value * 2 + 1];
+        *--p = decimal_digit_pairs[value * 2];
+    } else
+        *--p = '0' + (gchar) value;
+
+    g_string_append_len (str, p, buffer + sizeof (buffer) - p);
+}
+
+void
+__qmi_string_append_int (GString *str,
+                         gint64   value)
+{
+    if (value < 0) {
+        g_string_append_c (str, '-');
+        /* Negate as unsigned so that G_MININT64 is also handled */
+        __qmi_string_append_uint (str, (guint64) 0 - (guint64) value);
+    } else
+        __qmi_string_append_uint (str, (guint64) value);
+}
+
+void
+__qmi_string_append_hex (GString       *str,
+                         gconstpointer  mem,
+                         gsize          size,
+                         gchar          delimiter)
+{
+    gsize len;
+
+    if (!size)
+        return;
+
+    /* Written in place, the NUL of the last byte is the string terminator */
+    len = str->len;
+    g_string_set_size (str, len + (3 * size) - 1);
+    __qmi_utils_str_hex_into (mem, size, delimiter, str->str + len);
+}
+
+/*****************************************************************************/
+
 gboolean
 __qmi_user_allowed (uid_t uid,
                     GError **error)
@@ -252,16 +330,6 @@ static const GsmUtf8Mapping gsm_def_utf8_alphabet[GSM_DEF_ALPHABET_SIZE] = {
     TWO(0xc3, 0xb6), TWO(0xc3, 0xb1), TWO(0xc3, 0xbc), TWO(0xc3, 0xa0)
 };
 
-static guint8
-gsm_def_char_to_utf8 (const guint8  gsm,
-                      guint8       *out_utf8)
-{
-    if (gsm >= GSM_DEF_ALPHABET_SIZE)
-        return 0;
-    memcpy (out_utf8, &gsm_def_utf8_alphabet[gsm].chars[0], gsm_def_utf8_alphabet[gsm].len);
-    return gsm_def_utf8_alphabet[gsm].len;
-}
-
 #define EONE(a, g)        { {a, 0x00, 0x00}, 1, g }
 #define ETHR(a, b, c, g)  { {a, b,    c},    3, g }
 
@@ -292,147 +360,236 @@ gsm_ext_char_to_utf8 (const guint8  gsm,
     return 0;
 }
 
-static guint8 *
-charset_gsm_unpack (const guint8 *gsm,
-                    guint32       num_septets,
-                    guint8        start_offset,  /* in _bits_ */
-                    gsize        *out_unpacked_len)
+/* Unpack up to 8 septets from the given number of octets (at most 7), all
+ * of them starting at a septet boundary. */
+static inline void
+charset_gsm_unpack_word (const guint8 *gsm,
+                         guint         num_octets,
+                         guint         num_septets,
+                         guint8       *out)
 {
-    GByteArray *unpacked;
-    guint       i;
-
-    unpacked = g_byte_array_sized_new (num_septets + 1);
-    for (i = 0; i < num_septets; i++) {
-        guint8 bits_here, bits_in_next, octet, offset, c;
-        guint32 start_bit;
-
-        start_bit = start_offset + (i * 7); /* Overall bit offset of char in buffer */
-        offset = start_bit % 8;  /* Offset to start of char in this byte */
-        bits_here = offset ? (8 - offset) : 7;
-        bits_in_next = 7 - bits_here;
-
-        /* Grab bits in the current byte */
-        octet = gsm[start_bit / 8];
-        c = (octet >> offset) & (0xFF >> (8 - bits_here));
-
-        /* Grab any bits that spilled over to next byte */
-        if (bits_in_next) {
-            octet = gsm[(start_bit / 8) + 1];
-            c |= (octet & (0xFF >> (8 - bits_in_next))) << bits_here;
-        }
-        g_byte_array_append (unpacked, &c, 1);
-    }
+    guint64 word = 0;
+    guint   i;
 
-    *out_unpacked_len = unpacked->len;
-    return g_byte_array_free (unpacked, FALSE);
+    for (i = 0; i < num_octets; i++)
+        word |= ((guint64) gsm[i]) << (8 * i);
+    for (i = 0; i < num_septets; i++)
+        out[i] = (word >> (7 * i)) & 0x7F;
 }
 
-gchar *
-__qmi_string_utf8_from_gsm7 (const guint8 *gsm_packed,
-                             gsize         gsm_packed_len)
+static void
+charset_gsm_unpack_into (const guint8 *gsm,
+                         gsize         num_septets,
+                         guint8       *out)
 {
-    GByteArray *utf8;
-    guint8     *gsm_unpacked;
-    gsize       gsm_unpacked_len;
-    gsize       i;
+    gsize remaining;
+
+    /* Every 7 octets hold exactly 8 septets, so the bulk of the string is
+     * unpacked a whole 56-bit word at a time with no per-char bit offset
+     * computations; the fixed-size loops get unrolled by the compiler. */
+    for (remaining = num_septets; remaining >= 8; remaining -= 8) {
+        charset_gsm_unpack_word (gsm, 7, 8, out);
+        gsm += 7;
+        out += 8;
+    }
 
-    /* unpack operation needs input length in SEPTETS */
-    gsm_unpacked = charset_gsm_unpack (gsm_packed, gsm_packed_len * 8 / 7, 0, &gsm_unpacked_len);
+    /* Last partial word */
+    if (remaining)
+        charset_gsm_unpack_word (gsm, (remaining * 7 + 7) / 8, remaining, out);
+}
 
-    /* worst case initial length */
-    utf8 = g_byte_array_sized_new (gsm_unpacked_len * 2 + 1);
+gssize
+__qmi_string_utf8_from_gsm7_into (const guint8 *gsm_packed,
+                                  gsize         gsm_packed_len,
+                                  gchar        *out,
+                                  gsize         out_size)
+{
+    const guint8 *gsm_unpacked;
+    gsize         gsm_unpacked_len;
+    gsize         gsm_end;
+    guint8       *p;
+    gsize         i;
 
-    for (i = 0; i < gsm_unpacked_len; i++) {
-        guint8 uchars[4];
-        guint8 ulen;
+    if (out_size < __QMI_STRING_UTF8_FROM_GSM7_MAX_SIZE (gsm_packed_len))
+        return -1;
 
-        /*
-         * 	0x00 is NULL (when followed only by 0x00 up to the
-         * 	end of (fixed byte length) message, possibly also up to
-         * 	FORM FEED.  But 0x00 is also the code for COMMERCIAL AT
-         * 	when some other character (CARRIAGE RETURN if nothing else)
-         * 	comes after the 0x00.
-         *  http://unicode.org/Public/MAPPINGS/ETSI/GSM0338.TXT
-         *
-         * So, if we find a '@' (0x00) and all the next chars after that
-         * are also 0x00, we can consider the string finished already.
-         */
-        if (gsm_unpacked[i] == 0x00) {
-            gsize j;
+    /* unpack operation needs input length in SEPTETS */
+    gsm_unpacked_len = gsm_packed_len * 8 / 7;
+
+    /* The septets are unpacked into the tail of the output buffer itself, so
+     * no additional allocation is needed. As no septet expands to more than
+     * 2 UTF-8 bytes (the 3-byte '€' takes an escape plus a septet), the UTF-8
+     * written at the head of the buffer never reaches a septet not yet read. */
+    gsm_unpacked = (const guint8 *) out + out_size - gsm_unpacked_len;
+    charset_gsm_unpack_into (gsm_packed, gsm_unpacked_len, (guint8 *) gsm_unpacked);
+
+    /*
+     * 	0x00 is NULL (when followed only by 0x00 up to the
+     * 	end of (fixed byte length) message, possibly also up to
+     * 	FORM FEED.  But 0x00 is also the code for COMMERCIAL AT
+     * 	when some other character (CARRIAGE RETURN if nothing else)
+     * 	comes after the 0x00.
+     *  http://unicode.org/Public/MAPPINGS/ETSI/GSM0338.TXT
+     *
+     * So, if we find a '@' (0x00) and all the next chars after that
+     * are also 0x00, we can consider the string finished already.
+     */
+    for (gsm_end = gsm_unpacked_len; gsm_end > 0 && gsm_unpacked[gsm_end - 1] == 0x00; gsm_end--);
 
-            for (j = i + 1; j < gsm_unpacked_len; j++) {
-                if (gsm_unpacked[j] != 0x00)
-                    break;
-            }
-            if (j == gsm_unpacked_len)
-                break;
-        }
+    p = (guint8 *) out;
+    for (i = 0; i < gsm_end; i++) {
+        guint8 ulen;
 
         if (gsm_unpacked[i] == GSM_ESCAPE_CHAR) {
             /* Extended alphabet, decode next char */
-            ulen = gsm_ext_char_to_utf8 (gsm_unpacked[i+1], uchars);
+            ulen = (i + 1 < gsm_unpacked_len) ? gsm_ext_char_to_utf8 (gsm_unpacked[i + 1], p) : 0;
             if (ulen)
                 i += 1;
         } else {
-            /* Default alphabet */
-            ulen = gsm_def_char_to_utf8 (gsm_unpacked[i], uchars);
+            const GsmUtf8Mapping *mapping;
+
+            /* Default alphabet; unpacked septets are always within the table,
+             * and both bytes are copied unconditionally as the buffer has
+             * room for 2 per septet */
+            mapping = &gsm_def_utf8_alphabet[gsm_unpacked[i]];
+            p[0] = mapping->chars[0];
+            p[1] = mapping->chars[1];
+            ulen = mapping->len;
         }
 
         /* Invalid GSM-7, abort */
-        if (!ulen) {
-            g_free (gsm_unpacked);
-            g_byte_array_unref (utf8);
-            return NULL;
-        }
+        if (!ulen)
+            return -1;
 
-        g_byte_array_append (utf8, &uchars[0], ulen);
+        p += ulen;
     }
 
-    g_byte_array_append (utf8, (guint8 *) "\0", 1);  /* NUL terminator */
-    g_free (gsm_unpacked);
-    return (gchar *) g_byte_array_free (utf8, FALSE);
+    *p = '\0';  /* NUL terminator */
+    return (gssize) (p - (guint8 *) out);
+}
+
+gchar *
+__qmi_string_utf8_from_gsm7 (const guint8 *gsm_packed,
+                             gsize         gsm_packed_len)
+{
+    gchar *utf8;
+    gsize  utf8_size;
+
+    utf8_size = __QMI_STRING_UTF8_FROM_GSM7_MAX_SIZE (gsm_packed_len);
+    utf8 = g_malloc (utf8_size);
+    if (__qmi_string_utf8_from_gsm7_into (gsm_packed, gsm_packed_len, utf8, utf8_size) < 0) {
+        g_free (utf8);
+        return NULL;
+    }
+    return utf8;
 }
 
 /*****************************************************************************/
 
-gchar *
-__qmi_string_utf8_from_ucs2le (const guint8 *ucs2le,
-                               gsize         ucs2le_len)
+#define UCS2_ASCII_MASK   G_GUINT64_CONSTANT (0xFF80FF80FF80FF80)
+
+gssize
+__qmi_string_utf8_from_ucs2le_into (const guint8 *ucs2le,
+                                    gsize         ucs2le_len,
+                                    gchar        *out,
+                                    gsize         out_size)
 {
-    gsize               ucs2he_nchars;
-    g_autofree guint16 *ucs2he = NULL;
+    gsize   ucs2le_nchars;
+    guint8 *p;
+    gsize   i = 0;
 
     /* UCS2 data length given in bytes must be multiple of 2 */
     if (ucs2le_len % 2 != 0)
-        return NULL;
+        return -1;
+
+    if (out_size < __QMI_STRING_UTF8_FROM_UCS2LE_MAX_SIZE (ucs2le_len))
+        return -1;
 
     /* Convert length from bytes to number of ucs2 characters */
-    ucs2he_nchars = ucs2le_len / 2;
+    ucs2le_nchars = ucs2le_len / 2;
+
+    /* UCS2 is a subset of UTF-16, so the conversion follows the same rules
+     * g_utf16_to_utf8() applies: stop at the first NUL character, and fail on
+     * unpaired surrogates. It is done here directly from the little endian
+     * input into the caller buffer, instead of going through a host endian
+     * aligned copy and a new allocated string. */
+    p = (guint8 *) out;
+    while (i < ucs2le_nchars) {
+        gunichar c;
+
+        /* Fast path: 4 plain (non-NUL) ASCII characters at a time */
+        if (i + 4 <= ucs2le_nchars) {
+            guint64 word;
+
+            memcpy (&word, &ucs2le[2 * i], sizeof (word));
+            word = GUINT64_FROM_LE (word);
+            if (!(word & UCS2_ASCII_MASK) &&
+                (word & 0xFF) && ((word >> 16) & 0xFF) && ((word >> 32) & 0xFF) && ((word >> 48) & 0xFF)) {
+                p[0] = word & 0xFF;
+                p[1] = (word >> 16) & 0xFF;
+                p[2] = (word >> 32) & 0xFF;
+                p[3] = (word >> 48) & 0xFF;
+                p += 4;
+                i += 4;
+                continue;
+            }
+        }
 
-    /* We'll attempt to convert UCS2 to UTF-8, using GLib's support to convert
-     * from UTF-16 to UTF-8 (given that UCS2 is a subset of UTF-16). In order
-     * to do so, we need the input string in "host endian", so if we're in a
-     * BE system (where host endian is not little endian), we do an explicit
-     * conversion.
-     *
-     * We don't want to use g_convert() because that would mean requiring
-     * full iconv() support in the system.
-     *
-     * We're using an extra allocation always because we need to increase
-     * alignment (guint8 -> (guint16)gunichar2)
-     */
-    ucs2he = g_new (guint16, ucs2he_nchars);
-    g_assert (sizeof (guint16) * ucs2he_nchars == ucs2le_len);
-    memcpy (ucs2he, ucs2le, ucs2le_len);
-#if G_BYTE_ORDER == G_BIG_ENDIAN
-    {
-        guint i;
-
-        for (i = 0; i < ucs2he_nchars; i++)
-            ucs2he[i] = GUINT16_FROM_LE (ucs2he[i]);
+        c = ucs2le[2 * i] | (ucs2le[2 * i + 1] << 8);
+        i++;
+
+        if (c == 0)
+            break;
+
+        if (c < 0x80) {
+            *p++ = c;
+        } else if (c < 0x800) {
+            *p++ = 0xC0 | (c >> 6);
+            *p++ = 0x80 | (c & 0x3F);
+        } else if (c >= 0xD800 && c < 0xDC00) {
+            gunichar low;
+
+            /* High surrogate must be followed by a low surrogate */
+            if (i == ucs2le_nchars)
+                return -1;
+            low = ucs2le[2 * i] | (ucs2le[2 * i + 1] << 8);
+            if (low < 0xDC00 || low >= 0xE000)
+                return -1;
+            i++;
+
+            c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+            *p++ = 0xF0 | (c >> 18);
+            *p++ = 0x80 | ((c >> 12) & 0x3F);
+            *p++ = 0x80 | ((c >> 6) & 0x3F);
+            *p++ = 0x80 | (c & 0x3F);
+        } else if (c >= 0xDC00 && c < 0xE000) {
+            /* Unpaired low surrogate */
+            return -1;
+        } else {
+            *p++ = 0xE0 | (c >> 12);
+            *p++ = 0x80 | ((c >> 6) & 0x3F);
+            *p++ = 0x80 | (c & 0x3F);
+        }
     }
-#endif
-    return g_utf16_to_utf8 ((const gunichar2 *)ucs2he, ucs2he_nchars, NULL, NULL, NULL);
+
+    *p = '\0';  /* NUL terminator */
+    return (gssize) (p - (guint8 *) out);
+}
+
+gchar *
+__qmi_string_utf8_from_ucs2le (const guint8 *ucs2le,
+                               gsize         ucs2le_len)
+{
+    gchar *utf8;
+    gsize  utf8_size;
+
+    utf8_size = __QMI_STRING_UTF8_FROM_UCS2LE_MAX_SIZE (ucs2le_len);
+    utf8 = g_malloc (utf8_size);
+    if (__qmi_string_utf8_from_ucs2le_into (ucs2le, ucs2le_len, utf8, utf8_size) < 0) {
+        g_free (utf8);
+        return NULL;
+    }
+    return utf8;
 }
 /*****************************************************************************/
 
@@ -585,3 +742,265 @@ qmi_utils_set_traces_enabled (gboolean enabled)
 {
     g_atomic_int_set (&__traces_enabled, enabled);
 }
+
+/*****************************************************************************/
+/* Trace filter
+ *
+ * The filter maps each service to the kinds of message traced for all of its
+ * messages, plus a sorted array of per-message rules for the services that
+ * have any, so that deciding whether a message is traced is a table lookup
+ * (and, at most, a binary search) done before the message is copied or
+ * formatted. */
+
+typedef struct {
+    guint16 message_id;
+    guint8  kinds;
+} TraceFilterMessage;
+
+typedef struct {
+    gchar  *str;
+    guint8  service_kinds[G_MAXUINT8 + 1];
+    GArray *messages[G_MAXUINT8 + 1];
+} TraceFilter;
+
+G_LOCK_DEFINE_STATIC (traces_filter);
+static TraceFilter *traces_filter;
+
+static void
+trace_filter_free (TraceFilter *filter)
+{
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (filter->messages); i++) {
+        if (filter->messages[i])
+            g_array_unref (filter->messages[i]);
+    }
+    g_free (filter->str);
+    g_slice_free (TraceFilter, filter);
+}
+
+static gint
+trace_filter_message_cmp (const TraceFilterMessage *a,
+                          const TraceFilterMessage *b)
+{
+    return (gint) a->message_id - (gint) b->message_id;
+}
+
+static gboolean
+trace_filter_parse_number (const gchar  *str,
+                           guint         max,
+                           guint        *out)
+{
+    gulong  value;
+    gchar  *end = NULL;
+
+    if (!g_ascii_isdigit (str[0]))
+        return FALSE;
+    errno = 0;
+    value = strtoul (str, &end, 0);
+    if (errno || !end || *end != '\0' || value > max)
+        return FALSE;
+    *out = (guint) value;
+    return TRUE;
+}
+
+static gboolean
+trace_filter_parse_rule (TraceFilter  *filter,
+                         const gchar  *rule,
+                         GError      **error)
+{
+    gchar        **kind_strv = NULL;
+    gchar         *service_str;
+    gchar         *message_str;
+    gchar         *kinds_str;
+    guint          service;
+    guint          message_id = 0;
+    guint8         kinds = 0;
+    guint          i;
+    gboolean       success = FALSE;
+
+    service_str = g_ascii_strdown (rule, -1);
+
+    kinds_str = strchr (service_str, '/');
+    if (kinds_str)
+        *(kinds_str++) = '\0';
+    message_str = strchr (service_str, ':');
+    if (message_str)
+        *(message_str++) = '\0';
+
+    /* Service, by name or number */
+    if (!trace_filter_parse_number (service_str, G_MAXUINT8, &service)) {
+        GEnumClass *enum_class;
+        GEnumValue *enum_value;
+        gint        value = -1;
+
+        enum_class = G_ENUM_CLASS (g_type_class_ref (QMI_TYPE_SERVICE));
+        enum_value = g_enum_get_value_by_nick (enum_class, service_str);
+        if (enum_value)
+            value = enum_value->value;
+        g_type_class_unref (enum_class);
+
+        if (value < 0 || value > G_MAXUINT8) {
+            g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_INVALID_ARGS,
+                         "unknown service in trace filter rule '%s'", rule);
+            goto out;
+        }
+        service = (guint) value;
+    }
+
+    if (message_str && !trace_filter_parse_number (message_str, G_MAXUINT16, &message_id)) {
+        g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_INVALID_ARGS,
+                     "invalid message id in trace filter rule '%s'", rule);
+        goto out;
+    }
+
+    /* Kinds of message, all but errors (which are responses anyway) by default */
+    if (!kinds_str)
+        kinds = __QMI_TRACE_KIND_REQUEST | __QMI_TRACE_KIND_RESPONSE | __QMI_TRACE_KIND_INDICATION;
+    else {
+        kind_strv = g_strsplit (kinds_str, "+", -1);
+        for (i = 0; kind_strv[i]; i++) {
+            if (g_str_equal (kind_strv[i], "request"))
+                kinds |= __QMI_TRACE_KIND_REQUEST;
+            else if (g_str_equal (kind_strv[i], "response"))
+                kinds |= __QMI_TRACE_KIND_RESPONSE;
+            else if (g_str_equal (kind_strv[i], "indication"))
+                kinds |= __QMI_TRACE_KIND_INDICATION;
+            else if (g_str_equal (kind_strv[i], "error"))
+                kinds |= __QMI_TRACE_KIND_ERROR;
+            else {
+                g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_INVALID_ARGS,
+                             "unknown message kind '%s' in trace filter rule '%s'",
+                             kind_strv[i], rule);
+                goto out;
+            }
+        }
+    }
+
+    if (!message_str)
+        filter->service_kinds[service] |= kinds;
+    else {
+        TraceFilterMessage  key = { .message_id = message_id, .kinds = kinds };
+        GArray             *messages;
+
+        if (!filter->messages[service])
+            filter->messages[service] = g_array_new (FALSE, FALSE, sizeof (TraceFilterMessage));
+        messages = filter->messages[service];
+
+        for (i = 0; i < messages->len; i++) {
+            TraceFilterMessage *existing;
+
+            existing = &g_array_index (messages, TraceFilterMessage, i);
+            if (existing->message_id == message_id) {
+                existing->kinds |= kinds;
+                break;
+            }
+        }
+        if (i == messages->len) {
+            g_array_append_val (messages, key);
+            g_array_sort (messages, (GCompareFunc) trace_filter_message_cmp);
+        }
+    }
+
+    success = TRUE;
+
+out:
+    g_strfreev (kind_strv);
+    g_free (service_str);
+    return success;
+}
+
+gboolean
+qmi_utils_set_traces_filter (const gchar  *filter_str,
+                             GError      **error)
+{
+    TraceFilter *filter = NULL;
+    TraceFilter *old;
+
+    if (filter_str && filter_str[0]) {
+        gchar **rules;
+        guint   i;
+
+        filter = g_slice_new0 (TraceFilter);
+        filter->str = g_strdup (filter_str);
+
+        rules = g_strsplit (filter_str, ",", -1);
+        for (i = 0; rules[i]; i++) {
+            g_strstrip (rules[i]);
+            if (!rules[i][0])
+                continue;
+            if (!trace_filter_parse_rule (filter, rules[i], error)) {
+                g_strfreev (rules);
+                trace_filter_free (filter);
+                return FALSE;
+            }
+        }
+        g_strfreev (rules);
+    }
+
+    G_LOCK (traces_filter);
+    old = traces_filter;
+    g_atomic_pointer_set (&traces_filter, filter);
+    G_UNLOCK (traces_filter);
+
+    if (old)
+        trace_filter_free (old);
+    return TRUE;
+}
+
+gchar *
+qmi_utils_get_traces_filter (void)
+{
+    gchar *str = NULL;
+
+    G_LOCK (traces_filter);
+    if (traces_filter)
+        str = g_strdup (traces_filter->str);
+    G_UNLOCK (traces_filter);
+
+    return str;
+}
+
+guint8
+__qmi_utils_get_traces_filter_kinds (guint8  service,
+                                     guint16 message_id)
+{
+    guint8  kinds;
+    GArray *messages;
+
+    /* No filter, no lock */
+    if (!g_atomic_pointer_get (&traces_filter))
+        return __QMI_TRACE_KIND_ALL;
+
+    G_LOCK (traces_filter);
+    if (!traces_filter) {
+        G_UNLOCK (traces_filter);
+        return __QMI_TRACE_KIND_ALL;
+    }
+
+    kinds = traces_filter->service_kinds[service];
+    messages = traces_filter->messages[service];
+    if (messages) {
+        guint lo = 0;
+        guint hi = messages->len;
+
+        while (lo < hi) {
+            const TraceFilterMessage *entry;
+            guint                     mid;
+
+            mid = (lo + hi) / 2;
+            entry = &g_array_index (messages, TraceFilterMessage, mid);
+            if (entry->message_id == message_id) {
+                kinds |= entry->kinds;
+                break;
+            }
+            if (entry->message_id < message_id)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+    }
+    G_UNLOCK (traces_filter);
+
+    return kinds;
+}
@@ -74,6 +74,44 @@ gboolean qmi_utils_get_traces_enabled (void);
  */
 void qmi_utils_set_traces_enabled (gboolean enabled);
 
+/**
+ * qmi_utils_set_traces_filter:
+ * @filter: (nullable): the filter rules, or %NULL to trace every message.
+ * @error: Return location for error or %NULL.
+ *
+ * Limits the messages traced (see qmi_utils_set_traces_enabled(), as well as
+ * qmi_device_set_trace_ring_size()) to those matching any of the given rules.
+ * Messages filtered out are neither copied nor formatted.
+ *
+ * The rules are separated by commas, each one given as
+ * <literal>SERVICE[:MESSAGE][/KIND[+KIND...]]</literal>, where SERVICE is
+ * a service name (e.g. "wds") or number, MESSAGE a message id and KIND one of
+ * "request", "response", "indication" or "error" (responses with a failed
+ * result). A rule without message id applies to every message of the service,
+ * one without kinds to every request, response and indication.
+ *
+ * For example, "wds:0x0022/indication,nas/error" traces WDS packet service
+ * status indications and every failed NAS response.
+ *
+ * Returns: %TRUE if the filter is set, %FALSE if @error is set.
+ *
+ * Since: 1.28
+ */
+gboolean qmi_utils_set_traces_filter (const gchar  *filter,
+                                      GError      **error);
+
+/**
+ * qmi_utils_get_traces_filter:
+ *
+ * Gets the filter rules set with qmi_utils_set_traces_filter().
+ *
+ * Returns: (transfer full) (nullable): the filter rules, or %NULL if every
+ * message is traced. The returned value should be freed with g_free().
+ *
+ * Since: 1.28
+ */
+gchar *qmi_utils_get_traces_filter (void);
+
 G_END_DECLS
 
 #endif /* _LIBQMI_GLIB_QMI_UTILS_H_ */
@@ -0,0 +1,200 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+
+/*
+ * libqmi-glib -- GLib/GIO based library to control QMI devices
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2020 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+#include "qmi-worker.h"
+
+struct _QmiWorker {
+    /* Protected by the pool lock */
+    guint ref_count;
+
+    GMainContext *context;
+    GMainLoop    *loop;
+};
+
+/* Workers with at least one reference; the pool itself holds none */
+static GMutex     pool_lock;
+static GPtrArray *pool;
+
+/*****************************************************************************/
+
+static gpointer
+worker_thread (QmiWorker *self)
+{
+    g_main_context_push_thread_default (self->context);
+    g_main_loop_run (self->loop);
+    g_main_context_pop_thread_default (self->context);
+
+    /* Last reference gone, nobody else can reach the worker */
+    g_main_loop_unref (self->loop);
+    g_main_context_unref (self->context);
+    g_slice_free (QmiWorker, self);
+    return NULL;
+}
+
+static QmiWorker *
+worker_new (void)
+{
+    QmiWorker *self;
+
+    self = g_slice_new0 (QmiWorker);
+    self->context = g_main_context_new ();
+    self->loop = g_main_loop_new (self->context, FALSE);
+
+    /* Detached, the thread cleans up after itself once the loop is quit, so
+     * that the last reference may also be dropped from the worker thread */
+    g_thread_unref (g_thread_new ("qmi-worker", (GThreadFunc)worker_thread, self));
+    return self;
+}
+
+static gboolean
+worker_quit_cb (GMainLoop *loop)
+{
+    g_main_loop_quit (loop);
+    return G_SOURCE_REMOVE;
+}
+
+QmiWorker *
+__qmi_worker_pool_get (void)
+{
+    QmiWorker *self = NULL;
+    guint      i;
+
+    g_mutex_lock (&pool_lock);
+    {
+        if (!pool)
+            pool = g_ptr_array_new ();
+
+        if (pool->len < g_get_num_processors ()) {
+            self = worker_new ();
+            g_ptr_array_add (pool, self);
+        } else {
+            for (i = 0; i < pool->len; i++) {
+                QmiWorker *worker = g_ptr_array_index (pool, i);
+
+                if (!self || worker->ref_count < self->ref_count)
+                    self = worker;
+            }
+        }
+        self->ref_count++;
+    }
+    g_mutex_unlock (&pool_lock);
+
+    return self;
+}
+
+QmiWorker *
+__qmi_worker_new (void)
+{
+    QmiWorker *self;
+
+    self = worker_new ();
+    self->ref_count = 1;
+    return self;
+}
+
+QmiWorker *
+__qmi_worker_ref (QmiWorker *self)
+{
+    g_mutex_lock (&pool_lock);
+    g_assert (self->ref_count > 0);
+    self->ref_count++;
+    g_mutex_unlock (&pool_lock);
+    return self;
+}
+
+void
+__qmi_worker_unref (QmiWorker *self)
+{
+    gboolean last;
+
+    g_mutex_lock (&pool_lock);
+    {
+        g_assert (self->ref_count > 0);
+        last = (--self->ref_count == 0);
+        if (last && pool)
+            g_ptr_array_remove_fast (pool, self);
+    }
+    g_mutex_unlock (&pool_lock);
+
+    /* Quit from within the loop, which may not even be running yet */
+    if (last)
+        g_main_context_invoke (self->context, (GSourceFunc)worker_quit_cb, self->loop);
+}
+
+GMainContext *
+__qmi_worker_peek_context (QmiWorker *self)
+{
+    return self->context;
+}
+
+/*****************************************************************************/
+
+typedef struct {
+    GSourceFunc func;
+    gpointer    user_data;
+    GMutex      mutex;
+    GCond       cond;
+    gboolean    done;
+} InvokeSyncContext;
+
+static gboolean
+invoke_sync_cb (InvokeSyncContext *ctx)
+{
+    ctx->func (ctx->user_data);
+
+    g_mutex_lock (&ctx->mutex);
+    ctx->done = TRUE;
+    g_cond_signal (&ctx->cond);
+    g_mutex_unlock (&ctx->mutex);
+    return G_SOURCE_REMOVE;
+}
+
+void
+__qmi_worker_invoke_sync (QmiWorker   *self,
+                          GSourceFunc  func,
+                          gpointer     user_data)
+{
+    InvokeSyncContext ctx = { func, user_data };
+
+    if (g_main_context_is_owner (self->context)) {
+        func (user_data);
+        return;
+    }
+
+    g_mutex_init (&ctx.mutex);
+    g_cond_init (&ctx.cond);
+
+    g_main_context_invoke_full (self->context,
+                                G_PRIORITY_HIGH,
+                                (GSourceFunc)invoke_sync_cb,
+                                &ctx,
+                                NULL);
+
+    g_mutex_lock (&ctx.mutex);
+    while (!ctx.done)
+        g_cond_wait (&ctx.cond, &ctx.mutex);
+    g_mutex_unlock (&ctx.mutex);
+
+    g_mutex_clear (&ctx.mutex);
+    g_cond_clear (&ctx.cond);
+}
@@ -0,0 +1,74 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+
+/*
+ * libqmi-glib -- GLib/GIO based library to control QMI devices
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2020 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+#ifndef _LIBQMI_GLIB_QMI_WORKER_H_
+#define _LIBQMI_GLIB_QMI_WORKER_H_
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+#if !defined (LIBQMI_GLIB_COMPILATION)
+# error private worker threads
+#endif
+
+/*
+ * I/O worker threads, each one running its own main context. Devices opened
+ * with QMI_DEVICE_OPEN_FLAGS_WORKER_THREAD get one of the workers of a
+ * process-wide pool, sized to the number of processors, and do their reads
+ * and framing there instead of in the context of the caller. Each device is
+ * given the worker with the fewest users. The proxy may also run each device
+ * in a dedicated worker, outside of the pool.
+ */
+
+typedef struct _QmiWorker QmiWorker;
+
+/* Get a new reference to the least used worker of the pool, starting a new
+ * one if the pool is not full yet */
+G_GNUC_INTERNAL
+QmiWorker *__qmi_worker_pool_get (void);
+
+/* Start a new worker of its own, not shared with anyone through the pool */
+G_GNUC_INTERNAL
+QmiWorker *__qmi_worker_new (void);
+
+G_GNUC_INTERNAL
+QmiWorker *__qmi_worker_ref (QmiWorker *self);
+
+/* The worker thread exits when the last reference is dropped */
+G_GNUC_INTERNAL
+void __qmi_worker_unref (QmiWorker *self);
+
+G_GNUC_INTERNAL
+GMainContext *__qmi_worker_peek_context (QmiWorker *self);
+
+/* Run @func in the worker thread and wait for it to return. If called from
+ * the worker thread itself, @func is run right away. */
+G_GNUC_INTERNAL
+void __qmi_worker_invoke_sync (QmiWorker   *self,
+                               GSourceFunc  func,
+                               gpointer     user_data);
+
+G_END_DECLS
+
+#endif /* _LIBQMI_GLIB_QMI_WORKER_H_ */
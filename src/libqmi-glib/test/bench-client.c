@@ -0,0 +1,897 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2020 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+/*
+ * QmiClient throughput regression suite: a WDS client sends requests, with a
+ * fixed number of them in flight, to the scripted responder of a
+ * TestPortContext, which answers them after a set delay and also broadcasts
+ * bursts of indications.
+ *
+ * By default the device talks to the port context directly, as in the unit
+ * tests; with --proxy it goes through a qmi-proxy running in its own thread,
+ * which opens the port context pseudo-terminal as if it were a cdc-wdm port.
+ * The proxy binds the same abstract socket as the system qmi-proxy, so that
+ * one must not be running, and the same privileges are required.
+ *
+ * Reported: requests per second, request latency percentiles and indication
+ * throughput. Results can be saved to a key file, and compared against a
+ * previously saved one, failing if any of them got worse than the given
+ * threshold:
+ *
+ *   bench-client --save=baseline.ini
+ *   ... change the endpoint or device code ...
+ *   bench-client --baseline=baseline.ini --threshold=10
+ */
+
+#include <config.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <glib-object.h>
+#include <gio/gio.h>
+#include <libqmi-glib.h>
+
+#include "test-port-context.h"
+
+/* Indication unknown to the WDS client, so only the device signal sees it */
+#define BENCH_INDICATION_MESSAGE_ID 0x5A5A
+
+#define REQUEST_TIMEOUT     10
+#define BURST_TIMEOUT       10
+#define PROXY_OPEN_TIMEOUT  10
+
+#if defined HAVE_QMI_MESSAGE_WDS_GET_PACKET_SERVICE_STATUS
+
+/*****************************************************************************/
+/* Options */
+
+static gboolean  proxy_flag;
+static gint      duration          = 5;
+static gint      in_flight         = 8;
+static gint      reply_delay_ms;
+static gchar    *mix_str;
+static gint      burst_size        = 1000;
+static gint      bursts            = 5;
+static gchar    *save_path;
+static gchar    *baseline_path;
+static gint      threshold         = 10;
+
+static GOptionEntry main_entries[] = {
+    { "proxy", 'p', 0, G_OPTION_ARG_NONE, &proxy_flag,
+      "Go through a qmi-proxy instead of talking to the simulated device directly",
+      NULL
+    },
+    { "duration", 'd', 0, G_OPTION_ARG_INT, &duration,
+      "Length of the request measurement, in seconds (default 5)",
+      "[SECONDS]"
+    },
+    { "in-flight", 'n', 0, G_OPTION_ARG_INT, &in_flight,
+      "Number of requests kept in flight (default 8)",
+      "[N]"
+    },
+    { "delay", 0, 0, G_OPTION_ARG_INT, &reply_delay_ms,
+      "Delay before the simulated device answers each request, in ms (default 0)",
+      "[MS]"
+    },
+    { "mix", 'm', 0, G_OPTION_ARG_STRING, &mix_str,
+      "Relative weights of Get Packet Service Status, Get Channel Rates and failed Get Data Bearer Technology requests (default 8,1,1)",
+      "[N,N,N]"
+    },
+    { "burst-size", 'b', 0, G_OPTION_ARG_INT, &burst_size,
+      "Number of indications in each burst (default 1000)",
+      "[N]"
+    },
+    { "bursts", 0, 0, G_OPTION_ARG_INT, &bursts,
+      "Number of indication bursts (default 5)",
+      "[N]"
+    },
+    { "save", 's', 0, G_OPTION_ARG_FILENAME, &save_path,
+      "Save the results to this key file",
+      "[PATH]"
+    },
+    { "baseline", 0, 0, G_OPTION_ARG_FILENAME, &baseline_path,
+      "Compare the results against those saved in this key file, and fail on regressions",
+      "[PATH]"
+    },
+    { "threshold", 't', 0, G_OPTION_ARG_INT, &threshold,
+      "Regression allowed against the baseline, in percent (default 10)",
+      "[PERCENT]"
+    },
+    { NULL }
+};
+
+/*****************************************************************************/
+/* Request mix */
+
+typedef enum {
+    REQUEST_KIND_PACKET_SERVICE_STATUS,
+    REQUEST_KIND_CHANNEL_RATES,
+    REQUEST_KIND_DATA_BEARER_TECHNOLOGY,
+    REQUEST_KIND_LAST
+} RequestKind;
+
+static guint mix[REQUEST_KIND_LAST] = { 8, 1, 1 };
+static guint mix_total;
+
+static gboolean
+parse_mix (GError **error)
+{
+    gchar **weights;
+    guint   i;
+
+    if (mix_str) {
+        weights = g_strsplit (mix_str, ",", -1);
+        if (g_strv_length (weights) != REQUEST_KIND_LAST) {
+            g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                         "request mix must have %u weights", REQUEST_KIND_LAST);
+            g_strfreev (weights);
+            return FALSE;
+        }
+        for (i = 0; i < REQUEST_KIND_LAST; i++)
+            mix[i] = (guint) atoi (weights[i]);
+        g_strfreev (weights);
+    }
+
+#if !defined HAVE_QMI_MESSAGE_WDS_GET_CHANNEL_RATES
+    mix[REQUEST_KIND_CHANNEL_RATES] = 0;
+#endif
+#if !defined HAVE_QMI_MESSAGE_WDS_GET_DATA_BEARER_TECHNOLOGY
+    mix[REQUEST_KIND_DATA_BEARER_TECHNOLOGY] = 0;
+#endif
+
+    for (mix_total = 0, i = 0; i < REQUEST_KIND_LAST; i++)
+        mix_total += mix[i];
+    if (!mix_total) {
+        g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                     "request mix is empty");
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static void
+setup_replies (TestPortContext *ctx)
+{
+    /* Connected */
+    static const guint8 connection_status[] = { 0x02 };
+    /* TX/RX rate and max TX/RX rate, in bps */
+    static const guint8 channel_rates[] = {
+        0x00, 0x24, 0xF4, 0x00,
+        0x00, 0x48, 0xE8, 0x01,
+        0x00, 0x24, 0xF4, 0x00,
+        0x00, 0x48, 0xE8, 0x01,
+    };
+    /* Last bearer: LTE */
+    static const guint8 last_bearer[] = { 0x0B };
+
+    test_port_context_add_reply (ctx, QMI_SERVICE_WDS, 0x0022, QMI_PROTOCOL_ERROR_NONE,
+                                 0x01, connection_status, sizeof (connection_status));
+    test_port_context_add_reply (ctx, QMI_SERVICE_WDS, 0x0023, QMI_PROTOCOL_ERROR_NONE,
+                                 0x01, channel_rates, sizeof (channel_rates));
+    test_port_context_add_reply (ctx, QMI_SERVICE_WDS, 0x0037, QMI_PROTOCOL_ERROR_OUT_OF_CALL,
+                                 0x10, last_bearer, sizeof (last_bearer));
+}
+
+/*****************************************************************************/
+/* Proxy thread */
+
+typedef struct {
+    GThread   *thread;
+    GMainLoop *loop;
+    GMutex     ready_mutex;
+    GCond      ready_cond;
+    gboolean   ready;
+    GError    *error;
+} ProxyThread;
+
+static gpointer
+proxy_thread_func (ProxyThread *pt)
+{
+    GMainContext *context;
+    QmiProxy     *proxy;
+
+    context = g_main_context_new ();
+    g_main_context_push_thread_default (context);
+
+    proxy = qmi_proxy_new (&pt->error);
+    if (proxy)
+        pt->loop = g_main_loop_new (context, FALSE);
+
+    g_mutex_lock (&pt->ready_mutex);
+    pt->ready = TRUE;
+    g_cond_signal (&pt->ready_cond);
+    g_mutex_unlock (&pt->ready_mutex);
+
+    if (proxy) {
+        g_main_loop_run (pt->loop);
+        g_object_unref (proxy);
+    }
+
+    g_main_context_pop_thread_default (context);
+    g_main_context_unref (context);
+    return NULL;
+}
+
+static void
+proxy_thread_free (ProxyThread *pt)
+{
+    if (pt->loop)
+        g_main_loop_quit (pt->loop);
+    g_thread_join (pt->thread);
+    if (pt->loop)
+        g_main_loop_unref (pt->loop);
+    g_clear_error (&pt->error);
+    g_cond_clear (&pt->ready_cond);
+    g_mutex_clear (&pt->ready_mutex);
+    g_slice_free (ProxyThread, pt);
+}
+
+static ProxyThread *
+proxy_thread_new (GError **error)
+{
+    ProxyThread *pt;
+
+    pt = g_slice_new0 (ProxyThread);
+    g_mutex_init (&pt->ready_mutex);
+    g_cond_init (&pt->ready_cond);
+    pt->thread = g_thread_new ("qmi-proxy", (GThreadFunc) proxy_thread_func, pt);
+
+    /* Wait until the proxy is listening */
+    g_mutex_lock (&pt->ready_mutex);
+    while (!pt->ready)
+        g_cond_wait (&pt->ready_cond, &pt->ready_mutex);
+    g_mutex_unlock (&pt->ready_mutex);
+
+    if (pt->error) {
+        g_propagate_prefixed_error (error, g_steal_pointer (&pt->error),
+                                    "couldn't start proxy (is qmi-proxy already running?): ");
+        proxy_thread_free (pt);
+        return NULL;
+    }
+    return pt;
+}
+
+/*****************************************************************************/
+/* Bench */
+
+typedef struct {
+    GMainLoop       *loop;
+    TestPortContext *ctx;
+    QmiDevice       *device;
+    QmiClient       *client;
+    GError          *error;
+
+    /* Requests */
+    gboolean         sending;
+    guint            next_kind;
+    guint            requests_in_flight;
+    guint64          requests_done;
+    guint64          requests_failed;
+    GArray          *request_latencies;
+
+    /* Indications */
+    gulong           indication_id;
+    guint            burst_expected;
+    guint            burst_received;
+    gint64           burst_last;
+    GArray          *indication_delays;
+} Bench;
+
+typedef struct {
+    Bench       *bench;
+    RequestKind  kind;
+    gint64       start;
+} Request;
+
+static void
+bench_step_done (Bench  *bench,
+                 GError *error)
+{
+    if (error && !bench->error)
+        bench->error = error;
+    else if (error)
+        g_error_free (error);
+    g_main_loop_quit (bench->loop);
+}
+
+static void send_request (Bench *bench);
+
+static void
+request_done (Request  *request,
+              gboolean  success)
+{
+    Bench  *bench = request->bench;
+    gint64  latency;
+
+    bench->requests_in_flight--;
+    if (!success)
+        bench->requests_failed++;
+    else {
+        latency = g_get_monotonic_time () - request->start;
+        g_array_append_val (bench->request_latencies, latency);
+        bench->requests_done++;
+    }
+    g_slice_free (Request, request);
+
+    if (bench->sending)
+        send_request (bench);
+    else if (!bench->requests_in_flight)
+        g_main_loop_quit (bench->loop);
+}
+
+static void
+get_packet_service_status_ready (QmiClientWds *client,
+                                 GAsyncResult *res,
+                                 Request      *request)
+{
+    QmiMessageWdsGetPacketServiceStatusOutput *output;
+    gboolean                                   success = FALSE;
+
+    output = qmi_client_wds_get_packet_service_status_finish (client, res, NULL);
+    if (output) {
+        success = qmi_message_wds_get_packet_service_status_output_get_result (output, NULL);
+        qmi_message_wds_get_packet_service_status_output_unref (output);
+    }
+    request_done (request, success);
+}
+
+#if defined HAVE_QMI_MESSAGE_WDS_GET_CHANNEL_RATES
+static void
+get_channel_rates_ready (QmiClientWds *client,
+                         GAsyncResult *res,
+                         Request      *request)
+{
+    QmiMessageWdsGetChannelRatesOutput *output;
+    gboolean                            success = FALSE;
+
+    output = qmi_client_wds_get_channel_rates_finish (client, res, NULL);
+    if (output) {
+        success = qmi_message_wds_get_channel_rates_output_get_result (output, NULL);
+        qmi_message_wds_get_channel_rates_output_unref (output);
+    }
+    request_done (request, success);
+}
+#endif
+
+#if defined HAVE_QMI_MESSAGE_WDS_GET_DATA_BEARER_TECHNOLOGY
+static void
+get_data_bearer_technology_ready (QmiClientWds *client,
+                                  GAsyncResult *res,
+                                  Request      *request)
+{
+    QmiMessageWdsGetDataBearerTechnologyOutput *output;
+    GError                                     *error = NULL;
+    gboolean                                    success = FALSE;
+
+    /* Scripted to fail with an out of call error */
+    output = qmi_client_wds_get_data_bearer_technology_finish (client, res, NULL);
+    if (output) {
+        success = (!qmi_message_wds_get_data_bearer_technology_output_get_result (output, &error) &&
+                   g_error_matches (error, QMI_PROTOCOL_ERROR, QMI_PROTOCOL_ERROR_OUT_OF_CALL));
+        g_clear_error (&error);
+        qmi_message_wds_get_data_bearer_technology_output_unref (output);
+    }
+    request_done (request, success);
+}
+#endif
+
+static RequestKind
+next_request_kind (Bench *bench)
+{
+    guint slot;
+    guint i;
+
+    /* Deterministic weighted round robin */
+    slot = bench->next_kind++ % mix_total;
+    for (i = 0; i < REQUEST_KIND_LAST; i++) {
+        if (slot < mix[i])
+            return (RequestKind) i;
+        slot -= mix[i];
+    }
+    g_assert_not_reached ();
+}
+
+static void
+send_request (Bench *bench)
+{
+    Request *request;
+
+    request = g_slice_new (Request);
+    request->bench = bench;
+    request->kind = next_request_kind (bench);
+    request->start = g_get_monotonic_time ();
+    bench->requests_in_flight++;
+
+    switch (request->kind) {
+    case REQUEST_KIND_PACKET_SERVICE_STATUS:
+        qmi_client_wds_get_packet_service_status (QMI_CLIENT_WDS (bench->client), NULL, REQUEST_TIMEOUT, NULL,
+                                                  (GAsyncReadyCallback) get_packet_service_status_ready,
+                                                  request);
+        return;
+#if defined HAVE_QMI_MESSAGE_WDS_GET_CHANNEL_RATES
+    case REQUEST_KIND_CHANNEL_RATES:
+        qmi_client_wds_get_channel_rates (QMI_CLIENT_WDS (bench->client), NULL, REQUEST_TIMEOUT, NULL,
+                                          (GAsyncReadyCallback) get_channel_rates_ready,
+                                          request);
+        return;
+#endif
+#if defined HAVE_QMI_MESSAGE_WDS_GET_DATA_BEARER_TECHNOLOGY
+    case REQUEST_KIND_DATA_BEARER_TECHNOLOGY:
+        qmi_client_wds_get_data_bearer_technology (QMI_CLIENT_WDS (bench->client), NULL, REQUEST_TIMEOUT, NULL,
+                                                   (GAsyncReadyCallback) get_data_bearer_technology_ready,
+                                                   request);
+        return;
+#endif
+    default:
+        g_assert_not_reached ();
+    }
+}
+
+static gboolean
+requests_done_cb (Bench *bench)
+{
+    /* Stop sending, and wait for the ones in flight */
+    bench->sending = FALSE;
+    if (!bench->requests_in_flight)
+        g_main_loop_quit (bench->loop);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+indication_cb (QmiDevice  *device,
+               QmiMessage *message,
+               Bench      *bench)
+{
+    gsize   init_offset;
+    gsize   offset = 0;
+    guint64 sent;
+    gint64  now;
+    gint64  delay;
+
+    if (qmi_message_get_service (message) != QMI_SERVICE_WDS ||
+        qmi_message_get_message_id (message) != BENCH_INDICATION_MESSAGE_ID ||
+        bench->burst_received >= bench->burst_expected)
+        return;
+
+    if ((init_offset = qmi_message_tlv_read_init (message, TEST_PORT_CONTEXT_INDICATION_TLV_TIME, NULL, NULL)) == 0 ||
+        !qmi_message_tlv_read_guint64 (message, init_offset, &offset, QMI_ENDIAN_LITTLE, &sent, NULL))
+        return;
+
+    now = g_get_monotonic_time ();
+    delay = now - (gint64) sent;
+    g_array_append_val (bench->indication_delays, delay);
+    bench->burst_last = now;
+
+    if (++bench->burst_received == bench->burst_expected)
+        g_main_loop_quit (bench->loop);
+}
+
+static gboolean
+burst_timeout_cb (Bench *bench)
+{
+    g_main_loop_quit (bench->loop);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+allocate_client_ready (QmiDevice    *device,
+                       GAsyncResult *res,
+                       Bench        *bench)
+{
+    GError *error = NULL;
+
+    bench->client = qmi_device_allocate_client_finish (device, res, &error);
+    bench_step_done (bench, error);
+}
+
+static void
+device_open_ready (QmiDevice    *device,
+                   GAsyncResult *res,
+                   Bench        *bench)
+{
+    GError *error = NULL;
+
+    qmi_device_open_finish (device, res, &error);
+    bench_step_done (bench, error);
+}
+
+static void
+device_new_ready (GObject      *source,
+                  GAsyncResult *res,
+                  Bench        *bench)
+{
+    GError *error = NULL;
+
+    bench->device = qmi_device_new_finish (res, &error);
+    bench_step_done (bench, error);
+}
+
+static void
+device_release_client_ready (QmiDevice    *device,
+                             GAsyncResult *res,
+                             Bench        *bench)
+{
+    qmi_device_release_client_finish (device, res, NULL);
+    g_main_loop_quit (bench->loop);
+}
+
+static void
+device_close_ready (QmiDevice    *device,
+                    GAsyncResult *res,
+                    Bench        *bench)
+{
+    qmi_device_close_finish (device, res, NULL);
+    g_main_loop_quit (bench->loop);
+}
+
+/*****************************************************************************/
+/* Report */
+
+typedef struct {
+    const gchar *key;
+    gboolean     higher_is_better;
+    gdouble      value;
+} Result;
+
+enum {
+    RESULT_REQUESTS_PER_SECOND,
+    RESULT_REQUEST_LATENCY_P50,
+    RESULT_REQUEST_LATENCY_P90,
+    RESULT_REQUEST_LATENCY_P99,
+    RESULT_INDICATIONS_PER_SECOND,
+    RESULT_INDICATION_DELAY_P99,
+    RESULT_LAST
+};
+
+static Result results[RESULT_LAST] = {
+    { "requests-per-second",    TRUE,  0.0 },
+    { "request-latency-p50",    FALSE, 0.0 },
+    { "request-latency-p90",    FALSE, 0.0 },
+    { "request-latency-p99",    FALSE, 0.0 },
+    { "indications-per-second", TRUE,  0.0 },
+    { "indication-delay-p99",   FALSE, 0.0 },
+};
+
+static gint
+compare_gint64 (gconstpointer a,
+                gconstpointer b)
+{
+    gint64 va = *((const gint64 *) a);
+    gint64 vb = *((const gint64 *) b);
+
+    return (va > vb) - (va < vb);
+}
+
+static gint64
+percentile (GArray *samples,
+            guint   pct)
+{
+    if (!samples->len)
+        return 0;
+    return g_array_index (samples, gint64, (guint) (((guint64) (samples->len - 1) * pct) / 100));
+}
+
+static void
+print_distribution (const gchar *name,
+                    GArray      *samples)
+{
+    if (!samples->len) {
+        g_print ("%-20s no samples\n", name);
+        return;
+    }
+
+    g_array_sort (samples, compare_gint64);
+    g_print ("%-20s min %" G_GINT64_FORMAT ", p50 %" G_GINT64_FORMAT ", p90 %" G_GINT64_FORMAT
+             ", p99 %" G_GINT64_FORMAT ", max %" G_GINT64_FORMAT " (us)\n",
+             name,
+             percentile (samples, 0),
+             percentile (samples, 50),
+             percentile (samples, 90),
+             percentile (samples, 99),
+             percentile (samples, 100));
+}
+
+static gboolean
+save_results (const gchar  *group,
+              GError      **error)
+{
+    GKeyFile *key_file;
+    gboolean  success;
+    guint     i;
+
+    /* Keep the results of the other mode, if any */
+    key_file = g_key_file_new ();
+    g_key_file_load_from_file (key_file, save_path, G_KEY_FILE_NONE, NULL);
+    for (i = 0; i < RESULT_LAST; i++)
+        g_key_file_set_double (key_file, group, results[i].key, results[i].value);
+    success = g_key_file_save_to_file (key_file, save_path, error);
+    g_key_file_unref (key_file);
+    return success;
+}
+
+static gboolean
+compare_results (const gchar  *group,
+                 GError      **error)
+{
+    GKeyFile *key_file;
+    guint     regressions = 0;
+    guint     i;
+
+    key_file = g_key_file_new ();
+    if (!g_key_file_load_from_file (key_file, baseline_path, G_KEY_FILE_NONE, error)) {
+        g_key_file_unref (key_file);
+        return FALSE;
+    }
+
+    for (i = 0; i < RESULT_LAST; i++) {
+        gdouble  baseline;
+        gdouble  change;
+        GError  *inner_error = NULL;
+
+        baseline = g_key_file_get_double (key_file, group, results[i].key, &inner_error);
+        if (inner_error) {
+            g_print ("%-24s no baseline\n", results[i].key);
+            g_error_free (inner_error);
+            continue;
+        }
+        if (baseline <= 0.0)
+            continue;
+
+        /* Positive change is always worse */
+        change = 100.0 * (results[i].value - baseline) / baseline;
+        if (results[i].higher_is_better)
+            change = -change;
+
+        g_print ("%-24s %.1f (baseline %.1f, %+.1f%% worse)%s\n",
+                 results[i].key, results[i].value, baseline, change,
+                 change > threshold ? " REGRESSION" : "");
+        if (change > threshold)
+            regressions++;
+    }
+    g_key_file_unref (key_file);
+
+    if (regressions) {
+        g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                     "%u results regressed more than %d%% against the baseline",
+                     regressions, threshold);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+/*****************************************************************************/
+
+int main (int argc, char **argv)
+{
+    GOptionContext *context;
+    GError         *error = NULL;
+    ProxyThread    *pt = NULL;
+    Bench           bench;
+    gchar          *name;
+    const gchar    *device_path;
+    GFile          *file;
+    gint64          start;
+    gint64          elapsed;
+    gint64          burst_time = 0;
+    guint64         indications_received = 0;
+    guint64         indications_expected = 0;
+    const gchar    *group;
+    gint            i;
+    int             status = EXIT_SUCCESS;
+
+    context = g_option_context_new ("- QmiClient throughput regression suite");
+    g_option_context_add_main_entries (context, main_entries, NULL);
+    if (!g_option_context_parse (context, &argc, &argv, &error)) {
+        g_printerr ("error: %s\n", error->message);
+        exit (EXIT_FAILURE);
+    }
+    g_option_context_free (context);
+
+    if (duration <= 0 || in_flight <= 0 || reply_delay_ms < 0 || burst_size < 0 || bursts < 0 || threshold < 0) {
+        g_printerr ("error: invalid options\n");
+        exit (EXIT_FAILURE);
+    }
+    if (!parse_mix (&error)) {
+        g_printerr ("error: %s\n", error->message);
+        exit (EXIT_FAILURE);
+    }
+
+    memset (&bench, 0, sizeof (bench));
+    bench.loop = g_main_loop_new (NULL, FALSE);
+    bench.request_latencies = g_array_new (FALSE, FALSE, sizeof (gint64));
+    bench.indication_delays = g_array_new (FALSE, FALSE, sizeof (gint64));
+
+    /* Simulated device */
+    name = g_strdup_printf ("/dev/qmi-bench%08lu", (gulong) getpid ());
+    bench.ctx = test_port_context_new (name);
+    setup_replies (bench.ctx);
+    test_port_context_set_reply_delay (bench.ctx, (guint) reply_delay_ms);
+    device_path = name;
+    if (proxy_flag) {
+        device_path = test_port_context_open_tty (bench.ctx, &error);
+        if (!device_path) {
+            g_printerr ("error: %s\n", error->message);
+            exit (EXIT_FAILURE);
+        }
+        pt = proxy_thread_new (&error);
+        if (!pt) {
+            g_printerr ("error: %s\n", error->message);
+            exit (EXIT_FAILURE);
+        }
+    }
+    test_port_context_start (bench.ctx);
+
+    group = proxy_flag ? "proxy" : "direct";
+    g_print ("%s, %d requests in flight, mix %u,%u,%u, %d ms reply delay, %d s; %d bursts of %d indications\n",
+             group, in_flight,
+             mix[REQUEST_KIND_PACKET_SERVICE_STATUS],
+             mix[REQUEST_KIND_CHANNEL_RATES],
+             mix[REQUEST_KIND_DATA_BEARER_TECHNOLOGY],
+             reply_delay_ms, duration, bursts, burst_size);
+
+    /* Directly, the port context plays the proxy role itself */
+    file = g_file_new_for_path (device_path);
+    if (proxy_flag)
+        g_async_initable_new_async (QMI_TYPE_DEVICE,
+                                    G_PRIORITY_DEFAULT,
+                                    NULL,
+                                    (GAsyncReadyCallback) device_new_ready,
+                                    &bench,
+                                    QMI_DEVICE_FILE,          file,
+                                    QMI_DEVICE_NO_FILE_CHECK, TRUE,
+                                    NULL);
+    else
+        g_async_initable_new_async (QMI_TYPE_DEVICE,
+                                    G_PRIORITY_DEFAULT,
+                                    NULL,
+                                    (GAsyncReadyCallback) device_new_ready,
+                                    &bench,
+                                    QMI_DEVICE_FILE,          file,
+                                    QMI_DEVICE_NO_FILE_CHECK, TRUE,
+                                    QMI_DEVICE_PROXY_PATH,    name,
+                                    NULL);
+    g_object_unref (file);
+    g_main_loop_run (bench.loop);
+    if (bench.error)
+        goto out;
+
+    qmi_device_open (bench.device, QMI_DEVICE_OPEN_FLAGS_PROXY, PROXY_OPEN_TIMEOUT, NULL,
+                     (GAsyncReadyCallback) device_open_ready,
+                     &bench);
+    g_main_loop_run (bench.loop);
+    if (bench.error)
+        goto out;
+
+    qmi_device_allocate_client (bench.device, QMI_SERVICE_WDS, QMI_CID_NONE, REQUEST_TIMEOUT, NULL,
+                                (GAsyncReadyCallback) allocate_client_ready,
+                                &bench);
+    g_main_loop_run (bench.loop);
+    if (bench.error)
+        goto out;
+
+    /* Requests, with a fixed number of them in flight */
+    bench.sending = TRUE;
+    start = g_get_monotonic_time ();
+    for (i = 0; i < in_flight; i++)
+        send_request (&bench);
+    g_timeout_add_seconds (duration, (GSourceFunc) requests_done_cb, &bench);
+    g_main_loop_run (bench.loop);
+    elapsed = g_get_monotonic_time () - start;
+
+    /* Indication bursts */
+    bench.indication_id = g_signal_connect (bench.device,
+                                            QMI_DEVICE_SIGNAL_INDICATION,
+                                            G_CALLBACK (indication_cb),
+                                            &bench);
+    for (i = 0; i < bursts && burst_size > 0; i++) {
+        guint  timeout_id;
+        gint64 burst_start;
+
+        bench.burst_expected = (guint) burst_size;
+        bench.burst_received = 0;
+        burst_start = bench.burst_last = g_get_monotonic_time ();
+
+        test_port_context_send_indications (bench.ctx, QMI_SERVICE_WDS, BENCH_INDICATION_MESSAGE_ID, (guint) burst_size);
+        timeout_id = g_timeout_add_seconds (BURST_TIMEOUT, (GSourceFunc) burst_timeout_cb, &bench);
+        g_main_loop_run (bench.loop);
+        if (bench.burst_received == bench.burst_expected)
+            g_source_remove (timeout_id);
+
+        burst_time += bench.burst_last - burst_start;
+        indications_received += bench.burst_received;
+        indications_expected += bench.burst_expected;
+    }
+    g_signal_handler_disconnect (bench.device, bench.indication_id);
+
+    /* Report */
+    g_array_sort (bench.request_latencies, compare_gint64);
+    g_array_sort (bench.indication_delays, compare_gint64);
+    results[RESULT_REQUESTS_PER_SECOND].value = (gdouble) bench.requests_done * G_USEC_PER_SEC / (gdouble) MAX (elapsed, 1);
+    results[RESULT_REQUEST_LATENCY_P50].value = (gdouble) percentile (bench.request_latencies, 50);
+    results[RESULT_REQUEST_LATENCY_P90].value = (gdouble) percentile (bench.request_latencies, 90);
+    results[RESULT_REQUEST_LATENCY_P99].value = (gdouble) percentile (bench.request_latencies, 99);
+    results[RESULT_INDICATIONS_PER_SECOND].value = (gdouble) indications_received * G_USEC_PER_SEC / (gdouble) MAX (burst_time, 1);
+    results[RESULT_INDICATION_DELAY_P99].value = (gdouble) percentile (bench.indication_delays, 99);
+
+    g_print ("requests:            %" G_GUINT64_FORMAT " done, %" G_GUINT64_FORMAT " failed, %.1f/s\n",
+             bench.requests_done, bench.requests_failed, results[RESULT_REQUESTS_PER_SECOND].value);
+    print_distribution ("request latency:", bench.request_latencies);
+    g_print ("indications:         %" G_GUINT64_FORMAT " expected, %" G_GUINT64_FORMAT " received, %.1f/s\n",
+             indications_expected, indications_received, results[RESULT_INDICATIONS_PER_SECOND].value);
+    print_distribution ("indication delay:", bench.indication_delays);
+
+    if (bench.requests_failed || indications_received < indications_expected) {
+        g_printerr ("error: requests failed or indications lost\n");
+        status = EXIT_FAILURE;
+    }
+    if (save_path && !save_results (group, &error)) {
+        g_printerr ("error: couldn't save results: %s\n", error->message);
+        g_clear_error (&error);
+        status = EXIT_FAILURE;
+    }
+    if (baseline_path && !compare_results (group, &error)) {
+        g_printerr ("error: %s\n", error->message);
+        g_clear_error (&error);
+        status = EXIT_FAILURE;
+    }
+
+out:
+    if (bench.error) {
+        g_printerr ("error: %s\n", bench.error->message);
+        g_clear_error (&bench.error);
+        status = EXIT_FAILURE;
+    }
+
+    if (bench.client) {
+        qmi_device_release_client (bench.device, bench.client,
+                                   QMI_DEVICE_RELEASE_CLIENT_FLAGS_RELEASE_CID,
+                                   REQUEST_TIMEOUT, NULL,
+                                   (GAsyncReadyCallback) device_release_client_ready,
+                                   &bench);
+        g_main_loop_run (bench.loop);
+        g_clear_object (&bench.client);
+    }
+    if (bench.device) {
+        qmi_device_close_async (bench.device, REQUEST_TIMEOUT, NULL,
+                                (GAsyncReadyCallback) device_close_ready,
+                                &bench);
+        g_main_loop_run (bench.loop);
+        g_clear_object (&bench.device);
+    }
+
+    if (pt)
+        proxy_thread_free (pt);
+    test_port_context_stop (bench.ctx);
+    test_port_context_free (bench.ctx);
+    g_free (name);
+
+    g_array_unref (bench.request_latencies);
+    g_array_unref (bench.indication_delays);
+    g_main_loop_unref (bench.loop);
+
+    return status;
+}
+
+#else
+
+int main (int argc, char **argv)
+{
+    g_printerr ("error: WDS Get Packet Service Status support not built\n");
+    return EXIT_FAILURE;
+}
+
+#endif /* HAVE_QMI_MESSAGE_WDS_GET_PACKET_SERVICE_STATUS */
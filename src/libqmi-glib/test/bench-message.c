@@ -0,0 +1,671 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2020 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+/*
+ * Message codec benchmark: times message parsing, the TLV reader and writer
+ * families, the generated output parsers and the printable builder on large
+ * messages, reporting throughput and the number of allocations per operation.
+ *
+ *   bench-message [ITERATIONS]
+ *
+ * The generated response/indication parsers are internal to the library, so
+ * they are reached through the public process_indication() client method,
+ * which is where the library itself runs them for indications.
+ */
+
+#include <config.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib-object.h>
+#include <libqmi-glib.h>
+
+#include "test-port-context.h"
+
+#define DEFAULT_ITERATIONS 100000
+
+/*****************************************************************************/
+/* Allocation counting */
+
+static volatile guint64 n_allocations;
+
+#if defined __GLIBC__
+
+/* Every allocation in the process (GLib included) goes through these, the
+ * real allocator is reached through the glibc internal entry points */
+extern void *__libc_malloc  (size_t size);
+extern void *__libc_calloc  (size_t nmemb, size_t size);
+extern void *__libc_realloc (void *ptr, size_t size);
+
+void *
+malloc (size_t size)
+{
+    __sync_fetch_and_add (&n_allocations, 1);
+    return __libc_malloc (size);
+}
+
+void *
+calloc (size_t nmemb,
+        size_t size)
+{
+    __sync_fetch_and_add (&n_allocations, 1);
+    return __libc_calloc (nmemb, size);
+}
+
+void *
+realloc (void   *ptr,
+         size_t  size)
+{
+    __sync_fetch_and_add (&n_allocations, 1);
+    return __libc_realloc (ptr, size);
+}
+
+#define ALLOCATIONS_COUNTED TRUE
+#else
+#define ALLOCATIONS_COUNTED FALSE
+#endif
+
+/*****************************************************************************/
+/* Runner */
+
+typedef void (* BenchFunc) (gconstpointer user_data);
+
+static guint iterations = DEFAULT_ITERATIONS;
+
+static void
+bench_run (const gchar   *name,
+           gsize          bytes_per_op,
+           BenchFunc      func,
+           gconstpointer  user_data)
+{
+    gint64  start;
+    gint64  elapsed;
+    guint64 allocations;
+    gdouble ns_per_op;
+    guint   i;
+
+    /* Warm up caches and any lazily initialized state */
+    for (i = 0; i < iterations / 10 + 1; i++)
+        func (user_data);
+
+    allocations = n_allocations;
+    start = g_get_monotonic_time ();
+    for (i = 0; i < iterations; i++)
+        func (user_data);
+    elapsed = g_get_monotonic_time () - start;
+    allocations = n_allocations - allocations;
+
+    if (elapsed <= 0)
+        elapsed = 1;
+    ns_per_op = (gdouble) elapsed * 1000.0 / (gdouble) iterations;
+
+    g_print ("%-36s %9.1f ns/op %11.0f ops/s %8.1f MB/s",
+             name,
+             ns_per_op,
+             1e9 / ns_per_op,
+             (gdouble) bytes_per_op * 1000.0 / ns_per_op);
+    if (ALLOCATIONS_COUNTED)
+        g_print (" %7.2f allocs/op", (gdouble) allocations / (gdouble) iterations);
+    g_print ("\n");
+}
+
+/*****************************************************************************/
+/* Sample messages */
+
+/* NAS Network Scan response with 8 networks (as in test-generated) */
+static const guint8 nas_network_scan_response[] = {
+    0x01,
+    0x43, 0x01, 0x80, 0x03, 0x01,
+    0x02, 0xFF, 0xFF, 0x21, 0x00, 0x37, 0x01, 0x02,
+    0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x60,
+    0x00, 0x08, 0x00, 0xD6, 0x00, 0x01, 0x00, 0xAA,
+    0x07, 0x76, 0x6F, 0x64, 0x61, 0x20, 0x45, 0x53,
+    0xD6, 0x00, 0x03, 0x00, 0xAA, 0x06, 0x4F, 0x72,
+    0x61, 0x6E, 0x67, 0x65, 0xD6, 0x00, 0x04, 0x00,
+    0xAA, 0x05, 0x59, 0x4F, 0x49, 0x47, 0x4F, 0xD6,
+    0x00, 0x01, 0x00, 0xAA, 0x07, 0x76, 0x6F, 0x64,
+    0x61, 0x20, 0x45, 0x53, 0xD6, 0x00, 0x04, 0x00,
+    0xAA, 0x05, 0x59, 0x4F, 0x49, 0x47, 0x4F, 0xD6,
+    0x00, 0x07, 0x00, 0xAA, 0x08, 0x4D, 0x6F, 0x76,
+    0x69, 0x73, 0x74, 0x61, 0x72, 0xD6, 0x00, 0x07,
+    0x00, 0xAA, 0x08, 0x4D, 0x6F, 0x76, 0x69, 0x73,
+    0x74, 0x61, 0x72, 0xD6, 0x00, 0x03, 0x00, 0xA9,
+    0x00, 0x11, 0x2A, 0x00, 0x08, 0x00, 0xD6, 0x00,
+    0x01, 0x00, 0x04, 0xD6, 0x00, 0x03, 0x00, 0x04,
+    0xD6, 0x00, 0x04, 0x00, 0x05, 0xD6, 0x00, 0x01,
+    0x00, 0x05, 0xD6, 0x00, 0x04, 0x00, 0x04, 0xD6,
+    0x00, 0x07, 0x00, 0x04, 0xD6, 0x00, 0x07, 0x00,
+    0x05, 0xD6, 0x00, 0x03, 0x00, 0x05, 0x12, 0x2A,
+    0x00, 0x08, 0x00, 0xD6, 0x00, 0x01, 0x00, 0x00,
+    0xD6, 0x00, 0x03, 0x00, 0x00, 0xD6, 0x00, 0x04,
+    0x00, 0x00, 0xD6, 0x00, 0x01, 0x00, 0x00, 0xD6,
+    0x00, 0x04, 0x00, 0x00, 0xD6, 0x00, 0x07, 0x00,
+    0x00, 0xD6, 0x00, 0x07, 0x00, 0x00, 0xD6, 0x00,
+    0x03, 0x00, 0x00, 0x13, 0x04, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x14, 0x69, 0x00, 0x08, 0xD6, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0xD6, 0x00, 0x03, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0xD6, 0x00, 0x04, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xD6,
+    0x00, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+#define WDS_PROFILES          16
+#define LOC_SATELLITES_USED   12
+#define LOC_SATELLITES_IN_VIEW 32
+
+static gboolean
+tlv_write_gfloat (QmiMessage  *message,
+                  gfloat       value)
+{
+    union {
+        gfloat  f;
+        guint32 u;
+    } bits;
+
+    bits.f = value;
+    return qmi_message_tlv_write_guint32 (message, QMI_ENDIAN_LITTLE, bits.u, NULL);
+}
+
+static gboolean
+tlv_write_gdouble (QmiMessage  *message,
+                   gdouble      value)
+{
+    union {
+        gdouble d;
+        guint64 u;
+    } bits;
+
+    bits.d = value;
+    return qmi_message_tlv_write_guint64 (message, QMI_ENDIAN_LITTLE, bits.u, NULL);
+}
+
+/* Write the WDS Get Profile List profile list TLV */
+static void
+write_wds_profile_list (QmiMessage *message)
+{
+    gsize init_offset;
+    guint i;
+
+    init_offset = qmi_message_tlv_write_init (message, 0x01, NULL);
+    g_assert (init_offset);
+    g_assert (qmi_message_tlv_write_guint8 (message, WDS_PROFILES, NULL));
+    for (i = 0; i < WDS_PROFILES; i++) {
+        gchar name[32];
+
+        g_snprintf (name, sizeof (name), "profile-%02u.internet.example", i);
+        g_assert (qmi_message_tlv_write_guint8 (message, QMI_WDS_PROFILE_TYPE_3GPP, NULL));
+        g_assert (qmi_message_tlv_write_guint8 (message, (guint8) (i + 1), NULL));
+        g_assert (qmi_message_tlv_write_string (message, 1, name, -1, NULL));
+    }
+    g_assert (qmi_message_tlv_write_complete (message, init_offset, NULL));
+}
+
+/* WDS Get Profile List response with WDS_PROFILES profiles */
+static QmiMessage *
+build_wds_get_profile_list_response (void)
+{
+    QmiMessage *request;
+    QmiMessage *response;
+
+    request = qmi_message_new (QMI_SERVICE_WDS, 1, 0x0102, 0x002A);
+    response = qmi_message_response_new (request, QMI_PROTOCOL_ERROR_NONE);
+    qmi_message_unref (request);
+
+    write_wds_profile_list (response);
+    return response;
+}
+
+/* Turn a message built with the writer API into an indication */
+static QmiMessage *
+message_to_indication (QmiMessage *message)
+{
+    const guint8 *raw;
+    gsize         raw_len = 0;
+    GByteArray   *buffer;
+    QmiMessage   *indication;
+    GError       *error = NULL;
+
+    raw = qmi_message_get_raw (message, &raw_len, &error);
+    g_assert_no_error (error);
+
+    buffer = g_byte_array_append (g_byte_array_sized_new (raw_len), raw, raw_len);
+    buffer->data[QMI_FLAGS_OFFSET] = QMI_FLAGS_INDICATION;
+
+    indication = qmi_message_new_from_raw (buffer, &error);
+    g_assert_no_error (error);
+    g_assert (indication);
+
+    g_byte_array_unref (buffer);
+    qmi_message_unref (message);
+    return indication;
+}
+
+/* LOC Position Report indication with every field set */
+static QmiMessage *
+build_loc_position_report_indication (void)
+{
+    QmiMessage *message;
+    gsize       init_offset;
+    guint       type;
+    guint       i;
+
+    message = qmi_message_new (QMI_SERVICE_LOC, 1, 0, 0x0024);
+
+#define WRITE_TLV(tlv, body) do {                                      \
+        init_offset = qmi_message_tlv_write_init (message, tlv, NULL); \
+        g_assert (init_offset);                                        \
+        body;                                                          \
+        g_assert (qmi_message_tlv_write_complete (message, init_offset, NULL)); \
+    } while (0)
+
+    WRITE_TLV (0x01, g_assert (qmi_message_tlv_write_guint32 (message, QMI_ENDIAN_LITTLE, QMI_LOC_SESSION_STATUS_SUCCESS, NULL)));
+    WRITE_TLV (0x02, g_assert (qmi_message_tlv_write_guint8 (message, 1, NULL)));
+    WRITE_TLV (0x10, g_assert (tlv_write_gdouble (message, 41.3874)));
+    WRITE_TLV (0x11, g_assert (tlv_write_gdouble (message, 2.1686)));
+
+    /* Single precision values: horizontal uncertainties, speeds, altitudes... */
+    for (type = 0x12; type <= 0x22; type++) {
+        switch (type) {
+        case 0x16:
+        case 0x1D:
+            WRITE_TLV (type, g_assert (qmi_message_tlv_write_guint8 (message, 68, NULL)));
+            break;
+        case 0x17:
+        case 0x1E:
+            WRITE_TLV (type, g_assert (qmi_message_tlv_write_guint32 (message, QMI_ENDIAN_LITTLE, QMI_LOC_RELIABILITY_HIGH, NULL)));
+            break;
+        default:
+            WRITE_TLV (type, g_assert (tlv_write_gfloat (message, 1.5f * (gfloat) type)));
+            break;
+        }
+    }
+
+    WRITE_TLV (0x23, g_assert (qmi_message_tlv_write_guint32 (message, QMI_ENDIAN_LITTLE, QMI_LOC_TECHNOLOGY_USED_SATELLITE, NULL)));
+    WRITE_TLV (0x24, {
+        g_assert (tlv_write_gfloat (message, 1.2f));
+        g_assert (tlv_write_gfloat (message, 0.9f));
+        g_assert (tlv_write_gfloat (message, 0.8f));
+    });
+    WRITE_TLV (0x25, g_assert (qmi_message_tlv_write_guint64 (message, QMI_ENDIAN_LITTLE, G_GUINT64_CONSTANT (1577836800000), NULL)));
+    WRITE_TLV (0x26, g_assert (qmi_message_tlv_write_guint8 (message, 18, NULL)));
+    WRITE_TLV (0x27, {
+        g_assert (qmi_message_tlv_write_guint16 (message, QMI_ENDIAN_LITTLE, 2086, NULL));
+        g_assert (qmi_message_tlv_write_guint32 (message, QMI_ENDIAN_LITTLE, 259218000, NULL));
+    });
+    WRITE_TLV (0x28, g_assert (tlv_write_gfloat (message, 0.5f)));
+    WRITE_TLV (0x29, g_assert (qmi_message_tlv_write_guint32 (message, QMI_ENDIAN_LITTLE, QMI_LOC_TIME_SOURCE_NETWORK_TIME_TRANSFER, NULL)));
+    WRITE_TLV (0x2A, g_assert (qmi_message_tlv_write_guint64 (message, QMI_ENDIAN_LITTLE, 0, NULL)));
+    WRITE_TLV (0x2B, g_assert (qmi_message_tlv_write_guint32 (message, QMI_ENDIAN_LITTLE, 4242, NULL)));
+    WRITE_TLV (0x2C, {
+        g_assert (qmi_message_tlv_write_guint8 (message, LOC_SATELLITES_USED, NULL));
+        for (i = 0; i < LOC_SATELLITES_USED; i++)
+            g_assert (qmi_message_tlv_write_guint16 (message, QMI_ENDIAN_LITTLE, (guint16) (i + 1), NULL));
+    });
+    WRITE_TLV (0x2D, g_assert (qmi_message_tlv_write_guint8 (message, 0, NULL)));
+
+    return message_to_indication (message);
+}
+
+/* LOC GNSS SV Info indication with LOC_SATELLITES_IN_VIEW satellites */
+static QmiMessage *
+build_loc_gnss_sv_info_indication (void)
+{
+    QmiMessage *message;
+    gsize       init_offset;
+    guint       i;
+
+    message = qmi_message_new (QMI_SERVICE_LOC, 1, 0, 0x0025);
+
+    WRITE_TLV (0x01, g_assert (qmi_message_tlv_write_guint8 (message, 0, NULL)));
+    WRITE_TLV (0x10, {
+        g_assert (qmi_message_tlv_write_guint8 (message, LOC_SATELLITES_IN_VIEW, NULL));
+        for (i = 0; i < LOC_SATELLITES_IN_VIEW; i++) {
+            g_assert (qmi_message_tlv_write_guint32 (message, QMI_ENDIAN_LITTLE, 0x1FF, NULL));
+            g_assert (qmi_message_tlv_write_guint32 (message, QMI_ENDIAN_LITTLE, QMI_LOC_SYSTEM_GPS, NULL));
+            g_assert (qmi_message_tlv_write_guint16 (message, QMI_ENDIAN_LITTLE, (guint16) (i + 1), NULL));
+            g_assert (qmi_message_tlv_write_guint8 (message, QMI_LOC_HEALTH_STATUS_HEALTHY, NULL));
+            g_assert (qmi_message_tlv_write_guint32 (message, QMI_ENDIAN_LITTLE, QMI_LOC_SATELLITE_STATUS_TRACKING, NULL));
+            g_assert (qmi_message_tlv_write_guint8 (message, QMI_LOC_NAVIGATION_DATA_HAS_EPHEMERIS, NULL));
+            g_assert (tlv_write_gfloat (message, 10.0f + (gfloat) i));
+            g_assert (tlv_write_gfloat (message, 5.0f * (gfloat) i));
+            g_assert (tlv_write_gfloat (message, 30.0f));
+        }
+    });
+
+#undef WRITE_TLV
+
+    return message_to_indication (message);
+}
+
+/*****************************************************************************/
+/* Raw parsing */
+
+typedef struct {
+    const guint8 *raw;
+    gsize         raw_len;
+    GByteArray   *buffer;
+} RawContext;
+
+static void
+raw_context_init (RawContext *ctx,
+                  QmiMessage *message)
+{
+    GError *error = NULL;
+
+    ctx->raw = qmi_message_get_raw (message, &ctx->raw_len, &error);
+    g_assert_no_error (error);
+    ctx->buffer = g_byte_array_sized_new (ctx->raw_len);
+}
+
+static void
+bench_new_from_raw (gconstpointer user_data)
+{
+    const RawContext *ctx = user_data;
+    QmiMessage       *message;
+    GError           *error = NULL;
+
+    /* The buffer keeps its allocation across iterations */
+    g_byte_array_set_size (ctx->buffer, 0);
+    g_byte_array_append (ctx->buffer, ctx->raw, ctx->raw_len);
+
+    message = qmi_message_new_from_raw (ctx->buffer, &error);
+    g_assert (message);
+    qmi_message_unref (message);
+}
+
+/*****************************************************************************/
+/* TLV reader */
+
+static void
+bench_tlv_read_nas_network_scan (gconstpointer user_data)
+{
+    QmiMessage *message = (QmiMessage *) user_data;
+    gsize       init_offset;
+    gsize       offset = 0;
+    guint16     n_networks = 0;
+    guint16     i;
+
+    init_offset = qmi_message_tlv_read_init (message, 0x10, NULL, NULL);
+    g_assert (init_offset);
+    g_assert (qmi_message_tlv_read_guint16 (message, init_offset, &offset, QMI_ENDIAN_LITTLE, &n_networks, NULL));
+
+    for (i = 0; i < n_networks; i++) {
+        guint16  mcc;
+        guint16  mnc;
+        guint8   status;
+        gchar   *description = NULL;
+
+        g_assert (qmi_message_tlv_read_guint16 (message, init_offset, &offset, QMI_ENDIAN_LITTLE, &mcc, NULL));
+        g_assert (qmi_message_tlv_read_guint16 (message, init_offset, &offset, QMI_ENDIAN_LITTLE, &mnc, NULL));
+        g_assert (qmi_message_tlv_read_guint8 (message, init_offset, &offset, &status, NULL));
+        g_assert (qmi_message_tlv_read_string (message, init_offset, &offset, 1, 0, &description, NULL));
+        g_free (description);
+    }
+}
+
+static void
+bench_tlv_read_wds_profile_list (gconstpointer user_data)
+{
+    QmiMessage *message = (QmiMessage *) user_data;
+    gsize       init_offset;
+    gsize       offset = 0;
+    guint8      n_profiles = 0;
+    guint8      i;
+
+    init_offset = qmi_message_tlv_read_init (message, 0x01, NULL, NULL);
+    g_assert (init_offset);
+    g_assert (qmi_message_tlv_read_guint8 (message, init_offset, &offset, &n_profiles, NULL));
+
+    for (i = 0; i < n_profiles; i++) {
+        guint8  type;
+        guint8  index;
+        gchar  *name = NULL;
+
+        g_assert (qmi_message_tlv_read_guint8 (message, init_offset, &offset, &type, NULL));
+        g_assert (qmi_message_tlv_read_guint8 (message, init_offset, &offset, &index, NULL));
+        g_assert (qmi_message_tlv_read_string (message, init_offset, &offset, 1, 0, &name, NULL));
+        g_free (name);
+    }
+}
+
+static void
+bench_tlv_read_loc_position_report (gconstpointer user_data)
+{
+    QmiMessage *message = (QmiMessage *) user_data;
+    gsize       init_offset;
+    gsize       offset;
+    gdouble     latitude;
+    gdouble     longitude;
+    gfloat      value;
+    guint64     timestamp;
+    guint       type;
+
+    offset = 0;
+    init_offset = qmi_message_tlv_read_init (message, 0x10, NULL, NULL);
+    g_assert (qmi_message_tlv_read_gdouble (message, init_offset, &offset, QMI_ENDIAN_LITTLE, &latitude, NULL));
+
+    offset = 0;
+    init_offset = qmi_message_tlv_read_init (message, 0x11, NULL, NULL);
+    g_assert (qmi_message_tlv_read_gdouble (message, init_offset, &offset, QMI_ENDIAN_LITTLE, &longitude, NULL));
+
+    for (type = 0x18; type <= 0x1C; type++) {
+        offset = 0;
+        init_offset = qmi_message_tlv_read_init (message, type, NULL, NULL);
+        g_assert (qmi_message_tlv_read_gfloat_endian (message, init_offset, &offset, QMI_ENDIAN_LITTLE, &value, NULL));
+    }
+
+    offset = 0;
+    init_offset = qmi_message_tlv_read_init (message, 0x25, NULL, NULL);
+    g_assert (qmi_message_tlv_read_guint64 (message, init_offset, &offset, QMI_ENDIAN_LITTLE, &timestamp, NULL));
+}
+
+/*****************************************************************************/
+/* TLV writer */
+
+static void
+bench_tlv_write_wds_profile_list (gconstpointer user_data)
+{
+    QmiMessage *message;
+
+    message = qmi_message_new (QMI_SERVICE_WDS, 1, 0x0102, 0x002A);
+    write_wds_profile_list (message);
+    qmi_message_unref (message);
+}
+
+static void
+bench_tlv_write_loc_gnss_sv_info (gconstpointer user_data)
+{
+    qmi_message_unref (build_loc_gnss_sv_info_indication ());
+}
+
+/*****************************************************************************/
+/* Generated output parsers (run through process_indication()) */
+
+typedef struct {
+    QmiClient  *client;
+    QmiMessage *indication;
+} IndicationContext;
+
+static void
+bench_process_indication (gconstpointer user_data)
+{
+    const IndicationContext *ctx = user_data;
+
+    QMI_CLIENT_GET_CLASS (ctx->client)->process_indication (ctx->client, ctx->indication);
+}
+
+#if defined HAVE_QMI_INDICATION_LOC_POSITION_REPORT
+
+static void
+loc_position_report_cb (QmiClientLoc                         *client,
+                        QmiIndicationLocPositionReportOutput *output,
+                        gpointer                              user_data)
+{
+    QmiLocSessionStatus status;
+    gdouble             latitude;
+    gdouble             longitude;
+    gfloat              altitude;
+    guint64             timestamp;
+    GArray             *satellites_used = NULL;
+
+    g_assert (qmi_indication_loc_position_report_output_get_session_status (output, &status, NULL));
+    g_assert (qmi_indication_loc_position_report_output_get_latitude (output, &latitude, NULL));
+    g_assert (qmi_indication_loc_position_report_output_get_longitude (output, &longitude, NULL));
+    g_assert (qmi_indication_loc_position_report_output_get_altitude_from_sealevel (output, &altitude, NULL));
+    g_assert (qmi_indication_loc_position_report_output_get_utc_timestamp (output, &timestamp, NULL));
+    g_assert (qmi_indication_loc_position_report_output_get_satellites_used (output, &satellites_used, NULL));
+    g_assert_cmpuint (satellites_used->len, ==, LOC_SATELLITES_USED);
+}
+
+#endif /* HAVE_QMI_INDICATION_LOC_POSITION_REPORT */
+
+#if defined HAVE_QMI_INDICATION_LOC_GNSS_SV_INFO
+
+static void
+loc_gnss_sv_info_cb (QmiClientLoc                      *client,
+                     QmiIndicationLocGnssSvInfoOutput *output,
+                     gpointer                           user_data)
+{
+    GArray *list = NULL;
+
+    g_assert (qmi_indication_loc_gnss_sv_info_output_get_list (output, &list, NULL));
+    g_assert_cmpuint (list->len, ==, LOC_SATELLITES_IN_VIEW);
+}
+
+#endif /* HAVE_QMI_INDICATION_LOC_GNSS_SV_INFO */
+
+/*****************************************************************************/
+/* Printable */
+
+static void
+bench_get_printable_full (gconstpointer user_data)
+{
+    QmiMessage *message = (QmiMessage *) user_data;
+
+    g_free (qmi_message_get_printable_full (message, NULL, ""));
+}
+
+/*****************************************************************************/
+
+int main (int argc, char **argv)
+{
+    QmiMessage *nas_network_scan;
+    QmiMessage *wds_profile_list;
+    QmiMessage *loc_position_report;
+    QmiMessage *loc_gnss_sv_info;
+    GByteArray *buffer;
+    RawContext  raw_nas_network_scan;
+    RawContext  raw_wds_profile_list;
+    RawContext  raw_loc_position_report;
+    GError     *error = NULL;
+
+    /* Have GSlice allocations show up in the allocation counts */
+    g_setenv ("G_SLICE", "always-malloc", TRUE);
+
+    if (argc > 1)
+        iterations = (guint) strtoul (argv[1], NULL, 10);
+    if (!iterations) {
+        g_printerr ("usage: %s [ITERATIONS]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    buffer = g_byte_array_append (g_byte_array_new (),
+                                  nas_network_scan_response,
+                                  G_N_ELEMENTS (nas_network_scan_response));
+    nas_network_scan = qmi_message_new_from_raw (buffer, &error);
+    g_assert_no_error (error);
+    g_assert (nas_network_scan);
+    g_byte_array_unref (buffer);
+
+    wds_profile_list = build_wds_get_profile_list_response ();
+    loc_position_report = build_loc_position_report_indication ();
+    loc_gnss_sv_info = build_loc_gnss_sv_info_indication ();
+
+    g_print ("%u iterations%s\n\n",
+             iterations,
+             ALLOCATIONS_COUNTED ? "" : " (allocations not counted on this platform)");
+
+    raw_context_init (&raw_nas_network_scan, nas_network_scan);
+    raw_context_init (&raw_wds_profile_list, wds_profile_list);
+    raw_context_init (&raw_loc_position_report, loc_position_report);
+
+    bench_run ("new_from_raw/nas-network-scan", raw_nas_network_scan.raw_len,
+               bench_new_from_raw, &raw_nas_network_scan);
+    bench_run ("new_from_raw/wds-get-profile-list", raw_wds_profile_list.raw_len,
+               bench_new_from_raw, &raw_wds_profile_list);
+    bench_run ("new_from_raw/loc-position-report", raw_loc_position_report.raw_len,
+               bench_new_from_raw, &raw_loc_position_report);
+
+    bench_run ("tlv_read/nas-network-scan", qmi_message_get_length (nas_network_scan),
+               bench_tlv_read_nas_network_scan, nas_network_scan);
+    bench_run ("tlv_read/wds-get-profile-list", qmi_message_get_length (wds_profile_list),
+               bench_tlv_read_wds_profile_list, wds_profile_list);
+    bench_run ("tlv_read/loc-position-report", qmi_message_get_length (loc_position_report),
+               bench_tlv_read_loc_position_report, loc_position_report);
+
+    bench_run ("tlv_write/wds-get-profile-list", qmi_message_get_length (wds_profile_list),
+               bench_tlv_write_wds_profile_list, NULL);
+    bench_run ("tlv_write/loc-gnss-sv-info", qmi_message_get_length (loc_gnss_sv_info),
+               bench_tlv_write_loc_gnss_sv_info, NULL);
+
+#if defined HAVE_QMI_INDICATION_LOC_POSITION_REPORT || defined HAVE_QMI_INDICATION_LOC_GNSS_SV_INFO
+    {
+        IndicationContext ctx;
+
+        ctx.client = QMI_CLIENT (g_object_new (QMI_TYPE_CLIENT_LOC, NULL));
+
+#if defined HAVE_QMI_INDICATION_LOC_POSITION_REPORT
+        g_signal_connect (ctx.client, "position-report", G_CALLBACK (loc_position_report_cb), NULL);
+        ctx.indication = loc_position_report;
+        bench_run ("output_get/loc-position-report", qmi_message_get_length (loc_position_report),
+                   bench_process_indication, &ctx);
+#endif
+#if defined HAVE_QMI_INDICATION_LOC_GNSS_SV_INFO
+        g_signal_connect (ctx.client, "gnss-sv-info", G_CALLBACK (loc_gnss_sv_info_cb), NULL);
+        ctx.indication = loc_gnss_sv_info;
+        bench_run ("output_get/loc-gnss-sv-info", qmi_message_get_length (loc_gnss_sv_info),
+                   bench_process_indication, &ctx);
+#endif
+
+        g_object_unref (ctx.client);
+    }
+#endif
+
+    bench_run ("printable/nas-network-scan", qmi_message_get_length (nas_network_scan),
+               bench_get_printable_full, nas_network_scan);
+    bench_run ("printable/wds-get-profile-list", qmi_message_get_length (wds_profile_list),
+               bench_get_printable_full, wds_profile_list);
+    bench_run ("printable/loc-position-report", qmi_message_get_length (loc_position_report),
+               bench_get_printable_full, loc_position_report);
+
+    g_byte_array_unref (raw_nas_network_scan.buffer);
+    g_byte_array_unref (raw_wds_profile_list.buffer);
+    g_byte_array_unref (raw_loc_position_report.buffer);
+    qmi_message_unref (nas_network_scan);
+    qmi_message_unref (wds_profile_list);
+    qmi_message_unref (loc_position_report);
+    qmi_message_unref (loc_gnss_sv_info);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,952 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ *
+ * Copyright (C) 2020 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+/*
+ * qmi-proxy load generator: runs a QmiProxy in its own thread, in front of
+ * a simulated QMI device, and connects N synthetic clients to it. Each
+ * client allocates a WDS CID through the proxy and issues requests at a
+ * fixed rate, while the device broadcasts indications at M Hz.
+ *
+ * The simulated device is the master side of a pseudo-terminal; the proxy
+ * opens the slave side as if it were a cdc-wdm port.
+ *
+ * Reported: CPU time used by the proxy thread, request round trip latency,
+ * and indications dropped or delayed on their way to the clients.
+ *
+ * The proxy binds the same abstract socket as the system qmi-proxy, so that
+ * one must not be running, and the same privileges are required.
+ */
+
+#include <config.h>
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <pthread.h>
+#include <time.h>
+
+#include <glib-object.h>
+#include <glib-unix.h>
+#include <gio/gio.h>
+#include <libqmi-glib.h>
+
+#include "test-port-context.h"
+
+#define BUFFER_SIZE 4096
+
+/* WDS Get Packet Service Status, answered with just the result TLV */
+#define BENCH_REQUEST_MESSAGE_ID    0x0022
+/* Indication unknown to the WDS client, so only the device signal sees it */
+#define BENCH_INDICATION_MESSAGE_ID 0x5A5A
+#define BENCH_INDICATION_TLV_TIME   0x01
+
+#define REQUEST_TIMEOUT 10
+#define DRAIN_TIMEOUT   2
+
+/*****************************************************************************/
+/* Options */
+
+static gint   n_clients          = 16;
+static gint   request_rate       = 10;
+static gint   indication_rate    = 10;
+static gint   duration           = 10;
+static gint   late_threshold_ms  = 100;
+
+static GOptionEntry main_entries[] = {
+    { "clients", 'c', 0, G_OPTION_ARG_INT, &n_clients,
+      "Number of synthetic clients (default 16)",
+      "[N]"
+    },
+    { "request-rate", 'r', 0, G_OPTION_ARG_INT, &request_rate,
+      "Requests per second issued by each client (default 10)",
+      "[RATE]"
+    },
+    { "indication-rate", 'i', 0, G_OPTION_ARG_INT, &indication_rate,
+      "Indications per second broadcast by the device (default 10)",
+      "[RATE]"
+    },
+    { "duration", 'd', 0, G_OPTION_ARG_INT, &duration,
+      "Length of the measurement, in seconds (default 10)",
+      "[SECONDS]"
+    },
+    { "late-threshold", 'l', 0, G_OPTION_ARG_INT, &late_threshold_ms,
+      "Report indications delivered later than this as delayed, in ms (default 100)",
+      "[MS]"
+    },
+    { NULL }
+};
+
+/*****************************************************************************/
+/* Fixed rate event scheduling */
+
+typedef struct {
+    gdouble rate;
+    gint64  start;
+    guint64 done;
+} RateTimer;
+
+static guint
+rate_timer_interval_ms (gdouble rate)
+{
+    return CLAMP ((guint) (1000.0 / rate), 1, 100);
+}
+
+static void
+rate_timer_start (RateTimer *timer,
+                  gdouble    rate)
+{
+    timer->rate = rate;
+    timer->start = g_get_monotonic_time ();
+    timer->done = 0;
+}
+
+/* Number of events due since the last call, catching up if the timer
+ * source fired late */
+static guint64
+rate_timer_due (RateTimer *timer)
+{
+    guint64 expected;
+    guint64 due;
+
+    expected = (guint64) ((gdouble) (g_get_monotonic_time () - timer->start) * timer->rate / G_USEC_PER_SEC);
+    if (expected <= timer->done)
+        return 0;
+    due = expected - timer->done;
+    timer->done = expected;
+    return due;
+}
+
+/*****************************************************************************/
+/* Simulated device */
+
+typedef struct {
+    gchar        *path;
+    gint          master;
+    gint          keepalive;
+    GByteArray   *buffer;
+    guint8        last_cid[G_MAXUINT8 + 1];
+    GThread      *thread;
+    GMainContext *context;
+    GMainLoop    *loop;
+    GSource      *readable_source;
+    GSource      *indication_source;
+    RateTimer     indication_timer;
+    volatile gint indications_sent;
+} SimDevice;
+
+static void
+sim_device_write (SimDevice  *sim,
+                  QmiMessage *message)
+{
+    const guint8 *raw;
+    gsize         raw_length = 0;
+    gsize         written = 0;
+
+    raw = qmi_message_get_raw (message, &raw_length, NULL);
+    while (written < raw_length) {
+        gssize w;
+
+        w = write (sim->master, &raw[written], raw_length - written);
+        if (w < 0) {
+            if (errno == EINTR)
+                continue;
+            g_warning ("couldn't write to simulated device: %s", g_strerror (errno));
+            return;
+        }
+        written += w;
+    }
+}
+
+static void
+sim_device_process_request (SimDevice  *sim,
+                            QmiMessage *message)
+{
+    QmiMessage *response;
+    gsize       init_offset;
+    gsize       offset = 0;
+    guint8      service = 0;
+    guint8      cid = 0;
+
+    if (!qmi_message_is_request (message))
+        return;
+
+    response = qmi_message_response_new (message, QMI_PROTOCOL_ERROR_NONE);
+    if (!response)
+        return;
+
+    if (qmi_message_get_service (message) == QMI_SERVICE_CTL) {
+        switch (qmi_message_get_message_id (message)) {
+        case QMI_MESSAGE_CTL_ALLOCATE_CID:
+            if ((init_offset = qmi_message_tlv_read_init (message, QMI_MESSAGE_TLV_ALLOCATION_INFO, NULL, NULL)) > 0 &&
+                qmi_message_tlv_read_guint8 (message, init_offset, &offset, &service, NULL)) {
+                /* Never hand out the broadcast CID, nor 0 */
+                cid = ++sim->last_cid[service];
+                if (cid == QMI_CID_BROADCAST)
+                    cid = sim->last_cid[service] = 1;
+            }
+            break;
+        case QMI_MESSAGE_CTL_RELEASE_CID:
+            if ((init_offset = qmi_message_tlv_read_init (message, QMI_MESSAGE_TLV_ALLOCATION_INFO, NULL, NULL)) > 0) {
+                qmi_message_tlv_read_guint8 (message, init_offset, &offset, &service, NULL);
+                qmi_message_tlv_read_guint8 (message, init_offset, &offset, &cid, NULL);
+            }
+            break;
+        default:
+            break;
+        }
+
+        if (cid) {
+            init_offset = qmi_message_tlv_write_init (response, QMI_MESSAGE_TLV_ALLOCATION_INFO, NULL);
+            if (!init_offset ||
+                !qmi_message_tlv_write_guint8 (response, service, NULL) ||
+                !qmi_message_tlv_write_guint8 (response, cid, NULL) ||
+                !qmi_message_tlv_write_complete (response, init_offset, NULL))
+                g_assert_not_reached ();
+        }
+    }
+
+    sim_device_write (sim, response);
+    qmi_message_unref (response);
+}
+
+static gboolean
+sim_device_readable_cb (gint          fd,
+                        GIOCondition  condition,
+                        SimDevice    *sim)
+{
+    guint8      buffer[BUFFER_SIZE];
+    gssize      r;
+    QmiMessage *message;
+    GError     *error = NULL;
+
+    r = read (fd, buffer, sizeof (buffer));
+    if (r < 0) {
+        if (errno == EINTR || errno == EAGAIN)
+            return G_SOURCE_CONTINUE;
+        g_warning ("couldn't read from simulated device: %s", g_strerror (errno));
+        return G_SOURCE_REMOVE;
+    }
+    if (r == 0)
+        return G_SOURCE_CONTINUE;
+
+    g_byte_array_append (sim->buffer, buffer, r);
+
+    while ((message = qmi_message_new_from_raw (sim->buffer, &error)) != NULL) {
+        sim_device_process_request (sim, message);
+        qmi_message_unref (message);
+    }
+
+    /* Broken framing, just restart */
+    if (error) {
+        g_warning ("invalid message received by simulated device: %s", error->message);
+        g_error_free (error);
+        g_byte_array_set_size (sim->buffer, 0);
+    }
+
+    return G_SOURCE_CONTINUE;
+}
+
+static void
+sim_device_send_indication (SimDevice *sim)
+{
+    QmiMessage *message;
+    gsize       init_offset;
+
+    message = qmi_message_new (QMI_SERVICE_WDS, QMI_CID_BROADCAST, 0, BENCH_INDICATION_MESSAGE_ID);
+    ((GByteArray *) message)->data[QMI_FLAGS_OFFSET] = QMI_FLAGS_INDICATION;
+
+    init_offset = qmi_message_tlv_write_init (message, BENCH_INDICATION_TLV_TIME, NULL);
+    if (!init_offset ||
+        !qmi_message_tlv_write_guint64 (message, QMI_ENDIAN_LITTLE, (guint64) g_get_monotonic_time (), NULL) ||
+        !qmi_message_tlv_write_complete (message, init_offset, NULL))
+        g_assert_not_reached ();
+
+    sim_device_write (sim, message);
+    qmi_message_unref (message);
+    g_atomic_int_inc (&sim->indications_sent);
+}
+
+static gboolean
+sim_device_indication_cb (SimDevice *sim)
+{
+    guint64 due;
+
+    for (due = rate_timer_due (&sim->indication_timer); due > 0; due--)
+        sim_device_send_indication (sim);
+    return G_SOURCE_CONTINUE;
+}
+
+static gboolean
+sim_device_start_indications (SimDevice *sim)
+{
+    g_assert (!sim->indication_source);
+    rate_timer_start (&sim->indication_timer, indication_rate);
+    sim->indication_source = g_timeout_source_new (rate_timer_interval_ms (indication_rate));
+    g_source_set_callback (sim->indication_source, (GSourceFunc) sim_device_indication_cb, sim, NULL);
+    g_source_attach (sim->indication_source, sim->context);
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean
+sim_device_stop_indications (SimDevice *sim)
+{
+    if (sim->indication_source) {
+        g_source_destroy (sim->indication_source);
+        g_clear_pointer (&sim->indication_source, g_source_unref);
+    }
+    return G_SOURCE_REMOVE;
+}
+
+static gpointer
+sim_device_thread_func (SimDevice *sim)
+{
+    g_main_context_push_thread_default (sim->context);
+    g_main_loop_run (sim->loop);
+    sim_device_stop_indications (sim);
+    g_main_context_pop_thread_default (sim->context);
+    return NULL;
+}
+
+static void
+sim_device_free (SimDevice *sim)
+{
+    if (sim->thread) {
+        g_main_loop_quit (sim->loop);
+        g_thread_join (sim->thread);
+    }
+    if (sim->readable_source) {
+        g_source_destroy (sim->readable_source);
+        g_source_unref (sim->readable_source);
+    }
+    if (sim->loop)
+        g_main_loop_unref (sim->loop);
+    if (sim->context)
+        g_main_context_unref (sim->context);
+    if (sim->keepalive >= 0)
+        close (sim->keepalive);
+    if (sim->master >= 0)
+        close (sim->master);
+    if (sim->buffer)
+        g_byte_array_unref (sim->buffer);
+    g_free (sim->path);
+    g_slice_free (SimDevice, sim);
+}
+
+static SimDevice *
+sim_device_new (GError **error)
+{
+    SimDevice      *sim;
+    struct termios  tio;
+
+    sim = g_slice_new0 (SimDevice);
+    sim->master = -1;
+    sim->keepalive = -1;
+
+    sim->master = posix_openpt (O_RDWR | O_NOCTTY);
+    if (sim->master < 0 || grantpt (sim->master) < 0 || unlockpt (sim->master) < 0) {
+        g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errno),
+                     "couldn't create pseudo-terminal: %s", g_strerror (errno));
+        sim_device_free (sim);
+        return NULL;
+    }
+    sim->path = g_strdup (ptsname (sim->master));
+
+    /* QMUX messages are binary, no line discipline processing at all */
+    if (tcgetattr (sim->master, &tio) == 0) {
+        cfmakeraw (&tio);
+        tcsetattr (sim->master, TCSANOW, &tio);
+    }
+
+    /* Keep the slave open ourselves so that the master doesn't report
+     * hang-ups while the proxy has it closed; nothing is read from it */
+    sim->keepalive = open (sim->path, O_RDWR | O_NOCTTY);
+    if (sim->keepalive < 0) {
+        g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errno),
+                     "couldn't open pseudo-terminal '%s': %s", sim->path, g_strerror (errno));
+        sim_device_free (sim);
+        return NULL;
+    }
+
+    sim->buffer = g_byte_array_sized_new (BUFFER_SIZE);
+    sim->context = g_main_context_new ();
+    sim->loop = g_main_loop_new (sim->context, FALSE);
+
+    sim->readable_source = g_unix_fd_source_new (sim->master, G_IO_IN);
+    g_source_set_callback (sim->readable_source, (GSourceFunc) sim_device_readable_cb, sim, NULL);
+    g_source_attach (sim->readable_source, sim->context);
+
+    sim->thread = g_thread_new ("sim-device", (GThreadFunc) sim_device_thread_func, sim);
+    return sim;
+}
+
+/*****************************************************************************/
+/* Proxy thread */
+
+typedef struct {
+    GThread   *thread;
+    GMainLoop *loop;
+    GMutex     ready_mutex;
+    GCond      ready_cond;
+    gboolean   ready;
+    GError    *error;
+    clockid_t  cpu_clock;
+} ProxyThread;
+
+static gpointer
+proxy_thread_func (ProxyThread *pt)
+{
+    GMainContext *context;
+    QmiProxy     *proxy;
+
+    context = g_main_context_new ();
+    g_main_context_push_thread_default (context);
+
+    proxy = qmi_proxy_new (&pt->error);
+    pthread_getcpuclockid (pthread_self (), &pt->cpu_clock);
+    if (proxy)
+        pt->loop = g_main_loop_new (context, FALSE);
+
+    g_mutex_lock (&pt->ready_mutex);
+    pt->ready = TRUE;
+    g_cond_signal (&pt->ready_cond);
+    g_mutex_unlock (&pt->ready_mutex);
+
+    if (proxy) {
+        g_main_loop_run (pt->loop);
+        g_object_unref (proxy);
+    }
+
+    g_main_context_pop_thread_default (context);
+    g_main_context_unref (context);
+    return NULL;
+}
+
+static gint64
+proxy_thread_get_cpu_time (ProxyThread *pt)
+{
+    struct timespec ts;
+
+    if (clock_gettime (pt->cpu_clock, &ts) < 0)
+        return 0;
+    return (gint64) ts.tv_sec * G_USEC_PER_SEC + ts.tv_nsec / 1000;
+}
+
+static void
+proxy_thread_free (ProxyThread *pt)
+{
+    if (pt->loop)
+        g_main_loop_quit (pt->loop);
+    g_thread_join (pt->thread);
+    if (pt->loop)
+        g_main_loop_unref (pt->loop);
+    g_clear_error (&pt->error);
+    g_cond_clear (&pt->ready_cond);
+    g_mutex_clear (&pt->ready_mutex);
+    g_slice_free (ProxyThread, pt);
+}
+
+static ProxyThread *
+proxy_thread_new (GError **error)
+{
+    ProxyThread *pt;
+
+    pt = g_slice_new0 (ProxyThread);
+    g_mutex_init (&pt->ready_mutex);
+    g_cond_init (&pt->ready_cond);
+    pt->thread = g_thread_new ("qmi-proxy", (GThreadFunc) proxy_thread_func, pt);
+
+    /* Wait until the proxy is listening */
+    g_mutex_lock (&pt->ready_mutex);
+    while (!pt->ready)
+        g_cond_wait (&pt->ready_cond, &pt->ready_mutex);
+    g_mutex_unlock (&pt->ready_mutex);
+
+    if (pt->error) {
+        g_propagate_prefixed_error (error, g_steal_pointer (&pt->error),
+                                    "couldn't start proxy (is qmi-proxy already running?): ");
+        proxy_thread_free (pt);
+        return NULL;
+    }
+    return pt;
+}
+
+/*****************************************************************************/
+/* Synthetic clients */
+
+typedef struct {
+    GMainLoop *loop;
+    guint      pending;
+    gboolean   failed;
+
+    /* Measurements, updated from the main thread only */
+    gboolean   measuring;
+    guint64    requests_sent;
+    guint64    requests_failed;
+    guint64    requests_in_flight;
+    guint64    indications_received;
+    guint64    indications_delayed;
+    GArray    *request_latencies;
+    GArray    *indication_delays;
+} Bench;
+
+typedef struct {
+    Bench     *bench;
+    guint      index;
+    QmiDevice *device;
+    QmiClient *client;
+    gulong     indication_id;
+    RateTimer  request_timer;
+    guint      request_timeout_id;
+} BenchClient;
+
+typedef struct {
+    BenchClient *bc;
+    gint64       start;
+} Request;
+
+static void
+bench_step_done (Bench    *bench,
+                 gboolean  failed)
+{
+    if (failed)
+        bench->failed = TRUE;
+    g_assert (bench->pending > 0);
+    if (--bench->pending == 0)
+        g_main_loop_quit (bench->loop);
+}
+
+static void
+bench_loop_run (Bench *bench)
+{
+    if (bench->pending)
+        g_main_loop_run (bench->loop);
+}
+
+static void
+request_ready (QmiDevice    *device,
+               GAsyncResult *res,
+               Request      *request)
+{
+    Bench      *bench = request->bc->bench;
+    QmiMessage *response;
+    GError     *error = NULL;
+
+    bench->requests_in_flight--;
+
+    response = qmi_device_command_full_finish (device, res, &error);
+    if (!response) {
+        g_debug ("client %u: request failed: %s", request->bc->index, error->message);
+        g_error_free (error);
+        bench->requests_failed++;
+    } else {
+        gint64 latency;
+
+        latency = g_get_monotonic_time () - request->start;
+        g_array_append_val (bench->request_latencies, latency);
+        qmi_message_unref (response);
+    }
+
+    g_slice_free (Request, request);
+}
+
+static void
+client_send_request (BenchClient *bc)
+{
+    Request    *request;
+    QmiMessage *message;
+
+    request = g_slice_new (Request);
+    request->bc = bc;
+    request->start = g_get_monotonic_time ();
+
+    message = qmi_message_new (QMI_SERVICE_WDS,
+                               qmi_client_get_cid (bc->client),
+                               qmi_client_get_next_transaction_id (bc->client),
+                               BENCH_REQUEST_MESSAGE_ID);
+    qmi_device_command_full (bc->device,
+                             message,
+                             NULL,
+                             REQUEST_TIMEOUT,
+                             NULL,
+                             (GAsyncReadyCallback) request_ready,
+                             request);
+    qmi_message_unref (message);
+
+    bc->bench->requests_sent++;
+    bc->bench->requests_in_flight++;
+}
+
+static gboolean
+client_request_cb (BenchClient *bc)
+{
+    guint64 due;
+
+    for (due = rate_timer_due (&bc->request_timer); due > 0; due--)
+        client_send_request (bc);
+    return G_SOURCE_CONTINUE;
+}
+
+static void
+client_indication_cb (QmiDevice   *device,
+                      QmiMessage  *message,
+                      BenchClient *bc)
+{
+    Bench   *bench = bc->bench;
+    gsize    init_offset;
+    gsize    offset = 0;
+    guint64  sent;
+    gint64   delay;
+
+    if (!bench->measuring ||
+        qmi_message_get_service (message) != QMI_SERVICE_WDS ||
+        qmi_message_get_message_id (message) != BENCH_INDICATION_MESSAGE_ID)
+        return;
+
+    if ((init_offset = qmi_message_tlv_read_init (message, BENCH_INDICATION_TLV_TIME, NULL, NULL)) == 0 ||
+        !qmi_message_tlv_read_guint64 (message, init_offset, &offset, QMI_ENDIAN_LITTLE, &sent, NULL))
+        return;
+
+    delay = g_get_monotonic_time () - (gint64) sent;
+    g_array_append_val (bench->indication_delays, delay);
+    bench->indications_received++;
+    if (delay > (gint64) late_threshold_ms * 1000)
+        bench->indications_delayed++;
+}
+
+static void
+client_allocate_ready (QmiDevice    *device,
+                       GAsyncResult *res,
+                       BenchClient  *bc)
+{
+    GError *error = NULL;
+
+    bc->client = qmi_device_allocate_client_finish (device, res, &error);
+    if (!bc->client) {
+        g_printerr ("error: client %u: couldn't allocate WDS client: %s\n", bc->index, error->message);
+        g_error_free (error);
+        bench_step_done (bc->bench, TRUE);
+        return;
+    }
+
+    bc->indication_id = g_signal_connect (bc->device,
+                                          QMI_DEVICE_SIGNAL_INDICATION,
+                                          G_CALLBACK (client_indication_cb),
+                                          bc);
+    bench_step_done (bc->bench, FALSE);
+}
+
+static void
+client_open_ready (QmiDevice    *device,
+                   GAsyncResult *res,
+                   BenchClient  *bc)
+{
+    GError *error = NULL;
+
+    if (!qmi_device_open_finish (device, res, &error)) {
+        g_printerr ("error: client %u: couldn't open proxy connection: %s\n", bc->index, error->message);
+        g_error_free (error);
+        bench_step_done (bc->bench, TRUE);
+        return;
+    }
+
+    /* Goes through the proxy, which tracks the CID in the response */
+    qmi_device_allocate_client (device,
+                                QMI_SERVICE_WDS,
+                                QMI_CID_NONE,
+                                REQUEST_TIMEOUT,
+                                NULL,
+                                (GAsyncReadyCallback) client_allocate_ready,
+                                bc);
+}
+
+static void
+client_new_ready (GObject      *source,
+                  GAsyncResult *res,
+                  BenchClient  *bc)
+{
+    GError *error = NULL;
+
+    bc->device = qmi_device_new_finish (res, &error);
+    if (!bc->device) {
+        g_printerr ("error: client %u: couldn't create device: %s\n", bc->index, error->message);
+        g_error_free (error);
+        bench_step_done (bc->bench, TRUE);
+        return;
+    }
+
+    qmi_device_open (bc->device,
+                     QMI_DEVICE_OPEN_FLAGS_PROXY,
+                     REQUEST_TIMEOUT,
+                     NULL,
+                     (GAsyncReadyCallback) client_open_ready,
+                     bc);
+}
+
+static void
+client_start (BenchClient *bc,
+              const gchar *path)
+{
+    GFile *file;
+
+    file = g_file_new_for_path (path);
+    g_async_initable_new_async (QMI_TYPE_DEVICE,
+                                G_PRIORITY_DEFAULT,
+                                NULL,
+                                (GAsyncReadyCallback) client_new_ready,
+                                bc,
+                                QMI_DEVICE_FILE,          file,
+                                QMI_DEVICE_NO_FILE_CHECK, TRUE,
+                                NULL);
+    g_object_unref (file);
+}
+
+static void
+client_close_ready (QmiDevice    *device,
+                    GAsyncResult *res,
+                    BenchClient  *bc)
+{
+    qmi_device_close_finish (device, res, NULL);
+    bench_step_done (bc->bench, FALSE);
+}
+
+static void
+client_release_ready (QmiDevice    *device,
+                      GAsyncResult *res,
+                      BenchClient  *bc)
+{
+    qmi_device_release_client_finish (device, res, NULL);
+    qmi_device_close_async (device, REQUEST_TIMEOUT, NULL,
+                            (GAsyncReadyCallback) client_close_ready,
+                            bc);
+}
+
+static gboolean
+client_stop (BenchClient *bc)
+{
+    if (bc->indication_id) {
+        g_signal_handler_disconnect (bc->device, bc->indication_id);
+        bc->indication_id = 0;
+    }
+    if (!bc->device)
+        return FALSE;
+
+    if (bc->client)
+        qmi_device_release_client (bc->device,
+                                   bc->client,
+                                   QMI_DEVICE_RELEASE_CLIENT_FLAGS_RELEASE_CID,
+                                   REQUEST_TIMEOUT,
+                                   NULL,
+                                   (GAsyncReadyCallback) client_release_ready,
+                                   bc);
+    else
+        qmi_device_close_async (bc->device, REQUEST_TIMEOUT, NULL,
+                                (GAsyncReadyCallback) client_close_ready,
+                                bc);
+    return TRUE;
+}
+
+/*****************************************************************************/
+/* Report */
+
+static gint
+compare_gint64 (gconstpointer a,
+                gconstpointer b)
+{
+    gint64 va = *((const gint64 *) a);
+    gint64 vb = *((const gint64 *) b);
+
+    return (va > vb) - (va < vb);
+}
+
+static gint64
+percentile (GArray *samples,
+            guint   pct)
+{
+    return g_array_index (samples, gint64, (guint) (((guint64) (samples->len - 1) * pct) / 100));
+}
+
+static void
+print_distribution (const gchar *name,
+                    GArray      *samples)
+{
+    if (!samples->len) {
+        g_print ("%-20s no samples\n", name);
+        return;
+    }
+
+    g_array_sort (samples, compare_gint64);
+    g_print ("%-20s min %" G_GINT64_FORMAT ", p50 %" G_GINT64_FORMAT ", p90 %" G_GINT64_FORMAT
+             ", p99 %" G_GINT64_FORMAT ", max %" G_GINT64_FORMAT " (us)\n",
+             name,
+             percentile (samples, 0),
+             percentile (samples, 50),
+             percentile (samples, 90),
+             percentile (samples, 99),
+             percentile (samples, 100));
+}
+
+/*****************************************************************************/
+
+static gboolean
+measurement_done_cb (Bench *bench)
+{
+    g_main_loop_quit (bench->loop);
+    return G_SOURCE_REMOVE;
+}
+
+int main (int argc, char **argv)
+{
+    GOptionContext *context;
+    GError         *error = NULL;
+    SimDevice      *sim;
+    ProxyThread    *pt;
+    Bench           bench;
+    BenchClient    *clients;
+    gint64          wall_start;
+    gint64          wall_elapsed;
+    gint64          cpu_start;
+    gint64          cpu_elapsed;
+    guint64         indications_expected;
+    guint64         indications_dropped;
+    gint            i;
+    int             status = EXIT_SUCCESS;
+
+    context = g_option_context_new ("- qmi-proxy load generator");
+    g_option_context_add_main_entries (context, main_entries, NULL);
+    if (!g_option_context_parse (context, &argc, &argv, &error)) {
+        g_printerr ("error: %s\n", error->message);
+        exit (EXIT_FAILURE);
+    }
+    g_option_context_free (context);
+
+    if (n_clients <= 0 || request_rate < 0 || indication_rate < 0 || duration <= 0 || late_threshold_ms < 0) {
+        g_printerr ("error: invalid options\n");
+        exit (EXIT_FAILURE);
+    }
+
+    sim = sim_device_new (&error);
+    if (!sim) {
+        g_printerr ("error: %s\n", error->message);
+        exit (EXIT_FAILURE);
+    }
+
+    pt = proxy_thread_new (&error);
+    if (!pt) {
+        g_printerr ("error: %s\n", error->message);
+        sim_device_free (sim);
+        exit (EXIT_FAILURE);
+    }
+
+    memset (&bench, 0, sizeof (bench));
+    bench.loop = g_main_loop_new (NULL, FALSE);
+    bench.request_latencies = g_array_new (FALSE, FALSE, sizeof (gint64));
+    bench.indication_delays = g_array_new (FALSE, FALSE, sizeof (gint64));
+
+    g_print ("device %s, %d clients, %d requests/s per client, %d indications/s, %d s\n",
+             sim->path, n_clients, request_rate, indication_rate, duration);
+
+    /* Connect all clients at once, each one through its own proxy connection */
+    clients = g_new0 (BenchClient, n_clients);
+    for (i = 0; i < n_clients; i++) {
+        clients[i].bench = &bench;
+        clients[i].index = i;
+        bench.pending++;
+        client_start (&clients[i], sim->path);
+    }
+    bench_loop_run (&bench);
+    if (bench.failed) {
+        status = EXIT_FAILURE;
+        goto out;
+    }
+
+    /* Measure */
+    bench.measuring = TRUE;
+    wall_start = g_get_monotonic_time ();
+    cpu_start = proxy_thread_get_cpu_time (pt);
+
+    if (indication_rate > 0)
+        g_main_context_invoke (sim->context, (GSourceFunc) sim_device_start_indications, sim);
+    if (request_rate > 0) {
+        for (i = 0; i < n_clients; i++) {
+            rate_timer_start (&clients[i].request_timer, request_rate);
+            clients[i].request_timeout_id = g_timeout_add (rate_timer_interval_ms (request_rate),
+                                                           (GSourceFunc) client_request_cb,
+                                                           &clients[i]);
+        }
+    }
+
+    g_timeout_add_seconds (duration, (GSourceFunc) measurement_done_cb, &bench);
+    g_main_loop_run (bench.loop);
+
+    cpu_elapsed = proxy_thread_get_cpu_time (pt) - cpu_start;
+    wall_elapsed = g_get_monotonic_time () - wall_start;
+
+    for (i = 0; i < n_clients; i++) {
+        if (clients[i].request_timeout_id) {
+            g_source_remove (clients[i].request_timeout_id);
+            clients[i].request_timeout_id = 0;
+        }
+    }
+    g_main_context_invoke (sim->context, (GSourceFunc) sim_device_stop_indications, sim);
+
+    /* Let in-flight responses and indications arrive */
+    g_timeout_add_seconds (DRAIN_TIMEOUT, (GSourceFunc) measurement_done_cb, &bench);
+    g_main_loop_run (bench.loop);
+    bench.measuring = FALSE;
+
+    indications_expected = (guint64) g_atomic_int_get (&sim->indications_sent) * n_clients;
+    indications_dropped = indications_expected > bench.indications_received ?
+                          indications_expected - bench.indications_received : 0;
+
+    g_print ("proxy cpu:           %.3f s in %.3f s (%.1f%%)\n",
+             (gdouble) cpu_elapsed / G_USEC_PER_SEC,
+             (gdouble) wall_elapsed / G_USEC_PER_SEC,
+             100.0 * (gdouble) cpu_elapsed / (gdouble) MAX (wall_elapsed, 1));
+    g_print ("requests:            %" G_GUINT64_FORMAT " sent, %" G_GUINT64_FORMAT " failed, %" G_GUINT64_FORMAT " unanswered\n",
+             bench.requests_sent, bench.requests_failed, bench.requests_in_flight);
+    print_distribution ("request latency:", bench.request_latencies);
+    g_print ("indications:         %" G_GUINT64_FORMAT " expected, %" G_GUINT64_FORMAT " received, %"
+             G_GUINT64_FORMAT " dropped, %" G_GUINT64_FORMAT " delayed (> %d ms)\n",
+             indications_expected, bench.indications_received, indications_dropped,
+             bench.indications_delayed, late_threshold_ms);
+    print_distribution ("indication delay:", bench.indication_delays);
+
+out:
+    /* Release CIDs and close the proxy connections */
+    for (i = 0; i < n_clients; i++) {
+        if (client_stop (&clients[i]))
+            bench.pending++;
+    }
+    bench_loop_run (&bench);
+
+    for (i = 0; i < n_clients; i++) {
+        g_clear_object (&clients[i].client);
+        g_clear_object (&clients[i].device);
+    }
+    g_free (clients);
+
+    proxy_thread_free (pt);
+    sim_device_free (sim);
+
+    g_array_unref (bench.request_latencies);
+    g_array_unref (bench.indication_delays);
+    g_main_loop_unref (bench.loop);
+
+    return status;
+}
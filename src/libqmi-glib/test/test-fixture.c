@@ -161,7 +161,7 @@ test_fixture_setup (TestFixture *fixture)
                                        response, G_N_ELEMENTS (response),
                                        fixture->service_info[QMI_SERVICE_CTL].transaction_id++);
     }
-    qmi_device_open (fixture->device, QMI_DEVICE_OPEN_FLAGS_PROXY, 1, NULL,
+    qmi_device_open (fixture->device, QMI_DEVICE_OPEN_FLAGS_PROXY | fixture->open_flags, 1, NULL,
                      (GAsyncReadyCallback) device_open_ready,
                      fixture);
     test_fixture_loop_run (fixture);
@@ -251,6 +251,13 @@ device_close_ready (QmiDevice    *device,
     test_fixture_loop_stop (fixture);
 }
 
+void
+test_fixture_setup_worker_thread (TestFixture *fixture)
+{
+    fixture->open_flags = QMI_DEVICE_OPEN_FLAGS_WORKER_THREAD;
+    test_fixture_setup (fixture);
+}
+
 void
 test_fixture_teardown (TestFixture *fixture)
 {
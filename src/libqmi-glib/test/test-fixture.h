@@ -35,9 +35,12 @@ typedef struct {
     TestPortContext *ctx;
     QmiDevice       *device;
     TestServiceInfo  service_info[255];
+    /* Flags used to open the device, on top of the proxy one */
+    QmiDeviceOpenFlags open_flags;
 } TestFixture;
 
 void test_fixture_setup     (TestFixture *fixture);
+void test_fixture_setup_worker_thread (TestFixture *fixture);
 void test_fixture_teardown  (TestFixture *fixture);
 void test_fixture_loop_run  (TestFixture *fixture);
 void test_fixture_loop_stop (TestFixture *fixture);
@@ -51,4 +54,13 @@ typedef void (*TCFunc) (TestFixture *, gconstpointer);
                 (TCFunc)method,                      \
                 (TCFunc)test_fixture_teardown)
 
+/* Same test, with the device doing its I/O in a worker thread */
+#define TEST_ADD_WORKER_THREAD(path,method)          \
+    g_test_add (path,                                \
+                TestFixture,                         \
+                NULL,                                \
+                (TCFunc)test_fixture_setup_worker_thread, \
+                (TCFunc)method,                      \
+                (TCFunc)test_fixture_teardown)
+
 #endif /* TEST_FIXTURE_H */
@@ -353,6 +353,74 @@ test_generated_dms_get_time (TestFixture *fixture)
 
 #endif /* HAVE_QMI_MESSAGE_DMS_GET_TIME */
 
+/*****************************************************************************/
+/* DMS Get Band Capabilities */
+
+#if defined HAVE_QMI_MESSAGE_DMS_GET_BAND_CAPABILITIES
+
+static void
+dms_get_band_capabilities_ready (QmiClientDms *client,
+                                 GAsyncResult *res,
+                                 TestFixture  *fixture)
+{
+    QmiMessageDmsGetBandCapabilitiesOutput *output;
+    GError *error = NULL;
+    gboolean st;
+    GArray *extended_lte_band_capability = NULL;
+
+    output = qmi_client_dms_get_band_capabilities_finish (client, res, &error);
+    g_assert_no_error (error);
+    g_assert (output);
+
+    st = qmi_message_dms_get_band_capabilities_output_get_result (output, &error);
+    g_assert_no_error (error);
+    g_assert (st);
+
+    st = qmi_message_dms_get_band_capabilities_output_get_extended_lte_band_capability (output, &extended_lte_band_capability, &error);
+    g_assert_no_error (error);
+    g_assert (st);
+    g_assert (extended_lte_band_capability);
+    g_assert_cmpuint (extended_lte_band_capability->len, ==, 3);
+    g_assert_cmpuint (g_array_index (extended_lte_band_capability, guint16, 0), ==, 66);
+    g_assert_cmpuint (g_array_index (extended_lte_band_capability, guint16, 1), ==, 71);
+    g_assert_cmpuint (g_array_index (extended_lte_band_capability, guint16, 2), ==, 260);
+
+    qmi_message_dms_get_band_capabilities_output_unref (output);
+
+    test_fixture_loop_stop (fixture);
+}
+
+static void
+test_generated_dms_get_band_capabilities (TestFixture *fixture)
+{
+    guint8 expected[] = {
+        0x01,
+        0x0C, 0x00, 0x00, 0x02, 0x01, 0x00, 0x01, 0x00, 0x45, 0x00,
+        0x00, 0x00
+    };
+    guint8 response[] = {
+        0x01,
+        0x29, 0x00, 0x80, 0x02, 0x01, 0x02, 0x01, 0x00, 0x45, 0x00,
+        0x1D, 0x00,
+        0x02, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x01, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x12, 0x08, 0x00, 0x03, 0x00, 0x42, 0x00, 0x47, 0x00, 0x04, 0x01 /* bands 66, 71, 260 */
+    };
+
+    test_port_context_set_command (fixture->ctx,
+                                   expected, G_N_ELEMENTS (expected),
+                                   response, G_N_ELEMENTS (response),
+                                   fixture->service_info[QMI_SERVICE_DMS].transaction_id++);
+
+    qmi_client_dms_get_band_capabilities (QMI_CLIENT_DMS (fixture->service_info[QMI_SERVICE_DMS].client), NULL, 3, NULL,
+                                          (GAsyncReadyCallback) dms_get_band_capabilities_ready,
+                                          fixture);
+
+    test_fixture_loop_run (fixture);
+}
+
+#endif /* HAVE_QMI_MESSAGE_DMS_GET_BAND_CAPABILITIES */
+
 /*****************************************************************************/
 /* NAS Network Scan */
 
@@ -1090,6 +1158,17 @@ int main (int argc, char **argv)
 #if defined HAVE_QMI_MESSAGE_DMS_GET_TIME
     TEST_ADD ("/libqmi-glib/generated/dms/get-time", test_generated_dms_get_time);
 #endif
+#if defined HAVE_QMI_MESSAGE_DMS_GET_BAND_CAPABILITIES
+    TEST_ADD ("/libqmi-glib/generated/dms/get-band-capabilities", test_generated_dms_get_band_capabilities);
+#endif
+
+    /* A few of the above, with the device I/O done in a worker thread */
+#if defined HAVE_QMI_MESSAGE_DMS_GET_IDS
+    TEST_ADD_WORKER_THREAD ("/libqmi-glib/generated/worker-thread/dms/get-ids", test_generated_dms_get_ids);
+#endif
+#if defined HAVE_QMI_MESSAGE_DMS_GET_TIME
+    TEST_ADD_WORKER_THREAD ("/libqmi-glib/generated/worker-thread/dms/get-time", test_generated_dms_get_time);
+#endif
 
 #if defined HAVE_QMI_MESSAGE_NAS_NETWORK_SCAN
     TEST_ADD ("/libqmi-glib/generated/nas/network-scan", test_generated_nas_network_scan);
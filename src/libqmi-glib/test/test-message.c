@@ -172,6 +172,11 @@ test_message_printable_common (const guint8 *buffer,
     g_autoptr(GError)             error = NULL;
     g_autofree gchar             *printable = NULL;
 
+#if !defined MESSAGE_PRINTABLE_ENABLED
+    g_test_skip ("per-message printable support not generated");
+    return;
+#endif
+
     if (vendor_id != QMI_MESSAGE_VENDOR_GENERIC) {
         context = qmi_message_context_new ();
         qmi_message_context_set_vendor_id (context, vendor_id);
@@ -478,6 +483,35 @@ test_message_tlv_write_empty (void)
     g_assert (ret);
 }
 
+static void
+test_message_tlv_write_sized (void)
+{
+    g_autoptr(QmiMessage) self = NULL;
+    g_autoptr(QmiMessage) reference = NULL;
+    g_autoptr(GError)     error = NULL;
+    gboolean              ret;
+    gsize                 init_offset;
+    const guint8         *data;
+
+    self = qmi_message_new_sized (QMI_SERVICE_DMS, 0x01, 0x02, 0xFFFF, 4);
+    reference = qmi_message_new (QMI_SERVICE_DMS, 0x01, 0x02, 0xFFFF);
+    g_assert_cmpuint (qmi_message_get_length (self), ==, qmi_message_get_length (reference));
+
+    /* The preallocated space is enough for one TLV with a single byte */
+    data = ((GByteArray *)self)->data;
+    init_offset = qmi_message_tlv_write_init (self, 0x01, &error);
+    g_assert_no_error (error);
+    g_assert (init_offset > 0);
+    ret = qmi_message_tlv_write_guint8 (self, 0x0A, &error);
+    g_assert_no_error (error);
+    g_assert (ret);
+    ret = qmi_message_tlv_write_complete (self, init_offset, &error);
+    g_assert_no_error (error);
+    g_assert (ret);
+    g_assert (data == ((GByteArray *)self)->data);
+    g_assert_cmpuint (qmi_message_get_length (self), ==, qmi_message_get_length (reference) + 4);
+}
+
 static void
 test_message_tlv_write_reset (void)
 {
@@ -1607,6 +1641,7 @@ int main (int argc, char **argv)
     g_test_add_func ("/libqmi-glib/message/new/response/error",    test_message_new_response_error);
 
     g_test_add_func ("/libqmi-glib/message/tlv-write/empty",           test_message_tlv_write_empty);
+    g_test_add_func ("/libqmi-glib/message/tlv-write/sized",           test_message_tlv_write_sized);
     g_test_add_func ("/libqmi-glib/message/tlv-write/reset",           test_message_tlv_write_reset);
     g_test_add_func ("/libqmi-glib/message/tlv-rw/8",                  test_message_tlv_rw_8);
     g_test_add_func ("/libqmi-glib/message/tlv-rw/16",                 test_message_tlv_rw_16);
@@ -16,18 +16,36 @@
  */
 
 #include <config.h>
+
+#define _GNU_SOURCE
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
 
+#include <glib-unix.h>
 #include <gio/gio.h>
 #include <gio/gunixsocketaddress.h>
+#include <gio/gunixinputstream.h>
+#include <gio/gunixoutputstream.h>
 #include <libqmi-glib.h>
 
 #include "test-port-context.h"
 
 #define BUFFER_SIZE 1024
 
+#define REPLY_KEY(service,message_id) GUINT_TO_POINTER (((guint) (service) << 16) | (message_id))
+
+typedef struct {
+    QmiProtocolError  error;
+    guint8            tlv_type;
+    GByteArray       *tlv_value;
+} Reply;
+
 struct _TestPortContext {
     gchar *name;
     GThread *thread;
@@ -40,6 +58,15 @@ struct _TestPortContext {
     GMutex command_mutex;
     GByteArray *command;
     GByteArray *response;
+    GMainContext *context;
+    /* Scripted responder */
+    GHashTable *replies;
+    guint reply_delay_ms;
+    guint8 last_cid[G_MAXUINT8 + 1];
+    /* Pseudo-terminal served along with the socket */
+    gchar *tty_path;
+    gint tty_master;
+    gint tty_keepalive;
 };
 
 /*****************************************************************************/
@@ -163,11 +190,121 @@ process_next_command (TestPortContext *ctx,
     return response;
 }
 
+/*****************************************************************************/
+/* Scripted responder */
+
+static void
+reply_free (Reply *reply)
+{
+    if (reply->tlv_value)
+        g_byte_array_unref (reply->tlv_value);
+    g_slice_free (Reply, reply);
+}
+
+void
+test_port_context_add_reply (TestPortContext  *ctx,
+                             QmiService        service,
+                             guint16           message_id,
+                             QmiProtocolError  error,
+                             guint8            tlv_type,
+                             const guint8     *tlv_value,
+                             gsize             tlv_value_size)
+{
+    Reply *reply;
+
+    g_assert (ctx->thread == NULL);
+    g_assert (service != QMI_SERVICE_CTL);
+
+    if (!ctx->replies)
+        ctx->replies = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify)reply_free);
+
+    reply = g_slice_new0 (Reply);
+    reply->error = error;
+    reply->tlv_type = tlv_type;
+    if (tlv_value_size)
+        reply->tlv_value = g_byte_array_append (g_byte_array_sized_new (tlv_value_size), tlv_value, tlv_value_size);
+    g_hash_table_replace (ctx->replies, REPLY_KEY (service, message_id), reply);
+}
+
+void
+test_port_context_set_reply_delay (TestPortContext *ctx,
+                                   guint            delay_ms)
+{
+    g_assert (ctx->thread == NULL);
+    ctx->reply_delay_ms = delay_ms;
+}
+
+static QmiMessage *
+build_scripted_response (TestPortContext *ctx,
+                         QmiMessage      *message)
+{
+    QmiMessage *response;
+    Reply      *reply;
+    gsize       init_offset;
+    gsize       offset = 0;
+    guint8      service = 0;
+    guint8      cid = 0;
+
+    if (!qmi_message_is_request (message))
+        return NULL;
+
+    /* CTL requests (proxy open, client allocation and release) always succeed */
+    if (qmi_message_get_service (message) == QMI_SERVICE_CTL) {
+        response = qmi_message_response_new (message, QMI_PROTOCOL_ERROR_NONE);
+        g_assert (response);
+
+        switch (qmi_message_get_message_id (message)) {
+        case QMI_MESSAGE_CTL_ALLOCATE_CID:
+            if ((init_offset = qmi_message_tlv_read_init (message, QMI_MESSAGE_TLV_ALLOCATION_INFO, NULL, NULL)) > 0 &&
+                qmi_message_tlv_read_guint8 (message, init_offset, &offset, &service, NULL)) {
+                /* Never hand out the broadcast CID, nor 0 */
+                cid = ++ctx->last_cid[service];
+                if (cid == QMI_CID_BROADCAST)
+                    cid = ctx->last_cid[service] = 1;
+            }
+            break;
+        case QMI_MESSAGE_CTL_RELEASE_CID:
+            if ((init_offset = qmi_message_tlv_read_init (message, QMI_MESSAGE_TLV_ALLOCATION_INFO, NULL, NULL)) > 0) {
+                qmi_message_tlv_read_guint8 (message, init_offset, &offset, &service, NULL);
+                qmi_message_tlv_read_guint8 (message, init_offset, &offset, &cid, NULL);
+            }
+            break;
+        default:
+            break;
+        }
+
+        if (cid) {
+            init_offset = qmi_message_tlv_write_init (response, QMI_MESSAGE_TLV_ALLOCATION_INFO, NULL);
+            if (!init_offset ||
+                !qmi_message_tlv_write_guint8 (response, service, NULL) ||
+                !qmi_message_tlv_write_guint8 (response, cid, NULL) ||
+                !qmi_message_tlv_write_complete (response, init_offset, NULL))
+                g_assert_not_reached ();
+        }
+        return response;
+    }
+
+    reply = g_hash_table_lookup (ctx->replies,
+                                 REPLY_KEY (qmi_message_get_service (message),
+                                            qmi_message_get_message_id (message)));
+    if (!reply)
+        return qmi_message_response_new (message, QMI_PROTOCOL_ERROR_INVALID_QMI_COMMAND);
+
+    response = qmi_message_response_new (message, reply->error);
+    g_assert (response);
+    if (reply->tlv_value &&
+        !qmi_message_add_raw_tlv (response, reply->tlv_type, reply->tlv_value->data, reply->tlv_value->len, NULL))
+        g_assert_not_reached ();
+    return response;
+}
+
 /*****************************************************************************/
 
 typedef struct {
     TestPortContext *ctx;
-    GSocketConnection *connection;
+    GSocketConnection *connection; /* NULL for the pseudo-terminal */
+    GInputStream *istream;
+    GOutputStream *ostream;
     GSource *connection_readable_source;
     GByteArray *buffer;
 } Client;
@@ -177,10 +314,13 @@ client_free (Client *client)
 {
     g_source_destroy (client->connection_readable_source);
     g_source_unref (client->connection_readable_source);
-    g_output_stream_close (g_io_stream_get_output_stream (G_IO_STREAM (client->connection)), NULL, NULL);
+    g_output_stream_close (client->ostream, NULL, NULL);
     if (client->buffer)
         g_byte_array_unref (client->buffer);
-    g_object_unref (client->connection);
+    g_object_unref (client->istream);
+    g_object_unref (client->ostream);
+    if (client->connection)
+        g_object_unref (client->connection);
     g_slice_free (Client, client);
 }
 
@@ -191,34 +331,107 @@ connection_close (Client *client)
     client_free (client);
 }
 
+static void
+client_write (Client       *client,
+              const guint8 *data,
+              gsize         data_size)
+{
+    GError *error = NULL;
+
+    if (!g_output_stream_write_all (client->ostream,
+                                    data,
+                                    data_size,
+                                    NULL, /* bytes_written */
+                                    NULL, /* cancellable */
+                                    &error)) {
+        g_warning ("Cannot send response to client: %s", error->message);
+        g_error_free (error);
+    }
+}
+
+typedef struct {
+    Client     *client;
+    QmiMessage *response;
+} DelayedReply;
+
+static void
+delayed_reply_free (DelayedReply *delayed)
+{
+    qmi_message_unref (delayed->response);
+    g_slice_free (DelayedReply, delayed);
+}
+
+static gboolean
+delayed_reply_cb (DelayedReply *delayed)
+{
+    /* The client may have gone away in the meantime */
+    if (g_list_find (delayed->client->ctx->clients, delayed->client))
+        client_write (delayed->client,
+                      ((GByteArray *)delayed->response)->data,
+                      ((GByteArray *)delayed->response)->len);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+client_parse_scripted_requests (Client *client)
+{
+    QmiMessage *message;
+    GError     *error = NULL;
+
+    while ((message = qmi_message_new_from_raw (client->buffer, &error)) != NULL) {
+        QmiMessage *response;
+
+        response = build_scripted_response (client->ctx, message);
+        qmi_message_unref (message);
+        if (!response)
+            continue;
+
+        if (!client->ctx->reply_delay_ms) {
+            client_write (client, ((GByteArray *)response)->data, ((GByteArray *)response)->len);
+            qmi_message_unref (response);
+        } else {
+            DelayedReply *delayed;
+            GSource      *source;
+
+            delayed = g_slice_new (DelayedReply);
+            delayed->client = client;
+            delayed->response = response;
+            source = g_timeout_source_new (client->ctx->reply_delay_ms);
+            g_source_set_callback (source,
+                                   (GSourceFunc)delayed_reply_cb,
+                                   delayed,
+                                   (GDestroyNotify)delayed_reply_free);
+            g_source_attach (source, g_main_context_get_thread_default ());
+            g_source_unref (source);
+        }
+    }
+
+    /* We broke framing */
+    g_assert_no_error (error);
+}
+
 static void
 client_parse_request (Client *client)
 {
     GByteArray *response;
 
+    if (client->ctx->replies) {
+        client_parse_scripted_requests (client);
+        return;
+    }
+
     do {
         response = process_next_command (client->ctx, client->buffer);
         if (response) {
-            GError *error = NULL;
-
-            if (!g_output_stream_write_all (g_io_stream_get_output_stream (G_IO_STREAM (client->connection)),
-                                            response->data,
-                                            response->len,
-                                            NULL, /* bytes_written */
-                                            NULL, /* cancellable */
-                                            &error)) {
-                g_warning ("Cannot send response to client: %s", error->message);
-                g_error_free (error);
-            }
+            client_write (client, response->data, response->len);
             g_byte_array_unref (response);
         }
     } while (response);
 }
 
 static gboolean
-connection_readable_cb (GSocket *socket,
-                        GIOCondition condition,
-                        Client *client)
+client_readable (Client       *client,
+                 GIOCondition  condition)
 {
     guint8 buffer[BUFFER_SIZE];
     GError *error = NULL;
@@ -233,7 +446,7 @@ connection_readable_cb (GSocket *socket,
     if (!(condition & G_IO_IN || condition & G_IO_PRI))
         return TRUE;
 
-    r = g_input_stream_read (g_io_stream_get_input_stream (G_IO_STREAM (client->connection)),
+    r = g_input_stream_read (client->istream,
                              buffer,
                              BUFFER_SIZE,
                              NULL,
@@ -262,6 +475,22 @@ connection_readable_cb (GSocket *socket,
     return TRUE;
 }
 
+static gboolean
+connection_readable_cb (GSocket *socket,
+                        GIOCondition condition,
+                        Client *client)
+{
+    return client_readable (client, condition);
+}
+
+static gboolean
+tty_readable_cb (gint fd,
+                 GIOCondition condition,
+                 Client *client)
+{
+    return client_readable (client, condition);
+}
+
 static Client *
 client_new (TestPortContext *ctx,
             GSocketConnection *connection)
@@ -271,6 +500,8 @@ client_new (TestPortContext *ctx,
     client = g_slice_new0 (Client);
     client->ctx = ctx;
     client->connection = g_object_ref (connection);
+    client->istream = g_object_ref (g_io_stream_get_input_stream (G_IO_STREAM (connection)));
+    client->ostream = g_object_ref (g_io_stream_get_output_stream (G_IO_STREAM (connection)));
     client->connection_readable_source = g_socket_create_source (g_socket_connection_get_socket (client->connection),
                                                                  G_IO_IN | G_IO_PRI | G_IO_ERR | G_IO_HUP,
                                                                  NULL);
@@ -283,6 +514,92 @@ client_new (TestPortContext *ctx,
     return client;
 }
 
+static Client *
+client_new_tty (TestPortContext *ctx)
+{
+    Client *client;
+
+    client = g_slice_new0 (Client);
+    client->ctx = ctx;
+    client->istream = g_unix_input_stream_new (ctx->tty_master, FALSE);
+    client->ostream = g_unix_output_stream_new (ctx->tty_master, FALSE);
+    client->connection_readable_source = g_unix_fd_source_new (ctx->tty_master,
+                                                               G_IO_IN | G_IO_PRI | G_IO_ERR | G_IO_HUP);
+    g_source_set_callback (client->connection_readable_source,
+                           (GSourceFunc)tty_readable_cb,
+                           client,
+                           NULL);
+    g_source_attach (client->connection_readable_source, g_main_context_get_thread_default ());
+
+    return client;
+}
+
+/*****************************************************************************/
+/* Indication bursts */
+
+typedef struct {
+    TestPortContext *ctx;
+    QmiService       service;
+    guint16          message_id;
+    guint            count;
+} IndicationBurst;
+
+static void
+indication_burst_free (IndicationBurst *burst)
+{
+    g_slice_free (IndicationBurst, burst);
+}
+
+static gboolean
+indication_burst_cb (IndicationBurst *burst)
+{
+    guint i;
+
+    for (i = 0; i < burst->count; i++) {
+        QmiMessage *message;
+        gsize       init_offset;
+        GList      *l;
+
+        message = qmi_message_new (burst->service, QMI_CID_BROADCAST, 0, burst->message_id);
+        ((GByteArray *)message)->data[QMI_FLAGS_OFFSET] = QMI_FLAGS_INDICATION;
+
+        /* Every indication carries the time it was sent at */
+        init_offset = qmi_message_tlv_write_init (message, TEST_PORT_CONTEXT_INDICATION_TLV_TIME, NULL);
+        if (!init_offset ||
+            !qmi_message_tlv_write_guint64 (message, QMI_ENDIAN_LITTLE, (guint64) g_get_monotonic_time (), NULL) ||
+            !qmi_message_tlv_write_complete (message, init_offset, NULL))
+            g_assert_not_reached ();
+
+        for (l = burst->ctx->clients; l; l = g_list_next (l))
+            client_write ((Client *)l->data, ((GByteArray *)message)->data, ((GByteArray *)message)->len);
+        qmi_message_unref (message);
+    }
+
+    return G_SOURCE_REMOVE;
+}
+
+void
+test_port_context_send_indications (TestPortContext *ctx,
+                                    QmiService       service,
+                                    guint16          message_id,
+                                    guint            count)
+{
+    IndicationBurst *burst;
+
+    g_assert (ctx->context != NULL);
+
+    burst = g_slice_new (IndicationBurst);
+    burst->ctx = ctx;
+    burst->service = service;
+    burst->message_id = message_id;
+    burst->count = count;
+    g_main_context_invoke_full (ctx->context,
+                                G_PRIORITY_DEFAULT,
+                                (GSourceFunc)indication_burst_cb,
+                                burst,
+                                (GDestroyNotify)indication_burst_free);
+}
+
 /* /\*****************************************************************************\/ */
 
 static void
@@ -375,6 +692,10 @@ port_context_thread_func (TestPortContext *ctx)
 
     thread_context = g_main_context_new ();
     g_main_context_push_thread_default (thread_context);
+    ctx->context = thread_context;
+
+    if (ctx->tty_master >= 0)
+        ctx->clients = g_list_append (ctx->clients, client_new_tty (ctx));
 
     create_socket_service (ctx);
 
@@ -386,6 +707,48 @@ port_context_thread_func (TestPortContext *ctx)
     return NULL;
 }
 
+const gchar *
+test_port_context_open_tty (TestPortContext  *ctx,
+                            GError          **error)
+{
+    struct termios tio;
+
+    g_assert (ctx->thread == NULL);
+    g_assert (ctx->tty_master < 0);
+
+    ctx->tty_master = posix_openpt (O_RDWR | O_NOCTTY);
+    if (ctx->tty_master < 0 || grantpt (ctx->tty_master) < 0 || unlockpt (ctx->tty_master) < 0) {
+        g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errno),
+                     "couldn't create pseudo-terminal: %s", g_strerror (errno));
+        goto failed;
+    }
+    ctx->tty_path = g_strdup (ptsname (ctx->tty_master));
+
+    /* QMUX messages are binary, no line discipline processing at all */
+    if (tcgetattr (ctx->tty_master, &tio) == 0) {
+        cfmakeraw (&tio);
+        tcsetattr (ctx->tty_master, TCSANOW, &tio);
+    }
+
+    /* Keep the slave open ourselves so that the master doesn't report
+     * hang-ups while nobody has it open */
+    ctx->tty_keepalive = open (ctx->tty_path, O_RDWR | O_NOCTTY);
+    if (ctx->tty_keepalive < 0) {
+        g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errno),
+                     "couldn't open pseudo-terminal '%s': %s", ctx->tty_path, g_strerror (errno));
+        goto failed;
+    }
+
+    return ctx->tty_path;
+
+failed:
+    if (ctx->tty_master >= 0)
+        close (ctx->tty_master);
+    ctx->tty_master = -1;
+    g_clear_pointer (&ctx->tty_path, g_free);
+    return NULL;
+}
+
 void
 test_port_context_start (TestPortContext *ctx)
 {
@@ -425,6 +788,13 @@ test_port_context_free (TestPortContext *ctx)
         g_byte_array_unref (ctx->command);
     if (ctx->response)
         g_byte_array_unref (ctx->response);
+    if (ctx->replies)
+        g_hash_table_unref (ctx->replies);
+    if (ctx->tty_keepalive >= 0)
+        close (ctx->tty_keepalive);
+    if (ctx->tty_master >= 0)
+        close (ctx->tty_master);
+    g_free (ctx->tty_path);
     g_slice_free (TestPortContext, ctx);
 }
 
@@ -438,5 +808,7 @@ test_port_context_new (const gchar *name)
     g_cond_init (&ctx->ready_cond);
     g_mutex_init (&ctx->ready_mutex);
     g_mutex_init (&ctx->command_mutex);
+    ctx->tty_master = -1;
+    ctx->tty_keepalive = -1;
     return ctx;
 }
@@ -20,6 +20,20 @@
 
 #include <glib.h>
 #include <glib-object.h>
+#include <libqmi-glib.h>
+
+/* Constants for allocating/releasing clients */
+#define QMI_MESSAGE_CTL_ALLOCATE_CID    0x0022
+#define QMI_MESSAGE_CTL_RELEASE_CID     0x0023
+#define QMI_MESSAGE_TLV_ALLOCATION_INFO 0x01
+
+/* Offset of the QMI flags in a raw QMUX message, and the indication flag */
+#define QMI_FLAGS_OFFSET     6
+#define QMI_FLAGS_INDICATION 0x04
+
+/* TLV carrying the monotonic time an indication was sent at, as a
+ * little endian guint64 */
+#define TEST_PORT_CONTEXT_INDICATION_TLV_TIME 0x01
 
 typedef struct _TestPortContext TestPortContext;
 
@@ -34,4 +48,30 @@ void             test_port_context_set_command   (TestPortContext *ctx,
                                                   gsize            response_size,
                                                   guint16          transaction_id);
 
+/* Scripted responder: once a reply is added, the context no longer expects
+ * exact commands, it answers CTL requests itself and every other request
+ * with the reply for its service and message (or with an invalid QMI
+ * command error). Replies and delay must be set before starting. */
+void             test_port_context_add_reply     (TestPortContext  *ctx,
+                                                  QmiService        service,
+                                                  guint16           message_id,
+                                                  QmiProtocolError  error,
+                                                  guint8            tlv_type,
+                                                  const guint8     *tlv_value,
+                                                  gsize             tlv_value_size);
+void             test_port_context_set_reply_delay (TestPortContext *ctx,
+                                                    guint            delay_ms);
+
+/* Broadcast a burst of indications to every client */
+void             test_port_context_send_indications (TestPortContext *ctx,
+                                                     QmiService       service,
+                                                     guint16          message_id,
+                                                     guint            count);
+
+/* Also serve the master side of a pseudo-terminal, whose slave (the
+ * returned path) can be opened as a QMUX device, e.g. by qmi-proxy. Must be
+ * called before starting. */
+const gchar     *test_port_context_open_tty      (TestPortContext  *ctx,
+                                                  GError          **error);
+
 #endif /* TEST_PORT_CONTEXT_H */
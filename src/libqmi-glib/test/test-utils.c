@@ -105,6 +105,20 @@ test_read_string_from_plmn_encoded_array_ucs2le (void)
     common_test_read_string_from_plmn_encoded_array (QMI_NAS_PLMN_ENCODING_SCHEME_UCS2LE, ucs2le, G_N_ELEMENTS (ucs2le), expected_utf8);
 }
 
+static void
+test_read_string_from_plmn_encoded_array_ucs2le_non_ascii (void)
+{
+    const guint8 ucs2le[] = {
+        0x4d, 0x00, 0x6f, 0x00, 0x76, 0x00, 0x69, 0x00,
+        0x73, 0x00, 0x74, 0x00, 0x61, 0x00, 0x72, 0x00,
+        0x20, 0x00, 0xe9, 0x00, 0xac, 0x20, 0x3d, 0xd8,
+        0x00, 0xde, 0x21, 0x00
+    };
+    const gchar *expected_utf8 = "Movistar é€😀!";
+
+    common_test_read_string_from_plmn_encoded_array (QMI_NAS_PLMN_ENCODING_SCHEME_UCS2LE, ucs2le, G_N_ELEMENTS (ucs2le), expected_utf8);
+}
+
 /******************************************************************************/
 
 static void
@@ -245,6 +259,7 @@ int main (int argc, char **argv)
     g_test_add_func ("/libqmi-glib/utils/read-string-from-plmn-encoded-array/gsm7-extended-chars", test_read_string_from_plmn_encoded_array_gsm7_extended_chars);
     g_test_add_func ("/libqmi-glib/utils/read-string-from-plmn-encoded-array/gsm7-mixed-chars",    test_read_string_from_plmn_encoded_array_gsm7_mixed_chars);
     g_test_add_func ("/libqmi-glib/utils/read-string-from-plmn-encoded-array/ucs2le",              test_read_string_from_plmn_encoded_array_ucs2le);
+    g_test_add_func ("/libqmi-glib/utils/read-string-from-plmn-encoded-array/ucs2le-non-ascii",    test_read_string_from_plmn_encoded_array_ucs2le_non_ascii);
 
     g_test_add_func ("/libqmi-glib/utils/read-string-from-network-description-encoded-array/gsm7-default-chars",  test_read_string_from_network_description_encoded_array_gsm7_default_chars);
     g_test_add_func ("/libqmi-glib/utils/read-string-from-network-description-encoded-array/gsm7-extended-chars", test_read_string_from_network_description_encoded_array_gsm7_extended_chars);
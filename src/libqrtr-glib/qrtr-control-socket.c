@@ -21,6 +21,9 @@
  * Copyright (C) 2020 Aleksander Morgado <aleksander@aleksander.es>
  */
 
+#define _GNU_SOURCE
+#include <config.h>
+
 #include <endian.h>
 #include <errno.h>
 #include <linux/qrtr.h>
@@ -60,13 +63,31 @@ struct _QrtrControlSocketPrivate {
 
 /*****************************************************************************/
 
+static void
+track_burst_node (QrtrNode  *node,
+                  GPtrArray *burst_nodes)
+{
+    guint i;
+
+    /* The first time a node is touched while processing a burst of control
+     * packets, freeze its waiters so that they're checked once at the end
+     * instead of once per added service. */
+    for (i = 0; i < burst_nodes->len; i++) {
+        if (g_ptr_array_index (burst_nodes, i) == node)
+            return;
+    }
+    __qrtr_node_freeze_waiters (node);
+    g_ptr_array_add (burst_nodes, g_object_ref (node));
+}
+
 static void
 add_service_info (QrtrControlSocket *self,
                   guint32            node_id,
                   guint32            port,
                   guint32            service,
                   guint32            version,
-                  guint32            instance)
+                  guint32            instance,
+                  GPtrArray         *burst_nodes)
 {
     QrtrNode *node;
 
@@ -78,6 +99,7 @@ add_service_info (QrtrControlSocket *self,
         g_signal_emit (self, signals[SIGNAL_NODE_ADDED], 0, node_id);
     }
 
+    track_burst_node (node, burst_nodes);
     __qrtr_node_add_service_info (node, service, port, version, instance);
     g_signal_emit (self, signals[SIGNAL_SERVICE_ADDED], 0, node_id, service);
 }
@@ -109,63 +131,134 @@ remove_service_info (QrtrControlSocket *self,
 
 /*****************************************************************************/
 
-static gboolean
-qrtr_ctrl_message_cb (GSocket           *gsocket,
-                      GIOCondition       cond,
-                      QrtrControlSocket *self)
+static void
+process_ctrl_packet (QrtrControlSocket          *self,
+                     const struct qrtr_ctrl_pkt *ctrl_packet,
+                     gsize                       packet_len,
+                     GPtrArray                  *burst_nodes)
 {
-    GError               *error = NULL;
-    struct qrtr_ctrl_pkt  ctrl_packet;
-    gssize                bytes_received;
-    guint32               type;
-    guint32               node_id;
-    guint32               port;
-    guint32               service;
-    guint32               version;
-    guint32               instance;
-
-    /* check for message type and add/remove nodes here */
-
-    bytes_received = g_socket_receive (gsocket, (gchar *)&ctrl_packet,
-                                       sizeof (ctrl_packet), NULL, &error);
-    if (bytes_received < 0) {
-        g_warning ("[qrtr] socket i/o failure: %s", error->message);
-        g_error_free (error);
-        return FALSE;
-    }
-
-    if ((gsize)bytes_received < sizeof (ctrl_packet)) {
+    guint32 type;
+    guint32 node_id;
+    guint32 port;
+    guint32 service;
+    guint32 version;
+    guint32 instance;
+
+    if (packet_len < sizeof (*ctrl_packet)) {
         g_debug ("[qrtr] short packet received: ignoring");
-        return TRUE;
+        return;
     }
 
-    type = GUINT32_FROM_LE (ctrl_packet.cmd);
+    type = GUINT32_FROM_LE (ctrl_packet->cmd);
     if (type != QRTR_TYPE_NEW_SERVER && type != QRTR_TYPE_DEL_SERVER) {
         g_debug ("[qrtr] unknown packet type received: 0x%x", type);
-        return TRUE;
+        return;
     }
 
     /* type is something we handle, parse the packet */
-    node_id = GUINT32_FROM_LE (ctrl_packet.server.node);
-    port = GUINT32_FROM_LE (ctrl_packet.server.port);
-    service = GUINT32_FROM_LE (ctrl_packet.server.service);
-    version = GUINT32_FROM_LE (ctrl_packet.server.instance) & 0xff;
-    instance = GUINT32_FROM_LE (ctrl_packet.server.instance) >> 8;
+    node_id = GUINT32_FROM_LE (ctrl_packet->server.node);
+    port = GUINT32_FROM_LE (ctrl_packet->server.port);
+    service = GUINT32_FROM_LE (ctrl_packet->server.service);
+    version = GUINT32_FROM_LE (ctrl_packet->server.instance) & 0xff;
+    instance = GUINT32_FROM_LE (ctrl_packet->server.instance) >> 8;
 
     if (type == QRTR_TYPE_NEW_SERVER) {
         g_debug ("[qrtr] added server on %u:%u -> service %u, version %u, instance %u",
                 node_id, port, service, version, instance);
-        add_service_info (self, node_id, port, service, version, instance);
+        add_service_info (self, node_id, port, service, version, instance, burst_nodes);
     } else if (type == QRTR_TYPE_DEL_SERVER) {
         g_debug ("[qrtr] removed server on %u:%u -> service %u, version %u, instance %u",
                 node_id, port, service, version, instance);
         remove_service_info (self, node_id, port, service, version, instance);
     } else
         g_assert_not_reached ();
+}
+
+/* Max number of control packets read from the socket at once */
+#define CTRL_PACKET_BATCH_SIZE 32
+
+static gboolean
+receive_ctrl_packets (QrtrControlSocket *self,
+                      GSocket           *gsocket,
+                      GPtrArray         *burst_nodes)
+{
+    struct qrtr_ctrl_pkt ctrl_packets[CTRL_PACKET_BATCH_SIZE];
+    guint                n_received;
+
+    /* A node announces all its services in a burst, so keep reading until the
+     * socket is drained instead of going back to the main loop after every
+     * single packet. */
+    do {
+#if defined HAVE_RECVMMSG
+        struct mmsghdr msgs[CTRL_PACKET_BATCH_SIZE];
+        struct iovec   iovs[CTRL_PACKET_BATCH_SIZE];
+        gint           rc;
+        guint          i;
+
+        memset (msgs, 0, sizeof (msgs));
+        for (i = 0; i < CTRL_PACKET_BATCH_SIZE; i++) {
+            iovs[i].iov_base = &ctrl_packets[i];
+            iovs[i].iov_len = sizeof (ctrl_packets[i]);
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        rc = recvmmsg (g_socket_get_fd (gsocket), msgs, CTRL_PACKET_BATCH_SIZE, MSG_DONTWAIT, NULL);
+        if (rc < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+                return TRUE;
+            g_warning ("[qrtr] socket i/o failure: %s", g_strerror (errno));
+            return FALSE;
+        }
+
+        n_received = (guint) rc;
+        for (i = 0; i < n_received; i++)
+            process_ctrl_packet (self, &ctrl_packets[i], msgs[i].msg_len, burst_nodes);
+#else
+        for (n_received = 0; n_received < CTRL_PACKET_BATCH_SIZE; n_received++) {
+            GError *error = NULL;
+            gssize  bytes_received;
+
+            bytes_received = g_socket_receive (gsocket, (gchar *)&ctrl_packets[0],
+                                               sizeof (ctrl_packets[0]), NULL, &error);
+            if (bytes_received < 0) {
+                if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK)) {
+                    g_error_free (error);
+                    return TRUE;
+                }
+                g_warning ("[qrtr] socket i/o failure: %s", error->message);
+                g_error_free (error);
+                return FALSE;
+            }
+            process_ctrl_packet (self, &ctrl_packets[0], (gsize)bytes_received, burst_nodes);
+        }
+#endif
+    } while (n_received == CTRL_PACKET_BATCH_SIZE);
 
     return TRUE;
 }
 
+static gboolean
+qrtr_ctrl_message_cb (GSocket           *gsocket,
+                      GIOCondition       cond,
+                      QrtrControlSocket *self)
+{
+    g_autoptr(GPtrArray) burst_nodes = NULL;
+    gboolean             keep_source;
+    guint                i;
+
+    /* check for message type and add/remove nodes here */
+
+    burst_nodes = g_ptr_array_new_with_free_func (g_object_unref);
+    keep_source = receive_ctrl_packets (self, gsocket, burst_nodes);
+
+    /* Check the pending service waiters once per burst */
+    for (i = 0; i < burst_nodes->len; i++)
+        __qrtr_node_thaw_waiters (g_ptr_array_index (burst_nodes, i));
+
+    return keep_source;
+}
+
 /*****************************************************************************/
 
 QrtrNode *
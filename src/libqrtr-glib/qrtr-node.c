@@ -63,6 +63,13 @@ struct _QrtrNodePrivate {
     GHashTable *service_index;
     /* Maps port number to service entry (should only be one) */
     GHashTable *port_index;
+    /* Last entry found in the port index; most messages come from the same
+     * port as the previous one, so this skips the hash table lookup */
+    struct QrtrServiceInfo *port_cache;
+
+    /* Waiter dispatching is deferred while frozen */
+    guint    waiters_freeze_count;
+    gboolean waiters_dispatch_pending;
 
     /* Array of QrtrServiceWaiters currently registered. */
     GPtrArray *waiters;
@@ -244,10 +251,17 @@ __qrtr_node_add_service_info (QrtrNode *node,
     info->port = port;
     info->version = version;
     info->instance = instance;
-    node->priv->service_list = g_list_append (node->priv->service_list, info);
+    /* The list order is irrelevant, and prepending avoids walking it */
+    node->priv->service_list = g_list_prepend (node->priv->service_list, info);
     service_index_add_info (node->priv->service_index, service, info);
+    if (node->priv->port_cache && node->priv->port_cache->port == port)
+        node->priv->port_cache = NULL;
     g_hash_table_insert (node->priv->port_index, GUINT_TO_POINTER (port), info);
-    dispatch_pending_waiters (node);
+
+    if (node->priv->waiters_freeze_count > 0)
+        node->priv->waiters_dispatch_pending = TRUE;
+    else
+        dispatch_pending_waiters (node);
 }
 
 void
@@ -267,11 +281,33 @@ __qrtr_node_remove_service_info (QrtrNode *node,
     }
 
     service_index_remove_info (node->priv->service_index, service, info);
+    if (node->priv->port_cache == info)
+        node->priv->port_cache = NULL;
     g_hash_table_remove (node->priv->port_index, GUINT_TO_POINTER (port));
     node->priv->service_list = g_list_remove (node->priv->service_list, info);
     service_info_free (info);
 }
 
+void
+__qrtr_node_freeze_waiters (QrtrNode *node)
+{
+    node->priv->waiters_freeze_count++;
+}
+
+void
+__qrtr_node_thaw_waiters (QrtrNode *node)
+{
+    g_assert (node->priv->waiters_freeze_count > 0);
+
+    if (--node->priv->waiters_freeze_count > 0)
+        return;
+
+    if (node->priv->waiters_dispatch_pending) {
+        node->priv->waiters_dispatch_pending = FALSE;
+        dispatch_pending_waiters (node);
+    }
+}
+
 /*****************************************************************************/
 
 gint32
@@ -301,8 +337,14 @@ qrtr_node_lookup_service (QrtrNode *node,
 {
     struct QrtrServiceInfo *info;
 
-    info = g_hash_table_lookup (node->priv->port_index, GUINT_TO_POINTER (port));
-    return info ? (gint32)info->service : -1;
+    info = node->priv->port_cache;
+    if (!info || info->port != port) {
+        info = g_hash_table_lookup (node->priv->port_index, GUINT_TO_POINTER (port));
+        if (!info)
+            return -1;
+        node->priv->port_cache = info;
+    }
+    return (gint32)info->service;
 }
 
 /*****************************************************************************/
@@ -187,6 +187,14 @@ void __qrtr_node_remove_service_info (QrtrNode *node,
                                       guint32   version,
                                       guint32   instance);
 
+/* While frozen, services may be added without checking the pending
+ * waiters every time; they're all checked once when thawed. */
+G_GNUC_INTERNAL
+void __qrtr_node_freeze_waiters (QrtrNode *node);
+
+G_GNUC_INTERNAL
+void __qrtr_node_thaw_waiters (QrtrNode *node);
+
 #endif /* defined (LIBQMI_GLIB_COMPILATION) */
 
 #endif /* _LIBQRTR_GLIB_QRTR_NODE_H_ */
@@ -58,6 +58,38 @@ struct _QfuAtDevicePrivate {
     GByteArray *buffer;
 };
 
+/******************************************************************************/
+
+/* Like select() on @fd, but also returning as soon as @cancellable is
+ * cancelled, so that the caller doesn't wait for the whole timeout. */
+static gint
+select_with_cancellable (gint            fd,
+                         fd_set         *rd,
+                         fd_set         *wr,
+                         struct timeval *tv,
+                         GCancellable   *cancellable)
+{
+    fd_set aux_rd;
+    gint   cancellable_fd;
+    gint   aux;
+
+    cancellable_fd = g_cancellable_get_fd (cancellable);
+    if (cancellable_fd < 0)
+        return select (fd + 1, rd, wr, NULL, tv);
+
+    if (!rd) {
+        FD_ZERO (&aux_rd);
+        rd = &aux_rd;
+    }
+    FD_SET (cancellable_fd, rd);
+    aux = select (MAX (fd, cancellable_fd) + 1, rd, wr, NULL, tv);
+    if (aux > 0 && FD_ISSET (cancellable_fd, rd))
+        aux--;
+    g_cancellable_release_fd (cancellable);
+
+    return aux;
+}
+
 /******************************************************************************/
 /* Send */
 
@@ -75,10 +107,11 @@ send_request (QfuAtDevice   *self,
         .tv_usec = 0,
     };
 
-    /* Wait for the fd to be writable and don't wait forever */
+    /* Wait for the fd to be writable and don't wait forever; the read set
+     * only has the cancellable fd, if any */
     FD_ZERO (&wr);
     FD_SET (self->priv->fd, &wr);
-    aux = select (self->priv->fd + 1, NULL, &wr, NULL, &tv);
+    aux = select_with_cancellable (self->priv->fd, NULL, &wr, &tv, cancellable);
 
     if (g_cancellable_set_error_if_cancelled (cancellable, error))
         return FALSE;
@@ -150,7 +183,7 @@ receive_response (QfuAtDevice   *self,
 
     FD_ZERO (&rd);
     FD_SET (self->priv->fd, &rd);
-    aux = select (self->priv->fd + 1, &rd, NULL, NULL, &tv);
+    aux = select_with_cancellable (self->priv->fd, &rd, NULL, &tv, cancellable);
 
     if (g_cancellable_set_error_if_cancelled (cancellable, error))
         return -1;
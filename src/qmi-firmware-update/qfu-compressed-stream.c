@@ -0,0 +1,506 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * qmi-firmware-update -- Command line tool to update firmware in QMI devices
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright (C) 2016-2017 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+#include <string.h>
+
+#include "qfu-compressed-stream.h"
+
+static void seekable_iface_init (GSeekableIface *iface);
+
+G_DEFINE_TYPE_EXTENDED (QfuCompressedStream, qfu_compressed_stream, G_TYPE_INPUT_STREAM, 0,
+                        G_IMPLEMENT_INTERFACE (G_TYPE_SEEKABLE, seekable_iface_init))
+
+/* Compressed data read from the base stream at once */
+#define INPUT_BUFFER_SIZE (64 * 1024)
+
+/* Data decompressed at once, and how much of the previously decompressed
+ * data is kept around for backward seeks (e.g. while parsing headers) */
+#define DECODE_SIZE   (256 * 1024)
+#define LOOKBACK_SIZE (64 * 1024)
+
+/* Decompression may only restart at the beginning of a gzip member, as
+ * the decompressor state can't be saved in between */
+typedef struct {
+    goffset compressed_offset;
+    goffset offset;
+} RestartPoint;
+
+struct _QfuCompressedStreamPrivate {
+    GInputStream *base_stream;
+    GConverter   *converter;
+    GArray       *restart_points;
+    goffset       size;
+    goffset       position;
+    gboolean      finished;
+
+    /* Compressed data not yet given to the converter; input_offset is the
+     * offset of the start of the buffer in the base stream */
+    guint8       *input;
+    gsize         input_start;
+    gsize         input_end;
+    goffset       input_offset;
+    gboolean      input_eof;
+
+    /* Decompressed data: the look-back window followed by the last chunk */
+    guint8       *window;
+    gsize         window_len;
+    goffset       window_offset;
+};
+
+/******************************************************************************/
+
+gboolean
+qfu_compressed_stream_is_gzip (const guint8 *data,
+                               gsize         data_size)
+{
+    return (data_size >= 2 && data[0] == 0x1f && data[1] == 0x8b);
+}
+
+/******************************************************************************/
+
+static gboolean
+fill_input (QfuCompressedStream  *self,
+            GCancellable         *cancellable,
+            GError              **error)
+{
+    QfuCompressedStreamPrivate *priv = self->priv;
+    gssize                      n_read;
+
+    if (priv->input_start > 0) {
+        memmove (priv->input, priv->input + priv->input_start, priv->input_end - priv->input_start);
+        priv->input_offset += priv->input_start;
+        priv->input_end -= priv->input_start;
+        priv->input_start = 0;
+    }
+
+    n_read = g_input_stream_read (priv->base_stream,
+                                  priv->input + priv->input_end,
+                                  INPUT_BUFFER_SIZE - priv->input_end,
+                                  cancellable,
+                                  error);
+    if (n_read < 0) {
+        g_prefix_error (error, "couldn't read compressed data: ");
+        return FALSE;
+    }
+
+    if (n_read == 0)
+        priv->input_eof = TRUE;
+    priv->input_end += n_read;
+    return TRUE;
+}
+
+/* Called when the converter reports the end of a gzip member */
+static gboolean
+next_member (QfuCompressedStream  *self,
+             gboolean              indexing,
+             GCancellable         *cancellable,
+             GError              **error)
+{
+    QfuCompressedStreamPrivate *priv = self->priv;
+
+    g_converter_reset (priv->converter);
+
+    while (priv->input_end - priv->input_start < 2 && !priv->input_eof) {
+        if (!fill_input (self, cancellable, error))
+            return FALSE;
+    }
+
+    /* Concatenated members are decompressed as a single stream, as
+     * gzip(1) does; anything else after the last member is ignored */
+    if (qfu_compressed_stream_is_gzip (priv->input + priv->input_start, priv->input_end - priv->input_start)) {
+        if (indexing) {
+            RestartPoint point;
+
+            point.compressed_offset = priv->input_offset + priv->input_start;
+            point.offset            = priv->window_offset + priv->window_len;
+            g_array_append_val (priv->restart_points, point);
+        }
+        return TRUE;
+    }
+
+    if (priv->input_end > priv->input_start)
+        g_debug ("[qfu-compressed-stream] ignoring trailing data after compressed data");
+    priv->finished = TRUE;
+    return TRUE;
+}
+
+/* Decompresses the next chunk of data after the window, returns the
+ * amount of data decompressed or 0 at the end of the compressed data */
+static gssize
+decode_chunk (QfuCompressedStream  *self,
+              gboolean              indexing,
+              GCancellable         *cancellable,
+              GError              **error)
+{
+    QfuCompressedStreamPrivate *priv = self->priv;
+
+    if (priv->finished)
+        return 0;
+
+    /* Make room for a new chunk, keeping only the look-back window */
+    if (priv->window_len > LOOKBACK_SIZE) {
+        memmove (priv->window, priv->window + priv->window_len - LOOKBACK_SIZE, LOOKBACK_SIZE);
+        priv->window_offset += priv->window_len - LOOKBACK_SIZE;
+        priv->window_len = LOOKBACK_SIZE;
+    }
+
+    while (TRUE) {
+        GConverterResult  res;
+        gsize             bytes_read = 0;
+        gsize             bytes_written = 0;
+        GError           *inner_error = NULL;
+
+        if (priv->input_start == priv->input_end && !priv->input_eof) {
+            if (!fill_input (self, cancellable, error))
+                return -1;
+        }
+
+        res = g_converter_convert (priv->converter,
+                                   priv->input + priv->input_start,
+                                   priv->input_end - priv->input_start,
+                                   priv->window + priv->window_len,
+                                   DECODE_SIZE,
+                                   priv->input_eof ? G_CONVERTER_INPUT_AT_END : G_CONVERTER_NO_FLAGS,
+                                   &bytes_read,
+                                   &bytes_written,
+                                   &inner_error);
+        if (res == G_CONVERTER_ERROR) {
+            if (g_error_matches (inner_error, G_IO_ERROR, G_IO_ERROR_PARTIAL_INPUT) && !priv->input_eof) {
+                g_clear_error (&inner_error);
+                if (!fill_input (self, cancellable, error))
+                    return -1;
+                continue;
+            }
+            g_propagate_prefixed_error (error, inner_error, "couldn't decompress data: ");
+            return -1;
+        }
+
+        priv->input_start += bytes_read;
+        priv->window_len += bytes_written;
+
+        if (res == G_CONVERTER_FINISHED && !next_member (self, indexing, cancellable, error))
+            return -1;
+
+        if (bytes_written > 0 || priv->finished)
+            return (gssize) bytes_written;
+    }
+}
+
+static gboolean
+restart (QfuCompressedStream  *self,
+         const RestartPoint   *point,
+         GCancellable         *cancellable,
+         GError              **error)
+{
+    QfuCompressedStreamPrivate *priv = self->priv;
+
+    g_debug ("[qfu-compressed-stream] restarting decompression at offset %" G_GOFFSET_FORMAT, point->offset);
+
+    if (!g_seekable_seek (G_SEEKABLE (priv->base_stream), point->compressed_offset, G_SEEK_SET, cancellable, error)) {
+        g_prefix_error (error, "couldn't seek compressed data: ");
+        return FALSE;
+    }
+
+    g_converter_reset (priv->converter);
+    priv->finished      = FALSE;
+    priv->input_start   = 0;
+    priv->input_end     = 0;
+    priv->input_offset  = point->compressed_offset;
+    priv->input_eof     = FALSE;
+    priv->window_len    = 0;
+    priv->window_offset = point->offset;
+    return TRUE;
+}
+
+/* Makes sure the window contains the data at the current position */
+static gboolean
+load_position (QfuCompressedStream  *self,
+               GCancellable         *cancellable,
+               GError              **error)
+{
+    QfuCompressedStreamPrivate *priv = self->priv;
+    const RestartPoint         *point = NULL;
+    guint                       i;
+
+    if (priv->position >= priv->window_offset && priv->position < priv->window_offset + (goffset) priv->window_len)
+        return TRUE;
+
+    /* Restart from the closest point before the position when seeking
+     * backwards beyond the window, or forward beyond a member boundary */
+    for (i = priv->restart_points->len; i > 0; i--) {
+        point = &g_array_index (priv->restart_points, RestartPoint, i - 1);
+        if (point->offset <= priv->position)
+            break;
+    }
+    g_assert (point);
+    if ((priv->position < priv->window_offset || point->offset > priv->window_offset + (goffset) priv->window_len) &&
+        !restart (self, point, cancellable, error))
+        return FALSE;
+
+    while (priv->position >= priv->window_offset + (goffset) priv->window_len) {
+        gssize n_decoded;
+
+        n_decoded = decode_chunk (self, FALSE, cancellable, error);
+        if (n_decoded < 0)
+            return FALSE;
+        if (n_decoded == 0) {
+            g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                         "compressed data ended before offset %" G_GOFFSET_FORMAT, priv->position);
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+/* Decompresses everything once, to know the uncompressed size, to find
+ * where decompression can be restarted and to validate the checksums
+ * before any data is used */
+static gboolean
+build_index (QfuCompressedStream  *self,
+             GCancellable         *cancellable,
+             GError              **error)
+{
+    QfuCompressedStreamPrivate *priv = self->priv;
+    RestartPoint                start = { 0, 0 };
+    gssize                      n_decoded;
+
+    g_array_append_val (priv->restart_points, start);
+    if (!restart (self, &start, cancellable, error))
+        return FALSE;
+
+    do {
+        n_decoded = decode_chunk (self, TRUE, cancellable, error);
+        if (n_decoded < 0)
+            return FALSE;
+    } while (n_decoded > 0);
+
+    priv->size = priv->window_offset + priv->window_len;
+    g_debug ("[qfu-compressed-stream] %" G_GOFFSET_FORMAT " bytes of uncompressed data, %u restart points",
+             priv->size, priv->restart_points->len);
+    return TRUE;
+}
+
+/******************************************************************************/
+
+static gssize
+read_fn (GInputStream  *stream,
+         void          *buffer,
+         gsize          count,
+         GCancellable  *cancellable,
+         GError       **error)
+{
+    QfuCompressedStream        *self = QFU_COMPRESSED_STREAM (stream);
+    QfuCompressedStreamPrivate *priv = self->priv;
+    gsize                       n_copied = 0;
+
+    while (n_copied < count && priv->position < priv->size) {
+        gsize available;
+
+        if (!load_position (self, cancellable, error))
+            return -1;
+
+        available = (gsize) (priv->window_offset + priv->window_len - priv->position);
+        available = MIN (available, count - n_copied);
+        memcpy ((guint8 *) buffer + n_copied, priv->window + (priv->position - priv->window_offset), available);
+        n_copied += available;
+        priv->position += available;
+    }
+
+    return (gssize) n_copied;
+}
+
+static gboolean
+close_fn (GInputStream  *stream,
+          GCancellable  *cancellable,
+          GError       **error)
+{
+    QfuCompressedStream *self = QFU_COMPRESSED_STREAM (stream);
+
+    return g_input_stream_close (self->priv->base_stream, cancellable, error);
+}
+
+/******************************************************************************/
+
+static goffset
+tell (GSeekable *seekable)
+{
+    return QFU_COMPRESSED_STREAM (seekable)->priv->position;
+}
+
+static gboolean
+can_seek (GSeekable *seekable)
+{
+    return TRUE;
+}
+
+static gboolean
+seek (GSeekable     *seekable,
+      goffset        offset,
+      GSeekType      type,
+      GCancellable  *cancellable,
+      GError       **error)
+{
+    QfuCompressedStream *self = QFU_COMPRESSED_STREAM (seekable);
+    goffset              position;
+
+    switch (type) {
+    case G_SEEK_CUR:
+        position = self->priv->position + offset;
+        break;
+    case G_SEEK_SET:
+        position = offset;
+        break;
+    case G_SEEK_END:
+        position = self->priv->size + offset;
+        break;
+    default:
+        g_assert_not_reached ();
+    }
+
+    if (position < 0) {
+        g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                     "invalid seek offset: %" G_GOFFSET_FORMAT, position);
+        return FALSE;
+    }
+
+    /* Data is only decompressed when read */
+    self->priv->position = position;
+    return TRUE;
+}
+
+static gboolean
+can_truncate (GSeekable *seekable)
+{
+    return FALSE;
+}
+
+static gboolean
+truncate_fn (GSeekable     *seekable,
+             goffset        offset,
+             GCancellable  *cancellable,
+             GError       **error)
+{
+    g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                 "cannot truncate input stream");
+    return FALSE;
+}
+
+/******************************************************************************/
+
+goffset
+qfu_compressed_stream_get_size (QfuCompressedStream *self)
+{
+    g_return_val_if_fail (QFU_IS_COMPRESSED_STREAM (self), 0);
+
+    return self->priv->size;
+}
+
+guint
+qfu_compressed_stream_get_n_restart_points (QfuCompressedStream *self)
+{
+    g_return_val_if_fail (QFU_IS_COMPRESSED_STREAM (self), 0);
+
+    return self->priv->restart_points->len;
+}
+
+GInputStream *
+qfu_compressed_stream_new (GInputStream  *base_stream,
+                           GCancellable  *cancellable,
+                           GError       **error)
+{
+    QfuCompressedStream *self;
+
+    g_return_val_if_fail (G_IS_INPUT_STREAM (base_stream), NULL);
+
+    if (!G_IS_SEEKABLE (base_stream) || !g_seekable_can_seek (G_SEEKABLE (base_stream))) {
+        g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                     "compressed data is not seekable");
+        return NULL;
+    }
+
+    self = g_object_new (QFU_TYPE_COMPRESSED_STREAM, NULL);
+    self->priv->base_stream = g_object_ref (base_stream);
+
+    if (!build_index (self, cancellable, error)) {
+        g_object_unref (self);
+        return NULL;
+    }
+
+    return G_INPUT_STREAM (self);
+}
+
+static void
+qfu_compressed_stream_init (QfuCompressedStream *self)
+{
+    self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, QFU_TYPE_COMPRESSED_STREAM, QfuCompressedStreamPrivate);
+    self->priv->converter      = G_CONVERTER (g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_GZIP));
+    self->priv->restart_points = g_array_new (FALSE, FALSE, sizeof (RestartPoint));
+    self->priv->input          = g_malloc (INPUT_BUFFER_SIZE);
+    self->priv->window         = g_malloc (LOOKBACK_SIZE + DECODE_SIZE);
+}
+
+static void
+dispose (GObject *object)
+{
+    QfuCompressedStream *self = QFU_COMPRESSED_STREAM (object);
+
+    g_clear_object (&self->priv->base_stream);
+    g_clear_object (&self->priv->converter);
+
+    G_OBJECT_CLASS (qfu_compressed_stream_parent_class)->dispose (object);
+}
+
+static void
+finalize (GObject *object)
+{
+    QfuCompressedStream *self = QFU_COMPRESSED_STREAM (object);
+
+    g_array_unref (self->priv->restart_points);
+    g_free (self->priv->input);
+    g_free (self->priv->window);
+
+    G_OBJECT_CLASS (qfu_compressed_stream_parent_class)->finalize (object);
+}
+
+static void
+seekable_iface_init (GSeekableIface *iface)
+{
+    iface->tell         = tell;
+    iface->can_seek     = can_seek;
+    iface->seek         = seek;
+    iface->can_truncate = can_truncate;
+    iface->truncate_fn  = truncate_fn;
+}
+
+static void
+qfu_compressed_stream_class_init (QfuCompressedStreamClass *klass)
+{
+    GObjectClass      *object_class = G_OBJECT_CLASS (klass);
+    GInputStreamClass *stream_class = G_INPUT_STREAM_CLASS (klass);
+
+    g_type_class_add_private (object_class, sizeof (QfuCompressedStreamPrivate));
+
+    object_class->dispose  = dispose;
+    object_class->finalize = finalize;
+
+    stream_class->read_fn  = read_fn;
+    stream_class->close_fn = close_fn;
+}
@@ -0,0 +1,66 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * qmi-firmware-update -- Command line tool to update firmware in QMI devices
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright (C) 2016-2017 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+#ifndef QFU_COMPRESSED_STREAM_H
+#define QFU_COMPRESSED_STREAM_H
+
+#include <glib-object.h>
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define QFU_TYPE_COMPRESSED_STREAM            (qfu_compressed_stream_get_type ())
+#define QFU_COMPRESSED_STREAM(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), QFU_TYPE_COMPRESSED_STREAM, QfuCompressedStream))
+#define QFU_COMPRESSED_STREAM_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass),  QFU_TYPE_COMPRESSED_STREAM, QfuCompressedStreamClass))
+#define QFU_IS_COMPRESSED_STREAM(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), QFU_TYPE_COMPRESSED_STREAM))
+#define QFU_IS_COMPRESSED_STREAM_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass),  QFU_TYPE_COMPRESSED_STREAM))
+#define QFU_COMPRESSED_STREAM_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj),  QFU_TYPE_COMPRESSED_STREAM, QfuCompressedStreamClass))
+
+typedef struct _QfuCompressedStream        QfuCompressedStream;
+typedef struct _QfuCompressedStreamClass   QfuCompressedStreamClass;
+typedef struct _QfuCompressedStreamPrivate QfuCompressedStreamPrivate;
+
+/* Seekable view of the uncompressed contents of a gzip file. Data is
+ * decompressed on the fly as it's read; a small window of already
+ * decompressed data serves short backward seeks, and longer ones restart
+ * decompression from the closest gzip member boundary. */
+struct _QfuCompressedStream {
+    GInputStream                parent;
+    QfuCompressedStreamPrivate *priv;
+};
+
+struct _QfuCompressedStreamClass {
+    GInputStreamClass parent;
+};
+
+GType qfu_compressed_stream_get_type (void);
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (QfuCompressedStream, g_object_unref);
+
+gboolean      qfu_compressed_stream_is_gzip  (const guint8  *data,
+                                              gsize          data_size);
+GInputStream *qfu_compressed_stream_new      (GInputStream  *base_stream,
+                                              GCancellable  *cancellable,
+                                              GError       **error);
+goffset       qfu_compressed_stream_get_size (QfuCompressedStream *self);
+guint         qfu_compressed_stream_get_n_restart_points (QfuCompressedStream *self);
+
+G_END_DECLS
+
+#endif /* QFU_COMPRESSED_STREAM_H */
@@ -192,7 +192,8 @@ out:
 
 gboolean
 qfu_firehose_message_parse_response_configure (const gchar  *rsp,
-                                               guint32      *max_payload_size_to_target_in_bytes)
+                                               guint32      *max_payload_size_to_target_in_bytes,
+                                               guint32      *max_payload_size_to_target_in_bytes_supported)
 {
     GRegex     *r;
     GMatchInfo *match_info = NULL;
@@ -223,6 +224,30 @@ qfu_firehose_message_parse_response_configure (const gchar  *rsp,
         g_free (aux);
     }
 
+    /* The supported max payload size is optional, and reported as 0 if the
+     * target doesn't give it */
+    if (max_payload_size_to_target_in_bytes_supported) {
+        GRegex     *r_supported;
+        GMatchInfo *match_info_supported = NULL;
+
+        *max_payload_size_to_target_in_bytes_supported = 0;
+
+        r_supported = g_regex_new ("MaxPayloadSizeToTargetInBytesSupported=\"([^\"]*)\"", G_REGEX_RAW, 0, NULL);
+        g_assert (r_supported);
+
+        if (g_regex_match (r_supported, rsp, 0, &match_info_supported) && g_match_info_matches (match_info_supported)) {
+            gchar *aux;
+
+            aux = g_match_info_fetch (match_info_supported, 1);
+            *max_payload_size_to_target_in_bytes_supported = atoi (aux);
+            g_free (aux);
+        }
+
+        if (match_info_supported)
+            g_match_info_unref (match_info_supported);
+        g_regex_unref (r_supported);
+    }
+
     success = TRUE;
 
 out:
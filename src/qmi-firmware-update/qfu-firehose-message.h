@@ -46,7 +46,8 @@ gboolean qfu_firehose_message_parse_response_ack       (const gchar  *rsp,
                                                         gchar       **value,
                                                         gchar       **rawmode);
 gboolean qfu_firehose_message_parse_response_configure (const gchar  *rsp,
-                                                        guint32      *max_payload_size_to_target_in_bytes);
+                                                        guint32      *max_payload_size_to_target_in_bytes,
+                                                        guint32      *max_payload_size_to_target_in_bytes_supported);
 gboolean qfu_firehose_message_parse_log                (const gchar  *rsp,
                                                         gchar       **value);
 
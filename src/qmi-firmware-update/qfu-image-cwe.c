@@ -315,6 +315,78 @@ qfu_image_cwe_get_parsed_carrier (QfuImageCwe *self)
     return self->priv->carrier;
 }
 
+/******************************************************************************/
+/* Embedded header table cache
+ *
+ * Parsing the whole tree of embedded headers requires lots of small reads
+ * and seeks through big files; when the same image file is loaded several
+ * times (e.g. by each updater in fleet mode, or in verify and then update
+ * operations) the table is reused if the file identity (device, inode,
+ * modification time and size) didn't change. The parsed
+ * firmware/config/carrier info isn't cached because it also depends on
+ * the file name, and it's cheap to build from the header table anyway. */
+
+static GMutex      header_cache_mutex;
+static GHashTable *header_cache;
+
+static GArray *
+header_cache_lookup (const gchar *identity)
+{
+    GArray *headers = NULL;
+
+    g_mutex_lock (&header_cache_mutex);
+    if (header_cache) {
+        headers = g_hash_table_lookup (header_cache, identity);
+        if (headers)
+            g_array_ref (headers);
+    }
+    g_mutex_unlock (&header_cache_mutex);
+
+    return headers;
+}
+
+static void
+header_cache_add (const gchar *identity,
+                  GArray      *images)
+{
+    GArray *headers;
+    guint   i;
+
+    /* Only the raw headers and parent indices are stored, the duplicated
+     * strings are rebuilt when loaded */
+    headers = g_array_sized_new (FALSE, FALSE, sizeof (ImageInfo), images->len);
+    for (i = 0; i < images->len; i++) {
+        ImageInfo info;
+
+        info = g_array_index (images, ImageInfo, i);
+        info.type = NULL;
+        info.product = NULL;
+        g_array_append_val (headers, info);
+    }
+
+    g_mutex_lock (&header_cache_mutex);
+    if (!header_cache)
+        header_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_array_unref);
+    g_hash_table_replace (header_cache, g_strdup (identity), headers);
+    g_mutex_unlock (&header_cache_mutex);
+}
+
+static void
+load_image_info_from_cache (QfuImageCwe *self,
+                            GArray      *headers)
+{
+    guint i;
+
+    for (i = 0; i < headers->len; i++) {
+        ImageInfo info;
+
+        info = g_array_index (headers, ImageInfo, i);
+        info.type    = g_strndup (info.hdr.type,    sizeof (info.hdr.type));
+        info.product = g_strndup (info.hdr.product, sizeof (info.hdr.product));
+        g_array_append_val (self->priv->images, info);
+    }
+}
+
 /******************************************************************************/
 
 static goffset
@@ -484,6 +556,9 @@ initable_init (GInitable     *initable,
 {
     QfuImageCwe  *self;
     GInputStream *input_stream = NULL;
+    gchar        *identity = NULL;
+    GArray       *cached_headers = NULL;
+    gboolean      cached = FALSE;
     gboolean      result = FALSE;
 
     self = QFU_IMAGE_CWE (initable);
@@ -493,16 +568,27 @@ initable_init (GInitable     *initable,
         return FALSE;
 
     g_object_get (self, "input-stream", &input_stream, NULL);
-    g_assert (G_IS_FILE_INPUT_STREAM (input_stream));
-
-    g_debug ("[qfu-image-cwe] reading image headers...");
-    if (!g_seekable_seek (G_SEEKABLE (input_stream), 0, G_SEEK_SET, cancellable, error)) {
-        g_prefix_error (error, "couldn't seek input stream: ");
-        goto out;
-    }
-    if (!load_image_info (self, input_stream, "", -1, (goffset) -1, cancellable, error)) {
-        g_prefix_error (error, "couldn't read file header: ");
-        goto out;
+    g_assert (G_IS_SEEKABLE (input_stream));
+
+    identity = qfu_image_build_file_identity (QFU_IMAGE (self));
+    if (identity)
+        cached_headers = header_cache_lookup (identity);
+
+    if (cached_headers) {
+        g_debug ("[qfu-image-cwe] reusing cached image headers...");
+        load_image_info_from_cache (self, cached_headers);
+        g_array_unref (cached_headers);
+        cached = TRUE;
+    } else {
+        g_debug ("[qfu-image-cwe] reading image headers...");
+        if (!g_seekable_seek (G_SEEKABLE (input_stream), 0, G_SEEK_SET, cancellable, error)) {
+            g_prefix_error (error, "couldn't seek input stream: ");
+            goto out;
+        }
+        if (!load_image_info (self, input_stream, "", -1, (goffset) -1, cancellable, error)) {
+            g_prefix_error (error, "couldn't read file header: ");
+            goto out;
+        }
     }
 
     g_debug ("[qfu-image-cwe] validating data size...");
@@ -513,6 +599,10 @@ initable_init (GInitable     *initable,
         goto out;
     }
 
+    /* Only validated header tables are cached */
+    if (identity && !cached)
+        header_cache_add (identity, self->priv->images);
+
     g_debug ("[qfu-image-cwe] preloading firmware/config/carrier...");
     parse_firmware_config_carrier (self);
 
@@ -520,6 +610,7 @@ initable_init (GInitable     *initable,
     result = TRUE;
 
 out:
+    g_free (identity);
     g_object_unref (input_stream);
     return result;
 }
@@ -20,6 +20,8 @@
  * Copyright (C) 2016-2017 Aleksander Morgado <aleksander@aleksander.es>
  */
 
+#include <string.h>
+
 #include "qfu-image-factory.h"
 #include "qfu-image.h"
 #include "qfu-image-cwe.h"
@@ -36,6 +38,11 @@ qfu_image_factory_build (GFile        *file,
     g_assert (G_IS_FILE (file));
     basename = g_file_get_basename (file);
 
+    /* gzip compressed images are decompressed on the fly when read, so
+     * guess the type from the name of the file they contain */
+    if (g_str_has_suffix (basename, ".gz"))
+        basename[strlen (basename) - 3] = '\0';
+
     /* guessing image type based on the well known Gobi 1k and 2k
      * filenames, and assumes anything else could be a CWE image
      *
@@ -67,3 +74,86 @@ qfu_image_factory_build (GFile        *file,
     g_free (basename);
     return image;
 }
+
+/******************************************************************************/
+/* Shared images
+ *
+ * Images mapped in memory can be used by several updaters at the same time,
+ * so they're built once per process and kept here, indexed by path. The file
+ * identity is checked on every lookup, so that a file modified in between is
+ * loaded again.
+ */
+
+static GMutex      shared_images_mutex;
+static GHashTable *shared_images;
+
+QfuImage *
+qfu_image_factory_build_shared (GFile         *file,
+                                GCancellable  *cancellable,
+                                GError       **error)
+{
+    gchar    *path;
+    gchar    *identity;
+    gchar    *cached_identity;
+    QfuImage *image = NULL;
+
+    g_assert (G_IS_FILE (file));
+
+    /* Only local files may be mapped */
+    path = g_file_get_path (file);
+    if (!path)
+        return qfu_image_factory_build (file, cancellable, error);
+
+    /* Without identity the image can't be shared; any error is reported
+     * when building it */
+    identity = qfu_image_build_file_identity_for_file (file, cancellable, NULL);
+    if (!identity) {
+        g_free (path);
+        return qfu_image_factory_build (file, cancellable, error);
+    }
+
+    g_mutex_lock (&shared_images_mutex);
+    if (shared_images) {
+        image = g_hash_table_lookup (shared_images, path);
+        if (image) {
+            cached_identity = qfu_image_build_file_identity (image);
+            if (!g_strcmp0 (cached_identity, identity))
+                g_object_ref (image);
+            else {
+                g_debug ("[qfu-image-factory] shared image modified, reloading: %s", path);
+                g_hash_table_remove (shared_images, path);
+                image = NULL;
+            }
+            g_free (cached_identity);
+        }
+    }
+    g_mutex_unlock (&shared_images_mutex);
+
+    if (image) {
+        g_debug ("[qfu-image-factory] reusing shared image: %s", path);
+        goto out;
+    }
+
+    image = qfu_image_factory_build (file, cancellable, error);
+    if (!image || !qfu_image_peek (image, 0, 0))
+        goto out;
+
+    g_mutex_lock (&shared_images_mutex);
+    if (!shared_images)
+        shared_images = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
+    g_hash_table_replace (shared_images, g_strdup (path), g_object_ref (image));
+    g_mutex_unlock (&shared_images_mutex);
+
+out:
+    g_free (identity);
+    g_free (path);
+    return image;
+}
+
+void
+qfu_image_factory_clear_shared (void)
+{
+    g_mutex_lock (&shared_images_mutex);
+    g_clear_pointer (&shared_images, g_hash_table_unref);
+    g_mutex_unlock (&shared_images_mutex);
+}
@@ -35,6 +35,13 @@ QfuImage *qfu_image_factory_build (GFile        *file,
                                    GCancellable *cancellable,
                                    GError       **error);
 
+/* Like qfu_image_factory_build(), but images mapped in memory are kept and
+ * returned again for the same unmodified file until cleared */
+QfuImage *qfu_image_factory_build_shared (GFile         *file,
+                                          GCancellable  *cancellable,
+                                          GError       **error);
+void      qfu_image_factory_clear_shared (void);
+
 G_END_DECLS
 
 #endif /* QFU_IMAGE_H */
@@ -20,7 +20,12 @@
  * Copyright (C) 2016-2017 Aleksander Morgado <aleksander@aleksander.es>
  */
 
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+
 #include "qfu-image.h"
+#include "qfu-compressed-stream.h"
 #include "qfu-enum-types.h"
 
 static void initable_iface_init (GInitableIface *iface);
@@ -42,7 +47,10 @@ struct _QfuImagePrivate {
     QfuImageType  image_type;
     GFile        *file;
     GFileInfo    *info;
+    goffset       size;
     GInputStream *input_stream;
+    GMappedFile  *mapped_file;
+    gboolean      pages_locked;
 };
 
 /******************************************************************************/
@@ -66,6 +74,44 @@ qfu_image_get_data_chunk_size (QfuImage *self,
     return chunk_size;
 }
 
+const guint8 *
+qfu_image_peek (QfuImage *self,
+                goffset   offset,
+                gsize     size)
+{
+    g_return_val_if_fail (QFU_IS_IMAGE (self), NULL);
+
+    if (!self->priv->mapped_file)
+        return NULL;
+
+    if (offset < 0 ||
+        (gsize)offset > g_mapped_file_get_length (self->priv->mapped_file) ||
+        size > g_mapped_file_get_length (self->priv->mapped_file) - (gsize)offset)
+        return NULL;
+
+    return (const guint8 *)g_mapped_file_get_contents (self->priv->mapped_file) + offset;
+}
+
+const guint8 *
+qfu_image_peek_data_chunk (QfuImage *self,
+                           guint16   chunk_i,
+                           gsize    *chunk_size)
+{
+    gsize size;
+
+    g_return_val_if_fail (QFU_IS_IMAGE (self), NULL);
+
+    if (!self->priv->mapped_file || chunk_i >= qfu_image_get_n_data_chunks (self))
+        return NULL;
+
+    size = qfu_image_get_data_chunk_size (self, chunk_i);
+    if (chunk_size)
+        *chunk_size = size;
+    return qfu_image_peek (self,
+                           qfu_image_get_header_size (self) + ((goffset)chunk_i * QFU_IMAGE_CHUNK_SIZE),
+                           size);
+}
+
 gssize
 qfu_image_read_data_chunk (QfuImage      *self,
                            guint16        chunk_i,
@@ -105,6 +151,21 @@ qfu_image_read_data_chunk (QfuImage      *self,
     chunk_offset = qfu_image_get_header_size (self) + ((goffset)chunk_i * QFU_IMAGE_CHUNK_SIZE);
     g_debug ("[qfu-image] chunk #%u offset: %" G_GOFFSET_FORMAT " bytes", chunk_i, chunk_offset);
 
+    /* If the file is mapped, just copy from there */
+    if (self->priv->mapped_file) {
+        const guint8 *view;
+
+        view = qfu_image_peek (self, chunk_offset, chunk_size);
+        if (!view) {
+            g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                         "chunk %u out of the mapped image", chunk_i);
+            return -1;
+        }
+        memcpy (out_buffer, view, chunk_size);
+        g_debug ("[qfu-image] chunk #%u successfully read", chunk_i);
+        return chunk_size;
+    }
+
     /* Seek to the correct place: note that this is likely a noop if already in that offset */
     if (!g_seekable_seek (G_SEEKABLE (self->priv->input_stream), chunk_offset, G_SEEK_SET, cancellable, error)) {
         g_prefix_error (error, "couldn't seek input stream: ");
@@ -165,6 +226,21 @@ qfu_image_read (QfuImage      *self,
         return -1;
     }
 
+    /* If the file is mapped, just copy from there */
+    if (self->priv->mapped_file) {
+        const guint8 *view;
+
+        view = qfu_image_peek (self, offset, read_size);
+        if (!view) {
+            g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                         "data at offset %" G_GOFFSET_FORMAT " out of the mapped image", offset);
+            return -1;
+        }
+        memcpy (out_buffer, view, read_size);
+        g_debug ("[qfu-image] data at offset %" G_GOFFSET_FORMAT " successfully read", offset);
+        return read_size;
+    }
+
     /* Seek to the correct place: note that this is likely a noop if already in that offset */
     if (!g_seekable_seek (G_SEEKABLE (self->priv->input_stream), offset, G_SEEK_SET, cancellable, error)) {
         g_prefix_error (error, "couldn't seek input stream: ");
@@ -212,12 +288,94 @@ qfu_image_get_display_name (QfuImage *self)
     return g_file_info_get_display_name (self->priv->info);
 }
 
+#define FILE_IDENTITY_ATTRIBUTES                \
+    G_FILE_ATTRIBUTE_UNIX_DEVICE ","            \
+    G_FILE_ATTRIBUTE_UNIX_INODE ","             \
+    G_FILE_ATTRIBUTE_TIME_MODIFIED ","          \
+    G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC ","     \
+    G_FILE_ATTRIBUTE_STANDARD_SIZE
+
+static gchar *
+build_file_identity (GFileInfo *info)
+{
+    /* The identity is only available for local files */
+    if (!g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_UNIX_DEVICE) ||
+        !g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_UNIX_INODE) ||
+        !g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_TIME_MODIFIED))
+        return NULL;
+
+    return g_strdup_printf ("%u:%" G_GUINT64_FORMAT ":%" G_GUINT64_FORMAT ".%u:%" G_GOFFSET_FORMAT,
+                            g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_UNIX_DEVICE),
+                            g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_UNIX_INODE),
+                            g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED),
+                            g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC),
+                            g_file_info_get_size (info));
+}
+
+gchar *
+qfu_image_build_file_identity (QfuImage *self)
+{
+    g_return_val_if_fail (QFU_IS_IMAGE (self), NULL);
+
+    return build_file_identity (self->priv->info);
+}
+
+gchar *
+qfu_image_build_file_identity_for_file (GFile         *file,
+                                        GCancellable  *cancellable,
+                                        GError       **error)
+{
+    GFileInfo *info;
+    gchar     *identity;
+
+    g_return_val_if_fail (G_IS_FILE (file), NULL);
+
+    info = g_file_query_info (file, FILE_IDENTITY_ATTRIBUTES, G_FILE_QUERY_INFO_NONE, cancellable, error);
+    if (!info)
+        return NULL;
+
+    identity = build_file_identity (info);
+    g_object_unref (info);
+    return identity;
+}
+
+gboolean
+qfu_image_lock_pages (QfuImage  *self,
+                      GError   **error)
+{
+    g_return_val_if_fail (QFU_IS_IMAGE (self), FALSE);
+
+    if (self->priv->pages_locked)
+        return TRUE;
+
+    if (!self->priv->mapped_file) {
+        g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                     "image is not mapped in memory");
+        return FALSE;
+    }
+
+    /* Nothing to lock in an empty mapping */
+    if (!g_mapped_file_get_length (self->priv->mapped_file))
+        return TRUE;
+
+    if (mlock (g_mapped_file_get_contents (self->priv->mapped_file),
+               g_mapped_file_get_length (self->priv->mapped_file)) < 0) {
+        g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errno),
+                     "couldn't lock image pages in memory: %s",
+                     g_strerror (errno));
+        return FALSE;
+    }
+
+    self->priv->pages_locked = TRUE;
+    return TRUE;
+}
+
 goffset
 qfu_image_get_size (QfuImage *self)
 {
     g_return_val_if_fail (QFU_IS_IMAGE (self), 0);
 
-    return g_file_info_get_size (self->priv->info);
+    return self->priv->size;
 }
 
 goffset
@@ -285,6 +443,89 @@ get_data_size (QfuImage *self)
 
 /******************************************************************************/
 
+static void
+load_mapped_file (QfuImage *self)
+{
+    gchar  *path;
+    GError *inner_error = NULL;
+
+    /* Only local files can be mapped; if mapping isn't possible, the image
+     * is read through the input stream instead */
+    path = g_file_get_path (self->priv->file);
+    if (!path)
+        return;
+
+    self->priv->mapped_file = g_mapped_file_new (path, FALSE, &inner_error);
+    if (!self->priv->mapped_file) {
+        g_debug ("[qfu-image] couldn't map file: %s", inner_error->message);
+        g_error_free (inner_error);
+        g_free (path);
+        return;
+    }
+    g_free (path);
+
+    /* The file info and the mapping must agree on the size, or otherwise
+     * the file was modified in between */
+    if ((goffset)g_mapped_file_get_length (self->priv->mapped_file) != qfu_image_get_size (self)) {
+        g_debug ("[qfu-image] mapped file size mismatch");
+        g_clear_pointer (&self->priv->mapped_file, g_mapped_file_unref);
+        return;
+    }
+
+#if defined MADV_SEQUENTIAL
+    /* Images are read sequentially, so ask for aggressive readahead */
+    if (g_mapped_file_get_length (self->priv->mapped_file) > 0 &&
+        madvise (g_mapped_file_get_contents (self->priv->mapped_file),
+                 g_mapped_file_get_length (self->priv->mapped_file),
+                 MADV_SEQUENTIAL) < 0)
+        g_debug ("[qfu-image] couldn't advise sequential access to mapped file");
+#endif
+
+    g_debug ("[qfu-image] file mapped in memory");
+}
+
+/* xz compressed images would need liblzma, which GIO doesn't wrap */
+static const guint8 xz_magic[] = { 0xfd, '7', 'z', 'X', 'Z', 0x00 };
+
+/* Compressed images are read through a decompressing stream instead of
+ * being mapped; the image size is then the uncompressed one */
+static gboolean
+load_compressed_stream (QfuImage      *self,
+                        GCancellable  *cancellable,
+                        GError       **error)
+{
+    guint8        magic[sizeof (xz_magic)];
+    gsize         n_read = 0;
+    GInputStream *stream;
+
+    if (!g_input_stream_read_all (self->priv->input_stream, magic, sizeof (magic), &n_read, cancellable, error) ||
+        !g_seekable_seek (G_SEEKABLE (self->priv->input_stream), 0, G_SEEK_SET, cancellable, error)) {
+        g_prefix_error (error, "couldn't read file magic: ");
+        return FALSE;
+    }
+
+    if (n_read == sizeof (xz_magic) && !memcmp (magic, xz_magic, sizeof (xz_magic))) {
+        g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                     "xz compressed images are not supported, decompress it first");
+        return FALSE;
+    }
+
+    if (!qfu_compressed_stream_is_gzip (magic, n_read))
+        return TRUE;
+
+    g_debug ("[qfu-image] decompressing gzip file on the fly...");
+    stream = qfu_compressed_stream_new (self->priv->input_stream, cancellable, error);
+    if (!stream) {
+        g_prefix_error (error, "invalid gzip file: ");
+        return FALSE;
+    }
+
+    g_object_unref (self->priv->input_stream);
+    self->priv->input_stream = stream;
+    self->priv->size = qfu_compressed_stream_get_size (QFU_COMPRESSED_STREAM (stream));
+    return TRUE;
+}
+
 static gboolean
 initable_init (GInitable     *initable,
                GCancellable  *cancellable,
@@ -298,12 +539,27 @@ initable_init (GInitable     *initable,
     /* Load file info */
     g_debug ("[qfu-image] loading file info...");
     self->priv->info = g_file_query_info (self->priv->file,
-                                          G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME "," G_FILE_ATTRIBUTE_STANDARD_SIZE,
+                                          G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME ","
+                                          G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+                                          G_FILE_ATTRIBUTE_UNIX_DEVICE ","
+                                          G_FILE_ATTRIBUTE_UNIX_INODE ","
+                                          G_FILE_ATTRIBUTE_TIME_MODIFIED ","
+                                          G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC,
                                           G_FILE_QUERY_INFO_NONE,
                                           cancellable,
                                           error);
     if (!self->priv->info)
         return FALSE;
+    self->priv->size = g_file_info_get_size (self->priv->info);
+
+    /* Open file for reading. Kept open while the input stream reference is valid. */
+    g_debug ("[qfu-image] opening file for reading...");
+    self->priv->input_stream = G_INPUT_STREAM (g_file_read (self->priv->file, cancellable, error));
+    if (!self->priv->input_stream)
+        return FALSE;
+
+    if (!load_compressed_stream (self, cancellable, error))
+        return FALSE;
 
     /* Check minimum file size */
     if (qfu_image_get_size (self) < qfu_image_get_header_size (self)) {
@@ -311,11 +567,8 @@ initable_init (GInitable     *initable,
         return FALSE;
     }
 
-    /* Open file for reading. Kept open while the input stream reference is valid. */
-    g_debug ("[qfu-image] opening file for reading...");
-    self->priv->input_stream = G_INPUT_STREAM (g_file_read (self->priv->file, cancellable, error));
-    if (!self->priv->input_stream)
-        return FALSE;
+    if (G_IS_FILE_INPUT_STREAM (self->priv->input_stream))
+        load_mapped_file (self);
 
     return TRUE;
 }
@@ -395,6 +648,13 @@ dispose (GObject *object)
 {
     QfuImage *self = QFU_IMAGE (object);
 
+    if (self->priv->pages_locked) {
+        g_assert (self->priv->mapped_file);
+        munlock (g_mapped_file_get_contents (self->priv->mapped_file),
+                 g_mapped_file_get_length (self->priv->mapped_file));
+        self->priv->pages_locked = FALSE;
+    }
+    g_clear_pointer (&self->priv->mapped_file, g_mapped_file_unref);
     g_clear_object (&self->priv->input_stream);
     g_clear_object (&self->priv->info);
     g_clear_object (&self->priv->file);
@@ -442,8 +702,8 @@ qfu_image_class_init (QfuImageClass *klass)
     properties[PROP_INPUT_STREAM] =
         g_param_spec_object ("input-stream",
                              "Input stream",
-                             "Input stream object",
-                             G_TYPE_FILE_INPUT_STREAM,
+                             "Seekable input stream object",
+                             G_TYPE_INPUT_STREAM,
                              G_PARAM_READABLE);
     g_object_class_install_property (object_class, PROP_INPUT_STREAM, properties[PROP_INPUT_STREAM]);
 }
@@ -89,6 +89,12 @@ QfuImage     *qfu_image_new                 (GFile         *file,
                                              GError       **error);
 QfuImageType  qfu_image_get_image_type      (QfuImage      *self);
 const gchar  *qfu_image_get_display_name    (QfuImage      *self);
+gchar        *qfu_image_build_file_identity (QfuImage      *self);
+gchar        *qfu_image_build_file_identity_for_file (GFile         *file,
+                                                      GCancellable  *cancellable,
+                                                      GError       **error);
+gboolean      qfu_image_lock_pages          (QfuImage      *self,
+                                             GError       **error);
 goffset       qfu_image_get_size            (QfuImage      *self);
 goffset       qfu_image_get_header_size     (QfuImage      *self);
 gssize        qfu_image_read_header         (QfuImage      *self,
@@ -100,6 +106,12 @@ goffset       qfu_image_get_data_size       (QfuImage      *self);
 guint16       qfu_image_get_n_data_chunks   (QfuImage      *self);
 gsize         qfu_image_get_data_chunk_size (QfuImage      *self,
                                              guint16        chunk_i);
+const guint8 *qfu_image_peek                (QfuImage      *self,
+                                             goffset        offset,
+                                             gsize          size);
+const guint8 *qfu_image_peek_data_chunk     (QfuImage      *self,
+                                             guint16        chunk_i,
+                                             gsize         *chunk_size);
 gssize        qfu_image_read_data_chunk     (QfuImage      *self,
                                              guint16        chunk_i,
                                              guint8        *out_buffer,
@@ -31,6 +31,7 @@
 
 #include "qfu-log.h"
 #include "qfu-operation.h"
+#include "qfu-image-factory.h"
 #include "qfu-device-selection.h"
 #include "qfu-udev-helpers.h"
 #include "qfu-utils.h"
@@ -65,6 +66,9 @@ static gboolean   ignore_version_errors_flag;
 static gboolean   override_download_flag;
 static gint       modem_storage_index_int;
 static gboolean   skip_validation_flag;
+
+/* Service */
+static gchar     *service_socket_str;
 #endif
 
 /* Reset */
@@ -82,6 +86,10 @@ static gboolean   device_open_proxy_flag;
 static gboolean   device_open_qmi_flag;
 static gboolean   device_open_mbim_flag;
 static gboolean   device_open_auto_flag;
+static gint       qdl_window_size_int = 1;
+static gchar     *stats_json_str;
+static gchar    **fleet_strv;
+static gint       fleet_max_concurrent_int = 4;
 static gboolean   stdout_verbose_flag;
 static gboolean   stdout_silent_flag;
 static gchar     *verbose_log_str;
@@ -246,6 +254,14 @@ static GOptionEntry context_update_entries[] = {
     },
     { NULL }
 };
+
+static GOptionEntry context_service_entries[] = {
+    { "service", 0, 0, G_OPTION_ARG_FILENAME, &service_socket_str,
+      "Run as a service accepting update jobs through the given control socket, keeping the loaded firmware images across jobs.",
+      "[PATH]"
+    },
+    { NULL }
+};
 #endif /* WITH_UDEV */
 
 static GOptionEntry context_reset_entries[] = {
@@ -292,6 +308,22 @@ static GOptionEntry context_main_entries[] = {
       "Open a cdc-wdm device in either QMI or MBIM mode (default)",
       NULL
     },
+    { "qdl-window-size", 0, 0, G_OPTION_ARG_INT, &qdl_window_size_int,
+      "Number of QDL image chunks sent before waiting for their acks, if the device allows it (default 1).",
+      "[N]"
+    },
+    { "stats-json", 0, 0, G_OPTION_ARG_FILENAME, &stats_json_str,
+      "Append timing and throughput statistics of update operations to the given file in JSON format, one object per line ('-' for stdout).",
+      "[PATH]"
+    },
+    { "fleet", 0, 0, G_OPTION_ARG_FILENAME_ARRAY, &fleet_strv,
+      "Update several devices at the same time, selected by device path or glob pattern (e.g. /dev/ttyUSB*); may be given multiple times.",
+      "[PATH|PATTERN]"
+    },
+    { "fleet-max-concurrent", 0, 0, G_OPTION_ARG_INT, &fleet_max_concurrent_int,
+      "Maximum number of devices updated at the same time in fleet mode (default 4).",
+      "[N]"
+    },
 #if defined MM_RUNTIME_CHECK_ENABLED
     { "ignore-mm-runtime-check", 0, 0, G_OPTION_ARG_NONE, &ignore_mm_runtime_check_flag,
       "Ignore ModemManager runtime check",
@@ -542,6 +574,73 @@ print_help_examples (void)
 
 /*****************************************************************************/
 
+static gint
+compare_device_paths (const gchar **a,
+                      const gchar **b)
+{
+    return g_strcmp0 (*a, *b);
+}
+
+static gchar **
+expand_fleet_device_paths (gchar   **strv,
+                           GError  **error)
+{
+    GPtrArray *paths;
+    guint      i;
+
+    paths = g_ptr_array_new_with_free_func (g_free);
+    for (i = 0; strv[i]; i++) {
+        GPatternSpec *spec;
+        GDir         *dir;
+        gchar        *dirname;
+        const gchar  *name;
+        guint         n_matches = 0;
+
+        /* Plain paths are taken as they are */
+        if (!strpbrk (strv[i], "*?")) {
+            g_ptr_array_add (paths, g_strdup (strv[i]));
+            continue;
+        }
+
+        dirname = g_path_get_dirname (strv[i]);
+        dir = g_dir_open (dirname, 0, error);
+        if (!dir) {
+            g_free (dirname);
+            g_ptr_array_unref (paths);
+            return NULL;
+        }
+
+        spec = g_pattern_spec_new (strv[i]);
+        while ((name = g_dir_read_name (dir)) != NULL) {
+            gchar *path;
+
+            path = g_build_filename (dirname, name, NULL);
+            if (g_pattern_match_string (spec, path)) {
+                g_ptr_array_add (paths, path);
+                n_matches++;
+            } else
+                g_free (path);
+        }
+        g_pattern_spec_free (spec);
+        g_dir_close (dir);
+        g_free (dirname);
+
+        if (!n_matches)
+            g_printerr ("warning: no devices match '%s'\n", strv[i]);
+    }
+
+    if (!paths->len) {
+        g_set_error (error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND, "no devices found");
+        g_ptr_array_unref (paths);
+        return NULL;
+    }
+
+    g_ptr_array_sort (paths, (GCompareFunc) compare_device_paths);
+    g_ptr_array_set_free_func (paths, NULL);
+    g_ptr_array_add (paths, NULL);
+    return (gchar **) g_ptr_array_free (paths, FALSE);
+}
+
 int main (int argc, char **argv)
 {
     GError             *error = NULL;
@@ -553,6 +652,7 @@ int main (int argc, char **argv)
     guint               n_actions_cdc_wdm_needed;
     gboolean            result = FALSE;
     QfuDeviceSelection *device_selection = NULL;
+    gchar             **fleet_paths = NULL;
     QmiDeviceOpenFlags  device_open_flags = QMI_DEVICE_OPEN_FLAGS_NONE;
 
     setlocale (LC_ALL, "");
@@ -569,6 +669,10 @@ int main (int argc, char **argv)
     group = g_option_group_new ("update", "Update options (normal mode):", "", NULL, NULL);
     g_option_group_add_entries (group, context_update_entries);
     g_option_context_add_group (context, group);
+
+    group = g_option_group_new ("service", "Service options:", "", NULL, NULL);
+    g_option_group_add_entries (group, context_service_entries);
+    g_option_context_add_group (context, group);
 #endif
 
     group = g_option_group_new ("reset", "Reset options (normal mode):", "", NULL, NULL);
@@ -627,6 +731,9 @@ int main (int argc, char **argv)
     n_actions_cdc_wdm_needed += action_update_flag;
     n_actions_images_needed  += action_update_flag;
     n_actions_device_needed  += action_update_flag;
+    /* The service selects devices and images per job */
+    n_actions                += !!service_socket_str;
+    n_actions_cdc_wdm_needed += !!service_socket_str;
 #endif
 
     /* We don't allow multiple actions at the same time */
@@ -645,17 +752,55 @@ int main (int argc, char **argv)
         goto out;
     }
 
+    /* Fleet mode is only available for update operations, and replaces the
+     * single device selection */
+    if (fleet_strv) {
+        gboolean single_selection;
+
+        if (!action_update_download_flag
+#if defined WITH_UDEV
+            && !action_update_flag
+#endif
+            ) {
+            g_printerr ("error: fleet mode is only supported in update operations\n");
+            goto out;
+        }
+
+        single_selection = (cdc_wdm_str || tty_str);
+#if defined WITH_UDEV
+        single_selection |= (vid || pid || busnum || devnum);
+#endif
+        if (single_selection) {
+            g_printerr ("error: fleet mode cannot be used along with generic device selection options\n");
+            goto out;
+        }
+
+        if (fleet_max_concurrent_int < 1) {
+            g_printerr ("error: invalid maximum number of concurrent fleet updates\n");
+            goto out;
+        }
+
+        fleet_paths = expand_fleet_device_paths (fleet_strv, &error);
+        if (!fleet_paths) {
+            g_printerr ("error: couldn't select fleet devices: %s\n", error->message);
+            g_error_free (error);
+            goto out;
+        }
+    }
+
     /* device selection must be performed for update and reset operations */
     if (n_actions_device_needed) {
+        if (!fleet_paths) {
 #if defined WITH_UDEV
-        device_selection = qfu_device_selection_new (cdc_wdm_str, tty_str, vid, pid, busnum, devnum, &error);
+            device_selection = qfu_device_selection_new (cdc_wdm_str, tty_str, vid, pid, busnum, devnum, &error);
 #else
-        device_selection = qfu_device_selection_new (cdc_wdm_str, tty_str, 0, 0, 0, 0, &error);
+            device_selection = qfu_device_selection_new (cdc_wdm_str, tty_str, 0, 0, 0, 0, &error);
 #endif
-        if (!device_selection) {
-            g_printerr ("error: couldn't select device:: %s\n", error->message);
-            g_error_free (error);
-            goto out;
+            if (!device_selection) {
+                g_printerr ("error: couldn't select device:: %s\n", error->message);
+                g_error_free (error);
+                goto out;
+            }
         }
 
 #if defined MM_RUNTIME_CHECK_ENABLED
@@ -701,12 +846,37 @@ int main (int argc, char **argv)
             device_open_flags |= QMI_DEVICE_OPEN_FLAGS_AUTO;
     }
 
+    /* Validate QDL window size, sent to the device in a single byte */
+    if (qdl_window_size_int < 1 || qdl_window_size_int > G_MAXUINT8) {
+        g_printerr ("error: invalid QDL window size\n");
+        goto out;
+    }
+
     /* Run */
 
 #if defined WITH_UDEV
-    if (action_update_flag) {
-        g_assert (QFU_IS_DEVICE_SELECTION (device_selection));
+    if (service_socket_str) {
+        if (modem_storage_index_int < 0 || modem_storage_index_int > G_MAXUINT8) {
+            g_printerr ("error: invalid modem storage index\n");
+            goto out;
+        }
+
+        result = qfu_operation_service_run (service_socket_str,
+                                            (const gchar **) image_strv,
+                                            firmware_version_str,
+                                            config_version_str,
+                                            carrier_str,
+                                            device_open_flags,
+                                            ignore_version_errors_flag,
+                                            override_download_flag,
+                                            (guint8) modem_storage_index_int,
+                                            skip_validation_flag,
+                                            (guint8) qdl_window_size_int,
+                                            stats_json_str);
+        goto out;
+    }
 
+    if (action_update_flag) {
         /* Validate storage index, just (0,G_MAXUINT8] for now. The value 0 is also not
          * valid, but we use it to flag when no specific index has been requested. */
         if (modem_storage_index_int < 0 || modem_storage_index_int > G_MAXUINT8) {
@@ -714,6 +884,24 @@ int main (int argc, char **argv)
             goto out;
         }
 
+        if (fleet_paths) {
+            result = qfu_operation_update_fleet_run ((const gchar **) image_strv,
+                                                     (const gchar **) fleet_paths,
+                                                     (guint) fleet_max_concurrent_int,
+                                                     firmware_version_str,
+                                                     config_version_str,
+                                                     carrier_str,
+                                                     device_open_flags,
+                                                     ignore_version_errors_flag,
+                                                     override_download_flag,
+                                                     (guint8) modem_storage_index_int,
+                                                     skip_validation_flag,
+                                                     (guint8) qdl_window_size_int,
+                                                     stats_json_str);
+            goto out;
+        }
+
+        g_assert (QFU_IS_DEVICE_SELECTION (device_selection));
         result = qfu_operation_update_run ((const gchar **) image_strv,
                                            device_selection,
                                            firmware_version_str,
@@ -723,15 +911,28 @@ int main (int argc, char **argv)
                                            ignore_version_errors_flag,
                                            override_download_flag,
                                            (guint8) modem_storage_index_int,
-                                           skip_validation_flag);
+                                           skip_validation_flag,
+                                           (guint8) qdl_window_size_int,
+                                           stats_json_str);
         goto out;
     }
 #endif /* WITH_UDEV */
 
     if (action_update_download_flag) {
+        if (fleet_paths) {
+            result = qfu_operation_update_download_fleet_run ((const gchar **) image_strv,
+                                                              (const gchar **) fleet_paths,
+                                                              (guint) fleet_max_concurrent_int,
+                                                              (guint8) qdl_window_size_int,
+                                                              stats_json_str);
+            goto out;
+        }
+
         g_assert (QFU_IS_DEVICE_SELECTION (device_selection));
         result = qfu_operation_update_download_run ((const gchar **) image_strv,
-                                                    device_selection);
+                                                    device_selection,
+                                                    (guint8) qdl_window_size_int,
+                                                    stats_json_str);
         goto out;
     }
 
@@ -750,6 +951,7 @@ int main (int argc, char **argv)
 
 out:
 
+    qfu_image_factory_clear_shared ();
     qfu_log_shutdown ();
 
     /* Clean exit for a clean memleak report */
@@ -757,6 +959,7 @@ out:
         g_option_context_free (context);
     if (device_selection)
         g_object_unref (device_selection);
+    g_strfreev (fleet_paths);
 
     return (result ? EXIT_SUCCESS : EXIT_FAILURE);
 }
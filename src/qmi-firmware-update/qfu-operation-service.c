@@ -0,0 +1,554 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * qmi-firmware-update -- Command line tool to update firmware in QMI devices
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright (C) 2016 Zodiac Inflight Innovations
+ * Copyright (C) 2016-2017 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <glib-object.h>
+#include <gio/gio.h>
+#include <gio/gunixsocketaddress.h>
+#include <glib-unix.h>
+
+#include "qfu-operation.h"
+#include "qfu-updater.h"
+#include "qfu-image.h"
+#include "qfu-image-factory.h"
+
+#if defined WITH_UDEV
+
+/******************************************************************************/
+/* Service mode
+ *
+ * A long running process accepting update jobs through a control socket, so
+ * that the images, once parsed and mapped, are kept in the shared image cache
+ * (with their pages locked in memory if possible) across all the jobs.
+ *
+ * Clients send one command per line, and get a single line reply starting
+ * with either "ok" or "error" once the command is finished:
+ *
+ *   preload IMAGE...
+ *   update CDC_WDM IMAGE...
+ *   update-download TTY IMAGE...
+ *   flush
+ *   quit
+ *
+ * Arguments are split as in a shell, so paths with spaces may be quoted. The
+ * update settings given in the command line apply to all jobs.
+ */
+
+typedef struct {
+    GMainLoop      *loop;
+    GCancellable   *cancellable;
+    GSocketService *socket_service;
+    gchar          *socket_path;
+    guint           n_running;
+    guint           n_jobs;
+    guint           n_succeeded;
+    gboolean        quit_requested;
+    /* Job settings */
+    const gchar    *firmware_version;
+    const gchar    *config_version;
+    const gchar    *carrier;
+    QmiDeviceOpenFlags device_open_flags;
+    gboolean        ignore_version_errors;
+    gboolean        override_download;
+    guint8          modem_storage_index;
+    gboolean        skip_validation;
+    guint8          qdl_window_size;
+    const gchar    *stats_file;
+} ServiceOperation;
+
+typedef struct {
+    ServiceOperation  *service;
+    GSocketConnection *connection;
+    GDataInputStream  *input;
+    GOutputStream     *output;
+    /* Running job, if any */
+    QfuUpdater        *updater;
+    gchar             *label;
+    GTimer            *timer;
+    GList             *images;
+} ServiceClient;
+
+static void service_client_read_next (ServiceClient *client);
+
+static void
+service_quit_if_idle (ServiceOperation *service)
+{
+    if (service->n_running > 0)
+        return;
+
+    if (service->quit_requested || g_cancellable_is_cancelled (service->cancellable))
+        g_idle_add ((GSourceFunc) g_main_loop_quit, service->loop);
+}
+
+static gboolean
+signal_handler (ServiceOperation *service)
+{
+    /* Ignore consecutive requests of cancellation */
+    if (!g_cancellable_is_cancelled (service->cancellable)) {
+        g_printerr ("cancelling the service...\n");
+        g_socket_service_stop (service->socket_service);
+        g_cancellable_cancel (service->cancellable);
+        service_quit_if_idle (service);
+        /* Reset the signal handler to allow main loop cancellation on
+         * second signal */
+        return G_SOURCE_CONTINUE;
+    }
+
+    if (g_main_loop_is_running (service->loop)) {
+        g_printerr ("cancelling the main loop...\n");
+        g_main_loop_quit (service->loop);
+    }
+
+    return G_SOURCE_REMOVE;
+}
+
+/******************************************************************************/
+
+static void
+service_client_free (ServiceClient *client)
+{
+    g_assert (!client->updater);
+
+    g_debug ("[qfu-service] client disconnected");
+    g_object_unref (client->input);
+    g_object_unref (client->connection);
+    g_slice_free (ServiceClient, client);
+}
+
+static void
+service_client_reply (ServiceClient *client,
+                      const gchar   *format,
+                      ...)
+{
+    va_list  args;
+    gchar   *str;
+    GError  *error = NULL;
+
+    va_start (args, format);
+    str = g_strdup_vprintf (format, args);
+    va_end (args);
+
+    g_debug ("[qfu-service] reply: %s", str);
+
+    /* Replies are short, a blocking write is fine */
+    if (!g_output_stream_write_all (client->output, str, strlen (str), NULL, NULL, &error) ||
+        !g_output_stream_write_all (client->output, "\n", 1, NULL, NULL, &error)) {
+        g_debug ("[qfu-service] couldn't write reply: %s", error->message);
+        g_error_free (error);
+    }
+    g_free (str);
+}
+
+/* Images shared with the other jobs, kept mapped and locked in memory */
+static GList *
+service_load_images (gchar  **image_paths,
+                     GError **error)
+{
+    GList *images = NULL;
+    guint  i;
+
+    for (i = 0; image_paths[i]; i++) {
+        QfuImage *image;
+        GFile    *file;
+        GError   *inner_error = NULL;
+
+        file = g_file_new_for_commandline_arg (image_paths[i]);
+        image = qfu_image_factory_build_shared (file, NULL, error);
+        g_object_unref (file);
+        if (!image) {
+            g_list_free_full (images, g_object_unref);
+            return NULL;
+        }
+
+        /* Locking may fail e.g. due to RLIMIT_MEMLOCK; the pages are then
+         * only as warm as the page cache allows */
+        if (qfu_image_peek (image, 0, 0) && !qfu_image_lock_pages (image, &inner_error)) {
+            g_debug ("[qfu-service] %s: %s", qfu_image_get_display_name (image), inner_error->message);
+            g_error_free (inner_error);
+        }
+
+        images = g_list_append (images, image);
+    }
+
+    return images;
+}
+
+static void
+job_ready (QfuUpdater    *updater,
+           GAsyncResult  *res,
+           ServiceClient *client)
+{
+    ServiceOperation *service;
+    GError           *error = NULL;
+    gdouble           elapsed;
+
+    service = client->service;
+    elapsed = g_timer_elapsed (client->timer, NULL);
+
+    if (!qfu_updater_run_finish (updater, res, &error)) {
+        g_printerr ("[%s] error after %.2lfs: %s\n", client->label, elapsed, error->message);
+        service_client_reply (client, "error %s", error->message);
+        g_error_free (error);
+    } else {
+        g_print ("[%s] firmware update operation finished successfully in %.2lfs\n", client->label, elapsed);
+        service_client_reply (client, "ok %.2lf", elapsed);
+        service->n_succeeded++;
+    }
+
+    g_list_free_full (client->images, g_object_unref);
+    client->images = NULL;
+    g_clear_pointer (&client->timer, g_timer_destroy);
+    g_clear_pointer (&client->label, g_free);
+    g_clear_object (&client->updater);
+
+    g_assert (service->n_running > 0);
+    service->n_running--;
+
+    /* Keep on serving this client unless we're going away */
+    if (service->quit_requested || g_cancellable_is_cancelled (service->cancellable)) {
+        service_client_free (client);
+        service_quit_if_idle (service);
+        return;
+    }
+
+    service_client_read_next (client);
+}
+
+static gboolean
+service_client_start_job (ServiceClient  *client,
+                          gboolean        download,
+                          gchar         **argv,
+                          GError        **error)
+{
+    ServiceOperation   *service;
+    QfuDeviceSelection *device_selection;
+    GList              *l;
+    gboolean            shared = TRUE;
+
+    service = client->service;
+
+    if (!argv[0] || !argv[1]) {
+        g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+                     "a device and at least one image are required");
+        return FALSE;
+    }
+
+    device_selection = qfu_device_selection_new (download ? NULL : argv[0],
+                                                 download ? argv[0] : NULL,
+                                                 0, 0, 0, 0,
+                                                 error);
+    if (!device_selection)
+        return FALSE;
+
+    client->images = service_load_images (&argv[1], error);
+    if (!client->images) {
+        g_object_unref (device_selection);
+        return FALSE;
+    }
+
+    if (download)
+        client->updater = qfu_updater_new_download (device_selection);
+    else
+        client->updater = qfu_updater_new (device_selection,
+                                           service->firmware_version,
+                                           service->config_version,
+                                           service->carrier,
+                                           service->device_open_flags,
+                                           service->ignore_version_errors,
+                                           service->override_download,
+                                           service->modem_storage_index,
+                                           service->skip_validation);
+    g_object_unref (device_selection);
+
+    client->label = g_strdup (argv[0]);
+    qfu_updater_set_qdl_window_size (client->updater, service->qdl_window_size);
+    qfu_updater_set_stats_file (client->updater, service->stats_file);
+    qfu_updater_set_label (client->updater, client->label);
+
+    service->n_jobs++;
+    service->n_running++;
+    g_print ("[%s] starting firmware update operation (job %u)...\n", client->label, service->n_jobs);
+    client->timer = g_timer_new ();
+
+    /* Images are shared only if they're mapped in memory, as otherwise
+     * reading them at the same time from different updaters isn't safe */
+    for (l = client->images; l && shared; l = g_list_next (l))
+        shared = !!qfu_image_peek (QFU_IMAGE (l->data), 0, 0);
+
+    if (shared)
+        qfu_updater_run_images (client->updater, client->images, service->cancellable,
+                                (GAsyncReadyCallback) job_ready, client);
+    else {
+        GList *image_file_list = NULL;
+        guint  i;
+
+        for (i = 1; argv[i]; i++)
+            image_file_list = g_list_append (image_file_list, g_file_new_for_commandline_arg (argv[i]));
+        qfu_updater_run (client->updater, image_file_list, service->cancellable,
+                         (GAsyncReadyCallback) job_ready, client);
+        g_list_free_full (image_file_list, g_object_unref);
+    }
+
+    return TRUE;
+}
+
+/* Returns TRUE if the client should keep on being served right away */
+static gboolean
+service_client_run_command (ServiceClient *client,
+                            const gchar   *line)
+{
+    gchar  **argv = NULL;
+    GError  *error = NULL;
+    gboolean keep_reading = TRUE;
+
+    g_debug ("[qfu-service] command: %s", line);
+
+    if (!g_shell_parse_argv (line, NULL, &argv, &error)) {
+        /* Empty lines are just ignored */
+        if (!g_error_matches (error, G_SHELL_ERROR, G_SHELL_ERROR_EMPTY_STRING))
+            service_client_reply (client, "error %s", error->message);
+        g_error_free (error);
+        return TRUE;
+    }
+
+    if (g_str_equal (argv[0], "update") || g_str_equal (argv[0], "update-download")) {
+        if (service_client_start_job (client, g_str_equal (argv[0], "update-download"), &argv[1], &error))
+            keep_reading = FALSE;
+        else {
+            service_client_reply (client, "error %s", error->message);
+            g_error_free (error);
+        }
+    } else if (g_str_equal (argv[0], "preload")) {
+        GList *images;
+
+        if (!argv[1])
+            service_client_reply (client, "error no images given");
+        else if (!(images = service_load_images (&argv[1], &error))) {
+            service_client_reply (client, "error %s", error->message);
+            g_error_free (error);
+        } else {
+            service_client_reply (client, "ok %u", g_list_length (images));
+            g_list_free_full (images, g_object_unref);
+        }
+    } else if (g_str_equal (argv[0], "flush")) {
+        /* Images used by running jobs go away once they finish */
+        qfu_image_factory_clear_shared ();
+        service_client_reply (client, "ok");
+    } else if (g_str_equal (argv[0], "quit")) {
+        g_print ("quit requested, waiting for %u running jobs...\n", client->service->n_running);
+        client->service->quit_requested = TRUE;
+        g_socket_service_stop (client->service->socket_service);
+        service_client_reply (client, "ok");
+        service_quit_if_idle (client->service);
+        keep_reading = FALSE;
+    } else
+        service_client_reply (client, "error unknown command '%s'", argv[0]);
+
+    g_strfreev (argv);
+    return keep_reading;
+}
+
+static void
+read_line_ready (GDataInputStream *input,
+                 GAsyncResult     *res,
+                 ServiceClient    *client)
+{
+    gchar  *line;
+    GError *error = NULL;
+
+    line = g_data_input_stream_read_line_finish_utf8 (input, res, NULL, &error);
+    if (!line) {
+        if (error) {
+            g_debug ("[qfu-service] couldn't read command: %s", error->message);
+            g_error_free (error);
+        }
+        service_client_free (client);
+        return;
+    }
+
+    if (service_client_run_command (client, g_strstrip (line)))
+        service_client_read_next (client);
+    else if (!client->updater)
+        service_client_free (client);
+
+    g_free (line);
+}
+
+static void
+service_client_read_next (ServiceClient *client)
+{
+    g_data_input_stream_read_line_async (client->input,
+                                         G_PRIORITY_DEFAULT,
+                                         client->service->cancellable,
+                                         (GAsyncReadyCallback) read_line_ready,
+                                         client);
+}
+
+static gboolean
+incoming_cb (GSocketService    *socket_service,
+             GSocketConnection *connection,
+             GObject           *source_object,
+             ServiceOperation  *service)
+{
+    ServiceClient *client;
+
+    g_debug ("[qfu-service] client connected");
+
+    client = g_slice_new0 (ServiceClient);
+    client->service = service;
+    client->connection = g_object_ref (connection);
+    client->input = g_data_input_stream_new (g_io_stream_get_input_stream (G_IO_STREAM (connection)));
+    client->output = g_io_stream_get_output_stream (G_IO_STREAM (connection));
+
+    service_client_read_next (client);
+    return TRUE;
+}
+
+/******************************************************************************/
+
+static gboolean
+service_listen (ServiceOperation  *service,
+                GError           **error)
+{
+    GSocketAddress *address;
+    struct stat     st;
+    gboolean        result;
+
+    /* A socket left behind by a previous instance would make the bind fail,
+     * but never remove anything else */
+    if (lstat (service->socket_path, &st) == 0) {
+        if (!S_ISSOCK (st.st_mode)) {
+            g_set_error (error, G_IO_ERROR, G_IO_ERROR_EXISTS,
+                         "'%s' exists and is not a socket", service->socket_path);
+            return FALSE;
+        }
+        if (unlink (service->socket_path) < 0) {
+            g_set_error (error, G_IO_ERROR, g_io_error_from_errno (errno),
+                         "couldn't remove stale socket '%s': %s",
+                         service->socket_path, g_strerror (errno));
+            return FALSE;
+        }
+    }
+
+    service->socket_service = g_socket_service_new ();
+    address = g_unix_socket_address_new (service->socket_path);
+    result = g_socket_listener_add_address (G_SOCKET_LISTENER (service->socket_service),
+                                            address,
+                                            G_SOCKET_TYPE_STREAM,
+                                            G_SOCKET_PROTOCOL_DEFAULT,
+                                            NULL,
+                                            NULL,
+                                            error);
+    g_object_unref (address);
+    if (!result)
+        return FALSE;
+
+    g_signal_connect (service->socket_service, "incoming", G_CALLBACK (incoming_cb), service);
+    g_socket_service_start (service->socket_service);
+    return TRUE;
+}
+
+gboolean
+qfu_operation_service_run (const gchar         *socket_path,
+                           const gchar        **images,
+                           const gchar         *firmware_version,
+                           const gchar         *config_version,
+                           const gchar         *carrier,
+                           QmiDeviceOpenFlags   device_open_flags,
+                           gboolean             ignore_version_errors,
+                           gboolean             override_download,
+                           guint8               modem_storage_index,
+                           gboolean             skip_validation,
+                           guint8               qdl_window_size,
+                           const gchar         *stats_file)
+{
+    ServiceOperation service = {
+        .socket_path           = g_strdup (socket_path),
+        .firmware_version      = firmware_version,
+        .config_version        = config_version,
+        .carrier               = carrier,
+        .device_open_flags     = device_open_flags,
+        .ignore_version_errors = ignore_version_errors,
+        .override_download     = override_download,
+        .modem_storage_index   = modem_storage_index,
+        .skip_validation       = skip_validation,
+        .qdl_window_size       = qdl_window_size,
+        .stats_file            = stats_file,
+    };
+    GError   *error = NULL;
+    gboolean  result = FALSE;
+
+    g_assert (socket_path);
+
+    /* Images given in the command line are loaded right away */
+    if (images) {
+        GList *preloaded;
+
+        preloaded = service_load_images ((gchar **) images, &error);
+        if (!preloaded) {
+            g_printerr ("error: couldn't load firmware images: %s\n", error->message);
+            g_error_free (error);
+            goto out;
+        }
+        g_print ("preloaded %u firmware images\n", g_list_length (preloaded));
+        g_list_free_full (preloaded, g_object_unref);
+    }
+
+    if (!service_listen (&service, &error)) {
+        g_printerr ("error: couldn't listen in control socket: %s\n", error->message);
+        g_error_free (error);
+        goto out;
+    }
+
+    /* Create runtime context */
+    service.loop        = g_main_loop_new (NULL, FALSE);
+    service.cancellable = g_cancellable_new ();
+
+    /* Setup signals */
+    g_unix_signal_add (SIGINT,  (GSourceFunc) signal_handler, &service);
+    g_unix_signal_add (SIGHUP,  (GSourceFunc) signal_handler, &service);
+    g_unix_signal_add (SIGTERM, (GSourceFunc) signal_handler, &service);
+
+    /* Run! */
+    g_print ("waiting for update jobs in %s...\n", socket_path);
+    g_main_loop_run (service.loop);
+
+    g_print ("service finished: %u/%u update jobs finished successfully\n",
+             service.n_succeeded, service.n_jobs);
+    result = !g_cancellable_is_cancelled (service.cancellable);
+
+    g_socket_service_stop (service.socket_service);
+    g_socket_listener_close (G_SOCKET_LISTENER (service.socket_service));
+    unlink (service.socket_path);
+
+out:
+    g_clear_object (&service.socket_service);
+    g_clear_object (&service.cancellable);
+    g_clear_pointer (&service.loop, g_main_loop_unref);
+    g_free (service.socket_path);
+    return result;
+}
+
+#endif /* WITH_UDEV */
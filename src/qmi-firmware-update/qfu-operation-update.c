@@ -25,6 +25,8 @@
 
 #include "qfu-operation.h"
 #include "qfu-updater.h"
+#include "qfu-image.h"
+#include "qfu-image-factory.h"
 
 typedef struct {
     GMainLoop    *loop;
@@ -115,6 +117,212 @@ operation_update_run (QfuUpdater   *updater,
     return operation.result;
 }
 
+/******************************************************************************/
+/* Fleet mode: several updaters running at the same time */
+
+typedef struct {
+    QfuUpdater *updater;
+    gchar      *label;
+    GTimer     *timer;
+    gboolean    result;
+} FleetDevice;
+
+typedef struct {
+    UpdateOperation  operation;
+    GPtrArray       *devices;
+    guint            max_concurrent;
+    guint            next;
+    guint            n_running;
+    guint            n_succeeded;
+    /* Either images loaded once and shared by all updaters, or otherwise
+     * image files loaded by each updater */
+    GList           *images;
+    GList           *image_file_list;
+} FleetOperation;
+
+static void
+fleet_device_free (FleetDevice *device)
+{
+    if (device->timer)
+        g_timer_destroy (device->timer);
+    g_free (device->label);
+    g_clear_object (&device->updater);
+    g_slice_free (FleetDevice, device);
+}
+
+static void fleet_start_next (FleetOperation *fleet);
+
+static void
+fleet_run_ready (QfuUpdater   *updater,
+                 GAsyncResult *res,
+                 FleetDevice  *device)
+{
+    FleetOperation *fleet;
+    GError         *error = NULL;
+    gdouble         elapsed;
+
+    fleet = g_object_get_data (G_OBJECT (updater), "fleet-operation");
+    g_assert (fleet);
+
+    elapsed = g_timer_elapsed (device->timer, NULL);
+    if (!qfu_updater_run_finish (updater, res, &error)) {
+        g_printerr ("[%s] error after %.2lfs: %s\n", device->label, elapsed, error->message);
+        if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_PERMISSION_DENIED))
+            g_printerr ("[%s] note: you can ignore this error using --ignore-version-errors\n", device->label);
+        g_error_free (error);
+    } else {
+        g_print ("[%s] firmware update operation finished successfully in %.2lfs\n", device->label, elapsed);
+        device->result = TRUE;
+        fleet->n_succeeded++;
+    }
+
+    g_assert (fleet->n_running > 0);
+    fleet->n_running--;
+    fleet_start_next (fleet);
+}
+
+static void
+fleet_start_next (FleetOperation *fleet)
+{
+    /* Don't start new updates once cancelled */
+    while (!g_cancellable_is_cancelled (fleet->operation.cancellable) &&
+           fleet->n_running < fleet->max_concurrent &&
+           fleet->next < fleet->devices->len) {
+        FleetDevice *device;
+
+        device = g_ptr_array_index (fleet->devices, fleet->next++);
+        fleet->n_running++;
+
+        g_print ("[%s] starting firmware update operation (%u/%u)...\n",
+                 device->label, fleet->next, fleet->devices->len);
+        device->timer = g_timer_new ();
+        g_object_set_data (G_OBJECT (device->updater), "fleet-operation", fleet);
+        if (fleet->images)
+            qfu_updater_run_images (device->updater, fleet->images, fleet->operation.cancellable,
+                                    (GAsyncReadyCallback) fleet_run_ready, device);
+        else
+            qfu_updater_run (device->updater, fleet->image_file_list, fleet->operation.cancellable,
+                             (GAsyncReadyCallback) fleet_run_ready, device);
+    }
+
+    if (fleet->n_running > 0)
+        return;
+
+    g_print ("fleet firmware update operation finished: %u/%u devices updated successfully\n",
+             fleet->n_succeeded, fleet->devices->len);
+    fleet->operation.result = (fleet->n_succeeded == fleet->devices->len);
+    g_idle_add ((GSourceFunc) g_main_loop_quit, fleet->operation.loop);
+}
+
+static gboolean
+fleet_load_images (FleetOperation  *fleet,
+                   GError         **error)
+{
+    GList *l;
+
+    /* Images are shared only if they're mapped in memory, as otherwise
+     * reading them at the same time from different updaters isn't safe */
+    for (l = fleet->image_file_list; l; l = g_list_next (l)) {
+        QfuImage *image;
+
+        image = qfu_image_factory_build_shared (G_FILE (l->data), NULL, error);
+        if (!image)
+            return FALSE;
+
+        fleet->images = g_list_append (fleet->images, image);
+        if (!qfu_image_peek (image, 0, 0)) {
+            g_debug ("[qfu-operation] image not mapped, won't be shared: %s",
+                     qfu_image_get_display_name (image));
+            g_list_free_full (fleet->images, g_object_unref);
+            fleet->images = NULL;
+            break;
+        }
+    }
+
+    return TRUE;
+}
+
+static gboolean
+operation_update_fleet_run (GPtrArray    *devices,
+                            guint         max_concurrent,
+                            const gchar **images)
+{
+    FleetOperation  fleet = {
+        .operation = {
+            .loop        = NULL,
+            .cancellable = NULL,
+            .result      = FALSE,
+        },
+        .devices        = devices,
+        .max_concurrent = max_concurrent,
+    };
+    GError         *error = NULL;
+    guint           i;
+
+    g_assert (images);
+    g_assert (devices->len > 0);
+    g_assert (max_concurrent > 0);
+
+    /* Create list of image files, and load them once for all updaters */
+    for (i = 0; images[i]; i++)
+        fleet.image_file_list = g_list_append (fleet.image_file_list, g_file_new_for_commandline_arg (images[i]));
+    if (!fleet_load_images (&fleet, &error)) {
+        g_printerr ("error: couldn't load firmware images: %s\n", error->message);
+        g_error_free (error);
+        g_list_free_full (fleet.image_file_list, g_object_unref);
+        return FALSE;
+    }
+
+    /* Create runtime context */
+    fleet.operation.loop        = g_main_loop_new (NULL, FALSE);
+    fleet.operation.cancellable = g_cancellable_new ();
+
+    /* Setup signals */
+    g_unix_signal_add (SIGINT,  (GSourceFunc) signal_handler, &fleet.operation);
+    g_unix_signal_add (SIGHUP,  (GSourceFunc) signal_handler, &fleet.operation);
+    g_unix_signal_add (SIGTERM, (GSourceFunc) signal_handler, &fleet.operation);
+
+    /* Run! */
+    fleet_start_next (&fleet);
+    g_main_loop_run (fleet.operation.loop);
+
+    g_list_free_full (fleet.images, g_object_unref);
+    g_list_free_full (fleet.image_file_list, g_object_unref);
+    g_object_unref (fleet.operation.cancellable);
+    g_main_loop_unref (fleet.operation.loop);
+
+    /* A cancelled operation may leave devices not even started */
+    return (fleet.operation.result && fleet.n_succeeded == devices->len);
+}
+
+static GPtrArray *
+fleet_devices_new (const gchar **device_paths)
+{
+    GPtrArray *devices;
+    guint      i;
+
+    devices = g_ptr_array_new_with_free_func ((GDestroyNotify) fleet_device_free);
+    for (i = 0; device_paths[i]; i++) {
+        FleetDevice *device;
+
+        device = g_slice_new0 (FleetDevice);
+        device->label = g_strdup (device_paths[i]);
+        g_ptr_array_add (devices, device);
+    }
+    return devices;
+}
+
+static QfuDeviceSelection *
+fleet_device_selection_new (FleetDevice  *device,
+                            gboolean      tty,
+                            GError      **error)
+{
+    return qfu_device_selection_new (tty ? NULL : device->label,
+                                     tty ? device->label : NULL,
+                                     0, 0, 0, 0,
+                                     error);
+}
+
 #if defined WITH_UDEV
 
 gboolean
@@ -127,7 +335,9 @@ qfu_operation_update_run (const gchar        **images,
                           gboolean             ignore_version_errors,
                           gboolean             override_download,
                           guint8               modem_storage_index,
-                          gboolean             skip_validation)
+                          gboolean             skip_validation,
+                          guint8               qdl_window_size,
+                          const gchar         *stats_file)
 {
     QfuUpdater *updater = NULL;
     gboolean    result;
@@ -143,16 +353,74 @@ qfu_operation_update_run (const gchar        **images,
                                override_download,
                                modem_storage_index,
                                skip_validation);
+    qfu_updater_set_qdl_window_size (updater, qdl_window_size);
+    qfu_updater_set_stats_file (updater, stats_file);
     result = operation_update_run (updater, images);
     g_object_unref (updater);
     return result;
 }
 
+gboolean
+qfu_operation_update_fleet_run (const gchar        **images,
+                                const gchar        **device_paths,
+                                guint                max_concurrent,
+                                const gchar         *firmware_version,
+                                const gchar         *config_version,
+                                const gchar         *carrier,
+                                QmiDeviceOpenFlags   device_open_flags,
+                                gboolean             ignore_version_errors,
+                                gboolean             override_download,
+                                guint8               modem_storage_index,
+                                gboolean             skip_validation,
+                                guint8               qdl_window_size,
+                                const gchar         *stats_file)
+{
+    GPtrArray *devices;
+    gboolean   result;
+    guint      i;
+
+    devices = fleet_devices_new (device_paths);
+    for (i = 0; i < devices->len; i++) {
+        FleetDevice        *device;
+        QfuDeviceSelection *device_selection;
+        GError             *error = NULL;
+
+        device = g_ptr_array_index (devices, i);
+        device_selection = fleet_device_selection_new (device, FALSE, &error);
+        if (!device_selection) {
+            g_printerr ("error: couldn't select device %s: %s\n", device->label, error->message);
+            g_error_free (error);
+            g_ptr_array_unref (devices);
+            return FALSE;
+        }
+
+        device->updater = qfu_updater_new (device_selection,
+                                           firmware_version,
+                                           config_version,
+                                           carrier,
+                                           device_open_flags,
+                                           ignore_version_errors,
+                                           override_download,
+                                           modem_storage_index,
+                                           skip_validation);
+        qfu_updater_set_qdl_window_size (device->updater, qdl_window_size);
+        qfu_updater_set_stats_file (device->updater, stats_file);
+        qfu_updater_set_label (device->updater, device->label);
+        g_object_unref (device_selection);
+    }
+
+    result = operation_update_fleet_run (devices, max_concurrent, images);
+    g_ptr_array_unref (devices);
+    return result;
+}
+
 #endif
 
 gboolean
 qfu_operation_update_download_run (const gchar        **images,
-                                   QfuDeviceSelection  *device_selection)
+                                   QfuDeviceSelection  *device_selection,
+                                   guint8               qdl_window_size,
+                                   const gchar         *stats_file)
 {
     QfuUpdater *updater = NULL;
     gboolean    result;
@@ -160,7 +428,47 @@ qfu_operation_update_download_run (const gchar        **images,
     g_assert (images);
 
     updater = qfu_updater_new_download (device_selection);
+    qfu_updater_set_qdl_window_size (updater, qdl_window_size);
+    qfu_updater_set_stats_file (updater, stats_file);
     result = operation_update_run (updater, images);
     g_object_unref (updater);
     return result;
 }
+
+gboolean
+qfu_operation_update_download_fleet_run (const gchar **images,
+                                         const gchar **device_paths,
+                                         guint         max_concurrent,
+                                         guint8        qdl_window_size,
+                                         const gchar  *stats_file)
+{
+    GPtrArray *devices;
+    gboolean   result;
+    guint      i;
+
+    devices = fleet_devices_new (device_paths);
+    for (i = 0; i < devices->len; i++) {
+        FleetDevice        *device;
+        QfuDeviceSelection *device_selection;
+        GError             *error = NULL;
+
+        device = g_ptr_array_index (devices, i);
+        device_selection = fleet_device_selection_new (device, TRUE, &error);
+        if (!device_selection) {
+            g_printerr ("error: couldn't select device %s: %s\n", device->label, error->message);
+            g_error_free (error);
+            g_ptr_array_unref (devices);
+            return FALSE;
+        }
+
+        device->updater = qfu_updater_new_download (device_selection);
+        qfu_updater_set_qdl_window_size (device->updater, qdl_window_size);
+        qfu_updater_set_stats_file (device->updater, stats_file);
+        qfu_updater_set_label (device->updater, device->label);
+        g_object_unref (device_selection);
+    }
+
+    result = operation_update_fleet_run (devices, max_concurrent, images);
+    g_ptr_array_unref (devices);
+    return result;
+}
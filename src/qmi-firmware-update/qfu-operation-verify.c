@@ -69,20 +69,32 @@ print_image_cwe (QfuImageCwe *image,
     }
 }
 
+typedef struct {
+    const gchar *image_path;
+    QfuImage    *image;
+    GError      *error;
+} VerifyContext;
+
+static void
+verify_load_image (VerifyContext *ctx,
+                   gpointer       unused)
+{
+    GFile *file;
+
+    file = g_file_new_for_commandline_arg (ctx->image_path);
+    ctx->image = qfu_image_factory_build (file, NULL, &ctx->error);
+    g_object_unref (file);
+}
+
 static gboolean
-operation_verify_run_single (const gchar *image_path)
+operation_verify_print_single (VerifyContext *ctx)
 {
     QfuImage *image;
-    GFile    *file;
-    GError   *error = NULL;
-    gboolean  result = FALSE;
 
-    file = g_file_new_for_commandline_arg (image_path);
-    image = qfu_image_factory_build (file, NULL, &error);
+    image = ctx->image;
     if (!image) {
-        g_printerr ("error: couldn't detect image type: %s\n", error->message);
-        g_error_free (error);
-        goto out;
+        g_printerr ("error: couldn't detect image type: %s\n", ctx->error->message);
+        return FALSE;
     }
 
     g_print ("\n");
@@ -107,22 +119,39 @@ operation_verify_run_single (const gchar *image_path)
         print_image_cwe (image_cwe, "  ", "0", 0);
     }
 
-    result = TRUE;
-
-out:
-    if (image)
-        g_object_unref (image);
-    return result;
+    return TRUE;
 }
 
 gboolean
 qfu_operation_verify_run (const gchar **images)
 {
-    guint invalid_images = 0;
-    guint i;
+    GThreadPool   *pool;
+    VerifyContext *ctxs;
+    guint          n_images;
+    guint          invalid_images = 0;
+    guint          i;
+
+    n_images = g_strv_length ((gchar **) images);
+    ctxs = g_new0 (VerifyContext, n_images);
+
+    /* Images are loaded and validated in parallel, as that involves lots of
+     * I/O on possibly big files; the report is printed afterwards, in the
+     * same order as the images were given. */
+    pool = g_thread_pool_new ((GFunc) verify_load_image, NULL,
+                              (gint) MAX (1, MIN (n_images, g_get_num_processors ())),
+                              FALSE, NULL);
+    for (i = 0; i < n_images; i++) {
+        ctxs[i].image_path = images[i];
+        g_thread_pool_push (pool, &ctxs[i], NULL);
+    }
+    g_thread_pool_free (pool, FALSE, TRUE);
 
-    for (i = 0; images[i] ; i++)
-        invalid_images += !operation_verify_run_single (images[i]);
+    for (i = 0; i < n_images; i++) {
+        invalid_images += !operation_verify_print_single (&ctxs[i]);
+        g_clear_object (&ctxs[i].image);
+        g_clear_error (&ctxs[i].error);
+    }
+    g_free (ctxs);
 
     return !invalid_images;
 }
@@ -40,11 +40,45 @@ gboolean qfu_operation_update_run          (const gchar        **images,
                                             gboolean             ignore_version_errors,
                                             gboolean             override_download,
                                             guint8               modem_storage_index,
-                                            gboolean             skip_validation);
+                                            gboolean             skip_validation,
+                                            guint8               qdl_window_size,
+                                            const gchar         *stats_file);
+gboolean qfu_operation_update_fleet_run    (const gchar        **images,
+                                            const gchar        **device_paths,
+                                            guint                max_concurrent,
+                                            const gchar         *firmware_version,
+                                            const gchar         *config_version,
+                                            const gchar         *carrier,
+                                            QmiDeviceOpenFlags   device_open_flags,
+                                            gboolean             ignore_version_errors,
+                                            gboolean             override_download,
+                                            guint8               modem_storage_index,
+                                            gboolean             skip_validation,
+                                            guint8               qdl_window_size,
+                                            const gchar         *stats_file);
+gboolean qfu_operation_service_run         (const gchar         *socket_path,
+                                            const gchar        **images,
+                                            const gchar         *firmware_version,
+                                            const gchar         *config_version,
+                                            const gchar         *carrier,
+                                            QmiDeviceOpenFlags   device_open_flags,
+                                            gboolean             ignore_version_errors,
+                                            gboolean             override_download,
+                                            guint8               modem_storage_index,
+                                            gboolean             skip_validation,
+                                            guint8               qdl_window_size,
+                                            const gchar         *stats_file);
 #endif
 
 gboolean qfu_operation_update_download_run (const gchar        **images,
-                                            QfuDeviceSelection  *device_selection);
+                                            QfuDeviceSelection  *device_selection,
+                                            guint8               qdl_window_size,
+                                            const gchar         *stats_file);
+gboolean qfu_operation_update_download_fleet_run (const gchar **images,
+                                                  const gchar **device_paths,
+                                                  guint         max_concurrent,
+                                                  guint8        qdl_window_size,
+                                                  const gchar  *stats_file);
 gboolean qfu_operation_verify_run          (const gchar        **images);
 gboolean qfu_operation_reset_run           (QfuDeviceSelection  *device_selection,
                                             QmiDeviceOpenFlags   device_open_flags);
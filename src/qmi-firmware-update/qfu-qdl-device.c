@@ -25,6 +25,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <termios.h>
 #include <unistd.h>
 
@@ -36,12 +37,16 @@
 #include "qfu-dload-message.h"
 #include "qfu-qdl-device.h"
 #include "qfu-utils.h"
+#include "qfu-hdlc.h"
 #include "qfu-enum-types.h"
 
 static void initable_iface_init (GInitableIface *iface);
 
+/* The default GAsyncInitable implementation runs the GInitable one in a
+ * thread, so that the blocking port setup doesn't block the main loop */
 G_DEFINE_TYPE_EXTENDED (QfuQdlDevice, qfu_qdl_device, G_TYPE_OBJECT, 0,
-                        G_IMPLEMENT_INTERFACE (G_TYPE_INITABLE, initable_iface_init))
+                        G_IMPLEMENT_INTERFACE (G_TYPE_INITABLE, initable_iface_init)
+                        G_IMPLEMENT_INTERFACE (G_TYPE_ASYNC_INITABLE, NULL))
 
 enum {
     PROP_0,
@@ -60,110 +65,14 @@ struct _QfuQdlDevicePrivate {
     guint       qdl_version;
     GByteArray *buffer;
     GByteArray *secondary_buffer;
+    /* bytes received after the last response, kept while several
+     * responses may be outstanding */
+    GByteArray *pending;
 };
 
 /******************************************************************************/
 /* HDLC */
 
-#define CONTROL 0x7e
-#define ESCAPE  0x7d
-#define MASK    0x20
-
-static gsize
-escape (const guint8 *in,
-        gsize         inlen,
-        guint8       *out,
-        gsize         outlen)
-{
-    gsize i, j;
-
-    for (i = 0, j = 0; i < inlen; i++) {
-        /* Caller should give a big enough buffer */
-        g_assert ((j + 1) < outlen);
-        if (in[i] == CONTROL || in[i] == ESCAPE) {
-            out[j++] = ESCAPE;
-            out[j++] = in[i] ^ MASK;
-        } else
-            out[j++] = in[i];
-    }
-    return j;
-}
-
-static gsize
-unescape (const guint8 *in,
-          gsize         inlen,
-          guint8       *out,
-          gsize         outlen)
-{
-    gsize    i, j = 0;
-    gboolean escaping = FALSE;
-
-    for (i = 0; i < inlen; i++) {
-        /* Caller should give a big enough buffer */
-        g_assert (j < outlen);
-        if (escaping) {
-            out[j++] = in[i] ^ MASK;
-            escaping = FALSE;
-        } else if (in[i] == ESCAPE) {
-            escaping = TRUE;
-        } else {
-            out[j++] = in[i];
-        }
-    }
-
-    return j;
-}
-
-/* copy a possibly escaped single byte to out */
-static gsize
-escape_byte (guint8  byte,
-             guint8 *out,
-             gsize   outlen)
-{
-    gsize j = 0;
-
-    if (byte == CONTROL || byte == ESCAPE) {
-        out[j++] = ESCAPE;
-        byte ^= MASK;
-    }
-    out[j++] = byte;
-    return j;
-}
-
-static gsize
-hdlc_max_framed_size (gsize unframed_size)
-{
-    /* 1 header byte, (2 * input size) bytes, 2 crc bytes and 1 trailing byte */
-    return 4 + (2 * unframed_size);
-}
-
-static gsize
-hdlc_frame (const guint8 *in,
-            gsize         inlen,
-            guint8       *out,
-            gsize         outlen)
-{
-    guint16 crc;
-    gsize j = 0;
-
-    out[j++] = CONTROL;
-    j += escape (in, inlen, &out[j], outlen - j);
-    crc = qfu_utils_crc16 (in, inlen);
-    j += escape_byte (crc & 0xff, &out[j], outlen - j);
-    j += escape_byte (crc >> 8 & 0xff, &out[j], outlen - j);
-    out[j++] = CONTROL;
-
-    return j;
-}
-
-static gsize
-hdlc_max_unframed_size (gsize framed_size)
-{
-    /* -1 header byte, -2 crc bytes and -1 trailing byte */
-    g_assert (framed_size > 3);
-    return framed_size - 3;
-}
-
 static gsize
 hdlc_unframe (const guint8 *in,
               gsize         inlen,
@@ -175,14 +84,14 @@ hdlc_unframe (const guint8 *in,
     gsize j, i = inlen;
 
     /* the first control char is optional */
-    if (*in == CONTROL) {
+    if (*in == QFU_HDLC_CONTROL) {
         in++;
         i--;
     }
-    if (in[i - 1] == CONTROL)
+    if (in[i - 1] == QFU_HDLC_CONTROL)
         i--;
 
-    j = unescape (in, i, out, outlen);
+    j = qfu_hdlc_unescape (in, i, out, outlen);
     if (j < 2) {
         g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
                      "unescaping failed: too few bytes as output: %" G_GSIZE_FORMAT, j);
@@ -191,7 +100,7 @@ hdlc_unframe (const guint8 *in,
     j -= 2; /* remove the crc */
 
     /* verify the crc */
-    crc = qfu_utils_crc16 (out, j);
+    crc = qfu_hdlc_crc16 (out, j);
     if (crc != (out[j] | out[j + 1] << 8)) {
         g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
                      "crc check failed: 0x%04x != 0x%04x\n", crc, out[j] | out[j + 1] << 8);
@@ -204,14 +113,19 @@ hdlc_unframe (const guint8 *in,
 /******************************************************************************/
 /* Send */
 
+/* Sends the request given in one or more segments in a single write, so
+ * that e.g. a header and a chunk from a mapped image don't need to be
+ * copied into the same buffer */
 static gboolean
-send_request (QfuQdlDevice  *self,
-              const guint8  *request,
-              gsize          request_size,
-              GCancellable  *cancellable,
-              GError       **error)
+send_request_iov (QfuQdlDevice        *self,
+                  const struct iovec  *iov,
+                  guint                n_iov,
+                  GCancellable        *cancellable,
+                  GError             **error)
 {
     gssize         wlen;
+    gsize          request_size = 0;
+    guint          i;
     fd_set         wr;
     gint           aux;
     struct timeval tv = {
@@ -240,23 +154,26 @@ send_request (QfuQdlDevice  *self,
         return FALSE;
     }
 
-    /* Debug output */
+    for (i = 0; i < n_iov; i++)
+        request_size += iov[i].iov_len;
+
+    /* Debug output, only of the first segment */
     if (qfu_log_get_verbose ()) {
         gchar    *printable;
-        gsize     printable_size = request_size;
-        gboolean  shorted = FALSE;
+        gsize     printable_size = iov[0].iov_len;
+        gboolean  shorted = (n_iov > 1);
 
         if (printable_size > MAX_PRINTABLE_SIZE) {
             printable_size = MAX_PRINTABLE_SIZE;
             shorted = TRUE;
         }
 
-        printable = qfu_utils_str_hex (request, printable_size, ':');
+        printable = qfu_utils_str_hex (iov[0].iov_base, printable_size, ':');
         g_debug ("[qfu-qdl-device] >> %s%s [%" G_GSIZE_FORMAT "]", printable, shorted ? "..." : "", request_size);
         g_free (printable);
     }
 
-    wlen = write (self->priv->fd, request, request_size);
+    wlen = writev (self->priv->fd, iov, n_iov);
     if (wlen < 0) {
         g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
                      "error writting: %s",
@@ -276,6 +193,21 @@ send_request (QfuQdlDevice  *self,
     return TRUE;
 }
 
+static gboolean
+send_request (QfuQdlDevice  *self,
+              const guint8  *request,
+              gsize          request_size,
+              GCancellable  *cancellable,
+              GError       **error)
+{
+    struct iovec iov = {
+        .iov_base = (gpointer) request,
+        .iov_len  = request_size,
+    };
+
+    return send_request_iov (self, &iov, 1, cancellable, error);
+}
+
 static gboolean
 send_framed_request (QfuQdlDevice  *self,
                      const guint8  *request,
@@ -302,12 +234,12 @@ send_framed_request (QfuQdlDevice  *self,
         g_free (printable);
     }
 
-    max_framed_size = hdlc_max_framed_size (request_size);
+    max_framed_size = qfu_hdlc_max_framed_size (request_size);
     if (G_UNLIKELY (max_framed_size > self->priv->secondary_buffer->len))
         g_byte_array_set_size (self->priv->secondary_buffer, max_framed_size);
 
     /* Pack into an HDLC frame */
-    framed_size = hdlc_frame (request, request_size, self->priv->secondary_buffer->data, self->priv->secondary_buffer->len);
+    framed_size = qfu_hdlc_frame (request, request_size, self->priv->secondary_buffer->data, self->priv->secondary_buffer->len);
     g_assert (framed_size > 0);
 
     return send_request (self, self->priv->secondary_buffer->data, framed_size, cancellable, error);
@@ -331,6 +263,19 @@ receive_response (QfuQdlDevice  *self,
     gssize         frame_size;
     gsize          max_unframed_size;
     gsize          unframed_size;
+    gsize          n_pending;
+
+    /* Bytes left over from a previous read go first; if they already hold a
+     * full frame there's no need to read anything */
+    n_pending = self->priv->pending->len;
+    if (n_pending > 0) {
+        memcpy (self->priv->buffer->data, self->priv->pending->data, n_pending);
+        g_byte_array_set_size (self->priv->pending, 0);
+        if (n_pending > 1 && memchr (self->priv->buffer->data + 1, QFU_HDLC_CONTROL, n_pending - 1)) {
+            rlen = (gssize) n_pending;
+            goto process;
+        }
+    }
 
     /* Use requested timeout */
     tv.tv_sec  = timeout_secs;
@@ -357,7 +302,7 @@ receive_response (QfuQdlDevice  *self,
     }
 
     /* Receive in the primary buffer */
-    rlen = read (self->priv->fd, self->priv->buffer->data, self->priv->buffer->len);
+    rlen = read (self->priv->fd, self->priv->buffer->data + n_pending, self->priv->buffer->len - n_pending);
     if (rlen < 0) {
         g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
                      "couldn't read response: %s",
@@ -370,6 +315,9 @@ receive_response (QfuQdlDevice  *self,
                      "couldn't read response: HUP detected");
         return -1;
     }
+    rlen += n_pending;
+
+process:
 
     /* Debug output */
     if (qfu_log_get_verbose ()) {
@@ -387,7 +335,7 @@ receive_response (QfuQdlDevice  *self,
         g_free (printable);
     }
 
-    end = memchr (self->priv->buffer->data + 1, CONTROL, rlen - 1);
+    end = memchr (self->priv->buffer->data + 1, QFU_HDLC_CONTROL, rlen - 1);
     if (!end) {
         g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
                      "HDLC trailing control character not found");
@@ -403,11 +351,13 @@ receive_response (QfuQdlDevice  *self,
         return -1;
     }
 
-    if (frame_size < rlen)
-        g_debug ("[qfu-qdl-device] received %" G_GSSIZE_FORMAT " trailing bytes after HDLC frame (ignored)",
+    if (frame_size < rlen) {
+        g_debug ("[qfu-qdl-device] received %" G_GSSIZE_FORMAT " trailing bytes after HDLC frame (kept)",
                  rlen - frame_size);
+        g_byte_array_append (self->priv->pending, self->priv->buffer->data + frame_size, rlen - frame_size);
+    }
 
-    max_unframed_size = hdlc_max_unframed_size (frame_size);
+    max_unframed_size = qfu_hdlc_max_unframed_size (frame_size);
     if (G_UNLIKELY (max_unframed_size > self->priv->secondary_buffer->len))
         g_byte_array_set_size (self->priv->secondary_buffer, max_unframed_size);
 
@@ -459,6 +409,10 @@ send_receive (QfuQdlDevice  *self,
         return FALSE;
     }
 
+    /* Only one response is expected to this request, so anything left over
+     * from previous ones is discarded */
+    g_byte_array_set_size (self->priv->pending, 0);
+
     if (request_framed)
         sent = send_framed_request (self, request, request_size, cancellable, error);
     else
@@ -479,14 +433,19 @@ send_receive (QfuQdlDevice  *self,
 gboolean
 qfu_qdl_device_ufopen (QfuQdlDevice  *self,
                        QfuImage      *image,
+                       guint8         window_size,
+                       guint8        *negotiated_window_size,
                        GCancellable  *cancellable,
                        GError       **error)
 {
     gssize  reqlen;
     gssize  rsplen;
     guint8 *rsp = NULL;
+    guint8  rsp_window_size = 0;
 
-    reqlen = qfu_qdl_request_ufopen_build (self->priv->buffer->data, self->priv->buffer->len, image, cancellable, error);
+    g_assert (window_size > 0);
+
+    reqlen = qfu_qdl_request_ufopen_build (self->priv->buffer->data, self->priv->buffer->len, image, window_size, cancellable, error);
     if (reqlen < 0)
         return FALSE;
 
@@ -496,7 +455,13 @@ qfu_qdl_device_ufopen (QfuQdlDevice  *self,
 
     switch (rsp[0]) {
     case QFU_QDL_CMD_OPEN_UNFRAMED_RSP:
-        return qfu_qdl_response_ufopen_parse (rsp, rsplen, error);
+        if (!qfu_qdl_response_ufopen_parse (rsp, rsplen, &rsp_window_size, error))
+            return FALSE;
+        /* Never go over what the device reports, and if it doesn't report
+         * anything, don't send more than one chunk at a time */
+        if (negotiated_window_size)
+            *negotiated_window_size = (rsp_window_size > 0 ? MIN (window_size, rsp_window_size) : 1);
+        return TRUE;
     case QFU_QDL_CMD_ERROR:
         return qfu_qdl_response_error_parse (rsp, rsplen, error);
     default:
@@ -510,38 +475,58 @@ qfu_qdl_device_ufopen (QfuQdlDevice  *self,
 /******************************************************************************/
 
 gboolean
-qfu_qdl_device_ufwrite (QfuQdlDevice  *self,
-                        QfuImage      *image,
-                        guint16        sequence,
-                        GCancellable  *cancellable,
-                        GError       **error)
+qfu_qdl_device_ufwrite_send (QfuQdlDevice  *self,
+                             QfuImage      *image,
+                             guint16        sequence,
+                             GCancellable  *cancellable,
+                             GError       **error)
 {
-    gssize   reqlen;
-    gssize   rsplen;
-    guint8  *rsp = NULL;
-    guint16  ack_sequence = 0;
+    gssize        reqlen;
+    const guint8 *chunk;
+    gsize         chunk_size = 0;
+
+    if (self->priv->fd < 0) {
+        g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED, "device is closed");
+        return FALSE;
+    }
+
+    /* If the image is mapped, send the chunk straight from the mapping after
+     * the header, otherwise read it into the request buffer */
+    chunk = qfu_image_peek_data_chunk (image, sequence, &chunk_size);
+    if (chunk) {
+        struct iovec iov[2];
+
+        iov[0].iov_base = self->priv->buffer->data;
+        iov[0].iov_len  = qfu_qdl_request_ufwrite_header_build (self->priv->buffer->data, self->priv->buffer->len, sequence, chunk_size);
+        iov[1].iov_base = (gpointer) chunk;
+        iov[1].iov_len  = chunk_size;
+        return send_request_iov (self, iov, G_N_ELEMENTS (iov), cancellable, error);
+    }
 
     reqlen = qfu_qdl_request_ufwrite_build (self->priv->buffer->data, self->priv->buffer->len, image, sequence, cancellable, error);
     if (reqlen < 0)
         return FALSE;
+    return send_request (self, self->priv->buffer->data, reqlen, cancellable, error);
+}
+
+gboolean
+qfu_qdl_device_ufwrite_wait_ack (QfuQdlDevice  *self,
+                                 guint16       *ack_sequence,
+                                 GCancellable  *cancellable,
+                                 GError       **error)
+{
+    gssize  rsplen;
+    guint8 *rsp = NULL;
 
     /* NOTE: the last chunk will require a long timeout, so just define the
      * same one for all chunks */
-    rsplen = send_receive (self, self->priv->buffer->data, reqlen, FALSE, 120, &rsp, cancellable, error);
+    rsplen = receive_response (self, 120, &rsp, cancellable, error);
     if (rsplen < 0)
         return FALSE;
 
     switch (rsp[0]) {
     case QFU_QDL_CMD_WRITE_UNFRAMED_RSP:
-        if (!qfu_qdl_response_ufwrite_parse (rsp, rsplen, &ack_sequence, error))
-            return FALSE;
-        if (ack_sequence != sequence) {
-            g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
-                         "received ack for chunk #%" G_GUINT16_FORMAT " instead of chunk #%" G_GUINT16_FORMAT,
-                         ack_sequence, sequence);
-            return FALSE;
-        }
-        return TRUE;
+        return qfu_qdl_response_ufwrite_parse (rsp, rsplen, ack_sequence, error);
     case QFU_QDL_CMD_ERROR:
         return qfu_qdl_response_error_parse (rsp, rsplen, error);
     default:
@@ -552,6 +537,31 @@ qfu_qdl_device_ufwrite (QfuQdlDevice  *self,
     }
 }
 
+gboolean
+qfu_qdl_device_ufwrite (QfuQdlDevice  *self,
+                        QfuImage      *image,
+                        guint16        sequence,
+                        GCancellable  *cancellable,
+                        GError       **error)
+{
+    guint16 ack_sequence = 0;
+
+    /* Only the ack of this chunk is expected */
+    g_byte_array_set_size (self->priv->pending, 0);
+
+    if (!qfu_qdl_device_ufwrite_send (self, image, sequence, cancellable, error) ||
+        !qfu_qdl_device_ufwrite_wait_ack (self, &ack_sequence, cancellable, error))
+        return FALSE;
+
+    if (ack_sequence != sequence) {
+        g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                     "received ack for chunk #%" G_GUINT16_FORMAT " instead of chunk #%" G_GUINT16_FORMAT,
+                     ack_sequence, sequence);
+        return FALSE;
+    }
+    return TRUE;
+}
+
 /******************************************************************************/
 
 gboolean
@@ -795,6 +805,37 @@ qfu_qdl_device_new (GFile         *file,
                                            NULL));
 }
 
+QfuQdlDevice *
+qfu_qdl_device_new_finish (GAsyncResult  *res,
+                           GError       **error)
+{
+    GObject *source;
+    GObject *self;
+
+    source = g_async_result_get_source_object (res);
+    self = g_async_initable_new_finish (G_ASYNC_INITABLE (source), res, error);
+    g_object_unref (source);
+
+    return (self ? QFU_QDL_DEVICE (self) : NULL);
+}
+
+void
+qfu_qdl_device_new_async (GFile               *file,
+                          GCancellable        *cancellable,
+                          GAsyncReadyCallback  callback,
+                          gpointer             user_data)
+{
+    g_return_if_fail (G_IS_FILE (file));
+
+    g_async_initable_new_async (QFU_TYPE_QDL_DEVICE,
+                                G_PRIORITY_DEFAULT,
+                                cancellable,
+                                callback,
+                                user_data,
+                                "file", file,
+                                NULL);
+}
+
 
 static void
 qfu_qdl_device_init (QfuQdlDevice *self)
@@ -807,6 +848,7 @@ qfu_qdl_device_init (QfuQdlDevice *self)
     /* Shorter secondary buffer for framing/unframing */
     self->priv->secondary_buffer = g_byte_array_new ();
     g_byte_array_set_size (self->priv->secondary_buffer, SECONDARY_BUFFER_DEFAULT_SIZE);
+    self->priv->pending = g_byte_array_new ();
 }
 
 static void
@@ -856,6 +898,7 @@ dispose (GObject *object)
     }
     g_clear_pointer (&self->priv->buffer,           g_byte_array_unref);
     g_clear_pointer (&self->priv->secondary_buffer, g_byte_array_unref);
+    g_clear_pointer (&self->priv->pending, g_byte_array_unref);
     g_clear_object  (&self->priv->file);
 
     G_OBJECT_CLASS (qfu_qdl_device_parent_class)->dispose (object);
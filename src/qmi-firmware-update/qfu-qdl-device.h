@@ -54,11 +54,19 @@ G_DEFINE_AUTOPTR_CLEANUP_FUNC (QfuQdlDevice, g_object_unref);
 QfuQdlDevice *qfu_qdl_device_new       (GFile         *file,
                                         GCancellable  *cancellable,
                                         GError       **error);
+void          qfu_qdl_device_new_async (GFile               *file,
+                                        GCancellable        *cancellable,
+                                        GAsyncReadyCallback  callback,
+                                        gpointer             user_data);
+QfuQdlDevice *qfu_qdl_device_new_finish (GAsyncResult  *res,
+                                         GError       **error);
 gboolean      qfu_qdl_device_hello     (QfuQdlDevice  *self,
                                         GCancellable  *cancellable,
                                         GError       **error);
 gboolean      qfu_qdl_device_ufopen    (QfuQdlDevice  *self,
                                         QfuImage      *image,
+                                        guint8         window_size,
+                                        guint8        *negotiated_window_size,
                                         GCancellable  *cancellable,
                                         GError       **error);
 gboolean      qfu_qdl_device_ufwrite   (QfuQdlDevice  *self,
@@ -66,6 +74,17 @@ gboolean      qfu_qdl_device_ufwrite   (QfuQdlDevice  *self,
                                         guint16        sequence,
                                         GCancellable  *cancellable,
                                         GError       **error);
+
+/* Windowed ufwrite: several chunks sent before waiting for their acks */
+gboolean      qfu_qdl_device_ufwrite_send     (QfuQdlDevice  *self,
+                                               QfuImage      *image,
+                                               guint16        sequence,
+                                               GCancellable  *cancellable,
+                                               GError       **error);
+gboolean      qfu_qdl_device_ufwrite_wait_ack (QfuQdlDevice  *self,
+                                               guint16       *ack_sequence,
+                                               GCancellable  *cancellable,
+                                               GError       **error);
 gboolean      qfu_qdl_device_ufclose   (QfuQdlDevice  *self,
                                         GCancellable  *cancellable,
                                         GError       **error);
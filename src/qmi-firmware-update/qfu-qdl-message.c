@@ -288,6 +288,7 @@ gssize
 qfu_qdl_request_ufopen_build (guint8        *buffer,
                               gsize          buffer_len,
                               QfuImage      *image,
+                              guint8         window_size,
                               GCancellable  *cancellable,
                               GError       **error)
 {
@@ -300,7 +301,7 @@ qfu_qdl_request_ufopen_build (guint8        *buffer,
     memset (req, 0, sizeof (QdlUfopenReq));
     req->cmd        = QFU_QDL_CMD_OPEN_UNFRAMED_REQ;
     req->type       = (guint8) qfu_image_get_image_type (image);
-    req->windowsize = 1; /* snooped */
+    req->windowsize = window_size; /* 1 snooped */
     req->length     = GUINT32_TO_LE (qfu_image_get_header_size (image) + qfu_image_get_data_size (image));
     req->chunksize  = GUINT32_TO_LE (qfu_image_get_data_size (image));
 
@@ -332,6 +333,7 @@ G_STATIC_ASSERT (sizeof (QdlUfopenRsp) <= QFU_QDL_MESSAGE_MAX_HEADER_SIZE);
 gboolean
 qfu_qdl_response_ufopen_parse (const guint8  *buffer,
                                gsize          buffer_len,
+                               guint8        *window_size,
                                GError       **error)
 {
     QdlUfopenRsp *rsp;
@@ -351,7 +353,8 @@ qfu_qdl_response_ufopen_parse (const guint8  *buffer,
     g_debug ("[qfu,qdl-message]   window size: %u", rsp->windowsize);
     g_debug ("[qfu,qdl-message]   chunk size:  %" G_GUINT32_FORMAT, GUINT32_FROM_LE (rsp->chunksize));
 
-    /* For now, ignore all fields but build a GError based on status */
+    /* For now, ignore all fields but the window size, and build a GError
+     * based on status */
 
     /* Return error if status != 0 */
     if (rsp->status != 0) {
@@ -361,6 +364,9 @@ qfu_qdl_response_ufopen_parse (const guint8  *buffer,
         return FALSE;
     }
 
+    if (window_size)
+        *window_size = rsp->windowsize;
+
     return TRUE;
 }
 
@@ -379,6 +385,38 @@ struct _QdlUfwriteReq {
 
 G_STATIC_ASSERT (sizeof (QdlUfwriteReq) <= QFU_QDL_MESSAGE_MAX_HEADER_SIZE);
 
+static void
+ufwrite_header_build (guint8  *buffer,
+                      guint16  sequence,
+                      gsize    chunk_size)
+{
+    QdlUfwriteReq *req;
+
+    req = (QdlUfwriteReq *) buffer;
+    memset (req, 0, sizeof (QdlUfwriteReq));
+    req->cmd       = QFU_QDL_CMD_WRITE_UNFRAMED_REQ;
+    req->sequence  = GUINT16_TO_LE (sequence);
+    req->reserved  = 0;
+    req->chunksize = GUINT32_TO_LE ((guint32) chunk_size);
+    req->crc       = GUINT16_TO_LE (qfu_utils_crc16 (buffer, sizeof (QdlUfwriteReq) - 2));
+
+    g_debug ("[qfu,qdl-message] sent %s:", qfu_qdl_cmd_get_string ((QfuQdlCmd) req->cmd));
+    g_debug ("[qfu,qdl-message]   sequence:   %" G_GUINT16_FORMAT, GUINT16_FROM_LE (req->sequence));
+    g_debug ("[qfu,qdl-message]   chunk size: %" G_GUINT32_FORMAT, GUINT32_FROM_LE (req->chunksize));
+}
+
+gsize
+qfu_qdl_request_ufwrite_header_build (guint8  *buffer,
+                                      gsize    buffer_len,
+                                      guint16  sequence,
+                                      gsize    chunk_size)
+{
+    g_assert (buffer_len >= sizeof (QdlUfwriteReq));
+
+    ufwrite_header_build (buffer, sequence, chunk_size);
+    return sizeof (QdlUfwriteReq);
+}
+
 gssize
 qfu_qdl_request_ufwrite_build (guint8        *buffer,
                                gsize          buffer_len,
@@ -387,8 +425,7 @@ qfu_qdl_request_ufwrite_build (guint8        *buffer,
                                GCancellable  *cancellable,
                                GError       **error)
 {
-    QdlUfwriteReq *req;
-    gssize         n_read;
+    gssize n_read;
 
     g_assert (buffer_len >= sizeof (QdlUfwriteReq));
 
@@ -400,19 +437,9 @@ qfu_qdl_request_ufwrite_build (guint8        *buffer,
     }
 
     /* Create request after appending, so that we have correct chunksize */
-    req = (QdlUfwriteReq *) buffer;
-    memset (req, 0, sizeof (QdlUfwriteReq));
-    req->cmd       = QFU_QDL_CMD_WRITE_UNFRAMED_REQ;
-    req->sequence  = GUINT16_TO_LE (sequence);
-    req->reserved  = 0;
-    req->chunksize = GUINT32_TO_LE ((guint32) n_read);
-    req->crc       = GUINT16_TO_LE (qfu_utils_crc16 (buffer, sizeof (QdlUfwriteReq) - 2));
-
-    g_debug ("[qfu,qdl-message] sent %s:", qfu_qdl_cmd_get_string ((QfuQdlCmd) req->cmd));
-    g_debug ("[qfu,qdl-message]   sequence:   %" G_GUINT16_FORMAT, GUINT16_FROM_LE (req->sequence));
-    g_debug ("[qfu,qdl-message]   chunk size: %" G_GUINT32_FORMAT, GUINT32_FROM_LE (req->chunksize));
+    ufwrite_header_build (buffer, sequence, (gsize) n_read);
 
-    return (sizeof (QdlUfopenReq) + n_read);
+    return (sizeof (QdlUfwriteReq) + n_read);
 }
 
 /* The response is HDLC framed, so the crc is part of the framing */
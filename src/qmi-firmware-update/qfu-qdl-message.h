@@ -65,6 +65,7 @@ gsize  qfu_qdl_request_hello_build   (guint8        *buffer,
 gssize qfu_qdl_request_ufopen_build  (guint8        *buffer,
                                       gsize          buffer_len,
                                       QfuImage      *image,
+                                      guint8         window_size,
                                       GCancellable  *cancellable,
                                       GError       **error);
 gssize qfu_qdl_request_ufwrite_build (guint8        *buffer,
@@ -73,6 +74,10 @@ gssize qfu_qdl_request_ufwrite_build (guint8        *buffer,
                                       guint16        sequence,
                                       GCancellable  *cancellable,
                                       GError       **error);
+gsize  qfu_qdl_request_ufwrite_header_build (guint8  *buffer,
+                                             gsize    buffer_len,
+                                             guint16  sequence,
+                                             gsize    chunk_size);
 gsize  qfu_qdl_request_ufclose_build (guint8        *buffer,
                                       gsize          buffer_len);
 gsize  qfu_qdl_request_reset_build   (guint8        *buffer,
@@ -88,6 +93,7 @@ gboolean qfu_qdl_response_error_parse    (const guint8  *buffer,
                                           GError       **error);
 gboolean qfu_qdl_response_ufopen_parse   (const guint8  *buffer,
                                           gsize          buffer_len,
+                                          guint8        *window_size,
                                           GError       **error);
 gboolean qfu_qdl_response_ufwrite_parse  (const guint8  *buffer,
                                           gsize          buffer_len,
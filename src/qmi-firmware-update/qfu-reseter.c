@@ -43,6 +43,19 @@ struct _QfuReseterPrivate {
 
 #define MAX_RETRIES 2
 
+/* Strategies are run at the same time, the first one requesting the reset
+ * successfully wins and the others are cancelled */
+typedef enum {
+    RESET_STRATEGY_QMI,
+    RESET_STRATEGY_AT,
+    RESET_STRATEGY_LAST
+} ResetStrategy;
+
+static const gchar *reset_strategy_str[RESET_STRATEGY_LAST] = {
+    [RESET_STRATEGY_QMI] = "QMI",
+    [RESET_STRATEGY_AT]  = "AT",
+};
+
 typedef struct {
     /* Files to use */
     GList      *ttys;
@@ -51,16 +64,33 @@ typedef struct {
     QmiDevice    *qmi_device;
     QmiClientDms *qmi_client;
     gboolean      ignore_release_cid;
-    /* List of AT devices */
-    GList *at_devices;
-    GList *current;
-    /* Retries */
-    guint retries;
+    /* Strategies, each one with its own cancellable, chained to the one of
+     * the operation */
+    GCancellable *cancellable;
+    gulong        cancellable_id;
+    GCancellable *strategy_cancellables[RESET_STRATEGY_LAST];
+    GError       *strategy_errors[RESET_STRATEGY_LAST];
+    guint         n_pending;
+    gboolean      returned;
+    GTimer       *timer;
 } RunContext;
 
 static void
 run_context_free (RunContext *ctx)
 {
+    guint i;
+
+    g_assert (!ctx->n_pending);
+
+    if (ctx->cancellable) {
+        g_cancellable_disconnect (ctx->cancellable, ctx->cancellable_id);
+        g_object_unref (ctx->cancellable);
+    }
+    for (i = 0; i < RESET_STRATEGY_LAST; i++) {
+        g_clear_object (&ctx->strategy_cancellables[i]);
+        g_clear_error (&ctx->strategy_errors[i]);
+    }
+    g_timer_destroy (ctx->timer);
     if (ctx->cdc_wdm)
         g_object_unref (ctx->cdc_wdm);
     if (ctx->qmi_client) {
@@ -78,7 +108,6 @@ run_context_free (RunContext *ctx)
         g_object_unref (ctx->qmi_device);
     }
     g_list_free_full (ctx->ttys, g_object_unref);
-    g_list_free_full (ctx->at_devices, g_object_unref);
     g_slice_free (RunContext, ctx);
 }
 
@@ -90,38 +119,83 @@ qfu_reseter_run_finish (QfuReseter    *self,
     return g_task_propagate_boolean (G_TASK (res), error);
 }
 
-static void run_context_step_at (GTask *task);
+static void
+run_context_cancelled (GCancellable *cancellable,
+                       RunContext   *ctx)
+{
+    guint i;
 
-static gboolean
-run_context_step_at_cb (GTask *task)
+    for (i = 0; i < RESET_STRATEGY_LAST; i++)
+        g_cancellable_cancel (ctx->strategy_cancellables[i]);
+}
+
+static void
+run_context_strategy_start (GTask         *task,
+                            ResetStrategy  strategy)
 {
-    run_context_step_at (task);
-    return FALSE;
+    RunContext *ctx;
+
+    ctx = (RunContext *) g_task_get_task_data (task);
+
+    g_debug ("[qfu-reseter] starting %s reset strategy...", reset_strategy_str[strategy]);
+
+    /* Each running strategy holds its own task reference */
+    g_object_ref (task);
+    ctx->n_pending++;
 }
 
+/* Takes ownership of @error, and of the task reference of the strategy */
 static void
-run_context_step_at_next (GTask *task)
+run_context_strategy_complete (GTask         *task,
+                               ResetStrategy  strategy,
+                               GError        *error)
 {
     RunContext *ctx;
+    guint       i;
 
     ctx = (RunContext *) g_task_get_task_data (task);
-    ctx->current = g_list_next (ctx->current);
 
-    if (!ctx->current) {
-        if (!ctx->retries) {
-            g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_FAILED,
-                                     "couldn't run reset operation");
-            g_object_unref (task);
-            return;
-        }
+    g_assert (ctx->n_pending > 0);
+    ctx->n_pending--;
+
+    if (!error) {
+        g_debug ("[qfu-reseter] %s reset strategy succeeded after %.2lfs",
+                 reset_strategy_str[strategy], g_timer_elapsed (ctx->timer, NULL));
 
-        /* Launch retry with the first device */
-        ctx->retries--;
-        ctx->current = ctx->at_devices;
+        /* The device will go away, so don't try to release the CID */
+        ctx->ignore_release_cid = TRUE;
+
+        if (!ctx->returned) {
+            g_debug ("[qfu-reseter] reset requested with the %s strategy", reset_strategy_str[strategy]);
+            for (i = 0; i < RESET_STRATEGY_LAST; i++) {
+                if (i != strategy)
+                    g_cancellable_cancel (ctx->strategy_cancellables[i]);
+            }
+            ctx->returned = TRUE;
+            g_task_return_boolean (task, TRUE);
+        }
+    } else {
+        g_debug ("[qfu-reseter] %s reset strategy failed after %.2lfs: %s",
+                 reset_strategy_str[strategy], g_timer_elapsed (ctx->timer, NULL), error->message);
+        ctx->strategy_errors[strategy] = error;
+
+        if (!ctx->n_pending && !ctx->returned) {
+            GString *str;
+
+            ctx->returned = TRUE;
+            if (!g_task_return_error_if_cancelled (task)) {
+                str = g_string_new ("couldn't run reset operation");
+                for (i = 0; i < RESET_STRATEGY_LAST; i++) {
+                    if (ctx->strategy_errors[i])
+                        g_string_append_printf (str, "; %s: %s", reset_strategy_str[i], ctx->strategy_errors[i]->message);
+                }
+                g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_FAILED, "%s", str->str);
+                g_string_free (str, TRUE);
+            }
+        }
     }
 
-    /* Schedule next step in an idle */
-    g_idle_add ((GSourceFunc) run_context_step_at_cb, task);
+    g_object_unref (task);
 }
 
 static gint
@@ -131,83 +205,114 @@ device_sort_by_name_reversed (QfuAtDevice *a, QfuAtDevice *b)
 }
 
 static void
-run_context_step_at (GTask *task)
+at_strategy_thread (GTask        *thread_task,
+                    gpointer      unused,
+                    GList        *ttys,
+                    GCancellable *cancellable)
 {
-    RunContext  *ctx;
+    GList       *at_devices = NULL;
+    GList       *l;
     QfuAtDevice *at_device;
     GError      *error = NULL;
+    guint        i;
 
-    ctx = (RunContext *) g_task_get_task_data (task);
-
-    /* If we get to AT reset after trying QMI, and we didn't find any port to
-     * use, return error */
-    if (!ctx->ttys) {
-        g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
-                                 "No devices found to run reset operation");
-        g_object_unref (task);
-        return;
+    for (l = ttys; l; l = g_list_next (l)) {
+        at_device = qfu_at_device_new (G_FILE (l->data), cancellable, &error);
+        if (!at_device) {
+            g_task_return_error (thread_task, error);
+            goto out;
+        }
+        at_devices = g_list_append (at_devices, at_device);
     }
 
-    /* Initialize AT devices the first time we get here */
-    if (!ctx->at_devices) {
-        GList *l;
+    /* Sort by filename reversed; usually the TTY with biggest number is a
+     * good AT port */
+    at_devices = g_list_sort (at_devices, (GCompareFunc) device_sort_by_name_reversed);
+
+    /* The AT operations block, which is why the whole strategy runs in its
+     * own thread */
+    for (i = 0; i <= MAX_RETRIES; i++) {
+        for (l = at_devices; l; l = g_list_next (l)) {
+            at_device = QFU_AT_DEVICE (l->data);
+            if (qfu_at_device_boothold (at_device, cancellable, &error)) {
+                g_debug ("[qfu-reseter] successfully run 'at boothold' operation");
+                g_task_return_boolean (thread_task, TRUE);
+                goto out;
+            }
 
-        for (l = ctx->ttys; l; l = g_list_next (l)) {
-            at_device = qfu_at_device_new (G_FILE (l->data), g_task_get_cancellable (task), &error);
-            if (!at_device) {
-                g_task_return_error (task, error);
-                g_object_unref (task);
-                return;
+            g_debug ("[qfu-reseter] error: %s", error->message);
+            if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+                g_task_return_error (thread_task, error);
+                goto out;
             }
-            ctx->at_devices = g_list_append (ctx->at_devices, at_device);
+            g_clear_error (&error);
         }
-
-        /* Sort by filename reversed; usually the TTY with biggest number is a
-         * good AT port */
-        ctx->at_devices = g_list_sort (ctx->at_devices, (GCompareFunc) device_sort_by_name_reversed);
-        /* Select first TTY to start */
-        ctx->current = ctx->at_devices;
-    } else
-        g_assert (ctx->current);
-
-    at_device = QFU_AT_DEVICE (ctx->current->data);
-    if (!qfu_at_device_boothold (at_device, g_task_get_cancellable (task), &error)) {
-        g_debug ("[qfu-reseter] error: %s", error->message);
-        g_error_free (error);
-        run_context_step_at_next (task);
-        return;
     }
 
-    /* Success! */
-    g_debug ("[qfu-reseter] successfully run 'at boothold' operation");
-    ctx->ignore_release_cid = TRUE;
-    g_task_return_boolean (task, TRUE);
-    g_object_unref (task);
+    g_task_return_new_error (thread_task, G_IO_ERROR, G_IO_ERROR_FAILED,
+                             "couldn't run 'at boothold' operation");
+
+out:
+    g_list_free_full (at_devices, g_object_unref);
 }
 
 static void
-power_cycle_ready (QmiClientDms *qmi_client,
+at_strategy_ready (QfuReseter   *self,
                    GAsyncResult *res,
                    GTask        *task)
 {
-    GError     *error = NULL;
+    GError *error = NULL;
+
+    g_task_propagate_boolean (G_TASK (res), &error);
+    run_context_strategy_complete (task, RESET_STRATEGY_AT, error);
+}
+
+static void
+ttys_free (GList *ttys)
+{
+    g_list_free_full (ttys, g_object_unref);
+}
+
+static void
+run_context_strategy_at (GTask *task)
+{
     RunContext *ctx;
+    GTask      *thread_task;
 
     ctx = (RunContext *) g_task_get_task_data (task);
 
+    g_assert (ctx->ttys);
+
+    run_context_strategy_start (task, RESET_STRATEGY_AT);
+
+    /* The thread gets its own copy of the list, so that it doesn't share the
+     * run context */
+    thread_task = g_task_new (g_task_get_source_object (task),
+                              ctx->strategy_cancellables[RESET_STRATEGY_AT],
+                              (GAsyncReadyCallback) at_strategy_ready,
+                              task);
+    g_task_set_task_data (thread_task,
+                          g_list_copy_deep (ctx->ttys, (GCopyFunc) g_object_ref, NULL),
+                          (GDestroyNotify) ttys_free);
+    g_task_run_in_thread (thread_task, (GTaskThreadFunc) at_strategy_thread);
+    g_object_unref (thread_task);
+}
+
+static void
+power_cycle_ready (QmiClientDms *qmi_client,
+                   GAsyncResult *res,
+                   GTask        *task)
+{
+    GError *error = NULL;
+
     if (!qfu_utils_power_cycle_finish (qmi_client, res, &error)) {
-        g_debug ("[qfu-reseter] error: couldn't power cycle: %s", error->message);
-        g_error_free (error);
-        g_debug ("[qfu-reseter] skipping QMI-based boothold");
-        run_context_step_at (task);
+        g_prefix_error (&error, "couldn't power cycle: ");
+        run_context_strategy_complete (task, RESET_STRATEGY_QMI, error);
         return;
     }
 
     g_debug ("[qfu-reseter] reset requested successfully...");
-
-    ctx->ignore_release_cid = TRUE;
-    g_task_return_boolean (task, TRUE);
-    g_object_unref (task);
+    run_context_strategy_complete (task, RESET_STRATEGY_QMI, NULL);
 }
 
 static void
@@ -223,12 +328,10 @@ set_boot_image_download_mode_ready (QmiClientDms *client,
 
     output = qmi_client_dms_set_boot_image_download_mode_finish (client, res, &error);
     if (!output || !qmi_message_dms_set_boot_image_download_mode_output_get_result (output, &error)) {
-        g_debug ("[qfu-reseter] error: couldn't run 'set boot image download mode' operation: %s", error->message);
-        g_error_free (error);
+        g_prefix_error (&error, "couldn't run 'set boot image download mode' operation: ");
         if (output)
             qmi_message_dms_set_boot_image_download_mode_output_unref (output);
-        g_debug ("[qfu-reseter] skipping QMI-based boothold");
-        run_context_step_at (task);
+        run_context_strategy_complete (task, RESET_STRATEGY_QMI, error);
         return;
     }
 
@@ -236,8 +339,8 @@ set_boot_image_download_mode_ready (QmiClientDms *client,
 
     g_debug ("[qfu-reseter] successfully run 'set boot image download mode' operation");
 
-    qfu_utils_power_cycle (ctx->qmi_client,
-                           g_task_get_cancellable (task),
+    qfu_utils_power_cycle (client,
+                           ctx->strategy_cancellables[RESET_STRATEGY_QMI],
                            (GAsyncReadyCallback) power_cycle_ready,
                            task);
 }
@@ -260,7 +363,7 @@ run_context_step_qmi_boot_image_download_mode (GTask *task)
     qmi_client_dms_set_boot_image_download_mode (self->priv->qmi_client ? self->priv->qmi_client : ctx->qmi_client,
                                                  input,
                                                  10,
-                                                 g_task_get_cancellable (task),
+                                                 ctx->strategy_cancellables[RESET_STRATEGY_QMI],
                                                  (GAsyncReadyCallback) set_boot_image_download_mode_ready,
                                                  task);
     qmi_message_dms_set_boot_image_download_mode_input_unref (input);
@@ -273,16 +376,17 @@ set_firmware_id_ready (QmiClientDms *client,
 {
     QmiMessageDmsSetFirmwareIdOutput *output;
     GError                           *error = NULL;
-    RunContext                       *ctx;
-
-    ctx = (RunContext *) g_task_get_task_data (task);
 
     output = qmi_client_dms_set_firmware_id_finish (client, res, &error);
     if (!output || !qmi_message_dms_set_firmware_id_output_get_result (output, &error)) {
         g_debug ("[qfu-reseter] error: couldn't run 'set firmware id' operation: %s", error->message);
-        g_error_free (error);
         if (output)
             qmi_message_dms_set_firmware_id_output_unref (output);
+        if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+            run_context_strategy_complete (task, RESET_STRATEGY_QMI, error);
+            return;
+        }
+        g_error_free (error);
         g_debug ("[qfu-reseter] trying boot image download mode...");
         run_context_step_qmi_boot_image_download_mode (task);
         return;
@@ -291,9 +395,7 @@ set_firmware_id_ready (QmiClientDms *client,
     qmi_message_dms_set_firmware_id_output_unref (output);
 
     g_debug ("[qfu-reseter] successfully run 'set firmware id' operation");
-    ctx->ignore_release_cid = TRUE;
-    g_task_return_boolean (task, TRUE);
-    g_object_unref (task);
+    run_context_strategy_complete (task, RESET_STRATEGY_QMI, NULL);
 }
 
 static void
@@ -311,7 +413,7 @@ run_context_step_qmi_firmware_id (GTask *task)
     qmi_client_dms_set_firmware_id (self->priv->qmi_client ? self->priv->qmi_client : ctx->qmi_client,
                                     NULL,
                                     10,
-                                    g_task_get_cancellable (task),
+                                    ctx->strategy_cancellables[RESET_STRATEGY_QMI],
                                     (GAsyncReadyCallback) set_firmware_id_ready,
                                     task);
 }
@@ -331,17 +433,42 @@ new_client_dms_ready (gpointer      unused,
                                           &ctx->qmi_client,
                                           NULL, NULL, NULL, NULL, NULL, NULL,
                                           &error)) {
-        /* Jump to AT-based boothold */
-        g_debug ("[qfu-reseter] error: couldn't allocate QMI client: %s", error->message);
-        g_error_free (error);
-        g_debug ("[qfu-reseter] skipping QMI-based boothold");
-        run_context_step_at (task);
+        g_prefix_error (&error, "couldn't allocate QMI client: ");
+        run_context_strategy_complete (task, RESET_STRATEGY_QMI, error);
         return;
     }
 
     run_context_step_qmi_firmware_id (task);
 }
 
+static void
+run_context_strategy_qmi (GTask *task)
+{
+    RunContext *ctx;
+    QfuReseter *self;
+
+    ctx = (RunContext *) g_task_get_task_data (task);
+    self = g_task_get_source_object (task);
+
+    run_context_strategy_start (task, RESET_STRATEGY_QMI);
+
+    /* If we already got a QMI client as input, try QMI directly */
+    if (self->priv->qmi_client) {
+        run_context_step_qmi_firmware_id (task);
+        return;
+    }
+
+    /* Otherwise, try to allocate a QMI client */
+    g_assert (ctx->cdc_wdm);
+    qfu_utils_new_client_dms (ctx->cdc_wdm,
+                              3,
+                              self->priv->device_open_flags,
+                              FALSE,
+                              ctx->strategy_cancellables[RESET_STRATEGY_QMI],
+                              (GAsyncReadyCallback) new_client_dms_ready,
+                              task);
+}
+
 void
 qfu_reseter_run (QfuReseter          *self,
                  GCancellable        *cancellable,
@@ -350,9 +477,10 @@ qfu_reseter_run (QfuReseter          *self,
 {
     RunContext *ctx;
     GTask      *task;
+    guint       i;
 
     ctx = g_slice_new0 (RunContext);
-    ctx->retries = MAX_RETRIES;
+    ctx->timer = g_timer_new ();
 
     task = g_task_new (self, cancellable, callback, user_data);
     g_task_set_task_data (task, ctx, (GDestroyNotify) run_context_free);
@@ -369,27 +497,25 @@ qfu_reseter_run (QfuReseter          *self,
         return;
     }
 
-    /* If no cdc-wdm file available, try AT directly */
-    if (!ctx->cdc_wdm && !self->priv->qmi_client) {
-        run_context_step_at (task);
-        return;
+    for (i = 0; i < RESET_STRATEGY_LAST; i++)
+        ctx->strategy_cancellables[i] = g_cancellable_new ();
+    if (cancellable) {
+        ctx->cancellable = g_object_ref (cancellable);
+        ctx->cancellable_id = g_cancellable_connect (cancellable,
+                                                     (GCallback) run_context_cancelled,
+                                                     ctx,
+                                                     NULL);
     }
 
-    /* If we already got a QMI client as input, try QMI directly */
-    if (self->priv->qmi_client) {
-        run_context_step_qmi_firmware_id (task);
-        return;
-    }
+    /* QMI-based reset if there is a QMI port */
+    if (ctx->cdc_wdm || self->priv->qmi_client)
+        run_context_strategy_qmi (task);
 
-    /* Otherwise, try to allocate a QMI client */
-    g_assert (ctx->cdc_wdm);
-    qfu_utils_new_client_dms (ctx->cdc_wdm,
-                              3,
-                              self->priv->device_open_flags,
-                              FALSE,
-                              cancellable,
-                              (GAsyncReadyCallback) new_client_dms_ready,
-                              task);
+    /* And at the same time, AT-based reset over all TTYs */
+    if (ctx->ttys)
+        run_context_strategy_at (task);
+
+    g_object_unref (task);
 }
 
 /******************************************************************************/
@@ -39,8 +39,12 @@
 
 static void initable_iface_init (GInitableIface *iface);
 
+/* The default GAsyncInitable implementation runs the GInitable one in a
+ * thread, so that the sahara/firehose initialization doesn't block the
+ * main loop */
 G_DEFINE_TYPE_EXTENDED (QfuSaharaDevice, qfu_sahara_device, G_TYPE_OBJECT, 0,
-                        G_IMPLEMENT_INTERFACE (G_TYPE_INITABLE, initable_iface_init))
+                        G_IMPLEMENT_INTERFACE (G_TYPE_INITABLE, initable_iface_init)
+                        G_IMPLEMENT_INTERFACE (G_TYPE_ASYNC_INITABLE, NULL))
 
 enum {
     PROP_0,
@@ -67,6 +71,10 @@ struct _QfuSaharaDevicePrivate {
     guint transfer_block_size;
     /* number of images setup */
     guint n_setup_images;
+    /* firehose block read-ahead, while downloading */
+    struct _FirehosePrefetch *prefetch;
+    /* number of firehose operation retries, for statistics */
+    guint n_firehose_retries;
 };
 
 /******************************************************************************/
@@ -393,6 +401,7 @@ firehose_operation_run (QfuSaharaDevice          *self,
             if (max_retries && ++n_retries < max_retries) {
                 g_timer_reset (timer);
                 g_clear_error (&inner_error);
+                self->priv->n_firehose_retries++;
                 init_retry (self, user_data);
                 continue;
             }
@@ -436,6 +445,7 @@ firehose_operation_run (QfuSaharaDevice          *self,
             if (max_retries && ++n_retries < max_retries) {
                 g_timer_reset (timer);
                 g_clear_error (&inner_error);
+                self->priv->n_firehose_retries++;
                 init_retry (self, user_data);
                 continue;
             }
@@ -475,6 +485,226 @@ validate_ascii_print (const guint8 *rsp,
     return TRUE;
 }
 
+/******************************************************************************/
+/* Firehose block read-ahead
+ *
+ * While the image is being downloaded, a reader thread loads the next blocks
+ * from the image into a small ring of buffers, so that disk I/O for block N+1
+ * overlaps with the transfer of block N. The reader is the only one using
+ * the image input stream until the prefetch is stopped. */
+
+#define FIREHOSE_PREFETCH_N_BUFFERS 3
+
+typedef struct {
+    guint8  *data;
+    guint    block_i;
+    gsize    size;
+    gboolean send_last;
+    GError  *error;
+} FirehosePrefetchBlock;
+
+typedef struct _FirehosePrefetch {
+    QfuImage              *image;
+    guint                  n_blocks;
+    guint                  next_block_i;
+    GCancellable          *cancellable;
+    GAsyncQueue           *free_blocks;
+    GAsyncQueue           *ready_blocks;
+    GThread               *thread;
+    FirehosePrefetchBlock  blocks[FIREHOSE_PREFETCH_N_BUFFERS];
+} FirehosePrefetch;
+
+/* Computes the size of the block to send, which for the last block is
+ * adjusted to a sector size multiple */
+static gsize
+firehose_block_size (QfuSaharaDevice *self,
+                     QfuImage        *image,
+                     guint            block_i,
+                     gboolean        *send_last)
+{
+    goffset offset;
+    gsize   size;
+    gsize   last_block_size;
+
+    offset = block_i * (goffset)self->priv->transfer_block_size;
+    size = qfu_image_get_size (image) - offset;
+    if (size >= self->priv->transfer_block_size) {
+        *send_last = FALSE;
+        return self->priv->transfer_block_size;
+    }
+
+    /* we need to send an additional packet full of 0s after the last
+     * sector is transferred. */
+    *send_last = TRUE;
+
+    /* last transfer block adjusted to sector size multiple */
+    last_block_size = self->priv->sector_size_in_bytes;
+    while (last_block_size < size)
+        last_block_size += self->priv->sector_size_in_bytes;
+    g_assert (last_block_size <= self->priv->transfer_block_size);
+    return last_block_size;
+}
+
+/* Loads a block from the image into the given buffer, which must be at
+ * least transfer_block_size long. Only the padding after the image data is
+ * cleared, full-sized blocks are read as they are. */
+static gssize
+firehose_block_read (QfuSaharaDevice  *self,
+                     QfuImage         *image,
+                     guint             block_i,
+                     guint8           *buffer,
+                     gboolean         *send_last,
+                     GCancellable     *cancellable,
+                     GError          **error)
+{
+    gssize reqlen;
+    gsize  size;
+
+    size = firehose_block_size (self, image, block_i, send_last);
+    reqlen = qfu_image_read (image,
+                             block_i * (goffset)self->priv->transfer_block_size,
+                             size,
+                             buffer,
+                             self->priv->transfer_block_size,
+                             cancellable,
+                             error);
+    if (reqlen < 0) {
+        g_prefix_error (error, "couldn't read transfer block %u", block_i);
+        return -1;
+    }
+
+    g_assert ((gsize)reqlen <= size);
+    if ((gsize)reqlen < size)
+        memset (&buffer[reqlen], 0, size - reqlen);
+    return (gssize)size;
+}
+
+typedef struct {
+    QfuSaharaDevice  *self;
+    FirehosePrefetch *prefetch;
+} FirehosePrefetchThreadContext;
+
+static gpointer
+firehose_prefetch_thread (FirehosePrefetchThreadContext *ctx)
+{
+    FirehosePrefetch *prefetch = ctx->prefetch;
+    guint             block_i;
+
+    for (block_i = 0; block_i < prefetch->n_blocks; block_i++) {
+        FirehosePrefetchBlock *block;
+        gssize                 size;
+
+        /* Wait for a free buffer; the prefetch may be stopped meanwhile */
+        block = g_async_queue_pop (prefetch->free_blocks);
+        if (g_cancellable_is_cancelled (prefetch->cancellable))
+            break;
+
+        block->block_i = block_i;
+        size = firehose_block_read (ctx->self,
+                                    prefetch->image,
+                                    block_i,
+                                    block->data,
+                                    &block->send_last,
+                                    prefetch->cancellable,
+                                    &block->error);
+        block->size = (size < 0 ? 0 : (gsize)size);
+        g_async_queue_push (prefetch->ready_blocks, block);
+
+        /* Reader stops on the first error, which is reported to the writer
+         * along with the block */
+        if (block->error)
+            break;
+    }
+
+    g_slice_free (FirehosePrefetchThreadContext, ctx);
+    return NULL;
+}
+
+static void
+firehose_prefetch_start (QfuSaharaDevice *self,
+                         QfuImage        *image,
+                         guint            n_blocks)
+{
+    FirehosePrefetch              *prefetch;
+    FirehosePrefetchThreadContext *ctx;
+    guint                          i;
+
+    g_assert (!self->priv->prefetch);
+
+    prefetch = g_slice_new0 (FirehosePrefetch);
+    prefetch->image = g_object_ref (image);
+    prefetch->n_blocks = n_blocks;
+    prefetch->cancellable = g_cancellable_new ();
+    prefetch->free_blocks = g_async_queue_new ();
+    prefetch->ready_blocks = g_async_queue_new ();
+    for (i = 0; i < FIREHOSE_PREFETCH_N_BUFFERS; i++) {
+        prefetch->blocks[i].data = g_malloc (self->priv->transfer_block_size);
+        g_async_queue_push (prefetch->free_blocks, &prefetch->blocks[i]);
+    }
+
+    ctx = g_slice_new (FirehosePrefetchThreadContext);
+    ctx->self = self;
+    ctx->prefetch = prefetch;
+    prefetch->thread = g_thread_new ("qfu-firehose-prefetch", (GThreadFunc)firehose_prefetch_thread, ctx);
+
+    self->priv->prefetch = prefetch;
+}
+
+static void
+firehose_prefetch_stop (QfuSaharaDevice *self)
+{
+    FirehosePrefetch *prefetch;
+    guint             i;
+
+    prefetch = self->priv->prefetch;
+    if (!prefetch)
+        return;
+    self->priv->prefetch = NULL;
+
+    /* Wake up the reader in case it's waiting for a free buffer; it will
+     * see the cancellation right away and exit */
+    g_cancellable_cancel (prefetch->cancellable);
+    g_async_queue_push (prefetch->free_blocks, &prefetch->blocks[0]);
+    g_thread_join (prefetch->thread);
+
+    for (i = 0; i < FIREHOSE_PREFETCH_N_BUFFERS; i++) {
+        g_clear_error (&prefetch->blocks[i].error);
+        g_free (prefetch->blocks[i].data);
+    }
+    g_async_queue_unref (prefetch->free_blocks);
+    g_async_queue_unref (prefetch->ready_blocks);
+    g_object_unref (prefetch->cancellable);
+    g_object_unref (prefetch->image);
+    g_slice_free (FirehosePrefetch, prefetch);
+}
+
+/* Gets the next block loaded by the reader, if it's the one expected */
+static FirehosePrefetchBlock *
+firehose_prefetch_pop (QfuSaharaDevice  *self,
+                       QfuImage         *image,
+                       guint             block_i)
+{
+    FirehosePrefetch *prefetch;
+
+    prefetch = self->priv->prefetch;
+    if (!prefetch || prefetch->image != image || prefetch->next_block_i != block_i) {
+        /* Out of order access; the reader can't be used any more */
+        firehose_prefetch_stop (self);
+        return NULL;
+    }
+
+    prefetch->next_block_i++;
+    return g_async_queue_pop (prefetch->ready_blocks);
+}
+
+static void
+firehose_prefetch_release (QfuSaharaDevice       *self,
+                           FirehosePrefetchBlock *block)
+{
+    g_assert (self->priv->prefetch);
+    g_async_queue_push (self->priv->prefetch->free_blocks, block);
+}
+
 /******************************************************************************/
 /* Firehose setup download */
 
@@ -588,16 +818,25 @@ qfu_sahara_device_firehose_setup_download (QfuSaharaDevice  *self,
     g_debug ("  transfer block size:   %u (%u sectors/transfer)", self->priv->transfer_block_size, self->priv->transfer_block_size / self->priv->sector_size_in_bytes);
     g_debug ("  num transfers:         %u", n_transfer_blocks);
 
-    return firehose_operation_run (self,
-                                   (PrepareRequestCallback)  firehose_setup_download_prepare_request,
-                                   (ProcessResponseCallback) firehose_setup_download_process_response,
-                                   (CheckCompletionCallback) firehose_setup_download_check_completion,
-                                   (InitRetryCallback)       firehose_setup_download_init_retry,
-                                   FIREHOSE_SETUP_DOWNLOAD_MAX_RETRIES,
-                                   FIREHOSE_SETUP_DOWNLOAD_TIMEOUT_SECS,
-                                   &ctx,
-                                   cancellable,
-                                   error);
+    if (!firehose_operation_run (self,
+                                 (PrepareRequestCallback)  firehose_setup_download_prepare_request,
+                                 (ProcessResponseCallback) firehose_setup_download_process_response,
+                                 (CheckCompletionCallback) firehose_setup_download_check_completion,
+                                 (InitRetryCallback)       firehose_setup_download_init_retry,
+                                 FIREHOSE_SETUP_DOWNLOAD_MAX_RETRIES,
+                                 FIREHOSE_SETUP_DOWNLOAD_TIMEOUT_SECS,
+                                 &ctx,
+                                 cancellable,
+                                 error))
+        return FALSE;
+
+    /* Start reading blocks from the image right away, so that the first
+     * ones are ready when the caller starts writing them. Not needed if the
+     * image is mapped, as blocks are sent straight from the mapping. */
+    firehose_prefetch_stop (self);
+    if (!qfu_image_peek (image, 0, 0))
+        firehose_prefetch_start (self, image, n_transfer_blocks);
+    return TRUE;
 }
 
 /******************************************************************************/
@@ -612,55 +851,64 @@ qfu_sahara_device_firehose_write_block (QfuSaharaDevice  *self,
                                         GCancellable     *cancellable,
                                         GError          **error)
 {
-    gssize   reqlen;
-    goffset  offset;
-    gsize    size;
-    gboolean send_last = FALSE;
+    FirehosePrefetchBlock *block;
+    const guint8          *data;
+    gssize                 size;
+    gboolean               send_last = FALSE;
+    gboolean               sent;
 
     g_debug ("[qfu-sahara-device] writing block %u...", block_i);
 
     g_assert (self->priv->transfer_block_size < self->priv->buffer->len);
-    memset (self->priv->buffer->data, 0, self->priv->transfer_block_size);
 
-    offset = block_i * (goffset)self->priv->transfer_block_size;
-    size = qfu_image_get_size (image) - offset;
-    if (size >= self->priv->transfer_block_size)
-        size = self->priv->transfer_block_size;
-    else {
-        gsize last_block_size;
-
-        /* we need to send an additional packet full of 0s after the last
-         * sector is transferred. */
-        send_last = TRUE;
-
-        /* last transfer block adjusted to sector size multiple */
-        last_block_size = self->priv->sector_size_in_bytes;
-        while (last_block_size < size)
-            last_block_size += self->priv->sector_size_in_bytes;
-        size = last_block_size;
-        g_assert (size <= self->priv->transfer_block_size);
+    /* Send full-sized blocks straight from the mapped image if possible, use
+     * the block already loaded by the reader if available, or otherwise read
+     * it right away */
+    block = NULL;
+    size = (gssize)firehose_block_size (self, image, block_i, &send_last);
+    data = (send_last ? NULL : qfu_image_peek (image, block_i * (goffset)self->priv->transfer_block_size, (gsize)size));
+    if (!data)
+        block = firehose_prefetch_pop (self, image, block_i);
+
+    if (data) {
+        g_debug ("[qfu-sahara-device] sending block %u from mapped image", block_i);
+    } else if (block) {
+        if (block->error) {
+            g_propagate_error (error, g_steal_pointer (&block->error));
+            firehose_prefetch_release (self, block);
+            return FALSE;
+        }
+        g_assert (block->block_i == block_i);
+        data = block->data;
+        size = (gssize)block->size;
+        send_last = block->send_last;
+    } else {
+        size = firehose_block_read (self,
+                                    image,
+                                    block_i,
+                                    self->priv->buffer->data,
+                                    &send_last,
+                                    cancellable,
+                                    error);
+        if (size < 0)
+            return FALSE;
+        data = self->priv->buffer->data;
     }
 
-    reqlen = qfu_image_read (image,
-                             offset,
-                             size,
-                             self->priv->buffer->data,
-                             self->priv->buffer->len,
-                             cancellable,
-                             error);
-    if (reqlen < 0) {
-        g_prefix_error (error, "couldn't read transfer block %u", block_i);
-        return FALSE;
-    }
+    sent = (send_receive (self,
+                          data,
+                          (gsize)size,
+                          0,
+                          NULL,
+                          cancellable,
+                          error) >= 0);
 
-    g_assert ((guint)reqlen <= self->priv->transfer_block_size);
-    if (send_receive (self,
-                      self->priv->buffer->data,
-                      size,
-                      0,
-                      NULL,
-                      cancellable,
-                      error) < 0) {
+    /* While this block was being sent the reader has been loading the
+     * following ones, give the buffer back so that it can continue */
+    if (block)
+        firehose_prefetch_release (self, block);
+
+    if (!sent) {
         g_prefix_error (error, "couldn't send transfer block %u", block_i);
         return FALSE;
     }
@@ -757,6 +1005,8 @@ qfu_sahara_device_firehose_teardown_download (QfuSaharaDevice  *self,
         .acked = FALSE,
     };
 
+    firehose_prefetch_stop (self);
+
     return firehose_operation_run (self,
                                    NULL, /* PrepareRequestCallback */
                                    (ProcessResponseCallback) firehose_teardown_download_process_response,
@@ -860,11 +1110,18 @@ qfu_sahara_device_firehose_reset (QfuSaharaDevice  *self,
 
 #define FIREHOSE_INIT_TIMEOUT_SECS 10
 
+/* Upper bound for the payload size we negotiate with the target; larger
+ * payloads mean fewer and larger bulk transfers per image, but every prefetch
+ * slot holds one block in memory. */
+#define FIREHOSE_MAX_PAYLOAD_SIZE_TO_TARGET (4 * 1024 * 1024)
+
 typedef enum {
     FIREHOSE_INIT_STEP_PING,
     FIREHOSE_INIT_STEP_WAIT_PING,
     FIREHOSE_INIT_STEP_CONFIGURE,
     FIREHOSE_INIT_STEP_WAIT_CONFIGURE,
+    FIREHOSE_INIT_STEP_RECONFIGURE,
+    FIREHOSE_INIT_STEP_WAIT_RECONFIGURE,
     FIREHOSE_INIT_STEP_STORAGE_INFO,
     FIREHOSE_INIT_STEP_WAIT_STORAGE_INFO,
     FIREHOSE_INIT_STEP_LAST,
@@ -873,6 +1130,7 @@ typedef enum {
 typedef struct {
     FirehoseInitStep step;
     guint            max_payload_size_to_target_in_bytes;
+    guint            max_payload_size_to_target_in_bytes_supported;
     guint            sector_size_in_bytes;
     guint            num_partition_sectors;
     guint            total_sector_size_in_bytes;
@@ -916,13 +1174,20 @@ firehose_init_context_process_response_configure_message (const gchar          *
                                                           GError              **error)
 {
     guint32 max_payload_size_to_target_in_bytes = 0;
+    guint32 max_payload_size_to_target_in_bytes_supported = 0;
 
-    if (!qfu_firehose_message_parse_response_configure (rsp, &max_payload_size_to_target_in_bytes))
+    if (!qfu_firehose_message_parse_response_configure (rsp,
+                                                        &max_payload_size_to_target_in_bytes,
+                                                        &max_payload_size_to_target_in_bytes_supported))
         return FALSE;
 
     if (max_payload_size_to_target_in_bytes > 0) {
         g_debug ("[qfu-sahara-device] firehose requested max payload size: %u bytes", max_payload_size_to_target_in_bytes);
         ctx->max_payload_size_to_target_in_bytes = max_payload_size_to_target_in_bytes;
+        if (max_payload_size_to_target_in_bytes_supported > 0) {
+            g_debug ("[qfu-sahara-device] firehose supported max payload size: %u bytes", max_payload_size_to_target_in_bytes_supported);
+            ctx->max_payload_size_to_target_in_bytes_supported = max_payload_size_to_target_in_bytes_supported;
+        }
     } else {
         g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
                      "unexpected max payload size: %u", max_payload_size_to_target_in_bytes);
@@ -952,6 +1217,25 @@ firehose_init_prepare_request (QfuSaharaDevice     *self,
     case FIREHOSE_INIT_STEP_WAIT_CONFIGURE:
         /* not sending anything, just processing responses */
         return NULL;
+    case FIREHOSE_INIT_STEP_RECONFIGURE: {
+        guint requested;
+
+        /* If the target supports larger payloads than the one it suggested,
+         * configure again asking for the largest one we allow, so that each
+         * image block goes in as few bulk transfers as possible */
+        requested = MIN (ctx->max_payload_size_to_target_in_bytes_supported, FIREHOSE_MAX_PAYLOAD_SIZE_TO_TARGET);
+        if (requested <= ctx->max_payload_size_to_target_in_bytes) {
+            ctx->step = FIREHOSE_INIT_STEP_STORAGE_INFO;
+            return firehose_init_prepare_request (self, ctx);
+        }
+        g_debug ("[qfu-sahara-device] sending firehose configure with max payload size %u bytes...", requested);
+        qfu_firehose_message_build_configure (self->priv->buffer->data, self->priv->buffer->len, requested);
+        ctx->step++;
+        return (const gchar *)self->priv->buffer->data;
+    }
+    case FIREHOSE_INIT_STEP_WAIT_RECONFIGURE:
+        /* not sending anything, just processing responses */
+        return NULL;
     case FIREHOSE_INIT_STEP_STORAGE_INFO:
         g_debug ("[qfu-sahara-device] sending firehose storage info request...");
         qfu_firehose_message_build_get_storage_info (self->priv->buffer->data, self->priv->buffer->len);
@@ -980,6 +1264,14 @@ firehose_init_process_response (QfuSaharaDevice      *self,
 
     if (firehose_common_process_response_ack_message (rsp, "ACK", NULL, &inner_error)) {
         if (inner_error) {
+            /* a plain NAK to the larger payload request isn't fatal, just keep
+             * on with the payload size suggested by the target */
+            if (ctx->step == FIREHOSE_INIT_STEP_WAIT_RECONFIGURE) {
+                g_debug ("[qfu-sahara-device] larger max payload size rejected: %s", inner_error->message);
+                g_clear_error (&inner_error);
+                ctx->step++;
+                return TRUE;
+            }
             g_propagate_error (error, inner_error);
             return FALSE;
         }
@@ -995,7 +1287,7 @@ firehose_init_process_response (QfuSaharaDevice      *self,
             return FALSE;
         }
         /* if we were expecting a response, go on to next step */
-        if (ctx->step == FIREHOSE_INIT_STEP_WAIT_CONFIGURE)
+        if (ctx->step == FIREHOSE_INIT_STEP_WAIT_CONFIGURE || ctx->step == FIREHOSE_INIT_STEP_WAIT_RECONFIGURE)
             ctx->step++;
         return TRUE;
     }
@@ -1017,12 +1309,13 @@ sahara_device_firehose_init (QfuSaharaDevice  *self,
                              GError          **error)
 {
     FirehoseInitContext ctx = {
-        .step                                = FIREHOSE_INIT_STEP_PING,
-        .max_payload_size_to_target_in_bytes = 0,
-        .sector_size_in_bytes                = 0,
-        .num_partition_sectors               = 0,
-        .total_sector_size_in_bytes          = 0,
-        .pages_in_block                      = 0,
+        .step                                          = FIREHOSE_INIT_STEP_PING,
+        .max_payload_size_to_target_in_bytes           = 0,
+        .max_payload_size_to_target_in_bytes_supported = 0,
+        .sector_size_in_bytes                          = 0,
+        .num_partition_sectors                         = 0,
+        .total_sector_size_in_bytes                    = 0,
+        .pages_in_block                                = 0,
     };
 
     if (!firehose_operation_run (self,
@@ -1059,6 +1352,12 @@ sahara_device_firehose_init (QfuSaharaDevice  *self,
     g_assert (self->priv->transfer_block_size <= self->priv->max_payload_size_to_target_in_bytes);
     g_assert (self->priv->transfer_block_size > 0);
 
+    /* blocks that can't be sent straight from the mapped image are read into
+     * the device buffer, so make sure it is large enough for the negotiated
+     * payload size */
+    if (self->priv->transfer_block_size >= self->priv->buffer->len)
+        g_byte_array_set_size (self->priv->buffer, self->priv->transfer_block_size + 1);
+
     return TRUE;
 }
 
@@ -1066,6 +1365,7 @@ sahara_device_firehose_init (QfuSaharaDevice  *self,
 /* Sahara initialization */
 
 #define SAHARA_MAX_PROTOCOL_STEP_ATTEMPTS 5
+#define SAHARA_BOOT_SETTLE_TIME_MS        2000
 
 typedef enum {
     SAHARA_PROTOCOL_STEP_UNKNOWN,
@@ -1214,6 +1514,34 @@ sahara_device_run_protocol_step (QfuSaharaDevice    *self,
     return next_step;
 }
 
+/* Wait some time, returning early if the operation is cancelled */
+static gboolean
+sahara_device_settle (guint          timeout_ms,
+                      GCancellable  *cancellable,
+                      GError       **error)
+{
+    GPollFD  pollfd;
+    gint64   start;
+    gint64   elapsed_ms;
+
+    start = g_get_monotonic_time ();
+    if (!cancellable || !g_cancellable_make_pollfd (cancellable, &pollfd)) {
+        g_usleep (timeout_ms * 1000);
+        return TRUE;
+    }
+
+    /* Retry on signal interruptions until the timeout expires */
+    while ((elapsed_ms = (g_get_monotonic_time () - start) / 1000) < timeout_ms) {
+        if (g_poll (&pollfd, 1, (gint) (timeout_ms - elapsed_ms)) > 0)
+            break;
+    }
+    g_cancellable_release_fd (cancellable);
+
+    g_debug ("[qfu-sahara-device] waited %" G_GINT64_FORMAT "ms for device to boot properly",
+             (g_get_monotonic_time () - start) / 1000);
+    return !g_cancellable_set_error_if_cancelled (cancellable, error);
+}
+
 static gboolean
 sahara_device_initialize (QfuSaharaDevice  *self,
                           GCancellable     *cancellable,
@@ -1302,9 +1630,11 @@ initable_init (GInitable     *initable,
      * command to switch to firehose protocol is unsupported.
      *
      * 2 full seconds selected a bit arbitrarily, didn't get any failure when
-     * using this amount of time. */
+     * using this amount of time. The wait is aborted as soon as the operation
+     * is cancelled. */
     g_debug ("[qfu-sahara-device] waiting time for device to boot properly...");
-    g_usleep (2 * G_USEC_PER_SEC);
+    if (!sahara_device_settle (SAHARA_BOOT_SETTLE_TIME_MS, cancellable, &inner_error))
+        goto out;
 
     g_debug ("[qfu-sahara-device] initializing sahara protocol...");
     if (!sahara_device_initialize (self, cancellable, &inner_error))
@@ -1331,6 +1661,16 @@ out:
 
 /******************************************************************************/
 
+guint
+qfu_sahara_device_get_n_firehose_retries (QfuSaharaDevice *self)
+{
+    g_return_val_if_fail (QFU_IS_SAHARA_DEVICE (self), 0);
+
+    return self->priv->n_firehose_retries;
+}
+
+/******************************************************************************/
+
 QfuSaharaDevice *
 qfu_sahara_device_new (GFile         *file,
                        GCancellable  *cancellable,
@@ -1345,6 +1685,37 @@ qfu_sahara_device_new (GFile         *file,
                                               NULL));
 }
 
+QfuSaharaDevice *
+qfu_sahara_device_new_finish (GAsyncResult  *res,
+                              GError       **error)
+{
+    GObject *source;
+    GObject *self;
+
+    source = g_async_result_get_source_object (res);
+    self = g_async_initable_new_finish (G_ASYNC_INITABLE (source), res, error);
+    g_object_unref (source);
+
+    return (self ? QFU_SAHARA_DEVICE (self) : NULL);
+}
+
+void
+qfu_sahara_device_new_async (GFile               *file,
+                             GCancellable        *cancellable,
+                             GAsyncReadyCallback  callback,
+                             gpointer             user_data)
+{
+    g_return_if_fail (G_IS_FILE (file));
+
+    g_async_initable_new_async (QFU_TYPE_SAHARA_DEVICE,
+                                G_PRIORITY_DEFAULT,
+                                cancellable,
+                                callback,
+                                user_data,
+                                "file", file,
+                                NULL);
+}
+
 
 static void
 qfu_sahara_device_init (QfuSaharaDevice *self)
@@ -1397,6 +1768,8 @@ dispose (GObject *object)
 {
     QfuSaharaDevice *self = QFU_SAHARA_DEVICE (object);
 
+    firehose_prefetch_stop (self);
+
     if (!(self->priv->fd < 0)) {
         close (self->priv->fd);
         self->priv->fd = -1;
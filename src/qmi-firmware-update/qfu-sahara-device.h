@@ -53,6 +53,12 @@ G_DEFINE_AUTOPTR_CLEANUP_FUNC (QfuSaharaDevice, g_object_unref);
 QfuSaharaDevice *qfu_sahara_device_new                        (GFile            *file,
                                                                GCancellable     *cancellable,
                                                                GError          **error);
+void             qfu_sahara_device_new_async                  (GFile               *file,
+                                                               GCancellable        *cancellable,
+                                                               GAsyncReadyCallback  callback,
+                                                               gpointer             user_data);
+QfuSaharaDevice *qfu_sahara_device_new_finish                 (GAsyncResult     *res,
+                                                               GError          **error);
 gboolean         qfu_sahara_device_firehose_setup_download    (QfuSaharaDevice  *self,
                                                                QfuImage         *image,
                                                                guint            *n_blocks,
@@ -70,6 +76,7 @@ gboolean         qfu_sahara_device_firehose_teardown_download (QfuSaharaDevice
 gboolean         qfu_sahara_device_firehose_reset             (QfuSaharaDevice  *self,
                                                                GCancellable     *cancellable,
                                                                GError          **error);
+guint            qfu_sahara_device_get_n_firehose_retries     (QfuSaharaDevice  *self);
 
 G_END_DECLS
 
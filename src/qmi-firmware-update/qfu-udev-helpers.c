@@ -375,6 +375,32 @@ out:
 
 /******************************************************************************/
 
+static gboolean
+device_driver_matches_type (GUdevDevice             *device,
+                            QfuUdevHelperDeviceType  type)
+{
+    gchar    *driver = NULL;
+    gboolean  matches = FALSE;
+
+    if (!udev_helper_get_udev_interface_details (device, &driver, NULL))
+        return FALSE;
+
+    switch (type) {
+    case QFU_UDEV_HELPER_DEVICE_TYPE_TTY:
+        matches = (g_strcmp0 (driver, "qcserial") == 0);
+        break;
+    case QFU_UDEV_HELPER_DEVICE_TYPE_CDC_WDM:
+        matches = (g_strcmp0 (driver, "qmi_wwan") == 0 || g_strcmp0 (driver, "cdc_mbim") == 0);
+        break;
+    case QFU_UDEV_HELPER_DEVICE_TYPE_LAST:
+    default:
+        g_assert_not_reached ();
+    }
+
+    g_free (driver);
+    return matches;
+}
+
 static GFile *
 device_matches_sysfs_and_type (GUdevDevice             *device,
                                const gchar             *sysfs_path,
@@ -382,7 +408,6 @@ device_matches_sysfs_and_type (GUdevDevice             *device,
 {
     GFile *file = NULL;
     gchar *device_sysfs_path = NULL;
-    gchar *device_driver = NULL;
     gchar *device_path = NULL;
 
     if (!udev_helper_get_udev_device_details (device,
@@ -396,32 +421,15 @@ device_matches_sysfs_and_type (GUdevDevice             *device,
     if (g_strcmp0 (device_sysfs_path, sysfs_path) != 0)
         goto out;
 
-    if (!udev_helper_get_udev_interface_details (device,
-                                                 &device_driver,
-                                                 NULL))
+    if (!device_driver_matches_type (device, type))
         goto out;
 
-    switch (type) {
-    case QFU_UDEV_HELPER_DEVICE_TYPE_TTY:
-        if (g_strcmp0 (device_driver, "qcserial") != 0)
-            goto out;
-        break;
-    case QFU_UDEV_HELPER_DEVICE_TYPE_CDC_WDM:
-        if (g_strcmp0 (device_driver, "qmi_wwan") != 0 && g_strcmp0 (device_driver, "cdc_mbim") != 0)
-            goto out;
-        break;
-    case QFU_UDEV_HELPER_DEVICE_TYPE_LAST:
-    default:
-        g_assert_not_reached ();
-    }
-
     device_path = g_strdup_printf ("/dev/%s", g_udev_device_get_name (device));
     file = g_file_new_for_path (device_path);
     g_free (device_path);
 
 out:
     g_free (device_sysfs_path);
-    g_free (device_driver);
     return file;
 }
 
@@ -471,13 +479,28 @@ qfu_udev_helper_list_devices (QfuUdevHelperDeviceType  device_type,
 
 #define WAIT_FOR_DEVICE_TIMEOUT_SECS 120
 
+/* All the waits for a given device type in the process share one udev client
+ * and are indexed by the sysfs path of the USB device they expect, so that
+ * each uevent is resolved once and matched with a single lookup, no matter
+ * how many devices are being updated at the same time. */
 typedef struct {
     QfuUdevHelperDeviceType  device_type;
     GUdevClient             *udev;
+    gulong                   uevent_id;
+    /* sysfs path -> GList of GTask */
+    GHashTable              *waits;
+    /* Waits that may also match a peer port, checked one by one */
+    GList                   *peer_waits;
+    guint                    n_waits;
+} WaitForDeviceRegistry;
+
+static WaitForDeviceRegistry *wait_for_device_registries[QFU_UDEV_HELPER_DEVICE_TYPE_LAST];
+
+typedef struct {
+    QfuUdevHelperDeviceType  device_type;
     gchar                   *sysfs_path;
     gchar                   *peer_port;
     guint                    timeout_id;
-    gulong                   uevent_id;
     gulong                   cancellable_id;
 } WaitForDeviceContext;
 
@@ -485,10 +508,8 @@ static void
 wait_for_device_context_free (WaitForDeviceContext *ctx)
 {
     g_assert (!ctx->timeout_id);
-    g_assert (!ctx->uevent_id);
     g_assert (!ctx->cancellable_id);
 
-    g_object_unref (ctx->udev);
     g_free (ctx->sysfs_path);
     g_free (ctx->peer_port);
     g_slice_free (WaitForDeviceContext, ctx);
@@ -501,52 +522,164 @@ qfu_udev_helper_wait_for_device_finish (GAsyncResult  *res,
     return G_FILE (g_task_propagate_pointer (G_TASK (res), error));
 }
 
+static void wait_for_device_complete (GTask  *task,
+                                      GFile  *file,
+                                      GError *error);
+
 static void
-handle_uevent (GUdevClient *client,
-               const char  *action,
-               GUdevDevice *device,
-               GTask       *task)
+handle_uevent (GUdevClient           *client,
+               const char            *action,
+               GUdevDevice           *device,
+               WaitForDeviceRegistry *registry)
 {
-    WaitForDeviceContext *ctx;
-    GFile                *file;
-
-    ctx = (WaitForDeviceContext *) g_task_get_task_data (task);
+    gchar *device_sysfs_path = NULL;
+    gchar *device_path;
+    GList *matched = NULL;
+    GList *l;
 
     if (!g_str_equal (action, "add") && !g_str_equal (action, "move") && !g_str_equal (action, "change"))
         return;
 
-    file = device_matches_sysfs_and_type (device, ctx->sysfs_path, ctx->device_type);
-    if (!file && ctx->peer_port) {
-        gchar *tmp, *path;
+    /* Resolve the event just once, for all the waits */
+    if (!udev_helper_get_udev_device_details (device, &device_sysfs_path, NULL, NULL, NULL, NULL, NULL) ||
+        !device_sysfs_path)
+        goto out;
+
+    if (!device_driver_matches_type (device, registry->device_type))
+        goto out;
+
+    matched = g_list_copy (g_hash_table_lookup (registry->waits, device_sysfs_path));
 
+    for (l = registry->peer_waits; l; l = g_list_next (l)) {
+        WaitForDeviceContext *ctx;
+        gchar                *tmp, *path;
+
+        ctx = (WaitForDeviceContext *) g_task_get_task_data (G_TASK (l->data));
         tmp = g_build_filename (ctx->peer_port, "device", NULL);
         path = realpath (tmp, NULL);
         g_free (tmp);
         if (!path)
-            return;
+            continue;
 
-        file = device_matches_sysfs_and_type (device, path, ctx->device_type);
         g_debug ("[qfu-udev] peer lookup for %s: %s => %s",  g_udev_device_get_name (device), ctx->peer_port, path);
-        g_free (path);
+        if (g_str_equal (path, device_sysfs_path) && !g_list_find (matched, l->data))
+            matched = g_list_prepend (matched, l->data);
+        free (path);
     }
-    if (!file)
-        return;
+
+    if (!matched)
+        goto out;
 
     g_debug ("[qfu-udev] waiting device (%s) matched: %s",
-             qfu_udev_helper_device_type_to_string (ctx->device_type),
+             qfu_udev_helper_device_type_to_string (registry->device_type),
              g_udev_device_get_name (device));
 
-    /* Disconnect this handler */
-    g_signal_handler_disconnect (ctx->udev, ctx->uevent_id);
-    ctx->uevent_id = 0;
+    /* Completing the last wait may dispose the registry, so nothing may
+     * touch it after this loop */
+    device_path = g_strdup_printf ("/dev/%s", g_udev_device_get_name (device));
+    for (l = matched; l; l = g_list_next (l))
+        wait_for_device_complete (G_TASK (l->data), g_file_new_for_path (device_path), NULL);
+    g_free (device_path);
+    g_list_free (matched);
 
-    /* Disconnect the other handlers */
-    g_cancellable_disconnect (g_task_get_cancellable (task), ctx->cancellable_id);
-    ctx->cancellable_id = 0;
-    g_source_remove (ctx->timeout_id);
-    ctx->timeout_id = 0;
+out:
+    g_free (device_sysfs_path);
+}
 
-    g_task_return_pointer (task, file, g_object_unref);
+static void
+wait_for_device_registry_add (GTask *task)
+{
+    WaitForDeviceContext  *ctx;
+    WaitForDeviceRegistry *registry;
+    GList                 *waits;
+
+    ctx = (WaitForDeviceContext *) g_task_get_task_data (task);
+
+    registry = wait_for_device_registries[ctx->device_type];
+    if (!registry) {
+        registry = g_slice_new0 (WaitForDeviceRegistry);
+        registry->device_type = ctx->device_type;
+        if (ctx->device_type == QFU_UDEV_HELPER_DEVICE_TYPE_TTY)
+            registry->udev = g_udev_client_new (tty_subsys_list);
+        else if (ctx->device_type == QFU_UDEV_HELPER_DEVICE_TYPE_CDC_WDM)
+            registry->udev = g_udev_client_new (cdc_wdm_subsys_list);
+        else
+            g_assert_not_reached ();
+        registry->waits = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+        registry->uevent_id = g_signal_connect (registry->udev,
+                                                "uevent",
+                                                G_CALLBACK (handle_uevent),
+                                                registry);
+        wait_for_device_registries[ctx->device_type] = registry;
+    }
+
+    waits = g_hash_table_lookup (registry->waits, ctx->sysfs_path);
+    if (waits)
+        waits = g_list_append (waits, task);
+    else
+        g_hash_table_insert (registry->waits, g_strdup (ctx->sysfs_path), g_list_append (NULL, task));
+
+    if (ctx->peer_port)
+        registry->peer_waits = g_list_prepend (registry->peer_waits, task);
+
+    registry->n_waits++;
+}
+
+static void
+wait_for_device_registry_remove (GTask *task)
+{
+    WaitForDeviceContext  *ctx;
+    WaitForDeviceRegistry *registry;
+    GList                 *waits;
+
+    ctx = (WaitForDeviceContext *) g_task_get_task_data (task);
+    registry = wait_for_device_registries[ctx->device_type];
+    g_assert (registry);
+
+    waits = g_list_remove (g_hash_table_lookup (registry->waits, ctx->sysfs_path), task);
+    if (waits)
+        g_hash_table_insert (registry->waits, g_strdup (ctx->sysfs_path), waits);
+    else
+        g_hash_table_remove (registry->waits, ctx->sysfs_path);
+
+    registry->peer_waits = g_list_remove (registry->peer_waits, task);
+
+    if (--registry->n_waits > 0)
+        return;
+
+    g_signal_handler_disconnect (registry->udev, registry->uevent_id);
+    g_object_unref (registry->udev);
+    g_hash_table_unref (registry->waits);
+    g_assert (!registry->peer_waits);
+    g_slice_free (WaitForDeviceRegistry, registry);
+    wait_for_device_registries[ctx->device_type] = NULL;
+}
+
+/* Takes ownership of either @file or @error */
+static void
+wait_for_device_complete (GTask  *task,
+                          GFile  *file,
+                          GError *error)
+{
+    WaitForDeviceContext *ctx;
+
+    ctx = (WaitForDeviceContext *) g_task_get_task_data (task);
+
+    wait_for_device_registry_remove (task);
+
+    if (ctx->cancellable_id) {
+        g_cancellable_disconnect (g_task_get_cancellable (task), ctx->cancellable_id);
+        ctx->cancellable_id = 0;
+    }
+    if (ctx->timeout_id) {
+        g_source_remove (ctx->timeout_id);
+        ctx->timeout_id = 0;
+    }
+
+    if (error)
+        g_task_return_error (task, error);
+    else
+        g_task_return_pointer (task, file, g_object_unref);
     g_object_unref (task);
 }
 
@@ -557,19 +690,13 @@ wait_for_device_timed_out (GTask *task)
 
     ctx = (WaitForDeviceContext *) g_task_get_task_data (task);
 
-    /* Disconnect this handler */
+    /* The source is removed by returning FALSE */
     ctx->timeout_id = 0;
 
-    /* Disconnect the other handlers */
-    g_cancellable_disconnect (g_task_get_cancellable (task), ctx->cancellable_id);
-    ctx->cancellable_id = 0;
-    g_signal_handler_disconnect (ctx->udev, ctx->uevent_id);
-    ctx->uevent_id = 0;
-
-    g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_TIMED_OUT,
-                             "waiting for device at '%s' timed out",
-                             ctx->sysfs_path);
-    g_object_unref (task);
+    wait_for_device_complete (task, NULL,
+                              g_error_new (G_IO_ERROR, G_IO_ERROR_TIMED_OUT,
+                                           "waiting for device at '%s' timed out",
+                                           ctx->sysfs_path));
     return FALSE;
 }
 
@@ -581,20 +708,10 @@ wait_for_device_cancelled (GCancellable *cancellable,
 
     ctx = (WaitForDeviceContext *) g_task_get_task_data (task);
 
-    /* Disconnect this handler */
-    g_cancellable_disconnect (g_task_get_cancellable (task), ctx->cancellable_id);
-    ctx->cancellable_id = 0;
-
-    /* Disconnect the other handlers */
-    g_source_remove (ctx->timeout_id);
-    ctx->timeout_id = 0;
-    g_signal_handler_disconnect (ctx->udev, ctx->uevent_id);
-    ctx->uevent_id = 0;
-
-    g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_CANCELLED,
-                             "waiting for device at '%s' cancelled",
-                             ctx->sysfs_path);
-    g_object_unref (task);
+    wait_for_device_complete (task, NULL,
+                              g_error_new (G_IO_ERROR, G_IO_ERROR_CANCELLED,
+                                           "waiting for device at '%s' cancelled",
+                                           ctx->sysfs_path));
 }
 
 void
@@ -613,21 +730,17 @@ qfu_udev_helper_wait_for_device (QfuUdevHelperDeviceType  device_type,
     ctx->sysfs_path = g_strdup (sysfs_path);
     ctx->peer_port = g_strdup (peer_port);
 
-    if (ctx->device_type == QFU_UDEV_HELPER_DEVICE_TYPE_TTY)
-        ctx->udev = g_udev_client_new (tty_subsys_list);
-    else if (ctx->device_type == QFU_UDEV_HELPER_DEVICE_TYPE_CDC_WDM)
-        ctx->udev = g_udev_client_new (cdc_wdm_subsys_list);
-    else
-        g_assert_not_reached ();
-
     task = g_task_new (NULL, cancellable, callback, user_data);
     g_task_set_task_data (task, ctx, (GDestroyNotify) wait_for_device_context_free);
 
+    /* The cancellable handler would otherwise run before we are set up */
+    if (g_task_return_error_if_cancelled (task)) {
+        g_object_unref (task);
+        return;
+    }
+
     /* Monitor for device additions. */
-    ctx->uevent_id = g_signal_connect (ctx->udev,
-                                       "uevent",
-                                       G_CALLBACK (handle_uevent),
-                                       task);
+    wait_for_device_registry_add (task);
 
     /* Allow cancellation */
     ctx->cancellable_id = g_cancellable_connect (cancellable,
@@ -640,20 +753,32 @@ qfu_udev_helper_wait_for_device (QfuUdevHelperDeviceType  device_type,
                                              (GSourceFunc) wait_for_device_timed_out,
                                              task);
 
-    /* Note: task ownership is shared between the signals and the timeout */
+    /* Note: task ownership is shared between the registry, the cancellable
+     * and the timeout, and released by whichever completes the wait */
 }
 
 /******************************************************************************/
 
 struct _QfuUdevHelperGenericMonitor {
+    guint        ref_count;
     GUdevClient *udev;
 };
 
+/* A single generic monitor is shared by all the device selections in the
+ * process, so that events are logged only once */
+static QfuUdevHelperGenericMonitor *generic_monitor;
+
 void
 qfu_udev_helper_generic_monitor_free (QfuUdevHelperGenericMonitor *self)
 {
+    g_assert (self == generic_monitor);
+
+    if (--self->ref_count > 0)
+        return;
+
     g_object_unref (self->udev);
     g_slice_free (QfuUdevHelperGenericMonitor, self);
+    generic_monitor = NULL;
 }
 
 static void
@@ -676,8 +801,15 @@ qfu_udev_helper_generic_monitor_new (const gchar *sysfs_path)
 
     QfuUdevHelperGenericMonitor *self;
 
+    if (generic_monitor) {
+        generic_monitor->ref_count++;
+        return generic_monitor;
+    }
+
     self = g_slice_new0 (QfuUdevHelperGenericMonitor);
+    self->ref_count = 1;
     self->udev = g_udev_client_new (all_list);
+    generic_monitor = self;
 
     /* Monitor for device events. */
     g_signal_connect (self->udev, "uevent", G_CALLBACK (handle_uevent_generic), NULL);
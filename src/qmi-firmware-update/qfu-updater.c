@@ -20,7 +20,10 @@
  */
 
 #include <config.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <string.h>
+#include <unistd.h>
 
 #include <gio/gio.h>
 
@@ -51,6 +54,9 @@ typedef enum {
 struct _QfuUpdaterPrivate {
     UpdaterType         type;
     QfuDeviceSelection *device_selection;
+    guint8              qdl_window_size;
+    gchar              *label;
+    gchar              *stats_file;
 #if defined WITH_UDEV
     gchar              *firmware_version;
     gchar              *config_version;
@@ -78,12 +84,81 @@ static const gchar *progress[] = {
     "(-*----)"
 };
 
+/* Prints output of the update operation; when running several updaters at
+ * once, each line is prefixed with the label of the updater instead. */
+static void updater_print (GTask       *task,
+                           const gchar *format,
+                           ...) G_GNUC_PRINTF (2, 3);
+
+static void
+updater_print (GTask       *task,
+               const gchar *format,
+               ...)
+{
+    QfuUpdater  *self;
+    va_list      args;
+    gchar       *str;
+    gchar      **lines;
+    guint        i;
+
+    self = g_task_get_source_object (task);
+
+    va_start (args, format);
+    str = g_strdup_vprintf (format, args);
+    va_end (args);
+
+    if (!self->priv->label) {
+        g_print ("%s", str);
+        g_free (str);
+        return;
+    }
+
+    lines = g_strsplit (str, "\n", -1);
+    for (i = 0; lines[i]; i++) {
+        if (lines[i][0])
+            g_print ("[%s] %s\n", self->priv->label, lines[i]);
+    }
+    g_strfreev (lines);
+    g_free (str);
+}
+
+/* Interactive progress indicators are only shown when a single updater
+ * runs and the debug log isn't printed in stdout */
+static gboolean
+updater_show_progress (GTask *task)
+{
+    QfuUpdater *self;
+
+    self = g_task_get_source_object (task);
+    return (!qfu_log_get_verbose_stdout () && !self->priv->label);
+}
+
 /******************************************************************************/
 /* Run */
 
-/* Wait time after the upgrade has been done, before using the cdc-wdm port */
-#define WAIT_FOR_BOOT_TIMEOUT_SECS 5
-#define WAIT_FOR_BOOT_RETRIES      12
+/* After the upgrade, the cdc-wdm port is probed as soon as it's exposed, and
+ * then with an exponential backoff until the device finishes booting */
+#define WAIT_FOR_BOOT_INITIAL_DELAY_MS 250
+#define WAIT_FOR_BOOT_MAX_DELAY_MS     5000
+#define WAIT_FOR_BOOT_TIMEOUT_SECS     60
+
+/* Phases in which the updater just waits for the device */
+typedef enum {
+    WAIT_PHASE_TTY,
+    WAIT_PHASE_DOWNLOAD_PROTOCOL,
+    WAIT_PHASE_CDC_WDM,
+    WAIT_PHASE_BOOT,
+    WAIT_PHASE_LAST
+} WaitPhase;
+
+static const gchar *wait_phase_str[] = {
+    [WAIT_PHASE_TTY]               = "download mode port",
+    [WAIT_PHASE_DOWNLOAD_PROTOCOL] = "download protocol setup",
+    [WAIT_PHASE_CDC_WDM]           = "normal mode port",
+    [WAIT_PHASE_BOOT]              = "boot",
+};
+
+G_STATIC_ASSERT (G_N_ELEMENTS (wait_phase_str) == WAIT_PHASE_LAST);
 
 typedef enum {
 #if defined WITH_UDEV
@@ -108,6 +183,113 @@ typedef enum {
     RUN_CONTEXT_STEP_LAST
 } RunContextStep;
 
+static const gchar *run_context_step_str[] = {
+#if defined WITH_UDEV
+    [RUN_CONTEXT_STEP_QMI_CLIENT]              = "qmi-client",
+    [RUN_CONTEXT_STEP_GET_FIRMWARE_PREFERENCE] = "get-firmware-preference",
+    [RUN_CONTEXT_STEP_SET_FIRMWARE_PREFERENCE] = "set-firmware-preference",
+    [RUN_CONTEXT_STEP_POWER_CYCLE]             = "power-cycle",
+    [RUN_CONTEXT_STEP_CLEANUP_QMI_DEVICE]      = "cleanup-qmi-device",
+    [RUN_CONTEXT_STEP_WAIT_FOR_TTY]            = "wait-for-tty",
+#endif
+    [RUN_CONTEXT_STEP_SELECT_DEVICE]           = "select-device",
+    [RUN_CONTEXT_STEP_SELECT_IMAGE]            = "select-image",
+    [RUN_CONTEXT_STEP_DOWNLOAD_IMAGE]          = "download-image",
+    [RUN_CONTEXT_STEP_CLEANUP_IMAGE]           = "cleanup-image",
+    [RUN_CONTEXT_STEP_CLEANUP_DEVICE]          = "cleanup-device",
+#if defined WITH_UDEV
+    [RUN_CONTEXT_STEP_WAIT_FOR_CDC_WDM]        = "wait-for-cdc-wdm",
+    [RUN_CONTEXT_STEP_WAIT_FOR_BOOT]           = "wait-for-boot",
+    [RUN_CONTEXT_STEP_QMI_CLIENT_AFTER]        = "qmi-client-after",
+    [RUN_CONTEXT_STEP_CLEANUP_QMI_DEVICE_FULL] = "cleanup-qmi-device-full",
+#endif
+};
+
+G_STATIC_ASSERT (G_N_ELEMENTS (run_context_step_str) == RUN_CONTEXT_STEP_LAST);
+
+/* Throughput while downloading images is sampled in windows of this size */
+#define TRANSFER_STATS_WINDOW_SIZE (4 * 1024 * 1024)
+
+typedef struct {
+    goffset bytes;
+    gdouble secs;
+} TransferWindow;
+
+typedef struct {
+    gchar       *name;
+    const gchar *protocol;
+    goffset      size;
+    gdouble      transfer_secs;
+    gdouble      total_secs;
+    guint        n_retries;
+    GArray      *windows;
+    /* Ongoing transfer */
+    gint64       start_time;
+    gint64       window_start_time;
+    goffset      window_start_bytes;
+} ImageStats;
+
+static ImageStats *
+image_stats_new (QfuImage    *image,
+                 const gchar *protocol)
+{
+    ImageStats *stats;
+
+    stats = g_slice_new0 (ImageStats);
+    stats->name     = g_strdup (qfu_image_get_display_name (image));
+    stats->protocol = protocol;
+    stats->size     = qfu_image_get_size (image);
+    stats->windows  = g_array_new (FALSE, FALSE, sizeof (TransferWindow));
+    stats->start_time = stats->window_start_time = g_get_monotonic_time ();
+    return stats;
+}
+
+static void
+image_stats_free (ImageStats *stats)
+{
+    g_array_unref (stats->windows);
+    g_free (stats->name);
+    g_slice_free (ImageStats, stats);
+}
+
+static void
+image_stats_close_window (ImageStats *stats,
+                          gint64      now,
+                          goffset     bytes_done)
+{
+    TransferWindow window;
+
+    window.bytes = bytes_done - stats->window_start_bytes;
+    window.secs  = (gdouble) (now - stats->window_start_time) / G_USEC_PER_SEC;
+    g_array_append_val (stats->windows, window);
+
+    stats->window_start_time  = now;
+    stats->window_start_bytes = bytes_done;
+}
+
+/* Report the total amount of data transferred so far */
+static void
+image_stats_update (ImageStats *stats,
+                    goffset     bytes_done)
+{
+    if (bytes_done - stats->window_start_bytes >= TRANSFER_STATS_WINDOW_SIZE)
+        image_stats_close_window (stats, g_get_monotonic_time (), bytes_done);
+}
+
+/* Report that all data has been transferred, before any finalization
+ * done by the device */
+static void
+image_stats_transfer_done (ImageStats *stats,
+                           goffset     bytes_done)
+{
+    gint64 now;
+
+    now = g_get_monotonic_time ();
+    if (bytes_done > stats->window_start_bytes)
+        image_stats_close_window (stats, now, bytes_done);
+    stats->transfer_secs = (gdouble) (now - stats->start_time) / G_USEC_PER_SEC;
+}
+
 typedef struct {
     /* Device selection */
 #if defined WITH_UDEV
@@ -152,13 +334,27 @@ typedef struct {
     gchar *carrier;
 
     /* Waiting for boot */
-    guint wait_for_boot_seconds_elapsed;
-    guint wait_for_boot_retries;
+    guint   wait_for_boot_retries;
+    guint   wait_for_boot_delay_ms;
+    GTimer *wait_for_boot_timer;
 #endif
 
+    /* Time spent waiting for the device in each phase */
+    GTimer  *wait_timer;
+    gdouble  wait_secs[WAIT_PHASE_LAST];
+
+    /* Statistics */
+    gint64          start_time;
+    gint64          step_start_time;
+    RunContextStep  step_timed;
+    gdouble         step_secs[RUN_CONTEXT_STEP_LAST];
+    guint           step_runs[RUN_CONTEXT_STEP_LAST];
+    GPtrArray      *image_stats;
+
     /* Device to use while already in download mode */
     QfuQdlDevice    *qdl_device;
     QfuSaharaDevice *sahara_device;
+    guint            n_firehose_retries;
 } RunContext;
 
 static void
@@ -195,8 +391,14 @@ run_context_free (RunContext *ctx)
     }
     if (ctx->cdc_wdm_file)
         g_object_unref (ctx->cdc_wdm_file);
+    if (ctx->wait_for_boot_timer)
+        g_timer_destroy (ctx->wait_for_boot_timer);
 #endif
 
+    if (ctx->wait_timer)
+        g_timer_destroy (ctx->wait_timer);
+    if (ctx->image_stats)
+        g_ptr_array_unref (ctx->image_stats);
     g_clear_object (&ctx->qdl_device);
     g_clear_object (&ctx->sahara_device);
     g_clear_object (&ctx->serial_file);
@@ -205,18 +407,187 @@ run_context_free (RunContext *ctx)
     g_slice_free (RunContext, ctx);
 }
 
+gboolean
+/******************************************************************************/
+/* Statistics in JSON format */
+
+static void
+json_append_string (GString     *str,
+                    const gchar *value)
+{
+    const gchar *p;
+
+    if (!value) {
+        g_string_append (str, "null");
+        return;
+    }
+
+    g_string_append_c (str, '"');
+    for (p = value; *p; p++) {
+        switch (*p) {
+        case '"':
+            g_string_append (str, "\\\"");
+            break;
+        case '\\':
+            g_string_append (str, "\\\\");
+            break;
+        default:
+            if ((guchar) *p < 0x20)
+                g_string_append_printf (str, "\\u%04x", (guint) *p);
+            else
+                g_string_append_c (str, *p);
+            break;
+        }
+    }
+    g_string_append_c (str, '"');
+}
+
+static void
+run_context_step_timing_update (RunContext *ctx,
+                                gint64      now)
+{
+    if (ctx->step_start_time && ctx->step_timed < RUN_CONTEXT_STEP_LAST) {
+        ctx->step_secs[ctx->step_timed] += (gdouble) (now - ctx->step_start_time) / G_USEC_PER_SEC;
+        ctx->step_runs[ctx->step_timed]++;
+    }
+    ctx->step_timed = ctx->step;
+    ctx->step_start_time = now;
+}
+
+static gchar *
+build_stats_json (QfuUpdater   *self,
+                  RunContext   *ctx,
+                  const GError *error)
+{
+    GString *str;
+    gint64   now;
+    guint    i;
+    gboolean first;
+
+    now = g_get_monotonic_time ();
+    run_context_step_timing_update (ctx, now);
+
+    str = g_string_new ("{\"device\":");
+    json_append_string (str, self->priv->label);
+    g_string_append (str, ",\"result\":");
+    json_append_string (str, error ? "error" : "success");
+    g_string_append (str, ",\"error\":");
+    json_append_string (str, error ? error->message : NULL);
+    g_string_append_printf (str, ",\"total_secs\":%.3lf",
+                            ctx->start_time ? (gdouble) (now - ctx->start_time) / G_USEC_PER_SEC : 0.0);
+
+    g_string_append (str, ",\"steps\":[");
+    for (i = 0, first = TRUE; i < RUN_CONTEXT_STEP_LAST; i++) {
+        if (!ctx->step_runs[i])
+            continue;
+        g_string_append_printf (str, "%s{\"step\":", first ? "" : ",");
+        json_append_string (str, run_context_step_str[i]);
+        g_string_append_printf (str, ",\"runs\":%u,\"secs\":%.3lf}", ctx->step_runs[i], ctx->step_secs[i]);
+        first = FALSE;
+    }
+
+    g_string_append (str, "],\"waits\":[");
+    for (i = 0, first = TRUE; i < WAIT_PHASE_LAST; i++) {
+        if (ctx->wait_secs[i] <= 0)
+            continue;
+        g_string_append_printf (str, "%s{\"phase\":", first ? "" : ",");
+        json_append_string (str, wait_phase_str[i]);
+        g_string_append_printf (str, ",\"secs\":%.3lf}", ctx->wait_secs[i]);
+        first = FALSE;
+    }
+
+    g_string_append (str, "],\"images\":[");
+    for (i = 0; ctx->image_stats && i < ctx->image_stats->len; i++) {
+        ImageStats *stats;
+        guint       j;
+
+        stats = g_ptr_array_index (ctx->image_stats, i);
+        g_string_append_printf (str, "%s{\"name\":", i ? "," : "");
+        json_append_string (str, stats->name);
+        g_string_append (str, ",\"protocol\":");
+        json_append_string (str, stats->protocol);
+        g_string_append_printf (str,
+                                ",\"size\":%" G_GOFFSET_FORMAT
+                                ",\"transfer_secs\":%.3lf"
+                                ",\"total_secs\":%.3lf"
+                                ",\"bytes_per_sec\":%.0lf"
+                                ",\"retries\":%u"
+                                ",\"windows\":[",
+                                stats->size,
+                                stats->transfer_secs,
+                                stats->total_secs,
+                                stats->transfer_secs > 0 ? (gdouble) stats->size / stats->transfer_secs : 0.0,
+                                stats->n_retries);
+        for (j = 0; j < stats->windows->len; j++) {
+            TransferWindow *window;
+
+            window = &g_array_index (stats->windows, TransferWindow, j);
+            g_string_append_printf (str, "%s{\"bytes\":%" G_GOFFSET_FORMAT ",\"secs\":%.3lf,\"bytes_per_sec\":%.0lf}",
+                                    j ? "," : "",
+                                    window->bytes,
+                                    window->secs,
+                                    window->secs > 0 ? (gdouble) window->bytes / window->secs : 0.0);
+        }
+        g_string_append (str, "]}");
+    }
+    g_string_append (str, "]}\n");
+
+    return g_string_free (str, FALSE);
+}
+
+/* One JSON object per line is appended to the file, so that several runs (or
+ * several updaters running at the same time) can share the same file. */
+static void
+write_stats (QfuUpdater   *self,
+             RunContext   *ctx,
+             const GError *error)
+{
+    gchar *json;
+    gint   fd;
+
+    json = build_stats_json (self, ctx, error);
+
+    if (g_strcmp0 (self->priv->stats_file, "-") == 0) {
+        g_print ("%s", json);
+        g_free (json);
+        return;
+    }
+
+    fd = open (self->priv->stats_file, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0)
+        g_warning ("couldn't open statistics file '%s': %s", self->priv->stats_file, g_strerror (errno));
+    else {
+        /* Written at once so that lines from different writers aren't mixed */
+        if (write (fd, json, strlen (json)) < 0)
+            g_warning ("couldn't write statistics file '%s': %s", self->priv->stats_file, g_strerror (errno));
+        close (fd);
+    }
+    g_free (json);
+}
+
 gboolean
 qfu_updater_run_finish (QfuUpdater    *self,
                         GAsyncResult  *res,
                         GError       **error)
 {
-    return g_task_propagate_boolean (G_TASK (res), error);
+    GError   *inner_error = NULL;
+    gboolean  result;
+
+    result = g_task_propagate_boolean (G_TASK (res), &inner_error);
+
+    if (self->priv->stats_file)
+        write_stats (self, (RunContext *) g_task_get_task_data (G_TASK (res)), inner_error);
+
+    if (inner_error)
+        g_propagate_error (error, inner_error);
+    return result;
 }
 
 #if defined WITH_UDEV
 
 static void
-print_firmware_preference (QmiMessageDmsGetFirmwarePreferenceOutput *firmware_preference,
+print_firmware_preference (GTask                                    *task,
+                           QmiMessageDmsGetFirmwarePreferenceOutput *firmware_preference,
                            const gchar                              *prefix)
 {
     GArray *array;
@@ -231,11 +602,11 @@ print_firmware_preference (QmiMessageDmsGetFirmwarePreferenceOutput *firmware_pr
 
             image = &g_array_index (array, QmiMessageDmsGetFirmwarePreferenceOutputListImage, i);
             unique_id_str = qfu_utils_get_firmware_image_unique_id_printable (image->unique_id);
-            g_print ("%simage '%s': unique id '%s', build id '%s'\n",
-                     prefix,
-                     qmi_dms_firmware_image_type_get_string (image->type),
-                     unique_id_str,
-                     image->build_id);
+            updater_print (task, "%simage '%s': unique id '%s', build id '%s'\n",
+                                 prefix,
+                                 qmi_dms_firmware_image_type_get_string (image->type),
+                                 unique_id_str,
+                                 image->build_id);
             g_free (unique_id_str);
         }
     } else
@@ -243,7 +614,8 @@ print_firmware_preference (QmiMessageDmsGetFirmwarePreferenceOutput *firmware_pr
 }
 
 static void
-print_current_firmware (QmiMessageDmsSwiGetCurrentFirmwareOutput *current_firmware,
+print_current_firmware (GTask                                    *task,
+                        QmiMessageDmsSwiGetCurrentFirmwareOutput *current_firmware,
                         const gchar                              *prefix)
 {
     const gchar *model = NULL;
@@ -267,23 +639,62 @@ print_current_firmware (QmiMessageDmsSwiGetCurrentFirmwareOutput *current_firmwa
     qmi_message_dms_swi_get_current_firmware_output_get_config_version (current_firmware, &config_version, NULL);
 
     if (model)
-        g_print ("%sModel: %s\n", prefix, model);
+        updater_print (task, "%sModel: %s\n", prefix, model);
     if (boot_version)
-        g_print ("%sBoot version: %s\n", prefix, boot_version);
+        updater_print (task, "%sBoot version: %s\n", prefix, boot_version);
     if (amss_version)
-        g_print ("%sAMSS version: %s\n", prefix, amss_version);
+        updater_print (task, "%sAMSS version: %s\n", prefix, amss_version);
     if (sku_id)
-        g_print ("%sSKU ID: %s\n", prefix, sku_id);
+        updater_print (task, "%sSKU ID: %s\n", prefix, sku_id);
     if (package_id)
-        g_print ("%sPackage ID: %s\n", prefix, package_id);
+        updater_print (task, "%sPackage ID: %s\n", prefix, package_id);
     if (carrier_id)
-        g_print ("%sCarrier ID: %s\n", prefix, carrier_id);
+        updater_print (task, "%sCarrier ID: %s\n", prefix, carrier_id);
     if (config_version)
-        g_print ("%sConfig version: %s\n", prefix, config_version);
+        updater_print (task, "%sConfig version: %s\n", prefix, config_version);
 }
 
 #endif /* WITH_UDEV */
 
+static void
+run_context_wait_start (RunContext *ctx)
+{
+    if (!ctx->wait_timer)
+        ctx->wait_timer = g_timer_new ();
+    else
+        g_timer_start (ctx->wait_timer);
+}
+
+static void
+run_context_wait_done (RunContext *ctx,
+                       WaitPhase   phase)
+{
+    gdouble elapsed;
+
+    g_assert (ctx->wait_timer);
+    elapsed = g_timer_elapsed (ctx->wait_timer, NULL);
+    ctx->wait_secs[phase] += elapsed;
+    g_debug ("[qfu-updater] waited %.2lfs for %s", elapsed, wait_phase_str[phase]);
+}
+
+static void
+print_wait_times (GTask *task)
+{
+    RunContext *ctx;
+    guint       i;
+
+    ctx = (RunContext *) g_task_get_task_data (task);
+    if (!ctx->wait_timer)
+        return;
+
+    updater_print (task, "time spent waiting for the device:
+");
+    for (i = 0; i < WAIT_PHASE_LAST; i++) {
+        if (ctx->wait_secs[i] > 0)
+            updater_print (task, "   %s: %.2lfs\n", wait_phase_str[i], ctx->wait_secs[i]);
+    }
+}
+
 static void
 run_context_step_last (GTask *task)
 {
@@ -295,6 +706,8 @@ run_context_step_last (GTask *task)
 
     self = g_task_get_source_object (task);
 
+    print_wait_times (task);
+
     if (self->priv->type == UPDATER_TYPE_DOWNLOAD) {
         g_task_return_boolean (task, TRUE);
         g_object_unref (task);
@@ -303,51 +716,51 @@ run_context_step_last (GTask *task)
 
 #if defined WITH_UDEV
     if (self->priv->type == UPDATER_TYPE_GENERIC) {
-        g_print ("\n"
-                 "------------------------------------------------------------------------\n");
+        updater_print (task, "\n"
+                             "------------------------------------------------------------------------\n");
 
-        g_print ("\n"
-                 "   original firmware revision was:\n"
-                 "      %s\n", ctx->revision ? ctx->revision : "unknown");
+        updater_print (task, "\n"
+                             "   original firmware revision was:\n"
+                             "      %s\n", ctx->revision ? ctx->revision : "unknown");
         if (ctx->current_firmware) {
-            g_print ("   original running firmware details:\n");
-            print_current_firmware (ctx->current_firmware, "      ");
+            updater_print (task, "   original running firmware details:\n");
+            print_current_firmware (task, ctx->current_firmware, "      ");
         }
         if (ctx->firmware_preference) {
-            g_print ("   original firmware preference details:\n");
-            print_firmware_preference (ctx->firmware_preference, "      ");
+            updater_print (task, "   original firmware preference details:\n");
+            print_firmware_preference (task, ctx->firmware_preference, "      ");
         }
 
-        g_print ("\n"
-                 "   new firmware revision is:\n"
-                 "      %s\n", ctx->new_revision ? ctx->new_revision : "unknown");
+        updater_print (task, "\n"
+                             "   new firmware revision is:\n"
+                             "      %s\n", ctx->new_revision ? ctx->new_revision : "unknown");
         if (ctx->new_current_firmware) {
-            g_print ("   new running firmware details:\n");
-            print_current_firmware (ctx->new_current_firmware, "      ");
+            updater_print (task, "   new running firmware details:\n");
+            print_current_firmware (task, ctx->new_current_firmware, "      ");
         }
         if (ctx->new_firmware_preference) {
-            g_print ("   new firmware preference details:\n");
-            print_firmware_preference (ctx->new_firmware_preference, "      ");
+            updater_print (task, "   new firmware preference details:\n");
+            print_firmware_preference (task, ctx->new_firmware_preference, "      ");
         }
 
         if (ctx->new_supports_stored_image_management)
-            g_print ("\n"
-                     "   NOTE: this device supports stored image management\n"
-                     "   with qmicli operations:\n"
-                     "      --dms-list-stored-images\n"
-                     "      --dms-select-stored-image\n"
-                     "      --dms-delete-stored-image\n");
+            updater_print (task, "\n"
+                                 "   NOTE: this device supports stored image management\n"
+                                 "   with qmicli operations:\n"
+                                 "      --dms-list-stored-images\n"
+                                 "      --dms-select-stored-image\n"
+                                 "      --dms-delete-stored-image\n");
 
         if (ctx->new_supports_firmware_preference_management)
-            g_print ("\n"
-                     "   NOTE: this device supports firmware preference management\n"
-                     "   with qmicli operations:\n"
-                     "      --dms-get-firmware-preference\n"
-                     "      --dms-set-firmware-preference\n");
+            updater_print (task, "\n"
+                                 "   NOTE: this device supports firmware preference management\n"
+                                 "   with qmicli operations:\n"
+                                 "      --dms-get-firmware-preference\n"
+                                 "      --dms-set-firmware-preference\n");
 
-        g_print ("\n"
-                 "------------------------------------------------------------------------\n"
-                 "\n");
+        updater_print (task, "\n"
+                             "------------------------------------------------------------------------\n"
+                             "\n");
 
         g_task_return_boolean (task, TRUE);
         g_object_unref (task);
@@ -478,8 +891,9 @@ new_client_dms_after_ready (gpointer      unused,
                                           &ctx->new_firmware_preference,
                                           &ctx->new_current_firmware,
                                           &error)) {
-        if (ctx->wait_for_boot_retries == WAIT_FOR_BOOT_RETRIES) {
+        if (g_timer_elapsed (ctx->wait_for_boot_timer, NULL) >= WAIT_FOR_BOOT_TIMEOUT_SECS) {
             g_warning ("couldn't create DMS client after upgrade: %s", error->message);
+            run_context_wait_done (ctx, WAIT_PHASE_BOOT);
             run_context_step_next (task, ctx->step + 1);
         } else {
             g_debug ("couldn't create DMS client after upgrade: %s (will retry)", error->message);
@@ -489,6 +903,8 @@ new_client_dms_after_ready (gpointer      unused,
         return;
     }
 
+    run_context_wait_done (ctx, WAIT_PHASE_BOOT);
+
     /* Go on */
     run_context_step_next (task, ctx->step + 1);
 }
@@ -503,8 +919,10 @@ run_context_step_qmi_client_after (GTask *task)
     self = g_task_get_source_object (task);
 
     ctx->wait_for_boot_retries++;
-    g_print ("loading device information after the update (%u/%u)...\n",
-             ctx->wait_for_boot_retries, WAIT_FOR_BOOT_RETRIES);
+    if (ctx->wait_for_boot_retries == 1)
+        updater_print (task, "loading device information after the update...\n");
+    g_debug ("[qfu-updater] probing device after the update (attempt %u, %.2lfs elapsed)...",
+             ctx->wait_for_boot_retries, g_timer_elapsed (ctx->wait_for_boot_timer, NULL));
 
     g_debug ("[qfu-updater] creating QMI DMS client after upgrade...");
     g_assert (ctx->cdc_wdm_file);
@@ -523,21 +941,12 @@ wait_for_boot_ready (GTask *task)
     RunContext *ctx;
 
     ctx = (RunContext *) g_task_get_task_data (task);
-    ctx->wait_for_boot_seconds_elapsed++;
-
-    if (ctx->wait_for_boot_seconds_elapsed < WAIT_FOR_BOOT_TIMEOUT_SECS) {
-        if (!qfu_log_get_verbose_stdout ())
-            g_print (CLEAR_LINE "%s %u",
-                     progress[ctx->wait_for_boot_seconds_elapsed % G_N_ELEMENTS (progress)],
-                     WAIT_FOR_BOOT_TIMEOUT_SECS - ctx->wait_for_boot_seconds_elapsed);
-        return G_SOURCE_CONTINUE;
-    }
 
-    if (!qfu_log_get_verbose_stdout ())
-        g_print (CLEAR_LINE);
+    /* Next probe waits twice as long, up to a limit */
+    ctx->wait_for_boot_delay_ms = MIN (ctx->wait_for_boot_delay_ms * 2, WAIT_FOR_BOOT_MAX_DELAY_MS);
 
     /* Go on */
-    run_context_step_next (task, ctx->step + 1);
+    run_context_step_next_no_idle (task, ctx->step + 1);
     return G_SOURCE_REMOVE;
 }
 
@@ -547,17 +956,20 @@ run_context_step_wait_for_boot (GTask *task)
     RunContext *ctx;
 
     ctx = (RunContext *) g_task_get_task_data (task);
-    ctx->wait_for_boot_seconds_elapsed = 0;
 
-    g_debug ("[qfu-updater] waiting some time (%us) before accessing the cdc-wdm device...",
-             WAIT_FOR_BOOT_TIMEOUT_SECS);
-
-    if (!qfu_log_get_verbose_stdout ()) {
-        g_print ("waiting some time for the device to boot...\n");
-        g_print ("%s %u", progress[0], WAIT_FOR_BOOT_TIMEOUT_SECS);
+    /* The first probe is done right away, as soon as the cdc-wdm port is
+     * exposed; further ones only if the device isn't ready yet */
+    if (!ctx->wait_for_boot_timer) {
+        ctx->wait_for_boot_timer = g_timer_new ();
+        ctx->wait_for_boot_delay_ms = WAIT_FOR_BOOT_INITIAL_DELAY_MS;
+        run_context_wait_start (ctx);
+        run_context_step_next_no_idle (task, ctx->step + 1);
+        return;
     }
 
-    g_timeout_add_seconds (1, (GSourceFunc) wait_for_boot_ready, task);
+    g_debug ("[qfu-updater] device not ready yet, probing again in %ums...",
+             ctx->wait_for_boot_delay_ms);
+    g_timeout_add (ctx->wait_for_boot_delay_ms, (GSourceFunc) wait_for_boot_ready, task);
 }
 
 static void
@@ -575,6 +987,7 @@ wait_for_cdc_wdm_ready (QfuDeviceSelection *device_selection,
 
     g_assert (!ctx->cdc_wdm_file);
     ctx->cdc_wdm_file = qfu_device_selection_wait_for_cdc_wdm_finish (device_selection, res, &error);
+    run_context_wait_done (ctx, WAIT_PHASE_CDC_WDM);
     if (!ctx->cdc_wdm_file) {
         g_prefix_error (&error, "error waiting for cdc-wdm: ");
         g_task_return_error (task, error);
@@ -586,7 +999,7 @@ wait_for_cdc_wdm_ready (QfuDeviceSelection *device_selection,
     g_debug ("[qfu-updater] cdc-wdm device found: %s", path);
     g_free (path);
 
-    g_print ("normal mode detected\n");
+    updater_print (task, "normal mode detected\n");
 
     /* If no need to validate, we're done */
     if (self->priv->skip_validation) {
@@ -594,13 +1007,13 @@ wait_for_cdc_wdm_ready (QfuDeviceSelection *device_selection,
         return;
     }
 
-    g_print ("\n"
-             "------------------------------------------------------------------------\n"
-             "    NOTE: in order to validate which is the firmware running in the\n"
-             "    module, the program will wait for a complete boot; this process\n"
-             "    may take some time and several retries.\n"
-             "------------------------------------------------------------------------\n"
-             "\n");
+    updater_print (task, "\n"
+                         "------------------------------------------------------------------------\n"
+                         "    NOTE: in order to validate which is the firmware running in the\n"
+                         "    module, the program will wait for a complete boot; this process\n"
+                         "    may take some time and several retries.\n"
+                         "------------------------------------------------------------------------\n"
+                         "\n");
 
     /* Go on */
     run_context_step_next (task, ctx->step + 1);
@@ -614,6 +1027,7 @@ run_context_step_wait_for_cdc_wdm (GTask *task)
     self = g_task_get_source_object (task);
 
     g_debug ("[qfu-updater] now waiting for cdc-wdm device...");
+    run_context_wait_start ((RunContext *) g_task_get_task_data (task));
 
     qfu_device_selection_wait_for_cdc_wdm (self->priv->device_selection,
                                            g_task_get_cancellable (task),
@@ -623,8 +1037,29 @@ run_context_step_wait_for_cdc_wdm (GTask *task)
 
 #endif /* WITH_UDEV */
 
+/* Resetting the device may need to wait for a response for some time */
 static void
-run_context_step_cleanup_device (GTask *task)
+cleanup_device_thread (GTask        *thread_task,
+                       GObject      *device,
+                       gpointer      unused,
+                       GCancellable *cancellable)
+{
+    if (QFU_IS_QDL_DEVICE (device)) {
+        g_debug ("[qfu-updater] QDL reset");
+        qfu_qdl_device_reset (QFU_QDL_DEVICE (device), cancellable, NULL);
+    } else if (QFU_IS_SAHARA_DEVICE (device)) {
+        g_debug ("[qfu-updater] firehose reset");
+        qfu_sahara_device_firehose_reset (QFU_SAHARA_DEVICE (device), cancellable, NULL);
+    } else
+        g_assert_not_reached ();
+
+    g_task_return_boolean (thread_task, TRUE);
+}
+
+static void
+cleanup_device_ready (GObject      *device,
+                      GAsyncResult *res,
+                      GTask        *task)
 {
     RunContext *ctx;
     QfuUpdater *self;
@@ -632,22 +1067,11 @@ run_context_step_cleanup_device (GTask *task)
     ctx = (RunContext *) g_task_get_task_data (task);
     self = g_task_get_source_object (task);
 
-    g_assert (ctx->serial_file);
-
-    if (ctx->qdl_device) {
-        g_debug ("[qfu-updater] QDL reset");
-        qfu_qdl_device_reset (ctx->qdl_device, g_task_get_cancellable (task), NULL);
-        g_clear_object (&ctx->qdl_device);
-    } else if (ctx->sahara_device) {
-        g_debug ("[qfu-updater] firehose reset");
-        qfu_sahara_device_firehose_reset (ctx->sahara_device, g_task_get_cancellable (task), NULL);
-        g_clear_object (&ctx->sahara_device);
-    } else
-        g_assert_not_reached ();
-
+    /* Errors are ignored, the device may reboot before replying */
+    g_task_propagate_boolean (G_TASK (res), NULL);
     g_clear_object (&ctx->serial_file);
 
-    g_print ("rebooting in normal mode...\n");
+    updater_print (task, "rebooting in normal mode...\n");
 
     /* If we were running in download mode, we don't even wait for the reboot to finish */
     if (self->priv->type == UPDATER_TYPE_DOWNLOAD) {
@@ -658,6 +1082,30 @@ run_context_step_cleanup_device (GTask *task)
     run_context_step_next (task, ctx->step + 1);
 }
 
+static void
+run_context_step_cleanup_device (GTask *task)
+{
+    RunContext *ctx;
+    GObject    *device;
+    GTask      *thread_task;
+
+    ctx = (RunContext *) g_task_get_task_data (task);
+
+    g_assert (ctx->serial_file);
+
+    if (ctx->qdl_device)
+        device = G_OBJECT (g_steal_pointer (&ctx->qdl_device));
+    else if (ctx->sahara_device)
+        device = G_OBJECT (g_steal_pointer (&ctx->sahara_device));
+    else
+        g_assert_not_reached ();
+
+    thread_task = g_task_new (device, g_task_get_cancellable (task), (GAsyncReadyCallback) cleanup_device_ready, task);
+    g_task_run_in_thread (thread_task, (GTaskThreadFunc) cleanup_device_thread);
+    g_object_unref (thread_task);
+    g_object_unref (device);
+}
+
 static void
 run_context_step_cleanup_image (GTask *task)
 {
@@ -682,19 +1130,25 @@ run_context_step_cleanup_image (GTask *task)
 static gboolean
 download_image_firehose (QfuSaharaDevice  *device,
                          QfuImage         *image,
+                         gboolean         show_progress,
+                         ImageStats       *stats,
                          GCancellable     *cancellable,
                          GError          **error)
 {
-    guint sequence;
-    guint n_blocks;
+    guint   sequence;
+    guint   n_blocks;
+    goffset block_size;
 
     if (!qfu_sahara_device_firehose_setup_download (device, image, &n_blocks, cancellable, error)) {
         g_prefix_error (error, "couldn't prepare download: ");
         return FALSE;
     }
 
+    /* All blocks but the last one are full-sized */
+    block_size = n_blocks ? (stats->size + n_blocks - 1) / n_blocks : 0;
+
     for (sequence = 0; sequence < n_blocks; sequence++) {
-        if (!qfu_log_get_verbose_stdout ()) {
+        if (show_progress) {
             if (n_blocks > 1) {
                 g_print (CLEAR_LINE "%s %04.1lf%%",
                          progress[sequence % G_N_ELEMENTS (progress)],
@@ -705,11 +1159,13 @@ download_image_firehose (QfuSaharaDevice  *device,
             g_prefix_error (error, "couldn't write in session: ");
             return FALSE;
         }
+        image_stats_update (stats, MIN (stats->size, (sequence + 1) * block_size));
     }
 
+    image_stats_transfer_done (stats, stats->size);
     g_debug ("[qfu-updater] all blocks downloaded");
 
-    if (!qfu_log_get_verbose_stdout ())
+    if (show_progress)
         g_print (CLEAR_LINE "finalizing download... (may take several minutes, be patient)\n");
 
     if (!qfu_sahara_device_firehose_teardown_download (device, image, cancellable, error)) {
@@ -717,16 +1173,87 @@ download_image_firehose (QfuSaharaDevice  *device,
         return FALSE;
     }
 
-    if (!qfu_log_get_verbose_stdout ())
+    if (show_progress)
         g_print (CLEAR_LINE);
 
     g_debug ("[qfu-updater] sahara/firehose download finished");
     return TRUE;
 }
 
+/* Number of times the sender may go back to the first chunk not yet acked
+ * when a windowed download fails */
+#define QDL_WINDOWED_MAX_REWINDS 3
+
+static gboolean
+download_image_qdl_windowed (QfuQdlDevice  *device,
+                             QfuImage      *image,
+                             gboolean       show_progress,
+                             ImageStats    *stats,
+                             guint8         window_size,
+                             GCancellable  *cancellable,
+                             GError       **error)
+{
+    guint16 n_chunks;
+    goffset data_size;
+    guint   next;
+    guint   first_unacked;
+    guint   n_rewinds = 0;
+
+    n_chunks = qfu_image_get_n_data_chunks (image);
+    data_size = qfu_image_get_data_size (image);
+    next = first_unacked = 0;
+    while (first_unacked < n_chunks) {
+        GError  *inner_error = NULL;
+        guint16  ack_sequence = 0;
+
+        /* Fill the window */
+        while (next < n_chunks && (next - first_unacked) < window_size) {
+            if (show_progress) {
+                if (n_chunks > 1 && next < (guint)(n_chunks - 1))
+                    g_print (CLEAR_LINE "%s %04.1lf%%",
+                             progress[next % G_N_ELEMENTS (progress)],
+                             100.0 * ((gdouble) next / (gdouble) (n_chunks - 1)));
+                else if (next == (guint)(n_chunks - 1))
+                    g_print (CLEAR_LINE "finalizing download... (may take more than one minute, be patient)\n");
+            }
+            if (!qfu_qdl_device_ufwrite_send (device, image, (guint16) next, cancellable, error)) {
+                g_prefix_error (error, "couldn't write in session: ");
+                return FALSE;
+            }
+            next++;
+        }
+
+        if (!qfu_qdl_device_ufwrite_wait_ack (device, &ack_sequence, cancellable, &inner_error)) {
+            if (g_error_matches (inner_error, G_IO_ERROR, G_IO_ERROR_CANCELLED) || ++n_rewinds > QDL_WINDOWED_MAX_REWINDS) {
+                g_propagate_prefixed_error (error, inner_error, "couldn't write in session: ");
+                return FALSE;
+            }
+            g_debug ("[qfu-updater] rewinding to chunk #%u: %s", first_unacked, inner_error->message);
+            g_error_free (inner_error);
+            stats->n_retries++;
+            next = first_unacked;
+            continue;
+        }
+
+        /* Acks are cumulative; ignore the ones of chunks not in flight, e.g.
+         * those sent before a rewind */
+        if (ack_sequence < first_unacked || ack_sequence >= next) {
+            g_debug ("[qfu-updater] ignoring ack for chunk #%" G_GUINT16_FORMAT, ack_sequence);
+            continue;
+        }
+        first_unacked = ack_sequence + 1;
+        image_stats_update (stats, MIN (data_size, (goffset) first_unacked * QFU_IMAGE_CHUNK_SIZE));
+    }
+
+    return TRUE;
+}
+
 static gboolean
 download_image_qdl (QfuQdlDevice  *device,
                     QfuImage      *image,
+                    gboolean       show_progress,
+                    ImageStats    *stats,
+                    guint8         window_size,
                     GCancellable  *cancellable,
                     GError       **error)
 {
@@ -738,32 +1265,41 @@ download_image_qdl (QfuQdlDevice  *device,
         return FALSE;
     }
 
-    if (!qfu_qdl_device_ufopen (device, image, cancellable, error)) {
+    if (!qfu_qdl_device_ufopen (device, image, window_size, &window_size, cancellable, error)) {
         g_prefix_error (error, "couldn't open session: ");
         return FALSE;
     }
 
-    n_chunks = qfu_image_get_n_data_chunks (image);
-    for (sequence = 0; sequence < n_chunks; sequence++) {
-        if (!qfu_log_get_verbose_stdout ()) {
-            /* Use n-1 chunks for progress reporting; because the last one will take
-             * a lot longer. */
-            if (n_chunks > 1 && sequence < (n_chunks - 1))
-                g_print (CLEAR_LINE "%s %04.1lf%%",
-                         progress[sequence % G_N_ELEMENTS (progress)],
-                         100.0 * ((gdouble) sequence / (gdouble) (n_chunks - 1)));
-            else if (sequence == (n_chunks - 1))
-                g_print (CLEAR_LINE "finalizing download... (may take more than one minute, be patient)\n");
-        }
-        if (!qfu_qdl_device_ufwrite (device, image, sequence, cancellable, error)) {
-            g_prefix_error (error, "couldn't write in session: ");
+    if (window_size > 1) {
+        g_debug ("[qfu-updater] sending up to %u chunks before waiting for acks", window_size);
+        if (!download_image_qdl_windowed (device, image, show_progress, stats, window_size, cancellable, error))
             return FALSE;
+    } else {
+        n_chunks = qfu_image_get_n_data_chunks (image);
+        for (sequence = 0; sequence < n_chunks; sequence++) {
+            if (show_progress) {
+                /* Use n-1 chunks for progress reporting; because the last one will take
+                 * a lot longer. */
+                if (n_chunks > 1 && sequence < (n_chunks - 1))
+                    g_print (CLEAR_LINE "%s %04.1lf%%",
+                             progress[sequence % G_N_ELEMENTS (progress)],
+                             100.0 * ((gdouble) sequence / (gdouble) (n_chunks - 1)));
+                else if (sequence == (n_chunks - 1))
+                    g_print (CLEAR_LINE "finalizing download... (may take more than one minute, be patient)\n");
+            }
+            if (!qfu_qdl_device_ufwrite (device, image, sequence, cancellable, error)) {
+                g_prefix_error (error, "couldn't write in session: ");
+                return FALSE;
+            }
+            image_stats_update (stats, MIN (qfu_image_get_data_size (image),
+                                            (goffset) (sequence + 1) * QFU_IMAGE_CHUNK_SIZE));
         }
     }
 
+    image_stats_transfer_done (stats, qfu_image_get_data_size (image));
     g_debug ("[qfu-updater] all chunks ack-ed");
 
-    if (!qfu_log_get_verbose_stdout ())
+    if (show_progress)
         g_print (CLEAR_LINE);
 
     if (!qfu_qdl_device_ufclose (device, cancellable, error)) {
@@ -775,61 +1311,129 @@ download_image_qdl (QfuQdlDevice  *device,
     return TRUE;
 }
 
+/* The download is a long sequence of blocking operations on the port, so
+ * it's run in a thread; the device and image aren't used from the main
+ * thread in the meantime. */
+typedef struct {
+    QfuQdlDevice    *qdl_device;
+    QfuSaharaDevice *sahara_device;
+    QfuImage        *image;
+    ImageStats      *stats;
+    gboolean         show_progress;
+    guint8           qdl_window_size;
+} DownloadImageContext;
+
 static void
-run_context_step_download_image (GTask *task)
+download_image_context_free (DownloadImageContext *ctx)
 {
-    RunContext   *ctx;
-    GError       *error = NULL;
-    GCancellable *cancellable;
-    GTimer       *timer;
-    gdouble       elapsed;
-    gchar        *aux;
-
-    ctx = (RunContext *) g_task_get_task_data (task);
-    cancellable = g_task_get_cancellable (task);
-
-    timer = g_timer_new ();
+    g_clear_object (&ctx->qdl_device);
+    g_clear_object (&ctx->sahara_device);
+    g_object_unref (ctx->image);
+    g_slice_free (DownloadImageContext, ctx);
+}
 
-    aux = g_format_size ((guint64) qfu_image_get_size (ctx->current_image));
-    g_print ("downloading %s image: %s (%s)...\n",
-             qfu_image_type_get_string (qfu_image_get_image_type (ctx->current_image)),
-             qfu_image_get_display_name (ctx->current_image),
-             aux);
-    g_free (aux);
+static void
+download_image_thread (GTask                *thread_task,
+                       gpointer              unused,
+                       DownloadImageContext *ctx,
+                       GCancellable         *cancellable)
+{
+    GError   *error = NULL;
+    gboolean  result = FALSE;
 
     /* QDL/SDP based download */
     if (ctx->qdl_device)
-        download_image_qdl (ctx->qdl_device,
-                            ctx->current_image,
-                            cancellable,
-                            &error);
+        result = download_image_qdl (ctx->qdl_device,
+                                     ctx->image,
+                                     ctx->show_progress,
+                                     ctx->stats,
+                                     ctx->qdl_window_size,
+                                     cancellable,
+                                     &error);
     /* Sahara based download */
     else if (ctx->sahara_device)
-        download_image_firehose (ctx->sahara_device,
-                                 ctx->current_image,
-                                 cancellable,
-                                 &error);
+        result = download_image_firehose (ctx->sahara_device,
+                                          ctx->image,
+                                          ctx->show_progress,
+                                          ctx->stats,
+                                          cancellable,
+                                          &error);
     else
         g_assert_not_reached ();
 
-    elapsed = g_timer_elapsed (timer, NULL);
+    if (!result)
+        g_task_return_error (thread_task, error);
+    else
+        g_task_return_boolean (thread_task, TRUE);
+}
 
-    g_timer_destroy (timer);
+static void
+download_image_ready (GObject      *unused,
+                      GAsyncResult *res,
+                      GTask        *task)
+{
+    RunContext *ctx;
+    ImageStats *stats;
+    GError     *error = NULL;
+    gchar      *aux;
 
-    if (error) {
+    ctx = (RunContext *) g_task_get_task_data (task);
+    stats = g_ptr_array_index (ctx->image_stats, ctx->image_stats->len - 1);
+
+    stats->total_secs = (gdouble) (g_get_monotonic_time () - stats->start_time) / G_USEC_PER_SEC;
+    if (ctx->sahara_device)
+        stats->n_retries += qfu_sahara_device_get_n_firehose_retries (ctx->sahara_device) - ctx->n_firehose_retries;
+
+    if (!g_task_propagate_boolean (G_TASK (res), &error)) {
         g_prefix_error (&error, "error downloading image: ");
         g_task_return_error (task, error);
+        g_object_unref (task);
         return;
     }
 
-    aux = g_format_size ((guint64) ((qfu_image_get_size (ctx->current_image)) / elapsed));
-    g_print ("successfully downloaded in %.2lfs (%s/s)\n", elapsed, aux);
+    aux = g_format_size ((guint64) ((qfu_image_get_size (ctx->current_image)) / stats->total_secs));
+    updater_print (task, "successfully downloaded in %.2lfs (%s/s)\n", stats->total_secs, aux);
     g_free (aux);
 
     /* Go on */
     run_context_step_next (task, ctx->step + 1);
 }
 
+static void
+run_context_step_download_image (GTask *task)
+{
+    RunContext           *ctx;
+    DownloadImageContext *download_ctx;
+    GTask                *thread_task;
+    gchar                *aux;
+
+    ctx = (RunContext *) g_task_get_task_data (task);
+
+    download_ctx = g_slice_new0 (DownloadImageContext);
+    download_ctx->qdl_device      = ctx->qdl_device ? g_object_ref (ctx->qdl_device) : NULL;
+    download_ctx->sahara_device   = ctx->sahara_device ? g_object_ref (ctx->sahara_device) : NULL;
+    download_ctx->image           = g_object_ref (ctx->current_image);
+    download_ctx->show_progress   = updater_show_progress (task);
+    download_ctx->qdl_window_size = QFU_UPDATER (g_task_get_source_object (task))->priv->qdl_window_size;
+    download_ctx->stats           = image_stats_new (ctx->current_image, ctx->qdl_device ? "qdl" : "firehose");
+    g_ptr_array_add (ctx->image_stats, download_ctx->stats);
+
+    if (ctx->sahara_device)
+        ctx->n_firehose_retries = qfu_sahara_device_get_n_firehose_retries (ctx->sahara_device);
+
+    aux = g_format_size ((guint64) qfu_image_get_size (ctx->current_image));
+    updater_print (task, "downloading %s image: %s (%s)...\n",
+                         qfu_image_type_get_string (qfu_image_get_image_type (ctx->current_image)),
+                         qfu_image_get_display_name (ctx->current_image),
+                         aux);
+    g_free (aux);
+
+    thread_task = g_task_new (NULL, g_task_get_cancellable (task), (GAsyncReadyCallback) download_image_ready, task);
+    g_task_set_task_data (thread_task, download_ctx, (GDestroyNotify) download_image_context_free);
+    g_task_run_in_thread (thread_task, (GTaskThreadFunc) download_image_thread);
+    g_object_unref (thread_task);
+}
+
 static void
 run_context_step_select_image (GTask *task)
 {
@@ -853,39 +1457,87 @@ run_context_step_select_image (GTask *task)
 }
 
 static void
-run_context_step_select_device (GTask *task)
+select_device_finish (GTask *task)
+{
+    RunContext *ctx;
+
+    ctx = (RunContext *) g_task_get_task_data (task);
+
+    run_context_wait_done (ctx, WAIT_PHASE_DOWNLOAD_PROTOCOL);
+
+    if (!ctx->qdl_device && !ctx->sahara_device) {
+        g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_FAILED, "unsupported download protocol");
+        g_object_unref (task);
+        return;
+    }
+
+    run_context_step_next (task, ctx->step + 1);
+}
+
+static void
+qdl_device_new_ready (GObject      *unused,
+                      GAsyncResult *res,
+                      GTask        *task)
 {
     RunContext *ctx;
     GError     *error = NULL;
 
     ctx = (RunContext *) g_task_get_task_data (task);
 
-    g_assert (ctx->serial_file);
-    g_assert (!ctx->qdl_device);
-    g_assert (!ctx->sahara_device);
+    ctx->qdl_device = qfu_qdl_device_new_finish (res, &error);
+    if (!ctx->qdl_device) {
+        g_debug ("[qfu-updater] qdl device creation failed: %s", error->message);
+        g_clear_error (&error);
+    }
 
-    /* Check if we can setup a Sahara device. Always check this first, because
-     * the sahara stack is very sensitive to any kind of data sent to the port. */
-    ctx->sahara_device = qfu_sahara_device_new (ctx->serial_file, g_task_get_cancellable (task), &error);
+    select_device_finish (task);
+}
+
+static void
+sahara_device_new_ready (GObject      *unused,
+                         GAsyncResult *res,
+                         GTask        *task)
+{
+    RunContext *ctx;
+    GError     *error = NULL;
+
+    ctx = (RunContext *) g_task_get_task_data (task);
+
+    ctx->sahara_device = qfu_sahara_device_new_finish (res, &error);
     if (!ctx->sahara_device) {
         g_debug ("[qfu-updater] sahara device creation failed: %s", error->message);
         g_clear_error (&error);
 
         /* Check if we can setup a QDL device */
-        ctx->qdl_device = qfu_qdl_device_new (ctx->serial_file, g_task_get_cancellable (task), &error);
-        if (!ctx->qdl_device) {
-            g_debug ("[qfu-updater] qdl device creation failed: %s", error->message);
-            g_clear_error (&error);
-        }
-    }
-
-    if (!ctx->qdl_device && !ctx->sahara_device) {
-        g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_FAILED, "unsupported download protocol");
-        g_object_unref (task);
+        qfu_qdl_device_new_async (ctx->serial_file,
+                                  g_task_get_cancellable (task),
+                                  (GAsyncReadyCallback) qdl_device_new_ready,
+                                  task);
         return;
     }
 
-    run_context_step_next (task, ctx->step + 1);
+    select_device_finish (task);
+}
+
+static void
+run_context_step_select_device (GTask *task)
+{
+    RunContext *ctx;
+
+    ctx = (RunContext *) g_task_get_task_data (task);
+
+    g_assert (ctx->serial_file);
+    g_assert (!ctx->qdl_device);
+    g_assert (!ctx->sahara_device);
+
+    run_context_wait_start (ctx);
+
+    /* Check if we can setup a Sahara device. Always check this first, because
+     * the sahara stack is very sensitive to any kind of data sent to the port. */
+    qfu_sahara_device_new_async (ctx->serial_file,
+                                 g_task_get_cancellable (task),
+                                 (GAsyncReadyCallback) sahara_device_new_ready,
+                                 task);
 }
 
 #if defined WITH_UDEV
@@ -903,6 +1555,7 @@ wait_for_tty_ready (QfuDeviceSelection *device_selection,
 
     g_assert (!ctx->serial_file);
     ctx->serial_file = qfu_device_selection_wait_for_tty_finish (device_selection, res, &error);
+    run_context_wait_done (ctx, WAIT_PHASE_TTY);
     if (!ctx->serial_file) {
         g_prefix_error (&error, "error waiting for TTY: ");
         g_task_return_error (task, error);
@@ -914,7 +1567,7 @@ wait_for_tty_ready (QfuDeviceSelection *device_selection,
     g_debug ("[qfu-updater] TTY device found: %s", path);
     g_free (path);
 
-    g_print ("download mode detected\n");
+    updater_print (task, "download mode detected\n");
 
     /* Go on */
     run_context_step_next (task, ctx->step + 1);
@@ -927,9 +1580,10 @@ run_context_step_wait_for_tty (GTask *task)
 
     self = g_task_get_source_object (task);
 
-    g_print ("rebooting in download mode...\n");
+    updater_print (task, "rebooting in download mode...\n");
 
     g_debug ("[qfu-updater] reset requested, now waiting for TTY device...");
+    run_context_wait_start ((RunContext *) g_task_get_task_data (task));
     qfu_device_selection_wait_for_tty (self->priv->device_selection,
                                        g_task_get_cancellable (task),
                                        (GAsyncReadyCallback) wait_for_tty_ready,
@@ -1089,9 +1743,9 @@ set_firmware_preference_ready (QmiClientDms *client,
     /* list images we need to download? */
     if (qmi_message_dms_set_firmware_preference_output_get_image_download_list (output, &array, &error)) {
         if (!array->len) {
-            g_print ("device already contains the given firmware/config version: no download needed\n");
-            g_print ("forcing the download may be requested with the --override-download option\n");
-            g_print ("now power cycling to apply the new firmware preference...\n");
+            updater_print (task, "device already contains the given firmware/config version: no download needed\n");
+            updater_print (task, "forcing the download may be requested with the --override-download option\n");
+            updater_print (task, "now power cycling to apply the new firmware preference...\n");
             g_list_free_full (ctx->pending_images, g_object_unref);
             ctx->pending_images = NULL;
         } else {
@@ -1142,10 +1796,10 @@ run_context_step_set_firmware_preference (GTask *task)
     g_assert (config_version);
     g_assert (carrier);
 
-    g_print ("setting firmware preference:\n");
-    g_print ("  firmware version: '%s'\n", firmware_version);
-    g_print ("  config version:   '%s'\n", config_version);
-    g_print ("  carrier:          '%s'\n", carrier);
+    updater_print (task, "setting firmware preference:\n");
+    updater_print (task, "  firmware version: '%s'\n", firmware_version);
+    updater_print (task, "  config version:   '%s'\n", config_version);
+    updater_print (task, "  carrier:          '%s'\n", carrier);
 
     /* Set modem image info */
     modem_image_id.type = QMI_DMS_FIRMWARE_IMAGE_TYPE_MODEM;
@@ -1433,7 +2087,7 @@ run_context_step_qmi_client (GTask *task)
     ctx = (RunContext *) g_task_get_task_data (task);
     self = g_task_get_source_object (task);
 
-    g_print ("loading device information before the update...\n");
+    updater_print (task, "loading device information before the update...\n");
 
     g_debug ("[qfu-updater] creating QMI DMS client...");
     g_assert (ctx->cdc_wdm_file);
@@ -1486,6 +2140,8 @@ run_context_step (GTask *task)
         return;
     }
 
+    run_context_step_timing_update (ctx, g_get_monotonic_time ());
+
     if (ctx->step < G_N_ELEMENTS (run_context_step_func)) {
         run_context_step_func [ctx->step] (task);
         return;
@@ -1527,29 +2183,18 @@ preload_images (RunContext    *ctx,
     return TRUE;
 }
 
-void
-qfu_updater_run (QfuUpdater          *self,
-                 GList               *image_file_list,
-                 GCancellable        *cancellable,
-                 GAsyncReadyCallback  callback,
-                 gpointer             user_data)
+static void
+run_context_start (GTask *task)
 {
+    QfuUpdater *self;
     RunContext *ctx;
-    GTask      *task;
-    GError     *error = NULL;
-
-    g_assert (image_file_list);
 
-    ctx = g_slice_new0 (RunContext);
-
-    task = g_task_new (self, cancellable, callback, user_data);
-    g_task_set_task_data (task, ctx, (GDestroyNotify) run_context_free);
+    self = g_task_get_source_object (task);
+    ctx = (RunContext *) g_task_get_task_data (task);
 
-    if (!preload_images (ctx, image_file_list, cancellable, &error)) {
-        g_task_return_error (task, error);
-        g_object_unref (task);
-        return;
-    }
+    ctx->start_time = g_get_monotonic_time ();
+    ctx->step_timed = RUN_CONTEXT_STEP_LAST;
+    ctx->image_stats = g_ptr_array_new_with_free_func ((GDestroyNotify) image_stats_free);
 
     switch (self->priv->type) {
 #if defined WITH_UDEV
@@ -1582,6 +2227,57 @@ qfu_updater_run (QfuUpdater          *self,
     run_context_step (task);
 }
 
+void
+qfu_updater_run (QfuUpdater          *self,
+                 GList               *image_file_list,
+                 GCancellable        *cancellable,
+                 GAsyncReadyCallback  callback,
+                 gpointer             user_data)
+{
+    RunContext *ctx;
+    GTask      *task;
+    GError     *error = NULL;
+
+    g_assert (image_file_list);
+
+    ctx = g_slice_new0 (RunContext);
+
+    task = g_task_new (self, cancellable, callback, user_data);
+    g_task_set_task_data (task, ctx, (GDestroyNotify) run_context_free);
+
+    if (!preload_images (ctx, image_file_list, cancellable, &error)) {
+        g_task_return_error (task, error);
+        g_object_unref (task);
+        return;
+    }
+
+    run_context_start (task);
+}
+
+void
+qfu_updater_run_images (QfuUpdater          *self,
+                        GList               *images,
+                        GCancellable        *cancellable,
+                        GAsyncReadyCallback  callback,
+                        gpointer             user_data)
+{
+    RunContext *ctx;
+    GTask      *task;
+
+    g_assert (images);
+
+    ctx = g_slice_new0 (RunContext);
+
+    task = g_task_new (self, cancellable, callback, user_data);
+    g_task_set_task_data (task, ctx, (GDestroyNotify) run_context_free);
+
+    /* Images already loaded, possibly shared with other updaters */
+    ctx->pending_images = g_list_copy_deep (images, (GCopyFunc) g_object_ref, NULL);
+    ctx->pending_images = g_list_sort (ctx->pending_images, (GCompareFunc) image_sort_by_size);
+
+    run_context_start (task);
+}
+
 /******************************************************************************/
 
 #if defined WITH_UDEV
@@ -1632,11 +2328,42 @@ qfu_updater_new_download (QfuDeviceSelection *device_selection)
     return self;
 }
 
+void
+qfu_updater_set_label (QfuUpdater  *self,
+                       const gchar *label)
+{
+    g_return_if_fail (QFU_IS_UPDATER (self));
+
+    g_free (self->priv->label);
+    self->priv->label = g_strdup (label);
+}
+
+void
+qfu_updater_set_stats_file (QfuUpdater  *self,
+                            const gchar *path)
+{
+    g_return_if_fail (QFU_IS_UPDATER (self));
+
+    g_free (self->priv->stats_file);
+    self->priv->stats_file = g_strdup (path);
+}
+
+void
+qfu_updater_set_qdl_window_size (QfuUpdater *self,
+                                 guint8      window_size)
+{
+    g_return_if_fail (QFU_IS_UPDATER (self));
+    g_return_if_fail (window_size > 0);
+
+    self->priv->qdl_window_size = window_size;
+}
+
 static void
 qfu_updater_init (QfuUpdater *self)
 {
     self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self, QFU_TYPE_UPDATER, QfuUpdaterPrivate);
     self->priv->type = UPDATER_TYPE_UNKNOWN;
+    self->priv->qdl_window_size = 1;
 }
 
 static void
@@ -1652,9 +2379,11 @@ dispose (GObject *object)
 static void
 finalize (GObject *object)
 {
-#if defined WITH_UDEV
     QfuUpdater *self = QFU_UPDATER (object);
 
+    g_free (self->priv->label);
+    g_free (self->priv->stats_file);
+#if defined WITH_UDEV
     g_free (self->priv->firmware_version);
     g_free (self->priv->config_version);
     g_free (self->priv->carrier);
@@ -65,11 +65,22 @@ QfuUpdater *qfu_updater_new          (QfuDeviceSelection   *device_selection,
 #endif
 
 QfuUpdater *qfu_updater_new_download (QfuDeviceSelection   *device_selection);
+void        qfu_updater_set_qdl_window_size (QfuUpdater *self,
+                                             guint8      window_size);
+void        qfu_updater_set_label           (QfuUpdater  *self,
+                                             const gchar *label);
+void        qfu_updater_set_stats_file      (QfuUpdater  *self,
+                                             const gchar *path);
 void        qfu_updater_run          (QfuUpdater           *self,
                                       GList                *image_file_list,
                                       GCancellable         *cancellable,
                                       GAsyncReadyCallback   callback,
                                       gpointer              user_data);
+void        qfu_updater_run_images   (QfuUpdater           *self,
+                                      GList                *images,
+                                      GCancellable         *cancellable,
+                                      GAsyncReadyCallback   callback,
+                                      gpointer              user_data);
 gboolean    qfu_updater_run_finish   (QfuUpdater           *self,
                                       GAsyncResult         *res,
                                       GError              **error);
@@ -0,0 +1,304 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * qmi-firmware-update -- Command line tool to update firmware in QMI devices
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright (C) 2020 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+/*
+ * HDLC kernel benchmark: times the CRC, escaping and unescaping of QDL sized
+ * blocks of image data, against the byte-at-a-time versions they replaced,
+ * and checks that both produce the same output.
+ *
+ *   bench-hdlc [ITERATIONS]
+ *
+ * Random data has an escapable byte every 128 bytes on average; a run with
+ * no escapable bytes at all and one full of them bound the range.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include "qfu-hdlc.h"
+
+#define DEFAULT_ITERATIONS 2000
+
+/* Same size as the QDL image write chunks */
+#define BLOCK_SIZE (1024 * 1024)
+
+/*****************************************************************************/
+/* Byte-at-a-time references */
+
+static guint16
+reference_crc16 (const guint8 *buffer,
+                 gsize         len)
+{
+    guint16 crc = 0xffff;
+
+    while (len--)
+        crc = qfu_hdlc_crc_table[0][(crc ^ *buffer++) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+static gsize
+reference_escape (const guint8 *in,
+                  gsize         inlen,
+                  guint8       *out,
+                  gsize         outlen)
+{
+    gsize i, j;
+
+    for (i = 0, j = 0; i < inlen; i++) {
+        if (in[i] == QFU_HDLC_CONTROL || in[i] == QFU_HDLC_ESCAPE) {
+            if ((j + 2) > outlen)
+                return 0;
+            out[j++] = QFU_HDLC_ESCAPE;
+            out[j++] = in[i] ^ QFU_HDLC_MASK;
+        } else {
+            if (j >= outlen)
+                return 0;
+            out[j++] = in[i];
+        }
+    }
+    return j;
+}
+
+static gsize
+reference_unescape (const guint8 *in,
+                    gsize         inlen,
+                    guint8       *out,
+                    gsize         outlen)
+{
+    gsize    i, j;
+    gboolean escaping = FALSE;
+
+    for (i = 0, j = 0; i < inlen; i++) {
+        if (escaping) {
+            if (j >= outlen)
+                return 0;
+            out[j++] = in[i] ^ QFU_HDLC_MASK;
+            escaping = FALSE;
+        } else if (in[i] == QFU_HDLC_ESCAPE)
+            escaping = TRUE;
+        else {
+            if (j >= outlen)
+                return 0;
+            out[j++] = in[i];
+        }
+    }
+    return j;
+}
+
+/*****************************************************************************/
+/* Runner */
+
+typedef struct {
+    const guint8 *in;
+    gsize         inlen;
+    guint8       *out;
+    gsize         outlen;
+} BenchData;
+
+typedef gsize (* BenchFunc) (const BenchData *data);
+
+static guint iterations = DEFAULT_ITERATIONS;
+
+/* Keeps the results alive, so that the calls aren't optimized out */
+static volatile gsize sink;
+
+static gdouble
+bench_run (const gchar     *name,
+           BenchFunc        func,
+           const BenchData *data)
+{
+    gint64  start;
+    gint64  elapsed;
+    gdouble ns_per_op;
+    guint   i;
+
+    /* Warm up caches */
+    for (i = 0; i < iterations / 10 + 1; i++)
+        sink += func (data);
+
+    start = g_get_monotonic_time ();
+    for (i = 0; i < iterations; i++)
+        sink += func (data);
+    elapsed = g_get_monotonic_time () - start;
+
+    if (elapsed <= 0)
+        elapsed = 1;
+    ns_per_op = (gdouble) elapsed * 1000.0 / (gdouble) iterations;
+
+    g_print ("%-36s %11.1f ns/op %9.1f MB/s\n",
+             name,
+             ns_per_op,
+             (gdouble) data->inlen * 1000.0 / ns_per_op);
+    return ns_per_op;
+}
+
+static gsize
+run_crc16 (const BenchData *data)
+{
+    return qfu_hdlc_crc16 (data->in, data->inlen);
+}
+
+static gsize
+run_reference_crc16 (const BenchData *data)
+{
+    return reference_crc16 (data->in, data->inlen);
+}
+
+static gsize
+run_escape (const BenchData *data)
+{
+    return qfu_hdlc_escape (data->in, data->inlen, data->out, data->outlen);
+}
+
+static gsize
+run_reference_escape (const BenchData *data)
+{
+    return reference_escape (data->in, data->inlen, data->out, data->outlen);
+}
+
+static gsize
+run_unescape (const BenchData *data)
+{
+    return qfu_hdlc_unescape (data->in, data->inlen, data->out, data->outlen);
+}
+
+static gsize
+run_reference_unescape (const BenchData *data)
+{
+    return reference_unescape (data->in, data->inlen, data->out, data->outlen);
+}
+
+static void
+bench_pair (const gchar     *name,
+            BenchFunc        func,
+            BenchFunc        reference_func,
+            const BenchData *data)
+{
+    gchar   *label;
+    gdouble  ns;
+    gdouble  reference_ns;
+
+    label = g_strdup_printf ("%s (byte-at-a-time)", name);
+    reference_ns = bench_run (label, reference_func, data);
+    g_free (label);
+
+    ns = bench_run (name, func, data);
+    g_print ("%-36s %11.2fx\n", "  speedup", reference_ns / ns);
+}
+
+/*****************************************************************************/
+
+static void
+check_same_output (const BenchData *data,
+                   guint8          *reference_out)
+{
+    gsize len;
+    gsize reference_len;
+
+    g_assert (qfu_hdlc_crc16 (data->in, data->inlen) == reference_crc16 (data->in, data->inlen));
+
+    len = qfu_hdlc_escape (data->in, data->inlen, data->out, data->outlen);
+    reference_len = reference_escape (data->in, data->inlen, reference_out, data->outlen);
+    g_assert (len == reference_len);
+    g_assert (memcmp (data->out, reference_out, len) == 0);
+}
+
+static void
+bench_block (const gchar  *description,
+             const guint8 *block,
+             guint8       *escaped,
+             guint8       *unescaped,
+             guint8       *reference_out)
+{
+    BenchData data;
+    BenchData escaped_data;
+
+    g_print ("\n%s:\n", description);
+
+    data.in = block;
+    data.inlen = BLOCK_SIZE;
+    data.out = escaped;
+    data.outlen = 2 * BLOCK_SIZE;
+    check_same_output (&data, reference_out);
+
+    escaped_data.in = escaped;
+    escaped_data.inlen = qfu_hdlc_escape (block, BLOCK_SIZE, escaped, 2 * BLOCK_SIZE);
+    escaped_data.out = unescaped;
+    escaped_data.outlen = BLOCK_SIZE;
+    g_assert (run_unescape (&escaped_data) == BLOCK_SIZE);
+    g_assert (memcmp (unescaped, block, BLOCK_SIZE) == 0);
+    g_assert (run_reference_unescape (&escaped_data) == BLOCK_SIZE);
+    g_assert (memcmp (unescaped, block, BLOCK_SIZE) == 0);
+
+    g_print ("  %" G_GSIZE_FORMAT " bytes, %" G_GSIZE_FORMAT " once escaped\n",
+             (gsize) BLOCK_SIZE, escaped_data.inlen);
+
+    bench_pair ("crc16", run_crc16, run_reference_crc16, &data);
+    bench_pair ("escape", run_escape, run_reference_escape, &data);
+    bench_pair ("unescape", run_unescape, run_reference_unescape, &escaped_data);
+}
+
+int main (int argc, char **argv)
+{
+    guint8 *block;
+    guint8 *escaped;
+    guint8 *unescaped;
+    guint8 *reference_out;
+    GRand  *rand;
+    guint   i;
+
+    if (argc > 1)
+        iterations = (guint) atoi (argv[1]);
+    if (!iterations)
+        iterations = DEFAULT_ITERATIONS;
+
+    block = g_malloc (BLOCK_SIZE);
+    escaped = g_malloc (2 * BLOCK_SIZE);
+    unescaped = g_malloc (BLOCK_SIZE);
+    reference_out = g_malloc (2 * BLOCK_SIZE);
+
+    /* Fixed seed, so that runs are comparable */
+    rand = g_rand_new_with_seed (0x7e7d);
+    for (i = 0; i < BLOCK_SIZE; i++)
+        block[i] = (guint8) g_rand_int_range (rand, 0, 256);
+    g_rand_free (rand);
+
+    g_print ("%u iterations per benchmark\n", iterations);
+
+    bench_block ("Random data", block, escaped, unescaped, reference_out);
+
+    for (i = 0; i < BLOCK_SIZE; i++) {
+        if (block[i] == QFU_HDLC_CONTROL || block[i] == QFU_HDLC_ESCAPE)
+            block[i] = 0;
+    }
+    bench_block ("No escapable bytes", block, escaped, unescaped, reference_out);
+
+    for (i = 0; i < BLOCK_SIZE; i++)
+        block[i] = (i & 1) ? QFU_HDLC_CONTROL : QFU_HDLC_ESCAPE;
+    bench_block ("Only escapable bytes", block, escaped, unescaped, reference_out);
+
+    g_free (reference_out);
+    g_free (unescaped);
+    g_free (escaped);
+    g_free (block);
+    return 0;
+}
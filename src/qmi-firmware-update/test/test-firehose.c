@@ -53,9 +53,35 @@ test_firehose_response_configure_parser (void)
 {
     const gchar *rsp = "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n<data>\n<response value=\"NAK\" MemoryName=\"NAND\" MaxPayloadSizeFromTargetInBytes=\"2048\" MaxPayloadSizeToTargetInBytes=\"8192\" MaxPayloadSizeToTargetInBytesSupported=\"8192\" TargetName=\"9x55\" />\n</data>";
     guint        number = 0;
+    guint        supported = 0;
 
-    g_assert (qfu_firehose_message_parse_response_configure (rsp, &number));
+    g_assert (qfu_firehose_message_parse_response_configure (rsp, &number, &supported));
     g_assert_cmpuint (number, ==, 8192);
+    g_assert_cmpuint (supported, ==, 8192);
+}
+
+static void
+test_firehose_response_configure_parser_supported (void)
+{
+    const gchar *rsp = "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n<data>\n<response value=\"NAK\" MemoryName=\"eMMC\" MaxPayloadSizeFromTargetInBytes=\"4096\" MaxPayloadSizeToTargetInBytes=\"16384\" MaxPayloadSizeToTargetInBytesSupported=\"1048576\" TargetName=\"8996\" />\n</data>";
+    guint        number = 0;
+    guint        supported = 0;
+
+    g_assert (qfu_firehose_message_parse_response_configure (rsp, &number, &supported));
+    g_assert_cmpuint (number, ==, 16384);
+    g_assert_cmpuint (supported, ==, 1048576);
+}
+
+static void
+test_firehose_response_configure_parser_no_supported (void)
+{
+    const gchar *rsp = "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n<data>\n<response value=\"ACK\" MemoryName=\"eMMC\" MaxPayloadSizeToTargetInBytes=\"1048576\" />\n</data>";
+    guint        number = 0;
+    guint        supported = 1;
+
+    g_assert (qfu_firehose_message_parse_response_configure (rsp, &number, &supported));
+    g_assert_cmpuint (number, ==, 1048576);
+    g_assert_cmpuint (supported, ==, 0);
 }
 
 static void
@@ -78,6 +104,8 @@ int main (int argc, char **argv)
     g_test_add_func ("/qmi-firmware-update/firehose/response-ack-parser/value",         test_firehose_response_ack_parser_value);
     g_test_add_func ("/qmi-firmware-update/firehose/response-ack-varser/value-rawmode", test_firehose_response_ack_parser_value_rawmode);
     g_test_add_func ("/qmi-firmware-update/firehose/response-configure-parser",         test_firehose_response_configure_parser);
+    g_test_add_func ("/qmi-firmware-update/firehose/response-configure-parser/supported",    test_firehose_response_configure_parser_supported);
+    g_test_add_func ("/qmi-firmware-update/firehose/response-configure-parser/no-supported", test_firehose_response_configure_parser_no_supported);
     g_test_add_func ("/qmi-firmware-update/firehose/log-parser/value",                  test_firehose_log_parser_value);
 
     return g_test_run ();
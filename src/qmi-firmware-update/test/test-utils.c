@@ -19,7 +19,11 @@
  * Copyright (C) 2016 Aleksander Morgado <aleksander@aleksander.es>
  */
 
+#include <string.h>
+
 #include "qfu-utils.h"
+#include "qfu-hdlc.h"
+#include "qfu-compressed-stream.h"
 
 /******************************************************************************/
 
@@ -90,6 +94,224 @@ test_cwe_version_parser_mc7354b_spk (void)
 
 /******************************************************************************/
 
+static void
+test_crc16 (void)
+{
+    static const guint8 check[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+    guint8 buffer[1031];
+    guint  i;
+
+    /* CRC-16/X-25 check value */
+    g_assert_cmphex (qfu_utils_crc16 (check, sizeof (check)), ==, 0x906e);
+
+    /* The sliced implementation must match the byte-at-a-time one for every
+     * length, so that the leftover bytes are also covered */
+    for (i = 0; i < sizeof (buffer); i++)
+        buffer[i] = (guint8) g_test_rand_int ();
+
+    for (i = 0; i <= sizeof (buffer); i++) {
+        guint16       crc = 0xffff;
+        const guint8 *p = buffer;
+        gsize         len = i;
+
+        while (len--)
+            crc = qfu_hdlc_crc_table[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+        g_assert_cmphex (qfu_hdlc_crc16 (buffer, i), ==, (guint16) ~crc);
+    }
+}
+
+static void
+test_hdlc_frame_roundtrip (void)
+{
+    static const guint8 in[] = { 0x01, 0x7e, 0x02, 0x7d, 0x7d, 0x7e, 0x03 };
+    guint8 framed[64];
+    guint8 unframed[64];
+    gsize  framed_size;
+    gsize  unframed_size;
+    gsize  i;
+
+    framed_size = qfu_hdlc_frame (in, sizeof (in), framed, sizeof (framed));
+    g_assert_cmpuint (framed_size, >, sizeof (in));
+    g_assert_cmphex (framed[0], ==, QFU_HDLC_CONTROL);
+    g_assert_cmphex (framed[framed_size - 1], ==, QFU_HDLC_CONTROL);
+    for (i = 1; i < framed_size - 1; i++)
+        g_assert_cmphex (framed[i], !=, QFU_HDLC_CONTROL);
+
+    unframed_size = qfu_hdlc_unescape (&framed[1], framed_size - 2, unframed, sizeof (unframed));
+    g_assert_cmpuint (unframed_size, ==, sizeof (in) + 2);
+    g_assert (memcmp (unframed, in, sizeof (in)) == 0);
+    g_assert_cmphex (unframed[sizeof (in)] | (unframed[sizeof (in) + 1] << 8), ==, qfu_hdlc_crc16 (in, sizeof (in)));
+
+    /* Not enough room for the worst case */
+    g_assert_cmpuint (qfu_hdlc_frame (in, sizeof (in), framed, qfu_hdlc_max_framed_size (sizeof (in)) - 1), ==, 0);
+}
+
+/******************************************************************************/
+
+#define COMPRESSED_TEST_SIZE (1024 * 1024 + 123)
+
+static guint8 *
+build_compressed_test_data (void)
+{
+    guint8 *data;
+    guint   i;
+
+    /* Compressible, but without runs long enough to hide offset errors */
+    data = g_malloc (COMPRESSED_TEST_SIZE);
+    for (i = 0; i < COMPRESSED_TEST_SIZE; i++)
+        data[i] = (guint8) ((i / 3) ^ (i >> 11));
+    return data;
+}
+
+static void
+gzip_append (GByteArray   *out,
+             const guint8 *data,
+             gsize         data_size)
+{
+    GConverter       *compressor;
+    GConverterResult  res;
+    guint8            buffer[4096];
+    gsize             bytes_read;
+    gsize             bytes_written;
+    GError           *error = NULL;
+
+    compressor = G_CONVERTER (g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_GZIP, -1));
+    do {
+        res = g_converter_convert (compressor, data, data_size, buffer, sizeof (buffer),
+                                   G_CONVERTER_INPUT_AT_END, &bytes_read, &bytes_written, &error);
+        g_assert_no_error (error);
+        g_byte_array_append (out, buffer, bytes_written);
+        data += bytes_read;
+        data_size -= bytes_read;
+    } while (res != G_CONVERTER_FINISHED);
+    g_object_unref (compressor);
+}
+
+static GInputStream *
+compressed_stream_new_for_data (GByteArray  *compressed,
+                                GError     **error)
+{
+    GInputStream *base;
+    GInputStream *stream;
+
+    base = g_memory_input_stream_new_from_data (compressed->data, compressed->len, NULL);
+    stream = qfu_compressed_stream_new (base, NULL, error);
+    g_object_unref (base);
+    return stream;
+}
+
+static void
+compressed_stream_check_read (GInputStream *stream,
+                              const guint8 *data,
+                              goffset       offset,
+                              gsize         size)
+{
+    guint8   *buffer;
+    gsize     n_read = 0;
+    gboolean  res;
+    GError   *error = NULL;
+
+    buffer = g_malloc (size);
+    res = g_seekable_seek (G_SEEKABLE (stream), offset, G_SEEK_SET, NULL, &error);
+    g_assert_no_error (error);
+    g_assert (res);
+    res = g_input_stream_read_all (stream, buffer, size, &n_read, NULL, &error);
+    g_assert_no_error (error);
+    g_assert (res);
+    g_assert_cmpuint (n_read, ==, MIN (size, (gsize) (COMPRESSED_TEST_SIZE - offset)));
+    g_assert (memcmp (buffer, data + offset, n_read) == 0);
+    g_free (buffer);
+}
+
+static void
+test_compressed_stream_read (void)
+{
+    guint8       *data;
+    GByteArray   *compressed;
+    GInputStream *stream;
+    GError       *error = NULL;
+    goffset       offset;
+
+    data = build_compressed_test_data ();
+    compressed = g_byte_array_new ();
+    gzip_append (compressed, data, COMPRESSED_TEST_SIZE);
+
+    stream = compressed_stream_new_for_data (compressed, &error);
+    g_assert_no_error (error);
+    g_assert_cmpint (qfu_compressed_stream_get_size (QFU_COMPRESSED_STREAM (stream)), ==, COMPRESSED_TEST_SIZE);
+    g_assert_cmpuint (qfu_compressed_stream_get_n_restart_points (QFU_COMPRESSED_STREAM (stream)), ==, 1);
+
+    /* Sequential reads, with odd sizes so that they span decoded chunks */
+    for (offset = 0; offset < COMPRESSED_TEST_SIZE; offset += 4099)
+        compressed_stream_check_read (stream, data, offset, 4099);
+
+    /* Short backward seek served from the look-back window, forward seek,
+     * and a backward seek to the start */
+    compressed_stream_check_read (stream, data, 1000, 400);
+    compressed_stream_check_read (stream, data, 900, 400);
+    compressed_stream_check_read (stream, data, 700000, 300000);
+    compressed_stream_check_read (stream, data, 0, COMPRESSED_TEST_SIZE);
+
+    g_object_unref (stream);
+    g_byte_array_unref (compressed);
+    g_free (data);
+}
+
+static void
+test_compressed_stream_members (void)
+{
+    guint8       *data;
+    GByteArray   *compressed;
+    GInputStream *stream;
+    GError       *error = NULL;
+
+    /* Concatenated gzip members, each one a restart point */
+    data = build_compressed_test_data ();
+    compressed = g_byte_array_new ();
+    gzip_append (compressed, data, 300000);
+    gzip_append (compressed, data + 300000, 500000);
+    gzip_append (compressed, data + 800000, COMPRESSED_TEST_SIZE - 800000);
+
+    stream = compressed_stream_new_for_data (compressed, &error);
+    g_assert_no_error (error);
+    g_assert_cmpint (qfu_compressed_stream_get_size (QFU_COMPRESSED_STREAM (stream)), ==, COMPRESSED_TEST_SIZE);
+    g_assert_cmpuint (qfu_compressed_stream_get_n_restart_points (QFU_COMPRESSED_STREAM (stream)), ==, 3);
+
+    compressed_stream_check_read (stream, data, 900000, 1000);
+    compressed_stream_check_read (stream, data, 299000, 2000);
+    compressed_stream_check_read (stream, data, 10, 100);
+    compressed_stream_check_read (stream, data, 799999, 300000);
+
+    g_object_unref (stream);
+    g_byte_array_unref (compressed);
+    g_free (data);
+}
+
+static void
+test_compressed_stream_truncated (void)
+{
+    guint8       *data;
+    GByteArray   *compressed;
+    GInputStream *stream;
+    GError       *error = NULL;
+
+    data = build_compressed_test_data ();
+    compressed = g_byte_array_new ();
+    gzip_append (compressed, data, COMPRESSED_TEST_SIZE);
+    g_byte_array_set_size (compressed, compressed->len - 100);
+
+    /* Truncated files are detected before any data is used */
+    stream = compressed_stream_new_for_data (compressed, &error);
+    g_assert (error);
+    g_assert (!stream);
+    g_error_free (error);
+
+    g_byte_array_unref (compressed);
+    g_free (data);
+}
+
+/******************************************************************************/
+
 int main (int argc, char **argv)
 {
     g_test_init (&argc, &argv, NULL);
@@ -98,6 +320,11 @@ int main (int argc, char **argv)
     g_test_add_func ("/qmi-firmware-update/cwe-version-parser/mc7354/cwe",  test_cwe_version_parser_mc7354_cwe);
     g_test_add_func ("/qmi-firmware-update/cwe-version-parser/mc7354/nvu",  test_cwe_version_parser_mc7354_nvu);
     g_test_add_func ("/qmi-firmware-update/cwe-version-parser/mc7354b/spk", test_cwe_version_parser_mc7354b_spk);
+    g_test_add_func ("/qmi-firmware-update/hdlc/crc16",                     test_crc16);
+    g_test_add_func ("/qmi-firmware-update/hdlc/frame-roundtrip",           test_hdlc_frame_roundtrip);
+    g_test_add_func ("/qmi-firmware-update/compressed-stream/read",         test_compressed_stream_read);
+    g_test_add_func ("/qmi-firmware-update/compressed-stream/members",      test_compressed_stream_members);
+    g_test_add_func ("/qmi-firmware-update/compressed-stream/truncated",    test_compressed_stream_truncated);
 
     return g_test_run ();
 }
@@ -0,0 +1,1226 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * qmi-network-daemon -- Keep data connections of a QMI device up
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Copyright (C) 2020 Aleksander Morgado <aleksander@aleksander.es>
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <locale.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <glib.h>
+#include <glib/gprintf.h>
+#include <gio/gio.h>
+#include <gio/gunixsocketaddress.h>
+#include <glib-unix.h>
+
+#include <libqmi-glib.h>
+
+#define PROGRAM_NAME    "qmi-network-daemon"
+#define PROGRAM_VERSION PACKAGE_VERSION
+
+#define SOCKET_NAME_PREFIX       "qmi-network-daemon-"
+#define RETRY_BACKOFF_MIN_SECS   1
+#define RETRY_BACKOFF_MAX_SECS   60
+#define SHUTDOWN_TIMEOUT_SECS    10
+#define START_NETWORK_TIMEOUT_SECS 60
+
+/* Globals */
+static GMainLoop      *loop;
+static QmiDevice      *device;
+static GSocketService *socket_service;
+static GHashTable     *links;
+static gboolean        shutting_down;
+
+/* Main options */
+static gchar     *device_str;
+static gboolean   device_open_proxy_flag;
+static gchar     *socket_str;
+static gchar    **link_strv;
+static gboolean   verbose_flag;
+static gboolean   version_flag;
+
+static GOptionEntry main_entries[] = {
+    { "device", 'd', 0, G_OPTION_ARG_STRING, &device_str,
+      "Specify device path",
+      "[PATH]"
+    },
+    { "device-open-proxy", 'p', 0, G_OPTION_ARG_NONE, &device_open_proxy_flag,
+      "Request to use the 'qmi-proxy' proxy",
+      NULL
+    },
+    { "socket", 's', 0, G_OPTION_ARG_STRING, &socket_str,
+      "Name of the abstract control socket (defaults to '" SOCKET_NAME_PREFIX "' followed by the device name)",
+      "[NAME]"
+    },
+    { "link", 'l', 0, G_OPTION_ARG_STRING_ARRAY, &link_strv,
+      "Start a link once the device is ready (allowed keys: apn, 3gpp-profile, auth (PAP|CHAP|BOTH), username, password, ip-type (4|6)); may be given multiple times",
+      "[NAME[,key=value,...]]"
+    },
+    { "verbose", 'v', 0, G_OPTION_ARG_NONE, &verbose_flag,
+      "Run action with verbose logs, including the debug ones",
+      NULL
+    },
+    { "version", 'V', 0, G_OPTION_ARG_NONE, &version_flag,
+      "Print version",
+      NULL
+    },
+    { NULL }
+};
+
+static void
+log_handler (const gchar *log_domain,
+             GLogLevelFlags log_level,
+             const gchar *message,
+             gpointer user_data)
+{
+    const gchar *log_level_str;
+    time_t now;
+    gchar time_str[64];
+    struct tm *local_time;
+    gboolean err;
+
+    now = time ((time_t *) NULL);
+    local_time = localtime (&now);
+    strftime (time_str, 64, "%d %b %Y, %H:%M:%S", local_time);
+    err = FALSE;
+
+    switch (log_level) {
+    case G_LOG_LEVEL_WARNING:
+        log_level_str = "-Warning **";
+        err = TRUE;
+        break;
+
+    case G_LOG_LEVEL_CRITICAL:
+    case G_LOG_FLAG_FATAL:
+    case G_LOG_LEVEL_ERROR:
+        log_level_str = "-Error **";
+        err = TRUE;
+        break;
+
+    case G_LOG_LEVEL_DEBUG:
+        log_level_str = "[Debug]";
+        break;
+
+    case G_LOG_LEVEL_MESSAGE:
+    case G_LOG_LEVEL_INFO:
+        log_level_str = "";
+        err = TRUE;
+        break;
+
+    default:
+        log_level_str = "";
+        break;
+    }
+
+    if (!verbose_flag && !err)
+        return;
+
+    g_fprintf (err ? stderr : stdout,
+               "[%s] %s %s\n",
+               time_str,
+               log_level_str,
+               message);
+}
+
+static void
+print_version_and_exit (void)
+{
+    g_print ("\n"
+             PROGRAM_NAME " " PROGRAM_VERSION "\n"
+             "Copyright (2020) Aleksander Morgado\n"
+             "License GPLv2+: GNU GPL version 2 or later <http://gnu.org/licenses/gpl-2.0.html>\n"
+             "This is free software: you are free to change and redistribute it.\n"
+             "There is NO WARRANTY, to the extent permitted by law.\n"
+             "\n");
+    exit (EXIT_SUCCESS);
+}
+
+/*****************************************************************************/
+/* Links
+ *
+ * Each link owns its own WDS client, so that the packet service status
+ * indications received on that client refer only to the session it started.
+ */
+
+typedef enum {
+    LINK_STATE_IDLE,
+    LINK_STATE_CONNECTING,
+    LINK_STATE_CONNECTED,
+    LINK_STATE_WAITING_RETRY,
+    LINK_STATE_DISCONNECTING,
+} LinkState;
+
+static const gchar *link_state_str[] = {
+    [LINK_STATE_IDLE]          = "idle",
+    [LINK_STATE_CONNECTING]    = "connecting",
+    [LINK_STATE_CONNECTED]     = "connected",
+    [LINK_STATE_WAITING_RETRY] = "waiting-retry",
+    [LINK_STATE_DISCONNECTING] = "disconnecting",
+};
+
+typedef struct {
+    volatile gint         ref_count;
+    gchar                *name;
+
+    /* Settings */
+    gchar                *apn;
+    gchar                *username;
+    gchar                *password;
+    QmiWdsAuthentication  auth;
+    gboolean              auth_set;
+    QmiWdsIpFamily        ip_type;
+    guint                 profile_index_3gpp;
+
+    /* Session */
+    LinkState             state;
+    gboolean              removed;
+    QmiClientWds         *client;
+    guint                 packet_service_status_id;
+    guint32               packet_data_handle;
+    GCancellable         *cancellable;
+    guint                 retry_id;
+    guint                 backoff;
+    guint                 n_retries;
+    gchar                *last_error;
+} Link;
+
+static void link_connect       (Link *link);
+static void link_disconnect    (Link *link);
+static void check_shutdown_done (void);
+
+static Link *
+link_ref (Link *link)
+{
+    g_atomic_int_inc (&link->ref_count);
+    return link;
+}
+
+static void
+link_unref (Link *link)
+{
+    if (g_atomic_int_dec_and_test (&link->ref_count)) {
+        g_assert (!link->retry_id);
+        if (link->client && link->packet_service_status_id)
+            g_signal_handler_disconnect (link->client, link->packet_service_status_id);
+        g_clear_object (&link->client);
+        g_clear_object (&link->cancellable);
+        g_free (link->last_error);
+        g_free (link->apn);
+        g_free (link->username);
+        g_free (link->password);
+        g_free (link->name);
+        g_slice_free (Link, link);
+    }
+}
+
+static gboolean
+link_parse_property (Link         *link,
+                     const gchar  *key,
+                     const gchar  *value,
+                     GError      **error)
+{
+    if (!value || !value[0]) {
+        g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_INVALID_ARGS,
+                     "key '%s' requires a value", key);
+        return FALSE;
+    }
+
+    if (g_ascii_strcasecmp (key, "apn") == 0 && !link->apn) {
+        link->apn = g_strdup (value);
+        return TRUE;
+    }
+
+    if (g_ascii_strcasecmp (key, "3gpp-profile") == 0 && !link->profile_index_3gpp) {
+        link->profile_index_3gpp = atoi (value);
+        return TRUE;
+    }
+
+    if (g_ascii_strcasecmp (key, "auth") == 0 && !link->auth_set) {
+        if (g_ascii_strcasecmp (value, "PAP") == 0)
+            link->auth = QMI_WDS_AUTHENTICATION_PAP;
+        else if (g_ascii_strcasecmp (value, "CHAP") == 0)
+            link->auth = QMI_WDS_AUTHENTICATION_CHAP;
+        else if (g_ascii_strcasecmp (value, "BOTH") == 0)
+            link->auth = (QMI_WDS_AUTHENTICATION_PAP | QMI_WDS_AUTHENTICATION_CHAP);
+        else if (g_ascii_strcasecmp (value, "NONE") == 0)
+            link->auth = QMI_WDS_AUTHENTICATION_NONE;
+        else {
+            g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_INVALID_ARGS,
+                         "unknown auth protocol '%s'", value);
+            return FALSE;
+        }
+        link->auth_set = TRUE;
+        return TRUE;
+    }
+
+    if (g_ascii_strcasecmp (key, "username") == 0 && !link->username) {
+        link->username = g_strdup (value);
+        return TRUE;
+    }
+
+    if (g_ascii_strcasecmp (key, "password") == 0 && !link->password) {
+        link->password = g_strdup (value);
+        return TRUE;
+    }
+
+    if (g_ascii_strcasecmp (key, "ip-type") == 0 && link->ip_type == QMI_WDS_IP_FAMILY_UNSPECIFIED) {
+        switch (atoi (value)) {
+        case 4:
+            link->ip_type = QMI_WDS_IP_FAMILY_IPV4;
+            break;
+        case 6:
+            link->ip_type = QMI_WDS_IP_FAMILY_IPV6;
+            break;
+        default:
+            g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_INVALID_ARGS,
+                         "unknown IP type '%s' (not 4 or 6)", value);
+            return FALSE;
+        }
+        return TRUE;
+    }
+
+    g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_INVALID_ARGS,
+                 "unrecognized or duplicate option '%s'", key);
+    return FALSE;
+}
+
+/* Input string format: NAME[,key=value,...] */
+static Link *
+link_new_from_string (const gchar  *str,
+                      GError      **error)
+{
+    g_auto(GStrv) split = NULL;
+    Link *link;
+    guint i;
+
+    split = g_strsplit (str, ",", -1);
+    if (!split[0] || !split[0][0] || strchr (split[0], '=') || strchr (split[0], ' ')) {
+        g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_INVALID_ARGS,
+                     "missing or invalid link name");
+        return NULL;
+    }
+
+    link = g_slice_new0 (Link);
+    link->ref_count = 1;
+    link->name = g_strdup (split[0]);
+    link->auth = QMI_WDS_AUTHENTICATION_NONE;
+    link->ip_type = QMI_WDS_IP_FAMILY_UNSPECIFIED;
+    link->state = LINK_STATE_IDLE;
+    link->backoff = RETRY_BACKOFF_MIN_SECS;
+
+    for (i = 1; split[i]; i++) {
+        g_auto(GStrv) key_value = NULL;
+
+        key_value = g_strsplit (split[i], "=", 2);
+        if (!link_parse_property (link, g_strstrip (key_value[0]), key_value[1] ? g_strstrip (key_value[1]) : NULL, error)) {
+            link_unref (link);
+            return NULL;
+        }
+    }
+
+    return link;
+}
+
+static void
+link_set_state (Link      *link,
+                LinkState  state)
+{
+    if (link->state == state)
+        return;
+
+    g_debug ("[%s] link state: %s -> %s", link->name, link_state_str[link->state], link_state_str[state]);
+    link->state = state;
+}
+
+static void
+link_set_last_error (Link        *link,
+                     const gchar *message)
+{
+    g_free (link->last_error);
+    link->last_error = g_strdup (message);
+}
+
+/*****************************************************************************/
+/* Retry with exponential backoff */
+
+static gboolean
+link_retry_cb (Link *link)
+{
+    link->retry_id = 0;
+    link_connect (link);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+link_schedule_retry (Link *link)
+{
+    g_assert (!link->retry_id);
+
+    if (link->removed || shutting_down)
+        return;
+
+    g_message ("[%s] retrying connection in %u seconds...", link->name, link->backoff);
+    link_set_state (link, LINK_STATE_WAITING_RETRY);
+    link->n_retries++;
+    link->retry_id = g_timeout_add_seconds_full (G_PRIORITY_DEFAULT,
+                                                 link->backoff,
+                                                 (GSourceFunc) link_retry_cb,
+                                                 link_ref (link),
+                                                 (GDestroyNotify) link_unref);
+    link->backoff = MIN (link->backoff * 2, RETRY_BACKOFF_MAX_SECS);
+}
+
+/*****************************************************************************/
+/* Client release */
+
+static void
+release_client_ready (QmiDevice    *_device,
+                      GAsyncResult *res)
+{
+    g_autoptr(GError) error = NULL;
+
+    if (!qmi_device_release_client_finish (_device, res, &error))
+        g_warning ("couldn't release WDS client: %s", error->message);
+    check_shutdown_done ();
+}
+
+static void
+link_release_client (Link *link)
+{
+    if (!link->client)
+        return;
+
+    if (link->packet_service_status_id) {
+        g_signal_handler_disconnect (link->client, link->packet_service_status_id);
+        link->packet_service_status_id = 0;
+    }
+
+    qmi_device_release_client (device,
+                               QMI_CLIENT (link->client),
+                               QMI_DEVICE_RELEASE_CLIENT_FLAGS_RELEASE_CID,
+                               3,
+                               NULL,
+                               (GAsyncReadyCallback) release_client_ready,
+                               NULL);
+    g_clear_object (&link->client);
+}
+
+static void
+link_remove (Link *link)
+{
+    link_set_state (link, LINK_STATE_IDLE);
+    link_release_client (link);
+    /* A new link with the same name may have been added meanwhile */
+    if (g_hash_table_lookup (links, link->name) == link)
+        g_hash_table_remove (links, link->name);
+    check_shutdown_done ();
+}
+
+/*****************************************************************************/
+/* Disconnection */
+
+static void
+stop_network_ready (QmiClientWds *client,
+                    GAsyncResult *res,
+                    Link         *link)
+{
+    g_autoptr(QmiMessageWdsStopNetworkOutput) output = NULL;
+    g_autoptr(GError) error = NULL;
+
+    output = qmi_client_wds_stop_network_finish (client, res, &error);
+    if (output && !qmi_message_wds_stop_network_output_get_result (output, &error) &&
+        !g_error_matches (error, QMI_PROTOCOL_ERROR, QMI_PROTOCOL_ERROR_NO_EFFECT))
+        g_warning ("[%s] couldn't stop network: %s", link->name, error->message);
+    else if (!output)
+        g_warning ("[%s] couldn't stop network: %s", link->name, error->message);
+    else
+        g_message ("[%s] disconnected", link->name);
+
+    link->packet_data_handle = 0;
+    link_remove (link);
+    link_unref (link);
+}
+
+static void
+link_stop_network (Link *link)
+{
+    g_autoptr(QmiMessageWdsStopNetworkInput) input = NULL;
+
+    input = qmi_message_wds_stop_network_input_new ();
+    qmi_message_wds_stop_network_input_set_packet_data_handle (input, link->packet_data_handle, NULL);
+    qmi_message_wds_stop_network_input_set_disable_autoconnect (input, TRUE, NULL);
+
+    g_debug ("[%s] stopping network...", link->name);
+    qmi_client_wds_stop_network (link->client,
+                                 input,
+                                 30,
+                                 NULL,
+                                 (GAsyncReadyCallback) stop_network_ready,
+                                 link_ref (link));
+}
+
+static void
+link_disconnect (Link *link)
+{
+    LinkState previous_state;
+
+    previous_state = link->state;
+    if (previous_state == LINK_STATE_DISCONNECTING)
+        return;
+
+    link->removed = TRUE;
+    link_set_state (link, LINK_STATE_DISCONNECTING);
+
+    if (link->retry_id) {
+        g_source_remove (link->retry_id);
+        link->retry_id = 0;
+    }
+
+    /* Abort the ongoing connection attempt; the operation completion takes
+     * care of the cleanup, as only then the packet data handle is known */
+    if (previous_state == LINK_STATE_CONNECTING) {
+        g_cancellable_cancel (link->cancellable);
+        return;
+    }
+
+    if (!link->client || !link->packet_data_handle) {
+        link_remove (link);
+        return;
+    }
+
+    link_stop_network (link);
+}
+
+/*****************************************************************************/
+/* Connection */
+
+static void
+packet_service_status_cb (QmiClientWds                             *client,
+                          QmiIndicationWdsPacketServiceStatusOutput *output,
+                          Link                                      *link)
+{
+    QmiWdsConnectionStatus status;
+    QmiWdsCallEndReason cer;
+    QmiWdsVerboseCallEndReasonType verbose_cer_type;
+    gint16 verbose_cer_reason;
+    g_autofree gchar *reason = NULL;
+
+    if (!qmi_indication_wds_packet_service_status_output_get_connection_status (output, &status, NULL, NULL))
+        return;
+
+    g_debug ("[%s] packet service status: %s", link->name, qmi_wds_connection_status_get_string (status));
+
+    /* Only an unexpected disconnection of an established session matters */
+    if (status != QMI_WDS_CONNECTION_STATUS_DISCONNECTED || link->state != LINK_STATE_CONNECTED)
+        return;
+
+    if (qmi_indication_wds_packet_service_status_output_get_verbose_call_end_reason (output, &verbose_cer_type, &verbose_cer_reason, NULL))
+        reason = g_strdup_printf ("[%s] %s",
+                                  qmi_wds_verbose_call_end_reason_type_get_string (verbose_cer_type),
+                                  qmi_wds_verbose_call_end_reason_get_string (verbose_cer_type, verbose_cer_reason));
+    else if (qmi_indication_wds_packet_service_status_output_get_call_end_reason (output, &cer, NULL))
+        reason = g_strdup (qmi_wds_call_end_reason_get_string (cer));
+    else
+        reason = g_strdup ("unknown reason");
+
+    g_message ("[%s] connection lost: %s", link->name, reason);
+    link_set_last_error (link, reason);
+    link->packet_data_handle = 0;
+    link_schedule_retry (link);
+}
+
+static void
+start_network_ready (QmiClientWds *client,
+                     GAsyncResult *res,
+                     Link         *link)
+{
+    g_autoptr(QmiMessageWdsStartNetworkOutput) output = NULL;
+    g_autoptr(GError) error = NULL;
+
+    output = qmi_client_wds_start_network_finish (client, res, &error);
+    if (output && !qmi_message_wds_start_network_output_get_result (output, &error)) {
+        QmiWdsVerboseCallEndReasonType verbose_cer_type;
+        gint16 verbose_cer_reason;
+
+        if (g_error_matches (error, QMI_PROTOCOL_ERROR, QMI_PROTOCOL_ERROR_CALL_FAILED) &&
+            qmi_message_wds_start_network_output_get_verbose_call_end_reason (output, &verbose_cer_type, &verbose_cer_reason, NULL))
+            g_prefix_error (&error, "[%s] %s: ",
+                            qmi_wds_verbose_call_end_reason_type_get_string (verbose_cer_type),
+                            qmi_wds_verbose_call_end_reason_get_string (verbose_cer_type, verbose_cer_reason));
+        g_clear_pointer (&output, qmi_message_wds_start_network_output_unref);
+    }
+
+    if (link->state != LINK_STATE_CONNECTING) {
+        /* Disconnection requested meanwhile; if the modem still brought the
+         * session up, take it down again */
+        if (output &&
+            qmi_message_wds_start_network_output_get_packet_data_handle (output, &link->packet_data_handle, NULL))
+            link_stop_network (link);
+        else
+            link_remove (link);
+        link_unref (link);
+        return;
+    }
+
+    if (!output) {
+        g_warning ("[%s] couldn't start network: %s", link->name, error->message);
+        link_set_last_error (link, error->message);
+        link_schedule_retry (link);
+        link_unref (link);
+        return;
+    }
+
+    qmi_message_wds_start_network_output_get_packet_data_handle (output, &link->packet_data_handle, NULL);
+    g_message ("[%s] connected (packet data handle: %u)", link->name, link->packet_data_handle);
+    link_set_state (link, LINK_STATE_CONNECTED);
+    link_set_last_error (link, NULL);
+    link->backoff = RETRY_BACKOFF_MIN_SECS;
+    link_unref (link);
+}
+
+static void
+link_start_network (Link *link)
+{
+    g_autoptr(QmiMessageWdsStartNetworkInput) input = NULL;
+
+    input = qmi_message_wds_start_network_input_new ();
+    if (link->apn)
+        qmi_message_wds_start_network_input_set_apn (input, link->apn, NULL);
+    if (link->profile_index_3gpp > 0)
+        qmi_message_wds_start_network_input_set_profile_index_3gpp (input, link->profile_index_3gpp, NULL);
+    if (link->ip_type != QMI_WDS_IP_FAMILY_UNSPECIFIED)
+        qmi_message_wds_start_network_input_set_ip_family_preference (input, link->ip_type, NULL);
+    if (link->auth_set)
+        qmi_message_wds_start_network_input_set_authentication_preference (input, link->auth, NULL);
+    if (link->username)
+        qmi_message_wds_start_network_input_set_username (input, link->username, NULL);
+    if (link->password)
+        qmi_message_wds_start_network_input_set_password (input, link->password, NULL);
+
+    g_debug ("[%s] starting network...", link->name);
+    qmi_client_wds_start_network (link->client,
+                                  input,
+                                  START_NETWORK_TIMEOUT_SECS,
+                                  link->cancellable,
+                                  (GAsyncReadyCallback) start_network_ready,
+                                  link_ref (link));
+}
+
+static void
+set_ip_family_ready (QmiClientWds *client,
+                     GAsyncResult *res,
+                     Link         *link)
+{
+    g_autoptr(QmiMessageWdsSetIpFamilyOutput) output = NULL;
+    g_autoptr(GError) error = NULL;
+
+    output = qmi_client_wds_set_ip_family_finish (client, res, &error);
+    if (output && !qmi_message_wds_set_ip_family_output_get_result (output, &error))
+        g_clear_pointer (&output, qmi_message_wds_set_ip_family_output_unref);
+
+    /* Not fatal, older modems don't support it */
+    if (!output && !g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        g_debug ("[%s] couldn't set IP family: %s", link->name, error->message);
+
+    if (link->state == LINK_STATE_CONNECTING)
+        link_start_network (link);
+    else
+        link_remove (link);
+    link_unref (link);
+}
+
+static void
+link_setup_client (Link *link)
+{
+    g_autoptr(QmiMessageWdsSetIpFamilyInput) input = NULL;
+
+    if (link->ip_type == QMI_WDS_IP_FAMILY_UNSPECIFIED) {
+        link_start_network (link);
+        return;
+    }
+
+    /* The client IP family selects which session indications are reported */
+    input = qmi_message_wds_set_ip_family_input_new ();
+    qmi_message_wds_set_ip_family_input_set_preference (input, link->ip_type, NULL);
+    qmi_client_wds_set_ip_family (link->client,
+                                  input,
+                                  10,
+                                  link->cancellable,
+                                  (GAsyncReadyCallback) set_ip_family_ready,
+                                  link_ref (link));
+}
+
+static void
+allocate_client_ready (QmiDevice    *_device,
+                       GAsyncResult *res,
+                       Link         *link)
+{
+    g_autoptr(QmiClient) client = NULL;
+    g_autoptr(GError) error = NULL;
+
+    client = qmi_device_allocate_client_finish (_device, res, &error);
+    if (link->state != LINK_STATE_CONNECTING) {
+        if (client)
+            qmi_device_release_client (device,
+                                       client,
+                                       QMI_DEVICE_RELEASE_CLIENT_FLAGS_RELEASE_CID,
+                                       3,
+                                       NULL,
+                                       (GAsyncReadyCallback) release_client_ready,
+                                       NULL);
+        link_remove (link);
+        link_unref (link);
+        return;
+    }
+
+    if (!client) {
+        g_warning ("[%s] couldn't allocate WDS client: %s", link->name, error->message);
+        link_set_last_error (link, error->message);
+        link_schedule_retry (link);
+        link_unref (link);
+        return;
+    }
+
+    link->client = QMI_CLIENT_WDS (g_steal_pointer (&client));
+    link->packet_service_status_id = g_signal_connect (link->client,
+                                                       "packet-service-status",
+                                                       G_CALLBACK (packet_service_status_cb),
+                                                       link);
+    link_setup_client (link);
+    link_unref (link);
+}
+
+static void
+link_connect (Link *link)
+{
+    g_assert (link->state == LINK_STATE_IDLE || link->state == LINK_STATE_WAITING_RETRY);
+
+    link_set_state (link, LINK_STATE_CONNECTING);
+    g_clear_object (&link->cancellable);
+    link->cancellable = g_cancellable_new ();
+
+    /* The client is kept across retries */
+    if (link->client) {
+        link_setup_client (link);
+        return;
+    }
+
+    qmi_device_allocate_client (device,
+                                QMI_SERVICE_WDS,
+                                QMI_CID_NONE,
+                                10,
+                                link->cancellable,
+                                (GAsyncReadyCallback) allocate_client_ready,
+                                link_ref (link));
+}
+
+static gboolean
+link_add (Link    *link,
+          GError **error)
+{
+    if (g_hash_table_contains (links, link->name)) {
+        g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_WRONG_STATE,
+                     "link '%s' already exists", link->name);
+        return FALSE;
+    }
+
+    g_hash_table_insert (links, link->name, link_ref (link));
+    g_message ("[%s] link added", link->name);
+    link_connect (link);
+    return TRUE;
+}
+
+/*****************************************************************************/
+/* Shutdown */
+
+static gboolean
+shutdown_timeout_cb (void)
+{
+    g_warning ("timed out waiting for links to be disconnected");
+    g_main_loop_quit (loop);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+check_shutdown_done (void)
+{
+    if (shutting_down && g_hash_table_size (links) == 0)
+        g_idle_add ((GSourceFunc) g_main_loop_quit, loop);
+}
+
+static gboolean
+quit_cb (gpointer user_data)
+{
+    g_autoptr(GList) values = NULL;
+    GList *l;
+
+    if (shutting_down)
+        return G_SOURCE_CONTINUE;
+
+    g_warning ("Caught signal, disconnecting links...");
+    shutting_down = TRUE;
+
+    if (!links || !g_hash_table_size (links)) {
+        g_idle_add ((GSourceFunc) g_main_loop_quit, loop);
+        return G_SOURCE_CONTINUE;
+    }
+
+    values = g_hash_table_get_values (links);
+    for (l = values; l; l = g_list_next (l))
+        link_disconnect ((Link *) l->data);
+
+    g_timeout_add_seconds (SHUTDOWN_TIMEOUT_SECS, (GSourceFunc) shutdown_timeout_cb, NULL);
+    return G_SOURCE_CONTINUE;
+}
+
+/*****************************************************************************/
+/* Control socket
+ *
+ * Line based protocol, one command per line:
+ *   start NAME[,key=value,...]
+ *   stop NAME
+ *   status
+ * Every reply ends with either a 'OK' or a 'ERROR <message>' line.
+ */
+
+typedef struct {
+    GSocketConnection *connection;
+    GDataInputStream  *input;
+    GCancellable      *cancellable;
+} Control;
+
+static void control_read_next (Control *control);
+
+static void
+control_free (Control *control)
+{
+    g_cancellable_cancel (control->cancellable);
+    g_object_unref (control->cancellable);
+    g_object_unref (control->input);
+    g_object_unref (control->connection);
+    g_slice_free (Control, control);
+}
+
+static void
+control_process_status (GString *reply)
+{
+    GHashTableIter iter;
+    Link *link;
+
+    g_hash_table_iter_init (&iter, links);
+    while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&link)) {
+        g_string_append_printf (reply, "%s state=%s retries=%u",
+                                link->name, link_state_str[link->state], link->n_retries);
+        if (link->state == LINK_STATE_CONNECTED)
+            g_string_append_printf (reply, " packet-data-handle=%u", link->packet_data_handle);
+        if (link->last_error)
+            g_string_append_printf (reply, " last-error=\"%s\"", link->last_error);
+        g_string_append_c (reply, '\n');
+    }
+}
+
+static gboolean
+control_process_command (const gchar  *line,
+                         GString      *reply,
+                         GError      **error)
+{
+    g_auto(GStrv) split = NULL;
+
+    split = g_strsplit (line, " ", 2);
+    if (!split[0] || !split[0][0]) {
+        g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_INVALID_ARGS, "empty command");
+        return FALSE;
+    }
+
+    if (shutting_down) {
+        g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_WRONG_STATE, "shutting down");
+        return FALSE;
+    }
+
+    if (g_str_equal (split[0], "status")) {
+        control_process_status (reply);
+        return TRUE;
+    }
+
+    if (g_str_equal (split[0], "start")) {
+        Link *link;
+        gboolean success;
+
+        if (!split[1]) {
+            g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_INVALID_ARGS, "missing link settings");
+            return FALSE;
+        }
+        link = link_new_from_string (g_strstrip (split[1]), error);
+        if (!link)
+            return FALSE;
+        success = link_add (link, error);
+        link_unref (link);
+        return success;
+    }
+
+    if (g_str_equal (split[0], "stop")) {
+        Link *link;
+
+        link = split[1] ? g_hash_table_lookup (links, g_strstrip (split[1])) : NULL;
+        if (!link) {
+            g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_INVALID_ARGS, "unknown link");
+            return FALSE;
+        }
+        link_disconnect (link);
+        return TRUE;
+    }
+
+    g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_UNSUPPORTED,
+                 "unknown command '%s'", split[0]);
+    return FALSE;
+}
+
+static void
+control_read_line_ready (GDataInputStream *input,
+                         GAsyncResult     *res,
+                         Control          *control)
+{
+    g_autofree gchar *line = NULL;
+    g_autoptr(GString) reply = NULL;
+    g_autoptr(GError) error = NULL;
+    GOutputStream *output;
+
+    line = g_data_input_stream_read_line_finish_utf8 (input, res, NULL, &error);
+    if (!line) {
+        if (error && !g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+            g_debug ("control client error: %s", error->message);
+        control_free (control);
+        return;
+    }
+
+    g_debug ("control command: %s", line);
+
+    reply = g_string_new (NULL);
+    if (control_process_command (g_strstrip (line), reply, &error))
+        g_string_append (reply, "OK\n");
+    else
+        g_string_append_printf (reply, "ERROR %s\n", error->message);
+    g_clear_error (&error);
+
+    output = g_io_stream_get_output_stream (G_IO_STREAM (control->connection));
+    if (!g_output_stream_write_all (output, reply->str, reply->len, NULL, control->cancellable, &error)) {
+        g_debug ("couldn't write control reply: %s", error->message);
+        control_free (control);
+        return;
+    }
+
+    control_read_next (control);
+}
+
+static void
+control_read_next (Control *control)
+{
+    g_data_input_stream_read_line_async (control->input,
+                                         G_PRIORITY_DEFAULT,
+                                         control->cancellable,
+                                         (GAsyncReadyCallback) control_read_line_ready,
+                                         control);
+}
+
+static gboolean
+incoming_cb (GSocketService    *service,
+             GSocketConnection *connection,
+             GObject           *unused)
+{
+    g_autoptr(GCredentials) credentials = NULL;
+    g_autoptr(GError) error = NULL;
+    Control *control;
+    uid_t uid;
+
+    /* Only root and the user running the daemon may control it */
+    credentials = g_socket_get_credentials (g_socket_connection_get_socket (connection), &error);
+    if (!credentials) {
+        g_warning ("couldn't get control client credentials: %s", error->message);
+        return TRUE;
+    }
+
+    uid = g_credentials_get_unix_user (credentials, &error);
+    if (uid == (uid_t) -1 || (uid != 0 && uid != getuid ())) {
+        g_warning ("control client not allowed");
+        return TRUE;
+    }
+
+    control = g_slice_new0 (Control);
+    control->connection = g_object_ref (connection);
+    control->input = g_data_input_stream_new (g_io_stream_get_input_stream (G_IO_STREAM (connection)));
+    control->cancellable = g_cancellable_new ();
+    control_read_next (control);
+    return TRUE;
+}
+
+static gboolean
+setup_socket_service (GError **error)
+{
+    g_autoptr(GSocket) socket = NULL;
+    g_autoptr(GSocketAddress) socket_address = NULL;
+    g_autofree gchar *socket_name = NULL;
+
+    if (socket_str)
+        socket_name = g_strdup (socket_str);
+    else {
+        g_autofree gchar *basename = NULL;
+
+        basename = g_path_get_basename (device_str);
+        socket_name = g_strdup_printf (SOCKET_NAME_PREFIX "%s", basename);
+    }
+
+    socket = g_socket_new (G_SOCKET_FAMILY_UNIX,
+                           G_SOCKET_TYPE_STREAM,
+                           G_SOCKET_PROTOCOL_DEFAULT,
+                           error);
+    if (!socket)
+        return FALSE;
+
+    socket_address = g_unix_socket_address_new_with_type (socket_name,
+                                                          -1,
+                                                          G_UNIX_SOCKET_ADDRESS_ABSTRACT);
+    if (!g_socket_bind (socket, socket_address, TRUE, error) ||
+        !g_socket_listen (socket, error)) {
+        g_prefix_error (error, "Couldn't setup control socket '%s': ", socket_name);
+        return FALSE;
+    }
+
+    socket_service = g_socket_service_new ();
+    g_signal_connect (socket_service, "incoming", G_CALLBACK (incoming_cb), NULL);
+    if (!g_socket_listener_add_socket (G_SOCKET_LISTENER (socket_service), socket, NULL, error)) {
+        g_prefix_error (error, "Error adding socket at '%s' to socket service: ", socket_name);
+        return FALSE;
+    }
+
+    g_debug ("control socket available at '@%s'", socket_name);
+    g_socket_service_start (socket_service);
+    return TRUE;
+}
+
+/*****************************************************************************/
+/* Device setup */
+
+static void
+device_ready (void)
+{
+    g_autoptr(GError) error = NULL;
+    guint i;
+
+    if (!setup_socket_service (&error)) {
+        g_printerr ("error: %s\n", error->message);
+        g_main_loop_quit (loop);
+        return;
+    }
+
+    for (i = 0; link_strv && link_strv[i]; i++) {
+        g_autoptr(GError) link_error = NULL;
+        Link *link;
+
+        link = link_new_from_string (link_strv[i], &link_error);
+        if (!link || !link_add (link, &link_error))
+            g_warning ("couldn't start link '%s': %s", link_strv[i], link_error->message);
+        if (link)
+            link_unref (link);
+    }
+}
+
+static void
+wda_release_client_ready (QmiDevice    *_device,
+                          GAsyncResult *res)
+{
+    qmi_device_release_client_finish (_device, res, NULL);
+}
+
+static void
+get_data_format_ready (QmiClientWda *client,
+                       GAsyncResult *res)
+{
+    g_autoptr(QmiMessageWdaGetDataFormatOutput) output = NULL;
+    g_autoptr(GError) error = NULL;
+    QmiWdaLinkLayerProtocol link_layer_protocol;
+    QmiDeviceExpectedDataFormat expected = QMI_DEVICE_EXPECTED_DATA_FORMAT_UNKNOWN;
+
+    output = qmi_client_wda_get_data_format_finish (client, res, &error);
+    if (output &&
+        qmi_message_wda_get_data_format_output_get_result (output, &error) &&
+        qmi_message_wda_get_data_format_output_get_link_layer_protocol (output, &link_layer_protocol, &error)) {
+        if (link_layer_protocol == QMI_WDA_LINK_LAYER_PROTOCOL_RAW_IP)
+            expected = QMI_DEVICE_EXPECTED_DATA_FORMAT_RAW_IP;
+        else if (link_layer_protocol == QMI_WDA_LINK_LAYER_PROTOCOL_802_3)
+            expected = QMI_DEVICE_EXPECTED_DATA_FORMAT_802_3;
+    } else {
+        g_debug ("couldn't get data format: %s", error->message);
+        g_clear_error (&error);
+    }
+
+    /* Make the kernel expect what the modem sends */
+    if (expected != QMI_DEVICE_EXPECTED_DATA_FORMAT_UNKNOWN &&
+        expected != qmi_device_get_expected_data_format (device, NULL)) {
+        if (!qmi_device_set_expected_data_format (device, expected, &error))
+            g_warning ("couldn't update expected data format: %s", error->message);
+        else
+            g_debug ("expected data format updated to '%s'", qmi_device_expected_data_format_get_string (expected));
+    }
+
+    qmi_device_release_client (device,
+                               QMI_CLIENT (client),
+                               QMI_DEVICE_RELEASE_CLIENT_FLAGS_RELEASE_CID,
+                               3,
+                               NULL,
+                               (GAsyncReadyCallback) wda_release_client_ready,
+                               NULL);
+    g_object_unref (client);
+
+    device_ready ();
+}
+
+static void
+wda_allocate_client_ready (QmiDevice    *_device,
+                           GAsyncResult *res)
+{
+    g_autoptr(GError) error = NULL;
+    QmiClient *client;
+
+    client = qmi_device_allocate_client_finish (_device, res, &error);
+    if (!client) {
+        /* Not fatal, WDA isn't supported by older modems */
+        g_debug ("couldn't allocate WDA client: %s", error->message);
+        device_ready ();
+        return;
+    }
+
+    qmi_client_wda_get_data_format (QMI_CLIENT_WDA (client),
+                                    NULL,
+                                    10,
+                                    NULL,
+                                    (GAsyncReadyCallback) get_data_format_ready,
+                                    NULL);
+}
+
+static void
+device_open_ready (QmiDevice    *_device,
+                   GAsyncResult *res)
+{
+    g_autoptr(GError) error = NULL;
+
+    if (!qmi_device_open_finish (_device, res, &error)) {
+        g_printerr ("error: couldn't open the QmiDevice: %s\n", error->message);
+        g_main_loop_quit (loop);
+        return;
+    }
+
+    g_debug ("QMI device at '%s' ready", qmi_device_get_path_display (device));
+
+    qmi_device_allocate_client (device,
+                                QMI_SERVICE_WDA,
+                                QMI_CID_NONE,
+                                10,
+                                NULL,
+                                (GAsyncReadyCallback) wda_allocate_client_ready,
+                                NULL);
+}
+
+static void
+device_new_ready (GObject      *unused,
+                  GAsyncResult *res)
+{
+    g_autoptr(GError) error = NULL;
+    QmiDeviceOpenFlags open_flags = QMI_DEVICE_OPEN_FLAGS_AUTO;
+
+    device = qmi_device_new_finish (res, &error);
+    if (!device) {
+        g_printerr ("error: couldn't create QmiDevice: %s\n", error->message);
+        g_main_loop_quit (loop);
+        return;
+    }
+
+    if (device_open_proxy_flag)
+        open_flags |= QMI_DEVICE_OPEN_FLAGS_PROXY;
+
+    qmi_device_open (device,
+                     open_flags,
+                     15,
+                     NULL,
+                     (GAsyncReadyCallback) device_open_ready,
+                     NULL);
+}
+
+/*****************************************************************************/
+
+int main (int argc, char **argv)
+{
+    g_autoptr(GError) error = NULL;
+    g_autoptr(GFile) file = NULL;
+    GOptionContext *context;
+
+    setlocale (LC_ALL, "");
+
+    /* Setup option context, process it and destroy it */
+    context = g_option_context_new ("- Keep data connections of QMI devices up");
+    g_option_context_add_main_entries (context, main_entries, NULL);
+    if (!g_option_context_parse (context, &argc, &argv, &error)) {
+        g_printerr ("error: %s\n",
+                    error->message);
+        exit (EXIT_FAILURE);
+    }
+    g_option_context_free (context);
+
+    if (version_flag)
+        print_version_and_exit ();
+
+    g_log_set_handler (NULL,  G_LOG_LEVEL_MASK, log_handler, NULL);
+    g_log_set_handler ("Qmi", G_LOG_LEVEL_MASK, log_handler, NULL);
+    if (verbose_flag)
+        qmi_utils_set_traces_enabled (TRUE);
+
+    if (!device_str) {
+        g_printerr ("error: no device path specified\n");
+        exit (EXIT_FAILURE);
+    }
+
+    /* Setup signals */
+    g_unix_signal_add (SIGINT,  quit_cb, NULL);
+    g_unix_signal_add (SIGHUP,  quit_cb, NULL);
+    g_unix_signal_add (SIGTERM, quit_cb, NULL);
+
+    links = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, (GDestroyNotify) link_unref);
+
+    file = g_file_new_for_commandline_arg (device_str);
+    qmi_device_new (file, NULL, (GAsyncReadyCallback) device_new_ready, NULL);
+
+    /* Loop */
+    loop = g_main_loop_new (NULL, FALSE);
+    g_main_loop_run (loop);
+    g_main_loop_unref (loop);
+
+    /* Cleanup */
+    if (socket_service) {
+        g_socket_service_stop (socket_service);
+        g_object_unref (socket_service);
+    }
+    g_hash_table_unref (links);
+    g_clear_object (&device);
+
+    g_debug ("exiting '" PROGRAM_NAME "'...");
+
+    return EXIT_SUCCESS;
+}
@@ -27,7 +27,9 @@
 
 #include <glib.h>
 #include <glib/gprintf.h>
+#include <glib/gstdio.h>
 #include <gio/gio.h>
+#include <gio/gunixsocketaddress.h>
 #include <glib-unix.h>
 
 #include <libqmi-glib.h>
@@ -41,12 +43,19 @@
 static GMainLoop *loop;
 static QmiProxy *proxy;
 static guint timeout_id;
+static GSocketService *metrics_service;
 
 /* Main options */
 static gboolean verbose_flag;
 static gboolean version_flag;
 static gboolean no_exit_flag;
 static gint     empty_timeout = -1;
+static gboolean coalesce_flag;
+static gint     linger_time;
+static gchar  **keep_open_paths;
+static gboolean device_threads_flag;
+static gchar   *metrics_socket_path;
+static gchar   *trace_filter;
 
 static GOptionEntry main_entries[] = {
     { "no-exit", 0, 0, G_OPTION_ARG_NONE, &no_exit_flag,
@@ -57,6 +66,30 @@ static GOptionEntry main_entries[] = {
       "If no clients, exit after this timeout. If set to 0, equivalent to --no-exit.",
       "[SECS]"
     },
+    { "coalesce", 0, 0, G_OPTION_ARG_NONE, &coalesce_flag,
+      "Share one response among clients sending the same read-only request at the same time",
+      NULL
+    },
+    { "linger", 0, 0, G_OPTION_ARG_INT, &linger_time,
+      "Keep devices open for this time after their last client is gone",
+      "[SECS]"
+    },
+    { "keep-open", 0, 0, G_OPTION_ARG_FILENAME_ARRAY, &keep_open_paths,
+      "Open this device right away and never close it; implies --no-exit. May be given several times",
+      "[PATH]"
+    },
+    { "device-threads", 0, 0, G_OPTION_ARG_NONE, &device_threads_flag,
+      "Run each device, and the clients using it, in a thread of its own",
+      NULL
+    },
+    { "metrics-socket", 0, 0, G_OPTION_ARG_FILENAME, &metrics_socket_path,
+      "Write the proxy metrics, in text format, to every connection to this UNIX socket",
+      "[PATH]"
+    },
+    { "trace-filter", 0, 0, G_OPTION_ARG_STRING, &trace_filter,
+      "Only trace the messages matching these comma separated SERVICE[:MESSAGE][/KIND[+KIND]] rules",
+      "[RULES]"
+    },
     { "verbose", 'v', 0, G_OPTION_ARG_NONE, &verbose_flag,
       "Run action with verbose logs, including the debug ones",
       NULL
@@ -173,6 +206,59 @@ proxy_n_clients_changed (QmiProxy *_proxy)
 
 /*****************************************************************************/
 
+static gboolean
+metrics_incoming_cb (GSocketService    *service,
+                     GSocketConnection *connection,
+                     GObject           *unused)
+{
+    g_autofree gchar *metrics = NULL;
+    GError           *error = NULL;
+
+    /* Don't let a client not reading block the proxy for long */
+    g_socket_set_timeout (g_socket_connection_get_socket (connection), 1);
+
+    metrics = qmi_proxy_get_metrics (proxy);
+    if (!g_output_stream_write_all (g_io_stream_get_output_stream (G_IO_STREAM (connection)),
+                                    metrics,
+                                    strlen (metrics),
+                                    NULL,
+                                    NULL,
+                                    &error)) {
+        g_debug ("couldn't write metrics: %s", error->message);
+        g_error_free (error);
+    }
+    g_io_stream_close (G_IO_STREAM (connection), NULL, NULL);
+    return TRUE;
+}
+
+static gboolean
+setup_metrics_service (GError **error)
+{
+    GSocketAddress *address;
+    gboolean        success;
+
+    g_unlink (metrics_socket_path);
+    address = g_unix_socket_address_new (metrics_socket_path);
+    metrics_service = g_socket_service_new ();
+    success = g_socket_listener_add_address (G_SOCKET_LISTENER (metrics_service),
+                                             address,
+                                             G_SOCKET_TYPE_STREAM,
+                                             G_SOCKET_PROTOCOL_DEFAULT,
+                                             NULL,
+                                             NULL,
+                                             error);
+    g_object_unref (address);
+    if (!success)
+        return FALSE;
+
+    g_signal_connect (metrics_service, "incoming", G_CALLBACK (metrics_incoming_cb), NULL);
+    g_socket_service_start (metrics_service);
+    g_debug ("serving metrics at '%s'", metrics_socket_path);
+    return TRUE;
+}
+
+/*****************************************************************************/
+
 int main (int argc, char **argv)
 {
     GError *error = NULL;
@@ -197,6 +283,10 @@ int main (int argc, char **argv)
     g_log_set_handler ("Qmi", G_LOG_LEVEL_MASK, log_handler, NULL);
     if (verbose_flag)
         qmi_utils_set_traces_enabled (TRUE);
+    if (trace_filter && !qmi_utils_set_traces_filter (trace_filter, &error)) {
+        g_printerr ("error: invalid trace filter: %s\n", error->message);
+        exit (EXIT_FAILURE);
+    }
 
     /* Setup signals */
     g_unix_signal_add (SIGINT,  quit_cb, NULL);
@@ -214,6 +304,34 @@ int main (int argc, char **argv)
         exit (EXIT_FAILURE);
     }
 
+    if (coalesce_flag)
+        qmi_proxy_set_request_coalescing (proxy, TRUE);
+
+    if (linger_time > 0)
+        qmi_proxy_set_device_linger_time (proxy, (guint)linger_time);
+
+    /* Before any device is opened */
+    if (device_threads_flag)
+        qmi_proxy_set_device_threads (proxy, TRUE);
+
+    if (keep_open_paths) {
+        guint i;
+
+        for (i = 0; keep_open_paths[i]; i++) {
+            if (!qmi_proxy_keep_device_open (proxy, keep_open_paths[i], &error)) {
+                g_printerr ("error: cannot keep device '%s' open: %s\n", keep_open_paths[i], error->message);
+                exit (EXIT_FAILURE);
+            }
+        }
+        /* Devices kept open are pointless if the proxy goes away */
+        no_exit_flag = TRUE;
+    }
+
+    if (metrics_socket_path && !setup_metrics_service (&error)) {
+        g_printerr ("error: cannot serve metrics at '%s': %s\n", metrics_socket_path, error->message);
+        exit (EXIT_FAILURE);
+    }
+
     /* Don't exit the proxy when no clients are found */
     if (!no_exit_flag && empty_timeout != 0) {
         g_debug ("proxy will exit after %d secs if unused", empty_timeout);
@@ -231,6 +349,11 @@ int main (int argc, char **argv)
     g_main_loop_unref (loop);
 
     /* Cleanup; releases socket and such */
+    if (metrics_service) {
+        g_socket_service_stop (metrics_service);
+        g_clear_object (&metrics_service);
+        g_unlink (metrics_socket_path);
+    }
     g_object_unref (proxy);
 
     g_debug ("exiting 'qmi-proxy'...");
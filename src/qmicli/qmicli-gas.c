@@ -88,12 +88,21 @@ qmicli_gas_get_option_group (void)
     return group;
 }
 
+static guint n_actions;
+static gboolean checked;
+
+void
+qmicli_gas_options_reset (void)
+{
+    qmicli_reset_option_entries (entries);
+    set_active_firmware_int = -1;
+    n_actions = 0;
+    checked = FALSE;
+}
+
 gboolean
 qmicli_gas_options_enabled (void)
 {
-    static guint n_actions = 0;
-    static gboolean checked = FALSE;
-
     if (checked)
         return !!n_actions;
 
@@ -84,12 +84,20 @@ qmicli_gms_get_option_group (void)
     return group;
 }
 
+static guint n_actions;
+static gboolean checked;
+
+void
+qmicli_gms_options_reset (void)
+{
+    qmicli_reset_option_entries (entries);
+    n_actions = 0;
+    checked = FALSE;
+}
+
 gboolean
 qmicli_gms_options_enabled (void)
 {
-    static guint n_actions = 0;
-    static gboolean checked = FALSE;
-
     if (checked)
         return !!n_actions;
 
@@ -956,3 +956,36 @@ qmicli_parse_key_value_string (const gchar *str,
 
     return TRUE;
 }
+
+void
+qmicli_reset_option_entries (const GOptionEntry *entries)
+{
+    for (; entries->long_name; entries++) {
+        switch (entries->arg) {
+        case G_OPTION_ARG_NONE:
+            *((gboolean *) entries->arg_data) = FALSE;
+            break;
+        case G_OPTION_ARG_INT:
+            *((gint *) entries->arg_data) = 0;
+            break;
+        case G_OPTION_ARG_INT64:
+            *((gint64 *) entries->arg_data) = 0;
+            break;
+        case G_OPTION_ARG_DOUBLE:
+            *((gdouble *) entries->arg_data) = 0.0;
+            break;
+        case G_OPTION_ARG_STRING:
+        case G_OPTION_ARG_FILENAME:
+            g_clear_pointer ((gchar **) entries->arg_data, g_free);
+            break;
+        case G_OPTION_ARG_STRING_ARRAY:
+        case G_OPTION_ARG_FILENAME_ARRAY:
+            g_clear_pointer ((gchar ***) entries->arg_data, g_strfreev);
+            break;
+        case G_OPTION_ARG_CALLBACK:
+        default:
+            /* Callbacks store their own state, reset by the caller */
+            break;
+        }
+    }
+}
@@ -121,6 +121,8 @@ const char *qmicli_earfcn_to_eutra_band_string (guint16 earfcn);
 
 gboolean qmicli_validate_device_open_flags (QmiDeviceOpenFlags mask);
 
+void qmicli_reset_option_entries (const GOptionEntry *entries);
+
 typedef gboolean (*QmiParseKeyValueForeachFn) (const gchar *key,
                                                const gchar *value,
                                                GError **error,
@@ -25,8 +25,14 @@
 #include <stdlib.h>
 #include <locale.h>
 #include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/uio.h>
 
 #include <glib.h>
+#include <glib-unix.h>
 #include <gio/gio.h>
 
 #include <libqmi-glib.h>
@@ -38,6 +44,8 @@
 
 /* Context */
 
+typedef struct _FollowOutput FollowOutput;
+
 typedef enum {
     MONITORING_STEP_FIRST,
     MONITORING_STEP_REGISTER_EVENTS,
@@ -61,6 +69,7 @@ typedef struct {
     guint           set_operation_mode_indication_id;
     guint           get_engine_lock_indication_id;
     guint           set_engine_lock_indication_id;
+    FollowOutput   *follow_output;
 } Context;
 static Context *ctx;
 
@@ -74,6 +83,9 @@ static gint     timeout;
 static gboolean follow_position_report_flag;
 static gboolean follow_gnss_sv_info_flag;
 static gboolean follow_nmea_flag;
+static gchar   *follow_format_str;
+static gint     follow_queue_size;
+static gint     follow_interval;
 static gboolean delete_assistance_data_flag;
 static gboolean get_nmea_types_flag;
 static gchar   *set_nmea_types_str;
@@ -84,6 +96,7 @@ static gchar   *set_engine_lock_str;
 static gboolean noop_flag;
 
 #define DEFAULT_LOC_TIMEOUT_SECS 30
+#define DEFAULT_LOC_FOLLOW_QUEUE_SIZE 64
 
 static GOptionEntry entries[] = {
 #if defined HAVE_QMI_MESSAGE_LOC_START || defined HAVE_QMI_MESSAGE_LOC_STOP
@@ -150,6 +163,26 @@ static GOptionEntry entries[] = {
         NULL,
     },
 #endif
+#if (defined HAVE_QMI_INDICATION_LOC_POSITION_REPORT || \
+     defined HAVE_QMI_INDICATION_LOC_GNSS_SV_INFO ||    \
+     defined HAVE_QMI_INDICATION_LOC_NMEA) &&           \
+    defined HAVE_QMI_MESSAGE_LOC_REGISTER_EVENTS
+    {
+        "loc-follow-format", 0, 0, G_OPTION_ARG_STRING, &follow_format_str,
+        "Format of the records written by the `--loc-follow-*' actions, JSON is one object per line (default text)",
+        "[text|json]",
+    },
+    {
+        "loc-follow-queue-size", 0, 0, G_OPTION_ARG_INT, &follow_queue_size,
+        "Maximum number of records of the `--loc-follow-*' actions waiting to be written, the oldest ones are dropped when the output can't keep up (default 64)",
+        "[N]",
+    },
+    {
+        "loc-follow-interval", 0, 0, G_OPTION_ARG_INT, &follow_interval,
+        "Write at most one record of each kind (each NMEA sentence type, position report or GNSS space vehicle info) every given milliseconds in the `--loc-follow-*' actions, keeping only the latest one (default 0, write all)",
+        "[MS]",
+    },
+#endif
 #if defined HAVE_QMI_MESSAGE_LOC_DELETE_ASSISTANCE_DATA
     {
         "loc-delete-assistance-data", 0, 0, G_OPTION_ARG_NONE, &delete_assistance_data_flag,
@@ -213,11 +246,20 @@ qmicli_loc_get_option_group (void)
     return group;
 }
 
+static guint n_actions;
+static gboolean checked;
+
+void
+qmicli_loc_options_reset (void)
+{
+    qmicli_reset_option_entries (entries);
+    n_actions = 0;
+    checked = FALSE;
+}
+
 gboolean
 qmicli_loc_options_enabled (void)
 {
-    static guint n_actions = 0;
-    static gboolean checked = FALSE;
     gboolean follow_action;
 
     if (checked)
@@ -266,6 +308,28 @@ qmicli_loc_options_enabled (void)
         exit (EXIT_FAILURE);
     }
 
+    if (follow_format_str &&
+        !g_str_equal (follow_format_str, "text") &&
+        !g_str_equal (follow_format_str, "json")) {
+        g_printerr ("error: invalid follow format: '%s' [text|json]\n", follow_format_str);
+        exit (EXIT_FAILURE);
+    }
+
+    if (follow_queue_size < 0) {
+        g_printerr ("error: invalid follow queue size: %d\n", follow_queue_size);
+        exit (EXIT_FAILURE);
+    }
+
+    if (follow_interval < 0) {
+        g_printerr ("error: invalid follow interval: %d\n", follow_interval);
+        exit (EXIT_FAILURE);
+    }
+
+    if ((follow_format_str || follow_queue_size > 0 || follow_interval > 0) && !follow_action) {
+        g_printerr ("error: `--loc-follow-format', `--loc-follow-queue-size' and `--loc-follow-interval' are only applicable with the `--loc-follow-*' actions\n");
+        exit (EXIT_FAILURE);
+    }
+
     /* Actions that require receiving QMI indication messages must specify that
      * indications are expected. */
     if (get_position_report_flag ||
@@ -284,6 +348,368 @@ qmicli_loc_options_enabled (void)
     return !!n_actions;
 }
 
+static void operation_shutdown (gboolean operation_status);
+
+#if (defined HAVE_QMI_INDICATION_LOC_POSITION_REPORT || \
+     defined HAVE_QMI_INDICATION_LOC_GNSS_SV_INFO ||    \
+     defined HAVE_QMI_INDICATION_LOC_NMEA) &&           \
+    defined HAVE_QMI_MESSAGE_LOC_REGISTER_EVENTS
+
+/*****************************************************************************/
+/* Follow output
+ *
+ * Records of the follow actions are not printed from the indication handlers,
+ * they are queued and written to stdout (made non-blocking) when it is
+ * writable, so that a slow reader never stalls the main loop and thus the
+ * processing of the device input. The queue is bounded, the oldest records
+ * are dropped when full. Optionally, records of the same kind are coalesced so
+ * that only the latest one is written once per interval. */
+
+#define FOLLOW_OUTPUT_IOV_MAX 64
+
+typedef struct {
+    gchar   *key;
+    GString *data;
+} FollowRecord;
+
+struct _FollowOutput {
+    /* Records waiting to be written, the first one maybe partially */
+    GQueue    *queue;
+    guint      queue_size;
+    gsize      offset;
+    guint      writable_id;
+    gboolean   fd_was_blocking;
+    /* Latest record of each kind, when coalescing */
+    GPtrArray *pending;
+    guint      interval_id;
+    guint64    n_dropped;
+    guint64    n_coalesced;
+};
+
+static gboolean follow_output_flush (FollowOutput *self);
+
+static void
+follow_record_free (FollowRecord *record)
+{
+    g_free (record->key);
+    g_string_free (record->data, TRUE);
+    g_slice_free (FollowRecord, record);
+}
+
+static gboolean
+follow_output_writable_cb (gint          fd,
+                           GIOCondition  condition,
+                           FollowOutput *self)
+{
+    if (!follow_output_flush (self)) {
+        /* Reader gone, nothing else will ever be written */
+        self->writable_id = 0;
+        operation_shutdown (TRUE);
+        return G_SOURCE_REMOVE;
+    }
+
+    if (g_queue_is_empty (self->queue)) {
+        self->writable_id = 0;
+        return G_SOURCE_REMOVE;
+    }
+
+    return G_SOURCE_CONTINUE;
+}
+
+static gboolean
+follow_output_flush (FollowOutput *self)
+{
+    while (!g_queue_is_empty (self->queue)) {
+        struct iovec iov[FOLLOW_OUTPUT_IOV_MAX];
+        GList *l;
+        gsize offset;
+        guint n;
+        gssize r;
+
+        /* Gather as many queued records as possible in a single write */
+        offset = self->offset;
+        for (l = self->queue->head, n = 0; l && n < FOLLOW_OUTPUT_IOV_MAX; l = g_list_next (l), n++) {
+            FollowRecord *record = l->data;
+
+            iov[n].iov_base = record->data->str + offset;
+            iov[n].iov_len = record->data->len - offset;
+            offset = 0;
+        }
+
+        r = writev (STDOUT_FILENO, iov, n);
+        if (r < 0) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+            g_printerr ("error: couldn't write follow output: %s\n", g_strerror (errno));
+            return FALSE;
+        }
+
+        /* Release the records written completely */
+        while (r > 0) {
+            FollowRecord *record = g_queue_peek_head (self->queue);
+            gsize left = record->data->len - self->offset;
+
+            if ((gsize)r < left) {
+                self->offset += r;
+                break;
+            }
+            r -= left;
+            self->offset = 0;
+            follow_record_free (g_queue_pop_head (self->queue));
+        }
+    }
+
+    /* Keep on writing once the reader catches up, if anything is left */
+    if (!g_queue_is_empty (self->queue) && !self->writable_id)
+        self->writable_id = g_unix_fd_add (STDOUT_FILENO,
+                                           G_IO_OUT | G_IO_ERR | G_IO_HUP,
+                                           (GUnixFDSourceFunc) follow_output_writable_cb,
+                                           self);
+    return TRUE;
+}
+
+static void
+follow_output_enqueue (FollowOutput *self,
+                       FollowRecord *record)
+{
+    /* Queue full: drop the oldest record not being written */
+    if (g_queue_get_length (self->queue) >= self->queue_size) {
+        guint n = self->offset ? 1 : 0;
+
+        if (n < g_queue_get_length (self->queue)) {
+            follow_record_free (g_queue_pop_nth (self->queue, n));
+            if (self->n_dropped++ == 0)
+                g_printerr ("warning: follow output can't keep up: dropping records\n");
+        }
+    }
+
+    g_queue_push_tail (self->queue, record);
+}
+
+static gboolean
+follow_output_interval_cb (FollowOutput *self)
+{
+    guint i;
+
+    /* Nothing coalesced since the last write, write the next record of each
+     * kind right away */
+    if (!self->pending->len) {
+        self->interval_id = 0;
+        return G_SOURCE_REMOVE;
+    }
+
+    for (i = 0; i < self->pending->len; i++)
+        follow_output_enqueue (self, g_ptr_array_index (self->pending, i));
+    g_ptr_array_set_size (self->pending, 0);
+
+    if (!follow_output_flush (self)) {
+        self->interval_id = 0;
+        operation_shutdown (TRUE);
+        return G_SOURCE_REMOVE;
+    }
+    return G_SOURCE_CONTINUE;
+}
+
+static void
+follow_output_push (FollowOutput *self,
+                    const gchar  *key,
+                    GString      *data)
+{
+    FollowRecord *record;
+
+    record = g_slice_new (FollowRecord);
+    record->key = g_strdup (key);
+    record->data = data;
+
+    if (follow_interval > 0) {
+        guint i;
+
+        /* Within the interval, the latest record of each kind wins */
+        if (self->interval_id) {
+            for (i = 0; i < self->pending->len; i++) {
+                FollowRecord *pending = g_ptr_array_index (self->pending, i);
+
+                if (g_str_equal (pending->key, key)) {
+                    follow_record_free (pending);
+                    g_ptr_array_index (self->pending, i) = record;
+                    self->n_coalesced++;
+                    return;
+                }
+            }
+            g_ptr_array_add (self->pending, record);
+            return;
+        }
+
+        self->interval_id = g_timeout_add (follow_interval,
+                                           (GSourceFunc) follow_output_interval_cb,
+                                           self);
+    }
+
+    follow_output_enqueue (self, record);
+    if (!follow_output_flush (self))
+        operation_shutdown (TRUE);
+}
+
+static FollowOutput *
+follow_output_new (void)
+{
+    FollowOutput *self;
+    gint          flags;
+
+    self = g_slice_new0 (FollowOutput);
+    self->queue = g_queue_new ();
+    self->queue_size = follow_queue_size > 0 ? follow_queue_size : DEFAULT_LOC_FOLLOW_QUEUE_SIZE;
+    self->pending = g_ptr_array_new ();
+
+    /* Anything printed before must go out first */
+    fflush (stdout);
+
+    flags = fcntl (STDOUT_FILENO, F_GETFL);
+    self->fd_was_blocking = (flags >= 0 && !(flags & O_NONBLOCK));
+    if (self->fd_was_blocking && !g_unix_set_fd_nonblocking (STDOUT_FILENO, TRUE, NULL))
+        self->fd_was_blocking = FALSE;
+
+    return self;
+}
+
+static void
+follow_output_free (FollowOutput *self)
+{
+    guint i;
+
+    if (self->interval_id)
+        g_source_remove (self->interval_id);
+    if (self->writable_id)
+        g_source_remove (self->writable_id);
+
+    /* Write whatever is left, blocking */
+    if (self->fd_was_blocking)
+        g_unix_set_fd_nonblocking (STDOUT_FILENO, FALSE, NULL);
+
+    for (i = 0; i < self->pending->len; i++)
+        g_queue_push_tail (self->queue, g_ptr_array_index (self->pending, i));
+    g_ptr_array_set_size (self->pending, 0);
+
+    while (!g_queue_is_empty (self->queue)) {
+        FollowRecord *record;
+        gsize         offset;
+
+        record = g_queue_pop_head (self->queue);
+        offset = self->offset;
+        self->offset = 0;
+        while (offset < record->data->len) {
+            gssize r;
+
+            r = write (STDOUT_FILENO, record->data->str + offset, record->data->len - offset);
+            if (r < 0 && errno == EINTR)
+                continue;
+            if (r <= 0)
+                break;
+            offset += r;
+        }
+        follow_record_free (record);
+    }
+
+    if (self->n_dropped || self->n_coalesced)
+        g_debug ("follow output: %" G_GUINT64_FORMAT " records dropped, %" G_GUINT64_FORMAT " coalesced",
+                 self->n_dropped, self->n_coalesced);
+
+    g_ptr_array_unref (self->pending);
+    g_queue_free (self->queue);
+    g_slice_free (FollowOutput, self);
+}
+
+/* Records of GET actions are printed right away */
+static void
+loc_output (const gchar *key,
+            GString     *data)
+{
+    if (!ctx->follow_output) {
+        g_print ("%s", data->str);
+        g_string_free (data, TRUE);
+        return;
+    }
+
+    follow_output_push (ctx->follow_output, key, data);
+}
+
+static gboolean
+loc_output_json (void)
+{
+    return (follow_format_str && g_str_equal (follow_format_str, "json"));
+}
+
+static GString *
+json_record_new (const gchar *type)
+{
+    GString *json;
+
+    json = g_string_new (NULL);
+    g_string_append_printf (json, "{\"type\":\"%s\",\"time\":%" G_GINT64_FORMAT,
+                            type, g_get_real_time () / 1000);
+    return json;
+}
+
+static void
+json_record_complete (GString *json)
+{
+    g_string_append (json, "}\n");
+}
+
+static void
+json_append_string (GString     *json,
+                    const gchar *name,
+                    const gchar *value)
+{
+    const gchar *p;
+
+    g_string_append_printf (json, ",\"%s\":\"", name);
+    for (p = value; *p; p++) {
+        switch (*p) {
+        case '"':
+            g_string_append (json, "\\\"");
+            break;
+        case '\\':
+            g_string_append (json, "\\\\");
+            break;
+        case '\n':
+            g_string_append (json, "\\n");
+            break;
+        case '\r':
+            g_string_append (json, "\\r");
+            break;
+        default:
+            if ((guchar)*p < 0x20)
+                g_string_append_printf (json, "\\u%04x", (guint)(guchar)*p);
+            else
+                g_string_append_c (json, *p);
+            break;
+        }
+    }
+    g_string_append_c (json, '"');
+}
+
+static void
+json_append_number (GString     *json,
+                    const gchar *name,
+                    gdouble      value,
+                    const gchar *format)
+{
+    gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+    /* Numbers are written locale-independent, and NaN/Inf aren't JSON */
+    if (!isfinite (value))
+        g_string_append_printf (json, ",\"%s\":null", name);
+    else
+        g_string_append_printf (json, ",\"%s\":%s", name, g_ascii_formatd (buf, sizeof (buf), format, value));
+}
+
+#endif /* HAVE_QMI_INDICATION_LOC_POSITION_REPORT
+        * HAVE_QMI_INDICATION_LOC_GNSS_SV_INFO
+        * HAVE_QMI_INDICATION_LOC_NMEA */
+
 static void
 context_free (Context *context)
 {
@@ -323,6 +749,14 @@ context_free (Context *context)
     if (context->set_engine_lock_indication_id)
         g_signal_handler_disconnect (context->client, context->set_engine_lock_indication_id);
 
+#if (defined HAVE_QMI_INDICATION_LOC_POSITION_REPORT || \
+     defined HAVE_QMI_INDICATION_LOC_GNSS_SV_INFO ||    \
+     defined HAVE_QMI_INDICATION_LOC_NMEA) &&           \
+    defined HAVE_QMI_MESSAGE_LOC_REGISTER_EVENTS
+    if (context->follow_output)
+        follow_output_free (context->follow_output);
+#endif
+
     g_clear_object (&context->cancellable);
     g_clear_object (&context->client);
     g_clear_object (&context->device);
@@ -381,12 +815,29 @@ static void
 nmea_received (QmiClientLoc               *client,
                QmiIndicationLocNmeaOutput *output)
 {
-    const gchar *nmea = NULL;
+    const gchar       *nmea = NULL;
+    g_autofree gchar  *sentence = NULL;
+    GString           *record;
 
     qmi_indication_loc_nmea_output_get_nmea_string (output, &nmea, NULL);
-    if (nmea)
+    if (!nmea)
+        return;
+
+    /* Traces of each sentence type (e.g. $GPGGA) are coalesced separately */
+    sentence = g_strndup (nmea, strcspn (nmea, ",\r\n"));
+
+    if (loc_output_json ()) {
+        g_autofree gchar *trace = NULL;
+
+        trace = g_strndup (nmea, strcspn (nmea, "\r\n"));
+        record = json_record_new ("nmea");
+        json_append_string (record, "trace", trace);
+        json_record_complete (record);
+    } else
         /* Note: NMEA traces already have an EOL */
-        g_print ("%s", nmea);
+        record = g_string_new (nmea);
+
+    loc_output (sentence, record);
 }
 
 #endif /* HAVE_QMI_INDICATION_LOC_NMEA */
@@ -394,51 +845,107 @@ nmea_received (QmiClientLoc               *client,
 #if defined HAVE_QMI_INDICATION_LOC_GNSS_SV_INFO && defined HAVE_QMI_MESSAGE_LOC_REGISTER_EVENTS
 
 static void
-gnss_sv_info_received (QmiClientLoc                     *client,
-                       QmiIndicationLocGnssSvInfoOutput *output)
+gnss_sv_info_build_text (QmiIndicationLocGnssSvInfoOutput *output,
+                         GString                          *record)
 {
     GArray   *satellite_infos = NULL;
     guint     i, num_satellite_infos;
     gboolean  altitude_assumed;
 
     if (qmi_indication_loc_gnss_sv_info_output_get_altitude_assumed (output, &altitude_assumed, NULL))
-        g_print ("[gnss sv info] Altitude assumed: %s\n", altitude_assumed ? "yes" : "no");
+        g_string_append_printf (record, "[gnss sv info] Altitude assumed: %s\n", altitude_assumed ? "yes" : "no");
     else
-        g_print ("[gnss sv info] Altitude assumed: n/a\n");
+        g_string_append (record, "[gnss sv info] Altitude assumed: n/a\n");
 
     qmi_indication_loc_gnss_sv_info_output_get_list (output, &satellite_infos, NULL);
 
     num_satellite_infos = satellite_infos ? satellite_infos->len : 0;
-    g_print ("[gnss sv info] %d satellites detected:\n", num_satellite_infos);
+    g_string_append_printf (record, "[gnss sv info] %d satellites detected:\n", num_satellite_infos);
     for (i = 0; i < num_satellite_infos; i++) {
         QmiIndicationLocGnssSvInfoOutputListElement *element;
 
         element = &g_array_index (satellite_infos, QmiIndicationLocGnssSvInfoOutputListElement, i);
-        g_print ("   [satellite #%u]\n", i);
-        g_print ("      system:           %s\n", (element->valid_information & QMI_LOC_SATELLITE_VALID_INFORMATION_SYSTEM) ? qmi_loc_system_get_string (element->system) : "n/a");
+        g_string_append_printf (record, "   [satellite #%u]\n", i);
+        g_string_append_printf (record, "      system:           %s\n", (element->valid_information & QMI_LOC_SATELLITE_VALID_INFORMATION_SYSTEM) ? qmi_loc_system_get_string (element->system) : "n/a");
         if (element->valid_information & QMI_LOC_SATELLITE_VALID_INFORMATION_GNSS_SATELLITE_ID)
-            g_print ("      satellite id:     %u\n", element->gnss_satellite_id);
+            g_string_append_printf (record, "      satellite id:     %u\n", element->gnss_satellite_id);
         else
-            g_print ("      satellite id:     n/a\n");
-        g_print ("      health status:    %s\n", (element->valid_information & QMI_LOC_SATELLITE_VALID_INFORMATION_HEALTH_STATUS) ? qmi_loc_health_status_get_string (element->health_status) : "n/a");
-        g_print ("      satellite status: %s\n", (element->valid_information & QMI_LOC_SATELLITE_VALID_INFORMATION_PROCESS_STATUS) ? qmi_loc_satellite_status_get_string (element->satellite_status) : "n/a");
-        g_print ("      navigation data:  %s\n", (element->valid_information & QMI_LOC_SATELLITE_VALID_INFORMATION_SATELLITE_INFO_MASK) ? qmi_loc_navigation_data_get_string (element->navigation_data) : "n/a");
+            g_string_append (record, "      satellite id:     n/a\n");
+        g_string_append_printf (record, "      health status:    %s\n", (element->valid_information & QMI_LOC_SATELLITE_VALID_INFORMATION_HEALTH_STATUS) ? qmi_loc_health_status_get_string (element->health_status) : "n/a");
+        g_string_append_printf (record, "      satellite status: %s\n", (element->valid_information & QMI_LOC_SATELLITE_VALID_INFORMATION_PROCESS_STATUS) ? qmi_loc_satellite_status_get_string (element->satellite_status) : "n/a");
+        g_string_append_printf (record, "      navigation data:  %s\n", (element->valid_information & QMI_LOC_SATELLITE_VALID_INFORMATION_SATELLITE_INFO_MASK) ? qmi_loc_navigation_data_get_string (element->navigation_data) : "n/a");
 
         if (element->valid_information & QMI_LOC_SATELLITE_VALID_INFORMATION_ELEVATION)
-            g_print ("      elevation:        %lf\n", (gdouble)element->elevation_degrees);
+            g_string_append_printf (record, "      elevation:        %lf\n", (gdouble)element->elevation_degrees);
         else
-            g_print ("      elevation:        n/a\n");
+            g_string_append (record, "      elevation:        n/a\n");
 
         if (element->valid_information & QMI_LOC_SATELLITE_VALID_INFORMATION_AZIMUTH)
-            g_print ("      azimuth:          %lf\n", (gdouble)element->azimuth_degrees);
+            g_string_append_printf (record, "      azimuth:          %lf\n", (gdouble)element->azimuth_degrees);
         else
-            g_print ("      azimuth:          n/a\n");
+            g_string_append (record, "      azimuth:          n/a\n");
 
         if (element->valid_information & QMI_LOC_SATELLITE_VALID_INFORMATION_SIGNAL_TO_NOISE_RATIO)
-            g_print ("      SNR:              %lf\n", (gdouble)element->signal_to_noise_ratio_bhz);
+            g_string_append_printf (record, "      SNR:              %lf\n", (gdouble)element->signal_to_noise_ratio_bhz);
         else
-            g_print ("      SNR:              n/a\n");
+            g_string_append (record, "      SNR:              n/a\n");
     }
+}
+
+static void
+gnss_sv_info_build_json (QmiIndicationLocGnssSvInfoOutput *output,
+                         GString                          *record)
+{
+    GArray   *satellite_infos = NULL;
+    guint     i;
+    gboolean  altitude_assumed;
+
+    if (qmi_indication_loc_gnss_sv_info_output_get_altitude_assumed (output, &altitude_assumed, NULL))
+        g_string_append_printf (record, ",\"altitude-assumed\":%s", altitude_assumed ? "true" : "false");
+
+    g_string_append (record, ",\"satellites\":[");
+    qmi_indication_loc_gnss_sv_info_output_get_list (output, &satellite_infos, NULL);
+    for (i = 0; satellite_infos && i < satellite_infos->len; i++) {
+        QmiIndicationLocGnssSvInfoOutputListElement *element;
+
+        element = &g_array_index (satellite_infos, QmiIndicationLocGnssSvInfoOutputListElement, i);
+        g_string_append_printf (record, "%s{\"index\":%u", i ? "," : "", i);
+        if (element->valid_information & QMI_LOC_SATELLITE_VALID_INFORMATION_SYSTEM)
+            json_append_string (record, "system", qmi_loc_system_get_string (element->system));
+        if (element->valid_information & QMI_LOC_SATELLITE_VALID_INFORMATION_GNSS_SATELLITE_ID)
+            g_string_append_printf (record, ",\"satellite-id\":%u", element->gnss_satellite_id);
+        if (element->valid_information & QMI_LOC_SATELLITE_VALID_INFORMATION_HEALTH_STATUS)
+            json_append_string (record, "health-status", qmi_loc_health_status_get_string (element->health_status));
+        if (element->valid_information & QMI_LOC_SATELLITE_VALID_INFORMATION_PROCESS_STATUS)
+            json_append_string (record, "satellite-status", qmi_loc_satellite_status_get_string (element->satellite_status));
+        if (element->valid_information & QMI_LOC_SATELLITE_VALID_INFORMATION_SATELLITE_INFO_MASK)
+            json_append_string (record, "navigation-data", qmi_loc_navigation_data_get_string (element->navigation_data));
+        if (element->valid_information & QMI_LOC_SATELLITE_VALID_INFORMATION_ELEVATION)
+            json_append_number (record, "elevation", element->elevation_degrees, "%.7g");
+        if (element->valid_information & QMI_LOC_SATELLITE_VALID_INFORMATION_AZIMUTH)
+            json_append_number (record, "azimuth", element->azimuth_degrees, "%.7g");
+        if (element->valid_information & QMI_LOC_SATELLITE_VALID_INFORMATION_SIGNAL_TO_NOISE_RATIO)
+            json_append_number (record, "snr", element->signal_to_noise_ratio_bhz, "%.7g");
+        g_string_append_c (record, '}');
+    }
+    g_string_append_c (record, ']');
+}
+
+static void
+gnss_sv_info_received (QmiClientLoc                     *client,
+                       QmiIndicationLocGnssSvInfoOutput *output)
+{
+    GString *record;
+
+    if (loc_output_json ()) {
+        record = json_record_new ("gnss-sv-info");
+        gnss_sv_info_build_json (output, record);
+        json_record_complete (record);
+    } else {
+        record = g_string_new (NULL);
+        gnss_sv_info_build_text (output, record);
+    }
+    loc_output ("gnss-sv-info", record);
 
     /* Terminate GET request */
     if (get_gnss_sv_info_flag)
@@ -450,206 +957,325 @@ gnss_sv_info_received (QmiClientLoc                     *client,
 #if defined HAVE_QMI_INDICATION_LOC_POSITION_REPORT && defined HAVE_QMI_MESSAGE_LOC_REGISTER_EVENTS
 
 static void
-position_report_received (QmiClientLoc                         *client,
-                          QmiIndicationLocPositionReportOutput *output)
+position_report_build_text (QmiIndicationLocPositionReportOutput *output,
+                            GString                              *record)
 {
-    QmiLocSessionStatus status;
+    gdouble auxd;
+    gfloat auxf;
+    guint8 aux8;
+    guint32 aux32;
+    guint64 aux64;
+    QmiLocReliability reliability;
+    QmiLocTechnologyUsed technology;
+    QmiLocTimeSource time_source;
+    QmiLocSensorDataUsage sensor_data_usage;
+    QmiIndicationLocPositionReportOutputDilutionOfPrecision dop;
+    QmiIndicationLocPositionReportOutputGpsTime gps_time;
+    gchar *auxs;
+    gboolean auxb;
+    GArray *array;
+
+    if (qmi_indication_loc_position_report_output_get_latitude (output, &auxd, NULL))
+        g_string_append_printf (record, "   latitude:  %lf degrees\n", auxd);
+    else
+        g_string_append (record, "   latitude:  n/a\n");
 
-    qmi_indication_loc_position_report_output_get_session_status (output, &status, NULL);
-    g_print ("[position report] status: %s\n", qmi_loc_session_status_get_string (status));
-
-    if (status == QMI_LOC_SESSION_STATUS_SUCCESS || status == QMI_LOC_SESSION_STATUS_IN_PROGRESS) {
-        gdouble auxd;
-        gfloat auxf;
-        guint8 aux8;
-        guint32 aux32;
-        guint64 aux64;
-        QmiLocReliability reliability;
-        QmiLocTechnologyUsed technology;
-        QmiLocTimeSource time_source;
-        QmiLocSensorDataUsage sensor_data_usage;
-        QmiIndicationLocPositionReportOutputDilutionOfPrecision dop;
-        QmiIndicationLocPositionReportOutputGpsTime gps_time;
-        gchar *auxs;
-        gboolean auxb;
-        GArray *array;
-
-        if (qmi_indication_loc_position_report_output_get_latitude (output, &auxd, NULL))
-            g_print ("   latitude:  %lf degrees\n", auxd);
-        else
-            g_print ("   latitude:  n/a\n");
+    if (qmi_indication_loc_position_report_output_get_longitude (output, &auxd, NULL))
+        g_string_append_printf (record, "   longitude: %lf degrees\n", auxd);
+    else
+        g_string_append (record, "   longitude: n/a\n");
 
-        if (qmi_indication_loc_position_report_output_get_longitude (output, &auxd, NULL))
-            g_print ("   longitude: %lf degrees\n", auxd);
-        else
-            g_print ("   longitude: n/a\n");
+    if (qmi_indication_loc_position_report_output_get_horizontal_uncertainty_circular (output, &auxf, NULL))
+        g_string_append_printf (record, "   circular horizontal position uncertainty:            %lf meters\n", (gdouble)auxf);
+    else
+        g_string_append (record, "   circular horizontal position uncertainty:            n/a\n");
 
-        if (qmi_indication_loc_position_report_output_get_horizontal_uncertainty_circular (output, &auxf, NULL))
-            g_print ("   circular horizontal position uncertainty:            %lf meters\n", (gdouble)auxf);
-        else
-            g_print ("   circular horizontal position uncertainty:            n/a\n");
+    if (qmi_indication_loc_position_report_output_get_horizontal_uncertainty_elliptical_minor (output, &auxf, NULL))
+        g_string_append_printf (record, "   horizontal elliptical uncertainty (semi-minor axis): %lf meters\n", (gdouble)auxf);
+    else
+        g_string_append (record, "   horizontal elliptical uncertainty (semi-minor axis): n/a\n");
 
-        if (qmi_indication_loc_position_report_output_get_horizontal_uncertainty_elliptical_minor (output, &auxf, NULL))
-            g_print ("   horizontal elliptical uncertainty (semi-minor axis): %lf meters\n", (gdouble)auxf);
-        else
-            g_print ("   horizontal elliptical uncertainty (semi-minor axis): n/a\n");
+    if (qmi_indication_loc_position_report_output_get_horizontal_uncertainty_elliptical_major (output, &auxf, NULL))
+        g_string_append_printf (record, "   horizontal elliptical uncertainty (semi-major axis): %lf meters\n", (gdouble)auxf);
+    else
+        g_string_append (record, "   horizontal elliptical uncertainty (semi-major axis): n/a\n");
 
-        if (qmi_indication_loc_position_report_output_get_horizontal_uncertainty_elliptical_major (output, &auxf, NULL))
-            g_print ("   horizontal elliptical uncertainty (semi-major axis): %lf meters\n", (gdouble)auxf);
-        else
-            g_print ("   horizontal elliptical uncertainty (semi-major axis): n/a\n");
+    if (qmi_indication_loc_position_report_output_get_horizontal_uncertainty_elliptical_azimuth (output, &auxf, NULL))
+        g_string_append_printf (record, "   horizontal elliptical uncertainty azimuth:           %lf meters\n", (gdouble)auxf);
+    else
+        g_string_append (record, "   horizontal elliptical uncertainty azimuth:           n/a\n");
 
-        if (qmi_indication_loc_position_report_output_get_horizontal_uncertainty_elliptical_azimuth (output, &auxf, NULL))
-            g_print ("   horizontal elliptical uncertainty azimuth:           %lf meters\n", (gdouble)auxf);
-        else
-            g_print ("   horizontal elliptical uncertainty azimuth:           n/a\n");
+    if (qmi_indication_loc_position_report_output_get_horizontal_confidence (output, &aux8, NULL))
+        g_string_append_printf (record, "   horizontal confidence: %u%%\n", aux8);
+    else
+        g_string_append (record, "   horizontal confidence: n/a\n");
 
-        if (qmi_indication_loc_position_report_output_get_horizontal_confidence (output, &aux8, NULL))
-            g_print ("   horizontal confidence: %u%%\n", aux8);
-        else
-            g_print ("   horizontal confidence: n/a\n");
+    if (qmi_indication_loc_position_report_output_get_horizontal_reliability (output, &reliability, NULL))
+        g_string_append_printf (record, "   horizontal reliability: %s\n", qmi_loc_reliability_get_string (reliability));
+    else
+        g_string_append (record, "   horizontal reliability: n/a\n");
 
-        if (qmi_indication_loc_position_report_output_get_horizontal_reliability (output, &reliability, NULL))
-            g_print ("   horizontal reliability: %s\n", qmi_loc_reliability_get_string (reliability));
-        else
-            g_print ("   horizontal reliability: n/a\n");
+    if (qmi_indication_loc_position_report_output_get_horizontal_speed (output, &auxf, NULL))
+        g_string_append_printf (record, "   horizontal speed: %lf m/s\n", (gdouble)auxf);
+    else
+        g_string_append (record, "   horizontal speed: n/a\n");
 
-        if (qmi_indication_loc_position_report_output_get_horizontal_speed (output, &auxf, NULL))
-            g_print ("   horizontal speed: %lf m/s\n", (gdouble)auxf);
-        else
-            g_print ("   horizontal speed: n/a\n");
+    if (qmi_indication_loc_position_report_output_get_speed_uncertainty (output, &auxf, NULL))
+        g_string_append_printf (record, "   speed uncertainty: %lf m/s\n", (gdouble)auxf);
+    else
+        g_string_append (record, "   speed uncertainty: n/a\n");
 
-        if (qmi_indication_loc_position_report_output_get_speed_uncertainty (output, &auxf, NULL))
-            g_print ("   speed uncertainty: %lf m/s\n", (gdouble)auxf);
-        else
-            g_print ("   speed uncertainty: n/a\n");
+    if (qmi_indication_loc_position_report_output_get_altitude_from_ellipsoid (output, &auxf, NULL))
+        g_string_append_printf (record, "   altitude w.r.t. ellipsoid: %lf meters\n", (gdouble)auxf);
+    else
+        g_string_append (record, "   altitude w.r.t. ellipsoid: n/a\n");
 
-        if (qmi_indication_loc_position_report_output_get_altitude_from_ellipsoid (output, &auxf, NULL))
-            g_print ("   altitude w.r.t. ellipsoid: %lf meters\n", (gdouble)auxf);
-        else
-            g_print ("   altitude w.r.t. ellipsoid: n/a\n");
+    if (qmi_indication_loc_position_report_output_get_altitude_from_sealevel (output, &auxf, NULL))
+        g_string_append_printf (record, "   altitude w.r.t. mean sea level: %lf meters\n", (gdouble)auxf);
+    else
+        g_string_append (record, "   altitude w.r.t. mean sea level: n/a\n");
 
-        if (qmi_indication_loc_position_report_output_get_altitude_from_sealevel (output, &auxf, NULL))
-            g_print ("   altitude w.r.t. mean sea level: %lf meters\n", (gdouble)auxf);
-        else
-            g_print ("   altitude w.r.t. mean sea level: n/a\n");
+    if (qmi_indication_loc_position_report_output_get_vertical_uncertainty (output, &auxf, NULL))
+        g_string_append_printf (record, "   vertical uncertainty: %lf meters\n", (gdouble)auxf);
+    else
+        g_string_append (record, "   vertical uncertainty: n/a\n");
 
-        if (qmi_indication_loc_position_report_output_get_vertical_uncertainty (output, &auxf, NULL))
-            g_print ("   vertical uncertainty: %lf meters\n", (gdouble)auxf);
-        else
-            g_print ("   vertical uncertainty: n/a\n");
+    if (qmi_indication_loc_position_report_output_get_vertical_confidence (output, &aux8, NULL))
+        g_string_append_printf (record, "   vertical confidence: %u%%\n", aux8);
+    else
+        g_string_append (record, "   vertical confidence: n/a\n");
 
-        if (qmi_indication_loc_position_report_output_get_vertical_confidence (output, &aux8, NULL))
-            g_print ("   vertical confidence: %u%%\n", aux8);
-        else
-            g_print ("   vertical confidence: n/a\n");
+    if (qmi_indication_loc_position_report_output_get_vertical_reliability (output, &reliability, NULL))
+        g_string_append_printf (record, "   vertical reliability: %s\n", qmi_loc_reliability_get_string (reliability));
+    else
+        g_string_append (record, "   vertical reliability: n/a\n");
 
-        if (qmi_indication_loc_position_report_output_get_vertical_reliability (output, &reliability, NULL))
-            g_print ("   vertical reliability: %s\n", qmi_loc_reliability_get_string (reliability));
-        else
-            g_print ("   vertical reliability: n/a\n");
+    if (qmi_indication_loc_position_report_output_get_vertical_speed (output, &auxf, NULL))
+        g_string_append_printf (record, "   vertical speed: %lf m/s\n", (gdouble)auxf);
+    else
+        g_string_append (record, "   vertical speed: n/a\n");
 
-        if (qmi_indication_loc_position_report_output_get_vertical_speed (output, &auxf, NULL))
-            g_print ("   vertical speed: %lf m/s\n", (gdouble)auxf);
-        else
-            g_print ("   vertical speed: n/a\n");
+    if (qmi_indication_loc_position_report_output_get_heading (output, &auxf, NULL))
+        g_string_append_printf (record, "   heading: %lf degrees\n", (gdouble)auxf);
+    else
+        g_string_append (record, "   heading: n/a\n");
 
-        if (qmi_indication_loc_position_report_output_get_heading (output, &auxf, NULL))
-            g_print ("   heading: %lf degrees\n", (gdouble)auxf);
-        else
-            g_print ("   heading: n/a\n");
+    if (qmi_indication_loc_position_report_output_get_heading_uncertainty (output, &auxf, NULL))
+        g_string_append_printf (record, "   heading uncertainty: %lf meters\n", (gdouble)auxf);
+    else
+        g_string_append (record, "   heading uncertainty: n/a\n");
 
-        if (qmi_indication_loc_position_report_output_get_heading_uncertainty (output, &auxf, NULL))
-            g_print ("   heading uncertainty: %lf meters\n", (gdouble)auxf);
-        else
-            g_print ("   heading uncertainty: n/a\n");
+    if (qmi_indication_loc_position_report_output_get_magnetic_deviation (output, &auxf, NULL))
+        g_string_append_printf (record, "   magnetic deviation: %lf degrees\n", (gdouble)auxf);
+    else
+        g_string_append (record, "   magnetic deviation: n/a\n");
+
+    if (qmi_indication_loc_position_report_output_get_technology_used (output, &technology, NULL)) {
+        auxs = qmi_loc_technology_used_build_string_from_mask (technology);
+        g_string_append_printf (record, "   technology: %s\n", auxs);
+        g_free (auxs);
+    } else
+        g_string_append (record, "   technology: n/a\n");
+
+    if (qmi_indication_loc_position_report_output_get_dilution_of_precision (output, &dop, NULL)) {
+        g_string_append_printf (record, "   position DOP:   %lf\n", (gdouble)dop.position_dilution_of_precision);
+        g_string_append_printf (record, "   horizontal DOP: %lf\n", (gdouble)dop.horizontal_dilution_of_precision);
+        g_string_append_printf (record, "   vertical DOP:   %lf\n", (gdouble)dop.vertical_dilution_of_precision);
+    } else {
+        g_string_append (record, "   position DOP:   n/a\n");
+        g_string_append (record, "   horizontal DOP: n/a\n");
+        g_string_append (record, "   vertical DOP:   n/a\n");
+    }
 
-        if (qmi_indication_loc_position_report_output_get_magnetic_deviation (output, &auxf, NULL))
-            g_print ("   magnetic deviation: %lf degrees\n", (gdouble)auxf);
-        else
-            g_print ("   magnetic deviation: n/a\n");
-
-        if (qmi_indication_loc_position_report_output_get_technology_used (output, &technology, NULL)) {
-            auxs = qmi_loc_technology_used_build_string_from_mask (technology);
-            g_print ("   technology: %s\n", auxs);
-            g_free (auxs);
-        } else
-            g_print ("   technology: n/a\n");
-
-        if (qmi_indication_loc_position_report_output_get_dilution_of_precision (output, &dop, NULL)) {
-            g_print ("   position DOP:   %lf\n", (gdouble)dop.position_dilution_of_precision);
-            g_print ("   horizontal DOP: %lf\n", (gdouble)dop.horizontal_dilution_of_precision);
-            g_print ("   vertical DOP:   %lf\n", (gdouble)dop.vertical_dilution_of_precision);
-        } else {
-            g_print ("   position DOP:   n/a\n");
-            g_print ("   horizontal DOP: n/a\n");
-            g_print ("   vertical DOP:   n/a\n");
-        }
+    if (qmi_indication_loc_position_report_output_get_utc_timestamp (output, &aux64, NULL))
+        g_string_append_printf (record, "   UTC timestamp: %" G_GUINT64_FORMAT " ms\n", aux64);
+    else
+        g_string_append (record, "   UTC timestamp: n/a\n");
 
-        if (qmi_indication_loc_position_report_output_get_utc_timestamp (output, &aux64, NULL))
-            g_print ("   UTC timestamp: %" G_GUINT64_FORMAT " ms\n", aux64);
-        else
-            g_print ("   UTC timestamp: n/a\n");
+    if (qmi_indication_loc_position_report_output_get_leap_seconds (output, &aux8, NULL))
+        g_string_append_printf (record, "   Leap seconds: %u\n", aux8);
+    else
+        g_string_append (record, "   Leap seconds: n/a\n");
 
-        if (qmi_indication_loc_position_report_output_get_leap_seconds (output, &aux8, NULL))
-            g_print ("   Leap seconds: %u\n", aux8);
-        else
-            g_print ("   Leap seconds: n/a\n");
+    if (qmi_indication_loc_position_report_output_get_gps_time (output, &gps_time, NULL))
+        g_string_append_printf (record, "   GPS time: %u weeks and %ums\n", gps_time.gps_weeks, gps_time.gps_time_of_week_milliseconds);
+    else
+        g_string_append (record, "   GPS time: n/a\n");
 
-        if (qmi_indication_loc_position_report_output_get_gps_time (output, &gps_time, NULL))
-            g_print ("   GPS time: %u weeks and %ums\n", gps_time.gps_weeks, gps_time.gps_time_of_week_milliseconds);
-        else
-            g_print ("   GPS time: n/a\n");
+    if (qmi_indication_loc_position_report_output_get_time_uncertainty (output, &auxf, NULL))
+        g_string_append_printf (record, "   time uncertainty: %lf ms\n", (gdouble)auxf);
+    else
+        g_string_append (record, "   time uncertainty: n/a\n");
 
-        if (qmi_indication_loc_position_report_output_get_time_uncertainty (output, &auxf, NULL))
-            g_print ("   time uncertainty: %lf ms\n", (gdouble)auxf);
-        else
-            g_print ("   time uncertainty: n/a\n");
+    if (qmi_indication_loc_position_report_output_get_time_source (output, &time_source, NULL))
+        g_string_append_printf (record, "   time source: %s\n", qmi_loc_time_source_get_string (time_source));
+    else
+        g_string_append (record, "   time source: n/a\n");
 
-        if (qmi_indication_loc_position_report_output_get_time_source (output, &time_source, NULL))
-            g_print ("   time source: %s\n", qmi_loc_time_source_get_string (time_source));
-        else
-            g_print ("   time source: n/a\n");
+    if (qmi_indication_loc_position_report_output_get_sensor_data_usage (output, &sensor_data_usage, NULL)) {
+        g_autofree gchar *sensor_data_usage_str = NULL;
 
-        if (qmi_indication_loc_position_report_output_get_sensor_data_usage (output, &sensor_data_usage, NULL)) {
-            g_autofree gchar *sensor_data_usage_str = NULL;
+        sensor_data_usage_str = qmi_loc_sensor_data_usage_build_string_from_mask (sensor_data_usage);
+        g_string_append_printf (record, "   sensor data usage: %s\n", sensor_data_usage_str);
+    } else
+        g_string_append (record, "   sensor data usage: n/a\n");
 
-            sensor_data_usage_str = qmi_loc_sensor_data_usage_build_string_from_mask (sensor_data_usage);
-            g_print ("   sensor data usage: %s\n", sensor_data_usage_str);
-        } else
-            g_print ("   sensor data usage: n/a\n");
+    if (qmi_indication_loc_position_report_output_get_session_fix_count (output, &aux32, NULL))
+        g_string_append_printf (record, "   Fix count: %u\n", aux32);
+    else
+        g_string_append (record, "   Fix count: n/a\n");
+
+    if (qmi_indication_loc_position_report_output_get_satellites_used (output, &array, NULL)) {
+        guint i;
+
+        g_string_append (record, "   Satellites used: ");
+        for (i = 0; i < array->len; i++) {
+            guint16 sv_id;
+
+            /*
+             * - For GPS:     1 to 32
+             * - For SBAS:    33 to 64
+             * - For GLONASS: 65 to 96
+             * - For QZSS:    193 to 197
+             * - For BDS:     201 to 237
+             */
+            sv_id = g_array_index (array, guint16, i);
+            g_string_append_printf (record, "%u%s", sv_id, i == array->len - 1 ? "" : ",");
+        }
+        g_string_append (record, "\n");
+    } else
+        g_string_append (record, "   Satellites used: n/a\n");
 
-        if (qmi_indication_loc_position_report_output_get_session_fix_count (output, &aux32, NULL))
-            g_print ("   Fix count: %u\n", aux32);
-        else
-            g_print ("   Fix count: n/a\n");
-
-        if (qmi_indication_loc_position_report_output_get_satellites_used (output, &array, NULL)) {
-            guint i;
-
-            g_print ("   Satellites used: ");
-            for (i = 0; i < array->len; i++) {
-                guint16 sv_id;
-
-                /*
-                 * - For GPS:     1 to 32
-                 * - For SBAS:    33 to 64
-                 * - For GLONASS: 65 to 96
-                 * - For QZSS:    193 to 197
-                 * - For BDS:     201 to 237
-                 */
-                sv_id = g_array_index (array, guint16, i);
-                g_print ("%u%s", sv_id, i == array->len - 1 ? "" : ",");
-            }
-            g_print ("\n");
-        } else
-            g_print ("   Satellites used: n/a\n");
+    if (qmi_indication_loc_position_report_output_get_altitude_assumed (output, &auxb, NULL))
+        g_string_append_printf (record, "   Altitude assumed: %s\n", auxb ? "yes" : "no");
+    else
+        g_string_append (record, "   Altitude assumed: n/a\n");
+}
 
-        if (qmi_indication_loc_position_report_output_get_altitude_assumed (output, &auxb, NULL))
-            g_print ("   Altitude assumed: %s\n", auxb ? "yes" : "no");
-        else
-            g_print ("   Altitude assumed: n/a\n");
+static void
+position_report_build_json (QmiIndicationLocPositionReportOutput *output,
+                            GString                              *record)
+{
+    gdouble auxd;
+    gfloat auxf;
+    guint8 aux8;
+    guint32 aux32;
+    guint64 aux64;
+    QmiLocReliability reliability;
+    QmiLocTechnologyUsed technology;
+    QmiLocTimeSource time_source;
+    QmiLocSensorDataUsage sensor_data_usage;
+    QmiIndicationLocPositionReportOutputDilutionOfPrecision dop;
+    QmiIndicationLocPositionReportOutputGpsTime gps_time;
+    gboolean auxb;
+    GArray *array;
+
+    if (qmi_indication_loc_position_report_output_get_latitude (output, &auxd, NULL))
+        json_append_number (record, "latitude", auxd, "%.12g");
+    if (qmi_indication_loc_position_report_output_get_longitude (output, &auxd, NULL))
+        json_append_number (record, "longitude", auxd, "%.12g");
+    if (qmi_indication_loc_position_report_output_get_horizontal_uncertainty_circular (output, &auxf, NULL))
+        json_append_number (record, "horizontal-uncertainty-circular", auxf, "%.7g");
+    if (qmi_indication_loc_position_report_output_get_horizontal_uncertainty_elliptical_minor (output, &auxf, NULL))
+        json_append_number (record, "horizontal-uncertainty-elliptical-minor", auxf, "%.7g");
+    if (qmi_indication_loc_position_report_output_get_horizontal_uncertainty_elliptical_major (output, &auxf, NULL))
+        json_append_number (record, "horizontal-uncertainty-elliptical-major", auxf, "%.7g");
+    if (qmi_indication_loc_position_report_output_get_horizontal_uncertainty_elliptical_azimuth (output, &auxf, NULL))
+        json_append_number (record, "horizontal-uncertainty-elliptical-azimuth", auxf, "%.7g");
+    if (qmi_indication_loc_position_report_output_get_horizontal_confidence (output, &aux8, NULL))
+        g_string_append_printf (record, ",\"horizontal-confidence\":%u", aux8);
+    if (qmi_indication_loc_position_report_output_get_horizontal_reliability (output, &reliability, NULL))
+        json_append_string (record, "horizontal-reliability", qmi_loc_reliability_get_string (reliability));
+    if (qmi_indication_loc_position_report_output_get_horizontal_speed (output, &auxf, NULL))
+        json_append_number (record, "horizontal-speed", auxf, "%.7g");
+    if (qmi_indication_loc_position_report_output_get_speed_uncertainty (output, &auxf, NULL))
+        json_append_number (record, "speed-uncertainty", auxf, "%.7g");
+    if (qmi_indication_loc_position_report_output_get_altitude_from_ellipsoid (output, &auxf, NULL))
+        json_append_number (record, "altitude-from-ellipsoid", auxf, "%.7g");
+    if (qmi_indication_loc_position_report_output_get_altitude_from_sealevel (output, &auxf, NULL))
+        json_append_number (record, "altitude-from-sealevel", auxf, "%.7g");
+    if (qmi_indication_loc_position_report_output_get_vertical_uncertainty (output, &auxf, NULL))
+        json_append_number (record, "vertical-uncertainty", auxf, "%.7g");
+    if (qmi_indication_loc_position_report_output_get_vertical_confidence (output, &aux8, NULL))
+        g_string_append_printf (record, ",\"vertical-confidence\":%u", aux8);
+    if (qmi_indication_loc_position_report_output_get_vertical_reliability (output, &reliability, NULL))
+        json_append_string (record, "vertical-reliability", qmi_loc_reliability_get_string (reliability));
+    if (qmi_indication_loc_position_report_output_get_vertical_speed (output, &auxf, NULL))
+        json_append_number (record, "vertical-speed", auxf, "%.7g");
+    if (qmi_indication_loc_position_report_output_get_heading (output, &auxf, NULL))
+        json_append_number (record, "heading", auxf, "%.7g");
+    if (qmi_indication_loc_position_report_output_get_heading_uncertainty (output, &auxf, NULL))
+        json_append_number (record, "heading-uncertainty", auxf, "%.7g");
+    if (qmi_indication_loc_position_report_output_get_magnetic_deviation (output, &auxf, NULL))
+        json_append_number (record, "magnetic-deviation", auxf, "%.7g");
+    if (qmi_indication_loc_position_report_output_get_technology_used (output, &technology, NULL)) {
+        g_autofree gchar *technology_str = NULL;
+
+        technology_str = qmi_loc_technology_used_build_string_from_mask (technology);
+        json_append_string (record, "technology", technology_str);
+    }
+    if (qmi_indication_loc_position_report_output_get_dilution_of_precision (output, &dop, NULL)) {
+        json_append_number (record, "position-dop", dop.position_dilution_of_precision, "%.7g");
+        json_append_number (record, "horizontal-dop", dop.horizontal_dilution_of_precision, "%.7g");
+        json_append_number (record, "vertical-dop", dop.vertical_dilution_of_precision, "%.7g");
+    }
+    if (qmi_indication_loc_position_report_output_get_utc_timestamp (output, &aux64, NULL))
+        g_string_append_printf (record, ",\"utc-timestamp\":%" G_GUINT64_FORMAT, aux64);
+    if (qmi_indication_loc_position_report_output_get_leap_seconds (output, &aux8, NULL))
+        g_string_append_printf (record, ",\"leap-seconds\":%u", aux8);
+    if (qmi_indication_loc_position_report_output_get_gps_time (output, &gps_time, NULL))
+        g_string_append_printf (record, ",\"gps-weeks\":%u,\"gps-time-of-week\":%u",
+                                gps_time.gps_weeks, gps_time.gps_time_of_week_milliseconds);
+    if (qmi_indication_loc_position_report_output_get_time_uncertainty (output, &auxf, NULL))
+        json_append_number (record, "time-uncertainty", auxf, "%.7g");
+    if (qmi_indication_loc_position_report_output_get_time_source (output, &time_source, NULL))
+        json_append_string (record, "time-source", qmi_loc_time_source_get_string (time_source));
+    if (qmi_indication_loc_position_report_output_get_sensor_data_usage (output, &sensor_data_usage, NULL)) {
+        g_autofree gchar *sensor_data_usage_str = NULL;
+
+        sensor_data_usage_str = qmi_loc_sensor_data_usage_build_string_from_mask (sensor_data_usage);
+        json_append_string (record, "sensor-data-usage", sensor_data_usage_str);
+    }
+    if (qmi_indication_loc_position_report_output_get_session_fix_count (output, &aux32, NULL))
+        g_string_append_printf (record, ",\"fix-count\":%u", aux32);
+    if (qmi_indication_loc_position_report_output_get_satellites_used (output, &array, NULL)) {
+        guint i;
+
+        g_string_append (record, ",\"satellites-used\":[");
+        for (i = 0; i < array->len; i++)
+            g_string_append_printf (record, "%s%u", i ? "," : "", g_array_index (array, guint16, i));
+        g_string_append_c (record, ']');
+    }
+    if (qmi_indication_loc_position_report_output_get_altitude_assumed (output, &auxb, NULL))
+        g_string_append_printf (record, ",\"altitude-assumed\":%s", auxb ? "true" : "false");
+}
+
+static void
+position_report_received (QmiClientLoc                         *client,
+                          QmiIndicationLocPositionReportOutput *output)
+{
+    QmiLocSessionStatus  status;
+    gboolean             success;
+    GString             *record;
+
+    qmi_indication_loc_position_report_output_get_session_status (output, &status, NULL);
+    success = (status == QMI_LOC_SESSION_STATUS_SUCCESS || status == QMI_LOC_SESSION_STATUS_IN_PROGRESS);
+
+    if (loc_output_json ()) {
+        record = json_record_new ("position-report");
+        json_append_string (record, "status", qmi_loc_session_status_get_string (status));
+        if (success)
+            position_report_build_json (output, record);
+        json_record_complete (record);
+    } else {
+        record = g_string_new (NULL);
+        g_string_append_printf (record, "[position report] status: %s\n", qmi_loc_session_status_get_string (status));
+        if (success)
+            position_report_build_text (output, record);
+    }
+    loc_output ("position-report", record);
 
+    if (success) {
         /* Terminate GET request */
         if (get_position_report_flag)
             operation_shutdown (TRUE);
@@ -1569,6 +2195,8 @@ qmicli_loc_run (QmiDevice    *device,
     defined HAVE_QMI_MESSAGE_LOC_REGISTER_EVENTS
     if (get_position_report_flag || get_gnss_sv_info_flag || follow_position_report_flag || follow_gnss_sv_info_flag || follow_nmea_flag) {
         /* All the remaining actions require monitoring */
+        if (follow_position_report_flag || follow_gnss_sv_info_flag || follow_nmea_flag)
+            ctx->follow_output = follow_output_new ();
         ctx->monitoring_step = MONITORING_STEP_FIRST;
         monitoring_step_run ();
         return;
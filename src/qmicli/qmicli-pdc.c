@@ -37,7 +37,11 @@
 #if defined HAVE_QMI_SERVICE_PDC
 
 #define LIST_CONFIGS_TIMEOUT_SECS 2
-#define LOAD_CONFIG_CHUNK_SIZE 0x400
+
+/* Chunks are as large as the guint16 size prefix allows, halved each time the
+ * modem rejects the first one, down to the size that has always worked */
+#define LOAD_CONFIG_MAX_CHUNK_SIZE 0x8000
+#define LOAD_CONFIG_MIN_CHUNK_SIZE 0x400
 
 /* Info about config */
 typedef struct {
@@ -54,6 +58,13 @@ typedef struct {
     GMappedFile *mapped_file;
     GArray *checksum;
     gsize offset;
+    /* Size of the chunks sent, and the next one sent */
+    gsize chunk_size;
+    gsize next_chunk_size;
+    /* Chunks accepted so far */
+    guint chunks_accepted;
+    /* Reused for every chunk */
+    GArray *chunk;
 } LoadConfigFileData;
 
 /* Context */
@@ -84,6 +95,9 @@ typedef struct {
     guint deactivate_config_indication_id;
 
     guint token;
+
+    /* Provisioning: list, load if needed, then activate */
+    gboolean provisioning;
 } Context;
 static Context *ctx;
 
@@ -93,6 +107,8 @@ static gchar *delete_config_str;
 static gchar *activate_config_str;
 static gchar *deactivate_config_str;
 static gchar *load_config_str;
+static gint load_config_chunk_size_int;
+static gchar *provision_config_str;
 static gboolean noop_flag;
 
 #if defined HAVE_QMI_MESSAGE_PDC_LIST_CONFIGS && \
@@ -121,6 +137,12 @@ static gboolean noop_flag;
 # define HAVE_QMI_ACTION_PDC_LOAD_CONFIG
 #endif
 
+#if defined HAVE_QMI_ACTION_PDC_LIST_CONFIGS && \
+    defined HAVE_QMI_ACTION_PDC_LOAD_CONFIG && \
+    defined HAVE_QMI_ACTION_PDC_ACTIVATE_CONFIG
+# define HAVE_QMI_ACTION_PDC_PROVISION_CONFIG
+#endif
+
 static GOptionEntry entries[] = {
 #if defined HAVE_QMI_ACTION_PDC_LIST_CONFIGS
     {
@@ -156,6 +178,18 @@ static GOptionEntry entries[] = {
         "Load config to device",
         "[Path to config]"
     },
+    {
+        "pdc-load-config-chunk-size", 0, 0, G_OPTION_ARG_INT, &load_config_chunk_size_int,
+        "Size of the chunks sent when loading a config (default: largest accepted by the device)",
+        "[Size]"
+    },
+#endif
+#if defined HAVE_QMI_ACTION_PDC_PROVISION_CONFIG
+    {
+        "pdc-provision-config", 0, 0, G_OPTION_ARG_STRING, &provision_config_str,
+        "Load config to device unless already loaded, then activate it",
+        "[Path to config]"
+    },
 #endif
     {
         "pdc-noop", 0, 0, G_OPTION_ARG_NONE, &noop_flag,
@@ -178,12 +212,20 @@ qmicli_pdc_get_option_group (void)
     return group;
 }
 
+static guint n_actions;
+static gboolean checked;
+
+void
+qmicli_pdc_options_reset (void)
+{
+    qmicli_reset_option_entries (entries);
+    n_actions = 0;
+    checked = FALSE;
+}
+
 gboolean
 qmicli_pdc_options_enabled (void)
 {
-    static guint n_actions = 0;
-    static gboolean checked = FALSE;
-
     if (checked)
         return !!n_actions;
 
@@ -192,6 +234,7 @@ qmicli_pdc_options_enabled (void)
                  !!activate_config_str +
                  !!deactivate_config_str +
                  !!load_config_str +
+                 !!provision_config_str +
                  noop_flag);
 
     if (n_actions > 1) {
@@ -201,7 +244,7 @@ qmicli_pdc_options_enabled (void)
 
     /* Actions that require receiving QMI indication messages must specify that
      * indications are expected. */
-    if (list_configs_str || activate_config_str || deactivate_config_str || load_config_str)
+    if (list_configs_str || activate_config_str || deactivate_config_str || load_config_str || provision_config_str)
         qmicli_expect_indications ();
 
     checked = TRUE;
@@ -240,18 +283,25 @@ context_free (Context *context)
                 g_array_unref (current_config->id);
         }
         g_array_unref (context->config_list);
+    }
+
+    if (context->list_configs_indication_id)
         g_signal_handler_disconnect (context->client, context->list_configs_indication_id);
+    if (context->get_config_info_indication_id)
         g_signal_handler_disconnect (context->client, context->get_config_info_indication_id);
+    if (context->get_selected_config_indication_id)
         g_signal_handler_disconnect (context->client, context->get_selected_config_indication_id);
-    }
 
     if (context->load_config_file_data) {
         g_array_unref (context->load_config_file_data->checksum);
+        g_array_unref (context->load_config_file_data->chunk);
         g_mapped_file_unref (context->load_config_file_data->mapped_file);
         g_slice_free (LoadConfigFileData, context->load_config_file_data);
-        g_signal_handler_disconnect (context->client, context->load_config_indication_id);
     }
 
+    if (context->load_config_indication_id)
+        g_signal_handler_disconnect (context->client, context->load_config_indication_id);
+
     if (context->set_selected_config_indication_id)
         g_signal_handler_disconnect (context->client, context->set_selected_config_indication_id);
 
@@ -372,11 +422,21 @@ print_configs (GArray *configs)
     }
 }
 
+#if defined HAVE_QMI_ACTION_PDC_PROVISION_CONFIG
+static void provision_configs_listed (void);
+#endif
+
 static void
 check_list_config_completed (void)
 {
     if (ctx->configs_loaded == ctx->config_list->len &&
         ctx->ids_loaded) {
+#if defined HAVE_QMI_ACTION_PDC_PROVISION_CONFIG
+        if (ctx->provisioning) {
+            provision_configs_listed ();
+            return;
+        }
+#endif
         print_configs (ctx->config_list);
         operation_shutdown (TRUE);
     }
@@ -470,8 +530,16 @@ get_config_info_ready_indication (QmiClientPdc *client,
 static gboolean
 list_configs_timeout (void)
 {
+    ctx->timeout_id = 0;
+
     /* No indication yet, cancelling */
     if (!ctx->config_list) {
+#if defined HAVE_QMI_ACTION_PDC_PROVISION_CONFIG
+        if (ctx->provisioning) {
+            provision_configs_listed ();
+            return FALSE;
+        }
+#endif
         g_printf ("Total configurations: 0\n");
         operation_shutdown (TRUE);
     }
@@ -690,7 +758,7 @@ get_selected_config_input_create (const gchar *str)
 }
 
 static void
-run_list_configs (void)
+run_list_configs (const gchar *config_type_str)
 {
     QmiMessagePdcListConfigsInput *input;
     QmiMessagePdcGetSelectedConfigInput *get_selected_config_input;
@@ -710,13 +778,13 @@ run_list_configs (void)
         g_signal_connect (ctx->client, "get-config-info",
                           G_CALLBACK (get_config_info_ready_indication), NULL);
 
-    input = list_configs_input_create (list_configs_str);
+    input = list_configs_input_create (config_type_str);
     if (!input) {
         operation_shutdown (FALSE);
         return;
     }
 
-    get_selected_config_input = get_selected_config_input_create (list_configs_str);
+    get_selected_config_input = get_selected_config_input_create (config_type_str);
     if (!get_selected_config_input) {
         operation_shutdown (FALSE);
         return;
@@ -1194,12 +1262,20 @@ load_config_file_from_string (const gchar *str)
     checksum = g_checksum_new (G_CHECKSUM_SHA1);
     g_checksum_update (checksum, file_contents, file_size);
 
-    data = g_slice_new (LoadConfigFileData);
+    data = g_slice_new0 (LoadConfigFileData);
     data->mapped_file = mapped_file;
     data->checksum = g_array_sized_new (FALSE, FALSE, sizeof (guint8), hash_size);
     g_array_set_size (data->checksum, hash_size);
     data->offset = 0;
     g_checksum_get_digest (checksum, &g_array_index (data->checksum, guint8, 0), &hash_size);
+    g_checksum_free (checksum);
+
+    /* A given chunk size is used as is, otherwise start from the largest one */
+    if (load_config_chunk_size_int > 0)
+        data->next_chunk_size = MIN ((gsize) load_config_chunk_size_int, G_MAXUINT16);
+    else
+        data->next_chunk_size = LOAD_CONFIG_MAX_CHUNK_SIZE;
+    data->chunk = g_array_sized_new (FALSE, FALSE, sizeof (guint8), data->next_chunk_size);
 
     return data;
 }
@@ -1209,10 +1285,8 @@ load_config_input_create_chunk (LoadConfigFileData *config_file)
 {
     QmiMessagePdcLoadConfigInput *input;
     GError *error = NULL;
-    GArray *chunk;
     gsize full_size;
-    gsize chunk_size;
-    guint8 *file_content;
+    const guint8 *file_content;
 
     if (!config_file)
         return NULL;
@@ -1225,44 +1299,66 @@ load_config_input_create_chunk (LoadConfigFileData *config_file)
         return NULL;
     }
 
-    chunk = g_array_new (FALSE, FALSE, sizeof (guint8));
     full_size = g_mapped_file_get_length (config_file->mapped_file);
-    chunk_size = (((config_file->offset + LOAD_CONFIG_CHUNK_SIZE) > full_size) ?
-                  (full_size - config_file->offset) :
-                  LOAD_CONFIG_CHUNK_SIZE);
-
-    file_content = (guint8 *) g_mapped_file_get_contents (config_file->mapped_file);
-    g_array_append_vals (chunk, &file_content[config_file->offset], chunk_size);
+    config_file->chunk_size = (((config_file->offset + config_file->next_chunk_size) > full_size) ?
+                               (full_size - config_file->offset) :
+                               config_file->next_chunk_size);
+
+    /* The chunk array is only referenced by the input, and the input is
+     * serialized as soon as the request is sent, so it can be refilled for
+     * the next chunk right away */
+    file_content = (const guint8 *) g_mapped_file_get_contents (config_file->mapped_file);
+    g_array_set_size (config_file->chunk, config_file->chunk_size);
+    memcpy (config_file->chunk->data, &file_content[config_file->offset], config_file->chunk_size);
     g_print ("Uploaded %" G_GSIZE_FORMAT "  of %" G_GSIZE_FORMAT "\n", config_file->offset, full_size);
 
     if (!qmi_message_pdc_load_config_input_set_config_chunk (input,
                                                              QMI_PDC_CONFIGURATION_TYPE_SOFTWARE,
                                                              config_file->checksum,
                                                              full_size,
-                                                             chunk,
+                                                             config_file->chunk,
                                                              &error)) {
         g_printerr ("error: couldn't set chunk: '%s'\n", error->message);
         g_error_free (error);
-        g_array_unref (chunk);
         qmi_message_pdc_load_config_input_unref (input);
         return NULL;
     }
 
-    config_file->offset += chunk_size;
-
-    g_array_unref (chunk);
+    config_file->offset += config_file->chunk_size;
     return input;
 }
 
 static void load_config_ready (QmiClientPdc *client,
                                GAsyncResult *res);
 
+#if defined HAVE_QMI_ACTION_PDC_PROVISION_CONFIG
+static void provision_config_loaded (void);
+#endif
+
+static gboolean
+load_config_send_chunk (void)
+{
+    QmiMessagePdcLoadConfigInput *input;
+
+    input = load_config_input_create_chunk (ctx->load_config_file_data);
+    if (!input)
+        return FALSE;
+
+    qmi_client_pdc_load_config (ctx->client,
+                                input,
+                                10,
+                                ctx->cancellable,
+                                (GAsyncReadyCallback) load_config_ready,
+                                NULL);
+    qmi_message_pdc_load_config_input_unref (input);
+    return TRUE;
+}
+
 static void
 load_config_ready_indication (QmiClientPdc *client,
                               QmiIndicationPdcLoadConfigOutput *output)
 {
     GError *error = NULL;
-    QmiMessagePdcLoadConfigInput *input;
     gboolean frame_reset;
     guint32 remaining_size;
     guint16 error_code = 0;
@@ -1296,24 +1392,18 @@ load_config_ready_indication (QmiClientPdc *client,
 
     if (remaining_size == 0) {
         g_print ("Finished loading\n");
+#if defined HAVE_QMI_ACTION_PDC_PROVISION_CONFIG
+        if (ctx->provisioning) {
+            provision_config_loaded ();
+            return;
+        }
+#endif
         operation_shutdown (TRUE);
         return;
     }
 
-    g_print ("Loading next chunk (%u bytes remaining)\n", remaining_size);
-    input = load_config_input_create_chunk (ctx->load_config_file_data);
-    if (!input) {
-        g_printerr ("error: couldn't create next chunk\n");
-        operation_shutdown (FALSE);
-        return;
-    }
-
-    qmi_client_pdc_load_config (ctx->client,
-                                input,
-                                10,
-                                ctx->cancellable,
-                                (GAsyncReadyCallback) load_config_ready, NULL);
-    qmi_message_pdc_load_config_input_unref (input);
+    /* Next chunk already sent once the previous one was accepted */
+    g_debug ("Loading (%u bytes remaining)", remaining_size);
 }
 
 static void
@@ -1322,8 +1412,18 @@ load_config_ready (QmiClientPdc *client,
 {
     GError *error = NULL;
     QmiMessagePdcLoadConfigOutput *output;
+    LoadConfigFileData *config_file;
 
     output = qmi_client_pdc_load_config_finish (client, res, &error);
+
+    /* Operation may have already finished on an indication */
+    if (!ctx) {
+        if (output)
+            qmi_message_pdc_load_config_output_unref (output);
+        g_clear_error (&error);
+        return;
+    }
+
     if (!output) {
         g_printerr ("error: operation failed: %s\n", error->message);
         g_error_free (error);
@@ -1331,7 +1431,26 @@ load_config_ready (QmiClientPdc *client,
         return;
     }
 
+    config_file = ctx->load_config_file_data;
+
     if (!qmi_message_pdc_load_config_output_get_result (output, &error)) {
+        /* First chunk too large? Try again from the start with a smaller one */
+        if (!config_file->chunks_accepted &&
+            !load_config_chunk_size_int &&
+            config_file->next_chunk_size > LOAD_CONFIG_MIN_CHUNK_SIZE) {
+            config_file->next_chunk_size /= 2;
+            config_file->offset = 0;
+            g_debug ("Chunk rejected (%s), retrying with %" G_GSIZE_FORMAT " bytes",
+                     error->message, config_file->next_chunk_size);
+            g_error_free (error);
+            qmi_message_pdc_load_config_output_unref (output);
+            if (!load_config_send_chunk ()) {
+                g_printerr ("error: couldn't create next chunk\n");
+                operation_shutdown (FALSE);
+            }
+            return;
+        }
+
         g_printerr ("error: couldn't load config: %s\n", error->message);
         g_error_free (error);
         qmi_message_pdc_load_config_output_unref (output);
@@ -1340,34 +1459,37 @@ load_config_ready (QmiClientPdc *client,
     }
 
     qmi_message_pdc_load_config_output_unref (output);
+
+    if (!config_file->chunks_accepted++)
+        g_debug ("Loading config in chunks of %" G_GSIZE_FORMAT " bytes", config_file->chunk_size);
+
+    /* Chunk accepted, send the next one without waiting for the indication;
+     * the indication after the last chunk finishes the operation */
+    if (config_file->offset < g_mapped_file_get_length (config_file->mapped_file) &&
+        !load_config_send_chunk ()) {
+        g_printerr ("error: couldn't create next chunk\n");
+        operation_shutdown (FALSE);
+    }
 }
 
-static QmiMessagePdcLoadConfigInput *
+static gboolean
 load_config_input_create (const gchar *str)
 {
     LoadConfigFileData *config_file;
-    QmiMessagePdcLoadConfigInput *input = NULL;
 
     config_file = load_config_file_from_string (str);
     if (!config_file)
-        return NULL;
-
-    input = load_config_input_create_chunk (config_file);
-    if (!input)
-        return NULL;
+        return FALSE;
 
     ctx->load_config_file_data = config_file;
-    return input;
+    return TRUE;
 }
 
 static void
 run_load_config (void)
 {
-    QmiMessagePdcLoadConfigInput *input;
-
     g_debug ("Loading config asynchronously...");
-    input = load_config_input_create (load_config_str);
-    if (!input) {
+    if (!load_config_input_create (load_config_str)) {
         operation_shutdown (FALSE);
         return;
     }
@@ -1379,17 +1501,111 @@ run_load_config (void)
                           G_CALLBACK (load_config_ready_indication),
                           NULL);
 
-    qmi_client_pdc_load_config (ctx->client,
-                                input,
-                                10,
-                                ctx->cancellable,
-                                (GAsyncReadyCallback) load_config_ready,
-                                NULL);
-    qmi_message_pdc_load_config_input_unref (input);
+    if (!load_config_send_chunk ())
+        operation_shutdown (FALSE);
 }
 
 #endif /* HAVE_QMI_ACTION_PDC_LOAD_CONFIG */
 
+/******************************************************************************/
+/* Provision config
+ *
+ * List the software configs (their info requested all at once), load the given
+ * config unless one with the same ID is already there, and activate it unless
+ * already active. Loaded configs are identified by the SHA1 of their contents,
+ * so matching IDs mean the same config. Several devices are provisioned at
+ * once by giving --device more than once.
+ */
+
+#if defined HAVE_QMI_ACTION_PDC_PROVISION_CONFIG
+
+static gboolean
+config_id_equal (GArray *a,
+                 GArray *b)
+{
+    return (a && b && a->len == b->len && memcmp (a->data, b->data, a->len) == 0);
+}
+
+static void
+provision_config_activate (void)
+{
+    GArray  *id;
+    GString *str;
+    guint    i;
+
+    /* Activate via the regular action, which takes [type,id] */
+    id = ctx->load_config_file_data->checksum;
+    str = g_string_new ("software,");
+    for (i = 0; i < id->len; i++)
+        g_string_append_printf (str, "%02X", g_array_index (id, guint8, i));
+
+    g_free (activate_config_str);
+    activate_config_str = g_string_free (str, FALSE);
+
+    run_activate_config ();
+}
+
+static void
+provision_config_loaded (void)
+{
+    provision_config_activate ();
+}
+
+static void
+provision_configs_listed (void)
+{
+    LoadConfigFileData *config_file;
+    guint               i;
+
+    config_file = ctx->load_config_file_data;
+
+    if (config_id_equal (ctx->active_config_id, config_file->checksum)) {
+        g_print ("Config already active\n");
+        operation_shutdown (TRUE);
+        return;
+    }
+
+    for (i = 0; ctx->config_list && i < ctx->config_list->len; i++) {
+        ConfigInfo *current_config;
+
+        current_config = &g_array_index (ctx->config_list, ConfigInfo, i);
+        if (config_id_equal (current_config->id, config_file->checksum) &&
+            current_config->total_size == g_mapped_file_get_length (config_file->mapped_file)) {
+            g_print ("Config already loaded (%s), skipping load\n",
+                     current_config->description ? current_config->description : "no description");
+            provision_config_activate ();
+            return;
+        }
+    }
+
+    g_print ("Loading config...\n");
+    ctx->load_config_indication_id =
+        g_signal_connect (ctx->client,
+                          "load-config",
+                          G_CALLBACK (load_config_ready_indication),
+                          NULL);
+
+    if (!load_config_send_chunk ())
+        operation_shutdown (FALSE);
+}
+
+static void
+run_provision_config (void)
+{
+    g_debug ("Provisioning config asynchronously...");
+
+    ctx->load_config_file_data = load_config_file_from_string (provision_config_str);
+    if (!ctx->load_config_file_data) {
+        operation_shutdown (FALSE);
+        return;
+    }
+
+    ctx->provisioning = TRUE;
+    run_list_configs ("software");
+}
+
+#endif /* HAVE_QMI_ACTION_PDC_PROVISION_CONFIG */
+
 /******************************************************************************/
 /* Common */
 
@@ -1410,7 +1626,7 @@ qmicli_pdc_run (QmiDevice *device,
 
 #if defined HAVE_QMI_ACTION_PDC_LIST_CONFIGS
     if (list_configs_str) {
-        run_list_configs ();
+        run_list_configs (list_configs_str);
         return;
     }
 #endif
@@ -1443,6 +1659,13 @@ qmicli_pdc_run (QmiDevice *device,
     }
 #endif
 
+#if defined HAVE_QMI_ACTION_PDC_PROVISION_CONFIG
+    if (provision_config_str) {
+        run_provision_config ();
+        return;
+    }
+#endif
+
     /* Just client allocate/release? */
     if (noop_flag) {
         g_idle_add (noop_cb, NULL);
@@ -100,12 +100,22 @@ qmicli_qos_get_option_group (void)
     return group;
 }
 
+static guint n_actions;
+static gboolean checked;
+
+void
+qmicli_qos_options_reset (void)
+{
+    qmicli_reset_option_entries (entries);
+    get_flow_status_int = -1;
+    swi_read_data_stats_int = -1;
+    n_actions = 0;
+    checked = FALSE;
+}
+
 gboolean
 qmicli_qos_options_enabled (void)
 {
-    static guint n_actions = 0;
-    static gboolean checked = FALSE;
-
     if (checked)
         return !!n_actions;
 
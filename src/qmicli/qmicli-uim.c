@@ -50,6 +50,7 @@ static Context *ctx;
 /* Options */
 static gchar *read_transparent_str;
 static gchar *read_record_str;
+static gchar *read_files_str;
 static gchar *set_pin_protection_str;
 static gchar *verify_pin_str;
 static gchar *unblock_pin_str;
@@ -114,6 +115,12 @@ static GOptionEntry entries[] = {
       "[\"key=value,...\"]"
     },
 #endif
+#if defined HAVE_QMI_MESSAGE_UIM_READ_TRANSPARENT && defined HAVE_QMI_MESSAGE_UIM_READ_RECORD
+    { "uim-read-files", 0, 0, G_OPTION_ARG_STRING, &read_files_str,
+      "Read several files at once, coalescing reads of the same file (allowed keys: file ([0xNNNN-0xNNNN-...]), records (N[-N]), record-length, offset, length)",
+      "[\"key=value,...;key=value,...\"]"
+    },
+#endif
 #if defined HAVE_QMI_MESSAGE_UIM_GET_CARD_STATUS
     { "uim-get-card-status", 0, 0, G_OPTION_ARG_NONE, &get_card_status_flag,
       "Get card status",
@@ -202,12 +209,20 @@ qmicli_uim_get_option_group (void)
     return group;
 }
 
+static guint n_actions;
+static gboolean checked;
+
+void
+qmicli_uim_options_reset (void)
+{
+    qmicli_reset_option_entries (entries);
+    n_actions = 0;
+    checked = FALSE;
+}
+
 gboolean
 qmicli_uim_options_enabled (void)
 {
-    static guint n_actions = 0;
-    static gboolean checked = FALSE;
-
     if (checked)
         return !!n_actions;
 
@@ -217,6 +232,7 @@ qmicli_uim_options_enabled (void)
                  !!change_pin_str +
                  !!read_transparent_str +
                  !!read_record_str +
+                 !!read_files_str +
                  !!get_file_attributes_str +
                  !!sim_power_on_str +
                  !!sim_power_off_str +
@@ -1919,6 +1935,782 @@ out:
 
 #endif /* HAVE_QMI_MESSAGE_UIM_READ_RECORD */
 
+#if defined HAVE_QMI_MESSAGE_UIM_READ_TRANSPARENT && \
+    defined HAVE_QMI_MESSAGE_UIM_READ_RECORD
+
+/* Reads kept in flight at once; the modem queues them towards the card, so
+ * a few are enough to hide the per-request round-trip */
+#define READ_FILES_MAX_IN_FLIGHT 4
+
+/* Files that can't change during a card session, always read whole and
+ * cached (normalized paths, see read_files_entry_new()) */
+static const gchar *read_files_immutable[] = {
+    "3F00-2FE2",      /* EF ICCID */
+    "3F00-7F20-6F07", /* EF IMSI (SIM) */
+    "3F00-7FFF-6F07", /* EF IMSI (USIM) */
+    NULL
+};
+
+/* Contents of immutable files, keyed by device and file path; survives
+ * across batch lines until the card session changes */
+static GHashTable *read_files_cache;
+
+typedef struct {
+    /* Request */
+    gchar    *file;
+    guint16   file_id;
+    GArray   *file_path;
+    gboolean  record;
+    guint16   first;
+    guint16   last;
+    guint16   record_length;
+    guint16   offset;
+    guint16   length; /* 0 reads up to the end of the file */
+
+    /* Result */
+    gchar    *error;
+    gboolean  cached;
+    gboolean  card_result;
+    guint8    sw1;
+    guint8    sw2;
+    GArray   *data;
+    guint     record_size;
+} ReadFilesEntry;
+
+typedef struct {
+    ReadFilesEntry *head; /* provides file and path */
+    gboolean        record;
+    guint16         first;
+    guint16         last;
+    guint16         record_length;
+    guint16         offset;
+    guint32         end;   /* G_MAXUINT32 reads up to the end of the file */
+    gboolean        cache;
+    GPtrArray      *entries;
+} ReadFilesRequest;
+
+typedef struct {
+    GPtrArray *entries;
+    GPtrArray *requests;
+    guint      next;
+    guint      in_flight;
+    guint      pending;
+} ReadFilesContext;
+
+static ReadFilesContext *read_files_ctx;
+
+static void
+read_files_cache_clear (void)
+{
+    if (read_files_cache)
+        g_hash_table_remove_all (read_files_cache);
+}
+
+static gchar *
+read_files_cache_key (const ReadFilesEntry *entry)
+{
+    return g_strdup_printf ("%s|%s",
+                            qmi_device_get_path (ctx->device),
+                            entry->file);
+}
+
+static gboolean
+read_files_is_immutable (const ReadFilesEntry *entry)
+{
+    guint i;
+
+    if (entry->record)
+        return FALSE;
+
+    for (i = 0; read_files_immutable[i]; i++) {
+        if (g_str_equal (entry->file, read_files_immutable[i]))
+            return TRUE;
+    }
+    return FALSE;
+}
+
+static void
+read_files_entry_free (ReadFilesEntry *entry)
+{
+    g_free (entry->file);
+    g_free (entry->error);
+    if (entry->file_path)
+        g_array_unref (entry->file_path);
+    if (entry->data)
+        g_array_unref (entry->data);
+    g_slice_free (ReadFilesEntry, entry);
+}
+
+static void
+read_files_request_free (ReadFilesRequest *request)
+{
+    g_ptr_array_unref (request->entries);
+    g_slice_free (ReadFilesRequest, request);
+}
+
+static void
+read_files_context_free (ReadFilesContext *context)
+{
+    if (!context)
+        return;
+
+    g_ptr_array_unref (context->requests);
+    g_ptr_array_unref (context->entries);
+    g_slice_free (ReadFilesContext, context);
+}
+
+static gboolean
+read_files_range_from_string (const gchar *str,
+                              guint16     *first,
+                              guint16     *last)
+{
+    gchar **split;
+    guint aux1 = 0;
+    guint aux2 = 0;
+    gboolean success = FALSE;
+
+    split = g_strsplit (str, "-", 2);
+    if (qmicli_read_uint_from_string (split[0], &aux1) && aux1 <= G_MAXUINT16) {
+        if (!split[1])
+            aux2 = aux1;
+        success = (!split[1] || (qmicli_read_uint_from_string (split[1], &aux2) &&
+                                 aux2 <= G_MAXUINT16 && aux2 >= aux1));
+    }
+    g_strfreev (split);
+
+    if (success) {
+        *first = (guint16) aux1;
+        *last = (guint16) aux2;
+    }
+    return success;
+}
+
+static gboolean
+read_files_entry_handle (const gchar *key,
+                         const gchar *value,
+                         GError     **error,
+                         gpointer     user_data)
+{
+    ReadFilesEntry *entry = (ReadFilesEntry *) user_data;
+    guint aux;
+
+    if (!value || !value[0]) {
+        g_set_error (error,
+                     QMI_CORE_ERROR,
+                     QMI_CORE_ERROR_FAILED,
+                     "key '%s' requires a value",
+                     key);
+        return FALSE;
+    }
+
+    if (g_ascii_strcasecmp (key, "file") == 0) {
+        g_free (entry->file);
+        entry->file = g_strdup (value);
+        return TRUE;
+    }
+
+    if (g_ascii_strcasecmp (key, "records") == 0) {
+        if (!read_files_range_from_string (value, &entry->first, &entry->last) ||
+            entry->first == 0) {
+            g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_FAILED,
+                         "failed reading key 'records' as a 16bit record range");
+            return FALSE;
+        }
+        entry->record = TRUE;
+        return TRUE;
+    }
+
+    if (g_ascii_strcasecmp (key, "record-length") == 0 ||
+        g_ascii_strcasecmp (key, "offset") == 0 ||
+        g_ascii_strcasecmp (key, "length") == 0) {
+        if (!qmicli_read_uint_from_string (value, &aux) || (aux > G_MAXUINT16)) {
+            g_set_error (error, QMI_CORE_ERROR, QMI_CORE_ERROR_FAILED,
+                         "failed reading key '%s' as 16bit value", key);
+            return FALSE;
+        }
+        if (g_ascii_strcasecmp (key, "record-length") == 0)
+            entry->record_length = (guint16) aux;
+        else if (g_ascii_strcasecmp (key, "offset") == 0)
+            entry->offset = (guint16) aux;
+        else
+            entry->length = (guint16) aux;
+        return TRUE;
+    }
+
+    g_set_error (error,
+                 QMI_CORE_ERROR,
+                 QMI_CORE_ERROR_FAILED,
+                 "Unrecognized option '%s'",
+                 key);
+    return FALSE;
+}
+
+static ReadFilesEntry *
+read_files_entry_new (const gchar *str)
+{
+    GError *error = NULL;
+    ReadFilesEntry *entry;
+    GString *file;
+    guint i;
+
+    entry = g_slice_new0 (ReadFilesEntry);
+    if (!qmicli_parse_key_value_string (str,
+                                        &error,
+                                        read_files_entry_handle,
+                                        entry)) {
+        g_printerr ("error: could not parse input string '%s': %s\n",
+                    str,
+                    error->message);
+        g_error_free (error);
+        read_files_entry_free (entry);
+        return NULL;
+    }
+
+    if (!entry->file) {
+        g_printerr ("error: missing 'file' key in '%s'\n", str);
+        read_files_entry_free (entry);
+        return NULL;
+    }
+
+    if (entry->record && (entry->offset || entry->length)) {
+        g_printerr ("error: 'records' can't be combined with 'offset' or 'length' in '%s'\n", str);
+        read_files_entry_free (entry);
+        return NULL;
+    }
+
+    if (!get_sim_file_id_and_path_with_separator (entry->file,
+                                                  &entry->file_id,
+                                                  &entry->file_path,
+                                                  "-")) {
+        entry->file_path = NULL;
+        read_files_entry_free (entry);
+        return NULL;
+    }
+
+    /* Normalize the path so that equal files are grouped and cached
+     * together however they were written */
+    file = g_string_new (NULL);
+    for (i = 0; i + 1 < entry->file_path->len; i += 2)
+        g_string_append_printf (file, "%02X%02X-",
+                                g_array_index (entry->file_path, guint8, i + 1),
+                                g_array_index (entry->file_path, guint8, i));
+    g_string_append_printf (file, "%04X", entry->file_id);
+    g_free (entry->file);
+    entry->file = g_string_free (file, FALSE);
+
+    return entry;
+}
+
+static gint
+read_files_entry_compare (gconstpointer a,
+                          gconstpointer b)
+{
+    const ReadFilesEntry *entry_a = *((const ReadFilesEntry **) a);
+    const ReadFilesEntry *entry_b = *((const ReadFilesEntry **) b);
+    gint cmp;
+
+    cmp = g_strcmp0 (entry_a->file, entry_b->file);
+    if (cmp)
+        return cmp;
+    if (entry_a->record != entry_b->record)
+        return entry_a->record ? 1 : -1;
+    if (entry_a->record_length != entry_b->record_length)
+        return entry_a->record_length < entry_b->record_length ? -1 : 1;
+    if (entry_a->record)
+        return (gint) entry_a->first - (gint) entry_b->first;
+    return (gint) entry_a->offset - (gint) entry_b->offset;
+}
+
+static ReadFilesRequest *
+read_files_request_new (ReadFilesEntry *entry)
+{
+    ReadFilesRequest *request;
+
+    request = g_slice_new0 (ReadFilesRequest);
+    request->head = entry;
+    request->record = entry->record;
+    request->first = entry->first;
+    request->last = entry->last;
+    request->record_length = entry->record_length;
+    request->offset = entry->offset;
+    request->end = entry->length ? (guint32) entry->offset + entry->length : G_MAXUINT32;
+    request->entries = g_ptr_array_new ();
+    g_ptr_array_add (request->entries, entry);
+
+    /* Immutable files are read whole, so the cache can serve any range */
+    if (read_files_is_immutable (entry)) {
+        request->offset = 0;
+        request->end = G_MAXUINT32;
+        request->cache = TRUE;
+    }
+    return request;
+}
+
+static gboolean
+read_files_request_merge (ReadFilesRequest *request,
+                          ReadFilesEntry   *entry)
+{
+    guint32 end;
+
+    if (!g_str_equal (request->head->file, entry->file) ||
+        request->record != entry->record ||
+        request->record_length != entry->record_length)
+        return FALSE;
+
+    if (request->record) {
+        /* Overlapping or adjacent record ranges */
+        if ((guint32) entry->first > (guint32) request->last + 1)
+            return FALSE;
+        request->last = MAX (request->last, entry->last);
+    } else {
+        /* Overlapping or adjacent byte ranges, within a single read */
+        if (entry->offset > request->end)
+            return FALSE;
+        end = entry->length ? (guint32) entry->offset + entry->length : G_MAXUINT32;
+        if (end != G_MAXUINT32 && end - request->offset > G_MAXUINT16)
+            return FALSE;
+        request->end = MAX (request->end, end);
+    }
+
+    g_ptr_array_add (request->entries, entry);
+    return TRUE;
+}
+
+static void
+read_files_entry_set_data (ReadFilesEntry *entry,
+                           const guint8   *data,
+                           guint           len)
+{
+    entry->data = g_array_sized_new (FALSE, FALSE, sizeof (guint8), len);
+    g_array_append_vals (entry->data, data, len);
+}
+
+static void
+read_files_transparent_deliver (ReadFilesEntry *entry,
+                                GArray         *data,
+                                guint16         offset)
+{
+    guint start;
+    guint len;
+
+    start = entry->offset - offset;
+    if (start > data->len) {
+        entry->error = g_strdup ("offset beyond the end of the file");
+        return;
+    }
+
+    len = data->len - start;
+    if (entry->length && entry->length < len)
+        len = entry->length;
+    read_files_entry_set_data (entry, &g_array_index (data, guint8, start), len);
+}
+
+static void
+read_files_print_entry (ReadFilesEntry *entry)
+{
+    gchar *str;
+    guint i;
+
+    if (entry->record)
+        g_print ("File '%s' (records %u-%u):\n", entry->file, entry->first, entry->last);
+    else if (entry->length)
+        g_print ("File '%s' (offset %u, length %u):\n", entry->file, entry->offset, entry->length);
+    else
+        g_print ("File '%s' (offset %u):\n", entry->file, entry->offset);
+
+    if (entry->card_result)
+        g_print ("\tCard result: SW1 '0x%02x', SW2 '0x%02x'\n", entry->sw1, entry->sw2);
+
+    if (entry->error) {
+        g_print ("\terror: %s\n", entry->error);
+        return;
+    }
+
+    if (entry->cached)
+        g_print ("\tRead result (cached):\n");
+    else
+        g_print ("\tRead result:\n");
+
+    if (!entry->record || !entry->record_size) {
+        str = qmicli_get_raw_data_printable (entry->data, 80, "\t\t");
+        g_print ("%s\n", str);
+        g_free (str);
+        return;
+    }
+
+    for (i = 0; i * entry->record_size < entry->data->len; i++) {
+        GArray *record;
+
+        record = g_array_sized_new (FALSE, FALSE, sizeof (guint8), entry->record_size);
+        g_array_append_vals (record,
+                             &g_array_index (entry->data, guint8, i * entry->record_size),
+                             MIN (entry->record_size, entry->data->len - i * entry->record_size));
+        str = qmicli_get_raw_data_printable (record, 80, "\t\t");
+        g_print ("\tRecord %u:\n%s\n", entry->first + i, str);
+        g_free (str);
+        g_array_unref (record);
+    }
+}
+
+static void read_files_schedule (void);
+
+static void
+read_files_request_fail (ReadFilesRequest *request,
+                         const gchar      *error,
+                         gboolean          card_result,
+                         guint8           sw1,
+                         guint8           sw2)
+{
+    guint i;
+
+    for (i = 0; i < request->entries->len; i++) {
+        ReadFilesEntry *entry;
+
+        entry = g_ptr_array_index (request->entries, i);
+        entry->error = g_strdup (error);
+        entry->card_result = card_result;
+        entry->sw1 = sw1;
+        entry->sw2 = sw2;
+    }
+}
+
+static void
+read_files_request_done (void)
+{
+    read_files_ctx->in_flight--;
+    read_files_ctx->pending--;
+    read_files_schedule ();
+}
+
+static void
+read_files_transparent_ready (QmiClientUim     *client,
+                              GAsyncResult     *res,
+                              ReadFilesRequest *request)
+{
+    QmiMessageUimReadTransparentOutput *output;
+    GError *error = NULL;
+    GArray *read_result = NULL;
+    gboolean card_result;
+    guint8 sw1 = 0;
+    guint8 sw2 = 0;
+    guint i;
+
+    output = qmi_client_uim_read_transparent_finish (client, res, &error);
+    if (!output) {
+        read_files_request_fail (request, error->message, FALSE, 0, 0);
+        g_error_free (error);
+        read_files_request_done ();
+        return;
+    }
+
+    card_result = qmi_message_uim_read_transparent_output_get_card_result (output, &sw1, &sw2, NULL);
+
+    if (!qmi_message_uim_read_transparent_output_get_result (output, &error) ||
+        !qmi_message_uim_read_transparent_output_get_read_result (output, &read_result, &error)) {
+        read_files_request_fail (request, error->message, card_result, sw1, sw2);
+        g_error_free (error);
+        qmi_message_uim_read_transparent_output_unref (output);
+        read_files_request_done ();
+        return;
+    }
+
+    if (request->cache) {
+        GArray *data;
+
+        data = g_array_sized_new (FALSE, FALSE, sizeof (guint8), read_result->len);
+        g_array_append_vals (data, read_result->data, read_result->len);
+        g_hash_table_replace (read_files_cache, read_files_cache_key (request->head), data);
+    }
+
+    for (i = 0; i < request->entries->len; i++) {
+        ReadFilesEntry *entry;
+
+        entry = g_ptr_array_index (request->entries, i);
+        entry->card_result = card_result;
+        entry->sw1 = sw1;
+        entry->sw2 = sw2;
+        read_files_transparent_deliver (entry, read_result, request->offset);
+    }
+
+    qmi_message_uim_read_transparent_output_unref (output);
+    read_files_request_done ();
+}
+
+static void
+read_files_record_ready (QmiClientUim     *client,
+                         GAsyncResult     *res,
+                         ReadFilesRequest *request)
+{
+    QmiMessageUimReadRecordOutput *output;
+    GError *error = NULL;
+    GArray *read_result = NULL;
+    GArray *additional = NULL;
+    GArray *data;
+    gboolean card_result;
+    guint8 sw1 = 0;
+    guint8 sw2 = 0;
+    guint size;
+    guint i;
+
+    output = qmi_client_uim_read_record_finish (client, res, &error);
+    if (!output) {
+        read_files_request_fail (request, error->message, FALSE, 0, 0);
+        g_error_free (error);
+        read_files_request_done ();
+        return;
+    }
+
+    card_result = qmi_message_uim_read_record_output_get_card_result (output, &sw1, &sw2, NULL);
+
+    if (!qmi_message_uim_read_record_output_get_result (output, &error) ||
+        !qmi_message_uim_read_record_output_get_read_result (output, &read_result, &error)) {
+        read_files_request_fail (request, error->message, card_result, sw1, sw2);
+        g_error_free (error);
+        qmi_message_uim_read_record_output_unref (output);
+        read_files_request_done ();
+        return;
+    }
+
+    /* The first record comes on its own, any others of the range follow
+     * back to back in the additional read result */
+    size = read_result->len;
+    data = g_array_sized_new (FALSE, FALSE, sizeof (guint8), size);
+    g_array_append_vals (data, read_result->data, read_result->len);
+    if (qmi_message_uim_read_record_output_get_additional_read_result (output, &additional, NULL))
+        g_array_append_vals (data, additional->data, additional->len);
+
+    for (i = 0; i < request->entries->len; i++) {
+        ReadFilesEntry *entry;
+        guint start;
+        guint len;
+
+        entry = g_ptr_array_index (request->entries, i);
+        entry->card_result = card_result;
+        entry->sw1 = sw1;
+        entry->sw2 = sw2;
+        entry->record_size = size;
+
+        start = (entry->first - request->first) * size;
+        if (start > data->len) {
+            entry->error = g_strdup ("records beyond the end of the file");
+            continue;
+        }
+        len = MIN ((guint) (entry->last - entry->first + 1) * size, data->len - start);
+        read_files_entry_set_data (entry, &g_array_index (data, guint8, start), len);
+    }
+
+    g_array_unref (data);
+    qmi_message_uim_read_record_output_unref (output);
+    read_files_request_done ();
+}
+
+static void
+read_files_send (ReadFilesRequest *request)
+{
+    GArray *dummy_aid;
+
+    dummy_aid = g_array_new (FALSE, FALSE, sizeof (guint8));
+
+    if (request->record) {
+        QmiMessageUimReadRecordInput *input;
+
+        input = qmi_message_uim_read_record_input_new ();
+        qmi_message_uim_read_record_input_set_session (
+            input,
+            QMI_UIM_SESSION_TYPE_PRIMARY_GW_PROVISIONING,
+            dummy_aid, /* ignored */
+            NULL);
+        qmi_message_uim_read_record_input_set_file (
+            input,
+            request->head->file_id,
+            request->head->file_path,
+            NULL);
+        qmi_message_uim_read_record_input_set_record (
+            input,
+            request->first,
+            request->record_length,
+            NULL);
+        if (request->last > request->first)
+            qmi_message_uim_read_record_input_set_last_record (input, request->last, NULL);
+
+        g_debug ("Asynchronously reading records %u-%u of file '%s'...",
+                 request->first, request->last, request->head->file);
+        qmi_client_uim_read_record (ctx->client,
+                                    input,
+                                    10,
+                                    ctx->cancellable,
+                                    (GAsyncReadyCallback)read_files_record_ready,
+                                    request);
+        qmi_message_uim_read_record_input_unref (input);
+    } else {
+        QmiMessageUimReadTransparentInput *input;
+        guint16 length;
+
+        length = (request->end == G_MAXUINT32) ? 0 : (guint16) (request->end - request->offset);
+
+        input = qmi_message_uim_read_transparent_input_new ();
+        qmi_message_uim_read_transparent_input_set_session (
+            input,
+            QMI_UIM_SESSION_TYPE_PRIMARY_GW_PROVISIONING,
+            dummy_aid, /* ignored */
+            NULL);
+        qmi_message_uim_read_transparent_input_set_file (
+            input,
+            request->head->file_id,
+            request->head->file_path,
+            NULL);
+        qmi_message_uim_read_transparent_input_set_read_information (
+            input,
+            request->offset,
+            length,
+            NULL);
+
+        g_debug ("Asynchronously reading %u bytes at offset %u of file '%s'...",
+                 length, request->offset, request->head->file);
+        qmi_client_uim_read_transparent (ctx->client,
+                                         input,
+                                         10,
+                                         ctx->cancellable,
+                                         (GAsyncReadyCallback)read_files_transparent_ready,
+                                         request);
+        qmi_message_uim_read_transparent_input_unref (input);
+    }
+
+    g_array_unref (dummy_aid);
+}
+
+static void
+read_files_schedule (void)
+{
+    ReadFilesContext *context = read_files_ctx;
+    gboolean success = TRUE;
+    guint n_failed = 0;
+    guint i;
+
+    while (context->in_flight < READ_FILES_MAX_IN_FLIGHT &&
+           context->next < context->requests->len) {
+        context->in_flight++;
+        read_files_send (g_ptr_array_index (context->requests, context->next++));
+    }
+
+    if (context->pending > 0)
+        return;
+
+    for (i = 0; i < context->entries->len; i++) {
+        if (((ReadFilesEntry *) g_ptr_array_index (context->entries, i))->error)
+            n_failed++;
+    }
+
+    if (n_failed) {
+        g_print ("[%s] Read %u files from the UIM (%u failed):\n",
+                 qmi_device_get_path_display (ctx->device),
+                 context->entries->len, n_failed);
+        success = FALSE;
+    } else
+        g_print ("[%s] Successfully read %u files from the UIM:\n",
+                 qmi_device_get_path_display (ctx->device),
+                 context->entries->len);
+
+    for (i = 0; i < context->entries->len; i++)
+        read_files_print_entry (g_ptr_array_index (context->entries, i));
+
+    read_files_context_free (context);
+    read_files_ctx = NULL;
+    operation_shutdown (success);
+}
+
+static gboolean
+read_files_start (const gchar *str)
+{
+    ReadFilesContext *context;
+    GPtrArray *sorted;
+    ReadFilesRequest *request = NULL;
+    gchar **split;
+    guint i;
+
+    if (!read_files_cache)
+        read_files_cache = g_hash_table_new_full (g_str_hash,
+                                                  g_str_equal,
+                                                  g_free,
+                                                  (GDestroyNotify) g_array_unref);
+
+    context = g_slice_new0 (ReadFilesContext);
+    context->entries = g_ptr_array_new_with_free_func ((GDestroyNotify) read_files_entry_free);
+    context->requests = g_ptr_array_new_with_free_func ((GDestroyNotify) read_files_request_free);
+
+    /* Format of the string is:
+     *    "[file=0xNNNN-0xNNNN-...[,records=N[-N],record-length=N][,offset=N,length=N]];..."
+     */
+    split = g_strsplit (str, ";", -1);
+    for (i = 0; split[i]; i++) {
+        ReadFilesEntry *entry;
+
+        if (!split[i][0])
+            continue;
+
+        entry = read_files_entry_new (split[i]);
+        if (!entry) {
+            g_strfreev (split);
+            read_files_context_free (context);
+            return FALSE;
+        }
+        g_ptr_array_add (context->entries, entry);
+    }
+    g_strfreev (split);
+
+    if (!context->entries->len) {
+        g_printerr ("error: no files given to read\n");
+        read_files_context_free (context);
+        return FALSE;
+    }
+
+    /* Serve immutable files from the cache, and coalesce the rest into as
+     * few reads as possible: ranges of the same file (and record length)
+     * that overlap or touch each other become a single request */
+    sorted = g_ptr_array_new ();
+    for (i = 0; i < context->entries->len; i++) {
+        ReadFilesEntry *entry;
+        GArray *data;
+        gchar *key;
+
+        entry = g_ptr_array_index (context->entries, i);
+        if (read_files_is_immutable (entry)) {
+            key = read_files_cache_key (entry);
+            data = g_hash_table_lookup (read_files_cache, key);
+            g_free (key);
+            if (data) {
+                entry->cached = TRUE;
+                read_files_transparent_deliver (entry, data, 0);
+                continue;
+            }
+        }
+        g_ptr_array_add (sorted, entry);
+    }
+    g_ptr_array_sort (sorted, read_files_entry_compare);
+
+    for (i = 0; i < sorted->len; i++) {
+        ReadFilesEntry *entry;
+
+        entry = g_ptr_array_index (sorted, i);
+        if (request && read_files_request_merge (request, entry))
+            continue;
+        request = read_files_request_new (entry);
+        g_ptr_array_add (context->requests, request);
+    }
+    g_ptr_array_unref (sorted);
+
+    g_debug ("Reading %u files from the UIM with %u requests...",
+             context->entries->len, context->requests->len);
+
+    context->pending = context->requests->len;
+    read_files_ctx = context;
+    read_files_schedule ();
+    return TRUE;
+}
+
+#endif /* HAVE_QMI_MESSAGE_UIM_READ_TRANSPARENT
+        * HAVE_QMI_MESSAGE_UIM_READ_RECORD */
+
 #if defined HAVE_QMI_MESSAGE_UIM_GET_FILE_ATTRIBUTES
 
 static void
@@ -2393,6 +3185,13 @@ qmicli_uim_run (QmiDevice *device,
     ctx->client = g_object_ref (client);
     ctx->cancellable = g_object_ref (cancellable);
 
+#if defined HAVE_QMI_MESSAGE_UIM_READ_TRANSPARENT && defined HAVE_QMI_MESSAGE_UIM_READ_RECORD
+    /* Cached files are only valid within the current card session */
+    if (sim_power_on_str || sim_power_off_str || change_provisioning_session_str ||
+        switch_slot_str || reset_flag)
+        read_files_cache_clear ();
+#endif
+
 #if defined HAVE_QMI_MESSAGE_UIM_SET_PIN_PROTECTION
     if (set_pin_protection_str) {
         QmiMessageUimSetPinProtectionInput *input;
@@ -2523,6 +3322,14 @@ qmicli_uim_run (QmiDevice *device,
     }
 #endif
 
+#if defined HAVE_QMI_MESSAGE_UIM_READ_TRANSPARENT && defined HAVE_QMI_MESSAGE_UIM_READ_RECORD
+    if (read_files_str) {
+        if (!read_files_start (read_files_str))
+            operation_shutdown (FALSE);
+        return;
+    }
+#endif
+
 #if defined HAVE_QMI_MESSAGE_UIM_GET_FILE_ATTRIBUTES
     if (get_file_attributes_str) {
         QmiMessageUimGetFileAttributesInput *input;
@@ -35,17 +35,31 @@
 
 #if defined HAVE_QMI_SERVICE_VOICE
 
+#if defined HAVE_QMI_MESSAGE_VOICE_INDICATION_REGISTER && \
+    defined HAVE_QMI_INDICATION_VOICE_ALL_CALL_STATUS
+# define HAVE_VOICE_FOLLOW_CALLS
+#endif
+
 /* Context */
 typedef struct {
     QmiDevice *device;
     QmiClientVoice *client;
     GCancellable *cancellable;
+    /* Follow calls */
+    guint all_call_status_indication_id;
+    guint ussd_indication_id;
+    guint release_ussd_indication_id;
+    guint report_id;
+    GHashTable *calls;
+    GString *pending_events;
 } Context;
 static Context *ctx;
 
 /* Options */
 static gboolean get_config_flag;
 static gboolean get_supported_messages_flag;
+static gboolean follow_calls_flag;
+static gint follow_interval;
 static gboolean noop_flag;
 
 static GOptionEntry entries[] = {
@@ -60,6 +74,16 @@ static GOptionEntry entries[] = {
       "Get supported messages",
       NULL
     },
+#endif
+#if defined HAVE_VOICE_FOLLOW_CALLS
+    { "voice-follow-calls", 0, 0, G_OPTION_ARG_NONE, &follow_calls_flag,
+      "Follow call state changes and USSD events, writing one line per change",
+      NULL
+    },
+    { "voice-follow-interval", 0, 0, G_OPTION_ARG_INT, &follow_interval,
+      "Write the changes of the `--voice-follow-calls' action at most once every given milliseconds, only the latest state of each call (default 0, write right away)",
+      "[MS]"
+    },
 #endif
     { "voice-noop", 0, 0, G_OPTION_ARG_NONE, &noop_flag,
       "Just allocate or release a VOICE client. Use with `--client-no-release-cid' and/or `--client-cid'",
@@ -83,17 +107,26 @@ qmicli_voice_get_option_group (void)
     return group;
 }
 
+static guint n_actions;
+static gboolean checked;
+
+void
+qmicli_voice_options_reset (void)
+{
+    qmicli_reset_option_entries (entries);
+    n_actions = 0;
+    checked = FALSE;
+}
+
 gboolean
 qmicli_voice_options_enabled (void)
 {
-    static guint n_actions = 0;
-    static gboolean checked = FALSE;
-
     if (checked)
         return !!n_actions;
 
     n_actions = (get_config_flag +
                  get_supported_messages_flag +
+                 follow_calls_flag +
                  noop_flag);
 
     if (n_actions > 1) {
@@ -101,6 +134,21 @@ qmicli_voice_options_enabled (void)
         exit (EXIT_FAILURE);
     }
 
+    if (follow_interval < 0) {
+        g_printerr ("error: invalid follow interval: %d\n", follow_interval);
+        exit (EXIT_FAILURE);
+    }
+
+    if (follow_interval > 0 && !follow_calls_flag) {
+        g_printerr ("error: `--voice-follow-interval' is only applicable with `--voice-follow-calls'\n");
+        exit (EXIT_FAILURE);
+    }
+
+    /* Actions that require receiving QMI indication messages must specify that
+     * indications are expected. */
+    if (follow_calls_flag)
+        qmicli_expect_indications ();
+
     checked = TRUE;
     return !!n_actions;
 }
@@ -111,6 +159,19 @@ context_free (Context *context)
     if (!context)
         return;
 
+    if (context->report_id)
+        g_source_remove (context->report_id);
+    if (context->all_call_status_indication_id)
+        g_signal_handler_disconnect (context->client, context->all_call_status_indication_id);
+    if (context->ussd_indication_id)
+        g_signal_handler_disconnect (context->client, context->ussd_indication_id);
+    if (context->release_ussd_indication_id)
+        g_signal_handler_disconnect (context->client, context->release_ussd_indication_id);
+    if (context->calls)
+        g_hash_table_unref (context->calls);
+    if (context->pending_events)
+        g_string_free (context->pending_events, TRUE);
+
     if (context->client)
         g_object_unref (context->client);
     g_object_unref (context->cancellable);
@@ -304,6 +365,403 @@ get_supported_messages_ready (QmiClientVoice *client,
 
 #endif /* HAVE_QMI_MESSAGE_VOICE_GET_SUPPORTED_MESSAGES */
 
+#if defined HAVE_VOICE_FOLLOW_CALLS
+
+/*****************************************************************************/
+/* Follow calls
+ *
+ * The All Call Status indication reports the whole list of calls, so the
+ * state of each call is kept in a table, and only calls whose state differs
+ * from the one last written are reported: one line per change, made of an
+ * event name followed by key=value pairs (free text values are quoted and
+ * escaped), e.g.:
+ *
+ *   call time=1602761532123 id=1 state=conversation type=voice direction=mobile-originated mode=lte als=line-1 multipart=no presentation=allowed number="+34600000000"
+ *   call time=1602761540456 id=1 removed
+ *   ussd time=1602761550789 user-action=required data="1. Balance 2. Top up"
+ *   ussd-release time=1602761560012
+ *
+ * With an interval, changes are written at most once per interval, so calls
+ * going through several states within it are reported just in their latest
+ * one; USSD events are always reported, in order. */
+
+typedef struct {
+    QmiVoiceCallState     state;
+    QmiVoiceCallType      type;
+    QmiVoiceCallDirection direction;
+    QmiVoiceCallMode      mode;
+    QmiVoiceAls           als;
+    gboolean              multipart;
+    QmiVoicePresentation  presentation;
+    gchar                *number;
+} CallState;
+
+typedef struct {
+    guint8     id;
+    gboolean   present;
+    CallState  current;
+    /* Last state written, if any */
+    gboolean   reported;
+    CallState  last;
+} CallEntry;
+
+static void
+call_entry_free (CallEntry *entry)
+{
+    g_free (entry->current.number);
+    g_free (entry->last.number);
+    g_slice_free (CallEntry, entry);
+}
+
+static gboolean
+call_state_equal (const CallState *a,
+                  const CallState *b)
+{
+    return (a->state == b->state &&
+            a->type == b->type &&
+            a->direction == b->direction &&
+            a->mode == b->mode &&
+            a->als == b->als &&
+            a->multipart == b->multipart &&
+            a->presentation == b->presentation &&
+            g_strcmp0 (a->number, b->number) == 0);
+}
+
+static void
+call_state_copy (CallState       *dest,
+                 const CallState *src)
+{
+    g_free (dest->number);
+    *dest = *src;
+    dest->number = g_strdup (src->number);
+}
+
+static gint
+call_entry_compare (const CallEntry *a,
+                    const CallEntry *b)
+{
+    return (gint)a->id - (gint)b->id;
+}
+
+static void
+append_quoted (GString     *line,
+               const gchar *key,
+               const gchar *value)
+{
+    static gchar *exceptions;
+    g_autofree gchar *escaped = NULL;
+
+    /* Keep UTF-8 sequences as they are, only escape control chars and quotes */
+    if (G_UNLIKELY (!exceptions)) {
+        guint i;
+
+        exceptions = g_malloc (0x80 + 1);
+        for (i = 0; i < 0x80; i++)
+            exceptions[i] = (gchar)(0x80 + i);
+        exceptions[0x80] = '\0';
+    }
+
+    escaped = g_strescape (value, exceptions);
+    g_string_append_printf (line, " %s=\"%s\"", key, escaped);
+}
+
+static GString *
+event_line_new (const gchar *event)
+{
+    GString *line;
+
+    line = g_string_new (event);
+    g_string_append_printf (line, " time=%" G_GINT64_FORMAT, g_get_real_time () / 1000);
+    return line;
+}
+
+static void
+append_call_line (GString         *out,
+                  guint8           id,
+                  const CallState *state)
+{
+    g_autoptr(GString) line = NULL;
+
+    line = event_line_new ("call");
+    g_string_append_printf (line, " id=%u", id);
+    if (!state) {
+        g_string_append (line, " removed\n");
+        g_string_append_len (out, line->str, line->len);
+        return;
+    }
+
+    g_string_append_printf (line, " state=%s type=%s direction=%s mode=%s als=%s multipart=%s presentation=%s",
+                            qmi_voice_call_state_get_string (state->state),
+                            qmi_voice_call_type_get_string (state->type),
+                            qmi_voice_call_direction_get_string (state->direction),
+                            qmi_voice_call_mode_get_string (state->mode),
+                            qmi_voice_als_get_string (state->als),
+                            state->multipart ? "yes" : "no",
+                            qmi_voice_presentation_get_string (state->presentation));
+    if (state->number)
+        append_quoted (line, "number", state->number);
+    g_string_append_c (line, '\n');
+    g_string_append_len (out, line->str, line->len);
+}
+
+static void
+follow_calls_report (void)
+{
+    g_autoptr(GString) out = NULL;
+    GHashTableIter     iter;
+    CallEntry         *entry;
+    GList             *changed = NULL;
+    GList             *l;
+
+    out = g_string_new (NULL);
+
+    /* Calls in order of their IDs, so that output is stable */
+    g_hash_table_iter_init (&iter, ctx->calls);
+    while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&entry)) {
+        if (entry->present ?
+            (!entry->reported || !call_state_equal (&entry->current, &entry->last)) :
+            entry->reported)
+            changed = g_list_prepend (changed, entry);
+        else if (!entry->present)
+            g_hash_table_iter_remove (&iter);
+    }
+    changed = g_list_sort (changed, (GCompareFunc) call_entry_compare);
+
+    for (l = changed; l; l = g_list_next (l)) {
+        entry = l->data;
+        if (entry->present) {
+            append_call_line (out, entry->id, &entry->current);
+            call_state_copy (&entry->last, &entry->current);
+            entry->reported = TRUE;
+        } else {
+            append_call_line (out, entry->id, NULL);
+            g_hash_table_remove (ctx->calls, GUINT_TO_POINTER (entry->id));
+        }
+    }
+    g_list_free (changed);
+
+    g_string_append_len (out, ctx->pending_events->str, ctx->pending_events->len);
+    g_string_truncate (ctx->pending_events, 0);
+
+    if (out->len) {
+        fwrite (out->str, 1, out->len, stdout);
+        fflush (stdout);
+    }
+}
+
+static gboolean
+follow_calls_report_cb (void)
+{
+    ctx->report_id = 0;
+    follow_calls_report ();
+    return G_SOURCE_REMOVE;
+}
+
+static void
+follow_calls_schedule_report (void)
+{
+    if (!follow_interval) {
+        follow_calls_report ();
+        return;
+    }
+
+    if (!ctx->report_id)
+        ctx->report_id = g_timeout_add (follow_interval, (GSourceFunc) follow_calls_report_cb, NULL);
+}
+
+static void
+all_call_status_received (QmiClientVoice                        *client,
+                          QmiIndicationVoiceAllCallStatusOutput *output)
+{
+    GArray         *call_information = NULL;
+    GArray         *remote_party_number = NULL;
+    GHashTableIter  iter;
+    CallEntry      *entry;
+    guint           i;
+
+    qmi_indication_voice_all_call_status_output_get_call_information (output, &call_information, NULL);
+    qmi_indication_voice_all_call_status_output_get_remote_party_number (output, &remote_party_number, NULL);
+
+    /* The indication lists all calls, any other is gone */
+    g_hash_table_iter_init (&iter, ctx->calls);
+    while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&entry))
+        entry->present = FALSE;
+
+    for (i = 0; call_information && i < call_information->len; i++) {
+        QmiIndicationVoiceAllCallStatusOutputCallInformationCall *call;
+        guint j;
+
+        call = &g_array_index (call_information, QmiIndicationVoiceAllCallStatusOutputCallInformationCall, i);
+        entry = g_hash_table_lookup (ctx->calls, GUINT_TO_POINTER (call->id));
+        if (!entry) {
+            entry = g_slice_new0 (CallEntry);
+            entry->id = call->id;
+            g_hash_table_insert (ctx->calls, GUINT_TO_POINTER (call->id), entry);
+        }
+
+        entry->present = TRUE;
+        entry->current.state = call->state;
+        entry->current.type = call->type;
+        entry->current.direction = call->direction;
+        entry->current.mode = call->mode;
+        entry->current.als = call->als;
+        entry->current.multipart = call->multipart_indicator;
+        entry->current.presentation = QMI_VOICE_PRESENTATION_ALLOWED;
+        g_clear_pointer (&entry->current.number, g_free);
+
+        for (j = 0; remote_party_number && j < remote_party_number->len; j++) {
+            QmiIndicationVoiceAllCallStatusOutputRemotePartyNumberCall *number;
+
+            number = &g_array_index (remote_party_number, QmiIndicationVoiceAllCallStatusOutputRemotePartyNumberCall, j);
+            if (number->id == call->id) {
+                entry->current.presentation = number->presentation_indicator;
+                if (number->type && number->type[0])
+                    entry->current.number = g_strdup (number->type);
+                break;
+            }
+        }
+    }
+
+    follow_calls_schedule_report ();
+}
+
+#if defined HAVE_QMI_INDICATION_VOICE_USSD
+
+static gchar *
+ussd_data_to_utf8 (QmiVoiceUssDataCodingScheme  dcs,
+                   GArray                      *data)
+{
+    switch (dcs) {
+    case QMI_VOICE_USS_DATA_CODING_SCHEME_UCS2:
+        return g_convert ((const gchar *)data->data, data->len, "UTF-8", "UTF-16BE", NULL, NULL, NULL);
+    case QMI_VOICE_USS_DATA_CODING_SCHEME_ASCII:
+    case QMI_VOICE_USS_DATA_CODING_SCHEME_8BIT:
+        if (g_utf8_validate ((const gchar *)data->data, data->len, NULL))
+            return g_strndup ((const gchar *)data->data, data->len);
+        return NULL;
+    case QMI_VOICE_USS_DATA_CODING_SCHEME_UNKNOWN:
+    default:
+        return NULL;
+    }
+}
+
+static void
+ussd_received (QmiClientVoice               *client,
+               QmiIndicationVoiceUssdOutput *output)
+{
+    g_autoptr(GString)           line = NULL;
+    g_autofree gchar            *text = NULL;
+    QmiVoiceUserAction           user_action;
+    QmiVoiceUssDataCodingScheme  dcs;
+    GArray                      *data = NULL;
+    GArray                      *data_utf16 = NULL;
+
+    line = event_line_new ("ussd");
+
+    if (qmi_indication_voice_ussd_output_get_user_action (output, &user_action, NULL))
+        g_string_append_printf (line, " user-action=%s", qmi_voice_user_action_get_string (user_action));
+
+    /* The UTF-16 variant is preferred when both are given */
+    if (qmi_indication_voice_ussd_output_get_uss_data_utf16 (output, &data_utf16, NULL) && data_utf16)
+        text = g_utf16_to_utf8 ((const gunichar2 *)data_utf16->data, data_utf16->len, NULL, NULL, NULL);
+
+    if (!text && qmi_indication_voice_ussd_output_get_uss_data (output, &dcs, &data, NULL) && data) {
+        text = ussd_data_to_utf8 (dcs, data);
+        if (!text) {
+            guint i;
+
+            /* Undecodable data, given as it is */
+            g_string_append_printf (line, " data-coding-scheme=%s data-hex=",
+                                    qmi_voice_uss_data_coding_scheme_get_string (dcs));
+            for (i = 0; i < data->len; i++)
+                g_string_append_printf (line, "%02x", g_array_index (data, guint8, i));
+        }
+    }
+
+    if (text)
+        append_quoted (line, "data", text);
+
+    g_string_append_c (line, '\n');
+    g_string_append_len (ctx->pending_events, line->str, line->len);
+    follow_calls_schedule_report ();
+}
+
+#endif /* HAVE_QMI_INDICATION_VOICE_USSD */
+
+#if defined HAVE_QMI_INDICATION_VOICE_RELEASE_USSD
+
+static void
+release_ussd_received (QmiClientVoice *client)
+{
+    g_autoptr(GString) line = NULL;
+
+    line = event_line_new ("ussd-release");
+    g_string_append_c (line, '\n');
+    g_string_append_len (ctx->pending_events, line->str, line->len);
+    follow_calls_schedule_report ();
+}
+
+#endif /* HAVE_QMI_INDICATION_VOICE_RELEASE_USSD */
+
+static void
+follow_calls_cancelled (GCancellable *cancellable)
+{
+    /* Whatever is pending goes out before leaving */
+    follow_calls_report ();
+    operation_shutdown (TRUE);
+}
+
+static void
+indication_register_ready (QmiClientVoice *client,
+                           GAsyncResult   *res)
+{
+    g_autoptr(QmiMessageVoiceIndicationRegisterOutput) output = NULL;
+    g_autoptr(GError) error = NULL;
+
+    output = qmi_client_voice_indication_register_finish (client, res, &error);
+    if (!output) {
+        g_printerr ("error: operation failed: %s\n", error->message);
+        operation_shutdown (FALSE);
+        return;
+    }
+
+    if (!qmi_message_voice_indication_register_output_get_result (output, &error)) {
+        g_printerr ("error: couldn't register voice indications: %s\n", error->message);
+        operation_shutdown (FALSE);
+        return;
+    }
+
+    g_debug ("Registered voice indications...");
+
+    ctx->calls = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) call_entry_free);
+    ctx->pending_events = g_string_new (NULL);
+
+    ctx->all_call_status_indication_id = g_signal_connect (ctx->client,
+                                                           "all-call-status",
+                                                           G_CALLBACK (all_call_status_received),
+                                                           NULL);
+#if defined HAVE_QMI_INDICATION_VOICE_USSD
+    ctx->ussd_indication_id = g_signal_connect (ctx->client,
+                                                "ussd",
+                                                G_CALLBACK (ussd_received),
+                                                NULL);
+#endif
+#if defined HAVE_QMI_INDICATION_VOICE_RELEASE_USSD
+    ctx->release_ussd_indication_id = g_signal_connect (ctx->client,
+                                                        "release-ussd",
+                                                        G_CALLBACK (release_ussd_received),
+                                                        NULL);
+#endif
+
+    /* User can use Ctrl+C to stop following at any time */
+    g_cancellable_connect (ctx->cancellable,
+                           G_CALLBACK (follow_calls_cancelled),
+                           NULL,
+                           NULL);
+}
+
+#endif /* HAVE_VOICE_FOLLOW_CALLS */
+
 static gboolean
 noop_cb (gpointer unused)
 {
@@ -317,7 +775,7 @@ qmicli_voice_run (QmiDevice *device,
                   GCancellable *cancellable)
 {
     /* Initialize context */
-    ctx = g_slice_new (Context);
+    ctx = g_slice_new0 (Context);
     ctx->device = g_object_ref (device);
     ctx->client = g_object_ref (client);
     ctx->cancellable = g_object_ref (cancellable);
@@ -364,6 +822,25 @@ qmicli_voice_run (QmiDevice *device,
     }
 #endif
 
+#if defined HAVE_VOICE_FOLLOW_CALLS
+    if (follow_calls_flag) {
+        g_autoptr(QmiMessageVoiceIndicationRegisterInput) input = NULL;
+
+        input = qmi_message_voice_indication_register_input_new ();
+        qmi_message_voice_indication_register_input_set_call_notification_events (input, TRUE, NULL);
+        qmi_message_voice_indication_register_input_set_ussd_notification_events (input, TRUE, NULL);
+
+        g_debug ("Asynchronously registering voice indications...");
+        qmi_client_voice_indication_register (ctx->client,
+                                              input,
+                                              10,
+                                              ctx->cancellable,
+                                              (GAsyncReadyCallback)indication_register_ready,
+                                              NULL);
+        return;
+    }
+#endif
+
     /* Just client allocate/release? */
     if (noop_flag) {
         g_idle_add (noop_cb, NULL);
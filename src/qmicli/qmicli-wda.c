@@ -37,19 +37,64 @@
 
 #define QMI_WDA_DL_AGGREGATION_PROTOCOL_MAX_DATAGRAMS_UNDEFINED 0xFFFFFFFF
 #define QMI_WDA_DL_AGGREGATION_PROTOCOL_MAX_DATAGRAM_SIZE_UNDEFINED 0xFFFFFFFF
+
+/* Downlink aggregation defaults when QMAP is requested without explicit sizes */
+#define QMI_WDA_DL_AGGREGATION_PROTOCOL_MAX_DATAGRAMS_QMAP_DEFAULT 32
+#define QMI_WDA_DL_AGGREGATION_PROTOCOL_MAX_DATAGRAM_SIZE_QMAP_DEFAULT 32768
 #define QMI_WDA_ENDPOINT_INTERFACE_NUMBER_UNDEFINED -1
 
+/* Downlink aggregation tuning */
+#define TUNE_LATENCY_MAX_DATAGRAMS          4
+#define TUNE_LATENCY_MAX_DATAGRAM_SIZE      4096
+#define TUNE_MIN_DATAGRAM_SIZE              2048
+#define TUNE_DATAGRAM_SIZE_ALIGNMENT        1024
+#define TUNE_CALIBRATE_INTERVAL_SECS_DEFAULT 5
+#define TUNE_CALIBRATE_ROUNDS_MAX           10
+#define TUNE_CALIBRATE_MIN_PACKETS          100
+#define TUNE_CALIBRATE_CHANGE_THRESHOLD     10 /* percent */
+
+typedef enum {
+    TUNE_PROFILE_THROUGHPUT,
+    TUNE_PROFILE_BALANCED,
+    TUNE_PROFILE_LATENCY,
+} TuneProfile;
+
+typedef struct {
+    TuneProfile                   profile;
+    guint                         calibrate_rounds;
+    guint                         calibrate_interval;
+    QmiDataEndpointType           endpoint_type;
+    gint                          endpoint_iface_number;
+    /* Current format, as reported by the modem */
+    QmiWdaLinkLayerProtocol       link_layer_protocol;
+    QmiWdaDataAggregationProtocol ul_protocol;
+    QmiWdaDataAggregationProtocol dl_protocol;
+    /* Supported maxima */
+    guint32                       max_datagrams_limit;
+    guint32                       max_size_limit;
+    /* Currently applied values */
+    guint32                       max_datagrams;
+    guint32                       max_size;
+    /* Calibration state */
+    guint                         round;
+    guint                         timeout_id;
+    guint64                       rx_packets;
+    guint64                       rx_bytes;
+} TuneContext;
+
 /* Context */
 typedef struct {
     QmiDevice *device;
     QmiClientWda *client;
     GCancellable *cancellable;
+    TuneContext *tune;
 } Context;
 static Context *ctx;
 
 /* Options */
 static gchar    *set_data_format_str;
 static gchar    *get_data_format_str;
+static gchar    *tune_data_aggregation_str;
 static gboolean  get_data_format_flag;
 static gboolean  get_supported_messages_flag;
 static gboolean  noop_flag;
@@ -73,7 +118,7 @@ parse_get_data_format (const gchar  *option_name,
 static GOptionEntry entries[] = {
 #if defined HAVE_QMI_MESSAGE_WDA_SET_DATA_FORMAT
     { "wda-set-data-format", 0, 0, G_OPTION_ARG_STRING, &set_data_format_str,
-      "Set data format (allowed keys: link-layer-protocol (802-3|raw-ip), ul-protocol (tlp|qc-ncm|mbim|rndis|qmap|qmapv5), dl-protocol (tlp|qc-ncm|mbim|rndis|qmap|qmapv5), dl-datagram-max-size, dl-max-datagrams, ep-type (undefined|hsusb|pcie|embedded), ep-iface-number)",
+      "Set data format (allowed keys: link-layer-protocol (802-3|raw-ip), ul-protocol (tlp|qc-ncm|mbim|rndis|qmap|qmapv5), dl-protocol (tlp|qc-ncm|mbim|rndis|qmap|qmapv5), dl-datagram-max-size, dl-max-datagrams, ep-type (undefined|hsusb|pcie|embedded), ep-iface-number); with QMAP downlink aggregation the sizes default to 32768 bytes and 32 datagrams, and the WWAN iface is sized for the aggregation max size agreed",
       "[\"key=value,...\"]"
     },
 #endif
@@ -83,6 +128,12 @@ static GOptionEntry entries[] = {
       "[\"key=value,...\"]"
     },
 #endif
+#if defined HAVE_QMI_MESSAGE_WDA_GET_DATA_FORMAT && defined HAVE_QMI_MESSAGE_WDA_SET_DATA_FORMAT
+    { "wda-tune-data-aggregation", 0, 0, G_OPTION_ARG_STRING, &tune_data_aggregation_str,
+      "Tune QMAP downlink aggregation within the modem maxima (allowed keys: profile (throughput|balanced|latency), calibrate-rounds, calibrate-interval (seconds), ep-type (undefined|hsusb|pcie|embedded), ep-iface-number); calibration adjusts the sizes to the traffic measured on the WWAN iface",
+      "[\"key=value,...\"]"
+    },
+#endif
 #if defined HAVE_QMI_MESSAGE_WDA_GET_SUPPORTED_MESSAGES
     { "wda-get-supported-messages", 0, 0, G_OPTION_ARG_NONE, &get_supported_messages_flag,
       "Get supported messages",
@@ -111,17 +162,28 @@ qmicli_wda_get_option_group (void)
     return group;
 }
 
+static guint n_actions;
+static gboolean checked;
+
+void
+qmicli_wda_options_reset (void)
+{
+    qmicli_reset_option_entries (entries);
+    get_data_format_flag = FALSE;
+    g_clear_pointer (&get_data_format_str, g_free);
+    n_actions = 0;
+    checked = FALSE;
+}
+
 gboolean
 qmicli_wda_options_enabled (void)
 {
-    static guint n_actions = 0;
-    static gboolean checked = FALSE;
-
     if (checked)
         return !!n_actions;
 
     n_actions = (!!set_data_format_str +
                  get_data_format_flag +
+                 !!tune_data_aggregation_str +
                  get_supported_messages_flag +
                  noop_flag);
 
@@ -140,6 +202,11 @@ context_free (Context *context)
     if (!context)
         return;
 
+    if (context->tune) {
+        if (context->tune->timeout_id)
+            g_source_remove (context->tune->timeout_id);
+        g_slice_free (TuneContext, context->tune);
+    }
     if (context->client)
         g_object_unref (context->client);
     g_object_unref (context->cancellable);
@@ -348,6 +415,7 @@ set_data_format_ready (QmiClientWda *client,
     guint32 ndp_signature;
     guint32 data_aggregation_max_datagrams;
     guint32 data_aggregation_max_size;
+    gboolean dl_qmap = FALSE;
 
     output = qmi_client_wda_set_data_format_finish (client, res, &error);
     if (!output) {
@@ -391,9 +459,12 @@ set_data_format_ready (QmiClientWda *client,
     if (qmi_message_wda_set_data_format_output_get_downlink_data_aggregation_protocol (
             output,
             &data_aggregation_protocol,
-            NULL))
+            NULL)) {
         g_print ("     Downlink data aggregation protocol: '%s'\n",
                  qmi_wda_data_aggregation_protocol_get_string (data_aggregation_protocol));
+        dl_qmap = (data_aggregation_protocol == QMI_WDA_DATA_AGGREGATION_PROTOCOL_QMAP ||
+                   data_aggregation_protocol == QMI_WDA_DATA_AGGREGATION_PROTOCOL_QMAPV5);
+    }
 
     if (qmi_message_wda_set_data_format_output_get_ndp_signature (
             output,
@@ -410,9 +481,20 @@ set_data_format_ready (QmiClientWda *client,
     if (qmi_message_wda_set_data_format_output_get_downlink_data_aggregation_max_size (
             output,
             &data_aggregation_max_size,
-            NULL))
+            NULL)) {
         g_print ("     Downlink data aggregation max size: '%u'\n", data_aggregation_max_size);
 
+        /* Make the host receive buffers fit the aggregated frames; not fatal,
+         * as the driver in use may not need (or allow) it */
+        if (dl_qmap && data_aggregation_max_size > 0) {
+            if (!qmi_device_set_link_aggregation_max_size (ctx->device, data_aggregation_max_size, &error)) {
+                g_printerr ("warning: couldn't size WWAN iface for the aggregation max size: %s\n", error->message);
+                g_clear_error (&error);
+            } else
+                g_print ("    WWAN iface sized for aggregation to: '%u'\n", data_aggregation_max_size);
+        }
+    }
+
     qmi_message_wda_set_data_format_output_unref (output);
     operation_shutdown (TRUE);
 }
@@ -544,6 +626,15 @@ set_data_format_input_create (const gchar *str)
             goto error_out;
         }
 
+        /* QMAP without explicit aggregation sizes, use the defaults */
+        if (props.dl_protocol == QMI_WDA_DATA_AGGREGATION_PROTOCOL_QMAP ||
+            props.dl_protocol == QMI_WDA_DATA_AGGREGATION_PROTOCOL_QMAPV5) {
+            if (props.dl_datagram_max_size == QMI_WDA_DL_AGGREGATION_PROTOCOL_MAX_DATAGRAM_SIZE_UNDEFINED)
+                props.dl_datagram_max_size = QMI_WDA_DL_AGGREGATION_PROTOCOL_MAX_DATAGRAM_SIZE_QMAP_DEFAULT;
+            if (props.dl_max_datagrams == QMI_WDA_DL_AGGREGATION_PROTOCOL_MAX_DATAGRAMS_UNDEFINED)
+                props.dl_max_datagrams = QMI_WDA_DL_AGGREGATION_PROTOCOL_MAX_DATAGRAMS_QMAP_DEFAULT;
+        }
+
         if (!qmi_message_wda_set_data_format_input_set_uplink_data_aggregation_protocol (
                 input,
                 props.ul_protocol,
@@ -639,6 +730,501 @@ error_out:
 
 #endif /* HAVE_QMI_MESSAGE_WDA_SET_DATA_FORMAT */
 
+#if defined HAVE_QMI_MESSAGE_WDA_GET_DATA_FORMAT && defined HAVE_QMI_MESSAGE_WDA_SET_DATA_FORMAT
+
+static gboolean
+tune_data_aggregation_properties_handle (const gchar  *key,
+                                         const gchar  *value,
+                                         GError      **error,
+                                         gpointer      user_data)
+{
+    TuneContext *tune = (TuneContext *)user_data;
+
+    if (!value || !value[0]) {
+        g_set_error (error,
+                     QMI_CORE_ERROR,
+                     QMI_CORE_ERROR_FAILED,
+                     "key '%s' requires a value",
+                     key);
+        return FALSE;
+    }
+
+    if (g_ascii_strcasecmp (key, "profile") == 0) {
+        if (g_ascii_strcasecmp (value, "throughput") == 0)
+            tune->profile = TUNE_PROFILE_THROUGHPUT;
+        else if (g_ascii_strcasecmp (value, "balanced") == 0)
+            tune->profile = TUNE_PROFILE_BALANCED;
+        else if (g_ascii_strcasecmp (value, "latency") == 0)
+            tune->profile = TUNE_PROFILE_LATENCY;
+        else {
+            g_set_error (error,
+                         QMI_CORE_ERROR,
+                         QMI_CORE_ERROR_FAILED,
+                         "Unrecognized tuning profile '%s'",
+                         value);
+            return FALSE;
+        }
+        return TRUE;
+    }
+
+    if (g_ascii_strcasecmp (key, "calibrate-rounds") == 0) {
+        gint rounds;
+
+        rounds = atoi (value);
+        if (rounds < 0 || rounds > TUNE_CALIBRATE_ROUNDS_MAX) {
+            g_set_error (error,
+                         QMI_CORE_ERROR,
+                         QMI_CORE_ERROR_FAILED,
+                         "Calibration rounds must be between 0 and %u",
+                         TUNE_CALIBRATE_ROUNDS_MAX);
+            return FALSE;
+        }
+        tune->calibrate_rounds = (guint) rounds;
+        return TRUE;
+    }
+
+    if (g_ascii_strcasecmp (key, "calibrate-interval") == 0) {
+        gint interval;
+
+        interval = atoi (value);
+        if (interval <= 0) {
+            g_set_error (error,
+                         QMI_CORE_ERROR,
+                         QMI_CORE_ERROR_FAILED,
+                         "Invalid calibration interval '%s'",
+                         value);
+            return FALSE;
+        }
+        tune->calibrate_interval = (guint) interval;
+        return TRUE;
+    }
+
+    if (g_ascii_strcasecmp (key, "ep-type") == 0) {
+        if (!qmicli_read_data_endpoint_type_from_string (value, &(tune->endpoint_type))) {
+            g_set_error (error,
+                         QMI_CORE_ERROR,
+                         QMI_CORE_ERROR_FAILED,
+                         "Unrecognized Endpoint Type '%s'",
+                         value);
+            return FALSE;
+        }
+        return TRUE;
+    }
+
+    if (g_ascii_strcasecmp (key, "ep-iface-number") == 0) {
+        tune->endpoint_iface_number = atoi (value);
+        return TRUE;
+    }
+
+    g_set_error (error,
+                 QMI_CORE_ERROR,
+                 QMI_CORE_ERROR_FAILED,
+                 "Unrecognized option '%s'",
+                 key);
+    return FALSE;
+}
+
+static const gchar *
+tune_profile_get_string (TuneProfile profile)
+{
+    switch (profile) {
+    case TUNE_PROFILE_THROUGHPUT:
+        return "throughput";
+    case TUNE_PROFILE_BALANCED:
+        return "balanced";
+    case TUNE_PROFILE_LATENCY:
+        return "latency";
+    default:
+        g_assert_not_reached ();
+    }
+}
+
+/* How long the modem may hold downlink packets while filling an aggregate,
+ * used as calibration target for each profile */
+static guint
+tune_profile_get_window_usecs (TuneProfile profile)
+{
+    switch (profile) {
+    case TUNE_PROFILE_THROUGHPUT:
+        return 2000;
+    case TUNE_PROFILE_BALANCED:
+        return 1000;
+    case TUNE_PROFILE_LATENCY:
+        return 250;
+    default:
+        g_assert_not_reached ();
+    }
+}
+
+static guint32
+tune_align_size (TuneContext *tune,
+                 guint64      size)
+{
+    size = ((size + TUNE_DATAGRAM_SIZE_ALIGNMENT - 1) / TUNE_DATAGRAM_SIZE_ALIGNMENT) * TUNE_DATAGRAM_SIZE_ALIGNMENT;
+    size = MAX (size, TUNE_MIN_DATAGRAM_SIZE);
+    size = MIN (size, tune->max_size_limit);
+    return (guint32) size;
+}
+
+static void
+tune_profile_apply (TuneContext *tune)
+{
+    switch (tune->profile) {
+    case TUNE_PROFILE_THROUGHPUT:
+        tune->max_datagrams = tune->max_datagrams_limit;
+        tune->max_size = tune->max_size_limit;
+        break;
+    case TUNE_PROFILE_BALANCED:
+        tune->max_datagrams = MAX (tune->max_datagrams_limit / 2, 1);
+        tune->max_size = tune_align_size (tune, tune->max_size_limit / 2);
+        break;
+    case TUNE_PROFILE_LATENCY:
+        tune->max_datagrams = MIN (tune->max_datagrams_limit, TUNE_LATENCY_MAX_DATAGRAMS);
+        tune->max_size = tune_align_size (tune, TUNE_LATENCY_MAX_DATAGRAM_SIZE);
+        break;
+    default:
+        g_assert_not_reached ();
+    }
+}
+
+static gboolean
+tune_read_rx_counters (guint64  *out_packets,
+                       guint64  *out_bytes,
+                       GError  **error)
+{
+    const gchar *wwan_iface;
+    guint i;
+    struct {
+        const gchar *name;
+        guint64     *value;
+    } counters[] = {
+        { "rx_packets", out_packets },
+        { "rx_bytes",   out_bytes   },
+    };
+
+    wwan_iface = qmi_device_get_wwan_iface (ctx->device);
+    if (!wwan_iface) {
+        g_set_error (error,
+                     QMI_CORE_ERROR,
+                     QMI_CORE_ERROR_FAILED,
+                     "couldn't get WWAN iface name");
+        return FALSE;
+    }
+
+    for (i = 0; i < G_N_ELEMENTS (counters); i++) {
+        g_autofree gchar *path = NULL;
+        g_autofree gchar *contents = NULL;
+
+        path = g_strdup_printf ("/sys/class/net/%s/statistics/%s", wwan_iface, counters[i].name);
+        if (!g_file_get_contents (path, &contents, NULL, error))
+            return FALSE;
+        *(counters[i].value) = g_ascii_strtoull (contents, NULL, 10);
+    }
+
+    return TRUE;
+}
+
+static void tune_set_data_format (void);
+
+static gboolean
+tune_significant_change (guint32 current,
+                         guint32 proposed)
+{
+    guint32 diff;
+
+    diff = (current > proposed) ? (current - proposed) : (proposed - current);
+    return ((guint64) diff * 100 > (guint64) current * TUNE_CALIBRATE_CHANGE_THRESHOLD);
+}
+
+static gboolean
+tune_calibrate_cb (gpointer unused)
+{
+    TuneContext *tune = ctx->tune;
+    g_autoptr(GError) error = NULL;
+    guint64 rx_packets;
+    guint64 rx_bytes;
+    guint64 packets;
+    guint64 bytes;
+    guint64 datagrams;
+    guint32 max_datagrams;
+    guint32 max_size;
+
+    tune->timeout_id = 0;
+
+    if (!tune_read_rx_counters (&rx_packets, &rx_bytes, &error)) {
+        g_printerr ("error: couldn't read WWAN iface counters: %s\n", error->message);
+        operation_shutdown (FALSE);
+        return G_SOURCE_REMOVE;
+    }
+
+    packets = rx_packets - tune->rx_packets;
+    bytes = rx_bytes - tune->rx_bytes;
+    g_print ("[%s] Calibration round %u: %" G_GUINT64_FORMAT " packets, %" G_GUINT64_FORMAT " bytes received in %us\n",
+             qmi_device_get_path_display (ctx->device),
+             tune->round + 1, packets, bytes, tune->calibrate_interval);
+
+    if (packets < TUNE_CALIBRATE_MIN_PACKETS) {
+        g_print ("Not enough downlink traffic to calibrate, keeping current values\n");
+        operation_shutdown (TRUE);
+        return G_SOURCE_REMOVE;
+    }
+
+    /* Aggregate as many datagrams as arrive, at the measured rate, within the
+     * profile window; and size the aggregate for the measured mean packet */
+    datagrams = (packets * tune_profile_get_window_usecs (tune->profile)) /
+                ((guint64) tune->calibrate_interval * G_USEC_PER_SEC);
+    max_datagrams = (guint32) CLAMP (datagrams, 1, tune->max_datagrams_limit);
+    max_size = tune_align_size (tune, (bytes / packets) * max_datagrams);
+
+    tune->round++;
+
+    if (!tune_significant_change (tune->max_datagrams, max_datagrams) &&
+        !tune_significant_change (tune->max_size, max_size)) {
+        g_print ("Calibration converged: %u datagrams, %u bytes\n",
+                 tune->max_datagrams, tune->max_size);
+        operation_shutdown (TRUE);
+        return G_SOURCE_REMOVE;
+    }
+
+    tune->max_datagrams = max_datagrams;
+    tune->max_size = max_size;
+    tune_set_data_format ();
+    return G_SOURCE_REMOVE;
+}
+
+static void
+tune_set_data_format_ready (QmiClientWda *client,
+                            GAsyncResult *res)
+{
+    TuneContext *tune = ctx->tune;
+    g_autoptr(QmiMessageWdaSetDataFormatOutput) output = NULL;
+    g_autoptr(GError) error = NULL;
+    guint32 max_datagrams;
+    guint32 max_size;
+
+    output = qmi_client_wda_set_data_format_finish (client, res, &error);
+    if (!output) {
+        g_printerr ("error: operation failed: %s\n", error->message);
+        operation_shutdown (FALSE);
+        return;
+    }
+
+    if (!qmi_message_wda_set_data_format_output_get_result (output, &error)) {
+        g_printerr ("error: couldn't set data format: %s\n", error->message);
+        operation_shutdown (FALSE);
+        return;
+    }
+
+    /* The modem may have clamped the requested values */
+    if (qmi_message_wda_set_data_format_output_get_downlink_data_aggregation_max_datagrams (output, &max_datagrams, NULL))
+        tune->max_datagrams = max_datagrams;
+    if (qmi_message_wda_set_data_format_output_get_downlink_data_aggregation_max_size (output, &max_size, NULL))
+        tune->max_size = max_size;
+
+    g_print ("[%s] Downlink aggregation set (%s): %u datagrams, %u bytes\n",
+             qmi_device_get_path_display (ctx->device),
+             tune_profile_get_string (tune->profile),
+             tune->max_datagrams,
+             tune->max_size);
+
+    if (!qmi_device_set_link_aggregation_max_size (ctx->device, tune->max_size, &error)) {
+        g_printerr ("warning: couldn't size WWAN iface for the aggregation max size: %s\n", error->message);
+        g_clear_error (&error);
+    }
+
+    if (tune->round >= tune->calibrate_rounds) {
+        operation_shutdown (TRUE);
+        return;
+    }
+
+    if (!tune_read_rx_counters (&tune->rx_packets, &tune->rx_bytes, &error)) {
+        g_printerr ("error: couldn't read WWAN iface counters: %s\n", error->message);
+        operation_shutdown (FALSE);
+        return;
+    }
+
+    g_debug ("Measuring downlink traffic for %us...", tune->calibrate_interval);
+    tune->timeout_id = g_timeout_add_seconds (tune->calibrate_interval,
+                                              (GSourceFunc)tune_calibrate_cb,
+                                              NULL);
+}
+
+static void
+tune_set_data_format (void)
+{
+    TuneContext *tune = ctx->tune;
+    g_autoptr(QmiMessageWdaSetDataFormatInput) input = NULL;
+
+    input = qmi_message_wda_set_data_format_input_new ();
+    qmi_message_wda_set_data_format_input_set_link_layer_protocol (input, tune->link_layer_protocol, NULL);
+    qmi_message_wda_set_data_format_input_set_uplink_data_aggregation_protocol (input, tune->ul_protocol, NULL);
+    qmi_message_wda_set_data_format_input_set_downlink_data_aggregation_protocol (input, tune->dl_protocol, NULL);
+    qmi_message_wda_set_data_format_input_set_downlink_data_aggregation_max_datagrams (input, tune->max_datagrams, NULL);
+    qmi_message_wda_set_data_format_input_set_downlink_data_aggregation_max_size (input, tune->max_size, NULL);
+    if (tune->endpoint_type != QMI_DATA_ENDPOINT_TYPE_UNDEFINED)
+        qmi_message_wda_set_data_format_input_set_endpoint_info (input, tune->endpoint_type, tune->endpoint_iface_number, NULL);
+
+    g_debug ("Asynchronously setting downlink aggregation: %u datagrams, %u bytes...",
+             tune->max_datagrams, tune->max_size);
+    qmi_client_wda_set_data_format (ctx->client,
+                                    input,
+                                    10,
+                                    ctx->cancellable,
+                                    (GAsyncReadyCallback)tune_set_data_format_ready,
+                                    NULL);
+}
+
+static void
+tune_probe_ready (QmiClientWda *client,
+                  GAsyncResult *res)
+{
+    TuneContext *tune = ctx->tune;
+    g_autoptr(QmiMessageWdaSetDataFormatOutput) output = NULL;
+    g_autoptr(GError) error = NULL;
+
+    output = qmi_client_wda_set_data_format_finish (client, res, &error);
+    if (!output) {
+        g_printerr ("error: operation failed: %s\n", error->message);
+        operation_shutdown (FALSE);
+        return;
+    }
+
+    if (!qmi_message_wda_set_data_format_output_get_result (output, &error)) {
+        g_printerr ("error: couldn't probe aggregation limits: %s\n", error->message);
+        operation_shutdown (FALSE);
+        return;
+    }
+
+    /* The values agreed when asking for more than supported are the limits */
+    if (!qmi_message_wda_set_data_format_output_get_downlink_data_aggregation_max_datagrams (output, &tune->max_datagrams_limit, NULL) ||
+        !qmi_message_wda_set_data_format_output_get_downlink_data_aggregation_max_size (output, &tune->max_size_limit, NULL) ||
+        !tune->max_datagrams_limit ||
+        !tune->max_size_limit) {
+        g_printerr ("error: modem didn't report downlink aggregation limits\n");
+        operation_shutdown (FALSE);
+        return;
+    }
+
+    g_print ("[%s] Downlink aggregation limits: %u datagrams, %u bytes\n",
+             qmi_device_get_path_display (ctx->device),
+             tune->max_datagrams_limit,
+             tune->max_size_limit);
+
+    tune_profile_apply (tune);
+    tune_set_data_format ();
+}
+
+static void
+tune_get_data_format_ready (QmiClientWda *client,
+                            GAsyncResult *res)
+{
+    TuneContext *tune = ctx->tune;
+    g_autoptr(QmiMessageWdaGetDataFormatOutput) output = NULL;
+    g_autoptr(QmiMessageWdaSetDataFormatInput) input = NULL;
+    g_autoptr(GError) error = NULL;
+    guint32 max_datagrams = 0;
+    guint32 max_size = 0;
+
+    output = qmi_client_wda_get_data_format_finish (client, res, &error);
+    if (!output) {
+        g_printerr ("error: operation failed: %s\n", error->message);
+        operation_shutdown (FALSE);
+        return;
+    }
+
+    if (!qmi_message_wda_get_data_format_output_get_result (output, &error)) {
+        g_printerr ("error: couldn't get data format: %s\n", error->message);
+        operation_shutdown (FALSE);
+        return;
+    }
+
+    if (!qmi_message_wda_get_data_format_output_get_link_layer_protocol (output, &tune->link_layer_protocol, NULL) ||
+        !qmi_message_wda_get_data_format_output_get_uplink_data_aggregation_protocol (output, &tune->ul_protocol, NULL) ||
+        !qmi_message_wda_get_data_format_output_get_downlink_data_aggregation_protocol (output, &tune->dl_protocol, NULL)) {
+        g_printerr ("error: modem didn't report the current data format\n");
+        operation_shutdown (FALSE);
+        return;
+    }
+
+    if (tune->dl_protocol != QMI_WDA_DATA_AGGREGATION_PROTOCOL_QMAP &&
+        tune->dl_protocol != QMI_WDA_DATA_AGGREGATION_PROTOCOL_QMAPV5) {
+        g_printerr ("error: downlink aggregation protocol is '%s', tuning requires QMAP\n",
+                    qmi_wda_data_aggregation_protocol_get_string (tune->dl_protocol));
+        operation_shutdown (FALSE);
+        return;
+    }
+
+    /* The currently agreed values may be below what the modem supports, e.g.
+     * after a previous latency tuning, so ask for at least the QMAP defaults
+     * and let the modem clamp them to its limits */
+    qmi_message_wda_get_data_format_output_get_downlink_data_aggregation_max_datagrams (output, &max_datagrams, NULL);
+    qmi_message_wda_get_data_format_output_get_downlink_data_aggregation_max_size (output, &max_size, NULL);
+    tune->max_datagrams = MAX (max_datagrams, QMI_WDA_DL_AGGREGATION_PROTOCOL_MAX_DATAGRAMS_QMAP_DEFAULT);
+    tune->max_size = MAX (max_size, QMI_WDA_DL_AGGREGATION_PROTOCOL_MAX_DATAGRAM_SIZE_QMAP_DEFAULT);
+
+    input = qmi_message_wda_set_data_format_input_new ();
+    qmi_message_wda_set_data_format_input_set_link_layer_protocol (input, tune->link_layer_protocol, NULL);
+    qmi_message_wda_set_data_format_input_set_uplink_data_aggregation_protocol (input, tune->ul_protocol, NULL);
+    qmi_message_wda_set_data_format_input_set_downlink_data_aggregation_protocol (input, tune->dl_protocol, NULL);
+    qmi_message_wda_set_data_format_input_set_downlink_data_aggregation_max_datagrams (input, tune->max_datagrams, NULL);
+    qmi_message_wda_set_data_format_input_set_downlink_data_aggregation_max_size (input, tune->max_size, NULL);
+    if (tune->endpoint_type != QMI_DATA_ENDPOINT_TYPE_UNDEFINED)
+        qmi_message_wda_set_data_format_input_set_endpoint_info (input, tune->endpoint_type, tune->endpoint_iface_number, NULL);
+
+    g_debug ("Asynchronously probing downlink aggregation limits...");
+    qmi_client_wda_set_data_format (ctx->client,
+                                    input,
+                                    10,
+                                    ctx->cancellable,
+                                    (GAsyncReadyCallback)tune_probe_ready,
+                                    NULL);
+}
+
+static TuneContext *
+tune_context_create (const gchar *str)
+{
+    TuneContext *tune;
+    g_autoptr(GError) error = NULL;
+
+    tune = g_slice_new0 (TuneContext);
+    tune->profile = TUNE_PROFILE_BALANCED;
+    tune->calibrate_interval = TUNE_CALIBRATE_INTERVAL_SECS_DEFAULT;
+    tune->endpoint_type = QMI_DATA_ENDPOINT_TYPE_UNDEFINED;
+    tune->endpoint_iface_number = QMI_WDA_ENDPOINT_INTERFACE_NUMBER_UNDEFINED;
+
+    /* Allow just the profile name as shortcut */
+    if (!strchr (str, '=')) {
+        g_autofree gchar *profile_str = NULL;
+
+        profile_str = g_strdup_printf ("profile=%s", str);
+        if (!qmicli_parse_key_value_string (profile_str,
+                                            &error,
+                                            tune_data_aggregation_properties_handle,
+                                            tune))
+            goto error_out;
+    } else if (!qmicli_parse_key_value_string (str,
+                                               &error,
+                                               tune_data_aggregation_properties_handle,
+                                               tune))
+        goto error_out;
+
+    if ((tune->endpoint_type == QMI_DATA_ENDPOINT_TYPE_UNDEFINED) ^
+        (tune->endpoint_iface_number == QMI_WDA_ENDPOINT_INTERFACE_NUMBER_UNDEFINED)) {
+        g_printerr ("error: endpoint type and interface number must be both set or both unset\n");
+        g_slice_free (TuneContext, tune);
+        return NULL;
+    }
+
+    return tune;
+
+error_out:
+    g_printerr ("error: could not parse input string '%s'\n", error->message);
+    g_slice_free (TuneContext, tune);
+    return NULL;
+}
+
+#endif /* HAVE_QMI_MESSAGE_WDA_GET_DATA_FORMAT && HAVE_QMI_MESSAGE_WDA_SET_DATA_FORMAT */
+
 #if defined HAVE_QMI_MESSAGE_WDA_GET_SUPPORTED_MESSAGES
 
 static void
@@ -691,6 +1277,7 @@ qmicli_wda_run (QmiDevice *device,
     ctx->device = g_object_ref (device);
     ctx->client = g_object_ref (client);
     ctx->cancellable = g_object_ref (cancellable);
+    ctx->tune = NULL;
 
 #if defined HAVE_QMI_MESSAGE_WDA_SET_DATA_FORMAT
     if (set_data_format_str) {
@@ -737,6 +1324,35 @@ qmicli_wda_run (QmiDevice *device,
     }
 #endif
 
+#if defined HAVE_QMI_MESSAGE_WDA_GET_DATA_FORMAT && defined HAVE_QMI_MESSAGE_WDA_SET_DATA_FORMAT
+    if (tune_data_aggregation_str) {
+        g_autoptr(QmiMessageWdaGetDataFormatInput) input = NULL;
+
+        ctx->tune = tune_context_create (tune_data_aggregation_str);
+        if (!ctx->tune) {
+            operation_shutdown (FALSE);
+            return;
+        }
+
+        if (ctx->tune->endpoint_type != QMI_DATA_ENDPOINT_TYPE_UNDEFINED) {
+            input = qmi_message_wda_get_data_format_input_new ();
+            qmi_message_wda_get_data_format_input_set_endpoint_info (input,
+                                                                     ctx->tune->endpoint_type,
+                                                                     ctx->tune->endpoint_iface_number,
+                                                                     NULL);
+        }
+
+        g_debug ("Asynchronously getting data format...");
+        qmi_client_wda_get_data_format (ctx->client,
+                                        input,
+                                        10,
+                                        ctx->cancellable,
+                                        (GAsyncReadyCallback)tune_get_data_format_ready,
+                                        NULL);
+        return;
+    }
+#endif
+
 #if defined HAVE_QMI_MESSAGE_WDA_GET_SUPPORTED_MESSAGES
     if (get_supported_messages_flag) {
         g_debug ("Asynchronously getting supported WDA messages...");
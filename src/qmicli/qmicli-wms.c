@@ -40,14 +40,29 @@ typedef struct {
     QmiDevice *device;
     QmiClientWms *client;
     GCancellable *cancellable;
+
+    /* Storage dump */
+    QmiWmsStorageType storage_type;
+    GArray *message_list;
+    guint next;
+    guint in_flight;
+    guint n_failed;
 } Context;
 static Context *ctx;
 
 /* Options */
 static gboolean get_supported_messages_flag;
 static gboolean reset_flag;
+static gchar *dump_storage_str;
 static gboolean noop_flag;
 
+/* Maximum number of Raw Read requests kept in flight while dumping */
+#define DUMP_STORAGE_MAX_IN_FLIGHT 4
+
+#if defined HAVE_QMI_MESSAGE_WMS_LIST_MESSAGES && defined HAVE_QMI_MESSAGE_WMS_RAW_READ
+# define HAVE_WMS_DUMP_STORAGE
+#endif
+
 static GOptionEntry entries[] = {
 #if defined HAVE_QMI_MESSAGE_WMS_GET_SUPPORTED_MESSAGES
     { "wms-get-supported-messages", 0, 0, G_OPTION_ARG_NONE, &get_supported_messages_flag,
@@ -60,6 +75,12 @@ static GOptionEntry entries[] = {
       "Reset the service state",
       NULL
     },
+#endif
+#if defined HAVE_WMS_DUMP_STORAGE
+    { "wms-dump-storage", 0, 0, G_OPTION_ARG_STRING, &dump_storage_str,
+      "List and read all messages in the given storage",
+      "[uim|nv]"
+    },
 #endif
     { "wms-noop", 0, 0, G_OPTION_ARG_NONE, &noop_flag,
       "Just allocate or release a WMS client. Use with `--client-no-release-cid' and/or `--client-cid'",
@@ -83,17 +104,26 @@ qmicli_wms_get_option_group (void)
     return group;
 }
 
+static guint n_actions;
+static gboolean checked;
+
+void
+qmicli_wms_options_reset (void)
+{
+    qmicli_reset_option_entries (entries);
+    n_actions = 0;
+    checked = FALSE;
+}
+
 gboolean
 qmicli_wms_options_enabled (void)
 {
-    static guint n_actions = 0;
-    static gboolean checked = FALSE;
-
     if (checked)
         return !!n_actions;
 
     n_actions = (get_supported_messages_flag +
                  reset_flag +
+                 !!dump_storage_str +
                  noop_flag);
 
     if (n_actions > 1) {
@@ -111,6 +141,8 @@ context_free (Context *context)
     if (!context)
         return;
 
+    if (context->message_list)
+        g_array_unref (context->message_list);
     if (context->client)
         g_object_unref (context->client);
     g_object_unref (context->cancellable);
@@ -202,6 +234,178 @@ reset_ready (QmiClientWms *client,
 
 #endif
 
+#if defined HAVE_WMS_DUMP_STORAGE
+
+static gboolean
+read_storage_type_from_string (const gchar       *str,
+                               QmiWmsStorageType *out)
+{
+    if (g_ascii_strcasecmp (str, "uim") == 0)
+        *out = QMI_WMS_STORAGE_TYPE_UIM;
+    else if (g_ascii_strcasecmp (str, "nv") == 0)
+        *out = QMI_WMS_STORAGE_TYPE_NV;
+    else {
+        g_printerr ("error: invalid storage type: '%s' (expected 'uim' or 'nv')\n", str);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static void dump_storage_schedule (void);
+
+static void
+raw_read_ready (QmiClientWms *client,
+                GAsyncResult *res,
+                gpointer      user_data)
+{
+    QmiMessageWmsRawReadOutput *output;
+    GError *error = NULL;
+    guint32 memory_index;
+    QmiWmsMessageTagType message_tag;
+    QmiWmsMessageFormat format;
+    GArray *raw_data = NULL;
+    GString *pdu;
+    guint i;
+
+    memory_index = GPOINTER_TO_UINT (user_data);
+    ctx->in_flight--;
+
+    output = qmi_client_wms_raw_read_finish (client, res, &error);
+    if (!output) {
+        g_printerr ("error: couldn't read message at index %u: %s\n", memory_index, error->message);
+        g_error_free (error);
+        ctx->n_failed++;
+        dump_storage_schedule ();
+        return;
+    }
+
+    if (!qmi_message_wms_raw_read_output_get_result (output, &error) ||
+        !qmi_message_wms_raw_read_output_get_raw_message_data (output, &message_tag, &format, &raw_data, &error)) {
+        g_printerr ("error: couldn't read message at index %u: %s\n", memory_index, error->message);
+        g_error_free (error);
+        qmi_message_wms_raw_read_output_unref (output);
+        ctx->n_failed++;
+        dump_storage_schedule ();
+        return;
+    }
+
+    /* Printed as soon as it arrives, so the order follows the replies */
+    pdu = g_string_sized_new (raw_data->len * 2 + 1);
+    for (i = 0; i < raw_data->len; i++)
+        g_string_append_printf (pdu, "%02x", g_array_index (raw_data, guint8, i));
+
+    g_print ("[%s] Message at index %u:\n"
+             "\tTag:    '%s'\n"
+             "\tFormat: '%s'\n"
+             "\tLength: %u\n"
+             "\tPDU:    %s\n",
+             qmi_device_get_path_display (ctx->device),
+             memory_index,
+             qmi_wms_message_tag_type_get_string (message_tag),
+             qmi_wms_message_format_get_string (format),
+             raw_data->len,
+             pdu->str);
+
+    g_string_free (pdu, TRUE);
+    qmi_message_wms_raw_read_output_unref (output);
+    dump_storage_schedule ();
+}
+
+static void
+dump_storage_schedule (void)
+{
+    /* Stop issuing new reads once cancelled, just wait for the pending ones */
+    while (ctx->in_flight < DUMP_STORAGE_MAX_IN_FLIGHT &&
+           ctx->next < ctx->message_list->len &&
+           !g_cancellable_is_cancelled (ctx->cancellable)) {
+        QmiMessageWmsListMessagesOutputMessageListElement *element;
+        QmiMessageWmsRawReadInput *input;
+
+        element = &g_array_index (ctx->message_list,
+                                  QmiMessageWmsListMessagesOutputMessageListElement,
+                                  ctx->next++);
+
+        input = qmi_message_wms_raw_read_input_new ();
+        qmi_message_wms_raw_read_input_set_message_memory_storage_id (input,
+                                                                      ctx->storage_type,
+                                                                      element->memory_index,
+                                                                      NULL);
+        ctx->in_flight++;
+        qmi_client_wms_raw_read (ctx->client,
+                                 input,
+                                 10,
+                                 ctx->cancellable,
+                                 (GAsyncReadyCallback)raw_read_ready,
+                                 GUINT_TO_POINTER (element->memory_index));
+        qmi_message_wms_raw_read_input_unref (input);
+    }
+
+    if (ctx->in_flight > 0)
+        return;
+
+    if (ctx->n_failed || ctx->next < ctx->message_list->len) {
+        g_printerr ("error: couldn't read %u of %u messages\n",
+                    ctx->n_failed + (ctx->message_list->len - ctx->next),
+                    ctx->message_list->len);
+        operation_shutdown (FALSE);
+        return;
+    }
+
+    g_print ("[%s] Successfully read %u messages from the '%s' storage\n",
+             qmi_device_get_path_display (ctx->device),
+             ctx->message_list->len,
+             qmi_wms_storage_type_get_string (ctx->storage_type));
+    operation_shutdown (TRUE);
+}
+
+static void
+list_messages_ready (QmiClientWms *client,
+                     GAsyncResult *res)
+{
+    QmiMessageWmsListMessagesOutput *output;
+    GError *error = NULL;
+    GArray *message_list = NULL;
+
+    output = qmi_client_wms_list_messages_finish (client, res, &error);
+    if (!output) {
+        g_printerr ("error: operation failed: %s\n", error->message);
+        g_error_free (error);
+        operation_shutdown (FALSE);
+        return;
+    }
+
+    if (!qmi_message_wms_list_messages_output_get_result (output, &error)) {
+        g_printerr ("error: couldn't list messages: %s\n", error->message);
+        g_error_free (error);
+        qmi_message_wms_list_messages_output_unref (output);
+        operation_shutdown (FALSE);
+        return;
+    }
+
+    qmi_message_wms_list_messages_output_get_message_list (output, &message_list, NULL);
+    if (!message_list || !message_list->len) {
+        g_print ("[%s] No messages in the '%s' storage\n",
+                 qmi_device_get_path_display (ctx->device),
+                 qmi_wms_storage_type_get_string (ctx->storage_type));
+        qmi_message_wms_list_messages_output_unref (output);
+        operation_shutdown (TRUE);
+        return;
+    }
+
+    g_print ("[%s] Found %u messages in the '%s' storage\n",
+             qmi_device_get_path_display (ctx->device),
+             message_list->len,
+             qmi_wms_storage_type_get_string (ctx->storage_type));
+
+    /* The list is owned by the output, keep our own reference */
+    ctx->message_list = g_array_ref (message_list);
+    qmi_message_wms_list_messages_output_unref (output);
+
+    dump_storage_schedule ();
+}
+
+#endif /* HAVE_WMS_DUMP_STORAGE */
+
 static gboolean
 noop_cb (gpointer unused)
 {
@@ -215,7 +419,7 @@ qmicli_wms_run (QmiDevice *device,
                 GCancellable *cancellable)
 {
     /* Initialize context */
-    ctx = g_slice_new (Context);
+    ctx = g_slice_new0 (Context);
     ctx->device = g_object_ref (device);
     ctx->client = g_object_ref (client);
     ctx->cancellable = g_object_ref (cancellable);
@@ -246,6 +450,30 @@ qmicli_wms_run (QmiDevice *device,
     }
 #endif
 
+#if defined HAVE_WMS_DUMP_STORAGE
+    if (dump_storage_str) {
+        QmiMessageWmsListMessagesInput *input;
+
+        if (!read_storage_type_from_string (dump_storage_str, &ctx->storage_type)) {
+            operation_shutdown (FALSE);
+            return;
+        }
+
+        input = qmi_message_wms_list_messages_input_new ();
+        qmi_message_wms_list_messages_input_set_storage_type (input, ctx->storage_type, NULL);
+
+        g_debug ("Asynchronously listing WMS messages...");
+        qmi_client_wms_list_messages (ctx->client,
+                                      input,
+                                      10,
+                                      ctx->cancellable,
+                                      (GAsyncReadyCallback)list_messages_ready,
+                                      NULL);
+        qmi_message_wms_list_messages_input_unref (input);
+        return;
+    }
+#endif
+
     /* Just client allocate/release? */
     if (noop_flag) {
         g_idle_add (noop_cb, NULL);
@@ -24,11 +24,14 @@
 #include <stdlib.h>
 #include <locale.h>
 #include <string.h>
+#include <unistd.h>
+#include <glob.h>
 
 #include <glib.h>
 #include <glib/gprintf.h>
 #include <gio/gio.h>
 #include <glib-unix.h>
+#include <gio/gunixinputstream.h>
 
 #include <libqmi-glib.h>
 
@@ -51,15 +54,34 @@ static QmiService service;
 static gboolean operation_status;
 static gboolean expect_indications;
 
+/* Batch mode */
+static GDataInputStream *batch_input;
+static GHashTable *batch_clients;
+static guint batch_line;
+static GString *batch_out;
+static GString *batch_err;
+static GPrintFunc batch_old_print_func;
+static GPrintFunc batch_old_printerr_func;
+
+/* Multiple devices */
+static GPtrArray *device_paths;
+static guint fanout_pending;
+
 /* Main options */
 static gchar *device_str;
 static gboolean get_service_version_info_flag;
 static gboolean get_wwan_iface_flag;
 static gboolean get_expected_data_format_flag;
 static gchar *set_expected_data_format_str;
+static gboolean link_list_flag;
+static gchar *link_add_str;
+static gchar *link_delete_str;
+static gboolean link_delete_all_flag;
 static gchar *device_set_instance_id_str;
 static gboolean device_open_version_info_flag;
 static gboolean device_open_sync_flag;
+static gboolean device_open_version_info_cache_flag;
+static gboolean device_open_concurrent_ctl_flag;
 static gchar *device_open_net_str;
 static gboolean device_open_proxy_flag;
 static gboolean device_open_qmi_flag;
@@ -67,13 +89,47 @@ static gboolean device_open_mbim_flag;
 static gboolean device_open_auto_flag;
 static gchar *client_cid_str;
 static gboolean client_no_release_cid_flag;
+static gchar *batch_str;
 static gboolean verbose_flag;
 static gboolean silent_flag;
 static gboolean version_flag;
 
+static gboolean
+parse_device (const gchar  *option_name,
+              const gchar  *value,
+              gpointer      data,
+              GError      **error)
+{
+    glob_t globbuf;
+    guint  i;
+
+    if (!device_paths)
+        device_paths = g_ptr_array_new_with_free_func (g_free);
+
+    /* Plain paths are taken as given, even if they don't exist yet */
+    if (!strpbrk (value, "*?[")) {
+        g_ptr_array_add (device_paths, g_strdup (value));
+        return TRUE;
+    }
+
+    if (glob (value, 0, NULL, &globbuf) != 0) {
+        g_set_error (error,
+                     G_OPTION_ERROR,
+                     G_OPTION_ERROR_BAD_VALUE,
+                     "no device matches '%s'",
+                     value);
+        return FALSE;
+    }
+
+    for (i = 0; i < globbuf.gl_pathc; i++)
+        g_ptr_array_add (device_paths, g_strdup (globbuf.gl_pathv[i]));
+    globfree (&globbuf);
+    return TRUE;
+}
+
 static GOptionEntry main_entries[] = {
-    { "device", 'd', 0, G_OPTION_ARG_STRING, &device_str,
-      "Specify device path",
+    { "device", 'd', 0, G_OPTION_ARG_CALLBACK, parse_device,
+      "Specify device path; may be given multiple times, or as a glob, to run the same action on several devices in parallel",
       "[PATH]"
     },
     { "get-wwan-iface", 'w', 0, G_OPTION_ARG_NONE, &get_wwan_iface_flag,
@@ -88,6 +144,22 @@ static GOptionEntry main_entries[] = {
       "(qmi_wwan specific) Set the expected data format in the WWAN iface",
       "[802-3|raw-ip]"
     },
+    { "link-list", 0, 0, G_OPTION_ARG_NONE, &link_list_flag,
+      "(qmi_wwan specific) List the links multiplexed over the WWAN iface",
+      NULL
+    },
+    { "link-add", 0, 0, G_OPTION_ARG_STRING, &link_add_str,
+      "(qmi_wwan specific) Add a link multiplexed over the WWAN iface, with the given QMAP mux ID",
+      "[(Mux ID)|auto]"
+    },
+    { "link-delete", 0, 0, G_OPTION_ARG_STRING, &link_delete_str,
+      "(qmi_wwan specific) Delete a link multiplexed over the WWAN iface",
+      "[IFACE]"
+    },
+    { "link-delete-all", 0, 0, G_OPTION_ARG_NONE, &link_delete_all_flag,
+      "(qmi_wwan specific) Delete all links multiplexed over the WWAN iface",
+      NULL
+    },
     { "get-service-version-info", 0, 0, G_OPTION_ARG_NONE, &get_service_version_info_flag,
       "Get service version info",
       NULL
@@ -100,10 +172,18 @@ static GOptionEntry main_entries[] = {
       "Run version info check when opening device",
       NULL
     },
+    { "device-open-version-info-cache", 0, 0, G_OPTION_ARG_NONE, &device_open_version_info_cache_flag,
+      "Run version info check when opening device, unless cached for the device",
+      NULL
+    },
     { "device-open-sync", 0, 0, G_OPTION_ARG_NONE, &device_open_sync_flag,
       "Run sync operation when opening device",
       NULL
     },
+    { "device-open-concurrent-ctl", 0, 0, G_OPTION_ARG_NONE, &device_open_concurrent_ctl_flag,
+      "Run the CTL operations when opening device concurrently, also allocating the client ID",
+      NULL
+    },
     { "device-open-proxy", 'p', 0, G_OPTION_ARG_NONE, &device_open_proxy_flag,
       "Request to use the 'qmi-proxy' proxy",
       NULL
@@ -128,6 +208,10 @@ static GOptionEntry main_entries[] = {
       "Use the given CID, don't allocate a new one",
       "[CID]"
     },
+    { "batch", 0, 0, G_OPTION_ARG_FILENAME, &batch_str,
+      "Run the actions given one per line in a file (or stdin if '-') over the same device and clients",
+      "[PATH|-]"
+    },
     { "client-no-release-cid", 0, 0, G_OPTION_ARG_NONE, &client_no_release_cid_flag,
       "Do not release the CID when exiting",
       NULL
@@ -253,7 +337,11 @@ generic_options_enabled (void)
                  get_service_version_info_flag +
                  get_wwan_iface_flag +
                  get_expected_data_format_flag +
-                 !!set_expected_data_format_str);
+                 !!set_expected_data_format_str +
+                 link_list_flag +
+                 !!link_add_str +
+                 !!link_delete_str +
+                 link_delete_all_flag);
 
     if (n_actions > 1) {
         g_printerr ("error: too many generic actions requested\n");
@@ -276,6 +364,10 @@ qmicli_expect_indications (void)
 /*****************************************************************************/
 /* Running asynchronously */
 
+static void batch_start       (QmiDevice *dev);
+static void batch_action_done (gboolean   reported_operation_status,
+                               gboolean   skip_cid_release);
+
 static void
 close_ready (QmiDevice    *dev,
              GAsyncResult *res)
@@ -312,6 +404,12 @@ qmicli_async_operation_done (gboolean reported_operation_status,
 {
     QmiDeviceReleaseClientFlags flags = QMI_DEVICE_RELEASE_CLIENT_FLAGS_NONE;
 
+    /* In batch mode, go on with the next action */
+    if (batch_input) {
+        batch_action_done (reported_operation_status, skip_cid_release);
+        return;
+    }
+
     /* Keep the result of the operation */
     operation_status = reported_operation_status;
 
@@ -346,122 +444,113 @@ qmicli_async_operation_done (gboolean reported_operation_status,
 }
 
 static void
-allocate_client_ready (QmiDevice *dev,
-                       GAsyncResult *res)
+service_run (QmiDevice *dev,
+             QmiService svc,
+             QmiClient *cli)
 {
-    GError *error = NULL;
-
-    client = qmi_device_allocate_client_finish (dev, res, &error);
-    if (!client) {
-        g_printerr ("error: couldn't create client for the '%s' service: %s\n",
-                    qmi_service_get_string (service),
-                    error->message);
-        exit (EXIT_FAILURE);
-    }
-
     /* Run the service-specific action */
-    switch (service) {
+    switch (svc) {
     case QMI_SERVICE_DMS:
 #if defined HAVE_QMI_SERVICE_DMS
-        qmicli_dms_run (dev, QMI_CLIENT_DMS (client), cancellable);
+        qmicli_dms_run (dev, QMI_CLIENT_DMS (cli), cancellable);
         return;
 #else
         break;
 #endif
     case QMI_SERVICE_NAS:
 #if defined HAVE_QMI_SERVICE_NAS
-        qmicli_nas_run (dev, QMI_CLIENT_NAS (client), cancellable);
+        qmicli_nas_run (dev, QMI_CLIENT_NAS (cli), cancellable);
         return;
 #else
         break;
 #endif
     case QMI_SERVICE_WDS:
 #if defined HAVE_QMI_SERVICE_WDS
-        qmicli_wds_run (dev, QMI_CLIENT_WDS (client), cancellable);
+        qmicli_wds_run (dev, QMI_CLIENT_WDS (cli), cancellable);
         return;
 #else
         break;
 #endif
     case QMI_SERVICE_PBM:
 #if defined HAVE_QMI_SERVICE_PBM
-        qmicli_pbm_run (dev, QMI_CLIENT_PBM (client), cancellable);
+        qmicli_pbm_run (dev, QMI_CLIENT_PBM (cli), cancellable);
         return;
 #else
         break;
 #endif
     case QMI_SERVICE_PDC:
 #if defined HAVE_QMI_SERVICE_PDC
-        qmicli_pdc_run (dev, QMI_CLIENT_PDC (client), cancellable);
+        qmicli_pdc_run (dev, QMI_CLIENT_PDC (cli), cancellable);
         return;
 #else
         break;
 #endif
     case QMI_SERVICE_UIM:
 #if defined HAVE_QMI_SERVICE_UIM
-        qmicli_uim_run (dev, QMI_CLIENT_UIM (client), cancellable);
+        qmicli_uim_run (dev, QMI_CLIENT_UIM (cli), cancellable);
         return;
 #else
         break;
 #endif
     case QMI_SERVICE_WMS:
 #if defined HAVE_QMI_SERVICE_WMS
-        qmicli_wms_run (dev, QMI_CLIENT_WMS (client), cancellable);
+        qmicli_wms_run (dev, QMI_CLIENT_WMS (cli), cancellable);
         return;
 #else
         break;
 #endif
     case QMI_SERVICE_WDA:
 #if defined HAVE_QMI_SERVICE_WDA
-        qmicli_wda_run (dev, QMI_CLIENT_WDA (client), cancellable);
+        qmicli_wda_run (dev, QMI_CLIENT_WDA (cli), cancellable);
         return;
 #else
         break;
 #endif
     case QMI_SERVICE_VOICE:
 #if defined HAVE_QMI_SERVICE_VOICE
-        qmicli_voice_run (dev, QMI_CLIENT_VOICE (client), cancellable);
+        qmicli_voice_run (dev, QMI_CLIENT_VOICE (cli), cancellable);
         return;
 #else
         break;
 #endif
     case QMI_SERVICE_LOC:
 #if defined HAVE_QMI_SERVICE_LOC
-        qmicli_loc_run (dev, QMI_CLIENT_LOC (client), cancellable);
+        qmicli_loc_run (dev, QMI_CLIENT_LOC (cli), cancellable);
         return;
 #else
         break;
 #endif
     case QMI_SERVICE_QOS:
 #if defined HAVE_QMI_SERVICE_QOS
-        qmicli_qos_run (dev, QMI_CLIENT_QOS (client), cancellable);
+        qmicli_qos_run (dev, QMI_CLIENT_QOS (cli), cancellable);
         return;
 #else
         break;
 #endif
     case QMI_SERVICE_GAS:
 #if defined HAVE_QMI_SERVICE_GAS
-        qmicli_gas_run (dev, QMI_CLIENT_GAS (client), cancellable);
+        qmicli_gas_run (dev, QMI_CLIENT_GAS (cli), cancellable);
         return;
 #else
         break;
 #endif
     case QMI_SERVICE_GMS:
 #if defined HAVE_QMI_SERVICE_GMS
-        qmicli_gms_run (dev, QMI_CLIENT_GMS (client), cancellable);
+        qmicli_gms_run (dev, QMI_CLIENT_GMS (cli), cancellable);
         return;
 #else
         break;
 #endif
     case QMI_SERVICE_DSD:
 #if defined HAVE_QMI_SERVICE_DSD
-        qmicli_dsd_run (dev, QMI_CLIENT_DSD (client), cancellable);
+        qmicli_dsd_run (dev, QMI_CLIENT_DSD (cli), cancellable);
         return;
 #else
         break;
 #endif
     case QMI_SERVICE_SAR:
 #if defined HAVE_QMI_SERVICE_SAR
-        qmicli_sar_run (dev, QMI_CLIENT_SAR (client), cancellable);
+        qmicli_sar_run (dev, QMI_CLIENT_SAR (cli), cancellable);
         return;
 #else
         break;
@@ -506,6 +595,23 @@ allocate_client_ready (QmiDevice *dev,
     g_assert_not_reached ();
 }
 
+static void
+allocate_client_ready (QmiDevice *dev,
+                       GAsyncResult *res)
+{
+    GError *error = NULL;
+
+    client = qmi_device_allocate_client_finish (dev, res, &error);
+    if (!client) {
+        g_printerr ("error: couldn't create client for the '%s' service: %s\n",
+                    qmi_service_get_string (service),
+                    error->message);
+        exit (EXIT_FAILURE);
+    }
+
+    service_run (dev, service, client);
+}
+
 static void
 device_allocate_client (QmiDevice *dev)
 {
@@ -696,6 +802,127 @@ device_get_expected_data_format (QmiDevice *dev)
     g_idle_add ((GSourceFunc) device_get_expected_data_format_cb, g_object_ref (dev));
 }
 
+static gboolean
+device_link_list_cb (QmiDevice *dev)
+{
+    GPtrArray *links = NULL;
+    GError *error = NULL;
+    guint i;
+
+    if (!qmi_device_list_links (dev, &links, &error)) {
+        g_printerr ("error: cannot list links: %s\n", error->message);
+        g_error_free (error);
+    } else {
+        g_print ("[%s] found %u links%s\n",
+                 qmi_device_get_path_display (dev),
+                 links->len,
+                 links->len ? ":" : "");
+        for (i = 0; i < links->len; i++) {
+            const gchar *ifname;
+            guint mux_id;
+
+            ifname = (const gchar *) g_ptr_array_index (links, i);
+            if (qmi_device_get_link_mux_id (dev, ifname, &mux_id, NULL))
+                g_print ("  [%u] %s (mux ID: %u)\n", i, ifname, mux_id);
+            else
+                g_print ("  [%u] %s (mux ID: unknown)\n", i, ifname);
+        }
+        g_ptr_array_unref (links);
+    }
+
+    /* We're done now */
+    qmicli_async_operation_done (!error, FALSE);
+
+    g_object_unref (dev);
+    return FALSE;
+}
+
+static void
+device_link_list (QmiDevice *dev)
+{
+    g_debug ("Listing links over the WWAN iface of this control port...");
+    g_idle_add ((GSourceFunc) device_link_list_cb, g_object_ref (dev));
+}
+
+static gboolean
+device_link_add_cb (QmiDevice *dev)
+{
+    GError *error = NULL;
+    gchar *ifname = NULL;
+    guint mux_id = QMI_DEVICE_MUX_ID_AUTOMATIC;
+
+    if (g_ascii_strcasecmp (link_add_str, "auto") != 0 &&
+        (!qmicli_read_uint_from_string (link_add_str, &mux_id) ||
+         mux_id < QMI_DEVICE_MUX_ID_MIN ||
+         mux_id > QMI_DEVICE_MUX_ID_MAX)) {
+        g_printerr ("error: invalid mux ID given: '%s' (must be in range [%u,%u] or 'auto')\n",
+                    link_add_str, QMI_DEVICE_MUX_ID_MIN, QMI_DEVICE_MUX_ID_MAX);
+        qmicli_async_operation_done (FALSE, FALSE);
+        g_object_unref (dev);
+        return FALSE;
+    }
+
+    ifname = qmi_device_add_link (dev, mux_id, &mux_id, &error);
+    if (!ifname) {
+        g_printerr ("error: cannot add link: %s\n", error->message);
+        g_error_free (error);
+    } else {
+        g_print ("[%s] link successfully added:\n"
+                 "  iface name: %s\n"
+                 "  mux ID:     %u\n",
+                 qmi_device_get_path_display (dev),
+                 ifname,
+                 mux_id);
+        g_free (ifname);
+    }
+
+    /* We're done now */
+    qmicli_async_operation_done (!error, FALSE);
+
+    g_object_unref (dev);
+    return FALSE;
+}
+
+static void
+device_link_add (QmiDevice *dev)
+{
+    g_debug ("Adding link over the WWAN iface of this control port...");
+    g_idle_add ((GSourceFunc) device_link_add_cb, g_object_ref (dev));
+}
+
+static gboolean
+device_link_delete_cb (QmiDevice *dev)
+{
+    GError *error = NULL;
+    gboolean success;
+
+    if (link_delete_all_flag)
+        success = qmi_device_delete_all_links (dev, &error);
+    else
+        success = qmi_device_delete_link (dev, link_delete_str, &error);
+
+    if (!success) {
+        g_printerr ("error: cannot delete links: %s\n", error->message);
+        g_error_free (error);
+    } else
+        g_print ("[%s] link%s successfully deleted\n",
+                 qmi_device_get_path_display (dev),
+                 link_delete_all_flag ? "s" : "");
+
+    /* We're done now */
+    qmicli_async_operation_done (success, FALSE);
+
+    g_object_unref (dev);
+    return FALSE;
+}
+
+static void
+device_link_delete (QmiDevice *dev)
+{
+    g_debug ("Deleting links over the WWAN iface of this control port...");
+    g_idle_add ((GSourceFunc) device_link_delete_cb, g_object_ref (dev));
+}
+
 static gboolean
 device_get_wwan_iface_cb (QmiDevice *dev)
 {
@@ -736,7 +963,9 @@ device_open_ready (QmiDevice *dev,
     g_debug ("QMI Device at '%s' ready",
              qmi_device_get_path_display (dev));
 
-    if (device_set_instance_id_str)
+    if (batch_str)
+        batch_start (dev);
+    else if (device_set_instance_id_str)
         device_set_instance_id (dev);
     else if (get_service_version_info_flag)
         device_get_service_version_info (dev);
@@ -746,6 +975,12 @@ device_open_ready (QmiDevice *dev,
         device_get_expected_data_format (dev);
     else if (set_expected_data_format_str)
         device_set_expected_data_format (dev);
+    else if (link_list_flag)
+        device_link_list (dev);
+    else if (link_add_str)
+        device_link_add (dev);
+    else if (link_delete_str || link_delete_all_flag)
+        device_link_delete (dev);
     else
         device_allocate_client (dev);
 }
@@ -772,15 +1007,24 @@ device_new_ready (GObject *unused,
     /* Setup device open flags */
     if (device_open_version_info_flag)
         open_flags |= QMI_DEVICE_OPEN_FLAGS_VERSION_INFO;
+    if (device_open_version_info_cache_flag)
+        open_flags |= (QMI_DEVICE_OPEN_FLAGS_VERSION_INFO | QMI_DEVICE_OPEN_FLAGS_VERSION_INFO_CACHE);
     if (device_open_sync_flag)
         open_flags |= QMI_DEVICE_OPEN_FLAGS_SYNC;
+    if (device_open_concurrent_ctl_flag) {
+        open_flags |= QMI_DEVICE_OPEN_FLAGS_CONCURRENT_CTL;
+        /* The client for the requested service is created right after
+         * opening, so get its CID along with the rest of the open sequence */
+        if (!batch_str && !client_cid_str && service != QMI_SERVICE_CTL)
+            qmi_device_set_preallocated_services (device, &service, 1);
+    }
     if (device_open_proxy_flag)
         open_flags |= QMI_DEVICE_OPEN_FLAGS_PROXY;
     if (device_open_mbim_flag)
         open_flags |= QMI_DEVICE_OPEN_FLAGS_MBIM;
     if (device_open_auto_flag || (!device_open_qmi_flag && !device_open_mbim_flag))
         open_flags |= QMI_DEVICE_OPEN_FLAGS_AUTO;
-    if (expect_indications)
+    if (expect_indications || batch_str)
         open_flags |= QMI_DEVICE_OPEN_FLAGS_EXPECT_INDICATIONS;
     if (device_open_net_str) {
         if (!qmicli_read_device_open_flags_from_string (device_open_net_str, &open_flags) ||
@@ -830,6 +1074,16 @@ qrtr_node_ready (GObject *unused,
         exit (EXIT_FAILURE);
     }
 
+    /* The services used in batch mode are unknown in advance */
+    if (batch_str) {
+        qmi_device_new_from_node (node,
+                                  cancellable,
+                                  (GAsyncReadyCallback)device_new_ready,
+                                  NULL);
+        g_object_unref (node);
+        return;
+    }
+
     services = g_array_sized_new (FALSE, FALSE, sizeof (QmiService), 1);
     g_array_append_val (services, service);
 
@@ -886,121 +1140,169 @@ make_device (GFile *file)
 
 /*****************************************************************************/
 
-static void
-parse_actions (void)
-{
-    guint actions_enabled = 0;
-
-    /* Generic options? */
-    if (generic_options_enabled ()) {
-        service = QMI_SERVICE_CTL;
-        actions_enabled++;
-    }
-
+/* All the options of a service are named --<name>-..., so the option group
+ * of a service only needs to be set up when the command line asks for it */
+typedef struct {
+    const gchar  *name;
+    QmiService    service;
+    GOptionGroup *(* get_option_group) (void);
+    gboolean      (* options_enabled)  (void);
+    void          (* options_reset)    (void);
+} ServiceOptions;
+
+static const ServiceOptions service_options[] = {
 #if defined HAVE_QMI_SERVICE_DMS
-    if (qmicli_dms_options_enabled ()) {
-        service = QMI_SERVICE_DMS;
-        actions_enabled++;
-    }
+    { "dms",    QMI_SERVICE_DMS, qmicli_dms_get_option_group, qmicli_dms_options_enabled, qmicli_dms_options_reset },
 #endif
-
 #if defined HAVE_QMI_SERVICE_NAS
-    if (qmicli_nas_options_enabled ()) {
-        service = QMI_SERVICE_NAS;
-        actions_enabled++;
-    }
+    { "nas",    QMI_SERVICE_NAS, qmicli_nas_get_option_group, qmicli_nas_options_enabled, qmicli_nas_options_reset },
 #endif
-
 #if defined HAVE_QMI_SERVICE_WDS
-    if (qmicli_wds_options_enabled ()) {
-        service = QMI_SERVICE_WDS;
-        actions_enabled++;
-    }
+    { "wds",    QMI_SERVICE_WDS, qmicli_wds_get_option_group, qmicli_wds_options_enabled, qmicli_wds_options_reset },
 #endif
-
 #if defined HAVE_QMI_SERVICE_PBM
-    if (qmicli_pbm_options_enabled ()) {
-        service = QMI_SERVICE_PBM;
-        actions_enabled++;
-    }
+    { "pbm",    QMI_SERVICE_PBM, qmicli_pbm_get_option_group, qmicli_pbm_options_enabled, qmicli_pbm_options_reset },
 #endif
-
 #if defined HAVE_QMI_SERVICE_PDC
-    if (qmicli_pdc_options_enabled ()) {
-        service = QMI_SERVICE_PDC;
-        actions_enabled++;
-    }
+    { "pdc",    QMI_SERVICE_PDC, qmicli_pdc_get_option_group, qmicli_pdc_options_enabled, qmicli_pdc_options_reset },
 #endif
-
 #if defined HAVE_QMI_SERVICE_UIM
-    if (qmicli_uim_options_enabled ()) {
-        service = QMI_SERVICE_UIM;
-        actions_enabled++;
-    }
+    { "uim",    QMI_SERVICE_UIM, qmicli_uim_get_option_group, qmicli_uim_options_enabled, qmicli_uim_options_reset },
 #endif
-
 #if defined HAVE_QMI_SERVICE_SAR
-    if (qmicli_sar_options_enabled ()) {
-        service = QMI_SERVICE_SAR;
-        actions_enabled++;
-    }
+    { "sar",    QMI_SERVICE_SAR, qmicli_sar_get_option_group, qmicli_sar_options_enabled, qmicli_sar_options_reset },
 #endif
-
 #if defined HAVE_QMI_SERVICE_WMS
-    if (qmicli_wms_options_enabled ()) {
-        service = QMI_SERVICE_WMS;
-        actions_enabled++;
-    }
+    { "wms",    QMI_SERVICE_WMS, qmicli_wms_get_option_group, qmicli_wms_options_enabled, qmicli_wms_options_reset },
 #endif
-
 #if defined HAVE_QMI_SERVICE_WDA
-    if (qmicli_wda_options_enabled ()) {
-        service = QMI_SERVICE_WDA;
-        actions_enabled++;
-    }
+    { "wda",    QMI_SERVICE_WDA, qmicli_wda_get_option_group, qmicli_wda_options_enabled, qmicli_wda_options_reset },
 #endif
-
 #if defined HAVE_QMI_SERVICE_VOICE
-    if (qmicli_voice_options_enabled ()) {
-        service = QMI_SERVICE_VOICE;
-        actions_enabled++;
-    }
+    { "voice",  QMI_SERVICE_VOICE, qmicli_voice_get_option_group, qmicli_voice_options_enabled, qmicli_voice_options_reset },
 #endif
-
 #if defined HAVE_QMI_SERVICE_LOC
-    if (qmicli_loc_options_enabled ()) {
-        service = QMI_SERVICE_LOC;
-        actions_enabled++;
-    }
+    { "loc",    QMI_SERVICE_LOC, qmicli_loc_get_option_group, qmicli_loc_options_enabled, qmicli_loc_options_reset },
 #endif
-
 #if defined HAVE_QMI_SERVICE_QOS
-    if (qmicli_qos_options_enabled ()) {
-        service = QMI_SERVICE_QOS;
-        actions_enabled++;
-    }
+    { "qos",    QMI_SERVICE_QOS, qmicli_qos_get_option_group, qmicli_qos_options_enabled, qmicli_qos_options_reset },
 #endif
-
 #if defined HAVE_QMI_SERVICE_GAS
-    if (qmicli_gas_options_enabled ()) {
-        service = QMI_SERVICE_GAS;
-        actions_enabled++;
-    }
+    { "gas",    QMI_SERVICE_GAS, qmicli_gas_get_option_group, qmicli_gas_options_enabled, qmicli_gas_options_reset },
 #endif
-
 #if defined HAVE_QMI_SERVICE_GMS
-    if (qmicli_gms_options_enabled ()) {
-        service = QMI_SERVICE_GMS;
-        actions_enabled++;
-    }
+    { "gms",    QMI_SERVICE_GMS, qmicli_gms_get_option_group, qmicli_gms_options_enabled, qmicli_gms_options_reset },
 #endif
-
 #if defined HAVE_QMI_SERVICE_DSD
-    if (qmicli_dsd_options_enabled ()) {
-        service = QMI_SERVICE_DSD;
+    { "dsd",    QMI_SERVICE_DSD, qmicli_dsd_get_option_group, qmicli_dsd_options_enabled, qmicli_dsd_options_reset },
+#endif
+    { NULL }
+};
+
+static const ServiceOptions *
+lookup_service_options (const gchar *name,
+                        gsize        name_len)
+{
+    guint i;
+
+    for (i = 0; service_options[i].name; i++) {
+        if (strlen (service_options[i].name) == name_len &&
+            strncmp (service_options[i].name, name, name_len) == 0)
+            return &service_options[i];
+    }
+    return NULL;
+}
+
+static void
+add_service_option_groups (GOptionContext  *context,
+                           gint             argc,
+                           gchar          **argv)
+{
+    gboolean needed[G_N_ELEMENTS (service_options)] = { FALSE };
+    gint     i;
+    guint    j;
+
+    for (i = 1; i < argc; i++) {
+        const ServiceOptions *svc;
+        const gchar          *name;
+
+        if (!g_str_has_prefix (argv[i], "-"))
+            continue;
+
+        /* Help for everything needs all groups */
+        if (g_str_equal (argv[i], "-h") ||
+            g_str_equal (argv[i], "-?") ||
+            g_str_equal (argv[i], "--help") ||
+            g_str_equal (argv[i], "--help-all")) {
+            for (j = 0; service_options[j].name; j++)
+                needed[j] = TRUE;
+            break;
+        }
+
+        /* "--<name>-..." and "--help-<name>" */
+        if (!g_str_has_prefix (argv[i], "--"))
+            continue;
+        name = argv[i] + 2;
+        if (g_str_has_prefix (name, "help-"))
+            svc = lookup_service_options (name + 5, strlen (name + 5));
+        else
+            svc = lookup_service_options (name, strcspn (name, "-="));
+        if (svc)
+            needed[svc - service_options] = TRUE;
+    }
+
+    for (j = 0; service_options[j].name; j++) {
+        if (needed[j])
+            g_option_context_add_group (context, service_options[j].get_option_group ());
+    }
+}
+
+static void
+reset_service_options (void)
+{
+    guint i;
+
+    for (i = 0; service_options[i].name; i++)
+        service_options[i].options_reset ();
+}
+
+static guint
+parse_service_actions (QmiService *out_service)
+{
+    guint actions_enabled = 0;
+    guint i;
+
+    for (i = 0; service_options[i].name; i++) {
+        if (service_options[i].options_enabled ()) {
+            *out_service = service_options[i].service;
+            actions_enabled++;
+        }
+    }
+
+    return actions_enabled;
+}
+
+static void
+parse_actions (void)
+{
+    guint actions_enabled;
+
+    actions_enabled = parse_service_actions (&service);
+
+    /* Generic options? */
+    if (generic_options_enabled ()) {
+        service = QMI_SERVICE_CTL;
         actions_enabled++;
     }
-#endif
+
+    /* Batch mode runs the actions given in the batch input only */
+    if (batch_str) {
+        if (actions_enabled > 0) {
+            g_printerr ("error: cannot execute actions along with a batch\n");
+            exit (EXIT_FAILURE);
+        }
+        return;
+    }
 
     /* Cannot mix actions from different services */
     if (actions_enabled > 1) {
@@ -1017,61 +1319,553 @@ parse_actions (void)
     /* Go on! */
 }
 
+/*****************************************************************************/
+/* Batch mode
+ *
+ * Each line of the batch input holds the options of one action, as they would
+ * be given in the command line. Actions run one after the other over the same
+ * QmiDevice, and the client allocated for each service is kept around until
+ * the end of the input, so that only the first action of each service pays
+ * for the CID allocation. Action output is reported as tab-separated records:
+ *
+ *   <line>\tout\t<text>
+ *   <line>\terr\t<text>
+ *   <line>\tend\t<success|failure>
+ */
+
+static void batch_read_next (void);
+
+static void
+batch_record (const gchar *type,
+              const gchar *text)
+{
+    fprintf (stdout, "%u\t%s\t%s\n", batch_line, type, text);
+}
+
+static void
+batch_buffer_flush (GString     *buffer,
+                    const gchar *type,
+                    gboolean     all)
+{
+    gchar *eol;
+
+    while ((eol = strchr (buffer->str, '\n')) != NULL) {
+        *eol = '\0';
+        batch_record (type, buffer->str);
+        g_string_erase (buffer, 0, eol - buffer->str + 1);
+    }
+
+    if (all && buffer->len > 0) {
+        batch_record (type, buffer->str);
+        g_string_truncate (buffer, 0);
+    }
+}
+
+static void
+batch_print (const gchar *str)
+{
+    g_string_append (batch_out, str);
+    batch_buffer_flush (batch_out, "out", FALSE);
+}
+
+static void
+batch_printerr (const gchar *str)
+{
+    g_string_append (batch_err, str);
+    batch_buffer_flush (batch_err, "err", FALSE);
+}
+
+static void
+batch_release_next_client (void);
+
+static void
+batch_release_client_ready (QmiDevice    *dev,
+                            GAsyncResult *res)
+{
+    GError *error = NULL;
+
+    if (!qmi_device_release_client_finish (dev, res, &error)) {
+        g_printerr ("error: couldn't release client: %s\n", error->message);
+        g_error_free (error);
+    } else
+        g_debug ("Client released");
+
+    batch_release_next_client ();
+}
+
+static void
+batch_release_next_client (void)
+{
+    QmiDeviceReleaseClientFlags  flags = QMI_DEVICE_RELEASE_CLIENT_FLAGS_NONE;
+    GHashTableIter               iter;
+    QmiClient                   *cli;
+
+    g_hash_table_iter_init (&iter, batch_clients);
+    if (!g_hash_table_iter_next (&iter, NULL, (gpointer *)&cli)) {
+        qmi_device_close_async (device, 10, NULL, (GAsyncReadyCallback) close_ready, NULL);
+        return;
+    }
+
+    if (!client_no_release_cid_flag)
+        flags |= QMI_DEVICE_RELEASE_CLIENT_FLAGS_RELEASE_CID;
+    else
+        g_print ("[%s] Client ID not released:\n"
+                 "\tService: '%s'\n"
+                 "\t    CID: '%u'\n",
+                 qmi_device_get_path_display (device),
+                 qmi_service_get_string (qmi_client_get_service (cli)),
+                 qmi_client_get_cid (cli));
+
+    g_object_ref (cli);
+    g_hash_table_iter_remove (&iter);
+    qmi_device_release_client (device,
+                               cli,
+                               flags,
+                               10,
+                               NULL,
+                               (GAsyncReadyCallback)batch_release_client_ready,
+                               NULL);
+    g_object_unref (cli);
+}
+
+static void
+batch_finish (void)
+{
+    batch_buffer_flush (batch_out, "out", TRUE);
+    batch_buffer_flush (batch_err, "err", TRUE);
+    fflush (stdout);
+    g_set_print_handler (batch_old_print_func);
+    g_set_printerr_handler (batch_old_printerr_func);
+    g_string_free (batch_out, TRUE);
+    g_string_free (batch_err, TRUE);
+
+    g_clear_object (&batch_input);
+    g_clear_object (&cancellable);
+
+    batch_release_next_client ();
+}
+
+static void
+batch_action_done (gboolean reported_operation_status,
+                   gboolean skip_cid_release)
+{
+    if (!reported_operation_status)
+        operation_status = FALSE;
+
+    batch_buffer_flush (batch_out, "out", TRUE);
+    batch_buffer_flush (batch_err, "err", TRUE);
+    batch_record ("end", reported_operation_status ? "success" : "failure");
+    fflush (stdout);
+
+    /* The client can't be reused, e.g. after a device reset */
+    if (skip_cid_release) {
+        QmiClient *cli;
+
+        cli = g_hash_table_lookup (batch_clients, GUINT_TO_POINTER (service));
+        if (cli) {
+            g_debug ("Skipped CID release");
+            qmi_device_release_client (device,
+                                       cli,
+                                       QMI_DEVICE_RELEASE_CLIENT_FLAGS_NONE,
+                                       10,
+                                       NULL,
+                                       NULL,
+                                       NULL);
+            g_hash_table_remove (batch_clients, GUINT_TO_POINTER (service));
+        }
+    }
+
+    if (g_cancellable_is_cancelled (cancellable)) {
+        batch_finish ();
+        return;
+    }
+
+    batch_read_next ();
+}
+
+static void
+batch_allocate_client_ready (QmiDevice    *dev,
+                             GAsyncResult *res)
+{
+    QmiClient *cli;
+    GError    *error = NULL;
+
+    cli = qmi_device_allocate_client_finish (dev, res, &error);
+    if (!cli) {
+        g_printerr ("error: couldn't create client for the '%s' service: %s\n",
+                    qmi_service_get_string (service),
+                    error->message);
+        g_error_free (error);
+        batch_action_done (FALSE, FALSE);
+        return;
+    }
+
+    g_hash_table_insert (batch_clients, GUINT_TO_POINTER (service), cli);
+    service_run (dev, service, cli);
+}
+
+static void
+batch_run_action (const gchar *line)
+{
+    GOptionContext  *context;
+    QmiClient       *cli;
+    GError          *error = NULL;
+    gchar           *command;
+    gchar          **argv = NULL;
+    gint             argc = 0;
+    guint            actions_enabled = 0;
+    gboolean         parsed;
+
+    reset_service_options ();
+
+    command = g_strdup_printf (PROGRAM_NAME " %s", line);
+    context = g_option_context_new (NULL);
+    g_option_context_set_help_enabled (context, FALSE);
+
+    parsed = g_shell_parse_argv (command, &argc, &argv, &error);
+    if (parsed) {
+        add_service_option_groups (context, argc, argv);
+        parsed = g_option_context_parse (context, &argc, &argv, &error);
+    }
+
+    if (parsed) {
+        if (argc > 1)
+            g_printerr ("error: unexpected argument '%s'\n", argv[1]);
+        else
+            actions_enabled = parse_service_actions (&service);
+    } else {
+        g_printerr ("error: %s\n", error->message);
+        g_error_free (error);
+    }
+
+    g_option_context_free (context);
+    g_strfreev (argv);
+    g_free (command);
+
+    if (actions_enabled != 1) {
+        if (argc == 1 && actions_enabled == 0)
+            g_printerr ("error: no actions specified\n");
+        else if (actions_enabled > 1)
+            g_printerr ("error: cannot execute multiple actions of different services\n");
+        batch_action_done (FALSE, FALSE);
+        return;
+    }
+
+    cli = g_hash_table_lookup (batch_clients, GUINT_TO_POINTER (service));
+    if (cli) {
+        service_run (device, service, cli);
+        return;
+    }
+
+    qmi_device_allocate_client (device,
+                                service,
+                                QMI_CID_NONE,
+                                10,
+                                cancellable,
+                                (GAsyncReadyCallback)batch_allocate_client_ready,
+                                NULL);
+}
+
+static void
+batch_read_line_ready (GDataInputStream *input,
+                       GAsyncResult     *res)
+{
+    GError *error = NULL;
+    gchar  *line;
+
+    line = g_data_input_stream_read_line_finish_utf8 (input, res, NULL, &error);
+    if (!line) {
+        if (error && !g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+            g_printerr ("error: couldn't read batch input: %s\n", error->message);
+            operation_status = FALSE;
+        }
+        g_clear_error (&error);
+        batch_finish ();
+        return;
+    }
+
+    batch_line++;
+    g_strstrip (line);
+    if (line[0] == '\0' || line[0] == '#')
+        batch_read_next ();
+    else
+        batch_run_action (line);
+    g_free (line);
+}
+
+static void
+batch_read_next (void)
+{
+    if (!cancellable)
+        cancellable = g_cancellable_new ();
+
+    g_data_input_stream_read_line_async (batch_input,
+                                         G_PRIORITY_DEFAULT,
+                                         cancellable,
+                                         (GAsyncReadyCallback)batch_read_line_ready,
+                                         NULL);
+}
+
+static void
+batch_start (QmiDevice *dev)
+{
+    GInputStream *input;
+
+    if (g_str_equal (batch_str, "-"))
+        input = g_unix_input_stream_new (STDIN_FILENO, FALSE);
+    else {
+        GFile  *batch_file;
+        GError *error = NULL;
+
+        batch_file = g_file_new_for_commandline_arg (batch_str);
+        input = G_INPUT_STREAM (g_file_read (batch_file, NULL, &error));
+        g_object_unref (batch_file);
+        if (!input) {
+            g_printerr ("error: couldn't open batch input: %s\n", error->message);
+            exit (EXIT_FAILURE);
+        }
+    }
+
+    batch_input = g_data_input_stream_new (input);
+    g_object_unref (input);
+
+    batch_clients = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, g_object_unref);
+    batch_out = g_string_new (NULL);
+    batch_err = g_string_new (NULL);
+    batch_old_print_func = g_set_print_handler (batch_print);
+    batch_old_printerr_func = g_set_printerr_handler (batch_printerr);
+
+    operation_status = TRUE;
+    batch_read_next ();
+}
+
+/*****************************************************************************/
+/* Multiple devices
+ *
+ * The service modules keep the state of the single action they run in
+ * globals, so each device is handled by its own qmicli instance, all of them
+ * launched at once and supervised from this main loop. Output lines are
+ * tagged with the device path they refer to.
+ */
+
+typedef struct {
+    gchar       *path;
+    GSubprocess *subprocess;
+    guint        pending;
+} FanoutChild;
+
+static void
+fanout_child_unref (FanoutChild *child)
+{
+    if (--child->pending > 0)
+        return;
+
+    g_object_unref (child->subprocess);
+    g_free (child->path);
+    g_slice_free (FanoutChild, child);
+
+    if (--fanout_pending == 0)
+        g_main_loop_quit (loop);
+}
+
+typedef struct {
+    FanoutChild      *child;
+    GDataInputStream *input;
+    gboolean          is_stderr;
+} FanoutStream;
+
+static void fanout_stream_read_next (FanoutStream *stream);
+
+static void
+fanout_stream_read_line_ready (GDataInputStream *input,
+                               GAsyncResult     *res,
+                               FanoutStream     *stream)
+{
+    gchar *line;
+
+    line = g_data_input_stream_read_line_finish_utf8 (input, res, NULL, NULL);
+    if (!line) {
+        fanout_child_unref (stream->child);
+        g_object_unref (stream->input);
+        g_slice_free (FanoutStream, stream);
+        return;
+    }
+
+    if (stream->is_stderr)
+        g_printerr ("[%s] %s\n", stream->child->path, line);
+    else
+        g_print ("[%s] %s\n", stream->child->path, line);
+    g_free (line);
+
+    fanout_stream_read_next (stream);
+}
+
+static void
+fanout_stream_read_next (FanoutStream *stream)
+{
+    /* Not cancellable; children are signalled instead, and their output
+     * should be read until the end */
+    g_data_input_stream_read_line_async (stream->input,
+                                         G_PRIORITY_DEFAULT,
+                                         NULL,
+                                         (GAsyncReadyCallback)fanout_stream_read_line_ready,
+                                         stream);
+}
+
+static void
+fanout_stream_start (FanoutChild  *child,
+                     GInputStream *input,
+                     gboolean      is_stderr)
+{
+    FanoutStream *stream;
+
+    stream = g_slice_new0 (FanoutStream);
+    stream->child = child;
+    stream->input = g_data_input_stream_new (input);
+    stream->is_stderr = is_stderr;
+    child->pending++;
+    fanout_stream_read_next (stream);
+}
+
+static void
+fanout_wait_ready (GSubprocess  *subprocess,
+                   GAsyncResult *res,
+                   FanoutChild  *child)
+{
+    GError *error = NULL;
+
+    if (!g_subprocess_wait_check_finish (subprocess, res, &error)) {
+        g_printerr ("[%s] error: %s\n", child->path, error->message);
+        g_error_free (error);
+        operation_status = FALSE;
+    }
+
+    fanout_child_unref (child);
+}
+
+static void
+fanout_cancelled (GCancellable *_cancellable,
+                  GPtrArray    *subprocesses)
+{
+    guint i;
+
+    for (i = 0; i < subprocesses->len; i++)
+        g_subprocess_send_signal (g_ptr_array_index (subprocesses, i), SIGTERM);
+}
+
+/* Same command line, with all the device options replaced by the given one */
+static gchar **
+fanout_build_argv (gchar       **orig_argv,
+                   const gchar  *path)
+{
+    GPtrArray *argv;
+    guint      i;
+
+    argv = g_ptr_array_new ();
+    for (i = 0; orig_argv[i]; i++) {
+        if (i > 0 && (g_str_equal (orig_argv[i], "-d") || g_str_equal (orig_argv[i], "--device"))) {
+            if (orig_argv[i + 1])
+                i++;
+            continue;
+        }
+        if (i > 0 && (g_str_has_prefix (orig_argv[i], "--device=") ||
+                      g_str_has_prefix (orig_argv[i], "-d")))
+            continue;
+        /* Stop at the end of options, nothing else is expected afterwards */
+        if (g_str_equal (orig_argv[i], "--"))
+            break;
+        g_ptr_array_add (argv, g_strdup (orig_argv[i]));
+    }
+    g_ptr_array_add (argv, g_strdup ("-d"));
+    g_ptr_array_add (argv, g_strdup (path));
+    g_ptr_array_add (argv, NULL);
+
+    return (gchar **) g_ptr_array_free (argv, FALSE);
+}
+
+static gboolean
+fanout_run (gchar **orig_argv)
+{
+    GSubprocessLauncher *launcher;
+    GPtrArray           *subprocesses;
+    gulong               cancelled_id;
+    guint                i;
+
+    if (batch_str && g_str_equal (batch_str, "-")) {
+        g_printerr ("error: cannot read batch actions from stdin with multiple devices\n");
+        return FALSE;
+    }
+
+    launcher = g_subprocess_launcher_new (G_SUBPROCESS_FLAGS_STDOUT_PIPE |
+                                          G_SUBPROCESS_FLAGS_STDERR_PIPE);
+    subprocesses = g_ptr_array_new_with_free_func (g_object_unref);
+    operation_status = TRUE;
+
+    for (i = 0; i < device_paths->len; i++) {
+        const gchar  *path;
+        gchar       **argv;
+        GSubprocess  *subprocess;
+        FanoutChild  *child;
+        GError       *error = NULL;
+
+        path = g_ptr_array_index (device_paths, i);
+        argv = fanout_build_argv (orig_argv, path);
+        subprocess = g_subprocess_launcher_spawnv (launcher, (const gchar * const *) argv, &error);
+        g_strfreev (argv);
+        if (!subprocess) {
+            g_printerr ("[%s] error: couldn't launch: %s\n", path, error->message);
+            g_error_free (error);
+            operation_status = FALSE;
+            continue;
+        }
+
+        child = g_slice_new0 (FanoutChild);
+        child->path = g_strdup (path);
+        child->subprocess = subprocess;
+        child->pending = 1;
+        fanout_pending++;
+        g_ptr_array_add (subprocesses, g_object_ref (subprocess));
+
+        fanout_stream_start (child, g_subprocess_get_stdout_pipe (subprocess), FALSE);
+        fanout_stream_start (child, g_subprocess_get_stderr_pipe (subprocess), TRUE);
+        g_subprocess_wait_check_async (subprocess,
+                                       NULL,
+                                       (GAsyncReadyCallback)fanout_wait_ready,
+                                       child);
+    }
+    g_object_unref (launcher);
+
+    if (fanout_pending > 0) {
+        cancelled_id = g_cancellable_connect (cancellable,
+                                              G_CALLBACK (fanout_cancelled),
+                                              subprocesses,
+                                              NULL);
+        g_main_loop_run (loop);
+        g_cancellable_disconnect (cancellable, cancelled_id);
+    }
+
+    g_ptr_array_unref (subprocesses);
+    return operation_status;
+}
+
+/*****************************************************************************/
+
 int main (int argc, char **argv)
 {
     GError *error = NULL;
     GFile *file;
     GOptionContext *context;
+    gchar **orig_argv;
 
     setlocale (LC_ALL, "");
 
+    /* Keep the original command line around, in case it needs to be
+     * replayed for multiple devices */
+    orig_argv = g_strdupv (argv);
+
     /* Setup option context, process it and destroy it */
     context = g_option_context_new ("- Control QMI devices");
-#if defined HAVE_QMI_SERVICE_DMS
-    g_option_context_add_group (context, qmicli_dms_get_option_group ());
-#endif
-#if defined HAVE_QMI_SERVICE_NAS
-    g_option_context_add_group (context, qmicli_nas_get_option_group ());
-#endif
-#if defined HAVE_QMI_SERVICE_WDS
-    g_option_context_add_group (context, qmicli_wds_get_option_group ());
-#endif
-#if defined HAVE_QMI_SERVICE_PBM
-    g_option_context_add_group (context, qmicli_pbm_get_option_group ());
-#endif
-#if defined HAVE_QMI_SERVICE_PDC
-    g_option_context_add_group (context, qmicli_pdc_get_option_group ());
-#endif
-#if defined HAVE_QMI_SERVICE_UIM
-    g_option_context_add_group (context, qmicli_uim_get_option_group ());
-#endif
-#if defined HAVE_QMI_SERVICE_SAR
-    g_option_context_add_group (context, qmicli_sar_get_option_group ());
-#endif
-#if defined HAVE_QMI_SERVICE_WMS
-    g_option_context_add_group (context, qmicli_wms_get_option_group ());
-#endif
-#if defined HAVE_QMI_SERVICE_WDA
-    g_option_context_add_group (context, qmicli_wda_get_option_group ());
-#endif
-#if defined HAVE_QMI_SERVICE_VOICE
-    g_option_context_add_group (context, qmicli_voice_get_option_group ());
-#endif
-#if defined HAVE_QMI_SERVICE_LOC
-    g_option_context_add_group (context, qmicli_loc_get_option_group ());
-#endif
-#if defined HAVE_QMI_SERVICE_QOS
-    g_option_context_add_group (context, qmicli_qos_get_option_group ());
-#endif
-#if defined HAVE_QMI_SERVICE_GAS
-    g_option_context_add_group (context, qmicli_gas_get_option_group ());
-#endif
-#if defined HAVE_QMI_SERVICE_GMS
-    g_option_context_add_group (context, qmicli_gms_get_option_group ());
-#endif
-#if defined HAVE_QMI_SERVICE_DSD
-    g_option_context_add_group (context, qmicli_dsd_get_option_group ());
-#endif
+    add_service_option_groups (context, argc, argv);
     g_option_context_add_main_entries (context, main_entries, NULL);
     if (!g_option_context_parse (context, &argc, &argv, &error)) {
         g_printerr ("error: %s\n",
@@ -1096,11 +1890,33 @@ int main (int argc, char **argv)
 #endif
 
     /* No device path given? */
-    if (!device_str) {
+    if (!device_paths || !device_paths->len) {
         g_printerr ("error: no device path specified\n");
         exit (EXIT_FAILURE);
     }
 
+    /* Multiple devices, run the same action on each of them in parallel */
+    if (device_paths->len > 1) {
+        gboolean success;
+
+        cancellable = g_cancellable_new ();
+        loop = g_main_loop_new (NULL, FALSE);
+        g_unix_signal_add (SIGINT,  (GSourceFunc) signals_handler, NULL);
+        g_unix_signal_add (SIGHUP,  (GSourceFunc) signals_handler, NULL);
+        g_unix_signal_add (SIGTERM, (GSourceFunc) signals_handler, NULL);
+
+        success = fanout_run (orig_argv);
+
+        g_object_unref (cancellable);
+        g_main_loop_unref (loop);
+        g_ptr_array_unref (device_paths);
+        g_strfreev (orig_argv);
+        return (success ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    device_str = g_ptr_array_index (device_paths, 0);
+    g_strfreev (orig_argv);
+
     /* Build new GFile from the commandline arg */
     file = g_file_new_for_commandline_arg (device_str);
 
@@ -1125,6 +1941,8 @@ int main (int argc, char **argv)
         g_object_unref (cancellable);
     if (client)
         g_object_unref (client);
+    if (batch_clients)
+        g_hash_table_unref (batch_clients);
     if (device)
         g_object_unref (device);
     g_main_loop_unref (loop);
@@ -32,6 +32,7 @@ void          qmicli_expect_indications   (void);
 #if defined HAVE_QMI_SERVICE_DMS
 GOptionGroup *qmicli_dms_get_option_group (void);
 gboolean      qmicli_dms_options_enabled  (void);
+void          qmicli_dms_options_reset    (void);
 void          qmicli_dms_run              (QmiDevice *device,
                                            QmiClientDms *client,
                                            GCancellable *cancellable);
@@ -40,6 +41,7 @@ void          qmicli_dms_run              (QmiDevice *device,
 #if defined HAVE_QMI_SERVICE_WDS
 GOptionGroup *qmicli_wds_get_option_group (void);
 gboolean      qmicli_wds_options_enabled  (void);
+void          qmicli_wds_options_reset    (void);
 void          qmicli_wds_run              (QmiDevice *device,
                                            QmiClientWds *client,
                                            GCancellable *cancellable);
@@ -48,6 +50,7 @@ void          qmicli_wds_run              (QmiDevice *device,
 #if defined HAVE_QMI_SERVICE_NAS
 GOptionGroup *qmicli_nas_get_option_group (void);
 gboolean      qmicli_nas_options_enabled  (void);
+void          qmicli_nas_options_reset    (void);
 void          qmicli_nas_run              (QmiDevice *device,
                                            QmiClientNas *client,
                                            GCancellable *cancellable);
@@ -56,6 +59,7 @@ void          qmicli_nas_run              (QmiDevice *device,
 #if defined HAVE_QMI_SERVICE_PBM
 GOptionGroup *qmicli_pbm_get_option_group (void);
 gboolean      qmicli_pbm_options_enabled  (void);
+void          qmicli_pbm_options_reset    (void);
 void          qmicli_pbm_run              (QmiDevice *device,
                                            QmiClientPbm *client,
                                            GCancellable *cancellable);
@@ -64,6 +68,7 @@ void          qmicli_pbm_run              (QmiDevice *device,
 #if defined HAVE_QMI_SERVICE_PDC
 GOptionGroup *qmicli_pdc_get_option_group (void);
 gboolean      qmicli_pdc_options_enabled  (void);
+void          qmicli_pdc_options_reset    (void);
 void          qmicli_pdc_run              (QmiDevice *device,
                                            QmiClientPdc *client,
                                            GCancellable *cancellable);
@@ -72,6 +77,7 @@ void          qmicli_pdc_run              (QmiDevice *device,
 #if defined HAVE_QMI_SERVICE_UIM
 GOptionGroup *qmicli_uim_get_option_group (void);
 gboolean      qmicli_uim_options_enabled  (void);
+void          qmicli_uim_options_reset    (void);
 void          qmicli_uim_run              (QmiDevice *device,
                                            QmiClientUim *client,
                                            GCancellable *cancellable);
@@ -80,6 +86,7 @@ void          qmicli_uim_run              (QmiDevice *device,
 #if defined HAVE_QMI_SERVICE_WMS
 GOptionGroup *qmicli_wms_get_option_group (void);
 gboolean      qmicli_wms_options_enabled  (void);
+void          qmicli_wms_options_reset    (void);
 void          qmicli_wms_run              (QmiDevice *device,
                                            QmiClientWms *client,
                                            GCancellable *cancellable);
@@ -88,6 +95,7 @@ void          qmicli_wms_run              (QmiDevice *device,
 #if defined HAVE_QMI_SERVICE_WDA
 GOptionGroup *qmicli_wda_get_option_group (void);
 gboolean      qmicli_wda_options_enabled  (void);
+void          qmicli_wda_options_reset    (void);
 void          qmicli_wda_run              (QmiDevice *device,
                                            QmiClientWda *client,
                                            GCancellable *cancellable);
@@ -96,6 +104,7 @@ void          qmicli_wda_run              (QmiDevice *device,
 #if defined HAVE_QMI_SERVICE_VOICE
 GOptionGroup *qmicli_voice_get_option_group (void);
 gboolean      qmicli_voice_options_enabled  (void);
+void          qmicli_voice_options_reset    (void);
 void          qmicli_voice_run              (QmiDevice *device,
                                              QmiClientVoice *client,
                                              GCancellable *cancellable);
@@ -104,6 +113,7 @@ void          qmicli_voice_run              (QmiDevice *device,
 #if defined HAVE_QMI_SERVICE_LOC
 GOptionGroup *qmicli_loc_get_option_group (void);
 gboolean      qmicli_loc_options_enabled  (void);
+void          qmicli_loc_options_reset    (void);
 void          qmicli_loc_run              (QmiDevice *device,
                                            QmiClientLoc *client,
                                            GCancellable *cancellable);
@@ -112,6 +122,7 @@ void          qmicli_loc_run              (QmiDevice *device,
 #if defined HAVE_QMI_SERVICE_QOS
 GOptionGroup *qmicli_qos_get_option_group (void);
 gboolean      qmicli_qos_options_enabled  (void);
+void          qmicli_qos_options_reset    (void);
 void          qmicli_qos_run              (QmiDevice *device,
                                            QmiClientQos *client,
                                            GCancellable *cancellable);
@@ -120,6 +131,7 @@ void          qmicli_qos_run              (QmiDevice *device,
 #if defined HAVE_QMI_SERVICE_GAS
 GOptionGroup *qmicli_gas_get_option_group (void);
 gboolean      qmicli_gas_options_enabled  (void);
+void          qmicli_gas_options_reset    (void);
 void          qmicli_gas_run              (QmiDevice *device,
                                            QmiClientGas *client,
                                            GCancellable *cancellable);
@@ -128,6 +140,7 @@ void          qmicli_gas_run              (QmiDevice *device,
 #if defined HAVE_QMI_SERVICE_GMS
 GOptionGroup *qmicli_gms_get_option_group (void);
 gboolean      qmicli_gms_options_enabled  (void);
+void          qmicli_gms_options_reset    (void);
 void          qmicli_gms_run              (QmiDevice *device,
                                            QmiClientGms *client,
                                            GCancellable *cancellable);
@@ -136,6 +149,7 @@ void          qmicli_gms_run              (QmiDevice *device,
 #if defined HAVE_QMI_SERVICE_DSD
 GOptionGroup *qmicli_dsd_get_option_group (void);
 gboolean      qmicli_dsd_options_enabled  (void);
+void          qmicli_dsd_options_reset    (void);
 void          qmicli_dsd_run              (QmiDevice *device,
                                            QmiClientDsd *client,
                                            GCancellable *cancellable);
@@ -144,6 +158,7 @@ void          qmicli_dsd_run              (QmiDevice *device,
 #if defined HAVE_QMI_SERVICE_SAR
 GOptionGroup *qmicli_sar_get_option_group (void);
 gboolean      qmicli_sar_options_enabled  (void);
+void          qmicli_sar_options_reset    (void);
 void          qmicli_sar_run              (QmiDevice *device,
                                            QmiClientSar *client,
                                            GCancellable *cancellable);
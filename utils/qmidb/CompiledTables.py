@@ -0,0 +1,368 @@
+# -*- Mode: python; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+#
+# This program is free software; you can redistribute it and/or modify it under
+# the terms of the GNU General Public License as published by the Free Software
+# Foundation, version 2.
+#
+# This program is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.  See the GNU General Public License for more
+# details.
+#
+# You should have received a copy of the GNU General Public License along with
+# this program; if not, write to the Free Software Foundation, Inc., 51
+# Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+#
+# Copyright (C) 2011 - 2012 Red Hat, Inc.
+#
+
+# Compiles the database text into the record arrays cCoreDatabase loads
+# without parsing (see Core/DB2Image.h in the Gobi API).  Unlike the other
+# modules here, which interpret the tables, lines are parsed exactly as
+# cCoreDatabase's FromString() methods do so the result is the same as
+# loading the text: tokens split on '^' with empty tokens dropped, numbers
+# read the way strtol()/strtoul() read them, a later line replacing an
+# earlier one with the same key.  Record validity (IsValid()) is left to
+# cCoreDatabase, which falls back to the text if any record fails it.
+
+import sys
+
+SPACES = ' \t\n\v\f\r'
+
+def u32(val):
+    return val & 0xffffffff
+
+def s32(val):
+    val = val & 0xffffffff
+    if val >= 0x80000000:
+        val -= 0x100000000
+    return val
+
+def strtol(s, base=10):
+    # Returns (value, characters consumed), consumed is 0 if no digits
+    i = 0
+    while i < len(s) and s[i] in SPACES:
+        i += 1
+    neg = False
+    if i < len(s) and s[i] in '+-':
+        neg = s[i] == '-'
+        i += 1
+    if (base == 0 or base == 16) and s[i:i + 2] in ('0x', '0X') \
+            and i + 2 < len(s) and s[i + 2] in '0123456789abcdefABCDEF':
+        base = 16
+        i += 2
+    elif base == 0 and s[i:i + 1] == '0':
+        base = 8
+    elif base == 0:
+        base = 10
+    digits = '0123456789abcdef'[:base]
+    start = i
+    val = 0
+    while i < len(s) and s[i].lower() in digits:
+        val = val * base + digits.index(s[i].lower())
+        i += 1
+    if i == start:
+        return (0, 0)
+    if neg:
+        val = -val
+    return (val, i)
+
+def is_number(s, end):
+    # StringToLONG()/StringToULONG() accept trailing whitespace only
+    return end != 0 and (end == len(s) or s[end] in SPACES)
+
+def string_to_ulong(s):
+    if len(s) == 0 or s.lstrip(SPACES).startswith('-'):
+        return None
+    (val, end) = strtol(s, 0)
+    if not is_number(s, end):
+        return None
+    return val
+
+def string_to_long(s, default):
+    if len(s) == 0:
+        return default
+    body = s.lstrip(SPACES).lstrip('+-')
+    if body[:2] in ('0x', '0X') and s.lstrip(SPACES).startswith('-'):
+        return default
+    (val, end) = strtol(s, 0)
+    if not is_number(s, end):
+        return default
+    return val
+
+def tokens(line, sep='^'):
+    return [t for t in line.split(sep) if len(t) > 0]
+
+def quoted(tok):
+    tok = tok.rstrip(' ')
+    if len(tok) < 2 or tok[0] != '"' or tok[-1] != '"':
+        return None
+    return tok[1:-1]
+
+def ascii_lower(s):
+    return ''.join([(c >= 'A' and c <= 'Z') and chr(ord(c) + 32) or c for c in s])
+
+def read_lines(path, name):
+    f = open(path + name, 'rb')
+    text = f.read().decode('latin-1')
+    f.close()
+    if text.endswith('\n'):
+        text = text[:-1]
+    for line in text.split('\n'):
+        if line.endswith('\r'):
+            line = line[:-1]
+        yield line
+
+class CompiledTables:
+    def __init__(self, path):
+        self.errors = 0
+        self.entities = {}
+        self.fragments = {}
+        self.fields = {}
+        self.enums = {}
+        self.entries = {}
+
+        self._load(path, "Entity.txt", self._entity, self.entities)
+        self._load(path, "Struct.txt", self._fragment, self.fragments)
+        self._load(path, "Field.txt", self._field, self.fields)
+        self._load(path, "Enum.txt", self._enum, self.enums)
+        self._load(path, "EnumEntry.txt", self._entry, self.entries)
+
+    def _load(self, path, name, parse, table):
+        num = 0
+        for line in read_lines(path, name):
+            rec = parse(tokens(line))
+            if rec is not None:
+                table[rec[0]] = rec[1]
+            elif len(line) > 0:
+                sys.stderr.write("%s: parsing error, line %d (%s)\n" % (name, num, line))
+                self.errors += 1
+            num += 1
+
+    def _entity(self, toks):
+        # Type^"Key"^"Name"^Struct ID[^Format ID[^Internal[^Format Ex ID]]]
+        if len(toks) < 4:
+            return None
+        name = quoted(toks[2])
+        if name is None:
+            return None
+        etype = strtol(toks[0])[0]
+        key = [u32(etype)]
+        csv = toks[1]
+        if csv.startswith('"'):
+            csv = csv[1:]
+        if csv.endswith('"'):
+            csv = csv[:-1]
+        for tok in tokens(csv, ','):
+            val = string_to_ulong(tok)
+            if val is not None:
+                key.append(u32(val))
+        rec = { 'type': u32(etype),
+                'key': tuple(key),
+                'name': name,
+                'struct': s32(strtol(toks[3])[0]),
+                'format': -1,
+                'internal': 0,
+                'formatex': -1 }
+        if len(toks) > 4:
+            rec['format'] = s32(strtol(toks[4])[0])
+        if len(toks) > 5:
+            rec['internal'] = int(u32(strtol(toks[5])[0]) != 0)
+        if len(toks) > 6:
+            rec['formatex'] = s32(strtol(toks[6])[0])
+        return (rec['key'], rec)
+
+    def _fragment(self, toks):
+        # ID^Order^Type^Val^"Name"^Offset^Mod Type^"Mod Value"
+        if len(toks) < 8:
+            return None
+        modval = quoted(toks[7])
+        name = quoted(toks[4])
+        if modval is None or name is None:
+            return None
+        rec = { 'struct': u32(strtol(toks[0])[0]),
+                'order': u32(strtol(toks[1])[0]),
+                'value': u32(strtol(toks[3])[0]),
+                'offset': s32(strtol(toks[5])[0]),
+                'type': u32(strtol(toks[2])[0]),
+                'modtype': u32(strtol(toks[6])[0]),
+                'modval': modval,
+                'name': name }
+        return ((rec['struct'], rec['order']), rec)
+
+    def _field(self, toks):
+        # ID^"Name"^Size^Type^Type Value^Hex[^Description ID[^Internal]]
+        if len(toks) < 6:
+            return None
+        name = quoted(toks[1])
+        if name is None:
+            return None
+        rec = { 'id': u32(strtol(toks[0])[0]),
+                'size': u32(strtol(toks[2])[0]),
+                'name': name,
+                'type': u32(strtol(toks[3])[0]),
+                'typeval': u32(strtol(toks[4])[0]),
+                'hex': int(strtol(toks[5])[0] != 0),
+                'descid': -1,
+                'internal': 0 }
+        if len(toks) > 6:
+            rec['descid'] = s32(strtol(toks[6])[0])
+        if len(toks) > 7:
+            rec['internal'] = int(u32(strtol(toks[7])[0]) != 0)
+        return (rec['id'], rec)
+
+    def _enum(self, toks):
+        # ID^"Name"^Description ID^Internal
+        if len(toks) < 4:
+            return None
+        name = quoted(toks[1])
+        if name is None:
+            return None
+        rec = { 'id': u32(strtol(toks[0])[0]),
+                'internal': int(strtol(toks[3])[0] != 0),
+                'name': name,
+                'descid': -1 }
+        # Old format used to be a description string
+        if not toks[2].startswith('"'):
+            rec['descid'] = s32(strtol(toks[2])[0])
+        return (rec['id'], rec)
+
+    def _entry(self, toks):
+        # ID^Value^"Name"[^Description ID]
+        if len(toks) < 3:
+            return None
+        name = quoted(toks[2])
+        if name is None:
+            return None
+        rec = { 'id': u32(strtol(toks[0])[0]),
+                'name': name,
+                'value': s32(string_to_long(toks[1], -1)),
+                'hex': int(toks[1].startswith('0x')),
+                'descid': -1 }
+        if len(toks) > 3:
+            rec['descid'] = s32(strtol(toks[3])[0])
+        return ((rec['id'], rec['value']), rec)
+
+    def _names(self):
+        # cCoreDatabase::AssembleEntityNameMap(), case insensitive and the
+        # first entity (in key order) with a given name wins
+        names = {}
+        for key in sorted(self.entities.keys()):
+            ent = self.entities[key]
+            lower = ascii_lower(ent['name'])
+            if lower in names:
+                sys.stderr.write("Entity.txt: duplicate entity name '%s'\n" % ent['name'])
+                self.errors += 1
+                continue
+            names[lower] = ent
+        return [names[k] for k in sorted(names.keys())]
+
+    def _string(self, s):
+        if len(s) == 0:
+            return 0
+        if s not in self.offsets:
+            self.offsets[s] = self.pool_size
+            self.pool.append(s)
+            self.pool_size += len(s.encode('latin-1')) + 1
+        return self.offsets[s]
+
+    def _emit_table(self, out, ctype, cname, rows):
+        if len(rows) == 0:
+            return '0'
+        out.append('static const %s %s[] =\n{\n' % (ctype, cname))
+        for row in rows:
+            out.append('   { %s },\n' % ', '.join([str(v) for v in row]))
+        out.append('};\n\n')
+        return cname
+
+    def emit(self, out=sys.stdout):
+        self.pool = []
+        self.pool_size = 1
+        self.offsets = {}
+
+        ids = []
+        entities = []
+        for key in sorted(self.entities.keys()):
+            ent = self.entities[key]
+            entities.append((ent['type'], len(ids), len(key), ent['struct'],
+                             ent['format'], ent['formatex'], ent['internal'],
+                             self._string(ent['name'])))
+            ids.extend(key)
+
+        names = []
+        for ent in self._names():
+            names.append((self._string(ent['name']), len(ids), len(ent['key'])))
+            ids.extend(ent['key'])
+
+        frags = []
+        for key in sorted(self.fragments.keys()):
+            frag = self.fragments[key]
+            frags.append((frag['struct'], frag['order'], frag['offset'],
+                          frag['type'], frag['value'], frag['modtype'],
+                          self._string(frag['modval']),
+                          self._string(frag['name'])))
+
+        fields = []
+        for key in sorted(self.fields.keys()):
+            field = self.fields[key]
+            fields.append((field['id'], field['size'], field['type'],
+                           field['typeval'], field['hex'], field['internal'],
+                           field['descid'], self._string(field['name'])))
+
+        enums = []
+        for key in sorted(self.enums.keys()):
+            enum = self.enums[key]
+            enums.append((enum['id'], enum['internal'], enum['descid'],
+                          self._string(enum['name'])))
+
+        entries = []
+        for key in sorted(self.entries.keys()):
+            entry = self.entries[key]
+            entries.append((entry['id'], entry['value'], entry['hex'],
+                            entry['descid'], self._string(entry['name'])))
+
+        text = []
+        text.append('/* GENERATED CODE. DO NOT EDIT. */\n\n')
+        text.append('#include "StdAfx.h"\n#include "DB2Image.h"\n\n')
+
+        ent_arr = self._emit_table(text, 'sDB2ImageEntity', 'gEntities', entities)
+        name_arr = self._emit_table(text, 'sDB2ImageEntityName', 'gEntityNames', names)
+        id_arr = '0'
+        if len(ids) > 0:
+            id_arr = 'gEntityIDs'
+            text.append('static const UINT gEntityIDs[] =\n{\n')
+            for i in range(0, len(ids), 8):
+                text.append('   %s,\n' % ', '.join([str(v) for v in ids[i:i + 8]]))
+            text.append('};\n\n')
+        frag_arr = self._emit_table(text, 'sDB2ImageFragment', 'gFragments', frags)
+        field_arr = self._emit_table(text, 'sDB2ImageField', 'gFields', fields)
+        enum_arr = self._emit_table(text, 'sDB2ImageEnum', 'gEnums', enums)
+        entry_arr = self._emit_table(text, 'sDB2ImageEnumEntry', 'gEnumEntries', entries)
+
+        # Offset 0 is the empty string, the literal's own terminator is not
+        # part of the pool
+        text.append('static const CHAR gStrings[] =\n   "\\0"\n')
+        for s in self.pool:
+            esc = ''
+            for c in s:
+                if c == '"' or c == '\\' or c == '?':
+                    esc += '\\' + c
+                elif ord(c) < 0x20 or ord(c) > 0x7e:
+                    esc += '\\%03o' % ord(c)
+                else:
+                    esc += c
+            text.append('   "%s\\0"\n' % esc)
+        text.append('   ;\n\n')
+
+        text.append('const sDB2ImageView gDB2CompiledTables =\n{\n')
+        text.append('   %s, %d,\n' % (ent_arr, len(entities)))
+        text.append('   %s, %d,\n' % (name_arr, len(names)))
+        text.append('   %s, %d,\n' % (id_arr, len(ids)))
+        text.append('   %s, %d,\n' % (frag_arr, len(frags)))
+        text.append('   %s, %d,\n' % (field_arr, len(fields)))
+        text.append('   %s, %d,\n' % (enum_arr, len(enums)))
+        text.append('   %s, %d,\n' % (entry_arr, len(entries)))
+        text.append('   gStrings, %d\n' % self.pool_size)
+        text.append('};\n')
+
+        out.write(''.join(text))
@@ -22,13 +22,25 @@ import Entities
 import Enums
 import Fields
 import Structs
+import CompiledTables
 
-if len(sys.argv) > 2:
-    print "Usage: qmidb.py <path to Entity.txt>"
+args = sys.argv[1:]
+cpp = False
+if len(args) > 0 and args[0] == "--cpp":
+    cpp = True
+    args = args[1:]
+
+if len(args) > 1:
+    print "Usage: qmidb.py [--cpp] <path to Entity.txt>"
     sys.exit(1)
 path = ""
-if len(sys.argv) == 2:
-    path = sys.argv[1] + "/"
+if len(args) == 1:
+    path = args[0] + "/"
+
+if cpp:
+    # C++ record arrays for cCoreDatabase instead of C headers
+    CompiledTables.CompiledTables(path).emit()
+    sys.exit(0)
 
 enums = Enums.Enums(path)
 entities = Entities.Entities(path)
@@ -26,6 +26,8 @@
 #include <termios.h>
 #include <unistd.h>
 #include <stdlib.h>
+#include <poll.h>
+#include <time.h>
 #include <sys/types.h>
 
 typedef u_int16_t u16;
@@ -771,8 +773,540 @@ get_signal (int fd)
     return 0;
 }
 
+/*****************************************************/
+/* Burst mode: many requests in flight, latency distribution */
+
+/* qcqmi (GobiNet) binds each open file to one QMI service with this ioctl;
+ * reads and writes then carry the bare QMI SDU, with no QMUX header. */
+#define QMI_GET_SERVICE_FILE_IOCTL (0x8BE0 + 1)
+
+/* Request flags in the SDU header */
+#define QMI_CTL_FLAG_RESPONSE     0x01
+#define QMI_SERVICE_FLAG_RESPONSE 0x02
+
+typedef struct {
+    const char *name;
+    u8          service;
+    u16         msgid;   /* cheap, side-effect free request */
+} BurstService;
+
+static const BurstService burst_services[] = {
+    { "ctl", QMI_SVC_CTL, 0x0021 }, /* Get Version Info */
+    { "dms", QMI_SVC_DMS, 0x0025 }, /* Get IDs */
+    { "nas", QMI_SVC_NAS, 0x0020 }, /* Get Signal Strength */
+    { "wds", QMI_SVC_WDS, 0x0022 }, /* Get Packet Service Status */
+};
+
+typedef struct {
+    const BurstService *svc;
+    int   fd;         /* own file on qcqmi, shared on cdc-wdm */
+    u16   cid;        /* as returned by CTL: service | client << 8 */
+    u32   ntids;      /* 256 for CTL, 65536 otherwise */
+    u16   next_tid;
+    u64  *sent;       /* send timestamp indexed by TID, 0 if not in flight */
+    u32   inflight;
+    u32   replies;
+    u32   errors;
+    GArray *latencies;
+} BurstClient;
+
+typedef struct {
+    qbool        qcqmi;
+    int          ctlfd;
+    BurstClient *clients;
+    u32          n_clients;
+    u32          inflight;
+    u32          sent;
+    u32          replies;
+    u32          errors;
+    u32          lost;
+    u32          unmatched;
+    GArray      *latencies;
+} Burst;
+
+static u64
+now_ns (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (u64) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static size_t
+burst_build_request (const Burst *burst, const BurstClient *client, u16 tid, u8 *buf)
+{
+    u8     *sdu = burst->qcqmi ? buf : buf + qmux_size;
+    size_t  len;
+
+    sdu[0] = 0x00;
+    if (client->svc->service == QMI_SVC_CTL) {
+        sdu[1] = (u8) tid;
+        len = 2;
+    } else {
+        *(u16 *)(sdu + 1) = tid;
+        len = 3;
+    }
+    *(u16 *)(sdu + len) = client->svc->msgid;
+    *(u16 *)(sdu + len + 2) = 0;
+    len += 4;
+
+    if (burst->qcqmi)
+        return len;
+
+    len += qmux_size;
+    qmux_fill ((struct qmux *) buf, client->svc->service, client->cid, len);
+    return len;
+}
+
+/* Returns 1 if sent, 0 if the client can't send right now, -1 on error */
+static int
+burst_send (Burst *burst, BurstClient *client)
+{
+    u8      buf[32];
+    size_t  len;
+    ssize_t num;
+    u16     tid;
+
+    tid = client->next_tid;
+    /* TID 0 is reserved; a slot still in flight means we wrapped around */
+    if (tid == 0)
+        tid = 1;
+    if (client->sent[tid])
+        return 0;
+    client->next_tid = (tid + 1) % client->ntids;
+
+    len = burst_build_request (burst, client, tid, buf);
+    client->sent[tid] = now_ns ();
+    num = write (client->fd, buf, len);
+    if (num != len) {
+        client->sent[tid] = 0;
+        if (num < 0 && errno == EAGAIN)
+            return 0;
+        g_warning ("Failed to write: wrote %zd err %d", num, errno);
+        return -1;
+    }
+
+    client->inflight++;
+    burst->inflight++;
+    burst->sent++;
+    return 1;
+}
+
+static void
+burst_process_sdu (Burst *burst, BurstClient *client, u8 *sdu, size_t len, u64 now)
+{
+    u16 tid;
+    u64 latency;
+    size_t hdr;
+
+    if (client->svc->service == QMI_SVC_CTL) {
+        if (len < 2 || !(sdu[0] & QMI_CTL_FLAG_RESPONSE))
+            return;
+        tid = sdu[1];
+        hdr = 2;
+    } else {
+        if (len < 3 || !(sdu[0] & QMI_SERVICE_FLAG_RESPONSE))
+            return;
+        tid = *(u16 *)(sdu + 1);
+        hdr = 3;
+    }
+
+    if (!client->sent[tid]) {
+        /* Late reply to a request we already gave up on */
+        burst->unmatched++;
+        return;
+    }
+
+    latency = now - client->sent[tid];
+    client->sent[tid] = 0;
+    client->inflight--;
+    burst->inflight--;
+    client->replies++;
+    burst->replies++;
+    g_array_append_val (client->latencies, latency);
+    g_array_append_val (burst->latencies, latency);
+
+    if (qmi_msgisvalid (sdu + hdr, len - hdr) != 0) {
+        client->errors++;
+        burst->errors++;
+    }
+}
+
+static BurstClient *
+burst_lookup_client (Burst *burst, u8 service, u8 client_id)
+{
+    u32 i;
+
+    for (i = 0; i < burst->n_clients; i++) {
+        if (burst->clients[i].svc->service == service &&
+            (burst->clients[i].cid >> 8) == client_id)
+            return &burst->clients[i];
+    }
+    return NULL;
+}
+
+static void
+burst_read (Burst *burst, BurstClient *client, int fd)
+{
+    u8      buf[4096];
+    ssize_t num;
+    size_t  pos = 0;
+    u64     now;
+
+    num = read (fd, buf, sizeof (buf));
+    if (num <= 0) {
+        if (num < 0 && errno != EAGAIN)
+            g_warning ("read error %d", errno);
+        return;
+    }
+    now = now_ns ();
+
+    if (burst->qcqmi) {
+        burst_process_sdu (burst, client, buf, num, now);
+        return;
+    }
+
+    /* cdc-wdm hands over one message per read(), but be lenient with
+     * transports that coalesce them */
+    while (pos + qmux_size <= (size_t) num) {
+        struct qmux *qmux = (struct qmux *)(buf + pos);
+        size_t       msglen = qmux->len + 1;
+
+        if (qmux->tf != 1 || msglen < qmux_size || pos + msglen > (size_t) num) {
+            burst->unmatched++;
+            return;
+        }
+
+        client = burst_lookup_client (burst, qmux->service, qmux->qmicid);
+        if (client)
+            burst_process_sdu (burst, client, buf + pos + qmux_size, msglen - qmux_size, now);
+        pos += msglen;
+    }
+}
+
+static void
+burst_expire (Burst *burst, u64 now, u64 timeout_ns)
+{
+    u32 i, tid;
+
+    for (i = 0; i < burst->n_clients; i++) {
+        BurstClient *client = &burst->clients[i];
+
+        for (tid = 1; client->inflight && tid < client->ntids; tid++) {
+            if (client->sent[tid] && client->sent[tid] + timeout_ns < now) {
+                client->sent[tid] = 0;
+                client->inflight--;
+                burst->inflight--;
+                burst->lost++;
+            }
+        }
+    }
+}
+
+static int
+compare_u64 (const void *a, const void *b)
+{
+    u64 x = *(const u64 *) a, y = *(const u64 *) b;
+
+    return x < y ? -1 : x > y;
+}
+
+static u64
+percentile (GArray *sorted, double p)
+{
+    size_t idx;
+
+    if (!sorted->len)
+        return 0;
+    idx = (size_t) ((p / 100.0) * sorted->len + 0.999999);
+    if (idx > 0)
+        idx--;
+    if (idx >= sorted->len)
+        idx = sorted->len - 1;
+    return g_array_index (sorted, u64, idx);
+}
+
+static void
+print_latencies (const char *label, GArray *latencies)
+{
+    u64    sum = 0;
+    guint  i;
+
+    if (!latencies->len) {
+        g_print ("%-6s no replies\n", label);
+        return;
+    }
+
+    qsort (latencies->data, latencies->len, sizeof (u64), compare_u64);
+    for (i = 0; i < latencies->len; i++)
+        sum += g_array_index (latencies, u64, i);
+
+    g_print ("%-6s n=%-7u min %8.1f  p50 %8.1f  p90 %8.1f  p99 %8.1f  p99.9 %8.1f  max %8.1f  mean %8.1f us\n",
+             label, latencies->len,
+             g_array_index (latencies, u64, 0) / 1000.0,
+             percentile (latencies, 50) / 1000.0,
+             percentile (latencies, 90) / 1000.0,
+             percentile (latencies, 99) / 1000.0,
+             percentile (latencies, 99.9) / 1000.0,
+             g_array_index (latencies, u64, latencies->len - 1) / 1000.0,
+             (double) sum / latencies->len / 1000.0);
+}
+
+static qbool
+burst_allocate_clients (Burst *burst, const char *port, char **names)
+{
+    u32 i, j;
+
+    burst->clients = g_new0 (BurstClient, g_strv_length (names));
+    for (i = 0; names[i]; i++) {
+        const BurstService *svc = NULL;
+        BurstClient        *client;
+
+        for (j = 0; j < G_N_ELEMENTS (burst_services); j++) {
+            if (g_ascii_strcasecmp (names[i], burst_services[j].name) == 0)
+                svc = &burst_services[j];
+        }
+        if (!svc) {
+            g_warning ("unknown service '%s' (expected ctl, dms, nas or wds)", names[i]);
+            return FALSE;
+        }
+
+        client = &burst->clients[burst->n_clients];
+        client->svc = svc;
+        client->ntids = svc->service == QMI_SVC_CTL ? 0x100 : 0x10000;
+        client->next_tid = 1;
+
+        if (burst->qcqmi) {
+            /* The driver owns the CTL service on these nodes */
+            if (svc->service == QMI_SVC_CTL) {
+                g_warning ("ctl requests are not possible on qcqmi nodes, skipping");
+                continue;
+            }
+            client->fd = open (port, O_RDWR | O_NONBLOCK | O_NOCTTY);
+            if (client->fd < 0) {
+                g_warning ("%s: open failed: %d", port, errno);
+                return FALSE;
+            }
+            if (ioctl (client->fd, QMI_GET_SERVICE_FILE_IOCTL, (unsigned long) svc->service) != 0) {
+                g_warning ("%s: couldn't bind to service %s: %d", port, svc->name, errno);
+                close (client->fd);
+                return FALSE;
+            }
+        } else {
+            client->fd = burst->ctlfd;
+            if (svc->service != QMI_SVC_CTL) {
+                char    reply[2048];
+                size_t  rlen;
+                size_t  blen;
+                void   *b;
+
+                b = qmictl_new_getcid (ctl_tid++, svc->service, &blen);
+                rlen = send_and_wait_reply (burst->ctlfd, b, blen, reply, sizeof (reply));
+                g_free (b);
+                if (rlen <= 0 || qmictl_getcid_resp (reply, rlen, &client->cid) < 0) {
+                    g_warning ("Failed to get %s client ID", svc->name);
+                    return FALSE;
+                }
+                g_message ("%s CID %d 0x%X", svc->name, client->cid, client->cid);
+            }
+        }
+
+        client->sent = g_new0 (u64, client->ntids);
+        client->latencies = g_array_new (FALSE, FALSE, sizeof (u64));
+        burst->n_clients++;
+    }
+
+    return burst->n_clients > 0;
+}
+
+static void
+burst_release_clients (Burst *burst)
+{
+    u32 i;
+
+    for (i = 0; i < burst->n_clients; i++) {
+        BurstClient *client = &burst->clients[i];
+
+        if (burst->qcqmi)
+            close (client->fd);
+        else if (client->svc->service != QMI_SVC_CTL) {
+            char    reply[2048];
+            size_t  rlen;
+            size_t  blen;
+            void   *b;
+
+            /* Drop anything still queued so the release reply is the next read */
+            while (read (burst->ctlfd, reply, sizeof (reply)) > 0);
+
+            b = qmictl_new_releasecid (ctl_tid++, client->cid, &blen);
+            rlen = send_and_wait_reply (burst->ctlfd, b, blen, reply, sizeof (reply));
+            g_free (b);
+            if (rlen <= 0 || qmictl_releasecid_resp (reply, rlen) < 0)
+                g_warning ("Failed to release %s client ID", client->svc->name);
+        }
+        g_free (client->sent);
+        g_array_unref (client->latencies);
+    }
+    g_free (burst->clients);
+}
+
+static int
+run_burst (const char *port,
+           qbool       qcqmi,
+           char      **services,
+           u32         window,
+           u32         count,
+           u32         rate,
+           u32         timeout_ms)
+{
+    Burst          burst = { 0 };
+    struct pollfd *pfds;
+    u64            start, end, next_send, interval;
+    u64            timeout_ns = (u64) timeout_ms * 1000000ULL;
+    u64            last_expire;
+    u32            rr = 0;
+    u32            i;
+    int            ret = 1;
+
+    burst.qcqmi = qcqmi;
+    burst.ctlfd = -1;
+    burst.latencies = g_array_sized_new (FALSE, FALSE, sizeof (u64), count);
+
+    if (!qcqmi) {
+        burst.ctlfd = open (port, O_RDWR | O_EXCL | O_NONBLOCK | O_NOCTTY);
+        if (burst.ctlfd < 0) {
+            g_warning ("%s: open failed: %d", port, errno);
+            goto out;
+        }
+    }
+
+    if (!burst_allocate_clients (&burst, port, services))
+        goto out;
+
+    pfds = g_new0 (struct pollfd, burst.n_clients);
+    for (i = 0; i < burst.n_clients; i++) {
+        pfds[i].fd = burst.clients[i].fd;
+        pfds[i].events = POLLIN;
+    }
+
+    if (rate)
+        g_print ("burst: %u requests over %u service(s), window %u, rate %u req/s, %s node\n",
+                 count, burst.n_clients, window, rate, qcqmi ? "qcqmi" : "cdc-wdm");
+    else
+        g_print ("burst: %u requests over %u service(s), window %u, unlimited rate, %s node\n",
+                 count, burst.n_clients, window, qcqmi ? "qcqmi" : "cdc-wdm");
+
+    interval = rate ? 1000000000ULL / rate : 0;
+    start = next_send = last_expire = now_ns ();
+
+    while (burst.sent < count || burst.inflight > 0) {
+        u64 now = now_ns ();
+        u64 wait_ns;
+        u32 stalled = 0;
+
+        /* Fill the window, round-robin across services, paced to the rate */
+        while (burst.sent < count && burst.inflight < window &&
+               (!interval || now >= next_send) && stalled < burst.n_clients) {
+            int sent;
+
+            sent = burst_send (&burst, &burst.clients[rr]);
+            if (sent < 0)
+                goto abort;
+            if (sent) {
+                next_send += interval;
+                stalled = 0;
+            } else
+                stalled++;
+            rr = (rr + 1) % burst.n_clients;
+        }
+
+        if (now - last_expire > 100000000ULL) {
+            last_expire = now_ns ();
+            burst_expire (&burst, last_expire, timeout_ns);
+        }
+
+        wait_ns = 100000000ULL;
+        if (interval && burst.sent < count && burst.inflight < window)
+            wait_ns = next_send > now ? MIN (next_send - now, wait_ns) : 0;
+
+        /* On cdc-wdm all clients share the one file. Rates above 1000 req/s
+         * are kept by sending the backlog in one go after each wakeup. */
+        if (poll (pfds, qcqmi ? burst.n_clients : 1, (int) ((wait_ns + 999999) / 1000000)) < 0 &&
+            errno != EINTR) {
+            g_warning ("poll error %d", errno);
+            break;
+        }
+
+        for (i = 0; i < (qcqmi ? burst.n_clients : 1); i++) {
+            if (pfds[i].revents & POLLIN)
+                burst_read (&burst, &burst.clients[i], pfds[i].fd);
+        }
+    }
+abort:
+    end = now_ns ();
+    g_free (pfds);
+
+    g_print ("sent %u, replies %u (%u with QMI error), lost %u, unmatched %u in %.3f s\n",
+             burst.sent, burst.replies, burst.errors, burst.lost, burst.unmatched,
+             (end - start) / 1e9);
+    g_print ("throughput: %.1f replies/s\n", burst.replies / ((end - start) / 1e9));
+    for (i = 0; i < burst.n_clients; i++)
+        print_latencies (burst.clients[i].svc->name, burst.clients[i].latencies);
+    if (burst.n_clients > 1)
+        print_latencies ("all", burst.latencies);
+
+    ret = burst.lost ? 1 : 0;
+
+out:
+    burst_release_clients (&burst);
+    if (burst.ctlfd >= 0)
+        close (burst.ctlfd);
+    g_array_unref (burst.latencies);
+    return ret;
+}
+
+/*****************************************************/
+
+static gint   burst_window;
+static gint   burst_count = 1000;
+static gint   burst_rate;
+static gint   burst_timeout = 5000;
+static gchar *burst_services_str;
+static gboolean qcqmi_flag;
+
+static GOptionEntry main_entries[] = {
+    { "burst", 'b', 0, G_OPTION_ARG_INT, &burst_window,
+      "Run the burst latency test with up to N requests in flight",
+      "[N]"
+    },
+    { "count", 'n', 0, G_OPTION_ARG_INT, &burst_count,
+      "Number of requests to send in burst mode (default 1000)",
+      "[COUNT]"
+    },
+    { "rate", 'r', 0, G_OPTION_ARG_INT, &burst_rate,
+      "Target request rate in burst mode, 0 for unlimited (default 0)",
+      "[REQ/S]"
+    },
+    { "services", 's', 0, G_OPTION_ARG_STRING, &burst_services_str,
+      "Comma separated services to exercise in burst mode: ctl, dms, nas, wds (default dms)",
+      "[LIST]"
+    },
+    { "timeout", 't', 0, G_OPTION_ARG_INT, &burst_timeout,
+      "Give up on a request after this many milliseconds (default 5000)",
+      "[MS]"
+    },
+    { "qcqmi", 'q', 0, G_OPTION_ARG_NONE, &qcqmi_flag,
+      "Port is a GobiNet qcqmi node (detected from the name otherwise)",
+      NULL
+    },
+    { NULL }
+};
+
 int main(int argc, char *argv[])
 {
+    GOptionContext *context;
+    GError *error = NULL;
     int fd;
     void *b;
     size_t blen;
@@ -781,11 +1315,41 @@ int main(int argc, char *argv[])
     size_t rlen;
     int err;
 
+    context = g_option_context_new ("<port> - raw QMI tester");
+    g_option_context_add_main_entries (context, main_entries, NULL);
+    if (!g_option_context_parse (context, &argc, &argv, &error)) {
+        g_warning ("error: %s", error->message);
+        g_error_free (error);
+        return 1;
+    }
+    g_option_context_free (context);
+
     if (argc != 2) {
-        g_warning ("usage: %s <port>", argv[0]);
+        g_warning ("usage: %s [OPTION...] <port>", argv[0]);
         return 1;
     }
 
+    if (burst_window > 0) {
+        char **services;
+        char  *basename;
+        int    ret;
+
+        if (burst_count <= 0 || burst_rate < 0 || burst_timeout <= 0) {
+            g_warning ("count and timeout must be positive, rate must not be negative");
+            return 1;
+        }
+
+        basename = g_path_get_basename (argv[1]);
+        if (g_str_has_prefix (basename, "qcqmi"))
+            qcqmi_flag = TRUE;
+        g_free (basename);
+
+        services = g_strsplit (burst_services_str ? burst_services_str : "dms", ",", -1);
+        ret = run_burst (argv[1], qcqmi_flag, services, burst_window, burst_count, burst_rate, burst_timeout);
+        g_strfreev (services);
+        return ret;
+    }
+
     errno = 0;
     fd = open (argv[1], O_RDWR | O_EXCL | O_NONBLOCK | O_NOCTTY);
     if (fd < 0) {
@@ -39,11 +39,16 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/select.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
 #include <termios.h>
 #include <unistd.h>
 
+#include "qfu-hdlc.h"
+
 /* FIXME: endianness - this works on LE for now... */
 
 #ifndef VERSION
@@ -73,6 +78,11 @@ static void print_packet(const char *pfx, void *buf, int len)
 
 
 #define CHUNK (1024 * 1024)
+#define MAX_DEVICES 32
+
+/* prefix for messages, set to the device path when flashing several */
+static const char *log_prefix = "";
+#define info(fmt, arg...) fprintf(stderr, "%s" fmt, log_prefix, ##arg)
 
 /** DLOAD protocol **/
 
@@ -267,8 +277,9 @@ struct qdl_ufwrite_req {
     __u16 crc;
 }  __attribute__ ((packed));
 
-/* the buffer most hold a file chunk + this header */
-#define BUFSIZE (CHUNK + sizeof(struct qdl_ufwrite_req))
+/* the buffer must hold the largest request: an open request with its file
+ * header; image chunks are sent straight from the mapped file */
+#define BUFSIZE 1024
 
 /* The response is HDLC framed, so the crc is part of the framing */
 struct qdl_ufwrite_rsp {
@@ -299,131 +310,8 @@ struct qdl_imagepref_rsp {
     } image[];
 }  __attribute__ ((packed));
 
-/*
- * crc16 and HDLC escape code borrowed from modemmanager/libqcdm
- * Copyright (C) 2010 Red Hat, Inc.
- */
-
-/* Table of CRCs for each possible byte, with a generator polynomial of 0x8408 */
-static const __u16 crc_table[256] = {
-    0x0000, 0x1189, 0x2312, 0x329b, 0x4624, 0x57ad, 0x6536, 0x74bf,
-    0x8c48, 0x9dc1, 0xaf5a, 0xbed3, 0xca6c, 0xdbe5, 0xe97e, 0xf8f7,
-    0x1081, 0x0108, 0x3393, 0x221a, 0x56a5, 0x472c, 0x75b7, 0x643e,
-    0x9cc9, 0x8d40, 0xbfdb, 0xae52, 0xdaed, 0xcb64, 0xf9ff, 0xe876,
-    0x2102, 0x308b, 0x0210, 0x1399, 0x6726, 0x76af, 0x4434, 0x55bd,
-    0xad4a, 0xbcc3, 0x8e58, 0x9fd1, 0xeb6e, 0xfae7, 0xc87c, 0xd9f5,
-    0x3183, 0x200a, 0x1291, 0x0318, 0x77a7, 0x662e, 0x54b5, 0x453c,
-    0xbdcb, 0xac42, 0x9ed9, 0x8f50, 0xfbef, 0xea66, 0xd8fd, 0xc974,
-    0x4204, 0x538d, 0x6116, 0x709f, 0x0420, 0x15a9, 0x2732, 0x36bb,
-    0xce4c, 0xdfc5, 0xed5e, 0xfcd7, 0x8868, 0x99e1, 0xab7a, 0xbaf3,
-    0x5285, 0x430c, 0x7197, 0x601e, 0x14a1, 0x0528, 0x37b3, 0x263a,
-    0xdecd, 0xcf44, 0xfddf, 0xec56, 0x98e9, 0x8960, 0xbbfb, 0xaa72,
-    0x6306, 0x728f, 0x4014, 0x519d, 0x2522, 0x34ab, 0x0630, 0x17b9,
-    0xef4e, 0xfec7, 0xcc5c, 0xddd5, 0xa96a, 0xb8e3, 0x8a78, 0x9bf1,
-    0x7387, 0x620e, 0x5095, 0x411c, 0x35a3, 0x242a, 0x16b1, 0x0738,
-    0xffcf, 0xee46, 0xdcdd, 0xcd54, 0xb9eb, 0xa862, 0x9af9, 0x8b70,
-    0x8408, 0x9581, 0xa71a, 0xb693, 0xc22c, 0xd3a5, 0xe13e, 0xf0b7,
-    0x0840, 0x19c9, 0x2b52, 0x3adb, 0x4e64, 0x5fed, 0x6d76, 0x7cff,
-    0x9489, 0x8500, 0xb79b, 0xa612, 0xd2ad, 0xc324, 0xf1bf, 0xe036,
-    0x18c1, 0x0948, 0x3bd3, 0x2a5a, 0x5ee5, 0x4f6c, 0x7df7, 0x6c7e,
-    0xa50a, 0xb483, 0x8618, 0x9791, 0xe32e, 0xf2a7, 0xc03c, 0xd1b5,
-    0x2942, 0x38cb, 0x0a50, 0x1bd9, 0x6f66, 0x7eef, 0x4c74, 0x5dfd,
-    0xb58b, 0xa402, 0x9699, 0x8710, 0xf3af, 0xe226, 0xd0bd, 0xc134,
-    0x39c3, 0x284a, 0x1ad1, 0x0b58, 0x7fe7, 0x6e6e, 0x5cf5, 0x4d7c,
-    0xc60c, 0xd785, 0xe51e, 0xf497, 0x8028, 0x91a1, 0xa33a, 0xb2b3,
-    0x4a44, 0x5bcd, 0x6956, 0x78df, 0x0c60, 0x1de9, 0x2f72, 0x3efb,
-    0xd68d, 0xc704, 0xf59f, 0xe416, 0x90a9, 0x8120, 0xb3bb, 0xa232,
-    0x5ac5, 0x4b4c, 0x79d7, 0x685e, 0x1ce1, 0x0d68, 0x3ff3, 0x2e7a,
-    0xe70e, 0xf687, 0xc41c, 0xd595, 0xa12a, 0xb0a3, 0x8238, 0x93b1,
-    0x6b46, 0x7acf, 0x4854, 0x59dd, 0x2d62, 0x3ceb, 0x0e70, 0x1ff9,
-    0xf78f, 0xe606, 0xd49d, 0xc514, 0xb1ab, 0xa022, 0x92b9, 0x8330,
-    0x7bc7, 0x6a4e, 0x58d5, 0x495c, 0x3de3, 0x2c6a, 0x1ef1, 0x0f78
-};
-
-/* Calculate the CRC for a buffer using a seed of 0xffff */
-static __u16 crc16(const char *buffer, size_t len)
-{
-    __u16 crc = 0xffff;
-
-    while (len--)
-            crc = crc_table[(crc ^ *buffer++) & 0xff] ^ (crc >> 8);
-    return ~crc;
-}
-
-#define CONTROL 0x7e
-#define ESCAPE  0x7d
-#define MASK    0x20
-
-static size_t escape(const char *in, size_t inlen, char *out, size_t outlen)
-{
-    size_t i, j;
-
-    for (i = 0, j = 0; i < inlen; i++) {
-        if (in[i] == CONTROL || in[i] == ESCAPE) {
-            out[j++] = ESCAPE;
-            if (j < outlen)
-                out[j++] = in[i] ^ MASK;
-        } else {
-            out[j++] = in[i];
-        }
-        if (j >= outlen)
-            return 0; /* failed to enscape -  buffer too small */
-    }
-    return j;
-}
-
-static size_t unescape(const char *in, size_t inlen, char *out, size_t outlen)
-{
-    size_t i, j = 0;
-    bool escaping = false;
-
-    for (i = 0; i < inlen; i++) {
-        if (j >= outlen) {
-            debug("i=%zu, j=%zu, inlen=%zu, outlen=%zu\n", i, j, inlen, outlen);
-            return 0;
-        }
-        if (escaping) {
-            out[j++] = in[i] ^ MASK;
-            escaping = false;
-        } else if (in[i] == ESCAPE) {
-            escaping = true;
-        } else {
-            out[j++] = in[i];
-        }
-    }
-    return j;
-}
-
-/* copy a possibly escaped single byte to out */
-static size_t escape_byte(__u8 byte, char *out, size_t outlen)
-{
-    size_t j = 0;
-
-    if (byte == CONTROL || byte == ESCAPE) {
-        out[j++] = ESCAPE;
-        byte ^= MASK;
-    }
-    out[j++] = byte;
-    return j;
-}
-
-static size_t hdlc_frame(const char *in, size_t inlen, char *out, size_t outlen)
-{
-    __u16 crc;
-    size_t j = 0;
-
-    out[j++] = CONTROL;
-    j += escape(in, inlen, &out[j], outlen - j);
-    crc = crc16(in, inlen);
-    j += escape_byte(crc & 0xff, &out[j], outlen - j);
-    j += escape_byte(crc >> 8 & 0xff, &out[j], outlen - j);
-    out[j++] = CONTROL;
-
-    if (j < inlen)
-        return 0;    /* FIXME */
-
-    return j;
-}
+/* crc16 and HDLC escaping are shared with qmi-firmware-update (qfu-hdlc.h) */
+#define CONTROL QFU_HDLC_CONTROL
 
 static size_t hdlc_unframe(const char *in, size_t inlen, char *out, size_t outlen)
 {
@@ -438,7 +326,7 @@ static size_t hdlc_unframe(const char *in, size_t inlen, char *out, size_t outle
     if (in[i - 1] == CONTROL)
         i--;
 
-    j = unescape(in, i, out, outlen);
+    j = qfu_hdlc_unescape((const uint8_t *)in, i, (uint8_t *)out, outlen);
     if (j < 2) {
         debug("unescape failed: j = %zu\n", j);
         return 0;
@@ -446,7 +334,7 @@ static size_t hdlc_unframe(const char *in, size_t inlen, char *out, size_t outle
     j -= 2; /* remove the crc */
 
     /* verify the crc */
-    crc = crc16(out, j);
+    crc = qfu_hdlc_crc16((const uint8_t *)out, j);
     if (crc != ((unsigned char)out[j] | (unsigned char)out[j + 1] << 8)) {
         debug("crc failed: 0x%04x != 0x%04x\n", crc, out[j] | out[j + 1] << 8);
         return 0;
@@ -476,13 +364,13 @@ static inline size_t imglen(__u8 type, size_t len)
     }
 }
 
-static size_t create_ufopen_req(char *in, size_t filelen, __u8 type)
+static size_t create_ufopen_req(char *in, size_t filelen, __u8 type, __u8 windowsize)
 {
     struct qdl_ufopen_req *req = (void *)in;
 
     req->cmd = QDL_CMD_OPEN_UNFRAMED_REQ;
     req->type = type;
-    req ->windowsize = 1; /* snooped */
+    req ->windowsize = windowsize; /* 1 snooped */
     req->length = imglen(type, filelen);
     req->chunksize = imglen(type, filelen) - hdrlen(type);
     return sizeof(struct qdl_ufopen_req);
@@ -496,7 +384,7 @@ static size_t create_ufwrite_req(char *out, size_t chunksize, int sequence)
     req->sequence = sequence;
     req->reserved = 0;
     req->chunksize = chunksize;
-    req->crc = crc16(out, sizeof(*req) - 2);
+    req->crc = qfu_hdlc_crc16((const uint8_t *)out, sizeof(*req) - 2);
     return sizeof(*req);
 }
 
@@ -587,12 +475,18 @@ static int parse_sdp_err(const char *in, size_t inlen, bool silent)
     ret = hdlc_unframe(in, inlen, buf, sizeof(buf));
     if (ret == sizeof(*r) && r->cmd == QDL_CMD_ERROR) {
         if (!silent)
-            fprintf(stderr, "SDP error %d (%d): %s\n", r->error, r->errortxt, sdperr2str(r->error));
+            info("SDP error %d (%d): %s\n", r->error, r->errortxt, sdperr2str(r->error));
         return -r->error;
     }
     return -1; /* not an proper error frame */
 }
 
+/* window size granted in the last open response */
+static __u8 ufopen_windowsize;
+
+/* highest sequence acked since the last open request, -1 if none */
+static int ufwrite_last_ack = -1;
+
 static int parse_ufopen(const char *in, size_t inlen)
 {
     struct qdl_ufopen_rsp *r;
@@ -604,6 +498,7 @@ static int parse_ufopen(const char *in, size_t inlen)
     if (ret != sizeof(*r) || r->cmd != QDL_CMD_OPEN_UNFRAMED_RSP)
         return -1;
     debug("status=%d, windowsize=%d, chunksize=%d\n", r->status, r->windowsize, r->chunksize);
+    ufopen_windowsize = r->windowsize;
     return -r->status;
 }
 
@@ -618,10 +513,13 @@ static int parse_ufwrite(const char *in, size_t inlen)
     if (ret != sizeof(*r) || r->cmd != QDL_CMD_WRITE_UNFRAMED_RSP)
         return -1;
     if (r->status) {
-        fprintf(stderr, "seq 0x%04x status=%d\n", r->sequence, r->status);
+        info("seq 0x%04x status=%d\n", r->sequence, r->status);
         return -r->status;
     }
     debug("ack: %d\n", r->sequence);
+    /* acks are cumulative */
+    if (r->sequence > ufwrite_last_ack)
+        ufwrite_last_ack = r->sequence;
     return r->sequence;
 }
 
@@ -640,14 +538,14 @@ static int parse_ufdone(const char *in, size_t inlen)
 }
 
 /* read and parse QDL if available.  Will return unless data is
- * available withing 5 ms
+ * available within the given timeout
  */
-static int read_and_parse(int fd, bool silent)
+static int read_and_parse_timeout(int fd, bool silent, int timeout_ms)
 {
     char *end, *p, rbuf[512];
     int rlen, framelen, ret = 0;
     fd_set rd;
-    struct timeval tv = { .tv_sec = 1, .tv_usec = 0, };
+    struct timeval tv = { .tv_sec = timeout_ms / 1000, .tv_usec = (timeout_ms % 1000) * 1000, };
 
     FD_ZERO(&rd);
     FD_SET(fd, &rd);
@@ -685,7 +583,7 @@ static int read_and_parse(int fd, bool silent)
             ret = parse_ufdone(p, framelen);
             break;
         default:
-            fprintf(stderr, "Unsupported response code: 0x%02x\n", p[1]);
+            info("Unsupported response code: 0x%02x\n", p[1]);
         }
         if (ret < 0)
             return ret;
@@ -695,15 +593,20 @@ static int read_and_parse(int fd, bool silent)
     return ret;
 }
 
+static int read_and_parse(int fd, bool silent)
+{
+    return read_and_parse_timeout(fd, silent, 1000);
+}
+
 static int write_hdlc(int fd, const char *in, size_t inlen)
 {
-    char wbuf[512];
+    char wbuf[2 * BUFSIZE + 6];
     int wlen;
 
-    wlen = hdlc_frame(in, inlen, wbuf, sizeof(wbuf));
+    wlen = qfu_hdlc_frame((const uint8_t *)in, inlen, (uint8_t *)wbuf, sizeof(wbuf));
     if (wlen > 0) {
         if (write(fd, wbuf, wlen) < 0)
-            fprintf(stderr, "error writing HDLC");
+            info("error writing HDLC");
         else
             print_packet("write", wbuf, wlen);
     } else {
@@ -751,16 +654,16 @@ static int verify_cwehdr(char *buf)
     struct cwehdr *h = (void *)buf;
     char tmp[5];
 
-    fprintf(stderr, "  CWE revision: %d\n", be32toh(h->rev));
+    info("  CWE revision: %d\n", be32toh(h->rev));
     memcpy(tmp, h->type, 4);
     tmp[4] = 0;
-    fprintf(stderr, "  type: %s\n", tmp);
+    info("  type: %s\n", tmp);
     memcpy(tmp, h->product, 4);
     tmp[4] = 0;
-    fprintf(stderr, "  product: %s\n", tmp);
-    fprintf(stderr, "  image size: %d\n", be32toh(h->imgsize));
-    fprintf(stderr, "  version: %s\n", h->version);
-    fprintf(stderr, "  date: %s\n", h->date);
+    info("  product: %s\n", tmp);
+    info("  image size: %d\n", be32toh(h->imgsize));
+    info("  version: %s\n", h->version);
+    info("  date: %s\n", h->date);
     return 0;
 }
 
@@ -787,37 +690,97 @@ static __u8 filename2type(const char *filename)
     return QDL_IMAGE_CWE;
 }
 
-static int download_image(int serfd, char *buf, const char *image)
+/* send one ufwrite request, with the chunk taken from the mapped image */
+static int write_chunk(int serfd, const char *chunk, size_t chunksize, int sequence)
 {
-    int imgfd = -1, ret = 0, seq = 0;
-    size_t chunksize, rlen, filelen;
+    struct qdl_ufwrite_req req;
+    struct iovec iov[2];
+    size_t total, written = 0;
+    fd_set wr;
+    struct timeval tv = { .tv_sec = 2, .tv_usec = 0, };
+
+    create_ufwrite_req((char *)&req, chunksize, sequence);
+    iov[0].iov_base = &req;
+    iov[0].iov_len = sizeof(req);
+    iov[1].iov_base = (void *)chunk;
+    iov[1].iov_len = chunksize;
+    total = sizeof(req) + chunksize;
+
+    while (written < total) {
+        ssize_t wlen;
+
+        FD_ZERO(&wr);
+        FD_SET(serfd, &wr);
+        if (select(serfd + 1, NULL, &wr, NULL, &tv) <= 0)
+            return -1;
+        wlen = writev(serfd, iov, 2);
+        if (wlen < 0) {
+            if (errno == EINTR || errno == EAGAIN)
+                continue;
+            return -1;
+        }
+        written += wlen;
+        /* skip what was already written */
+        while (wlen > 0) {
+            size_t n = (size_t)wlen < iov[0].iov_len ? (size_t)wlen : iov[0].iov_len;
+
+            iov[0].iov_base = (char *)iov[0].iov_base + n;
+            iov[0].iov_len -= n;
+            wlen -= n;
+            if (!iov[0].iov_len) {
+                iov[0] = iov[1];
+                iov[1].iov_len = 0;
+            }
+        }
+    }
+    return 0;
+}
+
+/* number of ack polls without progress before giving up on a full window */
+#define WINDOW_STALL_LIMIT 30
+
+static int download_image(int serfd, char *buf, const char *image, __u8 window)
+{
+    int imgfd = -1, ret = 0, seq = 0, stalled = 0;
+    size_t chunksize, rlen, filelen, offset;
     struct stat img_data;
+    char *map = MAP_FAILED;
     __u8 type = filename2type(image);
 
     /* FIXME: verify that this image matches the modem */
     imgfd = open(image, O_RDONLY);
     if (imgfd < 0) {
-        fprintf(stderr, "Cannot open %s: %d\n", image, imgfd);
+        info("Cannot open %s: %d\n", image, imgfd);
         ret = imgfd;
         goto out;
     }
     fstat(imgfd, &img_data);
     if (imglen(type, img_data.st_size) < hdrlen(type)) {
-        fprintf(stderr, "%s is too short\n", image);
+        info("%s is too short\n", image);
         ret = -1;
         goto out;
     }
 
-    fprintf(stderr, "Downloading %s image '%s'\n", qdl_type2str(type), image);
+    /* the image is sent straight from the page cache */
+    map = mmap(NULL, img_data.st_size, PROT_READ, MAP_PRIVATE, imgfd, 0);
+    if (map == MAP_FAILED) {
+        info("Cannot map %s: %s\n", image, strerror(errno));
+        ret = -errno;
+        goto out;
+    }
+    madvise(map, img_data.st_size, MADV_SEQUENTIAL);
+
+    info("Downloading %s image '%s'\n", qdl_type2str(type), image);
 
     /* send open request */
-    rlen = create_ufopen_req(buf, img_data.st_size, type);
+    ufopen_windowsize = 0;
+    ufwrite_last_ack = -1;
+    rlen = create_ufopen_req(buf, img_data.st_size, type, window);
     if (hdrlen(type) > 0) {
         ret = -1;
         if (hdrlen(type) + rlen > BUFSIZE)
             goto out;
-        if (read(imgfd, buf + rlen, hdrlen(type)) != hdrlen(type))
-            goto out;
+        memcpy(buf + rlen, map, hdrlen(type));
         if (type == QDL_IMAGE_CWE)
             verify_cwehdr(buf + rlen);
     }
@@ -827,30 +790,48 @@ static int download_image(int serfd, char *buf, const char *image)
     if (read_and_parse(serfd, false) < 0)
         goto out;
 
+    /* the device may grant a smaller window than requested */
+    if (ufopen_windowsize > 0 && ufopen_windowsize < window)
+        window = ufopen_windowsize;
+    if (window > 1)
+        info("Using a window of %u chunks\n", window);
+
+    offset = hdrlen(type);
     filelen = imglen(type, img_data.st_size) - hdrlen(type);
     /* remaining data to send */
     while (filelen > 0) {
-        fd_set wr;
-        struct timeval tv = { .tv_sec = 2, .tv_usec = 0, };
-
         chunksize = CHUNK;
         if (chunksize > filelen)
             chunksize = filelen;
 
-        debug("write #%d (%zu)...", seq, chunksize);
-        rlen = create_ufwrite_req(buf, chunksize, seq++);
-        rlen += read(imgfd, buf + rlen, CHUNK);
-        filelen -= chunksize;
+        /* wait until there is room in the window */
+        while (window > 1 && seq - (ufwrite_last_ack + 1) >= window) {
+            int last_ack = ufwrite_last_ack;
+
+            ret = read_and_parse(serfd, false);
+            if (ret < 0)
+                goto out;
+            if (ufwrite_last_ack != last_ack)
+                stalled = 0;
+            else if (++stalled >= WINDOW_STALL_LIMIT) {
+                info("No ack received for seq %d\n", ufwrite_last_ack + 1);
+                ret = -1;
+                goto out;
+            }
+        }
 
-        FD_ZERO(&wr);
-        FD_SET(serfd, &wr);
-        if (select(serfd + 1, NULL, &wr, NULL, &tv) <= 0)
-            goto out;
-        if (write(serfd,  buf, rlen) < 0) {
-            fprintf(stderr, "error writing data");
+        debug("write #%d (%zu)...", seq, chunksize);
+        if (write_chunk(serfd, map + offset, chunksize, seq++) < 0) {
+            info("error writing data");
+            ret = -1;
             goto out;
         }
-        ret = read_and_parse(serfd, false);
+        offset += chunksize;
+        filelen -= chunksize;
+
+        /* lockstep: give the device a chance to ack each chunk; windowed:
+         * only consume the acks already available */
+        ret = read_and_parse_timeout(serfd, false, window > 1 ? 0 : 1000);
         if (ret < 0)
             goto out;
     }
@@ -858,15 +839,24 @@ static int download_image(int serfd, char *buf, const char *image)
     debug("finished writing\n");
 
     /* This may take a considerable amount of time */
-    fprintf(stderr, "\nWaiting for ack");
-    while (ret != seq - 1) {
-        fprintf(stderr, ".");
-        sleep(3);
+    info("Waiting for ack\n");
+    while (ufwrite_last_ack != seq - 1) {
         ret = read_and_parse(serfd, false);
+        if (ret < 0)
+            goto out;
+        if (ufwrite_last_ack == seq - 1)
+            break;
+        if (!*log_prefix)
+            fprintf(stderr, ".");
+        sleep(3);
     }
-    fprintf(stderr, "\n");
+    if (!*log_prefix)
+        fprintf(stderr, "\n");
+    ret = 0;
 
 out:
+    if (map != MAP_FAILED)
+        munmap(map, img_data.st_size);
     if (imgfd > 0)
         close(imgfd);
     return ret;
@@ -875,6 +865,7 @@ out:
 static struct option main_options[] = {
     { "help",   0, 0, 'h' },
     { "serial",     1, 0, 's' },
+    { "window",     1, 0, 'w' },
     { "debug",      0, 0, 'd' },
     { 0, 0, 0, 0 }
 };
@@ -886,30 +877,20 @@ static void usage(const char *prog)
 #ifdef DEBUG
         " [--debug] "
 #endif
-        "--serial <device> <image> [image2] [image3]\n",
+        " [--window <1-255>] --serial <device> [--serial <device2>...] <image> [image2] [image3]\n",
         __func__, prog);
 }
 
-int main(int argc, char *argv[])
+/* flash all images to the device in QDL mode at the given path */
+static int flash_device(const char *dev, char **images, int nimages, __u8 window)
 {
-    int opt, serfd = -1, ret = 0, version;
+    int serfd, ret = 0, version, i;
     char *buffer = NULL;
 
-    fprintf(stderr, "%s\n", DESCRIPTION);
-    while ((opt = getopt_long(argc, argv, "i:s:m:dvh", main_options, NULL)) != -1) {
-        switch(opt) {
-        case 's':
-            serfd = serial_open(optarg);
-            break;
-#ifdef DEBUG
-        case 'd':
-            debug = true;
-            break;
-#endif
-        case 'h':
-            usage(argv[0]);
-            return 0;
-        }
+    serfd = serial_open(dev);
+    if (serfd < 0) {
+        info("Cannot open %s\n", dev);
+        return serfd;
     }
 
     buffer = malloc(BUFSIZE);
@@ -918,7 +899,6 @@ int main(int argc, char *argv[])
         goto err;
     }
 
-
 /* FIXME: should do the following for a complete image upload*
  *
  *  For CWE images:
@@ -937,15 +917,6 @@ int main(int argc, char *argv[])
  * How do we do this properly?
  */
 
-    /* need at least one firmware filename */
-    if (optind == argc) {
-        usage(argv[0]);
-        return -1;
-    }
-
-    if (serfd < 0)
-        return serfd;
-
     /* switch to SDP - this is required for some modems like MC7710 */
     write_hdlc(serfd, (const char *)&dload_sdp, sizeof(dload_sdp));
     ret = read_and_parse(serfd, true);
@@ -968,14 +939,14 @@ int main(int argc, char *argv[])
             break;
     }
     if (ret < 0) {
-        fprintf(stderr, "Unable to detect QDL version\n");
+        info("Unable to detect QDL version\n");
         goto err;
     }
-    fprintf(stderr, "Got QDL version: %u\n", version);
+    info("Got QDL version: %u\n", version);
 
     /* download all images */
-    while (optind < argc && ret >= 0)
-        ret = download_image(serfd, buffer, argv[optind++]);
+    for (i = 0; i < nimages && ret >= 0; i++)
+        ret = download_image(serfd, buffer, images[i], window);
 
     /* close unframed session */
     buffer[0] = QDL_CMD_SESSION_DONE_REQ;
@@ -983,10 +954,10 @@ int main(int argc, char *argv[])
 
     /* read close response  */
     if (!read_and_parse(serfd, false))
-        fprintf(stderr, "Success!\n");
+        info("Success!\n");
 
     /* terminate SDP session */
-    fprintf(stderr, "Terminating session - rebooting modem...\n");
+    info("Terminating session - rebooting modem...\n");
     buffer[0] = QDL_CMD_SESSION_CLOSE_REQ;
     write_hdlc(serfd, buffer, 1);
 
@@ -999,3 +970,79 @@ err:
     free(buffer);
     return ret;
 }
+
+int main(int argc, char *argv[])
+{
+    int opt, ret = 0, window = 1, ndevices = 0, i, failed = 0;
+    const char *devices[MAX_DEVICES];
+    pid_t pids[MAX_DEVICES];
+
+    fprintf(stderr, "%s\n", DESCRIPTION);
+    while ((opt = getopt_long(argc, argv, "i:s:m:w:dvh", main_options, NULL)) != -1) {
+        switch(opt) {
+        case 's':
+            if (ndevices == MAX_DEVICES) {
+                fprintf(stderr, "Too many devices, at most %d\n", MAX_DEVICES);
+                return -1;
+            }
+            devices[ndevices++] = optarg;
+            break;
+        case 'w':
+            window = atoi(optarg);
+            if (window < 1 || window > 255) {
+                usage(argv[0]);
+                return -1;
+            }
+            break;
+#ifdef DEBUG
+        case 'd':
+            debug = true;
+            break;
+#endif
+        case 'h':
+            usage(argv[0]);
+            return 0;
+        }
+    }
+
+    /* need at least one firmware filename */
+    if (optind == argc || !ndevices) {
+        usage(argv[0]);
+        return -1;
+    }
+
+    if (ndevices == 1)
+        return flash_device(devices[0], &argv[optind], argc - optind, window);
+
+    /* flash all devices in parallel, one process each */
+    for (i = 0; i < ndevices; i++) {
+        pids[i] = fork();
+        if (pids[i] < 0) {
+            fprintf(stderr, "Cannot fork for %s: %s\n", devices[i], strerror(errno));
+            failed++;
+            continue;
+        }
+        if (pids[i] == 0) {
+            static char prefix[PATH_MAX + 4];
+
+            snprintf(prefix, sizeof(prefix), "[%s] ", devices[i]);
+            log_prefix = prefix;
+            ret = flash_device(devices[i], &argv[optind], argc - optind, window);
+            _exit(ret < 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+        }
+    }
+
+    for (i = 0; i < ndevices; i++) {
+        int status;
+
+        if (pids[i] <= 0)
+            continue;
+        if (waitpid(pids[i], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) {
+            fprintf(stderr, "[%s] flashing failed\n", devices[i]);
+            failed++;
+        } else
+            fprintf(stderr, "[%s] flashing succeeded\n", devices[i]);
+    }
+
+    return failed ? -1 : 0;
+}